@@ -11,8 +11,13 @@
  * - Search
  * - Iteration
  * - Output
+ *
+ * Building it again with -DCMC_NO_HINTS turns off the branch, restrict and
+ * pure hints of utl/compiler.h to measure their effect.
  */
 #include "macro_collections.h"
+#include "utl/cmc_perf.h"
+#include "utl/hash.h"
 #include "util/twister.c"
 #include <stdio.h>
 #include <stdint.h>
@@ -26,6 +31,10 @@
 // Percentage % macro
 #define PC(x) x * 100.0
 
+// Hardware counters of each phase, when the system has them
+static struct cmc_perf perf;
+static bool counters;
+
 static int intcmp(int a, int b)
 {
     return a - b;
@@ -33,14 +42,7 @@ static int intcmp(int a, int b)
 
 static size_t inthash(int t)
 {
-    size_t a = t;
-    a += ~(a << 15);
-    a ^= (a >> 10);
-    a += (a << 3);
-    a ^= (a >> 6);
-    a += ~(a << 11);
-    a ^= (a >> 16);
-    return a;
+    return cmc_hash_int(t);
 }
 
 size_t randsize(size_t min, size_t max, mt_state_ptr st)
@@ -48,6 +50,16 @@ size_t randsize(size_t min, size_t max, mt_state_ptr st)
     return (size_t)floor(twist_real(st) * ((double)max - (double)min + 1.0) + (double)min);
 }
 
+// Counters of the last phase per operation
+void perf_report(const char *phase, const char *name, size_t ops)
+{
+    if (!counters)
+        return;
+
+    printf("%9s %10s PER OP   :", phase, name);
+    cmc_perf_print(stdout, &perf, ops);
+}
+
 void shuffle(int *array, mt_state_ptr st)
 {
     for (size_t i = 0; i < NTOTAL; i++)
@@ -67,10 +79,12 @@ CMC_COLLECTION_GENERATE(LINKEDLIST, ll, linked, /* K */, int)
 CMC_COLLECTION_GENERATE(LIST, l, list, /* K */, int)
 CMC_COLLECTION_GENERATE(QUEUE, q, queue, /* K */, int)
 CMC_COLLECTION_GENERATE(STACK, s, stack, /* K */, int)
+CMC_COLLECTION_GENERATE(SWISSMAP, sm, smap, int, int)
 CMC_COLLECTION_GENERATE(TREEMAP, tm, tmap, int, int)
 CMC_COLLECTION_GENERATE(TREESET, ts, tset, /* K */, int)
 
 CMC_COLLECTION_GENERATE(INTERVALHEAP, ih, iheap, /* k */, int)
+CMC_COLLECTION_GENERATE(MINMAXHEAP, mmh, mmheap, /* k */, int)
 CMC_COLLECTION_GENERATE(MULTIMAP, mm, mmap, int, int)
 CMC_COLLECTION_GENERATE(MULTISET, ms, mset, /* K */, int)
 
@@ -87,12 +101,14 @@ CMC_COLLECTION_GENERATE(MULTISET, ms, mset, /* K */, int)
                                                                                                                  \
         cmc_timer_start(total);                                                                                  \
         cmc_timer_start(timer);                                                                                  \
+        cmc_perf_start(perf);                                                                                    \
                                                                                                                  \
         for (size_t i = 0; i < NTOTAL; i++)                                                                      \
         {                                                                                                        \
             insertbody;                                                                                          \
         }                                                                                                        \
                                                                                                                  \
+        cmc_perf_stop(perf);                                                                                     \
         cmc_timer_stop(timer);                                                                                   \
                                                                                                                  \
         cmc_timer_calc(timer);                                                                                   \
@@ -100,47 +116,56 @@ CMC_COLLECTION_GENERATE(MULTISET, ms, mset, /* K */, int)
         size_t s1 = PFX##_count(coll);                                                                           \
                                                                                                                  \
         printf("    INPUT %10s TOOK %8.0lf milliseconds for %8" PRIuMAX " elements\n", #NAME, timer.result, s1); \
+        perf_report("INPUT", #NAME, NTOTAL);                                                                     \
                                                                                                                  \
         double input_time = timer.result;                                                                        \
                                                                                                                  \
         cmc_timer_start(timer);                                                                                  \
+        cmc_perf_start(perf);                                                                                    \
                                                                                                                  \
         for (size_t i = 0; i < s; i++)                                                                           \
         {                                                                                                        \
             searchbody;                                                                                          \
         }                                                                                                        \
                                                                                                                  \
+        cmc_perf_stop(perf);                                                                                     \
         cmc_timer_stop(timer);                                                                                   \
                                                                                                                  \
         cmc_timer_calc(timer);                                                                                   \
                                                                                                                  \
         printf("   SEARCH %10s TOOK %8.0lf milliseconds for %8" PRIuMAX " elements\n", #NAME, timer.result, s);  \
+        perf_report("SEARCH", #NAME, s);                                                                         \
                                                                                                                  \
         double search_time = timer.result;                                                                       \
                                                                                                                  \
         struct sname##_iter iter;                                                                                \
                                                                                                                  \
         cmc_timer_start(timer);                                                                                  \
+        cmc_perf_start(perf);                                                                                    \
                                                                                                                  \
         for (PFX##_iter_init(&iter, coll); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))                       \
         {                                                                                                        \
         }                                                                                                        \
                                                                                                                  \
+        cmc_perf_stop(perf);                                                                                     \
         cmc_timer_stop(timer);                                                                                   \
                                                                                                                  \
         cmc_timer_calc(timer);                                                                                   \
                                                                                                                  \
         printf("ITERATION %10s TOOK %8.0lf milliseconds for %8" PRIuMAX " elements\n", #NAME, timer.result, s1); \
+        perf_report("ITERATION", #NAME, s1);                                                                     \
                                                                                                                  \
         double iter_time = timer.result;                                                                         \
                                                                                                                  \
         cmc_timer_start(timer);                                                                                  \
+        cmc_perf_start(perf);                                                                                    \
                                                                                                                  \
         for (size_t i = 0; i < NTOTAL; i++)                                                                      \
         {                                                                                                        \
             removebody;                                                                                          \
         }                                                                                                        \
                                                                                                                  \
+        cmc_perf_stop(perf);                                                                                     \
         cmc_timer_stop(timer);                                                                                   \
                                                                                                                  \
         cmc_timer_calc(timer);                                                                                   \
@@ -148,6 +173,7 @@ CMC_COLLECTION_GENERATE(MULTISET, ms, mset, /* K */, int)
         size_t s2 = PFX##_count(coll);                                                                           \
                                                                                                                  \
         printf("   OUTPUT %10s TOOK %8.0lf milliseconds for %8" PRIuMAX " elements\n", #NAME, timer.result, s1); \
+        perf_report("OUTPUT", #NAME, s1);                                                                        \
                                                                                                                  \
         double output_time = timer.result;                                                                       \
                                                                                                                  \
@@ -183,13 +209,74 @@ BENCHMARK(LINKEDLIST, ll, linked, ll_new(), ll_push_back(coll, array[i]), ll_pop
 BENCHMARK(LIST, l, list, l_new(NTOTAL), l_push_back(coll, array[i]), l_pop_back(coll), l_contains(coll, sarray[i], intcmp))
 BENCHMARK(QUEUE, q, queue, q_new(NTOTAL), q_enqueue(coll, array[i]), q_dequeue(coll), q_contains(coll, sarray[i], intcmp))
 BENCHMARK(STACK, s, stack, s_new(NTOTAL), s_push(coll, array[i]), s_pop(coll), s_contains(coll, sarray[i], intcmp))
+BENCHMARK(SWISSMAP, sm, smap, sm_new(NTOTAL, 0.6, intcmp, inthash), sm_insert(coll, array[i], array[i]), sm_remove(coll, array[i], &r), sm_contains(coll, sarray[i]))
 BENCHMARK(TREEMAP, tm, tmap, tm_new(intcmp), tm_insert(coll, array[i], array[i]), tm_remove(coll, array[i], &r), tm_contains(coll, sarray[i]))
 BENCHMARK(TREESET, ts, tset, ts_new(intcmp), ts_insert(coll, array[i]), ts_remove(coll, array[i]), ts_contains(coll, sarray[i]))
 
 BENCHMARK(INTERVALHEAP, ih, iheap, ih_new(NTOTAL, intcmp), ih_insert(coll, array[i]), ih_remove_max(coll, &r), ih_contains(coll, sarray[i]))
+BENCHMARK(MINMAXHEAP, mmh, mmheap, mmh_new(NTOTAL, intcmp), mmh_insert(coll, array[i]), mmh_remove_max(coll, &r), mmh_contains(coll, sarray[i]))
 BENCHMARK(MULTIMAP, mm, mmap, mm_new(NTOTAL, 0.8, intcmp, inthash), mm_insert(coll, array[i], array[i]), mm_remove(coll, array[i], &r), mm_contains(coll, sarray[i]))
 BENCHMARK(MULTISET, ms, mset, ms_new(NTOTAL, 0.6, intcmp, inthash), ms_insert(coll, array[i]), ms_remove(coll, array[i]), ms_contains(coll, sarray[i]))
 
+// A table with a constant amount of keys where every new key replaces an old
+// one, like a table of sessions. Removed entries do not leave tombstones behind
+// so searches on the table after the churn are not slowed down by them
+void HASHMAP_churn_benchmark(int *array, int *sarray)
+{
+    printf("+------------------------------------------------------------ %10s\n", "CHURN");
+    printf("+------------------------------------------------------------ \n");
+    struct cmc_timer timer;
+    int r;
+
+    const size_t half = NTOTAL / 2;
+
+    struct hmap *coll = hm_new(half, 0.6, intcmp, inthash);
+
+    for (size_t i = 0; i < half; i++)
+        hm_insert(coll, array[i], array[i]);
+
+    cmc_timer_start(timer);
+    cmc_perf_start(perf);
+
+    for (size_t i = half; i < NTOTAL; i++)
+    {
+        hm_remove(coll, array[i - half], &r);
+        hm_insert(coll, array[i], array[i]);
+    }
+
+    cmc_perf_stop(perf);
+    cmc_timer_stop(timer);
+    cmc_timer_calc(timer);
+
+    printf("    CHURN %10s TOOK %8.0lf milliseconds for %8" PRIuMAX " elements\n", "HASHMAP", timer.result, half);
+    perf_report("CHURN", "HASHMAP", half);
+
+    size_t found = 0;
+
+    cmc_timer_start(timer);
+    cmc_perf_start(perf);
+
+    // Half of the searches are misses
+    for (size_t i = 0; i < NTOTAL; i++)
+    {
+        if (hm_contains(coll, sarray[i]))
+            found++;
+    }
+
+    cmc_perf_stop(perf);
+    cmc_timer_stop(timer);
+    cmc_timer_calc(timer);
+
+    printf("   SEARCH %10s TOOK %8.0lf milliseconds for %8" PRIuMAX " elements\n", "HASHMAP", timer.result, NTOTAL);
+    perf_report("SEARCH", "HASHMAP", NTOTAL);
+
+    hm_free(coll, NULL);
+
+    assert(found == half);
+
+    printf("+------------------------------------------------------------ %10s\n\n", "CHURN");
+}
+
 int main(void)
 {
     // Using the Mersenne Twister to generate random numbers. This seed
@@ -217,6 +304,17 @@ int main(void)
 
     shuffle(sarray, &st);
 
+    // Cycles, instructions, cache, branch and TLB misses per operation of
+    // every phase, from perf_event_open on Linux
+    counters = cmc_perf_init(&perf);
+
+    if (!counters)
+        printf("\nNote: Hardware performance counters are not available.\n");
+
+#ifdef CMC_NO_HINTS
+    printf("\nNote: Compiler hints are turned off.\n");
+#endif
+
     printf("\nNote: Adjusted Time refers to if the container had done a search over all %" PRIuMAX " elements.\n\n", NTOTAL);
 
     // Linear containers have to search for NMIN elements and non-linear (hash
@@ -232,13 +330,17 @@ int main(void)
     LIST_io_benchmark(array, sarray, NMIN);
     QUEUE_io_benchmark(array, sarray, NMIN);
     STACK_io_benchmark(array, sarray, NMIN);
+    SWISSMAP_io_benchmark(array, sarray, NTOTAL);
     TREEMAP_io_benchmark(array, sarray, NTOTAL);
     TREESET_io_benchmark(array, sarray, NTOTAL);
 
     INTERVALHEAP_io_benchmark(array, array, NMIN);
+    MINMAXHEAP_io_benchmark(array, array, NMIN);
     MULTIMAP_io_benchmark(array, array, NTOTAL);
     MULTISET_io_benchmark(array, array, NTOTAL);
 
+    HASHMAP_churn_benchmark(array, sarray);
+
     cmc_timer_stop(timer);
     cmc_timer_calc(timer);
 
@@ -246,6 +348,8 @@ int main(void)
     printf("| Total Benchmark Running Time : %12.0lf seconds       | \n", timer.result / 1000);
     printf("+-----------------------------------------------------------+ \n");
 
+    cmc_perf_release(&perf);
+
     free(array);
     free(sarray);
 
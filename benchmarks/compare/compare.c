@@ -0,0 +1,934 @@
+/**
+ * compare.c
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Runs the same workloads on HashMap, SwissMap, TreeMap, Deque and Heap */
+/* and on the equivalent containers of other C libraries, side by side, at */
+/* a few sizes, and reports operations per second and the peak resident */
+/* memory that each run added. Every run is done by a child process of its */
+/* own, so its peak memory is not mixed with the one of the others. */
+
+/* The other libraries are not part of this repository. Each is compiled */
+/* in when its macro is defined and its headers can be found, see the */
+/* Makefile: COMPARE_KLIB for khash.h, kbtree.h and kdq.h, COMPARE_STB for */
+/* stb_ds.h and COMPARE_GLIB for GHashTable, GTree and GQueue. */
+
+/* Map workloads, all with 64 bit keys and values: */
+/* - insert_random, insert_sequential and insert_zipf insert n keys into */
+/*   an empty map, the last ones drawn from a zipfian distribution with */
+/*   repetitions, where keys that are already in the map are kept */
+/* - hit and miss look up n keys that are and are not in a map of n keys */
+/* - churn removes each of the n keys in the order they were inserted and */
+/*   inserts a new one in its place, 2n operations */
+/* - iterate sums the values of a map of n keys */
+/* - string_insert and string_hit do the same with string keys */
+/* Deque workloads: fill with push_back, queue with push_back and pop_front */
+/* on a deque of n elements, stack with push_front and pop_back and iterate. */
+/* Heap workloads: push of random keys and pop of all of them. */
+
+/* Usage: compare [-n max size] */
+
+#include "cmc/deque.h"
+#include "cmc/hashmap.h"
+#include "cmc/heap.h"
+#include "cmc/swissmap.h"
+#include "cmc/treemap.h"
+#include "utl/hash.h"
+#include "utl/timer.h"
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifdef COMPARE_KLIB
+#include "kbtree.h"
+#include "kdq.h"
+#include "khash.h"
+#endif
+
+#ifdef COMPARE_STB
+#define STB_DS_IMPLEMENTATION
+#include "stb_ds.h"
+#endif
+
+#ifdef COMPARE_GLIB
+#include <glib.h>
+#endif
+
+#define MIN_SIZE 10000
+#define MAX_SIZE 1000000
+#define ZIPF_S 0.99
+
+enum workload
+{
+    W_INSERT_RANDOM,
+    W_INSERT_SEQUENTIAL,
+    W_INSERT_ZIPF,
+    W_HIT,
+    W_MISS,
+    W_CHURN,
+    W_ITERATE,
+    W_STRING_INSERT,
+    W_STRING_HIT,
+    W_FILL,
+    W_QUEUE,
+    W_STACK,
+    W_DEQUE_ITERATE,
+    W_PUSH,
+    W_POP,
+    W_COUNT
+};
+
+static const char *workloads[] = { "insert_random", "insert_sequential", "insert_zipf",
+                                   "hit",           "miss",              "churn",
+                                   "iterate",       "string_insert",     "string_hit",
+                                   "fill",          "queue",             "stack",
+                                   "iterate",       "push",              "pop" };
+
+/* Input shared by every run, made before the children are created */
+struct data
+{
+    size_t n;
+    /* Unique random keys, the first n of them in the map and the next n not */
+    uint64_t *keys;
+    /* The first n keys shuffled, so lookups are not in insertion order */
+    uint64_t *hits;
+    uint64_t *zipf;
+    char **strings;
+};
+
+/* Keeps the results of lookups from being optimized away */
+static volatile uint64_t sink;
+
+static uint64_t splitmix64(uint64_t *state)
+{
+    uint64_t z = (*state += UINT64_C(0x9E3779B97F4A7C15));
+    z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+    z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+    return z ^ (z >> 31);
+}
+
+static int u64cmp(uint64_t a, uint64_t b)
+{
+    return (a > b) - (a < b);
+}
+
+static int strcmp_(char *a, char *b)
+{
+    return strcmp(a, b);
+}
+
+static size_t hash_str(char *key)
+{
+    return cmc_hash_str(key);
+}
+
+static size_t hash_u64(uint64_t key)
+{
+    return (size_t)cmc_hash_u64(key);
+}
+
+#define U64CMP(a, b) (((a) > (b)) - ((a) < (b)))
+
+/* Collections of this library */
+CMC_GENERATE_HASHMAP_EX(hm, hashmap, uint64_t, uint64_t, U64CMP, hash_u64)
+CMC_GENERATE_SWISSMAP_EX(sm, swissmap, uint64_t, uint64_t, U64CMP, hash_u64)
+CMC_GENERATE_HASHMAP(hms, hashmap_str, char *, uint64_t)
+CMC_GENERATE_TREEMAP(tm, treemap, uint64_t, uint64_t)
+CMC_GENERATE_DEQUE(d, deque, uint64_t)
+CMC_GENERATE_HEAP(h, heap, uint64_t)
+
+/* Every adapter gives a map the same operations. Inserts keep the value */
+/* of keys that are already in the map */
+#define CMC_MAP_ADAPTER(PFX, SNAME)                                                 \
+    static struct SNAME *PFX##_a_new(void)                                          \
+    {                                                                               \
+        return PFX##_new(16, 0.8, u64cmp, hash_u64);                             \
+    }                                                                               \
+    static uint64_t PFX##_a_sum(struct SNAME *map)                                  \
+    {                                                                               \
+        uint64_t sum = 0;                                                           \
+        struct SNAME##_iter iter;                                                   \
+                                                                                    \
+        for (PFX##_iter_init(&iter, map); !PFX##_iter_end(&iter); PFX##_iter_next(&iter)) \
+            sum += PFX##_iter_value(&iter);                                         \
+                                                                                    \
+        return sum;                                                                 \
+    }
+
+CMC_MAP_ADAPTER(hm, hashmap)
+CMC_MAP_ADAPTER(sm, swissmap)
+
+static struct treemap *tm_a_new(void)
+{
+    return tm_new(u64cmp);
+}
+
+static uint64_t tm_a_sum(struct treemap *map)
+{
+    uint64_t sum = 0;
+    struct treemap_iter iter;
+
+    for (tm_iter_init(&iter, map); !tm_iter_end(&iter); tm_iter_next(&iter))
+        sum += tm_iter_value(&iter);
+
+    return sum;
+}
+
+static void hm_a_remove(struct hashmap *map, uint64_t key)
+{
+    uint64_t value;
+    hm_remove(map, key, &value);
+}
+
+static void sm_a_remove(struct swissmap *map, uint64_t key)
+{
+    uint64_t value;
+    sm_remove(map, key, &value);
+}
+
+static void tm_a_remove(struct treemap *map, uint64_t key)
+{
+    uint64_t value;
+    tm_remove(map, key, &value);
+}
+
+static uint64_t d_a_sum(struct deque *deque)
+{
+    uint64_t sum = 0;
+    struct deque_iter iter;
+
+    for (d_iter_init(&iter, deque); !d_iter_end(&iter); d_iter_next(&iter))
+        sum += d_iter_value(&iter);
+
+    return sum;
+}
+
+static uint64_t h_a_pop(struct heap *heap)
+{
+    uint64_t value = 0;
+    h_remove(heap, &value);
+    return value;
+}
+
+#ifdef COMPARE_KLIB
+KHASH_MAP_INIT_INT64(u64, uint64_t)
+KHASH_MAP_INIT_STR(str, uint64_t)
+
+static void kh_a_insert(khash_t(u64) * h, uint64_t key, uint64_t value)
+{
+    int ret;
+    khiter_t k = kh_put(u64, h, key, &ret);
+
+    if (ret != 0)
+        kh_value(h, k) = value;
+}
+
+static bool kh_a_contains(khash_t(u64) * h, uint64_t key)
+{
+    return kh_get(u64, h, key) != kh_end(h);
+}
+
+static void kh_a_remove(khash_t(u64) * h, uint64_t key)
+{
+    khiter_t k = kh_get(u64, h, key);
+
+    if (k != kh_end(h))
+        kh_del(u64, h, k);
+}
+
+static uint64_t kh_a_sum(khash_t(u64) * h)
+{
+    uint64_t sum = 0;
+
+    for (khiter_t k = kh_begin(h); k != kh_end(h); ++k)
+    {
+        if (kh_exist(h, k))
+            sum += kh_value(h, k);
+    }
+
+    return sum;
+}
+
+static void khs_a_insert(khash_t(str) * h, char *key, uint64_t value)
+{
+    int ret;
+    khiter_t k = kh_put(str, h, key, &ret);
+
+    if (ret != 0)
+        kh_value(h, k) = value;
+}
+
+static bool khs_a_contains(khash_t(str) * h, char *key)
+{
+    return kh_get(str, h, key) != kh_end(h);
+}
+
+typedef struct
+{
+    uint64_t key;
+    uint64_t value;
+} kb_pair;
+
+#define kb_pair_cmp(a, b) U64CMP((a).key, (b).key)
+
+KBTREE_INIT(u64, kb_pair, kb_pair_cmp)
+
+static void kb_a_insert(kbtree_t(u64) * b, uint64_t key, uint64_t value)
+{
+    kb_pair pair = { key, value };
+
+    if (!kb_getp(u64, b, &pair))
+        kb_putp(u64, b, &pair);
+}
+
+static bool kb_a_contains(kbtree_t(u64) * b, uint64_t key)
+{
+    kb_pair pair = { key, 0 };
+
+    return kb_getp(u64, b, &pair) != NULL;
+}
+
+static void kb_a_remove(kbtree_t(u64) * b, uint64_t key)
+{
+    kb_pair pair = { key, 0 };
+
+    if (kb_getp(u64, b, &pair))
+        kb_delp(u64, b, &pair);
+}
+
+static uint64_t kb_a_sum(kbtree_t(u64) * b)
+{
+    uint64_t sum = 0;
+    kbitr_t itr;
+
+    for (kb_itr_first(u64, b, &itr); kb_itr_valid(&itr); kb_itr_next(u64, b, &itr))
+        sum += kb_itr_key(kb_pair, &itr).value;
+
+    return sum;
+}
+
+KDQ_INIT(uint64_t)
+
+static uint64_t kdq_a_sum(kdq_t(uint64_t) * q)
+{
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i < kdq_size(q); i++)
+        sum += kdq_at(q, i);
+
+    return sum;
+}
+#endif
+
+#ifdef COMPARE_STB
+typedef struct
+{
+    uint64_t key;
+    uint64_t value;
+} stb_entry;
+
+typedef struct
+{
+    char *key;
+    uint64_t value;
+} stb_str_entry;
+
+/* The map is reallocated by its macros, so they are given its address */
+static stb_entry **stb_a_new(void)
+{
+    return calloc(1, sizeof(stb_entry *));
+}
+
+static void stb_a_insert(stb_entry **map, uint64_t key, uint64_t value)
+{
+    if (hmgeti(*map, key) < 0)
+        hmput(*map, key, value);
+}
+
+static bool stb_a_contains(stb_entry **map, uint64_t key)
+{
+    return hmgeti(*map, key) >= 0;
+}
+
+static void stb_a_remove(stb_entry **map, uint64_t key)
+{
+    hmdel(*map, key);
+}
+
+static uint64_t stb_a_sum(stb_entry **map)
+{
+    uint64_t sum = 0;
+
+    for (ptrdiff_t i = 0; i < hmlen(*map); i++)
+        sum += (*map)[i].value;
+
+    return sum;
+}
+
+static void stb_a_free(stb_entry **map)
+{
+    hmfree(*map);
+    free(map);
+}
+
+static stb_str_entry **stbs_a_new(void)
+{
+    return calloc(1, sizeof(stb_str_entry *));
+}
+
+static void stbs_a_insert(stb_str_entry **map, char *key, uint64_t value)
+{
+    if (shgeti(*map, key) < 0)
+        shput(*map, key, value);
+}
+
+static bool stbs_a_contains(stb_str_entry **map, char *key)
+{
+    return shgeti(*map, key) >= 0;
+}
+
+static void stbs_a_free(stb_str_entry **map)
+{
+    shfree(*map);
+    free(map);
+}
+#endif
+
+#ifdef COMPARE_GLIB
+/* Keys and values are stored in the pointers themselves */
+#define G_KEY(key) ((gpointer)(uintptr_t)(key))
+
+static guint g_u64_hash(gconstpointer key)
+{
+    return (guint)cmc_hash_u64((uint64_t)(uintptr_t)key);
+}
+
+static gint g_u64_cmp(gconstpointer a, gconstpointer b, gpointer data)
+{
+    return U64CMP((uintptr_t)a, (uintptr_t)b);
+}
+
+static GHashTable *gh_a_new(void)
+{
+    return g_hash_table_new(g_u64_hash, g_direct_equal);
+}
+
+static void gh_a_insert(GHashTable *table, uint64_t key, uint64_t value)
+{
+    if (!g_hash_table_contains(table, G_KEY(key)))
+        g_hash_table_insert(table, G_KEY(key), G_KEY(value));
+}
+
+static uint64_t gh_a_sum(GHashTable *table)
+{
+    uint64_t sum = 0;
+    GHashTableIter iter;
+    gpointer key, value;
+
+    g_hash_table_iter_init(&iter, table);
+
+    while (g_hash_table_iter_next(&iter, &key, &value))
+        sum += (uint64_t)(uintptr_t)value;
+
+    return sum;
+}
+
+static GTree *gt_a_new(void)
+{
+    return g_tree_new_full(g_u64_cmp, NULL, NULL, NULL);
+}
+
+static void gt_a_insert(GTree *tree, uint64_t key, uint64_t value)
+{
+    if (!g_tree_lookup_extended(tree, G_KEY(key), NULL, NULL))
+        g_tree_insert(tree, G_KEY(key), G_KEY(value));
+}
+
+static bool gt_a_contains(GTree *tree, uint64_t key)
+{
+    return g_tree_lookup_extended(tree, G_KEY(key), NULL, NULL);
+}
+
+static gboolean gt_a_add(gpointer key, gpointer value, gpointer sum)
+{
+    *(uint64_t *)sum += (uint64_t)(uintptr_t)value;
+    return FALSE;
+}
+
+static uint64_t gt_a_sum(GTree *tree)
+{
+    uint64_t sum = 0;
+    g_tree_foreach(tree, gt_a_add, &sum);
+    return sum;
+}
+
+static void gq_a_add(gpointer value, gpointer sum)
+{
+    *(uint64_t *)sum += (uint64_t)(uintptr_t)value;
+}
+
+static uint64_t gq_a_sum(GQueue *queue)
+{
+    uint64_t sum = 0;
+    g_queue_foreach(queue, gq_a_add, &sum);
+    return sum;
+}
+#endif
+
+static double per_second(size_t ops, uint64_t start, uint64_t stop)
+{
+    return (double)ops * 1e9 / (double)(stop > start ? stop - start : 1);
+}
+
+/* Defines NAME(workload, data), that returns operations per second or a */
+/* negative number for workloads that the map does not support */
+#define MAP_CANDIDATE(NAME, T, NEW, INSERT, CONTAINS, REMOVE, SUM, FREE)           \
+    static double NAME(enum workload workload, struct data *d)                     \
+    {                                                                              \
+        size_t n = d->n, ops = n;                                                  \
+        uint64_t found = 0, start, stop;                                           \
+        T map = NEW;                                                               \
+                                                                                   \
+        if (workload >= W_HIT)                                                     \
+        {                                                                          \
+            for (size_t i = 0; i < n; i++)                                         \
+                INSERT(map, d->keys[i], i);                                        \
+        }                                                                          \
+                                                                                   \
+        start = cmc_timer_now();                                                   \
+                                                                                   \
+        switch (workload)                                                          \
+        {                                                                          \
+        case W_INSERT_RANDOM:                                                      \
+            for (size_t i = 0; i < n; i++)                                         \
+                INSERT(map, d->keys[i], i);                                        \
+            break;                                                                 \
+        case W_INSERT_SEQUENTIAL:                                                  \
+            for (size_t i = 0; i < n; i++)                                         \
+                INSERT(map, (uint64_t)i, i);                                       \
+            break;                                                                 \
+        case W_INSERT_ZIPF:                                                        \
+            for (size_t i = 0; i < n; i++)                                         \
+                INSERT(map, d->zipf[i], i);                                        \
+            break;                                                                 \
+        case W_HIT:                                                                \
+            for (size_t i = 0; i < n; i++)                                         \
+                found += CONTAINS(map, d->hits[i]);                                \
+            break;                                                                 \
+        case W_MISS:                                                               \
+            for (size_t i = 0; i < n; i++)                                         \
+                found += CONTAINS(map, d->keys[n + i]);                            \
+            break;                                                                 \
+        case W_CHURN:                                                              \
+            for (size_t i = 0; i < n; i++)                                         \
+            {                                                                      \
+                REMOVE(map, d->keys[i]);                                           \
+                INSERT(map, d->keys[n + i], i);                                    \
+            }                                                                      \
+            ops = 2 * n;                                                           \
+            break;                                                                 \
+        case W_ITERATE:                                                            \
+            found += SUM(map);                                                     \
+            break;                                                                 \
+        default:                                                                   \
+            FREE(map);                                                             \
+            return -1.0;                                                           \
+        }                                                                          \
+                                                                                   \
+        stop = cmc_timer_now();                                                    \
+        sink += found;                                                             \
+        FREE(map);                                                                 \
+                                                                                   \
+        return per_second(ops, start, stop);                                       \
+    }
+
+#define STRING_CANDIDATE(NAME, T, NEW, INSERT, CONTAINS, FREE)                     \
+    static double NAME(enum workload workload, struct data *d)                     \
+    {                                                                              \
+        size_t n = d->n;                                                           \
+        uint64_t found = 0, start, stop;                                           \
+        T map = NEW;                                                               \
+                                                                                   \
+        if (workload != W_STRING_INSERT && workload != W_STRING_HIT)               \
+        {                                                                          \
+            FREE(map);                                                             \
+            return -1.0;                                                           \
+        }                                                                          \
+                                                                                   \
+        if (workload == W_STRING_HIT)                                              \
+        {                                                                          \
+            for (size_t i = 0; i < n; i++)                                         \
+                INSERT(map, d->strings[i], i);                                     \
+        }                                                                          \
+                                                                                   \
+        start = cmc_timer_now();                                                   \
+                                                                                   \
+        for (size_t i = 0; i < n; i++)                                             \
+        {                                                                          \
+            if (workload == W_STRING_INSERT)                                       \
+                INSERT(map, d->strings[i], i);                                     \
+            else                                                                   \
+                found += CONTAINS(map, d->strings[n - 1 - i]);                     \
+        }                                                                          \
+                                                                                   \
+        stop = cmc_timer_now();                                                    \
+        sink += found;                                                             \
+        FREE(map);                                                                 \
+                                                                                   \
+        return per_second(n, start, stop);                                         \
+    }
+
+#define DEQUE_CANDIDATE(NAME, T, NEW, PUSH_BACK, PUSH_FRONT, POP_FRONT, POP_BACK, SUM, FREE) \
+    static double NAME(enum workload workload, struct data *d)                     \
+    {                                                                              \
+        size_t n = d->n, ops = n;                                                  \
+        uint64_t found = 0, start, stop;                                           \
+        T deque = NEW;                                                             \
+                                                                                   \
+        if (workload != W_FILL)                                                    \
+        {                                                                          \
+            for (size_t i = 0; i < n; i++)                                         \
+                PUSH_BACK(deque, d->keys[i]);                                      \
+        }                                                                          \
+                                                                                   \
+        start = cmc_timer_now();                                                   \
+                                                                                   \
+        switch (workload)                                                          \
+        {                                                                          \
+        case W_FILL:                                                               \
+            for (size_t i = 0; i < n; i++)                                         \
+                PUSH_BACK(deque, d->keys[i]);                                      \
+            break;                                                                 \
+        case W_QUEUE:                                                              \
+            for (size_t i = 0; i < n; i++)                                         \
+            {                                                                      \
+                PUSH_BACK(deque, d->keys[n + i]);                                  \
+                POP_FRONT(deque);                                                  \
+            }                                                                      \
+            ops = 2 * n;                                                           \
+            break;                                                                 \
+        case W_STACK:                                                              \
+            for (size_t i = 0; i < n; i++)                                         \
+            {                                                                      \
+                PUSH_FRONT(deque, d->keys[n + i]);                                 \
+                POP_BACK(deque);                                                   \
+            }                                                                      \
+            ops = 2 * n;                                                           \
+            break;                                                                 \
+        case W_DEQUE_ITERATE:                                                      \
+            found += SUM(deque);                                                   \
+            break;                                                                 \
+        default:                                                                   \
+            FREE(deque);                                                           \
+            return -1.0;                                                           \
+        }                                                                          \
+                                                                                   \
+        stop = cmc_timer_now();                                                    \
+        sink += found;                                                             \
+        FREE(deque);                                                               \
+                                                                                   \
+        return per_second(ops, start, stop);                                       \
+    }
+
+#define HEAP_CANDIDATE(NAME, T, NEW, PUSH, POP, FREE)                              \
+    static double NAME(enum workload workload, struct data *d)                     \
+    {                                                                              \
+        size_t n = d->n;                                                           \
+        uint64_t found = 0, start, stop;                                           \
+        T heap = NEW;                                                              \
+                                                                                   \
+        if (workload != W_PUSH && workload != W_POP)                               \
+        {                                                                          \
+            FREE(heap);                                                            \
+            return -1.0;                                                           \
+        }                                                                          \
+                                                                                   \
+        if (workload == W_POP)                                                     \
+        {                                                                          \
+            for (size_t i = 0; i < n; i++)                                         \
+                PUSH(heap, d->keys[i]);                                            \
+        }                                                                          \
+                                                                                   \
+        start = cmc_timer_now();                                                   \
+                                                                                   \
+        for (size_t i = 0; i < n; i++)                                             \
+        {                                                                          \
+            if (workload == W_PUSH)                                                \
+                PUSH(heap, d->keys[i]);                                            \
+            else                                                                   \
+                found += POP(heap);                                                \
+        }                                                                          \
+                                                                                   \
+        stop = cmc_timer_now();                                                    \
+        sink += found;                                                             \
+        FREE(heap);                                                                \
+                                                                                   \
+        return per_second(n, start, stop);                                         \
+    }
+
+#define CMC_FREE(PFX) PFX##_a_free
+#define hm_a_free(map) hm_free(map, NULL)
+#define sm_a_free(map) sm_free(map, NULL)
+#define tm_a_free(map) tm_free(map, NULL)
+#define hms_a_free(map) hms_free(map, NULL)
+#define d_a_free(deque) d_free(deque, NULL)
+#define h_a_free(heap) h_free(heap, NULL)
+
+MAP_CANDIDATE(run_hashmap, struct hashmap *, hm_a_new(), hm_insert, hm_contains, hm_a_remove,
+              hm_a_sum, hm_a_free)
+MAP_CANDIDATE(run_swissmap, struct swissmap *, sm_a_new(), sm_insert, sm_contains, sm_a_remove,
+              sm_a_sum, sm_a_free)
+MAP_CANDIDATE(run_treemap, struct treemap *, tm_a_new(), tm_insert, tm_contains, tm_a_remove,
+              tm_a_sum, tm_a_free)
+STRING_CANDIDATE(run_hashmap_str, struct hashmap_str *, hms_new(16, 0.8, strcmp_, hash_str),
+                 hms_insert, hms_contains, hms_a_free)
+DEQUE_CANDIDATE(run_deque, struct deque *, d_new(16), d_push_back, d_push_front, d_pop_front,
+                d_pop_back, d_a_sum, d_a_free)
+HEAP_CANDIDATE(run_heap, struct heap *, h_new(16, cmc_min_heap, u64cmp), h_insert, h_a_pop,
+               h_a_free)
+
+#ifdef COMPARE_KLIB
+#define kh_a_free(h) kh_destroy(u64, h)
+#define khs_a_free(h) kh_destroy(str, h)
+#define kb_a_free(b) kb_destroy(u64, b)
+#define kdq_a_push_back(q, v) kdq_push(uint64_t, q, v)
+#define kdq_a_push_front(q, v) kdq_unshift(uint64_t, q, v)
+#define kdq_a_pop_front(q) kdq_shift(uint64_t, q)
+#define kdq_a_pop_back(q) kdq_pop(uint64_t, q)
+#define kdq_a_free(q) kdq_destroy(uint64_t, q)
+
+MAP_CANDIDATE(run_khash, khash_t(u64) *, kh_init(u64), kh_a_insert, kh_a_contains, kh_a_remove,
+              kh_a_sum, kh_a_free)
+MAP_CANDIDATE(run_kbtree, kbtree_t(u64) *, kb_init(u64, KB_DEFAULT_SIZE), kb_a_insert,
+              kb_a_contains, kb_a_remove, kb_a_sum, kb_a_free)
+STRING_CANDIDATE(run_khash_str, khash_t(str) *, kh_init(str), khs_a_insert, khs_a_contains,
+                 khs_a_free)
+DEQUE_CANDIDATE(run_kdq, kdq_t(uint64_t) *, kdq_init(uint64_t), kdq_a_push_back,
+                kdq_a_push_front, kdq_a_pop_front, kdq_a_pop_back, kdq_a_sum, kdq_a_free)
+#endif
+
+#ifdef COMPARE_STB
+MAP_CANDIDATE(run_stb_hm, stb_entry **, stb_a_new(), stb_a_insert, stb_a_contains, stb_a_remove,
+              stb_a_sum, stb_a_free)
+STRING_CANDIDATE(run_stb_sh, stb_str_entry **, stbs_a_new(), stbs_a_insert, stbs_a_contains,
+                 stbs_a_free)
+#endif
+
+#ifdef COMPARE_GLIB
+#define gh_a_contains(t, k) g_hash_table_contains(t, G_KEY(k))
+#define gh_a_remove(t, k) g_hash_table_remove(t, G_KEY(k))
+#define gt_a_remove(t, k) g_tree_remove(t, G_KEY(k))
+#define ghs_a_new() g_hash_table_new(g_str_hash, g_str_equal)
+#define ghs_a_insert(t, k, v) g_hash_table_insert(t, k, G_KEY(v))
+#define ghs_a_contains(t, k) g_hash_table_contains(t, k)
+#define gq_a_push_back(q, v) g_queue_push_tail(q, G_KEY(v))
+#define gq_a_push_front(q, v) g_queue_push_head(q, G_KEY(v))
+
+MAP_CANDIDATE(run_ghash, GHashTable *, gh_a_new(), gh_a_insert, gh_a_contains, gh_a_remove,
+              gh_a_sum, g_hash_table_destroy)
+MAP_CANDIDATE(run_gtree, GTree *, gt_a_new(), gt_a_insert, gt_a_contains, gt_a_remove, gt_a_sum,
+              g_tree_destroy)
+STRING_CANDIDATE(run_ghash_str, GHashTable *, ghs_a_new(), ghs_a_insert, ghs_a_contains,
+                 g_hash_table_destroy)
+DEQUE_CANDIDATE(run_gqueue, GQueue *, g_queue_new(), gq_a_push_back, gq_a_push_front,
+                g_queue_pop_head, g_queue_pop_tail, gq_a_sum, g_queue_free)
+#endif
+
+struct candidate
+{
+    const char *kind;
+    const char *library;
+    const char *name;
+    double (*run)(enum workload, struct data *);
+};
+
+static const struct candidate candidates[] = {
+    { "hashmap", "cmc", "HashMap", run_hashmap },
+    { "hashmap", "cmc", "SwissMap", run_swissmap },
+#ifdef COMPARE_KLIB
+    { "hashmap", "klib", "khash", run_khash },
+#endif
+#ifdef COMPARE_STB
+    { "hashmap", "stb", "stb_ds hm", run_stb_hm },
+#endif
+#ifdef COMPARE_GLIB
+    { "hashmap", "glib", "GHashTable", run_ghash },
+#endif
+    { "string", "cmc", "HashMap", run_hashmap_str },
+#ifdef COMPARE_KLIB
+    { "string", "klib", "khash", run_khash_str },
+#endif
+#ifdef COMPARE_STB
+    { "string", "stb", "stb_ds sh", run_stb_sh },
+#endif
+#ifdef COMPARE_GLIB
+    { "string", "glib", "GHashTable", run_ghash_str },
+#endif
+    { "treemap", "cmc", "TreeMap", run_treemap },
+#ifdef COMPARE_KLIB
+    { "treemap", "klib", "kbtree", run_kbtree },
+#endif
+#ifdef COMPARE_GLIB
+    { "treemap", "glib", "GTree", run_gtree },
+#endif
+    { "deque", "cmc", "Deque", run_deque },
+#ifdef COMPARE_KLIB
+    { "deque", "klib", "kdq", run_kdq },
+#endif
+#ifdef COMPARE_GLIB
+    { "deque", "glib", "GQueue", run_gqueue },
+#endif
+    { "heap", "cmc", "Heap", run_heap },
+};
+
+static size_t peak_rss_kb(void)
+{
+    struct rusage usage;
+
+    getrusage(RUSAGE_SELF, &usage);
+
+    /* Kilobytes on Linux and bytes on macOS */
+#ifdef __APPLE__
+    return (size_t)usage.ru_maxrss / 1024;
+#else
+    return (size_t)usage.ru_maxrss;
+#endif
+}
+
+/* Runs a workload in a child process, which prints its own result */
+static void run_child(const struct candidate *c, enum workload workload, struct data *d)
+{
+    fflush(stdout);
+
+    pid_t pid = fork();
+
+    if (pid == 0)
+    {
+        size_t before = peak_rss_kb();
+        double ops = c->run(workload, d);
+
+        if (ops >= 0)
+            printf("%s,%s,%s,%s,%zu,%.0f,%zu\n", c->kind, c->library, c->name,
+                   workloads[workload], d->n, ops, peak_rss_kb() - before);
+
+        fflush(stdout);
+        _exit(0);
+    }
+    else if (pid > 0)
+        waitpid(pid, NULL, 0);
+}
+
+/* Ranks from 0 to n - 1, the lower ones much more likely */
+static void make_zipf(uint64_t *out, size_t n, const uint64_t *keys, uint64_t *state)
+{
+    double *cdf = malloc(sizeof(double) * n);
+    double total = 0;
+
+    if (!cdf)
+        exit(1);
+
+    for (size_t i = 0; i < n; i++)
+        cdf[i] = (total += 1.0 / pow((double)(i + 1), ZIPF_S));
+
+    for (size_t i = 0; i < n; i++)
+    {
+        double u = (double)(splitmix64(state) >> 11) / 9007199254740992.0 * total;
+        size_t lo = 0, hi = n - 1;
+
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+
+            if (cdf[mid] < u)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        out[i] = keys[lo];
+    }
+
+    free(cdf);
+}
+
+int main(int argc, char **argv)
+{
+    size_t max = MAX_SIZE;
+    uint64_t state = 42;
+
+    if (argc == 3 && strcmp(argv[1], "-n") == 0)
+        max = (size_t)strtoull(argv[2], NULL, 10);
+
+    struct data d;
+
+    d.keys = malloc(sizeof(uint64_t) * max * 2);
+    d.hits = malloc(sizeof(uint64_t) * max);
+    d.zipf = malloc(sizeof(uint64_t) * max);
+    d.strings = malloc(sizeof(char *) * max);
+
+    if (!d.keys || !d.hits || !d.zipf || !d.strings)
+        return 1;
+
+    /* Unique, since the generator is a bijection of its state */
+    for (size_t i = 0; i < max * 2; i++)
+        d.keys[i] = splitmix64(&state);
+
+    for (size_t i = 0; i < max; i++)
+    {
+        d.strings[i] = malloc(32);
+
+        if (!d.strings[i])
+            return 1;
+
+        snprintf(d.strings[i], 32, "key:%016" PRIx64, d.keys[i]);
+    }
+
+    printf("kind,library,name,workload,size,ops_per_sec,peak_rss_kb\n");
+
+    for (size_t n = MIN_SIZE; n <= max; n *= 10)
+    {
+        /* The keys not in the maps are the ones right after the first n */
+        if (n < max)
+            memcpy(d.keys + n, d.keys + max, sizeof(uint64_t) * n);
+
+        memcpy(d.hits, d.keys, sizeof(uint64_t) * n);
+
+        for (size_t i = n; i > 1; i--)
+        {
+            size_t j = (size_t)(splitmix64(&state) % i);
+            uint64_t tmp = d.hits[i - 1];
+            d.hits[i - 1] = d.hits[j];
+            d.hits[j] = tmp;
+        }
+
+        make_zipf(d.zipf, n, d.keys, &state);
+        d.n = n;
+
+        for (size_t c = 0; c < sizeof(candidates) / sizeof(candidates[0]); c++)
+        {
+            for (int w = 0; w < W_COUNT; w++)
+                run_child(&candidates[c], (enum workload)w, &d);
+        }
+    }
+
+    for (size_t i = 0; i < max; i++)
+        free(d.strings[i]);
+
+    free(d.keys);
+    free(d.hits);
+    free(d.zipf);
+    free(d.strings);
+
+    return 0;
+}
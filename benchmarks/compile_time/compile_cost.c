@@ -0,0 +1,333 @@
+/**
+ * compile_cost.c
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* What each collection costs to build. For every collection a unit that */
+/* only generates it is preprocessed and compiled, writing as CSV the lines */
+/* and bytes after preprocessing, the milliseconds that preprocessing and */
+/* compiling took and the bytes of code of the object file. */
+
+/* Then a program of a few units that all use the same collections is built */
+/* twice: with every unit generating them, as if each one had its own copy, */
+/* and with CMC_COLLECTION_INSTANTIATE, where only one unit defines them */
+/* and the others only declare them. */
+
+/* Usage: compile_cost [-c compiler] [-O flags] [-I include] [-u units] */
+/* Files are written to the current directory and removed at the end. */
+
+#include "utl/timer.h"
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define UNIT_FILE "cost_unit.c"
+#define UNIT_PREPROCESSED "cost_unit.i"
+#define UNIT_OBJECT "cost_unit.o"
+
+struct collection
+{
+    const char *name;
+    /* Key type, empty for collections without keys */
+    const char *key;
+};
+
+/* FROZEN_HASHMAP is left out since it needs a HASHMAP of the same name */
+/* and INTRUSIVE_LIST since its V must be a struct with a link. The key of */
+/* SMALLLIST is its amount of inline elements */
+static const struct collection collections[] = {
+    { "BIDIMAP", "size_t" },
+    { "BIDIMAP_POW2", "size_t" },
+    { "BIDIMAP_CACHED", "size_t" },
+    { "BITSET", "" },
+    { "BLOCKDEQUE", "" },
+    { "BLOCKING_QUEUE", "" },
+    { "BLOOMFILTER", "" },
+    { "BTREEMAP", "size_t" },
+    { "BTREESET", "" },
+    { "BYTERING", "" },
+    { "COMPACT_TREESET", "" },
+    { "CONCURRENT_HASHMAP", "size_t" },
+    { "CONCURRENT_STACK", "" },
+    { "COUNTMINSKETCH", "" },
+    { "CUCKOOMAP", "size_t" },
+    { "CUCKOOSET", "" },
+    { "DEQUE", "" },
+    { "FLATMAP", "size_t" },
+    { "GAPLIST", "" },
+    { "GROUPED_MULTIMAP", "size_t" },
+    { "HASHMAP", "size_t" },
+    { "HASHMAP_POW2", "size_t" },
+    { "HASHMAP_CACHED", "size_t" },
+    { "HASHMAP_INCREMENTAL", "size_t" },
+    { "HASHMAP_SMALL", "size_t" },
+    { "HASHSET", "" },
+    { "HASHSET_POW2", "" },
+    { "HASHSET_CACHED", "" },
+    { "HASHSET_SMALL", "" },
+    { "HEAP", "" },
+    { "HYPERLOGLOG", "" },
+    { "INDEXEDHEAP", "" },
+    { "INTERVALHEAP", "" },
+    { "INTERVALTREE", "size_t" },
+    { "LINKEDLIST", "" },
+    { "LIST", "" },
+    { "LRUCACHE", "size_t" },
+    { "MAPPED_HASHMAP", "size_t" },
+    { "MAPPED_SORTEDMAP", "size_t" },
+    { "MAPPED_SORTEDSET", "" },
+    { "MINMAXHEAP", "" },
+    { "MPMC_QUEUE", "" },
+    { "MULTIMAP", "size_t" },
+    { "MULTIMAP_CACHED", "size_t" },
+    { "MULTIQUEUE", "" },
+    { "MULTISET", "" },
+    { "MULTISET_POW2", "" },
+    { "MULTISET_CACHED", "" },
+    { "ORDEREDHASHMAP", "size_t" },
+    { "PERSISTENT_TREEMAP", "size_t" },
+    { "QUEUE", "" },
+    { "RADIXHEAP", "" },
+    { "RADIXTREEMAP", "" },
+    { "RINGBUFFER", "" },
+    { "ROARING", "" },
+    { "SKIPLISTMAP", "size_t" },
+    { "SMALLLIST", "8" },
+    { "SNAPSHOT_HASHMAP", "size_t" },
+    { "SPARSEMAP", "size_t" },
+    { "SPARSESET", "" },
+    { "SORTEDLIST", "" },
+    { "SORTED_MULTIMAP", "size_t" },
+    { "SORTEDWINDOW", "" },
+    { "STACK", "" },
+    { "SWISSMAP", "size_t" },
+    { "TIMERWHEEL", "" },
+    { "TOPK", "" },
+    { "TREEMAP", "size_t" },
+    { "TREESET", "" },
+    { "UNROLLEDLIST", "" },
+    { "WSDEQUE", "" },
+};
+
+#define COLLECTIONS (sizeof(collections) / sizeof(collections[0]))
+
+/* The collections used by every unit of the program */
+static const char *program[] = { "LIST", "DEQUE", "HASHMAP", "HASHSET", "TREEMAP", "SORTEDLIST" };
+
+#define PROGRAM (sizeof(program) / sizeof(program[0]))
+
+struct options
+{
+    const char *compiler;
+    const char *optimization;
+    const char *include;
+    size_t units;
+};
+
+/* Runs a command, returning the milliseconds that it took or -1 if it failed */
+static double run(const char *command)
+{
+    struct cmc_timer timer;
+
+    cmc_timer_start(timer);
+    int status = system(command);
+    cmc_timer_stop(timer);
+    cmc_timer_calc(timer);
+
+    return status == 0 ? timer.result : -1.0;
+}
+
+static const char *key_of(const char *name)
+{
+    for (size_t i = 0; i < COLLECTIONS; i++)
+    {
+        if (strcmp(collections[i].name, name) == 0)
+            return collections[i].key;
+    }
+
+    return "";
+}
+
+/* Writes a unit that includes the library and generates the given */
+/* collections with one of the macros of macro_collections.h */
+static bool write_unit(const char *path, const char *const *names, size_t count,
+                       const char *macro, bool instantiate)
+{
+    FILE *file = fopen(path, "w");
+
+    if (!file)
+        return false;
+
+    if (instantiate)
+        fprintf(file, "#define CMC_INSTANTIATE\n");
+
+    fprintf(file, "#include \"macro_collections.h\"\n");
+
+    for (size_t i = 0; i < count; i++)
+        fprintf(file, "%s(%s, c%" PRIu64 ", s%" PRIu64 ", %s, size_t)\n", macro, names[i],
+                (uint64_t)i, (uint64_t)i, key_of(names[i]));
+
+    return fclose(file) == 0;
+}
+
+/* Counts the lines and bytes of a file */
+static void measure_file(const char *path, uint64_t *lines, uint64_t *bytes)
+{
+    FILE *file = fopen(path, "r");
+    int c;
+
+    *lines = 0;
+    *bytes = 0;
+
+    if (!file)
+        return;
+
+    while ((c = fgetc(file)) != EOF)
+    {
+        (*bytes)++;
+
+        if (c == '\n')
+            (*lines)++;
+    }
+
+    fclose(file);
+}
+
+/* Bytes of code of an object file, as given by size(1) */
+static uint64_t text_size(const char *path)
+{
+    char command[256];
+    uint64_t text = 0;
+
+    snprintf(command, sizeof(command), "size %s", path);
+
+    FILE *output = popen(command, "r");
+
+    if (!output)
+        return 0;
+
+    char header[256];
+
+    if (fgets(header, sizeof(header), output) && fscanf(output, "%" SCNu64, &text) != 1)
+        text = 0;
+
+    pclose(output);
+
+    return text;
+}
+
+static void per_collection(struct options *options)
+{
+    char command[512];
+
+    printf("collection,preprocessed_lines,preprocessed_bytes,preprocess_ms,compile_ms,text_bytes\n");
+
+    /* The cost of the library itself, without any collection */
+    write_unit(UNIT_FILE, NULL, 0, "", false);
+
+    for (size_t i = 0; i <= COLLECTIONS; i++)
+    {
+        const char *name = i == 0 ? "(none)" : collections[i - 1].name;
+
+        if (i > 0)
+            write_unit(UNIT_FILE, &(collections[i - 1].name), 1, "CMC_COLLECTION_GENERATE",
+                       false);
+
+        snprintf(command, sizeof(command), "%s -std=c11 -D_DEFAULT_SOURCE -I %s -E %s -o %s",
+                 options->compiler, options->include, UNIT_FILE, UNIT_PREPROCESSED);
+
+        double preprocess = run(command);
+
+        snprintf(command, sizeof(command), "%s -std=c11 -D_DEFAULT_SOURCE %s -I %s -c %s -o %s",
+                 options->compiler, options->optimization, options->include, UNIT_FILE,
+                 UNIT_OBJECT);
+
+        double compile = run(command);
+
+        uint64_t lines, bytes;
+
+        measure_file(UNIT_PREPROCESSED, &lines, &bytes);
+
+        printf("%s,%" PRIu64 ",%" PRIu64 ",%.1f,%.1f,%" PRIu64 "\n", name, lines, bytes,
+               preprocess, compile, compile < 0 ? 0 : text_size(UNIT_OBJECT));
+        fflush(stdout);
+    }
+
+    remove(UNIT_FILE);
+    remove(UNIT_PREPROCESSED);
+    remove(UNIT_OBJECT);
+}
+
+/* Builds units of the program, with unit 0 being the one that instantiates */
+static void program_build(struct options *options, bool split)
+{
+    char path[64];
+    char command[512];
+    double total = 0;
+    uint64_t text = 0;
+
+    for (size_t u = 0; u < options->units; u++)
+    {
+        snprintf(path, sizeof(path), "cost_unit%" PRIu64 ".c", (uint64_t)u);
+
+        if (split)
+            write_unit(path, program, PROGRAM, "CMC_COLLECTION_INSTANTIATE", u == 0);
+        else
+            write_unit(path, program, PROGRAM, "CMC_COLLECTION_GENERATE", false);
+
+        snprintf(command, sizeof(command), "%s -std=c11 -D_DEFAULT_SOURCE %s -I %s -c %s -o %s",
+                 options->compiler, options->optimization, options->include, path, UNIT_OBJECT);
+
+        double compile = run(command);
+
+        if (compile < 0)
+        {
+            printf("%s: unit %" PRIu64 " failed to compile\n", split ? "split" : "generate",
+                   (uint64_t)u);
+            return;
+        }
+
+        total += compile;
+        text += text_size(UNIT_OBJECT);
+
+        remove(path);
+    }
+
+    remove(UNIT_OBJECT);
+
+    printf("%-8s units %" PRIu64 " compile %.1f ms text %" PRIu64 " bytes\n",
+           split ? "split" : "generate", (uint64_t)options->units, total, text);
+}
+
+int main(int argc, char **argv)
+{
+    struct options options = { "gcc", "-O2", "../../src", 8 };
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "-c") == 0)
+            options.compiler = argv[i + 1];
+        else if (strcmp(argv[i], "-O") == 0)
+            options.optimization = argv[i + 1];
+        else if (strcmp(argv[i], "-I") == 0)
+            options.include = argv[i + 1];
+        else if (strcmp(argv[i], "-u") == 0)
+            options.units = (size_t)strtoull(argv[i + 1], NULL, 10);
+    }
+
+    per_collection(&options);
+
+    printf("\n");
+
+    program_build(&options, false);
+    program_build(&options, true);
+
+    return 0;
+}
@@ -0,0 +1,165 @@
+/**
+ * counters.c
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* The same workload is run on a collection of src/dev, printing how many */
+/* comparisons, hashes, probes, rotations and copied bytes each operation */
+/* took, and on the collection of src/cmc that it mirrors, printing how long */
+/* each operation took. A change to the release collection that makes it */
+/* slower or faster should be explained by the algorithmic counts. */
+
+/* Usage: counters [-n elements] */
+
+#include "dev/deque.h"
+#include "dev/hashmap.h"
+#include "dev/list.h"
+#include "dev/treemap.h"
+#include "cmc/deque.h"
+#include "cmc/hashmap.h"
+#include "cmc/list.h"
+#include "cmc/treemap.h"
+#include "utl/hash.h"
+#include "utl/timer.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ELEMENTS 200000
+
+static int intcmp(size_t a, size_t b)
+{
+    return (a > b) - (a < b);
+}
+
+/* Keys in an order that is neither sorted nor sequential */
+static size_t key(size_t i, size_t n)
+{
+    return (i * 2654435761u) % (n * 4 + 1);
+}
+
+LIST_GENERATE(dl, dev_list, , size_t)
+DEQUE_GENERATE(dd, dev_deque, , size_t)
+HASHMAP_GENERATE(dhm, dev_hashmap, , size_t, size_t)
+TREEMAP_GENERATE(dtm, dev_treemap, , size_t, size_t)
+
+CMC_GENERATE_LIST(l, list, size_t)
+CMC_GENERATE_DEQUE(d, deque, size_t)
+CMC_GENERATE_HASHMAP(hm, hashmap, size_t, size_t)
+CMC_GENERATE_TREEMAP(tm, treemap, size_t, size_t)
+
+/* Pushes n elements then looks for every 16th of them */
+#define LIST_WORKLOAD(PFX, NEW, PUSH, CONTAINS)           \
+    do                                                    \
+    {                                                     \
+        PFX = NEW;                                        \
+        for (size_t i = 0; i < n; i++)                    \
+            PUSH;                                         \
+        for (size_t i = 0; i < n; i += 16)                \
+            sum += CONTAINS;                              \
+    } while (0)
+
+/* Inserts n keys, gets every one of them and removes half */
+#define MAP_WORKLOAD(PFX, NEW, INSERT, GET, REMOVE)       \
+    do                                                    \
+    {                                                     \
+        PFX = NEW;                                        \
+        for (size_t i = 0; i < n; i++)                    \
+            INSERT;                                       \
+        for (size_t i = 0; i < n; i++)                    \
+            sum += GET;                                   \
+        for (size_t i = 0; i < n; i += 2)                 \
+            REMOVE;                                       \
+    } while (0)
+
+static void report(const char *name, struct cmc_dev_counters counters, struct cmc_timer timer,
+                   uint64_t operations)
+{
+    printf("%-8s %8.2f ns/op ", name, (double)timer.elapsed / (double)operations);
+    cmc_dev_counters_print(stdout, counters, operations);
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = ELEMENTS;
+    size_t sum = 0;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "-n") == 0)
+            n = (size_t)strtoull(argv[i + 1], NULL, 10);
+    }
+
+    /* The dev collections log every operation */
+    cmc_log_config.enabled = false;
+
+    struct cmc_timer timer;
+
+    dev_list *dev_l;
+    struct list *rel_l;
+    uint64_t list_ops = n + n / 16;
+
+    LIST_WORKLOAD(dev_l, dl_new(16), dl_push_back(dev_l, key(i, n)),
+                  dl_contains(dev_l, key(i, n), intcmp));
+    cmc_timer_start(timer);
+    LIST_WORKLOAD(rel_l, l_new(16), l_push_back(rel_l, key(i, n)), l_contains(rel_l, key(i, n), intcmp));
+    cmc_timer_stop(timer);
+    cmc_timer_calc(timer);
+    report("list", dl_counters(dev_l), timer, list_ops);
+    dl_free(dev_l);
+    l_free(rel_l, NULL);
+
+    dev_deque *dev_d;
+    struct deque *rel_d;
+
+    LIST_WORKLOAD(dev_d, dd_new(16), dd_push_front(dev_d, key(i, n)),
+                  dd_contains(dev_d, key(i, n), intcmp));
+    cmc_timer_start(timer);
+    LIST_WORKLOAD(rel_d, d_new(16), d_push_front(rel_d, key(i, n)),
+                  d_contains(rel_d, key(i, n), intcmp));
+    cmc_timer_stop(timer);
+    cmc_timer_calc(timer);
+    report("deque", dd_counters(dev_d), timer, list_ops);
+    dd_free(dev_d);
+    d_free(rel_d, NULL);
+
+    dev_hashmap *dev_hm;
+    struct hashmap *rel_hm;
+    uint64_t map_ops = n * 2 + (n + 1) / 2;
+
+    MAP_WORKLOAD(dev_hm, dhm_new(16, 0.7, intcmp, cmc_hash_size),
+                 dhm_insert(dev_hm, key(i, n), i), dhm_get(dev_hm, key(i, n)),
+                 dhm_remove(dev_hm, key(i, n), NULL));
+    cmc_timer_start(timer);
+    MAP_WORKLOAD(rel_hm, hm_new(16, 0.7, intcmp, cmc_hash_size), hm_insert(rel_hm, key(i, n), i),
+                 hm_get(rel_hm, key(i, n)), hm_remove(rel_hm, key(i, n), NULL));
+    cmc_timer_stop(timer);
+    cmc_timer_calc(timer);
+    report("hashmap", dhm_counters(dev_hm), timer, map_ops);
+    dhm_free(dev_hm);
+    hm_free(rel_hm, NULL);
+
+    dev_treemap *dev_tm;
+    struct treemap *rel_tm;
+
+    MAP_WORKLOAD(dev_tm, dtm_new(intcmp), dtm_insert(dev_tm, key(i, n), i),
+                 dtm_get(dev_tm, key(i, n)), dtm_remove(dev_tm, key(i, n), NULL));
+    cmc_timer_start(timer);
+    MAP_WORKLOAD(rel_tm, tm_new(intcmp), tm_insert(rel_tm, key(i, n), i),
+                 tm_get(rel_tm, key(i, n)), tm_remove(rel_tm, key(i, n), NULL));
+    cmc_timer_stop(timer);
+    cmc_timer_calc(timer);
+    report("treemap", dtm_counters(dev_tm), timer, map_ops);
+    dtm_free(dev_tm);
+    tm_free(rel_tm, NULL);
+
+    printf("SUM: %" PRIuMAX "\n", (uintmax_t)sum);
+
+    return 0;
+}
@@ -0,0 +1,80 @@
+/**
+ * deque.c
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Showing off how different deque implementations affect runtime cost */
+
+#include "utl/timer.h"
+#include <stdio.h>
+#include <inttypes.h>
+
+#define MAX 200000
+
+#if defined(CMC_DEQUE)
+#include "cmc/deque.h"
+CMC_GENERATE_DEQUE(d, deque, int)
+#define TARGET "DEQUE"
+#elif defined(SAC_DEQUE)
+#include "sac/deque.h"
+SAC_DEQUE_GENERATE(d, deque, , int, MAX)
+#define TARGET "SAC DEQUE"
+#else
+#error Please define either CMC_DEQUE or SAC_DEQUE
+#endif
+
+int main(void)
+{
+
+#if defined(CMC_DEQUE)
+    struct deque *d = d_new(MAX);
+#elif defined(SAC_DEQUE)
+    static deque _d;
+    _d = d_new();
+    deque_ptr d = &_d;
+#endif
+
+    size_t sum = 0;
+    int i = 0;
+
+    struct cmc_timer timer;
+    cmc_timer_start(timer);
+
+    while (d_count(d) != MAX)
+    {
+        if (i % 2 == 0)
+            d_push_back(d, i++);
+        else
+            d_push_front(d, i++);
+
+        if (i % 10 == 0)
+        {
+            for (size_t j = 0; j < 4; j++)
+            {
+                sum += d_front(d) + d_back(d);
+                d_pop_front(d);
+                d_pop_back(d);
+            }
+        }
+    }
+
+    cmc_timer_stop(timer);
+    cmc_timer_calc(timer);
+
+    printf("----------------------------------------\n");
+    printf("%s\n", TARGET);
+    printf("Execution time: %.0lf milliseconds\n", timer.result);
+    printf("SUM: %" PRIuMAX "\n", sum);
+    printf("----------------------------------------\n");
+
+#if defined(CMC_DEQUE)
+    d_free(d, NULL);
+#endif
+
+    return 0;
+}
@@ -0,0 +1,199 @@
+/**
+ * hash.c
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Compares the hash functions of utl/hash.h to the ad-hoc ones used by the */
+/* examples, by the time it takes to fill and search a HashMap and by the */
+/* distribution of the distances of its entries to their original slot */
+
+#include "cmc/hashmap.h"
+#include "utl/hash.h"
+#include "utl/timer.h"
+#include <inttypes.h>
+#include <stdio.h>
+
+#define TOTAL 1000000
+#define LOAD 0.9
+
+static int intcmp(size_t a, size_t b)
+{
+    return (a > b) - (a < b);
+}
+
+static int strcmp_(char *a, char *b)
+{
+    return strcmp(a, b);
+}
+
+/* The mixer used by benchmarks/benchmark.c */
+static size_t adhoc(size_t a)
+{
+    a += ~(a << 15);
+    a ^= (a >> 10);
+    a += (a << 3);
+    a ^= (a >> 6);
+    a += ~(a << 11);
+    a ^= (a >> 16);
+    return a;
+}
+
+static size_t identity(size_t a)
+{
+    return a;
+}
+
+static size_t crc32c(size_t a)
+{
+    return cmc_hash_crc32c(&a, sizeof(a));
+}
+
+static size_t wyhash(size_t a)
+{
+    return cmc_hash_bytes(&a, sizeof(a));
+}
+
+/* The string hash used by examples/others/word_counter */
+static size_t djb2(char *str)
+{
+    size_t hash = 5381;
+    int c;
+
+    while ((c = *str++))
+        hash = ((hash << 5) + hash) + c;
+
+    return hash;
+}
+
+static size_t crc32c_str(char *str)
+{
+    return cmc_hash_crc32c(str, strlen(str));
+}
+
+CMC_GENERATE_HASHMAP(hm, hashmap, size_t, size_t)
+CMC_GENERATE_HASHMAP(hms, hashmap_str, char *, size_t)
+
+static void report(const char *name, struct cmc_timer *timer, struct cmc_hashtable_stats *stats)
+{
+    printf("%-12s %9.0lf ms  mean %6.3lf  max %4" PRIuMAX "  |", name, timer->result,
+           stats->mean_dist, (uintmax_t)stats->max_dist);
+
+    for (size_t i = 0; i < 8; i++)
+        printf(" %5.2lf", 100.0 * (double)stats->histogram[i] / (double)stats->count);
+
+    printf("\n");
+}
+
+static void bench_int(const char *name, size_t (*hash)(size_t), size_t *keys)
+{
+    struct cmc_timer timer;
+    struct cmc_hashtable_stats stats;
+    struct hashmap *map = hm_new(TOTAL, LOAD, intcmp, hash);
+
+    cmc_timer_start(timer);
+
+    for (size_t i = 0; i < TOTAL; i++)
+        hm_insert(map, keys[i], i);
+
+    for (size_t i = 0; i < TOTAL; i++)
+        hm_contains(map, keys[i]);
+
+    cmc_timer_stop(timer);
+    cmc_timer_calc(timer);
+
+    hm_stats(map, &stats);
+    report(name, &timer, &stats);
+
+    hm_free(map, NULL);
+}
+
+static void bench_str(const char *name, size_t (*hash)(char *), char **keys)
+{
+    struct cmc_timer timer;
+    struct cmc_hashtable_stats stats;
+    struct hashmap_str *map = hms_new(TOTAL, LOAD, strcmp_, hash);
+
+    cmc_timer_start(timer);
+
+    for (size_t i = 0; i < TOTAL; i++)
+        hms_insert(map, keys[i], i);
+
+    for (size_t i = 0; i < TOTAL; i++)
+        hms_contains(map, keys[i]);
+
+    cmc_timer_stop(timer);
+    cmc_timer_calc(timer);
+
+    hms_stats(map, &stats);
+    report(name, &timer, &stats);
+
+    hms_free(map, NULL);
+}
+
+static void bench_ints(const char *title, size_t *keys)
+{
+    printf("\n%s\n", title);
+    printf("%-12s %12s  %11s  %8s  | %% of the entries at distance 0 to 7\n", "hash", "time",
+           "dist", "");
+
+    bench_int("adhoc", adhoc, keys);
+    bench_int("identity", identity, keys);
+    bench_int("u64", cmc_hash_size, keys);
+    bench_int("wyhash", wyhash, keys);
+    bench_int("crc32c", crc32c, keys);
+}
+
+int main(void)
+{
+    size_t *keys = malloc(sizeof(size_t) * TOTAL);
+    char **strings = malloc(sizeof(char *) * TOTAL);
+
+    if (!keys || !strings)
+        return 1;
+
+#if defined(CMC_HASH_CRC32C_SSE42) || defined(CMC_HASH_CRC32C_ARM)
+    printf("CRC32C with hardware instructions\n");
+#else
+    printf("CRC32C without hardware instructions\n");
+#endif
+
+    for (size_t i = 0; i < TOTAL; i++)
+        keys[i] = i;
+
+    bench_ints("Sequential keys", keys);
+
+    /* Like the addresses of aligned objects */
+    for (size_t i = 0; i < TOTAL; i++)
+        keys[i] = i << 12;
+
+    bench_ints("Keys with the lower 12 bits clear", keys);
+
+    for (size_t i = 0; i < TOTAL; i++)
+    {
+        strings[i] = malloc(24);
+
+        if (!strings[i])
+            return 1;
+
+        snprintf(strings[i], 24, "key_%" PRIuMAX, (uintmax_t)i);
+    }
+
+    printf("\nString keys\n");
+
+    bench_str("djb2", djb2, strings);
+    bench_str("wyhash", cmc_hash_str, strings);
+    bench_str("crc32c", crc32c_str, strings);
+
+    for (size_t i = 0; i < TOTAL; i++)
+        free(strings[i]);
+
+    free(strings);
+    free(keys);
+
+    return 0;
+}
@@ -0,0 +1,264 @@
+/**
+ * sweep.c
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Sweeps the load factor given to the HashMap, HashSet and MultiSet from */
+/* 0.50 to 0.95 with each hash function of utl/hash.h, and the identity as */
+/* a baseline, over sequential, random, pointer and string keys. Every run */
+/* starts from an empty table, so growing is part of the inserts, and is */
+/* written as a CSV row with the throughput of inserts, of lookups of keys */
+/* that are there (hits) and of keys that are not (misses), the mean and */
+/* max distance of the entries to their original slot, as given by the */
+/* stats function of each collection, and the bytes that it holds. */
+
+/* Usage: sweep [-n keys] */
+
+#include "cmc/hashmap.h"
+#include "cmc/hashset.h"
+#include "cmc/multiset.h"
+#include "utl/hash.h"
+#include "utl/timer.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define KEYS 200000
+#define MIN_LOAD 0.50
+#define MAX_LOAD 0.95
+#define LOAD_STEP 0.05
+
+static int intcmp(size_t a, size_t b)
+{
+    return (a > b) - (a < b);
+}
+
+static int strcmp_(char *a, char *b)
+{
+    return strcmp(a, b);
+}
+
+static size_t identity(size_t a)
+{
+    return a;
+}
+
+static size_t wyhash(size_t a)
+{
+    return cmc_hash_bytes(&a, sizeof(a));
+}
+
+static size_t crc32c(size_t a)
+{
+    return cmc_hash_crc32c(&a, sizeof(a));
+}
+
+static size_t crc32c_str(char *str)
+{
+    return cmc_hash_crc32c(str, strlen(str));
+}
+
+struct int_hash
+{
+    const char *name;
+    size_t (*hash)(size_t);
+};
+
+struct str_hash
+{
+    const char *name;
+    size_t (*hash)(char *);
+};
+
+static const struct int_hash int_hashes[] = {
+    { "identity", identity },
+    { "u64", cmc_hash_size },
+    { "wyhash", wyhash },
+    { "crc32c", crc32c },
+};
+
+static const struct str_hash str_hashes[] = {
+    { "wyhash", cmc_hash_str },
+    { "crc32c", crc32c_str },
+};
+
+/* Keeps the results of lookups from being optimized away */
+static volatile size_t sink;
+
+static uint64_t splitmix64(uint64_t *state)
+{
+    uint64_t z = (*state += UINT64_C(0x9E3779B97F4A7C15));
+    z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+    z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+    return z ^ (z >> 31);
+}
+
+/* Millions of operations per second */
+static double mops(size_t count, struct cmc_timer *timer)
+{
+    return timer->elapsed ? (double)count * 1e3 / (double)timer->elapsed : 0.0;
+}
+
+/* keys holds count keys that are inserted and missing count that are not */
+#define SWEEP(NAME, PFX, SNAME, K, CMP, INSERT)                                                     \
+    static void NAME##_run(const char *collection, const char *distribution, const char *hash_name, \
+                           size_t (*hash)(K), K *keys, K *missing, size_t count, double load)       \
+    {                                                                                               \
+        struct cmc_timer insert, hit, miss;                                                         \
+        struct cmc_hashtable_stats stats;                                                           \
+        struct SNAME *table = PFX##_new(16, load, CMP, hash);                                       \
+                                                                                                    \
+        if (!table)                                                                                 \
+            exit(1);                                                                                \
+                                                                                                    \
+        cmc_timer_start(insert);                                                                    \
+        for (size_t i = 0; i < count; i++)                                                          \
+            INSERT(PFX, table, keys[i]);                                                            \
+        cmc_timer_stop(insert);                                                                     \
+        cmc_timer_calc(insert);                                                                     \
+                                                                                                    \
+        cmc_timer_start(hit);                                                                       \
+        for (size_t i = 0; i < count; i++)                                                          \
+            sink += PFX##_contains(table, keys[i]);                                                 \
+        cmc_timer_stop(hit);                                                                        \
+        cmc_timer_calc(hit);                                                                        \
+                                                                                                    \
+        cmc_timer_start(miss);                                                                      \
+        for (size_t i = 0; i < count; i++)                                                          \
+            sink += PFX##_contains(table, missing[i]);                                              \
+        cmc_timer_stop(miss);                                                                       \
+        cmc_timer_calc(miss);                                                                       \
+                                                                                                    \
+        PFX##_stats(table, &stats);                                                                 \
+                                                                                                    \
+        printf("%s,%s,%s,%.2f,%" PRIu64 ",%.2f,%.2f,%.2f,%.3f,%" PRIu64 ",%" PRIu64 ",%.1f\n",      \
+               collection, distribution, hash_name, load, (uint64_t)count, mops(count, &insert),    \
+               mops(count, &hit), mops(count, &miss), stats.mean_dist,                              \
+               (uint64_t)stats.max_dist, (uint64_t)stats.bytes,                                     \
+               (double)stats.bytes / (double)count);                                                \
+        fflush(stdout);                                                                             \
+                                                                                                    \
+        PFX##_free(table, NULL);                                                                    \
+    }
+
+#define MAP_INSERT(PFX, table, key) PFX##_insert(table, key, 0)
+#define SET_INSERT(PFX, table, key) PFX##_insert(table, key)
+
+CMC_GENERATE_HASHMAP(hm, hashmap, size_t, size_t)
+CMC_GENERATE_HASHSET(hs, hashset, size_t)
+CMC_GENERATE_MULTISET(ms, multiset, size_t)
+CMC_GENERATE_HASHMAP(hms, hashmap_str, char *, size_t)
+CMC_GENERATE_HASHSET(hss, hashset_str, char *)
+CMC_GENERATE_MULTISET(mss, multiset_str, char *)
+
+SWEEP(hashmap, hm, hashmap, size_t, intcmp, MAP_INSERT)
+SWEEP(hashset, hs, hashset, size_t, intcmp, SET_INSERT)
+SWEEP(multiset, ms, multiset, size_t, intcmp, SET_INSERT)
+SWEEP(hashmap_str, hms, hashmap_str, char *, strcmp_, MAP_INSERT)
+SWEEP(hashset_str, hss, hashset_str, char *, strcmp_, SET_INSERT)
+SWEEP(multiset_str, mss, multiset_str, char *, strcmp_, SET_INSERT)
+
+static void sweep_ints(const char *distribution, size_t *keys, size_t count)
+{
+    for (size_t h = 0; h < sizeof(int_hashes) / sizeof(int_hashes[0]); h++)
+    {
+        for (double load = MIN_LOAD; load < MAX_LOAD + LOAD_STEP / 2; load += LOAD_STEP)
+        {
+            const char *name = int_hashes[h].name;
+            size_t (*hash)(size_t) = int_hashes[h].hash;
+
+            hashmap_run("hashmap", distribution, name, hash, keys, keys + count, count, load);
+            hashset_run("hashset", distribution, name, hash, keys, keys + count, count, load);
+            multiset_run("multiset", distribution, name, hash, keys, keys + count, count, load);
+        }
+    }
+}
+
+static void sweep_strings(char **keys, size_t count)
+{
+    for (size_t h = 0; h < sizeof(str_hashes) / sizeof(str_hashes[0]); h++)
+    {
+        for (double load = MIN_LOAD; load < MAX_LOAD + LOAD_STEP / 2; load += LOAD_STEP)
+        {
+            const char *name = str_hashes[h].name;
+            size_t (*hash)(char *) = str_hashes[h].hash;
+
+            hashmap_str_run("hashmap", "string", name, hash, keys, keys + count, count, load);
+            hashset_str_run("hashset", "string", name, hash, keys, keys + count, count, load);
+            multiset_str_run("multiset", "string", name, hash, keys, keys + count, count, load);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t count = KEYS;
+    uint64_t state = 42;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "-n") == 0)
+            count = (size_t)strtoull(argv[i + 1], NULL, 10);
+    }
+
+    /* The keys that are inserted are followed by the ones that are not */
+    size_t *keys = malloc(sizeof(size_t) * count * 2);
+    char **strings = malloc(sizeof(char *) * count * 2);
+    void **objects = malloc(sizeof(void *) * count * 2);
+
+    if (!keys || !strings || !objects)
+        return 1;
+
+    printf("collection,keys,hash,load,elements,insert_mops,hit_mops,miss_mops,mean_dist,max_dist,"
+           "bytes,bytes_per_element\n");
+
+    for (size_t i = 0; i < count * 2; i++)
+        keys[i] = i;
+
+    sweep_ints("sequential", keys, count);
+
+    /* Unique keys, since the generator is a bijection of its state */
+    for (size_t i = 0; i < count * 2; i++)
+        keys[i] = (size_t)splitmix64(&state);
+
+    sweep_ints("random", keys, count);
+
+    /* Addresses of small objects, aligned and mostly next to each other */
+    for (size_t i = 0; i < count * 2; i++)
+    {
+        if (!(objects[i] = malloc(32)))
+            return 1;
+
+        keys[i] = (size_t)objects[i];
+    }
+
+    sweep_ints("pointer", keys, count);
+
+    for (size_t i = 0; i < count * 2; i++)
+    {
+        if (!(strings[i] = malloc(24)))
+            return 1;
+
+        snprintf(strings[i], 24, "key_%" PRIuMAX, (uintmax_t)i);
+    }
+
+    sweep_strings(strings, count);
+
+    for (size_t i = 0; i < count * 2; i++)
+    {
+        free(objects[i]);
+        free(strings[i]);
+    }
+
+    free(objects);
+    free(strings);
+    free(keys);
+
+    return 0;
+}
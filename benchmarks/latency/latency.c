@@ -0,0 +1,294 @@
+/**
+ * latency.c
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Latency of every single insert, lookup and remove of the HashMap */
+/* variants, recorded into histograms to compare their tails instead of */
+/* their totals. Every variant is run for each amount of keys and load */
+/* factor, starting from an empty table so growing is part of the inserts, */
+/* first for a few warmup runs that are not recorded and then for the */
+/* repetitions that are recorded together. Lookups are split into hits, of */
+/* keys that were inserted, and misses, of keys that were not. */
+
+/* Usage: latency [-f json|csv] [-r repetitions] [-w warmups] [-n max keys] */
+
+#include "cmc/hashmap.h"
+#include "cmc/swissmap.h"
+#include "utl/hash.h"
+#include "utl/timer.h"
+#include "../util/histogram.c"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MIN_KEYS 1000
+#define MAX_KEYS 1000000
+
+static const double loads[] = { 0.5, 0.7, 0.9 };
+static const char *operations[] = { "insert", "hit", "miss", "remove" };
+
+#define LOADS (sizeof(loads) / sizeof(loads[0]))
+#define OPERATIONS (sizeof(operations) / sizeof(operations[0]))
+
+static int intcmp(size_t a, size_t b)
+{
+    return (a > b) - (a < b);
+}
+
+#define INTCMP(a, b) (((a) > (b)) - ((a) < (b)))
+
+struct config
+{
+    bool json;
+    size_t repetitions;
+    size_t warmups;
+    size_t max_keys;
+};
+
+/* Keeps the results of lookups from being optimized away */
+static volatile size_t sink;
+
+/* Time that it takes to read the clock twice, taken out of every sample */
+static uint64_t overhead;
+
+static uint64_t splitmix64(uint64_t *state)
+{
+    uint64_t z = (*state += UINT64_C(0x9E3779B97F4A7C15));
+    z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+    z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+    return z ^ (z >> 31);
+}
+
+static void shuffle(size_t *keys, size_t count, uint64_t *state)
+{
+    for (size_t i = count; i > 1; i--)
+    {
+        size_t j = (size_t)(splitmix64(state) % i);
+        size_t tmp = keys[i - 1];
+        keys[i - 1] = keys[j];
+        keys[j] = tmp;
+    }
+}
+
+static void calibrate(void)
+{
+    histogram h;
+
+    hist_init(&h);
+
+    for (size_t i = 0; i < 100000; i++)
+    {
+        uint64_t start = cmc_timer_now();
+        hist_record(&h, cmc_timer_now() - start);
+    }
+
+    overhead = h.min;
+}
+
+static void record(histogram *h, uint64_t start, uint64_t stop)
+{
+    uint64_t elapsed = stop - start;
+
+    hist_record(h, elapsed > overhead ? elapsed - overhead : 0);
+}
+
+#define TIMED(h, op)                          \
+    do                                        \
+    {                                         \
+        uint64_t start_ = cmc_timer_now();    \
+        op;                                   \
+        record((h), start_, cmc_timer_now()); \
+    } while (0)
+
+/* keys holds count keys to be inserted followed by count that are not */
+#define LATENCY(NAME, PFX, SNAME)                                                          \
+    static void NAME##_run(struct config *config, size_t *keys, size_t count, double load, \
+                           histogram *hists)                                               \
+    {                                                                                      \
+        uint64_t state = count;                                                            \
+        size_t *missing = keys + count;                                                    \
+                                                                                           \
+        for (size_t op = 0; op < OPERATIONS; op++)                                         \
+            hist_init(&hists[op]);                                                         \
+                                                                                           \
+        for (size_t run = 0; run < config->warmups + config->repetitions; run++)           \
+        {                                                                                  \
+            histogram *h = run < config->warmups ? NULL : hists;                           \
+            struct SNAME *map = PFX##_new(16, load, intcmp, cmc_hash_size);                \
+            size_t value;                                                                  \
+                                                                                           \
+            if (!map)                                                                      \
+                exit(1);                                                                   \
+                                                                                           \
+            shuffle(keys, count, &state);                                                  \
+                                                                                           \
+            for (size_t i = 0; i < count; i++)                                             \
+            {                                                                              \
+                if (h)                                                                     \
+                    TIMED(&h[0], PFX##_insert(map, keys[i], i));                           \
+                else                                                                       \
+                    PFX##_insert(map, keys[i], i);                                         \
+            }                                                                              \
+                                                                                           \
+            shuffle(keys, count, &state);                                                  \
+                                                                                           \
+            for (size_t i = 0; i < count; i++)                                             \
+            {                                                                              \
+                if (h)                                                                     \
+                    TIMED(&h[1], sink += PFX##_get(map, keys[i]));                         \
+                else                                                                       \
+                    sink += PFX##_get(map, keys[i]);                                       \
+            }                                                                              \
+                                                                                           \
+            for (size_t i = 0; i < count; i++)                                             \
+            {                                                                              \
+                if (h)                                                                     \
+                    TIMED(&h[2], sink += PFX##_contains(map, missing[i]));                 \
+                else                                                                       \
+                    sink += PFX##_contains(map, missing[i]);                               \
+            }                                                                              \
+                                                                                           \
+            shuffle(keys, count, &state);                                                  \
+                                                                                           \
+            for (size_t i = 0; i < count; i++)                                             \
+            {                                                                              \
+                if (h)                                                                     \
+                    TIMED(&h[3], PFX##_remove(map, keys[i], &value));                      \
+                else                                                                       \
+                    PFX##_remove(map, keys[i], &value);                                    \
+            }                                                                              \
+                                                                                           \
+            PFX##_free(map, NULL);                                                         \
+        }                                                                                  \
+    }
+
+#define GENERATE(NAME, PFX, SNAME, GENERATOR) \
+    GENERATOR(PFX, SNAME, size_t, size_t)     \
+    LATENCY(NAME, PFX, SNAME)
+
+#define HASHMAP_EX(PFX, SNAME, K, V) CMC_GENERATE_HASHMAP_EX(PFX, SNAME, K, V, INTCMP, cmc_hash_size)
+#define SWISSMAP_EX(PFX, SNAME, K, V) CMC_GENERATE_SWISSMAP_EX(PFX, SNAME, K, V, INTCMP, cmc_hash_size)
+
+GENERATE(hashmap, hm, hashmap, CMC_GENERATE_HASHMAP)
+GENERATE(hashmap_pow2, hmp, hashmap_pow2, CMC_GENERATE_HASHMAP_POW2)
+GENERATE(hashmap_cached, hmc, hashmap_cached, CMC_GENERATE_HASHMAP_CACHED)
+GENERATE(hashmap_incremental, hmi, hashmap_incremental, CMC_GENERATE_HASHMAP_INCREMENTAL)
+GENERATE(hashmap_ex, hmx, hashmap_ex, HASHMAP_EX)
+GENERATE(swissmap, sm, swissmap, CMC_GENERATE_SWISSMAP)
+GENERATE(swissmap_ex, smx, swissmap_ex, SWISSMAP_EX)
+
+struct variant
+{
+    const char *name;
+    void (*run)(struct config *, size_t *, size_t, double, histogram *);
+};
+
+static const struct variant variants[] = {
+    { "hashmap", hashmap_run },
+    { "hashmap_pow2", hashmap_pow2_run },
+    { "hashmap_cached", hashmap_cached_run },
+    { "hashmap_incremental", hashmap_incremental_run },
+    { "hashmap_ex", hashmap_ex_run },
+    { "swissmap", swissmap_run },
+    { "swissmap_ex", swissmap_ex_run },
+};
+
+static void report(struct config *config, bool *first, const char *name, size_t count,
+                   double load, histogram *hists)
+{
+    for (size_t op = 0; op < OPERATIONS; op++)
+    {
+        histogram *h = &hists[op];
+        const char *format;
+
+        if (config->json)
+        {
+            format = "%s\n  { \"collection\": \"%s\", \"operation\": \"%s\", \"keys\": %" PRIu64
+                     ", \"load\": %.2f, \"samples\": %" PRIu64 ", \"mean_ns\": %.1f, \"p50_ns\": %" PRIu64
+                     ", \"p99_ns\": %" PRIu64 ", \"p999_ns\": %" PRIu64 ", \"max_ns\": %" PRIu64 " }";
+            printf(format, *first ? "" : ",", name, operations[op], (uint64_t)count, load, h->total,
+                   hist_mean(h), hist_quantile(h, 0.5), hist_quantile(h, 0.99),
+                   hist_quantile(h, 0.999), h->max);
+        }
+        else
+        {
+            format = "%s,%s,%" PRIu64 ",%.2f,%" PRIu64 ",%.1f,%" PRIu64 ",%" PRIu64 ",%" PRIu64
+                     ",%" PRIu64 "\n";
+            printf(format, name, operations[op], (uint64_t)count, load, h->total, hist_mean(h),
+                   hist_quantile(h, 0.5), hist_quantile(h, 0.99), hist_quantile(h, 0.999), h->max);
+        }
+
+        *first = false;
+    }
+
+    fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+    struct config config = { false, 5, 1, MAX_KEYS };
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "-f") == 0)
+            config.json = strcmp(argv[i + 1], "json") == 0;
+        else if (strcmp(argv[i], "-r") == 0)
+            config.repetitions = (size_t)strtoull(argv[i + 1], NULL, 10);
+        else if (strcmp(argv[i], "-w") == 0)
+            config.warmups = (size_t)strtoull(argv[i + 1], NULL, 10);
+        else if (strcmp(argv[i], "-n") == 0)
+            config.max_keys = (size_t)strtoull(argv[i + 1], NULL, 10);
+    }
+
+    size_t *keys = malloc(sizeof(size_t) * config.max_keys * 2);
+    size_t *work = malloc(sizeof(size_t) * config.max_keys * 2);
+    histogram *hists = malloc(sizeof(histogram) * OPERATIONS);
+    uint64_t state = 42;
+    bool first = true;
+
+    if (!keys || !work || !hists)
+        return 1;
+
+    /* Unique keys, since the generator is a bijection of its state */
+    for (size_t i = 0; i < config.max_keys * 2; i++)
+        keys[i] = (size_t)splitmix64(&state);
+
+    calibrate();
+
+    if (config.json)
+        printf("{ \"overhead_ns\": %" PRIu64 ", \"results\": [", overhead);
+    else
+        printf("collection,operation,keys,load,samples,mean_ns,p50_ns,p99_ns,p999_ns,max_ns\n");
+
+    for (size_t count = MIN_KEYS; count <= config.max_keys; count *= 10)
+    {
+        /* The keys that are not inserted come right after the ones that are */
+        memcpy(work, keys, sizeof(size_t) * count);
+        memcpy(work + count, keys + config.max_keys, sizeof(size_t) * count);
+
+        for (size_t l = 0; l < LOADS; l++)
+        {
+            for (size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); v++)
+            {
+                variants[v].run(&config, work, count, loads[l], hists);
+                report(&config, &first, variants[v].name, count, loads[l], hists);
+            }
+        }
+    }
+
+    if (config.json)
+        printf("\n] }\n");
+
+    free(keys);
+    free(work);
+    free(hists);
+
+    return 0;
+}
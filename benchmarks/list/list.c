@@ -0,0 +1,81 @@
+/**
+ * list.c
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Showing off how different list implementations affect runtime cost */
+
+#include "utl/timer.h"
+#include <stdio.h>
+#include <inttypes.h>
+
+#define MAX 20000
+
+#if defined(CMC_LIST)
+#include "cmc/list.h"
+CMC_GENERATE_LIST(l, list, int)
+#define TARGET "LIST"
+#elif defined(SAC_LIST)
+#include "sac/list.h"
+SAC_LIST_GENERATE(l, list, , int, MAX)
+#define TARGET "SAC LIST"
+#else
+#error Please define either CMC_LIST or SAC_LIST
+#endif
+
+int main(void)
+{
+
+#if defined(CMC_LIST)
+    struct list *l = l_new(MAX);
+#elif defined(SAC_LIST)
+    static list _l;
+    _l = l_new();
+    list_ptr l = &_l;
+#endif
+
+    size_t sum = 0;
+    int i = 0;
+
+    struct cmc_timer timer;
+    cmc_timer_start(timer);
+
+    while (l_count(l) != MAX)
+    {
+        l_push_back(l, i++);
+
+        if (i % 10 == 0)
+        {
+            /* Shifts the elements after the middle one */
+            size_t middle = l_count(l) / 2;
+
+            l_push_at(l, i, middle);
+
+            for (size_t j = 0; j < l_count(l); j += 64)
+                sum += l_get(l, j);
+
+            l_pop_at(l, middle);
+            l_pop_front(l);
+        }
+    }
+
+    cmc_timer_stop(timer);
+    cmc_timer_calc(timer);
+
+    printf("----------------------------------------\n");
+    printf("%s\n", TARGET);
+    printf("Execution time: %.0lf milliseconds\n", timer.result);
+    printf("SUM: %" PRIuMAX "\n", sum);
+    printf("----------------------------------------\n");
+
+#if defined(CMC_LIST)
+    l_free(l, NULL);
+#endif
+
+    return 0;
+}
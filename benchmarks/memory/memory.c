@@ -0,0 +1,192 @@
+/**
+ * memory.c
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Bytes per element of every collection after inserting n elements, as */
+/* given by its memory_usage and as counted by cmc_alloc_node_tracked, */
+/* and the peak that the tracker saw while they were inserted. Both should */
+/* be the same, the peak shows what growing the collection costs on top of */
+/* that. The overhead column is what is held beyond the elements themselves. */
+
+/* Usage: memory [-n max elements] */
+
+#include "cmc/blockdeque.h"
+#include "cmc/btreemap.h"
+#include "cmc/deque.h"
+#include "cmc/hashmap.h"
+#include "cmc/hashset.h"
+#include "cmc/heap.h"
+#include "cmc/linkedlist.h"
+#include "cmc/list.h"
+#include "cmc/multimap.h"
+#include "cmc/orderedhashmap.h"
+#include "cmc/skiplistmap.h"
+#include "cmc/sortedlist.h"
+#include "cmc/swissmap.h"
+#include "cmc/treemap.h"
+#include "cmc/treeset.h"
+#include "cmc/unrolledlist.h"
+#include "utl/cmc_alloc.h"
+#include "utl/hash.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MIN_ELEMENTS 100
+#define MAX_ELEMENTS 1000000
+
+static int intcmp(size_t a, size_t b)
+{
+    return (a > b) - (a < b);
+}
+
+#define TRACKED (&cmc_alloc_node_tracked)
+
+/* Every collection is filled with count distinct elements */
+#define SEQUENCE(NAME, PFX, SNAME, NEW, ADD, FREE)              \
+    static size_t NAME##_run(size_t count, size_t *tracked)     \
+    {                                                           \
+        struct SNAME *c = NEW;                                  \
+                                                                \
+        if (!c)                                                 \
+            exit(1);                                            \
+                                                                \
+        for (size_t i = 0; i < count; i++)                      \
+            ADD;                                                \
+                                                                \
+        size_t usage = PFX##_memory_usage(c);                   \
+                                                                \
+        *tracked = cmc_alloc_tracker.current;                   \
+                                                                \
+        FREE;                                                   \
+                                                                \
+        return usage;                                           \
+    }
+
+CMC_GENERATE_LIST(l, list, size_t)
+CMC_GENERATE_DEQUE(d, deque, size_t)
+CMC_GENERATE_HEAP(h, heap, size_t)
+CMC_GENERATE_BLOCKDEQUE(bd, blockdeque, size_t)
+CMC_GENERATE_LINKEDLIST(ll, linkedlist, size_t)
+CMC_GENERATE_UNROLLEDLIST(ul, unrolledlist, size_t)
+CMC_GENERATE_SORTEDLIST(sl, sortedlist, size_t)
+CMC_GENERATE_HASHSET(hs, hashset, size_t)
+CMC_GENERATE_HASHMAP(hm, hashmap, size_t, size_t)
+CMC_GENERATE_HASHMAP_CACHED(hmc, hashmap_cached, size_t, size_t)
+CMC_GENERATE_SWISSMAP(sm, swissmap, size_t, size_t)
+CMC_GENERATE_ORDEREDHASHMAP(ohm, orderedhashmap, size_t, size_t)
+CMC_GENERATE_MULTIMAP(mm, multimap, size_t, size_t)
+CMC_GENERATE_TREESET(ts, treeset, size_t)
+CMC_GENERATE_TREEMAP(tm, treemap, size_t, size_t)
+CMC_GENERATE_BTREEMAP(btm, btreemap, size_t, size_t)
+CMC_GENERATE_SKIPLISTMAP(slm, skiplistmap, size_t, size_t)
+
+SEQUENCE(list, l, list, l_new_custom(16, TRACKED), l_push_back(c, i), l_free(c, NULL))
+SEQUENCE(deque, d, deque, d_new_custom(16, TRACKED), d_push_back(c, i), d_free(c, NULL))
+SEQUENCE(heap, h, heap, h_new_custom(16, cmc_max_heap, intcmp, TRACKED), h_insert(c, i),
+         h_free(c, NULL))
+SEQUENCE(blockdeque, bd, blockdeque, bd_new_custom(16, TRACKED), bd_push_back(c, i),
+         bd_free(c, NULL))
+SEQUENCE(linkedlist, ll, linkedlist, ll_new_custom(TRACKED), ll_push_back(c, i),
+         ll_free(c, NULL))
+SEQUENCE(unrolledlist, ul, unrolledlist, ul_new_custom(TRACKED), ul_push_back(c, i),
+         ul_free(c, NULL))
+SEQUENCE(sortedlist, sl, sortedlist, sl_new_custom(16, intcmp, TRACKED), sl_insert(c, i),
+         sl_free(c, NULL))
+SEQUENCE(hashset, hs, hashset, hs_new_custom(16, 0.7, intcmp, cmc_hash_size, TRACKED),
+         hs_insert(c, i), hs_free(c, NULL))
+SEQUENCE(hashmap, hm, hashmap, hm_new_custom(16, 0.7, intcmp, cmc_hash_size, TRACKED),
+         hm_insert(c, i, i), hm_free(c, NULL))
+SEQUENCE(hashmap_cached, hmc, hashmap_cached,
+         hmc_new_custom(16, 0.7, intcmp, cmc_hash_size, TRACKED), hmc_insert(c, i, i),
+         hmc_free(c, NULL))
+SEQUENCE(swissmap, sm, swissmap, sm_new_custom(16, 0.7, intcmp, cmc_hash_size, TRACKED),
+         sm_insert(c, i, i), sm_free(c, NULL))
+SEQUENCE(orderedhashmap, ohm, orderedhashmap,
+         ohm_new_custom(16, 0.7, intcmp, cmc_hash_size, TRACKED), ohm_insert(c, i, i),
+         ohm_free(c, NULL))
+SEQUENCE(multimap, mm, multimap, mm_new_custom(16, 0.7, intcmp, cmc_hash_size, TRACKED),
+         mm_insert(c, i, i), mm_free(c, NULL))
+SEQUENCE(treeset, ts, treeset, ts_new_custom(intcmp, TRACKED), ts_insert(c, i),
+         ts_free(c, NULL))
+SEQUENCE(treemap, tm, treemap, tm_new_custom(intcmp, TRACKED), tm_insert(c, i, i),
+         tm_free(c, NULL))
+SEQUENCE(btreemap, btm, btreemap, btm_new_custom(intcmp, TRACKED), btm_insert(c, i, i),
+         btm_free(c, NULL))
+SEQUENCE(skiplistmap, slm, skiplistmap, slm_new_custom(intcmp, TRACKED),
+         slm_insert(c, i, i), slm_free(c, NULL))
+
+struct collection
+{
+    const char *name;
+    size_t (*run)(size_t, size_t *);
+    /* Size of an element, or of a key and its value */
+    size_t element;
+};
+
+#define V sizeof(size_t)
+#define KV (sizeof(size_t) * 2)
+
+static const struct collection collections[] = {
+    { "list", list_run, V },
+    { "deque", deque_run, V },
+    { "heap", heap_run, V },
+    { "blockdeque", blockdeque_run, V },
+    { "linkedlist", linkedlist_run, V },
+    { "unrolledlist", unrolledlist_run, V },
+    { "sortedlist", sortedlist_run, V },
+    { "hashset", hashset_run, V },
+    { "hashmap", hashmap_run, KV },
+    { "hashmap_cached", hashmap_cached_run, KV },
+    { "swissmap", swissmap_run, KV },
+    { "orderedhashmap", orderedhashmap_run, KV },
+    { "multimap", multimap_run, KV },
+    { "treeset", treeset_run, V },
+    { "treemap", treemap_run, KV },
+    { "btreemap", btreemap_run, KV },
+    { "skiplistmap", skiplistmap_run, KV },
+};
+
+int main(int argc, char **argv)
+{
+    size_t max_elements = MAX_ELEMENTS;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "-n") == 0)
+            max_elements = (size_t)strtoull(argv[i + 1], NULL, 10);
+    }
+
+    printf("collection,elements,bytes,tracked,peak,bytes_per_element,overhead_per_element\n");
+
+    for (size_t count = MIN_ELEMENTS; count <= max_elements; count *= 10)
+    {
+        for (size_t c = 0; c < sizeof(collections) / sizeof(collections[0]); c++)
+        {
+            size_t tracked;
+
+            cmc_alloc_tracker_reset();
+
+            size_t usage = collections[c].run(count, &tracked);
+            double per_element = (double)usage / (double)count;
+
+            printf("%s,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%.2f,%.2f\n",
+                   collections[c].name, (uint64_t)count, (uint64_t)usage, (uint64_t)tracked,
+                   (uint64_t)cmc_alloc_tracker.peak, per_element,
+                   per_element - (double)collections[c].element);
+
+            if (usage != tracked)
+                fprintf(stderr, "%s: memory_usage %" PRIu64 " but %" PRIu64 " were tracked\n",
+                        collections[c].name, (uint64_t)usage, (uint64_t)tracked);
+        }
+    }
+
+    return 0;
+}
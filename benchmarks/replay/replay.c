@@ -0,0 +1,453 @@
+/**
+ * replay.c
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Replays a trace of operations on the map collections, to compare them */
+/* on the access patterns of a real program instead of random keys. Each */
+/* collection runs the whole trace once untimed to warm up, once timed as a */
+/* whole for its throughput and once with every operation timed on its own, */
+/* recorded into a histogram for each type of operation. */
+
+/* A trace is a binary file with a header of the 8 bytes "CMCTRACE", the */
+/* version as a 32 bit little endian integer, 4 reserved bytes and the */
+/* amount of operations as a 64 bit little endian integer. Then comes each */
+/* operation as one byte with its type followed by its key as an unsigned */
+/* LEB128 varint: */
+/* - 0 insert: inserts the key, if it is not there, with the key as value */
+/* - 1 get: looks the key up */
+/* - 2 remove: removes the key, if it is there */
+/* - 3 iterate: goes through the first key elements of the map, or all of */
+/*   them if key is 0 */
+
+/* A program can write its own traces by logging its operations in this */
+/* format. Keys are 64 bits so pointers or hashes of strings can be used. */
+/* With -g a synthetic trace is written instead, with -n operations over -k */
+/* keys, skewed towards a few hot keys. */
+
+/* Usage: replay -t trace [-c collection] */
+/*        replay -g trace [-n operations] [-k keys] */
+
+#include "cmc/btreemap.h"
+#include "cmc/hashmap.h"
+#include "cmc/orderedhashmap.h"
+#include "cmc/skiplistmap.h"
+#include "cmc/swissmap.h"
+#include "cmc/treemap.h"
+#include "utl/hash.h"
+#include "utl/timer.h"
+#include "../util/histogram.c"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TRACE_MAGIC "CMCTRACE"
+#define TRACE_VERSION 1
+
+enum operation
+{
+    OP_INSERT = 0,
+    OP_GET = 1,
+    OP_REMOVE = 2,
+    OP_ITERATE = 3,
+    OPERATIONS
+};
+
+static const char *operation_names[OPERATIONS] = { "insert", "get", "remove", "iterate" };
+
+struct trace
+{
+    uint8_t *operations;
+    size_t *keys;
+    size_t count;
+};
+
+static int intcmp(size_t a, size_t b)
+{
+    return (a > b) - (a < b);
+}
+
+/* Keeps the results of lookups from being optimized away */
+static volatile size_t sink;
+
+/* Time that it takes to read the clock twice, taken out of every sample */
+static uint64_t overhead;
+
+static uint64_t splitmix64(uint64_t *state)
+{
+    uint64_t z = (*state += UINT64_C(0x9E3779B97F4A7C15));
+    z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+    z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+    return z ^ (z >> 31);
+}
+
+static void write_u32(FILE *file, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+        fputc((int)((value >> (i * 8)) & 0xFF), file);
+}
+
+static void write_u64(FILE *file, uint64_t value)
+{
+    for (int i = 0; i < 8; i++)
+        fputc((int)((value >> (i * 8)) & 0xFF), file);
+}
+
+static void write_varint(FILE *file, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        fputc((int)((value & 0x7F) | 0x80), file);
+        value >>= 7;
+    }
+
+    fputc((int)value, file);
+}
+
+static bool read_u64(FILE *file, uint64_t *value)
+{
+    *value = 0;
+
+    for (int i = 0; i < 8; i++)
+    {
+        int c = fgetc(file);
+
+        if (c == EOF)
+            return false;
+
+        *value |= (uint64_t)c << (i * 8);
+    }
+
+    return true;
+}
+
+static bool read_varint(FILE *file, uint64_t *value)
+{
+    *value = 0;
+
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        int c = fgetc(file);
+
+        if (c == EOF)
+            return false;
+
+        *value |= (uint64_t)(c & 0x7F) << shift;
+
+        if (!(c & 0x80))
+            return true;
+    }
+
+    return false;
+}
+
+/* Writes a trace of mostly lookups, where a few keys get most operations */
+static bool generate(const char *path, size_t count, size_t keys)
+{
+    FILE *file = fopen(path, "wb");
+    uint64_t state = 42;
+
+    if (!file)
+        return false;
+
+    fwrite(TRACE_MAGIC, 1, 8, file);
+    write_u32(file, TRACE_VERSION);
+    write_u32(file, 0);
+    write_u64(file, count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t roll = splitmix64(&state) % 1000;
+        double u = (double)(splitmix64(&state) >> 11) / (double)(UINT64_C(1) << 53);
+        /* Cubing a uniform value skews it towards 0, the hot keys */
+        size_t index = (size_t)((double)keys * u * u * u);
+        /* Scattered keys, but the same for the same index */
+        uint64_t seed = index;
+        uint64_t key = splitmix64(&seed);
+
+        if (roll < 300)
+        {
+            fputc(OP_INSERT, file);
+            write_varint(file, key);
+        }
+        else if (roll < 900)
+        {
+            fputc(OP_GET, file);
+            write_varint(file, key);
+        }
+        else if (roll < 999)
+        {
+            fputc(OP_REMOVE, file);
+            write_varint(file, key);
+        }
+        else
+        {
+            fputc(OP_ITERATE, file);
+            write_varint(file, 100);
+        }
+    }
+
+    return fclose(file) == 0;
+}
+
+static bool load(const char *path, struct trace *trace)
+{
+    FILE *file = fopen(path, "rb");
+    char magic[8];
+    uint64_t header, count;
+
+    if (!file)
+        return false;
+
+    if (fread(magic, 1, 8, file) != 8 || memcmp(magic, TRACE_MAGIC, 8) != 0 ||
+        !read_u64(file, &header) || (header & 0xFFFFFFFF) != TRACE_VERSION ||
+        !read_u64(file, &count))
+    {
+        fclose(file);
+        return false;
+    }
+
+    trace->operations = malloc(count);
+    trace->keys = malloc(sizeof(size_t) * count);
+    trace->count = 0;
+
+    if (!trace->operations || !trace->keys)
+    {
+        fclose(file);
+        return false;
+    }
+
+    for (uint64_t i = 0; i < count; i++)
+    {
+        int operation = fgetc(file);
+        uint64_t key;
+
+        if (operation == EOF || operation >= OPERATIONS || !read_varint(file, &key))
+            break;
+
+        trace->operations[i] = (uint8_t)operation;
+        trace->keys[i] = (size_t)key;
+        trace->count++;
+    }
+
+    fclose(file);
+
+    if (trace->count != count)
+        fprintf(stderr, "trace ends after %" PRIu64 " of %" PRIu64 " operations\n",
+                (uint64_t)trace->count, count);
+
+    return true;
+}
+
+static void calibrate(void)
+{
+    histogram h;
+
+    hist_init(&h);
+
+    for (size_t i = 0; i < 100000; i++)
+    {
+        uint64_t start = cmc_timer_now();
+        hist_record(&h, cmc_timer_now() - start);
+    }
+
+    overhead = h.min;
+}
+
+/* Runs one operation of the trace on map, an iterator of the map is iter */
+#define OPERATION(PFX, map, operation, key)                                        \
+    do                                                                             \
+    {                                                                              \
+        switch (operation)                                                         \
+        {                                                                          \
+            case OP_INSERT:                                                        \
+                PFX##_insert(map, key, key);                                       \
+                break;                                                             \
+            case OP_GET:                                                           \
+                sink += PFX##_get(map, key);                                       \
+                break;                                                             \
+            case OP_REMOVE:                                                        \
+                PFX##_remove(map, key, NULL);                                      \
+                break;                                                             \
+            default:                                                               \
+            {                                                                      \
+                size_t visited = 0;                                                \
+                for (PFX##_iter_init(&iter, map);                                  \
+                     !PFX##_iter_end(&iter) && (key == 0 || visited < key);        \
+                     PFX##_iter_next(&iter), visited++)                            \
+                    sink += PFX##_iter_value(&iter);                               \
+                break;                                                             \
+            }                                                                      \
+        }                                                                          \
+    } while (0)
+
+/* Returns the nanoseconds that the whole trace took and fills hists */
+#define REPLAY(NAME, PFX, SNAME, NEW)                                               \
+    static uint64_t NAME##_run(struct trace *trace, histogram *hists)               \
+    {                                                                               \
+        struct SNAME##_iter iter;                                                   \
+        struct cmc_timer timer = { 0 };                                             \
+        struct SNAME *map;                                                          \
+                                                                                    \
+        for (int pass = 0; pass < 3; pass++)                                        \
+        {                                                                           \
+            if (!(map = NEW))                                                       \
+                exit(1);                                                            \
+                                                                                    \
+            if (pass == 1)                                                          \
+                cmc_timer_start(timer);                                             \
+                                                                                    \
+            for (size_t i = 0; i < trace->count; i++)                               \
+            {                                                                       \
+                uint8_t op = trace->operations[i];                                  \
+                size_t key = trace->keys[i];                                        \
+                                                                                    \
+                if (pass == 2)                                                      \
+                {                                                                   \
+                    uint64_t start = cmc_timer_now();                               \
+                    OPERATION(PFX, map, op, key);                                   \
+                    uint64_t elapsed = cmc_timer_now() - start;                     \
+                    hist_record(&hists[op], elapsed > overhead ? elapsed - overhead \
+                                                               : 0);                \
+                }                                                                   \
+                else                                                                \
+                    OPERATION(PFX, map, op, key);                                   \
+            }                                                                       \
+                                                                                    \
+            if (pass == 1)                                                          \
+            {                                                                       \
+                cmc_timer_stop(timer);                                              \
+                cmc_timer_calc(timer);                                              \
+            }                                                                       \
+                                                                                    \
+            PFX##_free(map, NULL);                                                  \
+        }                                                                           \
+                                                                                    \
+        return timer.elapsed;                                                       \
+    }
+
+#define HASHED(PFX) PFX##_new(16, 0.7, intcmp, cmc_hash_size)
+#define SORTED(PFX) PFX##_new(intcmp)
+
+CMC_GENERATE_HASHMAP(hm, hashmap, size_t, size_t)
+CMC_GENERATE_HASHMAP_POW2(hmp, hashmap_pow2, size_t, size_t)
+CMC_GENERATE_HASHMAP_CACHED(hmc, hashmap_cached, size_t, size_t)
+CMC_GENERATE_SWISSMAP(sm, swissmap, size_t, size_t)
+CMC_GENERATE_ORDEREDHASHMAP(ohm, orderedhashmap, size_t, size_t)
+CMC_GENERATE_TREEMAP(tm, treemap, size_t, size_t)
+CMC_GENERATE_BTREEMAP(btm, btreemap, size_t, size_t)
+CMC_GENERATE_SKIPLISTMAP(slm, skiplistmap, size_t, size_t)
+
+REPLAY(hashmap, hm, hashmap, HASHED(hm))
+REPLAY(hashmap_pow2, hmp, hashmap_pow2, HASHED(hmp))
+REPLAY(hashmap_cached, hmc, hashmap_cached, HASHED(hmc))
+REPLAY(swissmap, sm, swissmap, HASHED(sm))
+REPLAY(orderedhashmap, ohm, orderedhashmap, HASHED(ohm))
+REPLAY(treemap, tm, treemap, SORTED(tm))
+REPLAY(btreemap, btm, btreemap, SORTED(btm))
+REPLAY(skiplistmap, slm, skiplistmap, SORTED(slm))
+
+struct collection
+{
+    const char *name;
+    uint64_t (*run)(struct trace *, histogram *);
+};
+
+static const struct collection collections[] = {
+    { "hashmap", hashmap_run },
+    { "hashmap_pow2", hashmap_pow2_run },
+    { "hashmap_cached", hashmap_cached_run },
+    { "swissmap", swissmap_run },
+    { "orderedhashmap", orderedhashmap_run },
+    { "treemap", treemap_run },
+    { "btreemap", btreemap_run },
+    { "skiplistmap", skiplistmap_run },
+};
+
+int main(int argc, char **argv)
+{
+    const char *trace_path = NULL;
+    const char *generate_path = NULL;
+    const char *only = NULL;
+    size_t count = 1000000;
+    size_t keys = 100000;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "-t") == 0)
+            trace_path = argv[i + 1];
+        else if (strcmp(argv[i], "-g") == 0)
+            generate_path = argv[i + 1];
+        else if (strcmp(argv[i], "-c") == 0)
+            only = argv[i + 1];
+        else if (strcmp(argv[i], "-n") == 0)
+            count = (size_t)strtoull(argv[i + 1], NULL, 10);
+        else if (strcmp(argv[i], "-k") == 0)
+            keys = (size_t)strtoull(argv[i + 1], NULL, 10);
+    }
+
+    if (generate_path)
+        return generate(generate_path, count, keys) ? 0 : 1;
+
+    struct trace trace;
+
+    if (!trace_path || !load(trace_path, &trace))
+    {
+        fprintf(stderr, "usage: replay -t trace [-c collection]\n"
+                        "       replay -g trace [-n operations] [-k keys]\n");
+        return 1;
+    }
+
+    histogram *hists = malloc(sizeof(histogram) * OPERATIONS);
+
+    if (!hists)
+        return 1;
+
+    calibrate();
+
+    printf("collection,operation,count,mops,mean_ns,p50_ns,p99_ns,p999_ns,max_ns\n");
+
+    for (size_t c = 0; c < sizeof(collections) / sizeof(collections[0]); c++)
+    {
+        if (only && strcmp(only, collections[c].name) != 0)
+            continue;
+
+        for (size_t op = 0; op < OPERATIONS; op++)
+            hist_init(&hists[op]);
+
+        uint64_t elapsed = collections[c].run(&trace, hists);
+
+        /* The throughput of every operation together, without the timer */
+        printf("%s,all,%" PRIu64 ",%.2f,%.1f,,,,\n", collections[c].name, (uint64_t)trace.count,
+               elapsed ? (double)trace.count * 1e3 / (double)elapsed : 0.0,
+               trace.count ? (double)elapsed / (double)trace.count : 0.0);
+
+        for (size_t op = 0; op < OPERATIONS; op++)
+        {
+            histogram *h = &hists[op];
+            double mean = hist_mean(h);
+
+            if (h->total == 0)
+                continue;
+
+            printf("%s,%s,%" PRIu64 ",%.2f,%.1f,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+                   collections[c].name, operation_names[op], h->total,
+                   mean > 0 ? 1e3 / mean : 0.0, mean, hist_quantile(h, 0.5),
+                   hist_quantile(h, 0.99), hist_quantile(h, 0.999), h->max);
+        }
+
+        fflush(stdout);
+    }
+
+    free(trace.operations);
+    free(trace.keys);
+    free(hists);
+
+    return 0;
+}
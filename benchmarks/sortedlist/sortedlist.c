@@ -0,0 +1,84 @@
+/**
+ * sortedlist.c
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Showing off how different sorted list implementations affect runtime cost */
+
+#include "utl/timer.h"
+#include <stdio.h>
+#include <inttypes.h>
+
+#define MAX 20000
+
+static int cmp(int a, int b)
+{
+    return (a > b) - (a < b);
+}
+
+#if defined(CMC_SORTEDLIST)
+#include "cmc/sortedlist.h"
+CMC_GENERATE_SORTEDLIST(s, sortedlist, int)
+#define TARGET "SORTEDLIST"
+#elif defined(SAC_SORTEDLIST)
+#include "sac/sortedlist.h"
+SAC_SORTEDLIST_GENERATE(s, sortedlist, , int, MAX)
+#define TARGET "SAC SORTEDLIST"
+#else
+#error Please define either CMC_SORTEDLIST or SAC_SORTEDLIST
+#endif
+
+int main(void)
+{
+
+#if defined(CMC_SORTEDLIST)
+    struct sortedlist *s = s_new(MAX, cmp);
+#elif defined(SAC_SORTEDLIST)
+    static sortedlist _s;
+    _s = s_new(cmp);
+    sortedlist_ptr s = &_s;
+#endif
+
+    size_t sum = 0;
+    unsigned i = 0;
+
+    struct cmc_timer timer;
+    cmc_timer_start(timer);
+
+    while (s_count(s) != MAX)
+    {
+        /* Scattered keys */
+        s_insert(s, (int)((i++ * 2654435761u) % 1000003));
+
+        /* Lookups in between insertions */
+        if (i % 10 == 0)
+        {
+            int min;
+
+            if (s_min(s, &min))
+                sum += (size_t)min;
+
+            sum += s_indexof(s, (int)(i % 1000003), true);
+        }
+    }
+
+    cmc_timer_stop(timer);
+    cmc_timer_calc(timer);
+
+    printf("----------------------------------------\n");
+    printf("%s\n", TARGET);
+    printf("Execution time: %.0lf milliseconds\n", timer.result);
+    printf("SUM: %" PRIuMAX "\n", sum);
+    printf("----------------------------------------\n");
+
+#if defined(CMC_SORTEDLIST)
+    s_free(s, NULL);
+#endif
+
+    return 0;
+}
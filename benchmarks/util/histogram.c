@@ -0,0 +1,129 @@
+/**
+ * histogram.c
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ * Latency histogram utility
+ *
+ */
+#include <stdint.h>
+#include <string.h>
+
+// Log-linear buckets like the ones of an HDR histogram. Values below
+// 2 * HIST_SUB have a bucket each and every power of two above it is split
+// into HIST_SUB buckets, so a bucket is never wider than 1 / HIST_SUB of
+// the values in it and any 64 bit value can be recorded
+#define HIST_SUB_BITS 6
+#define HIST_SUB (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS ((64 - HIST_SUB_BITS + 1) * HIST_SUB)
+
+typedef struct histogram_s
+{
+    uint64_t counts[HIST_BUCKETS];
+    uint64_t total;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+} histogram;
+
+// Empties the histogram
+void hist_init(histogram *h);
+
+// Records one value
+void hist_record(histogram *h, uint64_t value);
+
+// Highest value of the bucket of the value at the given quantile, in [0, 1]
+uint64_t hist_quantile(histogram *h, double quantile);
+
+// Mean of every recorded value
+double hist_mean(histogram *h);
+
+//
+// Implementation
+//
+static int hist_msb(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(value);
+#else
+    int msb = 0;
+
+    while (value >>= 1)
+        msb++;
+
+    return msb;
+#endif
+}
+
+static size_t hist_index(uint64_t value)
+{
+    if (value < 2 * HIST_SUB)
+        return (size_t)value;
+
+    int shift = hist_msb(value) - HIST_SUB_BITS;
+
+    return (size_t)(shift + 1) * HIST_SUB + (size_t)((value >> shift) - HIST_SUB);
+}
+
+static uint64_t hist_highest(size_t index)
+{
+    if (index < 2 * HIST_SUB)
+        return index;
+
+    int shift = (int)(index / HIST_SUB) - 1;
+    uint64_t lowest = (uint64_t)(index % HIST_SUB + HIST_SUB) << shift;
+
+    return lowest + ((UINT64_C(1) << shift) - 1);
+}
+
+void hist_init(histogram *h)
+{
+    memset(h, 0, sizeof(histogram));
+    h->min = UINT64_MAX;
+}
+
+void hist_record(histogram *h, uint64_t value)
+{
+    h->counts[hist_index(value)]++;
+    h->total++;
+    h->sum += value;
+
+    if (value < h->min)
+        h->min = value;
+    if (value > h->max)
+        h->max = value;
+}
+
+uint64_t hist_quantile(histogram *h, double quantile)
+{
+    if (h->total == 0)
+        return 0;
+
+    uint64_t rank = (uint64_t)(quantile * (double)h->total + 0.5);
+    uint64_t seen = 0;
+
+    if (rank < 1)
+        rank = 1;
+
+    for (size_t i = 0; i < HIST_BUCKETS; i++)
+    {
+        seen += h->counts[i];
+
+        if (seen >= rank)
+        {
+            uint64_t highest = hist_highest(i);
+
+            return highest < h->max ? highest : h->max;
+        }
+    }
+
+    return h->max;
+}
+
+double hist_mean(histogram *h)
+{
+    return h->total ? (double)h->sum / (double)h->total : 0.0;
+}
@@ -1,6 +1,2 @@
+#define CMC_INSTANTIATE
 #include "containers.h"
-
-COLLECTION_GENERATE_SOURCE(LIST, il, int_list, , , int)
-COLLECTION_GENERATE_SOURCE(STACK, cs, char_stack, , , char)
-COLLECTION_GENERATE_SOURCE(QUEUE, queue, index_queue, , , size_t)
-COLLECTION_GENERATE_SOURCE(DEQUE, dq, deque, , , int)
@@ -3,7 +3,7 @@
 #include <stdbool.h>
 #include "macro_collections.h"
 
-COLLECTION_GENERATE_HEADER(LIST, il, int_list, , , int)
-COLLECTION_GENERATE_HEADER(STACK, cs, char_stack, , , char)
-COLLECTION_GENERATE_HEADER(QUEUE, queue, index_queue, , , size_t)
-COLLECTION_GENERATE_HEADER(DEQUE, dq, deque, , , int)
+CMC_COLLECTION_INSTANTIATE(LIST, il, int_list, , int)
+CMC_COLLECTION_INSTANTIATE(STACK, cs, char_stack, , char)
+CMC_COLLECTION_INSTANTIATE(QUEUE, queue, index_queue, , size_t)
+CMC_COLLECTION_INSTANTIATE(DEQUE, dq, deque, , int)
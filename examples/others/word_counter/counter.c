@@ -9,261 +9,397 @@
  */
 
 /**
- * A multi-threading word counter in C using the C Macro Collections library
- * and the pthread library.
+ * A multi-threaded word counter in C using the C Macro Collections library
+ * and the pthread library, also used as a benchmark of string keys.
+ *
+ * The files are mapped into memory and split into chunks that the threads
+ * take from a shared counter. Each thread interns the words it finds and
+ * counts them in a HashMap of its own, keyed by the interned pointers, so
+ * counting takes no locks and compares no strings. The maps are then merged
+ * in parallel, each thread merging the words whose hash falls in its share
+ * into a map compared with strcmp, and keeping the K most frequent of them
+ * in a min Heap. The heaps of every thread give the K most frequent words.
+ *
+ * Usage: counter [-t threads] [-k words] files...
+ * The words go to stdout and the time spent and throughput to stderr.
  */
 
 #include <cmc/hashmap.h>
 #include <cmc/heap.h>
-#include <cmc/list.h>
 #include <ctype.h>
+#include <fcntl.h>
 #include <inttypes.h>
 #include <pthread.h>
-#include <sac/stack.h>
+#include <stdatomic.h>
 #include <stdio.h>
-#define CMC_LOG_COLOR
-#include <utl/log.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utl/intern.h>
+#include <utl/timer.h>
 
-// Maximum number of threads
-#define n_threads 100
+/* Bytes of each chunk of a file given to a thread */
+#define CHUNK_SIZE (1 << 20)
 
-/* HashMap mutex */
-pthread_mutex_t table_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* Longer words are counted by their first MAX_WORD letters */
+#define MAX_WORD 64
 
-/* printf, fprintf mutex */
-pthread_mutex_t print_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define MAX_THREADS 64
 
-/* A pair of word and number of how many times that word has appeared */
-/* This will be used by Heap */
-typedef struct wc_pair_s
+/* A word and how many times it appeared, sorted by the Heap */
+struct word_pair
 {
-    char *word;
+    const char *word;
     size_t count;
-} wc_pair;
-
-/* A stack allocated stack to keep track of each thread id */
-SAC_STACK_GENERATE(tl, TList, , pthread_t, n_threads)
+};
 
-/* A list used as a dynamic string */
-LIST_GENERATE(str, String, , char)
+/* Words of each thread, keyed by their interned pointer */
+CMC_GENERATE_HASHMAP(wc, word_count, const char *, size_t)
 
-/* A mapping between word and word count */
-HASHMAP_GENERATE(hm, HashMap, , char *, size_t)
+/* Heap of the most frequent words */
+CMC_GENERATE_HEAP(wt, word_top, struct word_pair)
 
-/* Used by HashMap to hash its keys (char *) */
-size_t djb2(char *str)
+/* Merged words, interned by different threads, so compared by their bytes */
+int word_cmp(const char *a, const char *b)
 {
-    size_t hash = 5381;
-    int c;
+    return strcmp(a, b);
+}
 
-    while ((c = *str++))
-        hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
+/* The least frequent word is at the top of the min Heap, and of two words */
+/* with the same count the one that comes last alphabetically */
+int pair_cmp(struct word_pair a, struct word_pair b)
+{
+    int cmp = (a.count > b.count) - (a.count < b.count);
 
-    return hash;
+    return cmp != 0 ? cmp : strcmp(b.word, a.word);
 }
 
-/* Used by HashMap to compare its keys (char *) */
-int chrcmp(char *a, char *b)
+struct file_map
 {
-    return strcmp(a, b);
-}
+    const char *name;
+    const char *data;
+    size_t size;
+};
 
-/* Heap used to sort the { word : word_count } pairs */
-HEAP_GENERATE(hp, Heap, , wc_pair)
+struct chunk
+{
+    struct file_map *file;
+    size_t begin;
+    size_t end;
+};
+
+struct counter
+{
+    struct cmc_intern words;
+    struct word_count *counts;
+    size_t total;
+    bool failed;
+};
 
-/* Used by Heap to sort wc_pair */
-int cmp_wcpair(wc_pair p1, wc_pair p2)
+struct merger
 {
-    /* Sort by count, then by word */
-    int cmp =  (p1.count > p2.count) - (p1.count < p2.count);
+    struct counter *counters;
+    size_t n_counters;
+    size_t share;
+    size_t k;
+    struct word_top *top;
+    size_t unique;
+};
+
+static struct chunk *chunks;
+static size_t n_chunks;
+static atomic_size_t next_chunk;
+
+/* Counts the words that start in the chunk, including the end of the */
+/* last one if it goes past it */
+static void count_chunk(struct counter *counter, struct chunk *chunk)
+{
+    const char *data = chunk->file->data;
+    size_t size = chunk->file->size;
+    size_t i = chunk->begin;
+
+    /* The word that was cut at the beginning belongs to the previous chunk */
+    if (i > 0)
+    {
+        while (i < size && isalpha((unsigned char)data[i - 1]) && isalpha((unsigned char)data[i]))
+            i++;
+    }
+
+    char word[MAX_WORD];
+
+    while (i < chunk->end)
+    {
+        if (!isalpha((unsigned char)data[i]))
+        {
+            i++;
+            continue;
+        }
+
+        size_t length = 0;
+
+        for (; i < size && isalpha((unsigned char)data[i]); i++)
+        {
+            if (length < MAX_WORD)
+                word[length++] = (char)tolower((unsigned char)data[i]);
+        }
+
+        const char *key = cmc_intern(&(counter->words), word, length);
+        size_t *count = key ? wc_get_or_insert(counter->counts, key, 0) : NULL;
 
-    if (cmp == 0)
-        /* I swapped p1 and p2 so that in the output the result is alphabetically ordered */
-        return chrcmp(p2.word, p1.word);
+        if (!count)
+        {
+            counter->failed = true;
+            return;
+        }
 
-    return cmp;
+        *count += 1;
+        counter->total++;
+    }
 }
 
-/* Argument type passed to void *counter_routine(void *data) */
-typedef struct cr_arg_s
+static void *count_routine(void *data)
 {
-    HashMap *table;
-    const char *file_name;
-} cr_arg;
+    struct counter *counter = data;
+
+    for (;;)
+    {
+        size_t c = atomic_fetch_add_explicit(&next_chunk, 1, memory_order_relaxed);
+
+        if (c >= n_chunks || counter->failed)
+            return NULL;
+
+        count_chunk(counter, &chunks[c]);
+    }
+}
 
-/* Word Counter */
-void *counter_routine(void *data)
+static void *merge_routine(void *data)
 {
-    /* Acquire data */
-    cr_arg *thread_arg = data;
-    HashMap *table = thread_arg->table;
-    const char *file_name = thread_arg->file_name;
+    struct merger *merger = data;
+    struct word_count *merged = wc_new(4096, 0.7, word_cmp, cmc_intern_hash);
+
+    merger->top = wt_new(merger->k, cmc_min_heap, pair_cmp);
 
-    FILE *file = fopen(file_name, "r");
+    if (!merged || !merger->top)
+        goto end;
 
-    if (!file)
+    for (size_t i = 0; i < merger->n_counters; i++)
     {
-        pthread_mutex_lock(&print_mutex);
+        struct word_count_iter iter;
+        struct word_count *counts = merger->counters[i].counts;
+
+        for (wc_iter_init(&iter, counts); !wc_iter_end(&iter); wc_iter_next(&iter))
+        {
+            const char *word = wc_iter_key(&iter);
+
+            if (cmc_intern_hash(word) % merger->n_counters != merger->share)
+                continue;
 
-        fprintf(stderr, "Failed to open file %s\n", file_name);
+            size_t *count = wc_get_or_insert(merged, word, 0);
 
-        pthread_mutex_unlock(&print_mutex);
-        return NULL;
+            if (count)
+                *count += wc_iter_value(&iter);
+        }
     }
 
-    int ch = 0;
-    String *word = str_new(100);
+    merger->unique = wc_count(merged);
 
-    /* Begin reading file */
-    /* Whenever a word is found, add it to the HashMap */
-    while ((ch = fgetc(file)) != EOF)
+    struct word_count_iter iter;
+
+    for (wc_iter_init(&iter, merged); !wc_iter_end(&iter); wc_iter_next(&iter))
     {
-        /* Normalize */
-        ch = tolower(ch);
+        struct word_pair pair = { wc_iter_key(&iter), wc_iter_value(&iter) };
 
-        /* Stop when is a space character or punctuation */
-        /* Only count alphabetical letter */
-        if ( ( isspace(ch) || ispunct(ch) ) && !str_empty(word) )
-        {
-            str_push_back(word, 0);
+        wt_offer_bounded(merger->top, pair, merger->k);
+    }
 
-            char *key = strdup(word->buffer);
+end:
+    if (merged)
+        wc_free(merged, NULL);
 
-            pthread_mutex_lock(&table_mutex);
+    return NULL;
+}
 
-            size_t *num = hm_get_ref(table, key);
+static bool map_file(struct file_map *file, const char *name)
+{
+    int fd = open(name, O_RDONLY);
+    struct stat st;
 
-            if (num == NULL)
-                hm_insert(table, key, 1);
-            else
-            {
-                *num += 1;
-                free(key);
-                key = NULL;
-            }
+    file->name = name;
+    file->data = NULL;
+    file->size = 0;
 
-            pthread_mutex_unlock(&table_mutex);
+    if (fd < 0)
+        return false;
 
-            str_clear(word);
-        }
-        else if (isalpha(ch))
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    if (st.st_size > 0)
+    {
+        void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (data == MAP_FAILED)
         {
-            str_push_back(word, ch);
+            close(fd);
+            return false;
         }
+
+        file->data = data;
+        file->size = (size_t)st.st_size;
     }
 
-    str_free(word);
-    fclose(file);
+    close(fd);
 
-    return NULL;
+    return true;
 }
 
 int main(int argc, char const *argv[])
 {
-    /* Check arguments*/
-    if (argc > n_threads)
+    size_t n_threads = 4;
+    size_t k = 20;
+    int first = 1;
+
+    for (; first + 1 < argc && argv[first][0] == '-'; first += 2)
     {
-        fprintf(stderr, "Sorry but no more than %d arguments\n", n_threads);
-        return 2;
+        if (strcmp(argv[first], "-t") == 0)
+            n_threads = strtoul(argv[first + 1], NULL, 10);
+        else if (strcmp(argv[first], "-k") == 0)
+            k = strtoul(argv[first + 1], NULL, 10);
+        else
+            break;
     }
-    else if (argc == 1)
+
+    if (first >= argc || n_threads == 0 || n_threads > MAX_THREADS || k == 0)
     {
-        fprintf(stderr, "Usage:\n %s path/to/file.txt path/to/another/file.txt\n", argv[0]);
+        fprintf(stderr, "Usage:\n %s [-t threads] [-k words] files...\n", argv[0]);
         return 1;
     }
 
-    cr_arg *thread_args = calloc(n_threads, sizeof(cr_arg));
+    size_t n_files = (size_t)(argc - first);
+    struct file_map *files = calloc(n_files, sizeof(struct file_map));
+    size_t bytes = 0;
 
-    /* Threads id storage */
-    TList ts = tl_new();
-
-    /* Resulting word - word_count mapping */
-    HashMap *result = hm_new(100000, 0.6, chrcmp, djb2);
-
-    /* Create one thread for each file */
-    for (int i = 1; i < argc; i++)
+    for (size_t i = 0; i < n_files; i++)
     {
-        thread_args[i - 1].table = result;
-        thread_args[i - 1].file_name = argv[i];
-
-        pthread_t T;
-        if (pthread_create(&T, NULL, counter_routine, &thread_args[i - 1]) != 0)
-        {
-            pthread_mutex_lock(&print_mutex);
+        if (!map_file(&files[i], argv[first + i]))
+            fprintf(stderr, "Failed to open file %s\n", argv[first + i]);
 
-            log_error("Could not create thread for %s\n", argv[i]);
+        bytes += files[i].size;
+        n_chunks += (files[i].size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    }
 
-            pthread_mutex_unlock(&print_mutex);
-        }
+    chunks = malloc((n_chunks ? n_chunks : 1) * sizeof(struct chunk));
 
-        if (!tl_push(&ts, T))
+    for (size_t i = 0, c = 0; i < n_files; i++)
+    {
+        for (size_t begin = 0; begin < files[i].size; begin += CHUNK_SIZE, c++)
         {
-            pthread_mutex_lock(&print_mutex);
-
-            log_error("Could not push to stack %lu", T);
+            size_t end = begin + CHUNK_SIZE;
 
-            pthread_mutex_unlock(&print_mutex);
+            chunks[c] = (struct chunk){ &files[i], begin, end < files[i].size ? end : files[i].size };
         }
     }
 
-    /* Wait for all threads to finish */
-    for (TList_iter iter = ts.it_start(&ts); !tl_iter_end(&iter); tl_iter_next(&iter))
+    struct counter counters[MAX_THREADS] = { 0 };
+    struct merger mergers[MAX_THREADS] = { 0 };
+    pthread_t threads[MAX_THREADS];
+    struct cmc_timer count_timer, merge_timer;
+
+    for (size_t i = 0; i < n_threads; i++)
     {
-        pthread_t T = tl_iter_value(&iter);
+        counters[i].counts = wc_new(4096, 0.7, cmc_intern_cmp, cmc_intern_hash);
 
-        if (pthread_join(T, NULL) != 0)
-        {
-            log_error("Failed to join thread %lu\n", T);
-        }
+        if (!counters[i].counts)
+            return 1;
     }
 
-    /* Sorting using a Heap */
-    Heap *sort = hp_new(hm_count(result), cmc_max_heap, cmp_wcpair);
+    cmc_timer_start(count_timer);
 
-    /* Add key-value pairs to Heap for sorting */
-    for (HashMap_iter iter = result->it_start(result);
-        !hm_iter_end(&iter);
-        hm_iter_next(&iter))
-    {
-        wc_pair wc = {hm_iter_key(&iter), hm_iter_value(&iter)};
+    for (size_t i = 0; i < n_threads; i++)
+        pthread_create(&threads[i], NULL, count_routine, &counters[i]);
+
+    for (size_t i = 0; i < n_threads; i++)
+        pthread_join(threads[i], NULL);
+
+    cmc_timer_stop(count_timer);
+    cmc_timer_start(merge_timer);
 
-        hp_insert(sort, wc);
+    for (size_t i = 0; i < n_threads; i++)
+    {
+        mergers[i] = (struct merger){ counters, n_threads, i, k, NULL, 0 };
+        pthread_create(&threads[i], NULL, merge_routine, &mergers[i]);
     }
 
-    /* Open file for output */
-    FILE *out = fopen("out.txt", "w");
+    for (size_t i = 0; i < n_threads; i++)
+        pthread_join(threads[i], NULL);
+
+    struct word_top *top = wt_new(k, cmc_min_heap, pair_cmp);
+    size_t total = 0;
+    size_t unique = 0;
+    bool failed = false;
 
-    if (!out)
+    for (size_t i = 0; i < n_threads; i++)
     {
-        fprintf(stderr, "Failed to create file %s\n", "out.txt");
+        total += counters[i].total;
+        unique += mergers[i].unique;
+        failed = failed || counters[i].failed || !mergers[i].top;
+
+        for (struct word_pair pair; mergers[i].top && wt_remove(mergers[i].top, &pair);)
+            wt_offer_bounded(top, pair, k);
     }
-    else
+
+    cmc_timer_stop(merge_timer);
+    cmc_timer_calc(count_timer);
+    cmc_timer_calc(merge_timer);
+
+    /* The heap gives the words from the least frequent */
+    size_t n_top = wt_count(top);
+    struct word_pair *sorted = malloc((n_top ? n_top : 1) * sizeof(struct word_pair));
+
+    for (size_t i = n_top; i > 0; i--)
+        wt_remove(top, &sorted[i - 1]);
+
+    printf("A total of %" PRIuMAX " words and %" PRIuMAX " unique words were found\n\n",
+           (uintmax_t)total, (uintmax_t)unique);
+
+    for (size_t i = 0; i < n_top; i++)
+        printf("%s, %" PRIuMAX "\n", sorted[i].word, (uintmax_t)sorted[i].count);
+
+    double seconds = (count_timer.result + merge_timer.result) / 1e3;
+
+    fprintf(stderr, "threads: %" PRIuMAX ", bytes: %" PRIuMAX "\n", (uintmax_t)n_threads,
+            (uintmax_t)bytes);
+    fprintf(stderr, "count: %.2lf ms, merge: %.2lf ms, %.2lf MB/s\n", count_timer.result,
+            merge_timer.result, seconds > 0 ? bytes / 1e6 / seconds : 0.0);
+
+    if (failed)
+        fprintf(stderr, "Ran out of memory, the counts are incomplete\n");
+
+    free(sorted);
+    wt_free(top, NULL);
+
+    for (size_t i = 0; i < n_threads; i++)
     {
-        fprintf(out, "A total of %" PRIuMAX " unique words were found\n\n", hp_count(sort));
+        if (mergers[i].top)
+            wt_free(mergers[i].top, NULL);
 
-        /* Until heap is exausted, print the pair into the file */
-        while (!hp_empty(sort))
-        {
-            wc_pair wc;
-
-            if (!hp_remove(sort, &wc))
-            {
-                fprintf(stderr, "Failed to remove element from heap");
-            }
-            else
-            {
-                fprintf(out, "%s, %" PRIuMAX "\n", wc.word, wc.count);
-                free(wc.word);
-            }
-        }
+        wc_free(counters[i].counts, NULL);
+        cmc_intern_release(&(counters[i].words));
+    }
 
-        fclose(out);
+    for (size_t i = 0; i < n_files; i++)
+    {
+        if (files[i].data)
+            munmap((void *)files[i].data, files[i].size);
     }
 
-    hp_free(sort);
-    hm_free(result);
-    free(thread_args);
+    free(chunks);
+    free(files);
 
-    return 0;
+    return failed;
 }
-
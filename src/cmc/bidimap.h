@@ -16,7 +16,11 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_serial.h"
 #include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
 
 /**
  * BidiMap
@@ -24,18 +28,29 @@
  * A bidirectional map is a map that allows you to create a bijection in both
  * directions between two sets of elements (K <-> V).
  *
- * This implementation uses two arrays of pointers to an entry containing both
- * the key and the value.
+ * Implementation
+ *
+ * Every pair is stored in a dense array of entries, containing both the key
+ * and the value, in no particular order. Two hashtables with open addressing
+ * and robin hood hashing, one for keys and one for values, map to these entries
+ * through 32-bit slots holding the index of an entry plus one, so that a slot
+ * with 0 is empty. Both hashtables share a single allocation, so a map is only
+ * ever made of two buffers. Removing a pair moves the last entry to its place
+ * so the array is kept dense. A BidiMap can hold up to UINT32_MAX - 1 pairs.
+ *
+ * new_from builds a map from two arrays with its tables sized only once, and
+ * CMC_GENERATE_BIDIMAP_INVERT generates a function that turns a map of K -> V
+ * into one of V -> K by swapping the two hashtables, without rehashing.
  */
 
 /* to_string format */
-static const char *cmc_string_fmt_bidimap = "%s at %p { key_buffer:%p, val_buffer:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", load:%lf, key_cmp:%p, val_cmp:%p, key_hash:%p, val_hash:%p }";
-
-#ifndef CMC_ENTRY_DELETED
-
-#define CMC_ENTRY_DELETED ((void *)1)
+static const char *cmc_string_fmt_bidimap = "%s at %p { entries:%p, key_buffer:%p, val_buffer:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", load:%lf, key_cmp:%p, val_cmp:%p, key_hash:%p, val_hash:%p }";
 
-#endif /* CMC_ENTRY_DELETED */
+/* A removal shrinks a collection once less than this fraction of what it */
+/* can hold without growing is in use. Define it as 0 to never shrink */
+#ifndef CMC_SHRINK_LOW_WATER
+#define CMC_SHRINK_LOW_WATER 0.25
+#endif
 
 #ifndef CMC_IMPL_HASHTABLE_SETUP
 #define CMC_IMPL_HASHTABLE_SETUP
@@ -72,32 +87,353 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                               6917529027641081903,
                                               13835058055282163729llu};
 
+/* Smallest prime from cmc_hashtable_primes that is greater or equal to */
+/* required, found with a binary search. Used by the default (prime sized) */
+/* hashtables */
+static inline size_t cmc_hashtable_prime_size(size_t required)
+{
+    const size_t count = sizeof(cmc_hashtable_primes) / sizeof(cmc_hashtable_primes[0]);
+
+    if (cmc_hashtable_primes[count - 1] < required)
+        return required;
+
+    size_t low = 0;
+    size_t high = count - 1;
+
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+
+        if (cmc_hashtable_primes[mid] < required)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return cmc_hashtable_primes[low];
+}
+
+/* Prime sized tables reduce a hash to a slot with Lemire's fastmod, which */
+/* replaces the division of the modulo with a few multiplications by a */
+/* multiplier computed once for every capacity. Without 128 bit integers */
+/* the multiplier is not used and the modulo is kept */
+#if defined(__SIZEOF_INT128__) && SIZE_MAX == UINT64_MAX
+__extension__ typedef unsigned __int128 cmc_fastmod;
+
+static inline cmc_fastmod cmc_fastmod_new(size_t divisor)
+{
+    return divisor > 0 ? ~(cmc_fastmod)0 / divisor + 1 : 0;
+}
+
+static inline size_t cmc_fastmod_reduce(size_t value, cmc_fastmod multiplier, size_t divisor)
+{
+    /* The fractional part of value / divisor, multiplied by divisor */
+    cmc_fastmod fraction = multiplier * value;
+    cmc_fastmod low = ((fraction & UINT64_MAX) * divisor) >> 64;
+    cmc_fastmod high = (fraction >> 64) * divisor;
+
+    return (size_t)((low + high) >> 64);
+}
+#else
+typedef size_t cmc_fastmod;
+
+static inline cmc_fastmod cmc_fastmod_new(size_t divisor)
+{
+    (void)divisor;
+    return 0;
+}
+
+static inline size_t cmc_fastmod_reduce(size_t value, cmc_fastmod multiplier, size_t divisor)
+{
+    (void)multiplier;
+    return value % divisor;
+}
+#endif
+
+/* Smallest power of two that is greater or equal to required. Used by the */
+/* hashtables generated with the POW2 variants */
+static inline size_t cmc_hashtable_pow2_size(size_t required)
+{
+    size_t size = 64;
+
+    while (size < required && size <= SIZE_MAX / 2)
+        size <<= 1;
+
+    return size;
+}
+
+/* Power of two hashtables only look at the lower bits of a hash so they are */
+/* first passed through this finalizer (from MurmurHash3) to spread the */
+/* entropy of the upper bits */
+static inline size_t cmc_hashtable_mix(size_t hash)
+{
+    uint64_t h = (uint64_t)hash;
+
+    h ^= h >> 33;
+    h *= UINT64_C(0xff51afd7ed558ccd);
+    h ^= h >> 33;
+    h *= UINT64_C(0xc4ceb9fe1a85ec53);
+    h ^= h >> 33;
+
+    return (size_t)h;
+}
+
+/* Fraction of what a hashtable can hold under which a removal shrinks it. */
+/* Tables grow by a factor of 1 / load, so right after growing one is only */
+/* load full, and the mark is kept under half of that so that a table that */
+/* just grew is not shrunk by the next removals */
+static inline double cmc_hashtable_low_water(double load)
+{
+    return CMC_SHRINK_LOW_WATER < load / 2 ? CMC_SHRINK_LOW_WATER : load / 2;
+}
+
+/* Sizing policies selected by the SIZING parameter of the generators. PRIME */
+/* tables reduce a hash with a modulo and POW2 tables mix it and mask it */
+#define CMC_IMPL_HASHTABLE_PRIME_SIZE(required) cmc_hashtable_prime_size(required)
+#define CMC_IMPL_HASHTABLE_PRIME_HOME(hash, capacity) ((hash) % (capacity))
+#define CMC_IMPL_HASHTABLE_PRIME_WRAP(pos, capacity) ((pos) % (capacity))
+
+#define CMC_IMPL_HASHTABLE_POW2_SIZE(required) cmc_hashtable_pow2_size(required)
+#define CMC_IMPL_HASHTABLE_POW2_HOME(hash, capacity) (cmc_hashtable_mix(hash) & ((capacity)-1))
+#define CMC_IMPL_HASHTABLE_POW2_WRAP(pos, capacity) ((pos) & ((capacity)-1))
+
+/* The same for a table, where PRIME tables use the fastmod multiplier kept */
+/* next to their capacity */
+#define CMC_IMPL_HASHTABLE_PRIME_TABLE_HOME(hash, table) \
+    cmc_fastmod_reduce(hash, (table)->fastmod, (table)->capacity)
+#define CMC_IMPL_HASHTABLE_PRIME_TABLE_WRAP(pos, table) \
+    cmc_fastmod_reduce(pos, (table)->fastmod, (table)->capacity)
+
+#define CMC_IMPL_HASHTABLE_POW2_TABLE_HOME(hash, table) \
+    CMC_IMPL_HASHTABLE_POW2_HOME(hash, (table)->capacity)
+#define CMC_IMPL_HASHTABLE_POW2_TABLE_WRAP(pos, table) \
+    CMC_IMPL_HASHTABLE_POW2_WRAP(pos, (table)->capacity)
+
+/* Hashing policies selected by the HASHING parameter of the generators. */
+/* CACHED tables store the full hash of every key in its entry so that it */
+/* is compared before the keys themselves and reused when resizing */
+#define CMC_IMPL_HASHTABLE_CACHED(...) __VA_ARGS__
+#define CMC_IMPL_HASHTABLE_CACHED_EQUALS(cached, hash) ((cached) == (hash))
+#define CMC_IMPL_HASHTABLE_CACHED_REHASH(cached, computed) (cached)
+
+#define CMC_IMPL_HASHTABLE_UNCACHED(...)
+#define CMC_IMPL_HASHTABLE_UNCACHED_EQUALS(cached, hash) true
+#define CMC_IMPL_HASHTABLE_UNCACHED_REHASH(cached, computed) (computed)
+
+/* Batched lookups hash and prefetch the home slots of this many keys before */
+/* resolving any of their probes */
+#define CMC_IMPL_HASHTABLE_BATCH 16
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CMC_IMPL_HASHTABLE_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define CMC_IMPL_HASHTABLE_PREFETCH(address)
+#endif
+
 #endif /* CMC_IMPL_HASHTABLE_SETUP */
 
+#ifndef CMC_IMPL_HASHTABLE_STATS
+#define CMC_IMPL_HASHTABLE_STATS
+
+/* Amount of buckets of the histogram of distances of cmc_hashtable_stats. */
+/* The last bucket also counts every entry that is further away */
+#ifndef CMC_HASHTABLE_STATS_BUCKETS
+#define CMC_HASHTABLE_STATS_BUCKETS 16
+#endif
+
+/* Health of a hashtable, as reported by the stats function of every */
+/* hashtable collection */
+struct cmc_hashtable_stats
+{
+    /* Amount of slots (or buckets) of the table */
+    size_t capacity;
+
+    /* Amount of entries in the table */
+    size_t count;
+
+    /* Slots that are marked as deleted and still take part in probes */
+    size_t tombstones;
+
+    /* Current load, count / capacity */
+    double load;
+
+    /* Greatest distance of an entry to its original position */
+    size_t max_dist;
+
+    /* Average distance of an entry to its original position */
+    double mean_dist;
+
+    /* Amount of entries at each distance to their original position */
+    size_t histogram[CMC_HASHTABLE_STATS_BUCKETS];
+
+    /* Bytes allocated by the collection, not counting what K and V own */
+    size_t bytes;
+
+    /* Lookups done since the table was created */
+    size_t lookups;
+
+    /* Entries compared by these lookups */
+    size_t probes;
+};
+
+/* Adds the distance of an entry to stats. Until cmc_hashtable_stats_end() */
+/* is called mean_dist holds the sum of all distances */
+static inline void cmc_hashtable_stats_add(struct cmc_hashtable_stats *stats, size_t dist)
+{
+    if (dist < CMC_HASHTABLE_STATS_BUCKETS)
+        stats->histogram[dist]++;
+    else
+        stats->histogram[CMC_HASHTABLE_STATS_BUCKETS - 1]++;
+
+    if (dist > stats->max_dist)
+        stats->max_dist = dist;
+
+    stats->mean_dist += (double)dist;
+}
+
+/* Adds the finished stats of another table to stats, for collections made */
+/* of more than one hashtable */
+static inline void cmc_hashtable_stats_merge(struct cmc_hashtable_stats *stats,
+                                             struct cmc_hashtable_stats *other)
+{
+    size_t entries = 0;
+
+    for (size_t i = 0; i < CMC_HASHTABLE_STATS_BUCKETS; i++)
+    {
+        stats->histogram[i] += other->histogram[i];
+        entries += other->histogram[i];
+    }
+
+    if (other->max_dist > stats->max_dist)
+        stats->max_dist = other->max_dist;
+
+    stats->mean_dist += other->mean_dist * (double)entries;
+    stats->capacity += other->capacity;
+    stats->count += other->count;
+    stats->tombstones += other->tombstones;
+    stats->bytes += other->bytes;
+    stats->lookups += other->lookups;
+    stats->probes += other->probes;
+}
+
+/* Turns the sum of distances of stats into their mean and computes the load */
+static inline void cmc_hashtable_stats_end(struct cmc_hashtable_stats *stats)
+{
+    size_t entries = 0;
+
+    for (size_t i = 0; i < CMC_HASHTABLE_STATS_BUCKETS; i++)
+        entries += stats->histogram[i];
+
+    if (entries > 0)
+        stats->mean_dist /= (double)entries;
+
+    if (stats->capacity > 0)
+        stats->load = (double)stats->count / (double)stats->capacity;
+}
+
+/* Defining CMC_HASHTABLE_PROBE_STATS before including any hashtable makes */
+/* every table count its lookups and the entries they compare, reported as */
+/* lookups and probes by cmc_hashtable_stats. The counters are not atomic */
+/* so lookups that run concurrently without a lock are counted loosely */
+#ifdef CMC_HASHTABLE_PROBE_STATS
+#define CMC_IMPL_HASHTABLE_PROBE_FIELDS size_t lookups; size_t probes;
+#define CMC_IMPL_HASHTABLE_PROBE_RESET(table) ((table)->lookups = 0, (table)->probes = 0)
+#define CMC_IMPL_HASHTABLE_PROBE_LOOKUP(table) ((table)->lookups++)
+#define CMC_IMPL_HASHTABLE_PROBE_SLOT(table) ((table)->probes++)
+#define CMC_IMPL_HASHTABLE_PROBE_ADD(to, from) \
+    ((to)->lookups += (from)->lookups, (to)->probes += (from)->probes)
+#else
+#define CMC_IMPL_HASHTABLE_PROBE_FIELDS
+#define CMC_IMPL_HASHTABLE_PROBE_RESET(table) ((void)0)
+#define CMC_IMPL_HASHTABLE_PROBE_LOOKUP(table) ((void)0)
+#define CMC_IMPL_HASHTABLE_PROBE_SLOT(table) ((void)0)
+#define CMC_IMPL_HASHTABLE_PROBE_ADD(to, from) ((void)0)
+#endif
+
+#endif /* CMC_IMPL_HASHTABLE_STATS */
+
 #define CMC_GENERATE_BIDIMAP(PFX, SNAME, K, V)    \
     CMC_GENERATE_BIDIMAP_HEADER(PFX, SNAME, K, V) \
     CMC_GENERATE_BIDIMAP_SOURCE(PFX, SNAME, K, V)
 
+/* Same as CMC_GENERATE_BIDIMAP but tables are sized to powers of two */
+#define CMC_GENERATE_BIDIMAP_POW2(PFX, SNAME, K, V) \
+    CMC_GENERATE_BIDIMAP_HEADER(PFX, SNAME, K, V)   \
+    CMC_GENERATE_BIDIMAP_POW2_SOURCE(PFX, SNAME, K, V)
+
+/* Same as CMC_GENERATE_BIDIMAP but entries also store the hashes of their */
+/* key and value */
+#define CMC_GENERATE_BIDIMAP_CACHED(PFX, SNAME, K, V)    \
+    CMC_GENERATE_BIDIMAP_CACHED_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_BIDIMAP_CACHED_SOURCE(PFX, SNAME, K, V)
+
+/* Same as CMC_GENERATE_BIDIMAP but keys and values are compared and hashed */
+/* by calling KEY_CMP, KEY_HASH, VAL_CMP and VAL_HASH directly, so the */
+/* compiler can inline them. The functions given to new are still stored */
+/* but only used by copy_of and to_string */
+#define CMC_GENERATE_BIDIMAP_EX(PFX, SNAME, K, V, KEY_CMP, KEY_HASH, VAL_CMP, VAL_HASH) \
+    CMC_GENERATE_BIDIMAP_HEADER(PFX, SNAME, K, V)                                       \
+    CMC_GENERATE_BIDIMAP_EX_SOURCE(PFX, SNAME, K, V, KEY_CMP, KEY_HASH, VAL_CMP, VAL_HASH)
+
 #define CMC_WRAPGEN_BIDIMAP_HEADER(PFX, SNAME, K, V) \
     CMC_GENERATE_BIDIMAP_HEADER(PFX, SNAME, K, V)
 
 #define CMC_WRAPGEN_BIDIMAP_SOURCE(PFX, SNAME, K, V) \
     CMC_GENERATE_BIDIMAP_SOURCE(PFX, SNAME, K, V)
 
+#define CMC_WRAPGEN_BIDIMAP_POW2_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_BIDIMAP_HEADER(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_BIDIMAP_POW2_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_BIDIMAP_POW2_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_BIDIMAP_CACHED_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_BIDIMAP_CACHED_HEADER(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_BIDIMAP_CACHED_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_BIDIMAP_CACHED_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_GENERATE_BIDIMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_IMPL_BIDIMAP_HEADER(PFX, SNAME, K, V, UNCACHED)
+
+#define CMC_GENERATE_BIDIMAP_CACHED_HEADER(PFX, SNAME, K, V) \
+    CMC_IMPL_BIDIMAP_HEADER(PFX, SNAME, K, V, CACHED)
+
+#define CMC_GENERATE_BIDIMAP_SOURCE(PFX, SNAME, K, V)          \
+    CMC_IMPL_BIDIMAP_SOURCE(PFX, SNAME, K, V, PRIME, UNCACHED, \
+                            _map_->key_cmp, _map_->key_hash, _map_->val_cmp, _map_->val_hash)
+
+#define CMC_GENERATE_BIDIMAP_POW2_SOURCE(PFX, SNAME, K, V)    \
+    CMC_IMPL_BIDIMAP_SOURCE(PFX, SNAME, K, V, POW2, UNCACHED, \
+                            _map_->key_cmp, _map_->key_hash, _map_->val_cmp, _map_->val_hash)
+
+#define CMC_GENERATE_BIDIMAP_CACHED_SOURCE(PFX, SNAME, K, V) \
+    CMC_IMPL_BIDIMAP_SOURCE(PFX, SNAME, K, V, PRIME, CACHED, \
+                            _map_->key_cmp, _map_->key_hash, _map_->val_cmp, _map_->val_hash)
+
+#define CMC_GENERATE_BIDIMAP_EX_SOURCE(PFX, SNAME, K, V, KEY_CMP, KEY_HASH, VAL_CMP, VAL_HASH) \
+    CMC_IMPL_BIDIMAP_SOURCE(PFX, SNAME, K, V, PRIME, UNCACHED,                                 \
+                            KEY_CMP, KEY_HASH, VAL_CMP, VAL_HASH)
+
 /* HEADER ********************************************************************/
-#define CMC_GENERATE_BIDIMAP_HEADER(PFX, SNAME, K, V)                       \
+#define CMC_IMPL_BIDIMAP_HEADER(PFX, SNAME, K, V, HASHING)                  \
                                                                             \
     /* BidiMap Structure */                                                 \
     struct SNAME                                                            \
     {                                                                       \
-        /* Array of Entries mapping K -> V */                               \
-        struct SNAME##_entry **key_buffer;                                  \
+        /* Dense array of entries, the first count ones are in use */       \
+        struct SNAME##_entry *entries;                                      \
                                                                             \
-        /* Array of entries mapping V -> K */                               \
-        struct SNAME##_entry **val_buffer;                                  \
+        /* Hashtable mapping K -> entry index + 1 */                        \
+        uint32_t *key_buffer;                                               \
                                                                             \
-        /* Current arrays capacity */                                       \
+        /* Hashtable mapping V -> entry index + 1, shares key_buffer */     \
+        uint32_t *val_buffer;                                               \
+                                                                            \
+        /* Current hashtables capacity */                                   \
         size_t capacity;                                                    \
+        /* Multiplier of the capacity that reduces a hash to a slot */      \
+        cmc_fastmod fastmod;                                                \
                                                                             \
         /* Current amount of keys */                                        \
         size_t count;                                                       \
@@ -117,11 +453,17 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         /* Value hash function */                                           \
         size_t (*val_hash)(V);                                              \
                                                                             \
+        /* Lookup counters, only present with CMC_HASHTABLE_PROBE_STATS */  \
+        CMC_IMPL_HASHTABLE_PROBE_FIELDS                                     \
+                                                                            \
         /* Function that returns an iterator to the start of the bidimap */ \
         struct SNAME##_iter (*it_start)(struct SNAME *);                    \
                                                                             \
         /* Function that returns an iterator to the end of the bidimap */   \
         struct SNAME##_iter (*it_end)(struct SNAME *);                      \
+                                                                            \
+        /* Custom allocation functions */                                   \
+        struct cmc_alloc_node *alloc;                                       \
     };                                                                      \
                                                                             \
     /* BidiMap Entry */                                                     \
@@ -133,13 +475,17 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         /* Entry Value */                                                   \
         V value;                                                            \
                                                                             \
-        /* The distance of this node to its original position, used by */   \
+        /* The distance of this entry to its original position, used by */  \
         /* robin-hood hashing relative to the key_buffer */                 \
-        size_t key_dist;                                                    \
+        uint32_t key_dist;                                                  \
                                                                             \
-        /* The distance of this node to its original position, used by */   \
-        /* robin-hood hashing relative to the value_buffer */               \
-        size_t val_dist;                                                    \
+        /* The distance of this entry to its original position, used by */  \
+        /* robin-hood hashing relative to the val_buffer */                 \
+        uint32_t val_dist;                                                  \
+                                                                            \
+        /* The hashes of the key and of the value, only stored by CACHED */ \
+        /* tables */                                                        \
+        CMC_IMPL_HASHTABLE_##HASHING(size_t key_hash; size_t val_hash;)     \
     };                                                                      \
                                                                             \
     /* BidiMap Iterator */                                                  \
@@ -172,31 +518,67 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
     struct SNAME *PFX##_new(size_t capacity, double load,                   \
                             int (*key_cmp)(K, K), size_t (*key_hash)(K),    \
                             int (*val_cmp)(V, V), size_t (*val_hash)(V));   \
+    struct SNAME *PFX##_new_custom(size_t capacity, double load,            \
+                                   int (*key_cmp)(K, K),                    \
+                                   size_t (*key_hash)(K),                   \
+                                   int (*val_cmp)(V, V),                    \
+                                   size_t (*val_hash)(V),                   \
+                                   struct cmc_alloc_node *alloc);           \
+    struct SNAME *PFX##_new_from(K *keys, V *values, size_t n,              \
+                                 double load, int (*key_cmp)(K, K),         \
+                                 size_t (*key_hash)(K),                     \
+                                 int (*val_cmp)(V, V),                      \
+                                 size_t (*val_hash)(V));                    \
     void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V));       \
     void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V));        \
     /* Collection Input and Output */                                       \
     bool PFX##_insert(struct SNAME *_map_, K key, V value);                 \
+    size_t PFX##_insert_many(struct SNAME *_map_, K *keys, V *values,       \
+                             size_t n);                                     \
     bool PFX##_update_key(struct SNAME *_map_, K key, K *old_key);          \
     bool PFX##_update_val(struct SNAME *_map_, V val, V *old_val);          \
     bool PFX##_remove_by_key(struct SNAME *_map_, K key, V *out_value);     \
     bool PFX##_remove_by_val(struct SNAME *_map_, V value, K *out_key);     \
+    size_t PFX##_remove_if(struct SNAME *_map_, bool (*pred)(K, V),         \
+                           void (*deallocator)(K, V));                      \
     /* Element Access */                                                    \
     K PFX##_get_key(struct SNAME *_map_, V val);                            \
     V PFX##_get_val(struct SNAME *_map_, K key);                            \
     /* Collection State */                                                  \
     bool PFX##_contains_key(struct SNAME *_map_, K key);                    \
     bool PFX##_contains_val(struct SNAME *_map_, V val);                    \
-    bool PFX##_empty(struct SNAME *_map_);                                  \
+    CMC_PURE bool PFX##_empty(struct SNAME *_map_);                         \
     bool PFX##_full(struct SNAME *_map_);                                   \
-    size_t PFX##_count(struct SNAME *_map_);                                \
+    CMC_PURE size_t PFX##_count(struct SNAME *_map_);                       \
+    size_t PFX##_memory_usage(struct SNAME *_map_);                         \
     size_t PFX##_capacity(struct SNAME *_map_);                             \
     double PFX##_load(struct SNAME *_map_);                                 \
+    void PFX##_stats(struct SNAME *_map_, struct cmc_hashtable_stats *out); \
     /* Collection Utility */                                                \
     bool PFX##_resize(struct SNAME *_map_, size_t capacity);                \
+    bool PFX##_shrink_to_fit(struct SNAME *_map_);                          \
     struct SNAME *PFX##_copy_of(struct SNAME *_map_, K (*key_copy_func)(K), \
                                 V (*value_copy_func)(V));                   \
     bool PFX##_equals(struct SNAME *_map1_, struct SNAME *_map2_);          \
     struct cmc_string PFX##_to_string(struct SNAME *_map_);                 \
+    bool PFX##_to_string_full(struct SNAME *_map_,                          \
+                              struct cmc_string_builder *builder,           \
+                              const char *elem_fmt);                        \
+    bool PFX##_write(struct SNAME *_map_, FILE *file,                       \
+                     void (*fmt)(FILE *, K, V));                            \
+    bool PFX##_write_fd(struct SNAME *_map_, int fd,                        \
+                        void (*fmt)(struct cmc_dump *, K, V));              \
+    /* Collection Serialization */                                          \
+    bool PFX##_save(struct SNAME *_map_, FILE *file,                        \
+                    bool (*key_writer)(K, FILE *),                          \
+                    bool (*value_writer)(V, FILE *));                       \
+    struct SNAME *PFX##_restore(FILE *file, int (*key_cmp)(K, K),           \
+                                size_t (*key_hash)(K),                      \
+                                int (*val_cmp)(V, V),                       \
+                                size_t (*val_hash)(V),                      \
+                                bool (*key_reader)(K *, FILE *),            \
+                                bool (*value_reader)(V *, FILE *));         \
+                                                                            \
                                                                             \
     /* Iterator Functions */                                                \
     /* Iterator Allocation and Deallocation */                              \
@@ -221,17 +603,36 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
     size_t PFX##_iter_index(struct SNAME##_iter *iter);                     \
                                                                             \
 /* SOURCE ********************************************************************/
-#define CMC_GENERATE_BIDIMAP_SOURCE(PFX, SNAME, K, V)                                            \
+#define CMC_IMPL_BIDIMAP_SOURCE(PFX, SNAME, K, V, SIZING, HASHING, KEY_CMP, KEY_HASH,            \
+                                VAL_CMP, VAL_HASH)                                               \
                                                                                                  \
     /* Implementation Detail Functions */                                                        \
-    static struct SNAME##_entry *PFX##_impl_new_entry(K key, V value);                           \
-    static struct SNAME##_entry **PFX##_impl_get_entry_by_key(struct SNAME *_map_, K key);       \
-    static struct SNAME##_entry **PFX##_impl_get_entry_by_val(struct SNAME *_map_, V val);       \
-    static struct SNAME##_entry **PFX##_impl_add_entry_to_key(struct SNAME *_map_,               \
-                                                              struct SNAME##_entry *entry);      \
-    static struct SNAME##_entry **PFX##_impl_add_entry_to_val(struct SNAME *_map_,               \
-                                                              struct SNAME##_entry *entry);      \
+    static inline int PFX##_impl_key_cmp(struct SNAME *_map_, K a, K b);                         \
+    static inline size_t PFX##_impl_key_hash(struct SNAME *_map_, K key);                        \
+    static inline int PFX##_impl_val_cmp(struct SNAME *_map_, V a, V b);                         \
+    static inline size_t PFX##_impl_val_hash(struct SNAME *_map_, V value);                      \
+    static uint32_t *PFX##_impl_get_entry_by_key(struct SNAME *_map_, K key);                    \
+    static uint32_t *PFX##_impl_get_entry_by_val(struct SNAME *_map_, V val);                    \
+    static uint32_t *PFX##_impl_find_index_in_key(struct SNAME *_map_, uint32_t index);          \
+    static uint32_t *PFX##_impl_find_index_in_val(struct SNAME *_map_, uint32_t index);          \
+    static void PFX##_impl_add_entry_to_key(struct SNAME *_map_, uint32_t index);                \
+    static void PFX##_impl_add_entry_to_val(struct SNAME *_map_, uint32_t index);                \
+    static void PFX##_impl_remove_entry_from_key(struct SNAME *_map_, uint32_t *slot);           \
+    static void PFX##_impl_remove_entry_from_val(struct SNAME *_map_, uint32_t *slot);           \
+    static void PFX##_impl_remove_entry(struct SNAME *_map_, uint32_t *key_slot,                 \
+                                        uint32_t *val_slot);                                     \
+    static bool PFX##_impl_alloc_buffers(struct SNAME *_map_, size_t capacity);                  \
+    static bool PFX##_impl_rehash(struct SNAME *_map_, size_t capacity);                         \
+    static void PFX##_impl_low_water(struct SNAME *_map_);                                       \
+    static bool PFX##_impl_shrink(struct SNAME *_map_, size_t required);                         \
+    static struct SNAME *PFX##_impl_load_layout(FILE *file, int (*key_cmp)(K, K),                \
+                                                size_t (*key_hash)(K), int (*val_cmp)(V, V),     \
+                                                size_t (*val_hash)(V),                           \
+                                                struct cmc_serial_header *header);               \
+                                                                                                 \
     static size_t PFX##_impl_calculate_size(size_t required);                                    \
+    static inline size_t PFX##_impl_home(struct SNAME *_map_, size_t hash);                      \
+    static inline size_t PFX##_impl_wrap(struct SNAME *_map_, size_t pos);                       \
     static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_map_);                         \
     static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_map_);                           \
                                                                                                  \
@@ -239,6 +640,16 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                             int (*key_cmp)(K, K), size_t (*key_hash)(K),                         \
                             int (*val_cmp)(V, V), size_t (*val_hash)(V))                         \
     {                                                                                            \
+        return PFX##_new_custom(capacity, load, key_cmp, key_hash, val_cmp, val_hash, NULL);     \
+    }                                                                                            \
+                                                                                                 \
+    struct SNAME *PFX##_new_custom(size_t capacity, double load, int (*key_cmp)(K, K),           \
+                                   size_t (*key_hash)(K), int (*val_cmp)(V, V),                  \
+                                   size_t (*val_hash)(V), struct cmc_alloc_node *alloc)          \
+    {                                                                                            \
+        if (!alloc)                                                                              \
+            alloc = &cmc_alloc_node_default;                                                     \
+                                                                                                 \
         if (capacity == 0 || load <= 0 || load >= 1)                                             \
             return NULL;                                                                         \
                                                                                                  \
@@ -246,56 +657,88 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         if (capacity >= UINTMAX_MAX * load)                                                      \
             return NULL;                                                                         \
                                                                                                  \
-        size_t real_capacity = PFX##_impl_calculate_size(capacity / load);                       \
+        struct SNAME *_map_ = alloc->malloc(sizeof(struct SNAME));                               \
                                                                                                  \
-        struct SNAME *_map_ = malloc(sizeof(struct SNAME));                                      \
-                                                                                                 \
-        if (!_map_)                                                                              \
+        if (CMC_UNLIKELY(!_map_))                                                                \
             return NULL;                                                                         \
                                                                                                  \
-        _map_->key_buffer = calloc(real_capacity, sizeof(struct SNAME##_entry *));               \
-        _map_->val_buffer = calloc(real_capacity, sizeof(struct SNAME##_entry *));               \
+        _map_->alloc = alloc;                                                                    \
                                                                                                  \
-        if (!_map_->key_buffer || !_map_->val_buffer)                                            \
+        _map_->entries = NULL;                                                                   \
+        _map_->key_buffer = NULL;                                                                \
+        _map_->val_buffer = NULL;                                                                \
+        _map_->count = 0;                                                                        \
+        _map_->load = load;                                                                      \
+                                                                                                 \
+        if (!PFX##_impl_alloc_buffers(_map_, PFX##_impl_calculate_size(capacity / load)))        \
         {                                                                                        \
-            free(_map_->key_buffer);                                                             \
-            free(_map_->val_buffer);                                                             \
-            free(_map_);                                                                         \
+            alloc->free(_map_);                                                                  \
             return NULL;                                                                         \
         }                                                                                        \
                                                                                                  \
-        _map_->count = 0;                                                                        \
-        _map_->capacity = real_capacity;                                                         \
-        _map_->load = load;                                                                      \
         _map_->key_cmp = key_cmp;                                                                \
         _map_->val_cmp = val_cmp;                                                                \
         _map_->key_hash = key_hash;                                                              \
         _map_->val_hash = val_hash;                                                              \
                                                                                                  \
+        CMC_IMPL_HASHTABLE_PROBE_RESET(_map_);                                                   \
+                                                                                                 \
         _map_->it_start = PFX##_impl_it_start;                                                   \
         _map_->it_end = PFX##_impl_it_end;                                                       \
                                                                                                  \
         return _map_;                                                                            \
     }                                                                                            \
                                                                                                  \
-    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V))                             \
+    /* Builds a map of n pairs with both tables sized once, each pair written */                 \
+    /* straight to the next entry. A pair whose key or value is already in */                    \
+    /* the map is skipped, as insert would */                                                    \
+    struct SNAME *PFX##_new_from(K *keys, V *values, size_t n, double load,                      \
+                                 int (*key_cmp)(K, K), size_t (*key_hash)(K),                    \
+                                 int (*val_cmp)(V, V), size_t (*val_hash)(V))                    \
     {                                                                                            \
-        for (size_t i = 0; i < _map_->capacity; i++)                                             \
+        struct SNAME *_map_ =                                                                    \
+            PFX##_new(n > 0 ? n : 1, load, key_cmp, key_hash, val_cmp, val_hash);                \
+                                                                                                 \
+        if (CMC_UNLIKELY(!_map_))                                                                \
+            return NULL;                                                                         \
+                                                                                                 \
+        for (size_t i = 0; i < n; i++)                                                           \
         {                                                                                        \
-            struct SNAME##_entry *entry = _map_->key_buffer[i];                                  \
+            K key = keys[i];                                                                     \
+            V value = values[i];                                                                 \
                                                                                                  \
-            if (entry != NULL && entry != CMC_ENTRY_DELETED)                                     \
-            {                                                                                    \
-                if (deallocator)                                                                 \
-                    deallocator(entry->key, entry->value);                                       \
+            if (PFX##_impl_get_entry_by_key(_map_, key) != NULL ||                               \
+                PFX##_impl_get_entry_by_val(_map_, value) != NULL)                               \
+                continue;                                                                        \
                                                                                                  \
-                free(entry);                                                                     \
-            }                                                                                    \
+            uint32_t index = (uint32_t)_map_->count;                                             \
+                                                                                                 \
+            struct SNAME##_entry *entry = &(_map_->entries[index]);                              \
+                                                                                                 \
+            entry->key = key;                                                                    \
+            entry->value = value;                                                                \
+            CMC_IMPL_HASHTABLE_##HASHING(entry->key_hash = PFX##_impl_key_hash(_map_, key);)     \
+            CMC_IMPL_HASHTABLE_##HASHING(entry->val_hash = PFX##_impl_val_hash(_map_, value);)   \
+                                                                                                 \
+            PFX##_impl_add_entry_to_key(_map_, index);                                           \
+            PFX##_impl_add_entry_to_val(_map_, index);                                           \
+                                                                                                 \
+            _map_->count++;                                                                      \
+        }                                                                                        \
+                                                                                                 \
+        return _map_;                                                                            \
+    }                                                                                            \
                                                                                                  \
-            _map_->key_buffer[i] = NULL;                                                         \
-            _map_->val_buffer[i] = NULL;                                                         \
+    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V))                             \
+    {                                                                                            \
+        if (deallocator)                                                                         \
+        {                                                                                        \
+            for (size_t i = 0; i < _map_->count; i++)                                            \
+                deallocator(_map_->entries[i].key, _map_->entries[i].value);                     \
         }                                                                                        \
                                                                                                  \
+        memset(_map_->key_buffer, 0, sizeof(uint32_t) * _map_->capacity * 2);                    \
+                                                                                                 \
         _map_->count = 0;                                                                        \
     }                                                                                            \
                                                                                                  \
@@ -303,16 +746,16 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
     {                                                                                            \
         PFX##_clear(_map_, deallocator);                                                         \
                                                                                                  \
-        free(_map_->key_buffer);                                                                 \
-        free(_map_->val_buffer);                                                                 \
-        free(_map_);                                                                             \
+        _map_->alloc->free(_map_->entries);                                                      \
+        _map_->alloc->free(_map_->key_buffer);                                                   \
+        _map_->alloc->free(_map_);                                                               \
     }                                                                                            \
                                                                                                  \
     bool PFX##_insert(struct SNAME *_map_, K key, V value)                                       \
     {                                                                                            \
         if (PFX##_full(_map_))                                                                   \
         {                                                                                        \
-            if (!PFX##_resize(_map_, PFX##_capacity(_map_) + 1))                                 \
+            if (CMC_UNLIKELY(!PFX##_resize(_map_, PFX##_capacity(_map_) + 1)))                   \
                 return false;                                                                    \
         }                                                                                        \
                                                                                                  \
@@ -320,28 +763,42 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
             PFX##_impl_get_entry_by_val(_map_, value) != NULL)                                   \
             return false;                                                                        \
                                                                                                  \
-        struct SNAME##_entry *entry = PFX##_impl_new_entry(key, value);                          \
-                                                                                                 \
-        struct SNAME##_entry **key_entry = PFX##_impl_add_entry_to_key(_map_, entry);            \
-        struct SNAME##_entry **val_entry = PFX##_impl_add_entry_to_val(_map_, entry);            \
+        uint32_t index = (uint32_t)_map_->count;                                                 \
                                                                                                  \
-        if (!key_entry || !val_entry)                                                            \
-        {                                                                                        \
-            if (key_entry)                                                                       \
-                *key_entry = CMC_ENTRY_DELETED;                                                  \
-            if (val_entry)                                                                       \
-                *val_entry = CMC_ENTRY_DELETED;                                                  \
+        struct SNAME##_entry *entry = &(_map_->entries[index]);                                  \
                                                                                                  \
-            free(entry);                                                                         \
+        entry->key = key;                                                                        \
+        entry->value = value;                                                                    \
+        entry->key_dist = 0;                                                                     \
+        entry->val_dist = 0;                                                                     \
+        CMC_IMPL_HASHTABLE_##HASHING(entry->key_hash = PFX##_impl_key_hash(_map_, key);)         \
+        CMC_IMPL_HASHTABLE_##HASHING(entry->val_hash = PFX##_impl_val_hash(_map_, value);)       \
                                                                                                  \
-            return false;                                                                        \
-        }                                                                                        \
+        PFX##_impl_add_entry_to_key(_map_, index);                                               \
+        PFX##_impl_add_entry_to_val(_map_, index);                                               \
                                                                                                  \
         _map_->count++;                                                                          \
                                                                                                  \
         return true;                                                                             \
     }                                                                                            \
                                                                                                  \
+    size_t PFX##_insert_many(struct SNAME *_map_, K *keys, V *values, size_t n)                  \
+    {                                                                                            \
+        /* Grow once for every pair instead of one threshold at a time */                        \
+        if (CMC_UNLIKELY(!PFX##_resize(_map_, PFX##_count(_map_) + n)))                          \
+            return 0;                                                                            \
+                                                                                                 \
+        size_t total = 0;                                                                        \
+                                                                                                 \
+        for (size_t i = 0; i < n; i++)                                                           \
+        {                                                                                        \
+            if (PFX##_insert(_map_, keys[i], values[i]))                                         \
+                total++;                                                                         \
+        }                                                                                        \
+                                                                                                 \
+        return total;                                                                            \
+    }                                                                                            \
+                                                                                                 \
     bool PFX##_update_key(struct SNAME *_map_, K key, K *old_key)                                \
     {                                                                                            \
         if (PFX##_empty(_map_))                                                                  \
@@ -360,38 +817,103 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                  \
     bool PFX##_remove_by_key(struct SNAME *_map_, K key, V *out_value)                           \
     {                                                                                            \
-        if (PFX##_empty(_map_))                                                                  \
+        uint32_t *key_slot = PFX##_impl_get_entry_by_key(_map_, key);                            \
+                                                                                                 \
+        if (!key_slot)                                                                           \
             return false;                                                                        \
                                                                                                  \
+        uint32_t *val_slot = PFX##_impl_find_index_in_val(_map_, *key_slot - 1);                 \
+                                                                                                 \
+        if (out_value)                                                                           \
+            *out_value = _map_->entries[*key_slot - 1].value;                                    \
+                                                                                                 \
+        PFX##_impl_remove_entry(_map_, key_slot, val_slot);                                      \
+                                                                                                 \
+        PFX##_impl_low_water(_map_);                                                             \
+                                                                                                 \
         return true;                                                                             \
     }                                                                                            \
                                                                                                  \
     bool PFX##_remove_by_val(struct SNAME *_map_, V value, K *out_key)                           \
     {                                                                                            \
-        if (PFX##_empty(_map_))                                                                  \
+        uint32_t *val_slot = PFX##_impl_get_entry_by_val(_map_, value);                          \
+                                                                                                 \
+        if (!val_slot)                                                                           \
             return false;                                                                        \
                                                                                                  \
+        uint32_t *key_slot = PFX##_impl_find_index_in_key(_map_, *val_slot - 1);                 \
+                                                                                                 \
+        if (out_key)                                                                             \
+            *out_key = _map_->entries[*val_slot - 1].key;                                        \
+                                                                                                 \
+        PFX##_impl_remove_entry(_map_, key_slot, val_slot);                                      \
+                                                                                                 \
+        PFX##_impl_low_water(_map_);                                                             \
+                                                                                                 \
         return true;                                                                             \
     }                                                                                            \
                                                                                                  \
+    /* Removes every entry for which pred is true. The array of entries is */                    \
+    /* compacted in a single pass and both hashtables are then rebuilt from */                   \
+    /* it. Returns how many were removed */                                                      \
+    size_t PFX##_remove_if(struct SNAME *_map_, bool (*pred)(K, V),                              \
+                           void (*deallocator)(K, V))                                            \
+    {                                                                                            \
+        size_t kept = 0;                                                                         \
+                                                                                                 \
+        for (size_t i = 0; i < _map_->count; i++)                                                \
+        {                                                                                        \
+            struct SNAME##_entry *entry = &(_map_->entries[i]);                                  \
+                                                                                                 \
+            if (pred(entry->key, entry->value))                                                  \
+            {                                                                                    \
+                if (deallocator)                                                                 \
+                    deallocator(entry->key, entry->value);                                       \
+                                                                                                 \
+                continue;                                                                        \
+            }                                                                                    \
+                                                                                                 \
+            _map_->entries[kept++] = *entry;                                                     \
+        }                                                                                        \
+                                                                                                 \
+        size_t removed = _map_->count - kept;                                                    \
+                                                                                                 \
+        if (removed == 0)                                                                        \
+            return 0;                                                                            \
+                                                                                                 \
+        memset(_map_->key_buffer, 0, sizeof(uint32_t) * _map_->capacity * 2);                    \
+                                                                                                 \
+        for (uint32_t i = 0; i < kept; i++)                                                      \
+        {                                                                                        \
+            PFX##_impl_add_entry_to_key(_map_, i);                                               \
+            PFX##_impl_add_entry_to_val(_map_, i);                                               \
+        }                                                                                        \
+                                                                                                 \
+        _map_->count = kept;                                                                     \
+                                                                                                 \
+        PFX##_impl_low_water(_map_);                                                             \
+                                                                                                 \
+        return removed;                                                                          \
+    }                                                                                            \
+                                                                                                 \
     K PFX##_get_key(struct SNAME *_map_, V val)                                                  \
     {                                                                                            \
-        struct SNAME##_entry **entry = PFX##_impl_get_entry_by_val(_map_, val);                  \
+        uint32_t *slot = PFX##_impl_get_entry_by_val(_map_, val);                                \
                                                                                                  \
-        if (!entry)                                                                              \
-            return (V){0};                                                                       \
+        if (!slot)                                                                               \
+            return (K){0};                                                                       \
                                                                                                  \
-        return (*entry)->key;                                                                    \
+        return _map_->entries[*slot - 1].key;                                                    \
     }                                                                                            \
                                                                                                  \
     V PFX##_get_val(struct SNAME *_map_, K key)                                                  \
     {                                                                                            \
-        struct SNAME##_entry **entry = PFX##_impl_get_entry_by_key(_map_, key);                  \
+        uint32_t *slot = PFX##_impl_get_entry_by_key(_map_, key);                                \
                                                                                                  \
-        if (!entry)                                                                              \
+        if (!slot)                                                                               \
             return (V){0};                                                                       \
                                                                                                  \
-        return (*entry)->value;                                                                  \
+        return _map_->entries[*slot - 1].value;                                                  \
     }                                                                                            \
                                                                                                  \
     bool PFX##_contains_key(struct SNAME *_map_, K key)                                          \
@@ -419,6 +941,14 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return _map_->count;                                                                     \
     }                                                                                            \
                                                                                                  \
+    size_t PFX##_memory_usage(struct SNAME *_map_)                                               \
+    {                                                                                            \
+        size_t entries_capacity = (size_t)((double)_map_->capacity * _map_->load) + 1;           \
+                                                                                                 \
+        return sizeof(struct SNAME) + sizeof(struct SNAME##_entry) * entries_capacity +          \
+               sizeof(uint32_t) * _map_->capacity * 2;                                           \
+    }                                                                                            \
+                                                                                                 \
     size_t PFX##_capacity(struct SNAME *_map_)                                                   \
     {                                                                                            \
         return _map_->capacity;                                                                  \
@@ -429,6 +959,29 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return _map_->load;                                                                      \
     }                                                                                            \
                                                                                                  \
+    void PFX##_stats(struct SNAME *_map_, struct cmc_hashtable_stats *out)                       \
+    {                                                                                            \
+        memset(out, 0, sizeof(struct cmc_hashtable_stats));                                      \
+                                                                                                 \
+        size_t entries_capacity = (size_t)((double)_map_->capacity * _map_->load) + 1;           \
+                                                                                                 \
+        out->capacity = _map_->capacity;                                                         \
+        out->count = _map_->count;                                                               \
+        out->bytes = sizeof(struct SNAME) + sizeof(struct SNAME##_entry) * entries_capacity +    \
+                     sizeof(uint32_t) * _map_->capacity * 2;                                     \
+                                                                                                 \
+        /* Both hashtables go to the same histogram */                                           \
+        for (size_t i = 0; i < _map_->count; i++)                                                \
+        {                                                                                        \
+            cmc_hashtable_stats_add(out, _map_->entries[i].key_dist);                            \
+            cmc_hashtable_stats_add(out, _map_->entries[i].val_dist);                            \
+        }                                                                                        \
+                                                                                                 \
+        CMC_IMPL_HASHTABLE_PROBE_ADD(out, _map_);                                                \
+                                                                                                 \
+        cmc_hashtable_stats_end(out);                                                            \
+    }                                                                                            \
+                                                                                                 \
     bool PFX##_resize(struct SNAME *_map_, size_t capacity)                                      \
     {                                                                                            \
         if (PFX##_capacity(_map_) == capacity)                                                   \
@@ -442,92 +995,48 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
             return false;                                                                        \
                                                                                                  \
         /* Calculate required capacity based on the prime numbers */                             \
-        size_t new_cap = PFX##_impl_calculate_size(capacity);                                    \
+        size_t new_cap = PFX##_impl_calculate_size(capacity / PFX##_load(_map_));                \
                                                                                                  \
         /* Not possible to shrink with current available prime numbers */                        \
         if (new_cap < PFX##_count(_map_) / PFX##_load(_map_))                                    \
             return false;                                                                        \
                                                                                                  \
-        struct SNAME *_new_map_ = PFX##_new(capacity, PFX##_load(_map_),                         \
-                                            _map_->key_cmp, _map_->key_hash,                     \
-                                            _map_->val_cmp, _map_->val_hash);                    \
-                                                                                                 \
-        if (!_new_map_)                                                                          \
-            return false;                                                                        \
-                                                                                                 \
-        for (size_t i = 0; i < _map_->capacity; i++)                                             \
-        {                                                                                        \
-            struct SNAME##_entry *scan = _map_->key_buffer[i];                                   \
-                                                                                                 \
-            if (scan && scan != CMC_ENTRY_DELETED)                                               \
-            {                                                                                    \
-                struct SNAME##_entry **e1 = PFX##_impl_add_entry_to_key(_new_map_, scan);        \
-                struct SNAME##_entry **e2 = PFX##_impl_add_entry_to_val(_new_map_, scan);        \
-                                                                                                 \
-                if (!e1 || !e2)                                                                  \
-                {                                                                                \
-                    free(_new_map_->key_buffer);                                                 \
-                    free(_new_map_->val_buffer);                                                 \
-                    free(_new_map_);                                                             \
-                                                                                                 \
-                    return false;                                                                \
-                }                                                                                \
-                                                                                                 \
-                _new_map_->count++;                                                              \
-            }                                                                                    \
-        }                                                                                        \
-                                                                                                 \
-        if (PFX##_count(_map_) != PFX##_count(_new_map_))                                        \
-        {                                                                                        \
-            free(_new_map_->key_buffer);                                                         \
-            free(_new_map_->val_buffer);                                                         \
-            free(_new_map_);                                                                     \
-                                                                                                 \
-            return false;                                                                        \
-        }                                                                                        \
-                                                                                                 \
-        struct SNAME##_entry **tmp_key_buf = _map_->key_buffer;                                  \
-        struct SNAME##_entry **tmp_val_buf = _map_->val_buffer;                                  \
-                                                                                                 \
-        _map_->key_buffer = _new_map_->key_buffer;                                               \
-        _map_->val_buffer = _new_map_->val_buffer;                                               \
-        _map_->capacity = _new_map_->capacity;                                                   \
-                                                                                                 \
-        free(tmp_key_buf);                                                                       \
-        free(tmp_val_buf);                                                                       \
-        free(_new_map_);                                                                         \
+        return PFX##_impl_rehash(_map_, new_cap);                                                \
+    }                                                                                            \
                                                                                                  \
-        return true;                                                                             \
+    bool PFX##_shrink_to_fit(struct SNAME *_map_)                                                \
+    {                                                                                            \
+        return PFX##_impl_shrink(_map_, PFX##_count(_map_));                                     \
     }                                                                                            \
                                                                                                  \
     struct SNAME *PFX##_copy_of(struct SNAME *_map_, K (*key_copy_func)(K),                      \
                                 V (*value_copy_func)(V))                                         \
     {                                                                                            \
-        struct SNAME *result = PFX##_new(PFX##_capacity(_map_), PFX##_load(_map_),               \
-                                         _map_->key_cmp, _map_->key_hash,                        \
-                                         _map_->val_cmp, _map_->val_hash);                       \
+        struct SNAME *result = PFX##_new_custom(PFX##_capacity(_map_), PFX##_load(_map_),        \
+                                                _map_->key_cmp, _map_->key_hash,                 \
+                                                _map_->val_cmp, _map_->val_hash, _map_->alloc);  \
+                                                                                                 \
+        if (CMC_UNLIKELY(!result))                                                               \
+            return NULL;                                                                         \
                                                                                                  \
-        for (size_t i = 0; i < _map_->capacity; i++)                                             \
+        for (size_t i = 0; i < _map_->count; i++)                                                \
         {                                                                                        \
-            struct SNAME##_entry *scan = _map_->key_buffer[i];                                   \
+            struct SNAME##_entry *scan = &(_map_->entries[i]);                                   \
                                                                                                  \
-            if (scan && scan != CMC_ENTRY_DELETED)                                               \
-            {                                                                                    \
-                K tmp_key;                                                                       \
-                V tmp_val;                                                                       \
+            K tmp_key;                                                                           \
+            V tmp_val;                                                                           \
                                                                                                  \
-                if (key_copy_func)                                                               \
-                    tmp_key = key_copy_func(scan->key);                                          \
-                else                                                                             \
-                    tmp_key = scan->key;                                                         \
+            if (key_copy_func)                                                                   \
+                tmp_key = key_copy_func(scan->key);                                              \
+            else                                                                                 \
+                tmp_key = scan->key;                                                             \
                                                                                                  \
-                if (value_copy_func)                                                             \
-                    tmp_val = value_copy_func(scan->value);                                      \
-                else                                                                             \
-                    tmp_val = scan->value;                                                       \
+            if (value_copy_func)                                                                 \
+                tmp_val = value_copy_func(scan->value);                                          \
+            else                                                                                 \
+                tmp_val = scan->value;                                                           \
                                                                                                  \
-                PFX##_insert(result, tmp_key, tmp_val);                                          \
-            }                                                                                    \
+            PFX##_insert(result, tmp_key, tmp_val);                                              \
         }                                                                                        \
                                                                                                  \
         return result;                                                                           \
@@ -538,34 +1047,19 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         if (PFX##_count(_map1_) != PFX##_count(_map2_))                                          \
             return false;                                                                        \
                                                                                                  \
-        struct SNAME *_mapA_;                                                                    \
-        struct SNAME *_mapB_;                                                                    \
-                                                                                                 \
-        if (PFX##_capacity(_map1_) < PFX##_capacity(_map2_))                                     \
+        for (size_t i = 0; i < _map1_->count; i++)                                               \
         {                                                                                        \
-            _mapA_ = _map1_;                                                                     \
-            _mapB_ = _map2_;                                                                     \
-        }                                                                                        \
-        else                                                                                     \
-        {                                                                                        \
-            _mapA_ = _map2_;                                                                     \
-            _mapB_ = _map1_;                                                                     \
-        }                                                                                        \
+            struct SNAME##_entry *scan = &(_map1_->entries[i]);                                  \
                                                                                                  \
-        for (size_t i = 0; i < _mapA_->capacity; i++)                                            \
-        {                                                                                        \
-            struct SNAME##_entry *scan = _mapA_->key_buffer[i];                                  \
+            uint32_t *slot_B = PFX##_impl_get_entry_by_key(_map2_, scan->key);                   \
                                                                                                  \
-            if (scan && scan != CMC_ENTRY_DELETED)                                               \
-            {                                                                                    \
-                struct SNAME##_entry **entry_B = PFX##_impl_get_entry_by_key(_mapB_, scan->key); \
+            if (!slot_B)                                                                         \
+                return false;                                                                    \
                                                                                                  \
-                if (!entry_B)                                                                    \
-                    return false;                                                                \
+            V value_B = _map2_->entries[*slot_B - 1].value;                                      \
                                                                                                  \
-                if (_mapA_->val_cmp((*entry_B)->value, scan->value) != 0)                        \
-                    return false;                                                                \
-            }                                                                                    \
+            if (PFX##_impl_val_cmp(_map1_, value_B, scan->value) != 0)                           \
+                return false;                                                                    \
         }                                                                                        \
                                                                                                  \
         return true;                                                                             \
@@ -578,17 +1072,101 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         const char *name = #SNAME;                                                               \
                                                                                                  \
         snprintf(str.s, cmc_string_len, cmc_string_fmt_bidimap,                                  \
-                 name, m_, m_->key_buffer, m_->val_buffer, m_->capacity, m_->count,              \
+                 name, m_, m_->entries, m_->key_buffer, m_->val_buffer, m_->capacity, m_->count, \
                  m_->load, m_->key_cmp, m_->val_cmp, m_->key_hash, m_->val_hash);                \
                                                                                                  \
         return str;                                                                              \
     }                                                                                            \
                                                                                                  \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_ENTRY)                               \
+                                                                                                 \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_ENTRY, (K, V))                              \
+                                                                                                 \
+    bool PFX##_save(struct SNAME *_map_, FILE *file, bool (*key_writer)(K, FILE *),              \
+                    bool (*value_writer)(V, FILE *))                                             \
+    {                                                                                            \
+        uint32_t flags = (key_writer ? 0 : CMC_SERIAL_RAW_KEYS) |                                \
+                         (value_writer ? 0 : CMC_SERIAL_RAW_VALUES);                             \
+                                                                                                 \
+        if (!key_writer && !value_writer)                                                        \
+            flags |= CMC_SERIAL_LAYOUT;                                                          \
+                                                                                                 \
+        if (!cmc_serial_write_header(file, "bidimap", flags, sizeof(K), sizeof(V),               \
+                                     sizeof(struct SNAME##_entry), _map_->count,                 \
+                                     _map_->capacity, _map_->load))                              \
+            return false;                                                                        \
+                                                                                                 \
+        /* Without any writer the entries in use and both hashtables are */                      \
+        /* written as they are in memory */                                                      \
+        if (flags & CMC_SERIAL_LAYOUT)                                                           \
+        {                                                                                        \
+            size_t slots = _map_->capacity * 2;                                                  \
+                                                                                                 \
+            return fwrite(_map_->entries, sizeof(struct SNAME##_entry), _map_->count, file) ==   \
+                       _map_->count &&                                                           \
+                   fwrite(_map_->key_buffer, sizeof(uint32_t), slots, file) == slots;            \
+        }                                                                                        \
+                                                                                                 \
+        for (size_t i = 0; i < _map_->count; i++)                                                \
+        {                                                                                        \
+            if (!CMC_SERIAL_WRITE(key_writer, _map_->entries[i].key, file) ||                    \
+                !CMC_SERIAL_WRITE(value_writer, _map_->entries[i].value, file))                  \
+                return false;                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* A map saved without writers is restored without hashing its keys and */                   \
+    /* values so it must be given the same hash functions it was saved with. */                  \
+    /* Otherwise each reader is only used if the keys or values were saved */                    \
+    /* with a writer */                                                                          \
+    struct SNAME *PFX##_restore(FILE *file, int (*key_cmp)(K, K), size_t (*key_hash)(K),         \
+                                int (*val_cmp)(V, V), size_t (*val_hash)(V),                     \
+                                bool (*key_reader)(K *, FILE *),                                 \
+                                bool (*value_reader)(V *, FILE *))                               \
+    {                                                                                            \
+        struct cmc_serial_header header;                                                         \
+                                                                                                 \
+        if (!cmc_serial_read_header(file, "bidimap", sizeof(K), sizeof(V), &header))             \
+            return NULL;                                                                         \
+                                                                                                 \
+        if (header.flags & CMC_SERIAL_LAYOUT)                                                    \
+            return PFX##_impl_load_layout(file, key_cmp, key_hash, val_cmp, val_hash, &header);  \
+                                                                                                 \
+        /* Allocated for every pair so that restoring never grows */                             \
+        struct SNAME *_map_ = PFX##_new(header.count > 0 ? header.count : 1, header.load,        \
+                                        key_cmp, key_hash, val_cmp, val_hash);                   \
+                                                                                                 \
+        if (CMC_UNLIKELY(!_map_))                                                                \
+            return NULL;                                                                         \
+                                                                                                 \
+        bool raw_keys = header.flags & CMC_SERIAL_RAW_KEYS;                                      \
+        bool raw_values = header.flags & CMC_SERIAL_RAW_VALUES;                                  \
+                                                                                                 \
+        for (size_t i = 0; i < header.count; i++)                                                \
+        {                                                                                        \
+            K key;                                                                               \
+            V value;                                                                             \
+                                                                                                 \
+            if (!CMC_SERIAL_READ(raw_keys, key_reader, &key, file) ||                            \
+                !CMC_SERIAL_READ(raw_values, value_reader, &value, file) ||                      \
+                !PFX##_insert(_map_, key, value))                                                \
+            {                                                                                    \
+                PFX##_free(_map_, NULL);                                                         \
+                return NULL;                                                                     \
+            }                                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        return _map_;                                                                            \
+    }                                                                                            \
+                                                                                                 \
+                                                                                                 \
     struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                    \
     {                                                                                            \
-        struct SNAME##_iter *iter = malloc(sizeof(struct SNAME##_iter));                         \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));          \
                                                                                                  \
-        if (!iter)                                                                               \
+        if (CMC_UNLIKELY(!iter))                                                                 \
             return NULL;                                                                         \
                                                                                                  \
         PFX##_iter_init(iter, target);                                                           \
@@ -598,7 +1176,7 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                  \
     void PFX##_iter_free(struct SNAME##_iter *iter)                                              \
     {                                                                                            \
-        free(iter);                                                                              \
+        iter->target->alloc->free(iter);                                                         \
     }                                                                                            \
                                                                                                  \
     void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                        \
@@ -609,31 +1187,13 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         iter->start = true;                                                                      \
         iter->end = PFX##_empty(target);                                                         \
                                                                                                  \
+        /* Entries are dense so the iteration goes through indexes */                            \
+        /* [0, count - 1] of the entries array */                                                \
         if (!PFX##_empty(target))                                                                \
         {                                                                                        \
-            for (size_t i = 0; i < target->capacity; i++)                                        \
-            {                                                                                    \
-                struct SNAME##_entry *tmp = target->key_buffer[i];                               \
-                                                                                                 \
-                if (tmp != NULL && tmp != CMC_ENTRY_DELETED)                                     \
-                {                                                                                \
-                    iter->first = i;                                                             \
-                    break;                                                                       \
-                }                                                                                \
-            }                                                                                    \
-                                                                                                 \
+            iter->first = 0;                                                                     \
+            iter->last = PFX##_count(target) - 1;                                                \
             iter->cursor = iter->first;                                                          \
-                                                                                                 \
-            for (size_t i = target->capacity; i > 0; i--)                                        \
-            {                                                                                    \
-                struct SNAME##_entry *tmp = target->key_buffer[i - 1];                           \
-                                                                                                 \
-                if (tmp != NULL && tmp != CMC_ENTRY_DELETED)                                     \
-                {                                                                                \
-                    iter->last = i - 1;                                                          \
-                    break;                                                                       \
-                }                                                                                \
-            }                                                                                    \
         }                                                                                        \
     }                                                                                            \
                                                                                                  \
@@ -682,18 +1242,8 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                  \
         iter->start = PFX##_empty(iter->target);                                                 \
                                                                                                  \
-        struct SNAME##_entry *scan = iter->target->key_buffer[iter->cursor];                     \
-                                                                                                 \
         iter->index++;                                                                           \
-                                                                                                 \
-        while (1)                                                                                \
-        {                                                                                        \
-            iter->cursor++;                                                                      \
-            scan = iter->target->key_buffer[iter->cursor];                                       \
-                                                                                                 \
-            if (scan != NULL && scan != CMC_ENTRY_DELETED)                                       \
-                break;                                                                           \
-        }                                                                                        \
+        iter->cursor++;                                                                          \
                                                                                                  \
         return true;                                                                             \
     }                                                                                            \
@@ -711,18 +1261,8 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                  \
         iter->end = PFX##_empty(iter->target);                                                   \
                                                                                                  \
-        struct SNAME##_entry *scan = iter->target->key_buffer[iter->cursor];                     \
-                                                                                                 \
         iter->index--;                                                                           \
-                                                                                                 \
-        while (1)                                                                                \
-        {                                                                                        \
-            iter->cursor--;                                                                      \
-            scan = iter->target->key_buffer[iter->cursor];                                       \
-                                                                                                 \
-            if (scan != NULL && scan != CMC_ENTRY_DELETED)                                       \
-                break;                                                                           \
-        }                                                                                        \
+        iter->cursor--;                                                                          \
                                                                                                  \
         return true;                                                                             \
     }                                                                                            \
@@ -788,7 +1328,7 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         if (PFX##_empty(iter->target))                                                           \
             return (K){0};                                                                       \
                                                                                                  \
-        return iter->target->key_buffer[iter->cursor]->key;                                      \
+        return iter->target->entries[iter->cursor].key;                                          \
     }                                                                                            \
                                                                                                  \
     V PFX##_iter_value(struct SNAME##_iter *iter)                                                \
@@ -796,7 +1336,7 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         if (PFX##_empty(iter->target))                                                           \
             return (V){0};                                                                       \
                                                                                                  \
-        return iter->target->key_buffer[iter->cursor]->value;                                    \
+        return iter->target->entries[iter->cursor].value;                                        \
     }                                                                                            \
                                                                                                  \
     size_t PFX##_iter_index(struct SNAME##_iter *iter)                                           \
@@ -804,177 +1344,387 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return iter->index;                                                                      \
     }                                                                                            \
                                                                                                  \
-    static struct SNAME##_entry *PFX##_impl_new_entry(K key, V value)                            \
+    static uint32_t *PFX##_impl_get_entry_by_key(struct SNAME *_map_, K key)                     \
     {                                                                                            \
-        struct SNAME##_entry *entry = malloc(sizeof(struct SNAME##_entry));                      \
+        size_t hash = PFX##_impl_key_hash(_map_, key);                                           \
+        size_t pos = PFX##_impl_home(_map_, hash);                                               \
+        size_t dist = 0;                                                                         \
                                                                                                  \
-        if (!entry)                                                                              \
-            return NULL;                                                                         \
+        CMC_IMPL_HASHTABLE_PROBE_LOOKUP(_map_);                                                  \
                                                                                                  \
-        entry->key = key;                                                                        \
-        entry->value = value;                                                                    \
-        entry->key_dist = 0;                                                                     \
-        entry->val_dist = 0;                                                                     \
+        /* There are no tombstones so the search stops at the first empty */                     \
+        /* slot or at the first entry closer to its original position */                         \
+        while (_map_->key_buffer[pos] != 0)                                                      \
+        {                                                                                        \
+            struct SNAME##_entry *target = &(_map_->entries[_map_->key_buffer[pos] - 1]);        \
                                                                                                  \
-        return entry;                                                                            \
+            if (target->key_dist < dist)                                                         \
+                break;                                                                           \
+                                                                                                 \
+            CMC_IMPL_HASHTABLE_PROBE_SLOT(_map_);                                                \
+                                                                                                 \
+            /* CACHED tables skip the comparison when the hashes differ */                       \
+            if (CMC_IMPL_HASHTABLE_##HASHING##_EQUALS(target->key_hash, hash) &&                 \
+                PFX##_impl_key_cmp(_map_, target->key, key) == 0)                                \
+                return &(_map_->key_buffer[pos]);                                                \
+                                                                                                 \
+            pos = PFX##_impl_wrap(_map_, pos + 1);                                               \
+            dist++;                                                                              \
+        }                                                                                        \
+                                                                                                 \
+        return NULL;                                                                             \
     }                                                                                            \
                                                                                                  \
-    static struct SNAME##_entry **PFX##_impl_get_entry_by_key(struct SNAME *_map_, K key)        \
+    static uint32_t *PFX##_impl_get_entry_by_val(struct SNAME *_map_, V val)                     \
     {                                                                                            \
-        size_t hash = _map_->key_hash(key);                                                      \
-        size_t pos = hash % _map_->capacity;                                                     \
+        size_t hash = PFX##_impl_val_hash(_map_, val);                                           \
+        size_t pos = PFX##_impl_home(_map_, hash);                                               \
+        size_t dist = 0;                                                                         \
                                                                                                  \
-        struct SNAME##_entry *target = _map_->key_buffer[pos];                                   \
+        CMC_IMPL_HASHTABLE_PROBE_LOOKUP(_map_);                                                  \
                                                                                                  \
-        while (target != NULL)                                                                   \
+        /* There are no tombstones so the search stops at the first empty */                     \
+        /* slot or at the first entry closer to its original position */                         \
+        while (_map_->val_buffer[pos] != 0)                                                      \
         {                                                                                        \
-            if (target != CMC_ENTRY_DELETED && _map_->key_cmp(target->key, key) == 0)            \
-                return &(_map_->key_buffer[pos % _map_->capacity]);                              \
+            struct SNAME##_entry *target = &(_map_->entries[_map_->val_buffer[pos] - 1]);        \
                                                                                                  \
-            pos++;                                                                               \
-            target = _map_->key_buffer[pos % _map_->capacity];                                   \
+            if (target->val_dist < dist)                                                         \
+                break;                                                                           \
+                                                                                                 \
+            CMC_IMPL_HASHTABLE_PROBE_SLOT(_map_);                                                \
+                                                                                                 \
+            /* CACHED tables skip the comparison when the hashes differ */                       \
+            if (CMC_IMPL_HASHTABLE_##HASHING##_EQUALS(target->val_hash, hash) &&                 \
+                PFX##_impl_val_cmp(_map_, target->value, val) == 0)                              \
+                return &(_map_->val_buffer[pos]);                                                \
+                                                                                                 \
+            pos = PFX##_impl_wrap(_map_, pos + 1);                                               \
+            dist++;                                                                              \
         }                                                                                        \
                                                                                                  \
         return NULL;                                                                             \
     }                                                                                            \
                                                                                                  \
-    static struct SNAME##_entry **PFX##_impl_get_entry_by_val(struct SNAME *_map_, V val)        \
+    /* Finds the slot of the key_buffer that refers to the entry at index. */                    \
+    /* Only indexes are compared, never the keys themselves */                                   \
+    static uint32_t *PFX##_impl_find_index_in_key(struct SNAME *_map_, uint32_t index)           \
     {                                                                                            \
-        size_t hash = _map_->val_hash(val);                                                      \
-        size_t pos = hash % _map_->capacity;                                                     \
+        struct SNAME##_entry *entry = &(_map_->entries[index]);                                  \
                                                                                                  \
-        struct SNAME##_entry *target = _map_->val_buffer[pos];                                   \
+        /* CACHED tables reuse the stored hash instead of calling key_hash() */                  \
+        size_t hash = CMC_IMPL_HASHTABLE_##HASHING##_REHASH(                                     \
+            entry->key_hash, PFX##_impl_key_hash(_map_, entry->key));                            \
+        size_t pos = PFX##_impl_wrap(_map_, PFX##_impl_home(_map_, hash) + entry->key_dist);     \
                                                                                                  \
-        while (target != NULL)                                                                   \
-        {                                                                                        \
-            if (target != CMC_ENTRY_DELETED && _map_->val_cmp(target->value, val) == 0)          \
-                return &(_map_->val_buffer[pos % _map_->capacity]);                              \
+        return &(_map_->key_buffer[pos]);                                                        \
+    }                                                                                            \
                                                                                                  \
-            pos++;                                                                               \
-            target = _map_->val_buffer[pos % _map_->capacity];                                   \
-        }                                                                                        \
+    /* Finds the slot of the val_buffer that refers to the entry at index. */                    \
+    /* Only indexes are compared, never the values themselves */                                 \
+    static uint32_t *PFX##_impl_find_index_in_val(struct SNAME *_map_, uint32_t index)           \
+    {                                                                                            \
+        struct SNAME##_entry *entry = &(_map_->entries[index]);                                  \
                                                                                                  \
-        return NULL;                                                                             \
+        /* CACHED tables reuse the stored hash instead of calling val_hash() */                  \
+        size_t hash = CMC_IMPL_HASHTABLE_##HASHING##_REHASH(                                     \
+            entry->val_hash, PFX##_impl_val_hash(_map_, entry->value));                          \
+        size_t pos = PFX##_impl_wrap(_map_, PFX##_impl_home(_map_, hash) + entry->val_dist);     \
+                                                                                                 \
+        return &(_map_->val_buffer[pos]);                                                        \
     }                                                                                            \
                                                                                                  \
-    static struct SNAME##_entry **PFX##_impl_add_entry_to_key(struct SNAME *_map_,               \
-                                                              struct SNAME##_entry *entry)       \
+    static void PFX##_impl_add_entry_to_key(struct SNAME *_map_, uint32_t index)                 \
     {                                                                                            \
-        struct SNAME##_entry **to_return = NULL;                                                 \
+        struct SNAME##_entry *entry = &(_map_->entries[index]);                                  \
                                                                                                  \
-        size_t hash = _map_->key_hash(entry->key);                                               \
-        size_t original_pos = hash % _map_->capacity;                                            \
-        size_t pos = original_pos;                                                               \
+        /* CACHED tables reuse the stored hash instead of calling key_hash() */                  \
+        size_t hash = CMC_IMPL_HASHTABLE_##HASHING##_REHASH(                                     \
+            entry->key_hash, PFX##_impl_key_hash(_map_, entry->key));                            \
+        size_t pos = PFX##_impl_home(_map_, hash);                                               \
                                                                                                  \
-        struct SNAME##_entry **scan = &(_map_->key_buffer[hash % _map_->capacity]);              \
+        uint32_t slot = index + 1;                                                               \
+        uint32_t dist = 0;                                                                       \
                                                                                                  \
-        if (*scan == NULL)                                                                       \
+        while (_map_->key_buffer[pos] != 0)                                                      \
         {                                                                                        \
-            *scan = entry;                                                                       \
+            struct SNAME##_entry *scan = &(_map_->entries[_map_->key_buffer[pos] - 1]);          \
+                                                                                                 \
+            /* Robin hood: the entry further from its home takes the slot */                     \
+            if (scan->key_dist < dist)                                                           \
+            {                                                                                    \
+                uint32_t tmp_slot = _map_->key_buffer[pos];                                      \
+                uint32_t tmp_dist = scan->key_dist;                                              \
+                                                                                                 \
+                _map_->key_buffer[pos] = slot;                                                   \
+                _map_->entries[slot - 1].key_dist = dist;                                        \
                                                                                                  \
-            return scan;                                                                         \
+                slot = tmp_slot;                                                                 \
+                dist = tmp_dist;                                                                 \
+            }                                                                                    \
+                                                                                                 \
+            pos = PFX##_impl_wrap(_map_, pos + 1);                                               \
+            dist++;                                                                              \
         }                                                                                        \
-        else                                                                                     \
+                                                                                                 \
+        _map_->key_buffer[pos] = slot;                                                           \
+        _map_->entries[slot - 1].key_dist = dist;                                                \
+    }                                                                                            \
+                                                                                                 \
+    static void PFX##_impl_add_entry_to_val(struct SNAME *_map_, uint32_t index)                 \
+    {                                                                                            \
+        struct SNAME##_entry *entry = &(_map_->entries[index]);                                  \
+                                                                                                 \
+        /* CACHED tables reuse the stored hash instead of calling val_hash() */                  \
+        size_t hash = CMC_IMPL_HASHTABLE_##HASHING##_REHASH(                                     \
+            entry->val_hash, PFX##_impl_val_hash(_map_, entry->value));                          \
+        size_t pos = PFX##_impl_home(_map_, hash);                                               \
+                                                                                                 \
+        uint32_t slot = index + 1;                                                               \
+        uint32_t dist = 0;                                                                       \
+                                                                                                 \
+        while (_map_->val_buffer[pos] != 0)                                                      \
         {                                                                                        \
-            while (true)                                                                         \
+            struct SNAME##_entry *scan = &(_map_->entries[_map_->val_buffer[pos] - 1]);          \
+                                                                                                 \
+            /* Robin hood: the entry further from its home takes the slot */                     \
+            if (scan->val_dist < dist)                                                           \
             {                                                                                    \
-                pos++;                                                                           \
-                scan = &(_map_->key_buffer[pos % _map_->capacity]);                              \
-                                                                                                 \
-                if (*scan == NULL || *scan == CMC_ENTRY_DELETED)                                 \
-                {                                                                                \
-                    if (!to_return)                                                              \
-                        to_return = scan;                                                        \
-                                                                                                 \
-                    *scan = entry;                                                               \
-                    entry->key_dist = pos - original_pos;                                        \
-                                                                                                 \
-                    return to_return;                                                            \
-                }                                                                                \
-                else if ((*scan)->key_dist < pos - original_pos)                                 \
-                {                                                                                \
-                    if (!to_return)                                                              \
-                        to_return = scan;                                                        \
-                                                                                                 \
-                    size_t tmp_dist = (*scan)->key_dist;                                         \
-                    entry->key_dist = pos - original_pos;                                        \
-                    original_pos = pos - tmp_dist;                                               \
-                                                                                                 \
-                    struct SNAME##_entry *_tmp_ = *scan;                                         \
-                    *scan = entry;                                                               \
-                    entry = _tmp_;                                                               \
-                }                                                                                \
+                uint32_t tmp_slot = _map_->val_buffer[pos];                                      \
+                uint32_t tmp_dist = scan->val_dist;                                              \
+                                                                                                 \
+                _map_->val_buffer[pos] = slot;                                                   \
+                _map_->entries[slot - 1].val_dist = dist;                                        \
+                                                                                                 \
+                slot = tmp_slot;                                                                 \
+                dist = tmp_dist;                                                                 \
             }                                                                                    \
+                                                                                                 \
+            pos = PFX##_impl_wrap(_map_, pos + 1);                                               \
+            dist++;                                                                              \
         }                                                                                        \
                                                                                                  \
-        return NULL;                                                                             \
+        _map_->val_buffer[pos] = slot;                                                           \
+        _map_->entries[slot - 1].val_dist = dist;                                                \
     }                                                                                            \
                                                                                                  \
-    static struct SNAME##_entry **PFX##_impl_add_entry_to_val(struct SNAME *_map_,               \
-                                                              struct SNAME##_entry *entry)       \
+    static void PFX##_impl_remove_entry_from_key(struct SNAME *_map_, uint32_t *slot)            \
     {                                                                                            \
-        struct SNAME##_entry **to_return = NULL;                                                 \
+        size_t pos = (size_t)(slot - _map_->key_buffer);                                         \
+                                                                                                 \
+        /* Backward shift deletion. Every entry that follows and is not at its */                \
+        /* original position is moved one position back */                                       \
+        while (true)                                                                             \
+        {                                                                                        \
+            size_t next = PFX##_impl_wrap(_map_, pos + 1);                                       \
                                                                                                  \
-        size_t hash = _map_->val_hash(entry->value);                                             \
-        size_t original_pos = hash % _map_->capacity;                                            \
-        size_t pos = original_pos;                                                               \
+            if (_map_->key_buffer[next] == 0 ||                                                  \
+                _map_->entries[_map_->key_buffer[next] - 1].key_dist == 0)                       \
+                break;                                                                           \
+                                                                                                 \
+            _map_->key_buffer[pos] = _map_->key_buffer[next];                                    \
+            _map_->entries[_map_->key_buffer[pos] - 1].key_dist--;                               \
                                                                                                  \
-        struct SNAME##_entry **scan = &(_map_->val_buffer[hash % _map_->capacity]);              \
+            pos = next;                                                                          \
+        }                                                                                        \
                                                                                                  \
-        if (*scan == NULL)                                                                       \
+        _map_->key_buffer[pos] = 0;                                                              \
+    }                                                                                            \
+                                                                                                 \
+    static void PFX##_impl_remove_entry_from_val(struct SNAME *_map_, uint32_t *slot)            \
+    {                                                                                            \
+        size_t pos = (size_t)(slot - _map_->val_buffer);                                         \
+                                                                                                 \
+        /* Backward shift deletion. Every entry that follows and is not at its */                \
+        /* original position is moved one position back */                                       \
+        while (true)                                                                             \
+        {                                                                                        \
+            size_t next = PFX##_impl_wrap(_map_, pos + 1);                                       \
+                                                                                                 \
+            if (_map_->val_buffer[next] == 0 ||                                                  \
+                _map_->entries[_map_->val_buffer[next] - 1].val_dist == 0)                       \
+                break;                                                                           \
+                                                                                                 \
+            _map_->val_buffer[pos] = _map_->val_buffer[next];                                    \
+            _map_->entries[_map_->val_buffer[pos] - 1].val_dist--;                               \
+                                                                                                 \
+            pos = next;                                                                          \
+        }                                                                                        \
+                                                                                                 \
+        _map_->val_buffer[pos] = 0;                                                              \
+    }                                                                                            \
+                                                                                                 \
+    /* Unlinks the entry both slots refer to and moves the last entry to its */                  \
+    /* place so that the array of entries stays dense */                                         \
+    static void PFX##_impl_remove_entry(struct SNAME *_map_, uint32_t *key_slot,                 \
+                                        uint32_t *val_slot)                                      \
+    {                                                                                            \
+        uint32_t index = *key_slot - 1;                                                          \
+        uint32_t last = (uint32_t)_map_->count - 1;                                              \
+                                                                                                 \
+        PFX##_impl_remove_entry_from_key(_map_, key_slot);                                       \
+        PFX##_impl_remove_entry_from_val(_map_, val_slot);                                       \
+                                                                                                 \
+        if (index != last)                                                                       \
         {                                                                                        \
-            *scan = entry;                                                                       \
+            *PFX##_impl_find_index_in_key(_map_, last) = index + 1;                              \
+            *PFX##_impl_find_index_in_val(_map_, last) = index + 1;                              \
+                                                                                                 \
+            _map_->entries[index] = _map_->entries[last];                                        \
+        }                                                                                        \
+                                                                                                 \
+        _map_->count--;                                                                          \
+    }                                                                                            \
+                                                                                                 \
+    /* Replaces the buffers of _map_ by empty hashtables of the given capacity */                \
+    /* and an entries array that fits as many pairs as they can take. The old */                 \
+    /* hashtables are left for the caller to free */                                             \
+    static bool PFX##_impl_alloc_buffers(struct SNAME *_map_, size_t capacity)                   \
+    {                                                                                            \
+        /* Slots are 32-bit indexes where 0 is reserved for empty slots */                       \
+        if (capacity >= UINT32_MAX)                                                              \
+            return false;                                                                        \
+                                                                                                 \
+        uint32_t *buffer = _map_->alloc->calloc(capacity * 2, sizeof(uint32_t));                 \
+                                                                                                 \
+        if (CMC_UNLIKELY(!buffer))                                                               \
+            return false;                                                                        \
                                                                                                  \
-            return scan;                                                                         \
+        size_t entries_capacity = (size_t)((double)capacity * _map_->load) + 1;                  \
+                                                                                                 \
+        struct SNAME##_entry *entries =                                                          \
+            _map_->alloc->realloc(_map_->entries,                                                \
+                                  sizeof(struct SNAME##_entry) * entries_capacity);              \
+                                                                                                 \
+        if (!entries)                                                                            \
+        {                                                                                        \
+            _map_->alloc->free(buffer);                                                          \
+            return false;                                                                        \
         }                                                                                        \
-        else                                                                                     \
+                                                                                                 \
+        _map_->entries = entries;                                                                \
+        _map_->key_buffer = buffer;                                                              \
+        _map_->val_buffer = buffer + capacity;                                                   \
+        _map_->capacity = capacity;                                                              \
+        _map_->fastmod = cmc_fastmod_new(_map_->capacity);                                       \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Replaces both hashtables by ones of the given capacity */                                 \
+    static bool PFX##_impl_rehash(struct SNAME *_map_, size_t capacity)                          \
+    {                                                                                            \
+        uint32_t *old_buffer = _map_->key_buffer;                                                \
+                                                                                                 \
+        if (!PFX##_impl_alloc_buffers(_map_, capacity))                                          \
+            return false;                                                                        \
+                                                                                                 \
+        /* Entries stay where they are, only their indexes are hashed again */                   \
+        for (uint32_t i = 0; i < _map_->count; i++)                                              \
         {                                                                                        \
-            while (true)                                                                         \
+            PFX##_impl_add_entry_to_key(_map_, i);                                               \
+            PFX##_impl_add_entry_to_val(_map_, i);                                               \
+        }                                                                                        \
+                                                                                                 \
+        _map_->alloc->free(old_buffer);                                                          \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Called after removals, shrinks the table once it is mostly empty */                       \
+    static void PFX##_impl_low_water(struct SNAME *_map_)                                        \
+    {                                                                                            \
+        double low_water = cmc_hashtable_low_water(_map_->load);                                 \
+                                                                                                 \
+        /* Left with room for as many again so it is not grown right back */                     \
+        if ((double)_map_->count < (double)_map_->capacity * _map_->load * low_water)            \
+            PFX##_impl_shrink(_map_, _map_->count * 2);                                          \
+    }                                                                                            \
+                                                                                                 \
+    /* Rebuilds the table at the smallest size that holds required entries */                    \
+    static bool PFX##_impl_shrink(struct SNAME *_map_, size_t required)                          \
+    {                                                                                            \
+        size_t count = required > 0 ? required : 1;                                              \
+        size_t capacity = PFX##_impl_calculate_size(count / PFX##_load(_map_));                  \
+                                                                                                 \
+        /* Already as small as the sizing policy allows */                                       \
+        if (capacity >= PFX##_capacity(_map_))                                                   \
+            return true;                                                                         \
+                                                                                                 \
+        return PFX##_impl_rehash(_map_, capacity);                                               \
+    }                                                                                            \
+                                                                                                 \
+    static struct SNAME *PFX##_impl_load_layout(FILE *file, int (*key_cmp)(K, K),                \
+                                                size_t (*key_hash)(K), int (*val_cmp)(V, V),     \
+                                                size_t (*val_hash)(V),                           \
+                                                struct cmc_serial_header *header)                \
+    {                                                                                            \
+        size_t capacity = header->capacity;                                                      \
+        size_t count = header->count;                                                            \
+                                                                                                 \
+        /* The hashtables are only valid for ones of the same sizing and entry */                \
+        if (header->extra != sizeof(struct SNAME##_entry) || capacity == 0 ||                    \
+            PFX##_impl_calculate_size(capacity) != capacity ||                                   \
+            count > (size_t)((double)capacity * header->load) + 1)                               \
+            return NULL;                                                                         \
+                                                                                                 \
+        struct SNAME *_map_ = PFX##_new(1, header->load, key_cmp, key_hash, val_cmp, val_hash);  \
+                                                                                                 \
+        if (CMC_UNLIKELY(!_map_))                                                                \
+            return NULL;                                                                         \
+                                                                                                 \
+        uint32_t *old_buffer = _map_->key_buffer;                                                \
+                                                                                                 \
+        if (!PFX##_impl_alloc_buffers(_map_, capacity))                                          \
+        {                                                                                        \
+            PFX##_free(_map_, NULL);                                                             \
+            return NULL;                                                                         \
+        }                                                                                        \
+                                                                                                 \
+        _map_->alloc->free(old_buffer);                                                          \
+                                                                                                 \
+        size_t slots = capacity * 2;                                                             \
+        size_t used = 0;                                                                         \
+                                                                                                 \
+        if (fread(_map_->entries, sizeof(struct SNAME##_entry), count, file) == count &&         \
+            fread(_map_->key_buffer, sizeof(uint32_t), slots, file) == slots)                    \
+        {                                                                                        \
+            /* Slots are trusted as they are but must index entries in use */                    \
+            for (size_t i = 0; i < slots && used != SIZE_MAX; i++)                               \
             {                                                                                    \
-                pos++;                                                                           \
-                scan = &(_map_->val_buffer[pos % _map_->capacity]);                              \
-                                                                                                 \
-                if (*scan == NULL || *scan == CMC_ENTRY_DELETED)                                 \
-                {                                                                                \
-                    if (!to_return)                                                              \
-                        to_return = scan;                                                        \
-                                                                                                 \
-                    *scan = entry;                                                               \
-                    entry->val_dist = pos - original_pos;                                        \
-                                                                                                 \
-                    return to_return;                                                            \
-                }                                                                                \
-                else if ((*scan)->val_dist < pos - original_pos)                                 \
-                {                                                                                \
-                    if (!to_return)                                                              \
-                        to_return = scan;                                                        \
-                                                                                                 \
-                    size_t tmp_dist = (*scan)->val_dist;                                         \
-                    entry->val_dist = pos - original_pos;                                        \
-                    original_pos = pos - tmp_dist;                                               \
-                                                                                                 \
-                    struct SNAME##_entry *_tmp_ = *scan;                                         \
-                    *scan = entry;                                                               \
-                    entry = _tmp_;                                                               \
-                }                                                                                \
+                if (_map_->key_buffer[i] > count)                                                \
+                    used = SIZE_MAX;                                                             \
+                else if (_map_->key_buffer[i] != 0)                                              \
+                    used++;                                                                      \
             }                                                                                    \
         }                                                                                        \
                                                                                                  \
-        return NULL;                                                                             \
+        /* Every entry is in both hashtables */                                                  \
+        if (used != count * 2)                                                                   \
+        {                                                                                        \
+            PFX##_free(_map_, NULL);                                                             \
+            return NULL;                                                                         \
+        }                                                                                        \
+                                                                                                 \
+        _map_->count = count;                                                                    \
+                                                                                                 \
+        return _map_;                                                                            \
     }                                                                                            \
                                                                                                  \
+                                                                                                 \
     static size_t PFX##_impl_calculate_size(size_t required)                                     \
     {                                                                                            \
-        const size_t count = sizeof(cmc_hashtable_primes) / sizeof(cmc_hashtable_primes[0]);     \
-                                                                                                 \
-        if (cmc_hashtable_primes[count - 1] < required)                                          \
-            return required;                                                                     \
+        return CMC_IMPL_HASHTABLE_##SIZING##_SIZE(required);                                     \
+    }                                                                                            \
                                                                                                  \
-        size_t i = 0;                                                                            \
-        while (cmc_hashtable_primes[i] < required)                                               \
-            i++;                                                                                 \
+    static inline size_t PFX##_impl_home(struct SNAME *_map_, size_t hash)                       \
+    {                                                                                            \
+        return CMC_IMPL_HASHTABLE_##SIZING##_TABLE_HOME(hash, _map_);                            \
+    }                                                                                            \
                                                                                                  \
-        return cmc_hashtable_primes[i];                                                          \
+    static inline size_t PFX##_impl_wrap(struct SNAME *_map_, size_t pos)                        \
+    {                                                                                            \
+        return CMC_IMPL_HASHTABLE_##SIZING##_TABLE_WRAP(pos, _map_);                             \
     }                                                                                            \
                                                                                                  \
     static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_map_)                          \
@@ -994,6 +1744,118 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         PFX##_iter_to_end(&iter);                                                                \
                                                                                                  \
         return iter;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    static inline int PFX##_impl_key_cmp(struct SNAME *_map_, K a, K b)                          \
+    {                                                                                            \
+        (void)_map_;                                                                             \
+                                                                                                 \
+        return KEY_CMP(a, b);                                                                    \
+    }                                                                                            \
+                                                                                                 \
+    static inline size_t PFX##_impl_key_hash(struct SNAME *_map_, K key)                         \
+    {                                                                                            \
+        (void)_map_;                                                                             \
+                                                                                                 \
+        return KEY_HASH(key);                                                                    \
+    }                                                                                            \
+                                                                                                 \
+    static inline int PFX##_impl_val_cmp(struct SNAME *_map_, V a, V b)                          \
+    {                                                                                            \
+        (void)_map_;                                                                             \
+                                                                                                 \
+        return VAL_CMP(a, b);                                                                    \
+    }                                                                                            \
+                                                                                                 \
+    static inline size_t PFX##_impl_val_hash(struct SNAME *_map_, V value)                       \
+    {                                                                                            \
+        (void)_map_;                                                                             \
+                                                                                                 \
+        return VAL_HASH(value);                                                                  \
+    }
+
+/* Generates PFX##_invert, turning a map SNAME of K -> V into the map ISNAME */
+/* of V -> K made by IPFX. The entries keep their order and the inverse */
+/* takes the hashtables with their two halves swapped, so no element is */
+/* hashed again. */
+/* Both maps must be generated with the same sizing and hashing, and for EX */
+/* maps the inverse must be given the same functions with keys and values */
+/* swapped. When K and V are the same type a map can be its own inverse, */
+/* with IPFX and ISNAME being PFX and SNAME */
+#define CMC_GENERATE_BIDIMAP_INVERT(PFX, SNAME, IPFX, ISNAME)   \
+    CMC_IMPL_BIDIMAP_INVERT(PFX, SNAME, IPFX, ISNAME, UNCACHED)
+
+#define CMC_GENERATE_BIDIMAP_CACHED_INVERT(PFX, SNAME, IPFX, ISNAME) \
+    CMC_IMPL_BIDIMAP_INVERT(PFX, SNAME, IPFX, ISNAME, CACHED)
+
+/* The map given is consumed, unless NULL is returned when out of memory */
+#define CMC_IMPL_BIDIMAP_INVERT(PFX, SNAME, IPFX, ISNAME, HASHING)                     \
+                                                                                       \
+    struct ISNAME *PFX##_invert(struct SNAME *_map_)                                   \
+    {                                                                                  \
+        struct cmc_alloc_node *alloc = _map_->alloc;                                   \
+                                                                                       \
+        struct ISNAME *inverse = alloc->malloc(sizeof(struct ISNAME));                 \
+                                                                                       \
+        if (CMC_UNLIKELY(!inverse))                                                    \
+            return NULL;                                                               \
+                                                                                       \
+        size_t entries_capacity = (size_t)((double)_map_->capacity * _map_->load) + 1; \
+                                                                                       \
+        struct ISNAME##_entry *entries =                                               \
+            alloc->malloc(sizeof(struct ISNAME##_entry) * entries_capacity);           \
+                                                                                       \
+        if (CMC_UNLIKELY(!entries))                                                    \
+        {                                                                              \
+            alloc->free(inverse);                                                      \
+            return NULL;                                                               \
+        }                                                                              \
+                                                                                       \
+        for (size_t i = 0; i < _map_->count; i++)                                      \
+        {                                                                              \
+            struct SNAME##_entry *from = &(_map_->entries[i]);                         \
+            struct ISNAME##_entry *to = &(entries[i]);                                 \
+                                                                                       \
+            to->key = from->value;                                                     \
+            to->value = from->key;                                                     \
+            to->key_dist = from->val_dist;                                             \
+            to->val_dist = from->key_dist;                                             \
+            CMC_IMPL_HASHTABLE_##HASHING(to->key_hash = from->val_hash;)               \
+            CMC_IMPL_HASHTABLE_##HASHING(to->val_hash = from->key_hash;)               \
+        }                                                                              \
+                                                                                       \
+        /* Entries keep their indexes so the slots stay valid, only the */             \
+        /* value table has to become the first half of the buffer */                   \
+        uint32_t *buffer = _map_->key_buffer;                                          \
+                                                                                       \
+        for (size_t i = 0; i < _map_->capacity; i++)                                   \
+        {                                                                              \
+            uint32_t slot = buffer[i];                                                 \
+            buffer[i] = buffer[i + _map_->capacity];                                   \
+            buffer[i + _map_->capacity] = slot;                                        \
+        }                                                                              \
+                                                                                       \
+        inverse->entries = entries;                                                    \
+        inverse->key_buffer = buffer;                                                  \
+        inverse->val_buffer = buffer + _map_->capacity;                                \
+        inverse->capacity = _map_->capacity;                                           \
+        inverse->fastmod = _map_->fastmod;                                             \
+        inverse->count = _map_->count;                                                 \
+        inverse->load = _map_->load;                                                   \
+        inverse->key_cmp = _map_->val_cmp;                                             \
+        inverse->val_cmp = _map_->key_cmp;                                             \
+        inverse->key_hash = _map_->val_hash;                                           \
+        inverse->val_hash = _map_->key_hash;                                           \
+        inverse->it_start = IPFX##_impl_it_start;                                      \
+        inverse->it_end = IPFX##_impl_it_end;                                          \
+        inverse->alloc = alloc;                                                        \
+                                                                                       \
+        CMC_IMPL_HASHTABLE_PROBE_RESET(inverse);                                       \
+                                                                                       \
+        alloc->free(_map_->entries);                                                   \
+        alloc->free(_map_);                                                            \
+                                                                                       \
+        return inverse;                                                                \
     }
 
 #endif /* CMC_BIDIMAP_H */
@@ -0,0 +1,914 @@
+/**
+ * bitset.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * BitSet
+ *
+ * A BitSet is a Set of small non-negative integers, like identifiers that
+ * are given in sequence, kept as one bit per integer that could be in the
+ * set. It has the same functions as the HashSet, including its set
+ * operations, so it can replace one whose elements are dense, taking an
+ * eighth of a byte per possible element instead of an entry per element.
+ *
+ * Elements of type V are converted to size_t to be used as the position of
+ * their bit, so V must be an integer type and negative values can't be
+ * inserted. The set grows to hold the largest element inserted.
+ *
+ * Implementation
+ *
+ * The bits are kept in an array of 64 bit words that is always a multiple
+ * of a cache line. Set operations go through the words of both sets, a
+ * vector of words at a time with AVX2 or SSE2 when available, counting the
+ * bits of the result with popcount as they go. Iteration skips to the next
+ * bit set with count trailing zeros, so it only looks at each word once.
+ *
+ * The word operations are in utl/cmc_bits.h. Define CMC_BITS_NO_SIMD to
+ * always go through one word at a time.
+ */
+
+#ifndef CMC_BITSET_H
+#define CMC_BITSET_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_bits.h"
+#include "../utl/cmc_math.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_bitset = "%s at %p { words:%p, word_count:%" PRIuMAX ", count:%" PRIuMAX " }";
+
+/* Words are aligned to and allocated in multiples of this size */
+#ifndef CMC_CACHE_LINE_SIZE
+#define CMC_CACHE_LINE_SIZE 64
+#endif
+
+#define CMC_BITSET_LINE_WORDS (CMC_CACHE_LINE_SIZE / sizeof(uint64_t))
+
+#define CMC_GENERATE_BITSET(PFX, SNAME, V)    \
+    CMC_GENERATE_BITSET_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_BITSET_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_BITSET_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_BITSET_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_BITSET_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_BITSET_SOURCE(PFX, SNAME, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_BITSET_HEADER(PFX, SNAME, V)                                         \
+                                                                                          \
+    /* BitSet Structure */                                                                \
+    struct SNAME                                                                          \
+    {                                                                                     \
+        /* Array of word_count words, bit i of word w is the element w * 64 + i */        \
+        uint64_t *words;                                                                  \
+                                                                                          \
+        /* Amount of words, always a multiple of CMC_BITSET_LINE_WORDS */                 \
+        size_t word_count;                                                                \
+                                                                                          \
+        /* Current amount of elements */                                                  \
+        size_t count;                                                                     \
+                                                                                          \
+        /* Function that returns an iterator to the start of the bitset */                \
+        struct SNAME##_iter (*it_start)(struct SNAME *);                                  \
+                                                                                          \
+        /* Function that returns an iterator to the end of the bitset */                  \
+        struct SNAME##_iter (*it_end)(struct SNAME *);                                    \
+                                                                                          \
+        /* Custom allocation functions */                                                 \
+        struct cmc_alloc_node *alloc;                                                     \
+    };                                                                                    \
+                                                                                          \
+    /* BitSet Iterator */                                                                 \
+    struct SNAME##_iter                                                                   \
+    {                                                                                     \
+        /* Target BitSet */                                                               \
+        struct SNAME *target;                                                             \
+                                                                                          \
+        /* Cursor's position, the element it is at */                                     \
+        size_t cursor;                                                                    \
+                                                                                          \
+        /* Keeps track of relative index to the iteration of elements */                  \
+        size_t index;                                                                     \
+                                                                                          \
+        /* The first element */                                                           \
+        size_t first;                                                                     \
+                                                                                          \
+        /* The last element */                                                            \
+        size_t last;                                                                      \
+                                                                                          \
+        /* If the iterator has reached the start of the iteration */                      \
+        bool start;                                                                       \
+                                                                                          \
+        /* If the iterator has reached the end of the iteration */                        \
+        bool end;                                                                         \
+    };                                                                                    \
+                                                                                          \
+    /* Collection Functions */                                                            \
+    /* Collection Allocation and Deallocation */                                          \
+    struct SNAME *PFX##_new(size_t capacity);                                             \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc);        \
+    struct SNAME *PFX##_new_from(V *elements, size_t size);                               \
+    void PFX##_clear(struct SNAME *_set_);                                                \
+    void PFX##_free(struct SNAME *_set_);                                                 \
+    /* Collection Input and Output */                                                     \
+    bool PFX##_insert(struct SNAME *_set_, V element);                                    \
+    size_t PFX##_insert_many(struct SNAME *_set_, V *elements, size_t n);                 \
+    bool PFX##_remove(struct SNAME *_set_, V element);                                    \
+    /* Element Access */                                                                  \
+    bool PFX##_max(struct SNAME *_set_, V *value);                                        \
+    bool PFX##_min(struct SNAME *_set_, V *value);                                        \
+    /* Collection State */                                                                \
+    bool PFX##_contains(struct SNAME *_set_, V element);                                  \
+    size_t PFX##_contains_many(struct SNAME *_set_, V *elements, size_t n, bool *found);  \
+    CMC_PURE bool PFX##_empty(struct SNAME *_set_);                                       \
+    CMC_PURE size_t PFX##_count(struct SNAME *_set_);                                     \
+    size_t PFX##_memory_usage(struct SNAME *_set_);                                       \
+    size_t PFX##_capacity(struct SNAME *_set_);                                           \
+    /* Collection Utility */                                                              \
+    bool PFX##_resize(struct SNAME *_set_, size_t capacity);                              \
+    bool PFX##_shrink_to_fit(struct SNAME *_set_);                                        \
+    struct SNAME *PFX##_copy_of(struct SNAME *_set_);                                     \
+    size_t PFX##_to_array(struct SNAME *_set_, V *CMC_RESTRICT elements, size_t size);    \
+    bool PFX##_equals(struct SNAME *_set1_, struct SNAME *_set2_);                        \
+    struct cmc_string PFX##_to_string(struct SNAME *_set_);                               \
+                                                                                          \
+    /* Set Operations */                                                                  \
+    struct SNAME *PFX##_union(struct SNAME *_set1_, struct SNAME *_set2_);                \
+    struct SNAME *PFX##_intersection(struct SNAME *_set1_, struct SNAME *_set2_);         \
+    struct SNAME *PFX##_difference(struct SNAME *_set1_, struct SNAME *_set2_);           \
+    struct SNAME *PFX##_symmetric_difference(struct SNAME *_set1_, struct SNAME *_set2_); \
+    bool PFX##_union_into(struct SNAME *_set1_, struct SNAME *_set2_);                    \
+    bool PFX##_intersect_with(struct SNAME *_set1_, struct SNAME *_set2_);                \
+    void PFX##_subtract(struct SNAME *_set1_, struct SNAME *_set2_);                      \
+    bool PFX##_is_subset(struct SNAME *_set1_, struct SNAME *_set2_);                     \
+    bool PFX##_is_superset(struct SNAME *_set1_, struct SNAME *_set2_);                   \
+    bool PFX##_is_proper_subset(struct SNAME *_set1_, struct SNAME *_set2_);              \
+    bool PFX##_is_proper_superset(struct SNAME *_set1_, struct SNAME *_set2_);            \
+    bool PFX##_is_disjointset(struct SNAME *_set1_, struct SNAME *_set2_);                \
+                                                                                          \
+    /* Iterator Functions */                                                              \
+    /* Iterator Allocation and Deallocation */                                            \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target);                            \
+    void PFX##_iter_free(struct SNAME##_iter *iter);                                      \
+    /* Iterator Initialization */                                                         \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);                \
+    /* Iterator State */                                                                  \
+    bool PFX##_iter_start(struct SNAME##_iter *iter);                                     \
+    bool PFX##_iter_end(struct SNAME##_iter *iter);                                       \
+    /* Iterator Movement */                                                               \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter);                                  \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter);                                    \
+    bool PFX##_iter_next(struct SNAME##_iter *iter);                                      \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter);                                      \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps);                     \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps);                      \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index);                       \
+    /* Iterator Access */                                                                 \
+    V PFX##_iter_value(struct SNAME##_iter *iter);                                        \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter);                                   \
+                                                                                          \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_BITSET_SOURCE(PFX, SNAME, V)                                                 \
+                                                                                                  \
+    /* Implementation Detail Functions */                                                         \
+    static size_t PFX##_impl_words_for(size_t capacity);                                          \
+    static bool PFX##_impl_set_words(struct SNAME *_set_, size_t word_count);                     \
+    static size_t PFX##_impl_used_words(struct SNAME *_set_);                                     \
+    static size_t PFX##_impl_next_set(struct SNAME *_set_, size_t from);                          \
+    static size_t PFX##_impl_prev_set(struct SNAME *_set_, size_t from);                          \
+    static struct SNAME *PFX##_impl_combine(struct SNAME *_set1_, struct SNAME *_set2_,           \
+                                            enum cmc_bits_op op);                                 \
+    static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_set_);                          \
+    static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_set_);                            \
+                                                                                                  \
+    /* Creates a set that holds the elements from 0 to capacity - 1 without */                    \
+    /* growing */                                                                                 \
+    struct SNAME *PFX##_new(size_t capacity)                                                      \
+    {                                                                                             \
+        return PFX##_new_custom(capacity, NULL);                                                  \
+    }                                                                                             \
+                                                                                                  \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc)                 \
+    {                                                                                             \
+        if (!alloc)                                                                               \
+            alloc = &cmc_alloc_node_default;                                                      \
+                                                                                                  \
+        size_t word_count = PFX##_impl_words_for(capacity);                                       \
+                                                                                                  \
+        if (word_count == 0)                                                                      \
+            return NULL;                                                                          \
+                                                                                                  \
+        struct SNAME *_set_ = alloc->malloc(sizeof(struct SNAME));                                \
+                                                                                                  \
+        if (CMC_UNLIKELY(!_set_))                                                                 \
+            return NULL;                                                                          \
+                                                                                                  \
+        _set_->words = NULL;                                                                      \
+        _set_->word_count = 0;                                                                    \
+        _set_->count = 0;                                                                         \
+        _set_->it_start = PFX##_impl_it_start;                                                    \
+        _set_->it_end = PFX##_impl_it_end;                                                        \
+        _set_->alloc = alloc;                                                                     \
+                                                                                                  \
+        if (!PFX##_impl_set_words(_set_, word_count))                                             \
+        {                                                                                         \
+            alloc->free(_set_);                                                                   \
+            return NULL;                                                                          \
+        }                                                                                         \
+                                                                                                  \
+        return _set_;                                                                             \
+    }                                                                                             \
+                                                                                                  \
+    struct SNAME *PFX##_new_from(V *elements, size_t size)                                        \
+    {                                                                                             \
+        size_t capacity = 1;                                                                      \
+                                                                                                  \
+        for (size_t i = 0; i < size; i++)                                                         \
+        {                                                                                         \
+            if ((size_t)elements[i] >= capacity)                                                  \
+                capacity = (size_t)elements[i] + 1;                                               \
+        }                                                                                         \
+                                                                                                  \
+        struct SNAME *_set_ = PFX##_new(capacity);                                                \
+                                                                                                  \
+        if (CMC_UNLIKELY(!_set_))                                                                 \
+            return NULL;                                                                          \
+                                                                                                  \
+        PFX##_insert_many(_set_, elements, size);                                                 \
+                                                                                                  \
+        return _set_;                                                                             \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_clear(struct SNAME *_set_)                                                         \
+    {                                                                                             \
+        memset(_set_->words, 0, _set_->word_count * sizeof(uint64_t));                            \
+                                                                                                  \
+        _set_->count = 0;                                                                         \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_free(struct SNAME *_set_)                                                          \
+    {                                                                                             \
+        cmc_alloc_aligned_free(_set_->alloc, _set_->words);                                       \
+        _set_->alloc->free(_set_);                                                                \
+    }                                                                                             \
+                                                                                                  \
+    /* Returns false if the element was already present or if the set could */                    \
+    /* not grow to hold it */                                                                     \
+    bool PFX##_insert(struct SNAME *_set_, V element)                                             \
+    {                                                                                             \
+        size_t bit = (size_t)element;                                                             \
+        size_t word = bit / 64;                                                                   \
+                                                                                                  \
+        if (word >= _set_->word_count)                                                            \
+        {                                                                                         \
+            size_t word_count = _set_->word_count * 2;                                            \
+                                                                                                  \
+            if (word_count <= word)                                                               \
+                word_count = PFX##_impl_words_for(bit + 1);                                       \
+                                                                                                  \
+            /* Only still too small if bit + 1 overflowed */                                      \
+            if (word_count <= word || !PFX##_impl_set_words(_set_, word_count))                   \
+                return false;                                                                     \
+        }                                                                                         \
+                                                                                                  \
+        uint64_t mask = UINT64_C(1) << (bit % 64);                                                \
+                                                                                                  \
+        if (_set_->words[word] & mask)                                                            \
+            return false;                                                                         \
+                                                                                                  \
+        _set_->words[word] |= mask;                                                               \
+        _set_->count++;                                                                           \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Returns how many elements were not present before */                                       \
+    size_t PFX##_insert_many(struct SNAME *_set_, V *elements, size_t n)                          \
+    {                                                                                             \
+        size_t inserted = 0;                                                                      \
+                                                                                                  \
+        for (size_t i = 0; i < n; i++)                                                            \
+        {                                                                                         \
+            if (PFX##_insert(_set_, elements[i]))                                                 \
+                inserted++;                                                                       \
+        }                                                                                         \
+                                                                                                  \
+        return inserted;                                                                          \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_remove(struct SNAME *_set_, V element)                                             \
+    {                                                                                             \
+        size_t bit = (size_t)element;                                                             \
+                                                                                                  \
+        if (bit / 64 >= _set_->word_count)                                                        \
+            return false;                                                                         \
+                                                                                                  \
+        uint64_t mask = UINT64_C(1) << (bit % 64);                                                \
+                                                                                                  \
+        if (!(_set_->words[bit / 64] & mask))                                                     \
+            return false;                                                                         \
+                                                                                                  \
+        _set_->words[bit / 64] &= ~mask;                                                          \
+        _set_->count--;                                                                           \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_max(struct SNAME *_set_, V *value)                                                 \
+    {                                                                                             \
+        if (PFX##_empty(_set_))                                                                   \
+            return false;                                                                         \
+                                                                                                  \
+        if (value)                                                                                \
+            *value = (V)PFX##_impl_prev_set(_set_, _set_->word_count * 64 - 1);                   \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_min(struct SNAME *_set_, V *value)                                                 \
+    {                                                                                             \
+        if (PFX##_empty(_set_))                                                                   \
+            return false;                                                                         \
+                                                                                                  \
+        if (value)                                                                                \
+            *value = (V)PFX##_impl_next_set(_set_, 0);                                            \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_contains(struct SNAME *_set_, V element)                                           \
+    {                                                                                             \
+        size_t bit = (size_t)element;                                                             \
+                                                                                                  \
+        if (bit / 64 >= _set_->word_count)                                                        \
+            return false;                                                                         \
+                                                                                                  \
+        return (_set_->words[bit / 64] >> (bit % 64)) & 1;                                        \
+    }                                                                                             \
+                                                                                                  \
+    /* Looks up n elements, storing in found[i] if elements[i] is present */                      \
+    /* when found is not NULL, and returns how many of them are present */                        \
+    size_t PFX##_contains_many(struct SNAME *_set_, V *elements, size_t n, bool *found)           \
+    {                                                                                             \
+        size_t result = 0;                                                                        \
+                                                                                                  \
+        for (size_t i = 0; i < n; i++)                                                            \
+        {                                                                                         \
+            bool present = PFX##_contains(_set_, elements[i]);                                    \
+                                                                                                  \
+            if (found)                                                                            \
+                found[i] = present;                                                               \
+                                                                                                  \
+            result += present;                                                                    \
+        }                                                                                         \
+                                                                                                  \
+        return result;                                                                            \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_empty(struct SNAME *_set_)                                                         \
+    {                                                                                             \
+        return _set_->count == 0;                                                                 \
+    }                                                                                             \
+                                                                                                  \
+    size_t PFX##_count(struct SNAME *_set_)                                                       \
+    {                                                                                             \
+        return _set_->count;                                                                      \
+    }                                                                                             \
+                                                                                                  \
+    size_t PFX##_memory_usage(struct SNAME *_set_)                                                \
+    {                                                                                             \
+        size_t words = _set_->word_count * sizeof(uint64_t);                                      \
+                                                                                                  \
+        return sizeof(struct SNAME) + cmc_alloc_aligned_size(CMC_CACHE_LINE_SIZE, words);         \
+    }                                                                                             \
+                                                                                                  \
+    /* Amount of elements that can be inserted without growing, always */                         \
+    /* starting from 0 */                                                                         \
+    size_t PFX##_capacity(struct SNAME *_set_)                                                    \
+    {                                                                                             \
+        return _set_->word_count * 64;                                                            \
+    }                                                                                             \
+                                                                                                  \
+    /* Returns false if capacity is too small for the largest element or if */                    \
+    /* the new words could not be allocated */                                                    \
+    bool PFX##_resize(struct SNAME *_set_, size_t capacity)                                       \
+    {                                                                                             \
+        size_t word_count = PFX##_impl_words_for(capacity);                                       \
+                                                                                                  \
+        if (word_count == 0 || word_count < PFX##_impl_used_words(_set_))                         \
+            return false;                                                                         \
+                                                                                                  \
+        if (word_count == _set_->word_count)                                                      \
+            return true;                                                                          \
+                                                                                                  \
+        return PFX##_impl_set_words(_set_, word_count);                                           \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_shrink_to_fit(struct SNAME *_set_)                                                 \
+    {                                                                                             \
+        return PFX##_resize(_set_, PFX##_impl_used_words(_set_) * 64);                            \
+    }                                                                                             \
+                                                                                                  \
+    struct SNAME *PFX##_copy_of(struct SNAME *_set_)                                              \
+    {                                                                                             \
+        struct SNAME *result = PFX##_new_custom(_set_->word_count * 64, _set_->alloc);            \
+                                                                                                  \
+        if (CMC_UNLIKELY(!result))                                                                \
+            return NULL;                                                                          \
+                                                                                                  \
+        memcpy(result->words, _set_->words, _set_->word_count * sizeof(uint64_t));                \
+                                                                                                  \
+        result->count = _set_->count;                                                             \
+                                                                                                  \
+        return result;                                                                            \
+    }                                                                                             \
+                                                                                                  \
+    /* Writes up to size elements in increasing order, returning how many */                      \
+    size_t PFX##_to_array(struct SNAME *_set_, V *CMC_RESTRICT elements, size_t size)             \
+    {                                                                                             \
+        size_t written = 0;                                                                       \
+                                                                                                  \
+        for (size_t w = 0; w < _set_->word_count && written < size; w++)                          \
+        {                                                                                         \
+            uint64_t word = _set_->words[w];                                                      \
+                                                                                                  \
+            while (word && written < size)                                                        \
+            {                                                                                     \
+                elements[written++] = (V)(w * 64 + cmc_math_ctz(word));                           \
+                word &= word - 1;                                                                 \
+            }                                                                                     \
+        }                                                                                         \
+                                                                                                  \
+        return written;                                                                           \
+    }                                                                                             \
+                                                                                                  \
+    /* Two sets are equal if they have the same elements, regardless of */                        \
+    /* their capacity */                                                                          \
+    bool PFX##_equals(struct SNAME *_set1_, struct SNAME *_set2_)                                 \
+    {                                                                                             \
+        if (_set1_->count != _set2_->count)                                                       \
+            return false;                                                                         \
+                                                                                                  \
+        size_t common = _set1_->word_count < _set2_->word_count ? _set1_->word_count              \
+                                                                 : _set2_->word_count;            \
+                                                                                                  \
+        /* With the same count, equal common words mean the rest are all zero */                  \
+        return memcmp(_set1_->words, _set2_->words, common * sizeof(uint64_t)) == 0 &&            \
+               cmc_bits_popcount(_set1_->words, common) == _set1_->count;                         \
+    }                                                                                             \
+                                                                                                  \
+    struct cmc_string PFX##_to_string(struct SNAME *_set_)                                        \
+    {                                                                                             \
+        struct cmc_string str;                                                                    \
+        struct SNAME *s_ = _set_;                                                                 \
+        const char *name = #SNAME;                                                                \
+                                                                                                  \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_bitset, name, s_, s_->words,               \
+                 s_->word_count, s_->count);                                                      \
+                                                                                                  \
+        return str;                                                                               \
+    }                                                                                             \
+                                                                                                  \
+    struct SNAME *PFX##_union(struct SNAME *_set1_, struct SNAME *_set2_)                         \
+    {                                                                                             \
+        return PFX##_impl_combine(_set1_, _set2_, CMC_BITS_OR);                                   \
+    }                                                                                             \
+                                                                                                  \
+    struct SNAME *PFX##_intersection(struct SNAME *_set1_, struct SNAME *_set2_)                  \
+    {                                                                                             \
+        return PFX##_impl_combine(_set1_, _set2_, CMC_BITS_AND);                                  \
+    }                                                                                             \
+                                                                                                  \
+    struct SNAME *PFX##_difference(struct SNAME *_set1_, struct SNAME *_set2_)                    \
+    {                                                                                             \
+        return PFX##_impl_combine(_set1_, _set2_, CMC_BITS_ANDNOT);                               \
+    }                                                                                             \
+                                                                                                  \
+    struct SNAME *PFX##_symmetric_difference(struct SNAME *_set1_, struct SNAME *_set2_)          \
+    {                                                                                             \
+        return PFX##_impl_combine(_set1_, _set2_, CMC_BITS_XOR);                                  \
+    }                                                                                             \
+                                                                                                  \
+    /* Adds every element of _set2_ to _set1_, growing it if needed. Returns */                   \
+    /* false if it could not grow, leaving _set1_ unchanged */                                    \
+    bool PFX##_union_into(struct SNAME *_set1_, struct SNAME *_set2_)                             \
+    {                                                                                             \
+        size_t used = PFX##_impl_used_words(_set2_);                                              \
+                                                                                                  \
+        if (used > _set1_->word_count && !PFX##_impl_set_words(_set1_, used))                     \
+            return false;                                                                         \
+                                                                                                  \
+        size_t count = cmc_bits_apply(_set1_->words, _set1_->words, _set2_->words, used,          \
+                                        CMC_BITS_OR);                                             \
+                                                                                                  \
+        _set1_->count = count + cmc_bits_popcount(_set1_->words + used,                           \
+                                                    _set1_->word_count - used);                   \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Keeps in _set1_ only the elements that are also in _set2_ */                               \
+    bool PFX##_intersect_with(struct SNAME *_set1_, struct SNAME *_set2_)                         \
+    {                                                                                             \
+        size_t common = _set1_->word_count < _set2_->word_count ? _set1_->word_count              \
+                                                                 : _set2_->word_count;            \
+                                                                                                  \
+        _set1_->count = cmc_bits_apply(_set1_->words, _set1_->words, _set2_->words, common,       \
+                                         CMC_BITS_AND);                                           \
+                                                                                                  \
+        memset(_set1_->words + common, 0, (_set1_->word_count - common) * sizeof(uint64_t));      \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Removes from _set1_ every element of _set2_ */                                             \
+    void PFX##_subtract(struct SNAME *_set1_, struct SNAME *_set2_)                               \
+    {                                                                                             \
+        size_t common = _set1_->word_count < _set2_->word_count ? _set1_->word_count              \
+                                                                 : _set2_->word_count;            \
+                                                                                                  \
+        size_t count = cmc_bits_apply(_set1_->words, _set1_->words, _set2_->words, common,        \
+                                        CMC_BITS_ANDNOT);                                         \
+                                                                                                  \
+        _set1_->count = count + cmc_bits_popcount(_set1_->words + common,                         \
+                                                    _set1_->word_count - common);                 \
+    }                                                                                             \
+                                                                                                  \
+    /* Is _set1_ a subset of _set2_ ? */                                                          \
+    bool PFX##_is_subset(struct SNAME *_set1_, struct SNAME *_set2_)                              \
+    {                                                                                             \
+        if (_set1_->count > _set2_->count)                                                        \
+            return false;                                                                         \
+                                                                                                  \
+        size_t used = PFX##_impl_used_words(_set1_);                                              \
+                                                                                                  \
+        if (used > _set2_->word_count)                                                            \
+            return false;                                                                         \
+                                                                                                  \
+        return cmc_bits_none(_set1_->words, _set2_->words, used, CMC_BITS_ANDNOT);                \
+    }                                                                                             \
+                                                                                                  \
+    /* Is _set1_ a superset of _set2_ ? */                                                        \
+    bool PFX##_is_superset(struct SNAME *_set1_, struct SNAME *_set2_)                            \
+    {                                                                                             \
+        return PFX##_is_subset(_set2_, _set1_);                                                   \
+    }                                                                                             \
+                                                                                                  \
+    /* Is _set1_ a proper subset of _set2_ ? */                                                   \
+    bool PFX##_is_proper_subset(struct SNAME *_set1_, struct SNAME *_set2_)                       \
+    {                                                                                             \
+        return _set1_->count < _set2_->count && PFX##_is_subset(_set1_, _set2_);                  \
+    }                                                                                             \
+                                                                                                  \
+    /* Is _set1_ a proper superset of _set2_ ? */                                                 \
+    bool PFX##_is_proper_superset(struct SNAME *_set1_, struct SNAME *_set2_)                     \
+    {                                                                                             \
+        return PFX##_is_proper_subset(_set2_, _set1_);                                            \
+    }                                                                                             \
+                                                                                                  \
+    /* Is _set1_ and _set2_ disjoint ? */                                                         \
+    bool PFX##_is_disjointset(struct SNAME *_set1_, struct SNAME *_set2_)                         \
+    {                                                                                             \
+        size_t common = _set1_->word_count < _set2_->word_count ? _set1_->word_count              \
+                                                                 : _set2_->word_count;            \
+                                                                                                  \
+        return cmc_bits_none(_set1_->words, _set2_->words, common, CMC_BITS_AND);                 \
+    }                                                                                             \
+                                                                                                  \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                     \
+    {                                                                                             \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));           \
+                                                                                                  \
+        if (CMC_UNLIKELY(!iter))                                                                  \
+            return NULL;                                                                          \
+                                                                                                  \
+        PFX##_iter_init(iter, target);                                                            \
+                                                                                                  \
+        return iter;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_iter_free(struct SNAME##_iter *iter)                                               \
+    {                                                                                             \
+        iter->target->alloc->free(iter);                                                          \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                         \
+    {                                                                                             \
+        memset(iter, 0, sizeof(struct SNAME##_iter));                                             \
+                                                                                                  \
+        iter->target = target;                                                                    \
+        iter->start = true;                                                                       \
+        iter->end = PFX##_empty(target);                                                          \
+                                                                                                  \
+        if (!PFX##_empty(target))                                                                 \
+        {                                                                                         \
+            iter->first = PFX##_impl_next_set(target, 0);                                         \
+            iter->last = PFX##_impl_prev_set(target, target->word_count * 64 - 1);                \
+            iter->cursor = iter->first;                                                           \
+        }                                                                                         \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                              \
+    {                                                                                             \
+        return PFX##_empty(iter->target) || iter->start;                                          \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                                \
+    {                                                                                             \
+        return PFX##_empty(iter->target) || iter->end;                                            \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                           \
+    {                                                                                             \
+        if (!PFX##_empty(iter->target))                                                           \
+        {                                                                                         \
+            iter->cursor = iter->first;                                                           \
+            iter->index = 0;                                                                      \
+            iter->start = true;                                                                   \
+            iter->end = PFX##_empty(iter->target);                                                \
+        }                                                                                         \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                             \
+    {                                                                                             \
+        if (!PFX##_empty(iter->target))                                                           \
+        {                                                                                         \
+            iter->cursor = iter->last;                                                            \
+            iter->index = PFX##_count(iter->target) - 1;                                          \
+            iter->start = PFX##_empty(iter->target);                                              \
+            iter->end = true;                                                                     \
+        }                                                                                         \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                               \
+    {                                                                                             \
+        if (iter->end)                                                                            \
+            return false;                                                                         \
+                                                                                                  \
+        if (iter->index + 1 == PFX##_count(iter->target))                                         \
+        {                                                                                         \
+            iter->end = true;                                                                     \
+            return false;                                                                         \
+        }                                                                                         \
+                                                                                                  \
+        iter->start = PFX##_empty(iter->target);                                                  \
+                                                                                                  \
+        iter->index++;                                                                            \
+        iter->cursor = PFX##_impl_next_set(iter->target, iter->cursor + 1);                       \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                               \
+    {                                                                                             \
+        if (iter->start)                                                                          \
+            return false;                                                                         \
+                                                                                                  \
+        if (iter->index == 0)                                                                     \
+        {                                                                                         \
+            iter->start = true;                                                                   \
+            return false;                                                                         \
+        }                                                                                         \
+                                                                                                  \
+        iter->end = PFX##_empty(iter->target);                                                    \
+                                                                                                  \
+        iter->index--;                                                                            \
+        iter->cursor = PFX##_impl_prev_set(iter->target, iter->cursor - 1);                       \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Returns true only if the iterator moved */                                                 \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps)                              \
+    {                                                                                             \
+        if (iter->end)                                                                            \
+            return false;                                                                         \
+                                                                                                  \
+        if (iter->index + 1 == PFX##_count(iter->target))                                         \
+        {                                                                                         \
+            iter->end = true;                                                                     \
+            return false;                                                                         \
+        }                                                                                         \
+                                                                                                  \
+        if (steps == 0 || iter->index + steps >= PFX##_count(iter->target))                       \
+            return false;                                                                         \
+                                                                                                  \
+        for (size_t i = 0; i < steps; i++)                                                        \
+            PFX##_iter_next(iter);                                                                \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Returns true only if the iterator moved */                                                 \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps)                               \
+    {                                                                                             \
+        if (iter->start)                                                                          \
+            return false;                                                                         \
+                                                                                                  \
+        if (iter->index == 0)                                                                     \
+        {                                                                                         \
+            iter->start = true;                                                                   \
+            return false;                                                                         \
+        }                                                                                         \
+                                                                                                  \
+        if (steps == 0 || iter->index < steps)                                                    \
+            return false;                                                                         \
+                                                                                                  \
+        for (size_t i = 0; i < steps; i++)                                                        \
+            PFX##_iter_prev(iter);                                                                \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Returns true only if the iterator was able to be positioned at the given index */          \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index)                                \
+    {                                                                                             \
+        if (index >= PFX##_count(iter->target))                                                   \
+            return false;                                                                         \
+                                                                                                  \
+        if (iter->index > index)                                                                  \
+            return PFX##_iter_rewind(iter, iter->index - index);                                  \
+        else if (iter->index < index)                                                             \
+            return PFX##_iter_advance(iter, index - iter->index);                                 \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                                 \
+    {                                                                                             \
+        if (PFX##_empty(iter->target))                                                            \
+            return (V){0};                                                                        \
+                                                                                                  \
+        return (V)iter->cursor;                                                                   \
+    }                                                                                             \
+                                                                                                  \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                            \
+    {                                                                                             \
+        return iter->index;                                                                       \
+    }                                                                                             \
+                                                                                                  \
+    /* Words for capacity elements rounded up to whole cache lines, or 0 if */                    \
+    /* that would overflow */                                                                     \
+    static size_t PFX##_impl_words_for(size_t capacity)                                           \
+    {                                                                                             \
+        size_t words = capacity / 64 + (capacity % 64 != 0);                                      \
+        size_t lines = words / CMC_BITSET_LINE_WORDS + (words % CMC_BITSET_LINE_WORDS != 0);      \
+                                                                                                  \
+        if (lines == 0)                                                                           \
+            lines = 1;                                                                            \
+                                                                                                  \
+        if (lines > SIZE_MAX / CMC_CACHE_LINE_SIZE)                                               \
+            return 0;                                                                             \
+                                                                                                  \
+        return lines * CMC_BITSET_LINE_WORDS;                                                     \
+    }                                                                                             \
+                                                                                                  \
+    /* Moves the words to a new array of word_count words, which must hold */                     \
+    /* every element */                                                                           \
+    static bool PFX##_impl_set_words(struct SNAME *_set_, size_t word_count)                      \
+    {                                                                                             \
+        uint64_t *words = cmc_alloc_aligned(_set_->alloc, CMC_CACHE_LINE_SIZE,                    \
+                                            word_count * sizeof(uint64_t));                       \
+                                                                                                  \
+        if (CMC_UNLIKELY(!words))                                                                 \
+            return false;                                                                         \
+                                                                                                  \
+        size_t kept = _set_->word_count < word_count ? _set_->word_count : word_count;            \
+                                                                                                  \
+        if (kept)                                                                                 \
+            memcpy(words, _set_->words, kept * sizeof(uint64_t));                                 \
+                                                                                                  \
+        memset(words + kept, 0, (word_count - kept) * sizeof(uint64_t));                          \
+                                                                                                  \
+        if (_set_->words)                                                                         \
+            cmc_alloc_aligned_free(_set_->alloc, _set_->words);                                   \
+                                                                                                  \
+        _set_->words = words;                                                                     \
+        _set_->word_count = word_count;                                                           \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Amount of words up to the last one that is not zero */                                     \
+    static size_t PFX##_impl_used_words(struct SNAME *_set_)                                      \
+    {                                                                                             \
+        size_t used = _set_->word_count;                                                          \
+                                                                                                  \
+        while (used > 0 && _set_->words[used - 1] == 0)                                           \
+            used--;                                                                               \
+                                                                                                  \
+        return used;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* First element from from onwards, or the capacity if there is none */                       \
+    static size_t PFX##_impl_next_set(struct SNAME *_set_, size_t from)                           \
+    {                                                                                             \
+        size_t w = from / 64;                                                                     \
+                                                                                                  \
+        if (w >= _set_->word_count)                                                               \
+            return _set_->word_count * 64;                                                        \
+                                                                                                  \
+        uint64_t word = _set_->words[w] & (~UINT64_C(0) << (from % 64));                          \
+                                                                                                  \
+        while (word == 0)                                                                         \
+        {                                                                                         \
+            if (++w == _set_->word_count)                                                         \
+                return _set_->word_count * 64;                                                    \
+                                                                                                  \
+            word = _set_->words[w];                                                               \
+        }                                                                                         \
+                                                                                                  \
+        return w * 64 + cmc_math_ctz(word);                                                       \
+    }                                                                                             \
+                                                                                                  \
+    /* Last element from from backwards, or SIZE_MAX if there is none */                          \
+    static size_t PFX##_impl_prev_set(struct SNAME *_set_, size_t from)                           \
+    {                                                                                             \
+        size_t w = from / 64;                                                                     \
+        uint64_t word = _set_->words[w] & (~UINT64_C(0) >> (63 - from % 64));                     \
+                                                                                                  \
+        while (word == 0)                                                                         \
+        {                                                                                         \
+            if (w-- == 0)                                                                         \
+                return SIZE_MAX;                                                                  \
+                                                                                                  \
+            word = _set_->words[w];                                                               \
+        }                                                                                         \
+                                                                                                  \
+        return w * 64 + 63 - cmc_math_clz(word);                                                  \
+    }                                                                                             \
+                                                                                                  \
+    /* A new set with _set1_ op _set2_. The words that only one of the sets */                    \
+    /* have are treated as zero in the other */                                                   \
+    static struct SNAME *PFX##_impl_combine(struct SNAME *_set1_, struct SNAME *_set2_,           \
+                                            enum cmc_bits_op op)                                  \
+    {                                                                                             \
+        size_t w1 = _set1_->word_count;                                                           \
+        size_t w2 = _set2_->word_count;                                                           \
+        size_t common = w1 < w2 ? w1 : w2;                                                        \
+        size_t word_count;                                                                        \
+                                                                                                  \
+        if (op == CMC_BITS_AND)                                                                   \
+            word_count = common;                                                                  \
+        else if (op == CMC_BITS_ANDNOT)                                                           \
+            word_count = w1;                                                                      \
+        else                                                                                      \
+            word_count = w1 > w2 ? w1 : w2;                                                       \
+                                                                                                  \
+        struct SNAME *result = PFX##_new_custom(word_count * 64, _set1_->alloc);                  \
+                                                                                                  \
+        if (CMC_UNLIKELY(!result))                                                                \
+            return NULL;                                                                          \
+                                                                                                  \
+        size_t count = cmc_bits_apply(result->words, _set1_->words, _set2_->words, common, op);   \
+                                                                                                  \
+        if (word_count > common)                                                                  \
+        {                                                                                         \
+            uint64_t *rest = (w1 > common ? _set1_->words : _set2_->words) + common;              \
+                                                                                                  \
+            memcpy(result->words + common, rest, (word_count - common) * sizeof(uint64_t));       \
+                                                                                                  \
+            count += cmc_bits_popcount(rest, word_count - common);                                \
+        }                                                                                         \
+                                                                                                  \
+        result->count = count;                                                                    \
+                                                                                                  \
+        return result;                                                                            \
+    }                                                                                             \
+                                                                                                  \
+    static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_set_)                           \
+    {                                                                                             \
+        struct SNAME##_iter iter;                                                                 \
+                                                                                                  \
+        PFX##_iter_init(&iter, _set_);                                                            \
+        PFX##_iter_to_start(&iter);                                                               \
+                                                                                                  \
+        return iter;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_set_)                             \
+    {                                                                                             \
+        struct SNAME##_iter iter;                                                                 \
+                                                                                                  \
+        PFX##_iter_init(&iter, _set_);                                                            \
+        PFX##_iter_to_end(&iter);                                                                 \
+                                                                                                  \
+        return iter;                                                                              \
+    }
+
+#endif /* CMC_BITSET_H */
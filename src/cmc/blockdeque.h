@@ -0,0 +1,678 @@
+/**
+ * blockdeque.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * BlockDeque
+ *
+ * A BlockDeque is a Deque that never moves its elements. Pushing to either
+ * end takes O(1) even when it has to grow, there is no copy of the whole
+ * collection and no moment where two buffers are allocated, so it can hold
+ * very large queues. Pointers to its elements stay valid until they are
+ * popped. Elements can also be accessed by their index in constant time.
+ *
+ * Implementation
+ *
+ * The elements are kept in blocks of a fixed size, of around
+ * CMC_BLOCKDEQUE_BYTES bytes each, and a map keeps a pointer to each block in
+ * order, with free slots before the first block and after the last one. A
+ * push that fills a block allocates the next one and only when one end of
+ * the map runs out of slots are the pointers to the blocks moved to its
+ * middle, in a map twice as large if it is more than half used. A block
+ * emptied by a pop is kept as a spare for the next block needed, so pushing
+ * and popping around the edge of a block does not allocate each time.
+ */
+
+#ifndef CMC_BLOCKDEQUE_H
+#define CMC_BLOCKDEQUE_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_blockdeque = "%s at %p { blocks:%p, map_capacity:%" PRIuMAX ", map_start:%" PRIuMAX ", count:%" PRIuMAX ", front:%" PRIuMAX " }";
+
+/* Size in bytes of each block of elements */
+#ifndef CMC_BLOCKDEQUE_BYTES
+#define CMC_BLOCKDEQUE_BYTES 4096
+#endif
+
+/* Elements in each block, at least 16 for large elements */
+#define CMC_BLOCKDEQUE_BLOCK(V) \
+    (sizeof(V) * 16 < CMC_BLOCKDEQUE_BYTES ? CMC_BLOCKDEQUE_BYTES / sizeof(V) : 16)
+
+#define CMC_GENERATE_BLOCKDEQUE(PFX, SNAME, V)    \
+    CMC_GENERATE_BLOCKDEQUE_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_BLOCKDEQUE_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_BLOCKDEQUE_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_BLOCKDEQUE_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_BLOCKDEQUE_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_BLOCKDEQUE_SOURCE(PFX, SNAME, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_BLOCKDEQUE_HEADER(PFX, SNAME, V)                               \
+    /* BlockDeque Structure */                                                      \
+    struct SNAME                                                                    \
+    {                                                                               \
+        /* Map of pointers to the blocks of elements, NULL where unused */          \
+        V **blocks;                                                                 \
+                                                                                    \
+        /* Amount of slots in the map */                                            \
+        size_t map_capacity;                                                        \
+                                                                                    \
+        /* Slot of the block with the front element */                              \
+        size_t map_start;                                                           \
+                                                                                    \
+        /* Current amount of elements */                                            \
+        size_t count;                                                               \
+                                                                                    \
+        /* Index of the front element in its block */                               \
+        size_t front;                                                               \
+                                                                                    \
+        /* An empty block kept for the next one needed, or NULL */                  \
+        V *spare;                                                                   \
+                                                                                    \
+        /* Custom allocation functions */                                           \
+        struct cmc_alloc_node *alloc;                                               \
+    };                                                                              \
+                                                                                    \
+    /* BlockDeque Iterator */                                                       \
+    struct SNAME##_iter                                                             \
+    {                                                                               \
+        /* Target blockdeque */                                                     \
+        struct SNAME *target;                                                       \
+                                                                                    \
+        /* Cursor's position (index) */                                             \
+        size_t cursor;                                                              \
+                                                                                    \
+        /* If the iterator has reached the start of the iteration */                \
+        bool start;                                                                 \
+                                                                                    \
+        /* If the iterator has reached the end of the iteration */                  \
+        bool end;                                                                   \
+    };                                                                              \
+                                                                                    \
+    /* Collection Functions */                                                      \
+    /* Collection Allocation and Deallocation */                                    \
+    struct SNAME *PFX##_new(size_t capacity);                                       \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc);  \
+    void PFX##_clear(struct SNAME *_deque_, void (*deallocator)(V));                \
+    void PFX##_free(struct SNAME *_deque_, void (*deallocator)(V));                 \
+    /* Collection Input and Output */                                               \
+    bool PFX##_push_front(struct SNAME *_deque_, V element);                        \
+    bool PFX##_push_back(struct SNAME *_deque_, V element);                         \
+    bool PFX##_pop_front(struct SNAME *_deque_);                                    \
+    bool PFX##_pop_back(struct SNAME *_deque_);                                     \
+    /* Element Access */                                                            \
+    V PFX##_front(struct SNAME *_deque_);                                           \
+    V PFX##_back(struct SNAME *_deque_);                                            \
+    V PFX##_get(struct SNAME *_deque_, size_t index);                               \
+    V *PFX##_get_ref(struct SNAME *_deque_, size_t index);                          \
+    /* Collection State */                                                          \
+    bool PFX##_contains(struct SNAME *_deque_, V element, int (*comparator)(V, V)); \
+    CMC_PURE bool PFX##_empty(struct SNAME *_deque_);                               \
+    CMC_PURE size_t PFX##_count(struct SNAME *_deque_);                             \
+    size_t PFX##_memory_usage(struct SNAME *_deque_);                               \
+    /* Collection Utility */                                                        \
+    bool PFX##_shrink_to_fit(struct SNAME *_deque_);                                \
+    struct cmc_string PFX##_to_string(struct SNAME *_deque_);                       \
+    bool PFX##_to_string_full(struct SNAME *_deque_,                                \
+                              struct cmc_string_builder *builder,                   \
+                              const char *elem_fmt);                                \
+    bool PFX##_write(struct SNAME *_deque_, FILE *file,                             \
+                     void (*fmt)(FILE *, V));                                       \
+    bool PFX##_write_fd(struct SNAME *_deque_, int fd,                              \
+                        void (*fmt)(struct cmc_dump *, V));                         \
+                                                                                    \
+    /* Iterator Functions */                                                        \
+    /* Iterator Initialization */                                                   \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);          \
+    /* Iterator State */                                                            \
+    bool PFX##_iter_start(struct SNAME##_iter *iter);                               \
+    bool PFX##_iter_end(struct SNAME##_iter *iter);                                 \
+    /* Iterator Movement */                                                         \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter);                            \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter);                              \
+    bool PFX##_iter_next(struct SNAME##_iter *iter);                                \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter);                                \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps);               \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps);                \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index);                 \
+    /* Iterator Access */                                                           \
+    V PFX##_iter_value(struct SNAME##_iter *iter);                                  \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter);                                \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter);                             \
+                                                                                    \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_BLOCKDEQUE_SOURCE(PFX, SNAME, V)                                             \
+    /* Implementation Detail Functions */                                                         \
+    static V *PFX##_impl_block(struct SNAME *_deque_, size_t slot);                               \
+    static void PFX##_impl_release(struct SNAME *_deque_, size_t slot);                           \
+    static void PFX##_impl_reset(struct SNAME *_deque_);                                          \
+    static bool PFX##_impl_map_room(struct SNAME *_deque_);                                       \
+                                                                                                  \
+    /* The map starts with room for capacity elements */                                          \
+    struct SNAME *PFX##_new(size_t capacity)                                                      \
+    {                                                                                             \
+        return PFX##_new_custom(capacity, NULL);                                                  \
+    }                                                                                             \
+                                                                                                  \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc)                 \
+    {                                                                                             \
+        if (!alloc)                                                                               \
+            alloc = &cmc_alloc_node_default;                                                      \
+                                                                                                  \
+        if (capacity < 1)                                                                         \
+            return NULL;                                                                          \
+                                                                                                  \
+        struct SNAME *_deque_ = alloc->malloc(sizeof(struct SNAME));                              \
+                                                                                                  \
+        if (CMC_UNLIKELY(!_deque_))                                                               \
+            return NULL;                                                                          \
+                                                                                                  \
+        _deque_->alloc = alloc;                                                                   \
+                                                                                                  \
+        size_t map_capacity = capacity / CMC_BLOCKDEQUE_BLOCK(V) + 2;                             \
+                                                                                                  \
+        _deque_->blocks = alloc->calloc(map_capacity, sizeof(V *));                               \
+                                                                                                  \
+        if (CMC_UNLIKELY(!_deque_->blocks))                                                       \
+        {                                                                                         \
+            alloc->free(_deque_);                                                                 \
+            return NULL;                                                                          \
+        }                                                                                         \
+                                                                                                  \
+        _deque_->map_capacity = map_capacity;                                                     \
+        _deque_->count = 0;                                                                       \
+        _deque_->spare = NULL;                                                                    \
+                                                                                                  \
+        PFX##_impl_reset(_deque_);                                                                \
+                                                                                                  \
+        return _deque_;                                                                           \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_clear(struct SNAME *_deque_, void (*deallocator)(V))                               \
+    {                                                                                             \
+        if (deallocator)                                                                          \
+        {                                                                                         \
+            for (size_t i = 0; i < _deque_->count; i++)                                           \
+                deallocator(PFX##_get(_deque_, i));                                               \
+        }                                                                                         \
+                                                                                                  \
+        for (size_t i = 0; i < _deque_->map_capacity; i++)                                        \
+            PFX##_impl_release(_deque_, i);                                                       \
+                                                                                                  \
+        _deque_->count = 0;                                                                       \
+                                                                                                  \
+        PFX##_impl_reset(_deque_);                                                                \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_free(struct SNAME *_deque_, void (*deallocator)(V))                                \
+    {                                                                                             \
+        PFX##_clear(_deque_, deallocator);                                                        \
+                                                                                                  \
+        _deque_->alloc->free(_deque_->spare);                                                     \
+        _deque_->alloc->free(_deque_->blocks);                                                    \
+        _deque_->alloc->free(_deque_);                                                            \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_push_front(struct SNAME *_deque_, V element)                                       \
+    {                                                                                             \
+        if (_deque_->front == 0)                                                                  \
+        {                                                                                         \
+            if (_deque_->map_start == 0 && !PFX##_impl_map_room(_deque_))                         \
+                return false;                                                                     \
+                                                                                                  \
+            if (!PFX##_impl_block(_deque_, _deque_->map_start - 1))                               \
+                return false;                                                                     \
+                                                                                                  \
+            _deque_->map_start--;                                                                 \
+            _deque_->front = CMC_BLOCKDEQUE_BLOCK(V);                                             \
+        }                                                                                         \
+        else if (!PFX##_impl_block(_deque_, _deque_->map_start))                                  \
+            return false;                                                                         \
+                                                                                                  \
+        _deque_->front--;                                                                         \
+        _deque_->blocks[_deque_->map_start][_deque_->front] = element;                            \
+        _deque_->count++;                                                                         \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_push_back(struct SNAME *_deque_, V element)                                        \
+    {                                                                                             \
+        size_t end = _deque_->front + _deque_->count;                                             \
+        size_t slot = _deque_->map_start + end / CMC_BLOCKDEQUE_BLOCK(V);                         \
+                                                                                                  \
+        if (slot >= _deque_->map_capacity)                                                        \
+        {                                                                                         \
+            if (!PFX##_impl_map_room(_deque_))                                                    \
+                return false;                                                                     \
+                                                                                                  \
+            slot = _deque_->map_start + end / CMC_BLOCKDEQUE_BLOCK(V);                            \
+        }                                                                                         \
+                                                                                                  \
+        V *block = PFX##_impl_block(_deque_, slot);                                               \
+                                                                                                  \
+        if (!block)                                                                               \
+            return false;                                                                         \
+                                                                                                  \
+        block[end % CMC_BLOCKDEQUE_BLOCK(V)] = element;                                           \
+        _deque_->count++;                                                                         \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_pop_front(struct SNAME *_deque_)                                                   \
+    {                                                                                             \
+        if (PFX##_empty(_deque_))                                                                 \
+            return false;                                                                         \
+                                                                                                  \
+        _deque_->front++;                                                                         \
+        _deque_->count--;                                                                         \
+                                                                                                  \
+        if (_deque_->count == 0)                                                                  \
+        {                                                                                         \
+            PFX##_impl_release(_deque_, _deque_->map_start);                                      \
+            PFX##_impl_reset(_deque_);                                                            \
+        }                                                                                         \
+        else if (_deque_->front == CMC_BLOCKDEQUE_BLOCK(V))                                       \
+        {                                                                                         \
+            PFX##_impl_release(_deque_, _deque_->map_start);                                      \
+                                                                                                  \
+            _deque_->map_start++;                                                                 \
+            _deque_->front = 0;                                                                   \
+        }                                                                                         \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_pop_back(struct SNAME *_deque_)                                                    \
+    {                                                                                             \
+        if (PFX##_empty(_deque_))                                                                 \
+            return false;                                                                         \
+                                                                                                  \
+        _deque_->count--;                                                                         \
+                                                                                                  \
+        size_t end = _deque_->front + _deque_->count;                                             \
+                                                                                                  \
+        if (_deque_->count == 0)                                                                  \
+        {                                                                                         \
+            PFX##_impl_release(_deque_, _deque_->map_start);                                      \
+            PFX##_impl_reset(_deque_);                                                            \
+        }                                                                                         \
+        else if (end % CMC_BLOCKDEQUE_BLOCK(V) == 0)                                              \
+            PFX##_impl_release(_deque_, _deque_->map_start + end / CMC_BLOCKDEQUE_BLOCK(V));      \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    V PFX##_front(struct SNAME *_deque_)                                                          \
+    {                                                                                             \
+        if (PFX##_empty(_deque_))                                                                 \
+            return (V){0};                                                                        \
+                                                                                                  \
+        return PFX##_get(_deque_, 0);                                                             \
+    }                                                                                             \
+                                                                                                  \
+    V PFX##_back(struct SNAME *_deque_)                                                           \
+    {                                                                                             \
+        if (PFX##_empty(_deque_))                                                                 \
+            return (V){0};                                                                        \
+                                                                                                  \
+        return PFX##_get(_deque_, _deque_->count - 1);                                            \
+    }                                                                                             \
+                                                                                                  \
+    V PFX##_get(struct SNAME *_deque_, size_t index)                                              \
+    {                                                                                             \
+        V *result = PFX##_get_ref(_deque_, index);                                                \
+                                                                                                  \
+        if (!result)                                                                              \
+            return (V){0};                                                                        \
+                                                                                                  \
+        return *result;                                                                           \
+    }                                                                                             \
+                                                                                                  \
+    V *PFX##_get_ref(struct SNAME *_deque_, size_t index)                                         \
+    {                                                                                             \
+        if (index >= _deque_->count)                                                              \
+            return NULL;                                                                          \
+                                                                                                  \
+        size_t position = _deque_->front + index;                                                 \
+                                                                                                  \
+        V *block = _deque_->blocks[_deque_->map_start + position / CMC_BLOCKDEQUE_BLOCK(V)];      \
+                                                                                                  \
+        return &(block[position % CMC_BLOCKDEQUE_BLOCK(V)]);                                      \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_contains(struct SNAME *_deque_, V element, int (*comparator)(V, V))                \
+    {                                                                                             \
+        for (size_t i = 0; i < _deque_->count; i++)                                               \
+        {                                                                                         \
+            if (comparator(PFX##_get(_deque_, i), element) == 0)                                  \
+                return true;                                                                      \
+        }                                                                                         \
+                                                                                                  \
+        return false;                                                                             \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_empty(struct SNAME *_deque_)                                                       \
+    {                                                                                             \
+        return _deque_->count == 0;                                                               \
+    }                                                                                             \
+                                                                                                  \
+    size_t PFX##_count(struct SNAME *_deque_)                                                     \
+    {                                                                                             \
+        return _deque_->count;                                                                    \
+    }                                                                                             \
+                                                                                                  \
+    size_t PFX##_memory_usage(struct SNAME *_deque_)                                              \
+    {                                                                                             \
+        size_t blocks = _deque_->spare ? 1 : 0;                                                   \
+                                                                                                  \
+        for (size_t i = 0; i < _deque_->map_capacity; i++)                                        \
+        {                                                                                         \
+            if (_deque_->blocks[i])                                                               \
+                blocks++;                                                                         \
+        }                                                                                         \
+                                                                                                  \
+        return sizeof(struct SNAME) + sizeof(V *) * _deque_->map_capacity +                       \
+               sizeof(V) * CMC_BLOCKDEQUE_BLOCK(V) * blocks;                                      \
+    }                                                                                             \
+                                                                                                  \
+    /* Frees the spare block and makes the map just large enough for the */                       \
+    /* blocks in use */                                                                           \
+    bool PFX##_shrink_to_fit(struct SNAME *_deque_)                                               \
+    {                                                                                             \
+        size_t used = (_deque_->front + _deque_->count + CMC_BLOCKDEQUE_BLOCK(V) - 1) /           \
+                      CMC_BLOCKDEQUE_BLOCK(V);                                                    \
+                                                                                                  \
+        size_t map_capacity = used + 2;                                                           \
+                                                                                                  \
+        V **blocks = _deque_->alloc->calloc(map_capacity, sizeof(V *));                           \
+                                                                                                  \
+        if (CMC_UNLIKELY(!blocks))                                                                \
+            return false;                                                                         \
+                                                                                                  \
+        memcpy(blocks + 1, _deque_->blocks + _deque_->map_start, used * sizeof(V *));             \
+                                                                                                  \
+        _deque_->alloc->free(_deque_->spare);                                                     \
+        _deque_->alloc->free(_deque_->blocks);                                                    \
+                                                                                                  \
+        _deque_->spare = NULL;                                                                    \
+        _deque_->blocks = blocks;                                                                 \
+        _deque_->map_capacity = map_capacity;                                                     \
+        _deque_->map_start = 1;                                                                   \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    struct cmc_string PFX##_to_string(struct SNAME *_deque_)                                      \
+    {                                                                                             \
+        struct cmc_string str;                                                                    \
+        struct SNAME *d_ = _deque_;                                                               \
+        const char *name = #SNAME;                                                                \
+                                                                                                  \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_blockdeque, name, d_, d_->blocks,          \
+                 d_->map_capacity, d_->map_start, d_->count, d_->front);                          \
+                                                                                                  \
+        return str;                                                                               \
+    }                                                                                             \
+                                                                                                  \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE)                                \
+                                                                                                  \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE, (V))                                  \
+                                                                                                  \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                         \
+    {                                                                                             \
+        iter->target = target;                                                                    \
+        iter->cursor = 0;                                                                         \
+        iter->start = true;                                                                       \
+        iter->end = PFX##_empty(target);                                                          \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                              \
+    {                                                                                             \
+        return PFX##_empty(iter->target) || iter->start;                                          \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                                \
+    {                                                                                             \
+        return PFX##_empty(iter->target) || iter->end;                                            \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                           \
+    {                                                                                             \
+        if (!PFX##_empty(iter->target))                                                           \
+        {                                                                                         \
+            iter->cursor = 0;                                                                     \
+            iter->start = true;                                                                   \
+            iter->end = false;                                                                    \
+        }                                                                                         \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                             \
+    {                                                                                             \
+        if (!PFX##_empty(iter->target))                                                           \
+        {                                                                                         \
+            iter->cursor = iter->target->count - 1;                                               \
+            iter->start = false;                                                                  \
+            iter->end = true;                                                                     \
+        }                                                                                         \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                               \
+    {                                                                                             \
+        if (iter->end)                                                                            \
+            return false;                                                                         \
+                                                                                                  \
+        if (iter->cursor + 1 == iter->target->count)                                              \
+        {                                                                                         \
+            iter->end = true;                                                                     \
+            return false;                                                                         \
+        }                                                                                         \
+                                                                                                  \
+        iter->start = false;                                                                      \
+        iter->cursor++;                                                                           \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                               \
+    {                                                                                             \
+        if (iter->start)                                                                          \
+            return false;                                                                         \
+                                                                                                  \
+        if (iter->cursor == 0)                                                                    \
+        {                                                                                         \
+            iter->start = true;                                                                   \
+            return false;                                                                         \
+        }                                                                                         \
+                                                                                                  \
+        iter->end = false;                                                                        \
+        iter->cursor--;                                                                           \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Returns true only if the iterator moved */                                                 \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps)                              \
+    {                                                                                             \
+        if (iter->end)                                                                            \
+            return false;                                                                         \
+                                                                                                  \
+        if (iter->cursor + 1 == iter->target->count)                                              \
+        {                                                                                         \
+            iter->end = true;                                                                     \
+            return false;                                                                         \
+        }                                                                                         \
+                                                                                                  \
+        if (steps == 0 || iter->cursor + steps >= iter->target->count)                            \
+            return false;                                                                         \
+                                                                                                  \
+        iter->start = false;                                                                      \
+        iter->cursor += steps;                                                                    \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Returns true only if the iterator moved */                                                 \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps)                               \
+    {                                                                                             \
+        if (iter->start)                                                                          \
+            return false;                                                                         \
+                                                                                                  \
+        if (iter->cursor == 0)                                                                    \
+        {                                                                                         \
+            iter->start = true;                                                                   \
+            return false;                                                                         \
+        }                                                                                         \
+                                                                                                  \
+        if (steps == 0 || iter->cursor < steps)                                                   \
+            return false;                                                                         \
+                                                                                                  \
+        iter->end = false;                                                                        \
+        iter->cursor -= steps;                                                                    \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Returns true only if the iterator was able to be positioned at the */                      \
+    /* given index */                                                                             \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index)                                \
+    {                                                                                             \
+        if (index >= iter->target->count)                                                         \
+            return false;                                                                         \
+                                                                                                  \
+        if (iter->cursor > index)                                                                 \
+            return PFX##_iter_rewind(iter, iter->cursor - index);                                 \
+        else if (iter->cursor < index)                                                            \
+            return PFX##_iter_advance(iter, index - iter->cursor);                                \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                                 \
+    {                                                                                             \
+        return PFX##_get(iter->target, iter->cursor);                                             \
+    }                                                                                             \
+                                                                                                  \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter)                                               \
+    {                                                                                             \
+        return PFX##_get_ref(iter->target, iter->cursor);                                         \
+    }                                                                                             \
+                                                                                                  \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                            \
+    {                                                                                             \
+        return iter->cursor;                                                                      \
+    }                                                                                             \
+                                                                                                  \
+    /* Block at the given slot of the map, allocating it if needed */                             \
+    static V *PFX##_impl_block(struct SNAME *_deque_, size_t slot)                                \
+    {                                                                                             \
+        if (_deque_->blocks[slot])                                                                \
+            return _deque_->blocks[slot];                                                         \
+                                                                                                  \
+        V *block = _deque_->spare;                                                                \
+                                                                                                  \
+        if (block)                                                                                \
+            _deque_->spare = NULL;                                                                \
+        else                                                                                      \
+        {                                                                                         \
+            block = _deque_->alloc->malloc(sizeof(V) * CMC_BLOCKDEQUE_BLOCK(V));                  \
+                                                                                                  \
+            if (CMC_UNLIKELY(!block))                                                             \
+                return NULL;                                                                      \
+        }                                                                                         \
+                                                                                                  \
+        _deque_->blocks[slot] = block;                                                            \
+                                                                                                  \
+        return block;                                                                             \
+    }                                                                                             \
+                                                                                                  \
+    /* Frees the block at the given slot, or keeps it as the spare */                             \
+    static void PFX##_impl_release(struct SNAME *_deque_, size_t slot)                            \
+    {                                                                                             \
+        V *block = _deque_->blocks[slot];                                                         \
+                                                                                                  \
+        if (!block)                                                                               \
+            return;                                                                               \
+                                                                                                  \
+        if (_deque_->spare)                                                                       \
+            _deque_->alloc->free(block);                                                          \
+        else                                                                                      \
+            _deque_->spare = block;                                                               \
+                                                                                                  \
+        _deque_->blocks[slot] = NULL;                                                             \
+    }                                                                                             \
+                                                                                                  \
+    /* An empty deque starts in the middle of the map and of its block */                         \
+    static void PFX##_impl_reset(struct SNAME *_deque_)                                           \
+    {                                                                                             \
+        _deque_->map_start = _deque_->map_capacity / 2;                                           \
+        _deque_->front = CMC_BLOCKDEQUE_BLOCK(V) / 2;                                             \
+    }                                                                                             \
+                                                                                                  \
+    /* Called when one end of the map has no free slot. Centers the blocks */                     \
+    /* in use in a map with at least as many free slots as used ones. Only the */                 \
+    /* pointers to the blocks are moved */                                                        \
+    static bool PFX##_impl_map_room(struct SNAME *_deque_)                                        \
+    {                                                                                             \
+        size_t used = (_deque_->front + _deque_->count + CMC_BLOCKDEQUE_BLOCK(V) - 1) /           \
+                      CMC_BLOCKDEQUE_BLOCK(V);                                                    \
+                                                                                                  \
+        size_t map_capacity = _deque_->map_capacity;                                              \
+                                                                                                  \
+        if (map_capacity < 2 * (used + 1))                                                        \
+            map_capacity = map_capacity * 2 > 2 * (used + 1) ? map_capacity * 2 : 2 * (used + 1); \
+                                                                                                  \
+        size_t map_start = (map_capacity - used) / 2;                                             \
+                                                                                                  \
+        if (map_capacity == _deque_->map_capacity)                                                \
+        {                                                                                         \
+            V **blocks = _deque_->blocks;                                                         \
+                                                                                                  \
+            memmove(blocks + map_start, blocks + _deque_->map_start, used * sizeof(V *));         \
+                                                                                                  \
+            for (size_t i = 0; i < map_capacity; i++)                                             \
+            {                                                                                     \
+                if (i < map_start || i >= map_start + used)                                       \
+                    blocks[i] = NULL;                                                             \
+            }                                                                                     \
+        }                                                                                         \
+        else                                                                                      \
+        {                                                                                         \
+            V **blocks = _deque_->alloc->calloc(map_capacity, sizeof(V *));                       \
+                                                                                                  \
+            if (CMC_UNLIKELY(!blocks))                                                            \
+                return false;                                                                     \
+                                                                                                  \
+            memcpy(blocks + map_start, _deque_->blocks + _deque_->map_start, used * sizeof(V *)); \
+                                                                                                  \
+            _deque_->alloc->free(_deque_->blocks);                                                \
+                                                                                                  \
+            _deque_->blocks = blocks;                                                             \
+            _deque_->map_capacity = map_capacity;                                                 \
+        }                                                                                         \
+                                                                                                  \
+        _deque_->map_start = map_start;                                                           \
+                                                                                                  \
+        return true;                                                                              \
+    }
+
+#endif /* CMC_BLOCKDEQUE_H */
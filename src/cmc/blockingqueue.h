@@ -0,0 +1,464 @@
+/**
+ * blockingqueue.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * BlockingQueue
+ *
+ * A BlockingQueue is a Queue of a bounded capacity shared by producer and
+ * consumer threads, like the stages of a pipeline. put waits while the queue
+ * is full and take waits while it is empty. offer and poll wait at most a
+ * timeout, in nanoseconds, and a timeout of 0 never waits. drain_to takes
+ * every element available at once without waiting.
+ *
+ * A closed queue rejects new elements and wakes every waiting thread. The
+ * elements already in it can still be taken and take and poll return false
+ * once it is closed and empty, which tells consumers to finish. Requires
+ * pthreads.
+ *
+ * Implementation
+ *
+ * The elements are kept in a Queue protected by a mutex. A consumer is only
+ * signaled when the queue goes from empty to not empty and a producer only
+ * when it goes from full to not full, and only if a thread is waiting. A
+ * thread that is woken signals the next waiting one if there is still room
+ * or elements left, so no thread is left waiting when it could proceed.
+ * Signals are sent after the mutex is released so the woken thread does
+ * not have to wait for it.
+ *
+ * Timeouts are measured with the C11 timespec_get clock, which is the one
+ * pthread_cond_timedwait uses by default.
+ */
+
+#ifndef CMC_BLOCKINGQUEUE_H
+#define CMC_BLOCKINGQUEUE_H
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+#include "queue.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_blockingqueue = "%s at %p { queue:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", closed:%s }";
+
+#define CMC_GENERATE_BLOCKING_QUEUE(PFX, SNAME, V)    \
+    CMC_GENERATE_BLOCKING_QUEUE_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_BLOCKING_QUEUE_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_BLOCKING_QUEUE_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_BLOCKING_QUEUE_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_BLOCKING_QUEUE_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_BLOCKING_QUEUE_SOURCE(PFX, SNAME, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_BLOCKING_QUEUE_HEADER(PFX, SNAME, V)                   \
+    /* The Queue that holds the elements */                                 \
+    CMC_GENERATE_QUEUE_HEADER(PFX##_queue, SNAME##_queue, V)                \
+                                                                            \
+    /* BlockingQueue Structure */                                           \
+    struct SNAME                                                            \
+    {                                                                       \
+        /* Elements in the order they were put */                           \
+        struct SNAME##_queue *queue;                                        \
+                                                                            \
+        /* Maximum amount of elements */                                    \
+        size_t capacity;                                                    \
+                                                                            \
+        /* If no more elements are accepted */                              \
+        bool closed;                                                        \
+                                                                            \
+        /* Threads waiting in take or poll */                               \
+        size_t waiting_consumers;                                           \
+                                                                            \
+        /* Threads waiting in put or offer */                               \
+        size_t waiting_producers;                                           \
+                                                                            \
+        /* Protects every other field */                                    \
+        pthread_mutex_t lock;                                               \
+                                                                            \
+        /* Signaled when an element is put in an empty queue */             \
+        pthread_cond_t not_empty;                                           \
+                                                                            \
+        /* Signaled when an element is taken from a full queue */           \
+        pthread_cond_t not_full;                                            \
+                                                                            \
+        /* Custom allocation functions */                                   \
+        struct cmc_alloc_node *alloc;                                       \
+    };                                                                      \
+                                                                            \
+    /* Collection Functions */                                              \
+    /* Collection Allocation and Deallocation */                            \
+    struct SNAME *PFX##_new(size_t capacity);                               \
+    struct SNAME *PFX##_new_custom(size_t capacity,                         \
+                                   struct cmc_alloc_node *alloc);           \
+    void PFX##_free(struct SNAME *_queue_, void (*deallocator)(V));         \
+    /* Collection Input and Output */                                       \
+    bool PFX##_put(struct SNAME *_queue_, V element);                       \
+    bool PFX##_take(struct SNAME *_queue_, V *result);                      \
+    bool PFX##_offer(struct SNAME *_queue_, V element, uint64_t timeout);   \
+    bool PFX##_poll(struct SNAME *_queue_, V *result, uint64_t timeout);    \
+    size_t PFX##_drain_to(struct SNAME *_queue_, V *elements, size_t size); \
+    void PFX##_close(struct SNAME *_queue_);                                \
+    /* Collection State */                                                  \
+    bool PFX##_closed(struct SNAME *_queue_);                               \
+    bool PFX##_empty(struct SNAME *_queue_);                                \
+    bool PFX##_full(struct SNAME *_queue_);                                 \
+    size_t PFX##_count(struct SNAME *_queue_);                              \
+    size_t PFX##_memory_usage(struct SNAME *_queue_);                       \
+    size_t PFX##_capacity(struct SNAME *_queue_);                           \
+    /* Collection Utility */                                                \
+    struct cmc_string PFX##_to_string(struct SNAME *_queue_);               \
+                                                                            \
+    /* SOURCE ********************************************************************/
+#define CMC_GENERATE_BLOCKING_QUEUE_SOURCE(PFX, SNAME, V)                                         \
+    CMC_GENERATE_QUEUE_SOURCE(PFX##_queue, SNAME##_queue, V)                                      \
+                                                                                                  \
+    /* Implementation Detail Functions */                                                         \
+    static bool PFX##_impl_wait(struct SNAME *_queue_, pthread_cond_t *condition, bool timed,     \
+                                struct timespec *deadline);                                       \
+    static void PFX##_impl_deadline(struct timespec *deadline, uint64_t timeout);                 \
+    static bool PFX##_impl_offer(struct SNAME *_queue_, V element, bool timed, uint64_t timeout); \
+    static bool PFX##_impl_poll(struct SNAME *_queue_, V *result, bool timed, uint64_t timeout);  \
+                                                                                                  \
+    struct SNAME *PFX##_new(size_t capacity)                                                      \
+    {                                                                                             \
+        return PFX##_new_custom(capacity, NULL);                                                  \
+    }                                                                                             \
+                                                                                                  \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc)                 \
+    {                                                                                             \
+        if (!alloc)                                                                               \
+            alloc = &cmc_alloc_node_default;                                                      \
+                                                                                                  \
+        if (capacity < 1)                                                                         \
+            return NULL;                                                                          \
+                                                                                                  \
+        struct SNAME *_queue_ = alloc->malloc(sizeof(struct SNAME));                              \
+                                                                                                  \
+        if (CMC_UNLIKELY(!_queue_))                                                               \
+            return NULL;                                                                          \
+                                                                                                  \
+        _queue_->alloc = alloc;                                                                   \
+                                                                                                  \
+        _queue_->queue = PFX##_queue_new(capacity);                                               \
+                                                                                                  \
+        if (!_queue_->queue)                                                                      \
+        {                                                                                         \
+            alloc->free(_queue_);                                                                 \
+            return NULL;                                                                          \
+        }                                                                                         \
+                                                                                                  \
+        if (pthread_mutex_init(&(_queue_->lock), NULL) != 0)                                      \
+        {                                                                                         \
+            PFX##_queue_free(_queue_->queue, NULL);                                               \
+            alloc->free(_queue_);                                                                 \
+            return NULL;                                                                          \
+        }                                                                                         \
+                                                                                                  \
+        if (pthread_cond_init(&(_queue_->not_empty), NULL) != 0)                                  \
+        {                                                                                         \
+            pthread_mutex_destroy(&(_queue_->lock));                                              \
+            PFX##_queue_free(_queue_->queue, NULL);                                               \
+            alloc->free(_queue_);                                                                 \
+            return NULL;                                                                          \
+        }                                                                                         \
+                                                                                                  \
+        if (pthread_cond_init(&(_queue_->not_full), NULL) != 0)                                   \
+        {                                                                                         \
+            pthread_cond_destroy(&(_queue_->not_empty));                                          \
+            pthread_mutex_destroy(&(_queue_->lock));                                              \
+            PFX##_queue_free(_queue_->queue, NULL);                                               \
+            alloc->free(_queue_);                                                                 \
+            return NULL;                                                                          \
+        }                                                                                         \
+                                                                                                  \
+        _queue_->capacity = capacity;                                                             \
+        _queue_->closed = false;                                                                  \
+        _queue_->waiting_consumers = 0;                                                           \
+        _queue_->waiting_producers = 0;                                                           \
+                                                                                                  \
+        return _queue_;                                                                           \
+    }                                                                                             \
+                                                                                                  \
+    /* No thread may be using the queue */                                                        \
+    void PFX##_free(struct SNAME *_queue_, void (*deallocator)(V))                                \
+    {                                                                                             \
+        pthread_cond_destroy(&(_queue_->not_full));                                               \
+        pthread_cond_destroy(&(_queue_->not_empty));                                              \
+        pthread_mutex_destroy(&(_queue_->lock));                                                  \
+                                                                                                  \
+        PFX##_queue_free(_queue_->queue, deallocator);                                            \
+                                                                                                  \
+        _queue_->alloc->free(_queue_);                                                            \
+    }                                                                                             \
+                                                                                                  \
+    /* Waits until there is room for the element. Returns false if the queue */                   \
+    /* is closed or if the element could not be allocated */                                      \
+    bool PFX##_put(struct SNAME *_queue_, V element)                                              \
+    {                                                                                             \
+        return PFX##_impl_offer(_queue_, element, false, 0);                                      \
+    }                                                                                             \
+                                                                                                  \
+    /* Waits until there is an element. Returns false if the queue is closed */                   \
+    /* and empty */                                                                               \
+    bool PFX##_take(struct SNAME *_queue_, V *result)                                             \
+    {                                                                                             \
+        return PFX##_impl_poll(_queue_, result, false, 0);                                        \
+    }                                                                                             \
+                                                                                                  \
+    /* Same as put but waits at most timeout nanoseconds */                                       \
+    bool PFX##_offer(struct SNAME *_queue_, V element, uint64_t timeout)                          \
+    {                                                                                             \
+        return PFX##_impl_offer(_queue_, element, true, timeout);                                 \
+    }                                                                                             \
+                                                                                                  \
+    /* Same as take but waits at most timeout nanoseconds */                                      \
+    bool PFX##_poll(struct SNAME *_queue_, V *result, uint64_t timeout)                           \
+    {                                                                                             \
+        return PFX##_impl_poll(_queue_, result, true, timeout);                                   \
+    }                                                                                             \
+                                                                                                  \
+    /* Takes up to size of the elements available without waiting, copying */                     \
+    /* them to elements. Returns how many were taken */                                           \
+    size_t PFX##_drain_to(struct SNAME *_queue_, V *elements, size_t size)                        \
+    {                                                                                             \
+        pthread_mutex_lock(&(_queue_->lock));                                                     \
+                                                                                                  \
+        bool was_full = _queue_->queue->count >= _queue_->capacity;                               \
+                                                                                                  \
+        size_t taken = PFX##_queue_dequeue_many(_queue_->queue, elements, size);                  \
+                                                                                                  \
+        bool wake = was_full && taken > 0 && _queue_->waiting_producers > 0;                      \
+                                                                                                  \
+        pthread_mutex_unlock(&(_queue_->lock));                                                   \
+                                                                                                  \
+        /* The woken producer wakes the next one if there is still room */                        \
+        if (wake)                                                                                 \
+            pthread_cond_signal(&(_queue_->not_full));                                            \
+                                                                                                  \
+        return taken;                                                                             \
+    }                                                                                             \
+                                                                                                  \
+    /* Rejects every new element and wakes every waiting thread */                                \
+    void PFX##_close(struct SNAME *_queue_)                                                       \
+    {                                                                                             \
+        pthread_mutex_lock(&(_queue_->lock));                                                     \
+                                                                                                  \
+        _queue_->closed = true;                                                                   \
+                                                                                                  \
+        pthread_mutex_unlock(&(_queue_->lock));                                                   \
+                                                                                                  \
+        pthread_cond_broadcast(&(_queue_->not_empty));                                            \
+        pthread_cond_broadcast(&(_queue_->not_full));                                             \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_closed(struct SNAME *_queue_)                                                      \
+    {                                                                                             \
+        pthread_mutex_lock(&(_queue_->lock));                                                     \
+                                                                                                  \
+        bool closed = _queue_->closed;                                                            \
+                                                                                                  \
+        pthread_mutex_unlock(&(_queue_->lock));                                                   \
+                                                                                                  \
+        return closed;                                                                            \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_empty(struct SNAME *_queue_)                                                       \
+    {                                                                                             \
+        return PFX##_count(_queue_) == 0;                                                         \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_full(struct SNAME *_queue_)                                                        \
+    {                                                                                             \
+        return PFX##_count(_queue_) >= _queue_->capacity;                                         \
+    }                                                                                             \
+                                                                                                  \
+    size_t PFX##_count(struct SNAME *_queue_)                                                     \
+    {                                                                                             \
+        pthread_mutex_lock(&(_queue_->lock));                                                     \
+                                                                                                  \
+        size_t count = _queue_->queue->count;                                                     \
+                                                                                                  \
+        pthread_mutex_unlock(&(_queue_->lock));                                                   \
+                                                                                                  \
+        return count;                                                                             \
+    }                                                                                             \
+                                                                                                  \
+    size_t PFX##_memory_usage(struct SNAME *_queue_)                                              \
+    {                                                                                             \
+        pthread_mutex_lock(&(_queue_->lock));                                                     \
+                                                                                                  \
+        size_t bytes = sizeof(struct SNAME) + PFX##_queue_memory_usage(_queue_->queue);           \
+                                                                                                  \
+        pthread_mutex_unlock(&(_queue_->lock));                                                   \
+                                                                                                  \
+        return bytes;                                                                             \
+    }                                                                                             \
+                                                                                                  \
+    size_t PFX##_capacity(struct SNAME *_queue_)                                                  \
+    {                                                                                             \
+        return _queue_->capacity;                                                                 \
+    }                                                                                             \
+                                                                                                  \
+    struct cmc_string PFX##_to_string(struct SNAME *_queue_)                                      \
+    {                                                                                             \
+        struct cmc_string str;                                                                    \
+        struct SNAME *q_ = _queue_;                                                               \
+        const char *name = #SNAME;                                                                \
+                                                                                                  \
+        pthread_mutex_lock(&(q_->lock));                                                          \
+                                                                                                  \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_blockingqueue, name, q_, q_->queue,        \
+                 q_->capacity, q_->queue->count, q_->closed ? "true" : "false");                  \
+                                                                                                  \
+        pthread_mutex_unlock(&(q_->lock));                                                        \
+                                                                                                  \
+        return str;                                                                               \
+    }                                                                                             \
+                                                                                                  \
+    /* Called with the lock held. Waits on condition until it is signaled or */                   \
+    /* the deadline passes. Returns false once the deadline passed */                             \
+    static bool PFX##_impl_wait(struct SNAME *_queue_, pthread_cond_t *condition, bool timed,     \
+                                struct timespec *deadline)                                        \
+    {                                                                                             \
+        if (!timed)                                                                               \
+        {                                                                                         \
+            pthread_cond_wait(condition, &(_queue_->lock));                                       \
+            return true;                                                                          \
+        }                                                                                         \
+                                                                                                  \
+        return pthread_cond_timedwait(condition, &(_queue_->lock), deadline) != ETIMEDOUT;        \
+    }                                                                                             \
+                                                                                                  \
+    /* The time timeout nanoseconds from now */                                                   \
+    static void PFX##_impl_deadline(struct timespec *deadline, uint64_t timeout)                  \
+    {                                                                                             \
+        timespec_get(deadline, TIME_UTC);                                                         \
+                                                                                                  \
+        uint64_t nanoseconds = (uint64_t)deadline->tv_nsec + timeout % 1000000000;                \
+                                                                                                  \
+        deadline->tv_sec += (time_t)(timeout / 1000000000 + nanoseconds / 1000000000);            \
+        deadline->tv_nsec = (long)(nanoseconds % 1000000000);                                     \
+    }                                                                                             \
+                                                                                                  \
+    static bool PFX##_impl_offer(struct SNAME *_queue_, V element, bool timed, uint64_t timeout)  \
+    {                                                                                             \
+        struct timespec deadline;                                                                 \
+                                                                                                  \
+        pthread_mutex_lock(&(_queue_->lock));                                                     \
+                                                                                                  \
+        if (_queue_->queue->count >= _queue_->capacity && !_queue_->closed)                       \
+        {                                                                                         \
+            if (timed && timeout == 0)                                                            \
+            {                                                                                     \
+                pthread_mutex_unlock(&(_queue_->lock));                                           \
+                return false;                                                                     \
+            }                                                                                     \
+                                                                                                  \
+            if (timed)                                                                            \
+                PFX##_impl_deadline(&deadline, timeout);                                          \
+                                                                                                  \
+            _queue_->waiting_producers++;                                                         \
+                                                                                                  \
+            bool waited = true;                                                                   \
+                                                                                                  \
+            while (_queue_->queue->count >= _queue_->capacity && !_queue_->closed && waited)      \
+                waited = PFX##_impl_wait(_queue_, &(_queue_->not_full), timed, &deadline);        \
+                                                                                                  \
+            _queue_->waiting_producers--;                                                         \
+        }                                                                                         \
+                                                                                                  \
+        if (_queue_->queue->count >= _queue_->capacity || _queue_->closed ||                      \
+            !PFX##_queue_enqueue(_queue_->queue, element))                                        \
+        {                                                                                         \
+            pthread_mutex_unlock(&(_queue_->lock));                                               \
+            return false;                                                                         \
+        }                                                                                         \
+                                                                                                  \
+        size_t count = _queue_->queue->count;                                                     \
+                                                                                                  \
+        bool wake_consumer = count == 1 && _queue_->waiting_consumers > 0;                        \
+        bool wake_producer = count < _queue_->capacity && _queue_->waiting_producers > 0;         \
+                                                                                                  \
+        pthread_mutex_unlock(&(_queue_->lock));                                                   \
+                                                                                                  \
+        if (wake_consumer)                                                                        \
+            pthread_cond_signal(&(_queue_->not_empty));                                           \
+        if (wake_producer)                                                                        \
+            pthread_cond_signal(&(_queue_->not_full));                                            \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    static bool PFX##_impl_poll(struct SNAME *_queue_, V *result, bool timed, uint64_t timeout)   \
+    {                                                                                             \
+        struct timespec deadline;                                                                 \
+                                                                                                  \
+        pthread_mutex_lock(&(_queue_->lock));                                                     \
+                                                                                                  \
+        if (_queue_->queue->count == 0 && !_queue_->closed)                                       \
+        {                                                                                         \
+            if (timed && timeout == 0)                                                            \
+            {                                                                                     \
+                pthread_mutex_unlock(&(_queue_->lock));                                           \
+                return false;                                                                     \
+            }                                                                                     \
+                                                                                                  \
+            if (timed)                                                                            \
+                PFX##_impl_deadline(&deadline, timeout);                                          \
+                                                                                                  \
+            _queue_->waiting_consumers++;                                                         \
+                                                                                                  \
+            bool waited = true;                                                                   \
+                                                                                                  \
+            while (_queue_->queue->count == 0 && !_queue_->closed && waited)                      \
+                waited = PFX##_impl_wait(_queue_, &(_queue_->not_empty), timed, &deadline);       \
+                                                                                                  \
+            _queue_->waiting_consumers--;                                                         \
+        }                                                                                         \
+                                                                                                  \
+        if (_queue_->queue->count == 0)                                                           \
+        {                                                                                         \
+            pthread_mutex_unlock(&(_queue_->lock));                                               \
+            return false;                                                                         \
+        }                                                                                         \
+                                                                                                  \
+        bool was_full = _queue_->queue->count >= _queue_->capacity;                               \
+                                                                                                  \
+        if (result)                                                                               \
+            *result = PFX##_queue_peek(_queue_->queue);                                           \
+                                                                                                  \
+        PFX##_queue_dequeue(_queue_->queue);                                                      \
+                                                                                                  \
+        size_t count = _queue_->queue->count;                                                     \
+                                                                                                  \
+        bool wake_producer = was_full && _queue_->waiting_producers > 0;                          \
+        bool wake_consumer = count > 0 && _queue_->waiting_consumers > 0;                         \
+                                                                                                  \
+        pthread_mutex_unlock(&(_queue_->lock));                                                   \
+                                                                                                  \
+        if (wake_producer)                                                                        \
+            pthread_cond_signal(&(_queue_->not_full));                                            \
+        if (wake_consumer)                                                                        \
+            pthread_cond_signal(&(_queue_->not_empty));                                           \
+                                                                                                  \
+        return true;                                                                              \
+    }
+
+#endif /* CMC_BLOCKINGQUEUE_H */
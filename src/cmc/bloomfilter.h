@@ -0,0 +1,423 @@
+/**
+ * bloomfilter.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * BloomFilter
+ *
+ * A BloomFilter is a probabilistic Set that only answers if an element might
+ * have been inserted. It never gives false negatives but some elements that
+ * were never inserted are reported as present. In exchange it only takes a few
+ * bits per element and elements are not stored at all, so they can't be
+ * removed or iterated. It is meant to be put in front of a bigger collection
+ * to reject elements that are not there without touching it.
+ *
+ * Implementation
+ *
+ * The bits are split in blocks of one cache line. The hash of an element,
+ * given by the same size_t (*hash)(V) function used by the HashSet, is mixed
+ * by cmc_hash_u64() and then selects one block and the k positions inside of
+ * it. Every insert and contains only touch one cache line.
+ * Blocks have a slightly higher false positive rate than spreading the bits
+ * over the entire filter, which is taken into account by its capacity.
+ */
+
+#ifndef CMC_BLOOMFILTER_H
+#define CMC_BLOOMFILTER_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_math.h"
+#include "../utl/cmc_string.h"
+#include "../utl/hash.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_bloomfilter = "%s at %p { blocks:%p, block_count:%" PRIuMAX ", probes:%" PRIuMAX ", count:%" PRIuMAX ", hash:%p }";
+
+/* Blocks are aligned to and as big as this size */
+#ifndef CMC_CACHE_LINE_SIZE
+#define CMC_CACHE_LINE_SIZE 64
+#endif
+
+/* Bits of a block, always a power of two */
+#define CMC_BLOOMFILTER_BLOCK_BITS (CMC_CACHE_LINE_SIZE * 8)
+
+/* Maximum amount of bits set by each element */
+#define CMC_BLOOMFILTER_MAX_PROBES 16
+
+/* Bits per element that blocks need in addition to the ones of a classic */
+/* Bloom filter to get close to the same false positive rate */
+#define CMC_BLOOMFILTER_BLOCK_OVERHEAD 1.1
+
+#define CMC_GENERATE_BLOOMFILTER(PFX, SNAME, V)    \
+    CMC_GENERATE_BLOOMFILTER_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_BLOOMFILTER_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_BLOOMFILTER_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_BLOOMFILTER_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_BLOOMFILTER_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_BLOOMFILTER_SOURCE(PFX, SNAME, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_BLOOMFILTER_HEADER(PFX, SNAME, V)                                    \
+                                                                                          \
+    /* BloomFilter Structure */                                                           \
+    struct SNAME                                                                          \
+    {                                                                                     \
+        /* Array of block_count blocks of CMC_BLOOMFILTER_BLOCK_BITS bits */              \
+        uint64_t *blocks;                                                                 \
+                                                                                          \
+        /* Amount of blocks */                                                            \
+        size_t block_count;                                                               \
+                                                                                          \
+        /* Amount of bits set by each element (k) */                                      \
+        size_t probes;                                                                    \
+                                                                                          \
+        /* Amount of insertions that set at least one bit */                              \
+        size_t count;                                                                     \
+                                                                                          \
+        /* Element hash function */                                                       \
+        size_t (*hash)(V);                                                                \
+                                                                                          \
+        /* Custom allocation functions */                                                 \
+        struct cmc_alloc_node *alloc;                                                     \
+    };                                                                                    \
+                                                                                          \
+    /* Collection Functions */                                                            \
+    /* Collection Allocation and Deallocation */                                          \
+    struct SNAME *PFX##_new(size_t capacity, double fpr, size_t (*hash)(V));              \
+    struct SNAME *PFX##_new_custom(size_t block_count, size_t probes, size_t (*hash)(V),  \
+                                   struct cmc_alloc_node *alloc);                         \
+    void PFX##_clear(struct SNAME *_filter_);                                             \
+    void PFX##_free(struct SNAME *_filter_);                                              \
+    /* Collection Input and Output */                                                     \
+    bool PFX##_insert(struct SNAME *_filter_, V element);                                 \
+    size_t PFX##_insert_many(struct SNAME *_filter_, V *elements, size_t n);              \
+    /* Collection State */                                                                \
+    bool PFX##_contains(struct SNAME *_filter_, V element);                               \
+    CMC_PURE bool PFX##_empty(struct SNAME *_filter_);                                    \
+    CMC_PURE size_t PFX##_count(struct SNAME *_filter_);                                  \
+    size_t PFX##_memory_usage(struct SNAME *_filter_);                                    \
+    size_t PFX##_bits(struct SNAME *_filter_);                                            \
+    size_t PFX##_probes(struct SNAME *_filter_);                                          \
+    double PFX##_fill(struct SNAME *_filter_);                                            \
+    double PFX##_fpr(struct SNAME *_filter_);                                             \
+    /* Collection Utility */                                                              \
+    struct SNAME *PFX##_copy_of(struct SNAME *_filter_);                                  \
+    bool PFX##_equals(struct SNAME *_filter1_, struct SNAME *_filter2_);                  \
+    struct cmc_string PFX##_to_string(struct SNAME *_filter_);                            \
+                                                                                          \
+    /* Set Operations */                                                                  \
+    bool PFX##_compatible(struct SNAME *_filter1_, struct SNAME *_filter2_);              \
+    struct SNAME *PFX##_union(struct SNAME *_filter1_, struct SNAME *_filter2_);          \
+    bool PFX##_union_into(struct SNAME *_filter1_, struct SNAME *_filter2_);              \
+                                                                                          \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_BLOOMFILTER_SOURCE(PFX, SNAME, V)                                            \
+                                                                                                  \
+    /* Implementation Detail Functions */                                                         \
+    static uint64_t *PFX##_impl_block(struct SNAME *_filter_, uint64_t hash);                     \
+    static inline size_t PFX##_impl_next_bit(uint64_t *hash);                                     \
+                                                                                                  \
+    /* Creates a filter for capacity elements with a false positive rate of */                    \
+    /* about fpr once all of them were inserted */                                                \
+    struct SNAME *PFX##_new(size_t capacity, double fpr, size_t (*hash)(V))                       \
+    {                                                                                             \
+        if (capacity == 0 || fpr <= 0 || fpr >= 1)                                                \
+            return NULL;                                                                          \
+                                                                                                  \
+        const double ln2 = 0.69314718055994530942;                                                \
+                                                                                                  \
+        /* Classic sizing, bits = -n ln(p) / ln(2)^2 and k = bits / n * ln(2) */                  \
+        double bits_per_element = -cmc_math_ln(fpr) / (ln2 * ln2);                                \
+        double probes = bits_per_element * ln2 + 0.5;                                             \
+                                                                                                  \
+        bits_per_element *= CMC_BLOOMFILTER_BLOCK_OVERHEAD;                                       \
+                                                                                                  \
+        double bits = bits_per_element * (double)capacity;                                        \
+                                                                                                  \
+        /* Prevent integer overflow */                                                            \
+        if (bits >= (double)SIZE_MAX / 2)                                                         \
+            return NULL;                                                                          \
+                                                                                                  \
+        size_t block_count =                                                                      \
+            ((size_t)bits + CMC_BLOOMFILTER_BLOCK_BITS - 1) / CMC_BLOOMFILTER_BLOCK_BITS;         \
+                                                                                                  \
+        return PFX##_new_custom(block_count, (size_t)probes, hash, NULL);                         \
+    }                                                                                             \
+                                                                                                  \
+    /* Creates a filter with a given size and amount of bits per element */                       \
+    /* whose memory comes from alloc, or the standard library if it is NULL */                    \
+    struct SNAME *PFX##_new_custom(size_t block_count, size_t probes, size_t (*hash)(V),          \
+                                   struct cmc_alloc_node *alloc)                                  \
+    {                                                                                             \
+        if (!alloc)                                                                               \
+            alloc = &cmc_alloc_node_default;                                                      \
+                                                                                                  \
+        if (block_count == 0 || block_count > SIZE_MAX / CMC_CACHE_LINE_SIZE)                     \
+            return NULL;                                                                          \
+                                                                                                  \
+        if (probes == 0)                                                                          \
+            probes = 1;                                                                           \
+        else if (probes > CMC_BLOOMFILTER_MAX_PROBES)                                             \
+            probes = CMC_BLOOMFILTER_MAX_PROBES;                                                  \
+                                                                                                  \
+        struct SNAME *_filter_ = alloc->malloc(sizeof(struct SNAME));                             \
+                                                                                                  \
+        if (CMC_UNLIKELY(!_filter_))                                                              \
+            return NULL;                                                                          \
+                                                                                                  \
+        _filter_->alloc = alloc;                                                                  \
+                                                                                                  \
+        _filter_->blocks =                                                                        \
+            cmc_alloc_aligned(alloc, CMC_CACHE_LINE_SIZE, block_count * CMC_CACHE_LINE_SIZE);     \
+                                                                                                  \
+        if (!_filter_->blocks)                                                                    \
+        {                                                                                         \
+            alloc->free(_filter_);                                                                \
+            return NULL;                                                                          \
+        }                                                                                         \
+                                                                                                  \
+        memset(_filter_->blocks, 0, block_count * CMC_CACHE_LINE_SIZE);                           \
+                                                                                                  \
+        _filter_->block_count = block_count;                                                      \
+        _filter_->probes = probes;                                                                \
+        _filter_->count = 0;                                                                      \
+        _filter_->hash = hash;                                                                    \
+                                                                                                  \
+        return _filter_;                                                                          \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_clear(struct SNAME *_filter_)                                                      \
+    {                                                                                             \
+        memset(_filter_->blocks, 0, _filter_->block_count * CMC_CACHE_LINE_SIZE);                 \
+                                                                                                  \
+        _filter_->count = 0;                                                                      \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_free(struct SNAME *_filter_)                                                       \
+    {                                                                                             \
+        cmc_alloc_aligned_free(_filter_->alloc, _filter_->blocks);                                \
+        _filter_->alloc->free(_filter_);                                                          \
+    }                                                                                             \
+                                                                                                  \
+    /* Returns false if the element was already reported as present */                            \
+    bool PFX##_insert(struct SNAME *_filter_, V element)                                          \
+    {                                                                                             \
+        uint64_t hash = cmc_hash_u64(_filter_->hash(element));                                    \
+        uint64_t *block = PFX##_impl_block(_filter_, hash);                                       \
+        uint64_t changed = 0;                                                                     \
+                                                                                                  \
+        for (size_t i = 0; i < _filter_->probes; i++)                                             \
+        {                                                                                         \
+            size_t bit = PFX##_impl_next_bit(&hash);                                              \
+            uint64_t mask = UINT64_C(1) << (bit & 63);                                            \
+                                                                                                  \
+            changed |= ~block[bit >> 6] & mask;                                                   \
+            block[bit >> 6] |= mask;                                                              \
+        }                                                                                         \
+                                                                                                  \
+        if (!changed)                                                                             \
+            return false;                                                                         \
+                                                                                                  \
+        _filter_->count++;                                                                        \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Returns how many elements were not reported as present before */                           \
+    size_t PFX##_insert_many(struct SNAME *_filter_, V *elements, size_t n)                       \
+    {                                                                                             \
+        size_t inserted = 0;                                                                      \
+                                                                                                  \
+        for (size_t i = 0; i < n; i++)                                                            \
+        {                                                                                         \
+            if (PFX##_insert(_filter_, elements[i]))                                              \
+                inserted++;                                                                       \
+        }                                                                                         \
+                                                                                                  \
+        return inserted;                                                                          \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_contains(struct SNAME *_filter_, V element)                                        \
+    {                                                                                             \
+        uint64_t hash = cmc_hash_u64(_filter_->hash(element));                                    \
+        uint64_t *block = PFX##_impl_block(_filter_, hash);                                       \
+                                                                                                  \
+        for (size_t i = 0; i < _filter_->probes; i++)                                             \
+        {                                                                                         \
+            size_t bit = PFX##_impl_next_bit(&hash);                                              \
+                                                                                                  \
+            if (!(block[bit >> 6] & (UINT64_C(1) << (bit & 63))))                                 \
+                return false;                                                                     \
+        }                                                                                         \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_empty(struct SNAME *_filter_)                                                      \
+    {                                                                                             \
+        return _filter_->count == 0;                                                              \
+    }                                                                                             \
+                                                                                                  \
+    size_t PFX##_count(struct SNAME *_filter_)                                                    \
+    {                                                                                             \
+        return _filter_->count;                                                                   \
+    }                                                                                             \
+                                                                                                  \
+    size_t PFX##_memory_usage(struct SNAME *_filter_)                                             \
+    {                                                                                             \
+        size_t blocks = _filter_->block_count * CMC_CACHE_LINE_SIZE;                              \
+                                                                                                  \
+        return sizeof(struct SNAME) + cmc_alloc_aligned_size(CMC_CACHE_LINE_SIZE, blocks);        \
+    }                                                                                             \
+                                                                                                  \
+    size_t PFX##_bits(struct SNAME *_filter_)                                                     \
+    {                                                                                             \
+        return _filter_->block_count * CMC_BLOOMFILTER_BLOCK_BITS;                                \
+    }                                                                                             \
+                                                                                                  \
+    size_t PFX##_probes(struct SNAME *_filter_)                                                   \
+    {                                                                                             \
+        return _filter_->probes;                                                                  \
+    }                                                                                             \
+                                                                                                  \
+    /* Fraction of the bits that are set. Goes through the entire filter */                       \
+    double PFX##_fill(struct SNAME *_filter_)                                                     \
+    {                                                                                             \
+        size_t words = _filter_->block_count * (CMC_CACHE_LINE_SIZE / sizeof(uint64_t));          \
+        size_t set = 0;                                                                           \
+                                                                                                  \
+        for (size_t i = 0; i < words; i++)                                                        \
+            set += cmc_math_popcount(_filter_->blocks[i]);                                        \
+                                                                                                  \
+        return (double)set / (double)PFX##_bits(_filter_);                                        \
+    }                                                                                             \
+                                                                                                  \
+    /* Estimated false positive rate, the chance that all k bits of an */                         \
+    /* element are already set */                                                                 \
+    double PFX##_fpr(struct SNAME *_filter_)                                                      \
+    {                                                                                             \
+        double fill = PFX##_fill(_filter_);                                                       \
+        double fpr = 1.0;                                                                         \
+                                                                                                  \
+        for (size_t i = 0; i < _filter_->probes; i++)                                             \
+            fpr *= fill;                                                                          \
+                                                                                                  \
+        return fpr;                                                                               \
+    }                                                                                             \
+                                                                                                  \
+    struct SNAME *PFX##_copy_of(struct SNAME *_filter_)                                           \
+    {                                                                                             \
+        struct SNAME *result =                                                                    \
+            PFX##_new_custom(_filter_->block_count, _filter_->probes, _filter_->hash,             \
+                             _filter_->alloc);                                                    \
+                                                                                                  \
+        if (!result)                                                                              \
+            return NULL;                                                                          \
+                                                                                                  \
+        memcpy(result->blocks, _filter_->blocks, _filter_->block_count * CMC_CACHE_LINE_SIZE);    \
+                                                                                                  \
+        result->count = _filter_->count;                                                          \
+                                                                                                  \
+        return result;                                                                            \
+    }                                                                                             \
+                                                                                                  \
+    /* Two filters are equal if they have the same bits set */                                    \
+    bool PFX##_equals(struct SNAME *_filter1_, struct SNAME *_filter2_)                           \
+    {                                                                                             \
+        if (!PFX##_compatible(_filter1_, _filter2_))                                              \
+            return false;                                                                         \
+                                                                                                  \
+        return memcmp(_filter1_->blocks, _filter2_->blocks,                                       \
+                      _filter1_->block_count * CMC_CACHE_LINE_SIZE) == 0;                         \
+    }                                                                                             \
+                                                                                                  \
+    struct cmc_string PFX##_to_string(struct SNAME *_filter_)                                     \
+    {                                                                                             \
+        struct cmc_string str;                                                                    \
+        struct SNAME *f_ = _filter_;                                                              \
+        const char *name = #SNAME;                                                                \
+                                                                                                  \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_bloomfilter, name, f_, f_->blocks,         \
+                 f_->block_count, f_->probes, f_->count, f_->hash);                               \
+                                                                                                  \
+        return str;                                                                               \
+    }                                                                                             \
+                                                                                                  \
+    /* Filters can only be merged if they map elements to the same bits */                        \
+    bool PFX##_compatible(struct SNAME *_filter1_, struct SNAME *_filter2_)                       \
+    {                                                                                             \
+        return _filter1_->block_count == _filter2_->block_count &&                                \
+               _filter1_->probes == _filter2_->probes && _filter1_->hash == _filter2_->hash;      \
+    }                                                                                             \
+                                                                                                  \
+    /* A new filter with every element of both filters, or NULL if they are */                    \
+    /* not compatible */                                                                          \
+    struct SNAME *PFX##_union(struct SNAME *_filter1_, struct SNAME *_filter2_)                   \
+    {                                                                                             \
+        if (!PFX##_compatible(_filter1_, _filter2_))                                              \
+            return NULL;                                                                          \
+                                                                                                  \
+        struct SNAME *result = PFX##_copy_of(_filter1_);                                          \
+                                                                                                  \
+        if (!result)                                                                              \
+            return NULL;                                                                          \
+                                                                                                  \
+        PFX##_union_into(result, _filter2_);                                                      \
+                                                                                                  \
+        return result;                                                                            \
+    }                                                                                             \
+                                                                                                  \
+    /* Adds every element of _filter2_ to _filter1_. The count becomes the */                     \
+    /* sum of both counts which overestimates elements they have in common */                     \
+    bool PFX##_union_into(struct SNAME *_filter1_, struct SNAME *_filter2_)                       \
+    {                                                                                             \
+        if (!PFX##_compatible(_filter1_, _filter2_))                                              \
+            return false;                                                                         \
+                                                                                                  \
+        size_t words = _filter1_->block_count * (CMC_CACHE_LINE_SIZE / sizeof(uint64_t));         \
+                                                                                                  \
+        for (size_t i = 0; i < words; i++)                                                        \
+            _filter1_->blocks[i] |= _filter2_->blocks[i];                                         \
+                                                                                                  \
+        _filter1_->count += _filter2_->count;                                                     \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* The block of an element, from a second mix of its hash so that it is */                    \
+    /* independent of the bits used inside the block */                                           \
+    static uint64_t *PFX##_impl_block(struct SNAME *_filter_, uint64_t hash)                      \
+    {                                                                                             \
+        size_t index = (size_t)(cmc_hash_u64(hash) % _filter_->block_count);                      \
+                                                                                                  \
+        return _filter_->blocks + index * (CMC_CACHE_LINE_SIZE / sizeof(uint64_t));               \
+    }                                                                                             \
+                                                                                                  \
+    /* Position inside of a block of the next bit of an element. The hash */                      \
+    /* is multiplied by an odd constant for each probe and the position is */                     \
+    /* taken from its upper bits. Two elements only set the same bits if */                       \
+    /* their whole hash is the same, while with double hashing the lower */                       \
+    /* bits of the hash alone would select every bit */                                           \
+    static inline size_t PFX##_impl_next_bit(uint64_t *hash)                                      \
+    {                                                                                             \
+        *hash *= UINT64_C(0x9e3779b97f4a7c15);                                                    \
+                                                                                                  \
+        return (size_t)(((*hash >> 32) * CMC_BLOOMFILTER_BLOCK_BITS) >> 32);                      \
+    }
+
+#endif /* CMC_BLOOMFILTER_H */
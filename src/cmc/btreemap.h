@@ -0,0 +1,1327 @@
+/**
+ * btreemap.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * BTreeMap
+ *
+ * A BTreeMap is an implementation of a Map that keeps its keys sorted, with
+ * the same functions as the TreeMap. Like a Map, it has only unique keys.
+ *
+ * Implementation
+ *
+ * This implementation uses a B+ tree. Every key and value is kept in a leaf,
+ * a node with room for CMC_BTREE_LEAF_SIZE keys next to each other followed
+ * by their values, and the leaves are linked to the previous and the next
+ * ones for iterators. Branches only guide the search, with up to
+ * CMC_BTREE_BRANCH_SIZE children and the smallest key under each one of them
+ * but the first. A lookup reads one node of each level and binary searches
+ * its keys, so a tree of millions of keys is only a few levels deep and a
+ * node is allocated for every few dozen keys instead of one for each key.
+ *
+ * Every node but the root is kept at least half full. Full nodes are split
+ * on the way down an insertion, before the key is placed, so an insertion
+ * that runs out of memory leaves the map as it was. A leaf at the end of the
+ * map that is split by a key past the end of it is left full, so keys
+ * inserted in ascending order fill their leaves.
+ */
+
+#ifndef CMC_BTREEMAP_H
+#define CMC_BTREEMAP_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_serial.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_btreemap = "%s at %p { root:%p, height:%" PRIuMAX ", count:%" PRIuMAX ", cmp:%p }";
+
+/* Maximum amount of keys in a leaf, at least 4 */
+#ifndef CMC_BTREE_LEAF_SIZE
+#define CMC_BTREE_LEAF_SIZE 32
+#endif
+
+/* Maximum amount of children of a branch, at least 4 */
+#ifndef CMC_BTREE_BRANCH_SIZE
+#define CMC_BTREE_BRANCH_SIZE 32
+#endif
+
+#define CMC_GENERATE_BTREEMAP(PFX, SNAME, K, V)    \
+    CMC_GENERATE_BTREEMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_BTREEMAP_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_BTREEMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_BTREEMAP_HEADER(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_BTREEMAP_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_BTREEMAP_SOURCE(PFX, SNAME, K, V)
+
+/* Same as CMC_GENERATE_BTREEMAP but keys are compared by calling CMP */
+/* directly, so the compiler can inline it. The function given to new is */
+/* still stored but only used by copy_of and to_string */
+#define CMC_GENERATE_BTREEMAP_EX(PFX, SNAME, K, V, CMP) \
+    CMC_GENERATE_BTREEMAP_HEADER(PFX, SNAME, K, V)      \
+    CMC_GENERATE_BTREEMAP_EX_SOURCE(PFX, SNAME, K, V, CMP)
+
+#define CMC_GENERATE_BTREEMAP_SOURCE(PFX, SNAME, K, V) \
+    CMC_IMPL_BTREEMAP_SOURCE(PFX, SNAME, K, V, _map_->cmp)
+
+#define CMC_GENERATE_BTREEMAP_EX_SOURCE(PFX, SNAME, K, V, CMP) \
+    CMC_IMPL_BTREEMAP_SOURCE(PFX, SNAME, K, V, CMP)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_BTREEMAP_HEADER(PFX, SNAME, K, V)                                            \
+                                                                                                  \
+    /* BTreeMap Structure */                                                                      \
+    struct SNAME                                                                                  \
+    {                                                                                             \
+        /* Root node, a leaf if height is 0 or NULL if the map is empty */                        \
+        void *root;                                                                               \
+                                                                                                  \
+        /* Amount of branches between the root and the leaves */                                  \
+        size_t height;                                                                            \
+                                                                                                  \
+        /* Current amount of keys */                                                              \
+        size_t count;                                                                             \
+                                                                                                  \
+        /* Key comparison function */                                                             \
+        int (*cmp)(K, K);                                                                         \
+                                                                                                  \
+        /* Function that returns an iterator to the start of the btreemap */                      \
+        struct SNAME##_iter (*it_start)(struct SNAME *);                                          \
+                                                                                                  \
+        /* Function that returns an iterator to the end of the btreemap */                        \
+        struct SNAME##_iter (*it_end)(struct SNAME *);                                            \
+                                                                                                  \
+        /* Custom allocation functions */                                                         \
+        struct cmc_alloc_node *alloc;                                                             \
+    };                                                                                            \
+                                                                                                  \
+    /* BTreeMap Leaf */                                                                           \
+    struct SNAME##_leaf                                                                           \
+    {                                                                                             \
+        /* Keys in ascending order */                                                             \
+        K keys[CMC_BTREE_LEAF_SIZE];                                                              \
+                                                                                                  \
+        /* Value of each key */                                                                   \
+        V values[CMC_BTREE_LEAF_SIZE];                                                            \
+                                                                                                  \
+        /* Amount of keys in the leaf */                                                          \
+        size_t count;                                                                             \
+                                                                                                  \
+        /* Leaf with the keys right before these ones */                                          \
+        struct SNAME##_leaf *prev;                                                                \
+                                                                                                  \
+        /* Leaf with the keys right after these ones */                                           \
+        struct SNAME##_leaf *next;                                                                \
+    };                                                                                            \
+                                                                                                  \
+    /* BTreeMap Branch */                                                                         \
+    struct SNAME##_branch                                                                         \
+    {                                                                                             \
+        /* keys[i] is the smallest key under children[i + 1] */                                   \
+        K keys[CMC_BTREE_BRANCH_SIZE - 1];                                                        \
+                                                                                                  \
+        /* Leaves one level above them, otherwise branches */                                     \
+        void *children[CMC_BTREE_BRANCH_SIZE];                                                    \
+                                                                                                  \
+        /* Amount of children */                                                                  \
+        size_t count;                                                                             \
+    };                                                                                            \
+                                                                                                  \
+    /* BTreeMap Iterator */                                                                       \
+    struct SNAME##_iter                                                                           \
+    {                                                                                             \
+        /* Target btreemap */                                                                     \
+        struct SNAME *target;                                                                     \
+                                                                                                  \
+        /* Leaf of the cursor */                                                                  \
+        struct SNAME##_leaf *cursor;                                                              \
+                                                                                                  \
+        /* Position of the cursor in its leaf */                                                  \
+        size_t position;                                                                          \
+                                                                                                  \
+        /* Keeps track of relative index to the iteration of elements */                          \
+        size_t index;                                                                             \
+                                                                                                  \
+        /* If the iterator has reached the start of the iteration */                              \
+        bool start;                                                                               \
+                                                                                                  \
+        /* If the iterator has reached the end of the iteration */                                \
+        bool end;                                                                                 \
+    };                                                                                            \
+                                                                                                  \
+    /* Collection Functions */                                                                    \
+    /* Collection Allocation and Deallocation */                                                  \
+    struct SNAME *PFX##_new(int (*compare)(K, K));                                                \
+    struct SNAME *PFX##_new_custom(int (*compare)(K, K), struct cmc_alloc_node *alloc);           \
+    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V));                             \
+    void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V));                              \
+    /* Collection Input and Output */                                                             \
+    bool PFX##_insert(struct SNAME *_map_, K key, V value);                                       \
+    V *PFX##_get_or_insert(struct SNAME *_map_, K key, V default_value);                          \
+    bool PFX##_upsert(struct SNAME *_map_, K key, V value);                                       \
+    bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value);                     \
+    bool PFX##_remove(struct SNAME *_map_, K key, V *out_value);                                  \
+    /* Element Access */                                                                          \
+    bool PFX##_max(struct SNAME *_map_, K *key, V *value);                                        \
+    bool PFX##_min(struct SNAME *_map_, K *key, V *value);                                        \
+    V PFX##_get(struct SNAME *_map_, K key);                                                      \
+    V *PFX##_get_ref(struct SNAME *_map_, K key);                                                 \
+    /* Collection State */                                                                        \
+    bool PFX##_contains(struct SNAME *_map_, K key);                                              \
+    CMC_PURE bool PFX##_empty(struct SNAME *_map_);                                               \
+    CMC_PURE size_t PFX##_count(struct SNAME *_map_);                                             \
+    size_t PFX##_memory_usage(struct SNAME *_map_);                                               \
+    /* Collection Utility */                                                                      \
+    struct SNAME *PFX##_copy_of(struct SNAME *_map_, K (*key_copy_func)(K),                       \
+                                V (*value_copy_func)(V));                                         \
+    bool PFX##_equals(struct SNAME *_map1_, struct SNAME *_map2_, int (*value_comparator)(V, V)); \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_);                                       \
+    bool PFX##_to_string_full(struct SNAME *_map_, struct cmc_string_builder *builder,            \
+                              const char *elem_fmt);                                              \
+    bool PFX##_write(struct SNAME *_map_, FILE *file, void (*fmt)(FILE *, K, V));                 \
+    bool PFX##_write_fd(struct SNAME *_map_, int fd, void (*fmt)(struct cmc_dump *, K, V));       \
+    /* Collection Serialization */                                                                \
+    bool PFX##_save(struct SNAME *_map_, FILE *file, bool (*key_writer)(K, FILE *),               \
+                    bool (*value_writer)(V, FILE *));                                             \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(K, K),                                 \
+                                bool (*key_reader)(K *, FILE *),                                  \
+                                bool (*value_reader)(V *, FILE *));                               \
+                                                                                                  \
+    /* Iterator Functions */                                                                      \
+    /* Iterator Allocation and Deallocation */                                                    \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target);                                    \
+    void PFX##_iter_free(struct SNAME##_iter *iter);                                              \
+    /* Iterator Initialization */                                                                 \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);                        \
+    /* Iterator State */                                                                          \
+    bool PFX##_iter_start(struct SNAME##_iter *iter);                                             \
+    bool PFX##_iter_end(struct SNAME##_iter *iter);                                               \
+    /* Iterator Movement */                                                                       \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter);                                          \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter);                                            \
+    bool PFX##_iter_next(struct SNAME##_iter *iter);                                              \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter);                                              \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps);                             \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps);                              \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index);                               \
+    /* Iterator Access */                                                                         \
+    K PFX##_iter_key(struct SNAME##_iter *iter);                                                  \
+    V PFX##_iter_value(struct SNAME##_iter *iter);                                                \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter);                                              \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter);                                           \
+                                                                                                  \
+/* SOURCE ********************************************************************/
+#define CMC_IMPL_BTREEMAP_SOURCE(PFX, SNAME, K, V, CMP)                                           \
+                                                                                                  \
+    /* Implementation Detail Functions */                                                         \
+    static inline int PFX##_impl_cmp(struct SNAME *_map_, K a, K b);                              \
+    static size_t PFX##_impl_lower_bound(struct SNAME *_map_, K *keys, size_t n, K key);          \
+    static size_t PFX##_impl_upper_bound(struct SNAME *_map_, K *keys, size_t n, K key);          \
+    static struct SNAME##_leaf *PFX##_impl_new_leaf(struct SNAME *_map_);                         \
+    static struct SNAME##_leaf *PFX##_impl_first_leaf(struct SNAME *_map_);                       \
+    static struct SNAME##_leaf *PFX##_impl_last_leaf(struct SNAME *_map_);                        \
+    static V *PFX##_impl_get_value(struct SNAME *_map_, K key);                                   \
+    static V *PFX##_impl_insert(struct SNAME *_map_, K key, V value, V **found);                  \
+    static bool PFX##_impl_split_child(struct SNAME *_map_, struct SNAME##_branch *parent,        \
+                                       size_t index, size_t height, K key);                       \
+    static bool PFX##_impl_remove(struct SNAME *_map_, void *node, size_t height, K key,          \
+                                  V *out_value);                                                  \
+    static void PFX##_impl_fix_child(struct SNAME *_map_, struct SNAME##_branch *parent,          \
+                                     size_t index, size_t height);                                \
+    static void PFX##_impl_merge_children(struct SNAME *_map_, struct SNAME##_branch *parent,     \
+                                          size_t index, size_t height);                           \
+    static void PFX##_impl_free_node(struct SNAME *_map_, void *node, size_t height,              \
+                                     void (*deallocator)(K, V));                                  \
+    static size_t PFX##_impl_node_bytes(void *node, size_t height);                               \
+    static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_map_);                          \
+    static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_map_);                            \
+                                                                                                  \
+    struct SNAME *PFX##_new(int (*compare)(K, K))                                                 \
+    {                                                                                             \
+        return PFX##_new_custom(compare, NULL);                                                   \
+    }                                                                                             \
+                                                                                                  \
+    struct SNAME *PFX##_new_custom(int (*compare)(K, K), struct cmc_alloc_node *alloc)            \
+    {                                                                                             \
+        if (!alloc)                                                                               \
+            alloc = &cmc_alloc_node_default;                                                      \
+                                                                                                  \
+        struct SNAME *_map_ = alloc->malloc(sizeof(struct SNAME));                                \
+                                                                                                  \
+        if (CMC_UNLIKELY(!_map_))                                                                 \
+            return NULL;                                                                          \
+                                                                                                  \
+        _map_->alloc = alloc;                                                                     \
+                                                                                                  \
+        _map_->root = NULL;                                                                       \
+        _map_->height = 0;                                                                        \
+        _map_->count = 0;                                                                         \
+        _map_->cmp = compare;                                                                     \
+                                                                                                  \
+        _map_->it_start = PFX##_impl_it_start;                                                    \
+        _map_->it_end = PFX##_impl_it_end;                                                        \
+                                                                                                  \
+        return _map_;                                                                             \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V))                              \
+    {                                                                                             \
+        if (_map_->root)                                                                          \
+            PFX##_impl_free_node(_map_, _map_->root, _map_->height, deallocator);                 \
+                                                                                                  \
+        _map_->root = NULL;                                                                       \
+        _map_->height = 0;                                                                        \
+        _map_->count = 0;                                                                         \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V))                               \
+    {                                                                                             \
+        PFX##_clear(_map_, deallocator);                                                          \
+                                                                                                  \
+        _map_->alloc->free(_map_);                                                                \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_insert(struct SNAME *_map_, K key, V value)                                        \
+    {                                                                                             \
+        V *existing = NULL;                                                                       \
+                                                                                                  \
+        return PFX##_impl_insert(_map_, key, value, &existing) != NULL;                           \
+    }                                                                                             \
+                                                                                                  \
+    V *PFX##_get_or_insert(struct SNAME *_map_, K key, V default_value)                           \
+    {                                                                                             \
+        V *existing = NULL;                                                                       \
+        V *inserted = PFX##_impl_insert(_map_, key, default_value, &existing);                    \
+                                                                                                  \
+        if (inserted)                                                                             \
+            return inserted;                                                                      \
+                                                                                                  \
+        /* NULL if a node could not be allocated */                                               \
+        return existing;                                                                          \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_upsert(struct SNAME *_map_, K key, V value)                                        \
+    {                                                                                             \
+        V *ref = PFX##_get_or_insert(_map_, key, value);                                          \
+                                                                                                  \
+        if (!ref)                                                                                 \
+            return false;                                                                         \
+                                                                                                  \
+        *ref = value;                                                                             \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value)                      \
+    {                                                                                             \
+        V *ref = PFX##_impl_get_value(_map_, key);                                                \
+                                                                                                  \
+        if (!ref)                                                                                 \
+            return false;                                                                         \
+                                                                                                  \
+        if (old_value)                                                                            \
+            *old_value = *ref;                                                                    \
+                                                                                                  \
+        *ref = new_value;                                                                         \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_remove(struct SNAME *_map_, K key, V *out_value)                                   \
+    {                                                                                             \
+        if (PFX##_empty(_map_))                                                                   \
+            return false;                                                                         \
+                                                                                                  \
+        if (!PFX##_impl_remove(_map_, _map_->root, _map_->height, key, out_value))                \
+            return false;                                                                         \
+                                                                                                  \
+        _map_->count--;                                                                           \
+                                                                                                  \
+        /* The tree only gets shorter at the root */                                              \
+        if (_map_->height > 0 && ((struct SNAME##_branch *)_map_->root)->count == 1)              \
+        {                                                                                         \
+            struct SNAME##_branch *root = _map_->root;                                            \
+                                                                                                  \
+            _map_->root = root->children[0];                                                      \
+            _map_->height--;                                                                      \
+                                                                                                  \
+            _map_->alloc->free(root);                                                             \
+        }                                                                                         \
+        else if (_map_->count == 0)                                                               \
+        {                                                                                         \
+            _map_->alloc->free(_map_->root);                                                      \
+                                                                                                  \
+            _map_->root = NULL;                                                                   \
+        }                                                                                         \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_max(struct SNAME *_map_, K *key, V *value)                                         \
+    {                                                                                             \
+        if (PFX##_empty(_map_))                                                                   \
+            return false;                                                                         \
+                                                                                                  \
+        struct SNAME##_leaf *leaf = PFX##_impl_last_leaf(_map_);                                  \
+                                                                                                  \
+        *key = leaf->keys[leaf->count - 1];                                                       \
+        *value = leaf->values[leaf->count - 1];                                                   \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_min(struct SNAME *_map_, K *key, V *value)                                         \
+    {                                                                                             \
+        if (PFX##_empty(_map_))                                                                   \
+            return false;                                                                         \
+                                                                                                  \
+        struct SNAME##_leaf *leaf = PFX##_impl_first_leaf(_map_);                                 \
+                                                                                                  \
+        *key = leaf->keys[0];                                                                     \
+        *value = leaf->values[0];                                                                 \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    V PFX##_get(struct SNAME *_map_, K key)                                                       \
+    {                                                                                             \
+        V *ref = PFX##_impl_get_value(_map_, key);                                                \
+                                                                                                  \
+        if (!ref)                                                                                 \
+            return (V){0};                                                                        \
+                                                                                                  \
+        return *ref;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    V *PFX##_get_ref(struct SNAME *_map_, K key)                                                  \
+    {                                                                                             \
+        return PFX##_impl_get_value(_map_, key);                                                  \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_contains(struct SNAME *_map_, K key)                                               \
+    {                                                                                             \
+        return PFX##_impl_get_value(_map_, key) != NULL;                                          \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_empty(struct SNAME *_map_)                                                         \
+    {                                                                                             \
+        return _map_->count == 0;                                                                 \
+    }                                                                                             \
+                                                                                                  \
+    size_t PFX##_count(struct SNAME *_map_)                                                       \
+    {                                                                                             \
+        return _map_->count;                                                                      \
+    }                                                                                             \
+                                                                                                  \
+    size_t PFX##_memory_usage(struct SNAME *_map_)                                                \
+    {                                                                                             \
+        if (!_map_->root)                                                                         \
+            return sizeof(struct SNAME);                                                          \
+                                                                                                  \
+        return sizeof(struct SNAME) + PFX##_impl_node_bytes(_map_->root, _map_->height);          \
+    }                                                                                             \
+                                                                                                  \
+    /* The keys are inserted in ascending order so the copy has full leaves */                    \
+    struct SNAME *PFX##_copy_of(struct SNAME *_map_, K (*key_copy_func)(K),                       \
+                                V (*value_copy_func)(V))                                          \
+    {                                                                                             \
+        struct SNAME *result = PFX##_new_custom(_map_->cmp, _map_->alloc);                        \
+                                                                                                  \
+        if (CMC_UNLIKELY(!result))                                                                \
+            return NULL;                                                                          \
+                                                                                                  \
+        struct SNAME##_iter iter;                                                                 \
+        PFX##_iter_init(&iter, _map_);                                                            \
+                                                                                                  \
+        if (!PFX##_empty(_map_))                                                                  \
+        {                                                                                         \
+            for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))      \
+            {                                                                                     \
+                K key = PFX##_iter_key(&iter);                                                    \
+                V value = PFX##_iter_value(&iter);                                                \
+                                                                                                  \
+                if (key_copy_func)                                                                \
+                    key = key_copy_func(key);                                                     \
+                if (value_copy_func)                                                              \
+                    value = value_copy_func(value);                                               \
+                                                                                                  \
+                PFX##_insert(result, key, value);                                                 \
+            }                                                                                     \
+        }                                                                                         \
+                                                                                                  \
+        return result;                                                                            \
+    }                                                                                             \
+                                                                                                  \
+    /* Both maps are sorted so their keys are compared in a single pass */                        \
+    bool PFX##_equals(struct SNAME *_map1_, struct SNAME *_map2_, int (*value_comparator)(V, V))  \
+    {                                                                                             \
+        if (PFX##_count(_map1_) != PFX##_count(_map2_))                                           \
+            return false;                                                                         \
+                                                                                                  \
+        struct SNAME##_iter iter1, iter2;                                                         \
+        PFX##_iter_init(&iter1, _map1_);                                                          \
+        PFX##_iter_init(&iter2, _map2_);                                                          \
+                                                                                                  \
+        for (; !PFX##_iter_end(&iter1); PFX##_iter_next(&iter1), PFX##_iter_next(&iter2))         \
+        {                                                                                         \
+            if (PFX##_impl_cmp(_map1_, PFX##_iter_key(&iter1), PFX##_iter_key(&iter2)) != 0)      \
+                return false;                                                                     \
+                                                                                                  \
+            if (value_comparator)                                                                 \
+            {                                                                                     \
+                if (value_comparator(PFX##_iter_value(&iter1), PFX##_iter_value(&iter2)) != 0)    \
+                    return false;                                                                 \
+            }                                                                                     \
+        }                                                                                         \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_)                                        \
+    {                                                                                             \
+        struct cmc_string str;                                                                    \
+        struct SNAME *m_ = _map_;                                                                 \
+        const char *name = #SNAME;                                                                \
+                                                                                                  \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_btreemap,                                  \
+                 name, m_, m_->root, m_->height, m_->count, m_->cmp);                             \
+                                                                                                  \
+        return str;                                                                               \
+    }                                                                                             \
+                                                                                                  \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_ENTRY)                                \
+                                                                                                  \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_ENTRY, (K, V))                               \
+                                                                                                  \
+    bool PFX##_save(struct SNAME *_map_, FILE *file, bool (*key_writer)(K, FILE *),               \
+                    bool (*value_writer)(V, FILE *))                                              \
+    {                                                                                             \
+        uint32_t flags = (key_writer ? 0 : CMC_SERIAL_RAW_KEYS) |                                 \
+                         (value_writer ? 0 : CMC_SERIAL_RAW_VALUES);                              \
+                                                                                                  \
+        if (!cmc_serial_write_header(file, "btreemap", flags, sizeof(K), sizeof(V), 0,            \
+                                     _map_->count, _map_->count, 0))                              \
+            return false;                                                                         \
+                                                                                                  \
+        struct SNAME##_iter iter;                                                                 \
+        PFX##_iter_init(&iter, _map_);                                                            \
+                                                                                                  \
+        if (!PFX##_empty(_map_))                                                                  \
+        {                                                                                         \
+            for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))      \
+            {                                                                                     \
+                K key = PFX##_iter_key(&iter);                                                    \
+                V value = PFX##_iter_value(&iter);                                                \
+                                                                                                  \
+                if (!CMC_SERIAL_WRITE(key_writer, key, file) ||                                   \
+                    !CMC_SERIAL_WRITE(value_writer, value, file))                                 \
+                    return false;                                                                 \
+            }                                                                                     \
+        }                                                                                         \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Each reader is only used if the keys or values were saved with a writer */                 \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(K, K),                                 \
+                                bool (*key_reader)(K *, FILE *),                                  \
+                                bool (*value_reader)(V *, FILE *))                                \
+    {                                                                                             \
+        struct cmc_serial_header header;                                                          \
+                                                                                                  \
+        if (!cmc_serial_read_header(file, "btreemap", sizeof(K), sizeof(V), &header))             \
+            return NULL;                                                                          \
+                                                                                                  \
+        struct SNAME *_map_ = PFX##_new(compare);                                                 \
+                                                                                                  \
+        if (CMC_UNLIKELY(!_map_))                                                                 \
+            return NULL;                                                                          \
+                                                                                                  \
+        bool raw_keys = header.flags & CMC_SERIAL_RAW_KEYS;                                       \
+        bool raw_values = header.flags & CMC_SERIAL_RAW_VALUES;                                   \
+                                                                                                  \
+        for (size_t i = 0; i < header.count; i++)                                                 \
+        {                                                                                         \
+            K key;                                                                                \
+            V value;                                                                              \
+                                                                                                  \
+            if (!CMC_SERIAL_READ(raw_keys, key_reader, &key, file) ||                             \
+                !CMC_SERIAL_READ(raw_values, value_reader, &value, file) ||                       \
+                !PFX##_insert(_map_, key, value))                                                 \
+            {                                                                                     \
+                PFX##_free(_map_, NULL);                                                          \
+                return NULL;                                                                      \
+            }                                                                                     \
+        }                                                                                         \
+                                                                                                  \
+        return _map_;                                                                             \
+    }                                                                                             \
+                                                                                                  \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                     \
+    {                                                                                             \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));           \
+                                                                                                  \
+        if (CMC_UNLIKELY(!iter))                                                                  \
+            return NULL;                                                                          \
+                                                                                                  \
+        PFX##_iter_init(iter, target);                                                            \
+                                                                                                  \
+        return iter;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_iter_free(struct SNAME##_iter *iter)                                               \
+    {                                                                                             \
+        iter->target->alloc->free(iter);                                                          \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                         \
+    {                                                                                             \
+        memset(iter, 0, sizeof(struct SNAME##_iter));                                             \
+                                                                                                  \
+        iter->target = target;                                                                    \
+        iter->start = true;                                                                       \
+        iter->end = PFX##_empty(target);                                                          \
+                                                                                                  \
+        if (!PFX##_empty(target))                                                                 \
+            iter->cursor = PFX##_impl_first_leaf(target);                                         \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                              \
+    {                                                                                             \
+        return PFX##_empty(iter->target) || iter->start;                                          \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                                \
+    {                                                                                             \
+        return PFX##_empty(iter->target) || iter->end;                                            \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                           \
+    {                                                                                             \
+        if (!PFX##_empty(iter->target))                                                           \
+        {                                                                                         \
+            iter->index = 0;                                                                      \
+            iter->start = true;                                                                   \
+            iter->end = PFX##_empty(iter->target);                                                \
+            iter->cursor = PFX##_impl_first_leaf(iter->target);                                   \
+            iter->position = 0;                                                                   \
+        }                                                                                         \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                             \
+    {                                                                                             \
+        if (!PFX##_empty(iter->target))                                                           \
+        {                                                                                         \
+            iter->index = iter->target->count - 1;                                                \
+            iter->start = PFX##_empty(iter->target);                                              \
+            iter->end = true;                                                                     \
+            iter->cursor = PFX##_impl_last_leaf(iter->target);                                    \
+            iter->position = iter->cursor->count - 1;                                             \
+        }                                                                                         \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                               \
+    {                                                                                             \
+        if (iter->end)                                                                            \
+            return false;                                                                         \
+                                                                                                  \
+        if (iter->index + 1 == PFX##_count(iter->target))                                         \
+        {                                                                                         \
+            iter->end = true;                                                                     \
+            return false;                                                                         \
+        }                                                                                         \
+                                                                                                  \
+        iter->start = PFX##_empty(iter->target);                                                  \
+                                                                                                  \
+        if (++iter->position == iter->cursor->count)                                              \
+        {                                                                                         \
+            iter->cursor = iter->cursor->next;                                                    \
+            iter->position = 0;                                                                   \
+        }                                                                                         \
+                                                                                                  \
+        iter->index++;                                                                            \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                               \
+    {                                                                                             \
+        if (iter->start)                                                                          \
+            return false;                                                                         \
+                                                                                                  \
+        if (iter->index == 0)                                                                     \
+        {                                                                                         \
+            iter->start = true;                                                                   \
+            return false;                                                                         \
+        }                                                                                         \
+                                                                                                  \
+        iter->end = PFX##_empty(iter->target);                                                    \
+                                                                                                  \
+        if (iter->position-- == 0)                                                                \
+        {                                                                                         \
+            iter->cursor = iter->cursor->prev;                                                    \
+            iter->position = iter->cursor->count - 1;                                             \
+        }                                                                                         \
+                                                                                                  \
+        iter->index--;                                                                            \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Returns true only if the iterator moved. Whole leaves are skipped */                       \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps)                              \
+    {                                                                                             \
+        if (iter->end)                                                                            \
+            return false;                                                                         \
+                                                                                                  \
+        if (iter->index + 1 == PFX##_count(iter->target))                                         \
+        {                                                                                         \
+            iter->end = true;                                                                     \
+            return false;                                                                         \
+        }                                                                                         \
+                                                                                                  \
+        if (steps == 0 || iter->index + steps >= PFX##_count(iter->target))                       \
+            return false;                                                                         \
+                                                                                                  \
+        iter->start = PFX##_empty(iter->target);                                                  \
+        iter->index += steps;                                                                     \
+        iter->position += steps;                                                                  \
+                                                                                                  \
+        while (iter->position >= iter->cursor->count)                                             \
+        {                                                                                         \
+            iter->position -= iter->cursor->count;                                                \
+            iter->cursor = iter->cursor->next;                                                    \
+        }                                                                                         \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Returns true only if the iterator moved. Whole leaves are skipped */                       \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps)                               \
+    {                                                                                             \
+        if (iter->start)                                                                          \
+            return false;                                                                         \
+                                                                                                  \
+        if (iter->index == 0)                                                                     \
+        {                                                                                         \
+            iter->start = true;                                                                   \
+            return false;                                                                         \
+        }                                                                                         \
+                                                                                                  \
+        if (steps == 0 || iter->index < steps)                                                    \
+            return false;                                                                         \
+                                                                                                  \
+        iter->end = PFX##_empty(iter->target);                                                    \
+        iter->index -= steps;                                                                     \
+                                                                                                  \
+        while (steps > iter->position)                                                            \
+        {                                                                                         \
+            steps -= iter->position + 1;                                                          \
+            iter->cursor = iter->cursor->prev;                                                    \
+            iter->position = iter->cursor->count - 1;                                             \
+        }                                                                                         \
+                                                                                                  \
+        iter->position -= steps;                                                                  \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Returns true only if the iterator was able to be positioned at the given index */          \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index)                                \
+    {                                                                                             \
+        if (index >= PFX##_count(iter->target))                                                   \
+            return false;                                                                         \
+                                                                                                  \
+        if (iter->index > index)                                                                  \
+            return PFX##_iter_rewind(iter, iter->index - index);                                  \
+        else if (iter->index < index)                                                             \
+            return PFX##_iter_advance(iter, index - iter->index);                                 \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    K PFX##_iter_key(struct SNAME##_iter *iter)                                                   \
+    {                                                                                             \
+        if (PFX##_empty(iter->target))                                                            \
+            return (K){0};                                                                        \
+                                                                                                  \
+        return iter->cursor->keys[iter->position];                                                \
+    }                                                                                             \
+                                                                                                  \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                                 \
+    {                                                                                             \
+        if (PFX##_empty(iter->target))                                                            \
+            return (V){0};                                                                        \
+                                                                                                  \
+        return iter->cursor->values[iter->position];                                              \
+    }                                                                                             \
+                                                                                                  \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter)                                               \
+    {                                                                                             \
+        if (PFX##_empty(iter->target))                                                            \
+            return NULL;                                                                          \
+                                                                                                  \
+        return &(iter->cursor->values[iter->position]);                                           \
+    }                                                                                             \
+                                                                                                  \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                            \
+    {                                                                                             \
+        return iter->index;                                                                       \
+    }                                                                                             \
+                                                                                                  \
+    /* Position of the first key that is not less than key */                                     \
+    static size_t PFX##_impl_lower_bound(struct SNAME *_map_, K *keys, size_t n, K key)           \
+    {                                                                                             \
+        size_t low = 0;                                                                           \
+        size_t high = n;                                                                          \
+                                                                                                  \
+        while (low < high)                                                                        \
+        {                                                                                         \
+            size_t mid = low + (high - low) / 2;                                                  \
+                                                                                                  \
+            if (PFX##_impl_cmp(_map_, keys[mid], key) < 0)                                        \
+                low = mid + 1;                                                                    \
+            else                                                                                  \
+                high = mid;                                                                       \
+        }                                                                                         \
+                                                                                                  \
+        return low;                                                                               \
+    }                                                                                             \
+                                                                                                  \
+    /* Position of the first key that is greater than key, which is also the */                   \
+    /* child of a branch that key belongs to */                                                   \
+    static size_t PFX##_impl_upper_bound(struct SNAME *_map_, K *keys, size_t n, K key)           \
+    {                                                                                             \
+        size_t low = 0;                                                                           \
+        size_t high = n;                                                                          \
+                                                                                                  \
+        while (low < high)                                                                        \
+        {                                                                                         \
+            size_t mid = low + (high - low) / 2;                                                  \
+                                                                                                  \
+            if (PFX##_impl_cmp(_map_, keys[mid], key) <= 0)                                       \
+                low = mid + 1;                                                                    \
+            else                                                                                  \
+                high = mid;                                                                       \
+        }                                                                                         \
+                                                                                                  \
+        return low;                                                                               \
+    }                                                                                             \
+                                                                                                  \
+    static struct SNAME##_leaf *PFX##_impl_new_leaf(struct SNAME *_map_)                          \
+    {                                                                                             \
+        struct SNAME##_leaf *leaf = _map_->alloc->malloc(sizeof(struct SNAME##_leaf));            \
+                                                                                                  \
+        if (CMC_UNLIKELY(!leaf))                                                                  \
+            return NULL;                                                                          \
+                                                                                                  \
+        leaf->count = 0;                                                                          \
+        leaf->prev = NULL;                                                                        \
+        leaf->next = NULL;                                                                        \
+                                                                                                  \
+        return leaf;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    static struct SNAME##_leaf *PFX##_impl_first_leaf(struct SNAME *_map_)                        \
+    {                                                                                             \
+        void *node = _map_->root;                                                                 \
+                                                                                                  \
+        for (size_t h = _map_->height; h > 0; h--)                                                \
+            node = ((struct SNAME##_branch *)node)->children[0];                                  \
+                                                                                                  \
+        return node;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    static struct SNAME##_leaf *PFX##_impl_last_leaf(struct SNAME *_map_)                         \
+    {                                                                                             \
+        void *node = _map_->root;                                                                 \
+                                                                                                  \
+        for (size_t h = _map_->height; h > 0; h--)                                                \
+        {                                                                                         \
+            struct SNAME##_branch *branch = node;                                                 \
+                                                                                                  \
+            node = branch->children[branch->count - 1];                                           \
+        }                                                                                         \
+                                                                                                  \
+        return node;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    static V *PFX##_impl_get_value(struct SNAME *_map_, K key)                                    \
+    {                                                                                             \
+        if (PFX##_empty(_map_))                                                                   \
+            return NULL;                                                                          \
+                                                                                                  \
+        void *node = _map_->root;                                                                 \
+                                                                                                  \
+        for (size_t h = _map_->height; h > 0; h--)                                                \
+        {                                                                                         \
+            struct SNAME##_branch *branch = node;                                                 \
+                                                                                                  \
+            node = branch->children[PFX##_impl_upper_bound(_map_, branch->keys,                   \
+                                                           branch->count - 1, key)];              \
+        }                                                                                         \
+                                                                                                  \
+        struct SNAME##_leaf *leaf = node;                                                         \
+                                                                                                  \
+        size_t i = PFX##_impl_lower_bound(_map_, leaf->keys, leaf->count, key);                   \
+                                                                                                  \
+        if (i == leaf->count || PFX##_impl_cmp(_map_, leaf->keys[i], key) != 0)                   \
+            return NULL;                                                                          \
+                                                                                                  \
+        return &(leaf->values[i]);                                                                \
+    }                                                                                             \
+                                                                                                  \
+    /* Walks down the tree once, splitting the full nodes on the way so that */                   \
+    /* the leaf of the key has room for it. If the key is already there its */                    \
+    /* value is stored in found and NULL is returned */                                           \
+    static V *PFX##_impl_insert(struct SNAME *_map_, K key, V value, V **found)                   \
+    {                                                                                             \
+        if (!_map_->root)                                                                         \
+        {                                                                                         \
+            _map_->root = PFX##_impl_new_leaf(_map_);                                             \
+                                                                                                  \
+            if (!_map_->root)                                                                     \
+                return NULL;                                                                      \
+        }                                                                                         \
+                                                                                                  \
+        bool full_root = _map_->height == 0                                                       \
+                             ? ((struct SNAME##_leaf *)_map_->root)->count == CMC_BTREE_LEAF_SIZE \
+                             : ((struct SNAME##_branch *)_map_->root)->count ==                   \
+                                   CMC_BTREE_BRANCH_SIZE;                                         \
+                                                                                                  \
+        if (full_root)                                                                            \
+        {                                                                                         \
+            if (_map_->height == 0 && (*found = PFX##_impl_get_value(_map_, key)) != NULL)        \
+                return NULL;                                                                      \
+                                                                                                  \
+            struct SNAME##_branch *root = _map_->alloc->malloc(sizeof(struct SNAME##_branch));    \
+                                                                                                  \
+            if (CMC_UNLIKELY(!root))                                                              \
+                return NULL;                                                                      \
+                                                                                                  \
+            root->children[0] = _map_->root;                                                      \
+            root->count = 1;                                                                      \
+                                                                                                  \
+            if (!PFX##_impl_split_child(_map_, root, 0, _map_->height, key))                      \
+            {                                                                                     \
+                _map_->alloc->free(root);                                                         \
+                return NULL;                                                                      \
+            }                                                                                     \
+                                                                                                  \
+            _map_->root = root;                                                                   \
+            _map_->height++;                                                                      \
+        }                                                                                         \
+                                                                                                  \
+        void *node = _map_->root;                                                                 \
+                                                                                                  \
+        for (size_t h = _map_->height; h > 0; h--)                                                \
+        {                                                                                         \
+            struct SNAME##_branch *branch = node;                                                 \
+                                                                                                  \
+            size_t i = PFX##_impl_upper_bound(_map_, branch->keys, branch->count - 1, key);       \
+                                                                                                  \
+            bool full = h == 1                                                                    \
+                            ? ((struct SNAME##_leaf *)branch->children[i])->count ==              \
+                                  CMC_BTREE_LEAF_SIZE                                             \
+                            : ((struct SNAME##_branch *)branch->children[i])->count ==            \
+                                  CMC_BTREE_BRANCH_SIZE;                                          \
+                                                                                                  \
+            if (full)                                                                             \
+            {                                                                                     \
+                if (h == 1)                                                                       \
+                {                                                                                 \
+                    struct SNAME##_leaf *leaf = branch->children[i];                              \
+                                                                                                  \
+                    size_t j = PFX##_impl_lower_bound(_map_, leaf->keys, leaf->count, key);       \
+                                                                                                  \
+                    if (j < leaf->count && PFX##_impl_cmp(_map_, leaf->keys[j], key) == 0)        \
+                    {                                                                             \
+                        *found = &(leaf->values[j]);                                              \
+                        return NULL;                                                              \
+                    }                                                                             \
+                }                                                                                 \
+                                                                                                  \
+                if (!PFX##_impl_split_child(_map_, branch, i, h - 1, key))                        \
+                    return NULL;                                                                  \
+                                                                                                  \
+                /* The key might belong to the new node */                                        \
+                if (PFX##_impl_cmp(_map_, branch->keys[i], key) <= 0)                             \
+                    i++;                                                                          \
+            }                                                                                     \
+                                                                                                  \
+            node = branch->children[i];                                                           \
+        }                                                                                         \
+                                                                                                  \
+        struct SNAME##_leaf *leaf = node;                                                         \
+                                                                                                  \
+        size_t i = PFX##_impl_lower_bound(_map_, leaf->keys, leaf->count, key);                   \
+                                                                                                  \
+        if (i < leaf->count && PFX##_impl_cmp(_map_, leaf->keys[i], key) == 0)                    \
+        {                                                                                         \
+            *found = &(leaf->values[i]);                                                          \
+            return NULL;                                                                          \
+        }                                                                                         \
+                                                                                                  \
+        memmove(leaf->keys + i + 1, leaf->keys + i, sizeof(K) * (leaf->count - i));               \
+        memmove(leaf->values + i + 1, leaf->values + i, sizeof(V) * (leaf->count - i));           \
+                                                                                                  \
+        leaf->keys[i] = key;                                                                      \
+        leaf->values[i] = value;                                                                  \
+        leaf->count++;                                                                            \
+                                                                                                  \
+        _map_->count++;                                                                           \
+                                                                                                  \
+        return &(leaf->values[i]);                                                                \
+    }                                                                                             \
+                                                                                                  \
+    /* Splits the full child at index of parent, which is not full, in two. */                    \
+    /* key is the one being inserted, a leaf at the end of the map that it */                     \
+    /* goes past the end of keeps all of its keys */                                              \
+    static bool PFX##_impl_split_child(struct SNAME *_map_, struct SNAME##_branch *parent,        \
+                                       size_t index, size_t height, K key)                        \
+    {                                                                                             \
+        void *right_node;                                                                         \
+        K separator;                                                                              \
+                                                                                                  \
+        if (height == 0)                                                                          \
+        {                                                                                         \
+            struct SNAME##_leaf *left = parent->children[index];                                  \
+            struct SNAME##_leaf *right = PFX##_impl_new_leaf(_map_);                              \
+                                                                                                  \
+            if (!right)                                                                           \
+                return false;                                                                     \
+                                                                                                  \
+            size_t half = CMC_BTREE_LEAF_SIZE / 2;                                                \
+                                                                                                  \
+            if (!left->next &&                                                                    \
+                PFX##_impl_cmp(_map_, left->keys[CMC_BTREE_LEAF_SIZE - 1], key) < 0)              \
+                half = CMC_BTREE_LEAF_SIZE;                                                       \
+                                                                                                  \
+            right->count = CMC_BTREE_LEAF_SIZE - half;                                            \
+                                                                                                  \
+            memcpy(right->keys, left->keys + half, sizeof(K) * right->count);                     \
+            memcpy(right->values, left->values + half, sizeof(V) * right->count);                 \
+                                                                                                  \
+            left->count = half;                                                                   \
+                                                                                                  \
+            right->prev = left;                                                                   \
+            right->next = left->next;                                                             \
+                                                                                                  \
+            if (left->next)                                                                       \
+                left->next->prev = right;                                                         \
+                                                                                                  \
+            left->next = right;                                                                   \
+                                                                                                  \
+            /* An empty leaf is only left for key, which will be its smallest */                  \
+            separator = right->count == 0 ? key : right->keys[0];                                 \
+            right_node = right;                                                                   \
+        }                                                                                         \
+        else                                                                                      \
+        {                                                                                         \
+            struct SNAME##_branch *left = parent->children[index];                                \
+            struct SNAME##_branch *right = _map_->alloc->malloc(sizeof(struct SNAME##_branch));   \
+                                                                                                  \
+            if (CMC_UNLIKELY(!right))                                                             \
+                return false;                                                                     \
+                                                                                                  \
+            size_t half = CMC_BTREE_BRANCH_SIZE / 2;                                              \
+                                                                                                  \
+            right->count = CMC_BTREE_BRANCH_SIZE - half;                                          \
+                                                                                                  \
+            memcpy(right->keys, left->keys + half, sizeof(K) * (right->count - 1));               \
+            memcpy(right->children, left->children + half, sizeof(void *) * right->count);        \
+                                                                                                  \
+            left->count = half;                                                                   \
+                                                                                                  \
+            separator = left->keys[half - 1];                                                     \
+            right_node = right;                                                                   \
+        }                                                                                         \
+                                                                                                  \
+        size_t moved = parent->count - 1 - index;                                                 \
+                                                                                                  \
+        memmove(parent->keys + index + 1, parent->keys + index, sizeof(K) * moved);               \
+        memmove(parent->children + index + 2, parent->children + index + 1,                       \
+                sizeof(void *) * moved);                                                          \
+                                                                                                  \
+        parent->keys[index] = separator;                                                          \
+        parent->children[index + 1] = right_node;                                                 \
+        parent->count++;                                                                          \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Removes key from the subtree of node and fixes the children that were */                   \
+    /* left with less than half of their keys on the way back up */                               \
+    static bool PFX##_impl_remove(struct SNAME *_map_, void *node, size_t height, K key,          \
+                                  V *out_value)                                                   \
+    {                                                                                             \
+        if (height == 0)                                                                          \
+        {                                                                                         \
+            struct SNAME##_leaf *leaf = node;                                                     \
+                                                                                                  \
+            size_t i = PFX##_impl_lower_bound(_map_, leaf->keys, leaf->count, key);               \
+                                                                                                  \
+            if (i == leaf->count || PFX##_impl_cmp(_map_, leaf->keys[i], key) != 0)               \
+                return false;                                                                     \
+                                                                                                  \
+            if (out_value)                                                                        \
+                *out_value = leaf->values[i];                                                     \
+                                                                                                  \
+            leaf->count--;                                                                        \
+                                                                                                  \
+            memmove(leaf->keys + i, leaf->keys + i + 1, sizeof(K) * (leaf->count - i));           \
+            memmove(leaf->values + i, leaf->values + i + 1, sizeof(V) * (leaf->count - i));       \
+                                                                                                  \
+            return true;                                                                          \
+        }                                                                                         \
+                                                                                                  \
+        struct SNAME##_branch *branch = node;                                                     \
+                                                                                                  \
+        size_t i = PFX##_impl_upper_bound(_map_, branch->keys, branch->count - 1, key);           \
+                                                                                                  \
+        if (!PFX##_impl_remove(_map_, branch->children[i], height - 1, key, out_value))           \
+            return false;                                                                         \
+                                                                                                  \
+        PFX##_impl_fix_child(_map_, branch, i, height - 1);                                       \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Gives a child that is less than half full a key from a sibling that */                     \
+    /* can spare one or merges it with a sibling */                                               \
+    static void PFX##_impl_fix_child(struct SNAME *_map_, struct SNAME##_branch *parent,          \
+                                     size_t index, size_t height)                                 \
+    {                                                                                             \
+        size_t minimum = height == 0 ? CMC_BTREE_LEAF_SIZE / 2 : CMC_BTREE_BRANCH_SIZE / 2;       \
+                                                                                                  \
+        size_t counts[3] = { 0, 0, 0 };                                                           \
+                                                                                                  \
+        for (size_t k = 0; k < 3; k++)                                                            \
+        {                                                                                         \
+            if (index + k < 1 || index + k - 1 >= parent->count)                                  \
+                continue;                                                                         \
+                                                                                                  \
+            void *child = parent->children[index + k - 1];                                        \
+                                                                                                  \
+            counts[k] = height == 0 ? ((struct SNAME##_leaf *)child)->count                       \
+                                    : ((struct SNAME##_branch *)child)->count;                    \
+        }                                                                                         \
+                                                                                                  \
+        if (counts[1] >= minimum)                                                                 \
+            return;                                                                               \
+                                                                                                  \
+        if (height == 0)                                                                          \
+        {                                                                                         \
+            struct SNAME##_leaf *leaf = parent->children[index];                                  \
+                                                                                                  \
+            if (counts[0] > minimum)                                                              \
+            {                                                                                     \
+                struct SNAME##_leaf *left = parent->children[index - 1];                          \
+                                                                                                  \
+                memmove(leaf->keys + 1, leaf->keys, sizeof(K) * leaf->count);                     \
+                memmove(leaf->values + 1, leaf->values, sizeof(V) * leaf->count);                 \
+                                                                                                  \
+                left->count--;                                                                    \
+                                                                                                  \
+                leaf->keys[0] = left->keys[left->count];                                          \
+                leaf->values[0] = left->values[left->count];                                      \
+                leaf->count++;                                                                    \
+                                                                                                  \
+                parent->keys[index - 1] = leaf->keys[0];                                          \
+                                                                                                  \
+                return;                                                                           \
+            }                                                                                     \
+                                                                                                  \
+            if (counts[2] > minimum)                                                              \
+            {                                                                                     \
+                struct SNAME##_leaf *right = parent->children[index + 1];                         \
+                                                                                                  \
+                leaf->keys[leaf->count] = right->keys[0];                                         \
+                leaf->values[leaf->count] = right->values[0];                                     \
+                leaf->count++;                                                                    \
+                                                                                                  \
+                right->count--;                                                                   \
+                                                                                                  \
+                memmove(right->keys, right->keys + 1, sizeof(K) * right->count);                  \
+                memmove(right->values, right->values + 1, sizeof(V) * right->count);              \
+                                                                                                  \
+                parent->keys[index] = right->keys[0];                                             \
+                                                                                                  \
+                return;                                                                           \
+            }                                                                                     \
+        }                                                                                         \
+        else                                                                                      \
+        {                                                                                         \
+            struct SNAME##_branch *branch = parent->children[index];                              \
+                                                                                                  \
+            if (counts[0] > minimum)                                                              \
+            {                                                                                     \
+                struct SNAME##_branch *left = parent->children[index - 1];                        \
+                                                                                                  \
+                memmove(branch->keys + 1, branch->keys, sizeof(K) * (branch->count - 1));         \
+                memmove(branch->children + 1, branch->children, sizeof(void *) * branch->count);  \
+                                                                                                  \
+                branch->keys[0] = parent->keys[index - 1];                                        \
+                branch->children[0] = left->children[left->count - 1];                            \
+                branch->count++;                                                                  \
+                                                                                                  \
+                parent->keys[index - 1] = left->keys[left->count - 2];                            \
+                                                                                                  \
+                left->count--;                                                                    \
+                                                                                                  \
+                return;                                                                           \
+            }                                                                                     \
+                                                                                                  \
+            if (counts[2] > minimum)                                                              \
+            {                                                                                     \
+                struct SNAME##_branch *right = parent->children[index + 1];                       \
+                                                                                                  \
+                branch->keys[branch->count - 1] = parent->keys[index];                            \
+                branch->children[branch->count] = right->children[0];                             \
+                branch->count++;                                                                  \
+                                                                                                  \
+                parent->keys[index] = right->keys[0];                                             \
+                                                                                                  \
+                right->count--;                                                                   \
+                                                                                                  \
+                memmove(right->keys, right->keys + 1, sizeof(K) * (right->count - 1));            \
+                memmove(right->children, right->children + 1, sizeof(void *) * right->count);     \
+                                                                                                  \
+                return;                                                                           \
+            }                                                                                     \
+        }                                                                                         \
+                                                                                                  \
+        /* No sibling can spare a key so both fit in one node */                                  \
+        if (counts[0] > 0)                                                                        \
+            PFX##_impl_merge_children(_map_, parent, index - 1, height);                          \
+        else if (counts[2] > 0)                                                                   \
+            PFX##_impl_merge_children(_map_, parent, index, height);                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Moves everything of the child at index + 1 of parent to the one at */                      \
+    /* index and frees it */                                                                      \
+    static void PFX##_impl_merge_children(struct SNAME *_map_, struct SNAME##_branch *parent,     \
+                                          size_t index, size_t height)                            \
+    {                                                                                             \
+        if (height == 0)                                                                          \
+        {                                                                                         \
+            struct SNAME##_leaf *left = parent->children[index];                                  \
+            struct SNAME##_leaf *right = parent->children[index + 1];                             \
+                                                                                                  \
+            memcpy(left->keys + left->count, right->keys, sizeof(K) * right->count);              \
+            memcpy(left->values + left->count, right->values, sizeof(V) * right->count);          \
+                                                                                                  \
+            left->count += right->count;                                                          \
+            left->next = right->next;                                                             \
+                                                                                                  \
+            if (right->next)                                                                      \
+                right->next->prev = left;                                                         \
+                                                                                                  \
+            _map_->alloc->free(right);                                                            \
+        }                                                                                         \
+        else                                                                                      \
+        {                                                                                         \
+            struct SNAME##_branch *left = parent->children[index];                                \
+            struct SNAME##_branch *right = parent->children[index + 1];                           \
+                                                                                                  \
+            left->keys[left->count - 1] = parent->keys[index];                                    \
+                                                                                                  \
+            memcpy(left->keys + left->count, right->keys, sizeof(K) * (right->count - 1));        \
+            memcpy(left->children + left->count, right->children,                                 \
+                   sizeof(void *) * right->count);                                                \
+                                                                                                  \
+            left->count += right->count;                                                          \
+                                                                                                  \
+            _map_->alloc->free(right);                                                            \
+        }                                                                                         \
+                                                                                                  \
+        size_t moved = parent->count - 2 - index;                                                 \
+                                                                                                  \
+        memmove(parent->keys + index, parent->keys + index + 1, sizeof(K) * moved);               \
+        memmove(parent->children + index + 1, parent->children + index + 2,                       \
+                sizeof(void *) * moved);                                                          \
+                                                                                                  \
+        parent->count--;                                                                          \
+    }                                                                                             \
+                                                                                                  \
+    static void PFX##_impl_free_node(struct SNAME *_map_, void *node, size_t height,              \
+                                     void (*deallocator)(K, V))                                   \
+    {                                                                                             \
+        if (height == 0)                                                                          \
+        {                                                                                         \
+            struct SNAME##_leaf *leaf = node;                                                     \
+                                                                                                  \
+            if (deallocator)                                                                      \
+            {                                                                                     \
+                for (size_t i = 0; i < leaf->count; i++)                                          \
+                    deallocator(leaf->keys[i], leaf->values[i]);                                  \
+            }                                                                                     \
+        }                                                                                         \
+        else                                                                                      \
+        {                                                                                         \
+            struct SNAME##_branch *branch = node;                                                 \
+                                                                                                  \
+            for (size_t i = 0; i < branch->count; i++)                                            \
+                PFX##_impl_free_node(_map_, branch->children[i], height - 1, deallocator);        \
+        }                                                                                         \
+                                                                                                  \
+        _map_->alloc->free(node);                                                                 \
+    }                                                                                             \
+                                                                                                  \
+    static size_t PFX##_impl_node_bytes(void *node, size_t height)                                \
+    {                                                                                             \
+        if (height == 0)                                                                          \
+            return sizeof(struct SNAME##_leaf);                                                   \
+                                                                                                  \
+        struct SNAME##_branch *branch = node;                                                     \
+        size_t bytes = sizeof(struct SNAME##_branch);                                             \
+                                                                                                  \
+        for (size_t i = 0; i < branch->count; i++)                                                \
+            bytes += PFX##_impl_node_bytes(branch->children[i], height - 1);                      \
+                                                                                                  \
+        return bytes;                                                                             \
+    }                                                                                             \
+                                                                                                  \
+    static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_map_)                           \
+    {                                                                                             \
+        struct SNAME##_iter iter;                                                                 \
+                                                                                                  \
+        PFX##_iter_init(&iter, _map_);                                                            \
+        PFX##_iter_to_start(&iter);                                                               \
+                                                                                                  \
+        return iter;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_map_)                             \
+    {                                                                                             \
+        struct SNAME##_iter iter;                                                                 \
+                                                                                                  \
+        PFX##_iter_init(&iter, _map_);                                                            \
+        PFX##_iter_to_end(&iter);                                                                 \
+                                                                                                  \
+        return iter;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    static inline int PFX##_impl_cmp(struct SNAME *_map_, K a, K b)                               \
+    {                                                                                             \
+        (void)_map_;                                                                              \
+                                                                                                  \
+        return CMP(a, b);                                                                         \
+    }
+
+#endif /* CMC_BTREEMAP_H */
@@ -0,0 +1,1445 @@
+/**
+ * btreeset.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * BTreeSet
+ *
+ * A BTreeSet is an implementation of a Set that keeps its elements sorted,
+ * with the same functions as the TreeSet. Like a Set it has only unique keys.
+ *
+ * Implementation
+ *
+ * This implementation uses a B+ tree, the same one of the BTreeMap. Every
+ * element is kept in a leaf, a node with room for CMC_BTREE_LEAF_SIZE
+ * elements next to each other, and the leaves are linked to the previous and
+ * the next ones for iterators. Branches only guide the search, with up to
+ * CMC_BTREE_BRANCH_SIZE children and the smallest element under each one of
+ * them but the first. Every node but the root is kept at least half full.
+ *
+ * Both sets of a set operation are sorted, so they are walked side by side
+ * once and the resulting set gets its elements in ascending order, which
+ * fills its leaves.
+ */
+
+#ifndef CMC_BTREESET_H
+#define CMC_BTREESET_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_serial.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_btreeset = "%s at %p { root:%p, height:%" PRIuMAX ", count:%" PRIuMAX ", cmp:%p }";
+
+/* Maximum amount of elements in a leaf, at least 4 */
+#ifndef CMC_BTREE_LEAF_SIZE
+#define CMC_BTREE_LEAF_SIZE 32
+#endif
+
+/* Maximum amount of children of a branch, at least 4 */
+#ifndef CMC_BTREE_BRANCH_SIZE
+#define CMC_BTREE_BRANCH_SIZE 32
+#endif
+
+#define CMC_GENERATE_BTREESET(PFX, SNAME, V)    \
+    CMC_GENERATE_BTREESET_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_BTREESET_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_BTREESET_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_BTREESET_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_BTREESET_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_BTREESET_SOURCE(PFX, SNAME, V)
+
+/* Same as CMC_GENERATE_BTREESET but elements are compared by calling CMP */
+/* directly, so the compiler can inline it. The function given to new is */
+/* still stored but only used by copy_of and to_string */
+#define CMC_GENERATE_BTREESET_EX(PFX, SNAME, V, CMP) \
+    CMC_GENERATE_BTREESET_HEADER(PFX, SNAME, V)      \
+    CMC_GENERATE_BTREESET_EX_SOURCE(PFX, SNAME, V, CMP)
+
+#define CMC_GENERATE_BTREESET_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_BTREESET_SOURCE(PFX, SNAME, V, _set_->cmp)
+
+#define CMC_GENERATE_BTREESET_EX_SOURCE(PFX, SNAME, V, CMP) \
+    CMC_IMPL_BTREESET_SOURCE(PFX, SNAME, V, CMP)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_BTREESET_HEADER(PFX, SNAME, V)                                       \
+                                                                                          \
+    /* BTreeSet Structure */                                                              \
+    struct SNAME                                                                          \
+    {                                                                                     \
+        /* Root node, a leaf if height is 0 or NULL if the set is empty */                \
+        void *root;                                                                       \
+                                                                                          \
+        /* Amount of branches between the root and the leaves */                          \
+        size_t height;                                                                    \
+                                                                                          \
+        /* Current amount of elements */                                                  \
+        size_t count;                                                                     \
+                                                                                          \
+        /* Element comparison function */                                                 \
+        int (*cmp)(V, V);                                                                 \
+                                                                                          \
+        /* Function that returns an iterator to the start of the btreeset */              \
+        struct SNAME##_iter (*it_start)(struct SNAME *);                                  \
+                                                                                          \
+        /* Function that returns an iterator to the end of the btreeset */                \
+        struct SNAME##_iter (*it_end)(struct SNAME *);                                    \
+                                                                                          \
+        /* Custom allocation functions */                                                 \
+        struct cmc_alloc_node *alloc;                                                     \
+    };                                                                                    \
+                                                                                          \
+    /* BTreeSet Leaf */                                                                   \
+    struct SNAME##_leaf                                                                   \
+    {                                                                                     \
+        /* Elements in ascending order */                                                 \
+        V values[CMC_BTREE_LEAF_SIZE];                                                    \
+                                                                                          \
+        /* Amount of elements in the leaf */                                              \
+        size_t count;                                                                     \
+                                                                                          \
+        /* Leaf with the elements right before these ones */                              \
+        struct SNAME##_leaf *prev;                                                        \
+                                                                                          \
+        /* Leaf with the elements right after these ones */                               \
+        struct SNAME##_leaf *next;                                                        \
+    };                                                                                    \
+                                                                                          \
+    /* BTreeSet Branch */                                                                 \
+    struct SNAME##_branch                                                                 \
+    {                                                                                     \
+        /* values[i] is the smallest element under children[i + 1] */                     \
+        V values[CMC_BTREE_BRANCH_SIZE - 1];                                              \
+                                                                                          \
+        /* Leaves one level above them, otherwise branches */                             \
+        void *children[CMC_BTREE_BRANCH_SIZE];                                            \
+                                                                                          \
+        /* Amount of children */                                                          \
+        size_t count;                                                                     \
+    };                                                                                    \
+                                                                                          \
+    /* BTreeSet Iterator */                                                               \
+    struct SNAME##_iter                                                                   \
+    {                                                                                     \
+        /* Target btreeset */                                                             \
+        struct SNAME *target;                                                             \
+                                                                                          \
+        /* Leaf of the cursor */                                                          \
+        struct SNAME##_leaf *cursor;                                                      \
+                                                                                          \
+        /* Position of the cursor in its leaf */                                          \
+        size_t position;                                                                  \
+                                                                                          \
+        /* Keeps track of relative index to the iteration of elements */                  \
+        size_t index;                                                                     \
+                                                                                          \
+        /* If the iterator has reached the start of the iteration */                      \
+        bool start;                                                                       \
+                                                                                          \
+        /* If the iterator has reached the end of the iteration */                        \
+        bool end;                                                                         \
+    };                                                                                    \
+                                                                                          \
+    /* Collection Functions */                                                            \
+    /* Collection Allocation and Deallocation */                                          \
+    struct SNAME *PFX##_new(int (*compare)(V, V));                                        \
+    struct SNAME *PFX##_new_custom(int (*compare)(V, V), struct cmc_alloc_node *alloc);   \
+    void PFX##_clear(struct SNAME *_set_, void (*deallocator)(V));                        \
+    void PFX##_free(struct SNAME *_set_, void (*deallocator)(V));                         \
+    /* Collection Input and Output */                                                     \
+    bool PFX##_insert(struct SNAME *_set_, V element);                                    \
+    bool PFX##_remove(struct SNAME *_set_, V element);                                    \
+    /* Element Access */                                                                  \
+    bool PFX##_max(struct SNAME *_set_, V *value);                                        \
+    bool PFX##_min(struct SNAME *_set_, V *value);                                        \
+    /* Collection State */                                                                \
+    bool PFX##_contains(struct SNAME *_set_, V element);                                  \
+    CMC_PURE bool PFX##_empty(struct SNAME *_set_);                                       \
+    CMC_PURE size_t PFX##_count(struct SNAME *_set_);                                     \
+    size_t PFX##_memory_usage(struct SNAME *_set_);                                       \
+    /* Collection Utility */                                                              \
+    struct SNAME *PFX##_copy_of(struct SNAME *_set_, V (*copy_func)(V));                  \
+    bool PFX##_equals(struct SNAME *_set1_, struct SNAME *_set2_);                        \
+    struct cmc_string PFX##_to_string(struct SNAME *_set_);                               \
+    bool PFX##_to_string_full(struct SNAME *_set_, struct cmc_string_builder *builder,    \
+                              const char *elem_fmt);                                      \
+    bool PFX##_write(struct SNAME *_set_, FILE *file, void (*fmt)(FILE *, V));            \
+    bool PFX##_write_fd(struct SNAME *_set_, int fd, void (*fmt)(struct cmc_dump *, V));  \
+    /* Collection Serialization */                                                        \
+    bool PFX##_save(struct SNAME *_set_, FILE *file, bool (*writer)(V, FILE *));          \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(V, V),                         \
+                                bool (*reader)(V *, FILE *));                             \
+                                                                                          \
+    /* Set Operations */                                                                  \
+    struct SNAME *PFX##_union(struct SNAME *_set1_, struct SNAME *_set2_);                \
+    struct SNAME *PFX##_intersection(struct SNAME *_set1_, struct SNAME *_set2_);         \
+    struct SNAME *PFX##_difference(struct SNAME *_set1_, struct SNAME *_set2_);           \
+    struct SNAME *PFX##_symmetric_difference(struct SNAME *_set1_, struct SNAME *_set2_); \
+    bool PFX##_is_subset(struct SNAME *_set1_, struct SNAME *_set2_);                     \
+    bool PFX##_is_superset(struct SNAME *_set1_, struct SNAME *_set2_);                   \
+    bool PFX##_is_proper_subset(struct SNAME *_set1_, struct SNAME *_set2_);              \
+    bool PFX##_is_proper_superset(struct SNAME *_set1_, struct SNAME *_set2_);            \
+    bool PFX##_is_disjointset(struct SNAME *_set1_, struct SNAME *_set2_);                \
+                                                                                          \
+    /* Iterator Functions */                                                              \
+    /* Iterator Allocation and Deallocation */                                            \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target);                            \
+    void PFX##_iter_free(struct SNAME##_iter *iter);                                      \
+    /* Iterator Initialization */                                                         \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);                \
+    /* Iterator State */                                                                  \
+    bool PFX##_iter_start(struct SNAME##_iter *iter);                                     \
+    bool PFX##_iter_end(struct SNAME##_iter *iter);                                       \
+    /* Iterator Movement */                                                               \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter);                                  \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter);                                    \
+    bool PFX##_iter_next(struct SNAME##_iter *iter);                                      \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter);                                      \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps);                     \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps);                      \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index);                       \
+    /* Iterator Access */                                                                 \
+    V PFX##_iter_value(struct SNAME##_iter *iter);                                        \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter);                                   \
+                                                                                          \
+/* SOURCE ********************************************************************/
+#define CMC_IMPL_BTREESET_SOURCE(PFX, SNAME, V, CMP)                                              \
+                                                                                                  \
+    /* Implementation Detail Functions */                                                         \
+    static inline int PFX##_impl_cmp(struct SNAME *_set_, V a, V b);                              \
+    static size_t PFX##_impl_lower_bound(struct SNAME *_set_, V *values, size_t n, V element);    \
+    static size_t PFX##_impl_upper_bound(struct SNAME *_set_, V *values, size_t n, V element);    \
+    static struct SNAME##_leaf *PFX##_impl_new_leaf(struct SNAME *_set_);                         \
+    static struct SNAME##_leaf *PFX##_impl_first_leaf(struct SNAME *_set_);                       \
+    static struct SNAME##_leaf *PFX##_impl_last_leaf(struct SNAME *_set_);                        \
+    static V *PFX##_impl_get_element(struct SNAME *_set_, V element);                             \
+    static V *PFX##_impl_insert(struct SNAME *_set_, V element, V **found);                       \
+    static bool PFX##_impl_split_child(struct SNAME *_set_, struct SNAME##_branch *parent,        \
+                                       size_t index, size_t height, V element);                   \
+    static bool PFX##_impl_remove(struct SNAME *_set_, void *node, size_t height, V element);     \
+    static void PFX##_impl_fix_child(struct SNAME *_set_, struct SNAME##_branch *parent,          \
+                                     size_t index, size_t height);                                \
+    static void PFX##_impl_merge_children(struct SNAME *_set_, struct SNAME##_branch *parent,     \
+                                          size_t index, size_t height);                           \
+    static void PFX##_impl_free_node(struct SNAME *_set_, void *node, size_t height,              \
+                                     void (*deallocator)(V));                                     \
+    static size_t PFX##_impl_node_bytes(void *node, size_t height);                               \
+    static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_set_);                          \
+    static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_set_);                            \
+                                                                                                  \
+    struct SNAME *PFX##_new(int (*compare)(V, V))                                                 \
+    {                                                                                             \
+        return PFX##_new_custom(compare, NULL);                                                   \
+    }                                                                                             \
+                                                                                                  \
+    struct SNAME *PFX##_new_custom(int (*compare)(V, V), struct cmc_alloc_node *alloc)            \
+    {                                                                                             \
+        if (!alloc)                                                                               \
+            alloc = &cmc_alloc_node_default;                                                      \
+                                                                                                  \
+        struct SNAME *_set_ = alloc->malloc(sizeof(struct SNAME));                                \
+                                                                                                  \
+        if (CMC_UNLIKELY(!_set_))                                                                 \
+            return NULL;                                                                          \
+                                                                                                  \
+        _set_->alloc = alloc;                                                                     \
+                                                                                                  \
+        _set_->root = NULL;                                                                       \
+        _set_->height = 0;                                                                        \
+        _set_->count = 0;                                                                         \
+        _set_->cmp = compare;                                                                     \
+                                                                                                  \
+        _set_->it_start = PFX##_impl_it_start;                                                    \
+        _set_->it_end = PFX##_impl_it_end;                                                        \
+                                                                                                  \
+        return _set_;                                                                             \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_clear(struct SNAME *_set_, void (*deallocator)(V))                                 \
+    {                                                                                             \
+        if (_set_->root)                                                                          \
+            PFX##_impl_free_node(_set_, _set_->root, _set_->height, deallocator);                 \
+                                                                                                  \
+        _set_->root = NULL;                                                                       \
+        _set_->height = 0;                                                                        \
+        _set_->count = 0;                                                                         \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_free(struct SNAME *_set_, void (*deallocator)(V))                                  \
+    {                                                                                             \
+        PFX##_clear(_set_, deallocator);                                                          \
+                                                                                                  \
+        _set_->alloc->free(_set_);                                                                \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_insert(struct SNAME *_set_, V element)                                             \
+    {                                                                                             \
+        V *existing = NULL;                                                                       \
+                                                                                                  \
+        return PFX##_impl_insert(_set_, element, &existing) != NULL;                              \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_remove(struct SNAME *_set_, V element)                                             \
+    {                                                                                             \
+        if (PFX##_empty(_set_))                                                                   \
+            return false;                                                                         \
+                                                                                                  \
+        if (!PFX##_impl_remove(_set_, _set_->root, _set_->height, element))                       \
+            return false;                                                                         \
+                                                                                                  \
+        _set_->count--;                                                                           \
+                                                                                                  \
+        /* The tree only gets shorter at the root */                                              \
+        if (_set_->height > 0 && ((struct SNAME##_branch *)_set_->root)->count == 1)              \
+        {                                                                                         \
+            struct SNAME##_branch *root = _set_->root;                                            \
+                                                                                                  \
+            _set_->root = root->children[0];                                                      \
+            _set_->height--;                                                                      \
+                                                                                                  \
+            _set_->alloc->free(root);                                                             \
+        }                                                                                         \
+        else if (_set_->count == 0)                                                               \
+        {                                                                                         \
+            _set_->alloc->free(_set_->root);                                                      \
+                                                                                                  \
+            _set_->root = NULL;                                                                   \
+        }                                                                                         \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_max(struct SNAME *_set_, V *value)                                                 \
+    {                                                                                             \
+        if (PFX##_empty(_set_))                                                                   \
+            return false;                                                                         \
+                                                                                                  \
+        struct SNAME##_leaf *leaf = PFX##_impl_last_leaf(_set_);                                  \
+                                                                                                  \
+        *value = leaf->values[leaf->count - 1];                                                   \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_min(struct SNAME *_set_, V *value)                                                 \
+    {                                                                                             \
+        if (PFX##_empty(_set_))                                                                   \
+            return false;                                                                         \
+                                                                                                  \
+        *value = PFX##_impl_first_leaf(_set_)->values[0];                                         \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_contains(struct SNAME *_set_, V element)                                           \
+    {                                                                                             \
+        return PFX##_impl_get_element(_set_, element) != NULL;                                    \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_empty(struct SNAME *_set_)                                                         \
+    {                                                                                             \
+        return _set_->count == 0;                                                                 \
+    }                                                                                             \
+                                                                                                  \
+    size_t PFX##_count(struct SNAME *_set_)                                                       \
+    {                                                                                             \
+        return _set_->count;                                                                      \
+    }                                                                                             \
+                                                                                                  \
+    size_t PFX##_memory_usage(struct SNAME *_set_)                                                \
+    {                                                                                             \
+        if (!_set_->root)                                                                         \
+            return sizeof(struct SNAME);                                                          \
+                                                                                                  \
+        return sizeof(struct SNAME) + PFX##_impl_node_bytes(_set_->root, _set_->height);          \
+    }                                                                                             \
+                                                                                                  \
+    /* The elements are inserted in ascending order so the copy has full leaves */                \
+    struct SNAME *PFX##_copy_of(struct SNAME *_set_, V (*copy_func)(V))                           \
+    {                                                                                             \
+        struct SNAME *result = PFX##_new_custom(_set_->cmp, _set_->alloc);                        \
+                                                                                                  \
+        if (CMC_UNLIKELY(!result))                                                                \
+            return NULL;                                                                          \
+                                                                                                  \
+        struct SNAME##_iter iter;                                                                 \
+        PFX##_iter_init(&iter, _set_);                                                            \
+                                                                                                  \
+        if (!PFX##_empty(_set_))                                                                  \
+        {                                                                                         \
+            for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))      \
+            {                                                                                     \
+                if (copy_func)                                                                    \
+                    PFX##_insert(result, copy_func(PFX##_iter_value(&iter)));                     \
+                else                                                                              \
+                    PFX##_insert(result, PFX##_iter_value(&iter));                                \
+            }                                                                                     \
+        }                                                                                         \
+                                                                                                  \
+        return result;                                                                            \
+    }                                                                                             \
+                                                                                                  \
+    /* Both sets are sorted so their elements are compared in a single pass */                    \
+    bool PFX##_equals(struct SNAME *_set1_, struct SNAME *_set2_)                                 \
+    {                                                                                             \
+        if (PFX##_count(_set1_) != PFX##_count(_set2_))                                           \
+            return false;                                                                         \
+                                                                                                  \
+        struct SNAME##_iter iter1, iter2;                                                         \
+        PFX##_iter_init(&iter1, _set1_);                                                          \
+        PFX##_iter_init(&iter2, _set2_);                                                          \
+                                                                                                  \
+        for (; !PFX##_iter_end(&iter1); PFX##_iter_next(&iter1), PFX##_iter_next(&iter2))         \
+        {                                                                                         \
+            if (PFX##_impl_cmp(_set1_, PFX##_iter_value(&iter1), PFX##_iter_value(&iter2)) != 0)  \
+                return false;                                                                     \
+        }                                                                                         \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    struct cmc_string PFX##_to_string(struct SNAME *_set_)                                        \
+    {                                                                                             \
+        struct cmc_string str;                                                                    \
+        struct SNAME *s_ = _set_;                                                                 \
+        const char *name = #SNAME;                                                                \
+                                                                                                  \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_btreeset,                                  \
+                 name, s_, s_->root, s_->height, s_->count, s_->cmp);                             \
+                                                                                                  \
+        return str;                                                                               \
+    }                                                                                             \
+                                                                                                  \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE)                                \
+                                                                                                  \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE, (V))                                  \
+                                                                                                  \
+    bool PFX##_save(struct SNAME *_set_, FILE *file, bool (*writer)(V, FILE *))                   \
+    {                                                                                             \
+        uint32_t flags = writer ? 0 : CMC_SERIAL_RAW_VALUES;                                      \
+                                                                                                  \
+        if (!cmc_serial_write_header(file, "btreeset", flags, 0, sizeof(V), 0, _set_->count,      \
+                                     _set_->count, 0))                                            \
+            return false;                                                                         \
+                                                                                                  \
+        struct SNAME##_iter iter;                                                                 \
+        PFX##_iter_init(&iter, _set_);                                                            \
+                                                                                                  \
+        if (!PFX##_empty(_set_))                                                                  \
+        {                                                                                         \
+            for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))      \
+            {                                                                                     \
+                V value = PFX##_iter_value(&iter);                                                \
+                                                                                                  \
+                if (!CMC_SERIAL_WRITE(writer, value, file))                                       \
+                    return false;                                                                 \
+            }                                                                                     \
+        }                                                                                         \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* The reader is only used if the set was saved with a writer */                              \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(V, V),                                 \
+                                bool (*reader)(V *, FILE *))                                      \
+    {                                                                                             \
+        struct cmc_serial_header header;                                                          \
+                                                                                                  \
+        if (!cmc_serial_read_header(file, "btreeset", 0, sizeof(V), &header))                     \
+            return NULL;                                                                          \
+                                                                                                  \
+        struct SNAME *_set_ = PFX##_new(compare);                                                 \
+                                                                                                  \
+        if (CMC_UNLIKELY(!_set_))                                                                 \
+            return NULL;                                                                          \
+                                                                                                  \
+        bool raw = header.flags & CMC_SERIAL_RAW_VALUES;                                          \
+                                                                                                  \
+        for (size_t i = 0; i < header.count; i++)                                                 \
+        {                                                                                         \
+            V value;                                                                              \
+                                                                                                  \
+            if (!CMC_SERIAL_READ(raw, reader, &value, file) || !PFX##_insert(_set_, value))       \
+            {                                                                                     \
+                PFX##_free(_set_, NULL);                                                          \
+                return NULL;                                                                      \
+            }                                                                                     \
+        }                                                                                         \
+                                                                                                  \
+        return _set_;                                                                             \
+    }                                                                                             \
+                                                                                                  \
+    struct SNAME *PFX##_union(struct SNAME *_set1_, struct SNAME *_set2_)                         \
+    {                                                                                             \
+        struct SNAME *_set_r_ = PFX##_new_custom(_set1_->cmp, _set1_->alloc);                     \
+                                                                                                  \
+        if (CMC_UNLIKELY(!_set_r_))                                                               \
+            return NULL;                                                                          \
+                                                                                                  \
+        struct SNAME##_iter iter1, iter2;                                                         \
+        PFX##_iter_init(&iter1, _set1_);                                                          \
+        PFX##_iter_init(&iter2, _set2_);                                                          \
+                                                                                                  \
+        while (!PFX##_iter_end(&iter1) && !PFX##_iter_end(&iter2))                                \
+        {                                                                                         \
+            V value1 = PFX##_iter_value(&iter1);                                                  \
+            V value2 = PFX##_iter_value(&iter2);                                                  \
+                                                                                                  \
+            int c = PFX##_impl_cmp(_set1_, value1, value2);                                       \
+                                                                                                  \
+            if (c <= 0)                                                                           \
+            {                                                                                     \
+                PFX##_insert(_set_r_, value1);                                                    \
+                PFX##_iter_next(&iter1);                                                          \
+                                                                                                  \
+                if (c == 0)                                                                       \
+                    PFX##_iter_next(&iter2);                                                      \
+            }                                                                                     \
+            else                                                                                  \
+            {                                                                                     \
+                PFX##_insert(_set_r_, value2);                                                    \
+                PFX##_iter_next(&iter2);                                                          \
+            }                                                                                     \
+        }                                                                                         \
+                                                                                                  \
+        for (; !PFX##_iter_end(&iter1); PFX##_iter_next(&iter1))                                  \
+            PFX##_insert(_set_r_, PFX##_iter_value(&iter1));                                      \
+                                                                                                  \
+        for (; !PFX##_iter_end(&iter2); PFX##_iter_next(&iter2))                                  \
+            PFX##_insert(_set_r_, PFX##_iter_value(&iter2));                                      \
+                                                                                                  \
+        return _set_r_;                                                                           \
+    }                                                                                             \
+                                                                                                  \
+    struct SNAME *PFX##_intersection(struct SNAME *_set1_, struct SNAME *_set2_)                  \
+    {                                                                                             \
+        struct SNAME *_set_r_ = PFX##_new_custom(_set1_->cmp, _set1_->alloc);                     \
+                                                                                                  \
+        if (CMC_UNLIKELY(!_set_r_))                                                               \
+            return NULL;                                                                          \
+                                                                                                  \
+        struct SNAME##_iter iter1, iter2;                                                         \
+        PFX##_iter_init(&iter1, _set1_);                                                          \
+        PFX##_iter_init(&iter2, _set2_);                                                          \
+                                                                                                  \
+        while (!PFX##_iter_end(&iter1) && !PFX##_iter_end(&iter2))                                \
+        {                                                                                         \
+            V value1 = PFX##_iter_value(&iter1);                                                  \
+                                                                                                  \
+            int c = PFX##_impl_cmp(_set1_, value1, PFX##_iter_value(&iter2));                     \
+                                                                                                  \
+            if (c == 0)                                                                           \
+                PFX##_insert(_set_r_, value1);                                                    \
+                                                                                                  \
+            if (c <= 0)                                                                           \
+                PFX##_iter_next(&iter1);                                                          \
+            if (c >= 0)                                                                           \
+                PFX##_iter_next(&iter2);                                                          \
+        }                                                                                         \
+                                                                                                  \
+        return _set_r_;                                                                           \
+    }                                                                                             \
+                                                                                                  \
+    struct SNAME *PFX##_difference(struct SNAME *_set1_, struct SNAME *_set2_)                    \
+    {                                                                                             \
+        struct SNAME *_set_r_ = PFX##_new_custom(_set1_->cmp, _set1_->alloc);                     \
+                                                                                                  \
+        if (CMC_UNLIKELY(!_set_r_))                                                               \
+            return NULL;                                                                          \
+                                                                                                  \
+        struct SNAME##_iter iter1, iter2;                                                         \
+        PFX##_iter_init(&iter1, _set1_);                                                          \
+        PFX##_iter_init(&iter2, _set2_);                                                          \
+                                                                                                  \
+        while (!PFX##_iter_end(&iter1) && !PFX##_iter_end(&iter2))                                \
+        {                                                                                         \
+            V value1 = PFX##_iter_value(&iter1);                                                  \
+                                                                                                  \
+            int c = PFX##_impl_cmp(_set1_, value1, PFX##_iter_value(&iter2));                     \
+                                                                                                  \
+            if (c < 0)                                                                            \
+                PFX##_insert(_set_r_, value1);                                                    \
+                                                                                                  \
+            if (c <= 0)                                                                           \
+                PFX##_iter_next(&iter1);                                                          \
+            if (c >= 0)                                                                           \
+                PFX##_iter_next(&iter2);                                                          \
+        }                                                                                         \
+                                                                                                  \
+        for (; !PFX##_iter_end(&iter1); PFX##_iter_next(&iter1))                                  \
+            PFX##_insert(_set_r_, PFX##_iter_value(&iter1));                                      \
+                                                                                                  \
+        return _set_r_;                                                                           \
+    }                                                                                             \
+                                                                                                  \
+    struct SNAME *PFX##_symmetric_difference(struct SNAME *_set1_, struct SNAME *_set2_)          \
+    {                                                                                             \
+        struct SNAME *_set_r_ = PFX##_new_custom(_set1_->cmp, _set1_->alloc);                     \
+                                                                                                  \
+        if (CMC_UNLIKELY(!_set_r_))                                                               \
+            return NULL;                                                                          \
+                                                                                                  \
+        struct SNAME##_iter iter1, iter2;                                                         \
+        PFX##_iter_init(&iter1, _set1_);                                                          \
+        PFX##_iter_init(&iter2, _set2_);                                                          \
+                                                                                                  \
+        while (!PFX##_iter_end(&iter1) && !PFX##_iter_end(&iter2))                                \
+        {                                                                                         \
+            V value1 = PFX##_iter_value(&iter1);                                                  \
+            V value2 = PFX##_iter_value(&iter2);                                                  \
+                                                                                                  \
+            int c = PFX##_impl_cmp(_set1_, value1, value2);                                       \
+                                                                                                  \
+            if (c < 0)                                                                            \
+                PFX##_insert(_set_r_, value1);                                                    \
+            else if (c > 0)                                                                       \
+                PFX##_insert(_set_r_, value2);                                                    \
+                                                                                                  \
+            if (c <= 0)                                                                           \
+                PFX##_iter_next(&iter1);                                                          \
+            if (c >= 0)                                                                           \
+                PFX##_iter_next(&iter2);                                                          \
+        }                                                                                         \
+                                                                                                  \
+        for (; !PFX##_iter_end(&iter1); PFX##_iter_next(&iter1))                                  \
+            PFX##_insert(_set_r_, PFX##_iter_value(&iter1));                                      \
+                                                                                                  \
+        for (; !PFX##_iter_end(&iter2); PFX##_iter_next(&iter2))                                  \
+            PFX##_insert(_set_r_, PFX##_iter_value(&iter2));                                      \
+                                                                                                  \
+        return _set_r_;                                                                           \
+    }                                                                                             \
+                                                                                                  \
+    /* Is _set1_ a subset of _set2_ ? */                                                          \
+    /* A set X is a subset of a set Y when: X <= Y */                                             \
+    /* If X is a subset of Y, then Y is a superset of X */                                        \
+    bool PFX##_is_subset(struct SNAME *_set1_, struct SNAME *_set2_)                              \
+    {                                                                                             \
+        /* If the cardinality of _set1_ is greater than that of _set2_, then it is safe */        \
+        /* to say that _set1_ can't be a subset of _set2_ */                                      \
+        if (PFX##_count(_set1_) > PFX##_count(_set2_))                                            \
+            return false;                                                                         \
+                                                                                                  \
+        /* The empty set is a subset of all sets */                                               \
+        if (PFX##_empty(_set1_))                                                                  \
+            return true;                                                                          \
+                                                                                                  \
+        struct SNAME##_iter iter1, iter2;                                                         \
+        PFX##_iter_init(&iter1, _set1_);                                                          \
+        PFX##_iter_init(&iter2, _set2_);                                                          \
+                                                                                                  \
+        while (!PFX##_iter_end(&iter1))                                                           \
+        {                                                                                         \
+            if (PFX##_iter_end(&iter2))                                                           \
+                return false;                                                                     \
+                                                                                                  \
+            int c = PFX##_impl_cmp(_set1_, PFX##_iter_value(&iter1), PFX##_iter_value(&iter2));   \
+                                                                                                  \
+            /* Every element of _set2_ that could match it was skipped */                         \
+            if (c < 0)                                                                            \
+                return false;                                                                     \
+                                                                                                  \
+            if (c == 0)                                                                           \
+                PFX##_iter_next(&iter1);                                                          \
+                                                                                                  \
+            PFX##_iter_next(&iter2);                                                              \
+        }                                                                                         \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Is _set1_ a superset of _set2_ ? */                                                        \
+    /* A set X is a superset of a set Y when: X >= Y */                                           \
+    /* If X is a superset of Y, then Y is a subset of X */                                        \
+    bool PFX##_is_superset(struct SNAME *_set1_, struct SNAME *_set2_)                            \
+    {                                                                                             \
+        return PFX##_is_subset(_set2_, _set1_);                                                   \
+    }                                                                                             \
+                                                                                                  \
+    /* Is _set1_ a proper subset of _set2_ ? */                                                   \
+    /* A set X is a proper subset of a set Y when: X < Y */                                       \
+    /* If X is a proper subset of Y, then Y is a proper superset of X */                          \
+    bool PFX##_is_proper_subset(struct SNAME *_set1_, struct SNAME *_set2_)                       \
+    {                                                                                             \
+        /* If the cardinality of _set1_ is greater than or equal to that of _set2_, then */       \
+        /* it is safe to say that _set1_ can't be a proper subset of _set2_ */                    \
+        if (PFX##_count(_set1_) >= PFX##_count(_set2_))                                           \
+            return false;                                                                         \
+                                                                                                  \
+        /* _set2_ has more elements so a subset of it is also a proper subset */                  \
+        return PFX##_is_subset(_set1_, _set2_);                                                   \
+    }                                                                                             \
+                                                                                                  \
+    /* Is _set1_ a proper superset of _set2_ ? */                                                 \
+    /* A set X is a proper superset of a set Y when: X > Y */                                     \
+    /* If X is a proper superset of Y, then Y is a proper subset of X */                          \
+    bool PFX##_is_proper_superset(struct SNAME *_set1_, struct SNAME *_set2_)                     \
+    {                                                                                             \
+        return PFX##_is_proper_subset(_set2_, _set1_);                                            \
+    }                                                                                             \
+                                                                                                  \
+    /* Is _set1_ a disjointset of _set2_ ? */                                                     \
+    /* A set X is a disjointset of a set Y if their intersection is empty, that is, if */         \
+    /* there are no elements in common between the two */                                         \
+    bool PFX##_is_disjointset(struct SNAME *_set1_, struct SNAME *_set2_)                         \
+    {                                                                                             \
+        struct SNAME##_iter iter1, iter2;                                                         \
+        PFX##_iter_init(&iter1, _set1_);                                                          \
+        PFX##_iter_init(&iter2, _set2_);                                                          \
+                                                                                                  \
+        while (!PFX##_iter_end(&iter1) && !PFX##_iter_end(&iter2))                                \
+        {                                                                                         \
+            int c = PFX##_impl_cmp(_set1_, PFX##_iter_value(&iter1), PFX##_iter_value(&iter2));   \
+                                                                                                  \
+            if (c == 0)                                                                           \
+                return false;                                                                     \
+            else if (c < 0)                                                                       \
+                PFX##_iter_next(&iter1);                                                          \
+            else                                                                                  \
+                PFX##_iter_next(&iter2);                                                          \
+        }                                                                                         \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                     \
+    {                                                                                             \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));           \
+                                                                                                  \
+        if (CMC_UNLIKELY(!iter))                                                                  \
+            return NULL;                                                                          \
+                                                                                                  \
+        PFX##_iter_init(iter, target);                                                            \
+                                                                                                  \
+        return iter;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_iter_free(struct SNAME##_iter *iter)                                               \
+    {                                                                                             \
+        iter->target->alloc->free(iter);                                                          \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                         \
+    {                                                                                             \
+        memset(iter, 0, sizeof(struct SNAME##_iter));                                             \
+                                                                                                  \
+        iter->target = target;                                                                    \
+        iter->start = true;                                                                       \
+        iter->end = PFX##_empty(target);                                                          \
+                                                                                                  \
+        if (!PFX##_empty(target))                                                                 \
+            iter->cursor = PFX##_impl_first_leaf(target);                                         \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                              \
+    {                                                                                             \
+        return PFX##_empty(iter->target) || iter->start;                                          \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                                \
+    {                                                                                             \
+        return PFX##_empty(iter->target) || iter->end;                                            \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                           \
+    {                                                                                             \
+        if (!PFX##_empty(iter->target))                                                           \
+        {                                                                                         \
+            iter->index = 0;                                                                      \
+            iter->start = true;                                                                   \
+            iter->end = PFX##_empty(iter->target);                                                \
+            iter->cursor = PFX##_impl_first_leaf(iter->target);                                   \
+            iter->position = 0;                                                                   \
+        }                                                                                         \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                             \
+    {                                                                                             \
+        if (!PFX##_empty(iter->target))                                                           \
+        {                                                                                         \
+            iter->index = iter->target->count - 1;                                                \
+            iter->start = PFX##_empty(iter->target);                                              \
+            iter->end = true;                                                                     \
+            iter->cursor = PFX##_impl_last_leaf(iter->target);                                    \
+            iter->position = iter->cursor->count - 1;                                             \
+        }                                                                                         \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                               \
+    {                                                                                             \
+        if (iter->end)                                                                            \
+            return false;                                                                         \
+                                                                                                  \
+        if (iter->index + 1 == PFX##_count(iter->target))                                         \
+        {                                                                                         \
+            iter->end = true;                                                                     \
+            return false;                                                                         \
+        }                                                                                         \
+                                                                                                  \
+        iter->start = PFX##_empty(iter->target);                                                  \
+                                                                                                  \
+        if (++iter->position == iter->cursor->count)                                              \
+        {                                                                                         \
+            iter->cursor = iter->cursor->next;                                                    \
+            iter->position = 0;                                                                   \
+        }                                                                                         \
+                                                                                                  \
+        iter->index++;                                                                            \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                               \
+    {                                                                                             \
+        if (iter->start)                                                                          \
+            return false;                                                                         \
+                                                                                                  \
+        if (iter->index == 0)                                                                     \
+        {                                                                                         \
+            iter->start = true;                                                                   \
+            return false;                                                                         \
+        }                                                                                         \
+                                                                                                  \
+        iter->end = PFX##_empty(iter->target);                                                    \
+                                                                                                  \
+        if (iter->position-- == 0)                                                                \
+        {                                                                                         \
+            iter->cursor = iter->cursor->prev;                                                    \
+            iter->position = iter->cursor->count - 1;                                             \
+        }                                                                                         \
+                                                                                                  \
+        iter->index--;                                                                            \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Returns true only if the iterator moved. Whole leaves are skipped */                       \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps)                              \
+    {                                                                                             \
+        if (iter->end)                                                                            \
+            return false;                                                                         \
+                                                                                                  \
+        if (iter->index + 1 == PFX##_count(iter->target))                                         \
+        {                                                                                         \
+            iter->end = true;                                                                     \
+            return false;                                                                         \
+        }                                                                                         \
+                                                                                                  \
+        if (steps == 0 || iter->index + steps >= PFX##_count(iter->target))                       \
+            return false;                                                                         \
+                                                                                                  \
+        iter->start = PFX##_empty(iter->target);                                                  \
+        iter->index += steps;                                                                     \
+        iter->position += steps;                                                                  \
+                                                                                                  \
+        while (iter->position >= iter->cursor->count)                                             \
+        {                                                                                         \
+            iter->position -= iter->cursor->count;                                                \
+            iter->cursor = iter->cursor->next;                                                    \
+        }                                                                                         \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Returns true only if the iterator moved. Whole leaves are skipped */                       \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps)                               \
+    {                                                                                             \
+        if (iter->start)                                                                          \
+            return false;                                                                         \
+                                                                                                  \
+        if (iter->index == 0)                                                                     \
+        {                                                                                         \
+            iter->start = true;                                                                   \
+            return false;                                                                         \
+        }                                                                                         \
+                                                                                                  \
+        if (steps == 0 || iter->index < steps)                                                    \
+            return false;                                                                         \
+                                                                                                  \
+        iter->end = PFX##_empty(iter->target);                                                    \
+        iter->index -= steps;                                                                     \
+                                                                                                  \
+        while (steps > iter->position)                                                            \
+        {                                                                                         \
+            steps -= iter->position + 1;                                                          \
+            iter->cursor = iter->cursor->prev;                                                    \
+            iter->position = iter->cursor->count - 1;                                             \
+        }                                                                                         \
+                                                                                                  \
+        iter->position -= steps;                                                                  \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Returns true only if the iterator was able to be positioned at the given index */          \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index)                                \
+    {                                                                                             \
+        if (index >= PFX##_count(iter->target))                                                   \
+            return false;                                                                         \
+                                                                                                  \
+        if (iter->index > index)                                                                  \
+            return PFX##_iter_rewind(iter, iter->index - index);                                  \
+        else if (iter->index < index)                                                             \
+            return PFX##_iter_advance(iter, index - iter->index);                                 \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                                 \
+    {                                                                                             \
+        if (PFX##_empty(iter->target))                                                            \
+            return (V){0};                                                                        \
+                                                                                                  \
+        return iter->cursor->values[iter->position];                                              \
+    }                                                                                             \
+                                                                                                  \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                            \
+    {                                                                                             \
+        return iter->index;                                                                       \
+    }                                                                                             \
+                                                                                                  \
+    /* Position of the first element that is not less than element */                             \
+    static size_t PFX##_impl_lower_bound(struct SNAME *_set_, V *values, size_t n, V element)     \
+    {                                                                                             \
+        size_t low = 0;                                                                           \
+        size_t high = n;                                                                          \
+                                                                                                  \
+        while (low < high)                                                                        \
+        {                                                                                         \
+            size_t mid = low + (high - low) / 2;                                                  \
+                                                                                                  \
+            if (PFX##_impl_cmp(_set_, values[mid], element) < 0)                                  \
+                low = mid + 1;                                                                    \
+            else                                                                                  \
+                high = mid;                                                                       \
+        }                                                                                         \
+                                                                                                  \
+        return low;                                                                               \
+    }                                                                                             \
+                                                                                                  \
+    /* Position of the first element that is greater than element, which is also the */           \
+    /* child of a branch that element belongs to */                                               \
+    static size_t PFX##_impl_upper_bound(struct SNAME *_set_, V *values, size_t n, V element)     \
+    {                                                                                             \
+        size_t low = 0;                                                                           \
+        size_t high = n;                                                                          \
+                                                                                                  \
+        while (low < high)                                                                        \
+        {                                                                                         \
+            size_t mid = low + (high - low) / 2;                                                  \
+                                                                                                  \
+            if (PFX##_impl_cmp(_set_, values[mid], element) <= 0)                                 \
+                low = mid + 1;                                                                    \
+            else                                                                                  \
+                high = mid;                                                                       \
+        }                                                                                         \
+                                                                                                  \
+        return low;                                                                               \
+    }                                                                                             \
+                                                                                                  \
+    static struct SNAME##_leaf *PFX##_impl_new_leaf(struct SNAME *_set_)                          \
+    {                                                                                             \
+        struct SNAME##_leaf *leaf = _set_->alloc->malloc(sizeof(struct SNAME##_leaf));            \
+                                                                                                  \
+        if (CMC_UNLIKELY(!leaf))                                                                  \
+            return NULL;                                                                          \
+                                                                                                  \
+        leaf->count = 0;                                                                          \
+        leaf->prev = NULL;                                                                        \
+        leaf->next = NULL;                                                                        \
+                                                                                                  \
+        return leaf;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    static struct SNAME##_leaf *PFX##_impl_first_leaf(struct SNAME *_set_)                        \
+    {                                                                                             \
+        void *node = _set_->root;                                                                 \
+                                                                                                  \
+        for (size_t h = _set_->height; h > 0; h--)                                                \
+            node = ((struct SNAME##_branch *)node)->children[0];                                  \
+                                                                                                  \
+        return node;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    static struct SNAME##_leaf *PFX##_impl_last_leaf(struct SNAME *_set_)                         \
+    {                                                                                             \
+        void *node = _set_->root;                                                                 \
+                                                                                                  \
+        for (size_t h = _set_->height; h > 0; h--)                                                \
+        {                                                                                         \
+            struct SNAME##_branch *branch = node;                                                 \
+                                                                                                  \
+            node = branch->children[branch->count - 1];                                           \
+        }                                                                                         \
+                                                                                                  \
+        return node;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    static V *PFX##_impl_get_element(struct SNAME *_set_, V element)                              \
+    {                                                                                             \
+        if (PFX##_empty(_set_))                                                                   \
+            return NULL;                                                                          \
+                                                                                                  \
+        void *node = _set_->root;                                                                 \
+                                                                                                  \
+        for (size_t h = _set_->height; h > 0; h--)                                                \
+        {                                                                                         \
+            struct SNAME##_branch *branch = node;                                                 \
+                                                                                                  \
+            node = branch->children[PFX##_impl_upper_bound(_set_, branch->values,                 \
+                                                           branch->count - 1, element)];          \
+        }                                                                                         \
+                                                                                                  \
+        struct SNAME##_leaf *leaf = node;                                                         \
+                                                                                                  \
+        size_t i = PFX##_impl_lower_bound(_set_, leaf->values, leaf->count, element);             \
+                                                                                                  \
+        if (i == leaf->count || PFX##_impl_cmp(_set_, leaf->values[i], element) != 0)             \
+            return NULL;                                                                          \
+                                                                                                  \
+        return &(leaf->values[i]);                                                                \
+    }                                                                                             \
+                                                                                                  \
+    /* Walks down the tree once, splitting the full nodes on the way so that */                   \
+    /* the leaf of the element has room for it. If the element is already there it is */          \
+    /* stored in found and NULL is returned */                                                    \
+    static V *PFX##_impl_insert(struct SNAME *_set_, V element, V **found)                        \
+    {                                                                                             \
+        if (!_set_->root)                                                                         \
+        {                                                                                         \
+            _set_->root = PFX##_impl_new_leaf(_set_);                                             \
+                                                                                                  \
+            if (!_set_->root)                                                                     \
+                return NULL;                                                                      \
+        }                                                                                         \
+                                                                                                  \
+        bool full_root = _set_->height == 0                                                       \
+                             ? ((struct SNAME##_leaf *)_set_->root)->count == CMC_BTREE_LEAF_SIZE \
+                             : ((struct SNAME##_branch *)_set_->root)->count ==                   \
+                                   CMC_BTREE_BRANCH_SIZE;                                         \
+                                                                                                  \
+        if (full_root)                                                                            \
+        {                                                                                         \
+            if (_set_->height == 0 && (*found = PFX##_impl_get_element(_set_, element)) != NULL)  \
+                return NULL;                                                                      \
+                                                                                                  \
+            struct SNAME##_branch *root = _set_->alloc->malloc(sizeof(struct SNAME##_branch));    \
+                                                                                                  \
+            if (CMC_UNLIKELY(!root))                                                              \
+                return NULL;                                                                      \
+                                                                                                  \
+            root->children[0] = _set_->root;                                                      \
+            root->count = 1;                                                                      \
+                                                                                                  \
+            if (!PFX##_impl_split_child(_set_, root, 0, _set_->height, element))                  \
+            {                                                                                     \
+                _set_->alloc->free(root);                                                         \
+                return NULL;                                                                      \
+            }                                                                                     \
+                                                                                                  \
+            _set_->root = root;                                                                   \
+            _set_->height++;                                                                      \
+        }                                                                                         \
+                                                                                                  \
+        void *node = _set_->root;                                                                 \
+                                                                                                  \
+        for (size_t h = _set_->height; h > 0; h--)                                                \
+        {                                                                                         \
+            struct SNAME##_branch *branch = node;                                                 \
+                                                                                                  \
+            size_t i = PFX##_impl_upper_bound(_set_, branch->values, branch->count - 1, element); \
+                                                                                                  \
+            bool full = h == 1                                                                    \
+                            ? ((struct SNAME##_leaf *)branch->children[i])->count ==              \
+                                  CMC_BTREE_LEAF_SIZE                                             \
+                            : ((struct SNAME##_branch *)branch->children[i])->count ==            \
+                                  CMC_BTREE_BRANCH_SIZE;                                          \
+                                                                                                  \
+            if (full)                                                                             \
+            {                                                                                     \
+                if (h == 1)                                                                       \
+                {                                                                                 \
+                    struct SNAME##_leaf *leaf = branch->children[i];                              \
+                                                                                                  \
+                    size_t j = PFX##_impl_lower_bound(_set_, leaf->values, leaf->count, element); \
+                                                                                                  \
+                    if (j < leaf->count && PFX##_impl_cmp(_set_, leaf->values[j], element) == 0)  \
+                    {                                                                             \
+                        *found = &(leaf->values[j]);                                              \
+                        return NULL;                                                              \
+                    }                                                                             \
+                }                                                                                 \
+                                                                                                  \
+                if (!PFX##_impl_split_child(_set_, branch, i, h - 1, element))                    \
+                    return NULL;                                                                  \
+                                                                                                  \
+                /* The element might belong to the new node */                                    \
+                if (PFX##_impl_cmp(_set_, branch->values[i], element) <= 0)                       \
+                    i++;                                                                          \
+            }                                                                                     \
+                                                                                                  \
+            node = branch->children[i];                                                           \
+        }                                                                                         \
+                                                                                                  \
+        struct SNAME##_leaf *leaf = node;                                                         \
+                                                                                                  \
+        size_t i = PFX##_impl_lower_bound(_set_, leaf->values, leaf->count, element);             \
+                                                                                                  \
+        if (i < leaf->count && PFX##_impl_cmp(_set_, leaf->values[i], element) == 0)              \
+        {                                                                                         \
+            *found = &(leaf->values[i]);                                                          \
+            return NULL;                                                                          \
+        }                                                                                         \
+                                                                                                  \
+        memmove(leaf->values + i + 1, leaf->values + i, sizeof(V) * (leaf->count - i));           \
+                                                                                                  \
+        leaf->values[i] = element;                                                                \
+        leaf->count++;                                                                            \
+                                                                                                  \
+        _set_->count++;                                                                           \
+                                                                                                  \
+        return &(leaf->values[i]);                                                                \
+    }                                                                                             \
+                                                                                                  \
+    /* Splits the full child at index of parent, which is not full, in two. */                    \
+    /* element is the one being inserted, a leaf at the end of the set that it */                 \
+    /* goes past the end of keeps all of its values */                                            \
+    static bool PFX##_impl_split_child(struct SNAME *_set_, struct SNAME##_branch *parent,        \
+                                       size_t index, size_t height, V element)                    \
+    {                                                                                             \
+        void *right_node;                                                                         \
+        V separator;                                                                              \
+                                                                                                  \
+        if (height == 0)                                                                          \
+        {                                                                                         \
+            struct SNAME##_leaf *left = parent->children[index];                                  \
+            struct SNAME##_leaf *right = PFX##_impl_new_leaf(_set_);                              \
+                                                                                                  \
+            if (!right)                                                                           \
+                return false;                                                                     \
+                                                                                                  \
+            size_t half = CMC_BTREE_LEAF_SIZE / 2;                                                \
+                                                                                                  \
+            if (!left->next &&                                                                    \
+                PFX##_impl_cmp(_set_, left->values[CMC_BTREE_LEAF_SIZE - 1], element) < 0)        \
+                half = CMC_BTREE_LEAF_SIZE;                                                       \
+                                                                                                  \
+            right->count = CMC_BTREE_LEAF_SIZE - half;                                            \
+                                                                                                  \
+            memcpy(right->values, left->values + half, sizeof(V) * right->count);                 \
+                                                                                                  \
+            left->count = half;                                                                   \
+                                                                                                  \
+            right->prev = left;                                                                   \
+            right->next = left->next;                                                             \
+                                                                                                  \
+            if (left->next)                                                                       \
+                left->next->prev = right;                                                         \
+                                                                                                  \
+            left->next = right;                                                                   \
+                                                                                                  \
+            /* An empty leaf is only left for element, which will be its smallest */              \
+            separator = right->count == 0 ? element : right->values[0];                           \
+            right_node = right;                                                                   \
+        }                                                                                         \
+        else                                                                                      \
+        {                                                                                         \
+            struct SNAME##_branch *left = parent->children[index];                                \
+            struct SNAME##_branch *right = _set_->alloc->malloc(sizeof(struct SNAME##_branch));   \
+                                                                                                  \
+            if (CMC_UNLIKELY(!right))                                                             \
+                return false;                                                                     \
+                                                                                                  \
+            size_t half = CMC_BTREE_BRANCH_SIZE / 2;                                              \
+                                                                                                  \
+            right->count = CMC_BTREE_BRANCH_SIZE - half;                                          \
+                                                                                                  \
+            memcpy(right->values, left->values + half, sizeof(V) * (right->count - 1));           \
+            memcpy(right->children, left->children + half, sizeof(void *) * right->count);        \
+                                                                                                  \
+            left->count = half;                                                                   \
+                                                                                                  \
+            separator = left->values[half - 1];                                                   \
+            right_node = right;                                                                   \
+        }                                                                                         \
+                                                                                                  \
+        size_t moved = parent->count - 1 - index;                                                 \
+                                                                                                  \
+        memmove(parent->values + index + 1, parent->values + index, sizeof(V) * moved);           \
+        memmove(parent->children + index + 2, parent->children + index + 1,                       \
+                sizeof(void *) * moved);                                                          \
+                                                                                                  \
+        parent->values[index] = separator;                                                        \
+        parent->children[index + 1] = right_node;                                                 \
+        parent->count++;                                                                          \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Removes element from the subtree of node and fixes the children that were */               \
+    /* left with less than half of their values on the way back up */                             \
+    static bool PFX##_impl_remove(struct SNAME *_set_, void *node, size_t height, V element)      \
+    {                                                                                             \
+        if (height == 0)                                                                          \
+        {                                                                                         \
+            struct SNAME##_leaf *leaf = node;                                                     \
+                                                                                                  \
+            size_t i = PFX##_impl_lower_bound(_set_, leaf->values, leaf->count, element);         \
+                                                                                                  \
+            if (i == leaf->count || PFX##_impl_cmp(_set_, leaf->values[i], element) != 0)         \
+                return false;                                                                     \
+                                                                                                  \
+            leaf->count--;                                                                        \
+                                                                                                  \
+            memmove(leaf->values + i, leaf->values + i + 1, sizeof(V) * (leaf->count - i));       \
+                                                                                                  \
+            return true;                                                                          \
+        }                                                                                         \
+                                                                                                  \
+        struct SNAME##_branch *branch = node;                                                     \
+                                                                                                  \
+        size_t i = PFX##_impl_upper_bound(_set_, branch->values, branch->count - 1, element);     \
+                                                                                                  \
+        if (!PFX##_impl_remove(_set_, branch->children[i], height - 1, element))                  \
+            return false;                                                                         \
+                                                                                                  \
+        PFX##_impl_fix_child(_set_, branch, i, height - 1);                                       \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Gives a child that is less than half full a element from a sibling that */                 \
+    /* can spare one or merges it with a sibling */                                               \
+    static void PFX##_impl_fix_child(struct SNAME *_set_, struct SNAME##_branch *parent,          \
+                                     size_t index, size_t height)                                 \
+    {                                                                                             \
+        size_t minimum = height == 0 ? CMC_BTREE_LEAF_SIZE / 2 : CMC_BTREE_BRANCH_SIZE / 2;       \
+                                                                                                  \
+        size_t counts[3] = { 0, 0, 0 };                                                           \
+                                                                                                  \
+        for (size_t k = 0; k < 3; k++)                                                            \
+        {                                                                                         \
+            if (index + k < 1 || index + k - 1 >= parent->count)                                  \
+                continue;                                                                         \
+                                                                                                  \
+            void *child = parent->children[index + k - 1];                                        \
+                                                                                                  \
+            counts[k] = height == 0 ? ((struct SNAME##_leaf *)child)->count                       \
+                                    : ((struct SNAME##_branch *)child)->count;                    \
+        }                                                                                         \
+                                                                                                  \
+        if (counts[1] >= minimum)                                                                 \
+            return;                                                                               \
+                                                                                                  \
+        if (height == 0)                                                                          \
+        {                                                                                         \
+            struct SNAME##_leaf *leaf = parent->children[index];                                  \
+                                                                                                  \
+            if (counts[0] > minimum)                                                              \
+            {                                                                                     \
+                struct SNAME##_leaf *left = parent->children[index - 1];                          \
+                                                                                                  \
+                memmove(leaf->values + 1, leaf->values, sizeof(V) * leaf->count);                 \
+                                                                                                  \
+                left->count--;                                                                    \
+                                                                                                  \
+                leaf->values[0] = left->values[left->count];                                      \
+                leaf->count++;                                                                    \
+                                                                                                  \
+                parent->values[index - 1] = leaf->values[0];                                      \
+                                                                                                  \
+                return;                                                                           \
+            }                                                                                     \
+                                                                                                  \
+            if (counts[2] > minimum)                                                              \
+            {                                                                                     \
+                struct SNAME##_leaf *right = parent->children[index + 1];                         \
+                                                                                                  \
+                leaf->values[leaf->count] = right->values[0];                                     \
+                leaf->count++;                                                                    \
+                                                                                                  \
+                right->count--;                                                                   \
+                                                                                                  \
+                memmove(right->values, right->values + 1, sizeof(V) * right->count);              \
+                                                                                                  \
+                parent->values[index] = right->values[0];                                         \
+                                                                                                  \
+                return;                                                                           \
+            }                                                                                     \
+        }                                                                                         \
+        else                                                                                      \
+        {                                                                                         \
+            struct SNAME##_branch *branch = parent->children[index];                              \
+                                                                                                  \
+            if (counts[0] > minimum)                                                              \
+            {                                                                                     \
+                struct SNAME##_branch *left = parent->children[index - 1];                        \
+                                                                                                  \
+                memmove(branch->values + 1, branch->values, sizeof(V) * (branch->count - 1));     \
+                memmove(branch->children + 1, branch->children, sizeof(void *) * branch->count);  \
+                                                                                                  \
+                branch->values[0] = parent->values[index - 1];                                    \
+                branch->children[0] = left->children[left->count - 1];                            \
+                branch->count++;                                                                  \
+                                                                                                  \
+                parent->values[index - 1] = left->values[left->count - 2];                        \
+                                                                                                  \
+                left->count--;                                                                    \
+                                                                                                  \
+                return;                                                                           \
+            }                                                                                     \
+                                                                                                  \
+            if (counts[2] > minimum)                                                              \
+            {                                                                                     \
+                struct SNAME##_branch *right = parent->children[index + 1];                       \
+                                                                                                  \
+                branch->values[branch->count - 1] = parent->values[index];                        \
+                branch->children[branch->count] = right->children[0];                             \
+                branch->count++;                                                                  \
+                                                                                                  \
+                parent->values[index] = right->values[0];                                         \
+                                                                                                  \
+                right->count--;                                                                   \
+                                                                                                  \
+                memmove(right->values, right->values + 1, sizeof(V) * (right->count - 1));        \
+                memmove(right->children, right->children + 1, sizeof(void *) * right->count);     \
+                                                                                                  \
+                return;                                                                           \
+            }                                                                                     \
+        }                                                                                         \
+                                                                                                  \
+        /* No sibling can spare a element so both fit in one node */                              \
+        if (counts[0] > 0)                                                                        \
+            PFX##_impl_merge_children(_set_, parent, index - 1, height);                          \
+        else if (counts[2] > 0)                                                                   \
+            PFX##_impl_merge_children(_set_, parent, index, height);                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Moves everything of the child at index + 1 of parent to the one at */                      \
+    /* index and frees it */                                                                      \
+    static void PFX##_impl_merge_children(struct SNAME *_set_, struct SNAME##_branch *parent,     \
+                                          size_t index, size_t height)                            \
+    {                                                                                             \
+        if (height == 0)                                                                          \
+        {                                                                                         \
+            struct SNAME##_leaf *left = parent->children[index];                                  \
+            struct SNAME##_leaf *right = parent->children[index + 1];                             \
+                                                                                                  \
+            memcpy(left->values + left->count, right->values, sizeof(V) * right->count);          \
+                                                                                                  \
+            left->count += right->count;                                                          \
+            left->next = right->next;                                                             \
+                                                                                                  \
+            if (right->next)                                                                      \
+                right->next->prev = left;                                                         \
+                                                                                                  \
+            _set_->alloc->free(right);                                                            \
+        }                                                                                         \
+        else                                                                                      \
+        {                                                                                         \
+            struct SNAME##_branch *left = parent->children[index];                                \
+            struct SNAME##_branch *right = parent->children[index + 1];                           \
+                                                                                                  \
+            left->values[left->count - 1] = parent->values[index];                                \
+                                                                                                  \
+            memcpy(left->values + left->count, right->values, sizeof(V) * (right->count - 1));    \
+            memcpy(left->children + left->count, right->children,                                 \
+                   sizeof(void *) * right->count);                                                \
+                                                                                                  \
+            left->count += right->count;                                                          \
+                                                                                                  \
+            _set_->alloc->free(right);                                                            \
+        }                                                                                         \
+                                                                                                  \
+        size_t moved = parent->count - 2 - index;                                                 \
+                                                                                                  \
+        memmove(parent->values + index, parent->values + index + 1, sizeof(V) * moved);           \
+        memmove(parent->children + index + 1, parent->children + index + 2,                       \
+                sizeof(void *) * moved);                                                          \
+                                                                                                  \
+        parent->count--;                                                                          \
+    }                                                                                             \
+                                                                                                  \
+    static void PFX##_impl_free_node(struct SNAME *_set_, void *node, size_t height,              \
+                                     void (*deallocator)(V))                                      \
+    {                                                                                             \
+        if (height == 0)                                                                          \
+        {                                                                                         \
+            struct SNAME##_leaf *leaf = node;                                                     \
+                                                                                                  \
+            if (deallocator)                                                                      \
+            {                                                                                     \
+                for (size_t i = 0; i < leaf->count; i++)                                          \
+                    deallocator(leaf->values[i]);                                                 \
+            }                                                                                     \
+        }                                                                                         \
+        else                                                                                      \
+        {                                                                                         \
+            struct SNAME##_branch *branch = node;                                                 \
+                                                                                                  \
+            for (size_t i = 0; i < branch->count; i++)                                            \
+                PFX##_impl_free_node(_set_, branch->children[i], height - 1, deallocator);        \
+        }                                                                                         \
+                                                                                                  \
+        _set_->alloc->free(node);                                                                 \
+    }                                                                                             \
+                                                                                                  \
+    static size_t PFX##_impl_node_bytes(void *node, size_t height)                                \
+    {                                                                                             \
+        if (height == 0)                                                                          \
+            return sizeof(struct SNAME##_leaf);                                                   \
+                                                                                                  \
+        struct SNAME##_branch *branch = node;                                                     \
+        size_t bytes = sizeof(struct SNAME##_branch);                                             \
+                                                                                                  \
+        for (size_t i = 0; i < branch->count; i++)                                                \
+            bytes += PFX##_impl_node_bytes(branch->children[i], height - 1);                      \
+                                                                                                  \
+        return bytes;                                                                             \
+    }                                                                                             \
+                                                                                                  \
+    static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_set_)                           \
+    {                                                                                             \
+        struct SNAME##_iter iter;                                                                 \
+                                                                                                  \
+        PFX##_iter_init(&iter, _set_);                                                            \
+        PFX##_iter_to_start(&iter);                                                               \
+                                                                                                  \
+        return iter;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_set_)                             \
+    {                                                                                             \
+        struct SNAME##_iter iter;                                                                 \
+                                                                                                  \
+        PFX##_iter_init(&iter, _set_);                                                            \
+        PFX##_iter_to_end(&iter);                                                                 \
+                                                                                                  \
+        return iter;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    static inline int PFX##_impl_cmp(struct SNAME *_set_, V a, V b)                               \
+    {                                                                                             \
+        (void)_set_;                                                                              \
+                                                                                                  \
+        return CMP(a, b);                                                                         \
+    }
+
+#endif /* CMC_BTREESET_H */
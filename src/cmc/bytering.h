@@ -0,0 +1,459 @@
+/**
+ * bytering.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * ByteRing
+ *
+ * A ByteRing is a circular buffer of bytes of a fixed capacity, meant for the
+ * input and output buffers of sockets and pipes. write and read copy whole
+ * ranges of bytes in at most two copies, and read_fd and write_fd move bytes
+ * between a file descriptor and the buffer with a single readv or writev,
+ * without copying them anywhere else.
+ *
+ * The bytes are in at most two contiguous regions, returned by spans, and so
+ * is the free space, returned by vacant_spans. A parser can look at the
+ * spans and then consume what it used, a producer can fill the vacant spans
+ * and then produce what it wrote. linearize moves the bytes so that they are
+ * a single region when a parser needs one. Requires POSIX.
+ */
+
+#ifndef CMC_BYTERING_H
+#define CMC_BYTERING_H
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_bytering = "%s at %p { buffer:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", head:%" PRIuMAX " }";
+
+#define CMC_GENERATE_BYTERING(PFX, SNAME)    \
+    CMC_GENERATE_BYTERING_HEADER(PFX, SNAME) \
+    CMC_GENERATE_BYTERING_SOURCE(PFX, SNAME)
+
+#define CMC_WRAPGEN_BYTERING_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_BYTERING_HEADER(PFX, SNAME)
+
+#define CMC_WRAPGEN_BYTERING_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_BYTERING_SOURCE(PFX, SNAME)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_BYTERING_HEADER(PFX, SNAME)                                                 \
+    /* ByteRing Structure */                                                                     \
+    struct SNAME                                                                                 \
+    {                                                                                            \
+        /* Circular buffer of bytes */                                                           \
+        unsigned char *buffer;                                                                   \
+                                                                                                 \
+        /* Size of the buffer */                                                                 \
+        size_t capacity;                                                                         \
+                                                                                                 \
+        /* Amount of bytes in the buffer */                                                      \
+        size_t count;                                                                            \
+                                                                                                 \
+        /* Index of the first byte */                                                            \
+        size_t head;                                                                             \
+                                                                                                 \
+        /* Custom allocation functions */                                                        \
+        struct cmc_alloc_node *alloc;                                                            \
+    };                                                                                           \
+                                                                                                 \
+    /* Collection Functions */                                                                   \
+    /* Collection Allocation and Deallocation */                                                 \
+    struct SNAME *PFX##_new(size_t capacity);                                                    \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc);               \
+    void PFX##_clear(struct SNAME *_ring_);                                                      \
+    void PFX##_free(struct SNAME *_ring_);                                                       \
+    /* Collection Input and Output */                                                            \
+    size_t PFX##_write(struct SNAME *_ring_, const void *data, size_t size);                     \
+    size_t PFX##_read(struct SNAME *_ring_, void *data, size_t size);                            \
+    size_t PFX##_peek(struct SNAME *_ring_, void *data, size_t size);                            \
+    bool PFX##_produce(struct SNAME *_ring_, size_t size);                                       \
+    bool PFX##_consume(struct SNAME *_ring_, size_t size);                                       \
+    ssize_t PFX##_read_fd(struct SNAME *_ring_, int fd);                                         \
+    ssize_t PFX##_write_fd(struct SNAME *_ring_, int fd);                                        \
+    /* Element Access */                                                                         \
+    void PFX##_spans(struct SNAME *_ring_, unsigned char **a, size_t *a_size, unsigned char **b, \
+                     size_t *b_size);                                                            \
+    void PFX##_vacant_spans(struct SNAME *_ring_, unsigned char **a, size_t *a_size,             \
+                            unsigned char **b, size_t *b_size);                                  \
+    unsigned char *PFX##_linearize(struct SNAME *_ring_);                                        \
+    size_t PFX##_index_of(struct SNAME *_ring_, unsigned char byte);                             \
+    /* Collection State */                                                                       \
+    bool PFX##_empty(struct SNAME *_ring_);                                                      \
+    bool PFX##_full(struct SNAME *_ring_);                                                       \
+    size_t PFX##_count(struct SNAME *_ring_);                                                    \
+    size_t PFX##_memory_usage(struct SNAME *_ring_);                                             \
+    size_t PFX##_vacant(struct SNAME *_ring_);                                                   \
+    size_t PFX##_capacity(struct SNAME *_ring_);                                                 \
+    /* Collection Utility */                                                                     \
+    bool PFX##_resize(struct SNAME *_ring_, size_t capacity);                                    \
+    struct cmc_string PFX##_to_string(struct SNAME *_ring_);                                     \
+                                                                                                 \
+    /* SOURCE ********************************************************************/
+#define CMC_GENERATE_BYTERING_SOURCE(PFX, SNAME)                                                     \
+    /* Implementation Detail Functions */                                                            \
+    static void PFX##_impl_reverse(unsigned char *bytes, size_t size);                               \
+                                                                                                     \
+    struct SNAME *PFX##_new(size_t capacity)                                                         \
+    {                                                                                                \
+        return PFX##_new_custom(capacity, NULL);                                                     \
+    }                                                                                                \
+                                                                                                     \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc)                    \
+    {                                                                                                \
+        if (!alloc)                                                                                  \
+            alloc = &cmc_alloc_node_default;                                                         \
+                                                                                                     \
+        if (capacity < 1)                                                                            \
+            return NULL;                                                                             \
+                                                                                                     \
+        struct SNAME *_ring_ = alloc->malloc(sizeof(struct SNAME));                                  \
+                                                                                                     \
+        if (CMC_UNLIKELY(!_ring_))                                                                   \
+            return NULL;                                                                             \
+                                                                                                     \
+        _ring_->alloc = alloc;                                                                       \
+                                                                                                     \
+        _ring_->buffer = alloc->malloc(capacity);                                                    \
+                                                                                                     \
+        if (CMC_UNLIKELY(!_ring_->buffer))                                                           \
+        {                                                                                            \
+            alloc->free(_ring_);                                                                     \
+            return NULL;                                                                             \
+        }                                                                                            \
+                                                                                                     \
+        _ring_->capacity = capacity;                                                                 \
+        _ring_->count = 0;                                                                           \
+        _ring_->head = 0;                                                                            \
+                                                                                                     \
+        return _ring_;                                                                               \
+    }                                                                                                \
+                                                                                                     \
+    void PFX##_clear(struct SNAME *_ring_)                                                           \
+    {                                                                                                \
+        _ring_->count = 0;                                                                           \
+        _ring_->head = 0;                                                                            \
+    }                                                                                                \
+                                                                                                     \
+    void PFX##_free(struct SNAME *_ring_)                                                            \
+    {                                                                                                \
+        _ring_->alloc->free(_ring_->buffer);                                                         \
+        _ring_->alloc->free(_ring_);                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    /* Copies as many of the size bytes as there is room for to the end of */                        \
+    /* the buffer. Returns how many were copied */                                                   \
+    size_t PFX##_write(struct SNAME *_ring_, const void *data, size_t size)                          \
+    {                                                                                                \
+        unsigned char *a, *b;                                                                        \
+        size_t a_size, b_size;                                                                       \
+                                                                                                     \
+        PFX##_vacant_spans(_ring_, &a, &a_size, &b, &b_size);                                        \
+                                                                                                     \
+        if (size > a_size + b_size)                                                                  \
+            size = a_size + b_size;                                                                  \
+                                                                                                     \
+        size_t first = size < a_size ? size : a_size;                                                \
+                                                                                                     \
+        memcpy(a, data, first);                                                                      \
+        memcpy(b, (const unsigned char *)data + first, size - first);                                \
+                                                                                                     \
+        _ring_->count += size;                                                                       \
+                                                                                                     \
+        return size;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    /* Copies up to size bytes from the start of the buffer to data and */                           \
+    /* removes them. Returns how many were read */                                                   \
+    size_t PFX##_read(struct SNAME *_ring_, void *data, size_t size)                                 \
+    {                                                                                                \
+        size = PFX##_peek(_ring_, data, size);                                                       \
+                                                                                                     \
+        PFX##_consume(_ring_, size);                                                                 \
+                                                                                                     \
+        return size;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    /* Same as read but the bytes are kept */                                                        \
+    size_t PFX##_peek(struct SNAME *_ring_, void *data, size_t size)                                 \
+    {                                                                                                \
+        unsigned char *a, *b;                                                                        \
+        size_t a_size, b_size;                                                                       \
+                                                                                                     \
+        PFX##_spans(_ring_, &a, &a_size, &b, &b_size);                                               \
+                                                                                                     \
+        if (size > a_size + b_size)                                                                  \
+            size = a_size + b_size;                                                                  \
+                                                                                                     \
+        size_t first = size < a_size ? size : a_size;                                                \
+                                                                                                     \
+        memcpy(data, a, first);                                                                      \
+        memcpy((unsigned char *)data + first, b, size - first);                                      \
+                                                                                                     \
+        return size;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    /* Adds size bytes already written to the vacant spans to the end */                             \
+    bool PFX##_produce(struct SNAME *_ring_, size_t size)                                            \
+    {                                                                                                \
+        if (size > PFX##_vacant(_ring_))                                                             \
+            return false;                                                                            \
+                                                                                                     \
+        _ring_->count += size;                                                                       \
+                                                                                                     \
+        return true;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    /* Removes size bytes from the start */                                                          \
+    bool PFX##_consume(struct SNAME *_ring_, size_t size)                                            \
+    {                                                                                                \
+        if (size > _ring_->count)                                                                    \
+            return false;                                                                            \
+                                                                                                     \
+        _ring_->head += size;                                                                        \
+                                                                                                     \
+        if (_ring_->head >= _ring_->capacity)                                                        \
+            _ring_->head -= _ring_->capacity;                                                        \
+                                                                                                     \
+        _ring_->count -= size;                                                                       \
+                                                                                                     \
+        /* An empty buffer starts over so the next bytes are contiguous */                           \
+        if (_ring_->count == 0)                                                                      \
+            _ring_->head = 0;                                                                        \
+                                                                                                     \
+        return true;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    /* Reads from fd into the vacant spans with a single readv. Returns what */                      \
+    /* readv returned, 0 at the end of the file, or -1 with errno set to */                          \
+    /* ENOBUFS if the buffer is full */                                                              \
+    ssize_t PFX##_read_fd(struct SNAME *_ring_, int fd)                                              \
+    {                                                                                                \
+        struct iovec iov[2];                                                                         \
+        unsigned char *a, *b;                                                                        \
+        size_t a_size, b_size;                                                                       \
+                                                                                                     \
+        if (PFX##_full(_ring_))                                                                      \
+        {                                                                                            \
+            errno = ENOBUFS;                                                                         \
+            return -1;                                                                               \
+        }                                                                                            \
+                                                                                                     \
+        PFX##_vacant_spans(_ring_, &a, &a_size, &b, &b_size);                                        \
+                                                                                                     \
+        iov[0].iov_base = a;                                                                         \
+        iov[0].iov_len = a_size;                                                                     \
+        iov[1].iov_base = b;                                                                         \
+        iov[1].iov_len = b_size;                                                                     \
+                                                                                                     \
+        ssize_t result = readv(fd, iov, b_size > 0 ? 2 : 1);                                         \
+                                                                                                     \
+        if (result > 0)                                                                              \
+            _ring_->count += (size_t)result;                                                         \
+                                                                                                     \
+        return result;                                                                               \
+    }                                                                                                \
+                                                                                                     \
+    /* Writes the bytes to fd with a single writev and removes the ones that */                      \
+    /* were written. Returns what writev returned, or 0 if the buffer is empty */                    \
+    ssize_t PFX##_write_fd(struct SNAME *_ring_, int fd)                                             \
+    {                                                                                                \
+        struct iovec iov[2];                                                                         \
+        unsigned char *a, *b;                                                                        \
+        size_t a_size, b_size;                                                                       \
+                                                                                                     \
+        if (PFX##_empty(_ring_))                                                                     \
+            return 0;                                                                                \
+                                                                                                     \
+        PFX##_spans(_ring_, &a, &a_size, &b, &b_size);                                               \
+                                                                                                     \
+        iov[0].iov_base = a;                                                                         \
+        iov[0].iov_len = a_size;                                                                     \
+        iov[1].iov_base = b;                                                                         \
+        iov[1].iov_len = b_size;                                                                     \
+                                                                                                     \
+        ssize_t result = writev(fd, iov, b_size > 0 ? 2 : 1);                                        \
+                                                                                                     \
+        if (result > 0)                                                                              \
+            PFX##_consume(_ring_, (size_t)result);                                                   \
+                                                                                                     \
+        return result;                                                                               \
+    }                                                                                                \
+                                                                                                     \
+    /* The bytes from the start are the a_size bytes at a followed by the */                         \
+    /* b_size bytes at b. The second span is empty unless the bytes wrap */                          \
+    /* around the end of the buffer */                                                               \
+    void PFX##_spans(struct SNAME *_ring_, unsigned char **a, size_t *a_size, unsigned char **b,     \
+                     size_t *b_size)                                                                 \
+    {                                                                                                \
+        size_t first = _ring_->capacity - _ring_->head;                                              \
+                                                                                                     \
+        if (first > _ring_->count)                                                                   \
+            first = _ring_->count;                                                                   \
+                                                                                                     \
+        *a = _ring_->buffer + _ring_->head;                                                          \
+        *a_size = first;                                                                             \
+        *b = _ring_->buffer;                                                                         \
+        *b_size = _ring_->count - first;                                                             \
+    }                                                                                                \
+                                                                                                     \
+    /* Same as spans but for the free space after the last byte */                                   \
+    void PFX##_vacant_spans(struct SNAME *_ring_, unsigned char **a, size_t *a_size,                 \
+                            unsigned char **b, size_t *b_size)                                       \
+    {                                                                                                \
+        size_t tail = _ring_->head + _ring_->count;                                                  \
+                                                                                                     \
+        if (tail >= _ring_->capacity)                                                                \
+        {                                                                                            \
+            /* The bytes wrap around, the free space is between them */                              \
+            tail -= _ring_->capacity;                                                                \
+                                                                                                     \
+            *a = _ring_->buffer + tail;                                                              \
+            *a_size = _ring_->head - tail;                                                           \
+            *b = _ring_->buffer;                                                                     \
+            *b_size = 0;                                                                             \
+        }                                                                                            \
+        else                                                                                         \
+        {                                                                                            \
+            *a = _ring_->buffer + tail;                                                              \
+            *a_size = _ring_->capacity - tail;                                                       \
+            *b = _ring_->buffer;                                                                     \
+            *b_size = _ring_->head;                                                                  \
+        }                                                                                            \
+    }                                                                                                \
+                                                                                                     \
+    /* Moves the bytes so that they are contiguous, if they wrap around, and */                      \
+    /* returns a pointer to the first one */                                                         \
+    unsigned char *PFX##_linearize(struct SNAME *_ring_)                                             \
+    {                                                                                                \
+        if (_ring_->head + _ring_->count > _ring_->capacity)                                         \
+        {                                                                                            \
+            /* Rotates the buffer so that head becomes the start */                                  \
+            PFX##_impl_reverse(_ring_->buffer, _ring_->head);                                        \
+            PFX##_impl_reverse(_ring_->buffer + _ring_->head, _ring_->capacity - _ring_->head);      \
+            PFX##_impl_reverse(_ring_->buffer, _ring_->capacity);                                    \
+                                                                                                     \
+            _ring_->head = 0;                                                                        \
+        }                                                                                            \
+                                                                                                     \
+        return _ring_->buffer + _ring_->head;                                                        \
+    }                                                                                                \
+                                                                                                     \
+    /* Position of the first byte equal to byte from the start, or count if */                       \
+    /* there is none */                                                                              \
+    size_t PFX##_index_of(struct SNAME *_ring_, unsigned char byte)                                  \
+    {                                                                                                \
+        unsigned char *a, *b;                                                                        \
+        size_t a_size, b_size;                                                                       \
+                                                                                                     \
+        PFX##_spans(_ring_, &a, &a_size, &b, &b_size);                                               \
+                                                                                                     \
+        unsigned char *found = memchr(a, byte, a_size);                                              \
+                                                                                                     \
+        if (found)                                                                                   \
+            return (size_t)(found - a);                                                              \
+                                                                                                     \
+        found = memchr(b, byte, b_size);                                                             \
+                                                                                                     \
+        if (found)                                                                                   \
+            return a_size + (size_t)(found - b);                                                     \
+                                                                                                     \
+        return _ring_->count;                                                                        \
+    }                                                                                                \
+                                                                                                     \
+    bool PFX##_empty(struct SNAME *_ring_)                                                           \
+    {                                                                                                \
+        return _ring_->count == 0;                                                                   \
+    }                                                                                                \
+                                                                                                     \
+    bool PFX##_full(struct SNAME *_ring_)                                                            \
+    {                                                                                                \
+        return _ring_->count >= _ring_->capacity;                                                    \
+    }                                                                                                \
+                                                                                                     \
+    size_t PFX##_count(struct SNAME *_ring_)                                                         \
+    {                                                                                                \
+        return _ring_->count;                                                                        \
+    }                                                                                                \
+                                                                                                     \
+    size_t PFX##_memory_usage(struct SNAME *_ring_)                                                  \
+    {                                                                                                \
+        return sizeof(struct SNAME) + _ring_->capacity;                                              \
+    }                                                                                                \
+                                                                                                     \
+    size_t PFX##_vacant(struct SNAME *_ring_)                                                        \
+    {                                                                                                \
+        return _ring_->capacity - _ring_->count;                                                     \
+    }                                                                                                \
+                                                                                                     \
+    size_t PFX##_capacity(struct SNAME *_ring_)                                                      \
+    {                                                                                                \
+        return _ring_->capacity;                                                                     \
+    }                                                                                                \
+                                                                                                     \
+    /* Fails if the bytes would not fit */                                                           \
+    bool PFX##_resize(struct SNAME *_ring_, size_t capacity)                                         \
+    {                                                                                                \
+        if (capacity < 1 || capacity < _ring_->count)                                                \
+            return false;                                                                            \
+                                                                                                     \
+        if (capacity == _ring_->capacity)                                                            \
+            return true;                                                                             \
+                                                                                                     \
+        unsigned char *buffer = _ring_->alloc->malloc(capacity);                                     \
+                                                                                                     \
+        if (CMC_UNLIKELY(!buffer))                                                                   \
+            return false;                                                                            \
+                                                                                                     \
+        size_t count = PFX##_peek(_ring_, buffer, _ring_->count);                                    \
+                                                                                                     \
+        _ring_->alloc->free(_ring_->buffer);                                                         \
+                                                                                                     \
+        _ring_->buffer = buffer;                                                                     \
+        _ring_->capacity = capacity;                                                                 \
+        _ring_->count = count;                                                                       \
+        _ring_->head = 0;                                                                            \
+                                                                                                     \
+        return true;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    struct cmc_string PFX##_to_string(struct SNAME *_ring_)                                          \
+    {                                                                                                \
+        struct cmc_string str;                                                                       \
+        struct SNAME *r_ = _ring_;                                                                   \
+        const char *name = #SNAME;                                                                   \
+                                                                                                     \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_bytering, name, r_, r_->buffer, r_->capacity, \
+                 r_->count, r_->head);                                                               \
+                                                                                                     \
+        return str;                                                                                  \
+    }                                                                                                \
+                                                                                                     \
+    static void PFX##_impl_reverse(unsigned char *bytes, size_t size)                                \
+    {                                                                                                \
+        for (size_t i = 0, j = size; i + 1 < j; i++, j--)                                            \
+        {                                                                                            \
+            unsigned char tmp = bytes[i];                                                            \
+            bytes[i] = bytes[j - 1];                                                                 \
+            bytes[j - 1] = tmp;                                                                      \
+        }                                                                                            \
+    }
+
+#endif /* CMC_BYTERING_H */
@@ -0,0 +1,773 @@
+/**
+ * compacttreeset.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * CompactTreeSet
+ *
+ * A CompactTreeSet is a TreeSet that takes a lot less memory for small
+ * elements. Like a Set it has only unique keys.
+ *
+ * Implementation
+ *
+ * This implementation uses an AVL Tree like the TreeSet, but its nodes are
+ * kept next to each other in a single array and link to each other with 32
+ * bit indices instead of pointers. Index 0 is never used, so it stands for
+ * no node. The parent of a node and its height share the same 32 bits, 26 for
+ * the parent and 6 for the height, so a node of an int takes 16 bytes instead
+ * of the 40 bytes of a TreeSet node, and a set has at most
+ * CMC_COMPACT_TREE_MAX elements.
+ *
+ * Removing an element moves the last node of the array to its place, so the
+ * nodes are always at the start of the array. The array only grows, until
+ * free is called.
+ */
+
+#ifndef CMC_COMPACTTREESET_H
+#define CMC_COMPACTTREESET_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* Maximum amount of elements of a set, the largest index of a parent */
+#define CMC_COMPACT_TREE_MAX ((UINT32_C(1) << 26) - 1)
+
+/* to_string format */
+static const char *cmc_string_fmt_compacttreeset = "%s at %p { nodes:%p, capacity:%" PRIuMAX ", root:%" PRIu32 ", count:%" PRIuMAX ", cmp:%p }";
+
+#define CMC_GENERATE_COMPACT_TREESET(PFX, SNAME, V)    \
+    CMC_GENERATE_COMPACT_TREESET_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_COMPACT_TREESET_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_COMPACT_TREESET_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_COMPACT_TREESET_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_COMPACT_TREESET_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_COMPACT_TREESET_SOURCE(PFX, SNAME, V)
+
+/* Same as CMC_GENERATE_COMPACT_TREESET but elements are compared by calling */
+/* CMP directly, so the compiler can inline it. The function given to new is */
+/* still stored but only used by to_string */
+#define CMC_GENERATE_COMPACT_TREESET_EX(PFX, SNAME, V, CMP) \
+    CMC_GENERATE_COMPACT_TREESET_HEADER(PFX, SNAME, V)      \
+    CMC_GENERATE_COMPACT_TREESET_EX_SOURCE(PFX, SNAME, V, CMP)
+
+#define CMC_GENERATE_COMPACT_TREESET_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_COMPACT_TREESET_SOURCE(PFX, SNAME, V, _set_->cmp)
+
+#define CMC_GENERATE_COMPACT_TREESET_EX_SOURCE(PFX, SNAME, V, CMP) \
+    CMC_IMPL_COMPACT_TREESET_SOURCE(PFX, SNAME, V, CMP)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_COMPACT_TREESET_HEADER(PFX, SNAME, V)                      \
+                                                                                \
+    /* CompactTreeSet Structure */                                              \
+    struct SNAME                                                                \
+    {                                                                           \
+        /* Nodes from index 1 to count, or NULL if nothing was inserted yet */  \
+        struct SNAME##_node *nodes;                                             \
+                                                                                \
+        /* Amount of nodes that fit in the array, index 0 included */           \
+        size_t capacity;                                                        \
+                                                                                \
+        /* Current amount of elements */                                        \
+        size_t count;                                                           \
+                                                                                \
+        /* Index of the root node, or 0 if the set is empty */                  \
+        uint32_t root;                                                          \
+                                                                                \
+        /* Element comparison function */                                       \
+        int (*cmp)(V, V);                                                       \
+                                                                                \
+        /* Custom allocation functions */                                       \
+        struct cmc_alloc_node *alloc;                                           \
+    };                                                                          \
+                                                                                \
+    /* CompactTreeSet Node */                                                   \
+    struct SNAME##_node                                                         \
+    {                                                                           \
+        /* Node element */                                                      \
+        V value;                                                                \
+                                                                                \
+        /* Index of the left child node or 0 */                                 \
+        uint32_t left;                                                          \
+                                                                                \
+        /* Index of the right child node or 0 */                                \
+        uint32_t right;                                                         \
+                                                                                \
+        /* Index of the parent node or 0 in the upper 26 bits and the height */ \
+        /* of the node in the lower 6 */                                        \
+        uint32_t link;                                                          \
+    };                                                                          \
+                                                                                \
+    /* CompactTreeSet Iterator */                                               \
+    struct SNAME##_iter                                                         \
+    {                                                                           \
+        /* Target compacttreeset */                                             \
+        struct SNAME *target;                                                   \
+                                                                                \
+        /* Index of the cursor's current node */                                \
+        uint32_t cursor;                                                        \
+                                                                                \
+        /* Index of the first node in the iteration */                          \
+        uint32_t first;                                                         \
+                                                                                \
+        /* Index of the last node in the iteration */                           \
+        uint32_t last;                                                          \
+                                                                                \
+        /* Keeps track of relative index to the iteration of elements */        \
+        size_t index;                                                           \
+                                                                                \
+        /* If the iterator has reached the start of the iteration */            \
+        bool start;                                                             \
+                                                                                \
+        /* If the iterator has reached the end of the iteration */              \
+        bool end;                                                               \
+    };                                                                          \
+                                                                                \
+    /* Collection Functions */                                                  \
+    /* Collection Allocation and Deallocation */                                \
+    struct SNAME *PFX##_new(int (*compare)(V, V));                              \
+    struct SNAME *PFX##_new_custom(int (*compare)(V, V),                        \
+                                   struct cmc_alloc_node *alloc);               \
+    void PFX##_clear(struct SNAME *_set_, void (*deallocator)(V));              \
+    void PFX##_free(struct SNAME *_set_, void (*deallocator)(V));               \
+    /* Collection Input and Output */                                           \
+    bool PFX##_insert(struct SNAME *_set_, V element);                          \
+    bool PFX##_remove(struct SNAME *_set_, V element);                          \
+    /* Element Access */                                                        \
+    bool PFX##_max(struct SNAME *_set_, V *value);                              \
+    bool PFX##_min(struct SNAME *_set_, V *value);                              \
+    bool PFX##_floor(struct SNAME *_set_, V element, V *value);                 \
+    bool PFX##_ceiling(struct SNAME *_set_, V element, V *value);               \
+    /* Collection State */                                                      \
+    bool PFX##_contains(struct SNAME *_set_, V element);                        \
+    CMC_PURE bool PFX##_empty(struct SNAME *_set_);                             \
+    CMC_PURE size_t PFX##_count(struct SNAME *_set_);                           \
+    size_t PFX##_memory_usage(struct SNAME *_set_);                             \
+    /* Collection Utility */                                                    \
+    struct cmc_string PFX##_to_string(struct SNAME *_set_);                     \
+    bool PFX##_to_string_full(struct SNAME *_set_,                              \
+                              struct cmc_string_builder *builder,               \
+                              const char *elem_fmt);                            \
+    bool PFX##_write(struct SNAME *_set_, FILE *file,                           \
+                     void (*fmt)(FILE *, V));                                   \
+    bool PFX##_write_fd(struct SNAME *_set_, int fd,                            \
+                        void (*fmt)(struct cmc_dump *, V));                     \
+                                                                                \
+    /* Iterator Functions */                                                    \
+    /* Iterator Initialization */                                               \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);      \
+    /* Iterator State */                                                        \
+    bool PFX##_iter_start(struct SNAME##_iter *iter);                           \
+    bool PFX##_iter_end(struct SNAME##_iter *iter);                             \
+    /* Iterator Movement */                                                     \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter);                        \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter);                          \
+    bool PFX##_iter_next(struct SNAME##_iter *iter);                            \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter);                            \
+    /* Iterator Access */                                                       \
+    V PFX##_iter_value(struct SNAME##_iter *iter);                              \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter);                         \
+                                                                                \
+/* SOURCE ********************************************************************/
+#define CMC_IMPL_COMPACT_TREESET_SOURCE(PFX, SNAME, V, CMP)                                    \
+                                                                                               \
+    /* Implementation Detail Functions */                                                      \
+    static inline int PFX##_impl_cmp(struct SNAME *_set_, V a, V b);                           \
+    static uint32_t PFX##_impl_get_node(struct SNAME *_set_, V element);                       \
+    static uint32_t PFX##_impl_bound_node(struct SNAME *_set_, V element, bool floor);         \
+    static uint32_t PFX##_impl_first(struct SNAME *_set_, uint32_t node);                      \
+    static uint32_t PFX##_impl_last(struct SNAME *_set_, uint32_t node);                       \
+    static uint32_t PFX##_impl_parent(struct SNAME *_set_, uint32_t node);                     \
+    static void PFX##_impl_set_parent(struct SNAME *_set_, uint32_t node, uint32_t parent);    \
+    static void PFX##_impl_replace_child(struct SNAME *_set_, uint32_t parent, uint32_t child, \
+                                         uint32_t other);                                      \
+    static unsigned PFX##_impl_h(struct SNAME *_set_, uint32_t node);                          \
+    static void PFX##_impl_hupdate(struct SNAME *_set_, uint32_t node);                        \
+    static void PFX##_impl_rotate_right(struct SNAME *_set_, uint32_t node);                   \
+    static void PFX##_impl_rotate_left(struct SNAME *_set_, uint32_t node);                    \
+    static void PFX##_impl_rebalance(struct SNAME *_set_, uint32_t node);                      \
+                                                                                               \
+    struct SNAME *PFX##_new(int (*compare)(V, V))                                              \
+    {                                                                                          \
+        return PFX##_new_custom(compare, NULL);                                                \
+    }                                                                                          \
+                                                                                               \
+    struct SNAME *PFX##_new_custom(int (*compare)(V, V), struct cmc_alloc_node *alloc)         \
+    {                                                                                          \
+        if (!alloc)                                                                            \
+            alloc = &cmc_alloc_node_default;                                                   \
+                                                                                               \
+        struct SNAME *_set_ = alloc->malloc(sizeof(struct SNAME));                             \
+                                                                                               \
+        if (CMC_UNLIKELY(!_set_))                                                              \
+            return NULL;                                                                       \
+                                                                                               \
+        _set_->alloc = alloc;                                                                  \
+                                                                                               \
+        _set_->nodes = NULL;                                                                   \
+        _set_->capacity = 0;                                                                   \
+        _set_->count = 0;                                                                      \
+        _set_->root = 0;                                                                       \
+        _set_->cmp = compare;                                                                  \
+                                                                                               \
+        return _set_;                                                                          \
+    }                                                                                          \
+                                                                                               \
+    /* The nodes are all at the start of the array, so the tree is not walked */               \
+    void PFX##_clear(struct SNAME *_set_, void (*deallocator)(V))                              \
+    {                                                                                          \
+        if (deallocator)                                                                       \
+        {                                                                                      \
+            for (size_t i = 1; i <= _set_->count; i++)                                         \
+                deallocator(_set_->nodes[i].value);                                            \
+        }                                                                                      \
+                                                                                               \
+        _set_->count = 0;                                                                      \
+        _set_->root = 0;                                                                       \
+    }                                                                                          \
+                                                                                               \
+    void PFX##_free(struct SNAME *_set_, void (*deallocator)(V))                               \
+    {                                                                                          \
+        PFX##_clear(_set_, deallocator);                                                       \
+                                                                                               \
+        _set_->alloc->free(_set_->nodes);                                                      \
+        _set_->alloc->free(_set_);                                                             \
+    }                                                                                          \
+                                                                                               \
+    bool PFX##_insert(struct SNAME *_set_, V element)                                          \
+    {                                                                                          \
+        uint32_t scan = _set_->root;                                                           \
+        uint32_t parent = 0;                                                                   \
+                                                                                               \
+        int c = 0;                                                                             \
+                                                                                               \
+        while (scan != 0)                                                                      \
+        {                                                                                      \
+            parent = scan;                                                                     \
+            c = PFX##_impl_cmp(_set_, _set_->nodes[scan].value, element);                      \
+                                                                                               \
+            if (c > 0)                                                                         \
+                scan = _set_->nodes[scan].left;                                                \
+            else if (c < 0)                                                                    \
+                scan = _set_->nodes[scan].right;                                               \
+            else                                                                               \
+                return false;                                                                  \
+        }                                                                                      \
+                                                                                               \
+        if (_set_->count == CMC_COMPACT_TREE_MAX)                                              \
+            return false;                                                                      \
+                                                                                               \
+        if (_set_->count + 1 >= _set_->capacity)                                               \
+        {                                                                                      \
+            size_t capacity = _set_->capacity == 0 ? 8 : _set_->capacity * 2;                  \
+                                                                                               \
+            struct SNAME##_node *nodes =                                                       \
+                _set_->alloc->realloc(_set_->nodes, sizeof(struct SNAME##_node) * capacity);   \
+                                                                                               \
+            if (!nodes)                                                                        \
+                return false;                                                                  \
+                                                                                               \
+            _set_->nodes = nodes;                                                              \
+            _set_->capacity = capacity;                                                        \
+        }                                                                                      \
+                                                                                               \
+        uint32_t node = (uint32_t)++_set_->count;                                              \
+                                                                                               \
+        _set_->nodes[node].value = element;                                                    \
+        _set_->nodes[node].left = 0;                                                           \
+        _set_->nodes[node].right = 0;                                                          \
+        _set_->nodes[node].link = (parent << 6) | 1;                                           \
+                                                                                               \
+        if (parent == 0)                                                                       \
+            _set_->root = node;                                                                \
+        else                                                                                   \
+        {                                                                                      \
+            if (c > 0)                                                                         \
+                _set_->nodes[parent].left = node;                                              \
+            else                                                                               \
+                _set_->nodes[parent].right = node;                                             \
+                                                                                               \
+            PFX##_impl_rebalance(_set_, parent);                                               \
+        }                                                                                      \
+                                                                                               \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    bool PFX##_remove(struct SNAME *_set_, V element)                                          \
+    {                                                                                          \
+        uint32_t node = PFX##_impl_get_node(_set_, element);                                   \
+                                                                                               \
+        if (node == 0)                                                                         \
+            return false;                                                                      \
+                                                                                               \
+        struct SNAME##_node *nodes = _set_->nodes;                                             \
+                                                                                               \
+        /* With two children the element of the next node takes its place */                   \
+        /* and that node, which has no left child, is the one unlinked */                      \
+        if (nodes[node].left != 0 && nodes[node].right != 0)                                   \
+        {                                                                                      \
+            uint32_t next = PFX##_impl_first(_set_, nodes[node].right);                        \
+                                                                                               \
+            nodes[node].value = nodes[next].value;                                             \
+            node = next;                                                                       \
+        }                                                                                      \
+                                                                                               \
+        uint32_t child = nodes[node].left != 0 ? nodes[node].left : nodes[node].right;         \
+        uint32_t parent = PFX##_impl_parent(_set_, node);                                      \
+                                                                                               \
+        PFX##_impl_replace_child(_set_, parent, node, child);                                  \
+                                                                                               \
+        if (child != 0)                                                                        \
+            PFX##_impl_set_parent(_set_, child, parent);                                       \
+                                                                                               \
+        /* The last node of the array fills the hole */                                        \
+        uint32_t last = (uint32_t)_set_->count;                                                \
+                                                                                               \
+        if (node != last)                                                                      \
+        {                                                                                      \
+            nodes[node] = nodes[last];                                                         \
+                                                                                               \
+            PFX##_impl_replace_child(_set_, PFX##_impl_parent(_set_, node), last, node);       \
+                                                                                               \
+            if (nodes[node].left != 0)                                                         \
+                PFX##_impl_set_parent(_set_, nodes[node].left, node);                          \
+            if (nodes[node].right != 0)                                                        \
+                PFX##_impl_set_parent(_set_, nodes[node].right, node);                         \
+                                                                                               \
+            if (parent == last)                                                                \
+                parent = node;                                                                 \
+        }                                                                                      \
+                                                                                               \
+        _set_->count--;                                                                        \
+                                                                                               \
+        if (parent != 0)                                                                       \
+            PFX##_impl_rebalance(_set_, parent);                                               \
+                                                                                               \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    bool PFX##_max(struct SNAME *_set_, V *value)                                              \
+    {                                                                                          \
+        if (PFX##_empty(_set_))                                                                \
+            return false;                                                                      \
+                                                                                               \
+        if (value)                                                                             \
+            *value = _set_->nodes[PFX##_impl_last(_set_, _set_->root)].value;                  \
+                                                                                               \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    bool PFX##_min(struct SNAME *_set_, V *value)                                              \
+    {                                                                                          \
+        if (PFX##_empty(_set_))                                                                \
+            return false;                                                                      \
+                                                                                               \
+        if (value)                                                                             \
+            *value = _set_->nodes[PFX##_impl_first(_set_, _set_->root)].value;                 \
+                                                                                               \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    /* The greatest element that is less than or equal to the given one */                     \
+    bool PFX##_floor(struct SNAME *_set_, V element, V *value)                                 \
+    {                                                                                          \
+        uint32_t node = PFX##_impl_bound_node(_set_, element, true);                           \
+                                                                                               \
+        if (node == 0)                                                                         \
+            return false;                                                                      \
+                                                                                               \
+        if (value)                                                                             \
+            *value = _set_->nodes[node].value;                                                 \
+                                                                                               \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    /* The smallest element that is greater than or equal to the given one */                  \
+    bool PFX##_ceiling(struct SNAME *_set_, V element, V *value)                               \
+    {                                                                                          \
+        uint32_t node = PFX##_impl_bound_node(_set_, element, false);                          \
+                                                                                               \
+        if (node == 0)                                                                         \
+            return false;                                                                      \
+                                                                                               \
+        if (value)                                                                             \
+            *value = _set_->nodes[node].value;                                                 \
+                                                                                               \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    bool PFX##_contains(struct SNAME *_set_, V element)                                        \
+    {                                                                                          \
+        return PFX##_impl_get_node(_set_, element) != 0;                                       \
+    }                                                                                          \
+                                                                                               \
+    bool PFX##_empty(struct SNAME *_set_)                                                      \
+    {                                                                                          \
+        return _set_->count == 0;                                                              \
+    }                                                                                          \
+                                                                                               \
+    size_t PFX##_count(struct SNAME *_set_)                                                    \
+    {                                                                                          \
+        return _set_->count;                                                                   \
+    }                                                                                          \
+                                                                                               \
+    size_t PFX##_memory_usage(struct SNAME *_set_)                                             \
+    {                                                                                          \
+        return sizeof(struct SNAME) + sizeof(struct SNAME##_node) * _set_->capacity;           \
+    }                                                                                          \
+                                                                                               \
+    struct cmc_string PFX##_to_string(struct SNAME *_set_)                                     \
+    {                                                                                          \
+        struct cmc_string str;                                                                 \
+        struct SNAME *s_ = _set_;                                                              \
+        const char *name = #SNAME;                                                             \
+                                                                                               \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_compacttreeset, name, s_, s_->nodes,    \
+                 s_->capacity, s_->root, s_->count, s_->cmp);                                  \
+                                                                                               \
+        return str;                                                                            \
+    }                                                                                          \
+                                                                                               \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE)                             \
+                                                                                               \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE, (V))                               \
+                                                                                               \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                      \
+    {                                                                                          \
+        iter->target = target;                                                                 \
+        iter->first = PFX##_impl_first(target, target->root);                                  \
+        iter->last = PFX##_impl_last(target, target->root);                                    \
+        iter->cursor = iter->first;                                                            \
+        iter->index = 0;                                                                       \
+        iter->start = true;                                                                    \
+        iter->end = PFX##_empty(target);                                                       \
+    }                                                                                          \
+                                                                                               \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                           \
+    {                                                                                          \
+        return PFX##_empty(iter->target) || iter->start;                                       \
+    }                                                                                          \
+                                                                                               \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                             \
+    {                                                                                          \
+        return PFX##_empty(iter->target) || iter->end;                                         \
+    }                                                                                          \
+                                                                                               \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                        \
+    {                                                                                          \
+        if (!PFX##_empty(iter->target))                                                        \
+        {                                                                                      \
+            iter->index = 0;                                                                   \
+            iter->start = true;                                                                \
+            iter->end = false;                                                                 \
+            iter->cursor = iter->first;                                                        \
+        }                                                                                      \
+    }                                                                                          \
+                                                                                               \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                          \
+    {                                                                                          \
+        if (!PFX##_empty(iter->target))                                                        \
+        {                                                                                      \
+            iter->index = iter->target->count - 1;                                             \
+            iter->start = false;                                                               \
+            iter->end = true;                                                                  \
+            iter->cursor = iter->last;                                                         \
+        }                                                                                      \
+    }                                                                                          \
+                                                                                               \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                            \
+    {                                                                                          \
+        if (iter->end)                                                                         \
+            return false;                                                                      \
+                                                                                               \
+        if (iter->cursor == iter->last)                                                        \
+        {                                                                                      \
+            iter->end = true;                                                                  \
+            return true;                                                                       \
+        }                                                                                      \
+                                                                                               \
+        struct SNAME *_set_ = iter->target;                                                    \
+                                                                                               \
+        iter->start = false;                                                                   \
+        iter->index++;                                                                         \
+                                                                                               \
+        if (_set_->nodes[iter->cursor].right != 0)                                             \
+        {                                                                                      \
+            iter->cursor = PFX##_impl_first(_set_, _set_->nodes[iter->cursor].right);          \
+            return true;                                                                       \
+        }                                                                                      \
+                                                                                               \
+        uint32_t parent = PFX##_impl_parent(_set_, iter->cursor);                              \
+                                                                                               \
+        while (_set_->nodes[parent].right == iter->cursor)                                     \
+        {                                                                                      \
+            iter->cursor = parent;                                                             \
+            parent = PFX##_impl_parent(_set_, parent);                                         \
+        }                                                                                      \
+                                                                                               \
+        iter->cursor = parent;                                                                 \
+                                                                                               \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                            \
+    {                                                                                          \
+        if (iter->start)                                                                       \
+            return false;                                                                      \
+                                                                                               \
+        if (iter->cursor == iter->first)                                                       \
+        {                                                                                      \
+            iter->start = true;                                                                \
+            return true;                                                                       \
+        }                                                                                      \
+                                                                                               \
+        struct SNAME *_set_ = iter->target;                                                    \
+                                                                                               \
+        iter->end = false;                                                                     \
+        iter->index--;                                                                         \
+                                                                                               \
+        if (_set_->nodes[iter->cursor].left != 0)                                              \
+        {                                                                                      \
+            iter->cursor = PFX##_impl_last(_set_, _set_->nodes[iter->cursor].left);            \
+            return true;                                                                       \
+        }                                                                                      \
+                                                                                               \
+        uint32_t parent = PFX##_impl_parent(_set_, iter->cursor);                              \
+                                                                                               \
+        while (_set_->nodes[parent].left == iter->cursor)                                      \
+        {                                                                                      \
+            iter->cursor = parent;                                                             \
+            parent = PFX##_impl_parent(_set_, parent);                                         \
+        }                                                                                      \
+                                                                                               \
+        iter->cursor = parent;                                                                 \
+                                                                                               \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                              \
+    {                                                                                          \
+        if (PFX##_empty(iter->target))                                                         \
+            return (V){ 0 };                                                                   \
+                                                                                               \
+        return iter->target->nodes[iter->cursor].value;                                        \
+    }                                                                                          \
+                                                                                               \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                         \
+    {                                                                                          \
+        return iter->index;                                                                    \
+    }                                                                                          \
+                                                                                               \
+    static inline int PFX##_impl_cmp(struct SNAME *_set_, V a, V b)                            \
+    {                                                                                          \
+        (void)_set_;                                                                           \
+                                                                                               \
+        return CMP(a, b);                                                                      \
+    }                                                                                          \
+                                                                                               \
+    static uint32_t PFX##_impl_get_node(struct SNAME *_set_, V element)                        \
+    {                                                                                          \
+        uint32_t scan = _set_->root;                                                           \
+                                                                                               \
+        while (scan != 0)                                                                      \
+        {                                                                                      \
+            int c = PFX##_impl_cmp(_set_, _set_->nodes[scan].value, element);                  \
+                                                                                               \
+            if (c > 0)                                                                         \
+                scan = _set_->nodes[scan].left;                                                \
+            else if (c < 0)                                                                    \
+                scan = _set_->nodes[scan].right;                                               \
+            else                                                                               \
+                return scan;                                                                   \
+        }                                                                                      \
+                                                                                               \
+        return 0;                                                                              \
+    }                                                                                          \
+                                                                                               \
+    /* The node of the floor or the ceiling of element, or 0 if there is none */               \
+    static uint32_t PFX##_impl_bound_node(struct SNAME *_set_, V element, bool floor)          \
+    {                                                                                          \
+        uint32_t scan = _set_->root;                                                           \
+        uint32_t result = 0;                                                                   \
+                                                                                               \
+        while (scan != 0)                                                                      \
+        {                                                                                      \
+            int c = PFX##_impl_cmp(_set_, _set_->nodes[scan].value, element);                  \
+                                                                                               \
+            if (c == 0)                                                                        \
+                return scan;                                                                   \
+                                                                                               \
+            if ((c < 0) == floor)                                                              \
+                result = scan;                                                                 \
+                                                                                               \
+            scan = c > 0 ? _set_->nodes[scan].left : _set_->nodes[scan].right;                 \
+        }                                                                                      \
+                                                                                               \
+        return result;                                                                         \
+    }                                                                                          \
+                                                                                               \
+    static uint32_t PFX##_impl_first(struct SNAME *_set_, uint32_t node)                       \
+    {                                                                                          \
+        if (node != 0)                                                                         \
+        {                                                                                      \
+            while (_set_->nodes[node].left != 0)                                               \
+                node = _set_->nodes[node].left;                                                \
+        }                                                                                      \
+                                                                                               \
+        return node;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    static uint32_t PFX##_impl_last(struct SNAME *_set_, uint32_t node)                        \
+    {                                                                                          \
+        if (node != 0)                                                                         \
+        {                                                                                      \
+            while (_set_->nodes[node].right != 0)                                              \
+                node = _set_->nodes[node].right;                                               \
+        }                                                                                      \
+                                                                                               \
+        return node;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    static uint32_t PFX##_impl_parent(struct SNAME *_set_, uint32_t node)                      \
+    {                                                                                          \
+        return _set_->nodes[node].link >> 6;                                                   \
+    }                                                                                          \
+                                                                                               \
+    static void PFX##_impl_set_parent(struct SNAME *_set_, uint32_t node, uint32_t parent)     \
+    {                                                                                          \
+        _set_->nodes[node].link = (parent << 6) | (_set_->nodes[node].link & 63);              \
+    }                                                                                          \
+                                                                                               \
+    /* Makes other take the place of child under parent, or of the root */                     \
+    static void PFX##_impl_replace_child(struct SNAME *_set_, uint32_t parent, uint32_t child, \
+                                         uint32_t other)                                       \
+    {                                                                                          \
+        if (parent == 0)                                                                       \
+            _set_->root = other;                                                               \
+        else if (_set_->nodes[parent].left == child)                                           \
+            _set_->nodes[parent].left = other;                                                 \
+        else                                                                                   \
+            _set_->nodes[parent].right = other;                                                \
+    }                                                                                          \
+                                                                                               \
+    static unsigned PFX##_impl_h(struct SNAME *_set_, uint32_t node)                           \
+    {                                                                                          \
+        if (node == 0)                                                                         \
+            return 0;                                                                          \
+                                                                                               \
+        return _set_->nodes[node].link & 63;                                                   \
+    }                                                                                          \
+                                                                                               \
+    static void PFX##_impl_hupdate(struct SNAME *_set_, uint32_t node)                         \
+    {                                                                                          \
+        unsigned h_l = PFX##_impl_h(_set_, _set_->nodes[node].left);                           \
+        unsigned h_r = PFX##_impl_h(_set_, _set_->nodes[node].right);                          \
+                                                                                               \
+        unsigned height = 1 + (h_l > h_r ? h_l : h_r);                                         \
+                                                                                               \
+        _set_->nodes[node].link = (_set_->nodes[node].link & ~UINT32_C(63)) | height;          \
+    }                                                                                          \
+                                                                                               \
+    static void PFX##_impl_rotate_right(struct SNAME *_set_, uint32_t node)                    \
+    {                                                                                          \
+        struct SNAME##_node *nodes = _set_->nodes;                                             \
+                                                                                               \
+        uint32_t new_root = nodes[node].left;                                                  \
+        uint32_t parent = PFX##_impl_parent(_set_, node);                                      \
+                                                                                               \
+        PFX##_impl_replace_child(_set_, parent, node, new_root);                               \
+        PFX##_impl_set_parent(_set_, new_root, parent);                                        \
+                                                                                               \
+        nodes[node].left = nodes[new_root].right;                                              \
+                                                                                               \
+        if (nodes[node].left != 0)                                                             \
+            PFX##_impl_set_parent(_set_, nodes[node].left, node);                              \
+                                                                                               \
+        nodes[new_root].right = node;                                                          \
+        PFX##_impl_set_parent(_set_, node, new_root);                                          \
+                                                                                               \
+        PFX##_impl_hupdate(_set_, node);                                                       \
+        PFX##_impl_hupdate(_set_, new_root);                                                   \
+    }                                                                                          \
+                                                                                               \
+    static void PFX##_impl_rotate_left(struct SNAME *_set_, uint32_t node)                     \
+    {                                                                                          \
+        struct SNAME##_node *nodes = _set_->nodes;                                             \
+                                                                                               \
+        uint32_t new_root = nodes[node].right;                                                 \
+        uint32_t parent = PFX##_impl_parent(_set_, node);                                      \
+                                                                                               \
+        PFX##_impl_replace_child(_set_, parent, node, new_root);                               \
+        PFX##_impl_set_parent(_set_, new_root, parent);                                        \
+                                                                                               \
+        nodes[node].right = nodes[new_root].left;                                              \
+                                                                                               \
+        if (nodes[node].right != 0)                                                            \
+            PFX##_impl_set_parent(_set_, nodes[node].right, node);                             \
+                                                                                               \
+        nodes[new_root].left = node;                                                           \
+        PFX##_impl_set_parent(_set_, node, new_root);                                          \
+                                                                                               \
+        PFX##_impl_hupdate(_set_, node);                                                       \
+        PFX##_impl_hupdate(_set_, new_root);                                                   \
+    }                                                                                          \
+                                                                                               \
+    /* Fixes the heights and the balance from node up to the root */                           \
+    static void PFX##_impl_rebalance(struct SNAME *_set_, uint32_t node)                       \
+    {                                                                                          \
+        struct SNAME##_node *nodes = _set_->nodes;                                             \
+                                                                                               \
+        while (node != 0)                                                                      \
+        {                                                                                      \
+            PFX##_impl_hupdate(_set_, node);                                                   \
+                                                                                               \
+            uint32_t left = nodes[node].left;                                                  \
+            uint32_t right = nodes[node].right;                                                \
+                                                                                               \
+            unsigned h_l = PFX##_impl_h(_set_, left);                                          \
+            unsigned h_r = PFX##_impl_h(_set_, right);                                         \
+                                                                                               \
+            if (h_l > h_r + 1)                                                                 \
+            {                                                                                  \
+                unsigned h_ll = PFX##_impl_h(_set_, nodes[left].left);                         \
+                                                                                               \
+                if (h_ll < PFX##_impl_h(_set_, nodes[left].right))                             \
+                    PFX##_impl_rotate_left(_set_, left);                                       \
+                                                                                               \
+                PFX##_impl_rotate_right(_set_, node);                                          \
+                                                                                               \
+                node = PFX##_impl_parent(_set_, node);                                         \
+            }                                                                                  \
+            else if (h_r > h_l + 1)                                                            \
+            {                                                                                  \
+                unsigned h_rr = PFX##_impl_h(_set_, nodes[right].right);                       \
+                                                                                               \
+                if (h_rr < PFX##_impl_h(_set_, nodes[right].left))                             \
+                    PFX##_impl_rotate_right(_set_, right);                                     \
+                                                                                               \
+                PFX##_impl_rotate_left(_set_, node);                                           \
+                                                                                               \
+                node = PFX##_impl_parent(_set_, node);                                         \
+            }                                                                                  \
+                                                                                               \
+            node = PFX##_impl_parent(_set_, node);                                             \
+        }                                                                                      \
+    }
+
+#endif /* CMC_COMPACTTREESET_H */
@@ -0,0 +1,362 @@
+/**
+ * concurrenthashmap.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * ConcurrentHashMap
+ *
+ * A ConcurrentHashMap is a HashMap that can be shared between threads. Keys
+ * are partitioned by their hash into a fixed number of shards, each one a
+ * HashMap protected by its own mutex, so threads working on keys that belong
+ * to different shards never wait for each other. Shards are padded to the
+ * size of a cache line so that their locks do not share one.
+ *
+ * There are no iterators and no functions returning references to values as
+ * they would outlive the lock of their shard. Requires pthreads.
+ */
+
+#ifndef CMC_CONCURRENTHASHMAP_H
+#define CMC_CONCURRENTHASHMAP_H
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+#include "hashmap.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_concurrenthashmap = "%s at %p { shards:%p, shard_count:%" PRIuMAX ", cmp:%p, hash:%p }";
+
+/* Shards are aligned and padded to this size to avoid false sharing */
+#ifndef CMC_CACHE_LINE_SIZE
+#define CMC_CACHE_LINE_SIZE 64
+#endif
+
+#define CMC_GENERATE_CONCURRENT_HASHMAP(PFX, SNAME, K, V)    \
+    CMC_GENERATE_CONCURRENT_HASHMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_CONCURRENT_HASHMAP_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_CONCURRENT_HASHMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_CONCURRENT_HASHMAP_HEADER(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_CONCURRENT_HASHMAP_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_CONCURRENT_HASHMAP_SOURCE(PFX, SNAME, K, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_CONCURRENT_HASHMAP_HEADER(PFX, SNAME, K, V)                        \
+                                                                                        \
+    /* The HashMap used by each shard */                                                \
+    CMC_GENERATE_HASHMAP_HEADER(PFX##_shard_map, SNAME##_shard_map, K, V)               \
+                                                                                        \
+    /* ConcurrentHashMap Structure */                                                   \
+    struct SNAME                                                                        \
+    {                                                                                   \
+        /* Array of shards */                                                           \
+        struct SNAME##_shard *shards;                                                   \
+                                                                                        \
+        /* How many shards there are, always a power of 2 */                            \
+        size_t shard_count;                                                             \
+                                                                                        \
+        /* Key comparison function */                                                   \
+        int (*cmp)(K, K);                                                               \
+                                                                                        \
+        /* Key hash function */                                                         \
+        size_t (*hash)(K);                                                              \
+                                                                                        \
+        /* Custom allocation functions */                                               \
+        struct cmc_alloc_node *alloc;                                                   \
+    };                                                                                  \
+                                                                                        \
+    /* A HashMap and the lock that protects it */                                       \
+    struct SNAME##_shard                                                                \
+    {                                                                                   \
+        pthread_mutex_t lock;                                                           \
+                                                                                        \
+        struct SNAME##_shard_map *map;                                                  \
+                                                                                        \
+        /* Fills the rest of the cache line */                                          \
+        char padding[CMC_CACHE_LINE_SIZE -                                              \
+                     (sizeof(pthread_mutex_t) + sizeof(void *)) % CMC_CACHE_LINE_SIZE]; \
+    };                                                                                  \
+                                                                                        \
+    /* Collection Functions */                                                          \
+    /* Collection Allocation and Deallocation */                                        \
+    struct SNAME *PFX##_new(size_t shards, size_t capacity, double load,                \
+                            int (*compare)(K, K), size_t (*hash)(K));                   \
+    struct SNAME *PFX##_new_custom(size_t shards, size_t capacity, double load,         \
+                                   int (*compare)(K, K), size_t (*hash)(K),             \
+                                   struct cmc_alloc_node *alloc);                       \
+    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V));                   \
+    void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V));                    \
+    /* Collection Input and Output */                                                   \
+    bool PFX##_insert(struct SNAME *_map_, K key, V value);                             \
+    bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value);           \
+    bool PFX##_remove(struct SNAME *_map_, K key, V *out_value);                        \
+    /* Element Access */                                                                \
+    V PFX##_get(struct SNAME *_map_, K key);                                            \
+    /* Collection State */                                                              \
+    bool PFX##_contains(struct SNAME *_map_, K key);                                    \
+    bool PFX##_empty(struct SNAME *_map_);                                              \
+    size_t PFX##_count(struct SNAME *_map_);                                            \
+    size_t PFX##_memory_usage(struct SNAME *_map_);                                     \
+    void PFX##_stats(struct SNAME *_map_, struct cmc_hashtable_stats *out);             \
+    /* Collection Utility */                                                            \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_);                             \
+                                                                                        \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_CONCURRENT_HASHMAP_SOURCE(PFX, SNAME, K, V)                     \
+                                                                                     \
+    CMC_GENERATE_HASHMAP_SOURCE(PFX##_shard_map, SNAME##_shard_map, K, V)            \
+                                                                                     \
+    /* Implementation Detail Functions */                                            \
+    static struct SNAME##_shard *PFX##_impl_shard_of(struct SNAME *_map_, K key);    \
+                                                                                     \
+    struct SNAME *PFX##_new(size_t shards, size_t capacity, double load,             \
+                            int (*compare)(K, K), size_t (*hash)(K))                 \
+    {                                                                                \
+        return PFX##_new_custom(shards, capacity, load, compare, hash, NULL);        \
+    }                                                                                \
+                                                                                     \
+    struct SNAME *PFX##_new_custom(size_t shards, size_t capacity, double load,      \
+                                   int (*compare)(K, K), size_t (*hash)(K),          \
+                                   struct cmc_alloc_node *alloc)                     \
+    {                                                                                \
+        if (!alloc)                                                                  \
+            alloc = &cmc_alloc_node_default;                                         \
+                                                                                     \
+        if (shards == 0 || capacity == 0)                                            \
+            return NULL;                                                             \
+                                                                                     \
+        size_t shard_count = 1;                                                      \
+                                                                                     \
+        while (shard_count < shards)                                                 \
+            shard_count *= 2;                                                        \
+                                                                                     \
+        struct SNAME *_map_ = alloc->malloc(sizeof(struct SNAME));                   \
+                                                                                     \
+        if (CMC_UNLIKELY(!_map_))                                                    \
+            return NULL;                                                             \
+                                                                                     \
+        _map_->alloc = alloc;                                                        \
+                                                                                     \
+        _map_->shards =                                                              \
+            cmc_alloc_aligned(alloc, CMC_CACHE_LINE_SIZE,                            \
+                              sizeof(struct SNAME##_shard) * shard_count);           \
+                                                                                     \
+        if (!_map_->shards)                                                          \
+        {                                                                            \
+            alloc->free(_map_);                                                      \
+            return NULL;                                                             \
+        }                                                                            \
+                                                                                     \
+        size_t shard_capacity = capacity / shard_count + 1;                          \
+                                                                                     \
+        for (size_t i = 0; i < shard_count; i++)                                     \
+        {                                                                            \
+            struct SNAME##_shard *shard = &(_map_->shards[i]);                       \
+                                                                                     \
+            shard->map =                                                             \
+                PFX##_shard_map_new_custom(shard_capacity, load, compare, hash,      \
+                                           alloc);                                   \
+                                                                                     \
+            if (!shard->map || pthread_mutex_init(&(shard->lock), NULL) != 0)        \
+            {                                                                        \
+                if (shard->map)                                                      \
+                    PFX##_shard_map_free(shard->map, NULL);                          \
+                                                                                     \
+                for (size_t j = 0; j < i; j++)                                       \
+                {                                                                    \
+                    pthread_mutex_destroy(&(_map_->shards[j].lock));                 \
+                    PFX##_shard_map_free(_map_->shards[j].map, NULL);                \
+                }                                                                    \
+                                                                                     \
+                cmc_alloc_aligned_free(alloc, _map_->shards);                        \
+                alloc->free(_map_);                                                  \
+                return NULL;                                                         \
+            }                                                                        \
+        }                                                                            \
+                                                                                     \
+        _map_->shard_count = shard_count;                                            \
+        _map_->cmp = compare;                                                        \
+        _map_->hash = hash;                                                          \
+                                                                                     \
+        return _map_;                                                                \
+    }                                                                                \
+                                                                                     \
+    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V))                 \
+    {                                                                                \
+        for (size_t i = 0; i < _map_->shard_count; i++)                              \
+        {                                                                            \
+            struct SNAME##_shard *shard = &(_map_->shards[i]);                       \
+                                                                                     \
+            pthread_mutex_lock(&(shard->lock));                                      \
+            PFX##_shard_map_clear(shard->map, deallocator);                          \
+            pthread_mutex_unlock(&(shard->lock));                                    \
+        }                                                                            \
+    }                                                                                \
+                                                                                     \
+    void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V))                  \
+    {                                                                                \
+        for (size_t i = 0; i < _map_->shard_count; i++)                              \
+        {                                                                            \
+            pthread_mutex_destroy(&(_map_->shards[i].lock));                         \
+            PFX##_shard_map_free(_map_->shards[i].map, deallocator);                 \
+        }                                                                            \
+                                                                                     \
+        cmc_alloc_aligned_free(_map_->alloc, _map_->shards);                         \
+        _map_->alloc->free(_map_);                                                   \
+    }                                                                                \
+                                                                                     \
+    bool PFX##_insert(struct SNAME *_map_, K key, V value)                           \
+    {                                                                                \
+        struct SNAME##_shard *shard = PFX##_impl_shard_of(_map_, key);               \
+                                                                                     \
+        pthread_mutex_lock(&(shard->lock));                                          \
+        bool result = PFX##_shard_map_insert(shard->map, key, value);                \
+        pthread_mutex_unlock(&(shard->lock));                                        \
+                                                                                     \
+        return result;                                                               \
+    }                                                                                \
+                                                                                     \
+    bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value)         \
+    {                                                                                \
+        struct SNAME##_shard *shard = PFX##_impl_shard_of(_map_, key);               \
+                                                                                     \
+        pthread_mutex_lock(&(shard->lock));                                          \
+        bool result = PFX##_shard_map_update(shard->map, key, new_value, old_value); \
+        pthread_mutex_unlock(&(shard->lock));                                        \
+                                                                                     \
+        return result;                                                               \
+    }                                                                                \
+                                                                                     \
+    bool PFX##_remove(struct SNAME *_map_, K key, V *out_value)                      \
+    {                                                                                \
+        struct SNAME##_shard *shard = PFX##_impl_shard_of(_map_, key);               \
+                                                                                     \
+        pthread_mutex_lock(&(shard->lock));                                          \
+        bool result = PFX##_shard_map_remove(shard->map, key, out_value);            \
+        pthread_mutex_unlock(&(shard->lock));                                        \
+                                                                                     \
+        return result;                                                               \
+    }                                                                                \
+                                                                                     \
+    V PFX##_get(struct SNAME *_map_, K key)                                          \
+    {                                                                                \
+        struct SNAME##_shard *shard = PFX##_impl_shard_of(_map_, key);               \
+                                                                                     \
+        pthread_mutex_lock(&(shard->lock));                                          \
+        V result = PFX##_shard_map_get(shard->map, key);                             \
+        pthread_mutex_unlock(&(shard->lock));                                        \
+                                                                                     \
+        return result;                                                               \
+    }                                                                                \
+                                                                                     \
+    bool PFX##_contains(struct SNAME *_map_, K key)                                  \
+    {                                                                                \
+        struct SNAME##_shard *shard = PFX##_impl_shard_of(_map_, key);               \
+                                                                                     \
+        pthread_mutex_lock(&(shard->lock));                                          \
+        bool result = PFX##_shard_map_contains(shard->map, key);                     \
+        pthread_mutex_unlock(&(shard->lock));                                        \
+                                                                                     \
+        return result;                                                               \
+    }                                                                                \
+                                                                                     \
+    bool PFX##_empty(struct SNAME *_map_)                                            \
+    {                                                                                \
+        return PFX##_count(_map_) == 0;                                              \
+    }                                                                                \
+                                                                                     \
+    /* Shards are locked one at a time so the result is only exact when */           \
+    /* no other thread is modifying the map */                                       \
+    size_t PFX##_count(struct SNAME *_map_)                                          \
+    {                                                                                \
+        size_t count = 0;                                                            \
+                                                                                     \
+        for (size_t i = 0; i < _map_->shard_count; i++)                              \
+        {                                                                            \
+            struct SNAME##_shard *shard = &(_map_->shards[i]);                       \
+                                                                                     \
+            pthread_mutex_lock(&(shard->lock));                                      \
+            count += PFX##_shard_map_count(shard->map);                              \
+            pthread_mutex_unlock(&(shard->lock));                                    \
+        }                                                                            \
+                                                                                     \
+        return count;                                                                \
+    }                                                                                \
+                                                                                     \
+    size_t PFX##_memory_usage(struct SNAME *_map_)                                   \
+    {                                                                                \
+        size_t shards = sizeof(struct SNAME##_shard) * _map_->shard_count;           \
+                                                                                     \
+        size_t bytes = sizeof(struct SNAME) +                                        \
+                       cmc_alloc_aligned_size(CMC_CACHE_LINE_SIZE, shards);          \
+                                                                                     \
+        for (size_t i = 0; i < _map_->shard_count; i++)                              \
+        {                                                                            \
+            struct SNAME##_shard *shard = &(_map_->shards[i]);                       \
+                                                                                     \
+            pthread_mutex_lock(&(shard->lock));                                      \
+            bytes += PFX##_shard_map_memory_usage(shard->map);                       \
+            pthread_mutex_unlock(&(shard->lock));                                    \
+        }                                                                            \
+                                                                                     \
+        return bytes;                                                                \
+    }                                                                                \
+                                                                                     \
+    /* Shards are locked one at a time, the same way as PFX##_count() */             \
+    void PFX##_stats(struct SNAME *_map_, struct cmc_hashtable_stats *out)           \
+    {                                                                                \
+        memset(out, 0, sizeof(struct cmc_hashtable_stats));                          \
+                                                                                     \
+        out->bytes = sizeof(struct SNAME) +                                          \
+                     sizeof(struct SNAME##_shard) * _map_->shard_count;              \
+                                                                                     \
+        for (size_t i = 0; i < _map_->shard_count; i++)                              \
+        {                                                                            \
+            struct SNAME##_shard *shard = &(_map_->shards[i]);                       \
+            struct cmc_hashtable_stats shard_stats;                                  \
+                                                                                     \
+            pthread_mutex_lock(&(shard->lock));                                      \
+            PFX##_shard_map_stats(shard->map, &shard_stats);                         \
+            pthread_mutex_unlock(&(shard->lock));                                    \
+                                                                                     \
+            cmc_hashtable_stats_merge(out, &shard_stats);                            \
+        }                                                                            \
+                                                                                     \
+        cmc_hashtable_stats_end(out);                                                \
+    }                                                                                \
+                                                                                     \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_)                           \
+    {                                                                                \
+        struct cmc_string str;                                                       \
+        struct SNAME *m_ = _map_;                                                    \
+        const char *name = #SNAME;                                                   \
+                                                                                     \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_concurrenthashmap,            \
+                 name, m_, m_->shards, m_->shard_count, m_->cmp, m_->hash);          \
+                                                                                     \
+        return str;                                                                  \
+    }                                                                                \
+                                                                                     \
+    /* The shard is picked with the mixed hash so that the lower bits of */          \
+    /* keys with a weak hash still spread across every shard */                      \
+    static struct SNAME##_shard *PFX##_impl_shard_of(struct SNAME *_map_, K key)     \
+    {                                                                                \
+        size_t hash = cmc_hashtable_mix(_map_->hash(key));                           \
+                                                                                     \
+        return &(_map_->shards[hash & (_map_->shard_count - 1)]);                    \
+    }
+
+#endif /* CMC_CONCURRENTHASHMAP_H */
@@ -0,0 +1,452 @@
+/**
+ * concurrentstack.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * ConcurrentStack
+ *
+ * A ConcurrentStack is a Stack of a fixed capacity that can be shared by any
+ * amount of threads without locks, like the free list of a pool of buffers.
+ * push fails if the stack is full and pop fails if it is empty. Requires C11
+ * atomics.
+ *
+ * Implementation
+ *
+ * This is the stack by Treiber, with an elimination array by Hendler, Shavit
+ * and Yerushalmi. The nodes are allocated up front and the ones not in use
+ * are kept in a second stack. Both stacks are 64 bit words with the index
+ * of the node at the top and a tag incremented by every change, so a compare
+ * and swap fails if the top was popped and pushed back in between, which
+ * would otherwise corrupt the stack (the ABA problem). The tag wraps after
+ * 2^32 changes, which is never reached while a thread is between its load
+ * and its compare and swap. There may be at most 2^32 - 1 nodes.
+ *
+ * A thread that loses the race for the top tries the elimination array. A
+ * push offers its node in a slot and waits a few iterations for a pop to
+ * take it, and a pop that finds a node in a slot takes it. Both return
+ * without touching the top. The slots are tagged like the stacks. A stack
+ * created with no slots never eliminates.
+ */
+
+#ifndef CMC_CONCURRENTSTACK_H
+#define CMC_CONCURRENTSTACK_H
+
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_concurrentstack = "%s at %p { nodes:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", slots:%" PRIuMAX " }";
+
+/* The tops and the slots are padded to this size to avoid false sharing */
+#ifndef CMC_CACHE_LINE_SIZE
+#define CMC_CACHE_LINE_SIZE 64
+#endif
+
+/* Iterations a push waits in a slot of the elimination array */
+#ifndef CMC_CONCURRENT_STACK_SPINS
+#define CMC_CONCURRENT_STACK_SPINS 64
+#endif
+
+/* Index of no node */
+#define CMC_CONCURRENT_STACK_NIL UINT32_MAX
+
+/* The tag of a word is its upper half and the index of a node the lower. */
+/* NEXT is the word that follows word with index at the top */
+#define CMC_IMPL_CSTACK_INDEX(word) ((uint_least32_t)((word)&UINT32_MAX))
+#define CMC_IMPL_CSTACK_NEXT(word, index) ((((word) >> 32) + 1) << 32 | (index))
+
+#define CMC_GENERATE_CONCURRENT_STACK(PFX, SNAME, V)    \
+    CMC_GENERATE_CONCURRENT_STACK_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_CONCURRENT_STACK_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_CONCURRENT_STACK_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_CONCURRENT_STACK_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_CONCURRENT_STACK_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_CONCURRENT_STACK_SOURCE(PFX, SNAME, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_CONCURRENT_STACK_HEADER(PFX, SNAME, V)                       \
+    /* A node of one of the stacks */                                             \
+    struct SNAME##_node                                                           \
+    {                                                                             \
+        V value;                                                                  \
+                                                                                  \
+        /* Index of the node below it */                                          \
+        atomic_uint_least32_t next;                                               \
+    };                                                                            \
+                                                                                  \
+    /* A slot of the elimination array. Holds a tag and the index of a node */    \
+    /* offered by a push */                                                       \
+    struct SNAME##_slot                                                           \
+    {                                                                             \
+        atomic_uint_least64_t offer;                                              \
+                                                                                  \
+        char padding[CMC_CACHE_LINE_SIZE - sizeof(atomic_uint_least64_t)];        \
+    };                                                                            \
+                                                                                  \
+    /* ConcurrentStack Structure */                                               \
+    struct SNAME                                                                  \
+    {                                                                             \
+        /* Tag and index of the top node */                                       \
+        atomic_uint_least64_t top;                                                \
+                                                                                  \
+        char top_padding[CMC_CACHE_LINE_SIZE - sizeof(atomic_uint_least64_t)];    \
+                                                                                  \
+        /* Tag and index of the top node not in use */                            \
+        atomic_uint_least64_t unused;                                             \
+                                                                                  \
+        char unused_padding[CMC_CACHE_LINE_SIZE - sizeof(atomic_uint_least64_t)]; \
+                                                                                  \
+        /* Current amount of elements */                                          \
+        atomic_size_t count;                                                      \
+                                                                                  \
+        /* Array of nodes */                                                      \
+        struct SNAME##_node *nodes;                                               \
+                                                                                  \
+        /* Amount of nodes */                                                     \
+        size_t capacity;                                                          \
+                                                                                  \
+        /* Elimination array */                                                   \
+        struct SNAME##_slot *slots;                                               \
+                                                                                  \
+        /* Amount of slots */                                                     \
+        size_t slot_count;                                                        \
+                                                                                  \
+        /* Custom allocation functions */                                         \
+        struct cmc_alloc_node *alloc;                                             \
+    };                                                                            \
+                                                                                  \
+    /* Collection Functions */                                                    \
+    /* Collection Allocation and Deallocation */                                  \
+    struct SNAME *PFX##_new(size_t capacity, size_t slots);                       \
+    struct SNAME *PFX##_new_custom(size_t capacity, size_t slots,                 \
+                                   struct cmc_alloc_node *alloc);                 \
+    void PFX##_free(struct SNAME *_stack_, void (*deallocator)(V));               \
+    /* Collection Input and Output */                                             \
+    bool PFX##_push(struct SNAME *_stack_, V element);                            \
+    bool PFX##_pop(struct SNAME *_stack_, V *result);                             \
+    /* Collection State */                                                        \
+    bool PFX##_empty(struct SNAME *_stack_);                                      \
+    size_t PFX##_count(struct SNAME *_stack_);                                    \
+    size_t PFX##_memory_usage(struct SNAME *_stack_);                             \
+    size_t PFX##_capacity(struct SNAME *_stack_);                                 \
+    /* Collection Utility */                                                      \
+    struct cmc_string PFX##_to_string(struct SNAME *_stack_);                     \
+                                                                                  \
+    /* SOURCE ********************************************************************/
+#define CMC_GENERATE_CONCURRENT_STACK_SOURCE(PFX, SNAME, V)                                           \
+    /* Implementation Detail Functions */                                                             \
+    static uint_least32_t PFX##_impl_take(struct SNAME *_stack_, atomic_uint_least64_t *list);        \
+    static void PFX##_impl_give(struct SNAME *_stack_, atomic_uint_least64_t *list,                   \
+                                uint_least32_t index);                                                \
+    static bool PFX##_impl_offer(struct SNAME *_stack_, uint_least64_t top, uint_least32_t index);    \
+    static uint_least32_t PFX##_impl_accept(struct SNAME *_stack_, uint_least64_t top);               \
+                                                                                                      \
+    /* Up to slots elimination slots are used, 0 disables elimination */                              \
+    struct SNAME *PFX##_new(size_t capacity, size_t slots)                                            \
+    {                                                                                                 \
+        return PFX##_new_custom(capacity, slots, NULL);                                               \
+    }                                                                                                 \
+                                                                                                      \
+    struct SNAME *PFX##_new_custom(size_t capacity, size_t slots, struct cmc_alloc_node *alloc)       \
+    {                                                                                                 \
+        if (!alloc)                                                                                   \
+            alloc = &cmc_alloc_node_default;                                                          \
+                                                                                                      \
+        if (capacity < 1 || capacity >= CMC_CONCURRENT_STACK_NIL)                                     \
+            return NULL;                                                                              \
+                                                                                                      \
+        size_t bytes = (sizeof(struct SNAME) + CMC_CACHE_LINE_SIZE - 1) / CMC_CACHE_LINE_SIZE;        \
+                                                                                                      \
+        struct SNAME *_stack_ = cmc_alloc_aligned(alloc, CMC_CACHE_LINE_SIZE,                         \
+                                                  bytes * CMC_CACHE_LINE_SIZE);                       \
+                                                                                                      \
+        if (CMC_UNLIKELY(!_stack_))                                                                   \
+            return NULL;                                                                              \
+                                                                                                      \
+        _stack_->alloc = alloc;                                                                       \
+                                                                                                      \
+        _stack_->nodes = alloc->malloc(sizeof(struct SNAME##_node) * capacity);                       \
+                                                                                                      \
+        if (CMC_UNLIKELY(!_stack_->nodes))                                                            \
+        {                                                                                             \
+            cmc_alloc_aligned_free(alloc, _stack_);                                                   \
+            return NULL;                                                                              \
+        }                                                                                             \
+                                                                                                      \
+        _stack_->slots = NULL;                                                                        \
+                                                                                                      \
+        if (slots > 0)                                                                                \
+        {                                                                                             \
+            _stack_->slots = cmc_alloc_aligned(alloc, CMC_CACHE_LINE_SIZE,                            \
+                                               sizeof(struct SNAME##_slot) * slots);                  \
+                                                                                                      \
+            if (CMC_UNLIKELY(!_stack_->slots))                                                        \
+            {                                                                                         \
+                alloc->free(_stack_->nodes);                                                          \
+                cmc_alloc_aligned_free(alloc, _stack_);                                               \
+                return NULL;                                                                          \
+            }                                                                                         \
+                                                                                                      \
+            for (size_t i = 0; i < slots; i++)                                                        \
+                atomic_init(&(_stack_->slots[i].offer), CMC_CONCURRENT_STACK_NIL);                    \
+        }                                                                                             \
+                                                                                                      \
+        /* Every node starts unused */                                                                \
+        for (size_t i = 0; i < capacity; i++)                                                         \
+        {                                                                                             \
+            uint_least32_t next = i + 1 < capacity ? (uint_least32_t)(i + 1)                          \
+                                                   : CMC_CONCURRENT_STACK_NIL;                        \
+                                                                                                      \
+            atomic_init(&(_stack_->nodes[i].next), next);                                             \
+        }                                                                                             \
+                                                                                                      \
+        atomic_init(&(_stack_->top), CMC_CONCURRENT_STACK_NIL);                                       \
+        atomic_init(&(_stack_->unused), 0);                                                           \
+        atomic_init(&(_stack_->count), 0);                                                            \
+                                                                                                      \
+        _stack_->capacity = capacity;                                                                 \
+        _stack_->slot_count = slots;                                                                  \
+                                                                                                      \
+        return _stack_;                                                                               \
+    }                                                                                                 \
+                                                                                                      \
+    /* No thread may be using the stack */                                                            \
+    void PFX##_free(struct SNAME *_stack_, void (*deallocator)(V))                                    \
+    {                                                                                                 \
+        if (deallocator)                                                                              \
+        {                                                                                             \
+            V value;                                                                                  \
+                                                                                                      \
+            while (PFX##_pop(_stack_, &value))                                                        \
+                deallocator(value);                                                                   \
+        }                                                                                             \
+                                                                                                      \
+        cmc_alloc_aligned_free(_stack_->alloc, _stack_->slots);                                       \
+        _stack_->alloc->free(_stack_->nodes);                                                         \
+        cmc_alloc_aligned_free(_stack_->alloc, _stack_);                                              \
+    }                                                                                                 \
+                                                                                                      \
+    /* Returns false if the stack is full */                                                          \
+    bool PFX##_push(struct SNAME *_stack_, V element)                                                 \
+    {                                                                                                 \
+        uint_least32_t index = PFX##_impl_take(_stack_, &(_stack_->unused));                          \
+                                                                                                      \
+        if (index == CMC_CONCURRENT_STACK_NIL)                                                        \
+            return false;                                                                             \
+                                                                                                      \
+        _stack_->nodes[index].value = element;                                                        \
+                                                                                                      \
+        /* Counted first so that a pop never sees it below zero */                                    \
+        atomic_fetch_add_explicit(&(_stack_->count), 1, memory_order_relaxed);                        \
+                                                                                                      \
+        uint_least64_t top = atomic_load_explicit(&(_stack_->top), memory_order_relaxed);             \
+                                                                                                      \
+        while (true)                                                                                  \
+        {                                                                                             \
+            atomic_store_explicit(&(_stack_->nodes[index].next), CMC_IMPL_CSTACK_INDEX(top),          \
+                                  memory_order_relaxed);                                              \
+                                                                                                      \
+            if (atomic_compare_exchange_weak_explicit(&(_stack_->top), &top,                          \
+                                                      CMC_IMPL_CSTACK_NEXT(top, index),               \
+                                                      memory_order_release, memory_order_relaxed))    \
+                break;                                                                                \
+                                                                                                      \
+            /* Lost the race for the top, a pop might take the node directly */                       \
+            if (PFX##_impl_offer(_stack_, top, index))                                                \
+                break;                                                                                \
+        }                                                                                             \
+                                                                                                      \
+        return true;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    /* Returns false if the stack is empty */                                                         \
+    bool PFX##_pop(struct SNAME *_stack_, V *result)                                                  \
+    {                                                                                                 \
+        uint_least64_t top = atomic_load_explicit(&(_stack_->top), memory_order_acquire);             \
+        uint_least32_t index;                                                                         \
+                                                                                                      \
+        while (true)                                                                                  \
+        {                                                                                             \
+            index = CMC_IMPL_CSTACK_INDEX(top);                                                       \
+                                                                                                      \
+            if (index == CMC_CONCURRENT_STACK_NIL)                                                    \
+                return false;                                                                         \
+                                                                                                      \
+            uint_least32_t next =                                                                     \
+                atomic_load_explicit(&(_stack_->nodes[index].next), memory_order_relaxed);            \
+                                                                                                      \
+            if (atomic_compare_exchange_weak_explicit(&(_stack_->top), &top,                          \
+                                                      CMC_IMPL_CSTACK_NEXT(top, next),                \
+                                                      memory_order_acquire, memory_order_acquire))    \
+                break;                                                                                \
+                                                                                                      \
+            /* Lost the race for the top, a push might have offered a node */                         \
+            index = PFX##_impl_accept(_stack_, top);                                                  \
+                                                                                                      \
+            if (index != CMC_CONCURRENT_STACK_NIL)                                                    \
+                break;                                                                                \
+        }                                                                                             \
+                                                                                                      \
+        if (result)                                                                                   \
+            *result = _stack_->nodes[index].value;                                                    \
+                                                                                                      \
+        atomic_fetch_sub_explicit(&(_stack_->count), 1, memory_order_relaxed);                        \
+                                                                                                      \
+        PFX##_impl_give(_stack_, &(_stack_->unused), index);                                          \
+                                                                                                      \
+        return true;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    bool PFX##_empty(struct SNAME *_stack_)                                                           \
+    {                                                                                                 \
+        uint_least64_t top = atomic_load_explicit(&(_stack_->top), memory_order_relaxed);             \
+                                                                                                      \
+        return CMC_IMPL_CSTACK_INDEX(top) == CMC_CONCURRENT_STACK_NIL;                                \
+    }                                                                                                 \
+                                                                                                      \
+    /* Only exact if no other thread is using the stack */                                            \
+    size_t PFX##_count(struct SNAME *_stack_)                                                         \
+    {                                                                                                 \
+        return atomic_load_explicit(&(_stack_->count), memory_order_relaxed);                         \
+    }                                                                                                 \
+                                                                                                      \
+    size_t PFX##_memory_usage(struct SNAME *_stack_)                                                  \
+    {                                                                                                 \
+        /* The struct takes whole cache lines */                                                      \
+        size_t lines = (sizeof(struct SNAME) + CMC_CACHE_LINE_SIZE - 1) / CMC_CACHE_LINE_SIZE;        \
+        size_t bytes = cmc_alloc_aligned_size(CMC_CACHE_LINE_SIZE, lines * CMC_CACHE_LINE_SIZE);      \
+                                                                                                      \
+        bytes += sizeof(struct SNAME##_node) * _stack_->capacity;                                     \
+                                                                                                      \
+        if (_stack_->slots)                                                                           \
+            bytes += cmc_alloc_aligned_size(CMC_CACHE_LINE_SIZE,                                      \
+                                            sizeof(struct SNAME##_slot) * _stack_->slot_count);       \
+                                                                                                      \
+        return bytes;                                                                                 \
+    }                                                                                                 \
+                                                                                                      \
+    size_t PFX##_capacity(struct SNAME *_stack_)                                                      \
+    {                                                                                                 \
+        return _stack_->capacity;                                                                     \
+    }                                                                                                 \
+                                                                                                      \
+    struct cmc_string PFX##_to_string(struct SNAME *_stack_)                                          \
+    {                                                                                                 \
+        struct cmc_string str;                                                                        \
+        struct SNAME *s_ = _stack_;                                                                   \
+        const char *name = #SNAME;                                                                    \
+                                                                                                      \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_concurrentstack, name, s_, s_->nodes,          \
+                 s_->capacity, PFX##_count(s_), s_->slot_count);                                      \
+                                                                                                      \
+        return str;                                                                                   \
+    }                                                                                                 \
+                                                                                                      \
+    /* Pops the index of the top node of list */                                                      \
+    static uint_least32_t PFX##_impl_take(struct SNAME *_stack_, atomic_uint_least64_t *list)         \
+    {                                                                                                 \
+        uint_least64_t top = atomic_load_explicit(list, memory_order_acquire);                        \
+                                                                                                      \
+        while (true)                                                                                  \
+        {                                                                                             \
+            uint_least32_t index = CMC_IMPL_CSTACK_INDEX(top);                                        \
+                                                                                                      \
+            if (index == CMC_CONCURRENT_STACK_NIL)                                                    \
+                return index;                                                                         \
+                                                                                                      \
+            uint_least32_t next =                                                                     \
+                atomic_load_explicit(&(_stack_->nodes[index].next), memory_order_relaxed);            \
+                                                                                                      \
+            if (atomic_compare_exchange_weak_explicit(list, &top, CMC_IMPL_CSTACK_NEXT(top, next),    \
+                                                      memory_order_acquire, memory_order_acquire))    \
+                return index;                                                                         \
+        }                                                                                             \
+    }                                                                                                 \
+                                                                                                      \
+    /* Pushes the node at index to list */                                                            \
+    static void PFX##_impl_give(struct SNAME *_stack_, atomic_uint_least64_t *list,                   \
+                                uint_least32_t index)                                                 \
+    {                                                                                                 \
+        uint_least64_t top = atomic_load_explicit(list, memory_order_relaxed);                        \
+                                                                                                      \
+        do                                                                                            \
+        {                                                                                             \
+            atomic_store_explicit(&(_stack_->nodes[index].next), CMC_IMPL_CSTACK_INDEX(top),          \
+                                  memory_order_relaxed);                                              \
+        } while (!atomic_compare_exchange_weak_explicit(list, &top, CMC_IMPL_CSTACK_NEXT(top, index), \
+                                                        memory_order_release,                         \
+                                                        memory_order_relaxed));                       \
+    }                                                                                                 \
+                                                                                                      \
+    /* Offers the node at index in the slot picked by the tag of top. Threads */                      \
+    /* that contend for the same top meet at the same slot. Returns true if a */                      \
+    /* pop took the node */                                                                           \
+    static bool PFX##_impl_offer(struct SNAME *_stack_, uint_least64_t top, uint_least32_t index)     \
+    {                                                                                                 \
+        if (_stack_->slot_count == 0)                                                                 \
+            return false;                                                                             \
+                                                                                                      \
+        atomic_uint_least64_t *slot = &(_stack_->slots[(top >> 32) % _stack_->slot_count].offer);     \
+                                                                                                      \
+        uint_least64_t empty = atomic_load_explicit(slot, memory_order_relaxed);                      \
+                                                                                                      \
+        if (CMC_IMPL_CSTACK_INDEX(empty) != CMC_CONCURRENT_STACK_NIL)                                 \
+            return false;                                                                             \
+                                                                                                      \
+        uint_least64_t offer = CMC_IMPL_CSTACK_NEXT(empty, index);                                    \
+                                                                                                      \
+        if (!atomic_compare_exchange_strong_explicit(slot, &empty, offer, memory_order_release,       \
+                                                     memory_order_relaxed))                           \
+            return false;                                                                             \
+                                                                                                      \
+        for (size_t i = 0; i < CMC_CONCURRENT_STACK_SPINS; i++)                                       \
+        {                                                                                             \
+            if (atomic_load_explicit(slot, memory_order_relaxed) != offer)                            \
+                return true;                                                                          \
+        }                                                                                             \
+                                                                                                      \
+        /* Takes the offer back unless a pop took it in the meantime */                               \
+        return !atomic_compare_exchange_strong_explicit(                                              \
+            slot, &offer, CMC_IMPL_CSTACK_NEXT(offer, CMC_CONCURRENT_STACK_NIL),                      \
+            memory_order_relaxed, memory_order_relaxed);                                              \
+    }                                                                                                 \
+                                                                                                      \
+    /* Takes the node offered in the slot picked by the tag of top, if any */                         \
+    static uint_least32_t PFX##_impl_accept(struct SNAME *_stack_, uint_least64_t top)                \
+    {                                                                                                 \
+        if (_stack_->slot_count == 0)                                                                 \
+            return CMC_CONCURRENT_STACK_NIL;                                                          \
+                                                                                                      \
+        atomic_uint_least64_t *slot = &(_stack_->slots[(top >> 32) % _stack_->slot_count].offer);     \
+                                                                                                      \
+        uint_least64_t offer = atomic_load_explicit(slot, memory_order_relaxed);                      \
+        uint_least32_t index = CMC_IMPL_CSTACK_INDEX(offer);                                          \
+                                                                                                      \
+        if (index == CMC_CONCURRENT_STACK_NIL)                                                        \
+            return index;                                                                             \
+                                                                                                      \
+        if (!atomic_compare_exchange_strong_explicit(                                                 \
+                slot, &offer, CMC_IMPL_CSTACK_NEXT(offer, CMC_CONCURRENT_STACK_NIL),                  \
+                memory_order_acquire, memory_order_relaxed))                                          \
+            return CMC_CONCURRENT_STACK_NIL;                                                          \
+                                                                                                      \
+        return index;                                                                                 \
+    }
+
+#endif /* CMC_CONCURRENTSTACK_H */
@@ -0,0 +1,399 @@
+/**
+ * countminsketch.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * CountMinSketch
+ *
+ * A CountMinSketch estimates how many times each element was inserted without
+ * storing the elements. Where a MultiSet needs an entry for every distinct
+ * element, a CountMinSketch uses a fixed table of counters, so streams with
+ * any amount of distinct elements fit in the same memory. An estimate is never
+ * less than the real count. With a width of w and a depth of d, it is more
+ * than the real count by at most e / w times the total of counts with a
+ * probability of at least 1 - exp(-d).
+ *
+ * Two CountMinSketches with the same width, depth and hash function can be
+ * merged, so each thread can count its part of a stream in its own sketch and
+ * the sketches can be added up when they are read.
+ *
+ * Implementation
+ *
+ * The counters are a table of d rows of w 32 bit counters, where w is a power
+ * of two and each row starts at a cache line. The hash of an element, given
+ * by the same size_t (*hash)(V) function used by the HashSet, is mixed by
+ * cmc_hash_u64() and split in two halves that select a counter in each row by
+ * double hashing. Insertions use the conservative update: only the counters
+ * that are below the new estimate of the element are raised to it, which
+ * keeps estimates much closer to the real counts than incrementing all of
+ * them. Counters saturate at UINT32_MAX instead of wrapping around.
+ */
+
+#ifndef CMC_COUNTMINSKETCH_H
+#define CMC_COUNTMINSKETCH_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_growth.h"
+#include "../utl/cmc_math.h"
+#include "../utl/cmc_string.h"
+#include "../utl/hash.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_countminsketch = "%s at %p { counters:%p, width:%" PRIuMAX ", depth:%" PRIuMAX ", total:%" PRIuMAX ", hash:%p }";
+
+/* Rows are aligned to this size */
+#ifndef CMC_CACHE_LINE_SIZE
+#define CMC_CACHE_LINE_SIZE 64
+#endif
+
+/* Maximum amount of rows */
+#define CMC_COUNTMINSKETCH_MAX_DEPTH 16
+
+#ifndef CMC_IMPL_COUNTMINSKETCH_ADD
+#define CMC_IMPL_COUNTMINSKETCH_ADD
+
+/* Sum of two counters that saturates at UINT32_MAX, without branches so that */
+/* loops of it can be vectorized */
+static inline uint32_t cmc_countmin_add(uint32_t a, uint32_t b)
+{
+    uint32_t sum = a + b;
+
+    return sum | (uint32_t)-(uint32_t)(sum < a);
+}
+
+#endif /* CMC_IMPL_COUNTMINSKETCH_ADD */
+
+#define CMC_GENERATE_COUNTMINSKETCH(PFX, SNAME, V)    \
+    CMC_GENERATE_COUNTMINSKETCH_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_COUNTMINSKETCH_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_COUNTMINSKETCH_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_COUNTMINSKETCH_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_COUNTMINSKETCH_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_COUNTMINSKETCH_SOURCE(PFX, SNAME, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_COUNTMINSKETCH_HEADER(PFX, SNAME, V)                           \
+                                                                                    \
+    /* CountMinSketch Structure */                                                  \
+    struct SNAME                                                                    \
+    {                                                                               \
+        /* Table of depth rows of width counters */                                 \
+        uint32_t *counters;                                                         \
+                                                                                    \
+        /* Counters in each row, a power of two */                                  \
+        size_t width;                                                               \
+                                                                                    \
+        /* Amount of rows */                                                        \
+        size_t depth;                                                               \
+                                                                                    \
+        /* Sum of the counts added */                                               \
+        size_t total;                                                               \
+                                                                                    \
+        /* Element hash function */                                                 \
+        size_t (*hash)(V);                                                          \
+                                                                                    \
+        /* Custom allocation functions */                                           \
+        struct cmc_alloc_node *alloc;                                               \
+    };                                                                              \
+                                                                                    \
+    /* Collection Functions */                                                      \
+    /* Collection Allocation and Deallocation */                                    \
+    struct SNAME *PFX##_new(size_t width, size_t depth, size_t (*hash)(V));         \
+    struct SNAME *PFX##_new_custom(size_t width, size_t depth, size_t (*hash)(V),   \
+                                   struct cmc_alloc_node *alloc);                   \
+    struct SNAME *PFX##_new_error(double epsilon, double delta, size_t (*hash)(V)); \
+    void PFX##_clear(struct SNAME *_cms_);                                          \
+    void PFX##_free(struct SNAME *_cms_);                                           \
+    /* Collection Input and Output */                                               \
+    void PFX##_insert(struct SNAME *_cms_, V element);                              \
+    void PFX##_add(struct SNAME *_cms_, V element, uint32_t count);                 \
+    void PFX##_insert_many(struct SNAME *_cms_, V *elements, size_t n);             \
+    /* Element Access */                                                            \
+    size_t PFX##_estimate(struct SNAME *_cms_, V element);                          \
+    /* Collection State */                                                          \
+    CMC_PURE bool PFX##_empty(struct SNAME *_cms_);                                 \
+    size_t PFX##_total(struct SNAME *_cms_);                                        \
+    size_t PFX##_width(struct SNAME *_cms_);                                        \
+    size_t PFX##_depth(struct SNAME *_cms_);                                        \
+    size_t PFX##_memory_usage(struct SNAME *_cms_);                                 \
+    /* Collection Utility */                                                        \
+    struct SNAME *PFX##_copy_of(struct SNAME *_cms_);                               \
+    bool PFX##_equals(struct SNAME *_cms1_, struct SNAME *_cms2_);                  \
+    struct cmc_string PFX##_to_string(struct SNAME *_cms_);                         \
+                                                                                    \
+    /* Set Operations */                                                            \
+    bool PFX##_compatible(struct SNAME *_cms1_, struct SNAME *_cms2_);              \
+    struct SNAME *PFX##_merge(struct SNAME *_cms1_, struct SNAME *_cms2_);          \
+    bool PFX##_merge_into(struct SNAME *_cms1_, struct SNAME *_cms2_);              \
+                                                                                    \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_COUNTMINSKETCH_SOURCE(PFX, SNAME, V)                                      \
+                                                                                               \
+    /* Implementation Detail Functions */                                                      \
+    static void PFX##_impl_cells(struct SNAME *_cms_, V element, uint32_t **cells);            \
+                                                                                               \
+    /* Creates a CountMinSketch with depth rows of at least width counters */                  \
+    struct SNAME *PFX##_new(size_t width, size_t depth, size_t (*hash)(V))                     \
+    {                                                                                          \
+        return PFX##_new_custom(width, depth, hash, NULL);                                     \
+    }                                                                                          \
+                                                                                               \
+    struct SNAME *PFX##_new_custom(size_t width, size_t depth, size_t (*hash)(V),              \
+                                   struct cmc_alloc_node *alloc)                               \
+    {                                                                                          \
+        if (!alloc)                                                                            \
+            alloc = &cmc_alloc_node_default;                                                   \
+                                                                                               \
+        if (width == 0 || depth == 0 || depth > CMC_COUNTMINSKETCH_MAX_DEPTH || !hash)         \
+            return NULL;                                                                       \
+                                                                                               \
+        /* Each row takes whole cache lines */                                                 \
+        size_t line = CMC_CACHE_LINE_SIZE / sizeof(uint32_t);                                  \
+                                                                                               \
+        width = cmc_growth_pow2(width < line ? line : width);                                  \
+                                                                                               \
+        if (width > SIZE_MAX / sizeof(uint32_t) / depth || width > UINT32_MAX)                 \
+            return NULL;                                                                       \
+                                                                                               \
+        struct SNAME *_cms_ = alloc->malloc(sizeof(struct SNAME));                             \
+                                                                                               \
+        if (CMC_UNLIKELY(!_cms_))                                                              \
+            return NULL;                                                                       \
+                                                                                               \
+        _cms_->counters = cmc_alloc_aligned(alloc, CMC_CACHE_LINE_SIZE,                        \
+                                            width * depth * sizeof(uint32_t));                 \
+                                                                                               \
+        if (CMC_UNLIKELY(!_cms_->counters))                                                    \
+        {                                                                                      \
+            alloc->free(_cms_);                                                                \
+            return NULL;                                                                       \
+        }                                                                                      \
+                                                                                               \
+        _cms_->width = width;                                                                  \
+        _cms_->depth = depth;                                                                  \
+        _cms_->hash = hash;                                                                    \
+        _cms_->alloc = alloc;                                                                  \
+                                                                                               \
+        PFX##_clear(_cms_);                                                                    \
+                                                                                               \
+        return _cms_;                                                                          \
+    }                                                                                          \
+                                                                                               \
+    /* Creates a CountMinSketch whose estimates are within epsilon times the */                \
+    /* total of the real counts with a probability of at least 1 - delta */                    \
+    struct SNAME *PFX##_new_error(double epsilon, double delta, size_t (*hash)(V))             \
+    {                                                                                          \
+        if (epsilon <= 0.0 || epsilon >= 1.0 || delta <= 0.0 || delta >= 1.0)                  \
+            return NULL;                                                                       \
+                                                                                               \
+        /* w = e / epsilon and d = ln(1 / delta) */                                            \
+        size_t width = (size_t)(2.71828182845904523536 / epsilon) + 1;                         \
+        size_t depth = (size_t)cmc_math_ln(1.0 / delta) + 1;                                   \
+                                                                                               \
+        return PFX##_new(width, depth, hash);                                                  \
+    }                                                                                          \
+                                                                                               \
+    void PFX##_clear(struct SNAME *_cms_)                                                      \
+    {                                                                                          \
+        memset(_cms_->counters, 0, _cms_->width * _cms_->depth * sizeof(uint32_t));            \
+                                                                                               \
+        _cms_->total = 0;                                                                      \
+    }                                                                                          \
+                                                                                               \
+    void PFX##_free(struct SNAME *_cms_)                                                       \
+    {                                                                                          \
+        cmc_alloc_aligned_free(_cms_->alloc, _cms_->counters);                                 \
+        _cms_->alloc->free(_cms_);                                                             \
+    }                                                                                          \
+                                                                                               \
+    void PFX##_insert(struct SNAME *_cms_, V element)                                          \
+    {                                                                                          \
+        PFX##_add(_cms_, element, 1);                                                          \
+    }                                                                                          \
+                                                                                               \
+    /* Adds count to the count of an element with the conservative update */                   \
+    void PFX##_add(struct SNAME *_cms_, V element, uint32_t count)                             \
+    {                                                                                          \
+        uint32_t *cells[CMC_COUNTMINSKETCH_MAX_DEPTH];                                         \
+        size_t depth = _cms_->depth;                                                           \
+                                                                                               \
+        PFX##_impl_cells(_cms_, element, cells);                                               \
+                                                                                               \
+        uint32_t min = UINT32_MAX;                                                             \
+                                                                                               \
+        for (size_t i = 0; i < depth; i++)                                                     \
+            min = *cells[i] < min ? *cells[i] : min;                                           \
+                                                                                               \
+        uint32_t estimate = cmc_countmin_add(min, count);                                      \
+                                                                                               \
+        for (size_t i = 0; i < depth; i++)                                                     \
+        {                                                                                      \
+            if (*cells[i] < estimate)                                                          \
+                *cells[i] = estimate;                                                          \
+        }                                                                                      \
+                                                                                               \
+        _cms_->total += count;                                                                 \
+    }                                                                                          \
+                                                                                               \
+    void PFX##_insert_many(struct SNAME *_cms_, V *elements, size_t n)                         \
+    {                                                                                          \
+        for (size_t i = 0; i < n; i++)                                                         \
+            PFX##_add(_cms_, elements[i], 1);                                                  \
+    }                                                                                          \
+                                                                                               \
+    /* The least of the counters of an element, never less than its real */                    \
+    /* count */                                                                                \
+    size_t PFX##_estimate(struct SNAME *_cms_, V element)                                      \
+    {                                                                                          \
+        uint32_t *cells[CMC_COUNTMINSKETCH_MAX_DEPTH];                                         \
+        size_t depth = _cms_->depth;                                                           \
+                                                                                               \
+        PFX##_impl_cells(_cms_, element, cells);                                               \
+                                                                                               \
+        uint32_t min = UINT32_MAX;                                                             \
+                                                                                               \
+        for (size_t i = 0; i < depth; i++)                                                     \
+            min = *cells[i] < min ? *cells[i] : min;                                           \
+                                                                                               \
+        return min;                                                                            \
+    }                                                                                          \
+                                                                                               \
+    bool PFX##_empty(struct SNAME *_cms_)                                                      \
+    {                                                                                          \
+        return _cms_->total == 0;                                                              \
+    }                                                                                          \
+                                                                                               \
+    size_t PFX##_total(struct SNAME *_cms_)                                                    \
+    {                                                                                          \
+        return _cms_->total;                                                                   \
+    }                                                                                          \
+                                                                                               \
+    size_t PFX##_width(struct SNAME *_cms_)                                                    \
+    {                                                                                          \
+        return _cms_->width;                                                                   \
+    }                                                                                          \
+                                                                                               \
+    size_t PFX##_depth(struct SNAME *_cms_)                                                    \
+    {                                                                                          \
+        return _cms_->depth;                                                                   \
+    }                                                                                          \
+                                                                                               \
+    size_t PFX##_memory_usage(struct SNAME *_cms_)                                             \
+    {                                                                                          \
+        size_t bytes = _cms_->width * _cms_->depth * sizeof(uint32_t);                         \
+                                                                                               \
+        return sizeof(struct SNAME) + cmc_alloc_aligned_size(CMC_CACHE_LINE_SIZE, bytes);      \
+    }                                                                                          \
+                                                                                               \
+    struct SNAME *PFX##_copy_of(struct SNAME *_cms_)                                           \
+    {                                                                                          \
+        struct SNAME *result =                                                                 \
+            PFX##_new_custom(_cms_->width, _cms_->depth, _cms_->hash, _cms_->alloc);           \
+                                                                                               \
+        if (!result)                                                                           \
+            return NULL;                                                                       \
+                                                                                               \
+        memcpy(result->counters, _cms_->counters,                                              \
+               _cms_->width * _cms_->depth * sizeof(uint32_t));                                \
+                                                                                               \
+        result->total = _cms_->total;                                                          \
+                                                                                               \
+        return result;                                                                         \
+    }                                                                                          \
+                                                                                               \
+    /* Two CountMinSketches are equal if all of their counters are equal */                    \
+    bool PFX##_equals(struct SNAME *_cms1_, struct SNAME *_cms2_)                              \
+    {                                                                                          \
+        if (!PFX##_compatible(_cms1_, _cms2_))                                                 \
+            return false;                                                                      \
+                                                                                               \
+        size_t bytes = _cms1_->width * _cms1_->depth * sizeof(uint32_t);                       \
+                                                                                               \
+        return memcmp(_cms1_->counters, _cms2_->counters, bytes) == 0;                         \
+    }                                                                                          \
+                                                                                               \
+    struct cmc_string PFX##_to_string(struct SNAME *_cms_)                                     \
+    {                                                                                          \
+        struct cmc_string str;                                                                 \
+        struct SNAME *c_ = _cms_;                                                              \
+        const char *name = #SNAME;                                                             \
+                                                                                               \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_countminsketch, name, c_, c_->counters, \
+                 c_->width, c_->depth, c_->total, c_->hash);                                   \
+                                                                                               \
+        return str;                                                                            \
+    }                                                                                          \
+                                                                                               \
+    /* CountMinSketches can only be merged if they map elements to the same */                 \
+    /* counters */                                                                             \
+    bool PFX##_compatible(struct SNAME *_cms1_, struct SNAME *_cms2_)                          \
+    {                                                                                          \
+        return _cms1_->width == _cms2_->width && _cms1_->depth == _cms2_->depth &&             \
+               _cms1_->hash == _cms2_->hash;                                                   \
+    }                                                                                          \
+                                                                                               \
+    /* A new CountMinSketch that counts the elements of both, or NULL if */                    \
+    /* they are not compatible */                                                              \
+    struct SNAME *PFX##_merge(struct SNAME *_cms1_, struct SNAME *_cms2_)                      \
+    {                                                                                          \
+        if (!PFX##_compatible(_cms1_, _cms2_))                                                 \
+            return NULL;                                                                       \
+                                                                                               \
+        struct SNAME *result = PFX##_copy_of(_cms1_);                                          \
+                                                                                               \
+        if (!result)                                                                           \
+            return NULL;                                                                       \
+                                                                                               \
+        PFX##_merge_into(result, _cms2_);                                                      \
+                                                                                               \
+        return result;                                                                         \
+    }                                                                                          \
+                                                                                               \
+    /* Adds the counts of _cms2_ to _cms1_. The estimates stay above the real */               \
+    /* counts, as if every element had been inserted into _cms1_ */                            \
+    bool PFX##_merge_into(struct SNAME *_cms1_, struct SNAME *_cms2_)                          \
+    {                                                                                          \
+        if (!PFX##_compatible(_cms1_, _cms2_))                                                 \
+            return false;                                                                      \
+                                                                                               \
+        size_t cells = _cms1_->width * _cms1_->depth;                                          \
+        uint32_t *c1 = _cms1_->counters;                                                       \
+        uint32_t *c2 = _cms2_->counters;                                                       \
+                                                                                               \
+        for (size_t i = 0; i < cells; i++)                                                     \
+            c1[i] = cmc_countmin_add(c1[i], c2[i]);                                            \
+                                                                                               \
+        _cms1_->total += _cms2_->total;                                                        \
+                                                                                               \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    /* The counter of an element in each row, selected by h1 + i * h2 */                       \
+    static void PFX##_impl_cells(struct SNAME *_cms_, V element, uint32_t **cells)             \
+    {                                                                                          \
+        uint64_t hash = cmc_hash_u64(_cms_->hash(element));                                    \
+                                                                                               \
+        size_t mask = _cms_->width - 1;                                                        \
+        size_t h1 = (size_t)(hash & 0xFFFFFFFF);                                               \
+        size_t h2 = (size_t)(hash >> 32) | 1;                                                  \
+                                                                                               \
+        for (size_t i = 0; i < _cms_->depth; i++)                                              \
+            cells[i] = _cms_->counters + i * _cms_->width + ((h1 + i * h2) & mask);            \
+    }
+
+#endif /* CMC_COUNTMINSKETCH_H */
@@ -0,0 +1,1455 @@
+/**
+ * cuckooset.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * CuckooSet
+ *
+ * A CuckooSet is a set of unique elements with the same uses as the HashSet,
+ * implemented as a bucketized cuckoo hashtable. An element can only be in one
+ * of two buckets of 4 slots, so a lookup compares at most 8 elements and
+ * reads at most two buckets however full the table is. This bounds the cost
+ * of every lookup, even at loads above 90%, where the probes of open
+ * addressing tables get long.
+ *
+ * A CuckooMap maps unique keys to values with the same table. Its values are
+ * kept in a separate array, so the buckets only hold tags and keys and a
+ * value is only read once its key is found.
+ *
+ * Implementation
+ *
+ * Each slot has a one byte tag with 8 bits of the hash of its element, where
+ * 0 marks an empty slot, so only elements with a matching tag are compared.
+ * The first bucket of an element comes from its hash and the second one from
+ * the first and its tag (partial-key cuckoo hashing), so an element can be
+ * moved to its other bucket without being hashed again.
+ *
+ * When both buckets of a new element are full, a breadth first search looks
+ * for the shortest path of moves, each taking an element to its other
+ * bucket, that ends at an empty slot. It visits at most CMC_CUCKOO_SEARCH
+ * buckets, through paths of at most CMC_CUCKOO_PATH buckets. The elements
+ * along the path are then moved starting from its end. The table doubles
+ * once the load factor is reached or when no path is found.
+ *
+ * Elements with the same hash also have the same two buckets, so no more
+ * than 8 of them fit in the table and inserting more fails.
+ */
+
+#ifndef CMC_CUCKOOSET_H
+#define CMC_CUCKOOSET_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_cuckooset = "%s at %p { buffer:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", load:%lf, cmp:%p, hash:%p }";
+static const char *cmc_string_fmt_cuckoomap = "%s at %p { buffer:%p, values:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", load:%lf, cmp:%p, hash:%p }";
+
+#ifndef CMC_IMPL_CUCKOO_SETUP
+#define CMC_IMPL_CUCKOO_SETUP
+
+/* Slots of a bucket. The tags and keys of up to 8 bytes of a bucket fit in */
+/* a cache line */
+#define CMC_CUCKOO_SLOTS 4
+
+/* Most buckets visited by the search for an empty slot */
+#ifndef CMC_CUCKOO_SEARCH
+#define CMC_CUCKOO_SEARCH 512
+#endif
+
+/* Most buckets in a path of moves, counting the one where it starts */
+#ifndef CMC_CUCKOO_PATH
+#define CMC_CUCKOO_PATH 5
+#endif
+
+/* Finalizer from MurmurHash3. The bucket of an element comes from the */
+/* lower bits of its result and the tag from the upper ones */
+static inline size_t cmc_cuckoo_mix(size_t hash)
+{
+    uint64_t h = (uint64_t)hash;
+
+    h ^= h >> 33;
+    h *= UINT64_C(0xff51afd7ed558ccd);
+    h ^= h >> 33;
+    h *= UINT64_C(0xc4ceb9fe1a85ec53);
+    h ^= h >> 33;
+
+    return (size_t)h;
+}
+
+/* Tag of a mixed hash, never 0 since it marks an empty slot */
+static inline uint8_t cmc_cuckoo_tag(size_t mixed)
+{
+    uint8_t tag = (uint8_t)(mixed >> (sizeof(size_t) * 8 - 8));
+
+    return tag != 0 ? tag : 1;
+}
+
+/* Other bucket of an element with tag that is in bucket. It is the same */
+/* function both ways, so it also gives back the first bucket */
+static inline size_t cmc_cuckoo_alt(size_t bucket, uint8_t tag, size_t mask)
+{
+    return (bucket ^ (((size_t)tag + 1) * (size_t)UINT64_C(0xc6a4a7935bd1e995))) & mask;
+}
+
+/* Amount of buckets, a power of two, with at least required slots or 0 if */
+/* there can't be as many */
+static inline size_t cmc_cuckoo_buckets(size_t required)
+{
+    size_t buckets = 2;
+
+    while (buckets * CMC_CUCKOO_SLOTS < required)
+    {
+        if (buckets > SIZE_MAX / CMC_CUCKOO_SLOTS / 4)
+            return 0;
+
+        buckets *= 2;
+    }
+
+    return buckets;
+}
+
+/* A slot of a bucket in a path of moves */
+struct cmc_cuckoo_step
+{
+    size_t bucket;
+    size_t slot;
+};
+
+/* A bucket reached by the search */
+struct cmc_cuckoo_node
+{
+    size_t bucket;
+
+    /* Node it was reached from, whose element at slot moves to this one */
+    uint32_t parent;
+    uint8_t slot;
+
+    /* Moves from the first two buckets */
+    uint8_t depth;
+};
+
+/* Breadth first search for an empty slot from the buckets b1 and b2. Each */
+/* bucket is stride bytes that start with the tags of its slots. Writes to */
+/* path the steps from b1 or b2 to the empty slot, where the element at */
+/* each step is to be moved to the next one, and returns how many steps */
+/* there are or 0 if no empty slot was found */
+static inline size_t cmc_cuckoo_search(const void *buckets, size_t stride, size_t mask,
+                                       size_t b1, size_t b2,
+                                       struct cmc_cuckoo_step path[CMC_CUCKOO_PATH])
+{
+    struct cmc_cuckoo_node nodes[CMC_CUCKOO_SEARCH];
+
+    size_t head = 0;
+    size_t tail = 0;
+
+    nodes[tail++] = (struct cmc_cuckoo_node){ b1, UINT32_MAX, 0, 0 };
+
+    if (b2 != b1)
+        nodes[tail++] = (struct cmc_cuckoo_node){ b2, UINT32_MAX, 0, 0 };
+
+    for (; head < tail; head++)
+    {
+        struct cmc_cuckoo_node *node = &nodes[head];
+        const uint8_t *tags = (const uint8_t *)buckets + node->bucket * stride;
+
+        for (size_t s = 0; s < CMC_CUCKOO_SLOTS; s++)
+        {
+            if (tags[s] != 0)
+                continue;
+
+            size_t length = (size_t)node->depth + 1;
+
+            path[node->depth].bucket = node->bucket;
+            path[node->depth].slot = s;
+
+            for (; node->parent != UINT32_MAX; node = &nodes[node->parent])
+            {
+                path[node->depth - 1].bucket = nodes[node->parent].bucket;
+                path[node->depth - 1].slot = node->slot;
+            }
+
+            return length;
+        }
+
+        if (node->depth + 1 >= CMC_CUCKOO_PATH)
+            continue;
+
+        for (size_t s = 0; s < CMC_CUCKOO_SLOTS && tail < CMC_CUCKOO_SEARCH; s++)
+        {
+            size_t alt = cmc_cuckoo_alt(node->bucket, tags[s], mask);
+
+            if (alt != node->bucket)
+                nodes[tail++] = (struct cmc_cuckoo_node){ alt, (uint32_t)head, (uint8_t)s,
+                                                          (uint8_t)(node->depth + 1) };
+        }
+    }
+
+    return 0;
+}
+
+#endif /* CMC_IMPL_CUCKOO_SETUP */
+
+#define CMC_GENERATE_CUCKOOSET(PFX, SNAME, V)    \
+    CMC_GENERATE_CUCKOOSET_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_CUCKOOSET_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_CUCKOOSET_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_CUCKOOSET_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_CUCKOOSET_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_CUCKOOSET_SOURCE(PFX, SNAME, V)
+
+#define CMC_GENERATE_CUCKOOMAP(PFX, SNAME, K, V)    \
+    CMC_GENERATE_CUCKOOMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_CUCKOOMAP_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_CUCKOOMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_CUCKOOMAP_HEADER(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_CUCKOOMAP_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_CUCKOOMAP_SOURCE(PFX, SNAME, K, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_CUCKOOSET_HEADER(PFX, SNAME, V)                                   \
+                                                                                       \
+    /* CuckooSet Structure */                                                          \
+    struct SNAME                                                                       \
+    {                                                                                  \
+        /* Buckets of elements */                                                      \
+        struct SNAME##_bucket *buffer;                                                 \
+                                                                                       \
+        /* Amount of slots, a power of two */                                          \
+        size_t capacity;                                                               \
+                                                                                       \
+        /* Current amount of elements */                                               \
+        size_t count;                                                                  \
+                                                                                       \
+        /* Load factor in range (0.0, 1.0) */                                          \
+        double load;                                                                   \
+                                                                                       \
+        /* Element comparison function */                                              \
+        int (*cmp)(V, V);                                                              \
+                                                                                       \
+        /* Element hash function */                                                    \
+        size_t (*hash)(V);                                                             \
+                                                                                       \
+        /* Custom allocation functions */                                              \
+        struct cmc_alloc_node *alloc;                                                  \
+    };                                                                                 \
+                                                                                       \
+    /* A bucket of slots, where a slot is empty if its tag is 0 */                     \
+    struct SNAME##_bucket                                                              \
+    {                                                                                  \
+        uint8_t tags[CMC_CUCKOO_SLOTS];                                                \
+        V values[CMC_CUCKOO_SLOTS];                                                    \
+    };                                                                                 \
+                                                                                       \
+    /* CuckooSet Iterator */                                                           \
+    struct SNAME##_iter                                                                \
+    {                                                                                  \
+        /* Target set */                                                               \
+        struct SNAME *target;                                                          \
+                                                                                       \
+        /* Slot of the current element */                                              \
+        size_t cursor;                                                                 \
+                                                                                       \
+        /* Amount of elements before the current one */                                \
+        size_t index;                                                                  \
+                                                                                       \
+        /* If the iterator has reached the start of the iteration */                   \
+        bool start;                                                                    \
+                                                                                       \
+        /* If the iterator has reached the end of the iteration */                     \
+        bool end;                                                                      \
+    };                                                                                 \
+                                                                                       \
+    /* Collection Functions */                                                         \
+    /* Collection Allocation and Deallocation */                                       \
+    struct SNAME *PFX##_new(size_t capacity, double load, int (*compare)(V, V),        \
+                            size_t (*hash)(V));                                        \
+    struct SNAME *PFX##_new_custom(size_t capacity, double load, int (*compare)(V, V), \
+                                   size_t (*hash)(V), struct cmc_alloc_node *alloc);   \
+    void PFX##_clear(struct SNAME *_set_, void (*deallocator)(V));                     \
+    void PFX##_free(struct SNAME *_set_, void (*deallocator)(V));                      \
+    /* Collection Input and Output */                                                  \
+    bool PFX##_insert(struct SNAME *_set_, V element);                                 \
+    bool PFX##_remove(struct SNAME *_set_, V element);                                 \
+    /* Collection State */                                                             \
+    bool PFX##_contains(struct SNAME *_set_, V element);                               \
+    CMC_PURE bool PFX##_empty(struct SNAME *_set_);                                    \
+    CMC_PURE size_t PFX##_count(struct SNAME *_set_);                                  \
+    size_t PFX##_capacity(struct SNAME *_set_);                                        \
+    double PFX##_load(struct SNAME *_set_);                                            \
+    size_t PFX##_memory_usage(struct SNAME *_set_);                                    \
+    /* Collection Utility */                                                           \
+    struct SNAME *PFX##_copy_of(struct SNAME *_set_, V (*copy_func)(V));               \
+    bool PFX##_equals(struct SNAME *_set1_, struct SNAME *_set2_);                     \
+    struct cmc_string PFX##_to_string(struct SNAME *_set_);                            \
+                                                                                       \
+    /* Iterator Functions */                                                           \
+    /* Iterator Allocation and Deallocation */                                         \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target);                         \
+    void PFX##_iter_free(struct SNAME##_iter *iter);                                   \
+    /* Iterator Initialization */                                                      \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);             \
+    /* Iterator State */                                                               \
+    bool PFX##_iter_start(struct SNAME##_iter *iter);                                  \
+    bool PFX##_iter_end(struct SNAME##_iter *iter);                                    \
+    /* Iterator Movement */                                                            \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter);                               \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter);                                 \
+    bool PFX##_iter_next(struct SNAME##_iter *iter);                                   \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter);                                   \
+    /* Iterator Access */                                                              \
+    V PFX##_iter_value(struct SNAME##_iter *iter);                                     \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter);
+
+#define CMC_GENERATE_CUCKOOMAP_HEADER(PFX, SNAME, K, V)                                \
+                                                                                       \
+    /* CuckooMap Structure */                                                          \
+    struct SNAME                                                                       \
+    {                                                                                  \
+        /* Buckets of keys */                                                          \
+        struct SNAME##_bucket *buffer;                                                 \
+                                                                                       \
+        /* Value of the key at each slot */                                            \
+        V *values;                                                                     \
+                                                                                       \
+        /* Amount of slots, a power of two */                                          \
+        size_t capacity;                                                               \
+                                                                                       \
+        /* Current amount of keys */                                                   \
+        size_t count;                                                                  \
+                                                                                       \
+        /* Load factor in range (0.0, 1.0) */                                          \
+        double load;                                                                   \
+                                                                                       \
+        /* Key comparison function */                                                  \
+        int (*cmp)(K, K);                                                              \
+                                                                                       \
+        /* Key hash function */                                                        \
+        size_t (*hash)(K);                                                             \
+                                                                                       \
+        /* Custom allocation functions */                                              \
+        struct cmc_alloc_node *alloc;                                                  \
+    };                                                                                 \
+                                                                                       \
+    /* A bucket of slots, where a slot is empty if its tag is 0 */                     \
+    struct SNAME##_bucket                                                              \
+    {                                                                                  \
+        uint8_t tags[CMC_CUCKOO_SLOTS];                                                \
+        K keys[CMC_CUCKOO_SLOTS];                                                      \
+    };                                                                                 \
+                                                                                       \
+    /* CuckooMap Iterator */                                                           \
+    struct SNAME##_iter                                                                \
+    {                                                                                  \
+        /* Target map */                                                               \
+        struct SNAME *target;                                                          \
+                                                                                       \
+        /* Slot of the current key */                                                  \
+        size_t cursor;                                                                 \
+                                                                                       \
+        /* Amount of keys before the current one */                                    \
+        size_t index;                                                                  \
+                                                                                       \
+        /* If the iterator has reached the start of the iteration */                   \
+        bool start;                                                                    \
+                                                                                       \
+        /* If the iterator has reached the end of the iteration */                     \
+        bool end;                                                                      \
+    };                                                                                 \
+                                                                                       \
+    /* Collection Functions */                                                         \
+    /* Collection Allocation and Deallocation */                                       \
+    struct SNAME *PFX##_new(size_t capacity, double load, int (*compare)(K, K),        \
+                            size_t (*hash)(K));                                        \
+    struct SNAME *PFX##_new_custom(size_t capacity, double load, int (*compare)(K, K), \
+                                   size_t (*hash)(K), struct cmc_alloc_node *alloc);   \
+    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V));                  \
+    void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V));                   \
+    /* Collection Input and Output */                                                  \
+    bool PFX##_insert(struct SNAME *_map_, K key, V value);                            \
+    bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value);          \
+    bool PFX##_remove(struct SNAME *_map_, K key, V *out_value);                       \
+    /* Element Access */                                                               \
+    V PFX##_get(struct SNAME *_map_, K key);                                           \
+    V *PFX##_get_ref(struct SNAME *_map_, K key);                                      \
+    /* Collection State */                                                             \
+    bool PFX##_contains(struct SNAME *_map_, K key);                                   \
+    CMC_PURE bool PFX##_empty(struct SNAME *_map_);                                    \
+    CMC_PURE size_t PFX##_count(struct SNAME *_map_);                                  \
+    size_t PFX##_capacity(struct SNAME *_map_);                                        \
+    double PFX##_load(struct SNAME *_map_);                                            \
+    size_t PFX##_memory_usage(struct SNAME *_map_);                                    \
+    /* Collection Utility */                                                           \
+    struct SNAME *PFX##_copy_of(struct SNAME *_map_, K (*key_copy_func)(K),            \
+                                V (*value_copy_func)(V));                              \
+    bool PFX##_equals(struct SNAME *_map1_, struct SNAME *_map2_,                      \
+                      int (*value_comparator)(V, V));                                  \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_);                            \
+                                                                                       \
+    /* Iterator Functions */                                                           \
+    /* Iterator Allocation and Deallocation */                                         \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target);                         \
+    void PFX##_iter_free(struct SNAME##_iter *iter);                                   \
+    /* Iterator Initialization */                                                      \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);             \
+    /* Iterator State */                                                               \
+    bool PFX##_iter_start(struct SNAME##_iter *iter);                                  \
+    bool PFX##_iter_end(struct SNAME##_iter *iter);                                    \
+    /* Iterator Movement */                                                            \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter);                               \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter);                                 \
+    bool PFX##_iter_next(struct SNAME##_iter *iter);                                   \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter);                                   \
+    /* Iterator Access */                                                              \
+    K PFX##_iter_key(struct SNAME##_iter *iter);                                       \
+    V PFX##_iter_value(struct SNAME##_iter *iter);                                     \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter);                                   \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter);
+
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_CUCKOOSET_SOURCE(PFX, SNAME, V)                                                  \
+                                                                                                      \
+    /* Implementation Detail Functions */                                                             \
+    static bool PFX##_impl_find(struct SNAME *_set_, V element, size_t mixed, size_t *slot);          \
+    static bool PFX##_impl_place(struct SNAME *_set_, V element, size_t mixed);                       \
+    static bool PFX##_impl_rehash(struct SNAME *_set_, size_t buckets);                               \
+    static size_t PFX##_impl_next_slot(struct SNAME *_set_, size_t from);                             \
+    static size_t PFX##_impl_prev_slot(struct SNAME *_set_, size_t from);                             \
+                                                                                                      \
+    struct SNAME *PFX##_new(size_t capacity, double load, int (*compare)(V, V),                       \
+                            size_t (*hash)(V))                                                        \
+    {                                                                                                 \
+        return PFX##_new_custom(capacity, load, compare, hash, NULL);                                 \
+    }                                                                                                 \
+                                                                                                      \
+    struct SNAME *PFX##_new_custom(size_t capacity, double load, int (*compare)(V, V),                \
+                                   size_t (*hash)(V), struct cmc_alloc_node *alloc)                   \
+    {                                                                                                 \
+        if (!alloc)                                                                                   \
+            alloc = &cmc_alloc_node_default;                                                          \
+                                                                                                      \
+        if (capacity == 0 || load <= 0 || load >= 1)                                                  \
+            return NULL;                                                                              \
+                                                                                                      \
+        /* Prevent integer overflow */                                                                \
+        if (capacity >= UINTMAX_MAX * load)                                                           \
+            return NULL;                                                                              \
+                                                                                                      \
+        size_t buckets = cmc_cuckoo_buckets(capacity / load);                                         \
+                                                                                                      \
+        if (buckets == 0)                                                                             \
+            return NULL;                                                                              \
+                                                                                                      \
+        struct SNAME *_set_ = alloc->malloc(sizeof(struct SNAME));                                    \
+                                                                                                      \
+        if (CMC_UNLIKELY(!_set_))                                                                     \
+            return NULL;                                                                              \
+                                                                                                      \
+        _set_->buffer = alloc->calloc(buckets, sizeof(struct SNAME##_bucket));                        \
+                                                                                                      \
+        if (CMC_UNLIKELY(!_set_->buffer))                                                             \
+        {                                                                                             \
+            alloc->free(_set_);                                                                       \
+            return NULL;                                                                              \
+        }                                                                                             \
+                                                                                                      \
+        _set_->capacity = buckets * CMC_CUCKOO_SLOTS;                                                 \
+        _set_->count = 0;                                                                             \
+        _set_->load = load;                                                                           \
+        _set_->cmp = compare;                                                                         \
+        _set_->hash = hash;                                                                           \
+        _set_->alloc = alloc;                                                                         \
+                                                                                                      \
+        return _set_;                                                                                 \
+    }                                                                                                 \
+                                                                                                      \
+    void PFX##_clear(struct SNAME *_set_, void (*deallocator)(V))                                     \
+    {                                                                                                 \
+        size_t buckets = _set_->capacity / CMC_CUCKOO_SLOTS;                                          \
+                                                                                                      \
+        if (deallocator)                                                                              \
+        {                                                                                             \
+            for (size_t i = 0; i < _set_->capacity; i++)                                              \
+            {                                                                                         \
+                struct SNAME##_bucket *bucket = &(_set_->buffer[i / CMC_CUCKOO_SLOTS]);               \
+                                                                                                      \
+                if (bucket->tags[i % CMC_CUCKOO_SLOTS] != 0)                                          \
+                    deallocator(bucket->values[i % CMC_CUCKOO_SLOTS]);                                \
+            }                                                                                         \
+        }                                                                                             \
+                                                                                                      \
+        memset(_set_->buffer, 0, buckets * sizeof(struct SNAME##_bucket));                            \
+                                                                                                      \
+        _set_->count = 0;                                                                             \
+    }                                                                                                 \
+                                                                                                      \
+    void PFX##_free(struct SNAME *_set_, void (*deallocator)(V))                                      \
+    {                                                                                                 \
+        if (deallocator)                                                                              \
+            PFX##_clear(_set_, deallocator);                                                          \
+                                                                                                      \
+        _set_->alloc->free(_set_->buffer);                                                            \
+        _set_->alloc->free(_set_);                                                                    \
+    }                                                                                                 \
+                                                                                                      \
+    /* Returns false if the element was already in the set or if it could */                          \
+    /* not be inserted */                                                                             \
+    bool PFX##_insert(struct SNAME *_set_, V element)                                                 \
+    {                                                                                                 \
+        size_t slot;                                                                                  \
+        size_t mixed = cmc_cuckoo_mix(_set_->hash(element));                                          \
+                                                                                                      \
+        if (PFX##_impl_find(_set_, element, mixed, &slot))                                            \
+            return false;                                                                             \
+                                                                                                      \
+        if ((double)(_set_->count + 1) > (double)_set_->capacity * _set_->load)                       \
+        {                                                                                             \
+            if (!PFX##_impl_rehash(_set_, _set_->capacity / CMC_CUCKOO_SLOTS * 2))                    \
+                return false;                                                                         \
+        }                                                                                             \
+                                                                                                      \
+        while (!PFX##_impl_place(_set_, element, mixed))                                              \
+        {                                                                                             \
+            /* At a low load a path is only missing when the two buckets */                           \
+            /* are full of elements with the same hash, that no growth */                             \
+            /* can split */                                                                           \
+            if (_set_->count < _set_->capacity / 2)                                                   \
+                return false;                                                                         \
+                                                                                                      \
+            if (!PFX##_impl_rehash(_set_, _set_->capacity / CMC_CUCKOO_SLOTS * 2))                    \
+                return false;                                                                         \
+        }                                                                                             \
+                                                                                                      \
+        _set_->count++;                                                                               \
+                                                                                                      \
+        return true;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    bool PFX##_remove(struct SNAME *_set_, V element)                                                 \
+    {                                                                                                 \
+        size_t slot;                                                                                  \
+                                                                                                      \
+        if (!PFX##_impl_find(_set_, element, cmc_cuckoo_mix(_set_->hash(element)), &slot))            \
+            return false;                                                                             \
+                                                                                                      \
+        _set_->buffer[slot / CMC_CUCKOO_SLOTS].tags[slot % CMC_CUCKOO_SLOTS] = 0;                     \
+        _set_->count--;                                                                               \
+                                                                                                      \
+        return true;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    bool PFX##_contains(struct SNAME *_set_, V element)                                               \
+    {                                                                                                 \
+        size_t slot;                                                                                  \
+                                                                                                      \
+        return PFX##_impl_find(_set_, element, cmc_cuckoo_mix(_set_->hash(element)), &slot);          \
+    }                                                                                                 \
+                                                                                                      \
+    bool PFX##_empty(struct SNAME *_set_)                                                             \
+    {                                                                                                 \
+        return _set_->count == 0;                                                                     \
+    }                                                                                                 \
+                                                                                                      \
+    size_t PFX##_count(struct SNAME *_set_)                                                           \
+    {                                                                                                 \
+        return _set_->count;                                                                          \
+    }                                                                                                 \
+                                                                                                      \
+    size_t PFX##_capacity(struct SNAME *_set_)                                                        \
+    {                                                                                                 \
+        return _set_->capacity;                                                                       \
+    }                                                                                                 \
+                                                                                                      \
+    double PFX##_load(struct SNAME *_set_)                                                            \
+    {                                                                                                 \
+        return _set_->load;                                                                           \
+    }                                                                                                 \
+                                                                                                      \
+    size_t PFX##_memory_usage(struct SNAME *_set_)                                                    \
+    {                                                                                                 \
+        return sizeof(struct SNAME) +                                                                 \
+               _set_->capacity / CMC_CUCKOO_SLOTS * sizeof(struct SNAME##_bucket);                    \
+    }                                                                                                 \
+                                                                                                      \
+    /* The copy has the same buckets, so its elements are not hashed again */                         \
+    struct SNAME *PFX##_copy_of(struct SNAME *_set_, V (*copy_func)(V))                               \
+    {                                                                                                 \
+        struct SNAME *result = PFX##_new_custom(1, _set_->load,                                       \
+                                                _set_->cmp, _set_->hash, _set_->alloc);               \
+                                                                                                      \
+        if (CMC_UNLIKELY(!result))                                                                    \
+            return NULL;                                                                              \
+                                                                                                      \
+        if (result->capacity != _set_->capacity &&                                                    \
+            !PFX##_impl_rehash(result, _set_->capacity / CMC_CUCKOO_SLOTS))                           \
+        {                                                                                             \
+            PFX##_free(result, NULL);                                                                 \
+            return NULL;                                                                              \
+        }                                                                                             \
+                                                                                                      \
+        size_t buckets = _set_->capacity / CMC_CUCKOO_SLOTS;                                          \
+                                                                                                      \
+        memcpy(result->buffer, _set_->buffer, buckets * sizeof(struct SNAME##_bucket));               \
+                                                                                                      \
+        if (copy_func)                                                                                \
+        {                                                                                             \
+            for (size_t i = 0; i < _set_->capacity; i++)                                              \
+            {                                                                                         \
+                struct SNAME##_bucket *bucket = &(result->buffer[i / CMC_CUCKOO_SLOTS]);              \
+                                                                                                      \
+                if (bucket->tags[i % CMC_CUCKOO_SLOTS] != 0)                                          \
+                    bucket->values[i % CMC_CUCKOO_SLOTS] =                                            \
+                        copy_func(bucket->values[i % CMC_CUCKOO_SLOTS]);                              \
+            }                                                                                         \
+        }                                                                                             \
+                                                                                                      \
+        result->count = _set_->count;                                                                 \
+                                                                                                      \
+        return result;                                                                                \
+    }                                                                                                 \
+                                                                                                      \
+    bool PFX##_equals(struct SNAME *_set1_, struct SNAME *_set2_)                                     \
+    {                                                                                                 \
+        if (_set1_->count != _set2_->count)                                                           \
+            return false;                                                                             \
+                                                                                                      \
+        for (size_t i = 0; i < _set1_->capacity; i++)                                                 \
+        {                                                                                             \
+            struct SNAME##_bucket *bucket = &(_set1_->buffer[i / CMC_CUCKOO_SLOTS]);                  \
+                                                                                                      \
+            if (bucket->tags[i % CMC_CUCKOO_SLOTS] != 0 &&                                            \
+                !PFX##_contains(_set2_, bucket->values[i % CMC_CUCKOO_SLOTS]))                        \
+                return false;                                                                         \
+        }                                                                                             \
+                                                                                                      \
+        return true;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    struct cmc_string PFX##_to_string(struct SNAME *_set_)                                            \
+    {                                                                                                 \
+        struct cmc_string str;                                                                        \
+        struct SNAME *s_ = _set_;                                                                     \
+        const char *name = #SNAME;                                                                    \
+                                                                                                      \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_cuckooset, name, s_, s_->buffer,               \
+                 s_->capacity, s_->count, s_->load, s_->cmp, s_->hash);                               \
+                                                                                                      \
+        return str;                                                                                   \
+    }                                                                                                 \
+                                                                                                      \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                         \
+    {                                                                                                 \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));               \
+                                                                                                      \
+        if (CMC_UNLIKELY(!iter))                                                                      \
+            return NULL;                                                                              \
+                                                                                                      \
+        PFX##_iter_init(iter, target);                                                                \
+                                                                                                      \
+        return iter;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    void PFX##_iter_free(struct SNAME##_iter *iter)                                                   \
+    {                                                                                                 \
+        iter->target->alloc->free(iter);                                                              \
+    }                                                                                                 \
+                                                                                                      \
+    /* Iterates in the order of the slots */                                                          \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                             \
+    {                                                                                                 \
+        iter->target = target;                                                                        \
+        iter->cursor = PFX##_impl_next_slot(target, 0);                                               \
+        iter->index = 0;                                                                              \
+        iter->start = true;                                                                           \
+        iter->end = PFX##_empty(target);                                                              \
+    }                                                                                                 \
+                                                                                                      \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                                  \
+    {                                                                                                 \
+        return PFX##_empty(iter->target) || iter->start;                                              \
+    }                                                                                                 \
+                                                                                                      \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                                    \
+    {                                                                                                 \
+        return PFX##_empty(iter->target) || iter->end;                                                \
+    }                                                                                                 \
+                                                                                                      \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                               \
+    {                                                                                                 \
+        if (!PFX##_empty(iter->target))                                                               \
+        {                                                                                             \
+            iter->cursor = PFX##_impl_next_slot(iter->target, 0);                                     \
+            iter->index = 0;                                                                          \
+            iter->start = true;                                                                       \
+            iter->end = false;                                                                        \
+        }                                                                                             \
+    }                                                                                                 \
+                                                                                                      \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                                 \
+    {                                                                                                 \
+        if (!PFX##_empty(iter->target))                                                               \
+        {                                                                                             \
+            iter->cursor = PFX##_impl_prev_slot(iter->target, iter->target->capacity - 1);            \
+            iter->index = iter->target->count - 1;                                                    \
+            iter->start = false;                                                                      \
+            iter->end = true;                                                                         \
+        }                                                                                             \
+    }                                                                                                 \
+                                                                                                      \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                                   \
+    {                                                                                                 \
+        if (iter->end)                                                                                \
+            return false;                                                                             \
+                                                                                                      \
+        if (iter->index + 1 == iter->target->count)                                                   \
+        {                                                                                             \
+            iter->end = true;                                                                         \
+            return false;                                                                             \
+        }                                                                                             \
+                                                                                                      \
+        iter->start = false;                                                                          \
+        iter->cursor = PFX##_impl_next_slot(iter->target, iter->cursor + 1);                          \
+        iter->index++;                                                                                \
+                                                                                                      \
+        return true;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                                   \
+    {                                                                                                 \
+        if (iter->start)                                                                              \
+            return false;                                                                             \
+                                                                                                      \
+        if (iter->index == 0)                                                                         \
+        {                                                                                             \
+            iter->start = true;                                                                       \
+            return false;                                                                             \
+        }                                                                                             \
+                                                                                                      \
+        iter->end = false;                                                                            \
+        iter->cursor = PFX##_impl_prev_slot(iter->target, iter->cursor - 1);                          \
+        iter->index--;                                                                                \
+                                                                                                      \
+        return true;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                                     \
+    {                                                                                                 \
+        if (PFX##_empty(iter->target))                                                                \
+            return (V){0};                                                                            \
+                                                                                                      \
+        size_t cursor = iter->cursor;                                                                 \
+                                                                                                      \
+        return iter->target->buffer[cursor / CMC_CUCKOO_SLOTS].values[cursor % CMC_CUCKOO_SLOTS];     \
+    }                                                                                                 \
+                                                                                                      \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                                \
+    {                                                                                                 \
+        return iter->index;                                                                           \
+    }                                                                                                 \
+                                                                                                      \
+    /* Looks for element in its two buckets and sets slot to where it is */                           \
+    static bool PFX##_impl_find(struct SNAME *_set_, V element, size_t mixed, size_t *slot)           \
+    {                                                                                                 \
+        size_t mask = _set_->capacity / CMC_CUCKOO_SLOTS - 1;                                         \
+        uint8_t tag = cmc_cuckoo_tag(mixed);                                                          \
+        size_t b = mixed & mask;                                                                      \
+                                                                                                      \
+        for (int i = 0; i < 2; i++, b = cmc_cuckoo_alt(b, tag, mask))                                 \
+        {                                                                                             \
+            struct SNAME##_bucket *bucket = &(_set_->buffer[b]);                                      \
+                                                                                                      \
+            for (size_t s = 0; s < CMC_CUCKOO_SLOTS; s++)                                             \
+            {                                                                                         \
+                if (bucket->tags[s] == tag && _set_->cmp(bucket->values[s], element) == 0)            \
+                {                                                                                     \
+                    *slot = b * CMC_CUCKOO_SLOTS + s;                                                 \
+                    return true;                                                                      \
+                }                                                                                     \
+            }                                                                                         \
+        }                                                                                             \
+                                                                                                      \
+        return false;                                                                                 \
+    }                                                                                                 \
+                                                                                                      \
+    /* Frees a slot in one of the two buckets of element, moving others */                            \
+    /* along the path found by the search, and puts element there. Fails */                           \
+    /* when no path is found or when a move on it is no longer valid, which */                        \
+    /* can happen when the path goes through a bucket twice */                                        \
+    static bool PFX##_impl_place(struct SNAME *_set_, V element, size_t mixed)                        \
+    {                                                                                                 \
+        size_t mask = _set_->capacity / CMC_CUCKOO_SLOTS - 1;                                         \
+        uint8_t tag = cmc_cuckoo_tag(mixed);                                                          \
+        size_t b1 = mixed & mask;                                                                     \
+        size_t b2 = cmc_cuckoo_alt(b1, tag, mask);                                                    \
+                                                                                                      \
+        struct cmc_cuckoo_step path[CMC_CUCKOO_PATH];                                                 \
+                                                                                                      \
+        size_t length = cmc_cuckoo_search(_set_->buffer, sizeof(struct SNAME##_bucket), mask,         \
+                                          b1, b2, path);                                              \
+                                                                                                      \
+        if (length == 0)                                                                              \
+            return false;                                                                             \
+                                                                                                      \
+        for (size_t i = length - 1; i > 0; i--)                                                       \
+        {                                                                                             \
+            struct SNAME##_bucket *from = &(_set_->buffer[path[i - 1].bucket]);                       \
+            struct SNAME##_bucket *to = &(_set_->buffer[path[i].bucket]);                             \
+            size_t fs = path[i - 1].slot;                                                             \
+            size_t ts = path[i].slot;                                                                 \
+                                                                                                      \
+            if (to->tags[ts] != 0 || from->tags[fs] == 0 ||                                           \
+                cmc_cuckoo_alt(path[i - 1].bucket, from->tags[fs], mask) != path[i].bucket)           \
+                return false;                                                                         \
+                                                                                                      \
+            to->tags[ts] = from->tags[fs];                                                            \
+            to->values[ts] = from->values[fs];                                                        \
+            from->tags[fs] = 0;                                                                       \
+        }                                                                                             \
+                                                                                                      \
+        struct SNAME##_bucket *bucket = &(_set_->buffer[path[0].bucket]);                             \
+                                                                                                      \
+        bucket->tags[path[0].slot] = tag;                                                             \
+        bucket->values[path[0].slot] = element;                                                       \
+                                                                                                      \
+        return true;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    /* Moves every element to a table with the given amount of buckets, */                            \
+    /* leaving the set as it was if any of them can't be placed */                                    \
+    static bool PFX##_impl_rehash(struct SNAME *_set_, size_t buckets)                                \
+    {                                                                                                 \
+        if (buckets > SIZE_MAX / CMC_CUCKOO_SLOTS / 4)                                                \
+            return false;                                                                             \
+                                                                                                      \
+        struct SNAME##_bucket *buffer = _set_->alloc->calloc(buckets, sizeof(struct SNAME##_bucket)); \
+                                                                                                      \
+        if (CMC_UNLIKELY(!buffer))                                                                    \
+            return false;                                                                             \
+                                                                                                      \
+        struct SNAME grown = *_set_;                                                                  \
+                                                                                                      \
+        grown.buffer = buffer;                                                                        \
+        grown.capacity = buckets * CMC_CUCKOO_SLOTS;                                                  \
+                                                                                                      \
+        for (size_t i = 0; i < _set_->capacity; i++)                                                  \
+        {                                                                                             \
+            struct SNAME##_bucket *bucket = &(_set_->buffer[i / CMC_CUCKOO_SLOTS]);                   \
+                                                                                                      \
+            if (bucket->tags[i % CMC_CUCKOO_SLOTS] == 0)                                              \
+                continue;                                                                             \
+                                                                                                      \
+            V element = bucket->values[i % CMC_CUCKOO_SLOTS];                                         \
+                                                                                                      \
+            if (!PFX##_impl_place(&grown, element, cmc_cuckoo_mix(_set_->hash(element))))             \
+            {                                                                                         \
+                _set_->alloc->free(buffer);                                                           \
+                return false;                                                                         \
+            }                                                                                         \
+        }                                                                                             \
+                                                                                                      \
+        _set_->alloc->free(_set_->buffer);                                                            \
+                                                                                                      \
+        _set_->buffer = buffer;                                                                       \
+        _set_->capacity = grown.capacity;                                                             \
+                                                                                                      \
+        return true;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    /* First occupied slot from the given one on */                                                   \
+    static size_t PFX##_impl_next_slot(struct SNAME *_set_, size_t from)                              \
+    {                                                                                                 \
+        for (; from < _set_->capacity; from++)                                                        \
+        {                                                                                             \
+            if (_set_->buffer[from / CMC_CUCKOO_SLOTS].tags[from % CMC_CUCKOO_SLOTS] != 0)            \
+                break;                                                                                \
+        }                                                                                             \
+                                                                                                      \
+        return from;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    /* Last occupied slot from the given one back */                                                  \
+    static size_t PFX##_impl_prev_slot(struct SNAME *_set_, size_t from)                              \
+    {                                                                                                 \
+        for (; from > 0; from--)                                                                      \
+        {                                                                                             \
+            if (_set_->buffer[from / CMC_CUCKOO_SLOTS].tags[from % CMC_CUCKOO_SLOTS] != 0)            \
+                break;                                                                                \
+        }                                                                                             \
+                                                                                                      \
+        return from;                                                                                  \
+    }
+
+#define CMC_GENERATE_CUCKOOMAP_SOURCE(PFX, SNAME, K, V)                                             \
+                                                                                                    \
+    /* Implementation Detail Functions */                                                           \
+    static bool PFX##_impl_find(struct SNAME *_map_, K key, size_t mixed, size_t *slot);            \
+    static bool PFX##_impl_place(struct SNAME *_map_, K key, V value, size_t mixed);                \
+    static bool PFX##_impl_rehash(struct SNAME *_map_, size_t buckets);                             \
+    static size_t PFX##_impl_next_slot(struct SNAME *_map_, size_t from);                           \
+    static size_t PFX##_impl_prev_slot(struct SNAME *_map_, size_t from);                           \
+                                                                                                    \
+    struct SNAME *PFX##_new(size_t capacity, double load, int (*compare)(K, K),                     \
+                            size_t (*hash)(K))                                                      \
+    {                                                                                               \
+        return PFX##_new_custom(capacity, load, compare, hash, NULL);                               \
+    }                                                                                               \
+                                                                                                    \
+    struct SNAME *PFX##_new_custom(size_t capacity, double load, int (*compare)(K, K),              \
+                                   size_t (*hash)(K), struct cmc_alloc_node *alloc)                 \
+    {                                                                                               \
+        if (!alloc)                                                                                 \
+            alloc = &cmc_alloc_node_default;                                                        \
+                                                                                                    \
+        if (capacity == 0 || load <= 0 || load >= 1)                                                \
+            return NULL;                                                                            \
+                                                                                                    \
+        /* Prevent integer overflow */                                                              \
+        if (capacity >= UINTMAX_MAX * load)                                                         \
+            return NULL;                                                                            \
+                                                                                                    \
+        size_t buckets = cmc_cuckoo_buckets(capacity / load);                                       \
+                                                                                                    \
+        if (buckets == 0)                                                                           \
+            return NULL;                                                                            \
+                                                                                                    \
+        struct SNAME *_map_ = alloc->malloc(sizeof(struct SNAME));                                  \
+                                                                                                    \
+        if (CMC_UNLIKELY(!_map_))                                                                   \
+            return NULL;                                                                            \
+                                                                                                    \
+        _map_->buffer = alloc->calloc(buckets, sizeof(struct SNAME##_bucket));                      \
+        _map_->values = alloc->malloc(buckets * CMC_CUCKOO_SLOTS * sizeof(V));                      \
+                                                                                                    \
+        if (CMC_UNLIKELY(!_map_->buffer || !_map_->values))                                         \
+        {                                                                                           \
+            alloc->free(_map_->buffer);                                                             \
+            alloc->free(_map_->values);                                                             \
+            alloc->free(_map_);                                                                     \
+            return NULL;                                                                            \
+        }                                                                                           \
+                                                                                                    \
+        _map_->capacity = buckets * CMC_CUCKOO_SLOTS;                                               \
+        _map_->count = 0;                                                                           \
+        _map_->load = load;                                                                         \
+        _map_->cmp = compare;                                                                       \
+        _map_->hash = hash;                                                                         \
+        _map_->alloc = alloc;                                                                       \
+                                                                                                    \
+        return _map_;                                                                               \
+    }                                                                                               \
+                                                                                                    \
+    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V))                                \
+    {                                                                                               \
+        size_t buckets = _map_->capacity / CMC_CUCKOO_SLOTS;                                        \
+                                                                                                    \
+        if (deallocator)                                                                            \
+        {                                                                                           \
+            for (size_t i = 0; i < _map_->capacity; i++)                                            \
+            {                                                                                       \
+                struct SNAME##_bucket *bucket = &(_map_->buffer[i / CMC_CUCKOO_SLOTS]);             \
+                                                                                                    \
+                if (bucket->tags[i % CMC_CUCKOO_SLOTS] != 0)                                        \
+                    deallocator(bucket->keys[i % CMC_CUCKOO_SLOTS], _map_->values[i]);              \
+            }                                                                                       \
+        }                                                                                           \
+                                                                                                    \
+        memset(_map_->buffer, 0, buckets * sizeof(struct SNAME##_bucket));                          \
+                                                                                                    \
+        _map_->count = 0;                                                                           \
+    }                                                                                               \
+                                                                                                    \
+    void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V))                                 \
+    {                                                                                               \
+        if (deallocator)                                                                            \
+            PFX##_clear(_map_, deallocator);                                                        \
+                                                                                                    \
+        _map_->alloc->free(_map_->buffer);                                                          \
+        _map_->alloc->free(_map_->values);                                                          \
+        _map_->alloc->free(_map_);                                                                  \
+    }                                                                                               \
+                                                                                                    \
+    /* Returns false if the key was already in the map or if it could not */                        \
+    /* be inserted */                                                                               \
+    bool PFX##_insert(struct SNAME *_map_, K key, V value)                                          \
+    {                                                                                               \
+        size_t slot;                                                                                \
+        size_t mixed = cmc_cuckoo_mix(_map_->hash(key));                                            \
+                                                                                                    \
+        if (PFX##_impl_find(_map_, key, mixed, &slot))                                              \
+            return false;                                                                           \
+                                                                                                    \
+        if ((double)(_map_->count + 1) > (double)_map_->capacity * _map_->load)                     \
+        {                                                                                           \
+            if (!PFX##_impl_rehash(_map_, _map_->capacity / CMC_CUCKOO_SLOTS * 2))                  \
+                return false;                                                                       \
+        }                                                                                           \
+                                                                                                    \
+        while (!PFX##_impl_place(_map_, key, value, mixed))                                         \
+        {                                                                                           \
+            /* At a low load a path is only missing when the two buckets */                         \
+            /* are full of keys with the same hash, that no growth can */                           \
+            /* split */                                                                             \
+            if (_map_->count < _map_->capacity / 2)                                                 \
+                return false;                                                                       \
+                                                                                                    \
+            if (!PFX##_impl_rehash(_map_, _map_->capacity / CMC_CUCKOO_SLOTS * 2))                  \
+                return false;                                                                       \
+        }                                                                                           \
+                                                                                                    \
+        _map_->count++;                                                                             \
+                                                                                                    \
+        return true;                                                                                \
+    }                                                                                               \
+                                                                                                    \
+    bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value)                        \
+    {                                                                                               \
+        size_t slot;                                                                                \
+                                                                                                    \
+        if (!PFX##_impl_find(_map_, key, cmc_cuckoo_mix(_map_->hash(key)), &slot))                  \
+            return false;                                                                           \
+                                                                                                    \
+        if (old_value)                                                                              \
+            *old_value = _map_->values[slot];                                                       \
+                                                                                                    \
+        _map_->values[slot] = new_value;                                                            \
+                                                                                                    \
+        return true;                                                                                \
+    }                                                                                               \
+                                                                                                    \
+    bool PFX##_remove(struct SNAME *_map_, K key, V *out_value)                                     \
+    {                                                                                               \
+        size_t slot;                                                                                \
+                                                                                                    \
+        if (!PFX##_impl_find(_map_, key, cmc_cuckoo_mix(_map_->hash(key)), &slot))                  \
+            return false;                                                                           \
+                                                                                                    \
+        if (out_value)                                                                              \
+            *out_value = _map_->values[slot];                                                       \
+                                                                                                    \
+        _map_->buffer[slot / CMC_CUCKOO_SLOTS].tags[slot % CMC_CUCKOO_SLOTS] = 0;                   \
+        _map_->count--;                                                                             \
+                                                                                                    \
+        return true;                                                                                \
+    }                                                                                               \
+                                                                                                    \
+    V PFX##_get(struct SNAME *_map_, K key)                                                         \
+    {                                                                                               \
+        size_t slot;                                                                                \
+                                                                                                    \
+        if (!PFX##_impl_find(_map_, key, cmc_cuckoo_mix(_map_->hash(key)), &slot))                  \
+            return (V){0};                                                                          \
+                                                                                                    \
+        return _map_->values[slot];                                                                 \
+    }                                                                                               \
+                                                                                                    \
+    V *PFX##_get_ref(struct SNAME *_map_, K key)                                                    \
+    {                                                                                               \
+        size_t slot;                                                                                \
+                                                                                                    \
+        if (!PFX##_impl_find(_map_, key, cmc_cuckoo_mix(_map_->hash(key)), &slot))                  \
+            return NULL;                                                                            \
+                                                                                                    \
+        return &(_map_->values[slot]);                                                              \
+    }                                                                                               \
+                                                                                                    \
+    bool PFX##_contains(struct SNAME *_map_, K key)                                                 \
+    {                                                                                               \
+        size_t slot;                                                                                \
+                                                                                                    \
+        return PFX##_impl_find(_map_, key, cmc_cuckoo_mix(_map_->hash(key)), &slot);                \
+    }                                                                                               \
+                                                                                                    \
+    bool PFX##_empty(struct SNAME *_map_)                                                           \
+    {                                                                                               \
+        return _map_->count == 0;                                                                   \
+    }                                                                                               \
+                                                                                                    \
+    size_t PFX##_count(struct SNAME *_map_)                                                         \
+    {                                                                                               \
+        return _map_->count;                                                                        \
+    }                                                                                               \
+                                                                                                    \
+    size_t PFX##_capacity(struct SNAME *_map_)                                                      \
+    {                                                                                               \
+        return _map_->capacity;                                                                     \
+    }                                                                                               \
+                                                                                                    \
+    double PFX##_load(struct SNAME *_map_)                                                          \
+    {                                                                                               \
+        return _map_->load;                                                                         \
+    }                                                                                               \
+                                                                                                    \
+    size_t PFX##_memory_usage(struct SNAME *_map_)                                                  \
+    {                                                                                               \
+        return sizeof(struct SNAME) +                                                               \
+               _map_->capacity / CMC_CUCKOO_SLOTS * sizeof(struct SNAME##_bucket) +                 \
+               _map_->capacity * sizeof(V);                                                         \
+    }                                                                                               \
+                                                                                                    \
+    /* The copy has the same buckets, so its keys are not hashed again */                           \
+    struct SNAME *PFX##_copy_of(struct SNAME *_map_, K (*key_copy_func)(K),                         \
+                                V (*value_copy_func)(V))                                            \
+    {                                                                                               \
+        struct SNAME *result = PFX##_new_custom(1, _map_->load,                                     \
+                                                _map_->cmp, _map_->hash, _map_->alloc);             \
+                                                                                                    \
+        if (CMC_UNLIKELY(!result))                                                                  \
+            return NULL;                                                                            \
+                                                                                                    \
+        if (result->capacity != _map_->capacity &&                                                  \
+            !PFX##_impl_rehash(result, _map_->capacity / CMC_CUCKOO_SLOTS))                         \
+        {                                                                                           \
+            PFX##_free(result, NULL);                                                               \
+            return NULL;                                                                            \
+        }                                                                                           \
+                                                                                                    \
+        size_t buckets = _map_->capacity / CMC_CUCKOO_SLOTS;                                        \
+                                                                                                    \
+        memcpy(result->buffer, _map_->buffer, buckets * sizeof(struct SNAME##_bucket));             \
+        memcpy(result->values, _map_->values, _map_->capacity * sizeof(V));                         \
+                                                                                                    \
+        if (key_copy_func || value_copy_func)                                                       \
+        {                                                                                           \
+            for (size_t i = 0; i < _map_->capacity; i++)                                            \
+            {                                                                                       \
+                struct SNAME##_bucket *bucket = &(result->buffer[i / CMC_CUCKOO_SLOTS]);            \
+                                                                                                    \
+                if (bucket->tags[i % CMC_CUCKOO_SLOTS] == 0)                                        \
+                    continue;                                                                       \
+                                                                                                    \
+                if (key_copy_func)                                                                  \
+                    bucket->keys[i % CMC_CUCKOO_SLOTS] =                                            \
+                        key_copy_func(bucket->keys[i % CMC_CUCKOO_SLOTS]);                          \
+                if (value_copy_func)                                                                \
+                    result->values[i] = value_copy_func(result->values[i]);                         \
+            }                                                                                       \
+        }                                                                                           \
+                                                                                                    \
+        result->count = _map_->count;                                                               \
+                                                                                                    \
+        return result;                                                                              \
+    }                                                                                               \
+                                                                                                    \
+    bool PFX##_equals(struct SNAME *_map1_, struct SNAME *_map2_, int (*value_comparator)(V, V))    \
+    {                                                                                               \
+        if (_map1_->count != _map2_->count)                                                         \
+            return false;                                                                           \
+                                                                                                    \
+        for (size_t i = 0; i < _map1_->capacity; i++)                                               \
+        {                                                                                           \
+            struct SNAME##_bucket *bucket = &(_map1_->buffer[i / CMC_CUCKOO_SLOTS]);                \
+                                                                                                    \
+            if (bucket->tags[i % CMC_CUCKOO_SLOTS] == 0)                                            \
+                continue;                                                                           \
+                                                                                                    \
+            K key = bucket->keys[i % CMC_CUCKOO_SLOTS];                                             \
+            size_t slot;                                                                            \
+                                                                                                    \
+            if (!PFX##_impl_find(_map2_, key, cmc_cuckoo_mix(_map2_->hash(key)), &slot))            \
+                return false;                                                                       \
+                                                                                                    \
+            if (value_comparator && value_comparator(_map1_->values[i], _map2_->values[slot]) != 0) \
+                return false;                                                                       \
+        }                                                                                           \
+                                                                                                    \
+        return true;                                                                                \
+    }                                                                                               \
+                                                                                                    \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_)                                          \
+    {                                                                                               \
+        struct cmc_string str;                                                                      \
+        struct SNAME *m_ = _map_;                                                                   \
+        const char *name = #SNAME;                                                                  \
+                                                                                                    \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_cuckoomap, name, m_, m_->buffer,             \
+                 m_->values, m_->capacity, m_->count, m_->load, m_->cmp, m_->hash);                 \
+                                                                                                    \
+        return str;                                                                                 \
+    }                                                                                               \
+                                                                                                    \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                       \
+    {                                                                                               \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));             \
+                                                                                                    \
+        if (CMC_UNLIKELY(!iter))                                                                    \
+            return NULL;                                                                            \
+                                                                                                    \
+        PFX##_iter_init(iter, target);                                                              \
+                                                                                                    \
+        return iter;                                                                                \
+    }                                                                                               \
+                                                                                                    \
+    void PFX##_iter_free(struct SNAME##_iter *iter)                                                 \
+    {                                                                                               \
+        iter->target->alloc->free(iter);                                                            \
+    }                                                                                               \
+                                                                                                    \
+    /* Iterates in the order of the slots */                                                        \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                           \
+    {                                                                                               \
+        iter->target = target;                                                                      \
+        iter->cursor = PFX##_impl_next_slot(target, 0);                                             \
+        iter->index = 0;                                                                            \
+        iter->start = true;                                                                         \
+        iter->end = PFX##_empty(target);                                                            \
+    }                                                                                               \
+                                                                                                    \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                                \
+    {                                                                                               \
+        return PFX##_empty(iter->target) || iter->start;                                            \
+    }                                                                                               \
+                                                                                                    \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                                  \
+    {                                                                                               \
+        return PFX##_empty(iter->target) || iter->end;                                              \
+    }                                                                                               \
+                                                                                                    \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                             \
+    {                                                                                               \
+        if (!PFX##_empty(iter->target))                                                             \
+        {                                                                                           \
+            iter->cursor = PFX##_impl_next_slot(iter->target, 0);                                   \
+            iter->index = 0;                                                                        \
+            iter->start = true;                                                                     \
+            iter->end = false;                                                                      \
+        }                                                                                           \
+    }                                                                                               \
+                                                                                                    \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                               \
+    {                                                                                               \
+        if (!PFX##_empty(iter->target))                                                             \
+        {                                                                                           \
+            iter->cursor = PFX##_impl_prev_slot(iter->target, iter->target->capacity - 1);          \
+            iter->index = iter->target->count - 1;                                                  \
+            iter->start = false;                                                                    \
+            iter->end = true;                                                                       \
+        }                                                                                           \
+    }                                                                                               \
+                                                                                                    \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                                 \
+    {                                                                                               \
+        if (iter->end)                                                                              \
+            return false;                                                                           \
+                                                                                                    \
+        if (iter->index + 1 == iter->target->count)                                                 \
+        {                                                                                           \
+            iter->end = true;                                                                       \
+            return false;                                                                           \
+        }                                                                                           \
+                                                                                                    \
+        iter->start = false;                                                                        \
+        iter->cursor = PFX##_impl_next_slot(iter->target, iter->cursor + 1);                        \
+        iter->index++;                                                                              \
+                                                                                                    \
+        return true;                                                                                \
+    }                                                                                               \
+                                                                                                    \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                                 \
+    {                                                                                               \
+        if (iter->start)                                                                            \
+            return false;                                                                           \
+                                                                                                    \
+        if (iter->index == 0)                                                                       \
+        {                                                                                           \
+            iter->start = true;                                                                     \
+            return false;                                                                           \
+        }                                                                                           \
+                                                                                                    \
+        iter->end = false;                                                                          \
+        iter->cursor = PFX##_impl_prev_slot(iter->target, iter->cursor - 1);                        \
+        iter->index--;                                                                              \
+                                                                                                    \
+        return true;                                                                                \
+    }                                                                                               \
+                                                                                                    \
+    K PFX##_iter_key(struct SNAME##_iter *iter)                                                     \
+    {                                                                                               \
+        if (PFX##_empty(iter->target))                                                              \
+            return (K){0};                                                                          \
+                                                                                                    \
+        size_t cursor = iter->cursor;                                                               \
+                                                                                                    \
+        return iter->target->buffer[cursor / CMC_CUCKOO_SLOTS].keys[cursor % CMC_CUCKOO_SLOTS];     \
+    }                                                                                               \
+                                                                                                    \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                                   \
+    {                                                                                               \
+        if (PFX##_empty(iter->target))                                                              \
+            return (V){0};                                                                          \
+                                                                                                    \
+        return iter->target->values[iter->cursor];                                                  \
+    }                                                                                               \
+                                                                                                    \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter)                                                 \
+    {                                                                                               \
+        if (PFX##_empty(iter->target))                                                              \
+            return NULL;                                                                            \
+                                                                                                    \
+        return &(iter->target->values[iter->cursor]);                                               \
+    }                                                                                               \
+                                                                                                    \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                              \
+    {                                                                                               \
+        return iter->index;                                                                         \
+    }                                                                                               \
+                                                                                                    \
+    /* Looks for key in its two buckets and sets slot to where it is */                             \
+    static bool PFX##_impl_find(struct SNAME *_map_, K key, size_t mixed, size_t *slot)             \
+    {                                                                                               \
+        size_t mask = _map_->capacity / CMC_CUCKOO_SLOTS - 1;                                       \
+        uint8_t tag = cmc_cuckoo_tag(mixed);                                                        \
+        size_t b = mixed & mask;                                                                    \
+                                                                                                    \
+        for (int i = 0; i < 2; i++, b = cmc_cuckoo_alt(b, tag, mask))                               \
+        {                                                                                           \
+            struct SNAME##_bucket *bucket = &(_map_->buffer[b]);                                    \
+                                                                                                    \
+            for (size_t s = 0; s < CMC_CUCKOO_SLOTS; s++)                                           \
+            {                                                                                       \
+                if (bucket->tags[s] == tag && _map_->cmp(bucket->keys[s], key) == 0)                \
+                {                                                                                   \
+                    *slot = b * CMC_CUCKOO_SLOTS + s;                                               \
+                    return true;                                                                    \
+                }                                                                                   \
+            }                                                                                       \
+        }                                                                                           \
+                                                                                                    \
+        return false;                                                                               \
+    }                                                                                               \
+                                                                                                    \
+    /* Frees a slot in one of the two buckets of key, moving others along */                        \
+    /* the path found by the search, and puts key and value there. Fails */                         \
+    /* when no path is found or when a move on it is no longer valid, which */                      \
+    /* can happen when the path goes through a bucket twice */                                      \
+    static bool PFX##_impl_place(struct SNAME *_map_, K key, V value, size_t mixed)                 \
+    {                                                                                               \
+        size_t mask = _map_->capacity / CMC_CUCKOO_SLOTS - 1;                                       \
+        uint8_t tag = cmc_cuckoo_tag(mixed);                                                        \
+        size_t b1 = mixed & mask;                                                                   \
+        size_t b2 = cmc_cuckoo_alt(b1, tag, mask);                                                  \
+                                                                                                    \
+        struct cmc_cuckoo_step path[CMC_CUCKOO_PATH];                                               \
+                                                                                                    \
+        size_t length = cmc_cuckoo_search(_map_->buffer, sizeof(struct SNAME##_bucket), mask,       \
+                                          b1, b2, path);                                            \
+                                                                                                    \
+        if (length == 0)                                                                            \
+            return false;                                                                           \
+                                                                                                    \
+        for (size_t i = length - 1; i > 0; i--)                                                     \
+        {                                                                                           \
+            struct SNAME##_bucket *from = &(_map_->buffer[path[i - 1].bucket]);                     \
+            struct SNAME##_bucket *to = &(_map_->buffer[path[i].bucket]);                           \
+            size_t fs = path[i - 1].slot;                                                           \
+            size_t ts = path[i].slot;                                                               \
+                                                                                                    \
+            if (to->tags[ts] != 0 || from->tags[fs] == 0 ||                                         \
+                cmc_cuckoo_alt(path[i - 1].bucket, from->tags[fs], mask) != path[i].bucket)         \
+                return false;                                                                       \
+                                                                                                    \
+            to->tags[ts] = from->tags[fs];                                                          \
+            to->keys[ts] = from->keys[fs];                                                          \
+            _map_->values[path[i].bucket * CMC_CUCKOO_SLOTS + ts] =                                 \
+                _map_->values[path[i - 1].bucket * CMC_CUCKOO_SLOTS + fs];                          \
+            from->tags[fs] = 0;                                                                     \
+        }                                                                                           \
+                                                                                                    \
+        struct SNAME##_bucket *bucket = &(_map_->buffer[path[0].bucket]);                           \
+                                                                                                    \
+        bucket->tags[path[0].slot] = tag;                                                           \
+        bucket->keys[path[0].slot] = key;                                                           \
+        _map_->values[path[0].bucket * CMC_CUCKOO_SLOTS + path[0].slot] = value;                    \
+                                                                                                    \
+        return true;                                                                                \
+    }                                                                                               \
+                                                                                                    \
+    /* Moves every key to a table with the given amount of buckets, leaving */                      \
+    /* the map as it was if any of them can't be placed */                                          \
+    static bool PFX##_impl_rehash(struct SNAME *_map_, size_t buckets)                              \
+    {                                                                                               \
+        if (buckets > SIZE_MAX / CMC_CUCKOO_SLOTS / 4 ||                                            \
+            buckets > SIZE_MAX / CMC_CUCKOO_SLOTS / sizeof(V))                                      \
+            return false;                                                                           \
+                                                                                                    \
+        struct SNAME grown = *_map_;                                                                \
+                                                                                                    \
+        grown.buffer = _map_->alloc->calloc(buckets, sizeof(struct SNAME##_bucket));                \
+        grown.values = _map_->alloc->malloc(buckets * CMC_CUCKOO_SLOTS * sizeof(V));                \
+        grown.capacity = buckets * CMC_CUCKOO_SLOTS;                                                \
+                                                                                                    \
+        if (CMC_UNLIKELY(!grown.buffer || !grown.values))                                           \
+        {                                                                                           \
+            _map_->alloc->free(grown.buffer);                                                       \
+            _map_->alloc->free(grown.values);                                                       \
+            return false;                                                                           \
+        }                                                                                           \
+                                                                                                    \
+        for (size_t i = 0; i < _map_->capacity; i++)                                                \
+        {                                                                                           \
+            struct SNAME##_bucket *bucket = &(_map_->buffer[i / CMC_CUCKOO_SLOTS]);                 \
+                                                                                                    \
+            if (bucket->tags[i % CMC_CUCKOO_SLOTS] == 0)                                            \
+                continue;                                                                           \
+                                                                                                    \
+            K key = bucket->keys[i % CMC_CUCKOO_SLOTS];                                             \
+                                                                                                    \
+            if (!PFX##_impl_place(&grown, key, _map_->values[i], cmc_cuckoo_mix(_map_->hash(key)))) \
+            {                                                                                       \
+                _map_->alloc->free(grown.buffer);                                                   \
+                _map_->alloc->free(grown.values);                                                   \
+                return false;                                                                       \
+            }                                                                                       \
+        }                                                                                           \
+                                                                                                    \
+        _map_->alloc->free(_map_->buffer);                                                          \
+        _map_->alloc->free(_map_->values);                                                          \
+                                                                                                    \
+        _map_->buffer = grown.buffer;                                                               \
+        _map_->values = grown.values;                                                               \
+        _map_->capacity = grown.capacity;                                                           \
+                                                                                                    \
+        return true;                                                                                \
+    }                                                                                               \
+                                                                                                    \
+    /* First occupied slot from the given one on */                                                 \
+    static size_t PFX##_impl_next_slot(struct SNAME *_map_, size_t from)                            \
+    {                                                                                               \
+        for (; from < _map_->capacity; from++)                                                      \
+        {                                                                                           \
+            if (_map_->buffer[from / CMC_CUCKOO_SLOTS].tags[from % CMC_CUCKOO_SLOTS] != 0)          \
+                break;                                                                              \
+        }                                                                                           \
+                                                                                                    \
+        return from;                                                                                \
+    }                                                                                               \
+                                                                                                    \
+    /* Last occupied slot from the given one back */                                                \
+    static size_t PFX##_impl_prev_slot(struct SNAME *_map_, size_t from)                            \
+    {                                                                                               \
+        for (; from > 0; from--)                                                                    \
+        {                                                                                           \
+            if (_map_->buffer[from / CMC_CUCKOO_SLOTS].tags[from % CMC_CUCKOO_SLOTS] != 0)          \
+                break;                                                                              \
+        }                                                                                           \
+                                                                                                    \
+        return from;                                                                                \
+    }
+
+#endif /* CMC_CUCKOOSET_H */
@@ -25,7 +25,9 @@
  * order to operate on O(1) for push and pop on either ends (only case where it
  * takes longer than O(1) is when the buffer is reallocated). If it was
  * implemented as a regular array, adding or removing elements from the front
- * would take O(N) due to the need to shift all elements in the deque.
+ * would take O(N) due to the need to shift all elements in the deque. With
+ * CMC_RING_POW2 defined as 1 (see cmc_growth.h) the capacity is always a power
+ * of two and indices wrap around with a mask.
  */
 
 #ifndef CMC_DEQUE_H
@@ -36,11 +38,30 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_growth.h"
+#include "../utl/cmc_scan.h"
+#include "../utl/cmc_serial.h"
+#include "../utl/cmc_sort.h"
 #include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
 
 /* to_string format */
 static const char *cmc_string_fmt_deque = "%s at %p { buffer:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", front:%" PRIuMAX ", back:%" PRIuMAX " }";
 
+/* A removal shrinks a collection once less than this fraction of what it */
+/* can hold without growing is in use. Define it as 0 to never shrink */
+#ifndef CMC_SHRINK_LOW_WATER
+#define CMC_SHRINK_LOW_WATER 0.25
+#endif
+
+/* A removal overwrites the slots it frees with zeros, so no copy of a */
+/* removed element is left in the buffer. Define it as 0 to skip it */
+#ifndef CMC_POP_ZERO
+#define CMC_POP_ZERO 1
+#endif
+
 #define CMC_GENERATE_DEQUE(PFX, SNAME, V)    \
     CMC_GENERATE_DEQUE_HEADER(PFX, SNAME, V) \
     CMC_GENERATE_DEQUE_SOURCE(PFX, SNAME, V)
@@ -51,6 +72,29 @@ static const char *cmc_string_fmt_deque = "%s at %p { buffer:%p, capacity:%" PRI
 #define CMC_WRAPGEN_DEQUE_SOURCE(PFX, SNAME, K, V) \
     CMC_GENERATE_DEQUE_SOURCE(PFX, SNAME, V)
 
+/* Same as CMC_GENERATE_DEQUE but contains compares the bytes of the */
+/* elements with the vector search of cmc_scan.h, for types like integers */
+/* and pointers. The comparator is ignored and may be NULL */
+#define CMC_GENERATE_DEQUE_BITWISE(PFX, SNAME, V) \
+    CMC_GENERATE_DEQUE_HEADER(PFX, SNAME, V)      \
+    CMC_GENERATE_DEQUE_BITWISE_SOURCE(PFX, SNAME, V)
+
+/* Same as CMC_GENERATE_DEQUE but V is plain data that owns nothing, so */
+/* removals and clear leave the slots they free as they are instead of */
+/* overwriting them with zeros */
+#define CMC_GENERATE_DEQUE_TRIVIAL(PFX, SNAME, V) \
+    CMC_GENERATE_DEQUE_HEADER(PFX, SNAME, V)      \
+    CMC_GENERATE_DEQUE_TRIVIAL_SOURCE(PFX, SNAME, V)
+
+#define CMC_GENERATE_DEQUE_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_DEQUE_SOURCE(PFX, SNAME, V, false, false)
+
+#define CMC_GENERATE_DEQUE_BITWISE_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_DEQUE_SOURCE(PFX, SNAME, V, true, false)
+
+#define CMC_GENERATE_DEQUE_TRIVIAL_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_DEQUE_SOURCE(PFX, SNAME, V, false, true)
+
 /* HEADER ********************************************************************/
 #define CMC_GENERATE_DEQUE_HEADER(PFX, SNAME, V)                                                \
                                                                                                 \
@@ -77,6 +121,9 @@ static const char *cmc_string_fmt_deque = "%s at %p { buffer:%p, capacity:%" PRI
                                                                                                 \
         /* Function that returns an iterator to the end of the deque */                         \
         struct SNAME##_iter (*it_end)(struct SNAME *);                                          \
+                                                                                                \
+        /* Custom allocation functions */                                                       \
+        struct cmc_alloc_node *alloc;                                                           \
     };                                                                                          \
                                                                                                 \
     /* Deque Iterator */                                                                        \
@@ -101,6 +148,8 @@ static const char *cmc_string_fmt_deque = "%s at %p { buffer:%p, capacity:%" PRI
     /* Collection Functions */                                                                  \
     /* Collection Allocation and Deallocation */                                                \
     struct SNAME *PFX##_new(size_t capacity);                                                   \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc);              \
+    struct SNAME *PFX##_new_from(V *elements, size_t size);                                     \
     void PFX##_clear(struct SNAME *_deque_, void (*deallocator)(V));                            \
     void PFX##_free(struct SNAME *_deque_, void (*deallocator)(V));                             \
     /* Collection Input and Output */                                                           \
@@ -108,20 +157,38 @@ static const char *cmc_string_fmt_deque = "%s at %p { buffer:%p, capacity:%" PRI
     bool PFX##_push_back(struct SNAME *_deque_, V element);                                     \
     bool PFX##_pop_front(struct SNAME *_deque_);                                                \
     bool PFX##_pop_back(struct SNAME *_deque_);                                                 \
+    bool PFX##_push_back_many(struct SNAME *_deque_, V *elements, size_t size);                 \
+    size_t PFX##_pop_front_many(struct SNAME *_deque_, V *elements, size_t size);               \
+    size_t PFX##_remove_if(struct SNAME *_deque_, bool (*pred)(V), void (*deallocator)(V));     \
     /* Element Access */                                                                        \
     V PFX##_front(struct SNAME *_deque_);                                                       \
     V PFX##_back(struct SNAME *_deque_);                                                        \
+    V PFX##_get(struct SNAME *_deque_, size_t index);                                           \
+    V *PFX##_get_ref(struct SNAME *_deque_, size_t index);                                      \
+    void PFX##_spans(struct SNAME *_deque_, V **a, size_t *a_count, V **b, size_t *b_count);    \
     /* Collection State */                                                                      \
     bool PFX##_contains(struct SNAME *_deque_, V element, int (*comparator)(V, V));             \
-    bool PFX##_empty(struct SNAME *_deque_);                                                    \
+    CMC_PURE bool PFX##_empty(struct SNAME *_deque_);                                           \
     bool PFX##_full(struct SNAME *_deque_);                                                     \
-    size_t PFX##_count(struct SNAME *_deque_);                                                  \
+    CMC_PURE size_t PFX##_count(struct SNAME *_deque_);                                         \
+    size_t PFX##_memory_usage(struct SNAME *_deque_);                                           \
     size_t PFX##_capacity(struct SNAME *_deque_);                                               \
     /* Collection Utility */                                                                    \
     bool PFX##_resize(struct SNAME *_deque_, size_t capacity);                                  \
+    bool PFX##_shrink_to_fit(struct SNAME *_deque_);                                            \
+    bool PFX##_reserve(struct SNAME *_deque_, size_t capacity);                                 \
+    void PFX##_sort(struct SNAME *_deque_, int (*comparator)(V, V));                            \
     struct SNAME *PFX##_copy_of(struct SNAME *_deque_, V (*copy_func)(V));                      \
+    size_t PFX##_to_array(struct SNAME *_deque_, V *CMC_RESTRICT elements, size_t size);        \
     bool PFX##_equals(struct SNAME *_deque1_, struct SNAME *_deque2_, int (*comparator)(V, V)); \
     struct cmc_string PFX##_to_string(struct SNAME *_deque_);                                   \
+    bool PFX##_to_string_full(struct SNAME *_deque_, struct cmc_string_builder *builder,        \
+                              const char *elem_fmt);                                            \
+    bool PFX##_write(struct SNAME *_deque_, FILE *file, void (*fmt)(FILE *, V));                \
+    bool PFX##_write_fd(struct SNAME *_deque_, int fd, void (*fmt)(struct cmc_dump *, V));      \
+    /* Collection Serialization */                                                              \
+    bool PFX##_save(struct SNAME *_deque_, FILE *file, bool (*writer)(V, FILE *));              \
+    struct SNAME *PFX##_restore(FILE *file, bool (*reader)(V *, FILE *));                       \
                                                                                                 \
     /* Iterator Functions */                                                                    \
     /* Iterator Allocation and Deallocation */                                                  \
@@ -146,484 +213,883 @@ static const char *cmc_string_fmt_deque = "%s at %p { buffer:%p, capacity:%" PRI
     size_t PFX##_iter_index(struct SNAME##_iter *iter);                                         \
                                                                                                 \
 /* SOURCE ********************************************************************/
-#define CMC_GENERATE_DEQUE_SOURCE(PFX, SNAME, V)                                                  \
-                                                                                                  \
-    /* Implementation Detail Functions */                                                         \
-    static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_deque_);                        \
-    static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_deque_);                          \
-                                                                                                  \
-    struct SNAME *PFX##_new(size_t capacity)                                                      \
-    {                                                                                             \
-        if (capacity < 1)                                                                         \
-            return NULL;                                                                          \
-                                                                                                  \
-        struct SNAME *_deque_ = malloc(sizeof(struct SNAME));                                     \
-                                                                                                  \
-        if (!_deque_)                                                                             \
-            return NULL;                                                                          \
-                                                                                                  \
-        _deque_->buffer = calloc(capacity, sizeof(V));                                            \
-                                                                                                  \
-        if (!_deque_->buffer)                                                                     \
-        {                                                                                         \
-            free(_deque_);                                                                        \
-            return NULL;                                                                          \
-        }                                                                                         \
-                                                                                                  \
-        _deque_->capacity = capacity;                                                             \
-        _deque_->count = 0;                                                                       \
-        _deque_->front = 0;                                                                       \
-        _deque_->back = 0;                                                                        \
-                                                                                                  \
-        _deque_->it_start = PFX##_impl_it_start;                                                  \
-        _deque_->it_end = PFX##_impl_it_end;                                                      \
-                                                                                                  \
-        return _deque_;                                                                           \
-    }                                                                                             \
-                                                                                                  \
-    void PFX##_clear(struct SNAME *_deque_, void (*deallocator)(V))                               \
-    {                                                                                             \
-        if (deallocator)                                                                          \
-        {                                                                                         \
-            for (size_t i = _deque_->front, j = 0; j < _deque_->count; j++)                       \
-            {                                                                                     \
-                deallocator(_deque_->buffer[i]);                                                  \
-                                                                                                  \
-                i = (i + 1) % _deque_->capacity;                                                  \
-            }                                                                                     \
-        }                                                                                         \
-                                                                                                  \
-        memset(_deque_->buffer, 0, sizeof(V) * _deque_->capacity);                                \
-                                                                                                  \
-        _deque_->count = 0;                                                                       \
-        _deque_->front = 0;                                                                       \
-        _deque_->back = 0;                                                                        \
-    }                                                                                             \
-                                                                                                  \
-    void PFX##_free(struct SNAME *_deque_, void (*deallocator)(V))                                \
-    {                                                                                             \
-        if (deallocator)                                                                          \
-        {                                                                                         \
-            for (size_t i = _deque_->front, j = 0; j < _deque_->count; j++)                       \
-            {                                                                                     \
-                deallocator(_deque_->buffer[i]);                                                  \
-                                                                                                  \
-                i = (i + 1) % _deque_->capacity;                                                  \
-            }                                                                                     \
-        }                                                                                         \
-                                                                                                  \
-        free(_deque_->buffer);                                                                    \
-        free(_deque_);                                                                            \
-    }                                                                                             \
-                                                                                                  \
-    bool PFX##_push_front(struct SNAME *_deque_, V element)                                       \
-    {                                                                                             \
-        if (PFX##_full(_deque_))                                                                  \
-        {                                                                                         \
-            if (!PFX##_resize(_deque_, PFX##_capacity(_deque_) * 2))                              \
-                return false;                                                                     \
-        }                                                                                         \
-                                                                                                  \
-        _deque_->front = (_deque_->front == 0) ? _deque_->capacity - 1 : _deque_->front - 1;      \
-                                                                                                  \
-        _deque_->buffer[_deque_->front] = element;                                                \
-                                                                                                  \
-        _deque_->count++;                                                                         \
-                                                                                                  \
-        return true;                                                                              \
-    }                                                                                             \
-                                                                                                  \
-    bool PFX##_push_back(struct SNAME *_deque_, V element)                                        \
-    {                                                                                             \
-        if (PFX##_full(_deque_))                                                                  \
-        {                                                                                         \
-            if (!PFX##_resize(_deque_, PFX##_capacity(_deque_) * 2))                              \
-                return false;                                                                     \
-        }                                                                                         \
-                                                                                                  \
-        _deque_->buffer[_deque_->back] = element;                                                 \
-                                                                                                  \
-        _deque_->back = (_deque_->back == _deque_->capacity - 1) ? 0 : _deque_->back + 1;         \
-                                                                                                  \
-        _deque_->count++;                                                                         \
-                                                                                                  \
-        return true;                                                                              \
-    }                                                                                             \
-                                                                                                  \
-    bool PFX##_pop_front(struct SNAME *_deque_)                                                   \
-    {                                                                                             \
-        if (PFX##_empty(_deque_))                                                                 \
-            return false;                                                                         \
-                                                                                                  \
-        _deque_->buffer[_deque_->front] = (V){0};                                                 \
-                                                                                                  \
-        _deque_->front = (_deque_->front == _deque_->capacity - 1) ? 0 : _deque_->front + 1;      \
-                                                                                                  \
-        _deque_->count--;                                                                         \
-                                                                                                  \
-        return true;                                                                              \
-    }                                                                                             \
-                                                                                                  \
-    bool PFX##_pop_back(struct SNAME *_deque_)                                                    \
-    {                                                                                             \
-        if (PFX##_empty(_deque_))                                                                 \
-            return false;                                                                         \
-                                                                                                  \
-        _deque_->back = (_deque_->back == 0) ? _deque_->capacity - 1 : _deque_->back - 1;         \
-                                                                                                  \
-        _deque_->buffer[_deque_->back] = (V){0};                                                  \
-                                                                                                  \
-        _deque_->count--;                                                                         \
-                                                                                                  \
-        return true;                                                                              \
-    }                                                                                             \
-                                                                                                  \
-    V PFX##_front(struct SNAME *_deque_)                                                          \
-    {                                                                                             \
-        if (PFX##_empty(_deque_))                                                                 \
-            return (V){0};                                                                        \
-                                                                                                  \
-        return _deque_->buffer[_deque_->front];                                                   \
-    }                                                                                             \
-                                                                                                  \
-    V PFX##_back(struct SNAME *_deque_)                                                           \
-    {                                                                                             \
-        if (PFX##_empty(_deque_))                                                                 \
-            return (V){0};                                                                        \
-                                                                                                  \
-        return _deque_->buffer[(_deque_->back == 0) ? _deque_->capacity - 1 : _deque_->back - 1]; \
-    }                                                                                             \
-                                                                                                  \
-    bool PFX##_contains(struct SNAME *_deque_, V element, int (*comparator)(V, V))                \
-    {                                                                                             \
-        for (size_t i = _deque_->front, j = 0; j < _deque_->count; j++)                           \
-        {                                                                                         \
-            if (comparator(_deque_->buffer[i], element) == 0)                                     \
-                return true;                                                                      \
-                                                                                                  \
-            i = (i + 1) % _deque_->capacity;                                                      \
-        }                                                                                         \
-                                                                                                  \
-        return false;                                                                             \
-    }                                                                                             \
-                                                                                                  \
-    bool PFX##_empty(struct SNAME *_deque_)                                                       \
-    {                                                                                             \
-        return _deque_->count == 0;                                                               \
-    }                                                                                             \
-                                                                                                  \
-    bool PFX##_full(struct SNAME *_deque_)                                                        \
-    {                                                                                             \
-        return _deque_->count >= _deque_->capacity;                                               \
-    }                                                                                             \
-                                                                                                  \
-    size_t PFX##_count(struct SNAME *_deque_)                                                     \
-    {                                                                                             \
-        return _deque_->count;                                                                    \
-    }                                                                                             \
-                                                                                                  \
-    size_t PFX##_capacity(struct SNAME *_deque_)                                                  \
-    {                                                                                             \
-        return _deque_->capacity;                                                                 \
-    }                                                                                             \
-                                                                                                  \
-    bool PFX##_resize(struct SNAME *_deque_, size_t capacity)                                     \
-    {                                                                                             \
-        if (PFX##_capacity(_deque_) == capacity)                                                  \
-            return true;                                                                          \
-                                                                                                  \
-        if (capacity < PFX##_count(_deque_))                                                      \
-            return false;                                                                         \
-                                                                                                  \
-        V *new_buffer = malloc(sizeof(V) * capacity);                                             \
-                                                                                                  \
-        if (!new_buffer)                                                                          \
-            return false;                                                                         \
-                                                                                                  \
-        for (size_t i = _deque_->front, j = 0; j < _deque_->count; j++)                           \
-        {                                                                                         \
-            new_buffer[j] = _deque_->buffer[i];                                                   \
-                                                                                                  \
-            i = (i + 1) % PFX##_capacity(_deque_);                                                \
-        }                                                                                         \
-                                                                                                  \
-        free(_deque_->buffer);                                                                    \
-                                                                                                  \
-        _deque_->buffer = new_buffer;                                                             \
-        _deque_->capacity = capacity;                                                             \
-        _deque_->front = 0;                                                                       \
-        _deque_->back = _deque_->count;                                                           \
-                                                                                                  \
-        return true;                                                                              \
-    }                                                                                             \
-                                                                                                  \
-    struct SNAME *PFX##_copy_of(struct SNAME *_deque_, V (*copy_func)(V))                         \
-    {                                                                                             \
-        struct SNAME *result = PFX##_new(_deque_->capacity);                                      \
-                                                                                                  \
-        if (!result)                                                                              \
-            return NULL;                                                                          \
-                                                                                                  \
-        if (copy_func)                                                                            \
-        {                                                                                         \
-            for (size_t i = _deque_->front, j = 0; j < _deque_->count; j++)                       \
-            {                                                                                     \
-                result->buffer[j] = copy_func(_deque_->buffer[i]);                                \
-                                                                                                  \
-                i = (i + 1) % _deque_->capacity;                                                  \
-            }                                                                                     \
-        }                                                                                         \
-        else                                                                                      \
-        {                                                                                         \
-            for (size_t i = _deque_->front, j = 0; j < _deque_->count; j++)                       \
-            {                                                                                     \
-                result->buffer[j] = _deque_->buffer[i];                                           \
-                                                                                                  \
-                i = (i + 1) % _deque_->capacity;                                                  \
-            }                                                                                     \
-        }                                                                                         \
-                                                                                                  \
-        result->count = _deque_->count;                                                           \
-                                                                                                  \
-        return result;                                                                            \
-    }                                                                                             \
-                                                                                                  \
-    bool PFX##_equals(struct SNAME *_deque1_, struct SNAME *_deque2_, int (*comparator)(V, V))    \
-    {                                                                                             \
-        if (PFX##_count(_deque1_) != PFX##_count(_deque2_))                                       \
-            return false;                                                                         \
-                                                                                                  \
-        size_t i, j, k;                                                                           \
-        for (i = _deque1_->front, j = _deque2_->front, k = 0; k < PFX##_count(_deque1_); k++)     \
-        {                                                                                         \
-            if (comparator(_deque1_->buffer[i], _deque2_->buffer[j]) != 0)                        \
-                return false;                                                                     \
-                                                                                                  \
-            i = (i + 1) % _deque1_->capacity;                                                     \
-            j = (j + 1) % _deque2_->capacity;                                                     \
-        }                                                                                         \
-                                                                                                  \
-        return true;                                                                              \
-    }                                                                                             \
-                                                                                                  \
-    struct cmc_string PFX##_to_string(struct SNAME *_deque_)                                      \
-    {                                                                                             \
-        struct cmc_string str;                                                                    \
-        struct SNAME *d_ = _deque_;                                                               \
-        const char *name = #SNAME;                                                                \
-                                                                                                  \
-        snprintf(str.s, cmc_string_len, cmc_string_fmt_deque,                                     \
-                 name, d_, d_->buffer, d_->capacity, d_->count, d_->front, d_->back);             \
-                                                                                                  \
-        return str;                                                                               \
-    }                                                                                             \
-                                                                                                  \
-    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                     \
-    {                                                                                             \
-        struct SNAME##_iter *iter = malloc(sizeof(struct SNAME##_iter));                          \
-                                                                                                  \
-        if (!iter)                                                                                \
-            return NULL;                                                                          \
-                                                                                                  \
-        PFX##_iter_init(iter, target);                                                            \
-                                                                                                  \
-        return iter;                                                                              \
-    }                                                                                             \
-                                                                                                  \
-    void PFX##_iter_free(struct SNAME##_iter *iter)                                               \
-    {                                                                                             \
-        free(iter);                                                                               \
-    }                                                                                             \
-                                                                                                  \
-    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                         \
-    {                                                                                             \
-        iter->target = target;                                                                    \
-        iter->cursor = target->front;                                                             \
-        iter->index = 0;                                                                          \
-        iter->start = true;                                                                       \
-        iter->end = PFX##_empty(target);                                                          \
-    }                                                                                             \
-                                                                                                  \
-    bool PFX##_iter_start(struct SNAME##_iter *iter)                                              \
-    {                                                                                             \
-        return PFX##_empty(iter->target) || iter->start;                                          \
-    }                                                                                             \
-                                                                                                  \
-    bool PFX##_iter_end(struct SNAME##_iter *iter)                                                \
-    {                                                                                             \
-        return PFX##_empty(iter->target) || iter->end;                                            \
-    }                                                                                             \
-                                                                                                  \
-    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                           \
-    {                                                                                             \
-        iter->cursor = iter->target->front;                                                       \
-        iter->index = 0;                                                                          \
-        iter->start = true;                                                                       \
-        iter->end = PFX##_empty(iter->target);                                                    \
-    }                                                                                             \
-                                                                                                  \
-    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                             \
-    {                                                                                             \
-        if (PFX##_empty(iter->target))                                                            \
-        {                                                                                         \
-            iter->cursor = 0;                                                                     \
-            iter->index = 0;                                                                      \
-        }                                                                                         \
-        else                                                                                      \
-        {                                                                                         \
-            if (iter->target->back == 0)                                                          \
-                iter->cursor = iter->target->capacity - 1;                                        \
-            else                                                                                  \
-                iter->cursor = iter->target->back - 1;                                            \
-                                                                                                  \
-            iter->index = PFX##_count(iter->target) - 1;                                          \
-        }                                                                                         \
-                                                                                                  \
-        iter->start = PFX##_empty(iter->target);                                                  \
-        iter->end = true;                                                                         \
-    }                                                                                             \
-                                                                                                  \
-    bool PFX##_iter_next(struct SNAME##_iter *iter)                                               \
-    {                                                                                             \
-        if (iter->end)                                                                            \
-            return false;                                                                         \
-                                                                                                  \
-        if (iter->index + 1 == PFX##_count(iter->target))                                         \
-        {                                                                                         \
-            iter->end = true;                                                                     \
-            return false;                                                                         \
-        }                                                                                         \
-                                                                                                  \
-        iter->start = PFX##_empty(iter->target);                                                  \
-                                                                                                  \
-        iter->cursor = (iter->cursor + 1) % (iter->target->capacity);                             \
-        iter->index++;                                                                            \
-                                                                                                  \
-        return true;                                                                              \
-    }                                                                                             \
-                                                                                                  \
-    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                               \
-    {                                                                                             \
-        if (iter->start)                                                                          \
-            return false;                                                                         \
-                                                                                                  \
-        if (iter->index == 0)                                                                     \
-        {                                                                                         \
-            iter->start = true;                                                                   \
-            return false;                                                                         \
-        }                                                                                         \
-                                                                                                  \
-        iter->end = PFX##_empty(iter->target);                                                    \
-                                                                                                  \
-        iter->cursor = (iter->cursor == 0) ? iter->target->capacity - 1 : iter->cursor - 1;       \
-        iter->index--;                                                                            \
-                                                                                                  \
-        return true;                                                                              \
-    }                                                                                             \
-                                                                                                  \
-    /* Returns true only if the iterator moved */                                                 \
-    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps)                              \
-    {                                                                                             \
-        if (iter->end)                                                                            \
-            return false;                                                                         \
-                                                                                                  \
-        if (iter->index + 1 == PFX##_count(iter->target))                                         \
-        {                                                                                         \
-            iter->end = true;                                                                     \
-            return false;                                                                         \
-        }                                                                                         \
-                                                                                                  \
-        if (steps == 0 || iter->index + steps >= PFX##_count(iter->target))                       \
-            return false;                                                                         \
-                                                                                                  \
-        iter->start = PFX##_empty(iter->target);                                                  \
-                                                                                                  \
-        iter->index += steps;                                                                     \
-        iter->cursor = (iter->cursor + steps) % iter->target->capacity;                           \
-                                                                                                  \
-        return true;                                                                              \
-    }                                                                                             \
-                                                                                                  \
-    /* Returns true only if the iterator moved */                                                 \
-    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps)                               \
-    {                                                                                             \
-        if (iter->start)                                                                          \
-            return false;                                                                         \
-                                                                                                  \
-        if (iter->index == 0)                                                                     \
-        {                                                                                         \
-            iter->start = true;                                                                   \
-            return false;                                                                         \
-        }                                                                                         \
-                                                                                                  \
-        if (steps == 0 || iter->index < steps)                                                    \
-            return false;                                                                         \
-                                                                                                  \
-        iter->end = PFX##_empty(iter->target);                                                    \
-                                                                                                  \
-        iter->index -= steps;                                                                     \
-                                                                                                  \
-        /* Prevent underflow */                                                                   \
-        if (iter->cursor < steps)                                                                 \
-            iter->cursor += PFX##_capacity(iter->target);                                         \
-                                                                                                  \
-        iter->cursor -= steps;                                                                    \
-                                                                                                  \
-        return true;                                                                              \
-    }                                                                                             \
-                                                                                                  \
-    /* Returns true only if the iterator was able to be positioned at the given index */          \
-    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index)                                \
-    {                                                                                             \
-        if (index >= PFX##_count(iter->target))                                                   \
-            return false;                                                                         \
-                                                                                                  \
-        if (iter->index > index)                                                                  \
-            return PFX##_iter_rewind(iter, iter->index - index);                                  \
-        else if (iter->index < index)                                                             \
-            return PFX##_iter_advance(iter, index - iter->index);                                 \
-                                                                                                  \
-        return true;                                                                              \
-    }                                                                                             \
-                                                                                                  \
-    V PFX##_iter_value(struct SNAME##_iter *iter)                                                 \
-    {                                                                                             \
-        if (PFX##_empty(iter->target))                                                            \
-            return (V){0};                                                                        \
-                                                                                                  \
-        return iter->target->buffer[iter->cursor];                                                \
-    }                                                                                             \
-                                                                                                  \
-    V *PFX##_iter_rvalue(struct SNAME##_iter *iter)                                               \
-    {                                                                                             \
-        if (PFX##_empty(iter->target))                                                            \
-            return NULL;                                                                          \
-                                                                                                  \
-        return &(iter->target->buffer[iter->cursor]);                                             \
-    }                                                                                             \
-                                                                                                  \
-    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                            \
-    {                                                                                             \
-        return iter->index;                                                                       \
-    }                                                                                             \
-                                                                                                  \
-    static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_deque_)                         \
-    {                                                                                             \
-        struct SNAME##_iter iter;                                                                 \
-                                                                                                  \
-        PFX##_iter_init(&iter, _deque_);                                                          \
-                                                                                                  \
-        return iter;                                                                              \
-    }                                                                                             \
-                                                                                                  \
-    static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_deque_)                           \
-    {                                                                                             \
-        struct SNAME##_iter iter;                                                                 \
-                                                                                                  \
-        PFX##_iter_init(&iter, _deque_);                                                          \
-        PFX##_iter_to_end(&iter);                                                                 \
-                                                                                                  \
-        return iter;                                                                              \
+#define CMC_IMPL_DEQUE_SOURCE(PFX, SNAME, V, BITWISE, TRIVIAL)                                  \
+                                                                                                \
+    /* Implementation Detail Functions */                                                       \
+    static void PFX##_impl_low_water(struct SNAME *_deque_);                                    \
+    static bool PFX##_impl_grow(struct SNAME *_deque_, size_t required);                        \
+    static inline size_t PFX##_impl_next(struct SNAME *_deque_, size_t i);                      \
+    static inline size_t PFX##_impl_prev(struct SNAME *_deque_, size_t i);                      \
+    static inline size_t PFX##_impl_wrap(struct SNAME *_deque_, size_t i);                      \
+    static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_deque_);                      \
+    static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_deque_);                        \
+                                                                                                \
+    CMC_GENERATE_SORT(PFX##_impl_sort, V, int (*comparator)(V, V), comparator, comparator)      \
+                                                                                                \
+    struct SNAME *PFX##_new(size_t capacity)                                                    \
+    {                                                                                           \
+        return PFX##_new_custom(capacity, NULL);                                                \
+    }                                                                                           \
+                                                                                                \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc)               \
+    {                                                                                           \
+        if (!alloc)                                                                             \
+            alloc = &cmc_alloc_node_default;                                                    \
+                                                                                                \
+        if (capacity < 1)                                                                       \
+            return NULL;                                                                        \
+                                                                                                \
+        if (CMC_RING_POW2)                                                                      \
+            capacity = cmc_growth_pow2(capacity);                                               \
+                                                                                                \
+        struct SNAME *_deque_ = alloc->malloc(sizeof(struct SNAME));                            \
+                                                                                                \
+        if (CMC_UNLIKELY(!_deque_))                                                             \
+            return NULL;                                                                        \
+                                                                                                \
+        _deque_->alloc = alloc;                                                                 \
+                                                                                                \
+        _deque_->buffer = alloc->calloc(capacity, sizeof(V));                                   \
+                                                                                                \
+        if (CMC_UNLIKELY(!_deque_->buffer))                                                     \
+        {                                                                                       \
+            alloc->free(_deque_);                                                               \
+            return NULL;                                                                        \
+        }                                                                                       \
+                                                                                                \
+        _deque_->capacity = capacity;                                                           \
+        _deque_->count = 0;                                                                     \
+        _deque_->front = 0;                                                                     \
+        _deque_->back = 0;                                                                      \
+                                                                                                \
+        _deque_->it_start = PFX##_impl_it_start;                                                \
+        _deque_->it_end = PFX##_impl_it_end;                                                    \
+                                                                                                \
+        return _deque_;                                                                         \
+    }                                                                                           \
+                                                                                                \
+    /* Creates a deque with the size elements in order, with room for half as */                \
+    /* many more */                                                                             \
+    struct SNAME *PFX##_new_from(V *elements, size_t size)                                      \
+    {                                                                                           \
+        if (size == 0)                                                                          \
+            return NULL;                                                                        \
+                                                                                                \
+        struct SNAME *_deque_ = PFX##_new(size + size / 2);                                     \
+                                                                                                \
+        if (CMC_UNLIKELY(!_deque_))                                                             \
+            return NULL;                                                                        \
+                                                                                                \
+        PFX##_push_back_many(_deque_, elements, size);                                          \
+                                                                                                \
+        return _deque_;                                                                         \
+    }                                                                                           \
+                                                                                                \
+    void PFX##_clear(struct SNAME *_deque_, void (*deallocator)(V))                             \
+    {                                                                                           \
+        if (deallocator)                                                                        \
+        {                                                                                       \
+            for (size_t i = _deque_->front, j = 0; j < _deque_->count; j++)                     \
+            {                                                                                   \
+                deallocator(_deque_->buffer[i]);                                                \
+                                                                                                \
+                i = PFX##_impl_next(_deque_, i);                                                \
+            }                                                                                   \
+        }                                                                                       \
+                                                                                                \
+        if (!TRIVIAL)                                                                           \
+            memset(_deque_->buffer, 0, sizeof(V) * _deque_->capacity);                          \
+                                                                                                \
+        _deque_->count = 0;                                                                     \
+        _deque_->front = 0;                                                                     \
+        _deque_->back = 0;                                                                      \
+    }                                                                                           \
+                                                                                                \
+    void PFX##_free(struct SNAME *_deque_, void (*deallocator)(V))                              \
+    {                                                                                           \
+        if (deallocator)                                                                        \
+        {                                                                                       \
+            for (size_t i = _deque_->front, j = 0; j < _deque_->count; j++)                     \
+            {                                                                                   \
+                deallocator(_deque_->buffer[i]);                                                \
+                                                                                                \
+                i = PFX##_impl_next(_deque_, i);                                                \
+            }                                                                                   \
+        }                                                                                       \
+                                                                                                \
+        _deque_->alloc->free(_deque_->buffer);                                                  \
+        _deque_->alloc->free(_deque_);                                                          \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_push_front(struct SNAME *_deque_, V element)                                     \
+    {                                                                                           \
+        if (PFX##_full(_deque_))                                                                \
+        {                                                                                       \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_deque_, _deque_->count + 1)))                    \
+                return false;                                                                   \
+        }                                                                                       \
+                                                                                                \
+        _deque_->front = PFX##_impl_prev(_deque_, _deque_->front);                              \
+                                                                                                \
+        _deque_->buffer[_deque_->front] = element;                                              \
+                                                                                                \
+        _deque_->count++;                                                                       \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_push_back(struct SNAME *_deque_, V element)                                      \
+    {                                                                                           \
+        if (PFX##_full(_deque_))                                                                \
+        {                                                                                       \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_deque_, _deque_->count + 1)))                    \
+                return false;                                                                   \
+        }                                                                                       \
+                                                                                                \
+        _deque_->buffer[_deque_->back] = element;                                               \
+                                                                                                \
+        _deque_->back = PFX##_impl_next(_deque_, _deque_->back);                                \
+                                                                                                \
+        _deque_->count++;                                                                       \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_pop_front(struct SNAME *_deque_)                                                 \
+    {                                                                                           \
+        if (PFX##_empty(_deque_))                                                               \
+            return false;                                                                       \
+                                                                                                \
+        if (CMC_POP_ZERO && !TRIVIAL)                                                           \
+            _deque_->buffer[_deque_->front] = (V){0};                                           \
+                                                                                                \
+        _deque_->front = PFX##_impl_next(_deque_, _deque_->front);                              \
+                                                                                                \
+        _deque_->count--;                                                                       \
+                                                                                                \
+        PFX##_impl_low_water(_deque_);                                                          \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_pop_back(struct SNAME *_deque_)                                                  \
+    {                                                                                           \
+        if (PFX##_empty(_deque_))                                                               \
+            return false;                                                                       \
+                                                                                                \
+        _deque_->back = PFX##_impl_prev(_deque_, _deque_->back);                                \
+                                                                                                \
+        if (CMC_POP_ZERO && !TRIVIAL)                                                           \
+            _deque_->buffer[_deque_->back] = (V){0};                                            \
+                                                                                                \
+        _deque_->count--;                                                                       \
+                                                                                                \
+        PFX##_impl_low_water(_deque_);                                                          \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    /* Pushes the size elements to the back in order, growing the buffer at most once */        \
+    bool PFX##_push_back_many(struct SNAME *_deque_, V *elements, size_t size)                  \
+    {                                                                                           \
+        if (size == 0)                                                                          \
+            return false;                                                                       \
+                                                                                                \
+        if (_deque_->count + size > _deque_->capacity)                                          \
+        {                                                                                       \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_deque_, _deque_->count + size)))                 \
+                return false;                                                                   \
+        }                                                                                       \
+                                                                                                \
+        /* The elements are copied up to the end of the buffer and then to */                   \
+        /* its start */                                                                         \
+        size_t first = _deque_->capacity - _deque_->back;                                       \
+                                                                                                \
+        if (first > size)                                                                       \
+            first = size;                                                                       \
+                                                                                                \
+        memcpy(_deque_->buffer + _deque_->back, elements, first * sizeof(V));                   \
+        memcpy(_deque_->buffer, elements + first, (size - first) * sizeof(V));                  \
+                                                                                                \
+        _deque_->back = PFX##_impl_wrap(_deque_, _deque_->back + size);                         \
+                                                                                                \
+        _deque_->count += size;                                                                 \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    /* Pops up to size elements from the front, copying them to elements */                     \
+    /* unless it is NULL. Returns how many were removed */                                      \
+    size_t PFX##_pop_front_many(struct SNAME *_deque_, V *elements, size_t size)                \
+    {                                                                                           \
+        if (size > _deque_->count)                                                              \
+            size = _deque_->count;                                                              \
+                                                                                                \
+        size_t first = _deque_->capacity - _deque_->front;                                      \
+                                                                                                \
+        if (first > size)                                                                       \
+            first = size;                                                                       \
+                                                                                                \
+        if (elements)                                                                           \
+        {                                                                                       \
+            memcpy(elements, _deque_->buffer + _deque_->front, first * sizeof(V));              \
+            memcpy(elements + first, _deque_->buffer, (size - first) * sizeof(V));              \
+        }                                                                                       \
+                                                                                                \
+        if (CMC_POP_ZERO && !TRIVIAL)                                                           \
+        {                                                                                       \
+            memset(_deque_->buffer + _deque_->front, 0, first * sizeof(V));                     \
+            memset(_deque_->buffer, 0, (size - first) * sizeof(V));                             \
+        }                                                                                       \
+                                                                                                \
+        _deque_->front = PFX##_impl_wrap(_deque_, _deque_->front + size);                       \
+                                                                                                \
+        _deque_->count -= size;                                                                 \
+                                                                                                \
+        PFX##_impl_low_water(_deque_);                                                          \
+                                                                                                \
+        return size;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    /* Removes every element for which pred is true in a single pass that */                    \
+    /* moves the others towards the front, keeping their order. Returns */                      \
+    /* how many were removed */                                                                 \
+    size_t PFX##_remove_if(struct SNAME *_deque_, bool (*pred)(V), void (*deallocator)(V))      \
+    {                                                                                           \
+        size_t write = _deque_->front;                                                          \
+        size_t read = _deque_->front;                                                           \
+        size_t removed = 0;                                                                     \
+                                                                                                \
+        for (size_t i = 0; i < _deque_->count; i++, read = PFX##_impl_next(_deque_, read))      \
+        {                                                                                       \
+            V element = _deque_->buffer[read];                                                  \
+                                                                                                \
+            if (pred(element))                                                                  \
+            {                                                                                   \
+                if (deallocator)                                                                \
+                    deallocator(element);                                                       \
+                                                                                                \
+                removed++;                                                                      \
+                continue;                                                                       \
+            }                                                                                   \
+                                                                                                \
+            _deque_->buffer[write] = element;                                                   \
+            write = PFX##_impl_next(_deque_, write);                                            \
+        }                                                                                       \
+                                                                                                \
+        if (removed == 0)                                                                       \
+            return 0;                                                                           \
+                                                                                                \
+        _deque_->back = write;                                                                  \
+                                                                                                \
+        if (CMC_POP_ZERO && !TRIVIAL)                                                           \
+        {                                                                                       \
+            for (size_t i = 0; i < removed; i++, write = PFX##_impl_next(_deque_, write))       \
+                _deque_->buffer[write] = (V){0};                                                \
+        }                                                                                       \
+                                                                                                \
+        _deque_->count -= removed;                                                              \
+                                                                                                \
+        PFX##_impl_low_water(_deque_);                                                          \
+                                                                                                \
+        return removed;                                                                         \
+    }                                                                                           \
+                                                                                                \
+    V PFX##_front(struct SNAME *_deque_)                                                        \
+    {                                                                                           \
+        if (PFX##_empty(_deque_))                                                               \
+            return (V){0};                                                                      \
+                                                                                                \
+        return _deque_->buffer[_deque_->front];                                                 \
+    }                                                                                           \
+                                                                                                \
+    V PFX##_back(struct SNAME *_deque_)                                                         \
+    {                                                                                           \
+        if (PFX##_empty(_deque_))                                                               \
+            return (V){0};                                                                      \
+                                                                                                \
+        return _deque_->buffer[PFX##_impl_prev(_deque_, _deque_->back)];                        \
+    }                                                                                           \
+                                                                                                \
+    V PFX##_get(struct SNAME *_deque_, size_t index)                                            \
+    {                                                                                           \
+        if (index >= _deque_->count)                                                            \
+            return (V){0};                                                                      \
+                                                                                                \
+        return *PFX##_get_ref(_deque_, index);                                                  \
+    }                                                                                           \
+                                                                                                \
+    V *PFX##_get_ref(struct SNAME *_deque_, size_t index)                                       \
+    {                                                                                           \
+        if (index >= _deque_->count)                                                            \
+            return NULL;                                                                        \
+                                                                                                \
+        return &(_deque_->buffer[PFX##_impl_wrap(_deque_, _deque_->front + index)]);            \
+    }                                                                                           \
+                                                                                                \
+    /* The elements from front to back are the a_count elements at a followed */                \
+    /* by the b_count elements at b. The second span is empty unless the */                     \
+    /* elements wrap around the end of the buffer */                                            \
+    void PFX##_spans(struct SNAME *_deque_, V **a, size_t *a_count, V **b, size_t *b_count)     \
+    {                                                                                           \
+        size_t first = _deque_->capacity - _deque_->front;                                      \
+                                                                                                \
+        if (first > _deque_->count)                                                             \
+            first = _deque_->count;                                                             \
+                                                                                                \
+        *a = _deque_->buffer + _deque_->front;                                                  \
+        *a_count = first;                                                                       \
+        *b = _deque_->buffer;                                                                   \
+        *b_count = _deque_->count - first;                                                      \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_contains(struct SNAME *_deque_, V element, int (*comparator)(V, V))              \
+    {                                                                                           \
+        if (BITWISE)                                                                            \
+        {                                                                                       \
+            V *a;                                                                               \
+            V *b;                                                                               \
+            size_t first, second;                                                               \
+                                                                                                \
+            PFX##_spans(_deque_, &a, &first, &b, &second);                                      \
+                                                                                                \
+            if (cmc_scan_find(a, first, sizeof(V), &element) != first)                          \
+                return true;                                                                    \
+                                                                                                \
+            return cmc_scan_find(b, second, sizeof(V), &element) != second;                     \
+        }                                                                                       \
+                                                                                                \
+        for (size_t i = _deque_->front, j = 0; j < _deque_->count; j++)                         \
+        {                                                                                       \
+            if (comparator(_deque_->buffer[i], element) == 0)                                   \
+                return true;                                                                    \
+                                                                                                \
+            i = PFX##_impl_next(_deque_, i);                                                    \
+        }                                                                                       \
+                                                                                                \
+        return false;                                                                           \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_empty(struct SNAME *_deque_)                                                     \
+    {                                                                                           \
+        return _deque_->count == 0;                                                             \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_full(struct SNAME *_deque_)                                                      \
+    {                                                                                           \
+        return _deque_->count >= _deque_->capacity;                                             \
+    }                                                                                           \
+                                                                                                \
+    size_t PFX##_count(struct SNAME *_deque_)                                                   \
+    {                                                                                           \
+        return _deque_->count;                                                                  \
+    }                                                                                           \
+                                                                                                \
+    size_t PFX##_memory_usage(struct SNAME *_deque_)                                            \
+    {                                                                                           \
+        return sizeof(struct SNAME) + sizeof(V) * _deque_->capacity;                            \
+    }                                                                                           \
+                                                                                                \
+    size_t PFX##_capacity(struct SNAME *_deque_)                                                \
+    {                                                                                           \
+        return _deque_->capacity;                                                               \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_resize(struct SNAME *_deque_, size_t capacity)                                   \
+    {                                                                                           \
+        if (CMC_RING_POW2)                                                                      \
+            capacity = cmc_growth_pow2(capacity);                                               \
+                                                                                                \
+        if (PFX##_capacity(_deque_) == capacity)                                                \
+            return true;                                                                        \
+                                                                                                \
+        if (capacity < PFX##_count(_deque_))                                                    \
+            return false;                                                                       \
+                                                                                                \
+        V *a;                                                                                   \
+        V *b;                                                                                   \
+        size_t first, second;                                                                   \
+                                                                                                \
+        PFX##_spans(_deque_, &a, &first, &b, &second);                                          \
+                                                                                                \
+        /* Elements that do not wrap and still fit stay where they are */                       \
+        if (second == 0 && _deque_->front < capacity && _deque_->front + first <= capacity)     \
+        {                                                                                       \
+            V *new_buffer = _deque_->alloc->realloc(_deque_->buffer, sizeof(V) * capacity);     \
+                                                                                                \
+            if (CMC_UNLIKELY(!new_buffer))                                                      \
+                return false;                                                                   \
+                                                                                                \
+            _deque_->buffer = new_buffer;                                                       \
+            _deque_->capacity = capacity;                                                       \
+            _deque_->back = PFX##_impl_wrap(_deque_, _deque_->front + first);                   \
+                                                                                                \
+            return true;                                                                        \
+        }                                                                                       \
+                                                                                                \
+        V *new_buffer = _deque_->alloc->malloc(sizeof(V) * capacity);                           \
+                                                                                                \
+        if (CMC_UNLIKELY(!new_buffer))                                                          \
+            return false;                                                                       \
+                                                                                                \
+        memcpy(new_buffer, a, first * sizeof(V));                                               \
+        memcpy(new_buffer + first, b, second * sizeof(V));                                      \
+                                                                                                \
+        _deque_->alloc->free(_deque_->buffer);                                                  \
+                                                                                                \
+        _deque_->buffer = new_buffer;                                                           \
+        _deque_->capacity = capacity;                                                           \
+        _deque_->front = 0;                                                                     \
+        _deque_->back = PFX##_impl_wrap(_deque_, _deque_->count);                               \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_shrink_to_fit(struct SNAME *_deque_)                                             \
+    {                                                                                           \
+        return PFX##_resize(_deque_, _deque_->count > 0 ? _deque_->count : 1);                  \
+    }                                                                                           \
+                                                                                                \
+    /* Grows the buffer so that at least capacity elements fit. Unlike */                       \
+    /* resize it never shrinks the buffer */                                                    \
+    bool PFX##_reserve(struct SNAME *_deque_, size_t capacity)                                  \
+    {                                                                                           \
+        if (capacity <= _deque_->capacity)                                                      \
+            return true;                                                                        \
+                                                                                                \
+        return PFX##_resize(_deque_, capacity);                                                 \
+    }                                                                                           \
+                                                                                                \
+    /* Sorts the deque in place in O(n log n) with the engine of cmc_sort.h. */                 \
+    /* If the elements wrap around the end of the buffer, the ones at the */                    \
+    /* front are first moved next to the others so they can be sorted as one */                 \
+    /* array starting at index 0 */                                                             \
+    void PFX##_sort(struct SNAME *_deque_, int (*comparator)(V, V))                             \
+    {                                                                                           \
+        if (_deque_->front + _deque_->count > _deque_->capacity)                                \
+        {                                                                                       \
+            size_t front_count = _deque_->capacity - _deque_->front;                            \
+                                                                                                \
+            memmove(_deque_->buffer + _deque_->back, _deque_->buffer + _deque_->front,          \
+                    sizeof(V) * front_count);                                                   \
+                                                                                                \
+            _deque_->front = 0;                                                                 \
+            _deque_->back = PFX##_impl_wrap(_deque_, _deque_->count);                           \
+        }                                                                                       \
+                                                                                                \
+        PFX##_impl_sort(comparator, _deque_->buffer + _deque_->front, _deque_->count);          \
+    }                                                                                           \
+                                                                                                \
+    struct SNAME *PFX##_copy_of(struct SNAME *_deque_, V (*copy_func)(V))                       \
+    {                                                                                           \
+        struct SNAME *result = PFX##_new_custom(_deque_->capacity, _deque_->alloc);             \
+                                                                                                \
+        if (CMC_UNLIKELY(!result))                                                              \
+            return NULL;                                                                        \
+                                                                                                \
+        if (copy_func)                                                                          \
+        {                                                                                       \
+            for (size_t i = _deque_->front, j = 0; j < _deque_->count; j++)                     \
+            {                                                                                   \
+                result->buffer[j] = copy_func(_deque_->buffer[i]);                              \
+                                                                                                \
+                i = PFX##_impl_next(_deque_, i);                                                \
+            }                                                                                   \
+        }                                                                                       \
+        else                                                                                    \
+        {                                                                                       \
+            V *a;                                                                               \
+            V *b;                                                                               \
+            size_t first, second;                                                               \
+                                                                                                \
+            PFX##_spans(_deque_, &a, &first, &b, &second);                                      \
+                                                                                                \
+            memcpy(result->buffer, a, first * sizeof(V));                                       \
+            memcpy(result->buffer + first, b, second * sizeof(V));                              \
+        }                                                                                       \
+                                                                                                \
+        result->count = _deque_->count;                                                         \
+        result->back = PFX##_impl_wrap(result, result->count);                                  \
+                                                                                                \
+        return result;                                                                          \
+    }                                                                                           \
+                                                                                                \
+    /* Copies up to size elements, from front to back, to elements and */                       \
+    /* returns how many were copied */                                                          \
+    size_t PFX##_to_array(struct SNAME *_deque_, V *CMC_RESTRICT elements, size_t size)         \
+    {                                                                                           \
+        V *a;                                                                                   \
+        V *b;                                                                                   \
+        size_t first, second;                                                                   \
+                                                                                                \
+        PFX##_spans(_deque_, &a, &first, &b, &second);                                          \
+                                                                                                \
+        if (size > _deque_->count)                                                              \
+            size = _deque_->count;                                                              \
+                                                                                                \
+        if (first > size)                                                                       \
+            first = size;                                                                       \
+                                                                                                \
+        memcpy(elements, a, first * sizeof(V));                                                 \
+        memcpy(elements + first, b, (size - first) * sizeof(V));                                \
+                                                                                                \
+        return size;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_equals(struct SNAME *_deque1_, struct SNAME *_deque2_, int (*comparator)(V, V))  \
+    {                                                                                           \
+        if (PFX##_count(_deque1_) != PFX##_count(_deque2_))                                     \
+            return false;                                                                       \
+                                                                                                \
+        size_t i, j, k;                                                                         \
+        for (i = _deque1_->front, j = _deque2_->front, k = 0; k < PFX##_count(_deque1_); k++)   \
+        {                                                                                       \
+            if (comparator(_deque1_->buffer[i], _deque2_->buffer[j]) != 0)                      \
+                return false;                                                                   \
+                                                                                                \
+            i = PFX##_impl_next(_deque1_, i);                                                   \
+            j = PFX##_impl_next(_deque2_, j);                                                   \
+        }                                                                                       \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    struct cmc_string PFX##_to_string(struct SNAME *_deque_)                                    \
+    {                                                                                           \
+        struct cmc_string str;                                                                  \
+        struct SNAME *d_ = _deque_;                                                             \
+        const char *name = #SNAME;                                                              \
+                                                                                                \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_deque,                                   \
+                 name, d_, d_->buffer, d_->capacity, d_->count, d_->front, d_->back);           \
+                                                                                                \
+        return str;                                                                             \
+    }                                                                                           \
+                                                                                                \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE)                              \
+                                                                                                \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE, (V))                                \
+                                                                                                \
+    bool PFX##_save(struct SNAME *_deque_, FILE *file, bool (*writer)(V, FILE *))               \
+    {                                                                                           \
+        uint32_t flags = writer ? 0 : CMC_SERIAL_RAW_VALUES;                                    \
+                                                                                                \
+        if (!cmc_serial_write_header(file, "deque", flags, 0, sizeof(V), 0,                     \
+                                     _deque_->count, _deque_->capacity, 0))                     \
+            return false;                                                                       \
+                                                                                                \
+        /* Without a writer the elements are written in at most two blocks, */                  \
+        /* from front to the end of the buffer and then from its start */                       \
+        if (!writer)                                                                            \
+        {                                                                                       \
+            size_t first = _deque_->capacity - _deque_->front;                                  \
+                                                                                                \
+            if (first > _deque_->count)                                                         \
+                first = _deque_->count;                                                         \
+                                                                                                \
+            size_t second = _deque_->count - first;                                             \
+                                                                                                \
+            return fwrite(_deque_->buffer + _deque_->front, sizeof(V), first, file) == first && \
+                   fwrite(_deque_->buffer, sizeof(V), second, file) == second;                  \
+        }                                                                                       \
+                                                                                                \
+        for (size_t i = _deque_->front, j = 0; j < _deque_->count; j++)                         \
+        {                                                                                       \
+            if (!writer(_deque_->buffer[i], file))                                              \
+                return false;                                                                   \
+                                                                                                \
+            i = PFX##_impl_next(_deque_, i);                                                    \
+        }                                                                                       \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    /* The reader is only used if the deque was saved with a writer */                          \
+    struct SNAME *PFX##_restore(FILE *file, bool (*reader)(V *, FILE *))                        \
+    {                                                                                           \
+        struct cmc_serial_header header;                                                        \
+                                                                                                \
+        if (!cmc_serial_read_header(file, "deque", 0, sizeof(V), &header))                      \
+            return NULL;                                                                        \
+                                                                                                \
+        if (header.capacity < header.count)                                                     \
+            return NULL;                                                                        \
+                                                                                                \
+        /* Allocated with the saved capacity so that loading never grows */                     \
+        struct SNAME *_deque_ = PFX##_new(header.capacity);                                     \
+                                                                                                \
+        if (CMC_UNLIKELY(!_deque_))                                                             \
+            return NULL;                                                                        \
+                                                                                                \
+        if (header.flags & CMC_SERIAL_RAW_VALUES)                                               \
+            _deque_->count = fread(_deque_->buffer, sizeof(V), header.count, file);             \
+        else                                                                                    \
+        {                                                                                       \
+            while (_deque_->count < header.count &&                                             \
+                   CMC_SERIAL_READ(false, reader, &(_deque_->buffer[_deque_->count]), file))    \
+                _deque_->count++;                                                               \
+        }                                                                                       \
+                                                                                                \
+        if (_deque_->count != header.count)                                                     \
+        {                                                                                       \
+            PFX##_free(_deque_, NULL);                                                          \
+            return NULL;                                                                        \
+        }                                                                                       \
+                                                                                                \
+        /* The elements were read in order into the start of the buffer */                      \
+        _deque_->back = PFX##_impl_wrap(_deque_, _deque_->count);                               \
+                                                                                                \
+        return _deque_;                                                                         \
+    }                                                                                           \
+                                                                                                \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                   \
+    {                                                                                           \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));         \
+                                                                                                \
+        if (CMC_UNLIKELY(!iter))                                                                \
+            return NULL;                                                                        \
+                                                                                                \
+        PFX##_iter_init(iter, target);                                                          \
+                                                                                                \
+        return iter;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    void PFX##_iter_free(struct SNAME##_iter *iter)                                             \
+    {                                                                                           \
+        iter->target->alloc->free(iter);                                                        \
+    }                                                                                           \
+                                                                                                \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                       \
+    {                                                                                           \
+        iter->target = target;                                                                  \
+        iter->cursor = target->front;                                                           \
+        iter->index = 0;                                                                        \
+        iter->start = true;                                                                     \
+        iter->end = PFX##_empty(target);                                                        \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                            \
+    {                                                                                           \
+        return PFX##_empty(iter->target) || iter->start;                                        \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                              \
+    {                                                                                           \
+        return PFX##_empty(iter->target) || iter->end;                                          \
+    }                                                                                           \
+                                                                                                \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                         \
+    {                                                                                           \
+        iter->cursor = iter->target->front;                                                     \
+        iter->index = 0;                                                                        \
+        iter->start = true;                                                                     \
+        iter->end = PFX##_empty(iter->target);                                                  \
+    }                                                                                           \
+                                                                                                \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                           \
+    {                                                                                           \
+        if (PFX##_empty(iter->target))                                                          \
+        {                                                                                       \
+            iter->cursor = 0;                                                                   \
+            iter->index = 0;                                                                    \
+        }                                                                                       \
+        else                                                                                    \
+        {                                                                                       \
+            iter->cursor = PFX##_impl_prev(iter->target, iter->target->back);                   \
+                                                                                                \
+            iter->index = PFX##_count(iter->target) - 1;                                        \
+        }                                                                                       \
+                                                                                                \
+        iter->start = PFX##_empty(iter->target);                                                \
+        iter->end = true;                                                                       \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                             \
+    {                                                                                           \
+        if (iter->end)                                                                          \
+            return false;                                                                       \
+                                                                                                \
+        if (iter->index + 1 == PFX##_count(iter->target))                                       \
+        {                                                                                       \
+            iter->end = true;                                                                   \
+            return false;                                                                       \
+        }                                                                                       \
+                                                                                                \
+        iter->start = PFX##_empty(iter->target);                                                \
+                                                                                                \
+        iter->cursor = PFX##_impl_next(iter->target, iter->cursor);                             \
+        iter->index++;                                                                          \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                             \
+    {                                                                                           \
+        if (iter->start)                                                                        \
+            return false;                                                                       \
+                                                                                                \
+        if (iter->index == 0)                                                                   \
+        {                                                                                       \
+            iter->start = true;                                                                 \
+            return false;                                                                       \
+        }                                                                                       \
+                                                                                                \
+        iter->end = PFX##_empty(iter->target);                                                  \
+                                                                                                \
+        iter->cursor = PFX##_impl_prev(iter->target, iter->cursor);                             \
+        iter->index--;                                                                          \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    /* Returns true only if the iterator moved */                                               \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps)                            \
+    {                                                                                           \
+        if (iter->end)                                                                          \
+            return false;                                                                       \
+                                                                                                \
+        if (iter->index + 1 == PFX##_count(iter->target))                                       \
+        {                                                                                       \
+            iter->end = true;                                                                   \
+            return false;                                                                       \
+        }                                                                                       \
+                                                                                                \
+        if (steps == 0 || iter->index + steps >= PFX##_count(iter->target))                     \
+            return false;                                                                       \
+                                                                                                \
+        iter->start = PFX##_empty(iter->target);                                                \
+                                                                                                \
+        iter->index += steps;                                                                   \
+        iter->cursor = PFX##_impl_wrap(iter->target, iter->cursor + steps);                     \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    /* Returns true only if the iterator moved */                                               \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps)                             \
+    {                                                                                           \
+        if (iter->start)                                                                        \
+            return false;                                                                       \
+                                                                                                \
+        if (iter->index == 0)                                                                   \
+        {                                                                                       \
+            iter->start = true;                                                                 \
+            return false;                                                                       \
+        }                                                                                       \
+                                                                                                \
+        if (steps == 0 || iter->index < steps)                                                  \
+            return false;                                                                       \
+                                                                                                \
+        iter->end = PFX##_empty(iter->target);                                                  \
+                                                                                                \
+        iter->index -= steps;                                                                   \
+                                                                                                \
+        /* Prevent underflow */                                                                 \
+        size_t cursor = iter->cursor + PFX##_capacity(iter->target) - steps;                    \
+                                                                                                \
+        iter->cursor = PFX##_impl_wrap(iter->target, cursor);                                   \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    /* Returns true only if the iterator was able to be positioned at the given index */        \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index)                              \
+    {                                                                                           \
+        if (index >= PFX##_count(iter->target))                                                 \
+            return false;                                                                       \
+                                                                                                \
+        if (iter->index > index)                                                                \
+            return PFX##_iter_rewind(iter, iter->index - index);                                \
+        else if (iter->index < index)                                                           \
+            return PFX##_iter_advance(iter, index - iter->index);                               \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                               \
+    {                                                                                           \
+        if (PFX##_empty(iter->target))                                                          \
+            return (V){0};                                                                      \
+                                                                                                \
+        return iter->target->buffer[iter->cursor];                                              \
+    }                                                                                           \
+                                                                                                \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter)                                             \
+    {                                                                                           \
+        if (PFX##_empty(iter->target))                                                          \
+            return NULL;                                                                        \
+                                                                                                \
+        return &(iter->target->buffer[iter->cursor]);                                           \
+    }                                                                                           \
+                                                                                                \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                          \
+    {                                                                                           \
+        return iter->index;                                                                     \
+    }                                                                                           \
+                                                                                                \
+    /* Called after removals, halves the buffer until it is no longer mostly empty */           \
+    static void PFX##_impl_low_water(struct SNAME *_deque_)                                     \
+    {                                                                                           \
+        size_t capacity = _deque_->capacity;                                                    \
+                                                                                                \
+        while (capacity > 1 &&                                                                  \
+               (double)_deque_->count < (double)capacity * CMC_SHRINK_LOW_WATER)                \
+            capacity /= 2;                                                                      \
+                                                                                                \
+        if (capacity != _deque_->capacity)                                                      \
+            PFX##_resize(_deque_, capacity);                                                    \
+    }                                                                                           \
+                                                                                                \
+    /* Called when the buffer is full, grows it by the policy of cmc_growth.h */                \
+    static bool PFX##_impl_grow(struct SNAME *_deque_, size_t required)                         \
+    {                                                                                           \
+        return PFX##_resize(_deque_, cmc_growth_capacity(_deque_->capacity, required));         \
+    }                                                                                           \
+                                                                                                \
+    /* Index after i in the circular buffer */                                                  \
+    static inline size_t PFX##_impl_next(struct SNAME *_deque_, size_t i)                       \
+    {                                                                                           \
+        if (CMC_RING_POW2)                                                                      \
+            return (i + 1) & (_deque_->capacity - 1);                                           \
+                                                                                                \
+        return i + 1 == _deque_->capacity ? 0 : i + 1;                                          \
+    }                                                                                           \
+                                                                                                \
+    /* Index before i in the circular buffer */                                                 \
+    static inline size_t PFX##_impl_prev(struct SNAME *_deque_, size_t i)                       \
+    {                                                                                           \
+        if (CMC_RING_POW2)                                                                      \
+            return (i - 1) & (_deque_->capacity - 1);                                           \
+                                                                                                \
+        return i == 0 ? _deque_->capacity - 1 : i - 1;                                          \
+    }                                                                                           \
+                                                                                                \
+    /* Wraps an index less than twice the capacity around the buffer */                         \
+    static inline size_t PFX##_impl_wrap(struct SNAME *_deque_, size_t i)                       \
+    {                                                                                           \
+        if (CMC_RING_POW2)                                                                      \
+            return i & (_deque_->capacity - 1);                                                 \
+                                                                                                \
+        return i >= _deque_->capacity ? i - _deque_->capacity : i;                              \
+    }                                                                                           \
+                                                                                                \
+    static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_deque_)                       \
+    {                                                                                           \
+        struct SNAME##_iter iter;                                                               \
+                                                                                                \
+        PFX##_iter_init(&iter, _deque_);                                                        \
+                                                                                                \
+        return iter;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_deque_)                         \
+    {                                                                                           \
+        struct SNAME##_iter iter;                                                               \
+                                                                                                \
+        PFX##_iter_init(&iter, _deque_);                                                        \
+        PFX##_iter_to_end(&iter);                                                               \
+                                                                                                \
+        return iter;                                                                            \
     }
 
 #endif /* CMC_DEQUE_H */
@@ -0,0 +1,787 @@
+/**
+ * flatmap.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * FlatMap
+ *
+ * A FlatMap is a Map that keeps its keys sorted in a plain array and their
+ * values in another array at the same positions. It has no nodes and no
+ * buckets, so a map of a few dozen entries takes only a couple of cache lines
+ * and a lookup is a binary search through them. Insertions and removals move
+ * the entries after them and take O(n), which for small maps is still faster
+ * than allocating a node of a TreeMap or hashing into the 53 buckets that a
+ * HashMap starts with.
+ *
+ * A map can also be built in bulk: append() adds an entry at the end without
+ * looking at the others and freeze() sorts all of them at once and shrinks
+ * the arrays to fit. Keys appended more than once keep the value appended
+ * last. Any other function sorts the appended entries before it does
+ * anything else.
+ *
+ * Keys that can be compared by their bytes, like integers and pointers, can
+ * be generated with CMC_GENERATE_FLATMAP_BITWISE. Lookups in maps of up to
+ * CMC_FLATMAP_LINEAR keys then use the vector search of cmc_scan.h instead of
+ * the binary search. The comparator is still used to keep the keys sorted
+ * and must return 0 only for keys with the same bytes.
+ */
+
+#ifndef CMC_FLATMAP_H
+#define CMC_FLATMAP_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_growth.h"
+#include "../utl/cmc_scan.h"
+#include "../utl/cmc_sort.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_flatmap = "%s at %p { keys:%p, values:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", sorted:%" PRIuMAX ", cmp:%p }";
+
+/* A removal shrinks a collection once less than this fraction of what it */
+/* can hold without growing is in use. Define it as 0 to never shrink */
+#ifndef CMC_SHRINK_LOW_WATER
+#define CMC_SHRINK_LOW_WATER 0.25
+#endif
+
+/* Maps generated with CMC_GENERATE_FLATMAP_BITWISE of up to this many keys */
+/* are searched linearly */
+#define CMC_FLATMAP_LINEAR 32
+
+/* Compares the keys of two entries while freeze sorts them */
+#define CMC_IMPL_FLATMAP_CMP(a, b) _map_->cmp((a).key, (b).key)
+
+#define CMC_GENERATE_FLATMAP(PFX, SNAME, K, V)    \
+    CMC_GENERATE_FLATMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_FLATMAP_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_FLATMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_FLATMAP_HEADER(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_FLATMAP_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_FLATMAP_SOURCE(PFX, SNAME, K, V)
+
+/* Same as CMC_GENERATE_FLATMAP but small maps are searched by comparing the */
+/* bytes of the keys with the vector search of cmc_scan.h */
+#define CMC_GENERATE_FLATMAP_BITWISE(PFX, SNAME, K, V)    \
+    CMC_GENERATE_FLATMAP_HEADER(PFX, SNAME, K, V)         \
+    CMC_GENERATE_FLATMAP_BITWISE_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_GENERATE_FLATMAP_SOURCE(PFX, SNAME, K, V) \
+    CMC_IMPL_FLATMAP_SOURCE(PFX, SNAME, K, V, false)
+
+#define CMC_GENERATE_FLATMAP_BITWISE_SOURCE(PFX, SNAME, K, V) \
+    CMC_IMPL_FLATMAP_SOURCE(PFX, SNAME, K, V, true)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_FLATMAP_HEADER(PFX, SNAME, K, V)                                             \
+                                                                                                  \
+    /* FlatMap Structure */                                                                       \
+    struct SNAME                                                                                  \
+    {                                                                                             \
+        /* Sorted keys */                                                                         \
+        K *keys;                                                                                  \
+                                                                                                  \
+        /* Value of each key, at the same position */                                             \
+        V *values;                                                                                \
+                                                                                                  \
+        /* Capacity of keys and values */                                                         \
+        size_t capacity;                                                                          \
+                                                                                                  \
+        /* Current amount of entries */                                                           \
+        size_t count;                                                                             \
+                                                                                                  \
+        /* Entries at the start that are sorted, the rest were appended */                        \
+        size_t sorted;                                                                            \
+                                                                                                  \
+        /* Key comparison function */                                                             \
+        int (*cmp)(K, K);                                                                         \
+                                                                                                  \
+        /* Custom allocation functions */                                                         \
+        struct cmc_alloc_node *alloc;                                                             \
+    };                                                                                            \
+                                                                                                  \
+    /* An entry being sorted by freeze */                                                         \
+    struct SNAME##_entry                                                                          \
+    {                                                                                             \
+        K key;                                                                                    \
+        V value;                                                                                  \
+        size_t order;                                                                             \
+    };                                                                                            \
+                                                                                                  \
+    /* FlatMap Iterator */                                                                        \
+    struct SNAME##_iter                                                                           \
+    {                                                                                             \
+        /* Target map */                                                                          \
+        struct SNAME *target;                                                                     \
+                                                                                                  \
+        /* Position in keys and values */                                                         \
+        size_t cursor;                                                                            \
+                                                                                                  \
+        /* If the iterator has reached the start of the iteration */                              \
+        bool start;                                                                               \
+                                                                                                  \
+        /* If the iterator has reached the end of the iteration */                                \
+        bool end;                                                                                 \
+    };                                                                                            \
+                                                                                                  \
+    /* Collection Functions */                                                                    \
+    /* Collection Allocation and Deallocation */                                                  \
+    struct SNAME *PFX##_new(size_t capacity, int (*compare)(K, K));                               \
+    struct SNAME *PFX##_new_custom(size_t capacity, int (*compare)(K, K),                         \
+                                   struct cmc_alloc_node *alloc);                                 \
+    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V));                             \
+    void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V));                              \
+    /* Collection Input and Output */                                                             \
+    bool PFX##_insert(struct SNAME *_map_, K key, V value);                                       \
+    bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value);                     \
+    bool PFX##_remove(struct SNAME *_map_, K key, V *out_value);                                  \
+    bool PFX##_append(struct SNAME *_map_, K key, V value);                                       \
+    bool PFX##_freeze(struct SNAME *_map_, void (*deallocator)(K, V));                            \
+    /* Element Access */                                                                          \
+    bool PFX##_max(struct SNAME *_map_, K *key, V *value);                                        \
+    bool PFX##_min(struct SNAME *_map_, K *key, V *value);                                        \
+    V PFX##_get(struct SNAME *_map_, K key);                                                      \
+    V *PFX##_get_ref(struct SNAME *_map_, K key);                                                 \
+    K *PFX##_keys(struct SNAME *_map_);                                                           \
+    V *PFX##_values(struct SNAME *_map_);                                                         \
+    /* Collection State */                                                                        \
+    bool PFX##_contains(struct SNAME *_map_, K key);                                              \
+    CMC_PURE bool PFX##_empty(struct SNAME *_map_);                                               \
+    CMC_PURE size_t PFX##_count(struct SNAME *_map_);                                             \
+    size_t PFX##_capacity(struct SNAME *_map_);                                                   \
+    size_t PFX##_memory_usage(struct SNAME *_map_);                                               \
+    /* Collection Utility */                                                                      \
+    struct SNAME *PFX##_copy_of(struct SNAME *_map_, K (*key_copy_func)(K),                       \
+                                V (*value_copy_func)(V));                                         \
+    bool PFX##_equals(struct SNAME *_map1_, struct SNAME *_map2_, int (*value_comparator)(V, V)); \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_);                                       \
+                                                                                                  \
+    /* Iterator Functions */                                                                      \
+    /* Iterator Allocation and Deallocation */                                                    \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target);                                    \
+    void PFX##_iter_free(struct SNAME##_iter *iter);                                              \
+    /* Iterator Initialization */                                                                 \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);                        \
+    /* Iterator State */                                                                          \
+    bool PFX##_iter_start(struct SNAME##_iter *iter);                                             \
+    bool PFX##_iter_end(struct SNAME##_iter *iter);                                               \
+    /* Iterator Movement */                                                                       \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter);                                          \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter);                                            \
+    bool PFX##_iter_next(struct SNAME##_iter *iter);                                              \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter);                                              \
+    /* Iterator Access */                                                                         \
+    K PFX##_iter_key(struct SNAME##_iter *iter);                                                  \
+    V PFX##_iter_value(struct SNAME##_iter *iter);                                                \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter);                                              \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter);                                           \
+                                                                                                  \
+/* SOURCE ********************************************************************/
+#define CMC_IMPL_FLATMAP_SOURCE(PFX, SNAME, K, V, BITWISE)                                       \
+                                                                                                 \
+    /* Implementation Detail Functions */                                                        \
+    static bool PFX##_impl_settle(struct SNAME *_map_);                                          \
+    static size_t PFX##_impl_lower_bound(struct SNAME *_map_, K key);                            \
+    static size_t PFX##_impl_find(struct SNAME *_map_, K key);                                   \
+    static bool PFX##_impl_resize(struct SNAME *_map_, size_t capacity);                         \
+    static void PFX##_impl_low_water(struct SNAME *_map_);                                       \
+                                                                                                 \
+    CMC_GENERATE_SORT(PFX##_impl_sort, struct SNAME##_entry, struct SNAME *_map_, _map_,         \
+                      CMC_IMPL_FLATMAP_CMP)                                                      \
+                                                                                                 \
+    struct SNAME *PFX##_new(size_t capacity, int (*compare)(K, K))                               \
+    {                                                                                            \
+        return PFX##_new_custom(capacity, compare, NULL);                                        \
+    }                                                                                            \
+                                                                                                 \
+    struct SNAME *PFX##_new_custom(size_t capacity, int (*compare)(K, K),                        \
+                                   struct cmc_alloc_node *alloc)                                 \
+    {                                                                                            \
+        if (!compare)                                                                            \
+            return NULL;                                                                         \
+                                                                                                 \
+        if (!alloc)                                                                              \
+            alloc = &cmc_alloc_node_default;                                                     \
+                                                                                                 \
+        struct SNAME *_map_ = alloc->malloc(sizeof(struct SNAME));                               \
+                                                                                                 \
+        if (CMC_UNLIKELY(!_map_))                                                                \
+            return NULL;                                                                         \
+                                                                                                 \
+        _map_->keys = NULL;                                                                      \
+        _map_->values = NULL;                                                                    \
+        _map_->capacity = 0;                                                                     \
+        _map_->count = 0;                                                                        \
+        _map_->sorted = 0;                                                                       \
+        _map_->cmp = compare;                                                                    \
+        _map_->alloc = alloc;                                                                    \
+                                                                                                 \
+        if (capacity > 0 && !PFX##_impl_resize(_map_, capacity))                                 \
+        {                                                                                        \
+            PFX##_free(_map_, NULL);                                                             \
+            return NULL;                                                                         \
+        }                                                                                        \
+                                                                                                 \
+        return _map_;                                                                            \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V))                             \
+    {                                                                                            \
+        if (deallocator)                                                                         \
+        {                                                                                        \
+            for (size_t i = 0; i < _map_->count; i++)                                            \
+                deallocator(_map_->keys[i], _map_->values[i]);                                   \
+        }                                                                                        \
+                                                                                                 \
+        _map_->count = 0;                                                                        \
+        _map_->sorted = 0;                                                                       \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V))                              \
+    {                                                                                            \
+        PFX##_clear(_map_, deallocator);                                                         \
+                                                                                                 \
+        _map_->alloc->free(_map_->keys);                                                         \
+        _map_->alloc->free(_map_->values);                                                       \
+        _map_->alloc->free(_map_);                                                               \
+    }                                                                                            \
+                                                                                                 \
+    /* Returns false if the key was already in the map or if it could not */                     \
+    /* be inserted. Moves every entry after it and takes O(n) */                                 \
+    bool PFX##_insert(struct SNAME *_map_, K key, V value)                                       \
+    {                                                                                            \
+        if (!PFX##_impl_settle(_map_))                                                           \
+            return false;                                                                        \
+                                                                                                 \
+        size_t i = PFX##_impl_lower_bound(_map_, key);                                           \
+                                                                                                 \
+        if (i < _map_->count && _map_->cmp(_map_->keys[i], key) == 0)                            \
+            return false;                                                                        \
+                                                                                                 \
+        if (_map_->count == _map_->capacity)                                                     \
+        {                                                                                        \
+            size_t capacity = cmc_growth_capacity(_map_->capacity, _map_->count + 1);            \
+                                                                                                 \
+            if (CMC_UNLIKELY(!PFX##_impl_resize(_map_, capacity)))                               \
+                return false;                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        size_t after = _map_->count - i;                                                         \
+                                                                                                 \
+        memmove(_map_->keys + i + 1, _map_->keys + i, after * sizeof(K));                        \
+        memmove(_map_->values + i + 1, _map_->values + i, after * sizeof(V));                    \
+                                                                                                 \
+        _map_->keys[i] = key;                                                                    \
+        _map_->values[i] = value;                                                                \
+        _map_->count++;                                                                          \
+        _map_->sorted++;                                                                         \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value)                     \
+    {                                                                                            \
+        size_t i = PFX##_impl_find(_map_, key);                                                  \
+                                                                                                 \
+        if (i == _map_->count)                                                                   \
+            return false;                                                                        \
+                                                                                                 \
+        if (old_value)                                                                           \
+            *old_value = _map_->values[i];                                                       \
+                                                                                                 \
+        _map_->values[i] = new_value;                                                            \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Moves every entry after the removed one and takes O(n) */                                 \
+    bool PFX##_remove(struct SNAME *_map_, K key, V *out_value)                                  \
+    {                                                                                            \
+        size_t i = PFX##_impl_find(_map_, key);                                                  \
+                                                                                                 \
+        if (i == _map_->count)                                                                   \
+            return false;                                                                        \
+                                                                                                 \
+        if (out_value)                                                                           \
+            *out_value = _map_->values[i];                                                       \
+                                                                                                 \
+        size_t after = _map_->count - i - 1;                                                     \
+                                                                                                 \
+        memmove(_map_->keys + i, _map_->keys + i + 1, after * sizeof(K));                        \
+        memmove(_map_->values + i, _map_->values + i + 1, after * sizeof(V));                    \
+                                                                                                 \
+        _map_->count--;                                                                          \
+        _map_->sorted--;                                                                         \
+                                                                                                 \
+        PFX##_impl_low_water(_map_);                                                             \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Adds an entry at the end in amortized O(1), to be sorted with the */                      \
+    /* others by freeze or by the next function that needs them sorted */                        \
+    bool PFX##_append(struct SNAME *_map_, K key, V value)                                       \
+    {                                                                                            \
+        if (_map_->count == _map_->capacity)                                                     \
+        {                                                                                        \
+            size_t capacity = cmc_growth_capacity(_map_->capacity, _map_->count + 1);            \
+                                                                                                 \
+            if (CMC_UNLIKELY(!PFX##_impl_resize(_map_, capacity)))                               \
+                return false;                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        _map_->keys[_map_->count] = key;                                                         \
+        _map_->values[_map_->count] = value;                                                     \
+        _map_->count++;                                                                          \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Sorts the appended entries and shrinks the arrays to fit. Of the */                       \
+    /* entries with the same key only the last one appended is kept and */                       \
+    /* the others are given to the deallocator */                                                \
+    bool PFX##_freeze(struct SNAME *_map_, void (*deallocator)(K, V))                            \
+    {                                                                                            \
+        size_t count = _map_->count;                                                             \
+        size_t sorted = _map_->sorted;                                                           \
+                                                                                                 \
+        /* Entries appended in ascending order are already in place */                           \
+        while (sorted < count &&                                                                 \
+               (sorted == 0 || _map_->cmp(_map_->keys[sorted - 1], _map_->keys[sorted]) < 0))    \
+            sorted++;                                                                            \
+                                                                                                 \
+        if (sorted < count)                                                                      \
+        {                                                                                        \
+            struct SNAME##_entry *entries =                                                      \
+                _map_->alloc->malloc(count * sizeof(struct SNAME##_entry));                      \
+                                                                                                 \
+            if (!entries)                                                                        \
+                return false;                                                                    \
+                                                                                                 \
+            for (size_t i = 0; i < count; i++)                                                   \
+            {                                                                                    \
+                entries[i].key = _map_->keys[i];                                                 \
+                entries[i].value = _map_->values[i];                                             \
+                entries[i].order = i;                                                            \
+            }                                                                                    \
+                                                                                                 \
+            PFX##_impl_sort(_map_, entries, count);                                              \
+                                                                                                 \
+            size_t j = 0;                                                                        \
+                                                                                                 \
+            for (size_t i = 0; i < count;)                                                       \
+            {                                                                                    \
+                /* Only the last appended of a run of equal keys is kept */                      \
+                size_t last = i;                                                                 \
+                size_t end = i + 1;                                                              \
+                                                                                                 \
+                for (; end < count && _map_->cmp(entries[i].key, entries[end].key) == 0; end++)  \
+                {                                                                                \
+                    if (entries[end].order > entries[last].order)                                \
+                        last = end;                                                              \
+                }                                                                                \
+                                                                                                 \
+                for (; i < end; i++)                                                             \
+                {                                                                                \
+                    if (i != last && deallocator)                                                \
+                        deallocator(entries[i].key, entries[i].value);                           \
+                }                                                                                \
+                                                                                                 \
+                _map_->keys[j] = entries[last].key;                                              \
+                _map_->values[j] = entries[last].value;                                          \
+                j++;                                                                             \
+            }                                                                                    \
+                                                                                                 \
+            _map_->alloc->free(entries);                                                         \
+                                                                                                 \
+            _map_->count = count = j;                                                            \
+        }                                                                                        \
+                                                                                                 \
+        _map_->sorted = count;                                                                   \
+                                                                                                 \
+        if (count < _map_->capacity)                                                             \
+            PFX##_impl_resize(_map_, count);                                                     \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_max(struct SNAME *_map_, K *key, V *value)                                        \
+    {                                                                                            \
+        if (!PFX##_impl_settle(_map_) || PFX##_empty(_map_))                                     \
+            return false;                                                                        \
+                                                                                                 \
+        if (key)                                                                                 \
+            *key = _map_->keys[_map_->count - 1];                                                \
+        if (value)                                                                               \
+            *value = _map_->values[_map_->count - 1];                                            \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_min(struct SNAME *_map_, K *key, V *value)                                        \
+    {                                                                                            \
+        if (!PFX##_impl_settle(_map_) || PFX##_empty(_map_))                                     \
+            return false;                                                                        \
+                                                                                                 \
+        if (key)                                                                                 \
+            *key = _map_->keys[0];                                                               \
+        if (value)                                                                               \
+            *value = _map_->values[0];                                                           \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    V PFX##_get(struct SNAME *_map_, K key)                                                      \
+    {                                                                                            \
+        size_t i = PFX##_impl_find(_map_, key);                                                  \
+                                                                                                 \
+        if (i == _map_->count)                                                                   \
+            return (V){0};                                                                       \
+                                                                                                 \
+        return _map_->values[i];                                                                 \
+    }                                                                                            \
+                                                                                                 \
+    V *PFX##_get_ref(struct SNAME *_map_, K key)                                                 \
+    {                                                                                            \
+        size_t i = PFX##_impl_find(_map_, key);                                                  \
+                                                                                                 \
+        if (i == _map_->count)                                                                   \
+            return NULL;                                                                         \
+                                                                                                 \
+        return &(_map_->values[i]);                                                              \
+    }                                                                                            \
+                                                                                                 \
+    /* The sorted keys, valid until the map is modified */                                       \
+    K *PFX##_keys(struct SNAME *_map_)                                                           \
+    {                                                                                            \
+        PFX##_impl_settle(_map_);                                                                \
+                                                                                                 \
+        return _map_->keys;                                                                      \
+    }                                                                                            \
+                                                                                                 \
+    /* The values, in the same order as keys */                                                  \
+    V *PFX##_values(struct SNAME *_map_)                                                         \
+    {                                                                                            \
+        PFX##_impl_settle(_map_);                                                                \
+                                                                                                 \
+        return _map_->values;                                                                    \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_contains(struct SNAME *_map_, K key)                                              \
+    {                                                                                            \
+        return PFX##_impl_find(_map_, key) != _map_->count;                                      \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_empty(struct SNAME *_map_)                                                        \
+    {                                                                                            \
+        return _map_->count == 0;                                                                \
+    }                                                                                            \
+                                                                                                 \
+    /* Appended keys that repeat are counted until the map is sorted */                          \
+    size_t PFX##_count(struct SNAME *_map_)                                                      \
+    {                                                                                            \
+        return _map_->count;                                                                     \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_capacity(struct SNAME *_map_)                                                   \
+    {                                                                                            \
+        return _map_->capacity;                                                                  \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_memory_usage(struct SNAME *_map_)                                               \
+    {                                                                                            \
+        return sizeof(struct SNAME) + _map_->capacity * (sizeof(K) + sizeof(V));                 \
+    }                                                                                            \
+                                                                                                 \
+    struct SNAME *PFX##_copy_of(struct SNAME *_map_, K (*key_copy_func)(K),                      \
+                                V (*value_copy_func)(V))                                         \
+    {                                                                                            \
+        if (!PFX##_impl_settle(_map_))                                                           \
+            return NULL;                                                                         \
+                                                                                                 \
+        struct SNAME *result = PFX##_new_custom(_map_->count, _map_->cmp, _map_->alloc);         \
+                                                                                                 \
+        if (CMC_UNLIKELY(!result))                                                               \
+            return NULL;                                                                         \
+                                                                                                 \
+        for (size_t i = 0; i < _map_->count; i++)                                                \
+        {                                                                                        \
+            K key = _map_->keys[i];                                                              \
+            V value = _map_->values[i];                                                          \
+                                                                                                 \
+            result->keys[i] = key_copy_func ? key_copy_func(key) : key;                          \
+            result->values[i] = value_copy_func ? value_copy_func(value) : value;                \
+        }                                                                                        \
+                                                                                                 \
+        result->count = _map_->count;                                                            \
+        result->sorted = _map_->count;                                                           \
+                                                                                                 \
+        return result;                                                                           \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_equals(struct SNAME *_map1_, struct SNAME *_map2_, int (*value_comparator)(V, V)) \
+    {                                                                                            \
+        if (!PFX##_impl_settle(_map1_) || !PFX##_impl_settle(_map2_))                            \
+            return false;                                                                        \
+                                                                                                 \
+        if (_map1_->count != _map2_->count)                                                      \
+            return false;                                                                        \
+                                                                                                 \
+        for (size_t i = 0; i < _map1_->count; i++)                                               \
+        {                                                                                        \
+            if (_map1_->cmp(_map1_->keys[i], _map2_->keys[i]) != 0)                              \
+                return false;                                                                    \
+                                                                                                 \
+            if (value_comparator &&                                                              \
+                value_comparator(_map1_->values[i], _map2_->values[i]) != 0)                     \
+                return false;                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_)                                       \
+    {                                                                                            \
+        struct cmc_string str;                                                                   \
+        struct SNAME *m_ = _map_;                                                                \
+        const char *name = #SNAME;                                                               \
+                                                                                                 \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_flatmap, name, m_, m_->keys, m_->values,  \
+                 m_->capacity, m_->count, m_->sorted, m_->cmp);                                  \
+                                                                                                 \
+        return str;                                                                              \
+    }                                                                                            \
+                                                                                                 \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                    \
+    {                                                                                            \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));          \
+                                                                                                 \
+        if (CMC_UNLIKELY(!iter))                                                                 \
+            return NULL;                                                                         \
+                                                                                                 \
+        PFX##_iter_init(iter, target);                                                           \
+                                                                                                 \
+        return iter;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_iter_free(struct SNAME##_iter *iter)                                              \
+    {                                                                                            \
+        iter->target->alloc->free(iter);                                                         \
+    }                                                                                            \
+                                                                                                 \
+    /* Iterates in the order of the keys */                                                      \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                        \
+    {                                                                                            \
+        PFX##_impl_settle(target);                                                               \
+                                                                                                 \
+        iter->target = target;                                                                   \
+        iter->cursor = 0;                                                                        \
+        iter->start = true;                                                                      \
+        iter->end = PFX##_empty(target);                                                         \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                             \
+    {                                                                                            \
+        return PFX##_empty(iter->target) || iter->start;                                         \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                               \
+    {                                                                                            \
+        return PFX##_empty(iter->target) || iter->end;                                           \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                          \
+    {                                                                                            \
+        if (!PFX##_empty(iter->target))                                                          \
+        {                                                                                        \
+            iter->cursor = 0;                                                                    \
+            iter->start = true;                                                                  \
+            iter->end = false;                                                                   \
+        }                                                                                        \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                            \
+    {                                                                                            \
+        if (!PFX##_empty(iter->target))                                                          \
+        {                                                                                        \
+            iter->cursor = iter->target->count - 1;                                              \
+            iter->start = false;                                                                 \
+            iter->end = true;                                                                    \
+        }                                                                                        \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                              \
+    {                                                                                            \
+        if (iter->end)                                                                           \
+            return false;                                                                        \
+                                                                                                 \
+        if (iter->cursor + 1 == iter->target->count)                                             \
+        {                                                                                        \
+            iter->end = true;                                                                    \
+            return false;                                                                        \
+        }                                                                                        \
+                                                                                                 \
+        iter->start = false;                                                                     \
+        iter->cursor++;                                                                          \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                              \
+    {                                                                                            \
+        if (iter->start)                                                                         \
+            return false;                                                                        \
+                                                                                                 \
+        if (iter->cursor == 0)                                                                   \
+        {                                                                                        \
+            iter->start = true;                                                                  \
+            return false;                                                                        \
+        }                                                                                        \
+                                                                                                 \
+        iter->end = false;                                                                       \
+        iter->cursor--;                                                                          \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    K PFX##_iter_key(struct SNAME##_iter *iter)                                                  \
+    {                                                                                            \
+        if (PFX##_empty(iter->target))                                                           \
+            return (K){0};                                                                       \
+                                                                                                 \
+        return iter->target->keys[iter->cursor];                                                 \
+    }                                                                                            \
+                                                                                                 \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                                \
+    {                                                                                            \
+        if (PFX##_empty(iter->target))                                                           \
+            return (V){0};                                                                       \
+                                                                                                 \
+        return iter->target->values[iter->cursor];                                               \
+    }                                                                                            \
+                                                                                                 \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter)                                              \
+    {                                                                                            \
+        if (PFX##_empty(iter->target))                                                           \
+            return NULL;                                                                         \
+                                                                                                 \
+        return &(iter->target->values[iter->cursor]);                                            \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                           \
+    {                                                                                            \
+        return iter->cursor;                                                                     \
+    }                                                                                            \
+                                                                                                 \
+    /* Sorts the entries appended since the last time they were sorted */                        \
+    static bool PFX##_impl_settle(struct SNAME *_map_)                                           \
+    {                                                                                            \
+        if (_map_->sorted == _map_->count)                                                       \
+            return true;                                                                         \
+                                                                                                 \
+        return PFX##_freeze(_map_, NULL);                                                        \
+    }                                                                                            \
+                                                                                                 \
+    /* Position of the first key not less than key */                                            \
+    static size_t PFX##_impl_lower_bound(struct SNAME *_map_, K key)                             \
+    {                                                                                            \
+        size_t L = 0;                                                                            \
+        size_t R = _map_->count;                                                                 \
+                                                                                                 \
+        while (L < R)                                                                            \
+        {                                                                                        \
+            size_t M = L + (R - L) / 2;                                                          \
+                                                                                                 \
+            if (_map_->cmp(_map_->keys[M], key) < 0)                                             \
+                L = M + 1;                                                                       \
+            else                                                                                 \
+                R = M;                                                                           \
+        }                                                                                        \
+                                                                                                 \
+        return L;                                                                                \
+    }                                                                                            \
+                                                                                                 \
+    /* Position of a key in keys and values, or the count if it is not there */                  \
+    static size_t PFX##_impl_find(struct SNAME *_map_, K key)                                    \
+    {                                                                                            \
+        if (!PFX##_impl_settle(_map_))                                                           \
+            return _map_->count;                                                                 \
+                                                                                                 \
+        size_t count = _map_->count;                                                             \
+                                                                                                 \
+        if (BITWISE && count <= CMC_FLATMAP_LINEAR)                                              \
+            return cmc_scan_find(_map_->keys, count, sizeof(K), &key);                           \
+                                                                                                 \
+        size_t i = PFX##_impl_lower_bound(_map_, key);                                           \
+                                                                                                 \
+        if (i < count && _map_->cmp(_map_->keys[i], key) == 0)                                   \
+            return i;                                                                            \
+                                                                                                 \
+        return count;                                                                            \
+    }                                                                                            \
+                                                                                                 \
+    static bool PFX##_impl_resize(struct SNAME *_map_, size_t capacity)                          \
+    {                                                                                            \
+        if (capacity == 0)                                                                       \
+        {                                                                                        \
+            _map_->alloc->free(_map_->keys);                                                     \
+            _map_->alloc->free(_map_->values);                                                   \
+                                                                                                 \
+            _map_->keys = NULL;                                                                  \
+            _map_->values = NULL;                                                                \
+            _map_->capacity = 0;                                                                 \
+                                                                                                 \
+            return true;                                                                         \
+        }                                                                                        \
+                                                                                                 \
+        K *keys = _map_->alloc->realloc(_map_->keys, capacity * sizeof(K));                      \
+                                                                                                 \
+        if (CMC_UNLIKELY(!keys))                                                                 \
+            return false;                                                                        \
+                                                                                                 \
+        _map_->keys = keys;                                                                      \
+                                                                                                 \
+        V *values = _map_->alloc->realloc(_map_->values, capacity * sizeof(V));                  \
+                                                                                                 \
+        if (CMC_UNLIKELY(!values))                                                               \
+        {                                                                                        \
+            /* The keys are kept if they were shrunk */                                          \
+            if (capacity < _map_->capacity)                                                      \
+                _map_->capacity = capacity;                                                      \
+                                                                                                 \
+            return false;                                                                        \
+        }                                                                                        \
+                                                                                                 \
+        _map_->values = values;                                                                  \
+        _map_->capacity = capacity;                                                              \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Called after removals, halves the arrays until they are no longer */                      \
+    /* mostly empty */                                                                           \
+    static void PFX##_impl_low_water(struct SNAME *_map_)                                        \
+    {                                                                                            \
+        size_t capacity = _map_->capacity;                                                       \
+                                                                                                 \
+        while (capacity > 1 && (double)_map_->count < (double)capacity * CMC_SHRINK_LOW_WATER)   \
+            capacity /= 2;                                                                       \
+                                                                                                 \
+        if (capacity != _map_->capacity)                                                         \
+            PFX##_impl_resize(_map_, capacity);                                                  \
+    }
+
+#endif /* CMC_FLATMAP_H */
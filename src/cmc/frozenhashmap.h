@@ -0,0 +1,487 @@
+/**
+ * frozenhashmap.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * FrozenHashMap
+ *
+ * A FrozenHashMap is an immutable copy of a HashMap, for tables that are built
+ * once and then only read. PFX##_freeze builds it from a HashMap generated
+ * with the same PFX, SNAME, K and V, and the keys can't be inserted, removed
+ * or updated after that, only their values can be changed through get_ref.
+ *
+ * Implementation
+ *
+ * The keys are placed with a minimal perfect hash built with the CHD
+ * (compress, hash and displace) algorithm. Keys are split into buckets of a
+ * few keys by their hash, and each bucket gets a displacement that sends its
+ * keys to slots that no other key takes, so the count entries fill exactly
+ * count slots. A lookup reads the displacement of the bucket of the key and
+ * compares the key with the one entry at the slot it gives, there is no
+ * probing and no state or distance kept in the entries.
+ *
+ * Two keys with the same hash can't be told apart by any displacement, so
+ * freezing a HashMap that has them fails. The keys and values are copied as
+ * they are and still belong to the HashMap, only one of them should be freed
+ * with a deallocator.
+ */
+
+#ifndef CMC_FROZENHASHMAP_H
+#define CMC_FROZENHASHMAP_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_string.h"
+#include "../utl/hash.h"
+#include "../utl/compiler.h"
+#include "hashmap.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_frozenhashmap = "%s at %p { buffer:%p, displacements:%p, count:%" PRIuMAX ", buckets:%" PRIuMAX ", seed:%" PRIu64 ", cmp:%p, hash:%p }";
+
+/* Average amount of keys in a bucket. Bigger buckets take less memory for */
+/* displacements but take longer to be placed by PFX##_freeze */
+#ifndef CMC_FROZEN_HASHMAP_BUCKET_SIZE
+#define CMC_FROZEN_HASHMAP_BUCKET_SIZE 4
+#endif
+
+/* Amount of seeds tried by PFX##_freeze before giving up */
+#ifndef CMC_FROZEN_HASHMAP_SEEDS
+#define CMC_FROZEN_HASHMAP_SEEDS 16
+#endif
+
+#ifndef CMC_IMPL_FROZEN_HASHMAP_HASH
+#define CMC_IMPL_FROZEN_HASHMAP_HASH
+
+/* Bucket of a key with the given hash */
+static inline size_t cmc_frozen_hashmap_bucket(size_t hash, uint64_t seed, size_t buckets)
+{
+    return (size_t)(cmc_hash_u64_seed(hash, seed) % buckets);
+}
+
+/* Slot of a key with the given hash in a bucket with the given displacement. */
+/* Every displacement mixes the hash with a different seed, none of them */
+/* with the seed of the buckets */
+static inline size_t cmc_frozen_hashmap_slot(size_t hash, uint64_t seed, uint32_t displacement,
+                                             size_t count)
+{
+    uint64_t slot_seed = seed + ((uint64_t)displacement + 1) * CMC_HASH_DEFAULT_SEED;
+
+    return (size_t)(cmc_hash_u64_seed(hash, slot_seed) % count);
+}
+
+#endif /* CMC_IMPL_FROZEN_HASHMAP_HASH */
+
+#define CMC_GENERATE_FROZEN_HASHMAP(PFX, SNAME, K, V)    \
+    CMC_GENERATE_FROZEN_HASHMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_FROZEN_HASHMAP_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_FROZEN_HASHMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_FROZEN_HASHMAP_HEADER(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_FROZEN_HASHMAP_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_FROZEN_HASHMAP_SOURCE(PFX, SNAME, K, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_FROZEN_HASHMAP_HEADER(PFX, SNAME, K, V)                                \
+                                                                                            \
+    /* FrozenHashMap Entry */                                                               \
+    struct SNAME##_frozen_entry                                                             \
+    {                                                                                       \
+        /* Entry Key */                                                                     \
+        K key;                                                                              \
+                                                                                            \
+        /* Entry Value */                                                                   \
+        V value;                                                                            \
+    };                                                                                      \
+                                                                                            \
+    /* FrozenHashMap Structure */                                                           \
+    struct SNAME##_frozen                                                                   \
+    {                                                                                       \
+        /* Array of count entries, each key at the slot given by its hash */                \
+        struct SNAME##_frozen_entry *buffer;                                                \
+                                                                                            \
+        /* Displacement of each bucket */                                                   \
+        uint32_t *displacements;                                                            \
+                                                                                            \
+        /* Amount of keys and of slots */                                                   \
+        size_t count;                                                                       \
+                                                                                            \
+        /* Amount of buckets */                                                             \
+        size_t buckets;                                                                     \
+                                                                                            \
+        /* Seed used to place the keys in buckets and slots */                              \
+        uint64_t seed;                                                                      \
+                                                                                            \
+        /* Key comparison function */                                                       \
+        int (*cmp)(K, K);                                                                   \
+                                                                                            \
+        /* Key hash function */                                                             \
+        size_t (*hash)(K);                                                                  \
+                                                                                            \
+        /* Lookup counters, only present with CMC_HASHTABLE_PROBE_STATS */                  \
+        CMC_IMPL_HASHTABLE_PROBE_FIELDS                                                     \
+                                                                                            \
+        /* Allocation functions, the ones of the map it was frozen from */                  \
+        struct cmc_alloc_node *alloc;                                                       \
+    };                                                                                      \
+                                                                                            \
+    /* Collection Functions */                                                              \
+    /* Collection Allocation and Deallocation */                                            \
+    struct SNAME##_frozen *PFX##_freeze(struct SNAME *_map_);                               \
+    void PFX##_frozen_free(struct SNAME##_frozen *_map_, void (*deallocator)(K, V));        \
+    /* Element Access */                                                                    \
+    V PFX##_frozen_get(struct SNAME##_frozen *_map_, K key);                                \
+    V *PFX##_frozen_get_ref(struct SNAME##_frozen *_map_, K key);                           \
+    /* Collection State */                                                                  \
+    bool PFX##_frozen_contains(struct SNAME##_frozen *_map_, K key);                        \
+    bool PFX##_frozen_empty(struct SNAME##_frozen *_map_);                                  \
+    size_t PFX##_frozen_count(struct SNAME##_frozen *_map_);                                \
+    size_t PFX##_frozen_memory_usage(struct SNAME##_frozen *_map_);                         \
+    void PFX##_frozen_stats(struct SNAME##_frozen *_map_, struct cmc_hashtable_stats *out); \
+    /* Collection Utility */                                                                \
+    struct cmc_string PFX##_frozen_to_string(struct SNAME##_frozen *_map_);                 \
+                                                                                            \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_FROZEN_HASHMAP_SOURCE(PFX, SNAME, K, V)                                        \
+                                                                                                    \
+    /* Implementation Detail Functions */                                                           \
+    static bool PFX##_impl_frozen_place(struct SNAME##_frozen *_map_,                               \
+                                        struct SNAME##_frozen_entry *entries, size_t *hashes,       \
+                                        bool *collision);                                           \
+    static struct SNAME##_frozen_entry *PFX##_impl_frozen_get_entry(struct SNAME##_frozen *_map_,   \
+                                                                    K key);                         \
+                                                                                                    \
+    /* Returns NULL if two keys have the same hash or if it ran out of memory */                    \
+    struct SNAME##_frozen *PFX##_freeze(struct SNAME *_map_)                                        \
+    {                                                                                               \
+        struct SNAME##_frozen *result = _map_->alloc->malloc(sizeof(struct SNAME##_frozen));        \
+                                                                                                    \
+        if (CMC_UNLIKELY(!result))                                                                  \
+            return NULL;                                                                            \
+                                                                                                    \
+        result->alloc = _map_->alloc;                                                               \
+        result->count = PFX##_count(_map_);                                                         \
+        result->buckets = result->count / CMC_FROZEN_HASHMAP_BUCKET_SIZE + 1;                       \
+        result->seed = CMC_HASH_DEFAULT_SEED;                                                       \
+        result->cmp = _map_->cmp;                                                                   \
+        result->hash = _map_->hash;                                                                 \
+                                                                                                    \
+        CMC_IMPL_HASHTABLE_PROBE_RESET(result);                                                     \
+                                                                                                    \
+        size_t slots = result->count == 0 ? 1 : result->count;                                      \
+                                                                                                    \
+        result->buffer = _map_->alloc->malloc(sizeof(struct SNAME##_frozen_entry) * slots);         \
+        result->displacements = _map_->alloc->calloc(result->buckets, sizeof(uint32_t));            \
+                                                                                                    \
+        struct SNAME##_frozen_entry *entries =                                                      \
+            _map_->alloc->malloc(sizeof(struct SNAME##_frozen_entry) * slots);                      \
+        size_t *hashes = _map_->alloc->malloc(sizeof(size_t) * slots);                              \
+                                                                                                    \
+        if (!result->buffer || !result->displacements || !entries || !hashes)                       \
+            goto error;                                                                             \
+                                                                                                    \
+        struct SNAME##_iter iter;                                                                   \
+        size_t i = 0;                                                                               \
+                                                                                                    \
+        for (PFX##_iter_init(&iter, _map_); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))         \
+        {                                                                                           \
+            entries[i].key = PFX##_iter_key(&iter);                                                 \
+            entries[i].value = PFX##_iter_value(&iter);                                             \
+            hashes[i] = result->hash(entries[i].key);                                               \
+            i++;                                                                                    \
+        }                                                                                           \
+                                                                                                    \
+        bool placed = false;                                                                        \
+        bool collision = false;                                                                     \
+                                                                                                    \
+        for (size_t s = 0; !placed && !collision && s < CMC_FROZEN_HASHMAP_SEEDS; s++)              \
+        {                                                                                           \
+            placed = PFX##_impl_frozen_place(result, entries, hashes, &collision);                  \
+                                                                                                    \
+            if (!placed)                                                                            \
+                result->seed = cmc_hash_u64(result->seed);                                          \
+        }                                                                                           \
+                                                                                                    \
+        if (!placed)                                                                                \
+            goto error;                                                                             \
+                                                                                                    \
+        _map_->alloc->free(entries);                                                                \
+        _map_->alloc->free(hashes);                                                                 \
+                                                                                                    \
+        return result;                                                                              \
+                                                                                                    \
+    error:                                                                                          \
+        _map_->alloc->free(result->buffer);                                                         \
+        _map_->alloc->free(result->displacements);                                                  \
+        _map_->alloc->free(result);                                                                 \
+        _map_->alloc->free(entries);                                                                \
+        _map_->alloc->free(hashes);                                                                 \
+                                                                                                    \
+        return NULL;                                                                                \
+    }                                                                                               \
+                                                                                                    \
+    void PFX##_frozen_free(struct SNAME##_frozen *_map_, void (*deallocator)(K, V))                 \
+    {                                                                                               \
+        if (deallocator)                                                                            \
+        {                                                                                           \
+            for (size_t i = 0; i < _map_->count; i++)                                               \
+                deallocator(_map_->buffer[i].key, _map_->buffer[i].value);                          \
+        }                                                                                           \
+                                                                                                    \
+        _map_->alloc->free(_map_->buffer);                                                          \
+        _map_->alloc->free(_map_->displacements);                                                   \
+        _map_->alloc->free(_map_);                                                                  \
+    }                                                                                               \
+                                                                                                    \
+    V PFX##_frozen_get(struct SNAME##_frozen *_map_, K key)                                         \
+    {                                                                                               \
+        struct SNAME##_frozen_entry *entry = PFX##_impl_frozen_get_entry(_map_, key);               \
+                                                                                                    \
+        if (!entry)                                                                                 \
+            return (V){0};                                                                          \
+                                                                                                    \
+        return entry->value;                                                                        \
+    }                                                                                               \
+                                                                                                    \
+    V *PFX##_frozen_get_ref(struct SNAME##_frozen *_map_, K key)                                    \
+    {                                                                                               \
+        struct SNAME##_frozen_entry *entry = PFX##_impl_frozen_get_entry(_map_, key);               \
+                                                                                                    \
+        if (!entry)                                                                                 \
+            return NULL;                                                                            \
+                                                                                                    \
+        return &(entry->value);                                                                     \
+    }                                                                                               \
+                                                                                                    \
+    bool PFX##_frozen_contains(struct SNAME##_frozen *_map_, K key)                                 \
+    {                                                                                               \
+        return PFX##_impl_frozen_get_entry(_map_, key) != NULL;                                     \
+    }                                                                                               \
+                                                                                                    \
+    bool PFX##_frozen_empty(struct SNAME##_frozen *_map_)                                           \
+    {                                                                                               \
+        return _map_->count == 0;                                                                   \
+    }                                                                                               \
+                                                                                                    \
+    size_t PFX##_frozen_count(struct SNAME##_frozen *_map_)                                         \
+    {                                                                                               \
+        return _map_->count;                                                                        \
+    }                                                                                               \
+                                                                                                    \
+    size_t PFX##_frozen_memory_usage(struct SNAME##_frozen *_map_)                                  \
+    {                                                                                               \
+        size_t slots = _map_->count == 0 ? 1 : _map_->count;                                        \
+                                                                                                    \
+        return sizeof(struct SNAME##_frozen) + sizeof(struct SNAME##_frozen_entry) * slots +        \
+               sizeof(uint32_t) * _map_->buckets;                                                   \
+    }                                                                                               \
+                                                                                                    \
+    /* Every key is at the only slot it is looked up in */                                          \
+    void PFX##_frozen_stats(struct SNAME##_frozen *_map_, struct cmc_hashtable_stats *out)          \
+    {                                                                                               \
+        memset(out, 0, sizeof(struct cmc_hashtable_stats));                                         \
+                                                                                                    \
+        out->capacity = _map_->count;                                                               \
+        out->count = _map_->count;                                                                  \
+        out->bytes = sizeof(struct SNAME##_frozen) +                                                \
+                     sizeof(struct SNAME##_frozen_entry) * _map_->count +                           \
+                     sizeof(uint32_t) * _map_->buckets;                                             \
+                                                                                                    \
+        for (size_t i = 0; i < _map_->count; i++)                                                   \
+            cmc_hashtable_stats_add(out, 0);                                                        \
+                                                                                                    \
+        CMC_IMPL_HASHTABLE_PROBE_ADD(out, _map_);                                                   \
+                                                                                                    \
+        cmc_hashtable_stats_end(out);                                                               \
+    }                                                                                               \
+                                                                                                    \
+    struct cmc_string PFX##_frozen_to_string(struct SNAME##_frozen *_map_)                          \
+    {                                                                                               \
+        struct cmc_string str;                                                                      \
+        struct SNAME##_frozen *m_ = _map_;                                                          \
+        const char *name = #SNAME "_frozen";                                                        \
+                                                                                                    \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_frozenhashmap,                               \
+                 name, m_, m_->buffer, m_->displacements, m_->count, m_->buckets,                   \
+                 m_->seed, m_->cmp, m_->hash);                                                      \
+                                                                                                    \
+        return str;                                                                                 \
+    }                                                                                               \
+                                                                                                    \
+    /* Finds a displacement for every bucket with the current seed and moves */                     \
+    /* the entries to their slots. Buckets are placed from the biggest to the */                    \
+    /* smallest, while there are still many free slots for the big ones. Sets */                    \
+    /* collision if two keys have the same hash, then no seed can place them */                     \
+    static bool PFX##_impl_frozen_place(struct SNAME##_frozen *_map_,                               \
+                                        struct SNAME##_frozen_entry *entries, size_t *hashes,       \
+                                        bool *collision)                                            \
+    {                                                                                               \
+        size_t count = _map_->count;                                                                \
+        size_t buckets = _map_->buckets;                                                            \
+                                                                                                    \
+        if (count == 0)                                                                             \
+            return true;                                                                            \
+                                                                                                    \
+        /* Keys grouped by bucket, the ones of bucket b start at start[b] */                        \
+        size_t *start = _map_->alloc->calloc(buckets + 1, sizeof(size_t));                          \
+        size_t *keys = _map_->alloc->malloc(sizeof(size_t) * count);                                \
+        size_t *order = _map_->alloc->malloc(sizeof(size_t) * buckets);                             \
+        size_t *slots = _map_->alloc->malloc(sizeof(size_t) * count);                               \
+        bool *taken = _map_->alloc->calloc(count, sizeof(bool));                                    \
+                                                                                                    \
+        bool result = false;                                                                        \
+                                                                                                    \
+        if (!start || !keys || !order || !slots || !taken)                                          \
+            goto end;                                                                               \
+                                                                                                    \
+        for (size_t i = 0; i < count; i++)                                                          \
+            start[cmc_frozen_hashmap_bucket(hashes[i], _map_->seed, buckets) + 1]++;                \
+                                                                                                    \
+        size_t largest = 0;                                                                         \
+                                                                                                    \
+        for (size_t b = 0; b < buckets; b++)                                                        \
+        {                                                                                           \
+            if (start[b + 1] > largest)                                                             \
+                largest = start[b + 1];                                                             \
+                                                                                                    \
+            start[b + 1] += start[b];                                                               \
+        }                                                                                           \
+                                                                                                    \
+        /* slots is used as the next free position of each bucket for now */                        \
+        memcpy(slots, start, sizeof(size_t) * buckets);                                             \
+                                                                                                    \
+        for (size_t i = 0; i < count; i++)                                                          \
+            keys[slots[cmc_frozen_hashmap_bucket(hashes[i], _map_->seed, buckets)]++] = i;          \
+                                                                                                    \
+        /* Counting sort of the buckets by their size, biggest first */                             \
+        size_t *sizes = _map_->alloc->calloc(largest + 2, sizeof(size_t));                          \
+                                                                                                    \
+        if (CMC_UNLIKELY(!sizes))                                                                   \
+            goto end;                                                                               \
+                                                                                                    \
+        for (size_t b = 0; b < buckets; b++)                                                        \
+            sizes[largest - (start[b + 1] - start[b]) + 1]++;                                       \
+                                                                                                    \
+        for (size_t s = 0; s <= largest; s++)                                                       \
+            sizes[s + 1] += sizes[s];                                                               \
+                                                                                                    \
+        for (size_t b = 0; b < buckets; b++)                                                        \
+            order[sizes[largest - (start[b + 1] - start[b])]++] = b;                                \
+                                                                                                    \
+        _map_->alloc->free(sizes);                                                                  \
+                                                                                                    \
+        for (size_t o = 0; o < buckets; o++)                                                        \
+        {                                                                                           \
+            size_t b = order[o];                                                                    \
+            size_t first = start[b];                                                                \
+            size_t size = start[b + 1] - first;                                                     \
+                                                                                                    \
+            if (size == 0)                                                                          \
+                break;                                                                              \
+                                                                                                    \
+            /* Keys with the same hash are always in the same bucket */                             \
+            for (size_t i = first; i < first + size; i++)                                           \
+            {                                                                                       \
+                for (size_t j = i + 1; j < first + size; j++)                                       \
+                {                                                                                   \
+                    if (hashes[keys[i]] == hashes[keys[j]])                                         \
+                    {                                                                               \
+                        *collision = true;                                                          \
+                        goto end;                                                                   \
+                    }                                                                               \
+                }                                                                                   \
+            }                                                                                       \
+                                                                                                    \
+            /* The last buckets have a single key and only one free slot is */                      \
+            /* left at the end, which takes about count tries to be found */                        \
+            size_t limit = count * 8 + 64;                                                          \
+            uint32_t d = 0;                                                                         \
+                                                                                                    \
+            for (; d < limit && d < UINT32_MAX; d++)                                                \
+            {                                                                                       \
+                size_t k = 0;                                                                       \
+                                                                                                    \
+                for (; k < size; k++)                                                               \
+                {                                                                                   \
+                    size_t slot = cmc_frozen_hashmap_slot(hashes[keys[first + k]],                  \
+                                                          _map_->seed, d, count);                   \
+                                                                                                    \
+                    if (taken[slot])                                                                \
+                        break;                                                                      \
+                                                                                                    \
+                    /* Keys of the same bucket can't share a slot either */                         \
+                    size_t j = 0;                                                                   \
+                                                                                                    \
+                    while (j < k && slots[j] != slot)                                               \
+                        j++;                                                                        \
+                                                                                                    \
+                    if (j < k)                                                                      \
+                        break;                                                                      \
+                                                                                                    \
+                    slots[k] = slot;                                                                \
+                }                                                                                   \
+                                                                                                    \
+                if (k == size)                                                                      \
+                    break;                                                                          \
+            }                                                                                       \
+                                                                                                    \
+            if (d == limit || d == UINT32_MAX)                                                      \
+                goto end;                                                                           \
+                                                                                                    \
+            _map_->displacements[b] = d;                                                            \
+                                                                                                    \
+            for (size_t k = 0; k < size; k++)                                                       \
+            {                                                                                       \
+                taken[slots[k]] = true;                                                             \
+                _map_->buffer[slots[k]] = entries[keys[first + k]];                                 \
+            }                                                                                       \
+        }                                                                                           \
+                                                                                                    \
+        result = true;                                                                              \
+                                                                                                    \
+    end:                                                                                            \
+        _map_->alloc->free(start);                                                                  \
+        _map_->alloc->free(keys);                                                                   \
+        _map_->alloc->free(order);                                                                  \
+        _map_->alloc->free(slots);                                                                  \
+        _map_->alloc->free(taken);                                                                  \
+                                                                                                    \
+        return result;                                                                              \
+    }                                                                                               \
+                                                                                                    \
+    static struct SNAME##_frozen_entry *PFX##_impl_frozen_get_entry(struct SNAME##_frozen *_map_,   \
+                                                                    K key)                          \
+    {                                                                                               \
+        CMC_IMPL_HASHTABLE_PROBE_LOOKUP(_map_);                                                     \
+                                                                                                    \
+        if (_map_->count == 0)                                                                      \
+            return NULL;                                                                            \
+                                                                                                    \
+        size_t hash = _map_->hash(key);                                                             \
+        size_t bucket = cmc_frozen_hashmap_bucket(hash, _map_->seed, _map_->buckets);               \
+        size_t slot = cmc_frozen_hashmap_slot(hash, _map_->seed, _map_->displacements[bucket],      \
+                                              _map_->count);                                        \
+                                                                                                    \
+        struct SNAME##_frozen_entry *entry = &(_map_->buffer[slot]);                                \
+                                                                                                    \
+        CMC_IMPL_HASHTABLE_PROBE_SLOT(_map_);                                                       \
+                                                                                                    \
+        if (_map_->cmp(entry->key, key) != 0)                                                       \
+            return NULL;                                                                            \
+                                                                                                    \
+        return entry;                                                                               \
+    }
+
+#endif /* CMC_FROZENHASHMAP_H */
@@ -0,0 +1,672 @@
+/**
+ * gaplist.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * GapList
+ *
+ * A GapList is a List for elements that are pushed and popped over and over
+ * near the same position, like the characters around the cursor of a text
+ * editor. It has the same functions to push, pop and access elements as the
+ * List.
+ *
+ * Implementation
+ *
+ * This implementation uses a gap buffer: a dynamic array whose free space is
+ * kept in the middle of the elements instead of after them. The elements
+ * before the gap are at the start of the array and the ones after it are at
+ * the end. Pushing or popping an element next to the gap only moves the
+ * edges of the gap, so it takes constant time. An edit somewhere else first
+ * moves the gap there, which moves only the elements between both
+ * positions, so a cursor that moves a little at a time makes every edit
+ * cheap and the gap is only moved far when the cursor jumps.
+ *
+ * Reading an element by its index adds the size of the gap to indices past
+ * it, so it is still done in constant time.
+ */
+
+#ifndef CMC_GAPLIST_H
+#define CMC_GAPLIST_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_growth.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_gaplist = "%s at %p { buffer:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", gap:%" PRIuMAX " }";
+
+/* A removal shrinks a collection once less than this fraction of what it */
+/* can hold without growing is in use. Define it as 0 to never shrink */
+#ifndef CMC_SHRINK_LOW_WATER
+#define CMC_SHRINK_LOW_WATER 0.25
+#endif
+
+#define CMC_GENERATE_GAPLIST(PFX, SNAME, V)    \
+    CMC_GENERATE_GAPLIST_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_GAPLIST_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_GAPLIST_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_GAPLIST_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_GAPLIST_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_GAPLIST_SOURCE(PFX, SNAME, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_GAPLIST_HEADER(PFX, SNAME, V)                                        \
+    /* GapList Structure */                                                               \
+    struct SNAME                                                                          \
+    {                                                                                     \
+        /* Dynamic array of elements with a gap in the middle */                          \
+        V *buffer;                                                                        \
+                                                                                          \
+        /* Current array capacity */                                                      \
+        size_t capacity;                                                                  \
+                                                                                          \
+        /* Current amount of elements */                                                  \
+        size_t count;                                                                     \
+                                                                                          \
+        /* Index of the element right after the gap, the amount of elements */            \
+        /* before it */                                                                   \
+        size_t gap;                                                                       \
+                                                                                          \
+        /* Custom allocation functions */                                                 \
+        struct cmc_alloc_node *alloc;                                                     \
+    };                                                                                    \
+                                                                                          \
+    /* GapList Iterator */                                                                \
+    struct SNAME##_iter                                                                   \
+    {                                                                                     \
+        /* Target gaplist */                                                              \
+        struct SNAME *target;                                                             \
+                                                                                          \
+        /* Cursor's position (index) */                                                   \
+        size_t cursor;                                                                    \
+                                                                                          \
+        /* If the iterator has reached the start of the iteration */                      \
+        bool start;                                                                       \
+                                                                                          \
+        /* If the iterator has reached the end of the iteration */                        \
+        bool end;                                                                         \
+    };                                                                                    \
+                                                                                          \
+    /* Collection Functions */                                                            \
+    /* Collection Allocation and Deallocation */                                          \
+    struct SNAME *PFX##_new(size_t capacity);                                             \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc);        \
+    void PFX##_clear(struct SNAME *_list_, void (*deallocator)(V));                       \
+    void PFX##_free(struct SNAME *_list_, void (*deallocator)(V));                        \
+    /* Collection Input and Output */                                                     \
+    bool PFX##_push_front(struct SNAME *_list_, V element);                               \
+    bool PFX##_push_at(struct SNAME *_list_, V element, size_t index);                    \
+    bool PFX##_push_back(struct SNAME *_list_, V element);                                \
+    bool PFX##_pop_front(struct SNAME *_list_);                                           \
+    bool PFX##_pop_at(struct SNAME *_list_, size_t index);                                \
+    bool PFX##_pop_back(struct SNAME *_list_);                                            \
+    /* Collection Sequence Input and Output */                                            \
+    bool PFX##_seq_push_front(struct SNAME *_list_, V *elements, size_t size);            \
+    bool PFX##_seq_push_at(struct SNAME *_list_, V *elements, size_t size, size_t index); \
+    bool PFX##_seq_push_back(struct SNAME *_list_, V *elements, size_t size);             \
+    bool PFX##_seq_pop_at(struct SNAME *_list_, size_t from, size_t to);                  \
+    /* Element Access */                                                                  \
+    V PFX##_front(struct SNAME *_list_);                                                  \
+    V PFX##_get(struct SNAME *_list_, size_t index);                                      \
+    V *PFX##_get_ref(struct SNAME *_list_, size_t index);                                 \
+    V PFX##_back(struct SNAME *_list_);                                                   \
+    size_t PFX##_indexof(struct SNAME *_list_, V element, int (*comparator)(V, V),        \
+                         bool from_start);                                                \
+    /* Collection State */                                                                \
+    bool PFX##_contains(struct SNAME *_list_, V element, int (*comparator)(V, V));        \
+    CMC_PURE bool PFX##_empty(struct SNAME *_list_);                                      \
+    bool PFX##_full(struct SNAME *_list_);                                                \
+    CMC_PURE size_t PFX##_count(struct SNAME *_list_);                                    \
+    size_t PFX##_memory_usage(struct SNAME *_list_);                                      \
+    bool PFX##_fits(struct SNAME *_list_, size_t size);                                   \
+    size_t PFX##_capacity(struct SNAME *_list_);                                          \
+    /* Collection Utility */                                                              \
+    bool PFX##_move_gap(struct SNAME *_list_, size_t index);                              \
+    bool PFX##_resize(struct SNAME *_list_, size_t capacity);                             \
+    bool PFX##_shrink_to_fit(struct SNAME *_list_);                                       \
+    bool PFX##_reserve(struct SNAME *_list_, size_t capacity);                            \
+    struct cmc_string PFX##_to_string(struct SNAME *_list_);                              \
+    bool PFX##_to_string_full(struct SNAME *_list_, struct cmc_string_builder *builder,   \
+                              const char *elem_fmt);                                      \
+    bool PFX##_write(struct SNAME *_list_, FILE *file, void (*fmt)(FILE *, V));           \
+    bool PFX##_write_fd(struct SNAME *_list_, int fd, void (*fmt)(struct cmc_dump *, V)); \
+                                                                                          \
+    /* Iterator Functions */                                                              \
+    /* Iterator Initialization */                                                         \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);                \
+    /* Iterator State */                                                                  \
+    bool PFX##_iter_start(struct SNAME##_iter *iter);                                     \
+    bool PFX##_iter_end(struct SNAME##_iter *iter);                                       \
+    /* Iterator Movement */                                                               \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter);                                  \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter);                                    \
+    bool PFX##_iter_next(struct SNAME##_iter *iter);                                      \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter);                                      \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps);                     \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps);                      \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index);                       \
+    /* Iterator Access */                                                                 \
+    V PFX##_iter_value(struct SNAME##_iter *iter);                                        \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter);                                      \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter);                                   \
+                                                                                          \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_GAPLIST_SOURCE(PFX, SNAME, V)                                              \
+    /* Implementation Detail Functions */                                                       \
+    static size_t PFX##_impl_gap_size(struct SNAME *_list_);                                    \
+    static void PFX##_impl_low_water(struct SNAME *_list_);                                     \
+    static bool PFX##_impl_grow(struct SNAME *_list_, size_t required);                         \
+                                                                                                \
+    struct SNAME *PFX##_new(size_t capacity)                                                    \
+    {                                                                                           \
+        return PFX##_new_custom(capacity, NULL);                                                \
+    }                                                                                           \
+                                                                                                \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc)               \
+    {                                                                                           \
+        if (!alloc)                                                                             \
+            alloc = &cmc_alloc_node_default;                                                    \
+                                                                                                \
+        if (capacity < 1)                                                                       \
+            return NULL;                                                                        \
+                                                                                                \
+        struct SNAME *_list_ = alloc->malloc(sizeof(struct SNAME));                             \
+                                                                                                \
+        if (CMC_UNLIKELY(!_list_))                                                              \
+            return NULL;                                                                        \
+                                                                                                \
+        _list_->alloc = alloc;                                                                  \
+                                                                                                \
+        _list_->buffer = alloc->malloc(sizeof(V) * capacity);                                   \
+                                                                                                \
+        if (CMC_UNLIKELY(!_list_->buffer))                                                      \
+        {                                                                                       \
+            alloc->free(_list_);                                                                \
+            return NULL;                                                                        \
+        }                                                                                       \
+                                                                                                \
+        _list_->capacity = capacity;                                                            \
+        _list_->count = 0;                                                                      \
+        _list_->gap = 0;                                                                        \
+                                                                                                \
+        return _list_;                                                                          \
+    }                                                                                           \
+                                                                                                \
+    void PFX##_clear(struct SNAME *_list_, void (*deallocator)(V))                              \
+    {                                                                                           \
+        if (deallocator)                                                                        \
+        {                                                                                       \
+            for (size_t i = 0; i < _list_->count; i++)                                          \
+                deallocator(PFX##_get(_list_, i));                                              \
+        }                                                                                       \
+                                                                                                \
+        _list_->count = 0;                                                                      \
+        _list_->gap = 0;                                                                        \
+    }                                                                                           \
+                                                                                                \
+    void PFX##_free(struct SNAME *_list_, void (*deallocator)(V))                               \
+    {                                                                                           \
+        PFX##_clear(_list_, deallocator);                                                       \
+                                                                                                \
+        _list_->alloc->free(_list_->buffer);                                                    \
+        _list_->alloc->free(_list_);                                                            \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_push_front(struct SNAME *_list_, V element)                                      \
+    {                                                                                           \
+        return PFX##_push_at(_list_, element, 0);                                               \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_push_at(struct SNAME *_list_, V element, size_t index)                           \
+    {                                                                                           \
+        return PFX##_seq_push_at(_list_, &element, 1, index);                                   \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_push_back(struct SNAME *_list_, V element)                                       \
+    {                                                                                           \
+        return PFX##_push_at(_list_, element, _list_->count);                                   \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_pop_front(struct SNAME *_list_)                                                  \
+    {                                                                                           \
+        return PFX##_seq_pop_at(_list_, 0, 0);                                                  \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_pop_at(struct SNAME *_list_, size_t index)                                       \
+    {                                                                                           \
+        return PFX##_seq_pop_at(_list_, index, index);                                          \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_pop_back(struct SNAME *_list_)                                                   \
+    {                                                                                           \
+        if (PFX##_empty(_list_))                                                                \
+            return false;                                                                       \
+                                                                                                \
+        return PFX##_seq_pop_at(_list_, _list_->count - 1, _list_->count - 1);                  \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_seq_push_front(struct SNAME *_list_, V *elements, size_t size)                   \
+    {                                                                                           \
+        return PFX##_seq_push_at(_list_, elements, size, 0);                                    \
+    }                                                                                           \
+                                                                                                \
+    /* The gap is moved to index and the elements fill its start */                             \
+    bool PFX##_seq_push_at(struct SNAME *_list_, V *elements, size_t size, size_t index)        \
+    {                                                                                           \
+        if (size == 0 || index > _list_->count)                                                 \
+            return false;                                                                       \
+                                                                                                \
+        if (!PFX##_fits(_list_, size))                                                          \
+        {                                                                                       \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_list_, _list_->count + size)))                   \
+                return false;                                                                   \
+        }                                                                                       \
+                                                                                                \
+        PFX##_move_gap(_list_, index);                                                          \
+                                                                                                \
+        memcpy(_list_->buffer + _list_->gap, elements, size * sizeof(V));                       \
+                                                                                                \
+        _list_->gap += size;                                                                    \
+        _list_->count += size;                                                                  \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_seq_push_back(struct SNAME *_list_, V *elements, size_t size)                    \
+    {                                                                                           \
+        return PFX##_seq_push_at(_list_, elements, size, _list_->count);                        \
+    }                                                                                           \
+                                                                                                \
+    /* The gap is moved next to the range, whichever side is closer, and */                     \
+    /* then widened over it */                                                                  \
+    bool PFX##_seq_pop_at(struct SNAME *_list_, size_t from, size_t to)                         \
+    {                                                                                           \
+        if (from > to || to >= _list_->count)                                                   \
+            return false;                                                                       \
+                                                                                                \
+        if (to < _list_->gap)                                                                   \
+        {                                                                                       \
+            PFX##_move_gap(_list_, to + 1);                                                     \
+                                                                                                \
+            _list_->gap = from;                                                                 \
+        }                                                                                       \
+        else                                                                                    \
+            PFX##_move_gap(_list_, from);                                                       \
+                                                                                                \
+        _list_->count -= to - from + 1;                                                         \
+                                                                                                \
+        PFX##_impl_low_water(_list_);                                                           \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    V PFX##_front(struct SNAME *_list_)                                                         \
+    {                                                                                           \
+        if (PFX##_empty(_list_))                                                                \
+            return (V){0};                                                                      \
+                                                                                                \
+        return PFX##_get(_list_, 0);                                                            \
+    }                                                                                           \
+                                                                                                \
+    V PFX##_get(struct SNAME *_list_, size_t index)                                             \
+    {                                                                                           \
+        if (index >= _list_->count)                                                             \
+            return (V){0};                                                                      \
+                                                                                                \
+        if (index >= _list_->gap)                                                               \
+            index += PFX##_impl_gap_size(_list_);                                               \
+                                                                                                \
+        return _list_->buffer[index];                                                           \
+    }                                                                                           \
+                                                                                                \
+    V *PFX##_get_ref(struct SNAME *_list_, size_t index)                                        \
+    {                                                                                           \
+        if (index >= _list_->count)                                                             \
+            return NULL;                                                                        \
+                                                                                                \
+        if (index >= _list_->gap)                                                               \
+            index += PFX##_impl_gap_size(_list_);                                               \
+                                                                                                \
+        return &(_list_->buffer[index]);                                                        \
+    }                                                                                           \
+                                                                                                \
+    V PFX##_back(struct SNAME *_list_)                                                          \
+    {                                                                                           \
+        if (PFX##_empty(_list_))                                                                \
+            return (V){0};                                                                      \
+                                                                                                \
+        return PFX##_get(_list_, _list_->count - 1);                                            \
+    }                                                                                           \
+                                                                                                \
+    size_t PFX##_indexof(struct SNAME *_list_, V element, int (*comparator)(V, V),              \
+                         bool from_start)                                                       \
+    {                                                                                           \
+        if (from_start)                                                                         \
+        {                                                                                       \
+            for (size_t i = 0; i < _list_->count; i++)                                          \
+            {                                                                                   \
+                if (comparator(PFX##_get(_list_, i), element) == 0)                             \
+                    return i;                                                                   \
+            }                                                                                   \
+        }                                                                                       \
+        else                                                                                    \
+        {                                                                                       \
+            for (size_t i = _list_->count; i > 0; i--)                                          \
+            {                                                                                   \
+                if (comparator(PFX##_get(_list_, i - 1), element) == 0)                         \
+                    return i - 1;                                                               \
+            }                                                                                   \
+        }                                                                                       \
+                                                                                                \
+        return _list_->count;                                                                   \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_contains(struct SNAME *_list_, V element, int (*comparator)(V, V))               \
+    {                                                                                           \
+        return PFX##_indexof(_list_, element, comparator, true) != _list_->count;               \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_empty(struct SNAME *_list_)                                                      \
+    {                                                                                           \
+        return _list_->count == 0;                                                              \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_full(struct SNAME *_list_)                                                       \
+    {                                                                                           \
+        return _list_->count >= _list_->capacity;                                               \
+    }                                                                                           \
+                                                                                                \
+    size_t PFX##_count(struct SNAME *_list_)                                                    \
+    {                                                                                           \
+        return _list_->count;                                                                   \
+    }                                                                                           \
+                                                                                                \
+    size_t PFX##_memory_usage(struct SNAME *_list_)                                             \
+    {                                                                                           \
+        return sizeof(struct SNAME) + sizeof(V) * _list_->capacity;                             \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_fits(struct SNAME *_list_, size_t size)                                          \
+    {                                                                                           \
+        return _list_->count + size <= _list_->capacity;                                        \
+    }                                                                                           \
+                                                                                                \
+    size_t PFX##_capacity(struct SNAME *_list_)                                                 \
+    {                                                                                           \
+        return _list_->capacity;                                                                \
+    }                                                                                           \
+                                                                                                \
+    /* Moves the gap so that index elements are before it. Only the */                          \
+    /* elements between the old and the new position are moved */                               \
+    bool PFX##_move_gap(struct SNAME *_list_, size_t index)                                     \
+    {                                                                                           \
+        if (index > _list_->count)                                                              \
+            return false;                                                                       \
+                                                                                                \
+        size_t gap_size = PFX##_impl_gap_size(_list_);                                          \
+                                                                                                \
+        V *buffer = _list_->buffer;                                                             \
+                                                                                                \
+        if (index < _list_->gap)                                                                \
+            memmove(buffer + index + gap_size, buffer + index,                                  \
+                    (_list_->gap - index) * sizeof(V));                                         \
+        else if (index > _list_->gap)                                                           \
+            memmove(buffer + _list_->gap, buffer + _list_->gap + gap_size,                      \
+                    (index - _list_->gap) * sizeof(V));                                         \
+                                                                                                \
+        _list_->gap = index;                                                                    \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    /* The elements after the gap are kept at the end of the buffer */                          \
+    bool PFX##_resize(struct SNAME *_list_, size_t capacity)                                    \
+    {                                                                                           \
+        if (PFX##_capacity(_list_) == capacity)                                                 \
+            return true;                                                                        \
+                                                                                                \
+        if (capacity < PFX##_count(_list_) || capacity == 0)                                    \
+            return false;                                                                       \
+                                                                                                \
+        size_t after = _list_->count - _list_->gap;                                             \
+        size_t old_start = _list_->capacity - after;                                            \
+        size_t new_start = capacity - after;                                                    \
+                                                                                                \
+        if (capacity < _list_->capacity)                                                        \
+            memmove(_list_->buffer + new_start, _list_->buffer + old_start, after * sizeof(V)); \
+                                                                                                \
+        V *new_buffer = _list_->alloc->realloc(_list_->buffer, sizeof(V) * capacity);           \
+                                                                                                \
+        if (CMC_UNLIKELY(!new_buffer))                                                          \
+        {                                                                                       \
+            if (capacity < _list_->capacity)                                                    \
+                memmove(_list_->buffer + old_start, _list_->buffer + new_start,                 \
+                        after * sizeof(V));                                                     \
+                                                                                                \
+            return false;                                                                       \
+        }                                                                                       \
+                                                                                                \
+        if (capacity > _list_->capacity)                                                        \
+            memmove(new_buffer + new_start, new_buffer + old_start, after * sizeof(V));         \
+                                                                                                \
+        _list_->buffer = new_buffer;                                                            \
+        _list_->capacity = capacity;                                                            \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_shrink_to_fit(struct SNAME *_list_)                                              \
+    {                                                                                           \
+        return PFX##_resize(_list_, _list_->count > 0 ? _list_->count : 1);                     \
+    }                                                                                           \
+                                                                                                \
+    /* Grows the buffer so that at least capacity elements fit. Unlike */                       \
+    /* resize it never shrinks the buffer */                                                    \
+    bool PFX##_reserve(struct SNAME *_list_, size_t capacity)                                   \
+    {                                                                                           \
+        if (capacity <= _list_->capacity)                                                       \
+            return true;                                                                        \
+                                                                                                \
+        return PFX##_resize(_list_, capacity);                                                  \
+    }                                                                                           \
+                                                                                                \
+    struct cmc_string PFX##_to_string(struct SNAME *_list_)                                     \
+    {                                                                                           \
+        struct cmc_string str;                                                                  \
+        struct SNAME *l_ = _list_;                                                              \
+        const char *name = #SNAME;                                                              \
+                                                                                                \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_gaplist, name, l_, l_->buffer,           \
+                 l_->capacity, l_->count, l_->gap);                                             \
+                                                                                                \
+        return str;                                                                             \
+    }                                                                                           \
+                                                                                                \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE)                              \
+                                                                                                \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE, (V))                                \
+                                                                                                \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                       \
+    {                                                                                           \
+        iter->target = target;                                                                  \
+        iter->cursor = 0;                                                                       \
+        iter->start = true;                                                                     \
+        iter->end = PFX##_empty(target);                                                        \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                            \
+    {                                                                                           \
+        return PFX##_empty(iter->target) || iter->start;                                        \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                              \
+    {                                                                                           \
+        return PFX##_empty(iter->target) || iter->end;                                          \
+    }                                                                                           \
+                                                                                                \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                         \
+    {                                                                                           \
+        if (!PFX##_empty(iter->target))                                                         \
+        {                                                                                       \
+            iter->cursor = 0;                                                                   \
+            iter->start = true;                                                                 \
+            iter->end = false;                                                                  \
+        }                                                                                       \
+    }                                                                                           \
+                                                                                                \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                           \
+    {                                                                                           \
+        if (!PFX##_empty(iter->target))                                                         \
+        {                                                                                       \
+            iter->cursor = iter->target->count - 1;                                             \
+            iter->start = false;                                                                \
+            iter->end = true;                                                                   \
+        }                                                                                       \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                             \
+    {                                                                                           \
+        if (iter->end)                                                                          \
+            return false;                                                                       \
+                                                                                                \
+        if (iter->cursor + 1 == iter->target->count)                                            \
+        {                                                                                       \
+            iter->end = true;                                                                   \
+            return false;                                                                       \
+        }                                                                                       \
+                                                                                                \
+        iter->start = false;                                                                    \
+        iter->cursor++;                                                                         \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                             \
+    {                                                                                           \
+        if (iter->start)                                                                        \
+            return false;                                                                       \
+                                                                                                \
+        if (iter->cursor == 0)                                                                  \
+        {                                                                                       \
+            iter->start = true;                                                                 \
+            return false;                                                                       \
+        }                                                                                       \
+                                                                                                \
+        iter->end = false;                                                                      \
+        iter->cursor--;                                                                         \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    /* Returns true only if the iterator moved */                                               \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps)                            \
+    {                                                                                           \
+        if (iter->end)                                                                          \
+            return false;                                                                       \
+                                                                                                \
+        if (iter->cursor + 1 == iter->target->count)                                            \
+        {                                                                                       \
+            iter->end = true;                                                                   \
+            return false;                                                                       \
+        }                                                                                       \
+                                                                                                \
+        if (steps == 0 || iter->cursor + steps >= iter->target->count)                          \
+            return false;                                                                       \
+                                                                                                \
+        iter->start = false;                                                                    \
+        iter->cursor += steps;                                                                  \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    /* Returns true only if the iterator moved */                                               \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps)                             \
+    {                                                                                           \
+        if (iter->start)                                                                        \
+            return false;                                                                       \
+                                                                                                \
+        if (iter->cursor == 0)                                                                  \
+        {                                                                                       \
+            iter->start = true;                                                                 \
+            return false;                                                                       \
+        }                                                                                       \
+                                                                                                \
+        if (steps == 0 || iter->cursor < steps)                                                 \
+            return false;                                                                       \
+                                                                                                \
+        iter->end = false;                                                                      \
+        iter->cursor -= steps;                                                                  \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    /* Returns true only if the iterator was able to be positioned at the */                    \
+    /* given index */                                                                           \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index)                              \
+    {                                                                                           \
+        if (index >= iter->target->count)                                                       \
+            return false;                                                                       \
+                                                                                                \
+        if (iter->cursor > index)                                                               \
+            return PFX##_iter_rewind(iter, iter->cursor - index);                               \
+        else if (iter->cursor < index)                                                          \
+            return PFX##_iter_advance(iter, index - iter->cursor);                              \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                               \
+    {                                                                                           \
+        return PFX##_get(iter->target, iter->cursor);                                           \
+    }                                                                                           \
+                                                                                                \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter)                                             \
+    {                                                                                           \
+        return PFX##_get_ref(iter->target, iter->cursor);                                       \
+    }                                                                                           \
+                                                                                                \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                          \
+    {                                                                                           \
+        return iter->cursor;                                                                    \
+    }                                                                                           \
+                                                                                                \
+    static size_t PFX##_impl_gap_size(struct SNAME *_list_)                                     \
+    {                                                                                           \
+        return _list_->capacity - _list_->count;                                                \
+    }                                                                                           \
+                                                                                                \
+    /* Called after removals, halves the buffer until it is no longer mostly empty */           \
+    static void PFX##_impl_low_water(struct SNAME *_list_)                                      \
+    {                                                                                           \
+        size_t capacity = _list_->capacity;                                                     \
+                                                                                                \
+        while (capacity > 1 &&                                                                  \
+               (double)_list_->count < (double)capacity * CMC_SHRINK_LOW_WATER)                 \
+            capacity /= 2;                                                                      \
+                                                                                                \
+        if (capacity != _list_->capacity)                                                       \
+            PFX##_resize(_list_, capacity);                                                     \
+    }                                                                                           \
+                                                                                                \
+    /* Called when the buffer is full, grows it by the policy of cmc_growth.h */                \
+    static bool PFX##_impl_grow(struct SNAME *_list_, size_t required)                          \
+    {                                                                                           \
+        return PFX##_resize(_list_, cmc_growth_capacity(_list_->capacity, required));           \
+    }
+
+#endif /* CMC_GAPLIST_H */
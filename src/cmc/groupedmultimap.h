@@ -0,0 +1,388 @@
+/**
+ * groupedmultimap.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * GroupedMultiMap
+ *
+ * A GroupedMultiMap is a MultiMap that keeps a single entry for each distinct
+ * key. That entry points to a contiguous and growable array with every value
+ * mapped to the key, in insertion order. Reading all values of a key is then a
+ * single look up followed by a linear scan, instead of walking a linked list
+ * where entries of other keys are interleaved.
+ *
+ * Implementation
+ *
+ * The keys are stored in a HashMap (hashmap.h) generated with the _groups
+ * suffix whose values are the arrays of each key. Removing a value shifts the
+ * ones that follow it so that the order of insertion is kept and, like the
+ * MultiMap, the first value added to a key is the first to be removed.
+ */
+
+#ifndef CMC_GROUPEDMULTIMAP_H
+#define CMC_GROUPEDMULTIMAP_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+#include "hashmap.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_groupedmultimap = "%s at %p { groups:%p, keys:%" PRIuMAX ", count:%" PRIuMAX ", cmp:%p, hash:%p }";
+
+/* Initial capacity of the array of values of a key */
+#ifndef CMC_GROUPED_MULTIMAP_GROUP_SIZE
+#define CMC_GROUPED_MULTIMAP_GROUP_SIZE 4
+#endif
+
+#define CMC_GENERATE_GROUPED_MULTIMAP(PFX, SNAME, K, V)    \
+    CMC_GENERATE_GROUPED_MULTIMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_GROUPED_MULTIMAP_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_GROUPED_MULTIMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_GROUPED_MULTIMAP_HEADER(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_GROUPED_MULTIMAP_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_GROUPED_MULTIMAP_SOURCE(PFX, SNAME, K, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_GROUPED_MULTIMAP_HEADER(PFX, SNAME, K, V)                                      \
+                                                                                                    \
+    /* GroupedMultiMap Structure */                                                                 \
+    struct SNAME                                                                                    \
+    {                                                                                               \
+        /* Maps each distinct key to its values */                                                  \
+        struct SNAME##_groups *groups;                                                              \
+                                                                                                    \
+        /* Current amount of values */                                                              \
+        size_t count;                                                                               \
+                                                                                                    \
+        /* Key comparison function */                                                               \
+        int (*cmp)(K, K);                                                                           \
+                                                                                                    \
+        /* Key hash function */                                                                     \
+        size_t (*hash)(K);                                                                          \
+                                                                                                    \
+        /* Custom allocation functions */                                                           \
+        struct cmc_alloc_node *alloc;                                                               \
+    };                                                                                              \
+                                                                                                    \
+    /* Values mapped to a key */                                                                    \
+    struct SNAME##_group                                                                            \
+    {                                                                                               \
+        /* Array of values in insertion order */                                                    \
+        V *values;                                                                                  \
+                                                                                                    \
+        /* Current amount of values */                                                              \
+        size_t count;                                                                               \
+                                                                                                    \
+        /* Current array capacity */                                                                \
+        size_t capacity;                                                                            \
+    };                                                                                              \
+                                                                                                    \
+    /* The HashMap from keys to groups */                                                           \
+    CMC_GENERATE_HASHMAP_HEADER(PFX##_groups, SNAME##_groups, K, struct SNAME##_group)              \
+                                                                                                    \
+    /* Collection Functions */                                                                      \
+    /* Collection Allocation and Deallocation */                                                    \
+    struct SNAME *PFX##_new(size_t capacity, double load, int (*compare)(K, K), size_t (*hash)(K)); \
+    struct SNAME *PFX##_new_custom(size_t capacity, double load, int (*compare)(K, K),              \
+                                   size_t (*hash)(K), struct cmc_alloc_node *alloc);                \
+    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V *, size_t));                     \
+    void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V *, size_t));                      \
+    /* Collection Input and Output */                                                               \
+    bool PFX##_insert(struct SNAME *_map_, K key, V value);                                         \
+    bool PFX##_remove(struct SNAME *_map_, K key, V *out_value);                                    \
+    size_t PFX##_remove_all(struct SNAME *_map_, K key, V **out_values);                            \
+    /* Element Access */                                                                            \
+    V PFX##_get(struct SNAME *_map_, K key);                                                        \
+    bool PFX##_get_all(struct SNAME *_map_, K key, V **out, size_t *n);                             \
+    /* Collection State */                                                                          \
+    bool PFX##_contains(struct SNAME *_map_, K key);                                                \
+    CMC_PURE bool PFX##_empty(struct SNAME *_map_);                                                 \
+    CMC_PURE size_t PFX##_count(struct SNAME *_map_);                                               \
+    size_t PFX##_memory_usage(struct SNAME *_map_);                                                 \
+    size_t PFX##_key_count(struct SNAME *_map_, K key);                                             \
+    size_t PFX##_keys(struct SNAME *_map_);                                                         \
+    void PFX##_stats(struct SNAME *_map_, struct cmc_hashtable_stats *out);                         \
+    /* Collection Utility */                                                                        \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_);                                         \
+                                                                                                    \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_GROUPED_MULTIMAP_SOURCE(PFX, SNAME, K, V)                                     \
+                                                                                                   \
+    CMC_GENERATE_HASHMAP_SOURCE(PFX##_groups, SNAME##_groups, K, struct SNAME##_group)             \
+                                                                                                   \
+    /* Implementation Detail Functions */                                                          \
+    static void PFX##_impl_free_groups(struct SNAME *_map_, void (*deallocator)(K, V *, size_t));  \
+                                                                                                   \
+    struct SNAME *PFX##_new(size_t capacity, double load, int (*compare)(K, K), size_t (*hash)(K)) \
+    {                                                                                              \
+        return PFX##_new_custom(capacity, load, compare, hash, NULL);                              \
+    }                                                                                              \
+                                                                                                   \
+    struct SNAME *PFX##_new_custom(size_t capacity, double load, int (*compare)(K, K),             \
+                                   size_t (*hash)(K), struct cmc_alloc_node *alloc)                \
+    {                                                                                              \
+        if (!alloc)                                                                                \
+            alloc = &cmc_alloc_node_default;                                                       \
+                                                                                                   \
+        struct SNAME *_map_ = alloc->malloc(sizeof(struct SNAME));                                 \
+                                                                                                   \
+        if (CMC_UNLIKELY(!_map_))                                                                  \
+            return NULL;                                                                           \
+                                                                                                   \
+        _map_->alloc = alloc;                                                                      \
+                                                                                                   \
+        _map_->groups = PFX##_groups_new(capacity, load, compare, hash);                           \
+                                                                                                   \
+        if (!_map_->groups)                                                                        \
+        {                                                                                          \
+            alloc->free(_map_);                                                                    \
+            return NULL;                                                                           \
+        }                                                                                          \
+                                                                                                   \
+        _map_->count = 0;                                                                          \
+        _map_->cmp = compare;                                                                      \
+        _map_->hash = hash;                                                                        \
+                                                                                                   \
+        return _map_;                                                                              \
+    }                                                                                              \
+                                                                                                   \
+    /* The deallocator is called once for every key with all of its values */                      \
+    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V *, size_t))                     \
+    {                                                                                              \
+        PFX##_impl_free_groups(_map_, deallocator);                                                \
+                                                                                                   \
+        PFX##_groups_clear(_map_->groups, NULL);                                                   \
+                                                                                                   \
+        _map_->count = 0;                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    /* The deallocator is called once for every key with all of its values */                      \
+    void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V *, size_t))                      \
+    {                                                                                              \
+        PFX##_impl_free_groups(_map_, deallocator);                                                \
+                                                                                                   \
+        PFX##_groups_free(_map_->groups, NULL);                                                    \
+                                                                                                   \
+        _map_->alloc->free(_map_);                                                                 \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_insert(struct SNAME *_map_, K key, V value)                                         \
+    {                                                                                              \
+        struct SNAME##_group *group =                                                              \
+            PFX##_groups_get_or_insert(_map_->groups, key, (struct SNAME##_group){0});             \
+                                                                                                   \
+        if (!group)                                                                                \
+            return false;                                                                          \
+                                                                                                   \
+        if (group->count == group->capacity)                                                       \
+        {                                                                                          \
+            size_t capacity =                                                                      \
+                group->capacity == 0 ? CMC_GROUPED_MULTIMAP_GROUP_SIZE : group->capacity * 2;      \
+                                                                                                   \
+            V *values = _map_->alloc->realloc(group->values, sizeof(V) * capacity);                \
+                                                                                                   \
+            if (CMC_UNLIKELY(!values))                                                             \
+            {                                                                                      \
+                /* Do not leave an empty group behind */                                           \
+                if (group->count == 0)                                                             \
+                    PFX##_groups_remove(_map_->groups, key, NULL);                                 \
+                                                                                                   \
+                return false;                                                                      \
+            }                                                                                      \
+                                                                                                   \
+            group->values = values;                                                                \
+            group->capacity = capacity;                                                            \
+        }                                                                                          \
+                                                                                                   \
+        group->values[group->count++] = value;                                                     \
+                                                                                                   \
+        _map_->count++;                                                                            \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Removes the first value that was added to the key */                                        \
+    bool PFX##_remove(struct SNAME *_map_, K key, V *out_value)                                    \
+    {                                                                                              \
+        struct SNAME##_group *group = PFX##_groups_get_ref(_map_->groups, key);                    \
+                                                                                                   \
+        if (!group)                                                                                \
+            return false;                                                                          \
+                                                                                                   \
+        if (out_value)                                                                             \
+            *out_value = group->values[0];                                                         \
+                                                                                                   \
+        if (group->count == 1)                                                                     \
+        {                                                                                          \
+            _map_->alloc->free(group->values);                                                     \
+                                                                                                   \
+            PFX##_groups_remove(_map_->groups, key, NULL);                                         \
+        }                                                                                          \
+        else                                                                                       \
+        {                                                                                          \
+            group->count--;                                                                        \
+                                                                                                   \
+            memmove(group->values, group->values + 1, sizeof(V) * group->count);                   \
+        }                                                                                          \
+                                                                                                   \
+        _map_->count--;                                                                            \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* The array of values is handed over to out_values, which must be freed */                    \
+    size_t PFX##_remove_all(struct SNAME *_map_, K key, V **out_values)                            \
+    {                                                                                              \
+        struct SNAME##_group group;                                                                \
+                                                                                                   \
+        if (!PFX##_groups_remove(_map_->groups, key, &group))                                      \
+            return 0;                                                                              \
+                                                                                                   \
+        if (out_values)                                                                            \
+            *out_values = group.values;                                                            \
+        else                                                                                       \
+            _map_->alloc->free(group.values);                                                      \
+                                                                                                   \
+        _map_->count -= group.count;                                                               \
+                                                                                                   \
+        return group.count;                                                                        \
+    }                                                                                              \
+                                                                                                   \
+    V PFX##_get(struct SNAME *_map_, K key)                                                        \
+    {                                                                                              \
+        struct SNAME##_group *group = PFX##_groups_get_ref(_map_->groups, key);                    \
+                                                                                                   \
+        if (!group)                                                                                \
+            return (V){0};                                                                         \
+                                                                                                   \
+        return group->values[0];                                                                   \
+    }                                                                                              \
+                                                                                                   \
+    /* Gives a view of every value of a key without copying them. The view */                      \
+    /* is valid until the next time the map is modified */                                         \
+    bool PFX##_get_all(struct SNAME *_map_, K key, V **out, size_t *n)                             \
+    {                                                                                              \
+        struct SNAME##_group *group = PFX##_groups_get_ref(_map_->groups, key);                    \
+                                                                                                   \
+        if (!group)                                                                                \
+        {                                                                                          \
+            *out = NULL;                                                                           \
+            *n = 0;                                                                                \
+                                                                                                   \
+            return false;                                                                          \
+        }                                                                                          \
+                                                                                                   \
+        *out = group->values;                                                                      \
+        *n = group->count;                                                                         \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_contains(struct SNAME *_map_, K key)                                                \
+    {                                                                                              \
+        return PFX##_groups_contains(_map_->groups, key);                                          \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_empty(struct SNAME *_map_)                                                          \
+    {                                                                                              \
+        return _map_->count == 0;                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    size_t PFX##_count(struct SNAME *_map_)                                                        \
+    {                                                                                              \
+        return _map_->count;                                                                       \
+    }                                                                                              \
+                                                                                                   \
+    size_t PFX##_memory_usage(struct SNAME *_map_)                                                 \
+    {                                                                                              \
+        size_t bytes = sizeof(struct SNAME) + PFX##_groups_memory_usage(_map_->groups);            \
+                                                                                                   \
+        struct SNAME##_groups_iter iter;                                                           \
+                                                                                                   \
+        PFX##_groups_iter_init(&iter, _map_->groups);                                              \
+                                                                                                   \
+        for (PFX##_groups_iter_to_start(&iter); !PFX##_groups_iter_end(&iter);                     \
+             PFX##_groups_iter_next(&iter))                                                        \
+            bytes += sizeof(V) * PFX##_groups_iter_rvalue(&iter)->capacity;                        \
+                                                                                                   \
+        return bytes;                                                                              \
+    }                                                                                              \
+                                                                                                   \
+    size_t PFX##_key_count(struct SNAME *_map_, K key)                                             \
+    {                                                                                              \
+        struct SNAME##_group *group = PFX##_groups_get_ref(_map_->groups, key);                    \
+                                                                                                   \
+        return group ? group->count : 0;                                                           \
+    }                                                                                              \
+                                                                                                   \
+    /* Amount of distinct keys */                                                                  \
+    size_t PFX##_keys(struct SNAME *_map_)                                                         \
+    {                                                                                              \
+        return PFX##_groups_count(_map_->groups);                                                  \
+    }                                                                                              \
+                                                                                                   \
+    /* Reports the hashtable of groups, one entry for each distinct key, */                        \
+    /* with the bytes of every array of values */                                                  \
+    void PFX##_stats(struct SNAME *_map_, struct cmc_hashtable_stats *out)                         \
+    {                                                                                              \
+        PFX##_groups_stats(_map_->groups, out);                                                    \
+                                                                                                   \
+        out->bytes += sizeof(struct SNAME);                                                        \
+                                                                                                   \
+        struct SNAME##_groups_iter iter;                                                           \
+                                                                                                   \
+        PFX##_groups_iter_init(&iter, _map_->groups);                                              \
+                                                                                                   \
+        for (PFX##_groups_iter_to_start(&iter); !PFX##_groups_iter_end(&iter);                     \
+             PFX##_groups_iter_next(&iter))                                                        \
+        {                                                                                          \
+            out->bytes += sizeof(V) * PFX##_groups_iter_rvalue(&iter)->capacity;                   \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_)                                         \
+    {                                                                                              \
+        struct cmc_string str;                                                                     \
+        struct SNAME *m_ = _map_;                                                                  \
+        const char *name = #SNAME;                                                                 \
+                                                                                                   \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_groupedmultimap,                            \
+                 name, m_, m_->groups, PFX##_groups_count(m_->groups), m_->count, m_->cmp,         \
+                 m_->hash);                                                                        \
+                                                                                                   \
+        return str;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    static void PFX##_impl_free_groups(struct SNAME *_map_, void (*deallocator)(K, V *, size_t))   \
+    {                                                                                              \
+        struct SNAME##_groups_iter iter;                                                           \
+                                                                                                   \
+        PFX##_groups_iter_init(&iter, _map_->groups);                                              \
+                                                                                                   \
+        for (PFX##_groups_iter_to_start(&iter); !PFX##_groups_iter_end(&iter);                     \
+             PFX##_groups_iter_next(&iter))                                                        \
+        {                                                                                          \
+            struct SNAME##_group *group = PFX##_groups_iter_rvalue(&iter);                         \
+                                                                                                   \
+            if (deallocator)                                                                       \
+                deallocator(PFX##_groups_iter_key(&iter), group->values, group->count);            \
+                                                                                                   \
+            _map_->alloc->free(group->values);                                                     \
+        }                                                                                          \
+    }
+
+#endif /* CMC_GROUPEDMULTIMAP_H */
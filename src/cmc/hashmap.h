@@ -20,15 +20,28 @@
 #define CMC_HASHMAP_H
 
 #include <inttypes.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_math.h"
+#include "../utl/cmc_parallel.h"
+#include "../utl/cmc_serial.h"
 #include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
 
 /* to_string format */
 static const char *cmc_string_fmt_hashmap = "%s at %p { buffer:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", load:%lf, cmp:%p, hash:%p }";
 
+/* A removal shrinks a collection once less than this fraction of what it */
+/* can hold without growing is in use. Define it as 0 to never shrink */
+#ifndef CMC_SHRINK_LOW_WATER
+#define CMC_SHRINK_LOW_WATER 0.25
+#endif
+
 #ifndef CMC_IMPL_HASHTABLE_STATE
 #define CMC_IMPL_HASHTABLE_STATE
 
@@ -39,6 +52,17 @@ enum cmc_entry_state
     CMC_ES_FILLED = 1
 };
 
+/* The state of an entry and its distance to its original position are packed */
+/* together as bit-fields. Only tables bigger than CMC_ES_DIST_MAX can have a */
+/* distance that does not fit and these grow instead of storing it */
+#if UINT_MAX >= 0xFFFFFFFF
+#define CMC_ES_DIST_BITS 30
+#else
+#define CMC_ES_DIST_BITS 14
+#endif
+
+#define CMC_ES_DIST_MAX (((size_t)1 << CMC_ES_DIST_BITS) - 1)
+
 #endif /* CMC_IMPL_HASHTABLE_STATE */
 
 #ifndef CMC_IMPL_HASHTABLE_SETUP
@@ -76,20 +100,601 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                               6917529027641081903,
                                               13835058055282163729llu};
 
+/* Smallest prime from cmc_hashtable_primes that is greater or equal to */
+/* required, found with a binary search. Used by the default (prime sized) */
+/* hashtables */
+static inline size_t cmc_hashtable_prime_size(size_t required)
+{
+    const size_t count = sizeof(cmc_hashtable_primes) / sizeof(cmc_hashtable_primes[0]);
+
+    if (cmc_hashtable_primes[count - 1] < required)
+        return required;
+
+    size_t low = 0;
+    size_t high = count - 1;
+
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+
+        if (cmc_hashtable_primes[mid] < required)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return cmc_hashtable_primes[low];
+}
+
+/* Prime sized tables reduce a hash to a slot with Lemire's fastmod, which */
+/* replaces the division of the modulo with a few multiplications by a */
+/* multiplier computed once for every capacity. Without 128 bit integers */
+/* the multiplier is not used and the modulo is kept */
+#if defined(__SIZEOF_INT128__) && SIZE_MAX == UINT64_MAX
+__extension__ typedef unsigned __int128 cmc_fastmod;
+
+static inline cmc_fastmod cmc_fastmod_new(size_t divisor)
+{
+    return divisor > 0 ? ~(cmc_fastmod)0 / divisor + 1 : 0;
+}
+
+static inline size_t cmc_fastmod_reduce(size_t value, cmc_fastmod multiplier, size_t divisor)
+{
+    /* The fractional part of value / divisor, multiplied by divisor */
+    cmc_fastmod fraction = multiplier * value;
+    cmc_fastmod low = ((fraction & UINT64_MAX) * divisor) >> 64;
+    cmc_fastmod high = (fraction >> 64) * divisor;
+
+    return (size_t)((low + high) >> 64);
+}
+#else
+typedef size_t cmc_fastmod;
+
+static inline cmc_fastmod cmc_fastmod_new(size_t divisor)
+{
+    (void)divisor;
+    return 0;
+}
+
+static inline size_t cmc_fastmod_reduce(size_t value, cmc_fastmod multiplier, size_t divisor)
+{
+    (void)multiplier;
+    return value % divisor;
+}
+#endif
+
+/* Smallest power of two that is greater or equal to required. Used by the */
+/* hashtables generated with the POW2 variants */
+static inline size_t cmc_hashtable_pow2_size(size_t required)
+{
+    size_t size = 64;
+
+    while (size < required && size <= SIZE_MAX / 2)
+        size <<= 1;
+
+    return size;
+}
+
+/* Power of two hashtables only look at the lower bits of a hash so they are */
+/* first passed through this finalizer (from MurmurHash3) to spread the */
+/* entropy of the upper bits */
+static inline size_t cmc_hashtable_mix(size_t hash)
+{
+    uint64_t h = (uint64_t)hash;
+
+    h ^= h >> 33;
+    h *= UINT64_C(0xff51afd7ed558ccd);
+    h ^= h >> 33;
+    h *= UINT64_C(0xc4ceb9fe1a85ec53);
+    h ^= h >> 33;
+
+    return (size_t)h;
+}
+
+/* Fraction of what a hashtable can hold under which a removal shrinks it. */
+/* Tables grow by a factor of 1 / load, so right after growing one is only */
+/* load full, and the mark is kept under half of that so that a table that */
+/* just grew is not shrunk by the next removals */
+static inline double cmc_hashtable_low_water(double load)
+{
+    return CMC_SHRINK_LOW_WATER < load / 2 ? CMC_SHRINK_LOW_WATER : load / 2;
+}
+
+/* Sizing policies selected by the SIZING parameter of the generators. PRIME */
+/* tables reduce a hash with a modulo and POW2 tables mix it and mask it */
+#define CMC_IMPL_HASHTABLE_PRIME_SIZE(required) cmc_hashtable_prime_size(required)
+#define CMC_IMPL_HASHTABLE_PRIME_HOME(hash, capacity) ((hash) % (capacity))
+#define CMC_IMPL_HASHTABLE_PRIME_WRAP(pos, capacity) ((pos) % (capacity))
+
+#define CMC_IMPL_HASHTABLE_POW2_SIZE(required) cmc_hashtable_pow2_size(required)
+#define CMC_IMPL_HASHTABLE_POW2_HOME(hash, capacity) (cmc_hashtable_mix(hash) & ((capacity)-1))
+#define CMC_IMPL_HASHTABLE_POW2_WRAP(pos, capacity) ((pos) & ((capacity)-1))
+
+/* The same for a table, where PRIME tables use the fastmod multiplier kept */
+/* next to their capacity */
+#define CMC_IMPL_HASHTABLE_PRIME_TABLE_HOME(hash, table) \
+    cmc_fastmod_reduce(hash, (table)->fastmod, (table)->capacity)
+#define CMC_IMPL_HASHTABLE_PRIME_TABLE_WRAP(pos, table) \
+    cmc_fastmod_reduce(pos, (table)->fastmod, (table)->capacity)
+
+#define CMC_IMPL_HASHTABLE_POW2_TABLE_HOME(hash, table) \
+    CMC_IMPL_HASHTABLE_POW2_HOME(hash, (table)->capacity)
+#define CMC_IMPL_HASHTABLE_POW2_TABLE_WRAP(pos, table) \
+    CMC_IMPL_HASHTABLE_POW2_WRAP(pos, (table)->capacity)
+
+/* Hashing policies selected by the HASHING parameter of the generators. */
+/* CACHED tables store the full hash of every key in its entry so that it */
+/* is compared before the keys themselves and reused when resizing */
+#define CMC_IMPL_HASHTABLE_CACHED(...) __VA_ARGS__
+#define CMC_IMPL_HASHTABLE_CACHED_EQUALS(cached, hash) ((cached) == (hash))
+#define CMC_IMPL_HASHTABLE_CACHED_REHASH(cached, computed) (cached)
+
+#define CMC_IMPL_HASHTABLE_UNCACHED(...)
+#define CMC_IMPL_HASHTABLE_UNCACHED_EQUALS(cached, hash) true
+#define CMC_IMPL_HASHTABLE_UNCACHED_REHASH(cached, computed) (computed)
+
+/* Batched lookups hash and prefetch the home slots of this many keys before */
+/* resolving any of their probes */
+#define CMC_IMPL_HASHTABLE_BATCH 16
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CMC_IMPL_HASHTABLE_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define CMC_IMPL_HASHTABLE_PREFETCH(address)
+#endif
+
 #endif /* CMC_IMPL_HASHTABLE_SETUP */
 
+#ifndef CMC_IMPL_HASHTABLE_STATS
+#define CMC_IMPL_HASHTABLE_STATS
+
+/* Amount of buckets of the histogram of distances of cmc_hashtable_stats. */
+/* The last bucket also counts every entry that is further away */
+#ifndef CMC_HASHTABLE_STATS_BUCKETS
+#define CMC_HASHTABLE_STATS_BUCKETS 16
+#endif
+
+/* Health of a hashtable, as reported by the stats function of every */
+/* hashtable collection */
+struct cmc_hashtable_stats
+{
+    /* Amount of slots (or buckets) of the table */
+    size_t capacity;
+
+    /* Amount of entries in the table */
+    size_t count;
+
+    /* Slots that are marked as deleted and still take part in probes */
+    size_t tombstones;
+
+    /* Current load, count / capacity */
+    double load;
+
+    /* Greatest distance of an entry to its original position */
+    size_t max_dist;
+
+    /* Average distance of an entry to its original position */
+    double mean_dist;
+
+    /* Amount of entries at each distance to their original position */
+    size_t histogram[CMC_HASHTABLE_STATS_BUCKETS];
+
+    /* Bytes allocated by the collection, not counting what K and V own */
+    size_t bytes;
+
+    /* Lookups done since the table was created */
+    size_t lookups;
+
+    /* Entries compared by these lookups */
+    size_t probes;
+};
+
+/* Adds the distance of an entry to stats. Until cmc_hashtable_stats_end() */
+/* is called mean_dist holds the sum of all distances */
+static inline void cmc_hashtable_stats_add(struct cmc_hashtable_stats *stats, size_t dist)
+{
+    if (dist < CMC_HASHTABLE_STATS_BUCKETS)
+        stats->histogram[dist]++;
+    else
+        stats->histogram[CMC_HASHTABLE_STATS_BUCKETS - 1]++;
+
+    if (dist > stats->max_dist)
+        stats->max_dist = dist;
+
+    stats->mean_dist += (double)dist;
+}
+
+/* Adds the finished stats of another table to stats, for collections made */
+/* of more than one hashtable */
+static inline void cmc_hashtable_stats_merge(struct cmc_hashtable_stats *stats,
+                                             struct cmc_hashtable_stats *other)
+{
+    size_t entries = 0;
+
+    for (size_t i = 0; i < CMC_HASHTABLE_STATS_BUCKETS; i++)
+    {
+        stats->histogram[i] += other->histogram[i];
+        entries += other->histogram[i];
+    }
+
+    if (other->max_dist > stats->max_dist)
+        stats->max_dist = other->max_dist;
+
+    stats->mean_dist += other->mean_dist * (double)entries;
+    stats->capacity += other->capacity;
+    stats->count += other->count;
+    stats->tombstones += other->tombstones;
+    stats->bytes += other->bytes;
+    stats->lookups += other->lookups;
+    stats->probes += other->probes;
+}
+
+/* Turns the sum of distances of stats into their mean and computes the load */
+static inline void cmc_hashtable_stats_end(struct cmc_hashtable_stats *stats)
+{
+    size_t entries = 0;
+
+    for (size_t i = 0; i < CMC_HASHTABLE_STATS_BUCKETS; i++)
+        entries += stats->histogram[i];
+
+    if (entries > 0)
+        stats->mean_dist /= (double)entries;
+
+    if (stats->capacity > 0)
+        stats->load = (double)stats->count / (double)stats->capacity;
+}
+
+/* Defining CMC_HASHTABLE_PROBE_STATS before including any hashtable makes */
+/* every table count its lookups and the entries they compare, reported as */
+/* lookups and probes by cmc_hashtable_stats. The counters are not atomic */
+/* so lookups that run concurrently without a lock are counted loosely */
+#ifdef CMC_HASHTABLE_PROBE_STATS
+#define CMC_IMPL_HASHTABLE_PROBE_FIELDS size_t lookups; size_t probes;
+#define CMC_IMPL_HASHTABLE_PROBE_RESET(table) ((table)->lookups = 0, (table)->probes = 0)
+#define CMC_IMPL_HASHTABLE_PROBE_LOOKUP(table) ((table)->lookups++)
+#define CMC_IMPL_HASHTABLE_PROBE_SLOT(table) ((table)->probes++)
+#define CMC_IMPL_HASHTABLE_PROBE_ADD(to, from) \
+    ((to)->lookups += (from)->lookups, (to)->probes += (from)->probes)
+#else
+#define CMC_IMPL_HASHTABLE_PROBE_FIELDS
+#define CMC_IMPL_HASHTABLE_PROBE_RESET(table) ((void)0)
+#define CMC_IMPL_HASHTABLE_PROBE_LOOKUP(table) ((void)0)
+#define CMC_IMPL_HASHTABLE_PROBE_SLOT(table) ((void)0)
+#define CMC_IMPL_HASHTABLE_PROBE_ADD(to, from) ((void)0)
+#endif
+
+#endif /* CMC_IMPL_HASHTABLE_STATS */
+
+#ifndef CMC_IMPL_HASHTABLE_OCCUPANCY
+#define CMC_IMPL_HASHTABLE_OCCUPANCY
+
+/* Defining CMC_HASHTABLE_OCCUPANCY before including any hashtable makes */
+/* every table keep a bitmap with one bit for each slot, set while the slot */
+/* is filled. Iterators, copy_of and the functions that go through every */
+/* entry then skip up to 64 empty slots at a time instead of reading their */
+/* states, which pays off for sparse tables. A table whose bitmap could not */
+/* be allocated works as if it was not defined */
+#ifdef CMC_HASHTABLE_OCCUPANCY
+#define CMC_IMPL_HASHTABLE_OCCUPANCY_FIELDS uint64_t *occupied;
+#define CMC_IMPL_HASHTABLE_OCCUPIED(table) ((table)->occupied)
+#define CMC_IMPL_HASHTABLE_OCCUPANCY_NEW(table) \
+    ((table)->occupied = cmc_occupancy_new((table)->alloc, (table)->capacity))
+#define CMC_IMPL_HASHTABLE_OCCUPANCY_FREE(table) (table)->alloc->free((table)->occupied)
+#define CMC_IMPL_HASHTABLE_OCCUPANCY_NONE(table) ((table)->occupied = NULL)
+#define CMC_IMPL_HASHTABLE_OCCUPANCY_SWAP(a, b) cmc_occupancy_swap(&(a)->occupied, &(b)->occupied)
+#define CMC_IMPL_HASHTABLE_OCCUPY(table, slot) \
+    ((table)->occupied ? cmc_occupancy_set((table)->occupied, slot) : (void)0)
+#define CMC_IMPL_HASHTABLE_VACATE(table, slot) \
+    ((table)->occupied ? cmc_occupancy_unset((table)->occupied, slot) : (void)0)
+#define CMC_IMPL_HASHTABLE_OCCUPANCY_BYTES(table) \
+    ((table)->occupied ? sizeof(uint64_t) * cmc_occupancy_words((table)->capacity) : 0)
+#else
+#define CMC_IMPL_HASHTABLE_OCCUPANCY_FIELDS
+#define CMC_IMPL_HASHTABLE_OCCUPIED(table) ((uint64_t *)NULL)
+#define CMC_IMPL_HASHTABLE_OCCUPANCY_NEW(table) ((void)0)
+#define CMC_IMPL_HASHTABLE_OCCUPANCY_FREE(table) ((void)0)
+#define CMC_IMPL_HASHTABLE_OCCUPANCY_NONE(table) ((void)0)
+#define CMC_IMPL_HASHTABLE_OCCUPANCY_SWAP(a, b) ((void)0)
+#define CMC_IMPL_HASHTABLE_OCCUPY(table, slot) ((void)0)
+#define CMC_IMPL_HASHTABLE_VACATE(table, slot) ((void)0)
+#define CMC_IMPL_HASHTABLE_OCCUPANCY_BYTES(table) ((size_t)0)
+#endif
+
+static inline size_t cmc_occupancy_words(size_t capacity)
+{
+    return capacity / 64 + (capacity % 64 != 0);
+}
+
+/* Returns NULL if the bitmap could not be allocated */
+static inline uint64_t *cmc_occupancy_new(struct cmc_alloc_node *alloc, size_t capacity)
+{
+    return alloc->calloc(cmc_occupancy_words(capacity), sizeof(uint64_t));
+}
+
+static inline void cmc_occupancy_set(uint64_t *bits, size_t slot)
+{
+    bits[slot / 64] |= UINT64_C(1) << (slot % 64);
+}
+
+static inline void cmc_occupancy_unset(uint64_t *bits, size_t slot)
+{
+    bits[slot / 64] &= ~(UINT64_C(1) << (slot % 64));
+}
+
+static inline void cmc_occupancy_swap(uint64_t **a, uint64_t **b)
+{
+    uint64_t *tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+/* First slot at or after from that is set, or capacity if there is none */
+static inline size_t cmc_occupancy_next(uint64_t *bits, size_t capacity, size_t from)
+{
+    if (from >= capacity)
+        return capacity;
+
+    size_t words = cmc_occupancy_words(capacity);
+    size_t w = from / 64;
+    uint64_t word = bits[w] & (~UINT64_C(0) << (from % 64));
+
+    while (word == 0)
+    {
+        if (++w == words)
+            return capacity;
+
+        word = bits[w];
+    }
+
+    return w * 64 + cmc_math_ctz(word);
+}
+
+/* Last slot at or before from that is set, or SIZE_MAX if there is none */
+static inline size_t cmc_occupancy_prev(uint64_t *bits, size_t from)
+{
+    size_t w = from / 64;
+    uint64_t word = bits[w] & (~UINT64_C(0) >> (63 - from % 64));
+
+    while (word == 0)
+    {
+        if (w-- == 0)
+            return SIZE_MAX;
+
+        word = bits[w];
+    }
+
+    return w * 64 + 63 - cmc_math_clz(word);
+}
+
+#endif /* CMC_IMPL_HASHTABLE_OCCUPANCY */
+
+#ifndef CMC_IMPL_HASHTABLE_STORAGE
+#define CMC_IMPL_HASHTABLE_STORAGE
+
+/* Amount of entries kept inside the struct of SMALL tables */
+#ifndef CMC_HASHTABLE_SMALL_SIZE
+#define CMC_HASHTABLE_SMALL_SIZE 8
+#endif
+
+/* Storage policies selected by the STORAGE parameter of the generators. */
+/* SMALL tables have room for CMC_HASHTABLE_SMALL_SIZE entries inside their */
+/* own struct. One that is created for at most that many keys keeps them */
+/* there, so creating it takes a single allocation, and looks them up by */
+/* comparing the keys one after the other without hashing them. It moves to */
+/* an allocated buffer when it grows past them and back once shrinking */
+/* leaves few enough keys. ALLOCATED tables always use an allocated buffer */
+#define CMC_IMPL_HASHTABLE_ALLOCATED_FIELDS(entry)
+#define CMC_IMPL_HASHTABLE_ALLOCATED_SIZE ((size_t)0)
+#define CMC_IMPL_HASHTABLE_ALLOCATED_BUFFER(table) NULL
+#define CMC_IMPL_HASHTABLE_ALLOCATED_IN_STRUCT(table) false
+
+#define CMC_IMPL_HASHTABLE_SMALL_FIELDS(entry) entry small_buffer[CMC_HASHTABLE_SMALL_SIZE];
+#define CMC_IMPL_HASHTABLE_SMALL_SIZE ((size_t)CMC_HASHTABLE_SMALL_SIZE)
+#define CMC_IMPL_HASHTABLE_SMALL_BUFFER(table) ((table)->small_buffer)
+#define CMC_IMPL_HASHTABLE_SMALL_IN_STRUCT(table) ((table)->buffer == (table)->small_buffer)
+
+#endif /* CMC_IMPL_HASHTABLE_STORAGE */
+
+#ifndef CMC_IMPL_HASHTABLE_FINGERPRINT
+#define CMC_IMPL_HASHTABLE_FINGERPRINT
+
+/* Defining CMC_HASHTABLE_FINGERPRINT before including any hashtable makes */
+/* every table keep the sum of the mixed hashes of its keys, updated as they */
+/* are inserted and removed. The sum does not depend on the order of the */
+/* keys, so equals returns false without looking any of them up when two */
+/* tables with the same count have different sums. SMALL tables, which */
+/* otherwise never hash their keys, then hash every key they insert */
+#ifdef CMC_HASHTABLE_FINGERPRINT
+#define CMC_IMPL_HASHTABLE_FINGERPRINT_FIELDS size_t fingerprint;
+#define CMC_IMPL_HASHTABLE_FINGERPRINTED(...) __VA_ARGS__
+#define CMC_IMPL_HASHTABLE_FINGERPRINT_DIFFERS(a, b) ((a)->fingerprint != (b)->fingerprint)
+#else
+#define CMC_IMPL_HASHTABLE_FINGERPRINT_FIELDS
+#define CMC_IMPL_HASHTABLE_FINGERPRINTED(...)
+#define CMC_IMPL_HASHTABLE_FINGERPRINT_DIFFERS(a, b) false
+#endif
+
+#endif /* CMC_IMPL_HASHTABLE_FINGERPRINT */
+
+/* Growth policies selected by the GROWTH parameter of the generators. */
+/* INCREMENTAL hashmaps keep their previous buffer when they grow and every */
+/* following insert or lookup moves up to CMC_HASHMAP_MIGRATE_STEP of its */
+/* slots to the new buffer, instead of rehashing everything at once. FIXED */
+/* hashmaps never replace their buffer: inserting into a full one fails and */
+/* removals do not shrink it. They are used by collections that own the */
+/* memory of the buffer, like the MappedHashMap */
+#ifndef CMC_HASHMAP_MIGRATE_STEP
+#define CMC_HASHMAP_MIGRATE_STEP 16
+#endif
+
+#define CMC_IMPL_HASHMAP_INSTANT_GROWTH false
+#define CMC_IMPL_HASHMAP_INCREMENTAL_GROWTH true
+#define CMC_IMPL_HASHMAP_FIXED_GROWTH false
+
+#define CMC_IMPL_HASHMAP_INSTANT_REHASH true
+#define CMC_IMPL_HASHMAP_INCREMENTAL_REHASH true
+#define CMC_IMPL_HASHMAP_FIXED_REHASH false
+
+/* Layouts selected by the LAYOUT parameter of the generators. AOS hashmaps */
+/* keep each value in the entry of its key. SOA hashmaps keep the values in */
+/* a separate array, the value of the entry at a slot being at the same */
+/* index, so that lookups only bring the keys and the states of the entries */
+/* they probe to the cache and going through the values alone reads them */
+/* one after the other. Paired with CMC_HASHTABLE_OCCUPANCY the entries are */
+/* not read at all when only the values are visited */
+#define CMC_IMPL_HASHMAP_AOS(...)
+#define CMC_IMPL_HASHMAP_SOA(...) __VA_ARGS__
+
+#define CMC_IMPL_HASHMAP_AOS_ENTRY_FIELDS(V) V value;
+#define CMC_IMPL_HASHMAP_SOA_ENTRY_FIELDS(V)
+
+#define CMC_IMPL_HASHMAP_AOS_TABLE_FIELDS(V)
+#define CMC_IMPL_HASHMAP_SOA_TABLE_FIELDS(V) V *values;
+
+#define CMC_IMPL_HASHMAP_AOS_VALUE(table, entry) ((entry)->value)
+#define CMC_IMPL_HASHMAP_SOA_VALUE(table, entry) ((table)->values[(entry) - (table)->buffer])
+
+#define CMC_IMPL_HASHMAP_AOS_VALUE_SIZE(V) ((size_t)0)
+#define CMC_IMPL_HASHMAP_SOA_VALUE_SIZE(V) sizeof(V)
+
+#define CMC_IMPL_HASHMAP_AOS_PARALLEL CMC_IMPL_PARALLEL_ENTRY
+#define CMC_IMPL_HASHMAP_SOA_PARALLEL CMC_IMPL_PARALLEL_SPLIT_ENTRY
+
 #define CMC_GENERATE_HASHMAP(PFX, SNAME, K, V)    \
     CMC_GENERATE_HASHMAP_HEADER(PFX, SNAME, K, V) \
     CMC_GENERATE_HASHMAP_SOURCE(PFX, SNAME, K, V)
 
+/* Same as CMC_GENERATE_HASHMAP but tables are sized to powers of two */
+#define CMC_GENERATE_HASHMAP_POW2(PFX, SNAME, K, V) \
+    CMC_GENERATE_HASHMAP_HEADER(PFX, SNAME, K, V)   \
+    CMC_GENERATE_HASHMAP_POW2_SOURCE(PFX, SNAME, K, V)
+
+/* Same as CMC_GENERATE_HASHMAP but entries also store the hash of their key */
+#define CMC_GENERATE_HASHMAP_CACHED(PFX, SNAME, K, V)    \
+    CMC_GENERATE_HASHMAP_CACHED_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_HASHMAP_CACHED_SOURCE(PFX, SNAME, K, V)
+
+/* Same as CMC_GENERATE_HASHMAP but growing is spread across operations */
+#define CMC_GENERATE_HASHMAP_INCREMENTAL(PFX, SNAME, K, V) \
+    CMC_GENERATE_HASHMAP_HEADER(PFX, SNAME, K, V)          \
+    CMC_GENERATE_HASHMAP_INCREMENTAL_SOURCE(PFX, SNAME, K, V)
+
+/* Same as CMC_GENERATE_HASHMAP but keys are compared and hashed by calling */
+/* CMP and HASH directly, so the compiler can inline them. The functions */
+/* given to new are still stored but only used by copy_of and to_string */
+#define CMC_GENERATE_HASHMAP_EX(PFX, SNAME, K, V, CMP, HASH) \
+    CMC_GENERATE_HASHMAP_HEADER(PFX, SNAME, K, V)            \
+    CMC_GENERATE_HASHMAP_EX_SOURCE(PFX, SNAME, K, V, CMP, HASH)
+
+/* Same as CMC_GENERATE_HASHMAP but a table of a few keys keeps them inside */
+/* its struct and finds them without hashing, see CMC_HASHTABLE_SMALL_SIZE */
+#define CMC_GENERATE_HASHMAP_SMALL(PFX, SNAME, K, V)    \
+    CMC_GENERATE_HASHMAP_SMALL_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_HASHMAP_SMALL_SOURCE(PFX, SNAME, K, V)
+
+/* Same as CMC_GENERATE_HASHMAP but the values are kept apart from the keys */
+#define CMC_GENERATE_HASHMAP_SOA(PFX, SNAME, K, V)    \
+    CMC_GENERATE_HASHMAP_SOA_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_HASHMAP_SOA_SOURCE(PFX, SNAME, K, V)
+
 #define CMC_WRAPGEN_HASHMAP_HEADER(PFX, SNAME, K, V) \
     CMC_GENERATE_HASHMAP_HEADER(PFX, SNAME, K, V)
 
 #define CMC_WRAPGEN_HASHMAP_SOURCE(PFX, SNAME, K, V) \
     CMC_GENERATE_HASHMAP_SOURCE(PFX, SNAME, K, V)
 
+#define CMC_WRAPGEN_HASHMAP_POW2_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_HASHMAP_HEADER(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_HASHMAP_POW2_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_HASHMAP_POW2_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_HASHMAP_CACHED_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_HASHMAP_CACHED_HEADER(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_HASHMAP_CACHED_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_HASHMAP_CACHED_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_HASHMAP_INCREMENTAL_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_HASHMAP_HEADER(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_HASHMAP_INCREMENTAL_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_HASHMAP_INCREMENTAL_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_HASHMAP_SMALL_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_HASHMAP_SMALL_HEADER(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_HASHMAP_SMALL_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_HASHMAP_SMALL_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_HASHMAP_SOA_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_HASHMAP_SOA_HEADER(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_HASHMAP_SOA_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_HASHMAP_SOA_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_GENERATE_HASHMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_IMPL_HASHMAP_HEADER(PFX, SNAME, K, V, UNCACHED, ALLOCATED, AOS)
+
+#define CMC_GENERATE_HASHMAP_CACHED_HEADER(PFX, SNAME, K, V) \
+    CMC_IMPL_HASHMAP_HEADER(PFX, SNAME, K, V, CACHED, ALLOCATED, AOS)
+
+#define CMC_GENERATE_HASHMAP_SMALL_HEADER(PFX, SNAME, K, V) \
+    CMC_IMPL_HASHMAP_HEADER(PFX, SNAME, K, V, UNCACHED, SMALL, AOS)
+
+#define CMC_GENERATE_HASHMAP_SOA_HEADER(PFX, SNAME, K, V) \
+    CMC_IMPL_HASHMAP_HEADER(PFX, SNAME, K, V, UNCACHED, ALLOCATED, SOA)
+
+#define CMC_GENERATE_HASHMAP_SOURCE(PFX, SNAME, K, V)                   \
+    CMC_IMPL_HASHMAP_SOURCE(PFX, SNAME, K, V, PRIME, UNCACHED, INSTANT, \
+                            ALLOCATED, AOS, _map_->cmp, _map_->hash)
+
+#define CMC_GENERATE_HASHMAP_POW2_SOURCE(PFX, SNAME, K, V)             \
+    CMC_IMPL_HASHMAP_SOURCE(PFX, SNAME, K, V, POW2, UNCACHED, INSTANT, \
+                            ALLOCATED, AOS, _map_->cmp, _map_->hash)
+
+#define CMC_GENERATE_HASHMAP_CACHED_SOURCE(PFX, SNAME, K, V)          \
+    CMC_IMPL_HASHMAP_SOURCE(PFX, SNAME, K, V, PRIME, CACHED, INSTANT, \
+                            ALLOCATED, AOS, _map_->cmp, _map_->hash)
+
+#define CMC_GENERATE_HASHMAP_INCREMENTAL_SOURCE(PFX, SNAME, K, V)           \
+    CMC_IMPL_HASHMAP_SOURCE(PFX, SNAME, K, V, PRIME, UNCACHED, INCREMENTAL, \
+                            ALLOCATED, AOS, _map_->cmp, _map_->hash)
+
+#define CMC_GENERATE_HASHMAP_EX_SOURCE(PFX, SNAME, K, V, CMP, HASH)                \
+    CMC_IMPL_HASHMAP_SOURCE(PFX, SNAME, K, V, PRIME, UNCACHED, INSTANT, ALLOCATED, \
+                            AOS, CMP, HASH)
+
+#define CMC_GENERATE_HASHMAP_SMALL_SOURCE(PFX, SNAME, K, V)             \
+    CMC_IMPL_HASHMAP_SOURCE(PFX, SNAME, K, V, PRIME, UNCACHED, INSTANT, \
+                            SMALL, AOS, _map_->cmp, _map_->hash)
+
+#define CMC_GENERATE_HASHMAP_SOA_SOURCE(PFX, SNAME, K, V)               \
+    CMC_IMPL_HASHMAP_SOURCE(PFX, SNAME, K, V, PRIME, UNCACHED, INSTANT, \
+                            ALLOCATED, SOA, _map_->cmp, _map_->hash)
+
 /* HEADER ********************************************************************/
-#define CMC_GENERATE_HASHMAP_HEADER(PFX, SNAME, K, V)                           \
+#define CMC_IMPL_HASHMAP_HEADER(PFX, SNAME, K, V, HASHING, STORAGE, LAYOUT)     \
+                                                                                \
+    /* Hashmap Entry */                                                         \
+    struct SNAME##_entry                                                        \
+    {                                                                           \
+        /* Entry Key */                                                         \
+        K key;                                                                  \
+                                                                                \
+        /* Entry Value, kept in the values of the hashmap by SOA tables */      \
+        CMC_IMPL_HASHMAP_##LAYOUT##_ENTRY_FIELDS(V)                             \
+                                                                                \
+        /* The hash of the key, only stored by CACHED tables */                 \
+        CMC_IMPL_HASHTABLE_##HASHING(size_t hash;)                              \
+                                                                                \
+        /* The distance of this node to its original position, used by */       \
+        /* robin-hood hashing */                                                \
+        unsigned int dist : CMC_ES_DIST_BITS;                                   \
+                                                                                \
+        /* The sate of this node (DELETED, EMPTY, FILLED) */                    \
+        signed int state : 2;                                                   \
+    };                                                                          \
                                                                                 \
     /* Hashmap Structure */                                                     \
     struct SNAME                                                                \
@@ -97,8 +702,13 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         /* Array of Entries */                                                  \
         struct SNAME##_entry *buffer;                                           \
                                                                                 \
+        /* Array of Values, one for each entry, only present in SOA tables */   \
+        CMC_IMPL_HASHMAP_##LAYOUT##_TABLE_FIELDS(V)                             \
+                                                                                \
         /* Current array capacity */                                            \
         size_t capacity;                                                        \
+        /* Multiplier of the capacity that reduces a hash to a slot */          \
+        cmc_fastmod fastmod;                                                    \
                                                                                 \
         /* Current amount of keys */                                            \
         size_t count;                                                           \
@@ -112,28 +722,35 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         /* Key hash function */                                                 \
         size_t (*hash)(K);                                                      \
                                                                                 \
+        /* Previous buffer of an INCREMENTAL hashmap that still has entries */  \
+        /* to be moved to the current one, otherwise NULL */                    \
+        struct SNAME *old;                                                      \
+                                                                                \
+        /* Index of the next slot of the previous buffer to be moved */         \
+        size_t migrated;                                                        \
+                                                                                \
+        /* Lookup counters, only present with CMC_HASHTABLE_PROBE_STATS */      \
+        CMC_IMPL_HASHTABLE_PROBE_FIELDS                                         \
+                                                                                \
+        /* Bitmap of the filled slots, only present with */                     \
+        /* CMC_HASHTABLE_OCCUPANCY. NULL if it could not be allocated */        \
+        CMC_IMPL_HASHTABLE_OCCUPANCY_FIELDS                                     \
+                                                                                \
+        /* Sum of the mixed hashes of the keys, only present with */            \
+        /* CMC_HASHTABLE_FINGERPRINT */                                         \
+        CMC_IMPL_HASHTABLE_FINGERPRINT_FIELDS                                   \
+                                                                                \
+        /* Entries kept inside the struct, only present in SMALL tables */      \
+        CMC_IMPL_HASHTABLE_##STORAGE##_FIELDS(struct SNAME##_entry)             \
+                                                                                \
         /* Function that returns an iterator to the start of the hashmap */     \
         struct SNAME##_iter (*it_start)(struct SNAME *);                        \
                                                                                 \
         /* Function that returns an iterator to the end of the hashmap */       \
         struct SNAME##_iter (*it_end)(struct SNAME *);                          \
-    };                                                                          \
-                                                                                \
-    /* Hashmap Entry */                                                         \
-    struct SNAME##_entry                                                        \
-    {                                                                           \
-        /* Entry Key */                                                         \
-        K key;                                                                  \
-                                                                                \
-        /* Entry Value */                                                       \
-        V value;                                                                \
-                                                                                \
-        /* The distance of this node to its original position, used by */       \
-        /* robin-hood hashing */                                                \
-        size_t dist;                                                            \
                                                                                 \
-        /* The sate of this node (DELETED, EMPTY, FILLED) */                    \
-        enum cmc_entry_state state;                                             \
+        /* Custom allocation functions */                                       \
+        struct cmc_alloc_node *alloc;                                           \
     };                                                                          \
                                                                                 \
     /* Hashmap Iterator */                                                      \
@@ -161,35 +778,114 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         bool end;                                                               \
     };                                                                          \
                                                                                 \
+    /* State of a hashmap being streamed by serialize */                        \
+    struct SNAME##_serializer                                                   \
+    {                                                                           \
+        struct cmc_serial_writer writer;                                        \
+                                                                                \
+        /* Goes through the hashmap, which must not change meanwhile */         \
+        struct SNAME##_iter iter;                                               \
+    };                                                                          \
+                                                                                \
+    /* State of a hashmap being received by deserialize */                      \
+    struct SNAME##_deserializer                                                 \
+    {                                                                           \
+        struct cmc_serial_reader reader;                                        \
+                                                                                \
+        /* Given to the hashmap once the header arrives */                      \
+        int (*compare)(K, K);                                                   \
+        size_t (*hash)(K);                                                      \
+                                                                                \
+        /* NULL until the header arrives */                                     \
+        struct SNAME *result;                                                   \
+    };                                                                          \
+                                                                                \
     /* Collection Functions */                                                  \
     /* Collection Allocation and Deallocation */                                \
     struct SNAME *PFX##_new(size_t capacity, double load, int (*compare)(K, K), \
                             size_t (*hash)(K));                                 \
+    struct SNAME *PFX##_new_custom(size_t capacity, double load,                \
+                                   int (*compare)(K, K), size_t (*hash)(K),     \
+                                   struct cmc_alloc_node *alloc);               \
+    struct SNAME *PFX##_new_from(K *keys, V *values, size_t size, double load,  \
+                                 int (*compare)(K, K), size_t (*hash)(K));      \
     void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V));           \
     void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V));            \
     /* Collection Input and Output */                                           \
     bool PFX##_insert(struct SNAME *_map_, K key, V value);                     \
+    size_t PFX##_insert_many(struct SNAME *_map_, K *keys, V *values,           \
+                             size_t n);                                         \
+    V *PFX##_get_or_insert(struct SNAME *_map_, K key, V default_value);        \
+    bool PFX##_upsert(struct SNAME *_map_, K key, V value);                     \
+    bool PFX##_merge(struct SNAME *_map1_, struct SNAME *_map2_,                \
+                     V (*combine)(V, V));                                       \
+    bool PFX##_merge_free(struct SNAME *_map1_, struct SNAME *_map2_,           \
+                          V (*combine)(V, V), void (*deallocator)(K, V));       \
     bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value);   \
     bool PFX##_remove(struct SNAME *_map_, K key, V *out_value);                \
+    size_t PFX##_remove_if(struct SNAME *_map_, bool (*pred)(K, V),             \
+                           void (*deallocator)(K, V));                          \
     /* Element Access */                                                        \
     bool PFX##_max(struct SNAME *_map_, K *key, V *value);                      \
     bool PFX##_min(struct SNAME *_map_, K *key, V *value);                      \
     V PFX##_get(struct SNAME *_map_, K key);                                    \
     V *PFX##_get_ref(struct SNAME *_map_, K key);                               \
+    size_t PFX##_get_many(struct SNAME *_map_, K *CMC_RESTRICT keys, size_t n,  \
+                          V *CMC_RESTRICT out, bool *CMC_RESTRICT found);       \
     /* Collection State */                                                      \
     bool PFX##_contains(struct SNAME *_map_, K key);                            \
-    bool PFX##_empty(struct SNAME *_map_);                                      \
+    size_t PFX##_contains_many(struct SNAME *_map_, K *keys, size_t n,          \
+                               bool *found);                                    \
+    CMC_PURE bool PFX##_empty(struct SNAME *_map_);                             \
     bool PFX##_full(struct SNAME *_map_);                                       \
-    size_t PFX##_count(struct SNAME *_map_);                                    \
+    CMC_PURE size_t PFX##_count(struct SNAME *_map_);                           \
+    size_t PFX##_memory_usage(struct SNAME *_map_);                             \
     size_t PFX##_capacity(struct SNAME *_map_);                                 \
     double PFX##_load(struct SNAME *_map_);                                     \
+    void PFX##_stats(struct SNAME *_map_, struct cmc_hashtable_stats *out);     \
     /* Collection Utility */                                                    \
     bool PFX##_resize(struct SNAME *_map_, size_t capacity);                    \
+    bool PFX##_shrink_to_fit(struct SNAME *_map_);                              \
     struct SNAME *PFX##_copy_of(struct SNAME *_map_, K (*key_copy_func)(K),     \
                                 V (*value_copy_func)(V));                       \
+    size_t PFX##_to_array(struct SNAME *_map_, K *CMC_RESTRICT keys,            \
+                          V *CMC_RESTRICT values, size_t size);                 \
+    size_t PFX##_parallel_slots(struct SNAME *_map_);                           \
+    V PFX##_parallel_reduce(struct SNAME *_map_, V initial,                     \
+                            V (*reduce)(V, K, V), V (*combine)(V, V),           \
+                            size_t threads);                                    \
     bool PFX##_equals(struct SNAME *_map1_, struct SNAME *_map2_,               \
                       int (*value_comparator)(V, V));                           \
+    size_t PFX##_fingerprint(struct SNAME *_map_);                              \
     struct cmc_string PFX##_to_string(struct SNAME *_map_);                     \
+    bool PFX##_to_string_full(struct SNAME *_map_,                              \
+                              struct cmc_string_builder *builder,               \
+                              const char *elem_fmt);                            \
+    bool PFX##_write(struct SNAME *_map_, FILE *file,                           \
+                     void (*fmt)(FILE *, K, V));                                \
+    bool PFX##_write_fd(struct SNAME *_map_, int fd,                            \
+                        void (*fmt)(struct cmc_dump *, K, V));                  \
+    /* Collection Serialization */                                              \
+    bool PFX##_save(struct SNAME *_map_, FILE *file,                            \
+                    bool (*key_writer)(K, FILE *),                              \
+                    bool (*value_writer)(V, FILE *));                           \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(K, K),               \
+                                size_t (*hash)(K),                              \
+                                bool (*key_reader)(K *, FILE *),                \
+                                bool (*value_reader)(V *, FILE *));             \
+    bool PFX##_serialize_begin(struct SNAME##_serializer *serializer,           \
+                               struct SNAME *_map_, size_t block_size,          \
+                               bool checksum);                                  \
+    size_t PFX##_serialize_next(struct SNAME##_serializer *serializer,          \
+                                void *buffer, size_t size);                     \
+    void PFX##_serialize_end(struct SNAME##_serializer *serializer);            \
+    bool PFX##_deserialize_begin(struct SNAME##_deserializer *deserializer,     \
+                                 int (*compare)(K, K), size_t (*hash)(K),       \
+                                 size_t block_size);                            \
+    bool PFX##_deserialize_next(struct SNAME##_deserializer *deserializer,      \
+                                const void *buffer, size_t size);               \
+    struct SNAME *PFX##_deserialize_end(                                        \
+        struct SNAME##_deserializer *deserializer);                             \
                                                                                 \
     /* Iterator Functions */                                                    \
     /* Iterator Allocation and Deallocation */                                  \
@@ -208,6 +904,8 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
     bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps);           \
     bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps);            \
     bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index);             \
+    bool PFX##_parallel_iter(struct SNAME##_iter *iter, struct SNAME *target,   \
+                             size_t slot);                                      \
     /* Iterator Access */                                                       \
     K PFX##_iter_key(struct SNAME##_iter *iter);                                \
     V PFX##_iter_value(struct SNAME##_iter *iter);                              \
@@ -215,17 +913,64 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
     size_t PFX##_iter_index(struct SNAME##_iter *iter);                         \
                                                                                 \
 /* SOURCE ********************************************************************/
-#define CMC_GENERATE_HASHMAP_SOURCE(PFX, SNAME, K, V)                                              \
+#define CMC_IMPL_HASHMAP_SOURCE(PFX, SNAME, K, V, SIZING, HASHING, GROWTH, STORAGE, LAYOUT,        \
+                                CMP, HASH)                                                         \
                                                                                                    \
     /* Implementation Detail Functions */                                                          \
+    static inline int PFX##_impl_cmp(struct SNAME *_map_, K a, K b);                               \
+    static inline size_t PFX##_impl_hash(struct SNAME *_map_, K key);                              \
     static struct SNAME##_entry *PFX##_impl_get_entry(struct SNAME *_map_, K key);                 \
+    static struct SNAME##_entry *PFX##_impl_get_entry_by_hash(struct SNAME *_map_, K key,          \
+                                                              size_t hash);                        \
+    static struct SNAME##_entry *PFX##_impl_insert_entry(struct SNAME *_map_, K key, V value,      \
+                                                         size_t hash,                              \
+                                                         struct SNAME##_entry **found);            \
+    static void PFX##_impl_get_batch(struct SNAME *_map_, K *keys, size_t n,                       \
+                                     struct SNAME##_entry **entries);                              \
+    static struct SNAME##_entry *PFX##_impl_small_get(struct SNAME *_map_, K key);                 \
+    static struct SNAME##_entry *PFX##_impl_small_insert(struct SNAME *_map_, K key, V value,      \
+                                                         struct SNAME##_entry **found);            \
+    static void PFX##_impl_small_remove(struct SNAME *_map_, struct SNAME##_entry *entry);         \
+    static void PFX##_impl_to_small(struct SNAME *_map_);                                          \
+    static void PFX##_impl_free_buffer(struct SNAME *_map_);                                       \
+    static bool PFX##_impl_values_new(struct SNAME *_map_);                                        \
+    static inline V *PFX##_impl_value(struct SNAME *_map_, struct SNAME##_entry *entry);           \
+    static bool PFX##_impl_dist_overflow(struct SNAME *_map_, size_t hash);                        \
+    static bool PFX##_impl_grow(struct SNAME *_map_, size_t capacity);                             \
+    static void PFX##_impl_migrate(struct SNAME *_map_, size_t steps);                             \
+    static size_t PFX##_impl_fingerprint(struct SNAME *_map_);                                     \
+    static void PFX##_impl_remove_entry(struct SNAME *_map_, struct SNAME##_entry *entry);         \
+    static bool PFX##_impl_rehash(struct SNAME *_map_, size_t capacity);                           \
+    static void PFX##_impl_low_water(struct SNAME *_map_);                                         \
+    static bool PFX##_impl_shrink(struct SNAME *_map_, size_t required);                           \
+    static struct SNAME *PFX##_impl_load_layout(FILE *file, int (*compare)(K, K),                  \
+                                                size_t (*hash)(K),                                 \
+                                                struct cmc_serial_header *header);                 \
+                                                                                                   \
+    static size_t PFX##_impl_next_filled(struct SNAME *_map_, size_t from);                        \
+    static size_t PFX##_impl_prev_filled(struct SNAME *_map_, size_t from);                        \
+    static void PFX##_impl_occupancy_fill(struct SNAME *_map_);                                    \
     static size_t PFX##_impl_calculate_size(size_t required);                                      \
+    static inline size_t PFX##_impl_home(struct SNAME *_map_, size_t hash);                        \
+    static inline size_t PFX##_impl_wrap(struct SNAME *_map_, size_t pos);                         \
     static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_map_);                           \
     static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_map_);                             \
                                                                                                    \
+    CMC_GENERATE_PARALLEL_REDUCE(PFX##_impl_parallel_reduce, SNAME, V, (V, K, V),                  \
+                                 CMC_IMPL_PARALLEL_FILLED, CMC_IMPL_HASHMAP_##LAYOUT##_PARALLEL)   \
+                                                                                                   \
     struct SNAME *PFX##_new(size_t capacity, double load, int (*compare)(K, K),                    \
                             size_t (*hash)(K))                                                     \
     {                                                                                              \
+        return PFX##_new_custom(capacity, load, compare, hash, NULL);                              \
+    }                                                                                              \
+                                                                                                   \
+    struct SNAME *PFX##_new_custom(size_t capacity, double load, int (*compare)(K, K),             \
+                                   size_t (*hash)(K), struct cmc_alloc_node *alloc)                \
+    {                                                                                              \
+        if (!alloc)                                                                                \
+            alloc = &cmc_alloc_node_default;                                                       \
+                                                                                                   \
         if (capacity == 0 || load <= 0 || load >= 1)                                               \
             return NULL;                                                                           \
                                                                                                    \
@@ -235,24 +980,57 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
         size_t real_capacity = PFX##_impl_calculate_size(capacity / load);                         \
                                                                                                    \
-        struct SNAME *_map_ = malloc(sizeof(struct SNAME));                                        \
+        struct SNAME *_map_ = alloc->malloc(sizeof(struct SNAME));                                 \
                                                                                                    \
-        if (!_map_)                                                                                \
+        if (CMC_UNLIKELY(!_map_))                                                                  \
             return NULL;                                                                           \
                                                                                                    \
-        _map_->buffer = calloc(real_capacity, sizeof(struct SNAME##_entry));                       \
+        _map_->alloc = alloc;                                                                      \
+                                                                                                   \
+        if (capacity <= CMC_IMPL_HASHTABLE_##STORAGE##_SIZE)                                       \
+        {                                                                                          \
+            /* Small tables keep their entries inside the struct */                                \
+            real_capacity = CMC_IMPL_HASHTABLE_##STORAGE##_SIZE;                                   \
+            _map_->buffer = CMC_IMPL_HASHTABLE_##STORAGE##_BUFFER(_map_);                          \
+                                                                                                   \
+            memset(_map_->buffer, 0, sizeof(struct SNAME##_entry) * real_capacity);                \
+        }                                                                                          \
+        else                                                                                       \
+        {                                                                                          \
+            _map_->buffer = alloc->calloc(real_capacity, sizeof(struct SNAME##_entry));            \
+                                                                                                   \
+            if (CMC_UNLIKELY(!_map_->buffer))                                                      \
+            {                                                                                      \
+                alloc->free(_map_);                                                                \
+                return NULL;                                                                       \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        _map_->capacity = real_capacity;                                                           \
+        _map_->fastmod = cmc_fastmod_new(_map_->capacity);                                         \
                                                                                                    \
-        if (!_map_->buffer)                                                                        \
+        if (!PFX##_impl_values_new(_map_))                                                         \
         {                                                                                          \
-            free(_map_);                                                                           \
+            PFX##_impl_free_buffer(_map_);                                                         \
+            alloc->free(_map_);                                                                    \
             return NULL;                                                                           \
         }                                                                                          \
                                                                                                    \
         _map_->count = 0;                                                                          \
-        _map_->capacity = real_capacity;                                                           \
         _map_->load = load;                                                                        \
         _map_->cmp = compare;                                                                      \
         _map_->hash = hash;                                                                        \
+        _map_->old = NULL;                                                                         \
+        _map_->migrated = 0;                                                                       \
+                                                                                                   \
+        CMC_IMPL_HASHTABLE_PROBE_RESET(_map_);                                                     \
+        CMC_IMPL_HASHTABLE_FINGERPRINTED(_map_->fingerprint = 0;)                                  \
+                                                                                                   \
+        /* Small tables are not worth a bitmap */                                                  \
+        if (CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_map_))                                       \
+            CMC_IMPL_HASHTABLE_OCCUPANCY_NONE(_map_);                                              \
+        else                                                                                       \
+            CMC_IMPL_HASHTABLE_OCCUPANCY_NEW(_map_);                                               \
                                                                                                    \
         _map_->it_start = PFX##_impl_it_start;                                                     \
         _map_->it_end = PFX##_impl_it_end;                                                         \
@@ -260,142 +1038,408 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return _map_;                                                                              \
     }                                                                                              \
                                                                                                    \
+    /* Creates a map sized for the size keys and inserts them with their */                        \
+    /* values. Only the first value of a repeated key is kept */                                   \
+    struct SNAME *PFX##_new_from(K *keys, V *values, size_t size, double load,                     \
+                                 int (*compare)(K, K), size_t (*hash)(K))                          \
+    {                                                                                              \
+        struct SNAME *_map_ = PFX##_new(size, load, compare, hash);                                \
+                                                                                                   \
+        if (CMC_UNLIKELY(!_map_))                                                                  \
+            return NULL;                                                                           \
+                                                                                                   \
+        for (size_t i = 0; i < size; i++)                                                          \
+        {                                                                                          \
+            if (!PFX##_insert(_map_, keys[i], values[i]) && !PFX##_contains(_map_, keys[i]))       \
+            {                                                                                      \
+                PFX##_free(_map_, NULL);                                                           \
+                return NULL;                                                                       \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        return _map_;                                                                              \
+    }                                                                                              \
+                                                                                                   \
     void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V))                               \
     {                                                                                              \
+        PFX##_impl_migrate(_map_, SIZE_MAX);                                                       \
+                                                                                                   \
         if (deallocator)                                                                           \
         {                                                                                          \
-            for (size_t i = 0; i < _map_->capacity; i++)                                           \
+            for (size_t i = PFX##_impl_next_filled(_map_, 0); i < _map_->capacity;                 \
+                 i = PFX##_impl_next_filled(_map_, i + 1))                                         \
             {                                                                                      \
                 struct SNAME##_entry *entry = &(_map_->buffer[i]);                                 \
                                                                                                    \
-                if (entry->state == CMC_ES_FILLED)                                                 \
-                {                                                                                  \
-                    deallocator(entry->key, entry->value);                                         \
-                }                                                                                  \
+                deallocator(entry->key, *PFX##_impl_value(_map_, entry));                          \
             }                                                                                      \
         }                                                                                          \
                                                                                                    \
         memset(_map_->buffer, 0, sizeof(struct SNAME##_entry) * _map_->capacity);                  \
                                                                                                    \
+        CMC_IMPL_HASHMAP_##LAYOUT(memset(_map_->values, 0, sizeof(V) * _map_->capacity);)          \
+                                                                                                   \
+        uint64_t *bits = CMC_IMPL_HASHTABLE_OCCUPIED(_map_);                                       \
+                                                                                                   \
+        if (bits)                                                                                  \
+            memset(bits, 0, sizeof(uint64_t) * cmc_occupancy_words(_map_->capacity));              \
+                                                                                                   \
         _map_->count = 0;                                                                          \
+                                                                                                   \
+        CMC_IMPL_HASHTABLE_FINGERPRINTED(_map_->fingerprint = 0;)                                  \
     }                                                                                              \
                                                                                                    \
     void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V))                                \
     {                                                                                              \
+        if (_map_->old)                                                                            \
+        {                                                                                          \
+            PFX##_free(_map_->old, deallocator);                                                   \
+            _map_->old = NULL;                                                                     \
+        }                                                                                          \
+                                                                                                   \
         if (deallocator)                                                                           \
         {                                                                                          \
-            for (size_t i = 0; i < _map_->capacity; i++)                                           \
+            for (size_t i = PFX##_impl_next_filled(_map_, 0); i < _map_->capacity;                 \
+                 i = PFX##_impl_next_filled(_map_, i + 1))                                         \
             {                                                                                      \
                 struct SNAME##_entry *entry = &(_map_->buffer[i]);                                 \
                                                                                                    \
-                if (entry->state == CMC_ES_FILLED)                                                 \
-                {                                                                                  \
-                    deallocator(entry->key, entry->value);                                         \
-                }                                                                                  \
+                deallocator(entry->key, *PFX##_impl_value(_map_, entry));                          \
             }                                                                                      \
         }                                                                                          \
                                                                                                    \
-        free(_map_->buffer);                                                                       \
-        free(_map_);                                                                               \
+        CMC_IMPL_HASHTABLE_OCCUPANCY_FREE(_map_);                                                  \
+                                                                                                   \
+        PFX##_impl_free_buffer(_map_);                                                             \
+        _map_->alloc->free(_map_);                                                                 \
     }                                                                                              \
                                                                                                    \
     bool PFX##_insert(struct SNAME *_map_, K key, V value)                                         \
     {                                                                                              \
+        PFX##_impl_migrate(_map_, CMC_HASHMAP_MIGRATE_STEP);                                       \
+                                                                                                   \
         if (PFX##_full(_map_))                                                                     \
         {                                                                                          \
-            if (!PFX##_resize(_map_, PFX##_capacity(_map_) + 1))                                   \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_map_, PFX##_capacity(_map_) + 1)))                  \
                 return false;                                                                      \
         }                                                                                          \
                                                                                                    \
-        size_t hash = _map_->hash(key);                                                            \
-        size_t original_pos = hash % _map_->capacity;                                              \
-        size_t pos = original_pos;                                                                 \
-                                                                                                   \
-        struct SNAME##_entry *target = &(_map_->buffer[pos]);                                      \
-                                                                                                   \
-        if (PFX##_impl_get_entry(_map_, key) != NULL)                                              \
-            return false;                                                                          \
+        /* Small tables are searched without the hash */                                           \
+        size_t hash =                                                                              \
+            CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_map_) ? 0 : PFX##_impl_hash(_map_, key);     \
                                                                                                    \
-        if (target->state == CMC_ES_EMPTY || target->state == CMC_ES_DELETED)                      \
+        /* Only tables bigger than CMC_ES_DIST_MAX can run out of bits to */                       \
+        /* store the distance of an entry */                                                       \
+        if (PFX##_capacity(_map_) > CMC_ES_DIST_MAX && PFX##_impl_dist_overflow(_map_, hash))      \
         {                                                                                          \
-            target->key = key;                                                                     \
-            target->value = value;                                                                 \
-            target->dist = 0;                                                                      \
-            target->state = CMC_ES_FILLED;                                                         \
-        }                                                                                          \
-        else                                                                                       \
-        {                                                                                          \
-            while (true)                                                                           \
-            {                                                                                      \
-                pos++;                                                                             \
-                target = &(_map_->buffer[pos % _map_->capacity]);                                  \
+            if (CMC_UNLIKELY(!PFX##_resize(_map_, PFX##_capacity(_map_) + 1)))                     \
+                return false;                                                                      \
                                                                                                    \
-                if (target->state == CMC_ES_EMPTY || target->state == CMC_ES_DELETED)              \
-                {                                                                                  \
-                    target->key = key;                                                             \
-                    target->value = value;                                                         \
-                    target->dist = pos - original_pos;                                             \
-                    target->state = CMC_ES_FILLED;                                                 \
+            return PFX##_insert(_map_, key, value);                                                \
+        }                                                                                          \
                                                                                                    \
-                    break;                                                                         \
-                }                                                                                  \
-                else if (target->dist < pos - original_pos)                                        \
-                {                                                                                  \
-                    K tmp_k = target->key;                                                         \
-                    V tmp_v = target->value;                                                       \
-                    size_t tmp_dist = target->dist;                                                \
+        if (_map_->old && PFX##_impl_get_entry_by_hash(_map_->old, key, hash) != NULL)             \
+            return false;                                                                          \
                                                                                                    \
-                    target->key = key;                                                             \
-                    target->value = value;                                                         \
-                    target->dist = pos - original_pos;                                             \
+        struct SNAME##_entry *existing;                                                            \
                                                                                                    \
-                    key = tmp_k;                                                                   \
-                    value = tmp_v;                                                                 \
-                    original_pos = pos - tmp_dist;                                                 \
-                }                                                                                  \
-            }                                                                                      \
-        }                                                                                          \
+        if (!PFX##_impl_insert_entry(_map_, key, value, hash, &existing))                          \
+            return false;                                                                          \
                                                                                                    \
         _map_->count++;                                                                            \
                                                                                                    \
+        /* Small tables did not hash the key */                                                    \
+        CMC_IMPL_HASHTABLE_FINGERPRINTED(_map_->fingerprint += cmc_hashtable_mix(                  \
+            hash ? hash : PFX##_impl_hash(_map_, key));)                                           \
+                                                                                                   \
         return true;                                                                               \
     }                                                                                              \
                                                                                                    \
-    bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value)                       \
+    size_t PFX##_insert_many(struct SNAME *_map_, K *keys, V *values, size_t n)                    \
+    {                                                                                              \
+        /* Grow once for every key instead of one threshold at a time */                           \
+        if (CMC_UNLIKELY(!PFX##_resize(_map_, PFX##_count(_map_) + n)))                            \
+            return 0;                                                                              \
+                                                                                                   \
+        size_t hashes[CMC_IMPL_HASHTABLE_BATCH];                                                   \
+        struct SNAME##_entry *existing;                                                            \
+                                                                                                   \
+        size_t total = 0;                                                                          \
+                                                                                                   \
+        /* Every key still fits in the entries of the struct */                                    \
+        if (CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_map_))                                       \
+        {                                                                                          \
+            for (size_t i = 0; i < n; i++)                                                         \
+            {                                                                                      \
+                if (PFX##_insert(_map_, keys[i], values[i]))                                       \
+                    total++;                                                                       \
+            }                                                                                      \
+                                                                                                   \
+            return total;                                                                          \
+        }                                                                                          \
+                                                                                                   \
+        for (size_t i = 0; i < n; i += CMC_IMPL_HASHTABLE_BATCH)                                   \
+        {                                                                                          \
+            size_t batch = n - i < CMC_IMPL_HASHTABLE_BATCH ? n - i : CMC_IMPL_HASHTABLE_BATCH;    \
+                                                                                                   \
+            for (size_t j = 0; j < batch; j++)                                                     \
+            {                                                                                      \
+                hashes[j] = PFX##_impl_hash(_map_, keys[i + j]);                                   \
+                                                                                                   \
+                CMC_IMPL_HASHTABLE_PREFETCH(&(_map_->buffer[PFX##_impl_home(_map_, hashes[j])]));  \
+            }                                                                                      \
+                                                                                                   \
+            for (size_t j = 0; j < batch; j++)                                                     \
+            {                                                                                      \
+                K key = keys[i + j];                                                               \
+                V value = values[i + j];                                                           \
+                                                                                                   \
+                /* Let insert deal with distances that do not fit */                               \
+                if (PFX##_capacity(_map_) > CMC_ES_DIST_MAX &&                                     \
+                    PFX##_impl_dist_overflow(_map_, hashes[j]))                                    \
+                {                                                                                  \
+                    if (PFX##_insert(_map_, key, value))                                           \
+                        total++;                                                                   \
+                                                                                                   \
+                    continue;                                                                      \
+                }                                                                                  \
+                                                                                                   \
+                if (PFX##_impl_insert_entry(_map_, key, value, hashes[j], &existing))              \
+                {                                                                                  \
+                    _map_->count++;                                                                \
+                    total++;                                                                       \
+                                                                                                   \
+                    CMC_IMPL_HASHTABLE_FINGERPRINTED(                                              \
+                        _map_->fingerprint += cmc_hashtable_mix(hashes[j]);)                       \
+                }                                                                                  \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        return total;                                                                              \
+    }                                                                                              \
+                                                                                                   \
+    V *PFX##_get_or_insert(struct SNAME *_map_, K key, V default_value)                            \
+    {                                                                                              \
+        PFX##_impl_migrate(_map_, CMC_HASHMAP_MIGRATE_STEP);                                       \
+                                                                                                   \
+        if (PFX##_full(_map_))                                                                     \
+        {                                                                                          \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_map_, PFX##_capacity(_map_) + 1)))                  \
+                return NULL;                                                                       \
+        }                                                                                          \
+                                                                                                   \
+        size_t hash =                                                                              \
+            CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_map_) ? 0 : PFX##_impl_hash(_map_, key);     \
+                                                                                                   \
+        if (PFX##_capacity(_map_) > CMC_ES_DIST_MAX && PFX##_impl_dist_overflow(_map_, hash))      \
+        {                                                                                          \
+            if (CMC_UNLIKELY(!PFX##_resize(_map_, PFX##_capacity(_map_) + 1)))                     \
+                return NULL;                                                                       \
+                                                                                                   \
+            return PFX##_get_or_insert(_map_, key, default_value);                                 \
+        }                                                                                          \
+                                                                                                   \
+        struct SNAME##_entry *entry = NULL;                                                        \
+                                                                                                   \
+        if (_map_->old)                                                                            \
+            entry = PFX##_impl_get_entry_by_hash(_map_->old, key, hash);                           \
+                                                                                                   \
+        /* Looks for the key and places it in the same probe */                                    \
+        if (!entry)                                                                                \
+        {                                                                                          \
+            struct SNAME##_entry *inserted =                                                       \
+                PFX##_impl_insert_entry(_map_, key, default_value, hash, &entry);                  \
+                                                                                                   \
+            if (inserted)                                                                          \
+            {                                                                                      \
+                entry = inserted;                                                                  \
+                _map_->count++;                                                                    \
+                                                                                                   \
+                CMC_IMPL_HASHTABLE_FINGERPRINTED(_map_->fingerprint += cmc_hashtable_mix(          \
+                    hash ? hash : PFX##_impl_hash(_map_, key));)                                   \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        return PFX##_impl_value(_map_, entry);                                                     \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_upsert(struct SNAME *_map_, K key, V value)                                         \
+    {                                                                                              \
+        V *ref = PFX##_get_or_insert(_map_, key, value);                                           \
+                                                                                                   \
+        if (!ref)                                                                                  \
+            return false;                                                                          \
+                                                                                                   \
+        *ref = value;                                                                              \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Adds every key of _map2_ to _map1_. A key that is in both gets */                           \
+    /* combine(value in _map1_, value in _map2_), or keeps its value if */                         \
+    /* combine is NULL. Every key is looked up and placed in a single probe. */                    \
+    /* Maps built by many threads can be reduced pairwise, the merges of one */                    \
+    /* round use different maps so they can run at the same time */                                \
+    bool PFX##_merge(struct SNAME *_map1_, struct SNAME *_map2_, V (*combine)(V, V))               \
+    {                                                                                              \
+        /* Grow once for both maps instead of one threshold at a time */                           \
+        if (CMC_UNLIKELY(!PFX##_resize(_map1_, PFX##_count(_map1_) + PFX##_count(_map2_))))        \
+            return false;                                                                          \
+                                                                                                   \
+        struct SNAME##_iter iter;                                                                  \
+                                                                                                   \
+        for (PFX##_iter_init(&iter, _map2_); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))       \
+        {                                                                                          \
+            size_t count = _map1_->count;                                                          \
+            V value = PFX##_iter_value(&iter);                                                     \
+                                                                                                   \
+            V *ref = PFX##_get_or_insert(_map1_, PFX##_iter_key(&iter), value);                    \
+                                                                                                   \
+            if (!ref)                                                                              \
+                return false;                                                                      \
+                                                                                                   \
+            if (_map1_->count == count && combine)                                                 \
+                *ref = combine(*ref, value);                                                       \
+        }                                                                                          \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Same as merge but frees _map2_, so its keys are moved to _map1_ with */                     \
+    /* their values instead of being shared by both maps. The keys of _map2_ */                    \
+    /* that were already in _map1_ are given to the deallocator with their */                      \
+    /* values once combined. If _map1_ can't grow _map2_ is not freed */                           \
+    bool PFX##_merge_free(struct SNAME *_map1_, struct SNAME *_map2_, V (*combine)(V, V),          \
+                          void (*deallocator)(K, V))                                               \
+    {                                                                                              \
+        if (CMC_UNLIKELY(!PFX##_resize(_map1_, PFX##_count(_map1_) + PFX##_count(_map2_))))        \
+            return false;                                                                          \
+                                                                                                   \
+        struct SNAME##_iter iter;                                                                  \
+                                                                                                   \
+        for (PFX##_iter_init(&iter, _map2_); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))       \
+        {                                                                                          \
+            size_t count = _map1_->count;                                                          \
+            K key = PFX##_iter_key(&iter);                                                         \
+            V value = PFX##_iter_value(&iter);                                                     \
+                                                                                                   \
+            V *ref = PFX##_get_or_insert(_map1_, key, value);                                      \
+                                                                                                   \
+            if (!ref)                                                                              \
+                return false;                                                                      \
+                                                                                                   \
+            if (_map1_->count == count)                                                            \
+            {                                                                                      \
+                if (combine)                                                                       \
+                    *ref = combine(*ref, value);                                                   \
+                                                                                                   \
+                if (deallocator)                                                                   \
+                    deallocator(key, value);                                                       \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        /* Every key now belongs to _map1_ or was deallocated */                                   \
+        PFX##_free(_map2_, NULL);                                                                  \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value)                       \
     {                                                                                              \
         struct SNAME##_entry *entry = PFX##_impl_get_entry(_map_, key);                            \
                                                                                                    \
         if (!entry)                                                                                \
             return false;                                                                          \
                                                                                                    \
+        V *value = PFX##_impl_value(_map_, entry);                                                 \
+                                                                                                   \
         if (old_value)                                                                             \
-            *old_value = entry->value;                                                             \
+            *old_value = *value;                                                                   \
                                                                                                    \
-        entry->value = new_value;                                                                  \
+        *value = new_value;                                                                        \
                                                                                                    \
         return true;                                                                               \
     }                                                                                              \
                                                                                                    \
     bool PFX##_remove(struct SNAME *_map_, K key, V *out_value)                                    \
     {                                                                                              \
-        struct SNAME##_entry *result = PFX##_impl_get_entry(_map_, key);                           \
+        PFX##_impl_migrate(_map_, CMC_HASHMAP_MIGRATE_STEP);                                       \
+                                                                                                   \
+        size_t hash =                                                                              \
+            CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_map_) ? 0 : PFX##_impl_hash(_map_, key);     \
+                                                                                                   \
+        /* The entry might still be in the previous buffer */                                      \
+        struct SNAME *table = _map_;                                                               \
+        struct SNAME##_entry *result = PFX##_impl_get_entry_by_hash(_map_, key, hash);             \
+                                                                                                   \
+        if (result == NULL && _map_->old)                                                          \
+        {                                                                                          \
+            table = _map_->old;                                                                    \
+            result = PFX##_impl_get_entry_by_hash(table, key, hash);                               \
+        }                                                                                          \
                                                                                                    \
         if (result == NULL)                                                                        \
             return false;                                                                          \
                                                                                                    \
         if (out_value)                                                                             \
-            *out_value = result->value;                                                            \
+            *out_value = *PFX##_impl_value(table, result);                                         \
                                                                                                    \
-        result->key = (K){0};                                                                      \
-        result->value = (V){0};                                                                    \
-        result->dist = 0;                                                                          \
-        result->state = CMC_ES_DELETED;                                                            \
+        PFX##_impl_remove_entry(table, result);                                                    \
                                                                                                    \
         _map_->count--;                                                                            \
                                                                                                    \
+        CMC_IMPL_HASHTABLE_FINGERPRINTED(_map_->fingerprint -= cmc_hashtable_mix(                  \
+            hash ? hash : PFX##_impl_hash(_map_, key));)                                           \
+                                                                                                   \
+        PFX##_impl_low_water(_map_);                                                               \
+                                                                                                   \
         return true;                                                                               \
     }                                                                                              \
                                                                                                    \
+    /* Removes every entry for which pred is true in a single sweep of the */                      \
+    /* buffer. Returns how many were removed */                                                    \
+    size_t PFX##_remove_if(struct SNAME *_map_, bool (*pred)(K, V),                                \
+                           void (*deallocator)(K, V))                                              \
+    {                                                                                              \
+        PFX##_impl_migrate(_map_, SIZE_MAX);                                                       \
+                                                                                                   \
+        size_t removed = 0;                                                                        \
+                                                                                                   \
+        /* Backward shift deletion moves the following entry into the slot */                      \
+        /* that was just emptied, so the same position is checked again */                         \
+        for (size_t i = PFX##_impl_next_filled(_map_, 0); i < _map_->capacity;                     \
+             i = PFX##_impl_next_filled(_map_, i))                                                 \
+        {                                                                                          \
+            struct SNAME##_entry *entry = &(_map_->buffer[i]);                                     \
+                                                                                                   \
+            K key = entry->key;                                                                    \
+            V value = *PFX##_impl_value(_map_, entry);                                             \
+                                                                                                   \
+            if (!pred(key, value))                                                                 \
+            {                                                                                      \
+                i++;                                                                               \
+                continue;                                                                          \
+            }                                                                                      \
+                                                                                                   \
+            CMC_IMPL_HASHTABLE_FINGERPRINTED(                                                      \
+                _map_->fingerprint -= cmc_hashtable_mix(PFX##_impl_hash(_map_, key));)             \
+                                                                                                   \
+            PFX##_impl_remove_entry(_map_, entry);                                                 \
+                                                                                                   \
+            if (deallocator)                                                                       \
+                deallocator(key, value);                                                           \
+                                                                                                   \
+            removed++;                                                                             \
+        }                                                                                          \
+                                                                                                   \
+        _map_->count -= removed;                                                                   \
+                                                                                                   \
+        if (removed > 0)                                                                           \
+            PFX##_impl_low_water(_map_);                                                           \
+                                                                                                   \
+        return removed;                                                                            \
+    }                                                                                              \
+                                                                                                   \
     bool PFX##_max(struct SNAME *_map_, K *key, V *value)                                          \
     {                                                                                              \
         if (PFX##_empty(_map_))                                                                    \
@@ -414,7 +1458,7 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
             K iter_key = PFX##_iter_key(&iter);                                                    \
             V iter_val = PFX##_iter_value(&iter);                                                  \
                                                                                                    \
-            if (_map_->cmp(iter_key, max_key) > 0)                                                 \
+            if (PFX##_impl_cmp(_map_, iter_key, max_key) > 0)                                      \
             {                                                                                      \
                 max_key = iter_key;                                                                \
                 max_val = iter_val;                                                                \
@@ -447,7 +1491,7 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
             K iter_key = PFX##_iter_key(&iter);                                                    \
             V iter_val = PFX##_iter_value(&iter);                                                  \
                                                                                                    \
-            if (_map_->cmp(iter_key, min_key) < 0)                                                 \
+            if (PFX##_impl_cmp(_map_, iter_key, min_key) < 0)                                      \
             {                                                                                      \
                 min_key = iter_key;                                                                \
                 min_val = iter_val;                                                                \
@@ -469,7 +1513,7 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         if (!entry)                                                                                \
             return (V){0};                                                                         \
                                                                                                    \
-        return entry->value;                                                                       \
+        return *PFX##_impl_value(_map_, entry);                                                    \
     }                                                                                              \
                                                                                                    \
     V *PFX##_get_ref(struct SNAME *_map_, K key)                                                   \
@@ -479,7 +1523,37 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         if (!entry)                                                                                \
             return NULL;                                                                           \
                                                                                                    \
-        return &(entry->value);                                                                    \
+        return PFX##_impl_value(_map_, entry);                                                     \
+    }                                                                                              \
+                                                                                                   \
+    size_t PFX##_get_many(struct SNAME *_map_, K *CMC_RESTRICT keys, size_t n,                     \
+                          V *CMC_RESTRICT out, bool *CMC_RESTRICT found)                           \
+    {                                                                                              \
+        PFX##_impl_migrate(_map_, CMC_HASHMAP_MIGRATE_STEP);                                       \
+                                                                                                   \
+        struct SNAME##_entry *entries[CMC_IMPL_HASHTABLE_BATCH];                                   \
+                                                                                                   \
+        size_t total = 0;                                                                          \
+                                                                                                   \
+        for (size_t i = 0; i < n; i += CMC_IMPL_HASHTABLE_BATCH)                                   \
+        {                                                                                          \
+            size_t batch = n - i < CMC_IMPL_HASHTABLE_BATCH ? n - i : CMC_IMPL_HASHTABLE_BATCH;    \
+                                                                                                   \
+            PFX##_impl_get_batch(_map_, keys + i, batch, entries);                                 \
+                                                                                                   \
+            for (size_t j = 0; j < batch; j++)                                                     \
+            {                                                                                      \
+                if (entries[j])                                                                    \
+                    total++;                                                                       \
+                                                                                                   \
+                if (out)                                                                           \
+                    out[i + j] = entries[j] ? *PFX##_impl_value(_map_, entries[j]) : (V){0};       \
+                if (found)                                                                         \
+                    found[i + j] = entries[j] != NULL;                                             \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        return total;                                                                              \
     }                                                                                              \
                                                                                                    \
     bool PFX##_contains(struct SNAME *_map_, K key)                                                \
@@ -487,6 +1561,11 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return PFX##_impl_get_entry(_map_, key) != NULL;                                           \
     }                                                                                              \
                                                                                                    \
+    size_t PFX##_contains_many(struct SNAME *_map_, K *keys, size_t n, bool *found)                \
+    {                                                                                              \
+        return PFX##_get_many(_map_, keys, n, NULL, found);                                        \
+    }                                                                                              \
+                                                                                                   \
     bool PFX##_empty(struct SNAME *_map_)                                                          \
     {                                                                                              \
         return _map_->count == 0;                                                                  \
@@ -494,6 +1573,10 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
     bool PFX##_full(struct SNAME *_map_)                                                           \
     {                                                                                              \
+        /* Small tables use every one of their entries */                                          \
+        if (CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_map_))                                       \
+            return PFX##_count(_map_) >= PFX##_capacity(_map_);                                    \
+                                                                                                   \
         return (double)PFX##_capacity(_map_) * PFX##_load(_map_) <= (double)PFX##_count(_map_);    \
     }                                                                                              \
                                                                                                    \
@@ -502,6 +1585,24 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return _map_->count;                                                                       \
     }                                                                                              \
                                                                                                    \
+    size_t PFX##_memory_usage(struct SNAME *_map_)                                                 \
+    {                                                                                              \
+        size_t bytes = 0;                                                                          \
+                                                                                                   \
+        /* Also the previous table of an INCREMENTAL hashmap that is being moved */                \
+        for (struct SNAME *table = _map_; table; table = table->old)                               \
+        {                                                                                          \
+            bytes += sizeof(struct SNAME) + CMC_IMPL_HASHTABLE_OCCUPANCY_BYTES(table);             \
+                                                                                                   \
+            if (!CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(table))                                  \
+                bytes += sizeof(struct SNAME##_entry) * table->capacity;                           \
+                                                                                                   \
+            bytes += CMC_IMPL_HASHMAP_##LAYOUT##_VALUE_SIZE(V) * table->capacity;                  \
+        }                                                                                          \
+                                                                                                   \
+        return bytes;                                                                              \
+    }                                                                                              \
+                                                                                                   \
     size_t PFX##_capacity(struct SNAME *_map_)                                                     \
     {                                                                                              \
         return _map_->capacity;                                                                    \
@@ -512,8 +1613,47 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return _map_->load;                                                                        \
     }                                                                                              \
                                                                                                    \
+    void PFX##_stats(struct SNAME *_map_, struct cmc_hashtable_stats *out)                         \
+    {                                                                                              \
+        memset(out, 0, sizeof(struct cmc_hashtable_stats));                                        \
+                                                                                                   \
+        out->capacity = _map_->capacity;                                                           \
+        out->count = _map_->count;                                                                 \
+                                                                                                   \
+        /* An INCREMENTAL map that is still growing also owns its previous */                      \
+        /* buffer, whose entries are counted in the same histogram */                              \
+        for (struct SNAME *table = _map_; table != NULL; table = table->old)                       \
+        {                                                                                          \
+            out->bytes += sizeof(struct SNAME);                                                    \
+                                                                                                   \
+            if (!CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(table))                                  \
+                out->bytes += sizeof(struct SNAME##_entry) * table->capacity;                      \
+                                                                                                   \
+            out->bytes += CMC_IMPL_HASHMAP_##LAYOUT##_VALUE_SIZE(V) * table->capacity;             \
+                                                                                                   \
+            if (CMC_IMPL_HASHTABLE_OCCUPIED(table))                                                \
+                out->bytes += sizeof(uint64_t) * cmc_occupancy_words(table->capacity);             \
+                                                                                                   \
+            for (size_t i = 0; i < table->capacity; i++)                                           \
+            {                                                                                      \
+                struct SNAME##_entry *entry = &(table->buffer[i]);                                 \
+                                                                                                   \
+                if (entry->state == CMC_ES_FILLED)                                                 \
+                    cmc_hashtable_stats_add(out, entry->dist);                                     \
+                else if (entry->state == CMC_ES_DELETED)                                           \
+                    out->tombstones++;                                                             \
+            }                                                                                      \
+                                                                                                   \
+            CMC_IMPL_HASHTABLE_PROBE_ADD(out, table);                                              \
+        }                                                                                          \
+                                                                                                   \
+        cmc_hashtable_stats_end(out);                                                              \
+    }                                                                                              \
+                                                                                                   \
     bool PFX##_resize(struct SNAME *_map_, size_t capacity)                                        \
     {                                                                                              \
+        PFX##_impl_migrate(_map_, SIZE_MAX);                                                       \
+                                                                                                   \
         if (PFX##_capacity(_map_) == capacity)                                                     \
             return true;                                                                           \
                                                                                                    \
@@ -531,91 +1671,146 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         if (theoretical_size < PFX##_count(_map_) / PFX##_load(_map_))                             \
             return false;                                                                          \
                                                                                                    \
-        struct SNAME *_new_map_ = PFX##_new(capacity, PFX##_load(_map_), _map_->cmp, _map_->hash); \
+        return PFX##_impl_rehash(_map_, capacity);                                                 \
+    }                                                                                              \
                                                                                                    \
-        if (!_new_map_)                                                                            \
-            return false;                                                                          \
+    bool PFX##_shrink_to_fit(struct SNAME *_map_)                                                  \
+    {                                                                                              \
+        return PFX##_impl_shrink(_map_, PFX##_count(_map_));                                       \
+    }                                                                                              \
                                                                                                    \
-        struct SNAME##_iter iter;                                                                  \
+    struct SNAME *PFX##_copy_of(struct SNAME *_map_, K (*key_copy_func)(K),                        \
+                                V (*value_copy_func)(V))                                           \
+    {                                                                                              \
+        PFX##_impl_migrate(_map_, SIZE_MAX);                                                       \
                                                                                                    \
-        for (PFX##_iter_init(&iter, _map_); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))        \
-        {                                                                                          \
-            K key = PFX##_iter_key(&iter);                                                         \
-            V value = PFX##_iter_value(&iter);                                                     \
+        struct SNAME *result = PFX##_new_custom(_map_->capacity, _map_->load, _map_->cmp,          \
+                                                _map_->hash, _map_->alloc);                        \
                                                                                                    \
-            PFX##_insert(_new_map_, key, value);                                                   \
-        }                                                                                          \
+        if (CMC_UNLIKELY(!result))                                                                 \
+            return NULL;                                                                           \
                                                                                                    \
-        if (PFX##_count(_map_) != PFX##_count(_new_map_))                                          \
+        /* Entries are copied to the same positions so both buffers must */                        \
+        /* have the same size */                                                                   \
+        if (result->capacity != _map_->capacity)                                                   \
         {                                                                                          \
-            PFX##_free(_new_map_, NULL);                                                           \
-            return false;                                                                          \
-        }                                                                                          \
+            struct SNAME##_entry *buffer = _map_->alloc->calloc(_map_->capacity,                   \
+                                                                sizeof(struct SNAME##_entry));     \
                                                                                                    \
-        struct SNAME##_entry *tmp_b = _map_->buffer;                                               \
-        _map_->buffer = _new_map_->buffer;                                                         \
-        _new_map_->buffer = tmp_b;                                                                 \
+            if (CMC_UNLIKELY(!buffer))                                                             \
+            {                                                                                      \
+                PFX##_free(result, NULL);                                                          \
+                return NULL;                                                                       \
+            }                                                                                      \
                                                                                                    \
-        size_t tmp_c = _map_->capacity;                                                            \
-        _map_->capacity = _new_map_->capacity;                                                     \
-        _new_map_->capacity = tmp_c;                                                               \
+            PFX##_impl_free_buffer(result);                                                        \
+            result->buffer = buffer;                                                               \
+            result->capacity = _map_->capacity;                                                    \
+            result->fastmod = cmc_fastmod_new(result->capacity);                                   \
                                                                                                    \
-        PFX##_free(_new_map_, NULL);                                                               \
+            CMC_IMPL_HASHTABLE_OCCUPANCY_FREE(result);                                             \
+            CMC_IMPL_HASHTABLE_OCCUPANCY_NEW(result);                                              \
                                                                                                    \
-        return true;                                                                               \
-    }                                                                                              \
+            if (!PFX##_impl_values_new(result))                                                    \
+            {                                                                                      \
+                PFX##_free(result, NULL);                                                          \
+                return NULL;                                                                       \
+            }                                                                                      \
+        }                                                                                          \
                                                                                                    \
-    struct SNAME *PFX##_copy_of(struct SNAME *_map_, K (*key_copy_func)(K),                        \
-                                V (*value_copy_func)(V))                                           \
-    {                                                                                              \
-        struct SNAME *result = PFX##_new(_map_->capacity, _map_->load, _map_->cmp, _map_->hash);   \
+        memcpy(result->buffer, _map_->buffer, sizeof(struct SNAME##_entry) * _map_->capacity);     \
                                                                                                    \
-        if (!result)                                                                               \
-            return NULL;                                                                           \
+        CMC_IMPL_HASHMAP_##LAYOUT(                                                                 \
+            memcpy(result->values, _map_->values, sizeof(V) * _map_->capacity);)                   \
+                                                                                                   \
+        uint64_t *bits = CMC_IMPL_HASHTABLE_OCCUPIED(result);                                      \
+        uint64_t *source = CMC_IMPL_HASHTABLE_OCCUPIED(_map_);                                     \
                                                                                                    \
+        if (bits && source)                                                                        \
+            memcpy(bits, source, sizeof(uint64_t) * cmc_occupancy_words(_map_->capacity));         \
+        else                                                                                       \
+            PFX##_impl_occupancy_fill(result);                                                     \
+                                                                                                   \
+        /* Only filled slots have something to copy */                                             \
         if (key_copy_func || value_copy_func)                                                      \
         {                                                                                          \
-            for (size_t i = 0; i < _map_->capacity; i++)                                           \
+            for (size_t i = PFX##_impl_next_filled(_map_, 0); i < _map_->capacity;                 \
+                 i = PFX##_impl_next_filled(_map_, i + 1))                                         \
             {                                                                                      \
-                struct SNAME##_entry *scan = &(_map_->buffer[i]);                                  \
+                struct SNAME##_entry *target = &(result->buffer[i]);                               \
                                                                                                    \
-                if (scan->state != CMC_ES_EMPTY)                                                   \
+                if (key_copy_func)                                                                 \
+                    target->key = key_copy_func(target->key);                                      \
+                                                                                                   \
+                if (value_copy_func)                                                               \
                 {                                                                                  \
-                    struct SNAME##_entry *target = &(result->buffer[i]);                           \
-                                                                                                   \
-                    if (scan->state == CMC_ES_DELETED)                                             \
-                        target->state = CMC_ES_DELETED;                                            \
-                    else                                                                           \
-                    {                                                                              \
-                        target->state = scan->state;                                               \
-                        target->dist = scan->dist;                                                 \
-                                                                                                   \
-                        if (key_copy_func)                                                         \
-                            target->key = key_copy_func(scan->key);                                \
-                        else                                                                       \
-                            target->key = scan->key;                                               \
-                                                                                                   \
-                        if (value_copy_func)                                                       \
-                            target->value = value_copy_func(scan->value);                          \
-                        else                                                                       \
-                            target->value = scan->value;                                           \
-                    }                                                                              \
+                    V *value = PFX##_impl_value(result, target);                                   \
+                                                                                                   \
+                    *value = value_copy_func(*value);                                              \
                 }                                                                                  \
             }                                                                                      \
         }                                                                                          \
-        else                                                                                       \
-            memcpy(result->buffer, _map_->buffer, sizeof(struct SNAME##_entry) * _map_->capacity); \
                                                                                                    \
         result->count = _map_->count;                                                              \
                                                                                                    \
+        /* Keys made by key_copy_func might not hash as the originals do */                        \
+        CMC_IMPL_HASHTABLE_FINGERPRINTED(result->fingerprint = key_copy_func                       \
+                                             ? PFX##_impl_fingerprint(result)                      \
+                                             : _map_->fingerprint;)                                \
+                                                                                                   \
         return result;                                                                             \
     }                                                                                              \
                                                                                                    \
+    /* Copies up to size entries, in the order of the buffer, to keys and */                       \
+    /* values, either of which can be NULL, and returns how many were copied */                    \
+    size_t PFX##_to_array(struct SNAME *_map_, K *CMC_RESTRICT keys, V *CMC_RESTRICT values,       \
+                          size_t size)                                                             \
+    {                                                                                              \
+        /* Everything is in one buffer once a pending migration is done */                         \
+        PFX##_impl_migrate(_map_, SIZE_MAX);                                                       \
+                                                                                                   \
+        size_t j = 0;                                                                              \
+                                                                                                   \
+        for (size_t i = PFX##_impl_next_filled(_map_, 0); i < _map_->capacity && j < size;         \
+             i = PFX##_impl_next_filled(_map_, i + 1), j++)                                        \
+        {                                                                                          \
+            if (keys)                                                                              \
+                keys[j] = _map_->buffer[i].key;                                                    \
+            if (values)                                                                            \
+                values[j] = *PFX##_impl_value(_map_, &(_map_->buffer[i]));                         \
+        }                                                                                          \
+                                                                                                   \
+        return j;                                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    /* A parallel scan has one slot for each slot of the buffer. Everything */                     \
+    /* is in one buffer once a pending migration is done */                                        \
+    size_t PFX##_parallel_slots(struct SNAME *_map_)                                               \
+    {                                                                                              \
+        PFX##_impl_migrate(_map_, SIZE_MAX);                                                       \
+                                                                                                   \
+        return _map_->capacity;                                                                    \
+    }                                                                                              \
+                                                                                                   \
+    /* Splits the buffer into ranges of slots, one for each of up to the given */                  \
+    /* amount of threads, and combines the results of each range */                                \
+    V PFX##_parallel_reduce(struct SNAME *_map_, V initial, V (*reduce)(V, K, V),                  \
+                            V (*combine)(V, V), size_t threads)                                    \
+    {                                                                                              \
+        size_t slots = PFX##_parallel_slots(_map_);                                                \
+                                                                                                   \
+        return PFX##_impl_parallel_reduce(_map_, slots, initial, reduce, combine, threads);        \
+    }                                                                                              \
+                                                                                                   \
     bool PFX##_equals(struct SNAME *_map1_, struct SNAME *_map2_, int (*value_comparator)(V, V))   \
     {                                                                                              \
         if (PFX##_count(_map1_) != PFX##_count(_map2_))                                            \
             return false;                                                                          \
                                                                                                    \
+        /* Maps with the same keys always have the same fingerprint */                             \
+        if (CMC_IMPL_HASHTABLE_FINGERPRINT_DIFFERS(_map1_, _map2_))                                \
+            return false;                                                                          \
+                                                                                                   \
         struct SNAME##_iter iter;                                                                  \
         PFX##_iter_init(&iter, _map1_);                                                            \
                                                                                                    \
@@ -628,7 +1823,9 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
             if (value_comparator)                                                                  \
             {                                                                                      \
-                if (value_comparator(entry->value, PFX##_iter_value(&iter)) != 0)                  \
+                V value = *PFX##_impl_value(_map2_, entry);                                        \
+                                                                                                   \
+                if (value_comparator(value, PFX##_iter_value(&iter)) != 0)                         \
                     return false;                                                                  \
             }                                                                                      \
         }                                                                                          \
@@ -636,6 +1833,16 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return true;                                                                               \
     }                                                                                              \
                                                                                                    \
+    size_t PFX##_fingerprint(struct SNAME *_map_)                                                  \
+    {                                                                                              \
+        CMC_IMPL_HASHTABLE_FINGERPRINTED(return _map_->fingerprint;)                               \
+                                                                                                   \
+        /* Everything is in one buffer once a pending migration is done */                         \
+        PFX##_impl_migrate(_map_, SIZE_MAX);                                                       \
+                                                                                                   \
+        return PFX##_impl_fingerprint(_map_);                                                      \
+    }                                                                                              \
+                                                                                                   \
     struct cmc_string PFX##_to_string(struct SNAME *_map_)                                         \
     {                                                                                              \
         struct cmc_string str;                                                                     \
@@ -648,52 +1855,256 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return str;                                                                                \
     }                                                                                              \
                                                                                                    \
-    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                      \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_ENTRY)                                 \
+                                                                                                   \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_ENTRY, (K, V))                                \
+                                                                                                   \
+    bool PFX##_save(struct SNAME *_map_, FILE *file, bool (*key_writer)(K, FILE *),                \
+                    bool (*value_writer)(V, FILE *))                                               \
     {                                                                                              \
-        struct SNAME##_iter *iter = malloc(sizeof(struct SNAME##_iter));                           \
+        uint32_t flags = (key_writer ? 0 : CMC_SERIAL_RAW_KEYS) |                                  \
+                         (value_writer ? 0 : CMC_SERIAL_RAW_VALUES);                               \
                                                                                                    \
-        if (!iter)                                                                                 \
-            return NULL;                                                                           \
+        /* The entries of a small table are not laid out like a hashtable */                       \
+        if (!key_writer && !value_writer && !CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_map_))      \
+            flags |= CMC_SERIAL_LAYOUT;                                                            \
                                                                                                    \
-        PFX##_iter_init(iter, target);                                                             \
+        /* Everything is in one buffer once a pending migration is done */                         \
+        PFX##_impl_migrate(_map_, SIZE_MAX);                                                       \
                                                                                                    \
-        return iter;                                                                               \
-    }                                                                                              \
+        if (!cmc_serial_write_header(file, "hashmap", flags, sizeof(K), sizeof(V),                 \
+                                     sizeof(struct SNAME##_entry), _map_->count,                   \
+                                     _map_->capacity, _map_->load))                                \
+            return false;                                                                          \
                                                                                                    \
-    void PFX##_iter_free(struct SNAME##_iter *iter)                                                \
-    {                                                                                              \
-        free(iter);                                                                                \
-    }                                                                                              \
+        /* Without any writer the buffer is written as it is in memory */                          \
+        if (flags & CMC_SERIAL_LAYOUT)                                                             \
+        {                                                                                          \
+            if (fwrite(_map_->buffer, sizeof(struct SNAME##_entry), _map_->capacity, file) !=      \
+                _map_->capacity)                                                                   \
+                return false;                                                                      \
                                                                                                    \
-    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                          \
-    {                                                                                              \
-        memset(iter, 0, sizeof(struct SNAME##_iter));                                              \
+            /* Followed by the values of SOA tables */                                             \
+            CMC_IMPL_HASHMAP_##LAYOUT(return fwrite(_map_->values, sizeof(V), _map_->capacity,     \
+                                                    file) == _map_->capacity;)                     \
                                                                                                    \
-        iter->target = target;                                                                     \
-        iter->start = true;                                                                        \
-        iter->end = PFX##_empty(target);                                                           \
+            return true;                                                                           \
+        }                                                                                          \
                                                                                                    \
-        if (!PFX##_empty(target))                                                                  \
+        for (size_t i = PFX##_impl_next_filled(_map_, 0); i < _map_->capacity;                     \
+             i = PFX##_impl_next_filled(_map_, i + 1))                                             \
         {                                                                                          \
-            for (size_t i = 0; i < target->capacity; i++)                                          \
-            {                                                                                      \
-                if (target->buffer[i].state == CMC_ES_FILLED)                                      \
-                {                                                                                  \
-                    iter->first = i;                                                               \
-                    break;                                                                         \
-                }                                                                                  \
-            }                                                                                      \
+            struct SNAME##_entry *entry = &(_map_->buffer[i]);                                     \
                                                                                                    \
-            iter->cursor = iter->first;                                                            \
+            if (!CMC_SERIAL_WRITE(key_writer, entry->key, file) ||                                 \
+                !CMC_SERIAL_WRITE(value_writer, *PFX##_impl_value(_map_, entry), file))            \
+                return false;                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* A map saved without writers is loaded without hashing its keys so it */                     \
+    /* must be given the same hash function it was saved with. Otherwise */                        \
+    /* each reader is only used if the keys or values were saved with a writer */                  \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(K, K), size_t (*hash)(K),               \
+                                bool (*key_reader)(K *, FILE *),                                   \
+                                bool (*value_reader)(V *, FILE *))                                 \
+    {                                                                                              \
+        struct cmc_serial_header header;                                                           \
+                                                                                                   \
+        if (!cmc_serial_read_header(file, "hashmap", sizeof(K), sizeof(V), &header))               \
+            return NULL;                                                                           \
+                                                                                                   \
+        if (header.flags & CMC_SERIAL_LAYOUT)                                                      \
+            return PFX##_impl_load_layout(file, compare, hash, &header);                           \
+                                                                                                   \
+        /* Allocated for every key so that loading never grows */                                  \
+        struct SNAME *_map_ =                                                                      \
+            PFX##_new(header.count > 0 ? header.count : 1, header.load, compare, hash);            \
+                                                                                                   \
+        if (!_map_)                                                                                \
+            return NULL;                                                                           \
+                                                                                                   \
+        bool raw_keys = header.flags & CMC_SERIAL_RAW_KEYS;                                        \
+        bool raw_values = header.flags & CMC_SERIAL_RAW_VALUES;                                    \
                                                                                                    \
-            for (size_t i = target->capacity; i > 0; i--)                                          \
+        for (size_t i = 0; i < header.count; i++)                                                  \
+        {                                                                                          \
+            K key;                                                                                 \
+            V value;                                                                               \
+                                                                                                   \
+            if (!CMC_SERIAL_READ(raw_keys, key_reader, &key, file) ||                              \
+                !CMC_SERIAL_READ(raw_values, value_reader, &value, file) ||                        \
+                !PFX##_insert(_map_, key, value))                                                  \
             {                                                                                      \
-                if (target->buffer[i - 1].state == CMC_ES_FILLED)                                  \
-                {                                                                                  \
-                    iter->last = i - 1;                                                            \
-                    break;                                                                         \
-                }                                                                                  \
+                PFX##_free(_map_, NULL);                                                           \
+                return NULL;                                                                       \
             }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        return _map_;                                                                              \
+    }                                                                                              \
+                                                                                                   \
+                                                                                                   \
+    static size_t PFX##_impl_serialize_fill(void *serializer, unsigned char *out, size_t room)     \
+    {                                                                                              \
+        struct SNAME##_iter *iter = &((struct SNAME##_serializer *)serializer)->iter;              \
+        size_t written = 0;                                                                        \
+                                                                                                   \
+        while (!iter->end && room - written >= sizeof(K) + sizeof(V))                              \
+        {                                                                                          \
+            K key = PFX##_iter_key(iter);                                                          \
+            V value = PFX##_iter_value(iter);                                                      \
+                                                                                                   \
+            memcpy(out + written, &key, sizeof(K));                                                \
+            memcpy(out + written + sizeof(K), &value, sizeof(V));                                  \
+                                                                                                   \
+            written += sizeof(K) + sizeof(V);                                                      \
+                                                                                                   \
+            PFX##_iter_next(iter);                                                                 \
+        }                                                                                          \
+                                                                                                   \
+        return written;                                                                            \
+    }                                                                                              \
+                                                                                                   \
+    /* Each key and its value are written as they are in memory, in blocks */                      \
+    /* of up to block_size bytes, or CMC_SERIAL_BLOCK_SIZE if it is 0 */                           \
+    bool PFX##_serialize_begin(struct SNAME##_serializer *serializer, struct SNAME *_map_,         \
+                               size_t block_size, bool checksum)                                   \
+    {                                                                                              \
+        PFX##_iter_init(&serializer->iter, _map_);                                                 \
+                                                                                                   \
+        return cmc_serial_writer_begin(&serializer->writer, "hashmap", sizeof(K), sizeof(V), 0,    \
+                                       _map_->count, _map_->capacity, _map_->load, block_size,     \
+                                       checksum);                                                  \
+    }                                                                                              \
+                                                                                                   \
+    /* Copies up to size bytes of the stream to buffer and returns how many */                     \
+    /* were copied, 0 once all of them were */                                                     \
+    size_t PFX##_serialize_next(struct SNAME##_serializer *serializer, void *buffer, size_t size)  \
+    {                                                                                              \
+        return cmc_serial_writer_next(&serializer->writer, buffer, size,                           \
+                                      PFX##_impl_serialize_fill, serializer);                      \
+    }                                                                                              \
+                                                                                                   \
+    void PFX##_serialize_end(struct SNAME##_serializer *serializer)                                \
+    {                                                                                              \
+        cmc_serial_writer_end(&serializer->writer);                                                \
+    }                                                                                              \
+                                                                                                   \
+    static bool PFX##_impl_deserialize_header(void *deserializer,                                  \
+                                              struct cmc_serial_header *header)                    \
+    {                                                                                              \
+        struct SNAME##_deserializer *d = deserializer;                                             \
+        uint32_t raw = CMC_SERIAL_RAW_KEYS | CMC_SERIAL_RAW_VALUES;                                \
+                                                                                                   \
+        if (!cmc_serial_check_header("hashmap", sizeof(K), sizeof(V), header) ||                   \
+            (header->flags & raw) != raw)                                                          \
+            return false;                                                                          \
+                                                                                                   \
+        /* Allocated for every key so that loading never grows */                                  \
+        d->result = PFX##_new(header->count > 0 ? header->count : 1, header->load, d->compare,     \
+                              d->hash);                                                            \
+                                                                                                   \
+        return d->result != NULL;                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    static bool PFX##_impl_deserialize_consume(void *deserializer, const unsigned char *in,        \
+                                               size_t size)                                        \
+    {                                                                                              \
+        struct SNAME *_map_ = ((struct SNAME##_deserializer *)deserializer)->result;               \
+                                                                                                   \
+        if (size % (sizeof(K) + sizeof(V)) != 0)                                                   \
+            return false;                                                                          \
+                                                                                                   \
+        for (size_t i = 0; i < size; i += sizeof(K) + sizeof(V))                                   \
+        {                                                                                          \
+            K key;                                                                                 \
+            V value;                                                                               \
+                                                                                                   \
+            memcpy(&key, in + i, sizeof(K));                                                       \
+            memcpy(&value, in + i + sizeof(K), sizeof(V));                                         \
+                                                                                                   \
+            if (!PFX##_insert(_map_, key, value))                                                  \
+                return false;                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Blocks longer than block_size, or CMC_SERIAL_BLOCK_SIZE if it is 0, */                      \
+    /* are rejected */                                                                             \
+    bool PFX##_deserialize_begin(struct SNAME##_deserializer *deserializer,                        \
+                                 int (*compare)(K, K), size_t (*hash)(K), size_t block_size)       \
+    {                                                                                              \
+        deserializer->compare = compare;                                                           \
+        deserializer->hash = hash;                                                                 \
+        deserializer->result = NULL;                                                               \
+                                                                                                   \
+        return cmc_serial_reader_begin(&deserializer->reader, block_size);                         \
+    }                                                                                              \
+                                                                                                   \
+    /* Takes the next size bytes of the stream, returns false if they are */                       \
+    /* not valid, and so does every call after that */                                             \
+    bool PFX##_deserialize_next(struct SNAME##_deserializer *deserializer, const void *buffer,     \
+                                size_t size)                                                       \
+    {                                                                                              \
+        return cmc_serial_reader_next(&deserializer->reader, buffer, size,                         \
+                                      PFX##_impl_deserialize_header,                               \
+                                      PFX##_impl_deserialize_consume, deserializer);               \
+    }                                                                                              \
+                                                                                                   \
+    /* Returns the hashmap if the whole stream arrived, otherwise NULL */                          \
+    struct SNAME *PFX##_deserialize_end(struct SNAME##_deserializer *deserializer)                 \
+    {                                                                                              \
+        struct SNAME *_map_ = deserializer->result;                                                \
+                                                                                                   \
+        if (!cmc_serial_reader_end(&deserializer->reader) ||                                       \
+            (_map_ && _map_->count != deserializer->reader.header.count))                          \
+        {                                                                                          \
+            if (_map_)                                                                             \
+                PFX##_free(_map_, NULL);                                                           \
+                                                                                                   \
+            return NULL;                                                                           \
+        }                                                                                          \
+                                                                                                   \
+        return _map_;                                                                              \
+    }                                                                                              \
+                                                                                                   \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                      \
+    {                                                                                              \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));            \
+                                                                                                   \
+        if (CMC_UNLIKELY(!iter))                                                                   \
+            return NULL;                                                                           \
+                                                                                                   \
+        PFX##_iter_init(iter, target);                                                             \
+                                                                                                   \
+        return iter;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    void PFX##_iter_free(struct SNAME##_iter *iter)                                                \
+    {                                                                                              \
+        iter->target->alloc->free(iter);                                                           \
+    }                                                                                              \
+                                                                                                   \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                          \
+    {                                                                                              \
+        /* Iterators only go through the current buffer */                                         \
+        PFX##_impl_migrate(target, SIZE_MAX);                                                      \
+                                                                                                   \
+        memset(iter, 0, sizeof(struct SNAME##_iter));                                              \
+                                                                                                   \
+        iter->target = target;                                                                     \
+        iter->start = true;                                                                        \
+        iter->end = PFX##_empty(target);                                                           \
+                                                                                                   \
+        if (!PFX##_empty(target))                                                                  \
+        {                                                                                          \
+            iter->first = PFX##_impl_next_filled(target, 0);                                       \
+            iter->last = PFX##_impl_prev_filled(target, target->capacity - 1);                     \
+            iter->cursor = iter->first;                                                            \
         }                                                                                          \
     }                                                                                              \
                                                                                                    \
@@ -742,18 +2153,8 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
         iter->start = PFX##_empty(iter->target);                                                   \
                                                                                                    \
-        struct SNAME##_entry *scan = &(iter->target->buffer[iter->cursor]);                        \
-                                                                                                   \
         iter->index++;                                                                             \
-                                                                                                   \
-        while (1)                                                                                  \
-        {                                                                                          \
-            iter->cursor++;                                                                        \
-            scan = &(iter->target->buffer[iter->cursor]);                                          \
-                                                                                                   \
-            if (scan->state == CMC_ES_FILLED)                                                      \
-                break;                                                                             \
-        }                                                                                          \
+        iter->cursor = PFX##_impl_next_filled(iter->target, iter->cursor + 1);                     \
                                                                                                    \
         return true;                                                                               \
     }                                                                                              \
@@ -771,18 +2172,8 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
         iter->end = PFX##_empty(iter->target);                                                     \
                                                                                                    \
-        struct SNAME##_entry *scan = &(iter->target->buffer[iter->cursor]);                        \
-                                                                                                   \
         iter->index--;                                                                             \
-                                                                                                   \
-        while (1)                                                                                  \
-        {                                                                                          \
-            iter->cursor--;                                                                        \
-            scan = &(iter->target->buffer[iter->cursor]);                                          \
-                                                                                                   \
-            if (scan->state == CMC_ES_FILLED)                                                      \
-                break;                                                                             \
-        }                                                                                          \
+        iter->cursor = PFX##_impl_prev_filled(iter->target, iter->cursor - 1);                     \
                                                                                                    \
         return true;                                                                               \
     }                                                                                              \
@@ -843,6 +2234,18 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return true;                                                                               \
     }                                                                                              \
                                                                                                    \
+    /* Places iter at a slot, for CMC_PARALLEL_FOR_EACH, and tells if it is filled */              \
+    bool PFX##_parallel_iter(struct SNAME##_iter *iter, struct SNAME *target, size_t slot)         \
+    {                                                                                              \
+        memset(iter, 0, sizeof(struct SNAME##_iter));                                              \
+                                                                                                   \
+        iter->target = target;                                                                     \
+        iter->cursor = slot;                                                                       \
+        iter->index = slot;                                                                        \
+                                                                                                   \
+        return slot < target->capacity && target->buffer[slot].state == CMC_ES_FILLED;             \
+    }                                                                                              \
+                                                                                                   \
     K PFX##_iter_key(struct SNAME##_iter *iter)                                                    \
     {                                                                                              \
         if (PFX##_empty(iter->target))                                                             \
@@ -856,7 +2259,7 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         if (PFX##_empty(iter->target))                                                             \
             return (V){0};                                                                         \
                                                                                                    \
-        return iter->target->buffer[iter->cursor].value;                                           \
+        return *PFX##_impl_value(iter->target, &(iter->target->buffer[iter->cursor]));             \
     }                                                                                              \
                                                                                                    \
     V *PFX##_iter_rvalue(struct SNAME##_iter *iter)                                                \
@@ -864,7 +2267,7 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         if (PFX##_empty(iter->target))                                                             \
             return NULL;                                                                           \
                                                                                                    \
-        return &(iter->target->buffer[iter->cursor].value);                                        \
+        return PFX##_impl_value(iter->target, &(iter->target->buffer[iter->cursor]));              \
     }                                                                                              \
                                                                                                    \
     size_t PFX##_iter_index(struct SNAME##_iter *iter)                                             \
@@ -874,35 +2277,708 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
     static struct SNAME##_entry *PFX##_impl_get_entry(struct SNAME *_map_, K key)                  \
     {                                                                                              \
-        size_t hash = _map_->hash(key);                                                            \
-        size_t pos = hash % _map_->capacity;                                                       \
+        PFX##_impl_migrate(_map_, CMC_HASHMAP_MIGRATE_STEP);                                       \
+                                                                                                   \
+        if (CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_map_))                                       \
+            return PFX##_impl_small_get(_map_, key);                                               \
+                                                                                                   \
+        size_t hash = PFX##_impl_hash(_map_, key);                                                 \
+                                                                                                   \
+        struct SNAME##_entry *entry = PFX##_impl_get_entry_by_hash(_map_, key, hash);              \
+                                                                                                   \
+        /* The entry might still be in the previous buffer */                                      \
+        if (!entry && _map_->old)                                                                  \
+            entry = PFX##_impl_get_entry_by_hash(_map_->old, key, hash);                           \
+                                                                                                   \
+        return entry;                                                                              \
+    }                                                                                              \
+                                                                                                   \
+    static struct SNAME##_entry *PFX##_impl_get_entry_by_hash(struct SNAME *_map_, K key,          \
+                                                              size_t hash)                         \
+    {                                                                                              \
+        if (CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_map_))                                       \
+            return PFX##_impl_small_get(_map_, key);                                               \
+                                                                                                   \
+        size_t original_pos = PFX##_impl_home(_map_, hash);                                        \
+        size_t pos = original_pos;                                                                 \
                                                                                                    \
         struct SNAME##_entry *target = &(_map_->buffer[pos]);                                      \
                                                                                                    \
-        while (target->state == CMC_ES_FILLED || target->state == CMC_ES_DELETED)                  \
+        CMC_IMPL_HASHTABLE_PROBE_LOOKUP(_map_);                                                    \
+                                                                                                   \
+        /* There are no tombstones so the search stops at the first empty */                       \
+        /* entry or at the first entry closer to its original position */                          \
+        while (target->state == CMC_ES_FILLED && target->dist >= pos - original_pos)               \
         {                                                                                          \
-            if (_map_->cmp(target->key, key) == 0)                                                 \
+            CMC_IMPL_HASHTABLE_PROBE_SLOT(_map_);                                                  \
+                                                                                                   \
+            /* CACHED tables skip the comparison when the hashes differ */                         \
+            if (CMC_IMPL_HASHTABLE_##HASHING##_EQUALS(target->hash, hash) &&                       \
+                PFX##_impl_cmp(_map_, target->key, key) == 0)                                      \
                 return target;                                                                     \
                                                                                                    \
             pos++;                                                                                 \
-            target = &(_map_->buffer[pos % _map_->capacity]);                                      \
+            target = &(_map_->buffer[PFX##_impl_wrap(_map_, pos)]);                                \
         }                                                                                          \
                                                                                                    \
         return NULL;                                                                               \
     }                                                                                              \
                                                                                                    \
-    static size_t PFX##_impl_calculate_size(size_t required)                                       \
+    /* Looks up at most CMC_IMPL_HASHTABLE_BATCH keys. Every hash is computed */                   \
+    /* and every home slot is prefetched before the first probe so that */                         \
+    /* the cache misses of independent keys overlap */                                             \
+    static void PFX##_impl_get_batch(struct SNAME *_map_, K *keys, size_t n,                       \
+                                     struct SNAME##_entry **entries)                               \
+    {                                                                                              \
+        size_t hashes[CMC_IMPL_HASHTABLE_BATCH];                                                   \
+                                                                                                   \
+        if (CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_map_))                                       \
+        {                                                                                          \
+            for (size_t i = 0; i < n; i++)                                                         \
+                entries[i] = PFX##_impl_small_get(_map_, keys[i]);                                 \
+                                                                                                   \
+            return;                                                                                \
+        }                                                                                          \
+                                                                                                   \
+        for (size_t i = 0; i < n; i++)                                                             \
+        {                                                                                          \
+            hashes[i] = PFX##_impl_hash(_map_, keys[i]);                                           \
+                                                                                                   \
+            CMC_IMPL_HASHTABLE_PREFETCH(&(_map_->buffer[PFX##_impl_home(_map_, hashes[i])]));      \
+        }                                                                                          \
+                                                                                                   \
+        for (size_t i = 0; i < n; i++)                                                             \
+        {                                                                                          \
+            entries[i] = PFX##_impl_get_entry_by_hash(_map_, keys[i], hashes[i]);                  \
+                                                                                                   \
+            if (!entries[i] && _map_->old)                                                         \
+                entries[i] = PFX##_impl_get_entry_by_hash(_map_->old, keys[i], hashes[i]);         \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    /* Places a key in the map and returns the entry where it ended up. When */                    \
+    /* found is not NULL the key is also searched for in the same probe and, */                    \
+    /* if it is already there, its entry is stored in found and NULL is */                         \
+    /* returned. The count is updated by the caller */                                             \
+    static struct SNAME##_entry *PFX##_impl_insert_entry(struct SNAME *_map_, K key, V value,      \
+                                                         size_t hash,                              \
+                                                         struct SNAME##_entry **found)             \
+    {                                                                                              \
+        if (CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_map_))                                       \
+            return PFX##_impl_small_insert(_map_, key, value, found);                              \
+                                                                                                   \
+        size_t original_pos = PFX##_impl_home(_map_, hash);                                        \
+        size_t pos = original_pos;                                                                 \
+                                                                                                   \
+        struct SNAME##_entry *target = &(_map_->buffer[pos]);                                      \
+        struct SNAME##_entry *result = NULL;                                                       \
+                                                                                                   \
+        while (target->state == CMC_ES_FILLED)                                                     \
+        {                                                                                          \
+            if (target->dist < pos - original_pos)                                                 \
+            {                                                                                      \
+                V *target_v = &CMC_IMPL_HASHMAP_##LAYOUT##_VALUE(_map_, target);                   \
+                                                                                                   \
+                K tmp_k = target->key;                                                             \
+                V tmp_v = *target_v;                                                               \
+                size_t tmp_dist = target->dist;                                                    \
+                CMC_IMPL_HASHTABLE_##HASHING(size_t tmp_h = target->hash;)                         \
+                                                                                                   \
+                target->key = key;                                                                 \
+                *target_v = value;                                                                 \
+                target->dist = pos - original_pos;                                                 \
+                CMC_IMPL_HASHTABLE_##HASHING(target->hash = hash;)                                 \
+                                                                                                   \
+                key = tmp_k;                                                                       \
+                value = tmp_v;                                                                     \
+                original_pos = pos - tmp_dist;                                                     \
+                CMC_IMPL_HASHTABLE_##HASHING(hash = tmp_h;)                                        \
+                                                                                                   \
+                if (!result)                                                                       \
+                    result = target;                                                               \
+            }                                                                                      \
+            /* Until the first swap this is the same walk as get_entry_by_hash */                  \
+            else if (found && !result &&                                                           \
+                     CMC_IMPL_HASHTABLE_##HASHING##_EQUALS(target->hash, hash) &&                  \
+                     PFX##_impl_cmp(_map_, target->key, key) == 0)                                 \
+            {                                                                                      \
+                *found = target;                                                                   \
+                return NULL;                                                                       \
+            }                                                                                      \
+                                                                                                   \
+            pos++;                                                                                 \
+            target = &(_map_->buffer[PFX##_impl_wrap(_map_, pos)]);                                \
+        }                                                                                          \
+                                                                                                   \
+        target->key = key;                                                                         \
+        CMC_IMPL_HASHMAP_##LAYOUT##_VALUE(_map_, target) = value;                                  \
+        target->dist = pos - original_pos;                                                         \
+        target->state = CMC_ES_FILLED;                                                             \
+        CMC_IMPL_HASHTABLE_##HASHING(target->hash = hash;)                                         \
+                                                                                                   \
+        CMC_IMPL_HASHTABLE_OCCUPY(_map_, (size_t)(target - _map_->buffer));                        \
+                                                                                                   \
+        return result ? result : target;                                                           \
+    }                                                                                              \
+                                                                                                   \
+    /* The keys of a small table are together at the start of its entries */                       \
+    static struct SNAME##_entry *PFX##_impl_small_get(struct SNAME *_map_, K key)                  \
+    {                                                                                              \
+        CMC_IMPL_HASHTABLE_PROBE_LOOKUP(_map_);                                                    \
+                                                                                                   \
+        for (size_t i = 0; i < _map_->capacity && _map_->buffer[i].state == CMC_ES_FILLED; i++)    \
+        {                                                                                          \
+            CMC_IMPL_HASHTABLE_PROBE_SLOT(_map_);                                                  \
+                                                                                                   \
+            if (PFX##_impl_cmp(_map_, _map_->buffer[i].key, key) == 0)                             \
+                return &(_map_->buffer[i]);                                                        \
+        }                                                                                          \
+                                                                                                   \
+        return NULL;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Same as insert_entry for small tables, which full() makes sure have */                      \
+    /* room for one more key */                                                                    \
+    static struct SNAME##_entry *PFX##_impl_small_insert(struct SNAME *_map_, K key, V value,      \
+                                                         struct SNAME##_entry **found)             \
+    {                                                                                              \
+        size_t pos = 0;                                                                            \
+                                                                                                   \
+        for (; pos < _map_->capacity && _map_->buffer[pos].state == CMC_ES_FILLED; pos++)          \
+        {                                                                                          \
+            if (found && PFX##_impl_cmp(_map_, _map_->buffer[pos].key, key) == 0)                  \
+            {                                                                                      \
+                *found = &(_map_->buffer[pos]);                                                    \
+                return NULL;                                                                       \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        struct SNAME##_entry *target = &(_map_->buffer[pos]);                                      \
+                                                                                                   \
+        target->key = key;                                                                         \
+        CMC_IMPL_HASHMAP_##LAYOUT##_VALUE(_map_, target) = value;                                  \
+        target->dist = 0;                                                                          \
+        target->state = CMC_ES_FILLED;                                                             \
+                                                                                                   \
+        /* CACHED tables still need it once they grow */                                           \
+        CMC_IMPL_HASHTABLE_##HASHING(target->hash = PFX##_impl_hash(_map_, key);)                  \
+                                                                                                   \
+        return target;                                                                             \
+    }                                                                                              \
+                                                                                                   \
+    /* Moves back the keys that follow the removed one */                                          \
+    static void PFX##_impl_small_remove(struct SNAME *_map_, struct SNAME##_entry *entry)          \
+    {                                                                                              \
+        size_t pos = (size_t)(entry - _map_->buffer);                                              \
+        size_t end = pos + 1;                                                                      \
+                                                                                                   \
+        while (end < _map_->capacity && _map_->buffer[end].state == CMC_ES_FILLED)                 \
+            end++;                                                                                 \
+                                                                                                   \
+        memmove(entry, entry + 1, sizeof(struct SNAME##_entry) * (end - pos - 1));                 \
+                                                                                                   \
+        memset(&(_map_->buffer[end - 1]), 0, sizeof(struct SNAME##_entry));                        \
+                                                                                                   \
+        CMC_IMPL_HASHMAP_##LAYOUT(memmove(&(_map_->values[pos]), &(_map_->values[pos + 1]),        \
+                                          sizeof(V) * (end - pos - 1));                            \
+                                  _map_->values[end - 1] = (V){0};)                                \
+    }                                                                                              \
+                                                                                                   \
+    /* Moves the keys of a table with at most CMC_HASHTABLE_SMALL_SIZE of */                       \
+    /* them to the entries of its struct */                                                        \
+    static void PFX##_impl_to_small(struct SNAME *_map_)                                           \
+    {                                                                                              \
+        struct SNAME##_entry *buffer = _map_->buffer;                                              \
+        size_t capacity = _map_->capacity;                                                         \
+        size_t count = 0;                                                                          \
+                                                                                                   \
+        _map_->buffer = CMC_IMPL_HASHTABLE_##STORAGE##_BUFFER(_map_);                              \
+        _map_->capacity = CMC_IMPL_HASHTABLE_##STORAGE##_SIZE;                                     \
+        _map_->fastmod = cmc_fastmod_new(_map_->capacity);                                         \
+                                                                                                   \
+        memset(_map_->buffer, 0, sizeof(struct SNAME##_entry) * _map_->capacity);                  \
+                                                                                                   \
+        for (size_t i = 0; i < capacity; i++)                                                      \
+        {                                                                                          \
+            if (buffer[i].state != CMC_ES_FILLED)                                                  \
+                continue;                                                                          \
+                                                                                                   \
+            _map_->buffer[count] = buffer[i];                                                      \
+            _map_->buffer[count].dist = 0;                                                         \
+                                                                                                   \
+            /* Moved towards the start of the same array, which keeps its size */                  \
+            CMC_IMPL_HASHMAP_##LAYOUT(_map_->values[count] = _map_->values[i];)                    \
+                                                                                                   \
+            count++;                                                                               \
+        }                                                                                          \
+                                                                                                   \
+        _map_->alloc->free(buffer);                                                                \
+                                                                                                   \
+        CMC_IMPL_HASHTABLE_OCCUPANCY_FREE(_map_);                                                  \
+        CMC_IMPL_HASHTABLE_OCCUPANCY_NONE(_map_);                                                  \
+    }                                                                                              \
+                                                                                                   \
+    /* The buffer of a small table is part of the struct */                                        \
+    static void PFX##_impl_free_buffer(struct SNAME *_map_)                                        \
+    {                                                                                              \
+        if (!CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_map_))                                      \
+            _map_->alloc->free(_map_->buffer);                                                     \
+                                                                                                   \
+        CMC_IMPL_HASHMAP_##LAYOUT(_map_->alloc->free(_map_->values); _map_->values = NULL;)        \
+    }                                                                                              \
+                                                                                                   \
+    /* Allocates the values of a SOA table for its capacity */                                     \
+    static bool PFX##_impl_values_new(struct SNAME *_map_)                                         \
+    {                                                                                              \
+        (void)_map_;                                                                               \
+        CMC_IMPL_HASHMAP_##LAYOUT(                                                                 \
+            _map_->values = _map_->alloc->calloc(_map_->capacity, sizeof(V));                      \
+            return _map_->values != NULL;)                                                         \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* The value of an entry of the map or of its previous buffer */                               \
+    static inline V *PFX##_impl_value(struct SNAME *_map_, struct SNAME##_entry *entry)            \
+    {                                                                                              \
+        (void)_map_;                                                                               \
+        CMC_IMPL_HASHMAP_##LAYOUT(                                                                 \
+            struct SNAME *old = _map_->old;                                                        \
+                                                                                                   \
+            if (old && (uintptr_t)entry - (uintptr_t)old->buffer <                                 \
+                           sizeof(struct SNAME##_entry) * old->capacity)                           \
+                _map_ = old;)                                                                      \
+                                                                                                   \
+        return &CMC_IMPL_HASHMAP_##LAYOUT##_VALUE(_map_, entry);                                   \
+    }                                                                                              \
+                                                                                                   \
+                                                                                                   \
+    static bool PFX##_impl_dist_overflow(struct SNAME *_map_, size_t hash)                         \
+    {                                                                                              \
+        size_t pos = PFX##_impl_home(_map_, hash);                                                 \
+        size_t dist = 0;                                                                           \
+                                                                                                   \
+        struct SNAME##_entry *target = &(_map_->buffer[pos]);                                      \
+                                                                                                   \
+        /* Follows the steps of an insertion without moving any entry */                           \
+        while (target->state == CMC_ES_FILLED)                                                     \
+        {                                                                                          \
+            /* The entry closer to its original position is the one carried */                     \
+            if (target->dist < dist)                                                               \
+                dist = target->dist;                                                               \
+                                                                                                   \
+            pos++;                                                                                 \
+            dist++;                                                                                \
+                                                                                                   \
+            if (dist > CMC_ES_DIST_MAX)                                                            \
+                return true;                                                                       \
+                                                                                                   \
+            target = &(_map_->buffer[PFX##_impl_wrap(_map_, pos)]);                                \
+        }                                                                                          \
+                                                                                                   \
+        return false;                                                                              \
+    }                                                                                              \
+                                                                                                   \
+    /* Called when the map is full. INCREMENTAL maps only allocate the new */                      \
+    /* buffer here and move the entries over the following operations */                           \
+    static bool PFX##_impl_grow(struct SNAME *_map_, size_t capacity)                              \
+    {                                                                                              \
+        /* Only one previous buffer is kept at a time */                                           \
+        PFX##_impl_migrate(_map_, SIZE_MAX);                                                       \
+                                                                                                   \
+        /* Prevent integer overflow */                                                             \
+        if (capacity >= UINTMAX_MAX * PFX##_load(_map_))                                           \
+            return false;                                                                          \
+                                                                                                   \
+        size_t real_capacity = PFX##_impl_calculate_size(capacity / PFX##_load(_map_));            \
+                                                                                                   \
+        /* The distance of an entry always fits in tables of up to */                              \
+        /* CMC_ES_DIST_MAX slots so only these can be migrated slot by slot. */                    \
+        /* The few keys of a small table are moved at once */                                      \
+        if (!CMC_IMPL_HASHMAP_##GROWTH##_GROWTH || real_capacity > CMC_ES_DIST_MAX ||              \
+            CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_map_))                                       \
+            return PFX##_resize(_map_, capacity);                                                  \
+                                                                                                   \
+        struct SNAME *old = _map_->alloc->malloc(sizeof(struct SNAME));                            \
+                                                                                                   \
+        if (CMC_UNLIKELY(!old))                                                                    \
+            return false;                                                                          \
+                                                                                                   \
+        struct SNAME##_entry *buffer = _map_->alloc->calloc(real_capacity,                         \
+                                                            sizeof(struct SNAME##_entry));         \
+                                                                                                   \
+        if (CMC_UNLIKELY(!buffer))                                                                 \
+        {                                                                                          \
+            _map_->alloc->free(old);                                                               \
+            return false;                                                                          \
+        }                                                                                          \
+                                                                                                   \
+        *old = *_map_;                                                                             \
+        old->old = NULL;                                                                           \
+                                                                                                   \
+        _map_->buffer = buffer;                                                                    \
+        _map_->capacity = real_capacity;                                                           \
+        _map_->fastmod = cmc_fastmod_new(_map_->capacity);                                         \
+                                                                                                   \
+        if (!PFX##_impl_values_new(_map_))                                                         \
+        {                                                                                          \
+            *_map_ = *old;                                                                         \
+                                                                                                   \
+            _map_->alloc->free(buffer);                                                            \
+            _map_->alloc->free(old);                                                               \
+            return false;                                                                          \
+        }                                                                                          \
+                                                                                                   \
+        CMC_IMPL_HASHTABLE_PROBE_RESET(old);                                                       \
+                                                                                                   \
+        _map_->old = old;                                                                          \
+        _map_->migrated = 0;                                                                       \
+                                                                                                   \
+        /* The previous bitmap stays with the previous buffer */                                   \
+        CMC_IMPL_HASHTABLE_OCCUPANCY_NEW(_map_);                                                   \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Moves the entries of the previous buffer to the current one, going */                       \
+    /* through at most steps slots. The previous buffer is freed once all */                       \
+    /* of it has been visited */                                                                   \
+    static void PFX##_impl_migrate(struct SNAME *_map_, size_t steps)                              \
+    {                                                                                              \
+        struct SNAME *old = _map_->old;                                                            \
+                                                                                                   \
+        if (!old)                                                                                  \
+            return;                                                                                \
+                                                                                                   \
+        /* Every slot before migrated is empty. Removing an entry shifts */                        \
+        /* the ones that follow it back so the same slot is visited again */                       \
+        for (; steps > 0 && _map_->migrated < old->capacity; steps--)                              \
+        {                                                                                          \
+            struct SNAME##_entry *entry = &(old->buffer[_map_->migrated]);                         \
+                                                                                                   \
+            if (entry->state != CMC_ES_FILLED)                                                     \
+            {                                                                                      \
+                _map_->migrated++;                                                                 \
+                continue;                                                                          \
+            }                                                                                      \
+                                                                                                   \
+            size_t hash =                                                                          \
+                CMC_IMPL_HASHTABLE_##HASHING##_REHASH(entry->hash,                                 \
+                                                      PFX##_impl_hash(_map_, entry->key));         \
+                                                                                                   \
+            V value = *PFX##_impl_value(old, entry);                                               \
+                                                                                                   \
+            PFX##_impl_insert_entry(_map_, entry->key, value, hash, NULL);                         \
+            PFX##_impl_remove_entry(old, entry);                                                   \
+        }                                                                                          \
+                                                                                                   \
+        if (_map_->migrated == old->capacity)                                                      \
+        {                                                                                          \
+            /* Keep the lookups that went through the previous buffer */                           \
+            CMC_IMPL_HASHTABLE_PROBE_ADD(_map_, old);                                              \
+                                                                                                   \
+            CMC_IMPL_HASHTABLE_OCCUPANCY_FREE(old);                                                \
+                                                                                                   \
+            PFX##_impl_free_buffer(old);                                                           \
+            _map_->alloc->free(old);                                                               \
+                                                                                                   \
+            _map_->old = NULL;                                                                     \
+            _map_->migrated = 0;                                                                   \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    /* Sums the fingerprint of a table without a previous buffer in the same */                    \
+    /* way as it would have been kept */                                                           \
+    static size_t PFX##_impl_fingerprint(struct SNAME *_map_)                                      \
+    {                                                                                              \
+        size_t sum = 0;                                                                            \
+                                                                                                   \
+        for (size_t i = PFX##_impl_next_filled(_map_, 0); i < _map_->capacity;                     \
+             i = PFX##_impl_next_filled(_map_, i + 1))                                             \
+        {                                                                                          \
+            sum += cmc_hashtable_mix(PFX##_impl_hash(_map_, _map_->buffer[i].key));                \
+        }                                                                                          \
+                                                                                                   \
+        return sum;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    static void PFX##_impl_remove_entry(struct SNAME *_map_, struct SNAME##_entry *entry)          \
+    {                                                                                              \
+        if (CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_map_))                                       \
+        {                                                                                          \
+            PFX##_impl_small_remove(_map_, entry);                                                 \
+            return;                                                                                \
+        }                                                                                          \
+                                                                                                   \
+        size_t pos = (size_t)(entry - _map_->buffer);                                              \
+                                                                                                   \
+        /* Backward shift deletion. Every entry that follows and is not at its */                  \
+        /* original position is moved one position back */                                         \
+        while (true)                                                                               \
+        {                                                                                          \
+            struct SNAME##_entry *next = &(_map_->buffer[PFX##_impl_wrap(_map_, pos + 1)]);        \
+                                                                                                   \
+            if (next->state != CMC_ES_FILLED || next->dist == 0)                                   \
+                break;                                                                             \
+                                                                                                   \
+            *entry = *next;                                                                        \
+            entry->dist--;                                                                         \
+                                                                                                   \
+            CMC_IMPL_HASHMAP_##LAYOUT##_VALUE(_map_, entry) =                                      \
+                CMC_IMPL_HASHMAP_##LAYOUT##_VALUE(_map_, next);                                    \
+                                                                                                   \
+            entry = next;                                                                          \
+            pos++;                                                                                 \
+        }                                                                                          \
+                                                                                                   \
+        entry->key = (K){0};                                                                       \
+        CMC_IMPL_HASHMAP_##LAYOUT##_VALUE(_map_, entry) = (V){0};                                  \
+        entry->dist = 0;                                                                           \
+        entry->state = CMC_ES_EMPTY;                                                               \
+        CMC_IMPL_HASHTABLE_##HASHING(entry->hash = 0;)                                             \
+                                                                                                   \
+        CMC_IMPL_HASHTABLE_VACATE(_map_, (size_t)(entry - _map_->buffer));                         \
+    }                                                                                              \
+                                                                                                   \
+    /* Moves every entry to a new buffer sized for capacity entries */                             \
+    static bool PFX##_impl_rehash(struct SNAME *_map_, size_t capacity)                            \
+    {                                                                                              \
+        if (!CMC_IMPL_HASHMAP_##GROWTH##_REHASH)                                                   \
+            return false;                                                                          \
+                                                                                                   \
+        /* Keys that fit in the entries of the struct are moved there */                           \
+        if (capacity <= CMC_IMPL_HASHTABLE_##STORAGE##_SIZE)                                       \
+        {                                                                                          \
+            if (_map_->count <= CMC_IMPL_HASHTABLE_##STORAGE##_SIZE)                               \
+            {                                                                                      \
+                if (!CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_map_))                              \
+                    PFX##_impl_to_small(_map_);                                                    \
+                                                                                                   \
+                return true;                                                                       \
+            }                                                                                      \
+                                                                                                   \
+            capacity = _map_->count;                                                               \
+        }                                                                                          \
+                                                                                                   \
+        struct SNAME *_new_map_ = PFX##_new_custom(capacity, PFX##_load(_map_), _map_->cmp,        \
+                                                   _map_->hash, _map_->alloc);                     \
+                                                                                                   \
+        if (CMC_UNLIKELY(!_new_map_))                                                              \
+            return false;                                                                          \
+                                                                                                   \
+        for (size_t i = PFX##_impl_next_filled(_map_, 0); i < _map_->capacity;                     \
+             i = PFX##_impl_next_filled(_map_, i + 1))                                             \
+        {                                                                                          \
+            struct SNAME##_entry *entry = &(_map_->buffer[i]);                                     \
+                                                                                                   \
+            /* CACHED tables reuse the stored hash instead of calling hash() */                    \
+            size_t hash =                                                                          \
+                CMC_IMPL_HASHTABLE_##HASHING##_REHASH(entry->hash,                                 \
+                                                      PFX##_impl_hash(_map_, entry->key));         \
+                                                                                                   \
+            if (PFX##_capacity(_new_map_) > CMC_ES_DIST_MAX &&                                     \
+                PFX##_impl_dist_overflow(_new_map_, hash))                                         \
+            {                                                                                      \
+                PFX##_free(_new_map_, NULL);                                                       \
+                return false;                                                                      \
+            }                                                                                      \
+                                                                                                   \
+            V value = *PFX##_impl_value(_map_, entry);                                             \
+                                                                                                   \
+            PFX##_impl_insert_entry(_new_map_, entry->key, value, hash, NULL);                     \
+        }                                                                                          \
+                                                                                                   \
+        struct SNAME##_entry *tmp_b = _map_->buffer;                                               \
+        _map_->buffer = _new_map_->buffer;                                                         \
+        _new_map_->buffer = tmp_b;                                                                 \
+                                                                                                   \
+        CMC_IMPL_HASHMAP_##LAYOUT(V *tmp_v = _map_->values; _map_->values = _new_map_->values;     \
+                                  _new_map_->values = tmp_v;)                                      \
+                                                                                                   \
+        /* The entries of a small table can't be given away so they are left */                    \
+        /* to be freed with the struct */                                                          \
+        if (tmp_b == CMC_IMPL_HASHTABLE_##STORAGE##_BUFFER(_map_))                                 \
+            _new_map_->buffer = CMC_IMPL_HASHTABLE_##STORAGE##_BUFFER(_new_map_);                  \
+                                                                                                   \
+        size_t tmp_c = _map_->capacity;                                                            \
+        _map_->capacity = _new_map_->capacity;                                                     \
+        _new_map_->capacity = tmp_c;                                                               \
+        _map_->fastmod = cmc_fastmod_new(_map_->capacity);                                         \
+        _new_map_->fastmod = cmc_fastmod_new(_new_map_->capacity);                                 \
+                                                                                                   \
+        CMC_IMPL_HASHTABLE_OCCUPANCY_SWAP(_map_, _new_map_);                                       \
+                                                                                                   \
+        PFX##_free(_new_map_, NULL);                                                               \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Called after removals, shrinks the table once it is mostly empty */                         \
+    static void PFX##_impl_low_water(struct SNAME *_map_)                                          \
+    {                                                                                              \
+        double low_water = cmc_hashtable_low_water(_map_->load);                                   \
+                                                                                                   \
+        /* Left with room for as many again so it is not grown right back. */                      \
+        /* This also keeps a SMALL table from moving its keys back into the */                     \
+        /* struct until half of CMC_HASHTABLE_SMALL_SIZE of them are left, */                      \
+        /* so one key more or less around that size doesn't allocate again */                      \
+        if ((double)_map_->count < (double)_map_->capacity * _map_->load * low_water)              \
+            PFX##_impl_shrink(_map_, _map_->count * 2);                                            \
+    }                                                                                              \
+                                                                                                   \
+    /* Rebuilds the table at the smallest size that holds required entries */                      \
+    static bool PFX##_impl_shrink(struct SNAME *_map_, size_t required)                            \
+    {                                                                                              \
+        PFX##_impl_migrate(_map_, SIZE_MAX);                                                       \
+                                                                                                   \
+        size_t capacity = required > 0 ? required : 1;                                             \
+                                                                                                   \
+        if (CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_map_))                                       \
+            return true;                                                                           \
+                                                                                                   \
+        /* Already as small as the sizing policy allows, unless the keys fit */                    \
+        /* in the entries of the struct */                                                         \
+        if (capacity > CMC_IMPL_HASHTABLE_##STORAGE##_SIZE &&                                      \
+            PFX##_impl_calculate_size(capacity / PFX##_load(_map_)) >= PFX##_capacity(_map_))      \
+            return true;                                                                           \
+                                                                                                   \
+        return PFX##_impl_rehash(_map_, capacity);                                                 \
+    }                                                                                              \
+                                                                                                   \
+    static struct SNAME *PFX##_impl_load_layout(FILE *file, int (*compare)(K, K),                  \
+                                                size_t (*hash)(K),                                 \
+                                                struct cmc_serial_header *header)                  \
+    {                                                                                              \
+        size_t capacity = header->capacity;                                                        \
+                                                                                                   \
+        /* The buffer is only valid for a table of the same sizing and entry */                    \
+        if (header->extra != sizeof(struct SNAME##_entry) || capacity == 0 ||                      \
+            PFX##_impl_calculate_size(capacity) != capacity || header->count > capacity ||         \
+            capacity > SIZE_MAX / sizeof(struct SNAME##_entry))                                    \
+            return NULL;                                                                           \
+                                                                                                   \
+        struct SNAME *_map_ = PFX##_new(1, header->load, compare, hash);                           \
+                                                                                                   \
+        if (CMC_UNLIKELY(!_map_))                                                                  \
+            return NULL;                                                                           \
+                                                                                                   \
+        struct SNAME##_entry *buffer =                                                             \
+            _map_->alloc->malloc(capacity * sizeof(struct SNAME##_entry));                         \
+                                                                                                   \
+        if (!buffer || fread(buffer, sizeof(struct SNAME##_entry), capacity, file) != capacity)    \
+        {                                                                                          \
+            _map_->alloc->free(buffer);                                                            \
+            PFX##_free(_map_, NULL);                                                               \
+            return NULL;                                                                           \
+        }                                                                                          \
+                                                                                                   \
+        PFX##_impl_free_buffer(_map_);                                                             \
+                                                                                                   \
+        _map_->buffer = buffer;                                                                    \
+        _map_->capacity = capacity;                                                                \
+        _map_->fastmod = cmc_fastmod_new(_map_->capacity);                                         \
+                                                                                                   \
+        /* SOA tables also read their values */                                                    \
+        if (!PFX##_impl_values_new(_map_))                                                         \
+        {                                                                                          \
+            PFX##_free(_map_, NULL);                                                               \
+            return NULL;                                                                           \
+        }                                                                                          \
+                                                                                                   \
+        CMC_IMPL_HASHMAP_##LAYOUT(                                                                 \
+            if (fread(_map_->values, sizeof(V), capacity, file) != capacity)                       \
+            {                                                                                      \
+                PFX##_free(_map_, NULL);                                                           \
+                return NULL;                                                                       \
+            })                                                                                     \
+                                                                                                   \
+        for (size_t i = 0; i < capacity; i++)                                                      \
+        {                                                                                          \
+            if (buffer[i].state != CMC_ES_FILLED)                                                  \
+                continue;                                                                          \
+                                                                                                   \
+            _map_->count++;                                                                        \
+                                                                                                   \
+            CMC_IMPL_HASHTABLE_FINGERPRINTED(_map_->fingerprint += cmc_hashtable_mix(              \
+                PFX##_impl_hash(_map_, buffer[i].key));)                                           \
+        }                                                                                          \
+                                                                                                   \
+        CMC_IMPL_HASHTABLE_OCCUPANCY_FREE(_map_);                                                  \
+        CMC_IMPL_HASHTABLE_OCCUPANCY_NEW(_map_);                                                   \
+                                                                                                   \
+        PFX##_impl_occupancy_fill(_map_);                                                          \
+                                                                                                   \
+        /* Entries are trusted as they are but their amount is counted */                          \
+        if (_map_->count != header->count)                                                         \
+        {                                                                                          \
+            PFX##_free(_map_, NULL);                                                               \
+            return NULL;                                                                           \
+        }                                                                                          \
+                                                                                                   \
+        return _map_;                                                                              \
+    }                                                                                              \
+                                                                                                   \
+                                                                                                   \
+    /* First filled slot at or after from, or the capacity if there is none */                     \
+    static size_t PFX##_impl_next_filled(struct SNAME *_map_, size_t from)                         \
+    {                                                                                              \
+        uint64_t *bits = CMC_IMPL_HASHTABLE_OCCUPIED(_map_);                                       \
+                                                                                                   \
+        if (bits)                                                                                  \
+            return cmc_occupancy_next(bits, _map_->capacity, from);                                \
+                                                                                                   \
+        while (from < _map_->capacity && _map_->buffer[from].state != CMC_ES_FILLED)               \
+            from++;                                                                                \
+                                                                                                   \
+        return from;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Last filled slot at or before from, or SIZE_MAX if there is none */                         \
+    static size_t PFX##_impl_prev_filled(struct SNAME *_map_, size_t from)                         \
+    {                                                                                              \
+        uint64_t *bits = CMC_IMPL_HASHTABLE_OCCUPIED(_map_);                                       \
+                                                                                                   \
+        if (bits)                                                                                  \
+            return cmc_occupancy_prev(bits, from);                                                 \
+                                                                                                   \
+        for (size_t i = from + 1; i > 0; i--)                                                      \
+        {                                                                                          \
+            if (_map_->buffer[i - 1].state == CMC_ES_FILLED)                                       \
+                return i - 1;                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        return SIZE_MAX;                                                                           \
+    }                                                                                              \
+                                                                                                   \
+    /* Sets the bits of the filled slots of a buffer that was not filled by */                     \
+    /* inserting its entries one by one. The bitmap must be empty */                               \
+    static void PFX##_impl_occupancy_fill(struct SNAME *_map_)                                     \
     {                                                                                              \
-        const size_t count = sizeof(cmc_hashtable_primes) / sizeof(cmc_hashtable_primes[0]);       \
+        uint64_t *bits = CMC_IMPL_HASHTABLE_OCCUPIED(_map_);                                       \
+                                                                                                   \
+        if (!bits)                                                                                 \
+            return;                                                                                \
+                                                                                                   \
+        for (size_t i = 0; i < _map_->capacity; i++)                                               \
+        {                                                                                          \
+            if (_map_->buffer[i].state == CMC_ES_FILLED)                                           \
+                cmc_occupancy_set(bits, i);                                                        \
+        }                                                                                          \
+    }                                                                                              \
                                                                                                    \
-        if (cmc_hashtable_primes[count - 1] < required)                                            \
-            return required;                                                                       \
+    static size_t PFX##_impl_calculate_size(size_t required)                                       \
+    {                                                                                              \
+        return CMC_IMPL_HASHTABLE_##SIZING##_SIZE(required);                                       \
+    }                                                                                              \
                                                                                                    \
-        size_t i = 0;                                                                              \
-        while (cmc_hashtable_primes[i] < required)                                                 \
-            i++;                                                                                   \
+    static inline size_t PFX##_impl_home(struct SNAME *_map_, size_t hash)                         \
+    {                                                                                              \
+        return CMC_IMPL_HASHTABLE_##SIZING##_TABLE_HOME(hash, _map_);                              \
+    }                                                                                              \
                                                                                                    \
-        return cmc_hashtable_primes[i];                                                            \
+    static inline size_t PFX##_impl_wrap(struct SNAME *_map_, size_t pos)                          \
+    {                                                                                              \
+        return CMC_IMPL_HASHTABLE_##SIZING##_TABLE_WRAP(pos, _map_);                               \
     }                                                                                              \
                                                                                                    \
     static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_map_)                            \
@@ -922,6 +2998,20 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         PFX##_iter_to_end(&iter);                                                                  \
                                                                                                    \
         return iter;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    static inline int PFX##_impl_cmp(struct SNAME *_map_, K a, K b)                                \
+    {                                                                                              \
+        (void)_map_;                                                                               \
+                                                                                                   \
+        return CMP(a, b);                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static inline size_t PFX##_impl_hash(struct SNAME *_map_, K key)                               \
+    {                                                                                              \
+        (void)_map_;                                                                               \
+                                                                                                   \
+        return HASH(key);                                                                          \
     }
 
 #endif /* CMC_HASHMAP_H */
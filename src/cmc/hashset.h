@@ -19,15 +19,28 @@
 #define CMC_HASHSET_H
 
 #include <inttypes.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_math.h"
+#include "../utl/cmc_parallel.h"
+#include "../utl/cmc_serial.h"
 #include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
 
 /* to_string format */
 static const char *cmc_string_fmt_hashset = "%s at %p { buffer:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", load:%lf, cmp:%p, hash:%p }";
 
+/* A removal shrinks a collection once less than this fraction of what it */
+/* can hold without growing is in use. Define it as 0 to never shrink */
+#ifndef CMC_SHRINK_LOW_WATER
+#define CMC_SHRINK_LOW_WATER 0.25
+#endif
+
 #ifndef CMC_IMPL_HASHTABLE_STATE
 #define CMC_IMPL_HASHTABLE_STATE
 
@@ -38,6 +51,17 @@ enum cmc_entry_state
     CMC_ES_FILLED = 1
 };
 
+/* The state of an entry and its distance to its original position are packed */
+/* together as bit-fields. Only tables bigger than CMC_ES_DIST_MAX can have a */
+/* distance that does not fit and these grow instead of storing it */
+#if UINT_MAX >= 0xFFFFFFFF
+#define CMC_ES_DIST_BITS 30
+#else
+#define CMC_ES_DIST_BITS 14
+#endif
+
+#define CMC_ES_DIST_MAX (((size_t)1 << CMC_ES_DIST_BITS) - 1)
+
 #endif /* CMC_IMPL_HASHTABLE_STATE */
 
 #ifndef CMC_IMPL_HASHTABLE_SETUP
@@ -75,20 +99,516 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                               6917529027641081903,
                                               13835058055282163729llu};
 
+/* Smallest prime from cmc_hashtable_primes that is greater or equal to */
+/* required, found with a binary search. Used by the default (prime sized) */
+/* hashtables */
+static inline size_t cmc_hashtable_prime_size(size_t required)
+{
+    const size_t count = sizeof(cmc_hashtable_primes) / sizeof(cmc_hashtable_primes[0]);
+
+    if (cmc_hashtable_primes[count - 1] < required)
+        return required;
+
+    size_t low = 0;
+    size_t high = count - 1;
+
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+
+        if (cmc_hashtable_primes[mid] < required)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return cmc_hashtable_primes[low];
+}
+
+/* Prime sized tables reduce a hash to a slot with Lemire's fastmod, which */
+/* replaces the division of the modulo with a few multiplications by a */
+/* multiplier computed once for every capacity. Without 128 bit integers */
+/* the multiplier is not used and the modulo is kept */
+#if defined(__SIZEOF_INT128__) && SIZE_MAX == UINT64_MAX
+__extension__ typedef unsigned __int128 cmc_fastmod;
+
+static inline cmc_fastmod cmc_fastmod_new(size_t divisor)
+{
+    return divisor > 0 ? ~(cmc_fastmod)0 / divisor + 1 : 0;
+}
+
+static inline size_t cmc_fastmod_reduce(size_t value, cmc_fastmod multiplier, size_t divisor)
+{
+    /* The fractional part of value / divisor, multiplied by divisor */
+    cmc_fastmod fraction = multiplier * value;
+    cmc_fastmod low = ((fraction & UINT64_MAX) * divisor) >> 64;
+    cmc_fastmod high = (fraction >> 64) * divisor;
+
+    return (size_t)((low + high) >> 64);
+}
+#else
+typedef size_t cmc_fastmod;
+
+static inline cmc_fastmod cmc_fastmod_new(size_t divisor)
+{
+    (void)divisor;
+    return 0;
+}
+
+static inline size_t cmc_fastmod_reduce(size_t value, cmc_fastmod multiplier, size_t divisor)
+{
+    (void)multiplier;
+    return value % divisor;
+}
+#endif
+
+/* Smallest power of two that is greater or equal to required. Used by the */
+/* hashtables generated with the POW2 variants */
+static inline size_t cmc_hashtable_pow2_size(size_t required)
+{
+    size_t size = 64;
+
+    while (size < required && size <= SIZE_MAX / 2)
+        size <<= 1;
+
+    return size;
+}
+
+/* Power of two hashtables only look at the lower bits of a hash so they are */
+/* first passed through this finalizer (from MurmurHash3) to spread the */
+/* entropy of the upper bits */
+static inline size_t cmc_hashtable_mix(size_t hash)
+{
+    uint64_t h = (uint64_t)hash;
+
+    h ^= h >> 33;
+    h *= UINT64_C(0xff51afd7ed558ccd);
+    h ^= h >> 33;
+    h *= UINT64_C(0xc4ceb9fe1a85ec53);
+    h ^= h >> 33;
+
+    return (size_t)h;
+}
+
+/* Fraction of what a hashtable can hold under which a removal shrinks it. */
+/* Tables grow by a factor of 1 / load, so right after growing one is only */
+/* load full, and the mark is kept under half of that so that a table that */
+/* just grew is not shrunk by the next removals */
+static inline double cmc_hashtable_low_water(double load)
+{
+    return CMC_SHRINK_LOW_WATER < load / 2 ? CMC_SHRINK_LOW_WATER : load / 2;
+}
+
+/* Sizing policies selected by the SIZING parameter of the generators. PRIME */
+/* tables reduce a hash with a modulo and POW2 tables mix it and mask it */
+#define CMC_IMPL_HASHTABLE_PRIME_SIZE(required) cmc_hashtable_prime_size(required)
+#define CMC_IMPL_HASHTABLE_PRIME_HOME(hash, capacity) ((hash) % (capacity))
+#define CMC_IMPL_HASHTABLE_PRIME_WRAP(pos, capacity) ((pos) % (capacity))
+
+#define CMC_IMPL_HASHTABLE_POW2_SIZE(required) cmc_hashtable_pow2_size(required)
+#define CMC_IMPL_HASHTABLE_POW2_HOME(hash, capacity) (cmc_hashtable_mix(hash) & ((capacity)-1))
+#define CMC_IMPL_HASHTABLE_POW2_WRAP(pos, capacity) ((pos) & ((capacity)-1))
+
+/* The same for a table, where PRIME tables use the fastmod multiplier kept */
+/* next to their capacity */
+#define CMC_IMPL_HASHTABLE_PRIME_TABLE_HOME(hash, table) \
+    cmc_fastmod_reduce(hash, (table)->fastmod, (table)->capacity)
+#define CMC_IMPL_HASHTABLE_PRIME_TABLE_WRAP(pos, table) \
+    cmc_fastmod_reduce(pos, (table)->fastmod, (table)->capacity)
+
+#define CMC_IMPL_HASHTABLE_POW2_TABLE_HOME(hash, table) \
+    CMC_IMPL_HASHTABLE_POW2_HOME(hash, (table)->capacity)
+#define CMC_IMPL_HASHTABLE_POW2_TABLE_WRAP(pos, table) \
+    CMC_IMPL_HASHTABLE_POW2_WRAP(pos, (table)->capacity)
+
+/* Hashing policies selected by the HASHING parameter of the generators. */
+/* CACHED tables store the full hash of every key in its entry so that it */
+/* is compared before the keys themselves and reused when resizing */
+#define CMC_IMPL_HASHTABLE_CACHED(...) __VA_ARGS__
+#define CMC_IMPL_HASHTABLE_CACHED_EQUALS(cached, hash) ((cached) == (hash))
+#define CMC_IMPL_HASHTABLE_CACHED_REHASH(cached, computed) (cached)
+
+#define CMC_IMPL_HASHTABLE_UNCACHED(...)
+#define CMC_IMPL_HASHTABLE_UNCACHED_EQUALS(cached, hash) true
+#define CMC_IMPL_HASHTABLE_UNCACHED_REHASH(cached, computed) (computed)
+
+/* Batched lookups hash and prefetch the home slots of this many keys before */
+/* resolving any of their probes */
+#define CMC_IMPL_HASHTABLE_BATCH 16
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CMC_IMPL_HASHTABLE_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define CMC_IMPL_HASHTABLE_PREFETCH(address)
+#endif
+
 #endif /* CMC_IMPL_HASHTABLE_SETUP */
 
+#ifndef CMC_IMPL_HASHTABLE_STATS
+#define CMC_IMPL_HASHTABLE_STATS
+
+/* Amount of buckets of the histogram of distances of cmc_hashtable_stats. */
+/* The last bucket also counts every entry that is further away */
+#ifndef CMC_HASHTABLE_STATS_BUCKETS
+#define CMC_HASHTABLE_STATS_BUCKETS 16
+#endif
+
+/* Health of a hashtable, as reported by the stats function of every */
+/* hashtable collection */
+struct cmc_hashtable_stats
+{
+    /* Amount of slots (or buckets) of the table */
+    size_t capacity;
+
+    /* Amount of entries in the table */
+    size_t count;
+
+    /* Slots that are marked as deleted and still take part in probes */
+    size_t tombstones;
+
+    /* Current load, count / capacity */
+    double load;
+
+    /* Greatest distance of an entry to its original position */
+    size_t max_dist;
+
+    /* Average distance of an entry to its original position */
+    double mean_dist;
+
+    /* Amount of entries at each distance to their original position */
+    size_t histogram[CMC_HASHTABLE_STATS_BUCKETS];
+
+    /* Bytes allocated by the collection, not counting what K and V own */
+    size_t bytes;
+
+    /* Lookups done since the table was created */
+    size_t lookups;
+
+    /* Entries compared by these lookups */
+    size_t probes;
+};
+
+/* Adds the distance of an entry to stats. Until cmc_hashtable_stats_end() */
+/* is called mean_dist holds the sum of all distances */
+static inline void cmc_hashtable_stats_add(struct cmc_hashtable_stats *stats, size_t dist)
+{
+    if (dist < CMC_HASHTABLE_STATS_BUCKETS)
+        stats->histogram[dist]++;
+    else
+        stats->histogram[CMC_HASHTABLE_STATS_BUCKETS - 1]++;
+
+    if (dist > stats->max_dist)
+        stats->max_dist = dist;
+
+    stats->mean_dist += (double)dist;
+}
+
+/* Adds the finished stats of another table to stats, for collections made */
+/* of more than one hashtable */
+static inline void cmc_hashtable_stats_merge(struct cmc_hashtable_stats *stats,
+                                             struct cmc_hashtable_stats *other)
+{
+    size_t entries = 0;
+
+    for (size_t i = 0; i < CMC_HASHTABLE_STATS_BUCKETS; i++)
+    {
+        stats->histogram[i] += other->histogram[i];
+        entries += other->histogram[i];
+    }
+
+    if (other->max_dist > stats->max_dist)
+        stats->max_dist = other->max_dist;
+
+    stats->mean_dist += other->mean_dist * (double)entries;
+    stats->capacity += other->capacity;
+    stats->count += other->count;
+    stats->tombstones += other->tombstones;
+    stats->bytes += other->bytes;
+    stats->lookups += other->lookups;
+    stats->probes += other->probes;
+}
+
+/* Turns the sum of distances of stats into their mean and computes the load */
+static inline void cmc_hashtable_stats_end(struct cmc_hashtable_stats *stats)
+{
+    size_t entries = 0;
+
+    for (size_t i = 0; i < CMC_HASHTABLE_STATS_BUCKETS; i++)
+        entries += stats->histogram[i];
+
+    if (entries > 0)
+        stats->mean_dist /= (double)entries;
+
+    if (stats->capacity > 0)
+        stats->load = (double)stats->count / (double)stats->capacity;
+}
+
+/* Defining CMC_HASHTABLE_PROBE_STATS before including any hashtable makes */
+/* every table count its lookups and the entries they compare, reported as */
+/* lookups and probes by cmc_hashtable_stats. The counters are not atomic */
+/* so lookups that run concurrently without a lock are counted loosely */
+#ifdef CMC_HASHTABLE_PROBE_STATS
+#define CMC_IMPL_HASHTABLE_PROBE_FIELDS size_t lookups; size_t probes;
+#define CMC_IMPL_HASHTABLE_PROBE_RESET(table) ((table)->lookups = 0, (table)->probes = 0)
+#define CMC_IMPL_HASHTABLE_PROBE_LOOKUP(table) ((table)->lookups++)
+#define CMC_IMPL_HASHTABLE_PROBE_SLOT(table) ((table)->probes++)
+#define CMC_IMPL_HASHTABLE_PROBE_ADD(to, from) \
+    ((to)->lookups += (from)->lookups, (to)->probes += (from)->probes)
+#else
+#define CMC_IMPL_HASHTABLE_PROBE_FIELDS
+#define CMC_IMPL_HASHTABLE_PROBE_RESET(table) ((void)0)
+#define CMC_IMPL_HASHTABLE_PROBE_LOOKUP(table) ((void)0)
+#define CMC_IMPL_HASHTABLE_PROBE_SLOT(table) ((void)0)
+#define CMC_IMPL_HASHTABLE_PROBE_ADD(to, from) ((void)0)
+#endif
+
+#endif /* CMC_IMPL_HASHTABLE_STATS */
+
+#ifndef CMC_IMPL_HASHTABLE_OCCUPANCY
+#define CMC_IMPL_HASHTABLE_OCCUPANCY
+
+/* Defining CMC_HASHTABLE_OCCUPANCY before including any hashtable makes */
+/* every table keep a bitmap with one bit for each slot, set while the slot */
+/* is filled. Iterators, copy_of and the functions that go through every */
+/* entry then skip up to 64 empty slots at a time instead of reading their */
+/* states, which pays off for sparse tables. A table whose bitmap could not */
+/* be allocated works as if it was not defined */
+#ifdef CMC_HASHTABLE_OCCUPANCY
+#define CMC_IMPL_HASHTABLE_OCCUPANCY_FIELDS uint64_t *occupied;
+#define CMC_IMPL_HASHTABLE_OCCUPIED(table) ((table)->occupied)
+#define CMC_IMPL_HASHTABLE_OCCUPANCY_NEW(table) \
+    ((table)->occupied = cmc_occupancy_new((table)->alloc, (table)->capacity))
+#define CMC_IMPL_HASHTABLE_OCCUPANCY_FREE(table) (table)->alloc->free((table)->occupied)
+#define CMC_IMPL_HASHTABLE_OCCUPANCY_NONE(table) ((table)->occupied = NULL)
+#define CMC_IMPL_HASHTABLE_OCCUPANCY_SWAP(a, b) cmc_occupancy_swap(&(a)->occupied, &(b)->occupied)
+#define CMC_IMPL_HASHTABLE_OCCUPY(table, slot) \
+    ((table)->occupied ? cmc_occupancy_set((table)->occupied, slot) : (void)0)
+#define CMC_IMPL_HASHTABLE_VACATE(table, slot) \
+    ((table)->occupied ? cmc_occupancy_unset((table)->occupied, slot) : (void)0)
+#define CMC_IMPL_HASHTABLE_OCCUPANCY_BYTES(table) \
+    ((table)->occupied ? sizeof(uint64_t) * cmc_occupancy_words((table)->capacity) : 0)
+#else
+#define CMC_IMPL_HASHTABLE_OCCUPANCY_FIELDS
+#define CMC_IMPL_HASHTABLE_OCCUPIED(table) ((uint64_t *)NULL)
+#define CMC_IMPL_HASHTABLE_OCCUPANCY_NEW(table) ((void)0)
+#define CMC_IMPL_HASHTABLE_OCCUPANCY_FREE(table) ((void)0)
+#define CMC_IMPL_HASHTABLE_OCCUPANCY_NONE(table) ((void)0)
+#define CMC_IMPL_HASHTABLE_OCCUPANCY_SWAP(a, b) ((void)0)
+#define CMC_IMPL_HASHTABLE_OCCUPY(table, slot) ((void)0)
+#define CMC_IMPL_HASHTABLE_VACATE(table, slot) ((void)0)
+#define CMC_IMPL_HASHTABLE_OCCUPANCY_BYTES(table) ((size_t)0)
+#endif
+
+static inline size_t cmc_occupancy_words(size_t capacity)
+{
+    return capacity / 64 + (capacity % 64 != 0);
+}
+
+/* Returns NULL if the bitmap could not be allocated */
+static inline uint64_t *cmc_occupancy_new(struct cmc_alloc_node *alloc, size_t capacity)
+{
+    return alloc->calloc(cmc_occupancy_words(capacity), sizeof(uint64_t));
+}
+
+static inline void cmc_occupancy_set(uint64_t *bits, size_t slot)
+{
+    bits[slot / 64] |= UINT64_C(1) << (slot % 64);
+}
+
+static inline void cmc_occupancy_unset(uint64_t *bits, size_t slot)
+{
+    bits[slot / 64] &= ~(UINT64_C(1) << (slot % 64));
+}
+
+static inline void cmc_occupancy_swap(uint64_t **a, uint64_t **b)
+{
+    uint64_t *tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+/* First slot at or after from that is set, or capacity if there is none */
+static inline size_t cmc_occupancy_next(uint64_t *bits, size_t capacity, size_t from)
+{
+    if (from >= capacity)
+        return capacity;
+
+    size_t words = cmc_occupancy_words(capacity);
+    size_t w = from / 64;
+    uint64_t word = bits[w] & (~UINT64_C(0) << (from % 64));
+
+    while (word == 0)
+    {
+        if (++w == words)
+            return capacity;
+
+        word = bits[w];
+    }
+
+    return w * 64 + cmc_math_ctz(word);
+}
+
+/* Last slot at or before from that is set, or SIZE_MAX if there is none */
+static inline size_t cmc_occupancy_prev(uint64_t *bits, size_t from)
+{
+    size_t w = from / 64;
+    uint64_t word = bits[w] & (~UINT64_C(0) >> (63 - from % 64));
+
+    while (word == 0)
+    {
+        if (w-- == 0)
+            return SIZE_MAX;
+
+        word = bits[w];
+    }
+
+    return w * 64 + 63 - cmc_math_clz(word);
+}
+
+#endif /* CMC_IMPL_HASHTABLE_OCCUPANCY */
+
+#ifndef CMC_IMPL_HASHTABLE_STORAGE
+#define CMC_IMPL_HASHTABLE_STORAGE
+
+/* Amount of entries kept inside the struct of SMALL tables */
+#ifndef CMC_HASHTABLE_SMALL_SIZE
+#define CMC_HASHTABLE_SMALL_SIZE 8
+#endif
+
+/* Storage policies selected by the STORAGE parameter of the generators. */
+/* SMALL tables have room for CMC_HASHTABLE_SMALL_SIZE entries inside their */
+/* own struct. One that is created for at most that many keys keeps them */
+/* there, so creating it takes a single allocation, and looks them up by */
+/* comparing the keys one after the other without hashing them. It moves to */
+/* an allocated buffer when it grows past them and back once shrinking */
+/* leaves few enough keys. ALLOCATED tables always use an allocated buffer */
+#define CMC_IMPL_HASHTABLE_ALLOCATED_FIELDS(entry)
+#define CMC_IMPL_HASHTABLE_ALLOCATED_SIZE ((size_t)0)
+#define CMC_IMPL_HASHTABLE_ALLOCATED_BUFFER(table) NULL
+#define CMC_IMPL_HASHTABLE_ALLOCATED_IN_STRUCT(table) false
+
+#define CMC_IMPL_HASHTABLE_SMALL_FIELDS(entry) entry small_buffer[CMC_HASHTABLE_SMALL_SIZE];
+#define CMC_IMPL_HASHTABLE_SMALL_SIZE ((size_t)CMC_HASHTABLE_SMALL_SIZE)
+#define CMC_IMPL_HASHTABLE_SMALL_BUFFER(table) ((table)->small_buffer)
+#define CMC_IMPL_HASHTABLE_SMALL_IN_STRUCT(table) ((table)->buffer == (table)->small_buffer)
+
+#endif /* CMC_IMPL_HASHTABLE_STORAGE */
+
+#ifndef CMC_IMPL_HASHTABLE_FINGERPRINT
+#define CMC_IMPL_HASHTABLE_FINGERPRINT
+
+/* Defining CMC_HASHTABLE_FINGERPRINT before including any hashtable makes */
+/* every table keep the sum of the mixed hashes of its keys, updated as they */
+/* are inserted and removed. The sum does not depend on the order of the */
+/* keys, so equals returns false without looking any of them up when two */
+/* tables with the same count have different sums. SMALL tables, which */
+/* otherwise never hash their keys, then hash every key they insert */
+#ifdef CMC_HASHTABLE_FINGERPRINT
+#define CMC_IMPL_HASHTABLE_FINGERPRINT_FIELDS size_t fingerprint;
+#define CMC_IMPL_HASHTABLE_FINGERPRINTED(...) __VA_ARGS__
+#define CMC_IMPL_HASHTABLE_FINGERPRINT_DIFFERS(a, b) ((a)->fingerprint != (b)->fingerprint)
+#else
+#define CMC_IMPL_HASHTABLE_FINGERPRINT_FIELDS
+#define CMC_IMPL_HASHTABLE_FINGERPRINTED(...)
+#define CMC_IMPL_HASHTABLE_FINGERPRINT_DIFFERS(a, b) false
+#endif
+
+#endif /* CMC_IMPL_HASHTABLE_FINGERPRINT */
+
 #define CMC_GENERATE_HASHSET(PFX, SNAME, V)    \
     CMC_GENERATE_HASHSET_HEADER(PFX, SNAME, V) \
     CMC_GENERATE_HASHSET_SOURCE(PFX, SNAME, V)
 
+/* Same as CMC_GENERATE_HASHSET but tables are sized to powers of two */
+#define CMC_GENERATE_HASHSET_POW2(PFX, SNAME, V) \
+    CMC_GENERATE_HASHSET_HEADER(PFX, SNAME, V)   \
+    CMC_GENERATE_HASHSET_POW2_SOURCE(PFX, SNAME, V)
+
+/* Same as CMC_GENERATE_HASHSET but entries also store the hash of their element */
+#define CMC_GENERATE_HASHSET_CACHED(PFX, SNAME, V)    \
+    CMC_GENERATE_HASHSET_CACHED_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_HASHSET_CACHED_SOURCE(PFX, SNAME, V)
+
+/* Same as CMC_GENERATE_HASHSET but elements are compared and hashed by */
+/* calling CMP and HASH directly, so the compiler can inline them. The */
+/* functions given to new are still stored but only used by copy_of and */
+/* to_string */
+#define CMC_GENERATE_HASHSET_EX(PFX, SNAME, V, CMP, HASH) \
+    CMC_GENERATE_HASHSET_HEADER(PFX, SNAME, V)            \
+    CMC_GENERATE_HASHSET_EX_SOURCE(PFX, SNAME, V, CMP, HASH)
+
+/* Same as CMC_GENERATE_HASHSET but a table of a few elements keeps them */
+/* inside its struct and finds them without hashing, see */
+/* CMC_HASHTABLE_SMALL_SIZE */
+#define CMC_GENERATE_HASHSET_SMALL(PFX, SNAME, V)    \
+    CMC_GENERATE_HASHSET_SMALL_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_HASHSET_SMALL_SOURCE(PFX, SNAME, V)
+
 #define CMC_WRAPGEN_HASHSET_HEADER(PFX, SNAME, K, V) \
     CMC_GENERATE_HASHSET_HEADER(PFX, SNAME, V)
 
 #define CMC_WRAPGEN_HASHSET_SOURCE(PFX, SNAME, K, V) \
     CMC_GENERATE_HASHSET_SOURCE(PFX, SNAME, V)
 
+#define CMC_WRAPGEN_HASHSET_POW2_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_HASHSET_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_HASHSET_POW2_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_HASHSET_POW2_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_HASHSET_CACHED_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_HASHSET_CACHED_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_HASHSET_CACHED_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_HASHSET_CACHED_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_HASHSET_SMALL_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_HASHSET_SMALL_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_HASHSET_SMALL_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_HASHSET_SMALL_SOURCE(PFX, SNAME, V)
+
+#define CMC_GENERATE_HASHSET_HEADER(PFX, SNAME, V) \
+    CMC_IMPL_HASHSET_HEADER(PFX, SNAME, V, UNCACHED, ALLOCATED)
+
+#define CMC_GENERATE_HASHSET_CACHED_HEADER(PFX, SNAME, V) \
+    CMC_IMPL_HASHSET_HEADER(PFX, SNAME, V, CACHED, ALLOCATED)
+
+#define CMC_GENERATE_HASHSET_SMALL_HEADER(PFX, SNAME, V) \
+    CMC_IMPL_HASHSET_HEADER(PFX, SNAME, V, UNCACHED, SMALL)
+
+#define CMC_GENERATE_HASHSET_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_HASHSET_SOURCE(PFX, SNAME, V, PRIME, UNCACHED, ALLOCATED, _set_->cmp, _set_->hash)
+
+#define CMC_GENERATE_HASHSET_POW2_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_HASHSET_SOURCE(PFX, SNAME, V, POW2, UNCACHED, ALLOCATED, _set_->cmp, _set_->hash)
+
+#define CMC_GENERATE_HASHSET_CACHED_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_HASHSET_SOURCE(PFX, SNAME, V, PRIME, CACHED, ALLOCATED, _set_->cmp, _set_->hash)
+
+#define CMC_GENERATE_HASHSET_EX_SOURCE(PFX, SNAME, V, CMP, HASH) \
+    CMC_IMPL_HASHSET_SOURCE(PFX, SNAME, V, PRIME, UNCACHED, ALLOCATED, CMP, HASH)
+
+#define CMC_GENERATE_HASHSET_SMALL_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_HASHSET_SOURCE(PFX, SNAME, V, PRIME, UNCACHED, SMALL, _set_->cmp, _set_->hash)
+
 /* HEADER ********************************************************************/
-#define CMC_GENERATE_HASHSET_HEADER(PFX, SNAME, V)                                           \
+#define CMC_IMPL_HASHSET_HEADER(PFX, SNAME, V, HASHING, STORAGE)                             \
+                                                                                             \
+    struct SNAME##_entry                                                                     \
+    {                                                                                        \
+        /* Entry element */                                                                  \
+        V value;                                                                             \
+                                                                                             \
+        /* The hash of the element, only stored by CACHED tables */                          \
+        CMC_IMPL_HASHTABLE_##HASHING(size_t hash;)                                           \
+                                                                                             \
+        /* The distance of this node to its original position, used by robin-hood hashing */ \
+        unsigned int dist : CMC_ES_DIST_BITS;                                                \
+                                                                                             \
+        /* The sate of this node (DELETED, EMPTY, FILLED) */                                 \
+        signed int state : 2;                                                                \
+    };                                                                                       \
                                                                                              \
     /* Hashset Structure */                                                                  \
     struct SNAME                                                                             \
@@ -98,6 +618,8 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                              \
         /* Current Array Capcity */                                                          \
         size_t capacity;                                                                     \
+        /* Multiplier of the capacity that reduces a hash to a slot */                       \
+        cmc_fastmod fastmod;                                                                 \
                                                                                              \
         /* Current amount of elements */                                                     \
         size_t count;                                                                        \
@@ -111,23 +633,28 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         /* Element hash function */                                                          \
         size_t (*hash)(V);                                                                   \
                                                                                              \
+        /* Lookup counters, only present with CMC_HASHTABLE_PROBE_STATS */                   \
+        CMC_IMPL_HASHTABLE_PROBE_FIELDS                                                      \
+                                                                                             \
+        /* Bitmap of the filled slots, only present with */                                  \
+        /* CMC_HASHTABLE_OCCUPANCY. NULL if it could not be allocated */                     \
+        CMC_IMPL_HASHTABLE_OCCUPANCY_FIELDS                                                  \
+                                                                                             \
+        /* Sum of the mixed hashes of the elements, only present with */                     \
+        /* CMC_HASHTABLE_FINGERPRINT */                                                      \
+        CMC_IMPL_HASHTABLE_FINGERPRINT_FIELDS                                                \
+                                                                                             \
+        /* Entries kept inside the struct, only present in SMALL tables */                   \
+        CMC_IMPL_HASHTABLE_##STORAGE##_FIELDS(struct SNAME##_entry)                          \
+                                                                                             \
         /* Function that returns an iterator to the start of the hashset */                  \
         struct SNAME##_iter (*it_start)(struct SNAME *);                                     \
                                                                                              \
         /* Function that returns an iterator to the end of the hashset */                    \
         struct SNAME##_iter (*it_end)(struct SNAME *);                                       \
-    };                                                                                       \
-                                                                                             \
-    struct SNAME##_entry                                                                     \
-    {                                                                                        \
-        /* Entry element */                                                                  \
-        V value;                                                                             \
                                                                                              \
-        /* The distance of this node to its original position, used by robin-hood hashing */ \
-        size_t dist;                                                                         \
-                                                                                             \
-        /* The sate of this node (DELETED, EMPTY, FILLED) */                                 \
-        enum cmc_entry_state state;                                                          \
+        /* Custom allocation functions */                                                    \
+        struct cmc_alloc_node *alloc;                                                        \
     };                                                                                       \
                                                                                              \
     /* Hashset Iterator */                                                                   \
@@ -159,32 +686,59 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
     /* Collection Allocation and Deallocation */                                             \
     struct SNAME *PFX##_new(size_t capacity, double load, int (*compare)(V, V),              \
                             size_t (*hash)(V));                                              \
+    struct SNAME *PFX##_new_custom(size_t capacity, double load, int (*compare)(V, V),       \
+                                   size_t (*hash)(V), struct cmc_alloc_node *alloc);         \
+    struct SNAME *PFX##_new_from(V *elements, size_t size, double load,                      \
+                                 int (*compare)(V, V), size_t (*hash)(V));                   \
     void PFX##_clear(struct SNAME *_set_, void (*deallocator)(V));                           \
     void PFX##_free(struct SNAME *_set_, void (*deallocator)(V));                            \
     /* Collection Input and Output */                                                        \
     bool PFX##_insert(struct SNAME *_set_, V element);                                       \
+    size_t PFX##_insert_many(struct SNAME *_set_, V *elements, size_t n);                    \
     bool PFX##_remove(struct SNAME *_set_, V element);                                       \
+    size_t PFX##_remove_if(struct SNAME *_set_, bool (*pred)(V), void (*deallocator)(V));    \
     /* Element Access */                                                                     \
     bool PFX##_max(struct SNAME *_set_, V *value);                                           \
     bool PFX##_min(struct SNAME *_set_, V *value);                                           \
     /* Collection State */                                                                   \
     bool PFX##_contains(struct SNAME *_set_, V element);                                     \
-    bool PFX##_empty(struct SNAME *_set_);                                                   \
+    size_t PFX##_contains_many(struct SNAME *_set_, V *elements, size_t n, bool *found);     \
+    CMC_PURE bool PFX##_empty(struct SNAME *_set_);                                          \
     bool PFX##_full(struct SNAME *_set_);                                                    \
-    size_t PFX##_count(struct SNAME *_set_);                                                 \
+    CMC_PURE size_t PFX##_count(struct SNAME *_set_);                                        \
+    size_t PFX##_memory_usage(struct SNAME *_set_);                                          \
     size_t PFX##_capacity(struct SNAME *_set_);                                              \
     double PFX##_load(struct SNAME *_set_);                                                  \
+    void PFX##_stats(struct SNAME *_set_, struct cmc_hashtable_stats *out);                  \
     /* Collection Utility */                                                                 \
     bool PFX##_resize(struct SNAME *_set_, size_t capacity);                                 \
+    bool PFX##_shrink_to_fit(struct SNAME *_set_);                                           \
     struct SNAME *PFX##_copy_of(struct SNAME *_set_, V (*copy_func)(V));                     \
+    size_t PFX##_to_array(struct SNAME *_set_, V *CMC_RESTRICT elements, size_t size);       \
+    size_t PFX##_parallel_slots(struct SNAME *_set_);                                        \
+    V PFX##_parallel_reduce(struct SNAME *_set_, V initial, V (*reduce)(V, V),               \
+                            V (*combine)(V, V), size_t threads);                             \
     bool PFX##_equals(struct SNAME *_set1_, struct SNAME *_set2_);                           \
+    size_t PFX##_fingerprint(struct SNAME *_set_);                                           \
     struct cmc_string PFX##_to_string(struct SNAME *_set_);                                  \
+    bool PFX##_to_string_full(struct SNAME *_set_, struct cmc_string_builder *builder,       \
+                              const char *elem_fmt);                                         \
+    bool PFX##_write(struct SNAME *_set_, FILE *file, void (*fmt)(FILE *, V));               \
+    bool PFX##_write_fd(struct SNAME *_set_, int fd, void (*fmt)(struct cmc_dump *, V));     \
+    /* Collection Serialization */                                                           \
+    bool PFX##_save(struct SNAME *_set_, FILE *file, bool (*writer)(V, FILE *));             \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(V, V), size_t (*hash)(V),         \
+                                bool (*reader)(V *, FILE *));                                \
+                                                                                             \
                                                                                              \
     /* Set Operations */                                                                     \
     struct SNAME *PFX##_union(struct SNAME *_set1_, struct SNAME *_set2_);                   \
     struct SNAME *PFX##_intersection(struct SNAME *_set1_, struct SNAME *_set2_);            \
     struct SNAME *PFX##_difference(struct SNAME *_set1_, struct SNAME *_set2_);              \
     struct SNAME *PFX##_symmetric_difference(struct SNAME *_set1_, struct SNAME *_set2_);    \
+    bool PFX##_union_into(struct SNAME *_set1_, struct SNAME *_set2_);                       \
+    bool PFX##_intersect_with(struct SNAME *_set1_, struct SNAME *_set2_);                   \
+    void PFX##_subtract(struct SNAME *_set1_, struct SNAME *_set2_);                         \
     bool PFX##_is_subset(struct SNAME *_set1_, struct SNAME *_set2_);                        \
     bool PFX##_is_superset(struct SNAME *_set1_, struct SNAME *_set2_);                      \
     bool PFX##_is_proper_subset(struct SNAME *_set1_, struct SNAME *_set2_);                 \
@@ -208,21 +762,65 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
     bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps);                        \
     bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps);                         \
     bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index);                          \
+    bool PFX##_parallel_iter(struct SNAME##_iter *iter, struct SNAME *target, size_t slot);  \
     /* Iterator Access */                                                                    \
     V PFX##_iter_value(struct SNAME##_iter *iter);                                           \
     size_t PFX##_iter_index(struct SNAME##_iter *iter);                                      \
                                                                                              \
 /* SOURCE ********************************************************************/
-#define CMC_GENERATE_HASHSET_SOURCE(PFX, SNAME, V)                                                 \
+#define CMC_IMPL_HASHSET_SOURCE(PFX, SNAME, V, SIZING, HASHING, STORAGE, CMP, HASH)                \
                                                                                                    \
     /* Implementation Detail Functions */                                                          \
+    static inline int PFX##_impl_cmp(struct SNAME *_set_, V a, V b);                               \
+    static inline size_t PFX##_impl_hash(struct SNAME *_set_, V value);                            \
     static struct SNAME##_entry *PFX##_impl_get_entry(struct SNAME *_set_, V element);             \
+    static struct SNAME##_entry *PFX##_impl_get_entry_by_hash(struct SNAME *_set_, V element,      \
+                                                              size_t hash);                        \
+    static struct SNAME##_entry *PFX##_impl_insert_entry(struct SNAME *_set_, V element,           \
+                                                         size_t hash, bool lookup);                \
+    static void PFX##_impl_get_batch(struct SNAME *_set_, V *elements, size_t n,                   \
+                                     struct SNAME##_entry **entries);                              \
+    static struct SNAME##_entry *PFX##_impl_small_get(struct SNAME *_set_, V element);             \
+    static struct SNAME##_entry *PFX##_impl_small_insert(struct SNAME *_set_, V element,           \
+                                                         bool lookup);                             \
+    static void PFX##_impl_small_remove(struct SNAME *_set_, struct SNAME##_entry *entry);         \
+    static void PFX##_impl_to_small(struct SNAME *_set_);                                          \
+    static void PFX##_impl_free_buffer(struct SNAME *_set_);                                       \
+    static bool PFX##_impl_dist_overflow(struct SNAME *_set_, size_t hash);                        \
+    static size_t PFX##_impl_fingerprint(struct SNAME *_set_);                                     \
+    static void PFX##_impl_remove_entry(struct SNAME *_set_, struct SNAME##_entry *entry);         \
+    static struct SNAME *PFX##_impl_new_sized(struct SNAME *_set_, size_t count);                  \
+    static void PFX##_impl_retain(struct SNAME *_set1_, struct SNAME *_set2_, bool common);        \
+    static bool PFX##_impl_rehash(struct SNAME *_set_, size_t capacity);                           \
+    static void PFX##_impl_low_water(struct SNAME *_set_);                                         \
+    static bool PFX##_impl_shrink(struct SNAME *_set_, size_t required);                           \
+    static struct SNAME *PFX##_impl_load_layout(FILE *file, int (*compare)(V, V),                  \
+                                                size_t (*hash)(V),                                 \
+                                                struct cmc_serial_header *header);                 \
+                                                                                                   \
+    static size_t PFX##_impl_next_filled(struct SNAME *_set_, size_t from);                        \
+    static size_t PFX##_impl_prev_filled(struct SNAME *_set_, size_t from);                        \
+    static void PFX##_impl_occupancy_fill(struct SNAME *_set_);                                    \
     static size_t PFX##_impl_calculate_size(size_t required);                                      \
+    static inline size_t PFX##_impl_home(struct SNAME *_set_, size_t hash);                        \
+    static inline size_t PFX##_impl_wrap(struct SNAME *_set_, size_t pos);                         \
     static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_set_);                           \
     static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_set_);                             \
                                                                                                    \
+    CMC_GENERATE_PARALLEL_REDUCE(PFX##_impl_parallel_reduce, SNAME, V, (V, V),                     \
+                                 CMC_IMPL_PARALLEL_FILLED, CMC_IMPL_PARALLEL_VALUE)                \
+                                                                                                   \
     struct SNAME *PFX##_new(size_t capacity, double load, int (*compare)(V, V), size_t (*hash)(V)) \
     {                                                                                              \
+        return PFX##_new_custom(capacity, load, compare, hash, NULL);                              \
+    }                                                                                              \
+                                                                                                   \
+    struct SNAME *PFX##_new_custom(size_t capacity, double load, int (*compare)(V, V),             \
+                                   size_t (*hash)(V), struct cmc_alloc_node *alloc)                \
+    {                                                                                              \
+        if (!alloc)                                                                                \
+            alloc = &cmc_alloc_node_default;                                                       \
+                                                                                                   \
         if (capacity == 0 || load <= 0 || load >= 1)                                               \
             return NULL;                                                                           \
                                                                                                    \
@@ -232,125 +830,201 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
         size_t real_capacity = PFX##_impl_calculate_size(capacity / load);                         \
                                                                                                    \
-        struct SNAME *_set_ = malloc(sizeof(struct SNAME));                                        \
+        struct SNAME *_set_ = alloc->malloc(sizeof(struct SNAME));                                 \
                                                                                                    \
-        if (!_set_)                                                                                \
+        if (CMC_UNLIKELY(!_set_))                                                                  \
             return NULL;                                                                           \
                                                                                                    \
-        _set_->buffer = calloc(real_capacity, sizeof(struct SNAME##_entry));                       \
+        _set_->alloc = alloc;                                                                      \
                                                                                                    \
-        if (!_set_->buffer)                                                                        \
+        if (capacity <= CMC_IMPL_HASHTABLE_##STORAGE##_SIZE)                                       \
         {                                                                                          \
-            free(_set_);                                                                           \
-            return NULL;                                                                           \
+            /* Small tables keep their entries inside the struct */                                \
+            real_capacity = CMC_IMPL_HASHTABLE_##STORAGE##_SIZE;                                   \
+            _set_->buffer = CMC_IMPL_HASHTABLE_##STORAGE##_BUFFER(_set_);                          \
+                                                                                                   \
+            memset(_set_->buffer, 0, sizeof(struct SNAME##_entry) * real_capacity);                \
+        }                                                                                          \
+        else                                                                                       \
+        {                                                                                          \
+            _set_->buffer = alloc->calloc(real_capacity, sizeof(struct SNAME##_entry));            \
+                                                                                                   \
+            if (CMC_UNLIKELY(!_set_->buffer))                                                      \
+            {                                                                                      \
+                alloc->free(_set_);                                                                \
+                return NULL;                                                                       \
+            }                                                                                      \
         }                                                                                          \
                                                                                                    \
         _set_->count = 0;                                                                          \
         _set_->capacity = real_capacity;                                                           \
+        _set_->fastmod = cmc_fastmod_new(_set_->capacity);                                         \
         _set_->load = load;                                                                        \
         _set_->cmp = compare;                                                                      \
         _set_->hash = hash;                                                                        \
                                                                                                    \
+        CMC_IMPL_HASHTABLE_PROBE_RESET(_set_);                                                     \
+        CMC_IMPL_HASHTABLE_FINGERPRINTED(_set_->fingerprint = 0;)                                  \
+                                                                                                   \
+        /* Small tables are not worth a bitmap */                                                  \
+        if (CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_set_))                                       \
+            CMC_IMPL_HASHTABLE_OCCUPANCY_NONE(_set_);                                              \
+        else                                                                                       \
+            CMC_IMPL_HASHTABLE_OCCUPANCY_NEW(_set_);                                               \
+                                                                                                   \
         _set_->it_start = PFX##_impl_it_start;                                                     \
         _set_->it_end = PFX##_impl_it_end;                                                         \
                                                                                                    \
         return _set_;                                                                              \
     }                                                                                              \
                                                                                                    \
+    /* Creates a set sized for the size elements and inserts them. Repeated */                     \
+    /* elements are only inserted once */                                                          \
+    struct SNAME *PFX##_new_from(V *elements, size_t size, double load, int (*compare)(V, V),      \
+                                 size_t (*hash)(V))                                                \
+    {                                                                                              \
+        struct SNAME *_set_ = PFX##_new(size, load, compare, hash);                                \
+                                                                                                   \
+        if (CMC_UNLIKELY(!_set_))                                                                  \
+            return NULL;                                                                           \
+                                                                                                   \
+        for (size_t i = 0; i < size; i++)                                                          \
+        {                                                                                          \
+            if (!PFX##_insert(_set_, elements[i]) && !PFX##_contains(_set_, elements[i]))          \
+            {                                                                                      \
+                PFX##_free(_set_, NULL);                                                           \
+                return NULL;                                                                       \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        return _set_;                                                                              \
+    }                                                                                              \
+                                                                                                   \
     void PFX##_clear(struct SNAME *_set_, void (*deallocator)(V))                                  \
     {                                                                                              \
         if (deallocator)                                                                           \
         {                                                                                          \
-            for (size_t i = 0; i < _set_->capacity; i++)                                           \
+            for (size_t i = PFX##_impl_next_filled(_set_, 0); i < _set_->capacity;                 \
+                 i = PFX##_impl_next_filled(_set_, i + 1))                                         \
             {                                                                                      \
                 struct SNAME##_entry *entry = &(_set_->buffer[i]);                                 \
                                                                                                    \
-                if (entry->state == CMC_ES_FILLED)                                                 \
-                {                                                                                  \
-                    deallocator(entry->value);                                                     \
-                }                                                                                  \
+                deallocator(entry->value);                                                         \
             }                                                                                      \
         }                                                                                          \
                                                                                                    \
         memset(_set_->buffer, 0, sizeof(struct SNAME##_entry) * _set_->capacity);                  \
                                                                                                    \
+        uint64_t *bits = CMC_IMPL_HASHTABLE_OCCUPIED(_set_);                                       \
+                                                                                                   \
+        if (bits)                                                                                  \
+            memset(bits, 0, sizeof(uint64_t) * cmc_occupancy_words(_set_->capacity));              \
+                                                                                                   \
         _set_->count = 0;                                                                          \
+                                                                                                   \
+        CMC_IMPL_HASHTABLE_FINGERPRINTED(_set_->fingerprint = 0;)                                  \
     }                                                                                              \
                                                                                                    \
     void PFX##_free(struct SNAME *_set_, void (*deallocator)(V))                                   \
     {                                                                                              \
         if (deallocator)                                                                           \
         {                                                                                          \
-            for (size_t i = 0; i < _set_->capacity; i++)                                           \
+            for (size_t i = PFX##_impl_next_filled(_set_, 0); i < _set_->capacity;                 \
+                 i = PFX##_impl_next_filled(_set_, i + 1))                                         \
             {                                                                                      \
                 struct SNAME##_entry *entry = &(_set_->buffer[i]);                                 \
                                                                                                    \
-                if (entry->state == CMC_ES_FILLED)                                                 \
-                {                                                                                  \
-                    deallocator(entry->value);                                                     \
-                }                                                                                  \
+                deallocator(entry->value);                                                         \
             }                                                                                      \
         }                                                                                          \
                                                                                                    \
-        free(_set_->buffer);                                                                       \
-        free(_set_);                                                                               \
+        CMC_IMPL_HASHTABLE_OCCUPANCY_FREE(_set_);                                                  \
+                                                                                                   \
+        PFX##_impl_free_buffer(_set_);                                                             \
+        _set_->alloc->free(_set_);                                                                 \
     }                                                                                              \
                                                                                                    \
     bool PFX##_insert(struct SNAME *_set_, V element)                                              \
     {                                                                                              \
         if (PFX##_full(_set_))                                                                     \
         {                                                                                          \
-            if (!PFX##_resize(_set_, PFX##_capacity(_set_) + 1))                                   \
+            if (CMC_UNLIKELY(!PFX##_resize(_set_, PFX##_capacity(_set_) + 1)))                     \
                 return false;                                                                      \
         }                                                                                          \
                                                                                                    \
-        size_t hash = _set_->hash(element);                                                        \
-        size_t original_pos = hash % _set_->capacity;                                              \
-        size_t pos = original_pos;                                                                 \
+        /* Small tables are searched without the hash */                                           \
+        size_t hash =                                                                              \
+            CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_set_) ? 0 : PFX##_impl_hash(_set_, element); \
                                                                                                    \
-        struct SNAME##_entry *target = &(_set_->buffer[pos]);                                      \
+        /* Only tables bigger than CMC_ES_DIST_MAX can run out of bits to */                       \
+        /* store the distance of an entry */                                                       \
+        if (PFX##_capacity(_set_) > CMC_ES_DIST_MAX && PFX##_impl_dist_overflow(_set_, hash))      \
+        {                                                                                          \
+            if (CMC_UNLIKELY(!PFX##_resize(_set_, PFX##_capacity(_set_) + 1)))                     \
+                return false;                                                                      \
+                                                                                                   \
+            return PFX##_insert(_set_, element);                                                   \
+        }                                                                                          \
                                                                                                    \
-        if (PFX##_impl_get_entry(_set_, element) != NULL)                                          \
+        if (!PFX##_impl_insert_entry(_set_, element, hash, true))                                  \
             return false;                                                                          \
                                                                                                    \
-        if (target->state == CMC_ES_EMPTY || target->state == CMC_ES_DELETED)                      \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    size_t PFX##_insert_many(struct SNAME *_set_, V *elements, size_t n)                           \
+    {                                                                                              \
+        /* Grow once for every element instead of one threshold at a time */                       \
+        if (CMC_UNLIKELY(!PFX##_resize(_set_, PFX##_count(_set_) + n)))                            \
+            return 0;                                                                              \
+                                                                                                   \
+        size_t hashes[CMC_IMPL_HASHTABLE_BATCH];                                                   \
+                                                                                                   \
+        size_t total = 0;                                                                          \
+                                                                                                   \
+        /* Every element still fits in the entries of the struct */                                \
+        if (CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_set_))                                       \
         {                                                                                          \
-            target->value = element;                                                               \
-            target->dist = 0;                                                                      \
-            target->state = CMC_ES_FILLED;                                                         \
+            for (size_t i = 0; i < n; i++)                                                         \
+            {                                                                                      \
+                if (PFX##_insert(_set_, elements[i]))                                              \
+                    total++;                                                                       \
+            }                                                                                      \
+                                                                                                   \
+            return total;                                                                          \
         }                                                                                          \
-        else                                                                                       \
+                                                                                                   \
+        for (size_t i = 0; i < n; i += CMC_IMPL_HASHTABLE_BATCH)                                   \
         {                                                                                          \
-            while (true)                                                                           \
+            size_t batch = n - i < CMC_IMPL_HASHTABLE_BATCH ? n - i : CMC_IMPL_HASHTABLE_BATCH;    \
+                                                                                                   \
+            for (size_t j = 0; j < batch; j++)                                                     \
             {                                                                                      \
-                pos++;                                                                             \
-                target = &(_set_->buffer[pos % _set_->capacity]);                                  \
+                hashes[j] = PFX##_impl_hash(_set_, elements[i + j]);                               \
                                                                                                    \
-                if (target->state == CMC_ES_EMPTY || target->state == CMC_ES_DELETED)              \
-                {                                                                                  \
-                    target->value = element;                                                       \
-                    target->dist = pos - original_pos;                                             \
-                    target->state = CMC_ES_FILLED;                                                 \
+                CMC_IMPL_HASHTABLE_PREFETCH(&(_set_->buffer[PFX##_impl_home(_set_, hashes[j])]));  \
+            }                                                                                      \
                                                                                                    \
-                    break;                                                                         \
-                }                                                                                  \
-                else if (target->dist < pos - original_pos)                                        \
-                {                                                                                  \
-                    V tmp = target->value;                                                         \
-                    size_t tmp_dist = target->dist;                                                \
+            for (size_t j = 0; j < batch; j++)                                                     \
+            {                                                                                      \
+                V element = elements[i + j];                                                       \
                                                                                                    \
-                    target->value = element;                                                       \
-                    target->dist = pos - original_pos;                                             \
+                /* Let insert deal with distances that do not fit */                               \
+                if (PFX##_capacity(_set_) > CMC_ES_DIST_MAX &&                                     \
+                    PFX##_impl_dist_overflow(_set_, hashes[j]))                                    \
+                {                                                                                  \
+                    if (PFX##_insert(_set_, element))                                              \
+                        total++;                                                                   \
                                                                                                    \
-                    element = tmp;                                                                 \
-                    original_pos = pos - tmp_dist;                                                 \
+                    continue;                                                                      \
                 }                                                                                  \
+                                                                                                   \
+                if (PFX##_impl_insert_entry(_set_, element, hashes[j], true))                      \
+                    total++;                                                                       \
             }                                                                                      \
         }                                                                                          \
                                                                                                    \
-        _set_->count++;                                                                            \
-                                                                                                   \
-        return true;                                                                               \
+        return total;                                                                              \
     }                                                                                              \
                                                                                                    \
     bool PFX##_remove(struct SNAME *_set_, V element)                                              \
@@ -360,15 +1034,51 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         if (result == NULL)                                                                        \
             return false;                                                                          \
                                                                                                    \
-        result->value = (V){0};                                                                    \
-        result->dist = 0;                                                                          \
-        result->state = CMC_ES_DELETED;                                                            \
+        PFX##_impl_remove_entry(_set_, result);                                                    \
                                                                                                    \
         _set_->count--;                                                                            \
                                                                                                    \
+        PFX##_impl_low_water(_set_);                                                               \
+                                                                                                   \
         return true;                                                                               \
     }                                                                                              \
                                                                                                    \
+    /* Removes every element for which pred is true in a single sweep of */                        \
+    /* the buffer. Returns how many were removed */                                                \
+    size_t PFX##_remove_if(struct SNAME *_set_, bool (*pred)(V), void (*deallocator)(V))           \
+    {                                                                                              \
+        size_t removed = 0;                                                                        \
+                                                                                                   \
+        /* Backward shift deletion moves the following entry into the slot */                      \
+        /* that was just emptied, so the same position is checked again */                         \
+        for (size_t i = PFX##_impl_next_filled(_set_, 0); i < _set_->capacity;                     \
+             i = PFX##_impl_next_filled(_set_, i))                                                 \
+        {                                                                                          \
+            struct SNAME##_entry *entry = &(_set_->buffer[i]);                                     \
+                                                                                                   \
+            if (pred(entry->value))                                                                \
+            {                                                                                      \
+                V value = entry->value;                                                            \
+                                                                                                   \
+                PFX##_impl_remove_entry(_set_, entry);                                             \
+                                                                                                   \
+                if (deallocator)                                                                   \
+                    deallocator(value);                                                            \
+                                                                                                   \
+                removed++;                                                                         \
+            }                                                                                      \
+            else                                                                                   \
+                i++;                                                                               \
+        }                                                                                          \
+                                                                                                   \
+        _set_->count -= removed;                                                                   \
+                                                                                                   \
+        if (removed > 0)                                                                           \
+            PFX##_impl_low_water(_set_);                                                           \
+                                                                                                   \
+        return removed;                                                                            \
+    }                                                                                              \
+                                                                                                   \
     bool PFX##_max(struct SNAME *_set_, V *value)                                                  \
     {                                                                                              \
         if (PFX##_empty(_set_))                                                                    \
@@ -383,7 +1093,7 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
             if (index == 0)                                                                        \
                 *value = result;                                                                   \
-            else if (_set_->cmp(result, *value) > 0)                                               \
+            else if (PFX##_impl_cmp(_set_, result, *value) > 0)                                    \
                 *value = result;                                                                   \
         }                                                                                          \
                                                                                                    \
@@ -404,7 +1114,7 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
             if (index == 0)                                                                        \
                 *value = result;                                                                   \
-            else if (_set_->cmp(result, *value) < 0)                                               \
+            else if (PFX##_impl_cmp(_set_, result, *value) < 0)                                    \
                 *value = result;                                                                   \
         }                                                                                          \
                                                                                                    \
@@ -416,6 +1126,31 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return PFX##_impl_get_entry(_set_, element) != NULL;                                       \
     }                                                                                              \
                                                                                                    \
+    size_t PFX##_contains_many(struct SNAME *_set_, V *elements, size_t n, bool *found)            \
+    {                                                                                              \
+        struct SNAME##_entry *entries[CMC_IMPL_HASHTABLE_BATCH];                                   \
+                                                                                                   \
+        size_t total = 0;                                                                          \
+                                                                                                   \
+        for (size_t i = 0; i < n; i += CMC_IMPL_HASHTABLE_BATCH)                                   \
+        {                                                                                          \
+            size_t batch = n - i < CMC_IMPL_HASHTABLE_BATCH ? n - i : CMC_IMPL_HASHTABLE_BATCH;    \
+                                                                                                   \
+            PFX##_impl_get_batch(_set_, elements + i, batch, entries);                             \
+                                                                                                   \
+            for (size_t j = 0; j < batch; j++)                                                     \
+            {                                                                                      \
+                if (entries[j])                                                                    \
+                    total++;                                                                       \
+                                                                                                   \
+                if (found)                                                                         \
+                    found[i + j] = entries[j] != NULL;                                             \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        return total;                                                                              \
+    }                                                                                              \
+                                                                                                   \
     bool PFX##_empty(struct SNAME *_set_)                                                          \
     {                                                                                              \
         return _set_->count == 0;                                                                  \
@@ -423,6 +1158,10 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
     bool PFX##_full(struct SNAME *_set_)                                                           \
     {                                                                                              \
+        /* Small tables use every one of their entries */                                          \
+        if (CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_set_))                                       \
+            return PFX##_count(_set_) >= PFX##_capacity(_set_);                                    \
+                                                                                                   \
         return (double)PFX##_capacity(_set_) * PFX##_load(_set_) <= (double)PFX##_count(_set_);    \
     }                                                                                              \
                                                                                                    \
@@ -431,6 +1170,16 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return _set_->count;                                                                       \
     }                                                                                              \
                                                                                                    \
+    size_t PFX##_memory_usage(struct SNAME *_set_)                                                 \
+    {                                                                                              \
+        size_t bytes = sizeof(struct SNAME) + CMC_IMPL_HASHTABLE_OCCUPANCY_BYTES(_set_);           \
+                                                                                                   \
+        if (!CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_set_))                                      \
+            bytes += sizeof(struct SNAME##_entry) * _set_->capacity;                               \
+                                                                                                   \
+        return bytes;                                                                              \
+    }                                                                                              \
+                                                                                                   \
     size_t PFX##_capacity(struct SNAME *_set_)                                                     \
     {                                                                                              \
         return _set_->capacity;                                                                    \
@@ -441,95 +1190,150 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return _set_->load;                                                                        \
     }                                                                                              \
                                                                                                    \
-    bool PFX##_resize(struct SNAME *_set_, size_t capacity)                                        \
+    void PFX##_stats(struct SNAME *_set_, struct cmc_hashtable_stats *out)                         \
     {                                                                                              \
-        if (PFX##_capacity(_set_) == capacity)                                                     \
-            return true;                                                                           \
+        memset(out, 0, sizeof(struct cmc_hashtable_stats));                                        \
                                                                                                    \
-        if (PFX##_capacity(_set_) > capacity / PFX##_load(_set_))                                  \
-            return true;                                                                           \
+        out->capacity = _set_->capacity;                                                           \
+        out->count = _set_->count;                                                                 \
+        out->bytes = sizeof(struct SNAME);                                                         \
                                                                                                    \
-        /* Prevent integer overflow */                                                             \
-        if (capacity >= UINTMAX_MAX * PFX##_load(_set_))                                           \
-            return false;                                                                          \
+        if (!CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_set_))                                      \
+            out->bytes += sizeof(struct SNAME##_entry) * _set_->capacity;                          \
                                                                                                    \
-        /* Calculate required capacity based on the prime numbers */                               \
-        size_t theoretical_size = PFX##_impl_calculate_size(capacity);                             \
+        if (CMC_IMPL_HASHTABLE_OCCUPIED(_set_))                                                    \
+            out->bytes += sizeof(uint64_t) * cmc_occupancy_words(_set_->capacity);                 \
                                                                                                    \
-        /* Not possible to shrink with current available prime numbers */                          \
-        if (theoretical_size < PFX##_count(_set_) / PFX##_load(_set_))                             \
-            return false;                                                                          \
+        for (size_t i = 0; i < _set_->capacity; i++)                                               \
+        {                                                                                          \
+            struct SNAME##_entry *entry = &(_set_->buffer[i]);                                     \
                                                                                                    \
-        struct SNAME *_new_set_ = PFX##_new(capacity, PFX##_load(_set_), _set_->cmp, _set_->hash); \
+            if (entry->state == CMC_ES_FILLED)                                                     \
+                cmc_hashtable_stats_add(out, entry->dist);                                         \
+            else if (entry->state == CMC_ES_DELETED)                                               \
+                out->tombstones++;                                                                 \
+        }                                                                                          \
                                                                                                    \
-        if (!_new_set_)                                                                            \
-            return false;                                                                          \
+        CMC_IMPL_HASHTABLE_PROBE_ADD(out, _set_);                                                  \
                                                                                                    \
-        struct SNAME##_iter iter;                                                                  \
+        cmc_hashtable_stats_end(out);                                                              \
+    }                                                                                              \
                                                                                                    \
-        for (PFX##_iter_init(&iter, _set_); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))        \
-        {                                                                                          \
-            V value = PFX##_iter_value(&iter);                                                     \
+    bool PFX##_resize(struct SNAME *_set_, size_t capacity)                                        \
+    {                                                                                              \
+        if (PFX##_capacity(_set_) == capacity)                                                     \
+            return true;                                                                           \
                                                                                                    \
-            PFX##_insert(_new_set_, value);                                                        \
-        }                                                                                          \
+        if (PFX##_capacity(_set_) > capacity / PFX##_load(_set_))                                  \
+            return true;                                                                           \
                                                                                                    \
-        if (PFX##_count(_set_) != PFX##_count(_new_set_))                                          \
-        {                                                                                          \
-            PFX##_free(_new_set_, NULL);                                                           \
+        /* Prevent integer overflow */                                                             \
+        if (capacity >= UINTMAX_MAX * PFX##_load(_set_))                                           \
             return false;                                                                          \
-        }                                                                                          \
                                                                                                    \
-        struct SNAME##_entry *tmp_b = _set_->buffer;                                               \
-        _set_->buffer = _new_set_->buffer;                                                         \
-        _new_set_->buffer = tmp_b;                                                                 \
+        /* Calculate required capacity based on the prime numbers */                               \
+        size_t theoretical_size = PFX##_impl_calculate_size(capacity);                             \
                                                                                                    \
-        size_t tmp_c = _set_->capacity;                                                            \
-        _set_->capacity = _new_set_->capacity;                                                     \
-        _new_set_->capacity = tmp_c;                                                               \
+        /* Not possible to shrink with current available prime numbers */                          \
+        if (theoretical_size < PFX##_count(_set_) / PFX##_load(_set_))                             \
+            return false;                                                                          \
                                                                                                    \
-        PFX##_free(_new_set_, NULL);                                                               \
+        return PFX##_impl_rehash(_set_, capacity);                                                 \
+    }                                                                                              \
                                                                                                    \
-        return true;                                                                               \
+    bool PFX##_shrink_to_fit(struct SNAME *_set_)                                                  \
+    {                                                                                              \
+        return PFX##_impl_shrink(_set_, PFX##_count(_set_));                                       \
     }                                                                                              \
                                                                                                    \
     struct SNAME *PFX##_copy_of(struct SNAME *_set_, V (*copy_func)(V))                            \
     {                                                                                              \
-        struct SNAME *result = PFX##_new(_set_->capacity, _set_->load, _set_->cmp, _set_->hash);   \
+        struct SNAME *result = PFX##_new_custom(_set_->capacity, _set_->load, _set_->cmp,          \
+                                                _set_->hash, _set_->alloc);                        \
                                                                                                    \
-        if (!result)                                                                               \
+        if (CMC_UNLIKELY(!result))                                                                 \
             return NULL;                                                                           \
                                                                                                    \
-        if (copy_func)                                                                             \
+        /* Entries are copied to the same positions so both buffers must */                        \
+        /* have the same size */                                                                   \
+        if (result->capacity != _set_->capacity)                                                   \
         {                                                                                          \
-            for (size_t i = 0; i < _set_->capacity; i++)                                           \
+            struct SNAME##_entry *buffer = _set_->alloc->calloc(_set_->capacity,                   \
+                                                                sizeof(struct SNAME##_entry));     \
+                                                                                                   \
+            if (CMC_UNLIKELY(!buffer))                                                             \
             {                                                                                      \
-                struct SNAME##_entry *scan = &(_set_->buffer[i]);                                  \
+                PFX##_free(result, NULL);                                                          \
+                return NULL;                                                                       \
+            }                                                                                      \
                                                                                                    \
-                if (scan->state != CMC_ES_EMPTY)                                                   \
-                {                                                                                  \
-                    struct SNAME##_entry *target = &(result->buffer[i]);                           \
+            PFX##_impl_free_buffer(result);                                                        \
+            result->buffer = buffer;                                                               \
+            result->capacity = _set_->capacity;                                                    \
+            result->fastmod = cmc_fastmod_new(result->capacity);                                   \
                                                                                                    \
-                    if (scan->state == CMC_ES_DELETED)                                             \
-                        target->state = CMC_ES_DELETED;                                            \
-                    else                                                                           \
-                    {                                                                              \
-                        target->state = scan->state;                                               \
-                        target->dist = scan->dist;                                                 \
+            CMC_IMPL_HASHTABLE_OCCUPANCY_FREE(result);                                             \
+            CMC_IMPL_HASHTABLE_OCCUPANCY_NEW(result);                                              \
+        }                                                                                          \
                                                                                                    \
-                        target->value = copy_func(scan->value);                                    \
-                    }                                                                              \
-                }                                                                                  \
+        memcpy(result->buffer, _set_->buffer, sizeof(struct SNAME##_entry) * _set_->capacity);     \
+                                                                                                   \
+        uint64_t *bits = CMC_IMPL_HASHTABLE_OCCUPIED(result);                                      \
+        uint64_t *source = CMC_IMPL_HASHTABLE_OCCUPIED(_set_);                                     \
+                                                                                                   \
+        if (bits && source)                                                                        \
+            memcpy(bits, source, sizeof(uint64_t) * cmc_occupancy_words(_set_->capacity));         \
+        else                                                                                       \
+            PFX##_impl_occupancy_fill(result);                                                     \
+                                                                                                   \
+        /* Only filled slots have something to copy */                                             \
+        if (copy_func)                                                                             \
+        {                                                                                          \
+            for (size_t i = PFX##_impl_next_filled(_set_, 0); i < _set_->capacity;                 \
+                 i = PFX##_impl_next_filled(_set_, i + 1))                                         \
+            {                                                                                      \
+                result->buffer[i].value = copy_func(_set_->buffer[i].value);                       \
             }                                                                                      \
         }                                                                                          \
-        else                                                                                       \
-            memcpy(result->buffer, _set_->buffer, sizeof(struct SNAME##_entry) * _set_->capacity); \
                                                                                                    \
         result->count = _set_->count;                                                              \
                                                                                                    \
+        /* Copies made by copy_func might not hash as the originals do */                          \
+        CMC_IMPL_HASHTABLE_FINGERPRINTED(result->fingerprint = copy_func                           \
+                                             ? PFX##_impl_fingerprint(result)                      \
+                                             : _set_->fingerprint;)                                \
+                                                                                                   \
         return result;                                                                             \
     }                                                                                              \
                                                                                                    \
+    /* Copies up to size elements, in the order of the buffer, to elements */                      \
+    /* and returns how many were copied */                                                         \
+    size_t PFX##_to_array(struct SNAME *_set_, V *CMC_RESTRICT elements, size_t size)              \
+    {                                                                                              \
+        size_t j = 0;                                                                              \
+                                                                                                   \
+        for (size_t i = PFX##_impl_next_filled(_set_, 0); i < _set_->capacity && j < size;         \
+             i = PFX##_impl_next_filled(_set_, i + 1))                                             \
+            elements[j++] = _set_->buffer[i].value;                                                \
+                                                                                                   \
+        return j;                                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    /* A parallel scan has one slot for each slot of the buffer */                                 \
+    size_t PFX##_parallel_slots(struct SNAME *_set_)                                               \
+    {                                                                                              \
+        return _set_->capacity;                                                                    \
+    }                                                                                              \
+                                                                                                   \
+    /* Splits the buffer into ranges of slots, one for each of up to the given */                  \
+    /* amount of threads, and combines the results of each range */                                \
+    V PFX##_parallel_reduce(struct SNAME *_set_, V initial, V (*reduce)(V, V),                     \
+                            V (*combine)(V, V), size_t threads)                                    \
+    {                                                                                              \
+        return PFX##_impl_parallel_reduce(_set_, _set_->capacity, initial, reduce, combine,        \
+                                          threads);                                                \
+    }                                                                                              \
+                                                                                                   \
     bool PFX##_equals(struct SNAME *_set1_, struct SNAME *_set2_)                                  \
     {                                                                                              \
         if (PFX##_count(_set1_) != PFX##_count(_set2_))                                            \
@@ -538,6 +1342,10 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         if (PFX##_count(_set1_) == 0)                                                              \
             return true;                                                                           \
                                                                                                    \
+        /* Sets with the same elements always have the same fingerprint */                         \
+        if (CMC_IMPL_HASHTABLE_FINGERPRINT_DIFFERS(_set1_, _set2_))                                \
+            return false;                                                                          \
+                                                                                                   \
         struct SNAME##_iter iter;                                                                  \
         PFX##_iter_init(&iter, _set1_);                                                            \
                                                                                                    \
@@ -550,6 +1358,13 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return true;                                                                               \
     }                                                                                              \
                                                                                                    \
+    size_t PFX##_fingerprint(struct SNAME *_set_)                                                  \
+    {                                                                                              \
+        CMC_IMPL_HASHTABLE_FINGERPRINTED(return _set_->fingerprint;)                               \
+                                                                                                   \
+        return PFX##_impl_fingerprint(_set_);                                                      \
+    }                                                                                              \
+                                                                                                   \
     struct cmc_string PFX##_to_string(struct SNAME *_set_)                                         \
     {                                                                                              \
         struct cmc_string str;                                                                     \
@@ -562,42 +1377,100 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return str;                                                                                \
     }                                                                                              \
                                                                                                    \
-    struct SNAME *PFX##_union(struct SNAME *_set1_, struct SNAME *_set2_)                          \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE)                                 \
+                                                                                                   \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE, (V))                                   \
+                                                                                                   \
+    bool PFX##_save(struct SNAME *_set_, FILE *file, bool (*writer)(V, FILE *))                    \
     {                                                                                              \
-        struct SNAME *_set_r_ = PFX##_new(_set1_->capacity, _set1_->load, _set1_->cmp,             \
-                                          _set1_->hash);                                           \
+        uint32_t flags = writer ? 0 : CMC_SERIAL_RAW_VALUES;                                       \
                                                                                                    \
-        if (!_set_r_)                                                                              \
-            return NULL;                                                                           \
+        /* The entries of a small table are not laid out like a hashtable */                       \
+        if (!writer && !CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_set_))                           \
+            flags |= CMC_SERIAL_LAYOUT;                                                            \
                                                                                                    \
-        struct SNAME##_iter iter1, iter2;                                                          \
-        PFX##_iter_init(&iter1, _set1_);                                                           \
-        PFX##_iter_init(&iter2, _set2_);                                                           \
+        if (!cmc_serial_write_header(file, "hashset", flags, 0, sizeof(V),                         \
+                                     sizeof(struct SNAME##_entry), _set_->count,                   \
+                                     _set_->capacity, _set_->load))                                \
+            return false;                                                                          \
                                                                                                    \
-        for (PFX##_iter_to_start(&iter1); !PFX##_iter_end(&iter1); PFX##_iter_next(&iter1))        \
+        /* Without a writer the buffer is written as it is in memory */                            \
+        if (flags & CMC_SERIAL_LAYOUT)                                                             \
+            return fwrite(_set_->buffer, sizeof(struct SNAME##_entry), _set_->capacity, file) ==   \
+                   _set_->capacity;                                                                \
+                                                                                                   \
+        for (size_t i = PFX##_impl_next_filled(_set_, 0); i < _set_->capacity;                     \
+             i = PFX##_impl_next_filled(_set_, i + 1))                                             \
         {                                                                                          \
-            PFX##_insert(_set_r_, PFX##_iter_value(&iter1));                                       \
+            if (!CMC_SERIAL_WRITE(writer, _set_->buffer[i].value, file))                           \
+                return false;                                                                      \
         }                                                                                          \
                                                                                                    \
-        for (PFX##_iter_to_start(&iter2); !PFX##_iter_end(&iter2); PFX##_iter_next(&iter2))        \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* A set saved without a writer is loaded without hashing its elements */                      \
+    /* so it must be given the same hash function it was saved with */                             \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(V, V), size_t (*hash)(V),               \
+                                bool (*reader)(V *, FILE *))                                       \
+    {                                                                                              \
+        struct cmc_serial_header header;                                                           \
+                                                                                                   \
+        if (!cmc_serial_read_header(file, "hashset", 0, sizeof(V), &header))                       \
+            return NULL;                                                                           \
+                                                                                                   \
+        if (header.flags & CMC_SERIAL_LAYOUT)                                                      \
+            return PFX##_impl_load_layout(file, compare, hash, &header);                           \
+                                                                                                   \
+        /* Allocated for every element so that loading never grows */                              \
+        struct SNAME *_set_ =                                                                      \
+            PFX##_new(header.count > 0 ? header.count : 1, header.load, compare, hash);            \
+                                                                                                   \
+        if (!_set_)                                                                                \
+            return NULL;                                                                           \
+                                                                                                   \
+        bool raw = header.flags & CMC_SERIAL_RAW_VALUES;                                           \
+                                                                                                   \
+        for (size_t i = 0; i < header.count; i++)                                                  \
         {                                                                                          \
-            PFX##_insert(_set_r_, PFX##_iter_value(&iter2));                                       \
+            V value;                                                                               \
+                                                                                                   \
+            if (!CMC_SERIAL_READ(raw, reader, &value, file) || !PFX##_insert(_set_, value))        \
+            {                                                                                      \
+                PFX##_free(_set_, NULL);                                                           \
+                return NULL;                                                                       \
+            }                                                                                      \
         }                                                                                          \
                                                                                                    \
-        return _set_r_;                                                                            \
+        return _set_;                                                                              \
     }                                                                                              \
                                                                                                    \
-    struct SNAME *PFX##_intersection(struct SNAME *_set1_, struct SNAME *_set2_)                   \
+                                                                                                   \
+    struct SNAME *PFX##_union(struct SNAME *_set1_, struct SNAME *_set2_)                          \
     {                                                                                              \
-        struct SNAME *_set_r_ = PFX##_new(_set1_->capacity, _set1_->load, _set1_->cmp,             \
-                                          _set1_->hash);                                           \
+        struct SNAME *_set_r_ =                                                                    \
+            PFX##_impl_new_sized(_set1_, PFX##_count(_set1_) + PFX##_count(_set2_));               \
                                                                                                    \
         if (!_set_r_)                                                                              \
             return NULL;                                                                           \
                                                                                                    \
+        PFX##_union_into(_set_r_, _set1_);                                                         \
+        PFX##_union_into(_set_r_, _set2_);                                                         \
+                                                                                                   \
+        return _set_r_;                                                                            \
+    }                                                                                              \
+                                                                                                   \
+    struct SNAME *PFX##_intersection(struct SNAME *_set1_, struct SNAME *_set2_)                   \
+    {                                                                                              \
         struct SNAME *_set_A_ = _set1_->count < _set2_->count ? _set1_ : _set2_;                   \
         struct SNAME *_set_B_ = _set_A_ == _set1_ ? _set2_ : _set1_;                               \
                                                                                                    \
+        /* The intersection is never bigger than the smaller set */                                \
+        struct SNAME *_set_r_ = PFX##_impl_new_sized(_set1_, PFX##_count(_set_A_));                \
+                                                                                                   \
+        if (!_set_r_)                                                                              \
+            return NULL;                                                                           \
+                                                                                                   \
         struct SNAME##_iter iter;                                                                  \
         PFX##_iter_init(&iter, _set_A_);                                                           \
                                                                                                    \
@@ -614,8 +1487,7 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
     struct SNAME *PFX##_difference(struct SNAME *_set1_, struct SNAME *_set2_)                     \
     {                                                                                              \
-        struct SNAME *_set_r_ = PFX##_new(_set1_->capacity, _set1_->load, _set1_->cmp,             \
-                                          _set1_->hash);                                           \
+        struct SNAME *_set_r_ = PFX##_impl_new_sized(_set1_, PFX##_count(_set1_));                 \
                                                                                                    \
         if (!_set_r_)                                                                              \
             return NULL;                                                                           \
@@ -638,8 +1510,8 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
     {                                                                                              \
         struct SNAME##_iter iter1, iter2;                                                          \
                                                                                                    \
-        struct SNAME *_set_r_ = PFX##_new(_set1_->capacity, _set1_->load, _set1_->cmp,             \
-                                          _set1_->hash);                                           \
+        struct SNAME *_set_r_ =                                                                    \
+            PFX##_impl_new_sized(_set1_, PFX##_count(_set1_) + PFX##_count(_set2_));               \
                                                                                                    \
         if (!_set_r_)                                                                              \
             return NULL;                                                                           \
@@ -666,6 +1538,102 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return _set_r_;                                                                            \
     }                                                                                              \
                                                                                                    \
+    bool PFX##_union_into(struct SNAME *_set1_, struct SNAME *_set2_)                              \
+    {                                                                                              \
+        /* Grow once for both operands instead of one threshold at a time */                       \
+        if (CMC_UNLIKELY(!PFX##_resize(_set1_, PFX##_count(_set1_) + PFX##_count(_set2_))))        \
+            return false;                                                                          \
+                                                                                                   \
+        struct SNAME##_iter iter;                                                                  \
+        PFX##_iter_init(&iter, _set2_);                                                            \
+                                                                                                   \
+        for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))           \
+        {                                                                                          \
+            PFX##_insert(_set1_, PFX##_iter_value(&iter));                                         \
+        }                                                                                          \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_intersect_with(struct SNAME *_set1_, struct SNAME *_set2_)                          \
+    {                                                                                              \
+        if (PFX##_count(_set1_) <= PFX##_count(_set2_))                                            \
+        {                                                                                          \
+            PFX##_impl_retain(_set1_, _set2_, true);                                               \
+                                                                                                   \
+            return true;                                                                           \
+        }                                                                                          \
+                                                                                                   \
+        /* Probing from _set2_ touches far fewer entries than scanning _set1_ */                   \
+        /* and the result always fits in a table sized after _set2_ */                             \
+        struct SNAME *_set_r_ = PFX##_impl_new_sized(_set1_, PFX##_count(_set2_));                 \
+                                                                                                   \
+        if (!_set_r_)                                                                              \
+            return false;                                                                          \
+                                                                                                   \
+        struct SNAME##_iter iter;                                                                  \
+        PFX##_iter_init(&iter, _set2_);                                                            \
+                                                                                                   \
+        for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))           \
+        {                                                                                          \
+            struct SNAME##_entry *entry = PFX##_impl_get_entry(_set1_, PFX##_iter_value(&iter));   \
+                                                                                                   \
+            /* Keep the element owned by _set1_ */                                                 \
+            if (entry != NULL)                                                                     \
+                PFX##_insert(_set_r_, entry->value);                                               \
+        }                                                                                          \
+                                                                                                   \
+        /* The entries of small tables are part of their struct so the */                          \
+        /* elements are inserted back instead */                                                   \
+        if (CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_set1_) ||                                    \
+            CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_set_r_))                                     \
+        {                                                                                          \
+            PFX##_clear(_set1_, NULL);                                                             \
+            PFX##_union_into(_set1_, _set_r_);                                                     \
+            PFX##_free(_set_r_, NULL);                                                             \
+                                                                                                   \
+            return PFX##_shrink_to_fit(_set1_);                                                    \
+        }                                                                                          \
+                                                                                                   \
+        struct SNAME##_entry *tmp_b = _set1_->buffer;                                              \
+        _set1_->buffer = _set_r_->buffer;                                                          \
+        _set_r_->buffer = tmp_b;                                                                   \
+                                                                                                   \
+        size_t tmp_c = _set1_->capacity;                                                           \
+        _set1_->capacity = _set_r_->capacity;                                                      \
+        _set_r_->capacity = tmp_c;                                                                 \
+        _set1_->fastmod = cmc_fastmod_new(_set1_->capacity);                                       \
+        _set_r_->fastmod = cmc_fastmod_new(_set_r_->capacity);                                     \
+                                                                                                   \
+        CMC_IMPL_HASHTABLE_OCCUPANCY_SWAP(_set1_, _set_r_);                                        \
+                                                                                                   \
+        _set1_->count = _set_r_->count;                                                            \
+                                                                                                   \
+        CMC_IMPL_HASHTABLE_FINGERPRINTED(_set1_->fingerprint = _set_r_->fingerprint;)              \
+                                                                                                   \
+        PFX##_free(_set_r_, NULL);                                                                 \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    void PFX##_subtract(struct SNAME *_set1_, struct SNAME *_set2_)                                \
+    {                                                                                              \
+        if (PFX##_count(_set1_) <= PFX##_count(_set2_))                                            \
+        {                                                                                          \
+            PFX##_impl_retain(_set1_, _set2_, false);                                              \
+                                                                                                   \
+            return;                                                                                \
+        }                                                                                          \
+                                                                                                   \
+        struct SNAME##_iter iter;                                                                  \
+        PFX##_iter_init(&iter, _set2_);                                                            \
+                                                                                                   \
+        for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))           \
+        {                                                                                          \
+            PFX##_remove(_set1_, PFX##_iter_value(&iter));                                         \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
     /* Is _set1_ a subset of _set2_ ? */                                                           \
     /* A set X is a subset of a set Y when: X <= Y */                                              \
     /* If X is a subset of Y, then Y is a superset of X */                                         \
@@ -755,15 +1723,18 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         if (PFX##_empty(_set1_))                                                                   \
             return true;                                                                           \
                                                                                                    \
+        struct SNAME *_set_A_ = _set1_->count < _set2_->count ? _set1_ : _set2_;                   \
+        struct SNAME *_set_B_ = _set_A_ == _set1_ ? _set2_ : _set1_;                               \
+                                                                                                   \
         struct SNAME##_iter iter;                                                                  \
                                                                                                    \
-        PFX##_iter_init(&iter, _set1_);                                                            \
+        PFX##_iter_init(&iter, _set_A_);                                                           \
                                                                                                    \
         for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))           \
         {                                                                                          \
             V value = PFX##_iter_value(&iter);                                                     \
                                                                                                    \
-            if (PFX##_contains(_set2_, value))                                                     \
+            if (PFX##_contains(_set_B_, value))                                                    \
                 return false;                                                                      \
         }                                                                                          \
                                                                                                    \
@@ -772,9 +1743,9 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
     struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                      \
     {                                                                                              \
-        struct SNAME##_iter *iter = malloc(sizeof(struct SNAME##_iter));                           \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));            \
                                                                                                    \
-        if (!iter)                                                                                 \
+        if (CMC_UNLIKELY(!iter))                                                                   \
             return NULL;                                                                           \
                                                                                                    \
         PFX##_iter_init(iter, target);                                                             \
@@ -784,7 +1755,7 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
     void PFX##_iter_free(struct SNAME##_iter *iter)                                                \
     {                                                                                              \
-        free(iter);                                                                                \
+        iter->target->alloc->free(iter);                                                           \
     }                                                                                              \
                                                                                                    \
     void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                          \
@@ -797,25 +1768,9 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
         if (!PFX##_empty(target))                                                                  \
         {                                                                                          \
-            for (size_t i = 0; i < target->capacity; i++)                                          \
-            {                                                                                      \
-                if (target->buffer[i].state == CMC_ES_FILLED)                                      \
-                {                                                                                  \
-                    iter->first = i;                                                               \
-                    break;                                                                         \
-                }                                                                                  \
-            }                                                                                      \
-                                                                                                   \
+            iter->first = PFX##_impl_next_filled(target, 0);                                       \
+            iter->last = PFX##_impl_prev_filled(target, target->capacity - 1);                     \
             iter->cursor = iter->first;                                                            \
-                                                                                                   \
-            for (size_t i = target->capacity; i > 0; i--)                                          \
-            {                                                                                      \
-                if (target->buffer[i - 1].state == CMC_ES_FILLED)                                  \
-                {                                                                                  \
-                    iter->last = i - 1;                                                            \
-                    break;                                                                         \
-                }                                                                                  \
-            }                                                                                      \
         }                                                                                          \
     }                                                                                              \
                                                                                                    \
@@ -864,18 +1819,8 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
         iter->start = PFX##_empty(iter->target);                                                   \
                                                                                                    \
-        struct SNAME##_entry *scan = &(iter->target->buffer[iter->cursor]);                        \
-                                                                                                   \
         iter->index++;                                                                             \
-                                                                                                   \
-        while (1)                                                                                  \
-        {                                                                                          \
-            iter->cursor++;                                                                        \
-            scan = &(iter->target->buffer[iter->cursor]);                                          \
-                                                                                                   \
-            if (scan->state == CMC_ES_FILLED)                                                      \
-                break;                                                                             \
-        }                                                                                          \
+        iter->cursor = PFX##_impl_next_filled(iter->target, iter->cursor + 1);                     \
                                                                                                    \
         return true;                                                                               \
     }                                                                                              \
@@ -893,18 +1838,8 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
         iter->end = PFX##_empty(iter->target);                                                     \
                                                                                                    \
-        struct SNAME##_entry *scan = &(iter->target->buffer[iter->cursor]);                        \
-                                                                                                   \
         iter->index--;                                                                             \
-                                                                                                   \
-        while (1)                                                                                  \
-        {                                                                                          \
-            iter->cursor--;                                                                        \
-            scan = &(iter->target->buffer[iter->cursor]);                                          \
-                                                                                                   \
-            if (scan->state == CMC_ES_FILLED)                                                      \
-                break;                                                                             \
-        }                                                                                          \
+        iter->cursor = PFX##_impl_prev_filled(iter->target, iter->cursor - 1);                     \
                                                                                                    \
         return true;                                                                               \
     }                                                                                              \
@@ -965,6 +1900,18 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return true;                                                                               \
     }                                                                                              \
                                                                                                    \
+    /* Places iter at a slot, for CMC_PARALLEL_FOR_EACH, and tells if it is filled */              \
+    bool PFX##_parallel_iter(struct SNAME##_iter *iter, struct SNAME *target, size_t slot)         \
+    {                                                                                              \
+        memset(iter, 0, sizeof(struct SNAME##_iter));                                              \
+                                                                                                   \
+        iter->target = target;                                                                     \
+        iter->cursor = slot;                                                                       \
+        iter->index = slot;                                                                        \
+                                                                                                   \
+        return slot < target->capacity && target->buffer[slot].state == CMC_ES_FILLED;             \
+    }                                                                                              \
+                                                                                                   \
     V PFX##_iter_value(struct SNAME##_iter *iter)                                                  \
     {                                                                                              \
         if (PFX##_empty(iter->target))                                                             \
@@ -980,35 +1927,553 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
     static struct SNAME##_entry *PFX##_impl_get_entry(struct SNAME *_set_, V element)              \
     {                                                                                              \
-        size_t hash = _set_->hash(element);                                                        \
-        size_t pos = hash % _set_->capacity;                                                       \
+        if (CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_set_))                                       \
+            return PFX##_impl_small_get(_set_, element);                                           \
+                                                                                                   \
+        return PFX##_impl_get_entry_by_hash(_set_, element, PFX##_impl_hash(_set_, element));      \
+    }                                                                                              \
+                                                                                                   \
+    static struct SNAME##_entry *PFX##_impl_get_entry_by_hash(struct SNAME *_set_, V element,      \
+                                                              size_t hash)                         \
+    {                                                                                              \
+        if (CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_set_))                                       \
+            return PFX##_impl_small_get(_set_, element);                                           \
+                                                                                                   \
+        size_t original_pos = PFX##_impl_home(_set_, hash);                                        \
+        size_t pos = original_pos;                                                                 \
                                                                                                    \
         struct SNAME##_entry *target = &(_set_->buffer[pos]);                                      \
                                                                                                    \
-        while (target->state == CMC_ES_FILLED || target->state == CMC_ES_DELETED)                  \
+        CMC_IMPL_HASHTABLE_PROBE_LOOKUP(_set_);                                                    \
+                                                                                                   \
+        /* There are no tombstones so the search stops at the first empty */                       \
+        /* entry or at the first entry closer to its original position */                          \
+        while (target->state == CMC_ES_FILLED && target->dist >= pos - original_pos)               \
         {                                                                                          \
-            if (_set_->cmp(target->value, element) == 0)                                           \
+            CMC_IMPL_HASHTABLE_PROBE_SLOT(_set_);                                                  \
+                                                                                                   \
+            /* CACHED tables skip the comparison when the hashes differ */                         \
+            if (CMC_IMPL_HASHTABLE_##HASHING##_EQUALS(target->hash, hash) &&                       \
+                PFX##_impl_cmp(_set_, target->value, element) == 0)                                \
                 return target;                                                                     \
                                                                                                    \
             pos++;                                                                                 \
-            target = &(_set_->buffer[pos % _set_->capacity]);                                      \
+            target = &(_set_->buffer[PFX##_impl_wrap(_set_, pos)]);                                \
         }                                                                                          \
                                                                                                    \
         return NULL;                                                                               \
     }                                                                                              \
                                                                                                    \
-    static size_t PFX##_impl_calculate_size(size_t required)                                       \
+    /* Looks up at most CMC_IMPL_HASHTABLE_BATCH elements. Every hash is */                        \
+    /* computed and every home slot is prefetched before the first probe so */                     \
+    /* that the cache misses of independent elements overlap */                                    \
+    static void PFX##_impl_get_batch(struct SNAME *_set_, V *elements, size_t n,                   \
+                                     struct SNAME##_entry **entries)                               \
+    {                                                                                              \
+        size_t hashes[CMC_IMPL_HASHTABLE_BATCH];                                                   \
+                                                                                                   \
+        if (CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_set_))                                       \
+        {                                                                                          \
+            for (size_t i = 0; i < n; i++)                                                         \
+                entries[i] = PFX##_impl_small_get(_set_, elements[i]);                             \
+                                                                                                   \
+            return;                                                                                \
+        }                                                                                          \
+                                                                                                   \
+        for (size_t i = 0; i < n; i++)                                                             \
+        {                                                                                          \
+            hashes[i] = PFX##_impl_hash(_set_, elements[i]);                                       \
+                                                                                                   \
+            CMC_IMPL_HASHTABLE_PREFETCH(&(_set_->buffer[PFX##_impl_home(_set_, hashes[i])]));      \
+        }                                                                                          \
+                                                                                                   \
+        for (size_t i = 0; i < n; i++)                                                             \
+            entries[i] = PFX##_impl_get_entry_by_hash(_set_, elements[i], hashes[i]);              \
+    }                                                                                              \
+                                                                                                   \
+    /* Places an element in the set and returns the entry where it ended */                        \
+    /* up. When lookup is true the element is also searched for in the same */                     \
+    /* probe and NULL is returned if it is already there */                                        \
+    static struct SNAME##_entry *PFX##_impl_insert_entry(struct SNAME *_set_, V element,           \
+                                                         size_t hash, bool lookup)                 \
+    {                                                                                              \
+        if (CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_set_))                                       \
+            return PFX##_impl_small_insert(_set_, element, lookup);                                \
+                                                                                                   \
+        size_t original_pos = PFX##_impl_home(_set_, hash);                                        \
+        size_t pos = original_pos;                                                                 \
+                                                                                                   \
+        /* Kept for the fingerprint as hash follows the carried element */                         \
+        CMC_IMPL_HASHTABLE_FINGERPRINTED(size_t inserted = hash;)                                  \
+                                                                                                   \
+        struct SNAME##_entry *target = &(_set_->buffer[pos]);                                      \
+        struct SNAME##_entry *result = NULL;                                                       \
+                                                                                                   \
+        while (target->state == CMC_ES_FILLED)                                                     \
+        {                                                                                          \
+            if (target->dist < pos - original_pos)                                                 \
+            {                                                                                      \
+                V tmp = target->value;                                                             \
+                size_t tmp_dist = target->dist;                                                    \
+                CMC_IMPL_HASHTABLE_##HASHING(size_t tmp_h = target->hash;)                         \
+                                                                                                   \
+                target->value = element;                                                           \
+                target->dist = pos - original_pos;                                                 \
+                CMC_IMPL_HASHTABLE_##HASHING(target->hash = hash;)                                 \
+                                                                                                   \
+                element = tmp;                                                                     \
+                original_pos = pos - tmp_dist;                                                     \
+                CMC_IMPL_HASHTABLE_##HASHING(hash = tmp_h;)                                        \
+                                                                                                   \
+                if (!result)                                                                       \
+                    result = target;                                                               \
+            }                                                                                      \
+            /* Until the first swap this is the same walk as get_entry_by_hash */                  \
+            else if (lookup && !result &&                                                          \
+                     CMC_IMPL_HASHTABLE_##HASHING##_EQUALS(target->hash, hash) &&                  \
+                     PFX##_impl_cmp(_set_, target->value, element) == 0)                           \
+                return NULL;                                                                       \
+                                                                                                   \
+            pos++;                                                                                 \
+            target = &(_set_->buffer[PFX##_impl_wrap(_set_, pos)]);                                \
+        }                                                                                          \
+                                                                                                   \
+        target->value = element;                                                                   \
+        target->dist = pos - original_pos;                                                         \
+        target->state = CMC_ES_FILLED;                                                             \
+        CMC_IMPL_HASHTABLE_##HASHING(target->hash = hash;)                                         \
+                                                                                                   \
+        CMC_IMPL_HASHTABLE_OCCUPY(_set_, (size_t)(target - _set_->buffer));                        \
+                                                                                                   \
+        _set_->count++;                                                                            \
+                                                                                                   \
+        CMC_IMPL_HASHTABLE_FINGERPRINTED(_set_->fingerprint += cmc_hashtable_mix(inserted);)       \
+                                                                                                   \
+        return result ? result : target;                                                           \
+    }                                                                                              \
+                                                                                                   \
+    /* The elements of a small table are together at the start of its entries */                   \
+    static struct SNAME##_entry *PFX##_impl_small_get(struct SNAME *_set_, V element)              \
+    {                                                                                              \
+        CMC_IMPL_HASHTABLE_PROBE_LOOKUP(_set_);                                                    \
+                                                                                                   \
+        for (size_t i = 0; i < _set_->capacity && _set_->buffer[i].state == CMC_ES_FILLED; i++)    \
+        {                                                                                          \
+            CMC_IMPL_HASHTABLE_PROBE_SLOT(_set_);                                                  \
+                                                                                                   \
+            if (PFX##_impl_cmp(_set_, _set_->buffer[i].value, element) == 0)                       \
+                return &(_set_->buffer[i]);                                                        \
+        }                                                                                          \
+                                                                                                   \
+        return NULL;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Same as insert_entry for small tables, which full() makes sure have */                      \
+    /* room for one more element */                                                                \
+    static struct SNAME##_entry *PFX##_impl_small_insert(struct SNAME *_set_, V element,           \
+                                                         bool lookup)                              \
+    {                                                                                              \
+        size_t pos = 0;                                                                            \
+                                                                                                   \
+        for (; pos < _set_->capacity && _set_->buffer[pos].state == CMC_ES_FILLED; pos++)          \
+        {                                                                                          \
+            if (lookup && PFX##_impl_cmp(_set_, _set_->buffer[pos].value, element) == 0)           \
+                return NULL;                                                                       \
+        }                                                                                          \
+                                                                                                   \
+        struct SNAME##_entry *target = &(_set_->buffer[pos]);                                      \
+                                                                                                   \
+        target->value = element;                                                                   \
+        target->dist = 0;                                                                          \
+        target->state = CMC_ES_FILLED;                                                             \
+                                                                                                   \
+        /* CACHED tables still need it once they grow */                                           \
+        CMC_IMPL_HASHTABLE_##HASHING(target->hash = PFX##_impl_hash(_set_, element);)              \
+                                                                                                   \
+        _set_->count++;                                                                            \
+                                                                                                   \
+        CMC_IMPL_HASHTABLE_FINGERPRINTED(                                                          \
+            _set_->fingerprint += cmc_hashtable_mix(PFX##_impl_hash(_set_, element));)             \
+                                                                                                   \
+        return target;                                                                             \
+    }                                                                                              \
+                                                                                                   \
+    /* Moves back the elements that follow the removed one */                                      \
+    static void PFX##_impl_small_remove(struct SNAME *_set_, struct SNAME##_entry *entry)          \
+    {                                                                                              \
+        size_t pos = (size_t)(entry - _set_->buffer);                                              \
+        size_t end = pos + 1;                                                                      \
+                                                                                                   \
+        while (end < _set_->capacity && _set_->buffer[end].state == CMC_ES_FILLED)                 \
+            end++;                                                                                 \
+                                                                                                   \
+        memmove(entry, entry + 1, sizeof(struct SNAME##_entry) * (end - pos - 1));                 \
+                                                                                                   \
+        memset(&(_set_->buffer[end - 1]), 0, sizeof(struct SNAME##_entry));                        \
+    }                                                                                              \
+                                                                                                   \
+    /* Moves the elements of a table with at most CMC_HASHTABLE_SMALL_SIZE */                      \
+    /* of them to the entries of its struct */                                                     \
+    static void PFX##_impl_to_small(struct SNAME *_set_)                                           \
+    {                                                                                              \
+        struct SNAME##_entry *buffer = _set_->buffer;                                              \
+        size_t capacity = _set_->capacity;                                                         \
+        size_t count = 0;                                                                          \
+                                                                                                   \
+        _set_->buffer = CMC_IMPL_HASHTABLE_##STORAGE##_BUFFER(_set_);                              \
+        _set_->capacity = CMC_IMPL_HASHTABLE_##STORAGE##_SIZE;                                     \
+        _set_->fastmod = cmc_fastmod_new(_set_->capacity);                                         \
+                                                                                                   \
+        memset(_set_->buffer, 0, sizeof(struct SNAME##_entry) * _set_->capacity);                  \
+                                                                                                   \
+        for (size_t i = 0; i < capacity; i++)                                                      \
+        {                                                                                          \
+            if (buffer[i].state != CMC_ES_FILLED)                                                  \
+                continue;                                                                          \
+                                                                                                   \
+            _set_->buffer[count] = buffer[i];                                                      \
+            _set_->buffer[count].dist = 0;                                                         \
+            count++;                                                                               \
+        }                                                                                          \
+                                                                                                   \
+        _set_->alloc->free(buffer);                                                                \
+                                                                                                   \
+        CMC_IMPL_HASHTABLE_OCCUPANCY_FREE(_set_);                                                  \
+        CMC_IMPL_HASHTABLE_OCCUPANCY_NONE(_set_);                                                  \
+    }                                                                                              \
+                                                                                                   \
+    /* The buffer of a small table is part of the struct */                                        \
+    static void PFX##_impl_free_buffer(struct SNAME *_set_)                                        \
+    {                                                                                              \
+        if (!CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_set_))                                      \
+            _set_->alloc->free(_set_->buffer);                                                     \
+    }                                                                                              \
+                                                                                                   \
+                                                                                                   \
+    static bool PFX##_impl_dist_overflow(struct SNAME *_set_, size_t hash)                         \
+    {                                                                                              \
+        size_t pos = PFX##_impl_home(_set_, hash);                                                 \
+        size_t dist = 0;                                                                           \
+                                                                                                   \
+        struct SNAME##_entry *target = &(_set_->buffer[pos]);                                      \
+                                                                                                   \
+        /* Follows the steps of an insertion without moving any entry */                           \
+        while (target->state == CMC_ES_FILLED)                                                     \
+        {                                                                                          \
+            /* The entry closer to its original position is the one carried */                     \
+            if (target->dist < dist)                                                               \
+                dist = target->dist;                                                               \
+                                                                                                   \
+            pos++;                                                                                 \
+            dist++;                                                                                \
+                                                                                                   \
+            if (dist > CMC_ES_DIST_MAX)                                                            \
+                return true;                                                                       \
+                                                                                                   \
+            target = &(_set_->buffer[PFX##_impl_wrap(_set_, pos)]);                                \
+        }                                                                                          \
+                                                                                                   \
+        return false;                                                                              \
+    }                                                                                              \
+                                                                                                   \
+    /* Sums the fingerprint in the same way as it would have been kept */                          \
+    static size_t PFX##_impl_fingerprint(struct SNAME *_set_)                                      \
+    {                                                                                              \
+        size_t sum = 0;                                                                            \
+                                                                                                   \
+        for (size_t i = PFX##_impl_next_filled(_set_, 0); i < _set_->capacity;                     \
+             i = PFX##_impl_next_filled(_set_, i + 1))                                             \
+        {                                                                                          \
+            sum += cmc_hashtable_mix(PFX##_impl_hash(_set_, _set_->buffer[i].value));              \
+        }                                                                                          \
+                                                                                                   \
+        return sum;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    static void PFX##_impl_remove_entry(struct SNAME *_set_, struct SNAME##_entry *entry)          \
     {                                                                                              \
-        const size_t count = sizeof(cmc_hashtable_primes) / sizeof(cmc_hashtable_primes[0]);       \
+        CMC_IMPL_HASHTABLE_FINGERPRINTED(_set_->fingerprint -= cmc_hashtable_mix(                  \
+            CMC_IMPL_HASHTABLE_##HASHING##_REHASH(entry->hash,                                     \
+                                                  PFX##_impl_hash(_set_, entry->value)));)         \
+                                                                                                   \
+        if (CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_set_))                                       \
+        {                                                                                          \
+            PFX##_impl_small_remove(_set_, entry);                                                 \
+            return;                                                                                \
+        }                                                                                          \
                                                                                                    \
-        if (cmc_hashtable_primes[count - 1] < required)                                            \
-            return required;                                                                       \
+        size_t pos = (size_t)(entry - _set_->buffer);                                              \
+                                                                                                   \
+        /* Backward shift deletion. Every entry that follows and is not at its */                  \
+        /* original position is moved one position back */                                         \
+        while (true)                                                                               \
+        {                                                                                          \
+            struct SNAME##_entry *next = &(_set_->buffer[PFX##_impl_wrap(_set_, pos + 1)]);        \
+                                                                                                   \
+            if (next->state != CMC_ES_FILLED || next->dist == 0)                                   \
+                break;                                                                             \
                                                                                                    \
-        size_t i = 0;                                                                              \
-        while (cmc_hashtable_primes[i] < required)                                                 \
-            i++;                                                                                   \
+            *entry = *next;                                                                        \
+            entry->dist--;                                                                         \
                                                                                                    \
-        return cmc_hashtable_primes[i];                                                            \
+            entry = next;                                                                          \
+            pos++;                                                                                 \
+        }                                                                                          \
+                                                                                                   \
+        entry->value = (V){0};                                                                     \
+        entry->dist = 0;                                                                           \
+        entry->state = CMC_ES_EMPTY;                                                               \
+        CMC_IMPL_HASHTABLE_##HASHING(entry->hash = 0;)                                             \
+                                                                                                   \
+        CMC_IMPL_HASHTABLE_VACATE(_set_, (size_t)(entry - _set_->buffer));                         \
+    }                                                                                              \
+                                                                                                   \
+    static struct SNAME *PFX##_impl_new_sized(struct SNAME *_set_, size_t count)                   \
+    {                                                                                              \
+        /* A set operation result that takes the load and functions of _set_ */                    \
+        return PFX##_new_custom(count > 0 ? count : 1, _set_->load, _set_->cmp, _set_->hash,       \
+                                _set_->alloc);                                                     \
+    }                                                                                              \
+                                                                                                   \
+    static void PFX##_impl_retain(struct SNAME *_set1_, struct SNAME *_set2_, bool common)         \
+    {                                                                                              \
+        /* Keeps only the elements of _set1_ that are (common) or are not (!common) */             \
+        /* in _set2_. Backward shift deletion moves the following entry into the */                \
+        /* slot that was just emptied, so the same position is checked again */                    \
+        for (size_t i = PFX##_impl_next_filled(_set1_, 0); i < _set1_->capacity;                   \
+             i = PFX##_impl_next_filled(_set1_, i))                                                \
+        {                                                                                          \
+            struct SNAME##_entry *entry = &(_set1_->buffer[i]);                                    \
+                                                                                                   \
+            if ((PFX##_impl_get_entry(_set2_, entry->value) != NULL) != common)                    \
+            {                                                                                      \
+                PFX##_impl_remove_entry(_set1_, entry);                                            \
+                                                                                                   \
+                _set1_->count--;                                                                   \
+            }                                                                                      \
+            else                                                                                   \
+                i++;                                                                               \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    /* Moves every entry to a new buffer sized for capacity entries */                             \
+    static bool PFX##_impl_rehash(struct SNAME *_set_, size_t capacity)                            \
+    {                                                                                              \
+        /* Elements that fit in the entries of the struct are moved there */                       \
+        if (capacity <= CMC_IMPL_HASHTABLE_##STORAGE##_SIZE)                                       \
+        {                                                                                          \
+            if (_set_->count <= CMC_IMPL_HASHTABLE_##STORAGE##_SIZE)                               \
+            {                                                                                      \
+                if (!CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_set_))                              \
+                    PFX##_impl_to_small(_set_);                                                    \
+                                                                                                   \
+                return true;                                                                       \
+            }                                                                                      \
+                                                                                                   \
+            capacity = _set_->count;                                                               \
+        }                                                                                          \
+                                                                                                   \
+        struct SNAME *_new_set_ = PFX##_new_custom(capacity, PFX##_load(_set_), _set_->cmp,        \
+                                                   _set_->hash, _set_->alloc);                     \
+                                                                                                   \
+        if (CMC_UNLIKELY(!_new_set_))                                                              \
+            return false;                                                                          \
+                                                                                                   \
+        for (size_t i = PFX##_impl_next_filled(_set_, 0); i < _set_->capacity;                     \
+             i = PFX##_impl_next_filled(_set_, i + 1))                                             \
+        {                                                                                          \
+            struct SNAME##_entry *entry = &(_set_->buffer[i]);                                     \
+                                                                                                   \
+            /* CACHED tables reuse the stored hash instead of calling hash() */                    \
+            size_t hash =                                                                          \
+                CMC_IMPL_HASHTABLE_##HASHING##_REHASH(entry->hash,                                 \
+                                                      PFX##_impl_hash(_set_, entry->value));       \
+                                                                                                   \
+            if (PFX##_capacity(_new_set_) > CMC_ES_DIST_MAX &&                                     \
+                PFX##_impl_dist_overflow(_new_set_, hash))                                         \
+                break;                                                                             \
+                                                                                                   \
+            PFX##_impl_insert_entry(_new_set_, entry->value, hash, false);                         \
+        }                                                                                          \
+                                                                                                   \
+        if (PFX##_count(_set_) != PFX##_count(_new_set_))                                          \
+        {                                                                                          \
+            PFX##_free(_new_set_, NULL);                                                           \
+            return false;                                                                          \
+        }                                                                                          \
+                                                                                                   \
+        struct SNAME##_entry *tmp_b = _set_->buffer;                                               \
+        _set_->buffer = _new_set_->buffer;                                                         \
+        _new_set_->buffer = tmp_b;                                                                 \
+                                                                                                   \
+        /* The entries of a small table can't be given away so they are left */                    \
+        /* to be freed with the struct */                                                          \
+        if (tmp_b == CMC_IMPL_HASHTABLE_##STORAGE##_BUFFER(_set_))                                 \
+            _new_set_->buffer = CMC_IMPL_HASHTABLE_##STORAGE##_BUFFER(_new_set_);                  \
+                                                                                                   \
+        size_t tmp_c = _set_->capacity;                                                            \
+        _set_->capacity = _new_set_->capacity;                                                     \
+        _new_set_->capacity = tmp_c;                                                               \
+        _set_->fastmod = cmc_fastmod_new(_set_->capacity);                                         \
+        _new_set_->fastmod = cmc_fastmod_new(_new_set_->capacity);                                 \
+                                                                                                   \
+        CMC_IMPL_HASHTABLE_OCCUPANCY_SWAP(_set_, _new_set_);                                       \
+                                                                                                   \
+        PFX##_free(_new_set_, NULL);                                                               \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Called after removals, shrinks the table once it is mostly empty */                         \
+    static void PFX##_impl_low_water(struct SNAME *_set_)                                          \
+    {                                                                                              \
+        double low_water = cmc_hashtable_low_water(_set_->load);                                   \
+                                                                                                   \
+        /* Left with room for as many again so it is not grown right back. */                      \
+        /* This also keeps a SMALL table from moving its keys back into the */                     \
+        /* struct until half of CMC_HASHTABLE_SMALL_SIZE of them are left, */                      \
+        /* so one key more or less around that size doesn't allocate again */                      \
+        if ((double)_set_->count < (double)_set_->capacity * _set_->load * low_water)              \
+            PFX##_impl_shrink(_set_, _set_->count * 2);                                            \
+    }                                                                                              \
+                                                                                                   \
+    /* Rebuilds the table at the smallest size that holds required entries */                      \
+    static bool PFX##_impl_shrink(struct SNAME *_set_, size_t required)                            \
+    {                                                                                              \
+        size_t capacity = required > 0 ? required : 1;                                             \
+                                                                                                   \
+        if (CMC_IMPL_HASHTABLE_##STORAGE##_IN_STRUCT(_set_))                                       \
+            return true;                                                                           \
+                                                                                                   \
+        /* Already as small as the sizing policy allows, unless the elements */                    \
+        /* fit in the entries of the struct */                                                     \
+        if (capacity > CMC_IMPL_HASHTABLE_##STORAGE##_SIZE &&                                      \
+            PFX##_impl_calculate_size(capacity / PFX##_load(_set_)) >= PFX##_capacity(_set_))      \
+            return true;                                                                           \
+                                                                                                   \
+        return PFX##_impl_rehash(_set_, capacity);                                                 \
+    }                                                                                              \
+                                                                                                   \
+    static struct SNAME *PFX##_impl_load_layout(FILE *file, int (*compare)(V, V),                  \
+                                                size_t (*hash)(V),                                 \
+                                                struct cmc_serial_header *header)                  \
+    {                                                                                              \
+        size_t capacity = header->capacity;                                                        \
+                                                                                                   \
+        /* The buffer is only valid for a table of the same sizing and entry */                    \
+        if (header->extra != sizeof(struct SNAME##_entry) || capacity == 0 ||                      \
+            PFX##_impl_calculate_size(capacity) != capacity || header->count > capacity ||         \
+            capacity > SIZE_MAX / sizeof(struct SNAME##_entry))                                    \
+            return NULL;                                                                           \
+                                                                                                   \
+        struct SNAME *_set_ = PFX##_new(1, header->load, compare, hash);                           \
+                                                                                                   \
+        if (CMC_UNLIKELY(!_set_))                                                                  \
+            return NULL;                                                                           \
+                                                                                                   \
+        struct SNAME##_entry *buffer =                                                             \
+            _set_->alloc->malloc(capacity * sizeof(struct SNAME##_entry));                         \
+                                                                                                   \
+        if (!buffer || fread(buffer, sizeof(struct SNAME##_entry), capacity, file) != capacity)    \
+        {                                                                                          \
+            _set_->alloc->free(buffer);                                                            \
+            PFX##_free(_set_, NULL);                                                               \
+            return NULL;                                                                           \
+        }                                                                                          \
+                                                                                                   \
+        PFX##_impl_free_buffer(_set_);                                                             \
+                                                                                                   \
+        _set_->buffer = buffer;                                                                    \
+        _set_->capacity = capacity;                                                                \
+        _set_->fastmod = cmc_fastmod_new(_set_->capacity);                                         \
+                                                                                                   \
+        for (size_t i = 0; i < capacity; i++)                                                      \
+        {                                                                                          \
+            if (buffer[i].state != CMC_ES_FILLED)                                                  \
+                continue;                                                                          \
+                                                                                                   \
+            _set_->count++;                                                                        \
+                                                                                                   \
+            CMC_IMPL_HASHTABLE_FINGERPRINTED(_set_->fingerprint += cmc_hashtable_mix(              \
+                PFX##_impl_hash(_set_, buffer[i].value));)                                         \
+        }                                                                                          \
+                                                                                                   \
+        CMC_IMPL_HASHTABLE_OCCUPANCY_FREE(_set_);                                                  \
+        CMC_IMPL_HASHTABLE_OCCUPANCY_NEW(_set_);                                                   \
+                                                                                                   \
+        PFX##_impl_occupancy_fill(_set_);                                                          \
+                                                                                                   \
+        /* Entries are trusted as they are but their amount is counted */                          \
+        if (_set_->count != header->count)                                                         \
+        {                                                                                          \
+            PFX##_free(_set_, NULL);                                                               \
+            return NULL;                                                                           \
+        }                                                                                          \
+                                                                                                   \
+        return _set_;                                                                              \
+    }                                                                                              \
+                                                                                                   \
+                                                                                                   \
+    /* First filled slot at or after from, or the capacity if there is none */                     \
+    static size_t PFX##_impl_next_filled(struct SNAME *_set_, size_t from)                         \
+    {                                                                                              \
+        uint64_t *bits = CMC_IMPL_HASHTABLE_OCCUPIED(_set_);                                       \
+                                                                                                   \
+        if (bits)                                                                                  \
+            return cmc_occupancy_next(bits, _set_->capacity, from);                                \
+                                                                                                   \
+        while (from < _set_->capacity && _set_->buffer[from].state != CMC_ES_FILLED)               \
+            from++;                                                                                \
+                                                                                                   \
+        return from;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Last filled slot at or before from, or SIZE_MAX if there is none */                         \
+    static size_t PFX##_impl_prev_filled(struct SNAME *_set_, size_t from)                         \
+    {                                                                                              \
+        uint64_t *bits = CMC_IMPL_HASHTABLE_OCCUPIED(_set_);                                       \
+                                                                                                   \
+        if (bits)                                                                                  \
+            return cmc_occupancy_prev(bits, from);                                                 \
+                                                                                                   \
+        for (size_t i = from + 1; i > 0; i--)                                                      \
+        {                                                                                          \
+            if (_set_->buffer[i - 1].state == CMC_ES_FILLED)                                       \
+                return i - 1;                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        return SIZE_MAX;                                                                           \
+    }                                                                                              \
+                                                                                                   \
+    /* Sets the bits of the filled slots of a buffer that was not filled by */                     \
+    /* inserting its entries one by one. The bitmap must be empty */                               \
+    static void PFX##_impl_occupancy_fill(struct SNAME *_set_)                                     \
+    {                                                                                              \
+        uint64_t *bits = CMC_IMPL_HASHTABLE_OCCUPIED(_set_);                                       \
+                                                                                                   \
+        if (!bits)                                                                                 \
+            return;                                                                                \
+                                                                                                   \
+        for (size_t i = 0; i < _set_->capacity; i++)                                               \
+        {                                                                                          \
+            if (_set_->buffer[i].state == CMC_ES_FILLED)                                           \
+                cmc_occupancy_set(bits, i);                                                        \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static size_t PFX##_impl_calculate_size(size_t required)                                       \
+    {                                                                                              \
+        return CMC_IMPL_HASHTABLE_##SIZING##_SIZE(required);                                       \
+    }                                                                                              \
+                                                                                                   \
+    static inline size_t PFX##_impl_home(struct SNAME *_set_, size_t hash)                         \
+    {                                                                                              \
+        return CMC_IMPL_HASHTABLE_##SIZING##_TABLE_HOME(hash, _set_);                              \
+    }                                                                                              \
+                                                                                                   \
+    static inline size_t PFX##_impl_wrap(struct SNAME *_set_, size_t pos)                          \
+    {                                                                                              \
+        return CMC_IMPL_HASHTABLE_##SIZING##_TABLE_WRAP(pos, _set_);                               \
     }                                                                                              \
                                                                                                    \
     static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_set_)                            \
@@ -1028,6 +2493,20 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         PFX##_iter_to_end(&iter);                                                                  \
                                                                                                    \
         return iter;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    static inline int PFX##_impl_cmp(struct SNAME *_set_, V a, V b)                                \
+    {                                                                                              \
+        (void)_set_;                                                                               \
+                                                                                                   \
+        return CMP(a, b);                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static inline size_t PFX##_impl_hash(struct SNAME *_set_, V value)                             \
+    {                                                                                              \
+        (void)_set_;                                                                               \
+                                                                                                   \
+        return HASH(value);                                                                        \
     }
 
 #endif /* CMC_HASHSET_H */
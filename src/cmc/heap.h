@@ -35,17 +35,50 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_growth.h"
+#include "../utl/cmc_serial.h"
+#include "../utl/cmc_sort.h"
 #include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
 
 /* to_string format */
 static const char *cmc_string_fmt_heap = "%s at %p { buffer:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", type:%s, cmp:%p }";
 
+/* A removal shrinks a collection once less than this fraction of what it */
+/* can hold without growing is in use. Define it as 0 to never shrink */
+#ifndef CMC_SHRINK_LOW_WATER
+#define CMC_SHRINK_LOW_WATER 0.25
+#endif
+
+/* Children of each node, at least 2. With more children the heap is not as */
+/* tall, so an element floats up past fewer parents and down through fewer */
+/* levels, each one comparing all the children that are next to each other */
+#ifndef CMC_HEAP_ARITY
+#define CMC_HEAP_ARITY 4
+#endif
+
+/* The buffer starts CMC_HEAP_ARITY - 1 elements into an allocation aligned */
+/* to this size, so the children of a node start at a multiple of */
+/* CMC_HEAP_ARITY elements. When CMC_HEAP_ARITY * sizeof(V) divides it they */
+/* are all in the same cache line */
+#ifndef CMC_CACHE_LINE_SIZE
+#define CMC_CACHE_LINE_SIZE 64
+#endif
+
+/* Also defined by sac/heap.h */
+#ifndef CMC_HEAP_ORDER
+#define CMC_HEAP_ORDER
+
 enum cmc_heap_order
 {
     cmc_max_heap = 1,
     cmc_min_heap = -1
 };
 
+#endif /* CMC_HEAP_ORDER */
+
 #define CMC_GENERATE_HEAP(PFX, SNAME, V)    \
     CMC_GENERATE_HEAP_HEADER(PFX, SNAME, V) \
     CMC_GENERATE_HEAP_SOURCE(PFX, SNAME, V)
@@ -56,6 +89,29 @@ enum cmc_heap_order
 #define CMC_WRAPGEN_HEAP_SOURCE(PFX, SNAME, K, V) \
     CMC_GENERATE_HEAP_SOURCE(PFX, SNAME, V)
 
+/* Same as CMC_GENERATE_HEAP but elements are compared by calling CMP */
+/* directly, so the compiler can inline it. The function given to new is */
+/* still stored but only used by copy_of and to_string */
+#define CMC_GENERATE_HEAP_EX(PFX, SNAME, V, CMP) \
+    CMC_GENERATE_HEAP_HEADER(PFX, SNAME, V)      \
+    CMC_GENERATE_HEAP_EX_SOURCE(PFX, SNAME, V, CMP)
+
+/* Same as CMC_GENERATE_HEAP but V is plain data that owns nothing, so */
+/* removals and clear leave the slots they free as they are instead of */
+/* overwriting them with zeros */
+#define CMC_GENERATE_HEAP_TRIVIAL(PFX, SNAME, V) \
+    CMC_GENERATE_HEAP_HEADER(PFX, SNAME, V)      \
+    CMC_GENERATE_HEAP_TRIVIAL_SOURCE(PFX, SNAME, V)
+
+#define CMC_GENERATE_HEAP_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_HEAP_SOURCE(PFX, SNAME, V, _heap_->cmp, false)
+
+#define CMC_GENERATE_HEAP_EX_SOURCE(PFX, SNAME, V, CMP) \
+    CMC_IMPL_HEAP_SOURCE(PFX, SNAME, V, CMP, false)
+
+#define CMC_GENERATE_HEAP_TRIVIAL_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_HEAP_SOURCE(PFX, SNAME, V, _heap_->cmp, true)
+
 /* HEADER ********************************************************************/
 #define CMC_GENERATE_HEAP_HEADER(PFX, SNAME, V)                                             \
                                                                                             \
@@ -82,6 +138,9 @@ enum cmc_heap_order
                                                                                             \
         /* Function that returns an iterator to the end of the heap */                      \
         struct SNAME##_iter (*it_end)(struct SNAME *);                                      \
+                                                                                            \
+        /* Custom allocation functions */                                                   \
+        struct cmc_alloc_node *alloc;                                                       \
     };                                                                                      \
                                                                                             \
     /* Heap Iterator */                                                                     \
@@ -103,24 +162,45 @@ enum cmc_heap_order
     /* Collection Functions */                                                              \
     /* Collection Allocation and Deallocation */                                            \
     struct SNAME *PFX##_new(size_t capacity, enum cmc_heap_order HO, int (*compare)(V, V)); \
+    struct SNAME *PFX##_new_custom(size_t capacity, enum cmc_heap_order HO,                 \
+                                   int (*compare)(V, V), struct cmc_alloc_node *alloc);     \
+    struct SNAME *PFX##_new_from(V *elements, size_t n, enum cmc_heap_order HO,             \
+                                 int (*compare)(V, V));                                     \
     void PFX##_clear(struct SNAME *_heap_, void (*deallocator)(V));                         \
     void PFX##_free(struct SNAME *_heap_, void (*deallocator)(V));                          \
     /* Collection Input and Output */                                                       \
     bool PFX##_insert(struct SNAME *_heap_, V element);                                     \
+    bool PFX##_insert_many(struct SNAME *_heap_, V *elements, size_t n);                    \
     bool PFX##_remove(struct SNAME *_heap_, V *result);                                     \
+    size_t PFX##_remove_if(struct SNAME *_heap_, bool (*pred)(V), void (*deallocator)(V));  \
+    bool PFX##_offer_bounded(struct SNAME *_heap_, V element, size_t k);                    \
+    bool PFX##_top_k(V *elements, size_t n, size_t k, V *out, enum cmc_heap_order HO,       \
+                     int (*compare)(V, V));                                                 \
     /* Element Access */                                                                    \
     V PFX##_peek(struct SNAME *_heap_);                                                     \
     /* Collection State */                                                                  \
     bool PFX##_contains(struct SNAME *_heap_, V element);                                   \
-    bool PFX##_empty(struct SNAME *_heap_);                                                 \
+    CMC_PURE bool PFX##_empty(struct SNAME *_heap_);                                        \
     bool PFX##_full(struct SNAME *_heap_);                                                  \
-    size_t PFX##_count(struct SNAME *_heap_);                                               \
+    CMC_PURE size_t PFX##_count(struct SNAME *_heap_);                                      \
+    size_t PFX##_memory_usage(struct SNAME *_heap_);                                        \
     size_t PFX##_capacity(struct SNAME *_heap_);                                            \
     /* Collection Utility */                                                                \
     bool PFX##_resize(struct SNAME *_heap_, size_t capacity);                               \
+    bool PFX##_shrink_to_fit(struct SNAME *_heap_);                                         \
+    bool PFX##_reserve(struct SNAME *_heap_, size_t capacity);                              \
     struct SNAME *PFX##_copy_of(struct SNAME *_heap_, V (*copy_func)(V));                   \
+    size_t PFX##_to_array(struct SNAME *_heap_, V *CMC_RESTRICT elements, size_t size);     \
     bool PFX##_equals(struct SNAME *_heap1_, struct SNAME *_heap2_);                        \
     struct cmc_string PFX##_to_string(struct SNAME *_heap_);                                \
+    bool PFX##_to_string_full(struct SNAME *_heap_, struct cmc_string_builder *builder,     \
+                              const char *elem_fmt);                                        \
+    bool PFX##_write(struct SNAME *_heap_, FILE *file, void (*fmt)(FILE *, V));             \
+    bool PFX##_write_fd(struct SNAME *_heap_, int fd, void (*fmt)(struct cmc_dump *, V));   \
+    /* Collection Serialization */                                                          \
+    bool PFX##_save(struct SNAME *_heap_, FILE *file, bool (*writer)(V, FILE *));           \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(V, V),                           \
+                                bool (*reader)(V *, FILE *));                               \
                                                                                             \
     /* Iterator Functions */                                                                \
     /* Iterator Allocation and Deallocation */                                              \
@@ -144,35 +224,59 @@ enum cmc_heap_order
     size_t PFX##_iter_index(struct SNAME##_iter *iter);                                     \
                                                                                             \
 /* SOURCE ********************************************************************/
-#define CMC_GENERATE_HEAP_SOURCE(PFX, SNAME, V)                                                   \
+#define CMC_IMPL_HEAP_SOURCE(PFX, SNAME, V, CMP, TRIVIAL)                                         \
                                                                                                   \
     /* Implementation Detail Functions */                                                         \
+    static inline int PFX##_impl_cmp(struct SNAME *_heap_, V a, V b);                             \
     static bool PFX##_impl_float_up(struct SNAME *_heap_, size_t index);                          \
     static bool PFX##_impl_float_down(struct SNAME *_heap_, size_t index);                        \
+    static void PFX##_impl_heapify(struct SNAME *_heap_);                                         \
+    static void PFX##_impl_low_water(struct SNAME *_heap_);                                       \
+    static bool PFX##_impl_grow(struct SNAME *_heap_, size_t required);                           \
+    static size_t PFX##_impl_buffer_bytes(size_t capacity);                                       \
+    static V *PFX##_impl_buffer_new(struct SNAME *_heap_, size_t capacity);                       \
+    static void PFX##_impl_buffer_free(struct SNAME *_heap_, V *buffer);                          \
     static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_heap_);                         \
     static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_heap_);                           \
                                                                                                   \
+    CMC_GENERATE_SORT(PFX##_impl_sort, V, struct SNAME *_heap_, _heap_, CMP)                      \
+    CMC_GENERATE_SELECT(PFX##_impl_select, V, struct SNAME *_heap_, _heap_, CMP)                  \
+                                                                                                  \
     struct SNAME *PFX##_new(size_t capacity, enum cmc_heap_order HO, int (*compare)(V, V))        \
     {                                                                                             \
+        return PFX##_new_custom(capacity, HO, compare, NULL);                                     \
+    }                                                                                             \
+                                                                                                  \
+    struct SNAME *PFX##_new_custom(size_t capacity, enum cmc_heap_order HO,                       \
+                                   int (*compare)(V, V), struct cmc_alloc_node *alloc)            \
+    {                                                                                             \
+        if (!alloc)                                                                               \
+            alloc = &cmc_alloc_node_default;                                                      \
+                                                                                                  \
         if (capacity < 1)                                                                         \
             return NULL;                                                                          \
                                                                                                   \
         if (HO != cmc_min_heap && HO != cmc_max_heap)                                             \
             return NULL;                                                                          \
                                                                                                   \
-        struct SNAME *_heap_ = malloc(sizeof(struct SNAME));                                      \
+        struct SNAME *_heap_ = alloc->malloc(sizeof(struct SNAME));                               \
                                                                                                   \
-        if (!_heap_)                                                                              \
+        if (CMC_UNLIKELY(!_heap_))                                                                \
             return NULL;                                                                          \
                                                                                                   \
-        _heap_->buffer = calloc(capacity, sizeof(V));                                             \
+        _heap_->alloc = alloc;                                                                    \
+                                                                                                  \
+        _heap_->buffer = PFX##_impl_buffer_new(_heap_, capacity);                                 \
                                                                                                   \
         if (!_heap_->buffer)                                                                      \
         {                                                                                         \
-            free(_heap_);                                                                         \
+            alloc->free(_heap_);                                                                  \
             return NULL;                                                                          \
         }                                                                                         \
                                                                                                   \
+        if (!TRIVIAL)                                                                             \
+            memset(_heap_->buffer, 0, sizeof(V) * capacity);                                      \
+                                                                                                  \
         _heap_->capacity = capacity;                                                              \
         _heap_->count = 0;                                                                        \
         _heap_->HO = HO;                                                                          \
@@ -184,6 +288,21 @@ enum cmc_heap_order
         return _heap_;                                                                            \
     }                                                                                             \
                                                                                                   \
+    /* Creates a heap out of the n elements in linear time. The capacity is */                    \
+    /* n, or 1 if n is 0 */                                                                       \
+    struct SNAME *PFX##_new_from(V *elements, size_t n, enum cmc_heap_order HO,                   \
+                                 int (*compare)(V, V))                                            \
+    {                                                                                             \
+        struct SNAME *_heap_ = PFX##_new(n > 0 ? n : 1, HO, compare);                             \
+                                                                                                  \
+        if (CMC_UNLIKELY(!_heap_))                                                                \
+            return NULL;                                                                          \
+                                                                                                  \
+        PFX##_insert_many(_heap_, elements, n);                                                   \
+                                                                                                  \
+        return _heap_;                                                                            \
+    }                                                                                             \
+                                                                                                  \
     void PFX##_clear(struct SNAME *_heap_, void (*deallocator)(V))                                \
     {                                                                                             \
         if (deallocator)                                                                          \
@@ -194,7 +313,8 @@ enum cmc_heap_order
             }                                                                                     \
         }                                                                                         \
                                                                                                   \
-        memset(_heap_->buffer, 0, sizeof(V) * _heap_->capacity);                                  \
+        if (!TRIVIAL)                                                                             \
+            memset(_heap_->buffer, 0, sizeof(V) * _heap_->capacity);                              \
                                                                                                   \
         _heap_->count = 0;                                                                        \
     }                                                                                             \
@@ -209,15 +329,15 @@ enum cmc_heap_order
             }                                                                                     \
         }                                                                                         \
                                                                                                   \
-        free(_heap_->buffer);                                                                     \
-        free(_heap_);                                                                             \
+        PFX##_impl_buffer_free(_heap_, _heap_->buffer);                                           \
+        _heap_->alloc->free(_heap_);                                                              \
     }                                                                                             \
                                                                                                   \
     bool PFX##_insert(struct SNAME *_heap_, V element)                                            \
     {                                                                                             \
         if (PFX##_full(_heap_))                                                                   \
         {                                                                                         \
-            if (!PFX##_resize(_heap_, PFX##_count(_heap_) * 2))                                   \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_heap_, _heap_->count + 1)))                        \
                 return false;                                                                     \
         }                                                                                         \
                                                                                                   \
@@ -235,6 +355,37 @@ enum cmc_heap_order
         return true;                                                                              \
     }                                                                                             \
                                                                                                   \
+    /* Inserts the n elements, growing the buffer at most once. If there are */                   \
+    /* at least as many of them as there are elements in the heap the whole */                    \
+    /* buffer is heapified in linear time, otherwise each one floats up */                        \
+    bool PFX##_insert_many(struct SNAME *_heap_, V *elements, size_t n)                           \
+    {                                                                                             \
+        if (n == 0)                                                                               \
+            return true;                                                                          \
+                                                                                                  \
+        if (_heap_->count + n > _heap_->capacity)                                                 \
+        {                                                                                         \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_heap_, _heap_->count + n)))                        \
+                return false;                                                                     \
+        }                                                                                         \
+                                                                                                  \
+        size_t first = _heap_->count;                                                             \
+                                                                                                  \
+        memcpy(_heap_->buffer + first, elements, sizeof(V) * n);                                  \
+                                                                                                  \
+        _heap_->count += n;                                                                       \
+                                                                                                  \
+        if (n < first)                                                                            \
+        {                                                                                         \
+            for (size_t i = first; i < _heap_->count; i++)                                        \
+                PFX##_impl_float_up(_heap_, i);                                                   \
+        }                                                                                         \
+        else                                                                                      \
+            PFX##_impl_heapify(_heap_);                                                           \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
     bool PFX##_remove(struct SNAME *_heap_, V *result)                                            \
     {                                                                                             \
         if (PFX##_empty(_heap_))                                                                  \
@@ -242,13 +393,122 @@ enum cmc_heap_order
                                                                                                   \
         *result = _heap_->buffer[0];                                                              \
         _heap_->buffer[0] = _heap_->buffer[_heap_->count - 1];                                    \
-        _heap_->buffer[_heap_->count - 1] = (V){0};                                               \
+        if (!TRIVIAL)                                                                             \
+            _heap_->buffer[_heap_->count - 1] = (V){0};                                           \
                                                                                                   \
         _heap_->count--;                                                                          \
                                                                                                   \
         if (!PFX##_impl_float_down(_heap_, 0))                                                    \
             return false;                                                                         \
                                                                                                   \
+        PFX##_impl_low_water(_heap_);                                                             \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Removes every element for which pred is true. The others are moved */                      \
+    /* towards the start of the buffer, which is then heapified in linear */                      \
+    /* time. Returns how many were removed */                                                     \
+    size_t PFX##_remove_if(struct SNAME *_heap_, bool (*pred)(V), void (*deallocator)(V))         \
+    {                                                                                             \
+        size_t kept = 0;                                                                          \
+                                                                                                  \
+        for (size_t i = 0; i < _heap_->count; i++)                                                \
+        {                                                                                         \
+            V element = _heap_->buffer[i];                                                        \
+                                                                                                  \
+            if (pred(element))                                                                    \
+            {                                                                                     \
+                if (deallocator)                                                                  \
+                    deallocator(element);                                                         \
+                                                                                                  \
+                continue;                                                                         \
+            }                                                                                     \
+                                                                                                  \
+            _heap_->buffer[kept++] = element;                                                     \
+        }                                                                                         \
+                                                                                                  \
+        size_t removed = _heap_->count - kept;                                                    \
+                                                                                                  \
+        if (removed == 0)                                                                         \
+            return 0;                                                                             \
+                                                                                                  \
+        if (!TRIVIAL)                                                                             \
+            memset(_heap_->buffer + kept, 0, sizeof(V) * removed);                                \
+                                                                                                  \
+        _heap_->count = kept;                                                                     \
+                                                                                                  \
+        PFX##_impl_heapify(_heap_);                                                               \
+        PFX##_impl_low_water(_heap_);                                                             \
+                                                                                                  \
+        return removed;                                                                           \
+    }                                                                                             \
+                                                                                                  \
+    /* Keeps at most k elements, the ones that would be removed last, so a */                     \
+    /* MinHeap keeps the k largest elements offered and a MaxHeap the k */                        \
+    /* smallest. Until there are k elements it is the same as insert, then */                     \
+    /* element only replaces the root if it would be removed after it. */                         \
+    /* Returns true if element is in the heap. The root that is replaced is */                    \
+    /* not deallocated, peek returns it before the call */                                        \
+    bool PFX##_offer_bounded(struct SNAME *_heap_, V element, size_t k)                           \
+    {                                                                                             \
+        if (k == 0)                                                                               \
+            return false;                                                                         \
+                                                                                                  \
+        if (_heap_->count < k)                                                                    \
+            return PFX##_insert(_heap_, element);                                                 \
+                                                                                                  \
+        if (PFX##_impl_cmp(_heap_, element, _heap_->buffer[0]) * _heap_->HO >= 0)                 \
+            return false;                                                                         \
+                                                                                                  \
+        _heap_->buffer[0] = element;                                                              \
+                                                                                                  \
+        return PFX##_impl_float_down(_heap_, 0);                                                  \
+    }                                                                                             \
+                                                                                                  \
+    /* Writes to out the min(k, n) elements that a heap of order HO with all */                   \
+    /* of the n elements would remove first, in that order. They are found */                     \
+    /* by an introselect over a copy of the elements, in O(n + k log k) on */                     \
+    /* average, without building a heap. Returns false if the copy could */                       \
+    /* not be allocated */                                                                        \
+    bool PFX##_top_k(V *elements, size_t n, size_t k, V *out, enum cmc_heap_order HO,             \
+                     int (*compare)(V, V))                                                        \
+    {                                                                                             \
+        if (HO != cmc_min_heap && HO != cmc_max_heap)                                             \
+            return false;                                                                         \
+                                                                                                  \
+        if (k > n)                                                                                \
+            k = n;                                                                                \
+                                                                                                  \
+        if (k == 0)                                                                               \
+            return true;                                                                          \
+                                                                                                  \
+        /* Only what CMP might read from the heap is set */                                       \
+        struct SNAME heap = { 0 };                                                                \
+                                                                                                  \
+        heap.HO = HO;                                                                             \
+        heap.cmp = compare;                                                                       \
+                                                                                                  \
+        struct SNAME *_heap_ = &heap;                                                             \
+                                                                                                  \
+        V *scratch = malloc(sizeof(V) * n);                                                       \
+                                                                                                  \
+        if (!scratch)                                                                             \
+            return false;                                                                         \
+                                                                                                  \
+        memcpy(scratch, elements, sizeof(V) * n);                                                 \
+                                                                                                  \
+        /* A MaxHeap removes the k largest first, which end up at the end */                      \
+        size_t first = HO == cmc_min_heap ? 0 : n - k;                                            \
+                                                                                                  \
+        PFX##_impl_select(_heap_, scratch, n, HO == cmc_min_heap ? k - 1 : n - k);                \
+        PFX##_impl_sort(_heap_, scratch + first, k);                                              \
+                                                                                                  \
+        for (size_t i = 0; i < k; i++)                                                            \
+            out[i] = HO == cmc_min_heap ? scratch[i] : scratch[n - 1 - i];                        \
+                                                                                                  \
+        free(scratch);                                                                            \
+                                                                                                  \
         return true;                                                                              \
     }                                                                                             \
                                                                                                   \
@@ -264,7 +524,7 @@ enum cmc_heap_order
     {                                                                                             \
         for (size_t i = 0; i < _heap_->count; i++)                                                \
         {                                                                                         \
-            if (_heap_->cmp(_heap_->buffer[i], element) == 0)                                     \
+            if (PFX##_impl_cmp(_heap_, _heap_->buffer[i], element) == 0)                          \
                 return true;                                                                      \
         }                                                                                         \
                                                                                                   \
@@ -286,6 +546,13 @@ enum cmc_heap_order
         return _heap_->count;                                                                     \
     }                                                                                             \
                                                                                                   \
+    size_t PFX##_memory_usage(struct SNAME *_heap_)                                               \
+    {                                                                                             \
+        size_t buffer = PFX##_impl_buffer_bytes(_heap_->capacity);                                \
+                                                                                                  \
+        return sizeof(struct SNAME) + cmc_alloc_aligned_size(CMC_CACHE_LINE_SIZE, buffer);        \
+    }                                                                                             \
+                                                                                                  \
     size_t PFX##_capacity(struct SNAME *_heap_)                                                   \
     {                                                                                             \
         return _heap_->capacity;                                                                  \
@@ -299,22 +566,43 @@ enum cmc_heap_order
         if (capacity < PFX##_count(_heap_))                                                       \
             return false;                                                                         \
                                                                                                   \
-        V *new_buffer = realloc(_heap_->buffer, sizeof(V) * capacity);                            \
+        /* realloc could lose the alignment of the buffer */                                      \
+        V *new_buffer = PFX##_impl_buffer_new(_heap_, capacity);                                  \
                                                                                                   \
         if (!new_buffer)                                                                          \
             return false;                                                                         \
                                                                                                   \
+        memcpy(new_buffer, _heap_->buffer, sizeof(V) * _heap_->count);                            \
+                                                                                                  \
+        PFX##_impl_buffer_free(_heap_, _heap_->buffer);                                           \
+                                                                                                  \
         _heap_->buffer = new_buffer;                                                              \
         _heap_->capacity = capacity;                                                              \
                                                                                                   \
         return true;                                                                              \
     }                                                                                             \
                                                                                                   \
+    bool PFX##_shrink_to_fit(struct SNAME *_heap_)                                                \
+    {                                                                                             \
+        return PFX##_resize(_heap_, _heap_->count > 0 ? _heap_->count : 1);                       \
+    }                                                                                             \
+                                                                                                  \
+    /* Grows the buffer so that at least capacity elements fit. Unlike */                         \
+    /* resize it never shrinks the buffer */                                                      \
+    bool PFX##_reserve(struct SNAME *_heap_, size_t capacity)                                     \
+    {                                                                                             \
+        if (capacity <= _heap_->capacity)                                                         \
+            return true;                                                                          \
+                                                                                                  \
+        return PFX##_resize(_heap_, capacity);                                                    \
+    }                                                                                             \
+                                                                                                  \
     struct SNAME *PFX##_copy_of(struct SNAME *_heap_, V (*copy_func)(V))                          \
     {                                                                                             \
-        struct SNAME *result = PFX##_new(_heap_->capacity, _heap_->HO, _heap_->cmp);              \
+        struct SNAME *result = PFX##_new_custom(_heap_->capacity, _heap_->HO, _heap_->cmp,        \
+                                                _heap_->alloc);                                   \
                                                                                                   \
-        if (!result)                                                                              \
+        if (CMC_UNLIKELY(!result))                                                                \
             return NULL;                                                                          \
                                                                                                   \
         if (copy_func)                                                                            \
@@ -330,6 +618,18 @@ enum cmc_heap_order
         return result;                                                                            \
     }                                                                                             \
                                                                                                   \
+    /* Copies up to size elements, in the order that they are iterated, to */                     \
+    /* elements and returns how many were copied */                                               \
+    size_t PFX##_to_array(struct SNAME *_heap_, V *CMC_RESTRICT elements, size_t size)            \
+    {                                                                                             \
+        if (size > _heap_->count)                                                                 \
+            size = _heap_->count;                                                                 \
+                                                                                                  \
+        memcpy(elements, _heap_->buffer, size * sizeof(V));                                       \
+                                                                                                  \
+        return size;                                                                              \
+    }                                                                                             \
+                                                                                                  \
     bool PFX##_equals(struct SNAME *_heap1_, struct SNAME *_heap2_)                               \
     {                                                                                             \
         if (PFX##_count(_heap1_) != PFX##_count(_heap2_))                                         \
@@ -337,7 +637,7 @@ enum cmc_heap_order
                                                                                                   \
         for (size_t i = 0; i < PFX##_count(_heap1_); i++)                                         \
         {                                                                                         \
-            if (_heap1_->cmp(_heap1_->buffer[i], _heap2_->buffer[i]) != 0)                        \
+            if (PFX##_impl_cmp(_heap1_, _heap1_->buffer[i], _heap2_->buffer[i]) != 0)             \
                 return false;                                                                     \
         }                                                                                         \
                                                                                                   \
@@ -357,11 +657,74 @@ enum cmc_heap_order
         return str;                                                                               \
     }                                                                                             \
                                                                                                   \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE)                                \
+                                                                                                  \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE, (V))                                  \
+                                                                                                  \
+    bool PFX##_save(struct SNAME *_heap_, FILE *file, bool (*writer)(V, FILE *))                  \
+    {                                                                                             \
+        uint32_t flags = writer ? 0 : CMC_SERIAL_RAW_VALUES;                                      \
+                                                                                                  \
+        if (!cmc_serial_write_header(file, "heap", flags, 0, sizeof(V), _heap_->HO,               \
+                                     _heap_->count, _heap_->capacity, 0))                         \
+            return false;                                                                         \
+                                                                                                  \
+        /* Without a writer the whole buffer is written at once */                                \
+        if (!writer)                                                                              \
+            return fwrite(_heap_->buffer, sizeof(V), _heap_->count, file) ==                      \
+                   _heap_->count;                                                                 \
+                                                                                                  \
+        for (size_t i = 0; i < _heap_->count; i++)                                                \
+        {                                                                                         \
+            if (!writer(_heap_->buffer[i], file))                                                 \
+                return false;                                                                     \
+        }                                                                                         \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* The reader is only used if the heap was saved with a writer */                             \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(V, V),                                 \
+                                bool (*reader)(V *, FILE *))                                      \
+    {                                                                                             \
+        struct cmc_serial_header header;                                                          \
+                                                                                                  \
+        if (!cmc_serial_read_header(file, "heap", 0, sizeof(V), &header))                         \
+            return NULL;                                                                          \
+                                                                                                  \
+        if (header.capacity < header.count)                                                       \
+            return NULL;                                                                          \
+                                                                                                  \
+        /* Allocated with the saved capacity so that loading never grows */                       \
+        struct SNAME *_heap_ =                                                                    \
+            PFX##_new(header.capacity, (enum cmc_heap_order)header.extra, compare);               \
+                                                                                                  \
+        if (!_heap_)                                                                              \
+            return NULL;                                                                          \
+                                                                                                  \
+        if (header.flags & CMC_SERIAL_RAW_VALUES)                                                 \
+            _heap_->count = fread(_heap_->buffer, sizeof(V), header.count, file);                 \
+        else                                                                                      \
+        {                                                                                         \
+            while (_heap_->count < header.count &&                                                \
+                   CMC_SERIAL_READ(false, reader, &(_heap_->buffer[_heap_->count]), file))        \
+                _heap_->count++;                                                                  \
+        }                                                                                         \
+                                                                                                  \
+        if (_heap_->count != header.count)                                                        \
+        {                                                                                         \
+            PFX##_free(_heap_, NULL);                                                             \
+            return NULL;                                                                          \
+        }                                                                                         \
+                                                                                                  \
+        return _heap_;                                                                            \
+    }                                                                                             \
+                                                                                                  \
     struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                     \
     {                                                                                             \
-        struct SNAME##_iter *iter = malloc(sizeof(struct SNAME##_iter));                          \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));           \
                                                                                                   \
-        if (!iter)                                                                                \
+        if (CMC_UNLIKELY(!iter))                                                                  \
             return NULL;                                                                          \
                                                                                                   \
         PFX##_iter_init(iter, target);                                                            \
@@ -371,7 +734,7 @@ enum cmc_heap_order
                                                                                                   \
     void PFX##_iter_free(struct SNAME##_iter *iter)                                               \
     {                                                                                             \
-        free(iter);                                                                               \
+        iter->target->alloc->free(iter);                                                          \
     }                                                                                             \
                                                                                                   \
     void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                         \
@@ -526,23 +889,23 @@ enum cmc_heap_order
     {                                                                                             \
         /* Current index */                                                                       \
         size_t C = index;                                                                         \
-        V child = _heap_->buffer[C];                                                              \
-        V parent = _heap_->buffer[(index - 1) / 2];                                               \
                                                                                                   \
         int mod = _heap_->HO;                                                                     \
                                                                                                   \
-        while (C > 0 && _heap_->cmp(child, parent) * mod > 0)                                     \
+        while (C > 0)                                                                             \
         {                                                                                         \
+            size_t P = (C - 1) / CMC_HEAP_ARITY;                                                  \
+                                                                                                  \
+            if (PFX##_impl_cmp(_heap_, _heap_->buffer[C], _heap_->buffer[P]) * mod <= 0)          \
+                break;                                                                            \
+                                                                                                  \
             /* Swap between C (current element) and its parent */                                 \
             V tmp = _heap_->buffer[C];                                                            \
-            _heap_->buffer[C] = _heap_->buffer[(C - 1) / 2];                                      \
-            _heap_->buffer[(C - 1) / 2] = tmp;                                                    \
+            _heap_->buffer[C] = _heap_->buffer[P];                                                \
+            _heap_->buffer[P] = tmp;                                                              \
                                                                                                   \
             /* Go to parent */                                                                    \
-            C = (C - 1) / 2;                                                                      \
-                                                                                                  \
-            child = _heap_->buffer[C];                                                            \
-            parent = _heap_->buffer[(C - 1) / 2];                                                 \
+            C = P;                                                                                \
         }                                                                                         \
                                                                                                   \
         return true;                                                                              \
@@ -554,22 +917,23 @@ enum cmc_heap_order
                                                                                                   \
         while (index < _heap_->count)                                                             \
         {                                                                                         \
-            size_t L = 2 * index + 1;                                                             \
-            size_t R = 2 * index + 2;                                                             \
+            size_t first = CMC_HEAP_ARITY * index + 1;                                            \
+            size_t last = first + CMC_HEAP_ARITY;                                                 \
             size_t C = index;                                                                     \
                                                                                                   \
-            /* Determine if we swap with the left or right element */                             \
-            if (L < _heap_->count && _heap_->cmp(_heap_->buffer[L], _heap_->buffer[C]) * mod > 0) \
-            {                                                                                     \
-                C = L;                                                                            \
-            }                                                                                     \
+            if (last > _heap_->count)                                                             \
+                last = _heap_->count;                                                             \
                                                                                                   \
-            if (R < _heap_->count && _heap_->cmp(_heap_->buffer[R], _heap_->buffer[C]) * mod > 0) \
+            /* Determine which of the children, if any, to swap with */                           \
+            for (size_t child = first; child < last; child++)                                     \
             {                                                                                     \
-                C = R;                                                                            \
+                V value = _heap_->buffer[child];                                                  \
+                                                                                                  \
+                if (PFX##_impl_cmp(_heap_, value, _heap_->buffer[C]) * mod > 0)                   \
+                    C = child;                                                                    \
             }                                                                                     \
                                                                                                   \
-            /* Swap only if either left or right was picked, otherwise done */                    \
+            /* Swap only if one of the children was picked, otherwise done */                     \
             if (C != index)                                                                       \
             {                                                                                     \
                 V tmp = _heap_->buffer[index];                                                    \
@@ -585,6 +949,69 @@ enum cmc_heap_order
         return true;                                                                              \
     }                                                                                             \
                                                                                                   \
+    /* Floyd's method, floats down every node that has children starting */                       \
+    /* from the last one, so each subtree is a heap before its root is */                         \
+    static void PFX##_impl_heapify(struct SNAME *_heap_)                                          \
+    {                                                                                             \
+        if (_heap_->count < 2)                                                                    \
+            return;                                                                               \
+                                                                                                  \
+        for (size_t i = (_heap_->count - 2) / CMC_HEAP_ARITY + 1; i > 0; i--)                     \
+            PFX##_impl_float_down(_heap_, i - 1);                                                 \
+    }                                                                                             \
+                                                                                                  \
+    /* Called after removals, halves the buffer until it is no longer mostly empty */             \
+    static void PFX##_impl_low_water(struct SNAME *_heap_)                                        \
+    {                                                                                             \
+        size_t capacity = _heap_->capacity;                                                       \
+                                                                                                  \
+        while (capacity > 1 &&                                                                    \
+               (double)_heap_->count < (double)capacity * CMC_SHRINK_LOW_WATER)                   \
+            capacity /= 2;                                                                        \
+                                                                                                  \
+        if (capacity != _heap_->capacity)                                                         \
+            PFX##_resize(_heap_, capacity);                                                       \
+    }                                                                                             \
+                                                                                                  \
+    /* Called when the buffer is full, grows it by the policy of cmc_growth.h */                  \
+    static bool PFX##_impl_grow(struct SNAME *_heap_, size_t required)                            \
+    {                                                                                             \
+        return PFX##_resize(_heap_, cmc_growth_capacity(_heap_->capacity, required));             \
+    }                                                                                             \
+                                                                                                  \
+    /* Size of the allocation of a buffer for capacity elements */                                \
+    static size_t PFX##_impl_buffer_bytes(size_t capacity)                                        \
+    {                                                                                             \
+        /* Whole cache lines, so that no other block shares the last one */                       \
+        size_t bytes = sizeof(V) * (CMC_HEAP_ARITY - 1 + capacity) + CMC_CACHE_LINE_SIZE - 1;     \
+                                                                                                  \
+        return bytes - bytes % CMC_CACHE_LINE_SIZE;                                               \
+    }                                                                                             \
+                                                                                                  \
+    /* Allocates a buffer for capacity elements placed as CMC_HEAP_ARITY says */                  \
+    static V *PFX##_impl_buffer_new(struct SNAME *_heap_, size_t capacity)                        \
+    {                                                                                             \
+        size_t padding = sizeof(V) * (CMC_HEAP_ARITY - 1);                                        \
+                                                                                                  \
+        if (capacity > (SIZE_MAX - padding - CMC_CACHE_LINE_SIZE) / sizeof(V))                    \
+            return NULL;                                                                          \
+                                                                                                  \
+        unsigned char *block = cmc_alloc_aligned(_heap_->alloc, CMC_CACHE_LINE_SIZE,              \
+                                                 PFX##_impl_buffer_bytes(capacity));              \
+                                                                                                  \
+        if (CMC_UNLIKELY(!block))                                                                 \
+            return NULL;                                                                          \
+                                                                                                  \
+        return (V *)(block + padding);                                                            \
+    }                                                                                             \
+                                                                                                  \
+    static void PFX##_impl_buffer_free(struct SNAME *_heap_, V *buffer)                           \
+    {                                                                                             \
+        unsigned char *block = (unsigned char *)buffer - sizeof(V) * (CMC_HEAP_ARITY - 1);        \
+                                                                                                  \
+        cmc_alloc_aligned_free(_heap_->alloc, block);                                             \
+    }                                                                                             \
+                                                                                                  \
     static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_heap_)                          \
     {                                                                                             \
         struct SNAME##_iter iter;                                                                 \
@@ -603,6 +1030,13 @@ enum cmc_heap_order
         PFX##_iter_to_end(&iter);                                                                 \
                                                                                                   \
         return iter;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    static inline int PFX##_impl_cmp(struct SNAME *_heap_, V a, V b)                              \
+    {                                                                                             \
+        (void)_heap_;                                                                             \
+                                                                                                  \
+        return CMP(a, b);                                                                         \
     }
 
 #endif /* CMC_HEAP_H */
@@ -0,0 +1,400 @@
+/**
+ * hyperloglog.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * HyperLogLog
+ *
+ * A HyperLogLog estimates how many distinct elements were inserted into it
+ * without storing them. Where a MultiSet needs memory for every distinct
+ * element, a HyperLogLog uses a fixed amount of registers, one byte each,
+ * chosen by its precision. With 2^p registers the standard error of the
+ * estimate is about 1.04 / sqrt(2^p), so a precision of 14 takes 16 KiB and
+ * is usually within 1% of the real cardinality. Two HyperLogLogs with the
+ * same precision and hash function can be merged to count the elements of
+ * both, as if every element had been inserted into a single one.
+ *
+ * Implementation
+ *
+ * The hash of an element, given by the same size_t (*hash)(V) function used
+ * by the HashSet, is mixed by cmc_hash_u64(). Its first p bits select a
+ * register and the register keeps the highest position of the first set bit
+ * seen among the remaining bits. Registers are a plain array of bytes so the
+ * merge is a byte wise maximum that compilers vectorize, and the estimate
+ * only reads them once to build a histogram. The estimate uses the improved
+ * estimator of Otmar Ertl, which has no bias for small cardinalities and
+ * needs neither linear counting nor the empirical tables of HyperLogLog++.
+ */
+
+#ifndef CMC_HYPERLOGLOG_H
+#define CMC_HYPERLOGLOG_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_math.h"
+#include "../utl/cmc_string.h"
+#include "../utl/hash.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_hyperloglog = "%s at %p { registers:%p, precision:%" PRIuMAX ", hash:%p }";
+
+/* Registers are aligned to this size */
+#ifndef CMC_CACHE_LINE_SIZE
+#define CMC_CACHE_LINE_SIZE 64
+#endif
+
+/* Range of the precision, 2^p registers */
+#define CMC_HYPERLOGLOG_MIN_PRECISION 4
+#define CMC_HYPERLOGLOG_MAX_PRECISION 18
+
+#define CMC_GENERATE_HYPERLOGLOG(PFX, SNAME, V)    \
+    CMC_GENERATE_HYPERLOGLOG_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_HYPERLOGLOG_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_HYPERLOGLOG_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_HYPERLOGLOG_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_HYPERLOGLOG_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_HYPERLOGLOG_SOURCE(PFX, SNAME, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_HYPERLOGLOG_HEADER(PFX, SNAME, V)                     \
+                                                                           \
+    /* HyperLogLog Structure */                                            \
+    struct SNAME                                                           \
+    {                                                                      \
+        /* Array of 2^precision registers */                               \
+        uint8_t *registers;                                                \
+                                                                           \
+        /* Amount of bits of the hash that select a register (p) */        \
+        size_t precision;                                                  \
+                                                                           \
+        /* Element hash function */                                        \
+        size_t (*hash)(V);                                                 \
+                                                                           \
+        /* Custom allocation functions */                                  \
+        struct cmc_alloc_node *alloc;                                      \
+    };                                                                     \
+                                                                           \
+    /* Collection Functions */                                             \
+    /* Collection Allocation and Deallocation */                           \
+    struct SNAME *PFX##_new(size_t precision, size_t (*hash)(V));          \
+    struct SNAME *PFX##_new_custom(size_t precision, size_t (*hash)(V),    \
+                                   struct cmc_alloc_node *alloc);          \
+    void PFX##_clear(struct SNAME *_hll_);                                 \
+    void PFX##_free(struct SNAME *_hll_);                                  \
+    /* Collection Input and Output */                                      \
+    bool PFX##_insert(struct SNAME *_hll_, V element);                     \
+    size_t PFX##_insert_many(struct SNAME *_hll_, V *elements, size_t n);  \
+    /* Collection State */                                                 \
+    CMC_PURE bool PFX##_empty(struct SNAME *_hll_);                        \
+    size_t PFX##_cardinality(struct SNAME *_hll_);                         \
+    double PFX##_estimate(struct SNAME *_hll_);                            \
+    size_t PFX##_precision(struct SNAME *_hll_);                           \
+    size_t PFX##_registers(struct SNAME *_hll_);                           \
+    size_t PFX##_memory_usage(struct SNAME *_hll_);                        \
+    /* Collection Utility */                                               \
+    struct SNAME *PFX##_copy_of(struct SNAME *_hll_);                      \
+    bool PFX##_equals(struct SNAME *_hll1_, struct SNAME *_hll2_);         \
+    struct cmc_string PFX##_to_string(struct SNAME *_hll_);                \
+                                                                           \
+    /* Set Operations */                                                   \
+    bool PFX##_compatible(struct SNAME *_hll1_, struct SNAME *_hll2_);     \
+    struct SNAME *PFX##_merge(struct SNAME *_hll1_, struct SNAME *_hll2_); \
+    bool PFX##_merge_into(struct SNAME *_hll1_, struct SNAME *_hll2_);     \
+                                                                           \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_HYPERLOGLOG_SOURCE(PFX, SNAME, V)                                              \
+                                                                                                    \
+    /* Implementation Detail Functions */                                                           \
+    static double PFX##_impl_sigma(double x);                                                       \
+    static double PFX##_impl_tau(double x);                                                         \
+                                                                                                    \
+    /* Creates a HyperLogLog with 2^precision registers */                                          \
+    struct SNAME *PFX##_new(size_t precision, size_t (*hash)(V))                                    \
+    {                                                                                               \
+        return PFX##_new_custom(precision, hash, NULL);                                             \
+    }                                                                                               \
+                                                                                                    \
+    struct SNAME *PFX##_new_custom(size_t precision, size_t (*hash)(V),                             \
+                                   struct cmc_alloc_node *alloc)                                    \
+    {                                                                                               \
+        if (!alloc)                                                                                 \
+            alloc = &cmc_alloc_node_default;                                                        \
+                                                                                                    \
+        if (precision < CMC_HYPERLOGLOG_MIN_PRECISION || precision > CMC_HYPERLOGLOG_MAX_PRECISION) \
+            return NULL;                                                                            \
+                                                                                                    \
+        struct SNAME *_hll_ = alloc->malloc(sizeof(struct SNAME));                                  \
+                                                                                                    \
+        if (CMC_UNLIKELY(!_hll_))                                                                   \
+            return NULL;                                                                            \
+                                                                                                    \
+        _hll_->alloc = alloc;                                                                       \
+                                                                                                    \
+        size_t registers = (size_t)1 << precision;                                                  \
+                                                                                                    \
+        /* Whole cache lines, so that no other block shares the last one */                         \
+        size_t bytes = (registers + CMC_CACHE_LINE_SIZE - 1) / CMC_CACHE_LINE_SIZE;                 \
+                                                                                                    \
+        _hll_->registers = cmc_alloc_aligned(alloc, CMC_CACHE_LINE_SIZE,                            \
+                                             bytes * CMC_CACHE_LINE_SIZE);                          \
+                                                                                                    \
+        if (CMC_UNLIKELY(!_hll_->registers))                                                        \
+        {                                                                                           \
+            alloc->free(_hll_);                                                                     \
+            return NULL;                                                                            \
+        }                                                                                           \
+                                                                                                    \
+        memset(_hll_->registers, 0, registers);                                                     \
+                                                                                                    \
+        _hll_->precision = precision;                                                               \
+        _hll_->hash = hash;                                                                         \
+                                                                                                    \
+        return _hll_;                                                                               \
+    }                                                                                               \
+                                                                                                    \
+    void PFX##_clear(struct SNAME *_hll_)                                                           \
+    {                                                                                               \
+        memset(_hll_->registers, 0, PFX##_registers(_hll_));                                        \
+    }                                                                                               \
+                                                                                                    \
+    void PFX##_free(struct SNAME *_hll_)                                                            \
+    {                                                                                               \
+        cmc_alloc_aligned_free(_hll_->alloc, _hll_->registers);                                     \
+        _hll_->alloc->free(_hll_);                                                                  \
+    }                                                                                               \
+                                                                                                    \
+    /* Returns true if a register was changed by the element */                                     \
+    bool PFX##_insert(struct SNAME *_hll_, V element)                                               \
+    {                                                                                               \
+        uint64_t hash = cmc_hash_u64(_hll_->hash(element));                                         \
+                                                                                                    \
+        size_t index = (size_t)(hash >> (64 - _hll_->precision));                                   \
+                                                                                                    \
+        /* Position of the first set bit after the index, from 1 to 65 - p */                       \
+        uint8_t rank = (uint8_t)(cmc_math_clz(hash << _hll_->precision) + 1);                       \
+                                                                                                    \
+        if (rank > 65 - _hll_->precision)                                                           \
+            rank = (uint8_t)(65 - _hll_->precision);                                                \
+                                                                                                    \
+        if (_hll_->registers[index] >= rank)                                                        \
+            return false;                                                                           \
+                                                                                                    \
+        _hll_->registers[index] = rank;                                                             \
+                                                                                                    \
+        return true;                                                                                \
+    }                                                                                               \
+                                                                                                    \
+    /* Returns how many elements changed a register */                                              \
+    size_t PFX##_insert_many(struct SNAME *_hll_, V *elements, size_t n)                            \
+    {                                                                                               \
+        size_t changed = 0;                                                                         \
+                                                                                                    \
+        for (size_t i = 0; i < n; i++)                                                              \
+        {                                                                                           \
+            if (PFX##_insert(_hll_, elements[i]))                                                   \
+                changed++;                                                                          \
+        }                                                                                           \
+                                                                                                    \
+        return changed;                                                                             \
+    }                                                                                               \
+                                                                                                    \
+    bool PFX##_empty(struct SNAME *_hll_)                                                           \
+    {                                                                                               \
+        size_t registers = PFX##_registers(_hll_);                                                  \
+        uint8_t any = 0;                                                                            \
+                                                                                                    \
+        for (size_t i = 0; i < registers; i++)                                                      \
+            any |= _hll_->registers[i];                                                             \
+                                                                                                    \
+        return any == 0;                                                                            \
+    }                                                                                               \
+                                                                                                    \
+    /* The estimate rounded to the nearest integer */                                               \
+    size_t PFX##_cardinality(struct SNAME *_hll_)                                                   \
+    {                                                                                               \
+        return (size_t)(PFX##_estimate(_hll_) + 0.5);                                               \
+    }                                                                                               \
+                                                                                                    \
+    /* Estimated amount of distinct elements inserted, with the improved */                         \
+    /* estimator of Otmar Ertl which is unbiased from 0 to 2^64 elements */                         \
+    /* without the empirical bias tables of HyperLogLog++ */                                        \
+    double PFX##_estimate(struct SNAME *_hll_)                                                      \
+    {                                                                                               \
+        size_t registers = PFX##_registers(_hll_);                                                  \
+        size_t q = 64 - _hll_->precision;                                                           \
+                                                                                                    \
+        /* Histogram of the registers, they go from 0 to q + 1 */                                   \
+        size_t counts[66] = { 0 };                                                                  \
+                                                                                                    \
+        for (size_t i = 0; i < registers; i++)                                                      \
+            counts[_hll_->registers[i]]++;                                                          \
+                                                                                                    \
+        if (counts[0] == registers)                                                                 \
+            return 0.0;                                                                             \
+                                                                                                    \
+        double m = (double)registers;                                                               \
+        double z = m * PFX##_impl_tau(1.0 - (double)counts[q + 1] / m);                             \
+                                                                                                    \
+        for (size_t k = q; k >= 1; k--)                                                             \
+        {                                                                                           \
+            z += (double)counts[k];                                                                 \
+            z *= 0.5;                                                                               \
+        }                                                                                           \
+                                                                                                    \
+        z += m * PFX##_impl_sigma((double)counts[0] / m);                                           \
+                                                                                                    \
+        /* alpha = 1 / (2 ln(2)) */                                                                 \
+        return 0.72134752044448170368 * m * m / z;                                                  \
+    }                                                                                               \
+                                                                                                    \
+    size_t PFX##_precision(struct SNAME *_hll_)                                                     \
+    {                                                                                               \
+        return _hll_->precision;                                                                    \
+    }                                                                                               \
+                                                                                                    \
+    /* Amount of registers, which is also their size in bytes */                                    \
+    size_t PFX##_registers(struct SNAME *_hll_)                                                     \
+    {                                                                                               \
+        return (size_t)1 << _hll_->precision;                                                       \
+    }                                                                                               \
+                                                                                                    \
+    size_t PFX##_memory_usage(struct SNAME *_hll_)                                                  \
+    {                                                                                               \
+        size_t registers = PFX##_registers(_hll_);                                                  \
+                                                                                                    \
+        /* Whole cache lines, as allocated by new */                                                \
+        size_t lines = (registers + CMC_CACHE_LINE_SIZE - 1) / CMC_CACHE_LINE_SIZE;                 \
+        size_t bytes = lines * CMC_CACHE_LINE_SIZE;                                                 \
+                                                                                                    \
+        return sizeof(struct SNAME) + cmc_alloc_aligned_size(CMC_CACHE_LINE_SIZE, bytes);           \
+    }                                                                                               \
+                                                                                                    \
+    struct SNAME *PFX##_copy_of(struct SNAME *_hll_)                                                \
+    {                                                                                               \
+        struct SNAME *result = PFX##_new_custom(_hll_->precision, _hll_->hash, _hll_->alloc);       \
+                                                                                                    \
+        if (CMC_UNLIKELY(!result))                                                                  \
+            return NULL;                                                                            \
+                                                                                                    \
+        memcpy(result->registers, _hll_->registers, PFX##_registers(_hll_));                        \
+                                                                                                    \
+        return result;                                                                              \
+    }                                                                                               \
+                                                                                                    \
+    /* Two HyperLogLogs are equal if all of their registers are equal */                            \
+    bool PFX##_equals(struct SNAME *_hll1_, struct SNAME *_hll2_)                                   \
+    {                                                                                               \
+        if (!PFX##_compatible(_hll1_, _hll2_))                                                      \
+            return false;                                                                           \
+                                                                                                    \
+        return memcmp(_hll1_->registers, _hll2_->registers, PFX##_registers(_hll1_)) == 0;          \
+    }                                                                                               \
+                                                                                                    \
+    struct cmc_string PFX##_to_string(struct SNAME *_hll_)                                          \
+    {                                                                                               \
+        struct cmc_string str;                                                                      \
+        struct SNAME *h_ = _hll_;                                                                   \
+        const char *name = #SNAME;                                                                  \
+                                                                                                    \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_hyperloglog, name, h_, h_->registers,        \
+                 h_->precision, h_->hash);                                                          \
+                                                                                                    \
+        return str;                                                                                 \
+    }                                                                                               \
+                                                                                                    \
+    /* HyperLogLogs can only be merged if they map elements to the same */                          \
+    /* registers */                                                                                 \
+    bool PFX##_compatible(struct SNAME *_hll1_, struct SNAME *_hll2_)                               \
+    {                                                                                               \
+        return _hll1_->precision == _hll2_->precision && _hll1_->hash == _hll2_->hash;              \
+    }                                                                                               \
+                                                                                                    \
+    /* A new HyperLogLog that counts the elements of both, or NULL if they */                       \
+    /* are not compatible */                                                                        \
+    struct SNAME *PFX##_merge(struct SNAME *_hll1_, struct SNAME *_hll2_)                           \
+    {                                                                                               \
+        if (!PFX##_compatible(_hll1_, _hll2_))                                                      \
+            return NULL;                                                                            \
+                                                                                                    \
+        struct SNAME *result = PFX##_copy_of(_hll1_);                                               \
+                                                                                                    \
+        if (!result)                                                                                \
+            return NULL;                                                                            \
+                                                                                                    \
+        PFX##_merge_into(result, _hll2_);                                                           \
+                                                                                                    \
+        return result;                                                                              \
+    }                                                                                               \
+                                                                                                    \
+    /* Adds the elements counted by _hll2_ to _hll1_ */                                             \
+    bool PFX##_merge_into(struct SNAME *_hll1_, struct SNAME *_hll2_)                               \
+    {                                                                                               \
+        if (!PFX##_compatible(_hll1_, _hll2_))                                                      \
+            return false;                                                                           \
+                                                                                                    \
+        size_t registers = PFX##_registers(_hll1_);                                                 \
+        uint8_t *r1 = _hll1_->registers;                                                            \
+        uint8_t *r2 = _hll2_->registers;                                                            \
+                                                                                                    \
+        for (size_t i = 0; i < registers; i++)                                                      \
+            r1[i] = r1[i] < r2[i] ? r2[i] : r1[i];                                                  \
+                                                                                                    \
+        return true;                                                                                \
+    }                                                                                               \
+                                                                                                    \
+    /* sigma(x) = x + sum of x^(2^k) * 2^(k-1) for k >= 1, the correction */                        \
+    /* for empty registers */                                                                       \
+    static double PFX##_impl_sigma(double x)                                                        \
+    {                                                                                               \
+        double y = 1.0;                                                                             \
+        double z = x;                                                                               \
+        double previous;                                                                            \
+                                                                                                    \
+        do                                                                                          \
+        {                                                                                           \
+            x *= x;                                                                                 \
+            previous = z;                                                                           \
+            z += x * y;                                                                             \
+            y += y;                                                                                 \
+        } while (z != previous);                                                                    \
+                                                                                                    \
+        return z;                                                                                   \
+    }                                                                                               \
+                                                                                                    \
+    /* tau(x) = (1 - x - sum of (1 - x^(2^-k))^2 * 2^-k for k >= 1) / 3, */                         \
+    /* the correction for registers at their maximum value */                                       \
+    static double PFX##_impl_tau(double x)                                                          \
+    {                                                                                               \
+        if (x == 0.0 || x == 1.0)                                                                   \
+            return 0.0;                                                                             \
+                                                                                                    \
+        double y = 1.0;                                                                             \
+        double z = 1.0 - x;                                                                         \
+        double previous;                                                                            \
+                                                                                                    \
+        do                                                                                          \
+        {                                                                                           \
+            x = cmc_math_sqrt(x);                                                                   \
+            previous = z;                                                                           \
+            y *= 0.5;                                                                               \
+            z -= (1.0 - x) * (1.0 - x) * y;                                                         \
+        } while (z != previous);                                                                    \
+                                                                                                    \
+        return z / 3.0;                                                                             \
+    }
+
+#endif /* CMC_HYPERLOGLOG_H */
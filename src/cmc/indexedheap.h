@@ -0,0 +1,520 @@
+/**
+ * indexedheap.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * IndexedHeap
+ *
+ * An IndexedHeap is a priority queue where every inserted element gets a
+ * handle, a number that refers to it for as long as it is in the heap. With
+ * the handle an element can be read, have its priority changed up or down or
+ * be removed from anywhere in the heap, all in O(log n). This is what
+ * algorithms like Dijkstra's or A* need to update a node that is already
+ * queued instead of queueing it again and skipping the stale copies.
+ *
+ * Implementation
+ *
+ * The heap is a buffer of handles with CMC_HEAP_ARITY children per node, the
+ * same as the Heap, and each handle is an index into an array of entries that
+ * keep both the element and its position in the buffer. Every time a handle
+ * moves in the buffer its position is updated, so finding an element from its
+ * handle takes constant time.
+ *
+ * The handles of removed elements are kept in the buffer right after the ones
+ * in the heap and are given to the next elements inserted. A handle is only
+ * valid while its element is in the heap, after that contains returns false
+ * for it until it is taken by another element.
+ */
+
+#ifndef CMC_INDEXEDHEAP_H
+#define CMC_INDEXEDHEAP_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "heap.h"
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_growth.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_indexedheap = "%s at %p { buffer:%p, entries:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", handles:%" PRIuMAX ", type:%s, cmp:%p }";
+
+#define CMC_GENERATE_INDEXEDHEAP(PFX, SNAME, V)    \
+    CMC_GENERATE_INDEXEDHEAP_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_INDEXEDHEAP_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_INDEXEDHEAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_INDEXEDHEAP_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_INDEXEDHEAP_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_INDEXEDHEAP_SOURCE(PFX, SNAME, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_INDEXEDHEAP_HEADER(PFX, SNAME, V)                                      \
+    /* Indexed Heap Structure */                                                            \
+    struct SNAME                                                                            \
+    {                                                                                       \
+        /* Handles of the elements in heap order, followed by the free ones */              \
+        size_t *buffer;                                                                     \
+                                                                                            \
+        /* Element and position in the buffer of each handle */                             \
+        struct SNAME##_entry *entries;                                                      \
+                                                                                            \
+        /* Current capacity of both arrays */                                               \
+        size_t capacity;                                                                    \
+                                                                                            \
+        /* Current amount of elements in the heap */                                        \
+        size_t count;                                                                       \
+                                                                                            \
+        /* Amount of handles given out so far, in the heap or free */                       \
+        size_t handles;                                                                     \
+                                                                                            \
+        /* Heap order (MaxHeap or MinHeap) */                                               \
+        enum cmc_heap_order HO;                                                             \
+                                                                                            \
+        /* Element comparison function */                                                   \
+        int (*cmp)(V, V);                                                                   \
+                                                                                            \
+        /* Custom allocation functions */                                                   \
+        struct cmc_alloc_node *alloc;                                                       \
+    };                                                                                      \
+                                                                                            \
+    /* Indexed Heap Entry */                                                                \
+    struct SNAME##_entry                                                                    \
+    {                                                                                       \
+        /* Element of the handle */                                                         \
+        V value;                                                                            \
+                                                                                            \
+        /* Index of the handle in the buffer, not less than count if it is free */          \
+        size_t position;                                                                    \
+    };                                                                                      \
+                                                                                            \
+    /* Collection Functions */                                                              \
+    /* Collection Allocation and Deallocation */                                            \
+    struct SNAME *PFX##_new(size_t capacity, enum cmc_heap_order HO, int (*compare)(V, V)); \
+    struct SNAME *PFX##_new_custom(size_t capacity, enum cmc_heap_order HO,                 \
+                                   int (*compare)(V, V), struct cmc_alloc_node *alloc);     \
+    void PFX##_clear(struct SNAME *_heap_, void (*deallocator)(V));                         \
+    void PFX##_free(struct SNAME *_heap_, void (*deallocator)(V));                          \
+    /* Collection Input and Output */                                                       \
+    bool PFX##_insert(struct SNAME *_heap_, V element, size_t *handle);                     \
+    bool PFX##_remove(struct SNAME *_heap_, V *result, size_t *handle);                     \
+    bool PFX##_remove_handle(struct SNAME *_heap_, size_t handle, V *result);               \
+    /* Collection Update */                                                                 \
+    bool PFX##_update(struct SNAME *_heap_, size_t handle, V element);                      \
+    bool PFX##_decrease_key(struct SNAME *_heap_, size_t handle, V element);                \
+    bool PFX##_increase_key(struct SNAME *_heap_, size_t handle, V element);                \
+    /* Element Access */                                                                    \
+    bool PFX##_peek(struct SNAME *_heap_, V *value, size_t *handle);                        \
+    V PFX##_get(struct SNAME *_heap_, size_t handle);                                       \
+    /* Collection State */                                                                  \
+    bool PFX##_contains(struct SNAME *_heap_, size_t handle);                               \
+    CMC_PURE bool PFX##_empty(struct SNAME *_heap_);                                        \
+    bool PFX##_full(struct SNAME *_heap_);                                                  \
+    CMC_PURE size_t PFX##_count(struct SNAME *_heap_);                                      \
+    size_t PFX##_memory_usage(struct SNAME *_heap_);                                        \
+    size_t PFX##_capacity(struct SNAME *_heap_);                                            \
+    /* Collection Utility */                                                                \
+    bool PFX##_resize(struct SNAME *_heap_, size_t capacity);                               \
+    struct cmc_string PFX##_to_string(struct SNAME *_heap_);                                \
+                                                                                            \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_INDEXEDHEAP_SOURCE(PFX, SNAME, V)                                         \
+    /* Implementation Detail Functions */                                                      \
+    static void PFX##_impl_float_up(struct SNAME *_heap_, size_t position);                    \
+    static void PFX##_impl_float_down(struct SNAME *_heap_, size_t position);                  \
+    static void PFX##_impl_fix(struct SNAME *_heap_, size_t position);                         \
+    static void PFX##_impl_remove_at(struct SNAME *_heap_, size_t position, V *result);        \
+                                                                                               \
+    struct SNAME *PFX##_new(size_t capacity, enum cmc_heap_order HO, int (*compare)(V, V))     \
+    {                                                                                          \
+        return PFX##_new_custom(capacity, HO, compare, NULL);                                  \
+    }                                                                                          \
+                                                                                               \
+    struct SNAME *PFX##_new_custom(size_t capacity, enum cmc_heap_order HO,                    \
+                                   int (*compare)(V, V), struct cmc_alloc_node *alloc)         \
+    {                                                                                          \
+        if (!alloc)                                                                            \
+            alloc = &cmc_alloc_node_default;                                                   \
+                                                                                               \
+        if (capacity < 1 || capacity > SIZE_MAX / sizeof(struct SNAME##_entry))                \
+            return NULL;                                                                       \
+                                                                                               \
+        if (HO != cmc_min_heap && HO != cmc_max_heap)                                          \
+            return NULL;                                                                       \
+                                                                                               \
+        struct SNAME *_heap_ = alloc->malloc(sizeof(struct SNAME));                            \
+                                                                                               \
+        if (CMC_UNLIKELY(!_heap_))                                                             \
+            return NULL;                                                                       \
+                                                                                               \
+        _heap_->alloc = alloc;                                                                 \
+                                                                                               \
+        _heap_->buffer = alloc->malloc(sizeof(size_t) * capacity);                             \
+        _heap_->entries = alloc->malloc(sizeof(struct SNAME##_entry) * capacity);              \
+                                                                                               \
+        if (!_heap_->buffer || !_heap_->entries)                                               \
+        {                                                                                      \
+            alloc->free(_heap_->buffer);                                                       \
+            alloc->free(_heap_->entries);                                                      \
+            alloc->free(_heap_);                                                               \
+            return NULL;                                                                       \
+        }                                                                                      \
+                                                                                               \
+        _heap_->capacity = capacity;                                                           \
+        _heap_->count = 0;                                                                     \
+        _heap_->handles = 0;                                                                   \
+        _heap_->HO = HO;                                                                       \
+        _heap_->cmp = compare;                                                                 \
+                                                                                               \
+        return _heap_;                                                                         \
+    }                                                                                          \
+                                                                                               \
+    /* Every handle given out so far is invalidated */                                         \
+    void PFX##_clear(struct SNAME *_heap_, void (*deallocator)(V))                             \
+    {                                                                                          \
+        if (deallocator)                                                                       \
+        {                                                                                      \
+            for (size_t i = 0; i < _heap_->count; i++)                                         \
+                deallocator(_heap_->entries[_heap_->buffer[i]].value);                         \
+        }                                                                                      \
+                                                                                               \
+        _heap_->count = 0;                                                                     \
+        _heap_->handles = 0;                                                                   \
+    }                                                                                          \
+                                                                                               \
+    void PFX##_free(struct SNAME *_heap_, void (*deallocator)(V))                              \
+    {                                                                                          \
+        if (deallocator)                                                                       \
+        {                                                                                      \
+            for (size_t i = 0; i < _heap_->count; i++)                                         \
+                deallocator(_heap_->entries[_heap_->buffer[i]].value);                         \
+        }                                                                                      \
+                                                                                               \
+        _heap_->alloc->free(_heap_->buffer);                                                   \
+        _heap_->alloc->free(_heap_->entries);                                                  \
+        _heap_->alloc->free(_heap_);                                                           \
+    }                                                                                          \
+                                                                                               \
+    /* The handle of the element is written to handle unless it is NULL */                     \
+    bool PFX##_insert(struct SNAME *_heap_, V element, size_t *handle)                         \
+    {                                                                                          \
+        /* A new handle is only needed if there are no free ones */                            \
+        if (_heap_->count == _heap_->handles)                                                  \
+        {                                                                                      \
+            if (PFX##_full(_heap_))                                                            \
+            {                                                                                  \
+                size_t capacity = cmc_growth_capacity(_heap_->capacity, _heap_->capacity + 1); \
+                                                                                               \
+                if (CMC_UNLIKELY(!PFX##_resize(_heap_, capacity)))                             \
+                    return false;                                                              \
+            }                                                                                  \
+                                                                                               \
+            _heap_->buffer[_heap_->handles] = _heap_->handles;                                 \
+            _heap_->handles++;                                                                 \
+        }                                                                                      \
+                                                                                               \
+        size_t h = _heap_->buffer[_heap_->count];                                              \
+                                                                                               \
+        _heap_->entries[h].value = element;                                                    \
+        _heap_->entries[h].position = _heap_->count;                                           \
+        _heap_->count++;                                                                       \
+                                                                                               \
+        PFX##_impl_float_up(_heap_, _heap_->count - 1);                                        \
+                                                                                               \
+        if (handle)                                                                            \
+            *handle = h;                                                                       \
+                                                                                               \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    /* Removes the element at the top. Both result and handle can be NULL */                   \
+    bool PFX##_remove(struct SNAME *_heap_, V *result, size_t *handle)                         \
+    {                                                                                          \
+        if (PFX##_empty(_heap_))                                                               \
+            return false;                                                                      \
+                                                                                               \
+        if (handle)                                                                            \
+            *handle = _heap_->buffer[0];                                                       \
+                                                                                               \
+        PFX##_impl_remove_at(_heap_, 0, result);                                               \
+                                                                                               \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    /* Removes the element of a handle from anywhere in the heap */                            \
+    bool PFX##_remove_handle(struct SNAME *_heap_, size_t handle, V *result)                   \
+    {                                                                                          \
+        if (!PFX##_contains(_heap_, handle))                                                   \
+            return false;                                                                      \
+                                                                                               \
+        PFX##_impl_remove_at(_heap_, _heap_->entries[handle].position, result);                \
+                                                                                               \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    /* Replaces the element of a handle, floating it up or down as needed */                   \
+    bool PFX##_update(struct SNAME *_heap_, size_t handle, V element)                          \
+    {                                                                                          \
+        if (!PFX##_contains(_heap_, handle))                                                   \
+            return false;                                                                      \
+                                                                                               \
+        _heap_->entries[handle].value = element;                                               \
+                                                                                               \
+        PFX##_impl_fix(_heap_, _heap_->entries[handle].position);                              \
+                                                                                               \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    /* Same as update but fails if element is greater than the current one */                  \
+    bool PFX##_decrease_key(struct SNAME *_heap_, size_t handle, V element)                    \
+    {                                                                                          \
+        if (!PFX##_contains(_heap_, handle))                                                   \
+            return false;                                                                      \
+                                                                                               \
+        if (_heap_->cmp(element, _heap_->entries[handle].value) > 0)                           \
+            return false;                                                                      \
+                                                                                               \
+        return PFX##_update(_heap_, handle, element);                                          \
+    }                                                                                          \
+                                                                                               \
+    /* Same as update but fails if element is less than the current one */                     \
+    bool PFX##_increase_key(struct SNAME *_heap_, size_t handle, V element)                    \
+    {                                                                                          \
+        if (!PFX##_contains(_heap_, handle))                                                   \
+            return false;                                                                      \
+                                                                                               \
+        if (_heap_->cmp(element, _heap_->entries[handle].value) < 0)                           \
+            return false;                                                                      \
+                                                                                               \
+        return PFX##_update(_heap_, handle, element);                                          \
+    }                                                                                          \
+                                                                                               \
+    /* The element at the top and its handle. Both value and handle can be NULL */             \
+    bool PFX##_peek(struct SNAME *_heap_, V *value, size_t *handle)                            \
+    {                                                                                          \
+        if (PFX##_empty(_heap_))                                                               \
+            return false;                                                                      \
+                                                                                               \
+        if (value)                                                                             \
+            *value = _heap_->entries[_heap_->buffer[0]].value;                                 \
+        if (handle)                                                                            \
+            *handle = _heap_->buffer[0];                                                       \
+                                                                                               \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    V PFX##_get(struct SNAME *_heap_, size_t handle)                                           \
+    {                                                                                          \
+        if (!PFX##_contains(_heap_, handle))                                                   \
+            return (V){0};                                                                     \
+                                                                                               \
+        return _heap_->entries[handle].value;                                                  \
+    }                                                                                          \
+                                                                                               \
+    /* If the handle belongs to an element that is in the heap */                              \
+    bool PFX##_contains(struct SNAME *_heap_, size_t handle)                                   \
+    {                                                                                          \
+        return handle < _heap_->handles && _heap_->entries[handle].position < _heap_->count;   \
+    }                                                                                          \
+                                                                                               \
+    bool PFX##_empty(struct SNAME *_heap_)                                                     \
+    {                                                                                          \
+        return _heap_->count == 0;                                                             \
+    }                                                                                          \
+                                                                                               \
+    bool PFX##_full(struct SNAME *_heap_)                                                      \
+    {                                                                                          \
+        return _heap_->count >= _heap_->capacity;                                              \
+    }                                                                                          \
+                                                                                               \
+    size_t PFX##_count(struct SNAME *_heap_)                                                   \
+    {                                                                                          \
+        return _heap_->count;                                                                  \
+    }                                                                                          \
+                                                                                               \
+    size_t PFX##_memory_usage(struct SNAME *_heap_)                                            \
+    {                                                                                          \
+        size_t entry = sizeof(size_t) + sizeof(struct SNAME##_entry);                          \
+                                                                                               \
+        return sizeof(struct SNAME) + entry * _heap_->capacity;                                \
+    }                                                                                          \
+                                                                                               \
+    size_t PFX##_capacity(struct SNAME *_heap_)                                                \
+    {                                                                                          \
+        return _heap_->capacity;                                                               \
+    }                                                                                          \
+                                                                                               \
+    /* The capacity can't be less than the amount of handles given out, so that */             \
+    /* none of them is invalidated */                                                          \
+    bool PFX##_resize(struct SNAME *_heap_, size_t capacity)                                   \
+    {                                                                                          \
+        if (PFX##_capacity(_heap_) == capacity)                                                \
+            return true;                                                                       \
+                                                                                               \
+        if (capacity < _heap_->handles || capacity > SIZE_MAX / sizeof(struct SNAME##_entry))  \
+            return false;                                                                      \
+                                                                                               \
+        size_t *new_buffer = _heap_->alloc->realloc(_heap_->buffer,                            \
+                                                    sizeof(size_t) * capacity);                \
+                                                                                               \
+        if (CMC_UNLIKELY(!new_buffer))                                                         \
+            return false;                                                                      \
+                                                                                               \
+        _heap_->buffer = new_buffer;                                                           \
+                                                                                               \
+        struct SNAME##_entry *new_entries =                                                    \
+            _heap_->alloc->realloc(_heap_->entries, sizeof(struct SNAME##_entry) * capacity);  \
+                                                                                               \
+        /* The buffer is left with its new size, which is still valid */                       \
+        if (!new_entries)                                                                      \
+            return false;                                                                      \
+                                                                                               \
+        _heap_->entries = new_entries;                                                         \
+        _heap_->capacity = capacity;                                                           \
+                                                                                               \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    struct cmc_string PFX##_to_string(struct SNAME *_heap_)                                    \
+    {                                                                                          \
+        struct cmc_string str;                                                                 \
+        struct SNAME *h_ = _heap_;                                                             \
+        const char *name = #SNAME;                                                             \
+        const char *t = h_->HO == 1 ? "MaxHeap" : "MinHeap";                                   \
+                                                                                               \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_indexedheap, name, h_, h_->buffer,      \
+                 h_->entries, h_->capacity, h_->count, h_->handles, t, h_->cmp);               \
+                                                                                               \
+        return str;                                                                            \
+    }                                                                                          \
+                                                                                               \
+    /* The handle at position is held aside while the parents it is above of */                \
+    /* are moved down, and then it is written to where it stops */                             \
+    static void PFX##_impl_float_up(struct SNAME *_heap_, size_t position)                     \
+    {                                                                                          \
+        size_t handle = _heap_->buffer[position];                                              \
+        V value = _heap_->entries[handle].value;                                               \
+                                                                                               \
+        int mod = _heap_->HO;                                                                  \
+                                                                                               \
+        while (position > 0)                                                                   \
+        {                                                                                      \
+            size_t parent = (position - 1) / CMC_HEAP_ARITY;                                   \
+            size_t above = _heap_->buffer[parent];                                             \
+                                                                                               \
+            if (_heap_->cmp(value, _heap_->entries[above].value) * mod <= 0)                   \
+                break;                                                                         \
+                                                                                               \
+            _heap_->buffer[position] = above;                                                  \
+            _heap_->entries[above].position = position;                                        \
+                                                                                               \
+            position = parent;                                                                 \
+        }                                                                                      \
+                                                                                               \
+        _heap_->buffer[position] = handle;                                                     \
+        _heap_->entries[handle].position = position;                                           \
+    }                                                                                          \
+                                                                                               \
+    static void PFX##_impl_float_down(struct SNAME *_heap_, size_t position)                   \
+    {                                                                                          \
+        size_t handle = _heap_->buffer[position];                                              \
+        V value = _heap_->entries[handle].value;                                               \
+                                                                                               \
+        int mod = _heap_->HO;                                                                  \
+                                                                                               \
+        while (true)                                                                           \
+        {                                                                                      \
+            size_t first = CMC_HEAP_ARITY * position + 1;                                      \
+                                                                                               \
+            if (first >= _heap_->count)                                                        \
+                break;                                                                         \
+                                                                                               \
+            size_t last = first + CMC_HEAP_ARITY;                                              \
+                                                                                               \
+            if (last > _heap_->count)                                                          \
+                last = _heap_->count;                                                          \
+                                                                                               \
+            /* Child that goes up if it is above the handle being floated down */              \
+            size_t best = first;                                                               \
+                                                                                               \
+            for (size_t child = first + 1; child < last; child++)                              \
+            {                                                                                  \
+                V a = _heap_->entries[_heap_->buffer[child]].value;                            \
+                V b = _heap_->entries[_heap_->buffer[best]].value;                             \
+                                                                                               \
+                if (_heap_->cmp(a, b) * mod > 0)                                               \
+                    best = child;                                                              \
+            }                                                                                  \
+                                                                                               \
+            size_t below = _heap_->buffer[best];                                               \
+                                                                                               \
+            if (_heap_->cmp(_heap_->entries[below].value, value) * mod <= 0)                   \
+                break;                                                                         \
+                                                                                               \
+            _heap_->buffer[position] = below;                                                  \
+            _heap_->entries[below].position = position;                                        \
+                                                                                               \
+            position = best;                                                                   \
+        }                                                                                      \
+                                                                                               \
+        _heap_->buffer[position] = handle;                                                     \
+        _heap_->entries[handle].position = position;                                           \
+    }                                                                                          \
+                                                                                               \
+    /* Restores the heap property after the element at position was changed */                 \
+    static void PFX##_impl_fix(struct SNAME *_heap_, size_t position)                          \
+    {                                                                                          \
+        if (position > 0)                                                                      \
+        {                                                                                      \
+            size_t parent = _heap_->buffer[(position - 1) / CMC_HEAP_ARITY];                   \
+                                                                                               \
+            V value = _heap_->entries[_heap_->buffer[position]].value;                         \
+                                                                                               \
+            if (_heap_->cmp(value, _heap_->entries[parent].value) * _heap_->HO > 0)            \
+            {                                                                                  \
+                PFX##_impl_float_up(_heap_, position);                                         \
+                return;                                                                        \
+            }                                                                                  \
+        }                                                                                      \
+                                                                                               \
+        PFX##_impl_float_down(_heap_, position);                                               \
+    }                                                                                          \
+                                                                                               \
+    /* The last handle of the heap takes the place of the removed one, which */                \
+    /* becomes the first free handle */                                                        \
+    static void PFX##_impl_remove_at(struct SNAME *_heap_, size_t position, V *result)         \
+    {                                                                                          \
+        size_t handle = _heap_->buffer[position];                                              \
+                                                                                               \
+        if (result)                                                                            \
+            *result = _heap_->entries[handle].value;                                           \
+                                                                                               \
+        _heap_->entries[handle].value = (V){0};                                                \
+        _heap_->count--;                                                                       \
+                                                                                               \
+        if (position != _heap_->count)                                                         \
+        {                                                                                      \
+            size_t last = _heap_->buffer[_heap_->count];                                       \
+                                                                                               \
+            _heap_->buffer[position] = last;                                                   \
+            _heap_->entries[last].position = position;                                         \
+                                                                                               \
+            PFX##_impl_fix(_heap_, position);                                                  \
+        }                                                                                      \
+                                                                                               \
+        _heap_->buffer[_heap_->count] = handle;                                                \
+        _heap_->entries[handle].position = _heap_->count;                                      \
+    }
+
+#endif /* CMC_INDEXEDHEAP_H */
@@ -26,11 +26,22 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_growth.h"
+#include "../utl/cmc_serial.h"
 #include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
 
 /* to_string format */
 static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity:%" PRIuMAX ", size:%" PRIuMAX ", count:%" PRIuMAX ", cmp:%p }";
 
+/* A removal shrinks a collection once less than this fraction of what it */
+/* can hold without growing is in use. Define it as 0 to never shrink */
+#ifndef CMC_SHRINK_LOW_WATER
+#define CMC_SHRINK_LOW_WATER 0.25
+#endif
+
 #define CMC_GENERATE_INTERVALHEAP(PFX, SNAME, V)    \
     CMC_GENERATE_INTERVALHEAP_HEADER(PFX, SNAME, V) \
     CMC_GENERATE_INTERVALHEAP_SOURCE(PFX, SNAME, V)
@@ -41,6 +52,19 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
 #define CMC_WRAPGEN_INTERVALHEAP_SOURCE(PFX, SNAME, K, V) \
     CMC_GENERATE_INTERVALHEAP_SOURCE(PFX, SNAME, V)
 
+/* Same as CMC_GENERATE_INTERVALHEAP but elements are compared by calling */
+/* CMP directly, so the compiler can inline it. The function given to new */
+/* is still stored but only used by copy_of and to_string */
+#define CMC_GENERATE_INTERVALHEAP_EX(PFX, SNAME, V, CMP) \
+    CMC_GENERATE_INTERVALHEAP_HEADER(PFX, SNAME, V)      \
+    CMC_GENERATE_INTERVALHEAP_EX_SOURCE(PFX, SNAME, V, CMP)
+
+#define CMC_GENERATE_INTERVALHEAP_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_INTERVALHEAP_SOURCE(PFX, SNAME, V, _heap_->cmp)
+
+#define CMC_GENERATE_INTERVALHEAP_EX_SOURCE(PFX, SNAME, V, CMP) \
+    CMC_IMPL_INTERVALHEAP_SOURCE(PFX, SNAME, V, CMP)
+
 /* HEADER ********************************************************************/
 #define CMC_GENERATE_INTERVALHEAP_HEADER(PFX, SNAME, V)                    \
                                                                            \
@@ -67,6 +91,9 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
                                                                            \
         /* Function that returns an iterator to the end of the heap */     \
         struct SNAME##_iter (*it_end)(struct SNAME *);                     \
+                                                                           \
+        /* Custom allocation functions */                                  \
+        struct cmc_alloc_node *alloc;                                      \
     };                                                                     \
                                                                            \
     /* Heap Node */                                                        \
@@ -96,12 +123,21 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
     /* Collection Functions */                                             \
     /* Collection Allocation and Deallocation */                           \
     struct SNAME *PFX##_new(size_t capacity, int (*compare)(V, V));        \
+    struct SNAME *PFX##_new_custom(size_t capacity, int (*compare)(V, V),  \
+                                   struct cmc_alloc_node *alloc);          \
+    struct SNAME *PFX##_new_from(V *elements, size_t n,                    \
+                                 int (*compare)(V, V));                    \
     void PFX##_clear(struct SNAME *_heap_, void (*deallocator)(V));        \
     void PFX##_free(struct SNAME *_heap_, void (*deallocator)(V));         \
     /* Collection Input and Output */                                      \
     bool PFX##_insert(struct SNAME *_heap_, V element);                    \
+    bool PFX##_insert_many(struct SNAME *_heap_, V *elements, size_t n);   \
     bool PFX##_remove_max(struct SNAME *_heap_, V *result);                \
     bool PFX##_remove_min(struct SNAME *_heap_, V *result);                \
+    bool PFX##_offer_bounded_max(struct SNAME *_heap_, V element,          \
+                                 size_t k);                                \
+    bool PFX##_offer_bounded_min(struct SNAME *_heap_, V element,          \
+                                 size_t k);                                \
     /* Collection Update */                                                \
     bool PFX##_update_max(struct SNAME *_heap_, V element);                \
     bool PFX##_update_min(struct SNAME *_heap_, V element);                \
@@ -110,15 +146,32 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
     bool PFX##_min(struct SNAME *_heap_, V *value);                        \
     /* Collection State */                                                 \
     bool PFX##_contains(struct SNAME *_heap_, V element);                  \
-    bool PFX##_empty(struct SNAME *_heap_);                                \
+    CMC_PURE bool PFX##_empty(struct SNAME *_heap_);                       \
     bool PFX##_full(struct SNAME *_heap_);                                 \
-    size_t PFX##_count(struct SNAME *_heap_);                              \
+    CMC_PURE size_t PFX##_count(struct SNAME *_heap_);                     \
+    size_t PFX##_memory_usage(struct SNAME *_heap_);                       \
     size_t PFX##_capacity(struct SNAME *_heap_);                           \
     /* Collection Utility */                                               \
     bool PFX##_resize(struct SNAME *_heap_, size_t capacity);              \
+    bool PFX##_shrink_to_fit(struct SNAME *_heap_);                        \
+    bool PFX##_reserve(struct SNAME *_heap_, size_t capacity);             \
     struct SNAME *PFX##_copy_of(struct SNAME *_set_, V (*copy_func)(V));   \
+    size_t PFX##_to_array(struct SNAME *_heap_, V *CMC_RESTRICT elements,  \
+                          size_t size);                                    \
     bool PFX##_equals(struct SNAME *_heap1_, struct SNAME *_heap2_);       \
     struct cmc_string PFX##_to_string(struct SNAME *_heap_);               \
+    bool PFX##_to_string_full(struct SNAME *_heap_,                        \
+                              struct cmc_string_builder *builder,          \
+                              const char *elem_fmt);                       \
+    bool PFX##_write(struct SNAME *_heap_, FILE *file,                     \
+                     void (*fmt)(FILE *, V));                              \
+    bool PFX##_write_fd(struct SNAME *_heap_, int fd,                      \
+                        void (*fmt)(struct cmc_dump *, V));                \
+    /* Collection Serialization */                                         \
+    bool PFX##_save(struct SNAME *_heap_, FILE *file,                      \
+                    bool (*writer)(V, FILE *));                            \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(V, V),          \
+                                bool (*reader)(V *, FILE *));              \
                                                                            \
     /* Iterator Functions */                                               \
     /* Iterator Allocation and Deallocation */                             \
@@ -142,35 +195,49 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
     size_t PFX##_iter_index(struct SNAME##_iter *iter);                    \
                                                                            \
 /* SOURCE ********************************************************************/
-#define CMC_GENERATE_INTERVALHEAP_SOURCE(PFX, SNAME, V)                                                    \
+#define CMC_IMPL_INTERVALHEAP_SOURCE(PFX, SNAME, V, CMP)                                                   \
                                                                                                            \
     /* Implementation Detail Functions */                                                                  \
+    static inline int PFX##_impl_cmp(struct SNAME *_heap_, V a, V b);                                      \
     static void PFX##_impl_float_up_max(struct SNAME *_heap_);                                             \
     static void PFX##_impl_float_up_min(struct SNAME *_heap_);                                             \
-    static void PFX##_impl_float_down_max(struct SNAME *_heap_);                                           \
-    static void PFX##_impl_float_down_min(struct SNAME *_heap_);                                           \
+    static void PFX##_impl_float_down_max(struct SNAME *_heap_, size_t index);                             \
+    static void PFX##_impl_float_down_min(struct SNAME *_heap_, size_t index);                             \
+    static void PFX##_impl_heapify(struct SNAME *_heap_);                                                  \
+    static void PFX##_impl_low_water(struct SNAME *_heap_);                                                \
+    static bool PFX##_impl_grow(struct SNAME *_heap_, size_t required);                                    \
     static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_heap_);                                  \
     static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_heap_);                                    \
                                                                                                            \
     struct SNAME *PFX##_new(size_t capacity, int (*compare)(V, V))                                         \
     {                                                                                                      \
+        return PFX##_new_custom(capacity, compare, NULL);                                                  \
+    }                                                                                                      \
+                                                                                                           \
+    struct SNAME *PFX##_new_custom(size_t capacity, int (*compare)(V, V), struct cmc_alloc_node *alloc)    \
+    {                                                                                                      \
+        if (!alloc)                                                                                        \
+            alloc = &cmc_alloc_node_default;                                                               \
+                                                                                                           \
         if (capacity == 0 || capacity == UINT64_MAX)                                                       \
             return NULL;                                                                                   \
                                                                                                            \
-        struct SNAME *_heap_ = malloc(sizeof(struct SNAME));                                               \
+        struct SNAME *_heap_ = alloc->malloc(sizeof(struct SNAME));                                        \
                                                                                                            \
-        if (!_heap_)                                                                                       \
+        if (CMC_UNLIKELY(!_heap_))                                                                         \
             return NULL;                                                                                   \
                                                                                                            \
+        _heap_->alloc = alloc;                                                                             \
+                                                                                                           \
         /* Since each node can store two elements, divide the actual capacity by 2 */                      \
         /* Round the capacity of nodes up */                                                               \
         capacity = capacity % 2 == 0 ? capacity / 2 : (capacity + 1) / 2;                                  \
                                                                                                            \
-        _heap_->buffer = calloc(capacity, sizeof(struct SNAME##_node));                                    \
+        _heap_->buffer = alloc->calloc(capacity, sizeof(struct SNAME##_node));                             \
                                                                                                            \
-        if (!_heap_->buffer)                                                                               \
+        if (CMC_UNLIKELY(!_heap_->buffer))                                                                 \
         {                                                                                                  \
-            free(_heap_);                                                                                  \
+            alloc->free(_heap_);                                                                           \
             return NULL;                                                                                   \
         }                                                                                                  \
                                                                                                            \
@@ -185,6 +252,20 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
         return _heap_;                                                                                     \
     }                                                                                                      \
                                                                                                            \
+    /* Creates a heap out of the n elements in linear time. The capacity is */                             \
+    /* n, or 1 if n is 0 */                                                                                \
+    struct SNAME *PFX##_new_from(V *elements, size_t n, int (*compare)(V, V))                              \
+    {                                                                                                      \
+        struct SNAME *_heap_ = PFX##_new(n > 0 ? n : 1, compare);                                          \
+                                                                                                           \
+        if (CMC_UNLIKELY(!_heap_))                                                                         \
+            return NULL;                                                                                   \
+                                                                                                           \
+        PFX##_insert_many(_heap_, elements, n);                                                            \
+                                                                                                           \
+        return _heap_;                                                                                     \
+    }                                                                                                      \
+                                                                                                           \
     void PFX##_clear(struct SNAME *_heap_, void (*deallocator)(V))                                         \
     {                                                                                                      \
         if (deallocator)                                                                                   \
@@ -211,16 +292,16 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
             }                                                                                              \
         }                                                                                                  \
                                                                                                            \
-        free(_heap_->buffer);                                                                              \
+        _heap_->alloc->free(_heap_->buffer);                                                               \
                                                                                                            \
-        free(_heap_);                                                                                      \
+        _heap_->alloc->free(_heap_);                                                                       \
     }                                                                                                      \
                                                                                                            \
     bool PFX##_insert(struct SNAME *_heap_, V element)                                                     \
     {                                                                                                      \
         if (PFX##_full(_heap_))                                                                            \
         {                                                                                                  \
-            if (!PFX##_resize(_heap_, PFX##_capacity(_heap_) * 4))                                         \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_heap_, _heap_->count + 1)))                                 \
                 return false;                                                                              \
         }                                                                                                  \
                                                                                                            \
@@ -237,7 +318,7 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
             struct SNAME##_node *curr_node = &(_heap_->buffer[_heap_->size - 1]);                          \
                                                                                                            \
             /* Decide if the new element goes into the MinHeap or MaxHeap */                               \
-            if (_heap_->cmp(curr_node->data[0], element) > 0)                                              \
+            if (PFX##_impl_cmp(_heap_, curr_node->data[0], element) > 0)                                   \
             {                                                                                              \
                 /* Swap current value and add new element to the MinHeap */                                \
                 curr_node->data[1] = curr_node->data[0];                                                   \
@@ -256,17 +337,53 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
             return true;                                                                                   \
                                                                                                            \
         /* Determine wheather to do a MaxHeap insert or a MinHeap insert */                                \
-        struct SNAME##_node *parent = &(_heap_->buffer[(_heap_->size - 1) / 2]);                           \
+        struct SNAME##_node *parent = &(_heap_->buffer[(_heap_->size - 2) / 2]);                           \
                                                                                                            \
-        if (_heap_->cmp(parent->data[0], element) > 0)                                                     \
+        if (PFX##_impl_cmp(_heap_, parent->data[0], element) > 0)                                          \
             PFX##_impl_float_up_min(_heap_);                                                               \
-        else if (_heap_->cmp(parent->data[1], element) < 0)                                                \
+        else if (PFX##_impl_cmp(_heap_, parent->data[1], element) < 0)                                     \
             PFX##_impl_float_up_max(_heap_);                                                               \
         /* else no float up required */                                                                    \
                                                                                                            \
         return true;                                                                                       \
     }                                                                                                      \
                                                                                                            \
+    /* Inserts the n elements, growing the buffer at most once. If there are */                            \
+    /* at least as many of them as there are elements in the heap the whole */                             \
+    /* buffer is heapified in linear time, otherwise each one is inserted */                               \
+    bool PFX##_insert_many(struct SNAME *_heap_, V *elements, size_t n)                                    \
+    {                                                                                                      \
+        if (n == 0)                                                                                        \
+            return true;                                                                                   \
+                                                                                                           \
+        if (_heap_->count + n > _heap_->capacity * 2)                                                      \
+        {                                                                                                  \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_heap_, _heap_->count + n)))                                 \
+                return false;                                                                              \
+        }                                                                                                  \
+                                                                                                           \
+        if (n < _heap_->count)                                                                             \
+        {                                                                                                  \
+            for (size_t i = 0; i < n; i++)                                                                 \
+                PFX##_insert(_heap_, elements[i]);                                                         \
+                                                                                                           \
+            return true;                                                                                   \
+        }                                                                                                  \
+                                                                                                           \
+        for (size_t i = 0; i < n; i++, _heap_->count++)                                                    \
+            _heap_->buffer[_heap_->count / 2].data[_heap_->count % 2] = elements[i];                       \
+                                                                                                           \
+        /* The last node might only have its MinHeap value */                                              \
+        if (_heap_->count % 2 == 1)                                                                        \
+            _heap_->buffer[_heap_->count / 2].data[1] = (V){0};                                            \
+                                                                                                           \
+        _heap_->size = (_heap_->count + 1) / 2;                                                            \
+                                                                                                           \
+        PFX##_impl_heapify(_heap_);                                                                        \
+                                                                                                           \
+        return true;                                                                                       \
+    }                                                                                                      \
+                                                                                                           \
     bool PFX##_remove_max(struct SNAME *_heap_, V *result)                                                 \
     {                                                                                                      \
         if (PFX##_empty(_heap_))                                                                           \
@@ -278,7 +395,10 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
                                                                                                            \
             _heap_->buffer[0].data[0] = (V){0};                                                            \
                                                                                                            \
-            _heap_->count--;                                                                               \
+            _heap_->size = 0;                                                                              \
+            _heap_->count = 0;                                                                             \
+                                                                                                           \
+            PFX##_impl_low_water(_heap_);                                                                  \
                                                                                                            \
             return true;                                                                                   \
         }                                                                                                  \
@@ -307,7 +427,9 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
         _heap_->count--;                                                                                   \
                                                                                                            \
         /* FLoat Down on the MaxHeap */                                                                    \
-        PFX##_impl_float_down_max(_heap_);                                                                 \
+        PFX##_impl_float_down_max(_heap_, 0);                                                              \
+                                                                                                           \
+        PFX##_impl_low_water(_heap_);                                                                      \
                                                                                                            \
         return true;                                                                                       \
     }                                                                                                      \
@@ -323,7 +445,10 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
         {                                                                                                  \
             _heap_->buffer[0].data[0] = (V){0};                                                            \
                                                                                                            \
-            _heap_->count--;                                                                               \
+            _heap_->size = 0;                                                                              \
+            _heap_->count = 0;                                                                             \
+                                                                                                           \
+            PFX##_impl_low_water(_heap_);                                                                  \
                                                                                                            \
             return true;                                                                                   \
         }                                                                                                  \
@@ -350,11 +475,50 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
         _heap_->count--;                                                                                   \
                                                                                                            \
         /* FLoat Down on the MinHeap */                                                                    \
-        PFX##_impl_float_down_min(_heap_);                                                                 \
+        PFX##_impl_float_down_min(_heap_, 0);                                                              \
+                                                                                                           \
+        PFX##_impl_low_water(_heap_);                                                                      \
                                                                                                            \
         return true;                                                                                       \
     }                                                                                                      \
                                                                                                            \
+    /* Keeps at most the k largest elements offered. Until there are k */                                  \
+    /* elements it is the same as insert, then element only replaces the */                                \
+    /* minimum if it is greater. Returns true if element is in the heap. */                                \
+    /* The minimum that is replaced is not deallocated */                                                  \
+    bool PFX##_offer_bounded_max(struct SNAME *_heap_, V element, size_t k)                                \
+    {                                                                                                      \
+        if (k == 0)                                                                                        \
+            return false;                                                                                  \
+                                                                                                           \
+        if (_heap_->count < k)                                                                             \
+            return PFX##_insert(_heap_, element);                                                          \
+                                                                                                           \
+        if (PFX##_impl_cmp(_heap_, element, _heap_->buffer[0].data[0]) <= 0)                               \
+            return false;                                                                                  \
+                                                                                                           \
+        return PFX##_update_min(_heap_, element);                                                          \
+    }                                                                                                      \
+                                                                                                           \
+    /* Keeps at most the k smallest elements offered, replacing the maximum */                             \
+    bool PFX##_offer_bounded_min(struct SNAME *_heap_, V element, size_t k)                                \
+    {                                                                                                      \
+        if (k == 0)                                                                                        \
+            return false;                                                                                  \
+                                                                                                           \
+        if (_heap_->count < k)                                                                             \
+            return PFX##_insert(_heap_, element);                                                          \
+                                                                                                           \
+        V max;                                                                                             \
+                                                                                                           \
+        PFX##_max(_heap_, &max);                                                                           \
+                                                                                                           \
+        if (PFX##_impl_cmp(_heap_, element, max) >= 0)                                                     \
+            return false;                                                                                  \
+                                                                                                           \
+        return PFX##_update_max(_heap_, element);                                                          \
+    }                                                                                                      \
+                                                                                                           \
     bool PFX##_update_max(struct SNAME *_heap_, V element)                                                 \
     {                                                                                                      \
         if (PFX##_empty(_heap_))                                                                           \
@@ -364,21 +528,21 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
         {                                                                                                  \
             _heap_->buffer[0].data[0] = element;                                                           \
         }                                                                                                  \
-        else if (_heap_->cmp(element, _heap_->buffer[0].data[0]) < 0)                                      \
+        else if (PFX##_impl_cmp(_heap_, element, _heap_->buffer[0].data[0]) < 0)                           \
         {                                                                                                  \
             /* Corner case: we are updating the Max value but it is less than */                           \
             /* the Min value */                                                                            \
             _heap_->buffer[0].data[1] = _heap_->buffer[0].data[0];                                         \
             _heap_->buffer[0].data[0] = element;                                                           \
                                                                                                            \
-            PFX##_impl_float_down_max(_heap_);                                                             \
+            PFX##_impl_float_down_max(_heap_, 0);                                                          \
         }                                                                                                  \
         else                                                                                               \
         {                                                                                                  \
             /* Update Max element and float it down */                                                     \
             _heap_->buffer[0].data[1] = element;                                                           \
                                                                                                            \
-            PFX##_impl_float_down_max(_heap_);                                                             \
+            PFX##_impl_float_down_max(_heap_, 0);                                                          \
         }                                                                                                  \
                                                                                                            \
         return true;                                                                                       \
@@ -393,21 +557,21 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
         {                                                                                                  \
             _heap_->buffer[0].data[0] = element;                                                           \
         }                                                                                                  \
-        else if (_heap_->cmp(element, _heap_->buffer[0].data[1]) > 0)                                      \
+        else if (PFX##_impl_cmp(_heap_, element, _heap_->buffer[0].data[1]) > 0)                           \
         {                                                                                                  \
             /* Corner case: we are updating the Min value but it is greater */                             \
             /* than the Max value. */                                                                      \
             _heap_->buffer[0].data[0] = _heap_->buffer[0].data[1];                                         \
             _heap_->buffer[0].data[1] = element;                                                           \
                                                                                                            \
-            PFX##_impl_float_down_min(_heap_);                                                             \
+            PFX##_impl_float_down_min(_heap_, 0);                                                          \
         }                                                                                                  \
         else                                                                                               \
         {                                                                                                  \
             /* Update Min element and float it down */                                                     \
             _heap_->buffer[0].data[0] = element;                                                           \
                                                                                                            \
-            PFX##_impl_float_down_min(_heap_);                                                             \
+            PFX##_impl_float_down_min(_heap_, 0);                                                          \
         }                                                                                                  \
                                                                                                            \
         return true;                                                                                       \
@@ -442,7 +606,7 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
     {                                                                                                      \
         for (size_t i = 0; i < _heap_->count; i++)                                                         \
         {                                                                                                  \
-            if (_heap_->cmp(_heap_->buffer[i / 2].data[i % 2], element) == 0)                              \
+            if (PFX##_impl_cmp(_heap_, _heap_->buffer[i / 2].data[i % 2], element) == 0)                   \
                 return true;                                                                               \
         }                                                                                                  \
                                                                                                            \
@@ -465,6 +629,11 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
         return _heap_->count;                                                                              \
     }                                                                                                      \
                                                                                                            \
+    size_t PFX##_memory_usage(struct SNAME *_heap_)                                                        \
+    {                                                                                                      \
+        return sizeof(struct SNAME) + sizeof(struct SNAME##_node) * _heap_->capacity;                      \
+    }                                                                                                      \
+                                                                                                           \
     size_t PFX##_capacity(struct SNAME *_heap_)                                                            \
     {                                                                                                      \
         return _heap_->capacity;                                                                           \
@@ -472,20 +641,24 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
                                                                                                            \
     bool PFX##_resize(struct SNAME *_heap_, size_t capacity)                                               \
     {                                                                                                      \
-        if (PFX##_capacity(_heap_) == capacity)                                                            \
-            return true;                                                                                   \
-                                                                                                           \
         if (capacity < PFX##_count(_heap_))                                                                \
             return false;                                                                                  \
                                                                                                            \
         capacity = capacity % 2 == 0 ? capacity / 2 : (capacity + 1) / 2;                                  \
                                                                                                            \
-        struct SNAME##_node *new_buffer = realloc(_heap_->buffer, sizeof(struct SNAME##_node) * capacity); \
+        if (PFX##_capacity(_heap_) == capacity)                                                            \
+            return true;                                                                                   \
                                                                                                            \
-        if (!new_buffer)                                                                                   \
+        struct SNAME##_node *new_buffer = _heap_->alloc->realloc(_heap_->buffer,                           \
+                                                                 sizeof(struct SNAME##_node) * capacity);  \
+                                                                                                           \
+        if (CMC_UNLIKELY(!new_buffer))                                                                     \
             return false;                                                                                  \
                                                                                                            \
-        memset(new_buffer + _heap_->capacity, 0, sizeof(struct SNAME##_node) * _heap_->capacity);          \
+        /* Only the nodes past the old capacity are new */                                                 \
+        if (capacity > _heap_->capacity)                                                                   \
+            memset(new_buffer + _heap_->capacity, 0,                                                       \
+                   sizeof(struct SNAME##_node) * (capacity - _heap_->capacity));                           \
                                                                                                            \
         _heap_->buffer = new_buffer;                                                                       \
         _heap_->capacity = capacity;                                                                       \
@@ -493,20 +666,35 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
         return true;                                                                                       \
     }                                                                                                      \
                                                                                                            \
+    bool PFX##_shrink_to_fit(struct SNAME *_heap_)                                                         \
+    {                                                                                                      \
+        return PFX##_resize(_heap_, _heap_->count > 0 ? _heap_->count : 1);                                \
+    }                                                                                                      \
+                                                                                                           \
+    /* Grows the buffer so that at least capacity elements fit. Unlike */                                  \
+    /* resize it never shrinks the buffer */                                                               \
+    bool PFX##_reserve(struct SNAME *_heap_, size_t capacity)                                              \
+    {                                                                                                      \
+        if (capacity <= _heap_->capacity * 2)                                                              \
+            return true;                                                                                   \
+                                                                                                           \
+        return PFX##_resize(_heap_, capacity);                                                             \
+    }                                                                                                      \
+                                                                                                           \
     struct SNAME *PFX##_copy_of(struct SNAME *_heap_, V (*copy_func)(V))                                   \
     {                                                                                                      \
-        struct SNAME *result = malloc(sizeof(struct SNAME));                                               \
+        struct SNAME *result = _heap_->alloc->malloc(sizeof(struct SNAME));                                \
                                                                                                            \
-        if (!result)                                                                                       \
+        if (CMC_UNLIKELY(!result))                                                                         \
             return NULL;                                                                                   \
                                                                                                            \
         memcpy(result, _heap_, sizeof(struct SNAME));                                                      \
                                                                                                            \
-        result->buffer = malloc(sizeof(struct SNAME##_node) * _heap_->capacity);                           \
+        result->buffer = _heap_->alloc->malloc(sizeof(struct SNAME##_node) * _heap_->capacity);            \
                                                                                                            \
-        if (!result->buffer)                                                                               \
+        if (CMC_UNLIKELY(!result->buffer))                                                                 \
         {                                                                                                  \
-            free(result);                                                                                  \
+            _heap_->alloc->free(result);                                                                   \
             return NULL;                                                                                   \
         }                                                                                                  \
                                                                                                            \
@@ -521,6 +709,19 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
         return result;                                                                                     \
     }                                                                                                      \
                                                                                                            \
+    /* Copies up to size elements, in the order that they are iterated, to */                              \
+    /* elements and returns how many were copied */                                                        \
+    size_t PFX##_to_array(struct SNAME *_heap_, V *CMC_RESTRICT elements, size_t size)                     \
+    {                                                                                                      \
+        if (size > _heap_->count)                                                                          \
+            size = _heap_->count;                                                                          \
+                                                                                                           \
+        for (size_t i = 0; i < size; i++)                                                                  \
+            elements[i] = _heap_->buffer[i / 2].data[i % 2];                                               \
+                                                                                                           \
+        return size;                                                                                       \
+    }                                                                                                      \
+                                                                                                           \
     bool PFX##_equals(struct SNAME *_heap1_, struct SNAME *_heap2_)                                        \
     {                                                                                                      \
         if (PFX##_count(_heap1_) != PFX##_count(_heap2_))                                                  \
@@ -531,7 +732,7 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
             V element1 = _heap1_->buffer[i / 2].data[i % 2];                                               \
             V element2 = _heap2_->buffer[i / 2].data[i % 2];                                               \
                                                                                                            \
-            if (_heap1_->cmp(element1, element2) == 0)                                                     \
+            if (PFX##_impl_cmp(_heap1_, element1, element2) == 0)                                          \
                 return true;                                                                               \
         }                                                                                                  \
                                                                                                            \
@@ -550,11 +751,82 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
         return str;                                                                                        \
     }                                                                                                      \
                                                                                                            \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE)                                         \
+                                                                                                           \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE, (V))                                           \
+                                                                                                           \
+    bool PFX##_save(struct SNAME *_heap_, FILE *file, bool (*writer)(V, FILE *))                           \
+    {                                                                                                      \
+        uint32_t flags = writer ? 0 : CMC_SERIAL_RAW_VALUES;                                               \
+                                                                                                           \
+        if (!cmc_serial_write_header(file, "intervalheap", flags, 0, sizeof(V), 0,                         \
+                                     _heap_->count, _heap_->capacity * 2, 0))                              \
+            return false;                                                                                  \
+                                                                                                           \
+        /* Without a writer the nodes are written as they are */                                           \
+        if (!writer)                                                                                       \
+            return fwrite(_heap_->buffer, sizeof(struct SNAME##_node), _heap_->size, file) ==              \
+                   _heap_->size;                                                                           \
+                                                                                                           \
+        for (size_t i = 0; i < _heap_->count; i++)                                                         \
+        {                                                                                                  \
+            if (!writer(_heap_->buffer[i / 2].data[i % 2], file))                                          \
+                return false;                                                                              \
+        }                                                                                                  \
+                                                                                                           \
+        return true;                                                                                       \
+    }                                                                                                      \
+                                                                                                           \
+    /* The reader is only used if the heap was saved with a writer */                                      \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(V, V), bool (*reader)(V *, FILE *))             \
+    {                                                                                                      \
+        struct cmc_serial_header header;                                                                   \
+                                                                                                           \
+        if (!cmc_serial_read_header(file, "intervalheap", 0, sizeof(V), &header))                          \
+            return NULL;                                                                                   \
+                                                                                                           \
+        if (header.capacity < header.count)                                                                \
+            return NULL;                                                                                   \
+                                                                                                           \
+        /* Allocated with the saved capacity so that loading never grows */                                \
+        struct SNAME *_heap_ = PFX##_new(header.capacity, compare);                                        \
+                                                                                                           \
+        if (CMC_UNLIKELY(!_heap_))                                                                         \
+            return NULL;                                                                                   \
+                                                                                                           \
+        /* Nodes in use, the last one only holds one element if count is odd */                            \
+        size_t size = header.count / 2 + header.count % 2;                                                 \
+                                                                                                           \
+        if (header.flags & CMC_SERIAL_RAW_VALUES)                                                          \
+        {                                                                                                  \
+            if (fread(_heap_->buffer, sizeof(struct SNAME##_node), size, file) == size)                    \
+                _heap_->count = header.count;                                                              \
+        }                                                                                                  \
+        else                                                                                               \
+        {                                                                                                  \
+            while (_heap_->count < header.count &&                                                         \
+                   CMC_SERIAL_READ(false, reader,                                                          \
+                                   &(_heap_->buffer[_heap_->count / 2].data[_heap_->count % 2]),           \
+                                   file))                                                                  \
+                _heap_->count++;                                                                           \
+        }                                                                                                  \
+                                                                                                           \
+        if (_heap_->count != header.count)                                                                 \
+        {                                                                                                  \
+            PFX##_free(_heap_, NULL);                                                                      \
+            return NULL;                                                                                   \
+        }                                                                                                  \
+                                                                                                           \
+        _heap_->size = size;                                                                               \
+                                                                                                           \
+        return _heap_;                                                                                     \
+    }                                                                                                      \
+                                                                                                           \
     struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                              \
     {                                                                                                      \
-        struct SNAME##_iter *iter = malloc(sizeof(struct SNAME##_iter));                                   \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));                    \
                                                                                                            \
-        if (!iter)                                                                                         \
+        if (CMC_UNLIKELY(!iter))                                                                           \
             return NULL;                                                                                   \
                                                                                                            \
         PFX##_iter_init(iter, target);                                                                     \
@@ -564,7 +836,7 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
                                                                                                            \
     void PFX##_iter_free(struct SNAME##_iter *iter)                                                        \
     {                                                                                                      \
-        free(iter);                                                                                        \
+        iter->target->alloc->free(iter);                                                                   \
     }                                                                                                      \
                                                                                                            \
     void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                                  \
@@ -730,7 +1002,7 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
             {                                                                                              \
                 /* In this case, the current node has no MaxHeap value so we */                            \
                 /* instead compare with the MinHeap value */                                               \
-                if (_heap_->cmp(curr_node->data[0], parent->data[1]) < 0)                                  \
+                if (PFX##_impl_cmp(_heap_, curr_node->data[0], parent->data[1]) < 0)                       \
                     break;                                                                                 \
                                                                                                            \
                 /* Since the comparison above passed now we need to swap the */                            \
@@ -744,7 +1016,7 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
             else                                                                                           \
             {                                                                                              \
                 /* Usual case, just compare both MaxHeap values */                                         \
-                if (_heap_->cmp(curr_node->data[1], parent->data[1]) < 0)                                  \
+                if (PFX##_impl_cmp(_heap_, curr_node->data[1], parent->data[1]) < 0)                       \
                     break;                                                                                 \
                                                                                                            \
                 /* Swap with parent and repeat */                                                          \
@@ -773,7 +1045,7 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
                                                                                                            \
             struct SNAME##_node *parent = &(_heap_->buffer[P_index]);                                      \
                                                                                                            \
-            if (_heap_->cmp(curr_node->data[0], parent->data[0]) >= 0)                                     \
+            if (PFX##_impl_cmp(_heap_, curr_node->data[0], parent->data[0]) >= 0)                          \
                 break;                                                                                     \
                                                                                                            \
             /* Swap with parent and repeat */                                                              \
@@ -787,11 +1059,8 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
         }                                                                                                  \
     }                                                                                                      \
                                                                                                            \
-    static void PFX##_impl_float_down_max(struct SNAME *_heap_)                                            \
+    static void PFX##_impl_float_down_max(struct SNAME *_heap_, size_t index)                              \
     {                                                                                                      \
-        /* Floats Down from the MinHeap */                                                                 \
-        size_t index = 0;                                                                                  \
-                                                                                                           \
         struct SNAME##_node *curr_node = &(_heap_->buffer[index]);                                         \
                                                                                                            \
         while (true)                                                                                       \
@@ -814,9 +1083,9 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
                 /* If the right child is the last node and there is no MaxHeap value */                    \
                 /* then do the comparison with the MinHeap value */                                        \
                 if (R_index == _heap_->size - 1 && PFX##_count(_heap_) % 2 != 0)                           \
-                    child = _heap_->cmp(L->data[1], R->data[0]) > 0 ? L_index : R_index;                   \
+                    child = PFX##_impl_cmp(_heap_, L->data[1], R->data[0]) > 0 ? L_index : R_index;        \
                 else                                                                                       \
-                    child = _heap_->cmp(L->data[1], R->data[1]) > 0 ? L_index : R_index;                   \
+                    child = PFX##_impl_cmp(_heap_, L->data[1], R->data[1]) > 0 ? L_index : R_index;        \
             }                                                                                              \
             /* Pick the only one available */                                                              \
             else                                                                                           \
@@ -829,7 +1098,7 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
             {                                                                                              \
                 /* Odd case, compare with MinHeap value */                                                 \
                 /* If current value is not less than the child node's value, it is done */                 \
-                if (_heap_->cmp(curr_node->data[1], child_node->data[0]) >= 0)                             \
+                if (PFX##_impl_cmp(_heap_, curr_node->data[1], child_node->data[0]) >= 0)                  \
                     break;                                                                                 \
                                                                                                            \
                 /* Otherwise swap and continue */                                                          \
@@ -840,7 +1109,7 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
             else                                                                                           \
             {                                                                                              \
                 /* If current value is not less than the child node's value, it is done */                 \
-                if (_heap_->cmp(curr_node->data[1], child_node->data[1]) >= 0)                             \
+                if (PFX##_impl_cmp(_heap_, curr_node->data[1], child_node->data[1]) >= 0)                  \
                     break;                                                                                 \
                                                                                                            \
                 /* Otherwise swap and continue */                                                          \
@@ -849,7 +1118,7 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
                 curr_node->data[1] = tmp;                                                                  \
                                                                                                            \
                 /* Check if the MinHeap and MaxHeap values need to be swapped */                           \
-                if (_heap_->cmp(child_node->data[0], child_node->data[1]) > 0)                             \
+                if (PFX##_impl_cmp(_heap_, child_node->data[0], child_node->data[1]) > 0)                  \
                 {                                                                                          \
                     /* Swap because the MinHeap value is greater than the MaxHeap value */                 \
                     tmp = child_node->data[0];                                                             \
@@ -864,11 +1133,8 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
         }                                                                                                  \
     }                                                                                                      \
                                                                                                            \
-    static void PFX##_impl_float_down_min(struct SNAME *_heap_)                                            \
+    static void PFX##_impl_float_down_min(struct SNAME *_heap_, size_t index)                              \
     {                                                                                                      \
-        /* Floats Down from the MinHeap */                                                                 \
-        size_t index = 0;                                                                                  \
-                                                                                                           \
         struct SNAME##_node *curr_node = &(_heap_->buffer[index]);                                         \
                                                                                                            \
         while (true)                                                                                       \
@@ -888,7 +1154,7 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
                 struct SNAME##_node *L = &(_heap_->buffer[L_index]);                                       \
                 struct SNAME##_node *R = &(_heap_->buffer[R_index]);                                       \
                                                                                                            \
-                child = _heap_->cmp(L->data[0], R->data[0]) < 0 ? L_index : R_index;                       \
+                child = PFX##_impl_cmp(_heap_, L->data[0], R->data[0]) < 0 ? L_index : R_index;            \
             }                                                                                              \
             /* Pick the only one available */                                                              \
             else                                                                                           \
@@ -897,7 +1163,7 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
             struct SNAME##_node *child_node = &(_heap_->buffer[child]);                                    \
                                                                                                            \
             /* If current value is smaller than the child node's value, it is done */                      \
-            if (_heap_->cmp(curr_node->data[0], child_node->data[0]) < 0)                                  \
+            if (PFX##_impl_cmp(_heap_, curr_node->data[0], child_node->data[0]) < 0)                       \
                 break;                                                                                     \
                                                                                                            \
             /* Otherwise swap and continue */                                                              \
@@ -909,7 +1175,7 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
             /* MaxHeap values need to be swapped */                                                        \
             if (child != _heap_->size - 1 || PFX##_count(_heap_) % 2 == 0)                                 \
             {                                                                                              \
-                if (_heap_->cmp(child_node->data[0], child_node->data[1]) > 0)                             \
+                if (PFX##_impl_cmp(_heap_, child_node->data[0], child_node->data[1]) > 0)                  \
                 {                                                                                          \
                     /* Swap because the MinHeap value is greater than the MaxHeap value */                 \
                     tmp = child_node->data[0];                                                             \
@@ -924,6 +1190,51 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
         }                                                                                                  \
     }                                                                                                      \
                                                                                                            \
+    /* Floyd's method, from the last node to the first each node gets its */                               \
+    /* values in order and then both are floated down, so each subtree is */                               \
+    /* an interval heap before its root is */                                                              \
+    static void PFX##_impl_heapify(struct SNAME *_heap_)                                                   \
+    {                                                                                                      \
+        for (size_t i = _heap_->size; i > 0; i--)                                                          \
+        {                                                                                                  \
+            struct SNAME##_node *node = &(_heap_->buffer[i - 1]);                                          \
+                                                                                                           \
+            /* The last node might only have its MinHeap value */                                          \
+            if (i < _heap_->size || _heap_->count % 2 == 0)                                                \
+            {                                                                                              \
+                if (PFX##_impl_cmp(_heap_, node->data[0], node->data[1]) > 0)                              \
+                {                                                                                          \
+                    V tmp = node->data[0];                                                                 \
+                    node->data[0] = node->data[1];                                                         \
+                    node->data[1] = tmp;                                                                   \
+                }                                                                                          \
+            }                                                                                              \
+                                                                                                           \
+            PFX##_impl_float_down_min(_heap_, i - 1);                                                      \
+            PFX##_impl_float_down_max(_heap_, i - 1);                                                      \
+        }                                                                                                  \
+    }                                                                                                      \
+                                                                                                           \
+    /* Called after removals, halves the buffer until it is no longer mostly empty */                      \
+    static void PFX##_impl_low_water(struct SNAME *_heap_)                                                 \
+    {                                                                                                      \
+        size_t capacity = _heap_->capacity;                                                                \
+                                                                                                           \
+        /* Each node holds two elements */                                                                 \
+        while (capacity > 1 &&                                                                             \
+               (double)_heap_->count < (double)capacity * 2 * CMC_SHRINK_LOW_WATER)                        \
+            capacity /= 2;                                                                                 \
+                                                                                                           \
+        if (capacity != _heap_->capacity)                                                                  \
+            PFX##_resize(_heap_, capacity * 2);                                                            \
+    }                                                                                                      \
+                                                                                                           \
+    /* Called when the buffer is full, grows it by the policy of cmc_growth.h */                           \
+    static bool PFX##_impl_grow(struct SNAME *_heap_, size_t required)                                     \
+    {                                                                                                      \
+        return PFX##_resize(_heap_, cmc_growth_capacity(_heap_->capacity * 2, required));                  \
+    }                                                                                                      \
+                                                                                                           \
     static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_heap_)                                   \
     {                                                                                                      \
         struct SNAME##_iter iter;                                                                          \
@@ -942,6 +1253,13 @@ static const char *cmc_string_fmt_intervalheap = "%s at %p { buffer:%p, capacity
         PFX##_iter_to_end(&iter);                                                                          \
                                                                                                            \
         return iter;                                                                                       \
+    }                                                                                                      \
+                                                                                                           \
+    static inline int PFX##_impl_cmp(struct SNAME *_heap_, V a, V b)                                       \
+    {                                                                                                      \
+        (void)_heap_;                                                                                      \
+                                                                                                           \
+        return CMP(a, b);                                                                                  \
     }
 
 #endif /* CMC_INTERVALHEAP_H */
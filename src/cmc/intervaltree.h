@@ -0,0 +1,717 @@
+/**
+ * intervaltree.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * IntervalTree
+ *
+ * An IntervalTree maps closed intervals [low, high] to values and finds the
+ * intervals that overlap a given interval or that contain a given point.
+ * Like a TreeMap it has only unique keys, here an interval is only equal to
+ * another if both their endpoints are equal. Endpoints can be of any type K
+ * that can be compared, like addresses, timestamps or version numbers.
+ *
+ * Finding the k intervals that overlap a query takes log(n) + k, while a list
+ * of ranges would have to check every one of them.
+ *
+ * Implementation
+ *
+ * This is the same AVL Tree as the TreeMap, ordered by the low endpoint and
+ * then by the high endpoint, where every node also keeps the maximum high
+ * endpoint of its subtree. The rotations and the rebalance update it together
+ * with the height. A query skips every subtree whose maximum is below the
+ * query and stops going right at the first node whose low endpoint is past
+ * the query, since every node after it starts even later.
+ */
+
+#ifndef CMC_INTERVALTREE_H
+#define CMC_INTERVALTREE_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_intervaltree = "%s at %p { root:%p, count:%" PRIuMAX ", cmp:%p }";
+
+#define CMC_GENERATE_INTERVALTREE(PFX, SNAME, K, V)    \
+    CMC_GENERATE_INTERVALTREE_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_INTERVALTREE_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_INTERVALTREE_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_INTERVALTREE_HEADER(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_INTERVALTREE_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_INTERVALTREE_SOURCE(PFX, SNAME, K, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_INTERVALTREE_HEADER(PFX, SNAME, K, V)                              \
+                                                                                        \
+    /* IntervalTree Structure */                                                        \
+    struct SNAME                                                                        \
+    {                                                                                   \
+        /* Root node */                                                                 \
+        struct SNAME##_node *root;                                                      \
+                                                                                        \
+        /* Current amount of intervals */                                               \
+        size_t count;                                                                   \
+                                                                                        \
+        /* Endpoint comparison function */                                              \
+        int (*cmp)(K, K);                                                               \
+                                                                                        \
+        /* Custom allocation functions */                                               \
+        struct cmc_alloc_node *alloc;                                                   \
+    };                                                                                  \
+                                                                                        \
+    /* IntervalTree Node */                                                             \
+    struct SNAME##_node                                                                 \
+    {                                                                                   \
+        /* Interval endpoints */                                                        \
+        K low;                                                                          \
+        K high;                                                                         \
+                                                                                        \
+        /* Interval value */                                                            \
+        V value;                                                                        \
+                                                                                        \
+        /* Greatest high endpoint of the subtree */                                     \
+        K max;                                                                          \
+                                                                                        \
+        /* Node height used by the AVL tree to keep it strictly balanced */             \
+        unsigned char height;                                                           \
+                                                                                        \
+        /* Right child node or subtree */                                               \
+        struct SNAME##_node *right;                                                     \
+                                                                                        \
+        /* Left child node or subtree */                                                \
+        struct SNAME##_node *left;                                                      \
+                                                                                        \
+        /* Parent node */                                                               \
+        struct SNAME##_node *parent;                                                    \
+    };                                                                                  \
+                                                                                        \
+    /* An interval and its value returned by queries */                                 \
+    struct SNAME##_interval                                                             \
+    {                                                                                   \
+        K low;                                                                          \
+        K high;                                                                         \
+        V value;                                                                        \
+    };                                                                                  \
+                                                                                        \
+    /* Collection Functions */                                                          \
+    /* Collection Allocation and Deallocation */                                        \
+    struct SNAME *PFX##_new(int (*compare)(K, K));                                      \
+    struct SNAME *PFX##_new_custom(int (*compare)(K, K), struct cmc_alloc_node *alloc); \
+    void PFX##_clear(struct SNAME *_tree_, void (*deallocator)(K, K, V));               \
+    void PFX##_free(struct SNAME *_tree_, void (*deallocator)(K, K, V));                \
+    /* Collection Input and Output */                                                   \
+    bool PFX##_insert(struct SNAME *_tree_, K low, K high, V value);                    \
+    bool PFX##_update(struct SNAME *_tree_, K low, K high, V new_value, V *old_value);  \
+    bool PFX##_remove(struct SNAME *_tree_, K low, K high, V *out_value);               \
+    /* Element Access */                                                                \
+    V PFX##_get(struct SNAME *_tree_, K low, K high);                                   \
+    V *PFX##_get_ref(struct SNAME *_tree_, K low, K high);                              \
+    bool PFX##_span(struct SNAME *_tree_, K *low, K *high);                             \
+    /* Interval Queries */                                                              \
+    bool PFX##_overlaps_any(struct SNAME *_tree_, K low, K high);                       \
+    size_t PFX##_overlaps(struct SNAME *_tree_, K low, K high,                          \
+                          struct SNAME##_interval *result, size_t size);                \
+    size_t PFX##_stab(struct SNAME *_tree_, K point, struct SNAME##_interval *result,   \
+                      size_t size);                                                     \
+    /* Collection State */                                                              \
+    bool PFX##_contains(struct SNAME *_tree_, K low, K high);                           \
+    CMC_PURE bool PFX##_empty(struct SNAME *_tree_);                                    \
+    CMC_PURE size_t PFX##_count(struct SNAME *_tree_);                                  \
+    size_t PFX##_memory_usage(struct SNAME *_tree_);                                    \
+    /* Collection Utility */                                                            \
+    struct cmc_string PFX##_to_string(struct SNAME *_tree_);                            \
+                                                                                        \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_INTERVALTREE_SOURCE(PFX, SNAME, K, V)                                    \
+                                                                                              \
+    /* Implementation Detail Functions */                                                     \
+    static int PFX##_impl_cmp(struct SNAME *_tree_, K low1, K high1, K low2, K high2);        \
+    static struct SNAME##_node *PFX##_impl_get_node(struct SNAME *_tree_, K low, K high);     \
+    static size_t PFX##_impl_overlaps(struct SNAME *_tree_, struct SNAME##_node *node, K low, \
+                                      K high, struct SNAME##_interval *result, size_t size,   \
+                                      size_t found);                                          \
+    static unsigned char PFX##_impl_h(struct SNAME##_node *node);                             \
+    static unsigned char PFX##_impl_hupdate(struct SNAME##_node *node);                       \
+    static K PFX##_impl_mupdate(struct SNAME *_tree_, struct SNAME##_node *node);             \
+    static void PFX##_impl_rotate_right(struct SNAME *_tree_, struct SNAME##_node **Z);       \
+    static void PFX##_impl_rotate_left(struct SNAME *_tree_, struct SNAME##_node **Z);        \
+    static void PFX##_impl_rebalance(struct SNAME *_tree_, struct SNAME##_node *node);        \
+                                                                                              \
+    struct SNAME *PFX##_new(int (*compare)(K, K))                                             \
+    {                                                                                         \
+        return PFX##_new_custom(compare, NULL);                                               \
+    }                                                                                         \
+                                                                                              \
+    struct SNAME *PFX##_new_custom(int (*compare)(K, K), struct cmc_alloc_node *alloc)        \
+    {                                                                                         \
+        if (!alloc)                                                                           \
+            alloc = &cmc_alloc_node_default;                                                  \
+                                                                                              \
+        if (!compare)                                                                         \
+            return NULL;                                                                      \
+                                                                                              \
+        struct SNAME *_tree_ = alloc->malloc(sizeof(struct SNAME));                           \
+                                                                                              \
+        if (CMC_UNLIKELY(!_tree_))                                                            \
+            return NULL;                                                                      \
+                                                                                              \
+        _tree_->root = NULL;                                                                  \
+        _tree_->count = 0;                                                                    \
+        _tree_->cmp = compare;                                                                \
+        _tree_->alloc = alloc;                                                                \
+                                                                                              \
+        return _tree_;                                                                        \
+    }                                                                                         \
+                                                                                              \
+    /* Frees every node from the leaves up, following the parent links */                     \
+    /* instead of recursing */                                                                \
+    void PFX##_clear(struct SNAME *_tree_, void (*deallocator)(K, K, V))                      \
+    {                                                                                         \
+        struct SNAME##_node *scan = _tree_->root;                                             \
+                                                                                              \
+        while (scan != NULL)                                                                  \
+        {                                                                                     \
+            if (scan->left != NULL)                                                           \
+                scan = scan->left;                                                            \
+            else if (scan->right != NULL)                                                     \
+                scan = scan->right;                                                           \
+            else                                                                              \
+            {                                                                                 \
+                struct SNAME##_node *parent = scan->parent;                                   \
+                                                                                              \
+                if (parent != NULL)                                                           \
+                {                                                                             \
+                    if (parent->left == scan)                                                 \
+                        parent->left = NULL;                                                  \
+                    else                                                                      \
+                        parent->right = NULL;                                                 \
+                }                                                                             \
+                                                                                              \
+                if (deallocator)                                                              \
+                    deallocator(scan->low, scan->high, scan->value);                          \
+                                                                                              \
+                _tree_->alloc->free(scan);                                                    \
+                                                                                              \
+                scan = parent;                                                                \
+            }                                                                                 \
+        }                                                                                     \
+                                                                                              \
+        _tree_->root = NULL;                                                                  \
+        _tree_->count = 0;                                                                    \
+    }                                                                                         \
+                                                                                              \
+    void PFX##_free(struct SNAME *_tree_, void (*deallocator)(K, K, V))                       \
+    {                                                                                         \
+        PFX##_clear(_tree_, deallocator);                                                     \
+                                                                                              \
+        _tree_->alloc->free(_tree_);                                                          \
+    }                                                                                         \
+                                                                                              \
+    /* Fails if low is greater than high or if the interval is already in */                  \
+    /* the tree */                                                                            \
+    bool PFX##_insert(struct SNAME *_tree_, K low, K high, V value)                           \
+    {                                                                                         \
+        if (_tree_->cmp(low, high) > 0)                                                       \
+            return false;                                                                     \
+                                                                                              \
+        struct SNAME##_node *scan = _tree_->root;                                             \
+        struct SNAME##_node *parent = NULL;                                                   \
+                                                                                              \
+        int c = 0;                                                                            \
+                                                                                              \
+        while (scan != NULL)                                                                  \
+        {                                                                                     \
+            parent = scan;                                                                    \
+            c = PFX##_impl_cmp(_tree_, scan->low, scan->high, low, high);                     \
+                                                                                              \
+            if (c > 0)                                                                        \
+                scan = scan->left;                                                            \
+            else if (c < 0)                                                                   \
+                scan = scan->right;                                                           \
+            else                                                                              \
+                return false;                                                                 \
+        }                                                                                     \
+                                                                                              \
+        struct SNAME##_node *node = _tree_->alloc->malloc(sizeof(struct SNAME##_node));       \
+                                                                                              \
+        if (CMC_UNLIKELY(!node))                                                              \
+            return false;                                                                     \
+                                                                                              \
+        node->low = low;                                                                      \
+        node->high = high;                                                                    \
+        node->value = value;                                                                  \
+        node->max = high;                                                                     \
+        node->height = 1;                                                                     \
+        node->right = NULL;                                                                   \
+        node->left = NULL;                                                                    \
+        node->parent = parent;                                                                \
+                                                                                              \
+        if (!parent)                                                                          \
+            _tree_->root = node;                                                              \
+        else                                                                                  \
+        {                                                                                     \
+            if (c > 0)                                                                        \
+                parent->left = node;                                                          \
+            else                                                                              \
+                parent->right = node;                                                         \
+                                                                                              \
+            PFX##_impl_rebalance(_tree_, parent);                                             \
+        }                                                                                     \
+                                                                                              \
+        _tree_->count++;                                                                      \
+                                                                                              \
+        return true;                                                                          \
+    }                                                                                         \
+                                                                                              \
+    bool PFX##_update(struct SNAME *_tree_, K low, K high, V new_value, V *old_value)         \
+    {                                                                                         \
+        struct SNAME##_node *node = PFX##_impl_get_node(_tree_, low, high);                   \
+                                                                                              \
+        if (!node)                                                                            \
+            return false;                                                                     \
+                                                                                              \
+        if (old_value)                                                                        \
+            *old_value = node->value;                                                         \
+                                                                                              \
+        node->value = new_value;                                                              \
+                                                                                              \
+        return true;                                                                          \
+    }                                                                                         \
+                                                                                              \
+    bool PFX##_remove(struct SNAME *_tree_, K low, K high, V *out_value)                      \
+    {                                                                                         \
+        struct SNAME##_node *node = PFX##_impl_get_node(_tree_, low, high);                   \
+                                                                                              \
+        if (!node)                                                                            \
+            return false;                                                                     \
+                                                                                              \
+        if (out_value)                                                                        \
+            *out_value = node->value;                                                         \
+                                                                                              \
+        struct SNAME##_node *temp = NULL, *unbalanced = NULL;                                 \
+                                                                                              \
+        bool is_root = node->parent == NULL;                                                  \
+                                                                                              \
+        if (node->left == NULL && node->right == NULL)                                        \
+        {                                                                                     \
+            if (is_root)                                                                      \
+                _tree_->root = NULL;                                                          \
+            else                                                                              \
+            {                                                                                 \
+                unbalanced = node->parent;                                                    \
+                                                                                              \
+                if (node->parent->right == node)                                              \
+                    node->parent->right = NULL;                                               \
+                else                                                                          \
+                    node->parent->left = NULL;                                                \
+            }                                                                                 \
+                                                                                              \
+            _tree_->alloc->free(node);                                                        \
+        }                                                                                     \
+        else if (node->left == NULL)                                                          \
+        {                                                                                     \
+            if (is_root)                                                                      \
+            {                                                                                 \
+                _tree_->root = node->right;                                                   \
+                _tree_->root->parent = NULL;                                                  \
+            }                                                                                 \
+            else                                                                              \
+            {                                                                                 \
+                unbalanced = node->parent;                                                    \
+                                                                                              \
+                node->right->parent = node->parent;                                           \
+                                                                                              \
+                if (node->parent->right == node)                                              \
+                    node->parent->right = node->right;                                        \
+                else                                                                          \
+                    node->parent->left = node->right;                                         \
+            }                                                                                 \
+                                                                                              \
+            _tree_->alloc->free(node);                                                        \
+        }                                                                                     \
+        else if (node->right == NULL)                                                         \
+        {                                                                                     \
+            if (is_root)                                                                      \
+            {                                                                                 \
+                _tree_->root = node->left;                                                    \
+                _tree_->root->parent = NULL;                                                  \
+            }                                                                                 \
+            else                                                                              \
+            {                                                                                 \
+                unbalanced = node->parent;                                                    \
+                                                                                              \
+                node->left->parent = node->parent;                                            \
+                                                                                              \
+                if (node->parent->right == node)                                              \
+                    node->parent->right = node->left;                                         \
+                else                                                                          \
+                    node->parent->left = node->left;                                          \
+            }                                                                                 \
+                                                                                              \
+            _tree_->alloc->free(node);                                                        \
+        }                                                                                     \
+        else                                                                                  \
+        {                                                                                     \
+            temp = node->right;                                                               \
+            while (temp->left != NULL)                                                        \
+                temp = temp->left;                                                            \
+                                                                                              \
+            K temp_low = temp->low;                                                           \
+            K temp_high = temp->high;                                                         \
+            V temp_val = temp->value;                                                         \
+                                                                                              \
+            unbalanced = temp->parent;                                                        \
+                                                                                              \
+            if (temp->right != NULL)                                                          \
+                temp->right->parent = temp->parent;                                           \
+                                                                                              \
+            if (temp->parent->right == temp)                                                  \
+                temp->parent->right = temp->right;                                            \
+            else                                                                              \
+                temp->parent->left = temp->right;                                             \
+                                                                                              \
+            _tree_->alloc->free(temp);                                                        \
+                                                                                              \
+            /* node is an ancestor of unbalanced so its max is fixed below */                 \
+            node->low = temp_low;                                                             \
+            node->high = temp_high;                                                           \
+            node->value = temp_val;                                                           \
+        }                                                                                     \
+                                                                                              \
+        if (unbalanced != NULL)                                                               \
+            PFX##_impl_rebalance(_tree_, unbalanced);                                         \
+                                                                                              \
+        _tree_->count--;                                                                      \
+                                                                                              \
+        return true;                                                                          \
+    }                                                                                         \
+                                                                                              \
+    V PFX##_get(struct SNAME *_tree_, K low, K high)                                          \
+    {                                                                                         \
+        struct SNAME##_node *node = PFX##_impl_get_node(_tree_, low, high);                   \
+                                                                                              \
+        if (!node)                                                                            \
+            return (V){ 0 };                                                                  \
+                                                                                              \
+        return node->value;                                                                   \
+    }                                                                                         \
+                                                                                              \
+    V *PFX##_get_ref(struct SNAME *_tree_, K low, K high)                                     \
+    {                                                                                         \
+        struct SNAME##_node *node = PFX##_impl_get_node(_tree_, low, high);                   \
+                                                                                              \
+        if (!node)                                                                            \
+            return NULL;                                                                      \
+                                                                                              \
+        return &(node->value);                                                                \
+    }                                                                                         \
+                                                                                              \
+    /* The least low endpoint and the greatest high endpoint of all */                        \
+    /* intervals */                                                                           \
+    bool PFX##_span(struct SNAME *_tree_, K *low, K *high)                                    \
+    {                                                                                         \
+        if (PFX##_empty(_tree_))                                                              \
+            return false;                                                                     \
+                                                                                              \
+        struct SNAME##_node *scan = _tree_->root;                                             \
+                                                                                              \
+        while (scan->left != NULL)                                                            \
+            scan = scan->left;                                                                \
+                                                                                              \
+        if (low)                                                                              \
+            *low = scan->low;                                                                 \
+        if (high)                                                                             \
+            *high = _tree_->root->max;                                                        \
+                                                                                              \
+        return true;                                                                          \
+    }                                                                                         \
+                                                                                              \
+    /* Stops at the first overlapping interval, taking log(n) */                              \
+    bool PFX##_overlaps_any(struct SNAME *_tree_, K low, K high)                              \
+    {                                                                                         \
+        struct SNAME##_node *scan = _tree_->root;                                             \
+                                                                                              \
+        while (scan != NULL)                                                                  \
+        {                                                                                     \
+            if (_tree_->cmp(scan->low, high) <= 0 && _tree_->cmp(low, scan->high) <= 0)       \
+                return true;                                                                  \
+                                                                                              \
+            /* If the left subtree ends before low, only the right one can */                 \
+            /* overlap. Otherwise, if nothing on the left overlaps, nothing */                \
+            /* on the right does either, as it starts even later */                           \
+            if (scan->left != NULL && _tree_->cmp(scan->left->max, low) >= 0)                 \
+                scan = scan->left;                                                            \
+            else                                                                              \
+                scan = scan->right;                                                           \
+        }                                                                                     \
+                                                                                              \
+        return false;                                                                         \
+    }                                                                                         \
+                                                                                              \
+    /* Writes up to size intervals that overlap [low, high] to result, in */                  \
+    /* ascending order, and returns how many overlap in total */                              \
+    size_t PFX##_overlaps(struct SNAME *_tree_, K low, K high,                                \
+                          struct SNAME##_interval *result, size_t size)                       \
+    {                                                                                         \
+        if (_tree_->cmp(low, high) > 0)                                                       \
+            return 0;                                                                         \
+                                                                                              \
+        return PFX##_impl_overlaps(_tree_, _tree_->root, low, high, result, size, 0);         \
+    }                                                                                         \
+                                                                                              \
+    /* Intervals that contain point */                                                        \
+    size_t PFX##_stab(struct SNAME *_tree_, K point, struct SNAME##_interval *result,         \
+                      size_t size)                                                            \
+    {                                                                                         \
+        return PFX##_impl_overlaps(_tree_, _tree_->root, point, point, result, size, 0);      \
+    }                                                                                         \
+                                                                                              \
+    bool PFX##_contains(struct SNAME *_tree_, K low, K high)                                  \
+    {                                                                                         \
+        return PFX##_impl_get_node(_tree_, low, high) != NULL;                                \
+    }                                                                                         \
+                                                                                              \
+    bool PFX##_empty(struct SNAME *_tree_)                                                    \
+    {                                                                                         \
+        return _tree_->count == 0;                                                            \
+    }                                                                                         \
+                                                                                              \
+    size_t PFX##_count(struct SNAME *_tree_)                                                  \
+    {                                                                                         \
+        return _tree_->count;                                                                 \
+    }                                                                                         \
+                                                                                              \
+    size_t PFX##_memory_usage(struct SNAME *_tree_)                                           \
+    {                                                                                         \
+        return sizeof(struct SNAME) + _tree_->count * sizeof(struct SNAME##_node);            \
+    }                                                                                         \
+                                                                                              \
+    struct cmc_string PFX##_to_string(struct SNAME *_tree_)                                   \
+    {                                                                                         \
+        struct cmc_string str;                                                                \
+        struct SNAME *t_ = _tree_;                                                            \
+        const char *name = #SNAME;                                                            \
+                                                                                              \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_intervaltree, name, t_, t_->root,      \
+                 t_->count, t_->cmp);                                                         \
+                                                                                              \
+        return str;                                                                           \
+    }                                                                                         \
+                                                                                              \
+    /* Intervals are ordered by their low endpoint and then by their high */                  \
+    /* endpoint */                                                                            \
+    static int PFX##_impl_cmp(struct SNAME *_tree_, K low1, K high1, K low2, K high2)         \
+    {                                                                                         \
+        int c = _tree_->cmp(low1, low2);                                                      \
+                                                                                              \
+        if (c != 0)                                                                           \
+            return c;                                                                         \
+                                                                                              \
+        return _tree_->cmp(high1, high2);                                                     \
+    }                                                                                         \
+                                                                                              \
+    static struct SNAME##_node *PFX##_impl_get_node(struct SNAME *_tree_, K low, K high)      \
+    {                                                                                         \
+        struct SNAME##_node *scan = _tree_->root;                                             \
+                                                                                              \
+        while (scan != NULL)                                                                  \
+        {                                                                                     \
+            int c = PFX##_impl_cmp(_tree_, scan->low, scan->high, low, high);                 \
+                                                                                              \
+            if (c > 0)                                                                        \
+                scan = scan->left;                                                            \
+            else if (c < 0)                                                                   \
+                scan = scan->right;                                                           \
+            else                                                                              \
+                return scan;                                                                  \
+        }                                                                                     \
+                                                                                              \
+        return NULL;                                                                          \
+    }                                                                                         \
+                                                                                              \
+    /* In order traversal that skips subtrees that end before low and stops */                \
+    /* at nodes that start after high. The recursion depth is the height of */                \
+    /* the tree */                                                                            \
+    static size_t PFX##_impl_overlaps(struct SNAME *_tree_, struct SNAME##_node *node, K low, \
+                                      K high, struct SNAME##_interval *result, size_t size,   \
+                                      size_t found)                                           \
+    {                                                                                         \
+        if (node == NULL || _tree_->cmp(node->max, low) < 0)                                  \
+            return found;                                                                     \
+                                                                                              \
+        found = PFX##_impl_overlaps(_tree_, node->left, low, high, result, size, found);      \
+                                                                                              \
+        if (_tree_->cmp(node->low, high) > 0)                                                 \
+            return found;                                                                     \
+                                                                                              \
+        if (_tree_->cmp(low, node->high) <= 0)                                                \
+        {                                                                                     \
+            if (found < size)                                                                 \
+            {                                                                                 \
+                result[found].low = node->low;                                                \
+                result[found].high = node->high;                                              \
+                result[found].value = node->value;                                            \
+            }                                                                                 \
+                                                                                              \
+            found++;                                                                          \
+        }                                                                                     \
+                                                                                              \
+        return PFX##_impl_overlaps(_tree_, node->right, low, high, result, size, found);      \
+    }                                                                                         \
+                                                                                              \
+    static unsigned char PFX##_impl_h(struct SNAME##_node *node)                              \
+    {                                                                                         \
+        if (node == NULL)                                                                     \
+            return 0;                                                                         \
+                                                                                              \
+        return node->height;                                                                  \
+    }                                                                                         \
+                                                                                              \
+    static unsigned char PFX##_impl_hupdate(struct SNAME##_node *node)                        \
+    {                                                                                         \
+        if (node == NULL)                                                                     \
+            return 0;                                                                         \
+                                                                                              \
+        unsigned char h_l = PFX##_impl_h(node->left);                                         \
+        unsigned char h_r = PFX##_impl_h(node->right);                                        \
+                                                                                              \
+        return 1 + (h_l > h_r ? h_l : h_r);                                                   \
+    }                                                                                         \
+                                                                                              \
+    /* Greatest high endpoint of a node and its children's subtrees */                        \
+    static K PFX##_impl_mupdate(struct SNAME *_tree_, struct SNAME##_node *node)              \
+    {                                                                                         \
+        K max = node->high;                                                                   \
+                                                                                              \
+        if (node->left != NULL && _tree_->cmp(node->left->max, max) > 0)                      \
+            max = node->left->max;                                                            \
+        if (node->right != NULL && _tree_->cmp(node->right->max, max) > 0)                    \
+            max = node->right->max;                                                           \
+                                                                                              \
+        return max;                                                                           \
+    }                                                                                         \
+                                                                                              \
+    static void PFX##_impl_rotate_right(struct SNAME *_tree_, struct SNAME##_node **Z)        \
+    {                                                                                         \
+        struct SNAME##_node *root = *Z;                                                       \
+        struct SNAME##_node *new_root = root->left;                                           \
+                                                                                              \
+        if (root->parent != NULL)                                                             \
+        {                                                                                     \
+            if (root->parent->left == root)                                                   \
+                root->parent->left = new_root;                                                \
+            else                                                                              \
+                root->parent->right = new_root;                                               \
+        }                                                                                     \
+                                                                                              \
+        new_root->parent = root->parent;                                                      \
+                                                                                              \
+        root->parent = new_root;                                                              \
+        root->left = new_root->right;                                                         \
+                                                                                              \
+        if (root->left)                                                                       \
+            root->left->parent = root;                                                        \
+                                                                                              \
+        new_root->right = root;                                                               \
+                                                                                              \
+        root->height = PFX##_impl_hupdate(root);                                              \
+        new_root->height = PFX##_impl_hupdate(new_root);                                      \
+        root->max = PFX##_impl_mupdate(_tree_, root);                                         \
+        new_root->max = PFX##_impl_mupdate(_tree_, new_root);                                 \
+                                                                                              \
+        *Z = new_root;                                                                        \
+    }                                                                                         \
+                                                                                              \
+    static void PFX##_impl_rotate_left(struct SNAME *_tree_, struct SNAME##_node **Z)         \
+    {                                                                                         \
+        struct SNAME##_node *root = *Z;                                                       \
+        struct SNAME##_node *new_root = root->right;                                          \
+                                                                                              \
+        if (root->parent != NULL)                                                             \
+        {                                                                                     \
+            if (root->parent->right == root)                                                  \
+                root->parent->right = new_root;                                               \
+            else                                                                              \
+                root->parent->left = new_root;                                                \
+        }                                                                                     \
+                                                                                              \
+        new_root->parent = root->parent;                                                      \
+                                                                                              \
+        root->parent = new_root;                                                              \
+        root->right = new_root->left;                                                         \
+                                                                                              \
+        if (root->right)                                                                      \
+            root->right->parent = root;                                                       \
+                                                                                              \
+        new_root->left = root;                                                                \
+                                                                                              \
+        root->height = PFX##_impl_hupdate(root);                                              \
+        new_root->height = PFX##_impl_hupdate(new_root);                                      \
+        root->max = PFX##_impl_mupdate(_tree_, root);                                         \
+        new_root->max = PFX##_impl_mupdate(_tree_, new_root);                                 \
+                                                                                              \
+        *Z = new_root;                                                                        \
+    }                                                                                         \
+                                                                                              \
+    /* Goes up to the root, since the max of every ancestor might change */                   \
+    static void PFX##_impl_rebalance(struct SNAME *_tree_, struct SNAME##_node *node)         \
+    {                                                                                         \
+        struct SNAME##_node *scan = node, *child = NULL;                                      \
+                                                                                              \
+        int balance;                                                                          \
+        bool is_root = false;                                                                 \
+                                                                                              \
+        while (scan != NULL)                                                                  \
+        {                                                                                     \
+            if (scan->parent == NULL)                                                         \
+                is_root = true;                                                               \
+                                                                                              \
+            scan->height = PFX##_impl_hupdate(scan);                                          \
+            scan->max = PFX##_impl_mupdate(_tree_, scan);                                     \
+            balance = PFX##_impl_h(scan->right) - PFX##_impl_h(scan->left);                   \
+                                                                                              \
+            if (balance >= 2)                                                                 \
+            {                                                                                 \
+                child = scan->right;                                                          \
+                                                                                              \
+                if (PFX##_impl_h(child->right) < PFX##_impl_h(child->left))                   \
+                    PFX##_impl_rotate_right(_tree_, &(scan->right));                          \
+                                                                                              \
+                PFX##_impl_rotate_left(_tree_, &scan);                                        \
+            }                                                                                 \
+            else if (balance <= -2)                                                           \
+            {                                                                                 \
+                child = scan->left;                                                           \
+                                                                                              \
+                if (PFX##_impl_h(child->left) < PFX##_impl_h(child->right))                   \
+                    PFX##_impl_rotate_left(_tree_, &(scan->left));                            \
+                                                                                              \
+                PFX##_impl_rotate_right(_tree_, &scan);                                       \
+            }                                                                                 \
+                                                                                              \
+            if (is_root)                                                                      \
+            {                                                                                 \
+                _tree_->root = scan;                                                          \
+                is_root = false;                                                              \
+            }                                                                                 \
+                                                                                              \
+            scan = scan->parent;                                                              \
+        }                                                                                     \
+    }
+
+#endif /* CMC_INTERVALTREE_H */
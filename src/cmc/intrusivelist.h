@@ -0,0 +1,542 @@
+/**
+ * intrusivelist.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * IntrusiveList
+ *
+ * An IntrusiveList is a doubly-linked list of objects that are allocated and
+ * owned elsewhere. Instead of nodes holding a copy of each element, the links
+ * are a member of the objects themselves, so inserting an object allocates
+ * nothing and an object can be removed from its list in O(1) given only a
+ * pointer to it. An object with more than one link can be in as many lists at
+ * once, one for each link.
+ *
+ * Implementation
+ *
+ * The links are a struct cmc_intrusive_link member of T, given to the
+ * generator as MEMBER, and the object is found back from its link with
+ * offsetof. The list keeps a sentinel link that the first and the last links
+ * point to, so no insertion or removal has to check for the ends of the list.
+ * An object that is not in a list has both of its link pointers NULL, which
+ * is also how a zeroed object starts.
+ *
+ * The list only keeps pointers to the objects, so they have to stay in place
+ * while they are linked and the list itself can't be moved either.
+ */
+
+#ifndef CMC_INTRUSIVELIST_H
+#define CMC_INTRUSIVELIST_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* Links of an object in an IntrusiveList, both NULL while it is in none */
+struct cmc_intrusive_link
+{
+    /* Link of the next object, or the sentinel of the list */
+    struct cmc_intrusive_link *next;
+
+    /* Link of the previous object, or the sentinel of the list */
+    struct cmc_intrusive_link *prev;
+};
+
+/* The object of type T whose MEMBER is link */
+#define CMC_INTRUSIVE_OBJECT(link, T, MEMBER) ((T *)((char *)(link) - offsetof(T, MEMBER)))
+
+/* to_string format */
+static const char *cmc_string_fmt_intrusivelist = "%s at %p { count:%" PRIuMAX ", front:%p, back:%p }";
+
+#define CMC_GENERATE_INTRUSIVE_LIST(PFX, SNAME, T, MEMBER)    \
+    CMC_GENERATE_INTRUSIVE_LIST_HEADER(PFX, SNAME, T, MEMBER) \
+    CMC_GENERATE_INTRUSIVE_LIST_SOURCE(PFX, SNAME, T, MEMBER)
+
+/* The link member is given as K and the type of the objects as V */
+#define CMC_WRAPGEN_INTRUSIVE_LIST_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_INTRUSIVE_LIST_HEADER(PFX, SNAME, V, K)
+
+#define CMC_WRAPGEN_INTRUSIVE_LIST_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_INTRUSIVE_LIST_SOURCE(PFX, SNAME, V, K)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_INTRUSIVE_LIST_HEADER(PFX, SNAME, T, MEMBER)               \
+    /* Intrusive List Structure */                                              \
+    struct SNAME                                                                \
+    {                                                                           \
+        /* Its next is the link of the first object and its prev the link of */ \
+        /* the last one. Both point to itself if the list is empty */           \
+        struct cmc_intrusive_link sentinel;                                     \
+                                                                                \
+        /* Current amount of objects in the list */                             \
+        size_t count;                                                           \
+                                                                                \
+        /* Custom allocation functions */                                       \
+        struct cmc_alloc_node *alloc;                                           \
+    };                                                                          \
+                                                                                \
+    /* Intrusive List Iterator */                                               \
+    struct SNAME##_iter                                                         \
+    {                                                                           \
+        /* Target Intrusive List */                                             \
+        struct SNAME *target;                                                   \
+                                                                                \
+        /* Link of the cursor's object */                                       \
+        struct cmc_intrusive_link *cursor;                                      \
+                                                                                \
+        /* Keeps track of relative index to the iteration of elements */        \
+        size_t index;                                                           \
+                                                                                \
+        /* If the iterator has reached the start of the iteration */            \
+        bool start;                                                             \
+                                                                                \
+        /* If the iterator has reached the end of the iteration */              \
+        bool end;                                                               \
+    };                                                                          \
+                                                                                \
+    /* Collection Functions */                                                  \
+    /* Collection Allocation and Deallocation */                                \
+    struct SNAME *PFX##_new(void);                                              \
+    struct SNAME *PFX##_new_custom(struct cmc_alloc_node *alloc);               \
+    void PFX##_init(struct SNAME *_list_);                                      \
+    void PFX##_clear(struct SNAME *_list_, void (*deallocator)(T *));           \
+    void PFX##_free(struct SNAME *_list_, void (*deallocator)(T *));            \
+    /* Collection Input and Output */                                           \
+    bool PFX##_push_front(struct SNAME *_list_, T *object);                     \
+    bool PFX##_push_back(struct SNAME *_list_, T *object);                      \
+    bool PFX##_insert_after(struct SNAME *_list_, T *position, T *object);      \
+    bool PFX##_insert_before(struct SNAME *_list_, T *position, T *object);     \
+    T *PFX##_pop_front(struct SNAME *_list_);                                   \
+    T *PFX##_pop_back(struct SNAME *_list_);                                    \
+    bool PFX##_remove(struct SNAME *_list_, T *object);                         \
+    /* Element Access */                                                        \
+    T *PFX##_front(struct SNAME *_list_);                                       \
+    T *PFX##_back(struct SNAME *_list_);                                        \
+    T *PFX##_next(struct SNAME *_list_, T *object);                             \
+    T *PFX##_prev(struct SNAME *_list_, T *object);                             \
+    /* Collection State */                                                      \
+    bool PFX##_linked(T *object);                                               \
+    CMC_PURE bool PFX##_empty(struct SNAME *_list_);                            \
+    CMC_PURE size_t PFX##_count(struct SNAME *_list_);                          \
+    size_t PFX##_memory_usage(struct SNAME *_list_);                            \
+    /* Collection Utility */                                                    \
+    struct cmc_string PFX##_to_string(struct SNAME *_list_);                    \
+    bool PFX##_to_string_full(struct SNAME *_list_,                             \
+                              struct cmc_string_builder *builder,               \
+                              const char *elem_fmt);                            \
+    bool PFX##_write(struct SNAME *_list_, FILE *file,                          \
+                     void (*fmt)(FILE *, T *));                                 \
+    bool PFX##_write_fd(struct SNAME *_list_, int fd,                           \
+                        void (*fmt)(struct cmc_dump *, T *));                   \
+                                                                                \
+    /* Iterator Functions */                                                    \
+    /* Iterator Initialization */                                               \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);      \
+    /* Iterator State */                                                        \
+    bool PFX##_iter_start(struct SNAME##_iter *iter);                           \
+    bool PFX##_iter_end(struct SNAME##_iter *iter);                             \
+    /* Iterator Movement */                                                     \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter);                        \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter);                          \
+    bool PFX##_iter_next(struct SNAME##_iter *iter);                            \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter);                            \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps);           \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps);            \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index);             \
+    /* Iterator Access */                                                       \
+    T *PFX##_iter_value(struct SNAME##_iter *iter);                             \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter);                         \
+                                                                                \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_INTRUSIVE_LIST_SOURCE(PFX, SNAME, T, MEMBER)                                  \
+    /* Implementation Detail Functions */                                                          \
+    static bool PFX##_impl_link(struct SNAME *_list_, struct cmc_intrusive_link *prev, T *object); \
+                                                                                                   \
+    struct SNAME *PFX##_new(void)                                                                  \
+    {                                                                                              \
+        return PFX##_new_custom(NULL);                                                             \
+    }                                                                                              \
+                                                                                                   \
+    struct SNAME *PFX##_new_custom(struct cmc_alloc_node *alloc)                                   \
+    {                                                                                              \
+        if (!alloc)                                                                                \
+            alloc = &cmc_alloc_node_default;                                                       \
+                                                                                                   \
+        struct SNAME *_list_ = alloc->malloc(sizeof(struct SNAME));                                \
+                                                                                                   \
+        if (CMC_UNLIKELY(!_list_))                                                                 \
+            return NULL;                                                                           \
+                                                                                                   \
+        _list_->alloc = alloc;                                                                     \
+                                                                                                   \
+        PFX##_init(_list_);                                                                        \
+                                                                                                   \
+        return _list_;                                                                             \
+    }                                                                                              \
+                                                                                                   \
+    /* Initializes a list that is not allocated by new, like one that is a */                      \
+    /* member of another struct */                                                                 \
+    void PFX##_init(struct SNAME *_list_)                                                          \
+    {                                                                                              \
+        _list_->sentinel.next = &(_list_->sentinel);                                               \
+        _list_->sentinel.prev = &(_list_->sentinel);                                               \
+        _list_->count = 0;                                                                         \
+    }                                                                                              \
+                                                                                                   \
+    /* Every object is unlinked before it is given to the deallocator */                           \
+    void PFX##_clear(struct SNAME *_list_, void (*deallocator)(T *))                               \
+    {                                                                                              \
+        struct cmc_intrusive_link *scan = _list_->sentinel.next;                                   \
+                                                                                                   \
+        while (scan != &(_list_->sentinel))                                                        \
+        {                                                                                          \
+            struct cmc_intrusive_link *next = scan->next;                                          \
+                                                                                                   \
+            scan->next = NULL;                                                                     \
+            scan->prev = NULL;                                                                     \
+                                                                                                   \
+            if (deallocator)                                                                       \
+                deallocator(CMC_INTRUSIVE_OBJECT(scan, T, MEMBER));                                \
+                                                                                                   \
+            scan = next;                                                                           \
+        }                                                                                          \
+                                                                                                   \
+        PFX##_init(_list_);                                                                        \
+    }                                                                                              \
+                                                                                                   \
+    void PFX##_free(struct SNAME *_list_, void (*deallocator)(T *))                                \
+    {                                                                                              \
+        PFX##_clear(_list_, deallocator);                                                          \
+                                                                                                   \
+        _list_->alloc->free(_list_);                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* The insertions fail if the object is already in a list through this link */                 \
+    bool PFX##_push_front(struct SNAME *_list_, T *object)                                         \
+    {                                                                                              \
+        return PFX##_impl_link(_list_, &(_list_->sentinel), object);                               \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_push_back(struct SNAME *_list_, T *object)                                          \
+    {                                                                                              \
+        return PFX##_impl_link(_list_, _list_->sentinel.prev, object);                             \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_insert_after(struct SNAME *_list_, T *position, T *object)                          \
+    {                                                                                              \
+        if (!PFX##_linked(position))                                                               \
+            return false;                                                                          \
+                                                                                                   \
+        return PFX##_impl_link(_list_, &(position->MEMBER), object);                               \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_insert_before(struct SNAME *_list_, T *position, T *object)                         \
+    {                                                                                              \
+        if (!PFX##_linked(position))                                                               \
+            return false;                                                                          \
+                                                                                                   \
+        return PFX##_impl_link(_list_, position->MEMBER.prev, object);                             \
+    }                                                                                              \
+                                                                                                   \
+    T *PFX##_pop_front(struct SNAME *_list_)                                                       \
+    {                                                                                              \
+        T *object = PFX##_front(_list_);                                                           \
+                                                                                                   \
+        if (object)                                                                                \
+            PFX##_remove(_list_, object);                                                          \
+                                                                                                   \
+        return object;                                                                             \
+    }                                                                                              \
+                                                                                                   \
+    T *PFX##_pop_back(struct SNAME *_list_)                                                        \
+    {                                                                                              \
+        T *object = PFX##_back(_list_);                                                            \
+                                                                                                   \
+        if (object)                                                                                \
+            PFX##_remove(_list_, object);                                                          \
+                                                                                                   \
+        return object;                                                                             \
+    }                                                                                              \
+                                                                                                   \
+    /* The object has to be in this list if it is linked */                                        \
+    bool PFX##_remove(struct SNAME *_list_, T *object)                                             \
+    {                                                                                              \
+        struct cmc_intrusive_link *link = &(object->MEMBER);                                       \
+                                                                                                   \
+        if (!link->next)                                                                           \
+            return false;                                                                          \
+                                                                                                   \
+        link->prev->next = link->next;                                                             \
+        link->next->prev = link->prev;                                                             \
+                                                                                                   \
+        link->next = NULL;                                                                         \
+        link->prev = NULL;                                                                         \
+                                                                                                   \
+        _list_->count--;                                                                           \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    T *PFX##_front(struct SNAME *_list_)                                                           \
+    {                                                                                              \
+        if (PFX##_empty(_list_))                                                                   \
+            return NULL;                                                                           \
+                                                                                                   \
+        return CMC_INTRUSIVE_OBJECT(_list_->sentinel.next, T, MEMBER);                             \
+    }                                                                                              \
+                                                                                                   \
+    T *PFX##_back(struct SNAME *_list_)                                                            \
+    {                                                                                              \
+        if (PFX##_empty(_list_))                                                                   \
+            return NULL;                                                                           \
+                                                                                                   \
+        return CMC_INTRUSIVE_OBJECT(_list_->sentinel.prev, T, MEMBER);                             \
+    }                                                                                              \
+                                                                                                   \
+    T *PFX##_next(struct SNAME *_list_, T *object)                                                 \
+    {                                                                                              \
+        struct cmc_intrusive_link *next = object->MEMBER.next;                                     \
+                                                                                                   \
+        if (!next || next == &(_list_->sentinel))                                                  \
+            return NULL;                                                                           \
+                                                                                                   \
+        return CMC_INTRUSIVE_OBJECT(next, T, MEMBER);                                              \
+    }                                                                                              \
+                                                                                                   \
+    T *PFX##_prev(struct SNAME *_list_, T *object)                                                 \
+    {                                                                                              \
+        struct cmc_intrusive_link *prev = object->MEMBER.prev;                                     \
+                                                                                                   \
+        if (!prev || prev == &(_list_->sentinel))                                                  \
+            return NULL;                                                                           \
+                                                                                                   \
+        return CMC_INTRUSIVE_OBJECT(prev, T, MEMBER);                                              \
+    }                                                                                              \
+                                                                                                   \
+    /* If the object is in a list through this link */                                             \
+    bool PFX##_linked(T *object)                                                                   \
+    {                                                                                              \
+        return object->MEMBER.next != NULL;                                                        \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_empty(struct SNAME *_list_)                                                         \
+    {                                                                                              \
+        return _list_->count == 0;                                                                 \
+    }                                                                                              \
+                                                                                                   \
+    size_t PFX##_count(struct SNAME *_list_)                                                       \
+    {                                                                                              \
+        return _list_->count;                                                                      \
+    }                                                                                              \
+                                                                                                   \
+    size_t PFX##_memory_usage(struct SNAME *_list_)                                                \
+    {                                                                                              \
+        /* The objects and their links belong to the caller */                                     \
+        return sizeof(struct SNAME);                                                               \
+    }                                                                                              \
+                                                                                                   \
+    struct cmc_string PFX##_to_string(struct SNAME *_list_)                                        \
+    {                                                                                              \
+        struct cmc_string str;                                                                     \
+        struct SNAME *l_ = _list_;                                                                 \
+        const char *name = #SNAME;                                                                 \
+                                                                                                   \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_intrusivelist, name, l_, l_->count,         \
+                 (void *)PFX##_front(l_), (void *)PFX##_back(l_));                                 \
+                                                                                                   \
+        return str;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE)                                 \
+                                                                                                   \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE, (T *))                                 \
+                                                                                                   \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                          \
+    {                                                                                              \
+        iter->target = target;                                                                     \
+        iter->cursor = target->sentinel.next;                                                      \
+        iter->index = 0;                                                                           \
+        iter->start = true;                                                                        \
+        iter->end = PFX##_empty(target);                                                           \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                               \
+    {                                                                                              \
+        return PFX##_empty(iter->target) || iter->start;                                           \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                                 \
+    {                                                                                              \
+        return PFX##_empty(iter->target) || iter->end;                                             \
+    }                                                                                              \
+                                                                                                   \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                            \
+    {                                                                                              \
+        if (!PFX##_empty(iter->target))                                                            \
+        {                                                                                          \
+            iter->cursor = iter->target->sentinel.next;                                            \
+            iter->index = 0;                                                                       \
+            iter->start = true;                                                                    \
+            iter->end = false;                                                                     \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                              \
+    {                                                                                              \
+        if (!PFX##_empty(iter->target))                                                            \
+        {                                                                                          \
+            iter->cursor = iter->target->sentinel.prev;                                            \
+            iter->index = iter->target->count - 1;                                                 \
+            iter->start = false;                                                                   \
+            iter->end = true;                                                                      \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                                \
+    {                                                                                              \
+        if (iter->end)                                                                             \
+            return false;                                                                          \
+                                                                                                   \
+        if (iter->cursor->next == &(iter->target->sentinel))                                       \
+        {                                                                                          \
+            iter->end = true;                                                                      \
+            return false;                                                                          \
+        }                                                                                          \
+                                                                                                   \
+        iter->start = false;                                                                       \
+                                                                                                   \
+        iter->cursor = iter->cursor->next;                                                         \
+        iter->index++;                                                                             \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                                \
+    {                                                                                              \
+        if (iter->start)                                                                           \
+            return false;                                                                          \
+                                                                                                   \
+        if (iter->cursor->prev == &(iter->target->sentinel))                                       \
+        {                                                                                          \
+            iter->start = true;                                                                    \
+            return false;                                                                          \
+        }                                                                                          \
+                                                                                                   \
+        iter->end = false;                                                                         \
+                                                                                                   \
+        iter->cursor = iter->cursor->prev;                                                         \
+        iter->index--;                                                                             \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Returns true only if the iterator moved */                                                  \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps)                               \
+    {                                                                                              \
+        if (iter->end)                                                                             \
+            return false;                                                                          \
+                                                                                                   \
+        if (iter->cursor->next == &(iter->target->sentinel))                                       \
+        {                                                                                          \
+            iter->end = true;                                                                      \
+            return false;                                                                          \
+        }                                                                                          \
+                                                                                                   \
+        if (steps == 0 || iter->index + steps >= PFX##_count(iter->target))                        \
+            return false;                                                                          \
+                                                                                                   \
+        iter->start = false;                                                                       \
+                                                                                                   \
+        iter->index += steps;                                                                      \
+                                                                                                   \
+        for (size_t i = 0; i < steps; i++)                                                         \
+            iter->cursor = iter->cursor->next;                                                     \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Returns true only if the iterator moved */                                                  \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps)                                \
+    {                                                                                              \
+        if (iter->start)                                                                           \
+            return false;                                                                          \
+                                                                                                   \
+        if (iter->cursor->prev == &(iter->target->sentinel))                                       \
+        {                                                                                          \
+            iter->start = true;                                                                    \
+            return false;                                                                          \
+        }                                                                                          \
+                                                                                                   \
+        if (steps == 0 || iter->index < steps)                                                     \
+            return false;                                                                          \
+                                                                                                   \
+        iter->end = false;                                                                         \
+                                                                                                   \
+        iter->index -= steps;                                                                      \
+                                                                                                   \
+        for (size_t i = 0; i < steps; i++)                                                         \
+            iter->cursor = iter->cursor->prev;                                                     \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Returns true only if the iterator was able to be positioned at the given */                 \
+    /* index */                                                                                    \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index)                                 \
+    {                                                                                              \
+        if (index >= PFX##_count(iter->target))                                                    \
+            return false;                                                                          \
+                                                                                                   \
+        if (iter->index > index)                                                                   \
+            return PFX##_iter_rewind(iter, iter->index - index);                                   \
+        else if (iter->index < index)                                                              \
+            return PFX##_iter_advance(iter, index - iter->index);                                  \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    T *PFX##_iter_value(struct SNAME##_iter *iter)                                                 \
+    {                                                                                              \
+        if (PFX##_empty(iter->target))                                                             \
+            return NULL;                                                                           \
+                                                                                                   \
+        return CMC_INTRUSIVE_OBJECT(iter->cursor, T, MEMBER);                                      \
+    }                                                                                              \
+                                                                                                   \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                             \
+    {                                                                                              \
+        return iter->index;                                                                        \
+    }                                                                                              \
+                                                                                                   \
+    /* Links the object right after prev */                                                        \
+    static bool PFX##_impl_link(struct SNAME *_list_, struct cmc_intrusive_link *prev, T *object)  \
+    {                                                                                              \
+        struct cmc_intrusive_link *link = &(object->MEMBER);                                       \
+                                                                                                   \
+        if (link->next)                                                                            \
+            return false;                                                                          \
+                                                                                                   \
+        link->prev = prev;                                                                         \
+        link->next = prev->next;                                                                   \
+                                                                                                   \
+        prev->next->prev = link;                                                                   \
+        prev->next = link;                                                                         \
+                                                                                                   \
+        _list_->count++;                                                                           \
+                                                                                                   \
+        return true;                                                                               \
+    }
+
+#endif /* CMC_INTRUSIVELIST_H */
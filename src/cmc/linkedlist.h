@@ -23,6 +23,10 @@
  * and removals at both ends in O(1) and in a given index in O(N). The list has
  * a head and tail pointer. The head points to the first element in the sequence
  * and tail points to the last.
+ *
+ * Nodes are allocated in chunks by a pool and removed nodes are reused by the
+ * next insertions. Each list has its own pool, whose chunks are freed at once
+ * by clear and free, unless it was created with a pool shared by other lists.
  */
 
 #ifndef CMC_LINKEDLIST_H
@@ -33,7 +37,17 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_serial.h"
 #include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* Maximum amount of nodes allocated at once. The first chunk of a pool has 4 */
+/* nodes and each one after it has twice as many as the one before */
+#ifndef CMC_LINKEDLIST_CHUNK_SIZE
+#define CMC_LINKEDLIST_CHUNK_SIZE 256
+#endif
 
 /* to_string format */
 static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", head:%p, tail:%p }";
@@ -51,6 +65,23 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
 /* HEADER ********************************************************************/
 #define CMC_GENERATE_LINKEDLIST_HEADER(PFX, SNAME, V)                                         \
                                                                                               \
+    /* Linked List Node Pool */                                                               \
+    struct SNAME##_pool                                                                       \
+    {                                                                                         \
+        /* Chunks that the nodes are allocated from, the newest one first */                  \
+        struct SNAME##_chunk *chunks;                                                         \
+                                                                                              \
+        /* Removed nodes that are reused before the newest chunk, linked by */                \
+        /* their next */                                                                      \
+        struct SNAME##_node *free_nodes;                                                      \
+                                                                                              \
+        /* Nodes of the newest chunk that were never used */                                  \
+        size_t chunk_left;                                                                    \
+                                                                                              \
+        /* Allocation functions of the chunks */                                              \
+        struct cmc_alloc_node *alloc;                                                         \
+    };                                                                                        \
+                                                                                              \
     /* Linked List Structure */                                                               \
     struct SNAME                                                                              \
     {                                                                                         \
@@ -68,6 +99,16 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
                                                                                               \
         /* Function that returns an iterator to the end of the list */                        \
         struct SNAME##_iter (*it_end)(struct SNAME *);                                        \
+                                                                                              \
+        /* Pool that the nodes are taken from, either local_pool or one */                    \
+        /* shared with other lists */                                                         \
+        struct SNAME##_pool *pool;                                                            \
+                                                                                              \
+        /* Pool used unless the list was created with another one */                          \
+        struct SNAME##_pool local_pool;                                                       \
+                                                                                              \
+        /* Custom allocation functions */                                                     \
+        struct cmc_alloc_node *alloc;                                                         \
     };                                                                                        \
                                                                                               \
     /* Doubly-linked list node */                                                             \
@@ -83,6 +124,19 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
         struct SNAME##_node *prev;                                                            \
     };                                                                                        \
                                                                                               \
+    /* Linked List Chunk of Nodes */                                                          \
+    struct SNAME##_chunk                                                                      \
+    {                                                                                         \
+        /* Chunk allocated before this one */                                                 \
+        struct SNAME##_chunk *next;                                                           \
+                                                                                              \
+        /* Amount of nodes in the chunk */                                                    \
+        size_t capacity;                                                                      \
+                                                                                              \
+        /* Nodes given in order from the last one to the first */                             \
+        struct SNAME##_node nodes[];                                                          \
+    };                                                                                        \
+                                                                                              \
     /* Linked List Iterator */                                                                \
     struct SNAME##_iter                                                                       \
     {                                                                                         \
@@ -105,8 +159,12 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
     /* Collection Functions */                                                                \
     /* Collection Allocation and Deallocation */                                              \
     struct SNAME *PFX##_new(void);                                                            \
+    struct SNAME *PFX##_new_custom(struct cmc_alloc_node *alloc);                             \
+    struct SNAME *PFX##_new_from(V *elements, size_t size);                                   \
+    struct SNAME *PFX##_new_pooled(struct SNAME##_pool *pool);                                \
     void PFX##_clear(struct SNAME *_list_, void (*deallocator)(V));                           \
     void PFX##_free(struct SNAME *_list_, void (*deallocator)(V));                            \
+    void PFX##_release(struct SNAME *_list_);                                                 \
     /* Collection Input and Output */                                                         \
     bool PFX##_push_front(struct SNAME *_list_, V element);                                   \
     bool PFX##_push_at(struct SNAME *_list_, V element, size_t index);                        \
@@ -114,6 +172,10 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
     bool PFX##_pop_front(struct SNAME *_list_);                                               \
     bool PFX##_pop_at(struct SNAME *_list_, size_t index);                                    \
     bool PFX##_pop_back(struct SNAME *_list_);                                                \
+    size_t PFX##_remove_if(struct SNAME *_list_, bool (*pred)(V), void (*deallocator)(V));    \
+    bool PFX##_splice(struct SNAME *_dst_, struct SNAME##_node *dst_node,                     \
+                      struct SNAME *_src_, struct SNAME##_node *first,                        \
+                      struct SNAME##_node *last);                                             \
     /* Element Access */                                                                      \
     V PFX##_front(struct SNAME *_list_);                                                      \
     V PFX##_get(struct SNAME *_list_, size_t index);                                          \
@@ -121,12 +183,28 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
     V PFX##_back(struct SNAME *_list_);                                                       \
     /* Collection State */                                                                    \
     bool PFX##_contains(struct SNAME *_list_, V element, int (*comparator)(V, V));            \
-    bool PFX##_empty(struct SNAME *_list_);                                                   \
-    size_t PFX##_count(struct SNAME *_list_);                                                 \
+    CMC_PURE bool PFX##_empty(struct SNAME *_list_);                                          \
+    CMC_PURE size_t PFX##_count(struct SNAME *_list_);                                        \
+    size_t PFX##_memory_usage(struct SNAME *_list_);                                          \
     /* Collection Utility */                                                                  \
+    void PFX##_sort(struct SNAME *_list_, int (*comparator)(V, V));                           \
     struct SNAME *PFX##_copy_of(struct SNAME *_list_, V (*copy_func)(V));                     \
+    size_t PFX##_to_array(struct SNAME *_list_, V *CMC_RESTRICT elements, size_t size);       \
     bool PFX##_equals(struct SNAME *_list1_, struct SNAME *_list2_, int (*comparator)(V, V)); \
     struct cmc_string PFX##_to_string(struct SNAME *_list_);                                  \
+    bool PFX##_to_string_full(struct SNAME *_list_, struct cmc_string_builder *builder,       \
+                              const char *elem_fmt);                                          \
+    bool PFX##_write(struct SNAME *_list_, FILE *file, void (*fmt)(FILE *, V));               \
+    bool PFX##_write_fd(struct SNAME *_list_, int fd, void (*fmt)(struct cmc_dump *, V));     \
+    /* Collection Serialization */                                                            \
+    bool PFX##_save(struct SNAME *_list_, FILE *file, bool (*writer)(V, FILE *));             \
+    struct SNAME *PFX##_restore(FILE *file, bool (*reader)(V *, FILE *));                     \
+                                                                                              \
+    /* Node Pool Functions */                                                                 \
+    /* Node Pool Allocation and Deallocation */                                               \
+    struct SNAME##_pool *PFX##_pool_new(void);                                                \
+    struct SNAME##_pool *PFX##_pool_new_custom(struct cmc_alloc_node *alloc);                 \
+    void PFX##_pool_free(struct SNAME##_pool *pool);                                          \
                                                                                               \
     /* Node Related Functions */                                                              \
     /* Node Allocation and Deallocation */                                                    \
@@ -175,17 +253,35 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
     /* Implementation Detail Functions */                                                    \
     static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_list_);                    \
     static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_list_);                      \
+    static struct SNAME##_node *PFX##_impl_new_node(struct SNAME *_list_, V element);        \
+    static void PFX##_impl_release_node(struct SNAME *_list_, struct SNAME##_node *node);    \
+    static void PFX##_impl_free_chunks(struct SNAME##_pool *pool);                           \
                                                                                              \
     struct SNAME *PFX##_new(void)                                                            \
     {                                                                                        \
-        struct SNAME *_list_ = malloc(sizeof(struct SNAME));                                 \
+        return PFX##_new_custom(NULL);                                                       \
+    }                                                                                        \
                                                                                              \
-        if (!_list_)                                                                         \
+    struct SNAME *PFX##_new_custom(struct cmc_alloc_node *alloc)                             \
+    {                                                                                        \
+        if (!alloc)                                                                          \
+            alloc = &cmc_alloc_node_default;                                                 \
+                                                                                             \
+        struct SNAME *_list_ = alloc->malloc(sizeof(struct SNAME));                          \
+                                                                                             \
+        if (CMC_UNLIKELY(!_list_))                                                           \
             return NULL;                                                                     \
                                                                                              \
+        _list_->alloc = alloc;                                                               \
+                                                                                             \
         _list_->count = 0;                                                                   \
         _list_->head = NULL;                                                                 \
         _list_->tail = NULL;                                                                 \
+        _list_->pool = &_list_->local_pool;                                                  \
+        _list_->local_pool.chunks = NULL;                                                    \
+        _list_->local_pool.free_nodes = NULL;                                                \
+        _list_->local_pool.chunk_left = 0;                                                   \
+        _list_->local_pool.alloc = alloc;                                                    \
                                                                                              \
         _list_->it_start = PFX##_impl_it_start;                                              \
         _list_->it_end = PFX##_impl_it_end;                                                  \
@@ -193,22 +289,69 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
         return _list_;                                                                       \
     }                                                                                        \
                                                                                              \
+    /* Creates a list with the size elements in order */                                     \
+    struct SNAME *PFX##_new_from(V *elements, size_t size)                                   \
+    {                                                                                        \
+        if (size == 0)                                                                       \
+            return NULL;                                                                     \
+                                                                                             \
+        struct SNAME *_list_ = PFX##_new();                                                  \
+                                                                                             \
+        if (CMC_UNLIKELY(!_list_))                                                           \
+            return NULL;                                                                     \
+                                                                                             \
+        for (size_t i = 0; i < size; i++)                                                    \
+        {                                                                                    \
+            if (!PFX##_push_back(_list_, elements[i]))                                       \
+            {                                                                                \
+                PFX##_free(_list_, NULL);                                                    \
+                return NULL;                                                                 \
+            }                                                                                \
+        }                                                                                    \
+                                                                                             \
+        return _list_;                                                                       \
+    }                                                                                        \
+                                                                                             \
+    /* The pool has to outlive the list and all of its nodes go back to it */                \
+    struct SNAME *PFX##_new_pooled(struct SNAME##_pool *pool)                                \
+    {                                                                                        \
+        struct SNAME *_list_ = PFX##_new_custom(pool->alloc);                                \
+                                                                                             \
+        if (CMC_UNLIKELY(!_list_))                                                           \
+            return NULL;                                                                     \
+                                                                                             \
+        _list_->pool = pool;                                                                 \
+                                                                                             \
+        return _list_;                                                                       \
+    }                                                                                        \
+                                                                                             \
     void PFX##_clear(struct SNAME *_list_, void (*deallocator)(V))                           \
     {                                                                                        \
-        struct SNAME##_node *scan = _list_->head;                                            \
+        bool shared = _list_->pool != &_list_->local_pool;                                   \
                                                                                              \
-        while (_list_->head != NULL)                                                         \
+        /* The nodes of the local pool are freed with its chunks, so the list */             \
+        /* is only walked if there is a deallocator or the pool is shared */                 \
+        struct SNAME##_node *scan = deallocator || shared ? _list_->head : NULL;             \
+                                                                                             \
+        while (scan != NULL)                                                                 \
         {                                                                                    \
-            _list_->head = _list_->head->next;                                               \
+            struct SNAME##_node *next = scan->next;                                          \
                                                                                              \
             if (deallocator)                                                                 \
-            {                                                                                \
                 deallocator(scan->data);                                                     \
-            }                                                                                \
                                                                                              \
-            free(scan);                                                                      \
+            if (shared)                                                                      \
+                PFX##_impl_release_node(_list_, scan);                                       \
+                                                                                             \
+            scan = next;                                                                     \
+        }                                                                                    \
+                                                                                             \
+        if (!shared)                                                                         \
+        {                                                                                    \
+            PFX##_impl_free_chunks(&_list_->local_pool);                                     \
                                                                                              \
-            scan = _list_->head;                                                             \
+            _list_->local_pool.free_nodes = NULL;                                            \
+            _list_->local_pool.chunk_left = 0;                                               \
         }                                                                                    \
                                                                                              \
         _list_->count = 0;                                                                   \
@@ -220,12 +363,19 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
     {                                                                                        \
         PFX##_clear(_list_, deallocator);                                                    \
                                                                                              \
-        free(_list_);                                                                        \
+        _list_->alloc->free(_list_);                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* Frees the struct of the collection without visiting its nodes, for an */              \
+    /* allocator that frees all of them at once like a cmc_arena */                          \
+    void PFX##_release(struct SNAME *_list_)                                                 \
+    {                                                                                        \
+        _list_->alloc->free(_list_);                                                         \
     }                                                                                        \
                                                                                              \
     bool PFX##_push_front(struct SNAME *_list_, V element)                                   \
     {                                                                                        \
-        struct SNAME##_node *_node_ = PFX##_new_node(element);                               \
+        struct SNAME##_node *_node_ = PFX##_impl_new_node(_list_, element);                  \
                                                                                              \
         if (!_node_)                                                                         \
             return false;                                                                    \
@@ -261,7 +411,7 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
             return PFX##_push_back(_list_, element);                                         \
         }                                                                                    \
                                                                                              \
-        struct SNAME##_node *_node_ = PFX##_new_node(element);                               \
+        struct SNAME##_node *_node_ = PFX##_impl_new_node(_list_, element);                  \
                                                                                              \
         if (!_node_)                                                                         \
             return false;                                                                    \
@@ -280,7 +430,7 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
                                                                                              \
     bool PFX##_push_back(struct SNAME *_list_, V element)                                    \
     {                                                                                        \
-        struct SNAME##_node *_node_ = PFX##_new_node(element);                               \
+        struct SNAME##_node *_node_ = PFX##_impl_new_node(_list_, element);                  \
                                                                                              \
         if (!_node_)                                                                         \
             return false;                                                                    \
@@ -310,7 +460,7 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
         struct SNAME##_node *_node_ = _list_->head;                                          \
         _list_->head = _list_->head->next;                                                   \
                                                                                              \
-        free(_node_);                                                                        \
+        PFX##_impl_release_node(_list_, _node_);                                             \
                                                                                              \
         if (_list_->head == NULL)                                                            \
             _list_->tail = NULL;                                                             \
@@ -347,7 +497,7 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
         _node_->next->prev = _node_->prev;                                                   \
         _node_->prev->next = _node_->next;                                                   \
                                                                                              \
-        free(_node_);                                                                        \
+        PFX##_impl_release_node(_list_, _node_);                                             \
                                                                                              \
         _list_->count--;                                                                     \
                                                                                              \
@@ -362,7 +512,7 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
         struct SNAME##_node *_node_ = _list_->tail;                                          \
         _list_->tail = _list_->tail->prev;                                                   \
                                                                                              \
-        free(_node_);                                                                        \
+        PFX##_impl_release_node(_list_, _node_);                                             \
                                                                                              \
         if (_list_->tail == NULL)                                                            \
             _list_->head = NULL;                                                             \
@@ -374,6 +524,137 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
         return true;                                                                         \
     }                                                                                        \
                                                                                              \
+    /* Unlinks and releases every node whose element pred is true for in a */                \
+    /* single pass. Returns how many were removed */                                         \
+    size_t PFX##_remove_if(struct SNAME *_list_, bool (*pred)(V), void (*deallocator)(V))    \
+    {                                                                                        \
+        size_t removed = 0;                                                                  \
+        struct SNAME##_node *scan = _list_->head;                                            \
+                                                                                             \
+        while (scan != NULL)                                                                 \
+        {                                                                                    \
+            struct SNAME##_node *next = scan->next;                                          \
+                                                                                             \
+            if (pred(scan->data))                                                            \
+            {                                                                                \
+                if (deallocator)                                                             \
+                    deallocator(scan->data);                                                 \
+                                                                                             \
+                PFX##_remove_current(_list_, scan);                                          \
+                removed++;                                                                   \
+            }                                                                                \
+                                                                                             \
+            scan = next;                                                                     \
+        }                                                                                    \
+                                                                                             \
+        return removed;                                                                      \
+    }                                                                                        \
+                                                                                             \
+    /* Moves the nodes from first to last, inclusive, out of src and into dst */             \
+    /* right before dst_node, or at the end of dst if it is NULL. Both lists */              \
+    /* can be the same as long as dst_node is not in the range. The nodes are */             \
+    /* relinked if the lists share their pool, otherwise their elements are */               \
+    /* moved to new nodes of dst. In both cases the range is walked once to */               \
+    /* count it. Returns false if last does not come after first */                          \
+    bool PFX##_splice(struct SNAME *_dst_, struct SNAME##_node *dst_node,                    \
+                      struct SNAME *_src_, struct SNAME##_node *first,                       \
+                      struct SNAME##_node *last)                                             \
+    {                                                                                        \
+        size_t count = 1;                                                                    \
+                                                                                             \
+        for (struct SNAME##_node *scan = first; scan != last; scan = scan->next)             \
+        {                                                                                    \
+            if (scan->next == NULL || scan == dst_node)                                      \
+                return false;                                                                \
+                                                                                             \
+            count++;                                                                         \
+        }                                                                                    \
+                                                                                             \
+        if (last == dst_node)                                                                \
+            return false;                                                                    \
+                                                                                             \
+        struct SNAME##_node *moved_first = first;                                            \
+        struct SNAME##_node *moved_last = last;                                              \
+                                                                                             \
+        if (_dst_->pool != _src_->pool)                                                      \
+        {                                                                                    \
+            moved_first = NULL;                                                              \
+            moved_last = NULL;                                                               \
+                                                                                             \
+            for (struct SNAME##_node *scan = first; scan != last->next; scan = scan->next)   \
+            {                                                                                \
+                struct SNAME##_node *_node_ = PFX##_impl_new_node(_dst_, scan->data);        \
+                                                                                             \
+                if (!_node_)                                                                 \
+                {                                                                            \
+                    while (moved_first)                                                      \
+                    {                                                                        \
+                        struct SNAME##_node *next = moved_first->next;                       \
+                                                                                             \
+                        PFX##_impl_release_node(_dst_, moved_first);                         \
+                                                                                             \
+                        moved_first = next;                                                  \
+                    }                                                                        \
+                                                                                             \
+                    return false;                                                            \
+                }                                                                            \
+                                                                                             \
+                if (moved_last)                                                              \
+                    moved_last->next = _node_;                                               \
+                else                                                                         \
+                    moved_first = _node_;                                                    \
+                                                                                             \
+                _node_->prev = moved_last;                                                   \
+                moved_last = _node_;                                                         \
+            }                                                                                \
+        }                                                                                    \
+                                                                                             \
+        if (first->prev)                                                                     \
+            first->prev->next = last->next;                                                  \
+        else                                                                                 \
+            _src_->head = last->next;                                                        \
+                                                                                             \
+        if (last->next)                                                                      \
+            last->next->prev = first->prev;                                                  \
+        else                                                                                 \
+            _src_->tail = first->prev;                                                       \
+                                                                                             \
+        _src_->count -= count;                                                               \
+                                                                                             \
+        if (moved_first != first)                                                            \
+        {                                                                                    \
+            struct SNAME##_node *scan = first;                                               \
+                                                                                             \
+            for (size_t i = 0; i < count; i++)                                               \
+            {                                                                                \
+                struct SNAME##_node *next = scan->next;                                      \
+                                                                                             \
+                PFX##_impl_release_node(_src_, scan);                                        \
+                                                                                             \
+                scan = next;                                                                 \
+            }                                                                                \
+        }                                                                                    \
+                                                                                             \
+        struct SNAME##_node *prev = dst_node ? dst_node->prev : _dst_->tail;                 \
+                                                                                             \
+        moved_first->prev = prev;                                                            \
+        moved_last->next = dst_node;                                                         \
+                                                                                             \
+        if (prev)                                                                            \
+            prev->next = moved_first;                                                        \
+        else                                                                                 \
+            _dst_->head = moved_first;                                                       \
+                                                                                             \
+        if (dst_node)                                                                        \
+            dst_node->prev = moved_last;                                                     \
+        else                                                                                 \
+            _dst_->tail = moved_last;                                                        \
+                                                                                             \
+        _dst_->count += count;                                                               \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
     V PFX##_front(struct SNAME *_list_)                                                      \
     {                                                                                        \
         if (PFX##_empty(_list_))                                                             \
@@ -444,11 +725,120 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
         return _list_->count;                                                                \
     }                                                                                        \
                                                                                              \
+    size_t PFX##_memory_usage(struct SNAME *_list_)                                          \
+    {                                                                                        \
+        size_t bytes = sizeof(struct SNAME);                                                 \
+                                                                                             \
+        /* A shared pool is not part of any list, so only the nodes in use count */          \
+        if (_list_->pool != &_list_->local_pool)                                             \
+            return bytes + sizeof(struct SNAME##_node) * _list_->count;                      \
+                                                                                             \
+        struct SNAME##_chunk *chunk = _list_->local_pool.chunks;                             \
+                                                                                             \
+        for (; chunk; chunk = chunk->next)                                                   \
+        {                                                                                    \
+            bytes += sizeof(struct SNAME##_chunk);                                           \
+            bytes += sizeof(struct SNAME##_node) * chunk->capacity;                          \
+        }                                                                                    \
+                                                                                             \
+        return bytes;                                                                        \
+    }                                                                                        \
+                                                                                             \
+    /* Stable bottom-up merge sort in O(n log n). Only the nodes are relinked */             \
+    /* and nothing is allocated */                                                           \
+    void PFX##_sort(struct SNAME *_list_, int (*comparator)(V, V))                           \
+    {                                                                                        \
+        struct SNAME##_node *head = _list_->head;                                            \
+                                                                                             \
+        if (_list_->count < 2)                                                               \
+            return;                                                                          \
+                                                                                             \
+        /* Runs of width nodes are merged in pairs by their next pointers */                 \
+        for (size_t width = 1;; width *= 2)                                                  \
+        {                                                                                    \
+            struct SNAME##_node *left = head;                                                \
+            struct SNAME##_node *tail = NULL;                                                \
+            size_t merges = 0;                                                               \
+                                                                                             \
+            head = NULL;                                                                     \
+                                                                                             \
+            while (left)                                                                     \
+            {                                                                                \
+                struct SNAME##_node *right = left;                                           \
+                size_t left_size = 0;                                                        \
+                size_t right_size = width;                                                   \
+                                                                                             \
+                merges++;                                                                    \
+                                                                                             \
+                while (left_size < width && right)                                           \
+                {                                                                            \
+                    left_size++;                                                             \
+                    right = right->next;                                                     \
+                }                                                                            \
+                                                                                             \
+                while (left_size > 0 || (right_size > 0 && right))                           \
+                {                                                                            \
+                    struct SNAME##_node *next;                                               \
+                                                                                             \
+                    /* Equal elements are taken from the left to keep it stable */           \
+                    bool take_left = left_size > 0;                                          \
+                                                                                             \
+                    if (take_left && right_size > 0 && right)                                \
+                        take_left = comparator(left->data, right->data) <= 0;                \
+                                                                                             \
+                    if (take_left)                                                           \
+                    {                                                                        \
+                        next = left;                                                         \
+                        left = left->next;                                                   \
+                        left_size--;                                                         \
+                    }                                                                        \
+                    else                                                                     \
+                    {                                                                        \
+                        next = right;                                                        \
+                        right = right->next;                                                 \
+                        right_size--;                                                        \
+                    }                                                                        \
+                                                                                             \
+                    if (tail)                                                                \
+                        tail->next = next;                                                   \
+                    else                                                                     \
+                        head = next;                                                         \
+                                                                                             \
+                    tail = next;                                                             \
+                }                                                                            \
+                                                                                             \
+                left = right;                                                                \
+            }                                                                                \
+                                                                                             \
+            tail->next = NULL;                                                               \
+                                                                                             \
+            if (merges <= 1)                                                                 \
+                break;                                                                       \
+        }                                                                                    \
+                                                                                             \
+        struct SNAME##_node *prev = NULL;                                                    \
+                                                                                             \
+        for (struct SNAME##_node *scan = head; scan != NULL; scan = scan->next)              \
+        {                                                                                    \
+            scan->prev = prev;                                                               \
+            prev = scan;                                                                     \
+        }                                                                                    \
+                                                                                             \
+        _list_->head = head;                                                                 \
+        _list_->tail = prev;                                                                 \
+    }                                                                                        \
+                                                                                             \
     struct SNAME *PFX##_copy_of(struct SNAME *_list_, V (*copy_func)(V))                     \
     {                                                                                        \
-        struct SNAME *result = PFX##_new();                                                  \
+        struct SNAME *result;                                                                \
+                                                                                             \
+        /* A copy of a list with a shared pool shares it too */                              \
+        if (_list_->pool != &_list_->local_pool)                                             \
+            result = PFX##_new_pooled(_list_->pool);                                         \
+        else                                                                                 \
+            result = PFX##_new_custom(_list_->alloc);                                        \
                                                                                              \
-        if (!result)                                                                         \
+        if (CMC_UNLIKELY(!result))                                                           \
             return NULL;                                                                     \
                                                                                              \
         struct SNAME##_node *scan = _list_->head;                                            \
@@ -460,9 +850,9 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
             struct SNAME##_node *new_node;                                                   \
                                                                                              \
             if (copy_func)                                                                   \
-                new_node = PFX##_new_node(copy_func(scan->data));                            \
+                new_node = PFX##_impl_new_node(result, copy_func(scan->data));               \
             else                                                                             \
-                new_node = PFX##_new_node(scan->data);                                       \
+                new_node = PFX##_impl_new_node(result, scan->data);                          \
                                                                                              \
             if (!result->head)                                                               \
             {                                                                                \
@@ -484,6 +874,18 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
         return result;                                                                       \
     }                                                                                        \
                                                                                              \
+    /* Copies up to size elements, from head to tail, to elements and */                     \
+    /* returns how many were copied */                                                       \
+    size_t PFX##_to_array(struct SNAME *_list_, V *CMC_RESTRICT elements, size_t size)       \
+    {                                                                                        \
+        size_t i = 0;                                                                        \
+                                                                                             \
+        for (struct SNAME##_node *node = _list_->head; node && i < size; node = node->next)  \
+            elements[i++] = node->data;                                                      \
+                                                                                             \
+        return i;                                                                            \
+    }                                                                                        \
+                                                                                             \
     bool PFX##_equals(struct SNAME *_list1_, struct SNAME *_list2_, int (*comparator)(V, V)) \
     {                                                                                        \
         if (PFX##_count(_list1_) != PFX##_count(_list2_))                                    \
@@ -516,6 +918,91 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
         return str;                                                                          \
     }                                                                                        \
                                                                                              \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE)                           \
+                                                                                             \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE, (V))                             \
+                                                                                             \
+    bool PFX##_save(struct SNAME *_list_, FILE *file, bool (*writer)(V, FILE *))             \
+    {                                                                                        \
+        uint32_t flags = writer ? 0 : CMC_SERIAL_RAW_VALUES;                                 \
+                                                                                             \
+        if (!cmc_serial_write_header(file, "linkedlist", flags, 0, sizeof(V), 0,             \
+                                     _list_->count, _list_->count, 0))                       \
+            return false;                                                                    \
+                                                                                             \
+        for (struct SNAME##_node *node = _list_->head; node; node = node->next)              \
+        {                                                                                    \
+            if (!CMC_SERIAL_WRITE(writer, node->data, file))                                 \
+                return false;                                                                \
+        }                                                                                    \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* The reader is only used if the list was saved with a writer */                        \
+    struct SNAME *PFX##_restore(FILE *file, bool (*reader)(V *, FILE *))                     \
+    {                                                                                        \
+        struct cmc_serial_header header;                                                     \
+                                                                                             \
+        if (!cmc_serial_read_header(file, "linkedlist", 0, sizeof(V), &header))              \
+            return NULL;                                                                     \
+                                                                                             \
+        struct SNAME *_list_ = PFX##_new();                                                  \
+                                                                                             \
+        if (CMC_UNLIKELY(!_list_))                                                           \
+            return NULL;                                                                     \
+                                                                                             \
+        bool raw = header.flags & CMC_SERIAL_RAW_VALUES;                                     \
+                                                                                             \
+        for (size_t i = 0; i < header.count; i++)                                            \
+        {                                                                                    \
+            V value;                                                                         \
+                                                                                             \
+            if (!CMC_SERIAL_READ(raw, reader, &value, file) ||                               \
+                !PFX##_push_back(_list_, value))                                             \
+            {                                                                                \
+                PFX##_free(_list_, NULL);                                                    \
+                return NULL;                                                                 \
+            }                                                                                \
+        }                                                                                    \
+                                                                                             \
+        return _list_;                                                                       \
+    }                                                                                        \
+                                                                                             \
+    struct SNAME##_pool *PFX##_pool_new(void)                                                \
+    {                                                                                        \
+        return PFX##_pool_new_custom(NULL);                                                  \
+    }                                                                                        \
+                                                                                             \
+    /* The pool and its chunks are allocated with alloc, which also */                       \
+    /* allocates every list created with it */                                               \
+    struct SNAME##_pool *PFX##_pool_new_custom(struct cmc_alloc_node *alloc)                 \
+    {                                                                                        \
+        if (!alloc)                                                                          \
+            alloc = &cmc_alloc_node_default;                                                 \
+                                                                                             \
+        struct SNAME##_pool *pool = alloc->malloc(sizeof(struct SNAME##_pool));              \
+                                                                                             \
+        if (CMC_UNLIKELY(!pool))                                                             \
+            return NULL;                                                                     \
+                                                                                             \
+        pool->chunks = NULL;                                                                 \
+        pool->free_nodes = NULL;                                                             \
+        pool->chunk_left = 0;                                                                \
+        pool->alloc = alloc;                                                                 \
+                                                                                             \
+        return pool;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* Every list created with the pool has to be freed before it */                         \
+    void PFX##_pool_free(struct SNAME##_pool *pool)                                          \
+    {                                                                                        \
+        PFX##_impl_free_chunks(pool);                                                        \
+                                                                                             \
+        pool->alloc->free(pool);                                                             \
+    }                                                                                        \
+                                                                                             \
+    /* Nodes that are not taken from a pool, they are never part of a list */                \
     struct SNAME##_node *PFX##_new_node(V element)                                           \
     {                                                                                        \
         struct SNAME##_node *_node_ = malloc(sizeof(struct SNAME##_node));                   \
@@ -577,7 +1064,7 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
                                                                                              \
     bool PFX##_insert_after(struct SNAME *_owner_, struct SNAME##_node *_node_, V element)   \
     {                                                                                        \
-        struct SNAME##_node *new_node = PFX##_new_node(element);                             \
+        struct SNAME##_node *new_node = PFX##_impl_new_node(_owner_, element);               \
                                                                                              \
         if (!new_node)                                                                       \
             return false;                                                                    \
@@ -599,7 +1086,7 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
                                                                                              \
     bool PFX##_insert_before(struct SNAME *_owner_, struct SNAME##_node *_node_, V element)  \
     {                                                                                        \
-        struct SNAME##_node *new_node = PFX##_new_node(element);                             \
+        struct SNAME##_node *new_node = PFX##_impl_new_node(_owner_, element);               \
                                                                                              \
         if (!new_node)                                                                       \
             return false;                                                                    \
@@ -634,7 +1121,7 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
         else                                                                                 \
             _owner_->tail = _node_;                                                          \
                                                                                              \
-        free(tmp);                                                                           \
+        PFX##_impl_release_node(_owner_, tmp);                                               \
                                                                                              \
         _owner_->count--;                                                                    \
                                                                                              \
@@ -653,7 +1140,7 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
         else                                                                                 \
             _owner_->tail = _node_->prev;                                                    \
                                                                                              \
-        free(_node_);                                                                        \
+        PFX##_impl_release_node(_owner_, _node_);                                            \
                                                                                              \
         _owner_->count--;                                                                    \
                                                                                              \
@@ -675,7 +1162,7 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
         else                                                                                 \
             _owner_->head = _node_;                                                          \
                                                                                              \
-        free(tmp);                                                                           \
+        PFX##_impl_release_node(_owner_, tmp);                                               \
                                                                                              \
         _owner_->count--;                                                                    \
                                                                                              \
@@ -694,9 +1181,9 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
                                                                                              \
     struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                \
     {                                                                                        \
-        struct SNAME##_iter *iter = malloc(sizeof(struct SNAME##_iter));                     \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));      \
                                                                                              \
-        if (!iter)                                                                           \
+        if (CMC_UNLIKELY(!iter))                                                             \
             return NULL;                                                                     \
                                                                                              \
         PFX##_iter_init(iter, target);                                                       \
@@ -706,7 +1193,7 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
                                                                                              \
     void PFX##_iter_free(struct SNAME##_iter *iter)                                          \
     {                                                                                        \
-        free(iter);                                                                          \
+        iter->target->alloc->free(iter);                                                     \
     }                                                                                        \
                                                                                              \
     void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                    \
@@ -879,6 +1366,69 @@ static const char *cmc_string_fmt_linkedlist = "%s at %p { count:%" PRIuMAX ", h
         return iter->cursor;                                                                 \
     }                                                                                        \
                                                                                              \
+    /* Takes a removed node if there is one, otherwise the next one of the */                \
+    /* newest chunk */                                                                       \
+    static struct SNAME##_node *PFX##_impl_new_node(struct SNAME *_list_, V element)         \
+    {                                                                                        \
+        struct SNAME##_pool *pool = _list_->pool;                                            \
+        struct SNAME##_node *node = pool->free_nodes;                                        \
+                                                                                             \
+        if (node)                                                                            \
+            pool->free_nodes = node->next;                                                   \
+        else                                                                                 \
+        {                                                                                    \
+            if (pool->chunk_left == 0)                                                       \
+            {                                                                                \
+                size_t capacity = pool->chunks ? pool->chunks->capacity * 2 : 4;             \
+                                                                                             \
+                if (capacity > CMC_LINKEDLIST_CHUNK_SIZE)                                    \
+                    capacity = CMC_LINKEDLIST_CHUNK_SIZE;                                    \
+                                                                                             \
+                size_t bytes = sizeof(struct SNAME##_node) * capacity;                       \
+                                                                                             \
+                struct SNAME##_chunk *chunk =                                                \
+                    pool->alloc->malloc(sizeof(struct SNAME##_chunk) + bytes);               \
+                                                                                             \
+                if (!chunk)                                                                  \
+                    return NULL;                                                             \
+                                                                                             \
+                chunk->next = pool->chunks;                                                  \
+                chunk->capacity = capacity;                                                  \
+                                                                                             \
+                pool->chunks = chunk;                                                        \
+                pool->chunk_left = capacity;                                                 \
+            }                                                                                \
+                                                                                             \
+            node = &(pool->chunks->nodes[--pool->chunk_left]);                               \
+        }                                                                                    \
+                                                                                             \
+        node->data = element;                                                                \
+        node->next = NULL;                                                                   \
+        node->prev = NULL;                                                                   \
+                                                                                             \
+        return node;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* The node is kept for the next insertion instead of being freed */                     \
+    static void PFX##_impl_release_node(struct SNAME *_list_, struct SNAME##_node *node)     \
+    {                                                                                        \
+        node->next = _list_->pool->free_nodes;                                               \
+                                                                                             \
+        _list_->pool->free_nodes = node;                                                     \
+    }                                                                                        \
+                                                                                             \
+    static void PFX##_impl_free_chunks(struct SNAME##_pool *pool)                            \
+    {                                                                                        \
+        while (pool->chunks)                                                                 \
+        {                                                                                    \
+            struct SNAME##_chunk *chunk = pool->chunks;                                      \
+                                                                                             \
+            pool->chunks = chunk->next;                                                      \
+                                                                                             \
+            pool->alloc->free(chunk);                                                        \
+        }                                                                                    \
+    }                                                                                        \
+                                                                                             \
     static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_list_)                     \
     {                                                                                        \
         struct SNAME##_iter iter;                                                            \
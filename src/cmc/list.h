@@ -38,6 +38,18 @@
  * forwards. Any modifications to the target list during iteration is considered
  * undefined behavior. Its sole purpose is to facilitate navigation through a
  * list.
+ *
+ * A list can be set to copy on write. Then copy_of without a copy function
+ * takes constant time and shares the buffer with the copy, counting its
+ * references, and the first modification of either list copies the buffer.
+ * Lists that are copied often and rarely modified, like configurations
+ * handed to each request, only copy what is actually modified. Pointers
+ * given by get_ref and iter_rvalue also copy a shared buffer first.
+ *
+ * A view is a range of the buffer given by a pointer and a count. Taking one
+ * does not allocate or copy anything, and the view functions only read from
+ * it, so a range can be handed to a worker instead of a sublist. A view is
+ * valid until the list is modified or freed.
  */
 
 #ifndef CMC_LIST_H
@@ -48,11 +60,26 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_cow.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_growth.h"
+#include "../utl/cmc_parallel.h"
+#include "../utl/cmc_scan.h"
+#include "../utl/cmc_serial.h"
+#include "../utl/cmc_sort.h"
 #include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
 
 /* to_string format */
 static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX " }";
 
+/* A removal shrinks a collection once less than this fraction of what it */
+/* can hold without growing is in use. Define it as 0 to never shrink */
+#ifndef CMC_SHRINK_LOW_WATER
+#define CMC_SHRINK_LOW_WATER 0.25
+#endif
+
 #define CMC_GENERATE_LIST(PFX, SNAME, V)    \
     CMC_GENERATE_LIST_HEADER(PFX, SNAME, V) \
     CMC_GENERATE_LIST_SOURCE(PFX, SNAME, V)
@@ -63,6 +90,29 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
 #define CMC_WRAPGEN_LIST_SOURCE(PFX, SNAME, K, V) \
     CMC_GENERATE_LIST_SOURCE(PFX, SNAME, V)
 
+/* Same as CMC_GENERATE_LIST but indexof and contains compare the bytes of */
+/* the elements with the vector search of cmc_scan.h, for types like */
+/* integers and pointers. The comparator is ignored and may be NULL */
+#define CMC_GENERATE_LIST_BITWISE(PFX, SNAME, V) \
+    CMC_GENERATE_LIST_HEADER(PFX, SNAME, V)      \
+    CMC_GENERATE_LIST_BITWISE_SOURCE(PFX, SNAME, V)
+
+/* Same as CMC_GENERATE_LIST but V is plain data that owns nothing, so */
+/* removals and clear leave the slots they free as they are instead of */
+/* overwriting them with zeros */
+#define CMC_GENERATE_LIST_TRIVIAL(PFX, SNAME, V) \
+    CMC_GENERATE_LIST_HEADER(PFX, SNAME, V)      \
+    CMC_GENERATE_LIST_TRIVIAL_SOURCE(PFX, SNAME, V)
+
+#define CMC_GENERATE_LIST_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_LIST_SOURCE(PFX, SNAME, V, false, false)
+
+#define CMC_GENERATE_LIST_BITWISE_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_LIST_SOURCE(PFX, SNAME, V, true, false)
+
+#define CMC_GENERATE_LIST_TRIVIAL_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_LIST_SOURCE(PFX, SNAME, V, false, true)
+
 /* HEADER ********************************************************************/
 #define CMC_GENERATE_LIST_HEADER(PFX, SNAME, V)                                               \
                                                                                               \
@@ -83,6 +133,16 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
                                                                                               \
         /* Function that returns an iterator to the end of the list */                        \
         struct SNAME##_iter (*it_end)(struct SNAME *);                                        \
+                                                                                              \
+        /* Reference count of a buffer shared with copies, NULL while only */                 \
+        /* this list uses it */                                                               \
+        struct cmc_cow *cow;                                                                  \
+                                                                                              \
+        /* If copy_of shares the buffer instead of copying it */                              \
+        bool copy_on_write;                                                                   \
+                                                                                              \
+        /* Custom allocation functions */                                                     \
+        struct cmc_alloc_node *alloc;                                                         \
     };                                                                                        \
                                                                                               \
     /* List Iterator */                                                                       \
@@ -101,9 +161,57 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
         bool end;                                                                             \
     };                                                                                        \
                                                                                               \
+    /* Read only range of the elements of a list */                                           \
+    struct SNAME##_view                                                                       \
+    {                                                                                         \
+        /* First element of the range */                                                      \
+        V *data;                                                                              \
+                                                                                              \
+        /* Amount of elements in the range */                                                 \
+        size_t count;                                                                         \
+    };                                                                                        \
+                                                                                              \
+    /* View Iterator */                                                                       \
+    struct SNAME##_view_iter                                                                  \
+    {                                                                                         \
+        /* Target view */                                                                     \
+        struct SNAME##_view view;                                                             \
+                                                                                              \
+        /* Cursor's position (index) */                                                       \
+        size_t cursor;                                                                        \
+                                                                                              \
+        /* If the iterator has reached the start of the iteration */                          \
+        bool start;                                                                           \
+                                                                                              \
+        /* If the iterator has reached the end of the iteration */                            \
+        bool end;                                                                             \
+    };                                                                                        \
+                                                                                              \
+    /* State of a list being streamed by serialize */                                         \
+    struct SNAME##_serializer                                                                 \
+    {                                                                                         \
+        struct cmc_serial_writer writer;                                                      \
+                                                                                              \
+        /* List being serialized, which must not change meanwhile */                          \
+        struct SNAME *target;                                                                 \
+                                                                                              \
+        /* Next element to be written */                                                      \
+        size_t index;                                                                         \
+    };                                                                                        \
+                                                                                              \
+    /* State of a list being received by deserialize */                                       \
+    struct SNAME##_deserializer                                                               \
+    {                                                                                         \
+        struct cmc_serial_reader reader;                                                      \
+                                                                                              \
+        /* NULL until the header arrives */                                                   \
+        struct SNAME *result;                                                                 \
+    };                                                                                        \
+                                                                                              \
     /* Collection Functions */                                                                \
     /* Collection Allocation and Deallocation */                                              \
     struct SNAME *PFX##_new(size_t capacity);                                                 \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc);            \
     struct SNAME *PFX##_new_from(V *elements, size_t size);                                   \
     void PFX##_clear(struct SNAME *_list_, void (*deallocator)(V));                           \
     void PFX##_free(struct SNAME *_list_, void (*deallocator)(V));                            \
@@ -114,6 +222,7 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
     bool PFX##_pop_front(struct SNAME *_list_);                                               \
     bool PFX##_pop_at(struct SNAME *_list_, size_t index);                                    \
     bool PFX##_pop_back(struct SNAME *_list_);                                                \
+    size_t PFX##_remove_if(struct SNAME *_list_, bool (*pred)(V), void (*deallocator)(V));    \
     /* Collection Sequence Input and Output */                                                \
     bool PFX##_seq_push_front(struct SNAME *_list_, V *elements, size_t size);                \
     bool PFX##_seq_push_at(struct SNAME *_list_, V *elements, size_t size, size_t index);     \
@@ -129,16 +238,45 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
                          bool from_start);                                                    \
     /* Collection State */                                                                    \
     bool PFX##_contains(struct SNAME *_list_, V element, int (*comparator)(V, V));            \
-    bool PFX##_empty(struct SNAME *_list_);                                                   \
+    CMC_PURE bool PFX##_empty(struct SNAME *_list_);                                          \
     bool PFX##_full(struct SNAME *_list_);                                                    \
-    size_t PFX##_count(struct SNAME *_list_);                                                 \
+    CMC_PURE size_t PFX##_count(struct SNAME *_list_);                                        \
+    size_t PFX##_memory_usage(struct SNAME *_list_);                                          \
     bool PFX##_fits(struct SNAME *_list_, size_t size);                                       \
     size_t PFX##_capacity(struct SNAME *_list_);                                              \
+    bool PFX##_shared(struct SNAME *_list_);                                                  \
+    bool PFX##_unshare(struct SNAME *_list_);                                                 \
+    void PFX##_set_copy_on_write(struct SNAME *_list_, bool enabled);                         \
     /* Collection Utility */                                                                  \
     bool PFX##_resize(struct SNAME *_list_, size_t capacity);                                 \
+    bool PFX##_shrink_to_fit(struct SNAME *_list_);                                           \
+    bool PFX##_reserve(struct SNAME *_list_, size_t capacity);                                \
+    void PFX##_sort(struct SNAME *_list_, int (*comparator)(V, V));                           \
+    void PFX##_sort_parallel(struct SNAME *_list_, int (*comparator)(V, V), size_t threads);  \
+    size_t PFX##_parallel_slots(struct SNAME *_list_);                                        \
+    V PFX##_parallel_reduce(struct SNAME *_list_, V initial, V (*reduce)(V, V),               \
+                            V (*combine)(V, V), size_t threads);                              \
     struct SNAME *PFX##_copy_of(struct SNAME *_list_, V (*copy_func)(V));                     \
+    size_t PFX##_to_array(struct SNAME *_list_, V *CMC_RESTRICT elements, size_t size);       \
     bool PFX##_equals(struct SNAME *_list1_, struct SNAME *_list2_, int (*comparator)(V, V)); \
     struct cmc_string PFX##_to_string(struct SNAME *_list_);                                  \
+    bool PFX##_to_string_full(struct SNAME *_list_, struct cmc_string_builder *builder,       \
+                              const char *elem_fmt);                                          \
+    bool PFX##_write(struct SNAME *_list_, FILE *file, void (*fmt)(FILE *, V));               \
+    bool PFX##_write_fd(struct SNAME *_list_, int fd, void (*fmt)(struct cmc_dump *, V));     \
+    /* Collection Serialization */                                                            \
+    bool PFX##_save(struct SNAME *_list_, FILE *file, bool (*writer)(V, FILE *));             \
+    struct SNAME *PFX##_restore(FILE *file, bool (*reader)(V *, FILE *));                     \
+    bool PFX##_serialize_begin(struct SNAME##_serializer *serializer, struct SNAME *_list_,   \
+                               size_t block_size, bool checksum);                             \
+    size_t PFX##_serialize_next(struct SNAME##_serializer *serializer, void *buffer,          \
+                                size_t size);                                                 \
+    void PFX##_serialize_end(struct SNAME##_serializer *serializer);                          \
+    bool PFX##_deserialize_begin(struct SNAME##_deserializer *deserializer,                   \
+                                 size_t block_size);                                          \
+    bool PFX##_deserialize_next(struct SNAME##_deserializer *deserializer,                    \
+                                const void *buffer, size_t size);                             \
+    struct SNAME *PFX##_deserialize_end(struct SNAME##_deserializer *deserializer);           \
                                                                                               \
     /* Iterator Functions */                                                                  \
     /* Iterator Allocation and Deallocation */                                                \
@@ -157,38 +295,75 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
     bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps);                         \
     bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps);                          \
     bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index);                           \
+    bool PFX##_parallel_iter(struct SNAME##_iter *iter, struct SNAME *target, size_t slot);   \
     /* Iterator Access */                                                                     \
     V PFX##_iter_value(struct SNAME##_iter *iter);                                            \
     V *PFX##_iter_rvalue(struct SNAME##_iter *iter);                                          \
     size_t PFX##_iter_index(struct SNAME##_iter *iter);                                       \
                                                                                               \
+    /* View Functions */                                                                      \
+    struct SNAME##_view PFX##_view(struct SNAME *_list_, size_t from, size_t to);             \
+    struct SNAME##_view PFX##_view_slice(struct SNAME##_view view, size_t from, size_t to);   \
+    V PFX##_view_get(struct SNAME##_view view, size_t index);                                 \
+    size_t PFX##_view_indexof(struct SNAME##_view view, V element, int (*comparator)(V, V),   \
+                              bool from_start);                                               \
+    bool PFX##_view_contains(struct SNAME##_view view, V element, int (*comparator)(V, V));   \
+    void PFX##_view_iter_init(struct SNAME##_view_iter *iter, struct SNAME##_view view);      \
+    bool PFX##_view_iter_start(struct SNAME##_view_iter *iter);                               \
+    bool PFX##_view_iter_end(struct SNAME##_view_iter *iter);                                 \
+    bool PFX##_view_iter_next(struct SNAME##_view_iter *iter);                                \
+    bool PFX##_view_iter_prev(struct SNAME##_view_iter *iter);                                \
+    V PFX##_view_iter_value(struct SNAME##_view_iter *iter);                                  \
+    size_t PFX##_view_iter_index(struct SNAME##_view_iter *iter);                             \
+                                                                                              \
 /* SOURCE ********************************************************************/
-#define CMC_GENERATE_LIST_SOURCE(PFX, SNAME, V)                                              \
+#define CMC_IMPL_LIST_SOURCE(PFX, SNAME, V, BITWISE, TRIVIAL)                                \
                                                                                              \
     /* Implementation Detail Functions */                                                    \
+    static void PFX##_impl_low_water(struct SNAME *_list_);                                  \
+    static bool PFX##_impl_grow(struct SNAME *_list_, size_t required);                      \
+    static bool PFX##_impl_unshare(struct SNAME *_list_);                                    \
     static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_list_);                    \
     static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_list_);                      \
                                                                                              \
+    CMC_GENERATE_SORT(PFX##_impl_sort, V, int (*comparator)(V, V), comparator, comparator)   \
+    CMC_GENERATE_PARALLEL_SORT(PFX##_impl_parallel_sort, PFX##_impl_sort, V,                 \
+                               int (*comparator)(V, V), comparator, comparator)              \
+    CMC_GENERATE_PARALLEL_REDUCE(PFX##_impl_parallel_reduce, SNAME, V, (V, V),               \
+                                 CMC_IMPL_PARALLEL_ANY, CMC_IMPL_PARALLEL_ELEMENT)           \
+                                                                                             \
     struct SNAME *PFX##_new(size_t capacity)                                                 \
     {                                                                                        \
+        return PFX##_new_custom(capacity, NULL);                                             \
+    }                                                                                        \
+                                                                                             \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc)            \
+    {                                                                                        \
+        if (!alloc)                                                                          \
+            alloc = &cmc_alloc_node_default;                                                 \
+                                                                                             \
         if (capacity < 1)                                                                    \
             return NULL;                                                                     \
                                                                                              \
-        struct SNAME *_list_ = malloc(sizeof(struct SNAME));                                 \
+        struct SNAME *_list_ = alloc->malloc(sizeof(struct SNAME));                          \
                                                                                              \
-        if (!_list_)                                                                         \
+        if (CMC_UNLIKELY(!_list_))                                                           \
             return NULL;                                                                     \
                                                                                              \
-        _list_->buffer = calloc(capacity, sizeof(V));                                        \
+        _list_->alloc = alloc;                                                               \
+                                                                                             \
+        _list_->buffer = alloc->calloc(capacity, sizeof(V));                                 \
                                                                                              \
-        if (!_list_->buffer)                                                                 \
+        if (CMC_UNLIKELY(!_list_->buffer))                                                   \
         {                                                                                    \
-            free(_list_);                                                                    \
+            alloc->free(_list_);                                                             \
             return NULL;                                                                     \
         }                                                                                    \
                                                                                              \
         _list_->capacity = capacity;                                                         \
         _list_->count = 0;                                                                   \
+        _list_->cow = NULL;                                                                  \
+        _list_->copy_on_write = false;                                                       \
                                                                                              \
         _list_->it_start = PFX##_impl_it_start;                                              \
         _list_->it_end = PFX##_impl_it_end;                                                  \
@@ -203,7 +378,7 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
                                                                                              \
         struct SNAME *_list_ = PFX##_new(size + size / 2);                                   \
                                                                                              \
-        if (!_list_)                                                                         \
+        if (CMC_UNLIKELY(!_list_))                                                           \
             return NULL;                                                                     \
                                                                                              \
         memcpy(_list_->buffer, elements, size * sizeof(V));                                  \
@@ -213,36 +388,72 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
         return _list_;                                                                       \
     }                                                                                        \
                                                                                              \
+    /* A list sharing its buffer only drops it. The elements are given to */                 \
+    /* the deallocator by the last list that uses them */                                    \
     void PFX##_clear(struct SNAME *_list_, void (*deallocator)(V))                           \
     {                                                                                        \
+        if (!cmc_cow_alone(_list_->cow))                                                     \
+        {                                                                                    \
+            V *buffer = _list_->alloc->calloc(_list_->capacity, sizeof(V));                  \
+                                                                                             \
+            /* Keeps sharing the buffer as an empty view until it can copy */                \
+            if (CMC_UNLIKELY(!buffer))                                                       \
+            {                                                                                \
+                _list_->count = 0;                                                           \
+                return;                                                                      \
+            }                                                                                \
+                                                                                             \
+            if (!cmc_cow_release(_list_->cow, _list_->alloc))                                \
+            {                                                                                \
+                _list_->buffer = buffer;                                                     \
+                _list_->cow = NULL;                                                          \
+                _list_->count = 0;                                                           \
+                return;                                                                      \
+            }                                                                                \
+                                                                                             \
+            /* The other lists dropped the buffer meanwhile */                               \
+            _list_->alloc->free(buffer);                                                     \
+            _list_->cow = NULL;                                                              \
+        }                                                                                    \
+                                                                                             \
+        PFX##_impl_unshare(_list_);                                                          \
+                                                                                             \
         if (deallocator)                                                                     \
         {                                                                                    \
             for (size_t i = 0; i < _list_->count; i++)                                       \
                 deallocator(_list_->buffer[i]);                                              \
         }                                                                                    \
                                                                                              \
-        memset(_list_->buffer, 0, sizeof(V) * _list_->capacity);                             \
+        if (!TRIVIAL)                                                                        \
+            memset(_list_->buffer, 0, sizeof(V) * _list_->capacity);                         \
                                                                                              \
         _list_->count = 0;                                                                   \
     }                                                                                        \
                                                                                              \
     void PFX##_free(struct SNAME *_list_, void (*deallocator)(V))                            \
     {                                                                                        \
-        if (deallocator)                                                                     \
+        if (cmc_cow_release(_list_->cow, _list_->alloc))                                     \
         {                                                                                    \
-            for (size_t i = 0; i < _list_->count; i++)                                       \
-                deallocator(_list_->buffer[i]);                                              \
+            if (deallocator)                                                                 \
+            {                                                                                \
+                for (size_t i = 0; i < _list_->count; i++)                                   \
+                    deallocator(_list_->buffer[i]);                                          \
+            }                                                                                \
+                                                                                             \
+            _list_->alloc->free(_list_->buffer);                                             \
         }                                                                                    \
                                                                                              \
-        free(_list_->buffer);                                                                \
-        free(_list_);                                                                        \
+        _list_->alloc->free(_list_);                                                         \
     }                                                                                        \
                                                                                              \
     bool PFX##_push_front(struct SNAME *_list_, V element)                                   \
     {                                                                                        \
+        if (!PFX##_impl_unshare(_list_))                                                     \
+            return false;                                                                    \
+                                                                                             \
         if (PFX##_full(_list_))                                                              \
         {                                                                                    \
-            if (!PFX##_resize(_list_, PFX##_count(_list_) * 2))                              \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_list_, _list_->count + 1)))                   \
                 return false;                                                                \
         }                                                                                    \
                                                                                              \
@@ -263,9 +474,12 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
         if (index > _list_->count)                                                           \
             return false;                                                                    \
                                                                                              \
+        if (!PFX##_impl_unshare(_list_))                                                     \
+            return false;                                                                    \
+                                                                                             \
         if (PFX##_full(_list_))                                                              \
         {                                                                                    \
-            if (!PFX##_resize(_list_, PFX##_count(_list_) * 2))                              \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_list_, _list_->count + 1)))                   \
                 return false;                                                                \
         }                                                                                    \
                                                                                              \
@@ -280,9 +494,12 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
                                                                                              \
     bool PFX##_push_back(struct SNAME *_list_, V element)                                    \
     {                                                                                        \
+        if (!PFX##_impl_unshare(_list_))                                                     \
+            return false;                                                                    \
+                                                                                             \
         if (PFX##_full(_list_))                                                              \
         {                                                                                    \
-            if (!PFX##_resize(_list_, PFX##_count(_list_) * 2))                              \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_list_, _list_->count + 1)))                   \
                 return false;                                                                \
         }                                                                                    \
                                                                                              \
@@ -296,9 +513,17 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
         if (PFX##_empty(_list_))                                                             \
             return false;                                                                    \
                                                                                              \
+        if (!PFX##_impl_unshare(_list_))                                                     \
+            return false;                                                                    \
+                                                                                             \
         memmove(_list_->buffer, _list_->buffer + 1, _list_->count * sizeof(V));              \
                                                                                              \
-        _list_->buffer[--_list_->count] = (V){0};                                            \
+        _list_->count--;                                                                     \
+                                                                                             \
+        if (!TRIVIAL)                                                                        \
+            _list_->buffer[_list_->count] = (V){0};                                          \
+                                                                                             \
+        PFX##_impl_low_water(_list_);                                                        \
                                                                                              \
         return true;                                                                         \
     }                                                                                        \
@@ -308,10 +533,18 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
         if (index >= _list_->count)                                                          \
             return false;                                                                    \
                                                                                              \
+        if (!PFX##_impl_unshare(_list_))                                                     \
+            return false;                                                                    \
+                                                                                             \
         memmove(_list_->buffer + index, _list_->buffer + index + 1,                          \
-                (_list_->count - index) * sizeof(V));                                        \
+                (_list_->count - index - 1) * sizeof(V));                                    \
+                                                                                             \
+        _list_->count--;                                                                     \
                                                                                              \
-        _list_->buffer[--_list_->count] = (V){0};                                            \
+        if (!TRIVIAL)                                                                        \
+            _list_->buffer[_list_->count] = (V){0};                                          \
+                                                                                             \
+        PFX##_impl_low_water(_list_);                                                        \
                                                                                              \
         return true;                                                                         \
     }                                                                                        \
@@ -321,19 +554,63 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
         if (PFX##_empty(_list_))                                                             \
             return false;                                                                    \
                                                                                              \
-        _list_->buffer[--_list_->count] = (V){0};                                            \
+        if (!PFX##_impl_unshare(_list_))                                                     \
+            return false;                                                                    \
+                                                                                             \
+        _list_->count--;                                                                     \
+                                                                                             \
+        if (!TRIVIAL)                                                                        \
+            _list_->buffer[_list_->count] = (V){0};                                          \
+                                                                                             \
+        PFX##_impl_low_water(_list_);                                                        \
                                                                                              \
         return true;                                                                         \
     }                                                                                        \
                                                                                              \
+    /* Removes every element for which pred is true in a single pass that */                 \
+    /* moves the others forward, passing the removed ones to deallocator. */                 \
+    /* Returns how many were removed */                                                      \
+    size_t PFX##_remove_if(struct SNAME *_list_, bool (*pred)(V), void (*deallocator)(V))    \
+    {                                                                                        \
+        if (PFX##_empty(_list_) || !PFX##_impl_unshare(_list_))                              \
+            return 0;                                                                        \
+                                                                                             \
+        size_t kept = 0;                                                                     \
+                                                                                             \
+        for (size_t i = 0; i < _list_->count; i++)                                           \
+        {                                                                                    \
+            V element = _list_->buffer[i];                                                   \
+                                                                                             \
+            if (!pred(element))                                                              \
+                _list_->buffer[kept++] = element;                                            \
+            else if (deallocator)                                                            \
+                deallocator(element);                                                        \
+        }                                                                                    \
+                                                                                             \
+        size_t removed = _list_->count - kept;                                               \
+                                                                                             \
+        if (!TRIVIAL)                                                                        \
+            memset(_list_->buffer + kept, 0, removed * sizeof(V));                           \
+                                                                                             \
+        _list_->count = kept;                                                                \
+                                                                                             \
+        if (removed > 0)                                                                     \
+            PFX##_impl_low_water(_list_);                                                    \
+                                                                                             \
+        return removed;                                                                      \
+    }                                                                                        \
+                                                                                             \
     bool PFX##_seq_push_front(struct SNAME *_list_, V *elements, size_t size)                \
     {                                                                                        \
         if (size == 0)                                                                       \
             return false;                                                                    \
                                                                                              \
+        if (!PFX##_impl_unshare(_list_))                                                     \
+            return false;                                                                    \
+                                                                                             \
         if (!PFX##_fits(_list_, size))                                                       \
         {                                                                                    \
-            if (!PFX##_resize(_list_, PFX##_count(_list_) + size))                           \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_list_, _list_->count + size)))                \
                 return false;                                                                \
         }                                                                                    \
                                                                                              \
@@ -357,9 +634,12 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
             return PFX##_seq_push_back(_list_, elements, size);                              \
         else                                                                                 \
         {                                                                                    \
+            if (!PFX##_impl_unshare(_list_))                                                 \
+                return false;                                                                \
+                                                                                             \
             if (!PFX##_fits(_list_, size))                                                   \
             {                                                                                \
-                if (!PFX##_resize(_list_, PFX##_count(_list_) + size))                       \
+                if (CMC_UNLIKELY(!PFX##_impl_grow(_list_, _list_->count + size)))            \
                     return false;                                                            \
             }                                                                                \
                                                                                              \
@@ -379,9 +659,12 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
         if (size == 0)                                                                       \
             return false;                                                                    \
                                                                                              \
+        if (!PFX##_impl_unshare(_list_))                                                     \
+            return false;                                                                    \
+                                                                                             \
         if (!PFX##_fits(_list_, size))                                                       \
         {                                                                                    \
-            if (!PFX##_resize(_list_, _list_->count + size))                                 \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_list_, _list_->count + size)))                \
                 return false;                                                                \
         }                                                                                    \
                                                                                              \
@@ -397,15 +680,21 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
         if (from > to || to >= _list_->count)                                                \
             return false;                                                                    \
                                                                                              \
+        if (!PFX##_impl_unshare(_list_))                                                     \
+            return false;                                                                    \
+                                                                                             \
         size_t length = (to - from + 1);                                                     \
                                                                                              \
         memmove(_list_->buffer + from, _list_->buffer + to + 1,                              \
                 (_list_->count - to - 1) * sizeof(V));                                       \
                                                                                              \
-        memset(_list_->buffer + _list_->count - length, 0, length * sizeof(V));              \
+        if (!TRIVIAL)                                                                        \
+            memset(_list_->buffer + _list_->count - length, 0, length * sizeof(V));          \
                                                                                              \
         _list_->count -= to - from + 1;                                                      \
                                                                                              \
+        PFX##_impl_low_water(_list_);                                                        \
+                                                                                             \
         return true;                                                                         \
     }                                                                                        \
                                                                                              \
@@ -414,11 +703,14 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
         if (from > to || to >= _list_->count)                                                \
             return false;                                                                    \
                                                                                              \
+        if (!PFX##_impl_unshare(_list_))                                                     \
+            return NULL;                                                                     \
+                                                                                             \
         size_t length = to - from + 1;                                                       \
                                                                                              \
-        struct SNAME *result = PFX##_new(length);                                            \
+        struct SNAME *result = PFX##_new_custom(length, _list_->alloc);                      \
                                                                                              \
-        if (!result)                                                                         \
+        if (CMC_UNLIKELY(!result))                                                           \
             return NULL;                                                                     \
                                                                                              \
         memcpy(result->buffer, _list_->buffer, _list_->count * sizeof(V));                   \
@@ -426,7 +718,8 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
         memmove(_list_->buffer + from, _list_->buffer + to + 1,                              \
                 (_list_->count - to - 1) * sizeof(V));                                       \
                                                                                              \
-        memset(_list_->buffer + _list_->count - length, 0, length * sizeof(V));              \
+        if (!TRIVIAL)                                                                        \
+            memset(_list_->buffer + _list_->count - length, 0, length * sizeof(V));          \
                                                                                              \
         _list_->count -= length;                                                             \
         result->count = length;                                                              \
@@ -458,6 +751,10 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
         if (PFX##_empty(_list_))                                                             \
             return NULL;                                                                     \
                                                                                              \
+        /* The element might be modified through the pointer */                              \
+        if (!PFX##_impl_unshare(_list_))                                                     \
+            return NULL;                                                                     \
+                                                                                             \
         return &(_list_->buffer[index]);                                                     \
     }                                                                                        \
                                                                                              \
@@ -472,37 +769,19 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
     size_t PFX##_indexof(struct SNAME *_list_, V element, int (*comparator)(V, V),           \
                          bool from_start)                                                    \
     {                                                                                        \
-        if (from_start)                                                                      \
-        {                                                                                    \
-            for (size_t i = 0; i < _list_->count; i++)                                       \
-            {                                                                                \
-                if (comparator(_list_->buffer[i], element) == 0)                             \
-                    return i;                                                                \
-            }                                                                                \
-        }                                                                                    \
-        else                                                                                 \
-        {                                                                                    \
-            for (size_t i = _list_->count; i > 0; i--)                                       \
-            {                                                                                \
-                if (comparator(_list_->buffer[i - 1], element) == 0)                         \
-                    return i - 1;                                                            \
-            }                                                                                \
-        }                                                                                    \
+        struct SNAME##_view view = { _list_->buffer, _list_->count };                        \
                                                                                              \
-        return _list_->count;                                                                \
+        return PFX##_view_indexof(view, element, comparator, from_start);                    \
     }                                                                                        \
                                                                                              \
     bool PFX##_contains(struct SNAME *_list_, V element, int (*comparator)(V, V))            \
     {                                                                                        \
-        for (size_t i = 0; i < _list_->count; i++)                                           \
-        {                                                                                    \
-            if (comparator(_list_->buffer[i], element) == 0)                                 \
-                return true;                                                                 \
-        }                                                                                    \
+        struct SNAME##_view view = { _list_->buffer, _list_->count };                        \
                                                                                              \
-        return false;                                                                        \
+        return PFX##_view_contains(view, element, comparator);                               \
     }                                                                                        \
                                                                                              \
+                                                                                             \
     bool PFX##_empty(struct SNAME *_list_)                                                   \
     {                                                                                        \
         return _list_->count == 0;                                                           \
@@ -518,6 +797,11 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
         return _list_->count;                                                                \
     }                                                                                        \
                                                                                              \
+    size_t PFX##_memory_usage(struct SNAME *_list_)                                          \
+    {                                                                                        \
+        return sizeof(struct SNAME) + sizeof(V) * _list_->capacity;                          \
+    }                                                                                        \
+                                                                                             \
     bool PFX##_fits(struct SNAME *_list_, size_t size)                                       \
     {                                                                                        \
         return _list_->count + size <= _list_->capacity;                                     \
@@ -528,6 +812,27 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
         return _list_->capacity;                                                             \
     }                                                                                        \
                                                                                              \
+    /* If the buffer is shared with a copy */                                                \
+    bool PFX##_shared(struct SNAME *_list_)                                                  \
+    {                                                                                        \
+        return !cmc_cow_alone(_list_->cow);                                                  \
+    }                                                                                        \
+                                                                                             \
+    /* With copy on write enabled, copy_of without a copy function takes */                  \
+    /* constant time and shares the buffer with the copy. Either one copies */               \
+    /* it before its first modification */                                                   \
+    void PFX##_set_copy_on_write(struct SNAME *_list_, bool enabled)                         \
+    {                                                                                        \
+        _list_->copy_on_write = enabled;                                                     \
+    }                                                                                        \
+                                                                                             \
+    /* Copies a buffer shared with copies, so that it can be written to */                   \
+    /* directly, like the callbacks of cmc_callback.h do */                                  \
+    bool PFX##_unshare(struct SNAME *_list_)                                                 \
+    {                                                                                        \
+        return PFX##_impl_unshare(_list_);                                                   \
+    }                                                                                        \
+                                                                                             \
     bool PFX##_resize(struct SNAME *_list_, size_t capacity)                                 \
     {                                                                                        \
         if (PFX##_capacity(_list_) == capacity)                                              \
@@ -536,9 +841,12 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
         if (capacity < PFX##_count(_list_))                                                  \
             return false;                                                                    \
                                                                                              \
-        V *new_buffer = realloc(_list_->buffer, sizeof(V) * capacity);                       \
+        if (!PFX##_impl_unshare(_list_))                                                     \
+            return false;                                                                    \
+                                                                                             \
+        V *new_buffer = _list_->alloc->realloc(_list_->buffer, sizeof(V) * capacity);        \
                                                                                              \
-        if (!new_buffer)                                                                     \
+        if (CMC_UNLIKELY(!new_buffer))                                                       \
             return false;                                                                    \
                                                                                              \
         _list_->buffer = new_buffer;                                                         \
@@ -547,11 +855,82 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
         return true;                                                                         \
     }                                                                                        \
                                                                                              \
+    bool PFX##_shrink_to_fit(struct SNAME *_list_)                                           \
+    {                                                                                        \
+        return PFX##_resize(_list_, _list_->count > 0 ? _list_->count : 1);                  \
+    }                                                                                        \
+                                                                                             \
+    /* Grows the buffer so that at least capacity elements fit. Unlike */                    \
+    /* resize it never shrinks the buffer */                                                 \
+    bool PFX##_reserve(struct SNAME *_list_, size_t capacity)                                \
+    {                                                                                        \
+        if (capacity <= _list_->capacity)                                                    \
+            return true;                                                                     \
+                                                                                             \
+        return PFX##_resize(_list_, capacity);                                               \
+    }                                                                                        \
+                                                                                             \
+    /* Sorts the list in place in O(n log n) with the engine of cmc_sort.h */                \
+    void PFX##_sort(struct SNAME *_list_, int (*comparator)(V, V))                           \
+    {                                                                                        \
+        if (!PFX##_impl_unshare(_list_))                                                     \
+            return;                                                                          \
+                                                                                             \
+        PFX##_impl_sort(comparator, _list_->buffer, _list_->count);                          \
+    }                                                                                        \
+                                                                                             \
+    /* Same as sort but with up to the given amount of threads */                            \
+    void PFX##_sort_parallel(struct SNAME *_list_, int (*comparator)(V, V), size_t threads)  \
+    {                                                                                        \
+        if (!PFX##_impl_unshare(_list_))                                                     \
+            return;                                                                          \
+                                                                                             \
+        PFX##_impl_parallel_sort(comparator, _list_->buffer, _list_->count, threads);        \
+    }                                                                                        \
+                                                                                             \
+    /* A parallel scan has one slot for each element */                                      \
+    size_t PFX##_parallel_slots(struct SNAME *_list_)                                        \
+    {                                                                                        \
+        return _list_->count;                                                                \
+    }                                                                                        \
+                                                                                             \
+    /* Splits the elements into contiguous ranges, one for each of up to the */              \
+    /* given amount of threads, and combines the results of each range */                    \
+    V PFX##_parallel_reduce(struct SNAME *_list_, V initial, V (*reduce)(V, V),              \
+                            V (*combine)(V, V), size_t threads)                              \
+    {                                                                                        \
+        return PFX##_impl_parallel_reduce(_list_, _list_->count, initial, reduce, combine,   \
+                                          threads);                                          \
+    }                                                                                        \
+                                                                                             \
     struct SNAME *PFX##_copy_of(struct SNAME *_list_, V (*copy_func)(V))                     \
     {                                                                                        \
-        struct SNAME *result = PFX##_new(_list_->capacity);                                  \
+        if (_list_->copy_on_write && !copy_func)                                             \
+        {                                                                                    \
+            struct SNAME *result = _list_->alloc->malloc(sizeof(struct SNAME));              \
+                                                                                             \
+            if (CMC_UNLIKELY(!result))                                                       \
+                return NULL;                                                                 \
+                                                                                             \
+            struct cmc_cow *cow = cmc_cow_share(_list_->cow, _list_->alloc);                 \
+                                                                                             \
+            if (!cow)                                                                        \
+            {                                                                                \
+                _list_->alloc->free(result);                                                 \
+                return NULL;                                                                 \
+            }                                                                                \
+                                                                                             \
+            *result = *_list_;                                                               \
+                                                                                             \
+            result->cow = cow;                                                               \
+            _list_->cow = cow;                                                               \
+                                                                                             \
+            return result;                                                                   \
+        }                                                                                    \
+                                                                                             \
+        struct SNAME *result = PFX##_new_custom(_list_->capacity, _list_->alloc);            \
                                                                                              \
-        if (!result)                                                                         \
+        if (CMC_UNLIKELY(!result))                                                           \
             return NULL;                                                                     \
                                                                                              \
         if (copy_func)                                                                       \
@@ -567,18 +946,34 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
         return result;                                                                       \
     }                                                                                        \
                                                                                              \
+    /* Copies up to size elements, in the order that they are iterated, to */                \
+    /* elements and returns how many were copied */                                          \
+    size_t PFX##_to_array(struct SNAME *_list_, V *CMC_RESTRICT elements, size_t size)       \
+    {                                                                                        \
+        if (size > _list_->count)                                                            \
+            size = _list_->count;                                                            \
+                                                                                             \
+        memcpy(elements, _list_->buffer, size * sizeof(V));                                  \
+                                                                                             \
+        return size;                                                                         \
+    }                                                                                        \
+                                                                                             \
     bool PFX##_equals(struct SNAME *_list1_, struct SNAME *_list2_, int (*comparator)(V, V)) \
     {                                                                                        \
         if (PFX##_count(_list1_) != PFX##_count(_list2_))                                    \
             return false;                                                                    \
                                                                                              \
+        /* Copies in copy on write mode that still share their buffer */                     \
+        if (_list1_->buffer == _list2_->buffer)                                              \
+            return true;                                                                     \
+                                                                                             \
         for (size_t i = 0; i < PFX##_count(_list1_); i++)                                    \
         {                                                                                    \
             if (comparator(_list1_->buffer[i], _list2_->buffer[i]) != 0)                     \
                 return false;                                                                \
         }                                                                                    \
                                                                                              \
-        return false;                                                                        \
+        return true;                                                                         \
     }                                                                                        \
                                                                                              \
     struct cmc_string PFX##_to_string(struct SNAME *_list_)                                  \
@@ -593,11 +988,182 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
         return str;                                                                          \
     }                                                                                        \
                                                                                              \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE)                           \
+                                                                                             \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE, (V))                             \
+                                                                                             \
+    bool PFX##_save(struct SNAME *_list_, FILE *file, bool (*writer)(V, FILE *))             \
+    {                                                                                        \
+        uint32_t flags = writer ? 0 : CMC_SERIAL_RAW_VALUES;                                 \
+                                                                                             \
+        if (!cmc_serial_write_header(file, "list", flags, 0, sizeof(V), 0,                   \
+                                     _list_->count, _list_->capacity, 0))                    \
+            return false;                                                                    \
+                                                                                             \
+        /* Without a writer the whole buffer is written at once */                           \
+        if (!writer)                                                                         \
+            return fwrite(_list_->buffer, sizeof(V), _list_->count, file) == _list_->count;  \
+                                                                                             \
+        for (size_t i = 0; i < _list_->count; i++)                                           \
+        {                                                                                    \
+            if (!writer(_list_->buffer[i], file))                                            \
+                return false;                                                                \
+        }                                                                                    \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* The reader is only used if the list was saved with a writer */                        \
+    struct SNAME *PFX##_restore(FILE *file, bool (*reader)(V *, FILE *))                     \
+    {                                                                                        \
+        struct cmc_serial_header header;                                                     \
+                                                                                             \
+        if (!cmc_serial_read_header(file, "list", 0, sizeof(V), &header))                    \
+            return NULL;                                                                     \
+                                                                                             \
+        if (header.capacity < header.count)                                                  \
+            return NULL;                                                                     \
+                                                                                             \
+        /* Allocated with the saved capacity so that loading never grows */                  \
+        struct SNAME *_list_ = PFX##_new(header.capacity);                                   \
+                                                                                             \
+        if (CMC_UNLIKELY(!_list_))                                                           \
+            return NULL;                                                                     \
+                                                                                             \
+        if (header.flags & CMC_SERIAL_RAW_VALUES)                                            \
+            _list_->count = fread(_list_->buffer, sizeof(V), header.count, file);            \
+        else                                                                                 \
+        {                                                                                    \
+            while (_list_->count < header.count &&                                           \
+                   CMC_SERIAL_READ(false, reader, &(_list_->buffer[_list_->count]), file))   \
+                _list_->count++;                                                             \
+        }                                                                                    \
+                                                                                             \
+        if (_list_->count != header.count)                                                   \
+        {                                                                                    \
+            PFX##_free(_list_, NULL);                                                        \
+            return NULL;                                                                     \
+        }                                                                                    \
+                                                                                             \
+        return _list_;                                                                       \
+    }                                                                                        \
+                                                                                             \
+    static size_t PFX##_impl_serialize_fill(void *serializer, unsigned char *out,            \
+                                            size_t room)                                     \
+    {                                                                                        \
+        struct SNAME##_serializer *s = serializer;                                           \
+        size_t n = s->target->count - s->index;                                              \
+                                                                                             \
+        if (n > room / sizeof(V))                                                            \
+            n = room / sizeof(V);                                                            \
+                                                                                             \
+        memcpy(out, s->target->buffer + s->index, n * sizeof(V));                            \
+                                                                                             \
+        s->index += n;                                                                       \
+                                                                                             \
+        return n * sizeof(V);                                                                \
+    }                                                                                        \
+                                                                                             \
+    /* The elements are written as they are in memory, in blocks of up to */                 \
+    /* block_size bytes, or CMC_SERIAL_BLOCK_SIZE if it is 0 */                              \
+    bool PFX##_serialize_begin(struct SNAME##_serializer *serializer, struct SNAME *_list_,  \
+                               size_t block_size, bool checksum)                             \
+    {                                                                                        \
+        serializer->target = _list_;                                                         \
+        serializer->index = 0;                                                               \
+                                                                                             \
+        return cmc_serial_writer_begin(&serializer->writer, "list", 0, sizeof(V), 0,         \
+                                       _list_->count, _list_->capacity, 0, block_size,       \
+                                       checksum);                                            \
+    }                                                                                        \
+                                                                                             \
+    /* Copies up to size bytes of the stream to buffer and returns how many */               \
+    /* were copied, 0 once all of them were */                                               \
+    size_t PFX##_serialize_next(struct SNAME##_serializer *serializer, void *buffer,         \
+                                size_t size)                                                 \
+    {                                                                                        \
+        return cmc_serial_writer_next(&serializer->writer, buffer, size,                     \
+                                      PFX##_impl_serialize_fill, serializer);                \
+    }                                                                                        \
+                                                                                             \
+    void PFX##_serialize_end(struct SNAME##_serializer *serializer)                          \
+    {                                                                                        \
+        cmc_serial_writer_end(&serializer->writer);                                          \
+    }                                                                                        \
+                                                                                             \
+    static bool PFX##_impl_deserialize_header(void *deserializer,                            \
+                                              struct cmc_serial_header *header)              \
+    {                                                                                        \
+        struct SNAME##_deserializer *d = deserializer;                                       \
+                                                                                             \
+        if (!cmc_serial_check_header("list", 0, sizeof(V), header) ||                        \
+            !(header->flags & CMC_SERIAL_RAW_VALUES) || header->capacity < header->count)    \
+            return false;                                                                    \
+                                                                                             \
+        d->result = PFX##_new(header->capacity);                                             \
+                                                                                             \
+        return d->result != NULL;                                                            \
+    }                                                                                        \
+                                                                                             \
+    static bool PFX##_impl_deserialize_consume(void *deserializer, const unsigned char *in,  \
+                                               size_t size)                                  \
+    {                                                                                        \
+        struct SNAME##_deserializer *d = deserializer;                                       \
+        struct SNAME *_list_ = d->result;                                                    \
+        size_t n = size / sizeof(V);                                                         \
+                                                                                             \
+        if (size % sizeof(V) != 0 || !PFX##_reserve(_list_, _list_->count + n))              \
+            return false;                                                                    \
+                                                                                             \
+        memcpy(_list_->buffer + _list_->count, in, size);                                    \
+                                                                                             \
+        _list_->count += n;                                                                  \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* Blocks longer than block_size, or CMC_SERIAL_BLOCK_SIZE if it is 0, */                \
+    /* are rejected */                                                                       \
+    bool PFX##_deserialize_begin(struct SNAME##_deserializer *deserializer,                  \
+                                 size_t block_size)                                          \
+    {                                                                                        \
+        deserializer->result = NULL;                                                         \
+                                                                                             \
+        return cmc_serial_reader_begin(&deserializer->reader, block_size);                   \
+    }                                                                                        \
+                                                                                             \
+    /* Takes the next size bytes of the stream, returns false if they are */                 \
+    /* not valid, and so does every call after that */                                       \
+    bool PFX##_deserialize_next(struct SNAME##_deserializer *deserializer,                   \
+                                const void *buffer, size_t size)                             \
+    {                                                                                        \
+        return cmc_serial_reader_next(&deserializer->reader, buffer, size,                   \
+                                      PFX##_impl_deserialize_header,                         \
+                                      PFX##_impl_deserialize_consume, deserializer);         \
+    }                                                                                        \
+                                                                                             \
+    /* Returns the list if the whole stream arrived, otherwise NULL */                       \
+    struct SNAME *PFX##_deserialize_end(struct SNAME##_deserializer *deserializer)           \
+    {                                                                                        \
+        struct SNAME *_list_ = deserializer->result;                                         \
+                                                                                             \
+        if (!cmc_serial_reader_end(&deserializer->reader) ||                                 \
+            (_list_ && _list_->count != deserializer->reader.header.count))                  \
+        {                                                                                    \
+            if (_list_)                                                                      \
+                PFX##_free(_list_, NULL);                                                    \
+                                                                                             \
+            return NULL;                                                                     \
+        }                                                                                    \
+                                                                                             \
+        return _list_;                                                                       \
+    }                                                                                        \
+                                                                                             \
     struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                \
     {                                                                                        \
-        struct SNAME##_iter *iter = malloc(sizeof(struct SNAME##_iter));                     \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));      \
                                                                                              \
-        if (!iter)                                                                           \
+        if (CMC_UNLIKELY(!iter))                                                             \
             return NULL;                                                                     \
                                                                                              \
         PFX##_iter_init(iter, target);                                                       \
@@ -607,7 +1173,7 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
                                                                                              \
     void PFX##_iter_free(struct SNAME##_iter *iter)                                          \
     {                                                                                        \
-        free(iter);                                                                          \
+        iter->target->alloc->free(iter);                                                     \
     }                                                                                        \
                                                                                              \
     void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                    \
@@ -742,6 +1308,17 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
         return true;                                                                         \
     }                                                                                        \
                                                                                              \
+    /* Places iter at the element of a slot, for CMC_PARALLEL_FOR_EACH */                    \
+    bool PFX##_parallel_iter(struct SNAME##_iter *iter, struct SNAME *target, size_t slot)   \
+    {                                                                                        \
+        iter->target = target;                                                               \
+        iter->cursor = slot;                                                                 \
+        iter->start = slot == 0;                                                             \
+        iter->end = slot + 1 >= target->count;                                               \
+                                                                                             \
+        return slot < target->count;                                                         \
+    }                                                                                        \
+                                                                                             \
     V PFX##_iter_value(struct SNAME##_iter *iter)                                            \
     {                                                                                        \
         if (PFX##_empty(iter->target))                                                       \
@@ -755,6 +1332,9 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
         if (PFX##_empty(iter->target))                                                       \
             return NULL;                                                                     \
                                                                                              \
+        if (!PFX##_impl_unshare(iter->target))                                               \
+            return NULL;                                                                     \
+                                                                                             \
         return &(iter->target->buffer[iter->cursor]);                                        \
     }                                                                                        \
                                                                                              \
@@ -763,6 +1343,206 @@ static const char *cmc_string_fmt_list = "%s at %p { buffer:%p, capacity:%" PRIu
         return iter->cursor;                                                                 \
     }                                                                                        \
                                                                                              \
+    /* The elements from index from to index to, both inclusive, or an empty */              \
+    /* view if the range is not in the list */                                               \
+    struct SNAME##_view PFX##_view(struct SNAME *_list_, size_t from, size_t to)             \
+    {                                                                                        \
+        struct SNAME##_view view = { NULL, 0 };                                              \
+                                                                                             \
+        if (from > to || to >= _list_->count)                                                \
+            return view;                                                                     \
+                                                                                             \
+        view.data = _list_->buffer + from;                                                   \
+        view.count = to - from + 1;                                                          \
+                                                                                             \
+        return view;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* Narrows a view in the same way as PFX_view narrows a list */                          \
+    struct SNAME##_view PFX##_view_slice(struct SNAME##_view view, size_t from, size_t to)   \
+    {                                                                                        \
+        struct SNAME##_view result = { NULL, 0 };                                            \
+                                                                                             \
+        if (from > to || to >= view.count)                                                   \
+            return result;                                                                   \
+                                                                                             \
+        result.data = view.data + from;                                                      \
+        result.count = to - from + 1;                                                        \
+                                                                                             \
+        return result;                                                                       \
+    }                                                                                        \
+                                                                                             \
+    V PFX##_view_get(struct SNAME##_view view, size_t index)                                 \
+    {                                                                                        \
+        if (index >= view.count)                                                             \
+            return (V){0};                                                                   \
+                                                                                             \
+        return view.data[index];                                                             \
+    }                                                                                        \
+                                                                                             \
+    /* Returns the count of the view if the element is not in it */                          \
+    size_t PFX##_view_indexof(struct SNAME##_view view, V element, int (*comparator)(V, V),  \
+                              bool from_start)                                               \
+    {                                                                                        \
+        if (BITWISE)                                                                         \
+        {                                                                                    \
+            if (from_start)                                                                  \
+                return cmc_scan_find(view.data, view.count, sizeof(V), &element);            \
+                                                                                             \
+            return cmc_scan_find_last(view.data, view.count, sizeof(V), &element);           \
+        }                                                                                    \
+                                                                                             \
+        if (from_start)                                                                      \
+        {                                                                                    \
+            for (size_t i = 0; i < view.count; i++)                                          \
+            {                                                                                \
+                if (comparator(view.data[i], element) == 0)                                  \
+                    return i;                                                                \
+            }                                                                                \
+        }                                                                                    \
+        else                                                                                 \
+        {                                                                                    \
+            for (size_t i = view.count; i > 0; i--)                                          \
+            {                                                                                \
+                if (comparator(view.data[i - 1], element) == 0)                              \
+                    return i - 1;                                                            \
+            }                                                                                \
+        }                                                                                    \
+                                                                                             \
+        return view.count;                                                                   \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_view_contains(struct SNAME##_view view, V element, int (*comparator)(V, V))   \
+    {                                                                                        \
+        if (BITWISE)                                                                         \
+            return cmc_scan_find(view.data, view.count, sizeof(V), &element) != view.count;  \
+                                                                                             \
+        for (size_t i = 0; i < view.count; i++)                                              \
+        {                                                                                    \
+            if (comparator(view.data[i], element) == 0)                                      \
+                return true;                                                                 \
+        }                                                                                    \
+                                                                                             \
+        return false;                                                                        \
+    }                                                                                        \
+                                                                                             \
+    void PFX##_view_iter_init(struct SNAME##_view_iter *iter, struct SNAME##_view view)      \
+    {                                                                                        \
+        iter->view = view;                                                                   \
+        iter->cursor = 0;                                                                    \
+        iter->start = true;                                                                  \
+        iter->end = view.count == 0;                                                         \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_view_iter_start(struct SNAME##_view_iter *iter)                               \
+    {                                                                                        \
+        return iter->view.count == 0 || iter->start;                                         \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_view_iter_end(struct SNAME##_view_iter *iter)                                 \
+    {                                                                                        \
+        return iter->view.count == 0 || iter->end;                                           \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_view_iter_next(struct SNAME##_view_iter *iter)                                \
+    {                                                                                        \
+        if (iter->end)                                                                       \
+            return false;                                                                    \
+                                                                                             \
+        if (iter->cursor + 1 == iter->view.count)                                            \
+        {                                                                                    \
+            iter->end = true;                                                                \
+            return false;                                                                    \
+        }                                                                                    \
+                                                                                             \
+        iter->start = false;                                                                 \
+                                                                                             \
+        iter->cursor++;                                                                      \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_view_iter_prev(struct SNAME##_view_iter *iter)                                \
+    {                                                                                        \
+        if (iter->start)                                                                     \
+            return false;                                                                    \
+                                                                                             \
+        if (iter->cursor == 0)                                                               \
+        {                                                                                    \
+            iter->start = true;                                                              \
+            return false;                                                                    \
+        }                                                                                    \
+                                                                                             \
+        iter->end = false;                                                                   \
+                                                                                             \
+        iter->cursor--;                                                                      \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    V PFX##_view_iter_value(struct SNAME##_view_iter *iter)                                  \
+    {                                                                                        \
+        if (iter->view.count == 0)                                                           \
+            return (V){0};                                                                   \
+                                                                                             \
+        return iter->view.data[iter->cursor];                                                \
+    }                                                                                        \
+                                                                                             \
+    size_t PFX##_view_iter_index(struct SNAME##_view_iter *iter)                             \
+    {                                                                                        \
+        return iter->cursor;                                                                 \
+    }                                                                                        \
+                                                                                             \
+    /* Called after removals, halves the buffer until it is no longer mostly empty */        \
+    static void PFX##_impl_low_water(struct SNAME *_list_)                                   \
+    {                                                                                        \
+        size_t capacity = _list_->capacity;                                                  \
+                                                                                             \
+        while (capacity > 1 &&                                                               \
+               (double)_list_->count < (double)capacity * CMC_SHRINK_LOW_WATER)              \
+            capacity /= 2;                                                                   \
+                                                                                             \
+        if (capacity != _list_->capacity)                                                    \
+            PFX##_resize(_list_, capacity);                                                  \
+    }                                                                                        \
+                                                                                             \
+    /* Called when the buffer is full, grows it by the policy of cmc_growth.h */             \
+    static bool PFX##_impl_grow(struct SNAME *_list_, size_t required)                       \
+    {                                                                                        \
+        return PFX##_resize(_list_, cmc_growth_capacity(_list_->capacity, required));        \
+    }                                                                                        \
+                                                                                             \
+    /* Called before every modification, copies a buffer that is shared */                   \
+    static bool PFX##_impl_unshare(struct SNAME *_list_)                                     \
+    {                                                                                        \
+        if (!_list_->cow)                                                                    \
+            return true;                                                                     \
+                                                                                             \
+        if (cmc_cow_alone(_list_->cow))                                                      \
+        {                                                                                    \
+            cmc_cow_release(_list_->cow, _list_->alloc);                                     \
+            _list_->cow = NULL;                                                              \
+                                                                                             \
+            return true;                                                                     \
+        }                                                                                    \
+                                                                                             \
+        V *buffer = _list_->alloc->calloc(_list_->capacity, sizeof(V));                      \
+                                                                                             \
+        if (CMC_UNLIKELY(!buffer))                                                           \
+            return false;                                                                    \
+                                                                                             \
+        memcpy(buffer, _list_->buffer, sizeof(V) * _list_->count);                           \
+                                                                                             \
+        /* The other lists might have dropped the buffer meanwhile */                        \
+        if (cmc_cow_release(_list_->cow, _list_->alloc))                                     \
+            _list_->alloc->free(_list_->buffer);                                             \
+                                                                                             \
+        _list_->buffer = buffer;                                                             \
+        _list_->cow = NULL;                                                                  \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
     static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_list_)                     \
     {                                                                                        \
         struct SNAME##_iter iter;                                                            \
@@ -0,0 +1,563 @@
+/**
+ * lrucache.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * LRUCache
+ *
+ * An LRUCache is a Map with unique keys that holds at most a fixed amount of
+ * entries. Once it is full, putting a new key evicts the entry that was used
+ * the longest time ago, which is given to an optional eviction callback. Both
+ * putting and getting a key mark it as the most recently used.
+ *
+ * Implementation
+ *
+ * A single open addressing hashtable with linear probing. Every slot carries
+ * the indices of the slots used right before and after it, so the recency
+ * order is a doubly-linked list threaded through the table and no node is
+ * allocated per entry. A get is one lookup plus relinking a few indices and a
+ * put that evicts reuses the slots already allocated. Removals move back the
+ * entries that follow in the same cluster (backward shift deletion), so there
+ * are no tombstones even though every put to a full cache removes an entry,
+ * and the moved entries have their neighbors relinked.
+ */
+
+#ifndef CMC_LRUCACHE_H
+#define CMC_LRUCACHE_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+#include "hashmap.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_lrucache = "%s at %p { buffer:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", limit:%" PRIuMAX ", head:%" PRIuMAX ", tail:%" PRIuMAX ", cmp:%p, hash:%p, evict:%p }";
+
+/* Fraction of the slots in use once the cache is full. Linear probing */
+/* needs a lower load than the robin hood hashing of the HashMap */
+#ifndef CMC_LRUCACHE_LOAD
+#define CMC_LRUCACHE_LOAD 0.6
+#endif
+
+/* Index of no slot, at both ends of the recency list */
+#define CMC_LRUCACHE_NONE SIZE_MAX
+
+#define CMC_GENERATE_LRUCACHE(PFX, SNAME, K, V)    \
+    CMC_GENERATE_LRUCACHE_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_LRUCACHE_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_LRUCACHE_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_LRUCACHE_HEADER(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_LRUCACHE_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_LRUCACHE_SOURCE(PFX, SNAME, K, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_LRUCACHE_HEADER(PFX, SNAME, K, V)                             \
+                                                                                   \
+    /* LRUCache Structure */                                                       \
+    struct SNAME                                                                   \
+    {                                                                              \
+        /* Array of Entries */                                                     \
+        struct SNAME##_entry *buffer;                                              \
+                                                                                   \
+        /* Amount of slots of the table */                                         \
+        size_t capacity;                                                           \
+                                                                                   \
+        /* Total amount of entries */                                              \
+        size_t count;                                                              \
+                                                                                   \
+        /* Entries held before the least recently used starts being evicted */     \
+        size_t limit;                                                              \
+                                                                                   \
+        /* Slots of the most and of the least recently used entries */             \
+        size_t head;                                                               \
+        size_t tail;                                                               \
+                                                                                   \
+        /* Key comparison function */                                              \
+        int (*cmp)(K, K);                                                          \
+                                                                                   \
+        /* Key hash function */                                                    \
+        size_t (*hash)(K);                                                         \
+                                                                                   \
+        /* Called with every entry evicted by a put, may be NULL */                \
+        void (*evict)(K, V);                                                       \
+                                                                                   \
+        /* Lookup counters, only present with CMC_HASHTABLE_PROBE_STATS */         \
+        CMC_IMPL_HASHTABLE_PROBE_FIELDS                                            \
+                                                                                   \
+        /* Custom allocation functions */                                          \
+        struct cmc_alloc_node *alloc;                                              \
+    };                                                                             \
+                                                                                   \
+    /* LRUCache Entry */                                                           \
+    struct SNAME##_entry                                                           \
+    {                                                                              \
+        /* Entry Key */                                                            \
+        K key;                                                                     \
+                                                                                   \
+        /* Entry Value */                                                          \
+        V value;                                                                   \
+                                                                                   \
+        /* The distance of this entry to its original position */                  \
+        size_t dist;                                                               \
+                                                                                   \
+        /* Slots of the entries used right before and after this one */            \
+        size_t prev;                                                               \
+        size_t next;                                                               \
+                                                                                   \
+        /* If this slot holds an entry */                                          \
+        bool filled;                                                               \
+    };                                                                             \
+                                                                                   \
+    /* Collection Functions */                                                     \
+    /* Collection Allocation and Deallocation */                                   \
+    struct SNAME *PFX##_new(size_t limit, int (*compare)(K, K), size_t (*hash)(K), \
+                            void (*evict)(K, V));                                  \
+    struct SNAME *PFX##_new_custom(size_t limit, int (*compare)(K, K),             \
+                                   size_t (*hash)(K), void (*evict)(K, V),         \
+                                   struct cmc_alloc_node *alloc);                  \
+    void PFX##_clear(struct SNAME *_cache_, void (*deallocator)(K, V));            \
+    void PFX##_free(struct SNAME *_cache_, void (*deallocator)(K, V));             \
+    /* Collection Input and Output */                                              \
+    bool PFX##_put(struct SNAME *_cache_, K key, V value);                         \
+    bool PFX##_remove(struct SNAME *_cache_, K key, V *out_value);                 \
+    /* Element Access */                                                           \
+    V PFX##_get(struct SNAME *_cache_, K key);                                     \
+    V *PFX##_get_ref(struct SNAME *_cache_, K key);                                \
+    V *PFX##_peek(struct SNAME *_cache_, K key);                                   \
+    bool PFX##_newest(struct SNAME *_cache_, K *key, V *value);                    \
+    bool PFX##_oldest(struct SNAME *_cache_, K *key, V *value);                    \
+    /* Collection State */                                                         \
+    bool PFX##_contains(struct SNAME *_cache_, K key);                             \
+    CMC_PURE bool PFX##_empty(struct SNAME *_cache_);                              \
+    bool PFX##_full(struct SNAME *_cache_);                                        \
+    CMC_PURE size_t PFX##_count(struct SNAME *_cache_);                            \
+    size_t PFX##_memory_usage(struct SNAME *_cache_);                              \
+    size_t PFX##_limit(struct SNAME *_cache_);                                     \
+    size_t PFX##_capacity(struct SNAME *_cache_);                                  \
+    void PFX##_stats(struct SNAME *_cache_, struct cmc_hashtable_stats *out);      \
+    /* Collection Utility */                                                       \
+    struct cmc_string PFX##_to_string(struct SNAME *_cache_);                      \
+                                                                                   \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_LRUCACHE_SOURCE(PFX, SNAME, K, V)                                        \
+                                                                                              \
+    /* Implementation Detail Functions */                                                     \
+    static size_t PFX##_impl_find(struct SNAME *_cache_, K key, size_t hash);                 \
+    static size_t PFX##_impl_insert(struct SNAME *_cache_, K key, V value, size_t hash);      \
+    static void PFX##_impl_remove_slot(struct SNAME *_cache_, size_t slot);                   \
+    static void PFX##_impl_move(struct SNAME *_cache_, size_t from, size_t to);               \
+    static void PFX##_impl_link_front(struct SNAME *_cache_, size_t slot);                    \
+    static void PFX##_impl_unlink(struct SNAME *_cache_, size_t slot);                        \
+    static void PFX##_impl_promote(struct SNAME *_cache_, size_t slot);                       \
+                                                                                              \
+    struct SNAME *PFX##_new(size_t limit, int (*compare)(K, K), size_t (*hash)(K),            \
+                            void (*evict)(K, V))                                              \
+    {                                                                                         \
+        return PFX##_new_custom(limit, compare, hash, evict, NULL);                           \
+    }                                                                                         \
+                                                                                              \
+    struct SNAME *PFX##_new_custom(size_t limit, int (*compare)(K, K), size_t (*hash)(K),     \
+                                   void (*evict)(K, V), struct cmc_alloc_node *alloc)         \
+    {                                                                                         \
+        if (!alloc)                                                                           \
+            alloc = &cmc_alloc_node_default;                                                  \
+                                                                                              \
+        if (limit == 0 || limit >= SIZE_MAX * CMC_LRUCACHE_LOAD)                              \
+            return NULL;                                                                      \
+                                                                                              \
+        size_t capacity = cmc_hashtable_prime_size((size_t)(limit / CMC_LRUCACHE_LOAD) + 1);  \
+                                                                                              \
+        struct SNAME *_cache_ = alloc->malloc(sizeof(struct SNAME));                          \
+                                                                                              \
+        if (CMC_UNLIKELY(!_cache_))                                                           \
+            return NULL;                                                                      \
+                                                                                              \
+        _cache_->alloc = alloc;                                                               \
+                                                                                              \
+        _cache_->buffer = alloc->calloc(capacity, sizeof(struct SNAME##_entry));              \
+                                                                                              \
+        if (CMC_UNLIKELY(!_cache_->buffer))                                                   \
+        {                                                                                     \
+            alloc->free(_cache_);                                                             \
+            return NULL;                                                                      \
+        }                                                                                     \
+                                                                                              \
+        _cache_->capacity = capacity;                                                         \
+        _cache_->count = 0;                                                                   \
+        _cache_->limit = limit;                                                               \
+        _cache_->head = CMC_LRUCACHE_NONE;                                                    \
+        _cache_->tail = CMC_LRUCACHE_NONE;                                                    \
+        _cache_->cmp = compare;                                                               \
+        _cache_->hash = hash;                                                                 \
+        _cache_->evict = evict;                                                               \
+                                                                                              \
+        CMC_IMPL_HASHTABLE_PROBE_RESET(_cache_);                                              \
+                                                                                              \
+        return _cache_;                                                                       \
+    }                                                                                         \
+                                                                                              \
+    /* The deallocator is called for every entry, the eviction callback is not */             \
+    void PFX##_clear(struct SNAME *_cache_, void (*deallocator)(K, V))                        \
+    {                                                                                         \
+        if (deallocator)                                                                      \
+        {                                                                                     \
+            for (size_t i = 0; i < _cache_->capacity; i++)                                    \
+            {                                                                                 \
+                struct SNAME##_entry *entry = &(_cache_->buffer[i]);                          \
+                                                                                              \
+                if (entry->filled)                                                            \
+                    deallocator(entry->key, entry->value);                                    \
+            }                                                                                 \
+        }                                                                                     \
+                                                                                              \
+        memset(_cache_->buffer, 0, sizeof(struct SNAME##_entry) * _cache_->capacity);         \
+                                                                                              \
+        _cache_->count = 0;                                                                   \
+        _cache_->head = CMC_LRUCACHE_NONE;                                                    \
+        _cache_->tail = CMC_LRUCACHE_NONE;                                                    \
+    }                                                                                         \
+                                                                                              \
+    void PFX##_free(struct SNAME *_cache_, void (*deallocator)(K, V))                         \
+    {                                                                                         \
+        if (deallocator)                                                                      \
+            PFX##_clear(_cache_, deallocator);                                                \
+                                                                                              \
+        _cache_->alloc->free(_cache_->buffer);                                                \
+        _cache_->alloc->free(_cache_);                                                        \
+    }                                                                                         \
+                                                                                              \
+    /* Inserts or updates a key and marks it as the most recently used. A */                  \
+    /* new key evicts the least recently used entry of a full cache first. */                 \
+    /* Returns true if the key was new and false if its value was replaced */                 \
+    bool PFX##_put(struct SNAME *_cache_, K key, V value)                                     \
+    {                                                                                         \
+        size_t hash = _cache_->hash(key);                                                     \
+        size_t slot = PFX##_impl_find(_cache_, key, hash);                                    \
+                                                                                              \
+        if (slot != CMC_LRUCACHE_NONE)                                                        \
+        {                                                                                     \
+            _cache_->buffer[slot].value = value;                                              \
+                                                                                              \
+            PFX##_impl_promote(_cache_, slot);                                                \
+                                                                                              \
+            return false;                                                                     \
+        }                                                                                     \
+                                                                                              \
+        if (PFX##_full(_cache_))                                                              \
+        {                                                                                     \
+            struct SNAME##_entry oldest = _cache_->buffer[_cache_->tail];                     \
+                                                                                              \
+            PFX##_impl_remove_slot(_cache_, _cache_->tail);                                   \
+                                                                                              \
+            if (_cache_->evict)                                                               \
+                _cache_->evict(oldest.key, oldest.value);                                     \
+        }                                                                                     \
+                                                                                              \
+        PFX##_impl_insert(_cache_, key, value, hash);                                         \
+                                                                                              \
+        return true;                                                                          \
+    }                                                                                         \
+                                                                                              \
+    bool PFX##_remove(struct SNAME *_cache_, K key, V *out_value)                             \
+    {                                                                                         \
+        size_t slot = PFX##_impl_find(_cache_, key, _cache_->hash(key));                      \
+                                                                                              \
+        if (slot == CMC_LRUCACHE_NONE)                                                        \
+            return false;                                                                     \
+                                                                                              \
+        if (out_value)                                                                        \
+            *out_value = _cache_->buffer[slot].value;                                         \
+                                                                                              \
+        PFX##_impl_remove_slot(_cache_, slot);                                                \
+                                                                                              \
+        return true;                                                                          \
+    }                                                                                         \
+                                                                                              \
+    /* Marks the key as the most recently used */                                             \
+    V PFX##_get(struct SNAME *_cache_, K key)                                                 \
+    {                                                                                         \
+        V *value = PFX##_get_ref(_cache_, key);                                               \
+                                                                                              \
+        if (!value)                                                                           \
+            return (V){ 0 };                                                                  \
+                                                                                              \
+        return *value;                                                                        \
+    }                                                                                         \
+                                                                                              \
+    /* Marks the key as the most recently used. The reference is valid until */               \
+    /* the next put or remove */                                                              \
+    V *PFX##_get_ref(struct SNAME *_cache_, K key)                                            \
+    {                                                                                         \
+        size_t slot = PFX##_impl_find(_cache_, key, _cache_->hash(key));                      \
+                                                                                              \
+        if (slot == CMC_LRUCACHE_NONE)                                                        \
+            return NULL;                                                                      \
+                                                                                              \
+        PFX##_impl_promote(_cache_, slot);                                                    \
+                                                                                              \
+        return &(_cache_->buffer[slot].value);                                                \
+    }                                                                                         \
+                                                                                              \
+    /* Like get_ref but without changing the recency order */                                 \
+    V *PFX##_peek(struct SNAME *_cache_, K key)                                               \
+    {                                                                                         \
+        size_t slot = PFX##_impl_find(_cache_, key, _cache_->hash(key));                      \
+                                                                                              \
+        if (slot == CMC_LRUCACHE_NONE)                                                        \
+            return NULL;                                                                      \
+                                                                                              \
+        return &(_cache_->buffer[slot].value);                                                \
+    }                                                                                         \
+                                                                                              \
+    /* The most recently used entry */                                                        \
+    bool PFX##_newest(struct SNAME *_cache_, K *key, V *value)                                \
+    {                                                                                         \
+        if (PFX##_empty(_cache_))                                                             \
+            return false;                                                                     \
+                                                                                              \
+        struct SNAME##_entry *entry = &(_cache_->buffer[_cache_->head]);                      \
+                                                                                              \
+        if (key)                                                                              \
+            *key = entry->key;                                                                \
+        if (value)                                                                            \
+            *value = entry->value;                                                            \
+                                                                                              \
+        return true;                                                                          \
+    }                                                                                         \
+                                                                                              \
+    /* The least recently used entry, the next one to be evicted */                           \
+    bool PFX##_oldest(struct SNAME *_cache_, K *key, V *value)                                \
+    {                                                                                         \
+        if (PFX##_empty(_cache_))                                                             \
+            return false;                                                                     \
+                                                                                              \
+        struct SNAME##_entry *entry = &(_cache_->buffer[_cache_->tail]);                      \
+                                                                                              \
+        if (key)                                                                              \
+            *key = entry->key;                                                                \
+        if (value)                                                                            \
+            *value = entry->value;                                                            \
+                                                                                              \
+        return true;                                                                          \
+    }                                                                                         \
+                                                                                              \
+    /* Doesn't change the recency order */                                                    \
+    bool PFX##_contains(struct SNAME *_cache_, K key)                                         \
+    {                                                                                         \
+        return PFX##_impl_find(_cache_, key, _cache_->hash(key)) != CMC_LRUCACHE_NONE;        \
+    }                                                                                         \
+                                                                                              \
+    bool PFX##_empty(struct SNAME *_cache_)                                                   \
+    {                                                                                         \
+        return _cache_->count == 0;                                                           \
+    }                                                                                         \
+                                                                                              \
+    bool PFX##_full(struct SNAME *_cache_)                                                    \
+    {                                                                                         \
+        return _cache_->count >= _cache_->limit;                                              \
+    }                                                                                         \
+                                                                                              \
+    size_t PFX##_count(struct SNAME *_cache_)                                                 \
+    {                                                                                         \
+        return _cache_->count;                                                                \
+    }                                                                                         \
+                                                                                              \
+    size_t PFX##_memory_usage(struct SNAME *_cache_)                                          \
+    {                                                                                         \
+        return sizeof(struct SNAME) + sizeof(struct SNAME##_entry) * _cache_->capacity;       \
+    }                                                                                         \
+                                                                                              \
+    size_t PFX##_limit(struct SNAME *_cache_)                                                 \
+    {                                                                                         \
+        return _cache_->limit;                                                                \
+    }                                                                                         \
+                                                                                              \
+    size_t PFX##_capacity(struct SNAME *_cache_)                                              \
+    {                                                                                         \
+        return _cache_->capacity;                                                             \
+    }                                                                                         \
+                                                                                              \
+    void PFX##_stats(struct SNAME *_cache_, struct cmc_hashtable_stats *out)                  \
+    {                                                                                         \
+        memset(out, 0, sizeof(struct cmc_hashtable_stats));                                   \
+                                                                                              \
+        out->capacity = _cache_->capacity;                                                    \
+        out->count = _cache_->count;                                                          \
+        out->bytes = sizeof(struct SNAME) + sizeof(struct SNAME##_entry) * _cache_->capacity; \
+                                                                                              \
+        for (size_t i = 0; i < _cache_->capacity; i++)                                        \
+        {                                                                                     \
+            if (_cache_->buffer[i].filled)                                                    \
+                cmc_hashtable_stats_add(out, _cache_->buffer[i].dist);                        \
+        }                                                                                     \
+                                                                                              \
+        CMC_IMPL_HASHTABLE_PROBE_ADD(out, _cache_);                                           \
+                                                                                              \
+        cmc_hashtable_stats_end(out);                                                         \
+    }                                                                                         \
+                                                                                              \
+    struct cmc_string PFX##_to_string(struct SNAME *_cache_)                                  \
+    {                                                                                         \
+        struct cmc_string str;                                                                \
+        struct SNAME *c_ = _cache_;                                                           \
+        const char *name = #SNAME;                                                            \
+                                                                                              \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_lrucache, name, c_, c_->buffer,        \
+                 c_->capacity, c_->count, c_->limit, c_->head, c_->tail, c_->cmp, c_->hash,   \
+                 c_->evict);                                                                  \
+                                                                                              \
+        return str;                                                                           \
+    }                                                                                         \
+                                                                                              \
+    /* Slot of a key or CMC_LRUCACHE_NONE */                                                  \
+    static size_t PFX##_impl_find(struct SNAME *_cache_, K key, size_t hash)                  \
+    {                                                                                         \
+        size_t pos = hash % _cache_->capacity;                                                \
+                                                                                              \
+        CMC_IMPL_HASHTABLE_PROBE_LOOKUP(_cache_);                                             \
+                                                                                              \
+        while (_cache_->buffer[pos].filled)                                                   \
+        {                                                                                     \
+            CMC_IMPL_HASHTABLE_PROBE_SLOT(_cache_);                                           \
+                                                                                              \
+            if (_cache_->cmp(_cache_->buffer[pos].key, key) == 0)                             \
+                return pos;                                                                   \
+                                                                                              \
+            pos = (pos + 1) % _cache_->capacity;                                              \
+        }                                                                                     \
+                                                                                              \
+        return CMC_LRUCACHE_NONE;                                                             \
+    }                                                                                         \
+                                                                                              \
+    /* Puts a key that is not in the table at the first empty slot from its */                \
+    /* original position, as the most recently used */                                        \
+    static size_t PFX##_impl_insert(struct SNAME *_cache_, K key, V value, size_t hash)       \
+    {                                                                                         \
+        size_t pos = hash % _cache_->capacity;                                                \
+        size_t dist = 0;                                                                      \
+                                                                                              \
+        while (_cache_->buffer[pos].filled)                                                   \
+        {                                                                                     \
+            pos = (pos + 1) % _cache_->capacity;                                              \
+            dist++;                                                                           \
+        }                                                                                     \
+                                                                                              \
+        struct SNAME##_entry *entry = &(_cache_->buffer[pos]);                                \
+                                                                                              \
+        entry->key = key;                                                                     \
+        entry->value = value;                                                                 \
+        entry->dist = dist;                                                                   \
+        entry->filled = true;                                                                 \
+                                                                                              \
+        PFX##_impl_link_front(_cache_, pos);                                                  \
+                                                                                              \
+        _cache_->count++;                                                                     \
+                                                                                              \
+        return pos;                                                                           \
+    }                                                                                         \
+                                                                                              \
+    /* Takes the entry at slot out of the table and of the recency list. The */               \
+    /* following entries of its cluster whose original position is at or */                   \
+    /* before the empty slot are moved back into it, which leaves another */                  \
+    /* slot empty, until the end of the cluster */                                            \
+    static void PFX##_impl_remove_slot(struct SNAME *_cache_, size_t slot)                    \
+    {                                                                                         \
+        PFX##_impl_unlink(_cache_, slot);                                                     \
+                                                                                              \
+        _cache_->buffer[slot].filled = false;                                                 \
+        _cache_->count--;                                                                     \
+                                                                                              \
+        size_t empty = slot;                                                                  \
+        size_t next = (slot + 1) % _cache_->capacity;                                         \
+                                                                                              \
+        while (_cache_->buffer[next].filled)                                                  \
+        {                                                                                     \
+            size_t gap = (next + _cache_->capacity - empty) % _cache_->capacity;              \
+                                                                                              \
+            if (_cache_->buffer[next].dist >= gap)                                            \
+            {                                                                                 \
+                PFX##_impl_move(_cache_, next, empty);                                        \
+                                                                                              \
+                empty = next;                                                                 \
+            }                                                                                 \
+                                                                                              \
+            next = (next + 1) % _cache_->capacity;                                            \
+        }                                                                                     \
+    }                                                                                         \
+                                                                                              \
+    /* Moves the entry at from to an empty slot before it and relinks its */                  \
+    /* neighbors in the recency list */                                                       \
+    static void PFX##_impl_move(struct SNAME *_cache_, size_t from, size_t to)                \
+    {                                                                                         \
+        struct SNAME##_entry *entry = &(_cache_->buffer[to]);                                 \
+                                                                                              \
+        *entry = _cache_->buffer[from];                                                       \
+        entry->dist -= (from + _cache_->capacity - to) % _cache_->capacity;                   \
+                                                                                              \
+        _cache_->buffer[from].filled = false;                                                 \
+                                                                                              \
+        if (entry->prev != CMC_LRUCACHE_NONE)                                                 \
+            _cache_->buffer[entry->prev].next = to;                                           \
+        else                                                                                  \
+            _cache_->head = to;                                                               \
+                                                                                              \
+        if (entry->next != CMC_LRUCACHE_NONE)                                                 \
+            _cache_->buffer[entry->next].prev = to;                                           \
+        else                                                                                  \
+            _cache_->tail = to;                                                               \
+    }                                                                                         \
+                                                                                              \
+    static void PFX##_impl_link_front(struct SNAME *_cache_, size_t slot)                     \
+    {                                                                                         \
+        struct SNAME##_entry *entry = &(_cache_->buffer[slot]);                               \
+                                                                                              \
+        entry->prev = CMC_LRUCACHE_NONE;                                                      \
+        entry->next = _cache_->head;                                                          \
+                                                                                              \
+        if (_cache_->head != CMC_LRUCACHE_NONE)                                               \
+            _cache_->buffer[_cache_->head].prev = slot;                                       \
+        else                                                                                  \
+            _cache_->tail = slot;                                                             \
+                                                                                              \
+        _cache_->head = slot;                                                                 \
+    }                                                                                         \
+                                                                                              \
+    static void PFX##_impl_unlink(struct SNAME *_cache_, size_t slot)                         \
+    {                                                                                         \
+        struct SNAME##_entry *entry = &(_cache_->buffer[slot]);                               \
+                                                                                              \
+        if (entry->prev != CMC_LRUCACHE_NONE)                                                 \
+            _cache_->buffer[entry->prev].next = entry->next;                                  \
+        else                                                                                  \
+            _cache_->head = entry->next;                                                      \
+                                                                                              \
+        if (entry->next != CMC_LRUCACHE_NONE)                                                 \
+            _cache_->buffer[entry->next].prev = entry->prev;                                  \
+        else                                                                                  \
+            _cache_->tail = entry->prev;                                                      \
+    }                                                                                         \
+                                                                                              \
+    static void PFX##_impl_promote(struct SNAME *_cache_, size_t slot)                        \
+    {                                                                                         \
+        if (_cache_->head == slot)                                                            \
+            return;                                                                           \
+                                                                                              \
+        PFX##_impl_unlink(_cache_, slot);                                                     \
+        PFX##_impl_link_front(_cache_, slot);                                                 \
+    }
+
+#endif /* CMC_LRUCACHE_H */
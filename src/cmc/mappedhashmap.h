@@ -0,0 +1,596 @@
+/**
+ * mappedhashmap.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * MappedHashMap
+ *
+ * A MappedHashMap is a HashMap whose buffer of entries lives in a file mapped
+ * into memory. A table filled once can be reopened by another process in
+ * constant time: PFX##_open maps the file and its pages are only read from
+ * disk the first time they are accessed.
+ *
+ * The file starts with a header holding the capacity, count, load factor and
+ * a seed, followed by the entries laid out exactly like the ones of a
+ * HashMap. The map itself never seeds hashes, the seed is only stored for
+ * the hash function of the caller so that it can be the same across runs.
+ *
+ * Keys and values are written to the file as they are, so K and V must not
+ * contain pointers. A file can only be opened by a MappedHashMap generated
+ * with the same K and V and by the same compiler. Growing the table builds
+ * a bigger one in a new file next to the previous one and renames it over,
+ * pointers returned by get_ref are invalidated by it. Requires POSIX.
+ */
+
+#ifndef CMC_MAPPEDHASHMAP_H
+#define CMC_MAPPEDHASHMAP_H
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+#include "hashmap.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_mappedhashmap = "%s at %p { buffer:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", load:%lf, path:%s, cmp:%p, hash:%p }";
+
+/* Appended to the path of the file to name the one that replaces it when */
+/* the table grows */
+#ifndef CMC_MAPPED_HASHMAP_SUFFIX
+#define CMC_MAPPED_HASHMAP_SUFFIX ".grow"
+#endif
+
+#ifndef CMC_IMPL_MAPPED_HASHMAP_FILE
+#define CMC_IMPL_MAPPED_HASHMAP_FILE
+
+/* First bytes of every file, the last one is the version of the layout */
+static const char cmc_mapped_hashmap_magic[8] = {'C', 'M', 'C', 'M', 'H', 'M', 'A', 1};
+
+/* Header at the start of the file. The entries follow it at an offset of */
+/* CMC_MAPPED_HASHMAP_OFFSET bytes */
+struct cmc_mapped_hashmap_header
+{
+    /* Always cmc_mapped_hashmap_magic */
+    char magic[8];
+
+    /* Size of an entry, tells apart files written with other K and V */
+    uint64_t entry_size;
+
+    /* Amount of entries in the file */
+    uint64_t capacity;
+
+    /* Current amount of keys */
+    uint64_t count;
+
+    /* Load factor in range (0.0, 1.0) */
+    double load;
+
+    /* Given when the file was created and never used by the map */
+    uint64_t seed;
+};
+
+#define CMC_MAPPED_HASHMAP_OFFSET 64
+
+#endif /* CMC_IMPL_MAPPED_HASHMAP_FILE */
+
+#define CMC_GENERATE_MAPPED_HASHMAP(PFX, SNAME, K, V)    \
+    CMC_GENERATE_MAPPED_HASHMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_MAPPED_HASHMAP_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_MAPPED_HASHMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_MAPPED_HASHMAP_HEADER(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_MAPPED_HASHMAP_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_MAPPED_HASHMAP_SOURCE(PFX, SNAME, K, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_MAPPED_HASHMAP_HEADER(PFX, SNAME, K, V)                             \
+                                                                                         \
+    /* The HashMap whose buffer is the mapped file */                                    \
+    CMC_GENERATE_HASHMAP_HEADER(PFX##_table, SNAME##_table, K, V)                        \
+                                                                                         \
+    /* MappedHashMap Structure */                                                        \
+    struct SNAME                                                                         \
+    {                                                                                    \
+        /* Table of the entries in the file */                                           \
+        struct SNAME##_table table;                                                      \
+                                                                                         \
+        /* Start of the mapping, where the header of the file is */                      \
+        struct cmc_mapped_hashmap_header *header;                                        \
+                                                                                         \
+        /* Size of the mapping in bytes */                                               \
+        size_t length;                                                                   \
+                                                                                         \
+        /* Descriptor of the file */                                                     \
+        int fd;                                                                          \
+                                                                                         \
+        /* Path of the file */                                                           \
+        char *path;                                                                      \
+                                                                                         \
+        /* Custom allocation functions */                                                \
+        struct cmc_alloc_node *alloc;                                                    \
+    };                                                                                   \
+                                                                                         \
+    /* Collection Functions */                                                           \
+    /* Collection Allocation and Deallocation */                                         \
+    struct SNAME *PFX##_create(const char *path, size_t capacity, double load,           \
+                               uint64_t seed, int (*compare)(K, K), size_t (*hash)(K));  \
+    struct SNAME *PFX##_create_custom(const char *path, size_t capacity, double load,    \
+                                      uint64_t seed, int (*compare)(K, K),               \
+                                      size_t (*hash)(K), struct cmc_alloc_node *alloc);  \
+    struct SNAME *PFX##_open(const char *path, int (*compare)(K, K), size_t (*hash)(K)); \
+    struct SNAME *PFX##_open_custom(const char *path, int (*compare)(K, K),              \
+                                    size_t (*hash)(K), struct cmc_alloc_node *alloc);    \
+    bool PFX##_sync(struct SNAME *_map_);                                                \
+    void PFX##_clear(struct SNAME *_map_);                                               \
+    void PFX##_close(struct SNAME *_map_);                                               \
+    /* Collection Input and Output */                                                    \
+    bool PFX##_insert(struct SNAME *_map_, K key, V value);                              \
+    bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value);            \
+    bool PFX##_remove(struct SNAME *_map_, K key, V *out_value);                         \
+    /* Element Access */                                                                 \
+    V PFX##_get(struct SNAME *_map_, K key);                                             \
+    V *PFX##_get_ref(struct SNAME *_map_, K key);                                        \
+    /* Collection State */                                                               \
+    bool PFX##_contains(struct SNAME *_map_, K key);                                     \
+    CMC_PURE bool PFX##_empty(struct SNAME *_map_);                                      \
+    CMC_PURE size_t PFX##_count(struct SNAME *_map_);                                    \
+    size_t PFX##_memory_usage(struct SNAME *_map_);                                      \
+    size_t PFX##_capacity(struct SNAME *_map_);                                          \
+    double PFX##_load(struct SNAME *_map_);                                              \
+    uint64_t PFX##_seed(struct SNAME *_map_);                                            \
+    void PFX##_stats(struct SNAME *_map_, struct cmc_hashtable_stats *out);              \
+    /* Collection Utility */                                                             \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_);                              \
+                                                                                         \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_MAPPED_HASHMAP_SOURCE(PFX, SNAME, K, V)                                 \
+                                                                                             \
+    CMC_IMPL_HASHMAP_SOURCE(PFX##_table, SNAME##_table, K, V, PRIME, UNCACHED, FIXED,        \
+                            ALLOCATED, AOS, _map_->cmp, _map_->hash)                         \
+                                                                                             \
+    /* Implementation Detail Functions */                                                    \
+    static char *PFX##_impl_copy_path(struct SNAME *_map_, const char *path,                 \
+                                      const char *suffix);                                   \
+    static bool PFX##_impl_create_file(struct SNAME *_map_, const char *path,                \
+                                       size_t capacity, double load, uint64_t seed);         \
+    static bool PFX##_impl_map_file(struct SNAME *_map_);                                    \
+    static void PFX##_impl_attach(struct SNAME *_map_, int (*compare)(K, K),                 \
+                                  size_t (*hash)(K));                                        \
+    static void PFX##_impl_unmap(struct SNAME *_map_);                                       \
+    static bool PFX##_impl_grow(struct SNAME *_map_);                                        \
+                                                                                             \
+    /* Creates the file at path, replacing any file that was there */                        \
+    struct SNAME *PFX##_create(const char *path, size_t capacity, double load,               \
+                               uint64_t seed, int (*compare)(K, K), size_t (*hash)(K))       \
+    {                                                                                        \
+        return PFX##_create_custom(path, capacity, load, seed, compare, hash, NULL);         \
+    }                                                                                        \
+                                                                                             \
+    /* The file is mapped to memory, only the rest is allocated with alloc */                \
+    struct SNAME *PFX##_create_custom(const char *path, size_t capacity, double load,        \
+                                      uint64_t seed, int (*compare)(K, K),                   \
+                                      size_t (*hash)(K), struct cmc_alloc_node *alloc)       \
+    {                                                                                        \
+        if (!alloc)                                                                          \
+            alloc = &cmc_alloc_node_default;                                                 \
+                                                                                             \
+        if (capacity == 0 || load <= 0 || load >= 1)                                         \
+            return NULL;                                                                     \
+                                                                                             \
+        /* Prevent integer overflow */                                                       \
+        if (capacity >= UINTMAX_MAX * load)                                                  \
+            return NULL;                                                                     \
+                                                                                             \
+        struct SNAME *_map_ = alloc->malloc(sizeof(struct SNAME));                           \
+                                                                                             \
+        if (CMC_UNLIKELY(!_map_))                                                            \
+            return NULL;                                                                     \
+                                                                                             \
+        _map_->alloc = alloc;                                                                \
+        _map_->path = PFX##_impl_copy_path(_map_, path, "");                                 \
+                                                                                             \
+        if (!_map_->path)                                                                    \
+        {                                                                                    \
+            alloc->free(_map_);                                                              \
+            return NULL;                                                                     \
+        }                                                                                    \
+                                                                                             \
+        size_t real_capacity = cmc_hashtable_prime_size(capacity / load);                    \
+                                                                                             \
+        if (!PFX##_impl_create_file(_map_, path, real_capacity, load, seed))                 \
+        {                                                                                    \
+            alloc->free(_map_->path);                                                        \
+            alloc->free(_map_);                                                              \
+            return NULL;                                                                     \
+        }                                                                                    \
+                                                                                             \
+        PFX##_impl_attach(_map_, compare, hash);                                             \
+                                                                                             \
+        return _map_;                                                                        \
+    }                                                                                        \
+                                                                                             \
+    /* Returns NULL if the file does not exist or was not written by a */                    \
+    /* MappedHashMap of the same K and V */                                                  \
+    struct SNAME *PFX##_open(const char *path, int (*compare)(K, K), size_t (*hash)(K))      \
+    {                                                                                        \
+        return PFX##_open_custom(path, compare, hash, NULL);                                 \
+    }                                                                                        \
+                                                                                             \
+    struct SNAME *PFX##_open_custom(const char *path, int (*compare)(K, K),                  \
+                                    size_t (*hash)(K), struct cmc_alloc_node *alloc)         \
+    {                                                                                        \
+        if (!alloc)                                                                          \
+            alloc = &cmc_alloc_node_default;                                                 \
+                                                                                             \
+        struct SNAME *_map_ = alloc->malloc(sizeof(struct SNAME));                           \
+                                                                                             \
+        if (CMC_UNLIKELY(!_map_))                                                            \
+            return NULL;                                                                     \
+                                                                                             \
+        _map_->alloc = alloc;                                                                \
+        _map_->path = PFX##_impl_copy_path(_map_, path, "");                                 \
+                                                                                             \
+        if (!_map_->path)                                                                    \
+        {                                                                                    \
+            alloc->free(_map_);                                                              \
+            return NULL;                                                                     \
+        }                                                                                    \
+                                                                                             \
+        _map_->fd = open(path, O_RDWR);                                                      \
+                                                                                             \
+        if (_map_->fd < 0)                                                                   \
+        {                                                                                    \
+            alloc->free(_map_->path);                                                        \
+            alloc->free(_map_);                                                              \
+            return NULL;                                                                     \
+        }                                                                                    \
+                                                                                             \
+        if (!PFX##_impl_map_file(_map_))                                                     \
+        {                                                                                    \
+            close(_map_->fd);                                                                \
+            alloc->free(_map_->path);                                                        \
+            alloc->free(_map_);                                                              \
+            return NULL;                                                                     \
+        }                                                                                    \
+                                                                                             \
+        PFX##_impl_attach(_map_, compare, hash);                                             \
+                                                                                             \
+        return _map_;                                                                        \
+    }                                                                                        \
+                                                                                             \
+    /* Changes reach the file even without calling this function, as long */                 \
+    /* as the system does not crash. Blocks until they are written to disk */                \
+    bool PFX##_sync(struct SNAME *_map_)                                                     \
+    {                                                                                        \
+        return msync(_map_->header, _map_->length, MS_SYNC) == 0;                            \
+    }                                                                                        \
+                                                                                             \
+    void PFX##_clear(struct SNAME *_map_)                                                    \
+    {                                                                                        \
+        PFX##_table_clear(&(_map_->table), NULL);                                            \
+                                                                                             \
+        _map_->header->count = 0;                                                            \
+    }                                                                                        \
+                                                                                             \
+    /* The file is kept, it can be opened again with PFX##_open */                           \
+    void PFX##_close(struct SNAME *_map_)                                                    \
+    {                                                                                        \
+        PFX##_impl_unmap(_map_);                                                             \
+                                                                                             \
+        _map_->alloc->free(_map_->path);                                                     \
+        _map_->alloc->free(_map_);                                                           \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_insert(struct SNAME *_map_, K key, V value)                                   \
+    {                                                                                        \
+        if (PFX##_table_full(&(_map_->table)))                                               \
+        {                                                                                    \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_map_)))                                       \
+                return false;                                                                \
+        }                                                                                    \
+                                                                                             \
+        if (!PFX##_table_insert(&(_map_->table), key, value))                                \
+            return false;                                                                    \
+                                                                                             \
+        _map_->header->count = _map_->table.count;                                           \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value)                 \
+    {                                                                                        \
+        return PFX##_table_update(&(_map_->table), key, new_value, old_value);               \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_remove(struct SNAME *_map_, K key, V *out_value)                              \
+    {                                                                                        \
+        if (!PFX##_table_remove(&(_map_->table), key, out_value))                            \
+            return false;                                                                    \
+                                                                                             \
+        _map_->header->count = _map_->table.count;                                           \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    V PFX##_get(struct SNAME *_map_, K key)                                                  \
+    {                                                                                        \
+        return PFX##_table_get(&(_map_->table), key);                                        \
+    }                                                                                        \
+                                                                                             \
+    V *PFX##_get_ref(struct SNAME *_map_, K key)                                             \
+    {                                                                                        \
+        return PFX##_table_get_ref(&(_map_->table), key);                                    \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_contains(struct SNAME *_map_, K key)                                          \
+    {                                                                                        \
+        return PFX##_table_contains(&(_map_->table), key);                                   \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_empty(struct SNAME *_map_)                                                    \
+    {                                                                                        \
+        return PFX##_table_empty(&(_map_->table));                                           \
+    }                                                                                        \
+                                                                                             \
+    size_t PFX##_count(struct SNAME *_map_)                                                  \
+    {                                                                                        \
+        return PFX##_table_count(&(_map_->table));                                           \
+    }                                                                                        \
+                                                                                             \
+    size_t PFX##_memory_usage(struct SNAME *_map_)                                           \
+    {                                                                                        \
+        /* The mapping is counted too, though it is not allocated by alloc */                \
+        return sizeof(struct SNAME) + strlen(_map_->path) + 1 + _map_->length;               \
+    }                                                                                        \
+                                                                                             \
+    size_t PFX##_capacity(struct SNAME *_map_)                                               \
+    {                                                                                        \
+        return PFX##_table_capacity(&(_map_->table));                                        \
+    }                                                                                        \
+                                                                                             \
+    double PFX##_load(struct SNAME *_map_)                                                   \
+    {                                                                                        \
+        return PFX##_table_load(&(_map_->table));                                            \
+    }                                                                                        \
+                                                                                             \
+    uint64_t PFX##_seed(struct SNAME *_map_)                                                 \
+    {                                                                                        \
+        return _map_->header->seed;                                                          \
+    }                                                                                        \
+                                                                                             \
+    void PFX##_stats(struct SNAME *_map_, struct cmc_hashtable_stats *out)                   \
+    {                                                                                        \
+        PFX##_table_stats(&(_map_->table), out);                                             \
+                                                                                             \
+        /* The table is part of the map and the file also holds the header */                \
+        out->bytes += sizeof(struct SNAME) - sizeof(struct SNAME##_table) +                  \
+                      CMC_MAPPED_HASHMAP_OFFSET;                                             \
+    }                                                                                        \
+                                                                                             \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_)                                   \
+    {                                                                                        \
+        struct cmc_string str;                                                               \
+        struct SNAME *m_ = _map_;                                                            \
+        const char *name = #SNAME;                                                           \
+                                                                                             \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_mappedhashmap,                        \
+                 name, m_, m_->table.buffer, m_->table.capacity, m_->table.count,            \
+                 m_->table.load, m_->path, m_->table.cmp, m_->table.hash);                   \
+                                                                                             \
+        return str;                                                                          \
+    }                                                                                        \
+                                                                                             \
+    static char *PFX##_impl_copy_path(struct SNAME *_map_, const char *path,                 \
+                                      const char *suffix)                                    \
+    {                                                                                        \
+        size_t length = strlen(path);                                                        \
+        size_t suffix_length = strlen(suffix);                                               \
+                                                                                             \
+        char *result = _map_->alloc->malloc(length + suffix_length + 1);                     \
+                                                                                             \
+        if (CMC_UNLIKELY(!result))                                                           \
+            return NULL;                                                                     \
+                                                                                             \
+        memcpy(result, path, length);                                                        \
+        memcpy(result + length, suffix, suffix_length + 1);                                  \
+                                                                                             \
+        return result;                                                                       \
+    }                                                                                        \
+                                                                                             \
+    /* Creates a file with an empty table of capacity entries and maps it */                 \
+    static bool PFX##_impl_create_file(struct SNAME *_map_, const char *path,                \
+                                       size_t capacity, double load, uint64_t seed)          \
+    {                                                                                        \
+        size_t entry_size = sizeof(struct SNAME##_table_entry);                              \
+                                                                                             \
+        /* Prevent integer overflow */                                                       \
+        if (capacity > (SIZE_MAX - CMC_MAPPED_HASHMAP_OFFSET) / entry_size)                  \
+            return false;                                                                    \
+                                                                                             \
+        size_t length = CMC_MAPPED_HASHMAP_OFFSET + capacity * entry_size;                   \
+                                                                                             \
+        int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);                               \
+                                                                                             \
+        if (fd < 0)                                                                          \
+            return false;                                                                    \
+                                                                                             \
+        /* Writing the last byte sizes the file without writing the rest of */               \
+        /* it, which reads as zeros. A zeroed entry is an empty one */                       \
+        if (lseek(fd, (off_t)(length - 1), SEEK_SET) < 0 || write(fd, "", 1) != 1)           \
+        {                                                                                    \
+            close(fd);                                                                       \
+            remove(path);                                                                    \
+            return false;                                                                    \
+        }                                                                                    \
+                                                                                             \
+        void *mapping = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);       \
+                                                                                             \
+        if (mapping == MAP_FAILED)                                                           \
+        {                                                                                    \
+            close(fd);                                                                       \
+            remove(path);                                                                    \
+            return false;                                                                    \
+        }                                                                                    \
+                                                                                             \
+        struct cmc_mapped_hashmap_header *header = mapping;                                  \
+                                                                                             \
+        memcpy(header->magic, cmc_mapped_hashmap_magic, sizeof(header->magic));              \
+        header->entry_size = entry_size;                                                     \
+        header->capacity = capacity;                                                         \
+        header->count = 0;                                                                   \
+        header->load = load;                                                                 \
+        header->seed = seed;                                                                 \
+                                                                                             \
+        _map_->header = header;                                                              \
+        _map_->length = length;                                                              \
+        _map_->fd = fd;                                                                      \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* Maps an opened file after checking that its header matches its size */                \
+    static bool PFX##_impl_map_file(struct SNAME *_map_)                                     \
+    {                                                                                        \
+        struct stat info;                                                                    \
+                                                                                             \
+        if (fstat(_map_->fd, &info) != 0 || info.st_size < CMC_MAPPED_HASHMAP_OFFSET)        \
+            return false;                                                                    \
+                                                                                             \
+        size_t length = (size_t)info.st_size;                                                \
+                                                                                             \
+        void *mapping =                                                                      \
+            mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, _map_->fd, 0);            \
+                                                                                             \
+        if (mapping == MAP_FAILED)                                                           \
+            return false;                                                                    \
+                                                                                             \
+        struct cmc_mapped_hashmap_header *header = mapping;                                  \
+        size_t entry_size = sizeof(struct SNAME##_table_entry);                              \
+                                                                                             \
+        if (memcmp(header->magic, cmc_mapped_hashmap_magic, sizeof(header->magic)) != 0 ||   \
+            header->entry_size != entry_size || header->capacity == 0 ||                     \
+            header->capacity > (length - CMC_MAPPED_HASHMAP_OFFSET) / entry_size ||          \
+            length != CMC_MAPPED_HASHMAP_OFFSET + header->capacity * entry_size ||           \
+            header->count > header->capacity || header->load <= 0 || header->load >= 1)      \
+        {                                                                                    \
+            munmap(mapping, length);                                                         \
+            return false;                                                                    \
+        }                                                                                    \
+                                                                                             \
+        _map_->header = header;                                                              \
+        _map_->length = length;                                                              \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* Points the table at the entries of the mapping */                                     \
+    static void PFX##_impl_attach(struct SNAME *_map_, int (*compare)(K, K),                 \
+                                  size_t (*hash)(K))                                         \
+    {                                                                                        \
+        struct SNAME##_table *table = &(_map_->table);                                       \
+                                                                                             \
+        table->alloc = _map_->alloc;                                                         \
+        table->buffer = (struct SNAME##_table_entry *)((char *)_map_->header +               \
+                                                       CMC_MAPPED_HASHMAP_OFFSET);           \
+        table->capacity = _map_->header->capacity;                                           \
+        table->fastmod = cmc_fastmod_new(table->capacity);                                   \
+        table->count = _map_->header->count;                                                 \
+        table->load = _map_->header->load;                                                   \
+        table->cmp = compare;                                                                \
+        table->hash = hash;                                                                  \
+        table->old = NULL;                                                                   \
+        table->migrated = 0;                                                                 \
+                                                                                             \
+        CMC_IMPL_HASHTABLE_PROBE_RESET(table);                                               \
+                                                                                             \
+        /* The bitmap is not part of the file so it is built again */                        \
+        CMC_IMPL_HASHTABLE_OCCUPANCY_NEW(table);                                             \
+        PFX##_table_impl_occupancy_fill(table);                                              \
+                                                                                             \
+        table->it_start = PFX##_table_impl_it_start;                                         \
+        table->it_end = PFX##_table_impl_it_end;                                             \
+    }                                                                                        \
+                                                                                             \
+    static void PFX##_impl_unmap(struct SNAME *_map_)                                        \
+    {                                                                                        \
+        CMC_IMPL_HASHTABLE_OCCUPANCY_FREE(&(_map_->table));                                  \
+                                                                                             \
+        munmap(_map_->header, _map_->length);                                                \
+        close(_map_->fd);                                                                    \
+    }                                                                                        \
+                                                                                             \
+    /* Builds the bigger table in a new file and renames it over the current */              \
+    /* one, so that the previous file is intact if anything fails halfway */                 \
+    static bool PFX##_impl_grow(struct SNAME *_map_)                                         \
+    {                                                                                        \
+        double load = PFX##_load(_map_);                                                     \
+        size_t capacity = PFX##_capacity(_map_) + 1;                                         \
+                                                                                             \
+        /* Prevent integer overflow */                                                       \
+        if (capacity >= UINTMAX_MAX * load)                                                  \
+            return false;                                                                    \
+                                                                                             \
+        char *path = PFX##_impl_copy_path(_map_, _map_->path, CMC_MAPPED_HASHMAP_SUFFIX);    \
+                                                                                             \
+        if (!path)                                                                           \
+            return false;                                                                    \
+                                                                                             \
+        struct SNAME grown = *_map_;                                                         \
+                                                                                             \
+        size_t real_capacity = cmc_hashtable_prime_size(capacity / load);                    \
+                                                                                             \
+        if (!PFX##_impl_create_file(&grown, path, real_capacity, load, _map_->header->seed)) \
+        {                                                                                    \
+            _map_->alloc->free(path);                                                        \
+            return false;                                                                    \
+        }                                                                                    \
+                                                                                             \
+        PFX##_impl_attach(&grown, _map_->table.cmp, _map_->table.hash);                      \
+                                                                                             \
+        bool success = true;                                                                 \
+                                                                                             \
+        for (size_t i = 0; success && i < _map_->table.capacity; i++)                        \
+        {                                                                                    \
+            struct SNAME##_table_entry *entry = &(_map_->table.buffer[i]);                   \
+                                                                                             \
+            if (entry->state == CMC_ES_FILLED)                                               \
+                success = PFX##_table_insert(&(grown.table), entry->key, entry->value);      \
+        }                                                                                    \
+                                                                                             \
+        grown.header->count = grown.table.count;                                             \
+                                                                                             \
+        /* The new file must be complete on disk before it replaces the old */               \
+        if (!success || !PFX##_sync(&grown) || rename(path, _map_->path) != 0)               \
+        {                                                                                    \
+            PFX##_impl_unmap(&grown);                                                        \
+            remove(path);                                                                    \
+            _map_->alloc->free(path);                                                        \
+            return false;                                                                    \
+        }                                                                                    \
+                                                                                             \
+        _map_->alloc->free(path);                                                            \
+                                                                                             \
+        PFX##_impl_unmap(_map_);                                                             \
+                                                                                             \
+        *_map_ = grown;                                                                      \
+                                                                                             \
+        return true;                                                                         \
+    }
+
+#endif /* CMC_MAPPEDHASHMAP_H */
@@ -0,0 +1,608 @@
+/**
+ * mappedsortedmap.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * MappedSortedMap and MappedSortedSet
+ *
+ * Read-only views of a file written by the save_flat method of a TreeMap, a
+ * TreeSet or a SortedList. The file is mapped into memory and searched where
+ * it is, so opening it takes constant time no matter how many keys it has and
+ * its pages are only read from disk the first time they are accessed.
+ *
+ * The file has the keys in order in a single array, followed by their values
+ * in another one, and optionally a sparse index with every step-th key. A
+ * lookup first does a binary search over the index, that is small enough to
+ * stay in cache, and then over the step keys that follow the indexed key
+ * found, so it touches about log2(step) pages of the array of keys instead of
+ * log2(count) of them. A MappedSortedMap opens files written by a TreeMap and
+ * a MappedSortedSet the ones written by a TreeSet or a SortedList.
+ *
+ * Keys and values are written to the file as they are, so K and V must not
+ * contain pointers and a file can only be opened by a view generated with the
+ * same K and V, by the same compiler. The file must not change while it is
+ * opened. Requires POSIX.
+ */
+
+#ifndef CMC_MAPPEDSORTEDMAP_H
+#define CMC_MAPPEDSORTEDMAP_H
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_serial.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_mappedsortedmap = "%s at %p { keys:%p, values:%p, count:%" PRIuMAX ", step:%" PRIuMAX ", cmp:%p }";
+static const char *cmc_string_fmt_mappedsortedset = "%s at %p { buffer:%p, count:%" PRIuMAX ", step:%" PRIuMAX ", cmp:%p }";
+
+#ifndef CMC_IMPL_MAPPED_SORTED_FILE
+#define CMC_IMPL_MAPPED_SORTED_FILE
+
+/* A file written by save_flat, mapped into memory */
+struct cmc_mapped_sorted_file
+{
+    /* Start of the mapping, where the header of the file is */
+    struct cmc_serial_header *header;
+
+    /* Size of the mapping in bytes */
+    size_t length;
+
+    /* Sorted keys, their values and the sparse index */
+    const void *keys;
+    const void *values;
+    const void *index;
+
+    /* Amount of keys */
+    size_t count;
+
+    /* Amount of keys in the index and the distance between them */
+    size_t indexed;
+    size_t step;
+};
+
+/* Maps the file at path and checks that it was written by save_flat with */
+/* keys and values of these sizes */
+static inline bool cmc_mapped_sorted_open(struct cmc_mapped_sorted_file *file, const char *path,
+                                          size_t key_size, size_t value_size)
+{
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(struct cmc_serial_header))
+    {
+        close(fd);
+        return false;
+    }
+
+    size_t length = (size_t)info.st_size;
+
+    /* The mapping stays valid after the descriptor is closed */
+    void *mapping = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+
+    close(fd);
+
+    if (mapping == MAP_FAILED)
+        return false;
+
+    struct cmc_serial_header *header = mapping;
+    uint32_t raw = CMC_SERIAL_RAW_KEYS | (value_size ? CMC_SERIAL_RAW_VALUES : 0);
+
+    if (memcmp(header->magic, "CMC", 4) != 0 || header->version != CMC_SERIAL_VERSION ||
+        !(header->flags & CMC_SERIAL_FLAT) || (header->flags & raw) != raw ||
+        header->key_size != key_size || header->value_size != value_size ||
+        header->count > length / (key_size + value_size))
+    {
+        munmap(mapping, length);
+        return false;
+    }
+
+    size_t count = (size_t)header->count;
+    size_t indexed = cmc_serial_flat_indexed(count, header->extra);
+    size_t keys = cmc_serial_flat_section(sizeof(struct cmc_serial_header));
+    size_t values = keys + cmc_serial_flat_section(count * key_size);
+    size_t index = values + cmc_serial_flat_section(count * value_size);
+
+    if (index > length || indexed * key_size > length - index)
+    {
+        munmap(mapping, length);
+        return false;
+    }
+
+    /* Every lookup goes through the index, so it is read ahead. glibc only */
+    /* declares posix_madvise with _POSIX_C_SOURCE or _DEFAULT_SOURCE */
+#ifdef POSIX_MADV_WILLNEED
+    if (indexed > 0)
+    {
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size_t first = index / page * page;
+
+        posix_madvise((char *)mapping + first, index - first + indexed * key_size,
+                      POSIX_MADV_WILLNEED);
+    }
+#endif
+
+    file->header = header;
+    file->length = length;
+    file->keys = (char *)mapping + keys;
+    file->values = (char *)mapping + values;
+    file->index = (char *)mapping + index;
+    file->count = count;
+    file->indexed = indexed;
+    file->step = header->extra;
+
+    return true;
+}
+
+static inline void cmc_mapped_sorted_close(struct cmc_mapped_sorted_file *file)
+{
+    munmap(file->header, file->length);
+}
+
+#endif /* CMC_IMPL_MAPPED_SORTED_FILE */
+
+#define CMC_GENERATE_MAPPED_SORTEDMAP(PFX, SNAME, K, V)    \
+    CMC_GENERATE_MAPPED_SORTEDMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_MAPPED_SORTEDMAP_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_MAPPED_SORTEDMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_MAPPED_SORTEDMAP_HEADER(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_MAPPED_SORTEDMAP_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_MAPPED_SORTEDMAP_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_GENERATE_MAPPED_SORTEDSET(PFX, SNAME, V)    \
+    CMC_GENERATE_MAPPED_SORTEDSET_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_MAPPED_SORTEDSET_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_MAPPED_SORTEDSET_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_MAPPED_SORTEDSET_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_MAPPED_SORTEDSET_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_MAPPED_SORTEDSET_SOURCE(PFX, SNAME, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_MAPPED_SORTEDMAP_HEADER(PFX, SNAME, K, V)    \
+                                                                  \
+    CMC_IMPL_MAPPED_SORTED_HEADER(PFX, SNAME, K)                  \
+                                                                  \
+    /* Element Access */                                          \
+    V PFX##_get(struct SNAME *_map_, K key);                      \
+    const V *PFX##_get_ref(struct SNAME *_map_, K key);           \
+    /* Collection Utility */                                      \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_);       \
+    bool PFX##_to_string_full(struct SNAME *_map_,                \
+                              struct cmc_string_builder *builder, \
+                              const char *elem_fmt);              \
+    bool PFX##_write(struct SNAME *_map_, FILE *file,             \
+                     void (*fmt)(FILE *, K, V));                  \
+    bool PFX##_write_fd(struct SNAME *_map_, int fd,              \
+                        void (*fmt)(struct cmc_dump *, K, V));    \
+    /* Iterator Access */                                         \
+    K PFX##_iter_key(struct SNAME##_iter *iter);                  \
+    V PFX##_iter_value(struct SNAME##_iter *iter);                \
+                                                                  \
+
+#define CMC_GENERATE_MAPPED_SORTEDSET_HEADER(PFX, SNAME, V)       \
+                                                                  \
+    CMC_IMPL_MAPPED_SORTED_HEADER(PFX, SNAME, V)                  \
+                                                                  \
+    /* Collection Utility */                                      \
+    struct cmc_string PFX##_to_string(struct SNAME *_set_);       \
+    bool PFX##_to_string_full(struct SNAME *_set_,                \
+                              struct cmc_string_builder *builder, \
+                              const char *elem_fmt);              \
+    bool PFX##_write(struct SNAME *_set_, FILE *file,             \
+                     void (*fmt)(FILE *, V));                     \
+    bool PFX##_write_fd(struct SNAME *_set_, int fd,              \
+                        void (*fmt)(struct cmc_dump *, V));       \
+    /* Iterator Access */                                         \
+    V PFX##_iter_value(struct SNAME##_iter *iter);                \
+                                                                  \
+
+/* Shared by both views, K is the type of the keys of a map or of the */
+/* elements of a set */
+#define CMC_IMPL_MAPPED_SORTED_HEADER(PFX, SNAME, K)                                         \
+                                                                                             \
+    /* MappedSorted Structure */                                                             \
+    struct SNAME                                                                             \
+    {                                                                                        \
+        /* The mapped file */                                                                \
+        struct cmc_mapped_sorted_file file;                                                  \
+                                                                                             \
+        /* Key comparison function, must be the one the file was sorted by */                \
+        int (*cmp)(K, K);                                                                    \
+                                                                                             \
+        /* Custom allocation functions */                                                    \
+        struct cmc_alloc_node *alloc;                                                        \
+    };                                                                                       \
+                                                                                             \
+    /* MappedSorted Iterator */                                                              \
+    struct SNAME##_iter                                                                      \
+    {                                                                                        \
+        /* Target view */                                                                    \
+        struct SNAME *target;                                                                \
+                                                                                             \
+        /* Position of the first key in the iteration */                                     \
+        size_t first;                                                                        \
+                                                                                             \
+        /* Amount of keys in the iteration */                                                \
+        size_t count;                                                                        \
+                                                                                             \
+        /* Keeps track of relative index to the iteration of elements */                     \
+        size_t index;                                                                        \
+                                                                                             \
+        /* If the iterator has reached the start of the iteration */                         \
+        bool start;                                                                          \
+                                                                                             \
+        /* If the iterator has reached the end of the iteration */                           \
+        bool end;                                                                            \
+    };                                                                                       \
+                                                                                             \
+    /* Collection Functions */                                                               \
+    /* Collection Allocation and Deallocation */                                             \
+    struct SNAME *PFX##_open(const char *path, int (*compare)(K, K));                        \
+    struct SNAME *PFX##_open_custom(const char *path, int (*compare)(K, K),                  \
+                                    struct cmc_alloc_node *alloc);                           \
+    void PFX##_close(struct SNAME *_view_);                                                  \
+    /* Element Access */                                                                     \
+    struct SNAME##_iter PFX##_lower_bound(struct SNAME *_view_, K key);                      \
+    struct SNAME##_iter PFX##_upper_bound(struct SNAME *_view_, K key);                      \
+    size_t PFX##_rank(struct SNAME *_view_, K key);                                          \
+    /* Collection State */                                                                   \
+    bool PFX##_contains(struct SNAME *_view_, K key);                                        \
+    CMC_PURE bool PFX##_empty(struct SNAME *_view_);                                         \
+    CMC_PURE size_t PFX##_count(struct SNAME *_view_);                                       \
+    size_t PFX##_memory_usage(struct SNAME *_view_);                                         \
+    size_t PFX##_step(struct SNAME *_view_);                                                 \
+                                                                                             \
+    /* Iterator Functions */                                                                 \
+    /* Iterator Initialization */                                                            \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);                   \
+    void PFX##_iter_init_range(struct SNAME##_iter *iter, struct SNAME *target, K lo, K hi); \
+    /* Iterator State */                                                                     \
+    bool PFX##_iter_start(struct SNAME##_iter *iter);                                        \
+    bool PFX##_iter_end(struct SNAME##_iter *iter);                                          \
+    /* Iterator Movement */                                                                  \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter);                                     \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter);                                       \
+    bool PFX##_iter_next(struct SNAME##_iter *iter);                                         \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter);                                         \
+    /* Iterator Access */                                                                    \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter);
+
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_MAPPED_SORTEDMAP_SOURCE(PFX, SNAME, K, V)                            \
+                                                                                          \
+    CMC_IMPL_MAPPED_SORTED_SOURCE(PFX, SNAME, K, sizeof(V))                               \
+                                                                                          \
+    V PFX##_get(struct SNAME *_map_, K key)                                               \
+    {                                                                                     \
+        const V *value = PFX##_get_ref(_map_, key);                                       \
+                                                                                          \
+        if (!value)                                                                       \
+            return (V){0};                                                                \
+                                                                                          \
+        return *value;                                                                    \
+    }                                                                                     \
+                                                                                          \
+    /* The value is in the mapped file, which is read-only */                             \
+    const V *PFX##_get_ref(struct SNAME *_map_, K key)                                    \
+    {                                                                                     \
+        size_t pos = PFX##_impl_search(_map_, key, false);                                \
+                                                                                          \
+        if (pos == _map_->file.count || _map_->cmp(PFX##_impl_key(_map_, pos), key) != 0) \
+            return NULL;                                                                  \
+                                                                                          \
+        return (const V *)_map_->file.values + pos;                                       \
+    }                                                                                     \
+                                                                                          \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_)                                \
+    {                                                                                     \
+        struct cmc_string str;                                                            \
+        struct SNAME *m_ = _map_;                                                         \
+        const char *name = #SNAME;                                                        \
+                                                                                          \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_mappedsortedmap, name, m_,         \
+                 m_->file.keys, m_->file.values, m_->file.count, m_->file.step, m_->cmp); \
+                                                                                          \
+        return str;                                                                       \
+    }                                                                                     \
+                                                                                          \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_ENTRY)                        \
+                                                                                          \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_ENTRY, (K, V))                       \
+                                                                                          \
+    K PFX##_iter_key(struct SNAME##_iter *iter)                                           \
+    {                                                                                     \
+        return PFX##_impl_key(iter->target, iter->first + iter->index);                   \
+    }                                                                                     \
+                                                                                          \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                         \
+    {                                                                                     \
+        return ((const V *)iter->target->file.values)[iter->first + iter->index];         \
+    }
+
+#define CMC_GENERATE_MAPPED_SORTEDSET_SOURCE(PFX, SNAME, V)                       \
+                                                                                  \
+    CMC_IMPL_MAPPED_SORTED_SOURCE(PFX, SNAME, V, 0)                               \
+                                                                                  \
+    struct cmc_string PFX##_to_string(struct SNAME *_set_)                        \
+    {                                                                             \
+        struct cmc_string str;                                                    \
+        struct SNAME *s_ = _set_;                                                 \
+        const char *name = #SNAME;                                                \
+                                                                                  \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_mappedsortedset, name, s_, \
+                 s_->file.keys, s_->file.count, s_->file.step, s_->cmp);          \
+                                                                                  \
+        return str;                                                               \
+    }                                                                             \
+                                                                                  \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE)                \
+                                                                                  \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE, (V))                  \
+                                                                                  \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                 \
+    {                                                                             \
+        return PFX##_impl_key(iter->target, iter->first + iter->index);           \
+    }
+
+#define CMC_IMPL_MAPPED_SORTED_SOURCE(PFX, SNAME, K, VALUE_SIZE)                               \
+                                                                                               \
+    /* Implementation Detail Functions */                                                      \
+    static inline K PFX##_impl_key(struct SNAME *_view_, size_t pos);                          \
+    static size_t PFX##_impl_bisect(struct SNAME *_view_, const K *keys, size_t lo,            \
+                                    size_t hi, K key, bool upper);                             \
+    static size_t PFX##_impl_search(struct SNAME *_view_, K key, bool upper);                  \
+    static struct SNAME##_iter PFX##_impl_iter_range(struct SNAME *_view_, size_t first,       \
+                                                     size_t last);                             \
+                                                                                               \
+    struct SNAME *PFX##_open(const char *path, int (*compare)(K, K))                           \
+    {                                                                                          \
+        return PFX##_open_custom(path, compare, NULL);                                         \
+    }                                                                                          \
+                                                                                               \
+    /* The file is mapped to memory, only the view is allocated with alloc */                  \
+    struct SNAME *PFX##_open_custom(const char *path, int (*compare)(K, K),                    \
+                                    struct cmc_alloc_node *alloc)                              \
+    {                                                                                          \
+        if (!alloc)                                                                            \
+            alloc = &cmc_alloc_node_default;                                                   \
+                                                                                               \
+        struct SNAME *_view_ = alloc->malloc(sizeof(struct SNAME));                            \
+                                                                                               \
+        if (CMC_UNLIKELY(!_view_))                                                             \
+            return NULL;                                                                       \
+                                                                                               \
+        if (!cmc_mapped_sorted_open(&_view_->file, path, sizeof(K), VALUE_SIZE))               \
+        {                                                                                      \
+            alloc->free(_view_);                                                               \
+            return NULL;                                                                       \
+        }                                                                                      \
+                                                                                               \
+        _view_->cmp = compare;                                                                 \
+        _view_->alloc = alloc;                                                                 \
+                                                                                               \
+        return _view_;                                                                         \
+    }                                                                                          \
+                                                                                               \
+    void PFX##_close(struct SNAME *_view_)                                                     \
+    {                                                                                          \
+        cmc_mapped_sorted_close(&_view_->file);                                                \
+                                                                                               \
+        _view_->alloc->free(_view_);                                                           \
+    }                                                                                          \
+                                                                                               \
+    /* Iterates from the first key that is not less than key to the end */                     \
+    struct SNAME##_iter PFX##_lower_bound(struct SNAME *_view_, K key)                         \
+    {                                                                                          \
+        return PFX##_impl_iter_range(_view_, PFX##_impl_search(_view_, key, false),            \
+                                     _view_->file.count);                                      \
+    }                                                                                          \
+                                                                                               \
+    /* Iterates from the first key that is greater than key to the end */                      \
+    struct SNAME##_iter PFX##_upper_bound(struct SNAME *_view_, K key)                         \
+    {                                                                                          \
+        return PFX##_impl_iter_range(_view_, PFX##_impl_search(_view_, key, true),             \
+                                     _view_->file.count);                                      \
+    }                                                                                          \
+                                                                                               \
+    /* Amount of keys that are less than key */                                                \
+    size_t PFX##_rank(struct SNAME *_view_, K key)                                             \
+    {                                                                                          \
+        return PFX##_impl_search(_view_, key, false);                                          \
+    }                                                                                          \
+                                                                                               \
+    bool PFX##_contains(struct SNAME *_view_, K key)                                           \
+    {                                                                                          \
+        size_t pos = PFX##_impl_search(_view_, key, false);                                    \
+                                                                                               \
+        return pos < _view_->file.count && _view_->cmp(PFX##_impl_key(_view_, pos), key) == 0; \
+    }                                                                                          \
+                                                                                               \
+    bool PFX##_empty(struct SNAME *_view_)                                                     \
+    {                                                                                          \
+        return _view_->file.count == 0;                                                        \
+    }                                                                                          \
+                                                                                               \
+    size_t PFX##_count(struct SNAME *_view_)                                                   \
+    {                                                                                          \
+        return _view_->file.count;                                                             \
+    }                                                                                          \
+                                                                                               \
+    size_t PFX##_memory_usage(struct SNAME *_view_)                                            \
+    {                                                                                          \
+        /* The mapping is counted too, though it is not allocated by alloc */                  \
+        return sizeof(struct SNAME) + _view_->file.length;                                     \
+    }                                                                                          \
+                                                                                               \
+    /* Distance between the keys of the sparse index, 0 if there is none */                    \
+    size_t PFX##_step(struct SNAME *_view_)                                                    \
+    {                                                                                          \
+        return _view_->file.step;                                                              \
+    }                                                                                          \
+                                                                                               \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                      \
+    {                                                                                          \
+        *iter = PFX##_impl_iter_range(target, 0, target->file.count);                          \
+    }                                                                                          \
+                                                                                               \
+    /* Iterates over the keys from lo, inclusive, to hi, exclusive */                          \
+    void PFX##_iter_init_range(struct SNAME##_iter *iter, struct SNAME *target, K lo, K hi)    \
+    {                                                                                          \
+        size_t first = PFX##_impl_search(target, lo, false);                                   \
+        size_t last = PFX##_impl_search(target, hi, false);                                    \
+                                                                                               \
+        *iter = PFX##_impl_iter_range(target, first, last > first ? last : first);             \
+    }                                                                                          \
+                                                                                               \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                           \
+    {                                                                                          \
+        return iter->count == 0 || iter->start;                                                \
+    }                                                                                          \
+                                                                                               \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                             \
+    {                                                                                          \
+        return iter->count == 0 || iter->end;                                                  \
+    }                                                                                          \
+                                                                                               \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                        \
+    {                                                                                          \
+        iter->index = 0;                                                                       \
+        iter->start = true;                                                                    \
+        iter->end = iter->count == 0;                                                          \
+    }                                                                                          \
+                                                                                               \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                          \
+    {                                                                                          \
+        iter->index = iter->count > 0 ? iter->count - 1 : 0;                                   \
+        iter->start = iter->count == 0;                                                        \
+        iter->end = true;                                                                      \
+    }                                                                                          \
+                                                                                               \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                            \
+    {                                                                                          \
+        if (iter->end)                                                                         \
+            return false;                                                                      \
+                                                                                               \
+        if (iter->index + 1 >= iter->count)                                                    \
+        {                                                                                      \
+            iter->end = true;                                                                  \
+            return false;                                                                      \
+        }                                                                                      \
+                                                                                               \
+        iter->start = false;                                                                   \
+        iter->index++;                                                                         \
+                                                                                               \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                            \
+    {                                                                                          \
+        if (iter->start)                                                                       \
+            return false;                                                                      \
+                                                                                               \
+        if (iter->index == 0)                                                                  \
+        {                                                                                      \
+            iter->start = true;                                                                \
+            return false;                                                                      \
+        }                                                                                      \
+                                                                                               \
+        iter->end = false;                                                                     \
+        iter->index--;                                                                         \
+                                                                                               \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                         \
+    {                                                                                          \
+        return iter->index;                                                                    \
+    }                                                                                          \
+                                                                                               \
+    static inline K PFX##_impl_key(struct SNAME *_view_, size_t pos)                           \
+    {                                                                                          \
+        return ((const K *)_view_->file.keys)[pos];                                            \
+    }                                                                                          \
+                                                                                               \
+    /* First position from lo to hi whose key is greater than key, or not */                   \
+    /* less than it if upper is false */                                                       \
+    static size_t PFX##_impl_bisect(struct SNAME *_view_, const K *keys, size_t lo,            \
+                                    size_t hi, K key, bool upper)                              \
+    {                                                                                          \
+        while (lo < hi)                                                                        \
+        {                                                                                      \
+            size_t mid = lo + (hi - lo) / 2;                                                   \
+            int c = _view_->cmp(keys[mid], key);                                               \
+                                                                                               \
+            if (c < 0 || (upper && c == 0))                                                    \
+                lo = mid + 1;                                                                  \
+            else                                                                               \
+                hi = mid;                                                                      \
+        }                                                                                      \
+                                                                                               \
+        return lo;                                                                             \
+    }                                                                                          \
+                                                                                               \
+    static size_t PFX##_impl_search(struct SNAME *_view_, K key, bool upper)                   \
+    {                                                                                          \
+        struct cmc_mapped_sorted_file *file = &_view_->file;                                   \
+        size_t lo = 0;                                                                         \
+        size_t hi = file->count;                                                               \
+                                                                                               \
+        if (file->indexed > 0)                                                                 \
+        {                                                                                      \
+            /* The key is after the last indexed key that comes before it and */               \
+            /* no further than the next indexed key */                                         \
+            size_t i = PFX##_impl_bisect(_view_, file->index, 0, file->indexed, key, upper);   \
+                                                                                               \
+            if (i == 0)                                                                        \
+                return 0;                                                                      \
+                                                                                               \
+            lo = (i - 1) * file->step + 1;                                                     \
+                                                                                               \
+            if (i < file->indexed)                                                             \
+                hi = i * file->step;                                                           \
+        }                                                                                      \
+                                                                                               \
+        return PFX##_impl_bisect(_view_, file->keys, lo, hi, key, upper);                      \
+    }                                                                                          \
+                                                                                               \
+    /* Iterates from first, inclusive, to last, exclusive */                                   \
+    static struct SNAME##_iter PFX##_impl_iter_range(struct SNAME *_view_, size_t first,       \
+                                                     size_t last)                              \
+    {                                                                                          \
+        struct SNAME##_iter iter;                                                              \
+                                                                                               \
+        iter.target = _view_;                                                                  \
+        iter.first = first;                                                                    \
+        iter.count = last - first;                                                             \
+        iter.index = 0;                                                                        \
+        iter.start = true;                                                                     \
+        iter.end = iter.count == 0;                                                            \
+                                                                                               \
+        return iter;                                                                           \
+    }
+
+#endif /* CMC_MAPPEDSORTEDMAP_H */
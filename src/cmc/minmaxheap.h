@@ -0,0 +1,936 @@
+/**
+ * minmaxheap.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * A min-max heap is a double ended priority queue with:
+ *
+ * - O(1) - Find Min
+ * - O(1) - Find Max
+ * - O(log n) - Insert
+ * - O(log n) - Remove Min
+ * - O(log n) - Remove Max
+ *
+ * It has the same functions as the IntervalHeap but keeps its elements in a
+ * flat array, like the Heap. Levels of the tree alternate between min levels,
+ * starting at the root, and max levels. An element on a min level is less
+ * than or equal to all elements below it and an element on a max level is
+ * greater than or equal to them, so the minimum is at the root and the
+ * maximum is one of its two children. Elements move between grandparents and
+ * grandchildren, skipping over a level at each step.
+ */
+
+#ifndef CMC_MINMAXHEAP_H
+#define CMC_MINMAXHEAP_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_growth.h"
+#include "../utl/cmc_math.h"
+#include "../utl/cmc_serial.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_minmaxheap = "%s at %p { buffer:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", cmp:%p }";
+
+/* A removal shrinks a collection once less than this fraction of what it */
+/* can hold without growing is in use. Define it as 0 to never shrink */
+#ifndef CMC_SHRINK_LOW_WATER
+#define CMC_SHRINK_LOW_WATER 0.25
+#endif
+
+#define CMC_GENERATE_MINMAXHEAP(PFX, SNAME, V)    \
+    CMC_GENERATE_MINMAXHEAP_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_MINMAXHEAP_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_MINMAXHEAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_MINMAXHEAP_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_MINMAXHEAP_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_MINMAXHEAP_SOURCE(PFX, SNAME, V)
+
+/* Same as CMC_GENERATE_MINMAXHEAP but elements are compared by calling CMP */
+/* directly, so the compiler can inline it. The function given to new is */
+/* still stored but only used by copy_of and to_string */
+#define CMC_GENERATE_MINMAXHEAP_EX(PFX, SNAME, V, CMP) \
+    CMC_GENERATE_MINMAXHEAP_HEADER(PFX, SNAME, V)      \
+    CMC_GENERATE_MINMAXHEAP_EX_SOURCE(PFX, SNAME, V, CMP)
+
+#define CMC_GENERATE_MINMAXHEAP_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_MINMAXHEAP_SOURCE(PFX, SNAME, V, _heap_->cmp)
+
+#define CMC_GENERATE_MINMAXHEAP_EX_SOURCE(PFX, SNAME, V, CMP) \
+    CMC_IMPL_MINMAXHEAP_SOURCE(PFX, SNAME, V, CMP)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_MINMAXHEAP_HEADER(PFX, SNAME, V)                             \
+    /* Heap Structure */                                                          \
+    struct SNAME                                                                  \
+    {                                                                             \
+        /* Dynamic array of elements */                                           \
+        V *buffer;                                                                \
+                                                                                  \
+        /* Current array capacity */                                              \
+        size_t capacity;                                                          \
+                                                                                  \
+        /* Current amount of elements in the heap */                              \
+        size_t count;                                                             \
+                                                                                  \
+        /* Element comparison function */                                         \
+        int (*cmp)(V, V);                                                         \
+                                                                                  \
+        /* Function that returns an iterator to the start of the heap */          \
+        struct SNAME##_iter (*it_start)(struct SNAME *);                          \
+                                                                                  \
+        /* Function that returns an iterator to the end of the heap */            \
+        struct SNAME##_iter (*it_end)(struct SNAME *);                            \
+                                                                                  \
+        /* Custom allocation functions */                                         \
+        struct cmc_alloc_node *alloc;                                             \
+    };                                                                            \
+                                                                                  \
+    /* Heap Iterator */                                                           \
+    struct SNAME##_iter                                                           \
+    {                                                                             \
+        /* Target heap */                                                         \
+        struct SNAME *target;                                                     \
+                                                                                  \
+        /* Cursor's position (index) */                                           \
+        size_t cursor;                                                            \
+                                                                                  \
+        /* If the iterator has reached the start of the iteration */              \
+        bool start;                                                               \
+                                                                                  \
+        /* If the iterator has reached the end of the iteration */                \
+        bool end;                                                                 \
+    };                                                                            \
+                                                                                  \
+    /* Collection Functions */                                                    \
+    /* Collection Allocation and Deallocation */                                  \
+    struct SNAME *PFX##_new(size_t capacity, int (*compare)(V, V));               \
+    struct SNAME *PFX##_new_custom(size_t capacity, int (*compare)(V, V),         \
+                                   struct cmc_alloc_node *alloc);                 \
+    struct SNAME *PFX##_new_from(V *elements, size_t n, int (*compare)(V, V));    \
+    void PFX##_clear(struct SNAME *_heap_, void (*deallocator)(V));               \
+    void PFX##_free(struct SNAME *_heap_, void (*deallocator)(V));                \
+    /* Collection Input and Output */                                             \
+    bool PFX##_insert(struct SNAME *_heap_, V element);                           \
+    bool PFX##_insert_many(struct SNAME *_heap_, V *elements, size_t n);          \
+    bool PFX##_remove_max(struct SNAME *_heap_, V *result);                       \
+    bool PFX##_remove_min(struct SNAME *_heap_, V *result);                       \
+    /* Collection Update */                                                       \
+    bool PFX##_update_max(struct SNAME *_heap_, V element);                       \
+    bool PFX##_update_min(struct SNAME *_heap_, V element);                       \
+    /* Element Access */                                                          \
+    bool PFX##_max(struct SNAME *_heap_, V *value);                               \
+    bool PFX##_min(struct SNAME *_heap_, V *value);                               \
+    /* Collection State */                                                        \
+    bool PFX##_contains(struct SNAME *_heap_, V element);                         \
+    CMC_PURE bool PFX##_empty(struct SNAME *_heap_);                              \
+    bool PFX##_full(struct SNAME *_heap_);                                        \
+    CMC_PURE size_t PFX##_count(struct SNAME *_heap_);                            \
+    size_t PFX##_memory_usage(struct SNAME *_heap_);                              \
+    size_t PFX##_capacity(struct SNAME *_heap_);                                  \
+    /* Collection Utility */                                                      \
+    bool PFX##_resize(struct SNAME *_heap_, size_t capacity);                     \
+    bool PFX##_shrink_to_fit(struct SNAME *_heap_);                               \
+    bool PFX##_reserve(struct SNAME *_heap_, size_t capacity);                    \
+    struct SNAME *PFX##_copy_of(struct SNAME *_heap_, V (*copy_func)(V));         \
+    bool PFX##_equals(struct SNAME *_heap1_, struct SNAME *_heap2_);              \
+    struct cmc_string PFX##_to_string(struct SNAME *_heap_);                      \
+    bool PFX##_to_string_full(struct SNAME *_heap_,                               \
+                              struct cmc_string_builder *builder,                 \
+                              const char *elem_fmt);                              \
+    bool PFX##_write(struct SNAME *_heap_, FILE *file,                            \
+                     void (*fmt)(FILE *, V));                                     \
+    bool PFX##_write_fd(struct SNAME *_heap_, int fd,                             \
+                        void (*fmt)(struct cmc_dump *, V));                       \
+    /* Collection Serialization */                                                \
+    bool PFX##_save(struct SNAME *_heap_, FILE *file, bool (*writer)(V, FILE *)); \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(V, V),                 \
+                                bool (*reader)(V *, FILE *));                     \
+                                                                                  \
+    /* Iterator Functions */                                                      \
+    /* Iterator Allocation and Deallocation */                                    \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target);                    \
+    void PFX##_iter_free(struct SNAME##_iter *iter);                              \
+    /* Iterator Initialization */                                                 \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);        \
+    /* Iterator State */                                                          \
+    bool PFX##_iter_start(struct SNAME##_iter *iter);                             \
+    bool PFX##_iter_end(struct SNAME##_iter *iter);                               \
+    /* Iterator Movement */                                                       \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter);                          \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter);                            \
+    bool PFX##_iter_next(struct SNAME##_iter *iter);                              \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter);                              \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps);             \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps);              \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index);               \
+    /* Iterator Access */                                                         \
+    V PFX##_iter_value(struct SNAME##_iter *iter);                                \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter);                           \
+                                                                                  \
+/* SOURCE ********************************************************************/
+#define CMC_IMPL_MINMAXHEAP_SOURCE(PFX, SNAME, V, CMP)                                           \
+    /* Implementation Detail Functions */                                                        \
+    static inline int PFX##_impl_cmp(struct SNAME *_heap_, V a, V b);                            \
+    static inline bool PFX##_impl_min_level(size_t index);                                       \
+    static size_t PFX##_impl_max_index(struct SNAME *_heap_);                                    \
+    static void PFX##_impl_float_up(struct SNAME *_heap_, size_t index);                         \
+    static void PFX##_impl_float_down(struct SNAME *_heap_, size_t index);                       \
+    static void PFX##_impl_heapify(struct SNAME *_heap_);                                        \
+    static void PFX##_impl_low_water(struct SNAME *_heap_);                                      \
+    static bool PFX##_impl_grow(struct SNAME *_heap_, size_t required);                          \
+    static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_heap_);                        \
+    static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_heap_);                          \
+                                                                                                 \
+    struct SNAME *PFX##_new(size_t capacity, int (*compare)(V, V))                               \
+    {                                                                                            \
+        return PFX##_new_custom(capacity, compare, NULL);                                        \
+    }                                                                                            \
+                                                                                                 \
+    struct SNAME *PFX##_new_custom(size_t capacity, int (*compare)(V, V),                        \
+                                   struct cmc_alloc_node *alloc)                                 \
+    {                                                                                            \
+        if (!alloc)                                                                              \
+            alloc = &cmc_alloc_node_default;                                                     \
+                                                                                                 \
+        if (capacity == 0 || capacity == UINT64_MAX)                                             \
+            return NULL;                                                                         \
+                                                                                                 \
+        struct SNAME *_heap_ = alloc->malloc(sizeof(struct SNAME));                              \
+                                                                                                 \
+        if (CMC_UNLIKELY(!_heap_))                                                               \
+            return NULL;                                                                         \
+                                                                                                 \
+        _heap_->alloc = alloc;                                                                   \
+                                                                                                 \
+        _heap_->buffer = alloc->calloc(capacity, sizeof(V));                                     \
+                                                                                                 \
+        if (CMC_UNLIKELY(!_heap_->buffer))                                                       \
+        {                                                                                        \
+            alloc->free(_heap_);                                                                 \
+            return NULL;                                                                         \
+        }                                                                                        \
+                                                                                                 \
+        _heap_->capacity = capacity;                                                             \
+        _heap_->count = 0;                                                                       \
+        _heap_->cmp = compare;                                                                   \
+                                                                                                 \
+        _heap_->it_start = PFX##_impl_it_start;                                                  \
+        _heap_->it_end = PFX##_impl_it_end;                                                      \
+                                                                                                 \
+        return _heap_;                                                                           \
+    }                                                                                            \
+                                                                                                 \
+    /* Creates a heap out of the n elements in linear time. The capacity is */                   \
+    /* n, or 1 if n is 0 */                                                                      \
+    struct SNAME *PFX##_new_from(V *elements, size_t n, int (*compare)(V, V))                    \
+    {                                                                                            \
+        struct SNAME *_heap_ = PFX##_new(n > 0 ? n : 1, compare);                                \
+                                                                                                 \
+        if (CMC_UNLIKELY(!_heap_))                                                               \
+            return NULL;                                                                         \
+                                                                                                 \
+        PFX##_insert_many(_heap_, elements, n);                                                  \
+                                                                                                 \
+        return _heap_;                                                                           \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_clear(struct SNAME *_heap_, void (*deallocator)(V))                               \
+    {                                                                                            \
+        if (deallocator)                                                                         \
+        {                                                                                        \
+            for (size_t i = 0; i < _heap_->count; i++)                                           \
+                deallocator(_heap_->buffer[i]);                                                  \
+        }                                                                                        \
+                                                                                                 \
+        memset(_heap_->buffer, 0, sizeof(V) * _heap_->capacity);                                 \
+                                                                                                 \
+        _heap_->count = 0;                                                                       \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_free(struct SNAME *_heap_, void (*deallocator)(V))                                \
+    {                                                                                            \
+        if (deallocator)                                                                         \
+        {                                                                                        \
+            for (size_t i = 0; i < _heap_->count; i++)                                           \
+                deallocator(_heap_->buffer[i]);                                                  \
+        }                                                                                        \
+                                                                                                 \
+        _heap_->alloc->free(_heap_->buffer);                                                     \
+                                                                                                 \
+        _heap_->alloc->free(_heap_);                                                             \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_insert(struct SNAME *_heap_, V element)                                           \
+    {                                                                                            \
+        if (PFX##_full(_heap_))                                                                  \
+        {                                                                                        \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_heap_, _heap_->count + 1)))                       \
+                return false;                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        _heap_->buffer[_heap_->count++] = element;                                               \
+                                                                                                 \
+        PFX##_impl_float_up(_heap_, _heap_->count - 1);                                          \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Inserts the n elements, growing the buffer at most once. If there are */                  \
+    /* at least as many of them as there are elements in the heap the whole */                   \
+    /* buffer is heapified in linear time, otherwise each one is inserted */                     \
+    bool PFX##_insert_many(struct SNAME *_heap_, V *elements, size_t n)                          \
+    {                                                                                            \
+        if (n == 0)                                                                              \
+            return true;                                                                         \
+                                                                                                 \
+        if (_heap_->count + n > _heap_->capacity)                                                \
+        {                                                                                        \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_heap_, _heap_->count + n)))                       \
+                return false;                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        if (n < _heap_->count)                                                                   \
+        {                                                                                        \
+            for (size_t i = 0; i < n; i++)                                                       \
+                PFX##_insert(_heap_, elements[i]);                                               \
+                                                                                                 \
+            return true;                                                                         \
+        }                                                                                        \
+                                                                                                 \
+        memcpy(_heap_->buffer + _heap_->count, elements, sizeof(V) * n);                         \
+                                                                                                 \
+        _heap_->count += n;                                                                      \
+                                                                                                 \
+        PFX##_impl_heapify(_heap_);                                                              \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_remove_max(struct SNAME *_heap_, V *result)                                       \
+    {                                                                                            \
+        if (PFX##_empty(_heap_))                                                                 \
+            return false;                                                                        \
+                                                                                                 \
+        size_t index = PFX##_impl_max_index(_heap_);                                             \
+                                                                                                 \
+        *result = _heap_->buffer[index];                                                         \
+                                                                                                 \
+        /* The last element takes its place and floats down from there */                        \
+        _heap_->count--;                                                                         \
+        _heap_->buffer[index] = _heap_->buffer[_heap_->count];                                   \
+        _heap_->buffer[_heap_->count] = (V){0};                                                  \
+                                                                                                 \
+        if (index < _heap_->count)                                                               \
+            PFX##_impl_float_down(_heap_, index);                                                \
+                                                                                                 \
+        PFX##_impl_low_water(_heap_);                                                            \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_remove_min(struct SNAME *_heap_, V *result)                                       \
+    {                                                                                            \
+        if (PFX##_empty(_heap_))                                                                 \
+            return false;                                                                        \
+                                                                                                 \
+        *result = _heap_->buffer[0];                                                             \
+                                                                                                 \
+        /* The last element takes the place of the root and floats down */                       \
+        _heap_->count--;                                                                         \
+        _heap_->buffer[0] = _heap_->buffer[_heap_->count];                                       \
+        _heap_->buffer[_heap_->count] = (V){0};                                                  \
+                                                                                                 \
+        if (_heap_->count > 0)                                                                   \
+            PFX##_impl_float_down(_heap_, 0);                                                    \
+                                                                                                 \
+        PFX##_impl_low_water(_heap_);                                                            \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_update_max(struct SNAME *_heap_, V element)                                       \
+    {                                                                                            \
+        if (PFX##_empty(_heap_))                                                                 \
+            return false;                                                                        \
+                                                                                                 \
+        size_t index = PFX##_impl_max_index(_heap_);                                             \
+                                                                                                 \
+        /* Corner case: the new maximum is less than the minimum, so they are */                 \
+        /* swapped and the old minimum floats down from the max level */                         \
+        if (index > 0 && PFX##_impl_cmp(_heap_, element, _heap_->buffer[0]) < 0)                 \
+        {                                                                                        \
+            _heap_->buffer[index] = _heap_->buffer[0];                                           \
+            _heap_->buffer[0] = element;                                                         \
+        }                                                                                        \
+        else                                                                                     \
+            _heap_->buffer[index] = element;                                                     \
+                                                                                                 \
+        PFX##_impl_float_down(_heap_, index);                                                    \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_update_min(struct SNAME *_heap_, V element)                                       \
+    {                                                                                            \
+        if (PFX##_empty(_heap_))                                                                 \
+            return false;                                                                        \
+                                                                                                 \
+        /* Floating down from a min level also handles a new minimum that is */                  \
+        /* greater than the maximum */                                                           \
+        _heap_->buffer[0] = element;                                                             \
+                                                                                                 \
+        PFX##_impl_float_down(_heap_, 0);                                                        \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_max(struct SNAME *_heap_, V *value)                                               \
+    {                                                                                            \
+        if (PFX##_empty(_heap_))                                                                 \
+            return false;                                                                        \
+                                                                                                 \
+        *value = _heap_->buffer[PFX##_impl_max_index(_heap_)];                                   \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_min(struct SNAME *_heap_, V *value)                                               \
+    {                                                                                            \
+        if (PFX##_empty(_heap_))                                                                 \
+            return false;                                                                        \
+                                                                                                 \
+        *value = _heap_->buffer[0];                                                              \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_contains(struct SNAME *_heap_, V element)                                         \
+    {                                                                                            \
+        for (size_t i = 0; i < _heap_->count; i++)                                               \
+        {                                                                                        \
+            if (PFX##_impl_cmp(_heap_, _heap_->buffer[i], element) == 0)                         \
+                return true;                                                                     \
+        }                                                                                        \
+                                                                                                 \
+        return false;                                                                            \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_empty(struct SNAME *_heap_)                                                       \
+    {                                                                                            \
+        return _heap_->count == 0;                                                               \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_full(struct SNAME *_heap_)                                                        \
+    {                                                                                            \
+        return _heap_->count >= _heap_->capacity;                                                \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_count(struct SNAME *_heap_)                                                     \
+    {                                                                                            \
+        return _heap_->count;                                                                    \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_memory_usage(struct SNAME *_heap_)                                              \
+    {                                                                                            \
+        return sizeof(struct SNAME) + sizeof(V) * _heap_->capacity;                              \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_capacity(struct SNAME *_heap_)                                                  \
+    {                                                                                            \
+        return _heap_->capacity;                                                                 \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_resize(struct SNAME *_heap_, size_t capacity)                                     \
+    {                                                                                            \
+        if (capacity < PFX##_count(_heap_) || capacity == 0)                                     \
+            return false;                                                                        \
+                                                                                                 \
+        if (PFX##_capacity(_heap_) == capacity)                                                  \
+            return true;                                                                         \
+                                                                                                 \
+        V *new_buffer = _heap_->alloc->realloc(_heap_->buffer, sizeof(V) * capacity);            \
+                                                                                                 \
+        if (CMC_UNLIKELY(!new_buffer))                                                           \
+            return false;                                                                        \
+                                                                                                 \
+        /* Only the elements past the old capacity are new */                                    \
+        if (capacity > _heap_->capacity)                                                         \
+            memset(new_buffer + _heap_->capacity, 0, sizeof(V) * (capacity - _heap_->capacity)); \
+                                                                                                 \
+        _heap_->buffer = new_buffer;                                                             \
+        _heap_->capacity = capacity;                                                             \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_shrink_to_fit(struct SNAME *_heap_)                                               \
+    {                                                                                            \
+        return PFX##_resize(_heap_, _heap_->count > 0 ? _heap_->count : 1);                      \
+    }                                                                                            \
+                                                                                                 \
+    /* Grows the buffer so that at least capacity elements fit. Unlike */                        \
+    /* resize it never shrinks the buffer */                                                     \
+    bool PFX##_reserve(struct SNAME *_heap_, size_t capacity)                                    \
+    {                                                                                            \
+        if (capacity <= _heap_->capacity)                                                        \
+            return true;                                                                         \
+                                                                                                 \
+        return PFX##_resize(_heap_, capacity);                                                   \
+    }                                                                                            \
+                                                                                                 \
+    struct SNAME *PFX##_copy_of(struct SNAME *_heap_, V (*copy_func)(V))                         \
+    {                                                                                            \
+        struct SNAME *result = PFX##_new_custom(_heap_->capacity, _heap_->cmp, _heap_->alloc);   \
+                                                                                                 \
+        if (CMC_UNLIKELY(!result))                                                               \
+            return NULL;                                                                         \
+                                                                                                 \
+        if (copy_func)                                                                           \
+        {                                                                                        \
+            for (size_t i = 0; i < _heap_->count; i++)                                           \
+                result->buffer[i] = copy_func(_heap_->buffer[i]);                                \
+        }                                                                                        \
+        else                                                                                     \
+            memcpy(result->buffer, _heap_->buffer, sizeof(V) * _heap_->count);                   \
+                                                                                                 \
+        result->count = _heap_->count;                                                           \
+                                                                                                 \
+        return result;                                                                           \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_equals(struct SNAME *_heap1_, struct SNAME *_heap2_)                              \
+    {                                                                                            \
+        if (PFX##_count(_heap1_) != PFX##_count(_heap2_))                                        \
+            return false;                                                                        \
+                                                                                                 \
+        for (size_t i = 0; i < PFX##_count(_heap1_); i++)                                        \
+        {                                                                                        \
+            if (PFX##_impl_cmp(_heap1_, _heap1_->buffer[i], _heap2_->buffer[i]) != 0)            \
+                return false;                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    struct cmc_string PFX##_to_string(struct SNAME *_heap_)                                      \
+    {                                                                                            \
+        struct cmc_string str;                                                                   \
+        struct SNAME *h_ = _heap_;                                                               \
+        const char *name = #SNAME;                                                               \
+                                                                                                 \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_minmaxheap,                               \
+                 name, h_, h_->buffer, h_->capacity, h_->count, h_->cmp);                        \
+                                                                                                 \
+        return str;                                                                              \
+    }                                                                                            \
+                                                                                                 \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE)                               \
+                                                                                                 \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE, (V))                                 \
+                                                                                                 \
+    bool PFX##_save(struct SNAME *_heap_, FILE *file, bool (*writer)(V, FILE *))                 \
+    {                                                                                            \
+        uint32_t flags = writer ? 0 : CMC_SERIAL_RAW_VALUES;                                     \
+                                                                                                 \
+        if (!cmc_serial_write_header(file, "minmaxheap", flags, 0, sizeof(V), 0,                 \
+                                     _heap_->count, _heap_->capacity, 0))                        \
+            return false;                                                                        \
+                                                                                                 \
+        /* Without a writer the whole buffer is written at once */                               \
+        if (!writer)                                                                             \
+            return fwrite(_heap_->buffer, sizeof(V), _heap_->count, file) ==                     \
+                   _heap_->count;                                                                \
+                                                                                                 \
+        for (size_t i = 0; i < _heap_->count; i++)                                               \
+        {                                                                                        \
+            if (!writer(_heap_->buffer[i], file))                                                \
+                return false;                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* The reader is only used if the heap was saved with a writer */                            \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(V, V),                                \
+                                bool (*reader)(V *, FILE *))                                     \
+    {                                                                                            \
+        struct cmc_serial_header header;                                                         \
+                                                                                                 \
+        if (!cmc_serial_read_header(file, "minmaxheap", 0, sizeof(V), &header))                  \
+            return NULL;                                                                         \
+                                                                                                 \
+        if (header.capacity < header.count)                                                      \
+            return NULL;                                                                         \
+                                                                                                 \
+        /* Allocated with the saved capacity so that loading never grows */                      \
+        struct SNAME *_heap_ = PFX##_new(header.capacity, compare);                              \
+                                                                                                 \
+        if (CMC_UNLIKELY(!_heap_))                                                               \
+            return NULL;                                                                         \
+                                                                                                 \
+        if (header.flags & CMC_SERIAL_RAW_VALUES)                                                \
+            _heap_->count = fread(_heap_->buffer, sizeof(V), header.count, file);                \
+        else                                                                                     \
+        {                                                                                        \
+            while (_heap_->count < header.count &&                                               \
+                   CMC_SERIAL_READ(false, reader, &(_heap_->buffer[_heap_->count]), file))       \
+                _heap_->count++;                                                                 \
+        }                                                                                        \
+                                                                                                 \
+        if (_heap_->count != header.count)                                                       \
+        {                                                                                        \
+            PFX##_free(_heap_, NULL);                                                            \
+            return NULL;                                                                         \
+        }                                                                                        \
+                                                                                                 \
+        return _heap_;                                                                           \
+    }                                                                                            \
+                                                                                                 \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                    \
+    {                                                                                            \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));          \
+                                                                                                 \
+        if (CMC_UNLIKELY(!iter))                                                                 \
+            return NULL;                                                                         \
+                                                                                                 \
+        PFX##_iter_init(iter, target);                                                           \
+                                                                                                 \
+        return iter;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_iter_free(struct SNAME##_iter *iter)                                              \
+    {                                                                                            \
+        iter->target->alloc->free(iter);                                                         \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                        \
+    {                                                                                            \
+        iter->target = target;                                                                   \
+        iter->cursor = 0;                                                                        \
+        iter->start = true;                                                                      \
+        iter->end = PFX##_empty(target);                                                         \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                             \
+    {                                                                                            \
+        return PFX##_empty(iter->target) || iter->start;                                         \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                               \
+    {                                                                                            \
+        return PFX##_empty(iter->target) || iter->end;                                           \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                          \
+    {                                                                                            \
+        if (!PFX##_empty(iter->target))                                                          \
+        {                                                                                        \
+            iter->cursor = 0;                                                                    \
+            iter->start = true;                                                                  \
+            iter->end = PFX##_empty(iter->target);                                               \
+        }                                                                                        \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                            \
+    {                                                                                            \
+        if (!PFX##_empty(iter->target))                                                          \
+        {                                                                                        \
+            iter->cursor = iter->target->count - 1;                                              \
+            iter->start = PFX##_empty(iter->target);                                             \
+            iter->end = true;                                                                    \
+        }                                                                                        \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                              \
+    {                                                                                            \
+        if (iter->end)                                                                           \
+            return false;                                                                        \
+                                                                                                 \
+        if (iter->cursor + 1 == PFX##_count(iter->target))                                       \
+        {                                                                                        \
+            iter->end = true;                                                                    \
+            return false;                                                                        \
+        }                                                                                        \
+                                                                                                 \
+        iter->start = PFX##_empty(iter->target);                                                 \
+                                                                                                 \
+        iter->cursor++;                                                                          \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                              \
+    {                                                                                            \
+        if (iter->start)                                                                         \
+            return false;                                                                        \
+                                                                                                 \
+        if (iter->cursor == 0)                                                                   \
+        {                                                                                        \
+            iter->start = true;                                                                  \
+            return false;                                                                        \
+        }                                                                                        \
+                                                                                                 \
+        iter->end = PFX##_empty(iter->target);                                                   \
+                                                                                                 \
+        iter->cursor--;                                                                          \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Returns true only if the iterator moved */                                                \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps)                             \
+    {                                                                                            \
+        if (iter->end)                                                                           \
+            return false;                                                                        \
+                                                                                                 \
+        if (iter->cursor + 1 == PFX##_count(iter->target))                                       \
+        {                                                                                        \
+            iter->end = true;                                                                    \
+            return false;                                                                        \
+        }                                                                                        \
+                                                                                                 \
+        if (steps == 0 || iter->cursor + steps >= PFX##_count(iter->target))                     \
+            return false;                                                                        \
+                                                                                                 \
+        iter->start = PFX##_empty(iter->target);                                                 \
+                                                                                                 \
+        iter->cursor += steps;                                                                   \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Returns true only if the iterator moved */                                                \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps)                              \
+    {                                                                                            \
+        if (iter->start)                                                                         \
+            return false;                                                                        \
+                                                                                                 \
+        if (iter->cursor == 0)                                                                   \
+        {                                                                                        \
+            iter->start = true;                                                                  \
+            return false;                                                                        \
+        }                                                                                        \
+                                                                                                 \
+        if (steps == 0 || iter->cursor < steps)                                                  \
+            return false;                                                                        \
+                                                                                                 \
+        iter->end = PFX##_empty(iter->target);                                                   \
+                                                                                                 \
+        iter->cursor -= steps;                                                                   \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Returns true only if the iterator was able to be positioned at the given index */         \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index)                               \
+    {                                                                                            \
+        if (index >= PFX##_count(iter->target))                                                  \
+            return false;                                                                        \
+                                                                                                 \
+        if (iter->cursor > index)                                                                \
+            return PFX##_iter_rewind(iter, iter->cursor - index);                                \
+        else if (iter->cursor < index)                                                           \
+            return PFX##_iter_advance(iter, index - iter->cursor);                               \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                                \
+    {                                                                                            \
+        if (PFX##_empty(iter->target))                                                           \
+            return (V){0};                                                                       \
+                                                                                                 \
+        return iter->target->buffer[iter->cursor];                                               \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                           \
+    {                                                                                            \
+        return iter->cursor;                                                                     \
+    }                                                                                            \
+                                                                                                 \
+    /* Levels 0, 2, 4 and so on are min levels, the others are max levels */                     \
+    static inline bool PFX##_impl_min_level(size_t index)                                        \
+    {                                                                                            \
+        return (63 - cmc_math_clz((uint64_t)index + 1)) % 2 == 0;                                \
+    }                                                                                            \
+                                                                                                 \
+    /* The maximum is the root if it is alone, otherwise one of its children */                  \
+    static size_t PFX##_impl_max_index(struct SNAME *_heap_)                                     \
+    {                                                                                            \
+        if (_heap_->count < 3)                                                                   \
+            return _heap_->count - 1;                                                            \
+                                                                                                 \
+        return PFX##_impl_cmp(_heap_, _heap_->buffer[1], _heap_->buffer[2]) < 0 ? 2 : 1;         \
+    }                                                                                            \
+                                                                                                 \
+    /* Moves the element at index up through its grandparents. It first goes */                  \
+    /* to the parent if it belongs to the levels of the other kind */                            \
+    static void PFX##_impl_float_up(struct SNAME *_heap_, size_t index)                          \
+    {                                                                                            \
+        if (index == 0)                                                                          \
+            return;                                                                              \
+                                                                                                 \
+        V *buffer = _heap_->buffer;                                                              \
+        V value = buffer[index];                                                                 \
+                                                                                                 \
+        size_t parent = (index - 1) / 2;                                                         \
+                                                                                                 \
+        /* Whether value goes up through min levels (-1) or max levels (1) */                    \
+        int side = PFX##_impl_min_level(index) ? -1 : 1;                                         \
+                                                                                                 \
+        if (PFX##_impl_cmp(_heap_, value, buffer[parent]) * side < 0)                            \
+        {                                                                                        \
+            buffer[index] = buffer[parent];                                                      \
+            index = parent;                                                                      \
+            side = -side;                                                                        \
+        }                                                                                        \
+                                                                                                 \
+        /* Hole technique, each grandparent moves down until value fits */                       \
+        while (index > 2)                                                                        \
+        {                                                                                        \
+            size_t grandparent = (index - 3) / 4;                                                \
+                                                                                                 \
+            if (PFX##_impl_cmp(_heap_, value, buffer[grandparent]) * side <= 0)                  \
+                break;                                                                           \
+                                                                                                 \
+            buffer[index] = buffer[grandparent];                                                 \
+            index = grandparent;                                                                 \
+        }                                                                                        \
+                                                                                                 \
+        buffer[index] = value;                                                                   \
+    }                                                                                            \
+                                                                                                 \
+    /* Moves the element at index down, to its smallest descendant within two */                 \
+    /* levels if it is on a min level or to its largest one otherwise */                         \
+    static void PFX##_impl_float_down(struct SNAME *_heap_, size_t index)                        \
+    {                                                                                            \
+        V *buffer = _heap_->buffer;                                                              \
+        size_t count = _heap_->count;                                                            \
+                                                                                                 \
+        /* Whether index is on a min level (-1) or a max level (1) */                            \
+        int side = PFX##_impl_min_level(index) ? -1 : 1;                                         \
+                                                                                                 \
+        while (true)                                                                             \
+        {                                                                                        \
+            size_t child = 2 * index + 1;                                                        \
+                                                                                                 \
+            if (child >= count)                                                                  \
+                return;                                                                          \
+                                                                                                 \
+            /* The best of the descendants within two levels. A child that has */                \
+            /* children of its own is never better than all of them */                           \
+            size_t first = 2 * child + 1;                                                        \
+            size_t last = first + 4 < count ? first + 4 : count;                                 \
+            size_t best = first < count ? first : child;                                         \
+                                                                                                 \
+            for (size_t i = first + 1; i < last; i++)                                            \
+            {                                                                                    \
+                if (PFX##_impl_cmp(_heap_, buffer[i], buffer[best]) * side > 0)                  \
+                    best = i;                                                                    \
+            }                                                                                    \
+                                                                                                 \
+            /* The children of the second child start at first + 2 */                            \
+            if (child + 1 < count && first + 2 >= count &&                                       \
+                PFX##_impl_cmp(_heap_, buffer[child + 1], buffer[best]) * side > 0)              \
+                best = child + 1;                                                                \
+                                                                                                 \
+            if (PFX##_impl_cmp(_heap_, buffer[best], buffer[index]) * side <= 0)                 \
+                return;                                                                          \
+                                                                                                 \
+            V value = buffer[index];                                                             \
+            buffer[index] = buffer[best];                                                        \
+            buffer[best] = value;                                                                \
+                                                                                                 \
+            /* A child is on the other kind of level and has no descendants */                   \
+            /* that could be out of place */                                                     \
+            if (best < first)                                                                    \
+                return;                                                                          \
+                                                                                                 \
+            /* The element now at a grandchild might belong to the level of */                   \
+            /* its parent */                                                                     \
+            size_t parent = (best - 1) / 2;                                                      \
+                                                                                                 \
+            if (PFX##_impl_cmp(_heap_, buffer[best], buffer[parent]) * side < 0)                 \
+            {                                                                                    \
+                value = buffer[best];                                                            \
+                buffer[best] = buffer[parent];                                                   \
+                buffer[parent] = value;                                                          \
+            }                                                                                    \
+                                                                                                 \
+            index = best;                                                                        \
+        }                                                                                        \
+    }                                                                                            \
+                                                                                                 \
+    /* Floyd's method, from the last parent to the root each element floats */                   \
+    /* down, so each subtree is a min-max heap before its root is */                             \
+    static void PFX##_impl_heapify(struct SNAME *_heap_)                                         \
+    {                                                                                            \
+        if (_heap_->count < 2)                                                                   \
+            return;                                                                              \
+                                                                                                 \
+        for (size_t i = (_heap_->count - 2) / 2 + 1; i > 0; i--)                                 \
+            PFX##_impl_float_down(_heap_, i - 1);                                                \
+    }                                                                                            \
+                                                                                                 \
+    /* Called after removals, halves the buffer until it is no longer mostly empty */            \
+    static void PFX##_impl_low_water(struct SNAME *_heap_)                                       \
+    {                                                                                            \
+        size_t capacity = _heap_->capacity;                                                      \
+                                                                                                 \
+        while (capacity > 1 && (double)_heap_->count < (double)capacity * CMC_SHRINK_LOW_WATER)  \
+            capacity /= 2;                                                                       \
+                                                                                                 \
+        if (capacity != _heap_->capacity)                                                        \
+            PFX##_resize(_heap_, capacity);                                                      \
+    }                                                                                            \
+                                                                                                 \
+    /* Called when the buffer is full, grows it by the policy of cmc_growth.h */                 \
+    static bool PFX##_impl_grow(struct SNAME *_heap_, size_t required)                           \
+    {                                                                                            \
+        return PFX##_resize(_heap_, cmc_growth_capacity(_heap_->capacity, required));            \
+    }                                                                                            \
+                                                                                                 \
+    static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_heap_)                         \
+    {                                                                                            \
+        struct SNAME##_iter iter;                                                                \
+                                                                                                 \
+        PFX##_iter_init(&iter, _heap_);                                                          \
+        PFX##_iter_to_start(&iter);                                                              \
+                                                                                                 \
+        return iter;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_heap_)                           \
+    {                                                                                            \
+        struct SNAME##_iter iter;                                                                \
+                                                                                                 \
+        PFX##_iter_init(&iter, _heap_);                                                          \
+        PFX##_iter_to_end(&iter);                                                                \
+                                                                                                 \
+        return iter;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    static inline int PFX##_impl_cmp(struct SNAME *_heap_, V a, V b)                             \
+    {                                                                                            \
+        (void)_heap_;                                                                            \
+                                                                                                 \
+        return CMP(a, b);                                                                        \
+    }
+
+#endif /* CMC_MINMAXHEAP_H */
@@ -0,0 +1,441 @@
+/**
+ * mpmcqueue.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * MPMCQueue
+ *
+ * A MPMCQueue is a Queue of a fixed capacity that can be shared by any amount
+ * of producer and consumer threads, like the job queue of a pool of workers.
+ * try_enqueue and try_dequeue never block and fail if the queue is full or
+ * empty. enqueue and dequeue wait until they succeed, first retrying a few
+ * times and then sleeping on a condition variable until another thread
+ * dequeues or enqueues an element. Requires pthreads and C11 atomics.
+ *
+ * Implementation
+ *
+ * This is the bounded queue by Dmitry Vyukov. Each slot of the circular
+ * buffer has a sequence number telling which turn of the buffer it is ready
+ * for. A producer claims the slot at the enqueue position with a compare
+ * and swap once its sequence shows it was dequeued in the previous turn,
+ * writes the element and then publishes it by advancing the sequence, and a
+ * consumer does the same from the dequeue position. Threads only contend on
+ * the position they advance and the slot they claim, and both positions are
+ * on their own cache lines.
+ *
+ * The mutex and the condition variables are only used by threads that gave
+ * up retrying. The others take them only to wake a thread that is waiting.
+ */
+
+#ifndef CMC_MPMCQUEUE_H
+#define CMC_MPMCQUEUE_H
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_mpmcqueue = "%s at %p { buffer:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX " }";
+
+/* The positions are padded to this size to avoid false sharing */
+#ifndef CMC_CACHE_LINE_SIZE
+#define CMC_CACHE_LINE_SIZE 64
+#endif
+
+/* Attempts a blocking function makes before it waits on a condition */
+#ifndef CMC_MPMC_QUEUE_SPINS
+#define CMC_MPMC_QUEUE_SPINS 64
+#endif
+
+#define CMC_GENERATE_MPMC_QUEUE(PFX, SNAME, V)    \
+    CMC_GENERATE_MPMC_QUEUE_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_MPMC_QUEUE_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_MPMC_QUEUE_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_MPMC_QUEUE_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_MPMC_QUEUE_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_MPMC_QUEUE_SOURCE(PFX, SNAME, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_MPMC_QUEUE_HEADER(PFX, SNAME, V)                         \
+    /* A slot of the circular buffer */                                       \
+    struct SNAME##_slot                                                       \
+    {                                                                         \
+        /* Position that can claim this slot next, plus one if it holds an */ \
+        /* element */                                                         \
+        atomic_size_t sequence;                                               \
+                                                                              \
+        /* Element stored, if any */                                          \
+        V value;                                                              \
+    };                                                                        \
+                                                                              \
+    /* MPMCQueue Structure */                                                 \
+    struct SNAME                                                              \
+    {                                                                         \
+        /* Position of the next enqueue */                                    \
+        atomic_size_t enqueue_pos;                                            \
+                                                                              \
+        char enqueue_padding[CMC_CACHE_LINE_SIZE - sizeof(atomic_size_t)];    \
+                                                                              \
+        /* Position of the next dequeue */                                    \
+        atomic_size_t dequeue_pos;                                            \
+                                                                              \
+        char dequeue_padding[CMC_CACHE_LINE_SIZE - sizeof(atomic_size_t)];    \
+                                                                              \
+        /* Circular buffer of slots */                                        \
+        struct SNAME##_slot *buffer;                                          \
+                                                                              \
+        /* Amount of slots, a power of two */                                 \
+        size_t capacity;                                                      \
+                                                                              \
+        /* Held by threads about to wait on the conditions or wake them */    \
+        pthread_mutex_t lock;                                                 \
+                                                                              \
+        /* Signaled when a slot is filled or emptied */                       \
+        pthread_cond_t not_empty;                                             \
+        pthread_cond_t not_full;                                              \
+                                                                              \
+        /* Threads waiting on each condition */                               \
+        atomic_size_t waiting_consumers;                                      \
+        atomic_size_t waiting_producers;                                      \
+                                                                              \
+        /* Custom allocation functions */                                     \
+        struct cmc_alloc_node *alloc;                                         \
+    };                                                                        \
+                                                                              \
+    /* Collection Functions */                                                \
+    /* Collection Allocation and Deallocation */                              \
+    struct SNAME *PFX##_new(size_t capacity);                                 \
+    struct SNAME *PFX##_new_custom(size_t capacity,                           \
+                                   struct cmc_alloc_node *alloc);             \
+    void PFX##_free(struct SNAME *_queue_, void (*deallocator)(V));           \
+    /* Collection Input and Output */                                         \
+    bool PFX##_try_enqueue(struct SNAME *_queue_, V element);                 \
+    bool PFX##_try_dequeue(struct SNAME *_queue_, V *result);                 \
+    bool PFX##_enqueue(struct SNAME *_queue_, V element);                     \
+    bool PFX##_dequeue(struct SNAME *_queue_, V *result);                     \
+    /* Collection State */                                                    \
+    bool PFX##_empty(struct SNAME *_queue_);                                  \
+    bool PFX##_full(struct SNAME *_queue_);                                   \
+    size_t PFX##_count(struct SNAME *_queue_);                                \
+    size_t PFX##_memory_usage(struct SNAME *_queue_);                         \
+    size_t PFX##_capacity(struct SNAME *_queue_);                             \
+    /* Collection Utility */                                                  \
+    struct cmc_string PFX##_to_string(struct SNAME *_queue_);                 \
+                                                                              \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_MPMC_QUEUE_SOURCE(PFX, SNAME, V)                                           \
+    /* Implementation Detail Functions */                                                       \
+    static bool PFX##_impl_enqueue(struct SNAME *_queue_, V element);                           \
+    static bool PFX##_impl_dequeue(struct SNAME *_queue_, V *result);                           \
+    static void PFX##_impl_wake(struct SNAME *_queue_, atomic_size_t *waiting,                  \
+                                pthread_cond_t *condition);                                     \
+                                                                                                \
+    /* The capacity is rounded up to a power of two */                                          \
+    struct SNAME *PFX##_new(size_t capacity)                                                    \
+    {                                                                                           \
+        return PFX##_new_custom(capacity, NULL);                                                \
+    }                                                                                           \
+                                                                                                \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc)               \
+    {                                                                                           \
+        if (!alloc)                                                                             \
+            alloc = &cmc_alloc_node_default;                                                    \
+                                                                                                \
+        if (capacity < 1 || capacity > SIZE_MAX / 2)                                            \
+            return NULL;                                                                        \
+                                                                                                \
+        size_t slots = 2;                                                                       \
+                                                                                                \
+        while (slots < capacity)                                                                \
+            slots *= 2;                                                                         \
+                                                                                                \
+        size_t size = (sizeof(struct SNAME) + CMC_CACHE_LINE_SIZE - 1) / CMC_CACHE_LINE_SIZE;   \
+                                                                                                \
+        struct SNAME *_queue_ = cmc_alloc_aligned(alloc, CMC_CACHE_LINE_SIZE,                   \
+                                                  size * CMC_CACHE_LINE_SIZE);                  \
+                                                                                                \
+        if (CMC_UNLIKELY(!_queue_))                                                             \
+            return NULL;                                                                        \
+                                                                                                \
+        _queue_->alloc = alloc;                                                                 \
+                                                                                                \
+        _queue_->buffer = alloc->malloc(sizeof(struct SNAME##_slot) * slots);                   \
+                                                                                                \
+        if (CMC_UNLIKELY(!_queue_->buffer))                                                     \
+        {                                                                                       \
+            cmc_alloc_aligned_free(alloc, _queue_);                                             \
+            return NULL;                                                                        \
+        }                                                                                       \
+                                                                                                \
+        for (size_t i = 0; i < slots; i++)                                                      \
+            atomic_init(&(_queue_->buffer[i].sequence), i);                                     \
+                                                                                                \
+        _queue_->capacity = slots;                                                              \
+                                                                                                \
+        atomic_init(&(_queue_->enqueue_pos), 0);                                                \
+        atomic_init(&(_queue_->dequeue_pos), 0);                                                \
+        atomic_init(&(_queue_->waiting_consumers), 0);                                          \
+        atomic_init(&(_queue_->waiting_producers), 0);                                          \
+                                                                                                \
+        pthread_mutex_init(&(_queue_->lock), NULL);                                             \
+        pthread_cond_init(&(_queue_->not_empty), NULL);                                         \
+        pthread_cond_init(&(_queue_->not_full), NULL);                                          \
+                                                                                                \
+        return _queue_;                                                                         \
+    }                                                                                           \
+                                                                                                \
+    /* Not thread safe, no other thread can be using the queue */                               \
+    void PFX##_free(struct SNAME *_queue_, void (*deallocator)(V))                              \
+    {                                                                                           \
+        V value;                                                                                \
+                                                                                                \
+        while (deallocator && PFX##_try_dequeue(_queue_, &value))                               \
+            deallocator(value);                                                                 \
+                                                                                                \
+        pthread_mutex_destroy(&(_queue_->lock));                                                \
+        pthread_cond_destroy(&(_queue_->not_empty));                                            \
+        pthread_cond_destroy(&(_queue_->not_full));                                             \
+                                                                                                \
+        _queue_->alloc->free(_queue_->buffer);                                                  \
+        cmc_alloc_aligned_free(_queue_->alloc, _queue_);                                        \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_try_enqueue(struct SNAME *_queue_, V element)                                    \
+    {                                                                                           \
+        if (!PFX##_impl_enqueue(_queue_, element))                                              \
+            return false;                                                                       \
+                                                                                                \
+        PFX##_impl_wake(_queue_, &(_queue_->waiting_consumers), &(_queue_->not_empty));         \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_try_dequeue(struct SNAME *_queue_, V *result)                                    \
+    {                                                                                           \
+        if (!PFX##_impl_dequeue(_queue_, result))                                               \
+            return false;                                                                       \
+                                                                                                \
+        PFX##_impl_wake(_queue_, &(_queue_->waiting_producers), &(_queue_->not_full));          \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    /* Waits until there is room for the element. Returns false only if */                      \
+    /* waiting on the condition variable fails */                                               \
+    bool PFX##_enqueue(struct SNAME *_queue_, V element)                                        \
+    {                                                                                           \
+        for (size_t i = 0; i < CMC_MPMC_QUEUE_SPINS; i++)                                       \
+        {                                                                                       \
+            if (PFX##_try_enqueue(_queue_, element))                                            \
+                return true;                                                                    \
+        }                                                                                       \
+                                                                                                \
+        bool result = true;                                                                     \
+                                                                                                \
+        pthread_mutex_lock(&(_queue_->lock));                                                   \
+                                                                                                \
+        /* Consumers check this after every dequeue, so either they see it */                   \
+        /* or the next attempt sees their dequeue */                                            \
+        atomic_fetch_add(&(_queue_->waiting_producers), 1);                                     \
+        atomic_thread_fence(memory_order_seq_cst);                                              \
+                                                                                                \
+        while (result && !PFX##_impl_enqueue(_queue_, element))                                 \
+            result = pthread_cond_wait(&(_queue_->not_full), &(_queue_->lock)) == 0;            \
+                                                                                                \
+        atomic_fetch_sub(&(_queue_->waiting_producers), 1);                                     \
+                                                                                                \
+        pthread_mutex_unlock(&(_queue_->lock));                                                 \
+                                                                                                \
+        if (result)                                                                             \
+            PFX##_impl_wake(_queue_, &(_queue_->waiting_consumers), &(_queue_->not_empty));     \
+                                                                                                \
+        return result;                                                                          \
+    }                                                                                           \
+                                                                                                \
+    /* Waits until there is an element to dequeue. Returns false only if */                     \
+    /* waiting on the condition variable fails */                                               \
+    bool PFX##_dequeue(struct SNAME *_queue_, V *result)                                        \
+    {                                                                                           \
+        for (size_t i = 0; i < CMC_MPMC_QUEUE_SPINS; i++)                                       \
+        {                                                                                       \
+            if (PFX##_try_dequeue(_queue_, result))                                             \
+                return true;                                                                    \
+        }                                                                                       \
+                                                                                                \
+        bool success = true;                                                                    \
+                                                                                                \
+        pthread_mutex_lock(&(_queue_->lock));                                                   \
+                                                                                                \
+        atomic_fetch_add(&(_queue_->waiting_consumers), 1);                                     \
+        atomic_thread_fence(memory_order_seq_cst);                                              \
+                                                                                                \
+        while (success && !PFX##_impl_dequeue(_queue_, result))                                 \
+            success = pthread_cond_wait(&(_queue_->not_empty), &(_queue_->lock)) == 0;          \
+                                                                                                \
+        atomic_fetch_sub(&(_queue_->waiting_consumers), 1);                                     \
+                                                                                                \
+        pthread_mutex_unlock(&(_queue_->lock));                                                 \
+                                                                                                \
+        if (success)                                                                            \
+            PFX##_impl_wake(_queue_, &(_queue_->waiting_producers), &(_queue_->not_full));      \
+                                                                                                \
+        return success;                                                                         \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_empty(struct SNAME *_queue_)                                                     \
+    {                                                                                           \
+        return PFX##_count(_queue_) == 0;                                                       \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_full(struct SNAME *_queue_)                                                      \
+    {                                                                                           \
+        return PFX##_count(_queue_) >= _queue_->capacity;                                       \
+    }                                                                                           \
+                                                                                                \
+    /* Only exact if no other thread is enqueueing or dequeueing */                             \
+    size_t PFX##_count(struct SNAME *_queue_)                                                   \
+    {                                                                                           \
+        size_t dequeue_pos = atomic_load(&(_queue_->dequeue_pos));                              \
+        size_t enqueue_pos = atomic_load(&(_queue_->enqueue_pos));                              \
+                                                                                                \
+        if (enqueue_pos < dequeue_pos)                                                          \
+            return 0;                                                                           \
+                                                                                                \
+        size_t count = enqueue_pos - dequeue_pos;                                               \
+                                                                                                \
+        return count > _queue_->capacity ? _queue_->capacity : count;                           \
+    }                                                                                           \
+                                                                                                \
+    size_t PFX##_memory_usage(struct SNAME *_queue_)                                            \
+    {                                                                                           \
+        /* The struct takes whole cache lines */                                                \
+        size_t lines = (sizeof(struct SNAME) + CMC_CACHE_LINE_SIZE - 1) / CMC_CACHE_LINE_SIZE;  \
+        size_t bytes = lines * CMC_CACHE_LINE_SIZE;                                             \
+                                                                                                \
+        bytes = cmc_alloc_aligned_size(CMC_CACHE_LINE_SIZE, bytes);                             \
+                                                                                                \
+        return bytes + sizeof(struct SNAME##_slot) * _queue_->capacity;                         \
+    }                                                                                           \
+                                                                                                \
+    size_t PFX##_capacity(struct SNAME *_queue_)                                                \
+    {                                                                                           \
+        return _queue_->capacity;                                                               \
+    }                                                                                           \
+                                                                                                \
+    struct cmc_string PFX##_to_string(struct SNAME *_queue_)                                    \
+    {                                                                                           \
+        struct cmc_string str;                                                                  \
+        struct SNAME *q_ = _queue_;                                                             \
+        const char *name = #SNAME;                                                              \
+                                                                                                \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_mpmcqueue, name, q_, q_->buffer,         \
+                 q_->capacity, PFX##_count(q_));                                                \
+                                                                                                \
+        return str;                                                                             \
+    }                                                                                           \
+                                                                                                \
+    /* Claims the slot at the enqueue position and publishes the element */                     \
+    static bool PFX##_impl_enqueue(struct SNAME *_queue_, V element)                            \
+    {                                                                                           \
+        size_t mask = _queue_->capacity - 1;                                                    \
+        size_t pos = atomic_load_explicit(&(_queue_->enqueue_pos), memory_order_relaxed);       \
+                                                                                                \
+        struct SNAME##_slot *slot;                                                              \
+                                                                                                \
+        while (true)                                                                            \
+        {                                                                                       \
+            slot = &(_queue_->buffer[pos & mask]);                                              \
+                                                                                                \
+            size_t sequence = atomic_load_explicit(&(slot->sequence), memory_order_acquire);    \
+            intptr_t diff = (intptr_t)sequence - (intptr_t)pos;                                 \
+                                                                                                \
+            if (diff == 0)                                                                      \
+            {                                                                                   \
+                if (atomic_compare_exchange_weak_explicit(&(_queue_->enqueue_pos), &pos,        \
+                                                          pos + 1, memory_order_relaxed,        \
+                                                          memory_order_relaxed))                \
+                    break;                                                                      \
+            }                                                                                   \
+            /* The slot still holds the element of the previous turn */                         \
+            else if (diff < 0)                                                                  \
+                return false;                                                                   \
+            else                                                                                \
+                pos = atomic_load_explicit(&(_queue_->enqueue_pos), memory_order_relaxed);      \
+        }                                                                                       \
+                                                                                                \
+        slot->value = element;                                                                  \
+                                                                                                \
+        atomic_store_explicit(&(slot->sequence), pos + 1, memory_order_release);                \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    /* Claims the slot at the dequeue position and releases it for the */                       \
+    /* next turn */                                                                             \
+    static bool PFX##_impl_dequeue(struct SNAME *_queue_, V *result)                            \
+    {                                                                                           \
+        size_t mask = _queue_->capacity - 1;                                                    \
+        size_t pos = atomic_load_explicit(&(_queue_->dequeue_pos), memory_order_relaxed);       \
+                                                                                                \
+        struct SNAME##_slot *slot;                                                              \
+                                                                                                \
+        while (true)                                                                            \
+        {                                                                                       \
+            slot = &(_queue_->buffer[pos & mask]);                                              \
+                                                                                                \
+            size_t sequence = atomic_load_explicit(&(slot->sequence), memory_order_acquire);    \
+            intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);                           \
+                                                                                                \
+            if (diff == 0)                                                                      \
+            {                                                                                   \
+                if (atomic_compare_exchange_weak_explicit(&(_queue_->dequeue_pos), &pos,        \
+                                                          pos + 1, memory_order_relaxed,        \
+                                                          memory_order_relaxed))                \
+                    break;                                                                      \
+            }                                                                                   \
+            /* The slot was not filled in this turn yet */                                      \
+            else if (diff < 0)                                                                  \
+                return false;                                                                   \
+            else                                                                                \
+                pos = atomic_load_explicit(&(_queue_->dequeue_pos), memory_order_relaxed);      \
+        }                                                                                       \
+                                                                                                \
+        *result = slot->value;                                                                  \
+                                                                                                \
+        atomic_store_explicit(&(slot->sequence), pos + mask + 1, memory_order_release);         \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    /* Called after every enqueue and dequeue. Takes the lock only if some */                   \
+    /* thread is waiting on the condition */                                                    \
+    static void PFX##_impl_wake(struct SNAME *_queue_, atomic_size_t *waiting,                  \
+                                pthread_cond_t *condition)                                      \
+    {                                                                                           \
+        atomic_thread_fence(memory_order_seq_cst);                                              \
+                                                                                                \
+        if (atomic_load_explicit(waiting, memory_order_relaxed) == 0)                           \
+            return;                                                                             \
+                                                                                                \
+        pthread_mutex_lock(&(_queue_->lock));                                                   \
+        pthread_cond_signal(condition);                                                         \
+        pthread_mutex_unlock(&(_queue_->lock));                                                 \
+    }
+
+#endif /* CMC_MPMCQUEUE_H */
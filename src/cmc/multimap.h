@@ -36,6 +36,10 @@
  * always hash to the same linked list. Also, keys that hash to the same bucket
  * will also be in the same linked list.
  *
+ * Entries are not allocated one by one. They are carved out of slabs, each one
+ * twice as big as the previous, and removed entries are kept in a free list to
+ * be reused by the next insertion. Freeing the map only frees its slabs.
+ *
  * The order of inserting and removing the same keys will behave like a FIFO. So
  * the first key added will be the first to be removed.
  */
@@ -48,11 +52,26 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_serial.h"
 #include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
 
 /* to_string format */
 static const char *cmc_string_fmt_multimap = "%s at %p { buffer:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", load:%lf, cmp:%p, hash:%p }";
 
+/* A removal shrinks a collection once less than this fraction of what it */
+/* can hold without growing is in use. Define it as 0 to never shrink */
+#ifndef CMC_SHRINK_LOW_WATER
+#define CMC_SHRINK_LOW_WATER 0.25
+#endif
+
+/* Amount of entries in the first slab of a multimap */
+#ifndef CMC_MULTIMAP_SLAB_SIZE
+#define CMC_MULTIMAP_SLAB_SIZE 64
+#endif
+
 #ifndef CMC_IMPL_HASHTABLE_SETUP
 #define CMC_IMPL_HASHTABLE_SETUP
 
@@ -88,20 +107,317 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                               6917529027641081903,
                                               13835058055282163729llu};
 
+/* Smallest prime from cmc_hashtable_primes that is greater or equal to */
+/* required, found with a binary search. Used by the default (prime sized) */
+/* hashtables */
+static inline size_t cmc_hashtable_prime_size(size_t required)
+{
+    const size_t count = sizeof(cmc_hashtable_primes) / sizeof(cmc_hashtable_primes[0]);
+
+    if (cmc_hashtable_primes[count - 1] < required)
+        return required;
+
+    size_t low = 0;
+    size_t high = count - 1;
+
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+
+        if (cmc_hashtable_primes[mid] < required)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return cmc_hashtable_primes[low];
+}
+
+/* Prime sized tables reduce a hash to a slot with Lemire's fastmod, which */
+/* replaces the division of the modulo with a few multiplications by a */
+/* multiplier computed once for every capacity. Without 128 bit integers */
+/* the multiplier is not used and the modulo is kept */
+#if defined(__SIZEOF_INT128__) && SIZE_MAX == UINT64_MAX
+__extension__ typedef unsigned __int128 cmc_fastmod;
+
+static inline cmc_fastmod cmc_fastmod_new(size_t divisor)
+{
+    return divisor > 0 ? ~(cmc_fastmod)0 / divisor + 1 : 0;
+}
+
+static inline size_t cmc_fastmod_reduce(size_t value, cmc_fastmod multiplier, size_t divisor)
+{
+    /* The fractional part of value / divisor, multiplied by divisor */
+    cmc_fastmod fraction = multiplier * value;
+    cmc_fastmod low = ((fraction & UINT64_MAX) * divisor) >> 64;
+    cmc_fastmod high = (fraction >> 64) * divisor;
+
+    return (size_t)((low + high) >> 64);
+}
+#else
+typedef size_t cmc_fastmod;
+
+static inline cmc_fastmod cmc_fastmod_new(size_t divisor)
+{
+    (void)divisor;
+    return 0;
+}
+
+static inline size_t cmc_fastmod_reduce(size_t value, cmc_fastmod multiplier, size_t divisor)
+{
+    (void)multiplier;
+    return value % divisor;
+}
+#endif
+
+/* Smallest power of two that is greater or equal to required. Used by the */
+/* hashtables generated with the POW2 variants */
+static inline size_t cmc_hashtable_pow2_size(size_t required)
+{
+    size_t size = 64;
+
+    while (size < required && size <= SIZE_MAX / 2)
+        size <<= 1;
+
+    return size;
+}
+
+/* Power of two hashtables only look at the lower bits of a hash so they are */
+/* first passed through this finalizer (from MurmurHash3) to spread the */
+/* entropy of the upper bits */
+static inline size_t cmc_hashtable_mix(size_t hash)
+{
+    uint64_t h = (uint64_t)hash;
+
+    h ^= h >> 33;
+    h *= UINT64_C(0xff51afd7ed558ccd);
+    h ^= h >> 33;
+    h *= UINT64_C(0xc4ceb9fe1a85ec53);
+    h ^= h >> 33;
+
+    return (size_t)h;
+}
+
+/* Fraction of what a hashtable can hold under which a removal shrinks it. */
+/* Tables grow by a factor of 1 / load, so right after growing one is only */
+/* load full, and the mark is kept under half of that so that a table that */
+/* just grew is not shrunk by the next removals */
+static inline double cmc_hashtable_low_water(double load)
+{
+    return CMC_SHRINK_LOW_WATER < load / 2 ? CMC_SHRINK_LOW_WATER : load / 2;
+}
+
+/* Sizing policies selected by the SIZING parameter of the generators. PRIME */
+/* tables reduce a hash with a modulo and POW2 tables mix it and mask it */
+#define CMC_IMPL_HASHTABLE_PRIME_SIZE(required) cmc_hashtable_prime_size(required)
+#define CMC_IMPL_HASHTABLE_PRIME_HOME(hash, capacity) ((hash) % (capacity))
+#define CMC_IMPL_HASHTABLE_PRIME_WRAP(pos, capacity) ((pos) % (capacity))
+
+#define CMC_IMPL_HASHTABLE_POW2_SIZE(required) cmc_hashtable_pow2_size(required)
+#define CMC_IMPL_HASHTABLE_POW2_HOME(hash, capacity) (cmc_hashtable_mix(hash) & ((capacity)-1))
+#define CMC_IMPL_HASHTABLE_POW2_WRAP(pos, capacity) ((pos) & ((capacity)-1))
+
+/* The same for a table, where PRIME tables use the fastmod multiplier kept */
+/* next to their capacity */
+#define CMC_IMPL_HASHTABLE_PRIME_TABLE_HOME(hash, table) \
+    cmc_fastmod_reduce(hash, (table)->fastmod, (table)->capacity)
+#define CMC_IMPL_HASHTABLE_PRIME_TABLE_WRAP(pos, table) \
+    cmc_fastmod_reduce(pos, (table)->fastmod, (table)->capacity)
+
+#define CMC_IMPL_HASHTABLE_POW2_TABLE_HOME(hash, table) \
+    CMC_IMPL_HASHTABLE_POW2_HOME(hash, (table)->capacity)
+#define CMC_IMPL_HASHTABLE_POW2_TABLE_WRAP(pos, table) \
+    CMC_IMPL_HASHTABLE_POW2_WRAP(pos, (table)->capacity)
+
+/* Hashing policies selected by the HASHING parameter of the generators. */
+/* CACHED tables store the full hash of every key in its entry so that it */
+/* is compared before the keys themselves and reused when resizing */
+#define CMC_IMPL_HASHTABLE_CACHED(...) __VA_ARGS__
+#define CMC_IMPL_HASHTABLE_CACHED_EQUALS(cached, hash) ((cached) == (hash))
+#define CMC_IMPL_HASHTABLE_CACHED_REHASH(cached, computed) (cached)
+
+#define CMC_IMPL_HASHTABLE_UNCACHED(...)
+#define CMC_IMPL_HASHTABLE_UNCACHED_EQUALS(cached, hash) true
+#define CMC_IMPL_HASHTABLE_UNCACHED_REHASH(cached, computed) (computed)
+
+/* Batched lookups hash and prefetch the home slots of this many keys before */
+/* resolving any of their probes */
+#define CMC_IMPL_HASHTABLE_BATCH 16
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CMC_IMPL_HASHTABLE_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define CMC_IMPL_HASHTABLE_PREFETCH(address)
+#endif
+
 #endif /* CMC_IMPL_HASHTABLE_SETUP */
 
+#ifndef CMC_IMPL_HASHTABLE_STATS
+#define CMC_IMPL_HASHTABLE_STATS
+
+/* Amount of buckets of the histogram of distances of cmc_hashtable_stats. */
+/* The last bucket also counts every entry that is further away */
+#ifndef CMC_HASHTABLE_STATS_BUCKETS
+#define CMC_HASHTABLE_STATS_BUCKETS 16
+#endif
+
+/* Health of a hashtable, as reported by the stats function of every */
+/* hashtable collection */
+struct cmc_hashtable_stats
+{
+    /* Amount of slots (or buckets) of the table */
+    size_t capacity;
+
+    /* Amount of entries in the table */
+    size_t count;
+
+    /* Slots that are marked as deleted and still take part in probes */
+    size_t tombstones;
+
+    /* Current load, count / capacity */
+    double load;
+
+    /* Greatest distance of an entry to its original position */
+    size_t max_dist;
+
+    /* Average distance of an entry to its original position */
+    double mean_dist;
+
+    /* Amount of entries at each distance to their original position */
+    size_t histogram[CMC_HASHTABLE_STATS_BUCKETS];
+
+    /* Bytes allocated by the collection, not counting what K and V own */
+    size_t bytes;
+
+    /* Lookups done since the table was created */
+    size_t lookups;
+
+    /* Entries compared by these lookups */
+    size_t probes;
+};
+
+/* Adds the distance of an entry to stats. Until cmc_hashtable_stats_end() */
+/* is called mean_dist holds the sum of all distances */
+static inline void cmc_hashtable_stats_add(struct cmc_hashtable_stats *stats, size_t dist)
+{
+    if (dist < CMC_HASHTABLE_STATS_BUCKETS)
+        stats->histogram[dist]++;
+    else
+        stats->histogram[CMC_HASHTABLE_STATS_BUCKETS - 1]++;
+
+    if (dist > stats->max_dist)
+        stats->max_dist = dist;
+
+    stats->mean_dist += (double)dist;
+}
+
+/* Adds the finished stats of another table to stats, for collections made */
+/* of more than one hashtable */
+static inline void cmc_hashtable_stats_merge(struct cmc_hashtable_stats *stats,
+                                             struct cmc_hashtable_stats *other)
+{
+    size_t entries = 0;
+
+    for (size_t i = 0; i < CMC_HASHTABLE_STATS_BUCKETS; i++)
+    {
+        stats->histogram[i] += other->histogram[i];
+        entries += other->histogram[i];
+    }
+
+    if (other->max_dist > stats->max_dist)
+        stats->max_dist = other->max_dist;
+
+    stats->mean_dist += other->mean_dist * (double)entries;
+    stats->capacity += other->capacity;
+    stats->count += other->count;
+    stats->tombstones += other->tombstones;
+    stats->bytes += other->bytes;
+    stats->lookups += other->lookups;
+    stats->probes += other->probes;
+}
+
+/* Turns the sum of distances of stats into their mean and computes the load */
+static inline void cmc_hashtable_stats_end(struct cmc_hashtable_stats *stats)
+{
+    size_t entries = 0;
+
+    for (size_t i = 0; i < CMC_HASHTABLE_STATS_BUCKETS; i++)
+        entries += stats->histogram[i];
+
+    if (entries > 0)
+        stats->mean_dist /= (double)entries;
+
+    if (stats->capacity > 0)
+        stats->load = (double)stats->count / (double)stats->capacity;
+}
+
+/* Defining CMC_HASHTABLE_PROBE_STATS before including any hashtable makes */
+/* every table count its lookups and the entries they compare, reported as */
+/* lookups and probes by cmc_hashtable_stats. The counters are not atomic */
+/* so lookups that run concurrently without a lock are counted loosely */
+#ifdef CMC_HASHTABLE_PROBE_STATS
+#define CMC_IMPL_HASHTABLE_PROBE_FIELDS size_t lookups; size_t probes;
+#define CMC_IMPL_HASHTABLE_PROBE_RESET(table) ((table)->lookups = 0, (table)->probes = 0)
+#define CMC_IMPL_HASHTABLE_PROBE_LOOKUP(table) ((table)->lookups++)
+#define CMC_IMPL_HASHTABLE_PROBE_SLOT(table) ((table)->probes++)
+#define CMC_IMPL_HASHTABLE_PROBE_ADD(to, from) \
+    ((to)->lookups += (from)->lookups, (to)->probes += (from)->probes)
+#else
+#define CMC_IMPL_HASHTABLE_PROBE_FIELDS
+#define CMC_IMPL_HASHTABLE_PROBE_RESET(table) ((void)0)
+#define CMC_IMPL_HASHTABLE_PROBE_LOOKUP(table) ((void)0)
+#define CMC_IMPL_HASHTABLE_PROBE_SLOT(table) ((void)0)
+#define CMC_IMPL_HASHTABLE_PROBE_ADD(to, from) ((void)0)
+#endif
+
+#endif /* CMC_IMPL_HASHTABLE_STATS */
+
 #define CMC_GENERATE_MULTIMAP(PFX, SNAME, K, V)    \
     CMC_GENERATE_MULTIMAP_HEADER(PFX, SNAME, K, V) \
     CMC_GENERATE_MULTIMAP_SOURCE(PFX, SNAME, K, V)
 
+/* Same as CMC_GENERATE_MULTIMAP but entries also store the hash of their key */
+#define CMC_GENERATE_MULTIMAP_CACHED(PFX, SNAME, K, V)    \
+    CMC_GENERATE_MULTIMAP_CACHED_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_MULTIMAP_CACHED_SOURCE(PFX, SNAME, K, V)
+
+/* Same as CMC_GENERATE_MULTIMAP but keys are compared and hashed by */
+/* calling CMP and HASH directly, so the compiler can inline them. The */
+/* functions given to new are still stored but only used by copy_of and */
+/* to_string */
+#define CMC_GENERATE_MULTIMAP_EX(PFX, SNAME, K, V, CMP, HASH) \
+    CMC_GENERATE_MULTIMAP_HEADER(PFX, SNAME, K, V)            \
+    CMC_GENERATE_MULTIMAP_EX_SOURCE(PFX, SNAME, K, V, CMP, HASH)
+
 #define CMC_WRAPGEN_MULTIMAP_HEADER(PFX, SNAME, K, V) \
     CMC_GENERATE_MULTIMAP_HEADER(PFX, SNAME, K, V)
 
 #define CMC_WRAPGEN_MULTIMAP_SOURCE(PFX, SNAME, K, V) \
     CMC_GENERATE_MULTIMAP_SOURCE(PFX, SNAME, K, V)
 
+#define CMC_WRAPGEN_MULTIMAP_CACHED_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_MULTIMAP_CACHED_HEADER(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_MULTIMAP_CACHED_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_MULTIMAP_CACHED_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_GENERATE_MULTIMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_IMPL_MULTIMAP_HEADER(PFX, SNAME, K, V, UNCACHED)
+
+#define CMC_GENERATE_MULTIMAP_CACHED_HEADER(PFX, SNAME, K, V) \
+    CMC_IMPL_MULTIMAP_HEADER(PFX, SNAME, K, V, CACHED)
+
+#define CMC_GENERATE_MULTIMAP_SOURCE(PFX, SNAME, K, V) \
+    CMC_IMPL_MULTIMAP_SOURCE(PFX, SNAME, K, V, UNCACHED, _map_->cmp, _map_->hash)
+
+#define CMC_GENERATE_MULTIMAP_CACHED_SOURCE(PFX, SNAME, K, V) \
+    CMC_IMPL_MULTIMAP_SOURCE(PFX, SNAME, K, V, CACHED, _map_->cmp, _map_->hash)
+
+#define CMC_GENERATE_MULTIMAP_EX_SOURCE(PFX, SNAME, K, V, CMP, HASH) \
+    CMC_IMPL_MULTIMAP_SOURCE(PFX, SNAME, K, V, UNCACHED, CMP, HASH)
+
 /* HEADER ********************************************************************/
-#define CMC_GENERATE_MULTIMAP_HEADER(PFX, SNAME, K, V)                                                \
+#define CMC_IMPL_MULTIMAP_HEADER(PFX, SNAME, K, V, HASHING)                                           \
                                                                                                       \
     /* Multimap Structure */                                                                          \
     struct SNAME                                                                                      \
@@ -111,6 +427,8 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                       \
         /* Current array capacity */                                                                  \
         size_t capacity;                                                                              \
+        /* Multiplier of the capacity that reduces a hash to a slot */                                \
+        cmc_fastmod fastmod;                                                                          \
                                                                                                       \
         /* Current amount of keys */                                                                  \
         size_t count;                                                                                 \
@@ -124,11 +442,26 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         /* Key hash function */                                                                       \
         size_t (*hash)(K);                                                                            \
                                                                                                       \
+        /* Slabs that entries are carved from, the newest one first */                                \
+        struct SNAME##_slab *slabs;                                                                   \
+                                                                                                      \
+        /* Entries left untouched at the end of the newest slab */                                    \
+        size_t slab_left;                                                                             \
+                                                                                                      \
+        /* Removed entries that can be reused, linked through next */                                 \
+        struct SNAME##_entry *free_entries;                                                           \
+                                                                                                      \
+        /* Lookup counters, only present with CMC_HASHTABLE_PROBE_STATS */                            \
+        CMC_IMPL_HASHTABLE_PROBE_FIELDS                                                               \
+                                                                                                      \
         /* Function that returns an iterator to the start of the multimap */                          \
         struct SNAME##_iter (*it_start)(struct SNAME *);                                              \
                                                                                                       \
         /* Function that returns an iterator to the end of the multimap */                            \
         struct SNAME##_iter (*it_end)(struct SNAME *);                                                \
+                                                                                                      \
+        /* Custom allocation functions */                                                             \
+        struct cmc_alloc_node *alloc;                                                                 \
     };                                                                                                \
                                                                                                       \
     /* Multimap Entry */                                                                              \
@@ -140,6 +473,9 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         /* Entry Value */                                                                             \
         V value;                                                                                      \
                                                                                                       \
+        /* The hash of the key, only stored by CACHED tables */                                       \
+        CMC_IMPL_HASHTABLE_##HASHING(size_t hash;)                                                    \
+                                                                                                      \
         /* Next entry on the linked list */                                                           \
         struct SNAME##_entry *next;                                                                   \
                                                                                                       \
@@ -147,6 +483,19 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         struct SNAME##_entry *prev;                                                                   \
     };                                                                                                \
                                                                                                       \
+    /* Block of entries */                                                                            \
+    struct SNAME##_slab                                                                               \
+    {                                                                                                 \
+        /* Next (older) slab */                                                                       \
+        struct SNAME##_slab *next;                                                                    \
+                                                                                                      \
+        /* Amount of entries in this slab */                                                          \
+        size_t size;                                                                                  \
+                                                                                                      \
+        /* Entries storage */                                                                         \
+        struct SNAME##_entry entries[];                                                               \
+    };                                                                                                \
+                                                                                                      \
     struct SNAME##_iter                                                                               \
     {                                                                                                 \
         /* Target multimap */                                                                         \
@@ -177,14 +526,26 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
     /* Collection Functions */                                                                        \
     /* Collection Allocation and Deallocation */                                                      \
     struct SNAME *PFX##_new(size_t capacity, double load, int (*compare)(K, K), size_t (*hash)(K));   \
+    struct SNAME *PFX##_new_custom(size_t capacity, double load, int (*compare)(K, K),                \
+                                   size_t (*hash)(K), struct cmc_alloc_node *alloc);                  \
     void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V));                                 \
     void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V));                                  \
+    void PFX##_release(struct SNAME *_map_);                                                          \
     /* Collection Input and Output */                                                                 \
     bool PFX##_insert(struct SNAME *_map_, K key, V value);                                           \
     bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value);                         \
     size_t PFX##_update_all(struct SNAME *_map_, K key, V new_value, V **old_values);                 \
     bool PFX##_remove(struct SNAME *_map_, K key, V *out_value);                                      \
     size_t PFX##_remove_all(struct SNAME *_map_, K key, V **out_values);                              \
+    size_t PFX##_update_all_into(struct SNAME *_map_, K key, V new_value, V *old_values,              \
+                                 size_t capacity);                                                    \
+    size_t PFX##_update_all_each(struct SNAME *_map_, K key, V new_value,                             \
+                                 void (*callback)(V, void *), void *data);                            \
+    size_t PFX##_remove_all_into(struct SNAME *_map_, K key, V *out_values, size_t capacity);         \
+    size_t PFX##_remove_all_each(struct SNAME *_map_, K key, void (*callback)(V, void *),             \
+                                 void *data);                                                         \
+    size_t PFX##_remove_if(struct SNAME *_map_, bool (*pred)(K, V),                                   \
+                           void (*deallocator)(K, V));                                                \
     /* Element Access */                                                                              \
     bool PFX##_max(struct SNAME *_map_, K *key, V *value);                                            \
     bool PFX##_min(struct SNAME *_map_, K *key, V *value);                                            \
@@ -192,17 +553,30 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
     V *PFX##_get_ref(struct SNAME *_map_, K key);                                                     \
     /* Collection State */                                                                            \
     bool PFX##_contains(struct SNAME *_map_, K key);                                                  \
-    bool PFX##_empty(struct SNAME *_map_);                                                            \
+    CMC_PURE bool PFX##_empty(struct SNAME *_map_);                                                   \
     bool PFX##_full(struct SNAME *_map_);                                                             \
-    size_t PFX##_count(struct SNAME *_map_);                                                          \
+    CMC_PURE size_t PFX##_count(struct SNAME *_map_);                                                 \
+    size_t PFX##_memory_usage(struct SNAME *_map_);                                                   \
     size_t PFX##_key_count(struct SNAME *_map_, K key);                                               \
     size_t PFX##_capacity(struct SNAME *_map_);                                                       \
     double PFX##_load(struct SNAME *_map_);                                                           \
+    void PFX##_stats(struct SNAME *_map_, struct cmc_hashtable_stats *out);                           \
     /* Collection Utility */                                                                          \
     bool PFX##_resize(struct SNAME *_map_, size_t capacity);                                          \
+    bool PFX##_shrink_to_fit(struct SNAME *_map_);                                                    \
     struct SNAME *PFX##_copy_of(struct SNAME *_map_, K (*key_copy_func)(K), V (*value_copy_func)(V)); \
     bool PFX##_equals(struct SNAME *_map1_, struct SNAME *_map2_, bool ignore_key_count);             \
     struct cmc_string PFX##_to_string(struct SNAME *_map_);                                           \
+    bool PFX##_to_string_full(struct SNAME *_map_, struct cmc_string_builder *builder,                \
+                              const char *elem_fmt);                                                  \
+    bool PFX##_write(struct SNAME *_map_, FILE *file, void (*fmt)(FILE *, K, V));                     \
+    bool PFX##_write_fd(struct SNAME *_map_, int fd, void (*fmt)(struct cmc_dump *, K, V));           \
+    /* Collection Serialization */                                                                    \
+    bool PFX##_save(struct SNAME *_map_, FILE *file, bool (*key_writer)(K, FILE *),                   \
+                    bool (*value_writer)(V, FILE *));                                                 \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(K, K), size_t (*hash)(K),                  \
+                                bool (*key_reader)(K *, FILE *), bool (*value_reader)(V *, FILE *));  \
+                                                                                                      \
                                                                                                       \
     /* Iterator Functions */                                                                          \
     /* Iterator Allocation and Deallocation */                                                        \
@@ -228,17 +602,43 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
     size_t PFX##_iter_index(struct SNAME##_iter *iter);                                               \
                                                                                                       \
 /* SOURCE ********************************************************************/
-#define CMC_GENERATE_MULTIMAP_SOURCE(PFX, SNAME, K, V)                                               \
+#define CMC_IMPL_MULTIMAP_SOURCE(PFX, SNAME, K, V, HASHING, CMP, HASH)                               \
                                                                                                      \
     /* Implementation Detail Functions */                                                            \
-    struct SNAME##_entry *PFX##_impl_new_entry(K key, V value);                                      \
+    static inline int PFX##_impl_cmp(struct SNAME *_map_, K a, K b);                                 \
+    static inline size_t PFX##_impl_hash(struct SNAME *_map_, K key);                                \
+    struct SNAME##_entry *PFX##_impl_new_entry(struct SNAME *_map_, K key, V value, size_t hash);    \
+    static void PFX##_impl_release_entry(struct SNAME *_map_, struct SNAME##_entry *entry);          \
+    static bool PFX##_impl_new_slab(struct SNAME *_map_);                                            \
+    static void PFX##_impl_free_entries(struct SNAME *_map_, void (*deallocator)(K, V));             \
+    static void PFX##_impl_link_entry(struct SNAME *_map_, struct SNAME##_entry *entry,              \
+                                      size_t hash);                                                  \
     struct SNAME##_entry *PFX##_impl_get_entry(struct SNAME *_map_, K key);                          \
+    static size_t PFX##_impl_update_all(struct SNAME *_map_, K key, V new_value, V *old_values,      \
+                                        size_t capacity, void (*callback)(V, void *),                \
+                                        void *data);                                                 \
+    static size_t PFX##_impl_remove_all(struct SNAME *_map_, K key, V *out_values,                   \
+                                        size_t capacity, void (*callback)(V, void *),                \
+                                        void *data);                                                 \
+    static bool PFX##_impl_rehash(struct SNAME *_map_, size_t capacity);                             \
+    static void PFX##_impl_low_water(struct SNAME *_map_);                                           \
+    static bool PFX##_impl_shrink(struct SNAME *_map_, size_t required);                             \
     size_t PFX##_impl_calculate_size(size_t required);                                               \
+    static inline size_t PFX##_impl_home(struct SNAME *_map_, size_t hash);                          \
     static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_map_);                             \
     static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_map_);                               \
                                                                                                      \
     struct SNAME *PFX##_new(size_t capacity, double load, int (*compare)(K, K), size_t (*hash)(K))   \
     {                                                                                                \
+        return PFX##_new_custom(capacity, load, compare, hash, NULL);                                \
+    }                                                                                                \
+                                                                                                     \
+    struct SNAME *PFX##_new_custom(size_t capacity, double load, int (*compare)(K, K),               \
+                                   size_t (*hash)(K), struct cmc_alloc_node *alloc)                  \
+    {                                                                                                \
+        if (!alloc)                                                                                  \
+            alloc = &cmc_alloc_node_default;                                                         \
+                                                                                                     \
         if (capacity == 0 || load <= 0)                                                              \
             return NULL;                                                                             \
                                                                                                      \
@@ -248,24 +648,32 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                      \
         size_t real_capacity = PFX##_impl_calculate_size(capacity / load);                           \
                                                                                                      \
-        struct SNAME *_map_ = malloc(sizeof(struct SNAME));                                          \
+        struct SNAME *_map_ = alloc->malloc(sizeof(struct SNAME));                                   \
                                                                                                      \
-        if (!_map_)                                                                                  \
+        if (CMC_UNLIKELY(!_map_))                                                                    \
             return NULL;                                                                             \
                                                                                                      \
-        _map_->buffer = calloc(real_capacity, sizeof(struct SNAME##_entry * [2]));                   \
+        _map_->alloc = alloc;                                                                        \
+                                                                                                     \
+        _map_->buffer = alloc->calloc(real_capacity, sizeof(struct SNAME##_entry * [2]));            \
                                                                                                      \
-        if (!_map_->buffer)                                                                          \
+        if (CMC_UNLIKELY(!_map_->buffer))                                                            \
         {                                                                                            \
-            free(_map_);                                                                             \
+            alloc->free(_map_);                                                                      \
             return NULL;                                                                             \
         }                                                                                            \
                                                                                                      \
         _map_->count = 0;                                                                            \
         _map_->capacity = real_capacity;                                                             \
+        _map_->fastmod = cmc_fastmod_new(_map_->capacity);                                           \
         _map_->load = load;                                                                          \
         _map_->cmp = compare;                                                                        \
         _map_->hash = hash;                                                                          \
+        _map_->slabs = NULL;                                                                         \
+        _map_->slab_left = 0;                                                                        \
+        _map_->free_entries = NULL;                                                                  \
+                                                                                                     \
+        CMC_IMPL_HASHTABLE_PROBE_RESET(_map_);                                                       \
                                                                                                      \
         _map_->it_start = PFX##_impl_it_start;                                                       \
         _map_->it_end = PFX##_impl_it_end;                                                           \
@@ -275,40 +683,7 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                      \
     void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V))                                 \
     {                                                                                                \
-        size_t index = 0;                                                                            \
-        struct SNAME##_entry *scan;                                                                  \
-                                                                                                     \
-        while (index < _map_->capacity)                                                              \
-        {                                                                                            \
-            scan = _map_->buffer[index][0];                                                          \
-                                                                                                     \
-            if (scan != NULL)                                                                        \
-            {                                                                                        \
-                if (scan->next == NULL && scan->prev == NULL)                                        \
-                {                                                                                    \
-                    if (deallocator)                                                                 \
-                        deallocator(scan->key, scan->value);                                         \
-                                                                                                     \
-                    free(scan);                                                                      \
-                }                                                                                    \
-                else                                                                                 \
-                {                                                                                    \
-                    while (scan != NULL)                                                             \
-                    {                                                                                \
-                        struct SNAME##_entry *tmp = scan;                                            \
-                                                                                                     \
-                        scan = scan->next;                                                           \
-                                                                                                     \
-                        if (deallocator)                                                             \
-                            deallocator(tmp->key, tmp->value);                                       \
-                                                                                                     \
-                        free(tmp);                                                                   \
-                    }                                                                                \
-                }                                                                                    \
-            }                                                                                        \
-                                                                                                     \
-            index++;                                                                                 \
-        }                                                                                            \
+        PFX##_impl_free_entries(_map_, deallocator);                                                 \
                                                                                                      \
         memset(_map_->buffer, 0, sizeof(struct SNAME##_entry * [2]) * _map_->capacity);              \
                                                                                                      \
@@ -317,67 +692,36 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                      \
     void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V))                                  \
     {                                                                                                \
-        size_t index = 0;                                                                            \
-        struct SNAME##_entry *scan;                                                                  \
-                                                                                                     \
-        while (index < _map_->capacity)                                                              \
-        {                                                                                            \
-            scan = _map_->buffer[index][0];                                                          \
-                                                                                                     \
-            if (scan != NULL)                                                                        \
-            {                                                                                        \
-                if (scan->next == NULL && scan->prev == NULL)                                        \
-                    free(scan);                                                                      \
-                else                                                                                 \
-                {                                                                                    \
-                    while (scan != NULL)                                                             \
-                    {                                                                                \
-                        struct SNAME##_entry *tmp = scan;                                            \
-                                                                                                     \
-                        scan = scan->next;                                                           \
-                                                                                                     \
-                        if (deallocator)                                                             \
-                            deallocator(tmp->key, tmp->value);                                       \
-                                                                                                     \
-                        free(tmp);                                                                   \
-                    }                                                                                \
-                }                                                                                    \
-            }                                                                                        \
+        PFX##_impl_free_entries(_map_, deallocator);                                                 \
                                                                                                      \
-            index++;                                                                                 \
-        }                                                                                            \
+        _map_->alloc->free(_map_->buffer);                                                           \
+        _map_->alloc->free(_map_);                                                                   \
+    }                                                                                                \
                                                                                                      \
-        free(_map_->buffer);                                                                         \
-        free(_map_);                                                                                 \
+    /* Frees the collection without visiting its entries, for an allocator */                        \
+    /* that frees all of them at once like a cmc_arena */                                            \
+    void PFX##_release(struct SNAME *_map_)                                                          \
+    {                                                                                                \
+        _map_->alloc->free(_map_->buffer);                                                           \
+        _map_->alloc->free(_map_);                                                                   \
     }                                                                                                \
                                                                                                      \
     bool PFX##_insert(struct SNAME *_map_, K key, V value)                                           \
     {                                                                                                \
         if (PFX##_full(_map_))                                                                       \
         {                                                                                            \
-            if (!PFX##_resize(_map_, PFX##_capacity(_map_) + 1))                                     \
+            if (CMC_UNLIKELY(!PFX##_resize(_map_, PFX##_capacity(_map_) + 1)))                       \
                 return false;                                                                        \
         }                                                                                            \
                                                                                                      \
-        size_t hash = _map_->hash(key);                                                              \
-        size_t pos = hash % _map_->capacity;                                                         \
+        size_t hash = PFX##_impl_hash(_map_, key);                                                   \
                                                                                                      \
-        struct SNAME##_entry *entry = PFX##_impl_new_entry(key, value);                              \
-                                                                                                     \
-        if (_map_->buffer[pos][0] == NULL)                                                           \
-        {                                                                                            \
-            _map_->buffer[pos][0] = entry;                                                           \
-            _map_->buffer[pos][1] = entry;                                                           \
-        }                                                                                            \
-        else                                                                                         \
-        {                                                                                            \
-            entry->prev = _map_->buffer[pos][1];                                                     \
+        struct SNAME##_entry *entry = PFX##_impl_new_entry(_map_, key, value, hash);                 \
                                                                                                      \
-            _map_->buffer[pos][1]->next = entry;                                                     \
-            _map_->buffer[pos][1] = entry;                                                           \
-        }                                                                                            \
+        if (!entry)                                                                                  \
+            return false;                                                                            \
                                                                                                      \
-        _map_->count++;                                                                              \
+        PFX##_impl_link_entry(_map_, entry, hash);                                                   \
                                                                                                      \
         return true;                                                                                 \
     }                                                                                                \
@@ -399,46 +743,42 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                      \
     size_t PFX##_update_all(struct SNAME *_map_, K key, V new_value, V **old_values)                 \
     {                                                                                                \
+        if (!old_values)                                                                             \
+            return PFX##_impl_update_all(_map_, key, new_value, NULL, 0, NULL, NULL);                \
+                                                                                                     \
         size_t total = PFX##_key_count(_map_, key);                                                  \
-        size_t index = 0;                                                                            \
                                                                                                      \
         if (total == 0)                                                                              \
-            return total;                                                                            \
-                                                                                                     \
-        if (old_values)                                                                              \
-        {                                                                                            \
-            *old_values = malloc(sizeof(V) * total);                                                 \
-                                                                                                     \
-            if (!(*old_values))                                                                      \
-                return false;                                                                        \
-        }                                                                                            \
-                                                                                                     \
-        size_t hash = _map_->hash(key);                                                              \
+            return 0;                                                                                \
                                                                                                      \
-        struct SNAME##_entry *entry = _map_->buffer[hash % _map_->capacity][0];                      \
+        *old_values = _map_->alloc->malloc(sizeof(V) * total);                                       \
                                                                                                      \
-        while (entry != NULL)                                                                        \
-        {                                                                                            \
-            if (_map_->cmp(entry->key, key) == 0)                                                    \
-            {                                                                                        \
-                if (old_values)                                                                      \
-                    (*old_values)[index++] = entry->value;                                           \
+        if (!(*old_values))                                                                          \
+            return 0;                                                                                \
                                                                                                      \
-                entry->value = new_value;                                                            \
-            }                                                                                        \
+        return PFX##_impl_update_all(_map_, key, new_value, *old_values, total, NULL, NULL);         \
+    }                                                                                                \
                                                                                                      \
-            entry = entry->next;                                                                     \
-        }                                                                                            \
+    /* Writes the old values of the first capacity entries updated to the */                         \
+    /* given buffer and returns how many were updated, in a single pass */                           \
+    size_t PFX##_update_all_into(struct SNAME *_map_, K key, V new_value, V *old_values,             \
+                                 size_t capacity)                                                    \
+    {                                                                                                \
+        return PFX##_impl_update_all(_map_, key, new_value, old_values, capacity, NULL, NULL);       \
+    }                                                                                                \
                                                                                                      \
-        return index;                                                                                \
+    size_t PFX##_update_all_each(struct SNAME *_map_, K key, V new_value,                            \
+                                 void (*callback)(V, void *), void *data)                            \
+    {                                                                                                \
+        return PFX##_impl_update_all(_map_, key, new_value, NULL, 0, callback, data);                \
     }                                                                                                \
                                                                                                      \
     bool PFX##_remove(struct SNAME *_map_, K key, V *out_value)                                      \
     {                                                                                                \
-        size_t hash = _map_->hash(key);                                                              \
+        size_t hash = PFX##_impl_hash(_map_, key);                                                   \
                                                                                                      \
-        struct SNAME##_entry **head = &(_map_->buffer[hash % _map_->capacity][0]);                   \
-        struct SNAME##_entry **tail = &(_map_->buffer[hash % _map_->capacity][1]);                   \
+        struct SNAME##_entry **head = &(_map_->buffer[PFX##_impl_home(_map_, hash)][0]);             \
+        struct SNAME##_entry **tail = &(_map_->buffer[PFX##_impl_home(_map_, hash)][1]);             \
                                                                                                      \
         if (*head == NULL)                                                                           \
             return false;                                                                            \
@@ -447,7 +787,8 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                      \
         if (entry->next == NULL && entry->prev == NULL)                                              \
         {                                                                                            \
-            if (_map_->cmp(entry->key, key) == 0)                                                    \
+            if (CMC_IMPL_HASHTABLE_##HASHING##_EQUALS(entry->hash, hash) &&                          \
+                PFX##_impl_cmp(_map_, entry->key, key) == 0)                                         \
             {                                                                                        \
                 *head = NULL;                                                                        \
                 *tail = NULL;                                                                        \
@@ -464,7 +805,8 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                      \
             while (entry != NULL)                                                                    \
             {                                                                                        \
-                if (_map_->cmp(entry->key, key) == 0)                                                \
+                if (CMC_IMPL_HASHTABLE_##HASHING##_EQUALS(entry->hash, hash) &&                      \
+                    PFX##_impl_cmp(_map_, entry->key, key) == 0)                                     \
                 {                                                                                    \
                     if (*head == entry)                                                              \
                         *head = entry->next;                                                         \
@@ -491,74 +833,96 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                 return false;                                                                        \
         }                                                                                            \
                                                                                                      \
-        free(entry);                                                                                 \
+        PFX##_impl_release_entry(_map_, entry);                                                      \
                                                                                                      \
         _map_->count--;                                                                              \
                                                                                                      \
+        PFX##_impl_low_water(_map_);                                                                 \
+                                                                                                     \
         return true;                                                                                 \
     }                                                                                                \
                                                                                                      \
     size_t PFX##_remove_all(struct SNAME *_map_, K key, V **out_values)                              \
     {                                                                                                \
-        size_t hash = _map_->hash(key);                                                              \
+        if (!out_values)                                                                             \
+            return PFX##_impl_remove_all(_map_, key, NULL, 0, NULL, NULL);                           \
                                                                                                      \
-        struct SNAME##_entry **head = &(_map_->buffer[hash % _map_->capacity][0]);                   \
-        struct SNAME##_entry **tail = &(_map_->buffer[hash % _map_->capacity][1]);                   \
+        size_t total = PFX##_key_count(_map_, key);                                                  \
                                                                                                      \
-        if (*head == NULL)                                                                           \
+        if (total == 0)                                                                              \
             return 0;                                                                                \
                                                                                                      \
-        size_t total = PFX##_key_count(_map_, key);                                                  \
-        size_t index = 0;                                                                            \
+        *out_values = _map_->alloc->malloc(sizeof(V) * total);                                       \
                                                                                                      \
-        if (out_values)                                                                              \
-            *out_values = malloc(sizeof(struct SNAME##_entry) * total);                              \
+        if (!(*out_values))                                                                          \
+            return 0;                                                                                \
                                                                                                      \
-        struct SNAME##_entry *entry = *head;                                                         \
+        return PFX##_impl_remove_all(_map_, key, *out_values, total, NULL, NULL);                    \
+    }                                                                                                \
                                                                                                      \
-        if (entry->next == NULL)                                                                     \
-        {                                                                                            \
-            *head = NULL;                                                                            \
-            *tail = NULL;                                                                            \
+    /* Removes at most capacity entries, so a call with a full buffer can be */                      \
+    /* followed by another one to remove the rest */                                                 \
+    size_t PFX##_remove_all_into(struct SNAME *_map_, K key, V *out_values, size_t capacity)         \
+    {                                                                                                \
+        return PFX##_impl_remove_all(_map_, key, out_values, capacity, NULL, NULL);                  \
+    }                                                                                                \
                                                                                                      \
-            if (out_values)                                                                          \
-                (*out_values)[index++] = entry->value;                                               \
+    size_t PFX##_remove_all_each(struct SNAME *_map_, K key, void (*callback)(V, void *),            \
+                                 void *data)                                                         \
+    {                                                                                                \
+        return PFX##_impl_remove_all(_map_, key, NULL, 0, callback, data);                           \
+    }                                                                                                \
                                                                                                      \
-            free(entry);                                                                             \
-        }                                                                                            \
-        else                                                                                         \
+    /* Removes every entry for which pred is true, walking each bucket's */                          \
+    /* list once. Returns how many were removed */                                                   \
+    size_t PFX##_remove_if(struct SNAME *_map_, bool (*pred)(K, V),                                  \
+                           void (*deallocator)(K, V))                                                \
+    {                                                                                                \
+        size_t removed = 0;                                                                          \
+                                                                                                     \
+        for (size_t i = 0; i < _map_->capacity; i++)                                                 \
         {                                                                                            \
+            struct SNAME##_entry **head = &(_map_->buffer[i][0]);                                    \
+            struct SNAME##_entry **tail = &(_map_->buffer[i][1]);                                    \
+                                                                                                     \
+            struct SNAME##_entry *entry = *head;                                                     \
+                                                                                                     \
             while (entry != NULL)                                                                    \
             {                                                                                        \
-                if (_map_->cmp(entry->key, key) == 0)                                                \
+                struct SNAME##_entry *next = entry->next;                                            \
+                                                                                                     \
+                if (pred(entry->key, entry->value))                                                  \
                 {                                                                                    \
                     if (*head == entry)                                                              \
-                        *head = entry->next;                                                         \
+                        *head = next;                                                                \
                     if (*tail == entry)                                                              \
                         *tail = entry->prev;                                                         \
                                                                                                      \
-                    struct SNAME##_entry *temp = entry->next;                                        \
-                                                                                                     \
                     if (entry->prev != NULL)                                                         \
-                        entry->prev->next = entry->next;                                             \
-                    if (entry->next != NULL)                                                         \
-                        entry->next->prev = entry->prev;                                             \
+                        entry->prev->next = next;                                                    \
+                    if (next != NULL)                                                                \
+                        next->prev = entry->prev;                                                    \
                                                                                                      \
-                    if (out_values)                                                                  \
-                        (*out_values)[index++] = entry->value;                                       \
+                    if (deallocator)                                                                 \
+                        deallocator(entry->key, entry->value);                                       \
                                                                                                      \
-                    free(entry);                                                                     \
+                    PFX##_impl_release_entry(_map_, entry);                                          \
                                                                                                      \
-                    entry = temp;                                                                    \
+                    removed++;                                                                       \
                 }                                                                                    \
-                else                                                                                 \
-                    entry = entry->next;                                                             \
+                                                                                                     \
+                entry = next;                                                                        \
             }                                                                                        \
         }                                                                                            \
                                                                                                      \
-        _map_->count -= index;                                                                       \
+        if (removed > 0)                                                                             \
+        {                                                                                            \
+            _map_->count -= removed;                                                                 \
                                                                                                      \
-        return index;                                                                                \
+            PFX##_impl_low_water(_map_);                                                             \
+        }                                                                                            \
+                                                                                                     \
+        return removed;                                                                              \
     }                                                                                                \
                                                                                                      \
     bool PFX##_max(struct SNAME *_map_, K *key, V *value)                                            \
@@ -579,7 +943,7 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                 *key = result_key;                                                                   \
                 *value = result_value;                                                               \
             }                                                                                        \
-            else if (_map_->cmp(result_key, *key) > 0)                                               \
+            else if (PFX##_impl_cmp(_map_, result_key, *key) > 0)                                    \
             {                                                                                        \
                 *key = result_key;                                                                   \
                 *value = result_value;                                                               \
@@ -607,7 +971,7 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                 *key = result_key;                                                                   \
                 *value = result_value;                                                               \
             }                                                                                        \
-            else if (_map_->cmp(result_key, *key) < 0)                                               \
+            else if (PFX##_impl_cmp(_map_, result_key, *key) < 0)                                    \
             {                                                                                        \
                 *key = result_key;                                                                   \
                 *value = result_value;                                                               \
@@ -657,11 +1021,21 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return _map_->count;                                                                         \
     }                                                                                                \
                                                                                                      \
+    size_t PFX##_memory_usage(struct SNAME *_map_)                                                   \
+    {                                                                                                \
+        size_t bytes = sizeof(struct SNAME) + sizeof(struct SNAME##_entry * [2]) * _map_->capacity;  \
+                                                                                                     \
+        for (struct SNAME##_slab *slab = _map_->slabs; slab; slab = slab->next)                      \
+            bytes += sizeof(struct SNAME##_slab) + sizeof(struct SNAME##_entry) * slab->size;        \
+                                                                                                     \
+        return bytes;                                                                                \
+    }                                                                                                \
+                                                                                                     \
     size_t PFX##_key_count(struct SNAME *_map_, K key)                                               \
     {                                                                                                \
-        size_t hash = _map_->hash(key);                                                              \
+        size_t hash = PFX##_impl_hash(_map_, key);                                                   \
                                                                                                      \
-        struct SNAME##_entry *entry = _map_->buffer[hash % _map_->capacity][0];                      \
+        struct SNAME##_entry *entry = _map_->buffer[PFX##_impl_home(_map_, hash)][0];                \
                                                                                                      \
         size_t total_count = 0;                                                                      \
                                                                                                      \
@@ -670,7 +1044,8 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                      \
         while (entry != NULL)                                                                        \
         {                                                                                            \
-            if (_map_->cmp(entry->key, key) == 0)                                                    \
+            if (CMC_IMPL_HASHTABLE_##HASHING##_EQUALS(entry->hash, hash) &&                          \
+                PFX##_impl_cmp(_map_, entry->key, key) == 0)                                         \
                 total_count++;                                                                       \
                                                                                                      \
             entry = entry->next;                                                                     \
@@ -689,6 +1064,31 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return _map_->load;                                                                          \
     }                                                                                                \
                                                                                                      \
+    void PFX##_stats(struct SNAME *_map_, struct cmc_hashtable_stats *out)                           \
+    {                                                                                                \
+        memset(out, 0, sizeof(struct cmc_hashtable_stats));                                          \
+                                                                                                     \
+        out->capacity = _map_->capacity;                                                             \
+        out->count = _map_->count;                                                                   \
+        out->bytes = sizeof(struct SNAME) + sizeof(*_map_->buffer) * _map_->capacity;                \
+                                                                                                     \
+        for (struct SNAME##_slab *slab = _map_->slabs; slab; slab = slab->next)                      \
+            out->bytes += sizeof(struct SNAME##_slab) + sizeof(struct SNAME##_entry) * slab->size;   \
+                                                                                                     \
+        /* The distance of an entry is its position in the list of its bucket */                     \
+        for (size_t i = 0; i < _map_->capacity; i++)                                                 \
+        {                                                                                            \
+            size_t dist = 0;                                                                         \
+                                                                                                     \
+            for (struct SNAME##_entry *scan = _map_->buffer[i][0]; scan; scan = scan->next)          \
+                cmc_hashtable_stats_add(out, dist++);                                                \
+        }                                                                                            \
+                                                                                                     \
+        CMC_IMPL_HASHTABLE_PROBE_ADD(out, _map_);                                                    \
+                                                                                                     \
+        cmc_hashtable_stats_end(out);                                                                \
+    }                                                                                                \
+                                                                                                     \
     bool PFX##_resize(struct SNAME *_map_, size_t capacity)                                          \
     {                                                                                                \
         if (PFX##_capacity(_map_) == capacity)                                                       \
@@ -708,45 +1108,20 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         if (theoretical_size < PFX##_count(_map_) / PFX##_load(_map_))                               \
             return false;                                                                            \
                                                                                                      \
-        struct SNAME *_new_map_ = PFX##_new(capacity, PFX##_load(_map_), _map_->cmp, _map_->hash);   \
-                                                                                                     \
-        if (!_new_map_)                                                                              \
-            return false;                                                                            \
-                                                                                                     \
-        struct SNAME##_iter iter;                                                                    \
-                                                                                                     \
-        for (PFX##_iter_init(&iter, _map_); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))          \
-        {                                                                                            \
-            K key = PFX##_iter_key(&iter);                                                           \
-            V value = PFX##_iter_value(&iter);                                                       \
-                                                                                                     \
-            PFX##_insert(_new_map_, key, value);                                                     \
-        }                                                                                            \
-                                                                                                     \
-        if (PFX##_count(_map_) != PFX##_count(_new_map_))                                            \
-        {                                                                                            \
-            PFX##_free(_new_map_, NULL);                                                             \
-            return false;                                                                            \
-        }                                                                                            \
-                                                                                                     \
-        struct SNAME##_entry *(*tmp_b)[2] = _map_->buffer;                                           \
-        _map_->buffer = _new_map_->buffer;                                                           \
-        _new_map_->buffer = tmp_b;                                                                   \
-                                                                                                     \
-        size_t tmp_c = _map_->capacity;                                                              \
-        _map_->capacity = _new_map_->capacity;                                                       \
-        _new_map_->capacity = tmp_c;                                                                 \
-                                                                                                     \
-        PFX##_free(_new_map_, NULL);                                                                 \
+        return PFX##_impl_rehash(_map_, capacity);                                                   \
+    }                                                                                                \
                                                                                                      \
-        return true;                                                                                 \
+    bool PFX##_shrink_to_fit(struct SNAME *_map_)                                                    \
+    {                                                                                                \
+        return PFX##_impl_shrink(_map_, PFX##_count(_map_));                                         \
     }                                                                                                \
                                                                                                      \
     struct SNAME *PFX##_copy_of(struct SNAME *_map_, K (*key_copy_func)(K), V (*value_copy_func)(V)) \
     {                                                                                                \
-        struct SNAME *result = PFX##_new(_map_->capacity, _map_->load, _map_->cmp, _map_->hash);     \
+        struct SNAME *result = PFX##_new_custom(_map_->capacity, _map_->load, _map_->cmp,            \
+                                                _map_->hash, _map_->alloc);                          \
                                                                                                      \
-        if (!result)                                                                                 \
+        if (CMC_UNLIKELY(!result))                                                                   \
             return NULL;                                                                             \
                                                                                                      \
         struct SNAME##_iter iter;                                                                    \
@@ -817,11 +1192,78 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return str;                                                                                  \
     }                                                                                                \
                                                                                                      \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_ENTRY)                                   \
+                                                                                                     \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_ENTRY, (K, V))                                  \
+                                                                                                     \
+    bool PFX##_save(struct SNAME *_map_, FILE *file, bool (*key_writer)(K, FILE *),                  \
+                    bool (*value_writer)(V, FILE *))                                                 \
+    {                                                                                                \
+        uint32_t flags = (key_writer ? 0 : CMC_SERIAL_RAW_KEYS) |                                    \
+                         (value_writer ? 0 : CMC_SERIAL_RAW_VALUES);                                 \
+                                                                                                     \
+        if (!cmc_serial_write_header(file, "multimap", flags, sizeof(K), sizeof(V),                  \
+                                     0, _map_->count,                                                \
+                                     _map_->capacity, _map_->load))                                  \
+            return false;                                                                            \
+                                                                                                     \
+        /* Entries of a bucket are written in order so that the values of */                         \
+        /* each key keep their order when restored */                                                \
+        for (size_t i = 0; i < _map_->capacity; i++)                                                 \
+        {                                                                                            \
+            for (struct SNAME##_entry *entry = _map_->buffer[i][0]; entry; entry = entry->next)      \
+            {                                                                                        \
+                if (!CMC_SERIAL_WRITE(key_writer, entry->key, file) ||                               \
+                    !CMC_SERIAL_WRITE(value_writer, entry->value, file))                             \
+                    return false;                                                                    \
+            }                                                                                        \
+        }                                                                                            \
+                                                                                                     \
+        return true;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    /* Each reader is only used if the keys or values were saved with a writer */                    \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(K, K), size_t (*hash)(K),                 \
+                                bool (*key_reader)(K *, FILE *), bool (*value_reader)(V *, FILE *))  \
+    {                                                                                                \
+        struct cmc_serial_header header;                                                             \
+                                                                                                     \
+        if (!cmc_serial_read_header(file, "multimap", sizeof(K), sizeof(V), &header))                \
+            return NULL;                                                                             \
+                                                                                                     \
+        /* Allocated for every entry so that restoring never grows */                                \
+        struct SNAME *_map_ =                                                                        \
+            PFX##_new(header.count > 0 ? header.count : 1, header.load, compare, hash);              \
+                                                                                                     \
+        if (!_map_)                                                                                  \
+            return NULL;                                                                             \
+                                                                                                     \
+        bool raw_keys = header.flags & CMC_SERIAL_RAW_KEYS;                                          \
+        bool raw_values = header.flags & CMC_SERIAL_RAW_VALUES;                                      \
+                                                                                                     \
+        for (size_t i = 0; i < header.count; i++)                                                    \
+        {                                                                                            \
+            K key;                                                                                   \
+            V value;                                                                                 \
+                                                                                                     \
+            if (!CMC_SERIAL_READ(raw_keys, key_reader, &key, file) ||                                \
+                !CMC_SERIAL_READ(raw_values, value_reader, &value, file) ||                          \
+                !PFX##_insert(_map_, key, value))                                                    \
+            {                                                                                        \
+                PFX##_free(_map_, NULL);                                                             \
+                return NULL;                                                                         \
+            }                                                                                        \
+        }                                                                                            \
+                                                                                                     \
+        return _map_;                                                                                \
+    }                                                                                                \
+                                                                                                     \
+                                                                                                     \
     struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                        \
     {                                                                                                \
-        struct SNAME##_iter *iter = malloc(sizeof(struct SNAME##_iter));                             \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));              \
                                                                                                      \
-        if (!iter)                                                                                   \
+        if (CMC_UNLIKELY(!iter))                                                                     \
             return NULL;                                                                             \
                                                                                                      \
         PFX##_iter_init(iter, target);                                                               \
@@ -831,7 +1273,7 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                      \
     void PFX##_iter_free(struct SNAME##_iter *iter)                                                  \
     {                                                                                                \
-        free(iter);                                                                                  \
+        iter->target->alloc->free(iter);                                                             \
     }                                                                                                \
                                                                                                      \
     void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                            \
@@ -1052,30 +1494,127 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return iter->index;                                                                          \
     }                                                                                                \
                                                                                                      \
-    struct SNAME##_entry *PFX##_impl_new_entry(K key, V value)                                       \
+    struct SNAME##_entry *PFX##_impl_new_entry(struct SNAME *_map_, K key, V value, size_t hash)     \
     {                                                                                                \
-        struct SNAME##_entry *entry = malloc(sizeof(struct SNAME##_entry));                          \
+        struct SNAME##_entry *entry = _map_->free_entries;                                           \
                                                                                                      \
-        if (!entry)                                                                                  \
-            return NULL;                                                                             \
+        if (entry)                                                                                   \
+            _map_->free_entries = entry->next;                                                       \
+        else                                                                                         \
+        {                                                                                            \
+            if (_map_->slab_left == 0 && !PFX##_impl_new_slab(_map_))                                \
+                return NULL;                                                                         \
+                                                                                                     \
+            entry = &(_map_->slabs->entries[_map_->slabs->size - _map_->slab_left]);                 \
+                                                                                                     \
+            _map_->slab_left--;                                                                      \
+        }                                                                                            \
                                                                                                      \
         entry->key = key;                                                                            \
         entry->value = value;                                                                        \
         entry->next = NULL;                                                                          \
         entry->prev = NULL;                                                                          \
+        CMC_IMPL_HASHTABLE_##HASHING(entry->hash = hash;)                                            \
                                                                                                      \
         return entry;                                                                                \
     }                                                                                                \
                                                                                                      \
+    /* Gives back an entry that is no longer linked to any bucket */                                 \
+    static void PFX##_impl_release_entry(struct SNAME *_map_, struct SNAME##_entry *entry)           \
+    {                                                                                                \
+        entry->next = _map_->free_entries;                                                           \
+        entry->prev = NULL;                                                                          \
+                                                                                                     \
+        _map_->free_entries = entry;                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    static bool PFX##_impl_new_slab(struct SNAME *_map_)                                             \
+    {                                                                                                \
+        /* Doubling the slab size keeps the amount of slabs logarithmic */                           \
+        size_t size = _map_->slabs ? _map_->slabs->size * 2 : CMC_MULTIMAP_SLAB_SIZE;                \
+                                                                                                     \
+        struct SNAME##_slab *slab =                                                                  \
+            _map_->alloc->malloc(sizeof(struct SNAME##_slab) + sizeof(struct SNAME##_entry) * size); \
+                                                                                                     \
+        if (!slab)                                                                                   \
+            return false;                                                                            \
+                                                                                                     \
+        slab->next = _map_->slabs;                                                                   \
+        slab->size = size;                                                                           \
+                                                                                                     \
+        _map_->slabs = slab;                                                                         \
+        _map_->slab_left = size;                                                                     \
+                                                                                                     \
+        return true;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    /* Frees every slab, calling deallocator on each entry that is still in the map */               \
+    static void PFX##_impl_free_entries(struct SNAME *_map_, void (*deallocator)(K, V))              \
+    {                                                                                                \
+        if (deallocator)                                                                             \
+        {                                                                                            \
+            for (size_t i = 0; i < _map_->capacity; i++)                                             \
+            {                                                                                        \
+                for (struct SNAME##_entry *scan = _map_->buffer[i][0]; scan; scan = scan->next)      \
+                    deallocator(scan->key, scan->value);                                             \
+            }                                                                                        \
+        }                                                                                            \
+                                                                                                     \
+        struct SNAME##_slab *slab = _map_->slabs;                                                    \
+                                                                                                     \
+        while (slab != NULL)                                                                         \
+        {                                                                                            \
+            struct SNAME##_slab *next = slab->next;                                                  \
+                                                                                                     \
+            _map_->alloc->free(slab);                                                                \
+                                                                                                     \
+            slab = next;                                                                             \
+        }                                                                                            \
+                                                                                                     \
+        _map_->slabs = NULL;                                                                         \
+        _map_->slab_left = 0;                                                                        \
+        _map_->free_entries = NULL;                                                                  \
+    }                                                                                                \
+                                                                                                     \
+    /* Appends an entry to the end of the list of its bucket */                                      \
+    static void PFX##_impl_link_entry(struct SNAME *_map_, struct SNAME##_entry *entry,              \
+                                      size_t hash)                                                   \
+    {                                                                                                \
+        size_t pos = PFX##_impl_home(_map_, hash);                                                   \
+                                                                                                     \
+        entry->next = NULL;                                                                          \
+        entry->prev = NULL;                                                                          \
+                                                                                                     \
+        if (_map_->buffer[pos][0] == NULL)                                                           \
+        {                                                                                            \
+            _map_->buffer[pos][0] = entry;                                                           \
+            _map_->buffer[pos][1] = entry;                                                           \
+        }                                                                                            \
+        else                                                                                         \
+        {                                                                                            \
+            entry->prev = _map_->buffer[pos][1];                                                     \
+                                                                                                     \
+            _map_->buffer[pos][1]->next = entry;                                                     \
+            _map_->buffer[pos][1] = entry;                                                           \
+        }                                                                                            \
+                                                                                                     \
+        _map_->count++;                                                                              \
+    }                                                                                                \
+                                                                                                     \
     struct SNAME##_entry *PFX##_impl_get_entry(struct SNAME *_map_, K key)                           \
     {                                                                                                \
-        size_t hash = _map_->hash(key);                                                              \
+        size_t hash = PFX##_impl_hash(_map_, key);                                                   \
                                                                                                      \
-        struct SNAME##_entry *entry = _map_->buffer[hash % _map_->capacity][0];                      \
+        struct SNAME##_entry *entry = _map_->buffer[PFX##_impl_home(_map_, hash)][0];                \
+                                                                                                     \
+        CMC_IMPL_HASHTABLE_PROBE_LOOKUP(_map_);                                                      \
                                                                                                      \
         while (entry != NULL)                                                                        \
         {                                                                                            \
-            if (_map_->cmp(entry->key, key) == 0)                                                    \
+            CMC_IMPL_HASHTABLE_PROBE_SLOT(_map_);                                                    \
+                                                                                                     \
+            if (CMC_IMPL_HASHTABLE_##HASHING##_EQUALS(entry->hash, hash) &&                          \
+                PFX##_impl_cmp(_map_, entry->key, key) == 0)                                         \
                 return entry;                                                                        \
                                                                                                      \
             entry = entry->next;                                                                     \
@@ -1084,18 +1623,169 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return NULL;                                                                                 \
     }                                                                                                \
                                                                                                      \
-    size_t PFX##_impl_calculate_size(size_t required)                                                \
+    /* Updates every entry of key in a single pass over its chain, writing */                        \
+    /* the old values of the first capacity ones and giving each one to the */                       \
+    /* callback, if any */                                                                           \
+    static size_t PFX##_impl_update_all(struct SNAME *_map_, K key, V new_value, V *old_values,      \
+                                        size_t capacity, void (*callback)(V, void *),                \
+                                        void *data)                                                  \
+    {                                                                                                \
+        size_t hash = PFX##_impl_hash(_map_, key);                                                   \
+        size_t index = 0;                                                                            \
+                                                                                                     \
+        struct SNAME##_entry *entry = _map_->buffer[PFX##_impl_home(_map_, hash)][0];                \
+                                                                                                     \
+        for (; entry != NULL; entry = entry->next)                                                   \
+        {                                                                                            \
+            if (!CMC_IMPL_HASHTABLE_##HASHING##_EQUALS(entry->hash, hash) ||                         \
+                PFX##_impl_cmp(_map_, entry->key, key) != 0)                                         \
+                continue;                                                                            \
+                                                                                                     \
+            if (old_values && index < capacity)                                                      \
+                old_values[index] = entry->value;                                                    \
+            if (callback)                                                                            \
+                callback(entry->value, data);                                                        \
+                                                                                                     \
+            entry->value = new_value;                                                                \
+            index++;                                                                                 \
+        }                                                                                            \
+                                                                                                     \
+        return index;                                                                                \
+    }                                                                                                \
+                                                                                                     \
+    /* Removes the entries of key in a single pass over its chain, stopping */                       \
+    /* after capacity of them when there is a buffer to write them to, and */                        \
+    /* giving each one to the callback, if any */                                                    \
+    static size_t PFX##_impl_remove_all(struct SNAME *_map_, K key, V *out_values,                   \
+                                        size_t capacity, void (*callback)(V, void *),                \
+                                        void *data)                                                  \
+    {                                                                                                \
+        size_t hash = PFX##_impl_hash(_map_, key);                                                   \
+        size_t limit = out_values ? capacity : SIZE_MAX;                                             \
+        size_t index = 0;                                                                            \
+                                                                                                     \
+        struct SNAME##_entry **head = &(_map_->buffer[PFX##_impl_home(_map_, hash)][0]);             \
+        struct SNAME##_entry **tail = &(_map_->buffer[PFX##_impl_home(_map_, hash)][1]);             \
+                                                                                                     \
+        struct SNAME##_entry *entry = *head;                                                         \
+                                                                                                     \
+        while (entry != NULL && index < limit)                                                       \
+        {                                                                                            \
+            struct SNAME##_entry *next = entry->next;                                                \
+                                                                                                     \
+            if (CMC_IMPL_HASHTABLE_##HASHING##_EQUALS(entry->hash, hash) &&                          \
+                PFX##_impl_cmp(_map_, entry->key, key) == 0)                                         \
+            {                                                                                        \
+                if (*head == entry)                                                                  \
+                    *head = next;                                                                    \
+                if (*tail == entry)                                                                  \
+                    *tail = entry->prev;                                                             \
+                                                                                                     \
+                if (entry->prev != NULL)                                                             \
+                    entry->prev->next = next;                                                        \
+                if (next != NULL)                                                                    \
+                    next->prev = entry->prev;                                                        \
+                                                                                                     \
+                if (out_values)                                                                      \
+                    out_values[index] = entry->value;                                                \
+                if (callback)                                                                        \
+                    callback(entry->value, data);                                                    \
+                                                                                                     \
+                PFX##_impl_release_entry(_map_, entry);                                              \
+                                                                                                     \
+                index++;                                                                             \
+            }                                                                                        \
+                                                                                                     \
+            entry = next;                                                                            \
+        }                                                                                            \
+                                                                                                     \
+        if (index > 0)                                                                               \
+        {                                                                                            \
+            _map_->count -= index;                                                                   \
+                                                                                                     \
+            PFX##_impl_low_water(_map_);                                                             \
+        }                                                                                            \
+                                                                                                     \
+        return index;                                                                                \
+    }                                                                                                \
+                                                                                                     \
+    /* Moves every entry to a new buffer sized for capacity entries */                               \
+    static bool PFX##_impl_rehash(struct SNAME *_map_, size_t capacity)                              \
     {                                                                                                \
-        const size_t count = sizeof(cmc_hashtable_primes) / sizeof(cmc_hashtable_primes[0]);         \
+        struct SNAME *_new_map_ = PFX##_new_custom(capacity, PFX##_load(_map_), _map_->cmp,          \
+                                                   _map_->hash, _map_->alloc);                       \
+                                                                                                     \
+        if (CMC_UNLIKELY(!_new_map_))                                                                \
+            return false;                                                                            \
+                                                                                                     \
+        /* Entries are moved to the new buffer instead of being copied */                            \
+        for (size_t i = 0; i < _map_->capacity; i++)                                                 \
+        {                                                                                            \
+            struct SNAME##_entry *entry = _map_->buffer[i][0];                                       \
+                                                                                                     \
+            while (entry != NULL)                                                                    \
+            {                                                                                        \
+                struct SNAME##_entry *next = entry->next;                                            \
+                                                                                                     \
+                /* CACHED tables reuse the stored hash instead of calling hash() */                  \
+                size_t hash =                                                                        \
+                    CMC_IMPL_HASHTABLE_##HASHING##_REHASH(entry->hash,                               \
+                                                          PFX##_impl_hash(_map_, entry->key));       \
+                                                                                                     \
+                PFX##_impl_link_entry(_new_map_, entry, hash);                                       \
                                                                                                      \
-        if (cmc_hashtable_primes[count - 1] < required)                                              \
-            return required;                                                                         \
+                entry = next;                                                                        \
+            }                                                                                        \
                                                                                                      \
-        size_t i = 0;                                                                                \
-        while (cmc_hashtable_primes[i] < required)                                                   \
-            i++;                                                                                     \
+            _map_->buffer[i][0] = NULL;                                                              \
+            _map_->buffer[i][1] = NULL;                                                              \
+        }                                                                                            \
                                                                                                      \
-        return cmc_hashtable_primes[i];                                                              \
+        struct SNAME##_entry *(*tmp_b)[2] = _map_->buffer;                                           \
+        _map_->buffer = _new_map_->buffer;                                                           \
+        _new_map_->buffer = tmp_b;                                                                   \
+                                                                                                     \
+        size_t tmp_c = _map_->capacity;                                                              \
+        _map_->capacity = _new_map_->capacity;                                                       \
+        _new_map_->capacity = tmp_c;                                                                 \
+        _map_->fastmod = cmc_fastmod_new(_map_->capacity);                                           \
+        _new_map_->fastmod = cmc_fastmod_new(_new_map_->capacity);                                   \
+                                                                                                     \
+        PFX##_free(_new_map_, NULL);                                                                 \
+                                                                                                     \
+        return true;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    /* Called after removals, shrinks the table once it is mostly empty */                           \
+    static void PFX##_impl_low_water(struct SNAME *_map_)                                            \
+    {                                                                                                \
+        double low_water = cmc_hashtable_low_water(_map_->load);                                     \
+                                                                                                     \
+        /* Left with room for as many again so it is not grown right back */                         \
+        if ((double)_map_->count < (double)_map_->capacity * _map_->load * low_water)                \
+            PFX##_impl_shrink(_map_, _map_->count * 2);                                              \
+    }                                                                                                \
+                                                                                                     \
+    /* Rebuilds the table at the smallest size that holds required entries */                        \
+    static bool PFX##_impl_shrink(struct SNAME *_map_, size_t required)                              \
+    {                                                                                                \
+        size_t capacity = required > 0 ? required : 1;                                               \
+                                                                                                     \
+        /* Already as small as the sizing policy allows */                                           \
+        if (PFX##_impl_calculate_size(capacity / PFX##_load(_map_)) >= PFX##_capacity(_map_))        \
+            return true;                                                                             \
+                                                                                                     \
+        return PFX##_impl_rehash(_map_, capacity);                                                   \
+    }                                                                                                \
+                                                                                                     \
+    size_t PFX##_impl_calculate_size(size_t required)                                                \
+    {                                                                                                \
+        return cmc_hashtable_prime_size(required);                                                   \
+    }                                                                                                \
+                                                                                                     \
+    static inline size_t PFX##_impl_home(struct SNAME *_map_, size_t hash)                           \
+    {                                                                                                \
+        return CMC_IMPL_HASHTABLE_PRIME_TABLE_HOME(hash, _map_);                                     \
     }                                                                                                \
                                                                                                      \
     static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_map_)                              \
@@ -1115,6 +1805,20 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         PFX##_iter_to_end(&iter);                                                                    \
                                                                                                      \
         return iter;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    static inline int PFX##_impl_cmp(struct SNAME *_map_, K a, K b)                                  \
+    {                                                                                                \
+        (void)_map_;                                                                                 \
+                                                                                                     \
+        return CMP(a, b);                                                                            \
+    }                                                                                                \
+                                                                                                     \
+    static inline size_t PFX##_impl_hash(struct SNAME *_map_, K key)                                 \
+    {                                                                                                \
+        (void)_map_;                                                                                 \
+                                                                                                     \
+        return HASH(key);                                                                            \
     }
 
 #endif /* CMC_MULTIMAP_H */
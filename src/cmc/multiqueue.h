@@ -0,0 +1,389 @@
+/**
+ * multiqueue.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * MultiQueue
+ *
+ * A MultiQueue is a relaxed priority queue that can be shared between
+ * threads. It is made of several Heaps, each protected by its own mutex, so
+ * threads that work on different heaps never wait for each other. An element
+ * is inserted in a random heap. A removal samples two random heaps and takes
+ * the top of the better one, so it does not always return the best element
+ * of the whole queue but one that is close to it, which is enough for best
+ * effort priorities like those of job schedulers. Unlike a single heap
+ * behind a lock, throughput keeps growing with the amount of threads.
+ *
+ * Locks are taken with trylock first and another random heap is picked when
+ * one is busy. Having two to four heaps per thread keeps contention low. The
+ * rank of a removed element among all elements is on average proportional
+ * to the amount of heaps.
+ *
+ * remove only returns false once every heap was seen empty. There are no
+ * iterators as they would outlive the locks. Requires pthreads.
+ */
+
+#ifndef CMC_MULTIQUEUE_H
+#define CMC_MULTIQUEUE_H
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+#include "heap.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_multiqueue = "%s at %p { shards:%p, shard_count:%" PRIuMAX ", type:%s, cmp:%p }";
+
+/* Shards are aligned and padded to this size to avoid false sharing */
+#ifndef CMC_CACHE_LINE_SIZE
+#define CMC_CACHE_LINE_SIZE 64
+#endif
+
+/* Random shards that are tried without waiting for their lock before */
+/* waiting for the last one */
+#ifndef CMC_MULTIQUEUE_TRIES
+#define CMC_MULTIQUEUE_TRIES 4
+#endif
+
+#define CMC_GENERATE_MULTIQUEUE(PFX, SNAME, V)    \
+    CMC_GENERATE_MULTIQUEUE_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_MULTIQUEUE_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_MULTIQUEUE_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_MULTIQUEUE_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_MULTIQUEUE_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_MULTIQUEUE_SOURCE(PFX, SNAME, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_MULTIQUEUE_HEADER(PFX, SNAME, V)                                      \
+                                                                                           \
+    /* The Heap used by each shard */                                                      \
+    CMC_GENERATE_HEAP_HEADER(PFX##_shard_heap, SNAME##_shard_heap, V)                      \
+                                                                                           \
+    /* MultiQueue Structure */                                                             \
+    struct SNAME                                                                           \
+    {                                                                                      \
+        /* Array of shards */                                                              \
+        struct SNAME##_shard *shards;                                                      \
+                                                                                           \
+        /* How many shards there are, always a power of 2 */                               \
+        size_t shard_count;                                                                \
+                                                                                           \
+        /* Heap order (MaxHeap or MinHeap) */                                              \
+        enum cmc_heap_order HO;                                                            \
+                                                                                           \
+        /* Element comparison function */                                                  \
+        int (*cmp)(V, V);                                                                  \
+                                                                                           \
+        /* Custom allocation functions */                                                  \
+        struct cmc_alloc_node *alloc;                                                      \
+    };                                                                                     \
+                                                                                           \
+    /* A Heap and the lock that protects it */                                             \
+    struct SNAME##_shard                                                                   \
+    {                                                                                      \
+        pthread_mutex_t lock;                                                              \
+                                                                                           \
+        struct SNAME##_shard_heap *heap;                                                   \
+                                                                                           \
+        /* Fills the rest of the cache line */                                             \
+        char padding[CMC_CACHE_LINE_SIZE -                                                 \
+                     (sizeof(pthread_mutex_t) + sizeof(void *)) % CMC_CACHE_LINE_SIZE];    \
+    };                                                                                     \
+                                                                                           \
+    /* Collection Functions */                                                             \
+    /* Collection Allocation and Deallocation */                                           \
+    struct SNAME *PFX##_new(size_t shards, size_t capacity, enum cmc_heap_order HO,        \
+                            int (*compare)(V, V));                                         \
+    struct SNAME *PFX##_new_custom(size_t shards, size_t capacity, enum cmc_heap_order HO, \
+                                   int (*compare)(V, V), struct cmc_alloc_node *alloc);    \
+    void PFX##_clear(struct SNAME *_queue_, void (*deallocator)(V));                       \
+    void PFX##_free(struct SNAME *_queue_, void (*deallocator)(V));                        \
+    /* Collection Input and Output */                                                      \
+    bool PFX##_insert(struct SNAME *_queue_, V element);                                   \
+    bool PFX##_remove(struct SNAME *_queue_, V *result);                                   \
+    /* Collection State */                                                                 \
+    bool PFX##_empty(struct SNAME *_queue_);                                               \
+    size_t PFX##_count(struct SNAME *_queue_);                                             \
+    size_t PFX##_memory_usage(struct SNAME *_queue_);                                      \
+    /* Collection Utility */                                                               \
+    struct cmc_string PFX##_to_string(struct SNAME *_queue_);
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_MULTIQUEUE_SOURCE(PFX, SNAME, V)                                       \
+                                                                                            \
+    CMC_GENERATE_HEAP_SOURCE(PFX##_shard_heap, SNAME##_shard_heap, V)                       \
+                                                                                            \
+    /* Implementation Detail Functions */                                                   \
+    static size_t PFX##_impl_random(void);                                                  \
+    static struct SNAME##_shard *PFX##_impl_lock_any(struct SNAME *_queue_);                \
+    static bool PFX##_impl_better(struct SNAME *_queue_, struct SNAME##_shard *a,           \
+                                  struct SNAME##_shard *b);                                 \
+                                                                                            \
+    struct SNAME *PFX##_new(size_t shards, size_t capacity, enum cmc_heap_order HO,         \
+                            int (*compare)(V, V))                                           \
+    {                                                                                       \
+        return PFX##_new_custom(shards, capacity, HO, compare, NULL);                       \
+    }                                                                                       \
+                                                                                            \
+    struct SNAME *PFX##_new_custom(size_t shards, size_t capacity, enum cmc_heap_order HO,  \
+                                   int (*compare)(V, V), struct cmc_alloc_node *alloc)      \
+    {                                                                                       \
+        if (!alloc)                                                                         \
+            alloc = &cmc_alloc_node_default;                                                \
+                                                                                            \
+        if (shards == 0 || capacity == 0)                                                   \
+            return NULL;                                                                    \
+                                                                                            \
+        if (HO != cmc_min_heap && HO != cmc_max_heap)                                       \
+            return NULL;                                                                    \
+                                                                                            \
+        size_t shard_count = 1;                                                             \
+                                                                                            \
+        while (shard_count < shards)                                                        \
+            shard_count *= 2;                                                               \
+                                                                                            \
+        struct SNAME *_queue_ = alloc->malloc(sizeof(struct SNAME));                        \
+                                                                                            \
+        if (CMC_UNLIKELY(!_queue_))                                                         \
+            return NULL;                                                                    \
+                                                                                            \
+        _queue_->alloc = alloc;                                                             \
+                                                                                            \
+        _queue_->shards =                                                                   \
+            cmc_alloc_aligned(alloc, CMC_CACHE_LINE_SIZE,                                   \
+                              sizeof(struct SNAME##_shard) * shard_count);                  \
+                                                                                            \
+        if (!_queue_->shards)                                                               \
+        {                                                                                   \
+            alloc->free(_queue_);                                                           \
+            return NULL;                                                                    \
+        }                                                                                   \
+                                                                                            \
+        size_t shard_capacity = capacity / shard_count + 1;                                 \
+                                                                                            \
+        for (size_t i = 0; i < shard_count; i++)                                            \
+        {                                                                                   \
+            struct SNAME##_shard *shard = &(_queue_->shards[i]);                            \
+                                                                                            \
+            shard->heap = PFX##_shard_heap_new_custom(shard_capacity, HO, compare, alloc);  \
+                                                                                            \
+            if (!shard->heap || pthread_mutex_init(&(shard->lock), NULL) != 0)              \
+            {                                                                               \
+                if (shard->heap)                                                            \
+                    PFX##_shard_heap_free(shard->heap, NULL);                               \
+                                                                                            \
+                for (size_t j = 0; j < i; j++)                                              \
+                {                                                                           \
+                    pthread_mutex_destroy(&(_queue_->shards[j].lock));                      \
+                    PFX##_shard_heap_free(_queue_->shards[j].heap, NULL);                   \
+                }                                                                           \
+                                                                                            \
+                cmc_alloc_aligned_free(alloc, _queue_->shards);                             \
+                alloc->free(_queue_);                                                       \
+                return NULL;                                                                \
+            }                                                                               \
+        }                                                                                   \
+                                                                                            \
+        _queue_->shard_count = shard_count;                                                 \
+        _queue_->HO = HO;                                                                   \
+        _queue_->cmp = compare;                                                             \
+                                                                                            \
+        return _queue_;                                                                     \
+    }                                                                                       \
+                                                                                            \
+    void PFX##_clear(struct SNAME *_queue_, void (*deallocator)(V))                         \
+    {                                                                                       \
+        for (size_t i = 0; i < _queue_->shard_count; i++)                                   \
+        {                                                                                   \
+            struct SNAME##_shard *shard = &(_queue_->shards[i]);                            \
+                                                                                            \
+            pthread_mutex_lock(&(shard->lock));                                             \
+            PFX##_shard_heap_clear(shard->heap, deallocator);                               \
+            pthread_mutex_unlock(&(shard->lock));                                           \
+        }                                                                                   \
+    }                                                                                       \
+                                                                                            \
+    void PFX##_free(struct SNAME *_queue_, void (*deallocator)(V))                          \
+    {                                                                                       \
+        for (size_t i = 0; i < _queue_->shard_count; i++)                                   \
+        {                                                                                   \
+            pthread_mutex_destroy(&(_queue_->shards[i].lock));                              \
+            PFX##_shard_heap_free(_queue_->shards[i].heap, deallocator);                    \
+        }                                                                                   \
+                                                                                            \
+        cmc_alloc_aligned_free(_queue_->alloc, _queue_->shards);                            \
+        _queue_->alloc->free(_queue_);                                                      \
+    }                                                                                       \
+                                                                                            \
+    bool PFX##_insert(struct SNAME *_queue_, V element)                                     \
+    {                                                                                       \
+        struct SNAME##_shard *shard = PFX##_impl_lock_any(_queue_);                         \
+                                                                                            \
+        bool result = PFX##_shard_heap_insert(shard->heap, element);                        \
+        pthread_mutex_unlock(&(shard->lock));                                               \
+                                                                                            \
+        return result;                                                                      \
+    }                                                                                       \
+                                                                                            \
+    /* Removes the top of the better of two random shards. If both are empty */             \
+    /* every shard is looked at before the queue is taken as empty */                       \
+    bool PFX##_remove(struct SNAME *_queue_, V *result)                                     \
+    {                                                                                       \
+        struct SNAME##_shard *first = PFX##_impl_lock_any(_queue_);                         \
+        struct SNAME##_shard *second = NULL;                                                \
+                                                                                            \
+        if (_queue_->shard_count > 1)                                                       \
+        {                                                                                   \
+            size_t mask = _queue_->shard_count - 1;                                         \
+            size_t index = (size_t)(first - _queue_->shards);                               \
+                                                                                            \
+            /* Any shard other than the first one */                                        \
+            second = &(_queue_->shards[(index + 1 + PFX##_impl_random() % mask) & mask]);   \
+                                                                                            \
+            /* A busy shard is not waited for, as another thread is using it */             \
+            if (pthread_mutex_trylock(&(second->lock)) != 0)                                \
+                second = NULL;                                                              \
+        }                                                                                   \
+                                                                                            \
+        struct SNAME##_shard *best = first;                                                 \
+                                                                                            \
+        if (second && PFX##_impl_better(_queue_, second, first))                            \
+            best = second;                                                                  \
+                                                                                            \
+        bool removed = PFX##_shard_heap_remove(best->heap, result);                         \
+                                                                                            \
+        if (second)                                                                         \
+            pthread_mutex_unlock(&(second->lock));                                          \
+                                                                                            \
+        pthread_mutex_unlock(&(first->lock));                                               \
+                                                                                            \
+        for (size_t i = 0; i < _queue_->shard_count && !removed; i++)                       \
+        {                                                                                   \
+            struct SNAME##_shard *shard = &(_queue_->shards[i]);                            \
+                                                                                            \
+            pthread_mutex_lock(&(shard->lock));                                             \
+            removed = PFX##_shard_heap_remove(shard->heap, result);                         \
+            pthread_mutex_unlock(&(shard->lock));                                           \
+        }                                                                                   \
+                                                                                            \
+        return removed;                                                                     \
+    }                                                                                       \
+                                                                                            \
+    bool PFX##_empty(struct SNAME *_queue_)                                                 \
+    {                                                                                       \
+        return PFX##_count(_queue_) == 0;                                                   \
+    }                                                                                       \
+                                                                                            \
+    /* Shards are locked one at a time so the result is only exact when */                  \
+    /* no other thread is modifying the queue */                                            \
+    size_t PFX##_count(struct SNAME *_queue_)                                               \
+    {                                                                                       \
+        size_t count = 0;                                                                   \
+                                                                                            \
+        for (size_t i = 0; i < _queue_->shard_count; i++)                                   \
+        {                                                                                   \
+            struct SNAME##_shard *shard = &(_queue_->shards[i]);                            \
+                                                                                            \
+            pthread_mutex_lock(&(shard->lock));                                             \
+            count += PFX##_shard_heap_count(shard->heap);                                   \
+            pthread_mutex_unlock(&(shard->lock));                                           \
+        }                                                                                   \
+                                                                                            \
+        return count;                                                                       \
+    }                                                                                       \
+                                                                                            \
+    size_t PFX##_memory_usage(struct SNAME *_queue_)                                        \
+    {                                                                                       \
+        size_t shards = sizeof(struct SNAME##_shard) * _queue_->shard_count;                \
+                                                                                            \
+        size_t bytes = sizeof(struct SNAME) +                                               \
+                       cmc_alloc_aligned_size(CMC_CACHE_LINE_SIZE, shards);                 \
+                                                                                            \
+        for (size_t i = 0; i < _queue_->shard_count; i++)                                   \
+        {                                                                                   \
+            struct SNAME##_shard *shard = &(_queue_->shards[i]);                            \
+                                                                                            \
+            pthread_mutex_lock(&(shard->lock));                                             \
+            bytes += PFX##_shard_heap_memory_usage(shard->heap);                            \
+            pthread_mutex_unlock(&(shard->lock));                                           \
+        }                                                                                   \
+                                                                                            \
+        return bytes;                                                                       \
+    }                                                                                       \
+                                                                                            \
+    struct cmc_string PFX##_to_string(struct SNAME *_queue_)                                \
+    {                                                                                       \
+        struct cmc_string str;                                                              \
+        struct SNAME *q_ = _queue_;                                                         \
+        const char *name = #SNAME;                                                          \
+                                                                                            \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_multiqueue, name, q_, q_->shards,    \
+                 q_->shard_count, q_->HO == cmc_min_heap ? "MinHeap" : "MaxHeap", q_->cmp); \
+                                                                                            \
+        return str;                                                                         \
+    }                                                                                       \
+                                                                                            \
+    /* The state of each thread starts from the address of its own copy of it */            \
+    static size_t PFX##_impl_random(void)                                                   \
+    {                                                                                       \
+        static _Thread_local uint64_t state = 0;                                            \
+                                                                                            \
+        if (state == 0)                                                                     \
+            state = ((uint64_t)(uintptr_t)&state * UINT64_C(0x9E3779B97F4A7C15)) | 1;       \
+                                                                                            \
+        state ^= state << 13;                                                               \
+        state ^= state >> 7;                                                                \
+        state ^= state << 17;                                                               \
+                                                                                            \
+        return (size_t)(state >> 16);                                                       \
+    }                                                                                       \
+                                                                                            \
+    /* Locks a random shard, trying others while they are busy, and returns it */           \
+    static struct SNAME##_shard *PFX##_impl_lock_any(struct SNAME *_queue_)                 \
+    {                                                                                       \
+        size_t mask = _queue_->shard_count - 1;                                             \
+        struct SNAME##_shard *shard = NULL;                                                 \
+                                                                                            \
+        for (size_t i = 0; i < CMC_MULTIQUEUE_TRIES; i++)                                   \
+        {                                                                                   \
+            shard = &(_queue_->shards[PFX##_impl_random() & mask]);                         \
+                                                                                            \
+            if (pthread_mutex_trylock(&(shard->lock)) == 0)                                 \
+                return shard;                                                               \
+        }                                                                                   \
+                                                                                            \
+        pthread_mutex_lock(&(shard->lock));                                                 \
+                                                                                            \
+        return shard;                                                                       \
+    }                                                                                       \
+                                                                                            \
+    /* If the top of a comes before the one of b, where both are locked */                  \
+    static bool PFX##_impl_better(struct SNAME *_queue_, struct SNAME##_shard *a,           \
+                                  struct SNAME##_shard *b)                                  \
+    {                                                                                       \
+        if (PFX##_shard_heap_empty(a->heap))                                                \
+            return false;                                                                   \
+                                                                                            \
+        if (PFX##_shard_heap_empty(b->heap))                                                \
+            return true;                                                                    \
+                                                                                            \
+        V top_a = PFX##_shard_heap_peek(a->heap);                                           \
+        V top_b = PFX##_shard_heap_peek(b->heap);                                           \
+                                                                                            \
+        return _queue_->cmp(top_a, top_b) * _queue_->HO > 0;                                \
+    }
+
+#endif /* CMC_MULTIQUEUE_H */
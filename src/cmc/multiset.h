@@ -22,15 +22,26 @@
 #define CMC_MULTISET_H
 
 #include <inttypes.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_serial.h"
 #include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
 
 /* to_string format */
 static const char *cmc_string_fmt_multiset = "%s at %p { buffer:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", cardinality:%" PRIuMAX ", load:%lf, cmp:%p, hash:%p }";
 
+/* A removal shrinks a collection once less than this fraction of what it */
+/* can hold without growing is in use. Define it as 0 to never shrink */
+#ifndef CMC_SHRINK_LOW_WATER
+#define CMC_SHRINK_LOW_WATER 0.25
+#endif
+
 #ifndef CMC_IMPL_HASHTABLE_STATE
 #define CMC_IMPL_HASHTABLE_STATE
 
@@ -41,6 +52,17 @@ enum cmc_entry_state
     CMC_ES_FILLED = 1
 };
 
+/* The state of an entry and its distance to its original position are packed */
+/* together as bit-fields. Only tables bigger than CMC_ES_DIST_MAX can have a */
+/* distance that does not fit and these grow instead of storing it */
+#if UINT_MAX >= 0xFFFFFFFF
+#define CMC_ES_DIST_BITS 30
+#else
+#define CMC_ES_DIST_BITS 14
+#endif
+
+#define CMC_ES_DIST_MAX (((size_t)1 << CMC_ES_DIST_BITS) - 1)
+
 #endif /* CMC_IMPL_HASHTABLE_STATE */
 
 #ifndef CMC_IMPL_HASHTABLE_SETUP
@@ -78,20 +100,331 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                               6917529027641081903,
                                               13835058055282163729llu};
 
+/* Smallest prime from cmc_hashtable_primes that is greater or equal to */
+/* required, found with a binary search. Used by the default (prime sized) */
+/* hashtables */
+static inline size_t cmc_hashtable_prime_size(size_t required)
+{
+    const size_t count = sizeof(cmc_hashtable_primes) / sizeof(cmc_hashtable_primes[0]);
+
+    if (cmc_hashtable_primes[count - 1] < required)
+        return required;
+
+    size_t low = 0;
+    size_t high = count - 1;
+
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+
+        if (cmc_hashtable_primes[mid] < required)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return cmc_hashtable_primes[low];
+}
+
+/* Prime sized tables reduce a hash to a slot with Lemire's fastmod, which */
+/* replaces the division of the modulo with a few multiplications by a */
+/* multiplier computed once for every capacity. Without 128 bit integers */
+/* the multiplier is not used and the modulo is kept */
+#if defined(__SIZEOF_INT128__) && SIZE_MAX == UINT64_MAX
+__extension__ typedef unsigned __int128 cmc_fastmod;
+
+static inline cmc_fastmod cmc_fastmod_new(size_t divisor)
+{
+    return divisor > 0 ? ~(cmc_fastmod)0 / divisor + 1 : 0;
+}
+
+static inline size_t cmc_fastmod_reduce(size_t value, cmc_fastmod multiplier, size_t divisor)
+{
+    /* The fractional part of value / divisor, multiplied by divisor */
+    cmc_fastmod fraction = multiplier * value;
+    cmc_fastmod low = ((fraction & UINT64_MAX) * divisor) >> 64;
+    cmc_fastmod high = (fraction >> 64) * divisor;
+
+    return (size_t)((low + high) >> 64);
+}
+#else
+typedef size_t cmc_fastmod;
+
+static inline cmc_fastmod cmc_fastmod_new(size_t divisor)
+{
+    (void)divisor;
+    return 0;
+}
+
+static inline size_t cmc_fastmod_reduce(size_t value, cmc_fastmod multiplier, size_t divisor)
+{
+    (void)multiplier;
+    return value % divisor;
+}
+#endif
+
+/* Smallest power of two that is greater or equal to required. Used by the */
+/* hashtables generated with the POW2 variants */
+static inline size_t cmc_hashtable_pow2_size(size_t required)
+{
+    size_t size = 64;
+
+    while (size < required && size <= SIZE_MAX / 2)
+        size <<= 1;
+
+    return size;
+}
+
+/* Power of two hashtables only look at the lower bits of a hash so they are */
+/* first passed through this finalizer (from MurmurHash3) to spread the */
+/* entropy of the upper bits */
+static inline size_t cmc_hashtable_mix(size_t hash)
+{
+    uint64_t h = (uint64_t)hash;
+
+    h ^= h >> 33;
+    h *= UINT64_C(0xff51afd7ed558ccd);
+    h ^= h >> 33;
+    h *= UINT64_C(0xc4ceb9fe1a85ec53);
+    h ^= h >> 33;
+
+    return (size_t)h;
+}
+
+/* Fraction of what a hashtable can hold under which a removal shrinks it. */
+/* Tables grow by a factor of 1 / load, so right after growing one is only */
+/* load full, and the mark is kept under half of that so that a table that */
+/* just grew is not shrunk by the next removals */
+static inline double cmc_hashtable_low_water(double load)
+{
+    return CMC_SHRINK_LOW_WATER < load / 2 ? CMC_SHRINK_LOW_WATER : load / 2;
+}
+
+/* Sizing policies selected by the SIZING parameter of the generators. PRIME */
+/* tables reduce a hash with a modulo and POW2 tables mix it and mask it */
+#define CMC_IMPL_HASHTABLE_PRIME_SIZE(required) cmc_hashtable_prime_size(required)
+#define CMC_IMPL_HASHTABLE_PRIME_HOME(hash, capacity) ((hash) % (capacity))
+#define CMC_IMPL_HASHTABLE_PRIME_WRAP(pos, capacity) ((pos) % (capacity))
+
+#define CMC_IMPL_HASHTABLE_POW2_SIZE(required) cmc_hashtable_pow2_size(required)
+#define CMC_IMPL_HASHTABLE_POW2_HOME(hash, capacity) (cmc_hashtable_mix(hash) & ((capacity)-1))
+#define CMC_IMPL_HASHTABLE_POW2_WRAP(pos, capacity) ((pos) & ((capacity)-1))
+
+/* The same for a table, where PRIME tables use the fastmod multiplier kept */
+/* next to their capacity */
+#define CMC_IMPL_HASHTABLE_PRIME_TABLE_HOME(hash, table) \
+    cmc_fastmod_reduce(hash, (table)->fastmod, (table)->capacity)
+#define CMC_IMPL_HASHTABLE_PRIME_TABLE_WRAP(pos, table) \
+    cmc_fastmod_reduce(pos, (table)->fastmod, (table)->capacity)
+
+#define CMC_IMPL_HASHTABLE_POW2_TABLE_HOME(hash, table) \
+    CMC_IMPL_HASHTABLE_POW2_HOME(hash, (table)->capacity)
+#define CMC_IMPL_HASHTABLE_POW2_TABLE_WRAP(pos, table) \
+    CMC_IMPL_HASHTABLE_POW2_WRAP(pos, (table)->capacity)
+
+/* Hashing policies selected by the HASHING parameter of the generators. */
+/* CACHED tables store the full hash of every key in its entry so that it */
+/* is compared before the keys themselves and reused when resizing */
+#define CMC_IMPL_HASHTABLE_CACHED(...) __VA_ARGS__
+#define CMC_IMPL_HASHTABLE_CACHED_EQUALS(cached, hash) ((cached) == (hash))
+#define CMC_IMPL_HASHTABLE_CACHED_REHASH(cached, computed) (cached)
+
+#define CMC_IMPL_HASHTABLE_UNCACHED(...)
+#define CMC_IMPL_HASHTABLE_UNCACHED_EQUALS(cached, hash) true
+#define CMC_IMPL_HASHTABLE_UNCACHED_REHASH(cached, computed) (computed)
+
+/* Batched lookups hash and prefetch the home slots of this many keys before */
+/* resolving any of their probes */
+#define CMC_IMPL_HASHTABLE_BATCH 16
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CMC_IMPL_HASHTABLE_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define CMC_IMPL_HASHTABLE_PREFETCH(address)
+#endif
+
 #endif /* CMC_IMPL_HASHTABLE_SETUP */
 
+#ifndef CMC_IMPL_HASHTABLE_STATS
+#define CMC_IMPL_HASHTABLE_STATS
+
+/* Amount of buckets of the histogram of distances of cmc_hashtable_stats. */
+/* The last bucket also counts every entry that is further away */
+#ifndef CMC_HASHTABLE_STATS_BUCKETS
+#define CMC_HASHTABLE_STATS_BUCKETS 16
+#endif
+
+/* Health of a hashtable, as reported by the stats function of every */
+/* hashtable collection */
+struct cmc_hashtable_stats
+{
+    /* Amount of slots (or buckets) of the table */
+    size_t capacity;
+
+    /* Amount of entries in the table */
+    size_t count;
+
+    /* Slots that are marked as deleted and still take part in probes */
+    size_t tombstones;
+
+    /* Current load, count / capacity */
+    double load;
+
+    /* Greatest distance of an entry to its original position */
+    size_t max_dist;
+
+    /* Average distance of an entry to its original position */
+    double mean_dist;
+
+    /* Amount of entries at each distance to their original position */
+    size_t histogram[CMC_HASHTABLE_STATS_BUCKETS];
+
+    /* Bytes allocated by the collection, not counting what K and V own */
+    size_t bytes;
+
+    /* Lookups done since the table was created */
+    size_t lookups;
+
+    /* Entries compared by these lookups */
+    size_t probes;
+};
+
+/* Adds the distance of an entry to stats. Until cmc_hashtable_stats_end() */
+/* is called mean_dist holds the sum of all distances */
+static inline void cmc_hashtable_stats_add(struct cmc_hashtable_stats *stats, size_t dist)
+{
+    if (dist < CMC_HASHTABLE_STATS_BUCKETS)
+        stats->histogram[dist]++;
+    else
+        stats->histogram[CMC_HASHTABLE_STATS_BUCKETS - 1]++;
+
+    if (dist > stats->max_dist)
+        stats->max_dist = dist;
+
+    stats->mean_dist += (double)dist;
+}
+
+/* Adds the finished stats of another table to stats, for collections made */
+/* of more than one hashtable */
+static inline void cmc_hashtable_stats_merge(struct cmc_hashtable_stats *stats,
+                                             struct cmc_hashtable_stats *other)
+{
+    size_t entries = 0;
+
+    for (size_t i = 0; i < CMC_HASHTABLE_STATS_BUCKETS; i++)
+    {
+        stats->histogram[i] += other->histogram[i];
+        entries += other->histogram[i];
+    }
+
+    if (other->max_dist > stats->max_dist)
+        stats->max_dist = other->max_dist;
+
+    stats->mean_dist += other->mean_dist * (double)entries;
+    stats->capacity += other->capacity;
+    stats->count += other->count;
+    stats->tombstones += other->tombstones;
+    stats->bytes += other->bytes;
+    stats->lookups += other->lookups;
+    stats->probes += other->probes;
+}
+
+/* Turns the sum of distances of stats into their mean and computes the load */
+static inline void cmc_hashtable_stats_end(struct cmc_hashtable_stats *stats)
+{
+    size_t entries = 0;
+
+    for (size_t i = 0; i < CMC_HASHTABLE_STATS_BUCKETS; i++)
+        entries += stats->histogram[i];
+
+    if (entries > 0)
+        stats->mean_dist /= (double)entries;
+
+    if (stats->capacity > 0)
+        stats->load = (double)stats->count / (double)stats->capacity;
+}
+
+/* Defining CMC_HASHTABLE_PROBE_STATS before including any hashtable makes */
+/* every table count its lookups and the entries they compare, reported as */
+/* lookups and probes by cmc_hashtable_stats. The counters are not atomic */
+/* so lookups that run concurrently without a lock are counted loosely */
+#ifdef CMC_HASHTABLE_PROBE_STATS
+#define CMC_IMPL_HASHTABLE_PROBE_FIELDS size_t lookups; size_t probes;
+#define CMC_IMPL_HASHTABLE_PROBE_RESET(table) ((table)->lookups = 0, (table)->probes = 0)
+#define CMC_IMPL_HASHTABLE_PROBE_LOOKUP(table) ((table)->lookups++)
+#define CMC_IMPL_HASHTABLE_PROBE_SLOT(table) ((table)->probes++)
+#define CMC_IMPL_HASHTABLE_PROBE_ADD(to, from) \
+    ((to)->lookups += (from)->lookups, (to)->probes += (from)->probes)
+#else
+#define CMC_IMPL_HASHTABLE_PROBE_FIELDS
+#define CMC_IMPL_HASHTABLE_PROBE_RESET(table) ((void)0)
+#define CMC_IMPL_HASHTABLE_PROBE_LOOKUP(table) ((void)0)
+#define CMC_IMPL_HASHTABLE_PROBE_SLOT(table) ((void)0)
+#define CMC_IMPL_HASHTABLE_PROBE_ADD(to, from) ((void)0)
+#endif
+
+#endif /* CMC_IMPL_HASHTABLE_STATS */
+
 #define CMC_GENERATE_MULTISET(PFX, SNAME, V)    \
     CMC_GENERATE_MULTISET_HEADER(PFX, SNAME, V) \
     CMC_GENERATE_MULTISET_SOURCE(PFX, SNAME, V)
 
+/* Same as CMC_GENERATE_MULTISET but tables are sized to powers of two */
+#define CMC_GENERATE_MULTISET_POW2(PFX, SNAME, V) \
+    CMC_GENERATE_MULTISET_HEADER(PFX, SNAME, V)   \
+    CMC_GENERATE_MULTISET_POW2_SOURCE(PFX, SNAME, V)
+
+/* Same as CMC_GENERATE_MULTISET but entries also store the hash of their element */
+#define CMC_GENERATE_MULTISET_CACHED(PFX, SNAME, V)    \
+    CMC_GENERATE_MULTISET_CACHED_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_MULTISET_CACHED_SOURCE(PFX, SNAME, V)
+
+/* Same as CMC_GENERATE_MULTISET but elements are compared and hashed by */
+/* calling CMP and HASH directly, so the compiler can inline them. The */
+/* functions given to new are still stored but only used by copy_of and */
+/* to_string */
+#define CMC_GENERATE_MULTISET_EX(PFX, SNAME, V, CMP, HASH) \
+    CMC_GENERATE_MULTISET_HEADER(PFX, SNAME, V)            \
+    CMC_GENERATE_MULTISET_EX_SOURCE(PFX, SNAME, V, CMP, HASH)
+
 #define CMC_WRAPGEN_MULTISET_HEADER(PFX, SNAME, K, V) \
     CMC_GENERATE_MULTISET_HEADER(PFX, SNAME, V)
 
 #define CMC_WRAPGEN_MULTISET_SOURCE(PFX, SNAME, K, V) \
     CMC_GENERATE_MULTISET_SOURCE(PFX, SNAME, V)
 
+#define CMC_WRAPGEN_MULTISET_POW2_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_MULTISET_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_MULTISET_POW2_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_MULTISET_POW2_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_MULTISET_CACHED_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_MULTISET_CACHED_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_MULTISET_CACHED_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_MULTISET_CACHED_SOURCE(PFX, SNAME, V)
+
+#define CMC_GENERATE_MULTISET_HEADER(PFX, SNAME, V) \
+    CMC_IMPL_MULTISET_HEADER(PFX, SNAME, V, UNCACHED)
+
+#define CMC_GENERATE_MULTISET_CACHED_HEADER(PFX, SNAME, V) \
+    CMC_IMPL_MULTISET_HEADER(PFX, SNAME, V, CACHED)
+
+#define CMC_GENERATE_MULTISET_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_MULTISET_SOURCE(PFX, SNAME, V, PRIME, UNCACHED, _set_->cmp, _set_->hash)
+
+#define CMC_GENERATE_MULTISET_POW2_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_MULTISET_SOURCE(PFX, SNAME, V, POW2, UNCACHED, _set_->cmp, _set_->hash)
+
+#define CMC_GENERATE_MULTISET_CACHED_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_MULTISET_SOURCE(PFX, SNAME, V, PRIME, CACHED, _set_->cmp, _set_->hash)
+
+#define CMC_GENERATE_MULTISET_EX_SOURCE(PFX, SNAME, V, CMP, HASH) \
+    CMC_IMPL_MULTISET_SOURCE(PFX, SNAME, V, PRIME, UNCACHED, CMP, HASH)
+
 /* HEADER ********************************************************************/
-#define CMC_GENERATE_MULTISET_HEADER(PFX, SNAME, V)                                          \
+#define CMC_IMPL_MULTISET_HEADER(PFX, SNAME, V, HASHING)                                     \
                                                                                              \
     /* Hashset Structure */                                                                  \
     struct SNAME                                                                             \
@@ -101,6 +434,8 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                              \
         /* Current Array Capcity */                                                          \
         size_t capacity;                                                                     \
+        /* Multiplier of the capacity that reduces a hash to a slot */                       \
+        cmc_fastmod fastmod;                                                                 \
                                                                                              \
         /* Current amount of unique elements */                                              \
         size_t count;                                                                        \
@@ -117,11 +452,17 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         /* Element hash function */                                                          \
         size_t (*hash)(V);                                                                   \
                                                                                              \
+        /* Lookup counters, only present with CMC_HASHTABLE_PROBE_STATS */                   \
+        CMC_IMPL_HASHTABLE_PROBE_FIELDS                                                      \
+                                                                                             \
         /* Function that returns an iterator to the start of the hashset */                  \
         struct SNAME##_iter (*it_start)(struct SNAME *);                                     \
                                                                                              \
         /* Function that returns an iterator to the end of the hashset */                    \
         struct SNAME##_iter (*it_end)(struct SNAME *);                                       \
+                                                                                             \
+        /* Custom allocation functions */                                                    \
+        struct cmc_alloc_node *alloc;                                                        \
     };                                                                                       \
                                                                                              \
     struct SNAME##_entry                                                                     \
@@ -132,11 +473,14 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         /* The element's multiplicity */                                                     \
         size_t multiplicity;                                                                 \
                                                                                              \
+        /* The hash of the element, only stored by CACHED tables */                          \
+        CMC_IMPL_HASHTABLE_##HASHING(size_t hash;)                                           \
+                                                                                             \
         /* The distance of this node to its original position, used by robin-hood hashing */ \
-        size_t dist;                                                                         \
+        unsigned int dist : CMC_ES_DIST_BITS;                                                \
                                                                                              \
         /* The sate of this node (DELETED, EMPTY, FILLED) */                                 \
-        enum cmc_entry_state state;                                                          \
+        signed int state : 2;                                                                \
     };                                                                                       \
                                                                                              \
     /* Hashset Iterator */                                                                   \
@@ -168,31 +512,49 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
     /* Collection Allocation and Deallocation */                                             \
     struct SNAME *PFX##_new(size_t capacity, double load, int (*compare)(V, V),              \
                             size_t (*hash)(V));                                              \
+    struct SNAME *PFX##_new_custom(size_t capacity, double load, int (*compare)(V, V),       \
+                                   size_t (*hash)(V), struct cmc_alloc_node *alloc);         \
     void PFX##_clear(struct SNAME *_set_, void (*deallocator)(V));                           \
     void PFX##_free(struct SNAME *_set_, void (*deallocator)(V));                            \
     /* Collection Input and Output */                                                        \
     bool PFX##_insert(struct SNAME *_set_, V element);                                       \
     bool PFX##_insert_many(struct SNAME *_set_, V element, size_t count);                    \
+    size_t PFX##_insert_array(struct SNAME *_set_, V *elements, size_t n);                   \
     bool PFX##_update(struct SNAME *_set_, V element, size_t multiplicity);                  \
     bool PFX##_remove(struct SNAME *_set_, V element);                                       \
     size_t PFX##_remove_all(struct SNAME *_set_, V element);                                 \
+    size_t PFX##_remove_if(struct SNAME *_set_, bool (*pred)(V), void (*deallocator)(V));    \
     /* Element Access */                                                                     \
     bool PFX##_max(struct SNAME *_set_, V *value);                                           \
     bool PFX##_min(struct SNAME *_set_, V *value);                                           \
     size_t PFX##_multiplicity_of(struct SNAME *_set_, V element);                            \
+    size_t PFX##_most_common(struct SNAME *_set_, size_t n, V *values,                       \
+                             size_t *multiplicities);                                        \
     /* Collection State */                                                                   \
     bool PFX##_contains(struct SNAME *_set_, V element);                                     \
-    bool PFX##_empty(struct SNAME *_set_);                                                   \
+    CMC_PURE bool PFX##_empty(struct SNAME *_set_);                                          \
     bool PFX##_full(struct SNAME *_set_);                                                    \
-    size_t PFX##_count(struct SNAME *_set_);                                                 \
+    CMC_PURE size_t PFX##_count(struct SNAME *_set_);                                        \
+    size_t PFX##_memory_usage(struct SNAME *_set_);                                          \
     size_t PFX##_cardinality(struct SNAME *_set_);                                           \
     size_t PFX##_capacity(struct SNAME *_set_);                                              \
     double PFX##_load(struct SNAME *_set_);                                                  \
+    void PFX##_stats(struct SNAME *_set_, struct cmc_hashtable_stats *out);                  \
     /* Collection Utility */                                                                 \
     bool PFX##_resize(struct SNAME *_set_, size_t capacity);                                 \
+    bool PFX##_shrink_to_fit(struct SNAME *_set_);                                           \
     struct SNAME *PFX##_copy_of(struct SNAME *_set_, V (*copy_func)(V));                     \
     bool PFX##_equals(struct SNAME *_set1_, struct SNAME *_set2_, bool ignore_multiplicity); \
     struct cmc_string PFX##_to_string(struct SNAME *_set_);                                  \
+    bool PFX##_to_string_full(struct SNAME *_set_, struct cmc_string_builder *builder,       \
+                              const char *elem_fmt);                                         \
+    bool PFX##_write(struct SNAME *_set_, FILE *file, void (*fmt)(FILE *, V));               \
+    bool PFX##_write_fd(struct SNAME *_set_, int fd, void (*fmt)(struct cmc_dump *, V));     \
+    /* Collection Serialization */                                                           \
+    bool PFX##_save(struct SNAME *_set_, FILE *file, bool (*writer)(V, FILE *));             \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(V, V), size_t (*hash)(V),         \
+                                bool (*reader)(V *, FILE *));                                \
+                                                                                             \
                                                                                              \
     /* Set Operations */                                                                     \
     struct SNAME *PFX##_union(struct SNAME *_set1_, struct SNAME *_set2_);                   \
@@ -200,6 +562,13 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
     struct SNAME *PFX##_difference(struct SNAME *_set1_, struct SNAME *_set2_);              \
     struct SNAME *PFX##_summation(struct SNAME *_set1_, struct SNAME *_set2_);               \
     struct SNAME *PFX##_symmetric_difference(struct SNAME *_set1_, struct SNAME *_set2_);    \
+    bool PFX##_union_into(struct SNAME *_set1_, struct SNAME *_set2_);                       \
+    bool PFX##_merge(struct SNAME *_set1_, struct SNAME *_set2_,                             \
+                     size_t (*combine)(size_t, size_t));                                     \
+    bool PFX##_merge_free(struct SNAME *_set1_, struct SNAME *_set2_,                        \
+                          size_t (*combine)(size_t, size_t), void (*deallocator)(V));        \
+    bool PFX##_intersect_with(struct SNAME *_set1_, struct SNAME *_set2_);                   \
+    void PFX##_subtract(struct SNAME *_set1_, struct SNAME *_set2_);                         \
     bool PFX##_is_subset(struct SNAME *_set1_, struct SNAME *_set2_);                        \
     bool PFX##_is_superset(struct SNAME *_set1_, struct SNAME *_set2_);                      \
     bool PFX##_is_proper_subset(struct SNAME *_set1_, struct SNAME *_set2_);                 \
@@ -229,18 +598,49 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
     size_t PFX##_iter_index(struct SNAME##_iter *iter);                                      \
                                                                                              \
 /* SOURCE ********************************************************************/
-#define CMC_GENERATE_MULTISET_SOURCE(PFX, SNAME, V)                                                \
+#define CMC_IMPL_MULTISET_SOURCE(PFX, SNAME, V, SIZING, HASHING, CMP, HASH)                        \
                                                                                                    \
     /* Implementation Detail Functions */                                                          \
+    static inline int PFX##_impl_cmp(struct SNAME *_set_, V a, V b);                               \
+    static inline size_t PFX##_impl_hash(struct SNAME *_set_, V value);                            \
     static struct SNAME##_entry *PFX##_impl_insert_and_return(struct SNAME *_set_, V element,      \
                                                               bool *new_node);                     \
     static struct SNAME##_entry *PFX##_impl_get_entry(struct SNAME *_set_, V element);             \
+    static struct SNAME##_entry *PFX##_impl_get_entry_by_hash(struct SNAME *_set_, V element,      \
+                                                              size_t hash);                        \
+    static struct SNAME##_entry *PFX##_impl_insert_entry(struct SNAME *_set_, V element,           \
+                                                         size_t multiplicity, size_t hash);        \
+    static bool PFX##_impl_dist_overflow(struct SNAME *_set_, size_t hash);                        \
+    static void PFX##_impl_remove_entry(struct SNAME *_set_, struct SNAME##_entry *entry);         \
+    static struct SNAME *PFX##_impl_new_sized(struct SNAME *_set_, size_t count);                  \
+    static bool PFX##_impl_shrink_entry(struct SNAME *_set_, struct SNAME##_entry *entry,          \
+                                        size_t multiplicity);                                      \
+    static bool PFX##_impl_rehash(struct SNAME *_set_, size_t capacity);                           \
+    static void PFX##_impl_low_water(struct SNAME *_set_);                                         \
+    static bool PFX##_impl_shrink(struct SNAME *_set_, size_t required);                           \
+    static void PFX##_impl_common_sift(V *values, size_t *multiplicities, size_t count,            \
+                                       size_t i);                                                  \
+    static struct SNAME *PFX##_impl_load_layout(FILE *file, int (*compare)(V, V),                  \
+                                                size_t (*hash)(V),                                 \
+                                                struct cmc_serial_header *header);                 \
+                                                                                                   \
     static size_t PFX##_impl_calculate_size(size_t required);                                      \
+    static inline size_t PFX##_impl_home(struct SNAME *_set_, size_t hash);                        \
+    static inline size_t PFX##_impl_wrap(struct SNAME *_set_, size_t pos);                         \
     static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_set_);                           \
     static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_set_);                             \
                                                                                                    \
     struct SNAME *PFX##_new(size_t capacity, double load, int (*compare)(V, V), size_t (*hash)(V)) \
     {                                                                                              \
+        return PFX##_new_custom(capacity, load, compare, hash, NULL);                              \
+    }                                                                                              \
+                                                                                                   \
+    struct SNAME *PFX##_new_custom(size_t capacity, double load, int (*compare)(V, V),             \
+                                   size_t (*hash)(V), struct cmc_alloc_node *alloc)                \
+    {                                                                                              \
+        if (!alloc)                                                                                \
+            alloc = &cmc_alloc_node_default;                                                       \
+                                                                                                   \
         if (capacity == 0 || load <= 0 || load >= 1)                                               \
             return NULL;                                                                           \
                                                                                                    \
@@ -250,26 +650,31 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
         size_t real_capacity = PFX##_impl_calculate_size(capacity / load);                         \
                                                                                                    \
-        struct SNAME *_set_ = malloc(sizeof(struct SNAME));                                        \
+        struct SNAME *_set_ = alloc->malloc(sizeof(struct SNAME));                                 \
                                                                                                    \
-        if (!_set_)                                                                                \
+        if (CMC_UNLIKELY(!_set_))                                                                  \
             return NULL;                                                                           \
                                                                                                    \
-        _set_->buffer = calloc(real_capacity, sizeof(struct SNAME##_entry));                       \
+        _set_->alloc = alloc;                                                                      \
                                                                                                    \
-        if (!_set_->buffer)                                                                        \
+        _set_->buffer = alloc->calloc(real_capacity, sizeof(struct SNAME##_entry));                \
+                                                                                                   \
+        if (CMC_UNLIKELY(!_set_->buffer))                                                          \
         {                                                                                          \
-            free(_set_);                                                                           \
+            alloc->free(_set_);                                                                    \
             return NULL;                                                                           \
         }                                                                                          \
                                                                                                    \
         _set_->count = 0;                                                                          \
         _set_->cardinality = 0;                                                                    \
         _set_->capacity = real_capacity;                                                           \
+        _set_->fastmod = cmc_fastmod_new(_set_->capacity);                                         \
         _set_->load = load;                                                                        \
         _set_->cmp = compare;                                                                      \
         _set_->hash = hash;                                                                        \
                                                                                                    \
+        CMC_IMPL_HASHTABLE_PROBE_RESET(_set_);                                                     \
+                                                                                                   \
         _set_->it_start = PFX##_impl_it_start;                                                     \
         _set_->it_end = PFX##_impl_it_end;                                                         \
                                                                                                    \
@@ -311,8 +716,8 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
             }                                                                                      \
         }                                                                                          \
                                                                                                    \
-        free(_set_->buffer);                                                                       \
-        free(_set_);                                                                               \
+        _set_->alloc->free(_set_->buffer);                                                         \
+        _set_->alloc->free(_set_);                                                                 \
     }                                                                                              \
                                                                                                    \
     bool PFX##_insert(struct SNAME *_set_, V element)                                              \
@@ -354,6 +759,23 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return true;                                                                               \
     }                                                                                              \
                                                                                                    \
+    size_t PFX##_insert_array(struct SNAME *_set_, V *elements, size_t n)                          \
+    {                                                                                              \
+        /* Grow once for every element instead of one threshold at a time */                       \
+        if (CMC_UNLIKELY(!PFX##_resize(_set_, PFX##_count(_set_) + n)))                            \
+            return 0;                                                                              \
+                                                                                                   \
+        size_t total = 0;                                                                          \
+                                                                                                   \
+        for (size_t i = 0; i < n; i++)                                                             \
+        {                                                                                          \
+            if (PFX##_insert(_set_, elements[i]))                                                  \
+                total++;                                                                           \
+        }                                                                                          \
+                                                                                                   \
+        return total;                                                                              \
+    }                                                                                              \
+                                                                                                   \
     bool PFX##_update(struct SNAME *_set_, V element, size_t multiplicity)                         \
     {                                                                                              \
         if (multiplicity == 0)                                                                     \
@@ -387,16 +809,15 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
             result->multiplicity--;                                                                \
         else                                                                                       \
         {                                                                                          \
-            result->value = (V){0};                                                                \
-            result->multiplicity = 0;                                                              \
-            result->dist = 0;                                                                      \
-            result->state = CMC_ES_DELETED;                                                        \
+            PFX##_impl_remove_entry(_set_, result);                                                \
                                                                                                    \
             _set_->count--;                                                                        \
         }                                                                                          \
                                                                                                    \
         _set_->cardinality--;                                                                      \
                                                                                                    \
+        PFX##_impl_low_water(_set_);                                                               \
+                                                                                                   \
         return true;                                                                               \
     }                                                                                              \
                                                                                                    \
@@ -409,14 +830,54 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
         size_t removed = result->multiplicity;                                                     \
                                                                                                    \
-        result->value = (V){0};                                                                    \
-        result->multiplicity = 0;                                                                  \
-        result->dist = 0;                                                                          \
-        result->state = CMC_ES_DELETED;                                                            \
+        PFX##_impl_remove_entry(_set_, result);                                                    \
                                                                                                    \
         _set_->count--;                                                                            \
         _set_->cardinality -= removed;                                                             \
                                                                                                    \
+        PFX##_impl_low_water(_set_);                                                               \
+                                                                                                   \
+        return removed;                                                                            \
+    }                                                                                              \
+                                                                                                   \
+    /* Removes every element for which pred is true, along with all of its */                      \
+    /* copies, in a single sweep of the buffer. The deallocator is called */                       \
+    /* once per element. Returns how many were removed taking into account */                      \
+    /* their multiplicity, like remove_all */                                                      \
+    size_t PFX##_remove_if(struct SNAME *_set_, bool (*pred)(V), void (*deallocator)(V))           \
+    {                                                                                              \
+        size_t unique = 0;                                                                         \
+        size_t removed = 0;                                                                        \
+                                                                                                   \
+        /* Backward shift deletion moves the following entry into the slot */                      \
+        /* that was just emptied, so the same position is checked again */                         \
+        for (size_t i = 0; i < _set_->capacity;)                                                   \
+        {                                                                                          \
+            struct SNAME##_entry *entry = &(_set_->buffer[i]);                                     \
+                                                                                                   \
+            if (entry->state == CMC_ES_FILLED && pred(entry->value))                               \
+            {                                                                                      \
+                V value = entry->value;                                                            \
+                                                                                                   \
+                removed += entry->multiplicity;                                                    \
+                                                                                                   \
+                PFX##_impl_remove_entry(_set_, entry);                                             \
+                                                                                                   \
+                if (deallocator)                                                                   \
+                    deallocator(value);                                                            \
+                                                                                                   \
+                unique++;                                                                          \
+            }                                                                                      \
+            else                                                                                   \
+                i++;                                                                               \
+        }                                                                                          \
+                                                                                                   \
+        _set_->count -= unique;                                                                    \
+        _set_->cardinality -= removed;                                                             \
+                                                                                                   \
+        if (unique > 0)                                                                            \
+            PFX##_impl_low_water(_set_);                                                           \
+                                                                                                   \
         return removed;                                                                            \
     }                                                                                              \
                                                                                                    \
@@ -434,7 +895,7 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
             if (index == 0)                                                                        \
                 *value = result;                                                                   \
-            else if (_set_->cmp(result, *value) > 0)                                               \
+            else if (PFX##_impl_cmp(_set_, result, *value) > 0)                                    \
                 *value = result;                                                                   \
         }                                                                                          \
                                                                                                    \
@@ -455,7 +916,7 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
             if (index == 0)                                                                        \
                 *value = result;                                                                   \
-            else if (_set_->cmp(result, *value) < 0)                                               \
+            else if (PFX##_impl_cmp(_set_, result, *value) < 0)                                    \
                 *value = result;                                                                   \
         }                                                                                          \
                                                                                                    \
@@ -472,6 +933,66 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return entry->multiplicity;                                                                \
     }                                                                                              \
                                                                                                    \
+    /* Writes the n elements with the greatest multiplicities to values, and */                    \
+    /* their multiplicities to multiplicities, from the greatest down. Both */                     \
+    /* arrays hold a heap of the greatest n seen so far while the set is */                        \
+    /* scanned, so it takes O(count log n) and allocates nothing. Returns */                       \
+    /* how many were written */                                                                    \
+    size_t PFX##_most_common(struct SNAME *_set_, size_t n, V *values, size_t *multiplicities)     \
+    {                                                                                              \
+        size_t size = 0;                                                                           \
+                                                                                                   \
+        if (n == 0)                                                                                \
+            return 0;                                                                              \
+                                                                                                   \
+        for (size_t i = 0; i < _set_->capacity; i++)                                               \
+        {                                                                                          \
+            struct SNAME##_entry *entry = &(_set_->buffer[i]);                                     \
+                                                                                                   \
+            if (entry->state != CMC_ES_FILLED)                                                     \
+                continue;                                                                          \
+                                                                                                   \
+            if (size < n)                                                                          \
+            {                                                                                      \
+                /* Goes up the heap of least multiplicity at the top */                            \
+                size_t c = size++;                                                                 \
+                                                                                                   \
+                while (c > 0 && multiplicities[(c - 1) / 2] > entry->multiplicity)                 \
+                {                                                                                  \
+                    values[c] = values[(c - 1) / 2];                                               \
+                    multiplicities[c] = multiplicities[(c - 1) / 2];                               \
+                    c = (c - 1) / 2;                                                               \
+                }                                                                                  \
+                                                                                                   \
+                values[c] = entry->value;                                                          \
+                multiplicities[c] = entry->multiplicity;                                           \
+            }                                                                                      \
+            else if (entry->multiplicity > multiplicities[0])                                      \
+            {                                                                                      \
+                values[0] = entry->value;                                                          \
+                multiplicities[0] = entry->multiplicity;                                           \
+                                                                                                   \
+                PFX##_impl_common_sift(values, multiplicities, size, 0);                           \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        /* Moving the least to the end leaves them from the greatest down */                       \
+        for (size_t end = size; end > 1; end--)                                                    \
+        {                                                                                          \
+            V value = values[0];                                                                   \
+            size_t multiplicity = multiplicities[0];                                               \
+                                                                                                   \
+            values[0] = values[end - 1];                                                           \
+            multiplicities[0] = multiplicities[end - 1];                                           \
+            values[end - 1] = value;                                                               \
+            multiplicities[end - 1] = multiplicity;                                                \
+                                                                                                   \
+            PFX##_impl_common_sift(values, multiplicities, end - 1, 0);                            \
+        }                                                                                          \
+                                                                                                   \
+        return size;                                                                               \
+    }                                                                                              \
+                                                                                                   \
     bool PFX##_contains(struct SNAME *_set_, V element)                                            \
     {                                                                                              \
         return PFX##_impl_get_entry(_set_, element) != NULL;                                       \
@@ -492,6 +1013,11 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return _set_->count;                                                                       \
     }                                                                                              \
                                                                                                    \
+    size_t PFX##_memory_usage(struct SNAME *_set_)                                                 \
+    {                                                                                              \
+        return sizeof(struct SNAME) + sizeof(struct SNAME##_entry) * _set_->capacity;              \
+    }                                                                                              \
+                                                                                                   \
     size_t PFX##_cardinality(struct SNAME *_set_)                                                  \
     {                                                                                              \
         return _set_->cardinality;                                                                 \
@@ -507,6 +1033,29 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return _set_->load;                                                                        \
     }                                                                                              \
                                                                                                    \
+    void PFX##_stats(struct SNAME *_set_, struct cmc_hashtable_stats *out)                         \
+    {                                                                                              \
+        memset(out, 0, sizeof(struct cmc_hashtable_stats));                                        \
+                                                                                                   \
+        out->capacity = _set_->capacity;                                                           \
+        out->count = _set_->count;                                                                 \
+        out->bytes = sizeof(struct SNAME) + sizeof(struct SNAME##_entry) * _set_->capacity;        \
+                                                                                                   \
+        for (size_t i = 0; i < _set_->capacity; i++)                                               \
+        {                                                                                          \
+            struct SNAME##_entry *entry = &(_set_->buffer[i]);                                     \
+                                                                                                   \
+            if (entry->state == CMC_ES_FILLED)                                                     \
+                cmc_hashtable_stats_add(out, entry->dist);                                         \
+            else if (entry->state == CMC_ES_DELETED)                                               \
+                out->tombstones++;                                                                 \
+        }                                                                                          \
+                                                                                                   \
+        CMC_IMPL_HASHTABLE_PROBE_ADD(out, _set_);                                                  \
+                                                                                                   \
+        cmc_hashtable_stats_end(out);                                                              \
+    }                                                                                              \
+                                                                                                   \
     bool PFX##_resize(struct SNAME *_set_, size_t capacity)                                        \
     {                                                                                              \
         if (PFX##_capacity(_set_) == capacity)                                                     \
@@ -526,42 +1075,20 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         if (theoretical_size < PFX##_count(_set_) / PFX##_load(_set_))                             \
             return false;                                                                          \
                                                                                                    \
-        struct SNAME *_new_set_ = PFX##_new(capacity, PFX##_load(_set_), _set_->cmp, _set_->hash); \
-                                                                                                   \
-        if (!_new_set_)                                                                            \
-            return false;                                                                          \
-                                                                                                   \
-        struct SNAME##_iter iter;                                                                  \
-                                                                                                   \
-        for (PFX##_iter_init(&iter, _set_); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))        \
-        {                                                                                          \
-            PFX##_insert_many(_new_set_, PFX##_iter_value(&iter), PFX##_iter_multiplicity(&iter)); \
-        }                                                                                          \
-                                                                                                   \
-        if (PFX##_count(_set_) != PFX##_count(_new_set_))                                          \
-        {                                                                                          \
-            PFX##_free(_new_set_, NULL);                                                           \
-            return false;                                                                          \
-        }                                                                                          \
-                                                                                                   \
-        struct SNAME##_entry *tmp_b = _set_->buffer;                                               \
-        _set_->buffer = _new_set_->buffer;                                                         \
-        _new_set_->buffer = tmp_b;                                                                 \
-                                                                                                   \
-        size_t tmp_c = _set_->capacity;                                                            \
-        _set_->capacity = _new_set_->capacity;                                                     \
-        _new_set_->capacity = tmp_c;                                                               \
-                                                                                                   \
-        PFX##_free(_new_set_, NULL);                                                               \
+        return PFX##_impl_rehash(_set_, capacity);                                                 \
+    }                                                                                              \
                                                                                                    \
-        return true;                                                                               \
+    bool PFX##_shrink_to_fit(struct SNAME *_set_)                                                  \
+    {                                                                                              \
+        return PFX##_impl_shrink(_set_, PFX##_count(_set_));                                       \
     }                                                                                              \
                                                                                                    \
     struct SNAME *PFX##_copy_of(struct SNAME *_set_, V (*copy_func)(V))                            \
     {                                                                                              \
-        struct SNAME *result = PFX##_new(_set_->capacity, _set_->load, _set_->cmp, _set_->hash);   \
+        struct SNAME *result = PFX##_new_custom(_set_->capacity, _set_->load, _set_->cmp,          \
+                                                _set_->hash, _set_->alloc);                        \
                                                                                                    \
-        if (!result)                                                                               \
+        if (CMC_UNLIKELY(!result))                                                                 \
             return NULL;                                                                           \
                                                                                                    \
         if (copy_func)                                                                             \
@@ -637,54 +1164,103 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return str;                                                                                \
     }                                                                                              \
                                                                                                    \
-    struct SNAME *PFX##_union(struct SNAME *_set1_, struct SNAME *_set2_)                          \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE)                                 \
+                                                                                                   \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE, (V))                                   \
+                                                                                                   \
+    bool PFX##_save(struct SNAME *_set_, FILE *file, bool (*writer)(V, FILE *))                    \
     {                                                                                              \
-        struct SNAME *_set_r_ = PFX##_new(_set1_->capacity, _set1_->load, _set1_->cmp,             \
-                                          _set1_->hash);                                           \
+        uint32_t flags = writer ? 0 : CMC_SERIAL_RAW_VALUES | CMC_SERIAL_LAYOUT;                   \
                                                                                                    \
-        if (!_set_r_)                                                                              \
-            return NULL;                                                                           \
+        if (!cmc_serial_write_header(file, "multiset", flags, 0, sizeof(V),                        \
+                                     sizeof(struct SNAME##_entry), _set_->count,                   \
+                                     _set_->capacity, _set_->load))                                \
+            return false;                                                                          \
                                                                                                    \
-        struct SNAME##_iter iter1, iter2;                                                          \
-        PFX##_iter_init(&iter1, _set1_);                                                           \
-        PFX##_iter_init(&iter2, _set2_);                                                           \
+        /* Without a writer the buffer is written as it is in memory */                            \
+        if (!writer)                                                                               \
+            return fwrite(_set_->buffer, sizeof(struct SNAME##_entry), _set_->capacity, file) ==   \
+                   _set_->capacity;                                                                \
                                                                                                    \
-        for (PFX##_iter_to_start(&iter1); !PFX##_iter_end(&iter1); PFX##_iter_next(&iter1))        \
+        /* Each distinct element is followed by its multiplicity */                                \
+        for (size_t i = 0; i < _set_->capacity; i++)                                               \
         {                                                                                          \
-            V value = PFX##_iter_value(&iter1);                                                    \
+            struct SNAME##_entry *entry = &(_set_->buffer[i]);                                     \
                                                                                                    \
-            size_t m1 = PFX##_iter_multiplicity(&iter1);                                           \
-            size_t m2 = PFX##_multiplicity_of(_set2_, value);                                      \
-            size_t max_ = m1 > m2 ? m1 : m2;                                                       \
+            if (entry->state != CMC_ES_FILLED)                                                     \
+                continue;                                                                          \
                                                                                                    \
-            PFX##_update(_set_r_, value, max_);                                                    \
+            if (!writer(entry->value, file) ||                                                     \
+                fwrite(&(entry->multiplicity), sizeof(size_t), 1, file) != 1)                      \
+                return false;                                                                      \
         }                                                                                          \
                                                                                                    \
-        for (PFX##_iter_to_start(&iter2); !PFX##_iter_end(&iter2); PFX##_iter_next(&iter2))        \
-        {                                                                                          \
-            V value = PFX##_iter_value(&iter2);                                                    \
+        return true;                                                                               \
+    }                                                                                              \
                                                                                                    \
-            size_t m1 = PFX##_multiplicity_of(_set1_, value);                                      \
-            size_t m2 = PFX##_iter_multiplicity(&iter2);                                           \
-            size_t max_ = m1 > m2 ? m1 : m2;                                                       \
+    /* A multiset saved without a writer is loaded without hashing its */                          \
+    /* elements so it must be given the same hash function it was saved with */                    \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(V, V), size_t (*hash)(V),               \
+                                bool (*reader)(V *, FILE *))                                       \
+    {                                                                                              \
+        struct cmc_serial_header header;                                                           \
                                                                                                    \
-            PFX##_update(_set_r_, value, max_);                                                    \
+        if (!cmc_serial_read_header(file, "multiset", 0, sizeof(V), &header))                      \
+            return NULL;                                                                           \
+                                                                                                   \
+        if (header.flags & CMC_SERIAL_LAYOUT)                                                      \
+            return PFX##_impl_load_layout(file, compare, hash, &header);                           \
+                                                                                                   \
+        /* Allocated for every element so that loading never grows */                              \
+        struct SNAME *_set_ =                                                                      \
+            PFX##_new(header.count > 0 ? header.count : 1, header.load, compare, hash);            \
+                                                                                                   \
+        if (!_set_)                                                                                \
+            return NULL;                                                                           \
+                                                                                                   \
+        for (size_t i = 0; i < header.count; i++)                                                  \
+        {                                                                                          \
+            V value;                                                                               \
+            size_t multiplicity;                                                                   \
+                                                                                                   \
+            if (!CMC_SERIAL_READ(false, reader, &value, file) ||                                   \
+                fread(&multiplicity, sizeof(size_t), 1, file) != 1 ||                              \
+                !PFX##_insert_many(_set_, value, multiplicity))                                    \
+            {                                                                                      \
+                PFX##_free(_set_, NULL);                                                           \
+                return NULL;                                                                       \
+            }                                                                                      \
         }                                                                                          \
                                                                                                    \
-        return _set_r_;                                                                            \
+        return _set_;                                                                              \
     }                                                                                              \
                                                                                                    \
-    struct SNAME *PFX##_intersection(struct SNAME *_set1_, struct SNAME *_set2_)                   \
+                                                                                                   \
+    struct SNAME *PFX##_union(struct SNAME *_set1_, struct SNAME *_set2_)                          \
     {                                                                                              \
-        struct SNAME *_set_r_ = PFX##_new(_set1_->capacity, _set1_->load, _set1_->cmp,             \
-                                          _set1_->hash);                                           \
+        struct SNAME *_set_r_ =                                                                    \
+            PFX##_impl_new_sized(_set1_, PFX##_count(_set1_) + PFX##_count(_set2_));               \
                                                                                                    \
         if (!_set_r_)                                                                              \
             return NULL;                                                                           \
                                                                                                    \
+        PFX##_union_into(_set_r_, _set1_);                                                         \
+        PFX##_union_into(_set_r_, _set2_);                                                         \
+                                                                                                   \
+        return _set_r_;                                                                            \
+    }                                                                                              \
+                                                                                                   \
+    struct SNAME *PFX##_intersection(struct SNAME *_set1_, struct SNAME *_set2_)                   \
+    {                                                                                              \
         struct SNAME *_set_A_ = _set1_->count < _set2_->count ? _set1_ : _set2_;                   \
         struct SNAME *_set_B_ = _set_A_ == _set1_ ? _set2_ : _set1_;                               \
                                                                                                    \
+        /* The intersection never has more distinct elements than the smaller set */               \
+        struct SNAME *_set_r_ = PFX##_impl_new_sized(_set1_, PFX##_count(_set_A_));                \
+                                                                                                   \
+        if (!_set_r_)                                                                              \
+            return NULL;                                                                           \
+                                                                                                   \
         struct SNAME##_iter iter;                                                                  \
         PFX##_iter_init(&iter, _set_A_);                                                           \
                                                                                                    \
@@ -704,8 +1280,7 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
     struct SNAME *PFX##_difference(struct SNAME *_set1_, struct SNAME *_set2_)                     \
     {                                                                                              \
-        struct SNAME *_set_r_ = PFX##_new(_set1_->capacity, _set1_->load, _set1_->cmp,             \
-                                          _set1_->hash);                                           \
+        struct SNAME *_set_r_ = PFX##_impl_new_sized(_set1_, PFX##_count(_set1_));                 \
                                                                                                    \
         if (!_set_r_)                                                                              \
             return NULL;                                                                           \
@@ -729,8 +1304,8 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
     struct SNAME *PFX##_summation(struct SNAME *_set1_, struct SNAME *_set2_)                      \
     {                                                                                              \
-        struct SNAME *_set_r_ = PFX##_new(_set1_->capacity, _set1_->load, _set1_->cmp,             \
-                                          _set1_->hash);                                           \
+        struct SNAME *_set_r_ =                                                                    \
+            PFX##_impl_new_sized(_set1_, PFX##_count(_set1_) + PFX##_count(_set2_));               \
                                                                                                    \
         if (!_set_r_)                                                                              \
             return NULL;                                                                           \
@@ -756,8 +1331,8 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
     {                                                                                              \
         struct SNAME##_iter iter1, iter2;                                                          \
                                                                                                    \
-        struct SNAME *_set_r_ = PFX##_new(_set1_->capacity, _set1_->load, _set1_->cmp,             \
-                                          _set1_->hash);                                           \
+        struct SNAME *_set_r_ =                                                                    \
+            PFX##_impl_new_sized(_set1_, PFX##_count(_set1_) + PFX##_count(_set2_));               \
                                                                                                    \
         if (!_set_r_)                                                                              \
             return NULL;                                                                           \
@@ -800,30 +1375,250 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         return _set_r_;                                                                            \
     }                                                                                              \
                                                                                                    \
-    bool PFX##_is_subset(struct SNAME *_set1_, struct SNAME *_set2_)                               \
+    bool PFX##_union_into(struct SNAME *_set1_, struct SNAME *_set2_)                              \
     {                                                                                              \
-        if (PFX##_count(_set1_) > PFX##_count(_set2_))                                             \
+        /* Grow once for both operands instead of one threshold at a time */                       \
+        if (CMC_UNLIKELY(!PFX##_resize(_set1_, PFX##_count(_set1_) + PFX##_count(_set2_))))        \
             return false;                                                                          \
                                                                                                    \
-        if (PFX##_empty(_set1_))                                                                   \
-            return true;                                                                           \
-                                                                                                   \
         struct SNAME##_iter iter;                                                                  \
-                                                                                                   \
-        PFX##_iter_init(&iter, _set1_);                                                            \
+        PFX##_iter_init(&iter, _set2_);                                                            \
                                                                                                    \
         for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))           \
         {                                                                                          \
-            V value = PFX##_iter_value(&iter);                                                     \
+            bool new_node;                                                                         \
                                                                                                    \
-            size_t m1 = PFX##_iter_multiplicity(&iter);                                            \
-            size_t m2 = PFX##_multiplicity_of(_set2_, value);                                      \
+            size_t m2 = PFX##_iter_multiplicity(&iter);                                            \
                                                                                                    \
-            if (m1 > m2)                                                                           \
+            struct SNAME##_entry *entry =                                                          \
+                PFX##_impl_insert_and_return(_set1_, PFX##_iter_value(&iter), &new_node);          \
+                                                                                                   \
+            if (!entry)                                                                            \
                 return false;                                                                      \
-        }                                                                                          \
                                                                                                    \
-        return true;                                                                               \
+            if (new_node)                                                                          \
+            {                                                                                      \
+                entry->multiplicity = m2;                                                          \
+                _set1_->cardinality += m2;                                                         \
+            }                                                                                      \
+            else if (m2 > entry->multiplicity)                                                     \
+            {                                                                                      \
+                _set1_->cardinality += m2 - entry->multiplicity;                                   \
+                entry->multiplicity = m2;                                                          \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Adds every element of _set2_ to _set1_. An element that is in both */                       \
+    /* gets the multiplicity combine(multiplicity in _set1_, multiplicity in */                    \
+    /* _set2_), which must not be 0, or the sum of both if combine is NULL. */                     \
+    /* Every element is looked up and placed in a single probe. Sets built by */                   \
+    /* many threads can be reduced pairwise, the merges of one round use */                        \
+    /* different sets so they can run at the same time */                                          \
+    bool PFX##_merge(struct SNAME *_set1_, struct SNAME *_set2_,                                   \
+                     size_t (*combine)(size_t, size_t))                                            \
+    {                                                                                              \
+        /* Grow once for both operands instead of one threshold at a time */                       \
+        if (CMC_UNLIKELY(!PFX##_resize(_set1_, PFX##_count(_set1_) + PFX##_count(_set2_))))        \
+            return false;                                                                          \
+                                                                                                   \
+        struct SNAME##_iter iter;                                                                  \
+                                                                                                   \
+        for (PFX##_iter_init(&iter, _set2_); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))       \
+        {                                                                                          \
+            bool new_node;                                                                         \
+                                                                                                   \
+            size_t m2 = PFX##_iter_multiplicity(&iter);                                            \
+                                                                                                   \
+            struct SNAME##_entry *entry =                                                          \
+                PFX##_impl_insert_and_return(_set1_, PFX##_iter_value(&iter), &new_node);          \
+                                                                                                   \
+            if (!entry)                                                                            \
+                return false;                                                                      \
+                                                                                                   \
+            size_t m1 = new_node ? 0 : entry->multiplicity;                                        \
+                                                                                                   \
+            entry->multiplicity = new_node ? m2 : combine ? combine(m1, m2) : m1 + m2;             \
+                                                                                                   \
+            _set1_->cardinality = (_set1_->cardinality - m1) + entry->multiplicity;                \
+        }                                                                                          \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Same as merge but frees _set2_, so its elements are moved to _set1_ */                      \
+    /* instead of being shared by both sets. The elements of _set2_ that were */                   \
+    /* already in _set1_ are given to the deallocator. If _set1_ can't grow */                     \
+    /* _set2_ is not freed */                                                                      \
+    bool PFX##_merge_free(struct SNAME *_set1_, struct SNAME *_set2_,                              \
+                          size_t (*combine)(size_t, size_t), void (*deallocator)(V))               \
+    {                                                                                              \
+        if (CMC_UNLIKELY(!PFX##_resize(_set1_, PFX##_count(_set1_) + PFX##_count(_set2_))))        \
+            return false;                                                                          \
+                                                                                                   \
+        struct SNAME##_iter iter;                                                                  \
+                                                                                                   \
+        for (PFX##_iter_init(&iter, _set2_); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))       \
+        {                                                                                          \
+            bool new_node;                                                                         \
+                                                                                                   \
+            V value = PFX##_iter_value(&iter);                                                     \
+            size_t m2 = PFX##_iter_multiplicity(&iter);                                            \
+                                                                                                   \
+            struct SNAME##_entry *entry = PFX##_impl_insert_and_return(_set1_, value, &new_node);  \
+                                                                                                   \
+            if (!entry)                                                                            \
+                return false;                                                                      \
+                                                                                                   \
+            size_t m1 = new_node ? 0 : entry->multiplicity;                                        \
+                                                                                                   \
+            entry->multiplicity = new_node ? m2 : combine ? combine(m1, m2) : m1 + m2;             \
+                                                                                                   \
+            _set1_->cardinality = (_set1_->cardinality - m1) + entry->multiplicity;                \
+                                                                                                   \
+            if (!new_node && deallocator)                                                          \
+                deallocator(value);                                                                \
+        }                                                                                          \
+                                                                                                   \
+        /* Every element now belongs to _set1_ or was deallocated */                               \
+        PFX##_free(_set2_, NULL);                                                                  \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_intersect_with(struct SNAME *_set1_, struct SNAME *_set2_)                          \
+    {                                                                                              \
+        if (PFX##_count(_set1_) <= PFX##_count(_set2_))                                            \
+        {                                                                                          \
+            for (size_t i = 0; i < _set1_->capacity;)                                              \
+            {                                                                                      \
+                struct SNAME##_entry *entry = &(_set1_->buffer[i]);                                \
+                                                                                                   \
+                if (entry->state != CMC_ES_FILLED)                                                 \
+                {                                                                                  \
+                    i++;                                                                           \
+                    continue;                                                                      \
+                }                                                                                  \
+                                                                                                   \
+                size_t m1 = entry->multiplicity;                                                   \
+                size_t m2 = PFX##_multiplicity_of(_set2_, entry->value);                           \
+                                                                                                   \
+                if (!PFX##_impl_shrink_entry(_set1_, entry, m1 < m2 ? m1 : m2))                    \
+                    i++;                                                                           \
+            }                                                                                      \
+                                                                                                   \
+            return true;                                                                           \
+        }                                                                                          \
+                                                                                                   \
+        /* Probing from _set2_ touches far fewer entries than scanning _set1_ */                   \
+        /* and the result always fits in a table sized after _set2_ */                             \
+        struct SNAME *_set_r_ = PFX##_impl_new_sized(_set1_, PFX##_count(_set2_));                 \
+                                                                                                   \
+        if (!_set_r_)                                                                              \
+            return false;                                                                          \
+                                                                                                   \
+        struct SNAME##_iter iter;                                                                  \
+        PFX##_iter_init(&iter, _set2_);                                                            \
+                                                                                                   \
+        for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))           \
+        {                                                                                          \
+            struct SNAME##_entry *entry = PFX##_impl_get_entry(_set1_, PFX##_iter_value(&iter));   \
+                                                                                                   \
+            if (entry == NULL)                                                                     \
+                continue;                                                                          \
+                                                                                                   \
+            size_t m1 = entry->multiplicity;                                                       \
+            size_t m2 = PFX##_iter_multiplicity(&iter);                                            \
+                                                                                                   \
+            /* Keep the element owned by _set1_ */                                                 \
+            PFX##_update(_set_r_, entry->value, m1 < m2 ? m1 : m2);                                \
+        }                                                                                          \
+                                                                                                   \
+        struct SNAME##_entry *tmp_b = _set1_->buffer;                                              \
+        _set1_->buffer = _set_r_->buffer;                                                          \
+        _set_r_->buffer = tmp_b;                                                                   \
+                                                                                                   \
+        size_t tmp_c = _set1_->capacity;                                                           \
+        _set1_->capacity = _set_r_->capacity;                                                      \
+        _set_r_->capacity = tmp_c;                                                                 \
+        _set1_->fastmod = cmc_fastmod_new(_set1_->capacity);                                       \
+        _set_r_->fastmod = cmc_fastmod_new(_set_r_->capacity);                                     \
+                                                                                                   \
+        _set1_->count = _set_r_->count;                                                            \
+        _set1_->cardinality = _set_r_->cardinality;                                                \
+                                                                                                   \
+        PFX##_free(_set_r_, NULL);                                                                 \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    void PFX##_subtract(struct SNAME *_set1_, struct SNAME *_set2_)                                \
+    {                                                                                              \
+        if (PFX##_count(_set1_) <= PFX##_count(_set2_))                                            \
+        {                                                                                          \
+            for (size_t i = 0; i < _set1_->capacity;)                                              \
+            {                                                                                      \
+                struct SNAME##_entry *entry = &(_set1_->buffer[i]);                                \
+                                                                                                   \
+                if (entry->state != CMC_ES_FILLED)                                                 \
+                {                                                                                  \
+                    i++;                                                                           \
+                    continue;                                                                      \
+                }                                                                                  \
+                                                                                                   \
+                size_t m1 = entry->multiplicity;                                                   \
+                size_t m2 = PFX##_multiplicity_of(_set2_, entry->value);                           \
+                                                                                                   \
+                if (!PFX##_impl_shrink_entry(_set1_, entry, m1 > m2 ? m1 - m2 : 0))                \
+                    i++;                                                                           \
+            }                                                                                      \
+                                                                                                   \
+            return;                                                                                \
+        }                                                                                          \
+                                                                                                   \
+        struct SNAME##_iter iter;                                                                  \
+        PFX##_iter_init(&iter, _set2_);                                                            \
+                                                                                                   \
+        for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))           \
+        {                                                                                          \
+            struct SNAME##_entry *entry = PFX##_impl_get_entry(_set1_, PFX##_iter_value(&iter));   \
+                                                                                                   \
+            if (entry == NULL)                                                                     \
+                continue;                                                                          \
+                                                                                                   \
+            size_t m1 = entry->multiplicity;                                                       \
+            size_t m2 = PFX##_iter_multiplicity(&iter);                                            \
+                                                                                                   \
+            PFX##_impl_shrink_entry(_set1_, entry, m1 > m2 ? m1 - m2 : 0);                         \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_is_subset(struct SNAME *_set1_, struct SNAME *_set2_)                               \
+    {                                                                                              \
+        if (PFX##_count(_set1_) > PFX##_count(_set2_))                                             \
+            return false;                                                                          \
+                                                                                                   \
+        if (PFX##_empty(_set1_))                                                                   \
+            return true;                                                                           \
+                                                                                                   \
+        struct SNAME##_iter iter;                                                                  \
+                                                                                                   \
+        PFX##_iter_init(&iter, _set1_);                                                            \
+                                                                                                   \
+        for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))           \
+        {                                                                                          \
+            V value = PFX##_iter_value(&iter);                                                     \
+                                                                                                   \
+            size_t m1 = PFX##_iter_multiplicity(&iter);                                            \
+            size_t m2 = PFX##_multiplicity_of(_set2_, value);                                      \
+                                                                                                   \
+            if (m1 > m2)                                                                           \
+                return false;                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        return true;                                                                               \
     }                                                                                              \
                                                                                                    \
     bool PFX##_is_superset(struct SNAME *_set1_, struct SNAME *_set2_)                             \
@@ -872,15 +1667,18 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         if (PFX##_empty(_set1_))                                                                   \
             return true;                                                                           \
                                                                                                    \
+        struct SNAME *_set_A_ = _set1_->count < _set2_->count ? _set1_ : _set2_;                   \
+        struct SNAME *_set_B_ = _set_A_ == _set1_ ? _set2_ : _set1_;                               \
+                                                                                                   \
         struct SNAME##_iter iter;                                                                  \
                                                                                                    \
-        PFX##_iter_init(&iter, _set1_);                                                            \
+        PFX##_iter_init(&iter, _set_A_);                                                           \
                                                                                                    \
         for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))           \
         {                                                                                          \
             V value = PFX##_iter_value(&iter);                                                     \
                                                                                                    \
-            if (PFX##_contains(_set2_, value))                                                     \
+            if (PFX##_contains(_set_B_, value))                                                    \
                 return false;                                                                      \
         }                                                                                          \
                                                                                                    \
@@ -889,9 +1687,9 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
     struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                      \
     {                                                                                              \
-        struct SNAME##_iter *iter = malloc(sizeof(struct SNAME##_iter));                           \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));            \
                                                                                                    \
-        if (!iter)                                                                                 \
+        if (CMC_UNLIKELY(!iter))                                                                   \
             return NULL;                                                                           \
                                                                                                    \
         PFX##_iter_init(iter, target);                                                             \
@@ -901,7 +1699,7 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
     void PFX##_iter_free(struct SNAME##_iter *iter)                                                \
     {                                                                                              \
-        free(iter);                                                                                \
+        iter->target->alloc->free(iter);                                                           \
     }                                                                                              \
                                                                                                    \
     void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                          \
@@ -1111,7 +1909,9 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
         *new_node = false;                                                                         \
                                                                                                    \
-        struct SNAME##_entry *entry = PFX##_impl_get_entry(_set_, element);                        \
+        size_t hash = PFX##_impl_hash(_set_, element);                                             \
+                                                                                                   \
+        struct SNAME##_entry *entry = PFX##_impl_get_entry_by_hash(_set_, element, hash);          \
                                                                                                    \
         if (entry != NULL)                                                                         \
             return entry;                                                                          \
@@ -1120,95 +1920,325 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
                                                                                                    \
         if (PFX##_full(_set_))                                                                     \
         {                                                                                          \
-            if (!PFX##_resize(_set_, PFX##_capacity(_set_) + 1))                                   \
+            if (CMC_UNLIKELY(!PFX##_resize(_set_, PFX##_capacity(_set_) + 1)))                     \
+                return NULL;                                                                       \
+        }                                                                                          \
+                                                                                                   \
+        /* Only tables bigger than CMC_ES_DIST_MAX can run out of bits to */                       \
+        /* store the distance of an entry */                                                       \
+        if (PFX##_capacity(_set_) > CMC_ES_DIST_MAX && PFX##_impl_dist_overflow(_set_, hash))      \
+        {                                                                                          \
+            if (CMC_UNLIKELY(!PFX##_resize(_set_, PFX##_capacity(_set_) + 1)))                     \
                 return NULL;                                                                       \
+                                                                                                   \
+            return PFX##_impl_insert_and_return(_set_, element, new_node);                         \
         }                                                                                          \
                                                                                                    \
-        size_t hash = _set_->hash(element);                                                        \
-        size_t original_pos = hash % _set_->capacity;                                              \
+        return PFX##_impl_insert_entry(_set_, element, 1, hash);                                   \
+    }                                                                                              \
+                                                                                                   \
+    static struct SNAME##_entry *PFX##_impl_get_entry(struct SNAME *_set_, V element)              \
+    {                                                                                              \
+        return PFX##_impl_get_entry_by_hash(_set_, element, PFX##_impl_hash(_set_, element));      \
+    }                                                                                              \
+                                                                                                   \
+    static struct SNAME##_entry *PFX##_impl_get_entry_by_hash(struct SNAME *_set_, V element,      \
+                                                              size_t hash)                         \
+    {                                                                                              \
+        size_t original_pos = PFX##_impl_home(_set_, hash);                                        \
         size_t pos = original_pos;                                                                 \
-        /* Current multiplicity. Might change due to robin hood hashing */                         \
-        size_t curr_mul = 1;                                                                       \
                                                                                                    \
         struct SNAME##_entry *target = &(_set_->buffer[pos]);                                      \
                                                                                                    \
-        if (target->state == CMC_ES_EMPTY || target->state == CMC_ES_DELETED)                      \
+        CMC_IMPL_HASHTABLE_PROBE_LOOKUP(_set_);                                                    \
+                                                                                                   \
+        /* There are no tombstones so the search stops at the first empty */                       \
+        /* entry or at the first entry closer to its original position */                          \
+        while (target->state == CMC_ES_FILLED && target->dist >= pos - original_pos)               \
         {                                                                                          \
-            target->value = element;                                                               \
-            target->multiplicity = curr_mul;                                                       \
-            target->dist = pos - original_pos;                                                     \
-            target->state = CMC_ES_FILLED;                                                         \
+            CMC_IMPL_HASHTABLE_PROBE_SLOT(_set_);                                                  \
+                                                                                                   \
+            /* CACHED tables skip the comparison when the hashes differ */                         \
+            if (CMC_IMPL_HASHTABLE_##HASHING##_EQUALS(target->hash, hash) &&                       \
+                PFX##_impl_cmp(_set_, target->value, element) == 0)                                \
+                return target;                                                                     \
+                                                                                                   \
+            pos++;                                                                                 \
+            target = &(_set_->buffer[PFX##_impl_wrap(_set_, pos)]);                                \
         }                                                                                          \
-        else                                                                                       \
-        {                                                                                          \
-            while (true)                                                                           \
-            {                                                                                      \
-                pos++;                                                                             \
-                target = &(_set_->buffer[pos % _set_->capacity]);                                  \
                                                                                                    \
-                if (target->state == CMC_ES_EMPTY || target->state == CMC_ES_DELETED)              \
-                {                                                                                  \
-                    target->value = element;                                                       \
-                    target->multiplicity = curr_mul;                                               \
-                    target->dist = pos - original_pos;                                             \
-                    target->state = CMC_ES_FILLED;                                                 \
+        return NULL;                                                                               \
+    }                                                                                              \
                                                                                                    \
-                    break;                                                                         \
-                }                                                                                  \
-                else if (target->dist < pos - original_pos)                                        \
-                {                                                                                  \
-                    /* Swap everything */                                                          \
-                    V tmp = target->value;                                                         \
-                    size_t tmp_dist = target->dist;                                                \
-                    size_t tmp_mul = target->multiplicity;                                         \
-                                                                                                   \
-                    target->value = element;                                                       \
-                    target->dist = pos - original_pos;                                             \
-                    target->multiplicity = curr_mul;                                               \
-                                                                                                   \
-                    element = tmp;                                                                 \
-                    original_pos = pos - tmp_dist;                                                 \
-                    curr_mul = tmp_mul;                                                            \
-                }                                                                                  \
+    /* Places an element that is known not to be in the set. Returns the */                        \
+    /* entry where the element ended up, which is not necessarily the last */                      \
+    /* one written because of robin hood hashing */                                                \
+    static struct SNAME##_entry *PFX##_impl_insert_entry(struct SNAME *_set_, V element,           \
+                                                         size_t multiplicity, size_t hash)         \
+    {                                                                                              \
+        size_t original_pos = PFX##_impl_home(_set_, hash);                                        \
+        size_t pos = original_pos;                                                                 \
+                                                                                                   \
+        struct SNAME##_entry *target = &(_set_->buffer[pos]);                                      \
+        struct SNAME##_entry *result = NULL;                                                       \
+                                                                                                   \
+        while (target->state == CMC_ES_FILLED)                                                     \
+        {                                                                                          \
+            if (target->dist < pos - original_pos)                                                 \
+            {                                                                                      \
+                /* Swap everything */                                                              \
+                V tmp = target->value;                                                             \
+                size_t tmp_dist = target->dist;                                                    \
+                size_t tmp_mul = target->multiplicity;                                             \
+                CMC_IMPL_HASHTABLE_##HASHING(size_t tmp_h = target->hash;)                         \
+                                                                                                   \
+                target->value = element;                                                           \
+                target->dist = pos - original_pos;                                                 \
+                target->multiplicity = multiplicity;                                               \
+                CMC_IMPL_HASHTABLE_##HASHING(target->hash = hash;)                                 \
+                                                                                                   \
+                element = tmp;                                                                     \
+                original_pos = pos - tmp_dist;                                                     \
+                multiplicity = tmp_mul;                                                            \
+                CMC_IMPL_HASHTABLE_##HASHING(hash = tmp_h;)                                        \
+                                                                                                   \
+                if (!result)                                                                       \
+                    result = target;                                                               \
             }                                                                                      \
+                                                                                                   \
+            pos++;                                                                                 \
+            target = &(_set_->buffer[PFX##_impl_wrap(_set_, pos)]);                                \
         }                                                                                          \
                                                                                                    \
+        target->value = element;                                                                   \
+        target->multiplicity = multiplicity;                                                       \
+        target->dist = pos - original_pos;                                                         \
+        target->state = CMC_ES_FILLED;                                                             \
+        CMC_IMPL_HASHTABLE_##HASHING(target->hash = hash;)                                         \
+                                                                                                   \
         _set_->count++;                                                                            \
                                                                                                    \
-        return target;                                                                             \
+        return result ? result : target;                                                           \
     }                                                                                              \
                                                                                                    \
-    static struct SNAME##_entry *PFX##_impl_get_entry(struct SNAME *_set_, V element)              \
+    static bool PFX##_impl_dist_overflow(struct SNAME *_set_, size_t hash)                         \
     {                                                                                              \
-        size_t hash = _set_->hash(element);                                                        \
-        size_t pos = hash % _set_->capacity;                                                       \
+        size_t pos = PFX##_impl_home(_set_, hash);                                                 \
+        size_t dist = 0;                                                                           \
                                                                                                    \
         struct SNAME##_entry *target = &(_set_->buffer[pos]);                                      \
                                                                                                    \
-        while (target->state == CMC_ES_FILLED || target->state == CMC_ES_DELETED)                  \
+        /* Follows the steps of an insertion without moving any entry */                           \
+        while (target->state == CMC_ES_FILLED)                                                     \
         {                                                                                          \
-            if (_set_->cmp(target->value, element) == 0)                                           \
-                return target;                                                                     \
+            /* The entry closer to its original position is the one carried */                     \
+            if (target->dist < dist)                                                               \
+                dist = target->dist;                                                               \
                                                                                                    \
             pos++;                                                                                 \
-            target = &(_set_->buffer[pos % _set_->capacity]);                                      \
+            dist++;                                                                                \
+                                                                                                   \
+            if (dist > CMC_ES_DIST_MAX)                                                            \
+                return true;                                                                       \
+                                                                                                   \
+            target = &(_set_->buffer[PFX##_impl_wrap(_set_, pos)]);                                \
         }                                                                                          \
                                                                                                    \
-        return NULL;                                                                               \
+        return false;                                                                              \
     }                                                                                              \
                                                                                                    \
-    static size_t PFX##_impl_calculate_size(size_t required)                                       \
+    static void PFX##_impl_remove_entry(struct SNAME *_set_, struct SNAME##_entry *entry)          \
     {                                                                                              \
-        const size_t count = sizeof(cmc_hashtable_primes) / sizeof(cmc_hashtable_primes[0]);       \
+        size_t pos = (size_t)(entry - _set_->buffer);                                              \
                                                                                                    \
-        if (cmc_hashtable_primes[count - 1] < required)                                            \
-            return required;                                                                       \
+        /* Backward shift deletion. Every entry that follows and is not at its */                  \
+        /* original position is moved one position back */                                         \
+        while (true)                                                                               \
+        {                                                                                          \
+            struct SNAME##_entry *next = &(_set_->buffer[PFX##_impl_wrap(_set_, pos + 1)]);        \
+                                                                                                   \
+            if (next->state != CMC_ES_FILLED || next->dist == 0)                                   \
+                break;                                                                             \
                                                                                                    \
-        size_t i = 0;                                                                              \
-        while (cmc_hashtable_primes[i] < required)                                                 \
-            i++;                                                                                   \
+            *entry = *next;                                                                        \
+            entry->dist--;                                                                         \
                                                                                                    \
-        return cmc_hashtable_primes[i];                                                            \
+            entry = next;                                                                          \
+            pos++;                                                                                 \
+        }                                                                                          \
+                                                                                                   \
+        entry->value = (V){0};                                                                     \
+        entry->multiplicity = 0;                                                                   \
+        entry->dist = 0;                                                                           \
+        entry->state = CMC_ES_EMPTY;                                                               \
+        CMC_IMPL_HASHTABLE_##HASHING(entry->hash = 0;)                                             \
+    }                                                                                              \
+                                                                                                   \
+    static struct SNAME *PFX##_impl_new_sized(struct SNAME *_set_, size_t count)                   \
+    {                                                                                              \
+        /* A set operation result that takes the load and functions of _set_ */                    \
+        return PFX##_new_custom(count > 0 ? count : 1, _set_->load, _set_->cmp, _set_->hash,       \
+                                _set_->alloc);                                                     \
+    }                                                                                              \
+                                                                                                   \
+    static bool PFX##_impl_shrink_entry(struct SNAME *_set_, struct SNAME##_entry *entry,          \
+                                        size_t multiplicity)                                       \
+    {                                                                                              \
+        /* Lowers the multiplicity of entry and returns true if it was removed. Backward */        \
+        /* shift deletion moves the following entry into the slot that was just emptied */         \
+        _set_->cardinality -= entry->multiplicity - multiplicity;                                  \
+                                                                                                   \
+        if (multiplicity > 0)                                                                      \
+        {                                                                                          \
+            entry->multiplicity = multiplicity;                                                    \
+                                                                                                   \
+            return false;                                                                          \
+        }                                                                                          \
+                                                                                                   \
+        PFX##_impl_remove_entry(_set_, entry);                                                     \
+                                                                                                   \
+        _set_->count--;                                                                            \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Moves every entry to a new buffer sized for capacity entries */                             \
+    static bool PFX##_impl_rehash(struct SNAME *_set_, size_t capacity)                            \
+    {                                                                                              \
+        struct SNAME *_new_set_ = PFX##_new_custom(capacity, PFX##_load(_set_), _set_->cmp,        \
+                                                   _set_->hash, _set_->alloc);                     \
+                                                                                                   \
+        if (CMC_UNLIKELY(!_new_set_))                                                              \
+            return false;                                                                          \
+                                                                                                   \
+        for (size_t i = 0; i < _set_->capacity; i++)                                               \
+        {                                                                                          \
+            struct SNAME##_entry *entry = &(_set_->buffer[i]);                                     \
+                                                                                                   \
+            if (entry->state != CMC_ES_FILLED)                                                     \
+                continue;                                                                          \
+                                                                                                   \
+            /* CACHED tables reuse the stored hash instead of calling hash() */                    \
+            size_t hash =                                                                          \
+                CMC_IMPL_HASHTABLE_##HASHING##_REHASH(entry->hash,                                 \
+                                                      PFX##_impl_hash(_set_, entry->value));       \
+                                                                                                   \
+            if (PFX##_capacity(_new_set_) > CMC_ES_DIST_MAX &&                                     \
+                PFX##_impl_dist_overflow(_new_set_, hash))                                         \
+                break;                                                                             \
+                                                                                                   \
+            PFX##_impl_insert_entry(_new_set_, entry->value, entry->multiplicity, hash);           \
+        }                                                                                          \
+                                                                                                   \
+        if (PFX##_count(_set_) != PFX##_count(_new_set_))                                          \
+        {                                                                                          \
+            PFX##_free(_new_set_, NULL);                                                           \
+            return false;                                                                          \
+        }                                                                                          \
+                                                                                                   \
+        struct SNAME##_entry *tmp_b = _set_->buffer;                                               \
+        _set_->buffer = _new_set_->buffer;                                                         \
+        _new_set_->buffer = tmp_b;                                                                 \
+                                                                                                   \
+        size_t tmp_c = _set_->capacity;                                                            \
+        _set_->capacity = _new_set_->capacity;                                                     \
+        _new_set_->capacity = tmp_c;                                                               \
+        _set_->fastmod = cmc_fastmod_new(_set_->capacity);                                         \
+        _new_set_->fastmod = cmc_fastmod_new(_new_set_->capacity);                                 \
+                                                                                                   \
+        PFX##_free(_new_set_, NULL);                                                               \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Called after removals, shrinks the table once it is mostly empty */                         \
+    static void PFX##_impl_low_water(struct SNAME *_set_)                                          \
+    {                                                                                              \
+        double low_water = cmc_hashtable_low_water(_set_->load);                                   \
+                                                                                                   \
+        /* Left with room for as many again so it is not grown right back */                       \
+        if ((double)_set_->count < (double)_set_->capacity * _set_->load * low_water)              \
+            PFX##_impl_shrink(_set_, _set_->count * 2);                                            \
+    }                                                                                              \
+                                                                                                   \
+    /* Rebuilds the table at the smallest size that holds required entries */                      \
+    static bool PFX##_impl_shrink(struct SNAME *_set_, size_t required)                            \
+    {                                                                                              \
+        size_t capacity = required > 0 ? required : 1;                                             \
+                                                                                                   \
+        /* Already as small as the sizing policy allows */                                         \
+        if (PFX##_impl_calculate_size(capacity / PFX##_load(_set_)) >= PFX##_capacity(_set_))      \
+            return true;                                                                           \
+                                                                                                   \
+        return PFX##_impl_rehash(_set_, capacity);                                                 \
+    }                                                                                              \
+                                                                                                   \
+    static struct SNAME *PFX##_impl_load_layout(FILE *file, int (*compare)(V, V),                  \
+                                                size_t (*hash)(V),                                 \
+                                                struct cmc_serial_header *header)                  \
+    {                                                                                              \
+        size_t capacity = header->capacity;                                                        \
+                                                                                                   \
+        /* The buffer is only valid for a table of the same sizing and entry */                    \
+        if (header->extra != sizeof(struct SNAME##_entry) || capacity == 0 ||                      \
+            PFX##_impl_calculate_size(capacity) != capacity || header->count > capacity ||         \
+            capacity > SIZE_MAX / sizeof(struct SNAME##_entry))                                    \
+            return NULL;                                                                           \
+                                                                                                   \
+        struct SNAME *_set_ = PFX##_new(1, header->load, compare, hash);                           \
+                                                                                                   \
+        if (CMC_UNLIKELY(!_set_))                                                                  \
+            return NULL;                                                                           \
+                                                                                                   \
+        struct SNAME##_entry *buffer =                                                             \
+            _set_->alloc->malloc(capacity * sizeof(struct SNAME##_entry));                         \
+                                                                                                   \
+        if (!buffer || fread(buffer, sizeof(struct SNAME##_entry), capacity, file) != capacity)    \
+        {                                                                                          \
+            _set_->alloc->free(buffer);                                                            \
+            PFX##_free(_set_, NULL);                                                               \
+            return NULL;                                                                           \
+        }                                                                                          \
+                                                                                                   \
+        _set_->alloc->free(_set_->buffer);                                                         \
+                                                                                                   \
+        _set_->buffer = buffer;                                                                    \
+        _set_->capacity = capacity;                                                                \
+        _set_->fastmod = cmc_fastmod_new(_set_->capacity);                                         \
+                                                                                                   \
+        for (size_t i = 0; i < capacity; i++)                                                      \
+        {                                                                                          \
+            if (buffer[i].state == CMC_ES_FILLED)                                                  \
+            {                                                                                      \
+                _set_->count++;                                                                    \
+                _set_->cardinality += buffer[i].multiplicity;                                      \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        /* Entries are trusted as they are but their amount is counted */                          \
+        if (_set_->count != header->count)                                                         \
+        {                                                                                          \
+            PFX##_free(_set_, NULL);                                                               \
+            return NULL;                                                                           \
+        }                                                                                          \
+                                                                                                   \
+        return _set_;                                                                              \
+    }                                                                                              \
+                                                                                                   \
+                                                                                                   \
+    static size_t PFX##_impl_calculate_size(size_t required)                                       \
+    {                                                                                              \
+        return CMC_IMPL_HASHTABLE_##SIZING##_SIZE(required);                                       \
+    }                                                                                              \
+                                                                                                   \
+    static inline size_t PFX##_impl_home(struct SNAME *_set_, size_t hash)                         \
+    {                                                                                              \
+        return CMC_IMPL_HASHTABLE_##SIZING##_TABLE_HOME(hash, _set_);                              \
+    }                                                                                              \
+                                                                                                   \
+    static inline size_t PFX##_impl_wrap(struct SNAME *_set_, size_t pos)                          \
+    {                                                                                              \
+        return CMC_IMPL_HASHTABLE_##SIZING##_TABLE_WRAP(pos, _set_);                               \
     }                                                                                              \
                                                                                                    \
     static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_set_)                            \
@@ -1228,6 +2258,44 @@ static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
         PFX##_iter_to_end(&iter);                                                                  \
                                                                                                    \
         return iter;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Moves an element of the heap of most_common down to its place */                            \
+    static void PFX##_impl_common_sift(V *values, size_t *multiplicities, size_t count,            \
+                                       size_t i)                                                   \
+    {                                                                                              \
+        V value = values[i];                                                                       \
+        size_t multiplicity = multiplicities[i];                                                   \
+                                                                                                   \
+        for (size_t c = 2 * i + 1; c < count; c = 2 * i + 1)                                       \
+        {                                                                                          \
+            if (c + 1 < count && multiplicities[c + 1] < multiplicities[c])                        \
+                c++;                                                                               \
+                                                                                                   \
+            if (multiplicities[c] >= multiplicity)                                                 \
+                break;                                                                             \
+                                                                                                   \
+            values[i] = values[c];                                                                 \
+            multiplicities[i] = multiplicities[c];                                                 \
+            i = c;                                                                                 \
+        }                                                                                          \
+                                                                                                   \
+        values[i] = value;                                                                         \
+        multiplicities[i] = multiplicity;                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static inline int PFX##_impl_cmp(struct SNAME *_set_, V a, V b)                                \
+    {                                                                                              \
+        (void)_set_;                                                                               \
+                                                                                                   \
+        return CMP(a, b);                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static inline size_t PFX##_impl_hash(struct SNAME *_set_, V value)                             \
+    {                                                                                              \
+        (void)_set_;                                                                               \
+                                                                                                   \
+        return HASH(value);                                                                        \
     }
 
 #endif /* CMC_MULTISET_H */
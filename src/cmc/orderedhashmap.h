@@ -0,0 +1,1247 @@
+/**
+ * orderedhashmap.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * OrderedHashMap
+ *
+ * An OrderedHashMap is a Map with unique keys, where every key is mapped to a
+ * value, that remembers the order in which its keys were inserted. Iterators
+ * go from the oldest key to the newest one. Updating the value of a key keeps
+ * its position and a key that is removed and inserted again goes to the end.
+ *
+ * Implementation
+ *
+ * Like the dict of Python, the entries are kept in a dense array in the order
+ * they were inserted and the hashtable only holds positions of that array.
+ * The hashtable uses open addressing with linear probing and its slots are as
+ * narrow as the amount of entries allows, one byte for up to 255 entries and
+ * up to eight bytes, so most of the memory of a sparse table is not spent on
+ * empty slots and iterating goes through count entries in a row. Removals
+ * leave a hole in the array of entries, which are compacted the next time the
+ * array is full, and move back the slots that follow them in the hashtable
+ * (backward shift deletion) so there are no tombstones.
+ */
+
+#ifndef CMC_ORDEREDHASHMAP_H
+#define CMC_ORDEREDHASHMAP_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_serial.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+#include "hashmap.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_orderedhashmap = "%s at %p { entries:%p, index:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", used:%" PRIuMAX ", load:%lf, cmp:%p, hash:%p }";
+
+#define CMC_GENERATE_ORDEREDHASHMAP(PFX, SNAME, K, V)    \
+    CMC_GENERATE_ORDEREDHASHMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_ORDEREDHASHMAP_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_ORDEREDHASHMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_ORDEREDHASHMAP_HEADER(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_ORDEREDHASHMAP_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_ORDEREDHASHMAP_SOURCE(PFX, SNAME, K, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_ORDEREDHASHMAP_HEADER(PFX, SNAME, K, V)                            \
+                                                                                        \
+    /* OrderedHashMap Structure */                                                      \
+    struct SNAME                                                                        \
+    {                                                                                   \
+        /* Entries in the order they were inserted */                                   \
+        struct SNAME##_entry *entries;                                                  \
+                                                                                        \
+        /* Slots of the hashtable, each one holds the position of an entry */           \
+        /* plus one or 0 if it is empty */                                              \
+        void *index;                                                                    \
+                                                                                        \
+        /* Bytes of each slot of the index, 1, 2, 4 or 8 */                             \
+        size_t width;                                                                   \
+                                                                                        \
+        /* Amount of slots of the index */                                              \
+        size_t capacity;                                                                \
+                                                                                        \
+        /* Current amount of keys */                                                    \
+        size_t count;                                                                   \
+                                                                                        \
+        /* Entries used so far, including the ones that were removed */                 \
+        size_t used;                                                                    \
+                                                                                        \
+        /* Size of the array of entries */                                              \
+        size_t limit;                                                                   \
+                                                                                        \
+        /* Load factor in range (0.0, 1.0) */                                           \
+        double load;                                                                    \
+                                                                                        \
+        /* Key comparison function */                                                   \
+        int (*cmp)(K, K);                                                               \
+                                                                                        \
+        /* Key hash function */                                                         \
+        size_t (*hash)(K);                                                              \
+                                                                                        \
+        /* Lookup counters, only present with CMC_HASHTABLE_PROBE_STATS */              \
+        CMC_IMPL_HASHTABLE_PROBE_FIELDS                                                 \
+                                                                                        \
+        /* Function that returns an iterator to the start of the hashmap */             \
+        struct SNAME##_iter (*it_start)(struct SNAME *);                                \
+                                                                                        \
+        /* Function that returns an iterator to the end of the hashmap */               \
+        struct SNAME##_iter (*it_end)(struct SNAME *);                                  \
+                                                                                        \
+        /* Custom allocation functions */                                               \
+        struct cmc_alloc_node *alloc;                                                   \
+    };                                                                                  \
+                                                                                        \
+    /* OrderedHashMap Entry */                                                          \
+    struct SNAME##_entry                                                                \
+    {                                                                                   \
+        /* Entry Key */                                                                 \
+        K key;                                                                          \
+                                                                                        \
+        /* Entry Value */                                                               \
+        V value;                                                                        \
+                                                                                        \
+        /* The hash of the key, used to move it to a new index */                       \
+        size_t hash;                                                                    \
+                                                                                        \
+        /* False once the entry was removed */                                          \
+        bool filled;                                                                    \
+    };                                                                                  \
+                                                                                        \
+    /* OrderedHashMap Iterator */                                                       \
+    struct SNAME##_iter                                                                 \
+    {                                                                                   \
+        /* Target hashmap */                                                            \
+        struct SNAME *target;                                                           \
+                                                                                        \
+        /* Cursor's position in the array of entries */                                 \
+        size_t cursor;                                                                  \
+                                                                                        \
+        /* Keeps track of relative index to the iteration of elements */                \
+        size_t index;                                                                   \
+                                                                                        \
+        /* The position of the first element */                                         \
+        size_t first;                                                                   \
+                                                                                        \
+        /* The position of the last element */                                          \
+        size_t last;                                                                    \
+                                                                                        \
+        /* If the iterator has reached the start of the iteration */                    \
+        bool start;                                                                     \
+                                                                                        \
+        /* If the iterator has reached the end of the iteration */                      \
+        bool end;                                                                       \
+    };                                                                                  \
+                                                                                        \
+    /* Collection Functions */                                                          \
+    /* Collection Allocation and Deallocation */                                        \
+    struct SNAME *PFX##_new(size_t capacity, double load, int (*compare)(K, K),         \
+                            size_t (*hash)(K));                                         \
+    struct SNAME *PFX##_new_custom(size_t capacity, double load, int (*compare)(K, K),  \
+                                   size_t (*hash)(K), struct cmc_alloc_node *alloc);    \
+    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V));                   \
+    void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V));                    \
+    /* Collection Input and Output */                                                   \
+    bool PFX##_insert(struct SNAME *_map_, K key, V value);                             \
+    size_t PFX##_insert_many(struct SNAME *_map_, K *keys, V *values, size_t n);        \
+    V *PFX##_get_or_insert(struct SNAME *_map_, K key, V default_value);                \
+    bool PFX##_upsert(struct SNAME *_map_, K key, V value);                             \
+    bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value);           \
+    bool PFX##_remove(struct SNAME *_map_, K key, V *out_value);                        \
+    /* Element Access */                                                                \
+    bool PFX##_max(struct SNAME *_map_, K *key, V *value);                              \
+    bool PFX##_min(struct SNAME *_map_, K *key, V *value);                              \
+    bool PFX##_first(struct SNAME *_map_, K *key, V *value);                            \
+    bool PFX##_last(struct SNAME *_map_, K *key, V *value);                             \
+    V PFX##_get(struct SNAME *_map_, K key);                                            \
+    V *PFX##_get_ref(struct SNAME *_map_, K key);                                       \
+    size_t PFX##_get_many(struct SNAME *_map_, K *CMC_RESTRICT keys, size_t n,          \
+                          V *CMC_RESTRICT out, bool *CMC_RESTRICT found);               \
+    /* Collection State */                                                              \
+    bool PFX##_contains(struct SNAME *_map_, K key);                                    \
+    size_t PFX##_contains_many(struct SNAME *_map_, K *keys, size_t n, bool *found);    \
+    CMC_PURE bool PFX##_empty(struct SNAME *_map_);                                     \
+    bool PFX##_full(struct SNAME *_map_);                                               \
+    CMC_PURE size_t PFX##_count(struct SNAME *_map_);                                   \
+    size_t PFX##_memory_usage(struct SNAME *_map_);                                     \
+    size_t PFX##_capacity(struct SNAME *_map_);                                         \
+    double PFX##_load(struct SNAME *_map_);                                             \
+    void PFX##_stats(struct SNAME *_map_, struct cmc_hashtable_stats *out);             \
+    /* Collection Utility */                                                            \
+    bool PFX##_resize(struct SNAME *_map_, size_t capacity);                            \
+    bool PFX##_shrink_to_fit(struct SNAME *_map_);                                      \
+    struct SNAME *PFX##_copy_of(struct SNAME *_map_, K (*key_copy_func)(K),             \
+                                V (*value_copy_func)(V));                               \
+    bool PFX##_equals(struct SNAME *_map1_, struct SNAME *_map2_,                       \
+                      int (*value_comparator)(V, V));                                   \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_);                             \
+    bool PFX##_to_string_full(struct SNAME *_map_, struct cmc_string_builder *builder,  \
+                              const char *elem_fmt);                                    \
+    bool PFX##_write(struct SNAME *_map_, FILE *file,                                   \
+                     void (*fmt)(FILE *, K, V));                                        \
+    bool PFX##_write_fd(struct SNAME *_map_, int fd,                                    \
+                        void (*fmt)(struct cmc_dump *, K, V));                          \
+    /* Collection Serialization */                                                      \
+    bool PFX##_save(struct SNAME *_map_, FILE *file, bool (*key_writer)(K, FILE *),     \
+                    bool (*value_writer)(V, FILE *));                                   \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(K, K), size_t (*hash)(K),    \
+                                bool (*key_reader)(K *, FILE *),                        \
+                                bool (*value_reader)(V *, FILE *));                     \
+                                                                                        \
+    /* Iterator Functions */                                                            \
+    /* Iterator Allocation and Deallocation */                                          \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target);                          \
+    void PFX##_iter_free(struct SNAME##_iter *iter);                                    \
+    /* Iterator Initialization */                                                       \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);              \
+    /* Iterator State */                                                                \
+    bool PFX##_iter_start(struct SNAME##_iter *iter);                                   \
+    bool PFX##_iter_end(struct SNAME##_iter *iter);                                     \
+    /* Iterator Movement */                                                             \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter);                                \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter);                                  \
+    bool PFX##_iter_next(struct SNAME##_iter *iter);                                    \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter);                                    \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps);                   \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps);                    \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index);                     \
+    /* Iterator Access */                                                               \
+    K PFX##_iter_key(struct SNAME##_iter *iter);                                        \
+    V PFX##_iter_value(struct SNAME##_iter *iter);                                      \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter);                                    \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter);                                 \
+                                                                                        \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_ORDEREDHASHMAP_SOURCE(PFX, SNAME, K, V)                                     \
+                                                                                                 \
+    /* Implementation Detail Functions */                                                        \
+    static inline size_t PFX##_impl_index_get(struct SNAME *_map_, size_t slot);                 \
+    static inline void PFX##_impl_index_set(struct SNAME *_map_, size_t slot, size_t value);     \
+    static size_t PFX##_impl_find(struct SNAME *_map_, K key, size_t hash, bool *found);         \
+    static struct SNAME##_entry *PFX##_impl_get_entry(struct SNAME *_map_, K key);               \
+    static struct SNAME##_entry *PFX##_impl_append(struct SNAME *_map_, size_t slot, K key,      \
+                                                   V value, size_t hash);                        \
+    static void PFX##_impl_remove_slot(struct SNAME *_map_, size_t slot);                        \
+    static bool PFX##_impl_rehash(struct SNAME *_map_, size_t capacity);                         \
+    static bool PFX##_impl_grow(struct SNAME *_map_);                                            \
+    static size_t PFX##_impl_width(size_t limit);                                                \
+    static size_t PFX##_impl_next_filled(struct SNAME *_map_, size_t from);                      \
+    static size_t PFX##_impl_prev_filled(struct SNAME *_map_, size_t from);                      \
+    static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_map_);                         \
+    static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_map_);                           \
+                                                                                                 \
+    struct SNAME *PFX##_new(size_t capacity, double load, int (*compare)(K, K),                  \
+                            size_t (*hash)(K))                                                   \
+    {                                                                                            \
+        return PFX##_new_custom(capacity, load, compare, hash, NULL);                            \
+    }                                                                                            \
+                                                                                                 \
+    struct SNAME *PFX##_new_custom(size_t capacity, double load, int (*compare)(K, K),           \
+                                   size_t (*hash)(K), struct cmc_alloc_node *alloc)              \
+    {                                                                                            \
+        if (!alloc)                                                                              \
+            alloc = &cmc_alloc_node_default;                                                     \
+                                                                                                 \
+        if (capacity == 0 || load <= 0 || load >= 1)                                             \
+            return NULL;                                                                         \
+                                                                                                 \
+        /* Prevent integer overflow */                                                           \
+        if (capacity >= UINTMAX_MAX * load)                                                      \
+            return NULL;                                                                         \
+                                                                                                 \
+        struct SNAME *_map_ = alloc->malloc(sizeof(struct SNAME));                               \
+                                                                                                 \
+        if (CMC_UNLIKELY(!_map_))                                                                \
+            return NULL;                                                                         \
+                                                                                                 \
+        _map_->alloc = alloc;                                                                    \
+                                                                                                 \
+        _map_->entries = NULL;                                                                   \
+        _map_->index = NULL;                                                                     \
+        _map_->width = 0;                                                                        \
+        _map_->capacity = 0;                                                                     \
+        _map_->count = 0;                                                                        \
+        _map_->used = 0;                                                                         \
+        _map_->limit = 0;                                                                        \
+        _map_->load = load;                                                                      \
+        _map_->cmp = compare;                                                                    \
+        _map_->hash = hash;                                                                      \
+                                                                                                 \
+        if (!PFX##_impl_rehash(_map_, capacity))                                                 \
+        {                                                                                        \
+            alloc->free(_map_);                                                                  \
+            return NULL;                                                                         \
+        }                                                                                        \
+                                                                                                 \
+        CMC_IMPL_HASHTABLE_PROBE_RESET(_map_);                                                   \
+                                                                                                 \
+        _map_->it_start = PFX##_impl_it_start;                                                   \
+        _map_->it_end = PFX##_impl_it_end;                                                       \
+                                                                                                 \
+        return _map_;                                                                            \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V))                             \
+    {                                                                                            \
+        if (deallocator)                                                                         \
+        {                                                                                        \
+            for (size_t i = 0; i < _map_->used; i++)                                             \
+            {                                                                                    \
+                struct SNAME##_entry *entry = &(_map_->entries[i]);                              \
+                                                                                                 \
+                if (entry->filled)                                                               \
+                    deallocator(entry->key, entry->value);                                       \
+            }                                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        memset(_map_->index, 0, _map_->capacity * _map_->width);                                 \
+                                                                                                 \
+        _map_->count = 0;                                                                        \
+        _map_->used = 0;                                                                         \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V))                              \
+    {                                                                                            \
+        if (deallocator)                                                                         \
+        {                                                                                        \
+            for (size_t i = 0; i < _map_->used; i++)                                             \
+            {                                                                                    \
+                struct SNAME##_entry *entry = &(_map_->entries[i]);                              \
+                                                                                                 \
+                if (entry->filled)                                                               \
+                    deallocator(entry->key, entry->value);                                       \
+            }                                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        _map_->alloc->free(_map_->entries);                                                      \
+        _map_->alloc->free(_map_->index);                                                        \
+        _map_->alloc->free(_map_);                                                               \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_insert(struct SNAME *_map_, K key, V value)                                       \
+    {                                                                                            \
+        if (PFX##_full(_map_))                                                                   \
+        {                                                                                        \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_map_)))                                           \
+                return false;                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        size_t hash = _map_->hash(key);                                                          \
+                                                                                                 \
+        bool found;                                                                              \
+        size_t slot = PFX##_impl_find(_map_, key, hash, &found);                                 \
+                                                                                                 \
+        if (found)                                                                               \
+            return false;                                                                        \
+                                                                                                 \
+        PFX##_impl_append(_map_, slot, key, value, hash);                                        \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_insert_many(struct SNAME *_map_, K *keys, V *values, size_t n)                  \
+    {                                                                                            \
+        /* Grow once for every key instead of one threshold at a time */                         \
+        if (CMC_UNLIKELY(!PFX##_resize(_map_, _map_->used + n)))                                 \
+            return 0;                                                                            \
+                                                                                                 \
+        size_t total = 0;                                                                        \
+                                                                                                 \
+        for (size_t i = 0; i < n; i++)                                                           \
+        {                                                                                        \
+            if (PFX##_insert(_map_, keys[i], values[i]))                                         \
+                total++;                                                                         \
+        }                                                                                        \
+                                                                                                 \
+        return total;                                                                            \
+    }                                                                                            \
+                                                                                                 \
+    V *PFX##_get_or_insert(struct SNAME *_map_, K key, V default_value)                          \
+    {                                                                                            \
+        if (PFX##_full(_map_))                                                                   \
+        {                                                                                        \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_map_)))                                           \
+                return NULL;                                                                     \
+        }                                                                                        \
+                                                                                                 \
+        size_t hash = _map_->hash(key);                                                          \
+                                                                                                 \
+        bool found;                                                                              \
+        size_t slot = PFX##_impl_find(_map_, key, hash, &found);                                 \
+                                                                                                 \
+        if (found)                                                                               \
+            return &(_map_->entries[PFX##_impl_index_get(_map_, slot) - 1].value);               \
+                                                                                                 \
+        return &(PFX##_impl_append(_map_, slot, key, default_value, hash)->value);               \
+    }                                                                                            \
+                                                                                                 \
+    /* An existing key keeps its position */                                                     \
+    bool PFX##_upsert(struct SNAME *_map_, K key, V value)                                       \
+    {                                                                                            \
+        V *ref = PFX##_get_or_insert(_map_, key, value);                                         \
+                                                                                                 \
+        if (!ref)                                                                                \
+            return false;                                                                        \
+                                                                                                 \
+        *ref = value;                                                                            \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value)                     \
+    {                                                                                            \
+        struct SNAME##_entry *entry = PFX##_impl_get_entry(_map_, key);                          \
+                                                                                                 \
+        if (!entry)                                                                              \
+            return false;                                                                        \
+                                                                                                 \
+        if (old_value)                                                                           \
+            *old_value = entry->value;                                                           \
+                                                                                                 \
+        entry->value = new_value;                                                                \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_remove(struct SNAME *_map_, K key, V *out_value)                                  \
+    {                                                                                            \
+        bool found;                                                                              \
+        size_t slot = PFX##_impl_find(_map_, key, _map_->hash(key), &found);                     \
+                                                                                                 \
+        if (!found)                                                                              \
+            return false;                                                                        \
+                                                                                                 \
+        struct SNAME##_entry *entry = &(_map_->entries[PFX##_impl_index_get(_map_, slot) - 1]);  \
+                                                                                                 \
+        if (out_value)                                                                           \
+            *out_value = entry->value;                                                           \
+                                                                                                 \
+        PFX##_impl_remove_slot(_map_, slot);                                                     \
+                                                                                                 \
+        entry->key = (K){0};                                                                     \
+        entry->value = (V){0};                                                                   \
+        entry->filled = false;                                                                   \
+                                                                                                 \
+        _map_->count--;                                                                          \
+                                                                                                 \
+        /* Holes at the end are given back right away */                                         \
+        while (_map_->used > 0 && !_map_->entries[_map_->used - 1].filled)                       \
+            _map_->used--;                                                                       \
+                                                                                                 \
+        /* Shrinks the table once it is mostly empty */                                          \
+        if ((double)_map_->count < (double)_map_->limit * CMC_SHRINK_LOW_WATER)                  \
+            PFX##_shrink_to_fit(_map_);                                                          \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_max(struct SNAME *_map_, K *key, V *value)                                        \
+    {                                                                                            \
+        if (PFX##_empty(_map_))                                                                  \
+            return false;                                                                        \
+                                                                                                 \
+        struct SNAME##_entry *max = NULL;                                                        \
+                                                                                                 \
+        for (size_t i = 0; i < _map_->used; i++)                                                 \
+        {                                                                                        \
+            struct SNAME##_entry *entry = &(_map_->entries[i]);                                  \
+                                                                                                 \
+            if (entry->filled && (!max || _map_->cmp(entry->key, max->key) > 0))                 \
+                max = entry;                                                                     \
+        }                                                                                        \
+                                                                                                 \
+        if (key)                                                                                 \
+            *key = max->key;                                                                     \
+        if (value)                                                                               \
+            *value = max->value;                                                                 \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_min(struct SNAME *_map_, K *key, V *value)                                        \
+    {                                                                                            \
+        if (PFX##_empty(_map_))                                                                  \
+            return false;                                                                        \
+                                                                                                 \
+        struct SNAME##_entry *min = NULL;                                                        \
+                                                                                                 \
+        for (size_t i = 0; i < _map_->used; i++)                                                 \
+        {                                                                                        \
+            struct SNAME##_entry *entry = &(_map_->entries[i]);                                  \
+                                                                                                 \
+            if (entry->filled && (!min || _map_->cmp(entry->key, min->key) < 0))                 \
+                min = entry;                                                                     \
+        }                                                                                        \
+                                                                                                 \
+        if (key)                                                                                 \
+            *key = min->key;                                                                     \
+        if (value)                                                                               \
+            *value = min->value;                                                                 \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* The key that was inserted the longest time ago */                                         \
+    bool PFX##_first(struct SNAME *_map_, K *key, V *value)                                      \
+    {                                                                                            \
+        if (PFX##_empty(_map_))                                                                  \
+            return false;                                                                        \
+                                                                                                 \
+        struct SNAME##_entry *entry = &(_map_->entries[PFX##_impl_next_filled(_map_, 0)]);       \
+                                                                                                 \
+        if (key)                                                                                 \
+            *key = entry->key;                                                                   \
+        if (value)                                                                               \
+            *value = entry->value;                                                               \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* The key that was inserted last */                                                         \
+    bool PFX##_last(struct SNAME *_map_, K *key, V *value)                                       \
+    {                                                                                            \
+        if (PFX##_empty(_map_))                                                                  \
+            return false;                                                                        \
+                                                                                                 \
+        /* There are no holes at the end of the entries */                                       \
+        struct SNAME##_entry *entry = &(_map_->entries[_map_->used - 1]);                        \
+                                                                                                 \
+        if (key)                                                                                 \
+            *key = entry->key;                                                                   \
+        if (value)                                                                               \
+            *value = entry->value;                                                               \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    V PFX##_get(struct SNAME *_map_, K key)                                                      \
+    {                                                                                            \
+        struct SNAME##_entry *entry = PFX##_impl_get_entry(_map_, key);                          \
+                                                                                                 \
+        if (!entry)                                                                              \
+            return (V){0};                                                                       \
+                                                                                                 \
+        return entry->value;                                                                     \
+    }                                                                                            \
+                                                                                                 \
+    V *PFX##_get_ref(struct SNAME *_map_, K key)                                                 \
+    {                                                                                            \
+        struct SNAME##_entry *entry = PFX##_impl_get_entry(_map_, key);                          \
+                                                                                                 \
+        if (!entry)                                                                              \
+            return NULL;                                                                         \
+                                                                                                 \
+        return &(entry->value);                                                                  \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_get_many(struct SNAME *_map_, K *CMC_RESTRICT keys, size_t n,                   \
+                          V *CMC_RESTRICT out, bool *CMC_RESTRICT found)                         \
+    {                                                                                            \
+        size_t total = 0;                                                                        \
+                                                                                                 \
+        for (size_t i = 0; i < n; i++)                                                           \
+        {                                                                                        \
+            struct SNAME##_entry *entry = PFX##_impl_get_entry(_map_, keys[i]);                  \
+                                                                                                 \
+            if (entry)                                                                           \
+                total++;                                                                         \
+                                                                                                 \
+            if (out)                                                                             \
+                out[i] = entry ? entry->value : (V){0};                                          \
+            if (found)                                                                           \
+                found[i] = entry != NULL;                                                        \
+        }                                                                                        \
+                                                                                                 \
+        return total;                                                                            \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_contains(struct SNAME *_map_, K key)                                              \
+    {                                                                                            \
+        return PFX##_impl_get_entry(_map_, key) != NULL;                                         \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_contains_many(struct SNAME *_map_, K *keys, size_t n, bool *found)              \
+    {                                                                                            \
+        return PFX##_get_many(_map_, keys, n, NULL, found);                                      \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_empty(struct SNAME *_map_)                                                        \
+    {                                                                                            \
+        return _map_->count == 0;                                                                \
+    }                                                                                            \
+                                                                                                 \
+    /* If the next insert has to compact or grow the entries */                                  \
+    bool PFX##_full(struct SNAME *_map_)                                                         \
+    {                                                                                            \
+        return _map_->used >= _map_->limit;                                                      \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_count(struct SNAME *_map_)                                                      \
+    {                                                                                            \
+        return _map_->count;                                                                     \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_memory_usage(struct SNAME *_map_)                                               \
+    {                                                                                            \
+        return sizeof(struct SNAME) + sizeof(struct SNAME##_entry) * _map_->limit +              \
+               _map_->width * _map_->capacity;                                                   \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_capacity(struct SNAME *_map_)                                                   \
+    {                                                                                            \
+        return _map_->capacity;                                                                  \
+    }                                                                                            \
+                                                                                                 \
+    double PFX##_load(struct SNAME *_map_)                                                       \
+    {                                                                                            \
+        return _map_->load;                                                                      \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_stats(struct SNAME *_map_, struct cmc_hashtable_stats *out)                       \
+    {                                                                                            \
+        memset(out, 0, sizeof(struct cmc_hashtable_stats));                                      \
+                                                                                                 \
+        out->capacity = _map_->capacity;                                                         \
+        out->count = _map_->count;                                                               \
+        out->bytes = sizeof(struct SNAME) + sizeof(struct SNAME##_entry) * _map_->limit +        \
+                     _map_->width * _map_->capacity;                                             \
+                                                                                                 \
+        for (size_t i = 0; i < _map_->capacity; i++)                                             \
+        {                                                                                        \
+            size_t position = PFX##_impl_index_get(_map_, i);                                    \
+                                                                                                 \
+            if (position == 0)                                                                   \
+                continue;                                                                        \
+                                                                                                 \
+            size_t hash = _map_->entries[position - 1].hash;                                     \
+            size_t home = CMC_IMPL_HASHTABLE_POW2_HOME(hash, _map_->capacity);                   \
+                                                                                                 \
+            cmc_hashtable_stats_add(out, (i - home) & (_map_->capacity - 1));                    \
+        }                                                                                        \
+                                                                                                 \
+        CMC_IMPL_HASHTABLE_PROBE_ADD(out, _map_);                                                \
+                                                                                                 \
+        cmc_hashtable_stats_end(out);                                                            \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_resize(struct SNAME *_map_, size_t capacity)                                      \
+    {                                                                                            \
+        if (_map_->limit >= capacity)                                                            \
+            return true;                                                                         \
+                                                                                                 \
+        /* Prevent integer overflow */                                                           \
+        if (capacity >= UINTMAX_MAX * PFX##_load(_map_))                                         \
+            return false;                                                                        \
+                                                                                                 \
+        return PFX##_impl_rehash(_map_, capacity);                                               \
+    }                                                                                            \
+                                                                                                 \
+    /* Also compacts the entries */                                                              \
+    bool PFX##_shrink_to_fit(struct SNAME *_map_)                                                \
+    {                                                                                            \
+        return PFX##_impl_rehash(_map_, _map_->count > 0 ? _map_->count : 1);                    \
+    }                                                                                            \
+                                                                                                 \
+    struct SNAME *PFX##_copy_of(struct SNAME *_map_, K (*key_copy_func)(K),                      \
+                                V (*value_copy_func)(V))                                         \
+    {                                                                                            \
+        struct SNAME *result = _map_->alloc->malloc(sizeof(struct SNAME));                       \
+                                                                                                 \
+        if (CMC_UNLIKELY(!result))                                                               \
+            return NULL;                                                                         \
+                                                                                                 \
+        *result = *_map_;                                                                        \
+                                                                                                 \
+        /* Entries are copied to the same positions so the index is the same */                  \
+        result->entries = _map_->alloc->malloc(sizeof(struct SNAME##_entry) * _map_->limit);     \
+        result->index = _map_->alloc->malloc(_map_->width * _map_->capacity);                    \
+                                                                                                 \
+        if (!result->entries || !result->index)                                                  \
+        {                                                                                        \
+            _map_->alloc->free(result->entries);                                                 \
+            _map_->alloc->free(result->index);                                                   \
+            _map_->alloc->free(result);                                                          \
+            return NULL;                                                                         \
+        }                                                                                        \
+                                                                                                 \
+        memcpy(result->index, _map_->index, _map_->width * _map_->capacity);                     \
+        memcpy(result->entries, _map_->entries, sizeof(struct SNAME##_entry) * _map_->used);     \
+                                                                                                 \
+        if (key_copy_func || value_copy_func)                                                    \
+        {                                                                                        \
+            for (size_t i = 0; i < result->used; i++)                                            \
+            {                                                                                    \
+                struct SNAME##_entry *entry = &(result->entries[i]);                             \
+                                                                                                 \
+                if (!entry->filled)                                                              \
+                    continue;                                                                    \
+                                                                                                 \
+                if (key_copy_func)                                                               \
+                    entry->key = key_copy_func(entry->key);                                      \
+                if (value_copy_func)                                                             \
+                    entry->value = value_copy_func(entry->value);                                \
+            }                                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        CMC_IMPL_HASHTABLE_PROBE_RESET(result);                                                  \
+                                                                                                 \
+        return result;                                                                           \
+    }                                                                                            \
+                                                                                                 \
+    /* Maps are equal if they have the same keys, in any order */                                \
+    bool PFX##_equals(struct SNAME *_map1_, struct SNAME *_map2_, int (*value_comparator)(V, V)) \
+    {                                                                                            \
+        if (PFX##_count(_map1_) != PFX##_count(_map2_))                                          \
+            return false;                                                                        \
+                                                                                                 \
+        for (size_t i = 0; i < _map1_->used; i++)                                                \
+        {                                                                                        \
+            struct SNAME##_entry *scan = &(_map1_->entries[i]);                                  \
+                                                                                                 \
+            if (!scan->filled)                                                                   \
+                continue;                                                                        \
+                                                                                                 \
+            struct SNAME##_entry *entry = PFX##_impl_get_entry(_map2_, scan->key);               \
+                                                                                                 \
+            if (entry == NULL)                                                                   \
+                return false;                                                                    \
+                                                                                                 \
+            if (value_comparator && value_comparator(entry->value, scan->value) != 0)            \
+                return false;                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_)                                       \
+    {                                                                                            \
+        struct cmc_string str;                                                                   \
+        struct SNAME *m_ = _map_;                                                                \
+        const char *name = #SNAME;                                                               \
+                                                                                                 \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_orderedhashmap, name, m_, m_->entries,    \
+                 m_->index, m_->capacity, m_->count, m_->used, m_->load, m_->cmp, m_->hash);     \
+                                                                                                 \
+        return str;                                                                              \
+    }                                                                                            \
+                                                                                                 \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_ENTRY)                               \
+                                                                                                 \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_ENTRY, (K, V))                              \
+                                                                                                 \
+    /* Entries are written in the order they were inserted, which restore */                     \
+    /* brings back */                                                                            \
+    bool PFX##_save(struct SNAME *_map_, FILE *file, bool (*key_writer)(K, FILE *),              \
+                    bool (*value_writer)(V, FILE *))                                             \
+    {                                                                                            \
+        uint32_t flags = (key_writer ? 0 : CMC_SERIAL_RAW_KEYS) |                                \
+                         (value_writer ? 0 : CMC_SERIAL_RAW_VALUES);                             \
+                                                                                                 \
+        if (!cmc_serial_write_header(file, "orderedhashmap", flags, sizeof(K), sizeof(V), 0,     \
+                                     _map_->count, _map_->capacity, _map_->load))                \
+            return false;                                                                        \
+                                                                                                 \
+        for (size_t i = 0; i < _map_->used; i++)                                                 \
+        {                                                                                        \
+            struct SNAME##_entry *entry = &(_map_->entries[i]);                                  \
+                                                                                                 \
+            if (!entry->filled)                                                                  \
+                continue;                                                                        \
+                                                                                                 \
+            if (!CMC_SERIAL_WRITE(key_writer, entry->key, file) ||                               \
+                !CMC_SERIAL_WRITE(value_writer, entry->value, file))                             \
+                return false;                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Each reader is only used if the keys or values were saved with a writer */                \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(K, K), size_t (*hash)(K),             \
+                                bool (*key_reader)(K *, FILE *),                                 \
+                                bool (*value_reader)(V *, FILE *))                               \
+    {                                                                                            \
+        struct cmc_serial_header header;                                                         \
+                                                                                                 \
+        if (!cmc_serial_read_header(file, "orderedhashmap", sizeof(K), sizeof(V), &header))      \
+            return NULL;                                                                         \
+                                                                                                 \
+        /* Allocated for every key so that loading never grows */                                \
+        struct SNAME *_map_ =                                                                    \
+            PFX##_new(header.count > 0 ? header.count : 1, header.load, compare, hash);          \
+                                                                                                 \
+        if (!_map_)                                                                              \
+            return NULL;                                                                         \
+                                                                                                 \
+        bool raw_keys = header.flags & CMC_SERIAL_RAW_KEYS;                                      \
+        bool raw_values = header.flags & CMC_SERIAL_RAW_VALUES;                                  \
+                                                                                                 \
+        for (size_t i = 0; i < header.count; i++)                                                \
+        {                                                                                        \
+            K key;                                                                               \
+            V value;                                                                             \
+                                                                                                 \
+            if (!CMC_SERIAL_READ(raw_keys, key_reader, &key, file) ||                            \
+                !CMC_SERIAL_READ(raw_values, value_reader, &value, file) ||                      \
+                !PFX##_insert(_map_, key, value))                                                \
+            {                                                                                    \
+                PFX##_free(_map_, NULL);                                                         \
+                return NULL;                                                                     \
+            }                                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        return _map_;                                                                            \
+    }                                                                                            \
+                                                                                                 \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                    \
+    {                                                                                            \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));          \
+                                                                                                 \
+        if (CMC_UNLIKELY(!iter))                                                                 \
+            return NULL;                                                                         \
+                                                                                                 \
+        PFX##_iter_init(iter, target);                                                           \
+                                                                                                 \
+        return iter;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_iter_free(struct SNAME##_iter *iter)                                              \
+    {                                                                                            \
+        iter->target->alloc->free(iter);                                                         \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                        \
+    {                                                                                            \
+        memset(iter, 0, sizeof(struct SNAME##_iter));                                            \
+                                                                                                 \
+        iter->target = target;                                                                   \
+        iter->start = true;                                                                      \
+        iter->end = PFX##_empty(target);                                                         \
+                                                                                                 \
+        if (!PFX##_empty(target))                                                                \
+        {                                                                                        \
+            iter->first = PFX##_impl_next_filled(target, 0);                                     \
+            iter->last = target->used - 1;                                                       \
+            iter->cursor = iter->first;                                                          \
+        }                                                                                        \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                             \
+    {                                                                                            \
+        return PFX##_empty(iter->target) || iter->start;                                         \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                               \
+    {                                                                                            \
+        return PFX##_empty(iter->target) || iter->end;                                           \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                          \
+    {                                                                                            \
+        if (!PFX##_empty(iter->target))                                                          \
+        {                                                                                        \
+            iter->cursor = iter->first;                                                          \
+            iter->index = 0;                                                                     \
+            iter->start = true;                                                                  \
+            iter->end = PFX##_empty(iter->target);                                               \
+        }                                                                                        \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                            \
+    {                                                                                            \
+        if (!PFX##_empty(iter->target))                                                          \
+        {                                                                                        \
+            iter->cursor = iter->last;                                                           \
+            iter->index = PFX##_count(iter->target) - 1;                                         \
+            iter->start = PFX##_empty(iter->target);                                             \
+            iter->end = true;                                                                    \
+        }                                                                                        \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                              \
+    {                                                                                            \
+        if (iter->end)                                                                           \
+            return false;                                                                        \
+                                                                                                 \
+        if (iter->index + 1 == PFX##_count(iter->target))                                        \
+        {                                                                                        \
+            iter->end = true;                                                                    \
+            return false;                                                                        \
+        }                                                                                        \
+                                                                                                 \
+        iter->start = PFX##_empty(iter->target);                                                 \
+                                                                                                 \
+        iter->index++;                                                                           \
+        iter->cursor = PFX##_impl_next_filled(iter->target, iter->cursor + 1);                   \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                              \
+    {                                                                                            \
+        if (iter->start)                                                                         \
+            return false;                                                                        \
+                                                                                                 \
+        if (iter->index == 0)                                                                    \
+        {                                                                                        \
+            iter->start = true;                                                                  \
+            return false;                                                                        \
+        }                                                                                        \
+                                                                                                 \
+        iter->end = PFX##_empty(iter->target);                                                   \
+                                                                                                 \
+        iter->index--;                                                                           \
+        iter->cursor = PFX##_impl_prev_filled(iter->target, iter->cursor - 1);                   \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Returns true only if the iterator moved */                                                \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps)                             \
+    {                                                                                            \
+        if (iter->end)                                                                           \
+            return false;                                                                        \
+                                                                                                 \
+        if (iter->index + 1 == PFX##_count(iter->target))                                        \
+        {                                                                                        \
+            iter->end = true;                                                                    \
+            return false;                                                                        \
+        }                                                                                        \
+                                                                                                 \
+        if (steps == 0 || iter->index + steps >= PFX##_count(iter->target))                      \
+            return false;                                                                        \
+                                                                                                 \
+        for (size_t i = 0; i < steps; i++)                                                       \
+            PFX##_iter_next(iter);                                                               \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Returns true only if the iterator moved */                                                \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps)                              \
+    {                                                                                            \
+        if (iter->start)                                                                         \
+            return false;                                                                        \
+                                                                                                 \
+        if (iter->index == 0)                                                                    \
+        {                                                                                        \
+            iter->start = true;                                                                  \
+            return false;                                                                        \
+        }                                                                                        \
+                                                                                                 \
+        if (steps == 0 || iter->index < steps)                                                   \
+            return false;                                                                        \
+                                                                                                 \
+        for (size_t i = 0; i < steps; i++)                                                       \
+            PFX##_iter_prev(iter);                                                               \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Returns true only if the iterator was able to be positioned at the given index */         \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index)                               \
+    {                                                                                            \
+        if (index >= PFX##_count(iter->target))                                                  \
+            return false;                                                                        \
+                                                                                                 \
+        if (iter->index > index)                                                                 \
+            return PFX##_iter_rewind(iter, iter->index - index);                                 \
+        else if (iter->index < index)                                                            \
+            return PFX##_iter_advance(iter, index - iter->index);                                \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    K PFX##_iter_key(struct SNAME##_iter *iter)                                                  \
+    {                                                                                            \
+        if (PFX##_empty(iter->target))                                                           \
+            return (K){0};                                                                       \
+                                                                                                 \
+        return iter->target->entries[iter->cursor].key;                                          \
+    }                                                                                            \
+                                                                                                 \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                                \
+    {                                                                                            \
+        if (PFX##_empty(iter->target))                                                           \
+            return (V){0};                                                                       \
+                                                                                                 \
+        return iter->target->entries[iter->cursor].value;                                        \
+    }                                                                                            \
+                                                                                                 \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter)                                              \
+    {                                                                                            \
+        if (PFX##_empty(iter->target))                                                           \
+            return NULL;                                                                         \
+                                                                                                 \
+        return &(iter->target->entries[iter->cursor].value);                                     \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                           \
+    {                                                                                            \
+        return iter->index;                                                                      \
+    }                                                                                            \
+                                                                                                 \
+    static inline size_t PFX##_impl_index_get(struct SNAME *_map_, size_t slot)                  \
+    {                                                                                            \
+        switch (_map_->width)                                                                    \
+        {                                                                                        \
+            case 1:                                                                              \
+                return ((uint8_t *)_map_->index)[slot];                                          \
+            case 2:                                                                              \
+                return ((uint16_t *)_map_->index)[slot];                                         \
+            case 4:                                                                              \
+                return ((uint32_t *)_map_->index)[slot];                                         \
+            default:                                                                             \
+                return (size_t)((uint64_t *)_map_->index)[slot];                                 \
+        }                                                                                        \
+    }                                                                                            \
+                                                                                                 \
+    static inline void PFX##_impl_index_set(struct SNAME *_map_, size_t slot, size_t value)      \
+    {                                                                                            \
+        switch (_map_->width)                                                                    \
+        {                                                                                        \
+            case 1:                                                                              \
+                ((uint8_t *)_map_->index)[slot] = (uint8_t)value;                                \
+                break;                                                                           \
+            case 2:                                                                              \
+                ((uint16_t *)_map_->index)[slot] = (uint16_t)value;                              \
+                break;                                                                           \
+            case 4:                                                                              \
+                ((uint32_t *)_map_->index)[slot] = (uint32_t)value;                              \
+                break;                                                                           \
+            default:                                                                             \
+                ((uint64_t *)_map_->index)[slot] = (uint64_t)value;                              \
+                break;                                                                           \
+        }                                                                                        \
+    }                                                                                            \
+                                                                                                 \
+    /* Slot of the index that holds key or, if the key is not in the map, */                     \
+    /* the empty slot where it would be placed */                                                \
+    static size_t PFX##_impl_find(struct SNAME *_map_, K key, size_t hash, bool *found)          \
+    {                                                                                            \
+        CMC_IMPL_HASHTABLE_PROBE_LOOKUP(_map_);                                                  \
+                                                                                                 \
+        size_t slot = CMC_IMPL_HASHTABLE_POW2_HOME(hash, _map_->capacity);                       \
+        size_t position;                                                                         \
+                                                                                                 \
+        /* The index is never full so every probe ends at an empty slot */                       \
+        while ((position = PFX##_impl_index_get(_map_, slot)) != 0)                              \
+        {                                                                                        \
+            struct SNAME##_entry *entry = &(_map_->entries[position - 1]);                       \
+                                                                                                 \
+            CMC_IMPL_HASHTABLE_PROBE_SLOT(_map_);                                                \
+                                                                                                 \
+            if (entry->hash == hash && _map_->cmp(entry->key, key) == 0)                         \
+            {                                                                                    \
+                *found = true;                                                                   \
+                return slot;                                                                     \
+            }                                                                                    \
+                                                                                                 \
+            slot = CMC_IMPL_HASHTABLE_POW2_WRAP(slot + 1, _map_->capacity);                      \
+        }                                                                                        \
+                                                                                                 \
+        *found = false;                                                                          \
+        return slot;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    static struct SNAME##_entry *PFX##_impl_get_entry(struct SNAME *_map_, K key)                \
+    {                                                                                            \
+        bool found;                                                                              \
+        size_t slot = PFX##_impl_find(_map_, key, _map_->hash(key), &found);                     \
+                                                                                                 \
+        if (!found)                                                                              \
+            return NULL;                                                                         \
+                                                                                                 \
+        return &(_map_->entries[PFX##_impl_index_get(_map_, slot) - 1]);                         \
+    }                                                                                            \
+                                                                                                 \
+    /* Adds an entry after the last one and points the empty slot to it */                       \
+    static struct SNAME##_entry *PFX##_impl_append(struct SNAME *_map_, size_t slot, K key,      \
+                                                   V value, size_t hash)                         \
+    {                                                                                            \
+        struct SNAME##_entry *entry = &(_map_->entries[_map_->used]);                            \
+                                                                                                 \
+        entry->key = key;                                                                        \
+        entry->value = value;                                                                    \
+        entry->hash = hash;                                                                      \
+        entry->filled = true;                                                                    \
+                                                                                                 \
+        _map_->used++;                                                                           \
+        _map_->count++;                                                                          \
+                                                                                                 \
+        PFX##_impl_index_set(_map_, slot, _map_->used);                                          \
+                                                                                                 \
+        return entry;                                                                            \
+    }                                                                                            \
+                                                                                                 \
+    /* Backward shift deletion. Every slot that follows in the same cluster */                   \
+    /* is moved back if the empty slot is not before its original position */                    \
+    static void PFX##_impl_remove_slot(struct SNAME *_map_, size_t slot)                         \
+    {                                                                                            \
+        size_t mask = _map_->capacity - 1;                                                       \
+        size_t empty = slot;                                                                     \
+        size_t next = (slot + 1) & mask;                                                         \
+        size_t position;                                                                         \
+                                                                                                 \
+        while ((position = PFX##_impl_index_get(_map_, next)) != 0)                              \
+        {                                                                                        \
+            size_t hash = _map_->entries[position - 1].hash;                                     \
+            size_t home = CMC_IMPL_HASHTABLE_POW2_HOME(hash, _map_->capacity);                   \
+                                                                                                 \
+            if (((next - home) & mask) >= ((next - empty) & mask))                               \
+            {                                                                                    \
+                PFX##_impl_index_set(_map_, empty, position);                                    \
+                empty = next;                                                                    \
+            }                                                                                    \
+                                                                                                 \
+            next = (next + 1) & mask;                                                            \
+        }                                                                                        \
+                                                                                                 \
+        PFX##_impl_index_set(_map_, empty, 0);                                                   \
+    }                                                                                            \
+                                                                                                 \
+    /* Replaces the entries and the index by ones sized for capacity keys, */                    \
+    /* leaving out the holes of removed entries */                                               \
+    static bool PFX##_impl_rehash(struct SNAME *_map_, size_t capacity)                          \
+    {                                                                                            \
+        if (capacity < _map_->count)                                                             \
+            capacity = _map_->count;                                                             \
+                                                                                                 \
+        size_t slots = cmc_hashtable_pow2_size(capacity / _map_->load);                          \
+                                                                                                 \
+        /* Rounding down the limit must not leave less than capacity */                          \
+        while ((size_t)((double)slots * _map_->load) < capacity && slots <= SIZE_MAX / 2)        \
+            slots <<= 1;                                                                         \
+                                                                                                 \
+        size_t limit = (size_t)((double)slots * _map_->load);                                    \
+        size_t width = PFX##_impl_width(limit);                                                  \
+                                                                                                 \
+        if (limit > SIZE_MAX / sizeof(struct SNAME##_entry))                                     \
+            return false;                                                                        \
+                                                                                                 \
+        struct SNAME##_entry *entries =                                                          \
+            _map_->alloc->malloc(sizeof(struct SNAME##_entry) * limit);                          \
+        void *index = _map_->alloc->calloc(slots, width);                                        \
+                                                                                                 \
+        if (!entries || !index)                                                                  \
+        {                                                                                        \
+            _map_->alloc->free(entries);                                                         \
+            _map_->alloc->free(index);                                                           \
+            return false;                                                                        \
+        }                                                                                        \
+                                                                                                 \
+        _map_->alloc->free(_map_->index);                                                        \
+                                                                                                 \
+        _map_->index = index;                                                                    \
+        _map_->width = width;                                                                    \
+        _map_->capacity = slots;                                                                 \
+                                                                                                 \
+        size_t used = 0;                                                                         \
+                                                                                                 \
+        for (size_t i = 0; i < _map_->used; i++)                                                 \
+        {                                                                                        \
+            struct SNAME##_entry *entry = &(_map_->entries[i]);                                  \
+                                                                                                 \
+            if (!entry->filled)                                                                  \
+                continue;                                                                        \
+                                                                                                 \
+            size_t slot = CMC_IMPL_HASHTABLE_POW2_HOME(entry->hash, slots);                      \
+                                                                                                 \
+            /* Every key is unique so only an empty slot is needed */                            \
+            while (PFX##_impl_index_get(_map_, slot) != 0)                                       \
+                slot = CMC_IMPL_HASHTABLE_POW2_WRAP(slot + 1, slots);                            \
+                                                                                                 \
+            entries[used++] = *entry;                                                            \
+                                                                                                 \
+            PFX##_impl_index_set(_map_, slot, used);                                             \
+        }                                                                                        \
+                                                                                                 \
+        _map_->alloc->free(_map_->entries);                                                      \
+                                                                                                 \
+        _map_->entries = entries;                                                                \
+        _map_->used = used;                                                                      \
+        _map_->limit = limit;                                                                    \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Called when there is no room after the last entry. The new entries */                     \
+    /* fit at least half again as many keys, so the holes of a map with */                       \
+    /* many removals are compacted without growing */                                            \
+    static bool PFX##_impl_grow(struct SNAME *_map_)                                             \
+    {                                                                                            \
+        size_t capacity = _map_->count + _map_->count / 2 + 1;                                   \
+                                                                                                 \
+        /* Prevent integer overflow */                                                           \
+        if (capacity >= UINTMAX_MAX * PFX##_load(_map_))                                         \
+            return false;                                                                        \
+                                                                                                 \
+        return PFX##_impl_rehash(_map_, capacity);                                               \
+    }                                                                                            \
+                                                                                                 \
+    /* Bytes of a slot of the index that can hold every position up to limit */                  \
+    static size_t PFX##_impl_width(size_t limit)                                                 \
+    {                                                                                            \
+        if (limit <= UINT8_MAX)                                                                  \
+            return 1;                                                                            \
+        else if (limit <= UINT16_MAX)                                                            \
+            return 2;                                                                            \
+        else if (limit <= UINT32_MAX)                                                            \
+            return 4;                                                                            \
+                                                                                                 \
+        return 8;                                                                                \
+    }                                                                                            \
+                                                                                                 \
+    static size_t PFX##_impl_next_filled(struct SNAME *_map_, size_t from)                       \
+    {                                                                                            \
+        while (from < _map_->used && !_map_->entries[from].filled)                               \
+            from++;                                                                              \
+                                                                                                 \
+        return from;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    static size_t PFX##_impl_prev_filled(struct SNAME *_map_, size_t from)                       \
+    {                                                                                            \
+        while (from > 0 && !_map_->entries[from].filled)                                         \
+            from--;                                                                              \
+                                                                                                 \
+        return from;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_map_)                          \
+    {                                                                                            \
+        struct SNAME##_iter iter;                                                                \
+                                                                                                 \
+        PFX##_iter_init(&iter, _map_);                                                           \
+        PFX##_iter_to_start(&iter);                                                              \
+                                                                                                 \
+        return iter;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_map_)                            \
+    {                                                                                            \
+        struct SNAME##_iter iter;                                                                \
+                                                                                                 \
+        PFX##_iter_init(&iter, _map_);                                                           \
+        PFX##_iter_to_end(&iter);                                                                \
+                                                                                                 \
+        return iter;                                                                             \
+    }
+
+#endif /* CMC_ORDEREDHASHMAP_H */
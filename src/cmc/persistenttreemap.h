@@ -0,0 +1,784 @@
+/**
+ * persistenttreemap.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * PersistentTreeMap
+ *
+ * A PersistentTreeMap is a TreeMap that keeps every version of itself that is
+ * still in use. A snapshot is a read-only version of the map taken in
+ * constant time, which can be read by any thread without locks while the map
+ * keeps being modified.
+ *
+ * Implementation
+ *
+ * This implementation uses an AVL tree whose nodes have no parent and can be
+ * shared by many versions. Each node counts its references, whether from
+ * parent nodes or from the roots of the map and of snapshots. A modification
+ * copies the nodes on its path that are shared with a snapshot (path
+ * copying) and changes the ones that only belong to the map in place, so a
+ * map without snapshots is modified like a TreeMap and one with snapshots
+ * copies O(log n) nodes per modification. A node is freed when its last
+ * reference is dropped.
+ *
+ * The map itself must only be used by one thread at a time, the one that
+ * modifies it, which is also the one that takes snapshots. Snapshots can be
+ * read and released from any thread. Running out of memory in the middle of a
+ * modification leaves the map as it was, but a removal that cannot copy a
+ * node it has to rotate leaves that part of the tree less balanced.
+ *
+ * Removed and replaced keys and values are not deallocated, since snapshots
+ * might still be using them. Requires C11 atomics.
+ */
+
+#ifndef CMC_PERSISTENTTREEMAP_H
+#define CMC_PERSISTENTTREEMAP_H
+
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_persistenttreemap = "%s at %p { root:%p, count:%" PRIuMAX ", cmp:%p }";
+
+/* No AVL tree with less than 2^64 nodes is as tall as this */
+#define CMC_PERSISTENT_TREE_MAX_HEIGHT 96
+
+#define CMC_GENERATE_PERSISTENT_TREEMAP(PFX, SNAME, K, V)    \
+    CMC_GENERATE_PERSISTENT_TREEMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_PERSISTENT_TREEMAP_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_PERSISTENT_TREEMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_PERSISTENT_TREEMAP_HEADER(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_PERSISTENT_TREEMAP_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_PERSISTENT_TREEMAP_SOURCE(PFX, SNAME, K, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_PERSISTENT_TREEMAP_HEADER(PFX, SNAME, K, V)                      \
+                                                                                      \
+    /* PersistentTreeMap Structure */                                                 \
+    struct SNAME                                                                      \
+    {                                                                                 \
+        /* Root node of the current version */                                        \
+        struct SNAME##_node *root;                                                    \
+                                                                                      \
+        /* Current amount of keys */                                                  \
+        size_t count;                                                                 \
+                                                                                      \
+        /* Key comparison function */                                                 \
+        int (*cmp)(K, K);                                                             \
+                                                                                      \
+        /* Custom allocation functions */                                             \
+        struct cmc_alloc_node *alloc;                                                 \
+    };                                                                                \
+                                                                                      \
+    /* PersistentTreeMap Node */                                                      \
+    struct SNAME##_node                                                               \
+    {                                                                                 \
+        /* Node Key */                                                                \
+        K key;                                                                        \
+                                                                                      \
+        /* Node Value */                                                              \
+        V value;                                                                      \
+                                                                                      \
+        /* Amount of nodes, maps and snapshots that point to this node */             \
+        atomic_size_t refs;                                                           \
+                                                                                      \
+        /* Node height used by the AVL tree to keep it strictly balanced */           \
+        unsigned char height;                                                         \
+                                                                                      \
+        /* Right child node or subtree */                                             \
+        struct SNAME##_node *right;                                                   \
+                                                                                      \
+        /* Left child node or subtree */                                              \
+        struct SNAME##_node *left;                                                    \
+    };                                                                                \
+                                                                                      \
+    /* A read-only version of a PersistentTreeMap */                                  \
+    struct SNAME##_snapshot                                                           \
+    {                                                                                 \
+        /* Root node of the version, which the snapshot holds a reference to */       \
+        struct SNAME##_node *root;                                                    \
+                                                                                      \
+        /* Amount of keys in the version */                                           \
+        size_t count;                                                                 \
+                                                                                      \
+        /* Key comparison function */                                                 \
+        int (*cmp)(K, K);                                                             \
+                                                                                      \
+        /* Allocation functions of the map, which its nodes are freed with */         \
+        struct cmc_alloc_node *alloc;                                                 \
+    };                                                                                \
+                                                                                      \
+    /* PersistentTreeMap Iterator, which goes forward through a snapshot */           \
+    struct SNAME##_iter                                                               \
+    {                                                                                 \
+        /* Nodes whose left subtree was visited and that were not visited */          \
+        /* themselves, with the cursor on top */                                      \
+        struct SNAME##_node *stack[CMC_PERSISTENT_TREE_MAX_HEIGHT];                   \
+                                                                                      \
+        /* Amount of nodes in the stack */                                            \
+        size_t depth;                                                                 \
+                                                                                      \
+        /* Keeps track of relative index to the iteration of elements */              \
+        size_t index;                                                                 \
+    };                                                                                \
+                                                                                      \
+    /* Collection Functions */                                                        \
+    /* Collection Allocation and Deallocation */                                      \
+    struct SNAME *PFX##_new(int (*compare)(K, K));                                    \
+    struct SNAME *PFX##_new_custom(int (*compare)(K, K),                              \
+                                   struct cmc_alloc_node *alloc);                     \
+    void PFX##_clear(struct SNAME *_map_);                                            \
+    void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V));                  \
+    /* Collection Input and Output */                                                 \
+    bool PFX##_insert(struct SNAME *_map_, K key, V value);                           \
+    bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value);         \
+    bool PFX##_remove(struct SNAME *_map_, K key, V *out_value);                      \
+    /* Element Access */                                                              \
+    V PFX##_get(struct SNAME *_map_, K key);                                          \
+    /* Collection State */                                                            \
+    bool PFX##_contains(struct SNAME *_map_, K key);                                  \
+    CMC_PURE bool PFX##_empty(struct SNAME *_map_);                                   \
+    CMC_PURE size_t PFX##_count(struct SNAME *_map_);                                 \
+    size_t PFX##_memory_usage(struct SNAME *_map_);                                   \
+    /* Snapshots */                                                                   \
+    struct SNAME##_snapshot PFX##_snapshot(struct SNAME *_map_);                      \
+    void PFX##_snapshot_release(struct SNAME##_snapshot *snapshot);                   \
+    V PFX##_snapshot_get(struct SNAME##_snapshot *snapshot, K key);                   \
+    bool PFX##_snapshot_contains(struct SNAME##_snapshot *snapshot, K key);           \
+    size_t PFX##_snapshot_count(struct SNAME##_snapshot *snapshot);                   \
+    /* Collection Utility */                                                          \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_);                           \
+    bool PFX##_to_string_full(struct SNAME##_snapshot *snapshot,                      \
+                              struct cmc_string_builder *builder,                     \
+                              const char *elem_fmt);                                  \
+    bool PFX##_write(struct SNAME##_snapshot *snapshot, FILE *file,                   \
+                     void (*fmt)(FILE *, K, V));                                      \
+    bool PFX##_write_fd(struct SNAME##_snapshot *snapshot, int fd,                    \
+                        void (*fmt)(struct cmc_dump *, K, V));                        \
+                                                                                      \
+    /* Iterator Functions */                                                          \
+    /* Iterator Initialization */                                                     \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME##_snapshot *target); \
+    /* Iterator State */                                                              \
+    bool PFX##_iter_end(struct SNAME##_iter *iter);                                   \
+    /* Iterator Movement */                                                           \
+    bool PFX##_iter_next(struct SNAME##_iter *iter);                                  \
+    /* Iterator Access */                                                             \
+    K PFX##_iter_key(struct SNAME##_iter *iter);                                      \
+    V PFX##_iter_value(struct SNAME##_iter *iter);                                    \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter);                               \
+                                                                                      \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_PERSISTENT_TREEMAP_SOURCE(PFX, SNAME, K, V)                             \
+                                                                                             \
+    /* Implementation Detail Functions */                                                    \
+    static struct SNAME##_node *PFX##_impl_new_node(struct cmc_alloc_node *alloc, K key,     \
+                                                    V value);                                \
+    static struct SNAME##_node *PFX##_impl_get_node(struct SNAME##_node *root,               \
+                                                    int (*cmp)(K, K), K key);                \
+    static struct SNAME##_node *PFX##_impl_own(struct cmc_alloc_node *alloc,                 \
+                                               struct SNAME##_node *node);                   \
+    static void PFX##_impl_release(struct cmc_alloc_node *alloc, struct SNAME##_node *node); \
+    static void PFX##_impl_deallocate(struct SNAME##_node *node, void (*deallocator)(K, V)); \
+    static unsigned char PFX##_impl_h(struct SNAME##_node *node);                            \
+    static unsigned char PFX##_impl_hupdate(struct SNAME##_node *node);                      \
+    static struct SNAME##_node *PFX##_impl_rotate_right(struct SNAME##_node *root);          \
+    static struct SNAME##_node *PFX##_impl_rotate_left(struct SNAME##_node *root);           \
+    static struct SNAME##_node *PFX##_impl_balance(struct SNAME *_map_,                      \
+                                                   struct SNAME##_node *node);               \
+    static void PFX##_impl_rebalance(struct SNAME *_map_, struct SNAME##_node **path,        \
+                                     size_t depth);                                          \
+                                                                                             \
+    struct SNAME *PFX##_new(int (*compare)(K, K))                                            \
+    {                                                                                        \
+        return PFX##_new_custom(compare, NULL);                                              \
+    }                                                                                        \
+                                                                                             \
+    struct SNAME *PFX##_new_custom(int (*compare)(K, K), struct cmc_alloc_node *alloc)       \
+    {                                                                                        \
+        if (!alloc)                                                                          \
+            alloc = &cmc_alloc_node_default;                                                 \
+                                                                                             \
+        struct SNAME *_map_ = alloc->malloc(sizeof(struct SNAME));                           \
+                                                                                             \
+        if (CMC_UNLIKELY(!_map_))                                                            \
+            return NULL;                                                                     \
+                                                                                             \
+        _map_->alloc = alloc;                                                                \
+                                                                                             \
+        _map_->root = NULL;                                                                  \
+        _map_->count = 0;                                                                    \
+        _map_->cmp = compare;                                                                \
+                                                                                             \
+        return _map_;                                                                        \
+    }                                                                                        \
+                                                                                             \
+    /* Snapshots keep their versions */                                                      \
+    void PFX##_clear(struct SNAME *_map_)                                                    \
+    {                                                                                        \
+        PFX##_impl_release(_map_->alloc, _map_->root);                                       \
+                                                                                             \
+        _map_->root = NULL;                                                                  \
+        _map_->count = 0;                                                                    \
+    }                                                                                        \
+                                                                                             \
+    /* Snapshots keep their versions, but the deallocator can only be used */                \
+    /* once every snapshot was released */                                                   \
+    void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V))                          \
+    {                                                                                        \
+        if (deallocator)                                                                     \
+            PFX##_impl_deallocate(_map_->root, deallocator);                                 \
+                                                                                             \
+        PFX##_impl_release(_map_->alloc, _map_->root);                                       \
+                                                                                             \
+        _map_->alloc->free(_map_);                                                           \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_insert(struct SNAME *_map_, K key, V value)                                   \
+    {                                                                                        \
+        if (PFX##_impl_get_node(_map_->root, _map_->cmp, key) != NULL)                       \
+            return false;                                                                    \
+                                                                                             \
+        struct SNAME##_node *node = PFX##_impl_new_node(_map_->alloc, key, value);           \
+                                                                                             \
+        if (!node)                                                                           \
+            return false;                                                                    \
+                                                                                             \
+        struct SNAME##_node *path[CMC_PERSISTENT_TREE_MAX_HEIGHT];                           \
+        struct SNAME##_node **link = &(_map_->root);                                         \
+                                                                                             \
+        size_t depth = 0;                                                                    \
+                                                                                             \
+        while (*link != NULL)                                                                \
+        {                                                                                    \
+            struct SNAME##_node *scan = PFX##_impl_own(_map_->alloc, *link);                 \
+                                                                                             \
+            /* The nodes copied so far are the same version as before */                     \
+            if (!scan)                                                                       \
+            {                                                                                \
+                _map_->alloc->free(node);                                                    \
+                return false;                                                                \
+            }                                                                                \
+                                                                                             \
+            *link = scan;                                                                    \
+            path[depth++] = scan;                                                            \
+                                                                                             \
+            if (_map_->cmp(scan->key, key) > 0)                                              \
+                link = &(scan->left);                                                        \
+            else                                                                             \
+                link = &(scan->right);                                                       \
+        }                                                                                    \
+                                                                                             \
+        *link = node;                                                                        \
+                                                                                             \
+        PFX##_impl_rebalance(_map_, path, depth);                                            \
+                                                                                             \
+        _map_->count++;                                                                      \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value)                 \
+    {                                                                                        \
+        if (PFX##_impl_get_node(_map_->root, _map_->cmp, key) == NULL)                       \
+            return false;                                                                    \
+                                                                                             \
+        struct SNAME##_node **link = &(_map_->root);                                         \
+                                                                                             \
+        while (true)                                                                         \
+        {                                                                                    \
+            struct SNAME##_node *scan = PFX##_impl_own(_map_->alloc, *link);                 \
+                                                                                             \
+            if (!scan)                                                                       \
+                return false;                                                                \
+                                                                                             \
+            *link = scan;                                                                    \
+                                                                                             \
+            int c = _map_->cmp(scan->key, key);                                              \
+                                                                                             \
+            if (c == 0)                                                                      \
+            {                                                                                \
+                if (old_value)                                                               \
+                    *old_value = scan->value;                                                \
+                                                                                             \
+                scan->value = new_value;                                                     \
+                                                                                             \
+                return true;                                                                 \
+            }                                                                                \
+                                                                                             \
+            if (c > 0)                                                                       \
+                link = &(scan->left);                                                        \
+            else                                                                             \
+                link = &(scan->right);                                                       \
+        }                                                                                    \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_remove(struct SNAME *_map_, K key, V *out_value)                              \
+    {                                                                                        \
+        if (PFX##_impl_get_node(_map_->root, _map_->cmp, key) == NULL)                       \
+            return false;                                                                    \
+                                                                                             \
+        struct SNAME##_node *path[CMC_PERSISTENT_TREE_MAX_HEIGHT];                           \
+        struct SNAME##_node **link = &(_map_->root);                                         \
+        struct SNAME##_node *node = NULL;                                                    \
+                                                                                             \
+        size_t depth = 0;                                                                    \
+                                                                                             \
+        while (true)                                                                         \
+        {                                                                                    \
+            node = PFX##_impl_own(_map_->alloc, *link);                                      \
+                                                                                             \
+            if (!node)                                                                       \
+                return false;                                                                \
+                                                                                             \
+            *link = node;                                                                    \
+            path[depth++] = node;                                                            \
+                                                                                             \
+            int c = _map_->cmp(node->key, key);                                              \
+                                                                                             \
+            if (c == 0)                                                                      \
+                break;                                                                       \
+                                                                                             \
+            if (c > 0)                                                                       \
+                link = &(node->left);                                                        \
+            else                                                                             \
+                link = &(node->right);                                                       \
+        }                                                                                    \
+                                                                                             \
+        V value = node->value;                                                               \
+                                                                                             \
+        /* The smallest key of the right subtree takes the place of the key */               \
+        /* and its node is removed instead */                                                \
+        if (node->left != NULL && node->right != NULL)                                       \
+        {                                                                                    \
+            struct SNAME##_node *target = node;                                              \
+                                                                                             \
+            link = &(node->right);                                                           \
+                                                                                             \
+            while (true)                                                                     \
+            {                                                                                \
+                node = PFX##_impl_own(_map_->alloc, *link);                                  \
+                                                                                             \
+                if (!node)                                                                   \
+                    return false;                                                            \
+                                                                                             \
+                *link = node;                                                                \
+                path[depth++] = node;                                                        \
+                                                                                             \
+                if (node->left == NULL)                                                      \
+                    break;                                                                   \
+                                                                                             \
+                link = &(node->left);                                                        \
+            }                                                                                \
+                                                                                             \
+            target->key = node->key;                                                         \
+            target->value = node->value;                                                     \
+        }                                                                                    \
+                                                                                             \
+        /* The child, if any, takes the reference that the node had to it */                 \
+        *link = node->left != NULL ? node->left : node->right;                               \
+                                                                                             \
+        _map_->alloc->free(node);                                                            \
+                                                                                             \
+        PFX##_impl_rebalance(_map_, path, depth - 1);                                        \
+                                                                                             \
+        _map_->count--;                                                                      \
+                                                                                             \
+        if (out_value)                                                                       \
+            *out_value = value;                                                              \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    V PFX##_get(struct SNAME *_map_, K key)                                                  \
+    {                                                                                        \
+        struct SNAME##_node *node = PFX##_impl_get_node(_map_->root, _map_->cmp, key);       \
+                                                                                             \
+        if (!node)                                                                           \
+            return (V){ 0 };                                                                 \
+                                                                                             \
+        return node->value;                                                                  \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_contains(struct SNAME *_map_, K key)                                          \
+    {                                                                                        \
+        return PFX##_impl_get_node(_map_->root, _map_->cmp, key) != NULL;                    \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_empty(struct SNAME *_map_)                                                    \
+    {                                                                                        \
+        return _map_->count == 0;                                                            \
+    }                                                                                        \
+                                                                                             \
+    size_t PFX##_count(struct SNAME *_map_)                                                  \
+    {                                                                                        \
+        return _map_->count;                                                                 \
+    }                                                                                        \
+                                                                                             \
+    size_t PFX##_memory_usage(struct SNAME *_map_)                                           \
+    {                                                                                        \
+        /* Nodes of the current version, which may also belong to snapshots */               \
+        return sizeof(struct SNAME) + sizeof(struct SNAME##_node) * _map_->count;            \
+    }                                                                                        \
+                                                                                             \
+    /* The current version stays the same until the map is modified again, */                \
+    /* so taking a snapshot only adds a reference to the root */                             \
+    struct SNAME##_snapshot PFX##_snapshot(struct SNAME *_map_)                              \
+    {                                                                                        \
+        struct SNAME##_snapshot snapshot;                                                    \
+                                                                                             \
+        snapshot.root = _map_->root;                                                         \
+        snapshot.count = _map_->count;                                                       \
+        snapshot.cmp = _map_->cmp;                                                           \
+        snapshot.alloc = _map_->alloc;                                                       \
+                                                                                             \
+        if (snapshot.root)                                                                   \
+            atomic_fetch_add_explicit(&(snapshot.root->refs), 1, memory_order_relaxed);      \
+                                                                                             \
+        return snapshot;                                                                     \
+    }                                                                                        \
+                                                                                             \
+    /* Can be called from any thread, and frees every node that only this */                 \
+    /* snapshot was using */                                                                 \
+    void PFX##_snapshot_release(struct SNAME##_snapshot *snapshot)                           \
+    {                                                                                        \
+        PFX##_impl_release(snapshot->alloc, snapshot->root);                                 \
+                                                                                             \
+        snapshot->root = NULL;                                                               \
+        snapshot->count = 0;                                                                 \
+    }                                                                                        \
+                                                                                             \
+    V PFX##_snapshot_get(struct SNAME##_snapshot *snapshot, K key)                           \
+    {                                                                                        \
+        struct SNAME##_node *node = PFX##_impl_get_node(snapshot->root, snapshot->cmp, key); \
+                                                                                             \
+        if (!node)                                                                           \
+            return (V){ 0 };                                                                 \
+                                                                                             \
+        return node->value;                                                                  \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_snapshot_contains(struct SNAME##_snapshot *snapshot, K key)                   \
+    {                                                                                        \
+        return PFX##_impl_get_node(snapshot->root, snapshot->cmp, key) != NULL;              \
+    }                                                                                        \
+                                                                                             \
+    size_t PFX##_snapshot_count(struct SNAME##_snapshot *snapshot)                           \
+    {                                                                                        \
+        return snapshot->count;                                                              \
+    }                                                                                        \
+                                                                                             \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_)                                   \
+    {                                                                                        \
+        struct cmc_string str;                                                               \
+        struct SNAME *m_ = _map_;                                                            \
+        const char *name = #SNAME;                                                           \
+                                                                                             \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_persistenttreemap,                    \
+                 name, m_, m_->root, m_->count, m_->cmp);                                    \
+                                                                                             \
+        return str;                                                                          \
+    }                                                                                        \
+                                                                                             \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME##_snapshot, CMC_IMPL_STRING_ENTRY)                \
+                                                                                             \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME##_snapshot, CMC_IMPL_STRING_ENTRY, (K, V))               \
+                                                                                             \
+    /* The iterator must not outlive the snapshot */                                         \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME##_snapshot *target)         \
+    {                                                                                        \
+        iter->depth = 0;                                                                     \
+        iter->index = 0;                                                                     \
+                                                                                             \
+        for (struct SNAME##_node *scan = target->root; scan != NULL; scan = scan->left)      \
+            iter->stack[iter->depth++] = scan;                                               \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                           \
+    {                                                                                        \
+        return iter->depth == 0;                                                             \
+    }                                                                                        \
+                                                                                             \
+    /* Returns false only if the iterator had already reached the end */                     \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                          \
+    {                                                                                        \
+        if (iter->depth == 0)                                                                \
+            return false;                                                                    \
+                                                                                             \
+        struct SNAME##_node *scan = iter->stack[--iter->depth]->right;                       \
+                                                                                             \
+        for (; scan != NULL; scan = scan->left)                                              \
+            iter->stack[iter->depth++] = scan;                                               \
+                                                                                             \
+        iter->index++;                                                                       \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    K PFX##_iter_key(struct SNAME##_iter *iter)                                              \
+    {                                                                                        \
+        if (iter->depth == 0)                                                                \
+            return (K){ 0 };                                                                 \
+                                                                                             \
+        return iter->stack[iter->depth - 1]->key;                                            \
+    }                                                                                        \
+                                                                                             \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                            \
+    {                                                                                        \
+        if (iter->depth == 0)                                                                \
+            return (V){ 0 };                                                                 \
+                                                                                             \
+        return iter->stack[iter->depth - 1]->value;                                          \
+    }                                                                                        \
+                                                                                             \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                       \
+    {                                                                                        \
+        return iter->index;                                                                  \
+    }                                                                                        \
+                                                                                             \
+    static struct SNAME##_node *PFX##_impl_new_node(struct cmc_alloc_node *alloc, K key,     \
+                                                    V value)                                 \
+    {                                                                                        \
+        struct SNAME##_node *node = alloc->malloc(sizeof(struct SNAME##_node));              \
+                                                                                             \
+        if (CMC_UNLIKELY(!node))                                                             \
+            return NULL;                                                                     \
+                                                                                             \
+        node->key = key;                                                                     \
+        node->value = value;                                                                 \
+        node->height = 1;                                                                    \
+        node->right = NULL;                                                                  \
+        node->left = NULL;                                                                   \
+                                                                                             \
+        atomic_init(&(node->refs), 1);                                                       \
+                                                                                             \
+        return node;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    static struct SNAME##_node *PFX##_impl_get_node(struct SNAME##_node *root,               \
+                                                    int (*cmp)(K, K), K key)                 \
+    {                                                                                        \
+        struct SNAME##_node *scan = root;                                                    \
+                                                                                             \
+        while (scan != NULL)                                                                 \
+        {                                                                                    \
+            int c = cmp(scan->key, key);                                                     \
+                                                                                             \
+            if (c > 0)                                                                       \
+                scan = scan->left;                                                           \
+            else if (c < 0)                                                                  \
+                scan = scan->right;                                                          \
+            else                                                                             \
+                return scan;                                                                 \
+        }                                                                                    \
+                                                                                             \
+        return NULL;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* Takes the place of the reference given to a node that is reached */                   \
+    /* through nodes of the map only. If no snapshot can reach the node it */                \
+    /* is returned as is, otherwise it is copied. Returns NULL and leaves the */             \
+    /* reference as it was if the copy could not be allocated */                             \
+    static struct SNAME##_node *PFX##_impl_own(struct cmc_alloc_node *alloc,                 \
+                                               struct SNAME##_node *node)                    \
+    {                                                                                        \
+        /* Only the thread that modifies the map can add references, so a */                 \
+        /* node that has one reference will keep it */                                       \
+        if (atomic_load_explicit(&(node->refs), memory_order_acquire) == 1)                  \
+            return node;                                                                     \
+                                                                                             \
+        struct SNAME##_node *copy = alloc->malloc(sizeof(struct SNAME##_node));              \
+                                                                                             \
+        if (CMC_UNLIKELY(!copy))                                                             \
+            return NULL;                                                                     \
+                                                                                             \
+        copy->key = node->key;                                                               \
+        copy->value = node->value;                                                           \
+        copy->height = node->height;                                                         \
+        copy->right = node->right;                                                           \
+        copy->left = node->left;                                                             \
+                                                                                             \
+        atomic_init(&(copy->refs), 1);                                                       \
+                                                                                             \
+        if (copy->right)                                                                     \
+            atomic_fetch_add_explicit(&(copy->right->refs), 1, memory_order_relaxed);        \
+        if (copy->left)                                                                      \
+            atomic_fetch_add_explicit(&(copy->left->refs), 1, memory_order_relaxed);         \
+                                                                                             \
+        PFX##_impl_release(alloc, node);                                                     \
+                                                                                             \
+        return copy;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* Drops a reference to a node, freeing it and every node that could */                  \
+    /* only be reached through it once nothing points to it */                               \
+    static void PFX##_impl_release(struct cmc_alloc_node *alloc, struct SNAME##_node *node)  \
+    {                                                                                        \
+        while (node != NULL &&                                                               \
+               atomic_fetch_sub_explicit(&(node->refs), 1, memory_order_acq_rel) == 1)       \
+        {                                                                                    \
+            struct SNAME##_node *right = node->right;                                        \
+                                                                                             \
+            PFX##_impl_release(alloc, node->left);                                           \
+                                                                                             \
+            alloc->free(node);                                                               \
+                                                                                             \
+            node = right;                                                                    \
+        }                                                                                    \
+    }                                                                                        \
+                                                                                             \
+    static void PFX##_impl_deallocate(struct SNAME##_node *node, void (*deallocator)(K, V))  \
+    {                                                                                        \
+        while (node != NULL)                                                                 \
+        {                                                                                    \
+            PFX##_impl_deallocate(node->left, deallocator);                                  \
+                                                                                             \
+            deallocator(node->key, node->value);                                             \
+                                                                                             \
+            node = node->right;                                                              \
+        }                                                                                    \
+    }                                                                                        \
+                                                                                             \
+    static unsigned char PFX##_impl_h(struct SNAME##_node *node)                             \
+    {                                                                                        \
+        if (node == NULL)                                                                    \
+            return 0;                                                                        \
+                                                                                             \
+        return node->height;                                                                 \
+    }                                                                                        \
+                                                                                             \
+    static unsigned char PFX##_impl_hupdate(struct SNAME##_node *node)                       \
+    {                                                                                        \
+        if (node == NULL)                                                                    \
+            return 0;                                                                        \
+                                                                                             \
+        unsigned char h_l = PFX##_impl_h(node->left);                                        \
+        unsigned char h_r = PFX##_impl_h(node->right);                                       \
+                                                                                             \
+        return 1 + (h_l > h_r ? h_l : h_r);                                                  \
+    }                                                                                        \
+                                                                                             \
+    /* Both root and its left child must belong to the map only */                           \
+    static struct SNAME##_node *PFX##_impl_rotate_right(struct SNAME##_node *root)           \
+    {                                                                                        \
+        struct SNAME##_node *new_root = root->left;                                          \
+                                                                                             \
+        root->left = new_root->right;                                                        \
+        new_root->right = root;                                                              \
+                                                                                             \
+        root->height = PFX##_impl_hupdate(root);                                             \
+        new_root->height = PFX##_impl_hupdate(new_root);                                     \
+                                                                                             \
+        return new_root;                                                                     \
+    }                                                                                        \
+                                                                                             \
+    /* Both root and its right child must belong to the map only */                          \
+    static struct SNAME##_node *PFX##_impl_rotate_left(struct SNAME##_node *root)            \
+    {                                                                                        \
+        struct SNAME##_node *new_root = root->right;                                         \
+                                                                                             \
+        root->right = new_root->left;                                                        \
+        new_root->left = root;                                                               \
+                                                                                             \
+        root->height = PFX##_impl_hupdate(root);                                             \
+        new_root->height = PFX##_impl_hupdate(new_root);                                     \
+                                                                                             \
+        return new_root;                                                                     \
+    }                                                                                        \
+                                                                                             \
+    /* Returns the new root of the subtree of a node that belongs to the map */              \
+    /* only. The children that are rotated are copied first if needed */                     \
+    static struct SNAME##_node *PFX##_impl_balance(struct SNAME *_map_,                      \
+                                                   struct SNAME##_node *node)                \
+    {                                                                                        \
+        node->height = PFX##_impl_hupdate(node);                                             \
+                                                                                             \
+        int balance = PFX##_impl_h(node->right) - PFX##_impl_h(node->left);                  \
+                                                                                             \
+        if (balance >= 2)                                                                    \
+        {                                                                                    \
+            struct SNAME##_node *child = PFX##_impl_own(_map_->alloc, node->right);          \
+                                                                                             \
+            if (!child)                                                                      \
+                return node;                                                                 \
+                                                                                             \
+            node->right = child;                                                             \
+                                                                                             \
+            if (PFX##_impl_h(child->right) < PFX##_impl_h(child->left))                      \
+            {                                                                                \
+                struct SNAME##_node *grandchild = PFX##_impl_own(_map_->alloc, child->left); \
+                                                                                             \
+                if (!grandchild)                                                             \
+                    return node;                                                             \
+                                                                                             \
+                child->left = grandchild;                                                    \
+                node->right = PFX##_impl_rotate_right(child);                                \
+            }                                                                                \
+                                                                                             \
+            return PFX##_impl_rotate_left(node);                                             \
+        }                                                                                    \
+        else if (balance <= -2)                                                              \
+        {                                                                                    \
+            struct SNAME##_node *child = PFX##_impl_own(_map_->alloc, node->left);           \
+                                                                                             \
+            if (!child)                                                                      \
+                return node;                                                                 \
+                                                                                             \
+            node->left = child;                                                              \
+                                                                                             \
+            if (PFX##_impl_h(child->left) < PFX##_impl_h(child->right))                      \
+            {                                                                                \
+                struct SNAME##_node *grandchild = PFX##_impl_own(_map_->alloc,               \
+                                                                 child->right);              \
+                                                                                             \
+                if (!grandchild)                                                             \
+                    return node;                                                             \
+                                                                                             \
+                child->right = grandchild;                                                   \
+                node->left = PFX##_impl_rotate_left(child);                                  \
+            }                                                                                \
+                                                                                             \
+            return PFX##_impl_rotate_right(node);                                            \
+        }                                                                                    \
+                                                                                             \
+        return node;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* Balances the nodes of a path from the root, the deepest one first */                  \
+    static void PFX##_impl_rebalance(struct SNAME *_map_, struct SNAME##_node **path,        \
+                                     size_t depth)                                           \
+    {                                                                                        \
+        for (size_t i = depth; i > 0; i--)                                                   \
+        {                                                                                    \
+            struct SNAME##_node *node = path[i - 1];                                         \
+            struct SNAME##_node *balanced = PFX##_impl_balance(_map_, node);                 \
+                                                                                             \
+            if (balanced == node)                                                            \
+                continue;                                                                    \
+                                                                                             \
+            if (i == 1)                                                                      \
+                _map_->root = balanced;                                                      \
+            else if (path[i - 2]->left == node)                                              \
+                path[i - 2]->left = balanced;                                                \
+            else                                                                             \
+                path[i - 2]->right = balanced;                                               \
+        }                                                                                    \
+    }
+
+#endif /* CMC_PERSISTENTTREEMAP_H */
@@ -17,6 +17,8 @@
  * circular buffer or ring buffer) is very important so that both adding and
  * removing elements from the Queue are done instantly. The array is linear but
  * with the modulo operator it is treated as a circular sequence of elements.
+ * With CMC_RING_POW2 defined as 1 (see cmc_growth.h) the capacity is always a
+ * power of two and indices wrap around with a mask.
  *
  * If the Queue was implemented as a regular Dynamic Array, when adding or
  * removing an element at the front, it would be necessary to shift all elements
@@ -48,11 +50,29 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_growth.h"
+#include "../utl/cmc_scan.h"
+#include "../utl/cmc_serial.h"
 #include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
 
 /* to_string format */
 static const char *cmc_string_fmt_queue = "%s at %p { buffer:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", front:%" PRIuMAX ", back:%" PRIuMAX " }";
 
+/* A removal shrinks a collection once less than this fraction of what it */
+/* can hold without growing is in use. Define it as 0 to never shrink */
+#ifndef CMC_SHRINK_LOW_WATER
+#define CMC_SHRINK_LOW_WATER 0.25
+#endif
+
+/* A removal overwrites the slots it frees with zeros, so no copy of a */
+/* removed element is left in the buffer. Define it as 0 to skip it */
+#ifndef CMC_POP_ZERO
+#define CMC_POP_ZERO 1
+#endif
+
 #define CMC_GENERATE_QUEUE(PFX, SNAME, V)    \
     CMC_GENERATE_QUEUE_HEADER(PFX, SNAME, V) \
     CMC_GENERATE_QUEUE_SOURCE(PFX, SNAME, V)
@@ -63,6 +83,29 @@ static const char *cmc_string_fmt_queue = "%s at %p { buffer:%p, capacity:%" PRI
 #define CMC_WRAPGEN_QUEUE_SOURCE(PFX, SNAME, K, V) \
     CMC_GENERATE_QUEUE_SOURCE(PFX, SNAME, V)
 
+/* Same as CMC_GENERATE_QUEUE but contains compares the bytes of the */
+/* elements with the vector search of cmc_scan.h, for types like integers */
+/* and pointers. The comparator is ignored and may be NULL */
+#define CMC_GENERATE_QUEUE_BITWISE(PFX, SNAME, V) \
+    CMC_GENERATE_QUEUE_HEADER(PFX, SNAME, V)      \
+    CMC_GENERATE_QUEUE_BITWISE_SOURCE(PFX, SNAME, V)
+
+/* Same as CMC_GENERATE_QUEUE but V is plain data that owns nothing, so */
+/* removals and clear leave the slots they free as they are instead of */
+/* overwriting them with zeros */
+#define CMC_GENERATE_QUEUE_TRIVIAL(PFX, SNAME, V) \
+    CMC_GENERATE_QUEUE_HEADER(PFX, SNAME, V)      \
+    CMC_GENERATE_QUEUE_TRIVIAL_SOURCE(PFX, SNAME, V)
+
+#define CMC_GENERATE_QUEUE_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_QUEUE_SOURCE(PFX, SNAME, V, false, false)
+
+#define CMC_GENERATE_QUEUE_BITWISE_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_QUEUE_SOURCE(PFX, SNAME, V, true, false)
+
+#define CMC_GENERATE_QUEUE_TRIVIAL_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_QUEUE_SOURCE(PFX, SNAME, V, false, true)
+
 /* HEADER ********************************************************************/
 #define CMC_GENERATE_QUEUE_HEADER(PFX, SNAME, V)                                                \
                                                                                                 \
@@ -89,6 +132,9 @@ static const char *cmc_string_fmt_queue = "%s at %p { buffer:%p, capacity:%" PRI
                                                                                                 \
         /* Function that returns an iterator to the end of the queue */                         \
         struct SNAME##_iter (*it_end)(struct SNAME *);                                          \
+                                                                                                \
+        /* Custom allocation functions */                                                       \
+        struct cmc_alloc_node *alloc;                                                           \
     };                                                                                          \
                                                                                                 \
     /* Queue Iterator */                                                                        \
@@ -113,24 +159,43 @@ static const char *cmc_string_fmt_queue = "%s at %p { buffer:%p, capacity:%" PRI
     /* Collection Functions */                                                                  \
     /* Collection Allocation and Deallocation */                                                \
     struct SNAME *PFX##_new(size_t capacity);                                                   \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc);              \
+    struct SNAME *PFX##_new_from(V *elements, size_t size);                                     \
     void PFX##_clear(struct SNAME *_queue_, void (*deallocator)(V));                            \
     void PFX##_free(struct SNAME *_queue_, void (*deallocator)(V));                             \
     /* Collection Input and Output */                                                           \
     bool PFX##_enqueue(struct SNAME *_queue_, V element);                                       \
     bool PFX##_dequeue(struct SNAME *_queue_);                                                  \
+    bool PFX##_enqueue_many(struct SNAME *_queue_, V *elements, size_t size);                   \
+    size_t PFX##_dequeue_many(struct SNAME *_queue_, V *elements, size_t size);                 \
+    size_t PFX##_remove_if(struct SNAME *_queue_, bool (*pred)(V), void (*deallocator)(V));     \
     /* Element Access */                                                                        \
     V PFX##_peek(struct SNAME *_queue_);                                                        \
+    V PFX##_get(struct SNAME *_queue_, size_t index);                                           \
+    V *PFX##_get_ref(struct SNAME *_queue_, size_t index);                                      \
+    void PFX##_spans(struct SNAME *_queue_, V **a, size_t *a_count, V **b, size_t *b_count);    \
     /* Collection State */                                                                      \
     bool PFX##_contains(struct SNAME *_queue_, V element, int (*comparator)(V, V));             \
-    bool PFX##_empty(struct SNAME *_queue_);                                                    \
+    CMC_PURE bool PFX##_empty(struct SNAME *_queue_);                                           \
     bool PFX##_full(struct SNAME *_queue_);                                                     \
-    size_t PFX##_count(struct SNAME *_queue_);                                                  \
+    CMC_PURE size_t PFX##_count(struct SNAME *_queue_);                                         \
+    size_t PFX##_memory_usage(struct SNAME *_queue_);                                           \
     size_t PFX##_capacity(struct SNAME *_queue_);                                               \
     /* Collection Utility */                                                                    \
     bool PFX##_resize(struct SNAME *_queue_, size_t capacity);                                  \
+    bool PFX##_shrink_to_fit(struct SNAME *_queue_);                                            \
+    bool PFX##_reserve(struct SNAME *_queue_, size_t capacity);                                 \
     struct SNAME *PFX##_copy_of(struct SNAME *_queue_, V (*copy_func)(V));                      \
+    size_t PFX##_to_array(struct SNAME *_queue_, V *CMC_RESTRICT elements, size_t size);        \
     bool PFX##_equals(struct SNAME *_queue1_, struct SNAME *_queue2_, int (*comparator)(V, V)); \
     struct cmc_string PFX##_to_string(struct SNAME *_queue_);                                   \
+    bool PFX##_to_string_full(struct SNAME *_queue_, struct cmc_string_builder *builder,        \
+                              const char *elem_fmt);                                            \
+    bool PFX##_write(struct SNAME *_queue_, FILE *file, void (*fmt)(FILE *, V));                \
+    bool PFX##_write_fd(struct SNAME *_queue_, int fd, void (*fmt)(struct cmc_dump *, V));      \
+    /* Collection Serialization */                                                              \
+    bool PFX##_save(struct SNAME *_queue_, FILE *file, bool (*writer)(V, FILE *));              \
+    struct SNAME *PFX##_restore(FILE *file, bool (*reader)(V *, FILE *));                       \
                                                                                                 \
     /* Iterator Functions */                                                                    \
     /* Iterator Allocation and Deallocation */                                                  \
@@ -155,27 +220,45 @@ static const char *cmc_string_fmt_queue = "%s at %p { buffer:%p, capacity:%" PRI
     size_t PFX##_iter_index(struct SNAME##_iter *iter);                                         \
                                                                                                 \
 /* SOURCE ********************************************************************/
-#define CMC_GENERATE_QUEUE_SOURCE(PFX, SNAME, V)                                               \
+#define CMC_IMPL_QUEUE_SOURCE(PFX, SNAME, V, BITWISE, TRIVIAL)                                 \
                                                                                                \
     /* Implementation Detail Functions */                                                      \
+    static void PFX##_impl_low_water(struct SNAME *_queue_);                                   \
+    static bool PFX##_impl_grow(struct SNAME *_queue_, size_t required);                       \
+    static inline size_t PFX##_impl_next(struct SNAME *_queue_, size_t i);                     \
+    static inline size_t PFX##_impl_prev(struct SNAME *_queue_, size_t i);                     \
+    static inline size_t PFX##_impl_wrap(struct SNAME *_queue_, size_t i);                     \
     static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_queue_);                     \
     static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_queue_);                       \
                                                                                                \
     struct SNAME *PFX##_new(size_t capacity)                                                   \
     {                                                                                          \
+        return PFX##_new_custom(capacity, NULL);                                               \
+    }                                                                                          \
+                                                                                               \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc)              \
+    {                                                                                          \
+        if (!alloc)                                                                            \
+            alloc = &cmc_alloc_node_default;                                                   \
+                                                                                               \
         if (capacity < 1)                                                                      \
             return NULL;                                                                       \
                                                                                                \
-        struct SNAME *_queue_ = malloc(sizeof(struct SNAME));                                  \
+        if (CMC_RING_POW2)                                                                     \
+            capacity = cmc_growth_pow2(capacity);                                              \
                                                                                                \
-        if (!_queue_)                                                                          \
+        struct SNAME *_queue_ = alloc->malloc(sizeof(struct SNAME));                           \
+                                                                                               \
+        if (CMC_UNLIKELY(!_queue_))                                                            \
             return NULL;                                                                       \
                                                                                                \
-        _queue_->buffer = calloc(capacity, sizeof(V));                                         \
+        _queue_->alloc = alloc;                                                                \
+                                                                                               \
+        _queue_->buffer = alloc->calloc(capacity, sizeof(V));                                  \
                                                                                                \
-        if (!_queue_->buffer)                                                                  \
+        if (CMC_UNLIKELY(!_queue_->buffer))                                                    \
         {                                                                                      \
-            free(_queue_);                                                                     \
+            alloc->free(_queue_);                                                              \
             return NULL;                                                                       \
         }                                                                                      \
                                                                                                \
@@ -190,6 +273,23 @@ static const char *cmc_string_fmt_queue = "%s at %p { buffer:%p, capacity:%" PRI
         return _queue_;                                                                        \
     }                                                                                          \
                                                                                                \
+    /* Creates a queue with the size elements in order, with room for half as */               \
+    /* many more */                                                                            \
+    struct SNAME *PFX##_new_from(V *elements, size_t size)                                     \
+    {                                                                                          \
+        if (size == 0)                                                                         \
+            return NULL;                                                                       \
+                                                                                               \
+        struct SNAME *_queue_ = PFX##_new(size + size / 2);                                    \
+                                                                                               \
+        if (CMC_UNLIKELY(!_queue_))                                                            \
+            return NULL;                                                                       \
+                                                                                               \
+        PFX##_enqueue_many(_queue_, elements, size);                                           \
+                                                                                               \
+        return _queue_;                                                                        \
+    }                                                                                          \
+                                                                                               \
     void PFX##_clear(struct SNAME *_queue_, void (*deallocator)(V))                            \
     {                                                                                          \
         if (deallocator)                                                                       \
@@ -198,11 +298,12 @@ static const char *cmc_string_fmt_queue = "%s at %p { buffer:%p, capacity:%" PRI
             {                                                                                  \
                 deallocator(_queue_->buffer[i]);                                               \
                                                                                                \
-                i = (i + 1) % _queue_->capacity;                                               \
+                i = PFX##_impl_next(_queue_, i);                                               \
             }                                                                                  \
         }                                                                                      \
                                                                                                \
-        memset(_queue_->buffer, 0, sizeof(V) * _queue_->capacity);                             \
+        if (!TRIVIAL)                                                                          \
+            memset(_queue_->buffer, 0, sizeof(V) * _queue_->capacity);                         \
                                                                                                \
         _queue_->count = 0;                                                                    \
         _queue_->front = 0;                                                                    \
@@ -217,25 +318,25 @@ static const char *cmc_string_fmt_queue = "%s at %p { buffer:%p, capacity:%" PRI
             {                                                                                  \
                 deallocator(_queue_->buffer[i]);                                               \
                                                                                                \
-                i = (i + 1) % _queue_->capacity;                                               \
+                i = PFX##_impl_next(_queue_, i);                                               \
             }                                                                                  \
         }                                                                                      \
                                                                                                \
-        free(_queue_->buffer);                                                                 \
-        free(_queue_);                                                                         \
+        _queue_->alloc->free(_queue_->buffer);                                                 \
+        _queue_->alloc->free(_queue_);                                                         \
     }                                                                                          \
                                                                                                \
     bool PFX##_enqueue(struct SNAME *_queue_, V element)                                       \
     {                                                                                          \
         if (PFX##_full(_queue_))                                                               \
         {                                                                                      \
-            if (!PFX##_resize(_queue_, PFX##_capacity(_queue_) * 2))                           \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_queue_, _queue_->count + 1)))                   \
                 return false;                                                                  \
         }                                                                                      \
                                                                                                \
         _queue_->buffer[_queue_->back] = element;                                              \
                                                                                                \
-        _queue_->back = (_queue_->back == _queue_->capacity - 1) ? 0 : _queue_->back + 1;      \
+        _queue_->back = PFX##_impl_next(_queue_, _queue_->back);                               \
         _queue_->count++;                                                                      \
                                                                                                \
         return true;                                                                           \
@@ -246,14 +347,123 @@ static const char *cmc_string_fmt_queue = "%s at %p { buffer:%p, capacity:%" PRI
         if (PFX##_empty(_queue_))                                                              \
             return false;                                                                      \
                                                                                                \
-        _queue_->buffer[_queue_->front] = (V){0};                                              \
+        if (CMC_POP_ZERO && !TRIVIAL)                                                          \
+            _queue_->buffer[_queue_->front] = (V){0};                                          \
                                                                                                \
-        _queue_->front = (_queue_->front == _queue_->capacity - 1) ? 0 : _queue_->front + 1;   \
+        _queue_->front = PFX##_impl_next(_queue_, _queue_->front);                             \
         _queue_->count--;                                                                      \
                                                                                                \
+        PFX##_impl_low_water(_queue_);                                                         \
+                                                                                               \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    /* Enqueues the size elements in order, growing the buffer at most once */                 \
+    bool PFX##_enqueue_many(struct SNAME *_queue_, V *elements, size_t size)                   \
+    {                                                                                          \
+        if (size == 0)                                                                         \
+            return false;                                                                      \
+                                                                                               \
+        if (_queue_->count + size > _queue_->capacity)                                         \
+        {                                                                                      \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_queue_, _queue_->count + size)))                \
+                return false;                                                                  \
+        }                                                                                      \
+                                                                                               \
+        /* The elements are copied up to the end of the buffer and then to */                  \
+        /* its start */                                                                        \
+        size_t first = _queue_->capacity - _queue_->back;                                      \
+                                                                                               \
+        if (first > size)                                                                      \
+            first = size;                                                                      \
+                                                                                               \
+        memcpy(_queue_->buffer + _queue_->back, elements, first * sizeof(V));                  \
+        memcpy(_queue_->buffer, elements + first, (size - first) * sizeof(V));                 \
+                                                                                               \
+        _queue_->back = PFX##_impl_wrap(_queue_, _queue_->back + size);                        \
+                                                                                               \
+        _queue_->count += size;                                                                \
+                                                                                               \
         return true;                                                                           \
     }                                                                                          \
                                                                                                \
+    /* Dequeues up to size elements, copying them to elements */                               \
+    /* unless it is NULL. Returns how many were removed */                                     \
+    size_t PFX##_dequeue_many(struct SNAME *_queue_, V *elements, size_t size)                 \
+    {                                                                                          \
+        if (size > _queue_->count)                                                             \
+            size = _queue_->count;                                                             \
+                                                                                               \
+        size_t first = _queue_->capacity - _queue_->front;                                     \
+                                                                                               \
+        if (first > size)                                                                      \
+            first = size;                                                                      \
+                                                                                               \
+        if (elements)                                                                          \
+        {                                                                                      \
+            memcpy(elements, _queue_->buffer + _queue_->front, first * sizeof(V));             \
+            memcpy(elements + first, _queue_->buffer, (size - first) * sizeof(V));             \
+        }                                                                                      \
+                                                                                               \
+        if (CMC_POP_ZERO && !TRIVIAL)                                                          \
+        {                                                                                      \
+            memset(_queue_->buffer + _queue_->front, 0, first * sizeof(V));                    \
+            memset(_queue_->buffer, 0, (size - first) * sizeof(V));                            \
+        }                                                                                      \
+                                                                                               \
+        _queue_->front = PFX##_impl_wrap(_queue_, _queue_->front + size);                      \
+                                                                                               \
+        _queue_->count -= size;                                                                \
+                                                                                               \
+        PFX##_impl_low_water(_queue_);                                                         \
+                                                                                               \
+        return size;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    /* Removes every element for which pred is true in a single pass that */                   \
+    /* moves the others towards the front, keeping their order. Returns */                     \
+    /* how many were removed */                                                                \
+    size_t PFX##_remove_if(struct SNAME *_queue_, bool (*pred)(V), void (*deallocator)(V))     \
+    {                                                                                          \
+        size_t write = _queue_->front;                                                         \
+        size_t read = _queue_->front;                                                          \
+        size_t removed = 0;                                                                    \
+                                                                                               \
+        for (size_t i = 0; i < _queue_->count; i++, read = PFX##_impl_next(_queue_, read))     \
+        {                                                                                      \
+            V element = _queue_->buffer[read];                                                 \
+                                                                                               \
+            if (pred(element))                                                                 \
+            {                                                                                  \
+                if (deallocator)                                                               \
+                    deallocator(element);                                                      \
+                                                                                               \
+                removed++;                                                                     \
+                continue;                                                                      \
+            }                                                                                  \
+                                                                                               \
+            _queue_->buffer[write] = element;                                                  \
+            write = PFX##_impl_next(_queue_, write);                                           \
+        }                                                                                      \
+                                                                                               \
+        if (removed == 0)                                                                      \
+            return 0;                                                                          \
+                                                                                               \
+        _queue_->back = write;                                                                 \
+                                                                                               \
+        if (CMC_POP_ZERO && !TRIVIAL)                                                          \
+        {                                                                                      \
+            for (size_t i = 0; i < removed; i++, write = PFX##_impl_next(_queue_, write))      \
+                _queue_->buffer[write] = (V){0};                                               \
+        }                                                                                      \
+                                                                                               \
+        _queue_->count -= removed;                                                             \
+                                                                                               \
+        PFX##_impl_low_water(_queue_);                                                         \
+                                                                                               \
+        return removed;                                                                        \
+    }                                                                                          \
+                                                                                               \
     V PFX##_peek(struct SNAME *_queue_)                                                        \
     {                                                                                          \
         if (PFX##_empty(_queue_))                                                              \
@@ -262,14 +472,60 @@ static const char *cmc_string_fmt_queue = "%s at %p { buffer:%p, capacity:%" PRI
         return _queue_->buffer[_queue_->front];                                                \
     }                                                                                          \
                                                                                                \
+    V PFX##_get(struct SNAME *_queue_, size_t index)                                           \
+    {                                                                                          \
+        if (index >= _queue_->count)                                                           \
+            return (V){0};                                                                     \
+                                                                                               \
+        return *PFX##_get_ref(_queue_, index);                                                 \
+    }                                                                                          \
+                                                                                               \
+    V *PFX##_get_ref(struct SNAME *_queue_, size_t index)                                      \
+    {                                                                                          \
+        if (index >= _queue_->count)                                                           \
+            return NULL;                                                                       \
+                                                                                               \
+        return &(_queue_->buffer[PFX##_impl_wrap(_queue_, _queue_->front + index)]);           \
+    }                                                                                          \
+                                                                                               \
+    /* The elements from front to back are the a_count elements at a followed */               \
+    /* by the b_count elements at b. The second span is empty unless the */                    \
+    /* elements wrap around the end of the buffer */                                           \
+    void PFX##_spans(struct SNAME *_queue_, V **a, size_t *a_count, V **b, size_t *b_count)    \
+    {                                                                                          \
+        size_t first = _queue_->capacity - _queue_->front;                                     \
+                                                                                               \
+        if (first > _queue_->count)                                                            \
+            first = _queue_->count;                                                            \
+                                                                                               \
+        *a = _queue_->buffer + _queue_->front;                                                 \
+        *a_count = first;                                                                      \
+        *b = _queue_->buffer;                                                                  \
+        *b_count = _queue_->count - first;                                                     \
+    }                                                                                          \
+                                                                                               \
     bool PFX##_contains(struct SNAME *_queue_, V element, int (*comparator)(V, V))             \
     {                                                                                          \
+        if (BITWISE)                                                                           \
+        {                                                                                      \
+            V *a;                                                                              \
+            V *b;                                                                              \
+            size_t first, second;                                                              \
+                                                                                               \
+            PFX##_spans(_queue_, &a, &first, &b, &second);                                     \
+                                                                                               \
+            if (cmc_scan_find(a, first, sizeof(V), &element) != first)                         \
+                return true;                                                                   \
+                                                                                               \
+            return cmc_scan_find(b, second, sizeof(V), &element) != second;                    \
+        }                                                                                      \
+                                                                                               \
         for (size_t i = _queue_->front, j = 0; j < _queue_->count; j++)                        \
         {                                                                                      \
             if (comparator(_queue_->buffer[i], element) == 0)                                  \
                 return true;                                                                   \
                                                                                                \
-            i = (i + 1) % _queue_->capacity;                                                   \
+            i = PFX##_impl_next(_queue_, i);                                                   \
         }                                                                                      \
                                                                                                \
         return false;                                                                          \
@@ -290,6 +546,11 @@ static const char *cmc_string_fmt_queue = "%s at %p { buffer:%p, capacity:%" PRI
         return _queue_->count;                                                                 \
     }                                                                                          \
                                                                                                \
+    size_t PFX##_memory_usage(struct SNAME *_queue_)                                           \
+    {                                                                                          \
+        return sizeof(struct SNAME) + sizeof(V) * _queue_->capacity;                           \
+    }                                                                                          \
+                                                                                               \
     size_t PFX##_capacity(struct SNAME *_queue_)                                               \
     {                                                                                          \
         return _queue_->capacity;                                                              \
@@ -297,39 +558,74 @@ static const char *cmc_string_fmt_queue = "%s at %p { buffer:%p, capacity:%" PRI
                                                                                                \
     bool PFX##_resize(struct SNAME *_queue_, size_t capacity)                                  \
     {                                                                                          \
+        if (CMC_RING_POW2)                                                                     \
+            capacity = cmc_growth_pow2(capacity);                                              \
+                                                                                               \
         if (PFX##_capacity(_queue_) == capacity)                                               \
             return true;                                                                       \
                                                                                                \
         if (capacity < PFX##_count(_queue_))                                                   \
             return false;                                                                      \
                                                                                                \
-        V *new_buffer = malloc(sizeof(V) * capacity);                                          \
+        V *a;                                                                                  \
+        V *b;                                                                                  \
+        size_t first, second;                                                                  \
                                                                                                \
-        if (!new_buffer)                                                                       \
-            return false;                                                                      \
+        PFX##_spans(_queue_, &a, &first, &b, &second);                                         \
                                                                                                \
-        for (size_t i = _queue_->front, j = 0; j < _queue_->count; j++)                        \
+        /* Elements that do not wrap and still fit stay where they are */                      \
+        if (second == 0 && _queue_->front < capacity && _queue_->front + first <= capacity)    \
         {                                                                                      \
-            new_buffer[j] = _queue_->buffer[i];                                                \
+            V *new_buffer = _queue_->alloc->realloc(_queue_->buffer, sizeof(V) * capacity);    \
                                                                                                \
-            i = (i + 1) % PFX##_capacity(_queue_);                                             \
+            if (CMC_UNLIKELY(!new_buffer))                                                     \
+                return false;                                                                  \
+                                                                                               \
+            _queue_->buffer = new_buffer;                                                      \
+            _queue_->capacity = capacity;                                                      \
+            _queue_->back = PFX##_impl_wrap(_queue_, _queue_->front + first);                  \
+                                                                                               \
+            return true;                                                                       \
         }                                                                                      \
                                                                                                \
-        free(_queue_->buffer);                                                                 \
+        V *new_buffer = _queue_->alloc->malloc(sizeof(V) * capacity);                          \
+                                                                                               \
+        if (CMC_UNLIKELY(!new_buffer))                                                         \
+            return false;                                                                      \
+                                                                                               \
+        memcpy(new_buffer, a, first * sizeof(V));                                              \
+        memcpy(new_buffer + first, b, second * sizeof(V));                                     \
+                                                                                               \
+        _queue_->alloc->free(_queue_->buffer);                                                 \
                                                                                                \
         _queue_->buffer = new_buffer;                                                          \
         _queue_->capacity = capacity;                                                          \
         _queue_->front = 0;                                                                    \
-        _queue_->back = _queue_->count;                                                        \
+        _queue_->back = PFX##_impl_wrap(_queue_, _queue_->count);                              \
                                                                                                \
         return true;                                                                           \
     }                                                                                          \
                                                                                                \
+    bool PFX##_shrink_to_fit(struct SNAME *_queue_)                                            \
+    {                                                                                          \
+        return PFX##_resize(_queue_, _queue_->count > 0 ? _queue_->count : 1);                 \
+    }                                                                                          \
+                                                                                               \
+    /* Grows the buffer so that at least capacity elements fit. Unlike */                      \
+    /* resize it never shrinks the buffer */                                                   \
+    bool PFX##_reserve(struct SNAME *_queue_, size_t capacity)                                 \
+    {                                                                                          \
+        if (capacity <= _queue_->capacity)                                                     \
+            return true;                                                                       \
+                                                                                               \
+        return PFX##_resize(_queue_, capacity);                                                \
+    }                                                                                          \
+                                                                                               \
     struct SNAME *PFX##_copy_of(struct SNAME *_queue_, V (*copy_func)(V))                      \
     {                                                                                          \
-        struct SNAME *result = PFX##_new(_queue_->capacity);                                   \
+        struct SNAME *result = PFX##_new_custom(_queue_->capacity, _queue_->alloc);            \
                                                                                                \
-        if (!result)                                                                           \
+        if (CMC_UNLIKELY(!result))                                                             \
             return NULL;                                                                       \
                                                                                                \
         if (copy_func)                                                                         \
@@ -338,24 +634,49 @@ static const char *cmc_string_fmt_queue = "%s at %p { buffer:%p, capacity:%" PRI
             {                                                                                  \
                 result->buffer[j] = copy_func(_queue_->buffer[i]);                             \
                                                                                                \
-                i = (i + 1) % _queue_->capacity;                                               \
+                i = PFX##_impl_next(_queue_, i);                                               \
             }                                                                                  \
         }                                                                                      \
         else                                                                                   \
         {                                                                                      \
-            for (size_t i = _queue_->front, j = 0; j < _queue_->count; j++)                    \
-            {                                                                                  \
-                result->buffer[j] = _queue_->buffer[i];                                        \
+            V *a;                                                                              \
+            V *b;                                                                              \
+            size_t first, second;                                                              \
                                                                                                \
-                i = (i + 1) % _queue_->capacity;                                               \
-            }                                                                                  \
+            PFX##_spans(_queue_, &a, &first, &b, &second);                                     \
+                                                                                               \
+            memcpy(result->buffer, a, first * sizeof(V));                                      \
+            memcpy(result->buffer + first, b, second * sizeof(V));                             \
         }                                                                                      \
                                                                                                \
         result->count = _queue_->count;                                                        \
+        result->back = PFX##_impl_wrap(result, result->count);                                 \
                                                                                                \
         return result;                                                                         \
     }                                                                                          \
                                                                                                \
+    /* Copies up to size elements, from front to back, to elements and */                      \
+    /* returns how many were copied */                                                         \
+    size_t PFX##_to_array(struct SNAME *_queue_, V *CMC_RESTRICT elements, size_t size)        \
+    {                                                                                          \
+        V *a;                                                                                  \
+        V *b;                                                                                  \
+        size_t first, second;                                                                  \
+                                                                                               \
+        PFX##_spans(_queue_, &a, &first, &b, &second);                                         \
+                                                                                               \
+        if (size > _queue_->count)                                                             \
+            size = _queue_->count;                                                             \
+                                                                                               \
+        if (first > size)                                                                      \
+            first = size;                                                                      \
+                                                                                               \
+        memcpy(elements, a, first * sizeof(V));                                                \
+        memcpy(elements + first, b, (size - first) * sizeof(V));                               \
+                                                                                               \
+        return size;                                                                           \
+    }                                                                                          \
+                                                                                               \
     bool PFX##_equals(struct SNAME *_queue1_, struct SNAME *_queue2_, int (*comparator)(V, V)) \
     {                                                                                          \
         if (PFX##_count(_queue1_) != PFX##_count(_queue2_))                                    \
@@ -367,8 +688,8 @@ static const char *cmc_string_fmt_queue = "%s at %p { buffer:%p, capacity:%" PRI
             if (comparator(_queue1_->buffer[i], _queue2_->buffer[j]) != 0)                     \
                 return false;                                                                  \
                                                                                                \
-            i = (i + 1) % _queue1_->capacity;                                                  \
-            j = (j + 1) % _queue2_->capacity;                                                  \
+            i = PFX##_impl_next(_queue1_, i);                                                  \
+            j = PFX##_impl_next(_queue2_, j);                                                  \
         }                                                                                      \
                                                                                                \
         return true;                                                                           \
@@ -386,11 +707,88 @@ static const char *cmc_string_fmt_queue = "%s at %p { buffer:%p, capacity:%" PRI
         return str;                                                                            \
     }                                                                                          \
                                                                                                \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE)                             \
+                                                                                               \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE, (V))                               \
+                                                                                               \
+    bool PFX##_save(struct SNAME *_queue_, FILE *file, bool (*writer)(V, FILE *))              \
+    {                                                                                          \
+        uint32_t flags = writer ? 0 : CMC_SERIAL_RAW_VALUES;                                   \
+                                                                                               \
+        if (!cmc_serial_write_header(file, "queue", flags, 0, sizeof(V), 0,                    \
+                                     _queue_->count, _queue_->capacity, 0))                    \
+            return false;                                                                      \
+                                                                                               \
+        /* Without a writer the elements are written in at most two blocks, */                 \
+        /* from front to the end of the buffer and then from its start */                      \
+        if (!writer)                                                                           \
+        {                                                                                      \
+            size_t first = _queue_->capacity - _queue_->front;                                 \
+                                                                                               \
+            if (first > _queue_->count)                                                        \
+                first = _queue_->count;                                                        \
+                                                                                               \
+            size_t second = _queue_->count - first;                                            \
+                                                                                               \
+            return fwrite(_queue_->buffer + _queue_->front, sizeof(V), first, file) ==         \
+                       first &&                                                                \
+                   fwrite(_queue_->buffer, sizeof(V), second, file) == second;                 \
+        }                                                                                      \
+                                                                                               \
+        for (size_t i = _queue_->front, j = 0; j < _queue_->count; j++)                        \
+        {                                                                                      \
+            if (!writer(_queue_->buffer[i], file))                                             \
+                return false;                                                                  \
+                                                                                               \
+            i = PFX##_impl_next(_queue_, i);                                                   \
+        }                                                                                      \
+                                                                                               \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    /* The reader is only used if the queue was saved with a writer */                         \
+    struct SNAME *PFX##_restore(FILE *file, bool (*reader)(V *, FILE *))                       \
+    {                                                                                          \
+        struct cmc_serial_header header;                                                       \
+                                                                                               \
+        if (!cmc_serial_read_header(file, "queue", 0, sizeof(V), &header))                     \
+            return NULL;                                                                       \
+                                                                                               \
+        if (header.capacity < header.count)                                                    \
+            return NULL;                                                                       \
+                                                                                               \
+        /* Allocated with the saved capacity so that loading never grows */                    \
+        struct SNAME *_queue_ = PFX##_new(header.capacity);                                    \
+                                                                                               \
+        if (CMC_UNLIKELY(!_queue_))                                                            \
+            return NULL;                                                                       \
+                                                                                               \
+        if (header.flags & CMC_SERIAL_RAW_VALUES)                                              \
+            _queue_->count = fread(_queue_->buffer, sizeof(V), header.count, file);            \
+        else                                                                                   \
+        {                                                                                      \
+            while (_queue_->count < header.count &&                                            \
+                   CMC_SERIAL_READ(false, reader, &(_queue_->buffer[_queue_->count]), file))   \
+                _queue_->count++;                                                              \
+        }                                                                                      \
+                                                                                               \
+        if (_queue_->count != header.count)                                                    \
+        {                                                                                      \
+            PFX##_free(_queue_, NULL);                                                         \
+            return NULL;                                                                       \
+        }                                                                                      \
+                                                                                               \
+        /* The elements were read in order into the start of the buffer */                     \
+        _queue_->back = PFX##_impl_wrap(_queue_, _queue_->count);                              \
+                                                                                               \
+        return _queue_;                                                                        \
+    }                                                                                          \
+                                                                                               \
     struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                  \
     {                                                                                          \
-        struct SNAME##_iter *iter = malloc(sizeof(struct SNAME##_iter));                       \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));        \
                                                                                                \
-        if (!iter)                                                                             \
+        if (CMC_UNLIKELY(!iter))                                                               \
             return NULL;                                                                       \
                                                                                                \
         PFX##_iter_init(iter, target);                                                         \
@@ -400,7 +798,7 @@ static const char *cmc_string_fmt_queue = "%s at %p { buffer:%p, capacity:%" PRI
                                                                                                \
     void PFX##_iter_free(struct SNAME##_iter *iter)                                            \
     {                                                                                          \
-        free(iter);                                                                            \
+        iter->target->alloc->free(iter);                                                       \
     }                                                                                          \
                                                                                                \
     void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                      \
@@ -436,10 +834,7 @@ static const char *cmc_string_fmt_queue = "%s at %p { buffer:%p, capacity:%" PRI
             iter->cursor = 0;                                                                  \
         else                                                                                   \
         {                                                                                      \
-            if (iter->target->back == 0)                                                       \
-                iter->cursor = iter->target->capacity - 1;                                     \
-            else                                                                               \
-                iter->cursor = iter->target->back - 1;                                         \
+            iter->cursor = PFX##_impl_prev(iter->target, iter->target->back);                  \
         }                                                                                      \
                                                                                                \
         iter->index = iter->target->count - 1;                                                 \
@@ -460,7 +855,7 @@ static const char *cmc_string_fmt_queue = "%s at %p { buffer:%p, capacity:%" PRI
                                                                                                \
         iter->start = PFX##_empty(iter->target);                                               \
                                                                                                \
-        iter->cursor = (iter->cursor + 1) % (iter->target->capacity);                          \
+        iter->cursor = PFX##_impl_next(iter->target, iter->cursor);                            \
         iter->index++;                                                                         \
                                                                                                \
         return true;                                                                           \
@@ -479,7 +874,7 @@ static const char *cmc_string_fmt_queue = "%s at %p { buffer:%p, capacity:%" PRI
                                                                                                \
         iter->end = PFX##_empty(iter->target);                                                 \
                                                                                                \
-        iter->cursor = (iter->cursor == 0) ? iter->target->capacity - 1 : iter->cursor - 1;    \
+        iter->cursor = PFX##_impl_prev(iter->target, iter->cursor);                            \
         iter->index--;                                                                         \
                                                                                                \
         return true;                                                                           \
@@ -503,7 +898,7 @@ static const char *cmc_string_fmt_queue = "%s at %p { buffer:%p, capacity:%" PRI
         iter->start = PFX##_empty(iter->target);                                               \
                                                                                                \
         iter->index += steps;                                                                  \
-        iter->cursor = (iter->cursor + steps) % iter->target->capacity;                        \
+        iter->cursor = PFX##_impl_wrap(iter->target, iter->cursor + steps);                    \
                                                                                                \
         return true;                                                                           \
     }                                                                                          \
@@ -528,10 +923,9 @@ static const char *cmc_string_fmt_queue = "%s at %p { buffer:%p, capacity:%" PRI
         iter->index -= steps;                                                                  \
                                                                                                \
         /* Prevent underflow */                                                                \
-        if (iter->cursor < steps)                                                              \
-            iter->cursor += PFX##_capacity(iter->target);                                      \
+        size_t cursor = iter->cursor + PFX##_capacity(iter->target) - steps;                   \
                                                                                                \
-        iter->cursor -= steps;                                                                 \
+        iter->cursor = PFX##_impl_wrap(iter->target, cursor);                                  \
                                                                                                \
         return true;                                                                           \
     }                                                                                          \
@@ -571,6 +965,52 @@ static const char *cmc_string_fmt_queue = "%s at %p { buffer:%p, capacity:%" PRI
         return iter->index;                                                                    \
     }                                                                                          \
                                                                                                \
+    /* Called after removals, halves the buffer until it is no longer mostly empty */          \
+    static void PFX##_impl_low_water(struct SNAME *_queue_)                                    \
+    {                                                                                          \
+        size_t capacity = _queue_->capacity;                                                   \
+                                                                                               \
+        while (capacity > 1 &&                                                                 \
+               (double)_queue_->count < (double)capacity * CMC_SHRINK_LOW_WATER)               \
+            capacity /= 2;                                                                     \
+                                                                                               \
+        if (capacity != _queue_->capacity)                                                     \
+            PFX##_resize(_queue_, capacity);                                                   \
+    }                                                                                          \
+                                                                                               \
+    /* Called when the buffer is full, grows it by the policy of cmc_growth.h */               \
+    static bool PFX##_impl_grow(struct SNAME *_queue_, size_t required)                        \
+    {                                                                                          \
+        return PFX##_resize(_queue_, cmc_growth_capacity(_queue_->capacity, required));        \
+    }                                                                                          \
+                                                                                               \
+    /* Index after i in the circular buffer */                                                 \
+    static inline size_t PFX##_impl_next(struct SNAME *_queue_, size_t i)                      \
+    {                                                                                          \
+        if (CMC_RING_POW2)                                                                     \
+            return (i + 1) & (_queue_->capacity - 1);                                          \
+                                                                                               \
+        return i + 1 == _queue_->capacity ? 0 : i + 1;                                         \
+    }                                                                                          \
+                                                                                               \
+    /* Index before i in the circular buffer */                                                \
+    static inline size_t PFX##_impl_prev(struct SNAME *_queue_, size_t i)                      \
+    {                                                                                          \
+        if (CMC_RING_POW2)                                                                     \
+            return (i - 1) & (_queue_->capacity - 1);                                          \
+                                                                                               \
+        return i == 0 ? _queue_->capacity - 1 : i - 1;                                         \
+    }                                                                                          \
+                                                                                               \
+    /* Wraps an index less than twice the capacity around the buffer */                        \
+    static inline size_t PFX##_impl_wrap(struct SNAME *_queue_, size_t i)                      \
+    {                                                                                          \
+        if (CMC_RING_POW2)                                                                     \
+            return i & (_queue_->capacity - 1);                                                \
+                                                                                               \
+        return i >= _queue_->capacity ? i - _queue_->capacity : i;                             \
+    }                                                                                          \
+                                                                                               \
     static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_queue_)                      \
     {                                                                                          \
         struct SNAME##_iter iter;                                                              \
@@ -0,0 +1,380 @@
+/**
+ * radixheap.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * RadixHeap
+ *
+ * A RadixHeap is a MinHeap for elements with unsigned integer keys that are
+ * removed in an order that never goes back, like the timestamps of an event
+ * scheduler or the distances of Dijkstra's algorithm. An element can only be
+ * inserted if its key is not less than the key of the last element removed.
+ * In exchange no two elements are ever compared, each one is moved at most
+ * once for every bit of its key and removing takes amortized O(log C), where
+ * C is the largest difference between two keys.
+ *
+ * Implementation
+ *
+ * The keys are given by a function passed to new. The elements are kept in
+ * 65 buckets by the highest bit in which their key differs from the key of
+ * the last element removed: bucket 0 has the keys equal to it and bucket i
+ * the keys whose highest differing bit is i - 1. Only bucket 0 is ever
+ * removed from. Once it is empty the first bucket that is not is emptied
+ * into the lower ones, relative to its smallest key, which becomes the new
+ * last key.
+ *
+ * Elements with equal keys are removed in no particular order.
+ */
+
+#ifndef CMC_RADIXHEAP_H
+#define CMC_RADIXHEAP_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_growth.h"
+#include "../utl/cmc_math.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* One bucket for equal keys and one for each bit of a key */
+#define CMC_RADIXHEAP_BUCKETS 65
+
+/* to_string format */
+static const char *cmc_string_fmt_radixheap = "%s at %p { count:%" PRIuMAX ", last:%" PRIu64 ", key:%p }";
+
+#define CMC_GENERATE_RADIXHEAP(PFX, SNAME, V)    \
+    CMC_GENERATE_RADIXHEAP_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_RADIXHEAP_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_RADIXHEAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_RADIXHEAP_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_RADIXHEAP_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_RADIXHEAP_SOURCE(PFX, SNAME, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_RADIXHEAP_HEADER(PFX, SNAME, V)                      \
+    /* Radix Heap Item */                                                 \
+    struct SNAME##_item                                                   \
+    {                                                                     \
+        uint64_t key;                                                     \
+        V value;                                                          \
+    };                                                                    \
+                                                                          \
+    /* Radix Heap Bucket */                                               \
+    struct SNAME##_bucket                                                 \
+    {                                                                     \
+        /* Dynamic array of elements and their keys */                    \
+        struct SNAME##_item *items;                                       \
+                                                                          \
+        /* Current array capacity */                                      \
+        size_t capacity;                                                  \
+                                                                          \
+        /* Current amount of elements in the bucket */                    \
+        size_t count;                                                     \
+    };                                                                    \
+                                                                          \
+    /* Radix Heap Structure */                                            \
+    struct SNAME                                                          \
+    {                                                                     \
+        /* Elements by the highest bit their key differs from last */     \
+        struct SNAME##_bucket buckets[CMC_RADIXHEAP_BUCKETS];             \
+                                                                          \
+        /* Current amount of elements in the heap */                      \
+        size_t count;                                                     \
+                                                                          \
+        /* Key of the last element removed, no key in the heap is less */ \
+        uint64_t last;                                                    \
+                                                                          \
+        /* Function that returns the key of an element */                 \
+        uint64_t (*key)(V);                                               \
+                                                                          \
+        /* Custom allocation functions */                                 \
+        struct cmc_alloc_node *alloc;                                     \
+    };                                                                    \
+                                                                          \
+    /* Collection Functions */                                            \
+    /* Collection Allocation and Deallocation */                          \
+    struct SNAME *PFX##_new(uint64_t (*key)(V));                          \
+    struct SNAME *PFX##_new_custom(uint64_t (*key)(V),                    \
+                                   struct cmc_alloc_node *alloc);         \
+    void PFX##_clear(struct SNAME *_heap_, void (*deallocator)(V));       \
+    void PFX##_free(struct SNAME *_heap_, void (*deallocator)(V));        \
+    /* Collection Input and Output */                                     \
+    bool PFX##_insert(struct SNAME *_heap_, V element);                   \
+    bool PFX##_remove(struct SNAME *_heap_, V *result);                   \
+    /* Element Access */                                                  \
+    bool PFX##_peek(struct SNAME *_heap_, V *value);                      \
+    uint64_t PFX##_last(struct SNAME *_heap_);                            \
+    /* Collection State */                                                \
+    CMC_PURE bool PFX##_empty(struct SNAME *_heap_);                      \
+    CMC_PURE size_t PFX##_count(struct SNAME *_heap_);                    \
+    size_t PFX##_memory_usage(struct SNAME *_heap_);                      \
+    /* Collection Utility */                                              \
+    struct cmc_string PFX##_to_string(struct SNAME *_heap_);              \
+                                                                          \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_RADIXHEAP_SOURCE(PFX, SNAME, V)                                             \
+    /* Implementation Detail Functions */                                                        \
+    static inline size_t PFX##_impl_bucket(struct SNAME *_heap_, uint64_t key);                  \
+    static bool PFX##_impl_reserve(struct SNAME *_heap_, struct SNAME##_bucket *bucket,          \
+                                   size_t required);                                             \
+    static bool PFX##_impl_refill(struct SNAME *_heap_);                                         \
+                                                                                                 \
+    struct SNAME *PFX##_new(uint64_t (*key)(V))                                                  \
+    {                                                                                            \
+        return PFX##_new_custom(key, NULL);                                                      \
+    }                                                                                            \
+                                                                                                 \
+    struct SNAME *PFX##_new_custom(uint64_t (*key)(V), struct cmc_alloc_node *alloc)             \
+    {                                                                                            \
+        if (!alloc)                                                                              \
+            alloc = &cmc_alloc_node_default;                                                     \
+                                                                                                 \
+        if (!key)                                                                                \
+            return NULL;                                                                         \
+                                                                                                 \
+        struct SNAME *_heap_ = alloc->malloc(sizeof(struct SNAME));                              \
+                                                                                                 \
+        if (CMC_UNLIKELY(!_heap_))                                                               \
+            return NULL;                                                                         \
+                                                                                                 \
+        _heap_->alloc = alloc;                                                                   \
+                                                                                                 \
+        memset(_heap_->buckets, 0, sizeof(_heap_->buckets));                                     \
+                                                                                                 \
+        _heap_->count = 0;                                                                       \
+        _heap_->last = 0;                                                                        \
+        _heap_->key = key;                                                                       \
+                                                                                                 \
+        return _heap_;                                                                           \
+    }                                                                                            \
+                                                                                                 \
+    /* The buckets keep their memory and the last key goes back to 0 */                          \
+    void PFX##_clear(struct SNAME *_heap_, void (*deallocator)(V))                               \
+    {                                                                                            \
+        for (size_t i = 0; i < CMC_RADIXHEAP_BUCKETS; i++)                                       \
+        {                                                                                        \
+            struct SNAME##_bucket *bucket = &(_heap_->buckets[i]);                               \
+                                                                                                 \
+            if (deallocator)                                                                     \
+            {                                                                                    \
+                for (size_t j = 0; j < bucket->count; j++)                                       \
+                    deallocator(bucket->items[j].value);                                         \
+            }                                                                                    \
+                                                                                                 \
+            bucket->count = 0;                                                                   \
+        }                                                                                        \
+                                                                                                 \
+        _heap_->count = 0;                                                                       \
+        _heap_->last = 0;                                                                        \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_free(struct SNAME *_heap_, void (*deallocator)(V))                                \
+    {                                                                                            \
+        PFX##_clear(_heap_, deallocator);                                                        \
+                                                                                                 \
+        for (size_t i = 0; i < CMC_RADIXHEAP_BUCKETS; i++)                                       \
+            _heap_->alloc->free(_heap_->buckets[i].items);                                       \
+                                                                                                 \
+        _heap_->alloc->free(_heap_);                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Fails if the key of element is less than the last key removed */                          \
+    bool PFX##_insert(struct SNAME *_heap_, V element)                                           \
+    {                                                                                            \
+        uint64_t key = _heap_->key(element);                                                     \
+                                                                                                 \
+        if (key < _heap_->last)                                                                  \
+            return false;                                                                        \
+                                                                                                 \
+        struct SNAME##_bucket *bucket = &(_heap_->buckets[PFX##_impl_bucket(_heap_, key)]);      \
+                                                                                                 \
+        if (CMC_UNLIKELY(!PFX##_impl_reserve(_heap_, bucket, bucket->count + 1)))                \
+            return false;                                                                        \
+                                                                                                 \
+        bucket->items[bucket->count].key = key;                                                  \
+        bucket->items[bucket->count].value = element;                                            \
+        bucket->count++;                                                                         \
+                                                                                                 \
+        _heap_->count++;                                                                         \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Removes an element with the smallest key. Can only fail if the heap is */                 \
+    /* empty or if a bucket could not grow while they were refilled */                           \
+    bool PFX##_remove(struct SNAME *_heap_, V *result)                                           \
+    {                                                                                            \
+        if (!PFX##_impl_refill(_heap_))                                                          \
+            return false;                                                                        \
+                                                                                                 \
+        struct SNAME##_bucket *bucket = &(_heap_->buckets[0]);                                   \
+                                                                                                 \
+        bucket->count--;                                                                         \
+                                                                                                 \
+        if (result)                                                                              \
+            *result = bucket->items[bucket->count].value;                                        \
+                                                                                                 \
+        _heap_->count--;                                                                         \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Same as remove but the element stays in the heap */                                       \
+    bool PFX##_peek(struct SNAME *_heap_, V *value)                                              \
+    {                                                                                            \
+        if (!PFX##_impl_refill(_heap_))                                                          \
+            return false;                                                                        \
+                                                                                                 \
+        struct SNAME##_bucket *bucket = &(_heap_->buckets[0]);                                   \
+                                                                                                 \
+        if (value)                                                                               \
+            *value = bucket->items[bucket->count - 1].value;                                     \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* The key that no element inserted can be less than */                                      \
+    uint64_t PFX##_last(struct SNAME *_heap_)                                                    \
+    {                                                                                            \
+        return _heap_->last;                                                                     \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_empty(struct SNAME *_heap_)                                                       \
+    {                                                                                            \
+        return _heap_->count == 0;                                                               \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_count(struct SNAME *_heap_)                                                     \
+    {                                                                                            \
+        return _heap_->count;                                                                    \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_memory_usage(struct SNAME *_heap_)                                              \
+    {                                                                                            \
+        size_t bytes = sizeof(struct SNAME);                                                     \
+                                                                                                 \
+        for (size_t i = 0; i < CMC_RADIXHEAP_BUCKETS; i++)                                       \
+            bytes += sizeof(struct SNAME##_item) * _heap_->buckets[i].capacity;                  \
+                                                                                                 \
+        return bytes;                                                                            \
+    }                                                                                            \
+                                                                                                 \
+    struct cmc_string PFX##_to_string(struct SNAME *_heap_)                                      \
+    {                                                                                            \
+        struct cmc_string str;                                                                   \
+        struct SNAME *h_ = _heap_;                                                               \
+        const char *name = #SNAME;                                                               \
+                                                                                                 \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_radixheap, name, h_, h_->count, h_->last, \
+                 h_->key);                                                                       \
+                                                                                                 \
+        return str;                                                                              \
+    }                                                                                            \
+                                                                                                 \
+    /* 0 if key is equal to last, otherwise one more than its highest bit that */                \
+    /* is different */                                                                           \
+    static inline size_t PFX##_impl_bucket(struct SNAME *_heap_, uint64_t key)                   \
+    {                                                                                            \
+        return 64 - cmc_math_clz(key ^ _heap_->last);                                            \
+    }                                                                                            \
+                                                                                                 \
+    static bool PFX##_impl_reserve(struct SNAME *_heap_, struct SNAME##_bucket *bucket,          \
+                                   size_t required)                                              \
+    {                                                                                            \
+        if (required <= bucket->capacity)                                                        \
+            return true;                                                                         \
+                                                                                                 \
+        size_t capacity = cmc_growth_capacity(bucket->capacity, required);                       \
+                                                                                                 \
+        if (capacity > SIZE_MAX / sizeof(struct SNAME##_item))                                   \
+            return false;                                                                        \
+                                                                                                 \
+        size_t bytes = sizeof(struct SNAME##_item) * capacity;                                   \
+                                                                                                 \
+        struct SNAME##_item *items = _heap_->alloc->realloc(bucket->items, bytes);               \
+                                                                                                 \
+        if (CMC_UNLIKELY(!items))                                                                \
+            return false;                                                                        \
+                                                                                                 \
+        bucket->items = items;                                                                   \
+        bucket->capacity = capacity;                                                             \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Makes sure that bucket 0 is not empty. If it is, the first bucket that */                 \
+    /* is not gets its smallest key as the last one and its elements are moved */                \
+    /* to lower buckets. Every bucket that receives them grows before any is */                  \
+    /* moved, so nothing changes if one can't */                                                 \
+    static bool PFX##_impl_refill(struct SNAME *_heap_)                                          \
+    {                                                                                            \
+        if (PFX##_empty(_heap_))                                                                 \
+            return false;                                                                        \
+                                                                                                 \
+        if (_heap_->buckets[0].count > 0)                                                        \
+            return true;                                                                         \
+                                                                                                 \
+        size_t index = 1;                                                                        \
+                                                                                                 \
+        while (_heap_->buckets[index].count == 0)                                                \
+            index++;                                                                             \
+                                                                                                 \
+        struct SNAME##_bucket *from = &(_heap_->buckets[index]);                                 \
+                                                                                                 \
+        uint64_t last = from->items[0].key;                                                      \
+                                                                                                 \
+        for (size_t i = 1; i < from->count; i++)                                                 \
+        {                                                                                        \
+            if (from->items[i].key < last)                                                       \
+                last = from->items[i].key;                                                       \
+        }                                                                                        \
+                                                                                                 \
+        uint64_t old_last = _heap_->last;                                                        \
+                                                                                                 \
+        _heap_->last = last;                                                                     \
+                                                                                                 \
+        /* Every element goes to a bucket below index */                                         \
+        size_t moving[CMC_RADIXHEAP_BUCKETS] = { 0 };                                            \
+                                                                                                 \
+        for (size_t i = 0; i < from->count; i++)                                                 \
+            moving[PFX##_impl_bucket(_heap_, from->items[i].key)]++;                             \
+                                                                                                 \
+        for (size_t i = 0; i < index; i++)                                                       \
+        {                                                                                        \
+            struct SNAME##_bucket *to = &(_heap_->buckets[i]);                                   \
+                                                                                                 \
+            if (moving[i] > 0 && !PFX##_impl_reserve(_heap_, to, to->count + moving[i]))         \
+            {                                                                                    \
+                _heap_->last = old_last;                                                         \
+                return false;                                                                    \
+            }                                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        for (size_t i = 0; i < from->count; i++)                                                 \
+        {                                                                                        \
+            size_t i_to = PFX##_impl_bucket(_heap_, from->items[i].key);                         \
+                                                                                                 \
+            struct SNAME##_bucket *to = &(_heap_->buckets[i_to]);                                \
+                                                                                                 \
+            to->items[to->count++] = from->items[i];                                             \
+        }                                                                                        \
+                                                                                                 \
+        from->count = 0;                                                                         \
+                                                                                                 \
+        return true;                                                                             \
+    }
+
+#endif /* CMC_RADIXHEAP_H */
@@ -0,0 +1,1529 @@
+/**
+ * radixtreemap.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * RadixTreeMap
+ *
+ * A RadixTreeMap is a sorted Map whose keys are strings of bytes, given as a
+ * pointer and a length, that are copied into the map. Keys are never hashed
+ * or compared as a whole: looking one up reads each of its bytes once, going
+ * down a tree that branches on them. Keys are sorted byte by byte, as
+ * unsigned values, and a key comes before every key that starts with it.
+ * Every key that starts with a given prefix can be iterated in order.
+ *
+ * Implementation
+ *
+ * This is an Adaptive Radix Tree. Each node branches on one byte and has one
+ * of four layouts depending on how many children it has:
+ *
+ * - Node4: up to 4 sorted bytes and their children
+ * - Node16: up to 16 sorted bytes, searched with SSE2 when available
+ * - Node48: an index of 256 bytes to up to 48 children
+ * - Node256: an array of 256 children
+ *
+ * Nodes grow and shrink between these layouts as children are added and
+ * removed. A node also keeps up to CMC_RADIX_PREFIX_MAX bytes shared by every
+ * key below it, so paths without branches take a single node, and a key that
+ * ends at a node is kept by that node. A key is only in a leaf, which is
+ * pointed to by the node where it is the only key left. Leaves are also
+ * linked to each other in order, so iterating takes constant time per key.
+ */
+
+#ifndef CMC_RADIXTREEMAP_H
+#define CMC_RADIXTREEMAP_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_bits.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_radixtreemap = "%s at %p { root:%p, count:%" PRIuMAX " }";
+
+#ifndef CMC_IMPL_RADIX_NODES
+#define CMC_IMPL_RADIX_NODES
+
+/* Bytes of the keys below a node that are kept by it. Longer paths without */
+/* branches are split in nodes with a single child */
+#define CMC_RADIX_PREFIX_MAX 12
+
+/* Layouts of a node */
+#define CMC_RADIX_NODE4 0
+#define CMC_RADIX_NODE16 1
+#define CMC_RADIX_NODE48 2
+#define CMC_RADIX_NODE256 3
+
+/* Children that are leaves are tagged in their lowest bit */
+#define CMC_RADIX_IS_LEAF(child) (((uintptr_t)(child)) & 1)
+#define CMC_RADIX_LEAF(child) ((void *)((uintptr_t)(child) & ~(uintptr_t)1))
+#define CMC_RADIX_TAG(leaf) ((void *)((uintptr_t)(leaf) | 1))
+
+struct cmc_radix_node
+{
+    /* CMC_RADIX_NODE4, 16, 48 or 256 */
+    uint8_t type;
+
+    /* Bytes used in prefix */
+    uint8_t prefix_length;
+
+    /* Amount of children */
+    uint16_t count;
+
+    /* Bytes that every key below this node has at this depth */
+    uint8_t prefix[CMC_RADIX_PREFIX_MAX];
+
+    /* Leaf of the key that ends at this node, not tagged */
+    void *leaf;
+};
+
+struct cmc_radix_node4
+{
+    struct cmc_radix_node node;
+    uint8_t keys[4];
+    void *children[4];
+};
+
+struct cmc_radix_node16
+{
+    struct cmc_radix_node node;
+    uint8_t keys[16];
+    void *children[16];
+};
+
+struct cmc_radix_node48
+{
+    struct cmc_radix_node node;
+
+    /* Position in children plus one, or 0 if the byte has no child */
+    uint8_t index[256];
+    void *children[48];
+};
+
+struct cmc_radix_node256
+{
+    struct cmc_radix_node node;
+    void *children[256];
+};
+
+static const size_t cmc_radix_node_size[] = { sizeof(struct cmc_radix_node4),
+                                              sizeof(struct cmc_radix_node16),
+                                              sizeof(struct cmc_radix_node48),
+                                              sizeof(struct cmc_radix_node256) };
+
+static const uint16_t cmc_radix_node_max[] = { 4, 16, 48, 256 };
+
+/* A node is shrunk when a removal leaves it with this many children, fewer */
+/* than the layout below it holds so that it doesn't grow right back */
+static const uint16_t cmc_radix_node_min[] = { 0, 3, 12, 37 };
+
+/* Compares two strings of bytes, where a string comes before the ones that */
+/* start with it */
+static inline int cmc_radix_compare(const uint8_t *a, size_t a_length, const uint8_t *b,
+                                    size_t b_length)
+{
+    int cmp = memcmp(a, b, a_length < b_length ? a_length : b_length);
+
+    if (cmp != 0)
+        return cmp;
+
+    return (a_length > b_length) - (a_length < b_length);
+}
+
+static inline struct cmc_radix_node *cmc_radix_new_node(struct cmc_alloc_node *alloc, uint8_t type)
+{
+    struct cmc_radix_node *node = alloc->malloc(cmc_radix_node_size[type]);
+
+    if (CMC_UNLIKELY(!node))
+        return NULL;
+
+    memset(node, 0, cmc_radix_node_size[type]);
+
+    node->type = type;
+
+    return node;
+}
+
+/* Position in a Node4 or a Node16 of the first byte not less than key */
+static inline uint16_t cmc_radix_sorted_position(const uint8_t *keys, uint16_t count, uint8_t key)
+{
+    uint16_t i = 0;
+
+    while (i < count && keys[i] < key)
+        i++;
+
+    return i;
+}
+
+/* Slot of the child of a byte, or NULL if it has none */
+static inline void **cmc_radix_find(struct cmc_radix_node *node, uint8_t key)
+{
+    switch (node->type)
+    {
+        case CMC_RADIX_NODE4: {
+            struct cmc_radix_node4 *n = (struct cmc_radix_node4 *)node;
+
+            for (uint16_t i = 0; i < node->count; i++)
+            {
+                if (n->keys[i] == key)
+                    return &n->children[i];
+            }
+
+            return NULL;
+        }
+        case CMC_RADIX_NODE16: {
+            struct cmc_radix_node16 *n = (struct cmc_radix_node16 *)node;
+
+#if defined(CMC_BITS_AVX2) || defined(CMC_BITS_SSE2)
+            __m128i match = _mm_cmpeq_epi8(_mm_set1_epi8((char)key),
+                                           _mm_loadu_si128((const __m128i *)n->keys));
+            unsigned mask = (unsigned)_mm_movemask_epi8(match) & ((1u << node->count) - 1);
+
+            return mask ? &n->children[cmc_math_ctz(mask)] : NULL;
+#else
+            uint16_t i = cmc_radix_sorted_position(n->keys, node->count, key);
+
+            return i < node->count && n->keys[i] == key ? &n->children[i] : NULL;
+#endif
+        }
+        case CMC_RADIX_NODE48: {
+            struct cmc_radix_node48 *n = (struct cmc_radix_node48 *)node;
+
+            return n->index[key] ? &n->children[n->index[key] - 1] : NULL;
+        }
+        default: {
+            struct cmc_radix_node256 *n = (struct cmc_radix_node256 *)node;
+
+            return n->children[key] ? &n->children[key] : NULL;
+        }
+    }
+}
+
+/* Child of the greatest byte below key, which is 256 to get the greatest */
+/* of all, or NULL if there is none */
+static inline void *cmc_radix_below(struct cmc_radix_node *node, uint16_t key)
+{
+    switch (node->type)
+    {
+        case CMC_RADIX_NODE4:
+        case CMC_RADIX_NODE16: {
+            uint8_t *keys = node->type == CMC_RADIX_NODE4 ? ((struct cmc_radix_node4 *)node)->keys
+                                                          : ((struct cmc_radix_node16 *)node)->keys;
+            void **children = node->type == CMC_RADIX_NODE4
+                                  ? ((struct cmc_radix_node4 *)node)->children
+                                  : ((struct cmc_radix_node16 *)node)->children;
+            uint16_t i = key > UINT8_MAX ? node->count
+                                         : cmc_radix_sorted_position(keys, node->count, (uint8_t)key);
+
+            return i > 0 ? children[i - 1] : NULL;
+        }
+        case CMC_RADIX_NODE48: {
+            struct cmc_radix_node48 *n = (struct cmc_radix_node48 *)node;
+
+            while (key-- > 0)
+            {
+                if (n->index[key])
+                    return n->children[n->index[key] - 1];
+            }
+
+            return NULL;
+        }
+        default: {
+            struct cmc_radix_node256 *n = (struct cmc_radix_node256 *)node;
+
+            while (key-- > 0)
+            {
+                if (n->children[key])
+                    return n->children[key];
+            }
+
+            return NULL;
+        }
+    }
+}
+
+/* Child of the smallest byte, or NULL if there is none */
+static inline void *cmc_radix_first(struct cmc_radix_node *node)
+{
+    switch (node->type)
+    {
+        case CMC_RADIX_NODE4:
+            return node->count ? ((struct cmc_radix_node4 *)node)->children[0] : NULL;
+        case CMC_RADIX_NODE16:
+            return node->count ? ((struct cmc_radix_node16 *)node)->children[0] : NULL;
+        case CMC_RADIX_NODE48: {
+            struct cmc_radix_node48 *n = (struct cmc_radix_node48 *)node;
+
+            for (uint16_t key = 0; key < 256; key++)
+            {
+                if (n->index[key])
+                    return n->children[n->index[key] - 1];
+            }
+
+            return NULL;
+        }
+        default: {
+            struct cmc_radix_node256 *n = (struct cmc_radix_node256 *)node;
+
+            for (uint16_t key = 0; key < 256; key++)
+            {
+                if (n->children[key])
+                    return n->children[key];
+            }
+
+            return NULL;
+        }
+    }
+}
+
+/* Leaf of the smallest key below child, not tagged */
+static inline void *cmc_radix_min(void *child)
+{
+    while (!CMC_RADIX_IS_LEAF(child))
+    {
+        struct cmc_radix_node *node = child;
+
+        if (node->leaf)
+            return node->leaf;
+
+        child = cmc_radix_first(node);
+    }
+
+    return CMC_RADIX_LEAF(child);
+}
+
+/* Leaf of the greatest key below child, not tagged */
+static inline void *cmc_radix_max(void *child)
+{
+    while (!CMC_RADIX_IS_LEAF(child))
+    {
+        struct cmc_radix_node *node = child;
+
+        if (node->count == 0)
+            return node->leaf;
+
+        child = cmc_radix_below(node, 256);
+    }
+
+    return CMC_RADIX_LEAF(child);
+}
+
+/* Copies the header and children of a node to one of another layout */
+static inline void cmc_radix_move(struct cmc_radix_node *from, struct cmc_radix_node *to)
+{
+    uint8_t type = to->type;
+    uint16_t count = 0;
+
+    memcpy(to, from, sizeof(struct cmc_radix_node));
+
+    to->type = type;
+
+    /* Goes through the children of from in order of byte */
+    for (uint16_t key = 0; key < 256; key++)
+    {
+        void **slot = cmc_radix_find(from, (uint8_t)key);
+
+        if (!slot)
+            continue;
+
+        switch (type)
+        {
+            case CMC_RADIX_NODE4:
+                ((struct cmc_radix_node4 *)to)->keys[count] = (uint8_t)key;
+                ((struct cmc_radix_node4 *)to)->children[count] = *slot;
+                break;
+            case CMC_RADIX_NODE16:
+                ((struct cmc_radix_node16 *)to)->keys[count] = (uint8_t)key;
+                ((struct cmc_radix_node16 *)to)->children[count] = *slot;
+                break;
+            case CMC_RADIX_NODE48:
+                ((struct cmc_radix_node48 *)to)->index[key] = (uint8_t)(count + 1);
+                ((struct cmc_radix_node48 *)to)->children[count] = *slot;
+                break;
+            default:
+                ((struct cmc_radix_node256 *)to)->children[key] = *slot;
+                break;
+        }
+
+        count++;
+    }
+}
+
+/* Adds the child of a byte that has none to the node at ref, which is */
+/* replaced by a larger one if it is full */
+static inline bool cmc_radix_add(struct cmc_alloc_node *alloc, void **ref, uint8_t key, void *child)
+{
+    struct cmc_radix_node *node = *ref;
+
+    if (node->count == cmc_radix_node_max[node->type])
+    {
+        struct cmc_radix_node *larger = cmc_radix_new_node(alloc, node->type + 1);
+
+        if (!larger)
+            return false;
+
+        cmc_radix_move(node, larger);
+        alloc->free(node);
+
+        *ref = node = larger;
+    }
+
+    switch (node->type)
+    {
+        case CMC_RADIX_NODE4:
+        case CMC_RADIX_NODE16: {
+            uint8_t *keys = node->type == CMC_RADIX_NODE4 ? ((struct cmc_radix_node4 *)node)->keys
+                                                          : ((struct cmc_radix_node16 *)node)->keys;
+            void **children = node->type == CMC_RADIX_NODE4
+                                  ? ((struct cmc_radix_node4 *)node)->children
+                                  : ((struct cmc_radix_node16 *)node)->children;
+            uint16_t i = cmc_radix_sorted_position(keys, node->count, key);
+
+            memmove(keys + i + 1, keys + i, node->count - i);
+            memmove(children + i + 1, children + i, (node->count - i) * sizeof(void *));
+
+            keys[i] = key;
+            children[i] = child;
+            break;
+        }
+        case CMC_RADIX_NODE48: {
+            struct cmc_radix_node48 *n = (struct cmc_radix_node48 *)node;
+            uint8_t slot = 0;
+
+            while (n->children[slot])
+                slot++;
+
+            n->index[key] = (uint8_t)(slot + 1);
+            n->children[slot] = child;
+            break;
+        }
+        default:
+            ((struct cmc_radix_node256 *)node)->children[key] = child;
+            break;
+    }
+
+    node->count++;
+
+    return true;
+}
+
+/* Removes the child of a byte from the node at ref, which is replaced by a */
+/* smaller one if it has few children left */
+static inline void cmc_radix_remove(struct cmc_alloc_node *alloc, void **ref, uint8_t key)
+{
+    struct cmc_radix_node *node = *ref;
+
+    switch (node->type)
+    {
+        case CMC_RADIX_NODE4:
+        case CMC_RADIX_NODE16: {
+            uint8_t *keys = node->type == CMC_RADIX_NODE4 ? ((struct cmc_radix_node4 *)node)->keys
+                                                          : ((struct cmc_radix_node16 *)node)->keys;
+            void **children = node->type == CMC_RADIX_NODE4
+                                  ? ((struct cmc_radix_node4 *)node)->children
+                                  : ((struct cmc_radix_node16 *)node)->children;
+            uint16_t i = cmc_radix_sorted_position(keys, node->count, key);
+
+            memmove(keys + i, keys + i + 1, node->count - i - 1);
+            memmove(children + i, children + i + 1, (node->count - i - 1) * sizeof(void *));
+            break;
+        }
+        case CMC_RADIX_NODE48: {
+            struct cmc_radix_node48 *n = (struct cmc_radix_node48 *)node;
+
+            n->children[n->index[key] - 1] = NULL;
+            n->index[key] = 0;
+            break;
+        }
+        default:
+            ((struct cmc_radix_node256 *)node)->children[key] = NULL;
+            break;
+    }
+
+    node->count--;
+
+    if (node->type == CMC_RADIX_NODE4 || node->count != cmc_radix_node_min[node->type])
+        return;
+
+    /* If the smaller node can't be allocated the larger one is still valid */
+    struct cmc_radix_node *smaller = cmc_radix_new_node(alloc, node->type - 1);
+
+    if (!smaller)
+        return;
+
+    cmc_radix_move(node, smaller);
+    alloc->free(node);
+
+    *ref = smaller;
+}
+
+/* Replaces the node at ref, that lost a child or its leaf, by what is left */
+/* of it when it has a single child or leaf. A node with a single child */
+/* node is merged into it if their prefixes fit in one */
+static inline void cmc_radix_collapse(struct cmc_alloc_node *alloc, void **ref)
+{
+    struct cmc_radix_node *node = *ref;
+
+    if (node->count == 0)
+    {
+        *ref = node->leaf ? CMC_RADIX_TAG(node->leaf) : NULL;
+        alloc->free(node);
+        return;
+    }
+
+    if (node->count > 1 || node->leaf)
+        return;
+
+    void *child = cmc_radix_first(node);
+
+    if (CMC_RADIX_IS_LEAF(child))
+    {
+        *ref = child;
+        alloc->free(node);
+        return;
+    }
+
+    struct cmc_radix_node *below = child;
+    size_t length = (size_t)node->prefix_length + 1 + below->prefix_length;
+
+    if (length > CMC_RADIX_PREFIX_MAX)
+        return;
+
+    uint8_t prefix[CMC_RADIX_PREFIX_MAX];
+    uint16_t key = 0;
+
+    while (!cmc_radix_find(node, (uint8_t)key))
+        key++;
+
+    memcpy(prefix, node->prefix, node->prefix_length);
+    prefix[node->prefix_length] = (uint8_t)key;
+    memcpy(prefix + node->prefix_length + 1, below->prefix, below->prefix_length);
+    memcpy(below->prefix, prefix, length);
+
+    below->prefix_length = (uint8_t)length;
+
+    *ref = below;
+    alloc->free(node);
+}
+
+/* Frees a chain of nodes with a single child each, down to the first child */
+/* that is not a node of the chain */
+static inline void cmc_radix_free_chain(struct cmc_alloc_node *alloc, struct cmc_radix_node *node,
+                                        size_t length)
+{
+    while (length-- > 0)
+    {
+        struct cmc_radix_node *next = node->count ? cmc_radix_first(node) : NULL;
+
+        alloc->free(node);
+
+        node = next;
+    }
+}
+
+/* Puts a and b, two keys that are different, below a new node at ref. The */
+/* bytes both have from depth on go to the prefix of that node, or of a */
+/* chain of nodes if they don't fit in one */
+static inline bool cmc_radix_split(struct cmc_alloc_node *alloc, void **ref, size_t depth,
+                                   const uint8_t *a, size_t a_length, void *a_child,
+                                   const uint8_t *b, size_t b_length, void *b_child)
+{
+    struct cmc_radix_node *first = NULL, *last = NULL;
+    size_t common = 0, chain = 0;
+    uint8_t edge = 0;
+
+    while (depth + common < a_length && depth + common < b_length &&
+           a[depth + common] == b[depth + common])
+        common++;
+
+    for (;;)
+    {
+        struct cmc_radix_node *node = cmc_radix_new_node(alloc, CMC_RADIX_NODE4);
+
+        if (!node)
+        {
+            cmc_radix_free_chain(alloc, first, chain);
+            return false;
+        }
+
+        size_t take = common < CMC_RADIX_PREFIX_MAX ? common : CMC_RADIX_PREFIX_MAX;
+
+        memcpy(node->prefix, a + depth, take);
+        node->prefix_length = (uint8_t)take;
+
+        if (last)
+            cmc_radix_add(alloc, (void **)&last, edge, node);
+        else
+            first = node;
+
+        last = node;
+        chain++;
+        depth += take;
+        common -= take;
+
+        if (common == 0)
+            break;
+
+        edge = a[depth];
+        depth++;
+        common--;
+    }
+
+    /* At most one of them ends at the last node */
+    if (depth == a_length)
+        last->leaf = CMC_RADIX_LEAF(a_child);
+    else
+        cmc_radix_add(alloc, (void **)&last, a[depth], a_child);
+
+    if (depth == b_length)
+        last->leaf = CMC_RADIX_LEAF(b_child);
+    else
+        cmc_radix_add(alloc, (void **)&last, b[depth], b_child);
+
+    *ref = first;
+
+    return true;
+}
+
+/* Frees every node below child, but not the leaves */
+static inline void cmc_radix_free_nodes(struct cmc_alloc_node *alloc, void *child)
+{
+    if (!child || CMC_RADIX_IS_LEAF(child))
+        return;
+
+    struct cmc_radix_node *node = child;
+
+    for (uint16_t key = 0; key < 256 && node->count > 0; key++)
+    {
+        void **slot = cmc_radix_find(node, (uint8_t)key);
+
+        if (slot)
+            cmc_radix_free_nodes(alloc, *slot);
+    }
+
+    alloc->free(node);
+}
+
+/* Bytes taken by every node below child, but not by the leaves */
+static inline size_t cmc_radix_nodes_size(void *child)
+{
+    if (!child || CMC_RADIX_IS_LEAF(child))
+        return 0;
+
+    struct cmc_radix_node *node = child;
+    size_t size = cmc_radix_node_size[node->type];
+
+    for (uint16_t key = 0; key < 256; key++)
+    {
+        void **slot = cmc_radix_find(node, (uint8_t)key);
+
+        if (slot)
+            size += cmc_radix_nodes_size(*slot);
+    }
+
+    return size;
+}
+
+#endif /* CMC_IMPL_RADIX_NODES */
+
+#define CMC_GENERATE_RADIXTREEMAP(PFX, SNAME, V)    \
+    CMC_GENERATE_RADIXTREEMAP_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_RADIXTREEMAP_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_RADIXTREEMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_RADIXTREEMAP_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_RADIXTREEMAP_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_RADIXTREEMAP_SOURCE(PFX, SNAME, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_RADIXTREEMAP_HEADER(PFX, SNAME, V)                                            \
+                                                                                                   \
+    /* RadixTreeMap Structure */                                                                   \
+    struct SNAME                                                                                   \
+    {                                                                                              \
+        /* Root node or leaf, NULL if the map is empty */                                          \
+        void *root;                                                                                \
+                                                                                                   \
+        /* Leaves of the smallest and of the greatest keys */                                      \
+        struct SNAME##_leaf *head;                                                                 \
+        struct SNAME##_leaf *tail;                                                                 \
+                                                                                                   \
+        /* Current amount of keys */                                                               \
+        size_t count;                                                                              \
+                                                                                                   \
+        /* Function that returns an iterator to the start of the radixtreemap */                   \
+        struct SNAME##_iter (*it_start)(struct SNAME *);                                           \
+                                                                                                   \
+        /* Function that returns an iterator to the end of the radixtreemap */                     \
+        struct SNAME##_iter (*it_end)(struct SNAME *);                                             \
+                                                                                                   \
+        /* Custom allocation functions */                                                          \
+        struct cmc_alloc_node *alloc;                                                              \
+    };                                                                                             \
+                                                                                                   \
+    /* RadixTreeMap Leaf, with a copy of its key */                                                \
+    struct SNAME##_leaf                                                                            \
+    {                                                                                              \
+        /* Leaves of the previous and of the next keys */                                          \
+        struct SNAME##_leaf *prev;                                                                 \
+        struct SNAME##_leaf *next;                                                                 \
+                                                                                                   \
+        V value;                                                                                   \
+                                                                                                   \
+        /* Bytes of key, which is also followed by a 0 */                                          \
+        size_t length;                                                                             \
+        char key[];                                                                                \
+    };                                                                                             \
+                                                                                                   \
+    /* RadixTreeMap Iterator */                                                                    \
+    struct SNAME##_iter                                                                            \
+    {                                                                                              \
+        /* Target RadixTreeMap */                                                                  \
+        struct SNAME *target;                                                                      \
+                                                                                                   \
+        /* Cursor's current leaf */                                                                \
+        struct SNAME##_leaf *cursor;                                                               \
+                                                                                                   \
+        /* First and last leaves of the iteration, NULL if it is empty */                          \
+        struct SNAME##_leaf *first;                                                                \
+        struct SNAME##_leaf *last;                                                                 \
+                                                                                                   \
+        /* Keeps track of relative index to the iteration of elements */                           \
+        size_t index;                                                                              \
+                                                                                                   \
+        /* Amount of keys from first to last, or SIZE_MAX until counted */                         \
+        size_t count;                                                                              \
+                                                                                                   \
+        /* If the iterator has reached the start of the iteration */                               \
+        bool start;                                                                                \
+                                                                                                   \
+        /* If the iterator has reached the end of the iteration */                                 \
+        bool end;                                                                                  \
+    };                                                                                             \
+                                                                                                   \
+    /* Collection Functions */                                                                     \
+    /* Collection Allocation and Deallocation */                                                   \
+    struct SNAME *PFX##_new(void);                                                                 \
+    struct SNAME *PFX##_new_custom(struct cmc_alloc_node *alloc);                                  \
+    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(V));                                 \
+    void PFX##_free(struct SNAME *_map_, void (*deallocator)(V));                                  \
+    /* Collection Input and Output */                                                              \
+    bool PFX##_insert(struct SNAME *_map_, const char *key, size_t length, V value);               \
+    V *PFX##_get_or_insert(struct SNAME *_map_, const char *key, size_t length, V default_value);  \
+    bool PFX##_update(struct SNAME *_map_, const char *key, size_t length, V new_value,            \
+                      V *old_value);                                                               \
+    bool PFX##_remove(struct SNAME *_map_, const char *key, size_t length, V *out_value);          \
+    /* Element Access */                                                                           \
+    bool PFX##_max(struct SNAME *_map_, const char **key, size_t *length, V *value);               \
+    bool PFX##_min(struct SNAME *_map_, const char **key, size_t *length, V *value);               \
+    V PFX##_get(struct SNAME *_map_, const char *key, size_t length);                              \
+    V *PFX##_get_ref(struct SNAME *_map_, const char *key, size_t length);                         \
+    /* Collection State */                                                                         \
+    bool PFX##_contains(struct SNAME *_map_, const char *key, size_t length);                      \
+    CMC_PURE bool PFX##_empty(struct SNAME *_map_);                                                \
+    CMC_PURE size_t PFX##_count(struct SNAME *_map_);                                              \
+    size_t PFX##_memory_usage(struct SNAME *_map_);                                                \
+    /* Collection Utility */                                                                       \
+    struct SNAME *PFX##_copy_of(struct SNAME *_map_, V (*value_copy_func)(V));                     \
+    bool PFX##_equals(struct SNAME *_map1_, struct SNAME *_map2_, int (*value_comparator)(V, V));  \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_);                                        \
+                                                                                                   \
+    /* Iterator Functions */                                                                       \
+    /* Iterator Allocation and Deallocation */                                                     \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target);                                     \
+    void PFX##_iter_free(struct SNAME##_iter *iter);                                               \
+    /* Iterator Initialization */                                                                  \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);                         \
+    struct SNAME##_iter PFX##_prefix_iter(struct SNAME *_map_, const char *prefix, size_t length); \
+    /* Iterator State */                                                                           \
+    bool PFX##_iter_start(struct SNAME##_iter *iter);                                              \
+    bool PFX##_iter_end(struct SNAME##_iter *iter);                                                \
+    /* Iterator Movement */                                                                        \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter);                                           \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter);                                             \
+    bool PFX##_iter_next(struct SNAME##_iter *iter);                                               \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter);                                               \
+    /* Iterator Access */                                                                          \
+    const char *PFX##_iter_key(struct SNAME##_iter *iter, size_t *length);                         \
+    V PFX##_iter_value(struct SNAME##_iter *iter);                                                 \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter);                                               \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter);                                            \
+                                                                                                   \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_RADIXTREEMAP_SOURCE(PFX, SNAME, V)                                              \
+                                                                                                     \
+    /* Implementation Detail Functions */                                                            \
+    static struct SNAME##_leaf *PFX##_impl_get_leaf(struct SNAME *_map_, const char *key,            \
+                                                    size_t length);                                  \
+    static struct SNAME##_leaf *PFX##_impl_insert(struct SNAME *_map_, const char *key,              \
+                                                  size_t length, V value, bool *inserted);           \
+    static struct SNAME##_leaf *PFX##_impl_new_leaf(struct SNAME *_map_, const char *key,            \
+                                                    size_t length, V value);                         \
+    static void PFX##_impl_link(struct SNAME *_map_, struct SNAME##_leaf *leaf,                      \
+                                struct SNAME##_leaf *prev);                                          \
+    static struct SNAME##_leaf *PFX##_impl_remove(struct SNAME *_map_, void **ref,                   \
+                                                  const uint8_t *key, size_t length,                 \
+                                                  size_t depth);                                     \
+    static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_map_);                             \
+    static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_map_);                               \
+                                                                                                     \
+    struct SNAME *PFX##_new(void)                                                                    \
+    {                                                                                                \
+        return PFX##_new_custom(NULL);                                                               \
+    }                                                                                                \
+                                                                                                     \
+    struct SNAME *PFX##_new_custom(struct cmc_alloc_node *alloc)                                     \
+    {                                                                                                \
+        if (!alloc)                                                                                  \
+            alloc = &cmc_alloc_node_default;                                                         \
+                                                                                                     \
+        struct SNAME *_map_ = alloc->malloc(sizeof(struct SNAME));                                   \
+                                                                                                     \
+        if (CMC_UNLIKELY(!_map_))                                                                    \
+            return NULL;                                                                             \
+                                                                                                     \
+        _map_->root = NULL;                                                                          \
+        _map_->head = NULL;                                                                          \
+        _map_->tail = NULL;                                                                          \
+        _map_->count = 0;                                                                            \
+        _map_->it_start = PFX##_impl_it_start;                                                       \
+        _map_->it_end = PFX##_impl_it_end;                                                           \
+        _map_->alloc = alloc;                                                                        \
+                                                                                                     \
+        return _map_;                                                                                \
+    }                                                                                                \
+                                                                                                     \
+    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(V))                                    \
+    {                                                                                                \
+        struct SNAME##_leaf *leaf = _map_->head;                                                     \
+                                                                                                     \
+        cmc_radix_free_nodes(_map_->alloc, _map_->root);                                             \
+                                                                                                     \
+        while (leaf)                                                                                 \
+        {                                                                                            \
+            struct SNAME##_leaf *next = leaf->next;                                                  \
+                                                                                                     \
+            if (deallocator)                                                                         \
+                deallocator(leaf->value);                                                            \
+                                                                                                     \
+            _map_->alloc->free(leaf);                                                                \
+                                                                                                     \
+            leaf = next;                                                                             \
+        }                                                                                            \
+                                                                                                     \
+        _map_->root = NULL;                                                                          \
+        _map_->head = NULL;                                                                          \
+        _map_->tail = NULL;                                                                          \
+        _map_->count = 0;                                                                            \
+    }                                                                                                \
+                                                                                                     \
+    void PFX##_free(struct SNAME *_map_, void (*deallocator)(V))                                     \
+    {                                                                                                \
+        PFX##_clear(_map_, deallocator);                                                             \
+                                                                                                     \
+        _map_->alloc->free(_map_);                                                                   \
+    }                                                                                                \
+                                                                                                     \
+    /* Returns false if the key was already present or could not be added */                         \
+    bool PFX##_insert(struct SNAME *_map_, const char *key, size_t length, V value)                  \
+    {                                                                                                \
+        bool inserted;                                                                               \
+                                                                                                     \
+        PFX##_impl_insert(_map_, key, length, value, &inserted);                                     \
+                                                                                                     \
+        return inserted;                                                                             \
+    }                                                                                                \
+                                                                                                     \
+    /* Returns a reference to the value of key, which is added with */                               \
+    /* default_value if it is not present, or NULL if it could not be added */                       \
+    V *PFX##_get_or_insert(struct SNAME *_map_, const char *key, size_t length, V default_value)     \
+    {                                                                                                \
+        bool inserted;                                                                               \
+        struct SNAME##_leaf *leaf = PFX##_impl_insert(_map_, key, length, default_value, &inserted); \
+                                                                                                     \
+        return leaf ? &leaf->value : NULL;                                                           \
+    }                                                                                                \
+                                                                                                     \
+    bool PFX##_update(struct SNAME *_map_, const char *key, size_t length, V new_value,              \
+                      V *old_value)                                                                  \
+    {                                                                                                \
+        struct SNAME##_leaf *leaf = PFX##_impl_get_leaf(_map_, key, length);                         \
+                                                                                                     \
+        if (!leaf)                                                                                   \
+            return false;                                                                            \
+                                                                                                     \
+        if (old_value)                                                                               \
+            *old_value = leaf->value;                                                                \
+                                                                                                     \
+        leaf->value = new_value;                                                                     \
+                                                                                                     \
+        return true;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    bool PFX##_remove(struct SNAME *_map_, const char *key, size_t length, V *out_value)             \
+    {                                                                                                \
+        if (!_map_->root)                                                                            \
+            return false;                                                                            \
+                                                                                                     \
+        struct SNAME##_leaf *leaf =                                                                  \
+            PFX##_impl_remove(_map_, &_map_->root, (const uint8_t *)key, length, 0);                 \
+                                                                                                     \
+        if (!leaf)                                                                                   \
+            return false;                                                                            \
+                                                                                                     \
+        if (leaf->prev)                                                                              \
+            leaf->prev->next = leaf->next;                                                           \
+        else                                                                                         \
+            _map_->head = leaf->next;                                                                \
+                                                                                                     \
+        if (leaf->next)                                                                              \
+            leaf->next->prev = leaf->prev;                                                           \
+        else                                                                                         \
+            _map_->tail = leaf->prev;                                                                \
+                                                                                                     \
+        if (out_value)                                                                               \
+            *out_value = leaf->value;                                                                \
+                                                                                                     \
+        _map_->alloc->free(leaf);                                                                    \
+        _map_->count--;                                                                              \
+                                                                                                     \
+        return true;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    /* The key returned is owned by the map and is valid until it is removed */                      \
+    bool PFX##_max(struct SNAME *_map_, const char **key, size_t *length, V *value)                  \
+    {                                                                                                \
+        if (PFX##_empty(_map_))                                                                      \
+            return false;                                                                            \
+                                                                                                     \
+        if (key)                                                                                     \
+            *key = _map_->tail->key;                                                                 \
+        if (length)                                                                                  \
+            *length = _map_->tail->length;                                                           \
+        if (value)                                                                                   \
+            *value = _map_->tail->value;                                                             \
+                                                                                                     \
+        return true;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    bool PFX##_min(struct SNAME *_map_, const char **key, size_t *length, V *value)                  \
+    {                                                                                                \
+        if (PFX##_empty(_map_))                                                                      \
+            return false;                                                                            \
+                                                                                                     \
+        if (key)                                                                                     \
+            *key = _map_->head->key;                                                                 \
+        if (length)                                                                                  \
+            *length = _map_->head->length;                                                           \
+        if (value)                                                                                   \
+            *value = _map_->head->value;                                                             \
+                                                                                                     \
+        return true;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    V PFX##_get(struct SNAME *_map_, const char *key, size_t length)                                 \
+    {                                                                                                \
+        struct SNAME##_leaf *leaf = PFX##_impl_get_leaf(_map_, key, length);                         \
+                                                                                                     \
+        if (!leaf)                                                                                   \
+            return (V){0};                                                                           \
+                                                                                                     \
+        return leaf->value;                                                                          \
+    }                                                                                                \
+                                                                                                     \
+    V *PFX##_get_ref(struct SNAME *_map_, const char *key, size_t length)                            \
+    {                                                                                                \
+        struct SNAME##_leaf *leaf = PFX##_impl_get_leaf(_map_, key, length);                         \
+                                                                                                     \
+        if (!leaf)                                                                                   \
+            return NULL;                                                                             \
+                                                                                                     \
+        return &leaf->value;                                                                         \
+    }                                                                                                \
+                                                                                                     \
+    bool PFX##_contains(struct SNAME *_map_, const char *key, size_t length)                         \
+    {                                                                                                \
+        return PFX##_impl_get_leaf(_map_, key, length) != NULL;                                      \
+    }                                                                                                \
+                                                                                                     \
+    bool PFX##_empty(struct SNAME *_map_)                                                            \
+    {                                                                                                \
+        return _map_->count == 0;                                                                    \
+    }                                                                                                \
+                                                                                                     \
+    size_t PFX##_count(struct SNAME *_map_)                                                          \
+    {                                                                                                \
+        return _map_->count;                                                                         \
+    }                                                                                                \
+                                                                                                     \
+    size_t PFX##_memory_usage(struct SNAME *_map_)                                                   \
+    {                                                                                                \
+        size_t size = sizeof(struct SNAME) + cmc_radix_nodes_size(_map_->root);                      \
+                                                                                                     \
+        for (struct SNAME##_leaf *leaf = _map_->head; leaf; leaf = leaf->next)                       \
+            size += sizeof(struct SNAME##_leaf) + leaf->length + 1;                                  \
+                                                                                                     \
+        return size;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    struct SNAME *PFX##_copy_of(struct SNAME *_map_, V (*value_copy_func)(V))                        \
+    {                                                                                                \
+        struct SNAME *result = PFX##_new_custom(_map_->alloc);                                       \
+                                                                                                     \
+        if (CMC_UNLIKELY(!result))                                                                   \
+            return NULL;                                                                             \
+                                                                                                     \
+        /* Keys are inserted in order, so each leaf is linked after the tail */                      \
+        for (struct SNAME##_leaf *leaf = _map_->head; leaf; leaf = leaf->next)                       \
+        {                                                                                            \
+            V value = value_copy_func ? value_copy_func(leaf->value) : leaf->value;                  \
+                                                                                                     \
+            if (!PFX##_insert(result, leaf->key, leaf->length, value))                               \
+            {                                                                                        \
+                PFX##_free(result, NULL);                                                            \
+                return NULL;                                                                         \
+            }                                                                                        \
+        }                                                                                            \
+                                                                                                     \
+        return result;                                                                               \
+    }                                                                                                \
+                                                                                                     \
+    bool PFX##_equals(struct SNAME *_map1_, struct SNAME *_map2_, int (*value_comparator)(V, V))     \
+    {                                                                                                \
+        if (_map1_->count != _map2_->count)                                                          \
+            return false;                                                                            \
+                                                                                                     \
+        struct SNAME##_leaf *a = _map1_->head, *b = _map2_->head;                                    \
+                                                                                                     \
+        /* Both have their keys in the same order */                                                 \
+        for (; a && b; a = a->next, b = b->next)                                                     \
+        {                                                                                            \
+            if (a->length != b->length || memcmp(a->key, b->key, a->length) != 0)                    \
+                return false;                                                                        \
+                                                                                                     \
+            if (value_comparator && value_comparator(a->value, b->value) != 0)                       \
+                return false;                                                                        \
+        }                                                                                            \
+                                                                                                     \
+        return true;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_)                                           \
+    {                                                                                                \
+        struct cmc_string str;                                                                       \
+        struct SNAME *m_ = _map_;                                                                    \
+        const char *name = #SNAME;                                                                   \
+                                                                                                     \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_radixtreemap, name, m_, m_->root,             \
+                 m_->count);                                                                         \
+                                                                                                     \
+        return str;                                                                                  \
+    }                                                                                                \
+                                                                                                     \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                        \
+    {                                                                                                \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));              \
+                                                                                                     \
+        if (CMC_UNLIKELY(!iter))                                                                     \
+            return NULL;                                                                             \
+                                                                                                     \
+        PFX##_iter_init(iter, target);                                                               \
+                                                                                                     \
+        return iter;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    void PFX##_iter_free(struct SNAME##_iter *iter)                                                  \
+    {                                                                                                \
+        iter->target->alloc->free(iter);                                                             \
+    }                                                                                                \
+                                                                                                     \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                            \
+    {                                                                                                \
+        memset(iter, 0, sizeof(struct SNAME##_iter));                                                \
+                                                                                                     \
+        iter->target = target;                                                                       \
+        iter->first = target->head;                                                                  \
+        iter->last = target->tail;                                                                   \
+        iter->count = target->count;                                                                 \
+                                                                                                     \
+        PFX##_iter_to_start(iter);                                                                   \
+    }                                                                                                \
+                                                                                                     \
+    /* An iterator over the keys that start with prefix, in order, which */                          \
+    /* is empty if there are none. Only the subtree of prefix is searched */                         \
+    struct SNAME##_iter PFX##_prefix_iter(struct SNAME *_map_, const char *prefix, size_t length)    \
+    {                                                                                                \
+        struct SNAME##_iter iter;                                                                    \
+        const uint8_t *p = (const uint8_t *)prefix;                                                  \
+        void *child = _map_->root;                                                                   \
+        size_t depth = 0;                                                                            \
+                                                                                                     \
+        memset(&iter, 0, sizeof(struct SNAME##_iter));                                               \
+                                                                                                     \
+        iter.target = _map_;                                                                         \
+        iter.count = SIZE_MAX;                                                                       \
+                                                                                                     \
+        while (child && !CMC_RADIX_IS_LEAF(child))                                                   \
+        {                                                                                            \
+            struct cmc_radix_node *node = child;                                                     \
+            size_t i = 0;                                                                            \
+                                                                                                     \
+            while (i < node->prefix_length && depth + i < length && node->prefix[i] == p[depth + i]) \
+                i++;                                                                                 \
+                                                                                                     \
+            /* The prefix ends at or inside this node, so it is its subtree */                       \
+            if (depth + i == length)                                                                 \
+                break;                                                                               \
+                                                                                                     \
+            if (i < node->prefix_length)                                                             \
+            {                                                                                        \
+                child = NULL;                                                                        \
+                break;                                                                               \
+            }                                                                                        \
+                                                                                                     \
+            depth += node->prefix_length;                                                            \
+                                                                                                     \
+            void **slot = depth < length ? cmc_radix_find(node, p[depth]) : NULL;                    \
+                                                                                                     \
+            child = slot ? *slot : NULL;                                                             \
+            depth++;                                                                                 \
+        }                                                                                            \
+                                                                                                     \
+        if (child && CMC_RADIX_IS_LEAF(child))                                                       \
+        {                                                                                            \
+            struct SNAME##_leaf *leaf = CMC_RADIX_LEAF(child);                                       \
+                                                                                                     \
+            if (leaf->length < length || memcmp(leaf->key, prefix, length) != 0)                     \
+                child = NULL;                                                                        \
+        }                                                                                            \
+                                                                                                     \
+        if (child)                                                                                   \
+        {                                                                                            \
+            iter.first = cmc_radix_min(child);                                                       \
+            iter.last = cmc_radix_max(child);                                                        \
+        }                                                                                            \
+        else                                                                                         \
+            iter.count = 0;                                                                          \
+                                                                                                     \
+        PFX##_iter_to_start(&iter);                                                                  \
+                                                                                                     \
+        return iter;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                                 \
+    {                                                                                                \
+        return !iter->first || iter->start;                                                          \
+    }                                                                                                \
+                                                                                                     \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                                   \
+    {                                                                                                \
+        return !iter->first || iter->end;                                                            \
+    }                                                                                                \
+                                                                                                     \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                              \
+    {                                                                                                \
+        iter->cursor = iter->first;                                                                  \
+        iter->index = 0;                                                                             \
+        iter->start = true;                                                                          \
+        iter->end = !iter->first;                                                                    \
+    }                                                                                                \
+                                                                                                     \
+    /* The keys of a prefix_iter are counted the first time it goes here */                          \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                                \
+    {                                                                                                \
+        if (iter->count == SIZE_MAX)                                                                 \
+        {                                                                                            \
+            iter->count = 1;                                                                         \
+                                                                                                     \
+            for (struct SNAME##_leaf *leaf = iter->first; leaf != iter->last; leaf = leaf->next)     \
+                iter->count++;                                                                       \
+        }                                                                                            \
+                                                                                                     \
+        iter->cursor = iter->last;                                                                   \
+        iter->index = iter->first ? iter->count - 1 : 0;                                             \
+        iter->start = !iter->first;                                                                  \
+        iter->end = true;                                                                            \
+    }                                                                                                \
+                                                                                                     \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                                  \
+    {                                                                                                \
+        if (iter->end)                                                                               \
+            return false;                                                                            \
+                                                                                                     \
+        if (iter->cursor == iter->last)                                                              \
+        {                                                                                            \
+            iter->end = true;                                                                        \
+            return false;                                                                            \
+        }                                                                                            \
+                                                                                                     \
+        iter->start = false;                                                                         \
+        iter->cursor = iter->cursor->next;                                                           \
+        iter->index++;                                                                               \
+                                                                                                     \
+        return true;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                                  \
+    {                                                                                                \
+        if (iter->start)                                                                             \
+            return false;                                                                            \
+                                                                                                     \
+        if (iter->cursor == iter->first)                                                             \
+        {                                                                                            \
+            iter->start = true;                                                                      \
+            return false;                                                                            \
+        }                                                                                            \
+                                                                                                     \
+        iter->end = false;                                                                           \
+        iter->cursor = iter->cursor->prev;                                                           \
+        iter->index--;                                                                               \
+                                                                                                     \
+        return true;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    /* The key is owned by the map and is followed by a 0 */                                         \
+    const char *PFX##_iter_key(struct SNAME##_iter *iter, size_t *length)                            \
+    {                                                                                                \
+        if (!iter->cursor)                                                                           \
+        {                                                                                            \
+            if (length)                                                                              \
+                *length = 0;                                                                         \
+                                                                                                     \
+            return NULL;                                                                             \
+        }                                                                                            \
+                                                                                                     \
+        if (length)                                                                                  \
+            *length = iter->cursor->length;                                                          \
+                                                                                                     \
+        return iter->cursor->key;                                                                    \
+    }                                                                                                \
+                                                                                                     \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                                    \
+    {                                                                                                \
+        if (!iter->cursor)                                                                           \
+            return (V){0};                                                                           \
+                                                                                                     \
+        return iter->cursor->value;                                                                  \
+    }                                                                                                \
+                                                                                                     \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter)                                                  \
+    {                                                                                                \
+        if (!iter->cursor)                                                                           \
+            return NULL;                                                                             \
+                                                                                                     \
+        return &iter->cursor->value;                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                               \
+    {                                                                                                \
+        return iter->index;                                                                          \
+    }                                                                                                \
+                                                                                                     \
+    static struct SNAME##_leaf *PFX##_impl_get_leaf(struct SNAME *_map_, const char *key,            \
+                                                    size_t length)                                   \
+    {                                                                                                \
+        const uint8_t *k = (const uint8_t *)key;                                                     \
+        void *child = _map_->root;                                                                   \
+        size_t depth = 0;                                                                            \
+                                                                                                     \
+        while (child && !CMC_RADIX_IS_LEAF(child))                                                   \
+        {                                                                                            \
+            struct cmc_radix_node *node = child;                                                     \
+                                                                                                     \
+            if (length - depth < node->prefix_length ||                                              \
+                memcmp(node->prefix, k + depth, node->prefix_length) != 0)                           \
+                return NULL;                                                                         \
+                                                                                                     \
+            depth += node->prefix_length;                                                            \
+                                                                                                     \
+            if (depth == length)                                                                     \
+                return node->leaf;                                                                   \
+                                                                                                     \
+            void **slot = cmc_radix_find(node, k[depth]);                                            \
+                                                                                                     \
+            child = slot ? *slot : NULL;                                                             \
+            depth++;                                                                                 \
+        }                                                                                            \
+                                                                                                     \
+        if (!child)                                                                                  \
+            return NULL;                                                                             \
+                                                                                                     \
+        /* The bytes skipped by the nodes above are also compared */                                 \
+        struct SNAME##_leaf *leaf = CMC_RADIX_LEAF(child);                                           \
+                                                                                                     \
+        if (leaf->length != length || memcmp(leaf->key, key, length) != 0)                           \
+            return NULL;                                                                             \
+                                                                                                     \
+        return leaf;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    /* Returns the leaf of key, that is added with value if it was not there, */                     \
+    /* or NULL if it could not be added */                                                           \
+    static struct SNAME##_leaf *PFX##_impl_insert(struct SNAME *_map_, const char *key,              \
+                                                  size_t length, V value, bool *inserted)            \
+    {                                                                                                \
+        const uint8_t *k = (const uint8_t *)key;                                                     \
+        struct cmc_alloc_node *alloc = _map_->alloc;                                                 \
+        struct SNAME##_leaf *leaf, *prev = NULL;                                                     \
+        void **ref = &_map_->root;                                                                   \
+        size_t depth = 0;                                                                            \
+                                                                                                     \
+        *inserted = false;                                                                           \
+                                                                                                     \
+        while (*ref && !CMC_RADIX_IS_LEAF(*ref))                                                     \
+        {                                                                                            \
+            struct cmc_radix_node *node = *ref;                                                      \
+            size_t i = 0;                                                                            \
+                                                                                                     \
+            while (i < node->prefix_length && depth + i < length && node->prefix[i] == k[depth + i]) \
+                i++;                                                                                 \
+                                                                                                     \
+            /* Key leaves the prefix of this node, which is split where it does */                   \
+            if (i < node->prefix_length)                                                             \
+            {                                                                                        \
+                bool before = depth + i == length || k[depth + i] < node->prefix[i];                 \
+                struct cmc_radix_node *parent = cmc_radix_new_node(alloc, CMC_RADIX_NODE4);          \
+                                                                                                     \
+                if (!parent)                                                                         \
+                    return NULL;                                                                     \
+                                                                                                     \
+                if (!(leaf = PFX##_impl_new_leaf(_map_, key, length, value)))                        \
+                {                                                                                    \
+                    alloc->free(parent);                                                             \
+                    return NULL;                                                                     \
+                }                                                                                    \
+                                                                                                     \
+                prev = before ? ((struct SNAME##_leaf *)cmc_radix_min(node))->prev                   \
+                              : (struct SNAME##_leaf *)cmc_radix_max(node);                          \
+                                                                                                     \
+                uint8_t edge = node->prefix[i];                                                      \
+                                                                                                     \
+                memcpy(parent->prefix, node->prefix, i);                                             \
+                parent->prefix_length = (uint8_t)i;                                                  \
+                                                                                                     \
+                memmove(node->prefix, node->prefix + i + 1, node->prefix_length - i - 1);            \
+                node->prefix_length = (uint8_t)(node->prefix_length - i - 1);                        \
+                                                                                                     \
+                cmc_radix_add(alloc, (void **)&parent, edge, node);                                  \
+                                                                                                     \
+                if (depth + i == length)                                                             \
+                    parent->leaf = leaf;                                                             \
+                else                                                                                 \
+                    cmc_radix_add(alloc, (void **)&parent, k[depth + i], CMC_RADIX_TAG(leaf));       \
+                                                                                                     \
+                *ref = parent;                                                                       \
+                                                                                                     \
+                goto inserted;                                                                       \
+            }                                                                                        \
+                                                                                                     \
+            depth += node->prefix_length;                                                            \
+                                                                                                     \
+            if (depth == length)                                                                     \
+            {                                                                                        \
+                if (node->leaf)                                                                      \
+                    return node->leaf;                                                               \
+                                                                                                     \
+                if (!(leaf = PFX##_impl_new_leaf(_map_, key, length, value)))                        \
+                    return NULL;                                                                     \
+                                                                                                     \
+                prev = ((struct SNAME##_leaf *)cmc_radix_min(node))->prev;                           \
+                node->leaf = leaf;                                                                   \
+                                                                                                     \
+                goto inserted;                                                                       \
+            }                                                                                        \
+                                                                                                     \
+            void **slot = cmc_radix_find(node, k[depth]);                                            \
+                                                                                                     \
+            if (slot)                                                                                \
+            {                                                                                        \
+                ref = slot;                                                                          \
+                depth++;                                                                             \
+                continue;                                                                            \
+            }                                                                                        \
+                                                                                                     \
+            if (!(leaf = PFX##_impl_new_leaf(_map_, key, length, value)))                            \
+                return NULL;                                                                         \
+                                                                                                     \
+            /* The key before it is the greatest of the children before it */                        \
+            void *below = cmc_radix_below(node, k[depth]);                                           \
+                                                                                                     \
+            if (below)                                                                               \
+                prev = cmc_radix_max(below);                                                         \
+            else if (node->leaf)                                                                     \
+                prev = node->leaf;                                                                   \
+            else                                                                                     \
+                prev = ((struct SNAME##_leaf *)cmc_radix_min(node))->prev;                           \
+                                                                                                     \
+            if (!cmc_radix_add(alloc, ref, k[depth], CMC_RADIX_TAG(leaf)))                           \
+            {                                                                                        \
+                alloc->free(leaf);                                                                   \
+                return NULL;                                                                         \
+            }                                                                                        \
+                                                                                                     \
+            goto inserted;                                                                           \
+        }                                                                                            \
+                                                                                                     \
+        if (*ref)                                                                                    \
+        {                                                                                            \
+            /* Two keys where there was one, split from depth on */                                  \
+            struct SNAME##_leaf *other = CMC_RADIX_LEAF(*ref);                                       \
+            int cmp = cmc_radix_compare(k, length, (const uint8_t *)other->key, other->length);      \
+                                                                                                     \
+            if (cmp == 0)                                                                            \
+                return other;                                                                        \
+                                                                                                     \
+            if (!(leaf = PFX##_impl_new_leaf(_map_, key, length, value)))                            \
+                return NULL;                                                                         \
+                                                                                                     \
+            if (!cmc_radix_split(alloc, ref, depth, (const uint8_t *)other->key, other->length,      \
+                                 *ref, k, length, CMC_RADIX_TAG(leaf)))                              \
+            {                                                                                        \
+                alloc->free(leaf);                                                                   \
+                return NULL;                                                                         \
+            }                                                                                        \
+                                                                                                     \
+            prev = cmp > 0 ? other : other->prev;                                                    \
+        }                                                                                            \
+        else                                                                                         \
+        {                                                                                            \
+            if (!(leaf = PFX##_impl_new_leaf(_map_, key, length, value)))                            \
+                return NULL;                                                                         \
+                                                                                                     \
+            *ref = CMC_RADIX_TAG(leaf);                                                              \
+        }                                                                                            \
+                                                                                                     \
+    inserted:                                                                                        \
+        PFX##_impl_link(_map_, leaf, prev);                                                          \
+                                                                                                     \
+        _map_->count++;                                                                              \
+        *inserted = true;                                                                            \
+                                                                                                     \
+        return leaf;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    static struct SNAME##_leaf *PFX##_impl_new_leaf(struct SNAME *_map_, const char *key,            \
+                                                    size_t length, V value)                          \
+    {                                                                                                \
+        struct SNAME##_leaf *leaf = _map_->alloc->malloc(sizeof(struct SNAME##_leaf) + length + 1);  \
+                                                                                                     \
+        if (CMC_UNLIKELY(!leaf))                                                                     \
+            return NULL;                                                                             \
+                                                                                                     \
+        leaf->prev = NULL;                                                                           \
+        leaf->next = NULL;                                                                           \
+        leaf->value = value;                                                                         \
+        leaf->length = length;                                                                       \
+                                                                                                     \
+        memcpy(leaf->key, key, length);                                                              \
+        leaf->key[length] = 0;                                                                       \
+                                                                                                     \
+        return leaf;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    /* Links leaf after prev, or as the head if prev is NULL */                                      \
+    static void PFX##_impl_link(struct SNAME *_map_, struct SNAME##_leaf *leaf,                      \
+                                struct SNAME##_leaf *prev)                                           \
+    {                                                                                                \
+        leaf->prev = prev;                                                                           \
+        leaf->next = prev ? prev->next : _map_->head;                                                \
+                                                                                                     \
+        if (prev)                                                                                    \
+            prev->next = leaf;                                                                       \
+        else                                                                                         \
+            _map_->head = leaf;                                                                      \
+                                                                                                     \
+        if (leaf->next)                                                                              \
+            leaf->next->prev = leaf;                                                                 \
+        else                                                                                         \
+            _map_->tail = leaf;                                                                      \
+    }                                                                                                \
+                                                                                                     \
+    /* Takes the leaf of key out of the tree below ref, returning it, or NULL */                     \
+    /* if it is not there. Each node it goes through is collapsed on the way */                      \
+    /* back up if it was left with a single child */                                                 \
+    static struct SNAME##_leaf *PFX##_impl_remove(struct SNAME *_map_, void **ref,                   \
+                                                  const uint8_t *key, size_t length, size_t depth)   \
+    {                                                                                                \
+        struct SNAME##_leaf *leaf;                                                                   \
+                                                                                                     \
+        if (CMC_RADIX_IS_LEAF(*ref))                                                                 \
+        {                                                                                            \
+            leaf = CMC_RADIX_LEAF(*ref);                                                             \
+                                                                                                     \
+            if (leaf->length != length || memcmp(leaf->key, key, length) != 0)                       \
+                return NULL;                                                                         \
+                                                                                                     \
+            *ref = NULL;                                                                             \
+                                                                                                     \
+            return leaf;                                                                             \
+        }                                                                                            \
+                                                                                                     \
+        struct cmc_radix_node *node = *ref;                                                          \
+                                                                                                     \
+        if (length - depth < node->prefix_length ||                                                  \
+            memcmp(node->prefix, key + depth, node->prefix_length) != 0)                             \
+            return NULL;                                                                             \
+                                                                                                     \
+        depth += node->prefix_length;                                                                \
+                                                                                                     \
+        if (depth == length)                                                                         \
+        {                                                                                            \
+            if (!(leaf = node->leaf))                                                                \
+                return NULL;                                                                         \
+                                                                                                     \
+            node->leaf = NULL;                                                                       \
+        }                                                                                            \
+        else                                                                                         \
+        {                                                                                            \
+            void **slot = cmc_radix_find(node, key[depth]);                                          \
+                                                                                                     \
+            if (!slot)                                                                               \
+                return NULL;                                                                         \
+                                                                                                     \
+            if (!(leaf = PFX##_impl_remove(_map_, slot, key, length, depth + 1)))                    \
+                return NULL;                                                                         \
+                                                                                                     \
+            /* The child was the leaf itself */                                                      \
+            if (!*slot)                                                                              \
+                cmc_radix_remove(_map_->alloc, ref, key[depth]);                                     \
+        }                                                                                            \
+                                                                                                     \
+        cmc_radix_collapse(_map_->alloc, ref);                                                       \
+                                                                                                     \
+        return leaf;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_map_)                              \
+    {                                                                                                \
+        struct SNAME##_iter iter;                                                                    \
+                                                                                                     \
+        PFX##_iter_init(&iter, _map_);                                                               \
+        PFX##_iter_to_start(&iter);                                                                  \
+                                                                                                     \
+        return iter;                                                                                 \
+    }                                                                                                \
+                                                                                                     \
+    static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_map_)                                \
+    {                                                                                                \
+        struct SNAME##_iter iter;                                                                    \
+                                                                                                     \
+        PFX##_iter_init(&iter, _map_);                                                               \
+        PFX##_iter_to_end(&iter);                                                                    \
+                                                                                                     \
+        return iter;                                                                                 \
+    }
+
+#endif /* CMC_RADIXTREEMAP_H */
@@ -0,0 +1,640 @@
+/**
+ * ringbuffer.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * RingBuffer
+ *
+ * A RingBuffer keeps the last N elements pushed to it, for a fixed N given
+ * when it is created. Once it has N elements each push overwrites the oldest
+ * one, so a window of the latest samples of a stream is kept by pushing alone,
+ * instead of a dequeue followed by an enqueue on a Queue. Elements can be read
+ * by their position from the oldest or from the newest one, and the whole
+ * window is at most two contiguous spans of the buffer.
+ *
+ * CMC_GENERATE_RINGBUFFER_NUMERIC also generates the sum, the mean, the
+ * minimum and the maximum of the newest elements, for types with the +, <
+ * and > operators. Their loops go through each span with no wrapping and
+ * with independent accumulators, so that the compiler can vectorize them.
+ *
+ * Implementation
+ *
+ * The buffer has a power of two capacity, at least N, so positions wrap
+ * around by masking them. head counts every push since the ring was
+ * created or cleared and the newest element is at head - 1.
+ */
+
+#ifndef CMC_RINGBUFFER_H
+#define CMC_RINGBUFFER_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* The buffer is aligned to cache lines */
+#ifndef CMC_CACHE_LINE_SIZE
+#define CMC_CACHE_LINE_SIZE 64
+#endif
+
+/* to_string format */
+static const char *cmc_string_fmt_ringbuffer = "%s at %p { buffer:%p, window:%" PRIuMAX ", capacity:%" PRIuMAX ", count:%" PRIuMAX ", head:%" PRIuMAX " }";
+
+#define CMC_GENERATE_RINGBUFFER(PFX, SNAME, V)    \
+    CMC_GENERATE_RINGBUFFER_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_RINGBUFFER_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_RINGBUFFER_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_RINGBUFFER_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_RINGBUFFER_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_RINGBUFFER_SOURCE(PFX, SNAME, V)
+
+/* Same as CMC_GENERATE_RINGBUFFER plus sum, mean, min and max, where S is */
+/* the type that the elements are summed as, like int64_t for int32_t */
+#define CMC_GENERATE_RINGBUFFER_NUMERIC(PFX, SNAME, V, S)    \
+    CMC_GENERATE_RINGBUFFER_HEADER(PFX, SNAME, V)            \
+    CMC_GENERATE_RINGBUFFER_SOURCE(PFX, SNAME, V)            \
+    CMC_GENERATE_RINGBUFFER_NUMERIC_HEADER(PFX, SNAME, V, S) \
+    CMC_GENERATE_RINGBUFFER_NUMERIC_SOURCE(PFX, SNAME, V, S)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_RINGBUFFER_HEADER(PFX, SNAME, V)                                       \
+                                                                                            \
+    /* RingBuffer Structure */                                                              \
+    struct SNAME                                                                            \
+    {                                                                                       \
+        /* Circular buffer aligned to a cache line */                                       \
+        V *buffer;                                                                          \
+                                                                                            \
+        /* Maximum amount of elements */                                                    \
+        size_t window;                                                                      \
+                                                                                            \
+        /* Power of two capacity of the buffer, at least window */                          \
+        size_t capacity;                                                                    \
+                                                                                            \
+        /* Current amount of elements */                                                    \
+        size_t count;                                                                       \
+                                                                                            \
+        /* Amount of pushes, the newest element is at head - 1 */                           \
+        size_t head;                                                                        \
+                                                                                            \
+        /* Custom allocation functions */                                                   \
+        struct cmc_alloc_node *alloc;                                                       \
+    };                                                                                      \
+                                                                                            \
+    /* RingBuffer Iterator */                                                               \
+    struct SNAME##_iter                                                                     \
+    {                                                                                       \
+        /* Target ring */                                                                   \
+        struct SNAME *target;                                                               \
+                                                                                            \
+        /* Position from the oldest element */                                              \
+        size_t cursor;                                                                      \
+                                                                                            \
+        /* If the iterator has reached the start of the iteration */                        \
+        bool start;                                                                         \
+                                                                                            \
+        /* If the iterator has reached the end of the iteration */                          \
+        bool end;                                                                           \
+    };                                                                                      \
+                                                                                            \
+    /* Collection Functions */                                                              \
+    /* Collection Allocation and Deallocation */                                            \
+    struct SNAME *PFX##_new(size_t window);                                                 \
+    struct SNAME *PFX##_new_custom(size_t window, struct cmc_alloc_node *alloc);            \
+    void PFX##_clear(struct SNAME *_ring_, void (*deallocator)(V));                         \
+    void PFX##_free(struct SNAME *_ring_, void (*deallocator)(V));                          \
+    /* Collection Input and Output */                                                       \
+    bool PFX##_push(struct SNAME *_ring_, V element, V *evicted);                           \
+    size_t PFX##_push_many(struct SNAME *_ring_, V *elements, size_t size);                 \
+    bool PFX##_pop_oldest(struct SNAME *_ring_);                                            \
+    /* Element Access */                                                                    \
+    V PFX##_get(struct SNAME *_ring_, size_t index);                                        \
+    V *PFX##_get_ref(struct SNAME *_ring_, size_t index);                                   \
+    V PFX##_get_newest(struct SNAME *_ring_, size_t index);                                 \
+    void PFX##_spans(struct SNAME *_ring_, V **a, size_t *a_count, V **b, size_t *b_count); \
+    void PFX##_newest_spans(struct SNAME *_ring_, size_t n, V **a, size_t *a_count, V **b,  \
+                            size_t *b_count);                                               \
+    /* Collection State */                                                                  \
+    CMC_PURE bool PFX##_empty(struct SNAME *_ring_);                                        \
+    bool PFX##_full(struct SNAME *_ring_);                                                  \
+    CMC_PURE size_t PFX##_count(struct SNAME *_ring_);                                      \
+    size_t PFX##_window(struct SNAME *_ring_);                                              \
+    size_t PFX##_pushed(struct SNAME *_ring_);                                              \
+    size_t PFX##_memory_usage(struct SNAME *_ring_);                                        \
+    /* Collection Utility */                                                                \
+    size_t PFX##_to_array(struct SNAME *_ring_, V *CMC_RESTRICT elements, size_t size);     \
+    struct cmc_string PFX##_to_string(struct SNAME *_ring_);                                \
+                                                                                            \
+    /* Iterator Functions */                                                                \
+    /* Iterator Allocation and Deallocation */                                              \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target);                              \
+    void PFX##_iter_free(struct SNAME##_iter *iter);                                        \
+    /* Iterator Initialization */                                                           \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);                  \
+    /* Iterator State */                                                                    \
+    bool PFX##_iter_start(struct SNAME##_iter *iter);                                       \
+    bool PFX##_iter_end(struct SNAME##_iter *iter);                                         \
+    /* Iterator Movement */                                                                 \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter);                                    \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter);                                      \
+    bool PFX##_iter_next(struct SNAME##_iter *iter);                                        \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter);                                        \
+    /* Iterator Access */                                                                   \
+    V PFX##_iter_value(struct SNAME##_iter *iter);                                          \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter);                                        \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter);
+
+#define CMC_GENERATE_RINGBUFFER_NUMERIC_HEADER(PFX, SNAME, V, S) \
+                                                                 \
+    S PFX##_sum(struct SNAME *_ring_, size_t n);                 \
+    double PFX##_mean(struct SNAME *_ring_, size_t n);           \
+    bool PFX##_min(struct SNAME *_ring_, size_t n, V *value);    \
+    bool PFX##_max(struct SNAME *_ring_, size_t n, V *value);    \
+                                                                 \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_RINGBUFFER_SOURCE(PFX, SNAME, V)                                              \
+                                                                                                   \
+    struct SNAME *PFX##_new(size_t window)                                                         \
+    {                                                                                              \
+        return PFX##_new_custom(window, NULL);                                                     \
+    }                                                                                              \
+                                                                                                   \
+    struct SNAME *PFX##_new_custom(size_t window, struct cmc_alloc_node *alloc)                    \
+    {                                                                                              \
+        if (!alloc)                                                                                \
+            alloc = &cmc_alloc_node_default;                                                       \
+                                                                                                   \
+        if (window < 1 || window > SIZE_MAX / 2 / sizeof(V))                                       \
+            return NULL;                                                                           \
+                                                                                                   \
+        size_t capacity = 1;                                                                       \
+                                                                                                   \
+        while (capacity < window)                                                                  \
+            capacity *= 2;                                                                         \
+                                                                                                   \
+        struct SNAME *_ring_ = alloc->malloc(sizeof(struct SNAME));                                \
+                                                                                                   \
+        if (CMC_UNLIKELY(!_ring_))                                                                 \
+            return NULL;                                                                           \
+                                                                                                   \
+        _ring_->buffer = cmc_alloc_aligned(alloc, CMC_CACHE_LINE_SIZE, capacity * sizeof(V));      \
+                                                                                                   \
+        if (CMC_UNLIKELY(!_ring_->buffer))                                                         \
+        {                                                                                          \
+            alloc->free(_ring_);                                                                   \
+            return NULL;                                                                           \
+        }                                                                                          \
+                                                                                                   \
+        _ring_->window = window;                                                                   \
+        _ring_->capacity = capacity;                                                               \
+        _ring_->count = 0;                                                                         \
+        _ring_->head = 0;                                                                          \
+        _ring_->alloc = alloc;                                                                     \
+                                                                                                   \
+        return _ring_;                                                                             \
+    }                                                                                              \
+                                                                                                   \
+    void PFX##_clear(struct SNAME *_ring_, void (*deallocator)(V))                                 \
+    {                                                                                              \
+        if (deallocator)                                                                           \
+        {                                                                                          \
+            for (size_t i = 0; i < _ring_->count; i++)                                             \
+                deallocator(PFX##_get(_ring_, i));                                                 \
+        }                                                                                          \
+                                                                                                   \
+        _ring_->count = 0;                                                                         \
+        _ring_->head = 0;                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    void PFX##_free(struct SNAME *_ring_, void (*deallocator)(V))                                  \
+    {                                                                                              \
+        PFX##_clear(_ring_, deallocator);                                                          \
+                                                                                                   \
+        cmc_alloc_aligned_free(_ring_->alloc, _ring_->buffer);                                     \
+        _ring_->alloc->free(_ring_);                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Returns true if the ring was full and its oldest element was */                             \
+    /* overwritten, which is then written to evicted if it is not NULL */                          \
+    bool PFX##_push(struct SNAME *_ring_, V element, V *evicted)                                   \
+    {                                                                                              \
+        size_t mask = _ring_->capacity - 1;                                                        \
+        bool full = _ring_->count == _ring_->window;                                               \
+                                                                                                   \
+        if (full && evicted)                                                                       \
+            *evicted = _ring_->buffer[(_ring_->head - _ring_->window) & mask];                     \
+                                                                                                   \
+        _ring_->buffer[_ring_->head & mask] = element;                                             \
+        _ring_->head++;                                                                            \
+                                                                                                   \
+        if (!full)                                                                                 \
+            _ring_->count++;                                                                       \
+                                                                                                   \
+        return full;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Pushes size elements with at most two copies and returns how many */                        \
+    /* were dropped, counting the oldest ones and those of elements that */                        \
+    /* did not fit in the window */                                                                \
+    size_t PFX##_push_many(struct SNAME *_ring_, V *elements, size_t size)                         \
+    {                                                                                              \
+        size_t mask = _ring_->capacity - 1;                                                        \
+        size_t total = _ring_->count + size;                                                       \
+        size_t evicted = total > _ring_->window ? total - _ring_->window : 0;                      \
+                                                                                                   \
+        if (size > _ring_->window)                                                                 \
+        {                                                                                          \
+            _ring_->head += size - _ring_->window;                                                 \
+            elements += size - _ring_->window;                                                     \
+            size = _ring_->window;                                                                 \
+        }                                                                                          \
+                                                                                                   \
+        size_t start = _ring_->head & mask;                                                        \
+        size_t first = _ring_->capacity - start;                                                   \
+                                                                                                   \
+        if (first > size)                                                                          \
+            first = size;                                                                          \
+                                                                                                   \
+        memcpy(_ring_->buffer + start, elements, first * sizeof(V));                               \
+        memcpy(_ring_->buffer, elements + first, (size - first) * sizeof(V));                      \
+                                                                                                   \
+        _ring_->head += size;                                                                      \
+        _ring_->count = total - evicted;                                                           \
+                                                                                                   \
+        return evicted;                                                                            \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_pop_oldest(struct SNAME *_ring_)                                                    \
+    {                                                                                              \
+        if (PFX##_empty(_ring_))                                                                   \
+            return false;                                                                          \
+                                                                                                   \
+        _ring_->count--;                                                                           \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Element at position index from the oldest one */                                            \
+    V PFX##_get(struct SNAME *_ring_, size_t index)                                                \
+    {                                                                                              \
+        if (index >= _ring_->count)                                                                \
+            return (V){0};                                                                         \
+                                                                                                   \
+        return _ring_->buffer[(_ring_->head - _ring_->count + index) & (_ring_->capacity - 1)];    \
+    }                                                                                              \
+                                                                                                   \
+    V *PFX##_get_ref(struct SNAME *_ring_, size_t index)                                           \
+    {                                                                                              \
+        if (index >= _ring_->count)                                                                \
+            return NULL;                                                                           \
+                                                                                                   \
+        return &(_ring_->buffer[(_ring_->head - _ring_->count + index) & (_ring_->capacity - 1)]); \
+    }                                                                                              \
+                                                                                                   \
+    /* Element at position index from the newest one, which is at 0 */                             \
+    V PFX##_get_newest(struct SNAME *_ring_, size_t index)                                         \
+    {                                                                                              \
+        if (index >= _ring_->count)                                                                \
+            return (V){0};                                                                         \
+                                                                                                   \
+        return _ring_->buffer[(_ring_->head - 1 - index) & (_ring_->capacity - 1)];                \
+    }                                                                                              \
+                                                                                                   \
+    /* The elements from the oldest to the newest are the a_count elements */                      \
+    /* at a followed by the b_count elements at b. The second span is empty */                     \
+    /* unless the elements wrap around the end of the buffer */                                    \
+    void PFX##_spans(struct SNAME *_ring_, V **a, size_t *a_count, V **b, size_t *b_count)         \
+    {                                                                                              \
+        PFX##_newest_spans(_ring_, _ring_->count, a, a_count, b, b_count);                         \
+    }                                                                                              \
+                                                                                                   \
+    /* Same as spans for the newest n elements, or all of them if there are */                     \
+    /* fewer than n */                                                                             \
+    void PFX##_newest_spans(struct SNAME *_ring_, size_t n, V **a, size_t *a_count, V **b,         \
+                            size_t *b_count)                                                       \
+    {                                                                                              \
+        if (n > _ring_->count)                                                                     \
+            n = _ring_->count;                                                                     \
+                                                                                                   \
+        size_t start = (_ring_->head - n) & (_ring_->capacity - 1);                                \
+        size_t first = _ring_->capacity - start;                                                   \
+                                                                                                   \
+        if (first > n)                                                                             \
+            first = n;                                                                             \
+                                                                                                   \
+        *a = _ring_->buffer + start;                                                               \
+        *a_count = first;                                                                          \
+        *b = _ring_->buffer;                                                                       \
+        *b_count = n - first;                                                                      \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_empty(struct SNAME *_ring_)                                                         \
+    {                                                                                              \
+        return _ring_->count == 0;                                                                 \
+    }                                                                                              \
+                                                                                                   \
+    /* When full each push overwrites the oldest element */                                        \
+    bool PFX##_full(struct SNAME *_ring_)                                                          \
+    {                                                                                              \
+        return _ring_->count == _ring_->window;                                                    \
+    }                                                                                              \
+                                                                                                   \
+    size_t PFX##_count(struct SNAME *_ring_)                                                       \
+    {                                                                                              \
+        return _ring_->count;                                                                      \
+    }                                                                                              \
+                                                                                                   \
+    size_t PFX##_window(struct SNAME *_ring_)                                                      \
+    {                                                                                              \
+        return _ring_->window;                                                                     \
+    }                                                                                              \
+                                                                                                   \
+    /* Amount of elements pushed since the ring was created or cleared */                          \
+    size_t PFX##_pushed(struct SNAME *_ring_)                                                      \
+    {                                                                                              \
+        return _ring_->head;                                                                       \
+    }                                                                                              \
+                                                                                                   \
+    size_t PFX##_memory_usage(struct SNAME *_ring_)                                                \
+    {                                                                                              \
+        return sizeof(struct SNAME) +                                                              \
+               cmc_alloc_aligned_size(CMC_CACHE_LINE_SIZE, _ring_->capacity * sizeof(V));          \
+    }                                                                                              \
+                                                                                                   \
+    /* Copies up to size elements, in the order that they are iterated, to */                      \
+    /* elements and returns how many were copied */                                                \
+    size_t PFX##_to_array(struct SNAME *_ring_, V *CMC_RESTRICT elements, size_t size)             \
+    {                                                                                              \
+        V *a, *b;                                                                                  \
+        size_t a_count, b_count;                                                                   \
+                                                                                                   \
+        PFX##_spans(_ring_, &a, &a_count, &b, &b_count);                                           \
+                                                                                                   \
+        if (size > _ring_->count)                                                                  \
+            size = _ring_->count;                                                                  \
+                                                                                                   \
+        if (a_count > size)                                                                        \
+            a_count = size;                                                                        \
+                                                                                                   \
+        memcpy(elements, a, a_count * sizeof(V));                                                  \
+        memcpy(elements + a_count, b, (size - a_count) * sizeof(V));                               \
+                                                                                                   \
+        return size;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    struct cmc_string PFX##_to_string(struct SNAME *_ring_)                                        \
+    {                                                                                              \
+        struct cmc_string str;                                                                     \
+        struct SNAME *r_ = _ring_;                                                                 \
+        const char *name = #SNAME;                                                                 \
+                                                                                                   \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_ringbuffer, name, r_, r_->buffer,           \
+                 r_->window, r_->capacity, r_->count, r_->head);                                   \
+                                                                                                   \
+        return str;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                      \
+    {                                                                                              \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));            \
+                                                                                                   \
+        if (CMC_UNLIKELY(!iter))                                                                   \
+            return NULL;                                                                           \
+                                                                                                   \
+        PFX##_iter_init(iter, target);                                                             \
+                                                                                                   \
+        return iter;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    void PFX##_iter_free(struct SNAME##_iter *iter)                                                \
+    {                                                                                              \
+        iter->target->alloc->free(iter);                                                           \
+    }                                                                                              \
+                                                                                                   \
+    /* Iterates from the oldest to the newest element */                                           \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                          \
+    {                                                                                              \
+        iter->target = target;                                                                     \
+        iter->cursor = 0;                                                                          \
+        iter->start = true;                                                                        \
+        iter->end = PFX##_empty(target);                                                           \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                               \
+    {                                                                                              \
+        return PFX##_empty(iter->target) || iter->start;                                           \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                                 \
+    {                                                                                              \
+        return PFX##_empty(iter->target) || iter->end;                                             \
+    }                                                                                              \
+                                                                                                   \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                            \
+    {                                                                                              \
+        if (!PFX##_empty(iter->target))                                                            \
+        {                                                                                          \
+            iter->cursor = 0;                                                                      \
+            iter->start = true;                                                                    \
+            iter->end = false;                                                                     \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                              \
+    {                                                                                              \
+        if (!PFX##_empty(iter->target))                                                            \
+        {                                                                                          \
+            iter->cursor = iter->target->count - 1;                                                \
+            iter->start = false;                                                                   \
+            iter->end = true;                                                                      \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                                \
+    {                                                                                              \
+        if (iter->end)                                                                             \
+            return false;                                                                          \
+                                                                                                   \
+        if (iter->cursor + 1 == iter->target->count)                                               \
+        {                                                                                          \
+            iter->end = true;                                                                      \
+            return false;                                                                          \
+        }                                                                                          \
+                                                                                                   \
+        iter->start = false;                                                                       \
+        iter->cursor++;                                                                            \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                                \
+    {                                                                                              \
+        if (iter->start)                                                                           \
+            return false;                                                                          \
+                                                                                                   \
+        if (iter->cursor == 0)                                                                     \
+        {                                                                                          \
+            iter->start = true;                                                                    \
+            return false;                                                                          \
+        }                                                                                          \
+                                                                                                   \
+        iter->end = false;                                                                         \
+        iter->cursor--;                                                                            \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                                  \
+    {                                                                                              \
+        return PFX##_get(iter->target, iter->cursor);                                              \
+    }                                                                                              \
+                                                                                                   \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter)                                                \
+    {                                                                                              \
+        return PFX##_get_ref(iter->target, iter->cursor);                                          \
+    }                                                                                              \
+                                                                                                   \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                             \
+    {                                                                                              \
+        return iter->cursor;                                                                       \
+    }
+
+#define CMC_GENERATE_RINGBUFFER_NUMERIC_SOURCE(PFX, SNAME, V, S)                       \
+                                                                                       \
+    /* Each span is reduced by four independent accumulators, so that no */            \
+    /* iteration waits for the previous one */                                         \
+    static S PFX##_impl_sum_span(const V *values, size_t count)                        \
+    {                                                                                  \
+        S s0 = 0, s1 = 0, s2 = 0, s3 = 0;                                              \
+        size_t i = 0;                                                                  \
+                                                                                       \
+        for (; i + 4 <= count; i += 4)                                                 \
+        {                                                                              \
+            s0 += (S)values[i];                                                        \
+            s1 += (S)values[i + 1];                                                    \
+            s2 += (S)values[i + 2];                                                    \
+            s3 += (S)values[i + 3];                                                    \
+        }                                                                              \
+                                                                                       \
+        for (; i < count; i++)                                                         \
+            s0 += (S)values[i];                                                        \
+                                                                                       \
+        return (s0 + s1) + (s2 + s3);                                                  \
+    }                                                                                  \
+                                                                                       \
+    /* Finds the minimum, or the maximum if max, of a non-empty span */                \
+    static V PFX##_impl_extreme_span(const V *values, size_t count, bool max)          \
+    {                                                                                  \
+        V m0 = values[0], m1 = values[0], m2 = values[0], m3 = values[0];              \
+        size_t i = 0;                                                                  \
+                                                                                       \
+        if (max)                                                                       \
+        {                                                                              \
+            for (; i + 4 <= count; i += 4)                                             \
+            {                                                                          \
+                m0 = values[i] > m0 ? values[i] : m0;                                  \
+                m1 = values[i + 1] > m1 ? values[i + 1] : m1;                          \
+                m2 = values[i + 2] > m2 ? values[i + 2] : m2;                          \
+                m3 = values[i + 3] > m3 ? values[i + 3] : m3;                          \
+            }                                                                          \
+                                                                                       \
+            for (; i < count; i++)                                                     \
+                m0 = values[i] > m0 ? values[i] : m0;                                  \
+                                                                                       \
+            m0 = m1 > m0 ? m1 : m0;                                                    \
+            m2 = m3 > m2 ? m3 : m2;                                                    \
+                                                                                       \
+            return m2 > m0 ? m2 : m0;                                                  \
+        }                                                                              \
+                                                                                       \
+        for (; i + 4 <= count; i += 4)                                                 \
+        {                                                                              \
+            m0 = values[i] < m0 ? values[i] : m0;                                      \
+            m1 = values[i + 1] < m1 ? values[i + 1] : m1;                              \
+            m2 = values[i + 2] < m2 ? values[i + 2] : m2;                              \
+            m3 = values[i + 3] < m3 ? values[i + 3] : m3;                              \
+        }                                                                              \
+                                                                                       \
+        for (; i < count; i++)                                                         \
+            m0 = values[i] < m0 ? values[i] : m0;                                      \
+                                                                                       \
+        m0 = m1 < m0 ? m1 : m0;                                                        \
+        m2 = m3 < m2 ? m3 : m2;                                                        \
+                                                                                       \
+        return m2 < m0 ? m2 : m0;                                                      \
+    }                                                                                  \
+                                                                                       \
+    static bool PFX##_impl_extreme(struct SNAME *_ring_, size_t n, V *value, bool max) \
+    {                                                                                  \
+        V *a, *b;                                                                      \
+        size_t a_count, b_count;                                                       \
+                                                                                       \
+        PFX##_newest_spans(_ring_, n, &a, &a_count, &b, &b_count);                     \
+                                                                                       \
+        if (a_count == 0)                                                              \
+            return false;                                                              \
+                                                                                       \
+        V result = PFX##_impl_extreme_span(a, a_count, max);                           \
+                                                                                       \
+        if (b_count > 0)                                                               \
+        {                                                                              \
+            V other = PFX##_impl_extreme_span(b, b_count, max);                        \
+                                                                                       \
+            if (max ? other > result : other < result)                                 \
+                result = other;                                                        \
+        }                                                                              \
+                                                                                       \
+        *value = result;                                                               \
+                                                                                       \
+        return true;                                                                   \
+    }                                                                                  \
+                                                                                       \
+    /* Sum of the newest n elements, or of all of them if there are fewer */           \
+    S PFX##_sum(struct SNAME *_ring_, size_t n)                                        \
+    {                                                                                  \
+        V *a, *b;                                                                      \
+        size_t a_count, b_count;                                                       \
+                                                                                       \
+        PFX##_newest_spans(_ring_, n, &a, &a_count, &b, &b_count);                     \
+                                                                                       \
+        return PFX##_impl_sum_span(a, a_count) + PFX##_impl_sum_span(b, b_count);      \
+    }                                                                                  \
+                                                                                       \
+    /* Mean of the newest n elements, 0 if the ring is empty */                        \
+    double PFX##_mean(struct SNAME *_ring_, size_t n)                                  \
+    {                                                                                  \
+        if (n > _ring_->count)                                                         \
+            n = _ring_->count;                                                         \
+                                                                                       \
+        if (n == 0)                                                                    \
+            return 0.0;                                                                \
+                                                                                       \
+        return (double)PFX##_sum(_ring_, n) / (double)n;                               \
+    }                                                                                  \
+                                                                                       \
+    /* Minimum of the newest n elements, false if the ring is empty */                 \
+    bool PFX##_min(struct SNAME *_ring_, size_t n, V *value)                           \
+    {                                                                                  \
+        return PFX##_impl_extreme(_ring_, n, value, false);                            \
+    }                                                                                  \
+                                                                                       \
+    /* Maximum of the newest n elements, false if the ring is empty */                 \
+    bool PFX##_max(struct SNAME *_ring_, size_t n, V *value)                           \
+    {                                                                                  \
+        return PFX##_impl_extreme(_ring_, n, value, true);                             \
+    }
+
+#endif /* CMC_RINGBUFFER_H */
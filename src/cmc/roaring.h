@@ -0,0 +1,1813 @@
+/**
+ * roaring.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * Roaring
+ *
+ * A Roaring bitmap is a Set of 32 bit unsigned integers that takes little
+ * memory whether its elements are sparse, dense or in long sequences. It
+ * has the same functions as the HashSet and the BitSet, including their set
+ * operations, and can be saved and restored like every other collection.
+ *
+ * Elements of type V are converted to uint32_t, so V must be an unsigned
+ * integer type and elements above UINT32_MAX can't be inserted.
+ *
+ * Implementation
+ *
+ * Elements are split by their upper 16 bits into chunks of 65536 values.
+ * Each chunk that has elements has a container, kept in an array sorted by
+ * chunk, that holds the lower 16 bits of its elements as either:
+ *
+ * - ARRAY: a sorted array of up to 4096 elements of 2 bytes
+ * - BITMAP: 65536 bits (8 KB), for chunks with more than 4096 elements
+ * - RUN: a sorted array of runs of consecutive elements, 4 bytes per run
+ *
+ * Inserting and removing keep a container as an ARRAY or a BITMAP, turning
+ * one into the other as it crosses 4096 elements, and RUN containers are
+ * turned into one of them when they are modified. PFX##_run_optimize turns
+ * each container into a RUN where that is smaller, which is best done once
+ * the set is built. Set operations between two ARRAY containers merge them
+ * and ARRAY containers are filtered by the other container for the
+ * intersection and the difference. Every other pair of containers is
+ * combined as bitmaps, with the word operations of utl/cmc_bits.h.
+ */
+
+#ifndef CMC_ROARING_H
+#define CMC_ROARING_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_bits.h"
+#include "../utl/cmc_math.h"
+#include "../utl/cmc_serial.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_roaring = "%s at %p { containers:%p, length:%" PRIuMAX ", capacity:%" PRIuMAX ", count:%" PRIuMAX " }";
+
+/* Bitmap containers are aligned to this size */
+#ifndef CMC_CACHE_LINE_SIZE
+#define CMC_CACHE_LINE_SIZE 64
+#endif
+
+#ifndef CMC_IMPL_ROARING_CONTAINERS
+#define CMC_IMPL_ROARING_CONTAINERS
+
+/* Types of containers */
+#define CMC_ROARING_ARRAY 0
+#define CMC_ROARING_BITMAP 1
+#define CMC_ROARING_RUN 2
+
+/* Most elements of an ARRAY container, as many bytes as a BITMAP */
+#define CMC_ROARING_ARRAY_MAX 4096
+
+/* A BITMAP container becomes an ARRAY only when a removal leaves it with */
+/* this many elements, so that elements inserted and removed right at the */
+/* limit don't turn it back and forth */
+#define CMC_ROARING_ARRAY_LOW (CMC_ROARING_ARRAY_MAX / 2)
+
+#define CMC_ROARING_BITMAP_WORDS 1024
+
+/* Elements from start to start + length, inclusive */
+struct cmc_roaring_run
+{
+    uint16_t start;
+    uint16_t length;
+};
+
+struct cmc_roaring_container
+{
+    /* Upper 16 bits of its elements */
+    uint16_t key;
+
+    /* CMC_ROARING_ARRAY, BITMAP or RUN */
+    uint16_t type;
+
+    /* Amount of elements, from 1 to 65536 */
+    uint32_t cardinality;
+
+    /* Amount of runs of a RUN container */
+    uint32_t runs;
+
+    /* Elements of an ARRAY or runs of a RUN that fit without growing */
+    uint32_t capacity;
+
+    union
+    {
+        uint16_t *array;
+        uint64_t *bitmap;
+        struct cmc_roaring_run *run;
+    } data;
+};
+
+/* A container as it is saved, followed by its array, bitmap or runs */
+struct cmc_roaring_serial
+{
+    uint16_t key;
+    uint16_t type;
+    uint32_t cardinality;
+    uint32_t runs;
+    uint32_t reserved;
+};
+
+/* First position of array whose element is not less than value */
+static inline uint32_t cmc_roaring_lower_bound(const uint16_t *array, uint32_t count,
+                                               uint16_t value)
+{
+    uint32_t low = 0, high = count;
+
+    while (low < high)
+    {
+        uint32_t mid = low + (high - low) / 2;
+
+        if (array[mid] < value)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return low;
+}
+
+/* Amount of runs whose start is not greater than value, so the run that */
+/* could have value is the one before that */
+static inline uint32_t cmc_roaring_run_upper(const struct cmc_roaring_run *run, uint32_t runs,
+                                             uint16_t value)
+{
+    uint32_t low = 0, high = runs;
+
+    while (low < high)
+    {
+        uint32_t mid = low + (high - low) / 2;
+
+        if (run[mid].start <= value)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return low;
+}
+
+static inline bool cmc_roaring_container_contains(const struct cmc_roaring_container *c,
+                                                  uint16_t value)
+{
+    if (c->type == CMC_ROARING_BITMAP)
+        return (c->data.bitmap[value / 64] >> (value % 64)) & 1;
+
+    if (c->type == CMC_ROARING_ARRAY)
+    {
+        uint32_t i = cmc_roaring_lower_bound(c->data.array, c->cardinality, value);
+
+        return i < c->cardinality && c->data.array[i] == value;
+    }
+
+    uint32_t r = cmc_roaring_run_upper(c->data.run, c->runs, value);
+
+    return r > 0 && value - c->data.run[r - 1].start <= c->data.run[r - 1].length;
+}
+
+/* Sets the bits from start to end, inclusive */
+static inline void cmc_roaring_words_fill(uint64_t *words, uint32_t start, uint32_t end)
+{
+    uint32_t first = start / 64, last = end / 64;
+    uint64_t head = ~UINT64_C(0) << (start % 64);
+    uint64_t tail = ~UINT64_C(0) >> (63 - end % 64);
+
+    if (first == last)
+    {
+        words[first] |= head & tail;
+        return;
+    }
+
+    words[first] |= head;
+
+    for (uint32_t w = first + 1; w < last; w++)
+        words[w] = ~UINT64_C(0);
+
+    words[last] |= tail;
+}
+
+/* Writes the elements of a container as CMC_ROARING_BITMAP_WORDS words */
+static inline void cmc_roaring_to_words(const struct cmc_roaring_container *c, uint64_t *words)
+{
+    if (c->type == CMC_ROARING_BITMAP)
+    {
+        memcpy(words, c->data.bitmap, CMC_ROARING_BITMAP_WORDS * sizeof(uint64_t));
+        return;
+    }
+
+    memset(words, 0, CMC_ROARING_BITMAP_WORDS * sizeof(uint64_t));
+
+    if (c->type == CMC_ROARING_ARRAY)
+    {
+        for (uint32_t i = 0; i < c->cardinality; i++)
+            words[c->data.array[i] / 64] |= UINT64_C(1) << (c->data.array[i] % 64);
+    }
+    else
+    {
+        for (uint32_t r = 0; r < c->runs; r++)
+            cmc_roaring_words_fill(words, c->data.run[r].start,
+                                   (uint32_t)c->data.run[r].start + c->data.run[r].length);
+    }
+}
+
+/* Writes the elements of a bitmap to array in increasing order */
+static inline void cmc_roaring_words_to_array(const uint64_t *words, uint16_t *array)
+{
+    uint32_t n = 0;
+
+    for (uint32_t w = 0; w < CMC_ROARING_BITMAP_WORDS; w++)
+    {
+        uint64_t word = words[w];
+
+        while (word)
+        {
+            array[n++] = (uint16_t)(w * 64 + cmc_math_ctz(word));
+            word &= word - 1;
+        }
+    }
+}
+
+/* Bytes taken by the elements of a container with each type */
+static inline size_t cmc_roaring_bytes(uint16_t type, uint32_t cardinality, uint32_t runs)
+{
+    if (type == CMC_ROARING_BITMAP)
+        return CMC_ROARING_BITMAP_WORDS * sizeof(uint64_t);
+    else if (type == CMC_ROARING_ARRAY)
+        return cardinality * sizeof(uint16_t);
+    else
+        return runs * sizeof(struct cmc_roaring_run);
+}
+
+static inline void cmc_roaring_container_free(struct cmc_alloc_node *alloc,
+                                              struct cmc_roaring_container *c)
+{
+    if (c->type == CMC_ROARING_BITMAP)
+        cmc_alloc_aligned_free(alloc, c->data.bitmap);
+    else
+        alloc->free(c->type == CMC_ROARING_ARRAY ? (void *)c->data.array : (void *)c->data.run);
+}
+
+/* Makes c a container of the cardinality elements of words, which can't */
+/* be 0, as an ARRAY if they fit and as a BITMAP otherwise */
+static inline bool cmc_roaring_from_words(struct cmc_alloc_node *alloc, const uint64_t *words,
+                                          uint32_t cardinality, struct cmc_roaring_container *c)
+{
+    c->cardinality = cardinality;
+    c->runs = 0;
+
+    if (cardinality > CMC_ROARING_ARRAY_MAX)
+    {
+        c->type = CMC_ROARING_BITMAP;
+        c->capacity = 0;
+        c->data.bitmap = cmc_alloc_aligned(alloc, CMC_CACHE_LINE_SIZE,
+                                           CMC_ROARING_BITMAP_WORDS * sizeof(uint64_t));
+
+        if (CMC_UNLIKELY(!c->data.bitmap))
+            return false;
+
+        memcpy(c->data.bitmap, words, CMC_ROARING_BITMAP_WORDS * sizeof(uint64_t));
+
+        return true;
+    }
+
+    c->type = CMC_ROARING_ARRAY;
+    c->capacity = cardinality;
+    c->data.array = alloc->malloc(cardinality * sizeof(uint16_t));
+
+    if (CMC_UNLIKELY(!c->data.array))
+        return false;
+
+    cmc_roaring_words_to_array(words, c->data.array);
+
+    return true;
+}
+
+/* Turns a container into an ARRAY or a BITMAP, given by type */
+static inline bool cmc_roaring_container_convert(struct cmc_alloc_node *alloc,
+                                                 struct cmc_roaring_container *c, uint16_t type)
+{
+    uint64_t words[CMC_ROARING_BITMAP_WORDS];
+    struct cmc_roaring_container result = *c;
+
+    if (c->type == type)
+        return true;
+
+    cmc_roaring_to_words(c, words);
+
+    result.type = type;
+    result.runs = 0;
+
+    if (type == CMC_ROARING_BITMAP)
+    {
+        result.capacity = 0;
+        result.data.bitmap = cmc_alloc_aligned(alloc, CMC_CACHE_LINE_SIZE, sizeof(words));
+
+        if (CMC_UNLIKELY(!result.data.bitmap))
+            return false;
+
+        memcpy(result.data.bitmap, words, sizeof(words));
+    }
+    else
+    {
+        result.capacity = c->cardinality;
+        result.data.array = alloc->malloc(c->cardinality * sizeof(uint16_t));
+
+        if (CMC_UNLIKELY(!result.data.array))
+            return false;
+
+        cmc_roaring_words_to_array(words, result.data.array);
+    }
+
+    cmc_roaring_container_free(alloc, c);
+
+    *c = result;
+
+    return true;
+}
+
+/* Turns a RUN container into the smallest of an ARRAY and a BITMAP */
+static inline bool cmc_roaring_container_plain(struct cmc_alloc_node *alloc,
+                                               struct cmc_roaring_container *c)
+{
+    if (c->type != CMC_ROARING_RUN)
+        return true;
+
+    return cmc_roaring_container_convert(alloc, c,
+                                         c->cardinality > CMC_ROARING_ARRAY_MAX
+                                             ? CMC_ROARING_BITMAP
+                                             : CMC_ROARING_ARRAY);
+}
+
+/* Returns 1 if value was inserted, 0 if it was already there and -1 if */
+/* the container could not grow */
+static inline int cmc_roaring_container_insert(struct cmc_alloc_node *alloc,
+                                               struct cmc_roaring_container *c, uint16_t value)
+{
+    if (c->type == CMC_ROARING_RUN)
+    {
+        if (cmc_roaring_container_contains(c, value))
+            return 0;
+
+        if (!cmc_roaring_container_plain(alloc, c))
+            return -1;
+    }
+
+    if (c->type == CMC_ROARING_ARRAY)
+    {
+        uint32_t i = cmc_roaring_lower_bound(c->data.array, c->cardinality, value);
+
+        if (i < c->cardinality && c->data.array[i] == value)
+            return 0;
+
+        if (c->cardinality == CMC_ROARING_ARRAY_MAX)
+        {
+            if (!cmc_roaring_container_convert(alloc, c, CMC_ROARING_BITMAP))
+                return -1;
+        }
+        else
+        {
+            if (c->cardinality == c->capacity)
+            {
+                uint32_t capacity = c->capacity < 2 ? 4 : c->capacity * 2;
+
+                if (capacity > CMC_ROARING_ARRAY_MAX)
+                    capacity = CMC_ROARING_ARRAY_MAX;
+
+                uint16_t *array = alloc->realloc(c->data.array, capacity * sizeof(uint16_t));
+
+                if (CMC_UNLIKELY(!array))
+                    return -1;
+
+                c->data.array = array;
+                c->capacity = capacity;
+            }
+
+            memmove(c->data.array + i + 1, c->data.array + i,
+                    (c->cardinality - i) * sizeof(uint16_t));
+
+            c->data.array[i] = value;
+            c->cardinality++;
+
+            return 1;
+        }
+    }
+
+    uint64_t mask = UINT64_C(1) << (value % 64);
+
+    if (c->data.bitmap[value / 64] & mask)
+        return 0;
+
+    c->data.bitmap[value / 64] |= mask;
+    c->cardinality++;
+
+    return 1;
+}
+
+/* Returns 1 if value was removed, 0 if it was not there and -1 if the */
+/* container had to change and could not. The container is left empty */
+/* when the last element is removed, to be freed by the caller */
+static inline int cmc_roaring_container_remove(struct cmc_alloc_node *alloc,
+                                               struct cmc_roaring_container *c, uint16_t value)
+{
+    if (!cmc_roaring_container_contains(c, value))
+        return 0;
+
+    if (c->cardinality == 1)
+    {
+        c->cardinality = 0;
+        return 1;
+    }
+
+    if (!cmc_roaring_container_plain(alloc, c))
+        return -1;
+
+    if (c->type == CMC_ROARING_ARRAY)
+    {
+        uint32_t i = cmc_roaring_lower_bound(c->data.array, c->cardinality, value);
+
+        memmove(c->data.array + i, c->data.array + i + 1,
+                (c->cardinality - i - 1) * sizeof(uint16_t));
+
+        c->cardinality--;
+
+        return 1;
+    }
+
+    c->data.bitmap[value / 64] &= ~(UINT64_C(1) << (value % 64));
+    c->cardinality--;
+
+    /* If the array can't be allocated the bitmap is still valid */
+    if (c->cardinality == CMC_ROARING_ARRAY_LOW)
+        cmc_roaring_container_convert(alloc, c, CMC_ROARING_ARRAY);
+
+    return 1;
+}
+
+/* Copies the elements of src to a new container at dst */
+static inline bool cmc_roaring_container_copy(struct cmc_alloc_node *alloc,
+                                              const struct cmc_roaring_container *src,
+                                              struct cmc_roaring_container *dst)
+{
+    size_t bytes = cmc_roaring_bytes(src->type, src->cardinality, src->runs);
+    void *data;
+
+    if (src->type == CMC_ROARING_BITMAP)
+        data = cmc_alloc_aligned(alloc, CMC_CACHE_LINE_SIZE, bytes);
+    else
+        data = alloc->malloc(bytes > 0 ? bytes : 1);
+
+    if (CMC_UNLIKELY(!data))
+        return false;
+
+    memcpy(data, src->type == CMC_ROARING_BITMAP ? (void *)src->data.bitmap
+                                                 : src->type == CMC_ROARING_ARRAY
+                                                       ? (void *)src->data.array
+                                                       : (void *)src->data.run,
+           bytes);
+
+    *dst = *src;
+    dst->capacity = src->type == CMC_ROARING_ARRAY ? src->cardinality : src->runs;
+
+    if (src->type == CMC_ROARING_BITMAP)
+        dst->data.bitmap = data;
+    else if (src->type == CMC_ROARING_ARRAY)
+        dst->data.array = data;
+    else
+        dst->data.run = data;
+
+    return true;
+}
+
+/* Smallest element not less than from, or -1 if there is none */
+static inline int32_t cmc_roaring_container_next(const struct cmc_roaring_container *c,
+                                                 uint32_t from)
+{
+    if (from > UINT16_MAX)
+        return -1;
+
+    if (c->type == CMC_ROARING_ARRAY)
+    {
+        uint32_t i = cmc_roaring_lower_bound(c->data.array, c->cardinality, (uint16_t)from);
+
+        return i < c->cardinality ? c->data.array[i] : -1;
+    }
+
+    if (c->type == CMC_ROARING_RUN)
+    {
+        uint32_t r = cmc_roaring_run_upper(c->data.run, c->runs, (uint16_t)from);
+
+        if (r > 0 && from - c->data.run[r - 1].start <= c->data.run[r - 1].length)
+            return (int32_t)from;
+
+        return r < c->runs ? c->data.run[r].start : -1;
+    }
+
+    uint32_t w = from / 64;
+    uint64_t word = c->data.bitmap[w] & (~UINT64_C(0) << (from % 64));
+
+    while (word == 0)
+    {
+        if (++w == CMC_ROARING_BITMAP_WORDS)
+            return -1;
+
+        word = c->data.bitmap[w];
+    }
+
+    return (int32_t)(w * 64 + cmc_math_ctz(word));
+}
+
+/* Largest element not greater than from, or -1 if there is none */
+static inline int32_t cmc_roaring_container_prev(const struct cmc_roaring_container *c,
+                                                 uint16_t from)
+{
+    if (c->type == CMC_ROARING_ARRAY)
+    {
+        uint32_t i = cmc_roaring_lower_bound(c->data.array, c->cardinality, from);
+
+        if (i < c->cardinality && c->data.array[i] == from)
+            return from;
+
+        return i > 0 ? c->data.array[i - 1] : -1;
+    }
+
+    if (c->type == CMC_ROARING_RUN)
+    {
+        uint32_t r = cmc_roaring_run_upper(c->data.run, c->runs, from);
+
+        if (r == 0)
+            return -1;
+
+        uint32_t end = (uint32_t)c->data.run[r - 1].start + c->data.run[r - 1].length;
+
+        return (int32_t)(from < end ? from : end);
+    }
+
+    uint32_t w = from / 64;
+    uint64_t word = c->data.bitmap[w] & (~UINT64_C(0) >> (63 - from % 64));
+
+    while (word == 0)
+    {
+        if (w-- == 0)
+            return -1;
+
+        word = c->data.bitmap[w];
+    }
+
+    return (int32_t)(w * 64 + 63 - cmc_math_clz(word));
+}
+
+/* Amount of runs of consecutive elements of an ARRAY or a BITMAP */
+static inline uint32_t cmc_roaring_count_runs(const struct cmc_roaring_container *c)
+{
+    uint32_t runs = 0;
+
+    if (c->type == CMC_ROARING_RUN)
+        return c->runs;
+
+    if (c->type == CMC_ROARING_ARRAY)
+    {
+        for (uint32_t i = 0; i < c->cardinality; i++)
+        {
+            if (i == 0 || c->data.array[i] != c->data.array[i - 1] + 1)
+                runs++;
+        }
+
+        return runs;
+    }
+
+    /* A run starts at every bit set whose previous bit is not set */
+    for (uint32_t w = 0; w < CMC_ROARING_BITMAP_WORDS; w++)
+    {
+        uint64_t word = c->data.bitmap[w];
+        uint64_t previous = (word << 1) | (w > 0 ? c->data.bitmap[w - 1] >> 63 : 0);
+
+        runs += (uint32_t)cmc_math_popcount(word & ~previous);
+    }
+
+    return runs;
+}
+
+/* Turns a container into a RUN if that takes less memory, or into the */
+/* smallest of an ARRAY and a BITMAP if it is a RUN that is not the smallest */
+static inline bool cmc_roaring_container_optimize(struct cmc_alloc_node *alloc,
+                                                  struct cmc_roaring_container *c)
+{
+    uint32_t runs = cmc_roaring_count_runs(c);
+    uint16_t plain =
+        c->cardinality > CMC_ROARING_ARRAY_MAX ? CMC_ROARING_BITMAP : CMC_ROARING_ARRAY;
+
+    size_t run_bytes = cmc_roaring_bytes(CMC_ROARING_RUN, c->cardinality, runs);
+    size_t plain_bytes = cmc_roaring_bytes(plain, c->cardinality, 0);
+
+    if (c->type == CMC_ROARING_RUN)
+        return run_bytes <= plain_bytes || cmc_roaring_container_plain(alloc, c);
+
+    if (run_bytes >= plain_bytes)
+        return true;
+
+    struct cmc_roaring_run *run = alloc->malloc(runs * sizeof(struct cmc_roaring_run));
+
+    if (CMC_UNLIKELY(!run))
+        return false;
+
+    uint32_t r = 0;
+    int32_t value = -1;
+
+    /* Goes through every element, extending the last run or starting one */
+    while ((value = cmc_roaring_container_next(c, (uint32_t)(value + 1))) >= 0)
+    {
+        if (r > 0 && run[r - 1].start + run[r - 1].length + 1 == value)
+            run[r - 1].length++;
+        else
+        {
+            run[r].start = (uint16_t)value;
+            run[r].length = 0;
+            r++;
+        }
+
+        if (value == UINT16_MAX)
+            break;
+    }
+
+    cmc_roaring_container_free(alloc, c);
+
+    c->type = CMC_ROARING_RUN;
+    c->runs = runs;
+    c->capacity = runs;
+    c->data.run = run;
+
+    return true;
+}
+
+/* Merges two ARRAY containers into result, whose cardinality is left as */
+/* 0 if it has no elements */
+static inline bool cmc_roaring_array_op(struct cmc_alloc_node *alloc,
+                                        const struct cmc_roaring_container *a,
+                                        const struct cmc_roaring_container *b,
+                                        enum cmc_bits_op op, struct cmc_roaring_container *result)
+{
+    const uint16_t *x = a->data.array, *y = b->data.array;
+    uint32_t n = a->cardinality, m = b->cardinality;
+    uint32_t i = 0, j = 0, k = 0;
+
+    bool only_a = op != CMC_BITS_AND;
+    bool only_b = op == CMC_BITS_OR || op == CMC_BITS_XOR;
+    bool both = op == CMC_BITS_OR || op == CMC_BITS_AND;
+
+    uint16_t *out = alloc->malloc((only_b ? n + m : n) * sizeof(uint16_t));
+
+    if (CMC_UNLIKELY(!out))
+        return false;
+
+    while (i < n && j < m)
+    {
+        if (x[i] < y[j])
+        {
+            if (only_a)
+                out[k++] = x[i];
+            i++;
+        }
+        else if (x[i] > y[j])
+        {
+            if (only_b)
+                out[k++] = y[j];
+            j++;
+        }
+        else
+        {
+            if (both)
+                out[k++] = x[i];
+            i++;
+            j++;
+        }
+    }
+
+    for (; only_a && i < n; i++)
+        out[k++] = x[i];
+
+    for (; only_b && j < m; j++)
+        out[k++] = y[j];
+
+    result->type = CMC_ROARING_ARRAY;
+    result->cardinality = k;
+    result->runs = 0;
+    result->capacity = only_b ? n + m : n;
+    result->data.array = out;
+
+    if (k == 0)
+        alloc->free(out);
+    else if (k > CMC_ROARING_ARRAY_MAX &&
+             !cmc_roaring_container_convert(alloc, result, CMC_ROARING_BITMAP))
+    {
+        alloc->free(out);
+        return false;
+    }
+
+    return true;
+}
+
+/* Sets result to a op b, for two containers of the same key. The */
+/* cardinality of result is 0 if it has no elements, and then nothing was */
+/* allocated for it */
+static inline bool cmc_roaring_container_op(struct cmc_alloc_node *alloc,
+                                            const struct cmc_roaring_container *a,
+                                            const struct cmc_roaring_container *b,
+                                            enum cmc_bits_op op,
+                                            struct cmc_roaring_container *result)
+{
+    result->key = a->key;
+    result->cardinality = 0;
+
+    if (a->type == CMC_ROARING_ARRAY && b->type == CMC_ROARING_ARRAY)
+        return cmc_roaring_array_op(alloc, a, b, op, result);
+
+    /* The result is never bigger than a, so a is filtered by b */
+    if (a->type == CMC_ROARING_ARRAY && (op == CMC_BITS_AND || op == CMC_BITS_ANDNOT))
+    {
+        uint16_t *out = alloc->malloc(a->cardinality * sizeof(uint16_t));
+        uint32_t k = 0;
+
+        if (CMC_UNLIKELY(!out))
+            return false;
+
+        for (uint32_t i = 0; i < a->cardinality; i++)
+        {
+            if (cmc_roaring_container_contains(b, a->data.array[i]) == (op == CMC_BITS_AND))
+                out[k++] = a->data.array[i];
+        }
+
+        if (k == 0)
+        {
+            alloc->free(out);
+            return true;
+        }
+
+        result->type = CMC_ROARING_ARRAY;
+        result->cardinality = k;
+        result->runs = 0;
+        result->capacity = a->cardinality;
+        result->data.array = out;
+
+        return true;
+    }
+
+    /* The intersection with an ARRAY b is b filtered by a */
+    if (b->type == CMC_ROARING_ARRAY && op == CMC_BITS_AND)
+        return cmc_roaring_container_op(alloc, b, a, op, result);
+
+    uint64_t words_a[CMC_ROARING_BITMAP_WORDS];
+    uint64_t words_b[CMC_ROARING_BITMAP_WORDS];
+    const uint64_t *x = a->data.bitmap, *y = b->data.bitmap;
+
+    if (a->type != CMC_ROARING_BITMAP)
+    {
+        cmc_roaring_to_words(a, words_a);
+        x = words_a;
+    }
+
+    if (b->type != CMC_ROARING_BITMAP)
+    {
+        cmc_roaring_to_words(b, words_b);
+        y = words_b;
+    }
+
+    uint32_t cardinality =
+        (uint32_t)cmc_bits_apply(words_a, x, y, CMC_ROARING_BITMAP_WORDS, op);
+
+    if (cardinality == 0)
+        return true;
+
+    return cmc_roaring_from_words(alloc, words_a, cardinality, result);
+}
+
+/* Amount of elements that two containers of the same key have in common */
+static inline uint32_t cmc_roaring_container_and_count(const struct cmc_roaring_container *a,
+                                                       const struct cmc_roaring_container *b)
+{
+    uint32_t count = 0;
+
+    if (a->type != CMC_ROARING_ARRAY && b->type == CMC_ROARING_ARRAY)
+        return cmc_roaring_container_and_count(b, a);
+
+    if (a->type == CMC_ROARING_ARRAY)
+    {
+        for (uint32_t i = 0; i < a->cardinality; i++)
+            count += cmc_roaring_container_contains(b, a->data.array[i]);
+
+        return count;
+    }
+
+    uint64_t words_a[CMC_ROARING_BITMAP_WORDS];
+    uint64_t words_b[CMC_ROARING_BITMAP_WORDS];
+    const uint64_t *x = a->data.bitmap, *y = b->data.bitmap;
+
+    if (a->type != CMC_ROARING_BITMAP)
+    {
+        cmc_roaring_to_words(a, words_a);
+        x = words_a;
+    }
+
+    if (b->type != CMC_ROARING_BITMAP)
+    {
+        cmc_roaring_to_words(b, words_b);
+        y = words_b;
+    }
+
+    for (uint32_t w = 0; w < CMC_ROARING_BITMAP_WORDS; w++)
+        count += (uint32_t)cmc_math_popcount(x[w] & y[w]);
+
+    return count;
+}
+
+#endif /* CMC_IMPL_ROARING_CONTAINERS */
+
+#define CMC_GENERATE_ROARING(PFX, SNAME, V)    \
+    CMC_GENERATE_ROARING_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_ROARING_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_ROARING_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_ROARING_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_ROARING_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_ROARING_SOURCE(PFX, SNAME, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_ROARING_HEADER(PFX, SNAME, V)                                        \
+                                                                                          \
+    /* Roaring Structure */                                                               \
+    struct SNAME                                                                          \
+    {                                                                                     \
+        /* Containers sorted by key */                                                    \
+        struct cmc_roaring_container *containers;                                         \
+                                                                                          \
+        /* Amount of containers */                                                        \
+        size_t length;                                                                    \
+                                                                                          \
+        /* Containers that fit without growing */                                         \
+        size_t capacity;                                                                  \
+                                                                                          \
+        /* Current amount of elements */                                                  \
+        size_t count;                                                                     \
+                                                                                          \
+        /* Function that returns an iterator to the start of the roaring */               \
+        struct SNAME##_iter (*it_start)(struct SNAME *);                                  \
+                                                                                          \
+        /* Function that returns an iterator to the end of the roaring */                 \
+        struct SNAME##_iter (*it_end)(struct SNAME *);                                    \
+                                                                                          \
+        /* Custom allocation functions */                                                 \
+        struct cmc_alloc_node *alloc;                                                     \
+    };                                                                                    \
+                                                                                          \
+    /* Roaring Iterator */                                                                \
+    struct SNAME##_iter                                                                   \
+    {                                                                                     \
+        /* Target Roaring */                                                              \
+        struct SNAME *target;                                                             \
+                                                                                          \
+        /* Container of the element the cursor is at */                                   \
+        size_t container;                                                                 \
+                                                                                          \
+        /* Cursor's position, the element it is at */                                     \
+        uint32_t cursor;                                                                  \
+                                                                                          \
+        /* Keeps track of relative index to the iteration of elements */                  \
+        size_t index;                                                                     \
+                                                                                          \
+        /* If the iterator has reached the start of the iteration */                      \
+        bool start;                                                                       \
+                                                                                          \
+        /* If the iterator has reached the end of the iteration */                        \
+        bool end;                                                                         \
+    };                                                                                    \
+                                                                                          \
+    /* Collection Functions */                                                            \
+    /* Collection Allocation and Deallocation */                                          \
+    struct SNAME *PFX##_new(void);                                                        \
+    struct SNAME *PFX##_new_custom(struct cmc_alloc_node *alloc);                         \
+    struct SNAME *PFX##_new_from(V *elements, size_t size);                               \
+    void PFX##_clear(struct SNAME *_set_);                                                \
+    void PFX##_free(struct SNAME *_set_);                                                 \
+    /* Collection Input and Output */                                                     \
+    bool PFX##_insert(struct SNAME *_set_, V element);                                    \
+    size_t PFX##_insert_many(struct SNAME *_set_, V *elements, size_t n);                 \
+    bool PFX##_remove(struct SNAME *_set_, V element);                                    \
+    /* Element Access */                                                                  \
+    bool PFX##_max(struct SNAME *_set_, V *value);                                        \
+    bool PFX##_min(struct SNAME *_set_, V *value);                                        \
+    /* Collection State */                                                                \
+    bool PFX##_contains(struct SNAME *_set_, V element);                                  \
+    CMC_PURE bool PFX##_empty(struct SNAME *_set_);                                       \
+    CMC_PURE size_t PFX##_count(struct SNAME *_set_);                                     \
+    size_t PFX##_memory_usage(struct SNAME *_set_);                                       \
+    /* Collection Utility */                                                              \
+    bool PFX##_run_optimize(struct SNAME *_set_);                                         \
+    struct SNAME *PFX##_copy_of(struct SNAME *_set_);                                     \
+    size_t PFX##_to_array(struct SNAME *_set_, V *CMC_RESTRICT elements, size_t size);    \
+    bool PFX##_equals(struct SNAME *_set1_, struct SNAME *_set2_);                        \
+    struct cmc_string PFX##_to_string(struct SNAME *_set_);                               \
+    /* Collection Serialization */                                                        \
+    bool PFX##_save(struct SNAME *_set_, FILE *file);                                     \
+    struct SNAME *PFX##_restore(FILE *file);                                              \
+                                                                                          \
+    /* Set Operations */                                                                  \
+    struct SNAME *PFX##_union(struct SNAME *_set1_, struct SNAME *_set2_);                \
+    struct SNAME *PFX##_intersection(struct SNAME *_set1_, struct SNAME *_set2_);         \
+    struct SNAME *PFX##_difference(struct SNAME *_set1_, struct SNAME *_set2_);           \
+    struct SNAME *PFX##_symmetric_difference(struct SNAME *_set1_, struct SNAME *_set2_); \
+    bool PFX##_union_into(struct SNAME *_set1_, struct SNAME *_set2_);                    \
+    bool PFX##_intersect_with(struct SNAME *_set1_, struct SNAME *_set2_);                \
+    bool PFX##_subtract(struct SNAME *_set1_, struct SNAME *_set2_);                      \
+    bool PFX##_is_subset(struct SNAME *_set1_, struct SNAME *_set2_);                     \
+    bool PFX##_is_superset(struct SNAME *_set1_, struct SNAME *_set2_);                   \
+    bool PFX##_is_proper_subset(struct SNAME *_set1_, struct SNAME *_set2_);              \
+    bool PFX##_is_proper_superset(struct SNAME *_set1_, struct SNAME *_set2_);            \
+    bool PFX##_is_disjointset(struct SNAME *_set1_, struct SNAME *_set2_);                \
+                                                                                          \
+    /* Iterator Functions */                                                              \
+    /* Iterator Allocation and Deallocation */                                            \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target);                            \
+    void PFX##_iter_free(struct SNAME##_iter *iter);                                      \
+    /* Iterator Initialization */                                                         \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);                \
+    /* Iterator State */                                                                  \
+    bool PFX##_iter_start(struct SNAME##_iter *iter);                                     \
+    bool PFX##_iter_end(struct SNAME##_iter *iter);                                       \
+    /* Iterator Movement */                                                               \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter);                                  \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter);                                    \
+    bool PFX##_iter_next(struct SNAME##_iter *iter);                                      \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter);                                      \
+    /* Iterator Access */                                                                 \
+    V PFX##_iter_value(struct SNAME##_iter *iter);                                        \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter);                                   \
+                                                                                          \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_ROARING_SOURCE(PFX, SNAME, V)                                                    \
+                                                                                                      \
+    /* Implementation Detail Functions */                                                             \
+    static size_t PFX##_impl_find(struct SNAME *_set_, uint16_t key);                                 \
+    static bool PFX##_impl_push(struct SNAME *_set_, size_t index,                                    \
+                                struct cmc_roaring_container *container);                             \
+    static void PFX##_impl_erase(struct SNAME *_set_, size_t index);                                  \
+    static struct SNAME *PFX##_impl_combine(struct SNAME *_set1_, struct SNAME *_set2_,               \
+                                            enum cmc_bits_op op);                                     \
+    static void PFX##_impl_swap(struct SNAME *_set1_, struct SNAME *_set2_);                          \
+    static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_set_);                              \
+    static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_set_);                                \
+                                                                                                      \
+    struct SNAME *PFX##_new(void)                                                                     \
+    {                                                                                                 \
+        return PFX##_new_custom(NULL);                                                                \
+    }                                                                                                 \
+                                                                                                      \
+    struct SNAME *PFX##_new_custom(struct cmc_alloc_node *alloc)                                      \
+    {                                                                                                 \
+        if (!alloc)                                                                                   \
+            alloc = &cmc_alloc_node_default;                                                          \
+                                                                                                      \
+        struct SNAME *_set_ = alloc->malloc(sizeof(struct SNAME));                                    \
+                                                                                                      \
+        if (CMC_UNLIKELY(!_set_))                                                                     \
+            return NULL;                                                                              \
+                                                                                                      \
+        _set_->containers = NULL;                                                                     \
+        _set_->length = 0;                                                                            \
+        _set_->capacity = 0;                                                                          \
+        _set_->count = 0;                                                                             \
+        _set_->it_start = PFX##_impl_it_start;                                                        \
+        _set_->it_end = PFX##_impl_it_end;                                                            \
+        _set_->alloc = alloc;                                                                         \
+                                                                                                      \
+        return _set_;                                                                                 \
+    }                                                                                                 \
+                                                                                                      \
+    struct SNAME *PFX##_new_from(V *elements, size_t size)                                            \
+    {                                                                                                 \
+        struct SNAME *_set_ = PFX##_new();                                                            \
+                                                                                                      \
+        if (CMC_UNLIKELY(!_set_))                                                                     \
+            return NULL;                                                                              \
+                                                                                                      \
+        PFX##_insert_many(_set_, elements, size);                                                     \
+                                                                                                      \
+        return _set_;                                                                                 \
+    }                                                                                                 \
+                                                                                                      \
+    void PFX##_clear(struct SNAME *_set_)                                                             \
+    {                                                                                                 \
+        for (size_t i = 0; i < _set_->length; i++)                                                    \
+            cmc_roaring_container_free(_set_->alloc, &_set_->containers[i]);                          \
+                                                                                                      \
+        _set_->length = 0;                                                                            \
+        _set_->count = 0;                                                                             \
+    }                                                                                                 \
+                                                                                                      \
+    void PFX##_free(struct SNAME *_set_)                                                              \
+    {                                                                                                 \
+        PFX##_clear(_set_);                                                                           \
+                                                                                                      \
+        if (_set_->containers)                                                                        \
+            _set_->alloc->free(_set_->containers);                                                    \
+                                                                                                      \
+        _set_->alloc->free(_set_);                                                                    \
+    }                                                                                                 \
+                                                                                                      \
+    /* Returns false if the element was already present, can't be held in */                          \
+    /* 32 bits or if its container could not grow */                                                  \
+    bool PFX##_insert(struct SNAME *_set_, V element)                                                 \
+    {                                                                                                 \
+        if ((uint64_t)element > UINT32_MAX)                                                           \
+            return false;                                                                             \
+                                                                                                      \
+        uint32_t value = (uint32_t)element;                                                           \
+        uint16_t key = (uint16_t)(value >> 16);                                                       \
+        size_t i = PFX##_impl_find(_set_, key);                                                       \
+                                                                                                      \
+        if (i == _set_->length || _set_->containers[i].key != key)                                    \
+        {                                                                                             \
+            struct cmc_roaring_container container = { 0 };                                           \
+                                                                                                      \
+            container.key = key;                                                                      \
+            container.type = CMC_ROARING_ARRAY;                                                       \
+            container.cardinality = 1;                                                                \
+            container.capacity = 1;                                                                   \
+            container.data.array = _set_->alloc->malloc(sizeof(uint16_t));                            \
+                                                                                                      \
+            if (CMC_UNLIKELY(!container.data.array))                                                  \
+                return false;                                                                         \
+                                                                                                      \
+            container.data.array[0] = (uint16_t)value;                                                \
+                                                                                                      \
+            if (!PFX##_impl_push(_set_, i, &container))                                               \
+            {                                                                                         \
+                _set_->alloc->free(container.data.array);                                             \
+                return false;                                                                         \
+            }                                                                                         \
+                                                                                                      \
+            _set_->count++;                                                                           \
+                                                                                                      \
+            return true;                                                                              \
+        }                                                                                             \
+                                                                                                      \
+        if (cmc_roaring_container_insert(_set_->alloc, &_set_->containers[i], (uint16_t)value) <= 0)  \
+            return false;                                                                             \
+                                                                                                      \
+        _set_->count++;                                                                               \
+                                                                                                      \
+        return true;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    /* Returns how many elements were not present before */                                           \
+    size_t PFX##_insert_many(struct SNAME *_set_, V *elements, size_t n)                              \
+    {                                                                                                 \
+        size_t inserted = 0;                                                                          \
+                                                                                                      \
+        for (size_t i = 0; i < n; i++)                                                                \
+        {                                                                                             \
+            if (PFX##_insert(_set_, elements[i]))                                                     \
+                inserted++;                                                                           \
+        }                                                                                             \
+                                                                                                      \
+        return inserted;                                                                              \
+    }                                                                                                 \
+                                                                                                      \
+    bool PFX##_remove(struct SNAME *_set_, V element)                                                 \
+    {                                                                                                 \
+        if ((uint64_t)element > UINT32_MAX)                                                           \
+            return false;                                                                             \
+                                                                                                      \
+        uint32_t value = (uint32_t)element;                                                           \
+        uint16_t key = (uint16_t)(value >> 16);                                                       \
+        size_t i = PFX##_impl_find(_set_, key);                                                       \
+                                                                                                      \
+        if (i == _set_->length || _set_->containers[i].key != key)                                    \
+            return false;                                                                             \
+                                                                                                      \
+        struct cmc_roaring_container *container = &_set_->containers[i];                              \
+                                                                                                      \
+        if (cmc_roaring_container_remove(_set_->alloc, container, (uint16_t)value) <= 0)              \
+            return false;                                                                             \
+                                                                                                      \
+        if (container->cardinality == 0)                                                              \
+            PFX##_impl_erase(_set_, i);                                                               \
+                                                                                                      \
+        _set_->count--;                                                                               \
+                                                                                                      \
+        return true;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    bool PFX##_max(struct SNAME *_set_, V *value)                                                     \
+    {                                                                                                 \
+        if (PFX##_empty(_set_))                                                                       \
+            return false;                                                                             \
+                                                                                                      \
+        struct cmc_roaring_container *last = &_set_->containers[_set_->length - 1];                   \
+                                                                                                      \
+        if (value)                                                                                    \
+            *value = (V)(((uint32_t)last->key << 16) |                                                \
+                         (uint32_t)cmc_roaring_container_prev(last, UINT16_MAX));                     \
+                                                                                                      \
+        return true;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    bool PFX##_min(struct SNAME *_set_, V *value)                                                     \
+    {                                                                                                 \
+        if (PFX##_empty(_set_))                                                                       \
+            return false;                                                                             \
+                                                                                                      \
+        struct cmc_roaring_container *first = &_set_->containers[0];                                  \
+                                                                                                      \
+        if (value)                                                                                    \
+            *value = (V)(((uint32_t)first->key << 16) |                                               \
+                         (uint32_t)cmc_roaring_container_next(first, 0));                             \
+                                                                                                      \
+        return true;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    bool PFX##_contains(struct SNAME *_set_, V element)                                               \
+    {                                                                                                 \
+        if ((uint64_t)element > UINT32_MAX)                                                           \
+            return false;                                                                             \
+                                                                                                      \
+        uint32_t value = (uint32_t)element;                                                           \
+        uint16_t key = (uint16_t)(value >> 16);                                                       \
+        size_t i = PFX##_impl_find(_set_, key);                                                       \
+                                                                                                      \
+        if (i == _set_->length || _set_->containers[i].key != key)                                    \
+            return false;                                                                             \
+                                                                                                      \
+        return cmc_roaring_container_contains(&_set_->containers[i], (uint16_t)value);                \
+    }                                                                                                 \
+                                                                                                      \
+    bool PFX##_empty(struct SNAME *_set_)                                                             \
+    {                                                                                                 \
+        return _set_->count == 0;                                                                     \
+    }                                                                                                 \
+                                                                                                      \
+    size_t PFX##_count(struct SNAME *_set_)                                                           \
+    {                                                                                                 \
+        return _set_->count;                                                                          \
+    }                                                                                                 \
+                                                                                                      \
+    size_t PFX##_memory_usage(struct SNAME *_set_)                                                    \
+    {                                                                                                 \
+        size_t bytes = sizeof(struct SNAME) + _set_->capacity * sizeof(struct cmc_roaring_container); \
+                                                                                                      \
+        for (size_t i = 0; i < _set_->length; i++)                                                    \
+        {                                                                                             \
+            struct cmc_roaring_container *c = &_set_->containers[i];                                  \
+                                                                                                      \
+            if (c->type == CMC_ROARING_BITMAP)                                                        \
+                bytes += cmc_alloc_aligned_size(CMC_CACHE_LINE_SIZE,                                  \
+                                                cmc_roaring_bytes(c->type, 0, 0));                    \
+            else                                                                                      \
+                bytes += cmc_roaring_bytes(c->type, c->capacity, c->capacity);                        \
+        }                                                                                             \
+                                                                                                      \
+        return bytes;                                                                                 \
+    }                                                                                                 \
+                                                                                                      \
+    /* Turns every container into a RUN where that takes less memory. */                              \
+    /* Returns false if a container could not be turned, which is still valid */                      \
+    bool PFX##_run_optimize(struct SNAME *_set_)                                                      \
+    {                                                                                                 \
+        bool result = true;                                                                           \
+                                                                                                      \
+        for (size_t i = 0; i < _set_->length; i++)                                                    \
+        {                                                                                             \
+            if (!cmc_roaring_container_optimize(_set_->alloc, &_set_->containers[i]))                 \
+                result = false;                                                                       \
+        }                                                                                             \
+                                                                                                      \
+        return result;                                                                                \
+    }                                                                                                 \
+                                                                                                      \
+    struct SNAME *PFX##_copy_of(struct SNAME *_set_)                                                  \
+    {                                                                                                 \
+        struct SNAME *result = PFX##_new_custom(_set_->alloc);                                        \
+                                                                                                      \
+        if (CMC_UNLIKELY(!result))                                                                    \
+            return NULL;                                                                              \
+                                                                                                      \
+        for (size_t i = 0; i < _set_->length; i++)                                                    \
+        {                                                                                             \
+            struct cmc_roaring_container copy;                                                        \
+                                                                                                      \
+            if (!cmc_roaring_container_copy(_set_->alloc, &_set_->containers[i], &copy))              \
+            {                                                                                         \
+                PFX##_free(result);                                                                   \
+                return NULL;                                                                          \
+            }                                                                                         \
+                                                                                                      \
+            if (!PFX##_impl_push(result, i, &copy))                                                   \
+            {                                                                                         \
+                cmc_roaring_container_free(_set_->alloc, &copy);                                      \
+                PFX##_free(result);                                                                   \
+                return NULL;                                                                          \
+            }                                                                                         \
+        }                                                                                             \
+                                                                                                      \
+        result->count = _set_->count;                                                                 \
+                                                                                                      \
+        return result;                                                                                \
+    }                                                                                                 \
+                                                                                                      \
+    /* Writes up to size elements in increasing order, returning how many */                          \
+    size_t PFX##_to_array(struct SNAME *_set_, V *CMC_RESTRICT elements, size_t size)                 \
+    {                                                                                                 \
+        size_t written = 0;                                                                           \
+                                                                                                      \
+        for (size_t i = 0; i < _set_->length && written < size; i++)                                  \
+        {                                                                                             \
+            struct cmc_roaring_container *c = &_set_->containers[i];                                  \
+            uint32_t high = (uint32_t)c->key << 16;                                                   \
+            int32_t value = -1;                                                                       \
+                                                                                                      \
+            while (written < size &&                                                                  \
+                   (value = cmc_roaring_container_next(c, (uint32_t)(value + 1))) >= 0)               \
+                elements[written++] = (V)(high | (uint32_t)value);                                    \
+        }                                                                                             \
+                                                                                                      \
+        return written;                                                                               \
+    }                                                                                                 \
+                                                                                                      \
+    /* Two sets are equal if they have the same elements, regardless of the */                        \
+    /* type of their containers */                                                                    \
+    bool PFX##_equals(struct SNAME *_set1_, struct SNAME *_set2_)                                     \
+    {                                                                                                 \
+        if (_set1_->count != _set2_->count || _set1_->length != _set2_->length)                       \
+            return false;                                                                             \
+                                                                                                      \
+        for (size_t i = 0; i < _set1_->length; i++)                                                   \
+        {                                                                                             \
+            struct cmc_roaring_container *a = &_set1_->containers[i];                                 \
+            struct cmc_roaring_container *b = &_set2_->containers[i];                                 \
+                                                                                                      \
+            if (a->key != b->key || a->cardinality != b->cardinality)                                 \
+                return false;                                                                         \
+                                                                                                      \
+            if (cmc_roaring_container_and_count(a, b) != a->cardinality)                              \
+                return false;                                                                         \
+        }                                                                                             \
+                                                                                                      \
+        return true;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    struct cmc_string PFX##_to_string(struct SNAME *_set_)                                            \
+    {                                                                                                 \
+        struct cmc_string str;                                                                        \
+        struct SNAME *s_ = _set_;                                                                     \
+        const char *name = #SNAME;                                                                    \
+                                                                                                      \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_roaring, name, s_, s_->containers,             \
+                 s_->length, s_->capacity, s_->count);                                                \
+                                                                                                      \
+        return str;                                                                                   \
+    }                                                                                                 \
+                                                                                                      \
+    /* Writes each container as it is in memory, after its type, key and */                           \
+    /* cardinality, so a set is restored without inserting its elements */                            \
+    bool PFX##_save(struct SNAME *_set_, FILE *file)                                                  \
+    {                                                                                                 \
+        if (!cmc_serial_write_header(file, "roaring", 0, 0, sizeof(V), 0, _set_->count,               \
+                                     _set_->length, 0))                                               \
+            return false;                                                                             \
+                                                                                                      \
+        for (size_t i = 0; i < _set_->length; i++)                                                    \
+        {                                                                                             \
+            struct cmc_roaring_container *c = &_set_->containers[i];                                  \
+            struct cmc_roaring_serial serial = { c->key, c->type, c->cardinality, c->runs, 0 };       \
+            size_t bytes = cmc_roaring_bytes(c->type, c->cardinality, c->runs);                       \
+            const void *data = c->type == CMC_ROARING_BITMAP  ? (const void *)c->data.bitmap          \
+                               : c->type == CMC_ROARING_ARRAY ? (const void *)c->data.array           \
+                                                              : (const void *)c->data.run;            \
+                                                                                                      \
+            if (fwrite(&serial, sizeof(serial), 1, file) != 1 ||                                      \
+                fwrite(data, 1, bytes, file) != bytes)                                                \
+                return false;                                                                         \
+        }                                                                                             \
+                                                                                                      \
+        return true;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    /* Returns NULL if the file is not a valid set, checking that its */                              \
+    /* containers are sorted and that their cardinalities add up */                                   \
+    struct SNAME *PFX##_restore(FILE *file)                                                           \
+    {                                                                                                 \
+        struct cmc_serial_header header;                                                              \
+                                                                                                      \
+        if (!cmc_serial_read_header(file, "roaring", 0, sizeof(V), &header))                          \
+            return NULL;                                                                              \
+                                                                                                      \
+        if (header.capacity > UINT16_MAX + 1)                                                         \
+            return NULL;                                                                              \
+                                                                                                      \
+        struct SNAME *_set_ = PFX##_new();                                                            \
+                                                                                                      \
+        if (CMC_UNLIKELY(!_set_))                                                                     \
+            return NULL;                                                                              \
+                                                                                                      \
+        for (size_t i = 0; i < header.capacity; i++)                                                  \
+        {                                                                                             \
+            struct cmc_roaring_serial serial;                                                         \
+            struct cmc_roaring_container c = { 0 };                                                   \
+                                                                                                      \
+            if (fread(&serial, sizeof(serial), 1, file) != 1)                                         \
+                goto error;                                                                           \
+                                                                                                      \
+            bool valid = serial.type <= CMC_ROARING_RUN && serial.cardinality > 0 &&                  \
+                         serial.cardinality <= UINT16_MAX + 1 &&                                      \
+                         (i == 0 || serial.key > _set_->containers[i - 1].key);                       \
+                                                                                                      \
+            if (serial.type == CMC_ROARING_ARRAY)                                                     \
+                valid = valid && serial.cardinality <= CMC_ROARING_ARRAY_MAX;                         \
+            else if (serial.type == CMC_ROARING_RUN)                                                  \
+                valid = valid && serial.runs > 0 && serial.runs <= serial.cardinality;                \
+                                                                                                      \
+            if (!valid)                                                                               \
+                goto error;                                                                           \
+                                                                                                      \
+            size_t bytes = cmc_roaring_bytes(serial.type, serial.cardinality, serial.runs);           \
+            void *data = serial.type == CMC_ROARING_BITMAP                                            \
+                             ? cmc_alloc_aligned(_set_->alloc, CMC_CACHE_LINE_SIZE, bytes)            \
+                             : _set_->alloc->malloc(bytes);                                           \
+                                                                                                      \
+            if (!data)                                                                                \
+                goto error;                                                                           \
+                                                                                                      \
+            c.key = serial.key;                                                                       \
+            c.type = serial.type;                                                                     \
+            c.cardinality = serial.cardinality;                                                       \
+            c.runs = serial.runs;                                                                     \
+            c.capacity = serial.type == CMC_ROARING_ARRAY ? serial.cardinality : serial.runs;         \
+            c.data.array = data;                                                                      \
+                                                                                                      \
+            if (fread(data, 1, bytes, file) != bytes || !PFX##_impl_push(_set_, i, &c))               \
+            {                                                                                         \
+                cmc_roaring_container_free(_set_->alloc, &c);                                         \
+                goto error;                                                                           \
+            }                                                                                         \
+                                                                                                      \
+            _set_->count += c.cardinality;                                                            \
+        }                                                                                             \
+                                                                                                      \
+        if (_set_->count != header.count)                                                             \
+            goto error;                                                                               \
+                                                                                                      \
+        return _set_;                                                                                 \
+                                                                                                      \
+    error:                                                                                            \
+        PFX##_free(_set_);                                                                            \
+        return NULL;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    struct SNAME *PFX##_union(struct SNAME *_set1_, struct SNAME *_set2_)                             \
+    {                                                                                                 \
+        return PFX##_impl_combine(_set1_, _set2_, CMC_BITS_OR);                                       \
+    }                                                                                                 \
+                                                                                                      \
+    struct SNAME *PFX##_intersection(struct SNAME *_set1_, struct SNAME *_set2_)                      \
+    {                                                                                                 \
+        return PFX##_impl_combine(_set1_, _set2_, CMC_BITS_AND);                                      \
+    }                                                                                                 \
+                                                                                                      \
+    struct SNAME *PFX##_difference(struct SNAME *_set1_, struct SNAME *_set2_)                        \
+    {                                                                                                 \
+        return PFX##_impl_combine(_set1_, _set2_, CMC_BITS_ANDNOT);                                   \
+    }                                                                                                 \
+                                                                                                      \
+    struct SNAME *PFX##_symmetric_difference(struct SNAME *_set1_, struct SNAME *_set2_)              \
+    {                                                                                                 \
+        return PFX##_impl_combine(_set1_, _set2_, CMC_BITS_XOR);                                      \
+    }                                                                                                 \
+                                                                                                      \
+    /* The in place operations build the result and take its containers, */                           \
+    /* so _set1_ is left unchanged if they return false */                                            \
+    bool PFX##_union_into(struct SNAME *_set1_, struct SNAME *_set2_)                                 \
+    {                                                                                                 \
+        struct SNAME *result = PFX##_union(_set1_, _set2_);                                           \
+                                                                                                      \
+        if (!result)                                                                                  \
+            return false;                                                                             \
+                                                                                                      \
+        PFX##_impl_swap(_set1_, result);                                                              \
+        PFX##_free(result);                                                                           \
+                                                                                                      \
+        return true;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    bool PFX##_intersect_with(struct SNAME *_set1_, struct SNAME *_set2_)                             \
+    {                                                                                                 \
+        struct SNAME *result = PFX##_intersection(_set1_, _set2_);                                    \
+                                                                                                      \
+        if (!result)                                                                                  \
+            return false;                                                                             \
+                                                                                                      \
+        PFX##_impl_swap(_set1_, result);                                                              \
+        PFX##_free(result);                                                                           \
+                                                                                                      \
+        return true;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    bool PFX##_subtract(struct SNAME *_set1_, struct SNAME *_set2_)                                   \
+    {                                                                                                 \
+        struct SNAME *result = PFX##_difference(_set1_, _set2_);                                      \
+                                                                                                      \
+        if (!result)                                                                                  \
+            return false;                                                                             \
+                                                                                                      \
+        PFX##_impl_swap(_set1_, result);                                                              \
+        PFX##_free(result);                                                                           \
+                                                                                                      \
+        return true;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    /* Is _set1_ a subset of _set2_ ? */                                                              \
+    bool PFX##_is_subset(struct SNAME *_set1_, struct SNAME *_set2_)                                  \
+    {                                                                                                 \
+        if (_set1_->count > _set2_->count)                                                            \
+            return false;                                                                             \
+                                                                                                      \
+        size_t j = 0;                                                                                 \
+                                                                                                      \
+        for (size_t i = 0; i < _set1_->length; i++)                                                   \
+        {                                                                                             \
+            struct cmc_roaring_container *a = &_set1_->containers[i];                                 \
+                                                                                                      \
+            while (j < _set2_->length && _set2_->containers[j].key < a->key)                          \
+                j++;                                                                                  \
+                                                                                                      \
+            if (j == _set2_->length || _set2_->containers[j].key != a->key)                           \
+                return false;                                                                         \
+                                                                                                      \
+            struct cmc_roaring_container *b = &_set2_->containers[j];                                 \
+                                                                                                      \
+            if (a->cardinality > b->cardinality ||                                                    \
+                cmc_roaring_container_and_count(a, b) != a->cardinality)                              \
+                return false;                                                                         \
+        }                                                                                             \
+                                                                                                      \
+        return true;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    /* Is _set1_ a superset of _set2_ ? */                                                            \
+    bool PFX##_is_superset(struct SNAME *_set1_, struct SNAME *_set2_)                                \
+    {                                                                                                 \
+        return PFX##_is_subset(_set2_, _set1_);                                                       \
+    }                                                                                                 \
+                                                                                                      \
+    /* Is _set1_ a proper subset of _set2_ ? */                                                       \
+    bool PFX##_is_proper_subset(struct SNAME *_set1_, struct SNAME *_set2_)                           \
+    {                                                                                                 \
+        return _set1_->count < _set2_->count && PFX##_is_subset(_set1_, _set2_);                      \
+    }                                                                                                 \
+                                                                                                      \
+    /* Is _set1_ a proper superset of _set2_ ? */                                                     \
+    bool PFX##_is_proper_superset(struct SNAME *_set1_, struct SNAME *_set2_)                         \
+    {                                                                                                 \
+        return PFX##_is_proper_subset(_set2_, _set1_);                                                \
+    }                                                                                                 \
+                                                                                                      \
+    /* Is _set1_ and _set2_ disjoint ? */                                                             \
+    bool PFX##_is_disjointset(struct SNAME *_set1_, struct SNAME *_set2_)                             \
+    {                                                                                                 \
+        size_t i = 0, j = 0;                                                                          \
+                                                                                                      \
+        while (i < _set1_->length && j < _set2_->length)                                              \
+        {                                                                                             \
+            struct cmc_roaring_container *a = &_set1_->containers[i];                                 \
+            struct cmc_roaring_container *b = &_set2_->containers[j];                                 \
+                                                                                                      \
+            if (a->key < b->key)                                                                      \
+                i++;                                                                                  \
+            else if (a->key > b->key)                                                                 \
+                j++;                                                                                  \
+            else                                                                                      \
+            {                                                                                         \
+                if (cmc_roaring_container_and_count(a, b) != 0)                                       \
+                    return false;                                                                     \
+                                                                                                      \
+                i++;                                                                                  \
+                j++;                                                                                  \
+            }                                                                                         \
+        }                                                                                             \
+                                                                                                      \
+        return true;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                         \
+    {                                                                                                 \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));               \
+                                                                                                      \
+        if (CMC_UNLIKELY(!iter))                                                                      \
+            return NULL;                                                                              \
+                                                                                                      \
+        PFX##_iter_init(iter, target);                                                                \
+                                                                                                      \
+        return iter;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    void PFX##_iter_free(struct SNAME##_iter *iter)                                                   \
+    {                                                                                                 \
+        iter->target->alloc->free(iter);                                                              \
+    }                                                                                                 \
+                                                                                                      \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                             \
+    {                                                                                                 \
+        memset(iter, 0, sizeof(struct SNAME##_iter));                                                 \
+                                                                                                      \
+        iter->target = target;                                                                        \
+                                                                                                      \
+        PFX##_iter_to_start(iter);                                                                    \
+    }                                                                                                 \
+                                                                                                      \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                                  \
+    {                                                                                                 \
+        return PFX##_empty(iter->target) || iter->start;                                              \
+    }                                                                                                 \
+                                                                                                      \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                                    \
+    {                                                                                                 \
+        return PFX##_empty(iter->target) || iter->end;                                                \
+    }                                                                                                 \
+                                                                                                      \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                               \
+    {                                                                                                 \
+        iter->start = true;                                                                           \
+        iter->end = PFX##_empty(iter->target);                                                        \
+        iter->index = 0;                                                                              \
+        iter->container = 0;                                                                          \
+                                                                                                      \
+        if (!PFX##_empty(iter->target))                                                               \
+        {                                                                                             \
+            struct cmc_roaring_container *first = &iter->target->containers[0];                       \
+                                                                                                      \
+            iter->cursor = ((uint32_t)first->key << 16) |                                             \
+                           (uint32_t)cmc_roaring_container_next(first, 0);                            \
+        }                                                                                             \
+    }                                                                                                 \
+                                                                                                      \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                                 \
+    {                                                                                                 \
+        iter->start = PFX##_empty(iter->target);                                                      \
+        iter->end = true;                                                                             \
+                                                                                                      \
+        if (!PFX##_empty(iter->target))                                                               \
+        {                                                                                             \
+            struct cmc_roaring_container *last =                                                      \
+                &iter->target->containers[iter->target->length - 1];                                  \
+                                                                                                      \
+            iter->index = PFX##_count(iter->target) - 1;                                              \
+            iter->container = iter->target->length - 1;                                               \
+            iter->cursor = ((uint32_t)last->key << 16) |                                              \
+                           (uint32_t)cmc_roaring_container_prev(last, UINT16_MAX);                    \
+        }                                                                                             \
+    }                                                                                                 \
+                                                                                                      \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                                   \
+    {                                                                                                 \
+        if (iter->end)                                                                                \
+            return false;                                                                             \
+                                                                                                      \
+        if (iter->index + 1 == PFX##_count(iter->target))                                             \
+        {                                                                                             \
+            iter->end = true;                                                                         \
+            return false;                                                                             \
+        }                                                                                             \
+                                                                                                      \
+        iter->start = PFX##_empty(iter->target);                                                      \
+                                                                                                      \
+        struct cmc_roaring_container *c = &iter->target->containers[iter->container];                 \
+        int32_t value = cmc_roaring_container_next(c, (iter->cursor & 0xFFFF) + 1);                   \
+                                                                                                      \
+        if (value < 0)                                                                                \
+        {                                                                                             \
+            c = &iter->target->containers[++iter->container];                                         \
+            value = cmc_roaring_container_next(c, 0);                                                 \
+        }                                                                                             \
+                                                                                                      \
+        iter->index++;                                                                                \
+        iter->cursor = ((uint32_t)c->key << 16) | (uint32_t)value;                                    \
+                                                                                                      \
+        return true;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                                   \
+    {                                                                                                 \
+        if (iter->start)                                                                              \
+            return false;                                                                             \
+                                                                                                      \
+        if (iter->index == 0)                                                                         \
+        {                                                                                             \
+            iter->start = true;                                                                       \
+            return false;                                                                             \
+        }                                                                                             \
+                                                                                                      \
+        iter->end = PFX##_empty(iter->target);                                                        \
+                                                                                                      \
+        struct cmc_roaring_container *c = &iter->target->containers[iter->container];                 \
+        uint16_t low = (uint16_t)(iter->cursor & 0xFFFF);                                             \
+        int32_t value = low == 0 ? -1 : cmc_roaring_container_prev(c, low - 1);                       \
+                                                                                                      \
+        if (value < 0)                                                                                \
+        {                                                                                             \
+            c = &iter->target->containers[--iter->container];                                         \
+            value = cmc_roaring_container_prev(c, UINT16_MAX);                                        \
+        }                                                                                             \
+                                                                                                      \
+        iter->index--;                                                                                \
+        iter->cursor = ((uint32_t)c->key << 16) | (uint32_t)value;                                    \
+                                                                                                      \
+        return true;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                                     \
+    {                                                                                                 \
+        if (PFX##_empty(iter->target))                                                                \
+            return (V){0};                                                                            \
+                                                                                                      \
+        return (V)iter->cursor;                                                                       \
+    }                                                                                                 \
+                                                                                                      \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                                \
+    {                                                                                                 \
+        return iter->index;                                                                           \
+    }                                                                                                 \
+                                                                                                      \
+    /* Position of the container of key, or where it would be inserted */                             \
+    static size_t PFX##_impl_find(struct SNAME *_set_, uint16_t key)                                  \
+    {                                                                                                 \
+        size_t low = 0, high = _set_->length;                                                         \
+                                                                                                      \
+        /* Elements are often inserted in increasing order */                                         \
+        if (high > 0 && _set_->containers[high - 1].key < key)                                        \
+            return high;                                                                              \
+                                                                                                      \
+        while (low < high)                                                                            \
+        {                                                                                             \
+            size_t mid = low + (high - low) / 2;                                                      \
+                                                                                                      \
+            if (_set_->containers[mid].key < key)                                                     \
+                low = mid + 1;                                                                        \
+            else                                                                                      \
+                high = mid;                                                                           \
+        }                                                                                             \
+                                                                                                      \
+        return low;                                                                                   \
+    }                                                                                                 \
+                                                                                                      \
+    /* Inserts a container at index, growing the array of containers */                               \
+    static bool PFX##_impl_push(struct SNAME *_set_, size_t index,                                    \
+                                struct cmc_roaring_container *container)                              \
+    {                                                                                                 \
+        if (_set_->length == _set_->capacity)                                                         \
+        {                                                                                             \
+            size_t capacity = _set_->capacity < 4 ? 4 : _set_->capacity * 2;                          \
+            struct cmc_roaring_container *containers = _set_->alloc->realloc(                         \
+                _set_->containers, capacity * sizeof(struct cmc_roaring_container));                  \
+                                                                                                      \
+            if (CMC_UNLIKELY(!containers))                                                            \
+                return false;                                                                         \
+                                                                                                      \
+            _set_->containers = containers;                                                           \
+            _set_->capacity = capacity;                                                               \
+        }                                                                                             \
+                                                                                                      \
+        memmove(_set_->containers + index + 1, _set_->containers + index,                             \
+                (_set_->length - index) * sizeof(struct cmc_roaring_container));                      \
+                                                                                                      \
+        _set_->containers[index] = *container;                                                        \
+        _set_->length++;                                                                              \
+                                                                                                      \
+        return true;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    /* Frees and removes the container at index */                                                    \
+    static void PFX##_impl_erase(struct SNAME *_set_, size_t index)                                   \
+    {                                                                                                 \
+        cmc_roaring_container_free(_set_->alloc, &_set_->containers[index]);                          \
+                                                                                                      \
+        memmove(_set_->containers + index, _set_->containers + index + 1,                             \
+                (_set_->length - index - 1) * sizeof(struct cmc_roaring_container));                  \
+                                                                                                      \
+        _set_->length--;                                                                              \
+    }                                                                                                 \
+                                                                                                      \
+    /* A new set with _set1_ op _set2_, going through the containers of both */                       \
+    /* in order of key. A container that only one of them has is copied, */                           \
+    /* when op keeps it, and two of the same key are combined */                                      \
+    static struct SNAME *PFX##_impl_combine(struct SNAME *_set1_, struct SNAME *_set2_,               \
+                                            enum cmc_bits_op op)                                      \
+    {                                                                                                 \
+        struct SNAME *result = PFX##_new_custom(_set1_->alloc);                                       \
+                                                                                                      \
+        if (CMC_UNLIKELY(!result))                                                                    \
+            return NULL;                                                                              \
+                                                                                                      \
+        bool keep_a = op != CMC_BITS_AND;                                                             \
+        bool keep_b = op == CMC_BITS_OR || op == CMC_BITS_XOR;                                        \
+        size_t i = 0, j = 0;                                                                          \
+                                                                                                      \
+        while (i < _set1_->length || j < _set2_->length)                                              \
+        {                                                                                             \
+            struct cmc_roaring_container *a = i < _set1_->length ? &_set1_->containers[i] : NULL;     \
+            struct cmc_roaring_container *b = j < _set2_->length ? &_set2_->containers[j] : NULL;     \
+            struct cmc_roaring_container c;                                                           \
+            bool ok = true;                                                                           \
+                                                                                                      \
+            c.cardinality = 0;                                                                        \
+                                                                                                      \
+            if (a && (!b || a->key < b->key))                                                         \
+            {                                                                                         \
+                if (keep_a)                                                                           \
+                    ok = cmc_roaring_container_copy(result->alloc, a, &c);                            \
+                i++;                                                                                  \
+            }                                                                                         \
+            else if (b && (!a || b->key < a->key))                                                    \
+            {                                                                                         \
+                if (keep_b)                                                                           \
+                    ok = cmc_roaring_container_copy(result->alloc, b, &c);                            \
+                j++;                                                                                  \
+            }                                                                                         \
+            else                                                                                      \
+            {                                                                                         \
+                ok = cmc_roaring_container_op(result->alloc, a, b, op, &c);                           \
+                i++;                                                                                  \
+                j++;                                                                                  \
+            }                                                                                         \
+                                                                                                      \
+            if (!ok)                                                                                  \
+            {                                                                                         \
+                PFX##_free(result);                                                                   \
+                return NULL;                                                                          \
+            }                                                                                         \
+                                                                                                      \
+            if (c.cardinality == 0)                                                                   \
+                continue;                                                                             \
+                                                                                                      \
+            if (!PFX##_impl_push(result, result->length, &c))                                         \
+            {                                                                                         \
+                cmc_roaring_container_free(result->alloc, &c);                                        \
+                PFX##_free(result);                                                                   \
+                return NULL;                                                                          \
+            }                                                                                         \
+                                                                                                      \
+            result->count += c.cardinality;                                                           \
+        }                                                                                             \
+                                                                                                      \
+        return result;                                                                                \
+    }                                                                                                 \
+                                                                                                      \
+    /* Exchanges the elements of two sets */                                                          \
+    static void PFX##_impl_swap(struct SNAME *_set1_, struct SNAME *_set2_)                           \
+    {                                                                                                 \
+        struct SNAME temp = *_set1_;                                                                  \
+                                                                                                      \
+        _set1_->containers = _set2_->containers;                                                      \
+        _set1_->length = _set2_->length;                                                              \
+        _set1_->capacity = _set2_->capacity;                                                          \
+        _set1_->count = _set2_->count;                                                                \
+                                                                                                      \
+        _set2_->containers = temp.containers;                                                         \
+        _set2_->length = temp.length;                                                                 \
+        _set2_->capacity = temp.capacity;                                                             \
+        _set2_->count = temp.count;                                                                   \
+    }                                                                                                 \
+                                                                                                      \
+    static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_set_)                               \
+    {                                                                                                 \
+        struct SNAME##_iter iter;                                                                     \
+                                                                                                      \
+        PFX##_iter_init(&iter, _set_);                                                                \
+        PFX##_iter_to_start(&iter);                                                                   \
+                                                                                                      \
+        return iter;                                                                                  \
+    }                                                                                                 \
+                                                                                                      \
+    static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_set_)                                 \
+    {                                                                                                 \
+        struct SNAME##_iter iter;                                                                     \
+                                                                                                      \
+        PFX##_iter_init(&iter, _set_);                                                                \
+        PFX##_iter_to_end(&iter);                                                                     \
+                                                                                                      \
+        return iter;                                                                                  \
+    }
+
+#endif /* CMC_ROARING_H */
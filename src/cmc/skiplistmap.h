@@ -0,0 +1,770 @@
+/**
+ * skiplistmap.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * SkipListMap
+ *
+ * A SkipListMap is a Map that keeps its keys sorted and that can be shared
+ * between threads, with the same functions as the TreeMap.
+ *
+ * Implementation
+ *
+ * This implementation uses a lazy skip list. Every node is linked in a sorted
+ * list at level 0 and in a random amount of the levels above it, each one with
+ * about a quarter of the nodes of the level below, so a search skips most
+ * nodes. Searches take no locks. An insertion locks only the nodes right
+ * before the new one, and a removal locks the removed node and the ones right
+ * before it. A removed node is marked before it is unlinked, so searches and
+ * iterators skip it.
+ *
+ * Iterators are weakly consistent: they go through the keys in ascending
+ * order and see each key that was in the map for the whole iteration, but
+ * might or might not see the keys that were inserted or removed while they
+ * were running.
+ *
+ * Threads that are searching might still be going through a removed node, so
+ * removed nodes are only freed by reclaim, clear and free, which must not run
+ * while other threads are using the map. Values are read and replaced with
+ * the lock of their node, since they can be of any type. Requires pthreads
+ * and C11 atomics.
+ */
+
+#ifndef CMC_SKIPLISTMAP_H
+#define CMC_SKIPLISTMAP_H
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_skiplistmap = "%s at %p { head:%p, count:%" PRIuMAX ", cmp:%p }";
+
+/* Maximum amount of levels of a node, enough for about 4^CMC_SKIPLIST_LEVELS */
+/* keys */
+#ifndef CMC_SKIPLIST_LEVELS
+#define CMC_SKIPLIST_LEVELS 24
+#endif
+
+#define CMC_GENERATE_SKIPLISTMAP(PFX, SNAME, K, V)    \
+    CMC_GENERATE_SKIPLISTMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_SKIPLISTMAP_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_SKIPLISTMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_SKIPLISTMAP_HEADER(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_SKIPLISTMAP_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_SKIPLISTMAP_SOURCE(PFX, SNAME, K, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_SKIPLISTMAP_HEADER(PFX, SNAME, K, V)                     \
+                                                                              \
+    /* SkipListMap Structure */                                               \
+    struct SNAME                                                              \
+    {                                                                         \
+        /* Node without a key before the first one, linked at every level */  \
+        struct SNAME##_node *head;                                            \
+                                                                              \
+        /* Current amount of keys */                                          \
+        atomic_size_t count;                                                  \
+                                                                              \
+        /* Removed nodes that were not freed yet, linked by their retired */  \
+        struct SNAME##_node *_Atomic retired;                                 \
+                                                                              \
+        /* Key comparison function */                                         \
+        int (*cmp)(K, K);                                                     \
+                                                                              \
+        /* Custom allocation functions */                                     \
+        struct cmc_alloc_node *alloc;                                         \
+    };                                                                        \
+                                                                              \
+    /* SkipListMap Node */                                                    \
+    struct SNAME##_node                                                       \
+    {                                                                         \
+        /* Node Key */                                                        \
+        K key;                                                                \
+                                                                              \
+        /* Node Value */                                                      \
+        V value;                                                              \
+                                                                              \
+        /* Protects the links that leave the node and its value */            \
+        pthread_mutex_t lock;                                                 \
+                                                                              \
+        /* If the key was removed, which happens before it is unlinked */     \
+        atomic_bool marked;                                                   \
+                                                                              \
+        /* If the node was linked at each one of its levels */                \
+        atomic_bool linked;                                                   \
+                                                                              \
+        /* Amount of levels that the node is linked at */                     \
+        size_t levels;                                                        \
+                                                                              \
+        /* Next removed node that was not freed yet */                        \
+        struct SNAME##_node *retired;                                         \
+                                                                              \
+        /* Next node at each level */                                         \
+        struct SNAME##_node *_Atomic next[];                                  \
+    };                                                                        \
+                                                                              \
+    /* SkipListMap Iterator, which goes forward through the keys */           \
+    struct SNAME##_iter                                                       \
+    {                                                                         \
+        /* Target skiplistmap */                                              \
+        struct SNAME *target;                                                 \
+                                                                              \
+        /* Cursor's current node or NULL at the end of the iteration */       \
+        struct SNAME##_node *cursor;                                          \
+                                                                              \
+        /* Keeps track of relative index to the iteration of elements */      \
+        size_t index;                                                         \
+    };                                                                        \
+                                                                              \
+    /* Collection Functions */                                                \
+    /* Collection Allocation and Deallocation */                              \
+    struct SNAME *PFX##_new(int (*compare)(K, K));                            \
+    struct SNAME *PFX##_new_custom(int (*compare)(K, K),                      \
+                                   struct cmc_alloc_node *alloc);             \
+    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V));         \
+    void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V));          \
+    void PFX##_reclaim(struct SNAME *_map_);                                  \
+    /* Collection Input and Output */                                         \
+    bool PFX##_insert(struct SNAME *_map_, K key, V value);                   \
+    bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value); \
+    bool PFX##_remove(struct SNAME *_map_, K key, V *out_value);              \
+    /* Element Access */                                                      \
+    bool PFX##_max(struct SNAME *_map_, K *key, V *value);                    \
+    bool PFX##_min(struct SNAME *_map_, K *key, V *value);                    \
+    V PFX##_get(struct SNAME *_map_, K key);                                  \
+    /* Collection State */                                                    \
+    bool PFX##_contains(struct SNAME *_map_, K key);                          \
+    bool PFX##_empty(struct SNAME *_map_);                                    \
+    size_t PFX##_count(struct SNAME *_map_);                                  \
+    size_t PFX##_memory_usage(struct SNAME *_map_);                           \
+    /* Collection Utility */                                                  \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_);                   \
+    bool PFX##_to_string_full(struct SNAME *_map_,                            \
+                              struct cmc_string_builder *builder,             \
+                              const char *elem_fmt);                          \
+    bool PFX##_write(struct SNAME *_map_, FILE *file,                         \
+                     void (*fmt)(FILE *, K, V));                              \
+    bool PFX##_write_fd(struct SNAME *_map_, int fd,                          \
+                        void (*fmt)(struct cmc_dump *, K, V));                \
+                                                                              \
+    /* Iterator Functions */                                                  \
+    /* Iterator Initialization */                                             \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);    \
+    /* Iterator State */                                                      \
+    bool PFX##_iter_end(struct SNAME##_iter *iter);                           \
+    /* Iterator Movement */                                                   \
+    bool PFX##_iter_next(struct SNAME##_iter *iter);                          \
+    /* Iterator Access */                                                     \
+    K PFX##_iter_key(struct SNAME##_iter *iter);                              \
+    V PFX##_iter_value(struct SNAME##_iter *iter);                            \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter);                       \
+                                                                              \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_SKIPLISTMAP_SOURCE(PFX, SNAME, K, V)                                        \
+                                                                                                 \
+    /* Implementation Detail Functions */                                                        \
+    static struct SNAME##_node *PFX##_impl_new_node(struct SNAME *_map_, K key, V value,         \
+                                                    size_t levels);                              \
+    static void PFX##_impl_free_node(struct SNAME *_map_, struct SNAME##_node *node);            \
+    static size_t PFX##_impl_random_levels(void);                                                \
+    static size_t PFX##_impl_find(struct SNAME *_map_, K key, struct SNAME##_node **preds,       \
+                                  struct SNAME##_node **succs);                                  \
+    static struct SNAME##_node *PFX##_impl_get_node(struct SNAME *_map_, K key);                 \
+    static struct SNAME##_node *PFX##_impl_next_node(struct SNAME##_node *node);                 \
+    static void PFX##_impl_unlock(struct SNAME##_node **preds, size_t levels);                   \
+    static V PFX##_impl_read_value(struct SNAME##_node *node);                                   \
+                                                                                                 \
+    struct SNAME *PFX##_new(int (*compare)(K, K))                                                \
+    {                                                                                            \
+        return PFX##_new_custom(compare, NULL);                                                  \
+    }                                                                                            \
+                                                                                                 \
+    struct SNAME *PFX##_new_custom(int (*compare)(K, K), struct cmc_alloc_node *alloc)           \
+    {                                                                                            \
+        if (!alloc)                                                                              \
+            alloc = &cmc_alloc_node_default;                                                     \
+                                                                                                 \
+        struct SNAME *_map_ = alloc->malloc(sizeof(struct SNAME));                               \
+                                                                                                 \
+        if (CMC_UNLIKELY(!_map_))                                                                \
+            return NULL;                                                                         \
+                                                                                                 \
+        _map_->alloc = alloc;                                                                    \
+                                                                                                 \
+        _map_->head = PFX##_impl_new_node(_map_, (K){ 0 }, (V){ 0 }, CMC_SKIPLIST_LEVELS);       \
+                                                                                                 \
+        if (!_map_->head)                                                                        \
+        {                                                                                        \
+            alloc->free(_map_);                                                                  \
+            return NULL;                                                                         \
+        }                                                                                        \
+                                                                                                 \
+        atomic_init(&(_map_->count), 0);                                                         \
+        atomic_init(&(_map_->retired), NULL);                                                    \
+                                                                                                 \
+        _map_->cmp = compare;                                                                    \
+                                                                                                 \
+        return _map_;                                                                            \
+    }                                                                                            \
+                                                                                                 \
+    /* Must not be called while other threads are using the map */                               \
+    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V))                             \
+    {                                                                                            \
+        struct SNAME##_node *scan = atomic_load(&(_map_->head->next[0]));                        \
+                                                                                                 \
+        while (scan != NULL)                                                                     \
+        {                                                                                        \
+            struct SNAME##_node *next = atomic_load(&(scan->next[0]));                           \
+                                                                                                 \
+            if (deallocator)                                                                     \
+                deallocator(scan->key, scan->value);                                             \
+                                                                                                 \
+            PFX##_impl_free_node(_map_, scan);                                                   \
+                                                                                                 \
+            scan = next;                                                                         \
+        }                                                                                        \
+                                                                                                 \
+        for (size_t i = 0; i < CMC_SKIPLIST_LEVELS; i++)                                         \
+            atomic_store(&(_map_->head->next[i]), NULL);                                         \
+                                                                                                 \
+        atomic_store(&(_map_->count), 0);                                                        \
+                                                                                                 \
+        PFX##_reclaim(_map_);                                                                    \
+    }                                                                                            \
+                                                                                                 \
+    /* Must not be called while other threads are using the map */                               \
+    void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V))                              \
+    {                                                                                            \
+        PFX##_clear(_map_, deallocator);                                                         \
+                                                                                                 \
+        PFX##_impl_free_node(_map_, _map_->head);                                                \
+                                                                                                 \
+        _map_->alloc->free(_map_);                                                               \
+    }                                                                                            \
+                                                                                                 \
+    /* Frees the nodes of the keys removed so far. Must not be called while */                   \
+    /* other threads are using the map */                                                        \
+    void PFX##_reclaim(struct SNAME *_map_)                                                      \
+    {                                                                                            \
+        struct SNAME##_node *scan = atomic_exchange(&(_map_->retired), NULL);                    \
+                                                                                                 \
+        while (scan != NULL)                                                                     \
+        {                                                                                        \
+            struct SNAME##_node *next = scan->retired;                                           \
+                                                                                                 \
+            PFX##_impl_free_node(_map_, scan);                                                   \
+                                                                                                 \
+            scan = next;                                                                         \
+        }                                                                                        \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_insert(struct SNAME *_map_, K key, V value)                                       \
+    {                                                                                            \
+        struct SNAME##_node *preds[CMC_SKIPLIST_LEVELS];                                         \
+        struct SNAME##_node *succs[CMC_SKIPLIST_LEVELS];                                         \
+        struct SNAME##_node *node = NULL;                                                        \
+                                                                                                 \
+        size_t levels = PFX##_impl_random_levels();                                              \
+                                                                                                 \
+        while (true)                                                                             \
+        {                                                                                        \
+            size_t found = PFX##_impl_find(_map_, key, preds, succs);                            \
+                                                                                                 \
+            if (found != CMC_SKIPLIST_LEVELS)                                                    \
+            {                                                                                    \
+                struct SNAME##_node *other = succs[found];                                       \
+                                                                                                 \
+                /* Otherwise the key is being removed and is searched again */                   \
+                if (!atomic_load(&(other->marked)))                                              \
+                {                                                                                \
+                    /* It is only in the map once it is linked */                                \
+                    while (!atomic_load(&(other->linked)))                                       \
+                        sched_yield();                                                           \
+                                                                                                 \
+                    if (node)                                                                    \
+                        PFX##_impl_free_node(_map_, node);                                       \
+                                                                                                 \
+                    return false;                                                                \
+                }                                                                                \
+                                                                                                 \
+                continue;                                                                        \
+            }                                                                                    \
+                                                                                                 \
+            if (!node)                                                                           \
+            {                                                                                    \
+                node = PFX##_impl_new_node(_map_, key, value, levels);                           \
+                                                                                                 \
+                if (!node)                                                                       \
+                    return false;                                                                \
+            }                                                                                    \
+                                                                                                 \
+            bool valid = true;                                                                   \
+            size_t locked = 0;                                                                   \
+                                                                                                 \
+            /* The nodes before it must still be in the map and linked to */                     \
+            /* the ones after it */                                                              \
+            for (size_t level = 0; valid && level < levels; level++)                             \
+            {                                                                                    \
+                struct SNAME##_node *pred = preds[level];                                        \
+                struct SNAME##_node *succ = succs[level];                                        \
+                                                                                                 \
+                if (level == 0 || pred != preds[level - 1])                                      \
+                    pthread_mutex_lock(&(pred->lock));                                           \
+                                                                                                 \
+                locked = level + 1;                                                              \
+                                                                                                 \
+                valid = !atomic_load(&(pred->marked)) &&                                         \
+                        (succ == NULL || !atomic_load(&(succ->marked))) &&                       \
+                        atomic_load(&(pred->next[level])) == succ;                               \
+            }                                                                                    \
+                                                                                                 \
+            if (!valid)                                                                          \
+            {                                                                                    \
+                PFX##_impl_unlock(preds, locked);                                                \
+                continue;                                                                        \
+            }                                                                                    \
+                                                                                                 \
+            for (size_t level = 0; level < levels; level++)                                      \
+                atomic_store_explicit(&(node->next[level]), succs[level], memory_order_relaxed); \
+                                                                                                 \
+            for (size_t level = 0; level < levels; level++)                                      \
+                atomic_store_explicit(&(preds[level]->next[level]), node, memory_order_release); \
+                                                                                                 \
+            atomic_store(&(node->linked), true);                                                 \
+                                                                                                 \
+            PFX##_impl_unlock(preds, locked);                                                    \
+                                                                                                 \
+            atomic_fetch_add_explicit(&(_map_->count), 1, memory_order_relaxed);                 \
+                                                                                                 \
+            return true;                                                                         \
+        }                                                                                        \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value)                     \
+    {                                                                                            \
+        struct SNAME##_node *node = PFX##_impl_get_node(_map_, key);                             \
+                                                                                                 \
+        if (!node)                                                                               \
+            return false;                                                                        \
+                                                                                                 \
+        pthread_mutex_lock(&(node->lock));                                                       \
+                                                                                                 \
+        bool removed = atomic_load(&(node->marked));                                             \
+                                                                                                 \
+        if (!removed)                                                                            \
+        {                                                                                        \
+            if (old_value)                                                                       \
+                *old_value = node->value;                                                        \
+                                                                                                 \
+            node->value = new_value;                                                             \
+        }                                                                                        \
+                                                                                                 \
+        pthread_mutex_unlock(&(node->lock));                                                     \
+                                                                                                 \
+        return !removed;                                                                         \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_remove(struct SNAME *_map_, K key, V *out_value)                                  \
+    {                                                                                            \
+        struct SNAME##_node *preds[CMC_SKIPLIST_LEVELS];                                         \
+        struct SNAME##_node *succs[CMC_SKIPLIST_LEVELS];                                         \
+        struct SNAME##_node *victim = NULL;                                                      \
+                                                                                                 \
+        V value = (V){ 0 };                                                                      \
+                                                                                                 \
+        while (true)                                                                             \
+        {                                                                                        \
+            size_t found = PFX##_impl_find(_map_, key, preds, succs);                            \
+                                                                                                 \
+            /* The key is marked once and then unlinked by this thread */                        \
+            if (!victim)                                                                         \
+            {                                                                                    \
+                if (found == CMC_SKIPLIST_LEVELS)                                                \
+                    return false;                                                                \
+                                                                                                 \
+                struct SNAME##_node *node = succs[found];                                        \
+                                                                                                 \
+                /* A node that is not linked yet is not in the map */                            \
+                if (!atomic_load(&(node->linked)) || node->levels - 1 != found)                  \
+                    return false;                                                                \
+                                                                                                 \
+                pthread_mutex_lock(&(node->lock));                                               \
+                                                                                                 \
+                if (atomic_load(&(node->marked)))                                                \
+                {                                                                                \
+                    pthread_mutex_unlock(&(node->lock));                                         \
+                    return false;                                                                \
+                }                                                                                \
+                                                                                                 \
+                atomic_store(&(node->marked), true);                                             \
+                                                                                                 \
+                value = node->value;                                                             \
+                victim = node;                                                                   \
+            }                                                                                    \
+                                                                                                 \
+            bool valid = true;                                                                   \
+            size_t locked = 0;                                                                   \
+                                                                                                 \
+            for (size_t level = 0; valid && level < victim->levels; level++)                     \
+            {                                                                                    \
+                struct SNAME##_node *pred = preds[level];                                        \
+                                                                                                 \
+                if (level == 0 || pred != preds[level - 1])                                      \
+                    pthread_mutex_lock(&(pred->lock));                                           \
+                                                                                                 \
+                locked = level + 1;                                                              \
+                                                                                                 \
+                valid = !atomic_load(&(pred->marked)) &&                                         \
+                        atomic_load(&(pred->next[level])) == victim;                             \
+            }                                                                                    \
+                                                                                                 \
+            if (!valid)                                                                          \
+            {                                                                                    \
+                PFX##_impl_unlock(preds, locked);                                                \
+                continue;                                                                        \
+            }                                                                                    \
+                                                                                                 \
+            for (size_t level = victim->levels; level > 0; level--)                              \
+            {                                                                                    \
+                struct SNAME##_node *next = atomic_load(&(victim->next[level - 1]));             \
+                                                                                                 \
+                atomic_store_explicit(&(preds[level - 1]->next[level - 1]), next,                \
+                                      memory_order_release);                                     \
+            }                                                                                    \
+                                                                                                 \
+            pthread_mutex_unlock(&(victim->lock));                                               \
+                                                                                                 \
+            PFX##_impl_unlock(preds, locked);                                                    \
+                                                                                                 \
+            /* Searches that are going through it can still follow its links */                  \
+            victim->retired = atomic_load(&(_map_->retired));                                    \
+                                                                                                 \
+            while (!atomic_compare_exchange_weak(&(_map_->retired), &(victim->retired), victim)) \
+                ;                                                                                \
+                                                                                                 \
+            atomic_fetch_sub_explicit(&(_map_->count), 1, memory_order_relaxed);                 \
+                                                                                                 \
+            if (out_value)                                                                       \
+                *out_value = value;                                                              \
+                                                                                                 \
+            return true;                                                                         \
+        }                                                                                        \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_max(struct SNAME *_map_, K *key, V *value)                                        \
+    {                                                                                            \
+        struct SNAME##_node *scan = _map_->head;                                                 \
+        struct SNAME##_node *last = NULL;                                                        \
+                                                                                                 \
+        /* Goes as far as possible at each level, from the top one */                            \
+        for (size_t level = CMC_SKIPLIST_LEVELS; level > 0; level--)                             \
+        {                                                                                        \
+            struct SNAME##_node *next = atomic_load(&(scan->next[level - 1]));                   \
+                                                                                                 \
+            for (; next != NULL; next = atomic_load(&(scan->next[level - 1])))                   \
+            {                                                                                    \
+                scan = next;                                                                     \
+                                                                                                 \
+                if (!atomic_load(&(scan->marked)))                                               \
+                    last = scan;                                                                 \
+            }                                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        if (!last)                                                                               \
+            return false;                                                                        \
+                                                                                                 \
+        if (key)                                                                                 \
+            *key = last->key;                                                                    \
+        if (value)                                                                               \
+            *value = PFX##_impl_read_value(last);                                                \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_min(struct SNAME *_map_, K *key, V *value)                                        \
+    {                                                                                            \
+        struct SNAME##_node *first = PFX##_impl_next_node(_map_->head);                          \
+                                                                                                 \
+        if (!first)                                                                              \
+            return false;                                                                        \
+                                                                                                 \
+        if (key)                                                                                 \
+            *key = first->key;                                                                   \
+        if (value)                                                                               \
+            *value = PFX##_impl_read_value(first);                                               \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    V PFX##_get(struct SNAME *_map_, K key)                                                      \
+    {                                                                                            \
+        struct SNAME##_node *node = PFX##_impl_get_node(_map_, key);                             \
+                                                                                                 \
+        if (!node)                                                                               \
+            return (V){ 0 };                                                                     \
+                                                                                                 \
+        return PFX##_impl_read_value(node);                                                      \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_contains(struct SNAME *_map_, K key)                                              \
+    {                                                                                            \
+        return PFX##_impl_get_node(_map_, key) != NULL;                                          \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_empty(struct SNAME *_map_)                                                        \
+    {                                                                                            \
+        return PFX##_count(_map_) == 0;                                                          \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_count(struct SNAME *_map_)                                                      \
+    {                                                                                            \
+        return atomic_load_explicit(&(_map_->count), memory_order_relaxed);                      \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_memory_usage(struct SNAME *_map_)                                               \
+    {                                                                                            \
+        /* Exact only while no other thread modifies the map */                                  \
+        size_t bytes = sizeof(struct SNAME);                                                     \
+        size_t link = sizeof(struct SNAME##_node *_Atomic);                                      \
+        struct SNAME##_node *node = _map_->head;                                                 \
+                                                                                                 \
+        while (node)                                                                             \
+        {                                                                                        \
+            bytes += sizeof(struct SNAME##_node) + link * node->levels;                          \
+            node = atomic_load(&(node->next[0]));                                                \
+        }                                                                                        \
+                                                                                                 \
+        for (node = atomic_load(&(_map_->retired)); node; node = node->retired)                  \
+            bytes += sizeof(struct SNAME##_node) + link * node->levels;                          \
+                                                                                                 \
+        return bytes;                                                                            \
+    }                                                                                            \
+                                                                                                 \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_)                                       \
+    {                                                                                            \
+        struct cmc_string str;                                                                   \
+        struct SNAME *m_ = _map_;                                                                \
+        const char *name = #SNAME;                                                               \
+                                                                                                 \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_skiplistmap,                              \
+                 name, m_, m_->head, PFX##_count(m_), m_->cmp);                                  \
+                                                                                                 \
+        return str;                                                                              \
+    }                                                                                            \
+                                                                                                 \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_ENTRY)                               \
+                                                                                                 \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_ENTRY, (K, V))                              \
+                                                                                                 \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                        \
+    {                                                                                            \
+        iter->target = target;                                                                   \
+        iter->cursor = PFX##_impl_next_node(target->head);                                       \
+        iter->index = 0;                                                                         \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                               \
+    {                                                                                            \
+        return iter->cursor == NULL;                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Returns false only if the iterator had already reached the end */                         \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                              \
+    {                                                                                            \
+        if (iter->cursor == NULL)                                                                \
+            return false;                                                                        \
+                                                                                                 \
+        iter->cursor = PFX##_impl_next_node(iter->cursor);                                       \
+        iter->index++;                                                                           \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    K PFX##_iter_key(struct SNAME##_iter *iter)                                                  \
+    {                                                                                            \
+        if (iter->cursor == NULL)                                                                \
+            return (K){ 0 };                                                                     \
+                                                                                                 \
+        return iter->cursor->key;                                                                \
+    }                                                                                            \
+                                                                                                 \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                                \
+    {                                                                                            \
+        if (iter->cursor == NULL)                                                                \
+            return (V){ 0 };                                                                     \
+                                                                                                 \
+        return PFX##_impl_read_value(iter->cursor);                                              \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                           \
+    {                                                                                            \
+        return iter->index;                                                                      \
+    }                                                                                            \
+                                                                                                 \
+    static struct SNAME##_node *PFX##_impl_new_node(struct SNAME *_map_, K key, V value,         \
+                                                    size_t levels)                               \
+    {                                                                                            \
+        size_t links = sizeof(struct SNAME##_node *_Atomic) * levels;                            \
+                                                                                                 \
+        struct SNAME##_node *node = _map_->alloc->malloc(sizeof(struct SNAME##_node) + links);   \
+                                                                                                 \
+        if (CMC_UNLIKELY(!node))                                                                 \
+            return NULL;                                                                         \
+                                                                                                 \
+        if (pthread_mutex_init(&(node->lock), NULL) != 0)                                        \
+        {                                                                                        \
+            _map_->alloc->free(node);                                                            \
+            return NULL;                                                                         \
+        }                                                                                        \
+                                                                                                 \
+        node->key = key;                                                                         \
+        node->value = value;                                                                     \
+        node->levels = levels;                                                                   \
+        node->retired = NULL;                                                                    \
+                                                                                                 \
+        atomic_init(&(node->marked), false);                                                     \
+        atomic_init(&(node->linked), false);                                                     \
+                                                                                                 \
+        for (size_t i = 0; i < levels; i++)                                                      \
+            atomic_init(&(node->next[i]), NULL);                                                 \
+                                                                                                 \
+        return node;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    static void PFX##_impl_free_node(struct SNAME *_map_, struct SNAME##_node *node)             \
+    {                                                                                            \
+        pthread_mutex_destroy(&(node->lock));                                                    \
+                                                                                                 \
+        _map_->alloc->free(node);                                                                \
+    }                                                                                            \
+                                                                                                 \
+    /* Each level gets a quarter of the nodes of the level below. The state */                   \
+    /* of each thread starts from the address of its own copy of it */                           \
+    static size_t PFX##_impl_random_levels(void)                                                 \
+    {                                                                                            \
+        static _Thread_local uint64_t state = 0;                                                 \
+                                                                                                 \
+        if (state == 0)                                                                          \
+            state = ((uint64_t)(uintptr_t)&state * UINT64_C(0x9E3779B97F4A7C15)) | 1;            \
+                                                                                                 \
+        state ^= state << 13;                                                                    \
+        state ^= state >> 7;                                                                     \
+        state ^= state << 17;                                                                    \
+                                                                                                 \
+        uint64_t bits = state;                                                                   \
+        size_t levels = 1;                                                                       \
+                                                                                                 \
+        while (levels < CMC_SKIPLIST_LEVELS && (bits & 3) == 0)                                  \
+        {                                                                                        \
+            levels++;                                                                            \
+            bits >>= 2;                                                                          \
+        }                                                                                        \
+                                                                                                 \
+        return levels;                                                                           \
+    }                                                                                            \
+                                                                                                 \
+    /* Fills preds and succs with the last node before key and the first one */                  \
+    /* after it at each level. Returns the highest level the key was found */                    \
+    /* at, or CMC_SKIPLIST_LEVELS if it was not */                                               \
+    static size_t PFX##_impl_find(struct SNAME *_map_, K key, struct SNAME##_node **preds,       \
+                                  struct SNAME##_node **succs)                                   \
+    {                                                                                            \
+        struct SNAME##_node *pred = _map_->head;                                                 \
+                                                                                                 \
+        size_t found = CMC_SKIPLIST_LEVELS;                                                      \
+                                                                                                 \
+        for (size_t level = CMC_SKIPLIST_LEVELS; level > 0; level--)                             \
+        {                                                                                        \
+            struct SNAME##_node *curr =                                                          \
+                atomic_load_explicit(&(pred->next[level - 1]), memory_order_acquire);            \
+                                                                                                 \
+            int c = 1;                                                                           \
+                                                                                                 \
+            while (curr != NULL && (c = _map_->cmp(curr->key, key)) < 0)                         \
+            {                                                                                    \
+                pred = curr;                                                                     \
+                curr = atomic_load_explicit(&(pred->next[level - 1]), memory_order_acquire);     \
+            }                                                                                    \
+                                                                                                 \
+            if (found == CMC_SKIPLIST_LEVELS && curr != NULL && c == 0)                          \
+                found = level - 1;                                                               \
+                                                                                                 \
+            preds[level - 1] = pred;                                                             \
+            succs[level - 1] = curr;                                                             \
+        }                                                                                        \
+                                                                                                 \
+        return found;                                                                            \
+    }                                                                                            \
+                                                                                                 \
+    /* The node of a key that is in the map */                                                   \
+    static struct SNAME##_node *PFX##_impl_get_node(struct SNAME *_map_, K key)                  \
+    {                                                                                            \
+        struct SNAME##_node *preds[CMC_SKIPLIST_LEVELS];                                         \
+        struct SNAME##_node *succs[CMC_SKIPLIST_LEVELS];                                         \
+                                                                                                 \
+        size_t found = PFX##_impl_find(_map_, key, preds, succs);                                \
+                                                                                                 \
+        if (found == CMC_SKIPLIST_LEVELS)                                                        \
+            return NULL;                                                                         \
+                                                                                                 \
+        struct SNAME##_node *node = succs[found];                                                \
+                                                                                                 \
+        if (!atomic_load(&(node->linked)) || atomic_load(&(node->marked)))                       \
+            return NULL;                                                                         \
+                                                                                                 \
+        return node;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* The first node after node at level 0 that was not removed */                              \
+    static struct SNAME##_node *PFX##_impl_next_node(struct SNAME##_node *node)                  \
+    {                                                                                            \
+        struct SNAME##_node *scan =                                                              \
+            atomic_load_explicit(&(node->next[0]), memory_order_acquire);                        \
+                                                                                                 \
+        while (scan != NULL && atomic_load(&(scan->marked)))                                     \
+            scan = atomic_load_explicit(&(scan->next[0]), memory_order_acquire);                 \
+                                                                                                 \
+        return scan;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* The same node can be before the new or removed one at many levels, */                     \
+    /* but it is locked only once */                                                             \
+    static void PFX##_impl_unlock(struct SNAME##_node **preds, size_t levels)                    \
+    {                                                                                            \
+        for (size_t level = 0; level < levels; level++)                                          \
+        {                                                                                        \
+            if (level == 0 || preds[level] != preds[level - 1])                                  \
+                pthread_mutex_unlock(&(preds[level]->lock));                                     \
+        }                                                                                        \
+    }                                                                                            \
+                                                                                                 \
+    static V PFX##_impl_read_value(struct SNAME##_node *node)                                    \
+    {                                                                                            \
+        pthread_mutex_lock(&(node->lock));                                                       \
+                                                                                                 \
+        V value = node->value;                                                                   \
+                                                                                                 \
+        pthread_mutex_unlock(&(node->lock));                                                     \
+                                                                                                 \
+        return value;                                                                            \
+    }
+
+#endif /* CMC_SKIPLISTMAP_H */
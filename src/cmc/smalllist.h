@@ -0,0 +1,776 @@
+/**
+ * smalllist.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * SmallList
+ *
+ * A SmallList is a List that keeps up to N elements inside of its own struct
+ * and only allocates a buffer once it has more than that. It is meant for the
+ * many short lists of a program, like the children of the nodes of a tree, where
+ * most lists never grow past a handful of elements and a List would allocate
+ * its struct and its buffer for each of them.
+ *
+ * A SmallList can be allocated by new, like a List, or be a member of another
+ * struct or a local variable, initialized by init and emptied by release. In
+ * the latter case it allocates nothing until it has more than N elements.
+ *
+ * Implementation
+ *
+ * The inline elements and the pointer to the buffer share the same memory, and
+ * which one is in use is told by the capacity, which is N while the elements
+ * are inline. Since the struct has no pointers into itself, it can be moved to
+ * another address, as when the array it is in is reallocated.
+ *
+ * When full, the capacity grows like the one of a List. Once removals leave a
+ * buffer mostly empty it is halved, and when N elements are enough they are
+ * moved back inline and the buffer is freed.
+ *
+ * The functions are the same as the ones of List, except for the sequences,
+ * the parallel functions and serialization. There are no it_start and it_end
+ * members, which would take space in every list.
+ */
+
+#ifndef CMC_SMALLLIST_H
+#define CMC_SMALLLIST_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_growth.h"
+#include "../utl/cmc_sort.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_smalllist = "%s at %p { buffer:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", inline:%s }";
+
+/* A removal shrinks a collection once less than this fraction of what it */
+/* can hold without growing is in use. Define it as 0 to never shrink */
+#ifndef CMC_SHRINK_LOW_WATER
+#define CMC_SHRINK_LOW_WATER 0.25
+#endif
+
+/* N is the amount of elements kept inline and must be at least 1 */
+#define CMC_GENERATE_SMALLLIST(PFX, SNAME, V, N)    \
+    CMC_GENERATE_SMALLLIST_HEADER(PFX, SNAME, V, N) \
+    CMC_GENERATE_SMALLLIST_SOURCE(PFX, SNAME, V, N)
+
+/* The amount of inline elements is given as K */
+#define CMC_WRAPGEN_SMALLLIST_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_SMALLLIST_HEADER(PFX, SNAME, V, K)
+
+#define CMC_WRAPGEN_SMALLLIST_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_SMALLLIST_SOURCE(PFX, SNAME, V, K)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_SMALLLIST_HEADER(PFX, SNAME, V, N)                                       \
+                                                                                              \
+    /* SmallList Structure */                                                                 \
+    struct SNAME                                                                              \
+    {                                                                                         \
+        /* Current amount of elements */                                                      \
+        size_t count;                                                                         \
+                                                                                              \
+        /* N while the elements are inline, otherwise the capacity of buffer */               \
+        size_t capacity;                                                                      \
+                                                                                              \
+        /* Custom allocation functions */                                                     \
+        struct cmc_alloc_node *alloc;                                                         \
+                                                                                              \
+        union                                                                                 \
+        {                                                                                     \
+            /* Elements once there are more than N of them */                                 \
+            V *buffer;                                                                        \
+                                                                                              \
+            /* Elements while there are up to N of them */                                    \
+            V local[N];                                                                       \
+        } storage;                                                                            \
+    };                                                                                        \
+                                                                                              \
+    /* SmallList Iterator */                                                                  \
+    struct SNAME##_iter                                                                       \
+    {                                                                                         \
+        /* Target list */                                                                     \
+        struct SNAME *target;                                                                 \
+                                                                                              \
+        /* Cursor's position (index) */                                                       \
+        size_t cursor;                                                                        \
+                                                                                              \
+        /* If the iterator has reached the start of the iteration */                          \
+        bool start;                                                                           \
+                                                                                              \
+        /* If the iterator has reached the end of the iteration */                            \
+        bool end;                                                                             \
+    };                                                                                        \
+                                                                                              \
+    /* Collection Functions */                                                                \
+    /* Collection Allocation and Deallocation */                                              \
+    struct SNAME *PFX##_new(size_t capacity);                                                 \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc);            \
+    void PFX##_init(struct SNAME *_list_, struct cmc_alloc_node *alloc);                      \
+    void PFX##_clear(struct SNAME *_list_, void (*deallocator)(V));                           \
+    void PFX##_release(struct SNAME *_list_, void (*deallocator)(V));                         \
+    void PFX##_free(struct SNAME *_list_, void (*deallocator)(V));                            \
+    /* Collection Input and Output */                                                         \
+    bool PFX##_push_front(struct SNAME *_list_, V element);                                   \
+    bool PFX##_push_at(struct SNAME *_list_, V element, size_t index);                        \
+    bool PFX##_push_back(struct SNAME *_list_, V element);                                    \
+    bool PFX##_pop_front(struct SNAME *_list_);                                               \
+    bool PFX##_pop_at(struct SNAME *_list_, size_t index);                                    \
+    bool PFX##_pop_back(struct SNAME *_list_);                                                \
+    /* Element Access */                                                                      \
+    V PFX##_front(struct SNAME *_list_);                                                      \
+    V PFX##_get(struct SNAME *_list_, size_t index);                                          \
+    V *PFX##_get_ref(struct SNAME *_list_, size_t index);                                     \
+    V PFX##_back(struct SNAME *_list_);                                                       \
+    V *PFX##_data(struct SNAME *_list_);                                                      \
+    size_t PFX##_indexof(struct SNAME *_list_, V element, int (*comparator)(V, V),            \
+                         bool from_start);                                                    \
+    /* Collection State */                                                                    \
+    bool PFX##_contains(struct SNAME *_list_, V element, int (*comparator)(V, V));            \
+    CMC_PURE bool PFX##_empty(struct SNAME *_list_);                                          \
+    bool PFX##_full(struct SNAME *_list_);                                                    \
+    bool PFX##_is_inline(struct SNAME *_list_);                                               \
+    CMC_PURE size_t PFX##_count(struct SNAME *_list_);                                        \
+    size_t PFX##_memory_usage(struct SNAME *_list_);                                          \
+    bool PFX##_fits(struct SNAME *_list_, size_t size);                                       \
+    size_t PFX##_capacity(struct SNAME *_list_);                                              \
+    /* Collection Utility */                                                                  \
+    bool PFX##_resize(struct SNAME *_list_, size_t capacity);                                 \
+    bool PFX##_shrink_to_fit(struct SNAME *_list_);                                           \
+    bool PFX##_reserve(struct SNAME *_list_, size_t capacity);                                \
+    void PFX##_sort(struct SNAME *_list_, int (*comparator)(V, V));                           \
+    struct SNAME *PFX##_copy_of(struct SNAME *_list_, V (*copy_func)(V));                     \
+    size_t PFX##_to_array(struct SNAME *_list_, V *CMC_RESTRICT elements, size_t size);       \
+    bool PFX##_equals(struct SNAME *_list1_, struct SNAME *_list2_, int (*comparator)(V, V)); \
+    struct cmc_string PFX##_to_string(struct SNAME *_list_);                                  \
+    bool PFX##_to_string_full(struct SNAME *_list_, struct cmc_string_builder *builder,       \
+                              const char *elem_fmt);                                          \
+    bool PFX##_write(struct SNAME *_list_, FILE *file, void (*fmt)(FILE *, V));               \
+    bool PFX##_write_fd(struct SNAME *_list_, int fd, void (*fmt)(struct cmc_dump *, V));     \
+                                                                                              \
+    /* Iterator Functions */                                                                  \
+    /* Iterator Allocation and Deallocation */                                                \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target);                                \
+    void PFX##_iter_free(struct SNAME##_iter *iter);                                          \
+    /* Iterator Initialization */                                                             \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);                    \
+    /* Iterator State */                                                                      \
+    bool PFX##_iter_start(struct SNAME##_iter *iter);                                         \
+    bool PFX##_iter_end(struct SNAME##_iter *iter);                                           \
+    /* Iterator Movement */                                                                   \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter);                                      \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter);                                        \
+    bool PFX##_iter_next(struct SNAME##_iter *iter);                                          \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter);                                          \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps);                         \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps);                          \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index);                           \
+    /* Iterator Access */                                                                     \
+    V PFX##_iter_value(struct SNAME##_iter *iter);                                            \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter);                                          \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter);                                       \
+                                                                                              \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_SMALLLIST_SOURCE(PFX, SNAME, V, N)                                         \
+                                                                                                \
+    /* Implementation Detail Functions */                                                       \
+    static void PFX##_impl_low_water(struct SNAME *_list_);                                     \
+    static bool PFX##_impl_grow(struct SNAME *_list_, size_t required);                         \
+                                                                                                \
+    CMC_GENERATE_SORT(PFX##_impl_sort, V, int (*comparator)(V, V), comparator, comparator)      \
+                                                                                                \
+    struct SNAME *PFX##_new(size_t capacity)                                                    \
+    {                                                                                           \
+        return PFX##_new_custom(capacity, NULL);                                                \
+    }                                                                                           \
+                                                                                                \
+    /* The elements are inline unless capacity is greater than N */                             \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc)               \
+    {                                                                                           \
+        if (!alloc)                                                                             \
+            alloc = &cmc_alloc_node_default;                                                    \
+                                                                                                \
+        struct SNAME *_list_ = alloc->malloc(sizeof(struct SNAME));                             \
+                                                                                                \
+        if (CMC_UNLIKELY(!_list_))                                                              \
+            return NULL;                                                                        \
+                                                                                                \
+        PFX##_init(_list_, alloc);                                                              \
+                                                                                                \
+        if (CMC_UNLIKELY(!PFX##_reserve(_list_, capacity)))                                     \
+        {                                                                                       \
+            alloc->free(_list_);                                                                \
+            return NULL;                                                                        \
+        }                                                                                       \
+                                                                                                \
+        return _list_;                                                                          \
+    }                                                                                           \
+                                                                                                \
+    /* Initializes a list that is not allocated by new, like one that is a */                   \
+    /* member of another struct. It is emptied by release instead of free */                    \
+    void PFX##_init(struct SNAME *_list_, struct cmc_alloc_node *alloc)                         \
+    {                                                                                           \
+        if (!alloc)                                                                             \
+            alloc = &cmc_alloc_node_default;                                                    \
+                                                                                                \
+        _list_->count = 0;                                                                      \
+        _list_->capacity = N;                                                                   \
+        _list_->alloc = alloc;                                                                  \
+                                                                                                \
+        memset(&(_list_->storage), 0, sizeof(_list_->storage));                                 \
+    }                                                                                           \
+                                                                                                \
+    void PFX##_clear(struct SNAME *_list_, void (*deallocator)(V))                              \
+    {                                                                                           \
+        V *buffer = PFX##_data(_list_);                                                         \
+                                                                                                \
+        if (deallocator)                                                                        \
+        {                                                                                       \
+            for (size_t i = 0; i < _list_->count; i++)                                          \
+                deallocator(buffer[i]);                                                         \
+        }                                                                                       \
+                                                                                                \
+        memset(buffer, 0, sizeof(V) * _list_->count);                                           \
+                                                                                                \
+        _list_->count = 0;                                                                      \
+    }                                                                                           \
+                                                                                                \
+    /* Same as clear but also frees the buffer, so the elements are inline */                   \
+    /* again. The list can still be used afterwards */                                          \
+    void PFX##_release(struct SNAME *_list_, void (*deallocator)(V))                            \
+    {                                                                                           \
+        PFX##_clear(_list_, deallocator);                                                       \
+                                                                                                \
+        if (!PFX##_is_inline(_list_))                                                           \
+            _list_->alloc->free(_list_->storage.buffer);                                        \
+                                                                                                \
+        PFX##_init(_list_, _list_->alloc);                                                      \
+    }                                                                                           \
+                                                                                                \
+    void PFX##_free(struct SNAME *_list_, void (*deallocator)(V))                               \
+    {                                                                                           \
+        PFX##_release(_list_, deallocator);                                                     \
+                                                                                                \
+        _list_->alloc->free(_list_);                                                            \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_push_front(struct SNAME *_list_, V element)                                      \
+    {                                                                                           \
+        return PFX##_push_at(_list_, element, 0);                                               \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_push_at(struct SNAME *_list_, V element, size_t index)                           \
+    {                                                                                           \
+        if (index > _list_->count)                                                              \
+            return false;                                                                       \
+                                                                                                \
+        if (PFX##_full(_list_))                                                                 \
+        {                                                                                       \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_list_, _list_->count + 1)))                      \
+                return false;                                                                   \
+        }                                                                                       \
+                                                                                                \
+        V *buffer = PFX##_data(_list_);                                                         \
+                                                                                                \
+        memmove(buffer + index + 1, buffer + index, (_list_->count - index) * sizeof(V));       \
+                                                                                                \
+        buffer[index] = element;                                                                \
+        _list_->count++;                                                                        \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_push_back(struct SNAME *_list_, V element)                                       \
+    {                                                                                           \
+        if (PFX##_full(_list_))                                                                 \
+        {                                                                                       \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_list_, _list_->count + 1)))                      \
+                return false;                                                                   \
+        }                                                                                       \
+                                                                                                \
+        PFX##_data(_list_)[_list_->count++] = element;                                          \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_pop_front(struct SNAME *_list_)                                                  \
+    {                                                                                           \
+        return PFX##_pop_at(_list_, 0);                                                         \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_pop_at(struct SNAME *_list_, size_t index)                                       \
+    {                                                                                           \
+        if (index >= _list_->count)                                                             \
+            return false;                                                                       \
+                                                                                                \
+        V *buffer = PFX##_data(_list_);                                                         \
+                                                                                                \
+        memmove(buffer + index, buffer + index + 1, (_list_->count - index - 1) * sizeof(V));   \
+                                                                                                \
+        buffer[--_list_->count] = (V){0};                                                       \
+                                                                                                \
+        PFX##_impl_low_water(_list_);                                                           \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_pop_back(struct SNAME *_list_)                                                   \
+    {                                                                                           \
+        if (PFX##_empty(_list_))                                                                \
+            return false;                                                                       \
+                                                                                                \
+        PFX##_data(_list_)[--_list_->count] = (V){0};                                           \
+                                                                                                \
+        PFX##_impl_low_water(_list_);                                                           \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    V PFX##_front(struct SNAME *_list_)                                                         \
+    {                                                                                           \
+        if (PFX##_empty(_list_))                                                                \
+            return (V){0};                                                                      \
+                                                                                                \
+        return PFX##_data(_list_)[0];                                                           \
+    }                                                                                           \
+                                                                                                \
+    V PFX##_get(struct SNAME *_list_, size_t index)                                             \
+    {                                                                                           \
+        if (index >= _list_->count)                                                             \
+            return (V){0};                                                                      \
+                                                                                                \
+        return PFX##_data(_list_)[index];                                                       \
+    }                                                                                           \
+                                                                                                \
+    V *PFX##_get_ref(struct SNAME *_list_, size_t index)                                        \
+    {                                                                                           \
+        if (index >= _list_->count)                                                             \
+            return NULL;                                                                        \
+                                                                                                \
+        return &(PFX##_data(_list_)[index]);                                                    \
+    }                                                                                           \
+                                                                                                \
+    V PFX##_back(struct SNAME *_list_)                                                          \
+    {                                                                                           \
+        if (PFX##_empty(_list_))                                                                \
+            return (V){0};                                                                      \
+                                                                                                \
+        return PFX##_data(_list_)[_list_->count - 1];                                           \
+    }                                                                                           \
+                                                                                                \
+    /* The elements, contiguous wherever they are. The pointer is valid */                      \
+    /* until the list is modified or moved */                                                   \
+    V *PFX##_data(struct SNAME *_list_)                                                         \
+    {                                                                                           \
+        return PFX##_is_inline(_list_) ? _list_->storage.local : _list_->storage.buffer;        \
+    }                                                                                           \
+                                                                                                \
+    size_t PFX##_indexof(struct SNAME *_list_, V element, int (*comparator)(V, V),              \
+                         bool from_start)                                                       \
+    {                                                                                           \
+        V *buffer = PFX##_data(_list_);                                                         \
+                                                                                                \
+        if (from_start)                                                                         \
+        {                                                                                       \
+            for (size_t i = 0; i < _list_->count; i++)                                          \
+            {                                                                                   \
+                if (comparator(buffer[i], element) == 0)                                        \
+                    return i;                                                                   \
+            }                                                                                   \
+        }                                                                                       \
+        else                                                                                    \
+        {                                                                                       \
+            for (size_t i = _list_->count; i > 0; i--)                                          \
+            {                                                                                   \
+                if (comparator(buffer[i - 1], element) == 0)                                    \
+                    return i - 1;                                                               \
+            }                                                                                   \
+        }                                                                                       \
+                                                                                                \
+        return _list_->count;                                                                   \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_contains(struct SNAME *_list_, V element, int (*comparator)(V, V))               \
+    {                                                                                           \
+        return PFX##_indexof(_list_, element, comparator, true) != _list_->count;               \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_empty(struct SNAME *_list_)                                                      \
+    {                                                                                           \
+        return _list_->count == 0;                                                              \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_full(struct SNAME *_list_)                                                       \
+    {                                                                                           \
+        return _list_->count >= _list_->capacity;                                               \
+    }                                                                                           \
+                                                                                                \
+    /* If the elements are kept in the struct and no buffer is allocated */                     \
+    bool PFX##_is_inline(struct SNAME *_list_)                                                  \
+    {                                                                                           \
+        return _list_->capacity <= N;                                                           \
+    }                                                                                           \
+                                                                                                \
+    /* The struct, which has the inline elements, and the buffer if any */                      \
+    size_t PFX##_memory_usage(struct SNAME *_list_)                                             \
+    {                                                                                           \
+        if (PFX##_is_inline(_list_))                                                            \
+            return sizeof(struct SNAME);                                                        \
+                                                                                                \
+        return sizeof(struct SNAME) + sizeof(V) * _list_->capacity;                             \
+    }                                                                                           \
+                                                                                                \
+    size_t PFX##_count(struct SNAME *_list_)                                                    \
+    {                                                                                           \
+        return _list_->count;                                                                   \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_fits(struct SNAME *_list_, size_t size)                                          \
+    {                                                                                           \
+        return _list_->count + size <= _list_->capacity;                                        \
+    }                                                                                           \
+                                                                                                \
+    size_t PFX##_capacity(struct SNAME *_list_)                                                 \
+    {                                                                                           \
+        return _list_->capacity;                                                                \
+    }                                                                                           \
+                                                                                                \
+    /* A capacity of up to N moves the elements inline and frees the buffer */                  \
+    bool PFX##_resize(struct SNAME *_list_, size_t capacity)                                    \
+    {                                                                                           \
+        if (capacity < N)                                                                       \
+            capacity = N;                                                                       \
+                                                                                                \
+        if (_list_->capacity == capacity)                                                       \
+            return true;                                                                        \
+                                                                                                \
+        if (capacity < _list_->count)                                                           \
+            return false;                                                                       \
+                                                                                                \
+        if (capacity == N)                                                                      \
+        {                                                                                       \
+            V *buffer = _list_->storage.buffer;                                                 \
+                                                                                                \
+            memcpy(_list_->storage.local, buffer, _list_->count * sizeof(V));                   \
+            memset(_list_->storage.local + _list_->count, 0, (N - _list_->count) * sizeof(V));  \
+                                                                                                \
+            _list_->alloc->free(buffer);                                                        \
+        }                                                                                       \
+        else if (PFX##_is_inline(_list_))                                                       \
+        {                                                                                       \
+            V *buffer = _list_->alloc->calloc(capacity, sizeof(V));                             \
+                                                                                                \
+            if (CMC_UNLIKELY(!buffer))                                                          \
+                return false;                                                                   \
+                                                                                                \
+            memcpy(buffer, _list_->storage.local, _list_->count * sizeof(V));                   \
+                                                                                                \
+            _list_->storage.buffer = buffer;                                                    \
+        }                                                                                       \
+        else                                                                                    \
+        {                                                                                       \
+            V *buffer = _list_->alloc->realloc(_list_->storage.buffer, sizeof(V) * capacity);   \
+                                                                                                \
+            if (CMC_UNLIKELY(!buffer))                                                          \
+                return false;                                                                   \
+                                                                                                \
+            _list_->storage.buffer = buffer;                                                    \
+        }                                                                                       \
+                                                                                                \
+        _list_->capacity = capacity;                                                            \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_shrink_to_fit(struct SNAME *_list_)                                              \
+    {                                                                                           \
+        return PFX##_resize(_list_, _list_->count);                                             \
+    }                                                                                           \
+                                                                                                \
+    /* Grows the buffer so that at least capacity elements fit. Unlike */                       \
+    /* resize it never shrinks the buffer */                                                    \
+    bool PFX##_reserve(struct SNAME *_list_, size_t capacity)                                   \
+    {                                                                                           \
+        if (capacity <= _list_->capacity)                                                       \
+            return true;                                                                        \
+                                                                                                \
+        return PFX##_resize(_list_, capacity);                                                  \
+    }                                                                                           \
+                                                                                                \
+    /* Sorts the list in place in O(n log n) with the engine of cmc_sort.h */                   \
+    void PFX##_sort(struct SNAME *_list_, int (*comparator)(V, V))                              \
+    {                                                                                           \
+        PFX##_impl_sort(comparator, PFX##_data(_list_), _list_->count);                         \
+    }                                                                                           \
+                                                                                                \
+    /* The copy is allocated by new and has the same capacity */                                \
+    struct SNAME *PFX##_copy_of(struct SNAME *_list_, V (*copy_func)(V))                        \
+    {                                                                                           \
+        struct SNAME *result = PFX##_new_custom(_list_->capacity, _list_->alloc);               \
+                                                                                                \
+        if (CMC_UNLIKELY(!result))                                                              \
+            return NULL;                                                                        \
+                                                                                                \
+        V *from = PFX##_data(_list_);                                                           \
+        V *to = PFX##_data(result);                                                             \
+                                                                                                \
+        if (copy_func)                                                                          \
+        {                                                                                       \
+            for (size_t i = 0; i < _list_->count; i++)                                          \
+                to[i] = copy_func(from[i]);                                                     \
+        }                                                                                       \
+        else                                                                                    \
+            memcpy(to, from, sizeof(V) * _list_->count);                                        \
+                                                                                                \
+        result->count = _list_->count;                                                          \
+                                                                                                \
+        return result;                                                                          \
+    }                                                                                           \
+                                                                                                \
+    /* Copies up to size elements, in the order that they are iterated, to */                   \
+    /* elements and returns how many were copied */                                             \
+    size_t PFX##_to_array(struct SNAME *_list_, V *CMC_RESTRICT elements, size_t size)          \
+    {                                                                                           \
+        if (size > _list_->count)                                                               \
+            size = _list_->count;                                                               \
+                                                                                                \
+        memcpy(elements, PFX##_data(_list_), size * sizeof(V));                                 \
+                                                                                                \
+        return size;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_equals(struct SNAME *_list1_, struct SNAME *_list2_, int (*comparator)(V, V))    \
+    {                                                                                           \
+        if (_list1_->count != _list2_->count)                                                   \
+            return false;                                                                       \
+                                                                                                \
+        V *buffer1 = PFX##_data(_list1_);                                                       \
+        V *buffer2 = PFX##_data(_list2_);                                                       \
+                                                                                                \
+        for (size_t i = 0; i < _list1_->count; i++)                                             \
+        {                                                                                       \
+            if (comparator(buffer1[i], buffer2[i]) != 0)                                        \
+                return false;                                                                   \
+        }                                                                                       \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    struct cmc_string PFX##_to_string(struct SNAME *_list_)                                     \
+    {                                                                                           \
+        struct cmc_string str;                                                                  \
+        struct SNAME *l_ = _list_;                                                              \
+        const char *name = #SNAME;                                                              \
+                                                                                                \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_smalllist, name, l_,                     \
+                 (void *)PFX##_data(l_), l_->capacity, l_->count,                               \
+                 PFX##_is_inline(l_) ? "true" : "false");                                       \
+                                                                                                \
+        return str;                                                                             \
+    }                                                                                           \
+                                                                                                \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE)                              \
+                                                                                                \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE, (V))                                \
+                                                                                                \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                   \
+    {                                                                                           \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));         \
+                                                                                                \
+        if (CMC_UNLIKELY(!iter))                                                                \
+            return NULL;                                                                        \
+                                                                                                \
+        PFX##_iter_init(iter, target);                                                          \
+                                                                                                \
+        return iter;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    void PFX##_iter_free(struct SNAME##_iter *iter)                                             \
+    {                                                                                           \
+        iter->target->alloc->free(iter);                                                        \
+    }                                                                                           \
+                                                                                                \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                       \
+    {                                                                                           \
+        iter->target = target;                                                                  \
+        iter->cursor = 0;                                                                       \
+        iter->start = true;                                                                     \
+        iter->end = PFX##_empty(target);                                                        \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                            \
+    {                                                                                           \
+        return PFX##_empty(iter->target) || iter->start;                                        \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                              \
+    {                                                                                           \
+        return PFX##_empty(iter->target) || iter->end;                                          \
+    }                                                                                           \
+                                                                                                \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                         \
+    {                                                                                           \
+        if (!PFX##_empty(iter->target))                                                         \
+        {                                                                                       \
+            iter->cursor = 0;                                                                   \
+            iter->start = true;                                                                 \
+            iter->end = false;                                                                  \
+        }                                                                                       \
+    }                                                                                           \
+                                                                                                \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                           \
+    {                                                                                           \
+        if (!PFX##_empty(iter->target))                                                         \
+        {                                                                                       \
+            iter->start = false;                                                                \
+            iter->cursor = iter->target->count - 1;                                             \
+            iter->end = true;                                                                   \
+        }                                                                                       \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                             \
+    {                                                                                           \
+        if (iter->end)                                                                          \
+            return false;                                                                       \
+                                                                                                \
+        if (iter->cursor + 1 == iter->target->count)                                            \
+        {                                                                                       \
+            iter->end = true;                                                                   \
+            return false;                                                                       \
+        }                                                                                       \
+                                                                                                \
+        iter->start = false;                                                                    \
+                                                                                                \
+        iter->cursor++;                                                                         \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                             \
+    {                                                                                           \
+        if (iter->start)                                                                        \
+            return false;                                                                       \
+                                                                                                \
+        if (iter->cursor == 0)                                                                  \
+        {                                                                                       \
+            iter->start = true;                                                                 \
+            return false;                                                                       \
+        }                                                                                       \
+                                                                                                \
+        iter->end = false;                                                                      \
+                                                                                                \
+        iter->cursor--;                                                                         \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    /* Returns true only if the iterator moved */                                               \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps)                            \
+    {                                                                                           \
+        if (iter->end)                                                                          \
+            return false;                                                                       \
+                                                                                                \
+        if (iter->cursor + 1 == iter->target->count)                                            \
+        {                                                                                       \
+            iter->end = true;                                                                   \
+            return false;                                                                       \
+        }                                                                                       \
+                                                                                                \
+        if (steps == 0 || iter->cursor + steps >= iter->target->count)                          \
+            return false;                                                                       \
+                                                                                                \
+        iter->start = false;                                                                    \
+                                                                                                \
+        iter->cursor += steps;                                                                  \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    /* Returns true only if the iterator moved */                                               \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps)                             \
+    {                                                                                           \
+        if (iter->start)                                                                        \
+            return false;                                                                       \
+                                                                                                \
+        if (iter->cursor == 0)                                                                  \
+        {                                                                                       \
+            iter->start = true;                                                                 \
+            return false;                                                                       \
+        }                                                                                       \
+                                                                                                \
+        if (steps == 0 || iter->cursor < steps)                                                 \
+            return false;                                                                       \
+                                                                                                \
+        iter->end = false;                                                                      \
+                                                                                                \
+        iter->cursor -= steps;                                                                  \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    /* Returns true only if the iterator was able to be positioned at the given index */        \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index)                              \
+    {                                                                                           \
+        if (index >= iter->target->count)                                                       \
+            return false;                                                                       \
+                                                                                                \
+        if (iter->cursor > index)                                                               \
+            return PFX##_iter_rewind(iter, iter->cursor - index);                               \
+        else if (iter->cursor < index)                                                          \
+            return PFX##_iter_advance(iter, index - iter->cursor);                              \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                               \
+    {                                                                                           \
+        if (PFX##_empty(iter->target))                                                          \
+            return (V){0};                                                                      \
+                                                                                                \
+        return PFX##_data(iter->target)[iter->cursor];                                          \
+    }                                                                                           \
+                                                                                                \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter)                                             \
+    {                                                                                           \
+        if (PFX##_empty(iter->target))                                                          \
+            return NULL;                                                                        \
+                                                                                                \
+        return &(PFX##_data(iter->target)[iter->cursor]);                                       \
+    }                                                                                           \
+                                                                                                \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                          \
+    {                                                                                           \
+        return iter->cursor;                                                                    \
+    }                                                                                           \
+                                                                                                \
+    /* Called after removals, halves the buffer until it is no longer mostly */                 \
+    /* empty, down to the inline elements */                                                    \
+    static void PFX##_impl_low_water(struct SNAME *_list_)                                      \
+    {                                                                                           \
+        size_t capacity = _list_->capacity;                                                     \
+                                                                                                \
+        while (capacity > N && (double)_list_->count < (double)capacity * CMC_SHRINK_LOW_WATER) \
+            capacity /= 2;                                                                      \
+                                                                                                \
+        if (capacity != _list_->capacity)                                                       \
+            PFX##_resize(_list_, capacity);                                                     \
+    }                                                                                           \
+                                                                                                \
+    static bool PFX##_impl_grow(struct SNAME *_list_, size_t required)                          \
+    {                                                                                           \
+        return PFX##_resize(_list_, cmc_growth_capacity(_list_->capacity, required));           \
+    }
+
+#endif /* CMC_SMALLLIST_H */
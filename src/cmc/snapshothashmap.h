@@ -0,0 +1,472 @@
+/**
+ * snapshothashmap.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * SnapshotHashMap
+ *
+ * A SnapshotHashMap is a HashMap for tables that are read far more often than
+ * they are written and that are shared between threads. Readers look keys up
+ * in the current table without taking locks or doing atomic read-modify-write
+ * operations. Writers are serialized by a mutex: they copy the current table,
+ * modify the copy and publish it atomically. The previous table is freed once
+ * every reader that could still be using it has left.
+ *
+ * Each reading thread first registers itself to get a reader slot, and passes
+ * it to every read. A reader announces the epoch it entered with in its slot
+ * and writers wait until no slot holds an epoch older than the one of the new
+ * table. Writes cost a copy of the whole table, so changes that come together
+ * should be batched by the caller.
+ *
+ * Removed and replaced keys and values are not deallocated. Requires pthreads
+ * and C11 atomics.
+ */
+
+#ifndef CMC_SNAPSHOTHASHMAP_H
+#define CMC_SNAPSHOTHASHMAP_H
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+#include "hashmap.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_snapshothashmap = "%s at %p { table:%p, epoch:%" PRIuMAX ", cmp:%p, hash:%p }";
+
+/* Reader slots are padded to this size to avoid false sharing */
+#ifndef CMC_CACHE_LINE_SIZE
+#define CMC_CACHE_LINE_SIZE 64
+#endif
+
+/* Maximum amount of threads registered as readers at the same time */
+#ifndef CMC_SNAPSHOT_HASHMAP_READERS
+#define CMC_SNAPSHOT_HASHMAP_READERS 64
+#endif
+
+/* Epoch of a reader that is not inside a read */
+#define CMC_SNAPSHOT_IDLE SIZE_MAX
+
+#define CMC_GENERATE_SNAPSHOT_HASHMAP(PFX, SNAME, K, V)    \
+    CMC_GENERATE_SNAPSHOT_HASHMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_SNAPSHOT_HASHMAP_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_SNAPSHOT_HASHMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_SNAPSHOT_HASHMAP_HEADER(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_SNAPSHOT_HASHMAP_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_SNAPSHOT_HASHMAP_SOURCE(PFX, SNAME, K, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_SNAPSHOT_HASHMAP_HEADER(PFX, SNAME, K, V)                      \
+                                                                                    \
+    /* The HashMap used by each published table */                                  \
+    CMC_GENERATE_HASHMAP_HEADER(PFX##_table, SNAME##_table, K, V)                   \
+                                                                                    \
+    /* A reader slot, padded so that readers do not share cache lines */            \
+    struct SNAME##_reader                                                           \
+    {                                                                               \
+        /* Epoch the reader entered with or CMC_SNAPSHOT_IDLE */                    \
+        atomic_size_t epoch;                                                        \
+                                                                                    \
+        /* If the slot belongs to a thread */                                       \
+        bool registered;                                                            \
+                                                                                    \
+        char padding[CMC_CACHE_LINE_SIZE -                                          \
+                     (sizeof(atomic_size_t) + sizeof(bool)) % CMC_CACHE_LINE_SIZE]; \
+    };                                                                              \
+                                                                                    \
+    /* SnapshotHashMap Structure */                                                 \
+    struct SNAME                                                                    \
+    {                                                                               \
+        /* Reader slots */                                                          \
+        struct SNAME##_reader readers[CMC_SNAPSHOT_HASHMAP_READERS];                \
+                                                                                    \
+        /* Table that readers look keys up in */                                    \
+        struct SNAME##_table *_Atomic table;                                        \
+                                                                                    \
+        /* Incremented every time a new table is published */                       \
+        atomic_size_t epoch;                                                        \
+                                                                                    \
+        /* Serializes writers and reader registration */                            \
+        pthread_mutex_t lock;                                                       \
+                                                                                    \
+        /* Key comparison function */                                               \
+        int (*cmp)(K, K);                                                           \
+                                                                                    \
+        /* Key hash function */                                                     \
+        size_t (*hash)(K);                                                          \
+                                                                                    \
+        /* Custom allocation functions */                                           \
+        struct cmc_alloc_node *alloc;                                               \
+    };                                                                              \
+                                                                                    \
+    /* Collection Functions */                                                      \
+    /* Collection Allocation and Deallocation */                                    \
+    struct SNAME *PFX##_new(size_t capacity, double load, int (*compare)(K, K),     \
+                            size_t (*hash)(K));                                     \
+    struct SNAME *PFX##_new_custom(size_t capacity, double load,                    \
+                                   int (*compare)(K, K), size_t (*hash)(K),         \
+                                   struct cmc_alloc_node *alloc);                   \
+    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V));               \
+    void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V));                \
+    /* Reader Registration */                                                       \
+    size_t PFX##_reader_register(struct SNAME *_map_);                              \
+    void PFX##_reader_unregister(struct SNAME *_map_, size_t reader);               \
+    /* Collection Input and Output */                                               \
+    bool PFX##_insert(struct SNAME *_map_, K key, V value);                         \
+    bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value);       \
+    bool PFX##_remove(struct SNAME *_map_, K key, V *out_value);                    \
+    /* Element Access */                                                            \
+    V PFX##_get(struct SNAME *_map_, size_t reader, K key);                         \
+    /* Collection State */                                                          \
+    bool PFX##_contains(struct SNAME *_map_, size_t reader, K key);                 \
+    size_t PFX##_count(struct SNAME *_map_, size_t reader);                         \
+    size_t PFX##_memory_usage(struct SNAME *_map_, size_t reader);                  \
+    void PFX##_stats(struct SNAME *_map_, size_t reader,                            \
+                     struct cmc_hashtable_stats *out);                              \
+    /* Collection Utility */                                                        \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_);                         \
+                                                                                    \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_SNAPSHOT_HASHMAP_SOURCE(PFX, SNAME, K, V)                                \
+                                                                                              \
+    CMC_GENERATE_HASHMAP_SOURCE(PFX##_table, SNAME##_table, K, V)                             \
+                                                                                              \
+    /* Implementation Detail Functions */                                                     \
+    static struct SNAME##_table *PFX##_impl_enter(struct SNAME *_map_, size_t reader);        \
+    static void PFX##_impl_leave(struct SNAME *_map_, size_t reader);                         \
+    static struct SNAME##_table *PFX##_impl_publish(struct SNAME *_map_,                      \
+                                                    struct SNAME##_table *table);             \
+                                                                                              \
+    struct SNAME *PFX##_new(size_t capacity, double load, int (*compare)(K, K),               \
+                            size_t (*hash)(K))                                                \
+    {                                                                                         \
+        return PFX##_new_custom(capacity, load, compare, hash, NULL);                         \
+    }                                                                                         \
+                                                                                              \
+    struct SNAME *PFX##_new_custom(size_t capacity, double load, int (*compare)(K, K),        \
+                                   size_t (*hash)(K), struct cmc_alloc_node *alloc)           \
+    {                                                                                         \
+        if (!alloc)                                                                           \
+            alloc = &cmc_alloc_node_default;                                                  \
+                                                                                              \
+        struct SNAME##_table *table =                                                         \
+            PFX##_table_new_custom(capacity, load, compare, hash, alloc);                     \
+                                                                                              \
+        if (!table)                                                                           \
+            return NULL;                                                                      \
+                                                                                              \
+        /* Whole cache lines, so that no other block shares the last one */                   \
+        size_t size = (sizeof(struct SNAME) + CMC_CACHE_LINE_SIZE - 1) / CMC_CACHE_LINE_SIZE; \
+                                                                                              \
+        struct SNAME *_map_ = cmc_alloc_aligned(alloc, CMC_CACHE_LINE_SIZE,                   \
+                                                size * CMC_CACHE_LINE_SIZE);                  \
+                                                                                              \
+        if (CMC_UNLIKELY(!_map_))                                                             \
+        {                                                                                     \
+            PFX##_table_free(table, NULL);                                                    \
+            return NULL;                                                                      \
+        }                                                                                     \
+                                                                                              \
+        if (pthread_mutex_init(&(_map_->lock), NULL) != 0)                                    \
+        {                                                                                     \
+            PFX##_table_free(table, NULL);                                                    \
+            cmc_alloc_aligned_free(alloc, _map_);                                             \
+            return NULL;                                                                      \
+        }                                                                                     \
+                                                                                              \
+        for (size_t i = 0; i < CMC_SNAPSHOT_HASHMAP_READERS; i++)                             \
+        {                                                                                     \
+            atomic_init(&(_map_->readers[i].epoch), CMC_SNAPSHOT_IDLE);                       \
+            _map_->readers[i].registered = false;                                             \
+        }                                                                                     \
+                                                                                              \
+        atomic_init(&(_map_->table), table);                                                  \
+        atomic_init(&(_map_->epoch), 0);                                                      \
+                                                                                              \
+        _map_->cmp = compare;                                                                 \
+        _map_->hash = hash;                                                                   \
+        _map_->alloc = alloc;                                                                 \
+                                                                                              \
+        return _map_;                                                                         \
+    }                                                                                         \
+                                                                                              \
+    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V))                          \
+    {                                                                                         \
+        pthread_mutex_lock(&(_map_->lock));                                                   \
+                                                                                              \
+        struct SNAME##_table *current =                                                       \
+            atomic_load_explicit(&(_map_->table), memory_order_relaxed);                      \
+        struct SNAME##_table *next =                                                          \
+            PFX##_table_new_custom(PFX##_table_capacity(current) * PFX##_table_load(current), \
+                                   PFX##_table_load(current), _map_->cmp, _map_->hash,        \
+                                   _map_->alloc);                                             \
+                                                                                              \
+        /* The old table is only deallocated when nobody is reading it */                     \
+        if (next)                                                                             \
+            PFX##_table_free(PFX##_impl_publish(_map_, next), deallocator);                   \
+                                                                                              \
+        pthread_mutex_unlock(&(_map_->lock));                                                 \
+    }                                                                                         \
+                                                                                              \
+    /* Must not be called while other threads are using the map */                            \
+    void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V))                           \
+    {                                                                                         \
+        PFX##_table_free(atomic_load_explicit(&(_map_->table), memory_order_relaxed),         \
+                         deallocator);                                                        \
+                                                                                              \
+        pthread_mutex_destroy(&(_map_->lock));                                                \
+                                                                                              \
+        cmc_alloc_aligned_free(_map_->alloc, _map_);                                          \
+    }                                                                                         \
+                                                                                              \
+    /* Returns CMC_SNAPSHOT_HASHMAP_READERS when every slot is taken */                       \
+    size_t PFX##_reader_register(struct SNAME *_map_)                                         \
+    {                                                                                         \
+        pthread_mutex_lock(&(_map_->lock));                                                   \
+                                                                                              \
+        size_t reader = 0;                                                                    \
+                                                                                              \
+        while (reader < CMC_SNAPSHOT_HASHMAP_READERS && _map_->readers[reader].registered)    \
+            reader++;                                                                         \
+                                                                                              \
+        if (reader < CMC_SNAPSHOT_HASHMAP_READERS)                                            \
+            _map_->readers[reader].registered = true;                                         \
+                                                                                              \
+        pthread_mutex_unlock(&(_map_->lock));                                                 \
+                                                                                              \
+        return reader;                                                                        \
+    }                                                                                         \
+                                                                                              \
+    void PFX##_reader_unregister(struct SNAME *_map_, size_t reader)                          \
+    {                                                                                         \
+        pthread_mutex_lock(&(_map_->lock));                                                   \
+                                                                                              \
+        _map_->readers[reader].registered = false;                                            \
+                                                                                              \
+        pthread_mutex_unlock(&(_map_->lock));                                                 \
+    }                                                                                         \
+                                                                                              \
+    bool PFX##_insert(struct SNAME *_map_, K key, V value)                                    \
+    {                                                                                         \
+        pthread_mutex_lock(&(_map_->lock));                                                   \
+                                                                                              \
+        struct SNAME##_table *current =                                                       \
+            atomic_load_explicit(&(_map_->table), memory_order_relaxed);                      \
+                                                                                              \
+        if (PFX##_table_contains(current, key))                                               \
+        {                                                                                     \
+            pthread_mutex_unlock(&(_map_->lock));                                             \
+            return false;                                                                     \
+        }                                                                                     \
+                                                                                              \
+        struct SNAME##_table *next = PFX##_table_copy_of(current, NULL, NULL);                \
+                                                                                              \
+        if (!next || !PFX##_table_insert(next, key, value))                                   \
+        {                                                                                     \
+            if (next)                                                                         \
+                PFX##_table_free(next, NULL);                                                 \
+                                                                                              \
+            pthread_mutex_unlock(&(_map_->lock));                                             \
+            return false;                                                                     \
+        }                                                                                     \
+                                                                                              \
+        PFX##_table_free(PFX##_impl_publish(_map_, next), NULL);                              \
+                                                                                              \
+        pthread_mutex_unlock(&(_map_->lock));                                                 \
+                                                                                              \
+        return true;                                                                          \
+    }                                                                                         \
+                                                                                              \
+    bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value)                  \
+    {                                                                                         \
+        pthread_mutex_lock(&(_map_->lock));                                                   \
+                                                                                              \
+        struct SNAME##_table *current =                                                       \
+            atomic_load_explicit(&(_map_->table), memory_order_relaxed);                      \
+                                                                                              \
+        if (!PFX##_table_contains(current, key))                                              \
+        {                                                                                     \
+            pthread_mutex_unlock(&(_map_->lock));                                             \
+            return false;                                                                     \
+        }                                                                                     \
+                                                                                              \
+        struct SNAME##_table *next = PFX##_table_copy_of(current, NULL, NULL);                \
+                                                                                              \
+        if (!next)                                                                            \
+        {                                                                                     \
+            pthread_mutex_unlock(&(_map_->lock));                                             \
+            return false;                                                                     \
+        }                                                                                     \
+                                                                                              \
+        PFX##_table_update(next, key, new_value, old_value);                                  \
+                                                                                              \
+        PFX##_table_free(PFX##_impl_publish(_map_, next), NULL);                              \
+                                                                                              \
+        pthread_mutex_unlock(&(_map_->lock));                                                 \
+                                                                                              \
+        return true;                                                                          \
+    }                                                                                         \
+                                                                                              \
+    bool PFX##_remove(struct SNAME *_map_, K key, V *out_value)                               \
+    {                                                                                         \
+        pthread_mutex_lock(&(_map_->lock));                                                   \
+                                                                                              \
+        struct SNAME##_table *current =                                                       \
+            atomic_load_explicit(&(_map_->table), memory_order_relaxed);                      \
+                                                                                              \
+        if (!PFX##_table_contains(current, key))                                              \
+        {                                                                                     \
+            pthread_mutex_unlock(&(_map_->lock));                                             \
+            return false;                                                                     \
+        }                                                                                     \
+                                                                                              \
+        struct SNAME##_table *next = PFX##_table_copy_of(current, NULL, NULL);                \
+                                                                                              \
+        if (!next)                                                                            \
+        {                                                                                     \
+            pthread_mutex_unlock(&(_map_->lock));                                             \
+            return false;                                                                     \
+        }                                                                                     \
+                                                                                              \
+        PFX##_table_remove(next, key, out_value);                                             \
+                                                                                              \
+        PFX##_table_free(PFX##_impl_publish(_map_, next), NULL);                              \
+                                                                                              \
+        pthread_mutex_unlock(&(_map_->lock));                                                 \
+                                                                                              \
+        return true;                                                                          \
+    }                                                                                         \
+                                                                                              \
+    V PFX##_get(struct SNAME *_map_, size_t reader, K key)                                    \
+    {                                                                                         \
+        struct SNAME##_table *table = PFX##_impl_enter(_map_, reader);                        \
+                                                                                              \
+        V result = PFX##_table_get(table, key);                                               \
+                                                                                              \
+        PFX##_impl_leave(_map_, reader);                                                      \
+                                                                                              \
+        return result;                                                                        \
+    }                                                                                         \
+                                                                                              \
+    bool PFX##_contains(struct SNAME *_map_, size_t reader, K key)                            \
+    {                                                                                         \
+        struct SNAME##_table *table = PFX##_impl_enter(_map_, reader);                        \
+                                                                                              \
+        bool result = PFX##_table_contains(table, key);                                       \
+                                                                                              \
+        PFX##_impl_leave(_map_, reader);                                                      \
+                                                                                              \
+        return result;                                                                        \
+    }                                                                                         \
+                                                                                              \
+    size_t PFX##_count(struct SNAME *_map_, size_t reader)                                    \
+    {                                                                                         \
+        struct SNAME##_table *table = PFX##_impl_enter(_map_, reader);                        \
+                                                                                              \
+        size_t result = PFX##_table_count(table);                                             \
+                                                                                              \
+        PFX##_impl_leave(_map_, reader);                                                      \
+                                                                                              \
+        return result;                                                                        \
+    }                                                                                         \
+                                                                                              \
+    /* Counts the table published when the read started */                                    \
+    size_t PFX##_memory_usage(struct SNAME *_map_, size_t reader)                             \
+    {                                                                                         \
+        struct SNAME##_table *table = PFX##_impl_enter(_map_, reader);                        \
+                                                                                              \
+        size_t size = (sizeof(struct SNAME) + CMC_CACHE_LINE_SIZE - 1) / CMC_CACHE_LINE_SIZE; \
+                                                                                              \
+        size_t lines = size * CMC_CACHE_LINE_SIZE;                                            \
+                                                                                              \
+        size_t result = cmc_alloc_aligned_size(CMC_CACHE_LINE_SIZE, lines) +                  \
+                        PFX##_table_memory_usage(table);                                      \
+                                                                                              \
+        PFX##_impl_leave(_map_, reader);                                                      \
+                                                                                              \
+        return result;                                                                        \
+    }                                                                                         \
+                                                                                              \
+    /* Reports the table published when the read started */                                   \
+    void PFX##_stats(struct SNAME *_map_, size_t reader, struct cmc_hashtable_stats *out)     \
+    {                                                                                         \
+        struct SNAME##_table *table = PFX##_impl_enter(_map_, reader);                        \
+                                                                                              \
+        PFX##_table_stats(table, out);                                                        \
+                                                                                              \
+        PFX##_impl_leave(_map_, reader);                                                      \
+                                                                                              \
+        out->bytes += sizeof(struct SNAME);                                                   \
+    }                                                                                         \
+                                                                                              \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_)                                    \
+    {                                                                                         \
+        struct cmc_string str;                                                                \
+        struct SNAME *m_ = _map_;                                                             \
+        const char *name = #SNAME;                                                            \
+                                                                                              \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_snapshothashmap,                       \
+                 name, m_, atomic_load(&(m_->table)), atomic_load(&(m_->epoch)), m_->cmp,     \
+                 m_->hash);                                                                   \
+                                                                                              \
+        return str;                                                                           \
+    }                                                                                         \
+                                                                                              \
+    /* The epoch announced in the slot must be visible before the table is */                 \
+    /* loaded. A writer that published a table and then saw the slot idle */                  \
+    /* knows that the reader will load the table it published */                              \
+    static struct SNAME##_table *PFX##_impl_enter(struct SNAME *_map_, size_t reader)         \
+    {                                                                                         \
+        size_t epoch = atomic_load_explicit(&(_map_->epoch), memory_order_acquire);           \
+                                                                                              \
+        atomic_store_explicit(&(_map_->readers[reader].epoch), epoch, memory_order_relaxed);  \
+        atomic_thread_fence(memory_order_seq_cst);                                            \
+                                                                                              \
+        return atomic_load_explicit(&(_map_->table), memory_order_acquire);                   \
+    }                                                                                         \
+                                                                                              \
+    static void PFX##_impl_leave(struct SNAME *_map_, size_t reader)                          \
+    {                                                                                         \
+        atomic_store_explicit(&(_map_->readers[reader].epoch), CMC_SNAPSHOT_IDLE,             \
+                              memory_order_release);                                          \
+    }                                                                                         \
+                                                                                              \
+    /* Publishes a table and returns the previous one once no reader can */                   \
+    /* still be using it. Called with the lock held */                                        \
+    static struct SNAME##_table *PFX##_impl_publish(struct SNAME *_map_,                      \
+                                                    struct SNAME##_table *table)              \
+    {                                                                                         \
+        struct SNAME##_table *previous = atomic_exchange(&(_map_->table), table);             \
+                                                                                              \
+        size_t epoch = atomic_fetch_add(&(_map_->epoch), 1) + 1;                              \
+                                                                                              \
+        atomic_thread_fence(memory_order_seq_cst);                                            \
+                                                                                              \
+        /* Readers that entered before the new epoch might hold previous */                   \
+        for (size_t i = 0; i < CMC_SNAPSHOT_HASHMAP_READERS; i++)                             \
+        {                                                                                     \
+            atomic_size_t *reader_epoch = &(_map_->readers[i].epoch);                         \
+                                                                                              \
+            while (atomic_load_explicit(reader_epoch, memory_order_acquire) < epoch)          \
+                sched_yield();                                                                \
+        }                                                                                     \
+                                                                                              \
+        return previous;                                                                      \
+    }
+
+#endif /* CMC_SNAPSHOTHASHMAP_H */
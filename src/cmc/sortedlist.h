@@ -15,8 +15,33 @@
  * as you like and when its capacity is full, the buffer is reallocated. The
  * elements are only sorted when a certain action requires that the array is
  * sorted like accessing min() or max(). This prevents the array from being
- * sorted after every insertion or removal. The array is sorted using a
- * variation of quick sort that uses insertion sort for small partitions.
+ * sorted after every insertion or removal. The array is sorted with the
+ * pattern defeating quicksort of cmc_sort.h, which takes O(n log n) at worst
+ * and close to linear time for runs and repeated elements. Elements that map
+ * to integers can be radix sorted instead with CMC_GENERATE_SORTEDLIST_RADIX.
+ * The list keeps track of how many elements at its start are already sorted,
+ * so only the elements inserted since then are sorted and then merged into
+ * them in linear time.
+ *
+ * A list that is mostly read can be frozen. This keeps a copy of the sorted
+ * elements in the order of a breadth first traversal of a binary search tree,
+ * so the searches of contains() and indexof() go through memory that is close
+ * together and without branches. Any change to the list drops the copy.
+ *
+ * A view is a range of the sorted buffer that is taken without allocating
+ * or copying, so a range can be searched and iterated by a worker instead of
+ * a new list. A view is valid until the list is modified or freed.
+ *
+ * remove_lazy() only marks an element in a bit set, and the marked elements
+ * are dropped together by the next sort, in a single pass over the buffer.
+ * contains() skips them, so removals and lookups can be interleaved without
+ * moving the buffer every time. In unique mode, set with set_unique(), the
+ * list behaves as a set: duplicates are dropped by the sort too, which makes
+ * it a compact replacement of a TreeSet for elements mostly inserted in order.
+ *
+ * The set operations treat the lists as multisets: an element that is n times
+ * in one list and m times in the other is max(n, m) times in their union,
+ * min(n, m) times in their intersection and n - m times in their difference.
  */
 
 #ifndef CMC_SORTEDLIST_H
@@ -27,10 +52,40 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_growth.h"
+#include "../utl/cmc_parallel.h"
+#include "../utl/cmc_serial.h"
+#include "../utl/cmc_sort.h"
 #include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+#include "heap.h"
 
 /* to_string format */
-static const char *cmc_string_fmt_sortedlist = "%s at %p { buffer:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", is_sorted:%s, cmp:%p }";
+static const char *cmc_string_fmt_sortedlist = "%s at %p { buffer:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", sorted:%" PRIuMAX ", cmp:%p }";
+
+/* A removal shrinks a collection once less than this fraction of what it */
+/* can hold without growing is in use. Define it as 0 to never shrink */
+#ifndef CMC_SHRINK_LOW_WATER
+#define CMC_SHRINK_LOW_WATER 0.25
+#endif
+
+/* Unsorted elements at the end of a sorted list up to this amount are */
+/* inserted one by one with a binary search instead of being merged */
+#define CMC_SORTEDLIST_INSERTION_TAIL 8
+
+/* An intersection gallops through the larger list when it has at least this */
+/* many times the elements of the smaller one */
+#define CMC_SORTEDLIST_GALLOP_RATIO 16
+
+#ifndef CMC_IMPL_SORTEDLIST_PREFETCH
+#if defined(__GNUC__) || defined(__clang__)
+#define CMC_IMPL_SORTEDLIST_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define CMC_IMPL_SORTEDLIST_PREFETCH(address)
+#endif
+#endif
 
 #define CMC_GENERATE_SORTEDLIST(PFX, SNAME, V)    \
     CMC_GENERATE_SORTEDLIST_HEADER(PFX, SNAME, V) \
@@ -42,649 +97,1878 @@ static const char *cmc_string_fmt_sortedlist = "%s at %p { buffer:%p, capacity:%
 #define CMC_WRAPGEN_SORTEDLIST_SOURCE(PFX, SNAME, K, V) \
     CMC_GENERATE_SORTEDLIST_SOURCE(PFX, SNAME, V)
 
+/* Same as CMC_GENERATE_SORTEDLIST but elements are compared by calling CMP */
+/* directly, so the compiler can inline it. The function given to new is */
+/* still stored but only used by copy_of and to_string */
+#define CMC_GENERATE_SORTEDLIST_EX(PFX, SNAME, V, CMP) \
+    CMC_GENERATE_SORTEDLIST_HEADER(PFX, SNAME, V)      \
+    CMC_GENERATE_SORTEDLIST_EX_SOURCE(PFX, SNAME, V, CMP)
+
+/* Same as CMC_GENERATE_SORTEDLIST but the list is sorted by a radix sort */
+/* over the keys given by uint64_t KEY(V), which must keep the order of the */
+/* elements. Every other comparison is made between keys too, so the */
+/* function given to new is only used by copy_of and to_string */
+#define CMC_GENERATE_SORTEDLIST_RADIX(PFX, SNAME, V, KEY) \
+    CMC_GENERATE_SORTEDLIST_HEADER(PFX, SNAME, V)         \
+    CMC_GENERATE_SORTEDLIST_RADIX_SOURCE(PFX, SNAME, V, KEY)
+
+/* Same as CMC_GENERATE_SORTEDLIST but V is plain data that owns nothing, */
+/* so removals and clear leave the slots they free as they are instead of */
+/* overwriting them with zeros */
+#define CMC_GENERATE_SORTEDLIST_TRIVIAL(PFX, SNAME, V) \
+    CMC_GENERATE_SORTEDLIST_HEADER(PFX, SNAME, V)      \
+    CMC_GENERATE_SORTEDLIST_TRIVIAL_SOURCE(PFX, SNAME, V)
+
+#define CMC_GENERATE_SORTEDLIST_SOURCE(PFX, SNAME, V)             \
+    CMC_IMPL_SORTEDLIST_SOURCE(PFX, SNAME, V, _list_->cmp, false) \
+    CMC_IMPL_SORTEDLIST_COMPARISON_SORT(PFX, SNAME, V)
+
+#define CMC_GENERATE_SORTEDLIST_EX_SOURCE(PFX, SNAME, V, CMP) \
+    CMC_IMPL_SORTEDLIST_SOURCE(PFX, SNAME, V, CMP, false)     \
+    CMC_IMPL_SORTEDLIST_COMPARISON_SORT(PFX, SNAME, V)
+
+#define CMC_GENERATE_SORTEDLIST_RADIX_SOURCE(PFX, SNAME, V, KEY)           \
+    CMC_IMPL_SORTEDLIST_RADIX_CMP(PFX, V, KEY)                             \
+    CMC_IMPL_SORTEDLIST_SOURCE(PFX, SNAME, V, PFX##_impl_radix_cmp, false) \
+    CMC_IMPL_SORTEDLIST_RADIX_SORT(PFX, SNAME, V, KEY)
+
+#define CMC_GENERATE_SORTEDLIST_TRIVIAL_SOURCE(PFX, SNAME, V)    \
+    CMC_IMPL_SORTEDLIST_SOURCE(PFX, SNAME, V, _list_->cmp, true) \
+    CMC_IMPL_SORTEDLIST_COMPARISON_SORT(PFX, SNAME, V)
+
 /* HEADER ********************************************************************/
-#define CMC_GENERATE_SORTEDLIST_HEADER(PFX, SNAME, V)                       \
-                                                                            \
-    /* List Structure */                                                    \
-    struct SNAME                                                            \
-    {                                                                       \
-        /* Dynamic array of elements */                                     \
-        V *buffer;                                                          \
-                                                                            \
-        /* Current array capacity */                                        \
-        size_t capacity;                                                    \
-                                                                            \
-        /* Current amount of elements */                                    \
-        size_t count;                                                       \
-                                                                            \
-        /* Flag if the list is sorted or not, used by lazy evaluation */    \
-        bool is_sorted;                                                     \
-                                                                            \
-        /* Element comparison function */                                   \
-        int (*cmp)(V, V);                                                   \
-                                                                            \
-        /* Function that returns an iterator to the start of the list */    \
-        struct SNAME##_iter (*it_start)(struct SNAME *);                    \
-                                                                            \
-        /* Function that returns an iterator to the end of the list */      \
-        struct SNAME##_iter (*it_end)(struct SNAME *);                      \
-    };                                                                      \
-                                                                            \
-    /* List Iterator */                                                     \
-    struct SNAME##_iter                                                     \
-    {                                                                       \
-        /* Target list */                                                   \
-        struct SNAME *target;                                               \
-                                                                            \
-        /* Cursor's position (index) */                                     \
-        size_t cursor;                                                      \
-                                                                            \
-        /* If the iterator has reached the start of the iteration */        \
-        bool start;                                                         \
-                                                                            \
-        /* If the iterator has reached the end of the iteration */          \
-        bool end;                                                           \
-    };                                                                      \
-                                                                            \
-    /* Collection Functions */                                              \
-    /* Collection Allocation and Deallocation */                            \
-    struct SNAME *PFX##_new(size_t capacity, int (*compare)(V, V));         \
-    void PFX##_clear(struct SNAME *_list_, void (*deallocator)(V));         \
-    void PFX##_free(struct SNAME *_list_, void (*deallocator)(V));          \
-    /* Collection Input and Output */                                       \
-    bool PFX##_insert(struct SNAME *_list_, V element);                     \
-    bool PFX##_remove(struct SNAME *_list_, size_t index);                  \
-    /* Element Access */                                                    \
-    bool PFX##_max(struct SNAME *_list_, V *result);                        \
-    bool PFX##_min(struct SNAME *_list_, V *result);                        \
-    V PFX##_get(struct SNAME *_list_, size_t index);                        \
-    size_t PFX##_indexof(struct SNAME *_list_, V element, bool from_start); \
-    /* Collection State */                                                  \
-    bool PFX##_contains(struct SNAME *_list_, V element);                   \
-    bool PFX##_empty(struct SNAME *_list_);                                 \
-    bool PFX##_full(struct SNAME *_list_);                                  \
-    size_t PFX##_count(struct SNAME *_list_);                               \
-    size_t PFX##_capacity(struct SNAME *_list_);                            \
-    /* Collection Utility */                                                \
-    bool PFX##_resize(struct SNAME *_list_, size_t capacity);               \
-    void PFX##_sort(struct SNAME *_list_);                                  \
-    struct SNAME *PFX##_copy_of(struct SNAME *_list_, V (*copy_func)(V));   \
-    bool PFX##_equals(struct SNAME *_list1_, struct SNAME *_list2_);        \
-    struct cmc_string PFX##_to_string(struct SNAME *_list_);                \
-                                                                            \
-    /* Iterator Functions */                                                \
-    /* Iterator Allocation and Deallocation */                              \
-    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target);              \
-    void PFX##_iter_free(struct SNAME##_iter *iter);                        \
-    /* Iterator Initialization */                                           \
-    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);  \
-    /* Iterator State */                                                    \
-    bool PFX##_iter_start(struct SNAME##_iter *iter);                       \
-    bool PFX##_iter_end(struct SNAME##_iter *iter);                         \
-    /* Iterator Movement */                                                 \
-    void PFX##_iter_to_start(struct SNAME##_iter *iter);                    \
-    void PFX##_iter_to_end(struct SNAME##_iter *iter);                      \
-    bool PFX##_iter_next(struct SNAME##_iter *iter);                        \
-    bool PFX##_iter_prev(struct SNAME##_iter *iter);                        \
-    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps);       \
-    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps);        \
-    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index);         \
-    /* Iterator Access */                                                   \
-    V PFX##_iter_value(struct SNAME##_iter *iter);                          \
-    size_t PFX##_iter_index(struct SNAME##_iter *iter);                     \
-                                                                            \
+#define CMC_GENERATE_SORTEDLIST_HEADER(PFX, SNAME, V)                               \
+                                                                                    \
+    /* List Structure */                                                            \
+    struct SNAME                                                                    \
+    {                                                                               \
+        /* Dynamic array of elements */                                             \
+        V *buffer;                                                                  \
+                                                                                    \
+        /* Current array capacity */                                                \
+        size_t capacity;                                                            \
+                                                                                    \
+        /* Current amount of elements */                                            \
+        size_t count;                                                               \
+                                                                                    \
+        /* Amount of elements at the start that are sorted, used by lazy */         \
+        /* evaluation */                                                            \
+        size_t sorted;                                                              \
+                                                                                    \
+        /* Bit set of the sorted elements removed by remove_lazy, with a bit */     \
+        /* for each element the buffer can hold, or NULL */                         \
+        uint64_t *dead;                                                             \
+                                                                                    \
+        /* Amount of bits set in dead */                                            \
+        size_t dead_count;                                                          \
+                                                                                    \
+        /* If duplicates are dropped whenever the list is sorted */                 \
+        bool unique;                                                                \
+                                                                                    \
+        /* Sorted elements in breadth first order, starting at index 1, */          \
+        /* while the list is frozen or NULL */                                      \
+        V *frozen;                                                                  \
+                                                                                    \
+        /* Index in the buffer of each element of frozen */                         \
+        size_t *frozen_index;                                                       \
+                                                                                    \
+        /* Element comparison function */                                           \
+        int (*cmp)(V, V);                                                           \
+                                                                                    \
+        /* Function that returns an iterator to the start of the list */            \
+        struct SNAME##_iter (*it_start)(struct SNAME *);                            \
+                                                                                    \
+        /* Function that returns an iterator to the end of the list */              \
+        struct SNAME##_iter (*it_end)(struct SNAME *);                              \
+                                                                                    \
+        /* Custom allocation functions */                                           \
+        struct cmc_alloc_node *alloc;                                               \
+    };                                                                              \
+                                                                                    \
+    /* List Iterator */                                                             \
+    struct SNAME##_iter                                                             \
+    {                                                                               \
+        /* Target list */                                                           \
+        struct SNAME *target;                                                       \
+                                                                                    \
+        /* Cursor's position (index) */                                             \
+        size_t cursor;                                                              \
+                                                                                    \
+        /* If the iterator has reached the start of the iteration */                \
+        bool start;                                                                 \
+                                                                                    \
+        /* If the iterator has reached the end of the iteration */                  \
+        bool end;                                                                   \
+    };                                                                              \
+                                                                                    \
+    /* Read only range of the sorted elements of a list */                          \
+    struct SNAME##_view                                                             \
+    {                                                                               \
+        /* First element of the range */                                            \
+        V *data;                                                                    \
+                                                                                    \
+        /* Amount of elements in the range */                                       \
+        size_t count;                                                               \
+                                                                                    \
+        /* List of the elements, whose comparison function is used */               \
+        struct SNAME *target;                                                       \
+    };                                                                              \
+                                                                                    \
+    /* View Iterator */                                                             \
+    struct SNAME##_view_iter                                                        \
+    {                                                                               \
+        /* Target view */                                                           \
+        struct SNAME##_view view;                                                   \
+                                                                                    \
+        /* Cursor's position (index) */                                             \
+        size_t cursor;                                                              \
+                                                                                    \
+        /* If the iterator has reached the start of the iteration */                \
+        bool start;                                                                 \
+                                                                                    \
+        /* If the iterator has reached the end of the iteration */                  \
+        bool end;                                                                   \
+    };                                                                              \
+                                                                                    \
+    /* Collection Functions */                                                      \
+    /* Collection Allocation and Deallocation */                                    \
+    struct SNAME *PFX##_new(size_t capacity, int (*compare)(V, V));                 \
+    struct SNAME *PFX##_new_custom(size_t capacity, int (*compare)(V, V),           \
+                                   struct cmc_alloc_node *alloc);                   \
+    struct SNAME *PFX##_new_from(V *elements, size_t size, int (*compare)(V, V));   \
+    void PFX##_clear(struct SNAME *_list_, void (*deallocator)(V));                 \
+    void PFX##_free(struct SNAME *_list_, void (*deallocator)(V));                  \
+    /* Collection Input and Output */                                               \
+    bool PFX##_insert(struct SNAME *_list_, V element);                             \
+    bool PFX##_remove(struct SNAME *_list_, size_t index);                          \
+    size_t PFX##_remove_if(struct SNAME *_list_, bool (*pred)(V),                   \
+                           void (*deallocator)(V));                                 \
+    bool PFX##_remove_lazy(struct SNAME *_list_, V element);                        \
+    /* Element Access */                                                            \
+    bool PFX##_max(struct SNAME *_list_, V *result);                                \
+    bool PFX##_min(struct SNAME *_list_, V *result);                                \
+    V PFX##_get(struct SNAME *_list_, size_t index);                                \
+    size_t PFX##_indexof(struct SNAME *_list_, V element, bool from_start);         \
+    /* Collection State */                                                          \
+    bool PFX##_contains(struct SNAME *_list_, V element);                           \
+    CMC_PURE bool PFX##_empty(struct SNAME *_list_);                                \
+    bool PFX##_full(struct SNAME *_list_);                                          \
+    CMC_PURE size_t PFX##_count(struct SNAME *_list_);                              \
+    size_t PFX##_memory_usage(struct SNAME *_list_);                                \
+    size_t PFX##_capacity(struct SNAME *_list_);                                    \
+    /* Collection Utility */                                                        \
+    bool PFX##_resize(struct SNAME *_list_, size_t capacity);                       \
+    bool PFX##_shrink_to_fit(struct SNAME *_list_);                                 \
+    bool PFX##_reserve(struct SNAME *_list_, size_t capacity);                      \
+    void PFX##_sort(struct SNAME *_list_);                                          \
+    void PFX##_set_unique(struct SNAME *_list_, bool enabled);                      \
+    void PFX##_sort_parallel(struct SNAME *_list_, size_t threads);                 \
+    size_t PFX##_parallel_slots(struct SNAME *_list_);                              \
+    V PFX##_parallel_reduce(struct SNAME *_list_, V initial, V (*reduce)(V, V),     \
+                            V (*combine)(V, V), size_t threads);                    \
+    bool PFX##_freeze(struct SNAME *_list_);                                        \
+    void PFX##_thaw(struct SNAME *_list_);                                          \
+    struct SNAME *PFX##_copy_of(struct SNAME *_list_, V (*copy_func)(V));           \
+    size_t PFX##_to_array(struct SNAME *_list_, V *CMC_RESTRICT elements,           \
+                          size_t size);                                             \
+    bool PFX##_equals(struct SNAME *_list1_, struct SNAME *_list2_);                \
+    struct cmc_string PFX##_to_string(struct SNAME *_list_);                        \
+    bool PFX##_to_string_full(struct SNAME *_list_,                                 \
+                              struct cmc_string_builder *builder,                   \
+                              const char *elem_fmt);                                \
+    bool PFX##_write(struct SNAME *_list_, FILE *file,                              \
+                     void (*fmt)(FILE *, V));                                       \
+    bool PFX##_write_fd(struct SNAME *_list_, int fd,                               \
+                        void (*fmt)(struct cmc_dump *, V));                         \
+    /* Collection Serialization */                                                  \
+    bool PFX##_save(struct SNAME *_list_, FILE *file,                               \
+                    bool (*writer)(V, FILE *));                                     \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(V, V),                   \
+                                bool (*reader)(V *, FILE *));                       \
+    bool PFX##_save_flat(struct SNAME *_list_, FILE *file, size_t step);            \
+                                                                                    \
+    /* Set Operations */                                                            \
+    struct SNAME *PFX##_union(struct SNAME *_list1_, struct SNAME *_list2_);        \
+    struct SNAME *PFX##_intersection(struct SNAME *_list1_, struct SNAME *_list2_); \
+    struct SNAME *PFX##_difference(struct SNAME *_list1_, struct SNAME *_list2_);   \
+    struct SNAME *PFX##_merge_k(struct SNAME **lists, size_t k);                    \
+                                                                                    \
+    /* Iterator Functions */                                                        \
+    /* Iterator Allocation and Deallocation */                                      \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target);                      \
+    void PFX##_iter_free(struct SNAME##_iter *iter);                                \
+    /* Iterator Initialization */                                                   \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);          \
+    /* Iterator State */                                                            \
+    bool PFX##_iter_start(struct SNAME##_iter *iter);                               \
+    bool PFX##_iter_end(struct SNAME##_iter *iter);                                 \
+    /* Iterator Movement */                                                         \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter);                            \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter);                              \
+    bool PFX##_iter_next(struct SNAME##_iter *iter);                                \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter);                                \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps);               \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps);                \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index);                 \
+    bool PFX##_parallel_iter(struct SNAME##_iter *iter, struct SNAME *target,       \
+                             size_t slot);                                          \
+    /* Iterator Access */                                                           \
+    V PFX##_iter_value(struct SNAME##_iter *iter);                                  \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter);                             \
+                                                                                    \
+    /* View Functions */                                                            \
+    struct SNAME##_view PFX##_view(struct SNAME *_list_, size_t from, size_t to);   \
+    struct SNAME##_view PFX##_view_range(struct SNAME *_list_, V low, V high);      \
+    struct SNAME##_view PFX##_view_slice(struct SNAME##_view view, size_t from,     \
+                                         size_t to);                                \
+    V PFX##_view_get(struct SNAME##_view view, size_t index);                       \
+    size_t PFX##_view_indexof(struct SNAME##_view view, V element,                  \
+                              bool from_start);                                     \
+    bool PFX##_view_contains(struct SNAME##_view view, V element);                  \
+    size_t PFX##_view_lower_bound(struct SNAME##_view view, V element);             \
+    size_t PFX##_view_upper_bound(struct SNAME##_view view, V element);             \
+    void PFX##_view_iter_init(struct SNAME##_view_iter *iter,                       \
+                              struct SNAME##_view view);                            \
+    bool PFX##_view_iter_start(struct SNAME##_view_iter *iter);                     \
+    bool PFX##_view_iter_end(struct SNAME##_view_iter *iter);                       \
+    bool PFX##_view_iter_next(struct SNAME##_view_iter *iter);                      \
+    bool PFX##_view_iter_prev(struct SNAME##_view_iter *iter);                      \
+    V PFX##_view_iter_value(struct SNAME##_view_iter *iter);                        \
+    size_t PFX##_view_iter_index(struct SNAME##_view_iter *iter);                   \
+                                                                                    \
 /* SOURCE ********************************************************************/
-#define CMC_GENERATE_SORTEDLIST_SOURCE(PFX, SNAME, V)                                     \
-                                                                                          \
-    /* Implementation Detail Functions */                                                 \
-    static size_t PFX##_impl_binary_search_first(struct SNAME *_list_, V value);          \
-    static size_t PFX##_impl_binary_search_last(struct SNAME *_list_, V value);           \
-    void PFX##_impl_sort_quicksort(V *array, int (*cmp)(V, V), size_t low, size_t high);  \
-    void PFX##_impl_sort_insertion(V *array, int (*cmp)(V, V), size_t low, size_t high);  \
-    static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_list_);                 \
-    static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_list_);                   \
-                                                                                          \
-    struct SNAME *PFX##_new(size_t capacity, int (*compare)(V, V))                        \
-    {                                                                                     \
-        if (capacity < 1)                                                                 \
-            return NULL;                                                                  \
-                                                                                          \
-        struct SNAME *_list_ = malloc(sizeof(struct SNAME));                              \
-                                                                                          \
-        if (!_list_)                                                                      \
-            return NULL;                                                                  \
-                                                                                          \
-        _list_->buffer = calloc(capacity, sizeof(V));                                     \
-                                                                                          \
-        if (!_list_->buffer)                                                              \
-        {                                                                                 \
-            free(_list_);                                                                 \
-            return NULL;                                                                  \
-        }                                                                                 \
-                                                                                          \
-        _list_->capacity = capacity;                                                      \
-        _list_->count = 0;                                                                \
-        _list_->cmp = compare;                                                            \
-        _list_->is_sorted = false;                                                        \
-                                                                                          \
-        _list_->it_start = PFX##_impl_it_start;                                           \
-        _list_->it_end = PFX##_impl_it_end;                                               \
-                                                                                          \
-        return _list_;                                                                    \
-    }                                                                                     \
-                                                                                          \
-    void PFX##_clear(struct SNAME *_list_, void (*deallocator)(V))                        \
-    {                                                                                     \
-        if (deallocator)                                                                  \
-        {                                                                                 \
-            for (size_t i = 0; i < _list_->count; i++)                                    \
-                deallocator(_list_->buffer[i]);                                           \
-        }                                                                                 \
-                                                                                          \
-        memset(_list_->buffer, 0, sizeof(V) * _list_->capacity);                          \
-                                                                                          \
-        _list_->count = 0;                                                                \
-    }                                                                                     \
-                                                                                          \
-    void PFX##_free(struct SNAME *_list_, void (*deallocator)(V))                         \
-    {                                                                                     \
-        if (deallocator)                                                                  \
-        {                                                                                 \
-            for (size_t i = 0; i < _list_->count; i++)                                    \
-                deallocator(_list_->buffer[i]);                                           \
-        }                                                                                 \
-                                                                                          \
-        free(_list_->buffer);                                                             \
-        free(_list_);                                                                     \
-    }                                                                                     \
-                                                                                          \
-    bool PFX##_insert(struct SNAME *_list_, V element)                                    \
-    {                                                                                     \
-        if (PFX##_full(_list_))                                                           \
-        {                                                                                 \
-            if (!PFX##_resize(_list_, PFX##_capacity(_list_) * 2))                        \
-                return false;                                                             \
-        }                                                                                 \
-                                                                                          \
-        _list_->buffer[_list_->count++] = element;                                        \
-                                                                                          \
-        _list_->is_sorted = false;                                                        \
-                                                                                          \
-        return true;                                                                      \
-    }                                                                                     \
-                                                                                          \
-    bool PFX##_remove(struct SNAME *_list_, size_t index)                                 \
-    {                                                                                     \
-        if (index >= _list_->count)                                                       \
-            return false;                                                                 \
-                                                                                          \
-        memmove(_list_->buffer + index, _list_->buffer + index + 1,                       \
-                (_list_->count - index) * sizeof(V));                                     \
-                                                                                          \
-        _list_->buffer[--_list_->count] = (V){0};                                         \
-                                                                                          \
-        return true;                                                                      \
-    }                                                                                     \
-                                                                                          \
-    bool PFX##_min(struct SNAME *_list_, V *result)                                       \
-    {                                                                                     \
-        if (PFX##_empty(_list_))                                                          \
-            return false;                                                                 \
-                                                                                          \
-        PFX##_sort(_list_);                                                               \
-                                                                                          \
-        *result = _list_->buffer[0];                                                      \
-                                                                                          \
-        return true;                                                                      \
-    }                                                                                     \
-                                                                                          \
-    bool PFX##_max(struct SNAME *_list_, V *result)                                       \
-    {                                                                                     \
-        if (PFX##_empty(_list_))                                                          \
-            return false;                                                                 \
-                                                                                          \
-        PFX##_sort(_list_);                                                               \
-                                                                                          \
-        *result = _list_->buffer[_list_->count - 1];                                      \
-                                                                                          \
-        return true;                                                                      \
-    }                                                                                     \
-                                                                                          \
-    V PFX##_get(struct SNAME *_list_, size_t index)                                       \
-    {                                                                                     \
-        if (index >= _list_->count)                                                       \
-            return (V){0};                                                                \
-                                                                                          \
-        PFX##_sort(_list_);                                                               \
-                                                                                          \
-        return _list_->buffer[index];                                                     \
-    }                                                                                     \
-                                                                                          \
-    size_t PFX##_indexof(struct SNAME *_list_, V element, bool from_start)                \
-    {                                                                                     \
-        PFX##_sort(_list_);                                                               \
-                                                                                          \
-        if (from_start)                                                                   \
-        {                                                                                 \
-            return PFX##_impl_binary_search_first(_list_, element);                       \
-        }                                                                                 \
-                                                                                          \
-        return PFX##_impl_binary_search_last(_list_, element);                            \
-    }                                                                                     \
-                                                                                          \
-    bool PFX##_contains(struct SNAME *_list_, V element)                                  \
-    {                                                                                     \
-        if (PFX##_empty(_list_))                                                          \
-            return false;                                                                 \
-                                                                                          \
-        PFX##_sort(_list_);                                                               \
-                                                                                          \
-        return PFX##_impl_binary_search_first(_list_, element) < PFX##_count(_list_);     \
-    }                                                                                     \
-                                                                                          \
-    bool PFX##_empty(struct SNAME *_list_)                                                \
-    {                                                                                     \
-        return _list_->count == 0;                                                        \
-    }                                                                                     \
-                                                                                          \
-    bool PFX##_full(struct SNAME *_list_)                                                 \
-    {                                                                                     \
-        return _list_->count >= _list_->capacity;                                         \
-    }                                                                                     \
-                                                                                          \
-    size_t PFX##_count(struct SNAME *_list_)                                              \
-    {                                                                                     \
-        return _list_->count;                                                             \
-    }                                                                                     \
-                                                                                          \
-    size_t PFX##_capacity(struct SNAME *_list_)                                           \
-    {                                                                                     \
-        return _list_->capacity;                                                          \
-    }                                                                                     \
-                                                                                          \
-    bool PFX##_resize(struct SNAME *_list_, size_t capacity)                              \
-    {                                                                                     \
-        if (PFX##_capacity(_list_) == capacity)                                           \
-            return true;                                                                  \
-                                                                                          \
-        if (capacity < PFX##_count(_list_))                                               \
-            return false;                                                                 \
-                                                                                          \
-        V *new_buffer = realloc(_list_->buffer, sizeof(V) * capacity);                    \
-                                                                                          \
-        if (!new_buffer)                                                                  \
-            return false;                                                                 \
-                                                                                          \
-        _list_->buffer = new_buffer;                                                      \
-        _list_->capacity = capacity;                                                      \
-                                                                                          \
-        return true;                                                                      \
-    }                                                                                     \
-                                                                                          \
-    void PFX##_sort(struct SNAME *_list_)                                                 \
-    {                                                                                     \
-        if (!_list_->is_sorted && _list_->count > 1)                                      \
-        {                                                                                 \
-            PFX##_impl_sort_quicksort(_list_->buffer, _list_->cmp, 0, _list_->count - 1); \
-                                                                                          \
-            _list_->is_sorted = true;                                                     \
-        }                                                                                 \
-    }                                                                                     \
-                                                                                          \
-    struct SNAME *PFX##_copy_of(struct SNAME *_list_, V (*copy_func)(V))                  \
-    {                                                                                     \
-        struct SNAME *result = PFX##_new(_list_->capacity, _list_->cmp);                  \
-                                                                                          \
-        if (!result)                                                                      \
-            return NULL;                                                                  \
-                                                                                          \
-        if (copy_func)                                                                    \
-        {                                                                                 \
-            for (size_t i = 0; i < _list_->count; i++)                                    \
-                result->buffer[i] = copy_func(_list_->buffer[i]);                         \
-        }                                                                                 \
-        else                                                                              \
-            memcpy(result->buffer, _list_->buffer, sizeof(V) * _list_->count);            \
-                                                                                          \
-        result->count = _list_->count;                                                    \
-                                                                                          \
-        return result;                                                                    \
-    }                                                                                     \
-                                                                                          \
-    bool PFX##_equals(struct SNAME *_list1_, struct SNAME *_list2_)                       \
-    {                                                                                     \
-        if (PFX##_count(_list1_) != PFX##_count(_list2_))                                 \
-            return false;                                                                 \
-                                                                                          \
-        PFX##_sort(_list1_);                                                              \
-        PFX##_sort(_list2_);                                                              \
-                                                                                          \
-        for (size_t i = 0; i < PFX##_count(_list1_); i++)                                 \
-        {                                                                                 \
-            if (_list1_->cmp(_list1_->buffer[i], _list2_->buffer[i]) != 0)                \
-                return false;                                                             \
-        }                                                                                 \
-                                                                                          \
-        return false;                                                                     \
-    }                                                                                     \
-                                                                                          \
-    struct cmc_string PFX##_to_string(struct SNAME *_list_)                               \
-    {                                                                                     \
-        struct cmc_string str;                                                            \
-        struct SNAME *l_ = _list_;                                                        \
-        const char *name = #SNAME;                                                        \
-                                                                                          \
-        snprintf(str.s, cmc_string_len, cmc_string_fmt_sortedlist,                        \
-                 name, l_, l_->buffer, l_->capacity, l_->count,                           \
-                 l_->is_sorted ? "true" : "false", l_->cmp);                              \
-                                                                                          \
-        return str;                                                                       \
-    }                                                                                     \
-                                                                                          \
-    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                             \
-    {                                                                                     \
-        struct SNAME##_iter *iter = malloc(sizeof(struct SNAME##_iter));                  \
-                                                                                          \
-        if (!iter)                                                                        \
-            return NULL;                                                                  \
-                                                                                          \
-        PFX##_iter_init(iter, target);                                                    \
-                                                                                          \
-        return iter;                                                                      \
-    }                                                                                     \
-                                                                                          \
-    void PFX##_iter_free(struct SNAME##_iter *iter)                                       \
-    {                                                                                     \
-        free(iter);                                                                       \
-    }                                                                                     \
-                                                                                          \
-    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                 \
-    {                                                                                     \
-        PFX##_sort(target);                                                               \
-                                                                                          \
-        iter->target = target;                                                            \
-        iter->cursor = 0;                                                                 \
-        iter->start = true;                                                               \
-        iter->end = PFX##_empty(target);                                                  \
-    }                                                                                     \
-                                                                                          \
-    bool PFX##_iter_start(struct SNAME##_iter *iter)                                      \
-    {                                                                                     \
-        return PFX##_empty(iter->target) || iter->start;                                  \
-    }                                                                                     \
-                                                                                          \
-    bool PFX##_iter_end(struct SNAME##_iter *iter)                                        \
-    {                                                                                     \
-        return PFX##_empty(iter->target) || iter->end;                                    \
-    }                                                                                     \
-                                                                                          \
-    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                   \
-    {                                                                                     \
-        if (!PFX##_empty(iter->target))                                                   \
-        {                                                                                 \
-            iter->cursor = 0;                                                             \
-            iter->start = true;                                                           \
-            iter->end = PFX##_empty(iter->target);                                        \
-        }                                                                                 \
-    }                                                                                     \
-                                                                                          \
-    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                     \
-    {                                                                                     \
-        if (!PFX##_empty(iter->target))                                                   \
-        {                                                                                 \
-            iter->start = PFX##_empty(iter->target);                                      \
-            iter->cursor = PFX##_empty(iter->target) ? 0 : iter->target->count - 1;       \
-            iter->end = true;                                                             \
-        }                                                                                 \
-    }                                                                                     \
-                                                                                          \
-    bool PFX##_iter_next(struct SNAME##_iter *iter)                                       \
-    {                                                                                     \
-        if (iter->end)                                                                    \
-            return false;                                                                 \
-                                                                                          \
-        if (iter->cursor + 1 == PFX##_count(iter->target))                                \
-        {                                                                                 \
-            iter->end = true;                                                             \
-            return false;                                                                 \
-        }                                                                                 \
-                                                                                          \
-        iter->start = PFX##_empty(iter->target);                                          \
-                                                                                          \
-        iter->cursor++;                                                                   \
-                                                                                          \
-        return true;                                                                      \
-    }                                                                                     \
-                                                                                          \
-    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                       \
-    {                                                                                     \
-        if (iter->start)                                                                  \
-            return false;                                                                 \
-                                                                                          \
-        if (iter->cursor == 0)                                                            \
-        {                                                                                 \
-            iter->start = true;                                                           \
-            return false;                                                                 \
-        }                                                                                 \
-                                                                                          \
-        iter->end = PFX##_empty(iter->target);                                            \
-                                                                                          \
-        iter->cursor--;                                                                   \
-                                                                                          \
-        return true;                                                                      \
-    }                                                                                     \
-                                                                                          \
-    /* Returns true only if the iterator moved */                                         \
-    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps)                      \
-    {                                                                                     \
-        if (iter->end)                                                                    \
-            return false;                                                                 \
-                                                                                          \
-        if (iter->cursor + 1 == iter->target->count)                                      \
-        {                                                                                 \
-            iter->end = true;                                                             \
-            return false;                                                                 \
-        }                                                                                 \
-                                                                                          \
-        if (steps == 0 || iter->cursor + steps >= PFX##_count(iter->target))              \
-            return false;                                                                 \
-                                                                                          \
-        iter->start = PFX##_empty(iter->target);                                          \
-                                                                                          \
-        iter->cursor += steps;                                                            \
-                                                                                          \
-        return true;                                                                      \
-    }                                                                                     \
-                                                                                          \
-    /* Returns true only if the iterator moved */                                         \
-    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps)                       \
-    {                                                                                     \
-        if (iter->start)                                                                  \
-            return false;                                                                 \
-                                                                                          \
-        if (iter->cursor == 0)                                                            \
-        {                                                                                 \
-            iter->start = true;                                                           \
-            return false;                                                                 \
-        }                                                                                 \
-                                                                                          \
-        if (steps == 0 || iter->cursor < steps)                                           \
-            return false;                                                                 \
-                                                                                          \
-        iter->end = PFX##_empty(iter->target);                                            \
-                                                                                          \
-        iter->cursor -= steps;                                                            \
-                                                                                          \
-        return true;                                                                      \
-    }                                                                                     \
-                                                                                          \
-    /* Returns true only if the iterator was able to be positioned at the given index */  \
-    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index)                        \
-    {                                                                                     \
-        if (index >= PFX##_count(iter->target))                                           \
-            return false;                                                                 \
-                                                                                          \
-        if (iter->cursor > index)                                                         \
-            return PFX##_iter_rewind(iter, iter->cursor - index);                         \
-        else if (iter->cursor < index)                                                    \
-            return PFX##_iter_advance(iter, index - iter->cursor);                        \
-                                                                                          \
-        return true;                                                                      \
-    }                                                                                     \
-                                                                                          \
-    V PFX##_iter_value(struct SNAME##_iter *iter)                                         \
-    {                                                                                     \
-        if (PFX##_empty(iter->target))                                                    \
-            return (V){0};                                                                \
-                                                                                          \
-        return iter->target->buffer[iter->cursor];                                        \
-    }                                                                                     \
-                                                                                          \
-    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                    \
-    {                                                                                     \
-        return iter->cursor;                                                              \
-    }                                                                                     \
-                                                                                          \
-    static size_t PFX##_impl_binary_search_first(struct SNAME *_list_, V value)           \
-    {                                                                                     \
-        if (PFX##_empty(_list_))                                                          \
-            return 1;                                                                     \
-                                                                                          \
-        size_t L = 0;                                                                     \
-        size_t R = PFX##_count(_list_);                                                   \
-                                                                                          \
-        while (L < R)                                                                     \
-        {                                                                                 \
-            size_t M = L + (R - L) / 2;                                                   \
-                                                                                          \
-            if (_list_->cmp(_list_->buffer[M], value) < 0)                                \
-                L = M + 1;                                                                \
-            else                                                                          \
-                R = M;                                                                    \
-        }                                                                                 \
-                                                                                          \
-        if (_list_->cmp(_list_->buffer[L], value) == 0)                                   \
-            return L;                                                                     \
-                                                                                          \
-        /* Not found */                                                                   \
-        return PFX##_count(_list_);                                                       \
-    }                                                                                     \
-                                                                                          \
-    static size_t PFX##_impl_binary_search_last(struct SNAME *_list_, V value)            \
-    {                                                                                     \
-        if (PFX##_empty(_list_))                                                          \
-            return 1;                                                                     \
-                                                                                          \
-        size_t L = 0;                                                                     \
-        size_t R = PFX##_count(_list_);                                                   \
-                                                                                          \
-        while (L < R)                                                                     \
-        {                                                                                 \
-            size_t M = L + (R - L) / 2;                                                   \
-                                                                                          \
-            if (_list_->cmp(_list_->buffer[M], value) > 0)                                \
-                R = M;                                                                    \
-            else                                                                          \
-                L = M + 1;                                                                \
-        }                                                                                 \
-                                                                                          \
-        if (_list_->cmp(_list_->buffer[L - 1], value) == 0)                               \
-            return L - 1;                                                                 \
-                                                                                          \
-        /* Not found */                                                                   \
-        return PFX##_count(_list_);                                                       \
-    }                                                                                     \
-                                                                                          \
-    /* Characteristics of this quicksort implementation: */                               \
-    /* - Hybrid: uses insertion sort for small arrays */                                  \
-    /* - Partition: Lomuto's Method (can be optimized and use Hoare's Method) */          \
-    /* - Tail recursion: minimize recursion depth */                                      \
-    void PFX##_impl_sort_quicksort(V *array, int (*cmp)(V, V), size_t low, size_t high)   \
-    {                                                                                     \
-        while (low < high)                                                                \
-        {                                                                                 \
-            /* Quicksort performs poorly for smaller arrays so let insertion */           \
-            /* sort do the job */                                                         \
-            if (high - low < 10)                                                          \
-            {                                                                             \
-                PFX##_impl_sort_insertion(array, cmp, low, high);                         \
-                break;                                                                    \
-            }                                                                             \
-            else                                                                          \
-            {                                                                             \
-                /* Partition */                                                           \
-                V pivot = array[high];                                                    \
-                                                                                          \
-                size_t pindex = low;                                                      \
-                                                                                          \
-                for (size_t i = low; i < high; i++)                                       \
-                {                                                                         \
-                    if (cmp(array[i], pivot) <= 0)                                        \
-                    {                                                                     \
-                        V _tmp_ = array[i];                                               \
-                        array[i] = array[pindex];                                         \
-                        array[pindex] = _tmp_;                                            \
-                                                                                          \
-                        pindex++;                                                         \
-                    }                                                                     \
-                }                                                                         \
-                                                                                          \
-                V _tmp_ = array[pindex];                                                  \
-                array[pindex] = array[high];                                              \
-                array[high] = _tmp_;                                                      \
-                                                                                          \
-                /* Tail recursion */                                                      \
-                if (pindex - low < high - pindex)                                         \
-                {                                                                         \
-                    PFX##_impl_sort_quicksort(array, cmp, low, pindex - 1);               \
-                                                                                          \
-                    low = pindex + 1;                                                     \
-                }                                                                         \
-                else                                                                      \
-                {                                                                         \
-                    PFX##_impl_sort_quicksort(array, cmp, pindex + 1, high);              \
-                                                                                          \
-                    high = pindex - 1;                                                    \
-                }                                                                         \
-            }                                                                             \
-        }                                                                                 \
-    }                                                                                     \
-                                                                                          \
-    void PFX##_impl_sort_insertion(V *array, int (*cmp)(V, V), size_t low, size_t high)   \
-    {                                                                                     \
-        for (size_t i = low + 1; i <= high; i++)                                          \
-        {                                                                                 \
-            V _tmp_ = array[i];                                                           \
-            size_t j = i;                                                                 \
-                                                                                          \
-            while (j > low && cmp(array[j - 1], _tmp_) > 0)                               \
-            {                                                                             \
-                array[j] = array[j - 1];                                                  \
-                j--;                                                                      \
-            }                                                                             \
-                                                                                          \
-            array[j] = _tmp_;                                                             \
-        }                                                                                 \
-    }                                                                                     \
-                                                                                          \
-    static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_list_)                  \
-    {                                                                                     \
-        struct SNAME##_iter iter;                                                         \
-                                                                                          \
-        PFX##_iter_init(&iter, _list_);                                                   \
-        PFX##_iter_to_start(&iter);                                                       \
-                                                                                          \
-        return iter;                                                                      \
-    }                                                                                     \
-                                                                                          \
-    static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_list_)                    \
-    {                                                                                     \
-        struct SNAME##_iter iter;                                                         \
-                                                                                          \
-        PFX##_iter_init(&iter, _list_);                                                   \
-        PFX##_iter_to_end(&iter);                                                         \
-                                                                                          \
-        return iter;                                                                      \
+#define CMC_IMPL_SORTEDLIST_SOURCE(PFX, SNAME, V, CMP, TRIVIAL)                          \
+                                                                                         \
+    /* Implementation Detail Functions */                                                \
+    static inline int PFX##_impl_cmp(struct SNAME *_list_, V a, V b);                    \
+    static size_t PFX##_impl_binary_search_first(struct SNAME *_list_, V value);         \
+    static size_t PFX##_impl_binary_search_last(struct SNAME *_list_, V value);          \
+    static void PFX##_impl_low_water(struct SNAME *_list_);                              \
+    static size_t PFX##_impl_find_live(struct SNAME *_list_, V value);                   \
+    static void PFX##_impl_compact(struct SNAME *_list_);                                \
+    static void PFX##_impl_unique(struct SNAME *_list_);                                 \
+    static bool PFX##_impl_grow(struct SNAME *_list_, size_t required);                  \
+    static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_list_);                \
+    static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_list_);                  \
+    static void PFX##_impl_sort_buffer(struct SNAME *_list_, V *array, size_t count);    \
+    static void PFX##_impl_insert_tail(struct SNAME *_list_);                            \
+    static bool PFX##_impl_merge_tail(struct SNAME *_list_);                             \
+    static size_t PFX##_impl_freeze_fill(struct SNAME *_list_, size_t i, size_t node);   \
+    static size_t PFX##_impl_frozen_search(struct SNAME *_list_, V value, bool first);   \
+    static struct SNAME *PFX##_impl_merge(struct SNAME *_list1_, struct SNAME *_list2_,  \
+                                          bool only1, bool both);                        \
+    static struct SNAME *PFX##_impl_gallop_intersection(struct SNAME *small,             \
+                                                        struct SNAME *large);            \
+    static size_t PFX##_impl_gallop(struct SNAME *_list_, size_t from, V value);         \
+                                                                                         \
+    CMC_GENERATE_SORT(PFX##_impl_sort, V, struct SNAME *_list_, _list_, CMP)             \
+    CMC_GENERATE_PARALLEL_SORT(PFX##_impl_parallel_sort, PFX##_impl_sort_buffer, V,      \
+                               struct SNAME *_list_, _list_, CMP)                        \
+    CMC_GENERATE_PARALLEL_REDUCE(PFX##_impl_parallel_reduce, SNAME, V, (V, V),           \
+                                 CMC_IMPL_PARALLEL_ANY, CMC_IMPL_PARALLEL_ELEMENT)       \
+                                                                                         \
+    /* Next element of one of the lists given to merge_k */                              \
+    struct SNAME##_cursor                                                                \
+    {                                                                                    \
+        struct SNAME *list;                                                              \
+        size_t index;                                                                    \
+        size_t order;                                                                    \
+    };                                                                                   \
+                                                                                         \
+    static int PFX##_impl_cursor_cmp(struct SNAME##_cursor a, struct SNAME##_cursor b);  \
+                                                                                         \
+    CMC_GENERATE_HEAP(PFX##_impl_kheap, SNAME##_impl_kheap, struct SNAME##_cursor)       \
+                                                                                         \
+    struct SNAME *PFX##_new(size_t capacity, int (*compare)(V, V))                       \
+    {                                                                                    \
+        return PFX##_new_custom(capacity, compare, NULL);                                \
+    }                                                                                    \
+                                                                                         \
+    struct SNAME *PFX##_new_custom(size_t capacity, int (*compare)(V, V),                \
+                                   struct cmc_alloc_node *alloc)                         \
+    {                                                                                    \
+        if (!alloc)                                                                      \
+            alloc = &cmc_alloc_node_default;                                             \
+                                                                                         \
+        if (capacity < 1)                                                                \
+            return NULL;                                                                 \
+                                                                                         \
+        struct SNAME *_list_ = alloc->malloc(sizeof(struct SNAME));                      \
+                                                                                         \
+        if (CMC_UNLIKELY(!_list_))                                                       \
+            return NULL;                                                                 \
+                                                                                         \
+        _list_->alloc = alloc;                                                           \
+                                                                                         \
+        _list_->buffer = alloc->calloc(capacity, sizeof(V));                             \
+                                                                                         \
+        if (CMC_UNLIKELY(!_list_->buffer))                                               \
+        {                                                                                \
+            alloc->free(_list_);                                                         \
+            return NULL;                                                                 \
+        }                                                                                \
+                                                                                         \
+        _list_->capacity = capacity;                                                     \
+        _list_->count = 0;                                                               \
+        _list_->cmp = compare;                                                           \
+        _list_->sorted = 0;                                                              \
+        _list_->dead = NULL;                                                             \
+        _list_->dead_count = 0;                                                          \
+        _list_->unique = false;                                                          \
+        _list_->frozen = NULL;                                                           \
+        _list_->frozen_index = NULL;                                                     \
+                                                                                         \
+        _list_->it_start = PFX##_impl_it_start;                                          \
+        _list_->it_end = PFX##_impl_it_end;                                              \
+                                                                                         \
+        return _list_;                                                                   \
+    }                                                                                    \
+                                                                                         \
+    /* Creates a list with the size elements, which are only sorted once an */           \
+    /* action requires it, with room for half as many more */                            \
+    struct SNAME *PFX##_new_from(V *elements, size_t size, int (*compare)(V, V))         \
+    {                                                                                    \
+        if (size == 0)                                                                   \
+            return NULL;                                                                 \
+                                                                                         \
+        struct SNAME *_list_ = PFX##_new(size + size / 2, compare);                      \
+                                                                                         \
+        if (CMC_UNLIKELY(!_list_))                                                       \
+            return NULL;                                                                 \
+                                                                                         \
+        memcpy(_list_->buffer, elements, size * sizeof(V));                              \
+                                                                                         \
+        _list_->count = size;                                                            \
+                                                                                         \
+        return _list_;                                                                   \
+    }                                                                                    \
+                                                                                         \
+    void PFX##_clear(struct SNAME *_list_, void (*deallocator)(V))                       \
+    {                                                                                    \
+        PFX##_impl_compact(_list_);                                                      \
+                                                                                         \
+        if (deallocator)                                                                 \
+        {                                                                                \
+            for (size_t i = 0; i < _list_->count; i++)                                   \
+                deallocator(_list_->buffer[i]);                                          \
+        }                                                                                \
+                                                                                         \
+        PFX##_thaw(_list_);                                                              \
+                                                                                         \
+        if (!TRIVIAL)                                                                    \
+            memset(_list_->buffer, 0, sizeof(V) * _list_->capacity);                     \
+                                                                                         \
+        _list_->count = 0;                                                               \
+        _list_->sorted = 0;                                                              \
+    }                                                                                    \
+                                                                                         \
+    void PFX##_free(struct SNAME *_list_, void (*deallocator)(V))                        \
+    {                                                                                    \
+        PFX##_impl_compact(_list_);                                                      \
+                                                                                         \
+        if (deallocator)                                                                 \
+        {                                                                                \
+            for (size_t i = 0; i < _list_->count; i++)                                   \
+                deallocator(_list_->buffer[i]);                                          \
+        }                                                                                \
+                                                                                         \
+        PFX##_thaw(_list_);                                                              \
+                                                                                         \
+        _list_->alloc->free(_list_->buffer);                                             \
+        _list_->alloc->free(_list_);                                                     \
+    }                                                                                    \
+                                                                                         \
+    bool PFX##_insert(struct SNAME *_list_, V element)                                   \
+    {                                                                                    \
+        if (PFX##_full(_list_))                                                          \
+        {                                                                                \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_list_, _list_->count + 1)))               \
+                return false;                                                            \
+        }                                                                                \
+                                                                                         \
+        PFX##_thaw(_list_);                                                              \
+                                                                                         \
+        /* Elements inserted in order keep the list sorted, and an element */            \
+        /* equal to the last one is left for the sort to drop in unique mode */          \
+        if (_list_->sorted == _list_->count)                                             \
+        {                                                                                \
+            int c = -1;                                                                  \
+                                                                                         \
+            if (_list_->count > 0)                                                       \
+                c = PFX##_impl_cmp(_list_, _list_->buffer[_list_->count - 1], element);  \
+                                                                                         \
+            if (c < 0 || (c == 0 && !_list_->unique))                                    \
+                _list_->sorted++;                                                        \
+        }                                                                                \
+                                                                                         \
+        _list_->buffer[_list_->count++] = element;                                       \
+                                                                                         \
+        return true;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    bool PFX##_remove(struct SNAME *_list_, size_t index)                                \
+    {                                                                                    \
+        PFX##_impl_compact(_list_);                                                      \
+                                                                                         \
+        if (index >= _list_->count)                                                      \
+            return false;                                                                \
+                                                                                         \
+        PFX##_thaw(_list_);                                                              \
+                                                                                         \
+        memmove(_list_->buffer + index, _list_->buffer + index + 1,                      \
+                (_list_->count - index - 1) * sizeof(V));                                \
+                                                                                         \
+        _list_->count--;                                                                 \
+                                                                                         \
+        if (!TRIVIAL)                                                                    \
+            _list_->buffer[_list_->count] = (V){0};                                      \
+                                                                                         \
+        if (index < _list_->sorted)                                                      \
+            _list_->sorted--;                                                            \
+                                                                                         \
+        PFX##_impl_low_water(_list_);                                                    \
+                                                                                         \
+        return true;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    /* Removes every element for which pred is true in a single pass that */             \
+    /* moves the others forward, so the sorted ones stay sorted and the */               \
+    /* list is not sorted first. Returns how many were removed */                        \
+    size_t PFX##_remove_if(struct SNAME *_list_, bool (*pred)(V),                        \
+                           void (*deallocator)(V))                                       \
+    {                                                                                    \
+        if (PFX##_empty(_list_))                                                         \
+            return 0;                                                                    \
+                                                                                         \
+        PFX##_thaw(_list_);                                                              \
+        PFX##_impl_compact(_list_);                                                      \
+                                                                                         \
+        size_t kept = 0;                                                                 \
+        size_t sorted = 0;                                                               \
+                                                                                         \
+        for (size_t i = 0; i < _list_->count; i++)                                       \
+        {                                                                                \
+            V element = _list_->buffer[i];                                               \
+                                                                                         \
+            if (!pred(element))                                                          \
+            {                                                                            \
+                if (i < _list_->sorted)                                                  \
+                    sorted++;                                                            \
+                                                                                         \
+                _list_->buffer[kept++] = element;                                        \
+            }                                                                            \
+            else if (deallocator)                                                        \
+                deallocator(element);                                                    \
+        }                                                                                \
+                                                                                         \
+        size_t removed = _list_->count - kept;                                           \
+                                                                                         \
+        if (!TRIVIAL)                                                                    \
+            memset(_list_->buffer + kept, 0, removed * sizeof(V));                       \
+                                                                                         \
+        _list_->count = kept;                                                            \
+        _list_->sorted = sorted;                                                         \
+                                                                                         \
+        if (removed > 0)                                                                 \
+            PFX##_impl_low_water(_list_);                                                \
+                                                                                         \
+        return removed;                                                                  \
+    }                                                                                    \
+                                                                                         \
+    /* Marks an element equal to the given one as removed without moving the */          \
+    /* others. Marked elements are skipped by contains() and count() and */              \
+    /* dropped all at once by the next sort, so a run of removals moves the */           \
+    /* buffer only once. Returns false if there was no such element */                   \
+    bool PFX##_remove_lazy(struct SNAME *_list_, V element)                              \
+    {                                                                                    \
+        if (PFX##_empty(_list_))                                                         \
+            return false;                                                                \
+                                                                                         \
+        if (_list_->sorted < _list_->count)                                              \
+            PFX##_sort(_list_);                                                          \
+                                                                                         \
+        size_t index = PFX##_impl_find_live(_list_, element);                            \
+                                                                                         \
+        if (index == _list_->count)                                                      \
+            return false;                                                                \
+                                                                                         \
+        if (!_list_->dead)                                                               \
+        {                                                                                \
+            _list_->dead = _list_->alloc->calloc((_list_->capacity + 63) / 64,           \
+                                                 sizeof(uint64_t));                      \
+                                                                                         \
+            /* Without the bit set the element is removed right away */                  \
+            if (CMC_UNLIKELY(!_list_->dead))                                             \
+                return PFX##_remove(_list_, index);                                      \
+        }                                                                                \
+                                                                                         \
+        PFX##_thaw(_list_);                                                              \
+                                                                                         \
+        _list_->dead[index / 64] |= UINT64_C(1) << (index % 64);                         \
+        _list_->dead_count++;                                                            \
+                                                                                         \
+        return true;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    bool PFX##_min(struct SNAME *_list_, V *result)                                      \
+    {                                                                                    \
+        if (PFX##_empty(_list_))                                                         \
+            return false;                                                                \
+                                                                                         \
+        PFX##_sort(_list_);                                                              \
+                                                                                         \
+        *result = _list_->buffer[0];                                                     \
+                                                                                         \
+        return true;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    bool PFX##_max(struct SNAME *_list_, V *result)                                      \
+    {                                                                                    \
+        if (PFX##_empty(_list_))                                                         \
+            return false;                                                                \
+                                                                                         \
+        PFX##_sort(_list_);                                                              \
+                                                                                         \
+        *result = _list_->buffer[_list_->count - 1];                                     \
+                                                                                         \
+        return true;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    V PFX##_get(struct SNAME *_list_, size_t index)                                      \
+    {                                                                                    \
+        PFX##_sort(_list_);                                                              \
+                                                                                         \
+        if (index >= _list_->count)                                                      \
+            return (V){0};                                                               \
+                                                                                         \
+        return _list_->buffer[index];                                                    \
+    }                                                                                    \
+                                                                                         \
+    size_t PFX##_indexof(struct SNAME *_list_, V element, bool from_start)               \
+    {                                                                                    \
+        PFX##_sort(_list_);                                                              \
+                                                                                         \
+        if (from_start)                                                                  \
+        {                                                                                \
+            return PFX##_impl_binary_search_first(_list_, element);                      \
+        }                                                                                \
+                                                                                         \
+        return PFX##_impl_binary_search_last(_list_, element);                           \
+    }                                                                                    \
+                                                                                         \
+    bool PFX##_contains(struct SNAME *_list_, V element)                                 \
+    {                                                                                    \
+        if (PFX##_empty(_list_))                                                         \
+            return false;                                                                \
+                                                                                         \
+        /* Removed elements are skipped so that they are not dropped yet */              \
+        if (_list_->sorted < _list_->count)                                              \
+            PFX##_sort(_list_);                                                          \
+                                                                                         \
+        return PFX##_impl_find_live(_list_, element) < _list_->count;                    \
+    }                                                                                    \
+                                                                                         \
+    bool PFX##_empty(struct SNAME *_list_)                                               \
+    {                                                                                    \
+        return _list_->count == _list_->dead_count;                                      \
+    }                                                                                    \
+                                                                                         \
+    bool PFX##_full(struct SNAME *_list_)                                                \
+    {                                                                                    \
+        return _list_->count >= _list_->capacity;                                        \
+    }                                                                                    \
+                                                                                         \
+    /* In unique mode, elements inserted since the last sort are counted */              \
+    /* even if they are duplicates */                                                    \
+    size_t PFX##_count(struct SNAME *_list_)                                             \
+    {                                                                                    \
+        return _list_->count - _list_->dead_count;                                       \
+    }                                                                                    \
+                                                                                         \
+    size_t PFX##_memory_usage(struct SNAME *_list_)                                      \
+    {                                                                                    \
+        size_t bytes = sizeof(struct SNAME) + sizeof(V) * _list_->capacity;              \
+                                                                                         \
+        /* The list is not modified while it is frozen */                                \
+        if (_list_->frozen)                                                              \
+            bytes += (sizeof(V) + sizeof(size_t)) * (_list_->count + 1);                 \
+                                                                                         \
+        if (_list_->dead)                                                                \
+            bytes += sizeof(uint64_t) * ((_list_->capacity + 63) / 64);                  \
+                                                                                         \
+        return bytes;                                                                    \
+    }                                                                                    \
+                                                                                         \
+    size_t PFX##_capacity(struct SNAME *_list_)                                          \
+    {                                                                                    \
+        return _list_->capacity;                                                         \
+    }                                                                                    \
+                                                                                         \
+    bool PFX##_resize(struct SNAME *_list_, size_t capacity)                             \
+    {                                                                                    \
+        if (PFX##_capacity(_list_) == capacity)                                          \
+            return true;                                                                 \
+                                                                                         \
+        /* The bit set of removed elements is sized by the capacity */                   \
+        PFX##_impl_compact(_list_);                                                      \
+                                                                                         \
+        if (capacity < PFX##_count(_list_))                                              \
+            return false;                                                                \
+                                                                                         \
+        V *new_buffer = _list_->alloc->realloc(_list_->buffer, sizeof(V) * capacity);    \
+                                                                                         \
+        if (CMC_UNLIKELY(!new_buffer))                                                   \
+            return false;                                                                \
+                                                                                         \
+        _list_->buffer = new_buffer;                                                     \
+        _list_->capacity = capacity;                                                     \
+                                                                                         \
+        return true;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    bool PFX##_shrink_to_fit(struct SNAME *_list_)                                       \
+    {                                                                                    \
+        return PFX##_resize(_list_, _list_->count > 0 ? _list_->count : 1);              \
+    }                                                                                    \
+                                                                                         \
+    /* Grows the buffer so that at least capacity elements fit. Unlike */                \
+    /* resize it never shrinks the buffer */                                             \
+    bool PFX##_reserve(struct SNAME *_list_, size_t capacity)                            \
+    {                                                                                    \
+        if (capacity <= _list_->capacity)                                                \
+            return true;                                                                 \
+                                                                                         \
+        return PFX##_resize(_list_, capacity);                                           \
+    }                                                                                    \
+                                                                                         \
+    /* Also drops the elements removed by remove_lazy and, in unique mode, */            \
+    /* the duplicates of the elements inserted since the last sort */                    \
+    void PFX##_sort(struct SNAME *_list_)                                                \
+    {                                                                                    \
+        PFX##_impl_compact(_list_);                                                      \
+                                                                                         \
+        size_t sorted = _list_->sorted;                                                  \
+        size_t tail = _list_->count - sorted;                                            \
+                                                                                         \
+        if (tail == 0)                                                                   \
+            return;                                                                      \
+                                                                                         \
+        if (sorted == 0)                                                                 \
+            PFX##_impl_sort_buffer(_list_, _list_->buffer, _list_->count);               \
+        else if (tail <= CMC_SORTEDLIST_INSERTION_TAIL)                                  \
+            PFX##_impl_insert_tail(_list_);                                              \
+        else                                                                             \
+        {                                                                                \
+            PFX##_impl_sort_buffer(_list_, _list_->buffer + sorted, tail);               \
+                                                                                         \
+            if (!PFX##_impl_merge_tail(_list_))                                          \
+                PFX##_impl_sort_buffer(_list_, _list_->buffer, _list_->count);           \
+        }                                                                                \
+                                                                                         \
+        _list_->sorted = _list_->count;                                                  \
+                                                                                         \
+        if (_list_->unique)                                                              \
+            PFX##_impl_unique(_list_);                                                   \
+    }                                                                                    \
+                                                                                         \
+    /* In unique mode the list behaves as a set, keeping one of each equal */            \
+    /* elements. The others are dropped without being deallocated */                     \
+    void PFX##_set_unique(struct SNAME *_list_, bool enabled)                            \
+    {                                                                                    \
+        if (enabled && !_list_->unique)                                                  \
+        {                                                                                \
+            PFX##_sort(_list_);                                                          \
+            PFX##_thaw(_list_);                                                          \
+            PFX##_impl_unique(_list_);                                                   \
+        }                                                                                \
+                                                                                         \
+        _list_->unique = enabled;                                                        \
+    }                                                                                    \
+                                                                                         \
+    /* Sorts every element again with up to the given amount of threads */               \
+    void PFX##_sort_parallel(struct SNAME *_list_, size_t threads)                       \
+    {                                                                                    \
+        PFX##_impl_compact(_list_);                                                      \
+                                                                                         \
+        if (_list_->sorted == _list_->count)                                             \
+            return;                                                                      \
+                                                                                         \
+        PFX##_impl_parallel_sort(_list_, _list_->buffer, _list_->count, threads);        \
+                                                                                         \
+        _list_->sorted = _list_->count;                                                  \
+                                                                                         \
+        if (_list_->unique)                                                              \
+            PFX##_impl_unique(_list_);                                                   \
+    }                                                                                    \
+                                                                                         \
+    /* A parallel scan has one slot for each element, which are sorted */                \
+    /* first so they are visited in order */                                             \
+    size_t PFX##_parallel_slots(struct SNAME *_list_)                                    \
+    {                                                                                    \
+        PFX##_sort(_list_);                                                              \
+                                                                                         \
+        return _list_->count;                                                            \
+    }                                                                                    \
+                                                                                         \
+    /* Sorts the list, splits it into contiguous ranges, one for each of up */           \
+    /* to the given amount of threads, and combines the results of each range */         \
+    V PFX##_parallel_reduce(struct SNAME *_list_, V initial, V (*reduce)(V, V),          \
+                            V (*combine)(V, V), size_t threads)                          \
+    {                                                                                    \
+        PFX##_sort_parallel(_list_, threads);                                            \
+                                                                                         \
+        return PFX##_impl_parallel_reduce(_list_, _list_->count, initial, reduce,        \
+                                          combine, threads);                             \
+    }                                                                                    \
+                                                                                         \
+    bool PFX##_freeze(struct SNAME *_list_)                                              \
+    {                                                                                    \
+        if (_list_->frozen)                                                              \
+            return true;                                                                 \
+                                                                                         \
+        PFX##_sort(_list_);                                                              \
+                                                                                         \
+        _list_->frozen = _list_->alloc->malloc(sizeof(V) * (_list_->count + 1));         \
+        _list_->frozen_index =                                                           \
+            _list_->alloc->malloc(sizeof(size_t) * (_list_->count + 1));                 \
+                                                                                         \
+        if (!_list_->frozen || !_list_->frozen_index)                                    \
+        {                                                                                \
+            PFX##_thaw(_list_);                                                          \
+            return false;                                                                \
+        }                                                                                \
+                                                                                         \
+        PFX##_impl_freeze_fill(_list_, 0, 1);                                            \
+                                                                                         \
+        return true;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    void PFX##_thaw(struct SNAME *_list_)                                                \
+    {                                                                                    \
+        _list_->alloc->free(_list_->frozen);                                             \
+        _list_->alloc->free(_list_->frozen_index);                                       \
+                                                                                         \
+        _list_->frozen = NULL;                                                           \
+        _list_->frozen_index = NULL;                                                     \
+    }                                                                                    \
+                                                                                         \
+    struct SNAME *PFX##_copy_of(struct SNAME *_list_, V (*copy_func)(V))                 \
+    {                                                                                    \
+        PFX##_impl_compact(_list_);                                                      \
+                                                                                         \
+        struct SNAME *result =                                                           \
+            PFX##_new_custom(_list_->capacity, _list_->cmp, _list_->alloc);              \
+                                                                                         \
+        if (!result)                                                                     \
+            return NULL;                                                                 \
+                                                                                         \
+        if (copy_func)                                                                   \
+        {                                                                                \
+            for (size_t i = 0; i < _list_->count; i++)                                   \
+                result->buffer[i] = copy_func(_list_->buffer[i]);                        \
+        }                                                                                \
+        else                                                                             \
+            memcpy(result->buffer, _list_->buffer, sizeof(V) * _list_->count);           \
+                                                                                         \
+        result->count = _list_->count;                                                   \
+        result->unique = _list_->unique;                                                 \
+                                                                                         \
+        return result;                                                                   \
+    }                                                                                    \
+                                                                                         \
+    /* Copies up to size elements, in sorted order, to elements and returns */           \
+    /* how many were copied */                                                           \
+    size_t PFX##_to_array(struct SNAME *_list_, V *CMC_RESTRICT elements, size_t size)   \
+    {                                                                                    \
+        PFX##_sort(_list_);                                                              \
+                                                                                         \
+        if (size > _list_->count)                                                        \
+            size = _list_->count;                                                        \
+                                                                                         \
+        memcpy(elements, _list_->buffer, size * sizeof(V));                              \
+                                                                                         \
+        return size;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    bool PFX##_equals(struct SNAME *_list1_, struct SNAME *_list2_)                      \
+    {                                                                                    \
+        if (PFX##_count(_list1_) != PFX##_count(_list2_))                                \
+            return false;                                                                \
+                                                                                         \
+        PFX##_sort(_list1_);                                                             \
+        PFX##_sort(_list2_);                                                             \
+                                                                                         \
+        for (size_t i = 0; i < PFX##_count(_list1_); i++)                                \
+        {                                                                                \
+            if (PFX##_impl_cmp(_list1_, _list1_->buffer[i], _list2_->buffer[i]) != 0)    \
+                return false;                                                            \
+        }                                                                                \
+                                                                                         \
+        return false;                                                                    \
+    }                                                                                    \
+                                                                                         \
+    struct cmc_string PFX##_to_string(struct SNAME *_list_)                              \
+    {                                                                                    \
+        struct cmc_string str;                                                           \
+        struct SNAME *l_ = _list_;                                                       \
+        const char *name = #SNAME;                                                       \
+                                                                                         \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_sortedlist,                       \
+                 name, l_, l_->buffer, l_->capacity, l_->count,                          \
+                 l_->sorted, l_->cmp);                                                   \
+                                                                                         \
+        return str;                                                                      \
+    }                                                                                    \
+                                                                                         \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE)                       \
+                                                                                         \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE, (V))                         \
+                                                                                         \
+    bool PFX##_save(struct SNAME *_list_, FILE *file, bool (*writer)(V, FILE *))         \
+    {                                                                                    \
+        uint32_t flags = writer ? 0 : CMC_SERIAL_RAW_VALUES;                             \
+                                                                                         \
+        PFX##_impl_compact(_list_);                                                      \
+                                                                                         \
+        if (!cmc_serial_write_header(file, "sortedlist", flags, 0, sizeof(V),            \
+                                     _list_->sorted == _list_->count, _list_->count,     \
+                                     _list_->capacity, 0))                               \
+            return false;                                                                \
+                                                                                         \
+        /* Without a writer the whole buffer is written at once */                       \
+        if (!writer)                                                                     \
+            return fwrite(_list_->buffer, sizeof(V), _list_->count, file) ==             \
+                   _list_->count;                                                        \
+                                                                                         \
+        for (size_t i = 0; i < _list_->count; i++)                                       \
+        {                                                                                \
+            if (!writer(_list_->buffer[i], file))                                        \
+                return false;                                                            \
+        }                                                                                \
+                                                                                         \
+        return true;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    /* The reader is only used if the list was saved with a writer */                    \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(V, V),                        \
+                                bool (*reader)(V *, FILE *))                             \
+    {                                                                                    \
+        struct cmc_serial_header header;                                                 \
+                                                                                         \
+        if (!cmc_serial_read_header(file, "sortedlist", 0, sizeof(V), &header))          \
+            return NULL;                                                                 \
+                                                                                         \
+        if (header.capacity < header.count)                                              \
+            return NULL;                                                                 \
+                                                                                         \
+        /* Allocated with the saved capacity so that loading never grows */              \
+        struct SNAME *_list_ = PFX##_new(header.capacity, compare);                      \
+                                                                                         \
+        if (CMC_UNLIKELY(!_list_))                                                       \
+            return NULL;                                                                 \
+                                                                                         \
+        if (header.flags & CMC_SERIAL_RAW_VALUES)                                        \
+            _list_->count = fread(_list_->buffer, sizeof(V), header.count, file);        \
+        else                                                                             \
+        {                                                                                \
+            while (_list_->count < header.count &&                                       \
+                   CMC_SERIAL_READ(false, reader, &(_list_->buffer[_list_->count]),      \
+                                   file))                                                \
+                _list_->count++;                                                         \
+        }                                                                                \
+                                                                                         \
+        if (_list_->count != header.count)                                               \
+        {                                                                                \
+            PFX##_free(_list_, NULL);                                                    \
+            return NULL;                                                                 \
+        }                                                                                \
+                                                                                         \
+        _list_->sorted = header.extra != 0 ? _list_->count : 0;                          \
+                                                                                         \
+        return _list_;                                                                   \
+    }                                                                                    \
+                                                                                         \
+    /* The set operations sort both lists and merge them in linear time, */              \
+    /* except for an intersection with a much smaller list. They return */               \
+    /* NULL if the result could not be allocated */                                      \
+    struct SNAME *PFX##_union(struct SNAME *_list1_, struct SNAME *_list2_)              \
+    {                                                                                    \
+        return PFX##_impl_merge(_list1_, _list2_, true, true);                           \
+    }                                                                                    \
+                                                                                         \
+    struct SNAME *PFX##_intersection(struct SNAME *_list1_, struct SNAME *_list2_)       \
+    {                                                                                    \
+        PFX##_sort(_list1_);                                                             \
+        PFX##_sort(_list2_);                                                             \
+                                                                                         \
+        if (_list1_->count * CMC_SORTEDLIST_GALLOP_RATIO <= _list2_->count)              \
+            return PFX##_impl_gallop_intersection(_list1_, _list2_);                     \
+        if (_list2_->count * CMC_SORTEDLIST_GALLOP_RATIO <= _list1_->count)              \
+            return PFX##_impl_gallop_intersection(_list2_, _list1_);                     \
+                                                                                         \
+        return PFX##_impl_merge(_list1_, _list2_, false, true);                          \
+    }                                                                                    \
+                                                                                         \
+    struct SNAME *PFX##_difference(struct SNAME *_list1_, struct SNAME *_list2_)         \
+    {                                                                                    \
+        return PFX##_impl_merge(_list1_, _list2_, true, false);                          \
+    }                                                                                    \
+                                                                                         \
+    /* Merges k lists into a new one, taking the next element of each list */            \
+    /* out of a heap. Returns NULL if k is 0 or if it could not allocate */              \
+    struct SNAME *PFX##_merge_k(struct SNAME **lists, size_t k)                          \
+    {                                                                                    \
+        if (k == 0)                                                                      \
+            return NULL;                                                                 \
+                                                                                         \
+        size_t total = 0;                                                                \
+                                                                                         \
+        for (size_t i = 0; i < k; i++)                                                   \
+        {                                                                                \
+            PFX##_sort(lists[i]);                                                        \
+            total += lists[i]->count;                                                    \
+        }                                                                                \
+                                                                                         \
+        struct SNAME *result = PFX##_new(total > 0 ? total : 1, lists[0]->cmp);          \
+                                                                                         \
+        if (CMC_UNLIKELY(!result))                                                       \
+            return NULL;                                                                 \
+                                                                                         \
+        struct SNAME##_impl_kheap *heap =                                                \
+            PFX##_impl_kheap_new(k, cmc_min_heap, PFX##_impl_cursor_cmp);                \
+                                                                                         \
+        if (!heap)                                                                       \
+        {                                                                                \
+            PFX##_free(result, NULL);                                                    \
+            return NULL;                                                                 \
+        }                                                                                \
+                                                                                         \
+        for (size_t i = 0; i < k; i++)                                                   \
+        {                                                                                \
+            struct SNAME##_cursor cursor = { lists[i], 0, i };                           \
+                                                                                         \
+            if (lists[i]->count > 0)                                                     \
+                PFX##_impl_kheap_insert(heap, cursor);                                   \
+        }                                                                                \
+                                                                                         \
+        struct SNAME##_cursor cursor;                                                    \
+                                                                                         \
+        while (PFX##_impl_kheap_remove(heap, &cursor))                                   \
+        {                                                                                \
+            result->buffer[result->count++] = cursor.list->buffer[cursor.index++];       \
+                                                                                         \
+            if (cursor.index < cursor.list->count &&                                     \
+                !PFX##_impl_kheap_insert(heap, cursor))                                  \
+            {                                                                            \
+                PFX##_impl_kheap_free(heap, NULL);                                       \
+                PFX##_free(result, NULL);                                                \
+                return NULL;                                                             \
+            }                                                                            \
+        }                                                                                \
+                                                                                         \
+        PFX##_impl_kheap_free(heap, NULL);                                               \
+                                                                                         \
+        result->sorted = result->count;                                                  \
+                                                                                         \
+        return result;                                                                   \
+    }                                                                                    \
+                                                                                         \
+    /* Sorts the list and writes its elements as they are in memory, to be */            \
+    /* opened by a MappedSortedSet. Every step-th element is also written to */          \
+    /* a sparse index, that is left out if step is 0 */                                  \
+    bool PFX##_save_flat(struct SNAME *_list_, FILE *file, size_t step)                  \
+    {                                                                                    \
+        uint32_t flags = CMC_SERIAL_FLAT | CMC_SERIAL_RAW_KEYS;                          \
+                                                                                         \
+        if (step > UINT32_MAX)                                                           \
+            return false;                                                                \
+                                                                                         \
+        PFX##_sort(_list_);                                                              \
+                                                                                         \
+        if (!cmc_serial_write_header(file, "sortedlist", flags, sizeof(V), 0,            \
+                                     (uint32_t)step, _list_->count, _list_->count, 0))   \
+            return false;                                                                \
+                                                                                         \
+        if (fwrite(_list_->buffer, sizeof(V), _list_->count, file) != _list_->count ||   \
+            !cmc_serial_flat_pad(file, _list_->count * sizeof(V)))                       \
+            return false;                                                                \
+                                                                                         \
+        for (size_t i = 0; step > 0 && i < _list_->count; i += step)                     \
+        {                                                                                \
+            if (fwrite(&_list_->buffer[i], sizeof(V), 1, file) != 1)                     \
+                return false;                                                            \
+        }                                                                                \
+                                                                                         \
+        size_t indexed = cmc_serial_flat_indexed(_list_->count, step);                   \
+                                                                                         \
+        return cmc_serial_flat_pad(file, indexed * sizeof(V));                           \
+    }                                                                                    \
+                                                                                         \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                            \
+    {                                                                                    \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));  \
+                                                                                         \
+        if (CMC_UNLIKELY(!iter))                                                         \
+            return NULL;                                                                 \
+                                                                                         \
+        PFX##_iter_init(iter, target);                                                   \
+                                                                                         \
+        return iter;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    void PFX##_iter_free(struct SNAME##_iter *iter)                                      \
+    {                                                                                    \
+        iter->target->alloc->free(iter);                                                 \
+    }                                                                                    \
+                                                                                         \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                \
+    {                                                                                    \
+        PFX##_sort(target);                                                              \
+                                                                                         \
+        iter->target = target;                                                           \
+        iter->cursor = 0;                                                                \
+        iter->start = true;                                                              \
+        iter->end = PFX##_empty(target);                                                 \
+    }                                                                                    \
+                                                                                         \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                     \
+    {                                                                                    \
+        return PFX##_empty(iter->target) || iter->start;                                 \
+    }                                                                                    \
+                                                                                         \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                       \
+    {                                                                                    \
+        return PFX##_empty(iter->target) || iter->end;                                   \
+    }                                                                                    \
+                                                                                         \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                  \
+    {                                                                                    \
+        if (!PFX##_empty(iter->target))                                                  \
+        {                                                                                \
+            iter->cursor = 0;                                                            \
+            iter->start = true;                                                          \
+            iter->end = PFX##_empty(iter->target);                                       \
+        }                                                                                \
+    }                                                                                    \
+                                                                                         \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                    \
+    {                                                                                    \
+        if (!PFX##_empty(iter->target))                                                  \
+        {                                                                                \
+            iter->start = PFX##_empty(iter->target);                                     \
+            iter->cursor = PFX##_empty(iter->target) ? 0 : iter->target->count - 1;      \
+            iter->end = true;                                                            \
+        }                                                                                \
+    }                                                                                    \
+                                                                                         \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                      \
+    {                                                                                    \
+        if (iter->end)                                                                   \
+            return false;                                                                \
+                                                                                         \
+        if (iter->cursor + 1 == PFX##_count(iter->target))                               \
+        {                                                                                \
+            iter->end = true;                                                            \
+            return false;                                                                \
+        }                                                                                \
+                                                                                         \
+        iter->start = PFX##_empty(iter->target);                                         \
+                                                                                         \
+        iter->cursor++;                                                                  \
+                                                                                         \
+        return true;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                      \
+    {                                                                                    \
+        if (iter->start)                                                                 \
+            return false;                                                                \
+                                                                                         \
+        if (iter->cursor == 0)                                                           \
+        {                                                                                \
+            iter->start = true;                                                          \
+            return false;                                                                \
+        }                                                                                \
+                                                                                         \
+        iter->end = PFX##_empty(iter->target);                                           \
+                                                                                         \
+        iter->cursor--;                                                                  \
+                                                                                         \
+        return true;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    /* Returns true only if the iterator moved */                                        \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps)                     \
+    {                                                                                    \
+        if (iter->end)                                                                   \
+            return false;                                                                \
+                                                                                         \
+        if (iter->cursor + 1 == iter->target->count)                                     \
+        {                                                                                \
+            iter->end = true;                                                            \
+            return false;                                                                \
+        }                                                                                \
+                                                                                         \
+        if (steps == 0 || iter->cursor + steps >= PFX##_count(iter->target))             \
+            return false;                                                                \
+                                                                                         \
+        iter->start = PFX##_empty(iter->target);                                         \
+                                                                                         \
+        iter->cursor += steps;                                                           \
+                                                                                         \
+        return true;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    /* Returns true only if the iterator moved */                                        \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps)                      \
+    {                                                                                    \
+        if (iter->start)                                                                 \
+            return false;                                                                \
+                                                                                         \
+        if (iter->cursor == 0)                                                           \
+        {                                                                                \
+            iter->start = true;                                                          \
+            return false;                                                                \
+        }                                                                                \
+                                                                                         \
+        if (steps == 0 || iter->cursor < steps)                                          \
+            return false;                                                                \
+                                                                                         \
+        iter->end = PFX##_empty(iter->target);                                           \
+                                                                                         \
+        iter->cursor -= steps;                                                           \
+                                                                                         \
+        return true;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    /* Returns true only if the iterator was able to be positioned at the given index */ \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index)                       \
+    {                                                                                    \
+        if (index >= PFX##_count(iter->target))                                          \
+            return false;                                                                \
+                                                                                         \
+        if (iter->cursor > index)                                                        \
+            return PFX##_iter_rewind(iter, iter->cursor - index);                        \
+        else if (iter->cursor < index)                                                   \
+            return PFX##_iter_advance(iter, index - iter->cursor);                       \
+                                                                                         \
+        return true;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    /* Places iter at the element of a slot, for CMC_PARALLEL_FOR_EACH */                \
+    bool PFX##_parallel_iter(struct SNAME##_iter *iter, struct SNAME *target,            \
+                             size_t slot)                                                \
+    {                                                                                    \
+        iter->target = target;                                                           \
+        iter->cursor = slot;                                                             \
+        iter->start = slot == 0;                                                         \
+        iter->end = slot + 1 >= target->count;                                           \
+                                                                                         \
+        return slot < target->count;                                                     \
+    }                                                                                    \
+                                                                                         \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                        \
+    {                                                                                    \
+        if (PFX##_empty(iter->target))                                                   \
+            return (V){0};                                                               \
+                                                                                         \
+        return iter->target->buffer[iter->cursor];                                       \
+    }                                                                                    \
+                                                                                         \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                   \
+    {                                                                                    \
+        return iter->cursor;                                                             \
+    }                                                                                    \
+                                                                                         \
+    /* The elements from index from to index to, both inclusive, once the */             \
+    /* list is sorted, or an empty view if the range is not in the list */               \
+    struct SNAME##_view PFX##_view(struct SNAME *_list_, size_t from, size_t to)         \
+    {                                                                                    \
+        struct SNAME##_view view = { NULL, 0, _list_ };                                  \
+                                                                                         \
+        if (from > to || to >= _list_->count)                                            \
+            return view;                                                                 \
+                                                                                         \
+        PFX##_sort(_list_);                                                              \
+                                                                                         \
+        view.data = _list_->buffer + from;                                               \
+        view.count = to - from + 1;                                                      \
+                                                                                         \
+        return view;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    /* The elements that are greater than or equal to low and less than or */            \
+    /* equal to high, found with two binary searches */                                  \
+    struct SNAME##_view PFX##_view_range(struct SNAME *_list_, V low, V high)            \
+    {                                                                                    \
+        struct SNAME##_view view = { NULL, 0, _list_ };                                  \
+                                                                                         \
+        if (PFX##_empty(_list_))                                                         \
+            return view;                                                                 \
+                                                                                         \
+        PFX##_sort(_list_);                                                              \
+                                                                                         \
+        view.data = _list_->buffer;                                                      \
+        view.count = _list_->count;                                                      \
+                                                                                         \
+        size_t from = PFX##_view_lower_bound(view, low);                                 \
+        size_t to = PFX##_view_upper_bound(view, high);                                  \
+                                                                                         \
+        view.data += from;                                                               \
+        view.count = to > from ? to - from : 0;                                          \
+                                                                                         \
+        return view;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    /* Narrows a view in the same way as PFX_view narrows a list */                      \
+    struct SNAME##_view PFX##_view_slice(struct SNAME##_view view, size_t from,          \
+                                         size_t to)                                      \
+    {                                                                                    \
+        struct SNAME##_view result = { NULL, 0, view.target };                           \
+                                                                                         \
+        if (from > to || to >= view.count)                                               \
+            return result;                                                               \
+                                                                                         \
+        result.data = view.data + from;                                                  \
+        result.count = to - from + 1;                                                    \
+                                                                                         \
+        return result;                                                                   \
+    }                                                                                    \
+                                                                                         \
+    V PFX##_view_get(struct SNAME##_view view, size_t index)                             \
+    {                                                                                    \
+        if (index >= view.count)                                                         \
+            return (V){0};                                                               \
+                                                                                         \
+        return view.data[index];                                                         \
+    }                                                                                    \
+                                                                                         \
+    /* Returns the count of the view if the element is not in it */                      \
+    size_t PFX##_view_indexof(struct SNAME##_view view, V element, bool from_start)      \
+    {                                                                                    \
+        if (from_start)                                                                  \
+        {                                                                                \
+            size_t i = PFX##_view_lower_bound(view, element);                            \
+                                                                                         \
+            if (i < view.count &&                                                        \
+                PFX##_impl_cmp(view.target, view.data[i], element) == 0)                 \
+                return i;                                                                \
+        }                                                                                \
+        else                                                                             \
+        {                                                                                \
+            size_t i = PFX##_view_upper_bound(view, element);                            \
+                                                                                         \
+            if (i > 0 && PFX##_impl_cmp(view.target, view.data[i - 1], element) == 0)    \
+                return i - 1;                                                            \
+        }                                                                                \
+                                                                                         \
+        return view.count;                                                               \
+    }                                                                                    \
+                                                                                         \
+    bool PFX##_view_contains(struct SNAME##_view view, V element)                        \
+    {                                                                                    \
+        return PFX##_view_indexof(view, element, true) < view.count;                     \
+    }                                                                                    \
+                                                                                         \
+    /* Index of the first element that is not less than element */                       \
+    size_t PFX##_view_lower_bound(struct SNAME##_view view, V element)                   \
+    {                                                                                    \
+        size_t L = 0;                                                                    \
+        size_t R = view.count;                                                           \
+                                                                                         \
+        while (L < R)                                                                    \
+        {                                                                                \
+            size_t M = L + (R - L) / 2;                                                  \
+                                                                                         \
+            if (PFX##_impl_cmp(view.target, view.data[M], element) < 0)                  \
+                L = M + 1;                                                               \
+            else                                                                         \
+                R = M;                                                                   \
+        }                                                                                \
+                                                                                         \
+        return L;                                                                        \
+    }                                                                                    \
+                                                                                         \
+    /* Index of the first element that is greater than element */                        \
+    size_t PFX##_view_upper_bound(struct SNAME##_view view, V element)                   \
+    {                                                                                    \
+        size_t L = 0;                                                                    \
+        size_t R = view.count;                                                           \
+                                                                                         \
+        while (L < R)                                                                    \
+        {                                                                                \
+            size_t M = L + (R - L) / 2;                                                  \
+                                                                                         \
+            if (PFX##_impl_cmp(view.target, view.data[M], element) > 0)                  \
+                R = M;                                                                   \
+            else                                                                         \
+                L = M + 1;                                                               \
+        }                                                                                \
+                                                                                         \
+        return L;                                                                        \
+    }                                                                                    \
+                                                                                         \
+    void PFX##_view_iter_init(struct SNAME##_view_iter *iter,                            \
+                              struct SNAME##_view view)                                  \
+    {                                                                                    \
+        iter->view = view;                                                               \
+        iter->cursor = 0;                                                                \
+        iter->start = true;                                                              \
+        iter->end = view.count == 0;                                                     \
+    }                                                                                    \
+                                                                                         \
+    bool PFX##_view_iter_start(struct SNAME##_view_iter *iter)                           \
+    {                                                                                    \
+        return iter->view.count == 0 || iter->start;                                     \
+    }                                                                                    \
+                                                                                         \
+    bool PFX##_view_iter_end(struct SNAME##_view_iter *iter)                             \
+    {                                                                                    \
+        return iter->view.count == 0 || iter->end;                                       \
+    }                                                                                    \
+                                                                                         \
+    bool PFX##_view_iter_next(struct SNAME##_view_iter *iter)                            \
+    {                                                                                    \
+        if (iter->end)                                                                   \
+            return false;                                                                \
+                                                                                         \
+        if (iter->cursor + 1 == iter->view.count)                                        \
+        {                                                                                \
+            iter->end = true;                                                            \
+            return false;                                                                \
+        }                                                                                \
+                                                                                         \
+        iter->start = false;                                                             \
+                                                                                         \
+        iter->cursor++;                                                                  \
+                                                                                         \
+        return true;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    bool PFX##_view_iter_prev(struct SNAME##_view_iter *iter)                            \
+    {                                                                                    \
+        if (iter->start)                                                                 \
+            return false;                                                                \
+                                                                                         \
+        if (iter->cursor == 0)                                                           \
+        {                                                                                \
+            iter->start = true;                                                          \
+            return false;                                                                \
+        }                                                                                \
+                                                                                         \
+        iter->end = false;                                                               \
+                                                                                         \
+        iter->cursor--;                                                                  \
+                                                                                         \
+        return true;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    V PFX##_view_iter_value(struct SNAME##_view_iter *iter)                              \
+    {                                                                                    \
+        if (iter->view.count == 0)                                                       \
+            return (V){0};                                                               \
+                                                                                         \
+        return iter->view.data[iter->cursor];                                            \
+    }                                                                                    \
+                                                                                         \
+    size_t PFX##_view_iter_index(struct SNAME##_view_iter *iter)                         \
+    {                                                                                    \
+        return iter->cursor;                                                             \
+    }                                                                                    \
+                                                                                         \
+    static size_t PFX##_impl_binary_search_first(struct SNAME *_list_, V value)          \
+    {                                                                                    \
+        if (_list_->count == 0)                                                          \
+            return 1;                                                                    \
+                                                                                         \
+        if (_list_->frozen)                                                              \
+            return PFX##_impl_frozen_search(_list_, value, true);                        \
+                                                                                         \
+        size_t L = 0;                                                                    \
+        size_t R = _list_->count;                                                        \
+                                                                                         \
+        while (L < R)                                                                    \
+        {                                                                                \
+            size_t M = L + (R - L) / 2;                                                  \
+                                                                                         \
+            if (PFX##_impl_cmp(_list_, _list_->buffer[M], value) < 0)                    \
+                L = M + 1;                                                               \
+            else                                                                         \
+                R = M;                                                                   \
+        }                                                                                \
+                                                                                         \
+        if (L < _list_->count && PFX##_impl_cmp(_list_, _list_->buffer[L], value) == 0)  \
+            return L;                                                                    \
+                                                                                         \
+        /* Not found */                                                                  \
+        return _list_->count;                                                            \
+    }                                                                                    \
+                                                                                         \
+    static size_t PFX##_impl_binary_search_last(struct SNAME *_list_, V value)           \
+    {                                                                                    \
+        if (_list_->count == 0)                                                          \
+            return 1;                                                                    \
+                                                                                         \
+        if (_list_->frozen)                                                              \
+            return PFX##_impl_frozen_search(_list_, value, false);                       \
+                                                                                         \
+        size_t L = 0;                                                                    \
+        size_t R = _list_->count;                                                        \
+                                                                                         \
+        while (L < R)                                                                    \
+        {                                                                                \
+            size_t M = L + (R - L) / 2;                                                  \
+                                                                                         \
+            if (PFX##_impl_cmp(_list_, _list_->buffer[M], value) > 0)                    \
+                R = M;                                                                   \
+            else                                                                         \
+                L = M + 1;                                                               \
+        }                                                                                \
+                                                                                         \
+        if (L > 0 && PFX##_impl_cmp(_list_, _list_->buffer[L - 1], value) == 0)          \
+            return L - 1;                                                                \
+                                                                                         \
+        /* Not found */                                                                  \
+        return _list_->count;                                                            \
+    }                                                                                    \
+                                                                                         \
+    /* Called after removals, halves the buffer until it is no longer mostly empty */    \
+    static void PFX##_impl_low_water(struct SNAME *_list_)                               \
+    {                                                                                    \
+        size_t capacity = _list_->capacity;                                              \
+                                                                                         \
+        while (capacity > 1 &&                                                           \
+               (double)_list_->count < (double)capacity * CMC_SHRINK_LOW_WATER)          \
+            capacity /= 2;                                                               \
+                                                                                         \
+        if (capacity != _list_->capacity)                                                \
+            PFX##_resize(_list_, capacity);                                              \
+    }                                                                                    \
+                                                                                         \
+    /* Index of the first element equal to value that was not removed by */              \
+    /* remove_lazy, or count if there is none. The list must be sorted */                \
+    static size_t PFX##_impl_find_live(struct SNAME *_list_, V value)                    \
+    {                                                                                    \
+        size_t index = PFX##_impl_binary_search_first(_list_, value);                    \
+                                                                                         \
+        if (!_list_->dead)                                                               \
+            return index;                                                                \
+                                                                                         \
+        while (index < _list_->count &&                                                  \
+               (_list_->dead[index / 64] >> (index % 64)) & 1)                           \
+        {                                                                                \
+            if (++index < _list_->count &&                                               \
+                PFX##_impl_cmp(_list_, _list_->buffer[index], value) != 0)               \
+                return _list_->count;                                                    \
+        }                                                                                \
+                                                                                         \
+        return index;                                                                    \
+    }                                                                                    \
+                                                                                         \
+    /* Drops the elements removed by remove_lazy in a single pass. They are */           \
+    /* all among the sorted ones, so the others stay in their order */                   \
+    static void PFX##_impl_compact(struct SNAME *_list_)                                 \
+    {                                                                                    \
+        if (!_list_->dead)                                                               \
+            return;                                                                      \
+                                                                                         \
+        size_t write = 0;                                                                \
+                                                                                         \
+        for (size_t i = 0; i < _list_->count; i++)                                       \
+        {                                                                                \
+            if (i < _list_->sorted && (_list_->dead[i / 64] >> (i % 64)) & 1)            \
+                continue;                                                                \
+                                                                                         \
+            _list_->buffer[write++] = _list_->buffer[i];                                 \
+        }                                                                                \
+                                                                                         \
+        if (!TRIVIAL)                                                                    \
+            memset(_list_->buffer + write, 0, (_list_->count - write) * sizeof(V));      \
+                                                                                         \
+        _list_->sorted -= _list_->dead_count;                                            \
+        _list_->count = write;                                                           \
+                                                                                         \
+        _list_->alloc->free(_list_->dead);                                               \
+        _list_->dead = NULL;                                                             \
+        _list_->dead_count = 0;                                                          \
+    }                                                                                    \
+                                                                                         \
+    /* Keeps the first of each run of equal elements of a sorted list */                 \
+    static void PFX##_impl_unique(struct SNAME *_list_)                                  \
+    {                                                                                    \
+        if (_list_->count < 2)                                                           \
+            return;                                                                      \
+                                                                                         \
+        size_t write = 1;                                                                \
+                                                                                         \
+        for (size_t i = 1; i < _list_->count; i++)                                       \
+        {                                                                                \
+            V element = _list_->buffer[i];                                               \
+                                                                                         \
+            if (PFX##_impl_cmp(_list_, _list_->buffer[write - 1], element) != 0)         \
+                _list_->buffer[write++] = element;                                       \
+        }                                                                                \
+                                                                                         \
+        if (!TRIVIAL)                                                                    \
+            memset(_list_->buffer + write, 0, (_list_->count - write) * sizeof(V));      \
+                                                                                         \
+        _list_->count = write;                                                           \
+        _list_->sorted = write;                                                          \
+    }                                                                                    \
+                                                                                         \
+    /* Called when the buffer is full, grows it by the policy of cmc_growth.h */         \
+    static bool PFX##_impl_grow(struct SNAME *_list_, size_t required)                   \
+    {                                                                                    \
+        return PFX##_resize(_list_, cmc_growth_capacity(_list_->capacity, required));    \
+    }                                                                                    \
+                                                                                         \
+    static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_list_)                 \
+    {                                                                                    \
+        struct SNAME##_iter iter;                                                        \
+                                                                                         \
+        PFX##_iter_init(&iter, _list_);                                                  \
+        PFX##_iter_to_start(&iter);                                                      \
+                                                                                         \
+        return iter;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_list_)                   \
+    {                                                                                    \
+        struct SNAME##_iter iter;                                                        \
+                                                                                         \
+        PFX##_iter_init(&iter, _list_);                                                  \
+        PFX##_iter_to_end(&iter);                                                        \
+                                                                                         \
+        return iter;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    /* Copies the sorted buffer from i to the subtree at node, in order, and */          \
+    /* returns the index after the last element copied */                                \
+    static size_t PFX##_impl_freeze_fill(struct SNAME *_list_, size_t i, size_t node)    \
+    {                                                                                    \
+        if (node > _list_->count)                                                        \
+            return i;                                                                    \
+                                                                                         \
+        i = PFX##_impl_freeze_fill(_list_, i, 2 * node);                                 \
+                                                                                         \
+        _list_->frozen[node] = _list_->buffer[i];                                        \
+        _list_->frozen_index[node] = i;                                                  \
+                                                                                         \
+        return PFX##_impl_freeze_fill(_list_, i + 1, 2 * node + 1);                      \
+    }                                                                                    \
+                                                                                         \
+    /* Looks for the first or the last element equal to value in the frozen */           \
+    /* copy. Each step only picks a child, which compiles to a conditional */            \
+    /* move, and the sixteen nodes four levels below are prefetched */                   \
+    static size_t PFX##_impl_frozen_search(struct SNAME *_list_, V value, bool first)    \
+    {                                                                                    \
+        V *frozen = _list_->frozen;                                                      \
+        size_t count = _list_->count;                                                    \
+        size_t node = 1;                                                                 \
+                                                                                         \
+        /* The search goes right past the elements less than value or, for */            \
+        /* the last one, not greater than it */                                          \
+        if (first)                                                                       \
+        {                                                                                \
+            while (node <= count)                                                        \
+            {                                                                            \
+                size_t ahead = node * 16 + 15 <= count ? node * 16 : 0;                  \
+                                                                                         \
+                CMC_IMPL_SORTEDLIST_PREFETCH(frozen + ahead);                            \
+                CMC_IMPL_SORTEDLIST_PREFETCH(frozen + ahead + 8);                        \
+                                                                                         \
+                node = 2 * node + (PFX##_impl_cmp(_list_, frozen[node], value) < 0);     \
+            }                                                                            \
+        }                                                                                \
+        else                                                                             \
+        {                                                                                \
+            while (node <= count)                                                        \
+            {                                                                            \
+                size_t ahead = node * 16 + 15 <= count ? node * 16 : 0;                  \
+                                                                                         \
+                CMC_IMPL_SORTEDLIST_PREFETCH(frozen + ahead);                            \
+                CMC_IMPL_SORTEDLIST_PREFETCH(frozen + ahead + 8);                        \
+                                                                                         \
+                node = 2 * node + (PFX##_impl_cmp(_list_, frozen[node], value) <= 0);    \
+            }                                                                            \
+        }                                                                                \
+                                                                                         \
+        /* Going up past every right turn gives the node where the search */             \
+        /* last went left, which is the first element past the bound or 0 */             \
+        while (node & 1)                                                                 \
+            node >>= 1;                                                                  \
+                                                                                         \
+        node >>= 1;                                                                      \
+                                                                                         \
+        if (first)                                                                       \
+        {                                                                                \
+            if (node != 0 && PFX##_impl_cmp(_list_, frozen[node], value) == 0)           \
+                return _list_->frozen_index[node];                                       \
+                                                                                         \
+            /* Not found */                                                              \
+            return count;                                                                \
+        }                                                                                \
+                                                                                         \
+        size_t index = node == 0 ? count : _list_->frozen_index[node];                   \
+                                                                                         \
+        if (index > 0 && PFX##_impl_cmp(_list_, _list_->buffer[index - 1], value) == 0)  \
+            return index - 1;                                                            \
+                                                                                         \
+        /* Not found */                                                                  \
+        return count;                                                                    \
+    }                                                                                    \
+                                                                                         \
+    /* Keeps the elements that are only in _list1_ and the ones that are in */           \
+    /* both lists depending on the flags. Every element of _list2_ is kept */            \
+    /* when the ones only in _list1_ are, which gives the union */                       \
+    static struct SNAME *PFX##_impl_merge(struct SNAME *_list1_, struct SNAME *_list2_,  \
+                                          bool only1, bool both)                         \
+    {                                                                                    \
+        PFX##_sort(_list1_);                                                             \
+        PFX##_sort(_list2_);                                                             \
+                                                                                         \
+        bool only2 = only1 && both;                                                      \
+                                                                                         \
+        size_t capacity = _list1_->count + (only2 ? _list2_->count : 0);                 \
+                                                                                         \
+        /* An intersection is never larger than its smaller list */                      \
+        if (!only1 && _list2_->count < capacity)                                         \
+            capacity = _list2_->count;                                                   \
+                                                                                         \
+        struct SNAME *result = PFX##_new_custom(capacity > 0 ? capacity : 1,             \
+                                                _list1_->cmp, _list1_->alloc);           \
+                                                                                         \
+        if (CMC_UNLIKELY(!result))                                                       \
+            return NULL;                                                                 \
+                                                                                         \
+        V *a = _list1_->buffer;                                                          \
+        V *b = _list2_->buffer;                                                          \
+        V *out = result->buffer;                                                         \
+                                                                                         \
+        size_t i = 0;                                                                    \
+        size_t j = 0;                                                                    \
+        size_t n = 0;                                                                    \
+                                                                                         \
+        while (i < _list1_->count && j < _list2_->count)                                 \
+        {                                                                                \
+            int c = PFX##_impl_cmp(_list1_, a[i], b[j]);                                 \
+                                                                                         \
+            if (c < 0)                                                                   \
+            {                                                                            \
+                if (only1)                                                               \
+                    out[n++] = a[i];                                                     \
+                                                                                         \
+                i++;                                                                     \
+            }                                                                            \
+            else if (c > 0)                                                              \
+            {                                                                            \
+                if (only2)                                                               \
+                    out[n++] = b[j];                                                     \
+                                                                                         \
+                j++;                                                                     \
+            }                                                                            \
+            else                                                                         \
+            {                                                                            \
+                if (both)                                                                \
+                    out[n++] = a[i];                                                     \
+                                                                                         \
+                i++;                                                                     \
+                j++;                                                                     \
+            }                                                                            \
+        }                                                                                \
+                                                                                         \
+        for (; only1 && i < _list1_->count; i++)                                         \
+            out[n++] = a[i];                                                             \
+                                                                                         \
+        for (; only2 && j < _list2_->count; j++)                                         \
+            out[n++] = b[j];                                                             \
+                                                                                         \
+        result->count = n;                                                               \
+        result->sorted = n;                                                              \
+                                                                                         \
+        return result;                                                                   \
+    }                                                                                    \
+                                                                                         \
+    /* Looks for each element of small in large, starting from where the */              \
+    /* last one was found, so it takes O(m log(n / m)) */                                \
+    static struct SNAME *PFX##_impl_gallop_intersection(struct SNAME *small,             \
+                                                        struct SNAME *large)             \
+    {                                                                                    \
+        size_t capacity = small->count > 0 ? small->count : 1;                           \
+                                                                                         \
+        struct SNAME *result = PFX##_new_custom(capacity, small->cmp, small->alloc);     \
+                                                                                         \
+        if (CMC_UNLIKELY(!result))                                                       \
+            return NULL;                                                                 \
+                                                                                         \
+        size_t j = 0;                                                                    \
+                                                                                         \
+        for (size_t i = 0; i < small->count && j < large->count; i++)                    \
+        {                                                                                \
+            j = PFX##_impl_gallop(large, j, small->buffer[i]);                           \
+                                                                                         \
+            if (j < large->count &&                                                      \
+                PFX##_impl_cmp(large, large->buffer[j], small->buffer[i]) == 0)          \
+            {                                                                            \
+                result->buffer[result->count++] = small->buffer[i];                      \
+                j++;                                                                     \
+            }                                                                            \
+        }                                                                                \
+                                                                                         \
+        result->sorted = result->count;                                                  \
+                                                                                         \
+        return result;                                                                   \
+    }                                                                                    \
+                                                                                         \
+    /* First index from the given one of an element not less than value. */              \
+    /* The steps double until one goes past it and then a binary search */               \
+    /* finds it within the last step */                                                  \
+    static size_t PFX##_impl_gallop(struct SNAME *_list_, size_t from, V value)          \
+    {                                                                                    \
+        size_t low = from;                                                               \
+        size_t high = from;                                                              \
+        size_t step = 1;                                                                 \
+                                                                                         \
+        while (high < _list_->count &&                                                   \
+               PFX##_impl_cmp(_list_, _list_->buffer[high], value) < 0)                  \
+        {                                                                                \
+            low = high + 1;                                                              \
+            high += step;                                                                \
+            step *= 2;                                                                   \
+        }                                                                                \
+                                                                                         \
+        if (high > _list_->count)                                                        \
+            high = _list_->count;                                                        \
+                                                                                         \
+        while (low < high)                                                               \
+        {                                                                                \
+            size_t M = low + (high - low) / 2;                                           \
+                                                                                         \
+            if (PFX##_impl_cmp(_list_, _list_->buffer[M], value) < 0)                    \
+                low = M + 1;                                                             \
+            else                                                                         \
+                high = M;                                                                \
+        }                                                                                \
+                                                                                         \
+        return low;                                                                      \
+    }                                                                                    \
+                                                                                         \
+    /* Orders the cursors of merge_k by their elements, and by their lists */            \
+    /* when these are equal */                                                           \
+    static int PFX##_impl_cursor_cmp(struct SNAME##_cursor a, struct SNAME##_cursor b)   \
+    {                                                                                    \
+        V value_a = a.list->buffer[a.index];                                             \
+        V value_b = b.list->buffer[b.index];                                             \
+                                                                                         \
+        int c = PFX##_impl_cmp(a.list, value_a, value_b);                                \
+                                                                                         \
+        if (c != 0)                                                                      \
+            return c;                                                                    \
+                                                                                         \
+        return (a.order > b.order) - (a.order < b.order);                                \
+    }                                                                                    \
+                                                                                         \
+    /* Inserts every element after the sorted ones by a binary search */                 \
+    static void PFX##_impl_insert_tail(struct SNAME *_list_)                             \
+    {                                                                                    \
+        for (size_t i = _list_->sorted; i < _list_->count; i++)                          \
+        {                                                                                \
+            V element = _list_->buffer[i];                                               \
+                                                                                         \
+            /* The first element greater than it, so equal elements stay in */           \
+            /* the order they were inserted */                                           \
+            size_t L = 0;                                                                \
+            size_t R = i;                                                                \
+                                                                                         \
+            while (L < R)                                                                \
+            {                                                                            \
+                size_t M = L + (R - L) / 2;                                              \
+                                                                                         \
+                if (PFX##_impl_cmp(_list_, _list_->buffer[M], element) <= 0)             \
+                    L = M + 1;                                                           \
+                else                                                                     \
+                    R = M;                                                               \
+            }                                                                            \
+                                                                                         \
+            memmove(_list_->buffer + L + 1, _list_->buffer + L, (i - L) * sizeof(V));    \
+                                                                                         \
+            _list_->buffer[L] = element;                                                 \
+        }                                                                                \
+    }                                                                                    \
+                                                                                         \
+    /* Merges the sorted elements with the elements after them, which must */            \
+    /* be sorted too. Only these are copied to a scratch buffer and the */               \
+    /* merge goes from the end so nothing is overwritten before it is read */            \
+    static bool PFX##_impl_merge_tail(struct SNAME *_list_)                              \
+    {                                                                                    \
+        V *buffer = _list_->buffer;                                                      \
+                                                                                         \
+        size_t i = _list_->sorted;                                                       \
+        size_t j = _list_->count - i;                                                    \
+        size_t k = _list_->count;                                                        \
+                                                                                         \
+        /* Already in order */                                                           \
+        if (PFX##_impl_cmp(_list_, buffer[i - 1], buffer[i]) <= 0)                       \
+            return true;                                                                 \
+                                                                                         \
+        V *scratch = _list_->alloc->malloc(sizeof(V) * j);                               \
+                                                                                         \
+        if (CMC_UNLIKELY(!scratch))                                                      \
+            return false;                                                                \
+                                                                                         \
+        memcpy(scratch, buffer + i, sizeof(V) * j);                                      \
+                                                                                         \
+        while (i > 0 && j > 0)                                                           \
+        {                                                                                \
+            if (PFX##_impl_cmp(_list_, scratch[j - 1], buffer[i - 1]) < 0)               \
+                buffer[--k] = buffer[--i];                                               \
+            else                                                                         \
+                buffer[--k] = scratch[--j];                                              \
+        }                                                                                \
+                                                                                         \
+        memcpy(buffer, scratch, sizeof(V) * j);                                          \
+                                                                                         \
+        _list_->alloc->free(scratch);                                                    \
+                                                                                         \
+        return true;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    static inline int PFX##_impl_cmp(struct SNAME *_list_, V a, V b)                     \
+    {                                                                                    \
+        (void)_list_;                                                                    \
+                                                                                         \
+        return CMP(a, b);                                                                \
+    }
+
+/* Sorts the buffer with the comparison sort */
+#define CMC_IMPL_SORTEDLIST_COMPARISON_SORT(PFX, SNAME, V)                           \
+                                                                                     \
+    static void PFX##_impl_sort_buffer(struct SNAME *_list_, V *array, size_t count) \
+    {                                                                                \
+        PFX##_impl_sort(_list_, array, count);                                       \
+    }
+
+/* Compares elements by their keys, so it agrees with the radix sort */
+#define CMC_IMPL_SORTEDLIST_RADIX_CMP(PFX, V, KEY)   \
+                                                     \
+    static inline int PFX##_impl_radix_cmp(V a, V b) \
+    {                                                \
+        uint64_t key_a = KEY(a);                     \
+        uint64_t key_b = KEY(b);                     \
+                                                     \
+        return (key_a > key_b) - (key_a < key_b);    \
+    }
+
+/* Sorts the buffer with the radix sort, or with the comparison sort if it */
+/* is small or the scratch buffer could not be allocated */
+#define CMC_IMPL_SORTEDLIST_RADIX_SORT(PFX, SNAME, V, KEY)                           \
+                                                                                     \
+    CMC_GENERATE_RADIX_SORT(PFX##_impl_radix_sort, V, KEY)                           \
+                                                                                     \
+    static void PFX##_impl_sort_buffer(struct SNAME *_list_, V *array, size_t count) \
+    {                                                                                \
+        if (!PFX##_impl_radix_sort(array, count))                                    \
+            PFX##_impl_sort(_list_, array, count);                                   \
     }
 
 #endif /* CMC_SORTEDLIST_H */
@@ -0,0 +1,554 @@
+/**
+ * sortedwindow.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * SortedWindow
+ *
+ * A SortedWindow keeps the last N values pushed to it, for a fixed N, and
+ * answers order statistics about them, like their median or their 99th
+ * percentile. Each push past N values evicts the oldest one, so it tracks
+ * percentiles of a stream of samples like a rolling window of latencies.
+ *
+ * Implementation
+ *
+ * The values are kept twice. A circular array has them in the order they
+ * were pushed, to know which one is the oldest, and a blocked sorted array
+ * has them sorted: an array of blocks, each one sorted and with up to
+ * CMC_SORTED_WINDOW_BLOCK values, where every value of a block is not
+ * greater than the values of the next one. A push finds its block with a
+ * binary search over the last value of each block and moves at most a block
+ * of values to make room, instead of the whole window like a SortedList
+ * would. A full block is split in half and a block that gets too empty is
+ * merged with its neighbour, so an evicted value is also only moved within
+ * its block. An order statistic skips whole blocks by their counts.
+ */
+
+#ifndef CMC_SORTEDWINDOW_H
+#define CMC_SORTEDWINDOW_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* Maximum amount of values in a block of the sorted array */
+#define CMC_SORTED_WINDOW_BLOCK 256
+
+/* to_string format */
+static const char *cmc_string_fmt_sortedwindow = "%s at %p { ring:%p, window:%" PRIuMAX ", head:%" PRIuMAX ", count:%" PRIuMAX ", blocks:%p, block_count:%" PRIuMAX ", cmp:%p }";
+
+#define CMC_GENERATE_SORTEDWINDOW(PFX, SNAME, V)    \
+    CMC_GENERATE_SORTEDWINDOW_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_SORTEDWINDOW_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_SORTEDWINDOW_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_SORTEDWINDOW_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_SORTEDWINDOW_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_SORTEDWINDOW_SOURCE(PFX, SNAME, V)
+
+/* Same as CMC_GENERATE_SORTEDWINDOW but elements are compared by calling */
+/* CMP directly, so the compiler can inline it. The function given to new is */
+/* still stored but only used by to_string */
+#define CMC_GENERATE_SORTEDWINDOW_EX(PFX, SNAME, V, CMP) \
+    CMC_GENERATE_SORTEDWINDOW_HEADER(PFX, SNAME, V)      \
+    CMC_GENERATE_SORTEDWINDOW_EX_SOURCE(PFX, SNAME, V, CMP)
+
+#define CMC_GENERATE_SORTEDWINDOW_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_SORTEDWINDOW_SOURCE(PFX, SNAME, V, _window_->cmp)
+
+#define CMC_GENERATE_SORTEDWINDOW_EX_SOURCE(PFX, SNAME, V, CMP) \
+    CMC_IMPL_SORTEDWINDOW_SOURCE(PFX, SNAME, V, CMP)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_SORTEDWINDOW_HEADER(PFX, SNAME, V)                    \
+                                                                           \
+    /* SortedWindow Structure */                                           \
+    struct SNAME                                                           \
+    {                                                                      \
+        /* Circular array with the values in the order they were pushed */ \
+        V *ring;                                                           \
+                                                                           \
+        /* Maximum amount of values, the size of the circular array */     \
+        size_t window;                                                     \
+                                                                           \
+        /* Index of the oldest value in the circular array */              \
+        size_t head;                                                       \
+                                                                           \
+        /* Current amount of values */                                     \
+        size_t count;                                                      \
+                                                                           \
+        /* Sorted blocks with every value */                               \
+        struct SNAME##_block *blocks;                                      \
+                                                                           \
+        /* Amount of blocks in use */                                      \
+        size_t block_count;                                                \
+                                                                           \
+        /* Amount of blocks that fit in the array */                       \
+        size_t block_capacity;                                             \
+                                                                           \
+        /* Element comparison function */                                  \
+        int (*cmp)(V, V);                                                  \
+                                                                           \
+        /* Custom allocation functions */                                  \
+        struct cmc_alloc_node *alloc;                                      \
+    };                                                                     \
+                                                                           \
+    /* SortedWindow Block */                                               \
+    struct SNAME##_block                                                   \
+    {                                                                      \
+        /* Sorted values, with room for CMC_SORTED_WINDOW_BLOCK of them */ \
+        V *values;                                                         \
+                                                                           \
+        /* Amount of values in the block */                                \
+        size_t count;                                                      \
+    };                                                                     \
+                                                                           \
+    /* Collection Functions */                                             \
+    /* Collection Allocation and Deallocation */                           \
+    struct SNAME *PFX##_new(size_t window, int (*compare)(V, V));          \
+    struct SNAME *PFX##_new_custom(size_t window, int (*compare)(V, V),    \
+                                   struct cmc_alloc_node *alloc);          \
+    void PFX##_clear(struct SNAME *_window_, void (*deallocator)(V));      \
+    void PFX##_free(struct SNAME *_window_, void (*deallocator)(V));       \
+    /* Collection Input and Output */                                      \
+    bool PFX##_push(struct SNAME *_window_, V element, V *evicted);        \
+    /* Element Access */                                                   \
+    V PFX##_get(struct SNAME *_window_, size_t index);                     \
+    bool PFX##_quantile(struct SNAME *_window_, double q, V *value);       \
+    bool PFX##_min(struct SNAME *_window_, V *value);                      \
+    bool PFX##_max(struct SNAME *_window_, V *value);                      \
+    /* Collection State */                                                 \
+    CMC_PURE bool PFX##_empty(struct SNAME *_window_);                     \
+    bool PFX##_full(struct SNAME *_window_);                               \
+    CMC_PURE size_t PFX##_count(struct SNAME *_window_);                   \
+    size_t PFX##_memory_usage(struct SNAME *_window_);                     \
+    /* Collection Utility */                                               \
+    struct cmc_string PFX##_to_string(struct SNAME *_window_);             \
+                                                                           \
+/* SOURCE ********************************************************************/
+#define CMC_IMPL_SORTEDWINDOW_SOURCE(PFX, SNAME, V, CMP)                                 \
+                                                                                         \
+    /* Implementation Detail Functions */                                                \
+    static inline int PFX##_impl_cmp(struct SNAME *_window_, V a, V b);                  \
+    static bool PFX##_impl_insert(struct SNAME *_window_, V element);                    \
+    static void PFX##_impl_remove(struct SNAME *_window_, V element);                    \
+    static size_t PFX##_impl_find_block(struct SNAME *_window_, V element, bool after);  \
+    static size_t PFX##_impl_bound(struct SNAME *_window_, struct SNAME##_block *block,  \
+                                   V element, bool after);                               \
+    static bool PFX##_impl_split(struct SNAME *_window_, size_t index);                  \
+    static void PFX##_impl_drop_block(struct SNAME *_window_, size_t index);             \
+                                                                                         \
+    struct SNAME *PFX##_new(size_t window, int (*compare)(V, V))                         \
+    {                                                                                    \
+        return PFX##_new_custom(window, compare, NULL);                                  \
+    }                                                                                    \
+                                                                                         \
+    struct SNAME *PFX##_new_custom(size_t window, int (*compare)(V, V),                  \
+                                   struct cmc_alloc_node *alloc)                         \
+    {                                                                                    \
+        if (!alloc)                                                                      \
+            alloc = &cmc_alloc_node_default;                                             \
+                                                                                         \
+        if (window == 0)                                                                 \
+            return NULL;                                                                 \
+                                                                                         \
+        struct SNAME *_window_ = alloc->malloc(sizeof(struct SNAME));                    \
+                                                                                         \
+        if (CMC_UNLIKELY(!_window_))                                                     \
+            return NULL;                                                                 \
+                                                                                         \
+        _window_->alloc = alloc;                                                         \
+                                                                                         \
+        _window_->ring = alloc->malloc(sizeof(V) * window);                              \
+                                                                                         \
+        if (CMC_UNLIKELY(!_window_->ring))                                               \
+        {                                                                                \
+            alloc->free(_window_);                                                       \
+            return NULL;                                                                 \
+        }                                                                                \
+                                                                                         \
+        _window_->window = window;                                                       \
+        _window_->head = 0;                                                              \
+        _window_->count = 0;                                                             \
+        _window_->blocks = NULL;                                                         \
+        _window_->block_count = 0;                                                       \
+        _window_->block_capacity = 0;                                                    \
+        _window_->cmp = compare;                                                         \
+                                                                                         \
+        return _window_;                                                                 \
+    }                                                                                    \
+                                                                                         \
+    void PFX##_clear(struct SNAME *_window_, void (*deallocator)(V))                     \
+    {                                                                                    \
+        for (size_t i = 0; i < _window_->block_count; i++)                               \
+        {                                                                                \
+            if (deallocator)                                                             \
+            {                                                                            \
+                for (size_t j = 0; j < _window_->blocks[i].count; j++)                   \
+                    deallocator(_window_->blocks[i].values[j]);                          \
+            }                                                                            \
+                                                                                         \
+            _window_->alloc->free(_window_->blocks[i].values);                           \
+        }                                                                                \
+                                                                                         \
+        _window_->head = 0;                                                              \
+        _window_->count = 0;                                                             \
+        _window_->block_count = 0;                                                       \
+    }                                                                                    \
+                                                                                         \
+    void PFX##_free(struct SNAME *_window_, void (*deallocator)(V))                      \
+    {                                                                                    \
+        PFX##_clear(_window_, deallocator);                                              \
+                                                                                         \
+        _window_->alloc->free(_window_->blocks);                                         \
+        _window_->alloc->free(_window_->ring);                                           \
+        _window_->alloc->free(_window_);                                                 \
+    }                                                                                    \
+                                                                                         \
+    /* The element is inserted before the oldest one is removed, so if it */             \
+    /* runs out of memory the window is left as it was */                                \
+    bool PFX##_push(struct SNAME *_window_, V element, V *evicted)                       \
+    {                                                                                    \
+        if (!PFX##_impl_insert(_window_, element))                                       \
+            return false;                                                                \
+                                                                                         \
+        if (_window_->count < _window_->window)                                          \
+        {                                                                                \
+            size_t index = (_window_->head + _window_->count) % _window_->window;        \
+                                                                                         \
+            _window_->ring[index] = element;                                             \
+            _window_->count++;                                                           \
+                                                                                         \
+            return true;                                                                 \
+        }                                                                                \
+                                                                                         \
+        V oldest = _window_->ring[_window_->head];                                       \
+                                                                                         \
+        PFX##_impl_remove(_window_, oldest);                                             \
+                                                                                         \
+        _window_->ring[_window_->head] = element;                                        \
+        _window_->head = (_window_->head + 1) % _window_->window;                        \
+                                                                                         \
+        if (evicted)                                                                     \
+            *evicted = oldest;                                                           \
+                                                                                         \
+        return true;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    /* Element at position index of the values in sorted order */                        \
+    V PFX##_get(struct SNAME *_window_, size_t index)                                    \
+    {                                                                                    \
+        if (index >= _window_->count)                                                    \
+            return (V){0};                                                               \
+                                                                                         \
+        struct SNAME##_block *block = _window_->blocks;                                  \
+                                                                                         \
+        while (index >= block->count)                                                    \
+        {                                                                                \
+            index -= block->count;                                                       \
+            block++;                                                                     \
+        }                                                                                \
+                                                                                         \
+        return block->values[index];                                                     \
+    }                                                                                    \
+                                                                                         \
+    /* The value at position q * (count - 1) in sorted order, rounded to the */          \
+    /* nearest position, where q goes from 0 for the minimum to 1 for the */             \
+    /* maximum */                                                                        \
+    bool PFX##_quantile(struct SNAME *_window_, double q, V *value)                      \
+    {                                                                                    \
+        if (PFX##_empty(_window_))                                                       \
+            return false;                                                                \
+                                                                                         \
+        if (q < 0.0)                                                                     \
+            q = 0.0;                                                                     \
+        else if (q > 1.0)                                                                \
+            q = 1.0;                                                                     \
+                                                                                         \
+        size_t index = (size_t)(q * (double)(_window_->count - 1) + 0.5);                \
+                                                                                         \
+        if (value)                                                                       \
+            *value = PFX##_get(_window_, index);                                         \
+                                                                                         \
+        return true;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    bool PFX##_min(struct SNAME *_window_, V *value)                                     \
+    {                                                                                    \
+        if (PFX##_empty(_window_))                                                       \
+            return false;                                                                \
+                                                                                         \
+        if (value)                                                                       \
+            *value = _window_->blocks[0].values[0];                                      \
+                                                                                         \
+        return true;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    bool PFX##_max(struct SNAME *_window_, V *value)                                     \
+    {                                                                                    \
+        if (PFX##_empty(_window_))                                                       \
+            return false;                                                                \
+                                                                                         \
+        struct SNAME##_block *last = &_window_->blocks[_window_->block_count - 1];       \
+                                                                                         \
+        if (value)                                                                       \
+            *value = last->values[last->count - 1];                                      \
+                                                                                         \
+        return true;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    bool PFX##_empty(struct SNAME *_window_)                                             \
+    {                                                                                    \
+        return _window_->count == 0;                                                     \
+    }                                                                                    \
+                                                                                         \
+    bool PFX##_full(struct SNAME *_window_)                                              \
+    {                                                                                    \
+        return _window_->count >= _window_->window;                                      \
+    }                                                                                    \
+                                                                                         \
+    size_t PFX##_count(struct SNAME *_window_)                                           \
+    {                                                                                    \
+        return _window_->count;                                                          \
+    }                                                                                    \
+                                                                                         \
+    size_t PFX##_memory_usage(struct SNAME *_window_)                                    \
+    {                                                                                    \
+        size_t bytes = sizeof(struct SNAME) + sizeof(V) * _window_->window;              \
+                                                                                         \
+        bytes += sizeof(struct SNAME##_block) * _window_->block_capacity;                \
+        bytes += sizeof(V) * CMC_SORTED_WINDOW_BLOCK * _window_->block_count;            \
+                                                                                         \
+        return bytes;                                                                    \
+    }                                                                                    \
+                                                                                         \
+    struct cmc_string PFX##_to_string(struct SNAME *_window_)                            \
+    {                                                                                    \
+        struct cmc_string str;                                                           \
+        struct SNAME *w_ = _window_;                                                     \
+        const char *name = #SNAME;                                                       \
+                                                                                         \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_sortedwindow, name, w_, w_->ring, \
+                 w_->window, w_->head, w_->count, w_->blocks, w_->block_count, w_->cmp); \
+                                                                                         \
+        return str;                                                                      \
+    }                                                                                    \
+                                                                                         \
+    static inline int PFX##_impl_cmp(struct SNAME *_window_, V a, V b)                   \
+    {                                                                                    \
+        (void)_window_;                                                                  \
+                                                                                         \
+        return CMP(a, b);                                                                \
+    }                                                                                    \
+                                                                                         \
+    /* Inserts the element into the blocked sorted array, after the values */            \
+    /* equal to it */                                                                    \
+    static bool PFX##_impl_insert(struct SNAME *_window_, V element)                     \
+    {                                                                                    \
+        if (_window_->block_count == 0)                                                  \
+        {                                                                                \
+            if (_window_->block_capacity == 0)                                           \
+            {                                                                            \
+                struct SNAME##_block *blocks =                                           \
+                    _window_->alloc->malloc(sizeof(struct SNAME##_block) * 4);           \
+                                                                                         \
+                if (!blocks)                                                             \
+                    return false;                                                        \
+                                                                                         \
+                _window_->blocks = blocks;                                               \
+                _window_->block_capacity = 4;                                            \
+            }                                                                            \
+                                                                                         \
+            V *values = _window_->alloc->malloc(sizeof(V) * CMC_SORTED_WINDOW_BLOCK);    \
+                                                                                         \
+            if (CMC_UNLIKELY(!values))                                                   \
+                return false;                                                            \
+                                                                                         \
+            _window_->blocks[0].values = values;                                         \
+            _window_->blocks[0].count = 0;                                               \
+            _window_->block_count = 1;                                                   \
+        }                                                                                \
+                                                                                         \
+        size_t index = PFX##_impl_find_block(_window_, element, true);                   \
+                                                                                         \
+        if (_window_->blocks[index].count == CMC_SORTED_WINDOW_BLOCK)                    \
+        {                                                                                \
+            if (!PFX##_impl_split(_window_, index))                                      \
+                return false;                                                            \
+                                                                                         \
+            struct SNAME##_block *left = &_window_->blocks[index];                       \
+                                                                                         \
+            if (PFX##_impl_cmp(_window_, left->values[left->count - 1], element) <= 0)   \
+                index++;                                                                 \
+        }                                                                                \
+                                                                                         \
+        struct SNAME##_block *block = &_window_->blocks[index];                          \
+                                                                                         \
+        size_t position = PFX##_impl_bound(_window_, block, element, true);              \
+                                                                                         \
+        memmove(block->values + position + 1, block->values + position,                  \
+                sizeof(V) * (block->count - position));                                  \
+                                                                                         \
+        block->values[position] = element;                                               \
+        block->count++;                                                                  \
+                                                                                         \
+        return true;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    /* Removes a value equal to the element, which is always found */                    \
+    static void PFX##_impl_remove(struct SNAME *_window_, V element)                     \
+    {                                                                                    \
+        size_t index = PFX##_impl_find_block(_window_, element, false);                  \
+                                                                                         \
+        struct SNAME##_block *block = &_window_->blocks[index];                          \
+                                                                                         \
+        size_t position = PFX##_impl_bound(_window_, block, element, false);             \
+                                                                                         \
+        memmove(block->values + position, block->values + position + 1,                  \
+                sizeof(V) * (block->count - position - 1));                              \
+                                                                                         \
+        block->count--;                                                                  \
+                                                                                         \
+        if (block->count == 0)                                                           \
+        {                                                                                \
+            if (_window_->block_count > 1)                                               \
+                PFX##_impl_drop_block(_window_, index);                                  \
+                                                                                         \
+            return;                                                                      \
+        }                                                                                \
+                                                                                         \
+        /* Merges with the next block if both fit in half a block */                     \
+        if (index + 1 == _window_->block_count)                                          \
+        {                                                                                \
+            if (index == 0)                                                              \
+                return;                                                                  \
+                                                                                         \
+            index--;                                                                     \
+        }                                                                                \
+                                                                                         \
+        struct SNAME##_block *left = &_window_->blocks[index];                           \
+        struct SNAME##_block *right = &_window_->blocks[index + 1];                      \
+                                                                                         \
+        if (left->count + right->count > CMC_SORTED_WINDOW_BLOCK / 2)                    \
+            return;                                                                      \
+                                                                                         \
+        memcpy(left->values + left->count, right->values, sizeof(V) * right->count);     \
+                                                                                         \
+        left->count += right->count;                                                     \
+        right->count = 0;                                                                \
+                                                                                         \
+        PFX##_impl_drop_block(_window_, index + 1);                                      \
+    }                                                                                    \
+                                                                                         \
+    /* Index of the first block whose last value is greater than the */                  \
+    /* element, or not less than it if after is false, or the last block */              \
+    static size_t PFX##_impl_find_block(struct SNAME *_window_, V element, bool after)   \
+    {                                                                                    \
+        size_t L = 0;                                                                    \
+        size_t R = _window_->block_count - 1;                                            \
+                                                                                         \
+        while (L < R)                                                                    \
+        {                                                                                \
+            size_t M = L + (R - L) / 2;                                                  \
+                                                                                         \
+            struct SNAME##_block *block = &_window_->blocks[M];                          \
+                                                                                         \
+            int c = PFX##_impl_cmp(_window_, block->values[block->count - 1], element);  \
+                                                                                         \
+            if (c < 0 || (after && c == 0))                                              \
+                L = M + 1;                                                               \
+            else                                                                         \
+                R = M;                                                                   \
+        }                                                                                \
+                                                                                         \
+        return L;                                                                        \
+    }                                                                                    \
+                                                                                         \
+    /* Position of the first value of the block greater than the element, */             \
+    /* or not less than it if after is false */                                          \
+    static size_t PFX##_impl_bound(struct SNAME *_window_, struct SNAME##_block *block,  \
+                                   V element, bool after)                                \
+    {                                                                                    \
+        size_t L = 0;                                                                    \
+        size_t R = block->count;                                                         \
+                                                                                         \
+        while (L < R)                                                                    \
+        {                                                                                \
+            size_t M = L + (R - L) / 2;                                                  \
+                                                                                         \
+            int c = PFX##_impl_cmp(_window_, block->values[M], element);                 \
+                                                                                         \
+            if (c < 0 || (after && c == 0))                                              \
+                L = M + 1;                                                               \
+            else                                                                         \
+                R = M;                                                                   \
+        }                                                                                \
+                                                                                         \
+        return L;                                                                        \
+    }                                                                                    \
+                                                                                         \
+    /* Moves the upper half of a full block to a new block after it */                   \
+    static bool PFX##_impl_split(struct SNAME *_window_, size_t index)                   \
+    {                                                                                    \
+        if (_window_->block_count == _window_->block_capacity)                           \
+        {                                                                                \
+            size_t capacity = _window_->block_capacity * 2;                              \
+                                                                                         \
+            struct SNAME##_block *blocks =                                               \
+                _window_->alloc->realloc(_window_->blocks,                               \
+                                         sizeof(struct SNAME##_block) * capacity);       \
+                                                                                         \
+            if (!blocks)                                                                 \
+                return false;                                                            \
+                                                                                         \
+            _window_->blocks = blocks;                                                   \
+            _window_->block_capacity = capacity;                                         \
+        }                                                                                \
+                                                                                         \
+        V *values = _window_->alloc->malloc(sizeof(V) * CMC_SORTED_WINDOW_BLOCK);        \
+                                                                                         \
+        if (CMC_UNLIKELY(!values))                                                       \
+            return false;                                                                \
+                                                                                         \
+        struct SNAME##_block *blocks = _window_->blocks;                                 \
+                                                                                         \
+        memmove(blocks + index + 2, blocks + index + 1,                                  \
+                sizeof(struct SNAME##_block) * (_window_->block_count - index - 1));     \
+                                                                                         \
+        size_t half = CMC_SORTED_WINDOW_BLOCK / 2;                                       \
+                                                                                         \
+        memcpy(values, blocks[index].values + half,                                      \
+               sizeof(V) * (CMC_SORTED_WINDOW_BLOCK - half));                            \
+                                                                                         \
+        blocks[index].count = half;                                                      \
+        blocks[index + 1].values = values;                                               \
+        blocks[index + 1].count = CMC_SORTED_WINDOW_BLOCK - half;                        \
+                                                                                         \
+        _window_->block_count++;                                                         \
+                                                                                         \
+        return true;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    static void PFX##_impl_drop_block(struct SNAME *_window_, size_t index)              \
+    {                                                                                    \
+        _window_->alloc->free(_window_->blocks[index].values);                           \
+                                                                                         \
+        memmove(_window_->blocks + index, _window_->blocks + index + 1,                  \
+                sizeof(struct SNAME##_block) * (_window_->block_count - index - 1));     \
+                                                                                         \
+        _window_->block_count--;                                                         \
+    }
+
+#endif /* CMC_SORTEDWINDOW_H */
@@ -0,0 +1,918 @@
+/**
+ * sparseset.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * SparseSet
+ *
+ * A SparseSet is a set of small unsigned integers, like the ids of the
+ * entities of a game, with insert, remove and contains in O(1) without any
+ * hashing and a clear that takes O(1) too. Its elements are kept packed in a
+ * contiguous array, so iterating over them is as fast as over a List.
+ *
+ * A SparseMap keeps a value for each id in another array that is packed in
+ * the same order, so it can be iterated as two plain arrays of keys and
+ * values.
+ *
+ * Implementation
+ *
+ * The elements are in a dense array, in no particular order. A sparse array,
+ * indexed by the elements themselves, has the position of each element in
+ * the dense array. An element is in the set only if its sparse entry is a
+ * position below count and the dense array has the element at that
+ * position, so entries that are stale are never trusted and clearing the set
+ * only sets its count to 0. A removal moves the last element to the position
+ * of the removed one.
+ *
+ * The sparse array grows to fit the greatest element inserted, so it takes 4
+ * bytes for every integer up to it. Elements must be less than UINT32_MAX.
+ */
+
+#ifndef CMC_SPARSESET_H
+#define CMC_SPARSESET_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_sparseset = "%s at %p { dense:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", sparse:%p, universe:%" PRIuMAX " }";
+static const char *cmc_string_fmt_sparsemap = "%s at %p { keys:%p, values:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", sparse:%p, universe:%" PRIuMAX " }";
+
+#ifndef CMC_IMPL_SPARSE_INDEX
+#define CMC_IMPL_SPARSE_INDEX
+
+/* Sparse array of positions in a dense array */
+struct cmc_sparse_index
+{
+    uint32_t *positions;
+
+    /* Elements below this have an entry */
+    size_t universe;
+};
+
+/* Grows the sparse array so that element has an entry. New entries are */
+/* zeroed only so that they are never read uninitialized */
+static inline bool cmc_sparse_index_fit(struct cmc_sparse_index *index, size_t element,
+                                        struct cmc_alloc_node *alloc)
+{
+    if (element < index->universe)
+        return true;
+
+    if (element >= UINT32_MAX)
+        return false;
+
+    size_t universe = index->universe ? index->universe : 64;
+
+    while (universe <= element)
+        universe *= 2;
+
+    uint32_t *positions = alloc->realloc(index->positions, universe * sizeof(uint32_t));
+
+    if (CMC_UNLIKELY(!positions))
+        return false;
+
+    memset(positions + index->universe, 0, (universe - index->universe) * sizeof(uint32_t));
+
+    index->positions = positions;
+    index->universe = universe;
+
+    return true;
+}
+
+/* Capacity that a full dense array grows to */
+static inline size_t cmc_sparse_dense_grow(size_t capacity)
+{
+    return capacity ? capacity * 2 : 16;
+}
+
+#endif /* CMC_IMPL_SPARSE_INDEX */
+
+#define CMC_GENERATE_SPARSESET(PFX, SNAME, V)    \
+    CMC_GENERATE_SPARSESET_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_SPARSESET_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_SPARSESET_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_SPARSESET_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_SPARSESET_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_SPARSESET_SOURCE(PFX, SNAME, V)
+
+/* Keys of type K, an unsigned integer, associated with values of type V */
+#define CMC_GENERATE_SPARSEMAP(PFX, SNAME, K, V)    \
+    CMC_GENERATE_SPARSEMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_SPARSEMAP_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_SPARSEMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_SPARSEMAP_HEADER(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_SPARSEMAP_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_SPARSEMAP_SOURCE(PFX, SNAME, K, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_SPARSESET_HEADER(PFX, SNAME, V)                               \
+                                                                                   \
+    /* SparseSet Structure */                                                      \
+    struct SNAME                                                                   \
+    {                                                                              \
+        /* Packed elements */                                                      \
+        V *dense;                                                                  \
+                                                                                   \
+        /* Capacity of the dense array */                                          \
+        size_t capacity;                                                           \
+                                                                                   \
+        /* Current amount of elements */                                           \
+        size_t count;                                                              \
+                                                                                   \
+        /* Position of each element in the dense array */                          \
+        struct cmc_sparse_index index;                                             \
+                                                                                   \
+        /* Custom allocation functions */                                          \
+        struct cmc_alloc_node *alloc;                                              \
+    };                                                                             \
+                                                                                   \
+    /* SparseSet Iterator */                                                       \
+    struct SNAME##_iter                                                            \
+    {                                                                              \
+        /* Target set */                                                           \
+        struct SNAME *target;                                                      \
+                                                                                   \
+        /* Position in the dense array */                                          \
+        size_t cursor;                                                             \
+                                                                                   \
+        /* If the iterator has reached the start of the iteration */               \
+        bool start;                                                                \
+                                                                                   \
+        /* If the iterator has reached the end of the iteration */                 \
+        bool end;                                                                  \
+    };                                                                             \
+                                                                                   \
+    /* Collection Functions */                                                     \
+    /* Collection Allocation and Deallocation */                                   \
+    struct SNAME *PFX##_new(size_t capacity);                                      \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc); \
+    void PFX##_clear(struct SNAME *_set_);                                         \
+    void PFX##_free(struct SNAME *_set_);                                          \
+    /* Collection Input and Output */                                              \
+    bool PFX##_insert(struct SNAME *_set_, V element);                             \
+    bool PFX##_remove(struct SNAME *_set_, V element);                             \
+    /* Element Access */                                                           \
+    V *PFX##_data(struct SNAME *_set_);                                            \
+    size_t PFX##_index_of(struct SNAME *_set_, V element);                         \
+    /* Collection State */                                                         \
+    bool PFX##_contains(struct SNAME *_set_, V element);                           \
+    CMC_PURE bool PFX##_empty(struct SNAME *_set_);                                \
+    CMC_PURE size_t PFX##_count(struct SNAME *_set_);                              \
+    size_t PFX##_memory_usage(struct SNAME *_set_);                                \
+    /* Collection Utility */                                                       \
+    struct SNAME *PFX##_copy_of(struct SNAME *_set_);                              \
+    bool PFX##_equals(struct SNAME *_set1_, struct SNAME *_set2_);                 \
+    struct cmc_string PFX##_to_string(struct SNAME *_set_);                        \
+                                                                                   \
+    /* Iterator Functions */                                                       \
+    /* Iterator Allocation and Deallocation */                                     \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target);                     \
+    void PFX##_iter_free(struct SNAME##_iter *iter);                               \
+    /* Iterator Initialization */                                                  \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);         \
+    /* Iterator State */                                                           \
+    bool PFX##_iter_start(struct SNAME##_iter *iter);                              \
+    bool PFX##_iter_end(struct SNAME##_iter *iter);                                \
+    /* Iterator Movement */                                                        \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter);                           \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter);                             \
+    bool PFX##_iter_next(struct SNAME##_iter *iter);                               \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter);                               \
+    /* Iterator Access */                                                          \
+    V PFX##_iter_value(struct SNAME##_iter *iter);                                 \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter);
+
+#define CMC_GENERATE_SPARSEMAP_HEADER(PFX, SNAME, K, V)                            \
+                                                                                   \
+    /* SparseMap Structure */                                                      \
+    struct SNAME                                                                   \
+    {                                                                              \
+        /* Packed keys */                                                          \
+        K *keys;                                                                   \
+                                                                                   \
+        /* Value of each key, at the same position */                              \
+        V *values;                                                                 \
+                                                                                   \
+        /* Capacity of keys and values */                                          \
+        size_t capacity;                                                           \
+                                                                                   \
+        /* Current amount of keys */                                               \
+        size_t count;                                                              \
+                                                                                   \
+        /* Position of each key in keys and values */                              \
+        struct cmc_sparse_index index;                                             \
+                                                                                   \
+        /* Custom allocation functions */                                          \
+        struct cmc_alloc_node *alloc;                                              \
+    };                                                                             \
+                                                                                   \
+    /* SparseMap Iterator */                                                       \
+    struct SNAME##_iter                                                            \
+    {                                                                              \
+        /* Target map */                                                           \
+        struct SNAME *target;                                                      \
+                                                                                   \
+        /* Position in keys and values */                                          \
+        size_t cursor;                                                             \
+                                                                                   \
+        /* If the iterator has reached the start of the iteration */               \
+        bool start;                                                                \
+                                                                                   \
+        /* If the iterator has reached the end of the iteration */                 \
+        bool end;                                                                  \
+    };                                                                             \
+                                                                                   \
+    /* Collection Functions */                                                     \
+    /* Collection Allocation and Deallocation */                                   \
+    struct SNAME *PFX##_new(size_t capacity);                                      \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc); \
+    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V));              \
+    void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V));               \
+    /* Collection Input and Output */                                              \
+    bool PFX##_insert(struct SNAME *_map_, K key, V value);                        \
+    bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value);      \
+    bool PFX##_remove(struct SNAME *_map_, K key, V *out_value);                   \
+    /* Element Access */                                                           \
+    V PFX##_get(struct SNAME *_map_, K key);                                       \
+    V *PFX##_get_ref(struct SNAME *_map_, K key);                                  \
+    K *PFX##_keys(struct SNAME *_map_);                                            \
+    V *PFX##_values(struct SNAME *_map_);                                          \
+    /* Collection State */                                                         \
+    bool PFX##_contains(struct SNAME *_map_, K key);                               \
+    CMC_PURE bool PFX##_empty(struct SNAME *_map_);                                \
+    CMC_PURE size_t PFX##_count(struct SNAME *_map_);                              \
+    size_t PFX##_memory_usage(struct SNAME *_map_);                                \
+    /* Collection Utility */                                                       \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_);                        \
+                                                                                   \
+    /* Iterator Functions */                                                       \
+    /* Iterator Allocation and Deallocation */                                     \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target);                     \
+    void PFX##_iter_free(struct SNAME##_iter *iter);                               \
+    /* Iterator Initialization */                                                  \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);         \
+    /* Iterator State */                                                           \
+    bool PFX##_iter_start(struct SNAME##_iter *iter);                              \
+    bool PFX##_iter_end(struct SNAME##_iter *iter);                                \
+    /* Iterator Movement */                                                        \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter);                           \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter);                             \
+    bool PFX##_iter_next(struct SNAME##_iter *iter);                               \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter);                               \
+    /* Iterator Access */                                                          \
+    K PFX##_iter_key(struct SNAME##_iter *iter);                                   \
+    V PFX##_iter_value(struct SNAME##_iter *iter);                                 \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter);                               \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter);                            \
+                                                                                   \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_SPARSESET_SOURCE(PFX, SNAME, V)                                        \
+                                                                                            \
+    /* The capacity is for the dense array and is also the size of the */                   \
+    /* sparse array until a greater element is inserted */                                  \
+    struct SNAME *PFX##_new(size_t capacity)                                                \
+    {                                                                                       \
+        return PFX##_new_custom(capacity, NULL);                                            \
+    }                                                                                       \
+                                                                                            \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc)           \
+    {                                                                                       \
+        if (!alloc)                                                                         \
+            alloc = &cmc_alloc_node_default;                                                \
+                                                                                            \
+        struct SNAME *_set_ = alloc->malloc(sizeof(struct SNAME));                          \
+                                                                                            \
+        if (CMC_UNLIKELY(!_set_))                                                           \
+            return NULL;                                                                    \
+                                                                                            \
+        _set_->dense = NULL;                                                                \
+        _set_->capacity = 0;                                                                \
+        _set_->count = 0;                                                                   \
+        _set_->index.positions = NULL;                                                      \
+        _set_->index.universe = 0;                                                          \
+        _set_->alloc = alloc;                                                               \
+                                                                                            \
+        if (capacity > 0)                                                                   \
+        {                                                                                   \
+            _set_->dense = alloc->malloc(capacity * sizeof(V));                             \
+            _set_->capacity = capacity;                                                     \
+                                                                                            \
+            if (!_set_->dense || !cmc_sparse_index_fit(&_set_->index, capacity - 1, alloc)) \
+            {                                                                               \
+                PFX##_free(_set_);                                                          \
+                return NULL;                                                                \
+            }                                                                               \
+        }                                                                                   \
+                                                                                            \
+        return _set_;                                                                       \
+    }                                                                                       \
+                                                                                            \
+    /* Takes O(1), since stale entries of the sparse array are never trusted */             \
+    void PFX##_clear(struct SNAME *_set_)                                                   \
+    {                                                                                       \
+        _set_->count = 0;                                                                   \
+    }                                                                                       \
+                                                                                            \
+    void PFX##_free(struct SNAME *_set_)                                                    \
+    {                                                                                       \
+        _set_->alloc->free(_set_->dense);                                                   \
+        _set_->alloc->free(_set_->index.positions);                                         \
+        _set_->alloc->free(_set_);                                                          \
+    }                                                                                       \
+                                                                                            \
+    /* Returns false if the element was already in the set or if it could */                \
+    /* not be inserted */                                                                   \
+    bool PFX##_insert(struct SNAME *_set_, V element)                                       \
+    {                                                                                       \
+        if (PFX##_contains(_set_, element))                                                 \
+            return false;                                                                   \
+                                                                                            \
+        if (!cmc_sparse_index_fit(&_set_->index, (size_t)element, _set_->alloc))            \
+            return false;                                                                   \
+                                                                                            \
+        if (_set_->count == _set_->capacity)                                                \
+        {                                                                                   \
+            size_t capacity = cmc_sparse_dense_grow(_set_->capacity);                       \
+            V *dense = _set_->alloc->realloc(_set_->dense, capacity * sizeof(V));           \
+                                                                                            \
+            if (CMC_UNLIKELY(!dense))                                                       \
+                return false;                                                               \
+                                                                                            \
+            _set_->dense = dense;                                                           \
+            _set_->capacity = capacity;                                                     \
+        }                                                                                   \
+                                                                                            \
+        _set_->index.positions[(size_t)element] = (uint32_t)_set_->count;                   \
+        _set_->dense[_set_->count++] = element;                                             \
+                                                                                            \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    /* The last element of the dense array takes the place of the removed one */            \
+    bool PFX##_remove(struct SNAME *_set_, V element)                                       \
+    {                                                                                       \
+        size_t position = PFX##_index_of(_set_, element);                                   \
+                                                                                            \
+        if (position == _set_->count)                                                       \
+            return false;                                                                   \
+                                                                                            \
+        V last = _set_->dense[--_set_->count];                                              \
+                                                                                            \
+        _set_->dense[position] = last;                                                      \
+        _set_->index.positions[(size_t)last] = (uint32_t)position;                          \
+                                                                                            \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    /* The packed elements, valid until the set is modified */                              \
+    V *PFX##_data(struct SNAME *_set_)                                                      \
+    {                                                                                       \
+        return _set_->dense;                                                                \
+    }                                                                                       \
+                                                                                            \
+    /* Position of an element in data, or the count if it is not in the set */              \
+    size_t PFX##_index_of(struct SNAME *_set_, V element)                                   \
+    {                                                                                       \
+        size_t e = (size_t)element;                                                         \
+                                                                                            \
+        if (e >= _set_->index.universe)                                                     \
+            return _set_->count;                                                            \
+                                                                                            \
+        size_t position = _set_->index.positions[e];                                        \
+                                                                                            \
+        if (position < _set_->count && _set_->dense[position] == element)                   \
+            return position;                                                                \
+                                                                                            \
+        return _set_->count;                                                                \
+    }                                                                                       \
+                                                                                            \
+    bool PFX##_contains(struct SNAME *_set_, V element)                                     \
+    {                                                                                       \
+        return PFX##_index_of(_set_, element) != _set_->count;                              \
+    }                                                                                       \
+                                                                                            \
+    bool PFX##_empty(struct SNAME *_set_)                                                   \
+    {                                                                                       \
+        return _set_->count == 0;                                                           \
+    }                                                                                       \
+                                                                                            \
+    size_t PFX##_count(struct SNAME *_set_)                                                 \
+    {                                                                                       \
+        return _set_->count;                                                                \
+    }                                                                                       \
+                                                                                            \
+    size_t PFX##_memory_usage(struct SNAME *_set_)                                          \
+    {                                                                                       \
+        return sizeof(struct SNAME) + _set_->capacity * sizeof(V) +                         \
+               _set_->index.universe * sizeof(uint32_t);                                    \
+    }                                                                                       \
+                                                                                            \
+    struct SNAME *PFX##_copy_of(struct SNAME *_set_)                                        \
+    {                                                                                       \
+        struct SNAME *result = PFX##_new_custom(_set_->count, _set_->alloc);                \
+                                                                                            \
+        if (CMC_UNLIKELY(!result))                                                          \
+            return NULL;                                                                    \
+                                                                                            \
+        for (size_t i = 0; i < _set_->count; i++)                                           \
+        {                                                                                   \
+            if (!PFX##_insert(result, _set_->dense[i]))                                     \
+            {                                                                               \
+                PFX##_free(result);                                                         \
+                return NULL;                                                                \
+            }                                                                               \
+        }                                                                                   \
+                                                                                            \
+        return result;                                                                      \
+    }                                                                                       \
+                                                                                            \
+    bool PFX##_equals(struct SNAME *_set1_, struct SNAME *_set2_)                           \
+    {                                                                                       \
+        if (_set1_->count != _set2_->count)                                                 \
+            return false;                                                                   \
+                                                                                            \
+        for (size_t i = 0; i < _set1_->count; i++)                                          \
+        {                                                                                   \
+            if (!PFX##_contains(_set2_, _set1_->dense[i]))                                  \
+                return false;                                                               \
+        }                                                                                   \
+                                                                                            \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    struct cmc_string PFX##_to_string(struct SNAME *_set_)                                  \
+    {                                                                                       \
+        struct cmc_string str;                                                              \
+        struct SNAME *s_ = _set_;                                                           \
+        const char *name = #SNAME;                                                          \
+                                                                                            \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_sparseset, name, s_, s_->dense,      \
+                 s_->capacity, s_->count, s_->index.positions, s_->index.universe);         \
+                                                                                            \
+        return str;                                                                         \
+    }                                                                                       \
+                                                                                            \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                               \
+    {                                                                                       \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));     \
+                                                                                            \
+        if (CMC_UNLIKELY(!iter))                                                            \
+            return NULL;                                                                    \
+                                                                                            \
+        PFX##_iter_init(iter, target);                                                      \
+                                                                                            \
+        return iter;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    void PFX##_iter_free(struct SNAME##_iter *iter)                                         \
+    {                                                                                       \
+        iter->target->alloc->free(iter);                                                    \
+    }                                                                                       \
+                                                                                            \
+    /* Iterates in the order of the dense array */                                          \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                   \
+    {                                                                                       \
+        iter->target = target;                                                              \
+        iter->cursor = 0;                                                                   \
+        iter->start = true;                                                                 \
+        iter->end = PFX##_empty(target);                                                    \
+    }                                                                                       \
+                                                                                            \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                        \
+    {                                                                                       \
+        return PFX##_empty(iter->target) || iter->start;                                    \
+    }                                                                                       \
+                                                                                            \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                          \
+    {                                                                                       \
+        return PFX##_empty(iter->target) || iter->end;                                      \
+    }                                                                                       \
+                                                                                            \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                     \
+    {                                                                                       \
+        if (!PFX##_empty(iter->target))                                                     \
+        {                                                                                   \
+            iter->cursor = 0;                                                               \
+            iter->start = true;                                                             \
+            iter->end = false;                                                              \
+        }                                                                                   \
+    }                                                                                       \
+                                                                                            \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                       \
+    {                                                                                       \
+        if (!PFX##_empty(iter->target))                                                     \
+        {                                                                                   \
+            iter->cursor = iter->target->count - 1;                                         \
+            iter->start = false;                                                            \
+            iter->end = true;                                                               \
+        }                                                                                   \
+    }                                                                                       \
+                                                                                            \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                         \
+    {                                                                                       \
+        if (iter->end)                                                                      \
+            return false;                                                                   \
+                                                                                            \
+        if (iter->cursor + 1 == iter->target->count)                                        \
+        {                                                                                   \
+            iter->end = true;                                                               \
+            return false;                                                                   \
+        }                                                                                   \
+                                                                                            \
+        iter->start = false;                                                                \
+        iter->cursor++;                                                                     \
+                                                                                            \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                         \
+    {                                                                                       \
+        if (iter->start)                                                                    \
+            return false;                                                                   \
+                                                                                            \
+        if (iter->cursor == 0)                                                              \
+        {                                                                                   \
+            iter->start = true;                                                             \
+            return false;                                                                   \
+        }                                                                                   \
+                                                                                            \
+        iter->end = false;                                                                  \
+        iter->cursor--;                                                                     \
+                                                                                            \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                           \
+    {                                                                                       \
+        if (PFX##_empty(iter->target))                                                      \
+            return (V){0};                                                                  \
+                                                                                            \
+        return iter->target->dense[iter->cursor];                                           \
+    }                                                                                       \
+                                                                                            \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                      \
+    {                                                                                       \
+        return iter->cursor;                                                                \
+    }
+
+#define CMC_GENERATE_SPARSEMAP_SOURCE(PFX, SNAME, K, V)                                 \
+                                                                                        \
+    /* Implementation Detail Functions */                                               \
+    static size_t PFX##_impl_position(struct SNAME *_map_, K key);                      \
+                                                                                        \
+    /* The capacity is for keys and values and is also the size of the */               \
+    /* sparse array until a greater key is inserted */                                  \
+    struct SNAME *PFX##_new(size_t capacity)                                            \
+    {                                                                                   \
+        return PFX##_new_custom(capacity, NULL);                                        \
+    }                                                                                   \
+                                                                                        \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc)       \
+    {                                                                                   \
+        if (!alloc)                                                                     \
+            alloc = &cmc_alloc_node_default;                                            \
+                                                                                        \
+        struct SNAME *_map_ = alloc->malloc(sizeof(struct SNAME));                      \
+                                                                                        \
+        if (CMC_UNLIKELY(!_map_))                                                       \
+            return NULL;                                                                \
+                                                                                        \
+        _map_->keys = NULL;                                                             \
+        _map_->values = NULL;                                                           \
+        _map_->capacity = 0;                                                            \
+        _map_->count = 0;                                                               \
+        _map_->index.positions = NULL;                                                  \
+        _map_->index.universe = 0;                                                      \
+        _map_->alloc = alloc;                                                           \
+                                                                                        \
+        if (capacity > 0)                                                               \
+        {                                                                               \
+            _map_->keys = alloc->malloc(capacity * sizeof(K));                          \
+            _map_->values = alloc->malloc(capacity * sizeof(V));                        \
+            _map_->capacity = capacity;                                                 \
+                                                                                        \
+            if (!_map_->keys || !_map_->values ||                                       \
+                !cmc_sparse_index_fit(&_map_->index, capacity - 1, alloc))              \
+            {                                                                           \
+                PFX##_free(_map_, NULL);                                                \
+                return NULL;                                                            \
+            }                                                                           \
+        }                                                                               \
+                                                                                        \
+        return _map_;                                                                   \
+    }                                                                                   \
+                                                                                        \
+    /* Takes O(1) without a deallocator */                                              \
+    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V))                    \
+    {                                                                                   \
+        if (deallocator)                                                                \
+        {                                                                               \
+            for (size_t i = 0; i < _map_->count; i++)                                   \
+                deallocator(_map_->keys[i], _map_->values[i]);                          \
+        }                                                                               \
+                                                                                        \
+        _map_->count = 0;                                                               \
+    }                                                                                   \
+                                                                                        \
+    void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V))                     \
+    {                                                                                   \
+        PFX##_clear(_map_, deallocator);                                                \
+                                                                                        \
+        _map_->alloc->free(_map_->keys);                                                \
+        _map_->alloc->free(_map_->values);                                              \
+        _map_->alloc->free(_map_->index.positions);                                     \
+        _map_->alloc->free(_map_);                                                      \
+    }                                                                                   \
+                                                                                        \
+    /* Returns false if the key was already in the map or if it could not */            \
+    /* be inserted */                                                                   \
+    bool PFX##_insert(struct SNAME *_map_, K key, V value)                              \
+    {                                                                                   \
+        if (PFX##_contains(_map_, key))                                                 \
+            return false;                                                               \
+                                                                                        \
+        if (!cmc_sparse_index_fit(&_map_->index, (size_t)key, _map_->alloc))            \
+            return false;                                                               \
+                                                                                        \
+        if (_map_->count == _map_->capacity)                                            \
+        {                                                                               \
+            size_t capacity = cmc_sparse_dense_grow(_map_->capacity);                   \
+            K *keys = _map_->alloc->realloc(_map_->keys, capacity * sizeof(K));         \
+                                                                                        \
+            if (CMC_UNLIKELY(!keys))                                                    \
+                return false;                                                           \
+                                                                                        \
+            /* Larger than the capacity until values is grown too */                    \
+            _map_->keys = keys;                                                         \
+                                                                                        \
+            V *values = _map_->alloc->realloc(_map_->values, capacity * sizeof(V));     \
+                                                                                        \
+            if (CMC_UNLIKELY(!values))                                                  \
+                return false;                                                           \
+                                                                                        \
+            _map_->values = values;                                                     \
+            _map_->capacity = capacity;                                                 \
+        }                                                                               \
+                                                                                        \
+        _map_->index.positions[(size_t)key] = (uint32_t)_map_->count;                   \
+        _map_->keys[_map_->count] = key;                                                \
+        _map_->values[_map_->count] = value;                                            \
+        _map_->count++;                                                                 \
+                                                                                        \
+        return true;                                                                    \
+    }                                                                                   \
+                                                                                        \
+    bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value)            \
+    {                                                                                   \
+        size_t position = PFX##_impl_position(_map_, key);                              \
+                                                                                        \
+        if (position == _map_->count)                                                   \
+            return false;                                                               \
+                                                                                        \
+        if (old_value)                                                                  \
+            *old_value = _map_->values[position];                                       \
+                                                                                        \
+        _map_->values[position] = new_value;                                            \
+                                                                                        \
+        return true;                                                                    \
+    }                                                                                   \
+                                                                                        \
+    /* The last key and value take the place of the removed ones */                     \
+    bool PFX##_remove(struct SNAME *_map_, K key, V *out_value)                         \
+    {                                                                                   \
+        size_t position = PFX##_impl_position(_map_, key);                              \
+                                                                                        \
+        if (position == _map_->count)                                                   \
+            return false;                                                               \
+                                                                                        \
+        if (out_value)                                                                  \
+            *out_value = _map_->values[position];                                       \
+                                                                                        \
+        size_t last = --_map_->count;                                                   \
+                                                                                        \
+        _map_->keys[position] = _map_->keys[last];                                      \
+        _map_->values[position] = _map_->values[last];                                  \
+        _map_->index.positions[(size_t)_map_->keys[position]] = (uint32_t)position;     \
+                                                                                        \
+        return true;                                                                    \
+    }                                                                                   \
+                                                                                        \
+    V PFX##_get(struct SNAME *_map_, K key)                                             \
+    {                                                                                   \
+        size_t position = PFX##_impl_position(_map_, key);                              \
+                                                                                        \
+        if (position == _map_->count)                                                   \
+            return (V){0};                                                              \
+                                                                                        \
+        return _map_->values[position];                                                 \
+    }                                                                                   \
+                                                                                        \
+    V *PFX##_get_ref(struct SNAME *_map_, K key)                                        \
+    {                                                                                   \
+        size_t position = PFX##_impl_position(_map_, key);                              \
+                                                                                        \
+        if (position == _map_->count)                                                   \
+            return NULL;                                                                \
+                                                                                        \
+        return &(_map_->values[position]);                                              \
+    }                                                                                   \
+                                                                                        \
+    /* The packed keys, valid until the map is modified */                              \
+    K *PFX##_keys(struct SNAME *_map_)                                                  \
+    {                                                                                   \
+        return _map_->keys;                                                             \
+    }                                                                                   \
+                                                                                        \
+    /* The packed values, in the same order as keys */                                  \
+    V *PFX##_values(struct SNAME *_map_)                                                \
+    {                                                                                   \
+        return _map_->values;                                                           \
+    }                                                                                   \
+                                                                                        \
+    bool PFX##_contains(struct SNAME *_map_, K key)                                     \
+    {                                                                                   \
+        return PFX##_impl_position(_map_, key) != _map_->count;                         \
+    }                                                                                   \
+                                                                                        \
+    bool PFX##_empty(struct SNAME *_map_)                                               \
+    {                                                                                   \
+        return _map_->count == 0;                                                       \
+    }                                                                                   \
+                                                                                        \
+    size_t PFX##_count(struct SNAME *_map_)                                             \
+    {                                                                                   \
+        return _map_->count;                                                            \
+    }                                                                                   \
+                                                                                        \
+    size_t PFX##_memory_usage(struct SNAME *_map_)                                      \
+    {                                                                                   \
+        return sizeof(struct SNAME) + _map_->capacity * (sizeof(K) + sizeof(V)) +       \
+               _map_->index.universe * sizeof(uint32_t);                                \
+    }                                                                                   \
+                                                                                        \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_)                              \
+    {                                                                                   \
+        struct cmc_string str;                                                          \
+        struct SNAME *m_ = _map_;                                                       \
+        const char *name = #SNAME;                                                      \
+                                                                                        \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_sparsemap, name, m_, m_->keys,   \
+                 m_->values, m_->capacity, m_->count, m_->index.positions,              \
+                 m_->index.universe);                                                   \
+                                                                                        \
+        return str;                                                                     \
+    }                                                                                   \
+                                                                                        \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                           \
+    {                                                                                   \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter)); \
+                                                                                        \
+        if (CMC_UNLIKELY(!iter))                                                        \
+            return NULL;                                                                \
+                                                                                        \
+        PFX##_iter_init(iter, target);                                                  \
+                                                                                        \
+        return iter;                                                                    \
+    }                                                                                   \
+                                                                                        \
+    void PFX##_iter_free(struct SNAME##_iter *iter)                                     \
+    {                                                                                   \
+        iter->target->alloc->free(iter);                                                \
+    }                                                                                   \
+                                                                                        \
+    /* Iterates in the order of the packed keys */                                      \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)               \
+    {                                                                                   \
+        iter->target = target;                                                          \
+        iter->cursor = 0;                                                               \
+        iter->start = true;                                                             \
+        iter->end = PFX##_empty(target);                                                \
+    }                                                                                   \
+                                                                                        \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                    \
+    {                                                                                   \
+        return PFX##_empty(iter->target) || iter->start;                                \
+    }                                                                                   \
+                                                                                        \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                      \
+    {                                                                                   \
+        return PFX##_empty(iter->target) || iter->end;                                  \
+    }                                                                                   \
+                                                                                        \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                 \
+    {                                                                                   \
+        if (!PFX##_empty(iter->target))                                                 \
+        {                                                                               \
+            iter->cursor = 0;                                                           \
+            iter->start = true;                                                         \
+            iter->end = false;                                                          \
+        }                                                                               \
+    }                                                                                   \
+                                                                                        \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                   \
+    {                                                                                   \
+        if (!PFX##_empty(iter->target))                                                 \
+        {                                                                               \
+            iter->cursor = iter->target->count - 1;                                     \
+            iter->start = false;                                                        \
+            iter->end = true;                                                           \
+        }                                                                               \
+    }                                                                                   \
+                                                                                        \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                     \
+    {                                                                                   \
+        if (iter->end)                                                                  \
+            return false;                                                               \
+                                                                                        \
+        if (iter->cursor + 1 == iter->target->count)                                    \
+        {                                                                               \
+            iter->end = true;                                                           \
+            return false;                                                               \
+        }                                                                               \
+                                                                                        \
+        iter->start = false;                                                            \
+        iter->cursor++;                                                                 \
+                                                                                        \
+        return true;                                                                    \
+    }                                                                                   \
+                                                                                        \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                     \
+    {                                                                                   \
+        if (iter->start)                                                                \
+            return false;                                                               \
+                                                                                        \
+        if (iter->cursor == 0)                                                          \
+        {                                                                               \
+            iter->start = true;                                                         \
+            return false;                                                               \
+        }                                                                               \
+                                                                                        \
+        iter->end = false;                                                              \
+        iter->cursor--;                                                                 \
+                                                                                        \
+        return true;                                                                    \
+    }                                                                                   \
+                                                                                        \
+    K PFX##_iter_key(struct SNAME##_iter *iter)                                         \
+    {                                                                                   \
+        if (PFX##_empty(iter->target))                                                  \
+            return (K){0};                                                              \
+                                                                                        \
+        return iter->target->keys[iter->cursor];                                        \
+    }                                                                                   \
+                                                                                        \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                       \
+    {                                                                                   \
+        if (PFX##_empty(iter->target))                                                  \
+            return (V){0};                                                              \
+                                                                                        \
+        return iter->target->values[iter->cursor];                                      \
+    }                                                                                   \
+                                                                                        \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter)                                     \
+    {                                                                                   \
+        if (PFX##_empty(iter->target))                                                  \
+            return NULL;                                                                \
+                                                                                        \
+        return &(iter->target->values[iter->cursor]);                                   \
+    }                                                                                   \
+                                                                                        \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                  \
+    {                                                                                   \
+        return iter->cursor;                                                            \
+    }                                                                                   \
+                                                                                        \
+    /* Position of a key in keys and values, or the count if it is not there */         \
+    static size_t PFX##_impl_position(struct SNAME *_map_, K key)                       \
+    {                                                                                   \
+        size_t k = (size_t)key;                                                         \
+                                                                                        \
+        if (k >= _map_->index.universe)                                                 \
+            return _map_->count;                                                        \
+                                                                                        \
+        size_t position = _map_->index.positions[k];                                    \
+                                                                                        \
+        if (position < _map_->count && _map_->keys[position] == key)                    \
+            return position;                                                            \
+                                                                                        \
+        return _map_->count;                                                            \
+    }
+
+#endif /* CMC_SPARSESET_H */
@@ -33,11 +33,23 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_growth.h"
+#include "../utl/cmc_scan.h"
+#include "../utl/cmc_serial.h"
 #include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
 
 /* to_string format */
 static const char *cmc_string_fmt_stack = "%s at %p { buffer:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX " }";
 
+/* A removal shrinks a collection once less than this fraction of what it */
+/* can hold without growing is in use. Define it as 0 to never shrink */
+#ifndef CMC_SHRINK_LOW_WATER
+#define CMC_SHRINK_LOW_WATER 0.25
+#endif
+
 #define CMC_GENERATE_STACK(PFX, SNAME, V)    \
     CMC_GENERATE_STACK_HEADER(PFX, SNAME, V) \
     CMC_GENERATE_STACK_SOURCE(PFX, SNAME, V)
@@ -48,6 +60,29 @@ static const char *cmc_string_fmt_stack = "%s at %p { buffer:%p, capacity:%" PRI
 #define CMC_WRAPGEN_STACK_SOURCE(PFX, SNAME, K, V) \
     CMC_GENERATE_STACK_SOURCE(PFX, SNAME, V)
 
+/* Same as CMC_GENERATE_STACK but contains compares the bytes of the */
+/* elements with the vector search of cmc_scan.h, for types like integers */
+/* and pointers. The comparator is ignored and may be NULL */
+#define CMC_GENERATE_STACK_BITWISE(PFX, SNAME, V) \
+    CMC_GENERATE_STACK_HEADER(PFX, SNAME, V)      \
+    CMC_GENERATE_STACK_BITWISE_SOURCE(PFX, SNAME, V)
+
+/* Same as CMC_GENERATE_STACK but V is plain data that owns nothing, so */
+/* removals and clear leave the slots they free as they are instead of */
+/* overwriting them with zeros */
+#define CMC_GENERATE_STACK_TRIVIAL(PFX, SNAME, V) \
+    CMC_GENERATE_STACK_HEADER(PFX, SNAME, V)      \
+    CMC_GENERATE_STACK_TRIVIAL_SOURCE(PFX, SNAME, V)
+
+#define CMC_GENERATE_STACK_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_STACK_SOURCE(PFX, SNAME, V, false, false)
+
+#define CMC_GENERATE_STACK_BITWISE_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_STACK_SOURCE(PFX, SNAME, V, true, false)
+
+#define CMC_GENERATE_STACK_TRIVIAL_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_STACK_SOURCE(PFX, SNAME, V, false, true)
+
 /* HEADER ********************************************************************/
 #define CMC_GENERATE_STACK_HEADER(PFX, SNAME, V)                                                \
                                                                                                 \
@@ -68,6 +103,9 @@ static const char *cmc_string_fmt_stack = "%s at %p { buffer:%p, capacity:%" PRI
                                                                                                 \
         /* Function that returns an iterator to the end of the stack */                         \
         struct SNAME##_iter (*it_end)(struct SNAME *);                                          \
+                                                                                                \
+        /* Custom allocation functions */                                                       \
+        struct cmc_alloc_node *alloc;                                                           \
     };                                                                                          \
                                                                                                 \
     /* Stack Iterator */                                                                        \
@@ -89,24 +127,38 @@ static const char *cmc_string_fmt_stack = "%s at %p { buffer:%p, capacity:%" PRI
     /* Collection Functions */                                                                  \
     /* Collection Allocation and Deallocation */                                                \
     struct SNAME *PFX##_new(size_t capacity);                                                   \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc);              \
+    struct SNAME *PFX##_new_from(V *elements, size_t size);                                     \
     void PFX##_clear(struct SNAME *_stack_, void (*deallocator)(V));                            \
     void PFX##_free(struct SNAME *_stack_, void (*deallocator)(V));                             \
     /* Collection Input and Output */                                                           \
     bool PFX##_push(struct SNAME *_stack_, V element);                                          \
     bool PFX##_pop(struct SNAME *_stack_);                                                      \
+    size_t PFX##_remove_if(struct SNAME *_stack_, bool (*pred)(V), void (*deallocator)(V));     \
     /* Element Access */                                                                        \
     V PFX##_top(struct SNAME *_stack_);                                                         \
     /* Collection State */                                                                      \
     bool PFX##_contains(struct SNAME *_stack_, V element, int (*comparator)(V, V));             \
-    bool PFX##_empty(struct SNAME *_stack_);                                                    \
+    CMC_PURE bool PFX##_empty(struct SNAME *_stack_);                                           \
     bool PFX##_full(struct SNAME *_stack_);                                                     \
-    size_t PFX##_count(struct SNAME *_stack_);                                                  \
+    CMC_PURE size_t PFX##_count(struct SNAME *_stack_);                                         \
+    size_t PFX##_memory_usage(struct SNAME *_stack_);                                           \
     size_t PFX##_capacity(struct SNAME *_stack_);                                               \
     /* Collection Utility */                                                                    \
     bool PFX##_resize(struct SNAME *_stack_, size_t capacity);                                  \
+    bool PFX##_shrink_to_fit(struct SNAME *_stack_);                                            \
+    bool PFX##_reserve(struct SNAME *_stack_, size_t capacity);                                 \
     struct SNAME *PFX##_copy_of(struct SNAME *_stack_, V (*copy_func)(V));                      \
+    size_t PFX##_to_array(struct SNAME *_stack_, V *CMC_RESTRICT elements, size_t size);        \
     bool PFX##_equals(struct SNAME *_stack1_, struct SNAME *_stack2_, int (*comparator)(V, V)); \
     struct cmc_string PFX##_to_string(struct SNAME *_stack_);                                   \
+    bool PFX##_to_string_full(struct SNAME *_stack_, struct cmc_string_builder *builder,        \
+                              const char *elem_fmt);                                            \
+    bool PFX##_write(struct SNAME *_stack_, FILE *file, void (*fmt)(FILE *, V));                \
+    bool PFX##_write_fd(struct SNAME *_stack_, int fd, void (*fmt)(struct cmc_dump *, V));      \
+    /* Collection Serialization */                                                              \
+    bool PFX##_save(struct SNAME *_stack_, FILE *file, bool (*writer)(V, FILE *));              \
+    struct SNAME *PFX##_restore(FILE *file, bool (*reader)(V *, FILE *));                       \
                                                                                                 \
     /* Iterator Functions */                                                                    \
     /* Iterator Allocation and Deallocation */                                                  \
@@ -131,27 +183,39 @@ static const char *cmc_string_fmt_stack = "%s at %p { buffer:%p, capacity:%" PRI
     size_t PFX##_iter_index(struct SNAME##_iter *iter);                                         \
                                                                                                 \
 /* SOURCE ********************************************************************/
-#define CMC_GENERATE_STACK_SOURCE(PFX, SNAME, V)                                               \
+#define CMC_IMPL_STACK_SOURCE(PFX, SNAME, V, BITWISE, TRIVIAL)                                 \
                                                                                                \
     /* Implementation Detail Functions */                                                      \
+    static void PFX##_impl_low_water(struct SNAME *_stack_);                                   \
+    static bool PFX##_impl_grow(struct SNAME *_stack_, size_t required);                       \
     static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_stack_);                     \
     static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_stack_);                       \
                                                                                                \
     struct SNAME *PFX##_new(size_t capacity)                                                   \
     {                                                                                          \
+        return PFX##_new_custom(capacity, NULL);                                               \
+    }                                                                                          \
+                                                                                               \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc)              \
+    {                                                                                          \
+        if (!alloc)                                                                            \
+            alloc = &cmc_alloc_node_default;                                                   \
+                                                                                               \
         if (capacity < 1)                                                                      \
             return NULL;                                                                       \
                                                                                                \
-        struct SNAME *_stack_ = malloc(sizeof(struct SNAME));                                  \
+        struct SNAME *_stack_ = alloc->malloc(sizeof(struct SNAME));                           \
                                                                                                \
-        if (!_stack_)                                                                          \
+        if (CMC_UNLIKELY(!_stack_))                                                            \
             return NULL;                                                                       \
                                                                                                \
-        _stack_->buffer = calloc(capacity, sizeof(V));                                         \
+        _stack_->alloc = alloc;                                                                \
+                                                                                               \
+        _stack_->buffer = alloc->calloc(capacity, sizeof(V));                                  \
                                                                                                \
-        if (!_stack_->buffer)                                                                  \
+        if (CMC_UNLIKELY(!_stack_->buffer))                                                    \
         {                                                                                      \
-            free(_stack_);                                                                     \
+            alloc->free(_stack_);                                                              \
             return NULL;                                                                       \
         }                                                                                      \
                                                                                                \
@@ -164,6 +228,25 @@ static const char *cmc_string_fmt_stack = "%s at %p { buffer:%p, capacity:%" PRI
         return _stack_;                                                                        \
     }                                                                                          \
                                                                                                \
+    /* Creates a stack with the size elements, the last one at the top, with */                \
+    /* room for half as many more */                                                           \
+    struct SNAME *PFX##_new_from(V *elements, size_t size)                                     \
+    {                                                                                          \
+        if (size == 0)                                                                         \
+            return NULL;                                                                       \
+                                                                                               \
+        struct SNAME *_stack_ = PFX##_new(size + size / 2);                                    \
+                                                                                               \
+        if (CMC_UNLIKELY(!_stack_))                                                            \
+            return NULL;                                                                       \
+                                                                                               \
+        memcpy(_stack_->buffer, elements, size * sizeof(V));                                   \
+                                                                                               \
+        _stack_->count = size;                                                                 \
+                                                                                               \
+        return _stack_;                                                                        \
+    }                                                                                          \
+                                                                                               \
     void PFX##_clear(struct SNAME *_stack_, void (*deallocator)(V))                            \
     {                                                                                          \
         if (deallocator)                                                                       \
@@ -172,28 +255,29 @@ static const char *cmc_string_fmt_stack = "%s at %p { buffer:%p, capacity:%" PRI
                 deallocator(_stack_->buffer[i]);                                               \
         }                                                                                      \
                                                                                                \
-        memset(_stack_->buffer, 0, sizeof(V) * _stack_->capacity);                             \
+        if (!TRIVIAL)                                                                          \
+            memset(_stack_->buffer, 0, sizeof(V) * _stack_->capacity);                         \
                                                                                                \
         _stack_->count = 0;                                                                    \
     }                                                                                          \
                                                                                                \
     void PFX##_free(struct SNAME *_stack_, void (*deallocator)(V))                             \
     {                                                                                          \
-        free(_stack_->buffer);                                                                 \
         if (deallocator)                                                                       \
         {                                                                                      \
             for (size_t i = 0; i < _stack_->count; i++)                                        \
                 deallocator(_stack_->buffer[i]);                                               \
         }                                                                                      \
                                                                                                \
-        free(_stack_);                                                                         \
+        _stack_->alloc->free(_stack_->buffer);                                                 \
+        _stack_->alloc->free(_stack_);                                                         \
     }                                                                                          \
                                                                                                \
     bool PFX##_push(struct SNAME *_stack_, V element)                                          \
     {                                                                                          \
         if (PFX##_full(_stack_))                                                               \
         {                                                                                      \
-            if (!PFX##_resize(_stack_, PFX##_capacity(_stack_) * 2))                           \
+            if (CMC_UNLIKELY(!PFX##_impl_grow(_stack_, _stack_->count + 1)))                   \
                 return false;                                                                  \
         }                                                                                      \
                                                                                                \
@@ -207,11 +291,48 @@ static const char *cmc_string_fmt_stack = "%s at %p { buffer:%p, capacity:%" PRI
         if (PFX##_empty(_stack_))                                                              \
             return false;                                                                      \
                                                                                                \
-        _stack_->buffer[--_stack_->count] = (V){0};                                            \
+        _stack_->count--;                                                                      \
+                                                                                               \
+        if (!TRIVIAL)                                                                          \
+            _stack_->buffer[_stack_->count] = (V){0};                                          \
+                                                                                               \
+        PFX##_impl_low_water(_stack_);                                                         \
                                                                                                \
         return true;                                                                           \
     }                                                                                          \
                                                                                                \
+    /* Removes every element for which pred is true in a single pass that */                   \
+    /* moves the others towards the bottom, keeping their order. Returns */                    \
+    /* how many were removed */                                                                \
+    size_t PFX##_remove_if(struct SNAME *_stack_, bool (*pred)(V), void (*deallocator)(V))     \
+    {                                                                                          \
+        size_t kept = 0;                                                                       \
+                                                                                               \
+        for (size_t i = 0; i < _stack_->count; i++)                                            \
+        {                                                                                      \
+            V element = _stack_->buffer[i];                                                    \
+                                                                                               \
+            if (!pred(element))                                                                \
+                _stack_->buffer[kept++] = element;                                             \
+            else if (deallocator)                                                              \
+                deallocator(element);                                                          \
+        }                                                                                      \
+                                                                                               \
+        size_t removed = _stack_->count - kept;                                                \
+                                                                                               \
+        if (removed == 0)                                                                      \
+            return 0;                                                                          \
+                                                                                               \
+        if (!TRIVIAL)                                                                          \
+            memset(_stack_->buffer + kept, 0, removed * sizeof(V));                            \
+                                                                                               \
+        _stack_->count = kept;                                                                 \
+                                                                                               \
+        PFX##_impl_low_water(_stack_);                                                         \
+                                                                                               \
+        return removed;                                                                        \
+    }                                                                                          \
+                                                                                               \
     V PFX##_top(struct SNAME *_stack_)                                                         \
     {                                                                                          \
         if (PFX##_empty(_stack_))                                                              \
@@ -222,6 +343,13 @@ static const char *cmc_string_fmt_stack = "%s at %p { buffer:%p, capacity:%" PRI
                                                                                                \
     bool PFX##_contains(struct SNAME *_stack_, V element, int (*comparator)(V, V))             \
     {                                                                                          \
+        if (BITWISE)                                                                           \
+        {                                                                                      \
+            size_t count = _stack_->count;                                                     \
+                                                                                               \
+            return cmc_scan_find(_stack_->buffer, count, sizeof(V), &element) != count;        \
+        }                                                                                      \
+                                                                                               \
         for (size_t i = 0; i < _stack_->count; i++)                                            \
         {                                                                                      \
             if (comparator(_stack_->buffer[i], element) == 0)                                  \
@@ -246,6 +374,11 @@ static const char *cmc_string_fmt_stack = "%s at %p { buffer:%p, capacity:%" PRI
         return _stack_->count;                                                                 \
     }                                                                                          \
                                                                                                \
+    size_t PFX##_memory_usage(struct SNAME *_stack_)                                           \
+    {                                                                                          \
+        return sizeof(struct SNAME) + sizeof(V) * _stack_->capacity;                           \
+    }                                                                                          \
+                                                                                               \
     size_t PFX##_capacity(struct SNAME *_stack_)                                               \
     {                                                                                          \
         return _stack_->capacity;                                                              \
@@ -259,9 +392,9 @@ static const char *cmc_string_fmt_stack = "%s at %p { buffer:%p, capacity:%" PRI
         if (capacity < PFX##_count(_stack_))                                                   \
             return false;                                                                      \
                                                                                                \
-        V *new_buffer = realloc(_stack_->buffer, sizeof(V) * capacity);                        \
+        V *new_buffer = _stack_->alloc->realloc(_stack_->buffer, sizeof(V) * capacity);        \
                                                                                                \
-        if (!new_buffer)                                                                       \
+        if (CMC_UNLIKELY(!new_buffer))                                                         \
             return false;                                                                      \
                                                                                                \
         _stack_->buffer = new_buffer;                                                          \
@@ -270,11 +403,26 @@ static const char *cmc_string_fmt_stack = "%s at %p { buffer:%p, capacity:%" PRI
         return true;                                                                           \
     }                                                                                          \
                                                                                                \
+    bool PFX##_shrink_to_fit(struct SNAME *_stack_)                                            \
+    {                                                                                          \
+        return PFX##_resize(_stack_, _stack_->count > 0 ? _stack_->count : 1);                 \
+    }                                                                                          \
+                                                                                               \
+    /* Grows the buffer so that at least capacity elements fit. Unlike */                      \
+    /* resize it never shrinks the buffer */                                                   \
+    bool PFX##_reserve(struct SNAME *_stack_, size_t capacity)                                 \
+    {                                                                                          \
+        if (capacity <= _stack_->capacity)                                                     \
+            return true;                                                                       \
+                                                                                               \
+        return PFX##_resize(_stack_, capacity);                                                \
+    }                                                                                          \
+                                                                                               \
     struct SNAME *PFX##_copy_of(struct SNAME *_stack_, V (*copy_func)(V))                      \
     {                                                                                          \
-        struct SNAME *result = PFX##_new(_stack_->capacity);                                   \
+        struct SNAME *result = PFX##_new_custom(_stack_->capacity, _stack_->alloc);            \
                                                                                                \
-        if (!result)                                                                           \
+        if (CMC_UNLIKELY(!result))                                                             \
             return NULL;                                                                       \
                                                                                                \
         if (copy_func)                                                                         \
@@ -290,6 +438,18 @@ static const char *cmc_string_fmt_stack = "%s at %p { buffer:%p, capacity:%" PRI
         return result;                                                                         \
     }                                                                                          \
                                                                                                \
+    /* Copies up to size elements, in the order that they are iterated, to */                  \
+    /* elements and returns how many were copied */                                            \
+    size_t PFX##_to_array(struct SNAME *_stack_, V *CMC_RESTRICT elements, size_t size)        \
+    {                                                                                          \
+        if (size > _stack_->count)                                                             \
+            size = _stack_->count;                                                             \
+                                                                                               \
+        memcpy(elements, _stack_->buffer, size * sizeof(V));                                   \
+                                                                                               \
+        return size;                                                                           \
+    }                                                                                          \
+                                                                                               \
     bool PFX##_equals(struct SNAME *_stack1_, struct SNAME *_stack2_, int (*comparator)(V, V)) \
     {                                                                                          \
         if (PFX##_count(_stack1_) != PFX##_count(_stack2_))                                    \
@@ -316,11 +476,71 @@ static const char *cmc_string_fmt_stack = "%s at %p { buffer:%p, capacity:%" PRI
         return str;                                                                            \
     }                                                                                          \
                                                                                                \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE)                             \
+                                                                                               \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE, (V))                               \
+                                                                                               \
+    bool PFX##_save(struct SNAME *_stack_, FILE *file, bool (*writer)(V, FILE *))              \
+    {                                                                                          \
+        uint32_t flags = writer ? 0 : CMC_SERIAL_RAW_VALUES;                                   \
+                                                                                               \
+        if (!cmc_serial_write_header(file, "stack", flags, 0, sizeof(V), 0,                    \
+                                     _stack_->count, _stack_->capacity, 0))                    \
+            return false;                                                                      \
+                                                                                               \
+        /* Without a writer the whole buffer is written at once */                             \
+        if (!writer)                                                                           \
+            return fwrite(_stack_->buffer, sizeof(V), _stack_->count, file) == _stack_->count; \
+                                                                                               \
+        for (size_t i = 0; i < _stack_->count; i++)                                            \
+        {                                                                                      \
+            if (!writer(_stack_->buffer[i], file))                                             \
+                return false;                                                                  \
+        }                                                                                      \
+                                                                                               \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    /* The reader is only used if the stack was saved with a writer */                         \
+    struct SNAME *PFX##_restore(FILE *file, bool (*reader)(V *, FILE *))                       \
+    {                                                                                          \
+        struct cmc_serial_header header;                                                       \
+                                                                                               \
+        if (!cmc_serial_read_header(file, "stack", 0, sizeof(V), &header))                     \
+            return NULL;                                                                       \
+                                                                                               \
+        if (header.capacity < header.count)                                                    \
+            return NULL;                                                                       \
+                                                                                               \
+        /* Allocated with the saved capacity so that loading never grows */                    \
+        struct SNAME *_stack_ = PFX##_new(header.capacity);                                    \
+                                                                                               \
+        if (CMC_UNLIKELY(!_stack_))                                                            \
+            return NULL;                                                                       \
+                                                                                               \
+        if (header.flags & CMC_SERIAL_RAW_VALUES)                                              \
+            _stack_->count = fread(_stack_->buffer, sizeof(V), header.count, file);            \
+        else                                                                                   \
+        {                                                                                      \
+            while (_stack_->count < header.count &&                                            \
+                   CMC_SERIAL_READ(false, reader, &(_stack_->buffer[_stack_->count]), file))   \
+                _stack_->count++;                                                              \
+        }                                                                                      \
+                                                                                               \
+        if (_stack_->count != header.count)                                                    \
+        {                                                                                      \
+            PFX##_free(_stack_, NULL);                                                         \
+            return NULL;                                                                       \
+        }                                                                                      \
+                                                                                               \
+        return _stack_;                                                                        \
+    }                                                                                          \
+                                                                                               \
     struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                  \
     {                                                                                          \
-        struct SNAME##_iter *iter = malloc(sizeof(struct SNAME##_iter));                       \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));        \
                                                                                                \
-        if (!iter)                                                                             \
+        if (CMC_UNLIKELY(!iter))                                                               \
             return NULL;                                                                       \
                                                                                                \
         PFX##_iter_init(iter, target);                                                         \
@@ -330,7 +550,7 @@ static const char *cmc_string_fmt_stack = "%s at %p { buffer:%p, capacity:%" PRI
                                                                                                \
     void PFX##_iter_free(struct SNAME##_iter *iter)                                            \
     {                                                                                          \
-        free(iter);                                                                            \
+        iter->target->alloc->free(iter);                                                       \
     }                                                                                          \
                                                                                                \
     void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                      \
@@ -490,6 +710,25 @@ static const char *cmc_string_fmt_stack = "%s at %p { buffer:%p, capacity:%" PRI
         return iter->target->count - 1 - iter->cursor;                                         \
     }                                                                                          \
                                                                                                \
+    /* Called after removals, halves the buffer until it is no longer mostly empty */          \
+    static void PFX##_impl_low_water(struct SNAME *_stack_)                                    \
+    {                                                                                          \
+        size_t capacity = _stack_->capacity;                                                   \
+                                                                                               \
+        while (capacity > 1 &&                                                                 \
+               (double)_stack_->count < (double)capacity * CMC_SHRINK_LOW_WATER)               \
+            capacity /= 2;                                                                     \
+                                                                                               \
+        if (capacity != _stack_->capacity)                                                     \
+            PFX##_resize(_stack_, capacity);                                                   \
+    }                                                                                          \
+                                                                                               \
+    /* Called when the buffer is full, grows it by the policy of cmc_growth.h */               \
+    static bool PFX##_impl_grow(struct SNAME *_stack_, size_t required)                        \
+    {                                                                                          \
+        return PFX##_resize(_stack_, cmc_growth_capacity(_stack_->capacity, required));        \
+    }                                                                                          \
+                                                                                               \
     static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_stack_)                      \
     {                                                                                          \
         struct SNAME##_iter iter;                                                              \
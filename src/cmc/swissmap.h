@@ -0,0 +1,1649 @@
+/**
+ * swissmap.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * SwissMap
+ *
+ * A SwissMap is an implementation of a Map with unique keys, where every key
+ * is mapped to a value. The keys are not sorted. It has the same interface as
+ * the HashMap but it is implemented as an open addressing hashtable that keeps
+ * a separate array of one byte control tags, one for each entry. A full tag
+ * holds 7 bits of the hash of its key so that probing only compares keys whose
+ * tags match. Tags are checked 16 at a time (a group) using SSE2 or NEON when
+ * available, with a portable fallback otherwise.
+ *
+ * Define CMC_SWISSMAP_NO_SIMD before including this file to always use the
+ * portable group functions.
+ */
+
+#ifndef CMC_SWISSMAP_H
+#define CMC_SWISSMAP_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_serial.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_swissmap = "%s at %p { buffer:%p, ctrl:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", deleted:%" PRIuMAX ", load:%lf, cmp:%p, hash:%p }";
+
+/* A removal shrinks a collection once less than this fraction of what it */
+/* can hold without growing is in use. Define it as 0 to never shrink */
+#ifndef CMC_SHRINK_LOW_WATER
+#define CMC_SHRINK_LOW_WATER 0.25
+#endif
+
+#ifndef CMC_IMPL_HASHTABLE_SETUP
+#define CMC_IMPL_HASHTABLE_SETUP
+
+static const size_t cmc_hashtable_primes[] = {53, 97, 191, 383, 769, 1531,
+                                              3067, 6143, 12289, 24571, 49157,
+                                              98299, 196613, 393209, 786431,
+                                              1572869, 3145721, 6291449,
+                                              12582917, 25165813, 50331653,
+                                              100663291, 201326611, 402653189,
+                                              805306357, 1610612741,
+                                              3221225473, 6442450939,
+                                              12884901893, 25769803799,
+                                              51539607551, 103079215111,
+                                              206158430209, 412316860441,
+                                              824633720831, 1649267441651,
+                                              3298534883309, 6597069766657,
+                                              13194139533299, 26388279066623,
+                                              52776558133303, 105553116266489,
+                                              211106232532969, 422212465066001,
+                                              844424930131963,
+                                              1688849860263953,
+                                              3377699720527861,
+                                              6755399441055731,
+                                              13510798882111483,
+                                              27021597764222939,
+                                              54043195528445957,
+                                              108086391056891903,
+                                              216172782113783773,
+                                              432345564227567621,
+                                              864691128455135207,
+                                              1729382256910270481,
+                                              3458764513820540933,
+                                              6917529027641081903,
+                                              13835058055282163729llu};
+
+/* Smallest prime from cmc_hashtable_primes that is greater or equal to */
+/* required, found with a binary search. Used by the default (prime sized) */
+/* hashtables */
+static inline size_t cmc_hashtable_prime_size(size_t required)
+{
+    const size_t count = sizeof(cmc_hashtable_primes) / sizeof(cmc_hashtable_primes[0]);
+
+    if (cmc_hashtable_primes[count - 1] < required)
+        return required;
+
+    size_t low = 0;
+    size_t high = count - 1;
+
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+
+        if (cmc_hashtable_primes[mid] < required)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return cmc_hashtable_primes[low];
+}
+
+/* Prime sized tables reduce a hash to a slot with Lemire's fastmod, which */
+/* replaces the division of the modulo with a few multiplications by a */
+/* multiplier computed once for every capacity. Without 128 bit integers */
+/* the multiplier is not used and the modulo is kept */
+#if defined(__SIZEOF_INT128__) && SIZE_MAX == UINT64_MAX
+__extension__ typedef unsigned __int128 cmc_fastmod;
+
+static inline cmc_fastmod cmc_fastmod_new(size_t divisor)
+{
+    return divisor > 0 ? ~(cmc_fastmod)0 / divisor + 1 : 0;
+}
+
+static inline size_t cmc_fastmod_reduce(size_t value, cmc_fastmod multiplier, size_t divisor)
+{
+    /* The fractional part of value / divisor, multiplied by divisor */
+    cmc_fastmod fraction = multiplier * value;
+    cmc_fastmod low = ((fraction & UINT64_MAX) * divisor) >> 64;
+    cmc_fastmod high = (fraction >> 64) * divisor;
+
+    return (size_t)((low + high) >> 64);
+}
+#else
+typedef size_t cmc_fastmod;
+
+static inline cmc_fastmod cmc_fastmod_new(size_t divisor)
+{
+    (void)divisor;
+    return 0;
+}
+
+static inline size_t cmc_fastmod_reduce(size_t value, cmc_fastmod multiplier, size_t divisor)
+{
+    (void)multiplier;
+    return value % divisor;
+}
+#endif
+
+/* Smallest power of two that is greater or equal to required. Used by the */
+/* hashtables generated with the POW2 variants */
+static inline size_t cmc_hashtable_pow2_size(size_t required)
+{
+    size_t size = 64;
+
+    while (size < required && size <= SIZE_MAX / 2)
+        size <<= 1;
+
+    return size;
+}
+
+/* Power of two hashtables only look at the lower bits of a hash so they are */
+/* first passed through this finalizer (from MurmurHash3) to spread the */
+/* entropy of the upper bits */
+static inline size_t cmc_hashtable_mix(size_t hash)
+{
+    uint64_t h = (uint64_t)hash;
+
+    h ^= h >> 33;
+    h *= UINT64_C(0xff51afd7ed558ccd);
+    h ^= h >> 33;
+    h *= UINT64_C(0xc4ceb9fe1a85ec53);
+    h ^= h >> 33;
+
+    return (size_t)h;
+}
+
+/* Fraction of what a hashtable can hold under which a removal shrinks it. */
+/* Tables grow by a factor of 1 / load, so right after growing one is only */
+/* load full, and the mark is kept under half of that so that a table that */
+/* just grew is not shrunk by the next removals */
+static inline double cmc_hashtable_low_water(double load)
+{
+    return CMC_SHRINK_LOW_WATER < load / 2 ? CMC_SHRINK_LOW_WATER : load / 2;
+}
+
+/* Sizing policies selected by the SIZING parameter of the generators. PRIME */
+/* tables reduce a hash with a modulo and POW2 tables mix it and mask it */
+#define CMC_IMPL_HASHTABLE_PRIME_SIZE(required) cmc_hashtable_prime_size(required)
+#define CMC_IMPL_HASHTABLE_PRIME_HOME(hash, capacity) ((hash) % (capacity))
+#define CMC_IMPL_HASHTABLE_PRIME_WRAP(pos, capacity) ((pos) % (capacity))
+
+#define CMC_IMPL_HASHTABLE_POW2_SIZE(required) cmc_hashtable_pow2_size(required)
+#define CMC_IMPL_HASHTABLE_POW2_HOME(hash, capacity) (cmc_hashtable_mix(hash) & ((capacity)-1))
+#define CMC_IMPL_HASHTABLE_POW2_WRAP(pos, capacity) ((pos) & ((capacity)-1))
+
+/* The same for a table, where PRIME tables use the fastmod multiplier kept */
+/* next to their capacity */
+#define CMC_IMPL_HASHTABLE_PRIME_TABLE_HOME(hash, table) \
+    cmc_fastmod_reduce(hash, (table)->fastmod, (table)->capacity)
+#define CMC_IMPL_HASHTABLE_PRIME_TABLE_WRAP(pos, table) \
+    cmc_fastmod_reduce(pos, (table)->fastmod, (table)->capacity)
+
+#define CMC_IMPL_HASHTABLE_POW2_TABLE_HOME(hash, table) \
+    CMC_IMPL_HASHTABLE_POW2_HOME(hash, (table)->capacity)
+#define CMC_IMPL_HASHTABLE_POW2_TABLE_WRAP(pos, table) \
+    CMC_IMPL_HASHTABLE_POW2_WRAP(pos, (table)->capacity)
+
+/* Hashing policies selected by the HASHING parameter of the generators. */
+/* CACHED tables store the full hash of every key in its entry so that it */
+/* is compared before the keys themselves and reused when resizing */
+#define CMC_IMPL_HASHTABLE_CACHED(...) __VA_ARGS__
+#define CMC_IMPL_HASHTABLE_CACHED_EQUALS(cached, hash) ((cached) == (hash))
+#define CMC_IMPL_HASHTABLE_CACHED_REHASH(cached, computed) (cached)
+
+#define CMC_IMPL_HASHTABLE_UNCACHED(...)
+#define CMC_IMPL_HASHTABLE_UNCACHED_EQUALS(cached, hash) true
+#define CMC_IMPL_HASHTABLE_UNCACHED_REHASH(cached, computed) (computed)
+
+/* Batched lookups hash and prefetch the home slots of this many keys before */
+/* resolving any of their probes */
+#define CMC_IMPL_HASHTABLE_BATCH 16
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CMC_IMPL_HASHTABLE_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define CMC_IMPL_HASHTABLE_PREFETCH(address)
+#endif
+
+#endif /* CMC_IMPL_HASHTABLE_SETUP */
+
+#ifndef CMC_IMPL_HASHTABLE_STATS
+#define CMC_IMPL_HASHTABLE_STATS
+
+/* Amount of buckets of the histogram of distances of cmc_hashtable_stats. */
+/* The last bucket also counts every entry that is further away */
+#ifndef CMC_HASHTABLE_STATS_BUCKETS
+#define CMC_HASHTABLE_STATS_BUCKETS 16
+#endif
+
+/* Health of a hashtable, as reported by the stats function of every */
+/* hashtable collection */
+struct cmc_hashtable_stats
+{
+    /* Amount of slots (or buckets) of the table */
+    size_t capacity;
+
+    /* Amount of entries in the table */
+    size_t count;
+
+    /* Slots that are marked as deleted and still take part in probes */
+    size_t tombstones;
+
+    /* Current load, count / capacity */
+    double load;
+
+    /* Greatest distance of an entry to its original position */
+    size_t max_dist;
+
+    /* Average distance of an entry to its original position */
+    double mean_dist;
+
+    /* Amount of entries at each distance to their original position */
+    size_t histogram[CMC_HASHTABLE_STATS_BUCKETS];
+
+    /* Bytes allocated by the collection, not counting what K and V own */
+    size_t bytes;
+
+    /* Lookups done since the table was created */
+    size_t lookups;
+
+    /* Entries compared by these lookups */
+    size_t probes;
+};
+
+/* Adds the distance of an entry to stats. Until cmc_hashtable_stats_end() */
+/* is called mean_dist holds the sum of all distances */
+static inline void cmc_hashtable_stats_add(struct cmc_hashtable_stats *stats, size_t dist)
+{
+    if (dist < CMC_HASHTABLE_STATS_BUCKETS)
+        stats->histogram[dist]++;
+    else
+        stats->histogram[CMC_HASHTABLE_STATS_BUCKETS - 1]++;
+
+    if (dist > stats->max_dist)
+        stats->max_dist = dist;
+
+    stats->mean_dist += (double)dist;
+}
+
+/* Adds the finished stats of another table to stats, for collections made */
+/* of more than one hashtable */
+static inline void cmc_hashtable_stats_merge(struct cmc_hashtable_stats *stats,
+                                             struct cmc_hashtable_stats *other)
+{
+    size_t entries = 0;
+
+    for (size_t i = 0; i < CMC_HASHTABLE_STATS_BUCKETS; i++)
+    {
+        stats->histogram[i] += other->histogram[i];
+        entries += other->histogram[i];
+    }
+
+    if (other->max_dist > stats->max_dist)
+        stats->max_dist = other->max_dist;
+
+    stats->mean_dist += other->mean_dist * (double)entries;
+    stats->capacity += other->capacity;
+    stats->count += other->count;
+    stats->tombstones += other->tombstones;
+    stats->bytes += other->bytes;
+    stats->lookups += other->lookups;
+    stats->probes += other->probes;
+}
+
+/* Turns the sum of distances of stats into their mean and computes the load */
+static inline void cmc_hashtable_stats_end(struct cmc_hashtable_stats *stats)
+{
+    size_t entries = 0;
+
+    for (size_t i = 0; i < CMC_HASHTABLE_STATS_BUCKETS; i++)
+        entries += stats->histogram[i];
+
+    if (entries > 0)
+        stats->mean_dist /= (double)entries;
+
+    if (stats->capacity > 0)
+        stats->load = (double)stats->count / (double)stats->capacity;
+}
+
+/* Defining CMC_HASHTABLE_PROBE_STATS before including any hashtable makes */
+/* every table count its lookups and the entries they compare, reported as */
+/* lookups and probes by cmc_hashtable_stats. The counters are not atomic */
+/* so lookups that run concurrently without a lock are counted loosely */
+#ifdef CMC_HASHTABLE_PROBE_STATS
+#define CMC_IMPL_HASHTABLE_PROBE_FIELDS size_t lookups; size_t probes;
+#define CMC_IMPL_HASHTABLE_PROBE_RESET(table) ((table)->lookups = 0, (table)->probes = 0)
+#define CMC_IMPL_HASHTABLE_PROBE_LOOKUP(table) ((table)->lookups++)
+#define CMC_IMPL_HASHTABLE_PROBE_SLOT(table) ((table)->probes++)
+#define CMC_IMPL_HASHTABLE_PROBE_ADD(to, from) \
+    ((to)->lookups += (from)->lookups, (to)->probes += (from)->probes)
+#else
+#define CMC_IMPL_HASHTABLE_PROBE_FIELDS
+#define CMC_IMPL_HASHTABLE_PROBE_RESET(table) ((void)0)
+#define CMC_IMPL_HASHTABLE_PROBE_LOOKUP(table) ((void)0)
+#define CMC_IMPL_HASHTABLE_PROBE_SLOT(table) ((void)0)
+#define CMC_IMPL_HASHTABLE_PROBE_ADD(to, from) ((void)0)
+#endif
+
+#endif /* CMC_IMPL_HASHTABLE_STATS */
+
+#ifndef CMC_IMPL_SWISSMAP_SETUP
+#define CMC_IMPL_SWISSMAP_SETUP
+
+#if !defined(CMC_SWISSMAP_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define CMC_SWISS_SSE2
+#include <emmintrin.h>
+#elif !defined(CMC_SWISSMAP_NO_SIMD) && defined(__ARM_NEON) && defined(__aarch64__)
+#define CMC_SWISS_NEON
+#include <arm_neon.h>
+#endif
+
+/* Amount of control tags that are checked at once */
+#define CMC_SWISS_GROUP 16
+
+/* Control tags of slots that are not filled. Filled slots have a tag in the */
+/* range [0, 127] so the sign bit alone tells if a slot is free */
+#define CMC_SWISS_EMPTY ((int8_t)-128)
+#define CMC_SWISS_DELETED ((int8_t)-2)
+
+/* The upper bits of a hash select the first group to be probed and the */
+/* lower 7 bits are stored in the control tag */
+#define CMC_SWISS_H1(hash) ((hash) >> 7)
+#define CMC_SWISS_H2(hash) ((int8_t)((hash)&0x7F))
+
+/* Position of the lowest bit set of a non-zero group mask */
+static inline size_t cmc_swiss_lowest(uint32_t mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_ctz(mask);
+#else
+    size_t i = 0;
+
+    while (!(mask & 1))
+    {
+        mask >>= 1;
+        i++;
+    }
+
+    return i;
+#endif
+}
+
+/* Amount of zeros above the highest bit set of a non-zero group mask */
+static inline size_t cmc_swiss_leading(uint32_t mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_clz(mask) - (32 - CMC_SWISS_GROUP);
+#else
+    size_t i = 0;
+
+    while (!(mask & (UINT32_C(1) << (CMC_SWISS_GROUP - 1 - i))))
+        i++;
+
+    return i;
+#endif
+}
+
+#if defined(CMC_SWISS_NEON)
+/* NEON has no movemask so each byte of the comparison result is reduced to */
+/* its bit of the group mask by adding up each half of the vector */
+static inline uint32_t cmc_swiss_neon_mask(uint8x16_t result)
+{
+    static const uint8_t bits[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                     1, 2, 4, 8, 16, 32, 64, 128};
+
+    uint8x16_t masked = vandq_u8(result, vld1q_u8(bits));
+
+    return (uint32_t)vaddv_u8(vget_low_u8(masked)) |
+           ((uint32_t)vaddv_u8(vget_high_u8(masked)) << 8);
+}
+#endif
+
+/* Bit i of the result is set if the control tag i of group equals tag */
+static inline uint32_t cmc_swiss_match(const int8_t *group, int8_t tag)
+{
+#if defined(CMC_SWISS_SSE2)
+    __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(tag)));
+#elif defined(CMC_SWISS_NEON)
+    return cmc_swiss_neon_mask(vceqq_s8(vld1q_s8(group), vdupq_n_s8(tag)));
+#else
+    uint32_t mask = 0;
+
+    for (size_t i = 0; i < CMC_SWISS_GROUP; i++)
+    {
+        if (group[i] == tag)
+            mask |= UINT32_C(1) << i;
+    }
+
+    return mask;
+#endif
+}
+
+/* Bit i of the result is set if the slot i of group is empty or deleted */
+static inline uint32_t cmc_swiss_match_free(const int8_t *group)
+{
+#if defined(CMC_SWISS_SSE2)
+    return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+#elif defined(CMC_SWISS_NEON)
+    return cmc_swiss_neon_mask(vcltzq_s8(vld1q_s8(group)));
+#else
+    uint32_t mask = 0;
+
+    for (size_t i = 0; i < CMC_SWISS_GROUP; i++)
+    {
+        if (group[i] < 0)
+            mask |= UINT32_C(1) << i;
+    }
+
+    return mask;
+#endif
+}
+
+#endif /* CMC_IMPL_SWISSMAP_SETUP */
+
+#define CMC_GENERATE_SWISSMAP(PFX, SNAME, K, V)    \
+    CMC_GENERATE_SWISSMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_SWISSMAP_SOURCE(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_SWISSMAP_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_SWISSMAP_HEADER(PFX, SNAME, K, V)
+
+#define CMC_WRAPGEN_SWISSMAP_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_SWISSMAP_SOURCE(PFX, SNAME, K, V)
+
+/* Same as CMC_GENERATE_SWISSMAP but keys are compared and hashed by */
+/* calling CMP and HASH directly, so the compiler can inline them. The */
+/* functions given to new are still stored but only used by copy_of and */
+/* to_string */
+#define CMC_GENERATE_SWISSMAP_EX(PFX, SNAME, K, V, CMP, HASH) \
+    CMC_GENERATE_SWISSMAP_HEADER(PFX, SNAME, K, V)            \
+    CMC_GENERATE_SWISSMAP_EX_SOURCE(PFX, SNAME, K, V, CMP, HASH)
+
+#define CMC_GENERATE_SWISSMAP_SOURCE(PFX, SNAME, K, V) \
+    CMC_IMPL_SWISSMAP_SOURCE(PFX, SNAME, K, V, _map_->cmp, _map_->hash)
+
+#define CMC_GENERATE_SWISSMAP_EX_SOURCE(PFX, SNAME, K, V, CMP, HASH) \
+    CMC_IMPL_SWISSMAP_SOURCE(PFX, SNAME, K, V, CMP, HASH)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_SWISSMAP_HEADER(PFX, SNAME, K, V)                          \
+                                                                                \
+    /* SwissMap Structure */                                                    \
+    struct SNAME                                                                \
+    {                                                                           \
+        /* Array of Entries */                                                  \
+        struct SNAME##_entry *buffer;                                           \
+                                                                                \
+        /* Array of control tags, one for each entry, followed by a copy of */  \
+        /* the first group so a group can be read starting at any slot */       \
+        int8_t *ctrl;                                                           \
+                                                                                \
+        /* Current array capacity (always a power of two) */                    \
+        size_t capacity;                                                        \
+                                                                                \
+        /* Current amount of keys */                                            \
+        size_t count;                                                           \
+                                                                                \
+        /* Current amount of slots marked as deleted */                         \
+        size_t deleted;                                                         \
+                                                                                \
+        /* Load factor in range (0.0, 1.0) */                                   \
+        double load;                                                            \
+                                                                                \
+        /* Key comparison function */                                           \
+        int (*cmp)(K, K);                                                       \
+                                                                                \
+        /* Key hash function */                                                 \
+        size_t (*hash)(K);                                                      \
+                                                                                \
+        /* Lookup counters, only present with CMC_HASHTABLE_PROBE_STATS */      \
+        CMC_IMPL_HASHTABLE_PROBE_FIELDS                                         \
+                                                                                \
+        /* Function that returns an iterator to the start of the swissmap */    \
+        struct SNAME##_iter (*it_start)(struct SNAME *);                        \
+                                                                                \
+        /* Function that returns an iterator to the end of the swissmap */      \
+        struct SNAME##_iter (*it_end)(struct SNAME *);                          \
+                                                                                \
+        /* Custom allocation functions */                                       \
+        struct cmc_alloc_node *alloc;                                           \
+    };                                                                          \
+                                                                                \
+    /* SwissMap Entry */                                                        \
+    struct SNAME##_entry                                                        \
+    {                                                                           \
+        /* Entry Key */                                                         \
+        K key;                                                                  \
+                                                                                \
+        /* Entry Value */                                                       \
+        V value;                                                                \
+    };                                                                          \
+                                                                                \
+    /* SwissMap Iterator */                                                     \
+    struct SNAME##_iter                                                         \
+    {                                                                           \
+        /* Target swissmap */                                                   \
+        struct SNAME *target;                                                   \
+                                                                                \
+        /* Cursor's position (index) */                                         \
+        size_t cursor;                                                          \
+                                                                                \
+        /* Keeps track of relative index to the iteration of elements */        \
+        size_t index;                                                           \
+                                                                                \
+        /* The index of the first element */                                    \
+        size_t first;                                                           \
+                                                                                \
+        /* The index of the last element */                                     \
+        size_t last;                                                            \
+                                                                                \
+        /* If the iterator has reached the start of the iteration */            \
+        bool start;                                                             \
+                                                                                \
+        /* If the iterator has reached the end of the iteration */              \
+        bool end;                                                               \
+    };                                                                          \
+                                                                                \
+    /* Collection Functions */                                                  \
+    /* Collection Allocation and Deallocation */                                \
+    struct SNAME *PFX##_new(size_t capacity, double load, int (*compare)(K, K), \
+                            size_t (*hash)(K));                                 \
+    struct SNAME *PFX##_new_custom(size_t capacity, double load,                \
+                                   int (*compare)(K, K), size_t (*hash)(K),     \
+                                   struct cmc_alloc_node *alloc);               \
+    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V));           \
+    void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V));            \
+    /* Collection Input and Output */                                           \
+    bool PFX##_insert(struct SNAME *_map_, K key, V value);                     \
+    bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value);   \
+    bool PFX##_remove(struct SNAME *_map_, K key, V *out_value);                \
+    /* Element Access */                                                        \
+    bool PFX##_max(struct SNAME *_map_, K *key, V *value);                      \
+    bool PFX##_min(struct SNAME *_map_, K *key, V *value);                      \
+    V PFX##_get(struct SNAME *_map_, K key);                                    \
+    V *PFX##_get_ref(struct SNAME *_map_, K key);                               \
+    /* Collection State */                                                      \
+    bool PFX##_contains(struct SNAME *_map_, K key);                            \
+    CMC_PURE bool PFX##_empty(struct SNAME *_map_);                             \
+    bool PFX##_full(struct SNAME *_map_);                                       \
+    CMC_PURE size_t PFX##_count(struct SNAME *_map_);                           \
+    size_t PFX##_memory_usage(struct SNAME *_map_);                             \
+    size_t PFX##_capacity(struct SNAME *_map_);                                 \
+    double PFX##_load(struct SNAME *_map_);                                     \
+    void PFX##_stats(struct SNAME *_map_, struct cmc_hashtable_stats *out);     \
+    /* Collection Utility */                                                    \
+    bool PFX##_resize(struct SNAME *_map_, size_t capacity);                    \
+    bool PFX##_shrink_to_fit(struct SNAME *_map_);                              \
+    struct SNAME *PFX##_copy_of(struct SNAME *_map_, K (*key_copy_func)(K),     \
+                                V (*value_copy_func)(V));                       \
+    bool PFX##_equals(struct SNAME *_map1_, struct SNAME *_map2_,               \
+                      int (*value_comparator)(V, V));                           \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_);                     \
+    bool PFX##_to_string_full(struct SNAME *_map_,                              \
+                              struct cmc_string_builder *builder,               \
+                              const char *elem_fmt);                            \
+    bool PFX##_write(struct SNAME *_map_, FILE *file,                           \
+                     void (*fmt)(FILE *, K, V));                                \
+    bool PFX##_write_fd(struct SNAME *_map_, int fd,                            \
+                        void (*fmt)(struct cmc_dump *, K, V));                  \
+    /* Collection Serialization */                                              \
+    bool PFX##_save(struct SNAME *_map_, FILE *file,                            \
+                    bool (*key_writer)(K, FILE *),                              \
+                    bool (*value_writer)(V, FILE *));                           \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(K, K),               \
+                                size_t (*hash)(K),                              \
+                                bool (*key_reader)(K *, FILE *),                \
+                                bool (*value_reader)(V *, FILE *));             \
+                                                                                \
+                                                                                \
+    /* Iterator Functions */                                                    \
+    /* Iterator Allocation and Deallocation */                                  \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target);                  \
+    void PFX##_iter_free(struct SNAME##_iter *iter);                            \
+    /* Iterator Initialization */                                               \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);      \
+    /* Iterator State */                                                        \
+    bool PFX##_iter_start(struct SNAME##_iter *iter);                           \
+    bool PFX##_iter_end(struct SNAME##_iter *iter);                             \
+    /* Iterator Movement */                                                     \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter);                        \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter);                          \
+    bool PFX##_iter_next(struct SNAME##_iter *iter);                            \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter);                            \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps);           \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps);            \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index);             \
+    /* Iterator Access */                                                       \
+    K PFX##_iter_key(struct SNAME##_iter *iter);                                \
+    V PFX##_iter_value(struct SNAME##_iter *iter);                              \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter);                            \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter);                         \
+                                                                                \
+/* SOURCE ********************************************************************/
+#define CMC_IMPL_SWISSMAP_SOURCE(PFX, SNAME, K, V, CMP, HASH)                                            \
+                                                                                                         \
+    /* Implementation Detail Functions */                                                                \
+    static inline int PFX##_impl_cmp(struct SNAME *_map_, K a, K b);                                     \
+    static inline size_t PFX##_impl_hash(struct SNAME *_map_, K key);                                    \
+    static struct SNAME##_entry *PFX##_impl_get_entry(struct SNAME *_map_, K key);                       \
+    static size_t PFX##_impl_find_slot(struct SNAME *_map_, size_t hash);                                \
+    static void PFX##_impl_set_ctrl(struct SNAME *_map_, size_t index, int8_t tag);                      \
+    static bool PFX##_impl_rehash(struct SNAME *_map_, size_t capacity);                                 \
+    static void PFX##_impl_low_water(struct SNAME *_map_);                                               \
+    static bool PFX##_impl_shrink(struct SNAME *_map_, size_t required);                                 \
+    static struct SNAME *PFX##_impl_load_layout(FILE *file, int (*compare)(K, K),                        \
+                                                size_t (*hash)(K),                                       \
+                                                struct cmc_serial_header *header);                       \
+                                                                                                         \
+    static size_t PFX##_impl_calculate_size(size_t required);                                            \
+    static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_map_);                                 \
+    static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_map_);                                   \
+                                                                                                         \
+    struct SNAME *PFX##_new(size_t capacity, double load, int (*compare)(K, K),                          \
+                            size_t (*hash)(K))                                                           \
+    {                                                                                                    \
+        return PFX##_new_custom(capacity, load, compare, hash, NULL);                                    \
+    }                                                                                                    \
+                                                                                                         \
+    struct SNAME *PFX##_new_custom(size_t capacity, double load, int (*compare)(K, K),                   \
+                                   size_t (*hash)(K), struct cmc_alloc_node *alloc)                      \
+    {                                                                                                    \
+        if (!alloc)                                                                                      \
+            alloc = &cmc_alloc_node_default;                                                             \
+                                                                                                         \
+        if (capacity == 0 || load <= 0 || load >= 1)                                                     \
+            return NULL;                                                                                 \
+                                                                                                         \
+        /* Prevent integer overflow */                                                                   \
+        if (capacity >= UINTMAX_MAX * load)                                                              \
+            return NULL;                                                                                 \
+                                                                                                         \
+        size_t real_capacity = PFX##_impl_calculate_size(capacity / load);                               \
+                                                                                                         \
+        struct SNAME *_map_ = alloc->malloc(sizeof(struct SNAME));                                       \
+                                                                                                         \
+        if (CMC_UNLIKELY(!_map_))                                                                        \
+            return NULL;                                                                                 \
+                                                                                                         \
+        _map_->alloc = alloc;                                                                            \
+                                                                                                         \
+        _map_->buffer = alloc->calloc(real_capacity, sizeof(struct SNAME##_entry));                      \
+                                                                                                         \
+        if (CMC_UNLIKELY(!_map_->buffer))                                                                \
+        {                                                                                                \
+            alloc->free(_map_);                                                                          \
+            return NULL;                                                                                 \
+        }                                                                                                \
+                                                                                                         \
+        _map_->ctrl = alloc->malloc(real_capacity + CMC_SWISS_GROUP);                                    \
+                                                                                                         \
+        if (CMC_UNLIKELY(!_map_->ctrl))                                                                  \
+        {                                                                                                \
+            alloc->free(_map_->buffer);                                                                  \
+            alloc->free(_map_);                                                                          \
+            return NULL;                                                                                 \
+        }                                                                                                \
+                                                                                                         \
+        memset(_map_->ctrl, CMC_SWISS_EMPTY, real_capacity + CMC_SWISS_GROUP);                           \
+                                                                                                         \
+        _map_->count = 0;                                                                                \
+        _map_->deleted = 0;                                                                              \
+        _map_->capacity = real_capacity;                                                                 \
+        _map_->load = load;                                                                              \
+        _map_->cmp = compare;                                                                            \
+        _map_->hash = hash;                                                                              \
+                                                                                                         \
+        CMC_IMPL_HASHTABLE_PROBE_RESET(_map_);                                                           \
+                                                                                                         \
+        _map_->it_start = PFX##_impl_it_start;                                                           \
+        _map_->it_end = PFX##_impl_it_end;                                                               \
+                                                                                                         \
+        return _map_;                                                                                    \
+    }                                                                                                    \
+                                                                                                         \
+    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V))                                     \
+    {                                                                                                    \
+        if (deallocator)                                                                                 \
+        {                                                                                                \
+            for (size_t i = 0; i < _map_->capacity; i++)                                                 \
+            {                                                                                            \
+                if (_map_->ctrl[i] >= 0)                                                                 \
+                {                                                                                        \
+                    struct SNAME##_entry *entry = &(_map_->buffer[i]);                                   \
+                                                                                                         \
+                    deallocator(entry->key, entry->value);                                               \
+                }                                                                                        \
+            }                                                                                            \
+        }                                                                                                \
+                                                                                                         \
+        memset(_map_->buffer, 0, sizeof(struct SNAME##_entry) * _map_->capacity);                        \
+        memset(_map_->ctrl, CMC_SWISS_EMPTY, _map_->capacity + CMC_SWISS_GROUP);                         \
+                                                                                                         \
+        _map_->count = 0;                                                                                \
+        _map_->deleted = 0;                                                                              \
+    }                                                                                                    \
+                                                                                                         \
+    void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V))                                      \
+    {                                                                                                    \
+        if (deallocator)                                                                                 \
+        {                                                                                                \
+            for (size_t i = 0; i < _map_->capacity; i++)                                                 \
+            {                                                                                            \
+                if (_map_->ctrl[i] >= 0)                                                                 \
+                {                                                                                        \
+                    struct SNAME##_entry *entry = &(_map_->buffer[i]);                                   \
+                                                                                                         \
+                    deallocator(entry->key, entry->value);                                               \
+                }                                                                                        \
+            }                                                                                            \
+        }                                                                                                \
+                                                                                                         \
+        _map_->alloc->free(_map_->buffer);                                                               \
+        _map_->alloc->free(_map_->ctrl);                                                                 \
+        _map_->alloc->free(_map_);                                                                       \
+    }                                                                                                    \
+                                                                                                         \
+    bool PFX##_insert(struct SNAME *_map_, K key, V value)                                               \
+    {                                                                                                    \
+        if (PFX##_impl_get_entry(_map_, key) != NULL)                                                    \
+            return false;                                                                                \
+                                                                                                         \
+        /* Lookups rely on the table always having at least one empty slot */                            \
+        if (PFX##_full(_map_) || _map_->count + 1 >= _map_->capacity)                                    \
+        {                                                                                                \
+            if (_map_->capacity > SIZE_MAX / 2)                                                          \
+                return false;                                                                            \
+                                                                                                         \
+            if (!PFX##_impl_rehash(_map_, _map_->capacity * 2))                                          \
+                return false;                                                                            \
+        }                                                                                                \
+        else if ((double)_map_->capacity * _map_->load <= (double)(_map_->count + _map_->deleted) ||     \
+                 _map_->count + _map_->deleted + 1 >= _map_->capacity)                                   \
+        {                                                                                                \
+            /* Too many deleted slots, clean them up keeping the capacity */                             \
+            if (!PFX##_impl_rehash(_map_, _map_->capacity))                                              \
+                return false;                                                                            \
+        }                                                                                                \
+                                                                                                         \
+        size_t hash = cmc_hashtable_mix(PFX##_impl_hash(_map_, key));                                    \
+        size_t pos = PFX##_impl_find_slot(_map_, hash);                                                  \
+                                                                                                         \
+        if (_map_->ctrl[pos] == CMC_SWISS_DELETED)                                                       \
+            _map_->deleted--;                                                                            \
+                                                                                                         \
+        PFX##_impl_set_ctrl(_map_, pos, CMC_SWISS_H2(hash));                                             \
+                                                                                                         \
+        _map_->buffer[pos].key = key;                                                                    \
+        _map_->buffer[pos].value = value;                                                                \
+                                                                                                         \
+        _map_->count++;                                                                                  \
+                                                                                                         \
+        return true;                                                                                     \
+    }                                                                                                    \
+                                                                                                         \
+    bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value)                             \
+    {                                                                                                    \
+        struct SNAME##_entry *entry = PFX##_impl_get_entry(_map_, key);                                  \
+                                                                                                         \
+        if (!entry)                                                                                      \
+            return false;                                                                                \
+                                                                                                         \
+        if (old_value)                                                                                   \
+            *old_value = entry->value;                                                                   \
+                                                                                                         \
+        entry->value = new_value;                                                                        \
+                                                                                                         \
+        return true;                                                                                     \
+    }                                                                                                    \
+                                                                                                         \
+    bool PFX##_remove(struct SNAME *_map_, K key, V *out_value)                                          \
+    {                                                                                                    \
+        struct SNAME##_entry *result = PFX##_impl_get_entry(_map_, key);                                 \
+                                                                                                         \
+        if (result == NULL)                                                                              \
+            return false;                                                                                \
+                                                                                                         \
+        if (out_value)                                                                                   \
+            *out_value = result->value;                                                                  \
+                                                                                                         \
+        size_t index = (size_t)(result - _map_->buffer);                                                 \
+        size_t index_before = (index - CMC_SWISS_GROUP) & (_map_->capacity - 1);                         \
+                                                                                                         \
+        uint32_t empty_after = cmc_swiss_match(&(_map_->ctrl[index]), CMC_SWISS_EMPTY);                  \
+        uint32_t empty_before = cmc_swiss_match(&(_map_->ctrl[index_before]), CMC_SWISS_EMPTY);          \
+                                                                                                         \
+        /* If every group containing this slot also has an empty slot, no */                             \
+        /* probe sequence ever went past it and it can be emptied again */                               \
+        if (empty_before && empty_after &&                                                               \
+            cmc_swiss_lowest(empty_after) + cmc_swiss_leading(empty_before) < CMC_SWISS_GROUP)           \
+        {                                                                                                \
+            PFX##_impl_set_ctrl(_map_, index, CMC_SWISS_EMPTY);                                          \
+        }                                                                                                \
+        else                                                                                             \
+        {                                                                                                \
+            PFX##_impl_set_ctrl(_map_, index, CMC_SWISS_DELETED);                                        \
+            _map_->deleted++;                                                                            \
+        }                                                                                                \
+                                                                                                         \
+        result->key = (K){0};                                                                            \
+        result->value = (V){0};                                                                          \
+                                                                                                         \
+        _map_->count--;                                                                                  \
+                                                                                                         \
+        PFX##_impl_low_water(_map_);                                                                     \
+                                                                                                         \
+        return true;                                                                                     \
+    }                                                                                                    \
+                                                                                                         \
+    bool PFX##_max(struct SNAME *_map_, K *key, V *value)                                                \
+    {                                                                                                    \
+        if (PFX##_empty(_map_))                                                                          \
+            return false;                                                                                \
+                                                                                                         \
+        struct SNAME##_iter iter;                                                                        \
+        PFX##_iter_init(&iter, _map_);                                                                   \
+                                                                                                         \
+        K max_key = PFX##_iter_key(&iter);                                                               \
+        V max_val = PFX##_iter_value(&iter);                                                             \
+                                                                                                         \
+        PFX##_iter_next(&iter);                                                                          \
+                                                                                                         \
+        for (; !PFX##_iter_end(&iter); PFX##_iter_next(&iter))                                           \
+        {                                                                                                \
+            K iter_key = PFX##_iter_key(&iter);                                                          \
+            V iter_val = PFX##_iter_value(&iter);                                                        \
+                                                                                                         \
+            if (PFX##_impl_cmp(_map_, iter_key, max_key) > 0)                                            \
+            {                                                                                            \
+                max_key = iter_key;                                                                      \
+                max_val = iter_val;                                                                      \
+            }                                                                                            \
+        }                                                                                                \
+                                                                                                         \
+        if (key)                                                                                         \
+            *key = max_key;                                                                              \
+        if (value)                                                                                       \
+            *value = max_val;                                                                            \
+                                                                                                         \
+        return true;                                                                                     \
+    }                                                                                                    \
+                                                                                                         \
+    bool PFX##_min(struct SNAME *_map_, K *key, V *value)                                                \
+    {                                                                                                    \
+        if (PFX##_empty(_map_))                                                                          \
+            return false;                                                                                \
+                                                                                                         \
+        struct SNAME##_iter iter;                                                                        \
+        PFX##_iter_init(&iter, _map_);                                                                   \
+                                                                                                         \
+        K min_key = PFX##_iter_key(&iter);                                                               \
+        V min_val = PFX##_iter_value(&iter);                                                             \
+                                                                                                         \
+        PFX##_iter_next(&iter);                                                                          \
+                                                                                                         \
+        for (; !PFX##_iter_end(&iter); PFX##_iter_next(&iter))                                           \
+        {                                                                                                \
+            K iter_key = PFX##_iter_key(&iter);                                                          \
+            V iter_val = PFX##_iter_value(&iter);                                                        \
+                                                                                                         \
+            if (PFX##_impl_cmp(_map_, iter_key, min_key) < 0)                                            \
+            {                                                                                            \
+                min_key = iter_key;                                                                      \
+                min_val = iter_val;                                                                      \
+            }                                                                                            \
+        }                                                                                                \
+                                                                                                         \
+        if (key)                                                                                         \
+            *key = min_key;                                                                              \
+        if (value)                                                                                       \
+            *value = min_val;                                                                            \
+                                                                                                         \
+        return true;                                                                                     \
+    }                                                                                                    \
+                                                                                                         \
+    V PFX##_get(struct SNAME *_map_, K key)                                                              \
+    {                                                                                                    \
+        struct SNAME##_entry *entry = PFX##_impl_get_entry(_map_, key);                                  \
+                                                                                                         \
+        if (!entry)                                                                                      \
+            return (V){0};                                                                               \
+                                                                                                         \
+        return entry->value;                                                                             \
+    }                                                                                                    \
+                                                                                                         \
+    V *PFX##_get_ref(struct SNAME *_map_, K key)                                                         \
+    {                                                                                                    \
+        struct SNAME##_entry *entry = PFX##_impl_get_entry(_map_, key);                                  \
+                                                                                                         \
+        if (!entry)                                                                                      \
+            return NULL;                                                                                 \
+                                                                                                         \
+        return &(entry->value);                                                                          \
+    }                                                                                                    \
+                                                                                                         \
+    bool PFX##_contains(struct SNAME *_map_, K key)                                                      \
+    {                                                                                                    \
+        return PFX##_impl_get_entry(_map_, key) != NULL;                                                 \
+    }                                                                                                    \
+                                                                                                         \
+    bool PFX##_empty(struct SNAME *_map_)                                                                \
+    {                                                                                                    \
+        return _map_->count == 0;                                                                        \
+    }                                                                                                    \
+                                                                                                         \
+    bool PFX##_full(struct SNAME *_map_)                                                                 \
+    {                                                                                                    \
+        return (double)PFX##_capacity(_map_) * PFX##_load(_map_) <= (double)PFX##_count(_map_);          \
+    }                                                                                                    \
+                                                                                                         \
+    size_t PFX##_count(struct SNAME *_map_)                                                              \
+    {                                                                                                    \
+        return _map_->count;                                                                             \
+    }                                                                                                    \
+                                                                                                         \
+    size_t PFX##_memory_usage(struct SNAME *_map_)                                                       \
+    {                                                                                                    \
+        return sizeof(struct SNAME) + sizeof(struct SNAME##_entry) * _map_->capacity +                   \
+               _map_->capacity + CMC_SWISS_GROUP;                                                        \
+    }                                                                                                    \
+                                                                                                         \
+    size_t PFX##_capacity(struct SNAME *_map_)                                                           \
+    {                                                                                                    \
+        return _map_->capacity;                                                                          \
+    }                                                                                                    \
+                                                                                                         \
+    double PFX##_load(struct SNAME *_map_)                                                               \
+    {                                                                                                    \
+        return _map_->load;                                                                              \
+    }                                                                                                    \
+                                                                                                         \
+    void PFX##_stats(struct SNAME *_map_, struct cmc_hashtable_stats *out)                               \
+    {                                                                                                    \
+        memset(out, 0, sizeof(struct cmc_hashtable_stats));                                              \
+                                                                                                         \
+        out->capacity = _map_->capacity;                                                                 \
+        out->count = _map_->count;                                                                       \
+        out->tombstones = _map_->deleted;                                                                \
+        out->bytes = sizeof(struct SNAME) + sizeof(struct SNAME##_entry) * _map_->capacity +             \
+                     _map_->capacity + CMC_SWISS_GROUP;                                                  \
+                                                                                                         \
+        size_t mask = _map_->capacity - 1;                                                               \
+                                                                                                         \
+        for (size_t i = 0; i < _map_->capacity; i++)                                                     \
+        {                                                                                                \
+            if (_map_->ctrl[i] < 0)                                                                      \
+                continue;                                                                                \
+                                                                                                         \
+            /* Distances are counted in groups, following the same */                                    \
+            /* triangular probing as a lookup of this key */                                             \
+            size_t hash = cmc_hashtable_mix(PFX##_impl_hash(_map_, _map_->buffer[i].key));               \
+            size_t pos = CMC_SWISS_H1(hash) & mask;                                                      \
+            size_t stride = 0;                                                                           \
+            size_t dist = 0;                                                                             \
+                                                                                                         \
+            while (((i - pos) & mask) >= CMC_SWISS_GROUP)                                                \
+            {                                                                                            \
+                stride += CMC_SWISS_GROUP;                                                               \
+                pos = (pos + stride) & mask;                                                             \
+                dist++;                                                                                  \
+            }                                                                                            \
+                                                                                                         \
+            cmc_hashtable_stats_add(out, dist);                                                          \
+        }                                                                                                \
+                                                                                                         \
+        CMC_IMPL_HASHTABLE_PROBE_ADD(out, _map_);                                                        \
+                                                                                                         \
+        cmc_hashtable_stats_end(out);                                                                    \
+    }                                                                                                    \
+                                                                                                         \
+    bool PFX##_resize(struct SNAME *_map_, size_t capacity)                                              \
+    {                                                                                                    \
+        if (PFX##_capacity(_map_) == capacity)                                                           \
+            return true;                                                                                 \
+                                                                                                         \
+        if (PFX##_capacity(_map_) > capacity / PFX##_load(_map_))                                        \
+            return true;                                                                                 \
+                                                                                                         \
+        /* Prevent integer overflow */                                                                   \
+        if (capacity >= UINTMAX_MAX * PFX##_load(_map_))                                                 \
+            return false;                                                                                \
+                                                                                                         \
+        return PFX##_impl_rehash(_map_, PFX##_impl_calculate_size(capacity / PFX##_load(_map_)));        \
+    }                                                                                                    \
+                                                                                                         \
+    bool PFX##_shrink_to_fit(struct SNAME *_map_)                                                        \
+    {                                                                                                    \
+        return PFX##_impl_shrink(_map_, PFX##_count(_map_));                                             \
+    }                                                                                                    \
+                                                                                                         \
+    struct SNAME *PFX##_copy_of(struct SNAME *_map_, K (*key_copy_func)(K),                              \
+                                V (*value_copy_func)(V))                                                 \
+    {                                                                                                    \
+        struct SNAME *result = _map_->alloc->malloc(sizeof(struct SNAME));                               \
+                                                                                                         \
+        if (CMC_UNLIKELY(!result))                                                                       \
+            return NULL;                                                                                 \
+                                                                                                         \
+        memcpy(result, _map_, sizeof(struct SNAME));                                                     \
+                                                                                                         \
+        result->buffer = _map_->alloc->malloc(sizeof(struct SNAME##_entry) * _map_->capacity);           \
+        result->ctrl = _map_->alloc->malloc(_map_->capacity + CMC_SWISS_GROUP);                          \
+                                                                                                         \
+        if (!result->buffer || !result->ctrl)                                                            \
+        {                                                                                                \
+            _map_->alloc->free(result->buffer);                                                          \
+            _map_->alloc->free(result->ctrl);                                                            \
+            _map_->alloc->free(result);                                                                  \
+            return NULL;                                                                                 \
+        }                                                                                                \
+                                                                                                         \
+        memcpy(result->buffer, _map_->buffer, sizeof(struct SNAME##_entry) * _map_->capacity);           \
+        memcpy(result->ctrl, _map_->ctrl, _map_->capacity + CMC_SWISS_GROUP);                            \
+                                                                                                         \
+        if (key_copy_func || value_copy_func)                                                            \
+        {                                                                                                \
+            for (size_t i = 0; i < _map_->capacity; i++)                                                 \
+            {                                                                                            \
+                if (_map_->ctrl[i] >= 0)                                                                 \
+                {                                                                                        \
+                    struct SNAME##_entry *target = &(result->buffer[i]);                                 \
+                                                                                                         \
+                    if (key_copy_func)                                                                   \
+                        target->key = key_copy_func(target->key);                                        \
+                                                                                                         \
+                    if (value_copy_func)                                                                 \
+                        target->value = value_copy_func(target->value);                                  \
+                }                                                                                        \
+            }                                                                                            \
+        }                                                                                                \
+                                                                                                         \
+        return result;                                                                                   \
+    }                                                                                                    \
+                                                                                                         \
+    bool PFX##_equals(struct SNAME *_map1_, struct SNAME *_map2_, int (*value_comparator)(V, V))         \
+    {                                                                                                    \
+        if (PFX##_count(_map1_) != PFX##_count(_map2_))                                                  \
+            return false;                                                                                \
+                                                                                                         \
+        struct SNAME##_iter iter;                                                                        \
+        PFX##_iter_init(&iter, _map1_);                                                                  \
+                                                                                                         \
+        for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))                 \
+        {                                                                                                \
+            struct SNAME##_entry *entry = PFX##_impl_get_entry(_map2_, PFX##_iter_key(&iter));           \
+                                                                                                         \
+            if (entry == NULL)                                                                           \
+                return false;                                                                            \
+                                                                                                         \
+            if (value_comparator)                                                                        \
+            {                                                                                            \
+                if (value_comparator(entry->value, PFX##_iter_value(&iter)) != 0)                        \
+                    return false;                                                                        \
+            }                                                                                            \
+        }                                                                                                \
+                                                                                                         \
+        return true;                                                                                     \
+    }                                                                                                    \
+                                                                                                         \
+    struct cmc_string PFX##_to_string(struct SNAME *_map_)                                               \
+    {                                                                                                    \
+        struct cmc_string str;                                                                           \
+        struct SNAME *m_ = _map_;                                                                        \
+        const char *name = #SNAME;                                                                       \
+                                                                                                         \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_swissmap,                                         \
+                 name, m_, m_->buffer, m_->ctrl, m_->capacity, m_->count, m_->deleted,                   \
+                 m_->load, m_->cmp, m_->hash);                                                           \
+                                                                                                         \
+        return str;                                                                                      \
+    }                                                                                                    \
+                                                                                                         \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_ENTRY)                                       \
+                                                                                                         \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_ENTRY, (K, V))                                      \
+                                                                                                         \
+    bool PFX##_save(struct SNAME *_map_, FILE *file, bool (*key_writer)(K, FILE *),                      \
+                    bool (*value_writer)(V, FILE *))                                                     \
+    {                                                                                                    \
+        uint32_t flags = (key_writer ? 0 : CMC_SERIAL_RAW_KEYS) |                                        \
+                         (value_writer ? 0 : CMC_SERIAL_RAW_VALUES);                                     \
+                                                                                                         \
+        if (!key_writer && !value_writer)                                                                \
+            flags |= CMC_SERIAL_LAYOUT;                                                                  \
+                                                                                                         \
+        if (!cmc_serial_write_header(file, "swissmap", flags, sizeof(K), sizeof(V),                      \
+                                     sizeof(struct SNAME##_entry), _map_->count,                         \
+                                     _map_->capacity, _map_->load))                                      \
+            return false;                                                                                \
+                                                                                                         \
+        /* Without any writer the entries and their control tags are written */                          \
+        /* as they are in memory */                                                                      \
+        if (flags & CMC_SERIAL_LAYOUT)                                                                   \
+        {                                                                                                \
+            size_t ctrl_size = _map_->capacity + CMC_SWISS_GROUP;                                        \
+                                                                                                         \
+            return fwrite(_map_->buffer, sizeof(struct SNAME##_entry), _map_->capacity, file) ==         \
+                       _map_->capacity &&                                                                \
+                   fwrite(_map_->ctrl, sizeof(int8_t), ctrl_size, file) == ctrl_size;                    \
+        }                                                                                                \
+                                                                                                         \
+        for (size_t i = 0; i < _map_->capacity; i++)                                                     \
+        {                                                                                                \
+            if (_map_->ctrl[i] < 0)                                                                      \
+                continue;                                                                                \
+                                                                                                         \
+            if (!CMC_SERIAL_WRITE(key_writer, _map_->buffer[i].key, file) ||                             \
+                !CMC_SERIAL_WRITE(value_writer, _map_->buffer[i].value, file))                           \
+                return false;                                                                            \
+        }                                                                                                \
+                                                                                                         \
+        return true;                                                                                     \
+    }                                                                                                    \
+                                                                                                         \
+    /* A map saved without writers is restored without hashing its keys so */                            \
+    /* it must be given the same hash function it was saved with. Otherwise */                           \
+    /* each reader is only used if the keys or values were saved with a writer */                        \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(K, K), size_t (*hash)(K),                     \
+                                bool (*key_reader)(K *, FILE *),                                         \
+                                bool (*value_reader)(V *, FILE *))                                       \
+    {                                                                                                    \
+        struct cmc_serial_header header;                                                                 \
+                                                                                                         \
+        if (!cmc_serial_read_header(file, "swissmap", sizeof(K), sizeof(V), &header))                    \
+            return NULL;                                                                                 \
+                                                                                                         \
+        if (header.flags & CMC_SERIAL_LAYOUT)                                                            \
+            return PFX##_impl_load_layout(file, compare, hash, &header);                                 \
+                                                                                                         \
+        /* Allocated for every key so that restoring never grows */                                      \
+        struct SNAME *_map_ =                                                                            \
+            PFX##_new(header.count > 0 ? header.count : 1, header.load, compare, hash);                  \
+                                                                                                         \
+        if (!_map_)                                                                                      \
+            return NULL;                                                                                 \
+                                                                                                         \
+        bool raw_keys = header.flags & CMC_SERIAL_RAW_KEYS;                                              \
+        bool raw_values = header.flags & CMC_SERIAL_RAW_VALUES;                                          \
+                                                                                                         \
+        for (size_t i = 0; i < header.count; i++)                                                        \
+        {                                                                                                \
+            K key;                                                                                       \
+            V value;                                                                                     \
+                                                                                                         \
+            if (!CMC_SERIAL_READ(raw_keys, key_reader, &key, file) ||                                    \
+                !CMC_SERIAL_READ(raw_values, value_reader, &value, file) ||                              \
+                !PFX##_insert(_map_, key, value))                                                        \
+            {                                                                                            \
+                PFX##_free(_map_, NULL);                                                                 \
+                return NULL;                                                                             \
+            }                                                                                            \
+        }                                                                                                \
+                                                                                                         \
+        return _map_;                                                                                    \
+    }                                                                                                    \
+                                                                                                         \
+                                                                                                         \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                            \
+    {                                                                                                    \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));                  \
+                                                                                                         \
+        if (CMC_UNLIKELY(!iter))                                                                         \
+            return NULL;                                                                                 \
+                                                                                                         \
+        PFX##_iter_init(iter, target);                                                                   \
+                                                                                                         \
+        return iter;                                                                                     \
+    }                                                                                                    \
+                                                                                                         \
+    void PFX##_iter_free(struct SNAME##_iter *iter)                                                      \
+    {                                                                                                    \
+        iter->target->alloc->free(iter);                                                                 \
+    }                                                                                                    \
+                                                                                                         \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                                \
+    {                                                                                                    \
+        memset(iter, 0, sizeof(struct SNAME##_iter));                                                    \
+                                                                                                         \
+        iter->target = target;                                                                           \
+        iter->start = true;                                                                              \
+        iter->end = PFX##_empty(target);                                                                 \
+                                                                                                         \
+        if (!PFX##_empty(target))                                                                        \
+        {                                                                                                \
+            for (size_t i = 0; i < target->capacity; i++)                                                \
+            {                                                                                            \
+                if (target->ctrl[i] >= 0)                                                                \
+                {                                                                                        \
+                    iter->first = i;                                                                     \
+                    break;                                                                               \
+                }                                                                                        \
+            }                                                                                            \
+                                                                                                         \
+            iter->cursor = iter->first;                                                                  \
+                                                                                                         \
+            for (size_t i = target->capacity; i > 0; i--)                                                \
+            {                                                                                            \
+                if (target->ctrl[i - 1] >= 0)                                                            \
+                {                                                                                        \
+                    iter->last = i - 1;                                                                  \
+                    break;                                                                               \
+                }                                                                                        \
+            }                                                                                            \
+        }                                                                                                \
+    }                                                                                                    \
+                                                                                                         \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                                     \
+    {                                                                                                    \
+        return PFX##_empty(iter->target) || iter->start;                                                 \
+    }                                                                                                    \
+                                                                                                         \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                                       \
+    {                                                                                                    \
+        return PFX##_empty(iter->target) || iter->end;                                                   \
+    }                                                                                                    \
+                                                                                                         \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                                  \
+    {                                                                                                    \
+        if (!PFX##_empty(iter->target))                                                                  \
+        {                                                                                                \
+            iter->cursor = iter->first;                                                                  \
+            iter->index = 0;                                                                             \
+            iter->start = true;                                                                          \
+            iter->end = PFX##_empty(iter->target);                                                       \
+        }                                                                                                \
+    }                                                                                                    \
+                                                                                                         \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                                    \
+    {                                                                                                    \
+        if (!PFX##_empty(iter->target))                                                                  \
+        {                                                                                                \
+            iter->cursor = iter->last;                                                                   \
+            iter->index = PFX##_count(iter->target) - 1;                                                 \
+            iter->start = PFX##_empty(iter->target);                                                     \
+            iter->end = true;                                                                            \
+        }                                                                                                \
+    }                                                                                                    \
+                                                                                                         \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                                      \
+    {                                                                                                    \
+        if (iter->end)                                                                                   \
+            return false;                                                                                \
+                                                                                                         \
+        if (iter->index + 1 == PFX##_count(iter->target))                                                \
+        {                                                                                                \
+            iter->end = true;                                                                            \
+            return false;                                                                                \
+        }                                                                                                \
+                                                                                                         \
+        iter->start = PFX##_empty(iter->target);                                                         \
+                                                                                                         \
+        iter->index++;                                                                                   \
+                                                                                                         \
+        while (1)                                                                                        \
+        {                                                                                                \
+            iter->cursor++;                                                                              \
+                                                                                                         \
+            if (iter->target->ctrl[iter->cursor] >= 0)                                                   \
+                break;                                                                                   \
+        }                                                                                                \
+                                                                                                         \
+        return true;                                                                                     \
+    }                                                                                                    \
+                                                                                                         \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                                      \
+    {                                                                                                    \
+        if (iter->start)                                                                                 \
+            return false;                                                                                \
+                                                                                                         \
+        if (iter->index == 0)                                                                            \
+        {                                                                                                \
+            iter->start = true;                                                                          \
+            return false;                                                                                \
+        }                                                                                                \
+                                                                                                         \
+        iter->end = PFX##_empty(iter->target);                                                           \
+                                                                                                         \
+        iter->index--;                                                                                   \
+                                                                                                         \
+        while (1)                                                                                        \
+        {                                                                                                \
+            iter->cursor--;                                                                              \
+                                                                                                         \
+            if (iter->target->ctrl[iter->cursor] >= 0)                                                   \
+                break;                                                                                   \
+        }                                                                                                \
+                                                                                                         \
+        return true;                                                                                     \
+    }                                                                                                    \
+                                                                                                         \
+    /* Returns true only if the iterator moved */                                                        \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps)                                     \
+    {                                                                                                    \
+        if (iter->end)                                                                                   \
+            return false;                                                                                \
+                                                                                                         \
+        if (iter->index + 1 == PFX##_count(iter->target))                                                \
+        {                                                                                                \
+            iter->end = true;                                                                            \
+            return false;                                                                                \
+        }                                                                                                \
+                                                                                                         \
+        if (steps == 0 || iter->index + steps >= PFX##_count(iter->target))                              \
+            return false;                                                                                \
+                                                                                                         \
+        for (size_t i = 0; i < steps; i++)                                                               \
+            PFX##_iter_next(iter);                                                                       \
+                                                                                                         \
+        return true;                                                                                     \
+    }                                                                                                    \
+                                                                                                         \
+    /* Returns true only if the iterator moved */                                                        \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps)                                      \
+    {                                                                                                    \
+        if (iter->start)                                                                                 \
+            return false;                                                                                \
+                                                                                                         \
+        if (iter->index == 0)                                                                            \
+        {                                                                                                \
+            iter->start = true;                                                                          \
+            return false;                                                                                \
+        }                                                                                                \
+                                                                                                         \
+        if (steps == 0 || iter->index < steps)                                                           \
+            return false;                                                                                \
+                                                                                                         \
+        for (size_t i = 0; i < steps; i++)                                                               \
+            PFX##_iter_prev(iter);                                                                       \
+                                                                                                         \
+        return true;                                                                                     \
+    }                                                                                                    \
+                                                                                                         \
+    /* Returns true only if the iterator was able to be positioned at the given index */                 \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index)                                       \
+    {                                                                                                    \
+        if (index >= PFX##_count(iter->target))                                                          \
+            return false;                                                                                \
+                                                                                                         \
+        if (iter->index > index)                                                                         \
+            return PFX##_iter_rewind(iter, iter->index - index);                                         \
+        else if (iter->index < index)                                                                    \
+            return PFX##_iter_advance(iter, index - iter->index);                                        \
+                                                                                                         \
+        return true;                                                                                     \
+    }                                                                                                    \
+                                                                                                         \
+    K PFX##_iter_key(struct SNAME##_iter *iter)                                                          \
+    {                                                                                                    \
+        if (PFX##_empty(iter->target))                                                                   \
+            return (K){0};                                                                               \
+                                                                                                         \
+        return iter->target->buffer[iter->cursor].key;                                                   \
+    }                                                                                                    \
+                                                                                                         \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                                        \
+    {                                                                                                    \
+        if (PFX##_empty(iter->target))                                                                   \
+            return (V){0};                                                                               \
+                                                                                                         \
+        return iter->target->buffer[iter->cursor].value;                                                 \
+    }                                                                                                    \
+                                                                                                         \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter)                                                      \
+    {                                                                                                    \
+        if (PFX##_empty(iter->target))                                                                   \
+            return NULL;                                                                                 \
+                                                                                                         \
+        return &(iter->target->buffer[iter->cursor].value);                                              \
+    }                                                                                                    \
+                                                                                                         \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                                   \
+    {                                                                                                    \
+        return iter->index;                                                                              \
+    }                                                                                                    \
+                                                                                                         \
+    static struct SNAME##_entry *PFX##_impl_get_entry(struct SNAME *_map_, K key)                        \
+    {                                                                                                    \
+        size_t hash = cmc_hashtable_mix(PFX##_impl_hash(_map_, key));                                    \
+        size_t mask = _map_->capacity - 1;                                                               \
+        size_t pos = CMC_SWISS_H1(hash) & mask;                                                          \
+        size_t stride = 0;                                                                               \
+                                                                                                         \
+        int8_t tag = CMC_SWISS_H2(hash);                                                                 \
+                                                                                                         \
+        CMC_IMPL_HASHTABLE_PROBE_LOOKUP(_map_);                                                          \
+                                                                                                         \
+        /* There is always at least one empty slot so this loop ends */                                  \
+        while (true)                                                                                     \
+        {                                                                                                \
+            const int8_t *group = &(_map_->ctrl[pos]);                                                   \
+                                                                                                         \
+            for (uint32_t match = cmc_swiss_match(group, tag); match; match &= match - 1)                \
+            {                                                                                            \
+                struct SNAME##_entry *target = &(_map_->buffer[(pos + cmc_swiss_lowest(match)) & mask]); \
+                                                                                                         \
+                CMC_IMPL_HASHTABLE_PROBE_SLOT(_map_);                                                    \
+                                                                                                         \
+                if (PFX##_impl_cmp(_map_, target->key, key) == 0)                                        \
+                    return target;                                                                       \
+            }                                                                                            \
+                                                                                                         \
+            if (cmc_swiss_match(group, CMC_SWISS_EMPTY))                                                 \
+                return NULL;                                                                             \
+                                                                                                         \
+            /* Triangular probing visits every group of a power of two table */                          \
+            stride += CMC_SWISS_GROUP;                                                                   \
+            pos = (pos + stride) & mask;                                                                 \
+        }                                                                                                \
+    }                                                                                                    \
+                                                                                                         \
+    static size_t PFX##_impl_find_slot(struct SNAME *_map_, size_t hash)                                 \
+    {                                                                                                    \
+        size_t mask = _map_->capacity - 1;                                                               \
+        size_t pos = CMC_SWISS_H1(hash) & mask;                                                          \
+        size_t stride = 0;                                                                               \
+                                                                                                         \
+        while (true)                                                                                     \
+        {                                                                                                \
+            uint32_t match = cmc_swiss_match_free(&(_map_->ctrl[pos]));                                  \
+                                                                                                         \
+            if (match)                                                                                   \
+                return (pos + cmc_swiss_lowest(match)) & mask;                                           \
+                                                                                                         \
+            stride += CMC_SWISS_GROUP;                                                                   \
+            pos = (pos + stride) & mask;                                                                 \
+        }                                                                                                \
+    }                                                                                                    \
+                                                                                                         \
+    static void PFX##_impl_set_ctrl(struct SNAME *_map_, size_t index, int8_t tag)                       \
+    {                                                                                                    \
+        _map_->ctrl[index] = tag;                                                                        \
+                                                                                                         \
+        /* Keep the copy of the first group up to date */                                                \
+        if (index < CMC_SWISS_GROUP)                                                                     \
+            _map_->ctrl[_map_->capacity + index] = tag;                                                  \
+    }                                                                                                    \
+                                                                                                         \
+    static bool PFX##_impl_rehash(struct SNAME *_map_, size_t capacity)                                  \
+    {                                                                                                    \
+        struct SNAME##_entry *new_buffer = _map_->alloc->calloc(capacity, sizeof(struct SNAME##_entry)); \
+        int8_t *new_ctrl = _map_->alloc->malloc(capacity + CMC_SWISS_GROUP);                             \
+                                                                                                         \
+        if (!new_buffer || !new_ctrl)                                                                    \
+        {                                                                                                \
+            _map_->alloc->free(new_buffer);                                                              \
+            _map_->alloc->free(new_ctrl);                                                                \
+            return false;                                                                                \
+        }                                                                                                \
+                                                                                                         \
+        memset(new_ctrl, CMC_SWISS_EMPTY, capacity + CMC_SWISS_GROUP);                                   \
+                                                                                                         \
+        struct SNAME##_entry *old_buffer = _map_->buffer;                                                \
+        int8_t *old_ctrl = _map_->ctrl;                                                                  \
+        size_t old_capacity = _map_->capacity;                                                           \
+                                                                                                         \
+        _map_->buffer = new_buffer;                                                                      \
+        _map_->ctrl = new_ctrl;                                                                          \
+        _map_->capacity = capacity;                                                                      \
+        _map_->deleted = 0;                                                                              \
+                                                                                                         \
+        for (size_t i = 0; i < old_capacity; i++)                                                        \
+        {                                                                                                \
+            if (old_ctrl[i] >= 0)                                                                        \
+            {                                                                                            \
+                size_t hash = cmc_hashtable_mix(PFX##_impl_hash(_map_, old_buffer[i].key));              \
+                size_t pos = PFX##_impl_find_slot(_map_, hash);                                          \
+                                                                                                         \
+                PFX##_impl_set_ctrl(_map_, pos, CMC_SWISS_H2(hash));                                     \
+                                                                                                         \
+                _map_->buffer[pos] = old_buffer[i];                                                      \
+            }                                                                                            \
+        }                                                                                                \
+                                                                                                         \
+        _map_->alloc->free(old_buffer);                                                                  \
+        _map_->alloc->free(old_ctrl);                                                                    \
+                                                                                                         \
+        return true;                                                                                     \
+    }                                                                                                    \
+                                                                                                         \
+    /* Called after removals, shrinks the table once it is mostly empty */                               \
+    static void PFX##_impl_low_water(struct SNAME *_map_)                                                \
+    {                                                                                                    \
+        double low_water = cmc_hashtable_low_water(_map_->load);                                         \
+                                                                                                         \
+        /* Left with room for as many again so it is not grown right back */                             \
+        if ((double)_map_->count < (double)_map_->capacity * _map_->load * low_water)                    \
+            PFX##_impl_shrink(_map_, _map_->count * 2);                                                  \
+    }                                                                                                    \
+                                                                                                         \
+    /* Rebuilds the table at the smallest size that holds required entries */                            \
+    static bool PFX##_impl_shrink(struct SNAME *_map_, size_t required)                                  \
+    {                                                                                                    \
+        size_t count = required > 0 ? required : 1;                                                      \
+        size_t capacity = PFX##_impl_calculate_size(count / PFX##_load(_map_));                          \
+                                                                                                         \
+        /* Already as small as the sizing policy allows */                                               \
+        if (capacity >= PFX##_capacity(_map_))                                                           \
+            return true;                                                                                 \
+                                                                                                         \
+        return PFX##_impl_rehash(_map_, capacity);                                                       \
+    }                                                                                                    \
+                                                                                                         \
+    static struct SNAME *PFX##_impl_load_layout(FILE *file, int (*compare)(K, K),                        \
+                                                size_t (*hash)(K),                                       \
+                                                struct cmc_serial_header *header)                        \
+    {                                                                                                    \
+        size_t capacity = header->capacity;                                                              \
+                                                                                                         \
+        /* The buffer is only valid for a table with the same entry */                                   \
+        if (header->extra != sizeof(struct SNAME##_entry) || capacity == 0 ||                            \
+            PFX##_impl_calculate_size(capacity) != capacity || header->count > capacity ||               \
+            capacity > SIZE_MAX / sizeof(struct SNAME##_entry))                                          \
+            return NULL;                                                                                 \
+                                                                                                         \
+        struct SNAME *_map_ = PFX##_new(1, header->load, compare, hash);                                 \
+                                                                                                         \
+        if (CMC_UNLIKELY(!_map_))                                                                        \
+            return NULL;                                                                                 \
+                                                                                                         \
+        size_t ctrl_size = capacity + CMC_SWISS_GROUP;                                                   \
+                                                                                                         \
+        struct SNAME##_entry *buffer = _map_->alloc->malloc(capacity * sizeof(struct SNAME##_entry));    \
+        int8_t *ctrl = _map_->alloc->malloc(ctrl_size);                                                  \
+                                                                                                         \
+        if (!buffer || !ctrl ||                                                                          \
+            fread(buffer, sizeof(struct SNAME##_entry), capacity, file) != capacity ||                   \
+            fread(ctrl, sizeof(int8_t), ctrl_size, file) != ctrl_size)                                   \
+        {                                                                                                \
+            _map_->alloc->free(buffer);                                                                  \
+            _map_->alloc->free(ctrl);                                                                    \
+            PFX##_free(_map_, NULL);                                                                     \
+            return NULL;                                                                                 \
+        }                                                                                                \
+                                                                                                         \
+        _map_->alloc->free(_map_->buffer);                                                               \
+        _map_->alloc->free(_map_->ctrl);                                                                 \
+                                                                                                         \
+        _map_->buffer = buffer;                                                                          \
+        _map_->ctrl = ctrl;                                                                              \
+        _map_->capacity = capacity;                                                                      \
+                                                                                                         \
+        for (size_t i = 0; i < capacity; i++)                                                            \
+        {                                                                                                \
+            if (ctrl[i] >= 0)                                                                            \
+                _map_->count++;                                                                          \
+            else if (ctrl[i] == CMC_SWISS_DELETED)                                                       \
+                _map_->deleted++;                                                                        \
+        }                                                                                                \
+                                                                                                         \
+        /* Tags are trusted as they are but their amount and the copy of the */                          \
+        /* first group are checked */                                                                    \
+        if (_map_->count != header->count || memcmp(ctrl, ctrl + capacity, CMC_SWISS_GROUP) != 0)        \
+        {                                                                                                \
+            PFX##_free(_map_, NULL);                                                                     \
+            return NULL;                                                                                 \
+        }                                                                                                \
+                                                                                                         \
+        return _map_;                                                                                    \
+    }                                                                                                    \
+                                                                                                         \
+                                                                                                         \
+    static size_t PFX##_impl_calculate_size(size_t required)                                             \
+    {                                                                                                    \
+        return cmc_hashtable_pow2_size(required);                                                        \
+    }                                                                                                    \
+                                                                                                         \
+    static struct SNAME##_iter PFX##_impl_it_start(struct SNAME *_map_)                                  \
+    {                                                                                                    \
+        struct SNAME##_iter iter;                                                                        \
+                                                                                                         \
+        PFX##_iter_init(&iter, _map_);                                                                   \
+                                                                                                         \
+        return iter;                                                                                     \
+    }                                                                                                    \
+                                                                                                         \
+    static struct SNAME##_iter PFX##_impl_it_end(struct SNAME *_map_)                                    \
+    {                                                                                                    \
+        struct SNAME##_iter iter;                                                                        \
+                                                                                                         \
+        PFX##_iter_init(&iter, _map_);                                                                   \
+        PFX##_iter_to_end(&iter);                                                                        \
+                                                                                                         \
+        return iter;                                                                                     \
+    }                                                                                                    \
+                                                                                                         \
+    static inline int PFX##_impl_cmp(struct SNAME *_map_, K a, K b)                                      \
+    {                                                                                                    \
+        (void)_map_;                                                                                     \
+                                                                                                         \
+        return CMP(a, b);                                                                                \
+    }                                                                                                    \
+                                                                                                         \
+    static inline size_t PFX##_impl_hash(struct SNAME *_map_, K key)                                     \
+    {                                                                                                    \
+        (void)_map_;                                                                                     \
+                                                                                                         \
+        return HASH(key);                                                                                \
+    }                                                                                                    \
+
+#endif /* CMC_SWISSMAP_H */
@@ -0,0 +1,552 @@
+/**
+ * timerwheel.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * TimerWheel
+ *
+ * A TimerWheel keeps elements until a deadline, like the timeouts of network
+ * connections. Scheduling and cancelling a timer take O(1) and advancing the
+ * wheel to a new time fires every timer that expired, in the order of their
+ * deadlines, by calling a function with each one of their elements. Time is
+ * measured in ticks, an unsigned 64 bit integer with whatever unit suits the
+ * program, like milliseconds.
+ *
+ * Each scheduled timer gets a handle that can be used to read, cancel or
+ * reschedule it for as long as it did not fire. The handles of timers that
+ * fired or were cancelled are given to the next timers scheduled.
+ *
+ * Implementation
+ *
+ * The wheel is hierarchical, with 11 levels of 64 slots each. A timer is
+ * kept at the level of the highest 6 bits in which its deadline differs from
+ * the current time, in the slot of the deadline at those bits. The timers of
+ * level 0 expire once the time reaches their slot, and the timers in a slot
+ * of a higher level are placed again, at lower levels, once the time reaches
+ * it. Each timer is moved at most once per level and a bitmap of the slots in
+ * use lets advance skip all the empty ones at once.
+ *
+ * The timers are kept in a single array and the lists of each slot are linked
+ * by their indices, which are also their handles, so the array can grow
+ * without invalidating any of them.
+ */
+
+#ifndef CMC_TIMERWHEEL_H
+#define CMC_TIMERWHEEL_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_growth.h"
+#include "../utl/cmc_math.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* Slots of each level, one bit of a bitmap each, and the bits of time */
+/* they cover */
+#define CMC_TIMERWHEEL_SLOTS 64
+#define CMC_TIMERWHEEL_BITS 6
+
+/* Levels needed to cover every bit of time */
+#define CMC_TIMERWHEEL_LEVELS 11
+
+/* Every slot has a list, and one more list keeps the timers that expired */
+/* until they fire */
+#define CMC_TIMERWHEEL_EXPIRED (CMC_TIMERWHEEL_LEVELS * CMC_TIMERWHEEL_SLOTS)
+
+/* End of a list, and the list of a timer that is not scheduled */
+#define CMC_TIMERWHEEL_NONE SIZE_MAX
+
+/* to_string format */
+static const char *cmc_string_fmt_timerwheel = "%s at %p { timers:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX ", now:%" PRIu64 " }";
+
+#define CMC_GENERATE_TIMERWHEEL(PFX, SNAME, V)    \
+    CMC_GENERATE_TIMERWHEEL_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_TIMERWHEEL_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_TIMERWHEEL_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_TIMERWHEEL_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_TIMERWHEEL_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_TIMERWHEEL_SOURCE(PFX, SNAME, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_TIMERWHEEL_HEADER(PFX, SNAME, V)                                         \
+    /* Timer Wheel Timer */                                                                   \
+    struct SNAME##_timer                                                                      \
+    {                                                                                         \
+        /* Element given to the callback when it fires */                                     \
+        V value;                                                                              \
+                                                                                              \
+        /* Tick at which it expires */                                                        \
+        uint64_t deadline;                                                                    \
+                                                                                              \
+        /* Neighbouring timers in its list, or the next free timer */                         \
+        size_t next;                                                                          \
+        size_t prev;                                                                          \
+                                                                                              \
+        /* List the timer is in, CMC_TIMERWHEEL_NONE if it is free */                         \
+        size_t list;                                                                          \
+    };                                                                                        \
+                                                                                              \
+    /* Timer Wheel Structure */                                                               \
+    struct SNAME                                                                              \
+    {                                                                                         \
+        /* Array of timers, indexed by their handles */                                       \
+        struct SNAME##_timer *timers;                                                         \
+                                                                                              \
+        /* Current array capacity */                                                          \
+        size_t capacity;                                                                      \
+                                                                                              \
+        /* Amount of handles given out so far, scheduled or free */                           \
+        size_t handles;                                                                       \
+                                                                                              \
+        /* Current amount of scheduled timers */                                              \
+        size_t count;                                                                         \
+                                                                                              \
+        /* First free timer */                                                                \
+        size_t free_list;                                                                     \
+                                                                                              \
+        /* Current time */                                                                    \
+        uint64_t now;                                                                         \
+                                                                                              \
+        /* First timer of each list and the last one of the expired list */                   \
+        size_t heads[CMC_TIMERWHEEL_EXPIRED + 1];                                             \
+        size_t expired_tail;                                                                  \
+                                                                                              \
+        /* Slots of each level that have timers */                                            \
+        uint64_t occupied[CMC_TIMERWHEEL_LEVELS];                                             \
+                                                                                              \
+        /* Custom allocation functions */                                                     \
+        struct cmc_alloc_node *alloc;                                                         \
+    };                                                                                        \
+                                                                                              \
+    /* Collection Functions */                                                                \
+    /* Collection Allocation and Deallocation */                                              \
+    struct SNAME *PFX##_new(size_t capacity, uint64_t now);                                   \
+    struct SNAME *PFX##_new_custom(size_t capacity, uint64_t now,                             \
+                                   struct cmc_alloc_node *alloc);                             \
+    void PFX##_clear(struct SNAME *_wheel_, void (*deallocator)(V));                          \
+    void PFX##_free(struct SNAME *_wheel_, void (*deallocator)(V));                           \
+    /* Collection Input and Output */                                                         \
+    bool PFX##_schedule(struct SNAME *_wheel_, uint64_t deadline, V element, size_t *handle); \
+    bool PFX##_cancel(struct SNAME *_wheel_, size_t handle, V *result);                       \
+    bool PFX##_reschedule(struct SNAME *_wheel_, size_t handle, uint64_t deadline);           \
+    size_t PFX##_advance(struct SNAME *_wheel_, uint64_t now, void (*callback)(V, void *),    \
+                         void *data);                                                         \
+    /* Element Access */                                                                      \
+    V PFX##_get(struct SNAME *_wheel_, size_t handle);                                        \
+    uint64_t PFX##_deadline(struct SNAME *_wheel_, size_t handle);                            \
+    uint64_t PFX##_now(struct SNAME *_wheel_);                                                \
+    bool PFX##_next_tick(struct SNAME *_wheel_, uint64_t *tick);                              \
+    /* Collection State */                                                                    \
+    bool PFX##_contains(struct SNAME *_wheel_, size_t handle);                                \
+    CMC_PURE bool PFX##_empty(struct SNAME *_wheel_);                                         \
+    CMC_PURE size_t PFX##_count(struct SNAME *_wheel_);                                       \
+    size_t PFX##_memory_usage(struct SNAME *_wheel_);                                         \
+    /* Collection Utility */                                                                  \
+    struct cmc_string PFX##_to_string(struct SNAME *_wheel_);                                 \
+                                                                                              \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_TIMERWHEEL_SOURCE(PFX, SNAME, V)                                            \
+    /* Implementation Detail Functions */                                                        \
+    static size_t PFX##_impl_place(struct SNAME *_wheel_, uint64_t deadline);                    \
+    static void PFX##_impl_link(struct SNAME *_wheel_, size_t handle, size_t list);              \
+    static void PFX##_impl_unlink(struct SNAME *_wheel_, size_t handle);                         \
+    static bool PFX##_impl_next(struct SNAME *_wheel_, uint64_t *tick, size_t *list);            \
+                                                                                                 \
+    struct SNAME *PFX##_new(size_t capacity, uint64_t now)                                       \
+    {                                                                                            \
+        return PFX##_new_custom(capacity, now, NULL);                                            \
+    }                                                                                            \
+                                                                                                 \
+    struct SNAME *PFX##_new_custom(size_t capacity, uint64_t now, struct cmc_alloc_node *alloc)  \
+    {                                                                                            \
+        if (!alloc)                                                                              \
+            alloc = &cmc_alloc_node_default;                                                     \
+                                                                                                 \
+        if (capacity < 1 || capacity > SIZE_MAX / sizeof(struct SNAME##_timer))                  \
+            return NULL;                                                                         \
+                                                                                                 \
+        struct SNAME *_wheel_ = alloc->malloc(sizeof(struct SNAME));                             \
+                                                                                                 \
+        if (CMC_UNLIKELY(!_wheel_))                                                              \
+            return NULL;                                                                         \
+                                                                                                 \
+        _wheel_->alloc = alloc;                                                                  \
+                                                                                                 \
+        _wheel_->timers = alloc->malloc(sizeof(struct SNAME##_timer) * capacity);                \
+                                                                                                 \
+        if (CMC_UNLIKELY(!_wheel_->timers))                                                      \
+        {                                                                                        \
+            alloc->free(_wheel_);                                                                \
+            return NULL;                                                                         \
+        }                                                                                        \
+                                                                                                 \
+        _wheel_->capacity = capacity;                                                            \
+                                                                                                 \
+        PFX##_clear(_wheel_, NULL);                                                              \
+                                                                                                 \
+        _wheel_->now = now;                                                                      \
+                                                                                                 \
+        return _wheel_;                                                                          \
+    }                                                                                            \
+                                                                                                 \
+    /* Every handle given out so far is invalidated. The time is kept */                         \
+    void PFX##_clear(struct SNAME *_wheel_, void (*deallocator)(V))                              \
+    {                                                                                            \
+        if (deallocator)                                                                         \
+        {                                                                                        \
+            for (size_t i = 0; i < _wheel_->handles; i++)                                        \
+            {                                                                                    \
+                if (_wheel_->timers[i].list != CMC_TIMERWHEEL_NONE)                              \
+                    deallocator(_wheel_->timers[i].value);                                       \
+            }                                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        for (size_t i = 0; i <= CMC_TIMERWHEEL_EXPIRED; i++)                                     \
+            _wheel_->heads[i] = CMC_TIMERWHEEL_NONE;                                             \
+                                                                                                 \
+        memset(_wheel_->occupied, 0, sizeof(_wheel_->occupied));                                 \
+                                                                                                 \
+        _wheel_->handles = 0;                                                                    \
+        _wheel_->count = 0;                                                                      \
+        _wheel_->free_list = CMC_TIMERWHEEL_NONE;                                                \
+        _wheel_->expired_tail = CMC_TIMERWHEEL_NONE;                                             \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_free(struct SNAME *_wheel_, void (*deallocator)(V))                               \
+    {                                                                                            \
+        PFX##_clear(_wheel_, deallocator);                                                       \
+                                                                                                 \
+        _wheel_->alloc->free(_wheel_->timers);                                                   \
+        _wheel_->alloc->free(_wheel_);                                                           \
+    }                                                                                            \
+                                                                                                 \
+    /* A deadline that is not after the current time fires on the next advance. */               \
+    /* The handle of the timer is written to handle unless it is NULL */                         \
+    bool PFX##_schedule(struct SNAME *_wheel_, uint64_t deadline, V element, size_t *handle)     \
+    {                                                                                            \
+        size_t h = _wheel_->free_list;                                                           \
+                                                                                                 \
+        if (h != CMC_TIMERWHEEL_NONE)                                                            \
+            _wheel_->free_list = _wheel_->timers[h].next;                                        \
+        else                                                                                     \
+        {                                                                                        \
+            if (_wheel_->handles == _wheel_->capacity)                                           \
+            {                                                                                    \
+                size_t capacity = cmc_growth_capacity(_wheel_->capacity, _wheel_->capacity + 1); \
+                                                                                                 \
+                if (capacity > SIZE_MAX / sizeof(struct SNAME##_timer))                          \
+                    return false;                                                                \
+                                                                                                 \
+                struct SNAME##_timer *timers =                                                   \
+                    _wheel_->alloc->realloc(_wheel_->timers,                                     \
+                                            sizeof(struct SNAME##_timer) * capacity);            \
+                                                                                                 \
+                if (!timers)                                                                     \
+                    return false;                                                                \
+                                                                                                 \
+                _wheel_->timers = timers;                                                        \
+                _wheel_->capacity = capacity;                                                    \
+            }                                                                                    \
+                                                                                                 \
+            h = _wheel_->handles++;                                                              \
+        }                                                                                        \
+                                                                                                 \
+        _wheel_->timers[h].value = element;                                                      \
+        _wheel_->timers[h].deadline = deadline;                                                  \
+                                                                                                 \
+        PFX##_impl_link(_wheel_, h, PFX##_impl_place(_wheel_, deadline));                        \
+                                                                                                 \
+        _wheel_->count++;                                                                        \
+                                                                                                 \
+        if (handle)                                                                              \
+            *handle = h;                                                                         \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Removes a timer before it fires. Its element is written to result */                      \
+    /* unless it is NULL */                                                                      \
+    bool PFX##_cancel(struct SNAME *_wheel_, size_t handle, V *result)                           \
+    {                                                                                            \
+        if (!PFX##_contains(_wheel_, handle))                                                    \
+            return false;                                                                        \
+                                                                                                 \
+        struct SNAME##_timer *timer = &(_wheel_->timers[handle]);                                \
+                                                                                                 \
+        PFX##_impl_unlink(_wheel_, handle);                                                      \
+                                                                                                 \
+        if (result)                                                                              \
+            *result = timer->value;                                                              \
+                                                                                                 \
+        timer->value = (V){0};                                                                   \
+        timer->list = CMC_TIMERWHEEL_NONE;                                                       \
+        timer->next = _wheel_->free_list;                                                        \
+                                                                                                 \
+        _wheel_->free_list = handle;                                                             \
+        _wheel_->count--;                                                                        \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Moves the deadline of a timer, keeping its handle */                                      \
+    bool PFX##_reschedule(struct SNAME *_wheel_, size_t handle, uint64_t deadline)               \
+    {                                                                                            \
+        if (!PFX##_contains(_wheel_, handle))                                                    \
+            return false;                                                                        \
+                                                                                                 \
+        PFX##_impl_unlink(_wheel_, handle);                                                      \
+                                                                                                 \
+        _wheel_->timers[handle].deadline = deadline;                                             \
+                                                                                                 \
+        PFX##_impl_link(_wheel_, handle, PFX##_impl_place(_wheel_, deadline));                   \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Moves the time forward to now and fires every timer whose deadline is */                  \
+    /* not after it, earliest first, calling callback with its element and */                    \
+    /* data. Each timer is removed before its callback is called, which can */                   \
+    /* schedule and cancel timers but can't call advance. Timers scheduled by */                 \
+    /* it that already expired fire on the next advance. If callback is NULL */                  \
+    /* the elements are discarded. Returns how many timers fired */                              \
+    size_t PFX##_advance(struct SNAME *_wheel_, uint64_t now, void (*callback)(V, void *),       \
+                         void *data)                                                             \
+    {                                                                                            \
+        uint64_t tick;                                                                           \
+        size_t list;                                                                             \
+                                                                                                 \
+        while (PFX##_impl_next(_wheel_, &tick, &list) && tick <= now)                            \
+        {                                                                                        \
+            _wheel_->now = tick;                                                                 \
+                                                                                                 \
+            size_t scan = _wheel_->heads[list];                                                  \
+                                                                                                 \
+            _wheel_->heads[list] = CMC_TIMERWHEEL_NONE;                                          \
+            _wheel_->occupied[list / CMC_TIMERWHEEL_SLOTS] &=                                    \
+                ~((uint64_t)1 << (list % CMC_TIMERWHEEL_SLOTS));                                 \
+                                                                                                 \
+            /* The timers of level 0 expired and the ones above go down */                       \
+            while (scan != CMC_TIMERWHEEL_NONE)                                                  \
+            {                                                                                    \
+                size_t next = _wheel_->timers[scan].next;                                        \
+                                                                                                 \
+                if (list < CMC_TIMERWHEEL_SLOTS)                                                 \
+                    PFX##_impl_link(_wheel_, scan, CMC_TIMERWHEEL_EXPIRED);                      \
+                else                                                                             \
+                    PFX##_impl_link(_wheel_, scan,                                               \
+                                    PFX##_impl_place(_wheel_, _wheel_->timers[scan].deadline));  \
+                                                                                                 \
+                scan = next;                                                                     \
+            }                                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        if (now > _wheel_->now)                                                                  \
+            _wheel_->now = now;                                                                  \
+                                                                                                 \
+        size_t fired = 0;                                                                        \
+                                                                                                 \
+        while (_wheel_->heads[CMC_TIMERWHEEL_EXPIRED] != CMC_TIMERWHEEL_NONE)                    \
+        {                                                                                        \
+            V value;                                                                             \
+                                                                                                 \
+            PFX##_cancel(_wheel_, _wheel_->heads[CMC_TIMERWHEEL_EXPIRED], &value);               \
+                                                                                                 \
+            fired++;                                                                             \
+                                                                                                 \
+            if (callback)                                                                        \
+                callback(value, data);                                                           \
+        }                                                                                        \
+                                                                                                 \
+        return fired;                                                                            \
+    }                                                                                            \
+                                                                                                 \
+    V PFX##_get(struct SNAME *_wheel_, size_t handle)                                            \
+    {                                                                                            \
+        if (!PFX##_contains(_wheel_, handle))                                                    \
+            return (V){0};                                                                       \
+                                                                                                 \
+        return _wheel_->timers[handle].value;                                                    \
+    }                                                                                            \
+                                                                                                 \
+    uint64_t PFX##_deadline(struct SNAME *_wheel_, size_t handle)                                \
+    {                                                                                            \
+        if (!PFX##_contains(_wheel_, handle))                                                    \
+            return 0;                                                                            \
+                                                                                                 \
+        return _wheel_->timers[handle].deadline;                                                 \
+    }                                                                                            \
+                                                                                                 \
+    uint64_t PFX##_now(struct SNAME *_wheel_)                                                    \
+    {                                                                                            \
+        return _wheel_->now;                                                                     \
+    }                                                                                            \
+                                                                                                 \
+    /* The first tick at which advance has work to do, which is never after */                   \
+    /* the earliest deadline. Can be used as the timeout of a poll. Returns */                   \
+    /* false if there are no timers */                                                           \
+    bool PFX##_next_tick(struct SNAME *_wheel_, uint64_t *tick)                                  \
+    {                                                                                            \
+        size_t list;                                                                             \
+                                                                                                 \
+        return PFX##_impl_next(_wheel_, tick, &list);                                            \
+    }                                                                                            \
+                                                                                                 \
+    /* If the handle belongs to a timer that did not fire nor was cancelled */                   \
+    bool PFX##_contains(struct SNAME *_wheel_, size_t handle)                                    \
+    {                                                                                            \
+        return handle < _wheel_->handles && _wheel_->timers[handle].list != CMC_TIMERWHEEL_NONE; \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_empty(struct SNAME *_wheel_)                                                      \
+    {                                                                                            \
+        return _wheel_->count == 0;                                                              \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_count(struct SNAME *_wheel_)                                                    \
+    {                                                                                            \
+        return _wheel_->count;                                                                   \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_memory_usage(struct SNAME *_wheel_)                                             \
+    {                                                                                            \
+        return sizeof(struct SNAME) + sizeof(struct SNAME##_timer) * _wheel_->capacity;          \
+    }                                                                                            \
+                                                                                                 \
+    struct cmc_string PFX##_to_string(struct SNAME *_wheel_)                                     \
+    {                                                                                            \
+        struct cmc_string str;                                                                   \
+        struct SNAME *w_ = _wheel_;                                                              \
+        const char *name = #SNAME;                                                               \
+                                                                                                 \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_timerwheel, name, w_, w_->timers,         \
+                 w_->capacity, w_->count, w_->now);                                              \
+                                                                                                 \
+        return str;                                                                              \
+    }                                                                                            \
+                                                                                                 \
+    /* List of the slot of a deadline, at the level of the highest bits in */                    \
+    /* which it differs from the current time */                                                 \
+    static size_t PFX##_impl_place(struct SNAME *_wheel_, uint64_t deadline)                     \
+    {                                                                                            \
+        uint64_t now = _wheel_->now;                                                             \
+                                                                                                 \
+        if (deadline <= now)                                                                     \
+            return now % CMC_TIMERWHEEL_SLOTS;                                                   \
+                                                                                                 \
+        size_t level = (63 - cmc_math_clz(deadline ^ now)) / CMC_TIMERWHEEL_BITS;                \
+        size_t slot = (deadline >> (level * CMC_TIMERWHEEL_BITS)) % CMC_TIMERWHEEL_SLOTS;        \
+                                                                                                 \
+        return level * CMC_TIMERWHEEL_SLOTS + slot;                                              \
+    }                                                                                            \
+                                                                                                 \
+    /* Slot lists are pushed to their front and the expired list to its back, */                 \
+    /* so the timers fire in the order that they expired */                                      \
+    static void PFX##_impl_link(struct SNAME *_wheel_, size_t handle, size_t list)               \
+    {                                                                                            \
+        struct SNAME##_timer *timer = &(_wheel_->timers[handle]);                                \
+                                                                                                 \
+        timer->list = list;                                                                      \
+                                                                                                 \
+        if (list == CMC_TIMERWHEEL_EXPIRED)                                                      \
+        {                                                                                        \
+            size_t tail = _wheel_->expired_tail;                                                 \
+                                                                                                 \
+            timer->next = CMC_TIMERWHEEL_NONE;                                                   \
+            timer->prev = tail;                                                                  \
+                                                                                                 \
+            if (tail == CMC_TIMERWHEEL_NONE)                                                     \
+                _wheel_->heads[list] = handle;                                                   \
+            else                                                                                 \
+                _wheel_->timers[tail].next = handle;                                             \
+                                                                                                 \
+            _wheel_->expired_tail = handle;                                                      \
+                                                                                                 \
+            return;                                                                              \
+        }                                                                                        \
+                                                                                                 \
+        timer->next = _wheel_->heads[list];                                                      \
+        timer->prev = CMC_TIMERWHEEL_NONE;                                                       \
+                                                                                                 \
+        if (timer->next != CMC_TIMERWHEEL_NONE)                                                  \
+            _wheel_->timers[timer->next].prev = handle;                                          \
+                                                                                                 \
+        _wheel_->heads[list] = handle;                                                           \
+        _wheel_->occupied[list / CMC_TIMERWHEEL_SLOTS] |=                                        \
+            (uint64_t)1 << (list % CMC_TIMERWHEEL_SLOTS);                                        \
+    }                                                                                            \
+                                                                                                 \
+    static void PFX##_impl_unlink(struct SNAME *_wheel_, size_t handle)                          \
+    {                                                                                            \
+        struct SNAME##_timer *timer = &(_wheel_->timers[handle]);                                \
+                                                                                                 \
+        size_t list = timer->list;                                                               \
+                                                                                                 \
+        if (timer->prev != CMC_TIMERWHEEL_NONE)                                                  \
+            _wheel_->timers[timer->prev].next = timer->next;                                     \
+        else                                                                                     \
+            _wheel_->heads[list] = timer->next;                                                  \
+                                                                                                 \
+        if (timer->next != CMC_TIMERWHEEL_NONE)                                                  \
+            _wheel_->timers[timer->next].prev = timer->prev;                                     \
+        else if (list == CMC_TIMERWHEEL_EXPIRED)                                                 \
+            _wheel_->expired_tail = timer->prev;                                                 \
+                                                                                                 \
+        if (list != CMC_TIMERWHEEL_EXPIRED && _wheel_->heads[list] == CMC_TIMERWHEEL_NONE)       \
+        {                                                                                        \
+            _wheel_->occupied[list / CMC_TIMERWHEEL_SLOTS] &=                                    \
+                ~((uint64_t)1 << (list % CMC_TIMERWHEEL_SLOTS));                                 \
+        }                                                                                        \
+    }                                                                                            \
+                                                                                                 \
+    /* The first slot that the time reaches and the tick at which it does. The */                \
+    /* slots of level 0 are reached at the ticks that they are for and the */                    \
+    /* slots above once all the bits below them are 0. A lower level is always */                \
+    /* reached before a higher one */                                                            \
+    static bool PFX##_impl_next(struct SNAME *_wheel_, uint64_t *tick, size_t *list)             \
+    {                                                                                            \
+        uint64_t now = _wheel_->now;                                                             \
+                                                                                                 \
+        for (size_t level = 0; level < CMC_TIMERWHEEL_LEVELS; level++)                           \
+        {                                                                                        \
+            size_t shift = level * CMC_TIMERWHEEL_BITS;                                          \
+            size_t digit = (now >> shift) % CMC_TIMERWHEEL_SLOTS;                                \
+                                                                                                 \
+            /* Only level 0 can have timers in the slot of the current time */                   \
+            uint64_t slots = _wheel_->occupied[level];                                           \
+                                                                                                 \
+            if (level == 0)                                                                      \
+                slots &= UINT64_MAX << digit;                                                    \
+            else                                                                                 \
+                slots &= digit == CMC_TIMERWHEEL_SLOTS - 1 ? 0 : UINT64_MAX << (digit + 1);      \
+                                                                                                 \
+            if (slots == 0)                                                                      \
+                continue;                                                                        \
+                                                                                                 \
+            size_t slot = cmc_math_ctz(slots);                                                   \
+            size_t above = shift + CMC_TIMERWHEEL_BITS;                                          \
+                                                                                                 \
+            uint64_t high = above >= 64 ? 0 : (now >> above) << above;                           \
+                                                                                                 \
+            *tick = high | ((uint64_t)slot << shift);                                            \
+            *list = level * CMC_TIMERWHEEL_SLOTS + slot;                                         \
+                                                                                                 \
+            return true;                                                                         \
+        }                                                                                        \
+                                                                                                 \
+        return false;                                                                            \
+    }
+
+#endif /* CMC_TIMERWHEEL_H */
@@ -0,0 +1,445 @@
+/**
+ * topk.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * TopK
+ *
+ * A TopK finds the elements that appear the most in a stream, the heavy
+ * hitters, using a fixed amount of memory. It keeps at most k counters, so
+ * it never holds more than k elements no matter how many different ones are
+ * inserted, and each insertion takes O(1).
+ *
+ * The counts are estimates. An element that is not being counted takes the
+ * counter of the one with the smallest count, and starts from that count plus
+ * one, so a count is never less than the real one and is at most error
+ * greater than it, where error is the count the counter had when the element
+ * took it. Any element that appears more than total / k times is always in
+ * the TopK.
+ *
+ * Implementation
+ *
+ * This is the Space-Saving algorithm. The counters are kept in an array
+ * sorted by count and the counters with the same count are grouped in a
+ * bucket with the first and last positions of the group. Incrementing a count
+ * swaps its counter with the last one of its group, so the array stays sorted
+ * after moving a single counter. A HashMap (hashmap.h) generated with the
+ * _index suffix finds the counter of an element.
+ */
+
+#ifndef CMC_TOPK_H
+#define CMC_TOPK_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+#include "hashmap.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_topk = "%s at %p { counters:%p, k:%" PRIuMAX ", count:%" PRIuMAX ", total:%" PRIuMAX ", index:%p, cmp:%p, hash:%p }";
+
+/* Load factor of the HashMap from elements to their counters */
+#define CMC_TOPK_INDEX_LOAD 0.7
+
+#define CMC_GENERATE_TOPK(PFX, SNAME, V)    \
+    CMC_GENERATE_TOPK_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_TOPK_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_TOPK_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_TOPK_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_TOPK_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_TOPK_SOURCE(PFX, SNAME, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_TOPK_HEADER(PFX, SNAME, V)                                                  \
+                                                                                                 \
+    /* TopK Structure */                                                                         \
+    struct SNAME                                                                                 \
+    {                                                                                            \
+        /* Array of k counters */                                                                \
+        struct SNAME##_counter *counters;                                                        \
+                                                                                                 \
+        /* Counters in ascending order of count */                                               \
+        size_t *order;                                                                           \
+                                                                                                 \
+        /* Groups of counters with the same count */                                             \
+        struct SNAME##_bucket *buckets;                                                          \
+                                                                                                 \
+        /* Stack of buckets not in use */                                                        \
+        size_t *spare;                                                                           \
+                                                                                                 \
+        /* Amount of buckets in spare */                                                         \
+        size_t spare_count;                                                                      \
+                                                                                                 \
+        /* Maximum amount of elements counted */                                                 \
+        size_t k;                                                                                \
+                                                                                                 \
+        /* Current amount of elements counted */                                                 \
+        size_t count;                                                                            \
+                                                                                                 \
+        /* Amount of insertions */                                                               \
+        size_t total;                                                                            \
+                                                                                                 \
+        /* Counter of each element counted */                                                    \
+        struct SNAME##_index *index;                                                             \
+                                                                                                 \
+        /* Element comparison function */                                                        \
+        int (*cmp)(V, V);                                                                        \
+                                                                                                 \
+        /* Element hash function */                                                              \
+        size_t (*hash)(V);                                                                       \
+                                                                                                 \
+        /* Custom allocation functions */                                                        \
+        struct cmc_alloc_node *alloc;                                                            \
+    };                                                                                           \
+                                                                                                 \
+    /* The count of an element */                                                                \
+    struct SNAME##_counter                                                                       \
+    {                                                                                            \
+        /* Element counted */                                                                    \
+        V value;                                                                                 \
+                                                                                                 \
+        /* Estimated count, 0 while the counter is not in use */                                 \
+        size_t count;                                                                            \
+                                                                                                 \
+        /* How much count might be above the real count */                                       \
+        size_t error;                                                                            \
+                                                                                                 \
+        /* Position in order */                                                                  \
+        size_t position;                                                                         \
+                                                                                                 \
+        /* Bucket of the counters with the same count */                                         \
+        size_t bucket;                                                                           \
+    };                                                                                           \
+                                                                                                 \
+    /* Counters with the same count, in a range of positions of order */                         \
+    struct SNAME##_bucket                                                                        \
+    {                                                                                            \
+        size_t first;                                                                            \
+        size_t last;                                                                             \
+    };                                                                                           \
+                                                                                                 \
+    /* The HashMap from elements to counters */                                                  \
+    CMC_GENERATE_HASHMAP_HEADER(PFX##_index, SNAME##_index, V, size_t)                           \
+                                                                                                 \
+    /* Collection Functions */                                                                   \
+    /* Collection Allocation and Deallocation */                                                 \
+    struct SNAME *PFX##_new(size_t k, int (*compare)(V, V), size_t (*hash)(V));                  \
+    struct SNAME *PFX##_new_custom(size_t k, int (*compare)(V, V), size_t (*hash)(V),            \
+                                   struct cmc_alloc_node *alloc);                                \
+    void PFX##_clear(struct SNAME *_topk_, void (*deallocator)(V));                              \
+    void PFX##_free(struct SNAME *_topk_, void (*deallocator)(V));                               \
+    /* Collection Input and Output */                                                            \
+    bool PFX##_insert(struct SNAME *_topk_, V element, void (*deallocator)(V));                  \
+    /* Element Access */                                                                         \
+    size_t PFX##_top(struct SNAME *_topk_, size_t n, V *values, size_t *counts, size_t *errors); \
+    size_t PFX##_count_of(struct SNAME *_topk_, V element);                                      \
+    size_t PFX##_error_of(struct SNAME *_topk_, V element);                                      \
+    /* Collection State */                                                                       \
+    bool PFX##_contains(struct SNAME *_topk_, V element);                                        \
+    CMC_PURE bool PFX##_empty(struct SNAME *_topk_);                                             \
+    CMC_PURE size_t PFX##_count(struct SNAME *_topk_);                                           \
+    size_t PFX##_k(struct SNAME *_topk_);                                                        \
+    size_t PFX##_total(struct SNAME *_topk_);                                                    \
+    size_t PFX##_memory_usage(struct SNAME *_topk_);                                             \
+    /* Collection Utility */                                                                     \
+    struct cmc_string PFX##_to_string(struct SNAME *_topk_);                                     \
+                                                                                                 \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_TOPK_SOURCE(PFX, SNAME, V)                                                 \
+                                                                                                \
+    CMC_GENERATE_HASHMAP_SOURCE(PFX##_index, SNAME##_index, V, size_t)                          \
+                                                                                                \
+    /* Implementation Detail Functions */                                                       \
+    static void PFX##_impl_reset(struct SNAME *_topk_);                                         \
+    static void PFX##_impl_increment(struct SNAME *_topk_, size_t slot);                        \
+    static struct SNAME##_counter *PFX##_impl_counter(struct SNAME *_topk_, V element);         \
+                                                                                                \
+    struct SNAME *PFX##_new(size_t k, int (*compare)(V, V), size_t (*hash)(V))                  \
+    {                                                                                           \
+        return PFX##_new_custom(k, compare, hash, NULL);                                        \
+    }                                                                                           \
+                                                                                                \
+    struct SNAME *PFX##_new_custom(size_t k, int (*compare)(V, V), size_t (*hash)(V),           \
+                                   struct cmc_alloc_node *alloc)                                \
+    {                                                                                           \
+        if (k == 0 || !compare || !hash)                                                        \
+            return NULL;                                                                        \
+                                                                                                \
+        if (!alloc)                                                                             \
+            alloc = &cmc_alloc_node_default;                                                    \
+                                                                                                \
+        struct SNAME *_topk_ = alloc->malloc(sizeof(struct SNAME));                             \
+                                                                                                \
+        if (CMC_UNLIKELY(!_topk_))                                                              \
+            return NULL;                                                                        \
+                                                                                                \
+        _topk_->counters = alloc->malloc(k * sizeof(struct SNAME##_counter));                   \
+        _topk_->order = alloc->malloc(k * sizeof(size_t));                                      \
+        _topk_->buckets = alloc->malloc(k * sizeof(struct SNAME##_bucket));                     \
+        _topk_->spare = alloc->malloc(k * sizeof(size_t));                                      \
+        _topk_->index =                                                                         \
+            PFX##_index_new_custom(k, CMC_TOPK_INDEX_LOAD, compare, hash, alloc);               \
+                                                                                                \
+        if (!_topk_->counters || !_topk_->order || !_topk_->buckets || !_topk_->spare ||        \
+            !_topk_->index)                                                                     \
+        {                                                                                       \
+            if (_topk_->index)                                                                  \
+                PFX##_index_free(_topk_->index, NULL);                                          \
+                                                                                                \
+            alloc->free(_topk_->counters);                                                      \
+            alloc->free(_topk_->order);                                                         \
+            alloc->free(_topk_->buckets);                                                       \
+            alloc->free(_topk_->spare);                                                         \
+            alloc->free(_topk_);                                                                \
+                                                                                                \
+            return NULL;                                                                        \
+        }                                                                                       \
+                                                                                                \
+        _topk_->k = k;                                                                          \
+        _topk_->cmp = compare;                                                                  \
+        _topk_->hash = hash;                                                                    \
+        _topk_->alloc = alloc;                                                                  \
+                                                                                                \
+        PFX##_impl_reset(_topk_);                                                               \
+                                                                                                \
+        return _topk_;                                                                          \
+    }                                                                                           \
+                                                                                                \
+    void PFX##_clear(struct SNAME *_topk_, void (*deallocator)(V))                              \
+    {                                                                                           \
+        if (deallocator)                                                                        \
+        {                                                                                       \
+            for (size_t i = 0; i < _topk_->k; i++)                                              \
+            {                                                                                   \
+                if (_topk_->counters[i].count > 0)                                              \
+                    deallocator(_topk_->counters[i].value);                                     \
+            }                                                                                   \
+        }                                                                                       \
+                                                                                                \
+        PFX##_index_clear(_topk_->index, NULL);                                                 \
+        PFX##_impl_reset(_topk_);                                                               \
+    }                                                                                           \
+                                                                                                \
+    void PFX##_free(struct SNAME *_topk_, void (*deallocator)(V))                               \
+    {                                                                                           \
+        PFX##_clear(_topk_, deallocator);                                                       \
+        PFX##_index_free(_topk_->index, NULL);                                                  \
+                                                                                                \
+        _topk_->alloc->free(_topk_->counters);                                                  \
+        _topk_->alloc->free(_topk_->order);                                                     \
+        _topk_->alloc->free(_topk_->buckets);                                                   \
+        _topk_->alloc->free(_topk_->spare);                                                     \
+        _topk_->alloc->free(_topk_);                                                            \
+    }                                                                                           \
+                                                                                                \
+    /* Counts an element. When k elements are already counted, the one with */                  \
+    /* the smallest count is given to the deallocator and replaced. Returns */                  \
+    /* false if the element could not be counted */                                             \
+    bool PFX##_insert(struct SNAME *_topk_, V element, void (*deallocator)(V))                  \
+    {                                                                                           \
+        size_t *slot = PFX##_index_get_ref(_topk_->index, element);                             \
+                                                                                                \
+        if (slot)                                                                               \
+        {                                                                                       \
+            PFX##_impl_increment(_topk_, *slot);                                                \
+            _topk_->total++;                                                                    \
+                                                                                                \
+            return true;                                                                        \
+        }                                                                                       \
+                                                                                                \
+        /* The counter with the smallest count, which is not in use if any is */                \
+        size_t victim = _topk_->order[0];                                                       \
+        struct SNAME##_counter *counter = &(_topk_->counters[victim]);                          \
+                                                                                                \
+        if (!PFX##_index_insert(_topk_->index, element, victim))                                \
+            return false;                                                                       \
+                                                                                                \
+        if (counter->count > 0)                                                                 \
+        {                                                                                       \
+            PFX##_index_remove(_topk_->index, counter->value, NULL);                            \
+                                                                                                \
+            if (deallocator)                                                                    \
+                deallocator(counter->value);                                                    \
+        }                                                                                       \
+        else                                                                                    \
+            _topk_->count++;                                                                    \
+                                                                                                \
+        counter->value = element;                                                               \
+        counter->error = counter->count;                                                        \
+                                                                                                \
+        PFX##_impl_increment(_topk_, victim);                                                   \
+        _topk_->total++;                                                                        \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    /* Writes the n elements with the greatest counts to values, from the */                    \
+    /* greatest down, and their counts and errors to counts and errors if */                    \
+    /* they are not NULL. Takes O(n). Returns how many were written */                          \
+    size_t PFX##_top(struct SNAME *_topk_, size_t n, V *values, size_t *counts, size_t *errors) \
+    {                                                                                           \
+        if (n > _topk_->count)                                                                  \
+            n = _topk_->count;                                                                  \
+                                                                                                \
+        for (size_t i = 0; i < n; i++)                                                          \
+        {                                                                                       \
+            struct SNAME##_counter *counter =                                                   \
+                &(_topk_->counters[_topk_->order[_topk_->k - 1 - i]]);                          \
+                                                                                                \
+            values[i] = counter->value;                                                         \
+                                                                                                \
+            if (counts)                                                                         \
+                counts[i] = counter->count;                                                     \
+            if (errors)                                                                         \
+                errors[i] = counter->error;                                                     \
+        }                                                                                       \
+                                                                                                \
+        return n;                                                                               \
+    }                                                                                           \
+                                                                                                \
+    /* The estimated count of an element, or 0 if it is not being counted */                    \
+    size_t PFX##_count_of(struct SNAME *_topk_, V element)                                      \
+    {                                                                                           \
+        struct SNAME##_counter *counter = PFX##_impl_counter(_topk_, element);                  \
+                                                                                                \
+        return counter ? counter->count : 0;                                                    \
+    }                                                                                           \
+                                                                                                \
+    /* How much the count of an element might be above its real count */                        \
+    size_t PFX##_error_of(struct SNAME *_topk_, V element)                                      \
+    {                                                                                           \
+        struct SNAME##_counter *counter = PFX##_impl_counter(_topk_, element);                  \
+                                                                                                \
+        return counter ? counter->error : 0;                                                    \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_contains(struct SNAME *_topk_, V element)                                        \
+    {                                                                                           \
+        return PFX##_impl_counter(_topk_, element) != NULL;                                     \
+    }                                                                                           \
+                                                                                                \
+    bool PFX##_empty(struct SNAME *_topk_)                                                      \
+    {                                                                                           \
+        return _topk_->count == 0;                                                              \
+    }                                                                                           \
+                                                                                                \
+    size_t PFX##_count(struct SNAME *_topk_)                                                    \
+    {                                                                                           \
+        return _topk_->count;                                                                   \
+    }                                                                                           \
+                                                                                                \
+    size_t PFX##_k(struct SNAME *_topk_)                                                        \
+    {                                                                                           \
+        return _topk_->k;                                                                       \
+    }                                                                                           \
+                                                                                                \
+    size_t PFX##_total(struct SNAME *_topk_)                                                    \
+    {                                                                                           \
+        return _topk_->total;                                                                   \
+    }                                                                                           \
+                                                                                                \
+    size_t PFX##_memory_usage(struct SNAME *_topk_)                                             \
+    {                                                                                           \
+        size_t per_counter = sizeof(struct SNAME##_counter) + sizeof(struct SNAME##_bucket) +   \
+                             2 * sizeof(size_t);                                                \
+                                                                                                \
+        return sizeof(struct SNAME) + _topk_->k * per_counter +                                 \
+               PFX##_index_memory_usage(_topk_->index);                                         \
+    }                                                                                           \
+                                                                                                \
+    struct cmc_string PFX##_to_string(struct SNAME *_topk_)                                     \
+    {                                                                                           \
+        struct cmc_string str;                                                                  \
+        struct SNAME *t_ = _topk_;                                                              \
+        const char *name = #SNAME;                                                              \
+                                                                                                \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_topk, name, t_, t_->counters, t_->k,     \
+                 t_->count, t_->total, t_->index, t_->cmp, t_->hash);                           \
+                                                                                                \
+        return str;                                                                             \
+    }                                                                                           \
+                                                                                                \
+    /* Every counter out of use, in a single bucket of count 0 */                               \
+    static void PFX##_impl_reset(struct SNAME *_topk_)                                          \
+    {                                                                                           \
+        size_t k = _topk_->k;                                                                   \
+                                                                                                \
+        for (size_t i = 0; i < k; i++)                                                          \
+        {                                                                                       \
+            _topk_->counters[i].count = 0;                                                      \
+            _topk_->counters[i].error = 0;                                                      \
+            _topk_->counters[i].position = i;                                                   \
+            _topk_->counters[i].bucket = 0;                                                     \
+            _topk_->order[i] = i;                                                               \
+            _topk_->spare[i] = k - 1 - i;                                                       \
+        }                                                                                       \
+                                                                                                \
+        _topk_->buckets[0].first = 0;                                                           \
+        _topk_->buckets[0].last = k - 1;                                                        \
+        _topk_->spare_count = k - 1;                                                            \
+        _topk_->count = 0;                                                                      \
+        _topk_->total = 0;                                                                      \
+    }                                                                                           \
+                                                                                                \
+    /* Moves a counter to the end of its group before incrementing it, so */                    \
+    /* that order stays sorted */                                                               \
+    static void PFX##_impl_increment(struct SNAME *_topk_, size_t slot)                         \
+    {                                                                                           \
+        struct SNAME##_counter *counters = _topk_->counters;                                    \
+        struct SNAME##_counter *counter = &(counters[slot]);                                    \
+        struct SNAME##_bucket *bucket = &(_topk_->buckets[counter->bucket]);                    \
+                                                                                                \
+        size_t p = counter->position;                                                           \
+        size_t last = bucket->last;                                                             \
+        size_t other = _topk_->order[last];                                                     \
+                                                                                                \
+        _topk_->order[p] = other;                                                               \
+        _topk_->order[last] = slot;                                                             \
+        counters[other].position = p;                                                           \
+        counter->position = last;                                                               \
+                                                                                                \
+        if (bucket->first == last)                                                              \
+            _topk_->spare[_topk_->spare_count++] = counter->bucket;                             \
+        else                                                                                    \
+            bucket->last--;                                                                     \
+                                                                                                \
+        counter->count++;                                                                       \
+                                                                                                \
+        /* Joins the group after it if it has the new count */                                  \
+        if (last + 1 < _topk_->k && counters[_topk_->order[last + 1]].count == counter->count)  \
+        {                                                                                       \
+            counter->bucket = counters[_topk_->order[last + 1]].bucket;                         \
+            _topk_->buckets[counter->bucket].first = last;                                      \
+        }                                                                                       \
+        else                                                                                    \
+        {                                                                                       \
+            counter->bucket = _topk_->spare[--_topk_->spare_count];                             \
+            _topk_->buckets[counter->bucket].first = last;                                      \
+            _topk_->buckets[counter->bucket].last = last;                                       \
+        }                                                                                       \
+    }                                                                                           \
+                                                                                                \
+    static struct SNAME##_counter *PFX##_impl_counter(struct SNAME *_topk_, V element)          \
+    {                                                                                           \
+        size_t *slot = PFX##_index_get_ref(_topk_->index, element);                             \
+                                                                                                \
+        if (!slot)                                                                              \
+            return NULL;                                                                        \
+                                                                                                \
+        return &(_topk_->counters[*slot]);                                                      \
+    }
+
+#endif /* CMC_TOPK_H */
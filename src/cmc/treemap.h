@@ -14,6 +14,25 @@
  * A TreeMap is an implementation of a Map that keeps its keys sorted. Like a
  * Map, it has only unique keys. This implementation uses a balanced binary
  * tree called AVL Tree that uses the height of nodes to keep its keys balanced.
+ *
+ * Nodes are allocated in chunks that are only freed by clear and free, and
+ * removed nodes are reused by the next insertions. A deallocator given to
+ * clear or free is called going through the chunks in memory order, so
+ * tearing down a large tree does not chase pointers from node to node.
+ *
+ * Every node also keeps the size of its subtree, so the rank of a key, the
+ * key at a given position and the iterator jumps all take log(n).
+ *
+ * The map can also keep a finger to the last node accessed. With it enabled,
+ * get, insert, update, remove and contains go up from that node to the lowest
+ * ancestor that can hold the key and search down from there, so runs of keys
+ * that are close to each other take amortized log(d), where d is how far the
+ * key is from the previous one.
+ *
+ * get_many and contains_many look up a batch of keys by going down the tree
+ * for several of them at once, one level at a time, and prefetching the next
+ * node of each, so their cache misses overlap instead of following each
+ * other. Keys in ascending order are looked up with the finger instead.
  */
 
 #ifndef CMC_TREEMAP_H
@@ -24,7 +43,48 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_serial.h"
 #include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* Maximum amount of nodes allocated at once. The first chunk of a tree has 4 */
+/* nodes and each one after it has twice as many as the one before */
+#ifndef CMC_TREE_CHUNK_SIZE
+#define CMC_TREE_CHUNK_SIZE 256
+#endif
+
+#ifndef CMC_IMPL_TREE_THREADS
+#define CMC_IMPL_TREE_THREADS
+
+/* Defining CMC_TREE_THREADED before including any tree makes every node */
+/* also point to the nodes before and after it in order, updated by insert */
+/* and remove. The iterators, min and max then follow a single pointer */
+/* instead of going up and down the tree, for two more pointers per node */
+#ifdef CMC_TREE_THREADED
+#define CMC_IMPL_TREE_THREAD_FIELDS(SNAME, a, b) \
+    struct SNAME##_node *a;                      \
+    struct SNAME##_node *b;
+#define CMC_IMPL_TREE_THREADED(...) __VA_ARGS__
+#else
+#define CMC_IMPL_TREE_THREAD_FIELDS(SNAME, a, b)
+#define CMC_IMPL_TREE_THREADED(...)
+#endif
+
+#endif /* CMC_IMPL_TREE_THREADS */
+
+#ifndef CMC_IMPL_TREE_BATCH
+/* Batched lookups go down the tree for this many keys at once, one level */
+/* of each search at a time, so the cache misses of the batch overlap */
+#define CMC_IMPL_TREE_BATCH 16
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CMC_IMPL_TREE_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define CMC_IMPL_TREE_PREFETCH(address)
+#endif
+#endif /* CMC_IMPL_TREE_BATCH */
 
 /* to_string format */
 static const char *cmc_string_fmt_treemap = "%s at %p { root:%p, count:%" PRIuMAX ", cmp:%p }";
@@ -39,6 +99,19 @@ static const char *cmc_string_fmt_treemap = "%s at %p { root:%p, count:%" PRIuMA
 #define CMC_WRAPGEN_TREEMAP_SOURCE(PFX, SNAME, K, V) \
     CMC_GENERATE_TREEMAP_SOURCE(PFX, SNAME, K, V)
 
+/* Same as CMC_GENERATE_TREEMAP but keys are compared by calling CMP */
+/* directly, so the compiler can inline it. The function given to new is */
+/* still stored but only used by copy_of and to_string */
+#define CMC_GENERATE_TREEMAP_EX(PFX, SNAME, K, V, CMP) \
+    CMC_GENERATE_TREEMAP_HEADER(PFX, SNAME, K, V)      \
+    CMC_GENERATE_TREEMAP_EX_SOURCE(PFX, SNAME, K, V, CMP)
+
+#define CMC_GENERATE_TREEMAP_SOURCE(PFX, SNAME, K, V) \
+    CMC_IMPL_TREEMAP_SOURCE(PFX, SNAME, K, V, _map_->cmp)
+
+#define CMC_GENERATE_TREEMAP_EX_SOURCE(PFX, SNAME, K, V, CMP) \
+    CMC_IMPL_TREEMAP_SOURCE(PFX, SNAME, K, V, CMP)
+
 /* HEADER ********************************************************************/
 #define CMC_GENERATE_TREEMAP_HEADER(PFX, SNAME, K, V)                                             \
                                                                                                   \
@@ -59,6 +132,28 @@ static const char *cmc_string_fmt_treemap = "%s at %p { root:%p, count:%" PRIuMA
                                                                                                   \
         /* Function that returns an iterator to the end of the treemap */                         \
         struct SNAME##_iter (*it_end)(struct SNAME *);                                            \
+                                                                                                  \
+        /* Chunks that the nodes are allocated from, the newest one first */                      \
+        struct SNAME##_chunk *chunks;                                                             \
+                                                                                                  \
+        /* Removed nodes that are reused before the newest chunk, linked by */                    \
+        /* their parent */                                                                        \
+        struct SNAME##_node *free_nodes;                                                          \
+                                                                                                  \
+        /* Nodes of the newest chunk that were never used */                                      \
+        size_t chunk_left;                                                                        \
+                                                                                                  \
+        /* First and last nodes in order, if CMC_TREE_THREADED is defined */                      \
+        CMC_IMPL_TREE_THREAD_FIELDS(SNAME, first, last)                                           \
+                                                                                                  \
+        /* Last node accessed, where searches start from if use_finger is set */                  \
+        struct SNAME##_node *finger;                                                              \
+                                                                                                  \
+        /* If searches start from the finger instead of the root */                               \
+        bool use_finger;                                                                          \
+                                                                                                  \
+        /* Custom allocation functions */                                                         \
+        struct cmc_alloc_node *alloc;                                                             \
     };                                                                                            \
                                                                                                   \
     /* Treemap Node */                                                                            \
@@ -73,6 +168,9 @@ static const char *cmc_string_fmt_treemap = "%s at %p { root:%p, count:%" PRIuMA
         /* Node height used by the AVL tree to keep it strictly balanced */                       \
         unsigned char height;                                                                     \
                                                                                                   \
+        /* Amount of nodes in the subtree of this node, itself included */                        \
+        size_t size;                                                                              \
+                                                                                                  \
         /* Right child node or subtree */                                                         \
         struct SNAME##_node *right;                                                               \
                                                                                                   \
@@ -81,6 +179,22 @@ static const char *cmc_string_fmt_treemap = "%s at %p { root:%p, count:%" PRIuMA
                                                                                                   \
         /* Parent node */                                                                         \
         struct SNAME##_node *parent;                                                              \
+                                                                                                  \
+        /* Nodes before and after this one, if CMC_TREE_THREADED is defined */                    \
+        CMC_IMPL_TREE_THREAD_FIELDS(SNAME, prev, next)                                            \
+    };                                                                                            \
+                                                                                                  \
+    /* Treemap Chunk of Nodes */                                                                  \
+    struct SNAME##_chunk                                                                          \
+    {                                                                                             \
+        /* Chunk allocated before this one */                                                     \
+        struct SNAME##_chunk *next;                                                               \
+                                                                                                  \
+        /* Amount of nodes in the chunk */                                                        \
+        size_t capacity;                                                                          \
+                                                                                                  \
+        /* Nodes given in order from the last one to the first */                                 \
+        struct SNAME##_node nodes[];                                                              \
     };                                                                                            \
                                                                                                   \
     /* Treemap Iterator */                                                                        \
@@ -98,6 +212,10 @@ static const char *cmc_string_fmt_treemap = "%s at %p { root:%p, count:%" PRIuMA
         /* The last node in the iteration */                                                      \
         struct SNAME##_node *last;                                                                \
                                                                                                   \
+        /* Amount of nodes from first to last. Iterators over part of the */                      \
+        /* tree have SIZE_MAX until it is needed */                                               \
+        size_t count;                                                                             \
+                                                                                                  \
         /* Keeps track of relative index to the iteration of elements */                          \
         size_t index;                                                                             \
                                                                                                   \
@@ -108,36 +226,103 @@ static const char *cmc_string_fmt_treemap = "%s at %p { root:%p, count:%" PRIuMA
         bool end;                                                                                 \
     };                                                                                            \
                                                                                                   \
+    /* State of a treemap being streamed by serialize */                                          \
+    struct SNAME##_serializer                                                                     \
+    {                                                                                             \
+        struct cmc_serial_writer writer;                                                          \
+                                                                                                  \
+        /* Goes through the treemap, which must not change meanwhile */                           \
+        struct SNAME##_iter iter;                                                                 \
+    };                                                                                            \
+                                                                                                  \
+    /* State of a treemap being received by deserialize */                                        \
+    struct SNAME##_deserializer                                                                   \
+    {                                                                                             \
+        struct cmc_serial_reader reader;                                                          \
+                                                                                                  \
+        /* Given to the treemap once the header arrives */                                        \
+        int (*compare)(K, K);                                                                     \
+                                                                                                  \
+        /* NULL until the header arrives */                                                       \
+        struct SNAME *result;                                                                     \
+    };                                                                                            \
+                                                                                                  \
     /* Collection Functions */                                                                    \
     /* Collection Allocation and Deallocation */                                                  \
     struct SNAME *PFX##_new(int (*compare)(K, K));                                                \
+    struct SNAME *PFX##_new_custom(int (*compare)(K, K), struct cmc_alloc_node *alloc);           \
+    struct SNAME *PFX##_new_from_sorted(int (*compare)(K, K), K *keys, V *values, size_t n);      \
+    struct SNAME *PFX##_new_from(int (*compare)(K, K), K *keys, V *values, size_t n);             \
     void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V));                             \
     void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V));                              \
+    void PFX##_release(struct SNAME *_map_);                                                      \
     /* Collection Input and Output */                                                             \
     bool PFX##_insert(struct SNAME *_map_, K key, V value);                                       \
+    size_t PFX##_insert_sorted_many(struct SNAME *_map_, K *keys, V *values, size_t n);           \
+    struct SNAME *PFX##_split(struct SNAME *_map_, K key);                                        \
+    bool PFX##_join(struct SNAME *_map1_, struct SNAME *_map2_);                                  \
+    V *PFX##_get_or_insert(struct SNAME *_map_, K key, V default_value);                          \
+    bool PFX##_upsert(struct SNAME *_map_, K key, V value);                                       \
     bool PFX##_update(struct SNAME *_map_, K key, V new_value, V *old_value);                     \
     bool PFX##_remove(struct SNAME *_map_, K key, V *out_value);                                  \
+    size_t PFX##_remove_if(struct SNAME *_map_, bool (*pred)(K, V),                               \
+                           void (*deallocator)(K, V));                                            \
     /* Element Access */                                                                          \
     bool PFX##_max(struct SNAME *_map_, K *key, V *value);                                        \
     bool PFX##_min(struct SNAME *_map_, K *key, V *value);                                        \
+    bool PFX##_floor(struct SNAME *_map_, K key, K *out_key, V *out_value);                       \
+    bool PFX##_ceiling(struct SNAME *_map_, K key, K *out_key, V *out_value);                     \
+    struct SNAME##_iter PFX##_lower_bound(struct SNAME *_map_, K key);                            \
+    struct SNAME##_iter PFX##_upper_bound(struct SNAME *_map_, K key);                            \
+    size_t PFX##_rank(struct SNAME *_map_, K key);                                                \
+    bool PFX##_select(struct SNAME *_map_, size_t index, K *key, V *value);                       \
     V PFX##_get(struct SNAME *_map_, K key);                                                      \
     V *PFX##_get_ref(struct SNAME *_map_, K key);                                                 \
+    size_t PFX##_get_many(struct SNAME *_map_, K *CMC_RESTRICT keys, size_t n,                    \
+                          V *CMC_RESTRICT out, bool *CMC_RESTRICT found);                         \
     /* Collection State */                                                                        \
     bool PFX##_contains(struct SNAME *_map_, K key);                                              \
-    bool PFX##_empty(struct SNAME *_map_);                                                        \
-    size_t PFX##_count(struct SNAME *_map_);                                                      \
+    size_t PFX##_contains_many(struct SNAME *_map_, K *keys, size_t n, bool *found);              \
+    CMC_PURE bool PFX##_empty(struct SNAME *_map_);                                               \
+    CMC_PURE size_t PFX##_count(struct SNAME *_map_);                                             \
+    size_t PFX##_memory_usage(struct SNAME *_map_);                                               \
+    void PFX##_set_finger(struct SNAME *_map_, bool enabled);                                     \
     /* Collection Utility */                                                                      \
     struct SNAME *PFX##_copy_of(struct SNAME *_map_, K (*key_copy_func)(K),                       \
                                 V (*value_copy_func)(V));                                         \
+    size_t PFX##_to_array(struct SNAME *_map_, K *CMC_RESTRICT keys, V *CMC_RESTRICT values,      \
+                          size_t size);                                                           \
     bool PFX##_equals(struct SNAME *_map1_, struct SNAME *_map2_, int (*value_comparator)(V, V)); \
     struct cmc_string PFX##_to_string(struct SNAME *_map_);                                       \
-                                                                                                  \
+    bool PFX##_to_string_full(struct SNAME *_map_, struct cmc_string_builder *builder,            \
+                              const char *elem_fmt);                                              \
+    bool PFX##_write(struct SNAME *_map_, FILE *file, void (*fmt)(FILE *, K, V));                 \
+    bool PFX##_write_fd(struct SNAME *_map_, int fd, void (*fmt)(struct cmc_dump *, K, V));       \
+    /* Collection Serialization */                                                                \
+    bool PFX##_save(struct SNAME *_map_, FILE *file, bool (*key_writer)(K, FILE *),               \
+                    bool (*value_writer)(V, FILE *));                                             \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(K, K),                                 \
+                                bool (*key_reader)(K *, FILE *),                                  \
+                                bool (*value_reader)(V *, FILE *));                               \
+    bool PFX##_save_flat(struct SNAME *_map_, FILE *file, size_t step);                           \
+    bool PFX##_serialize_begin(struct SNAME##_serializer *serializer, struct SNAME *_map_,        \
+                               size_t block_size, bool checksum);                                 \
+    size_t PFX##_serialize_next(struct SNAME##_serializer *serializer, void *buffer,              \
+                                size_t size);                                                     \
+    void PFX##_serialize_end(struct SNAME##_serializer *serializer);                              \
+    bool PFX##_deserialize_begin(struct SNAME##_deserializer *deserializer, int (*compare)(K, K), \
+                                 size_t block_size);                                              \
+    bool PFX##_deserialize_next(struct SNAME##_deserializer *deserializer, const void *buffer,    \
+                                size_t size);                                                     \
+    struct SNAME *PFX##_deserialize_end(struct SNAME##_deserializer *deserializer);               \
     /* Iterator Functions */                                                                      \
     /* Iterator Allocation and Deallocation */                                                    \
     struct SNAME##_iter *PFX##_iter_new(struct SNAME *target);                                    \
     void PFX##_iter_free(struct SNAME##_iter *iter);                                              \
     /* Iterator Initialization */                                                                 \
     void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);                        \
+    void PFX##_iter_init_range(struct SNAME##_iter *iter, struct SNAME *target, K lo,             \
+                               K hi);                                                             \
     /* Iterator State */                                                                          \
     bool PFX##_iter_start(struct SNAME##_iter *iter);                                             \
     bool PFX##_iter_end(struct SNAME##_iter *iter);                                               \
@@ -156,13 +341,54 @@ static const char *cmc_string_fmt_treemap = "%s at %p { root:%p, count:%" PRIuMA
     size_t PFX##_iter_index(struct SNAME##_iter *iter);                                           \
                                                                                                   \
 /* SOURCE ********************************************************************/
-#define CMC_GENERATE_TREEMAP_SOURCE(PFX, SNAME, K, V)                                            \
+#define CMC_IMPL_TREEMAP_SOURCE(PFX, SNAME, K, V, CMP)                                           \
                                                                                                  \
     /* Implementation Detail Functions */                                                        \
-    static struct SNAME##_node *PFX##_impl_new_node(K key, V value);                             \
+    static inline int PFX##_impl_cmp(struct SNAME *_map_, K a, K b);                             \
+    static struct SNAME##_node *PFX##_impl_new_node(struct SNAME *_map_, K key, V value);        \
+    static void PFX##_impl_release_node(struct SNAME *_map_, struct SNAME##_node *node);         \
+    static void PFX##_impl_link_node(struct SNAME *_map_, struct SNAME##_node *node);            \
+    static void PFX##_impl_unlink_node(struct SNAME *_map_, struct SNAME##_node *node);          \
+    static struct SNAME##_node *PFX##_impl_first_node(struct SNAME *_map_);                      \
+    static struct SNAME##_node *PFX##_impl_last_node(struct SNAME *_map_);                       \
+    static struct SNAME##_node *PFX##_impl_next_node(struct SNAME##_node *node);                 \
+    static struct SNAME##_node *PFX##_impl_prev_node(struct SNAME##_node *node);                 \
+    static void PFX##_impl_thread_nodes(struct SNAME *_map_, struct SNAME##_node **nodes,        \
+                                        size_t n);                                               \
+    static struct SNAME##_node *PFX##_impl_join_nodes(struct SNAME *_map_,                       \
+                                                    struct SNAME##_node *left,                   \
+                                                    struct SNAME##_node *node,                   \
+                                                    struct SNAME##_node *right);                 \
+    static void PFX##_impl_split_nodes(struct SNAME *_map_, struct SNAME##_node *node,           \
+                                       K key, struct SNAME##_node **left,                        \
+                                       struct SNAME##_node **right);                             \
+    static struct SNAME##_node *PFX##_impl_detach_first(struct SNAME *_map_);                    \
+    static void PFX##_impl_take_chunks(struct SNAME *_map1_, struct SNAME *_map2_);              \
+    static struct SNAME##_node *PFX##_impl_build_nodes(struct SNAME##_node **nodes, size_t n,    \
+                                                     struct SNAME##_node *parent);               \
+    static bool PFX##_impl_build(struct SNAME *_map_, K *keys, V *values, size_t n,              \
+                                 struct SNAME##_node *parent, struct SNAME##_node **result);     \
     static struct SNAME##_node *PFX##_impl_get_node(struct SNAME *_map_, K key);                 \
+    static void PFX##_impl_get_batch(struct SNAME *_map_, K *keys, size_t n,                     \
+                                     struct SNAME##_node **nodes);                               \
+    static struct SNAME##_node *PFX##_impl_search_start(struct SNAME *_map_, K key);             \
+    static struct SNAME##_node *PFX##_impl_ceiling_node(struct SNAME *_map_, K key,              \
+                                                        bool strict);                            \
+    static struct SNAME##_node *PFX##_impl_floor_node(struct SNAME *_map_, K key,                \
+                                                      bool strict);                              \
+    static void PFX##_impl_iter_init_nodes(struct SNAME##_iter *iter, struct SNAME *target,      \
+                                           struct SNAME##_node *first,                           \
+                                           struct SNAME##_node *last);                           \
+    static size_t PFX##_impl_iter_count(struct SNAME##_iter *iter);                              \
+    static size_t PFX##_impl_node_rank(struct SNAME##_node *node);                               \
+    static struct SNAME##_node *PFX##_impl_select_node(struct SNAME *_map_, size_t index);       \
+    static void PFX##_impl_iter_seek(struct SNAME##_iter *iter, size_t index);                   \
+    static struct SNAME##_node *PFX##_impl_insert_node(struct SNAME *_map_, K key, V value,      \
+                                                       struct SNAME##_node **found);             \
     static unsigned char PFX##_impl_h(struct SNAME##_node *node);                                \
     static unsigned char PFX##_impl_hupdate(struct SNAME##_node *node);                          \
+    static size_t PFX##_impl_s(struct SNAME##_node *node);                                       \
+    static size_t PFX##_impl_supdate(struct SNAME##_node *node);                                 \
     static void PFX##_impl_rotate_right(struct SNAME##_node **Z);                                \
     static void PFX##_impl_rotate_left(struct SNAME##_node **Z);                                 \
     static void PFX##_impl_rebalance(struct SNAME *_map_, struct SNAME##_node *node);            \
@@ -171,14 +397,31 @@ static const char *cmc_string_fmt_treemap = "%s at %p { root:%p, count:%" PRIuMA
                                                                                                  \
     struct SNAME *PFX##_new(int (*compare)(K, K))                                                \
     {                                                                                            \
-        struct SNAME *_map_ = malloc(sizeof(struct SNAME));                                      \
+        return PFX##_new_custom(compare, NULL);                                                  \
+    }                                                                                            \
+                                                                                                 \
+    struct SNAME *PFX##_new_custom(int (*compare)(K, K), struct cmc_alloc_node *alloc)           \
+    {                                                                                            \
+        if (!alloc)                                                                              \
+            alloc = &cmc_alloc_node_default;                                                     \
                                                                                                  \
-        if (!_map_)                                                                              \
+        struct SNAME *_map_ = alloc->malloc(sizeof(struct SNAME));                               \
+                                                                                                 \
+        if (CMC_UNLIKELY(!_map_))                                                                \
             return NULL;                                                                         \
                                                                                                  \
+        _map_->alloc = alloc;                                                                    \
+                                                                                                 \
         _map_->count = 0;                                                                        \
         _map_->root = NULL;                                                                      \
         _map_->cmp = compare;                                                                    \
+        _map_->chunks = NULL;                                                                    \
+                                                                                                 \
+        CMC_IMPL_TREE_THREADED(_map_->first = NULL; _map_->last = NULL;)                         \
+        _map_->free_nodes = NULL;                                                                \
+        _map_->chunk_left = 0;                                                                   \
+        _map_->finger = NULL;                                                                    \
+        _map_->use_finger = false;                                                               \
                                                                                                  \
         _map_->it_start = PFX##_impl_it_start;                                                   \
         _map_->it_end = PFX##_impl_it_end;                                                       \
@@ -186,127 +429,227 @@ static const char *cmc_string_fmt_treemap = "%s at %p { root:%p, count:%" PRIuMA
         return _map_;                                                                            \
     }                                                                                            \
                                                                                                  \
-    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V))                             \
+    /* Builds a perfectly balanced tree in linear time from n keys in strictly */                \
+    /* ascending order and their values. Returns NULL if the keys are not */                     \
+    /* sorted or have duplicates */                                                              \
+    struct SNAME *PFX##_new_from_sorted(int (*compare)(K, K), K *keys, V *values, size_t n)      \
     {                                                                                            \
-        struct SNAME##_node *scan = _map_->root;                                                 \
-        struct SNAME##_node *up = NULL;                                                          \
+        struct SNAME *_map_ = PFX##_new(compare);                                                \
                                                                                                  \
-        while (scan != NULL)                                                                     \
+        if (CMC_UNLIKELY(!_map_))                                                                \
+            return NULL;                                                                         \
+                                                                                                 \
+        for (size_t i = 1; i < n; i++)                                                           \
         {                                                                                        \
-            if (scan->left != NULL)                                                              \
+            if (PFX##_impl_cmp(_map_, keys[i - 1], keys[i]) >= 0)                                \
             {                                                                                    \
-                struct SNAME##_node *left = scan->left;                                          \
-                                                                                                 \
-                scan->left = up;                                                                 \
-                up = scan;                                                                       \
-                scan = left;                                                                     \
+                PFX##_free(_map_, NULL);                                                         \
+                return NULL;                                                                     \
             }                                                                                    \
-            else if (scan->right != NULL)                                                        \
-            {                                                                                    \
-                struct SNAME##_node *right = scan->right;                                        \
+        }                                                                                        \
                                                                                                  \
-                scan->left = up;                                                                 \
-                scan->right = NULL;                                                              \
-                up = scan;                                                                       \
-                scan = right;                                                                    \
-            }                                                                                    \
-            else                                                                                 \
+        if (!PFX##_impl_build(_map_, keys, values, n, NULL, &(_map_->root)))                     \
+        {                                                                                        \
+            /* Every node built so far belongs to a chunk */                                     \
+            PFX##_free(_map_, NULL);                                                             \
+            return NULL;                                                                         \
+        }                                                                                        \
+                                                                                                 \
+        _map_->count = n;                                                                        \
+                                                                                                 \
+        return _map_;                                                                            \
+    }                                                                                            \
+                                                                                                 \
+    /* Creates a map with n keys in any order and their values, keeping only */                  \
+    /* the first value of a repeated key. Keys at the start that are in */                       \
+    /* strictly ascending order are built into a balanced tree in linear time */                 \
+    /* and the rest are inserted */                                                              \
+    struct SNAME *PFX##_new_from(int (*compare)(K, K), K *keys, V *values, size_t n)             \
+    {                                                                                            \
+        struct SNAME *_map_ = PFX##_new(compare);                                                \
+                                                                                                 \
+        if (CMC_UNLIKELY(!_map_))                                                                \
+            return NULL;                                                                         \
+                                                                                                 \
+        size_t sorted = n > 0 ? 1 : 0;                                                           \
+                                                                                                 \
+        while (sorted < n && PFX##_impl_cmp(_map_, keys[sorted - 1], keys[sorted]) < 0)          \
+            sorted++;                                                                            \
+                                                                                                 \
+        if (!PFX##_impl_build(_map_, keys, values, sorted, NULL, &(_map_->root)))                \
+        {                                                                                        \
+            PFX##_free(_map_, NULL);                                                             \
+            return NULL;                                                                         \
+        }                                                                                        \
+                                                                                                 \
+        _map_->count = sorted;                                                                   \
+                                                                                                 \
+        for (size_t i = sorted; i < n; i++)                                                      \
+        {                                                                                        \
+            if (!PFX##_insert(_map_, keys[i], values[i]) && !PFX##_contains(_map_, keys[i]))     \
             {                                                                                    \
-                if (up == NULL)                                                                  \
-                {                                                                                \
-                    if (deallocator)                                                             \
-                        deallocator(scan->key, scan->value);                                     \
+                PFX##_free(_map_, NULL);                                                         \
+                return NULL;                                                                     \
+            }                                                                                    \
+        }                                                                                        \
                                                                                                  \
-                    free(scan);                                                                  \
-                    scan = NULL;                                                                 \
-                }                                                                                \
+        return _map_;                                                                            \
+    }                                                                                            \
                                                                                                  \
-                while (up != NULL)                                                               \
-                {                                                                                \
-                    if (deallocator)                                                             \
-                        deallocator(scan->key, scan->value);                                     \
-                                                                                                 \
-                    free(scan);                                                                  \
-                                                                                                 \
-                    if (up->right != NULL)                                                       \
-                    {                                                                            \
-                        scan = up->right;                                                        \
-                        up->right = NULL;                                                        \
-                        break;                                                                   \
-                    }                                                                            \
-                    else                                                                         \
-                    {                                                                            \
-                        scan = up;                                                               \
-                        up = up->left;                                                           \
-                    }                                                                            \
-                }                                                                                \
+    void PFX##_clear(struct SNAME *_map_, void (*deallocator)(K, V))                             \
+    {                                                                                            \
+        /* The nodes are freed with their chunks, so they are only visited if */                 \
+        /* there is a deallocator, and then in the order they are laid out in */                 \
+        /* memory instead of by following the tree */                                            \
+        while (_map_->chunks)                                                                    \
+        {                                                                                        \
+            struct SNAME##_chunk *chunk = _map_->chunks;                                         \
+                                                                                                 \
+            /* Only the newest chunk has nodes that were never used, and the */                  \
+            /* removed ones have no size */                                                      \
+            for (size_t i = _map_->chunk_left; deallocator && i < chunk->capacity; i++)          \
+            {                                                                                    \
+                if (chunk->nodes[i].size != 0)                                                   \
+                    deallocator(chunk->nodes[i].key, chunk->nodes[i].value);                     \
             }                                                                                    \
+                                                                                                 \
+            _map_->chunks = chunk->next;                                                         \
+            _map_->chunk_left = 0;                                                               \
+                                                                                                 \
+            _map_->alloc->free(chunk);                                                           \
         }                                                                                        \
                                                                                                  \
         _map_->count = 0;                                                                        \
         _map_->root = NULL;                                                                      \
+        _map_->free_nodes = NULL;                                                                \
+        _map_->chunk_left = 0;                                                                   \
+                                                                                                 \
+        CMC_IMPL_TREE_THREADED(_map_->first = NULL; _map_->last = NULL;)                         \
+        _map_->finger = NULL;                                                                    \
     }                                                                                            \
                                                                                                  \
     void PFX##_free(struct SNAME *_map_, void (*deallocator)(K, V))                              \
     {                                                                                            \
         PFX##_clear(_map_, deallocator);                                                         \
                                                                                                  \
-        free(_map_);                                                                             \
+        _map_->alloc->free(_map_);                                                               \
+    }                                                                                            \
+                                                                                                 \
+    /* Frees the struct of the collection without visiting its nodes, for an */                  \
+    /* allocator that frees all of them at once like a cmc_arena */                              \
+    void PFX##_release(struct SNAME *_map_)                                                      \
+    {                                                                                            \
+        _map_->alloc->free(_map_);                                                               \
     }                                                                                            \
                                                                                                  \
     bool PFX##_insert(struct SNAME *_map_, K key, V value)                                       \
     {                                                                                            \
-        if (PFX##_empty(_map_))                                                                  \
-        {                                                                                        \
-            _map_->root = PFX##_impl_new_node(key, value);                                       \
+        struct SNAME##_node *existing = NULL;                                                    \
                                                                                                  \
-            if (!_map_->root)                                                                    \
-                return false;                                                                    \
-        }                                                                                        \
-        else                                                                                     \
+        return PFX##_impl_insert_node(_map_, key, value, &existing) != NULL;                     \
+    }                                                                                            \
+                                                                                                 \
+    /* Inserts n keys in ascending order and their values, keeping the value */                  \
+    /* of a key that is already in the map or repeated in the batch, and */                      \
+    /* returns how many were inserted. A batch that is not small next to the */                  \
+    /* map is merged with its nodes in order and the tree is rebuilt from */                     \
+    /* them in O(n + count). A smaller one is inserted key by key with each */                   \
+    /* search starting from the finger left by the previous key. Keys that */                    \
+    /* are not in ascending order are inserted one by one */                                     \
+    size_t PFX##_insert_sorted_many(struct SNAME *_map_, K *keys, V *values, size_t n)           \
+    {                                                                                            \
+        bool sorted = true;                                                                      \
+                                                                                                 \
+        for (size_t i = 1; i < n && sorted; i++)                                                 \
+            sorted = PFX##_impl_cmp(_map_, keys[i - 1], keys[i]) <= 0;                           \
+                                                                                                 \
+        /* The rebuild visits every node, so the batch has to be at least an */                  \
+        /* eighth of the tree */                                                                 \
+        struct SNAME##_node **nodes = NULL;                                                      \
+        size_t bytes = sizeof(struct SNAME##_node *) * (_map_->count + n);                       \
+                                                                                                 \
+        if (n > 0 && sorted && n >= _map_->count / 8)                                            \
+            nodes = _map_->alloc->malloc(bytes);                                                 \
+                                                                                                 \
+        if (!nodes)                                                                              \
         {                                                                                        \
-            struct SNAME##_node *scan = _map_->root;                                             \
-            struct SNAME##_node *parent = scan;                                                  \
+            bool use_finger = _map_->use_finger;                                                 \
+            size_t inserted = 0;                                                                 \
                                                                                                  \
-            while (scan != NULL)                                                                 \
-            {                                                                                    \
-                parent = scan;                                                                   \
+            _map_->use_finger = use_finger || sorted;                                            \
                                                                                                  \
-                if (_map_->cmp(scan->key, key) > 0)                                              \
-                    scan = scan->left;                                                           \
-                else if (_map_->cmp(scan->key, key) < 0)                                         \
-                    scan = scan->right;                                                          \
-                else                                                                             \
-                    return false;                                                                \
-            }                                                                                    \
+            for (size_t i = 0; i < n; i++)                                                       \
+                inserted += PFX##_insert(_map_, keys[i], values[i]);                             \
                                                                                                  \
-            struct SNAME##_node *node;                                                           \
+            PFX##_set_finger(_map_, use_finger);                                                 \
                                                                                                  \
-            if (_map_->cmp(parent->key, key) > 0)                                                \
-            {                                                                                    \
-                parent->left = PFX##_impl_new_node(key, value);                                  \
+            return inserted;                                                                     \
+        }                                                                                        \
                                                                                                  \
-                if (!parent->left)                                                               \
-                    return false;                                                                \
+        struct SNAME##_node *scan = PFX##_impl_first_node(_map_);                                \
+        size_t total = 0;                                                                        \
+        size_t i = 0;                                                                            \
                                                                                                  \
-                parent->left->parent = parent;                                                   \
-                node = parent->left;                                                             \
+        while (scan != NULL || i < n)                                                            \
+        {                                                                                        \
+            if (i < n && total > 0 &&                                                            \
+                PFX##_impl_cmp(_map_, nodes[total - 1]->key, keys[i]) == 0)                      \
+                i++;                                                                             \
+            else if (i == n ||                                                                   \
+                     (scan != NULL && PFX##_impl_cmp(_map_, scan->key, keys[i]) <= 0))           \
+            {                                                                                    \
+                nodes[total++] = scan;                                                           \
+                scan = PFX##_impl_next_node(scan);                                               \
+            }                                                                                    \
+            else if ((nodes[total] = PFX##_impl_new_node(_map_, keys[i], values[i])) != NULL)    \
+            {                                                                                    \
+                total++;                                                                         \
+                i++;                                                                             \
             }                                                                                    \
             else                                                                                 \
             {                                                                                    \
-                parent->right = PFX##_impl_new_node(key, value);                                 \
+                /* Out of memory, the rest of the batch is left out */                           \
+                i = n;                                                                           \
+            }                                                                                    \
+        }                                                                                        \
                                                                                                  \
-                if (!parent->right)                                                              \
-                    return false;                                                                \
+        size_t inserted = total - _map_->count;                                                  \
                                                                                                  \
-                parent->right->parent = parent;                                                  \
-                node = parent->right;                                                            \
-            }                                                                                    \
+        _map_->root = PFX##_impl_build_nodes(nodes, total, NULL);                                \
+        _map_->count = total;                                                                    \
+        _map_->finger = NULL;                                                                    \
                                                                                                  \
-            PFX##_impl_rebalance(_map_, node);                                                   \
-        }                                                                                        \
+        PFX##_impl_thread_nodes(_map_, nodes, total);                                            \
                                                                                                  \
-        _map_->count++;                                                                          \
+        _map_->alloc->free(nodes);                                                               \
+                                                                                                 \
+        return inserted;                                                                         \
+    }                                                                                            \
+                                                                                                 \
+    V *PFX##_get_or_insert(struct SNAME *_map_, K key, V default_value)                          \
+    {                                                                                            \
+        struct SNAME##_node *node = NULL;                                                        \
+        struct SNAME##_node *inserted =                                                          \
+            PFX##_impl_insert_node(_map_, key, default_value, &node);                            \
+                                                                                                 \
+        if (inserted)                                                                            \
+            return &(inserted->value);                                                           \
+                                                                                                 \
+        /* NULL if the new node could not be allocated */                                        \
+        if (!node)                                                                               \
+            return NULL;                                                                         \
+                                                                                                 \
+        return &(node->value);                                                                   \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_upsert(struct SNAME *_map_, K key, V value)                                       \
+    {                                                                                            \
+        V *ref = PFX##_get_or_insert(_map_, key, value);                                         \
+                                                                                                 \
+        if (!ref)                                                                                \
+            return false;                                                                        \
+                                                                                                 \
+        *ref = value;                                                                            \
                                                                                                  \
         return true;                                                                             \
     }                                                                                            \
@@ -354,7 +697,7 @@ static const char *cmc_string_fmt_treemap = "%s at %p { root:%p, count:%" PRIuMA
                     node->parent->left = NULL;                                                   \
             }                                                                                    \
                                                                                                  \
-            free(node);                                                                          \
+            PFX##_impl_release_node(_map_, node);                                                \
         }                                                                                        \
         else if (node->left == NULL)                                                             \
         {                                                                                        \
@@ -375,7 +718,7 @@ static const char *cmc_string_fmt_treemap = "%s at %p { root:%p, count:%" PRIuMA
                     node->parent->left = node->right;                                            \
             }                                                                                    \
                                                                                                  \
-            free(node);                                                                          \
+            PFX##_impl_release_node(_map_, node);                                                \
         }                                                                                        \
         else if (node->right == NULL)                                                            \
         {                                                                                        \
@@ -396,7 +739,7 @@ static const char *cmc_string_fmt_treemap = "%s at %p { root:%p, count:%" PRIuMA
                     node->parent->left = node->left;                                             \
             }                                                                                    \
                                                                                                  \
-            free(node);                                                                          \
+            PFX##_impl_release_node(_map_, node);                                                \
         }                                                                                        \
         else                                                                                     \
         {                                                                                        \
@@ -435,7 +778,7 @@ static const char *cmc_string_fmt_treemap = "%s at %p { root:%p, count:%" PRIuMA
                     temp->parent->left = temp->left;                                             \
             }                                                                                    \
                                                                                                  \
-            free(temp);                                                                          \
+            PFX##_impl_release_node(_map_, temp);                                                \
                                                                                                  \
             node->key = temp_key;                                                                \
             node->value = temp_val;                                                              \
@@ -444,6 +787,10 @@ static const char *cmc_string_fmt_treemap = "%s at %p { root:%p, count:%" PRIuMA
         if (unbalanced != NULL)                                                                  \
             PFX##_impl_rebalance(_map_, unbalanced);                                             \
                                                                                                  \
+        /* The released node might have been the finger */                                       \
+        if (_map_->use_finger)                                                                   \
+            _map_->finger = unbalanced;                                                          \
+                                                                                                 \
         _map_->count--;                                                                          \
                                                                                                  \
         if (_map_->count == 0)                                                                   \
@@ -452,129 +799,547 @@ static const char *cmc_string_fmt_treemap = "%s at %p { root:%p, count:%" PRIuMA
         return true;                                                                             \
     }                                                                                            \
                                                                                                  \
-    bool PFX##_max(struct SNAME *_map_, K *key, V *value)                                        \
+    /* Removes every entry for which pred is true and returns how many were */                   \
+    /* removed. The nodes that are kept are gathered in order in one pass */                     \
+    /* and the tree is rebuilt from them in O(count). If that buffer cannot */                   \
+    /* be allocated each entry is removed on its own */                                          \
+    size_t PFX##_remove_if(struct SNAME *_map_, bool (*pred)(K, V),                              \
+                           void (*deallocator)(K, V))                                            \
     {                                                                                            \
-        if (PFX##_empty(_map_))                                                                  \
-            return false;                                                                        \
+        size_t count = _map_->count;                                                             \
+        struct SNAME##_node **nodes = NULL;                                                      \
                                                                                                  \
-        struct SNAME##_node *scan = _map_->root;                                                 \
+        if (count > 0)                                                                           \
+            nodes = _map_->alloc->malloc(sizeof(struct SNAME##_node *) * count);                 \
                                                                                                  \
-        while (scan->right != NULL)                                                              \
-            scan = scan->right;                                                                  \
+        if (!nodes)                                                                              \
+        {                                                                                        \
+            size_t removed = 0;                                                                  \
+            struct SNAME##_node *scan = PFX##_impl_first_node(_map_);                            \
                                                                                                  \
-        *key = scan->key;                                                                        \
-        *value = scan->value;                                                                    \
+            while (scan != NULL)                                                                 \
+            {                                                                                    \
+                K key = scan->key;                                                               \
+                V value = scan->value;                                                           \
                                                                                                  \
-        return true;                                                                             \
-    }                                                                                            \
+                if (!pred(key, value))                                                           \
+                {                                                                                \
+                    scan = PFX##_impl_next_node(scan);                                           \
+                    continue;                                                                    \
+                }                                                                                \
                                                                                                  \
-    bool PFX##_min(struct SNAME *_map_, K *key, V *value)                                        \
-    {                                                                                            \
-        if (PFX##_empty(_map_))                                                                  \
-            return false;                                                                        \
+                PFX##_remove(_map_, key, NULL);                                                  \
                                                                                                  \
-        struct SNAME##_node *scan = _map_->root;                                                 \
+                if (deallocator)                                                                 \
+                    deallocator(key, value);                                                     \
                                                                                                  \
-        while (scan->left != NULL)                                                               \
-            scan = scan->left;                                                                   \
+                removed++;                                                                       \
                                                                                                  \
-        *key = scan->key;                                                                        \
-        *value = scan->value;                                                                    \
+                scan = PFX##_impl_ceiling_node(_map_, key, true);                                \
+            }                                                                                    \
                                                                                                  \
-        return true;                                                                             \
-    }                                                                                            \
+            _map_->finger = NULL;                                                                \
                                                                                                  \
-    V PFX##_get(struct SNAME *_map_, K key)                                                      \
-    {                                                                                            \
-        struct SNAME##_node *node = PFX##_impl_get_node(_map_, key);                             \
+            return removed;                                                                      \
+        }                                                                                        \
                                                                                                  \
-        if (!node)                                                                               \
-            return (V){0};                                                                       \
+        /* Kept nodes fill the buffer from the start and removed ones from */                    \
+        /* the end, as they can only be released once the walk is over */                        \
+        size_t kept = 0;                                                                         \
+        size_t removed = 0;                                                                      \
                                                                                                  \
-        return node->value;                                                                      \
+        for (struct SNAME##_node *scan = PFX##_impl_first_node(_map_); scan != NULL;             \
+             scan = PFX##_impl_next_node(scan))                                                  \
+        {                                                                                        \
+            if (pred(scan->key, scan->value))                                                    \
+                nodes[count - ++removed] = scan;                                                 \
+            else                                                                                 \
+                nodes[kept++] = scan;                                                            \
+        }                                                                                        \
+                                                                                                 \
+        for (size_t i = kept; i < count; i++)                                                    \
+        {                                                                                        \
+            if (deallocator)                                                                     \
+                deallocator(nodes[i]->key, nodes[i]->value);                                     \
+                                                                                                 \
+            PFX##_impl_release_node(_map_, nodes[i]);                                            \
+        }                                                                                        \
+                                                                                                 \
+        if (removed > 0)                                                                         \
+        {                                                                                        \
+            _map_->root = PFX##_impl_build_nodes(nodes, kept, NULL);                             \
+            _map_->count = kept;                                                                 \
+                                                                                                 \
+            /* The finger might have been released */                                            \
+            _map_->finger = NULL;                                                                \
+                                                                                                 \
+            PFX##_impl_thread_nodes(_map_, nodes, kept);                                         \
+        }                                                                                        \
+                                                                                                 \
+        _map_->alloc->free(nodes);                                                               \
+                                                                                                 \
+        return removed;                                                                          \
     }                                                                                            \
                                                                                                  \
-    V *PFX##_get_ref(struct SNAME *_map_, K key)                                                 \
+    /* Moves the keys that are greater than or equal to key to a new map, */                     \
+    /* which is returned, or NULL if it could not be allocated. The tree is */                   \
+    /* split in O(log n), but nodes are freed with the chunks of the map */                      \
+    /* that allocated them, so the smaller side is then copied to the new */                     \
+    /* map and the larger one stays in the nodes it already has. With k */                       \
+    /* keys less than key that takes O(min(k, n - k)) in total */                                \
+    struct SNAME *PFX##_split(struct SNAME *_map_, K key)                                        \
     {                                                                                            \
-        struct SNAME##_node *node = PFX##_impl_get_node(_map_, key);                             \
+        struct SNAME *result = PFX##_new_custom(_map_->cmp, _map_->alloc);                       \
                                                                                                  \
-        if (!node)                                                                               \
+        if (CMC_UNLIKELY(!result))                                                               \
             return NULL;                                                                         \
                                                                                                  \
-        return &(node->value);                                                                   \
-    }                                                                                            \
+        struct SNAME##_node *left = NULL;                                                        \
+        struct SNAME##_node *right = NULL;                                                       \
                                                                                                  \
-    bool PFX##_contains(struct SNAME *_map_, K key)                                              \
-    {                                                                                            \
-        struct SNAME##_node *scan = _map_->root;                                                 \
+        PFX##_impl_split_nodes(_map_, _map_->root, key, &left, &right);                          \
                                                                                                  \
-        while (scan != NULL)                                                                     \
+        bool moves_left = PFX##_impl_s(left) < PFX##_impl_s(right);                              \
+        struct SNAME##_node *moved = moves_left ? left : right;                                  \
+        size_t n = PFX##_impl_s(moved);                                                          \
+                                                                                                 \
+        /* The nodes that are copied, followed by their copies */                                \
+        struct SNAME##_node **nodes = NULL;                                                      \
+                                                                                                 \
+        if (n > 0)                                                                               \
         {                                                                                        \
-            if (_map_->cmp(scan->key, key) > 0)                                                  \
-                scan = scan->left;                                                               \
-            else if (_map_->cmp(scan->key, key) < 0)                                             \
-                scan = scan->right;                                                              \
-            else                                                                                 \
-                return true;                                                                     \
+            nodes = _map_->alloc->malloc(sizeof(struct SNAME##_node *) * n * 2);                 \
+                                                                                                 \
+            while (nodes && moved->left != NULL)                                                 \
+                moved = moved->left;                                                             \
         }                                                                                        \
                                                                                                  \
-        return false;                                                                            \
-    }                                                                                            \
+        for (size_t i = 0; nodes && i < n; i++, moved = PFX##_impl_next_node(moved))             \
+        {                                                                                        \
+            nodes[i] = moved;                                                                    \
+            nodes[n + i] = NULL;                                                                 \
+        }                                                                                        \
                                                                                                  \
-    bool PFX##_empty(struct SNAME *_map_)                                                        \
-    {                                                                                            \
-        return _map_->count == 0;                                                                \
-    }                                                                                            \
+        for (size_t i = 0; nodes && i < n; i++)                                                  \
+        {                                                                                        \
+            struct SNAME##_node *old = nodes[i];                                                 \
                                                                                                  \
-    size_t PFX##_count(struct SNAME *_map_)                                                      \
-    {                                                                                            \
-        return _map_->count;                                                                     \
-    }                                                                                            \
+            if (!(nodes[n + i] = PFX##_impl_new_node(result, old->key, old->value)))             \
+                break;                                                                           \
+        }                                                                                        \
                                                                                                  \
-    struct SNAME *PFX##_copy_of(struct SNAME *_map_, K (*key_copy_func)(K),                      \
-                                V (*value_copy_func)(V))                                         \
-    {                                                                                            \
-        struct SNAME *result = PFX##_new(_map_->cmp);                                            \
+        if (n > 0 && (!nodes || !nodes[n * 2 - 1]))                                              \
+        {                                                                                        \
+            /* Puts the tree back together around the first node on the right */                 \
+            _map_->root = right;                                                                 \
+                                                                                                 \
+            if (right != NULL)                                                                   \
+            {                                                                                    \
+                struct SNAME##_node *node = PFX##_impl_detach_first(_map_);                      \
+                                                                                                 \
+                _map_->root = PFX##_impl_join_nodes(_map_, left, node, _map_->root);             \
+            }                                                                                    \
+            else                                                                                 \
+                _map_->root = left;                                                              \
+                                                                                                 \
+            if (nodes)                                                                           \
+                _map_->alloc->free(nodes);                                                       \
+                                                                                                 \
+            PFX##_free(result, NULL);                                                            \
                                                                                                  \
-        if (!result)                                                                             \
             return NULL;                                                                         \
+        }                                                                                        \
                                                                                                  \
-        struct SNAME##_iter iter;                                                                \
-        PFX##_iter_init(&iter, _map_);                                                           \
+        for (size_t i = 0; i < n; i++)                                                           \
+            PFX##_impl_release_node(_map_, nodes[i]);                                            \
                                                                                                  \
-        if (!PFX##_empty(_map_))                                                                 \
+        _map_->root = moves_left ? right : left;                                                 \
+        _map_->count -= n;                                                                       \
+                                                                                                 \
+        result->root = n > 0 ? PFX##_impl_build_nodes(nodes + n, n, NULL) : NULL;                \
+        result->count = n;                                                                       \
+                                                                                                 \
+        if (n > 0)                                                                               \
         {                                                                                        \
-            for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))     \
-            {                                                                                    \
-                K key = PFX##_iter_key(&iter);                                                   \
-                V value = PFX##_iter_value(&iter);                                               \
+            PFX##_impl_thread_nodes(result, nodes + n, n);                                       \
                                                                                                  \
-                if (key_copy_func)                                                               \
-                    key = key_copy_func(key);                                                    \
-                if (value_copy_func)                                                             \
-                    value = value_copy_func(value);                                              \
+            _map_->alloc->free(nodes);                                                           \
+        }                                                                                        \
                                                                                                  \
-                PFX##_insert(result, key, value);                                                \
-            }                                                                                    \
+        _map_->finger = NULL;                                                                    \
+        result->use_finger = _map_->use_finger;                                                  \
+        /* The map given keeps the smaller keys */                                               \
+        if (moves_left)                                                                          \
+        {                                                                                        \
+            struct SNAME swap = *_map_;                                                          \
+                                                                                                 \
+            *_map_ = *result;                                                                    \
+            *result = swap;                                                                      \
         }                                                                                        \
                                                                                                  \
         return result;                                                                           \
     }                                                                                            \
                                                                                                  \
-    bool PFX##_equals(struct SNAME *_map1_, struct SNAME *_map2_, int (*value_comparator)(V, V)) \
+    /* Moves every key of the second map to the first one if all of them */                      \
+    /* are greater than those of the first map, leaving the second one empty, */                 \
+    /* and returns false otherwise or if they do not share an allocator. The */                  \
+    /* trees are joined in O(log n) and the chunks of the second map and its */                  \
+    /* removed nodes are handed over to the first one */                                         \
+    bool PFX##_join(struct SNAME *_map1_, struct SNAME *_map2_)                                  \
     {                                                                                            \
-        if (PFX##_count(_map1_) != PFX##_count(_map2_))                                          \
+        if (_map1_ == _map2_ || _map1_->alloc != _map2_->alloc)                                  \
             return false;                                                                        \
                                                                                                  \
-        struct SNAME##_iter iter;                                                                \
-        PFX##_iter_init(&iter, _map1_);                                                          \
+        struct SNAME##_node *last = PFX##_impl_last_node(_map1_);                                \
+        struct SNAME##_node *first = PFX##_impl_first_node(_map2_);                              \
                                                                                                  \
-        for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))         \
+        if (last && first && PFX##_impl_cmp(_map1_, last->key, first->key) >= 0)                 \
+            return false;                                                                        \
+                                                                                                 \
+        if (first != NULL)                                                                       \
         {                                                                                        \
-            struct SNAME##_node *node = PFX##_impl_get_node(_map2_, PFX##_iter_key(&iter));      \
+            struct SNAME##_node *node = PFX##_impl_detach_first(_map2_);                         \
                                                                                                  \
-            if (node == NULL)                                                                    \
-                return false;                                                                    \
+            _map1_->root = PFX##_impl_join_nodes(_map1_, _map1_->root, node, _map2_->root);      \
+                                                                                                 \
+            CMC_IMPL_TREE_THREADED(                                                              \
+                if (last != NULL)                                                                \
+                {                                                                                \
+                    last->next = first;                                                          \
+                    first->prev = last;                                                          \
+                }                                                                                \
+                else                                                                             \
+                    _map1_->first = first;                                                       \
+                                                                                                 \
+                _map1_->last = _map2_->last;                                                     \
+            )                                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        _map1_->count += _map2_->count;                                                          \
+                                                                                                 \
+        PFX##_impl_take_chunks(_map1_, _map2_);                                                  \
+                                                                                                 \
+        _map2_->root = NULL;                                                                     \
+        _map2_->count = 0;                                                                       \
+        _map2_->finger = NULL;                                                                   \
+        CMC_IMPL_TREE_THREADED(_map2_->first = NULL; _map2_->last = NULL;)                       \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_max(struct SNAME *_map_, K *key, V *value)                                        \
+    {                                                                                            \
+        if (PFX##_empty(_map_))                                                                  \
+            return false;                                                                        \
+                                                                                                 \
+        struct SNAME##_node *scan = PFX##_impl_last_node(_map_);                                 \
+                                                                                                 \
+        *key = scan->key;                                                                        \
+        *value = scan->value;                                                                    \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_min(struct SNAME *_map_, K *key, V *value)                                        \
+    {                                                                                            \
+        if (PFX##_empty(_map_))                                                                  \
+            return false;                                                                        \
+                                                                                                 \
+        struct SNAME##_node *scan = PFX##_impl_first_node(_map_);                                \
+                                                                                                 \
+        *key = scan->key;                                                                        \
+        *value = scan->value;                                                                    \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* The largest key that is less than or equal to key */                                      \
+    bool PFX##_floor(struct SNAME *_map_, K key, K *out_key, V *out_value)                       \
+    {                                                                                            \
+        struct SNAME##_node *node = PFX##_impl_floor_node(_map_, key, false);                    \
+                                                                                                 \
+        if (!node)                                                                               \
+            return false;                                                                        \
+                                                                                                 \
+        if (out_key)                                                                             \
+            *out_key = node->key;                                                                \
+        if (out_value)                                                                           \
+            *out_value = node->value;                                                            \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* The smallest key that is greater than or equal to key */                                  \
+    bool PFX##_ceiling(struct SNAME *_map_, K key, K *out_key, V *out_value)                     \
+    {                                                                                            \
+        struct SNAME##_node *node = PFX##_impl_ceiling_node(_map_, key, false);                  \
+                                                                                                 \
+        if (!node)                                                                               \
+            return false;                                                                        \
+                                                                                                 \
+        if (out_key)                                                                             \
+            *out_key = node->key;                                                                \
+        if (out_value)                                                                           \
+            *out_value = node->value;                                                            \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* An iterator from the first key that is not less than key to the end of */                 \
+    /* the map. Its index starts at 0 on that key */                                             \
+    struct SNAME##_iter PFX##_lower_bound(struct SNAME *_map_, K key)                            \
+    {                                                                                            \
+        struct SNAME##_iter iter;                                                                \
+        struct SNAME##_node *first = PFX##_impl_ceiling_node(_map_, key, false);                 \
+        struct SNAME##_node *last = PFX##_impl_last_node(_map_);                                 \
+                                                                                                 \
+        PFX##_impl_iter_init_nodes(&iter, _map_, first, last);                                   \
+                                                                                                 \
+        return iter;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* An iterator from the first key that is greater than key to the end of */                  \
+    /* the map. Its index starts at 0 on that key */                                             \
+    struct SNAME##_iter PFX##_upper_bound(struct SNAME *_map_, K key)                            \
+    {                                                                                            \
+        struct SNAME##_iter iter;                                                                \
+        struct SNAME##_node *first = PFX##_impl_ceiling_node(_map_, key, true);                  \
+        struct SNAME##_node *last = PFX##_impl_last_node(_map_);                                 \
+                                                                                                 \
+        PFX##_impl_iter_init_nodes(&iter, _map_, first, last);                                   \
+                                                                                                 \
+        return iter;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Amount of keys that are less than key */                                                  \
+    size_t PFX##_rank(struct SNAME *_map_, K key)                                                \
+    {                                                                                            \
+        struct SNAME##_node *scan = _map_->root;                                                 \
+                                                                                                 \
+        size_t rank = 0;                                                                         \
+                                                                                                 \
+        while (scan != NULL)                                                                     \
+        {                                                                                        \
+            if (PFX##_impl_cmp(_map_, scan->key, key) < 0)                                       \
+            {                                                                                    \
+                rank += PFX##_impl_s(scan->left) + 1;                                            \
+                scan = scan->right;                                                              \
+            }                                                                                    \
+            else                                                                                 \
+                scan = scan->left;                                                               \
+        }                                                                                        \
+                                                                                                 \
+        return rank;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* The key at the given position in ascending order, starting at 0 */                        \
+    bool PFX##_select(struct SNAME *_map_, size_t index, K *key, V *value)                       \
+    {                                                                                            \
+        struct SNAME##_node *node = PFX##_impl_select_node(_map_, index);                        \
+                                                                                                 \
+        if (!node)                                                                               \
+            return false;                                                                        \
+                                                                                                 \
+        if (key)                                                                                 \
+            *key = node->key;                                                                    \
+        if (value)                                                                               \
+            *value = node->value;                                                                \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    V PFX##_get(struct SNAME *_map_, K key)                                                      \
+    {                                                                                            \
+        struct SNAME##_node *node = PFX##_impl_get_node(_map_, key);                             \
+                                                                                                 \
+        if (!node)                                                                               \
+            return (V){0};                                                                       \
+                                                                                                 \
+        return node->value;                                                                      \
+    }                                                                                            \
+                                                                                                 \
+    V *PFX##_get_ref(struct SNAME *_map_, K key)                                                 \
+    {                                                                                            \
+        struct SNAME##_node *node = PFX##_impl_get_node(_map_, key);                             \
+                                                                                                 \
+        if (!node)                                                                               \
+            return NULL;                                                                         \
+                                                                                                 \
+        return &(node->value);                                                                   \
+    }                                                                                            \
+                                                                                                 \
+    /* Writes the value of each key to out, or a default value if it is not */                   \
+    /* in the map, and whether it was found to found. Either can be NULL. */                     \
+    /* Returns how many keys were found */                                                       \
+    size_t PFX##_get_many(struct SNAME *_map_, K *CMC_RESTRICT keys, size_t n,                   \
+                          V *CMC_RESTRICT out, bool *CMC_RESTRICT found)                         \
+    {                                                                                            \
+        bool sorted = n > 1;                                                                     \
+                                                                                                 \
+        for (size_t i = 1; i < n && sorted; i++)                                                 \
+            sorted = PFX##_impl_cmp(_map_, keys[i - 1], keys[i]) <= 0;                           \
+                                                                                                 \
+        size_t total = 0;                                                                        \
+                                                                                                 \
+        /* Each key is found close to the previous one */                                        \
+        if (sorted)                                                                              \
+        {                                                                                        \
+            bool use_finger = _map_->use_finger;                                                 \
+                                                                                                 \
+            /* Starts from the root, whatever the finger was left on */                          \
+            PFX##_set_finger(_map_, true);                                                       \
+                                                                                                 \
+            for (size_t i = 0; i < n; i++)                                                       \
+            {                                                                                    \
+                struct SNAME##_node *node = PFX##_impl_get_node(_map_, keys[i]);                 \
+                                                                                                 \
+                if (node)                                                                        \
+                    total++;                                                                     \
+                                                                                                 \
+                if (out)                                                                         \
+                    out[i] = node ? node->value : (V){0};                                        \
+                if (found)                                                                       \
+                    found[i] = node != NULL;                                                     \
+            }                                                                                    \
+                                                                                                 \
+            PFX##_set_finger(_map_, use_finger);                                                 \
+                                                                                                 \
+            return total;                                                                        \
+        }                                                                                        \
+                                                                                                 \
+        struct SNAME##_node *nodes[CMC_IMPL_TREE_BATCH];                                         \
+                                                                                                 \
+        for (size_t i = 0; i < n; i += CMC_IMPL_TREE_BATCH)                                      \
+        {                                                                                        \
+            size_t batch = n - i < CMC_IMPL_TREE_BATCH ? n - i : CMC_IMPL_TREE_BATCH;            \
+                                                                                                 \
+            PFX##_impl_get_batch(_map_, keys + i, batch, nodes);                                 \
+                                                                                                 \
+            for (size_t j = 0; j < batch; j++)                                                   \
+            {                                                                                    \
+                if (nodes[j])                                                                    \
+                    total++;                                                                     \
+                                                                                                 \
+                if (out)                                                                         \
+                    out[i + j] = nodes[j] ? nodes[j]->value : (V){0};                            \
+                if (found)                                                                       \
+                    found[i + j] = nodes[j] != NULL;                                             \
+            }                                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        return total;                                                                            \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_contains_many(struct SNAME *_map_, K *keys, size_t n, bool *found)              \
+    {                                                                                            \
+        return PFX##_get_many(_map_, keys, n, NULL, found);                                      \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_contains(struct SNAME *_map_, K key)                                              \
+    {                                                                                            \
+        return PFX##_impl_get_node(_map_, key) != NULL;                                          \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_empty(struct SNAME *_map_)                                                        \
+    {                                                                                            \
+        return _map_->count == 0;                                                                \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_count(struct SNAME *_map_)                                                      \
+    {                                                                                            \
+        return _map_->count;                                                                     \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_memory_usage(struct SNAME *_map_)                                               \
+    {                                                                                            \
+        size_t bytes = sizeof(struct SNAME);                                                     \
+                                                                                                 \
+        for (struct SNAME##_chunk *chunk = _map_->chunks; chunk; chunk = chunk->next)            \
+        {                                                                                        \
+            bytes += sizeof(struct SNAME##_chunk);                                               \
+            bytes += sizeof(struct SNAME##_node) * chunk->capacity;                              \
+        }                                                                                        \
+                                                                                                 \
+        return bytes;                                                                            \
+    }                                                                                            \
+                                                                                                 \
+    /* Searches of keys close to the previous one get faster with the finger, */                 \
+    /* while the others compare up to twice as many keys */                                      \
+    void PFX##_set_finger(struct SNAME *_map_, bool enabled)                                     \
+    {                                                                                            \
+        _map_->use_finger = enabled;                                                             \
+        _map_->finger = NULL;                                                                    \
+    }                                                                                            \
+                                                                                                 \
+    struct SNAME *PFX##_copy_of(struct SNAME *_map_, K (*key_copy_func)(K),                      \
+                                V (*value_copy_func)(V))                                         \
+    {                                                                                            \
+        struct SNAME *result = PFX##_new_custom(_map_->cmp, _map_->alloc);                       \
+                                                                                                 \
+        if (CMC_UNLIKELY(!result))                                                               \
+            return NULL;                                                                         \
+                                                                                                 \
+        struct SNAME##_iter iter;                                                                \
+        PFX##_iter_init(&iter, _map_);                                                           \
+                                                                                                 \
+        if (!PFX##_empty(_map_))                                                                 \
+        {                                                                                        \
+            for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))     \
+            {                                                                                    \
+                K key = PFX##_iter_key(&iter);                                                   \
+                V value = PFX##_iter_value(&iter);                                               \
+                                                                                                 \
+                if (key_copy_func)                                                               \
+                    key = key_copy_func(key);                                                    \
+                if (value_copy_func)                                                             \
+                    value = value_copy_func(value);                                              \
+                                                                                                 \
+                PFX##_insert(result, key, value);                                                \
+            }                                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        return result;                                                                           \
+    }                                                                                            \
+                                                                                                 \
+    /* Copies up to size entries, in ascending order of keys, to keys and */                     \
+    /* values, either of which can be NULL, and returns how many were copied */                  \
+    size_t PFX##_to_array(struct SNAME *_map_, K *CMC_RESTRICT keys, V *CMC_RESTRICT values,     \
+                          size_t size)                                                           \
+    {                                                                                            \
+        size_t i = 0;                                                                            \
+                                                                                                 \
+        if (PFX##_empty(_map_))                                                                  \
+            return 0;                                                                            \
+                                                                                                 \
+        struct SNAME##_iter iter;                                                                \
+        PFX##_iter_init(&iter, _map_);                                                           \
+                                                                                                 \
+        for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter) && i < size;                     \
+             PFX##_iter_next(&iter), i++)                                                        \
+        {                                                                                        \
+            if (keys)                                                                            \
+                keys[i] = PFX##_iter_key(&iter);                                                 \
+            if (values)                                                                          \
+                values[i] = PFX##_iter_value(&iter);                                             \
+        }                                                                                        \
+                                                                                                 \
+        return i;                                                                                \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_equals(struct SNAME *_map1_, struct SNAME *_map2_, int (*value_comparator)(V, V)) \
+    {                                                                                            \
+        if (PFX##_count(_map1_) != PFX##_count(_map2_))                                          \
+            return false;                                                                        \
+                                                                                                 \
+        struct SNAME##_iter iter;                                                                \
+        PFX##_iter_init(&iter, _map1_);                                                          \
+                                                                                                 \
+        for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))         \
+        {                                                                                        \
+            struct SNAME##_node *node = PFX##_impl_get_node(_map2_, PFX##_iter_key(&iter));      \
+                                                                                                 \
+            if (node == NULL)                                                                    \
+                return false;                                                                    \
                                                                                                  \
             if (value_comparator)                                                                \
             {                                                                                    \
@@ -598,282 +1363,1152 @@ static const char *cmc_string_fmt_treemap = "%s at %p { root:%p, count:%" PRIuMA
         return str;                                                                              \
     }                                                                                            \
                                                                                                  \
-    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                    \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_ENTRY)                               \
+                                                                                                 \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_ENTRY, (K, V))                              \
+                                                                                                 \
+    bool PFX##_save(struct SNAME *_map_, FILE *file, bool (*key_writer)(K, FILE *),              \
+                    bool (*value_writer)(V, FILE *))                                             \
     {                                                                                            \
-        struct SNAME##_iter *iter = malloc(sizeof(struct SNAME##_iter));                         \
+        uint32_t flags = (key_writer ? 0 : CMC_SERIAL_RAW_KEYS) |                                \
+                         (value_writer ? 0 : CMC_SERIAL_RAW_VALUES);                             \
                                                                                                  \
-        if (!iter)                                                                               \
-            return NULL;                                                                         \
+        if (!cmc_serial_write_header(file, "treemap", flags, sizeof(K), sizeof(V), 0,            \
+                                     _map_->count, _map_->count, 0))                             \
+            return false;                                                                        \
                                                                                                  \
-        PFX##_iter_init(iter, target);                                                           \
+        struct SNAME##_iter iter;                                                                \
+        PFX##_iter_init(&iter, _map_);                                                           \
                                                                                                  \
-        return iter;                                                                             \
+        if (!PFX##_empty(_map_))                                                                 \
+        {                                                                                        \
+            for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))     \
+            {                                                                                    \
+                K key = PFX##_iter_key(&iter);                                                   \
+                V value = PFX##_iter_value(&iter);                                               \
+                                                                                                 \
+                if (!CMC_SERIAL_WRITE(key_writer, key, file) ||                                  \
+                    !CMC_SERIAL_WRITE(value_writer, value, file))                                \
+                    return false;                                                                \
+            }                                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        return true;                                                                             \
     }                                                                                            \
                                                                                                  \
-    void PFX##_iter_free(struct SNAME##_iter *iter)                                              \
+    /* Each reader is only used if the keys or values were saved with a writer */                \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(K, K),                                \
+                                bool (*key_reader)(K *, FILE *),                                 \
+                                bool (*value_reader)(V *, FILE *))                               \
     {                                                                                            \
-        free(iter);                                                                              \
+        struct cmc_serial_header header;                                                         \
+                                                                                                 \
+        if (!cmc_serial_read_header(file, "treemap", sizeof(K), sizeof(V), &header))             \
+            return NULL;                                                                         \
+                                                                                                 \
+        struct SNAME *_map_ = PFX##_new(compare);                                                \
+                                                                                                 \
+        if (CMC_UNLIKELY(!_map_))                                                                \
+            return NULL;                                                                         \
+                                                                                                 \
+        bool raw_keys = header.flags & CMC_SERIAL_RAW_KEYS;                                      \
+        bool raw_values = header.flags & CMC_SERIAL_RAW_VALUES;                                  \
+                                                                                                 \
+        for (size_t i = 0; i < header.count; i++)                                                \
+        {                                                                                        \
+            K key;                                                                               \
+            V value;                                                                             \
+                                                                                                 \
+            if (!CMC_SERIAL_READ(raw_keys, key_reader, &key, file) ||                            \
+                !CMC_SERIAL_READ(raw_values, value_reader, &value, file) ||                      \
+                !PFX##_insert(_map_, key, value))                                                \
+            {                                                                                    \
+                PFX##_free(_map_, NULL);                                                         \
+                return NULL;                                                                     \
+            }                                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        return _map_;                                                                            \
+    }                                                                                            \
+                                                                                                 \
+    /* Writes the keys and values as they are in memory and in order, to be */                   \
+    /* opened by a MappedSortedMap. Every step-th key is also written to a */                    \
+    /* sparse index, that is left out if step is 0 */                                            \
+    bool PFX##_save_flat(struct SNAME *_map_, FILE *file, size_t step)                           \
+    {                                                                                            \
+        uint32_t flags = CMC_SERIAL_FLAT | CMC_SERIAL_RAW_KEYS | CMC_SERIAL_RAW_VALUES;          \
+        struct SNAME##_iter iter;                                                                \
+        size_t index = 0;                                                                        \
+                                                                                                 \
+        if (step > UINT32_MAX)                                                                   \
+            return false;                                                                        \
+                                                                                                 \
+        if (!cmc_serial_write_header(file, "treemap", flags, sizeof(K), sizeof(V),               \
+                                     (uint32_t)step, _map_->count, _map_->count, 0))             \
+            return false;                                                                        \
+                                                                                                 \
+        for (PFX##_iter_init(&iter, _map_); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))      \
+        {                                                                                        \
+            if (fwrite(&iter.cursor->key, sizeof(K), 1, file) != 1)                              \
+                return false;                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        if (!cmc_serial_flat_pad(file, _map_->count * sizeof(K)))                                \
+            return false;                                                                        \
+                                                                                                 \
+        for (PFX##_iter_init(&iter, _map_); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))      \
+        {                                                                                        \
+            if (fwrite(&iter.cursor->value, sizeof(V), 1, file) != 1)                            \
+                return false;                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        if (!cmc_serial_flat_pad(file, _map_->count * sizeof(V)))                                \
+            return false;                                                                        \
+                                                                                                 \
+        for (PFX##_iter_init(&iter, _map_); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))      \
+        {                                                                                        \
+            if (step > 0 && index++ % step == 0 &&                                               \
+                fwrite(&iter.cursor->key, sizeof(K), 1, file) != 1)                              \
+                return false;                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        size_t indexed = cmc_serial_flat_indexed(_map_->count, step);                            \
+                                                                                                 \
+        return cmc_serial_flat_pad(file, indexed * sizeof(K));                                   \
+    }                                                                                            \
+                                                                                                 \
+    static size_t PFX##_impl_serialize_fill(void *serializer, unsigned char *out, size_t room)   \
+    {                                                                                            \
+        struct SNAME##_iter *iter = &((struct SNAME##_serializer *)serializer)->iter;            \
+        size_t written = 0;                                                                      \
+                                                                                                 \
+        while (!iter->end && room - written >= sizeof(K) + sizeof(V))                            \
+        {                                                                                        \
+            memcpy(out + written, &iter->cursor->key, sizeof(K));                                \
+            memcpy(out + written + sizeof(K), &iter->cursor->value, sizeof(V));                  \
+                                                                                                 \
+            written += sizeof(K) + sizeof(V);                                                    \
+                                                                                                 \
+            PFX##_iter_next(iter);                                                               \
+        }                                                                                        \
+                                                                                                 \
+        return written;                                                                          \
+    }                                                                                            \
+                                                                                                 \
+    /* Each key and its value are written as they are in memory and in */                        \
+    /* order, in blocks of up to block_size bytes, or CMC_SERIAL_BLOCK_SIZE */                   \
+    /* if it is 0 */                                                                             \
+    bool PFX##_serialize_begin(struct SNAME##_serializer *serializer, struct SNAME *_map_,       \
+                               size_t block_size, bool checksum)                                 \
+    {                                                                                            \
+        PFX##_iter_init(&serializer->iter, _map_);                                               \
+                                                                                                 \
+        return cmc_serial_writer_begin(&serializer->writer, "treemap", sizeof(K), sizeof(V), 0,  \
+                                       _map_->count, _map_->count, 0, block_size, checksum);     \
+    }                                                                                            \
+                                                                                                 \
+    /* Copies up to size bytes of the stream to buffer and returns how many */                   \
+    /* were copied, 0 once all of them were */                                                   \
+    size_t PFX##_serialize_next(struct SNAME##_serializer *serializer, void *buffer,             \
+                                size_t size)                                                     \
+    {                                                                                            \
+        return cmc_serial_writer_next(&serializer->writer, buffer, size,                         \
+                                      PFX##_impl_serialize_fill, serializer);                    \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_serialize_end(struct SNAME##_serializer *serializer)                              \
+    {                                                                                            \
+        cmc_serial_writer_end(&serializer->writer);                                              \
+    }                                                                                            \
+                                                                                                 \
+    static bool PFX##_impl_deserialize_header(void *deserializer,                                \
+                                              struct cmc_serial_header *header)                  \
+    {                                                                                            \
+        struct SNAME##_deserializer *d = deserializer;                                           \
+        uint32_t raw = CMC_SERIAL_RAW_KEYS | CMC_SERIAL_RAW_VALUES;                              \
+                                                                                                 \
+        if (!cmc_serial_check_header("treemap", sizeof(K), sizeof(V), header) ||                 \
+            (header->flags & raw) != raw)                                                        \
+            return false;                                                                        \
+                                                                                                 \
+        d->result = PFX##_new(d->compare);                                                       \
+                                                                                                 \
+        return d->result != NULL;                                                                \
+    }                                                                                            \
+                                                                                                 \
+    static bool PFX##_impl_deserialize_consume(void *deserializer, const unsigned char *in,      \
+                                               size_t size)                                      \
+    {                                                                                            \
+        struct SNAME *_map_ = ((struct SNAME##_deserializer *)deserializer)->result;             \
+                                                                                                 \
+        if (size % (sizeof(K) + sizeof(V)) != 0)                                                 \
+            return false;                                                                        \
+                                                                                                 \
+        for (size_t i = 0; i < size; i += sizeof(K) + sizeof(V))                                 \
+        {                                                                                        \
+            K key;                                                                               \
+            V value;                                                                             \
+                                                                                                 \
+            memcpy(&key, in + i, sizeof(K));                                                     \
+            memcpy(&value, in + i + sizeof(K), sizeof(V));                                       \
+                                                                                                 \
+            if (!PFX##_insert(_map_, key, value))                                                \
+                return false;                                                                    \
+        }                                                                                        \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Blocks longer than block_size, or CMC_SERIAL_BLOCK_SIZE if it is 0, */                    \
+    /* are rejected */                                                                           \
+    bool PFX##_deserialize_begin(struct SNAME##_deserializer *deserializer,                      \
+                                 int (*compare)(K, K), size_t block_size)                        \
+    {                                                                                            \
+        deserializer->compare = compare;                                                         \
+        deserializer->result = NULL;                                                             \
+                                                                                                 \
+        return cmc_serial_reader_begin(&deserializer->reader, block_size);                       \
+    }                                                                                            \
+                                                                                                 \
+    /* Takes the next size bytes of the stream, returns false if they are */                     \
+    /* not valid, and so does every call after that */                                           \
+    bool PFX##_deserialize_next(struct SNAME##_deserializer *deserializer, const void *buffer,   \
+                                size_t size)                                                     \
+    {                                                                                            \
+        return cmc_serial_reader_next(&deserializer->reader, buffer, size,                       \
+                                      PFX##_impl_deserialize_header,                             \
+                                      PFX##_impl_deserialize_consume, deserializer);             \
+    }                                                                                            \
+                                                                                                 \
+    /* Returns the treemap if the whole stream arrived, otherwise NULL */                        \
+    struct SNAME *PFX##_deserialize_end(struct SNAME##_deserializer *deserializer)               \
+    {                                                                                            \
+        struct SNAME *_map_ = deserializer->result;                                              \
+                                                                                                 \
+        if (!cmc_serial_reader_end(&deserializer->reader) ||                                     \
+            (_map_ && _map_->count != deserializer->reader.header.count))                        \
+        {                                                                                        \
+            if (_map_)                                                                           \
+                PFX##_free(_map_, NULL);                                                         \
+                                                                                                 \
+            return NULL;                                                                         \
+        }                                                                                        \
+                                                                                                 \
+        return _map_;                                                                            \
+    }                                                                                            \
+                                                                                                 \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                    \
+    {                                                                                            \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));          \
+                                                                                                 \
+        if (CMC_UNLIKELY(!iter))                                                                 \
+            return NULL;                                                                         \
+                                                                                                 \
+        PFX##_iter_init(iter, target);                                                           \
+                                                                                                 \
+        return iter;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_iter_free(struct SNAME##_iter *iter)                                              \
+    {                                                                                            \
+        iter->target->alloc->free(iter);                                                         \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                        \
+    {                                                                                            \
+        memset(iter, 0, sizeof(struct SNAME##_iter));                                            \
+                                                                                                 \
+        iter->target = target;                                                                   \
+        iter->start = true;                                                                      \
+        iter->end = PFX##_empty(target);                                                         \
+        iter->count = PFX##_count(target);                                                       \
+                                                                                                 \
+        iter->cursor = PFX##_impl_first_node(target);                                            \
+        iter->first = iter->cursor;                                                              \
+        iter->last = PFX##_impl_last_node(target);                                               \
+    }                                                                                            \
+                                                                                                 \
+    /* Iterates over the keys from lo, inclusive, to hi, exclusive. The index */                 \
+    /* starts at 0 on the first of them */                                                       \
+    void PFX##_iter_init_range(struct SNAME##_iter *iter, struct SNAME *target, K lo,            \
+                               K hi)                                                             \
+    {                                                                                            \
+        PFX##_impl_iter_init_nodes(iter, target, PFX##_impl_ceiling_node(target, lo, false),     \
+                                   PFX##_impl_floor_node(target, hi, true));                     \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                             \
+    {                                                                                            \
+        return iter->count == 0 || iter->start;                                                  \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                               \
+    {                                                                                            \
+        return iter->count == 0 || iter->end;                                                    \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                          \
+    {                                                                                            \
+        if (iter->count > 0)                                                                     \
+        {                                                                                        \
+            iter->index = 0;                                                                     \
+            iter->start = true;                                                                  \
+            iter->end = iter->count == 0;                                                        \
+            iter->cursor = iter->first;                                                          \
+        }                                                                                        \
+    }                                                                                            \
+                                                                                                 \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                            \
+    {                                                                                            \
+        if (iter->count > 0)                                                                     \
+        {                                                                                        \
+            iter->index = PFX##_impl_iter_count(iter) - 1;                                       \
+            iter->start = iter->count == 0;                                                      \
+            iter->end = true;                                                                    \
+            iter->cursor = iter->last;                                                           \
+        }                                                                                        \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                              \
+    {                                                                                            \
+        if (iter->end)                                                                           \
+            return false;                                                                        \
+                                                                                                 \
+        if (iter->cursor == iter->last)                                                          \
+        {                                                                                        \
+            iter->end = true;                                                                    \
+            return false;                                                                        \
+        }                                                                                        \
+                                                                                                 \
+        iter->start = iter->count == 0;                                                          \
+        iter->cursor = PFX##_impl_next_node(iter->cursor);                                       \
+        iter->index++;                                                                           \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                              \
+    {                                                                                            \
+        if (iter->start)                                                                         \
+            return false;                                                                        \
+                                                                                                 \
+        if (iter->cursor == iter->first)                                                         \
+        {                                                                                        \
+            iter->start = true;                                                                  \
+            return false;                                                                        \
+        }                                                                                        \
+                                                                                                 \
+        iter->end = iter->count == 0;                                                            \
+        iter->cursor = PFX##_impl_prev_node(iter->cursor);                                       \
+        iter->index--;                                                                           \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Returns true only if the iterator moved */                                                \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps)                             \
+    {                                                                                            \
+        if (iter->end)                                                                           \
+            return false;                                                                        \
+                                                                                                 \
+        if (iter->cursor == iter->last)                                                          \
+        {                                                                                        \
+            iter->end = true;                                                                    \
+            return false;                                                                        \
+        }                                                                                        \
+                                                                                                 \
+        if (steps == 0 || iter->index + steps >= PFX##_impl_iter_count(iter))                    \
+            return false;                                                                        \
+                                                                                                 \
+        PFX##_impl_iter_seek(iter, iter->index + steps);                                         \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Returns true only if the iterator moved */                                                \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps)                              \
+    {                                                                                            \
+        if (iter->start)                                                                         \
+            return false;                                                                        \
+                                                                                                 \
+        if (iter->cursor == iter->first)                                                         \
+        {                                                                                        \
+            iter->start = true;                                                                  \
+            return false;                                                                        \
+        }                                                                                        \
+                                                                                                 \
+        if (steps == 0 || iter->index < steps)                                                   \
+            return false;                                                                        \
+                                                                                                 \
+        PFX##_impl_iter_seek(iter, iter->index - steps);                                         \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* Returns true only if the iterator was able to be positioned at the given index */         \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index)                               \
+    {                                                                                            \
+        if (index >= PFX##_impl_iter_count(iter))                                                \
+            return false;                                                                        \
+                                                                                                 \
+        if (iter->index > index)                                                                 \
+            return PFX##_iter_rewind(iter, iter->index - index);                                 \
+        else if (iter->index < index)                                                            \
+            return PFX##_iter_advance(iter, index - iter->index);                                \
+                                                                                                 \
+        return true;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    K PFX##_iter_key(struct SNAME##_iter *iter)                                                  \
+    {                                                                                            \
+        if (iter->count == 0)                                                                    \
+            return (K){0};                                                                       \
+                                                                                                 \
+        return iter->cursor->key;                                                                \
+    }                                                                                            \
+                                                                                                 \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                                \
+    {                                                                                            \
+        if (iter->count == 0)                                                                    \
+            return (V){0};                                                                       \
+                                                                                                 \
+        return iter->cursor->value;                                                              \
+    }                                                                                            \
+                                                                                                 \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter)                                              \
+    {                                                                                            \
+        if (iter->count == 0)                                                                    \
+            return NULL;                                                                         \
+                                                                                                 \
+        return &(iter->cursor->value);                                                           \
+    }                                                                                            \
+                                                                                                 \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                           \
+    {                                                                                            \
+        return iter->index;                                                                      \
+    }                                                                                            \
+                                                                                                 \
+    /* Takes a removed node if there is one, otherwise the next one of the */                    \
+    /* newest chunk */                                                                           \
+    static struct SNAME##_node *PFX##_impl_new_node(struct SNAME *_map_, K key, V value)         \
+    {                                                                                            \
+        struct SNAME##_node *node = _map_->free_nodes;                                           \
+                                                                                                 \
+        if (node)                                                                                \
+            _map_->free_nodes = node->parent;                                                    \
+        else                                                                                     \
+        {                                                                                        \
+            if (_map_->chunk_left == 0)                                                          \
+            {                                                                                    \
+                size_t capacity = _map_->chunks ? _map_->chunks->capacity * 2 : 4;               \
+                                                                                                 \
+                if (capacity > CMC_TREE_CHUNK_SIZE)                                              \
+                    capacity = CMC_TREE_CHUNK_SIZE;                                              \
+                                                                                                 \
+                size_t bytes = sizeof(struct SNAME##_node) * capacity;                           \
+                                                                                                 \
+                struct SNAME##_chunk *chunk =                                                    \
+                    _map_->alloc->malloc(sizeof(struct SNAME##_chunk) + bytes);                  \
+                                                                                                 \
+                if (!chunk)                                                                      \
+                    return NULL;                                                                 \
+                                                                                                 \
+                chunk->next = _map_->chunks;                                                     \
+                chunk->capacity = capacity;                                                      \
+                                                                                                 \
+                _map_->chunks = chunk;                                                           \
+                _map_->chunk_left = capacity;                                                    \
+            }                                                                                    \
+                                                                                                 \
+            node = &(_map_->chunks->nodes[--_map_->chunk_left]);                                 \
+        }                                                                                        \
+                                                                                                 \
+        node->key = key;                                                                         \
+        node->value = value;                                                                     \
+        node->right = NULL;                                                                      \
+        node->left = NULL;                                                                       \
+        node->parent = NULL;                                                                     \
+        node->height = 0;                                                                        \
+        node->size = 1;                                                                          \
+                                                                                                 \
+        CMC_IMPL_TREE_THREADED(node->prev = NULL; node->next = NULL;)                            \
+                                                                                                 \
+        return node;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* The node is kept for the next insertion instead of being freed */                         \
+    static void PFX##_impl_release_node(struct SNAME *_map_, struct SNAME##_node *node)          \
+    {                                                                                            \
+        /* Marks it for clear, as nodes in the tree have a size of at least 1 */                 \
+        node->size = 0;                                                                          \
+                                                                                                 \
+        PFX##_impl_unlink_node(_map_, node);                                                     \
+                                                                                                 \
+        node->parent = _map_->free_nodes;                                                        \
+                                                                                                 \
+        _map_->free_nodes = node;                                                                \
+    }                                                                                            \
+                                                                                                 \
+    /* Threads a node that was just added as a leaf between the nodes before */                  \
+    /* and after it, one of which is its parent */                                               \
+    static void PFX##_impl_link_node(struct SNAME *_map_, struct SNAME##_node *node)             \
+    {                                                                                            \
+        (void)_map_;                                                                             \
+        (void)node;                                                                              \
+                                                                                                 \
+        CMC_IMPL_TREE_THREADED(                                                                  \
+            struct SNAME##_node *parent = node->parent;                                          \
+                                                                                                 \
+            if (parent != NULL && parent->left == node)                                          \
+            {                                                                                    \
+                node->next = parent;                                                             \
+                node->prev = parent->prev;                                                       \
+            }                                                                                    \
+            else if (parent != NULL)                                                             \
+            {                                                                                    \
+                node->prev = parent;                                                             \
+                node->next = parent->next;                                                       \
+            }                                                                                    \
+                                                                                                 \
+            if (node->prev != NULL)                                                              \
+                node->prev->next = node;                                                         \
+            else                                                                                 \
+                _map_->first = node;                                                             \
+                                                                                                 \
+            if (node->next != NULL)                                                              \
+                node->next->prev = node;                                                         \
+            else                                                                                 \
+                _map_->last = node;                                                              \
+        )                                                                                        \
+    }                                                                                            \
+                                                                                                 \
+    /* Joins the nodes before and after a node taken out of the tree. When */                    \
+    /* remove moves the successor up into a node with two children, it is */                     \
+    /* the successor that is unlinked */                                                         \
+    static void PFX##_impl_unlink_node(struct SNAME *_map_, struct SNAME##_node *node)           \
+    {                                                                                            \
+        (void)_map_;                                                                             \
+        (void)node;                                                                              \
+                                                                                                 \
+        CMC_IMPL_TREE_THREADED(                                                                  \
+            if (node->prev != NULL)                                                              \
+                node->prev->next = node->next;                                                   \
+            else                                                                                 \
+                _map_->first = node->next;                                                       \
+                                                                                                 \
+            if (node->next != NULL)                                                              \
+                node->next->prev = node->prev;                                                   \
+            else                                                                                 \
+                _map_->last = node->prev;                                                        \
+        )                                                                                        \
+    }                                                                                            \
+                                                                                                 \
+    static struct SNAME##_node *PFX##_impl_first_node(struct SNAME *_map_)                       \
+    {                                                                                            \
+        CMC_IMPL_TREE_THREADED(return _map_->first;)                                             \
+                                                                                                 \
+        struct SNAME##_node *scan = _map_->root;                                                 \
+                                                                                                 \
+        while (scan != NULL && scan->left != NULL)                                               \
+            scan = scan->left;                                                                   \
+                                                                                                 \
+        return scan;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    static struct SNAME##_node *PFX##_impl_last_node(struct SNAME *_map_)                        \
+    {                                                                                            \
+        CMC_IMPL_TREE_THREADED(return _map_->last;)                                              \
+                                                                                                 \
+        struct SNAME##_node *scan = _map_->root;                                                 \
+                                                                                                 \
+        while (scan != NULL && scan->right != NULL)                                              \
+            scan = scan->right;                                                                  \
+                                                                                                 \
+        return scan;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* The node after the given one in order, or NULL if it is the last */                       \
+    static struct SNAME##_node *PFX##_impl_next_node(struct SNAME##_node *node)                  \
+    {                                                                                            \
+        CMC_IMPL_TREE_THREADED(return node->next;)                                               \
+                                                                                                 \
+        if (node->right != NULL)                                                                 \
+        {                                                                                        \
+            node = node->right;                                                                  \
+                                                                                                 \
+            while (node->left != NULL)                                                           \
+                node = node->left;                                                               \
+                                                                                                 \
+            return node;                                                                         \
+        }                                                                                        \
+                                                                                                 \
+        while (node->parent != NULL && node->parent->right == node)                              \
+            node = node->parent;                                                                 \
+                                                                                                 \
+        return node->parent;                                                                     \
+    }                                                                                            \
+                                                                                                 \
+    /* The node before the given one in order, or NULL if it is the first */                     \
+    static struct SNAME##_node *PFX##_impl_prev_node(struct SNAME##_node *node)                  \
+    {                                                                                            \
+        CMC_IMPL_TREE_THREADED(return node->prev;)                                               \
+                                                                                                 \
+        if (node->left != NULL)                                                                  \
+        {                                                                                        \
+            node = node->left;                                                                   \
+                                                                                                 \
+            while (node->right != NULL)                                                          \
+                node = node->right;                                                              \
+                                                                                                 \
+            return node;                                                                         \
+        }                                                                                        \
+                                                                                                 \
+        while (node->parent != NULL && node->parent->left == node)                               \
+            node = node->parent;                                                                 \
+                                                                                                 \
+        return node->parent;                                                                     \
+    }                                                                                            \
+                                                                                                 \
+    /* Links the prev and next of n nodes that are in order */                                   \
+    static void PFX##_impl_thread_nodes(struct SNAME *_map_, struct SNAME##_node **nodes,        \
+                                        size_t n)                                                \
+    {                                                                                            \
+        (void)_map_;                                                                             \
+        (void)nodes;                                                                             \
+        (void)n;                                                                                 \
+                                                                                                 \
+        CMC_IMPL_TREE_THREADED(                                                                  \
+            for (size_t i = 0; i < n; i++)                                                       \
+            {                                                                                    \
+                nodes[i]->prev = i > 0 ? nodes[i - 1] : NULL;                                    \
+                nodes[i]->next = i + 1 < n ? nodes[i + 1] : NULL;                                \
+            }                                                                                    \
+                                                                                                 \
+            _map_->first = n > 0 ? nodes[0] : NULL;                                              \
+            _map_->last = n > 0 ? nodes[n - 1] : NULL;                                           \
+        )                                                                                        \
+    }                                                                                            \
+                                                                                                 \
+    /* Joins the trees left and right, whose keys are all less and greater */                    \
+    /* than that of node, with node between them, and returns the root. It */                    \
+    /* goes down the side of the taller tree to a subtree that is about as */                    \
+    /* tall as the other one, puts node in its place and rebalances back up, */                  \
+    /* taking time proportional to the difference of their heights */                            \
+    static struct SNAME##_node *PFX##_impl_join_nodes(struct SNAME *_map_,                       \
+                                                    struct SNAME##_node *left,                   \
+                                                    struct SNAME##_node *node,                   \
+                                                    struct SNAME##_node *right)                  \
+    {                                                                                            \
+        struct SNAME##_node *parent = NULL;                                                      \
+        unsigned char h_l = PFX##_impl_h(left);                                                  \
+        unsigned char h_r = PFX##_impl_h(right);                                                 \
+                                                                                                 \
+        if (h_l > h_r + 1)                                                                       \
+        {                                                                                        \
+            for (parent = left; PFX##_impl_h(parent->right) > h_r + 1;)                          \
+                parent = parent->right;                                                          \
+                                                                                                 \
+            left = parent->right;                                                                \
+            parent->right = node;                                                                \
+        }                                                                                        \
+        else if (h_r > h_l + 1)                                                                  \
+        {                                                                                        \
+            for (parent = right; PFX##_impl_h(parent->left) > h_l + 1;)                          \
+                parent = parent->left;                                                           \
+                                                                                                 \
+            right = parent->left;                                                                \
+            parent->left = node;                                                                 \
+        }                                                                                        \
+                                                                                                 \
+        node->parent = parent;                                                                   \
+        node->left = left;                                                                       \
+        node->right = right;                                                                     \
+                                                                                                 \
+        if (left)                                                                                \
+            left->parent = node;                                                                 \
+        if (right)                                                                               \
+            right->parent = node;                                                                \
+                                                                                                 \
+        node->height = PFX##_impl_hupdate(node);                                                 \
+        node->size = PFX##_impl_supdate(node);                                                   \
+                                                                                                 \
+        if (parent == NULL)                                                                      \
+            return node;                                                                         \
+                                                                                                 \
+        PFX##_impl_rebalance(_map_, node);                                                       \
+                                                                                                 \
+        return _map_->root;                                                                      \
     }                                                                                            \
                                                                                                  \
-    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                        \
+    /* Splits the tree under node into the nodes with keys less than key */                      \
+    /* and the rest, joining the subtrees that hang on each side of the path */                  \
+    /* to key. The joins get taller along the way up, so their costs add up */                   \
+    /* to the height of the tree */                                                              \
+    static void PFX##_impl_split_nodes(struct SNAME *_map_, struct SNAME##_node *node,           \
+                                       K key, struct SNAME##_node **left,                        \
+                                       struct SNAME##_node **right)                              \
     {                                                                                            \
-        memset(iter, 0, sizeof(struct SNAME##_iter));                                            \
+        if (node == NULL)                                                                        \
+        {                                                                                        \
+            *left = NULL;                                                                        \
+            *right = NULL;                                                                       \
+            return;                                                                              \
+        }                                                                                        \
                                                                                                  \
-        iter->target = target;                                                                   \
-        iter->start = true;                                                                      \
-        iter->end = PFX##_empty(target);                                                         \
+        struct SNAME##_node *l = node->left;                                                     \
+        struct SNAME##_node *r = node->right;                                                    \
                                                                                                  \
-        iter->cursor = target->root;                                                             \
+        if (l)                                                                                   \
+            l->parent = NULL;                                                                    \
+        if (r)                                                                                   \
+            r->parent = NULL;                                                                    \
                                                                                                  \
-        if (!PFX##_empty(target))                                                                \
+        if (PFX##_impl_cmp(_map_, key, node->key) <= 0)                                          \
         {                                                                                        \
-            while (iter->cursor->left != NULL)                                                   \
-                iter->cursor = iter->cursor->left;                                               \
+            PFX##_impl_split_nodes(_map_, l, key, left, right);                                  \
                                                                                                  \
-            iter->first = iter->cursor;                                                          \
+            *right = PFX##_impl_join_nodes(_map_, *right, node, r);                              \
+        }                                                                                        \
+        else                                                                                     \
+        {                                                                                        \
+            PFX##_impl_split_nodes(_map_, r, key, left, right);                                  \
                                                                                                  \
-            iter->last = target->root;                                                           \
-            while (iter->last->right != NULL)                                                    \
-                iter->last = iter->last->right;                                                  \
+            *left = PFX##_impl_join_nodes(_map_, l, node, *left);                                \
         }                                                                                        \
     }                                                                                            \
                                                                                                  \
-    bool PFX##_iter_start(struct SNAME##_iter *iter)                                             \
+    /* Takes the node with the smallest key out of a tree that is not */                         \
+    /* empty without releasing it, so it keeps its place in the order */                         \
+    static struct SNAME##_node *PFX##_impl_detach_first(struct SNAME *_map_)                     \
     {                                                                                            \
-        return PFX##_empty(iter->target) || iter->start;                                         \
-    }                                                                                            \
+        struct SNAME##_node *node = _map_->root;                                                 \
                                                                                                  \
-    bool PFX##_iter_end(struct SNAME##_iter *iter)                                               \
-    {                                                                                            \
-        return PFX##_empty(iter->target) || iter->end;                                           \
-    }                                                                                            \
+        while (node->left != NULL)                                                               \
+            node = node->left;                                                                   \
                                                                                                  \
-    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                          \
-    {                                                                                            \
-        if (!PFX##_empty(iter->target))                                                          \
+        struct SNAME##_node *parent = node->parent;                                              \
+                                                                                                 \
+        if (node->right)                                                                         \
+            node->right->parent = parent;                                                        \
+                                                                                                 \
+        if (parent == NULL)                                                                      \
+            _map_->root = node->right;                                                           \
+        else                                                                                     \
         {                                                                                        \
-            iter->index = 0;                                                                     \
-            iter->start = true;                                                                  \
-            iter->end = PFX##_empty(iter->target);                                               \
-            iter->cursor = iter->first;                                                          \
+            parent->left = node->right;                                                          \
+                                                                                                 \
+            PFX##_impl_rebalance(_map_, parent);                                                 \
         }                                                                                        \
+                                                                                                 \
+        return node;                                                                             \
     }                                                                                            \
                                                                                                  \
-    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                            \
+    /* Moves the chunks and the removed nodes of the second tree to the */                       \
+    /* first one. Only the newest chunk of a tree can have nodes that were */                    \
+    /* never used, so those of the second tree are released */                                   \
+    static void PFX##_impl_take_chunks(struct SNAME *_map1_, struct SNAME *_map2_)               \
     {                                                                                            \
-        if (!PFX##_empty(iter->target))                                                          \
+        if (_map2_->chunks)                                                                      \
         {                                                                                        \
-            iter->index = iter->target->count - 1;                                               \
-            iter->start = PFX##_empty(iter->target);                                             \
-            iter->end = true;                                                                    \
-            iter->cursor = iter->last;                                                           \
-        }                                                                                        \
-    }                                                                                            \
+            for (size_t i = 0; i < _map2_->chunk_left; i++)                                      \
+            {                                                                                    \
+                struct SNAME##_node *node = &(_map2_->chunks->nodes[i]);                         \
                                                                                                  \
-    bool PFX##_iter_next(struct SNAME##_iter *iter)                                              \
-    {                                                                                            \
-        if (iter->end)                                                                           \
-            return false;                                                                        \
+                node->size = 0;                                                                  \
+                node->parent = _map1_->free_nodes;                                               \
+                _map1_->free_nodes = node;                                                       \
+            }                                                                                    \
+        }                                                                                        \
                                                                                                  \
-        if (iter->cursor == iter->last)                                                          \
+        while (_map2_->free_nodes)                                                               \
         {                                                                                        \
-            iter->end = true;                                                                    \
-            return false;                                                                        \
-        }                                                                                        \
+            struct SNAME##_node *node = _map2_->free_nodes;                                      \
                                                                                                  \
-        iter->start = PFX##_empty(iter->target);                                                 \
+            _map2_->free_nodes = node->parent;                                                   \
+            node->parent = _map1_->free_nodes;                                                   \
+            _map1_->free_nodes = node;                                                           \
+        }                                                                                        \
                                                                                                  \
-        if (iter->cursor->right != NULL)                                                         \
+        if (_map2_->chunks)                                                                      \
         {                                                                                        \
-            iter->cursor = iter->cursor->right;                                                  \
-                                                                                                 \
-            while (iter->cursor->left != NULL)                                                   \
-                iter->cursor = iter->cursor->left;                                               \
+            struct SNAME##_chunk *tail = _map2_->chunks;                                         \
                                                                                                  \
-            iter->index++;                                                                       \
+            while (tail->next)                                                                   \
+                tail = tail->next;                                                               \
                                                                                                  \
-            return true;                                                                         \
+            if (_map1_->chunks)                                                                  \
+            {                                                                                    \
+                tail->next = _map1_->chunks->next;                                               \
+                _map1_->chunks->next = _map2_->chunks;                                           \
+            }                                                                                    \
+            else                                                                                 \
+            {                                                                                    \
+                _map1_->chunks = _map2_->chunks;                                                 \
+                _map1_->chunk_left = 0;                                                          \
+            }                                                                                    \
         }                                                                                        \
                                                                                                  \
-        while (true)                                                                             \
-        {                                                                                        \
-            if (iter->cursor->parent->left == iter->cursor)                                      \
-            {                                                                                    \
-                iter->cursor = iter->cursor->parent;                                             \
+        _map2_->chunks = NULL;                                                                   \
+        _map2_->chunk_left = 0;                                                                  \
+    }                                                                                            \
+                                                                                                 \
+    /* Links n nodes that are in order into a balanced tree, like build */                       \
+    static struct SNAME##_node *PFX##_impl_build_nodes(struct SNAME##_node **nodes, size_t n,    \
+                                                     struct SNAME##_node *parent)                \
+    {                                                                                            \
+        if (n == 0)                                                                              \
+            return NULL;                                                                         \
                                                                                                  \
-                iter->index++;                                                                   \
+        size_t mid = n / 2;                                                                      \
+        struct SNAME##_node *node = nodes[mid];                                                  \
                                                                                                  \
-                return true;                                                                     \
-            }                                                                                    \
+        node->parent = parent;                                                                   \
+        node->left = PFX##_impl_build_nodes(nodes, mid, node);                                   \
+        node->right = PFX##_impl_build_nodes(nodes + mid + 1, n - mid - 1, node);                \
+        node->height = PFX##_impl_hupdate(node);                                                 \
+        node->size = PFX##_impl_supdate(node);                                                   \
                                                                                                  \
-            iter->cursor = iter->cursor->parent;                                                 \
-        }                                                                                        \
+        return node;                                                                             \
     }                                                                                            \
                                                                                                  \
-    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                              \
+    /* The middle key is the root of its subtree, so both sides of every node */                 \
+    /* differ by at most one key */                                                              \
+    static bool PFX##_impl_build(struct SNAME *_map_, K *keys, V *values, size_t n,              \
+                                 struct SNAME##_node *parent, struct SNAME##_node **result)      \
     {                                                                                            \
-        if (iter->start)                                                                         \
-            return false;                                                                        \
+        *result = NULL;                                                                          \
                                                                                                  \
-        if (iter->cursor == iter->first)                                                         \
-        {                                                                                        \
-            iter->start = true;                                                                  \
-            return false;                                                                        \
-        }                                                                                        \
+        if (n == 0)                                                                              \
+            return true;                                                                         \
                                                                                                  \
-        iter->end = PFX##_empty(iter->target);                                                   \
+        size_t mid = n / 2;                                                                      \
                                                                                                  \
-        if (iter->cursor->left != NULL)                                                          \
-        {                                                                                        \
-            iter->cursor = iter->cursor->left;                                                   \
+        struct SNAME##_node *node = PFX##_impl_new_node(_map_, keys[mid], values[mid]);          \
                                                                                                  \
-            while (iter->cursor->right != NULL)                                                  \
-                iter->cursor = iter->cursor->right;                                              \
+        if (!node)                                                                               \
+            return false;                                                                        \
                                                                                                  \
-            iter->index--;                                                                       \
+        node->parent = parent;                                                                   \
                                                                                                  \
-            return true;                                                                         \
-        }                                                                                        \
+        *result = node;                                                                          \
                                                                                                  \
-        while (true)                                                                             \
-        {                                                                                        \
-            if (iter->cursor->parent->right == iter->cursor)                                     \
-            {                                                                                    \
-                iter->cursor = iter->cursor->parent;                                             \
+        PFX##_impl_link_node(_map_, node);                                                       \
                                                                                                  \
-                iter->index--;                                                                   \
+        if (!PFX##_impl_build(_map_, keys, values, mid, node, &(node->left)) ||                  \
+            !PFX##_impl_build(_map_, keys + mid + 1, values + mid + 1, n - mid - 1, node,        \
+                              &(node->right)))                                                   \
+            return false;                                                                        \
                                                                                                  \
-                return true;                                                                     \
-            }                                                                                    \
+        node->height = PFX##_impl_hupdate(node);                                                 \
+        node->size = PFX##_impl_supdate(node);                                                   \
                                                                                                  \
-            iter->cursor = iter->cursor->parent;                                                 \
-        }                                                                                        \
+        return true;                                                                             \
     }                                                                                            \
                                                                                                  \
-    /* Returns true only if the iterator moved */                                                \
-    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps)                             \
+    /* The node with the smallest key that is greater than or equal to key, */                   \
+    /* or only greater if strict */                                                              \
+    static struct SNAME##_node *PFX##_impl_ceiling_node(struct SNAME *_map_, K key,              \
+                                                        bool strict)                             \
     {                                                                                            \
-        if (iter->end)                                                                           \
-            return false;                                                                        \
+        struct SNAME##_node *scan = _map_->root;                                                 \
+        struct SNAME##_node *result = NULL;                                                      \
                                                                                                  \
-        if (iter->cursor == iter->last)                                                          \
+        while (scan != NULL)                                                                     \
         {                                                                                        \
-            iter->end = true;                                                                    \
-            return false;                                                                        \
+            int c = PFX##_impl_cmp(_map_, scan->key, key);                                       \
+                                                                                                 \
+            if (c > 0 || (c == 0 && !strict))                                                    \
+            {                                                                                    \
+                result = scan;                                                                   \
+                scan = scan->left;                                                               \
+            }                                                                                    \
+            else                                                                                 \
+                scan = scan->right;                                                              \
         }                                                                                        \
                                                                                                  \
-        if (steps == 0 || iter->index + steps >= PFX##_count(iter->target))                      \
-            return false;                                                                        \
+        return result;                                                                           \
+    }                                                                                            \
                                                                                                  \
-        iter->index += steps;                                                                    \
+    /* The node with the largest key that is less than or equal to key, or */                    \
+    /* only less if strict */                                                                    \
+    static struct SNAME##_node *PFX##_impl_floor_node(struct SNAME *_map_, K key,                \
+                                                      bool strict)                               \
+    {                                                                                            \
+        struct SNAME##_node *scan = _map_->root;                                                 \
+        struct SNAME##_node *result = NULL;                                                      \
                                                                                                  \
-        for (size_t i = 0; i < steps; i++)                                                       \
-            PFX##_iter_next(iter);                                                               \
+        while (scan != NULL)                                                                     \
+        {                                                                                        \
+            int c = PFX##_impl_cmp(_map_, scan->key, key);                                       \
                                                                                                  \
-        return true;                                                                             \
+            if (c < 0 || (c == 0 && !strict))                                                    \
+            {                                                                                    \
+                result = scan;                                                                   \
+                scan = scan->right;                                                              \
+            }                                                                                    \
+            else                                                                                 \
+                scan = scan->left;                                                               \
+        }                                                                                        \
+                                                                                                 \
+        return result;                                                                           \
     }                                                                                            \
                                                                                                  \
-    /* Returns true only if the iterator moved */                                                \
-    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps)                              \
+    /* An iterator from first to last, both included, which is empty if either */                \
+    /* one of them is missing or they are out of order */                                        \
+    static void PFX##_impl_iter_init_nodes(struct SNAME##_iter *iter, struct SNAME *target,      \
+                                           struct SNAME##_node *first,                           \
+                                           struct SNAME##_node *last)                            \
     {                                                                                            \
-        if (iter->start)                                                                         \
-            return false;                                                                        \
+        memset(iter, 0, sizeof(struct SNAME##_iter));                                            \
                                                                                                  \
-        if (iter->cursor == iter->first)                                                         \
+        iter->target = target;                                                                   \
+        iter->start = true;                                                                      \
+                                                                                                 \
+        if (first && last && PFX##_impl_cmp(target, first->key, last->key) <= 0)                 \
         {                                                                                        \
-            iter->start = true;                                                                  \
-            return false;                                                                        \
+            iter->cursor = first;                                                                \
+            iter->first = first;                                                                 \
+            iter->last = last;                                                                   \
+            iter->count = SIZE_MAX;                                                              \
         }                                                                                        \
                                                                                                  \
-        if (steps == 0 || iter->index < steps)                                                   \
-            return false;                                                                        \
+        iter->end = iter->count == 0;                                                            \
+    }                                                                                            \
+                                                                                                 \
+    /* Counts the nodes of an iterator over part of the tree the first time */                   \
+    /* it is needed */                                                                           \
+    static size_t PFX##_impl_iter_count(struct SNAME##_iter *iter)                               \
+    {                                                                                            \
+        if (iter->count != SIZE_MAX)                                                             \
+            return iter->count;                                                                  \
                                                                                                  \
-        iter->index -= steps;                                                                    \
+        size_t first = PFX##_impl_node_rank(iter->first);                                        \
                                                                                                  \
-        for (size_t i = 0; i < steps; i++)                                                       \
-            PFX##_iter_prev(iter);                                                               \
+        iter->count = PFX##_impl_node_rank(iter->last) - first + 1;                              \
                                                                                                  \
-        return true;                                                                             \
+        return iter->count;                                                                      \
     }                                                                                            \
                                                                                                  \
-    /* Returns true only if the iterator was able to be positioned at the given index */         \
-    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index)                               \
+    /* Position of the node in ascending order, starting at 0 */                                 \
+    static size_t PFX##_impl_node_rank(struct SNAME##_node *node)                                \
     {                                                                                            \
-        if (index >= PFX##_count(iter->target))                                                  \
-            return false;                                                                        \
+        size_t rank = PFX##_impl_s(node->left);                                                  \
                                                                                                  \
-        if (iter->index > index)                                                                 \
-            return PFX##_iter_rewind(iter, iter->index - index);                                 \
-        else if (iter->index < index)                                                            \
-            return PFX##_iter_advance(iter, index - iter->index);                                \
+        while (node->parent != NULL)                                                             \
+        {                                                                                        \
+            if (node->parent->right == node)                                                     \
+                rank += PFX##_impl_s(node->parent->left) + 1;                                    \
                                                                                                  \
-        return true;                                                                             \
+            node = node->parent;                                                                 \
+        }                                                                                        \
+                                                                                                 \
+        return rank;                                                                             \
     }                                                                                            \
                                                                                                  \
-    K PFX##_iter_key(struct SNAME##_iter *iter)                                                  \
+    /* The node at the given position in ascending order, starting at 0 */                       \
+    static struct SNAME##_node *PFX##_impl_select_node(struct SNAME *_map_, size_t index)        \
     {                                                                                            \
-        if (PFX##_empty(iter->target))                                                           \
-            return (K){0};                                                                       \
+        struct SNAME##_node *scan = _map_->root;                                                 \
                                                                                                  \
-        return iter->cursor->key;                                                                \
+        while (scan != NULL)                                                                     \
+        {                                                                                        \
+            size_t left = PFX##_impl_s(scan->left);                                              \
+                                                                                                 \
+            if (index < left)                                                                    \
+                scan = scan->left;                                                               \
+            else if (index > left)                                                               \
+            {                                                                                    \
+                index -= left + 1;                                                               \
+                scan = scan->right;                                                              \
+            }                                                                                    \
+            else                                                                                 \
+                return scan;                                                                     \
+        }                                                                                        \
+                                                                                                 \
+        return NULL;                                                                             \
     }                                                                                            \
                                                                                                  \
-    V PFX##_iter_value(struct SNAME##_iter *iter)                                                \
+    /* Moves the iterator to an index that is known to be inside its range */                    \
+    static void PFX##_impl_iter_seek(struct SNAME##_iter *iter, size_t index)                    \
     {                                                                                            \
-        if (PFX##_empty(iter->target))                                                           \
-            return (V){0};                                                                       \
+        size_t rank = PFX##_impl_node_rank(iter->first) + index;                                 \
                                                                                                  \
-        return iter->cursor->value;                                                              \
+        iter->cursor = PFX##_impl_select_node(iter->target, rank);                               \
+        iter->index = index;                                                                     \
+        iter->start = false;                                                                     \
+        iter->end = false;                                                                       \
     }                                                                                            \
                                                                                                  \
-    V *PFX##_iter_rvalue(struct SNAME##_iter *iter)                                              \
+    static struct SNAME##_node *PFX##_impl_get_node(struct SNAME *_map_, K key)                  \
     {                                                                                            \
-        if (PFX##_empty(iter->target))                                                           \
+        if (PFX##_empty(_map_))                                                                  \
             return NULL;                                                                         \
                                                                                                  \
-        return &(iter->cursor->value);                                                           \
+        struct SNAME##_node *scan = PFX##_impl_search_start(_map_, key);                         \
+        struct SNAME##_node *last = scan;                                                        \
+                                                                                                 \
+        while (scan != NULL)                                                                     \
+        {                                                                                        \
+            int c = PFX##_impl_cmp(_map_, scan->key, key);                                       \
+                                                                                                 \
+            last = scan;                                                                         \
+                                                                                                 \
+            if (c > 0)                                                                           \
+                scan = scan->left;                                                               \
+            else if (c < 0)                                                                      \
+                scan = scan->right;                                                              \
+            else                                                                                 \
+                break;                                                                           \
+        }                                                                                        \
+                                                                                                 \
+        /* A key that is not found leaves the finger next to where it would be */                \
+        if (_map_->use_finger)                                                                   \
+            _map_->finger = last;                                                                \
+                                                                                                 \
+        return scan;                                                                             \
     }                                                                                            \
                                                                                                  \
-    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                           \
+    /* Finds the nodes of up to CMC_IMPL_TREE_BATCH keys from the root. Each */                  \
+    /* round moves every search that is not over one level down and */                           \
+    /* prefetches the node it moved to, which is only read in the next round */                  \
+    static void PFX##_impl_get_batch(struct SNAME *_map_, K *keys, size_t n,                     \
+                                     struct SNAME##_node **nodes)                                \
     {                                                                                            \
-        return iter->index;                                                                      \
+        bool done[CMC_IMPL_TREE_BATCH];                                                          \
+        size_t active = 0;                                                                       \
+                                                                                                 \
+        for (size_t i = 0; i < n; i++)                                                           \
+        {                                                                                        \
+            nodes[i] = _map_->root;                                                              \
+            done[i] = _map_->root == NULL;                                                       \
+            active += !done[i];                                                                  \
+        }                                                                                        \
+                                                                                                 \
+        while (active > 0)                                                                       \
+        {                                                                                        \
+            for (size_t i = 0; i < n; i++)                                                       \
+            {                                                                                    \
+                if (done[i])                                                                     \
+                    continue;                                                                    \
+                                                                                                 \
+                int c = PFX##_impl_cmp(_map_, nodes[i]->key, keys[i]);                           \
+                                                                                                 \
+                if (c != 0)                                                                      \
+                    nodes[i] = c > 0 ? nodes[i]->left : nodes[i]->right;                         \
+                                                                                                 \
+                if (c == 0 || nodes[i] == NULL)                                                  \
+                {                                                                                \
+                    done[i] = true;                                                              \
+                    active--;                                                                    \
+                }                                                                                \
+                else                                                                             \
+                    CMC_IMPL_TREE_PREFETCH(nodes[i]);                                            \
+            }                                                                                    \
+        }                                                                                        \
     }                                                                                            \
                                                                                                  \
-    static struct SNAME##_node *PFX##_impl_new_node(K key, V value)                              \
+    /* The node that searches for key go down from. With the finger, it is */                    \
+    /* the lowest ancestor of the finger whose subtree can hold key */                           \
+    static struct SNAME##_node *PFX##_impl_search_start(struct SNAME *_map_, K key)              \
     {                                                                                            \
-        struct SNAME##_node *node = malloc(sizeof(struct SNAME##_node));                         \
+        struct SNAME##_node *scan = _map_->finger;                                               \
                                                                                                  \
-        if (!node)                                                                               \
-            return NULL;                                                                         \
+        if (!_map_->use_finger || scan == NULL)                                                  \
+            return _map_->root;                                                                  \
                                                                                                  \
-        node->key = key;                                                                         \
-        node->value = value;                                                                     \
-        node->right = NULL;                                                                      \
-        node->left = NULL;                                                                       \
-        node->parent = NULL;                                                                     \
-        node->height = 0;                                                                        \
+        int c = PFX##_impl_cmp(_map_, scan->key, key);                                           \
                                                                                                  \
-        return node;                                                                             \
+        if (c == 0)                                                                              \
+            return scan;                                                                         \
+                                                                                                 \
+        /* Going up from a left child gives the subtree an upper bound and */                    \
+        /* from a right child a lower bound. The subtree of start holds every */                 \
+        /* key between start and the first bound on the side of key */                           \
+        struct SNAME##_node *start = scan;                                                       \
+                                                                                                 \
+        while (scan->parent != NULL)                                                             \
+        {                                                                                        \
+            struct SNAME##_node *parent = scan->parent;                                          \
+                                                                                                 \
+            bool bound = c < 0 ? parent->left == scan : parent->right == scan;                   \
+                                                                                                 \
+            if (bound)                                                                           \
+            {                                                                                    \
+                int p = PFX##_impl_cmp(_map_, parent->key, key);                                 \
+                                                                                                 \
+                if (p == 0)                                                                      \
+                    return parent;                                                               \
+                                                                                                 \
+                if ((p > 0) == (c < 0))                                                          \
+                    break;                                                                       \
+                                                                                                 \
+                start = parent;                                                                  \
+            }                                                                                    \
+                                                                                                 \
+            scan = parent;                                                                       \
+        }                                                                                        \
+                                                                                                 \
+        return start;                                                                            \
     }                                                                                            \
                                                                                                  \
-    static struct SNAME##_node *PFX##_impl_get_node(struct SNAME *_map_, K key)                  \
+    /* Walks down the tree once, comparing each node a single time. If the */                    \
+    /* key is already there its node is stored in found and NULL is returned */                  \
+    static struct SNAME##_node *PFX##_impl_insert_node(struct SNAME *_map_, K key, V value,      \
+                                                       struct SNAME##_node **found)              \
     {                                                                                            \
-        if (PFX##_empty(_map_))                                                                  \
-            return NULL;                                                                         \
+        struct SNAME##_node *scan = PFX##_impl_search_start(_map_, key);                         \
+        struct SNAME##_node *parent = NULL;                                                      \
                                                                                                  \
-        struct SNAME##_node *scan = _map_->root;                                                 \
+        int c = 0;                                                                               \
                                                                                                  \
         while (scan != NULL)                                                                     \
         {                                                                                        \
-            if (_map_->cmp(scan->key, key) > 0)                                                  \
+            parent = scan;                                                                       \
+            c = PFX##_impl_cmp(_map_, scan->key, key);                                           \
+                                                                                                 \
+            if (c > 0)                                                                           \
                 scan = scan->left;                                                               \
-            else if (_map_->cmp(scan->key, key) < 0)                                             \
+            else if (c < 0)                                                                      \
                 scan = scan->right;                                                              \
             else                                                                                 \
-                return scan;                                                                     \
+            {                                                                                    \
+                if (_map_->use_finger)                                                           \
+                    _map_->finger = scan;                                                        \
+                                                                                                 \
+                *found = scan;                                                                   \
+                return NULL;                                                                     \
+            }                                                                                    \
         }                                                                                        \
                                                                                                  \
-        return NULL;                                                                             \
+        struct SNAME##_node *node = PFX##_impl_new_node(_map_, key, value);                      \
+                                                                                                 \
+        if (!node)                                                                               \
+            return NULL;                                                                         \
+                                                                                                 \
+        if (!parent)                                                                             \
+            _map_->root = node;                                                                  \
+        else                                                                                     \
+        {                                                                                        \
+            if (c > 0)                                                                           \
+                parent->left = node;                                                             \
+            else                                                                                 \
+                parent->right = node;                                                            \
+                                                                                                 \
+            node->parent = parent;                                                               \
+        }                                                                                        \
+                                                                                                 \
+        /* Linked while it is still a leaf under parent */                                       \
+        PFX##_impl_link_node(_map_, node);                                                       \
+                                                                                                 \
+        if (parent)                                                                              \
+            PFX##_impl_rebalance(_map_, node);                                                   \
+                                                                                                 \
+        if (_map_->use_finger)                                                                   \
+            _map_->finger = node;                                                                \
+                                                                                                 \
+        _map_->count++;                                                                          \
+                                                                                                 \
+        return node;                                                                             \
     }                                                                                            \
                                                                                                  \
     static unsigned char PFX##_impl_h(struct SNAME##_node *node)                                 \
@@ -895,6 +2530,22 @@ static const char *cmc_string_fmt_treemap = "%s at %p { root:%p, count:%" PRIuMA
         return 1 + (h_l > h_r ? h_l : h_r);                                                      \
     }                                                                                            \
                                                                                                  \
+    static size_t PFX##_impl_s(struct SNAME##_node *node)                                        \
+    {                                                                                            \
+        if (node == NULL)                                                                        \
+            return 0;                                                                            \
+                                                                                                 \
+        return node->size;                                                                       \
+    }                                                                                            \
+                                                                                                 \
+    static size_t PFX##_impl_supdate(struct SNAME##_node *node)                                  \
+    {                                                                                            \
+        if (node == NULL)                                                                        \
+            return 0;                                                                            \
+                                                                                                 \
+        return 1 + PFX##_impl_s(node->left) + PFX##_impl_s(node->right);                         \
+    }                                                                                            \
+                                                                                                 \
     static void PFX##_impl_rotate_right(struct SNAME##_node **Z)                                 \
     {                                                                                            \
         struct SNAME##_node *root = *Z;                                                          \
@@ -920,6 +2571,8 @@ static const char *cmc_string_fmt_treemap = "%s at %p { root:%p, count:%" PRIuMA
                                                                                                  \
         root->height = PFX##_impl_hupdate(root);                                                 \
         new_root->height = PFX##_impl_hupdate(new_root);                                         \
+        root->size = PFX##_impl_supdate(root);                                                   \
+        new_root->size = PFX##_impl_supdate(new_root);                                           \
                                                                                                  \
         *Z = new_root;                                                                           \
     }                                                                                            \
@@ -949,6 +2602,8 @@ static const char *cmc_string_fmt_treemap = "%s at %p { root:%p, count:%" PRIuMA
                                                                                                  \
         root->height = PFX##_impl_hupdate(root);                                                 \
         new_root->height = PFX##_impl_hupdate(new_root);                                         \
+        root->size = PFX##_impl_supdate(root);                                                   \
+        new_root->size = PFX##_impl_supdate(new_root);                                           \
                                                                                                  \
         *Z = new_root;                                                                           \
     }                                                                                            \
@@ -966,6 +2621,7 @@ static const char *cmc_string_fmt_treemap = "%s at %p { root:%p, count:%" PRIuMA
                 is_root = true;                                                                  \
                                                                                                  \
             scan->height = PFX##_impl_hupdate(scan);                                             \
+            scan->size = PFX##_impl_supdate(scan);                                               \
             balance = PFX##_impl_h(scan->right) - PFX##_impl_h(scan->left);                      \
                                                                                                  \
             if (balance >= 2)                                                                    \
@@ -1014,6 +2670,13 @@ static const char *cmc_string_fmt_treemap = "%s at %p { root:%p, count:%" PRIuMA
         PFX##_iter_to_end(&iter);                                                                \
                                                                                                  \
         return iter;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    static inline int PFX##_impl_cmp(struct SNAME *_map_, K a, K b)                              \
+    {                                                                                            \
+        (void)_map_;                                                                             \
+                                                                                                 \
+        return CMP(a, b);                                                                        \
     }
 
 #endif /* CMC_TREEMAP_H */
@@ -14,6 +14,17 @@
  * A TreeSet is an implementation of a Set that keeps its elements sorted. Like
  * a Set it has only unique keys. This implementation uses a balanced binary
  * tree called AVL Tree that uses the height of nodes to keep its keys balanced.
+ *
+ * Nodes are allocated in chunks that are only freed by clear and free, and
+ * removed nodes are reused by the next insertions. A deallocator given to
+ * clear or free is called going through the chunks in memory order, so
+ * tearing down a large tree does not chase pointers from node to node.
+ *
+ * Every node also keeps the size of its subtree, so the rank of a element, the
+ * element at a given position and the iterator jumps all take log(n).
+ *
+ * contains_many goes down the tree for several elements at once, one level
+ * at a time, prefetching the next node of each so their cache misses overlap.
  */
 
 #ifndef CMC_TREESET_H
@@ -24,7 +35,48 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_serial.h"
 #include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* Maximum amount of nodes allocated at once. The first chunk of a tree has 4 */
+/* nodes and each one after it has twice as many as the one before */
+#ifndef CMC_TREE_CHUNK_SIZE
+#define CMC_TREE_CHUNK_SIZE 256
+#endif
+
+#ifndef CMC_IMPL_TREE_THREADS
+#define CMC_IMPL_TREE_THREADS
+
+/* Defining CMC_TREE_THREADED before including any tree makes every node */
+/* also point to the nodes before and after it in order, updated by insert */
+/* and remove. The iterators, min and max then follow a single pointer */
+/* instead of going up and down the tree, for two more pointers per node */
+#ifdef CMC_TREE_THREADED
+#define CMC_IMPL_TREE_THREAD_FIELDS(SNAME, a, b) \
+    struct SNAME##_node *a;                      \
+    struct SNAME##_node *b;
+#define CMC_IMPL_TREE_THREADED(...) __VA_ARGS__
+#else
+#define CMC_IMPL_TREE_THREAD_FIELDS(SNAME, a, b)
+#define CMC_IMPL_TREE_THREADED(...)
+#endif
+
+#endif /* CMC_IMPL_TREE_THREADS */
+
+#ifndef CMC_IMPL_TREE_BATCH
+/* Batched lookups go down the tree for this many keys at once, one level */
+/* of each search at a time, so the cache misses of the batch overlap */
+#define CMC_IMPL_TREE_BATCH 16
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CMC_IMPL_TREE_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define CMC_IMPL_TREE_PREFETCH(address)
+#endif
+#endif /* CMC_IMPL_TREE_BATCH */
 
 /* to_string format */
 static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMAX ", cmp:%p }";
@@ -39,6 +91,19 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
 #define CMC_WRAPGEN_TREESET_SOURCE(PFX, SNAME, K, V) \
     CMC_GENERATE_TREESET_SOURCE(PFX, SNAME, V)
 
+/* Same as CMC_GENERATE_TREESET but elements are compared by calling CMP */
+/* directly, so the compiler can inline it. The function given to new is */
+/* still stored but only used by copy_of and to_string */
+#define CMC_GENERATE_TREESET_EX(PFX, SNAME, V, CMP) \
+    CMC_GENERATE_TREESET_HEADER(PFX, SNAME, V)      \
+    CMC_GENERATE_TREESET_EX_SOURCE(PFX, SNAME, V, CMP)
+
+#define CMC_GENERATE_TREESET_SOURCE(PFX, SNAME, V) \
+    CMC_IMPL_TREESET_SOURCE(PFX, SNAME, V, _set_->cmp)
+
+#define CMC_GENERATE_TREESET_EX_SOURCE(PFX, SNAME, V, CMP) \
+    CMC_IMPL_TREESET_SOURCE(PFX, SNAME, V, CMP)
+
 /* HEADER ********************************************************************/
 #define CMC_GENERATE_TREESET_HEADER(PFX, SNAME, V)                                        \
                                                                                           \
@@ -59,6 +124,22 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
                                                                                           \
         /* Function that returns an iterator to the end of the treeset */                 \
         struct SNAME##_iter (*it_end)(struct SNAME *);                                    \
+                                                                                          \
+        /* Chunks that the nodes are allocated from, the newest one first */              \
+        struct SNAME##_chunk *chunks;                                                     \
+                                                                                          \
+        /* Removed nodes that are reused before the newest chunk, linked by */            \
+        /* their parent */                                                                \
+        struct SNAME##_node *free_nodes;                                                  \
+                                                                                          \
+        /* Nodes of the newest chunk that were never used */                              \
+        size_t chunk_left;                                                                \
+                                                                                          \
+        /* First and last nodes in order, if CMC_TREE_THREADED is defined */              \
+        CMC_IMPL_TREE_THREAD_FIELDS(SNAME, first, last)                                   \
+                                                                                          \
+        /* Custom allocation functions */                                                 \
+        struct cmc_alloc_node *alloc;                                                     \
     };                                                                                    \
                                                                                           \
     /* Treeset Node */                                                                    \
@@ -70,6 +151,9 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
         /* Node height used by the AVL tree to keep it strictly balanced */               \
         unsigned char height;                                                             \
                                                                                           \
+        /* Amount of nodes in the subtree of this node, itself included */                \
+        size_t size;                                                                      \
+                                                                                          \
         /* Right child node or subtree */                                                 \
         struct SNAME##_node *right;                                                       \
                                                                                           \
@@ -78,6 +162,22 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
                                                                                           \
         /* Parent node */                                                                 \
         struct SNAME##_node *parent;                                                      \
+                                                                                          \
+        /* Nodes before and after this one, if CMC_TREE_THREADED is defined */            \
+        CMC_IMPL_TREE_THREAD_FIELDS(SNAME, prev, next)                                    \
+    };                                                                                    \
+                                                                                          \
+    /* Treeset Chunk of Nodes */                                                          \
+    struct SNAME##_chunk                                                                  \
+    {                                                                                     \
+        /* Chunk allocated before this one */                                             \
+        struct SNAME##_chunk *next;                                                       \
+                                                                                          \
+        /* Amount of nodes in the chunk */                                                \
+        size_t capacity;                                                                  \
+                                                                                          \
+        /* Nodes given in order from the last one to the first */                         \
+        struct SNAME##_node nodes[];                                                      \
     };                                                                                    \
                                                                                           \
     /* Treeset Iterator */                                                                \
@@ -95,6 +195,10 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
         /* The last node in the iteration */                                              \
         struct SNAME##_node *last;                                                        \
                                                                                           \
+        /* Amount of nodes from first to last. Iterators over part of the */              \
+        /* tree have SIZE_MAX until it is needed */                                       \
+        size_t count;                                                                     \
+                                                                                          \
         /* Keeps track of relative index to the iteration of elements */                  \
         size_t index;                                                                     \
                                                                                           \
@@ -108,28 +212,58 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
     /* Collection Functions */                                                            \
     /* Collection Allocation and Deallocation */                                          \
     struct SNAME *PFX##_new(int (*compare)(V, V));                                        \
+    struct SNAME *PFX##_new_custom(int (*compare)(V, V), struct cmc_alloc_node *alloc);   \
+    struct SNAME *PFX##_new_from_sorted(int (*compare)(V, V), V *elements, size_t n);     \
+    struct SNAME *PFX##_new_from(int (*compare)(V, V), V *elements, size_t n);            \
     void PFX##_clear(struct SNAME *_set_, void (*deallocator)(V));                        \
     void PFX##_free(struct SNAME *_set_, void (*deallocator)(V));                         \
+    void PFX##_release(struct SNAME *_set_);                                              \
     /* Collection Input and Output */                                                     \
     bool PFX##_insert(struct SNAME *_set_, V element);                                    \
+    size_t PFX##_insert_sorted_many(struct SNAME *_set_, V *elements, size_t n);          \
+    struct SNAME *PFX##_split(struct SNAME *_set_, V element);                            \
+    bool PFX##_join(struct SNAME *_set1_, struct SNAME *_set2_);                          \
     bool PFX##_remove(struct SNAME *_set_, V element);                                    \
+    size_t PFX##_remove_if(struct SNAME *_set_, bool (*pred)(V), void (*deallocator)(V)); \
     /* Element Access */                                                                  \
     bool PFX##_max(struct SNAME *_set_, V *value);                                        \
     bool PFX##_min(struct SNAME *_set_, V *value);                                        \
+    bool PFX##_floor(struct SNAME *_set_, V element, V *value);                           \
+    bool PFX##_ceiling(struct SNAME *_set_, V element, V *value);                         \
+    struct SNAME##_iter PFX##_lower_bound(struct SNAME *_set_, V element);                \
+    struct SNAME##_iter PFX##_upper_bound(struct SNAME *_set_, V element);                \
+    size_t PFX##_rank(struct SNAME *_set_, V element);                                    \
+    bool PFX##_select(struct SNAME *_set_, size_t index, V *value);                       \
     /* Collection State */                                                                \
     bool PFX##_contains(struct SNAME *_set_, V element);                                  \
-    bool PFX##_empty(struct SNAME *_set_);                                                \
-    size_t PFX##_count(struct SNAME *_set_);                                              \
+    size_t PFX##_contains_many(struct SNAME *_set_, V *elements, size_t n, bool *found);  \
+    CMC_PURE bool PFX##_empty(struct SNAME *_set_);                                       \
+    CMC_PURE size_t PFX##_count(struct SNAME *_set_);                                     \
+    size_t PFX##_memory_usage(struct SNAME *_set_);                                       \
     /* Collection Utility */                                                              \
     struct SNAME *PFX##_copy_of(struct SNAME *_set_, V (*copy_func)(V));                  \
+    size_t PFX##_to_array(struct SNAME *_set_, V *CMC_RESTRICT elements, size_t size);    \
     bool PFX##_equals(struct SNAME *_set1_, struct SNAME *_set2_);                        \
     struct cmc_string PFX##_to_string(struct SNAME *_set_);                               \
+    bool PFX##_to_string_full(struct SNAME *_set_, struct cmc_string_builder *builder,    \
+                              const char *elem_fmt);                                      \
+    bool PFX##_write(struct SNAME *_set_, FILE *file, void (*fmt)(FILE *, V));            \
+    bool PFX##_write_fd(struct SNAME *_set_, int fd, void (*fmt)(struct cmc_dump *, V));  \
+    /* Collection Serialization */                                                        \
+    bool PFX##_save(struct SNAME *_set_, FILE *file, bool (*writer)(V, FILE *));          \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(V, V),                         \
+                                bool (*reader)(V *, FILE *));                             \
+    bool PFX##_save_flat(struct SNAME *_set_, FILE *file, size_t step);                   \
                                                                                           \
     /* Set Operations */                                                                  \
     struct SNAME *PFX##_union(struct SNAME *_set1_, struct SNAME *_set2_);                \
     struct SNAME *PFX##_intersection(struct SNAME *_set1_, struct SNAME *_set2_);         \
     struct SNAME *PFX##_difference(struct SNAME *_set1_, struct SNAME *_set2_);           \
     struct SNAME *PFX##_symmetric_difference(struct SNAME *_set1_, struct SNAME *_set2_); \
+    bool PFX##_union_with(struct SNAME *_set1_, struct SNAME *_set2_);                    \
+    bool PFX##_intersection_with(struct SNAME *_set1_, struct SNAME *_set2_);             \
+    bool PFX##_difference_with(struct SNAME *_set1_, struct SNAME *_set2_);               \
+    bool PFX##_symmetric_difference_with(struct SNAME *_set1_, struct SNAME *_set2_);     \
     bool PFX##_is_subset(struct SNAME *_set1_, struct SNAME *_set2_);                     \
     bool PFX##_is_superset(struct SNAME *_set1_, struct SNAME *_set2_);                   \
     bool PFX##_is_proper_subset(struct SNAME *_set1_, struct SNAME *_set2_);              \
@@ -142,6 +276,8 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
     void PFX##_iter_free(struct SNAME##_iter *iter);                                      \
     /* Iterator Initialization */                                                         \
     void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);                \
+    void PFX##_iter_init_range(struct SNAME##_iter *iter, struct SNAME *target, V lo,     \
+                               V hi);                                                     \
     /* Iterator State */                                                                  \
     bool PFX##_iter_start(struct SNAME##_iter *iter);                                     \
     bool PFX##_iter_end(struct SNAME##_iter *iter);                                       \
@@ -168,13 +304,54 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
     }                                                                                     \
                                                                                           \
 /* SOURCE ********************************************************************/
-#define CMC_GENERATE_TREESET_SOURCE(PFX, SNAME, V)                                           \
+#define CMC_IMPL_TREESET_SOURCE(PFX, SNAME, V, CMP)                                          \
                                                                                              \
     /* Implementation Detail Functions */                                                    \
-    static struct SNAME##_node *PFX##_impl_new_node(V element);                              \
+    static inline int PFX##_impl_cmp(struct SNAME *_set_, V a, V b);                         \
+    static struct SNAME##_node *PFX##_impl_new_node(struct SNAME *_set_, V element);         \
+    static void PFX##_impl_release_node(struct SNAME *_set_, struct SNAME##_node *node);     \
+    static void PFX##_impl_link_node(struct SNAME *_set_, struct SNAME##_node *node);        \
+    static void PFX##_impl_unlink_node(struct SNAME *_set_, struct SNAME##_node *node);      \
+    static struct SNAME##_node *PFX##_impl_first_node(struct SNAME *_set_);                  \
+    static struct SNAME##_node *PFX##_impl_last_node(struct SNAME *_set_);                   \
+    static struct SNAME##_node *PFX##_impl_next_node(struct SNAME##_node *node);             \
+    static struct SNAME##_node *PFX##_impl_prev_node(struct SNAME##_node *node);             \
+    static void PFX##_impl_thread_nodes(struct SNAME *_set_, struct SNAME##_node **nodes,    \
+                                        size_t n);                                           \
+    static struct SNAME##_node *PFX##_impl_join_nodes(struct SNAME *_set_,                   \
+                                                    struct SNAME##_node *left,               \
+                                                    struct SNAME##_node *node,               \
+                                                    struct SNAME##_node *right);             \
+    static void PFX##_impl_split_nodes(struct SNAME *_set_, struct SNAME##_node *node,       \
+                                       V element, struct SNAME##_node **left,                \
+                                       struct SNAME##_node **right);                         \
+    static struct SNAME##_node *PFX##_impl_detach_first(struct SNAME *_set_);                \
+    static void PFX##_impl_take_chunks(struct SNAME *_set1_, struct SNAME *_set2_);          \
+    static struct SNAME##_node *PFX##_impl_build_nodes(struct SNAME##_node **nodes,          \
+                                                     size_t n, struct SNAME##_node *parent); \
+    static bool PFX##_impl_build(struct SNAME *_set_, V *elements, size_t n,                 \
+                                 struct SNAME##_node *parent, struct SNAME##_node **result); \
     static struct SNAME##_node *PFX##_impl_get_node(struct SNAME *_set_, V element);         \
+    static void PFX##_impl_get_batch(struct SNAME *_set_, V *elements, size_t n,             \
+                                     struct SNAME##_node **nodes);                           \
+    static struct SNAME##_node *PFX##_impl_ceiling_node(struct SNAME *_set_, V element,      \
+                                                        bool strict);                        \
+    static struct SNAME##_node *PFX##_impl_floor_node(struct SNAME *_set_, V element,        \
+                                                      bool strict);                          \
+    static void PFX##_impl_iter_init_nodes(struct SNAME##_iter *iter, struct SNAME *target,  \
+                                           struct SNAME##_node *first,                       \
+                                           struct SNAME##_node *last);                       \
+    static size_t PFX##_impl_iter_count(struct SNAME##_iter *iter);                          \
+    static struct SNAME *PFX##_impl_merge(struct SNAME *_set1_, struct SNAME *_set2_,        \
+                                          bool only1, bool both, bool only2);                \
+    static bool PFX##_impl_replace(struct SNAME *_set_, struct SNAME *result);               \
+    static size_t PFX##_impl_node_rank(struct SNAME##_node *node);                           \
+    static struct SNAME##_node *PFX##_impl_select_node(struct SNAME *_set_, size_t index);   \
+    static void PFX##_impl_iter_seek(struct SNAME##_iter *iter, size_t index);               \
     static unsigned char PFX##_impl_h(struct SNAME##_node *node);                            \
     static unsigned char PFX##_impl_hupdate(struct SNAME##_node *node);                      \
+    static size_t PFX##_impl_s(struct SNAME##_node *node);                                   \
+    static size_t PFX##_impl_supdate(struct SNAME##_node *node);                             \
     static void PFX##_impl_rotate_right(struct SNAME##_node **Z);                            \
     static void PFX##_impl_rotate_left(struct SNAME##_node **Z);                             \
     static void PFX##_impl_rebalance(struct SNAME *_set_, struct SNAME##_node *node);        \
@@ -183,14 +360,29 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
                                                                                              \
     struct SNAME *PFX##_new(int (*compare)(V, V))                                            \
     {                                                                                        \
-        struct SNAME *_set_ = malloc(sizeof(struct SNAME));                                  \
+        return PFX##_new_custom(compare, NULL);                                              \
+    }                                                                                        \
+                                                                                             \
+    struct SNAME *PFX##_new_custom(int (*compare)(V, V), struct cmc_alloc_node *alloc)       \
+    {                                                                                        \
+        if (!alloc)                                                                          \
+            alloc = &cmc_alloc_node_default;                                                 \
+                                                                                             \
+        struct SNAME *_set_ = alloc->malloc(sizeof(struct SNAME));                           \
                                                                                              \
-        if (!_set_)                                                                          \
+        if (CMC_UNLIKELY(!_set_))                                                            \
             return NULL;                                                                     \
                                                                                              \
+        _set_->alloc = alloc;                                                                \
+                                                                                             \
         _set_->count = 0;                                                                    \
         _set_->root = NULL;                                                                  \
         _set_->cmp = compare;                                                                \
+        _set_->chunks = NULL;                                                                \
+                                                                                             \
+        CMC_IMPL_TREE_THREADED(_set_->first = NULL; _set_->last = NULL;)                     \
+        _set_->free_nodes = NULL;                                                            \
+        _set_->chunk_left = 0;                                                               \
                                                                                              \
         _set_->it_start = PFX##_impl_it_start;                                               \
         _set_->it_end = PFX##_impl_it_end;                                                   \
@@ -198,82 +390,128 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
         return _set_;                                                                        \
     }                                                                                        \
                                                                                              \
-    void PFX##_clear(struct SNAME *_set_, void (*deallocator)(V))                            \
+    /* Builds a perfectly balanced tree in linear time from n elements in */                 \
+    /* strictly ascending order. Returns NULL if the elements are not sorted */              \
+    /* or have duplicates */                                                                 \
+    struct SNAME *PFX##_new_from_sorted(int (*compare)(V, V), V *elements, size_t n)         \
     {                                                                                        \
-        struct SNAME##_node *scan = _set_->root;                                             \
-        struct SNAME##_node *up = NULL;                                                      \
+        struct SNAME *_set_ = PFX##_new(compare);                                            \
                                                                                              \
-        while (scan != NULL)                                                                 \
+        if (CMC_UNLIKELY(!_set_))                                                            \
+            return NULL;                                                                     \
+                                                                                             \
+        for (size_t i = 1; i < n; i++)                                                       \
         {                                                                                    \
-            if (scan->left != NULL)                                                          \
+            if (PFX##_impl_cmp(_set_, elements[i - 1], elements[i]) >= 0)                    \
             {                                                                                \
-                struct SNAME##_node *left = scan->left;                                      \
-                                                                                             \
-                scan->left = up;                                                             \
-                up = scan;                                                                   \
-                scan = left;                                                                 \
+                PFX##_free(_set_, NULL);                                                     \
+                return NULL;                                                                 \
             }                                                                                \
-            else if (scan->right != NULL)                                                    \
-            {                                                                                \
-                struct SNAME##_node *right = scan->right;                                    \
+        }                                                                                    \
                                                                                              \
-                scan->left = up;                                                             \
-                scan->right = NULL;                                                          \
-                up = scan;                                                                   \
-                scan = right;                                                                \
-            }                                                                                \
-            else                                                                             \
+        if (!PFX##_impl_build(_set_, elements, n, NULL, &(_set_->root)))                     \
+        {                                                                                    \
+            /* Every node built so far belongs to a chunk */                                 \
+            PFX##_free(_set_, NULL);                                                         \
+            return NULL;                                                                     \
+        }                                                                                    \
+                                                                                             \
+        _set_->count = n;                                                                    \
+                                                                                             \
+        return _set_;                                                                        \
+    }                                                                                        \
+                                                                                             \
+    /* Creates a set with n elements in any order, repeated ones inserted only */            \
+    /* once. Elements at the start that are in strictly ascending order are */               \
+    /* built into a balanced tree in linear time and the rest are inserted */                \
+    struct SNAME *PFX##_new_from(int (*compare)(V, V), V *elements, size_t n)                \
+    {                                                                                        \
+        struct SNAME *_set_ = PFX##_new(compare);                                            \
+                                                                                             \
+        if (CMC_UNLIKELY(!_set_))                                                            \
+            return NULL;                                                                     \
+                                                                                             \
+        size_t sorted = n > 0 ? 1 : 0;                                                       \
+                                                                                             \
+        while (sorted < n &&                                                                 \
+               PFX##_impl_cmp(_set_, elements[sorted - 1], elements[sorted]) < 0)            \
+            sorted++;                                                                        \
+                                                                                             \
+        if (!PFX##_impl_build(_set_, elements, sorted, NULL, &(_set_->root)))                \
+        {                                                                                    \
+            PFX##_free(_set_, NULL);                                                         \
+            return NULL;                                                                     \
+        }                                                                                    \
+                                                                                             \
+        _set_->count = sorted;                                                               \
+                                                                                             \
+        for (size_t i = sorted; i < n; i++)                                                  \
+        {                                                                                    \
+            if (!PFX##_insert(_set_, elements[i]) && !PFX##_contains(_set_, elements[i]))    \
             {                                                                                \
-                if (up == NULL)                                                              \
-                {                                                                            \
-                    if (deallocator)                                                         \
-                        deallocator(scan->value);                                            \
+                PFX##_free(_set_, NULL);                                                     \
+                return NULL;                                                                 \
+            }                                                                                \
+        }                                                                                    \
                                                                                              \
-                    free(scan);                                                              \
-                    scan = NULL;                                                             \
-                }                                                                            \
+        return _set_;                                                                        \
+    }                                                                                        \
                                                                                              \
-                while (up != NULL)                                                           \
-                {                                                                            \
-                    if (deallocator)                                                         \
-                        deallocator(scan->value);                                            \
-                                                                                             \
-                    free(scan);                                                              \
-                                                                                             \
-                    if (up->right != NULL)                                                   \
-                    {                                                                        \
-                        scan = up->right;                                                    \
-                        up->right = NULL;                                                    \
-                        break;                                                               \
-                    }                                                                        \
-                    else                                                                     \
-                    {                                                                        \
-                        scan = up;                                                           \
-                        up = up->left;                                                       \
-                    }                                                                        \
-                }                                                                            \
+    void PFX##_clear(struct SNAME *_set_, void (*deallocator)(V))                            \
+    {                                                                                        \
+        /* The nodes are freed with their chunks, so they are only visited if */             \
+        /* there is a deallocator, and then in the order they are laid out in */             \
+        /* memory instead of by following the tree */                                        \
+        while (_set_->chunks)                                                                \
+        {                                                                                    \
+            struct SNAME##_chunk *chunk = _set_->chunks;                                     \
+                                                                                             \
+            /* Only the newest chunk has nodes that were never used, and the */              \
+            /* removed ones have no size */                                                  \
+            for (size_t i = _set_->chunk_left; deallocator && i < chunk->capacity; i++)      \
+            {                                                                                \
+                if (chunk->nodes[i].size != 0)                                               \
+                    deallocator(chunk->nodes[i].value);                                      \
             }                                                                                \
+                                                                                             \
+            _set_->chunks = chunk->next;                                                     \
+            _set_->chunk_left = 0;                                                           \
+                                                                                             \
+            _set_->alloc->free(chunk);                                                       \
         }                                                                                    \
                                                                                              \
         _set_->count = 0;                                                                    \
         _set_->root = NULL;                                                                  \
+        _set_->free_nodes = NULL;                                                            \
+        _set_->chunk_left = 0;                                                               \
+                                                                                             \
+        CMC_IMPL_TREE_THREADED(_set_->first = NULL; _set_->last = NULL;)                     \
     }                                                                                        \
                                                                                              \
     void PFX##_free(struct SNAME *_set_, void (*deallocator)(V))                             \
     {                                                                                        \
         PFX##_clear(_set_, deallocator);                                                     \
                                                                                              \
-        free(_set_);                                                                         \
+        _set_->alloc->free(_set_);                                                           \
+    }                                                                                        \
+                                                                                             \
+    /* Frees the struct of the collection without visiting its nodes, for an */              \
+    /* allocator that frees all of them at once like a cmc_arena */                          \
+    void PFX##_release(struct SNAME *_set_)                                                  \
+    {                                                                                        \
+        _set_->alloc->free(_set_);                                                           \
     }                                                                                        \
                                                                                              \
     bool PFX##_insert(struct SNAME *_set_, V element)                                        \
     {                                                                                        \
         if (PFX##_empty(_set_))                                                              \
         {                                                                                    \
-            _set_->root = PFX##_impl_new_node(element);                                      \
+            _set_->root = PFX##_impl_new_node(_set_, element);                               \
                                                                                              \
             if (!_set_->root)                                                                \
                 return false;                                                                \
+                                                                                             \
+            PFX##_impl_link_node(_set_, _set_->root);                                        \
         }                                                                                    \
         else                                                                                 \
         {                                                                                    \
@@ -284,9 +522,9 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
             {                                                                                \
                 parent = scan;                                                               \
                                                                                              \
-                if (_set_->cmp(scan->value, element) > 0)                                    \
+                if (PFX##_impl_cmp(_set_, scan->value, element) > 0)                         \
                     scan = scan->left;                                                       \
-                else if (_set_->cmp(scan->value, element) < 0)                               \
+                else if (PFX##_impl_cmp(_set_, scan->value, element) < 0)                    \
                     scan = scan->right;                                                      \
                 else                                                                         \
                     return false;                                                            \
@@ -294,9 +532,9 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
                                                                                              \
             struct SNAME##_node *node;                                                       \
                                                                                              \
-            if (_set_->cmp(parent->value, element) > 0)                                      \
+            if (PFX##_impl_cmp(_set_, parent->value, element) > 0)                           \
             {                                                                                \
-                parent->left = PFX##_impl_new_node(element);                                 \
+                parent->left = PFX##_impl_new_node(_set_, element);                          \
                                                                                              \
                 if (!parent->left)                                                           \
                     return false;                                                            \
@@ -306,7 +544,7 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
             }                                                                                \
             else                                                                             \
             {                                                                                \
-                parent->right = PFX##_impl_new_node(element);                                \
+                parent->right = PFX##_impl_new_node(_set_, element);                         \
                                                                                              \
                 if (!parent->right)                                                          \
                     return false;                                                            \
@@ -315,6 +553,9 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
                 node = parent->right;                                                        \
             }                                                                                \
                                                                                              \
+            /* Linked while it is still a leaf under parent */                               \
+            PFX##_impl_link_node(_set_, node);                                               \
+                                                                                             \
             PFX##_impl_rebalance(_set_, node);                                               \
         }                                                                                    \
                                                                                              \
@@ -323,6 +564,76 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
         return true;                                                                         \
     }                                                                                        \
                                                                                              \
+    /* Inserts n elements in ascending order, skipping those that are already */             \
+    /* in the set or repeated in the batch, and returns how many were */                     \
+    /* inserted. A batch that is not small next to the set is merged with its */             \
+    /* nodes in order and the tree is rebuilt from them in O(n + count). A */                \
+    /* smaller one, or one that is not in ascending order, is inserted */                    \
+    /* element by element */                                                                 \
+    size_t PFX##_insert_sorted_many(struct SNAME *_set_, V *elements, size_t n)              \
+    {                                                                                        \
+        bool sorted = true;                                                                  \
+                                                                                             \
+        for (size_t i = 1; i < n && sorted; i++)                                             \
+            sorted = PFX##_impl_cmp(_set_, elements[i - 1], elements[i]) <= 0;               \
+                                                                                             \
+        /* The rebuild visits every node, so the batch has to be at least an */              \
+        /* eighth of the tree */                                                             \
+        struct SNAME##_node **nodes = NULL;                                                  \
+        size_t bytes = sizeof(struct SNAME##_node *) * (_set_->count + n);                   \
+                                                                                             \
+        if (n > 0 && sorted && n >= _set_->count / 8)                                        \
+            nodes = _set_->alloc->malloc(bytes);                                             \
+                                                                                             \
+        if (!nodes)                                                                          \
+        {                                                                                    \
+            size_t inserted = 0;                                                             \
+                                                                                             \
+            for (size_t i = 0; i < n; i++)                                                   \
+                inserted += PFX##_insert(_set_, elements[i]);                                \
+                                                                                             \
+            return inserted;                                                                 \
+        }                                                                                    \
+                                                                                             \
+        struct SNAME##_node *scan = PFX##_impl_first_node(_set_);                            \
+        size_t total = 0;                                                                    \
+        size_t i = 0;                                                                        \
+                                                                                             \
+        while (scan != NULL || i < n)                                                        \
+        {                                                                                    \
+            if (i < n && total > 0 &&                                                        \
+                PFX##_impl_cmp(_set_, nodes[total - 1]->value, elements[i]) == 0)            \
+                i++;                                                                         \
+            else if (i == n ||                                                               \
+                     (scan != NULL && PFX##_impl_cmp(_set_, scan->value, elements[i]) <= 0)) \
+            {                                                                                \
+                nodes[total++] = scan;                                                       \
+                scan = PFX##_impl_next_node(scan);                                           \
+            }                                                                                \
+            else if ((nodes[total] = PFX##_impl_new_node(_set_, elements[i])) != NULL)       \
+            {                                                                                \
+                total++;                                                                     \
+                i++;                                                                         \
+            }                                                                                \
+            else                                                                             \
+            {                                                                                \
+                /* Out of memory, the rest of the batch is left out */                       \
+                i = n;                                                                       \
+            }                                                                                \
+        }                                                                                    \
+                                                                                             \
+        size_t inserted = total - _set_->count;                                              \
+                                                                                             \
+        _set_->root = PFX##_impl_build_nodes(nodes, total, NULL);                            \
+        _set_->count = total;                                                                \
+                                                                                             \
+        PFX##_impl_thread_nodes(_set_, nodes, total);                                        \
+                                                                                             \
+        _set_->alloc->free(nodes);                                                           \
+                                                                                             \
+        return inserted;                                                                     \
+    }                                                                                        \
+                                                                                             \
     bool PFX##_remove(struct SNAME *_set_, V element)                                        \
     {                                                                                        \
         struct SNAME##_node *node = PFX##_impl_get_node(_set_, element);                     \
@@ -348,7 +659,7 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
                     node->parent->left = NULL;                                               \
             }                                                                                \
                                                                                              \
-            free(node);                                                                      \
+            PFX##_impl_release_node(_set_, node);                                            \
         }                                                                                    \
         else if (node->left == NULL)                                                         \
         {                                                                                    \
@@ -369,7 +680,7 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
                     node->parent->left = node->right;                                        \
             }                                                                                \
                                                                                              \
-            free(node);                                                                      \
+            PFX##_impl_release_node(_set_, node);                                            \
         }                                                                                    \
         else if (node->right == NULL)                                                        \
         {                                                                                    \
@@ -390,7 +701,7 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
                     node->parent->left = node->left;                                         \
             }                                                                                \
                                                                                              \
-            free(node);                                                                      \
+            PFX##_impl_release_node(_set_, node);                                            \
         }                                                                                    \
         else                                                                                 \
         {                                                                                    \
@@ -428,7 +739,7 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
                     temp->parent->left = temp->left;                                         \
             }                                                                                \
                                                                                              \
-            free(temp);                                                                      \
+            PFX##_impl_release_node(_set_, temp);                                            \
                                                                                              \
             node->value = temp_value;                                                        \
         }                                                                                    \
@@ -444,560 +755,1540 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
         return true;                                                                         \
     }                                                                                        \
                                                                                              \
-    bool PFX##_max(struct SNAME *_set_, V *value)                                            \
+    /* Removes every element for which pred is true and returns how many */                  \
+    /* were removed. The nodes that are kept are gathered in order in one */                 \
+    /* pass and the tree is rebuilt from them in O(count). If that buffer */                 \
+    /* cannot be allocated each element is removed on its own */                             \
+    size_t PFX##_remove_if(struct SNAME *_set_, bool (*pred)(V), void (*deallocator)(V))     \
     {                                                                                        \
-        if (PFX##_empty(_set_))                                                              \
-            return false;                                                                    \
+        size_t count = _set_->count;                                                         \
+        struct SNAME##_node **nodes = NULL;                                                  \
                                                                                              \
-        struct SNAME##_node *scan = _set_->root;                                             \
+        if (count > 0)                                                                       \
+            nodes = _set_->alloc->malloc(sizeof(struct SNAME##_node *) * count);             \
                                                                                              \
-        while (scan->right != NULL)                                                          \
-            scan = scan->right;                                                              \
+        if (!nodes)                                                                          \
+        {                                                                                    \
+            size_t removed = 0;                                                              \
+            struct SNAME##_node *scan = PFX##_impl_first_node(_set_);                        \
                                                                                              \
-        *value = scan->value;                                                                \
+            while (scan != NULL)                                                             \
+            {                                                                                \
+                V value = scan->value;                                                       \
                                                                                              \
-        return true;                                                                         \
-    }                                                                                        \
+                if (!pred(value))                                                            \
+                {                                                                            \
+                    scan = PFX##_impl_next_node(scan);                                       \
+                    continue;                                                                \
+                }                                                                            \
                                                                                              \
-    bool PFX##_min(struct SNAME *_set_, V *value)                                            \
-    {                                                                                        \
-        if (PFX##_empty(_set_))                                                              \
-            return false;                                                                    \
+                PFX##_remove(_set_, value);                                                  \
                                                                                              \
-        struct SNAME##_node *scan = _set_->root;                                             \
+                if (deallocator)                                                             \
+                    deallocator(value);                                                      \
                                                                                              \
-        while (scan->left != NULL)                                                           \
-            scan = scan->left;                                                               \
+                removed++;                                                                   \
                                                                                              \
-        *value = scan->value;                                                                \
+                scan = PFX##_impl_ceiling_node(_set_, value, true);                          \
+            }                                                                                \
                                                                                              \
-        return true;                                                                         \
-    }                                                                                        \
+            return removed;                                                                  \
+        }                                                                                    \
                                                                                              \
-    bool PFX##_contains(struct SNAME *_set_, V element)                                      \
-    {                                                                                        \
-        struct SNAME##_node *scan = _set_->root;                                             \
+        /* Kept nodes fill the buffer from the start and removed ones from */                \
+        /* the end, as they can only be released once the walk is over */                    \
+        size_t kept = 0;                                                                     \
+        size_t removed = 0;                                                                  \
                                                                                              \
-        while (scan != NULL)                                                                 \
+        for (struct SNAME##_node *scan = PFX##_impl_first_node(_set_); scan != NULL;         \
+             scan = PFX##_impl_next_node(scan))                                              \
         {                                                                                    \
-            if (_set_->cmp(scan->value, element) > 0)                                        \
-                scan = scan->left;                                                           \
-            else if (_set_->cmp(scan->value, element) < 0)                                   \
-                scan = scan->right;                                                          \
+            if (pred(scan->value))                                                           \
+                nodes[count - ++removed] = scan;                                             \
             else                                                                             \
-                return true;                                                                 \
+                nodes[kept++] = scan;                                                        \
         }                                                                                    \
                                                                                              \
-        return false;                                                                        \
-    }                                                                                        \
-                                                                                             \
-    bool PFX##_empty(struct SNAME *_set_)                                                    \
-    {                                                                                        \
-        return _set_->count == 0;                                                            \
-    }                                                                                        \
-                                                                                             \
-    size_t PFX##_count(struct SNAME *_set_)                                                  \
-    {                                                                                        \
-        return _set_->count;                                                                 \
-    }                                                                                        \
-                                                                                             \
-    struct SNAME *PFX##_copy_of(struct SNAME *_set_, V (*copy_func)(V))                      \
-    {                                                                                        \
-        struct SNAME *result = PFX##_new(_set_->cmp);                                        \
-                                                                                             \
-        if (!result)                                                                         \
-            return NULL;                                                                     \
-                                                                                             \
-        struct SNAME##_iter iter;                                                            \
-        PFX##_iter_init(&iter, _set_);                                                       \
-                                                                                             \
-        if (!PFX##_empty(_set_))                                                             \
+        for (size_t i = kept; i < count; i++)                                                \
         {                                                                                    \
-            for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter)) \
-            {                                                                                \
-                if (copy_func)                                                               \
-                    PFX##_insert(result, copy_func(PFX##_iter_value(&iter)));                \
-                else                                                                         \
-                    PFX##_insert(result, PFX##_iter_value(&iter));                           \
-            }                                                                                \
-        }                                                                                    \
-                                                                                             \
-        return result;                                                                       \
-    }                                                                                        \
-                                                                                             \
-    bool PFX##_equals(struct SNAME *_set1_, struct SNAME *_set2_)                            \
-    {                                                                                        \
-        if (PFX##_count(_set1_) != PFX##_count(_set2_))                                      \
-            return false;                                                                    \
+            if (deallocator)                                                                 \
+                deallocator(nodes[i]->value);                                                \
                                                                                              \
-        struct SNAME##_iter iter;                                                            \
-        PFX##_iter_init(&iter, _set1_);                                                      \
+            PFX##_impl_release_node(_set_, nodes[i]);                                        \
+        }                                                                                    \
                                                                                              \
-        for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))     \
+        if (removed > 0)                                                                     \
         {                                                                                    \
-            if (PFX##_impl_get_node(_set2_, PFX##_iter_value(&iter)) == NULL)                \
-                return false;                                                                \
+            _set_->root = PFX##_impl_build_nodes(nodes, kept, NULL);                         \
+            _set_->count = kept;                                                             \
+                                                                                             \
+            PFX##_impl_thread_nodes(_set_, nodes, kept);                                     \
         }                                                                                    \
                                                                                              \
-        return true;                                                                         \
+        _set_->alloc->free(nodes);                                                           \
+                                                                                             \
+        return removed;                                                                      \
     }                                                                                        \
                                                                                              \
-    struct cmc_string PFX##_to_string(struct SNAME *_set_)                                   \
+    /* Moves the elements that are greater than or equal to element to a new set, */         \
+    /* which is returned, or NULL if it could not be allocated. The tree is */               \
+    /* split in O(log n), but nodes are freed with the chunks of the set */                  \
+    /* that allocated them, so the smaller side is then copied to the new */                 \
+    /* set and the larger one stays in the nodes it already has. With k */                   \
+    /* elements less than element that takes O(min(k, n - k)) in total */                    \
+    struct SNAME *PFX##_split(struct SNAME *_set_, V element)                                \
     {                                                                                        \
-        struct cmc_string str;                                                               \
-        struct SNAME *s_ = _set_;                                                            \
-        const char *name = #SNAME;                                                           \
+        struct SNAME *result = PFX##_new_custom(_set_->cmp, _set_->alloc);                   \
                                                                                              \
-        snprintf(str.s, cmc_string_len, cmc_string_fmt_treeset,                              \
-                 name, s_, s_->root, s_->count, s_->cmp);                                    \
+        if (CMC_UNLIKELY(!result))                                                           \
+            return NULL;                                                                     \
                                                                                              \
-        return str;                                                                          \
-    }                                                                                        \
+        struct SNAME##_node *left = NULL;                                                    \
+        struct SNAME##_node *right = NULL;                                                   \
                                                                                              \
-    struct SNAME *PFX##_union(struct SNAME *_set1_, struct SNAME *_set2_)                    \
-    {                                                                                        \
-        struct SNAME *_set_r_ = PFX##_new(_set1_->cmp);                                      \
+        PFX##_impl_split_nodes(_set_, _set_->root, element, &left, &right);                  \
                                                                                              \
-        if (!_set_r_)                                                                        \
-            return NULL;                                                                     \
+        bool moves_left = PFX##_impl_s(left) < PFX##_impl_s(right);                          \
+        struct SNAME##_node *moved = moves_left ? left : right;                              \
+        size_t n = PFX##_impl_s(moved);                                                      \
                                                                                              \
-        struct SNAME##_iter iter1, iter2;                                                    \
-        PFX##_iter_init(&iter1, _set1_);                                                     \
-        PFX##_iter_init(&iter2, _set2_);                                                     \
+        /* The nodes that are copied, followed by their copies */                            \
+        struct SNAME##_node **nodes = NULL;                                                  \
                                                                                              \
-        for (PFX##_iter_to_start(&iter1); !PFX##_iter_end(&iter1); PFX##_iter_next(&iter1))  \
+        if (n > 0)                                                                           \
         {                                                                                    \
-            PFX##_insert(_set_r_, PFX##_iter_value(&iter1));                                 \
+            nodes = _set_->alloc->malloc(sizeof(struct SNAME##_node *) * n * 2);             \
+                                                                                             \
+            while (nodes && moved->left != NULL)                                             \
+                moved = moved->left;                                                         \
         }                                                                                    \
                                                                                              \
-        for (PFX##_iter_to_start(&iter2); !PFX##_iter_end(&iter2); PFX##_iter_next(&iter2))  \
+        for (size_t i = 0; nodes && i < n; i++, moved = PFX##_impl_next_node(moved))         \
         {                                                                                    \
-            PFX##_insert(_set_r_, PFX##_iter_value(&iter2));                                 \
+            nodes[i] = moved;                                                                \
+            nodes[n + i] = NULL;                                                             \
         }                                                                                    \
                                                                                              \
-        return _set_r_;                                                                      \
-    }                                                                                        \
+        for (size_t i = 0; nodes && i < n; i++)                                              \
+        {                                                                                    \
+            struct SNAME##_node *old = nodes[i];                                             \
                                                                                              \
-    struct SNAME *PFX##_intersection(struct SNAME *_set1_, struct SNAME *_set2_)             \
-    {                                                                                        \
-        struct SNAME *_set_r_ = PFX##_new(_set1_->cmp);                                      \
+            if (!(nodes[n + i] = PFX##_impl_new_node(result, old->value)))                   \
+                break;                                                                       \
+        }                                                                                    \
                                                                                              \
-        if (!_set_r_)                                                                        \
-            return NULL;                                                                     \
+        if (n > 0 && (!nodes || !nodes[n * 2 - 1]))                                          \
+        {                                                                                    \
+            /* Puts the tree back together around the first node on the right */             \
+            _set_->root = right;                                                             \
                                                                                              \
-        struct SNAME *_set_A_ = _set1_->count < _set2_->count ? _set1_ : _set2_;             \
-        struct SNAME *_set_B_ = _set_A_ == _set1_ ? _set2_ : _set1_;                         \
+            if (right != NULL)                                                               \
+            {                                                                                \
+                struct SNAME##_node *node = PFX##_impl_detach_first(_set_);                  \
                                                                                              \
-        struct SNAME##_iter iter;                                                            \
-        PFX##_iter_init(&iter, _set_A_);                                                     \
+                _set_->root = PFX##_impl_join_nodes(_set_, left, node, _set_->root);         \
+            }                                                                                \
+            else                                                                             \
+                _set_->root = left;                                                          \
                                                                                              \
-        for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))     \
-        {                                                                                    \
-            V value = PFX##_iter_value(&iter);                                               \
+            if (nodes)                                                                       \
+                _set_->alloc->free(nodes);                                                   \
+                                                                                             \
+            PFX##_free(result, NULL);                                                        \
                                                                                              \
-            if (PFX##_impl_get_node(_set_B_, value) != NULL)                                 \
-                PFX##_insert(_set_r_, value);                                                \
+            return NULL;                                                                     \
         }                                                                                    \
                                                                                              \
-        return _set_r_;                                                                      \
-    }                                                                                        \
+        for (size_t i = 0; i < n; i++)                                                       \
+            PFX##_impl_release_node(_set_, nodes[i]);                                        \
                                                                                              \
-    struct SNAME *PFX##_difference(struct SNAME *_set1_, struct SNAME *_set2_)               \
-    {                                                                                        \
-        struct SNAME *_set_r_ = PFX##_new(_set1_->cmp);                                      \
+        _set_->root = moves_left ? right : left;                                             \
+        _set_->count -= n;                                                                   \
                                                                                              \
-        if (!_set_r_)                                                                        \
-            return NULL;                                                                     \
+        result->root = n > 0 ? PFX##_impl_build_nodes(nodes + n, n, NULL) : NULL;            \
+        result->count = n;                                                                   \
                                                                                              \
-        struct SNAME##_iter iter;                                                            \
-        PFX##_iter_init(&iter, _set1_);                                                      \
+        if (n > 0)                                                                           \
+        {                                                                                    \
+            PFX##_impl_thread_nodes(result, nodes + n, n);                                   \
                                                                                              \
-        for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))     \
+            _set_->alloc->free(nodes);                                                       \
+        }                                                                                    \
+        /* The set given keeps the smaller elements */                                       \
+        if (moves_left)                                                                      \
         {                                                                                    \
-            V value = PFX##_iter_value(&iter);                                               \
+            struct SNAME swap = *_set_;                                                      \
                                                                                              \
-            if (PFX##_impl_get_node(_set2_, value) == NULL)                                  \
-                PFX##_insert(_set_r_, value);                                                \
+            *_set_ = *result;                                                                \
+            *result = swap;                                                                  \
         }                                                                                    \
                                                                                              \
-        return _set_r_;                                                                      \
+        return result;                                                                       \
     }                                                                                        \
                                                                                              \
-    struct SNAME *PFX##_symmetric_difference(struct SNAME *_set1_, struct SNAME *_set2_)     \
+    /* Moves every element of the second set to the first one if all of them */              \
+    /* are greater than those of the first set, leaving the second one empty, */             \
+    /* and returns false otherwise or if they do not share an allocator. The */              \
+    /* trees are joined in O(log n) and the chunks of the second set and its */              \
+    /* removed nodes are handed over to the first one */                                     \
+    bool PFX##_join(struct SNAME *_set1_, struct SNAME *_set2_)                              \
     {                                                                                        \
-        struct SNAME *_set_r_ = PFX##_new(_set1_->cmp);                                      \
+        if (_set1_ == _set2_ || _set1_->alloc != _set2_->alloc)                              \
+            return false;                                                                    \
                                                                                              \
-        if (!_set_r_)                                                                        \
-            return NULL;                                                                     \
+        struct SNAME##_node *last = PFX##_impl_last_node(_set1_);                            \
+        struct SNAME##_node *first = PFX##_impl_first_node(_set2_);                          \
                                                                                              \
-        struct SNAME##_iter iter1, iter2;                                                    \
-        PFX##_iter_init(&iter1, _set1_);                                                     \
-        PFX##_iter_init(&iter2, _set2_);                                                     \
+        if (last && first && PFX##_impl_cmp(_set1_, last->value, first->value) >= 0)         \
+            return false;                                                                    \
                                                                                              \
-        for (PFX##_iter_to_start(&iter1); !PFX##_iter_end(&iter1); PFX##_iter_next(&iter1))  \
+        if (first != NULL)                                                                   \
         {                                                                                    \
-            V value = PFX##_iter_value(&iter1);                                              \
+            struct SNAME##_node *node = PFX##_impl_detach_first(_set2_);                     \
                                                                                              \
-            if (PFX##_impl_get_node(_set2_, value) == NULL)                                  \
-                PFX##_insert(_set_r_, value);                                                \
-        }                                                                                    \
+            _set1_->root = PFX##_impl_join_nodes(_set1_, _set1_->root, node, _set2_->root);  \
                                                                                              \
-        for (PFX##_iter_to_start(&iter2); !PFX##_iter_end(&iter2); PFX##_iter_next(&iter2))  \
-        {                                                                                    \
-            V value = PFX##_iter_value(&iter2);                                              \
+            CMC_IMPL_TREE_THREADED(                                                          \
+                if (last != NULL)                                                            \
+                {                                                                            \
+                    last->next = first;                                                      \
+                    first->prev = last;                                                      \
+                }                                                                            \
+                else                                                                         \
+                    _set1_->first = first;                                                   \
                                                                                              \
-            if (PFX##_impl_get_node(_set1_, value) == NULL)                                  \
-                PFX##_insert(_set_r_, value);                                                \
+                _set1_->last = _set2_->last;                                                 \
+            )                                                                                \
         }                                                                                    \
                                                                                              \
-        return _set_r_;                                                                      \
+        _set1_->count += _set2_->count;                                                      \
+                                                                                             \
+        PFX##_impl_take_chunks(_set1_, _set2_);                                              \
+                                                                                             \
+        _set2_->root = NULL;                                                                 \
+        _set2_->count = 0;                                                                   \
+        CMC_IMPL_TREE_THREADED(_set2_->first = NULL; _set2_->last = NULL;)                   \
+                                                                                             \
+        return true;                                                                         \
     }                                                                                        \
                                                                                              \
-    /* Is _set1_ a subset of _set2_ ? */                                                     \
-    /* A set X is a subset of a set Y when: X <= Y */                                        \
-    /* If X is a subset of Y, then Y is a superset of X */                                   \
-    bool PFX##_is_subset(struct SNAME *_set1_, struct SNAME *_set2_)                         \
+    bool PFX##_max(struct SNAME *_set_, V *value)                                            \
     {                                                                                        \
-        /* If the cardinality of _set1_ is greater than that of _set2_, then it is safe */   \
-        /* to say that _set1_ can't be a subset of _set2_ */                                 \
-        if (PFX##_count(_set1_) > PFX##_count(_set2_))                                       \
+        if (PFX##_empty(_set_))                                                              \
             return false;                                                                    \
                                                                                              \
-        /* The empty set is a subset of all sets */                                          \
-        if (PFX##_empty(_set1_))                                                             \
-            return true;                                                                     \
+        struct SNAME##_node *scan = PFX##_impl_last_node(_set_);                             \
+                                                                                             \
+        *value = scan->value;                                                                \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_min(struct SNAME *_set_, V *value)                                            \
+    {                                                                                        \
+        if (PFX##_empty(_set_))                                                              \
+            return false;                                                                    \
+                                                                                             \
+        struct SNAME##_node *scan = PFX##_impl_first_node(_set_);                            \
+                                                                                             \
+        *value = scan->value;                                                                \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* The largest element that is less than or equal to element */                          \
+    bool PFX##_floor(struct SNAME *_set_, V element, V *value)                               \
+    {                                                                                        \
+        struct SNAME##_node *node = PFX##_impl_floor_node(_set_, element, false);            \
+                                                                                             \
+        if (!node)                                                                           \
+            return false;                                                                    \
+                                                                                             \
+        if (value)                                                                           \
+            *value = node->value;                                                            \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* The smallest element that is greater than or equal to element */                      \
+    bool PFX##_ceiling(struct SNAME *_set_, V element, V *value)                             \
+    {                                                                                        \
+        struct SNAME##_node *node = PFX##_impl_ceiling_node(_set_, element, false);          \
+                                                                                             \
+        if (!node)                                                                           \
+            return false;                                                                    \
+                                                                                             \
+        if (value)                                                                           \
+            *value = node->value;                                                            \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* An iterator from the first element that is not less than element to */                \
+    /* the end of the set. Its index starts at 0 on that element */                          \
+    struct SNAME##_iter PFX##_lower_bound(struct SNAME *_set_, V element)                    \
+    {                                                                                        \
+        struct SNAME##_iter iter;                                                            \
+        struct SNAME##_node *first = PFX##_impl_ceiling_node(_set_, element, false);         \
+        struct SNAME##_node *last = PFX##_impl_last_node(_set_);                             \
+                                                                                             \
+        PFX##_impl_iter_init_nodes(&iter, _set_, first, last);                               \
+                                                                                             \
+        return iter;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* An iterator from the first element that is greater than element to the */             \
+    /* end of the set. Its index starts at 0 on that element */                              \
+    struct SNAME##_iter PFX##_upper_bound(struct SNAME *_set_, V element)                    \
+    {                                                                                        \
+        struct SNAME##_iter iter;                                                            \
+        struct SNAME##_node *first = PFX##_impl_ceiling_node(_set_, element, true);          \
+        struct SNAME##_node *last = PFX##_impl_last_node(_set_);                             \
+                                                                                             \
+        PFX##_impl_iter_init_nodes(&iter, _set_, first, last);                               \
+                                                                                             \
+        return iter;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* Amount of elements that are less than element */                                      \
+    size_t PFX##_rank(struct SNAME *_set_, V element)                                        \
+    {                                                                                        \
+        struct SNAME##_node *scan = _set_->root;                                             \
+                                                                                             \
+        size_t rank = 0;                                                                     \
+                                                                                             \
+        while (scan != NULL)                                                                 \
+        {                                                                                    \
+            if (PFX##_impl_cmp(_set_, scan->value, element) < 0)                             \
+            {                                                                                \
+                rank += PFX##_impl_s(scan->left) + 1;                                        \
+                scan = scan->right;                                                          \
+            }                                                                                \
+            else                                                                             \
+                scan = scan->left;                                                           \
+        }                                                                                    \
+                                                                                             \
+        return rank;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* The element at the given position in ascending order, starting at 0 */                \
+    bool PFX##_select(struct SNAME *_set_, size_t index, V *value)                           \
+    {                                                                                        \
+        struct SNAME##_node *node = PFX##_impl_select_node(_set_, index);                    \
+                                                                                             \
+        if (!node)                                                                           \
+            return false;                                                                    \
+                                                                                             \
+        if (value)                                                                           \
+            *value = node->value;                                                            \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_contains(struct SNAME *_set_, V element)                                      \
+    {                                                                                        \
+        struct SNAME##_node *scan = _set_->root;                                             \
+                                                                                             \
+        while (scan != NULL)                                                                 \
+        {                                                                                    \
+            if (PFX##_impl_cmp(_set_, scan->value, element) > 0)                             \
+                scan = scan->left;                                                           \
+            else if (PFX##_impl_cmp(_set_, scan->value, element) < 0)                        \
+                scan = scan->right;                                                          \
+            else                                                                             \
+                return true;                                                                 \
+        }                                                                                    \
+                                                                                             \
+        return false;                                                                        \
+    }                                                                                        \
+                                                                                             \
+    /* Writes whether each element is in the set to found, which can be */                   \
+    /* NULL, and returns how many were found. The searches of a batch of */                  \
+    /* elements go down the tree together so their cache misses overlap */                   \
+    size_t PFX##_contains_many(struct SNAME *_set_, V *elements, size_t n, bool *found)      \
+    {                                                                                        \
+        struct SNAME##_node *nodes[CMC_IMPL_TREE_BATCH];                                     \
+        size_t total = 0;                                                                    \
+                                                                                             \
+        for (size_t i = 0; i < n; i += CMC_IMPL_TREE_BATCH)                                  \
+        {                                                                                    \
+            size_t batch = n - i < CMC_IMPL_TREE_BATCH ? n - i : CMC_IMPL_TREE_BATCH;        \
+                                                                                             \
+            PFX##_impl_get_batch(_set_, elements + i, batch, nodes);                         \
+                                                                                             \
+            for (size_t j = 0; j < batch; j++)                                               \
+            {                                                                                \
+                if (nodes[j])                                                                \
+                    total++;                                                                 \
+                                                                                             \
+                if (found)                                                                   \
+                    found[i + j] = nodes[j] != NULL;                                         \
+            }                                                                                \
+        }                                                                                    \
+                                                                                             \
+        return total;                                                                        \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_empty(struct SNAME *_set_)                                                    \
+    {                                                                                        \
+        return _set_->count == 0;                                                            \
+    }                                                                                        \
+                                                                                             \
+    size_t PFX##_count(struct SNAME *_set_)                                                  \
+    {                                                                                        \
+        return _set_->count;                                                                 \
+    }                                                                                        \
+                                                                                             \
+    size_t PFX##_memory_usage(struct SNAME *_set_)                                           \
+    {                                                                                        \
+        size_t bytes = sizeof(struct SNAME);                                                 \
+                                                                                             \
+        for (struct SNAME##_chunk *chunk = _set_->chunks; chunk; chunk = chunk->next)        \
+        {                                                                                    \
+            bytes += sizeof(struct SNAME##_chunk);                                           \
+            bytes += sizeof(struct SNAME##_node) * chunk->capacity;                          \
+        }                                                                                    \
+                                                                                             \
+        return bytes;                                                                        \
+    }                                                                                        \
+                                                                                             \
+    struct SNAME *PFX##_copy_of(struct SNAME *_set_, V (*copy_func)(V))                      \
+    {                                                                                        \
+        struct SNAME *result = PFX##_new_custom(_set_->cmp, _set_->alloc);                   \
+                                                                                             \
+        if (CMC_UNLIKELY(!result))                                                           \
+            return NULL;                                                                     \
+                                                                                             \
+        struct SNAME##_iter iter;                                                            \
+        PFX##_iter_init(&iter, _set_);                                                       \
+                                                                                             \
+        if (!PFX##_empty(_set_))                                                             \
+        {                                                                                    \
+            for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter)) \
+            {                                                                                \
+                if (copy_func)                                                               \
+                    PFX##_insert(result, copy_func(PFX##_iter_value(&iter)));                \
+                else                                                                         \
+                    PFX##_insert(result, PFX##_iter_value(&iter));                           \
+            }                                                                                \
+        }                                                                                    \
+                                                                                             \
+        return result;                                                                       \
+    }                                                                                        \
+                                                                                             \
+    /* Copies up to size elements, in ascending order, to elements and */                    \
+    /* returns how many were copied */                                                       \
+    size_t PFX##_to_array(struct SNAME *_set_, V *CMC_RESTRICT elements, size_t size)        \
+    {                                                                                        \
+        size_t i = 0;                                                                        \
+                                                                                             \
+        if (PFX##_empty(_set_))                                                              \
+            return 0;                                                                        \
                                                                                              \
         struct SNAME##_iter iter;                                                            \
+        PFX##_iter_init(&iter, _set_);                                                       \
+                                                                                             \
+        for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter) && i < size;                 \
+             PFX##_iter_next(&iter))                                                         \
+            elements[i++] = PFX##_iter_value(&iter);                                         \
+                                                                                             \
+        return i;                                                                            \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_equals(struct SNAME *_set1_, struct SNAME *_set2_)                            \
+    {                                                                                        \
+        if (PFX##_count(_set1_) != PFX##_count(_set2_))                                      \
+            return false;                                                                    \
                                                                                              \
+        struct SNAME##_iter iter;                                                            \
         PFX##_iter_init(&iter, _set1_);                                                      \
                                                                                              \
         for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))     \
         {                                                                                    \
-            V value = PFX##_iter_value(&iter);                                               \
-                                                                                             \
-            if (!PFX##_contains(_set2_, value))                                              \
+            if (PFX##_impl_get_node(_set2_, PFX##_iter_value(&iter)) == NULL)                \
                 return false;                                                                \
         }                                                                                    \
                                                                                              \
         return true;                                                                         \
     }                                                                                        \
                                                                                              \
-    /* Is _set1_ a superset of _set2_ ? */                                                   \
-    /* A set X is a superset of a set Y when: X >= Y */                                      \
-    /* If X is a superset of Y, then Y is a subset of X */                                   \
-    bool PFX##_is_superset(struct SNAME *_set1_, struct SNAME *_set2_)                       \
+    struct cmc_string PFX##_to_string(struct SNAME *_set_)                                   \
     {                                                                                        \
-        return PFX##_is_subset(_set2_, _set1_);                                              \
+        struct cmc_string str;                                                               \
+        struct SNAME *s_ = _set_;                                                            \
+        const char *name = #SNAME;                                                           \
+                                                                                             \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_treeset,                              \
+                 name, s_, s_->root, s_->count, s_->cmp);                                    \
+                                                                                             \
+        return str;                                                                          \
     }                                                                                        \
                                                                                              \
-    /* Is _set1_ a proper subset of _set2_ ? */                                              \
-    /* A set X is a proper subset of a set Y when: X < Y */                                  \
-    /* If X is a proper subset of Y, then Y is a proper superset of X */                     \
-    bool PFX##_is_proper_subset(struct SNAME *_set1_, struct SNAME *_set2_)                  \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE)                           \
+                                                                                             \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE, (V))                             \
+                                                                                             \
+    bool PFX##_save(struct SNAME *_set_, FILE *file, bool (*writer)(V, FILE *))              \
     {                                                                                        \
-        /* If the cardinality of _set1_ is greater than or equal to that of _set2_, then */  \
-        /* it is safe to say that _set1_ can't be a proper subset of _set2_ */               \
-        if (PFX##_count(_set1_) >= PFX##_count(_set2_))                                      \
+        uint32_t flags = writer ? 0 : CMC_SERIAL_RAW_VALUES;                                 \
+                                                                                             \
+        if (!cmc_serial_write_header(file, "treeset", flags, 0, sizeof(V), 0, _set_->count,  \
+                                     _set_->count, 0))                                       \
+            return false;                                                                    \
+                                                                                             \
+        struct SNAME##_iter iter;                                                            \
+        PFX##_iter_init(&iter, _set_);                                                       \
+                                                                                             \
+        if (!PFX##_empty(_set_))                                                             \
+        {                                                                                    \
+            for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter)) \
+            {                                                                                \
+                V value = PFX##_iter_value(&iter);                                           \
+                                                                                             \
+                if (!CMC_SERIAL_WRITE(writer, value, file))                                  \
+                    return false;                                                            \
+            }                                                                                \
+        }                                                                                    \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* The reader is only used if the set was saved with a writer */                         \
+    struct SNAME *PFX##_restore(FILE *file, int (*compare)(V, V),                            \
+                                bool (*reader)(V *, FILE *))                                 \
+    {                                                                                        \
+        struct cmc_serial_header header;                                                     \
+                                                                                             \
+        if (!cmc_serial_read_header(file, "treeset", 0, sizeof(V), &header))                 \
+            return NULL;                                                                     \
+                                                                                             \
+        struct SNAME *_set_ = PFX##_new(compare);                                            \
+                                                                                             \
+        if (CMC_UNLIKELY(!_set_))                                                            \
+            return NULL;                                                                     \
+                                                                                             \
+        bool raw = header.flags & CMC_SERIAL_RAW_VALUES;                                     \
+                                                                                             \
+        for (size_t i = 0; i < header.count; i++)                                            \
+        {                                                                                    \
+            V value;                                                                         \
+                                                                                             \
+            if (!CMC_SERIAL_READ(raw, reader, &value, file) || !PFX##_insert(_set_, value))  \
+            {                                                                                \
+                PFX##_free(_set_, NULL);                                                     \
+                return NULL;                                                                 \
+            }                                                                                \
+        }                                                                                    \
+                                                                                             \
+        return _set_;                                                                        \
+    }                                                                                        \
+                                                                                             \
+    /* The set operations walk both sets in order at the same time and build */              \
+    /* the resulting tree in linear time */                                                  \
+    struct SNAME *PFX##_union(struct SNAME *_set1_, struct SNAME *_set2_)                    \
+    {                                                                                        \
+        return PFX##_impl_merge(_set1_, _set2_, true, true, true);                           \
+    }                                                                                        \
+                                                                                             \
+    struct SNAME *PFX##_intersection(struct SNAME *_set1_, struct SNAME *_set2_)             \
+    {                                                                                        \
+        return PFX##_impl_merge(_set1_, _set2_, false, true, false);                         \
+    }                                                                                        \
+                                                                                             \
+    struct SNAME *PFX##_difference(struct SNAME *_set1_, struct SNAME *_set2_)               \
+    {                                                                                        \
+        return PFX##_impl_merge(_set1_, _set2_, true, false, false);                         \
+    }                                                                                        \
+                                                                                             \
+    struct SNAME *PFX##_symmetric_difference(struct SNAME *_set1_, struct SNAME *_set2_)     \
+    {                                                                                        \
+        return PFX##_impl_merge(_set1_, _set2_, true, false, true);                          \
+    }                                                                                        \
+                                                                                             \
+    /* The in-place set operations store the result in _set1_. Elements of */                \
+    /* _set2_ are shared by both sets and the ones taken out of _set1_ are not */            \
+    /* freed. Returns false if the result could not be allocated, leaving */                 \
+    /* _set1_ as it was */                                                                   \
+    bool PFX##_union_with(struct SNAME *_set1_, struct SNAME *_set2_)                        \
+    {                                                                                        \
+        return PFX##_impl_replace(_set1_, PFX##_union(_set1_, _set2_));                      \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_intersection_with(struct SNAME *_set1_, struct SNAME *_set2_)                 \
+    {                                                                                        \
+        return PFX##_impl_replace(_set1_, PFX##_intersection(_set1_, _set2_));               \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_difference_with(struct SNAME *_set1_, struct SNAME *_set2_)                   \
+    {                                                                                        \
+        return PFX##_impl_replace(_set1_, PFX##_difference(_set1_, _set2_));                 \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_symmetric_difference_with(struct SNAME *_set1_, struct SNAME *_set2_)         \
+    {                                                                                        \
+        return PFX##_impl_replace(_set1_, PFX##_symmetric_difference(_set1_, _set2_));       \
+    }                                                                                        \
+                                                                                             \
+    /* Is _set1_ a subset of _set2_ ? */                                                     \
+    /* A set X is a subset of a set Y when: X <= Y */                                        \
+    /* If X is a subset of Y, then Y is a superset of X */                                   \
+    bool PFX##_is_subset(struct SNAME *_set1_, struct SNAME *_set2_)                         \
+    {                                                                                        \
+        /* If the cardinality of _set1_ is greater than that of _set2_, then it is safe */   \
+        /* to say that _set1_ can't be a subset of _set2_ */                                 \
+        if (PFX##_count(_set1_) > PFX##_count(_set2_))                                       \
             return false;                                                                    \
                                                                                              \
+        /* The empty set is a subset of all sets */                                          \
         if (PFX##_empty(_set1_))                                                             \
+            return true;                                                                     \
+                                                                                             \
+        struct SNAME##_iter iter1, iter2;                                                    \
+        PFX##_iter_init(&iter1, _set1_);                                                     \
+        PFX##_iter_init(&iter2, _set2_);                                                     \
+                                                                                             \
+        while (!PFX##_iter_end(&iter1))                                                      \
+        {                                                                                    \
+            if (PFX##_iter_end(&iter2))                                                      \
+                return false;                                                                \
+                                                                                             \
+            V value1 = PFX##_iter_value(&iter1);                                             \
+            V value2 = PFX##_iter_value(&iter2);                                             \
+                                                                                             \
+            int c = PFX##_impl_cmp(_set1_, value1, value2);                                  \
+                                                                                             \
+            /* Every element of _set2_ that could match it was skipped */                    \
+            if (c < 0)                                                                       \
+                return false;                                                                \
+                                                                                             \
+            if (c == 0)                                                                      \
+                PFX##_iter_next(&iter1);                                                     \
+                                                                                             \
+            PFX##_iter_next(&iter2);                                                         \
+        }                                                                                    \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* Is _set1_ a superset of _set2_ ? */                                                   \
+    /* A set X is a superset of a set Y when: X >= Y */                                      \
+    /* If X is a superset of Y, then Y is a subset of X */                                   \
+    bool PFX##_is_superset(struct SNAME *_set1_, struct SNAME *_set2_)                       \
+    {                                                                                        \
+        return PFX##_is_subset(_set2_, _set1_);                                              \
+    }                                                                                        \
+                                                                                             \
+    /* Is _set1_ a proper subset of _set2_ ? */                                              \
+    /* A set X is a proper subset of a set Y when: X < Y */                                  \
+    /* If X is a proper subset of Y, then Y is a proper superset of X */                     \
+    bool PFX##_is_proper_subset(struct SNAME *_set1_, struct SNAME *_set2_)                  \
+    {                                                                                        \
+        /* If the cardinality of _set1_ is greater than or equal to that of _set2_, then */  \
+        /* it is safe to say that _set1_ can't be a proper subset of _set2_ */               \
+        if (PFX##_count(_set1_) >= PFX##_count(_set2_))                                      \
+            return false;                                                                    \
+                                                                                             \
+        /* With fewer elements any subset of _set2_ is a proper one */                       \
+        return PFX##_is_subset(_set1_, _set2_);                                              \
+    }                                                                                        \
+                                                                                             \
+    /* Is _set1_ a proper superset of _set2_ ? */                                            \
+    /* A set X is a proper superset of a set Y when: X > Y */                                \
+    /* If X is a proper superset of Y, then Y is a proper subset of X */                     \
+    bool PFX##_is_proper_superset(struct SNAME *_set1_, struct SNAME *_set2_)                \
+    {                                                                                        \
+        return PFX##_is_proper_subset(_set2_, _set1_);                                       \
+    }                                                                                        \
+                                                                                             \
+    /* Is _set1_ a disjointset of _set2_ ? */                                                \
+    /* A set X is a disjointset of a set Y if their intersection is empty, that is, if */    \
+    /* there are no elements in common between the two */                                    \
+    bool PFX##_is_disjointset(struct SNAME *_set1_, struct SNAME *_set2_)                    \
+    {                                                                                        \
+        struct SNAME##_iter iter1, iter2;                                                    \
+        PFX##_iter_init(&iter1, _set1_);                                                     \
+        PFX##_iter_init(&iter2, _set2_);                                                     \
+                                                                                             \
+        while (!PFX##_iter_end(&iter1) && !PFX##_iter_end(&iter2))                           \
+        {                                                                                    \
+            V value1 = PFX##_iter_value(&iter1);                                             \
+            V value2 = PFX##_iter_value(&iter2);                                             \
+                                                                                             \
+            int c = PFX##_impl_cmp(_set1_, value1, value2);                                  \
+                                                                                             \
+            if (c == 0)                                                                      \
+                return false;                                                                \
+            else if (c < 0)                                                                  \
+                PFX##_iter_next(&iter1);                                                     \
+            else                                                                             \
+                PFX##_iter_next(&iter2);                                                     \
+        }                                                                                    \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+                                                                                             \
+    /* Writes the elements as they are in memory and in order, to be opened */               \
+    /* by a MappedSortedSet. Every step-th element is also written to a */                   \
+    /* sparse index, that is left out if step is 0 */                                        \
+    bool PFX##_save_flat(struct SNAME *_set_, FILE *file, size_t step)                       \
+    {                                                                                        \
+        uint32_t flags = CMC_SERIAL_FLAT | CMC_SERIAL_RAW_KEYS;                              \
+        struct SNAME##_iter iter;                                                            \
+        size_t index = 0;                                                                    \
+                                                                                             \
+        if (step > UINT32_MAX)                                                               \
+            return false;                                                                    \
+                                                                                             \
+        if (!cmc_serial_write_header(file, "treeset", flags, sizeof(V), 0, (uint32_t)step,   \
+                                     _set_->count, _set_->count, 0))                         \
+            return false;                                                                    \
+                                                                                             \
+        for (PFX##_iter_init(&iter, _set_); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))  \
+        {                                                                                    \
+            if (fwrite(&iter.cursor->value, sizeof(V), 1, file) != 1)                        \
+                return false;                                                                \
+        }                                                                                    \
+                                                                                             \
+        if (!cmc_serial_flat_pad(file, _set_->count * sizeof(V)))                            \
+            return false;                                                                    \
+                                                                                             \
+        for (PFX##_iter_init(&iter, _set_); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))  \
+        {                                                                                    \
+            if (step > 0 && index++ % step == 0 &&                                           \
+                fwrite(&iter.cursor->value, sizeof(V), 1, file) != 1)                        \
+                return false;                                                                \
+        }                                                                                    \
+                                                                                             \
+        size_t indexed = cmc_serial_flat_indexed(_set_->count, step);                        \
+                                                                                             \
+        return cmc_serial_flat_pad(file, indexed * sizeof(V));                               \
+    }                                                                                        \
+                                                                                             \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                \
+    {                                                                                        \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));      \
+                                                                                             \
+        if (CMC_UNLIKELY(!iter))                                                             \
+            return NULL;                                                                     \
+                                                                                             \
+        PFX##_iter_init(iter, target);                                                       \
+                                                                                             \
+        return iter;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    void PFX##_iter_free(struct SNAME##_iter *iter)                                          \
+    {                                                                                        \
+        iter->target->alloc->free(iter);                                                     \
+    }                                                                                        \
+                                                                                             \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                    \
+    {                                                                                        \
+        memset(iter, 0, sizeof(struct SNAME##_iter));                                        \
+                                                                                             \
+        iter->target = target;                                                               \
+        iter->start = true;                                                                  \
+        iter->end = PFX##_empty(target);                                                     \
+        iter->count = PFX##_count(target);                                                   \
+                                                                                             \
+        iter->cursor = PFX##_impl_first_node(target);                                        \
+        iter->first = iter->cursor;                                                          \
+        iter->last = PFX##_impl_last_node(target);                                           \
+    }                                                                                        \
+                                                                                             \
+    /* Iterates over the elements from lo, inclusive, to hi, exclusive. The index */         \
+    /* starts at 0 on the first of them */                                                   \
+    void PFX##_iter_init_range(struct SNAME##_iter *iter, struct SNAME *target, V lo,        \
+                               V hi)                                                         \
+    {                                                                                        \
+        PFX##_impl_iter_init_nodes(iter, target, PFX##_impl_ceiling_node(target, lo, false), \
+                                   PFX##_impl_floor_node(target, hi, true));                 \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                         \
+    {                                                                                        \
+        return iter->count == 0 || iter->start;                                              \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                           \
+    {                                                                                        \
+        return iter->count == 0 || iter->end;                                                \
+    }                                                                                        \
+                                                                                             \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                      \
+    {                                                                                        \
+        if (iter->count > 0)                                                                 \
+        {                                                                                    \
+            iter->index = 0;                                                                 \
+            iter->start = true;                                                              \
+            iter->end = iter->count == 0;                                                    \
+            iter->cursor = iter->first;                                                      \
+        }                                                                                    \
+    }                                                                                        \
+                                                                                             \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                        \
+    {                                                                                        \
+        if (iter->count > 0)                                                                 \
+        {                                                                                    \
+            iter->index = PFX##_impl_iter_count(iter) - 1;                                   \
+            iter->start = iter->count == 0;                                                  \
+            iter->end = true;                                                                \
+            iter->cursor = iter->last;                                                       \
+        }                                                                                    \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                          \
+    {                                                                                        \
+        if (iter->end)                                                                       \
+            return false;                                                                    \
+                                                                                             \
+        if (iter->cursor == iter->last)                                                      \
+        {                                                                                    \
+            iter->end = true;                                                                \
+            return true;                                                                     \
+        }                                                                                    \
+                                                                                             \
+        iter->start = iter->count == 0;                                                      \
+        iter->cursor = PFX##_impl_next_node(iter->cursor);                                   \
+        iter->index++;                                                                       \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                          \
+    {                                                                                        \
+        if (iter->start)                                                                     \
+            return false;                                                                    \
+                                                                                             \
+        if (iter->cursor == iter->first)                                                     \
+        {                                                                                    \
+            iter->start = true;                                                              \
+                                                                                             \
+            return true;                                                                     \
+        }                                                                                    \
+                                                                                             \
+        iter->end = iter->count == 0;                                                        \
+        iter->cursor = PFX##_impl_prev_node(iter->cursor);                                   \
+        iter->index--;                                                                       \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* Returns true only if the iterator moved */                                            \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps)                         \
+    {                                                                                        \
+        if (iter->end)                                                                       \
+            return false;                                                                    \
+                                                                                             \
+        if (iter->cursor == iter->last)                                                      \
+        {                                                                                    \
+            iter->end = true;                                                                \
+            return false;                                                                    \
+        }                                                                                    \
+                                                                                             \
+        if (steps == 0 || iter->index + steps >= PFX##_impl_iter_count(iter))                \
+            return false;                                                                    \
+                                                                                             \
+        PFX##_impl_iter_seek(iter, iter->index + steps);                                     \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* Returns true only if the iterator moved */                                            \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps)                          \
+    {                                                                                        \
+        if (iter->start)                                                                     \
+            return false;                                                                    \
+                                                                                             \
+        if (iter->cursor == iter->first)                                                     \
+        {                                                                                    \
+            iter->start = true;                                                              \
+            return false;                                                                    \
+        }                                                                                    \
+                                                                                             \
+        if (steps == 0 || iter->index < steps)                                               \
+            return false;                                                                    \
+                                                                                             \
+        PFX##_impl_iter_seek(iter, iter->index - steps);                                     \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* Returns true only if the iterator was able to be positioned at the given index */     \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index)                           \
+    {                                                                                        \
+        if (index >= PFX##_impl_iter_count(iter))                                            \
+            return false;                                                                    \
+                                                                                             \
+        if (iter->index > index)                                                             \
+            return PFX##_iter_rewind(iter, iter->index - index);                             \
+        else if (iter->index < index)                                                        \
+            return PFX##_iter_advance(iter, index - iter->index);                            \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                            \
+    {                                                                                        \
+        if (iter->count == 0)                                                                \
+            return (V){0};                                                                   \
+                                                                                             \
+        return iter->cursor->value;                                                          \
+    }                                                                                        \
+                                                                                             \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                       \
+    {                                                                                        \
+        return iter->index;                                                                  \
+    }                                                                                        \
+                                                                                             \
+    /* Takes a removed node if there is one, otherwise the next one of the */                \
+    /* newest chunk */                                                                       \
+    static struct SNAME##_node *PFX##_impl_new_node(struct SNAME *_set_, V element)          \
+    {                                                                                        \
+        struct SNAME##_node *node = _set_->free_nodes;                                       \
+                                                                                             \
+        if (node)                                                                            \
+            _set_->free_nodes = node->parent;                                                \
+        else                                                                                 \
+        {                                                                                    \
+            if (_set_->chunk_left == 0)                                                      \
+            {                                                                                \
+                size_t capacity = _set_->chunks ? _set_->chunks->capacity * 2 : 4;           \
+                                                                                             \
+                if (capacity > CMC_TREE_CHUNK_SIZE)                                          \
+                    capacity = CMC_TREE_CHUNK_SIZE;                                          \
+                                                                                             \
+                size_t bytes = sizeof(struct SNAME##_node) * capacity;                       \
+                                                                                             \
+                struct SNAME##_chunk *chunk =                                                \
+                    _set_->alloc->malloc(sizeof(struct SNAME##_chunk) + bytes);              \
+                                                                                             \
+                if (!chunk)                                                                  \
+                    return NULL;                                                             \
+                                                                                             \
+                chunk->next = _set_->chunks;                                                 \
+                chunk->capacity = capacity;                                                  \
+                                                                                             \
+                _set_->chunks = chunk;                                                       \
+                _set_->chunk_left = capacity;                                                \
+            }                                                                                \
+                                                                                             \
+            node = &(_set_->chunks->nodes[--_set_->chunk_left]);                             \
+        }                                                                                    \
+                                                                                             \
+        node->value = element;                                                               \
+        node->right = NULL;                                                                  \
+        node->left = NULL;                                                                   \
+        node->parent = NULL;                                                                 \
+        node->height = 0;                                                                    \
+        node->size = 1;                                                                      \
+                                                                                             \
+        CMC_IMPL_TREE_THREADED(node->prev = NULL; node->next = NULL;)                        \
+                                                                                             \
+        return node;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* The node is kept for the next insertion instead of being freed */                     \
+    static void PFX##_impl_release_node(struct SNAME *_set_, struct SNAME##_node *node)      \
+    {                                                                                        \
+        /* Marks it for clear, as nodes in the tree have a size of at least 1 */             \
+        node->size = 0;                                                                      \
+                                                                                             \
+        PFX##_impl_unlink_node(_set_, node);                                                 \
+                                                                                             \
+        node->parent = _set_->free_nodes;                                                    \
+                                                                                             \
+        _set_->free_nodes = node;                                                            \
+    }                                                                                        \
+                                                                                             \
+    /* Threads a node that was just added as a leaf between the nodes before */              \
+    /* and after it, one of which is its parent */                                           \
+    static void PFX##_impl_link_node(struct SNAME *_set_, struct SNAME##_node *node)         \
+    {                                                                                        \
+        (void)_set_;                                                                         \
+        (void)node;                                                                          \
+                                                                                             \
+        CMC_IMPL_TREE_THREADED(                                                              \
+            struct SNAME##_node *parent = node->parent;                                      \
+                                                                                             \
+            if (parent != NULL && parent->left == node)                                      \
+            {                                                                                \
+                node->next = parent;                                                         \
+                node->prev = parent->prev;                                                   \
+            }                                                                                \
+            else if (parent != NULL)                                                         \
+            {                                                                                \
+                node->prev = parent;                                                         \
+                node->next = parent->next;                                                   \
+            }                                                                                \
+                                                                                             \
+            if (node->prev != NULL)                                                          \
+                node->prev->next = node;                                                     \
+            else                                                                             \
+                _set_->first = node;                                                         \
+                                                                                             \
+            if (node->next != NULL)                                                          \
+                node->next->prev = node;                                                     \
+            else                                                                             \
+                _set_->last = node;                                                          \
+        )                                                                                    \
+    }                                                                                        \
+                                                                                             \
+    /* Joins the nodes before and after a node taken out of the tree. When */                \
+    /* remove moves the successor up into a node with two children, it is */                 \
+    /* the successor that is unlinked */                                                     \
+    static void PFX##_impl_unlink_node(struct SNAME *_set_, struct SNAME##_node *node)       \
+    {                                                                                        \
+        (void)_set_;                                                                         \
+        (void)node;                                                                          \
+                                                                                             \
+        CMC_IMPL_TREE_THREADED(                                                              \
+            if (node->prev != NULL)                                                          \
+                node->prev->next = node->next;                                               \
+            else                                                                             \
+                _set_->first = node->next;                                                   \
+                                                                                             \
+            if (node->next != NULL)                                                          \
+                node->next->prev = node->prev;                                               \
+            else                                                                             \
+                _set_->last = node->prev;                                                    \
+        )                                                                                    \
+    }                                                                                        \
+                                                                                             \
+    static struct SNAME##_node *PFX##_impl_first_node(struct SNAME *_set_)                   \
+    {                                                                                        \
+        CMC_IMPL_TREE_THREADED(return _set_->first;)                                         \
+                                                                                             \
+        struct SNAME##_node *scan = _set_->root;                                             \
+                                                                                             \
+        while (scan != NULL && scan->left != NULL)                                           \
+            scan = scan->left;                                                               \
+                                                                                             \
+        return scan;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    static struct SNAME##_node *PFX##_impl_last_node(struct SNAME *_set_)                    \
+    {                                                                                        \
+        CMC_IMPL_TREE_THREADED(return _set_->last;)                                          \
+                                                                                             \
+        struct SNAME##_node *scan = _set_->root;                                             \
+                                                                                             \
+        while (scan != NULL && scan->right != NULL)                                          \
+            scan = scan->right;                                                              \
+                                                                                             \
+        return scan;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* The node after the given one in order, or NULL if it is the last */                   \
+    static struct SNAME##_node *PFX##_impl_next_node(struct SNAME##_node *node)              \
+    {                                                                                        \
+        CMC_IMPL_TREE_THREADED(return node->next;)                                           \
+                                                                                             \
+        if (node->right != NULL)                                                             \
+        {                                                                                    \
+            node = node->right;                                                              \
+                                                                                             \
+            while (node->left != NULL)                                                       \
+                node = node->left;                                                           \
+                                                                                             \
+            return node;                                                                     \
+        }                                                                                    \
+                                                                                             \
+        while (node->parent != NULL && node->parent->right == node)                          \
+            node = node->parent;                                                             \
+                                                                                             \
+        return node->parent;                                                                 \
+    }                                                                                        \
+                                                                                             \
+    /* The node before the given one in order, or NULL if it is the first */                 \
+    static struct SNAME##_node *PFX##_impl_prev_node(struct SNAME##_node *node)              \
+    {                                                                                        \
+        CMC_IMPL_TREE_THREADED(return node->prev;)                                           \
+                                                                                             \
+        if (node->left != NULL)                                                              \
+        {                                                                                    \
+            node = node->left;                                                               \
+                                                                                             \
+            while (node->right != NULL)                                                      \
+                node = node->right;                                                          \
+                                                                                             \
+            return node;                                                                     \
+        }                                                                                    \
+                                                                                             \
+        while (node->parent != NULL && node->parent->left == node)                           \
+            node = node->parent;                                                             \
+                                                                                             \
+        return node->parent;                                                                 \
+    }                                                                                        \
+                                                                                             \
+    /* Links the prev and next of n nodes that are in order */                               \
+    static void PFX##_impl_thread_nodes(struct SNAME *_set_, struct SNAME##_node **nodes,    \
+                                        size_t n)                                            \
+    {                                                                                        \
+        (void)_set_;                                                                         \
+        (void)nodes;                                                                         \
+        (void)n;                                                                             \
+                                                                                             \
+        CMC_IMPL_TREE_THREADED(                                                              \
+            for (size_t i = 0; i < n; i++)                                                   \
+            {                                                                                \
+                nodes[i]->prev = i > 0 ? nodes[i - 1] : NULL;                                \
+                nodes[i]->next = i + 1 < n ? nodes[i + 1] : NULL;                            \
+            }                                                                                \
+                                                                                             \
+            _set_->first = n > 0 ? nodes[0] : NULL;                                          \
+            _set_->last = n > 0 ? nodes[n - 1] : NULL;                                       \
+        )                                                                                    \
+    }                                                                                        \
+                                                                                             \
+    /* Joins the trees left and right, whose elements are all less and greater */            \
+    /* than that of node, with node between them, and returns the root. It */                \
+    /* goes down the side of the taller tree to a subtree that is about as */                \
+    /* tall as the other one, puts node in its place and rebalances back up, */              \
+    /* taking time proportional to the difference of their heights */                        \
+    static struct SNAME##_node *PFX##_impl_join_nodes(struct SNAME *_set_,                   \
+                                                    struct SNAME##_node *left,               \
+                                                    struct SNAME##_node *node,               \
+                                                    struct SNAME##_node *right)              \
+    {                                                                                        \
+        struct SNAME##_node *parent = NULL;                                                  \
+        unsigned char h_l = PFX##_impl_h(left);                                              \
+        unsigned char h_r = PFX##_impl_h(right);                                             \
+                                                                                             \
+        if (h_l > h_r + 1)                                                                   \
+        {                                                                                    \
+            for (parent = left; PFX##_impl_h(parent->right) > h_r + 1;)                      \
+                parent = parent->right;                                                      \
+                                                                                             \
+            left = parent->right;                                                            \
+            parent->right = node;                                                            \
+        }                                                                                    \
+        else if (h_r > h_l + 1)                                                              \
+        {                                                                                    \
+            for (parent = right; PFX##_impl_h(parent->left) > h_l + 1;)                      \
+                parent = parent->left;                                                       \
+                                                                                             \
+            right = parent->left;                                                            \
+            parent->left = node;                                                             \
+        }                                                                                    \
+                                                                                             \
+        node->parent = parent;                                                               \
+        node->left = left;                                                                   \
+        node->right = right;                                                                 \
+                                                                                             \
+        if (left)                                                                            \
+            left->parent = node;                                                             \
+        if (right)                                                                           \
+            right->parent = node;                                                            \
+                                                                                             \
+        node->height = PFX##_impl_hupdate(node);                                             \
+        node->size = PFX##_impl_supdate(node);                                               \
+                                                                                             \
+        if (parent == NULL)                                                                  \
+            return node;                                                                     \
+                                                                                             \
+        PFX##_impl_rebalance(_set_, node);                                                   \
+                                                                                             \
+        return _set_->root;                                                                  \
+    }                                                                                        \
+                                                                                             \
+    /* Splits the tree under node into the nodes with elements less than element */          \
+    /* and the rest, joining the subtrees that hang on each side of the path */              \
+    /* to element. The joins get taller along the way up, so their costs add up */           \
+    /* to the height of the tree */                                                          \
+    static void PFX##_impl_split_nodes(struct SNAME *_set_, struct SNAME##_node *node,       \
+                                       V element, struct SNAME##_node **left,                \
+                                       struct SNAME##_node **right)                          \
+    {                                                                                        \
+        if (node == NULL)                                                                    \
+        {                                                                                    \
+            *left = NULL;                                                                    \
+            *right = NULL;                                                                   \
+            return;                                                                          \
+        }                                                                                    \
+                                                                                             \
+        struct SNAME##_node *l = node->left;                                                 \
+        struct SNAME##_node *r = node->right;                                                \
+                                                                                             \
+        if (l)                                                                               \
+            l->parent = NULL;                                                                \
+        if (r)                                                                               \
+            r->parent = NULL;                                                                \
+                                                                                             \
+        if (PFX##_impl_cmp(_set_, element, node->value) <= 0)                                \
+        {                                                                                    \
+            PFX##_impl_split_nodes(_set_, l, element, left, right);                          \
+                                                                                             \
+            *right = PFX##_impl_join_nodes(_set_, *right, node, r);                          \
+        }                                                                                    \
+        else                                                                                 \
         {                                                                                    \
-            /* The empty set is a proper subset of all non-empty sets */                     \
-            if (!PFX##_empty(_set2_))                                                        \
-                return true;                                                                 \
-            /* The empty set is not a proper subset of itself (this is true for any set) */  \
-            else                                                                             \
-                return false;                                                                \
+            PFX##_impl_split_nodes(_set_, r, element, left, right);                          \
+                                                                                             \
+            *left = PFX##_impl_join_nodes(_set_, l, node, *left);                            \
         }                                                                                    \
+    }                                                                                        \
                                                                                              \
-        struct SNAME##_iter iter;                                                            \
+    /* Takes the node with the smallest element out of a tree that is not */                 \
+    /* empty without releasing it, so it keeps its place in the order */                     \
+    static struct SNAME##_node *PFX##_impl_detach_first(struct SNAME *_set_)                 \
+    {                                                                                        \
+        struct SNAME##_node *node = _set_->root;                                             \
                                                                                              \
-        PFX##_iter_init(&iter, _set1_);                                                      \
+        while (node->left != NULL)                                                           \
+            node = node->left;                                                               \
                                                                                              \
-        for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))     \
+        struct SNAME##_node *parent = node->parent;                                          \
+                                                                                             \
+        if (node->right)                                                                     \
+            node->right->parent = parent;                                                    \
+                                                                                             \
+        if (parent == NULL)                                                                  \
+            _set_->root = node->right;                                                       \
+        else                                                                                 \
         {                                                                                    \
-            V value = PFX##_iter_value(&iter);                                               \
+            parent->left = node->right;                                                      \
                                                                                              \
-            if (!PFX##_contains(_set2_, value))                                              \
-                return false;                                                                \
+            PFX##_impl_rebalance(_set_, parent);                                             \
         }                                                                                    \
                                                                                              \
-        return true;                                                                         \
+        return node;                                                                         \
     }                                                                                        \
                                                                                              \
-    /* Is _set1_ a proper superset of _set2_ ? */                                            \
-    /* A set X is a proper superset of a set Y when: X > Y */                                \
-    /* If X is a proper superset of Y, then Y is a proper subset of X */                     \
-    bool PFX##_is_proper_superset(struct SNAME *_set1_, struct SNAME *_set2_)                \
+    /* Moves the chunks and the removed nodes of the second tree to the */                   \
+    /* first one. Only the newest chunk of a tree can have nodes that were */                \
+    /* never used, so those of the second tree are released */                               \
+    static void PFX##_impl_take_chunks(struct SNAME *_set1_, struct SNAME *_set2_)           \
     {                                                                                        \
-        return PFX##_is_proper_subset(_set2_, _set1_);                                       \
-    }                                                                                        \
+        if (_set2_->chunks)                                                                  \
+        {                                                                                    \
+            for (size_t i = 0; i < _set2_->chunk_left; i++)                                  \
+            {                                                                                \
+                struct SNAME##_node *node = &(_set2_->chunks->nodes[i]);                     \
                                                                                              \
-    /* Is _set1_ a disjointset of _set2_ ? */                                                \
-    /* A set X is a disjointset of a set Y if their intersection is empty, that is, if */    \
-    /* there are no elements in common between the two */                                    \
-    bool PFX##_is_disjointset(struct SNAME *_set1_, struct SNAME *_set2_)                    \
-    {                                                                                        \
-        /* The intersection of an empty set with any other set will result in an empty */    \
-        /* set */                                                                            \
-        if (PFX##_empty(_set1_))                                                             \
-            return true;                                                                     \
+                node->size = 0;                                                              \
+                node->parent = _set1_->free_nodes;                                           \
+                _set1_->free_nodes = node;                                                   \
+            }                                                                                \
+        }                                                                                    \
                                                                                              \
-        struct SNAME##_iter iter;                                                            \
+        while (_set2_->free_nodes)                                                           \
+        {                                                                                    \
+            struct SNAME##_node *node = _set2_->free_nodes;                                  \
                                                                                              \
-        PFX##_iter_init(&iter, _set1_);                                                      \
+            _set2_->free_nodes = node->parent;                                               \
+            node->parent = _set1_->free_nodes;                                               \
+            _set1_->free_nodes = node;                                                       \
+        }                                                                                    \
                                                                                              \
-        for (PFX##_iter_to_start(&iter); !PFX##_iter_end(&iter); PFX##_iter_next(&iter))     \
+        if (_set2_->chunks)                                                                  \
         {                                                                                    \
-            V value = PFX##_iter_value(&iter);                                               \
+            struct SNAME##_chunk *tail = _set2_->chunks;                                     \
                                                                                              \
-            if (PFX##_contains(_set2_, value))                                               \
-                return false;                                                                \
+            while (tail->next)                                                               \
+                tail = tail->next;                                                           \
+                                                                                             \
+            if (_set1_->chunks)                                                              \
+            {                                                                                \
+                tail->next = _set1_->chunks->next;                                           \
+                _set1_->chunks->next = _set2_->chunks;                                       \
+            }                                                                                \
+            else                                                                             \
+            {                                                                                \
+                _set1_->chunks = _set2_->chunks;                                             \
+                _set1_->chunk_left = 0;                                                      \
+            }                                                                                \
         }                                                                                    \
                                                                                              \
-        return true;                                                                         \
+        _set2_->chunks = NULL;                                                               \
+        _set2_->chunk_left = 0;                                                              \
     }                                                                                        \
                                                                                              \
-    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                \
+    /* Links n nodes that are in order into a balanced tree, like build */                   \
+    static struct SNAME##_node *PFX##_impl_build_nodes(struct SNAME##_node **nodes,          \
+                                                     size_t n, struct SNAME##_node *parent)  \
     {                                                                                        \
-        struct SNAME##_iter *iter = malloc(sizeof(struct SNAME##_iter));                     \
-                                                                                             \
-        if (!iter)                                                                           \
+        if (n == 0)                                                                          \
             return NULL;                                                                     \
                                                                                              \
-        PFX##_iter_init(iter, target);                                                       \
+        size_t mid = n / 2;                                                                  \
+        struct SNAME##_node *node = nodes[mid];                                              \
                                                                                              \
-        return iter;                                                                         \
-    }                                                                                        \
+        node->parent = parent;                                                               \
+        node->left = PFX##_impl_build_nodes(nodes, mid, node);                               \
+        node->right = PFX##_impl_build_nodes(nodes + mid + 1, n - mid - 1, node);            \
+        node->height = PFX##_impl_hupdate(node);                                             \
+        node->size = PFX##_impl_supdate(node);                                               \
                                                                                              \
-    void PFX##_iter_free(struct SNAME##_iter *iter)                                          \
-    {                                                                                        \
-        free(iter);                                                                          \
+        return node;                                                                         \
     }                                                                                        \
                                                                                              \
-    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                    \
+    /* The middle element is the root of its subtree, so both sides of every */              \
+    /* node differ by at most one element */                                                 \
+    static bool PFX##_impl_build(struct SNAME *_set_, V *elements, size_t n,                 \
+                                 struct SNAME##_node *parent, struct SNAME##_node **result)  \
     {                                                                                        \
-        memset(iter, 0, sizeof(struct SNAME##_iter));                                        \
+        *result = NULL;                                                                      \
                                                                                              \
-        iter->target = target;                                                               \
-        iter->start = true;                                                                  \
-        iter->end = PFX##_empty(target);                                                     \
+        if (n == 0)                                                                          \
+            return true;                                                                     \
                                                                                              \
-        iter->cursor = target->root;                                                         \
+        size_t mid = n / 2;                                                                  \
                                                                                              \
-        if (!PFX##_empty(target))                                                            \
-        {                                                                                    \
-            while (iter->cursor->left != NULL)                                               \
-                iter->cursor = iter->cursor->left;                                           \
+        struct SNAME##_node *node = PFX##_impl_new_node(_set_, elements[mid]);               \
                                                                                              \
-            iter->first = iter->cursor;                                                      \
+        if (!node)                                                                           \
+            return false;                                                                    \
                                                                                              \
-            iter->last = target->root;                                                       \
-            while (iter->last->right != NULL)                                                \
-                iter->last = iter->last->right;                                              \
-        }                                                                                    \
-    }                                                                                        \
+        node->parent = parent;                                                               \
                                                                                              \
-    bool PFX##_iter_start(struct SNAME##_iter *iter)                                         \
-    {                                                                                        \
-        return PFX##_empty(iter->target) || iter->start;                                     \
-    }                                                                                        \
+        *result = node;                                                                      \
                                                                                              \
-    bool PFX##_iter_end(struct SNAME##_iter *iter)                                           \
-    {                                                                                        \
-        return PFX##_empty(iter->target) || iter->end;                                       \
+        PFX##_impl_link_node(_set_, node);                                                   \
+                                                                                             \
+        if (!PFX##_impl_build(_set_, elements, mid, node, &(node->left)) ||                  \
+            !PFX##_impl_build(_set_, elements + mid + 1, n - mid - 1, node, &(node->right))) \
+            return false;                                                                    \
+                                                                                             \
+        node->height = PFX##_impl_hupdate(node);                                             \
+        node->size = PFX##_impl_supdate(node);                                               \
+                                                                                             \
+        return true;                                                                         \
     }                                                                                        \
                                                                                              \
-    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                      \
+    /* The node with the smallest element that is greater than or equal to element, */       \
+    /* or only greater if strict */                                                          \
+    static struct SNAME##_node *PFX##_impl_ceiling_node(struct SNAME *_set_, V element,      \
+                                                        bool strict)                         \
     {                                                                                        \
-        if (!PFX##_empty(iter->target))                                                      \
+        struct SNAME##_node *scan = _set_->root;                                             \
+        struct SNAME##_node *result = NULL;                                                  \
+                                                                                             \
+        while (scan != NULL)                                                                 \
         {                                                                                    \
-            iter->index = 0;                                                                 \
-            iter->start = true;                                                              \
-            iter->end = PFX##_empty(iter->target);                                           \
-            iter->cursor = iter->first;                                                      \
+            int c = PFX##_impl_cmp(_set_, scan->value, element);                             \
+                                                                                             \
+            if (c > 0 || (c == 0 && !strict))                                                \
+            {                                                                                \
+                result = scan;                                                               \
+                scan = scan->left;                                                           \
+            }                                                                                \
+            else                                                                             \
+                scan = scan->right;                                                          \
         }                                                                                    \
+                                                                                             \
+        return result;                                                                       \
     }                                                                                        \
                                                                                              \
-    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                        \
+    /* The node with the largest element that is less than or equal to element, or */        \
+    /* only less if strict */                                                                \
+    static struct SNAME##_node *PFX##_impl_floor_node(struct SNAME *_set_, V element,        \
+                                                      bool strict)                           \
     {                                                                                        \
-        if (!PFX##_empty(iter->target))                                                      \
+        struct SNAME##_node *scan = _set_->root;                                             \
+        struct SNAME##_node *result = NULL;                                                  \
+                                                                                             \
+        while (scan != NULL)                                                                 \
         {                                                                                    \
-            iter->index = iter->target->count - 1;                                           \
-            iter->start = PFX##_empty(iter->target);                                         \
-            iter->end = true;                                                                \
-            iter->cursor = iter->last;                                                       \
+            int c = PFX##_impl_cmp(_set_, scan->value, element);                             \
+                                                                                             \
+            if (c < 0 || (c == 0 && !strict))                                                \
+            {                                                                                \
+                result = scan;                                                               \
+                scan = scan->right;                                                          \
+            }                                                                                \
+            else                                                                             \
+                scan = scan->left;                                                           \
         }                                                                                    \
+                                                                                             \
+        return result;                                                                       \
     }                                                                                        \
                                                                                              \
-    bool PFX##_iter_next(struct SNAME##_iter *iter)                                          \
+    /* An iterator from first to last, both included, which is empty if either */            \
+    /* one of them is missing or they are out of order */                                    \
+    static void PFX##_impl_iter_init_nodes(struct SNAME##_iter *iter, struct SNAME *target,  \
+                                           struct SNAME##_node *first,                       \
+                                           struct SNAME##_node *last)                        \
     {                                                                                        \
-        if (iter->end)                                                                       \
-            return false;                                                                    \
+        memset(iter, 0, sizeof(struct SNAME##_iter));                                        \
                                                                                              \
-        if (iter->cursor == iter->last)                                                      \
+        iter->target = target;                                                               \
+        iter->start = true;                                                                  \
+                                                                                             \
+        if (first && last && PFX##_impl_cmp(target, first->value, last->value) <= 0)         \
         {                                                                                    \
-            iter->end = true;                                                                \
-            return true;                                                                     \
+            iter->cursor = first;                                                            \
+            iter->first = first;                                                             \
+            iter->last = last;                                                               \
+            iter->count = SIZE_MAX;                                                          \
         }                                                                                    \
                                                                                              \
-        iter->start = PFX##_empty(iter->target);                                             \
+        iter->end = iter->count == 0;                                                        \
+    }                                                                                        \
                                                                                              \
-        if (iter->cursor->right != NULL)                                                     \
-        {                                                                                    \
-            iter->cursor = iter->cursor->right;                                              \
+    /* Counts the nodes of an iterator over part of the tree the first time */               \
+    /* it is needed */                                                                       \
+    static size_t PFX##_impl_iter_count(struct SNAME##_iter *iter)                           \
+    {                                                                                        \
+        if (iter->count != SIZE_MAX)                                                         \
+            return iter->count;                                                              \
                                                                                              \
-            while (iter->cursor->left != NULL)                                               \
-                iter->cursor = iter->cursor->left;                                           \
+        size_t first = PFX##_impl_node_rank(iter->first);                                    \
                                                                                              \
-            iter->index++;                                                                   \
+        iter->count = PFX##_impl_node_rank(iter->last) - first + 1;                          \
                                                                                              \
-            return true;                                                                     \
-        }                                                                                    \
+        return iter->count;                                                                  \
+    }                                                                                        \
                                                                                              \
-        while (true)                                                                         \
-        {                                                                                    \
-            if (iter->cursor->parent->left == iter->cursor)                                  \
-            {                                                                                \
-                iter->cursor = iter->cursor->parent;                                         \
+    /* Keeps the elements that are only in _set1_, in both sets or only in */                \
+    /* _set2_ depending on the flags. They come out of the merge sorted, so */               \
+    /* the new tree is built from them like in new_from_sorted */                            \
+    static struct SNAME *PFX##_impl_merge(struct SNAME *_set1_, struct SNAME *_set2_,        \
+                                          bool only1, bool both, bool only2)                 \
+    {                                                                                        \
+        struct SNAME *_set_r_ = PFX##_new_custom(_set1_->cmp, _set1_->alloc);                \
                                                                                              \
-                iter->index++;                                                               \
+        if (CMC_UNLIKELY(!_set_r_))                                                          \
+            return NULL;                                                                     \
                                                                                              \
-                return true;                                                                 \
-            }                                                                                \
+        size_t capacity = (only1 ? _set1_->count : 0) + (only2 ? _set2_->count : 0);         \
                                                                                              \
-            iter->cursor = iter->cursor->parent;                                             \
-        }                                                                                    \
-    }                                                                                        \
+        if (both && !only1 && !only2)                                                        \
+            capacity = _set1_->count < _set2_->count ? _set1_->count : _set2_->count;        \
                                                                                              \
-    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                          \
-    {                                                                                        \
-        if (iter->start)                                                                     \
-            return false;                                                                    \
+        if (capacity == 0)                                                                   \
+            return _set_r_;                                                                  \
                                                                                              \
-        if (iter->cursor == iter->first)                                                     \
-        {                                                                                    \
-            iter->start = true;                                                              \
+        V *elements = _set1_->alloc->malloc(sizeof(V) * capacity);                           \
                                                                                              \
-            return true;                                                                     \
+        if (CMC_UNLIKELY(!elements))                                                         \
+        {                                                                                    \
+            PFX##_free(_set_r_, NULL);                                                       \
+            return NULL;                                                                     \
         }                                                                                    \
                                                                                              \
-        iter->end = PFX##_empty(iter->target);                                               \
-                                                                                             \
-        if (iter->cursor->left != NULL)                                                      \
-        {                                                                                    \
-            iter->cursor = iter->cursor->left;                                               \
+        size_t n = 0;                                                                        \
                                                                                              \
-            while (iter->cursor->right != NULL)                                              \
-                iter->cursor = iter->cursor->right;                                          \
+        struct SNAME##_iter iter1, iter2;                                                    \
+        PFX##_iter_init(&iter1, _set1_);                                                     \
+        PFX##_iter_init(&iter2, _set2_);                                                     \
                                                                                              \
-            iter->index--;                                                                   \
+        while (!PFX##_iter_end(&iter1) && !PFX##_iter_end(&iter2))                           \
+        {                                                                                    \
+            V value1 = PFX##_iter_value(&iter1);                                             \
+            V value2 = PFX##_iter_value(&iter2);                                             \
                                                                                              \
-            return true;                                                                     \
-        }                                                                                    \
+            int c = PFX##_impl_cmp(_set1_, value1, value2);                                  \
                                                                                              \
-        while (true)                                                                         \
-        {                                                                                    \
-            if (iter->cursor->parent->right == iter->cursor)                                 \
+            if (c < 0)                                                                       \
             {                                                                                \
-                iter->cursor = iter->cursor->parent;                                         \
+                if (only1)                                                                   \
+                    elements[n++] = value1;                                                  \
                                                                                              \
-                iter->index--;                                                               \
+                PFX##_iter_next(&iter1);                                                     \
+            }                                                                                \
+            else if (c > 0)                                                                  \
+            {                                                                                \
+                if (only2)                                                                   \
+                    elements[n++] = value2;                                                  \
                                                                                              \
-                return true;                                                                 \
+                PFX##_iter_next(&iter2);                                                     \
             }                                                                                \
+            else                                                                             \
+            {                                                                                \
+                if (both)                                                                    \
+                    elements[n++] = value1;                                                  \
                                                                                              \
-            iter->cursor = iter->cursor->parent;                                             \
+                PFX##_iter_next(&iter1);                                                     \
+                PFX##_iter_next(&iter2);                                                     \
+            }                                                                                \
         }                                                                                    \
-    }                                                                                        \
                                                                                              \
-    /* Returns true only if the iterator moved */                                            \
-    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps)                         \
-    {                                                                                        \
-        if (iter->end)                                                                       \
-            return false;                                                                    \
+        for (; only1 && !PFX##_iter_end(&iter1); PFX##_iter_next(&iter1))                    \
+            elements[n++] = PFX##_iter_value(&iter1);                                        \
                                                                                              \
-        if (iter->cursor == iter->last)                                                      \
-        {                                                                                    \
-            iter->end = true;                                                                \
-            return false;                                                                    \
-        }                                                                                    \
+        for (; only2 && !PFX##_iter_end(&iter2); PFX##_iter_next(&iter2))                    \
+            elements[n++] = PFX##_iter_value(&iter2);                                        \
                                                                                              \
-        if (steps == 0 || iter->index + steps >= PFX##_count(iter->target))                  \
-            return false;                                                                    \
+        bool built = PFX##_impl_build(_set_r_, elements, n, NULL, &(_set_r_->root));         \
+                                                                                             \
+        _set1_->alloc->free(elements);                                                       \
                                                                                              \
-        iter->index += steps;                                                                \
+        if (!built)                                                                          \
+        {                                                                                    \
+            PFX##_free(_set_r_, NULL);                                                       \
+            return NULL;                                                                     \
+        }                                                                                    \
                                                                                              \
-        for (size_t i = 0; i < steps; i++)                                                   \
-            PFX##_iter_next(iter);                                                           \
+        _set_r_->count = n;                                                                  \
                                                                                              \
-        return true;                                                                         \
+        return _set_r_;                                                                      \
     }                                                                                        \
                                                                                              \
-    /* Returns true only if the iterator moved */                                            \
-    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps)                          \
+    /* Moves the tree of result to _set_ and frees the old one */                            \
+    static bool PFX##_impl_replace(struct SNAME *_set_, struct SNAME *result)                \
     {                                                                                        \
-        if (iter->start)                                                                     \
-            return false;                                                                    \
-                                                                                             \
-        if (iter->cursor == iter->first)                                                     \
-        {                                                                                    \
-            iter->start = true;                                                              \
+        if (!result)                                                                         \
             return false;                                                                    \
-        }                                                                                    \
                                                                                              \
-        if (steps == 0 || iter->index < steps)                                               \
-            return false;                                                                    \
+        struct SNAME old = *_set_;                                                           \
                                                                                              \
-        iter->index -= steps;                                                                \
+        *_set_ = *result;                                                                    \
+        *result = old;                                                                       \
                                                                                              \
-        for (size_t i = 0; i < steps; i++)                                                   \
-            PFX##_iter_prev(iter);                                                           \
+        PFX##_free(result, NULL);                                                            \
                                                                                              \
         return true;                                                                         \
     }                                                                                        \
                                                                                              \
-    /* Returns true only if the iterator was able to be positioned at the given index */     \
-    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index)                           \
+    /* Position of the node in ascending order, starting at 0 */                             \
+    static size_t PFX##_impl_node_rank(struct SNAME##_node *node)                            \
     {                                                                                        \
-        if (index >= PFX##_count(iter->target))                                              \
-            return false;                                                                    \
+        size_t rank = PFX##_impl_s(node->left);                                              \
                                                                                              \
-        if (iter->index > index)                                                             \
-            return PFX##_iter_rewind(iter, iter->index - index);                             \
-        else if (iter->index < index)                                                        \
-            return PFX##_iter_advance(iter, index - iter->index);                            \
+        while (node->parent != NULL)                                                         \
+        {                                                                                    \
+            if (node->parent->right == node)                                                 \
+                rank += PFX##_impl_s(node->parent->left) + 1;                                \
                                                                                              \
-        return true;                                                                         \
+            node = node->parent;                                                             \
+        }                                                                                    \
+                                                                                             \
+        return rank;                                                                         \
     }                                                                                        \
                                                                                              \
-    V PFX##_iter_value(struct SNAME##_iter *iter)                                            \
+    /* The node at the given position in ascending order, starting at 0 */                   \
+    static struct SNAME##_node *PFX##_impl_select_node(struct SNAME *_set_, size_t index)    \
     {                                                                                        \
-        if (PFX##_empty(iter->target))                                                       \
-            return (V){0};                                                                   \
+        struct SNAME##_node *scan = _set_->root;                                             \
                                                                                              \
-        return iter->cursor->value;                                                          \
-    }                                                                                        \
+        while (scan != NULL)                                                                 \
+        {                                                                                    \
+            size_t left = PFX##_impl_s(scan->left);                                          \
                                                                                              \
-    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                       \
-    {                                                                                        \
-        return iter->index;                                                                  \
+            if (index < left)                                                                \
+                scan = scan->left;                                                           \
+            else if (index > left)                                                           \
+            {                                                                                \
+                index -= left + 1;                                                           \
+                scan = scan->right;                                                          \
+            }                                                                                \
+            else                                                                             \
+                return scan;                                                                 \
+        }                                                                                    \
+                                                                                             \
+        return NULL;                                                                         \
     }                                                                                        \
                                                                                              \
-    static struct SNAME##_node *PFX##_impl_new_node(V element)                               \
+    /* Moves the iterator to an index that is known to be inside its range */                \
+    static void PFX##_impl_iter_seek(struct SNAME##_iter *iter, size_t index)                \
     {                                                                                        \
-        struct SNAME##_node *node = malloc(sizeof(struct SNAME##_node));                     \
-                                                                                             \
-        if (!node)                                                                           \
-            return NULL;                                                                     \
+        size_t rank = PFX##_impl_node_rank(iter->first) + index;                             \
                                                                                              \
-        node->value = element;                                                               \
-        node->right = NULL;                                                                  \
-        node->left = NULL;                                                                   \
-        node->parent = NULL;                                                                 \
-        node->height = 0;                                                                    \
-                                                                                             \
-        return node;                                                                         \
+        iter->cursor = PFX##_impl_select_node(iter->target, rank);                           \
+        iter->index = index;                                                                 \
+        iter->start = false;                                                                 \
+        iter->end = false;                                                                   \
     }                                                                                        \
                                                                                              \
     static struct SNAME##_node *PFX##_impl_get_node(struct SNAME *_set_, V element)          \
@@ -1009,9 +2300,9 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
                                                                                              \
         while (scan != NULL)                                                                 \
         {                                                                                    \
-            if (_set_->cmp(scan->value, element) > 0)                                        \
+            if (PFX##_impl_cmp(_set_, scan->value, element) > 0)                             \
                 scan = scan->left;                                                           \
-            else if (_set_->cmp(scan->value, element) < 0)                                   \
+            else if (PFX##_impl_cmp(_set_, scan->value, element) < 0)                        \
                 scan = scan->right;                                                          \
             else                                                                             \
                 return scan;                                                                 \
@@ -1020,6 +2311,45 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
         return NULL;                                                                         \
     }                                                                                        \
                                                                                              \
+    /* Finds the nodes of up to CMC_IMPL_TREE_BATCH elements. Each round */                  \
+    /* moves every search that is not over one level down and prefetches */                  \
+    /* the node it moved to, which is only read in the next round */                         \
+    static void PFX##_impl_get_batch(struct SNAME *_set_, V *elements, size_t n,             \
+                                     struct SNAME##_node **nodes)                            \
+    {                                                                                        \
+        bool done[CMC_IMPL_TREE_BATCH];                                                      \
+        size_t active = 0;                                                                   \
+                                                                                             \
+        for (size_t i = 0; i < n; i++)                                                       \
+        {                                                                                    \
+            nodes[i] = _set_->root;                                                          \
+            done[i] = _set_->root == NULL;                                                   \
+            active += !done[i];                                                              \
+        }                                                                                    \
+                                                                                             \
+        while (active > 0)                                                                   \
+        {                                                                                    \
+            for (size_t i = 0; i < n; i++)                                                   \
+            {                                                                                \
+                if (done[i])                                                                 \
+                    continue;                                                                \
+                                                                                             \
+                int c = PFX##_impl_cmp(_set_, nodes[i]->value, elements[i]);                 \
+                                                                                             \
+                if (c != 0)                                                                  \
+                    nodes[i] = c > 0 ? nodes[i]->left : nodes[i]->right;                     \
+                                                                                             \
+                if (c == 0 || nodes[i] == NULL)                                              \
+                {                                                                            \
+                    done[i] = true;                                                          \
+                    active--;                                                                \
+                }                                                                            \
+                else                                                                         \
+                    CMC_IMPL_TREE_PREFETCH(nodes[i]);                                        \
+            }                                                                                \
+        }                                                                                    \
+    }                                                                                        \
+                                                                                             \
     static unsigned char PFX##_impl_h(struct SNAME##_node *node)                             \
     {                                                                                        \
         if (node == NULL)                                                                    \
@@ -1039,6 +2369,22 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
         return 1 + (h_l > h_r ? h_l : h_r);                                                  \
     }                                                                                        \
                                                                                              \
+    static size_t PFX##_impl_s(struct SNAME##_node *node)                                    \
+    {                                                                                        \
+        if (node == NULL)                                                                    \
+            return 0;                                                                        \
+                                                                                             \
+        return node->size;                                                                   \
+    }                                                                                        \
+                                                                                             \
+    static size_t PFX##_impl_supdate(struct SNAME##_node *node)                              \
+    {                                                                                        \
+        if (node == NULL)                                                                    \
+            return 0;                                                                        \
+                                                                                             \
+        return 1 + PFX##_impl_s(node->left) + PFX##_impl_s(node->right);                     \
+    }                                                                                        \
+                                                                                             \
     static void PFX##_impl_rotate_right(struct SNAME##_node **Z)                             \
     {                                                                                        \
         struct SNAME##_node *root = *Z;                                                      \
@@ -1064,6 +2410,8 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
                                                                                              \
         root->height = PFX##_impl_hupdate(root);                                             \
         new_root->height = PFX##_impl_hupdate(new_root);                                     \
+        root->size = PFX##_impl_supdate(root);                                               \
+        new_root->size = PFX##_impl_supdate(new_root);                                       \
                                                                                              \
         *Z = new_root;                                                                       \
     }                                                                                        \
@@ -1093,6 +2441,8 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
                                                                                              \
         root->height = PFX##_impl_hupdate(root);                                             \
         new_root->height = PFX##_impl_hupdate(new_root);                                     \
+        root->size = PFX##_impl_supdate(root);                                               \
+        new_root->size = PFX##_impl_supdate(new_root);                                       \
                                                                                              \
         *Z = new_root;                                                                       \
     }                                                                                        \
@@ -1110,6 +2460,7 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
                 is_root = true;                                                              \
                                                                                              \
             scan->height = PFX##_impl_hupdate(scan);                                         \
+            scan->size = PFX##_impl_supdate(scan);                                           \
             balance = PFX##_impl_h(scan->right) - PFX##_impl_h(scan->left);                  \
                                                                                              \
             if (balance >= 2)                                                                \
@@ -1158,6 +2509,13 @@ static const char *cmc_string_fmt_treeset = "%s at %p { root:%p, count:%" PRIuMA
         PFX##_iter_to_end(&iter);                                                            \
                                                                                              \
         return iter;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    static inline int PFX##_impl_cmp(struct SNAME *_set_, V a, V b)                          \
+    {                                                                                        \
+        (void)_set_;                                                                         \
+                                                                                             \
+        return CMP(a, b);                                                                    \
     }
 
 #endif /* CMC_TREESET_H */
@@ -0,0 +1,930 @@
+/**
+ * unrolledlist.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * UnrolledList
+ *
+ * An UnrolledList is a LinkedList whose nodes keep a small array of elements
+ * instead of a single one. It has the same functions as the LinkedList, but a
+ * position inside a node is given by the node and the offset of the element
+ * in it.
+ *
+ * Implementation
+ *
+ * Each node has room for CMC_UNROLLEDLIST_NODE_SIZE elements, kept at the
+ * start of its array and in order. An insertion only moves the elements of
+ * one node and a full node is split in two halves. An element pushed past the
+ * end of a full node goes to the next one if it has room, or starts a new
+ * node, so elements pushed in order fill their nodes. A removal that leaves a
+ * node less than a quarter full merges it with a neighbour when both fit in
+ * one node, and an empty node is freed.
+ *
+ * Only one pointer is followed for every node instead of for every element,
+ * so finding an index and iterating over the list read memory almost as an
+ * array would.
+ */
+
+#ifndef CMC_UNROLLEDLIST_H
+#define CMC_UNROLLEDLIST_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_dump.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* Maximum amount of elements in a node, at least 2 */
+#ifndef CMC_UNROLLEDLIST_NODE_SIZE
+#define CMC_UNROLLEDLIST_NODE_SIZE 16
+#endif
+
+/* to_string format */
+static const char *cmc_string_fmt_unrolledlist = "%s at %p { count:%" PRIuMAX ", nodes:%" PRIuMAX ", head:%p, tail:%p }";
+
+#define CMC_GENERATE_UNROLLEDLIST(PFX, SNAME, V)    \
+    CMC_GENERATE_UNROLLEDLIST_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_UNROLLEDLIST_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_UNROLLEDLIST_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_UNROLLEDLIST_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_UNROLLEDLIST_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_UNROLLEDLIST_SOURCE(PFX, SNAME, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_UNROLLEDLIST_HEADER(PFX, SNAME, V)                                           \
+    /* Unrolled List Structure */                                                                 \
+    struct SNAME                                                                                  \
+    {                                                                                             \
+        /* First node in the list */                                                              \
+        struct SNAME##_node *head;                                                                \
+                                                                                                  \
+        /* Last node in the list */                                                               \
+        struct SNAME##_node *tail;                                                                \
+                                                                                                  \
+        /* Current amount of elements in the list */                                              \
+        size_t count;                                                                             \
+                                                                                                  \
+        /* Current amount of nodes in the list */                                                 \
+        size_t nodes;                                                                             \
+                                                                                                  \
+        /* Custom allocation functions */                                                         \
+        struct cmc_alloc_node *alloc;                                                             \
+    };                                                                                            \
+                                                                                                  \
+    /* Unrolled List Node */                                                                      \
+    struct SNAME##_node                                                                           \
+    {                                                                                             \
+        /* Elements of the node, the first count ones are in use */                               \
+        V data[CMC_UNROLLEDLIST_NODE_SIZE];                                                       \
+                                                                                                  \
+        /* Amount of elements in the node, never 0 */                                             \
+        size_t count;                                                                             \
+                                                                                                  \
+        /* Pointer to the next node on the list */                                                \
+        struct SNAME##_node *next;                                                                \
+                                                                                                  \
+        /* Pointer to the previous node on the list */                                            \
+        struct SNAME##_node *prev;                                                                \
+    };                                                                                            \
+                                                                                                  \
+    /* Unrolled List Iterator */                                                                  \
+    struct SNAME##_iter                                                                           \
+    {                                                                                             \
+        /* Target Unrolled List */                                                                \
+        struct SNAME *target;                                                                     \
+                                                                                                  \
+        /* Node of the cursor's element */                                                        \
+        struct SNAME##_node *cursor;                                                              \
+                                                                                                  \
+        /* Position of the cursor's element in its node */                                        \
+        size_t offset;                                                                            \
+                                                                                                  \
+        /* Keeps track of relative index to the iteration of elements */                          \
+        size_t index;                                                                             \
+                                                                                                  \
+        /* If the iterator has reached the start of the iteration */                              \
+        bool start;                                                                               \
+                                                                                                  \
+        /* If the iterator has reached the end of the iteration */                                \
+        bool end;                                                                                 \
+    };                                                                                            \
+                                                                                                  \
+    /* Collection Functions */                                                                    \
+    /* Collection Allocation and Deallocation */                                                  \
+    struct SNAME *PFX##_new(void);                                                                \
+    struct SNAME *PFX##_new_custom(struct cmc_alloc_node *alloc);                                 \
+    void PFX##_clear(struct SNAME *_list_, void (*deallocator)(V));                               \
+    void PFX##_free(struct SNAME *_list_, void (*deallocator)(V));                                \
+    /* Collection Input and Output */                                                             \
+    bool PFX##_push_front(struct SNAME *_list_, V element);                                       \
+    bool PFX##_push_at(struct SNAME *_list_, V element, size_t index);                            \
+    bool PFX##_push_back(struct SNAME *_list_, V element);                                        \
+    bool PFX##_pop_front(struct SNAME *_list_);                                                   \
+    bool PFX##_pop_at(struct SNAME *_list_, size_t index);                                        \
+    bool PFX##_pop_back(struct SNAME *_list_);                                                    \
+    /* Element Access */                                                                          \
+    V PFX##_front(struct SNAME *_list_);                                                          \
+    V PFX##_get(struct SNAME *_list_, size_t index);                                              \
+    V *PFX##_get_ref(struct SNAME *_list_, size_t index);                                         \
+    V PFX##_back(struct SNAME *_list_);                                                           \
+    /* Collection State */                                                                        \
+    bool PFX##_contains(struct SNAME *_list_, V element, int (*comparator)(V, V));                \
+    CMC_PURE bool PFX##_empty(struct SNAME *_list_);                                              \
+    CMC_PURE size_t PFX##_count(struct SNAME *_list_);                                            \
+    size_t PFX##_memory_usage(struct SNAME *_list_);                                              \
+    /* Collection Utility */                                                                      \
+    struct SNAME *PFX##_copy_of(struct SNAME *_list_, V (*copy_func)(V));                         \
+    bool PFX##_equals(struct SNAME *_list1_, struct SNAME *_list2_, int (*comparator)(V, V));     \
+    struct cmc_string PFX##_to_string(struct SNAME *_list_);                                      \
+    bool PFX##_to_string_full(struct SNAME *_list_, struct cmc_string_builder *builder,           \
+                              const char *elem_fmt);                                              \
+    bool PFX##_write(struct SNAME *_list_, FILE *file, void (*fmt)(FILE *, V));                   \
+    bool PFX##_write_fd(struct SNAME *_list_, int fd, void (*fmt)(struct cmc_dump *, V));         \
+                                                                                                  \
+    /* Node Related Functions */                                                                  \
+    /* Node Access Relative to an Unrolled List */                                                \
+    struct SNAME##_node *PFX##_head(struct SNAME *_list_);                                        \
+    struct SNAME##_node *PFX##_get_node(struct SNAME *_list_, size_t index, size_t *offset);      \
+    struct SNAME##_node *PFX##_tail(struct SNAME *_list_);                                        \
+    /* Input and Output Relative to a Node */                                                     \
+    bool PFX##_insert_after(struct SNAME *_owner_, struct SNAME##_node *_node_, size_t offset,    \
+                            V element);                                                           \
+    bool PFX##_insert_before(struct SNAME *_owner_, struct SNAME##_node *_node_, size_t offset,   \
+                             V element);                                                          \
+    bool PFX##_remove_current(struct SNAME *_owner_, struct SNAME##_node *_node_, size_t offset); \
+    /* Node Access Relative to an Unrolled List Node */                                           \
+    struct SNAME##_node *PFX##_next_node(struct SNAME##_node *_node_);                            \
+    struct SNAME##_node *PFX##_prev_node(struct SNAME##_node *_node_);                            \
+                                                                                                  \
+    /* Iterator Functions */                                                                      \
+    /* Iterator Allocation and Deallocation */                                                    \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target);                                    \
+    void PFX##_iter_free(struct SNAME##_iter *iter);                                              \
+    /* Iterator Initialization */                                                                 \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target);                        \
+    /* Iterator State */                                                                          \
+    bool PFX##_iter_start(struct SNAME##_iter *iter);                                             \
+    bool PFX##_iter_end(struct SNAME##_iter *iter);                                               \
+    /* Iterator Movement */                                                                       \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter);                                          \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter);                                            \
+    bool PFX##_iter_next(struct SNAME##_iter *iter);                                              \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter);                                              \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps);                             \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps);                              \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index);                               \
+    /* Iterator Access */                                                                         \
+    V PFX##_iter_value(struct SNAME##_iter *iter);                                                \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter);                                              \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter);                                           \
+    struct SNAME##_node *PFX##_iter_node(struct SNAME##_iter *iter);                              \
+    size_t PFX##_iter_offset(struct SNAME##_iter *iter);                                          \
+                                                                                                  \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_UNROLLEDLIST_SOURCE(PFX, SNAME, V)                                            \
+    /* Implementation Detail Functions */                                                          \
+    static struct SNAME##_node *PFX##_impl_new_node(struct SNAME *_list_,                          \
+                                                    struct SNAME##_node *prev);                    \
+    static void PFX##_impl_free_node(struct SNAME *_list_, struct SNAME##_node *node);             \
+    static bool PFX##_impl_insert(struct SNAME *_list_, struct SNAME##_node *node, size_t offset,  \
+                                  V element);                                                      \
+    static void PFX##_impl_remove(struct SNAME *_list_, struct SNAME##_node *node, size_t offset); \
+                                                                                                   \
+    struct SNAME *PFX##_new(void)                                                                  \
+    {                                                                                              \
+        return PFX##_new_custom(NULL);                                                             \
+    }                                                                                              \
+                                                                                                   \
+    struct SNAME *PFX##_new_custom(struct cmc_alloc_node *alloc)                                   \
+    {                                                                                              \
+        if (!alloc)                                                                                \
+            alloc = &cmc_alloc_node_default;                                                       \
+                                                                                                   \
+        struct SNAME *_list_ = alloc->malloc(sizeof(struct SNAME));                                \
+                                                                                                   \
+        if (CMC_UNLIKELY(!_list_))                                                                 \
+            return NULL;                                                                           \
+                                                                                                   \
+        _list_->alloc = alloc;                                                                     \
+                                                                                                   \
+        _list_->head = NULL;                                                                       \
+        _list_->tail = NULL;                                                                       \
+        _list_->count = 0;                                                                         \
+        _list_->nodes = 0;                                                                         \
+                                                                                                   \
+        return _list_;                                                                             \
+    }                                                                                              \
+                                                                                                   \
+    void PFX##_clear(struct SNAME *_list_, void (*deallocator)(V))                                 \
+    {                                                                                              \
+        struct SNAME##_node *scan = _list_->head;                                                  \
+                                                                                                   \
+        while (scan != NULL)                                                                       \
+        {                                                                                          \
+            struct SNAME##_node *next = scan->next;                                                \
+                                                                                                   \
+            if (deallocator)                                                                       \
+            {                                                                                      \
+                for (size_t i = 0; i < scan->count; i++)                                           \
+                    deallocator(scan->data[i]);                                                    \
+            }                                                                                      \
+                                                                                                   \
+            _list_->alloc->free(scan);                                                             \
+                                                                                                   \
+            scan = next;                                                                           \
+        }                                                                                          \
+                                                                                                   \
+        _list_->head = NULL;                                                                       \
+        _list_->tail = NULL;                                                                       \
+        _list_->count = 0;                                                                         \
+        _list_->nodes = 0;                                                                         \
+    }                                                                                              \
+                                                                                                   \
+    void PFX##_free(struct SNAME *_list_, void (*deallocator)(V))                                  \
+    {                                                                                              \
+        PFX##_clear(_list_, deallocator);                                                          \
+                                                                                                   \
+        _list_->alloc->free(_list_);                                                               \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_push_front(struct SNAME *_list_, V element)                                         \
+    {                                                                                              \
+        return PFX##_impl_insert(_list_, _list_->head, 0, element);                                \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_push_at(struct SNAME *_list_, V element, size_t index)                              \
+    {                                                                                              \
+        if (index > _list_->count)                                                                 \
+            return false;                                                                          \
+                                                                                                   \
+        if (index == _list_->count)                                                                \
+            return PFX##_push_back(_list_, element);                                               \
+                                                                                                   \
+        size_t offset;                                                                             \
+        struct SNAME##_node *_node_ = PFX##_get_node(_list_, index, &offset);                      \
+                                                                                                   \
+        return PFX##_impl_insert(_list_, _node_, offset, element);                                 \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_push_back(struct SNAME *_list_, V element)                                          \
+    {                                                                                              \
+        size_t offset = _list_->tail ? _list_->tail->count : 0;                                    \
+                                                                                                   \
+        return PFX##_impl_insert(_list_, _list_->tail, offset, element);                           \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_pop_front(struct SNAME *_list_)                                                     \
+    {                                                                                              \
+        if (PFX##_empty(_list_))                                                                   \
+            return false;                                                                          \
+                                                                                                   \
+        PFX##_impl_remove(_list_, _list_->head, 0);                                                \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_pop_at(struct SNAME *_list_, size_t index)                                          \
+    {                                                                                              \
+        if (index >= _list_->count)                                                                \
+            return false;                                                                          \
+                                                                                                   \
+        size_t offset;                                                                             \
+        struct SNAME##_node *_node_ = PFX##_get_node(_list_, index, &offset);                      \
+                                                                                                   \
+        PFX##_impl_remove(_list_, _node_, offset);                                                 \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_pop_back(struct SNAME *_list_)                                                      \
+    {                                                                                              \
+        if (PFX##_empty(_list_))                                                                   \
+            return false;                                                                          \
+                                                                                                   \
+        PFX##_impl_remove(_list_, _list_->tail, _list_->tail->count - 1);                          \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    V PFX##_front(struct SNAME *_list_)                                                            \
+    {                                                                                              \
+        if (PFX##_empty(_list_))                                                                   \
+            return (V){0};                                                                         \
+                                                                                                   \
+        return _list_->head->data[0];                                                              \
+    }                                                                                              \
+                                                                                                   \
+    V PFX##_get(struct SNAME *_list_, size_t index)                                                \
+    {                                                                                              \
+        size_t offset;                                                                             \
+        struct SNAME##_node *_node_ = PFX##_get_node(_list_, index, &offset);                      \
+                                                                                                   \
+        if (!_node_)                                                                               \
+            return (V){0};                                                                         \
+                                                                                                   \
+        return _node_->data[offset];                                                               \
+    }                                                                                              \
+                                                                                                   \
+    V *PFX##_get_ref(struct SNAME *_list_, size_t index)                                           \
+    {                                                                                              \
+        size_t offset;                                                                             \
+        struct SNAME##_node *_node_ = PFX##_get_node(_list_, index, &offset);                      \
+                                                                                                   \
+        if (!_node_)                                                                               \
+            return NULL;                                                                           \
+                                                                                                   \
+        return &(_node_->data[offset]);                                                            \
+    }                                                                                              \
+                                                                                                   \
+    V PFX##_back(struct SNAME *_list_)                                                             \
+    {                                                                                              \
+        if (PFX##_empty(_list_))                                                                   \
+            return (V){0};                                                                         \
+                                                                                                   \
+        return _list_->tail->data[_list_->tail->count - 1];                                        \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_contains(struct SNAME *_list_, V element, int (*comparator)(V, V))                  \
+    {                                                                                              \
+        for (struct SNAME##_node *scan = _list_->head; scan != NULL; scan = scan->next)            \
+        {                                                                                          \
+            for (size_t i = 0; i < scan->count; i++)                                               \
+            {                                                                                      \
+                if (comparator(scan->data[i], element) == 0)                                       \
+                    return true;                                                                   \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        return false;                                                                              \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_empty(struct SNAME *_list_)                                                         \
+    {                                                                                              \
+        return _list_->count == 0;                                                                 \
+    }                                                                                              \
+                                                                                                   \
+    size_t PFX##_count(struct SNAME *_list_)                                                       \
+    {                                                                                              \
+        return _list_->count;                                                                      \
+    }                                                                                              \
+                                                                                                   \
+    size_t PFX##_memory_usage(struct SNAME *_list_)                                                \
+    {                                                                                              \
+        return sizeof(struct SNAME) + sizeof(struct SNAME##_node) * _list_->nodes;                 \
+    }                                                                                              \
+                                                                                                   \
+    /* The nodes of the copy are filled just as the ones of the list */                            \
+    struct SNAME *PFX##_copy_of(struct SNAME *_list_, V (*copy_func)(V))                           \
+    {                                                                                              \
+        struct SNAME *result = PFX##_new_custom(_list_->alloc);                                    \
+                                                                                                   \
+        if (CMC_UNLIKELY(!result))                                                                 \
+            return NULL;                                                                           \
+                                                                                                   \
+        for (struct SNAME##_node *scan = _list_->head; scan != NULL; scan = scan->next)            \
+        {                                                                                          \
+            struct SNAME##_node *_node_ = PFX##_impl_new_node(result, result->tail);               \
+                                                                                                   \
+            if (!_node_)                                                                           \
+            {                                                                                      \
+                PFX##_free(result, NULL);                                                          \
+                return NULL;                                                                       \
+            }                                                                                      \
+                                                                                                   \
+            if (copy_func)                                                                         \
+            {                                                                                      \
+                for (size_t i = 0; i < scan->count; i++)                                           \
+                    _node_->data[i] = copy_func(scan->data[i]);                                    \
+            }                                                                                      \
+            else                                                                                   \
+                memcpy(_node_->data, scan->data, sizeof(V) * scan->count);                         \
+                                                                                                   \
+            _node_->count = scan->count;                                                           \
+        }                                                                                          \
+                                                                                                   \
+        result->count = _list_->count;                                                             \
+                                                                                                   \
+        return result;                                                                             \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_equals(struct SNAME *_list1_, struct SNAME *_list2_, int (*comparator)(V, V))       \
+    {                                                                                              \
+        if (PFX##_count(_list1_) != PFX##_count(_list2_))                                          \
+            return false;                                                                          \
+                                                                                                   \
+        struct SNAME##_node *scan1 = _list1_->head;                                                \
+        struct SNAME##_node *scan2 = _list2_->head;                                                \
+                                                                                                   \
+        size_t offset1 = 0;                                                                        \
+        size_t offset2 = 0;                                                                        \
+                                                                                                   \
+        for (size_t i = 0; i < _list1_->count; i++)                                                \
+        {                                                                                          \
+            if (comparator(scan1->data[offset1], scan2->data[offset2]) != 0)                       \
+                return false;                                                                      \
+                                                                                                   \
+            if (++offset1 == scan1->count)                                                         \
+            {                                                                                      \
+                scan1 = scan1->next;                                                               \
+                offset1 = 0;                                                                       \
+            }                                                                                      \
+                                                                                                   \
+            if (++offset2 == scan2->count)                                                         \
+            {                                                                                      \
+                scan2 = scan2->next;                                                               \
+                offset2 = 0;                                                                       \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    struct cmc_string PFX##_to_string(struct SNAME *_list_)                                        \
+    {                                                                                              \
+        struct cmc_string str;                                                                     \
+        struct SNAME *l_ = _list_;                                                                 \
+        const char *name = #SNAME;                                                                 \
+                                                                                                   \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_unrolledlist, name, l_, l_->count,          \
+                 l_->nodes, l_->head, l_->tail);                                                   \
+                                                                                                   \
+        return str;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    CMC_IMPL_STRING_FULL(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE)                                 \
+                                                                                                   \
+    CMC_IMPL_DUMP(PFX, SNAME, SNAME, CMC_IMPL_STRING_VALUE, (V))                                   \
+                                                                                                   \
+    struct SNAME##_node *PFX##_head(struct SNAME *_list_)                                          \
+    {                                                                                              \
+        return _list_->head;                                                                       \
+    }                                                                                              \
+                                                                                                   \
+    /* Returns the node with the element at index and its position in the node */                  \
+    /* through offset. The walk starts from whichever end is closer */                             \
+    struct SNAME##_node *PFX##_get_node(struct SNAME *_list_, size_t index, size_t *offset)        \
+    {                                                                                              \
+        if (index >= _list_->count)                                                                \
+            return NULL;                                                                           \
+                                                                                                   \
+        struct SNAME##_node *_node_ = NULL;                                                        \
+                                                                                                   \
+        if (index < _list_->count / 2)                                                             \
+        {                                                                                          \
+            _node_ = _list_->head;                                                                 \
+                                                                                                   \
+            while (index >= _node_->count)                                                         \
+            {                                                                                      \
+                index -= _node_->count;                                                            \
+                _node_ = _node_->next;                                                             \
+            }                                                                                      \
+        }                                                                                          \
+        else                                                                                       \
+        {                                                                                          \
+            /* Elements from index to the end of the list */                                       \
+            size_t rest = _list_->count - index;                                                   \
+                                                                                                   \
+            _node_ = _list_->tail;                                                                 \
+                                                                                                   \
+            while (rest > _node_->count)                                                           \
+            {                                                                                      \
+                rest -= _node_->count;                                                             \
+                _node_ = _node_->prev;                                                             \
+            }                                                                                      \
+                                                                                                   \
+            index = _node_->count - rest;                                                          \
+        }                                                                                          \
+                                                                                                   \
+        if (offset)                                                                                \
+            *offset = index;                                                                       \
+                                                                                                   \
+        return _node_;                                                                             \
+    }                                                                                              \
+                                                                                                   \
+    struct SNAME##_node *PFX##_tail(struct SNAME *_list_)                                          \
+    {                                                                                              \
+        return _list_->tail;                                                                       \
+    }                                                                                              \
+                                                                                                   \
+    /* Nodes might be split, merged or freed by these functions, so only the */                    \
+    /* nodes returned afterwards are valid */                                                      \
+    bool PFX##_insert_after(struct SNAME *_owner_, struct SNAME##_node *_node_, size_t offset,     \
+                            V element)                                                             \
+    {                                                                                              \
+        if (offset >= _node_->count)                                                               \
+            return false;                                                                          \
+                                                                                                   \
+        return PFX##_impl_insert(_owner_, _node_, offset + 1, element);                            \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_insert_before(struct SNAME *_owner_, struct SNAME##_node *_node_, size_t offset,    \
+                             V element)                                                            \
+    {                                                                                              \
+        if (offset >= _node_->count)                                                               \
+            return false;                                                                          \
+                                                                                                   \
+        return PFX##_impl_insert(_owner_, _node_, offset, element);                                \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_remove_current(struct SNAME *_owner_, struct SNAME##_node *_node_, size_t offset)   \
+    {                                                                                              \
+        if (offset >= _node_->count)                                                               \
+            return false;                                                                          \
+                                                                                                   \
+        PFX##_impl_remove(_owner_, _node_, offset);                                                \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    struct SNAME##_node *PFX##_next_node(struct SNAME##_node *_node_)                              \
+    {                                                                                              \
+        return _node_->next;                                                                       \
+    }                                                                                              \
+                                                                                                   \
+    struct SNAME##_node *PFX##_prev_node(struct SNAME##_node *_node_)                              \
+    {                                                                                              \
+        return _node_->prev;                                                                       \
+    }                                                                                              \
+                                                                                                   \
+    struct SNAME##_iter *PFX##_iter_new(struct SNAME *target)                                      \
+    {                                                                                              \
+        struct SNAME##_iter *iter = target->alloc->malloc(sizeof(struct SNAME##_iter));            \
+                                                                                                   \
+        if (CMC_UNLIKELY(!iter))                                                                   \
+            return NULL;                                                                           \
+                                                                                                   \
+        PFX##_iter_init(iter, target);                                                             \
+                                                                                                   \
+        return iter;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    void PFX##_iter_free(struct SNAME##_iter *iter)                                                \
+    {                                                                                              \
+        iter->target->alloc->free(iter);                                                           \
+    }                                                                                              \
+                                                                                                   \
+    void PFX##_iter_init(struct SNAME##_iter *iter, struct SNAME *target)                          \
+    {                                                                                              \
+        iter->target = target;                                                                     \
+        iter->cursor = target->head;                                                               \
+        iter->offset = 0;                                                                          \
+        iter->index = 0;                                                                           \
+        iter->start = true;                                                                        \
+        iter->end = PFX##_empty(target);                                                           \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_iter_start(struct SNAME##_iter *iter)                                               \
+    {                                                                                              \
+        return PFX##_empty(iter->target) || iter->start;                                           \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_iter_end(struct SNAME##_iter *iter)                                                 \
+    {                                                                                              \
+        return PFX##_empty(iter->target) || iter->end;                                             \
+    }                                                                                              \
+                                                                                                   \
+    void PFX##_iter_to_start(struct SNAME##_iter *iter)                                            \
+    {                                                                                              \
+        if (!PFX##_empty(iter->target))                                                            \
+        {                                                                                          \
+            iter->cursor = iter->target->head;                                                     \
+            iter->offset = 0;                                                                      \
+            iter->index = 0;                                                                       \
+            iter->start = true;                                                                    \
+            iter->end = false;                                                                     \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    void PFX##_iter_to_end(struct SNAME##_iter *iter)                                              \
+    {                                                                                              \
+        if (!PFX##_empty(iter->target))                                                            \
+        {                                                                                          \
+            iter->cursor = iter->target->tail;                                                     \
+            iter->offset = iter->target->tail->count - 1;                                          \
+            iter->index = iter->target->count - 1;                                                 \
+            iter->start = false;                                                                   \
+            iter->end = true;                                                                      \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_iter_next(struct SNAME##_iter *iter)                                                \
+    {                                                                                              \
+        if (iter->end)                                                                             \
+            return false;                                                                          \
+                                                                                                   \
+        if (iter->index + 1 == iter->target->count)                                                \
+        {                                                                                          \
+            iter->end = true;                                                                      \
+            return false;                                                                          \
+        }                                                                                          \
+                                                                                                   \
+        iter->start = false;                                                                       \
+                                                                                                   \
+        if (++iter->offset == iter->cursor->count)                                                 \
+        {                                                                                          \
+            iter->cursor = iter->cursor->next;                                                     \
+            iter->offset = 0;                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        iter->index++;                                                                             \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_iter_prev(struct SNAME##_iter *iter)                                                \
+    {                                                                                              \
+        if (iter->start)                                                                           \
+            return false;                                                                          \
+                                                                                                   \
+        if (iter->index == 0)                                                                      \
+        {                                                                                          \
+            iter->start = true;                                                                    \
+            return false;                                                                          \
+        }                                                                                          \
+                                                                                                   \
+        iter->end = false;                                                                         \
+                                                                                                   \
+        if (iter->offset == 0)                                                                     \
+        {                                                                                          \
+            iter->cursor = iter->cursor->prev;                                                     \
+            iter->offset = iter->cursor->count;                                                    \
+        }                                                                                          \
+                                                                                                   \
+        iter->offset--;                                                                            \
+        iter->index--;                                                                             \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Returns true only if the iterator moved. Whole nodes are skipped at once */                 \
+    bool PFX##_iter_advance(struct SNAME##_iter *iter, size_t steps)                               \
+    {                                                                                              \
+        if (iter->end)                                                                             \
+            return false;                                                                          \
+                                                                                                   \
+        if (iter->index + 1 == iter->target->count)                                                \
+        {                                                                                          \
+            iter->end = true;                                                                      \
+            return false;                                                                          \
+        }                                                                                          \
+                                                                                                   \
+        if (steps == 0 || iter->index + steps >= iter->target->count)                              \
+            return false;                                                                          \
+                                                                                                   \
+        iter->start = false;                                                                       \
+        iter->index += steps;                                                                      \
+                                                                                                   \
+        steps += iter->offset;                                                                     \
+                                                                                                   \
+        while (steps >= iter->cursor->count)                                                       \
+        {                                                                                          \
+            steps -= iter->cursor->count;                                                          \
+            iter->cursor = iter->cursor->next;                                                     \
+        }                                                                                          \
+                                                                                                   \
+        iter->offset = steps;                                                                      \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Returns true only if the iterator moved. Whole nodes are skipped at once */                 \
+    bool PFX##_iter_rewind(struct SNAME##_iter *iter, size_t steps)                                \
+    {                                                                                              \
+        if (iter->start)                                                                           \
+            return false;                                                                          \
+                                                                                                   \
+        if (iter->index == 0)                                                                      \
+        {                                                                                          \
+            iter->start = true;                                                                    \
+            return false;                                                                          \
+        }                                                                                          \
+                                                                                                   \
+        if (steps == 0 || iter->index < steps)                                                     \
+            return false;                                                                          \
+                                                                                                   \
+        iter->end = false;                                                                         \
+        iter->index -= steps;                                                                      \
+                                                                                                   \
+        while (steps > iter->offset)                                                               \
+        {                                                                                          \
+            steps -= iter->offset + 1;                                                             \
+            iter->cursor = iter->cursor->prev;                                                     \
+            iter->offset = iter->cursor->count - 1;                                                \
+        }                                                                                          \
+                                                                                                   \
+        iter->offset -= steps;                                                                     \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Returns true only if the iterator was able to be positioned at the given */                 \
+    /* index */                                                                                    \
+    bool PFX##_iter_go_to(struct SNAME##_iter *iter, size_t index)                                 \
+    {                                                                                              \
+        if (index >= PFX##_count(iter->target))                                                    \
+            return false;                                                                          \
+                                                                                                   \
+        if (iter->index > index)                                                                   \
+            return PFX##_iter_rewind(iter, iter->index - index);                                   \
+        else if (iter->index < index)                                                              \
+            return PFX##_iter_advance(iter, index - iter->index);                                  \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    V PFX##_iter_value(struct SNAME##_iter *iter)                                                  \
+    {                                                                                              \
+        if (PFX##_empty(iter->target))                                                             \
+            return (V){0};                                                                         \
+                                                                                                   \
+        return iter->cursor->data[iter->offset];                                                   \
+    }                                                                                              \
+                                                                                                   \
+    V *PFX##_iter_rvalue(struct SNAME##_iter *iter)                                                \
+    {                                                                                              \
+        if (PFX##_empty(iter->target))                                                             \
+            return NULL;                                                                           \
+                                                                                                   \
+        return &(iter->cursor->data[iter->offset]);                                                \
+    }                                                                                              \
+                                                                                                   \
+    size_t PFX##_iter_index(struct SNAME##_iter *iter)                                             \
+    {                                                                                              \
+        return iter->index;                                                                        \
+    }                                                                                              \
+                                                                                                   \
+    struct SNAME##_node *PFX##_iter_node(struct SNAME##_iter *iter)                                \
+    {                                                                                              \
+        return iter->cursor;                                                                       \
+    }                                                                                              \
+                                                                                                   \
+    size_t PFX##_iter_offset(struct SNAME##_iter *iter)                                            \
+    {                                                                                              \
+        return iter->offset;                                                                       \
+    }                                                                                              \
+                                                                                                   \
+    /* Allocates an empty node linked right after prev, or as the head if prev is */               \
+    /* NULL */                                                                                     \
+    static struct SNAME##_node *PFX##_impl_new_node(struct SNAME *_list_,                          \
+                                                    struct SNAME##_node *prev)                     \
+    {                                                                                              \
+        struct SNAME##_node *node = _list_->alloc->malloc(sizeof(struct SNAME##_node));            \
+                                                                                                   \
+        if (CMC_UNLIKELY(!node))                                                                   \
+            return NULL;                                                                           \
+                                                                                                   \
+        node->count = 0;                                                                           \
+        node->prev = prev;                                                                         \
+        node->next = prev ? prev->next : _list_->head;                                             \
+                                                                                                   \
+        if (node->next)                                                                            \
+            node->next->prev = node;                                                               \
+        else                                                                                       \
+            _list_->tail = node;                                                                   \
+                                                                                                   \
+        if (prev)                                                                                  \
+            prev->next = node;                                                                     \
+        else                                                                                       \
+            _list_->head = node;                                                                   \
+                                                                                                   \
+        _list_->nodes++;                                                                           \
+                                                                                                   \
+        return node;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    static void PFX##_impl_free_node(struct SNAME *_list_, struct SNAME##_node *node)              \
+    {                                                                                              \
+        if (node->prev)                                                                            \
+            node->prev->next = node->next;                                                         \
+        else                                                                                       \
+            _list_->head = node->next;                                                             \
+                                                                                                   \
+        if (node->next)                                                                            \
+            node->next->prev = node->prev;                                                         \
+        else                                                                                       \
+            _list_->tail = node->prev;                                                             \
+                                                                                                   \
+        _list_->nodes--;                                                                           \
+                                                                                                   \
+        _list_->alloc->free(node);                                                                 \
+    }                                                                                              \
+                                                                                                   \
+    /* Places element at offset in node, where offset is at most the amount of */                  \
+    /* elements of the node. The node is only NULL if the list is empty */                         \
+    static bool PFX##_impl_insert(struct SNAME *_list_, struct SNAME##_node *node, size_t offset,  \
+                                  V element)                                                       \
+    {                                                                                              \
+        if (!node)                                                                                 \
+        {                                                                                          \
+            node = PFX##_impl_new_node(_list_, NULL);                                              \
+                                                                                                   \
+            if (!node)                                                                             \
+                return false;                                                                      \
+        }                                                                                          \
+        else if (node->count == CMC_UNROLLEDLIST_NODE_SIZE)                                        \
+        {                                                                                          \
+            struct SNAME##_node *next = node->next;                                                \
+            struct SNAME##_node *prev = node->prev;                                                \
+                                                                                                   \
+            if (offset == node->count && next && next->count < CMC_UNROLLEDLIST_NODE_SIZE)         \
+            {                                                                                      \
+                node = next;                                                                       \
+                offset = 0;                                                                        \
+            }                                                                                      \
+            else if (offset == 0 && prev && prev->count < CMC_UNROLLEDLIST_NODE_SIZE)              \
+            {                                                                                      \
+                node = prev;                                                                       \
+                offset = prev->count;                                                              \
+            }                                                                                      \
+            else                                                                                   \
+            {                                                                                      \
+                struct SNAME##_node *split = PFX##_impl_new_node(_list_, node);                    \
+                                                                                                   \
+                if (!split)                                                                        \
+                    return false;                                                                  \
+                                                                                                   \
+                /* An element past the end of the node starts a new one */                         \
+                if (offset < node->count)                                                          \
+                {                                                                                  \
+                    size_t half = node->count / 2;                                                 \
+                                                                                                   \
+                    split->count = node->count - half;                                             \
+                    memcpy(split->data, node->data + half, sizeof(V) * split->count);              \
+                    node->count = half;                                                            \
+                                                                                                   \
+                    if (offset > half)                                                             \
+                    {                                                                              \
+                        node = split;                                                              \
+                        offset -= half;                                                            \
+                    }                                                                              \
+                }                                                                                  \
+                else                                                                               \
+                {                                                                                  \
+                    node = split;                                                                  \
+                    offset = 0;                                                                    \
+                }                                                                                  \
+            }                                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        memmove(node->data + offset + 1, node->data + offset, sizeof(V) * (node->count - offset)); \
+                                                                                                   \
+        node->data[offset] = element;                                                              \
+        node->count++;                                                                             \
+                                                                                                   \
+        _list_->count++;                                                                           \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    static void PFX##_impl_remove(struct SNAME *_list_, struct SNAME##_node *node, size_t offset)  \
+    {                                                                                              \
+        memmove(node->data + offset, node->data + offset + 1,                                      \
+                sizeof(V) * (node->count - offset - 1));                                           \
+                                                                                                   \
+        node->count--;                                                                             \
+                                                                                                   \
+        _list_->count--;                                                                           \
+                                                                                                   \
+        if (node->count == 0)                                                                      \
+        {                                                                                          \
+            PFX##_impl_free_node(_list_, node);                                                    \
+            return;                                                                                \
+        }                                                                                          \
+                                                                                                   \
+        if (node->count * 4 >= CMC_UNROLLEDLIST_NODE_SIZE)                                         \
+            return;                                                                                \
+                                                                                                   \
+        /* A node less than a quarter full is merged with a neighbour if both of */                \
+        /* them fit in one node */                                                                 \
+        struct SNAME##_node *next = node->next;                                                    \
+        struct SNAME##_node *prev = node->prev;                                                    \
+                                                                                                   \
+        if (next && node->count + next->count <= CMC_UNROLLEDLIST_NODE_SIZE)                       \
+        {                                                                                          \
+            memcpy(node->data + node->count, next->data, sizeof(V) * next->count);                 \
+            node->count += next->count;                                                            \
+                                                                                                   \
+            PFX##_impl_free_node(_list_, next);                                                    \
+        }                                                                                          \
+        else if (prev && prev->count + node->count <= CMC_UNROLLEDLIST_NODE_SIZE)                  \
+        {                                                                                          \
+            memcpy(prev->data + prev->count, node->data, sizeof(V) * node->count);                 \
+            prev->count += node->count;                                                            \
+                                                                                                   \
+            PFX##_impl_free_node(_list_, node);                                                    \
+        }                                                                                          \
+    }
+
+#endif /* CMC_UNROLLEDLIST_H */
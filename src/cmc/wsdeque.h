@@ -0,0 +1,369 @@
+/**
+ * wsdeque.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * WSDeque
+ *
+ * A WSDeque (work-stealing deque) is a Deque shared by one owner thread and
+ * any amount of thief threads, the building block of the worker queues of a
+ * task scheduler. The owner pushes and pops elements at the bottom, like a
+ * Stack, and thieves steal the oldest elements from the top, without locks.
+ * Only one thread may call push and pop at a time. Requires C11 atomics.
+ *
+ * Implementation
+ *
+ * This is the deque by Chase and Lev, with the C11 memory orderings by Le,
+ * Pop, Cohen and Zappa Nardelli. Elements are kept in a circular array from
+ * the top index to the bottom index. The owner only contends with thieves
+ * when it pops the last element, and thieves claim the top with a compare
+ * and swap. When the array is full the owner copies the elements to one
+ * twice as large. A thief may still be reading the old array, so it is only
+ * freed together with the deque.
+ *
+ * A thief that loses the race for the top element may have read its slot
+ * while the owner was overwriting it, and its copy is then discarded.
+ */
+
+#ifndef CMC_WSDEQUE_H
+#define CMC_WSDEQUE_H
+
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../utl/cmc_alloc.h"
+#include "../utl/cmc_string.h"
+#include "../utl/compiler.h"
+
+/* to_string format */
+static const char *cmc_string_fmt_wsdeque = "%s at %p { array:%p, capacity:%" PRIuMAX ", count:%" PRIuMAX " }";
+
+/* The indices are padded to this size to avoid false sharing */
+#ifndef CMC_CACHE_LINE_SIZE
+#define CMC_CACHE_LINE_SIZE 64
+#endif
+
+#define CMC_GENERATE_WSDEQUE(PFX, SNAME, V)    \
+    CMC_GENERATE_WSDEQUE_HEADER(PFX, SNAME, V) \
+    CMC_GENERATE_WSDEQUE_SOURCE(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_WSDEQUE_HEADER(PFX, SNAME, K, V) \
+    CMC_GENERATE_WSDEQUE_HEADER(PFX, SNAME, V)
+
+#define CMC_WRAPGEN_WSDEQUE_SOURCE(PFX, SNAME, K, V) \
+    CMC_GENERATE_WSDEQUE_SOURCE(PFX, SNAME, V)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_WSDEQUE_HEADER(PFX, SNAME, V)                              \
+    /* Circular array of elements */                                            \
+    struct SNAME##_array                                                        \
+    {                                                                           \
+        /* Amount of elements it holds, a power of two */                       \
+        size_t capacity;                                                        \
+                                                                                \
+        /* Previous array replaced when growing, freed with the deque */        \
+        struct SNAME##_array *retired;                                          \
+                                                                                \
+        V buffer[];                                                             \
+    };                                                                          \
+                                                                                \
+    /* WSDeque Structure */                                                     \
+    struct SNAME                                                                \
+    {                                                                           \
+        /* Index of the oldest element, advanced by thieves and by the owner */ \
+        /* when it pops the last one */                                         \
+        atomic_size_t top;                                                      \
+                                                                                \
+        char top_padding[CMC_CACHE_LINE_SIZE - sizeof(atomic_size_t)];          \
+                                                                                \
+        /* Index after the newest element, only written by the owner */         \
+        atomic_size_t bottom;                                                   \
+                                                                                \
+        char bottom_padding[CMC_CACHE_LINE_SIZE - sizeof(atomic_size_t)];       \
+                                                                                \
+        /* Current array, replaced by the owner when it grows */                \
+        struct SNAME##_array *_Atomic array;                                    \
+                                                                                \
+        /* Custom allocation functions */                                       \
+        struct cmc_alloc_node *alloc;                                           \
+    };                                                                          \
+                                                                                \
+    /* Collection Functions */                                                  \
+    /* Collection Allocation and Deallocation */                                \
+    struct SNAME *PFX##_new(size_t capacity);                                   \
+    struct SNAME *PFX##_new_custom(size_t capacity,                             \
+                                   struct cmc_alloc_node *alloc);               \
+    void PFX##_free(struct SNAME *_deque_, void (*deallocator)(V));             \
+    /* Owner Functions */                                                       \
+    bool PFX##_push(struct SNAME *_deque_, V element);                          \
+    bool PFX##_pop(struct SNAME *_deque_, V *result);                           \
+    /* Thief Functions */                                                       \
+    bool PFX##_steal(struct SNAME *_deque_, V *result);                         \
+    /* Collection State */                                                      \
+    bool PFX##_empty(struct SNAME *_deque_);                                    \
+    size_t PFX##_count(struct SNAME *_deque_);                                  \
+    size_t PFX##_memory_usage(struct SNAME *_deque_);                           \
+    size_t PFX##_capacity(struct SNAME *_deque_);                               \
+    /* Collection Utility */                                                    \
+    struct cmc_string PFX##_to_string(struct SNAME *_deque_);                   \
+                                                                                \
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_WSDEQUE_SOURCE(PFX, SNAME, V)                                                 \
+    /* Implementation Detail Functions */                                                          \
+    static struct SNAME##_array *PFX##_impl_new_array(struct SNAME *_deque_, size_t capacity);     \
+    static struct SNAME##_array *PFX##_impl_grow(struct SNAME *_deque_,                            \
+                                                 struct SNAME##_array *array, size_t top,          \
+                                                 size_t bottom);                                   \
+                                                                                                   \
+    /* The capacity is rounded up to a power of two */                                             \
+    struct SNAME *PFX##_new(size_t capacity)                                                       \
+    {                                                                                              \
+        return PFX##_new_custom(capacity, NULL);                                                   \
+    }                                                                                              \
+                                                                                                   \
+    struct SNAME *PFX##_new_custom(size_t capacity, struct cmc_alloc_node *alloc)                  \
+    {                                                                                              \
+        if (!alloc)                                                                                \
+            alloc = &cmc_alloc_node_default;                                                       \
+                                                                                                   \
+        if (capacity < 1 || capacity > SIZE_MAX / 4)                                               \
+            return NULL;                                                                           \
+                                                                                                   \
+        size_t size = 2;                                                                           \
+                                                                                                   \
+        while (size < capacity)                                                                    \
+            size *= 2;                                                                             \
+                                                                                                   \
+        size_t bytes = (sizeof(struct SNAME) + CMC_CACHE_LINE_SIZE - 1) / CMC_CACHE_LINE_SIZE;     \
+                                                                                                   \
+        struct SNAME *_deque_ = cmc_alloc_aligned(alloc, CMC_CACHE_LINE_SIZE,                      \
+                                                  bytes * CMC_CACHE_LINE_SIZE);                    \
+                                                                                                   \
+        if (CMC_UNLIKELY(!_deque_))                                                                \
+            return NULL;                                                                           \
+                                                                                                   \
+        _deque_->alloc = alloc;                                                                    \
+                                                                                                   \
+        struct SNAME##_array *array = PFX##_impl_new_array(_deque_, size);                         \
+                                                                                                   \
+        if (!array)                                                                                \
+        {                                                                                          \
+            cmc_alloc_aligned_free(alloc, _deque_);                                                \
+            return NULL;                                                                           \
+        }                                                                                          \
+                                                                                                   \
+        /* The indices start at 1 so that bottom - 1 never wraps around */                         \
+        atomic_init(&(_deque_->top), 1);                                                           \
+        atomic_init(&(_deque_->bottom), 1);                                                        \
+        atomic_init(&(_deque_->array), array);                                                     \
+                                                                                                   \
+        return _deque_;                                                                            \
+    }                                                                                              \
+                                                                                                   \
+    /* Not thread safe, no other thread can be using the deque */                                  \
+    void PFX##_free(struct SNAME *_deque_, void (*deallocator)(V))                                 \
+    {                                                                                              \
+        V value;                                                                                   \
+                                                                                                   \
+        while (deallocator && PFX##_pop(_deque_, &value))                                          \
+            deallocator(value);                                                                    \
+                                                                                                   \
+        struct SNAME##_array *array = atomic_load(&(_deque_->array));                              \
+                                                                                                   \
+        while (array)                                                                              \
+        {                                                                                          \
+            struct SNAME##_array *retired = array->retired;                                        \
+                                                                                                   \
+            _deque_->alloc->free(array);                                                           \
+                                                                                                   \
+            array = retired;                                                                       \
+        }                                                                                          \
+                                                                                                   \
+        cmc_alloc_aligned_free(_deque_->alloc, _deque_);                                           \
+    }                                                                                              \
+                                                                                                   \
+    /* Only called by the owner */                                                                 \
+    bool PFX##_push(struct SNAME *_deque_, V element)                                              \
+    {                                                                                              \
+        size_t b = atomic_load_explicit(&(_deque_->bottom), memory_order_relaxed);                 \
+        size_t t = atomic_load_explicit(&(_deque_->top), memory_order_acquire);                    \
+                                                                                                   \
+        struct SNAME##_array *array = atomic_load_explicit(&(_deque_->array),                      \
+                                                           memory_order_relaxed);                  \
+                                                                                                   \
+        if (b - t >= array->capacity)                                                              \
+        {                                                                                          \
+            array = PFX##_impl_grow(_deque_, array, t, b);                                         \
+                                                                                                   \
+            if (!array)                                                                            \
+                return false;                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        array->buffer[b & (array->capacity - 1)] = element;                                        \
+                                                                                                   \
+        atomic_store_explicit(&(_deque_->bottom), b + 1, memory_order_release);                    \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Only called by the owner. Pops the newest element */                                        \
+    bool PFX##_pop(struct SNAME *_deque_, V *result)                                               \
+    {                                                                                              \
+        size_t b = atomic_load_explicit(&(_deque_->bottom), memory_order_relaxed) - 1;             \
+                                                                                                   \
+        struct SNAME##_array *array = atomic_load_explicit(&(_deque_->array),                      \
+                                                           memory_order_relaxed);                  \
+                                                                                                   \
+        /* The bottom is moved before the top is read, so a thief either sees */                   \
+        /* the element gone or the owner sees the thief's steal */                                 \
+        atomic_store_explicit(&(_deque_->bottom), b, memory_order_seq_cst);                        \
+                                                                                                   \
+        size_t t = atomic_load_explicit(&(_deque_->top), memory_order_seq_cst);                    \
+                                                                                                   \
+        if (t > b)                                                                                 \
+        {                                                                                          \
+            atomic_store_explicit(&(_deque_->bottom), b + 1, memory_order_relaxed);                \
+            return false;                                                                          \
+        }                                                                                          \
+                                                                                                   \
+        V value = array->buffer[b & (array->capacity - 1)];                                        \
+                                                                                                   \
+        /* The last element, thieves might be stealing it */                                       \
+        if (t == b)                                                                                \
+        {                                                                                          \
+            bool won = atomic_compare_exchange_strong_explicit(                                    \
+                &(_deque_->top), &t, t + 1, memory_order_seq_cst, memory_order_relaxed);           \
+                                                                                                   \
+            atomic_store_explicit(&(_deque_->bottom), b + 1, memory_order_relaxed);                \
+                                                                                                   \
+            if (!won)                                                                              \
+                return false;                                                                      \
+        }                                                                                          \
+                                                                                                   \
+        *result = value;                                                                           \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Called by any thread. Steals the oldest element. Returns false if the */                    \
+    /* deque is empty or if another thread took that element first */                              \
+    bool PFX##_steal(struct SNAME *_deque_, V *result)                                             \
+    {                                                                                              \
+        size_t t = atomic_load_explicit(&(_deque_->top), memory_order_seq_cst);                    \
+        size_t b = atomic_load_explicit(&(_deque_->bottom), memory_order_seq_cst);                 \
+                                                                                                   \
+        if (t >= b)                                                                                \
+            return false;                                                                          \
+                                                                                                   \
+        struct SNAME##_array *array = atomic_load_explicit(&(_deque_->array),                      \
+                                                           memory_order_acquire);                  \
+                                                                                                   \
+        V value = array->buffer[t & (array->capacity - 1)];                                        \
+                                                                                                   \
+        if (!atomic_compare_exchange_strong_explicit(&(_deque_->top), &t, t + 1,                   \
+                                                     memory_order_seq_cst,                         \
+                                                     memory_order_relaxed))                        \
+            return false;                                                                          \
+                                                                                                   \
+        *result = value;                                                                           \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    bool PFX##_empty(struct SNAME *_deque_)                                                        \
+    {                                                                                              \
+        return PFX##_count(_deque_) == 0;                                                          \
+    }                                                                                              \
+                                                                                                   \
+    /* Only exact if no other thread is using the deque */                                         \
+    size_t PFX##_count(struct SNAME *_deque_)                                                      \
+    {                                                                                              \
+        size_t t = atomic_load(&(_deque_->top));                                                   \
+        size_t b = atomic_load(&(_deque_->bottom));                                                \
+                                                                                                   \
+        return b > t ? b - t : 0;                                                                  \
+    }                                                                                              \
+                                                                                                   \
+    size_t PFX##_memory_usage(struct SNAME *_deque_)                                               \
+    {                                                                                              \
+        /* The struct takes whole cache lines */                                                   \
+        size_t lines = (sizeof(struct SNAME) + CMC_CACHE_LINE_SIZE - 1) / CMC_CACHE_LINE_SIZE;     \
+        size_t bytes = cmc_alloc_aligned_size(CMC_CACHE_LINE_SIZE, lines * CMC_CACHE_LINE_SIZE);   \
+                                                                                                   \
+        /* Arrays replaced by the owner are kept until the deque is freed */                       \
+        struct SNAME##_array *array = atomic_load(&(_deque_->array));                              \
+                                                                                                   \
+        for (; array; array = array->retired)                                                      \
+            bytes += sizeof(struct SNAME##_array) + sizeof(V) * array->capacity;                   \
+                                                                                                   \
+        return bytes;                                                                              \
+    }                                                                                              \
+                                                                                                   \
+    size_t PFX##_capacity(struct SNAME *_deque_)                                                   \
+    {                                                                                              \
+        return atomic_load(&(_deque_->array))->capacity;                                           \
+    }                                                                                              \
+                                                                                                   \
+    struct cmc_string PFX##_to_string(struct SNAME *_deque_)                                       \
+    {                                                                                              \
+        struct cmc_string str;                                                                     \
+        struct SNAME *d_ = _deque_;                                                                \
+        const char *name = #SNAME;                                                                 \
+                                                                                                   \
+        struct SNAME##_array *array = atomic_load(&(d_->array));                                   \
+                                                                                                   \
+        snprintf(str.s, cmc_string_len, cmc_string_fmt_wsdeque, name, d_, array,                   \
+                 array->capacity, PFX##_count(d_));                                                \
+                                                                                                   \
+        return str;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    static struct SNAME##_array *PFX##_impl_new_array(struct SNAME *_deque_, size_t capacity)      \
+    {                                                                                              \
+        struct SNAME##_array *array =                                                              \
+            _deque_->alloc->malloc(sizeof(struct SNAME##_array) + sizeof(V) * capacity);           \
+                                                                                                   \
+        if (!array)                                                                                \
+            return NULL;                                                                           \
+                                                                                                   \
+        array->capacity = capacity;                                                                \
+        array->retired = NULL;                                                                     \
+                                                                                                   \
+        return array;                                                                              \
+    }                                                                                              \
+                                                                                                   \
+    /* Called by the owner when the array is full. Copies the elements from */                     \
+    /* top to bottom to an array twice as large and publishes it */                                \
+    static struct SNAME##_array *PFX##_impl_grow(struct SNAME *_deque_,                            \
+                                                 struct SNAME##_array *array, size_t top,          \
+                                                 size_t bottom)                                    \
+    {                                                                                              \
+        if (array->capacity > SIZE_MAX / 4)                                                        \
+            return NULL;                                                                           \
+                                                                                                   \
+        struct SNAME##_array *result = PFX##_impl_new_array(_deque_, array->capacity * 2);         \
+                                                                                                   \
+        if (!result)                                                                               \
+            return NULL;                                                                           \
+                                                                                                   \
+        for (size_t i = top; i < bottom; i++)                                                      \
+            result->buffer[i & (result->capacity - 1)] = array->buffer[i & (array->capacity - 1)]; \
+                                                                                                   \
+        result->retired = array;                                                                   \
+                                                                                                   \
+        atomic_store_explicit(&(_deque_->array), result, memory_order_release);                    \
+                                                                                                   \
+        return result;                                                                             \
+    }
+
+#endif /* CMC_WSDEQUE_H */
@@ -0,0 +1,64 @@
+/**
+ * counters.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * Operation counters kept by every dev collection
+ *
+ * Each collection has its own counters that are incremented as it works and
+ * returned by PFX##_counters. They are plain increments, cheap enough to be
+ * left on in a staging build, and are meant to measure the algorithmic cost
+ * of a workload, like how many comparisons or probes it took, to be compared
+ * with the time the same workload takes with the collections of src/cmc.
+ *
+ * Counters are never reset by clear, only by PFX##_counters_reset.
+ */
+
+#ifndef CMC_DEV_COUNTERS_H
+#define CMC_DEV_COUNTERS_H
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+
+struct cmc_dev_counters
+{
+    /* Calls to the comparison function */
+    uint64_t comparisons;
+    /* Calls to the hash function */
+    uint64_t hashes;
+    /* Slots of a hashtable looked at */
+    uint64_t probes;
+    /* Rotations done to balance a tree */
+    uint64_t rotations;
+    /* Times that a buffer was grown or shrunk */
+    uint64_t resizes;
+    /* Calls to malloc, calloc and realloc */
+    uint64_t allocations;
+    /* Bytes of elements moved around within or between buffers */
+    uint64_t copied_bytes;
+};
+
+static const struct cmc_dev_counters cmc_dev_counters_empty = { 0 };
+
+/* Writes every counter divided by the amount of operations, if it is not 0 */
+static inline void cmc_dev_counters_print(FILE *file, struct cmc_dev_counters counters,
+                                          uint64_t operations)
+{
+    double ops = operations ? (double)operations : 1.0;
+
+    fprintf(file,
+            "comparisons/op %.2f hashes/op %.2f probes/op %.2f rotations/op %.2f "
+            "resizes %" PRIu64 " allocations %" PRIu64 " copied bytes/op %.2f\n",
+            (double)counters.comparisons / ops, (double)counters.hashes / ops,
+            (double)counters.probes / ops, (double)counters.rotations / ops,
+            counters.resizes, counters.allocations, (double)counters.copied_bytes / ops);
+}
+
+#endif /* CMC_DEV_COUNTERS_H */
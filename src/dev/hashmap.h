@@ -0,0 +1,459 @@
+/**
+ * hashmap.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * HashMap
+ *
+ * Development version of the HashMap of src/cmc, with the same robin-hood
+ * open addressing over a prime sized buffer. Removals shift the entries that
+ * follow back instead of leaving deleted entries behind. It logs what each
+ * function does and keeps the operation counters of counters.h. Its include
+ * guard is not the one of src/cmc/hashmap.h so both can be used by the same
+ * program.
+ */
+
+#ifndef CMC_DEV_HASHMAP_H
+#define CMC_DEV_HASHMAP_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include "../utl/log.h"
+#include "../cmc/hashmap.h"
+#include "counters.h"
+
+#define HASHMAP_GENERATE(PFX, SNAME, FMOD, K, V)    \
+    HASHMAP_GENERATE_HEADER(PFX, SNAME, FMOD, K, V) \
+    HASHMAP_GENERATE_SOURCE(PFX, SNAME, FMOD, K, V)
+
+#define HASHMAP_WRAPGEN_HEADER(PFX, SNAME, FMOD, K, V) \
+    HASHMAP_GENERATE_HEADER(PFX, SNAME, FMOD, K, V)
+
+#define HASHMAP_WRAPGEN_SOURCE(PFX, SNAME, FMOD, K, V) \
+    HASHMAP_GENERATE_SOURCE(PFX, SNAME, FMOD, K, V)
+
+/* HEADER ********************************************************************/
+#define HASHMAP_GENERATE_HEADER(PFX, SNAME, FMOD, K, V)                                           \
+                                                                                                  \
+    /* HashMap Entry */                                                                           \
+    typedef struct SNAME##_entry_s                                                                \
+    {                                                                                             \
+        /* Entry Key */                                                                           \
+        K key;                                                                                    \
+                                                                                                  \
+        /* Entry Value */                                                                         \
+        V value;                                                                                  \
+                                                                                                  \
+        /* Distance of the entry to the position given by its hash */                             \
+        size_t dist;                                                                              \
+                                                                                                  \
+        /* If the entry holds a key */                                                            \
+        bool filled;                                                                              \
+                                                                                                  \
+    } SNAME##_entry, *SNAME##_entry_ptr;                                                          \
+                                                                                                  \
+    /* HashMap Structure */                                                                       \
+    typedef struct SNAME##_s                                                                      \
+    {                                                                                             \
+        /* Array of entries */                                                                    \
+        SNAME##_entry *buffer;                                                                    \
+                                                                                                  \
+        /* Current array capacity */                                                              \
+        size_t capacity;                                                                          \
+                                                                                                  \
+        /* Current amount of keys */                                                              \
+        size_t count;                                                                             \
+                                                                                                  \
+        /* Load factor in range (0.0, 1.0) */                                                     \
+        double load;                                                                              \
+                                                                                                  \
+        /* Key comparison function */                                                             \
+        int (*cmp)(K, K);                                                                         \
+                                                                                                  \
+        /* Key hash function */                                                                   \
+        size_t (*hash)(K);                                                                        \
+                                                                                                  \
+        /* Operation counters */                                                                  \
+        struct cmc_dev_counters counters;                                                         \
+                                                                                                  \
+    } SNAME, *SNAME##_ptr;                                                                        \
+                                                                                                  \
+    /* Collection Functions */                                                                    \
+    /* Collection Allocation and Deallocation */                                                  \
+    FMOD SNAME *PFX##_new(size_t capacity, double load, int (*compare)(K, K), size_t (*hash)(K)); \
+    FMOD void PFX##_clear(SNAME *_map_);                                                          \
+    FMOD void PFX##_free(SNAME *_map_);                                                           \
+    /* Collection Input and Output */                                                             \
+    FMOD bool PFX##_insert(SNAME *_map_, K key, V value);                                         \
+    FMOD bool PFX##_update(SNAME *_map_, K key, V new_value, V *old_value);                       \
+    FMOD bool PFX##_remove(SNAME *_map_, K key, V *out_value);                                    \
+    /* Element Access */                                                                          \
+    FMOD V PFX##_get(SNAME *_map_, K key);                                                        \
+    FMOD V *PFX##_get_ref(SNAME *_map_, K key);                                                   \
+    /* Collection State */                                                                        \
+    FMOD bool PFX##_contains(SNAME *_map_, K key);                                                \
+    FMOD bool PFX##_empty(SNAME *_map_);                                                          \
+    FMOD size_t PFX##_count(SNAME *_map_);                                                        \
+    FMOD size_t PFX##_capacity(SNAME *_map_);                                                     \
+    /* Operation Counters */                                                                      \
+    FMOD struct cmc_dev_counters PFX##_counters(SNAME *_map_);                                    \
+    FMOD void PFX##_counters_reset(SNAME *_map_);                                                 \
+                                                                                                  \
+    /* Default Value */                                                                           \
+    static inline V PFX##_impl_default_value(void)                                                \
+    {                                                                                             \
+        V _empty_value_;                                                                          \
+                                                                                                  \
+        memset(&_empty_value_, 0, sizeof(V));                                                     \
+                                                                                                  \
+        return _empty_value_;                                                                     \
+    }                                                                                             \
+                                                                                                  \
+/* SOURCE ********************************************************************/
+#define HASHMAP_GENERATE_SOURCE(PFX, SNAME, FMOD, K, V)                                                        \
+                                                                                                               \
+    /* Implementation Detail Functions */                                                                      \
+    static SNAME##_entry *PFX##_impl_get_entry(SNAME *_map_, K key);                                           \
+    static void PFX##_impl_place(SNAME *_map_, SNAME##_entry *buffer, size_t capacity, K key, V value);        \
+    static bool PFX##_impl_grow(SNAME *_map_);                                                                 \
+                                                                                                               \
+    FMOD SNAME *PFX##_new(size_t capacity, double load, int (*compare)(K, K), size_t (*hash)(K))               \
+    {                                                                                                          \
+        if (capacity < 1 || load <= 0 || load >= 1)                                                            \
+        {                                                                                                      \
+            cmc_log_warn("Invalid capacity %" PRIuMAX " or load %lf for %s given", capacity, load, "HashMap"); \
+            return NULL;                                                                                       \
+        }                                                                                                      \
+                                                                                                               \
+        if (compare == NULL || hash == NULL)                                                                   \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "compare or hash");                            \
+                                                                                                               \
+        SNAME *_map_ = malloc(sizeof(SNAME));                                                                  \
+                                                                                                               \
+        if (!_map_)                                                                                            \
+        {                                                                                                      \
+            cmc_log_info("%s allocation failed", "HashMap");                                                   \
+            return NULL;                                                                                       \
+        }                                                                                                      \
+                                                                                                               \
+        size_t real_capacity = cmc_hashtable_prime_size((size_t)((double)capacity / load) + 1);                \
+                                                                                                               \
+        _map_->buffer = calloc(real_capacity, sizeof(SNAME##_entry));                                          \
+                                                                                                               \
+        if (!_map_->buffer)                                                                                    \
+        {                                                                                                      \
+            cmc_log_info("%s allocation failed", "HashMap buffer");                                            \
+            free(_map_);                                                                                       \
+            return NULL;                                                                                       \
+        }                                                                                                      \
+                                                                                                               \
+        _map_->capacity = real_capacity;                                                                       \
+        _map_->count = 0;                                                                                      \
+        _map_->load = load;                                                                                    \
+        _map_->cmp = compare;                                                                                  \
+        _map_->hash = hash;                                                                                    \
+                                                                                                               \
+        _map_->counters = cmc_dev_counters_empty;                                                              \
+        _map_->counters.allocations = 2;                                                                       \
+                                                                                                               \
+        cmc_log_info("HashMap at %p successfully allocated", _map_);                                           \
+                                                                                                               \
+        return _map_;                                                                                          \
+    }                                                                                                          \
+                                                                                                               \
+    FMOD void PFX##_clear(SNAME *_map_)                                                                        \
+    {                                                                                                          \
+        if (_map_ == NULL)                                                                                     \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_map_");                                      \
+                                                                                                               \
+        memset(_map_->buffer, 0, sizeof(SNAME##_entry) * _map_->capacity);                                     \
+                                                                                                               \
+        _map_->count = 0;                                                                                      \
+                                                                                                               \
+        cmc_log_trace("HashMap at %p cleared", _map_);                                                         \
+    }                                                                                                          \
+                                                                                                               \
+    FMOD void PFX##_free(SNAME *_map_)                                                                         \
+    {                                                                                                          \
+        if (_map_ == NULL)                                                                                     \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_map_");                                      \
+                                                                                                               \
+        free(_map_->buffer);                                                                                   \
+                                                                                                               \
+        uintptr_t address = (uintptr_t)(void *)_map_;                                                          \
+                                                                                                               \
+        free(_map_);                                                                                           \
+                                                                                                               \
+        cmc_log_info("HashMap at %" PRIxPTR " successfully deallocated", address);                             \
+    }                                                                                                          \
+                                                                                                               \
+    FMOD bool PFX##_insert(SNAME *_map_, K key, V value)                                                       \
+    {                                                                                                          \
+        if (_map_ == NULL)                                                                                     \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_map_");                                      \
+                                                                                                               \
+        if (PFX##_impl_get_entry(_map_, key) != NULL)                                                          \
+        {                                                                                                      \
+            cmc_log_debug("Key already present in HashMap at %p", _map_);                                      \
+            return false;                                                                                      \
+        }                                                                                                      \
+                                                                                                               \
+        if ((double)(_map_->count + 1) > (double)_map_->capacity * _map_->load)                                \
+        {                                                                                                      \
+            if (!PFX##_impl_grow(_map_))                                                                       \
+            {                                                                                                  \
+                cmc_log_info("HashMap at %p failed to be reallocated", _map_);                                 \
+                return false;                                                                                  \
+            }                                                                                                  \
+        }                                                                                                      \
+                                                                                                               \
+        PFX##_impl_place(_map_, _map_->buffer, _map_->capacity, key, value);                                   \
+                                                                                                               \
+        _map_->count++;                                                                                        \
+                                                                                                               \
+        cmc_log_trace("Key added to HashMap at %p", _map_);                                                    \
+                                                                                                               \
+        return true;                                                                                           \
+    }                                                                                                          \
+                                                                                                               \
+    FMOD bool PFX##_update(SNAME *_map_, K key, V new_value, V *old_value)                                     \
+    {                                                                                                          \
+        if (_map_ == NULL)                                                                                     \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_map_");                                      \
+                                                                                                               \
+        SNAME##_entry *entry = PFX##_impl_get_entry(_map_, key);                                               \
+                                                                                                               \
+        if (!entry)                                                                                            \
+        {                                                                                                      \
+            cmc_log_debug("Key not found in HashMap at %p", _map_);                                            \
+            return false;                                                                                      \
+        }                                                                                                      \
+                                                                                                               \
+        if (old_value)                                                                                         \
+            *old_value = entry->value;                                                                         \
+                                                                                                               \
+        entry->value = new_value;                                                                              \
+                                                                                                               \
+        return true;                                                                                           \
+    }                                                                                                          \
+                                                                                                               \
+    FMOD bool PFX##_remove(SNAME *_map_, K key, V *out_value)                                                  \
+    {                                                                                                          \
+        if (_map_ == NULL)                                                                                     \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_map_");                                      \
+                                                                                                               \
+        SNAME##_entry *entry = PFX##_impl_get_entry(_map_, key);                                               \
+                                                                                                               \
+        if (!entry)                                                                                            \
+        {                                                                                                      \
+            cmc_log_debug("Key not found in HashMap at %p", _map_);                                            \
+            return false;                                                                                      \
+        }                                                                                                      \
+                                                                                                               \
+        if (out_value)                                                                                         \
+            *out_value = entry->value;                                                                         \
+                                                                                                               \
+        size_t pos = (size_t)(entry - _map_->buffer);                                                          \
+        size_t next = (pos + 1) % _map_->capacity;                                                             \
+                                                                                                               \
+        /* Entries after it move back one slot until one is at its position */                                 \
+        while (_map_->buffer[next].filled && _map_->buffer[next].dist > 0)                                     \
+        {                                                                                                      \
+            _map_->counters.probes++;                                                                          \
+            _map_->counters.copied_bytes += sizeof(SNAME##_entry);                                             \
+                                                                                                               \
+            _map_->buffer[pos] = _map_->buffer[next];                                                          \
+            _map_->buffer[pos].dist--;                                                                         \
+                                                                                                               \
+            pos = next;                                                                                        \
+            next = (next + 1) % _map_->capacity;                                                               \
+        }                                                                                                      \
+                                                                                                               \
+        memset(&(_map_->buffer[pos]), 0, sizeof(SNAME##_entry));                                               \
+                                                                                                               \
+        _map_->count--;                                                                                        \
+                                                                                                               \
+        cmc_log_trace("Key removed from HashMap at %p", _map_);                                                \
+                                                                                                               \
+        return true;                                                                                           \
+    }                                                                                                          \
+                                                                                                               \
+    FMOD V PFX##_get(SNAME *_map_, K key)                                                                      \
+    {                                                                                                          \
+        V *value = PFX##_get_ref(_map_, key);                                                                  \
+                                                                                                               \
+        if (!value)                                                                                            \
+            return PFX##_impl_default_value();                                                                 \
+                                                                                                               \
+        return *value;                                                                                         \
+    }                                                                                                          \
+                                                                                                               \
+    FMOD V *PFX##_get_ref(SNAME *_map_, K key)                                                                 \
+    {                                                                                                          \
+        if (_map_ == NULL)                                                                                     \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_map_");                                      \
+                                                                                                               \
+        SNAME##_entry *entry = PFX##_impl_get_entry(_map_, key);                                               \
+                                                                                                               \
+        if (!entry)                                                                                            \
+        {                                                                                                      \
+            cmc_log_debug("Key not found in HashMap at %p", _map_);                                            \
+            return NULL;                                                                                       \
+        }                                                                                                      \
+                                                                                                               \
+        return &(entry->value);                                                                                \
+    }                                                                                                          \
+                                                                                                               \
+    FMOD bool PFX##_contains(SNAME *_map_, K key)                                                              \
+    {                                                                                                          \
+        if (_map_ == NULL)                                                                                     \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_map_");                                      \
+                                                                                                               \
+        return PFX##_impl_get_entry(_map_, key) != NULL;                                                       \
+    }                                                                                                          \
+                                                                                                               \
+    FMOD bool PFX##_empty(SNAME *_map_)                                                                        \
+    {                                                                                                          \
+        if (_map_ == NULL)                                                                                     \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_map_");                                      \
+                                                                                                               \
+        return _map_->count == 0;                                                                              \
+    }                                                                                                          \
+                                                                                                               \
+    FMOD size_t PFX##_count(SNAME *_map_)                                                                      \
+    {                                                                                                          \
+        if (_map_ == NULL)                                                                                     \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_map_");                                      \
+                                                                                                               \
+        return _map_->count;                                                                                   \
+    }                                                                                                          \
+                                                                                                               \
+    FMOD size_t PFX##_capacity(SNAME *_map_)                                                                   \
+    {                                                                                                          \
+        if (_map_ == NULL)                                                                                     \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_map_");                                      \
+                                                                                                               \
+        return _map_->capacity;                                                                                \
+    }                                                                                                          \
+                                                                                                               \
+    FMOD struct cmc_dev_counters PFX##_counters(SNAME *_map_)                                                  \
+    {                                                                                                          \
+        if (_map_ == NULL)                                                                                     \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_map_");                                      \
+                                                                                                               \
+        return _map_->counters;                                                                                \
+    }                                                                                                          \
+                                                                                                               \
+    FMOD void PFX##_counters_reset(SNAME *_map_)                                                               \
+    {                                                                                                          \
+        if (_map_ == NULL)                                                                                     \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_map_");                                      \
+                                                                                                               \
+        _map_->counters = cmc_dev_counters_empty;                                                              \
+    }                                                                                                          \
+                                                                                                               \
+    /* The search stops at an empty entry or at one that is closer to its */                                   \
+    /* own position than the key would be, since it would have taken it */                                     \
+    static SNAME##_entry *PFX##_impl_get_entry(SNAME *_map_, K key)                                            \
+    {                                                                                                          \
+        _map_->counters.hashes++;                                                                              \
+                                                                                                               \
+        size_t pos = _map_->hash(key) % _map_->capacity;                                                       \
+                                                                                                               \
+        for (size_t dist = 0;; dist++)                                                                         \
+        {                                                                                                      \
+            SNAME##_entry *entry = &(_map_->buffer[pos]);                                                      \
+                                                                                                               \
+            _map_->counters.probes++;                                                                          \
+                                                                                                               \
+            if (!entry->filled || entry->dist < dist)                                                          \
+                return NULL;                                                                                   \
+                                                                                                               \
+            _map_->counters.comparisons++;                                                                     \
+                                                                                                               \
+            if (_map_->cmp(entry->key, key) == 0)                                                              \
+                return entry;                                                                                  \
+                                                                                                               \
+            pos = (pos + 1) % _map_->capacity;                                                                 \
+        }                                                                                                      \
+    }                                                                                                          \
+                                                                                                               \
+    /* Robin-hood insertion of a key that is not in the buffer */                                              \
+    static void PFX##_impl_place(SNAME *_map_, SNAME##_entry *buffer, size_t capacity, K key, V value)         \
+    {                                                                                                          \
+        _map_->counters.hashes++;                                                                              \
+                                                                                                               \
+        SNAME##_entry current = { key, value, 0, true };                                                       \
+        size_t pos = _map_->hash(key) % capacity;                                                              \
+                                                                                                               \
+        for (;;)                                                                                               \
+        {                                                                                                      \
+            SNAME##_entry *entry = &(buffer[pos]);                                                             \
+                                                                                                               \
+            _map_->counters.probes++;                                                                          \
+                                                                                                               \
+            if (!entry->filled)                                                                                \
+            {                                                                                                  \
+                *entry = current;                                                                              \
+                return;                                                                                        \
+            }                                                                                                  \
+                                                                                                               \
+            /* Takes the place of an entry that is closer to its position */                                   \
+            if (entry->dist < current.dist)                                                                    \
+            {                                                                                                  \
+                SNAME##_entry swap = *entry;                                                                   \
+                *entry = current;                                                                              \
+                current = swap;                                                                                \
+                                                                                                               \
+                _map_->counters.copied_bytes += sizeof(SNAME##_entry);                                         \
+            }                                                                                                  \
+                                                                                                               \
+            pos = (pos + 1) % capacity;                                                                        \
+            current.dist++;                                                                                    \
+        }                                                                                                      \
+    }                                                                                                          \
+                                                                                                               \
+    static bool PFX##_impl_grow(SNAME *_map_)                                                                  \
+    {                                                                                                          \
+        size_t new_capacity = cmc_hashtable_prime_size(_map_->capacity * 2);                                   \
+                                                                                                               \
+        SNAME##_entry *new_buffer = calloc(new_capacity, sizeof(SNAME##_entry));                               \
+                                                                                                               \
+        if (!new_buffer)                                                                                       \
+        {                                                                                                      \
+            cmc_log_info("%s reallocation failed", "HashMap buffer");                                          \
+            return false;                                                                                      \
+        }                                                                                                      \
+                                                                                                               \
+        _map_->counters.resizes++;                                                                             \
+        _map_->counters.allocations++;                                                                         \
+        _map_->counters.copied_bytes += sizeof(SNAME##_entry) * _map_->count;                                  \
+                                                                                                               \
+        for (size_t i = 0; i < _map_->capacity; i++)                                                           \
+        {                                                                                                      \
+            SNAME##_entry *entry = &(_map_->buffer[i]);                                                        \
+                                                                                                               \
+            if (entry->filled)                                                                                 \
+                PFX##_impl_place(_map_, new_buffer, new_capacity, entry->key, entry->value);                   \
+        }                                                                                                      \
+                                                                                                               \
+        free(_map_->buffer);                                                                                   \
+                                                                                                               \
+        _map_->buffer = new_buffer;                                                                            \
+        _map_->capacity = new_capacity;                                                                        \
+                                                                                                               \
+        cmc_log_trace("HashMap at %p grew to %" PRIuMAX "", _map_, new_capacity);                              \
+                                                                                                               \
+        return true;                                                                                           \
+    }
+
+#endif /* CMC_DEV_HASHMAP_H */
@@ -0,0 +1,392 @@
+/**
+ * list.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * List
+ *
+ * Development version of the List of src/cmc, a dynamic array. It logs what
+ * each function does and keeps the operation counters of counters.h. Its
+ * include guard is not the one of src/cmc/list.h so both can be used by the
+ * same program.
+ */
+
+#ifndef CMC_DEV_LIST_H
+#define CMC_DEV_LIST_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include "../utl/log.h"
+#include "counters.h"
+
+#define LIST_GENERATE(PFX, SNAME, FMOD, V)    \
+    LIST_GENERATE_HEADER(PFX, SNAME, FMOD, V) \
+    LIST_GENERATE_SOURCE(PFX, SNAME, FMOD, V)
+
+#define LIST_WRAPGEN_HEADER(PFX, SNAME, FMOD, K, V) \
+    LIST_GENERATE_HEADER(PFX, SNAME, FMOD, V)
+
+#define LIST_WRAPGEN_SOURCE(PFX, SNAME, FMOD, K, V) \
+    LIST_GENERATE_SOURCE(PFX, SNAME, FMOD, V)
+
+/* HEADER ********************************************************************/
+#define LIST_GENERATE_HEADER(PFX, SNAME, FMOD, V)                                                   \
+                                                                                                    \
+    /* List Structure */                                                                            \
+    typedef struct SNAME##_s                                                                        \
+    {                                                                                               \
+        /* Dynamic array of elements */                                                             \
+        V *buffer;                                                                                  \
+                                                                                                    \
+        /* Current array capacity */                                                                \
+        size_t capacity;                                                                            \
+                                                                                                    \
+        /* Current amount of elements */                                                            \
+        size_t count;                                                                               \
+                                                                                                    \
+        /* Operation counters */                                                                    \
+        struct cmc_dev_counters counters;                                                           \
+                                                                                                    \
+    } SNAME, *SNAME##_ptr;                                                                          \
+                                                                                                    \
+    /* Collection Functions */                                                                      \
+    /* Collection Allocation and Deallocation */                                                    \
+    FMOD SNAME *PFX##_new(size_t capacity);                                                         \
+    FMOD void PFX##_clear(SNAME *_list_);                                                           \
+    FMOD void PFX##_free(SNAME *_list_);                                                            \
+    /* Collection Input and Output */                                                               \
+    FMOD bool PFX##_push_front(SNAME *_list_, V element);                                           \
+    FMOD bool PFX##_push_at(SNAME *_list_, V element, size_t index);                                \
+    FMOD bool PFX##_push_back(SNAME *_list_, V element);                                            \
+    FMOD bool PFX##_pop_front(SNAME *_list_);                                                       \
+    FMOD bool PFX##_pop_at(SNAME *_list_, size_t index);                                            \
+    FMOD bool PFX##_pop_back(SNAME *_list_);                                                        \
+    /* Element Access */                                                                            \
+    FMOD V PFX##_front(SNAME *_list_);                                                              \
+    FMOD V PFX##_back(SNAME *_list_);                                                               \
+    FMOD V PFX##_get(SNAME *_list_, size_t index);                                                  \
+    FMOD size_t PFX##_index_of(SNAME *_list_, V element, int (*comparator)(V, V), bool from_start); \
+    /* Collection State */                                                                          \
+    FMOD bool PFX##_contains(SNAME *_list_, V element, int (*comparator)(V, V));                    \
+    FMOD bool PFX##_empty(SNAME *_list_);                                                           \
+    FMOD bool PFX##_full(SNAME *_list_);                                                            \
+    FMOD size_t PFX##_count(SNAME *_list_);                                                         \
+    FMOD size_t PFX##_capacity(SNAME *_list_);                                                      \
+    /* Operation Counters */                                                                        \
+    FMOD struct cmc_dev_counters PFX##_counters(SNAME *_list_);                                     \
+    FMOD void PFX##_counters_reset(SNAME *_list_);                                                  \
+                                                                                                    \
+    /* Default Value */                                                                             \
+    static inline V PFX##_impl_default_value(void)                                                  \
+    {                                                                                               \
+        V _empty_value_;                                                                            \
+                                                                                                    \
+        memset(&_empty_value_, 0, sizeof(V));                                                       \
+                                                                                                    \
+        return _empty_value_;                                                                       \
+    }                                                                                               \
+                                                                                                    \
+/* SOURCE ********************************************************************/
+#define LIST_GENERATE_SOURCE(PFX, SNAME, FMOD, V)                                                                 \
+                                                                                                                  \
+    /* Implementation Detail Functions */                                                                         \
+    static bool PFX##_impl_grow(SNAME *_list_);                                                                   \
+                                                                                                                  \
+    FMOD SNAME *PFX##_new(size_t capacity)                                                                        \
+    {                                                                                                             \
+        if (capacity < 1)                                                                                         \
+        {                                                                                                         \
+            cmc_log_warn("Invalid capacity for %s given: %" PRIuMAX "", "List", capacity);                        \
+            return NULL;                                                                                          \
+        }                                                                                                         \
+                                                                                                                  \
+        SNAME *_list_ = malloc(sizeof(SNAME));                                                                    \
+                                                                                                                  \
+        if (!_list_)                                                                                              \
+        {                                                                                                         \
+            cmc_log_info("%s allocation failed", "List");                                                         \
+            return NULL;                                                                                          \
+        }                                                                                                         \
+                                                                                                                  \
+        _list_->buffer = calloc(capacity, sizeof(V));                                                             \
+                                                                                                                  \
+        if (!_list_->buffer)                                                                                      \
+        {                                                                                                         \
+            cmc_log_info("%s allocation failed", "List buffer");                                                  \
+            free(_list_);                                                                                         \
+            return NULL;                                                                                          \
+        }                                                                                                         \
+                                                                                                                  \
+        _list_->capacity = capacity;                                                                              \
+        _list_->count = 0;                                                                                        \
+                                                                                                                  \
+        _list_->counters = cmc_dev_counters_empty;                                                                \
+        _list_->counters.allocations = 2;                                                                         \
+                                                                                                                  \
+        cmc_log_info("List at %p successfully allocated", _list_);                                                \
+                                                                                                                  \
+        return _list_;                                                                                            \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD void PFX##_clear(SNAME *_list_)                                                                          \
+    {                                                                                                             \
+        if (_list_ == NULL)                                                                                       \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_list_");                                        \
+                                                                                                                  \
+        memset(_list_->buffer, 0, sizeof(V) * _list_->capacity);                                                  \
+                                                                                                                  \
+        _list_->count = 0;                                                                                        \
+                                                                                                                  \
+        cmc_log_trace("List at %p cleared", _list_);                                                              \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD void PFX##_free(SNAME *_list_)                                                                           \
+    {                                                                                                             \
+        if (_list_ == NULL)                                                                                       \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_list_");                                        \
+                                                                                                                  \
+        free(_list_->buffer);                                                                                     \
+                                                                                                                  \
+        uintptr_t address = (uintptr_t)(void *)_list_;                                                            \
+                                                                                                                  \
+        free(_list_);                                                                                             \
+                                                                                                                  \
+        cmc_log_info("List at %" PRIxPTR " successfully deallocated", address);                                   \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD bool PFX##_push_front(SNAME *_list_, V element)                                                          \
+    {                                                                                                             \
+        return PFX##_push_at(_list_, element, 0);                                                                 \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD bool PFX##_push_at(SNAME *_list_, V element, size_t index)                                               \
+    {                                                                                                             \
+        if (_list_ == NULL)                                                                                       \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_list_");                                        \
+                                                                                                                  \
+        if (index > _list_->count)                                                                                \
+        {                                                                                                         \
+            cmc_log_warn("Index %" PRIuMAX " out of range for List at %p", index, _list_);                        \
+            return false;                                                                                         \
+        }                                                                                                         \
+                                                                                                                  \
+        if (PFX##_full(_list_))                                                                                   \
+        {                                                                                                         \
+            if (!PFX##_impl_grow(_list_))                                                                         \
+            {                                                                                                     \
+                cmc_log_info("List at %p failed to be reallocated", _list_);                                      \
+                return false;                                                                                     \
+            }                                                                                                     \
+        }                                                                                                         \
+                                                                                                                  \
+        size_t moved = sizeof(V) * (_list_->count - index);                                                       \
+                                                                                                                  \
+        memmove(_list_->buffer + index + 1, _list_->buffer + index, moved);                                       \
+                                                                                                                  \
+        _list_->counters.copied_bytes += moved;                                                                   \
+                                                                                                                  \
+        _list_->buffer[index] = element;                                                                          \
+                                                                                                                  \
+        _list_->count++;                                                                                          \
+                                                                                                                  \
+        cmc_log_trace("Element added at %" PRIuMAX " to List at %p", index, _list_);                              \
+                                                                                                                  \
+        return true;                                                                                              \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD bool PFX##_push_back(SNAME *_list_, V element)                                                           \
+    {                                                                                                             \
+        return PFX##_push_at(_list_, element, PFX##_count(_list_));                                               \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD bool PFX##_pop_front(SNAME *_list_)                                                                      \
+    {                                                                                                             \
+        return PFX##_pop_at(_list_, 0);                                                                           \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD bool PFX##_pop_at(SNAME *_list_, size_t index)                                                           \
+    {                                                                                                             \
+        if (_list_ == NULL)                                                                                       \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_list_");                                        \
+                                                                                                                  \
+        if (index >= _list_->count)                                                                               \
+        {                                                                                                         \
+            cmc_log_debug("Attempt of removing at %" PRIuMAX " from List at %p with %" PRIuMAX " elements",       \
+                          index, _list_, _list_->count);                                                          \
+            return false;                                                                                         \
+        }                                                                                                         \
+                                                                                                                  \
+        size_t moved = sizeof(V) * (_list_->count - index - 1);                                                   \
+                                                                                                                  \
+        memmove(_list_->buffer + index, _list_->buffer + index + 1, moved);                                       \
+                                                                                                                  \
+        _list_->counters.copied_bytes += moved;                                                                   \
+                                                                                                                  \
+        _list_->buffer[--_list_->count] = PFX##_impl_default_value();                                             \
+                                                                                                                  \
+        cmc_log_trace("Element removed from %" PRIuMAX " to List at %p", index, _list_);                          \
+                                                                                                                  \
+        return true;                                                                                              \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD bool PFX##_pop_back(SNAME *_list_)                                                                       \
+    {                                                                                                             \
+        if (_list_ == NULL)                                                                                       \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_list_");                                        \
+                                                                                                                  \
+        if (PFX##_empty(_list_))                                                                                  \
+        {                                                                                                         \
+            cmc_log_debug("Attempt of removing an element from empty List at %p", _list_);                        \
+            return false;                                                                                         \
+        }                                                                                                         \
+                                                                                                                  \
+        return PFX##_pop_at(_list_, _list_->count - 1);                                                           \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD V PFX##_front(SNAME *_list_)                                                                             \
+    {                                                                                                             \
+        return PFX##_get(_list_, 0);                                                                              \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD V PFX##_back(SNAME *_list_)                                                                              \
+    {                                                                                                             \
+        if (_list_ == NULL)                                                                                       \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_list_");                                        \
+                                                                                                                  \
+        if (PFX##_empty(_list_))                                                                                  \
+        {                                                                                                         \
+            cmc_log_debug("Attempt to access element from empty List at %p", _list_);                             \
+            return PFX##_impl_default_value();                                                                    \
+        }                                                                                                         \
+                                                                                                                  \
+        return PFX##_get(_list_, _list_->count - 1);                                                              \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD V PFX##_get(SNAME *_list_, size_t index)                                                                 \
+    {                                                                                                             \
+        if (_list_ == NULL)                                                                                       \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_list_");                                        \
+                                                                                                                  \
+        if (index >= _list_->count)                                                                               \
+        {                                                                                                         \
+            cmc_log_debug("Attempt to access element at %" PRIuMAX " from List at %p with %" PRIuMAX " elements", \
+                          index, _list_, _list_->count);                                                          \
+            return PFX##_impl_default_value();                                                                    \
+        }                                                                                                         \
+                                                                                                                  \
+        cmc_log_trace("Element access at %" PRIuMAX "", index);                                                   \
+                                                                                                                  \
+        return _list_->buffer[index];                                                                             \
+    }                                                                                                             \
+                                                                                                                  \
+    /* Returns the count of the list if the element was not found */                                              \
+    FMOD size_t PFX##_index_of(SNAME *_list_, V element, int (*comparator)(V, V), bool from_start)                \
+    {                                                                                                             \
+        if (_list_ == NULL)                                                                                       \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_list_");                                        \
+                                                                                                                  \
+        if (comparator == NULL)                                                                                   \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "comparator");                                    \
+                                                                                                                  \
+        for (size_t i = 0; i < _list_->count; i++)                                                                \
+        {                                                                                                         \
+            size_t index = from_start ? i : _list_->count - 1 - i;                                                \
+                                                                                                                  \
+            _list_->counters.comparisons++;                                                                       \
+                                                                                                                  \
+            if (comparator(_list_->buffer[index], element) == 0)                                                  \
+                return index;                                                                                     \
+        }                                                                                                         \
+                                                                                                                  \
+        return _list_->count;                                                                                     \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD bool PFX##_contains(SNAME *_list_, V element, int (*comparator)(V, V))                                   \
+    {                                                                                                             \
+        return PFX##_index_of(_list_, element, comparator, true) != PFX##_count(_list_);                          \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD bool PFX##_empty(SNAME *_list_)                                                                          \
+    {                                                                                                             \
+        if (_list_ == NULL)                                                                                       \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_list_");                                        \
+                                                                                                                  \
+        return _list_->count == 0;                                                                                \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD bool PFX##_full(SNAME *_list_)                                                                           \
+    {                                                                                                             \
+        if (_list_ == NULL)                                                                                       \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_list_");                                        \
+                                                                                                                  \
+        return _list_->count >= _list_->capacity;                                                                 \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD size_t PFX##_count(SNAME *_list_)                                                                        \
+    {                                                                                                             \
+        if (_list_ == NULL)                                                                                       \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_list_");                                        \
+                                                                                                                  \
+        return _list_->count;                                                                                     \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD size_t PFX##_capacity(SNAME *_list_)                                                                     \
+    {                                                                                                             \
+        if (_list_ == NULL)                                                                                       \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_list_");                                        \
+                                                                                                                  \
+        return _list_->capacity;                                                                                  \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD struct cmc_dev_counters PFX##_counters(SNAME *_list_)                                                    \
+    {                                                                                                             \
+        if (_list_ == NULL)                                                                                       \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_list_");                                        \
+                                                                                                                  \
+        return _list_->counters;                                                                                  \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD void PFX##_counters_reset(SNAME *_list_)                                                                 \
+    {                                                                                                             \
+        if (_list_ == NULL)                                                                                       \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_list_");                                        \
+                                                                                                                  \
+        _list_->counters = cmc_dev_counters_empty;                                                                \
+    }                                                                                                             \
+                                                                                                                  \
+    /* Doubles the capacity, realloc copies the elements when it has to move */                                   \
+    /* the buffer, which is counted as if it always did */                                                        \
+    static bool PFX##_impl_grow(SNAME *_list_)                                                                    \
+    {                                                                                                             \
+        size_t new_capacity = _list_->capacity * 2;                                                               \
+                                                                                                                  \
+        V *new_buffer = realloc(_list_->buffer, sizeof(V) * new_capacity);                                        \
+                                                                                                                  \
+        if (!new_buffer)                                                                                          \
+        {                                                                                                         \
+            cmc_log_info("%s reallocation failed", "List buffer");                                                \
+            return false;                                                                                         \
+        }                                                                                                         \
+                                                                                                                  \
+        memset(new_buffer + _list_->capacity, 0, sizeof(V) * (new_capacity - _list_->capacity));                  \
+                                                                                                                  \
+        _list_->counters.resizes++;                                                                               \
+        _list_->counters.allocations++;                                                                           \
+        _list_->counters.copied_bytes += sizeof(V) * _list_->count;                                               \
+                                                                                                                  \
+        _list_->buffer = new_buffer;                                                                              \
+        _list_->capacity = new_capacity;                                                                          \
+                                                                                                                  \
+        return true;                                                                                              \
+    }
+
+#endif /* CMC_DEV_LIST_H */
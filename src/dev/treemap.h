@@ -0,0 +1,493 @@
+/**
+ * treemap.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * TreeMap
+ *
+ * Development version of the TreeMap of src/cmc, an AVL tree of keys and
+ * values. Insertions and removals are done recursively, returning the new
+ * root of each subtree, so nodes have no parent pointer. It logs what each
+ * function does and keeps the operation counters of counters.h. Its include
+ * guard is not the one of src/cmc/treemap.h so both can be used by the same
+ * program.
+ */
+
+#ifndef CMC_DEV_TREEMAP_H
+#define CMC_DEV_TREEMAP_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include "../utl/log.h"
+#include "counters.h"
+
+#define TREEMAP_GENERATE(PFX, SNAME, FMOD, K, V)    \
+    TREEMAP_GENERATE_HEADER(PFX, SNAME, FMOD, K, V) \
+    TREEMAP_GENERATE_SOURCE(PFX, SNAME, FMOD, K, V)
+
+#define TREEMAP_WRAPGEN_HEADER(PFX, SNAME, FMOD, K, V) \
+    TREEMAP_GENERATE_HEADER(PFX, SNAME, FMOD, K, V)
+
+#define TREEMAP_WRAPGEN_SOURCE(PFX, SNAME, FMOD, K, V) \
+    TREEMAP_GENERATE_SOURCE(PFX, SNAME, FMOD, K, V)
+
+/* HEADER ********************************************************************/
+#define TREEMAP_GENERATE_HEADER(PFX, SNAME, FMOD, K, V)                     \
+                                                                            \
+    /* TreeMap Node */                                                      \
+    typedef struct SNAME##_node_s                                           \
+    {                                                                       \
+        /* Node Key */                                                      \
+        K key;                                                              \
+                                                                            \
+        /* Node Value */                                                    \
+        V value;                                                            \
+                                                                            \
+        /* Height of the subtree rooted at this node */                     \
+        unsigned char height;                                               \
+                                                                            \
+        /* Left child node */                                               \
+        struct SNAME##_node_s *left;                                        \
+                                                                            \
+        /* Right child node */                                              \
+        struct SNAME##_node_s *right;                                       \
+                                                                            \
+    } SNAME##_node, *SNAME##_node_ptr;                                      \
+                                                                            \
+    /* TreeMap Structure */                                                 \
+    typedef struct SNAME##_s                                                \
+    {                                                                       \
+        /* Root node */                                                     \
+        SNAME##_node *root;                                                 \
+                                                                            \
+        /* Current amount of keys */                                        \
+        size_t count;                                                       \
+                                                                            \
+        /* Key comparison function */                                       \
+        int (*cmp)(K, K);                                                   \
+                                                                            \
+        /* Operation counters */                                            \
+        struct cmc_dev_counters counters;                                   \
+                                                                            \
+    } SNAME, *SNAME##_ptr;                                                  \
+                                                                            \
+    /* Collection Functions */                                              \
+    /* Collection Allocation and Deallocation */                            \
+    FMOD SNAME *PFX##_new(int (*compare)(K, K));                            \
+    FMOD void PFX##_clear(SNAME *_map_);                                    \
+    FMOD void PFX##_free(SNAME *_map_);                                     \
+    /* Collection Input and Output */                                       \
+    FMOD bool PFX##_insert(SNAME *_map_, K key, V value);                   \
+    FMOD bool PFX##_update(SNAME *_map_, K key, V new_value, V *old_value); \
+    FMOD bool PFX##_remove(SNAME *_map_, K key, V *out_value);              \
+    /* Element Access */                                                    \
+    FMOD V PFX##_get(SNAME *_map_, K key);                                  \
+    FMOD V *PFX##_get_ref(SNAME *_map_, K key);                             \
+    /* Collection State */                                                  \
+    FMOD bool PFX##_contains(SNAME *_map_, K key);                          \
+    FMOD bool PFX##_empty(SNAME *_map_);                                    \
+    FMOD size_t PFX##_count(SNAME *_map_);                                  \
+    /* Operation Counters */                                                \
+    FMOD struct cmc_dev_counters PFX##_counters(SNAME *_map_);              \
+    FMOD void PFX##_counters_reset(SNAME *_map_);                           \
+                                                                            \
+    /* Default Value */                                                     \
+    static inline V PFX##_impl_default_value(void)                          \
+    {                                                                       \
+        V _empty_value_;                                                    \
+                                                                            \
+        memset(&_empty_value_, 0, sizeof(V));                               \
+                                                                            \
+        return _empty_value_;                                               \
+    }                                                                       \
+                                                                            \
+/* SOURCE ********************************************************************/
+#define TREEMAP_GENERATE_SOURCE(PFX, SNAME, FMOD, K, V)                                                           \
+                                                                                                                  \
+    /* Implementation Detail Functions */                                                                         \
+    static SNAME##_node *PFX##_impl_get_node(SNAME *_map_, K key);                                                \
+    static void PFX##_impl_free_nodes(SNAME##_node *node);                                                        \
+    static unsigned char PFX##_impl_height(SNAME##_node *node);                                                   \
+    static void PFX##_impl_update_height(SNAME##_node *node);                                                     \
+    static SNAME##_node *PFX##_impl_rotate_right(SNAME *_map_, SNAME##_node *node);                               \
+    static SNAME##_node *PFX##_impl_rotate_left(SNAME *_map_, SNAME##_node *node);                                \
+    static SNAME##_node *PFX##_impl_rebalance(SNAME *_map_, SNAME##_node *node);                                  \
+    static SNAME##_node *PFX##_impl_insert(SNAME *_map_, SNAME##_node *node, SNAME##_node *new_node);             \
+    static SNAME##_node *PFX##_impl_remove(SNAME *_map_, SNAME##_node *node, K key, V *out_value, bool *removed); \
+    static SNAME##_node *PFX##_impl_remove_min(SNAME *_map_, SNAME##_node *node, SNAME##_node **min);             \
+                                                                                                                  \
+    FMOD SNAME *PFX##_new(int (*compare)(K, K))                                                                   \
+    {                                                                                                             \
+        if (compare == NULL)                                                                                      \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "compare");                                       \
+                                                                                                                  \
+        SNAME *_map_ = malloc(sizeof(SNAME));                                                                     \
+                                                                                                                  \
+        if (!_map_)                                                                                               \
+        {                                                                                                         \
+            cmc_log_info("%s allocation failed", "TreeMap");                                                      \
+            return NULL;                                                                                          \
+        }                                                                                                         \
+                                                                                                                  \
+        _map_->root = NULL;                                                                                       \
+        _map_->count = 0;                                                                                         \
+        _map_->cmp = compare;                                                                                     \
+                                                                                                                  \
+        _map_->counters = cmc_dev_counters_empty;                                                                 \
+        _map_->counters.allocations = 1;                                                                          \
+                                                                                                                  \
+        cmc_log_info("TreeMap at %p successfully allocated", _map_);                                              \
+                                                                                                                  \
+        return _map_;                                                                                             \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD void PFX##_clear(SNAME *_map_)                                                                           \
+    {                                                                                                             \
+        if (_map_ == NULL)                                                                                        \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_map_");                                         \
+                                                                                                                  \
+        PFX##_impl_free_nodes(_map_->root);                                                                       \
+                                                                                                                  \
+        _map_->root = NULL;                                                                                       \
+        _map_->count = 0;                                                                                         \
+                                                                                                                  \
+        cmc_log_trace("TreeMap at %p cleared", _map_);                                                            \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD void PFX##_free(SNAME *_map_)                                                                            \
+    {                                                                                                             \
+        if (_map_ == NULL)                                                                                        \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_map_");                                         \
+                                                                                                                  \
+        PFX##_impl_free_nodes(_map_->root);                                                                       \
+                                                                                                                  \
+        uintptr_t address = (uintptr_t)(void *)_map_;                                                             \
+                                                                                                                  \
+        free(_map_);                                                                                              \
+                                                                                                                  \
+        cmc_log_info("TreeMap at %" PRIxPTR " successfully deallocated", address);                                \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD bool PFX##_insert(SNAME *_map_, K key, V value)                                                          \
+    {                                                                                                             \
+        if (_map_ == NULL)                                                                                        \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_map_");                                         \
+                                                                                                                  \
+        if (PFX##_impl_get_node(_map_, key) != NULL)                                                              \
+        {                                                                                                         \
+            cmc_log_debug("Key already present in TreeMap at %p", _map_);                                         \
+            return false;                                                                                         \
+        }                                                                                                         \
+                                                                                                                  \
+        SNAME##_node *node = malloc(sizeof(SNAME##_node));                                                        \
+                                                                                                                  \
+        if (!node)                                                                                                \
+        {                                                                                                         \
+            cmc_log_info("%s allocation failed", "TreeMap node");                                                 \
+            return false;                                                                                         \
+        }                                                                                                         \
+                                                                                                                  \
+        _map_->counters.allocations++;                                                                            \
+                                                                                                                  \
+        node->key = key;                                                                                          \
+        node->value = value;                                                                                      \
+        node->height = 1;                                                                                         \
+        node->left = NULL;                                                                                        \
+        node->right = NULL;                                                                                       \
+                                                                                                                  \
+        _map_->root = PFX##_impl_insert(_map_, _map_->root, node);                                                \
+        _map_->count++;                                                                                           \
+                                                                                                                  \
+        cmc_log_trace("Key added to TreeMap at %p", _map_);                                                       \
+                                                                                                                  \
+        return true;                                                                                              \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD bool PFX##_update(SNAME *_map_, K key, V new_value, V *old_value)                                        \
+    {                                                                                                             \
+        if (_map_ == NULL)                                                                                        \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_map_");                                         \
+                                                                                                                  \
+        SNAME##_node *node = PFX##_impl_get_node(_map_, key);                                                     \
+                                                                                                                  \
+        if (!node)                                                                                                \
+        {                                                                                                         \
+            cmc_log_debug("Key not found in TreeMap at %p", _map_);                                               \
+            return false;                                                                                         \
+        }                                                                                                         \
+                                                                                                                  \
+        if (old_value)                                                                                            \
+            *old_value = node->value;                                                                             \
+                                                                                                                  \
+        node->value = new_value;                                                                                  \
+                                                                                                                  \
+        return true;                                                                                              \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD bool PFX##_remove(SNAME *_map_, K key, V *out_value)                                                     \
+    {                                                                                                             \
+        if (_map_ == NULL)                                                                                        \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_map_");                                         \
+                                                                                                                  \
+        bool removed = false;                                                                                     \
+                                                                                                                  \
+        _map_->root = PFX##_impl_remove(_map_, _map_->root, key, out_value, &removed);                            \
+                                                                                                                  \
+        if (!removed)                                                                                             \
+        {                                                                                                         \
+            cmc_log_debug("Key not found in TreeMap at %p", _map_);                                               \
+            return false;                                                                                         \
+        }                                                                                                         \
+                                                                                                                  \
+        _map_->count--;                                                                                           \
+                                                                                                                  \
+        cmc_log_trace("Key removed from TreeMap at %p", _map_);                                                   \
+                                                                                                                  \
+        return true;                                                                                              \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD V PFX##_get(SNAME *_map_, K key)                                                                         \
+    {                                                                                                             \
+        V *value = PFX##_get_ref(_map_, key);                                                                     \
+                                                                                                                  \
+        if (!value)                                                                                               \
+            return PFX##_impl_default_value();                                                                    \
+                                                                                                                  \
+        return *value;                                                                                            \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD V *PFX##_get_ref(SNAME *_map_, K key)                                                                    \
+    {                                                                                                             \
+        if (_map_ == NULL)                                                                                        \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_map_");                                         \
+                                                                                                                  \
+        SNAME##_node *node = PFX##_impl_get_node(_map_, key);                                                     \
+                                                                                                                  \
+        if (!node)                                                                                                \
+        {                                                                                                         \
+            cmc_log_debug("Key not found in TreeMap at %p", _map_);                                               \
+            return NULL;                                                                                          \
+        }                                                                                                         \
+                                                                                                                  \
+        return &(node->value);                                                                                    \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD bool PFX##_contains(SNAME *_map_, K key)                                                                 \
+    {                                                                                                             \
+        if (_map_ == NULL)                                                                                        \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_map_");                                         \
+                                                                                                                  \
+        return PFX##_impl_get_node(_map_, key) != NULL;                                                           \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD bool PFX##_empty(SNAME *_map_)                                                                           \
+    {                                                                                                             \
+        if (_map_ == NULL)                                                                                        \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_map_");                                         \
+                                                                                                                  \
+        return _map_->count == 0;                                                                                 \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD size_t PFX##_count(SNAME *_map_)                                                                         \
+    {                                                                                                             \
+        if (_map_ == NULL)                                                                                        \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_map_");                                         \
+                                                                                                                  \
+        return _map_->count;                                                                                      \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD struct cmc_dev_counters PFX##_counters(SNAME *_map_)                                                     \
+    {                                                                                                             \
+        if (_map_ == NULL)                                                                                        \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_map_");                                         \
+                                                                                                                  \
+        return _map_->counters;                                                                                   \
+    }                                                                                                             \
+                                                                                                                  \
+    FMOD void PFX##_counters_reset(SNAME *_map_)                                                                  \
+    {                                                                                                             \
+        if (_map_ == NULL)                                                                                        \
+            cmc_log_fatal("Invalid null pointer parameter: %s", "_map_");                                         \
+                                                                                                                  \
+        _map_->counters = cmc_dev_counters_empty;                                                                 \
+    }                                                                                                             \
+                                                                                                                  \
+    static SNAME##_node *PFX##_impl_get_node(SNAME *_map_, K key)                                                 \
+    {                                                                                                             \
+        SNAME##_node *node = _map_->root;                                                                         \
+                                                                                                                  \
+        while (node != NULL)                                                                                      \
+        {                                                                                                         \
+            _map_->counters.comparisons++;                                                                        \
+                                                                                                                  \
+            int c = _map_->cmp(key, node->key);                                                                   \
+                                                                                                                  \
+            if (c == 0)                                                                                           \
+                return node;                                                                                      \
+                                                                                                                  \
+            node = c < 0 ? node->left : node->right;                                                              \
+        }                                                                                                         \
+                                                                                                                  \
+        return NULL;                                                                                              \
+    }                                                                                                             \
+                                                                                                                  \
+    static void PFX##_impl_free_nodes(SNAME##_node *node)                                                         \
+    {                                                                                                             \
+        if (node == NULL)                                                                                         \
+            return;                                                                                               \
+                                                                                                                  \
+        PFX##_impl_free_nodes(node->left);                                                                        \
+        PFX##_impl_free_nodes(node->right);                                                                       \
+                                                                                                                  \
+        free(node);                                                                                               \
+    }                                                                                                             \
+                                                                                                                  \
+    static unsigned char PFX##_impl_height(SNAME##_node *node)                                                    \
+    {                                                                                                             \
+        return node == NULL ? 0 : node->height;                                                                   \
+    }                                                                                                             \
+                                                                                                                  \
+    static void PFX##_impl_update_height(SNAME##_node *node)                                                      \
+    {                                                                                                             \
+        unsigned char left = PFX##_impl_height(node->left);                                                       \
+        unsigned char right = PFX##_impl_height(node->right);                                                     \
+                                                                                                                  \
+        node->height = (unsigned char)((left > right ? left : right) + 1);                                        \
+    }                                                                                                             \
+                                                                                                                  \
+    static SNAME##_node *PFX##_impl_rotate_right(SNAME *_map_, SNAME##_node *node)                                \
+    {                                                                                                             \
+        SNAME##_node *root = node->left;                                                                          \
+                                                                                                                  \
+        node->left = root->right;                                                                                 \
+        root->right = node;                                                                                       \
+                                                                                                                  \
+        PFX##_impl_update_height(node);                                                                           \
+        PFX##_impl_update_height(root);                                                                           \
+                                                                                                                  \
+        _map_->counters.rotations++;                                                                              \
+                                                                                                                  \
+        return root;                                                                                              \
+    }                                                                                                             \
+                                                                                                                  \
+    static SNAME##_node *PFX##_impl_rotate_left(SNAME *_map_, SNAME##_node *node)                                 \
+    {                                                                                                             \
+        SNAME##_node *root = node->right;                                                                         \
+                                                                                                                  \
+        node->right = root->left;                                                                                 \
+        root->left = node;                                                                                        \
+                                                                                                                  \
+        PFX##_impl_update_height(node);                                                                           \
+        PFX##_impl_update_height(root);                                                                           \
+                                                                                                                  \
+        _map_->counters.rotations++;                                                                              \
+                                                                                                                  \
+        return root;                                                                                              \
+    }                                                                                                             \
+                                                                                                                  \
+    /* Returns the new root of a subtree whose children differ by at most 2 */                                    \
+    static SNAME##_node *PFX##_impl_rebalance(SNAME *_map_, SNAME##_node *node)                                   \
+    {                                                                                                             \
+        PFX##_impl_update_height(node);                                                                           \
+                                                                                                                  \
+        int balance = PFX##_impl_height(node->left) - PFX##_impl_height(node->right);                             \
+                                                                                                                  \
+        if (balance > 1)                                                                                          \
+        {                                                                                                         \
+            if (PFX##_impl_height(node->left->left) < PFX##_impl_height(node->left->right))                       \
+                node->left = PFX##_impl_rotate_left(_map_, node->left);                                           \
+                                                                                                                  \
+            return PFX##_impl_rotate_right(_map_, node);                                                          \
+        }                                                                                                         \
+        else if (balance < -1)                                                                                    \
+        {                                                                                                         \
+            if (PFX##_impl_height(node->right->right) < PFX##_impl_height(node->right->left))                     \
+                node->right = PFX##_impl_rotate_right(_map_, node->right);                                        \
+                                                                                                                  \
+            return PFX##_impl_rotate_left(_map_, node);                                                           \
+        }                                                                                                         \
+                                                                                                                  \
+        return node;                                                                                              \
+    }                                                                                                             \
+                                                                                                                  \
+    /* The key of new_node is known not to be in the tree */                                                      \
+    static SNAME##_node *PFX##_impl_insert(SNAME *_map_, SNAME##_node *node, SNAME##_node *new_node)              \
+    {                                                                                                             \
+        if (node == NULL)                                                                                         \
+            return new_node;                                                                                      \
+                                                                                                                  \
+        _map_->counters.comparisons++;                                                                            \
+                                                                                                                  \
+        if (_map_->cmp(new_node->key, node->key) < 0)                                                             \
+            node->left = PFX##_impl_insert(_map_, node->left, new_node);                                          \
+        else                                                                                                      \
+            node->right = PFX##_impl_insert(_map_, node->right, new_node);                                        \
+                                                                                                                  \
+        return PFX##_impl_rebalance(_map_, node);                                                                 \
+    }                                                                                                             \
+                                                                                                                  \
+    static SNAME##_node *PFX##_impl_remove(SNAME *_map_, SNAME##_node *node, K key, V *out_value, bool *removed)  \
+    {                                                                                                             \
+        if (node == NULL)                                                                                         \
+            return NULL;                                                                                          \
+                                                                                                                  \
+        _map_->counters.comparisons++;                                                                            \
+                                                                                                                  \
+        int c = _map_->cmp(key, node->key);                                                                       \
+                                                                                                                  \
+        if (c < 0)                                                                                                \
+            node->left = PFX##_impl_remove(_map_, node->left, key, out_value, removed);                           \
+        else if (c > 0)                                                                                           \
+            node->right = PFX##_impl_remove(_map_, node->right, key, out_value, removed);                         \
+        else                                                                                                      \
+        {                                                                                                         \
+            SNAME##_node *left = node->left;                                                                      \
+            SNAME##_node *right = node->right;                                                                    \
+                                                                                                                  \
+            if (out_value)                                                                                        \
+                *out_value = node->value;                                                                         \
+                                                                                                                  \
+            free(node);                                                                                           \
+                                                                                                                  \
+            *removed = true;                                                                                      \
+                                                                                                                  \
+            if (right == NULL)                                                                                    \
+                return left;                                                                                      \
+                                                                                                                  \
+            /* The smallest node of the right subtree takes its place */                                          \
+            SNAME##_node *min;                                                                                    \
+                                                                                                                  \
+            right = PFX##_impl_remove_min(_map_, right, &min);                                                    \
+                                                                                                                  \
+            min->left = left;                                                                                     \
+            min->right = right;                                                                                   \
+                                                                                                                  \
+            return PFX##_impl_rebalance(_map_, min);                                                              \
+        }                                                                                                         \
+                                                                                                                  \
+        return PFX##_impl_rebalance(_map_, node);                                                                 \
+    }                                                                                                             \
+                                                                                                                  \
+    static SNAME##_node *PFX##_impl_remove_min(SNAME *_map_, SNAME##_node *node, SNAME##_node **min)              \
+    {                                                                                                             \
+        if (node->left == NULL)                                                                                   \
+        {                                                                                                         \
+            *min = node;                                                                                          \
+            return node->right;                                                                                   \
+        }                                                                                                         \
+                                                                                                                  \
+        node->left = PFX##_impl_remove_min(_map_, node->left, min);                                               \
+                                                                                                                  \
+        return PFX##_impl_rebalance(_map_, node);                                                                 \
+    }
+
+#endif /* CMC_DEV_TREEMAP_H */
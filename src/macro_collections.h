@@ -27,28 +27,120 @@
 #define CMC_COLLECTION_GENERATE_SOURCE(C, PFX, SNAME, K, V) \
     CMC_CONCATC(C)(PFX, SNAME, K, V)
 
+/**
+ * Generating each collection once
+ *
+ * CMC_COLLECTION_GENERATE defines every function of a collection, so it can
+ * only be used in one translation unit and every unit that generates the
+ * same collection compiles it again. Instead, a header of the program can
+ * list its collections with CMC_COLLECTION_INSTANTIATE and be included by
+ * every unit. It only declares the collections, like
+ * CMC_COLLECTION_GENERATE_HEADER, except in the one unit that defines
+ * CMC_INSTANTIATE before it first includes this file, where the functions
+ * are defined like with CMC_COLLECTION_GENERATE.
+ *
+ *     // containers.h
+ *     #include "macro_collections.h"
+ *     CMC_COLLECTION_INSTANTIATE(LIST, il, int_list, , int)
+ *
+ *     // containers.c
+ *     #define CMC_INSTANTIATE
+ *     #include "containers.h"
+ *
+ * Each collection is then compiled once and its code is in the final binary
+ * once, so both the build and the instruction cache footprint do not grow
+ * with the amount of units that use it. The functions are not inlined into
+ * the other units unless link time optimization is used.
+ * benchmarks/compile_time has a benchmark of the cost of each collection.
+ */
+#ifdef CMC_INSTANTIATE
+#define CMC_COLLECTION_INSTANTIATE(C, PFX, SNAME, K, V) \
+    CMC_COLLECTION_GENERATE(C, PFX, SNAME, K, V)
+#else
+#define CMC_COLLECTION_INSTANTIATE(C, PFX, SNAME, K, V) \
+    CMC_COLLECTION_GENERATE_HEADER(C, PFX, SNAME, K, V)
+#endif
+
 #include "cmc/bidimap.h"      /* Added in 26/09/2019 */
+#include "cmc/bitset.h"       /* Added in 15/10/2026 */
+#include "cmc/bloomfilter.h"  /* Added in 14/10/2026 */
+#include "cmc/btreemap.h"     /* Added in 14/10/2026 */
+#include "cmc/btreeset.h"     /* Added in 14/10/2026 */
+#include "cmc/compacttreeset.h" /* Added in 14/10/2026 */
+#include "cmc/concurrenthashmap.h" /* Added in 14/10/2026 */
+#include "cmc/cuckooset.h" /* Added in 15/10/2026 */
+#include "cmc/multiqueue.h" /* Added in 15/10/2026 */
 #include "cmc/deque.h"        /* Added in 20/03/2019 */
+#include "cmc/frozenhashmap.h" /* Added in 14/10/2026 */
+#include "cmc/groupedmultimap.h" /* Added in 14/10/2026 */
 #include "cmc/hashmap.h"      /* Added in 03/04/2019 */
 #include "cmc/hashset.h"      /* Added in 01/04/2019 */
 #include "cmc/heap.h"         /* Added in 25/03/2019 */
+#include "cmc/hyperloglog.h"  /* Added in 14/10/2026 */
 #include "cmc/intervalheap.h" /* Added in 06/07/2019 */
 #include "cmc/linkedlist.h"   /* Added in 22/03/2019 */
 #include "cmc/list.h"         /* Added in 12/02/2019 */
+#include "cmc/lrucache.h"     /* Added in 14/10/2026 */
+#include "cmc/mappedhashmap.h" /* Added in 14/10/2026 */
+#include "cmc/mappedsortedmap.h" /* Added in 15/10/2026 */
 #include "cmc/multimap.h"     /* Added in 26/04/2019 */
 #include "cmc/multiset.h"     /* Added in 10/04/2019 */
+#include "cmc/orderedhashmap.h" /* Added in 14/10/2026 */
+#include "cmc/persistenttreemap.h" /* Added in 14/10/2026 */
 #include "cmc/queue.h"        /* Added in 15/02/2019 */
+#include "cmc/skiplistmap.h"    /* Added in 14/10/2026 */
+#include "cmc/snapshothashmap.h" /* Added in 14/10/2026 */
+#include "cmc/smalllist.h" /* Added in 15/10/2026 */
+#include "cmc/sparseset.h" /* Added in 15/10/2026 */
+#include "cmc/flatmap.h" /* Added in 15/10/2026 */
+#include "cmc/topk.h" /* Added in 15/10/2026 */
+#include "cmc/countminsketch.h" /* Added in 15/10/2026 */
+#include "cmc/intervaltree.h" /* Added in 15/10/2026 */
+#include "cmc/sortedmultimap.h" /* Added in 15/10/2026 */
 #include "cmc/sortedlist.h"   /* Added in 17/09/2019 */
+#include "cmc/sortedwindow.h" /* Added in 14/10/2026 */
+#include "cmc/gaplist.h" /* Added in 14/10/2026 */
+#include "cmc/blockdeque.h" /* Added in 14/10/2026 */
+#include "cmc/mpmcqueue.h" /* Added in 14/10/2026 */
+#include "cmc/wsdeque.h" /* Added in 14/10/2026 */
+#include "cmc/blockingqueue.h" /* Added in 14/10/2026 */
+#include "cmc/bytering.h" /* Added in 14/10/2026 */
+#include "cmc/concurrentstack.h" /* Added in 14/10/2026 */
+#include "cmc/unrolledlist.h" /* Added in 14/10/2026 */
+#include "cmc/intrusivelist.h" /* Added in 14/10/2026 */
+#include "cmc/indexedheap.h" /* Added in 14/10/2026 */
+#include "cmc/radixheap.h" /* Added in 14/10/2026 */
+#include "cmc/radixtreemap.h" /* Added in 15/10/2026 */
+#include "cmc/ringbuffer.h" /* Added in 15/10/2026 */
+#include "cmc/roaring.h"      /* Added in 15/10/2026 */
+#include "cmc/timerwheel.h" /* Added in 14/10/2026 */
+#include "cmc/minmaxheap.h" /* Added in 14/10/2026 */
 #include "cmc/stack.h"        /* Added in 14/02/2019 */
+#include "cmc/swissmap.h"     /* Added in 14/10/2026 */
 #include "cmc/treemap.h"      /* Added in 28/03/2019 */
 #include "cmc/treeset.h"      /* Added in 27/03/2019 */
 
+#include "sac/deque.h"
+#include "sac/hashmap.h"
+#include "sac/hashset.h"
+#include "sac/heap.h"
+#include "sac/intervalheap.h"
+#include "sac/list.h"
 #include "sac/queue.h"
+#include "sac/sortedlist.h"
 #include "sac/stack.h"
+#include "sac/treemap.h"
+#include "sac/treeset.h"
 
+#include "utl/arena.h"        /* Added in 14/10/2026 */
 #include "utl/assert.h"       /* Added in 27/06/2019 */
 #include "utl/foreach.h"      /* Added in 25/02/2019 */
+#include "utl/hash.h"         /* Added in 14/10/2026 */
 #include "utl/log.h"          /* Added in 21/06/2109 */
+#include "utl/pages.h"        /* Added in 14/10/2026 */
+#include "utl/pool.h"         /* Added in 14/10/2026 */
+#include "utl/replica.h"      /* Added in 15/10/2026 */
+#include "utl/sync.h"         /* Added in 15/10/2026 */
 #include "utl/test.h"         /* Added in 26/06/2019 */
 #include "utl/timer.h"        /* Added in 12/04/2019 */
 
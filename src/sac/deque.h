@@ -0,0 +1,415 @@
+/**
+ * deque.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * A Purely Stack Allocated Deque
+ *
+ * A circular buffer of fixed size inside the struct, so it can be used where
+ * there is no malloc at all. Elements are pushed and popped at both ends in
+ * constant time, like in the Deque.
+ *
+ * Generating a collection with too big of a storage can be dangerous and might
+ * quickly cause a stack overflow.
+ *
+ * It is recommended to not generate any Stack Allocated Collection with less
+ * than 1000 internal storage.
+ */
+
+#ifndef CMC_SAC_DEQUE_H
+#define CMC_SAC_DEQUE_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define SAC_DEQUE_GENERATE(PFX, SNAME, FMOD, V, SIZE)    \
+    SAC_DEQUE_GENERATE_HEADER(PFX, SNAME, FMOD, V, SIZE) \
+    SAC_DEQUE_GENERATE_SOURCE(PFX, SNAME, FMOD, V, SIZE)
+
+#define SAC_DEQUE_WRAPGEN_HEADER(PFX, SNAME, FMOD, K, V, SIZE) \
+    SAC_DEQUE_GENERATE_HEADER(PFX, SNAME, FMOD, V, SIZE)
+
+#define SAC_DEQUE_WRAPGEN_SOURCE(PFX, SNAME, FMOD, K, V, SIZE) \
+    SAC_DEQUE_GENERATE_SOURCE(PFX, SNAME, FMOD, V, SIZE)
+
+/* HEADER ********************************************************************/
+#define SAC_DEQUE_GENERATE_HEADER(PFX, SNAME, FMOD, V, SIZE)                      \
+                                                                                  \
+    /* Deque Structure */                                                         \
+    typedef struct SNAME##_s                                                      \
+    {                                                                             \
+        /* Internal Storage */                                                    \
+        V buffer[SIZE];                                                           \
+                                                                                  \
+        /* Current amount of elements */                                          \
+        size_t count;                                                             \
+                                                                                  \
+        /* Index representing the front of the deque */                           \
+        size_t front;                                                             \
+                                                                                  \
+        /* Index representing the back of the deque */                            \
+        size_t back;                                                              \
+                                                                                  \
+        /* Function that returns an iterator to the start of the deque */         \
+        struct SNAME##_iter_s (*it_start)(struct SNAME##_s *);                    \
+                                                                                  \
+        /* Function that returns an iterator to the end of the deque */           \
+        struct SNAME##_iter_s (*it_end)(struct SNAME##_s *);                      \
+                                                                                  \
+    } SNAME, *SNAME##_ptr;                                                        \
+                                                                                  \
+    /* Deque Iterator */                                                          \
+    typedef struct SNAME##_iter_s                                                 \
+    {                                                                             \
+        /* Target deque */                                                        \
+        struct SNAME##_s *target;                                                 \
+                                                                                  \
+        /* Cursor's position (index) */                                           \
+        size_t cursor;                                                            \
+                                                                                  \
+        /* Keeps track of relative index to the iteration of elements */          \
+        size_t index;                                                             \
+                                                                                  \
+        /* If the iterator has reached the start of the iteration */              \
+        bool start;                                                               \
+                                                                                  \
+        /* If the iterator has reached the end of the iteration */                \
+        bool end;                                                                 \
+                                                                                  \
+    } SNAME##_iter, *SNAME##_iter_ptr;                                            \
+                                                                                  \
+    /* Collection Functions */                                                    \
+    /* Collection Allocation and Deallocation */                                  \
+    FMOD SNAME PFX##_new(void);                                                   \
+    FMOD void PFX##_clear(SNAME *_deque_);                                        \
+    /* Collection Input and Output */                                             \
+    FMOD bool PFX##_push_front(SNAME *_deque_, V element);                        \
+    FMOD bool PFX##_push_back(SNAME *_deque_, V element);                         \
+    FMOD bool PFX##_pop_front(SNAME *_deque_);                                    \
+    FMOD bool PFX##_pop_back(SNAME *_deque_);                                     \
+    /* Element Access */                                                          \
+    FMOD V PFX##_front(SNAME *_deque_);                                           \
+    FMOD V PFX##_back(SNAME *_deque_);                                            \
+    FMOD V PFX##_get(SNAME *_deque_, size_t index);                               \
+    FMOD V *PFX##_get_ref(SNAME *_deque_, size_t index);                          \
+    /* Collection State */                                                        \
+    FMOD bool PFX##_contains(SNAME *_deque_, V element, int (*comparator)(V, V)); \
+    FMOD bool PFX##_empty(SNAME *_deque_);                                        \
+    FMOD bool PFX##_full(SNAME *_deque_);                                         \
+    FMOD size_t PFX##_count(SNAME *_deque_);                                      \
+    FMOD size_t PFX##_capacity(void);                                             \
+                                                                                  \
+    /* Iterator Functions */                                                      \
+    /* Iterator Initialization */                                                 \
+    FMOD void PFX##_iter_init(SNAME##_iter *iter, SNAME *target);                 \
+    /* Iterator State */                                                          \
+    FMOD bool PFX##_iter_start(SNAME##_iter *iter);                               \
+    FMOD bool PFX##_iter_end(SNAME##_iter *iter);                                 \
+    /* Iterator Movement */                                                       \
+    FMOD void PFX##_iter_to_start(SNAME##_iter *iter);                            \
+    FMOD void PFX##_iter_to_end(SNAME##_iter *iter);                              \
+    FMOD bool PFX##_iter_next(SNAME##_iter *iter);                                \
+    FMOD bool PFX##_iter_prev(SNAME##_iter *iter);                                \
+    /* Iterator Access */                                                         \
+    FMOD V PFX##_iter_value(SNAME##_iter *iter);                                  \
+    FMOD V *PFX##_iter_rvalue(SNAME##_iter *iter);                                \
+    FMOD size_t PFX##_iter_index(SNAME##_iter *iter);                             \
+                                                                                  \
+    /* Default Value */                                                           \
+    static inline V PFX##_impl_default_value(void)                                \
+    {                                                                             \
+        V _empty_value_;                                                          \
+                                                                                  \
+        memset(&_empty_value_, 0, sizeof(V));                                     \
+                                                                                  \
+        return _empty_value_;                                                     \
+    }
+
+/* SOURCE ********************************************************************/
+#define SAC_DEQUE_GENERATE_SOURCE(PFX, SNAME, FMOD, V, SIZE)                                    \
+                                                                                                \
+    /* Implementation Detail Functions */                                                       \
+    static inline size_t PFX##_impl_next(size_t index);                                         \
+    static inline size_t PFX##_impl_prev(size_t index);                                         \
+    static SNAME##_iter PFX##_impl_it_start(SNAME *_deque_);                                    \
+    static SNAME##_iter PFX##_impl_it_end(SNAME *_deque_);                                      \
+                                                                                                \
+    FMOD SNAME PFX##_new(void)                                                                  \
+    {                                                                                           \
+        SNAME result;                                                                           \
+                                                                                                \
+        memset(&result, 0, sizeof(SNAME));                                                      \
+                                                                                                \
+        result.it_start = PFX##_impl_it_start;                                                  \
+        result.it_end = PFX##_impl_it_end;                                                      \
+                                                                                                \
+        return result;                                                                          \
+    }                                                                                           \
+                                                                                                \
+    FMOD void PFX##_clear(SNAME *_deque_)                                                       \
+    {                                                                                           \
+        memset(_deque_->buffer, 0, sizeof(_deque_->buffer));                                    \
+                                                                                                \
+        _deque_->count = 0;                                                                     \
+        _deque_->front = 0;                                                                     \
+        _deque_->back = 0;                                                                      \
+    }                                                                                           \
+                                                                                                \
+    FMOD bool PFX##_push_front(SNAME *_deque_, V element)                                       \
+    {                                                                                           \
+        if (PFX##_full(_deque_))                                                                \
+            return false;                                                                       \
+                                                                                                \
+        _deque_->front = PFX##_impl_prev(_deque_->front);                                       \
+                                                                                                \
+        _deque_->buffer[_deque_->front] = element;                                              \
+                                                                                                \
+        _deque_->count++;                                                                       \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    FMOD bool PFX##_push_back(SNAME *_deque_, V element)                                        \
+    {                                                                                           \
+        if (PFX##_full(_deque_))                                                                \
+            return false;                                                                       \
+                                                                                                \
+        _deque_->buffer[_deque_->back] = element;                                               \
+                                                                                                \
+        _deque_->back = PFX##_impl_next(_deque_->back);                                         \
+                                                                                                \
+        _deque_->count++;                                                                       \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    FMOD bool PFX##_pop_front(SNAME *_deque_)                                                   \
+    {                                                                                           \
+        if (PFX##_empty(_deque_))                                                               \
+            return false;                                                                       \
+                                                                                                \
+        _deque_->buffer[_deque_->front] = PFX##_impl_default_value();                           \
+                                                                                                \
+        _deque_->front = PFX##_impl_next(_deque_->front);                                       \
+                                                                                                \
+        _deque_->count--;                                                                       \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    FMOD bool PFX##_pop_back(SNAME *_deque_)                                                    \
+    {                                                                                           \
+        if (PFX##_empty(_deque_))                                                               \
+            return false;                                                                       \
+                                                                                                \
+        _deque_->back = PFX##_impl_prev(_deque_->back);                                         \
+                                                                                                \
+        _deque_->buffer[_deque_->back] = PFX##_impl_default_value();                            \
+                                                                                                \
+        _deque_->count--;                                                                       \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    FMOD V PFX##_front(SNAME *_deque_)                                                          \
+    {                                                                                           \
+        if (PFX##_empty(_deque_))                                                               \
+            return PFX##_impl_default_value();                                                  \
+                                                                                                \
+        return _deque_->buffer[_deque_->front];                                                 \
+    }                                                                                           \
+                                                                                                \
+    FMOD V PFX##_back(SNAME *_deque_)                                                           \
+    {                                                                                           \
+        if (PFX##_empty(_deque_))                                                               \
+            return PFX##_impl_default_value();                                                  \
+                                                                                                \
+        return _deque_->buffer[PFX##_impl_prev(_deque_->back)];                                 \
+    }                                                                                           \
+                                                                                                \
+    /* Index relative to the front of the deque */                                              \
+    FMOD V PFX##_get(SNAME *_deque_, size_t index)                                              \
+    {                                                                                           \
+        V *result = PFX##_get_ref(_deque_, index);                                              \
+                                                                                                \
+        if (!result)                                                                            \
+            return PFX##_impl_default_value();                                                  \
+                                                                                                \
+        return *result;                                                                         \
+    }                                                                                           \
+                                                                                                \
+    FMOD V *PFX##_get_ref(SNAME *_deque_, size_t index)                                         \
+    {                                                                                           \
+        if (index >= _deque_->count)                                                            \
+            return NULL;                                                                        \
+                                                                                                \
+        size_t i = _deque_->front + index;                                                      \
+                                                                                                \
+        return &(_deque_->buffer[i >= SIZE ? i - SIZE : i]);                                    \
+    }                                                                                           \
+                                                                                                \
+    FMOD bool PFX##_contains(SNAME *_deque_, V element, int (*comparator)(V, V))                \
+    {                                                                                           \
+        for (size_t i = _deque_->front, j = 0; j < _deque_->count; i = PFX##_impl_next(i), j++) \
+        {                                                                                       \
+            if (comparator(_deque_->buffer[i], element) == 0)                                   \
+                return true;                                                                    \
+        }                                                                                       \
+                                                                                                \
+        return false;                                                                           \
+    }                                                                                           \
+                                                                                                \
+    FMOD bool PFX##_empty(SNAME *_deque_)                                                       \
+    {                                                                                           \
+        return _deque_->count == 0;                                                             \
+    }                                                                                           \
+                                                                                                \
+    FMOD bool PFX##_full(SNAME *_deque_)                                                        \
+    {                                                                                           \
+        return _deque_->count >= SIZE;                                                          \
+    }                                                                                           \
+                                                                                                \
+    FMOD size_t PFX##_count(SNAME *_deque_)                                                     \
+    {                                                                                           \
+        return _deque_->count;                                                                  \
+    }                                                                                           \
+                                                                                                \
+    FMOD size_t PFX##_capacity(void)                                                            \
+    {                                                                                           \
+        return SIZE;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    FMOD void PFX##_iter_init(SNAME##_iter *iter, SNAME *target)                                \
+    {                                                                                           \
+        iter->target = target;                                                                  \
+        iter->cursor = target->front;                                                           \
+        iter->index = 0;                                                                        \
+        iter->start = true;                                                                     \
+        iter->end = PFX##_empty(target);                                                        \
+    }                                                                                           \
+                                                                                                \
+    FMOD bool PFX##_iter_start(SNAME##_iter *iter)                                              \
+    {                                                                                           \
+        return PFX##_empty(iter->target) || iter->start;                                        \
+    }                                                                                           \
+                                                                                                \
+    FMOD bool PFX##_iter_end(SNAME##_iter *iter)                                                \
+    {                                                                                           \
+        return PFX##_empty(iter->target) || iter->end;                                          \
+    }                                                                                           \
+                                                                                                \
+    FMOD void PFX##_iter_to_start(SNAME##_iter *iter)                                           \
+    {                                                                                           \
+        iter->cursor = iter->target->front;                                                     \
+        iter->index = 0;                                                                        \
+        iter->start = true;                                                                     \
+        iter->end = PFX##_empty(iter->target);                                                  \
+    }                                                                                           \
+                                                                                                \
+    FMOD void PFX##_iter_to_end(SNAME##_iter *iter)                                             \
+    {                                                                                           \
+        if (PFX##_empty(iter->target))                                                          \
+            iter->cursor = 0;                                                                   \
+        else                                                                                    \
+            iter->cursor = PFX##_impl_prev(iter->target->back);                                 \
+                                                                                                \
+        iter->index = iter->target->count - 1;                                                  \
+        iter->start = PFX##_empty(iter->target);                                                \
+        iter->end = true;                                                                       \
+    }                                                                                           \
+                                                                                                \
+    FMOD bool PFX##_iter_next(SNAME##_iter *iter)                                               \
+    {                                                                                           \
+        if (iter->end)                                                                          \
+            return false;                                                                       \
+                                                                                                \
+        iter->start = PFX##_empty(iter->target);                                                \
+                                                                                                \
+        if (iter->index == iter->target->count - 1)                                             \
+            iter->end = true;                                                                   \
+        else                                                                                    \
+        {                                                                                       \
+            iter->cursor = PFX##_impl_next(iter->cursor);                                       \
+            iter->index++;                                                                      \
+        }                                                                                       \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    FMOD bool PFX##_iter_prev(SNAME##_iter *iter)                                               \
+    {                                                                                           \
+        if (iter->start)                                                                        \
+            return false;                                                                       \
+                                                                                                \
+        iter->end = PFX##_empty(iter->target);                                                  \
+                                                                                                \
+        if (iter->index == 0)                                                                   \
+            iter->start = true;                                                                 \
+        else                                                                                    \
+        {                                                                                       \
+            iter->cursor = PFX##_impl_prev(iter->cursor);                                       \
+            iter->index--;                                                                      \
+        }                                                                                       \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    FMOD V PFX##_iter_value(SNAME##_iter *iter)                                                 \
+    {                                                                                           \
+        if (PFX##_empty(iter->target))                                                          \
+            return PFX##_impl_default_value();                                                  \
+                                                                                                \
+        return iter->target->buffer[iter->cursor];                                              \
+    }                                                                                           \
+                                                                                                \
+    FMOD V *PFX##_iter_rvalue(SNAME##_iter *iter)                                               \
+    {                                                                                           \
+        if (PFX##_empty(iter->target))                                                          \
+            return NULL;                                                                        \
+                                                                                                \
+        return &(iter->target->buffer[iter->cursor]);                                           \
+    }                                                                                           \
+                                                                                                \
+    FMOD size_t PFX##_iter_index(SNAME##_iter *iter)                                            \
+    {                                                                                           \
+        return iter->index;                                                                     \
+    }                                                                                           \
+                                                                                                \
+    static inline size_t PFX##_impl_next(size_t index)                                          \
+    {                                                                                           \
+        return (index == SIZE - 1) ? 0 : index + 1;                                             \
+    }                                                                                           \
+                                                                                                \
+    static inline size_t PFX##_impl_prev(size_t index)                                          \
+    {                                                                                           \
+        return (index == 0) ? SIZE - 1 : index - 1;                                             \
+    }                                                                                           \
+                                                                                                \
+    static SNAME##_iter PFX##_impl_it_start(SNAME *_deque_)                                     \
+    {                                                                                           \
+        SNAME##_iter iter;                                                                      \
+                                                                                                \
+        PFX##_iter_init(&iter, _deque_);                                                        \
+        PFX##_iter_to_start(&iter);                                                             \
+                                                                                                \
+        return iter;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    static SNAME##_iter PFX##_impl_it_end(SNAME *_deque_)                                       \
+    {                                                                                           \
+        SNAME##_iter iter;                                                                      \
+                                                                                                \
+        PFX##_iter_init(&iter, _deque_);                                                        \
+        PFX##_iter_to_end(&iter);                                                               \
+                                                                                                \
+        return iter;                                                                            \
+    }
+
+#endif /* CMC_SAC_DEQUE_H */
@@ -0,0 +1,517 @@
+/**
+ * hashmap.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * A Purely Stack Allocated HashMap
+ *
+ * This means that the HashMap has a fixed amount of slots, but it also has the
+ * advantage of not requiring for manually allocating and deallocating the
+ * struct. No function calls the allocator so it can be used where malloc is
+ * not available or not allowed.
+ *
+ * Keys are placed in an array of SIZE entries inside the struct with robin
+ * hood hashing and removed with backward shift deletion, like in the HashMap.
+ * The map is full when every entry is taken, but lookups get slower as it
+ * gets close to that, so SIZE should be about twice the amount of keys it is
+ * going to hold.
+ *
+ * Generating a collection with too big of a storage can be dangerous and might
+ * quickly cause a stack overflow.
+ */
+
+#ifndef CMC_SAC_HASHMAP_H
+#define CMC_SAC_HASHMAP_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define SAC_HASHMAP_GENERATE(PFX, SNAME, FMOD, K, V, SIZE)    \
+    SAC_HASHMAP_GENERATE_HEADER(PFX, SNAME, FMOD, K, V, SIZE) \
+    SAC_HASHMAP_GENERATE_SOURCE(PFX, SNAME, FMOD, K, V, SIZE)
+
+#define SAC_HASHMAP_WRAPGEN_HEADER(PFX, SNAME, FMOD, K, V, SIZE) \
+    SAC_HASHMAP_GENERATE_HEADER(PFX, SNAME, FMOD, K, V, SIZE)
+
+#define SAC_HASHMAP_WRAPGEN_SOURCE(PFX, SNAME, FMOD, K, V, SIZE) \
+    SAC_HASHMAP_GENERATE_SOURCE(PFX, SNAME, FMOD, K, V, SIZE)
+
+/* HEADER ********************************************************************/
+#define SAC_HASHMAP_GENERATE_HEADER(PFX, SNAME, FMOD, K, V, SIZE)           \
+                                                                            \
+    /* HashMap Entry */                                                     \
+    typedef struct SNAME##_entry_s                                          \
+    {                                                                       \
+        /* Entry Key */                                                     \
+        K key;                                                              \
+                                                                            \
+        /* Entry Value */                                                   \
+        V value;                                                            \
+                                                                            \
+        /* The distance of this entry to its original position, used by */  \
+        /* robin hood hashing */                                            \
+        size_t dist;                                                        \
+                                                                            \
+        /* If this entry holds a key */                                     \
+        bool filled;                                                        \
+                                                                            \
+    } SNAME##_entry, *SNAME##_entry_ptr;                                    \
+                                                                            \
+    /* HashMap Structure */                                                 \
+    typedef struct SNAME##_s                                                \
+    {                                                                       \
+        /* Internal Storage */                                              \
+        SNAME##_entry buffer[SIZE];                                         \
+                                                                            \
+        /* Current amount of keys */                                        \
+        size_t count;                                                       \
+                                                                            \
+        /* Key comparison function */                                       \
+        int (*cmp)(K, K);                                                   \
+                                                                            \
+        /* Key hash function */                                             \
+        size_t (*hash)(K);                                                  \
+                                                                            \
+        /* Function that returns an iterator to the start of the hashmap */ \
+        struct SNAME##_iter_s (*it_start)(struct SNAME##_s *);              \
+                                                                            \
+        /* Function that returns an iterator to the end of the hashmap */   \
+        struct SNAME##_iter_s (*it_end)(struct SNAME##_s *);                \
+                                                                            \
+    } SNAME, *SNAME##_ptr;                                                  \
+                                                                            \
+    /* HashMap Iterator */                                                  \
+    typedef struct SNAME##_iter_s                                           \
+    {                                                                       \
+        /* Target hashmap */                                                \
+        struct SNAME##_s *target;                                           \
+                                                                            \
+        /* Cursor's position (index) */                                     \
+        size_t cursor;                                                      \
+                                                                            \
+        /* Keeps track of relative index to the iteration of elements */    \
+        size_t index;                                                       \
+                                                                            \
+        /* The index of the first element */                                \
+        size_t first;                                                       \
+                                                                            \
+        /* The index of the last element */                                 \
+        size_t last;                                                        \
+                                                                            \
+        /* If the iterator has reached the start of the iteration */        \
+        bool start;                                                         \
+                                                                            \
+        /* If the iterator has reached the end of the iteration */          \
+        bool end;                                                           \
+                                                                            \
+    } SNAME##_iter, *SNAME##_iter_ptr;                                      \
+                                                                            \
+    /* Collection Functions */                                              \
+    /* Collection Allocation and Deallocation */                            \
+    FMOD SNAME PFX##_new(int (*compare)(K, K), size_t (*hash)(K));          \
+    FMOD void PFX##_clear(SNAME *_map_);                                    \
+    /* Collection Input and Output */                                       \
+    FMOD bool PFX##_insert(SNAME *_map_, K key, V value);                   \
+    FMOD bool PFX##_update(SNAME *_map_, K key, V new_value, V *old_value); \
+    FMOD bool PFX##_remove(SNAME *_map_, K key, V *out_value);              \
+    /* Element Access */                                                    \
+    FMOD V PFX##_get(SNAME *_map_, K key);                                  \
+    FMOD V *PFX##_get_ref(SNAME *_map_, K key);                             \
+    /* Collection State */                                                  \
+    FMOD bool PFX##_contains(SNAME *_map_, K key);                          \
+    FMOD bool PFX##_empty(SNAME *_map_);                                    \
+    FMOD bool PFX##_full(SNAME *_map_);                                     \
+    FMOD size_t PFX##_count(SNAME *_map_);                                  \
+    FMOD size_t PFX##_capacity(void);                                       \
+                                                                            \
+    /* Iterator Functions */                                                \
+    /* Iterator Initialization */                                           \
+    FMOD void PFX##_iter_init(SNAME##_iter *iter, SNAME *target);           \
+    /* Iterator State */                                                    \
+    FMOD bool PFX##_iter_start(SNAME##_iter *iter);                         \
+    FMOD bool PFX##_iter_end(SNAME##_iter *iter);                           \
+    /* Iterator Movement */                                                 \
+    FMOD void PFX##_iter_to_start(SNAME##_iter *iter);                      \
+    FMOD void PFX##_iter_to_end(SNAME##_iter *iter);                        \
+    FMOD bool PFX##_iter_next(SNAME##_iter *iter);                          \
+    FMOD bool PFX##_iter_prev(SNAME##_iter *iter);                          \
+    /* Iterator Access */                                                   \
+    FMOD K PFX##_iter_key(SNAME##_iter *iter);                              \
+    FMOD V PFX##_iter_value(SNAME##_iter *iter);                            \
+    FMOD V *PFX##_iter_rvalue(SNAME##_iter *iter);                          \
+    FMOD size_t PFX##_iter_index(SNAME##_iter *iter);                       \
+                                                                            \
+    /* Default Key */                                                       \
+    static inline K PFX##_impl_default_key(void)                            \
+    {                                                                       \
+        K _empty_key_;                                                      \
+                                                                            \
+        memset(&_empty_key_, 0, sizeof(K));                                 \
+                                                                            \
+        return _empty_key_;                                                 \
+    }                                                                       \
+                                                                            \
+    /* Default Value */                                                     \
+    static inline V PFX##_impl_default_value(void)                          \
+    {                                                                       \
+        V _empty_value_;                                                    \
+                                                                            \
+        memset(&_empty_value_, 0, sizeof(V));                               \
+                                                                            \
+        return _empty_value_;                                               \
+    }                                                                       \
+                                                                            \
+/* SOURCE ********************************************************************/
+#define SAC_HASHMAP_GENERATE_SOURCE(PFX, SNAME, FMOD, K, V, SIZE)                  \
+                                                                                   \
+    /* Implementation Detail Functions */                                          \
+    static SNAME##_entry *PFX##_impl_get_entry(SNAME *_map_, K key);               \
+    static void PFX##_impl_place_entry(SNAME *_map_, SNAME##_entry entry);         \
+    static void PFX##_impl_remove_entry(SNAME *_map_, SNAME##_entry *entry);       \
+    static size_t PFX##_impl_next_filled(SNAME *_map_, size_t from);               \
+    static size_t PFX##_impl_prev_filled(SNAME *_map_, size_t from);               \
+    static SNAME##_iter PFX##_impl_it_start(SNAME *_map_);                         \
+    static SNAME##_iter PFX##_impl_it_end(SNAME *_map_);                           \
+                                                                                   \
+    FMOD SNAME PFX##_new(int (*compare)(K, K), size_t (*hash)(K))                  \
+    {                                                                              \
+        SNAME result;                                                              \
+                                                                                   \
+        memset(&result, 0, sizeof(SNAME));                                         \
+                                                                                   \
+        result.cmp = compare;                                                      \
+        result.hash = hash;                                                        \
+                                                                                   \
+        result.it_start = PFX##_impl_it_start;                                     \
+        result.it_end = PFX##_impl_it_end;                                         \
+                                                                                   \
+        return result;                                                             \
+    }                                                                              \
+                                                                                   \
+    FMOD void PFX##_clear(SNAME *_map_)                                            \
+    {                                                                              \
+        memset(_map_->buffer, 0, sizeof(_map_->buffer));                           \
+                                                                                   \
+        _map_->count = 0;                                                          \
+    }                                                                              \
+                                                                                   \
+    FMOD bool PFX##_insert(SNAME *_map_, K key, V value)                           \
+    {                                                                              \
+        if (PFX##_full(_map_) || PFX##_impl_get_entry(_map_, key) != NULL)         \
+            return false;                                                          \
+                                                                                   \
+        SNAME##_entry entry;                                                       \
+                                                                                   \
+        memset(&entry, 0, sizeof(SNAME##_entry));                                  \
+                                                                                   \
+        entry.key = key;                                                           \
+        entry.value = value;                                                       \
+                                                                                   \
+        PFX##_impl_place_entry(_map_, entry);                                      \
+                                                                                   \
+        return true;                                                               \
+    }                                                                              \
+                                                                                   \
+    FMOD bool PFX##_update(SNAME *_map_, K key, V new_value, V *old_value)         \
+    {                                                                              \
+        SNAME##_entry *entry = PFX##_impl_get_entry(_map_, key);                   \
+                                                                                   \
+        if (!entry)                                                                \
+            return false;                                                          \
+                                                                                   \
+        if (old_value)                                                             \
+            *old_value = entry->value;                                             \
+                                                                                   \
+        entry->value = new_value;                                                  \
+                                                                                   \
+        return true;                                                               \
+    }                                                                              \
+                                                                                   \
+    FMOD bool PFX##_remove(SNAME *_map_, K key, V *out_value)                      \
+    {                                                                              \
+        SNAME##_entry *entry = PFX##_impl_get_entry(_map_, key);                   \
+                                                                                   \
+        if (!entry)                                                                \
+            return false;                                                          \
+                                                                                   \
+        if (out_value)                                                             \
+            *out_value = entry->value;                                             \
+                                                                                   \
+        PFX##_impl_remove_entry(_map_, entry);                                     \
+                                                                                   \
+        return true;                                                               \
+    }                                                                              \
+                                                                                   \
+    FMOD V PFX##_get(SNAME *_map_, K key)                                          \
+    {                                                                              \
+        SNAME##_entry *entry = PFX##_impl_get_entry(_map_, key);                   \
+                                                                                   \
+        if (!entry)                                                                \
+            return PFX##_impl_default_value();                                     \
+                                                                                   \
+        return entry->value;                                                       \
+    }                                                                              \
+                                                                                   \
+    FMOD V *PFX##_get_ref(SNAME *_map_, K key)                                     \
+    {                                                                              \
+        SNAME##_entry *entry = PFX##_impl_get_entry(_map_, key);                   \
+                                                                                   \
+        if (!entry)                                                                \
+            return NULL;                                                           \
+                                                                                   \
+        return &(entry->value);                                                    \
+    }                                                                              \
+                                                                                   \
+    FMOD bool PFX##_contains(SNAME *_map_, K key)                                  \
+    {                                                                              \
+        return PFX##_impl_get_entry(_map_, key) != NULL;                           \
+    }                                                                              \
+                                                                                   \
+    FMOD bool PFX##_empty(SNAME *_map_)                                            \
+    {                                                                              \
+        return _map_->count == 0;                                                  \
+    }                                                                              \
+                                                                                   \
+    FMOD bool PFX##_full(SNAME *_map_)                                             \
+    {                                                                              \
+        return _map_->count >= SIZE;                                               \
+    }                                                                              \
+                                                                                   \
+    FMOD size_t PFX##_count(SNAME *_map_)                                          \
+    {                                                                              \
+        return _map_->count;                                                       \
+    }                                                                              \
+                                                                                   \
+    FMOD size_t PFX##_capacity(void)                                               \
+    {                                                                              \
+        return SIZE;                                                               \
+    }                                                                              \
+                                                                                   \
+    FMOD void PFX##_iter_init(SNAME##_iter *iter, SNAME *target)                   \
+    {                                                                              \
+        iter->target = target;                                                     \
+        iter->first = PFX##_impl_next_filled(target, 0);                           \
+        iter->last = PFX##_impl_prev_filled(target, SIZE - 1);                     \
+        iter->cursor = iter->first;                                                \
+        iter->index = 0;                                                           \
+        iter->start = true;                                                        \
+        iter->end = PFX##_empty(target);                                           \
+    }                                                                              \
+                                                                                   \
+    FMOD bool PFX##_iter_start(SNAME##_iter *iter)                                 \
+    {                                                                              \
+        return PFX##_empty(iter->target) || iter->start;                           \
+    }                                                                              \
+                                                                                   \
+    FMOD bool PFX##_iter_end(SNAME##_iter *iter)                                   \
+    {                                                                              \
+        return PFX##_empty(iter->target) || iter->end;                             \
+    }                                                                              \
+                                                                                   \
+    FMOD void PFX##_iter_to_start(SNAME##_iter *iter)                              \
+    {                                                                              \
+        iter->cursor = iter->first;                                                \
+        iter->index = 0;                                                           \
+        iter->start = true;                                                        \
+        iter->end = PFX##_empty(iter->target);                                     \
+    }                                                                              \
+                                                                                   \
+    FMOD void PFX##_iter_to_end(SNAME##_iter *iter)                                \
+    {                                                                              \
+        if (PFX##_empty(iter->target))                                             \
+            iter->cursor = 0;                                                      \
+        else                                                                       \
+            iter->cursor = iter->last;                                             \
+                                                                                   \
+        iter->index = iter->target->count - 1;                                     \
+        iter->start = PFX##_empty(iter->target);                                   \
+        iter->end = true;                                                          \
+    }                                                                              \
+                                                                                   \
+    FMOD bool PFX##_iter_next(SNAME##_iter *iter)                                  \
+    {                                                                              \
+        if (iter->end)                                                             \
+            return false;                                                          \
+                                                                                   \
+        iter->start = PFX##_empty(iter->target);                                   \
+                                                                                   \
+        if (iter->index == iter->target->count - 1)                                \
+            iter->end = true;                                                      \
+        else                                                                       \
+        {                                                                          \
+            iter->cursor = PFX##_impl_next_filled(iter->target, iter->cursor + 1); \
+            iter->index++;                                                         \
+        }                                                                          \
+                                                                                   \
+        return true;                                                               \
+    }                                                                              \
+                                                                                   \
+    FMOD bool PFX##_iter_prev(SNAME##_iter *iter)                                  \
+    {                                                                              \
+        if (iter->start)                                                           \
+            return false;                                                          \
+                                                                                   \
+        iter->end = PFX##_empty(iter->target);                                     \
+                                                                                   \
+        if (iter->index == 0)                                                      \
+            iter->start = true;                                                    \
+        else                                                                       \
+        {                                                                          \
+            iter->cursor = PFX##_impl_prev_filled(iter->target, iter->cursor - 1); \
+            iter->index--;                                                         \
+        }                                                                          \
+                                                                                   \
+        return true;                                                               \
+    }                                                                              \
+                                                                                   \
+    FMOD K PFX##_iter_key(SNAME##_iter *iter)                                      \
+    {                                                                              \
+        if (PFX##_empty(iter->target))                                             \
+            return PFX##_impl_default_key();                                       \
+                                                                                   \
+        return iter->target->buffer[iter->cursor].key;                             \
+    }                                                                              \
+                                                                                   \
+    FMOD V PFX##_iter_value(SNAME##_iter *iter)                                    \
+    {                                                                              \
+        if (PFX##_empty(iter->target))                                             \
+            return PFX##_impl_default_value();                                     \
+                                                                                   \
+        return iter->target->buffer[iter->cursor].value;                           \
+    }                                                                              \
+                                                                                   \
+    FMOD V *PFX##_iter_rvalue(SNAME##_iter *iter)                                  \
+    {                                                                              \
+        if (PFX##_empty(iter->target))                                             \
+            return NULL;                                                           \
+                                                                                   \
+        return &(iter->target->buffer[iter->cursor].value);                        \
+    }                                                                              \
+                                                                                   \
+    FMOD size_t PFX##_iter_index(SNAME##_iter *iter)                               \
+    {                                                                              \
+        return iter->index;                                                        \
+    }                                                                              \
+                                                                                   \
+    static SNAME##_entry *PFX##_impl_get_entry(SNAME *_map_, K key)                \
+    {                                                                              \
+        size_t pos = _map_->hash(key) % (SIZE);                                    \
+                                                                                   \
+        /* The search stops at the first empty entry or at the first entry */      \
+        /* closer to its original position than the key would be. A full */        \
+        /* table has no empty entry so it also stops after every entry */          \
+        for (size_t dist = 0; dist < SIZE; dist++)                                 \
+        {                                                                          \
+            SNAME##_entry *target = &(_map_->buffer[pos]);                         \
+                                                                                   \
+            if (!target->filled || target->dist < dist)                            \
+                return NULL;                                                       \
+                                                                                   \
+            if (_map_->cmp(target->key, key) == 0)                                 \
+                return target;                                                     \
+                                                                                   \
+            pos = (pos + 1) % (SIZE);                                              \
+        }                                                                          \
+                                                                                   \
+        return NULL;                                                               \
+    }                                                                              \
+                                                                                   \
+    /* Robin hood hashing. The entry being placed takes the position of the */     \
+    /* first entry closer to its own original position, which is then */           \
+    /* placed further on. The key must not be in the table and the table */        \
+    /* must not be full */                                                         \
+    static void PFX##_impl_place_entry(SNAME *_map_, SNAME##_entry entry)          \
+    {                                                                              \
+        size_t pos = _map_->hash(entry.key) % (SIZE);                              \
+                                                                                   \
+        entry.dist = 0;                                                            \
+        entry.filled = true;                                                       \
+                                                                                   \
+        while (_map_->buffer[pos].filled)                                          \
+        {                                                                          \
+            if (_map_->buffer[pos].dist < entry.dist)                              \
+            {                                                                      \
+                SNAME##_entry tmp = _map_->buffer[pos];                            \
+                _map_->buffer[pos] = entry;                                        \
+                entry = tmp;                                                       \
+            }                                                                      \
+                                                                                   \
+            pos = (pos + 1) % (SIZE);                                              \
+            entry.dist++;                                                          \
+        }                                                                          \
+                                                                                   \
+        _map_->buffer[pos] = entry;                                                \
+        _map_->count++;                                                            \
+    }                                                                              \
+                                                                                   \
+    /* Backward shift deletion. Every entry that follows and is not at its */      \
+    /* original position is moved one position back, so there are no */            \
+    /* tombstones */                                                               \
+    static void PFX##_impl_remove_entry(SNAME *_map_, SNAME##_entry *entry)        \
+    {                                                                              \
+        size_t pos = (size_t)(entry - _map_->buffer);                              \
+                                                                                   \
+        for (size_t i = 1; i < SIZE; i++)                                          \
+        {                                                                          \
+            size_t next = (pos + 1) % (SIZE);                                      \
+                                                                                   \
+            if (!_map_->buffer[next].filled || _map_->buffer[next].dist == 0)      \
+                break;                                                             \
+                                                                                   \
+            _map_->buffer[pos] = _map_->buffer[next];                              \
+            _map_->buffer[pos].dist--;                                             \
+                                                                                   \
+            pos = next;                                                            \
+        }                                                                          \
+                                                                                   \
+        memset(&(_map_->buffer[pos]), 0, sizeof(SNAME##_entry));                   \
+                                                                                   \
+        _map_->count--;                                                            \
+    }                                                                              \
+                                                                                   \
+    /* First filled entry at or after from, or SIZE if there is none */            \
+    static size_t PFX##_impl_next_filled(SNAME *_map_, size_t from)                \
+    {                                                                              \
+        while (from < SIZE && !_map_->buffer[from].filled)                         \
+            from++;                                                                \
+                                                                                   \
+        return from;                                                               \
+    }                                                                              \
+                                                                                   \
+    /* Last filled entry at or before from, or 0 if there is none */               \
+    static size_t PFX##_impl_prev_filled(SNAME *_map_, size_t from)                \
+    {                                                                              \
+        while (from > 0 && !_map_->buffer[from].filled)                            \
+            from--;                                                                \
+                                                                                   \
+        return from;                                                               \
+    }                                                                              \
+                                                                                   \
+    static SNAME##_iter PFX##_impl_it_start(SNAME *_map_)                          \
+    {                                                                              \
+        SNAME##_iter iter;                                                         \
+                                                                                   \
+        PFX##_iter_init(&iter, _map_);                                             \
+        PFX##_iter_to_start(&iter);                                                \
+                                                                                   \
+        return iter;                                                               \
+    }                                                                              \
+                                                                                   \
+    static SNAME##_iter PFX##_impl_it_end(SNAME *_map_)                            \
+    {                                                                              \
+        SNAME##_iter iter;                                                         \
+                                                                                   \
+        PFX##_iter_init(&iter, _map_);                                             \
+        PFX##_iter_to_end(&iter);                                                  \
+                                                                                   \
+        return iter;                                                               \
+    }
+
+#endif /* CMC_SAC_HASHMAP_H */
@@ -0,0 +1,234 @@
+/**
+ * heap.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * A Purely Stack Allocated Heap
+ *
+ * A binary heap stored in a buffer of fixed size inside the struct, so it can
+ * be used where there is no malloc at all. Every function gets the FMOD
+ * modifier, which can be static inline to have them all inlined.
+ *
+ * Generating a collection with too big of a storage can be dangerous and might
+ * quickly cause a stack overflow.
+ *
+ * It is recommended to not generate any Stack Allocated Collection with less
+ * than 1000 internal storage.
+ */
+
+#ifndef CMC_SAC_HEAP_H
+#define CMC_SAC_HEAP_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* Also defined by cmc/heap.h */
+#ifndef CMC_HEAP_ORDER
+#define CMC_HEAP_ORDER
+
+enum cmc_heap_order
+{
+    cmc_max_heap = 1,
+    cmc_min_heap = -1
+};
+
+#endif /* CMC_HEAP_ORDER */
+
+#define SAC_HEAP_GENERATE(PFX, SNAME, FMOD, V, SIZE)    \
+    SAC_HEAP_GENERATE_HEADER(PFX, SNAME, FMOD, V, SIZE) \
+    SAC_HEAP_GENERATE_SOURCE(PFX, SNAME, FMOD, V, SIZE)
+
+#define SAC_HEAP_WRAPGEN_HEADER(PFX, SNAME, FMOD, K, V, SIZE) \
+    SAC_HEAP_GENERATE_HEADER(PFX, SNAME, FMOD, V, SIZE)
+
+#define SAC_HEAP_WRAPGEN_SOURCE(PFX, SNAME, FMOD, K, V, SIZE) \
+    SAC_HEAP_GENERATE_SOURCE(PFX, SNAME, FMOD, V, SIZE)
+
+/* HEADER ********************************************************************/
+#define SAC_HEAP_GENERATE_HEADER(PFX, SNAME, FMOD, V, SIZE)             \
+                                                                        \
+    /* Heap Structure */                                                \
+    typedef struct SNAME##_s                                            \
+    {                                                                   \
+        /* Internal Storage */                                          \
+        V buffer[SIZE];                                                 \
+                                                                        \
+        /* Current amount of elements */                                \
+        size_t count;                                                   \
+                                                                        \
+        /* Heap order (MaxHeap or MinHeap) */                           \
+        enum cmc_heap_order HO;                                         \
+                                                                        \
+        /* Function that compares two elements */                       \
+        int (*cmp)(V, V);                                               \
+                                                                        \
+    } SNAME, *SNAME##_ptr;                                              \
+                                                                        \
+    /* Collection Functions */                                          \
+    /* Collection Allocation and Deallocation */                        \
+    FMOD SNAME PFX##_new(enum cmc_heap_order HO, int (*compare)(V, V)); \
+    FMOD void PFX##_clear(SNAME *_heap_);                               \
+    /* Collection Input and Output */                                   \
+    FMOD bool PFX##_insert(SNAME *_heap_, V element);                   \
+    FMOD bool PFX##_remove(SNAME *_heap_, V *result);                   \
+    /* Element Access */                                                \
+    FMOD V PFX##_peek(SNAME *_heap_);                                   \
+    /* Collection State */                                              \
+    FMOD bool PFX##_contains(SNAME *_heap_, V element);                 \
+    FMOD bool PFX##_empty(SNAME *_heap_);                               \
+    FMOD bool PFX##_full(SNAME *_heap_);                                \
+    FMOD size_t PFX##_count(SNAME *_heap_);                             \
+    FMOD size_t PFX##_capacity(void);                                   \
+                                                                        \
+    /* Default Value */                                                 \
+    static inline V PFX##_impl_default_value(void)                      \
+    {                                                                   \
+        V _empty_value_;                                                \
+                                                                        \
+        memset(&_empty_value_, 0, sizeof(V));                           \
+                                                                        \
+        return _empty_value_;                                           \
+    }
+
+/* SOURCE ********************************************************************/
+#define SAC_HEAP_GENERATE_SOURCE(PFX, SNAME, FMOD, V, SIZE)                                     \
+                                                                                                \
+    /* Implementation Detail Functions */                                                       \
+    static void PFX##_impl_float_up(SNAME *_heap_, size_t index);                               \
+    static void PFX##_impl_float_down(SNAME *_heap_, size_t index);                             \
+                                                                                                \
+    FMOD SNAME PFX##_new(enum cmc_heap_order HO, int (*compare)(V, V))                          \
+    {                                                                                           \
+        SNAME result;                                                                           \
+                                                                                                \
+        memset(&result, 0, sizeof(SNAME));                                                      \
+                                                                                                \
+        result.HO = HO;                                                                         \
+        result.cmp = compare;                                                                   \
+                                                                                                \
+        return result;                                                                          \
+    }                                                                                           \
+                                                                                                \
+    FMOD void PFX##_clear(SNAME *_heap_)                                                        \
+    {                                                                                           \
+        memset(_heap_->buffer, 0, sizeof(_heap_->buffer));                                      \
+                                                                                                \
+        _heap_->count = 0;                                                                      \
+    }                                                                                           \
+                                                                                                \
+    FMOD bool PFX##_insert(SNAME *_heap_, V element)                                            \
+    {                                                                                           \
+        if (PFX##_full(_heap_))                                                                 \
+            return false;                                                                       \
+                                                                                                \
+        _heap_->buffer[_heap_->count++] = element;                                              \
+                                                                                                \
+        PFX##_impl_float_up(_heap_, _heap_->count - 1);                                         \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    FMOD bool PFX##_remove(SNAME *_heap_, V *result)                                            \
+    {                                                                                           \
+        if (PFX##_empty(_heap_))                                                                \
+            return false;                                                                       \
+                                                                                                \
+        *result = _heap_->buffer[0];                                                            \
+                                                                                                \
+        _heap_->buffer[0] = _heap_->buffer[--_heap_->count];                                    \
+        _heap_->buffer[_heap_->count] = PFX##_impl_default_value();                             \
+                                                                                                \
+        PFX##_impl_float_down(_heap_, 0);                                                       \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    FMOD V PFX##_peek(SNAME *_heap_)                                                            \
+    {                                                                                           \
+        if (PFX##_empty(_heap_))                                                                \
+            return PFX##_impl_default_value();                                                  \
+                                                                                                \
+        return _heap_->buffer[0];                                                               \
+    }                                                                                           \
+                                                                                                \
+    FMOD bool PFX##_contains(SNAME *_heap_, V element)                                          \
+    {                                                                                           \
+        for (size_t i = 0; i < _heap_->count; i++)                                              \
+        {                                                                                       \
+            if (_heap_->cmp(_heap_->buffer[i], element) == 0)                                   \
+                return true;                                                                    \
+        }                                                                                       \
+                                                                                                \
+        return false;                                                                           \
+    }                                                                                           \
+                                                                                                \
+    FMOD bool PFX##_empty(SNAME *_heap_)                                                        \
+    {                                                                                           \
+        return _heap_->count == 0;                                                              \
+    }                                                                                           \
+                                                                                                \
+    FMOD bool PFX##_full(SNAME *_heap_)                                                         \
+    {                                                                                           \
+        return _heap_->count >= SIZE;                                                           \
+    }                                                                                           \
+                                                                                                \
+    FMOD size_t PFX##_count(SNAME *_heap_)                                                      \
+    {                                                                                           \
+        return _heap_->count;                                                                   \
+    }                                                                                           \
+                                                                                                \
+    FMOD size_t PFX##_capacity(void)                                                            \
+    {                                                                                           \
+        return SIZE;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    static void PFX##_impl_float_up(SNAME *_heap_, size_t index)                                \
+    {                                                                                           \
+        V element = _heap_->buffer[index];                                                      \
+                                                                                                \
+        /* Parents that go after the element move down to make room for it */                   \
+        while (index > 0)                                                                       \
+        {                                                                                       \
+            size_t parent = (index - 1) / 2;                                                    \
+                                                                                                \
+            if (_heap_->cmp(_heap_->buffer[parent], element) * _heap_->HO >= 0)                 \
+                break;                                                                          \
+                                                                                                \
+            _heap_->buffer[index] = _heap_->buffer[parent];                                     \
+            index = parent;                                                                     \
+        }                                                                                       \
+                                                                                                \
+        _heap_->buffer[index] = element;                                                        \
+    }                                                                                           \
+                                                                                                \
+    static void PFX##_impl_float_down(SNAME *_heap_, size_t index)                              \
+    {                                                                                           \
+        V element = _heap_->buffer[index];                                                      \
+                                                                                                \
+        while (2 * index + 1 < _heap_->count)                                                   \
+        {                                                                                       \
+            size_t child = 2 * index + 1;                                                       \
+                                                                                                \
+            /* Pick the child that goes first */                                                \
+            if (child + 1 < _heap_->count &&                                                    \
+                _heap_->cmp(_heap_->buffer[child + 1], _heap_->buffer[child]) * _heap_->HO > 0) \
+                child++;                                                                        \
+                                                                                                \
+            if (_heap_->cmp(element, _heap_->buffer[child]) * _heap_->HO >= 0)                  \
+                break;                                                                          \
+                                                                                                \
+            _heap_->buffer[index] = _heap_->buffer[child];                                      \
+            index = child;                                                                      \
+        }                                                                                       \
+                                                                                                \
+        _heap_->buffer[index] = element;                                                        \
+    }
+
+#endif /* CMC_SAC_HEAP_H */
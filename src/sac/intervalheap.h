@@ -0,0 +1,441 @@
+/**
+ * intervalheap.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * A Purely Stack Allocated IntervalHeap
+ *
+ * A double-ended priority queue stored in a buffer of fixed size inside the
+ * struct, so it can be used where there is no malloc at all. Every function
+ * gets the FMOD modifier, which can be static inline to have them all inlined.
+ *
+ * Each node holds one value of the MinHeap and one of the MaxHeap. When the
+ * count is odd the last node has a single value, kept in both of its slots.
+ *
+ * Generating a collection with too big of a storage can be dangerous and might
+ * quickly cause a stack overflow.
+ *
+ * It is recommended to not generate any Stack Allocated Collection with less
+ * than 1000 internal storage.
+ */
+
+#ifndef CMC_SAC_INTERVALHEAP_H
+#define CMC_SAC_INTERVALHEAP_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define SAC_INTERVALHEAP_GENERATE(PFX, SNAME, FMOD, V, SIZE)    \
+    SAC_INTERVALHEAP_GENERATE_HEADER(PFX, SNAME, FMOD, V, SIZE) \
+    SAC_INTERVALHEAP_GENERATE_SOURCE(PFX, SNAME, FMOD, V, SIZE)
+
+#define SAC_INTERVALHEAP_WRAPGEN_HEADER(PFX, SNAME, FMOD, K, V, SIZE) \
+    SAC_INTERVALHEAP_GENERATE_HEADER(PFX, SNAME, FMOD, V, SIZE)
+
+#define SAC_INTERVALHEAP_WRAPGEN_SOURCE(PFX, SNAME, FMOD, K, V, SIZE) \
+    SAC_INTERVALHEAP_GENERATE_SOURCE(PFX, SNAME, FMOD, V, SIZE)
+
+/* HEADER ********************************************************************/
+#define SAC_INTERVALHEAP_GENERATE_HEADER(PFX, SNAME, FMOD, V, SIZE) \
+                                                                    \
+    /* IntervalHeap Node */                                         \
+    typedef struct SNAME##_node_s                                   \
+    {                                                               \
+        /* 0 - Value of the MinHeap */                              \
+        /* 1 - Value of the MaxHeap */                              \
+        V data[2];                                                  \
+                                                                    \
+    } SNAME##_node, *SNAME##_node_ptr;                              \
+                                                                    \
+    /* IntervalHeap Structure */                                    \
+    typedef struct SNAME##_s                                        \
+    {                                                               \
+        /* Internal Storage */                                      \
+        SNAME##_node buffer[(SIZE + 1) / 2];                        \
+                                                                    \
+        /* Current amount of elements */                            \
+        size_t count;                                               \
+                                                                    \
+        /* Function that compares two elements */                   \
+        int (*cmp)(V, V);                                           \
+                                                                    \
+    } SNAME, *SNAME##_ptr;                                          \
+                                                                    \
+    /* Collection Functions */                                      \
+    /* Collection Allocation and Deallocation */                    \
+    FMOD SNAME PFX##_new(int (*compare)(V, V));                     \
+    FMOD void PFX##_clear(SNAME *_heap_);                           \
+    /* Collection Input and Output */                               \
+    FMOD bool PFX##_insert(SNAME *_heap_, V element);               \
+    FMOD bool PFX##_remove_max(SNAME *_heap_, V *result);           \
+    FMOD bool PFX##_remove_min(SNAME *_heap_, V *result);           \
+    /* Element Access */                                            \
+    FMOD bool PFX##_update_max(SNAME *_heap_, V element);           \
+    FMOD bool PFX##_update_min(SNAME *_heap_, V element);           \
+    FMOD bool PFX##_max(SNAME *_heap_, V *value);                   \
+    FMOD bool PFX##_min(SNAME *_heap_, V *value);                   \
+    /* Collection State */                                          \
+    FMOD bool PFX##_contains(SNAME *_heap_, V element);             \
+    FMOD bool PFX##_empty(SNAME *_heap_);                           \
+    FMOD bool PFX##_full(SNAME *_heap_);                            \
+    FMOD size_t PFX##_count(SNAME *_heap_);                         \
+    FMOD size_t PFX##_capacity(void);
+
+/* SOURCE ********************************************************************/
+#define SAC_INTERVALHEAP_GENERATE_SOURCE(PFX, SNAME, FMOD, V, SIZE)                                \
+                                                                                                   \
+    /* Implementation Detail Functions */                                                          \
+    static void PFX##_impl_float_up_max(SNAME *_heap_, size_t index);                              \
+    static void PFX##_impl_float_up_min(SNAME *_heap_, size_t index);                              \
+    static void PFX##_impl_float_down_max(SNAME *_heap_, size_t index);                            \
+    static void PFX##_impl_float_down_min(SNAME *_heap_, size_t index);                            \
+    static inline void PFX##_impl_swap(V *a, V *b);                                                \
+                                                                                                   \
+    FMOD SNAME PFX##_new(int (*compare)(V, V))                                                     \
+    {                                                                                              \
+        SNAME result;                                                                              \
+                                                                                                   \
+        memset(&result, 0, sizeof(SNAME));                                                         \
+                                                                                                   \
+        result.cmp = compare;                                                                      \
+                                                                                                   \
+        return result;                                                                             \
+    }                                                                                              \
+                                                                                                   \
+    FMOD void PFX##_clear(SNAME *_heap_)                                                           \
+    {                                                                                              \
+        memset(_heap_->buffer, 0, sizeof(_heap_->buffer));                                         \
+                                                                                                   \
+        _heap_->count = 0;                                                                         \
+    }                                                                                              \
+                                                                                                   \
+    FMOD bool PFX##_insert(SNAME *_heap_, V element)                                               \
+    {                                                                                              \
+        if (PFX##_full(_heap_))                                                                    \
+            return false;                                                                          \
+                                                                                                   \
+        size_t index = _heap_->count / 2;                                                          \
+                                                                                                   \
+        SNAME##_node *node = &(_heap_->buffer[index]);                                             \
+                                                                                                   \
+        bool occupying = _heap_->count % 2 == 0;                                                   \
+                                                                                                   \
+        if (occupying)                                                                             \
+        {                                                                                          \
+            /* A new node with a single value */                                                   \
+            node->data[0] = element;                                                               \
+            node->data[1] = element;                                                               \
+        }                                                                                          \
+        else if (_heap_->cmp(element, node->data[0]) < 0)                                          \
+            node->data[0] = element;                                                               \
+        else                                                                                       \
+            node->data[1] = element;                                                               \
+                                                                                                   \
+        _heap_->count++;                                                                           \
+                                                                                                   \
+        if (index == 0)                                                                            \
+            return true;                                                                           \
+                                                                                                   \
+        size_t P_index = (index - 1) / 2;                                                          \
+                                                                                                   \
+        SNAME##_node *parent = &(_heap_->buffer[P_index]);                                         \
+                                                                                                   \
+        /* Determine wheather to do a MinHeap insert or a MaxHeap insert */                        \
+        if (_heap_->cmp(element, parent->data[0]) < 0)                                             \
+        {                                                                                          \
+            if (occupying)                                                                         \
+            {                                                                                      \
+                /* Both slots of the new node take the value of the parent */                      \
+                node->data[0] = node->data[1] = parent->data[0];                                   \
+                parent->data[0] = element;                                                         \
+                index = P_index;                                                                   \
+            }                                                                                      \
+                                                                                                   \
+            PFX##_impl_float_up_min(_heap_, index);                                                \
+        }                                                                                          \
+        else if (_heap_->cmp(element, parent->data[1]) > 0)                                        \
+        {                                                                                          \
+            if (occupying)                                                                         \
+            {                                                                                      \
+                node->data[0] = node->data[1] = parent->data[1];                                   \
+                parent->data[1] = element;                                                         \
+                index = P_index;                                                                   \
+            }                                                                                      \
+                                                                                                   \
+            PFX##_impl_float_up_max(_heap_, index);                                                \
+        }                                                                                          \
+        /* else no float up required */                                                            \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    FMOD bool PFX##_remove_max(SNAME *_heap_, V *result)                                           \
+    {                                                                                              \
+        if (PFX##_empty(_heap_))                                                                   \
+            return false;                                                                          \
+                                                                                                   \
+        *result = _heap_->buffer[0].data[1];                                                       \
+                                                                                                   \
+        size_t last = (_heap_->count - 1) / 2;                                                     \
+                                                                                                   \
+        SNAME##_node *last_node = &(_heap_->buffer[last]);                                         \
+                                                                                                   \
+        V element = last_node->data[1];                                                            \
+                                                                                                   \
+        /* Either the last node is discarded or its MinHeap value is left */                       \
+        if (_heap_->count % 2 == 1)                                                                \
+            memset(last_node, 0, sizeof(SNAME##_node));                                            \
+        else                                                                                       \
+            last_node->data[1] = last_node->data[0];                                               \
+                                                                                                   \
+        _heap_->count--;                                                                           \
+                                                                                                   \
+        if (last == 0)                                                                             \
+            return true;                                                                           \
+                                                                                                   \
+        _heap_->buffer[0].data[1] = element;                                                       \
+                                                                                                   \
+        PFX##_impl_float_down_max(_heap_, 0);                                                      \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    FMOD bool PFX##_remove_min(SNAME *_heap_, V *result)                                           \
+    {                                                                                              \
+        if (PFX##_empty(_heap_))                                                                   \
+            return false;                                                                          \
+                                                                                                   \
+        *result = _heap_->buffer[0].data[0];                                                       \
+                                                                                                   \
+        size_t last = (_heap_->count - 1) / 2;                                                     \
+                                                                                                   \
+        SNAME##_node *last_node = &(_heap_->buffer[last]);                                         \
+                                                                                                   \
+        V element = last_node->data[0];                                                            \
+                                                                                                   \
+        /* Either the last node is discarded or its MaxHeap value is left */                       \
+        if (_heap_->count % 2 == 1)                                                                \
+            memset(last_node, 0, sizeof(SNAME##_node));                                            \
+        else                                                                                       \
+            last_node->data[0] = last_node->data[1];                                               \
+                                                                                                   \
+        _heap_->count--;                                                                           \
+                                                                                                   \
+        if (last == 0)                                                                             \
+            return true;                                                                           \
+                                                                                                   \
+        _heap_->buffer[0].data[0] = element;                                                       \
+                                                                                                   \
+        PFX##_impl_float_down_min(_heap_, 0);                                                      \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    FMOD bool PFX##_update_max(SNAME *_heap_, V element)                                           \
+    {                                                                                              \
+        if (PFX##_empty(_heap_))                                                                   \
+            return false;                                                                          \
+                                                                                                   \
+        _heap_->buffer[0].data[1] = element;                                                       \
+                                                                                                   \
+        PFX##_impl_float_down_max(_heap_, 0);                                                      \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    FMOD bool PFX##_update_min(SNAME *_heap_, V element)                                           \
+    {                                                                                              \
+        if (PFX##_empty(_heap_))                                                                   \
+            return false;                                                                          \
+                                                                                                   \
+        _heap_->buffer[0].data[0] = element;                                                       \
+                                                                                                   \
+        PFX##_impl_float_down_min(_heap_, 0);                                                      \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    FMOD bool PFX##_max(SNAME *_heap_, V *value)                                                   \
+    {                                                                                              \
+        if (PFX##_empty(_heap_))                                                                   \
+            return false;                                                                          \
+                                                                                                   \
+        *value = _heap_->buffer[0].data[1];                                                        \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    FMOD bool PFX##_min(SNAME *_heap_, V *value)                                                   \
+    {                                                                                              \
+        if (PFX##_empty(_heap_))                                                                   \
+            return false;                                                                          \
+                                                                                                   \
+        *value = _heap_->buffer[0].data[0];                                                        \
+                                                                                                   \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    FMOD bool PFX##_contains(SNAME *_heap_, V element)                                             \
+    {                                                                                              \
+        for (size_t i = 0; i < _heap_->count; i++)                                                 \
+        {                                                                                          \
+            if (_heap_->cmp(_heap_->buffer[i / 2].data[i % 2], element) == 0)                      \
+                return true;                                                                       \
+        }                                                                                          \
+                                                                                                   \
+        return false;                                                                              \
+    }                                                                                              \
+                                                                                                   \
+    FMOD bool PFX##_empty(SNAME *_heap_)                                                           \
+    {                                                                                              \
+        return _heap_->count == 0;                                                                 \
+    }                                                                                              \
+                                                                                                   \
+    FMOD bool PFX##_full(SNAME *_heap_)                                                            \
+    {                                                                                              \
+        return _heap_->count >= SIZE;                                                              \
+    }                                                                                              \
+                                                                                                   \
+    FMOD size_t PFX##_count(SNAME *_heap_)                                                         \
+    {                                                                                              \
+        return _heap_->count;                                                                      \
+    }                                                                                              \
+                                                                                                   \
+    FMOD size_t PFX##_capacity(void)                                                               \
+    {                                                                                              \
+        return SIZE;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    static void PFX##_impl_float_up_max(SNAME *_heap_, size_t index)                               \
+    {                                                                                              \
+        while (index > 0)                                                                          \
+        {                                                                                          \
+            size_t P_index = (index - 1) / 2;                                                      \
+                                                                                                   \
+            V *curr = &(_heap_->buffer[index].data[1]);                                            \
+            V *parent = &(_heap_->buffer[P_index].data[1]);                                        \
+                                                                                                   \
+            if (_heap_->cmp(*curr, *parent) <= 0)                                                  \
+                break;                                                                             \
+                                                                                                   \
+            PFX##_impl_swap(curr, parent);                                                         \
+                                                                                                   \
+            index = P_index;                                                                       \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static void PFX##_impl_float_up_min(SNAME *_heap_, size_t index)                               \
+    {                                                                                              \
+        while (index > 0)                                                                          \
+        {                                                                                          \
+            size_t P_index = (index - 1) / 2;                                                      \
+                                                                                                   \
+            V *curr = &(_heap_->buffer[index].data[0]);                                            \
+            V *parent = &(_heap_->buffer[P_index].data[0]);                                        \
+                                                                                                   \
+            if (_heap_->cmp(*curr, *parent) >= 0)                                                  \
+                break;                                                                             \
+                                                                                                   \
+            PFX##_impl_swap(curr, parent);                                                         \
+                                                                                                   \
+            index = P_index;                                                                       \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static void PFX##_impl_float_down_max(SNAME *_heap_, size_t index)                             \
+    {                                                                                              \
+        size_t size = (_heap_->count + 1) / 2;                                                     \
+                                                                                                   \
+        while (true)                                                                               \
+        {                                                                                          \
+            SNAME##_node *curr_node = &(_heap_->buffer[index]);                                    \
+                                                                                                   \
+            /* The last node with a single value has no children */                                \
+            if (index == size - 1 && _heap_->count % 2 == 1)                                       \
+            {                                                                                      \
+                curr_node->data[0] = curr_node->data[1];                                           \
+                break;                                                                             \
+            }                                                                                      \
+                                                                                                   \
+            /* The MaxHeap value might have become the smaller one */                              \
+            if (_heap_->cmp(curr_node->data[0], curr_node->data[1]) > 0)                           \
+                PFX##_impl_swap(&(curr_node->data[0]), &(curr_node->data[1]));                     \
+                                                                                                   \
+            size_t child = 2 * index + 1;                                                          \
+                                                                                                   \
+            if (child >= size)                                                                     \
+                break;                                                                             \
+                                                                                                   \
+            /* Pick the child with the greatest value */                                           \
+            if (child + 1 < size &&                                                                \
+                _heap_->cmp(_heap_->buffer[child + 1].data[1], _heap_->buffer[child].data[1]) > 0) \
+                child++;                                                                           \
+                                                                                                   \
+            V *curr = &(curr_node->data[1]);                                                       \
+            V *next = &(_heap_->buffer[child].data[1]);                                            \
+                                                                                                   \
+            if (_heap_->cmp(*next, *curr) <= 0)                                                    \
+                break;                                                                             \
+                                                                                                   \
+            PFX##_impl_swap(curr, next);                                                           \
+                                                                                                   \
+            index = child;                                                                         \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static void PFX##_impl_float_down_min(SNAME *_heap_, size_t index)                             \
+    {                                                                                              \
+        size_t size = (_heap_->count + 1) / 2;                                                     \
+                                                                                                   \
+        while (true)                                                                               \
+        {                                                                                          \
+            SNAME##_node *curr_node = &(_heap_->buffer[index]);                                    \
+                                                                                                   \
+            /* The last node with a single value has no children */                                \
+            if (index == size - 1 && _heap_->count % 2 == 1)                                       \
+            {                                                                                      \
+                curr_node->data[1] = curr_node->data[0];                                           \
+                break;                                                                             \
+            }                                                                                      \
+                                                                                                   \
+            /* The MinHeap value might have become the greater one */                              \
+            if (_heap_->cmp(curr_node->data[0], curr_node->data[1]) > 0)                           \
+                PFX##_impl_swap(&(curr_node->data[0]), &(curr_node->data[1]));                     \
+                                                                                                   \
+            size_t child = 2 * index + 1;                                                          \
+                                                                                                   \
+            if (child >= size)                                                                     \
+                break;                                                                             \
+                                                                                                   \
+            /* Pick the child with the smallest value */                                           \
+            if (child + 1 < size &&                                                                \
+                _heap_->cmp(_heap_->buffer[child + 1].data[0], _heap_->buffer[child].data[0]) < 0) \
+                child++;                                                                           \
+                                                                                                   \
+            V *curr = &(curr_node->data[0]);                                                       \
+            V *next = &(_heap_->buffer[child].data[0]);                                            \
+                                                                                                   \
+            if (_heap_->cmp(*next, *curr) >= 0)                                                    \
+                break;                                                                             \
+                                                                                                   \
+            PFX##_impl_swap(curr, next);                                                           \
+                                                                                                   \
+            index = child;                                                                         \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    static inline void PFX##_impl_swap(V *a, V *b)                                                 \
+    {                                                                                              \
+        V tmp = *a;                                                                                \
+        *a = *b;                                                                                   \
+        *b = tmp;                                                                                  \
+    }
+
+#endif /* CMC_SAC_INTERVALHEAP_H */
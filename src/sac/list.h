@@ -0,0 +1,397 @@
+/**
+ * list.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * A Purely Stack Allocated List
+ *
+ * A dynamic array of fixed size inside the struct, so it can be used where
+ * there is no malloc at all. Elements are pushed and popped anywhere by
+ * shifting the ones after them, like in the List.
+ *
+ * Generating a collection with too big of a storage can be dangerous and might
+ * quickly cause a stack overflow.
+ *
+ * It is recommended to not generate any Stack Allocated Collection with less
+ * than 1000 internal storage.
+ */
+
+#ifndef CMC_SAC_LIST_H
+#define CMC_SAC_LIST_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define SAC_LIST_GENERATE(PFX, SNAME, FMOD, V, SIZE)    \
+    SAC_LIST_GENERATE_HEADER(PFX, SNAME, FMOD, V, SIZE) \
+    SAC_LIST_GENERATE_SOURCE(PFX, SNAME, FMOD, V, SIZE)
+
+#define SAC_LIST_WRAPGEN_HEADER(PFX, SNAME, FMOD, K, V, SIZE) \
+    SAC_LIST_GENERATE_HEADER(PFX, SNAME, FMOD, V, SIZE)
+
+#define SAC_LIST_WRAPGEN_SOURCE(PFX, SNAME, FMOD, K, V, SIZE) \
+    SAC_LIST_GENERATE_SOURCE(PFX, SNAME, FMOD, V, SIZE)
+
+/* HEADER ********************************************************************/
+#define SAC_LIST_GENERATE_HEADER(PFX, SNAME, FMOD, V, SIZE)                      \
+                                                                                 \
+    /* List Structure */                                                         \
+    typedef struct SNAME##_s                                                     \
+    {                                                                            \
+        /* Internal Storage */                                                   \
+        V buffer[SIZE];                                                          \
+                                                                                 \
+        /* Current amount of elements */                                         \
+        size_t count;                                                            \
+                                                                                 \
+        /* Function that returns an iterator to the start of the list */         \
+        struct SNAME##_iter_s (*it_start)(struct SNAME##_s *);                   \
+                                                                                 \
+        /* Function that returns an iterator to the end of the list */           \
+        struct SNAME##_iter_s (*it_end)(struct SNAME##_s *);                     \
+                                                                                 \
+    } SNAME, *SNAME##_ptr;                                                       \
+                                                                                 \
+    /* List Iterator */                                                          \
+    typedef struct SNAME##_iter_s                                                \
+    {                                                                            \
+        /* Target list */                                                        \
+        struct SNAME##_s *target;                                                \
+                                                                                 \
+        /* Cursor's position (index) */                                          \
+        size_t cursor;                                                           \
+                                                                                 \
+        /* If the iterator has reached the start of the iteration */             \
+        bool start;                                                              \
+                                                                                 \
+        /* If the iterator has reached the end of the iteration */               \
+        bool end;                                                                \
+                                                                                 \
+    } SNAME##_iter, *SNAME##_iter_ptr;                                           \
+                                                                                 \
+    /* Collection Functions */                                                   \
+    /* Collection Allocation and Deallocation */                                 \
+    FMOD SNAME PFX##_new(void);                                                  \
+    FMOD void PFX##_clear(SNAME *_list_);                                        \
+    /* Collection Input and Output */                                            \
+    FMOD bool PFX##_push_front(SNAME *_list_, V element);                        \
+    FMOD bool PFX##_push_at(SNAME *_list_, V element, size_t index);             \
+    FMOD bool PFX##_push_back(SNAME *_list_, V element);                         \
+    FMOD bool PFX##_pop_front(SNAME *_list_);                                    \
+    FMOD bool PFX##_pop_at(SNAME *_list_, size_t index);                         \
+    FMOD bool PFX##_pop_back(SNAME *_list_);                                     \
+    /* Element Access */                                                         \
+    FMOD V PFX##_front(SNAME *_list_);                                           \
+    FMOD V PFX##_get(SNAME *_list_, size_t index);                               \
+    FMOD V *PFX##_get_ref(SNAME *_list_, size_t index);                          \
+    FMOD V PFX##_back(SNAME *_list_);                                            \
+    FMOD size_t PFX##_indexof(SNAME *_list_, V element, int (*comparator)(V, V), \
+                              bool from_start);                                  \
+    /* Collection State */                                                       \
+    FMOD bool PFX##_contains(SNAME *_list_, V element, int (*comparator)(V, V)); \
+    FMOD bool PFX##_empty(SNAME *_list_);                                        \
+    FMOD bool PFX##_full(SNAME *_list_);                                         \
+    FMOD size_t PFX##_count(SNAME *_list_);                                      \
+    FMOD size_t PFX##_capacity(void);                                            \
+                                                                                 \
+    /* Iterator Functions */                                                     \
+    /* Iterator Initialization */                                                \
+    FMOD void PFX##_iter_init(SNAME##_iter *iter, SNAME *target);                \
+    /* Iterator State */                                                         \
+    FMOD bool PFX##_iter_start(SNAME##_iter *iter);                              \
+    FMOD bool PFX##_iter_end(SNAME##_iter *iter);                                \
+    /* Iterator Movement */                                                      \
+    FMOD void PFX##_iter_to_start(SNAME##_iter *iter);                           \
+    FMOD void PFX##_iter_to_end(SNAME##_iter *iter);                             \
+    FMOD bool PFX##_iter_next(SNAME##_iter *iter);                               \
+    FMOD bool PFX##_iter_prev(SNAME##_iter *iter);                               \
+    /* Iterator Access */                                                        \
+    FMOD V PFX##_iter_value(SNAME##_iter *iter);                                 \
+    FMOD V *PFX##_iter_rvalue(SNAME##_iter *iter);                               \
+    FMOD size_t PFX##_iter_index(SNAME##_iter *iter);                            \
+                                                                                 \
+    /* Default Value */                                                          \
+    static inline V PFX##_impl_default_value(void)                               \
+    {                                                                            \
+        V _empty_value_;                                                         \
+                                                                                 \
+        memset(&_empty_value_, 0, sizeof(V));                                    \
+                                                                                 \
+        return _empty_value_;                                                    \
+    }
+
+/* SOURCE ********************************************************************/
+#define SAC_LIST_GENERATE_SOURCE(PFX, SNAME, FMOD, V, SIZE)                       \
+                                                                                  \
+    /* Implementation Detail Functions */                                         \
+    static SNAME##_iter PFX##_impl_it_start(SNAME *_list_);                       \
+    static SNAME##_iter PFX##_impl_it_end(SNAME *_list_);                         \
+                                                                                  \
+    FMOD SNAME PFX##_new(void)                                                    \
+    {                                                                             \
+        SNAME result;                                                             \
+                                                                                  \
+        memset(&result, 0, sizeof(SNAME));                                        \
+                                                                                  \
+        result.it_start = PFX##_impl_it_start;                                    \
+        result.it_end = PFX##_impl_it_end;                                        \
+                                                                                  \
+        return result;                                                            \
+    }                                                                             \
+                                                                                  \
+    FMOD void PFX##_clear(SNAME *_list_)                                          \
+    {                                                                             \
+        memset(_list_->buffer, 0, sizeof(_list_->buffer));                        \
+                                                                                  \
+        _list_->count = 0;                                                        \
+    }                                                                             \
+                                                                                  \
+    FMOD bool PFX##_push_front(SNAME *_list_, V element)                          \
+    {                                                                             \
+        return PFX##_push_at(_list_, element, 0);                                 \
+    }                                                                             \
+                                                                                  \
+    FMOD bool PFX##_push_at(SNAME *_list_, V element, size_t index)               \
+    {                                                                             \
+        if (PFX##_full(_list_) || index > _list_->count)                          \
+            return false;                                                         \
+                                                                                  \
+        memmove(_list_->buffer + index + 1, _list_->buffer + index,               \
+                (_list_->count - index) * sizeof(V));                             \
+                                                                                  \
+        _list_->buffer[index] = element;                                          \
+        _list_->count++;                                                          \
+                                                                                  \
+        return true;                                                              \
+    }                                                                             \
+                                                                                  \
+    FMOD bool PFX##_push_back(SNAME *_list_, V element)                           \
+    {                                                                             \
+        if (PFX##_full(_list_))                                                   \
+            return false;                                                         \
+                                                                                  \
+        _list_->buffer[_list_->count++] = element;                                \
+                                                                                  \
+        return true;                                                              \
+    }                                                                             \
+                                                                                  \
+    FMOD bool PFX##_pop_front(SNAME *_list_)                                      \
+    {                                                                             \
+        return PFX##_pop_at(_list_, 0);                                           \
+    }                                                                             \
+                                                                                  \
+    FMOD bool PFX##_pop_at(SNAME *_list_, size_t index)                           \
+    {                                                                             \
+        if (index >= _list_->count)                                               \
+            return false;                                                         \
+                                                                                  \
+        memmove(_list_->buffer + index, _list_->buffer + index + 1,               \
+                (_list_->count - index - 1) * sizeof(V));                         \
+                                                                                  \
+        _list_->buffer[--_list_->count] = PFX##_impl_default_value();             \
+                                                                                  \
+        return true;                                                              \
+    }                                                                             \
+                                                                                  \
+    FMOD bool PFX##_pop_back(SNAME *_list_)                                       \
+    {                                                                             \
+        if (PFX##_empty(_list_))                                                  \
+            return false;                                                         \
+                                                                                  \
+        _list_->buffer[--_list_->count] = PFX##_impl_default_value();             \
+                                                                                  \
+        return true;                                                              \
+    }                                                                             \
+                                                                                  \
+    FMOD V PFX##_front(SNAME *_list_)                                             \
+    {                                                                             \
+        if (PFX##_empty(_list_))                                                  \
+            return PFX##_impl_default_value();                                    \
+                                                                                  \
+        return _list_->buffer[0];                                                 \
+    }                                                                             \
+                                                                                  \
+    FMOD V PFX##_get(SNAME *_list_, size_t index)                                 \
+    {                                                                             \
+        if (index >= _list_->count)                                               \
+            return PFX##_impl_default_value();                                    \
+                                                                                  \
+        return _list_->buffer[index];                                             \
+    }                                                                             \
+                                                                                  \
+    FMOD V *PFX##_get_ref(SNAME *_list_, size_t index)                            \
+    {                                                                             \
+        if (index >= _list_->count)                                               \
+            return NULL;                                                          \
+                                                                                  \
+        return &(_list_->buffer[index]);                                          \
+    }                                                                             \
+                                                                                  \
+    FMOD V PFX##_back(SNAME *_list_)                                              \
+    {                                                                             \
+        if (PFX##_empty(_list_))                                                  \
+            return PFX##_impl_default_value();                                    \
+                                                                                  \
+        return _list_->buffer[_list_->count - 1];                                 \
+    }                                                                             \
+                                                                                  \
+    /* Returns the count of the list if the element is not found */               \
+    FMOD size_t PFX##_indexof(SNAME *_list_, V element, int (*comparator)(V, V),  \
+                              bool from_start)                                    \
+    {                                                                             \
+        if (from_start)                                                           \
+        {                                                                         \
+            for (size_t i = 0; i < _list_->count; i++)                            \
+            {                                                                     \
+                if (comparator(_list_->buffer[i], element) == 0)                  \
+                    return i;                                                     \
+            }                                                                     \
+        }                                                                         \
+        else                                                                      \
+        {                                                                         \
+            for (size_t i = _list_->count; i > 0; i--)                            \
+            {                                                                     \
+                if (comparator(_list_->buffer[i - 1], element) == 0)              \
+                    return i - 1;                                                 \
+            }                                                                     \
+        }                                                                         \
+                                                                                  \
+        return _list_->count;                                                     \
+    }                                                                             \
+                                                                                  \
+    FMOD bool PFX##_contains(SNAME *_list_, V element, int (*comparator)(V, V))   \
+    {                                                                             \
+        return PFX##_indexof(_list_, element, comparator, true) != _list_->count; \
+    }                                                                             \
+                                                                                  \
+    FMOD bool PFX##_empty(SNAME *_list_)                                          \
+    {                                                                             \
+        return _list_->count == 0;                                                \
+    }                                                                             \
+                                                                                  \
+    FMOD bool PFX##_full(SNAME *_list_)                                           \
+    {                                                                             \
+        return _list_->count >= SIZE;                                             \
+    }                                                                             \
+                                                                                  \
+    FMOD size_t PFX##_count(SNAME *_list_)                                        \
+    {                                                                             \
+        return _list_->count;                                                     \
+    }                                                                             \
+                                                                                  \
+    FMOD size_t PFX##_capacity(void)                                              \
+    {                                                                             \
+        return SIZE;                                                              \
+    }                                                                             \
+                                                                                  \
+    FMOD void PFX##_iter_init(SNAME##_iter *iter, SNAME *target)                  \
+    {                                                                             \
+        iter->target = target;                                                    \
+        iter->cursor = 0;                                                         \
+        iter->start = true;                                                       \
+        iter->end = PFX##_empty(target);                                          \
+    }                                                                             \
+                                                                                  \
+    FMOD bool PFX##_iter_start(SNAME##_iter *iter)                                \
+    {                                                                             \
+        return PFX##_empty(iter->target) || iter->start;                          \
+    }                                                                             \
+                                                                                  \
+    FMOD bool PFX##_iter_end(SNAME##_iter *iter)                                  \
+    {                                                                             \
+        return PFX##_empty(iter->target) || iter->end;                            \
+    }                                                                             \
+                                                                                  \
+    FMOD void PFX##_iter_to_start(SNAME##_iter *iter)                             \
+    {                                                                             \
+        iter->cursor = 0;                                                         \
+        iter->start = true;                                                       \
+        iter->end = PFX##_empty(iter->target);                                    \
+    }                                                                             \
+                                                                                  \
+    FMOD void PFX##_iter_to_end(SNAME##_iter *iter)                               \
+    {                                                                             \
+        iter->cursor = PFX##_empty(iter->target) ? 0 : iter->target->count - 1;   \
+        iter->start = PFX##_empty(iter->target);                                  \
+        iter->end = true;                                                         \
+    }                                                                             \
+                                                                                  \
+    FMOD bool PFX##_iter_next(SNAME##_iter *iter)                                 \
+    {                                                                             \
+        if (iter->end)                                                            \
+            return false;                                                         \
+                                                                                  \
+        iter->start = PFX##_empty(iter->target);                                  \
+                                                                                  \
+        if (iter->cursor == iter->target->count - 1)                              \
+            iter->end = true;                                                     \
+        else                                                                      \
+            iter->cursor++;                                                       \
+                                                                                  \
+        return true;                                                              \
+    }                                                                             \
+                                                                                  \
+    FMOD bool PFX##_iter_prev(SNAME##_iter *iter)                                 \
+    {                                                                             \
+        if (iter->start)                                                          \
+            return false;                                                         \
+                                                                                  \
+        iter->end = PFX##_empty(iter->target);                                    \
+                                                                                  \
+        if (iter->cursor == 0)                                                    \
+            iter->start = true;                                                   \
+        else                                                                      \
+            iter->cursor--;                                                       \
+                                                                                  \
+        return true;                                                              \
+    }                                                                             \
+                                                                                  \
+    FMOD V PFX##_iter_value(SNAME##_iter *iter)                                   \
+    {                                                                             \
+        if (PFX##_empty(iter->target))                                            \
+            return PFX##_impl_default_value();                                    \
+                                                                                  \
+        return iter->target->buffer[iter->cursor];                                \
+    }                                                                             \
+                                                                                  \
+    FMOD V *PFX##_iter_rvalue(SNAME##_iter *iter)                                 \
+    {                                                                             \
+        if (PFX##_empty(iter->target))                                            \
+            return NULL;                                                          \
+                                                                                  \
+        return &(iter->target->buffer[iter->cursor]);                             \
+    }                                                                             \
+                                                                                  \
+    FMOD size_t PFX##_iter_index(SNAME##_iter *iter)                              \
+    {                                                                             \
+        return iter->cursor;                                                      \
+    }                                                                             \
+                                                                                  \
+    static SNAME##_iter PFX##_impl_it_start(SNAME *_list_)                        \
+    {                                                                             \
+        SNAME##_iter iter;                                                        \
+                                                                                  \
+        PFX##_iter_init(&iter, _list_);                                           \
+        PFX##_iter_to_start(&iter);                                               \
+                                                                                  \
+        return iter;                                                              \
+    }                                                                             \
+                                                                                  \
+    static SNAME##_iter PFX##_impl_it_end(SNAME *_list_)                          \
+    {                                                                             \
+        SNAME##_iter iter;                                                        \
+                                                                                  \
+        PFX##_iter_init(&iter, _list_);                                           \
+        PFX##_iter_to_end(&iter);                                                 \
+                                                                                  \
+        return iter;                                                              \
+    }
+
+#endif /* CMC_SAC_LIST_H */
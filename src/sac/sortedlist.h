@@ -0,0 +1,402 @@
+/**
+ * sortedlist.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * A Purely Stack Allocated SortedList
+ *
+ * An array of fixed size inside the struct that is always kept sorted, so it
+ * can be used where there is no malloc at all. Unlike the SortedList, which
+ * sorts lazily, every insertion shifts the greater elements to make room
+ * for the new one, found by binary search, so lookups never have to sort.
+ *
+ * Generating a collection with too big of a storage can be dangerous and might
+ * quickly cause a stack overflow.
+ *
+ * It is recommended to not generate any Stack Allocated Collection with less
+ * than 1000 internal storage.
+ */
+
+#ifndef CMC_SAC_SORTEDLIST_H
+#define CMC_SAC_SORTEDLIST_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define SAC_SORTEDLIST_GENERATE(PFX, SNAME, FMOD, V, SIZE)    \
+    SAC_SORTEDLIST_GENERATE_HEADER(PFX, SNAME, FMOD, V, SIZE) \
+    SAC_SORTEDLIST_GENERATE_SOURCE(PFX, SNAME, FMOD, V, SIZE)
+
+#define SAC_SORTEDLIST_WRAPGEN_HEADER(PFX, SNAME, FMOD, K, V, SIZE) \
+    SAC_SORTEDLIST_GENERATE_HEADER(PFX, SNAME, FMOD, V, SIZE)
+
+#define SAC_SORTEDLIST_WRAPGEN_SOURCE(PFX, SNAME, FMOD, K, V, SIZE) \
+    SAC_SORTEDLIST_GENERATE_SOURCE(PFX, SNAME, FMOD, V, SIZE)
+
+/* HEADER ********************************************************************/
+#define SAC_SORTEDLIST_GENERATE_HEADER(PFX, SNAME, FMOD, V, SIZE)               \
+                                                                                \
+    /* SortedList Structure */                                                  \
+    typedef struct SNAME##_s                                                    \
+    {                                                                           \
+        /* Internal Storage */                                                  \
+        V buffer[SIZE];                                                         \
+                                                                                \
+        /* Current amount of elements */                                        \
+        size_t count;                                                           \
+                                                                                \
+        /* Element comparison function */                                       \
+        int (*cmp)(V, V);                                                       \
+                                                                                \
+        /* Function that returns an iterator to the start of the sorted list */ \
+        struct SNAME##_iter_s (*it_start)(struct SNAME##_s *);                  \
+                                                                                \
+        /* Function that returns an iterator to the end of the sorted list */   \
+        struct SNAME##_iter_s (*it_end)(struct SNAME##_s *);                    \
+                                                                                \
+    } SNAME, *SNAME##_ptr;                                                      \
+                                                                                \
+    /* SortedList Iterator */                                                   \
+    typedef struct SNAME##_iter_s                                               \
+    {                                                                           \
+        /* Target sorted list */                                                \
+        struct SNAME##_s *target;                                               \
+                                                                                \
+        /* Cursor's position (index) */                                         \
+        size_t cursor;                                                          \
+                                                                                \
+        /* If the iterator has reached the start of the iteration */            \
+        bool start;                                                             \
+                                                                                \
+        /* If the iterator has reached the end of the iteration */              \
+        bool end;                                                               \
+                                                                                \
+    } SNAME##_iter, *SNAME##_iter_ptr;                                          \
+                                                                                \
+    /* Collection Functions */                                                  \
+    /* Collection Allocation and Deallocation */                                \
+    FMOD SNAME PFX##_new(int (*compare)(V, V));                                 \
+    FMOD void PFX##_clear(SNAME *_list_);                                       \
+    /* Collection Input and Output */                                           \
+    FMOD bool PFX##_insert(SNAME *_list_, V element);                           \
+    FMOD bool PFX##_remove(SNAME *_list_, size_t index);                        \
+    /* Element Access */                                                        \
+    FMOD bool PFX##_max(SNAME *_list_, V *result);                              \
+    FMOD bool PFX##_min(SNAME *_list_, V *result);                              \
+    FMOD V PFX##_get(SNAME *_list_, size_t index);                              \
+    FMOD size_t PFX##_indexof(SNAME *_list_, V element, bool from_start);       \
+    /* Collection State */                                                      \
+    FMOD bool PFX##_contains(SNAME *_list_, V element);                         \
+    FMOD bool PFX##_empty(SNAME *_list_);                                       \
+    FMOD bool PFX##_full(SNAME *_list_);                                        \
+    FMOD size_t PFX##_count(SNAME *_list_);                                     \
+    FMOD size_t PFX##_capacity(void);                                           \
+                                                                                \
+    /* Iterator Functions */                                                    \
+    /* Iterator Initialization */                                               \
+    FMOD void PFX##_iter_init(SNAME##_iter *iter, SNAME *target);               \
+    /* Iterator State */                                                        \
+    FMOD bool PFX##_iter_start(SNAME##_iter *iter);                             \
+    FMOD bool PFX##_iter_end(SNAME##_iter *iter);                               \
+    /* Iterator Movement */                                                     \
+    FMOD void PFX##_iter_to_start(SNAME##_iter *iter);                          \
+    FMOD void PFX##_iter_to_end(SNAME##_iter *iter);                            \
+    FMOD bool PFX##_iter_next(SNAME##_iter *iter);                              \
+    FMOD bool PFX##_iter_prev(SNAME##_iter *iter);                              \
+    /* Iterator Access */                                                       \
+    FMOD V PFX##_iter_value(SNAME##_iter *iter);                                \
+    FMOD V *PFX##_iter_rvalue(SNAME##_iter *iter);                              \
+    FMOD size_t PFX##_iter_index(SNAME##_iter *iter);                           \
+                                                                                \
+    /* Default Value */                                                         \
+    static inline V PFX##_impl_default_value(void)                              \
+    {                                                                           \
+        V _empty_value_;                                                        \
+                                                                                \
+        memset(&_empty_value_, 0, sizeof(V));                                   \
+                                                                                \
+        return _empty_value_;                                                   \
+    }
+
+/* SOURCE ********************************************************************/
+#define SAC_SORTEDLIST_GENERATE_SOURCE(PFX, SNAME, FMOD, V, SIZE)                       \
+                                                                                        \
+    /* Implementation Detail Functions */                                               \
+    static size_t PFX##_impl_lower_bound(SNAME *_list_, V element);                     \
+    static size_t PFX##_impl_upper_bound(SNAME *_list_, V element);                     \
+    static SNAME##_iter PFX##_impl_it_start(SNAME *_list_);                             \
+    static SNAME##_iter PFX##_impl_it_end(SNAME *_list_);                               \
+                                                                                        \
+    FMOD SNAME PFX##_new(int (*compare)(V, V))                                          \
+    {                                                                                   \
+        SNAME result;                                                                   \
+                                                                                        \
+        memset(&result, 0, sizeof(SNAME));                                              \
+                                                                                        \
+        result.cmp = compare;                                                           \
+                                                                                        \
+        result.it_start = PFX##_impl_it_start;                                          \
+        result.it_end = PFX##_impl_it_end;                                              \
+                                                                                        \
+        return result;                                                                  \
+    }                                                                                   \
+                                                                                        \
+    FMOD void PFX##_clear(SNAME *_list_)                                                \
+    {                                                                                   \
+        memset(_list_->buffer, 0, sizeof(_list_->buffer));                              \
+                                                                                        \
+        _list_->count = 0;                                                              \
+    }                                                                                   \
+                                                                                        \
+    /* Equal elements keep the order in which they were inserted */                     \
+    FMOD bool PFX##_insert(SNAME *_list_, V element)                                    \
+    {                                                                                   \
+        if (PFX##_full(_list_))                                                         \
+            return false;                                                               \
+                                                                                        \
+        size_t index = PFX##_impl_upper_bound(_list_, element);                         \
+                                                                                        \
+        memmove(_list_->buffer + index + 1, _list_->buffer + index,                     \
+                (_list_->count - index) * sizeof(V));                                   \
+                                                                                        \
+        _list_->buffer[index] = element;                                                \
+        _list_->count++;                                                                \
+                                                                                        \
+        return true;                                                                    \
+    }                                                                                   \
+                                                                                        \
+    FMOD bool PFX##_remove(SNAME *_list_, size_t index)                                 \
+    {                                                                                   \
+        if (index >= _list_->count)                                                     \
+            return false;                                                               \
+                                                                                        \
+        memmove(_list_->buffer + index, _list_->buffer + index + 1,                     \
+                (_list_->count - index - 1) * sizeof(V));                               \
+                                                                                        \
+        _list_->buffer[--_list_->count] = PFX##_impl_default_value();                   \
+                                                                                        \
+        return true;                                                                    \
+    }                                                                                   \
+                                                                                        \
+    FMOD bool PFX##_max(SNAME *_list_, V *result)                                       \
+    {                                                                                   \
+        if (PFX##_empty(_list_))                                                        \
+            return false;                                                               \
+                                                                                        \
+        *result = _list_->buffer[_list_->count - 1];                                    \
+                                                                                        \
+        return true;                                                                    \
+    }                                                                                   \
+                                                                                        \
+    FMOD bool PFX##_min(SNAME *_list_, V *result)                                       \
+    {                                                                                   \
+        if (PFX##_empty(_list_))                                                        \
+            return false;                                                               \
+                                                                                        \
+        *result = _list_->buffer[0];                                                    \
+                                                                                        \
+        return true;                                                                    \
+    }                                                                                   \
+                                                                                        \
+    FMOD V PFX##_get(SNAME *_list_, size_t index)                                       \
+    {                                                                                   \
+        if (index >= _list_->count)                                                     \
+            return PFX##_impl_default_value();                                          \
+                                                                                        \
+        return _list_->buffer[index];                                                   \
+    }                                                                                   \
+                                                                                        \
+    /* Returns the count of the list if the element is not found */                     \
+    FMOD size_t PFX##_indexof(SNAME *_list_, V element, bool from_start)                \
+    {                                                                                   \
+        size_t index = from_start ? PFX##_impl_lower_bound(_list_, element)             \
+                                  : PFX##_impl_upper_bound(_list_, element);            \
+                                                                                        \
+        if (!from_start)                                                                \
+        {                                                                               \
+            if (index == 0)                                                             \
+                return _list_->count;                                                   \
+                                                                                        \
+            index--;                                                                    \
+        }                                                                               \
+                                                                                        \
+        if (index >= _list_->count || _list_->cmp(_list_->buffer[index], element) != 0) \
+            return _list_->count;                                                       \
+                                                                                        \
+        return index;                                                                   \
+    }                                                                                   \
+                                                                                        \
+    FMOD bool PFX##_contains(SNAME *_list_, V element)                                  \
+    {                                                                                   \
+        return PFX##_indexof(_list_, element, true) != _list_->count;                   \
+    }                                                                                   \
+                                                                                        \
+    FMOD bool PFX##_empty(SNAME *_list_)                                                \
+    {                                                                                   \
+        return _list_->count == 0;                                                      \
+    }                                                                                   \
+                                                                                        \
+    FMOD bool PFX##_full(SNAME *_list_)                                                 \
+    {                                                                                   \
+        return _list_->count >= SIZE;                                                   \
+    }                                                                                   \
+                                                                                        \
+    FMOD size_t PFX##_count(SNAME *_list_)                                              \
+    {                                                                                   \
+        return _list_->count;                                                           \
+    }                                                                                   \
+                                                                                        \
+    FMOD size_t PFX##_capacity(void)                                                    \
+    {                                                                                   \
+        return SIZE;                                                                    \
+    }                                                                                   \
+                                                                                        \
+    FMOD void PFX##_iter_init(SNAME##_iter *iter, SNAME *target)                        \
+    {                                                                                   \
+        iter->target = target;                                                          \
+        iter->cursor = 0;                                                               \
+        iter->start = true;                                                             \
+        iter->end = PFX##_empty(target);                                                \
+    }                                                                                   \
+                                                                                        \
+    FMOD bool PFX##_iter_start(SNAME##_iter *iter)                                      \
+    {                                                                                   \
+        return PFX##_empty(iter->target) || iter->start;                                \
+    }                                                                                   \
+                                                                                        \
+    FMOD bool PFX##_iter_end(SNAME##_iter *iter)                                        \
+    {                                                                                   \
+        return PFX##_empty(iter->target) || iter->end;                                  \
+    }                                                                                   \
+                                                                                        \
+    FMOD void PFX##_iter_to_start(SNAME##_iter *iter)                                   \
+    {                                                                                   \
+        iter->cursor = 0;                                                               \
+        iter->start = true;                                                             \
+        iter->end = PFX##_empty(iter->target);                                          \
+    }                                                                                   \
+                                                                                        \
+    FMOD void PFX##_iter_to_end(SNAME##_iter *iter)                                     \
+    {                                                                                   \
+        iter->cursor = PFX##_empty(iter->target) ? 0 : iter->target->count - 1;         \
+        iter->start = PFX##_empty(iter->target);                                        \
+        iter->end = true;                                                               \
+    }                                                                                   \
+                                                                                        \
+    FMOD bool PFX##_iter_next(SNAME##_iter *iter)                                       \
+    {                                                                                   \
+        if (iter->end)                                                                  \
+            return false;                                                               \
+                                                                                        \
+        iter->start = PFX##_empty(iter->target);                                        \
+                                                                                        \
+        if (iter->cursor == iter->target->count - 1)                                    \
+            iter->end = true;                                                           \
+        else                                                                            \
+            iter->cursor++;                                                             \
+                                                                                        \
+        return true;                                                                    \
+    }                                                                                   \
+                                                                                        \
+    FMOD bool PFX##_iter_prev(SNAME##_iter *iter)                                       \
+    {                                                                                   \
+        if (iter->start)                                                                \
+            return false;                                                               \
+                                                                                        \
+        iter->end = PFX##_empty(iter->target);                                          \
+                                                                                        \
+        if (iter->cursor == 0)                                                          \
+            iter->start = true;                                                         \
+        else                                                                            \
+            iter->cursor--;                                                             \
+                                                                                        \
+        return true;                                                                    \
+    }                                                                                   \
+                                                                                        \
+    FMOD V PFX##_iter_value(SNAME##_iter *iter)                                         \
+    {                                                                                   \
+        if (PFX##_empty(iter->target))                                                  \
+            return PFX##_impl_default_value();                                          \
+                                                                                        \
+        return iter->target->buffer[iter->cursor];                                      \
+    }                                                                                   \
+                                                                                        \
+    FMOD V *PFX##_iter_rvalue(SNAME##_iter *iter)                                       \
+    {                                                                                   \
+        if (PFX##_empty(iter->target))                                                  \
+            return NULL;                                                                \
+                                                                                        \
+        return &(iter->target->buffer[iter->cursor]);                                   \
+    }                                                                                   \
+                                                                                        \
+    FMOD size_t PFX##_iter_index(SNAME##_iter *iter)                                    \
+    {                                                                                   \
+        return iter->cursor;                                                            \
+    }                                                                                   \
+                                                                                        \
+    /* Index of the first element that is not less than element */                      \
+    static size_t PFX##_impl_lower_bound(SNAME *_list_, V element)                      \
+    {                                                                                   \
+        size_t low = 0;                                                                 \
+        size_t high = _list_->count;                                                    \
+                                                                                        \
+        while (low < high)                                                              \
+        {                                                                               \
+            size_t mid = low + (high - low) / 2;                                        \
+                                                                                        \
+            if (_list_->cmp(_list_->buffer[mid], element) < 0)                          \
+                low = mid + 1;                                                          \
+            else                                                                        \
+                high = mid;                                                             \
+        }                                                                               \
+                                                                                        \
+        return low;                                                                     \
+    }                                                                                   \
+                                                                                        \
+    /* Index of the first element that is greater than element */                       \
+    static size_t PFX##_impl_upper_bound(SNAME *_list_, V element)                      \
+    {                                                                                   \
+        size_t low = 0;                                                                 \
+        size_t high = _list_->count;                                                    \
+                                                                                        \
+        while (low < high)                                                              \
+        {                                                                               \
+            size_t mid = low + (high - low) / 2;                                        \
+                                                                                        \
+            if (_list_->cmp(_list_->buffer[mid], element) <= 0)                         \
+                low = mid + 1;                                                          \
+            else                                                                        \
+                high = mid;                                                             \
+        }                                                                               \
+                                                                                        \
+        return low;                                                                     \
+    }                                                                                   \
+                                                                                        \
+    static SNAME##_iter PFX##_impl_it_start(SNAME *_list_)                              \
+    {                                                                                   \
+        SNAME##_iter iter;                                                              \
+                                                                                        \
+        PFX##_iter_init(&iter, _list_);                                                 \
+        PFX##_iter_to_start(&iter);                                                     \
+                                                                                        \
+        return iter;                                                                    \
+    }                                                                                   \
+                                                                                        \
+    static SNAME##_iter PFX##_impl_it_end(SNAME *_list_)                                \
+    {                                                                                   \
+        SNAME##_iter iter;                                                              \
+                                                                                        \
+        PFX##_iter_init(&iter, _list_);                                                 \
+        PFX##_iter_to_end(&iter);                                                       \
+                                                                                        \
+        return iter;                                                                    \
+    }
+
+#endif /* CMC_SAC_SORTEDLIST_H */
@@ -0,0 +1,211 @@
+/**
+ * spscqueue.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * A Purely Stack Allocated Single-Producer Single-Consumer Queue
+ *
+ * Same as the stack allocated Queue, but one thread can enqueue elements
+ * while another thread dequeues them, without any locks. Only one thread
+ * may call the producer functions (push) and only one thread may call the
+ * consumer functions (pop and peek) at a time. count, empty and capacity
+ * can be called by either of them.
+ *
+ * Implementation
+ *
+ * The head and tail indices are incremented without wrapping around and are
+ * reduced to a position of the buffer with a mask, so SIZE has to be a
+ * power of two. The producer only writes the tail and the consumer only the
+ * head, published with release stores and read with acquire loads, and each
+ * of them is on its own cache line together with the last value read of the
+ * other index. The other index is only read again when that cached value
+ * shows the queue full, for the producer, or empty, for the consumer.
+ *
+ * The structure is aligned to the cache line size, so it should be a global
+ * or a local variable, or be allocated with aligned_alloc. It can't be
+ * returned by value, so it is initialized in place by PFX##_init.
+ */
+
+#ifndef CMC_SAC_SPSCQUEUE_H
+#define CMC_SAC_SPSCQUEUE_H
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifndef CMC_CACHE_LINE_SIZE
+#define CMC_CACHE_LINE_SIZE 64
+#endif
+
+#define SAC_SPSC_QUEUE_GENERATE(PFX, SNAME, FMOD, V, SIZE)    \
+    SAC_SPSC_QUEUE_GENERATE_HEADER(PFX, SNAME, FMOD, V, SIZE) \
+    SAC_SPSC_QUEUE_GENERATE_SOURCE(PFX, SNAME, FMOD, V, SIZE)
+
+#define SAC_SPSC_QUEUE_WRAPGEN_HEADER(PFX, SNAME, FMOD, K, V, SIZE) \
+    SAC_SPSC_QUEUE_GENERATE_HEADER(PFX, SNAME, FMOD, V, SIZE)
+
+#define SAC_SPSC_QUEUE_WRAPGEN_SOURCE(PFX, SNAME, FMOD, K, V, SIZE) \
+    SAC_SPSC_QUEUE_GENERATE_SOURCE(PFX, SNAME, FMOD, V, SIZE)
+
+/* HEADER ********************************************************************/
+#define SAC_SPSC_QUEUE_GENERATE_HEADER(PFX, SNAME, FMOD, V, SIZE)                \
+    _Static_assert((SIZE) > 0 && ((SIZE) & ((SIZE)-1)) == 0,                     \
+                   #SNAME " SIZE has to be a power of two");                     \
+                                                                                 \
+    /* Queue Structure */                                                        \
+    typedef struct SNAME##_s                                                     \
+    {                                                                            \
+        /* Index of the next element to be enqueued, written by the producer */  \
+        _Alignas(CMC_CACHE_LINE_SIZE) atomic_size_t tail;                        \
+                                                                                 \
+        /* Last value of head read by the producer */                            \
+        size_t head_cache;                                                       \
+                                                                                 \
+        /* Index of the next element to be dequeued, written by the consumer */  \
+        _Alignas(CMC_CACHE_LINE_SIZE) atomic_size_t head;                        \
+                                                                                 \
+        /* Last value of tail read by the consumer */                            \
+        size_t tail_cache;                                                       \
+                                                                                 \
+        /* Internal Storage */                                                   \
+        _Alignas(CMC_CACHE_LINE_SIZE) V buffer[SIZE];                            \
+                                                                                 \
+    } SNAME, *SNAME##_ptr;                                                       \
+                                                                                 \
+    /* Collection Functions */                                                   \
+    /* Collection Initialization */                                              \
+    FMOD void PFX##_init(SNAME *_queue_);                                        \
+    /* Producer Functions */                                                     \
+    FMOD bool PFX##_push(SNAME *_queue_, V element);                             \
+    FMOD size_t PFX##_push_many(SNAME *_queue_, const V *elements, size_t size); \
+    /* Consumer Functions */                                                     \
+    FMOD bool PFX##_pop(SNAME *_queue_, V *result);                              \
+    FMOD size_t PFX##_pop_many(SNAME *_queue_, V *elements, size_t size);        \
+    FMOD bool PFX##_peek(SNAME *_queue_, V *result);                             \
+    /* Collection State */                                                       \
+    FMOD size_t PFX##_count(SNAME *_queue_);                                     \
+    FMOD bool PFX##_empty(SNAME *_queue_);                                       \
+    FMOD size_t PFX##_capacity(void);                                            \
+                                                                                 \
+/* SOURCE ********************************************************************/
+#define SAC_SPSC_QUEUE_GENERATE_SOURCE(PFX, SNAME, FMOD, V, SIZE)                               \
+    /* Not thread safe, has to be called before the queue is shared */                          \
+    FMOD void PFX##_init(SNAME *_queue_)                                                        \
+    {                                                                                           \
+        atomic_init(&(_queue_->tail), 0);                                                       \
+        atomic_init(&(_queue_->head), 0);                                                       \
+                                                                                                \
+        _queue_->head_cache = 0;                                                                \
+        _queue_->tail_cache = 0;                                                                \
+    }                                                                                           \
+                                                                                                \
+    FMOD bool PFX##_push(SNAME *_queue_, V element)                                             \
+    {                                                                                           \
+        return PFX##_push_many(_queue_, &element, 1) == 1;                                      \
+    }                                                                                           \
+                                                                                                \
+    /* Enqueues as many of the size elements as fit, in order, and returns */                   \
+    /* how many were enqueued */                                                                \
+    FMOD size_t PFX##_push_many(SNAME *_queue_, const V *elements, size_t size)                 \
+    {                                                                                           \
+        size_t tail = atomic_load_explicit(&(_queue_->tail), memory_order_relaxed);             \
+                                                                                                \
+        if (SIZE - (tail - _queue_->head_cache) < size)                                         \
+            _queue_->head_cache = atomic_load_explicit(&(_queue_->head), memory_order_acquire); \
+                                                                                                \
+        size_t space = SIZE - (tail - _queue_->head_cache);                                     \
+                                                                                                \
+        if (size > space)                                                                       \
+            size = space;                                                                       \
+                                                                                                \
+        if (size == 0)                                                                          \
+            return 0;                                                                           \
+                                                                                                \
+        size_t position = tail & (SIZE - 1);                                                    \
+        size_t first = SIZE - position < size ? SIZE - position : size;                         \
+                                                                                                \
+        memcpy(_queue_->buffer + position, elements, first * sizeof(V));                        \
+        memcpy(_queue_->buffer, elements + first, (size - first) * sizeof(V));                  \
+                                                                                                \
+        atomic_store_explicit(&(_queue_->tail), tail + size, memory_order_release);             \
+                                                                                                \
+        return size;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    FMOD bool PFX##_pop(SNAME *_queue_, V *result)                                              \
+    {                                                                                           \
+        return PFX##_pop_many(_queue_, result, 1) == 1;                                         \
+    }                                                                                           \
+                                                                                                \
+    /* Dequeues up to size elements into elements and returns how many were */                  \
+    /* dequeued */                                                                              \
+    FMOD size_t PFX##_pop_many(SNAME *_queue_, V *elements, size_t size)                        \
+    {                                                                                           \
+        size_t head = atomic_load_explicit(&(_queue_->head), memory_order_relaxed);             \
+                                                                                                \
+        if (_queue_->tail_cache - head < size)                                                  \
+            _queue_->tail_cache = atomic_load_explicit(&(_queue_->tail), memory_order_acquire); \
+                                                                                                \
+        size_t available = _queue_->tail_cache - head;                                          \
+                                                                                                \
+        if (size > available)                                                                   \
+            size = available;                                                                   \
+                                                                                                \
+        if (size == 0)                                                                          \
+            return 0;                                                                           \
+                                                                                                \
+        size_t position = head & (SIZE - 1);                                                    \
+        size_t first = SIZE - position < size ? SIZE - position : size;                         \
+                                                                                                \
+        memcpy(elements, _queue_->buffer + position, first * sizeof(V));                        \
+        memcpy(elements + first, _queue_->buffer, (size - first) * sizeof(V));                  \
+                                                                                                \
+        atomic_store_explicit(&(_queue_->head), head + size, memory_order_release);             \
+                                                                                                \
+        return size;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    FMOD bool PFX##_peek(SNAME *_queue_, V *result)                                             \
+    {                                                                                           \
+        size_t head = atomic_load_explicit(&(_queue_->head), memory_order_relaxed);             \
+                                                                                                \
+        if (_queue_->tail_cache == head)                                                        \
+        {                                                                                       \
+            _queue_->tail_cache = atomic_load_explicit(&(_queue_->tail), memory_order_acquire); \
+                                                                                                \
+            if (_queue_->tail_cache == head)                                                    \
+                return false;                                                                   \
+        }                                                                                       \
+                                                                                                \
+        *result = _queue_->buffer[head & (SIZE - 1)];                                           \
+                                                                                                \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    /* Only exact if the other thread is not pushing or popping */                              \
+    FMOD size_t PFX##_count(SNAME *_queue_)                                                     \
+    {                                                                                           \
+        size_t head = atomic_load_explicit(&(_queue_->head), memory_order_acquire);             \
+        size_t tail = atomic_load_explicit(&(_queue_->tail), memory_order_acquire);             \
+                                                                                                \
+        return tail - head;                                                                     \
+    }                                                                                           \
+                                                                                                \
+    FMOD bool PFX##_empty(SNAME *_queue_)                                                       \
+    {                                                                                           \
+        return PFX##_count(_queue_) == 0;                                                       \
+    }                                                                                           \
+                                                                                                \
+    FMOD size_t PFX##_capacity(void)                                                            \
+    {                                                                                           \
+        return SIZE;                                                                            \
+    }
+
+#endif /* CMC_SAC_SPSCQUEUE_H */
@@ -0,0 +1,810 @@
+/**
+ * treemap.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * A Purely Stack Allocated TreeMap
+ *
+ * This means that the TreeMap has a fixed amount of nodes, but it also has
+ * the advantage of not requiring for manually allocating and deallocating the
+ * struct. No function calls the allocator so it can be used where malloc is
+ * not available or not allowed.
+ *
+ * Keys are kept sorted in an AVL tree, like in the TreeMap, but its nodes are
+ * the SIZE elements of an array inside the struct and link to each other by
+ * their index in it. Indexes are CMC_SAC_TREE_INDEX, which can be defined as
+ * a smaller type than uint32_t if SIZE fits in it, and SIZE itself is the
+ * index of no node. Removed nodes are kept in a free list, linked by their
+ * right child, and reused before any node that was never taken.
+ *
+ * Generating a collection with too big of a storage can be dangerous and might
+ * quickly cause a stack overflow.
+ */
+
+#ifndef CMC_SAC_TREEMAP_H
+#define CMC_SAC_TREEMAP_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Also used by sac/treeset.h */
+#ifndef CMC_SAC_TREE_INDEX
+#define CMC_SAC_TREE_INDEX uint32_t
+#endif
+
+#define SAC_TREEMAP_GENERATE(PFX, SNAME, FMOD, K, V, SIZE)    \
+    SAC_TREEMAP_GENERATE_HEADER(PFX, SNAME, FMOD, K, V, SIZE) \
+    SAC_TREEMAP_GENERATE_SOURCE(PFX, SNAME, FMOD, K, V, SIZE)
+
+#define SAC_TREEMAP_WRAPGEN_HEADER(PFX, SNAME, FMOD, K, V, SIZE) \
+    SAC_TREEMAP_GENERATE_HEADER(PFX, SNAME, FMOD, K, V, SIZE)
+
+#define SAC_TREEMAP_WRAPGEN_SOURCE(PFX, SNAME, FMOD, K, V, SIZE) \
+    SAC_TREEMAP_GENERATE_SOURCE(PFX, SNAME, FMOD, K, V, SIZE)
+
+/* HEADER ********************************************************************/
+#define SAC_TREEMAP_GENERATE_HEADER(PFX, SNAME, FMOD, K, V, SIZE)           \
+                                                                            \
+    /* TreeMap Node */                                                      \
+    typedef struct SNAME##_node_s                                           \
+    {                                                                       \
+        /* Node key */                                                      \
+        K key;                                                              \
+                                                                            \
+        /* Node value */                                                    \
+        V value;                                                            \
+                                                                            \
+        /* Node height used by the AVL tree to keep it strictly balanced */ \
+        unsigned char height;                                               \
+                                                                            \
+        /* Index of the left child, the right child and the parent */       \
+        CMC_SAC_TREE_INDEX left;                                            \
+        CMC_SAC_TREE_INDEX right;                                           \
+        CMC_SAC_TREE_INDEX parent;                                          \
+                                                                            \
+    } SNAME##_node, *SNAME##_node_ptr;                                      \
+                                                                            \
+    /* TreeMap Structure */                                                 \
+    typedef struct SNAME##_s                                                \
+    {                                                                       \
+        /* Internal Storage */                                              \
+        SNAME##_node nodes[SIZE];                                           \
+                                                                            \
+        /* Index of the root node */                                        \
+        CMC_SAC_TREE_INDEX root;                                            \
+                                                                            \
+        /* First node of the free list */                                   \
+        CMC_SAC_TREE_INDEX free;                                            \
+                                                                            \
+        /* Nodes from this index on were never taken */                     \
+        size_t used;                                                        \
+                                                                            \
+        /* Current amount of keys */                                        \
+        size_t count;                                                       \
+                                                                            \
+        /* Key comparison function */                                       \
+        int (*cmp)(K, K);                                                   \
+                                                                            \
+        /* Function that returns an iterator to the start of the treemap */ \
+        struct SNAME##_iter_s (*it_start)(struct SNAME##_s *);              \
+                                                                            \
+        /* Function that returns an iterator to the end of the treemap */   \
+        struct SNAME##_iter_s (*it_end)(struct SNAME##_s *);                \
+                                                                            \
+    } SNAME, *SNAME##_ptr;                                                  \
+                                                                            \
+    /* TreeMap Iterator */                                                  \
+    typedef struct SNAME##_iter_s                                           \
+    {                                                                       \
+        /* Target treemap */                                                \
+        struct SNAME##_s *target;                                           \
+                                                                            \
+        /* Cursor's position (index of a node) */                           \
+        size_t cursor;                                                      \
+                                                                            \
+        /* Keeps track of relative index to the iteration of elements */    \
+        size_t index;                                                       \
+                                                                            \
+        /* The node with the smallest key */                                \
+        size_t first;                                                       \
+                                                                            \
+        /* The node with the greatest key */                                \
+        size_t last;                                                        \
+                                                                            \
+        /* If the iterator has reached the start of the iteration */        \
+        bool start;                                                         \
+                                                                            \
+        /* If the iterator has reached the end of the iteration */          \
+        bool end;                                                           \
+                                                                            \
+    } SNAME##_iter, *SNAME##_iter_ptr;                                      \
+                                                                            \
+    /* Collection Functions */                                              \
+    /* Collection Allocation and Deallocation */                            \
+    FMOD SNAME PFX##_new(int (*compare)(K, K));                             \
+    FMOD void PFX##_clear(SNAME *_map_);                                    \
+    /* Collection Input and Output */                                       \
+    FMOD bool PFX##_insert(SNAME *_map_, K key, V value);                   \
+    FMOD bool PFX##_update(SNAME *_map_, K key, V new_value, V *old_value); \
+    FMOD bool PFX##_remove(SNAME *_map_, K key, V *out_value);              \
+    /* Element Access */                                                    \
+    FMOD bool PFX##_max(SNAME *_map_, K *key, V *value);                    \
+    FMOD bool PFX##_min(SNAME *_map_, K *key, V *value);                    \
+    FMOD bool PFX##_floor(SNAME *_map_, K key, K *out_key, V *out_value);   \
+    FMOD bool PFX##_ceiling(SNAME *_map_, K key, K *out_key, V *out_value); \
+    FMOD V PFX##_get(SNAME *_map_, K key);                                  \
+    FMOD V *PFX##_get_ref(SNAME *_map_, K key);                             \
+    /* Collection State */                                                  \
+    FMOD bool PFX##_contains(SNAME *_map_, K key);                          \
+    FMOD bool PFX##_empty(SNAME *_map_);                                    \
+    FMOD bool PFX##_full(SNAME *_map_);                                     \
+    FMOD size_t PFX##_count(SNAME *_map_);                                  \
+    FMOD size_t PFX##_capacity(void);                                       \
+                                                                            \
+    /* Iterator Functions */                                                \
+    /* Iterator Initialization */                                           \
+    FMOD void PFX##_iter_init(SNAME##_iter *iter, SNAME *target);           \
+    /* Iterator State */                                                    \
+    FMOD bool PFX##_iter_start(SNAME##_iter *iter);                         \
+    FMOD bool PFX##_iter_end(SNAME##_iter *iter);                           \
+    /* Iterator Movement */                                                 \
+    FMOD void PFX##_iter_to_start(SNAME##_iter *iter);                      \
+    FMOD void PFX##_iter_to_end(SNAME##_iter *iter);                        \
+    FMOD bool PFX##_iter_next(SNAME##_iter *iter);                          \
+    FMOD bool PFX##_iter_prev(SNAME##_iter *iter);                          \
+    /* Iterator Access */                                                   \
+    FMOD K PFX##_iter_key(SNAME##_iter *iter);                              \
+    FMOD V PFX##_iter_value(SNAME##_iter *iter);                            \
+    FMOD V *PFX##_iter_rvalue(SNAME##_iter *iter);                          \
+    FMOD size_t PFX##_iter_index(SNAME##_iter *iter);                       \
+                                                                            \
+    /* Default Key */                                                       \
+    static inline K PFX##_impl_default_key(void)                            \
+    {                                                                       \
+        K _empty_key_;                                                      \
+                                                                            \
+        memset(&_empty_key_, 0, sizeof(K));                                 \
+                                                                            \
+        return _empty_key_;                                                 \
+    }                                                                       \
+                                                                            \
+    /* Default Value */                                                     \
+    static inline V PFX##_impl_default_value(void)                          \
+    {                                                                       \
+        V _empty_value_;                                                    \
+                                                                            \
+        memset(&_empty_value_, 0, sizeof(V));                               \
+                                                                            \
+        return _empty_value_;                                               \
+    }
+
+/* SOURCE ********************************************************************/
+#define SAC_TREEMAP_GENERATE_SOURCE(PFX, SNAME, FMOD, K, V, SIZE)                           \
+                                                                                            \
+    /* Implementation Detail Functions */                                                   \
+    static size_t PFX##_impl_get_node(SNAME *_map_, K key);                                 \
+    static size_t PFX##_impl_new_node(SNAME *_map_);                                        \
+    static void PFX##_impl_set_child(SNAME *_map_, size_t parent, size_t old, size_t node); \
+    static unsigned char PFX##_impl_h(SNAME *_map_, size_t node);                           \
+    static void PFX##_impl_hupdate(SNAME *_map_, size_t node);                              \
+    static size_t PFX##_impl_rotate_right(SNAME *_map_, size_t node);                       \
+    static size_t PFX##_impl_rotate_left(SNAME *_map_, size_t node);                        \
+    static void PFX##_impl_rebalance(SNAME *_map_, size_t node);                            \
+    static size_t PFX##_impl_first(SNAME *_map_, size_t node);                              \
+    static size_t PFX##_impl_last(SNAME *_map_, size_t node);                               \
+    static size_t PFX##_impl_next(SNAME *_map_, size_t node);                               \
+    static size_t PFX##_impl_prev(SNAME *_map_, size_t node);                               \
+    static SNAME##_iter PFX##_impl_it_start(SNAME *_map_);                                  \
+    static SNAME##_iter PFX##_impl_it_end(SNAME *_map_);                                    \
+                                                                                            \
+    FMOD SNAME PFX##_new(int (*compare)(K, K))                                              \
+    {                                                                                       \
+        SNAME result;                                                                       \
+                                                                                            \
+        memset(&result, 0, sizeof(SNAME));                                                  \
+                                                                                            \
+        result.root = (SIZE);                                                               \
+        result.free = (SIZE);                                                               \
+        result.cmp = compare;                                                               \
+                                                                                            \
+        result.it_start = PFX##_impl_it_start;                                              \
+        result.it_end = PFX##_impl_it_end;                                                  \
+                                                                                            \
+        return result;                                                                      \
+    }                                                                                       \
+                                                                                            \
+    FMOD void PFX##_clear(SNAME *_map_)                                                     \
+    {                                                                                       \
+        memset(_map_->nodes, 0, sizeof(_map_->nodes));                                      \
+                                                                                            \
+        _map_->root = (SIZE);                                                               \
+        _map_->free = (SIZE);                                                               \
+        _map_->used = 0;                                                                    \
+        _map_->count = 0;                                                                   \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_insert(SNAME *_map_, K key, V value)                                    \
+    {                                                                                       \
+        size_t parent = (SIZE);                                                             \
+        size_t scan = _map_->root;                                                          \
+                                                                                            \
+        int c = 0;                                                                          \
+                                                                                            \
+        while (scan != (SIZE))                                                              \
+        {                                                                                   \
+            c = _map_->cmp(key, _map_->nodes[scan].key);                                    \
+                                                                                            \
+            if (c == 0)                                                                     \
+                return false;                                                               \
+                                                                                            \
+            parent = scan;                                                                  \
+            scan = c < 0 ? _map_->nodes[scan].left : _map_->nodes[scan].right;              \
+        }                                                                                   \
+                                                                                            \
+        size_t index = PFX##_impl_new_node(_map_);                                          \
+                                                                                            \
+        if (index == (SIZE))                                                                \
+            return false;                                                                   \
+                                                                                            \
+        SNAME##_node *node = &(_map_->nodes[index]);                                        \
+                                                                                            \
+        node->key = key;                                                                    \
+        node->value = value;                                                                \
+        node->height = 1;                                                                   \
+        node->left = (SIZE);                                                                \
+        node->right = (SIZE);                                                               \
+        node->parent = (CMC_SAC_TREE_INDEX)parent;                                          \
+                                                                                            \
+        if (parent == (SIZE))                                                               \
+            _map_->root = (CMC_SAC_TREE_INDEX)index;                                        \
+        else if (c < 0)                                                                     \
+            _map_->nodes[parent].left = (CMC_SAC_TREE_INDEX)index;                          \
+        else                                                                                \
+            _map_->nodes[parent].right = (CMC_SAC_TREE_INDEX)index;                         \
+                                                                                            \
+        _map_->count++;                                                                     \
+                                                                                            \
+        PFX##_impl_rebalance(_map_, parent);                                                \
+                                                                                            \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_update(SNAME *_map_, K key, V new_value, V *old_value)                  \
+    {                                                                                       \
+        size_t node = PFX##_impl_get_node(_map_, key);                                      \
+                                                                                            \
+        if (node == (SIZE))                                                                 \
+            return false;                                                                   \
+                                                                                            \
+        if (old_value)                                                                      \
+            *old_value = _map_->nodes[node].value;                                          \
+                                                                                            \
+        _map_->nodes[node].value = new_value;                                               \
+                                                                                            \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_remove(SNAME *_map_, K key, V *out_value)                               \
+    {                                                                                       \
+        size_t node = PFX##_impl_get_node(_map_, key);                                      \
+                                                                                            \
+        if (node == (SIZE))                                                                 \
+            return false;                                                                   \
+                                                                                            \
+        if (out_value)                                                                      \
+            *out_value = _map_->nodes[node].value;                                          \
+                                                                                            \
+        /* A node with two children takes the key and value of its successor */             \
+        /* which is removed in its place */                                                 \
+        if (_map_->nodes[node].left != (SIZE) && _map_->nodes[node].right != (SIZE))        \
+        {                                                                                   \
+            size_t successor = PFX##_impl_first(_map_, _map_->nodes[node].right);           \
+                                                                                            \
+            _map_->nodes[node].key = _map_->nodes[successor].key;                           \
+            _map_->nodes[node].value = _map_->nodes[successor].value;                       \
+                                                                                            \
+            node = successor;                                                               \
+        }                                                                                   \
+                                                                                            \
+        SNAME##_node *target = &(_map_->nodes[node]);                                       \
+                                                                                            \
+        size_t child = target->left != (SIZE) ? target->left : target->right;               \
+        size_t parent = target->parent;                                                     \
+                                                                                            \
+        PFX##_impl_set_child(_map_, parent, node, child);                                   \
+                                                                                            \
+        if (child != (SIZE))                                                                \
+            _map_->nodes[child].parent = (CMC_SAC_TREE_INDEX)parent;                        \
+                                                                                            \
+        memset(target, 0, sizeof(SNAME##_node));                                            \
+                                                                                            \
+        target->right = _map_->free;                                                        \
+        _map_->free = (CMC_SAC_TREE_INDEX)node;                                             \
+                                                                                            \
+        _map_->count--;                                                                     \
+                                                                                            \
+        PFX##_impl_rebalance(_map_, parent);                                                \
+                                                                                            \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_max(SNAME *_map_, K *key, V *value)                                     \
+    {                                                                                       \
+        if (PFX##_empty(_map_))                                                             \
+            return false;                                                                   \
+                                                                                            \
+        SNAME##_node *node = &(_map_->nodes[PFX##_impl_last(_map_, _map_->root)]);          \
+                                                                                            \
+        if (key)                                                                            \
+            *key = node->key;                                                               \
+        if (value)                                                                          \
+            *value = node->value;                                                           \
+                                                                                            \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_min(SNAME *_map_, K *key, V *value)                                     \
+    {                                                                                       \
+        if (PFX##_empty(_map_))                                                             \
+            return false;                                                                   \
+                                                                                            \
+        SNAME##_node *node = &(_map_->nodes[PFX##_impl_first(_map_, _map_->root)]);         \
+                                                                                            \
+        if (key)                                                                            \
+            *key = node->key;                                                               \
+        if (value)                                                                          \
+            *value = node->value;                                                           \
+                                                                                            \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_floor(SNAME *_map_, K key, K *out_key, V *out_value)                    \
+    {                                                                                       \
+        size_t result = (SIZE);                                                             \
+        size_t scan = _map_->root;                                                          \
+                                                                                            \
+        /* The last node on the way down whose key is not greater */                        \
+        while (scan != (SIZE))                                                              \
+        {                                                                                   \
+            int c = _map_->cmp(_map_->nodes[scan].key, key);                                \
+                                                                                            \
+            if (c > 0)                                                                      \
+                scan = _map_->nodes[scan].left;                                             \
+            else                                                                            \
+            {                                                                               \
+                result = scan;                                                              \
+                                                                                            \
+                if (c == 0)                                                                 \
+                    break;                                                                  \
+                                                                                            \
+                scan = _map_->nodes[scan].right;                                            \
+            }                                                                               \
+        }                                                                                   \
+                                                                                            \
+        if (result == (SIZE))                                                               \
+            return false;                                                                   \
+                                                                                            \
+        if (out_key)                                                                        \
+            *out_key = _map_->nodes[result].key;                                            \
+        if (out_value)                                                                      \
+            *out_value = _map_->nodes[result].value;                                        \
+                                                                                            \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_ceiling(SNAME *_map_, K key, K *out_key, V *out_value)                  \
+    {                                                                                       \
+        size_t result = (SIZE);                                                             \
+        size_t scan = _map_->root;                                                          \
+                                                                                            \
+        /* The last node on the way down whose key is not less */                           \
+        while (scan != (SIZE))                                                              \
+        {                                                                                   \
+            int c = _map_->cmp(_map_->nodes[scan].key, key);                                \
+                                                                                            \
+            if (c < 0)                                                                      \
+                scan = _map_->nodes[scan].right;                                            \
+            else                                                                            \
+            {                                                                               \
+                result = scan;                                                              \
+                                                                                            \
+                if (c == 0)                                                                 \
+                    break;                                                                  \
+                                                                                            \
+                scan = _map_->nodes[scan].left;                                             \
+            }                                                                               \
+        }                                                                                   \
+                                                                                            \
+        if (result == (SIZE))                                                               \
+            return false;                                                                   \
+                                                                                            \
+        if (out_key)                                                                        \
+            *out_key = _map_->nodes[result].key;                                            \
+        if (out_value)                                                                      \
+            *out_value = _map_->nodes[result].value;                                        \
+                                                                                            \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    FMOD V PFX##_get(SNAME *_map_, K key)                                                   \
+    {                                                                                       \
+        size_t node = PFX##_impl_get_node(_map_, key);                                      \
+                                                                                            \
+        if (node == (SIZE))                                                                 \
+            return PFX##_impl_default_value();                                              \
+                                                                                            \
+        return _map_->nodes[node].value;                                                    \
+    }                                                                                       \
+                                                                                            \
+    FMOD V *PFX##_get_ref(SNAME *_map_, K key)                                              \
+    {                                                                                       \
+        size_t node = PFX##_impl_get_node(_map_, key);                                      \
+                                                                                            \
+        if (node == (SIZE))                                                                 \
+            return NULL;                                                                    \
+                                                                                            \
+        return &(_map_->nodes[node].value);                                                 \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_contains(SNAME *_map_, K key)                                           \
+    {                                                                                       \
+        return PFX##_impl_get_node(_map_, key) != (SIZE);                                   \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_empty(SNAME *_map_)                                                     \
+    {                                                                                       \
+        return _map_->count == 0;                                                           \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_full(SNAME *_map_)                                                      \
+    {                                                                                       \
+        return _map_->count >= SIZE;                                                        \
+    }                                                                                       \
+                                                                                            \
+    FMOD size_t PFX##_count(SNAME *_map_)                                                   \
+    {                                                                                       \
+        return _map_->count;                                                                \
+    }                                                                                       \
+                                                                                            \
+    FMOD size_t PFX##_capacity(void)                                                        \
+    {                                                                                       \
+        return SIZE;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    FMOD void PFX##_iter_init(SNAME##_iter *iter, SNAME *target)                            \
+    {                                                                                       \
+        iter->target = target;                                                              \
+        iter->first = PFX##_impl_first(target, target->root);                               \
+        iter->last = PFX##_impl_last(target, target->root);                                 \
+        iter->cursor = iter->first;                                                         \
+        iter->index = 0;                                                                    \
+        iter->start = true;                                                                 \
+        iter->end = PFX##_empty(target);                                                    \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_iter_start(SNAME##_iter *iter)                                          \
+    {                                                                                       \
+        return PFX##_empty(iter->target) || iter->start;                                    \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_iter_end(SNAME##_iter *iter)                                            \
+    {                                                                                       \
+        return PFX##_empty(iter->target) || iter->end;                                      \
+    }                                                                                       \
+                                                                                            \
+    FMOD void PFX##_iter_to_start(SNAME##_iter *iter)                                       \
+    {                                                                                       \
+        iter->cursor = iter->first;                                                         \
+        iter->index = 0;                                                                    \
+        iter->start = true;                                                                 \
+        iter->end = PFX##_empty(iter->target);                                              \
+    }                                                                                       \
+                                                                                            \
+    FMOD void PFX##_iter_to_end(SNAME##_iter *iter)                                         \
+    {                                                                                       \
+        iter->cursor = iter->last;                                                          \
+        iter->index = iter->target->count - 1;                                              \
+        iter->start = PFX##_empty(iter->target);                                            \
+        iter->end = true;                                                                   \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_iter_next(SNAME##_iter *iter)                                           \
+    {                                                                                       \
+        if (iter->end)                                                                      \
+            return false;                                                                   \
+                                                                                            \
+        iter->start = PFX##_empty(iter->target);                                            \
+                                                                                            \
+        if (iter->index == iter->target->count - 1)                                         \
+            iter->end = true;                                                               \
+        else                                                                                \
+        {                                                                                   \
+            iter->cursor = PFX##_impl_next(iter->target, iter->cursor);                     \
+            iter->index++;                                                                  \
+        }                                                                                   \
+                                                                                            \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_iter_prev(SNAME##_iter *iter)                                           \
+    {                                                                                       \
+        if (iter->start)                                                                    \
+            return false;                                                                   \
+                                                                                            \
+        iter->end = PFX##_empty(iter->target);                                              \
+                                                                                            \
+        if (iter->index == 0)                                                               \
+            iter->start = true;                                                             \
+        else                                                                                \
+        {                                                                                   \
+            iter->cursor = PFX##_impl_prev(iter->target, iter->cursor);                     \
+            iter->index--;                                                                  \
+        }                                                                                   \
+                                                                                            \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    FMOD K PFX##_iter_key(SNAME##_iter *iter)                                               \
+    {                                                                                       \
+        if (PFX##_empty(iter->target))                                                      \
+            return PFX##_impl_default_key();                                                \
+                                                                                            \
+        return iter->target->nodes[iter->cursor].key;                                       \
+    }                                                                                       \
+                                                                                            \
+    FMOD V PFX##_iter_value(SNAME##_iter *iter)                                             \
+    {                                                                                       \
+        if (PFX##_empty(iter->target))                                                      \
+            return PFX##_impl_default_value();                                              \
+                                                                                            \
+        return iter->target->nodes[iter->cursor].value;                                     \
+    }                                                                                       \
+                                                                                            \
+    FMOD V *PFX##_iter_rvalue(SNAME##_iter *iter)                                           \
+    {                                                                                       \
+        if (PFX##_empty(iter->target))                                                      \
+            return NULL;                                                                    \
+                                                                                            \
+        return &(iter->target->nodes[iter->cursor].value);                                  \
+    }                                                                                       \
+                                                                                            \
+    FMOD size_t PFX##_iter_index(SNAME##_iter *iter)                                        \
+    {                                                                                       \
+        return iter->index;                                                                 \
+    }                                                                                       \
+                                                                                            \
+    /* Index of the node with the key, or SIZE if there is none */                          \
+    static size_t PFX##_impl_get_node(SNAME *_map_, K key)                                  \
+    {                                                                                       \
+        size_t scan = _map_->root;                                                          \
+                                                                                            \
+        while (scan != (SIZE))                                                              \
+        {                                                                                   \
+            int c = _map_->cmp(key, _map_->nodes[scan].key);                                \
+                                                                                            \
+            if (c == 0)                                                                     \
+                break;                                                                      \
+                                                                                            \
+            scan = c < 0 ? _map_->nodes[scan].left : _map_->nodes[scan].right;              \
+        }                                                                                   \
+                                                                                            \
+        return scan;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    /* Takes a node from the free list or one that was never taken */                       \
+    static size_t PFX##_impl_new_node(SNAME *_map_)                                         \
+    {                                                                                       \
+        if (_map_->free != (SIZE))                                                          \
+        {                                                                                   \
+            size_t node = _map_->free;                                                      \
+                                                                                            \
+            _map_->free = _map_->nodes[node].right;                                         \
+                                                                                            \
+            return node;                                                                    \
+        }                                                                                   \
+                                                                                            \
+        if (_map_->used < (SIZE))                                                           \
+            return _map_->used++;                                                           \
+                                                                                            \
+        return (SIZE);                                                                      \
+    }                                                                                       \
+                                                                                            \
+    /* Replaces old, a child of parent or the root, with node */                            \
+    static void PFX##_impl_set_child(SNAME *_map_, size_t parent, size_t old, size_t node)  \
+    {                                                                                       \
+        if (parent == (SIZE))                                                               \
+            _map_->root = (CMC_SAC_TREE_INDEX)node;                                         \
+        else if (_map_->nodes[parent].left == old)                                          \
+            _map_->nodes[parent].left = (CMC_SAC_TREE_INDEX)node;                           \
+        else                                                                                \
+            _map_->nodes[parent].right = (CMC_SAC_TREE_INDEX)node;                          \
+    }                                                                                       \
+                                                                                            \
+    static unsigned char PFX##_impl_h(SNAME *_map_, size_t node)                            \
+    {                                                                                       \
+        if (node == (SIZE))                                                                 \
+            return 0;                                                                       \
+                                                                                            \
+        return _map_->nodes[node].height;                                                   \
+    }                                                                                       \
+                                                                                            \
+    static void PFX##_impl_hupdate(SNAME *_map_, size_t node)                               \
+    {                                                                                       \
+        unsigned char h_left = PFX##_impl_h(_map_, _map_->nodes[node].left);                \
+        unsigned char h_right = PFX##_impl_h(_map_, _map_->nodes[node].right);              \
+                                                                                            \
+        _map_->nodes[node].height = 1 + (h_left > h_right ? h_left : h_right);              \
+    }                                                                                       \
+                                                                                            \
+    /* Both rotations return the node that takes the place of the given one */              \
+    static size_t PFX##_impl_rotate_right(SNAME *_map_, size_t node)                        \
+    {                                                                                       \
+        SNAME##_node *Z = &(_map_->nodes[node]);                                            \
+                                                                                            \
+        size_t root = Z->left;                                                              \
+                                                                                            \
+        SNAME##_node *R = &(_map_->nodes[root]);                                            \
+                                                                                            \
+        PFX##_impl_set_child(_map_, Z->parent, node, root);                                 \
+                                                                                            \
+        R->parent = Z->parent;                                                              \
+        Z->left = R->right;                                                                 \
+                                                                                            \
+        if (R->right != (SIZE))                                                             \
+            _map_->nodes[R->right].parent = (CMC_SAC_TREE_INDEX)node;                       \
+                                                                                            \
+        R->right = (CMC_SAC_TREE_INDEX)node;                                                \
+        Z->parent = (CMC_SAC_TREE_INDEX)root;                                               \
+                                                                                            \
+        PFX##_impl_hupdate(_map_, node);                                                    \
+        PFX##_impl_hupdate(_map_, root);                                                    \
+                                                                                            \
+        return root;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    static size_t PFX##_impl_rotate_left(SNAME *_map_, size_t node)                         \
+    {                                                                                       \
+        SNAME##_node *Z = &(_map_->nodes[node]);                                            \
+                                                                                            \
+        size_t root = Z->right;                                                             \
+                                                                                            \
+        SNAME##_node *R = &(_map_->nodes[root]);                                            \
+                                                                                            \
+        PFX##_impl_set_child(_map_, Z->parent, node, root);                                 \
+                                                                                            \
+        R->parent = Z->parent;                                                              \
+        Z->right = R->left;                                                                 \
+                                                                                            \
+        if (R->left != (SIZE))                                                              \
+            _map_->nodes[R->left].parent = (CMC_SAC_TREE_INDEX)node;                        \
+                                                                                            \
+        R->left = (CMC_SAC_TREE_INDEX)node;                                                 \
+        Z->parent = (CMC_SAC_TREE_INDEX)root;                                               \
+                                                                                            \
+        PFX##_impl_hupdate(_map_, node);                                                    \
+        PFX##_impl_hupdate(_map_, root);                                                    \
+                                                                                            \
+        return root;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    /* Fixes the heights and balance from node up to the root */                            \
+    static void PFX##_impl_rebalance(SNAME *_map_, size_t node)                             \
+    {                                                                                       \
+        while (node != (SIZE))                                                              \
+        {                                                                                   \
+            PFX##_impl_hupdate(_map_, node);                                                \
+                                                                                            \
+            SNAME##_node *N = &(_map_->nodes[node]);                                        \
+                                                                                            \
+            int balance = PFX##_impl_h(_map_, N->left) - PFX##_impl_h(_map_, N->right);     \
+                                                                                            \
+            if (balance > 1)                                                                \
+            {                                                                               \
+                SNAME##_node *L = &(_map_->nodes[N->left]);                                 \
+                                                                                            \
+                if (PFX##_impl_h(_map_, L->left) < PFX##_impl_h(_map_, L->right))           \
+                    PFX##_impl_rotate_left(_map_, N->left);                                 \
+                                                                                            \
+                node = PFX##_impl_rotate_right(_map_, node);                                \
+            }                                                                               \
+            else if (balance < -1)                                                          \
+            {                                                                               \
+                SNAME##_node *R = &(_map_->nodes[N->right]);                                \
+                                                                                            \
+                if (PFX##_impl_h(_map_, R->right) < PFX##_impl_h(_map_, R->left))           \
+                    PFX##_impl_rotate_right(_map_, N->right);                               \
+                                                                                            \
+                node = PFX##_impl_rotate_left(_map_, node);                                 \
+            }                                                                               \
+                                                                                            \
+            node = _map_->nodes[node].parent;                                               \
+        }                                                                                   \
+    }                                                                                       \
+                                                                                            \
+    /* Node with the smallest key under node, or SIZE if node is SIZE */                    \
+    static size_t PFX##_impl_first(SNAME *_map_, size_t node)                               \
+    {                                                                                       \
+        if (node == (SIZE))                                                                 \
+            return node;                                                                    \
+                                                                                            \
+        while (_map_->nodes[node].left != (SIZE))                                           \
+            node = _map_->nodes[node].left;                                                 \
+                                                                                            \
+        return node;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    /* Node with the greatest key under node, or SIZE if node is SIZE */                    \
+    static size_t PFX##_impl_last(SNAME *_map_, size_t node)                                \
+    {                                                                                       \
+        if (node == (SIZE))                                                                 \
+            return node;                                                                    \
+                                                                                            \
+        while (_map_->nodes[node].right != (SIZE))                                          \
+            node = _map_->nodes[node].right;                                                \
+                                                                                            \
+        return node;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    /* In order successor, or SIZE if node has the greatest key */                          \
+    static size_t PFX##_impl_next(SNAME *_map_, size_t node)                                \
+    {                                                                                       \
+        if (_map_->nodes[node].right != (SIZE))                                             \
+            return PFX##_impl_first(_map_, _map_->nodes[node].right);                       \
+                                                                                            \
+        size_t parent = _map_->nodes[node].parent;                                          \
+                                                                                            \
+        while (parent != (SIZE) && _map_->nodes[parent].right == node)                      \
+        {                                                                                   \
+            node = parent;                                                                  \
+            parent = _map_->nodes[node].parent;                                             \
+        }                                                                                   \
+                                                                                            \
+        return parent;                                                                      \
+    }                                                                                       \
+                                                                                            \
+    /* In order predecessor, or SIZE if node has the smallest key */                        \
+    static size_t PFX##_impl_prev(SNAME *_map_, size_t node)                                \
+    {                                                                                       \
+        if (_map_->nodes[node].left != (SIZE))                                              \
+            return PFX##_impl_last(_map_, _map_->nodes[node].left);                         \
+                                                                                            \
+        size_t parent = _map_->nodes[node].parent;                                          \
+                                                                                            \
+        while (parent != (SIZE) && _map_->nodes[parent].left == node)                       \
+        {                                                                                   \
+            node = parent;                                                                  \
+            parent = _map_->nodes[node].parent;                                             \
+        }                                                                                   \
+                                                                                            \
+        return parent;                                                                      \
+    }                                                                                       \
+                                                                                            \
+    static SNAME##_iter PFX##_impl_it_start(SNAME *_map_)                                   \
+    {                                                                                       \
+        SNAME##_iter iter;                                                                  \
+                                                                                            \
+        PFX##_iter_init(&iter, _map_);                                                      \
+        PFX##_iter_to_start(&iter);                                                         \
+                                                                                            \
+        return iter;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    static SNAME##_iter PFX##_impl_it_end(SNAME *_map_)                                     \
+    {                                                                                       \
+        SNAME##_iter iter;                                                                  \
+                                                                                            \
+        PFX##_iter_init(&iter, _map_);                                                      \
+        PFX##_iter_to_end(&iter);                                                           \
+                                                                                            \
+        return iter;                                                                        \
+    }
+
+#endif /* CMC_SAC_TREEMAP_H */
@@ -0,0 +1,728 @@
+/**
+ * treeset.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * A Purely Stack Allocated TreeSet
+ *
+ * This means that the TreeSet has a fixed amount of nodes, but it also has
+ * the advantage of not requiring for manually allocating and deallocating the
+ * struct. No function calls the allocator so it can be used where malloc is
+ * not available or not allowed.
+ *
+ * Elements are kept sorted in an AVL tree, like in the TreeSet, but its nodes
+ * are the SIZE entries of an array inside the struct and link to each other
+ * by their index in it. Indexes are CMC_SAC_TREE_INDEX, which can be defined as
+ * a smaller type than uint32_t if SIZE fits in it, and SIZE itself is the
+ * index of no node. Removed nodes are kept in a free list, linked by their
+ * right child, and reused before any node that was never taken.
+ *
+ * Generating a collection with too big of a storage can be dangerous and might
+ * quickly cause a stack overflow.
+ */
+
+#ifndef CMC_SAC_TREESET_H
+#define CMC_SAC_TREESET_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Also used by sac/treemap.h */
+#ifndef CMC_SAC_TREE_INDEX
+#define CMC_SAC_TREE_INDEX uint32_t
+#endif
+
+#define SAC_TREESET_GENERATE(PFX, SNAME, FMOD, V, SIZE)    \
+    SAC_TREESET_GENERATE_HEADER(PFX, SNAME, FMOD, V, SIZE) \
+    SAC_TREESET_GENERATE_SOURCE(PFX, SNAME, FMOD, V, SIZE)
+
+#define SAC_TREESET_WRAPGEN_HEADER(PFX, SNAME, FMOD, K, V, SIZE) \
+    SAC_TREESET_GENERATE_HEADER(PFX, SNAME, FMOD, V, SIZE)
+
+#define SAC_TREESET_WRAPGEN_SOURCE(PFX, SNAME, FMOD, K, V, SIZE) \
+    SAC_TREESET_GENERATE_SOURCE(PFX, SNAME, FMOD, V, SIZE)
+
+/* HEADER ********************************************************************/
+#define SAC_TREESET_GENERATE_HEADER(PFX, SNAME, FMOD, V, SIZE)              \
+                                                                            \
+    /* TreeSet Node */                                                      \
+    typedef struct SNAME##_node_s                                           \
+    {                                                                       \
+        /* Node element */                                                  \
+        V value;                                                            \
+                                                                            \
+        /* Node height used by the AVL tree to keep it strictly balanced */ \
+        unsigned char height;                                               \
+                                                                            \
+        /* Index of the left child, the right child and the parent */       \
+        CMC_SAC_TREE_INDEX left;                                            \
+        CMC_SAC_TREE_INDEX right;                                           \
+        CMC_SAC_TREE_INDEX parent;                                          \
+                                                                            \
+    } SNAME##_node, *SNAME##_node_ptr;                                      \
+                                                                            \
+    /* TreeSet Structure */                                                 \
+    typedef struct SNAME##_s                                                \
+    {                                                                       \
+        /* Internal Storage */                                              \
+        SNAME##_node nodes[SIZE];                                           \
+                                                                            \
+        /* Index of the root node */                                        \
+        CMC_SAC_TREE_INDEX root;                                            \
+                                                                            \
+        /* First node of the free list */                                   \
+        CMC_SAC_TREE_INDEX free;                                            \
+                                                                            \
+        /* Nodes from this index on were never taken */                     \
+        size_t used;                                                        \
+                                                                            \
+        /* Current amount of elements */                                    \
+        size_t count;                                                       \
+                                                                            \
+        /* Element comparison function */                                   \
+        int (*cmp)(V, V);                                                   \
+                                                                            \
+        /* Function that returns an iterator to the start of the treeset */ \
+        struct SNAME##_iter_s (*it_start)(struct SNAME##_s *);              \
+                                                                            \
+        /* Function that returns an iterator to the end of the treeset */   \
+        struct SNAME##_iter_s (*it_end)(struct SNAME##_s *);                \
+                                                                            \
+    } SNAME, *SNAME##_ptr;                                                  \
+                                                                            \
+    /* TreeSet Iterator */                                                  \
+    typedef struct SNAME##_iter_s                                           \
+    {                                                                       \
+        /* Target treeset */                                                \
+        struct SNAME##_s *target;                                           \
+                                                                            \
+        /* Cursor's position (index of a node) */                           \
+        size_t cursor;                                                      \
+                                                                            \
+        /* Keeps track of relative index to the iteration of elements */    \
+        size_t index;                                                       \
+                                                                            \
+        /* The node with the smallest value */                              \
+        size_t first;                                                       \
+                                                                            \
+        /* The node with the greatest value */                              \
+        size_t last;                                                        \
+                                                                            \
+        /* If the iterator has reached the start of the iteration */        \
+        bool start;                                                         \
+                                                                            \
+        /* If the iterator has reached the end of the iteration */          \
+        bool end;                                                           \
+                                                                            \
+    } SNAME##_iter, *SNAME##_iter_ptr;                                      \
+                                                                            \
+    /* Collection Functions */                                              \
+    /* Collection Allocation and Deallocation */                            \
+    FMOD SNAME PFX##_new(int (*compare)(V, V));                             \
+    FMOD void PFX##_clear(SNAME *_set_);                                    \
+    /* Collection Input and Output */                                       \
+    FMOD bool PFX##_insert(SNAME *_set_, V element);                        \
+    FMOD bool PFX##_remove(SNAME *_set_, V element);                        \
+    /* Element Access */                                                    \
+    FMOD bool PFX##_max(SNAME *_set_, V *value);                            \
+    FMOD bool PFX##_min(SNAME *_set_, V *value);                            \
+    FMOD bool PFX##_floor(SNAME *_set_, V element, V *value);               \
+    FMOD bool PFX##_ceiling(SNAME *_set_, V element, V *value);             \
+    /* Collection State */                                                  \
+    FMOD bool PFX##_contains(SNAME *_set_, V element);                      \
+    FMOD bool PFX##_empty(SNAME *_set_);                                    \
+    FMOD bool PFX##_full(SNAME *_set_);                                     \
+    FMOD size_t PFX##_count(SNAME *_set_);                                  \
+    FMOD size_t PFX##_capacity(void);                                       \
+                                                                            \
+    /* Iterator Functions */                                                \
+    /* Iterator Initialization */                                           \
+    FMOD void PFX##_iter_init(SNAME##_iter *iter, SNAME *target);           \
+    /* Iterator State */                                                    \
+    FMOD bool PFX##_iter_start(SNAME##_iter *iter);                         \
+    FMOD bool PFX##_iter_end(SNAME##_iter *iter);                           \
+    /* Iterator Movement */                                                 \
+    FMOD void PFX##_iter_to_start(SNAME##_iter *iter);                      \
+    FMOD void PFX##_iter_to_end(SNAME##_iter *iter);                        \
+    FMOD bool PFX##_iter_next(SNAME##_iter *iter);                          \
+    FMOD bool PFX##_iter_prev(SNAME##_iter *iter);                          \
+    /* Iterator Access */                                                   \
+    FMOD V PFX##_iter_value(SNAME##_iter *iter);                            \
+    FMOD size_t PFX##_iter_index(SNAME##_iter *iter);                       \
+                                                                            \
+    /* Default Value */                                                     \
+    static inline V PFX##_impl_default_value(void)                          \
+    {                                                                       \
+        V _empty_value_;                                                    \
+                                                                            \
+        memset(&_empty_value_, 0, sizeof(V));                               \
+                                                                            \
+        return _empty_value_;                                               \
+    }
+
+/* SOURCE ********************************************************************/
+#define SAC_TREESET_GENERATE_SOURCE(PFX, SNAME, FMOD, V, SIZE)                              \
+                                                                                            \
+    /* Implementation Detail Functions */                                                   \
+    static size_t PFX##_impl_get_node(SNAME *_set_, V element);                             \
+    static size_t PFX##_impl_new_node(SNAME *_set_);                                        \
+    static void PFX##_impl_set_child(SNAME *_set_, size_t parent, size_t old, size_t node); \
+    static unsigned char PFX##_impl_h(SNAME *_set_, size_t node);                           \
+    static void PFX##_impl_hupdate(SNAME *_set_, size_t node);                              \
+    static size_t PFX##_impl_rotate_right(SNAME *_set_, size_t node);                       \
+    static size_t PFX##_impl_rotate_left(SNAME *_set_, size_t node);                        \
+    static void PFX##_impl_rebalance(SNAME *_set_, size_t node);                            \
+    static size_t PFX##_impl_first(SNAME *_set_, size_t node);                              \
+    static size_t PFX##_impl_last(SNAME *_set_, size_t node);                               \
+    static size_t PFX##_impl_next(SNAME *_set_, size_t node);                               \
+    static size_t PFX##_impl_prev(SNAME *_set_, size_t node);                               \
+    static SNAME##_iter PFX##_impl_it_start(SNAME *_set_);                                  \
+    static SNAME##_iter PFX##_impl_it_end(SNAME *_set_);                                    \
+                                                                                            \
+    FMOD SNAME PFX##_new(int (*compare)(V, V))                                              \
+    {                                                                                       \
+        SNAME result;                                                                       \
+                                                                                            \
+        memset(&result, 0, sizeof(SNAME));                                                  \
+                                                                                            \
+        result.root = (SIZE);                                                               \
+        result.free = (SIZE);                                                               \
+        result.cmp = compare;                                                               \
+                                                                                            \
+        result.it_start = PFX##_impl_it_start;                                              \
+        result.it_end = PFX##_impl_it_end;                                                  \
+                                                                                            \
+        return result;                                                                      \
+    }                                                                                       \
+                                                                                            \
+    FMOD void PFX##_clear(SNAME *_set_)                                                     \
+    {                                                                                       \
+        memset(_set_->nodes, 0, sizeof(_set_->nodes));                                      \
+                                                                                            \
+        _set_->root = (SIZE);                                                               \
+        _set_->free = (SIZE);                                                               \
+        _set_->used = 0;                                                                    \
+        _set_->count = 0;                                                                   \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_insert(SNAME *_set_, V element)                                         \
+    {                                                                                       \
+        size_t parent = (SIZE);                                                             \
+        size_t scan = _set_->root;                                                          \
+                                                                                            \
+        int c = 0;                                                                          \
+                                                                                            \
+        while (scan != (SIZE))                                                              \
+        {                                                                                   \
+            c = _set_->cmp(element, _set_->nodes[scan].value);                              \
+                                                                                            \
+            if (c == 0)                                                                     \
+                return false;                                                               \
+                                                                                            \
+            parent = scan;                                                                  \
+            scan = c < 0 ? _set_->nodes[scan].left : _set_->nodes[scan].right;              \
+        }                                                                                   \
+                                                                                            \
+        size_t index = PFX##_impl_new_node(_set_);                                          \
+                                                                                            \
+        if (index == (SIZE))                                                                \
+            return false;                                                                   \
+                                                                                            \
+        SNAME##_node *node = &(_set_->nodes[index]);                                        \
+                                                                                            \
+        node->value = element;                                                              \
+        node->height = 1;                                                                   \
+        node->left = (SIZE);                                                                \
+        node->right = (SIZE);                                                               \
+        node->parent = (CMC_SAC_TREE_INDEX)parent;                                          \
+                                                                                            \
+        if (parent == (SIZE))                                                               \
+            _set_->root = (CMC_SAC_TREE_INDEX)index;                                        \
+        else if (c < 0)                                                                     \
+            _set_->nodes[parent].left = (CMC_SAC_TREE_INDEX)index;                          \
+        else                                                                                \
+            _set_->nodes[parent].right = (CMC_SAC_TREE_INDEX)index;                         \
+                                                                                            \
+        _set_->count++;                                                                     \
+                                                                                            \
+        PFX##_impl_rebalance(_set_, parent);                                                \
+                                                                                            \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_remove(SNAME *_set_, V element)                                         \
+    {                                                                                       \
+        size_t node = PFX##_impl_get_node(_set_, element);                                  \
+                                                                                            \
+        if (node == (SIZE))                                                                 \
+            return false;                                                                   \
+                                                                                            \
+        /* A node with two children takes the value of its successor */                     \
+        /* which is removed in its place */                                                 \
+        if (_set_->nodes[node].left != (SIZE) && _set_->nodes[node].right != (SIZE))        \
+        {                                                                                   \
+            size_t successor = PFX##_impl_first(_set_, _set_->nodes[node].right);           \
+                                                                                            \
+            _set_->nodes[node].value = _set_->nodes[successor].value;                       \
+                                                                                            \
+            node = successor;                                                               \
+        }                                                                                   \
+                                                                                            \
+        SNAME##_node *target = &(_set_->nodes[node]);                                       \
+                                                                                            \
+        size_t child = target->left != (SIZE) ? target->left : target->right;               \
+        size_t parent = target->parent;                                                     \
+                                                                                            \
+        PFX##_impl_set_child(_set_, parent, node, child);                                   \
+                                                                                            \
+        if (child != (SIZE))                                                                \
+            _set_->nodes[child].parent = (CMC_SAC_TREE_INDEX)parent;                        \
+                                                                                            \
+        memset(target, 0, sizeof(SNAME##_node));                                            \
+                                                                                            \
+        target->right = _set_->free;                                                        \
+        _set_->free = (CMC_SAC_TREE_INDEX)node;                                             \
+                                                                                            \
+        _set_->count--;                                                                     \
+                                                                                            \
+        PFX##_impl_rebalance(_set_, parent);                                                \
+                                                                                            \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_max(SNAME *_set_, V *value)                                             \
+    {                                                                                       \
+        if (PFX##_empty(_set_))                                                             \
+            return false;                                                                   \
+                                                                                            \
+        SNAME##_node *node = &(_set_->nodes[PFX##_impl_last(_set_, _set_->root)]);          \
+                                                                                            \
+        if (value)                                                                          \
+            *value = node->value;                                                           \
+                                                                                            \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_min(SNAME *_set_, V *value)                                             \
+    {                                                                                       \
+        if (PFX##_empty(_set_))                                                             \
+            return false;                                                                   \
+                                                                                            \
+        SNAME##_node *node = &(_set_->nodes[PFX##_impl_first(_set_, _set_->root)]);         \
+                                                                                            \
+        if (value)                                                                          \
+            *value = node->value;                                                           \
+                                                                                            \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_floor(SNAME *_set_, V element, V *value)                                \
+    {                                                                                       \
+        size_t result = (SIZE);                                                             \
+        size_t scan = _set_->root;                                                          \
+                                                                                            \
+        /* The last node on the way down whose value is not greater */                      \
+        while (scan != (SIZE))                                                              \
+        {                                                                                   \
+            int c = _set_->cmp(_set_->nodes[scan].value, element);                          \
+                                                                                            \
+            if (c > 0)                                                                      \
+                scan = _set_->nodes[scan].left;                                             \
+            else                                                                            \
+            {                                                                               \
+                result = scan;                                                              \
+                                                                                            \
+                if (c == 0)                                                                 \
+                    break;                                                                  \
+                                                                                            \
+                scan = _set_->nodes[scan].right;                                            \
+            }                                                                               \
+        }                                                                                   \
+                                                                                            \
+        if (result == (SIZE))                                                               \
+            return false;                                                                   \
+                                                                                            \
+        if (value)                                                                          \
+            *value = _set_->nodes[result].value;                                            \
+                                                                                            \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_ceiling(SNAME *_set_, V element, V *value)                              \
+    {                                                                                       \
+        size_t result = (SIZE);                                                             \
+        size_t scan = _set_->root;                                                          \
+                                                                                            \
+        /* The last node on the way down whose value is not less */                         \
+        while (scan != (SIZE))                                                              \
+        {                                                                                   \
+            int c = _set_->cmp(_set_->nodes[scan].value, element);                          \
+                                                                                            \
+            if (c < 0)                                                                      \
+                scan = _set_->nodes[scan].right;                                            \
+            else                                                                            \
+            {                                                                               \
+                result = scan;                                                              \
+                                                                                            \
+                if (c == 0)                                                                 \
+                    break;                                                                  \
+                                                                                            \
+                scan = _set_->nodes[scan].left;                                             \
+            }                                                                               \
+        }                                                                                   \
+                                                                                            \
+        if (result == (SIZE))                                                               \
+            return false;                                                                   \
+                                                                                            \
+        if (value)                                                                          \
+            *value = _set_->nodes[result].value;                                            \
+                                                                                            \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_contains(SNAME *_set_, V element)                                       \
+    {                                                                                       \
+        return PFX##_impl_get_node(_set_, element) != (SIZE);                               \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_empty(SNAME *_set_)                                                     \
+    {                                                                                       \
+        return _set_->count == 0;                                                           \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_full(SNAME *_set_)                                                      \
+    {                                                                                       \
+        return _set_->count >= SIZE;                                                        \
+    }                                                                                       \
+                                                                                            \
+    FMOD size_t PFX##_count(SNAME *_set_)                                                   \
+    {                                                                                       \
+        return _set_->count;                                                                \
+    }                                                                                       \
+                                                                                            \
+    FMOD size_t PFX##_capacity(void)                                                        \
+    {                                                                                       \
+        return SIZE;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    FMOD void PFX##_iter_init(SNAME##_iter *iter, SNAME *target)                            \
+    {                                                                                       \
+        iter->target = target;                                                              \
+        iter->first = PFX##_impl_first(target, target->root);                               \
+        iter->last = PFX##_impl_last(target, target->root);                                 \
+        iter->cursor = iter->first;                                                         \
+        iter->index = 0;                                                                    \
+        iter->start = true;                                                                 \
+        iter->end = PFX##_empty(target);                                                    \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_iter_start(SNAME##_iter *iter)                                          \
+    {                                                                                       \
+        return PFX##_empty(iter->target) || iter->start;                                    \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_iter_end(SNAME##_iter *iter)                                            \
+    {                                                                                       \
+        return PFX##_empty(iter->target) || iter->end;                                      \
+    }                                                                                       \
+                                                                                            \
+    FMOD void PFX##_iter_to_start(SNAME##_iter *iter)                                       \
+    {                                                                                       \
+        iter->cursor = iter->first;                                                         \
+        iter->index = 0;                                                                    \
+        iter->start = true;                                                                 \
+        iter->end = PFX##_empty(iter->target);                                              \
+    }                                                                                       \
+                                                                                            \
+    FMOD void PFX##_iter_to_end(SNAME##_iter *iter)                                         \
+    {                                                                                       \
+        iter->cursor = iter->last;                                                          \
+        iter->index = iter->target->count - 1;                                              \
+        iter->start = PFX##_empty(iter->target);                                            \
+        iter->end = true;                                                                   \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_iter_next(SNAME##_iter *iter)                                           \
+    {                                                                                       \
+        if (iter->end)                                                                      \
+            return false;                                                                   \
+                                                                                            \
+        iter->start = PFX##_empty(iter->target);                                            \
+                                                                                            \
+        if (iter->index == iter->target->count - 1)                                         \
+            iter->end = true;                                                               \
+        else                                                                                \
+        {                                                                                   \
+            iter->cursor = PFX##_impl_next(iter->target, iter->cursor);                     \
+            iter->index++;                                                                  \
+        }                                                                                   \
+                                                                                            \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    FMOD bool PFX##_iter_prev(SNAME##_iter *iter)                                           \
+    {                                                                                       \
+        if (iter->start)                                                                    \
+            return false;                                                                   \
+                                                                                            \
+        iter->end = PFX##_empty(iter->target);                                              \
+                                                                                            \
+        if (iter->index == 0)                                                               \
+            iter->start = true;                                                             \
+        else                                                                                \
+        {                                                                                   \
+            iter->cursor = PFX##_impl_prev(iter->target, iter->cursor);                     \
+            iter->index--;                                                                  \
+        }                                                                                   \
+                                                                                            \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    FMOD V PFX##_iter_value(SNAME##_iter *iter)                                             \
+    {                                                                                       \
+        if (PFX##_empty(iter->target))                                                      \
+            return PFX##_impl_default_value();                                              \
+                                                                                            \
+        return iter->target->nodes[iter->cursor].value;                                     \
+    }                                                                                       \
+                                                                                            \
+    FMOD size_t PFX##_iter_index(SNAME##_iter *iter)                                        \
+    {                                                                                       \
+        return iter->index;                                                                 \
+    }                                                                                       \
+                                                                                            \
+    /* Index of the node with the element, or SIZE if there is none */                      \
+    static size_t PFX##_impl_get_node(SNAME *_set_, V element)                              \
+    {                                                                                       \
+        size_t scan = _set_->root;                                                          \
+                                                                                            \
+        while (scan != (SIZE))                                                              \
+        {                                                                                   \
+            int c = _set_->cmp(element, _set_->nodes[scan].value);                          \
+                                                                                            \
+            if (c == 0)                                                                     \
+                break;                                                                      \
+                                                                                            \
+            scan = c < 0 ? _set_->nodes[scan].left : _set_->nodes[scan].right;              \
+        }                                                                                   \
+                                                                                            \
+        return scan;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    /* Takes a node from the free list or one that was never taken */                       \
+    static size_t PFX##_impl_new_node(SNAME *_set_)                                         \
+    {                                                                                       \
+        if (_set_->free != (SIZE))                                                          \
+        {                                                                                   \
+            size_t node = _set_->free;                                                      \
+                                                                                            \
+            _set_->free = _set_->nodes[node].right;                                         \
+                                                                                            \
+            return node;                                                                    \
+        }                                                                                   \
+                                                                                            \
+        if (_set_->used < (SIZE))                                                           \
+            return _set_->used++;                                                           \
+                                                                                            \
+        return (SIZE);                                                                      \
+    }                                                                                       \
+                                                                                            \
+    /* Replaces old, a child of parent or the root, with node */                            \
+    static void PFX##_impl_set_child(SNAME *_set_, size_t parent, size_t old, size_t node)  \
+    {                                                                                       \
+        if (parent == (SIZE))                                                               \
+            _set_->root = (CMC_SAC_TREE_INDEX)node;                                         \
+        else if (_set_->nodes[parent].left == old)                                          \
+            _set_->nodes[parent].left = (CMC_SAC_TREE_INDEX)node;                           \
+        else                                                                                \
+            _set_->nodes[parent].right = (CMC_SAC_TREE_INDEX)node;                          \
+    }                                                                                       \
+                                                                                            \
+    static unsigned char PFX##_impl_h(SNAME *_set_, size_t node)                            \
+    {                                                                                       \
+        if (node == (SIZE))                                                                 \
+            return 0;                                                                       \
+                                                                                            \
+        return _set_->nodes[node].height;                                                   \
+    }                                                                                       \
+                                                                                            \
+    static void PFX##_impl_hupdate(SNAME *_set_, size_t node)                               \
+    {                                                                                       \
+        unsigned char h_left = PFX##_impl_h(_set_, _set_->nodes[node].left);                \
+        unsigned char h_right = PFX##_impl_h(_set_, _set_->nodes[node].right);              \
+                                                                                            \
+        _set_->nodes[node].height = 1 + (h_left > h_right ? h_left : h_right);              \
+    }                                                                                       \
+                                                                                            \
+    /* Both rotations return the node that takes the place of the given one */              \
+    static size_t PFX##_impl_rotate_right(SNAME *_set_, size_t node)                        \
+    {                                                                                       \
+        SNAME##_node *Z = &(_set_->nodes[node]);                                            \
+                                                                                            \
+        size_t root = Z->left;                                                              \
+                                                                                            \
+        SNAME##_node *R = &(_set_->nodes[root]);                                            \
+                                                                                            \
+        PFX##_impl_set_child(_set_, Z->parent, node, root);                                 \
+                                                                                            \
+        R->parent = Z->parent;                                                              \
+        Z->left = R->right;                                                                 \
+                                                                                            \
+        if (R->right != (SIZE))                                                             \
+            _set_->nodes[R->right].parent = (CMC_SAC_TREE_INDEX)node;                       \
+                                                                                            \
+        R->right = (CMC_SAC_TREE_INDEX)node;                                                \
+        Z->parent = (CMC_SAC_TREE_INDEX)root;                                               \
+                                                                                            \
+        PFX##_impl_hupdate(_set_, node);                                                    \
+        PFX##_impl_hupdate(_set_, root);                                                    \
+                                                                                            \
+        return root;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    static size_t PFX##_impl_rotate_left(SNAME *_set_, size_t node)                         \
+    {                                                                                       \
+        SNAME##_node *Z = &(_set_->nodes[node]);                                            \
+                                                                                            \
+        size_t root = Z->right;                                                             \
+                                                                                            \
+        SNAME##_node *R = &(_set_->nodes[root]);                                            \
+                                                                                            \
+        PFX##_impl_set_child(_set_, Z->parent, node, root);                                 \
+                                                                                            \
+        R->parent = Z->parent;                                                              \
+        Z->right = R->left;                                                                 \
+                                                                                            \
+        if (R->left != (SIZE))                                                              \
+            _set_->nodes[R->left].parent = (CMC_SAC_TREE_INDEX)node;                        \
+                                                                                            \
+        R->left = (CMC_SAC_TREE_INDEX)node;                                                 \
+        Z->parent = (CMC_SAC_TREE_INDEX)root;                                               \
+                                                                                            \
+        PFX##_impl_hupdate(_set_, node);                                                    \
+        PFX##_impl_hupdate(_set_, root);                                                    \
+                                                                                            \
+        return root;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    /* Fixes the heights and balance from node up to the root */                            \
+    static void PFX##_impl_rebalance(SNAME *_set_, size_t node)                             \
+    {                                                                                       \
+        while (node != (SIZE))                                                              \
+        {                                                                                   \
+            PFX##_impl_hupdate(_set_, node);                                                \
+                                                                                            \
+            SNAME##_node *N = &(_set_->nodes[node]);                                        \
+                                                                                            \
+            int balance = PFX##_impl_h(_set_, N->left) - PFX##_impl_h(_set_, N->right);     \
+                                                                                            \
+            if (balance > 1)                                                                \
+            {                                                                               \
+                SNAME##_node *L = &(_set_->nodes[N->left]);                                 \
+                                                                                            \
+                if (PFX##_impl_h(_set_, L->left) < PFX##_impl_h(_set_, L->right))           \
+                    PFX##_impl_rotate_left(_set_, N->left);                                 \
+                                                                                            \
+                node = PFX##_impl_rotate_right(_set_, node);                                \
+            }                                                                               \
+            else if (balance < -1)                                                          \
+            {                                                                               \
+                SNAME##_node *R = &(_set_->nodes[N->right]);                                \
+                                                                                            \
+                if (PFX##_impl_h(_set_, R->right) < PFX##_impl_h(_set_, R->left))           \
+                    PFX##_impl_rotate_right(_set_, N->right);                               \
+                                                                                            \
+                node = PFX##_impl_rotate_left(_set_, node);                                 \
+            }                                                                               \
+                                                                                            \
+            node = _set_->nodes[node].parent;                                               \
+        }                                                                                   \
+    }                                                                                       \
+                                                                                            \
+    /* Node with the smallest value under node, or SIZE if node is SIZE */                  \
+    static size_t PFX##_impl_first(SNAME *_set_, size_t node)                               \
+    {                                                                                       \
+        if (node == (SIZE))                                                                 \
+            return node;                                                                    \
+                                                                                            \
+        while (_set_->nodes[node].left != (SIZE))                                           \
+            node = _set_->nodes[node].left;                                                 \
+                                                                                            \
+        return node;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    /* Node with the greatest value under node, or SIZE if node is SIZE */                  \
+    static size_t PFX##_impl_last(SNAME *_set_, size_t node)                                \
+    {                                                                                       \
+        if (node == (SIZE))                                                                 \
+            return node;                                                                    \
+                                                                                            \
+        while (_set_->nodes[node].right != (SIZE))                                          \
+            node = _set_->nodes[node].right;                                                \
+                                                                                            \
+        return node;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    /* In order successor, or SIZE if node has the greatest value */                        \
+    static size_t PFX##_impl_next(SNAME *_set_, size_t node)                                \
+    {                                                                                       \
+        if (_set_->nodes[node].right != (SIZE))                                             \
+            return PFX##_impl_first(_set_, _set_->nodes[node].right);                       \
+                                                                                            \
+        size_t parent = _set_->nodes[node].parent;                                          \
+                                                                                            \
+        while (parent != (SIZE) && _set_->nodes[parent].right == node)                      \
+        {                                                                                   \
+            node = parent;                                                                  \
+            parent = _set_->nodes[node].parent;                                             \
+        }                                                                                   \
+                                                                                            \
+        return parent;                                                                      \
+    }                                                                                       \
+                                                                                            \
+    /* In order predecessor, or SIZE if node has the smallest value */                      \
+    static size_t PFX##_impl_prev(SNAME *_set_, size_t node)                                \
+    {                                                                                       \
+        if (_set_->nodes[node].left != (SIZE))                                              \
+            return PFX##_impl_last(_set_, _set_->nodes[node].left);                         \
+                                                                                            \
+        size_t parent = _set_->nodes[node].parent;                                          \
+                                                                                            \
+        while (parent != (SIZE) && _set_->nodes[parent].left == node)                       \
+        {                                                                                   \
+            node = parent;                                                                  \
+            parent = _set_->nodes[node].parent;                                             \
+        }                                                                                   \
+                                                                                            \
+        return parent;                                                                      \
+    }                                                                                       \
+                                                                                            \
+    static SNAME##_iter PFX##_impl_it_start(SNAME *_set_)                                   \
+    {                                                                                       \
+        SNAME##_iter iter;                                                                  \
+                                                                                            \
+        PFX##_iter_init(&iter, _set_);                                                      \
+        PFX##_iter_to_start(&iter);                                                         \
+                                                                                            \
+        return iter;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    static SNAME##_iter PFX##_impl_it_end(SNAME *_set_)                                     \
+    {                                                                                       \
+        SNAME##_iter iter;                                                                  \
+                                                                                            \
+        PFX##_iter_init(&iter, _set_);                                                      \
+        PFX##_iter_to_end(&iter);                                                           \
+                                                                                            \
+        return iter;                                                                        \
+    }
+
+#endif /* CMC_SAC_TREESET_H */
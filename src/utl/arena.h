@@ -0,0 +1,243 @@
+/**
+ * arena.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Bump allocator for collections that live as long as a request. Memory */
+/* is taken from chunks of CMC_ARENA_CHUNK_SIZE bytes by moving a cursor, */
+/* freeing a block does nothing unless it is the last one and */
+/* cmc_arena_reset makes every chunk free again at once. The chunks are */
+/* kept to be reused and only cmc_arena_release gives them back. */
+
+/* CMC_GENERATE_ARENA(NAME) defines a static struct cmc_arena NAME and a */
+/* struct cmc_alloc_node NAME##_node that allocates from it, to be passed */
+/* to PFX_new_custom. A collection whose memory all comes from an arena can */
+/* be dropped with its PFX_release, which does not visit its nodes, before */
+/* the arena is reset. An arena must not be shared by threads. */
+
+#ifndef CMC_ARENA_H
+#define CMC_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cmc_alloc.h"
+
+#ifndef CMC_ARENA_CHUNK_SIZE
+#define CMC_ARENA_CHUNK_SIZE 65536
+#endif
+
+/* Alignment of every block and size of the header that precedes it */
+#define CMC_ARENA_ALIGN _Alignof(max_align_t)
+
+#define CMC_ARENA_ROUND(size) (((size) + CMC_ARENA_ALIGN - 1) & ~(CMC_ARENA_ALIGN - 1))
+
+#define CMC_GENERATE_ARENA(NAME)                                                  \
+    static struct cmc_arena NAME = { NULL, NULL };                                \
+                                                                                  \
+    static void *NAME##_malloc(size_t size)                                       \
+    {                                                                             \
+        return cmc_arena_malloc(&NAME, size);                                     \
+    }                                                                             \
+                                                                                  \
+    static void *NAME##_calloc(size_t count, size_t size)                         \
+    {                                                                             \
+        return cmc_arena_calloc(&NAME, count, size);                              \
+    }                                                                             \
+                                                                                  \
+    static void *NAME##_realloc(void *ptr, size_t size)                           \
+    {                                                                             \
+        return cmc_arena_realloc(&NAME, ptr, size);                               \
+    }                                                                             \
+                                                                                  \
+    static void NAME##_free(void *ptr)                                            \
+    {                                                                             \
+        cmc_arena_free(&NAME, ptr);                                               \
+    }                                                                             \
+                                                                                  \
+    static struct cmc_alloc_node NAME##_node = { NAME##_malloc, NAME##_calloc,    \
+                                                 NAME##_realloc, NAME##_free };
+
+struct cmc_arena_chunk
+{
+    /* Next chunk, the ones after the current one are free */
+    struct cmc_arena_chunk *next;
+
+    /* Bytes of the chunk after its header */
+    size_t capacity;
+
+    /* Bytes taken by blocks */
+    size_t used;
+};
+
+struct cmc_arena
+{
+    /* Oldest chunk, where a reset arena starts from */
+    struct cmc_arena_chunk *first;
+
+    /* Chunk that blocks are taken from */
+    struct cmc_arena_chunk *current;
+};
+
+/* Bytes of a block, kept in the header before it */
+static inline size_t cmc_arena_size(void *ptr)
+{
+    size_t size;
+
+    memcpy(&size, (unsigned char *)ptr - CMC_ARENA_ALIGN, sizeof(size_t));
+
+    return size;
+}
+
+static inline unsigned char *cmc_arena_data(struct cmc_arena_chunk *chunk)
+{
+    return (unsigned char *)chunk + CMC_ARENA_ROUND(sizeof(struct cmc_arena_chunk));
+}
+
+/* If the block is the last one taken from the current chunk */
+static inline bool cmc_arena_is_last(struct cmc_arena *arena, void *ptr)
+{
+    struct cmc_arena_chunk *chunk = arena->current;
+
+    return chunk && (unsigned char *)ptr + CMC_ARENA_ROUND(cmc_arena_size(ptr)) ==
+                        cmc_arena_data(chunk) + chunk->used;
+}
+
+static inline void *cmc_arena_malloc(struct cmc_arena *arena, size_t size)
+{
+    if (size > SIZE_MAX / 2)
+        return NULL;
+
+    size_t bytes = CMC_ARENA_ALIGN + CMC_ARENA_ROUND(size);
+
+    struct cmc_arena_chunk *chunk = arena->current;
+
+    if (!chunk || chunk->capacity - chunk->used < bytes)
+    {
+        /* The chunks after the current one are free since the last reset */
+        struct cmc_arena_chunk *next = chunk ? chunk->next : arena->first;
+
+        if (next && next->capacity >= bytes)
+            chunk = next;
+        else
+        {
+            size_t capacity = bytes > CMC_ARENA_CHUNK_SIZE ? bytes : CMC_ARENA_CHUNK_SIZE;
+
+            struct cmc_arena_chunk *fresh =
+                malloc(CMC_ARENA_ROUND(sizeof(struct cmc_arena_chunk)) + capacity);
+
+            if (!fresh)
+                return NULL;
+
+            fresh->capacity = capacity;
+            fresh->next = next;
+
+            if (chunk)
+                chunk->next = fresh;
+            else
+                arena->first = fresh;
+
+            chunk = fresh;
+        }
+
+        chunk->used = 0;
+        arena->current = chunk;
+    }
+
+    unsigned char *result = cmc_arena_data(chunk) + chunk->used + CMC_ARENA_ALIGN;
+
+    memcpy(result - CMC_ARENA_ALIGN, &size, sizeof(size_t));
+
+    chunk->used += bytes;
+
+    return result;
+}
+
+static inline void *cmc_arena_calloc(struct cmc_arena *arena, size_t count, size_t size)
+{
+    if (size != 0 && count > SIZE_MAX / size)
+        return NULL;
+
+    void *result = cmc_arena_malloc(arena, count * size);
+
+    /* The chunks are reused after a reset so they are not zeroed */
+    if (result)
+        memset(result, 0, count * size);
+
+    return result;
+}
+
+/* Only the last block is given back to its chunk */
+static inline void cmc_arena_free(struct cmc_arena *arena, void *ptr)
+{
+    if (!ptr || !cmc_arena_is_last(arena, ptr))
+        return;
+
+    arena->current->used -= CMC_ARENA_ALIGN + CMC_ARENA_ROUND(cmc_arena_size(ptr));
+}
+
+/* The last block grows in place if its chunk has room, any other one is */
+/* copied to a new block */
+static inline void *cmc_arena_realloc(struct cmc_arena *arena, void *ptr, size_t size)
+{
+    if (!ptr)
+        return cmc_arena_malloc(arena, size);
+
+    size_t old_size = cmc_arena_size(ptr);
+
+    if (cmc_arena_is_last(arena, ptr) && size <= SIZE_MAX / 2)
+    {
+        struct cmc_arena_chunk *chunk = arena->current;
+
+        size_t used = chunk->used - CMC_ARENA_ROUND(old_size);
+
+        if (chunk->capacity - used >= CMC_ARENA_ROUND(size))
+        {
+            chunk->used = used + CMC_ARENA_ROUND(size);
+
+            memcpy((unsigned char *)ptr - CMC_ARENA_ALIGN, &size, sizeof(size_t));
+
+            return ptr;
+        }
+    }
+
+    void *result = cmc_arena_malloc(arena, size);
+
+    if (result)
+        memcpy(result, ptr, old_size < size ? old_size : size);
+
+    return result;
+}
+
+/* Every block is freed at once, the chunks are kept to be used again */
+static inline void cmc_arena_reset(struct cmc_arena *arena)
+{
+    arena->current = NULL;
+}
+
+/* Frees the chunks of the arena, which is left empty */
+static inline void cmc_arena_release(struct cmc_arena *arena)
+{
+    struct cmc_arena_chunk *chunk = arena->first;
+
+    while (chunk)
+    {
+        struct cmc_arena_chunk *next = chunk->next;
+
+        free(chunk);
+
+        chunk = next;
+    }
+
+    arena->first = NULL;
+    arena->current = NULL;
+}
+
+#endif /* CMC_ARENA_H */
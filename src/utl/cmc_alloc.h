@@ -0,0 +1,197 @@
+/**
+ * cmc_alloc.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Allocation functions of a collection. Every collection has a */
+/* PFX_new_custom that takes the same arguments as its PFX_new and a pointer */
+/* to a struct cmc_alloc_node, which is stored in it and has to outlive it. */
+/* All of the memory of the collection, including its iterators, is then */
+/* allocated and freed through it. PFX_new uses cmc_alloc_node_default, made */
+/* of the functions of the standard library, as does a NULL node. */
+
+/* The functions have the same signatures as the ones they replace, so an */
+/* allocator like jemalloc can be plugged in as it is. One that needs some */
+/* state, like an arena or a NUMA node, is given a node of its own whose */
+/* functions know where that state is. */
+
+/* Every collection also has a PFX_memory_usage that returns how many bytes */
+/* it holds from its allocator, the struct itself included, as the sum of */
+/* the sizes that were asked for. That is what cmc_alloc_node_tracked */
+/* counts too, so a collection created with it and no iterators allocated */
+/* adds exactly its PFX_memory_usage to cmc_alloc_tracker. The elements */
+/* themselves are counted, but not anything that they point to. */
+
+#ifndef CMC_ALLOC_H
+#define CMC_ALLOC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct cmc_alloc_node
+{
+    void *(*malloc)(size_t);
+    void *(*calloc)(size_t, size_t);
+    void *(*realloc)(void *, size_t);
+    void (*free)(void *);
+};
+
+static struct cmc_alloc_node cmc_alloc_node_default = { malloc, calloc, realloc, free };
+
+/* Bytes that cmc_alloc_aligned asks the allocator for */
+static inline size_t cmc_alloc_aligned_size(size_t alignment, size_t size)
+{
+    return size + alignment;
+}
+
+/* Allocates size bytes aligned to alignment, a power of two not less than */
+/* the size of a pointer. The block has to be freed by cmc_alloc_aligned_free */
+/* since it starts after a pointer to what the allocator returned */
+static inline void *cmc_alloc_aligned(struct cmc_alloc_node *alloc, size_t alignment,
+                                      size_t size)
+{
+    unsigned char *block = alloc->malloc(cmc_alloc_aligned_size(alignment, size));
+
+    if (!block)
+        return NULL;
+
+    unsigned char *result = block + alignment - (uintptr_t)block % alignment;
+
+    memcpy(result - sizeof(void *), &block, sizeof(void *));
+
+    return result;
+}
+
+static inline void cmc_alloc_aligned_free(struct cmc_alloc_node *alloc, void *ptr)
+{
+    if (!ptr)
+        return;
+
+    void *block;
+
+    memcpy(&block, (unsigned char *)ptr - sizeof(void *), sizeof(void *));
+
+    alloc->free(block);
+}
+
+/* Totals of the blocks allocated through cmc_alloc_node_tracked, which */
+/* are not synchronized, so it should only be used by a single thread */
+struct cmc_alloc_tracker
+{
+    /* Bytes currently allocated */
+    size_t current;
+    /* Highest value that current had */
+    size_t peak;
+    /* Calls that allocated a block and calls that freed one */
+    size_t allocations;
+    size_t frees;
+};
+
+static struct cmc_alloc_tracker cmc_alloc_tracker;
+
+/* Each block starts with its size, in as many bytes as the alignment of */
+/* the blocks of malloc so that what comes after it keeps that alignment */
+#define CMC_ALLOC_TRACKED_HEADER sizeof(max_align_t)
+
+static inline void cmc_alloc_tracker_reset(void)
+{
+    memset(&cmc_alloc_tracker, 0, sizeof(struct cmc_alloc_tracker));
+}
+
+static inline void *cmc_alloc_tracked_start(unsigned char *block, size_t size)
+{
+    if (!block)
+        return NULL;
+
+    memcpy(block, &size, sizeof(size_t));
+
+    cmc_alloc_tracker.current += size;
+    cmc_alloc_tracker.allocations++;
+
+    if (cmc_alloc_tracker.current > cmc_alloc_tracker.peak)
+        cmc_alloc_tracker.peak = cmc_alloc_tracker.current;
+
+    return block + CMC_ALLOC_TRACKED_HEADER;
+}
+
+static inline size_t cmc_alloc_tracked_size(void *ptr)
+{
+    size_t size;
+
+    memcpy(&size, (unsigned char *)ptr - CMC_ALLOC_TRACKED_HEADER, sizeof(size_t));
+
+    return size;
+}
+
+static inline void *cmc_alloc_tracked_malloc(size_t size)
+{
+    if (size > SIZE_MAX - CMC_ALLOC_TRACKED_HEADER)
+        return NULL;
+
+    return cmc_alloc_tracked_start(malloc(size + CMC_ALLOC_TRACKED_HEADER), size);
+}
+
+static inline void *cmc_alloc_tracked_calloc(size_t count, size_t size)
+{
+    if (size != 0 && count > (SIZE_MAX - CMC_ALLOC_TRACKED_HEADER) / size)
+        return NULL;
+
+    return cmc_alloc_tracked_start(calloc(1, count * size + CMC_ALLOC_TRACKED_HEADER),
+                                   count * size);
+}
+
+static inline void cmc_alloc_tracked_free(void *ptr)
+{
+    if (!ptr)
+        return;
+
+    cmc_alloc_tracker.current -= cmc_alloc_tracked_size(ptr);
+    cmc_alloc_tracker.frees++;
+
+    free((unsigned char *)ptr - CMC_ALLOC_TRACKED_HEADER);
+}
+
+static inline void *cmc_alloc_tracked_realloc(void *ptr, size_t size)
+{
+    if (!ptr)
+        return cmc_alloc_tracked_malloc(size);
+
+    if (size > SIZE_MAX - CMC_ALLOC_TRACKED_HEADER)
+        return NULL;
+
+    size_t old = cmc_alloc_tracked_size(ptr);
+    unsigned char *block =
+        realloc((unsigned char *)ptr - CMC_ALLOC_TRACKED_HEADER, size + CMC_ALLOC_TRACKED_HEADER);
+
+    if (!block)
+        return NULL;
+
+    /* A reallocation is counted as a free of the old block */
+    cmc_alloc_tracker.current -= old;
+    cmc_alloc_tracker.frees++;
+
+    return cmc_alloc_tracked_start(block, size);
+}
+
+/* Allocation functions of the standard library that keep the totals of */
+/* cmc_alloc_tracker. Only blocks allocated through it can be freed by it */
+static inline struct cmc_alloc_node *cmc_alloc_tracked_node(void)
+{
+    static struct cmc_alloc_node node = { cmc_alloc_tracked_malloc, cmc_alloc_tracked_calloc,
+                                          cmc_alloc_tracked_realloc, cmc_alloc_tracked_free };
+
+    return &node;
+}
+
+/* Used like cmc_alloc_node_default, behind a function so that including */
+/* this header without using it does not warn of an unused variable */
+#define cmc_alloc_node_tracked (*cmc_alloc_tracked_node())
+
+#endif /* CMC_ALLOC_H */
@@ -0,0 +1,164 @@
+/**
+ * cmc_bits.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Operations over arrays of 64 bit words, shared by the collections that */
+/* keep sets as bits, the BitSet and the bitmap containers of the Roaring */
+/* bitmap. They go a vector of words at a time with AVX2 or SSE2 when */
+/* available. Define CMC_BITS_NO_SIMD to always go one word at a time. */
+
+#ifndef CMC_BITS_H
+#define CMC_BITS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "cmc_math.h"
+
+#if !defined(CMC_BITS_NO_SIMD) && defined(__AVX2__)
+#define CMC_BITS_AVX2
+#include <immintrin.h>
+#elif !defined(CMC_BITS_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define CMC_BITS_SSE2
+#include <emmintrin.h>
+#endif
+
+/* Word by word operations of the set operations */
+enum cmc_bits_op
+{
+    CMC_BITS_OR,
+    CMC_BITS_AND,
+    CMC_BITS_ANDNOT,
+    CMC_BITS_XOR
+};
+
+static inline uint64_t cmc_bits_word_op(uint64_t a, uint64_t b, enum cmc_bits_op op)
+{
+    switch (op)
+    {
+        case CMC_BITS_OR:
+            return a | b;
+        case CMC_BITS_AND:
+            return a & b;
+        case CMC_BITS_ANDNOT:
+            return a & ~b;
+        default:
+            return a ^ b;
+    }
+}
+
+/* Amount of bits set in count words */
+static inline size_t cmc_bits_popcount(const uint64_t *words, size_t count)
+{
+    size_t result = 0;
+
+    for (size_t i = 0; i < count; i++)
+        result += cmc_math_popcount(words[i]);
+
+    return result;
+}
+
+/* Sets dst to a op b for count words, returning the amount of bits set in */
+/* dst. dst can be the same as a or b. With ANDNOT it is a and not b */
+static inline size_t cmc_bits_apply(uint64_t *dst, const uint64_t *a, const uint64_t *b,
+                                      size_t count, enum cmc_bits_op op)
+{
+    size_t result = 0;
+    size_t i = 0;
+
+#if defined(CMC_BITS_AVX2)
+    for (; i + 4 <= count; i += 4)
+    {
+        __m256i va = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i *)(b + i));
+        __m256i vr;
+
+        if (op == CMC_BITS_OR)
+            vr = _mm256_or_si256(va, vb);
+        else if (op == CMC_BITS_AND)
+            vr = _mm256_and_si256(va, vb);
+        else if (op == CMC_BITS_ANDNOT)
+            vr = _mm256_andnot_si256(vb, va);
+        else
+            vr = _mm256_xor_si256(va, vb);
+
+        _mm256_storeu_si256((__m256i *)(dst + i), vr);
+
+        result += cmc_math_popcount(dst[i]) + cmc_math_popcount(dst[i + 1]) +
+                  cmc_math_popcount(dst[i + 2]) + cmc_math_popcount(dst[i + 3]);
+    }
+#elif defined(CMC_BITS_SSE2)
+    for (; i + 2 <= count; i += 2)
+    {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+        __m128i vr;
+
+        if (op == CMC_BITS_OR)
+            vr = _mm_or_si128(va, vb);
+        else if (op == CMC_BITS_AND)
+            vr = _mm_and_si128(va, vb);
+        else if (op == CMC_BITS_ANDNOT)
+            vr = _mm_andnot_si128(vb, va);
+        else
+            vr = _mm_xor_si128(va, vb);
+
+        _mm_storeu_si128((__m128i *)(dst + i), vr);
+
+        result += cmc_math_popcount(dst[i]) + cmc_math_popcount(dst[i + 1]);
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        dst[i] = cmc_bits_word_op(a[i], b[i], op);
+        result += cmc_math_popcount(dst[i]);
+    }
+
+    return result;
+}
+
+/* If a op b is zero for all count words, stopping at the first that is not */
+static inline bool cmc_bits_none(const uint64_t *a, const uint64_t *b, size_t count,
+                                   enum cmc_bits_op op)
+{
+    size_t i = 0;
+
+#if defined(CMC_BITS_AVX2)
+    for (; i + 4 <= count; i += 4)
+    {
+        __m256i va = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i *)(b + i));
+
+        /* testz is (a & b) == 0 and testc is (~b & a) == 0 */
+        if (op == CMC_BITS_AND ? !_mm256_testz_si256(va, vb) : !_mm256_testc_si256(vb, va))
+            return false;
+    }
+#elif defined(CMC_BITS_SSE2)
+    for (; i + 2 <= count; i += 2)
+    {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+        __m128i vr = op == CMC_BITS_AND ? _mm_and_si128(va, vb) : _mm_andnot_si128(vb, va);
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(vr, _mm_setzero_si128())) != 0xFFFF)
+            return false;
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        if (cmc_bits_word_op(a[i], b[i], op))
+            return false;
+    }
+
+    return true;
+}
+
+#endif /* CMC_BITS_H */
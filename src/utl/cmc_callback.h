@@ -0,0 +1,271 @@
+/**
+ * cmc_callback.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Filter, map and fold with callbacks given when they are generated, so */
+/* they are called straight from a loop over the buffer of the collection */
+/* and can be inlined into it, instead of through a function pointer for */
+/* every element. A callback can be a function or a function like macro. */
+/* These are generated after the collection, with the same PFX and SNAME, */
+/* and NAME is added to the name of each function so a collection can have */
+/* as many of them as needed. */
+
+/* CMC_GENERATE_LIST_FILTER(PFX, SNAME, V, NAME, PRED) generates */
+/* bool PFX##_filter_into_##NAME(struct SNAME *from, struct SNAME *to), */
+/* that adds to the end of to the elements of from for which PRED(element) */
+/* is true. When from and to are the same list the other elements are */
+/* dropped in place, with no deallocator called for them. */
+
+/* CMC_GENERATE_LIST_MAP(PFX, SNAME, V, NAME, MAP) generates */
+/* bool PFX##_map_into_##NAME(struct SNAME *from, struct SNAME *to), */
+/* that adds to the end of to MAP(element) for every element of from, or */
+/* replaces every element by it when from and to are the same list. */
+/* Both copy a buffer shared in copy on write mode before writing to it. */
+
+/* CMC_GENERATE_LIST_FOLD(PFX, SNAME, V, NAME, R, FOLD) generates */
+/* R PFX##_fold_##NAME(struct SNAME *list, R initial), that returns */
+/* FOLD(...FOLD(FOLD(initial, e0), e1)..., en) over the elements in order. */
+
+/* The HashSet and HashMap versions are the same, going through the slots */
+/* of their buffer. A HashSet is given its elements and a HashMap each key */
+/* and value, so the callbacks of a HashMap are PRED(key, value), */
+/* MAP(key, value), that returns the new value, and FOLD(result, key, */
+/* value). Their filter_into and the HashSet map_into need two different */
+/* tables, since entries are moved around when others are removed, and the */
+/* HashMap map_into updates the values in place when given the same map. */
+/* Elements that are already in the other table are not added again. */
+
+/* CMC_GENERATE_HASHMAP_FOLD_VALUES(PFX, SNAME, K, V, NAME, R, FOLD) */
+/* generates R PFX##_fold_values_##NAME(struct SNAME *map, R initial), */
+/* the same as fold with FOLD(result, value). A HashMap that keeps its */
+/* values apart from its keys then only reads the values. */
+
+#ifndef CMC_CALLBACK_H
+#define CMC_CALLBACK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define CMC_GENERATE_LIST_FILTER(PFX, SNAME, V, NAME, PRED)                     \
+                                                                                \
+    static bool PFX##_filter_into_##NAME(struct SNAME *from, struct SNAME *to)  \
+    {                                                                           \
+        if (from == to)                                                         \
+        {                                                                       \
+            if (!PFX##_unshare(from))                                           \
+                return false;                                                   \
+                                                                                \
+            size_t kept = 0;                                                    \
+                                                                                \
+            for (size_t i = 0; i < from->count; i++)                            \
+            {                                                                   \
+                if (PRED(from->buffer[i]))                                      \
+                    from->buffer[kept++] = from->buffer[i];                     \
+            }                                                                   \
+                                                                                \
+            from->count = kept;                                                 \
+                                                                                \
+            return true;                                                        \
+        }                                                                       \
+                                                                                \
+        for (size_t i = 0; i < from->count; i++)                                \
+        {                                                                       \
+            if (PRED(from->buffer[i]) && !PFX##_push_back(to, from->buffer[i])) \
+                return false;                                                   \
+        }                                                                       \
+                                                                                \
+        return true;                                                            \
+    }
+
+#define CMC_GENERATE_LIST_MAP(PFX, SNAME, V, NAME, MAP)                     \
+                                                                            \
+    static bool PFX##_map_into_##NAME(struct SNAME *from, struct SNAME *to) \
+    {                                                                       \
+        if (from == to)                                                     \
+        {                                                                   \
+            if (!PFX##_unshare(from))                                       \
+                return false;                                               \
+                                                                            \
+            for (size_t i = 0; i < from->count; i++)                        \
+                from->buffer[i] = MAP(from->buffer[i]);                     \
+                                                                            \
+            return true;                                                    \
+        }                                                                   \
+                                                                            \
+        /* reserve only copies a shared buffer when it has to grow it */    \
+        if (!PFX##_unshare(to))                                             \
+            return false;                                                   \
+                                                                            \
+        if (!PFX##_reserve(to, to->count + from->count))                    \
+            return false;                                                   \
+                                                                            \
+        V *out = to->buffer + to->count;                                    \
+                                                                            \
+        for (size_t i = 0; i < from->count; i++)                            \
+            out[i] = MAP(from->buffer[i]);                                  \
+                                                                            \
+        to->count += from->count;                                           \
+                                                                            \
+        return true;                                                        \
+    }
+
+#define CMC_GENERATE_LIST_FOLD(PFX, SNAME, V, NAME, R, FOLD)  \
+                                                              \
+    static R PFX##_fold_##NAME(struct SNAME *list, R initial) \
+    {                                                         \
+        R result = initial;                                   \
+                                                              \
+        for (size_t i = 0; i < list->count; i++)              \
+            result = FOLD(result, list->buffer[i]);           \
+                                                              \
+        return result;                                        \
+    }
+
+#define CMC_GENERATE_HASHSET_FILTER(PFX, SNAME, V, NAME, PRED)                        \
+                                                                                      \
+    static bool PFX##_filter_into_##NAME(struct SNAME *from, struct SNAME *to)        \
+    {                                                                                 \
+        for (size_t i = 0; i < from->capacity; i++)                                   \
+        {                                                                             \
+            struct SNAME##_entry *entry = &from->buffer[i];                           \
+                                                                                      \
+            if (entry->state != CMC_ES_FILLED || !PRED(entry->value))                 \
+                continue;                                                             \
+                                                                                      \
+            if (!PFX##_insert(to, entry->value) && !PFX##_contains(to, entry->value)) \
+                return false;                                                         \
+        }                                                                             \
+                                                                                      \
+        return true;                                                                  \
+    }
+
+#define CMC_GENERATE_HASHSET_MAP(PFX, SNAME, V, NAME, MAP)                  \
+                                                                            \
+    static bool PFX##_map_into_##NAME(struct SNAME *from, struct SNAME *to) \
+    {                                                                       \
+        for (size_t i = 0; i < from->capacity; i++)                         \
+        {                                                                   \
+            if (from->buffer[i].state != CMC_ES_FILLED)                     \
+                continue;                                                   \
+                                                                            \
+            V value = MAP(from->buffer[i].value);                           \
+                                                                            \
+            if (!PFX##_insert(to, value) && !PFX##_contains(to, value))     \
+                return false;                                               \
+        }                                                                   \
+                                                                            \
+        return true;                                                        \
+    }
+
+#define CMC_GENERATE_HASHSET_FOLD(PFX, SNAME, V, NAME, R, FOLD) \
+                                                                \
+    static R PFX##_fold_##NAME(struct SNAME *set, R initial)    \
+    {                                                           \
+        R result = initial;                                     \
+                                                                \
+        for (size_t i = 0; i < set->capacity; i++)              \
+        {                                                       \
+            if (set->buffer[i].state == CMC_ES_FILLED)          \
+                result = FOLD(result, set->buffer[i].value);    \
+        }                                                       \
+                                                                \
+        return result;                                          \
+    }
+
+/* A pending migration of an INCREMENTAL HashMap is finished first, so */
+/* every entry is in its current buffer */
+#define CMC_GENERATE_HASHMAP_FILTER(PFX, SNAME, K, V, NAME, PRED)                        \
+                                                                                         \
+    static bool PFX##_filter_into_##NAME(struct SNAME *from, struct SNAME *to)           \
+    {                                                                                    \
+        PFX##_impl_migrate(from, SIZE_MAX);                                              \
+                                                                                         \
+        for (size_t i = 0; i < from->capacity; i++)                                      \
+        {                                                                                \
+            struct SNAME##_entry *entry = &from->buffer[i];                              \
+                                                                                         \
+            if (entry->state != CMC_ES_FILLED)                                           \
+                continue;                                                                \
+                                                                                         \
+            V value = *PFX##_impl_value(from, entry);                                    \
+                                                                                         \
+            if (!PRED(entry->key, value))                                                \
+                continue;                                                                \
+                                                                                         \
+            if (!PFX##_insert(to, entry->key, value) && !PFX##_contains(to, entry->key)) \
+                return false;                                                            \
+        }                                                                                \
+                                                                                         \
+        return true;                                                                     \
+    }
+
+#define CMC_GENERATE_HASHMAP_MAP(PFX, SNAME, K, V, NAME, MAP)               \
+                                                                            \
+    static bool PFX##_map_into_##NAME(struct SNAME *from, struct SNAME *to) \
+    {                                                                       \
+        PFX##_impl_migrate(from, SIZE_MAX);                                 \
+                                                                            \
+        for (size_t i = 0; i < from->capacity; i++)                         \
+        {                                                                   \
+            struct SNAME##_entry *entry = &from->buffer[i];                 \
+                                                                            \
+            if (entry->state != CMC_ES_FILLED)                              \
+                continue;                                                   \
+                                                                            \
+            V *ref = PFX##_impl_value(from, entry);                         \
+            V value = MAP(entry->key, *ref);                                \
+                                                                            \
+            if (from == to)                                                 \
+                *ref = value;                                               \
+            else if (!PFX##_insert(to, entry->key, value) &&                \
+                     !PFX##_contains(to, entry->key))                       \
+                return false;                                               \
+        }                                                                   \
+                                                                            \
+        return true;                                                        \
+    }
+
+#define CMC_GENERATE_HASHMAP_FOLD(PFX, SNAME, K, V, NAME, R, FOLD)                \
+                                                                                  \
+    static R PFX##_fold_##NAME(struct SNAME *map, R initial)                      \
+    {                                                                             \
+        PFX##_impl_migrate(map, SIZE_MAX);                                        \
+                                                                                  \
+        R result = initial;                                                       \
+                                                                                  \
+        for (size_t i = 0; i < map->capacity; i++)                                \
+        {                                                                         \
+            struct SNAME##_entry *entry = &map->buffer[i];                        \
+                                                                                  \
+            if (entry->state == CMC_ES_FILLED)                                    \
+                result = FOLD(result, entry->key, *PFX##_impl_value(map, entry)); \
+        }                                                                         \
+                                                                                  \
+        return result;                                                            \
+    }
+
+#define CMC_GENERATE_HASHMAP_FOLD_VALUES(PFX, SNAME, K, V, NAME, R, FOLD)     \
+                                                                              \
+    static R PFX##_fold_values_##NAME(struct SNAME *map, R initial)           \
+    {                                                                         \
+        PFX##_impl_migrate(map, SIZE_MAX);                                    \
+                                                                              \
+        R result = initial;                                                   \
+                                                                              \
+        for (size_t i = PFX##_impl_next_filled(map, 0); i < map->capacity;    \
+             i = PFX##_impl_next_filled(map, i + 1))                          \
+        {                                                                     \
+            result = FOLD(result, *PFX##_impl_value(map, &(map->buffer[i]))); \
+        }                                                                     \
+                                                                              \
+        return result;                                                        \
+    }
+
+#endif /* CMC_CALLBACK_H */
@@ -0,0 +1,79 @@
+/**
+ * cmc_cow.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Reference count of a buffer shared by copies of a collection in copy on */
+/* write mode. A collection that owns its buffer alone has no count, and */
+/* the first copy_of creates one with two references. Before modifying a */
+/* shared buffer a collection copies it and drops its reference, and the */
+/* last one to drop it frees the buffer. */
+
+/* The count is atomic, so copies sharing a buffer can be used, modified */
+/* and freed by different threads. Each copy must still only be used by */
+/* one thread at a time. */
+
+/* Only the List uses it. A HashMap would have to check for a shared buffer */
+/* even on lookups, which move entries while it grows incrementally, and it */
+/* keeps up to four buffers apart, or its entries inside the struct. */
+
+#ifndef CMC_COW_H
+#define CMC_COW_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "cmc_alloc.h"
+
+struct cmc_cow
+{
+    /* Collections sharing the buffer */
+    atomic_size_t refs;
+};
+
+/* Adds a reference for a new copy, creating the count if the buffer had */
+/* only one owner. Returns NULL if it could not be allocated */
+static inline struct cmc_cow *cmc_cow_share(struct cmc_cow *cow, struct cmc_alloc_node *alloc)
+{
+    if (cow)
+    {
+        atomic_fetch_add_explicit(&(cow->refs), 1, memory_order_relaxed);
+
+        return cow;
+    }
+
+    cow = alloc->malloc(sizeof(struct cmc_cow));
+
+    if (cow)
+        atomic_init(&(cow->refs), 2);
+
+    return cow;
+}
+
+/* If no other collection is using the buffer anymore */
+static inline bool cmc_cow_alone(struct cmc_cow *cow)
+{
+    return !cow || atomic_load_explicit(&(cow->refs), memory_order_acquire) == 1;
+}
+
+/* Drops a reference and returns true if it was the last one, in which case */
+/* the count is freed and the caller is the only owner of the buffer */
+static inline bool cmc_cow_release(struct cmc_cow *cow, struct cmc_alloc_node *alloc)
+{
+    if (!cow)
+        return true;
+
+    if (atomic_fetch_sub_explicit(&(cow->refs), 1, memory_order_acq_rel) != 1)
+        return false;
+
+    alloc->free(cow);
+
+    return true;
+}
+
+#endif /* CMC_COW_H */
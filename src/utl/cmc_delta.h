@@ -0,0 +1,645 @@
+/**
+ * cmc_delta.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Compression of sorted integers, like the posting lists of an index. A */
+/* cmc_delta keeps the difference between each value and the one before it */
+/* with group varint: every four differences share a control byte, with two */
+/* bits for each of them telling if it takes 1, 2, 4 or 8 bytes, followed */
+/* by their bytes, least significant first. Small gaps take one byte and */
+/* the widths of a whole group are known from a single byte. */
+/* Values are kept in blocks of CMC_DELTA_BLOCK and the first value of each */
+/* block is kept whole, so a block can be decoded on its own and contains */
+/* only decodes one block, found with a binary search over their first */
+/* values. */
+
+/* Groups without 8 byte differences take at most 16 bytes, and are spread */
+/* to their four values at once with a byte shuffle, with SSSE3 or NEON */
+/* when available, using a table of the shuffle for every control byte. */
+/* Other groups and builds without them decode one byte at a time. Define */
+/* CMC_DELTA_NO_SIMD to always do so. */
+
+/* Values are pushed in ascending order with cmc_delta_push and, once every */
+/* one of them was pushed, cmc_delta_finish writes the last group. The */
+/* encoding of values that are not in order is still exact but every one of */
+/* them takes 8 bytes and cmc_delta_contains can miss them. */
+
+/* The generators below add to a SortedList or a TreeSet of integers of any */
+/* width and signedness: */
+/* bool PFX##_to_delta(struct SNAME *coll, struct cmc_delta *delta), that */
+/* compresses the elements into a new cmc_delta, */
+/* struct SNAME *PFX##_from_delta(struct cmc_delta *delta, int (*compare)(V, V)), */
+/* that builds a new collection back from it, */
+/* bool PFX##_delta_contains(struct cmc_delta *delta, V element), */
+/* V PFX##_delta_value(struct cmc_delta_iter *iter), that converts the */
+/* current value of an iterator back to V, and */
+/* bool PFX##_save_delta(struct SNAME *coll, FILE *file) and */
+/* struct SNAME *PFX##_restore_delta(FILE *file, int (*compare)(V, V)), that */
+/* save and restore the collection in this format. The collection must be */
+/* ordered by the value of its elements. Signed integers are stored with */
+/* their sign bit flipped, so they keep their order as unsigned ones. */
+
+#ifndef CMC_DELTA_H
+#define CMC_DELTA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cmc_serial.h"
+
+#if !defined(CMC_DELTA_NO_SIMD) && defined(__SSSE3__)
+#define CMC_DELTA_SSSE3
+#include <tmmintrin.h>
+#elif !defined(CMC_DELTA_NO_SIMD) && defined(__ARM_NEON) && defined(__aarch64__) && \
+    defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define CMC_DELTA_NEON
+#include <arm_neon.h>
+#endif
+
+/* Amount of values in a block, a multiple of 4 */
+#ifndef CMC_DELTA_BLOCK
+#define CMC_DELTA_BLOCK 128
+#endif
+
+/* Converts an integer of type V to an unsigned 64 bit integer of the same */
+/* order and back */
+#define CMC_DELTA_FLIP(V) ((V)-1 > (V)0 ? 0 : (uint64_t)1 << 63)
+#define CMC_DELTA_TO(V, value) ((uint64_t)(int64_t)(value) ^ CMC_DELTA_FLIP(V))
+#define CMC_DELTA_FROM(V, value) ((V)(int64_t)((value) ^ CMC_DELTA_FLIP(V)))
+
+struct cmc_delta
+{
+    /* Encoded groups */
+    unsigned char *data;
+    size_t size;
+    size_t capacity;
+
+    /* Amount of values pushed */
+    size_t count;
+
+    /* First value and offset in data of every block */
+    uint64_t *firsts;
+    size_t *offsets;
+    size_t blocks;
+    size_t blocks_capacity;
+
+    /* Differences waiting for the rest of their group */
+    uint64_t pending[4];
+
+    /* Last value pushed */
+    uint64_t last;
+};
+
+/* Goes through the values of a cmc_delta, decoding one block at a time */
+struct cmc_delta_iter
+{
+    const struct cmc_delta *target;
+
+    /* Block in values and position of the current value in it */
+    size_t block;
+    size_t cursor;
+
+    /* Amount of values of the block in values */
+    size_t filled;
+
+    uint64_t values[CMC_DELTA_BLOCK];
+};
+
+/* Bytes taken by each code of a control byte */
+static const unsigned char cmc_delta_widths[4] = { 1, 2, 4, 8 };
+
+#if defined(CMC_DELTA_SSSE3) || defined(CMC_DELTA_NEON)
+
+/* Width of the value j of a group with control byte c, where its bytes */
+/* start after the control byte, and which of them goes to its byte b, */
+/* with 0x80 for the bytes that are zero */
+#define CMC_DELTA_W(c, j) (1 << (((c) >> (2 * (j))) & 3))
+#define CMC_DELTA_O(c, j)                                                   \
+    (((j) > 0 ? CMC_DELTA_W(c, 0) : 0) + ((j) > 1 ? CMC_DELTA_W(c, 1) : 0) + \
+     ((j) > 2 ? CMC_DELTA_W(c, 2) : 0))
+#define CMC_DELTA_B(c, j, b) ((b) < CMC_DELTA_W(c, j) ? CMC_DELTA_O(c, j) + (b) : 0x80)
+
+#define CMC_DELTA_VALUE(c, j)                                                            \
+    CMC_DELTA_B(c, j, 0), CMC_DELTA_B(c, j, 1), CMC_DELTA_B(c, j, 2), CMC_DELTA_B(c, j, 3), \
+        CMC_DELTA_B(c, j, 4), CMC_DELTA_B(c, j, 5), CMC_DELTA_B(c, j, 6), CMC_DELTA_B(c, j, 7)
+#define CMC_DELTA_ROW(c) \
+    { CMC_DELTA_VALUE(c, 0), CMC_DELTA_VALUE(c, 1), CMC_DELTA_VALUE(c, 2), CMC_DELTA_VALUE(c, 3) },
+#define CMC_DELTA_ROW4(c) \
+    CMC_DELTA_ROW(c) CMC_DELTA_ROW((c) + 1) CMC_DELTA_ROW((c) + 2) CMC_DELTA_ROW((c) + 3)
+#define CMC_DELTA_ROW16(c) \
+    CMC_DELTA_ROW4(c) CMC_DELTA_ROW4((c) + 4) CMC_DELTA_ROW4((c) + 8) CMC_DELTA_ROW4((c) + 12)
+#define CMC_DELTA_ROW64(c) \
+    CMC_DELTA_ROW16(c) CMC_DELTA_ROW16((c) + 16) CMC_DELTA_ROW16((c) + 32) CMC_DELTA_ROW16((c) + 48)
+
+/* Shuffle of the bytes after each control byte to its four values. Rows */
+/* of control bytes with an 8 byte value are never used */
+static const unsigned char cmc_delta_shuffle[256][32] = {
+    CMC_DELTA_ROW64(0) CMC_DELTA_ROW64(64) CMC_DELTA_ROW64(128) CMC_DELTA_ROW64(192)
+};
+
+#undef CMC_DELTA_ROW64
+#undef CMC_DELTA_ROW16
+#undef CMC_DELTA_ROW4
+#undef CMC_DELTA_ROW
+#undef CMC_DELTA_VALUE
+#undef CMC_DELTA_B
+#undef CMC_DELTA_O
+#undef CMC_DELTA_W
+
+/* Spreads the 16 bytes at in to the four values of a group with control */
+/* byte control, which has no 8 byte values */
+static inline void cmc_delta_shuffle_group(const unsigned char *in, unsigned char control,
+                                           uint64_t *group)
+{
+    const unsigned char *shuffle = cmc_delta_shuffle[control];
+
+#if defined(CMC_DELTA_SSSE3)
+    __m128i bytes = _mm_loadu_si128((const __m128i *)in);
+
+    _mm_storeu_si128((__m128i *)group,
+                     _mm_shuffle_epi8(bytes, _mm_loadu_si128((const __m128i *)shuffle)));
+    _mm_storeu_si128((__m128i *)(group + 2),
+                     _mm_shuffle_epi8(bytes, _mm_loadu_si128((const __m128i *)(shuffle + 16))));
+#else
+    uint8x16_t bytes = vld1q_u8(in);
+
+    vst1q_u8((uint8_t *)group, vqtbl1q_u8(bytes, vld1q_u8(shuffle)));
+    vst1q_u8((uint8_t *)(group + 2), vqtbl1q_u8(bytes, vld1q_u8(shuffle + 16)));
+#endif
+}
+
+#endif
+
+static inline void cmc_delta_init(struct cmc_delta *delta)
+{
+    memset(delta, 0, sizeof(*delta));
+}
+
+static inline void cmc_delta_release(struct cmc_delta *delta)
+{
+    free(delta->data);
+    free(delta->firsts);
+    free(delta->offsets);
+
+    cmc_delta_init(delta);
+}
+
+/* Bytes taken by the encoding of the values */
+static inline size_t cmc_delta_size(const struct cmc_delta *delta)
+{
+    return delta->size;
+}
+
+static inline unsigned cmc_delta_code(uint64_t value)
+{
+    if (value < ((uint64_t)1 << 8))
+        return 0;
+    if (value < ((uint64_t)1 << 16))
+        return 1;
+
+    return value < ((uint64_t)1 << 32) ? 2 : 3;
+}
+
+/* Bytes taken by a group with this control byte, itself included */
+static inline size_t cmc_delta_group_size(unsigned char control)
+{
+    return 1 + (size_t)cmc_delta_widths[control & 3] + cmc_delta_widths[(control >> 2) & 3] +
+           cmc_delta_widths[(control >> 4) & 3] + cmc_delta_widths[control >> 6];
+}
+
+static inline bool cmc_delta_write_group(struct cmc_delta *delta)
+{
+    if (delta->capacity - delta->size < 33)
+    {
+        size_t capacity = delta->capacity < 64 ? 128 : delta->capacity * 2;
+        unsigned char *data = realloc(delta->data, capacity);
+
+        if (!data)
+            return false;
+
+        delta->data = data;
+        delta->capacity = capacity;
+    }
+
+    unsigned char *out = delta->data + delta->size;
+    unsigned char control = 0;
+    size_t pos = 1;
+
+    for (int i = 0; i < 4; i++)
+    {
+        unsigned code = cmc_delta_code(delta->pending[i]);
+
+        control |= (unsigned char)(code << (2 * i));
+
+        for (unsigned b = 0; b < cmc_delta_widths[code]; b++)
+            out[pos++] = (unsigned char)(delta->pending[i] >> (8 * b));
+    }
+
+    out[0] = control;
+    delta->size += pos;
+
+    memset(delta->pending, 0, sizeof(delta->pending));
+
+    return true;
+}
+
+static inline bool cmc_delta_push(struct cmc_delta *delta, uint64_t value)
+{
+    size_t slot = delta->count % CMC_DELTA_BLOCK;
+
+    if (slot == 0)
+    {
+        if (delta->blocks == delta->blocks_capacity)
+        {
+            size_t capacity = delta->blocks_capacity == 0 ? 8 : delta->blocks_capacity * 2;
+            uint64_t *firsts = realloc(delta->firsts, capacity * sizeof(uint64_t));
+
+            if (!firsts)
+                return false;
+
+            delta->firsts = firsts;
+
+            size_t *offsets = realloc(delta->offsets, capacity * sizeof(size_t));
+
+            if (!offsets)
+                return false;
+
+            delta->offsets = offsets;
+            delta->blocks_capacity = capacity;
+        }
+
+        /* The first value of a block is a difference from 0 */
+        delta->firsts[delta->blocks] = value;
+        delta->offsets[delta->blocks] = delta->size;
+        delta->blocks++;
+        delta->last = 0;
+    }
+
+    delta->pending[slot % 4] = value - delta->last;
+    delta->last = value;
+    delta->count++;
+
+    if (slot % 4 == 3)
+        return cmc_delta_write_group(delta);
+
+    return true;
+}
+
+/* Writes the last group, padded with zeros. Nothing can be pushed after */
+static inline bool cmc_delta_finish(struct cmc_delta *delta)
+{
+    if (delta->count % 4 == 0)
+        return true;
+
+    return cmc_delta_write_group(delta);
+}
+
+/* Decodes block to out, which has room for CMC_DELTA_BLOCK values, and */
+/* returns how many values it has */
+static inline size_t cmc_delta_decode(const struct cmc_delta *delta, size_t block, uint64_t *out)
+{
+    size_t count = delta->count - block * CMC_DELTA_BLOCK;
+    const unsigned char *in = delta->data + delta->offsets[block];
+    uint64_t previous = 0;
+
+#if defined(CMC_DELTA_SSSE3) || defined(CMC_DELTA_NEON)
+    const unsigned char *end = delta->data + delta->size;
+#endif
+
+    if (count > CMC_DELTA_BLOCK)
+        count = CMC_DELTA_BLOCK;
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        unsigned char control = *in++;
+        uint64_t group[4];
+
+#if defined(CMC_DELTA_SSSE3) || defined(CMC_DELTA_NEON)
+        /* A code of 3 has both of its bits set. The vector is only loaded */
+        /* if it doesn't go past the end of the encoding */
+        if ((control & (control >> 1) & 0x55) == 0 && end - in >= 16)
+        {
+            cmc_delta_shuffle_group(in, control, group);
+            in += cmc_delta_group_size(control) - 1;
+        }
+        else
+#endif
+        {
+            for (int j = 0; j < 4; j++)
+            {
+                unsigned width = cmc_delta_widths[(control >> (2 * j)) & 3];
+                uint64_t value = 0;
+
+                for (unsigned b = 0; b < width; b++)
+                    value |= (uint64_t)in[b] << (8 * b);
+
+                group[j] = value;
+                in += width;
+            }
+        }
+
+        /* The padding of the last group is never written out */
+        size_t n = count - i < 4 ? count - i : 4;
+
+        for (size_t j = 0; j < n; j++)
+            out[i + j] = previous += group[j];
+    }
+
+    return count;
+}
+
+static inline bool cmc_delta_contains(const struct cmc_delta *delta, uint64_t value)
+{
+    if (delta->blocks == 0 || value < delta->firsts[0])
+        return false;
+
+    /* Last block that starts at or before value */
+    size_t lo = 0, hi = delta->blocks;
+
+    while (hi - lo > 1)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+
+        if (delta->firsts[mid] <= value)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    uint64_t values[CMC_DELTA_BLOCK];
+    size_t count = cmc_delta_decode(delta, lo, values);
+
+    for (size_t i = 0; i < count && values[i] <= value; i++)
+    {
+        if (values[i] == value)
+            return true;
+    }
+
+    return false;
+}
+
+/* Writes a header with CMC_SERIAL_DELTA followed by the size of the */
+/* encoding, as 64 bits, and the encoding. The last group must be written */
+static inline bool cmc_delta_save(const struct cmc_delta *delta, FILE *file,
+                                  const char *collection, size_t value_size)
+{
+    uint64_t size = delta->size;
+
+    if (!cmc_serial_write_header(file, collection, CMC_SERIAL_DELTA, 0, value_size, 0,
+                                 delta->count, delta->count, 0))
+        return false;
+
+    return fwrite(&size, sizeof(size), 1, file) == 1 &&
+           fwrite(delta->data, 1, delta->size, file) == delta->size;
+}
+
+/* Reads the encoding saved by cmc_delta_save to a new delta and finds */
+/* where its blocks start */
+static inline bool cmc_delta_load(struct cmc_delta *delta, FILE *file, const char *collection,
+                                  size_t value_size)
+{
+    struct cmc_serial_header header;
+    uint64_t size;
+
+    cmc_delta_init(delta);
+
+    if (!cmc_serial_read_header(file, collection, 0, value_size, &header) ||
+        !(header.flags & CMC_SERIAL_DELTA) || header.value_size != value_size ||
+        fread(&size, sizeof(size), 1, file) != 1 || size > SIZE_MAX ||
+        header.count / 4 > size)
+        return false;
+
+    size_t count = (size_t)header.count;
+    size_t blocks = (count + CMC_DELTA_BLOCK - 1) / CMC_DELTA_BLOCK;
+
+    delta->data = malloc(size > 0 ? (size_t)size : 1);
+    delta->firsts = malloc((blocks > 0 ? blocks : 1) * sizeof(uint64_t));
+    delta->offsets = malloc((blocks > 0 ? blocks : 1) * sizeof(size_t));
+
+    if (!delta->data || !delta->firsts || !delta->offsets ||
+        fread(delta->data, 1, (size_t)size, file) != size)
+    {
+        cmc_delta_release(delta);
+        return false;
+    }
+
+    delta->size = delta->capacity = (size_t)size;
+    delta->count = count;
+    delta->blocks = delta->blocks_capacity = blocks;
+
+    size_t pos = 0;
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        if (pos >= delta->size || delta->size - pos < cmc_delta_group_size(delta->data[pos]))
+        {
+            cmc_delta_release(delta);
+            return false;
+        }
+
+        if (i % CMC_DELTA_BLOCK == 0)
+        {
+            size_t block = i / CMC_DELTA_BLOCK;
+            unsigned width = cmc_delta_widths[delta->data[pos] & 3];
+            uint64_t first = 0;
+
+            for (unsigned b = 0; b < width; b++)
+                first |= (uint64_t)delta->data[pos + 1 + b] << (8 * b);
+
+            delta->firsts[block] = first;
+            delta->offsets[block] = pos;
+        }
+
+        pos += cmc_delta_group_size(delta->data[pos]);
+    }
+
+    return pos == delta->size;
+}
+
+static inline void cmc_delta_iter_init(struct cmc_delta_iter *iter, const struct cmc_delta *target)
+{
+    iter->target = target;
+    iter->block = 0;
+    iter->cursor = 0;
+    iter->filled = target->count > 0 ? cmc_delta_decode(target, 0, iter->values) : 0;
+}
+
+static inline bool cmc_delta_iter_end(struct cmc_delta_iter *iter)
+{
+    return iter->cursor >= iter->filled;
+}
+
+static inline bool cmc_delta_iter_next(struct cmc_delta_iter *iter)
+{
+    if (iter->cursor + 1 < iter->filled)
+    {
+        iter->cursor++;
+        return true;
+    }
+
+    if (iter->block + 1 >= iter->target->blocks)
+    {
+        iter->cursor = iter->filled;
+        return false;
+    }
+
+    iter->block++;
+    iter->cursor = 0;
+    iter->filled = cmc_delta_decode(iter->target, iter->block, iter->values);
+
+    return true;
+}
+
+static inline uint64_t cmc_delta_iter_value(struct cmc_delta_iter *iter)
+{
+    return iter->values[iter->cursor];
+}
+
+/* Position of the current value among all of them */
+static inline size_t cmc_delta_iter_index(struct cmc_delta_iter *iter)
+{
+    return iter->block * CMC_DELTA_BLOCK + iter->cursor;
+}
+
+#define CMC_GENERATE_SORTEDLIST_DELTA(PFX, SNAME, V)                                     \
+                                                                                         \
+    static bool PFX##_impl_delta_push_all(struct SNAME *coll, struct cmc_delta *delta)   \
+    {                                                                                    \
+        PFX##_sort(coll);                                                                \
+                                                                                         \
+        for (size_t i = 0; i < coll->count; i++)                                         \
+        {                                                                                \
+            if (!cmc_delta_push(delta, CMC_DELTA_TO(V, coll->buffer[i])))                \
+                return false;                                                            \
+        }                                                                                \
+                                                                                         \
+        return true;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    /* The values are decoded straight to the buffer of the list */                      \
+    static struct SNAME *PFX##_from_delta(struct cmc_delta *delta, int (*compare)(V, V)) \
+    {                                                                                    \
+        struct SNAME *coll = PFX##_new(delta->count > 0 ? delta->count : 1, compare);    \
+        uint64_t values[CMC_DELTA_BLOCK];                                                \
+                                                                                         \
+        if (!coll)                                                                       \
+            return NULL;                                                                 \
+                                                                                         \
+        for (size_t block = 0; block < delta->blocks; block++)                           \
+        {                                                                                \
+            size_t count = cmc_delta_decode(delta, block, values);                       \
+                                                                                         \
+            for (size_t i = 0; i < count; i++)                                           \
+                coll->buffer[coll->count++] = CMC_DELTA_FROM(V, values[i]);              \
+        }                                                                                \
+                                                                                         \
+        coll->sorted = coll->count;                                                      \
+                                                                                         \
+        return coll;                                                                     \
+    }                                                                                    \
+                                                                                         \
+    CMC_IMPL_DELTA(PFX, SNAME, V, "sortedlist")
+
+#define CMC_GENERATE_TREESET_DELTA(PFX, SNAME, V)                                          \
+                                                                                           \
+    static bool PFX##_impl_delta_push_all(struct SNAME *coll, struct cmc_delta *delta)     \
+    {                                                                                      \
+        struct SNAME##_iter iter;                                                          \
+                                                                                           \
+        for (PFX##_iter_init(&iter, coll); !PFX##_iter_end(&iter); PFX##_iter_next(&iter)) \
+        {                                                                                  \
+            if (!cmc_delta_push(delta, CMC_DELTA_TO(V, PFX##_iter_value(&iter))))          \
+                return false;                                                              \
+        }                                                                                  \
+                                                                                           \
+        return true;                                                                       \
+    }                                                                                      \
+                                                                                           \
+    /* The tree is built in linear time from the decoded values */                         \
+    static struct SNAME *PFX##_from_delta(struct cmc_delta *delta, int (*compare)(V, V))   \
+    {                                                                                      \
+        V *array = malloc((delta->count > 0 ? delta->count : 1) * sizeof(V));              \
+        struct cmc_delta_iter iter;                                                        \
+        size_t count = 0;                                                                  \
+                                                                                           \
+        if (!array)                                                                        \
+            return NULL;                                                                   \
+                                                                                           \
+        for (cmc_delta_iter_init(&iter, delta); !cmc_delta_iter_end(&iter);                \
+             cmc_delta_iter_next(&iter))                                                   \
+            array[count++] = CMC_DELTA_FROM(V, cmc_delta_iter_value(&iter));               \
+                                                                                           \
+        struct SNAME *coll = PFX##_new_from_sorted(compare, array, count);                 \
+                                                                                           \
+        free(array);                                                                       \
+                                                                                           \
+        return coll;                                                                       \
+    }                                                                                      \
+                                                                                           \
+    CMC_IMPL_DELTA(PFX, SNAME, V, "treeset")
+
+/* Shared by the generators, that define PFX##_impl_delta_push_all and */        \
+/* PFX##_from_delta */                                                           \
+#define CMC_IMPL_DELTA(PFX, SNAME, V, COLLECTION)                                \
+                                                                                 \
+    static bool PFX##_to_delta(struct SNAME *coll, struct cmc_delta *delta)      \
+    {                                                                            \
+        cmc_delta_init(delta);                                                   \
+                                                                                 \
+        if (!PFX##_impl_delta_push_all(coll, delta) || !cmc_delta_finish(delta)) \
+        {                                                                        \
+            cmc_delta_release(delta);                                            \
+            return false;                                                        \
+        }                                                                        \
+                                                                                 \
+        return true;                                                             \
+    }                                                                            \
+                                                                                 \
+    static bool PFX##_delta_contains(struct cmc_delta *delta, V element)         \
+    {                                                                            \
+        return cmc_delta_contains(delta, CMC_DELTA_TO(V, element));              \
+    }                                                                            \
+                                                                                 \
+    static V PFX##_delta_value(struct cmc_delta_iter *iter)                      \
+    {                                                                            \
+        return CMC_DELTA_FROM(V, cmc_delta_iter_value(iter));                    \
+    }                                                                            \
+                                                                                 \
+    static bool PFX##_save_delta(struct SNAME *coll, FILE *file)                 \
+    {                                                                            \
+        struct cmc_delta delta;                                                  \
+                                                                                 \
+        if (!PFX##_to_delta(coll, &delta))                                       \
+            return false;                                                        \
+                                                                                 \
+        bool saved = cmc_delta_save(&delta, file, COLLECTION, sizeof(V));        \
+                                                                                 \
+        cmc_delta_release(&delta);                                               \
+                                                                                 \
+        return saved;                                                            \
+    }                                                                            \
+                                                                                 \
+    static struct SNAME *PFX##_restore_delta(FILE *file, int (*compare)(V, V))   \
+    {                                                                            \
+        struct cmc_delta delta;                                                  \
+                                                                                 \
+        if (!cmc_delta_load(&delta, file, COLLECTION, sizeof(V)))                \
+            return NULL;                                                         \
+                                                                                 \
+        struct SNAME *coll = PFX##_from_delta(&delta, compare);                  \
+                                                                                 \
+        cmc_delta_release(&delta);                                               \
+                                                                                 \
+        return coll;                                                             \
+    }
+
+#endif /* CMC_DELTA_H */
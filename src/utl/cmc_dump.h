@@ -0,0 +1,281 @@
+/**
+ * cmc_dump.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Writing every element of a collection, one per line, as text. The */
+/* collections that can be iterated have PFX##_write(coll, file, fmt), */
+/* that calls fmt(file, element) for each element, in the order of their */
+/* iterators, and then writes a new line, so the buffering is the one of */
+/* the FILE. PFX##_write_fd(coll, fd, fmt) does the same into a struct */
+/* cmc_dump, a buffer of CMC_DUMP_BUFFER bytes that is given to a single */
+/* write(2) every time it is full. Maps pass both the key and the value */
+/* of an entry to fmt, in this order. Both return false if anything could */
+/* not be written. */
+
+/* Integers are formatted two digits at a time from a table, without */
+/* going through the format string parsing of printf. The formatters for */
+/* the common scalar types, like cmc_fdump_size_t for PFX##_write and */
+/* cmc_dump_size_t for PFX##_write_fd, can be passed as fmt directly, and */
+/* the ones of a map can call them for its keys and values. */
+
+#ifndef CMC_DUMP_H
+#define CMC_DUMP_H
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Size of the buffer of PFX##_write_fd */
+#ifndef CMC_DUMP_BUFFER
+#define CMC_DUMP_BUFFER 65536
+#endif
+
+/* Enough characters for any 64 bit integer with its sign */
+#define CMC_DUMP_DIGITS 20
+
+struct cmc_dump
+{
+    int fd;
+    bool failed;
+    size_t length;
+    char buffer[CMC_DUMP_BUFFER];
+};
+
+static const char cmc_dump_pairs[] = "00010203040506070809"
+                                     "10111213141516171819"
+                                     "20212223242526272829"
+                                     "30313233343536373839"
+                                     "40414243444546474849"
+                                     "50515253545556575859"
+                                     "60616263646566676869"
+                                     "70717273747576777879"
+                                     "80818283848586878889"
+                                     "90919293949596979899";
+
+/* Writes the digits of value so that they end right before end and */
+/* returns where they start */
+static inline char *cmc_dump_format_unsigned(char *end, uint64_t value)
+{
+    while (value >= 100)
+    {
+        const char *pair = cmc_dump_pairs + (value % 100) * 2;
+
+        value /= 100;
+        *--end = pair[1];
+        *--end = pair[0];
+    }
+
+    if (value >= 10)
+    {
+        *--end = cmc_dump_pairs[value * 2 + 1];
+        *--end = cmc_dump_pairs[value * 2];
+    }
+    else
+        *--end = (char)('0' + value);
+
+    return end;
+}
+
+static inline char *cmc_dump_format_signed(char *end, int64_t value)
+{
+    if (value >= 0)
+        return cmc_dump_format_unsigned(end, (uint64_t)value);
+
+    /* Negated as unsigned, which also works for INT64_MIN */
+    char *start = cmc_dump_format_unsigned(end, 0 - (uint64_t)value);
+
+    *--start = '-';
+
+    return start;
+}
+
+static inline void cmc_dump_init(struct cmc_dump *dump, int fd)
+{
+    dump->fd = fd;
+    dump->failed = false;
+    dump->length = 0;
+}
+
+/* Writes everything in the buffer to the file descriptor */
+static inline bool cmc_dump_flush(struct cmc_dump *dump)
+{
+    size_t done = 0;
+
+    while (!dump->failed && done < dump->length)
+    {
+        ssize_t written = write(dump->fd, dump->buffer + done, dump->length - done);
+
+        if (written >= 0)
+            done += (size_t)written;
+        else if (errno != EINTR)
+            dump->failed = true;
+    }
+
+    dump->length = 0;
+
+    return !dump->failed;
+}
+
+static inline void cmc_dump_bytes(struct cmc_dump *dump, const char *data, size_t size)
+{
+    while (size > CMC_DUMP_BUFFER - dump->length)
+    {
+        size_t part = CMC_DUMP_BUFFER - dump->length;
+
+        memcpy(dump->buffer + dump->length, data, part);
+        dump->length += part;
+        data += part;
+        size -= part;
+
+        if (!cmc_dump_flush(dump))
+            return;
+    }
+
+    memcpy(dump->buffer + dump->length, data, size);
+    dump->length += size;
+}
+
+static inline void cmc_dump_str(struct cmc_dump *dump, const char *string)
+{
+    cmc_dump_bytes(dump, string, strlen(string));
+}
+
+static inline void cmc_dump_char(struct cmc_dump *dump, char c)
+{
+    if (dump->length == CMC_DUMP_BUFFER)
+        cmc_dump_flush(dump);
+
+    dump->buffer[dump->length++] = c;
+}
+
+static inline void cmc_dump_u64(struct cmc_dump *dump, uint64_t value)
+{
+    char digits[CMC_DUMP_DIGITS];
+    char *end = digits + CMC_DUMP_DIGITS;
+    char *start = cmc_dump_format_unsigned(end, value);
+
+    cmc_dump_bytes(dump, start, (size_t)(end - start));
+}
+
+static inline void cmc_dump_i64(struct cmc_dump *dump, int64_t value)
+{
+    char digits[CMC_DUMP_DIGITS];
+    char *end = digits + CMC_DUMP_DIGITS;
+    char *start = cmc_dump_format_signed(end, value);
+
+    cmc_dump_bytes(dump, start, (size_t)(end - start));
+}
+
+static inline void cmc_fdump_u64(FILE *file, uint64_t value)
+{
+    char digits[CMC_DUMP_DIGITS];
+    char *end = digits + CMC_DUMP_DIGITS;
+    char *start = cmc_dump_format_unsigned(end, value);
+
+    fwrite(start, 1, (size_t)(end - start), file);
+}
+
+static inline void cmc_fdump_i64(FILE *file, int64_t value)
+{
+    char digits[CMC_DUMP_DIGITS];
+    char *end = digits + CMC_DUMP_DIGITS;
+    char *start = cmc_dump_format_signed(end, value);
+
+    fwrite(start, 1, (size_t)(end - start), file);
+}
+
+/* Formatters of a scalar type T for both PFX##_write and PFX##_write_fd */
+#define CMC_IMPL_DUMP_SCALAR(NAME, T, KIND)                            \
+    static inline void cmc_dump_##NAME(struct cmc_dump *dump, T value) \
+    {                                                                  \
+        cmc_dump_##KIND(dump, value);                                  \
+    }                                                                  \
+                                                                       \
+    static inline void cmc_fdump_##NAME(FILE *file, T value)           \
+    {                                                                  \
+        cmc_fdump_##KIND(file, value);                                 \
+    }
+
+CMC_IMPL_DUMP_SCALAR(int, int, i64)
+CMC_IMPL_DUMP_SCALAR(unsigned, unsigned, u64)
+CMC_IMPL_DUMP_SCALAR(int32_t, int32_t, i64)
+CMC_IMPL_DUMP_SCALAR(uint32_t, uint32_t, u64)
+CMC_IMPL_DUMP_SCALAR(int64_t, int64_t, i64)
+CMC_IMPL_DUMP_SCALAR(uint64_t, uint64_t, u64)
+CMC_IMPL_DUMP_SCALAR(size_t, size_t, u64)
+
+/* Floating point numbers still go through printf */
+static inline void cmc_dump_double(struct cmc_dump *dump, double value)
+{
+    char digits[32];
+    int length = snprintf(digits, sizeof(digits), "%.17g", value);
+
+    if (length > 0)
+        cmc_dump_bytes(dump, digits, (size_t)length);
+}
+
+static inline void cmc_fdump_double(FILE *file, double value)
+{
+    fprintf(file, "%.17g", value);
+}
+
+#define CMC_IMPL_DUMP_UNPACK(...) __VA_ARGS__
+
+/* Defines PFX##_write and PFX##_write_fd for a collection whose iterators */
+/* are initialized from a struct TARGET. ELEMENT is CMC_IMPL_STRING_VALUE */
+/* or CMC_IMPL_STRING_ENTRY, of cmc_string.h, and TYPES the parenthesized */
+/* types that come after the first argument of fmt, like (V) or (K, V) */
+#define CMC_IMPL_DUMP(PFX, SNAME, TARGET, ELEMENT, TYPES)                             \
+                                                                                      \
+    bool PFX##_write(struct TARGET *target, FILE *file,                               \
+                     void (*fmt)(FILE *, CMC_IMPL_DUMP_UNPACK TYPES))                 \
+    {                                                                                 \
+        struct SNAME##_iter iter;                                                     \
+                                                                                      \
+        for (PFX##_iter_init(&iter, target); !PFX##_iter_end(&iter);                  \
+             PFX##_iter_next(&iter))                                                  \
+        {                                                                             \
+            fmt(file, ELEMENT(PFX, iter));                                            \
+            putc('\n', file);                                                         \
+        }                                                                             \
+                                                                                      \
+        return !ferror(file);                                                         \
+    }                                                                                 \
+                                                                                      \
+    bool PFX##_write_fd(struct TARGET *target, int fd,                                \
+                        void (*fmt)(struct cmc_dump *, CMC_IMPL_DUMP_UNPACK TYPES))   \
+    {                                                                                 \
+        struct cmc_dump *dump = malloc(sizeof(struct cmc_dump));                      \
+        struct SNAME##_iter iter;                                                     \
+                                                                                      \
+        if (!dump)                                                                    \
+            return false;                                                             \
+                                                                                      \
+        cmc_dump_init(dump, fd);                                                      \
+                                                                                      \
+        for (PFX##_iter_init(&iter, target); !PFX##_iter_end(&iter) && !dump->failed; \
+             PFX##_iter_next(&iter))                                                  \
+        {                                                                             \
+            fmt(dump, ELEMENT(PFX, iter));                                            \
+            cmc_dump_char(dump, '\n');                                                \
+        }                                                                             \
+                                                                                      \
+        bool result = cmc_dump_flush(dump);                                           \
+                                                                                      \
+        free(dump);                                                                   \
+                                                                                      \
+        return result;                                                                \
+    }
+
+#endif /* CMC_DUMP_H */
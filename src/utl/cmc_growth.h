@@ -0,0 +1,73 @@
+/**
+ * cmc_growth.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Growth policy shared by the collections backed by a single array: List, */
+/* SortedList, Stack, Queue, Deque, Heap and IntervalHeap. When one of them */
+/* is full its new capacity is CMC_GROWTH_POLICY(capacity, required), where */
+/* required is the least capacity that fits what is being added. */
+
+/* By default the capacity is multiplied by CMC_GROWTH_FACTOR and then */
+/* CMC_GROWTH_STEP is added to it, so a factor of 1.0 and a step grow it */
+/* linearly. Both can be defined before including a collection, or */
+/* CMC_GROWTH_POLICY can be defined as any other expression of both */
+/* arguments. A policy that returns less than required gets required. */
+
+/* Queue and Deque are circular arrays. With CMC_RING_POW2 defined as 1 */
+/* their capacities are always rounded up to a power of two, so an index */
+/* wraps around by masking it with capacity - 1 instead of comparing it. */
+
+#ifndef CMC_GROWTH_H
+#define CMC_GROWTH_H
+
+#include <stddef.h>
+
+#ifndef CMC_GROWTH_FACTOR
+#define CMC_GROWTH_FACTOR 2.0
+#endif
+
+#ifndef CMC_GROWTH_STEP
+#define CMC_GROWTH_STEP 0
+#endif
+
+#ifndef CMC_GROWTH_POLICY
+#define CMC_GROWTH_POLICY(capacity, required) cmc_growth_next(capacity, required)
+#endif
+
+#ifndef CMC_RING_POW2
+#define CMC_RING_POW2 0
+#endif
+
+static inline size_t cmc_growth_next(size_t capacity, size_t required)
+{
+    size_t next = (size_t)((double)capacity * CMC_GROWTH_FACTOR) + CMC_GROWTH_STEP;
+
+    return next > required ? next : required;
+}
+
+/* Capacity that a full collection grows to so that required elements fit */
+static inline size_t cmc_growth_capacity(size_t capacity, size_t required)
+{
+    size_t next = CMC_GROWTH_POLICY(capacity, required);
+
+    return next > required ? next : required;
+}
+
+/* Least power of two not less than capacity */
+static inline size_t cmc_growth_pow2(size_t capacity)
+{
+    size_t result = 1;
+
+    while (result < capacity)
+        result *= 2;
+
+    return result;
+}
+
+#endif /* CMC_GROWTH_H */
@@ -0,0 +1,135 @@
+/**
+ * cmc_math.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Small numeric helpers shared by the probabilistic collections. They */
+/* don't depend on libm so that no collection has to be linked with -lm */
+
+#ifndef CMC_MATH_H
+#define CMC_MATH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Natural logarithm of x > 0 */
+static inline double cmc_math_ln(double x)
+{
+    int e = 0;
+
+    /* x = m * 2^e with m in [1, 2) */
+    while (x < 1.0)
+    {
+        x *= 2.0;
+        e--;
+    }
+
+    while (x >= 2.0)
+    {
+        x /= 2.0;
+        e++;
+    }
+
+    /* ln(m) = 2 * atanh((m - 1) / (m + 1)), which converges fast for m < 2 */
+    double y = (x - 1.0) / (x + 1.0);
+    double y2 = y * y;
+    double term = y;
+    double sum = 0.0;
+
+    for (int i = 1; i < 40; i += 2)
+    {
+        sum += term / i;
+        term *= y2;
+    }
+
+    return 2.0 * sum + e * 0.69314718055994530942;
+}
+
+/* Square root of x >= 0 by Newton's method */
+static inline double cmc_math_sqrt(double x)
+{
+    if (x <= 0.0)
+        return 0.0;
+
+    double r = x > 1.0 ? x : 1.0;
+
+    /* Decreases monotonically towards the root, stopping when it can't */
+    for (int i = 0; i < 1100; i++)
+    {
+        double next = 0.5 * (r + x / r);
+
+        if (next >= r)
+            break;
+
+        r = next;
+    }
+
+    return r;
+}
+
+/* Amount of bits set in a word */
+static inline size_t cmc_math_popcount(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_popcountll(word);
+#else
+    size_t count = 0;
+
+    while (word)
+    {
+        word &= word - 1;
+        count++;
+    }
+
+    return count;
+#endif
+}
+
+/* Amount of leading zero bits of a word, 64 if it is 0 */
+static inline size_t cmc_math_clz(uint64_t word)
+{
+    if (word == 0)
+        return 64;
+
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_clzll(word);
+#else
+    size_t count = 0;
+
+    while (!(word & (UINT64_C(1) << 63)))
+    {
+        word <<= 1;
+        count++;
+    }
+
+    return count;
+#endif
+}
+
+/* Amount of trailing zero bits of a word, 64 if it is 0 */
+static inline size_t cmc_math_ctz(uint64_t word)
+{
+    if (word == 0)
+        return 64;
+
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_ctzll(word);
+#else
+    size_t count = 0;
+
+    while (!(word & 1))
+    {
+        word >>= 1;
+        count++;
+    }
+
+    return count;
+#endif
+}
+
+#endif /* CMC_MATH_H */
@@ -0,0 +1,206 @@
+/**
+ * cmc_parallel.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Splitting a scan over a collection among threads. Array based collections */
+/* are split into contiguous ranges of their elements and hashtables into */
+/* ranges of their slots, from 0 to their capacity, so every thread gets the */
+/* same amount of memory to go through. */
+
+/* CMC_PARALLEL_FOR_EACH(PFX, SNAME, TARGET, THREADS, BODY) runs BODY once */
+/* for every element of TARGET with an iterator named iter placed at it, so */
+/* BODY can use the iterator access functions like PFX##_iter_value or */
+/* PFX##_iter_key. The slots are shared by an OpenMP team of up to THREADS */
+/* threads when compiled with OpenMP, and otherwise BODY runs on the calling */
+/* thread. BODY must not change the collection nor break out of the loop, */
+/* and anything that it writes outside of the element is shared by every */
+/* thread. The collections that support it have PFX##_parallel_slots, that */
+/* returns how many slots there are, and PFX##_parallel_iter, that places */
+/* an iterator at a slot and tells if there is an element there. */
+
+/* PFX##_parallel_reduce, in the same collections, does the same split with */
+/* POSIX threads. Every thread starts a partial result from the given */
+/* initial value and reduces its range into it, so the initial value should */
+/* change nothing when combined, like 0 for a sum. The partial results are */
+/* then combined, in order, on the calling thread. */
+
+/* CMC_GENERATE_PARALLEL_REDUCE(FNAME, SNAME, V, ARGS, FILLED, REDUCE) */
+/* generates static V FNAME(struct SNAME *target, size_t slots, V initial, */
+/* V (*reduce) ARGS, V (*combine)(V, V), size_t threads) and its helpers, */
+/* named FNAME_*. ARGS is the parenthesized parameter list of reduce, */
+/* FILLED(target, slot) tells if a slot has an element and */
+/* REDUCE(task, slot) returns task->partial with the element at slot of */
+/* task->target reduced into it by task->reduce. */
+
+#ifndef CMC_PARALLEL_H
+#define CMC_PARALLEL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/* Least amount of slots that a parallel scan gives to each thread */
+#ifndef CMC_PARALLEL_SIZE
+#define CMC_PARALLEL_SIZE 4096
+#endif
+
+#ifdef _OPENMP
+#define CMC_IMPL_PARALLEL_PRAGMA(X) _Pragma(#X)
+#define CMC_IMPL_PARALLEL_FOR(THREADS) \
+    CMC_IMPL_PARALLEL_PRAGMA(omp parallel for num_threads(THREADS) schedule(static))
+#else
+#define CMC_IMPL_PARALLEL_FOR(THREADS)
+#endif
+
+/* Slot helpers for CMC_GENERATE_PARALLEL_REDUCE. Every slot of an array */
+/* based collection has an element and hashtables mark the filled ones. */
+/* Maps that keep their values apart have them at the index of the slot */
+#define CMC_IMPL_PARALLEL_ANY(target, slot) true
+#define CMC_IMPL_PARALLEL_FILLED(target, slot) ((target)->buffer[slot].state == CMC_ES_FILLED)
+#define CMC_IMPL_PARALLEL_ELEMENT(task, slot) \
+    (task)->reduce((task)->partial, (task)->target->buffer[slot])
+#define CMC_IMPL_PARALLEL_VALUE(task, slot) \
+    (task)->reduce((task)->partial, (task)->target->buffer[slot].value)
+#define CMC_IMPL_PARALLEL_ENTRY(task, slot)                            \
+    (task)->reduce((task)->partial, (task)->target->buffer[slot].key, \
+                   (task)->target->buffer[slot].value)
+#define CMC_IMPL_PARALLEL_SPLIT_ENTRY(task, slot)                      \
+    (task)->reduce((task)->partial, (task)->target->buffer[slot].key, \
+                   (task)->target->values[slot])
+
+#define CMC_PARALLEL_FOR_EACH(PFX, SNAME, TARGET, THREADS, BODY)                                 \
+    do                                                                                           \
+    {                                                                                            \
+        struct SNAME *const cmc_par_target_ = (TARGET);                                          \
+        const size_t cmc_par_slots_ = PFX##_parallel_slots(cmc_par_target_);                     \
+        const int cmc_par_threads_ = (int)cmc_parallel_threads(cmc_par_slots_, (THREADS));       \
+                                                                                                 \
+        (void)cmc_par_threads_;                                                                  \
+                                                                                                 \
+        CMC_IMPL_PARALLEL_FOR(cmc_par_threads_)                                                  \
+        for (size_t cmc_par_slot_ = 0; cmc_par_slot_ < cmc_par_slots_; cmc_par_slot_++)          \
+        {                                                                                        \
+            struct SNAME##_iter iter;                                                            \
+                                                                                                 \
+            if (PFX##_parallel_iter(&iter, cmc_par_target_, cmc_par_slot_))                      \
+            {                                                                                    \
+                BODY;                                                                            \
+            }                                                                                    \
+        }                                                                                        \
+    } while (0)
+
+/* How many threads a scan over slots is split into, at least one and no */
+/* more than one for every CMC_PARALLEL_SIZE slots */
+static inline size_t cmc_parallel_threads(size_t slots, size_t threads)
+{
+    if (threads > slots / CMC_PARALLEL_SIZE)
+        threads = slots / CMC_PARALLEL_SIZE;
+
+    return threads > 0 ? threads : 1;
+}
+
+/* First slot of the range of thread t out of threads */
+static inline size_t cmc_parallel_bound(size_t slots, size_t threads, size_t t)
+{
+    return t == threads ? slots : slots / threads * t;
+}
+
+/* Calls worker on each of the count tasks, of size bytes each. The last */
+/* task runs on the calling thread, and so does every task whose thread */
+/* could not be created */
+static inline void cmc_parallel_run(void *tasks, size_t size, size_t count, void *(*worker)(void *))
+{
+    pthread_t *ids = count > 1 ? malloc(sizeof(pthread_t) * count) : NULL;
+    bool *started = ids ? malloc(sizeof(bool) * count) : NULL;
+
+    for (size_t t = 0; t < count; t++)
+    {
+        void *task = (char *)tasks + size * t;
+        bool spawned = started && t + 1 < count && pthread_create(&ids[t], NULL, worker, task) == 0;
+
+        if (started)
+            started[t] = spawned;
+
+        if (!spawned)
+            worker(task);
+    }
+
+    for (size_t t = 0; started && t < count; t++)
+    {
+        if (started[t])
+            pthread_join(ids[t], NULL);
+    }
+
+    free(ids);
+    free(started);
+}
+
+#define CMC_GENERATE_PARALLEL_REDUCE(FNAME, SNAME, V, ARGS, FILLED, REDUCE)                  \
+                                                                                             \
+    /* Reduces the slots of target from begin to end, exclusive */                           \
+    struct FNAME##_task                                                                      \
+    {                                                                                        \
+        struct SNAME *target;                                                                \
+        V (*reduce) ARGS;                                                                    \
+        V partial;                                                                           \
+        size_t begin;                                                                        \
+        size_t end;                                                                          \
+    };                                                                                       \
+                                                                                             \
+    static void *FNAME##_worker(void *arg)                                                   \
+    {                                                                                        \
+        struct FNAME##_task *task = arg;                                                     \
+                                                                                             \
+        for (size_t slot = task->begin; slot < task->end; slot++)                            \
+        {                                                                                    \
+            if (FILLED(task->target, slot))                                                  \
+                task->partial = REDUCE(task, slot);                                          \
+        }                                                                                    \
+                                                                                             \
+        return NULL;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    static V FNAME(struct SNAME *target, size_t slots, V initial, V (*reduce) ARGS,          \
+                   V (*combine)(V, V), size_t threads)                                       \
+    {                                                                                        \
+        threads = cmc_parallel_threads(slots, threads);                                      \
+                                                                                             \
+        struct FNAME##_task single;                                                          \
+        struct FNAME##_task *tasks = threads > 1 ? malloc(sizeof(*tasks) * threads) : NULL;  \
+                                                                                             \
+        if (!tasks)                                                                          \
+        {                                                                                    \
+            tasks = &single;                                                                 \
+            threads = 1;                                                                     \
+        }                                                                                    \
+                                                                                             \
+        for (size_t t = 0; t < threads; t++)                                                 \
+        {                                                                                    \
+            tasks[t].target = target;                                                        \
+            tasks[t].reduce = reduce;                                                        \
+            tasks[t].partial = initial;                                                      \
+            tasks[t].begin = cmc_parallel_bound(slots, threads, t);                          \
+            tasks[t].end = cmc_parallel_bound(slots, threads, t + 1);                        \
+        }                                                                                    \
+                                                                                             \
+        cmc_parallel_run(tasks, sizeof(*tasks), threads, FNAME##_worker);                    \
+                                                                                             \
+        V result = tasks[0].partial;                                                         \
+                                                                                             \
+        for (size_t t = 1; t < threads; t++)                                                 \
+            result = combine(result, tasks[t].partial);                                      \
+                                                                                             \
+        if (tasks != &single)                                                                \
+            free(tasks);                                                                     \
+                                                                                             \
+        return result;                                                                       \
+    }
+
+#endif /* CMC_PARALLEL_H */
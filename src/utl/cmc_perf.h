@@ -0,0 +1,211 @@
+/**
+ * cmc_perf.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Hardware performance counters, to go with the timer of timer.h */
+
+/* A struct cmc_perf counts cycles, instructions, L1 data cache misses, */
+/* last level cache misses, branch misses and data TLB misses of the */
+/* calling thread between cmc_perf_start and cmc_perf_stop, only in user */
+/* space. The counters are opened with perf_event_open(2) as a single */
+/* group, so they are all counted over the same instructions, and a */
+/* counter that the processor or the kernel does not have is left out of */
+/* it. When the kernel had to share the hardware between more counters */
+/* than it has, the values are scaled by the time that they were counted. */
+
+/* Counters are only available on Linux, with syscall(2) declared by */
+/* _DEFAULT_SOURCE or _GNU_SOURCE, and cmc_perf_init returns false */
+/* when none of them could be opened, like in a virtual machine without a */
+/* PMU or with a perf_event_paranoid above 2. The start and stop macros */
+/* can still be used, and every value stays at 0. */
+
+#ifndef CMC_PERF_H
+#define CMC_PERF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__linux__) && (defined(_DEFAULT_SOURCE) || defined(_GNU_SOURCE))
+#define CMC_PERF_LINUX
+#endif
+
+#if defined(CMC_PERF_LINUX)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+enum cmc_perf_counter
+{
+    cmc_perf_cycles = 0,
+    cmc_perf_instructions,
+    cmc_perf_l1d_misses,
+    cmc_perf_llc_misses,
+    cmc_perf_branch_misses,
+    cmc_perf_dtlb_misses,
+    CMC_PERF_COUNTERS
+};
+
+static const char *cmc_perf_names[CMC_PERF_COUNTERS] = { "cycles",   "instructions",
+                                                         "l1d-miss", "llc-miss",
+                                                         "br-miss",  "dtlb-miss" };
+
+struct cmc_perf
+{
+    /* File descriptor of each counter or -1 if it could not be opened */
+    int fds[CMC_PERF_COUNTERS];
+    /* The first counter that was opened */
+    int leader;
+    /* Counted between the last start and stop */
+    uint64_t values[CMC_PERF_COUNTERS];
+};
+
+#if defined(CMC_PERF_LINUX)
+static inline int cmc_perf_open(uint32_t type, uint64_t config, int group)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(struct perf_event_attr));
+
+    attr.size = sizeof(struct perf_event_attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = group == -1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+/* Read misses of a cache */
+#define CMC_PERF_CACHE(CACHE)                                            \
+    (PERF_COUNT_HW_CACHE_##CACHE | (PERF_COUNT_HW_CACHE_OP_READ << 8) | \
+     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+#endif
+
+/* Opens the counters, returning false if none of them could be opened */
+static inline bool cmc_perf_init(struct cmc_perf *perf)
+{
+    memset(perf, 0, sizeof(struct cmc_perf));
+
+    perf->leader = -1;
+
+    for (int i = 0; i < CMC_PERF_COUNTERS; i++)
+        perf->fds[i] = -1;
+
+#if defined(CMC_PERF_LINUX)
+    const uint32_t types[CMC_PERF_COUNTERS] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                                                PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE,
+                                                PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE };
+    const uint64_t configs[CMC_PERF_COUNTERS] = { PERF_COUNT_HW_CPU_CYCLES,
+                                                  PERF_COUNT_HW_INSTRUCTIONS,
+                                                  CMC_PERF_CACHE(L1D),
+                                                  CMC_PERF_CACHE(LL),
+                                                  PERF_COUNT_HW_BRANCH_MISSES,
+                                                  CMC_PERF_CACHE(DTLB) };
+
+    for (int i = 0; i < CMC_PERF_COUNTERS; i++)
+    {
+        perf->fds[i] = cmc_perf_open(types[i], configs[i], perf->leader);
+
+        if (perf->fds[i] >= 0 && perf->leader < 0)
+            perf->leader = perf->fds[i];
+    }
+#endif
+
+    return perf->leader >= 0;
+}
+
+static inline void cmc_perf_release(struct cmc_perf *perf)
+{
+#if defined(CMC_PERF_LINUX)
+    for (int i = 0; i < CMC_PERF_COUNTERS; i++)
+    {
+        if (perf->fds[i] >= 0)
+            close(perf->fds[i]);
+    }
+#endif
+
+    perf->leader = -1;
+
+    for (int i = 0; i < CMC_PERF_COUNTERS; i++)
+        perf->fds[i] = -1;
+}
+
+/* If the counter was opened */
+static inline bool cmc_perf_available(struct cmc_perf *perf, enum cmc_perf_counter counter)
+{
+    return perf->fds[counter] >= 0;
+}
+
+static inline void cmc_perf_begin(struct cmc_perf *perf)
+{
+#if defined(CMC_PERF_LINUX)
+    if (perf->leader >= 0)
+    {
+        ioctl(perf->leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(perf->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#else
+    (void)perf;
+#endif
+}
+
+static inline void cmc_perf_end(struct cmc_perf *perf)
+{
+#if defined(CMC_PERF_LINUX)
+    if (perf->leader >= 0)
+        ioctl(perf->leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    for (int i = 0; i < CMC_PERF_COUNTERS; i++)
+    {
+        /* Value, time enabled and time running */
+        uint64_t data[3] = { 0, 0, 0 };
+
+        perf->values[i] = 0;
+
+        if (perf->fds[i] < 0 || read(perf->fds[i], data, sizeof(data)) != sizeof(data))
+            continue;
+
+        if (data[2] > 0 && data[2] < data[1])
+            perf->values[i] = (uint64_t)((double)data[0] * ((double)data[1] / (double)data[2]));
+        else
+            perf->values[i] = data[0];
+    }
+#else
+    (void)perf;
+#endif
+}
+
+/* Counts from 0 again */
+#define cmc_perf_start(perf) cmc_perf_begin(&(perf))
+
+/* Stops counting and reads the counters into values */
+#define cmc_perf_stop(perf) cmc_perf_end(&(perf))
+
+/* Writes the counters per operation, or n/a for the ones not available */
+static inline void cmc_perf_print(FILE *file, struct cmc_perf *perf, uint64_t operations)
+{
+    for (int i = 0; i < CMC_PERF_COUNTERS; i++)
+    {
+        if (!cmc_perf_available(perf, (enum cmc_perf_counter)i))
+            fprintf(file, " %s/op n/a", cmc_perf_names[i]);
+        else
+            fprintf(file, " %s/op %.2f", cmc_perf_names[i],
+                    operations ? (double)perf->values[i] / (double)operations : 0.0);
+    }
+
+    fprintf(file, "\n");
+}
+
+#endif /* CMC_PERF_H */
@@ -0,0 +1,263 @@
+/**
+ * cmc_scan.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Linear search for an element in an array by comparing its bytes, used by */
+/* the BITWISE generators of the array collections. Elements of 1, 2, 4, 8 */
+/* or 16 bytes are compared a vector at a time, with AVX2, SSE2 or NEON when */
+/* available, and any other size is compared with memcmp. */
+
+/* Two elements are only equal if all of their bytes are, so this is only */
+/* correct for types like integers and pointers. Floating point values 0.0 */
+/* and -0.0 are different and a NaN is equal to itself, and structs with */
+/* padding bytes can never be compared this way. */
+
+/* Define CMC_SCAN_NO_SIMD to always compare one element at a time. */
+
+#ifndef CMC_SCAN_H
+#define CMC_SCAN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "cmc_math.h"
+
+#if !defined(CMC_SCAN_NO_SIMD) && defined(__AVX2__)
+#define CMC_SCAN_AVX2
+#include <immintrin.h>
+#elif !defined(CMC_SCAN_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define CMC_SCAN_SSE2
+#include <emmintrin.h>
+#elif !defined(CMC_SCAN_NO_SIMD) && defined(__ARM_NEON) && defined(__aarch64__)
+#define CMC_SCAN_NEON
+#include <arm_neon.h>
+#endif
+
+/* Bytes compared at once and bits of the mask for each byte */
+#if defined(CMC_SCAN_AVX2)
+#define CMC_SCAN_VECTOR 32
+#define CMC_SCAN_BITS 1
+#elif defined(CMC_SCAN_SSE2)
+#define CMC_SCAN_VECTOR 16
+#define CMC_SCAN_BITS 1
+#elif defined(CMC_SCAN_NEON)
+#define CMC_SCAN_VECTOR 16
+#define CMC_SCAN_BITS 4
+#endif
+
+#ifdef CMC_SCAN_VECTOR
+
+/* Mask with CMC_SCAN_BITS bits set for every byte of the block at p that */
+/* belongs to an element equal to the element at the same position of */
+/* pattern. Elements of 16 bytes are compared as two halves of 8 */
+static inline uint64_t cmc_scan_bytes(const unsigned char *p, const unsigned char *pattern,
+                                      size_t size)
+{
+#if defined(CMC_SCAN_AVX2)
+    __m256i a = _mm256_loadu_si256((const __m256i *)p);
+    __m256i b = _mm256_loadu_si256((const __m256i *)pattern);
+    __m256i eq;
+
+    if (size == 1)
+        eq = _mm256_cmpeq_epi8(a, b);
+    else if (size == 2)
+        eq = _mm256_cmpeq_epi16(a, b);
+    else if (size == 4)
+        eq = _mm256_cmpeq_epi32(a, b);
+    else
+        eq = _mm256_cmpeq_epi64(a, b);
+
+    return (uint32_t)_mm256_movemask_epi8(eq);
+#elif defined(CMC_SCAN_SSE2)
+    __m128i a = _mm_loadu_si128((const __m128i *)p);
+    __m128i b = _mm_loadu_si128((const __m128i *)pattern);
+    __m128i eq;
+
+    if (size == 1)
+        eq = _mm_cmpeq_epi8(a, b);
+    else if (size == 2)
+        eq = _mm_cmpeq_epi16(a, b);
+    else if (size == 4)
+        eq = _mm_cmpeq_epi32(a, b);
+    else
+    {
+        /* SSE2 has no 64 bit comparison, both halves have to be equal */
+        eq = _mm_cmpeq_epi32(a, b);
+        eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+    }
+
+    return (uint32_t)_mm_movemask_epi8(eq);
+#else
+    uint8x16_t a = vld1q_u8(p);
+    uint8x16_t b = vld1q_u8(pattern);
+    uint8x16_t eq;
+
+    if (size == 1)
+        eq = vceqq_u8(a, b);
+    else if (size == 2)
+        eq = vreinterpretq_u8_u16(vceqq_u16(vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b)));
+    else if (size == 4)
+        eq = vreinterpretq_u8_u32(vceqq_u32(vreinterpretq_u32_u8(a), vreinterpretq_u32_u8(b)));
+    else
+        eq = vreinterpretq_u8_u64(vceqq_u64(vreinterpretq_u64_u8(a), vreinterpretq_u64_u8(b)));
+
+    /* Narrowing keeps four bits of each byte */
+    uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(eq), 4);
+
+    return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0);
+#endif
+}
+
+/* Keeps the bit of the first byte of every element that is equal to the */
+/* pattern */
+static inline uint64_t cmc_scan_lanes(uint64_t mask, size_t size)
+{
+    /* Elements of 16 bytes need both of their halves */
+    if (size == 16)
+        mask &= mask >> (8 * CMC_SCAN_BITS);
+
+    uint64_t first = 0;
+
+    for (size_t i = 0; i < CMC_SCAN_VECTOR; i += size)
+        first |= (uint64_t)1 << (i * CMC_SCAN_BITS);
+
+    return mask & first;
+}
+
+#endif /* CMC_SCAN_VECTOR */
+
+/* If elements of this size are compared a vector at a time */
+static inline bool cmc_scan_vectorized(size_t size)
+{
+#ifdef CMC_SCAN_VECTOR
+    return size <= 16 && (size & (size - 1)) == 0;
+#else
+    (void)size;
+    return false;
+#endif
+}
+
+/* Index of the first element of the array equal to element, or count if */
+/* there is none */
+static inline size_t cmc_scan_find(const void *array, size_t count, size_t size,
+                                   const void *element)
+{
+    const unsigned char *bytes = array;
+
+    size_t i = 0;
+
+#ifdef CMC_SCAN_VECTOR
+    if (cmc_scan_vectorized(size))
+    {
+        unsigned char pattern[CMC_SCAN_VECTOR];
+
+        for (size_t k = 0; k < CMC_SCAN_VECTOR; k += size)
+            memcpy(pattern + k, element, size);
+
+        size_t per_vector = CMC_SCAN_VECTOR / size;
+
+        /* Four vectors are compared before checking for a match */
+        for (; i + 4 * per_vector <= count; i += 4 * per_vector)
+        {
+            const unsigned char *p = bytes + i * size;
+
+            uint64_t m0 = cmc_scan_bytes(p, pattern, size);
+            uint64_t m1 = cmc_scan_bytes(p + CMC_SCAN_VECTOR, pattern, size);
+            uint64_t m2 = cmc_scan_bytes(p + 2 * CMC_SCAN_VECTOR, pattern, size);
+            uint64_t m3 = cmc_scan_bytes(p + 3 * CMC_SCAN_VECTOR, pattern, size);
+
+            if (cmc_scan_lanes(m0 | m1 | m2 | m3, size) != 0)
+                break;
+        }
+
+        for (; i + per_vector <= count; i += per_vector)
+        {
+            uint64_t mask = cmc_scan_bytes(bytes + i * size, pattern, size);
+            uint64_t lanes = cmc_scan_lanes(mask, size);
+
+            if (lanes != 0)
+                return i + cmc_math_ctz(lanes) / CMC_SCAN_BITS / size;
+        }
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        if (memcmp(bytes + i * size, element, size) == 0)
+            return i;
+    }
+
+    return count;
+}
+
+/* Index of the last element of the array equal to element, or count if */
+/* there is none */
+static inline size_t cmc_scan_find_last(const void *array, size_t count, size_t size,
+                                        const void *element)
+{
+    const unsigned char *bytes = array;
+
+    size_t i = count;
+
+#ifdef CMC_SCAN_VECTOR
+    if (cmc_scan_vectorized(size))
+    {
+        size_t per_vector = CMC_SCAN_VECTOR / size;
+
+        /* The elements past the last whole vector are compared first */
+        for (; i % per_vector != 0; i--)
+        {
+            if (memcmp(bytes + (i - 1) * size, element, size) == 0)
+                return i - 1;
+        }
+
+        unsigned char pattern[CMC_SCAN_VECTOR];
+
+        for (size_t k = 0; k < CMC_SCAN_VECTOR; k += size)
+            memcpy(pattern + k, element, size);
+
+        for (; i >= 4 * per_vector; i -= 4 * per_vector)
+        {
+            const unsigned char *p = bytes + (i - 4 * per_vector) * size;
+
+            uint64_t m0 = cmc_scan_bytes(p, pattern, size);
+            uint64_t m1 = cmc_scan_bytes(p + CMC_SCAN_VECTOR, pattern, size);
+            uint64_t m2 = cmc_scan_bytes(p + 2 * CMC_SCAN_VECTOR, pattern, size);
+            uint64_t m3 = cmc_scan_bytes(p + 3 * CMC_SCAN_VECTOR, pattern, size);
+
+            if (cmc_scan_lanes(m0 | m1 | m2 | m3, size) != 0)
+                break;
+        }
+
+        for (; i > 0; i -= per_vector)
+        {
+            const unsigned char *p = bytes + (i - per_vector) * size;
+
+            uint64_t mask = cmc_scan_bytes(p, pattern, size);
+            uint64_t lanes = cmc_scan_lanes(mask, size);
+
+            if (lanes != 0)
+                return i - per_vector + (63 - cmc_math_clz(lanes)) / CMC_SCAN_BITS / size;
+        }
+
+        return count;
+    }
+#endif
+
+    for (; i > 0; i--)
+    {
+        if (memcmp(bytes + (i - 1) * size, element, size) == 0)
+            return i - 1;
+    }
+
+    return count;
+}
+
+#endif /* CMC_SCAN_H */
@@ -0,0 +1,491 @@
+/**
+ * cmc_serial.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* The binary format written by the save and read by the restore method of */
+/* every collection. A file starts with a cmc_serial_header followed by the */
+/* elements the collection wrote. Keys and values are either written by a */
+/* function given by the user or, when none is given, with fwrite as they */
+/* are in memory. Numbers are in the byte order of the machine that wrote */
+/* them so files are not meant to be moved across architectures */
+
+/* The serialize and deserialize functions stream the same format in */
+/* pieces, for pipes and sockets, with a bounded amount of memory. The */
+/* header is followed by blocks, each a 32 bit length, that many bytes of */
+/* whole elements written as they are in memory and, when the header has */
+/* CMC_SERIAL_CHECKSUM, the Adler-32 of those bytes. A block of length 0 */
+/* ends the stream. A cmc_serial_writer hands out as many bytes as fit in */
+/* the buffer it is given and carries on from there on the next call, and */
+/* a cmc_serial_reader takes any amount of bytes, keeping the ones of a */
+/* block that is not complete yet */
+
+/* The save_flat method of sorted collections writes a file meant to be */
+/* mapped to memory and searched where it is, by a MappedSortedMap or a */
+/* MappedSortedSet. The header has CMC_SERIAL_FLAT and its extra is the */
+/* step of the sparse index. It is followed by the sorted keys, then the */
+/* values, if there are any, and last every step-th key, starting at the */
+/* first one, when step is not 0. Each of them starts at a multiple of */
+/* CMC_SERIAL_FLAT_ALIGN bytes from the start of the file */
+
+#ifndef CMC_SERIAL_H
+#define CMC_SERIAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Version of the format, restore rejects files of any other version */
+#define CMC_SERIAL_VERSION 1
+
+/* Flags of a header. Keys or values written with fwrite are RAW. When */
+/* everything is RAW, hashtables write their buffer as it is in memory */
+/* and load it back without hashing (LAYOUT), so the same hash function */
+/* must be given to restore */
+#define CMC_SERIAL_RAW_KEYS 0x1
+#define CMC_SERIAL_RAW_VALUES 0x2
+#define CMC_SERIAL_LAYOUT 0x4
+
+/* Flags of a header written by serialize. Every block is followed by a */
+/* checksum when CHECKSUM is set */
+#define CMC_SERIAL_STREAM 0x8
+#define CMC_SERIAL_CHECKSUM 0x10
+
+/* Flag of a header written by save_flat */
+#define CMC_SERIAL_FLAT 0x20
+
+/* Flag of a header written by save_delta, of cmc_delta.h */
+#define CMC_SERIAL_DELTA 0x40
+
+/* Alignment of the sections of a file written by save_flat */
+#define CMC_SERIAL_FLAT_ALIGN 64
+
+/* Size of the elements of a block when serialize is given 0 */
+#ifndef CMC_SERIAL_BLOCK_SIZE
+#define CMC_SERIAL_BLOCK_SIZE 65536
+#endif
+
+struct cmc_serial_header
+{
+    /* Always "CMC" */
+    char magic[4];
+
+    /* CMC_SERIAL_VERSION when the file was written */
+    uint32_t version;
+
+    /* Name of the collection, the same as the name of its header */
+    char collection[16];
+
+    /* CMC_SERIAL_ flags */
+    uint32_t flags;
+
+    /* Sizes of K and V, checked when they were written RAW */
+    uint32_t key_size;
+    uint32_t value_size;
+
+    /* State specific to a collection, like the order of a Heap */
+    uint32_t extra;
+
+    /* Amount of elements */
+    uint64_t count;
+
+    /* Capacity of the collection when it was saved */
+    uint64_t capacity;
+
+    /* Load factor of hashtables, 0 for other collections */
+    double load;
+};
+
+/* Writes one key or value with writer, or with fwrite when it is NULL */
+#define CMC_SERIAL_WRITE(writer, value, file) \
+    ((writer) ? (writer)((value), (file)) : fwrite(&(value), sizeof(value), 1, (file)) == 1)
+
+/* Reads one key or value to target. It was written with fwrite if raw is */
+/* true, otherwise the reader is needed */
+#define CMC_SERIAL_READ(raw, reader, target, file)                   \
+    ((raw) ? fread((target), sizeof(*(target)), 1, (file)) == 1 \
+           : (reader) != NULL && (reader)((target), (file)))
+
+static inline bool cmc_serial_write_header(FILE *file, const char *collection, uint32_t flags,
+                                           size_t key_size, size_t value_size, uint32_t extra,
+                                           size_t count, size_t capacity, double load)
+{
+    struct cmc_serial_header header;
+
+    /* Padding bytes are written too */
+    memset(&header, 0, sizeof(header));
+
+    memcpy(header.magic, "CMC", 4);
+    strncpy(header.collection, collection, sizeof(header.collection) - 1);
+
+    header.version = CMC_SERIAL_VERSION;
+    header.flags = flags;
+    header.key_size = (uint32_t)key_size;
+    header.value_size = (uint32_t)value_size;
+    header.extra = extra;
+    header.count = count;
+    header.capacity = capacity;
+    header.load = load;
+
+    return fwrite(&header, sizeof(header), 1, file) == 1;
+}
+
+/* Checks that a header was written by the same collection and with the */
+/* same sizes for what was written RAW */
+static inline bool cmc_serial_check_header(const char *collection, size_t key_size,
+                                           size_t value_size, struct cmc_serial_header *header)
+{
+    if (memcmp(header->magic, "CMC", 4) != 0 || header->version != CMC_SERIAL_VERSION)
+        return false;
+
+    if (strncmp(header->collection, collection, sizeof(header->collection)) != 0)
+        return false;
+
+    if ((header->flags & CMC_SERIAL_RAW_KEYS) && header->key_size != key_size)
+        return false;
+
+    if ((header->flags & CMC_SERIAL_RAW_VALUES) && header->value_size != value_size)
+        return false;
+
+    return header->count <= SIZE_MAX && header->capacity <= SIZE_MAX;
+}
+
+/* Reads a header and checks it with cmc_serial_check_header */
+static inline bool cmc_serial_read_header(FILE *file, const char *collection, size_t key_size,
+                                          size_t value_size, struct cmc_serial_header *header)
+{
+    if (fread(header, sizeof(*header), 1, file) != 1)
+        return false;
+
+    return cmc_serial_check_header(collection, key_size, value_size, header);
+}
+
+/* Amount of keys in the sparse index of a flat file */
+static inline size_t cmc_serial_flat_indexed(size_t count, size_t step)
+{
+    return step == 0 ? 0 : (count + step - 1) / step;
+}
+
+/* Size of a section of a flat file with its padding */
+static inline size_t cmc_serial_flat_section(size_t size)
+{
+    return (size + CMC_SERIAL_FLAT_ALIGN - 1) / CMC_SERIAL_FLAT_ALIGN * CMC_SERIAL_FLAT_ALIGN;
+}
+
+/* Writes the zeros that pad a section of size bytes */
+static inline bool cmc_serial_flat_pad(FILE *file, size_t size)
+{
+    static const unsigned char zeros[CMC_SERIAL_FLAT_ALIGN] = { 0 };
+    size_t padding = cmc_serial_flat_section(size) - size;
+
+    return padding == 0 || fwrite(zeros, 1, padding, file) == padding;
+}
+
+static inline uint32_t cmc_serial_adler32(const unsigned char *data, size_t size)
+{
+    uint32_t a = 1, b = 0;
+
+    while (size > 0)
+    {
+        /* The sums can go this long without overflowing */
+        size_t n = size < 5552 ? size : 5552;
+
+        size -= n;
+
+        while (n-- > 0)
+        {
+            a += *data++;
+            b += a;
+        }
+
+        a %= 65521;
+        b %= 65521;
+    }
+
+    return (b << 16) | a;
+}
+
+struct cmc_serial_writer
+{
+    /* A 32 bit length, the elements and room for the checksum */
+    unsigned char *block;
+
+    /* Most bytes of elements that a block holds */
+    size_t block_size;
+
+    /* Bytes of block that are ready to be handed out */
+    size_t pending;
+
+    /* Bytes of block that were already handed out */
+    size_t sent;
+
+    /* If every block is followed by its checksum */
+    bool checksum;
+
+    /* If the last block, of length 0, is in block */
+    bool finished;
+};
+
+/* Allocates the block and puts the header in it, so it is the first thing */
+/* handed out. The block always fits the header and at least one element */
+static inline bool cmc_serial_writer_begin(struct cmc_serial_writer *writer,
+                                           const char *collection, size_t key_size,
+                                           size_t value_size, uint32_t extra, size_t count,
+                                           size_t capacity, double load, size_t block_size,
+                                           bool checksum)
+{
+    struct cmc_serial_header header;
+
+    memset(writer, 0, sizeof(*writer));
+
+    if (block_size == 0)
+        block_size = CMC_SERIAL_BLOCK_SIZE;
+    if (block_size < key_size + value_size)
+        block_size = key_size + value_size;
+    if (block_size < sizeof(header))
+        block_size = sizeof(header);
+
+    writer->block = malloc(block_size + 8);
+
+    if (!writer->block)
+        return false;
+
+    memset(&header, 0, sizeof(header));
+
+    memcpy(header.magic, "CMC", 4);
+    strncpy(header.collection, collection, sizeof(header.collection) - 1);
+
+    header.version = CMC_SERIAL_VERSION;
+    header.flags = CMC_SERIAL_STREAM | (checksum ? CMC_SERIAL_CHECKSUM : 0);
+    header.flags |= (key_size ? CMC_SERIAL_RAW_KEYS : 0) | CMC_SERIAL_RAW_VALUES;
+    header.key_size = (uint32_t)key_size;
+    header.value_size = (uint32_t)value_size;
+    header.extra = extra;
+    header.count = count;
+    header.capacity = capacity;
+    header.load = load;
+
+    memcpy(writer->block, &header, sizeof(header));
+
+    writer->block_size = block_size;
+    writer->pending = sizeof(header);
+    writer->checksum = checksum;
+
+    return true;
+}
+
+/* Copies up to size bytes of the stream to buffer and returns how many */
+/* were copied, 0 once everything was handed out. fill(source, out, room) */
+/* writes the next elements of the collection to out, as many whole ones */
+/* as fit in room bytes, and returns how many bytes it wrote */
+static inline size_t cmc_serial_writer_next(struct cmc_serial_writer *writer, void *buffer,
+                                            size_t size,
+                                            size_t (*fill)(void *, unsigned char *, size_t),
+                                            void *source)
+{
+    unsigned char *out = buffer;
+    size_t written = 0;
+
+    while (written < size)
+    {
+        if (writer->sent == writer->pending)
+        {
+            if (writer->finished || !writer->block)
+                break;
+
+            uint32_t length = (uint32_t)fill(source, writer->block + 4, writer->block_size);
+
+            memcpy(writer->block, &length, 4);
+
+            writer->pending = 4 + length;
+            writer->sent = 0;
+            writer->finished = length == 0;
+
+            if (writer->checksum && length > 0)
+            {
+                uint32_t checksum = cmc_serial_adler32(writer->block + 4, length);
+
+                memcpy(writer->block + writer->pending, &checksum, 4);
+
+                writer->pending += 4;
+            }
+        }
+
+        size_t n = writer->pending - writer->sent;
+
+        if (n > size - written)
+            n = size - written;
+
+        memcpy(out + written, writer->block + writer->sent, n);
+
+        writer->sent += n;
+        written += n;
+    }
+
+    return written;
+}
+
+static inline void cmc_serial_writer_end(struct cmc_serial_writer *writer)
+{
+    free(writer->block);
+
+    writer->block = NULL;
+}
+
+enum cmc_serial_stage
+{
+    CMC_SERIAL_HEADER = 0,
+    CMC_SERIAL_LENGTH,
+    CMC_SERIAL_BLOCK,
+    CMC_SERIAL_DONE,
+    CMC_SERIAL_ERROR
+};
+
+struct cmc_serial_reader
+{
+    /* Bytes of the header or the current block */
+    unsigned char *block;
+
+    /* Most bytes of elements that a block may have */
+    size_t block_size;
+
+    /* Bytes of block that were received and that are needed */
+    size_t have;
+    size_t needed;
+
+    /* What is being received */
+    enum cmc_serial_stage stage;
+
+    /* Length of the current block */
+    uint32_t length;
+
+    /* The header, once it was received */
+    struct cmc_serial_header header;
+};
+
+/* Blocks longer than block_size, or CMC_SERIAL_BLOCK_SIZE if it is 0, are */
+/* rejected */
+static inline bool cmc_serial_reader_begin(struct cmc_serial_reader *reader, size_t block_size)
+{
+    memset(reader, 0, sizeof(*reader));
+
+    if (block_size == 0)
+        block_size = CMC_SERIAL_BLOCK_SIZE;
+
+    /* The header goes through the block too */
+    if (block_size + 4 > sizeof(reader->header))
+        reader->block = malloc(block_size + 4);
+    else
+        reader->block = malloc(sizeof(reader->header));
+
+    if (!reader->block)
+        return false;
+
+    reader->block_size = block_size;
+    reader->needed = sizeof(reader->header);
+    reader->stage = CMC_SERIAL_HEADER;
+
+    return true;
+}
+
+/* Takes the next size bytes of the stream. header(target, header) is */
+/* called once the header arrived and consume(target, elements, size) with */
+/* the elements of every block, and both return false to stop the stream. */
+/* Returns false if the stream was stopped, is not valid or has bytes after */
+/* its end, and every call after that does too */
+static inline bool cmc_serial_reader_next(struct cmc_serial_reader *reader, const void *buffer,
+                                          size_t size,
+                                          bool (*header)(void *, struct cmc_serial_header *),
+                                          bool (*consume)(void *, const unsigned char *, size_t),
+                                          void *target)
+{
+    const unsigned char *in = buffer;
+
+    while (size > 0 && reader->stage < CMC_SERIAL_DONE)
+    {
+        size_t n = reader->needed - reader->have;
+
+        if (n > size)
+            n = size;
+
+        memcpy(reader->block + reader->have, in, n);
+
+        reader->have += n;
+        in += n;
+        size -= n;
+
+        if (reader->have < reader->needed)
+            break;
+
+        bool checksum = reader->header.flags & CMC_SERIAL_CHECKSUM;
+
+        reader->have = 0;
+
+        if (reader->stage == CMC_SERIAL_HEADER)
+        {
+            memcpy(&reader->header, reader->block, sizeof(reader->header));
+
+            reader->stage = (reader->header.flags & CMC_SERIAL_STREAM) &&
+                                    header(target, &reader->header)
+                                ? CMC_SERIAL_LENGTH
+                                : CMC_SERIAL_ERROR;
+            reader->needed = 4;
+        }
+        else if (reader->stage == CMC_SERIAL_LENGTH)
+        {
+            memcpy(&reader->length, reader->block, 4);
+
+            if (reader->length > reader->block_size)
+                reader->stage = CMC_SERIAL_ERROR;
+            else if (reader->length == 0)
+                reader->stage = CMC_SERIAL_DONE;
+            else
+            {
+                reader->stage = CMC_SERIAL_BLOCK;
+                reader->needed = reader->length + (checksum ? 4 : 0);
+            }
+        }
+        else
+        {
+            uint32_t expected = 0;
+
+            if (checksum)
+                memcpy(&expected, reader->block + reader->length, 4);
+
+            if (checksum && expected != cmc_serial_adler32(reader->block, reader->length))
+                reader->stage = CMC_SERIAL_ERROR;
+            else if (!consume(target, reader->block, reader->length))
+                reader->stage = CMC_SERIAL_ERROR;
+            else
+            {
+                reader->stage = CMC_SERIAL_LENGTH;
+                reader->needed = 4;
+            }
+        }
+    }
+
+    if (size > 0 && reader->stage == CMC_SERIAL_DONE)
+        reader->stage = CMC_SERIAL_ERROR;
+
+    return reader->stage != CMC_SERIAL_ERROR;
+}
+
+/* If the stream reached its end with no error */
+static inline bool cmc_serial_reader_end(struct cmc_serial_reader *reader)
+{
+    free(reader->block);
+
+    reader->block = NULL;
+
+    return reader->stage == CMC_SERIAL_DONE;
+}
+
+#endif /* CMC_SERIAL_H */
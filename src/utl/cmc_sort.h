@@ -0,0 +1,786 @@
+/**
+ * cmc_sort.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Sorting engine shared by the collections backed by arrays. It is a pattern */
+/* defeating quicksort: a quicksort with a median of three, or of nine for */
+/* larger partitions, that switches to heapsort once too many partitions */
+/* come out unbalanced, so it always takes O(n log n). Runs of elements that */
+/* are already in order are finished by a short insertion sort and elements */
+/* equal to the pivot of the partition before are put aside at once, so */
+/* sorted, reversed and repetitive arrays take close to linear time. */
+
+/* CMC_GENERATE_SORT(FNAME, V, CTX_DECL, CTX, CMP) generates */
+/* static void FNAME(CTX_DECL, V *array, size_t count) and its helpers, named */
+/* FNAME_*. CTX_DECL is a parameter passed through every call, like the */
+/* collection or a comparator, CTX is its name and CMP is called as */
+/* CMP(a, b), so it can use CTX. */
+
+/* CMC_GENERATE_RADIX_SORT(FNAME, V, KEY) generates */
+/* static bool FNAME(V *array, size_t count), a least significant digit */
+/* radix sort for elements that map to an unsigned 64 bit integer, with */
+/* uint64_t KEY(V) keeping the order of the elements. It returns false, */
+/* leaving the array untouched, when the array is too small for it to pay */
+/* off or the scratch buffer could not be allocated. cmc_radix_key_int64 */
+/* and cmc_radix_key_double map signed integers and floating point numbers. */
+
+/* CMC_GENERATE_PARALLEL_SORT(FNAME, SORT, V, CTX_DECL, CTX, CMP) generates */
+/* static void FNAME(CTX_DECL, V *array, size_t count, size_t threads), a */
+/* merge sort that sorts one part of the array on each thread with */
+/* SORT(CTX, array, count) and then merges them in rounds. Every merge is */
+/* split among the threads too, so the last ones still use all of them. */
+
+/* CMC_GENERATE_SELECT(FNAME, V, CTX_DECL, CTX, CMP) generates */
+/* static void FNAME(CTX_DECL, V *array, size_t count, size_t nth), an */
+/* introselect that moves to nth the element that would be there if the */
+/* array was sorted, with no greater elements before it and no lesser ones */
+/* after it. It is a quickselect that only follows the side of nth and */
+/* switches to a heap based selection once too many partitions come out */
+/* unbalanced, so it takes O(n) on average and O(n log n) at most. */
+
+#ifndef CMC_SORT_H
+#define CMC_SORT_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Partitions smaller than this are sorted by insertion sort */
+#define CMC_SORT_INSERTION_SIZE 24
+
+/* Partitions larger than this take the median of nine as the pivot */
+#define CMC_SORT_NINTHER_SIZE 128
+
+/* Moves that an insertion sort over a partition that came out sorted can */
+/* make before it gives up */
+#define CMC_SORT_PARTIAL_LIMIT 8
+
+/* Arrays smaller than this are not radix sorted */
+#define CMC_SORT_RADIX_SIZE 512
+
+/* Least amount of elements that a parallel sort gives to each thread */
+#define CMC_SORT_PARALLEL_SIZE 16384
+
+/* Flips the sign bit so negative numbers come first */
+static inline uint64_t cmc_radix_key_int64(int64_t value)
+{
+    return (uint64_t)value ^ ((uint64_t)1 << 63);
+}
+
+/* Negative numbers have every bit flipped, since a larger magnitude makes */
+/* them smaller, and positive numbers only have their sign bit flipped */
+static inline uint64_t cmc_radix_key_double(double value)
+{
+    uint64_t bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+
+    return bits >> 63 ? ~bits : bits | ((uint64_t)1 << 63);
+}
+
+#define CMC_GENERATE_SORT(FNAME, V, CTX_DECL, CTX, CMP)                                        \
+                                                                                               \
+    static void FNAME##_loop(CTX_DECL, V *array, size_t begin, size_t end, size_t bad_allowed, \
+                             bool leftmost);                                                   \
+                                                                                               \
+    static void FNAME(CTX_DECL, V *array, size_t count)                                        \
+    {                                                                                          \
+        if (count < 2)                                                                         \
+            return;                                                                            \
+                                                                                               \
+        /* Amount of unbalanced partitions tolerated before heapsort is used */                \
+        size_t bad_allowed = 0;                                                                \
+                                                                                               \
+        for (size_t n = count; n > 1; n >>= 1)                                                 \
+            bad_allowed++;                                                                     \
+                                                                                               \
+        FNAME##_loop(CTX, array, 0, count, bad_allowed, true);                                 \
+    }                                                                                          \
+                                                                                               \
+    static inline void FNAME##_swap(V *array, size_t a, size_t b)                              \
+    {                                                                                          \
+        V tmp = array[a];                                                                      \
+        array[a] = array[b];                                                                   \
+        array[b] = tmp;                                                                        \
+    }                                                                                          \
+                                                                                               \
+    static inline void FNAME##_sort2(CTX_DECL, V *array, size_t a, size_t b)                   \
+    {                                                                                          \
+        (void)CTX;                                                                             \
+                                                                                               \
+        if (CMP(array[b], array[a]) < 0)                                                       \
+            FNAME##_swap(array, a, b);                                                         \
+    }                                                                                          \
+                                                                                               \
+    static inline void FNAME##_sort3(CTX_DECL, V *array, size_t a, size_t b, size_t c)         \
+    {                                                                                          \
+        FNAME##_sort2(CTX, array, a, b);                                                       \
+        FNAME##_sort2(CTX, array, b, c);                                                       \
+        FNAME##_sort2(CTX, array, a, b);                                                       \
+    }                                                                                          \
+                                                                                               \
+    static void FNAME##_insertion(CTX_DECL, V *array, size_t begin, size_t end)                \
+    {                                                                                          \
+        (void)CTX;                                                                             \
+                                                                                               \
+        for (size_t i = begin + 1; i < end; i++)                                               \
+        {                                                                                      \
+            V tmp = array[i];                                                                  \
+            size_t j = i;                                                                      \
+                                                                                               \
+            while (j > begin && CMP(tmp, array[j - 1]) < 0)                                    \
+            {                                                                                  \
+                array[j] = array[j - 1];                                                       \
+                j--;                                                                           \
+            }                                                                                  \
+                                                                                               \
+            array[j] = tmp;                                                                    \
+        }                                                                                      \
+    }                                                                                          \
+                                                                                               \
+    /* Insertion sort that gives up after a few moves. Returns true if the */                  \
+    /* partition got sorted */                                                                 \
+    static bool FNAME##_partial_insertion(CTX_DECL, V *array, size_t begin, size_t end)        \
+    {                                                                                          \
+        (void)CTX;                                                                             \
+                                                                                               \
+        size_t moves = 0;                                                                      \
+                                                                                               \
+        for (size_t i = begin + 1; i < end; i++)                                               \
+        {                                                                                      \
+            if (CMP(array[i], array[i - 1]) < 0)                                               \
+            {                                                                                  \
+                V tmp = array[i];                                                              \
+                size_t j = i;                                                                  \
+                                                                                               \
+                do                                                                             \
+                {                                                                              \
+                    array[j] = array[j - 1];                                                   \
+                    j--;                                                                       \
+                } while (j > begin && CMP(tmp, array[j - 1]) < 0);                             \
+                                                                                               \
+                array[j] = tmp;                                                                \
+                moves += i - j;                                                                \
+            }                                                                                  \
+                                                                                               \
+            if (moves > CMC_SORT_PARTIAL_LIMIT)                                                \
+                return false;                                                                  \
+        }                                                                                      \
+                                                                                               \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    static void FNAME##_sift_down(CTX_DECL, V *array, size_t begin, size_t root, size_t size)  \
+    {                                                                                          \
+        (void)CTX;                                                                             \
+                                                                                               \
+        while (true)                                                                           \
+        {                                                                                      \
+            size_t child = 2 * root + 1;                                                       \
+                                                                                               \
+            if (child >= size)                                                                 \
+                return;                                                                        \
+                                                                                               \
+            if (child + 1 < size &&                                                            \
+                CMP(array[begin + child], array[begin + child + 1]) < 0)                       \
+                child++;                                                                       \
+                                                                                               \
+            if (!(CMP(array[begin + root], array[begin + child]) < 0))                         \
+                return;                                                                        \
+                                                                                               \
+            FNAME##_swap(array, begin + root, begin + child);                                  \
+            root = child;                                                                      \
+        }                                                                                      \
+    }                                                                                          \
+                                                                                               \
+    static void FNAME##_heapsort(CTX_DECL, V *array, size_t begin, size_t end)                 \
+    {                                                                                          \
+        size_t size = end - begin;                                                             \
+                                                                                               \
+        for (size_t i = size / 2; i > 0; i--)                                                  \
+            FNAME##_sift_down(CTX, array, begin, i - 1, size);                                 \
+                                                                                               \
+        for (size_t i = size - 1; i > 0; i--)                                                  \
+        {                                                                                      \
+            FNAME##_swap(array, begin, begin + i);                                             \
+            FNAME##_sift_down(CTX, array, begin, 0, i);                                        \
+        }                                                                                      \
+    }                                                                                          \
+                                                                                               \
+    /* Partitions around the pivot at begin, with the elements equal to it */                  \
+    /* going to the right. The pivot is moved between both sides and its */                    \
+    /* position is returned. The median selection guarantees that an element */                \
+    /* that is not less than the pivot is at end - 1 */                                        \
+    static size_t FNAME##_partition_right(CTX_DECL, V *array, size_t begin, size_t end,        \
+                                          bool *already_partitioned)                           \
+    {                                                                                          \
+        (void)CTX;                                                                             \
+                                                                                               \
+        V pivot = array[begin];                                                                \
+                                                                                               \
+        size_t first = begin;                                                                  \
+        size_t last = end;                                                                     \
+                                                                                               \
+        while (CMP(array[++first], pivot) < 0)                                                 \
+            ;                                                                                  \
+                                                                                               \
+        if (first - 1 == begin)                                                                \
+        {                                                                                      \
+            while (first < last && !(CMP(array[--last], pivot) < 0))                           \
+                ;                                                                              \
+        }                                                                                      \
+        else                                                                                   \
+        {                                                                                      \
+            while (!(CMP(array[--last], pivot) < 0))                                           \
+                ;                                                                              \
+        }                                                                                      \
+                                                                                               \
+        *already_partitioned = first >= last;                                                  \
+                                                                                               \
+        while (first < last)                                                                   \
+        {                                                                                      \
+            FNAME##_swap(array, first, last);                                                  \
+                                                                                               \
+            while (CMP(array[++first], pivot) < 0)                                             \
+                ;                                                                              \
+            while (!(CMP(array[--last], pivot) < 0))                                           \
+                ;                                                                              \
+        }                                                                                      \
+                                                                                               \
+        size_t pivot_pos = first - 1;                                                          \
+                                                                                               \
+        array[begin] = array[pivot_pos];                                                       \
+        array[pivot_pos] = pivot;                                                              \
+                                                                                               \
+        return pivot_pos;                                                                      \
+    }                                                                                          \
+                                                                                               \
+    /* Partitions around the pivot at begin, with the elements equal to it */                  \
+    /* going to the left. Used when the pivot is equal to the element before */                \
+    /* begin, so every element on the left is equal and already in place */                    \
+    static size_t FNAME##_partition_left(CTX_DECL, V *array, size_t begin, size_t end)         \
+    {                                                                                          \
+        (void)CTX;                                                                             \
+                                                                                               \
+        V pivot = array[begin];                                                                \
+                                                                                               \
+        size_t first = begin;                                                                  \
+        size_t last = end;                                                                     \
+                                                                                               \
+        while (CMP(pivot, array[--last]) < 0)                                                  \
+            ;                                                                                  \
+                                                                                               \
+        if (last + 1 == end)                                                                   \
+        {                                                                                      \
+            while (first < last && !(CMP(pivot, array[++first]) < 0))                          \
+                ;                                                                              \
+        }                                                                                      \
+        else                                                                                   \
+        {                                                                                      \
+            while (!(CMP(pivot, array[++first]) < 0))                                          \
+                ;                                                                              \
+        }                                                                                      \
+                                                                                               \
+        while (first < last)                                                                   \
+        {                                                                                      \
+            FNAME##_swap(array, first, last);                                                  \
+                                                                                               \
+            while (CMP(pivot, array[--last]) < 0)                                              \
+                ;                                                                              \
+            while (!(CMP(pivot, array[++first]) < 0))                                          \
+                ;                                                                              \
+        }                                                                                      \
+                                                                                               \
+        array[begin] = array[last];                                                            \
+        array[last] = pivot;                                                                   \
+                                                                                               \
+        return last;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    /* Sorts from begin to end, exclusive. If it is not leftmost there is an */                \
+    /* element before begin not greater than any element of the partition */                   \
+    static void FNAME##_loop(CTX_DECL, V *array, size_t begin, size_t end, size_t bad_allowed, \
+                             bool leftmost)                                                    \
+    {                                                                                          \
+        (void)CTX;                                                                             \
+                                                                                               \
+        while (true)                                                                           \
+        {                                                                                      \
+            size_t size = end - begin;                                                         \
+                                                                                               \
+            if (size < CMC_SORT_INSERTION_SIZE)                                                \
+            {                                                                                  \
+                FNAME##_insertion(CTX, array, begin, end);                                     \
+                return;                                                                        \
+            }                                                                                  \
+                                                                                               \
+            /* The pivot ends up at begin */                                                   \
+            size_t half = size / 2;                                                            \
+                                                                                               \
+            if (size > CMC_SORT_NINTHER_SIZE)                                                  \
+            {                                                                                  \
+                FNAME##_sort3(CTX, array, begin, begin + half, end - 1);                       \
+                FNAME##_sort3(CTX, array, begin + 1, begin + half - 1, end - 2);               \
+                FNAME##_sort3(CTX, array, begin + 2, begin + half + 1, end - 3);               \
+                FNAME##_sort3(CTX, array, begin + half - 1, begin + half, begin + half + 1);   \
+                FNAME##_swap(array, begin, begin + half);                                      \
+            }                                                                                  \
+            else                                                                               \
+                FNAME##_sort3(CTX, array, begin + half, begin, end - 1);                       \
+                                                                                               \
+            /* Many elements equal to the pivot before are skipped at once */                  \
+            if (!leftmost && !(CMP(array[begin - 1], array[begin]) < 0))                       \
+            {                                                                                  \
+                begin = FNAME##_partition_left(CTX, array, begin, end) + 1;                    \
+                continue;                                                                      \
+            }                                                                                  \
+                                                                                               \
+            bool already_partitioned = false;                                                  \
+                                                                                               \
+            size_t pivot_pos =                                                                 \
+                FNAME##_partition_right(CTX, array, begin, end, &already_partitioned);         \
+                                                                                               \
+            size_t l_size = pivot_pos - begin;                                                 \
+            size_t r_size = end - (pivot_pos + 1);                                             \
+                                                                                               \
+            if (l_size < size / 8 || r_size < size / 8)                                        \
+            {                                                                                  \
+                if (--bad_allowed == 0)                                                        \
+                {                                                                              \
+                    FNAME##_heapsort(CTX, array, begin, end);                                  \
+                    return;                                                                    \
+                }                                                                              \
+                                                                                               \
+                /* Shuffles a few elements to break patterns */                                \
+                if (l_size >= CMC_SORT_INSERTION_SIZE)                                         \
+                {                                                                              \
+                    FNAME##_swap(array, begin, begin + l_size / 4);                            \
+                    FNAME##_swap(array, pivot_pos - 1, pivot_pos - l_size / 4);                \
+                }                                                                              \
+                                                                                               \
+                if (r_size >= CMC_SORT_INSERTION_SIZE)                                         \
+                {                                                                              \
+                    FNAME##_swap(array, pivot_pos + 1, pivot_pos + 1 + r_size / 4);            \
+                    FNAME##_swap(array, end - 1, end - r_size / 4);                            \
+                }                                                                              \
+            }                                                                                  \
+            else if (already_partitioned &&                                                    \
+                     FNAME##_partial_insertion(CTX, array, begin, pivot_pos) &&                \
+                     FNAME##_partial_insertion(CTX, array, pivot_pos + 1, end))                \
+                return;                                                                        \
+                                                                                               \
+            /* The smaller side is sorted first so the recursion stays shallow */              \
+            if (l_size < r_size)                                                               \
+            {                                                                                  \
+                FNAME##_loop(CTX, array, begin, pivot_pos, bad_allowed, leftmost);             \
+                                                                                               \
+                begin = pivot_pos + 1;                                                         \
+                leftmost = false;                                                              \
+            }                                                                                  \
+            else                                                                               \
+            {                                                                                  \
+                FNAME##_loop(CTX, array, pivot_pos + 1, end, bad_allowed, false);              \
+                                                                                               \
+                end = pivot_pos;                                                               \
+            }                                                                                  \
+        }                                                                                      \
+    }
+
+#define CMC_GENERATE_RADIX_SORT(FNAME, V, KEY)                                     \
+                                                                                   \
+    static bool FNAME(V *array, size_t count)                                      \
+    {                                                                              \
+        if (count < CMC_SORT_RADIX_SIZE)                                           \
+            return false;                                                          \
+                                                                                   \
+        V *scratch = malloc(sizeof(V) * count);                                    \
+                                                                                   \
+        if (!scratch)                                                              \
+            return false;                                                          \
+                                                                                   \
+        /* The histograms of every byte of the keys are taken in one pass */       \
+        size_t histogram[8][256];                                                  \
+                                                                                   \
+        memset(histogram, 0, sizeof(histogram));                                   \
+                                                                                   \
+        for (size_t i = 0; i < count; i++)                                         \
+        {                                                                          \
+            uint64_t key = KEY(array[i]);                                          \
+                                                                                   \
+            for (size_t b = 0; b < 8; b++)                                         \
+                histogram[b][(key >> (b * 8)) & 0xFF]++;                           \
+        }                                                                          \
+                                                                                   \
+        V *source = array;                                                         \
+        V *target = scratch;                                                       \
+                                                                                   \
+        for (size_t b = 0; b < 8; b++)                                             \
+        {                                                                          \
+            size_t *offsets = histogram[b];                                        \
+            size_t shift = b * 8;                                                  \
+                                                                                   \
+            /* Every key has the same byte so this pass would not move anything */ \
+            if (offsets[(KEY(source[0]) >> shift) & 0xFF] == count)                \
+                continue;                                                          \
+                                                                                   \
+            size_t total = 0;                                                      \
+                                                                                   \
+            for (size_t d = 0; d < 256; d++)                                       \
+            {                                                                      \
+                size_t digits = offsets[d];                                        \
+                offsets[d] = total;                                                \
+                total += digits;                                                   \
+            }                                                                      \
+                                                                                   \
+            for (size_t i = 0; i < count; i++)                                     \
+                target[offsets[(KEY(source[i]) >> shift) & 0xFF]++] = source[i];   \
+                                                                                   \
+            V *tmp = source;                                                       \
+            source = target;                                                       \
+            target = tmp;                                                          \
+        }                                                                          \
+                                                                                   \
+        if (source != array)                                                       \
+            memcpy(array, source, sizeof(V) * count);                              \
+                                                                                   \
+        free(scratch);                                                             \
+                                                                                   \
+        return true;                                                               \
+    }
+
+#define CMC_GENERATE_PARALLEL_SORT(FNAME, SORT, V, CTX_DECL, CTX, CMP)                           \
+                                                                                                 \
+    /* Sorts a, or merges a and b into the elements of out from begin to */                      \
+    /* end, exclusive */                                                                         \
+    struct FNAME##_task                                                                          \
+    {                                                                                            \
+        CTX_DECL;                                                                                \
+        V *a;                                                                                    \
+        size_t a_count;                                                                          \
+        V *b;                                                                                    \
+        size_t b_count;                                                                          \
+        V *out;                                                                                  \
+        size_t begin;                                                                            \
+        size_t end;                                                                              \
+        bool started;                                                                            \
+    };                                                                                           \
+                                                                                                 \
+    static void *FNAME##_sort_worker(void *arg)                                                  \
+    {                                                                                            \
+        struct FNAME##_task *task = arg;                                                         \
+        CTX_DECL = task->CTX;                                                                    \
+                                                                                                 \
+        SORT(CTX, task->a, task->a_count);                                                       \
+                                                                                                 \
+        return NULL;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* How many of the first k merged elements come from a. On ties the */                       \
+    /* elements of a go first */                                                                 \
+    static size_t FNAME##_corank(CTX_DECL, V *a, size_t a_count, V *b, size_t b_count,           \
+                                 size_t k)                                                       \
+    {                                                                                            \
+        (void)CTX;                                                                               \
+                                                                                                 \
+        size_t low = k > b_count ? k - b_count : 0;                                              \
+        size_t high = k < a_count ? k : a_count;                                                 \
+                                                                                                 \
+        while (low < high)                                                                       \
+        {                                                                                        \
+            size_t i = low + (high - low) / 2;                                                   \
+            size_t j = k - i;                                                                    \
+                                                                                                 \
+            if (j > 0 && i < a_count && !(CMP(b[j - 1], a[i]) < 0))                              \
+                low = i + 1;                                                                     \
+            else                                                                                 \
+                high = i;                                                                        \
+        }                                                                                        \
+                                                                                                 \
+        return low;                                                                              \
+    }                                                                                            \
+                                                                                                 \
+    static void *FNAME##_merge_worker(void *arg)                                                 \
+    {                                                                                            \
+        struct FNAME##_task *task = arg;                                                         \
+        CTX_DECL = task->CTX;                                                                    \
+                                                                                                 \
+        V *a = task->a;                                                                          \
+        V *b = task->b;                                                                          \
+        V *out = task->out;                                                                      \
+                                                                                                 \
+        size_t i = FNAME##_corank(CTX, a, task->a_count, b, task->b_count, task->begin);         \
+        size_t i_end = FNAME##_corank(CTX, a, task->a_count, b, task->b_count, task->end);       \
+        size_t j = task->begin - i;                                                              \
+        size_t j_end = task->end - i_end;                                                        \
+        size_t k = task->begin;                                                                  \
+                                                                                                 \
+        while (i < i_end && j < j_end)                                                           \
+            out[k++] = CMP(b[j], a[i]) < 0 ? b[j++] : a[i++];                                    \
+                                                                                                 \
+        memcpy(out + k, a + i, sizeof(V) * (i_end - i));                                         \
+        memcpy(out + k + (i_end - i), b + j, sizeof(V) * (j_end - j));                           \
+                                                                                                 \
+        return NULL;                                                                             \
+    }                                                                                            \
+                                                                                                 \
+    /* The last task runs on the calling thread, and so does every task */                       \
+    /* whose thread could not be created */                                                      \
+    static void FNAME##_run(struct FNAME##_task *tasks, pthread_t *ids, size_t count,            \
+                            void *(*worker)(void *))                                             \
+    {                                                                                            \
+        for (size_t t = 0; t < count; t++)                                                       \
+        {                                                                                        \
+            tasks[t].started =                                                                   \
+                t + 1 < count && pthread_create(&ids[t], NULL, worker, &tasks[t]) == 0;          \
+                                                                                                 \
+            if (!tasks[t].started)                                                               \
+                worker(&tasks[t]);                                                               \
+        }                                                                                        \
+                                                                                                 \
+        for (size_t t = 0; t < count; t++)                                                       \
+        {                                                                                        \
+            if (tasks[t].started)                                                                \
+                pthread_join(ids[t], NULL);                                                      \
+        }                                                                                        \
+    }                                                                                            \
+                                                                                                 \
+    static void FNAME(CTX_DECL, V *array, size_t count, size_t threads)                          \
+    {                                                                                            \
+        if (threads > count / CMC_SORT_PARALLEL_SIZE)                                            \
+            threads = count / CMC_SORT_PARALLEL_SIZE;                                            \
+                                                                                                 \
+        V *scratch = threads > 1 ? malloc(sizeof(V) * count) : NULL;                             \
+        struct FNAME##_task *tasks = scratch ? malloc(sizeof(*tasks) * threads) : NULL;          \
+        pthread_t *ids = tasks ? malloc(sizeof(pthread_t) * threads) : NULL;                     \
+        size_t *bounds = ids ? malloc(sizeof(size_t) * (threads + 1)) : NULL;                    \
+                                                                                                 \
+        if (!bounds)                                                                             \
+        {                                                                                        \
+            free(scratch);                                                                       \
+            free(tasks);                                                                         \
+            free(ids);                                                                           \
+                                                                                                 \
+            SORT(CTX, array, count);                                                             \
+            return;                                                                              \
+        }                                                                                        \
+                                                                                                 \
+        for (size_t t = 0; t < threads; t++)                                                     \
+            bounds[t] = count / threads * t;                                                     \
+                                                                                                 \
+        bounds[threads] = count;                                                                 \
+                                                                                                 \
+        for (size_t t = 0; t < threads; t++)                                                     \
+        {                                                                                        \
+            tasks[t].CTX = CTX;                                                                  \
+            tasks[t].a = array + bounds[t];                                                      \
+            tasks[t].a_count = bounds[t + 1] - bounds[t];                                        \
+        }                                                                                        \
+                                                                                                 \
+        FNAME##_run(tasks, ids, threads, FNAME##_sort_worker);                                   \
+                                                                                                 \
+        V *source = array;                                                                       \
+        V *target = scratch;                                                                     \
+                                                                                                 \
+        /* Each round merges pairs of sorted runs, each pair by as many */                       \
+        /* threads as there are for it */                                                        \
+        for (size_t runs = threads; runs > 1; runs = (runs + 1) / 2)                             \
+        {                                                                                        \
+            size_t pairs = (runs + 1) / 2;                                                       \
+            size_t parts = threads / pairs;                                                      \
+            size_t total = 0;                                                                    \
+                                                                                                 \
+            for (size_t p = 0; p < pairs; p++)                                                   \
+            {                                                                                    \
+                size_t first = bounds[2 * p];                                                    \
+                size_t middle = bounds[2 * p + 1 < runs ? 2 * p + 1 : runs];                     \
+                size_t last = bounds[2 * p + 2 < runs ? 2 * p + 2 : runs];                       \
+                                                                                                 \
+                for (size_t q = 0; q < parts; q++)                                               \
+                {                                                                                \
+                    struct FNAME##_task *task = &tasks[total++];                                 \
+                                                                                                 \
+                    task->CTX = CTX;                                                             \
+                    task->a = source + first;                                                    \
+                    task->a_count = middle - first;                                              \
+                    task->b = source + middle;                                                   \
+                    task->b_count = last - middle;                                               \
+                    task->out = target + first;                                                  \
+                    task->begin = (last - first) / parts * q;                                    \
+                    task->end = q + 1 < parts ? (last - first) / parts * (q + 1) : last - first; \
+                }                                                                                \
+                                                                                                 \
+                bounds[p] = first;                                                               \
+            }                                                                                    \
+                                                                                                 \
+            bounds[pairs] = count;                                                               \
+                                                                                                 \
+            FNAME##_run(tasks, ids, total, FNAME##_merge_worker);                                \
+                                                                                                 \
+            V *tmp = source;                                                                     \
+            source = target;                                                                     \
+            target = tmp;                                                                        \
+        }                                                                                        \
+                                                                                                 \
+        if (source != array)                                                                     \
+            memcpy(array, source, sizeof(V) * count);                                            \
+                                                                                                 \
+        free(scratch);                                                                           \
+        free(tasks);                                                                             \
+        free(ids);                                                                               \
+        free(bounds);                                                                            \
+    }
+
+#define CMC_GENERATE_SELECT(FNAME, V, CTX_DECL, CTX, CMP)                                     \
+                                                                                              \
+    static inline void FNAME##_swap(V *array, size_t a, size_t b)                             \
+    {                                                                                         \
+        V tmp = array[a];                                                                     \
+        array[a] = array[b];                                                                  \
+        array[b] = tmp;                                                                       \
+    }                                                                                         \
+                                                                                              \
+    /* Max heap of the size elements from begin */                                            \
+    static void FNAME##_sift_down(CTX_DECL, V *array, size_t begin, size_t root, size_t size) \
+    {                                                                                         \
+        (void)CTX;                                                                            \
+                                                                                              \
+        while (true)                                                                          \
+        {                                                                                     \
+            size_t child = 2 * root + 1;                                                      \
+                                                                                              \
+            if (child >= size)                                                                \
+                return;                                                                       \
+                                                                                              \
+            if (child + 1 < size &&                                                           \
+                CMP(array[begin + child], array[begin + child + 1]) < 0)                      \
+                child++;                                                                      \
+                                                                                              \
+            if (!(CMP(array[begin + root], array[begin + child]) < 0))                        \
+                return;                                                                       \
+                                                                                              \
+            FNAME##_swap(array, begin + root, begin + child);                                 \
+            root = child;                                                                     \
+        }                                                                                     \
+    }                                                                                         \
+                                                                                              \
+    /* Keeps the smallest elements from begin to nth in a max heap while */                   \
+    /* the rest of the partition goes through it, then puts its root at nth */                \
+    static void FNAME##_heap_select(CTX_DECL, V *array, size_t begin, size_t end, size_t nth) \
+    {                                                                                         \
+        (void)CTX;                                                                            \
+                                                                                              \
+        size_t size = nth - begin + 1;                                                        \
+                                                                                              \
+        for (size_t i = size / 2; i > 0; i--)                                                 \
+            FNAME##_sift_down(CTX, array, begin, i - 1, size);                                \
+                                                                                              \
+        for (size_t i = nth + 1; i < end; i++)                                                \
+        {                                                                                     \
+            if (CMP(array[i], array[begin]) < 0)                                              \
+            {                                                                                 \
+                FNAME##_swap(array, begin, i);                                                \
+                FNAME##_sift_down(CTX, array, begin, 0, size);                                \
+            }                                                                                 \
+        }                                                                                     \
+                                                                                              \
+        FNAME##_swap(array, begin, nth);                                                      \
+    }                                                                                         \
+                                                                                              \
+    static void FNAME(CTX_DECL, V *array, size_t count, size_t nth)                           \
+    {                                                                                         \
+        (void)CTX;                                                                            \
+                                                                                              \
+        if (nth >= count)                                                                     \
+            return;                                                                           \
+                                                                                              \
+        size_t begin = 0;                                                                     \
+        size_t end = count;                                                                   \
+                                                                                              \
+        /* Amount of unbalanced partitions tolerated before the heap is used */               \
+        size_t bad_allowed = 0;                                                               \
+                                                                                              \
+        for (size_t n = count; n > 1; n >>= 1)                                                \
+            bad_allowed++;                                                                    \
+                                                                                              \
+        while (end - begin >= CMC_SORT_INSERTION_SIZE)                                        \
+        {                                                                                     \
+            size_t size = end - begin;                                                        \
+            size_t half = begin + size / 2;                                                   \
+                                                                                              \
+            /* Median of three, which also keeps both scans below in bounds */                \
+            if (CMP(array[half], array[begin]) < 0)                                           \
+                FNAME##_swap(array, begin, half);                                             \
+            if (CMP(array[end - 1], array[half]) < 0)                                         \
+                FNAME##_swap(array, half, end - 1);                                           \
+            if (CMP(array[half], array[begin]) < 0)                                           \
+                FNAME##_swap(array, begin, half);                                             \
+                                                                                              \
+            V pivot = array[half];                                                            \
+                                                                                              \
+            size_t first = begin;                                                             \
+            size_t last = end - 1;                                                            \
+                                                                                              \
+            /* Both scans stop at elements equal to the pivot, so partitions */               \
+            /* of many equal elements still come out balanced */                              \
+            while (true)                                                                      \
+            {                                                                                 \
+                while (CMP(array[first], pivot) < 0)                                          \
+                    first++;                                                                  \
+                while (CMP(pivot, array[last]) < 0)                                           \
+                    last--;                                                                   \
+                                                                                              \
+                if (first >= last)                                                            \
+                    break;                                                                    \
+                                                                                              \
+                FNAME##_swap(array, first, last);                                             \
+                first++;                                                                      \
+                last--;                                                                       \
+            }                                                                                 \
+                                                                                              \
+            /* Every element before first is not greater than any after it */                 \
+            size_t l_size = first - begin;                                                    \
+            size_t r_size = end - first;                                                      \
+                                                                                              \
+            if (l_size < size / 8 || r_size < size / 8)                                       \
+            {                                                                                 \
+                if (bad_allowed == 0)                                                         \
+                {                                                                             \
+                    FNAME##_heap_select(CTX, array, begin, end, nth);                         \
+                    return;                                                                   \
+                }                                                                             \
+                                                                                              \
+                bad_allowed--;                                                                \
+            }                                                                                 \
+                                                                                              \
+            if (nth < first)                                                                  \
+                end = first;                                                                  \
+            else                                                                              \
+                begin = first;                                                                \
+        }                                                                                     \
+                                                                                              \
+        /* Insertion sort of what is left */                                                  \
+        for (size_t i = begin + 1; i < end; i++)                                              \
+        {                                                                                     \
+            V tmp = array[i];                                                                 \
+            size_t j = i;                                                                     \
+                                                                                              \
+            while (j > begin && CMP(tmp, array[j - 1]) < 0)                                   \
+            {                                                                                 \
+                array[j] = array[j - 1];                                                      \
+                j--;                                                                          \
+            }                                                                                 \
+                                                                                              \
+            array[j] = tmp;                                                                   \
+        }                                                                                     \
+    }
+
+#endif /* CMC_SORT_H */
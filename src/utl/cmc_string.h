@@ -10,11 +10,32 @@
 
 /* A very simple fixed size string used by all collections' method to_string */
 
+/* struct cmc_string_builder is a growable string for anything longer than */
+/* that. Appending to it grows its buffer geometrically, so it is amortized */
+/* constant time per character, and clearing it keeps the buffer so it can */
+/* be reused across calls without allocating again. Its printf formats */
+/* straight into the free space at the end of the buffer and only formats */
+/* a second time, after growing it once, when the result did not fit. The */
+/* buffer is always terminated by a null character, once anything was */
+/* appended to it. */
+
+/* The collections that can be iterated have PFX##_to_string_full(coll, */
+/* builder, elem_fmt), that appends every element formatted by elem_fmt */
+/* as "[ e0, e1, ..., en ]", in the order of their iterators. Maps pass */
+/* both the key and the value of an entry to elem_fmt, in this order, so */
+/* it takes two arguments, like "%d: %d". */
+
 #ifndef CMC_STRING_H
 #define CMC_STRING_H
 
 #include <inttypes.h>
+#include <stdarg.h>
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 static const size_t cmc_string_len = 200;
 
@@ -23,4 +44,178 @@ struct cmc_string
     char s[200];
 };
 
+/* Least capacity of a builder that has something in it */
+#ifndef CMC_STRING_BUILDER_MIN
+#define CMC_STRING_BUILDER_MIN 64
+#endif
+
+struct cmc_string_builder
+{
+    char *buffer;
+    size_t length;
+    size_t capacity;
+};
+
+static inline void cmc_string_builder_init(struct cmc_string_builder *builder)
+{
+    builder->buffer = NULL;
+    builder->length = 0;
+    builder->capacity = 0;
+}
+
+static inline void cmc_string_builder_release(struct cmc_string_builder *builder)
+{
+    free(builder->buffer);
+    cmc_string_builder_init(builder);
+}
+
+/* Empties the builder but keeps its buffer */
+static inline void cmc_string_builder_clear(struct cmc_string_builder *builder)
+{
+    builder->length = 0;
+
+    if (builder->buffer)
+        builder->buffer[0] = '\0';
+}
+
+/* Makes room for extra more characters and the null character after them */
+static inline bool cmc_string_builder_reserve(struct cmc_string_builder *builder, size_t extra)
+{
+    if (extra >= SIZE_MAX - builder->length)
+        return false;
+
+    size_t required = builder->length + extra + 1;
+
+    if (required <= builder->capacity)
+        return true;
+
+    size_t capacity = builder->capacity > CMC_STRING_BUILDER_MIN / 2 ? builder->capacity * 2
+                                                                    : CMC_STRING_BUILDER_MIN;
+
+    if (capacity < required)
+        capacity = required;
+
+    char *buffer = realloc(builder->buffer, capacity);
+
+    if (!buffer)
+        return false;
+
+    builder->buffer = buffer;
+    builder->capacity = capacity;
+
+    return true;
+}
+
+static inline bool cmc_string_builder_append(struct cmc_string_builder *builder, const char *string,
+                                             size_t length)
+{
+    if (!cmc_string_builder_reserve(builder, length))
+        return false;
+
+    memcpy(builder->buffer + builder->length, string, length);
+
+    builder->length += length;
+    builder->buffer[builder->length] = '\0';
+
+    return true;
+}
+
+static inline bool cmc_string_builder_puts(struct cmc_string_builder *builder, const char *string)
+{
+    return cmc_string_builder_append(builder, string, strlen(string));
+}
+
+static inline bool cmc_string_builder_putc(struct cmc_string_builder *builder, char c)
+{
+    return cmc_string_builder_append(builder, &c, 1);
+}
+
+static inline bool cmc_string_builder_vprintf(struct cmc_string_builder *builder, const char *format,
+                                              va_list args)
+{
+    if (!cmc_string_builder_reserve(builder, 0))
+        return false;
+
+    va_list copy;
+    va_copy(copy, args);
+
+    size_t free_space = builder->capacity - builder->length;
+    int length = vsnprintf(builder->buffer + builder->length, free_space, format, copy);
+
+    va_end(copy);
+
+    if (length < 0)
+    {
+        builder->buffer[builder->length] = '\0';
+        return false;
+    }
+
+    /* Did not fit, so it is formatted again once there is room for it */
+    if ((size_t)length >= free_space)
+    {
+        if (!cmc_string_builder_reserve(builder, (size_t)length))
+        {
+            builder->buffer[builder->length] = '\0';
+            return false;
+        }
+
+        vsnprintf(builder->buffer + builder->length, (size_t)length + 1, format, args);
+    }
+
+    builder->length += (size_t)length;
+
+    return true;
+}
+
+static inline bool cmc_string_builder_printf(struct cmc_string_builder *builder, const char *format,
+                                             ...)
+{
+    va_list args;
+    va_start(args, format);
+
+    bool result = cmc_string_builder_vprintf(builder, format, args);
+
+    va_end(args);
+
+    return result;
+}
+
+/* The string built so far, which is never NULL */
+static inline const char *cmc_string_builder_str(struct cmc_string_builder *builder)
+{
+    return builder->buffer ? builder->buffer : "";
+}
+
+/* Element arguments given to the format of PFX##_to_string_full */
+#define CMC_IMPL_STRING_VALUE(PFX, iter) PFX##_iter_value(&(iter))
+#define CMC_IMPL_STRING_ENTRY(PFX, iter) PFX##_iter_key(&(iter)), PFX##_iter_value(&(iter))
+
+/* Defines PFX##_to_string_full for a collection whose iterators are */
+/* initialized from a struct TARGET, with ELEMENT being one of the above */
+#define CMC_IMPL_STRING_FULL(PFX, SNAME, TARGET, ELEMENT)                                \
+                                                                                         \
+    bool PFX##_to_string_full(struct TARGET *target, struct cmc_string_builder *builder, \
+                              const char *elem_fmt)                                      \
+    {                                                                                    \
+        struct SNAME##_iter iter;                                                        \
+        bool empty = true;                                                               \
+                                                                                         \
+        if (!cmc_string_builder_putc(builder, '['))                                      \
+            return false;                                                                \
+                                                                                         \
+        for (PFX##_iter_init(&iter, target); !PFX##_iter_end(&iter);                     \
+             PFX##_iter_next(&iter))                                                     \
+        {                                                                                \
+            if (!cmc_string_builder_puts(builder, empty ? " " : ", "))                   \
+                return false;                                                            \
+                                                                                         \
+            if (!cmc_string_builder_printf(builder, elem_fmt, ELEMENT(PFX, iter)))       \
+                return false;                                                            \
+                                                                                         \
+            empty = false;                                                               \
+        }                                                                                \
+                                                                                         \
+        return cmc_string_builder_puts(builder, empty ? "]" : " ]");                     \
+    }
+
 #endif /* CMC_STRING_H */
@@ -0,0 +1,51 @@
+/**
+ * compiler.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Hints to the compiler used by the collections, that expand to nothing */
+/* when the compiler does not support them or when CMC_NO_HINTS is */
+/* defined, so their effect can be measured by building with and without */
+/* it. */
+
+/* CMC_LIKELY and CMC_UNLIKELY wrap the condition of a branch that is */
+/* almost always or almost never taken, like a failed allocation, so the */
+/* other side is laid out as the straight path. CMC_RESTRICT qualifies a */
+/* pointer parameter that does not alias any other one, like the arrays */
+/* that a collection writes its elements to. CMC_PURE marks a function */
+/* whose result only depends on its arguments and on memory it reads, */
+/* without side effects, like count and empty, so repeated calls with */
+/* nothing written in between can be merged even when the function is */
+/* defined in another translation unit and can't be inlined. */
+
+#ifndef CMC_COMPILER_H
+#define CMC_COMPILER_H
+
+#if !defined(CMC_NO_HINTS) && (defined(__GNUC__) || defined(__clang__))
+#define CMC_LIKELY(x) __builtin_expect(!!(x), 1)
+#define CMC_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#define CMC_PURE __attribute__((pure))
+#else
+#define CMC_LIKELY(x) (x)
+#define CMC_UNLIKELY(x) (x)
+#define CMC_PURE
+#endif
+
+#if defined(CMC_NO_HINTS)
+#define CMC_RESTRICT
+#elif defined(__cplusplus) && (defined(__GNUC__) || defined(__clang__))
+#define CMC_RESTRICT __restrict__
+#elif defined(__cplusplus) && defined(_MSC_VER)
+#define CMC_RESTRICT __restrict
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+#define CMC_RESTRICT restrict
+#else
+#define CMC_RESTRICT
+#endif
+
+#endif /* CMC_COMPILER_H */
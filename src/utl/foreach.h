@@ -11,6 +11,8 @@
 #ifndef CMC_FOR_EACH_H
 #define CMC_FOR_EACH_H
 
+#include <stddef.h>
+
 #define CMC_FOR_EACH(PFX, SNAME, TARGET, BODY)                                                                      \
     do                                                                                                              \
     {                                                                                                               \
@@ -29,4 +31,145 @@
         }                                                                                                           \
     } while (0)
 
+/* Loop straight over the buffer of a collection that keeps its elements at */
+/* the start of it, like the List, Stack, Heap, MinMaxHeap or SortedList, */
+/* and their stack allocated versions, with no iterator. BODY sees the */
+/* position of the element as index and a pointer to it as value, and it */
+/* must not change the count of the collection. Elements are visited in the */
+/* order they are kept, so a heap is not visited in order and neither is an */
+/* unsorted SortedList */
+#define CMC_FAST_FOR_EACH(V, TARGET, BODY)                       \
+    do                                                           \
+    {                                                            \
+        V *const cmc_fast_buffer_ = (TARGET)->buffer;            \
+        const size_t cmc_fast_count_ = (TARGET)->count;          \
+                                                                 \
+        for (size_t index = 0; index < cmc_fast_count_; index++) \
+        {                                                        \
+            V *value = cmc_fast_buffer_ + index;                 \
+                                                                 \
+            BODY;                                                \
+        }                                                        \
+    } while (0)
+
+#define CMC_FAST_FOR_EACH_REV(V, TARGET, BODY)             \
+    do                                                     \
+    {                                                      \
+        V *const cmc_fast_buffer_ = (TARGET)->buffer;      \
+                                                           \
+        for (size_t index = (TARGET)->count; index-- > 0;) \
+        {                                                  \
+            V *value = cmc_fast_buffer_ + index;           \
+                                                           \
+            BODY;                                          \
+        }                                                  \
+    } while (0)
+
+/* Same as CMC_FAST_FOR_EACH but for the ring buffers of the Deque, Queue or */
+/* ByteRing, whose elements are in at most two spans given by PFX##_spans. */
+/* A break in BODY only leaves the span it is in */
+#define CMC_FAST_FOR_EACH_SPANS(PFX, V, TARGET, BODY)                                           \
+    do                                                                                          \
+    {                                                                                           \
+        V *cmc_fast_spans_[2];                                                                  \
+        size_t cmc_fast_counts_[2];                                                             \
+                                                                                                \
+        PFX##_spans(TARGET, &cmc_fast_spans_[0], &cmc_fast_counts_[0], &cmc_fast_spans_[1],     \
+                    &cmc_fast_counts_[1]);                                                      \
+                                                                                                \
+        for (size_t cmc_fast_span_ = 0, index = 0; cmc_fast_span_ < 2; cmc_fast_span_++)        \
+        {                                                                                       \
+            V *const cmc_fast_buffer_ = cmc_fast_spans_[cmc_fast_span_];                        \
+            const size_t cmc_fast_count_ = cmc_fast_counts_[cmc_fast_span_];                    \
+                                                                                                \
+            for (size_t cmc_fast_i_ = 0; cmc_fast_i_ < cmc_fast_count_; cmc_fast_i_++, index++) \
+            {                                                                                   \
+                V *value = cmc_fast_buffer_ + cmc_fast_i_;                                      \
+                                                                                                \
+                BODY;                                                                           \
+            }                                                                                   \
+        }                                                                                       \
+    } while (0)
+
+/* Iterates two collections, of any type, in lockstep until either of them */
+/* ends. BODY sees one iterator for each of them, iter1 and iter2 */
+#define CMC_ZIP_FOR_EACH(PFX1, SNAME1, TARGET1, PFX2, SNAME2, TARGET2, BODY) \
+    do                                                                       \
+    {                                                                        \
+        struct SNAME1##_iter iter1 = (TARGET1)->it_start(TARGET1);           \
+        struct SNAME2##_iter iter2 = (TARGET2)->it_start(TARGET2);           \
+                                                                             \
+        for (; !PFX1##_iter_end(&iter1) && !PFX2##_iter_end(&iter2);         \
+             PFX1##_iter_next(&iter1), PFX2##_iter_next(&iter2))             \
+        {                                                                    \
+            BODY;                                                            \
+        }                                                                    \
+    } while (0)
+
+/* Same as CMC_ZIP_FOR_EACH for three collections, with iter1, iter2 and */
+/* iter3 */
+#define CMC_ZIP3_FOR_EACH(PFX1, SNAME1, TARGET1, PFX2, SNAME2, TARGET2, PFX3, SNAME3, TARGET3, \
+                          BODY)                                                                \
+    do                                                                                         \
+    {                                                                                          \
+        struct SNAME1##_iter iter1 = (TARGET1)->it_start(TARGET1);                             \
+        struct SNAME2##_iter iter2 = (TARGET2)->it_start(TARGET2);                             \
+        struct SNAME3##_iter iter3 = (TARGET3)->it_start(TARGET3);                             \
+                                                                                               \
+        for (; !PFX1##_iter_end(&iter1) && !PFX2##_iter_end(&iter2) &&                         \
+               !PFX3##_iter_end(&iter3);                                                       \
+             PFX1##_iter_next(&iter1), PFX2##_iter_next(&iter2), PFX3##_iter_next(&iter3))     \
+        {                                                                                      \
+            BODY;                                                                              \
+        }                                                                                      \
+    } while (0)
+
+/* Same as CMC_ZIP_FOR_EACH but straight over the buffers of two collections */
+/* that keep their elements at the start of it, like CMC_FAST_FOR_EACH. BODY */
+/* sees the position of the elements as index and pointers to them as */
+/* value1 and value2, up to the count of the smallest collection. It must */
+/* not change the count of either collection */
+#define CMC_FAST_ZIP_FOR_EACH(V1, TARGET1, V2, TARGET2, BODY)             \
+    do                                                                    \
+    {                                                                     \
+        V1 *const cmc_zip_buffer1_ = (TARGET1)->buffer;                   \
+        V2 *const cmc_zip_buffer2_ = (TARGET2)->buffer;                   \
+        const size_t cmc_zip_count_ = (TARGET1)->count < (TARGET2)->count \
+                                          ? (TARGET1)->count              \
+                                          : (TARGET2)->count;             \
+                                                                          \
+        for (size_t index = 0; index < cmc_zip_count_; index++)           \
+        {                                                                 \
+            V1 *value1 = cmc_zip_buffer1_ + index;                        \
+            V2 *value2 = cmc_zip_buffer2_ + index;                        \
+                                                                          \
+            BODY;                                                         \
+        }                                                                 \
+    } while (0)
+
+/* Same as CMC_FAST_ZIP_FOR_EACH for three collections, with value1, value2 */
+/* and value3 */
+#define CMC_FAST_ZIP3_FOR_EACH(V1, TARGET1, V2, TARGET2, V3, TARGET3, BODY) \
+    do                                                                      \
+    {                                                                       \
+        V1 *const cmc_zip_buffer1_ = (TARGET1)->buffer;                     \
+        V2 *const cmc_zip_buffer2_ = (TARGET2)->buffer;                     \
+        V3 *const cmc_zip_buffer3_ = (TARGET3)->buffer;                     \
+        size_t cmc_zip_count_ = (TARGET1)->count;                           \
+                                                                            \
+        if ((TARGET2)->count < cmc_zip_count_)                              \
+            cmc_zip_count_ = (TARGET2)->count;                              \
+        if ((TARGET3)->count < cmc_zip_count_)                              \
+            cmc_zip_count_ = (TARGET3)->count;                              \
+                                                                            \
+        for (size_t index = 0; index < cmc_zip_count_; index++)             \
+        {                                                                   \
+            V1 *value1 = cmc_zip_buffer1_ + index;                          \
+            V2 *value2 = cmc_zip_buffer2_ + index;                          \
+            V3 *value3 = cmc_zip_buffer3_ + index;                          \
+                                                                            \
+            BODY;                                                           \
+        }                                                                   \
+    } while (0)
+
 #endif /* CMC_FOR_EACH_H */
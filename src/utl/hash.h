@@ -0,0 +1,270 @@
+/**
+ * hash.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Hash functions ready to be given to the hashtable collections. Byte */
+/* strings are hashed with wyhash (final version 4, public domain), */
+/* integers with the SplitMix64 finalizer and cmc_hash_crc32c uses the */
+/* CRC32 instructions of SSE4.2 or ARMv8 when they are enabled. */
+/* */
+/* Every function has a seeded variant. A table whose keys come from */
+/* untrusted input should use a seed that is not known to its users, for */
+/* example one from cmc_hash_random_seed(), so that colliding keys can't */
+/* be precomputed */
+
+#ifndef CMC_HASH_H
+#define CMC_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#define CMC_HASH_CRC32C_SSE42
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define CMC_HASH_CRC32C_ARM
+#endif
+
+/* Seed used by the functions without one */
+#define CMC_HASH_DEFAULT_SEED UINT64_C(0x9e3779b97f4a7c15)
+
+/* Default secret of wyhash */
+static const uint64_t cmc_hash_wy_secret[4] = { UINT64_C(0xa0761d6478bd642f),
+                                                UINT64_C(0xe7037ed1a0b428db),
+                                                UINT64_C(0x8ebc6af09c88c6e3),
+                                                UINT64_C(0x589965cc75374cc3) };
+
+/* Full 128-bit product of a and b, the low half to a and the high to b */
+static inline void cmc_hash_wy_mum(uint64_t *a, uint64_t *b)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)*a * *b;
+
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+
+    c += lo < t;
+
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+/* The product of a and b folded to 64 bits */
+static inline uint64_t cmc_hash_wy_mix(uint64_t a, uint64_t b)
+{
+    cmc_hash_wy_mum(&a, &b);
+
+    return a ^ b;
+}
+
+static inline uint64_t cmc_hash_wy_read8(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint64_t cmc_hash_wy_read4(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+/* Hashes len bytes starting at data */
+static inline uint64_t cmc_hash_bytes_seed(const void *data, size_t len, uint64_t seed)
+{
+    const uint64_t *s = cmc_hash_wy_secret;
+    const uint8_t *p = (const uint8_t *)data;
+    uint64_t a, b;
+
+    seed ^= cmc_hash_wy_mix(seed ^ s[0], s[1]);
+
+    if (len <= 16)
+    {
+        if (len >= 4)
+        {
+            a = (cmc_hash_wy_read4(p) << 32) | cmc_hash_wy_read4(p + ((len >> 3) << 2));
+            b = (cmc_hash_wy_read4(p + len - 4) << 32) |
+                cmc_hash_wy_read4(p + len - 4 - ((len >> 3) << 2));
+        }
+        else if (len > 0)
+        {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+            b = 0;
+        }
+        else
+            a = b = 0;
+    }
+    else
+    {
+        size_t i = len;
+
+        if (i > 48)
+        {
+            uint64_t seed1 = seed, seed2 = seed;
+
+            do
+            {
+                seed = cmc_hash_wy_mix(cmc_hash_wy_read8(p) ^ s[1],
+                                       cmc_hash_wy_read8(p + 8) ^ seed);
+                seed1 = cmc_hash_wy_mix(cmc_hash_wy_read8(p + 16) ^ s[2],
+                                        cmc_hash_wy_read8(p + 24) ^ seed1);
+                seed2 = cmc_hash_wy_mix(cmc_hash_wy_read8(p + 32) ^ s[3],
+                                        cmc_hash_wy_read8(p + 40) ^ seed2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+
+            seed ^= seed1 ^ seed2;
+        }
+
+        while (i > 16)
+        {
+            seed = cmc_hash_wy_mix(cmc_hash_wy_read8(p) ^ s[1], cmc_hash_wy_read8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+
+        a = cmc_hash_wy_read8(p + i - 16);
+        b = cmc_hash_wy_read8(p + i - 8);
+    }
+
+    a ^= s[1];
+    b ^= seed;
+
+    cmc_hash_wy_mum(&a, &b);
+
+    return cmc_hash_wy_mix(a ^ s[0] ^ len, b ^ s[1]);
+}
+
+static inline uint64_t cmc_hash_bytes(const void *data, size_t len)
+{
+    return cmc_hash_bytes_seed(data, len, CMC_HASH_DEFAULT_SEED);
+}
+
+/* Hashes a null terminated string, the key type of most string maps */
+static inline size_t cmc_hash_str_seed(char *str, uint64_t seed)
+{
+    return (size_t)cmc_hash_bytes_seed(str, strlen(str), seed);
+}
+
+static inline size_t cmc_hash_str(char *str)
+{
+    return cmc_hash_str_seed(str, CMC_HASH_DEFAULT_SEED);
+}
+
+/* SplitMix64 finalizer, every bit of the input affects every bit of the */
+/* output so consecutive integers land on unrelated slots */
+static inline uint64_t cmc_hash_u64_seed(uint64_t x, uint64_t seed)
+{
+    x ^= seed;
+    x ^= x >> 30;
+    x *= UINT64_C(0xbf58476d1ce4e5b9);
+    x ^= x >> 27;
+    x *= UINT64_C(0x94d049bb133111eb);
+    x ^= x >> 31;
+
+    return x;
+}
+
+static inline uint64_t cmc_hash_u64(uint64_t x)
+{
+    return cmc_hash_u64_seed(x, CMC_HASH_DEFAULT_SEED);
+}
+
+/* cmc_hash_u64 for size_t keys, like the ones used by the tests */
+static inline size_t cmc_hash_size(size_t x)
+{
+    return (size_t)cmc_hash_u64(x);
+}
+
+static inline size_t cmc_hash_int(int x)
+{
+    return (size_t)cmc_hash_u64((uint64_t)(int64_t)x);
+}
+
+#if !defined(CMC_HASH_CRC32C_SSE42) && !defined(CMC_HASH_CRC32C_ARM)
+/* Half a byte at a time fallback of the reflected Castagnoli polynomial */
+static const uint32_t cmc_hash_crc32c_table[16] = {
+    0x00000000, 0x105EC76F, 0x20BD8EDE, 0x30E349B1, 0x417B1DBC, 0x5125DAD3,
+    0x61C69362, 0x7198540D, 0x82F63B78, 0x92A8FC17, 0xA24BB5A6, 0xB21572C9,
+    0xC38D26C4, 0xD3D3E1AB, 0xE330A81A, 0xF36E6F75
+};
+#endif
+
+/* CRC32C (Castagnoli) of len bytes, seeded by the starting CRC. It only */
+/* has 32 bits so it suits tables that stay well below 2^32 keys */
+static inline uint32_t cmc_hash_crc32c_seed(const void *data, size_t len, uint32_t seed)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t crc = ~seed;
+
+#if defined(CMC_HASH_CRC32C_SSE42) || defined(CMC_HASH_CRC32C_ARM)
+    for (; len >= 8; len -= 8, p += 8)
+    {
+        uint64_t v;
+        memcpy(&v, p, 8);
+#if defined(CMC_HASH_CRC32C_SSE42)
+        crc = (uint32_t)_mm_crc32_u64(crc, v);
+#else
+        crc = __crc32cd(crc, v);
+#endif
+    }
+
+    for (; len > 0; len--, p++)
+    {
+#if defined(CMC_HASH_CRC32C_SSE42)
+        crc = _mm_crc32_u8(crc, *p);
+#else
+        crc = __crc32cb(crc, *p);
+#endif
+    }
+#else
+    for (; len > 0; len--, p++)
+    {
+        crc ^= *p;
+        crc = (crc >> 4) ^ cmc_hash_crc32c_table[crc & 0x0F];
+        crc = (crc >> 4) ^ cmc_hash_crc32c_table[crc & 0x0F];
+    }
+#endif
+
+    return ~crc;
+}
+
+static inline uint32_t cmc_hash_crc32c(const void *data, size_t len)
+{
+    return cmc_hash_crc32c_seed(data, len, 0);
+}
+
+/* A seed that changes between runs, taken from the clock and from */
+/* addresses that move with ASLR. It is not a cryptographic source */
+static inline uint64_t cmc_hash_random_seed(void)
+{
+    uint64_t seed = (uint64_t)time(NULL);
+    int local = 0;
+
+    seed = cmc_hash_u64_seed(seed, (uint64_t)clock());
+    seed = cmc_hash_u64_seed(seed, (uint64_t)(uintptr_t)&local);
+    seed = cmc_hash_u64_seed(seed, (uint64_t)(uintptr_t)cmc_hash_wy_secret);
+
+    return seed;
+}
+
+#endif /* CMC_HASH_H */
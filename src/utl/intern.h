@@ -0,0 +1,345 @@
+/**
+ * intern.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* String interning. cmc_intern keeps a single copy of each distinct */
+/* string and returns a pointer to it that stays valid until the interner */
+/* is released, so two interned strings are equal only if they are the */
+/* same pointer. Each string also gets an id, counting up from 0, that can */
+/* be turned back into its string. */
+
+/* Interned strings can be the keys of the hashed collections, declared */
+/* with K as const char *, with cmc_intern_cmp, which compares pointers, and */
+/* cmc_intern_hash, which reads the hash computed when they were interned. */
+/* Keys of sorted collections still need strcmp, since pointers are not in */
+/* the order of their strings. */
+
+/* Strings are copied after a small header into chunks of */
+/* CMC_INTERN_CHUNK_SIZE bytes, like utl/arena.h, and are never moved or */
+/* freed on their own. They are found through a hashtable of ids with */
+/* linear probing, that keeps part of each hash so that most probes that */
+/* don't match are not followed to their string. */
+
+/* A struct cmc_intern that is all zeros is empty and uses the default */
+/* allocation functions, which can be changed while it is empty. An */
+/* interner must not be shared by threads without a lock. */
+
+#ifndef CMC_INTERN_H
+#define CMC_INTERN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "cmc_alloc.h"
+#include "hash.h"
+
+#ifndef CMC_INTERN_CHUNK_SIZE
+#define CMC_INTERN_CHUNK_SIZE 65536
+#endif
+
+/* Marks a slot of the hashtable that has no id */
+#define CMC_INTERN_EMPTY UINT32_MAX
+
+/* Header of an interned string, that is right before its bytes */
+struct cmc_intern_string
+{
+    /* Hash of the string, as given by cmc_hash_bytes */
+    uint64_t hash;
+
+    /* Bytes of the string, not counting the 0 that follows them */
+    uint32_t length;
+
+    uint32_t id;
+
+    char data[];
+};
+
+struct cmc_intern_chunk
+{
+    struct cmc_intern_chunk *next;
+
+    /* Bytes of the chunk after its header */
+    size_t capacity;
+
+    /* Bytes taken by strings */
+    size_t used;
+
+    unsigned char data[];
+};
+
+struct cmc_intern_slot
+{
+    uint32_t id;
+
+    /* Upper bits of the hash of the string */
+    uint32_t tag;
+};
+
+struct cmc_intern
+{
+    /* Chunk that strings are copied to, linked to the older ones */
+    struct cmc_intern_chunk *chunk;
+
+    /* Hashtable of ids, with a power of 2 capacity */
+    struct cmc_intern_slot *table;
+    size_t capacity;
+
+    /* Strings by id */
+    struct cmc_intern_string **strings;
+    size_t count;
+    size_t strings_capacity;
+
+    /* Custom allocation functions, the default ones if NULL */
+    struct cmc_alloc_node *alloc;
+};
+
+/* Header of an interned string */
+static inline struct cmc_intern_string *cmc_intern_header(const char *str)
+{
+    return (struct cmc_intern_string *)(str - offsetof(struct cmc_intern_string, data));
+}
+
+static inline struct cmc_alloc_node *cmc_intern_alloc(struct cmc_intern *in)
+{
+    if (!in->alloc)
+        in->alloc = &cmc_alloc_node_default;
+
+    return in->alloc;
+}
+
+/* Copies a string to a chunk, after its header */
+static inline struct cmc_intern_string *cmc_intern_copy(struct cmc_intern *in, const char *str,
+                                                        size_t length, uint64_t hash)
+{
+    size_t align = _Alignof(struct cmc_intern_string);
+    size_t bytes = (sizeof(struct cmc_intern_string) + length + 1 + align - 1) & ~(align - 1);
+    struct cmc_intern_chunk *chunk = in->chunk;
+
+    if (!chunk || chunk->capacity - chunk->used < bytes)
+    {
+        size_t capacity = bytes > CMC_INTERN_CHUNK_SIZE ? bytes : CMC_INTERN_CHUNK_SIZE;
+
+        chunk = cmc_intern_alloc(in)->malloc(sizeof(struct cmc_intern_chunk) + capacity);
+
+        if (!chunk)
+            return NULL;
+
+        chunk->next = in->chunk;
+        chunk->capacity = capacity;
+        chunk->used = 0;
+
+        in->chunk = chunk;
+    }
+
+    struct cmc_intern_string *result = (struct cmc_intern_string *)(chunk->data + chunk->used);
+
+    result->hash = hash;
+    result->length = (uint32_t)length;
+    result->id = (uint32_t)in->count;
+
+    memcpy(result->data, str, length);
+    result->data[length] = 0;
+
+    chunk->used += bytes;
+
+    return result;
+}
+
+/* Slot of a string in the hashtable, or the empty slot where it would go */
+static inline struct cmc_intern_slot *cmc_intern_slot(struct cmc_intern *in, const char *str,
+                                                      size_t length, uint64_t hash)
+{
+    size_t mask = in->capacity - 1;
+    uint32_t tag = (uint32_t)(hash >> 32);
+
+    for (size_t i = (size_t)hash & mask;; i = (i + 1) & mask)
+    {
+        struct cmc_intern_slot *slot = &in->table[i];
+
+        if (slot->id == CMC_INTERN_EMPTY)
+            return slot;
+
+        if (slot->tag != tag)
+            continue;
+
+        struct cmc_intern_string *s = in->strings[slot->id];
+
+        if (s->length == length && memcmp(s->data, str, length) == 0)
+            return slot;
+    }
+}
+
+/* Doubles the hashtable and the array of strings as needed so that one */
+/* more string fits with the table at most 3/4 full */
+static inline bool cmc_intern_reserve(struct cmc_intern *in)
+{
+    struct cmc_alloc_node *alloc = cmc_intern_alloc(in);
+
+    if (in->count == in->strings_capacity)
+    {
+        size_t capacity = in->strings_capacity ? in->strings_capacity * 2 : 64;
+        struct cmc_intern_string **strings =
+            alloc->realloc(in->strings, capacity * sizeof(struct cmc_intern_string *));
+
+        if (!strings)
+            return false;
+
+        in->strings = strings;
+        in->strings_capacity = capacity;
+    }
+
+    if ((in->count + 1) * 4 <= in->capacity * 3)
+        return true;
+
+    size_t capacity = in->capacity ? in->capacity * 2 : 128;
+    struct cmc_intern_slot *table = alloc->malloc(capacity * sizeof(struct cmc_intern_slot));
+
+    if (!table)
+        return false;
+
+    /* All bits set is CMC_INTERN_EMPTY */
+    memset(table, 0xff, capacity * sizeof(struct cmc_intern_slot));
+
+    for (size_t i = 0; i < in->count; i++)
+    {
+        struct cmc_intern_string *s = in->strings[i];
+        size_t j = (size_t)s->hash & (capacity - 1);
+
+        while (table[j].id != CMC_INTERN_EMPTY)
+            j = (j + 1) & (capacity - 1);
+
+        table[j].id = s->id;
+        table[j].tag = (uint32_t)(s->hash >> 32);
+    }
+
+    alloc->free(in->table);
+
+    in->table = table;
+    in->capacity = capacity;
+
+    return true;
+}
+
+/* Returns the interned copy of the length bytes of str, that are copied */
+/* if they were not interned yet, or NULL if they could not be. The copy */
+/* is followed by a 0 */
+static inline const char *cmc_intern(struct cmc_intern *in, const char *str, size_t length)
+{
+    if (length > UINT32_MAX || in->count >= CMC_INTERN_EMPTY || !cmc_intern_reserve(in))
+        return NULL;
+
+    uint64_t hash = cmc_hash_bytes(str, length);
+    struct cmc_intern_slot *slot = cmc_intern_slot(in, str, length, hash);
+
+    if (slot->id != CMC_INTERN_EMPTY)
+        return in->strings[slot->id]->data;
+
+    struct cmc_intern_string *s = cmc_intern_copy(in, str, length, hash);
+
+    if (!s)
+        return NULL;
+
+    slot->id = s->id;
+    slot->tag = (uint32_t)(hash >> 32);
+
+    in->strings[in->count++] = s;
+
+    return s->data;
+}
+
+/* Same as cmc_intern for a null terminated string */
+static inline const char *cmc_intern_str(struct cmc_intern *in, const char *str)
+{
+    return cmc_intern(in, str, strlen(str));
+}
+
+/* The interned copy of a string, or NULL if it was never interned */
+static inline const char *cmc_intern_find(struct cmc_intern *in, const char *str, size_t length)
+{
+    if (in->count == 0 || length > UINT32_MAX)
+        return NULL;
+
+    struct cmc_intern_slot *slot = cmc_intern_slot(in, str, length, cmc_hash_bytes(str, length));
+
+    return slot->id == CMC_INTERN_EMPTY ? NULL : in->strings[slot->id]->data;
+}
+
+/* The interned string of an id, or NULL if there is none */
+static inline const char *cmc_intern_string(struct cmc_intern *in, uint32_t id)
+{
+    return id < in->count ? in->strings[id]->data : NULL;
+}
+
+/* The following take a string returned by the interner */
+
+static inline uint32_t cmc_intern_id(const char *str)
+{
+    return cmc_intern_header(str)->id;
+}
+
+static inline size_t cmc_intern_length(const char *str)
+{
+    return cmc_intern_header(str)->length;
+}
+
+/* For the hashed collections, their hash and their comparison */
+static inline size_t cmc_intern_hash(const char *str)
+{
+    return (size_t)cmc_intern_header(str)->hash;
+}
+
+static inline int cmc_intern_cmp(const char *a, const char *b)
+{
+    return (a > b) - (a < b);
+}
+
+static inline size_t cmc_intern_count(struct cmc_intern *in)
+{
+    return in->count;
+}
+
+static inline size_t cmc_intern_memory_usage(struct cmc_intern *in)
+{
+    size_t bytes = in->capacity * sizeof(struct cmc_intern_slot) +
+                   in->strings_capacity * sizeof(struct cmc_intern_string *);
+
+    for (struct cmc_intern_chunk *chunk = in->chunk; chunk; chunk = chunk->next)
+        bytes += sizeof(struct cmc_intern_chunk) + chunk->capacity;
+
+    return bytes;
+}
+
+/* Frees every string, which is left empty */
+static inline void cmc_intern_release(struct cmc_intern *in)
+{
+    struct cmc_alloc_node *alloc = cmc_intern_alloc(in);
+    struct cmc_intern_chunk *chunk = in->chunk;
+
+    while (chunk)
+    {
+        struct cmc_intern_chunk *next = chunk->next;
+
+        alloc->free(chunk);
+
+        chunk = next;
+    }
+
+    alloc->free(in->table);
+    alloc->free(in->strings);
+
+    in->chunk = NULL;
+    in->table = NULL;
+    in->capacity = 0;
+    in->strings = NULL;
+    in->count = 0;
+    in->strings_capacity = 0;
+}
+
+#endif /* CMC_INTERN_H */
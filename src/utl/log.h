@@ -15,6 +15,18 @@
  *
  * You can customize the logging utility by accessing cmc_log_config and
  * directly modifying its values to better suit your needs.
+ *
+ * Defining CMC_LOG_MIN_LEVEL to a log level removes every call below it at
+ * compile time, so with CMC_LOG_MIN_LEVEL as CMC_LOG_INFO no trace or debug
+ * call costs anything, not even evaluating its arguments.
+ *
+ * cmc_log_limit(TYPE, PER_SECOND, fmt, ...) logs at most PER_SECOND messages
+ * each second from the place where it is called. Its counts are not atomic
+ * so with many threads a few more messages can get through.
+ *
+ * A sink set in cmc_log_config receives every message that is not disabled
+ * instead of it being written by the calling thread, like the one of
+ * log_async.h.
  */
 
 /**
@@ -72,6 +84,16 @@ static const char *cmc_log_color[] = {"\x1b[94m", "\x1b[36m", "\x1b[32m", "\x1b[
 
 #endif
 
+enum cmc_log_type
+{
+    CMC_LOG_TRACE = 1,
+    CMC_LOG_DEBUG = 2,
+    CMC_LOG_INFO = 3,
+    CMC_LOG_WARN = 4,
+    CMC_LOG_ERROR = 5,
+    CMC_LOG_FATAL = 6
+};
+
 static struct
 {
     int tlevel;    /* Terminal Level */
@@ -80,55 +102,114 @@ static struct
     bool fenabled; /* File Output Enabled */
     FILE *file;    /* File for Output */
     bool enabled;  /* Logging enabled */
+    /* Receives the messages instead of them being written, if not NULL */
+    void (*sink)(enum cmc_log_type, const char *, const char *, int, const char *, va_list);
 
-} cmc_log_config = {0, 0, true, true, NULL, true};
+} cmc_log_config = {0, 0, true, true, NULL, true, NULL};
 
-enum cmc_log_type
+#ifndef CMC_LOG_MIN_LEVEL
+#define CMC_LOG_MIN_LEVEL 0
+#endif
+
+#define CMC_LOG_CALL(TYPE, fmt, ...) \
+    ((int)(TYPE) >= CMC_LOG_MIN_LEVEL ? cmc_log(TYPE, __FILE__, __func__, __LINE__, fmt, __VA_ARGS__) : (void)0)
+
+#define cmc_log_trace(fmt, ...) CMC_LOG_CALL(CMC_LOG_TRACE, fmt, __VA_ARGS__)
+#define cmc_log_debug(fmt, ...) CMC_LOG_CALL(CMC_LOG_DEBUG, fmt, __VA_ARGS__)
+#define cmc_log_info(fmt, ...) CMC_LOG_CALL(CMC_LOG_INFO, fmt, __VA_ARGS__)
+#define cmc_log_warn(fmt, ...) CMC_LOG_CALL(CMC_LOG_WARN, fmt, __VA_ARGS__)
+#define cmc_log_error(fmt, ...) CMC_LOG_CALL(CMC_LOG_ERROR, fmt, __VA_ARGS__)
+#define cmc_log_fatal(fmt, ...) CMC_LOG_CALL(CMC_LOG_FATAL, fmt, __VA_ARGS__)
+
+#define cmc_log_limit(TYPE, PER_SECOND, fmt, ...)                                   \
+    do                                                                              \
+    {                                                                               \
+        static time_t cmc_log_second_ = 0;                                          \
+        static unsigned cmc_log_count_ = 0;                                         \
+                                                                                    \
+        if ((int)(TYPE) >= CMC_LOG_MIN_LEVEL &&                                     \
+            cmc_log_allow(&cmc_log_second_, &cmc_log_count_, (PER_SECOND)))         \
+            cmc_log(TYPE, __FILE__, __func__, __LINE__, fmt, __VA_ARGS__);          \
+    } while (0)
+
+/* If a message of this type passes a terminal or file level */
+static inline bool cmc_log_level(int level, enum cmc_log_type log)
 {
-    CMC_LOG_TRACE = 1,
-    CMC_LOG_DEBUG = 2,
-    CMC_LOG_INFO = 3,
-    CMC_LOG_WARN = 4,
-    CMC_LOG_ERROR = 5,
-    CMC_LOG_FATAL = 6
-};
+    if (level < 0)
+        return ((int)log * -1) >= level;
+    else if (level > 0)
+        return (int)log >= level;
 
-#define cmc_log_trace(fmt, ...) cmc_log(CMC_LOG_TRACE, __FILE__, __func__, __LINE__, fmt, __VA_ARGS__)
-#define cmc_log_debug(fmt, ...) cmc_log(CMC_LOG_DEBUG, __FILE__, __func__, __LINE__, fmt, __VA_ARGS__)
-#define cmc_log_info(fmt, ...) cmc_log(CMC_LOG_INFO, __FILE__, __func__, __LINE__, fmt, __VA_ARGS__)
-#define cmc_log_warn(fmt, ...) cmc_log(CMC_LOG_WARN, __FILE__, __func__, __LINE__, fmt, __VA_ARGS__)
-#define cmc_log_error(fmt, ...) cmc_log(CMC_LOG_ERROR, __FILE__, __func__, __LINE__, fmt, __VA_ARGS__)
-#define cmc_log_fatal(fmt, ...) cmc_log(CMC_LOG_FATAL, __FILE__, __func__, __LINE__, fmt, __VA_ARGS__)
+    return true;
+}
 
-static void cmc_log(enum cmc_log_type log, const char *filename, const char *funcname, int line, const char *fmt, ...)
+/* Counts a message of a call site, telling if it is within its limit */
+static inline bool cmc_log_allow(time_t *second, unsigned *count, unsigned per_second)
 {
-    if (!cmc_log_config.enabled)
-        return;
+    time_t now = time(NULL);
 
-    if (cmc_log_config.tenabled)
+    if (*second != now)
     {
-        if (cmc_log_config.tlevel < 0 && ((int)log * -1) < cmc_log_config.tlevel)
-            return;
-        else if (cmc_log_config.tlevel > 0 && (int)log < cmc_log_config.tlevel)
-            return;
+        *second = now;
+        *count = 0;
+    }
 
-        int i = (int)log - 1;
+    return (*count)++ < per_second;
+}
+
+/* Writes what comes before the message itself */
+static inline void cmc_log_header(FILE *stream, bool terminal, time_t t, enum cmc_log_type log,
+                                  const char *filename, const char *funcname, int line)
+{
+    int i = (int)log - 1;
+
+    struct tm *lt = localtime(&t);
 
-        time_t t = time(NULL);
-        struct tm *lt = localtime(&t);
+    char time[32];
 
-        char time[16];
+    if (terminal)
+    {
         time[strftime(time, sizeof(time), "%H:%M:%S", lt)] = '\0';
 
 #ifdef CMC_LOG_COLOR
-        fprintf(stderr,
+        fprintf(stream,
                 "%s %s%5s\x1b[0m \x1b[90m%s at %s:%d:\x1b[0m ",
                 time, cmc_log_color[i], cmc_log_names[i], filename, funcname, line);
 #else
-        fprintf(stderr,
+        fprintf(stream,
                 "%s %5s %s at %s:%d: ",
                 time, cmc_log_names[i], filename, funcname, line);
 #endif
+    }
+    else
+    {
+        time[strftime(time, sizeof(time), "%Y-%m-%d %H:%M:%S", lt)] = '\0';
+
+        fprintf(stream, "%s %5s %s at %s:%d: ", time, cmc_log_names[i], filename, funcname, line);
+    }
+}
+
+static void cmc_log(enum cmc_log_type log, const char *filename, const char *funcname, int line, const char *fmt, ...)
+{
+    if (!cmc_log_config.enabled)
+        return;
+
+    if (cmc_log_config.sink)
+    {
+        va_list sink_args;
+        va_start(sink_args, fmt);
+        cmc_log_config.sink(log, filename, funcname, line, fmt, sink_args);
+        va_end(sink_args);
+
+        return;
+    }
+
+    if (cmc_log_config.tenabled)
+    {
+        if (!cmc_log_level(cmc_log_config.tlevel, log))
+            return;
+
+        cmc_log_header(stderr, true, time(NULL), log, filename, funcname, line);
 
         va_list args;
         va_start(args, fmt);
@@ -141,20 +222,10 @@ static void cmc_log(enum cmc_log_type log, const char *filename, const char *fun
 
     if (cmc_log_config.file && cmc_log_config.fenabled)
     {
-        if (cmc_log_config.flevel < 0 && ((int)log * -1) < cmc_log_config.flevel)
+        if (!cmc_log_level(cmc_log_config.flevel, log))
             return;
-        else if (cmc_log_config.flevel > 0 && (int)log < cmc_log_config.flevel)
-            return;
-
-        int i = (int)log - 1;
-
-        time_t t = time(NULL);
-        struct tm *lt = localtime(&t);
-
-        char time[32];
-        time[strftime(time, sizeof(time), "%Y-%m-%d %H:%M:%S", lt)] = '\0';
 
-        fprintf(cmc_log_config.file, "%s %5s %s at %s:%d: ", time, cmc_log_names[i], filename, funcname, line);
+        cmc_log_header(cmc_log_config.file, false, time(NULL), log, filename, funcname, line);
 
         va_list file_args;
         va_start(file_args, fmt);
@@ -0,0 +1,693 @@
+/**
+ * log_async.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/**
+ * Asynchronous sink for the logging macros of log.h
+ *
+ * cmc_log_async_start sets a sink in cmc_log_config that, instead of
+ * formatting and writing each message, copies its level, file, function,
+ * line, format and arguments into a ring buffer and returns. A background
+ * thread takes them out of the buffer, formats them and writes them to the
+ * terminal and to the file of cmc_log_config, flushing once for every batch
+ * instead of once for every message.
+ *
+ * The ring buffer is lock free. A thread that logs only claims a record of it
+ * with an atomic compare and swap and never waits for the background thread,
+ * so when the buffer is full the message is dropped and counted, and the
+ * amount of dropped messages is written with the next batch.
+ *
+ * The arguments are read following the conversions of the format, so the
+ * format, file and function must be strings that live until the message is
+ * written, like string literals. The strings given to %s are copied, up to
+ * CMC_LOG_ASYNC_STRINGS bytes for each message, and at most
+ * CMC_LOG_ASYNC_ARGS arguments are kept, with the rest of the format written
+ * as it is. %n is not supported and its argument is ignored.
+ *
+ * cmc_log_async_stop must only be called when no other thread is logging.
+ * Requires pthreads and C11 atomics.
+ */
+
+#ifndef CMC_LOG_ASYNC_H
+#define CMC_LOG_ASYNC_H
+
+#include "log.h"
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Amount of records in the ring buffer, must be a power of 2 */
+#ifndef CMC_LOG_ASYNC_CAPACITY
+#define CMC_LOG_ASYNC_CAPACITY 4096
+#endif
+
+/* Arguments kept for each message, including the ones of '*' */
+#ifndef CMC_LOG_ASYNC_ARGS
+#define CMC_LOG_ASYNC_ARGS 8
+#endif
+
+/* Bytes kept for each message for the strings of its %s conversions */
+#ifndef CMC_LOG_ASYNC_STRINGS
+#define CMC_LOG_ASYNC_STRINGS 128
+#endif
+
+/* Nanoseconds that the background thread sleeps when there is nothing to do */
+#ifndef CMC_LOG_ASYNC_SLEEP
+#define CMC_LOG_ASYNC_SLEEP 1000000
+#endif
+
+union cmc_log_async_arg
+{
+    intmax_t i;
+    uintmax_t u;
+    long double f;
+    const void *p;
+    /* Offset of a string within the strings of the record */
+    size_t s;
+};
+
+struct cmc_log_async_record
+{
+    /* Tells producers and the background thread who owns the record */
+    atomic_size_t sequence;
+
+    enum cmc_log_type log;
+    const char *filename;
+    const char *funcname;
+    int line;
+    time_t time;
+    const char *fmt;
+
+    /* Amount of arguments read */
+    size_t count;
+    /* If the arguments did not fit and the format is only written up to them */
+    bool truncated;
+    union cmc_log_async_arg args[CMC_LOG_ASYNC_ARGS];
+    char strings[CMC_LOG_ASYNC_STRINGS];
+};
+
+static struct
+{
+    struct cmc_log_async_record *buffer;
+    atomic_size_t enqueue_pos;
+    /* Only used by the background thread */
+    size_t dequeue_pos;
+    /* Records written, for cmc_log_async_flush */
+    atomic_size_t written;
+    atomic_size_t dropped;
+    /* Dropped messages that were already reported */
+    size_t reported;
+    atomic_bool running;
+    pthread_t thread;
+
+} cmc_log_async_state;
+
+/* What a conversion reads from the arguments */
+enum cmc_log_async_kind
+{
+    CMC_LOG_ASYNC_NONE = 0,
+    CMC_LOG_ASYNC_SIGNED,
+    CMC_LOG_ASYNC_UNSIGNED,
+    CMC_LOG_ASYNC_FLOAT,
+    CMC_LOG_ASYNC_CHAR,
+    CMC_LOG_ASYNC_STRING,
+    CMC_LOG_ASYNC_POINTER,
+    CMC_LOG_ASYNC_IGNORED
+};
+
+/* A conversion of a format, from its '%' up to end */
+struct cmc_log_async_spec
+{
+    const char *end;
+    enum cmc_log_async_kind kind;
+    /* Amount of '*' for width and precision */
+    int stars;
+    /* The length modifier, like "hh" or "l", and its size */
+    const char *length;
+    size_t length_size;
+    char conversion;
+};
+
+/* Parses the conversion that starts at the '%' of fmt */
+static inline struct cmc_log_async_spec cmc_log_async_parse(const char *fmt)
+{
+    struct cmc_log_async_spec spec = { 0 };
+    const char *c = fmt + 1;
+
+    while (*c && strchr("-+ #0", *c))
+        c++;
+
+    if (*c == '*')
+    {
+        spec.stars++;
+        c++;
+    }
+
+    while (*c >= '0' && *c <= '9')
+        c++;
+
+    if (*c == '.')
+    {
+        c++;
+
+        if (*c == '*')
+        {
+            spec.stars++;
+            c++;
+        }
+
+        while (*c >= '0' && *c <= '9')
+            c++;
+    }
+
+    spec.length = c;
+
+    while (*c && strchr("hljztL", *c))
+        c++;
+
+    spec.length_size = (size_t)(c - spec.length);
+    spec.conversion = *c;
+    spec.end = *c ? c + 1 : c;
+
+    switch (spec.conversion)
+    {
+        case 'd':
+        case 'i':
+            spec.kind = CMC_LOG_ASYNC_SIGNED;
+            break;
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+            spec.kind = CMC_LOG_ASYNC_UNSIGNED;
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            spec.kind = CMC_LOG_ASYNC_FLOAT;
+            break;
+        case 'c':
+            spec.kind = CMC_LOG_ASYNC_CHAR;
+            break;
+        case 's':
+            spec.kind = CMC_LOG_ASYNC_STRING;
+            break;
+        case 'p':
+            spec.kind = CMC_LOG_ASYNC_POINTER;
+            break;
+        case 'n':
+            spec.kind = CMC_LOG_ASYNC_IGNORED;
+            break;
+        default:
+            spec.kind = CMC_LOG_ASYNC_NONE;
+            break;
+    }
+
+    return spec;
+}
+
+/* If the length modifier of a spec is the given one */
+static inline bool cmc_log_async_length(struct cmc_log_async_spec *spec, const char *length)
+{
+    return spec->length_size == strlen(length) && strncmp(spec->length, length, spec->length_size) == 0;
+}
+
+/* Reads an integer argument by its length modifier */
+static inline intmax_t cmc_log_async_read_signed(struct cmc_log_async_spec *spec, va_list *args)
+{
+    if (cmc_log_async_length(spec, "hh"))
+        return (signed char)va_arg(*args, int);
+    else if (cmc_log_async_length(spec, "h"))
+        return (short)va_arg(*args, int);
+    else if (cmc_log_async_length(spec, "l"))
+        return va_arg(*args, long);
+    else if (cmc_log_async_length(spec, "ll"))
+        return va_arg(*args, long long);
+    else if (cmc_log_async_length(spec, "j"))
+        return va_arg(*args, intmax_t);
+    else if (cmc_log_async_length(spec, "z"))
+        return (intmax_t)va_arg(*args, size_t);
+    else if (cmc_log_async_length(spec, "t"))
+        return va_arg(*args, ptrdiff_t);
+
+    return va_arg(*args, int);
+}
+
+static inline uintmax_t cmc_log_async_read_unsigned(struct cmc_log_async_spec *spec, va_list *args)
+{
+    if (cmc_log_async_length(spec, "hh"))
+        return (unsigned char)va_arg(*args, unsigned);
+    else if (cmc_log_async_length(spec, "h"))
+        return (unsigned short)va_arg(*args, unsigned);
+    else if (cmc_log_async_length(spec, "l"))
+        return va_arg(*args, unsigned long);
+    else if (cmc_log_async_length(spec, "ll"))
+        return va_arg(*args, unsigned long long);
+    else if (cmc_log_async_length(spec, "j"))
+        return va_arg(*args, uintmax_t);
+    else if (cmc_log_async_length(spec, "z"))
+        return va_arg(*args, size_t);
+    else if (cmc_log_async_length(spec, "t"))
+        return (uintmax_t)va_arg(*args, ptrdiff_t);
+
+    return va_arg(*args, unsigned);
+}
+
+/* Copies the arguments of fmt into the record */
+static inline void cmc_log_async_capture(struct cmc_log_async_record *record, const char *fmt,
+                                         va_list *args)
+{
+    size_t strings = 0;
+
+    record->count = 0;
+    record->truncated = false;
+
+    for (const char *c = fmt; *c; c++)
+    {
+        if (*c != '%')
+            continue;
+
+        if (c[1] == '%')
+        {
+            c++;
+            continue;
+        }
+
+        struct cmc_log_async_spec spec = cmc_log_async_parse(c);
+
+        if (record->count + (size_t)spec.stars + 1 > CMC_LOG_ASYNC_ARGS)
+        {
+            record->truncated = true;
+            return;
+        }
+
+        for (int i = 0; i < spec.stars; i++)
+            record->args[record->count++].i = va_arg(*args, int);
+
+        union cmc_log_async_arg *arg = &(record->args[record->count++]);
+
+        switch (spec.kind)
+        {
+            case CMC_LOG_ASYNC_SIGNED:
+                arg->i = cmc_log_async_read_signed(&spec, args);
+                break;
+            case CMC_LOG_ASYNC_UNSIGNED:
+                arg->u = cmc_log_async_read_unsigned(&spec, args);
+                break;
+            case CMC_LOG_ASYNC_FLOAT:
+                if (cmc_log_async_length(&spec, "L"))
+                    arg->f = va_arg(*args, long double);
+                else
+                    arg->f = va_arg(*args, double);
+                break;
+            case CMC_LOG_ASYNC_CHAR:
+                arg->i = va_arg(*args, int);
+                break;
+            case CMC_LOG_ASYNC_STRING:
+            {
+                const char *string = va_arg(*args, const char *);
+                size_t length = string ? strlen(string) : 6;
+                size_t space = CMC_LOG_ASYNC_STRINGS - strings;
+
+                if (space == 0)
+                {
+                    record->count--;
+                    record->truncated = true;
+                    return;
+                }
+
+                if (length > space - 1)
+                    length = space - 1;
+
+                memcpy(record->strings + strings, string ? string : "(null)", length);
+                record->strings[strings + length] = '\0';
+
+                arg->s = strings;
+                strings += length + 1;
+                break;
+            }
+            case CMC_LOG_ASYNC_POINTER:
+                arg->p = va_arg(*args, const void *);
+                break;
+            case CMC_LOG_ASYNC_IGNORED:
+                (void)va_arg(*args, void *);
+                break;
+            case CMC_LOG_ASYNC_NONE:
+                record->count--;
+                break;
+        }
+
+        c = spec.end - 1;
+    }
+}
+
+/* Writes a conversion with its length modifier changed to the one that its */
+/* argument was stored as */
+static inline void cmc_log_async_print(FILE *stream, struct cmc_log_async_record *record,
+                                       const char *start, struct cmc_log_async_spec *spec,
+                                       size_t *arg)
+{
+    char format[64];
+    size_t prefix = (size_t)(spec->length - start);
+
+    if (prefix > sizeof(format) - 4)
+        prefix = sizeof(format) - 4;
+
+    memcpy(format, start, prefix);
+
+    size_t f = prefix;
+
+    if (spec->kind == CMC_LOG_ASYNC_SIGNED || spec->kind == CMC_LOG_ASYNC_UNSIGNED)
+        format[f++] = 'j';
+    else if (spec->kind == CMC_LOG_ASYNC_FLOAT)
+        format[f++] = 'L';
+
+    format[f++] = spec->conversion;
+    format[f] = '\0';
+
+    int stars[2] = { 0, 0 };
+
+    for (int i = 0; i < spec->stars; i++)
+        stars[i] = (int)record->args[(*arg)++].i;
+
+    union cmc_log_async_arg value = record->args[(*arg)++];
+
+#define CMC_LOG_ASYNC_PRINTF(VALUE)                                            \
+    do                                                                         \
+    {                                                                          \
+        if (spec->stars == 0)                                                  \
+            fprintf(stream, format, VALUE);                                    \
+        else if (spec->stars == 1)                                             \
+            fprintf(stream, format, stars[0], VALUE);                          \
+        else                                                                   \
+            fprintf(stream, format, stars[0], stars[1], VALUE);                \
+    } while (0)
+
+    switch (spec->kind)
+    {
+        case CMC_LOG_ASYNC_SIGNED:
+            CMC_LOG_ASYNC_PRINTF(value.i);
+            break;
+        case CMC_LOG_ASYNC_UNSIGNED:
+            CMC_LOG_ASYNC_PRINTF(value.u);
+            break;
+        case CMC_LOG_ASYNC_FLOAT:
+            CMC_LOG_ASYNC_PRINTF(value.f);
+            break;
+        case CMC_LOG_ASYNC_CHAR:
+            CMC_LOG_ASYNC_PRINTF((int)value.i);
+            break;
+        case CMC_LOG_ASYNC_STRING:
+            CMC_LOG_ASYNC_PRINTF(record->strings + value.s);
+            break;
+        case CMC_LOG_ASYNC_POINTER:
+            CMC_LOG_ASYNC_PRINTF(value.p);
+            break;
+        default:
+            break;
+    }
+
+#undef CMC_LOG_ASYNC_PRINTF
+}
+
+/* Writes the message of a record, without its header */
+static inline void cmc_log_async_message(FILE *stream, struct cmc_log_async_record *record)
+{
+    const char *c = record->fmt;
+    size_t arg = 0;
+
+    while (*c)
+    {
+        const char *text = c;
+
+        while (*c && *c != '%')
+            c++;
+
+        fwrite(text, 1, (size_t)(c - text), stream);
+
+        if (!*c)
+            break;
+
+        if (c[1] == '%')
+        {
+            fputc('%', stream);
+            c += 2;
+            continue;
+        }
+
+        struct cmc_log_async_spec spec = cmc_log_async_parse(c);
+
+        if (spec.kind == CMC_LOG_ASYNC_IGNORED)
+        {
+            c = spec.end;
+            continue;
+        }
+
+        if (spec.kind == CMC_LOG_ASYNC_NONE || arg + (size_t)spec.stars + 1 > record->count)
+        {
+            /* Not a conversion or one whose argument was not kept */
+            fputs(c, stream);
+            break;
+        }
+
+        cmc_log_async_print(stream, record, c, &spec, &arg);
+
+        c = spec.end;
+    }
+}
+
+/* Writes a record to the terminal and to the file, like cmc_log would */
+static inline void cmc_log_async_write(struct cmc_log_async_record *record)
+{
+    if (cmc_log_config.tenabled && cmc_log_level(cmc_log_config.tlevel, record->log))
+    {
+        cmc_log_header(stderr, true, record->time, record->log, record->filename,
+                       record->funcname, record->line);
+        cmc_log_async_message(stderr, record);
+        fputc('\n', stderr);
+    }
+
+    if (cmc_log_config.file && cmc_log_config.fenabled &&
+        cmc_log_level(cmc_log_config.flevel, record->log))
+    {
+        cmc_log_header(cmc_log_config.file, false, record->time, record->log, record->filename,
+                       record->funcname, record->line);
+        cmc_log_async_message(cmc_log_config.file, record);
+        fputc('\n', cmc_log_config.file);
+    }
+}
+
+/* The sink set by cmc_log_async_start, called by the thread that logs */
+static void cmc_log_async_sink(enum cmc_log_type log, const char *filename, const char *funcname,
+                               int line, const char *fmt, va_list args)
+{
+    bool terminal = cmc_log_config.tenabled && cmc_log_level(cmc_log_config.tlevel, log);
+    bool file = cmc_log_config.file && cmc_log_config.fenabled &&
+                cmc_log_level(cmc_log_config.flevel, log);
+
+    if (!terminal && !file)
+        return;
+
+    struct cmc_log_async_record *record;
+    size_t pos = atomic_load_explicit(&cmc_log_async_state.enqueue_pos, memory_order_relaxed);
+
+    for (;;)
+    {
+        record = &(cmc_log_async_state.buffer[pos & (CMC_LOG_ASYNC_CAPACITY - 1)]);
+
+        size_t sequence = atomic_load_explicit(&(record->sequence), memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&cmc_log_async_state.enqueue_pos, &pos,
+                                                      pos + 1, memory_order_relaxed,
+                                                      memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            /* Full */
+            atomic_fetch_add_explicit(&cmc_log_async_state.dropped, 1, memory_order_relaxed);
+            return;
+        }
+        else
+            pos = atomic_load_explicit(&cmc_log_async_state.enqueue_pos, memory_order_relaxed);
+    }
+
+    record->log = log;
+    record->filename = filename;
+    record->funcname = funcname;
+    record->line = line;
+    record->time = time(NULL);
+    record->fmt = fmt;
+
+    va_list copy;
+    va_copy(copy, args);
+    cmc_log_async_capture(record, fmt, &copy);
+    va_end(copy);
+
+    atomic_store_explicit(&(record->sequence), pos + 1, memory_order_release);
+}
+
+/* Writes every record that is ready, returning how many there were */
+static inline size_t cmc_log_async_drain(void)
+{
+    size_t count = 0;
+
+    for (;;)
+    {
+        size_t pos = cmc_log_async_state.dequeue_pos;
+        struct cmc_log_async_record *record =
+            &(cmc_log_async_state.buffer[pos & (CMC_LOG_ASYNC_CAPACITY - 1)]);
+
+        if (atomic_load_explicit(&(record->sequence), memory_order_acquire) != pos + 1)
+            break;
+
+        cmc_log_async_write(record);
+
+        atomic_store_explicit(&(record->sequence), pos + CMC_LOG_ASYNC_CAPACITY,
+                              memory_order_release);
+
+        cmc_log_async_state.dequeue_pos = pos + 1;
+        count++;
+    }
+
+    size_t dropped = atomic_load_explicit(&cmc_log_async_state.dropped, memory_order_relaxed);
+
+    if (dropped != cmc_log_async_state.reported)
+    {
+        if (cmc_log_config.tenabled)
+            fprintf(stderr, "%zu log messages dropped\n", dropped - cmc_log_async_state.reported);
+
+        if (cmc_log_config.file && cmc_log_config.fenabled)
+            fprintf(cmc_log_config.file, "%zu log messages dropped\n",
+                    dropped - cmc_log_async_state.reported);
+
+        cmc_log_async_state.reported = dropped;
+    }
+
+    if (count > 0)
+    {
+        fflush(stderr);
+
+        if (cmc_log_config.file)
+            fflush(cmc_log_config.file);
+
+        atomic_fetch_add_explicit(&cmc_log_async_state.written, count, memory_order_release);
+    }
+
+    return count;
+}
+
+static void *cmc_log_async_run(void *argument)
+{
+    (void)argument;
+
+    struct timespec sleep = { 0, CMC_LOG_ASYNC_SLEEP };
+
+    for (;;)
+    {
+        if (cmc_log_async_drain() > 0)
+            continue;
+
+        if (!atomic_load_explicit(&cmc_log_async_state.running, memory_order_acquire))
+            break;
+
+        nanosleep(&sleep, NULL);
+    }
+
+    /* What was logged right before stopping */
+    cmc_log_async_drain();
+
+    return NULL;
+}
+
+/* Starts the background thread and sets the sink of cmc_log_config */
+static inline bool cmc_log_async_start(void)
+{
+    if (cmc_log_async_state.buffer)
+        return true;
+
+    struct cmc_log_async_record *buffer =
+        malloc(sizeof(struct cmc_log_async_record) * CMC_LOG_ASYNC_CAPACITY);
+
+    if (!buffer)
+        return false;
+
+    for (size_t i = 0; i < CMC_LOG_ASYNC_CAPACITY; i++)
+        atomic_init(&(buffer[i].sequence), i);
+
+    cmc_log_async_state.buffer = buffer;
+    cmc_log_async_state.dequeue_pos = 0;
+    cmc_log_async_state.reported = 0;
+    atomic_init(&cmc_log_async_state.enqueue_pos, 0);
+    atomic_init(&cmc_log_async_state.written, 0);
+    atomic_init(&cmc_log_async_state.dropped, 0);
+    atomic_init(&cmc_log_async_state.running, true);
+
+    if (pthread_create(&cmc_log_async_state.thread, NULL, cmc_log_async_run, NULL) != 0)
+    {
+        free(buffer);
+        cmc_log_async_state.buffer = NULL;
+        return false;
+    }
+
+    cmc_log_config.sink = cmc_log_async_sink;
+
+    return true;
+}
+
+/* Waits until everything logged before the call is written */
+static inline void cmc_log_async_flush(void)
+{
+    if (!cmc_log_async_state.buffer)
+        return;
+
+    size_t target = atomic_load_explicit(&cmc_log_async_state.enqueue_pos, memory_order_acquire);
+    struct timespec sleep = { 0, CMC_LOG_ASYNC_SLEEP / 10 };
+
+    while (atomic_load_explicit(&cmc_log_async_state.written, memory_order_acquire) < target)
+        nanosleep(&sleep, NULL);
+}
+
+/* Writes what is left, stops the background thread and removes the sink */
+static inline void cmc_log_async_stop(void)
+{
+    if (!cmc_log_async_state.buffer)
+        return;
+
+    cmc_log_config.sink = NULL;
+
+    atomic_store_explicit(&cmc_log_async_state.running, false, memory_order_release);
+    pthread_join(cmc_log_async_state.thread, NULL);
+
+    free(cmc_log_async_state.buffer);
+    cmc_log_async_state.buffer = NULL;
+}
+
+/* Messages dropped because the ring buffer was full */
+static inline size_t cmc_log_async_dropped(void)
+{
+    return atomic_load_explicit(&cmc_log_async_state.dropped, memory_order_relaxed);
+}
+
+#endif /* CMC_LOG_ASYNC_H */
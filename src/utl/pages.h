@@ -0,0 +1,215 @@
+/**
+ * pages.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Allocation functions for large arrays, like the buffers of a big HashMap */
+/* or List, used through cmc_alloc_node_pages. Every block is aligned to */
+/* CMC_CACHE_LINE_SIZE so an entry never straddles more cache lines than it */
+/* has to. Blocks of at least CMC_PAGES_THRESHOLD bytes are mapped straight */
+/* from the system, aligned to CMC_PAGES_HUGE_SIZE and advised to be backed */
+/* by huge pages, which cuts the TLB misses of random accesses. The system */
+/* zeroes a fresh mapping, so calloc does not touch its pages. */
+
+/* Mapping needs mmap with MAP_ANONYMOUS, which glibc only declares with */
+/* _DEFAULT_SOURCE or _GNU_SOURCE defined. Without it every block comes */
+/* from malloc, still aligned. With CMC_PAGES_HUGETLB defined large blocks */
+/* are first mapped with MAP_HUGETLB, which needs huge pages reserved by the */
+/* system, and then as regular pages if that fails. */
+
+#ifndef CMC_PAGES_H
+#define CMC_PAGES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "cmc_alloc.h"
+
+#ifndef CMC_CACHE_LINE_SIZE
+#define CMC_CACHE_LINE_SIZE 64
+#endif
+
+#ifndef CMC_PAGES_HUGE_SIZE
+#define CMC_PAGES_HUGE_SIZE ((size_t)2 << 20)
+#endif
+
+#ifndef CMC_PAGES_THRESHOLD
+#define CMC_PAGES_THRESHOLD CMC_PAGES_HUGE_SIZE
+#endif
+
+#if defined(MAP_ANONYMOUS)
+#define CMC_PAGES_MMAP
+#endif
+
+/* Kept right before every block */
+struct cmc_pages_header
+{
+    /* What malloc or mmap returned */
+    void *base;
+
+    /* Bytes of the mapping, or 0 if the block came from malloc */
+    size_t length;
+
+    /* Bytes that the block can hold */
+    size_t capacity;
+};
+
+static inline struct cmc_pages_header *cmc_pages_header(void *ptr)
+{
+    return (struct cmc_pages_header *)((unsigned char *)ptr - sizeof(struct cmc_pages_header));
+}
+
+/* If the block is a mapping of its own */
+static inline bool cmc_pages_mapped(void *ptr)
+{
+    return cmc_pages_header(ptr)->length != 0;
+}
+
+#ifdef CMC_PAGES_MMAP
+
+/* The mapping starts at a huge page and the block one cache line after it */
+static inline void *cmc_pages_map(size_t size)
+{
+    size_t huge = CMC_PAGES_HUGE_SIZE;
+
+    if (size > SIZE_MAX - CMC_CACHE_LINE_SIZE - 2 * huge)
+        return NULL;
+
+    size_t length = (size + CMC_CACHE_LINE_SIZE + huge - 1) / huge * huge;
+
+    unsigned char *base = MAP_FAILED;
+
+#if defined(CMC_PAGES_HUGETLB) && defined(MAP_HUGETLB)
+    base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                -1, 0);
+#endif
+
+    if (base == MAP_FAILED)
+    {
+        /* One more huge page so the mapping can be trimmed to start at one */
+        unsigned char *mapping = mmap(NULL, length + huge, PROT_READ | PROT_WRITE,
+                                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (mapping == MAP_FAILED)
+            return NULL;
+
+        size_t head = (huge - (uintptr_t)mapping % huge) % huge;
+
+        if (head > 0)
+            munmap(mapping, head);
+
+        munmap(mapping + head + length, huge - head);
+
+        base = mapping + head;
+
+#ifdef MADV_HUGEPAGE
+        madvise(base, length, MADV_HUGEPAGE);
+#endif
+    }
+
+    unsigned char *result = base + CMC_CACHE_LINE_SIZE;
+
+    *cmc_pages_header(result) =
+        (struct cmc_pages_header){ base, length, length - CMC_CACHE_LINE_SIZE };
+
+    return result;
+}
+
+#endif /* CMC_PAGES_MMAP */
+
+static inline void *cmc_pages_malloc(size_t size)
+{
+#ifdef CMC_PAGES_MMAP
+    if (size >= CMC_PAGES_THRESHOLD)
+        return cmc_pages_map(size);
+#endif
+
+    size_t extra = sizeof(struct cmc_pages_header) + CMC_CACHE_LINE_SIZE - 1;
+
+    if (size > SIZE_MAX - extra)
+        return NULL;
+
+    unsigned char *base = malloc(size + extra);
+
+    if (!base)
+        return NULL;
+
+    uintptr_t start = (uintptr_t)(base + sizeof(struct cmc_pages_header));
+
+    unsigned char *result = base + sizeof(struct cmc_pages_header) +
+                            (CMC_CACHE_LINE_SIZE - start % CMC_CACHE_LINE_SIZE) %
+                                CMC_CACHE_LINE_SIZE;
+
+    *cmc_pages_header(result) = (struct cmc_pages_header){ base, 0, size };
+
+    return result;
+}
+
+static inline void *cmc_pages_calloc(size_t count, size_t size)
+{
+    if (size != 0 && count > SIZE_MAX / size)
+        return NULL;
+
+    void *result = cmc_pages_malloc(count * size);
+
+    /* A fresh mapping is already zeroed */
+    if (result && !cmc_pages_mapped(result))
+        memset(result, 0, count * size);
+
+    return result;
+}
+
+static inline void cmc_pages_free(void *ptr)
+{
+    if (!ptr)
+        return;
+
+    struct cmc_pages_header *header = cmc_pages_header(ptr);
+
+#ifdef CMC_PAGES_MMAP
+    if (header->length != 0)
+    {
+        munmap(header->base, header->length);
+        return;
+    }
+#endif
+
+    free(header->base);
+}
+
+static inline void *cmc_pages_realloc(void *ptr, size_t size)
+{
+    if (!ptr)
+        return cmc_pages_malloc(size);
+
+    size_t capacity = cmc_pages_header(ptr)->capacity;
+
+    /* A mapping is kept while the block fits in it, a block from malloc */
+    /* unless it shrinks to less than half */
+    if (size <= capacity && (cmc_pages_mapped(ptr) || size >= capacity / 2))
+        return ptr;
+
+    void *result = cmc_pages_malloc(size);
+
+    if (!result)
+        return NULL;
+
+    memcpy(result, ptr, capacity < size ? capacity : size);
+
+    cmc_pages_free(ptr);
+
+    return result;
+}
+
+static struct cmc_alloc_node cmc_alloc_node_pages = { cmc_pages_malloc, cmc_pages_calloc,
+                                                      cmc_pages_realloc, cmc_pages_free };
+
+#endif /* CMC_PAGES_H */
@@ -0,0 +1,298 @@
+/**
+ * pool.h
+ *
+ * Creation Date: 14/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Size class allocator for small blocks, like the nodes of a SkipListMap */
+/* or the first chunks of nodes of a TreeMap, used through */
+/* cmc_alloc_node_pool. */
+/* Blocks of up to CMC_POOL_MAX_SIZE bytes are rounded up to a multiple of */
+/* CMC_POOL_GRAIN and every such size is a class with, for each thread, a */
+/* cache of free blocks that is used without any synchronization. Larger */
+/* blocks go straight to malloc. */
+
+/* A cache that grows past twice CMC_POOL_BATCH blocks moves a batch of */
+/* them to a depot shared by all threads, and an empty cache takes a batch */
+/* from it, so a node freed by one thread can be reused by another. The */
+/* depot of each class is a lock free stack of batches. Pushing one is a */
+/* compare and swap, while taking one swaps the whole stack out for an */
+/* empty one and pushes back the batches that were not taken, so there is */
+/* never a compare and swap against a head that may have been popped and */
+/* pushed back in between. */
+
+/* Batches that the depot has none of are carved out of one malloc and the */
+/* pool never frees them, they are only reused. A thread should call */
+/* cmc_pool_flush before exiting so its cache goes back to the depot. */
+/* Requires C11 atomics and thread local storage. */
+
+#ifndef CMC_POOL_H
+#define CMC_POOL_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cmc_alloc.h"
+
+#ifndef CMC_POOL_MAX_SIZE
+#define CMC_POOL_MAX_SIZE 256
+#endif
+
+#ifndef CMC_POOL_BATCH
+#define CMC_POOL_BATCH 64
+#endif
+
+/* Sizes of the classes are multiples of this, it fits a free block */
+#define CMC_POOL_GRAIN 16
+
+#define CMC_POOL_CLASSES (CMC_POOL_MAX_SIZE / CMC_POOL_GRAIN)
+
+/* Every block is preceded by its class, or CMC_POOL_CLASSES if it came */
+/* from malloc, in a header that keeps the block aligned */
+#define CMC_POOL_HEADER _Alignof(max_align_t)
+
+/* A block that is free links to the next one of its cache or batch and, */
+/* if it is the first of a batch in the depot, to the next batch */
+struct cmc_pool_block
+{
+    struct cmc_pool_block *next;
+    struct cmc_pool_block *batch;
+};
+
+struct cmc_pool_cache
+{
+    struct cmc_pool_block *blocks[CMC_POOL_CLASSES];
+    size_t count[CMC_POOL_CLASSES];
+};
+
+static _Thread_local struct cmc_pool_cache cmc_pool_cache;
+
+static _Atomic(struct cmc_pool_block *) cmc_pool_depot[CMC_POOL_CLASSES];
+
+static inline size_t cmc_pool_class(void *ptr)
+{
+    size_t size_class;
+
+    memcpy(&size_class, (unsigned char *)ptr - CMC_POOL_HEADER, sizeof(size_t));
+
+    return size_class;
+}
+
+static inline void *cmc_pool_mark(unsigned char *block, size_t size_class)
+{
+    memcpy(block, &size_class, sizeof(size_t));
+
+    return block + CMC_POOL_HEADER;
+}
+
+/* Pushes a list of batches, from first to last, to the depot */
+static inline void cmc_pool_depot_push(size_t size_class, struct cmc_pool_block *first,
+                                       struct cmc_pool_block *last)
+{
+    struct cmc_pool_block *head = atomic_load_explicit(&cmc_pool_depot[size_class],
+                                                       memory_order_relaxed);
+
+    do
+    {
+        last->batch = head;
+    } while (!atomic_compare_exchange_weak_explicit(&cmc_pool_depot[size_class], &head, first,
+                                                    memory_order_release,
+                                                    memory_order_relaxed));
+}
+
+/* Takes a batch from the depot or carves a new one */
+static inline struct cmc_pool_block *cmc_pool_refill(size_t size_class)
+{
+    struct cmc_pool_block *taken =
+        atomic_exchange_explicit(&cmc_pool_depot[size_class], NULL, memory_order_acquire);
+
+    if (taken)
+    {
+        struct cmc_pool_block *rest = taken->batch;
+
+        if (rest)
+        {
+            struct cmc_pool_block *last = rest;
+
+            while (last->batch)
+                last = last->batch;
+
+            cmc_pool_depot_push(size_class, rest, last);
+        }
+
+        return taken;
+    }
+
+    size_t stride = CMC_POOL_HEADER + (size_class + 1) * CMC_POOL_GRAIN;
+
+    unsigned char *slab = malloc(stride * CMC_POOL_BATCH);
+
+    if (!slab)
+        return NULL;
+
+    struct cmc_pool_block *next = NULL;
+
+    for (size_t i = CMC_POOL_BATCH; i > 0; i--)
+    {
+        struct cmc_pool_block *block = cmc_pool_mark(slab + (i - 1) * stride, size_class);
+
+        block->next = next;
+        next = block;
+    }
+
+    return next;
+}
+
+static inline void *cmc_pool_malloc(size_t size)
+{
+    if (size > CMC_POOL_MAX_SIZE)
+    {
+        if (size > SIZE_MAX - CMC_POOL_HEADER)
+            return NULL;
+
+        unsigned char *block = malloc(CMC_POOL_HEADER + size);
+
+        return block ? cmc_pool_mark(block, CMC_POOL_CLASSES) : NULL;
+    }
+
+    size_t size_class = size == 0 ? 0 : (size - 1) / CMC_POOL_GRAIN;
+
+    struct cmc_pool_cache *cache = &cmc_pool_cache;
+
+    if (!cache->blocks[size_class])
+    {
+        cache->blocks[size_class] = cmc_pool_refill(size_class);
+
+        if (!cache->blocks[size_class])
+            return NULL;
+
+        cache->count[size_class] = CMC_POOL_BATCH;
+    }
+
+    struct cmc_pool_block *result = cache->blocks[size_class];
+
+    cache->blocks[size_class] = result->next;
+
+    if (cache->count[size_class] > 0)
+        cache->count[size_class]--;
+
+    return result;
+}
+
+static inline void *cmc_pool_calloc(size_t count, size_t size)
+{
+    if (size != 0 && count > SIZE_MAX / size)
+        return NULL;
+
+    void *result = cmc_pool_malloc(count * size);
+
+    if (result)
+        memset(result, 0, count * size);
+
+    return result;
+}
+
+static inline void cmc_pool_free(void *ptr)
+{
+    if (!ptr)
+        return;
+
+    size_t size_class = cmc_pool_class(ptr);
+
+    if (size_class == CMC_POOL_CLASSES)
+    {
+        free((unsigned char *)ptr - CMC_POOL_HEADER);
+        return;
+    }
+
+    struct cmc_pool_cache *cache = &cmc_pool_cache;
+
+    struct cmc_pool_block *block = ptr;
+
+    block->next = cache->blocks[size_class];
+    cache->blocks[size_class] = block;
+
+    if (++cache->count[size_class] < 2 * CMC_POOL_BATCH)
+        return;
+
+    /* The most recently freed blocks stay, they are the likeliest to be in */
+    /* the cache of the processor */
+    struct cmc_pool_block *last = block;
+    size_t kept = 1;
+
+    for (; kept < CMC_POOL_BATCH && last->next; kept++)
+        last = last->next;
+
+    /* A batch taken from the depot might not have been full */
+    if (last->next)
+    {
+        cmc_pool_depot_push(size_class, last->next, last->next);
+
+        last->next = NULL;
+    }
+
+    cache->count[size_class] = kept;
+}
+
+static inline void *cmc_pool_realloc(void *ptr, size_t size)
+{
+    if (!ptr)
+        return cmc_pool_malloc(size);
+
+    size_t size_class = cmc_pool_class(ptr);
+
+    if (size_class == CMC_POOL_CLASSES && size > CMC_POOL_MAX_SIZE)
+    {
+        if (size > SIZE_MAX - CMC_POOL_HEADER)
+            return NULL;
+
+        unsigned char *block = realloc((unsigned char *)ptr - CMC_POOL_HEADER,
+                                       CMC_POOL_HEADER + size);
+
+        return block ? block + CMC_POOL_HEADER : NULL;
+    }
+
+    /* A block from malloc is larger than any class */
+    size_t old_size =
+        size_class == CMC_POOL_CLASSES ? SIZE_MAX : (size_class + 1) * CMC_POOL_GRAIN;
+
+    if (size <= old_size)
+        return ptr;
+
+    void *result = cmc_pool_malloc(size);
+
+    if (!result)
+        return NULL;
+
+    memcpy(result, ptr, old_size < size ? old_size : size);
+
+    cmc_pool_free(ptr);
+
+    return result;
+}
+
+/* Moves every block in the cache of this thread to the depot */
+static inline void cmc_pool_flush(void)
+{
+    struct cmc_pool_cache *cache = &cmc_pool_cache;
+
+    for (size_t i = 0; i < CMC_POOL_CLASSES; i++)
+    {
+        if (cache->blocks[i])
+            cmc_pool_depot_push(i, cache->blocks[i], cache->blocks[i]);
+
+        cache->blocks[i] = NULL;
+        cache->count[i] = 0;
+    }
+}
+
+static struct cmc_alloc_node cmc_alloc_node_pool = { cmc_pool_malloc, cmc_pool_calloc,
+                                                     cmc_pool_realloc, cmc_pool_free };
+
+#endif /* CMC_POOL_H */
@@ -0,0 +1,482 @@
+/**
+ * replica.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Copies of a read-only collection, one on each NUMA node, so that readers */
+/* on every socket look things up in local memory. CMC_GENERATE_REPLICA(PFX, */
+/* SNAME) is used after the collection is generated with the same PFX and */
+/* SNAME and defines struct SNAME##_replica and functions prefixed by */
+/* PFX##_replica_. */
+
+/* PFX##_replica_new takes a collection, that still belongs to the caller, */
+/* a function that copies it and one that frees a copy. Each copy is made */
+/* by a thread whose memory policy prefers one of the nodes, so the pages */
+/* the copy touches first are placed on that node. That needs the copy to */
+/* get fresh memory, as the large buffers that malloc maps and those of */
+/* cmc_alloc_node_pages are. */
+
+/* Each reading thread registers itself to get a reader slot, which also */
+/* records the node of the CPU it runs on, so threads should be pinned to */
+/* a node. PFX##_replica_enter returns the copy of that node, which can be */
+/* read until PFX##_replica_leave. PFX##_replica_publish makes new copies */
+/* of a collection and swaps all of them at once, so a reader always sees */
+/* copies of the same collection. The old copies are freed once every */
+/* reader that could be using them has left, as in the SnapshotHashMap. */
+
+/* Nodes are found through /sys/devices/system/node and memory policies set */
+/* with the set_mempolicy system call, so libnuma is not needed. Where */
+/* these are not available, or with CMC_REPLICA_NO_NUMA defined, there is a */
+/* single node and a single copy. The system calls are only declared by */
+/* glibc with _DEFAULT_SOURCE or _GNU_SOURCE. Requires pthreads and C11 */
+/* atomics. */
+
+#ifndef CMC_REPLICA_H
+#define CMC_REPLICA_H
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "cmc_alloc.h"
+
+#if defined(__linux__) && !defined(CMC_REPLICA_NO_NUMA)
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(_DEFAULT_SOURCE) && defined(SYS_getcpu) && defined(SYS_set_mempolicy)
+#define CMC_REPLICA_NUMA
+#endif
+#endif
+
+/* Reader slots are padded to this size to avoid false sharing */
+#ifndef CMC_CACHE_LINE_SIZE
+#define CMC_CACHE_LINE_SIZE 64
+#endif
+
+/* Maximum amount of threads registered as readers at the same time */
+#ifndef CMC_REPLICA_READERS
+#define CMC_REPLICA_READERS 64
+#endif
+
+/* Nodes past this one share the copy of the last node */
+#define CMC_REPLICA_MAX_NODES 64
+
+/* Epoch of a reader that is not inside a read */
+#define CMC_REPLICA_IDLE SIZE_MAX
+
+#ifdef CMC_REPLICA_NUMA
+
+/* Linux memory policy that takes memory from a node while it has some */
+#define CMC_REPLICA_MPOL_PREFERRED 1
+#define CMC_REPLICA_MPOL_DEFAULT 0
+
+/* Amount of nodes, as one more than the highest node online */
+static inline size_t cmc_replica_node_count(void)
+{
+    FILE *file = fopen("/sys/devices/system/node/online", "r");
+
+    if (!file)
+        return 1;
+
+    /* A list of ranges like 0-1,4 */
+    unsigned long node = 0;
+    unsigned long highest = 0;
+
+    while (fscanf(file, "%lu", &node) == 1)
+    {
+        if (node > highest)
+            highest = node;
+
+        if (fgetc(file) == EOF)
+            break;
+    }
+
+    fclose(file);
+
+    return highest + 1 < CMC_REPLICA_MAX_NODES ? highest + 1 : CMC_REPLICA_MAX_NODES;
+}
+
+/* Node of the CPU the calling thread is running on */
+static inline size_t cmc_replica_current_node(void)
+{
+    unsigned cpu = 0;
+    unsigned node = 0;
+
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0)
+        return 0;
+
+    return node;
+}
+
+/* Makes the memory that the calling thread touches first come from node, */
+/* or from anywhere again if prefer is false */
+static inline bool cmc_replica_prefer(size_t node, bool prefer)
+{
+    unsigned long mask = 1UL << node;
+
+    if (!prefer)
+        return syscall(SYS_set_mempolicy, CMC_REPLICA_MPOL_DEFAULT, NULL, 0) == 0;
+
+    /* The kernel reads one bit less than it is told to */
+    return syscall(SYS_set_mempolicy, CMC_REPLICA_MPOL_PREFERRED, &mask,
+                   sizeof(mask) * 8 + 1) == 0;
+}
+
+#else
+
+static inline size_t cmc_replica_node_count(void)
+{
+    return 1;
+}
+
+static inline size_t cmc_replica_current_node(void)
+{
+    return 0;
+}
+
+static inline bool cmc_replica_prefer(size_t node, bool prefer)
+{
+    (void)node;
+    (void)prefer;
+
+    return false;
+}
+
+#endif /* CMC_REPLICA_NUMA */
+
+#define CMC_GENERATE_REPLICA(PFX, SNAME)    \
+    CMC_GENERATE_REPLICA_HEADER(PFX, SNAME) \
+    CMC_GENERATE_REPLICA_SOURCE(PFX, SNAME)
+
+/* HEADER ********************************************************************/
+#define CMC_GENERATE_REPLICA_HEADER(PFX, SNAME)                                             \
+                                                                                            \
+    /* A reader slot, padded so that readers do not share cache lines */                    \
+    struct SNAME##_replica_reader                                                           \
+    {                                                                                       \
+        /* Epoch the reader entered with or CMC_REPLICA_IDLE */                             \
+        atomic_size_t epoch;                                                                \
+                                                                                            \
+        /* Node whose copy the reader uses */                                               \
+        size_t node;                                                                        \
+                                                                                            \
+        /* If the slot belongs to a thread */                                               \
+        bool registered;                                                                    \
+                                                                                            \
+        char padding[CMC_CACHE_LINE_SIZE -                                                  \
+                     (sizeof(atomic_size_t) + sizeof(size_t) + sizeof(bool)) %              \
+                         CMC_CACHE_LINE_SIZE];                                              \
+    };                                                                                      \
+                                                                                            \
+    /* The copies published together */                                                     \
+    struct SNAME##_replica_copies                                                           \
+    {                                                                                       \
+        struct SNAME *copies[CMC_REPLICA_MAX_NODES];                                        \
+    };                                                                                      \
+                                                                                            \
+    /* Replica Structure */                                                                 \
+    struct SNAME##_replica                                                                  \
+    {                                                                                       \
+        /* Reader slots */                                                                  \
+        struct SNAME##_replica_reader readers[CMC_REPLICA_READERS];                         \
+                                                                                            \
+        /* Copies that readers use */                                                       \
+        struct SNAME##_replica_copies *_Atomic current;                                     \
+                                                                                            \
+        /* Incremented every time new copies are published */                               \
+        atomic_size_t epoch;                                                                \
+                                                                                            \
+        /* Serializes publishers and reader registration */                                 \
+        pthread_mutex_t lock;                                                               \
+                                                                                            \
+        /* Amount of nodes, each with a copy */                                             \
+        size_t nodes;                                                                       \
+                                                                                            \
+        /* Makes a copy of a collection */                                                  \
+        struct SNAME *(*copy)(struct SNAME *);                                              \
+                                                                                            \
+        /* Frees a copy */                                                                  \
+        void (*release)(struct SNAME *);                                                    \
+                                                                                            \
+        /* Custom allocation functions */                                                   \
+        struct cmc_alloc_node *alloc;                                                       \
+    };                                                                                      \
+                                                                                            \
+    /* Replica Functions */                                                                 \
+    struct SNAME##_replica *PFX##_replica_new(struct SNAME *source,                         \
+                                              struct SNAME *(*copy)(struct SNAME *),        \
+                                              void (*release)(struct SNAME *));             \
+    struct SNAME##_replica *PFX##_replica_new_custom(struct SNAME *source,                  \
+                                                     struct SNAME *(*copy)(struct SNAME *), \
+                                                     void (*release)(struct SNAME *),       \
+                                                     struct cmc_alloc_node *alloc);         \
+    void PFX##_replica_free(struct SNAME##_replica *_replica_);                             \
+    size_t PFX##_replica_register(struct SNAME##_replica *_replica_);                       \
+    void PFX##_replica_unregister(struct SNAME##_replica *_replica_, size_t reader);        \
+    struct SNAME *PFX##_replica_enter(struct SNAME##_replica *_replica_, size_t reader);    \
+    void PFX##_replica_leave(struct SNAME##_replica *_replica_, size_t reader);             \
+    bool PFX##_replica_publish(struct SNAME##_replica *_replica_, struct SNAME *source);    \
+    size_t PFX##_replica_nodes(struct SNAME##_replica *_replica_);
+/* SOURCE ********************************************************************/
+#define CMC_GENERATE_REPLICA_SOURCE(PFX, SNAME)                                                   \
+                                                                                                  \
+    /* A copy made by a thread on the node it is for */                                           \
+    struct SNAME##_replica_job                                                                    \
+    {                                                                                             \
+        struct SNAME##_replica *replica;                                                          \
+        struct SNAME *source;                                                                     \
+        struct SNAME *result;                                                                     \
+        size_t node;                                                                              \
+    };                                                                                            \
+                                                                                                  \
+    /* Implementation Detail Functions */                                                         \
+    static struct SNAME##_replica_copies *PFX##_replica_impl_make(struct SNAME##_replica *r_,     \
+                                                                  struct SNAME *source);          \
+    static void *PFX##_replica_impl_copy(void *arg);                                              \
+    static void PFX##_replica_impl_release(struct SNAME##_replica *_replica_,                     \
+                                           struct SNAME##_replica_copies *copies);                \
+                                                                                                  \
+    struct SNAME##_replica *PFX##_replica_new(struct SNAME *source,                               \
+                                              struct SNAME *(*copy)(struct SNAME *),              \
+                                              void (*release)(struct SNAME *))                    \
+    {                                                                                             \
+        return PFX##_replica_new_custom(source, copy, release, NULL);                             \
+    }                                                                                             \
+                                                                                                  \
+    struct SNAME##_replica *PFX##_replica_new_custom(struct SNAME *source,                        \
+                                                     struct SNAME *(*copy)(struct SNAME *),       \
+                                                     void (*release)(struct SNAME *),             \
+                                                     struct cmc_alloc_node *alloc)                \
+    {                                                                                             \
+        if (!alloc)                                                                               \
+            alloc = &cmc_alloc_node_default;                                                      \
+                                                                                                  \
+        /* Whole cache lines, so that no other block shares the last one */                       \
+        size_t size = (sizeof(struct SNAME##_replica) + CMC_CACHE_LINE_SIZE - 1) /                \
+                      CMC_CACHE_LINE_SIZE;                                                        \
+                                                                                                  \
+        struct SNAME##_replica *_replica_ =                                                       \
+            cmc_alloc_aligned(alloc, CMC_CACHE_LINE_SIZE, size * CMC_CACHE_LINE_SIZE);            \
+                                                                                                  \
+        if (!_replica_)                                                                           \
+            return NULL;                                                                          \
+                                                                                                  \
+        _replica_->nodes = cmc_replica_node_count();                                              \
+        _replica_->copy = copy;                                                                   \
+        _replica_->release = release;                                                             \
+        _replica_->alloc = alloc;                                                                 \
+                                                                                                  \
+        struct SNAME##_replica_copies *copies = PFX##_replica_impl_make(_replica_, source);       \
+                                                                                                  \
+        if (!copies)                                                                              \
+        {                                                                                         \
+            cmc_alloc_aligned_free(alloc, _replica_);                                             \
+            return NULL;                                                                          \
+        }                                                                                         \
+                                                                                                  \
+        if (pthread_mutex_init(&(_replica_->lock), NULL) != 0)                                    \
+        {                                                                                         \
+            PFX##_replica_impl_release(_replica_, copies);                                        \
+            cmc_alloc_aligned_free(alloc, _replica_);                                             \
+            return NULL;                                                                          \
+        }                                                                                         \
+                                                                                                  \
+        for (size_t i = 0; i < CMC_REPLICA_READERS; i++)                                          \
+        {                                                                                         \
+            atomic_init(&(_replica_->readers[i].epoch), CMC_REPLICA_IDLE);                        \
+            _replica_->readers[i].node = 0;                                                       \
+            _replica_->readers[i].registered = false;                                             \
+        }                                                                                         \
+                                                                                                  \
+        atomic_init(&(_replica_->current), copies);                                               \
+        atomic_init(&(_replica_->epoch), 0);                                                      \
+                                                                                                  \
+        return _replica_;                                                                         \
+    }                                                                                             \
+                                                                                                  \
+    /* Must not be called while other threads are using the replica */                            \
+    void PFX##_replica_free(struct SNAME##_replica *_replica_)                                    \
+    {                                                                                             \
+        PFX##_replica_impl_release(_replica_, atomic_load_explicit(&(_replica_->current),         \
+                                                                   memory_order_relaxed));        \
+                                                                                                  \
+        pthread_mutex_destroy(&(_replica_->lock));                                                \
+                                                                                                  \
+        cmc_alloc_aligned_free(_replica_->alloc, _replica_);                                      \
+    }                                                                                             \
+                                                                                                  \
+    /* Called by the reading thread. Returns CMC_REPLICA_READERS when every */                    \
+    /* slot is taken */                                                                           \
+    size_t PFX##_replica_register(struct SNAME##_replica *_replica_)                              \
+    {                                                                                             \
+        size_t node = cmc_replica_current_node();                                                 \
+                                                                                                  \
+        if (node >= _replica_->nodes)                                                             \
+            node = _replica_->nodes - 1;                                                          \
+                                                                                                  \
+        pthread_mutex_lock(&(_replica_->lock));                                                   \
+                                                                                                  \
+        size_t reader = 0;                                                                        \
+                                                                                                  \
+        while (reader < CMC_REPLICA_READERS && _replica_->readers[reader].registered)             \
+            reader++;                                                                             \
+                                                                                                  \
+        if (reader < CMC_REPLICA_READERS)                                                         \
+        {                                                                                         \
+            _replica_->readers[reader].node = node;                                               \
+            _replica_->readers[reader].registered = true;                                         \
+        }                                                                                         \
+                                                                                                  \
+        pthread_mutex_unlock(&(_replica_->lock));                                                 \
+                                                                                                  \
+        return reader;                                                                            \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_replica_unregister(struct SNAME##_replica *_replica_, size_t reader)               \
+    {                                                                                             \
+        pthread_mutex_lock(&(_replica_->lock));                                                   \
+                                                                                                  \
+        _replica_->readers[reader].registered = false;                                            \
+                                                                                                  \
+        pthread_mutex_unlock(&(_replica_->lock));                                                 \
+    }                                                                                             \
+                                                                                                  \
+    /* The epoch announced in the slot must be visible before the copies */                       \
+    /* are loaded. A publisher that then sees the slot idle knows that the */                     \
+    /* reader will load the copies it published */                                                \
+    struct SNAME *PFX##_replica_enter(struct SNAME##_replica *_replica_, size_t reader)           \
+    {                                                                                             \
+        struct SNAME##_replica_reader *slot = &(_replica_->readers[reader]);                      \
+                                                                                                  \
+        size_t epoch = atomic_load_explicit(&(_replica_->epoch), memory_order_acquire);           \
+                                                                                                  \
+        atomic_store_explicit(&(slot->epoch), epoch, memory_order_relaxed);                       \
+        atomic_thread_fence(memory_order_seq_cst);                                                \
+                                                                                                  \
+        struct SNAME##_replica_copies *copies =                                                   \
+            atomic_load_explicit(&(_replica_->current), memory_order_acquire);                    \
+                                                                                                  \
+        return copies->copies[slot->node];                                                        \
+    }                                                                                             \
+                                                                                                  \
+    void PFX##_replica_leave(struct SNAME##_replica *_replica_, size_t reader)                    \
+    {                                                                                             \
+        atomic_store_explicit(&(_replica_->readers[reader].epoch), CMC_REPLICA_IDLE,              \
+                              memory_order_release);                                              \
+    }                                                                                             \
+                                                                                                  \
+    /* Makes copies of source and publishes them, then frees the previous */                      \
+    /* ones once no reader can still be using them. Returns false, keeping */                     \
+    /* the previous copies, if any copy could not be made */                                      \
+    bool PFX##_replica_publish(struct SNAME##_replica *_replica_, struct SNAME *source)           \
+    {                                                                                             \
+        pthread_mutex_lock(&(_replica_->lock));                                                   \
+                                                                                                  \
+        struct SNAME##_replica_copies *copies = PFX##_replica_impl_make(_replica_, source);       \
+                                                                                                  \
+        if (!copies)                                                                              \
+        {                                                                                         \
+            pthread_mutex_unlock(&(_replica_->lock));                                             \
+            return false;                                                                         \
+        }                                                                                         \
+                                                                                                  \
+        struct SNAME##_replica_copies *previous = atomic_exchange(&(_replica_->current), copies); \
+                                                                                                  \
+        size_t epoch = atomic_fetch_add(&(_replica_->epoch), 1) + 1;                              \
+                                                                                                  \
+        atomic_thread_fence(memory_order_seq_cst);                                                \
+                                                                                                  \
+        /* Readers that entered before the new epoch might hold previous */                       \
+        for (size_t i = 0; i < CMC_REPLICA_READERS; i++)                                          \
+        {                                                                                         \
+            atomic_size_t *reader_epoch = &(_replica_->readers[i].epoch);                         \
+                                                                                                  \
+            while (atomic_load_explicit(reader_epoch, memory_order_acquire) < epoch)              \
+                sched_yield();                                                                    \
+        }                                                                                         \
+                                                                                                  \
+        pthread_mutex_unlock(&(_replica_->lock));                                                 \
+                                                                                                  \
+        PFX##_replica_impl_release(_replica_, previous);                                          \
+                                                                                                  \
+        return true;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    size_t PFX##_replica_nodes(struct SNAME##_replica *_replica_)                                 \
+    {                                                                                             \
+        return _replica_->nodes;                                                                  \
+    }                                                                                             \
+                                                                                                  \
+    /* Copies source once for each node, one node at a time so that source */                     \
+    /* is only read by one thread. Returns NULL if any copy failed */                             \
+    static struct SNAME##_replica_copies *PFX##_replica_impl_make(struct SNAME##_replica *r_,     \
+                                                                  struct SNAME *source)           \
+    {                                                                                             \
+        struct SNAME##_replica_copies *copies =                                                   \
+            r_->alloc->calloc(1, sizeof(struct SNAME##_replica_copies));                          \
+                                                                                                  \
+        if (!copies)                                                                              \
+            return NULL;                                                                          \
+                                                                                                  \
+        for (size_t i = 0; i < r_->nodes; i++)                                                    \
+        {                                                                                         \
+            struct SNAME##_replica_job job = { r_, source, NULL, i };                             \
+                                                                                                  \
+            /* A single node has its copy made by the calling thread */                           \
+            if (r_->nodes == 1)                                                                   \
+                PFX##_replica_impl_copy(&job);                                                    \
+            else                                                                                  \
+            {                                                                                     \
+                pthread_t thread;                                                                 \
+                                                                                                  \
+                if (pthread_create(&thread, NULL, PFX##_replica_impl_copy, &job) == 0)            \
+                    pthread_join(thread, NULL);                                                   \
+            }                                                                                     \
+                                                                                                  \
+            copies->copies[i] = job.result;                                                       \
+                                                                                                  \
+            if (!job.result)                                                                      \
+            {                                                                                     \
+                PFX##_replica_impl_release(r_, copies);                                           \
+                return NULL;                                                                      \
+            }                                                                                     \
+        }                                                                                         \
+                                                                                                  \
+        return copies;                                                                            \
+    }                                                                                             \
+                                                                                                  \
+    static void *PFX##_replica_impl_copy(void *arg)                                               \
+    {                                                                                             \
+        struct SNAME##_replica_job *job = arg;                                                    \
+                                                                                                  \
+        bool placed = job->replica->nodes > 1 && cmc_replica_prefer(job->node, true);             \
+                                                                                                  \
+        job->result = job->replica->copy(job->source);                                            \
+                                                                                                  \
+        if (placed)                                                                               \
+            cmc_replica_prefer(job->node, false);                                                 \
+                                                                                                  \
+        return NULL;                                                                              \
+    }                                                                                             \
+                                                                                                  \
+    static void PFX##_replica_impl_release(struct SNAME##_replica *_replica_,                     \
+                                           struct SNAME##_replica_copies *copies)                 \
+    {                                                                                             \
+        for (size_t i = 0; i < _replica_->nodes; i++)                                             \
+        {                                                                                         \
+            if (copies->copies[i])                                                                \
+                _replica_->release(copies->copies[i]);                                            \
+        }                                                                                         \
+                                                                                                  \
+        _replica_->alloc->free(copies);                                                           \
+    }
+
+#endif /* CMC_REPLICA_H */
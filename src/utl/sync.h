@@ -0,0 +1,416 @@
+/**
+ * sync.h
+ *
+ * Creation Date: 15/10/2026
+ *
+ * Authors:
+ * Leonardo Vencovsky (https://github.com/LeoVen)
+ *
+ */
+
+/* Synchronized wrapper around any collection, shared by threads through a */
+/* reader writer lock. CMC_GENERATE_SYNC(C, PFX, SNAME, K, V) is used after */
+/* the collection is generated with the same arguments and defines */
+/* struct SNAME##_sync and functions prefixed by PFX##_sync_. */
+
+/* PFX##_sync_new takes a collection that is then only used through the */
+/* wrapper, and PFX##_sync_free gives it back to be freed by the caller. */
+/* PFX##_sync_read and PFX##_sync_write call a function with the */
+/* collection while holding a shared or an exclusive lock, which is also */
+/* how its iterators are used, since an iterator must not outlive the */
+/* lock. The batch functions lock_and_apply and lock_and_apply_shared call */
+/* a function once for each of count items of size bytes under a single */
+/* lock, so a thread that has many operations to do pays for one */
+/* acquisition instead of one for each. */
+
+/* Every collection gets count and empty, which take a shared lock, except */
+/* for the few that do not have them. Maps, sets, heaps and sequences also */
+/* get their usual functions, with the same signatures as the collection */
+/* but taking the wrapper. Functions that only read, like get and contains, */
+/* take a shared lock and the others an exclusive one. Maps and sets also */
+/* have insert_all, and get_all or contains_all, to do a whole array of */
+/* keys at once. Functions that return pointers into the collection, like */
+/* get_ref, are not wrapped since the pointer would outlive the lock. */
+
+/* Other functions can be added with CMC_GENERATE_SYNC_READ(PFX, SNAME, R, */
+/* NAME, PARAMS, ARGS) and CMC_GENERATE_SYNC_WRITE, that define */
+/* R PFX##_sync_##NAME calling PFX##_##NAME. PARAMS are the parameters */
+/* after the collection and ARGS their names, each in parentheses and */
+/* starting with a comma, like (, K key, V *out) and (, key, out), or () */
+/* when there are none. Requires pthreads. */
+
+#ifndef CMC_SYNC_H
+#define CMC_SYNC_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "cmc_alloc.h"
+
+#define CMC_IMPL_SYNC_EXPAND(...) __VA_ARGS__
+
+/* Functions that wrap a function of the collection, called with one of */
+/* the functions below and LOCK as rdlock or wrlock */
+#define CMC_IMPL_SYNC_DECLARE(PFX, SNAME, LOCK, R, NAME, PARAMS, ARGS) \
+    R PFX##_sync_##NAME(struct SNAME##_sync *_sync_ CMC_IMPL_SYNC_EXPAND PARAMS);
+
+#define CMC_IMPL_SYNC_DEFINE(PFX, SNAME, LOCK, R, NAME, PARAMS, ARGS)            \
+    R PFX##_sync_##NAME(struct SNAME##_sync *_sync_ CMC_IMPL_SYNC_EXPAND PARAMS) \
+    {                                                                            \
+        pthread_rwlock_##LOCK(&(_sync_->lock));                                  \
+        R result = PFX##_##NAME(_sync_->collection CMC_IMPL_SYNC_EXPAND ARGS);   \
+        pthread_rwlock_unlock(&(_sync_->lock));                                  \
+        return result;                                                           \
+    }
+
+#define CMC_GENERATE_SYNC_READ(PFX, SNAME, R, NAME, PARAMS, ARGS) \
+    static CMC_IMPL_SYNC_DEFINE(PFX, SNAME, rdlock, R, NAME, PARAMS, ARGS)
+
+#define CMC_GENERATE_SYNC_WRITE(PFX, SNAME, R, NAME, PARAMS, ARGS) \
+    static CMC_IMPL_SYNC_DEFINE(PFX, SNAME, wrlock, R, NAME, PARAMS, ARGS)
+
+#define CMC_GENERATE_SYNC(C, PFX, SNAME, K, V)    \
+    CMC_GENERATE_SYNC_HEADER(C, PFX, SNAME, K, V) \
+    CMC_GENERATE_SYNC_SOURCE(C, PFX, SNAME, K, V)
+
+#define CMC_GENERATE_SYNC_HEADER(C, PFX, SNAME, K, V) \
+    CMC_IMPL_SYNC_HEADER(PFX, SNAME, K, V)            \
+    CMC_IMPL_SYNC_METHODS(C)(CMC_IMPL_SYNC_DECLARE, PFX, SNAME, K, V)
+
+#define CMC_GENERATE_SYNC_SOURCE(C, PFX, SNAME, K, V) \
+    CMC_IMPL_SYNC_SOURCE(PFX, SNAME, K, V)            \
+    CMC_IMPL_SYNC_METHODS(C)(CMC_IMPL_SYNC_DEFINE, PFX, SNAME, K, V)
+
+#define CMC_IMPL_SYNC_METHODS_(C) CMC_IMPL_SYNC_METHODS_##C
+#define CMC_IMPL_SYNC_METHODS(C) CMC_IMPL_SYNC_METHODS_(C)
+
+/* Functions of each kind of collection, expanded with GEN as */
+/* CMC_IMPL_SYNC_DECLARE or CMC_IMPL_SYNC_DEFINE */
+#define CMC_IMPL_SYNC_NONE(GEN, PFX, SNAME, K, V)
+
+#define CMC_IMPL_SYNC_COUNTED(GEN, PFX, SNAME, K, V) \
+    GEN(PFX, SNAME, rdlock, size_t, count, (), ())   \
+    GEN(PFX, SNAME, rdlock, bool, empty, (), ())
+
+#define CMC_IMPL_SYNC_MAP(GEN, PFX, SNAME, K, V)                                       \
+    CMC_IMPL_SYNC_COUNTED(GEN, PFX, SNAME, K, V)                                       \
+    GEN(PFX, SNAME, rdlock, V, get, (, K key), (, key))                                \
+    GEN(PFX, SNAME, rdlock, bool, contains, (, K key), (, key))                        \
+    GEN(PFX, SNAME, wrlock, bool, insert, (, K key, V value), (, key, value))          \
+    GEN(PFX, SNAME, wrlock, bool, update, (, K key, V new_value, V *old_value),        \
+        (, key, new_value, old_value))                                                 \
+    GEN(PFX, SNAME, wrlock, bool, remove, (, K key, V *out_value), (, key, out_value)) \
+    GEN##_MAP_BATCH(PFX, SNAME, K, V)
+
+#define CMC_IMPL_SYNC_SET(GEN, PFX, SNAME, K, V)                        \
+    CMC_IMPL_SYNC_COUNTED(GEN, PFX, SNAME, K, V)                        \
+    GEN(PFX, SNAME, rdlock, bool, contains, (, V element), (, element)) \
+    GEN(PFX, SNAME, wrlock, bool, insert, (, V element), (, element))   \
+    GEN(PFX, SNAME, wrlock, bool, remove, (, V element), (, element))   \
+    GEN##_SET_BATCH(PFX, SNAME, K, V)
+
+#define CMC_IMPL_SYNC_HEAP(GEN, PFX, SNAME, K, V)                     \
+    CMC_IMPL_SYNC_COUNTED(GEN, PFX, SNAME, K, V)                      \
+    GEN(PFX, SNAME, rdlock, V, peek, (), ())                          \
+    GEN(PFX, SNAME, wrlock, bool, insert, (, V element), (, element)) \
+    GEN(PFX, SNAME, wrlock, bool, remove, (, V *value), (, value))
+
+#define CMC_IMPL_SYNC_SEQUENCE(GEN, PFX, SNAME, K, V)                     \
+    CMC_IMPL_SYNC_COUNTED(GEN, PFX, SNAME, K, V)                          \
+    GEN(PFX, SNAME, rdlock, V, get, (, size_t index), (, index))          \
+    GEN(PFX, SNAME, rdlock, V, front, (), ())                             \
+    GEN(PFX, SNAME, rdlock, V, back, (), ())                              \
+    GEN(PFX, SNAME, wrlock, bool, push_front, (, V element), (, element)) \
+    GEN(PFX, SNAME, wrlock, bool, push_back, (, V element), (, element))  \
+    GEN(PFX, SNAME, wrlock, bool, pop_front, (), ())                      \
+    GEN(PFX, SNAME, wrlock, bool, pop_back, (), ())
+
+#define CMC_IMPL_SYNC_QUEUE(GEN, PFX, SNAME, K, V)                     \
+    CMC_IMPL_SYNC_COUNTED(GEN, PFX, SNAME, K, V)                       \
+    GEN(PFX, SNAME, rdlock, V, peek, (), ())                           \
+    GEN(PFX, SNAME, wrlock, bool, enqueue, (, V element), (, element)) \
+    GEN(PFX, SNAME, wrlock, bool, dequeue, (), ())
+
+#define CMC_IMPL_SYNC_STACK(GEN, PFX, SNAME, K, V)                  \
+    CMC_IMPL_SYNC_COUNTED(GEN, PFX, SNAME, K, V)                    \
+    GEN(PFX, SNAME, rdlock, V, top, (), ())                         \
+    GEN(PFX, SNAME, wrlock, bool, push, (, V element), (, element)) \
+    GEN(PFX, SNAME, wrlock, bool, pop, (), ())
+
+#define CMC_IMPL_SYNC_SORTEDLIST(GEN, PFX, SNAME, K, V)                 \
+    CMC_IMPL_SYNC_COUNTED(GEN, PFX, SNAME, K, V)                        \
+    GEN(PFX, SNAME, rdlock, V, get, (, size_t index), (, index))        \
+    GEN(PFX, SNAME, rdlock, bool, contains, (, V element), (, element)) \
+    GEN(PFX, SNAME, wrlock, bool, insert, (, V element), (, element))   \
+    GEN(PFX, SNAME, wrlock, bool, remove, (, size_t index), (, index))
+
+#define CMC_IMPL_SYNC_METHODS_BIDIMAP CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_BIDIMAP_CACHED CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_BITSET CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_BLOCKDEQUE CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_BLOCKING_QUEUE CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_BLOOMFILTER CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_BTREEMAP CMC_IMPL_SYNC_MAP
+#define CMC_IMPL_SYNC_METHODS_BTREESET CMC_IMPL_SYNC_SET
+#define CMC_IMPL_SYNC_METHODS_BYTERING CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_COMPACT_TREESET CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_CONCURRENT_HASHMAP CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_CONCURRENT_STACK CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_COUNTMINSKETCH CMC_IMPL_SYNC_NONE
+#define CMC_IMPL_SYNC_METHODS_DEQUE CMC_IMPL_SYNC_SEQUENCE
+#define CMC_IMPL_SYNC_METHODS_FLATMAP CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_FROZEN_HASHMAP CMC_IMPL_SYNC_NONE
+#define CMC_IMPL_SYNC_METHODS_GAPLIST CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_GROUPED_MULTIMAP CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_HASHMAP CMC_IMPL_SYNC_MAP
+#define CMC_IMPL_SYNC_METHODS_HASHMAP_CACHED CMC_IMPL_SYNC_MAP
+#define CMC_IMPL_SYNC_METHODS_HASHMAP_INCREMENTAL CMC_IMPL_SYNC_MAP
+#define CMC_IMPL_SYNC_METHODS_HASHMAP_SMALL CMC_IMPL_SYNC_MAP
+#define CMC_IMPL_SYNC_METHODS_HASHMAP_SOA CMC_IMPL_SYNC_MAP
+#define CMC_IMPL_SYNC_METHODS_HASHSET CMC_IMPL_SYNC_SET
+#define CMC_IMPL_SYNC_METHODS_HASHSET_CACHED CMC_IMPL_SYNC_SET
+#define CMC_IMPL_SYNC_METHODS_HASHSET_SMALL CMC_IMPL_SYNC_SET
+#define CMC_IMPL_SYNC_METHODS_HEAP CMC_IMPL_SYNC_HEAP
+#define CMC_IMPL_SYNC_METHODS_HYPERLOGLOG CMC_IMPL_SYNC_NONE
+#define CMC_IMPL_SYNC_METHODS_INDEXEDHEAP CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_INTERVALHEAP CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_INTERVALTREE CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_INTRUSIVE_LIST CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_LINKEDLIST CMC_IMPL_SYNC_SEQUENCE
+#define CMC_IMPL_SYNC_METHODS_LIST CMC_IMPL_SYNC_SEQUENCE
+#define CMC_IMPL_SYNC_METHODS_LRUCACHE CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_MAPPED_HASHMAP CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_MAPPED_SORTEDMAP CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_MAPPED_SORTEDSET CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_MINMAXHEAP CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_MPMC_QUEUE CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_MULTIMAP CMC_IMPL_SYNC_MAP
+#define CMC_IMPL_SYNC_METHODS_MULTIMAP_CACHED CMC_IMPL_SYNC_MAP
+#define CMC_IMPL_SYNC_METHODS_MULTISET CMC_IMPL_SYNC_SET
+#define CMC_IMPL_SYNC_METHODS_MULTISET_CACHED CMC_IMPL_SYNC_SET
+#define CMC_IMPL_SYNC_METHODS_ORDEREDHASHMAP CMC_IMPL_SYNC_MAP
+#define CMC_IMPL_SYNC_METHODS_PERSISTENT_TREEMAP CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_QUEUE CMC_IMPL_SYNC_QUEUE
+#define CMC_IMPL_SYNC_METHODS_RADIXHEAP CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_RADIXTREEMAP CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_RINGBUFFER CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_ROARING CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_SKIPLISTMAP CMC_IMPL_SYNC_MAP
+#define CMC_IMPL_SYNC_METHODS_SMALLLIST CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_SNAPSHOT_HASHMAP CMC_IMPL_SYNC_NONE
+#define CMC_IMPL_SYNC_METHODS_SORTEDLIST CMC_IMPL_SYNC_SORTEDLIST
+#define CMC_IMPL_SYNC_METHODS_SORTEDWINDOW CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_SORTED_MULTIMAP CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_SPARSEMAP CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_SPARSESET CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_STACK CMC_IMPL_SYNC_STACK
+#define CMC_IMPL_SYNC_METHODS_SWISSMAP CMC_IMPL_SYNC_MAP
+#define CMC_IMPL_SYNC_METHODS_TIMERWHEEL CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_TOPK CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_TREEMAP CMC_IMPL_SYNC_MAP
+#define CMC_IMPL_SYNC_METHODS_TREESET CMC_IMPL_SYNC_SET
+#define CMC_IMPL_SYNC_METHODS_UNROLLEDLIST CMC_IMPL_SYNC_COUNTED
+#define CMC_IMPL_SYNC_METHODS_WSDEQUE CMC_IMPL_SYNC_COUNTED
+
+#define CMC_IMPL_SYNC_HEADER(PFX, SNAME, K, V)                                                 \
+                                                                                               \
+    /* Synchronized Wrapper */                                                                 \
+    struct SNAME##_sync                                                                        \
+    {                                                                                          \
+        /* Wrapped collection */                                                               \
+        struct SNAME *collection;                                                              \
+                                                                                               \
+        /* Taken shared by reads and exclusive by writes */                                    \
+        pthread_rwlock_t lock;                                                                 \
+                                                                                               \
+        /* Custom allocation functions */                                                      \
+        struct cmc_alloc_node *alloc;                                                          \
+    };                                                                                         \
+                                                                                               \
+    /* Collection Functions */                                                                 \
+    /* Collection Allocation and Deallocation */                                               \
+    struct SNAME##_sync *PFX##_sync_new(struct SNAME *collection);                             \
+    struct SNAME##_sync *PFX##_sync_new_custom(struct SNAME *collection,                       \
+                                               struct cmc_alloc_node *alloc);                  \
+    struct SNAME *PFX##_sync_free(struct SNAME##_sync *_sync_);                                \
+    /* Locked Access */                                                                        \
+    void PFX##_sync_read(struct SNAME##_sync *_sync_, void (*func)(struct SNAME *, void *),    \
+                         void *data);                                                          \
+    void PFX##_sync_write(struct SNAME##_sync *_sync_, void (*func)(struct SNAME *, void *),   \
+                          void *data);                                                         \
+    size_t PFX##_sync_lock_and_apply(struct SNAME##_sync *_sync_,                              \
+                                     bool (*func)(struct SNAME *, void *), void *items,        \
+                                     size_t size, size_t count);                               \
+    size_t PFX##_sync_lock_and_apply_shared(struct SNAME##_sync *_sync_,                       \
+                                            bool (*func)(struct SNAME *, void *), void *items, \
+                                            size_t size, size_t count);
+
+#define CMC_IMPL_SYNC_SOURCE(PFX, SNAME, K, V)                                                 \
+                                                                                               \
+    struct SNAME##_sync *PFX##_sync_new(struct SNAME *collection)                              \
+    {                                                                                          \
+        return PFX##_sync_new_custom(collection, NULL);                                        \
+    }                                                                                          \
+                                                                                               \
+    struct SNAME##_sync *PFX##_sync_new_custom(struct SNAME *collection,                       \
+                                               struct cmc_alloc_node *alloc)                   \
+    {                                                                                          \
+        if (!collection)                                                                       \
+            return NULL;                                                                       \
+                                                                                               \
+        if (!alloc)                                                                            \
+            alloc = &cmc_alloc_node_default;                                                   \
+                                                                                               \
+        struct SNAME##_sync *_sync_ = alloc->malloc(sizeof(struct SNAME##_sync));              \
+                                                                                               \
+        if (!_sync_)                                                                           \
+            return NULL;                                                                       \
+                                                                                               \
+        if (pthread_rwlock_init(&(_sync_->lock), NULL) != 0)                                   \
+        {                                                                                      \
+            alloc->free(_sync_);                                                               \
+            return NULL;                                                                       \
+        }                                                                                      \
+                                                                                               \
+        _sync_->collection = collection;                                                       \
+        _sync_->alloc = alloc;                                                                 \
+                                                                                               \
+        return _sync_;                                                                         \
+    }                                                                                          \
+                                                                                               \
+    struct SNAME *PFX##_sync_free(struct SNAME##_sync *_sync_)                                 \
+    {                                                                                          \
+        struct SNAME *collection = _sync_->collection;                                         \
+                                                                                               \
+        pthread_rwlock_destroy(&(_sync_->lock));                                               \
+                                                                                               \
+        _sync_->alloc->free(_sync_);                                                           \
+                                                                                               \
+        return collection;                                                                     \
+    }                                                                                          \
+                                                                                               \
+    void PFX##_sync_read(struct SNAME##_sync *_sync_, void (*func)(struct SNAME *, void *),    \
+                         void *data)                                                           \
+    {                                                                                          \
+        pthread_rwlock_rdlock(&(_sync_->lock));                                                \
+        func(_sync_->collection, data);                                                        \
+        pthread_rwlock_unlock(&(_sync_->lock));                                                \
+    }                                                                                          \
+                                                                                               \
+    void PFX##_sync_write(struct SNAME##_sync *_sync_, void (*func)(struct SNAME *, void *),   \
+                          void *data)                                                          \
+    {                                                                                          \
+        pthread_rwlock_wrlock(&(_sync_->lock));                                                \
+        func(_sync_->collection, data);                                                        \
+        pthread_rwlock_unlock(&(_sync_->lock));                                                \
+    }                                                                                          \
+                                                                                               \
+    size_t PFX##_sync_lock_and_apply(struct SNAME##_sync *_sync_,                              \
+                                     bool (*func)(struct SNAME *, void *), void *items,        \
+                                     size_t size, size_t count)                                \
+    {                                                                                          \
+        size_t applied = 0;                                                                    \
+                                                                                               \
+        pthread_rwlock_wrlock(&(_sync_->lock));                                                \
+                                                                                               \
+        for (size_t i = 0; i < count; i++)                                                     \
+            applied += func(_sync_->collection, (char *)items + i * size);                     \
+                                                                                               \
+        pthread_rwlock_unlock(&(_sync_->lock));                                                \
+                                                                                               \
+        return applied;                                                                        \
+    }                                                                                          \
+                                                                                               \
+    size_t PFX##_sync_lock_and_apply_shared(struct SNAME##_sync *_sync_,                       \
+                                            bool (*func)(struct SNAME *, void *), void *items, \
+                                            size_t size, size_t count)                         \
+    {                                                                                          \
+        size_t applied = 0;                                                                    \
+                                                                                               \
+        pthread_rwlock_rdlock(&(_sync_->lock));                                                \
+                                                                                               \
+        for (size_t i = 0; i < count; i++)                                                     \
+            applied += func(_sync_->collection, (char *)items + i * size);                     \
+                                                                                               \
+        pthread_rwlock_unlock(&(_sync_->lock));                                                \
+                                                                                               \
+        return applied;                                                                        \
+    }
+
+/* Batches of the maps and sets, returning how many keys were inserted or */
+/* found. get_all sets the values of keys that are not found to zero */
+#define CMC_IMPL_SYNC_DECLARE_MAP_BATCH(PFX, SNAME, K, V)                                        \
+    size_t PFX##_sync_insert_all(struct SNAME##_sync *_sync_, K *keys, V *values, size_t count); \
+    size_t PFX##_sync_get_all(struct SNAME##_sync *_sync_, K *keys, V *values, size_t count);
+
+#define CMC_IMPL_SYNC_DEFINE_MAP_BATCH(PFX, SNAME, K, V)                                        \
+    size_t PFX##_sync_insert_all(struct SNAME##_sync *_sync_, K *keys, V *values, size_t count) \
+    {                                                                                           \
+        size_t inserted = 0;                                                                    \
+                                                                                                \
+        pthread_rwlock_wrlock(&(_sync_->lock));                                                 \
+                                                                                                \
+        for (size_t i = 0; i < count; i++)                                                      \
+            inserted += PFX##_insert(_sync_->collection, keys[i], values[i]);                   \
+                                                                                                \
+        pthread_rwlock_unlock(&(_sync_->lock));                                                 \
+                                                                                                \
+        return inserted;                                                                        \
+    }                                                                                           \
+                                                                                                \
+    size_t PFX##_sync_get_all(struct SNAME##_sync *_sync_, K *keys, V *values, size_t count)    \
+    {                                                                                           \
+        size_t found = 0;                                                                       \
+                                                                                                \
+        pthread_rwlock_rdlock(&(_sync_->lock));                                                 \
+                                                                                                \
+        for (size_t i = 0; i < count; i++)                                                      \
+        {                                                                                       \
+            if (PFX##_contains(_sync_->collection, keys[i]))                                    \
+            {                                                                                   \
+                values[i] = PFX##_get(_sync_->collection, keys[i]);                             \
+                found++;                                                                        \
+            }                                                                                   \
+            else                                                                                \
+                values[i] = (V){ 0 };                                                           \
+        }                                                                                       \
+                                                                                                \
+        pthread_rwlock_unlock(&(_sync_->lock));                                                 \
+                                                                                                \
+        return found;                                                                           \
+    }
+
+#define CMC_IMPL_SYNC_DECLARE_SET_BATCH(PFX, SNAME, K, V)                                 \
+    size_t PFX##_sync_insert_all(struct SNAME##_sync *_sync_, V *elements, size_t count); \
+    size_t PFX##_sync_contains_all(struct SNAME##_sync *_sync_, V *elements, size_t count);
+
+#define CMC_IMPL_SYNC_DEFINE_SET_BATCH(PFX, SNAME, K, V)                                   \
+    size_t PFX##_sync_insert_all(struct SNAME##_sync *_sync_, V *elements, size_t count)   \
+    {                                                                                      \
+        size_t inserted = 0;                                                               \
+                                                                                           \
+        pthread_rwlock_wrlock(&(_sync_->lock));                                            \
+                                                                                           \
+        for (size_t i = 0; i < count; i++)                                                 \
+            inserted += PFX##_insert(_sync_->collection, elements[i]);                     \
+                                                                                           \
+        pthread_rwlock_unlock(&(_sync_->lock));                                            \
+                                                                                           \
+        return inserted;                                                                   \
+    }                                                                                      \
+                                                                                           \
+    size_t PFX##_sync_contains_all(struct SNAME##_sync *_sync_, V *elements, size_t count) \
+    {                                                                                      \
+        size_t found = 0;                                                                  \
+                                                                                           \
+        pthread_rwlock_rdlock(&(_sync_->lock));                                            \
+                                                                                           \
+        for (size_t i = 0; i < count; i++)                                                 \
+            found += PFX##_contains(_sync_->collection, elements[i]);                      \
+                                                                                           \
+        pthread_rwlock_unlock(&(_sync_->lock));                                            \
+                                                                                           \
+        return found;                                                                      \
+    }
+
+#endif /* CMC_SYNC_H */
@@ -10,40 +10,154 @@
 
 /* Simple timer macros utility */
 
+/* The timer measures wall clock time with a monotonic clock, in */
+/* nanoseconds, so it is not affected by changes to the system time and */
+/* also measures the time spent waiting for other threads. That is */
+/* clock_gettime(CLOCK_MONOTONIC) where it is available, */
+/* QueryPerformanceCounter on Windows, and otherwise timespec_get, from */
+/* C11, or clock, from C89, as the last resort. */
+
+/* cmc_timer_calc gives the time between cmc_timer_start and cmc_timer_stop */
+/* in nanoseconds, as elapsed, and in milliseconds, as result. */
+/* cmc_timer_lap stops the timer, calculates it and starts it again from */
+/* where it stopped, to time consecutive steps. cmc_timer_accumulate adds */
+/* the time of the last calc to total, to time a step that is run between */
+/* other things that should not be timed, starting from a timer that was */
+/* initialized to {0}. */
+
+/* With CMC_TIMER_CYCLES defined as 1 the timer also counts the cycles */
+/* between start and stop, as cycles, with the cycle counter of x86 */
+/* (rdtsc) or of ARMv8 (cntvct_el0). The x86 counter runs at a constant */
+/* rate on recent processors, not necessarily the one the core is running */
+/* at, and the ARMv8 one at the frequency of the system timer. Without a */
+/* cycle counter cycles is the same as elapsed. */
+
 #ifndef CMC_TIMER_H
 #define CMC_TIMER_H
 
+#include <stdint.h>
 #include <time.h>
 
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+#ifndef CMC_TIMER_CYCLES
+#define CMC_TIMER_CYCLES 0
+#endif
+
 struct cmc_timer
 {
-    clock_t start;
-    clock_t stop;
+    uint64_t start;
+    uint64_t stop;
+    /* Milliseconds between start and stop */
     double result;
+    /* Nanoseconds between start and stop */
+    uint64_t elapsed;
+    /* Sum of elapsed of every cmc_timer_accumulate */
+    uint64_t total;
+    uint64_t start_cycles;
+    uint64_t stop_cycles;
+    uint64_t cycles;
 };
 
-#define cmc_timer_start(timer)          \
-    do                                  \
-    {                                   \
-        struct cmc_timer *t = &(timer); \
-        t->start = clock();             \
-                                        \
+/* Nanoseconds since an arbitrary point in the past */
+static inline uint64_t cmc_timer_now(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER counter, frequency;
+
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+
+    uint64_t seconds = (uint64_t)counter.QuadPart / (uint64_t)frequency.QuadPart;
+    uint64_t rest = (uint64_t)counter.QuadPart % (uint64_t)frequency.QuadPart;
+
+    return seconds * UINT64_C(1000000000) +
+           rest * UINT64_C(1000000000) / (uint64_t)frequency.QuadPart;
+#elif defined(CLOCK_MONOTONIC)
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * UINT64_C(1000000000) + (uint64_t)now.tv_nsec;
+#elif defined(TIME_UTC)
+    struct timespec now;
+
+    timespec_get(&now, TIME_UTC);
+
+    return (uint64_t)now.tv_sec * UINT64_C(1000000000) + (uint64_t)now.tv_nsec;
+#else
+    return (uint64_t)((double)clock() * 1e9 / CLOCKS_PER_SEC);
+#endif
+}
+
+/* Value of the cycle counter of the processor */
+static inline uint64_t cmc_timer_cycles(void)
+{
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_ia32_rdtsc();
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+    uint64_t cycles;
+
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(cycles));
+
+    return cycles;
+#else
+    return cmc_timer_now();
+#endif
+}
+
+#define cmc_timer_start(timer)                         \
+    do                                                 \
+    {                                                  \
+        struct cmc_timer *cmc_t_ = &(timer);           \
+        if (CMC_TIMER_CYCLES)                          \
+            cmc_t_->start_cycles = cmc_timer_cycles(); \
+        cmc_t_->start = cmc_timer_now();               \
+                                                       \
+    } while (0)
+
+#define cmc_timer_stop(timer)                         \
+    do                                                \
+    {                                                 \
+        struct cmc_timer *cmc_t_ = &(timer);          \
+        cmc_t_->stop = cmc_timer_now();               \
+        if (CMC_TIMER_CYCLES)                         \
+            cmc_t_->stop_cycles = cmc_timer_cycles(); \
+                                                      \
+    } while (0)
+
+#define cmc_timer_calc(timer)                                            \
+    do                                                                   \
+    {                                                                    \
+        struct cmc_timer *cmc_t_ = &(timer);                             \
+        cmc_t_->elapsed = cmc_t_->stop - cmc_t_->start;                  \
+        cmc_t_->result = (double)cmc_t_->elapsed / 1e6;                  \
+        cmc_t_->cycles = cmc_t_->elapsed;                                \
+        if (CMC_TIMER_CYCLES)                                            \
+            cmc_t_->cycles = cmc_t_->stop_cycles - cmc_t_->start_cycles; \
+                                                                         \
     } while (0)
 
-#define cmc_timer_stop(timer)           \
-    do                                  \
-    {                                   \
-        struct cmc_timer *t = &(timer); \
-        t->stop = clock();              \
-                                        \
+#define cmc_timer_lap(timer)                            \
+    do                                                  \
+    {                                                   \
+        cmc_timer_stop(timer);                          \
+        cmc_timer_calc(timer);                          \
+        struct cmc_timer *cmc_t_ = &(timer);            \
+        cmc_t_->start = cmc_t_->stop;                   \
+        if (CMC_TIMER_CYCLES)                           \
+            cmc_t_->start_cycles = cmc_t_->stop_cycles; \
+                                                        \
     } while (0)
 
-#define cmc_timer_calc(timer)                                               \
-    do                                                                      \
-    {                                                                       \
-        struct cmc_timer *t = &(timer);                                     \
-        t->result = (double)(t->stop - t->start) * 1000.0 / CLOCKS_PER_SEC; \
-                                                                            \
+#define cmc_timer_accumulate(timer)          \
+    do                                       \
+    {                                        \
+        struct cmc_timer *cmc_t_ = &(timer); \
+        cmc_t_->total += cmc_t_->elapsed;    \
+                                             \
     } while (0)
 
 #endif /* CMC_TIMER_H */
@@ -307,6 +307,141 @@ int main(void)
 
     printf("\n\n");
 
+    memset(sums, 0, sizeof sums);
+
+    CMC_FAST_FOR_EACH(int, l, {
+        sums[0] += *value;
+    });
+
+    CMC_FAST_FOR_EACH(int, s, {
+        sums[1] += *value;
+    });
+
+    CMC_FAST_FOR_EACH(int, h, {
+        sums[2] += *value;
+    });
+
+    CMC_FAST_FOR_EACH_SPANS(d, int, d, {
+        sums[3] += *value;
+    });
+
+    CMC_FAST_FOR_EACH_SPANS(q, int, q, {
+        sums[4] += *value;
+    });
+
+    CMC_FAST_FOR_EACH_REV(int, l, {
+        if (l_get(l, index) == *value)
+            sums[5] += *value;
+    });
+
+    printf("-------------------- CMC_FAST_FOR_EACH --------------------\n");
+    if (sums[0] == 50005000)
+        printf("%12s PASSED\n", "LIST");
+    else
+        printf("%12s FAILED\n", "LIST");
+    if (sums[1] == 50005000)
+        printf("%12s PASSED\n", "STACK");
+    else
+        printf("%12s FAILED\n", "STACK");
+    if (sums[2] == 50005000)
+        printf("%12s PASSED\n", "HEAP");
+    else
+        printf("%12s FAILED\n", "HEAP");
+    if (sums[3] == 50005000)
+        printf("%12s PASSED\n", "DEQUE");
+    else
+        printf("%12s FAILED\n", "DEQUE");
+    if (sums[4] == 50005000)
+        printf("%12s PASSED\n", "QUEUE");
+    else
+        printf("%12s FAILED\n", "QUEUE");
+    if (sums[5] == 50005000)
+        printf("%12s PASSED\n", "LIST REV");
+    else
+        printf("%12s FAILED\n", "LIST REV");
+
+    printf("\n\n");
+
+    static bool seen[3][10001];
+
+    memset(sums, 0, sizeof sums);
+
+    CMC_PARALLEL_FOR_EACH(l, list, l, 4, {
+        seen[0][l_iter_value(&iter)] = true;
+    });
+
+    CMC_PARALLEL_FOR_EACH(hs, hset, hs, 4, {
+        seen[1][hs_iter_value(&iter)] = true;
+    });
+
+    CMC_PARALLEL_FOR_EACH(hm, hmap, hm, 4, {
+        if (hm_iter_key(&iter) == hm_iter_value(&iter))
+            seen[2][hm_iter_key(&iter)] = true;
+    });
+
+    for (int i = 1; i < 10001; i++)
+    {
+        for (int j = 0; j < 3; j++)
+            sums[j] += seen[j][i] ? i : 0;
+    }
+
+    printf("------------------ CMC_PARALLEL_FOR_EACH ------------------\n");
+    if (sums[0] == 50005000)
+        printf("%12s PASSED\n", "LIST");
+    else
+        printf("%12s FAILED\n", "LIST");
+    if (sums[1] == 50005000)
+        printf("%12s PASSED\n", "HASHSET");
+    else
+        printf("%12s FAILED\n", "HASHSET");
+    if (sums[2] == 50005000)
+        printf("%12s PASSED\n", "HASHMAP");
+    else
+        printf("%12s FAILED\n", "HASHMAP");
+
+    printf("\n\n");
+
+    memset(sums, 0, sizeof sums);
+
+    CMC_ZIP_FOR_EACH(l, list, l, d, deque, d, {
+        if (l_iter_value(&iter1) == d_iter_value(&iter2))
+            sums[0] += l_iter_value(&iter1);
+    });
+
+    CMC_ZIP3_FOR_EACH(l, list, l, d, deque, d, ll, linked, ll, {
+        if (l_iter_value(&iter1) == d_iter_value(&iter2) &&
+            l_iter_value(&iter1) == ll_iter_value(&iter3))
+            sums[1] += l_iter_value(&iter1);
+    });
+
+    CMC_FAST_ZIP_FOR_EACH(int, l, int, s, {
+        sums[2] += *value1 + *value2;
+    });
+
+    CMC_FAST_ZIP3_FOR_EACH(int, l, int, s, int, h, {
+        sums[3] += *value1 + *value2 + *value3;
+    });
+
+    printf("-------------------- CMC_ZIP_FOR_EACH ---------------------\n");
+    if (sums[0] == 50005000)
+        printf("%12s PASSED\n", "ZIP");
+    else
+        printf("%12s FAILED\n", "ZIP");
+    if (sums[1] == 50005000)
+        printf("%12s PASSED\n", "ZIP3");
+    else
+        printf("%12s FAILED\n", "ZIP3");
+    if (sums[2] == 2 * 50005000)
+        printf("%12s PASSED\n", "FAST ZIP");
+    else
+        printf("%12s FAILED\n", "FAST ZIP");
+    if (sums[3] == 3 * 50005000)
+        printf("%12s PASSED\n", "FAST ZIP3");
+    else
+        printf("%12s FAILED\n", "FAST ZIP3");
+
+    printf("\n\n");
+
     l_free(l, NULL);
     ll_free(ll, NULL);
     s_free(s, NULL);
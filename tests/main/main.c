@@ -1,20 +1,77 @@
 #include <utl/timer.h>
 
+#include "unt/arena.c"
 #include "unt/bidimap.c"
+#include "unt/bitset.c"
+#include "unt/bloomfilter.c"
+#include "unt/btreemap.c"
+#include "unt/btreeset.c"
+#include "unt/compacttreeset.c"
+#include "unt/concurrenthashmap.c"
+#include "unt/cuckooset.c"
+#include "unt/multiqueue.c"
 #include "unt/deque.c"
+#include "unt/dump.c"
+#include "unt/frozenhashmap.c"
+#include "unt/groupedmultimap.c"
+#include "unt/hash.c"
 #include "unt/hashmap.c"
 #include "unt/hashset.c"
 #include "unt/heap.c"
+#include "unt/hyperloglog.c"
+#include "unt/intern.c"
 #include "unt/intervalheap.c"
 #include "unt/linkedlist.c"
 #include "unt/list.c"
+#include "unt/log.c"
+#include "unt/lrucache.c"
+#include "unt/mappedhashmap.c"
+#include "unt/mappedsortedmap.c"
 #include "unt/multimap.c"
 #include "unt/multiset.c"
+#include "unt/orderedhashmap.c"
+#include "unt/pages.c"
+#include "unt/persistenttreemap.c"
+#include "unt/pool.c"
 #include "unt/queue.c"
+#include "unt/skiplistmap.c"
+#include "unt/snapshothashmap.c"
 #include "unt/sortedlist.c"
+#include "unt/sortedwindow.c"
+#include "unt/string.c"
+#include "unt/gaplist.c"
+#include "unt/blockdeque.c"
+#include "unt/mpmcqueue.c"
+#include "unt/spscqueue.c"
+#include "unt/wsdeque.c"
+#include "unt/blockingqueue.c"
+#include "unt/bytering.c"
+#include "unt/concurrentstack.c"
+#include "unt/unrolledlist.c"
+#include "unt/intrusivelist.c"
+#include "unt/indexedheap.c"
+#include "unt/radixheap.c"
+#include "unt/radixtreemap.c"
+#include "unt/ringbuffer.c"
+#include "unt/roaring.c"
+#include "unt/smalllist.c"
+#include "unt/sparseset.c"
+#include "unt/flatmap.c"
+#include "unt/topk.c"
+#include "unt/countminsketch.c"
+#include "unt/intervaltree.c"
+#include "unt/sortedmultimap.c"
+#include "unt/perf.c"
+#include "unt/timer.c"
+#include "unt/timerwheel.c"
+#include "unt/minmaxheap.c"
 #include "unt/stack.c"
+#include "unt/swissmap.c"
+#include "unt/replica.c"
+#include "unt/sync.c"
 #include "unt/treemap.c"
 #include "unt/treeset.c"
+#include "unt/memory.c"
 
 int main(void)
 {
@@ -23,21 +80,78 @@ int main(void)
     cmc_timer_start(timer);
     uintmax_t failed = 0;
 
+    failed += arena_test();
     failed += bidimap_test();
+    failed += bitset_test();
+    failed += bloomfilter_test();
+    failed += btreemap_test();
+    failed += btreeset_test();
+    failed += compacttreeset_test();
+    failed += concurrenthashmap_test();
+    failed += cuckooset_test();
+    failed += multiqueue_test();
     failed += deque_test();
+    failed += dump_test();
+    failed += frozenhashmap_test();
+    failed += groupedmultimap_test();
+    failed += hash_test();
     failed += hashmap_test();
     failed += hashset_test();
     failed += heap_test();
+    failed += hyperloglog_test();
+    failed += intern_test();
     failed += intervalheap_test();
     failed += linkedlist_test();
     failed += list_test();
+    failed += lrucache_test();
+    failed += mappedhashmap_test();
+    failed += mappedsortedmap_test();
     failed += multimap_test();
     failed += multiset_test();
+    failed += orderedhashmap_test();
+    failed += pages_test();
+    failed += persistenttreemap_test();
+    failed += pool_test();
     failed += queue_test();
+    failed += skiplistmap_test();
+    failed += snapshothashmap_test();
     failed += sortedlist_test();
+    failed += sortedwindow_test();
+    failed += string_test();
+    failed += gaplist_test();
+    failed += blockdeque_test();
+    failed += mpmcqueue_test();
+    failed += spscqueue_test();
+    failed += wsdeque_test();
+    failed += blockingqueue_test();
+    failed += bytering_test();
+    failed += concurrentstack_test();
+    failed += unrolledlist_test();
+    failed += intrusivelist_test();
+    failed += indexedheap_test();
+    failed += radixheap_test();
+    failed += radixtreemap_test();
+    failed += ringbuffer_test();
+    failed += roaring_test();
+    failed += smalllist_test();
+    failed += sparseset_test();
+    failed += flatmap_test();
+    failed += topk_test();
+    failed += countminsketch_test();
+    failed += intervaltree_test();
+    failed += sortedmultimap_test();
+    failed += perf_test();
+    failed += timer_test();
+    failed += timerwheel_test();
+    failed += minmaxheap_test();
     failed += stack_test();
+    failed += swissmap_test();
+    failed += replica_test();
+    failed += sync_test();
     failed += treemap_test();
     failed += treeset_test();
+    failed += memory_test();
+    failed += log_test();
 
     cmc_timer_stop(timer);
     cmc_timer_calc(timer);
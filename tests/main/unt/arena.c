@@ -0,0 +1,158 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <utl/arena.h>
+
+CMC_CREATE_UNIT(arena_test, true, {
+    CMC_CREATE_TEST(malloc[alignment], {
+        struct cmc_arena arena = { 0 };
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            unsigned char *block = cmc_arena_malloc(&arena, i % 37);
+
+            cmc_assert_not_equals(ptr, NULL, block);
+            cmc_assert_equals(size_t, 0, (uintptr_t)block % CMC_ARENA_ALIGN);
+
+            memset(block, 0xff, i % 37);
+        }
+
+        cmc_arena_release(&arena);
+
+        cmc_assert_equals(ptr, NULL, arena.first);
+    });
+
+    CMC_CREATE_TEST(malloc[larger than a chunk], {
+        struct cmc_arena arena = { 0 };
+
+        unsigned char *small = cmc_arena_malloc(&arena, 16);
+        unsigned char *large = cmc_arena_malloc(&arena, CMC_ARENA_CHUNK_SIZE * 2);
+
+        cmc_assert_not_equals(ptr, NULL, small);
+        cmc_assert_not_equals(ptr, NULL, large);
+
+        memset(large, 0xff, CMC_ARENA_CHUNK_SIZE * 2);
+
+        cmc_assert_equals(ptr, NULL, cmc_arena_malloc(&arena, SIZE_MAX));
+
+        cmc_arena_release(&arena);
+    });
+
+    CMC_CREATE_TEST(calloc, {
+        struct cmc_arena arena = { 0 };
+
+        unsigned char *block = cmc_arena_malloc(&arena, 64);
+
+        memset(block, 0xff, 64);
+
+        cmc_arena_reset(&arena);
+
+        /* Same memory as the block before, zeroed again */
+        unsigned char *zeroed = cmc_arena_calloc(&arena, 8, 8);
+
+        cmc_assert_equals(ptr, block, zeroed);
+
+        for (size_t i = 0; i < 64; i++)
+            cmc_assert_equals(uint8_t, 0, zeroed[i]);
+
+        cmc_assert_equals(ptr, NULL, cmc_arena_calloc(&arena, SIZE_MAX, 2));
+
+        cmc_arena_release(&arena);
+    });
+
+    CMC_CREATE_TEST(realloc, {
+        struct cmc_arena arena = { 0 };
+
+        size_t *first = cmc_arena_realloc(&arena, NULL, sizeof(size_t) * 4);
+
+        for (size_t i = 0; i < 4; i++)
+            first[i] = i;
+
+        /* The last block grows in place */
+        size_t *grown = cmc_arena_realloc(&arena, first, sizeof(size_t) * 64);
+
+        cmc_assert_equals(ptr, first, grown);
+
+        size_t *other = cmc_arena_malloc(&arena, sizeof(size_t));
+
+        /* Any other one is copied */
+        size_t *copied = cmc_arena_realloc(&arena, grown, sizeof(size_t) * 128);
+
+        cmc_assert_not_equals(ptr, grown, copied);
+        cmc_assert_not_equals(ptr, other, copied);
+
+        for (size_t i = 0; i < 4; i++)
+            cmc_assert_equals(size_t, i, copied[i]);
+
+        cmc_arena_release(&arena);
+    });
+
+    CMC_CREATE_TEST(free[last block], {
+        struct cmc_arena arena = { 0 };
+
+        void *a = cmc_arena_malloc(&arena, 10);
+        void *b = cmc_arena_malloc(&arena, 10);
+
+        /* Only the last block is given back */
+        cmc_arena_free(&arena, a);
+
+        cmc_assert_not_equals(ptr, a, cmc_arena_malloc(&arena, 10));
+
+        void *c = cmc_arena_malloc(&arena, 10);
+
+        cmc_arena_free(&arena, c);
+
+        cmc_assert_equals(ptr, c, cmc_arena_malloc(&arena, 10));
+
+        cmc_arena_free(&arena, NULL);
+
+        cmc_assert_not_equals(ptr, b, c);
+
+        cmc_arena_release(&arena);
+    });
+
+    CMC_CREATE_TEST(reset[chunks are reused], {
+        struct cmc_arena arena = { 0 };
+
+        void *first = cmc_arena_malloc(&arena, 100);
+
+        for (size_t i = 0; i < 10000; i++)
+            cmc_assert_not_equals(ptr, NULL, cmc_arena_malloc(&arena, 100));
+
+        struct cmc_arena_chunk *chunk = arena.first;
+        size_t chunks = 0;
+
+        for (; chunk; chunk = chunk->next)
+            chunks++;
+
+        cmc_assert_greater(size_t, 1, chunks);
+
+        cmc_arena_reset(&arena);
+
+        cmc_assert_equals(ptr, first, cmc_arena_malloc(&arena, 100));
+
+        for (size_t i = 0; i < 10000; i++)
+            cmc_assert_not_equals(ptr, NULL, cmc_arena_malloc(&arena, 100));
+
+        size_t after = 0;
+
+        for (chunk = arena.first; chunk; chunk = chunk->next)
+            after++;
+
+        cmc_assert_equals(size_t, chunks, after);
+
+        cmc_arena_release(&arena);
+    });
+
+    CMC_CREATE_TEST(node, {
+        void *block = test_arena_node.malloc(100);
+
+        cmc_assert_not_equals(ptr, NULL, block);
+        cmc_assert_not_equals(ptr, NULL, test_arena.first);
+
+        test_arena_node.free(block);
+        cmc_arena_release(&test_arena);
+    });
+});
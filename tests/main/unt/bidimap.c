@@ -6,6 +6,27 @@
 #include <cmc/bidimap.h>
 
 CMC_GENERATE_BIDIMAP(bm, bidimap, size_t, size_t)
+CMC_GENERATE_BIDIMAP_CACHED(bmc, bidimap_cached, size_t, size_t)
+
+CMC_GENERATE_BIDIMAP_INVERT(bm, bidimap, bm, bidimap)
+CMC_GENERATE_BIDIMAP_CACHED_INVERT(bmc, bidimap_cached, bmc, bidimap_cached)
+
+static size_t bm_deallocated = 0;
+
+static bool bm_odd_key(size_t key, size_t value)
+{
+    (void)value;
+
+    return key % 2 == 1;
+}
+
+static void bm_count_deallocator(size_t key, size_t value)
+{
+    (void)key;
+    (void)value;
+
+    bm_deallocated++;
+}
 
 CMC_CREATE_UNIT(bidimap_test, true, {
     CMC_CREATE_TEST(new, {
@@ -16,6 +37,23 @@ CMC_CREATE_UNIT(bidimap_test, true, {
         bm_free(map, NULL);
     });
 
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct bidimap *map = bm_new_custom(100, 0.6, cmp, hash, cmp, hash, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            bm_insert(map, i, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        bm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
     CMC_CREATE_TEST(clear[count], {
         struct bidimap *map = bm_new(100, 0.6, cmp, hash, cmp, hash);
 
@@ -43,9 +81,9 @@ CMC_CREATE_UNIT(bidimap_test, true, {
 
         for (size_t i = 0; i < bm_capacity(map); i++)
         {
-            if (map->key_buffer[i] && map->key_buffer[i] != CMC_ENTRY_DELETED)
+            if (map->key_buffer[i])
             {
-                sum += map->key_buffer[i]->key;
+                sum += map->entries[map->key_buffer[i] - 1].key;
             }
         }
 
@@ -114,4 +152,359 @@ CMC_CREATE_UNIT(bidimap_test, true, {
         bm_free(map1, NULL);
         bm_free(map2, NULL);
     });
+
+    CMC_CREATE_TEST(cached[buffer_growth], {
+        struct bidimap_cached *map = bmc_new(1, 0.7, cmp, counthash, cmp, counthash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 1; i <= 1000; i++)
+            cmc_assert(bmc_insert(map, i, i * 2));
+
+        cmc_assert_equals(size_t, 1000, bmc_count(map));
+
+        hash_calls = 0;
+
+        cmc_assert(bmc_resize(map, 10000));
+
+        cmc_assert_equals(size_t, 0, hash_calls);
+
+        for (size_t i = 1; i <= 1000; i++)
+        {
+            cmc_assert_equals(size_t, i * 2, bmc_get_val(map, i));
+            cmc_assert_equals(size_t, i, bmc_get_key(map, i * 2));
+        }
+
+        bmc_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(insert_many, {
+        struct bidimap *map = bm_new(1, 0.7, cmp, hash, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        size_t keys[1000];
+        size_t values[1000];
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            keys[i] = i;
+            values[i] = i % 500 + 1000;
+        }
+
+        /* Pairs with a value that is already mapped are skipped */
+        cmc_assert_equals(size_t, 500, bm_insert_many(map, keys, values, 1000));
+        cmc_assert_equals(size_t, 500, bm_count(map));
+
+        for (size_t i = 0; i < 500; i++)
+        {
+            cmc_assert_equals(size_t, i + 1000, bm_get_val(map, i));
+            cmc_assert_equals(size_t, i, bm_get_key(map, i + 1000));
+        }
+
+        bm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(stats, {
+        struct bidimap *map = bm_new(500, 0.6, cmp, hash0, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(bm_insert(map, i, i));
+
+        struct cmc_hashtable_stats stats;
+
+        bm_stats(map, &stats);
+
+        // Distances of both hashtables are reported, only keys collide
+        size_t entries = 0;
+
+        for (size_t i = 0; i < CMC_HASHTABLE_STATS_BUCKETS; i++)
+            entries += stats.histogram[i];
+
+        cmc_assert_equals(size_t, 100, stats.count);
+        cmc_assert_equals(size_t, 200, entries);
+        cmc_assert_equals(size_t, 99, stats.max_dist);
+        cmc_assert_lesser_equals(size_t, stats.bytes,
+                                 sizeof(uint32_t) * 2 * bm_capacity(map) +
+                                     sizeof(struct bidimap_entry) * 100);
+
+        bm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(remove_by_key, {
+        struct bidimap *map = bm_new(1, 0.7, cmp, hash, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(bm_insert(map, i, i + 1000));
+
+        size_t value;
+
+        /* Every removal moves the last pair to the place of the removed one */
+        for (size_t i = 0; i < 1000; i += 2)
+        {
+            cmc_assert(bm_remove_by_key(map, i, &value));
+            cmc_assert_equals(size_t, i + 1000, value);
+        }
+
+        cmc_assert(!bm_remove_by_key(map, 0, &value));
+        cmc_assert_equals(size_t, 500, bm_count(map));
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            cmc_assert_equals(bool, i % 2 == 1, bm_contains_key(map, i));
+            cmc_assert_equals(bool, i % 2 == 1, bm_contains_val(map, i + 1000));
+        }
+
+        for (size_t i = 1; i < 1000; i += 2)
+            cmc_assert_equals(size_t, i, bm_get_key(map, i + 1000));
+
+        bm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(remove_by_val, {
+        struct bidimap *map = bm_new(1, 0.7, cmp, hash, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(bm_insert(map, i, i + 1000));
+
+        size_t key;
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            cmc_assert(bm_remove_by_val(map, i + 1000, &key));
+            cmc_assert_equals(size_t, i, key);
+        }
+
+        cmc_assert(bm_empty(map));
+        cmc_assert(!bm_remove_by_val(map, 1000, &key));
+
+        /* Removed pairs can be mapped again */
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(bm_insert(map, i + 1000, i));
+
+        cmc_assert_equals(size_t, 1000, bm_count(map));
+
+        bm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(cached[remove_by_key], {
+        struct bidimap_cached *map = bmc_new(1, 0.7, cmp, counthash, cmp, counthash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(bmc_insert(map, i, i * 2));
+
+        hash_calls = 0;
+
+        /* Only the lookup of the key is hashed, the pair moved in its */
+        /* place is found through the stored hashes */
+        cmc_assert(bmc_remove_by_key(map, 0, NULL));
+
+        cmc_assert_equals(size_t, 1, hash_calls);
+        cmc_assert_equals(size_t, 99, bmc_get_key(map, 198));
+
+        bmc_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(new_from, {
+        size_t keys[1000];
+        size_t values[1000];
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            keys[i] = i;
+            values[i] = i * 3;
+        }
+
+        // Pairs with a key or a value already in the map are skipped
+        keys[10] = 5;
+        values[20] = 15;
+
+        struct bidimap *map = bm_new_from(keys, values, 1000, 0.6, cmp, hash, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+        cmc_assert_equals(size_t, 998, bm_count(map));
+
+        size_t capacity = map->capacity;
+
+        cmc_assert_greater_equals(size_t, 998, (size_t)(capacity * 0.6));
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            if (i == 10 || i == 20)
+                continue;
+
+            cmc_assert_equals(size_t, i * 3, bm_get_val(map, i));
+            cmc_assert_equals(size_t, i, bm_get_key(map, i * 3));
+        }
+
+        cmc_assert(!bm_contains_key(map, 20));
+        cmc_assert(!bm_contains_val(map, 30));
+
+        // No rehash was needed after the first sizing
+        cmc_assert(bm_insert(map, 2000, 2000));
+        cmc_assert_equals(size_t, capacity, map->capacity);
+
+        bm_free(map, NULL);
+
+        map = bm_new_from(NULL, NULL, 0, 0.6, cmp, hash, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+        cmc_assert(bm_empty(map));
+
+        bm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(invert, {
+        struct bidimap *map = bm_new(100, 0.6, cmp, hash, cmp, hash);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(bm_insert(map, i, i + 5000));
+
+        cmc_assert(bm_remove_by_key(map, 500, NULL));
+
+        size_t capacity = map->capacity;
+
+        struct bidimap *inverse = bm_invert(map);
+
+        cmc_assert_not_equals(ptr, NULL, inverse);
+        cmc_assert_equals(size_t, 999, bm_count(inverse));
+        cmc_assert_equals(size_t, capacity, inverse->capacity);
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            if (i == 500)
+                continue;
+
+            cmc_assert_equals(size_t, i, bm_get_val(inverse, i + 5000));
+            cmc_assert_equals(size_t, i + 5000, bm_get_key(inverse, i));
+        }
+
+        cmc_assert(!bm_contains_key(inverse, 5500));
+        cmc_assert(!bm_contains_key(inverse, 10));
+
+        // The inverse is a regular map
+        cmc_assert(bm_insert(inverse, 5500, 500));
+        cmc_assert(bm_remove_by_val(inverse, 0, NULL));
+        cmc_assert(!bm_contains_key(inverse, 5000));
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(bm_insert(inverse, i + 10000, i + 1000));
+
+        cmc_assert_equals(size_t, 1999, bm_count(inverse));
+
+        bm_free(inverse, NULL);
+    });
+
+    CMC_CREATE_TEST(cached[invert], {
+        count_alloc_reset();
+
+        struct bidimap_cached *map =
+            bmc_new_custom(100, 0.6, cmp, hash, cmp, hash, &count_alloc);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(bmc_insert(map, i, i * 7));
+
+        struct bidimap_cached *inverse = bmc_invert(map);
+
+        cmc_assert_not_equals(ptr, NULL, inverse);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert_equals(size_t, i, bmc_get_val(inverse, i * 7));
+
+        bmc_free(inverse, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(save restore, {
+        struct bidimap *map = bm_new(1, 0.7, cmp, hash, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 500; i++)
+            cmc_assert(bm_insert(map, i, i * 2));
+
+        FILE *file = tmpfile();
+
+        cmc_assert_not_equals(ptr, NULL, file);
+
+        cmc_assert(bm_save(map, file, NULL, NULL));
+        cmc_assert(bm_save(map, file, write_size, write_size));
+
+        rewind(file);
+
+        for (size_t k = 0; k < 2; k++)
+        {
+            struct bidimap *r =
+                bm_restore(file, cmp, hash, cmp, hash, read_size, read_size);
+
+            cmc_assert_not_equals(ptr, NULL, r);
+            cmc_assert_equals(size_t, 500, bm_count(r));
+
+            for (size_t i = 0; i < 500; i++)
+            {
+                cmc_assert_equals(size_t, i * 2, bm_get_val(r, i));
+                cmc_assert_equals(size_t, i, bm_get_key(r, i * 2));
+            }
+
+            cmc_assert(bm_insert(r, 1000, 1));
+            cmc_assert(bm_remove_by_key(r, 0, NULL));
+
+            bm_free(r, NULL);
+        }
+
+        fclose(file);
+        bm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(remove_if, {
+        struct bidimap *map = bm_new(100, 0.6, cmp, hash, cmp, hash);
+        struct bidimap_cached *cached = bmc_new(100, 0.6, cmp, hash0, cmp, hash0);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(bm_insert(map, i, i + 1000));
+
+        /* Every key and every value collide */
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(bmc_insert(cached, i, i + 1000));
+
+        bm_deallocated = 0;
+
+        cmc_assert_equals(size_t, 500, bm_remove_if(map, bm_odd_key, bm_count_deallocator));
+        cmc_assert_equals(size_t, 500, bm_deallocated);
+        cmc_assert_equals(size_t, 500, bm_count(map));
+        cmc_assert_equals(size_t, 0, bm_remove_if(map, bm_odd_key, NULL));
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            cmc_assert_equals(bool, i % 2 == 0, bm_contains_key(map, i));
+            cmc_assert_equals(bool, i % 2 == 0, bm_contains_val(map, i + 1000));
+        }
+
+        for (size_t i = 0; i < 1000; i += 2)
+            cmc_assert_equals(size_t, i, bm_get_key(map, i + 1000));
+
+        cmc_assert_equals(size_t, 50, bmc_remove_if(cached, bm_odd_key, NULL));
+        cmc_assert_equals(size_t, 50, bmc_count(cached));
+
+        for (size_t i = 0; i < 100; i++)
+        {
+            cmc_assert_equals(bool, i % 2 == 0, bmc_contains_key(cached, i));
+            cmc_assert_equals(bool, i % 2 == 0, bmc_contains_val(cached, i + 1000));
+        }
+
+        cmc_assert(bmc_insert(cached, 1, 1001));
+        cmc_assert_equals(size_t, 1001, bmc_get_val(cached, 1));
+
+        bm_free(map, NULL);
+        bmc_free(cached, NULL);
+    });
 });
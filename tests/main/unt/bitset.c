@@ -0,0 +1,322 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/bitset.h>
+
+CMC_GENERATE_BITSET(bs, bitset, size_t)
+
+/* Bits of a reference set kept as one bool per element */
+#define BITSET_UNIVERSE 5000
+
+static struct bitset *bitset_random(bool *reference, size_t seed, size_t modulo)
+{
+    struct bitset *set = bs_new(1);
+
+    for (size_t i = 0; i < BITSET_UNIVERSE; i++)
+    {
+        reference[i] = (i * 2654435761u + seed) % modulo == 0;
+
+        if (reference[i])
+            bs_insert(set, i);
+    }
+
+    return set;
+}
+
+static bool bitset_matches(struct bitset *set, bool *reference)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < BITSET_UNIVERSE; i++)
+    {
+        if (bs_contains(set, i) != reference[i])
+            return false;
+
+        count += reference[i];
+    }
+
+    return bs_count(set) == count && !bs_contains(set, BITSET_UNIVERSE * 2);
+}
+
+CMC_CREATE_UNIT(bitset_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct bitset *set = bs_new(1000);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+        cmc_assert(bs_empty(set));
+        cmc_assert_greater_equals(size_t, 1000, bs_capacity(set));
+        cmc_assert_equals(size_t, 0, bs_capacity(set) % (CMC_CACHE_LINE_SIZE * 8));
+        cmc_assert_equals(size_t, 0, (uintptr_t)set->words % CMC_CACHE_LINE_SIZE);
+
+        bs_free(set);
+
+        set = bs_new(0);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+        cmc_assert_greater(size_t, 0, bs_capacity(set));
+
+        bs_free(set);
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct bitset *set = bs_new_custom(64, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 0; i < 100000; i += 7)
+            bs_insert(set, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        bs_free(set);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(insert remove contains, {
+        struct bitset *set = bs_new(100);
+
+        cmc_assert(bs_insert(set, 0));
+        cmc_assert(bs_insert(set, 63));
+        cmc_assert(bs_insert(set, 64));
+        cmc_assert(!bs_insert(set, 63));
+        cmc_assert_equals(size_t, 3, bs_count(set));
+
+        // Grows to hold larger elements
+        cmc_assert(bs_insert(set, 100000));
+        cmc_assert_greater(size_t, 100000, bs_capacity(set));
+        cmc_assert(bs_contains(set, 100000));
+        cmc_assert(!bs_contains(set, 99999));
+        cmc_assert(!bs_contains(set, 10000000));
+        cmc_assert(bs_contains(set, 64));
+
+        // Elements that can never fit
+        cmc_assert(!bs_insert(set, SIZE_MAX));
+        cmc_assert(!bs_insert(set, SIZE_MAX - 64));
+
+        cmc_assert(bs_remove(set, 63));
+        cmc_assert(!bs_remove(set, 63));
+        cmc_assert(!bs_remove(set, 10000000));
+        cmc_assert(!bs_contains(set, 63));
+        cmc_assert_equals(size_t, 3, bs_count(set));
+
+        size_t elements[5];
+        bool found[5];
+
+        // 1, 2, 3 and again 1, plus 64 which was already there
+        for (size_t i = 0; i < 4; i++)
+            elements[i] = i % 3 + 1;
+
+        elements[4] = 64;
+
+        cmc_assert_equals(size_t, 3, bs_insert_many(set, elements, 5));
+        cmc_assert_equals(size_t, 5, bs_contains_many(set, elements, 5, found));
+        cmc_assert(found[0] && found[4]);
+
+        bs_clear(set);
+
+        cmc_assert(bs_empty(set));
+        cmc_assert(!bs_contains(set, 100000));
+
+        bs_free(set);
+    });
+
+    CMC_CREATE_TEST(min max, {
+        struct bitset *set = bs_new(1);
+        size_t value = 0;
+
+        cmc_assert(!bs_min(set, &value));
+        cmc_assert(!bs_max(set, &value));
+
+        bs_insert(set, 700);
+        bs_insert(set, 129);
+        bs_insert(set, 4000);
+
+        cmc_assert(bs_min(set, &value));
+        cmc_assert_equals(size_t, 129, value);
+        cmc_assert(bs_max(set, &value));
+        cmc_assert_equals(size_t, 4000, value);
+
+        bs_free(set);
+    });
+
+    CMC_CREATE_TEST(iteration, {
+        bool reference[BITSET_UNIVERSE];
+        struct bitset *set = bitset_random(reference, 3, 7);
+
+        size_t index = 0;
+        size_t last = 0;
+        bool sorted = true;
+        bool present = true;
+
+        struct bitset_iter iter;
+
+        for (bs_iter_init(&iter, set); !bs_iter_end(&iter); bs_iter_next(&iter))
+        {
+            size_t value = bs_iter_value(&iter);
+
+            sorted = sorted && (index == 0 || value > last);
+            present = present && reference[value];
+            last = value;
+            index++;
+        }
+
+        cmc_assert(sorted);
+        cmc_assert(present);
+        cmc_assert_equals(size_t, bs_count(set), index);
+
+        index = 0;
+
+        for (bs_iter_to_end(&iter); !bs_iter_start(&iter); bs_iter_prev(&iter))
+        {
+            size_t value = bs_iter_value(&iter);
+
+            sorted = sorted && (index == 0 || value < last);
+            last = value;
+            index++;
+        }
+
+        cmc_assert(sorted);
+        cmc_assert_equals(size_t, bs_count(set), index);
+
+        size_t array[BITSET_UNIVERSE];
+        size_t written = bs_to_array(set, array, BITSET_UNIVERSE);
+
+        cmc_assert_equals(size_t, bs_count(set), written);
+        cmc_assert_equals(size_t, 3, bs_to_array(set, array, 3));
+
+        bs_iter_to_start(&iter);
+
+        cmc_assert(bs_iter_go_to(&iter, 10));
+        cmc_assert_equals(size_t, array[10], bs_iter_value(&iter));
+        cmc_assert(bs_iter_go_to(&iter, 2));
+        cmc_assert_equals(size_t, array[2], bs_iter_value(&iter));
+
+        bs_free(set);
+    });
+
+    CMC_CREATE_TEST(set operations, {
+        bool a[BITSET_UNIVERSE];
+        bool b[BITSET_UNIVERSE];
+        bool expected[BITSET_UNIVERSE];
+
+        struct bitset *set1 = bitset_random(a, 1, 3);
+        struct bitset *set2 = bitset_random(b, 2, 5);
+
+        // Sets of different capacities
+        bs_resize(set2, BITSET_UNIVERSE * 4);
+
+        struct bitset *result = bs_union(set1, set2);
+
+        for (size_t i = 0; i < BITSET_UNIVERSE; i++)
+            expected[i] = a[i] || b[i];
+
+        cmc_assert(bitset_matches(result, expected));
+        bs_free(result);
+
+        result = bs_intersection(set1, set2);
+
+        for (size_t i = 0; i < BITSET_UNIVERSE; i++)
+            expected[i] = a[i] && b[i];
+
+        cmc_assert(bitset_matches(result, expected));
+        bs_free(result);
+
+        result = bs_difference(set2, set1);
+
+        for (size_t i = 0; i < BITSET_UNIVERSE; i++)
+            expected[i] = b[i] && !a[i];
+
+        cmc_assert(bitset_matches(result, expected));
+        bs_free(result);
+
+        result = bs_symmetric_difference(set1, set2);
+
+        for (size_t i = 0; i < BITSET_UNIVERSE; i++)
+            expected[i] = a[i] != b[i];
+
+        cmc_assert(bitset_matches(result, expected));
+        bs_free(result);
+
+        struct bitset *copy = bs_copy_of(set1);
+
+        cmc_assert(bs_union_into(copy, set2));
+
+        for (size_t i = 0; i < BITSET_UNIVERSE; i++)
+            expected[i] = a[i] || b[i];
+
+        cmc_assert(bitset_matches(copy, expected));
+
+        cmc_assert(bs_is_subset(set1, copy));
+        cmc_assert(bs_is_proper_subset(set2, copy));
+        cmc_assert(bs_is_superset(copy, set1));
+        cmc_assert(bs_is_proper_superset(copy, set2));
+        cmc_assert(!bs_is_subset(copy, set1));
+        cmc_assert(!bs_is_disjointset(set1, set2));
+
+        bs_subtract(copy, set1);
+
+        for (size_t i = 0; i < BITSET_UNIVERSE; i++)
+            expected[i] = b[i] && !a[i];
+
+        cmc_assert(bitset_matches(copy, expected));
+        cmc_assert(bs_is_disjointset(copy, set1));
+
+        bs_free(copy);
+        copy = bs_copy_of(set2);
+
+        cmc_assert(bs_intersect_with(copy, set1));
+
+        for (size_t i = 0; i < BITSET_UNIVERSE; i++)
+            expected[i] = a[i] && b[i];
+
+        cmc_assert(bitset_matches(copy, expected));
+
+        bs_free(copy);
+        bs_free(set1);
+        bs_free(set2);
+    });
+
+    CMC_CREATE_TEST(equals resize, {
+        struct bitset *set1 = bs_new(64);
+        struct bitset *set2 = bs_new(100000);
+
+        cmc_assert(bs_equals(set1, set2));
+
+        bs_insert(set1, 10);
+        bs_insert(set2, 10);
+
+        cmc_assert(bs_equals(set1, set2));
+        cmc_assert(bs_equals(set2, set1));
+
+        bs_insert(set2, 90000);
+
+        cmc_assert(!bs_equals(set1, set2));
+
+        bs_remove(set2, 90000);
+        bs_insert(set2, 11);
+        bs_insert(set1, 20000);
+
+        // Same count, each with an element the other does not have
+        cmc_assert(!bs_equals(set1, set2));
+        cmc_assert(!bs_equals(set2, set1));
+
+        cmc_assert(!bs_resize(set1, 100));
+        cmc_assert(bs_shrink_to_fit(set1));
+        cmc_assert_greater(size_t, 20000, bs_capacity(set1));
+        cmc_assert(bs_contains(set1, 20000));
+
+        bs_remove(set2, 11);
+
+        cmc_assert(bs_shrink_to_fit(set2));
+        cmc_assert_equals(size_t, CMC_CACHE_LINE_SIZE * 8, bs_capacity(set2));
+        cmc_assert_lesser(size_t, bs_memory_usage(set1), bs_memory_usage(set2));
+
+        bs_free(set1);
+        bs_free(set2);
+    });
+});
@@ -0,0 +1,202 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/blockdeque.h>
+#include <cmc/deque.h>
+
+CMC_GENERATE_BLOCKDEQUE(bd, blockdeque, size_t)
+CMC_GENERATE_DEQUE(bdr, blockdeque_reference, size_t)
+
+/* If both deques have the same elements in the same order */
+static bool blockdeque_same(struct blockdeque *deque, struct blockdeque_reference *reference)
+{
+    if (bd_count(deque) != bdr_count(reference))
+        return false;
+
+    struct blockdeque_reference_iter iter;
+
+    size_t i = 0;
+
+    for (bdr_iter_init(&iter, reference); !bdr_iter_end(&iter); bdr_iter_next(&iter), i++)
+    {
+        if (bd_get(deque, i) != bdr_iter_value(&iter))
+            return false;
+    }
+
+    return true;
+}
+
+CMC_CREATE_UNIT(blockdeque_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct blockdeque *d = bd_new(100);
+
+        cmc_assert_not_equals(ptr, NULL, d);
+        cmc_assert_not_equals(ptr, NULL, d->blocks);
+        cmc_assert(bd_empty(d));
+        cmc_assert_equals(size_t, 0, bd_front(d));
+        cmc_assert_equals(size_t, 0, bd_back(d));
+        cmc_assert(!bd_pop_front(d));
+        cmc_assert(!bd_pop_back(d));
+        cmc_assert_equals(ptr, NULL, bd_get_ref(d, 0));
+
+        bd_free(d, NULL);
+
+        cmc_assert_equals(ptr, NULL, bd_new(0));
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct blockdeque *d = bd_new_custom(100, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, d);
+
+        for (size_t i = 0; i < 1000; i++)
+            bd_push_back(d, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        bd_free(d, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(push and pop, {
+        struct blockdeque *d = bd_new(1);
+
+        cmc_assert_not_equals(ptr, NULL, d);
+
+        for (size_t i = 1; i <= 5000; i++)
+        {
+            cmc_assert(bd_push_back(d, i));
+            cmc_assert(bd_push_front(d, i + 10000));
+        }
+
+        cmc_assert_equals(size_t, 10000, bd_count(d));
+        cmc_assert_equals(size_t, 15000, bd_front(d));
+        cmc_assert_equals(size_t, 5000, bd_back(d));
+        cmc_assert_equals(size_t, 10001, bd_get(d, 4999));
+        cmc_assert_equals(size_t, 1, bd_get(d, 5000));
+        cmc_assert(bd_contains(d, 2500, cmp));
+        cmc_assert(!bd_contains(d, 7000, cmp));
+
+        for (size_t i = 0; i < 5000; i++)
+        {
+            cmc_assert(bd_pop_front(d));
+            cmc_assert_equals(size_t, i < 4999 ? 14999 - i : 1, bd_front(d));
+        }
+
+        for (size_t i = 5000; i > 0; i--)
+        {
+            cmc_assert_equals(size_t, i, bd_back(d));
+            cmc_assert(bd_pop_back(d));
+        }
+
+        cmc_assert(bd_empty(d));
+        cmc_assert(bd_push_back(d, 3));
+        cmc_assert_equals(size_t, 3, bd_front(d));
+
+        bd_free(d, NULL);
+    });
+
+    CMC_CREATE_TEST(random operations, {
+        struct blockdeque *d = bd_new(1);
+        struct blockdeque_reference *r = bdr_new(1);
+
+        cmc_assert_not_equals(ptr, NULL, d);
+        cmc_assert_not_equals(ptr, NULL, r);
+
+        size_t seed = 12345;
+
+        /* Long runs on each end make the map move its blocks both ways */
+        for (size_t i = 0; i < 100000; i++)
+        {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+
+            size_t roll = (seed >> 33) % 100;
+            bool to_front = (i / 3000) % 2 == 0;
+
+            if (roll < 55)
+            {
+                cmc_assert(to_front ? bd_push_front(d, i) : bd_push_back(d, i));
+                cmc_assert(to_front ? bdr_push_front(r, i) : bdr_push_back(r, i));
+            }
+            else if (roll < 80)
+            {
+                cmc_assert_equals(bool, !bdr_empty(r), bd_pop_front(d));
+                bdr_pop_front(r);
+            }
+            else
+            {
+                cmc_assert_equals(bool, !bdr_empty(r), bd_pop_back(d));
+                bdr_pop_back(r);
+            }
+
+            cmc_assert_equals(size_t, bdr_front(r), bd_front(d));
+            cmc_assert_equals(size_t, bdr_back(r), bd_back(d));
+        }
+
+        cmc_assert(blockdeque_same(d, r));
+        cmc_assert(bd_shrink_to_fit(d));
+        cmc_assert(blockdeque_same(d, r));
+        cmc_assert(bd_push_front(d, 1));
+        cmc_assert(bd_push_back(d, 2));
+        cmc_assert(bdr_push_front(r, 1));
+        cmc_assert(bdr_push_back(r, 2));
+        cmc_assert(blockdeque_same(d, r));
+
+        bd_free(d, NULL);
+        bdr_free(r, NULL);
+    });
+
+    CMC_CREATE_TEST(stable pointers, {
+        struct blockdeque *d = bd_new(1);
+
+        cmc_assert_not_equals(ptr, NULL, d);
+        cmc_assert(bd_push_back(d, 42));
+
+        size_t *first = bd_get_ref(d, 0);
+
+        for (size_t i = 0; i < 100000; i++)
+        {
+            cmc_assert(bd_push_back(d, i));
+            cmc_assert(bd_push_front(d, i));
+        }
+
+        cmc_assert_equals(ptr, first, bd_get_ref(d, 100000));
+        cmc_assert_equals(size_t, 42, *first);
+
+        bd_free(d, NULL);
+    });
+
+    CMC_CREATE_TEST(iter, {
+        struct blockdeque *d = bd_new(10);
+
+        cmc_assert_not_equals(ptr, NULL, d);
+
+        for (size_t i = 0; i < 3000; i++)
+            cmc_assert(bd_push_back(d, i));
+
+        struct blockdeque_iter iter;
+
+        size_t total = 0;
+
+        for (bd_iter_init(&iter, d); !bd_iter_end(&iter); bd_iter_next(&iter))
+        {
+            cmc_assert_equals(size_t, total, bd_iter_value(&iter));
+            cmc_assert_equals(size_t, total, bd_iter_index(&iter));
+            total++;
+        }
+
+        cmc_assert_equals(size_t, 3000, total);
+
+        bd_iter_to_end(&iter);
+
+        cmc_assert(bd_iter_go_to(&iter, 1500));
+        cmc_assert_equals(size_t, 1500, *bd_iter_rvalue(&iter));
+
+        bd_free(d, NULL);
+    });
+});
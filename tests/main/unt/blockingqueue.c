@@ -0,0 +1,252 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <pthread.h>
+
+#include <cmc/blockingqueue.h>
+
+CMC_GENERATE_BLOCKING_QUEUE(bq, blockingqueue, size_t)
+
+#define BQ_THREADS 3
+#define BQ_ELEMENTS 20000
+
+struct bq_worker
+{
+    struct blockingqueue *queue;
+    size_t first;
+    size_t sum;
+    size_t taken;
+    bool failed;
+};
+
+static void *bq_producer_run(void *arg)
+{
+    struct bq_worker *worker = arg;
+
+    for (size_t i = 0; i < BQ_ELEMENTS; i++)
+    {
+        /* Half of them with a timeout long enough to never expire */
+        bool put = i % 2 == 0 ? bq_put(worker->queue, worker->first + i)
+                              : bq_offer(worker->queue, worker->first + i, 10000000000);
+
+        if (!put)
+            worker->failed = true;
+    }
+
+    return NULL;
+}
+
+static void *bq_consumer_run(void *arg)
+{
+    struct bq_worker *worker = arg;
+
+    size_t value;
+
+    while (bq_take(worker->queue, &value))
+    {
+        worker->sum += value;
+        worker->taken++;
+    }
+
+    return NULL;
+}
+
+static void *bq_poller_run(void *arg)
+{
+    struct bq_worker *worker = arg;
+
+    size_t value;
+
+    if (bq_poll(worker->queue, &value, 10000000000))
+    {
+        worker->sum = value;
+        worker->taken = 1;
+    }
+
+    return NULL;
+}
+
+CMC_CREATE_UNIT(blockingqueue_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct blockingqueue *q = bq_new(10);
+
+        cmc_assert_not_equals(ptr, NULL, q);
+        cmc_assert_equals(size_t, 10, bq_capacity(q));
+        cmc_assert(bq_empty(q));
+        cmc_assert(!bq_full(q));
+        cmc_assert(!bq_closed(q));
+
+        bq_free(q, NULL);
+
+        cmc_assert_equals(ptr, NULL, bq_new(0));
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct blockingqueue *q = bq_new_custom(10, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, q);
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        bq_free(q, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(put take, {
+        struct blockingqueue *q = bq_new(100);
+
+        cmc_assert_not_equals(ptr, NULL, q);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(bq_put(q, i));
+
+        cmc_assert(bq_full(q));
+        cmc_assert(!bq_offer(q, 100, 0));
+        cmc_assert(!bq_offer(q, 100, 1000000));
+        cmc_assert_equals(size_t, 100, bq_count(q));
+
+        size_t value;
+
+        for (size_t i = 0; i < 50; i++)
+        {
+            cmc_assert(bq_take(q, &value));
+            cmc_assert_equals(size_t, i, value);
+        }
+
+        size_t elements[100];
+
+        cmc_assert_equals(size_t, 20, bq_drain_to(q, elements, 20));
+
+        for (size_t i = 0; i < 20; i++)
+            cmc_assert_equals(size_t, 50 + i, elements[i]);
+
+        cmc_assert_equals(size_t, 30, bq_drain_to(q, elements, 100));
+        cmc_assert_equals(size_t, 99, elements[29]);
+        cmc_assert_equals(size_t, 0, bq_drain_to(q, elements, 100));
+
+        cmc_assert(bq_empty(q));
+        cmc_assert(!bq_poll(q, &value, 0));
+        cmc_assert(!bq_poll(q, &value, 1000000));
+
+        cmc_assert(bq_offer(q, 7, 0));
+        cmc_assert(bq_poll(q, &value, 0));
+        cmc_assert_equals(size_t, 7, value);
+
+        bq_free(q, NULL);
+    });
+
+    CMC_CREATE_TEST(close, {
+        struct blockingqueue *q = bq_new(10);
+
+        cmc_assert_not_equals(ptr, NULL, q);
+
+        for (size_t i = 0; i < 5; i++)
+            cmc_assert(bq_put(q, i));
+
+        bq_close(q);
+
+        cmc_assert(bq_closed(q));
+        cmc_assert(!bq_put(q, 5));
+        cmc_assert(!bq_offer(q, 5, 1000000));
+
+        /* The elements put before closing are kept */
+        size_t value;
+
+        for (size_t i = 0; i < 5; i++)
+        {
+            cmc_assert(bq_take(q, &value));
+            cmc_assert_equals(size_t, i, value);
+        }
+
+        cmc_assert(!bq_take(q, &value));
+        cmc_assert(!bq_poll(q, &value, 1000000));
+
+        bq_free(q, NULL);
+    });
+
+    CMC_CREATE_TEST(poll wakes up, {
+        struct blockingqueue *q = bq_new(1);
+
+        cmc_assert_not_equals(ptr, NULL, q);
+
+        struct bq_worker poller = { 0 };
+        poller.queue = q;
+
+        pthread_t thread;
+
+        cmc_assert_equals(int32_t, 0, pthread_create(&thread, NULL, bq_poller_run, &poller));
+
+        cmc_assert(bq_put(q, 42));
+
+        pthread_join(thread, NULL);
+
+        cmc_assert_equals(size_t, 1, poller.taken);
+        cmc_assert_equals(size_t, 42, poller.sum);
+
+        bq_free(q, NULL);
+    });
+
+    CMC_CREATE_TEST(threads, {
+        struct blockingqueue *q = bq_new(4);
+
+        cmc_assert_not_equals(ptr, NULL, q);
+
+        pthread_t producers[BQ_THREADS];
+        pthread_t consumers[BQ_THREADS];
+        struct bq_worker workers[2 * BQ_THREADS];
+
+        for (size_t i = 0; i < 2 * BQ_THREADS; i++)
+        {
+            workers[i].queue = q;
+            workers[i].first = (i % BQ_THREADS) * BQ_ELEMENTS;
+            workers[i].sum = 0;
+            workers[i].taken = 0;
+            workers[i].failed = false;
+        }
+
+        for (size_t i = 0; i < BQ_THREADS; i++)
+        {
+            int result = pthread_create(&consumers[i], NULL, bq_consumer_run, &workers[i]);
+
+            cmc_assert_equals(int32_t, 0, result);
+
+            result = pthread_create(&producers[i], NULL, bq_producer_run,
+                                    &workers[BQ_THREADS + i]);
+
+            cmc_assert_equals(int32_t, 0, result);
+        }
+
+        for (size_t i = 0; i < BQ_THREADS; i++)
+        {
+            pthread_join(producers[i], NULL);
+
+            cmc_assert(!workers[BQ_THREADS + i].failed);
+        }
+
+        /* Consumers finish once the queue is closed and empty */
+        bq_close(q);
+
+        size_t sum = 0;
+        size_t taken = 0;
+
+        for (size_t i = 0; i < BQ_THREADS; i++)
+        {
+            pthread_join(consumers[i], NULL);
+
+            sum += workers[i].sum;
+            taken += workers[i].taken;
+        }
+
+        size_t total = (size_t)BQ_THREADS * BQ_ELEMENTS;
+
+        cmc_assert_equals(size_t, total, taken);
+        cmc_assert_equals(size_t, total * (total - 1) / 2, sum);
+        cmc_assert(bq_empty(q));
+
+        bq_free(q, NULL);
+    });
+});
@@ -0,0 +1,143 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/bloomfilter.h>
+
+CMC_GENERATE_BLOOMFILTER(bf, bloomfilter, size_t)
+
+CMC_CREATE_UNIT(bloomfilter_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct bloomfilter *filter = bf_new(10000, 0.01, hash);
+
+        cmc_assert_not_equals(ptr, NULL, filter);
+        cmc_assert_equals(size_t, 0, bf_count(filter));
+        cmc_assert(bf_empty(filter));
+
+        // About 9.6 bits and 7 probes per element, plus the block overhead
+        cmc_assert_equals(size_t, 7, bf_probes(filter));
+        cmc_assert_greater_equals(size_t, 95850, bf_bits(filter));
+        cmc_assert_lesser_equals(size_t, 95850 * 12 / 10, bf_bits(filter));
+        cmc_assert_equals(size_t, 0, (uintptr_t)filter->blocks % CMC_CACHE_LINE_SIZE);
+
+        bf_free(filter);
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct bloomfilter *filter = bf_new_custom(16, 4, hash, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, filter);
+
+        for (size_t i = 0; i < 1000; i++)
+            bf_insert(filter, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        bf_free(filter);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(new[edge cases], {
+        cmc_assert_equals(ptr, NULL, bf_new(0, 0.01, hash));
+        cmc_assert_equals(ptr, NULL, bf_new(100, 0, hash));
+        cmc_assert_equals(ptr, NULL, bf_new(100, 1, hash));
+        cmc_assert_equals(ptr, NULL, bf_new_custom(0, 4, hash, NULL));
+    });
+
+    CMC_CREATE_TEST(insert contains, {
+        struct bloomfilter *filter = bf_new(10000, 0.01, hash);
+
+        cmc_assert_not_equals(ptr, NULL, filter);
+
+        for (size_t i = 0; i < 10000; i++)
+            bf_insert(filter, i);
+
+        // No false negatives
+        for (size_t i = 0; i < 10000; i++)
+            cmc_assert(bf_contains(filter, i));
+
+        cmc_assert(!bf_insert(filter, 10));
+
+        size_t false_positives = 0;
+
+        for (size_t i = 10000; i < 110000; i++)
+        {
+            if (bf_contains(filter, i))
+                false_positives++;
+        }
+
+        // Close to the 1% it was created for
+        cmc_assert_lesser_equals(size_t, 1500, false_positives);
+        cmc_assert_lesser_equals(double, 0.015, bf_fpr(filter));
+
+        bf_clear(filter);
+
+        cmc_assert(bf_empty(filter));
+        cmc_assert_equals(double, 0.0, bf_fill(filter));
+        cmc_assert(!bf_contains(filter, 10));
+
+        bf_free(filter);
+    });
+
+    CMC_CREATE_TEST(insert[weak hash], {
+        struct bloomfilter *filter = bf_new(1000, 0.01, numhash);
+
+        cmc_assert_not_equals(ptr, NULL, filter);
+
+        // The identity is mixed before it selects any bit
+        for (size_t i = 0; i < 1000; i++)
+            bf_insert(filter, i << 20);
+
+        size_t false_positives = 0;
+
+        for (size_t i = 1000; i < 11000; i++)
+        {
+            if (bf_contains(filter, i << 20))
+                false_positives++;
+        }
+
+        cmc_assert_lesser_equals(size_t, 150, false_positives);
+
+        bf_free(filter);
+    });
+
+    CMC_CREATE_TEST(union, {
+        struct bloomfilter *filter1 = bf_new(1000, 0.01, hash);
+        struct bloomfilter *filter2 = bf_new(1000, 0.01, hash);
+        struct bloomfilter *other = bf_new(10, 0.01, hash);
+
+        cmc_assert_not_equals(ptr, NULL, filter1);
+        cmc_assert_not_equals(ptr, NULL, filter2);
+        cmc_assert_not_equals(ptr, NULL, other);
+
+        for (size_t i = 0; i < 500; i++)
+        {
+            bf_insert(filter1, i);
+            bf_insert(filter2, i + 500);
+        }
+
+        cmc_assert_equals(ptr, NULL, bf_union(filter1, other));
+        cmc_assert(!bf_union_into(filter1, other));
+
+        struct bloomfilter *result = bf_union(filter1, filter2);
+
+        cmc_assert_not_equals(ptr, NULL, result);
+        cmc_assert(!bf_equals(result, filter1));
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(bf_contains(result, i));
+
+        cmc_assert(bf_union_into(filter1, filter2));
+        cmc_assert(bf_equals(result, filter1));
+        cmc_assert_equals(size_t, 1000, bf_count(filter1));
+
+        bf_free(result);
+        bf_free(other);
+        bf_free(filter2);
+        bf_free(filter1);
+    });
+});
@@ -0,0 +1,212 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/btreemap.h>
+
+CMC_GENERATE_BTREEMAP(btm, btreemap, size_t, size_t)
+
+CMC_CREATE_UNIT(btreemap_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct btreemap *map = btm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+        cmc_assert_equals(ptr, NULL, map->root);
+        cmc_assert(btm_empty(map));
+
+        btm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct btreemap *map = btm_new_custom(cmp, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            btm_insert(map, i, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        btm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(clear[count], {
+        struct btreemap *map = btm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 5000; i++)
+            btm_insert(map, i, i);
+
+        cmc_assert_equals(size_t, 5000, btm_count(map));
+
+        btm_clear(map, NULL);
+
+        cmc_assert_equals(size_t, 0, btm_count(map));
+        cmc_assert_equals(size_t, 0, map->height);
+        cmc_assert_equals(ptr, NULL, map->root);
+
+        btm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(insert[sorted], {
+        struct btreemap *map = btm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 10000; i++)
+            cmc_assert(btm_insert(map, i, i * 2));
+
+        cmc_assert(!btm_insert(map, 500, 0));
+        cmc_assert_equals(size_t, 10000, btm_count(map));
+
+        for (size_t i = 0; i < 10000; i++)
+            cmc_assert_equals(size_t, i * 2, btm_get(map, i));
+
+        /* Every leaf but the last one is full */
+        struct btreemap_leaf *leaf = map->root;
+
+        for (size_t h = map->height; h > 0; h--)
+            leaf = ((struct btreemap_branch *)leaf)->children[0];
+
+        for (; leaf->next; leaf = leaf->next)
+            cmc_assert_equals(size_t, CMC_BTREE_LEAF_SIZE, leaf->count);
+
+        btm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(get_or_insert[counter], {
+        struct btreemap *map = btm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            size_t *counter = btm_get_or_insert(map, (i * 37) % 100, 0);
+
+            cmc_assert_not_equals(ptr, NULL, counter);
+
+            *counter += 1;
+        }
+
+        cmc_assert_equals(size_t, 100, btm_count(map));
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert_equals(size_t, 10, btm_get(map, i));
+
+        cmc_assert(btm_upsert(map, 0, 50));
+        cmc_assert(btm_upsert(map, 200, 60));
+        cmc_assert_equals(size_t, 50, btm_get(map, 0));
+        cmc_assert_equals(size_t, 60, btm_get(map, 200));
+        cmc_assert_equals(size_t, 101, btm_count(map));
+
+        btm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(remove, {
+        struct btreemap *map = btm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 10000; i++)
+            cmc_assert(btm_insert(map, (i * 7919) % 10000, i));
+
+        /* The odd keys first, then the rest from the middle outwards */
+        for (size_t i = 1; i < 10000; i += 2)
+            cmc_assert(btm_remove(map, i, NULL));
+
+        cmc_assert(!btm_remove(map, 1, NULL));
+        cmc_assert_equals(size_t, 5000, btm_count(map));
+
+        for (size_t i = 0; i < 10000; i += 2)
+            cmc_assert(btm_contains(map, i));
+
+        size_t key;
+        size_t value;
+
+        cmc_assert(btm_min(map, &key, &value));
+        cmc_assert_equals(size_t, 0, key);
+        cmc_assert(btm_max(map, &key, &value));
+        cmc_assert_equals(size_t, 9998, key);
+
+        for (size_t i = 0; i < 2500; i++)
+        {
+            cmc_assert(btm_remove(map, 5000 + i * 2, &value));
+            cmc_assert(btm_remove(map, 4998 - i * 2, &value));
+        }
+
+        cmc_assert(btm_empty(map));
+        cmc_assert_equals(ptr, NULL, map->root);
+        cmc_assert(!btm_min(map, &key, &value));
+
+        btm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(iter, {
+        struct btreemap *map = btm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 1000; i > 0; i--)
+            cmc_assert(btm_insert(map, i, i));
+
+        struct btreemap_iter iter;
+        btm_iter_init(&iter, map);
+
+        size_t sum = 0;
+
+        for (btm_iter_to_start(&iter); !btm_iter_end(&iter); btm_iter_next(&iter))
+        {
+            cmc_assert_equals(size_t, btm_iter_index(&iter) + 1, btm_iter_key(&iter));
+            sum += btm_iter_value(&iter);
+        }
+
+        cmc_assert_equals(size_t, 500500, sum);
+
+        cmc_assert(btm_iter_go_to(&iter, 10));
+        cmc_assert_equals(size_t, 11, btm_iter_key(&iter));
+        cmc_assert(btm_iter_advance(&iter, 900));
+        cmc_assert_equals(size_t, 911, btm_iter_key(&iter));
+        cmc_assert(!btm_iter_advance(&iter, 100));
+        cmc_assert(btm_iter_rewind(&iter, 910));
+        cmc_assert_equals(size_t, 1, btm_iter_key(&iter));
+
+        *btm_iter_rvalue(&iter) = 0;
+
+        cmc_assert_equals(size_t, 0, btm_get(map, 1));
+
+        btm_iter_to_end(&iter);
+
+        cmc_assert_equals(size_t, 1000, btm_iter_key(&iter));
+        cmc_assert(btm_iter_prev(&iter));
+        cmc_assert_equals(size_t, 999, btm_iter_key(&iter));
+
+        btm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(copy_of[equals], {
+        struct btreemap *map = btm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(btm_insert(map, i * 3, i));
+
+        struct btreemap *copy = btm_copy_of(map, NULL, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, copy);
+        cmc_assert(btm_equals(map, copy, cmp));
+
+        cmc_assert(btm_update(copy, 3, 10, NULL));
+        cmc_assert(btm_equals(map, copy, NULL));
+        cmc_assert(!btm_equals(map, copy, cmp));
+
+        btm_free(map, NULL);
+        btm_free(copy, NULL);
+    });
+});
@@ -0,0 +1,165 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/btreeset.h>
+
+CMC_GENERATE_BTREESET(bts, btreeset, size_t)
+
+CMC_CREATE_UNIT(btreeset_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct btreeset *set = bts_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+        cmc_assert(bts_empty(set));
+
+        bts_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct btreeset *set = bts_new_custom(cmp, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 0; i < 1000; i++)
+            bts_insert(set, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        bts_free(set, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(clear[count], {
+        struct btreeset *set = bts_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 0; i < 5000; i++)
+            bts_insert(set, i);
+
+        cmc_assert_equals(size_t, 5000, bts_count(set));
+
+        bts_clear(set, NULL);
+
+        cmc_assert_equals(size_t, 0, bts_count(set));
+        cmc_assert_equals(ptr, NULL, set->root);
+
+        bts_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(remove, {
+        struct btreeset *set = bts_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 0; i < 5000; i++)
+            cmc_assert(bts_insert(set, (i * 7919) % 5000));
+
+        cmc_assert(!bts_insert(set, 10));
+
+        for (size_t i = 0; i < 5000; i += 3)
+            cmc_assert(bts_remove(set, i));
+
+        cmc_assert(!bts_remove(set, 0));
+
+        for (size_t i = 0; i < 5000; i++)
+            cmc_assert_equals(bool, i % 3 != 0, bts_contains(set, i));
+
+        size_t value;
+
+        cmc_assert(bts_min(set, &value));
+        cmc_assert_equals(size_t, 1, value);
+        cmc_assert(bts_max(set, &value));
+        cmc_assert_equals(size_t, 4999, value);
+
+        for (size_t i = 0; i < 5000; i++)
+            bts_remove(set, i);
+
+        cmc_assert(bts_empty(set));
+        cmc_assert_equals(ptr, NULL, set->root);
+
+        bts_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(set operations, {
+        struct btreeset *set1 = bts_new(cmp);
+        struct btreeset *set2 = bts_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, set1);
+        cmc_assert_not_equals(ptr, NULL, set2);
+
+        /* Multiples of 2 and multiples of 3 */
+        for (size_t i = 0; i < 600; i++)
+        {
+            bts_insert(set1, i * 2);
+            bts_insert(set2, i * 3);
+        }
+
+        struct btreeset *set_u = bts_union(set1, set2);
+        struct btreeset *set_i = bts_intersection(set1, set2);
+        struct btreeset *set_d = bts_difference(set1, set2);
+        struct btreeset *set_s = bts_symmetric_difference(set1, set2);
+
+        cmc_assert_equals(size_t, 1000, bts_count(set_u));
+        cmc_assert_equals(size_t, 200, bts_count(set_i));
+        cmc_assert_equals(size_t, 400, bts_count(set_d));
+        cmc_assert_equals(size_t, 800, bts_count(set_s));
+
+        cmc_assert(bts_contains(set_i, 6));
+        cmc_assert(!bts_contains(set_d, 6));
+        cmc_assert(bts_contains(set_d, 4));
+        cmc_assert(bts_contains(set_s, 1797));
+
+        cmc_assert(bts_is_subset(set_i, set1));
+        cmc_assert(bts_is_proper_subset(set_i, set2));
+        cmc_assert(bts_is_superset(set_u, set2));
+        cmc_assert(!bts_is_subset(set1, set2));
+        cmc_assert(!bts_is_proper_superset(set_u, set_u));
+        cmc_assert(bts_is_disjointset(set_d, set2));
+        cmc_assert(!bts_is_disjointset(set1, set2));
+
+        bts_free(set1, NULL);
+        bts_free(set2, NULL);
+        bts_free(set_u, NULL);
+        bts_free(set_i, NULL);
+        bts_free(set_d, NULL);
+        bts_free(set_s, NULL);
+    });
+
+    CMC_CREATE_TEST(iter, {
+        struct btreeset *set = bts_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 1000; i > 0; i--)
+            cmc_assert(bts_insert(set, i));
+
+        struct btreeset_iter iter;
+        bts_iter_init(&iter, set);
+
+        for (bts_iter_to_start(&iter); !bts_iter_end(&iter); bts_iter_next(&iter))
+            cmc_assert_equals(size_t, bts_iter_index(&iter) + 1, bts_iter_value(&iter));
+
+        cmc_assert(bts_iter_go_to(&iter, 500));
+        cmc_assert_equals(size_t, 501, bts_iter_value(&iter));
+        cmc_assert(bts_iter_rewind(&iter, 450));
+        cmc_assert_equals(size_t, 51, bts_iter_value(&iter));
+
+        bts_iter_to_end(&iter);
+
+        cmc_assert_equals(size_t, 1000, bts_iter_value(&iter));
+
+        struct btreeset *copy = bts_copy_of(set, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, copy);
+        cmc_assert(bts_equals(set, copy));
+
+        bts_free(set, NULL);
+        bts_free(copy, NULL);
+    });
+});
@@ -0,0 +1,169 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <unistd.h>
+
+#include <cmc/bytering.h>
+
+CMC_GENERATE_BYTERING(br, bytering)
+
+CMC_CREATE_UNIT(bytering_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct bytering *r = br_new(16);
+
+        cmc_assert_not_equals(ptr, NULL, r);
+        cmc_assert_equals(size_t, 16, br_capacity(r));
+        cmc_assert_equals(size_t, 16, br_vacant(r));
+        cmc_assert(br_empty(r));
+
+        br_free(r);
+
+        cmc_assert_equals(ptr, NULL, br_new(0));
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct bytering *r = br_new_custom(16, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, r);
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        br_free(r);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(write read, {
+        struct bytering *r = br_new(10);
+
+        cmc_assert_not_equals(ptr, NULL, r);
+
+        unsigned char out[16];
+
+        cmc_assert_equals(size_t, 6, br_write(r, "abcdef", 6));
+        cmc_assert_equals(size_t, 4, br_read(r, out, 4));
+        cmc_assert(memcmp(out, "abcd", 4) == 0);
+
+        /* Wraps around the end of the buffer and only what fits is copied */
+        cmc_assert_equals(size_t, 8, br_write(r, "ghijklmnop", 10));
+        cmc_assert(br_full(r));
+        cmc_assert_equals(size_t, 0, br_write(r, "q", 1));
+
+        unsigned char *a;
+        unsigned char *b;
+        size_t a_size;
+        size_t b_size;
+
+        br_spans(r, &a, &a_size, &b, &b_size);
+
+        cmc_assert_equals(size_t, 6, a_size);
+        cmc_assert_equals(size_t, 4, b_size);
+        cmc_assert(memcmp(a, "efghij", 6) == 0);
+        cmc_assert(memcmp(b, "klmn", 4) == 0);
+
+        cmc_assert_equals(size_t, 3, br_index_of(r, 'h'));
+        cmc_assert_equals(size_t, 7, br_index_of(r, 'l'));
+        cmc_assert_equals(size_t, 10, br_index_of(r, 'z'));
+
+        cmc_assert_equals(size_t, 10, br_peek(r, out, 16));
+        cmc_assert(memcmp(out, "efghijklmn", 10) == 0);
+        cmc_assert_equals(size_t, 10, br_count(r));
+
+        cmc_assert(!br_consume(r, 11));
+        cmc_assert(br_consume(r, 8));
+        cmc_assert_equals(size_t, 2, br_read(r, out, 16));
+        cmc_assert(memcmp(out, "mn", 2) == 0);
+        cmc_assert(br_empty(r));
+
+        br_free(r);
+    });
+
+    CMC_CREATE_TEST(produce linearize resize, {
+        struct bytering *r = br_new(8);
+
+        cmc_assert_not_equals(ptr, NULL, r);
+
+        cmc_assert_equals(size_t, 5, br_write(r, "12345", 5));
+        cmc_assert(br_consume(r, 3));
+
+        unsigned char *a;
+        unsigned char *b;
+        size_t a_size;
+        size_t b_size;
+
+        br_vacant_spans(r, &a, &a_size, &b, &b_size);
+
+        cmc_assert_equals(size_t, 3, a_size);
+        cmc_assert_equals(size_t, 3, b_size);
+
+        memcpy(a, "678", 3);
+        memcpy(b, "9AB", 3);
+
+        cmc_assert(!br_produce(r, 7));
+        cmc_assert(br_produce(r, 6));
+        cmc_assert(br_full(r));
+
+        unsigned char *bytes = br_linearize(r);
+
+        cmc_assert(memcmp(bytes, "456789AB", 8) == 0);
+
+        br_spans(r, &a, &a_size, &b, &b_size);
+
+        cmc_assert_equals(size_t, 8, a_size);
+        cmc_assert_equals(size_t, 0, b_size);
+
+        cmc_assert(br_consume(r, 2));
+        cmc_assert(!br_resize(r, 5));
+        cmc_assert(br_resize(r, 6));
+        cmc_assert_equals(size_t, 6, br_count(r));
+        cmc_assert(memcmp(br_linearize(r), "6789AB", 6) == 0);
+
+        br_free(r);
+    });
+
+    CMC_CREATE_TEST(fd, {
+        int fds[2];
+
+        cmc_assert_equals(int32_t, 0, pipe(fds));
+
+        struct bytering *r = br_new(8);
+
+        cmc_assert_not_equals(ptr, NULL, r);
+
+        cmc_assert_equals(size_t, 6, br_write(r, "xxxxxx", 6));
+        cmc_assert(br_consume(r, 6));
+        cmc_assert_equals(size_t, 6, br_write(r, "abcdef", 6));
+
+        /* Both filled regions are written at once */
+        cmc_assert_equals(int64_t, 6, br_write_fd(r, fds[1]));
+        cmc_assert(br_empty(r));
+        cmc_assert_equals(int64_t, 0, br_write_fd(r, fds[1]));
+
+        cmc_assert_equals(size_t, 3, br_write(r, "___", 3));
+        cmc_assert(br_consume(r, 2));
+
+        cmc_assert_equals(int64_t, 6, br_read_fd(r, fds[0]));
+        cmc_assert_equals(size_t, 7, br_count(r));
+
+        unsigned char out[8];
+
+        cmc_assert_equals(size_t, 7, br_read(r, out, 8));
+        cmc_assert(memcmp(out, "_abcdef", 7) == 0);
+
+        cmc_assert_equals(size_t, 8, br_write(r, "12345678", 8));
+        cmc_assert_equals(int64_t, -1, br_read_fd(r, fds[0]));
+        cmc_assert_equals(int32_t, ENOBUFS, errno);
+
+        close(fds[1]);
+
+        cmc_assert(br_consume(r, 8));
+        cmc_assert_equals(int64_t, 0, br_read_fd(r, fds[0]));
+
+        close(fds[0]);
+
+        br_free(r);
+    });
+});
@@ -0,0 +1,182 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/compacttreeset.h>
+
+CMC_GENERATE_COMPACT_TREESET(cts, compacttreeset, size_t)
+
+/* Height of a subtree, or 0 if it is not a valid AVL tree with correct */
+/* parent indices */
+static size_t compact_height(struct compacttreeset *set, uint32_t node, uint32_t parent)
+{
+    if (node == 0)
+        return 1;
+
+    struct compacttreeset_node *n = &set->nodes[node];
+
+    if (node > set->count || n->link >> 6 != parent)
+        return 0;
+
+    size_t left = compact_height(set, n->left, node);
+    size_t right = compact_height(set, n->right, node);
+
+    if (left == 0 || right == 0 || left > right + 1 || right > left + 1)
+        return 0;
+
+    if (n->left && set->nodes[n->left].value >= n->value)
+        return 0;
+    if (n->right && set->nodes[n->right].value <= n->value)
+        return 0;
+
+    size_t height = (left > right ? left : right) + 1;
+
+    return (n->link & 63) + 1 == height ? height : 0;
+}
+
+CMC_CREATE_UNIT(compacttreeset_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct compacttreeset *set = cts_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+        cmc_assert_equals(ptr, NULL, set->nodes);
+        cmc_assert(cts_empty(set));
+        cmc_assert(!cts_min(set, NULL));
+        cmc_assert(!cts_remove(set, 1));
+
+        /* The element and three indices, with padding to 8 bytes */
+        cmc_assert_equals(size_t, 24, sizeof(struct compacttreeset_node));
+
+        cts_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct compacttreeset *set = cts_new_custom(cmp, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 0; i < 1000; i++)
+            cts_insert(set, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        cts_free(set, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(insert remove, {
+        struct compacttreeset *set = cts_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 0; i < 5000; i++)
+            cmc_assert(cts_insert(set, (i * 7919) % 5000));
+
+        cmc_assert(!cts_insert(set, 10));
+        cmc_assert_equals(size_t, 5000, cts_count(set));
+        cmc_assert_not_equals(size_t, 0, compact_height(set, set->root, 0));
+
+        for (size_t i = 0; i < 5000; i += 3)
+            cmc_assert(cts_remove(set, (i * 3571) % 5000));
+
+        cmc_assert(!cts_remove(set, 0));
+        cmc_assert_equals(size_t, 3333, cts_count(set));
+        cmc_assert_not_equals(size_t, 0, compact_height(set, set->root, 0));
+
+        for (size_t i = 0; i < 5000; i++)
+            cmc_assert_equals(bool, i % 3 != 0, cts_contains(set, (i * 3571) % 5000));
+
+        size_t value;
+        size_t smallest = 0;
+
+        while (!cts_contains(set, smallest))
+            smallest++;
+
+        cmc_assert(cts_min(set, &value));
+        cmc_assert_equals(size_t, smallest, value);
+
+        /* The array is reused once it is emptied */
+        size_t capacity = set->capacity;
+
+        cts_clear(set, NULL);
+
+        cmc_assert(cts_empty(set));
+
+        for (size_t i = 0; i < 5000; i++)
+            cmc_assert(cts_insert(set, i));
+
+        cmc_assert_equals(size_t, capacity, set->capacity);
+        cmc_assert_not_equals(size_t, 0, compact_height(set, set->root, 0));
+
+        for (size_t i = 0; i < 5000; i++)
+            cmc_assert(cts_remove(set, i));
+
+        cmc_assert(cts_empty(set));
+        cmc_assert_equals(size_t, 0, set->root);
+
+        cts_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(bounds, {
+        struct compacttreeset *set = cts_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 1; i <= 100; i++)
+            cmc_assert(cts_insert(set, i * 10));
+
+        size_t value;
+
+        cmc_assert(cts_floor(set, 55, &value));
+        cmc_assert_equals(size_t, 50, value);
+        cmc_assert(cts_ceiling(set, 55, &value));
+        cmc_assert_equals(size_t, 60, value);
+        cmc_assert(cts_floor(set, 60, &value));
+        cmc_assert_equals(size_t, 60, value);
+        cmc_assert(!cts_floor(set, 5, &value));
+        cmc_assert(!cts_ceiling(set, 1001, &value));
+        cmc_assert(cts_max(set, &value));
+        cmc_assert_equals(size_t, 1000, value);
+
+        cts_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(iter, {
+        struct compacttreeset *set = cts_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 1000; i > 0; i--)
+            cmc_assert(cts_insert(set, i));
+
+        struct compacttreeset_iter iter;
+
+        size_t total = 0;
+
+        for (cts_iter_init(&iter, set); !cts_iter_end(&iter); cts_iter_next(&iter))
+        {
+            cmc_assert_equals(size_t, total + 1, cts_iter_value(&iter));
+            cmc_assert_equals(size_t, total, cts_iter_index(&iter));
+            total++;
+        }
+
+        cmc_assert_equals(size_t, 1000, total);
+        cmc_assert(!cts_iter_next(&iter));
+
+        for (cts_iter_to_end(&iter); !cts_iter_start(&iter); cts_iter_prev(&iter))
+        {
+            cmc_assert_equals(size_t, total, cts_iter_value(&iter));
+            cmc_assert_equals(size_t, total - 1, cts_iter_index(&iter));
+            total--;
+        }
+
+        cmc_assert_equals(size_t, 0, total);
+        cmc_assert(!cts_iter_prev(&iter));
+
+        cts_free(set, NULL);
+    });
+});
@@ -0,0 +1,156 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/concurrenthashmap.h>
+
+CMC_GENERATE_CONCURRENT_HASHMAP(chm, concurrenthashmap, size_t, size_t)
+
+struct chm_worker
+{
+    struct concurrenthashmap *map;
+    size_t start;
+    size_t end;
+};
+
+static void *chm_worker_insert(void *arg)
+{
+    struct chm_worker *worker = arg;
+
+    for (size_t i = worker->start; i < worker->end; i++)
+        chm_insert(worker->map, i, i * 2);
+
+    /* Every thread also removes the odd keys of its range */
+    for (size_t i = worker->start + 1; i < worker->end; i += 2)
+        chm_remove(worker->map, i, NULL);
+
+    return NULL;
+}
+
+CMC_CREATE_UNIT(concurrenthashmap_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct concurrenthashmap *map = chm_new(10, 1000, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+        cmc_assert_equals(size_t, 16, map->shard_count);
+        cmc_assert_equals(size_t, 0, chm_count(map));
+        cmc_assert(chm_empty(map));
+
+        for (size_t i = 0; i < map->shard_count; i++)
+            cmc_assert_equals(size_t, 0, (uintptr_t)&(map->shards[i]) % CMC_CACHE_LINE_SIZE);
+
+        chm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct concurrenthashmap *map = chm_new_custom(10, 1000, 0.6, cmp, hash, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            chm_insert(map, i, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        chm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(new[shards = 0], {
+        struct concurrenthashmap *map = chm_new(0, 1000, 0.6, cmp, hash);
+
+        cmc_assert_equals(ptr, NULL, map);
+    });
+
+    CMC_CREATE_TEST(insert remove update, {
+        struct concurrenthashmap *map = chm_new(4, 1, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(chm_insert(map, i, i));
+
+        cmc_assert(!chm_insert(map, 10, 0));
+        cmc_assert_equals(size_t, 1000, chm_count(map));
+
+        size_t old;
+
+        cmc_assert(chm_update(map, 10, 20, &old));
+        cmc_assert_equals(size_t, 10, old);
+        cmc_assert_equals(size_t, 20, chm_get(map, 10));
+
+        for (size_t i = 0; i < 500; i++)
+            cmc_assert(chm_remove(map, i, NULL));
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert_equals(bool, i >= 500, chm_contains(map, i));
+
+        chm_clear(map, NULL);
+
+        cmc_assert(chm_empty(map));
+
+        chm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(stats, {
+        struct concurrenthashmap *map = chm_new(4, 1000, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(chm_insert(map, i, i));
+
+        struct cmc_hashtable_stats stats;
+
+        chm_stats(map, &stats);
+
+        size_t capacity = 0;
+        size_t entries = 0;
+
+        for (size_t i = 0; i < map->shard_count; i++)
+            capacity += chm_shard_map_capacity(map->shards[i].map);
+
+        for (size_t i = 0; i < CMC_HASHTABLE_STATS_BUCKETS; i++)
+            entries += stats.histogram[i];
+
+        cmc_assert_equals(size_t, capacity, stats.capacity);
+        cmc_assert_equals(size_t, 1000, stats.count);
+        cmc_assert_equals(size_t, 1000, entries);
+
+        chm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(threads, {
+        struct concurrenthashmap *map = chm_new(8, 1000, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        pthread_t threads[4];
+        struct chm_worker workers[4];
+
+        for (size_t i = 0; i < 4; i++)
+        {
+            workers[i].map = map;
+            workers[i].start = i * 10000;
+            workers[i].end = (i + 1) * 10000;
+
+            int result = pthread_create(&threads[i], NULL, chm_worker_insert, &workers[i]);
+
+            cmc_assert_equals(int32_t, 0, result);
+        }
+
+        for (size_t i = 0; i < 4; i++)
+            pthread_join(threads[i], NULL);
+
+        cmc_assert_equals(size_t, 20000, chm_count(map));
+
+        for (size_t i = 0; i < 40000; i++)
+            cmc_assert_equals(size_t, i % 2 == 0 ? i * 2 : 0, chm_get(map, i));
+
+        chm_free(map, NULL);
+    });
+});
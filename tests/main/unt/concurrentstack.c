@@ -0,0 +1,192 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <cmc/concurrentstack.h>
+
+CMC_GENERATE_CONCURRENT_STACK(cs, concurrentstack, size_t)
+
+#define CS_THREADS 4
+#define CS_ROUNDS 20000
+#define CS_BUFFERS 16
+
+struct cs_worker
+{
+    struct concurrentstack *stack;
+    atomic_bool *in_use;
+    size_t errors;
+};
+
+/* Each worker takes buffers from the stack and gives them back, checking */
+/* that no other worker holds the same buffer at the same time */
+static void *cs_worker_run(void *arg)
+{
+    struct cs_worker *worker = arg;
+
+    for (size_t i = 0; i < CS_ROUNDS; i++)
+    {
+        size_t a;
+        size_t b;
+
+        if (!cs_pop(worker->stack, &a))
+        {
+            sched_yield();
+            continue;
+        }
+
+        if (atomic_exchange(&worker->in_use[a], true))
+            worker->errors++;
+
+        bool second = cs_pop(worker->stack, &b);
+
+        if (second && atomic_exchange(&worker->in_use[b], true))
+            worker->errors++;
+
+        if (second)
+        {
+            atomic_store(&worker->in_use[b], false);
+
+            if (!cs_push(worker->stack, b))
+                worker->errors++;
+        }
+
+        atomic_store(&worker->in_use[a], false);
+
+        if (!cs_push(worker->stack, a))
+            worker->errors++;
+    }
+
+    return NULL;
+}
+
+CMC_CREATE_UNIT(concurrentstack_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct concurrentstack *s = cs_new(10, 4);
+
+        cmc_assert_not_equals(ptr, NULL, s);
+        cmc_assert_equals(size_t, 10, cs_capacity(s));
+        cmc_assert_equals(size_t, 0, cs_count(s));
+        cmc_assert(cs_empty(s));
+
+        cs_free(s, NULL);
+
+        s = cs_new(10, 0);
+
+        cmc_assert_not_equals(ptr, NULL, s);
+        cmc_assert_equals(ptr, NULL, s->slots);
+
+        cs_free(s, NULL);
+
+        cmc_assert_equals(ptr, NULL, cs_new(0, 4));
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct concurrentstack *s = cs_new_custom(10, 4, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, s);
+
+        for (size_t i = 0; i < 1000; i++)
+            cs_push(s, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        cs_free(s, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(push pop, {
+        struct concurrentstack *s = cs_new(100, 4);
+
+        cmc_assert_not_equals(ptr, NULL, s);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(cs_push(s, i));
+
+        cmc_assert(!cs_push(s, 100));
+        cmc_assert_equals(size_t, 100, cs_count(s));
+
+        size_t value;
+
+        for (size_t i = 0; i < 100; i++)
+        {
+            cmc_assert(cs_pop(s, &value));
+            cmc_assert_equals(size_t, 99 - i, value);
+        }
+
+        cmc_assert(!cs_pop(s, &value));
+        cmc_assert(cs_empty(s));
+
+        /* Nodes are reused */
+        for (size_t i = 0; i < 1000; i++)
+        {
+            cmc_assert(cs_push(s, i));
+            cmc_assert(cs_push(s, i + 1));
+            cmc_assert(cs_pop(s, &value));
+            cmc_assert_equals(size_t, i + 1, value);
+            cmc_assert(cs_pop(s, NULL));
+        }
+
+        cmc_assert(cs_empty(s));
+
+        cs_free(s, NULL);
+    });
+
+    CMC_CREATE_TEST(threads, {
+        for (size_t slots = 0; slots <= 2; slots += 2)
+        {
+            struct concurrentstack *s = cs_new(CS_BUFFERS, slots);
+
+            cmc_assert_not_equals(ptr, NULL, s);
+
+            atomic_bool in_use[CS_BUFFERS];
+
+            for (size_t i = 0; i < CS_BUFFERS; i++)
+            {
+                atomic_init(&in_use[i], false);
+                cmc_assert(cs_push(s, i));
+            }
+
+            pthread_t threads[CS_THREADS];
+            struct cs_worker workers[CS_THREADS];
+
+            for (size_t i = 0; i < CS_THREADS; i++)
+            {
+                workers[i].stack = s;
+                workers[i].in_use = in_use;
+                workers[i].errors = 0;
+
+                int result = pthread_create(&threads[i], NULL, cs_worker_run, &workers[i]);
+
+                cmc_assert_equals(int32_t, 0, result);
+            }
+
+            for (size_t i = 0; i < CS_THREADS; i++)
+            {
+                pthread_join(threads[i], NULL);
+
+                cmc_assert_equals(size_t, 0, workers[i].errors);
+            }
+
+            /* Every buffer came back exactly once */
+            size_t seen = 0;
+            size_t value;
+
+            while (cs_pop(s, &value))
+            {
+                cmc_assert(value < CS_BUFFERS);
+                seen |= (size_t)1 << value;
+            }
+
+            cmc_assert_equals(size_t, ((size_t)1 << CS_BUFFERS) - 1, seen);
+
+            cs_free(s, NULL);
+        }
+    });
+});
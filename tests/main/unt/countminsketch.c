@@ -0,0 +1,133 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/countminsketch.h>
+
+CMC_GENERATE_COUNTMINSKETCH(cms, countminsketch, size_t)
+
+CMC_CREATE_UNIT(countminsketch_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct countminsketch *sketch = cms_new(1000, 4, hash);
+
+        cmc_assert_not_equals(ptr, NULL, sketch);
+        cmc_assert_equals(size_t, 1024, cms_width(sketch));
+        cmc_assert_equals(size_t, 4, cms_depth(sketch));
+        cmc_assert_equals(size_t, 0, (uintptr_t)sketch->counters % CMC_CACHE_LINE_SIZE);
+        cmc_assert_equals(size_t, 0, cms_estimate(sketch, 1));
+        cmc_assert(cms_empty(sketch));
+
+        cms_free(sketch);
+
+        cmc_assert_equals(ptr, NULL, cms_new(0, 4, hash));
+        cmc_assert_equals(ptr, NULL, cms_new(16, CMC_COUNTMINSKETCH_MAX_DEPTH + 1, hash));
+
+        // e / 0.001 counters in ln(1 / 0.01) rows
+        sketch = cms_new_error(0.001, 0.01, hash);
+
+        cmc_assert_not_equals(ptr, NULL, sketch);
+        cmc_assert_equals(size_t, 4096, cms_width(sketch));
+        cmc_assert_equals(size_t, 5, cms_depth(sketch));
+
+        cms_free(sketch);
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct countminsketch *sketch = cms_new_custom(256, 4, hash, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, sketch);
+
+        for (size_t i = 0; i < 1000; i++)
+            cms_insert(sketch, i);
+
+        cmc_assert_equals(size_t, 2, count_alloc_live);
+
+        cms_free(sketch);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(estimate, {
+        struct countminsketch *sketch = cms_new(16384, 4, hash);
+
+        // Element i is inserted i % 50 + 1 times
+        for (size_t i = 0; i < 2000; i++)
+            cms_add(sketch, i, (uint32_t)(i % 50 + 1));
+
+        cmc_assert_equals(size_t, 40 * 1275, cms_total(sketch));
+
+        bool above = true;
+        size_t exact = 0;
+
+        for (size_t i = 0; i < 2000; i++)
+        {
+            size_t estimate = cms_estimate(sketch, i);
+
+            above = above && estimate >= i % 50 + 1;
+
+            if (estimate == i % 50 + 1)
+                exact++;
+        }
+
+        // Never below and mostly exact with the conservative update
+        cmc_assert(above);
+        cmc_assert_greater(size_t, 1900, exact);
+
+        cms_clear(sketch);
+
+        cmc_assert(cms_empty(sketch));
+        cmc_assert_equals(size_t, 0, cms_estimate(sketch, 7));
+
+        cms_free(sketch);
+    });
+
+    CMC_CREATE_TEST(saturate, {
+        struct countminsketch *sketch = cms_new(16, 1, hash);
+
+        cms_add(sketch, 1, UINT32_MAX - 1);
+        cms_add(sketch, 1, 10);
+
+        cmc_assert_equals(size_t, UINT32_MAX, cms_estimate(sketch, 1));
+
+        struct countminsketch *merged = cms_merge(sketch, sketch);
+
+        cmc_assert_equals(size_t, UINT32_MAX, cms_estimate(merged, 1));
+
+        cms_free(sketch);
+        cms_free(merged);
+    });
+
+    CMC_CREATE_TEST(merge, {
+        struct countminsketch *s1 = cms_new(1024, 4, hash);
+        struct countminsketch *s2 = cms_new(1024, 4, hash);
+        struct countminsketch *other = cms_new(512, 4, hash);
+
+        cmc_assert(!cms_compatible(s1, other));
+        cmc_assert_equals(ptr, NULL, cms_merge(s1, other));
+        cmc_assert(!cms_merge_into(s1, other));
+
+        // Two threads counting halves of the same stream
+        for (size_t i = 0; i < 100; i++)
+            cms_insert(i % 2 == 0 ? s1 : s2, i % 10);
+
+        struct countminsketch *copy = cms_copy_of(s1);
+
+        cmc_assert(cms_equals(s1, copy));
+        cmc_assert(cms_merge_into(s1, s2));
+        cmc_assert(!cms_equals(s1, copy));
+        cmc_assert_equals(size_t, 100, cms_total(s1));
+
+        for (size_t i = 0; i < 10; i++)
+            cmc_assert_greater_equals(size_t, 10, cms_estimate(s1, i));
+
+        cmc_assert_equals(size_t, 0, cms_estimate(s1, 10000));
+
+        cms_free(s1);
+        cms_free(s2);
+        cms_free(other);
+        cms_free(copy);
+    });
+});
@@ -0,0 +1,230 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/cuckooset.h>
+
+CMC_GENERATE_CUCKOOSET(cks, cuckooset, size_t)
+CMC_GENERATE_CUCKOOMAP(ckm, cuckoomap, size_t, size_t)
+
+CMC_CREATE_UNIT(cuckooset_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct cuckooset *set = cks_new(1000, 0.9, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+        cmc_assert(cks_empty(set));
+        cmc_assert_greater_equals(size_t, (size_t)(1000 / 0.9), cks_capacity(set));
+        cmc_assert_equals(size_t, 0, cks_capacity(set) & (cks_capacity(set) - 1));
+
+        cks_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct cuckooset *set = cks_new_custom(10, 0.9, cmp, hash, &count_alloc);
+        struct cuckoomap *map = ckm_new_custom(10, 0.9, cmp, hash, &count_alloc);
+
+        for (size_t i = 0; i < 5000; i++)
+        {
+            cmc_assert(cks_insert(set, i));
+            cmc_assert(ckm_insert(map, i, i));
+        }
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        cks_free(set, NULL);
+        ckm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(new[capacity = 0], {
+        cmc_assert_equals(ptr, NULL, cks_new(0, 0.9, cmp, hash));
+        cmc_assert_equals(ptr, NULL, cks_new(100, 1.0, cmp, hash));
+        cmc_assert_equals(ptr, NULL, cks_new(UINT64_MAX, 0.99, cmp, hash));
+    });
+
+    CMC_CREATE_TEST(insert remove contains, {
+        struct cuckooset *set = cks_new(1, 0.9, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 0; i < 20000; i++)
+            cmc_assert(cks_insert(set, i * 3));
+
+        cmc_assert(!cks_insert(set, 0));
+        cmc_assert_equals(size_t, 20000, cks_count(set));
+
+        for (size_t i = 0; i < 60000; i++)
+            cmc_assert_equals(bool, i % 3 == 0, cks_contains(set, i));
+
+        for (size_t i = 0; i < 60000; i += 6)
+            cmc_assert(cks_remove(set, i));
+
+        cmc_assert(!cks_remove(set, 0));
+        cmc_assert(!cks_remove(set, 1));
+        cmc_assert_equals(size_t, 10000, cks_count(set));
+
+        for (size_t i = 0; i < 60000; i++)
+            cmc_assert_equals(bool, i % 6 == 3, cks_contains(set, i));
+
+        cks_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(insert[high load], {
+        // The table only grows once it is 95% full
+        struct cuckooset *set = cks_new(4000, 0.95, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        size_t capacity = cks_capacity(set);
+        size_t fill = (size_t)(capacity * 0.95);
+
+        for (size_t i = 0; i < fill; i++)
+            cmc_assert(cks_insert(set, i));
+
+        cmc_assert_equals(size_t, capacity, cks_capacity(set));
+
+        for (size_t i = 0; i < fill; i++)
+            cmc_assert(cks_contains(set, i));
+
+        cks_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(insert[same hash], {
+        // Only the 8 slots of their two buckets can hold them
+        struct cuckooset *set = cks_new(1000, 0.9, cmp, hash0);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 0; i < 8; i++)
+            cmc_assert(cks_insert(set, i));
+
+        cmc_assert(!cks_insert(set, 8));
+        cmc_assert_equals(size_t, 8, cks_count(set));
+
+        for (size_t i = 0; i < 8; i++)
+            cmc_assert(cks_contains(set, i));
+
+        cks_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(clear, {
+        struct cuckooset *set = cks_new(100, 0.9, cmp, hash);
+
+        for (size_t i = 0; i < 500; i++)
+            cks_insert(set, i);
+
+        cks_clear(set, NULL);
+
+        cmc_assert(cks_empty(set));
+        cmc_assert(!cks_contains(set, 10));
+        cmc_assert(cks_insert(set, 10));
+
+        cks_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(copy_of equals, {
+        struct cuckooset *set = cks_new(100, 0.9, cmp, hash);
+
+        for (size_t i = 0; i < 1000; i++)
+            cks_insert(set, i);
+
+        struct cuckooset *copy = cks_copy_of(set, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, copy);
+        cmc_assert_equals(size_t, cks_capacity(set), cks_capacity(copy));
+        cmc_assert(cks_equals(set, copy));
+
+        cks_remove(copy, 5);
+        cks_insert(copy, 5000);
+
+        cmc_assert(!cks_equals(set, copy));
+
+        cks_free(set, NULL);
+        cks_free(copy, NULL);
+    });
+
+    CMC_CREATE_TEST(iter, {
+        struct cuckooset *set = cks_new(100, 0.9, cmp, hash);
+
+        for (size_t i = 1; i <= 300; i++)
+            cks_insert(set, i);
+
+        struct cuckooset_iter iter;
+        size_t sum = 0;
+        size_t index = 0;
+
+        for (cks_iter_init(&iter, set); !cks_iter_end(&iter); cks_iter_next(&iter))
+        {
+            cmc_assert_equals(size_t, index++, cks_iter_index(&iter));
+            sum += cks_iter_value(&iter);
+        }
+
+        cmc_assert_equals(size_t, 300, index);
+        cmc_assert_equals(size_t, 300 * 301 / 2, sum);
+
+        sum = 0;
+
+        for (cks_iter_to_end(&iter); !cks_iter_start(&iter); cks_iter_prev(&iter))
+            sum += cks_iter_value(&iter);
+
+        cmc_assert_equals(size_t, 300 * 301 / 2, sum);
+
+        cks_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(map[insert update remove], {
+        struct cuckoomap *map = ckm_new(1, 0.9, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 10000; i++)
+            cmc_assert(ckm_insert(map, i, i * 2));
+
+        cmc_assert(!ckm_insert(map, 10, 0));
+        cmc_assert_equals(size_t, 10000, ckm_count(map));
+
+        for (size_t i = 0; i < 10000; i++)
+            cmc_assert_equals(size_t, i * 2, ckm_get(map, i));
+
+        size_t old = 0;
+
+        cmc_assert(ckm_update(map, 10, 7, &old));
+        cmc_assert_equals(size_t, 20, old);
+        cmc_assert_equals(size_t, 7, *ckm_get_ref(map, 10));
+        cmc_assert(!ckm_update(map, 10000, 7, NULL));
+        cmc_assert_equals(ptr, NULL, ckm_get_ref(map, 10000));
+
+        cmc_assert(ckm_remove(map, 10, &old));
+        cmc_assert_equals(size_t, 7, old);
+        cmc_assert(!ckm_remove(map, 10, NULL));
+        cmc_assert(!ckm_contains(map, 10));
+        cmc_assert_equals(size_t, 9999, ckm_count(map));
+
+        struct cuckoomap *copy = ckm_copy_of(map, NULL, NULL);
+
+        cmc_assert(ckm_equals(map, copy, cmp));
+
+        ckm_update(copy, 11, 0, NULL);
+
+        cmc_assert(ckm_equals(map, copy, NULL));
+        cmc_assert(!ckm_equals(map, copy, cmp));
+
+        struct cuckoomap_iter iter;
+        size_t count = 0;
+
+        for (ckm_iter_init(&iter, map); !ckm_iter_end(&iter); ckm_iter_next(&iter))
+        {
+            cmc_assert_equals(size_t, ckm_iter_key(&iter) * 2, ckm_iter_value(&iter));
+            count++;
+        }
+
+        cmc_assert_equals(size_t, 9999, count);
+
+        ckm_free(map, NULL);
+        ckm_free(copy, NULL);
+    });
+});
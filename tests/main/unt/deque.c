@@ -6,6 +6,13 @@
 #include <cmc/deque.h>
 
 CMC_GENERATE_DEQUE(d, deque, size_t)
+CMC_GENERATE_DEQUE_BITWISE(db, deque_bitwise, size_t)
+CMC_GENERATE_DEQUE_TRIVIAL(dt, deque_trivial, size_t)
+
+static bool d_is_odd(size_t x)
+{
+    return x % 2 == 1;
+}
 
 CMC_CREATE_UNIT(deque_test, true, {
     CMC_CREATE_TEST(new, {
@@ -19,6 +26,23 @@ CMC_CREATE_UNIT(deque_test, true, {
         d_free(d, NULL);
     });
 
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct deque *d = d_new_custom(100, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, d);
+
+        for (size_t i = 0; i < 1000; i++)
+            d_push_back(d, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        d_free(d, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
     CMC_CREATE_TEST(new[capacity = 0], {
         struct deque *d = d_new(0);
 
@@ -382,6 +406,112 @@ CMC_CREATE_UNIT(deque_test, true, {
         d_free(d, NULL);
     });
 
+    CMC_CREATE_TEST(push_back_many and pop_front_many, {
+        struct deque *d = d_new(10);
+
+        cmc_assert_not_equals(ptr, NULL, d);
+
+        size_t elements[300];
+
+        for (size_t i = 0; i < 300; i++)
+            elements[i] = i;
+
+        cmc_assert(!d_push_back_many(d, elements, 0));
+
+        /* The front is moved so the copies wrap around the buffer */
+        for (size_t i = 0; i < 7; i++)
+            cmc_assert(d_push_back(d, 1000));
+
+        for (size_t i = 0; i < 7; i++)
+            cmc_assert(d_pop_front(d));
+
+        cmc_assert(d_push_back_many(d, elements, 8));
+        cmc_assert_equals(size_t, 8, d_count(d));
+
+        for (size_t i = 0; i < 8; i++)
+            cmc_assert_equals(size_t, i, d_get(d, i));
+
+        cmc_assert(d_push_back_many(d, elements + 8, 292));
+        cmc_assert_equals(size_t, 300, d_count(d));
+
+        for (size_t i = 0; i < 300; i++)
+            cmc_assert_equals(size_t, i, d_get(d, i));
+
+        size_t result[300];
+        size_t *slots[100];
+
+        for (size_t i = 0; i < 100; i++)
+            slots[i] = d_get_ref(d, i);
+
+        cmc_assert_equals(size_t, 100, d_pop_front_many(d, result, 100));
+
+        /* The slots freed are zeroed */
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert_equals(size_t, 0, *slots[i]);
+
+        cmc_assert_equals(size_t, 100, d_front(d));
+        cmc_assert_equals(size_t, 50, d_pop_front_many(d, NULL, 50));
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert_equals(size_t, i, result[i]);
+
+        cmc_assert_equals(size_t, 150, d_pop_front_many(d, result, 300));
+        cmc_assert(d_empty(d));
+        cmc_assert_equals(size_t, 0, d_pop_front_many(d, result, 1));
+
+        for (size_t i = 0; i < 150; i++)
+            cmc_assert_equals(size_t, i + 150, result[i]);
+
+        d_free(d, NULL);
+    });
+
+    CMC_CREATE_TEST(get and spans, {
+        struct deque *d = d_new(100);
+
+        cmc_assert_not_equals(ptr, NULL, d);
+
+        /* The front ends up at the end of the buffer */
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert(d_push_front(d, 49 - i));
+
+        for (size_t i = 50; i < 80; i++)
+            cmc_assert(d_push_back(d, i));
+
+        for (size_t i = 0; i < 80; i++)
+            cmc_assert_equals(size_t, i, d_get(d, i));
+
+        cmc_assert_equals(size_t, 0, d_get(d, 80));
+        cmc_assert_equals(ptr, NULL, d_get_ref(d, 80));
+
+        *d_get_ref(d, 10) = 1000;
+
+        cmc_assert_equals(size_t, 1000, d_get(d, 10));
+
+        size_t *a;
+        size_t *b;
+        size_t a_count;
+        size_t b_count;
+
+        d_spans(d, &a, &a_count, &b, &b_count);
+
+        cmc_assert_equals(size_t, 50, a_count);
+        cmc_assert_equals(size_t, 30, b_count);
+        cmc_assert_equals(ptr, d_get_ref(d, 0), a);
+        cmc_assert_equals(ptr, d_get_ref(d, 50), b);
+
+        /* Without wrapping around there is a single span */
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert(d_pop_front(d));
+
+        d_spans(d, &a, &a_count, &b, &b_count);
+
+        cmc_assert_equals(size_t, 30, a_count);
+        cmc_assert_equals(size_t, 0, b_count);
+        cmc_assert_equals(size_t, 50, a[0]);
+
+        d_free(d, NULL);
+    });
+
     CMC_CREATE_TEST(contains, {
         struct deque *d = d_new(100);
 
@@ -404,6 +534,34 @@ CMC_CREATE_UNIT(deque_test, true, {
         d_free(d, NULL);
     });
 
+    CMC_CREATE_TEST(contains[bitwise], {
+        struct deque_bitwise *d = db_new(100);
+
+        cmc_assert_not_equals(ptr, NULL, d);
+
+        /* The elements wrap around the end of the buffer */
+        for (size_t i = 0; i < 100; i++)
+        {
+            if (i % 2 == 0)
+                cmc_assert(db_push_back(d, i));
+            else
+                cmc_assert(db_push_front(d, i));
+        }
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(db_contains(d, i, NULL));
+
+        cmc_assert(!db_contains(d, 100, NULL));
+
+        for (size_t i = 0; i < 30; i++)
+            cmc_assert(db_pop_front(d));
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert_equals(bool, i % 2 == 0 || i < 40, db_contains(d, i, NULL));
+
+        db_free(d, NULL);
+    });
+
     CMC_CREATE_TEST(contains[count = 0], {
         struct deque *d = d_new(100);
 
@@ -536,6 +694,85 @@ CMC_CREATE_UNIT(deque_test, true, {
         d_free(d, NULL);
     });
 
+    CMC_CREATE_TEST(reserve, {
+        struct deque *d = d_new(100);
+
+        cmc_assert_not_equals(ptr, NULL, d);
+
+        /* The elements wrap around the end of the buffer */
+        for (size_t i = 0; i < 100; i++)
+        {
+            if (i % 2 == 0)
+                cmc_assert(d_push_back(d, i));
+            else
+                cmc_assert(d_push_front(d, i));
+        }
+
+        cmc_assert(d_reserve(d, 500));
+        cmc_assert_equals(size_t, 500, d_capacity(d));
+        cmc_assert(d_reserve(d, 100));
+        cmc_assert_equals(size_t, 500, d_capacity(d));
+
+        for (size_t i = 0; i < 100; i++)
+        {
+            size_t expected = i < 50 ? 99 - i * 2 : (i - 50) * 2;
+
+            cmc_assert_equals(size_t, expected, d->buffer[(d->front + i) % d->capacity]);
+        }
+
+        d_free(d, NULL);
+    });
+
+    CMC_CREATE_TEST(resize[back], {
+        struct deque *q = d_new(8);
+
+        cmc_assert_not_equals(ptr, NULL, q);
+
+        for (size_t i = 1; i <= 3; i++)
+            cmc_assert(d_push_back(q, i));
+
+        /* The buffer is left full, so the back wraps around to 0 */
+        cmc_assert(d_shrink_to_fit(q));
+        cmc_assert_equals(size_t, 3, d_capacity(q));
+        cmc_assert_equals(size_t, 0, q->back);
+
+        cmc_assert(d_pop_front(q));
+        cmc_assert(d_push_back(q, 4));
+
+        for (size_t i = 2; i <= 4; i++)
+        {
+            cmc_assert_equals(size_t, i, d_front(q));
+            cmc_assert(d_pop_front(q));
+        }
+
+        d_free(q, NULL);
+    });
+
+    CMC_CREATE_TEST(copy_of[back], {
+        struct deque *q1 = d_new(8);
+
+        cmc_assert_not_equals(ptr, NULL, q1);
+
+        for (size_t i = 1; i <= 3; i++)
+            cmc_assert(d_push_back(q1, i));
+
+        struct deque *q2 = d_copy_of(q1, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, q2);
+
+        /* New elements go after the copied ones */
+        cmc_assert(d_push_back(q2, 4));
+
+        for (size_t i = 1; i <= 4; i++)
+        {
+            cmc_assert_equals(size_t, i, d_front(q2));
+            cmc_assert(d_pop_front(q2));
+        }
+
+        d_free(q1, NULL);
+        d_free(q2, NULL);
+    });
+
     CMC_CREATE_TEST(copy_of, {
         struct deque *d1 = d_new(100);
 
@@ -630,4 +867,161 @@ CMC_CREATE_UNIT(deque_test, true, {
         d_free(d1, NULL);
         d_free(d2, NULL);
     });
+
+    CMC_CREATE_TEST(sort, {
+        struct deque *d = d_new(100);
+
+        cmc_assert_not_equals(ptr, NULL, d);
+
+        /* The elements wrap around the end of the buffer */
+        for (size_t i = 0; i < 60; i++)
+            cmc_assert(d_push_back(d, (i * 37) % 101));
+        for (size_t i = 0; i < 30; i++)
+            cmc_assert(d_push_front(d, (i * 53) % 97 + 200));
+
+        cmc_assert(d->front > d->back);
+
+        d_sort(d, cmp);
+
+        cmc_assert_equals(size_t, 90, d_count(d));
+        cmc_assert_equals(size_t, 0, d->front);
+
+        struct deque_iter iter;
+
+        size_t last = 0;
+
+        for (d_iter_init(&iter, d); !d_iter_end(&iter); d_iter_next(&iter))
+        {
+            cmc_assert(last <= d_iter_value(&iter));
+            last = d_iter_value(&iter);
+        }
+
+        cmc_assert_equals(size_t, d_back(d), last);
+        cmc_assert(d_push_back(d, 300));
+        cmc_assert_equals(size_t, 300, d_back(d));
+
+        /* A full deque */
+        while (!d_full(d))
+            cmc_assert(d_push_front(d, d_count(d)));
+
+        d_sort(d, cmp);
+
+        cmc_assert_equals(size_t, 0, d_front(d));
+        cmc_assert_equals(size_t, 300, d_back(d));
+
+        d_free(d, NULL);
+    });
+
+    CMC_CREATE_TEST(new_from, {
+        size_t elements[100];
+
+        for (size_t i = 0; i < 100; i++)
+            elements[i] = i;
+
+        struct deque *d = d_new_from(elements, 100);
+
+        cmc_assert_not_equals(ptr, NULL, d);
+        cmc_assert_equals(size_t, 100, d_count(d));
+
+        for (size_t i = 0; i < 100; i++)
+        {
+            cmc_assert_equals(size_t, i, d_front(d));
+            cmc_assert(d_pop_front(d));
+        }
+
+        d_free(d, NULL);
+
+        cmc_assert_equals(ptr, NULL, d_new_from(elements, 0));
+    });
+
+    CMC_CREATE_TEST(to_array[wrapped around], {
+        struct deque *d = d_new(100);
+
+        size_t elements[100] = { 0 };
+
+        cmc_assert_equals(size_t, 0, d_to_array(d, elements, 100));
+
+        for (size_t i = 0; i < 80; i++)
+            d_push_back(d, i);
+
+        for (size_t i = 0; i < 60; i++)
+            d_pop_front(d);
+
+        for (size_t i = 80; i < 150; i++)
+            d_push_back(d, i);
+
+        cmc_assert_equals(size_t, 90, d_to_array(d, elements, 100));
+
+        for (size_t i = 0; i < 90; i++)
+            cmc_assert_equals(size_t, i + 60, elements[i]);
+
+        cmc_assert_equals(size_t, 30, d_to_array(d, elements, 30));
+
+        d_free(d, NULL);
+    });
+
+    CMC_CREATE_TEST(remove_if[wrapped], {
+        struct deque *d = d_new(100);
+
+        // Half of the elements wrap around the end of the buffer
+        for (size_t i = 0; i < 50; i++)
+            d_push_back(d, i + 50);
+        for (size_t i = 0; i < 50; i++)
+            d_push_front(d, 49 - i);
+
+        cmc_assert_equals(size_t, 50, d_remove_if(d, d_is_odd, NULL));
+        cmc_assert_equals(size_t, 50, d_count(d));
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert_equals(size_t, i * 2, d_get(d, i));
+
+        cmc_assert(d_push_back(d, 100));
+        cmc_assert_equals(size_t, 100, d_back(d));
+        cmc_assert_equals(size_t, 0, d_front(d));
+
+        d_free(d, NULL);
+    });
+
+    CMC_CREATE_TEST(trivial, {
+        struct deque_trivial *d = dt_new(100);
+
+        cmc_assert_not_equals(ptr, NULL, d);
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert(dt_push_back(d, i + 50));
+
+        for (size_t i = 0; i < 10; i++)
+            cmc_assert(dt_pop_back(d));
+
+        // The slots that were freed keep what they had
+        cmc_assert_equals(size_t, 99, d->buffer[49]);
+
+        cmc_assert(dt_resize(d, 200));
+        cmc_assert_equals(size_t, 0, d->front);
+
+        // Half of the elements wrap around the end of the buffer
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert(dt_push_front(d, 49 - i));
+
+        cmc_assert(dt_resize(d, 400));
+        cmc_assert_equals(size_t, 0, d->front);
+        cmc_assert_equals(size_t, 90, dt_count(d));
+
+        for (size_t i = 0; i < 90; i++)
+            cmc_assert_equals(size_t, i, dt_get(d, i));
+
+        struct deque_trivial *copy = dt_copy_of(d, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, copy);
+        cmc_assert(dt_equals(d, copy, cmp));
+
+        dt_clear(d, NULL);
+
+        cmc_assert(dt_empty(d));
+        cmc_assert(dt_push_front(d, 10));
+        cmc_assert_equals(size_t, 10, dt_back(d));
+
+        dt_free(d, NULL);
+        dt_free(copy, NULL);
+    });
 });
@@ -0,0 +1,139 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <fcntl.h>
+
+#include <cmc/list.h>
+#include <cmc/treemap.h>
+#include <utl/cmc_dump.h>
+
+CMC_GENERATE_LIST(dmp_l, dump_list, int64_t)
+CMC_GENERATE_TREEMAP(dmp_tm, dump_treemap, size_t, size_t)
+
+static const char *dmp_path = "dump.tmp";
+
+static void dmp_entry(struct cmc_dump *dump, size_t key, size_t value)
+{
+    cmc_dump_size_t(dump, key);
+    cmc_dump_char(dump, '=');
+    cmc_dump_size_t(dump, value);
+}
+
+static void dmp_fentry(FILE *file, size_t key, size_t value)
+{
+    cmc_fdump_size_t(file, key);
+    putc('=', file);
+    cmc_fdump_size_t(file, value);
+}
+
+/* Reads back what was written and checks it against what printf gives */
+static bool dmp_check_list(struct dump_list *list)
+{
+    FILE *file = fopen(dmp_path, "r");
+    char line[64];
+    char expected[64];
+
+    if (!file)
+        return false;
+
+    for (size_t i = 0; i < dmp_l_count(list); i++)
+    {
+        snprintf(expected, sizeof(expected), "%" PRId64 "\n", dmp_l_get(list, i));
+
+        if (!fgets(line, sizeof(line), file) || strcmp(line, expected) != 0)
+        {
+            fclose(file);
+            return false;
+        }
+    }
+
+    bool end = fgetc(file) == EOF;
+
+    fclose(file);
+
+    return end;
+}
+
+CMC_CREATE_UNIT(dump_test, true, {
+    CMC_CREATE_TEST(format, {
+        char digits[CMC_DUMP_DIGITS + 1];
+        char *end = digits + CMC_DUMP_DIGITS;
+
+        *end = '\0';
+
+        cmc_assert_equals(int32_t, 0, strcmp("0", cmc_dump_format_unsigned(end, 0)));
+        cmc_assert_equals(int32_t, 0, strcmp("7", cmc_dump_format_unsigned(end, 7)));
+        cmc_assert_equals(int32_t, 0, strcmp("10", cmc_dump_format_unsigned(end, 10)));
+        cmc_assert_equals(int32_t, 0, strcmp("1000", cmc_dump_format_unsigned(end, 1000)));
+        cmc_assert_equals(int32_t, 0,
+                          strcmp("18446744073709551615", cmc_dump_format_unsigned(end, UINT64_MAX)));
+        cmc_assert_equals(int32_t, 0, strcmp("-1", cmc_dump_format_signed(end, -1)));
+        cmc_assert_equals(int32_t, 0,
+                          strcmp("-9223372036854775808", cmc_dump_format_signed(end, INT64_MIN)));
+    });
+
+    CMC_CREATE_TEST(write, {
+        struct dump_list *list = dmp_l_new(100);
+
+        /* Spans many blocks of the buffer of write_fd */
+        for (int64_t i = 0; i < 100000; i++)
+            dmp_l_push_back(list, (i % 2 ? -i : i) * 1234567);
+
+        FILE *file = fopen(dmp_path, "w");
+
+        cmc_assert_not_equals(ptr, NULL, file);
+        cmc_assert(dmp_l_write(list, file, cmc_fdump_int64_t));
+        fclose(file);
+        cmc_assert(dmp_check_list(list));
+
+        int fd = open(dmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+        cmc_assert(fd >= 0);
+        cmc_assert(dmp_l_write_fd(list, fd, cmc_dump_int64_t));
+        close(fd);
+        cmc_assert(dmp_check_list(list));
+
+        /* Not a valid file descriptor */
+        cmc_assert(!dmp_l_write_fd(list, -1, cmc_dump_int64_t));
+
+        dmp_l_free(list, NULL);
+        remove(dmp_path);
+    });
+
+    CMC_CREATE_TEST(write[map], {
+        struct dump_treemap *map = dmp_tm_new(cmp);
+        char line[64];
+
+        for (size_t i = 0; i < 3; i++)
+            dmp_tm_insert(map, i, i * 100);
+
+        int fd = open(dmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+        cmc_assert(fd >= 0);
+        cmc_assert(dmp_tm_write_fd(map, fd, dmp_entry));
+        close(fd);
+
+        FILE *file = fopen(dmp_path, "a+");
+
+        cmc_assert_not_equals(ptr, NULL, file);
+        cmc_assert(dmp_tm_write(map, file, dmp_fentry));
+        rewind(file);
+
+        for (size_t i = 0; i < 6; i++)
+        {
+            char expected[64];
+
+            snprintf(expected, sizeof(expected), "%zu=%zu\n", i % 3, i % 3 * 100);
+            cmc_assert(fgets(line, sizeof(line), file) != NULL);
+            cmc_assert_equals(int32_t, 0, strcmp(expected, line));
+        }
+
+        cmc_assert(fgets(line, sizeof(line), file) == NULL);
+
+        fclose(file);
+        dmp_tm_free(map, NULL);
+        remove(dmp_path);
+    });
+});
@@ -0,0 +1,185 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/flatmap.h>
+
+CMC_GENERATE_FLATMAP(flm, flatmap, size_t, size_t)
+CMC_GENERATE_FLATMAP_BITWISE(flmb, flatmap_bitwise, size_t, size_t)
+
+CMC_CREATE_UNIT(flatmap_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct flatmap *m = flm_new(16, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, m);
+        cmc_assert_equals(size_t, 16, flm_capacity(m));
+        cmc_assert(flm_empty(m));
+
+        flm_free(m, NULL);
+
+        cmc_assert_equals(ptr, NULL, flm_new(16, NULL));
+    });
+
+    CMC_CREATE_TEST(insert remove, {
+        struct flatmap *m = flm_new(0, cmp);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(flm_insert(m, (i * 37) % 100, i));
+
+        cmc_assert(!flm_insert(m, 37, 0));
+        cmc_assert_equals(size_t, 100, flm_count(m));
+        cmc_assert_equals(size_t, 1, flm_get(m, 37));
+        cmc_assert_equals(ptr, NULL, flm_get_ref(m, 100));
+
+        bool sorted = true;
+        size_t *keys = flm_keys(m);
+
+        for (size_t i = 0; i < 100; i++)
+            sorted = sorted && keys[i] == i;
+
+        cmc_assert(sorted);
+
+        size_t value = 0;
+
+        cmc_assert(flm_update(m, 37, 1000, &value));
+        cmc_assert_equals(size_t, 1, value);
+        cmc_assert_equals(size_t, 1000, flm_get(m, 37));
+        cmc_assert(!flm_update(m, 100, 0, NULL));
+
+        cmc_assert(flm_remove(m, 0, &value));
+        cmc_assert_equals(size_t, 0, value);
+        cmc_assert(!flm_remove(m, 0, NULL));
+        cmc_assert(!flm_contains(m, 0));
+
+        size_t key = 0;
+
+        cmc_assert(flm_min(m, &key, NULL));
+        cmc_assert_equals(size_t, 1, key);
+        cmc_assert(flm_max(m, &key, &value));
+        cmc_assert_equals(size_t, 99, key);
+
+        // Removals shrink the arrays
+        for (size_t i = 1; i < 95; i++)
+            cmc_assert(flm_remove(m, i, NULL));
+
+        cmc_assert_equals(size_t, 5, flm_count(m));
+        cmc_assert_lesser(size_t, 32, flm_capacity(m));
+        cmc_assert(flm_contains(m, 97));
+
+        flm_free(m, NULL);
+    });
+
+    CMC_CREATE_TEST(append freeze[count allocations], {
+        count_alloc_reset();
+
+        struct flatmap *m = flm_new_custom(0, cmp, &count_alloc);
+
+        for (size_t i = 0; i < 300; i++)
+            cmc_assert(flm_append(m, (i * 7) % 200, i));
+
+        cmc_assert_equals(size_t, 300, flm_count(m));
+        cmc_assert(flm_freeze(m, NULL));
+
+        // Repeated keys keep the value appended last
+        cmc_assert_equals(size_t, 200, flm_count(m));
+        cmc_assert_equals(size_t, 200, flm_capacity(m));
+        cmc_assert_equals(size_t, 200, flm_get(m, 0));
+        cmc_assert_equals(size_t, 201, flm_get(m, 7));
+        cmc_assert_equals(size_t, 100, flm_get(m, 100));
+        cmc_assert_equals(size_t, 3, count_alloc_live);
+
+        // Appended entries are sorted by the next lookup
+        cmc_assert(flm_append(m, 500, 1));
+        cmc_assert(flm_append(m, 0, 2));
+        cmc_assert_equals(size_t, 2, flm_get(m, 0));
+        cmc_assert_equals(size_t, 201, flm_count(m));
+
+        size_t key = 0;
+
+        cmc_assert(flm_max(m, &key, NULL));
+        cmc_assert_equals(size_t, 500, key);
+
+        flm_free(m, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(bitwise, {
+        struct flatmap_bitwise *m = flmb_new(0, cmp);
+
+        for (size_t i = 0; i < 100; i++)
+        {
+            cmc_assert(flmb_insert(m, i * 3, i));
+
+            // Linear search first and binary search after the threshold
+            cmc_assert(flmb_contains(m, i * 3));
+            cmc_assert(!flmb_contains(m, i * 3 + 1));
+            cmc_assert_equals(size_t, i / 2, flmb_get(m, (i / 2) * 3));
+        }
+
+        cmc_assert(flmb_remove(m, 30, NULL));
+        cmc_assert(!flmb_contains(m, 30));
+        cmc_assert_equals(size_t, 11, flmb_get(m, 33));
+
+        flmb_free(m, NULL);
+    });
+
+    CMC_CREATE_TEST(copy_of equals, {
+        struct flatmap *m1 = flm_new(0, cmp);
+
+        for (size_t i = 0; i < 20; i++)
+            flm_append(m1, 20 - i, i);
+
+        struct flatmap *m2 = flm_copy_of(m1, NULL, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, m2);
+        cmc_assert(flm_equals(m1, m2, cmp));
+
+        flm_update(m2, 5, 100, NULL);
+
+        cmc_assert(flm_equals(m1, m2, NULL));
+        cmc_assert(!flm_equals(m1, m2, cmp));
+
+        flm_remove(m2, 5, NULL);
+
+        cmc_assert(!flm_equals(m1, m2, NULL));
+
+        flm_free(m1, NULL);
+        flm_free(m2, NULL);
+    });
+
+    CMC_CREATE_TEST(iteration, {
+        struct flatmap *m = flm_new(0, cmp);
+        struct flatmap_iter iter;
+
+        flm_iter_init(&iter, m);
+
+        cmc_assert(flm_iter_start(&iter));
+        cmc_assert(flm_iter_end(&iter));
+
+        for (size_t i = 0; i < 6; i++)
+            flm_append(m, 5 - i, 5 - i);
+
+        size_t expected = 0;
+        bool ordered = true;
+
+        for (flm_iter_init(&iter, m); !flm_iter_end(&iter); flm_iter_next(&iter))
+        {
+            ordered = ordered && flm_iter_key(&iter) == expected;
+            ordered = ordered && flm_iter_value(&iter) == expected;
+            ordered = ordered && flm_iter_index(&iter) == expected++;
+        }
+
+        cmc_assert(ordered);
+        cmc_assert_equals(size_t, 6, expected);
+
+        for (flm_iter_to_end(&iter); !flm_iter_start(&iter); flm_iter_prev(&iter))
+            ordered = ordered && *flm_iter_rvalue(&iter) == --expected;
+
+        cmc_assert(ordered);
+        cmc_assert_equals(size_t, 0, expected);
+
+        flm_free(m, NULL);
+    });
+});
@@ -0,0 +1,168 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/frozenhashmap.h>
+
+CMC_GENERATE_HASHMAP(fhm, frozen_hashmap, size_t, size_t)
+CMC_GENERATE_FROZEN_HASHMAP(fhm, frozen_hashmap, size_t, size_t)
+CMC_GENERATE_HASHMAP_SMALL(fhms, frozen_hashmap_small, size_t, size_t)
+CMC_GENERATE_FROZEN_HASHMAP(fhms, frozen_hashmap_small, size_t, size_t)
+
+CMC_CREATE_UNIT(frozenhashmap_test, true, {
+    CMC_CREATE_TEST(freeze, {
+        struct frozen_hashmap *map = fhm_new(100, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 10000; i++)
+            cmc_assert(fhm_insert(map, i, i * 2));
+
+        struct frozen_hashmap_frozen *frozen = fhm_freeze(map);
+
+        cmc_assert_not_equals(ptr, NULL, frozen);
+        cmc_assert_equals(size_t, 10000, fhm_frozen_count(frozen));
+        cmc_assert(!fhm_frozen_empty(frozen));
+
+        for (size_t i = 0; i < 10000; i++)
+            cmc_assert_equals(size_t, i * 2, fhm_frozen_get(frozen, i));
+
+        for (size_t i = 10000; i < 20000; i++)
+            cmc_assert(!fhm_frozen_contains(frozen, i));
+
+        /* The frozen map is a copy */
+        fhm_clear(map, NULL);
+
+        cmc_assert(fhm_frozen_contains(frozen, 1));
+
+        fhm_free(map, NULL);
+        fhm_frozen_free(frozen, NULL);
+    });
+
+    CMC_CREATE_TEST(freeze[count allocations], {
+        count_alloc_reset();
+
+        struct frozen_hashmap *map = fhm_new_custom(100, 0.6, cmp, hash, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(fhm_insert(map, i, i));
+
+        size_t live = count_alloc_live;
+
+        struct frozen_hashmap_frozen *frozen = fhm_freeze(map);
+
+        cmc_assert_not_equals(ptr, NULL, frozen);
+        cmc_assert_greater(size_t, live, count_alloc_live);
+
+        fhm_free(map, NULL);
+        fhm_frozen_free(frozen, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(freeze[empty], {
+        struct frozen_hashmap *map = fhm_new(100, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        struct frozen_hashmap_frozen *frozen = fhm_freeze(map);
+
+        cmc_assert_not_equals(ptr, NULL, frozen);
+        cmc_assert(fhm_frozen_empty(frozen));
+        cmc_assert(!fhm_frozen_contains(frozen, 0));
+        cmc_assert_equals(ptr, NULL, fhm_frozen_get_ref(frozen, 0));
+
+        fhm_free(map, NULL);
+        fhm_frozen_free(frozen, NULL);
+    });
+
+    CMC_CREATE_TEST(freeze[same hash], {
+        struct frozen_hashmap *map = fhm_new(100, 0.6, cmp, hash0);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        cmc_assert(fhm_insert(map, 1, 1));
+        cmc_assert(fhm_insert(map, 2, 2));
+
+        cmc_assert_equals(ptr, NULL, fhm_freeze(map));
+
+        fhm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(freeze[small], {
+        struct frozen_hashmap_small *map = fhms_new(4, 0.6, cmp, numhash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 1; i <= 5; i++)
+            cmc_assert(fhms_insert(map, i, i));
+
+        struct frozen_hashmap_small_frozen *frozen = fhms_freeze(map);
+
+        cmc_assert_not_equals(ptr, NULL, frozen);
+        cmc_assert_equals(size_t, 5, fhms_frozen_count(frozen));
+
+        for (size_t i = 1; i <= 5; i++)
+            cmc_assert_equals(size_t, i, fhms_frozen_get(frozen, i));
+
+        cmc_assert(!fhms_frozen_contains(frozen, 0));
+        cmc_assert(!fhms_frozen_contains(frozen, 6));
+
+        fhms_free(map, NULL);
+        fhms_frozen_free(frozen, NULL);
+    });
+
+    CMC_CREATE_TEST(get_ref, {
+        struct frozen_hashmap *map = fhm_new(100, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(fhm_insert(map, i, i));
+
+        struct frozen_hashmap_frozen *frozen = fhm_freeze(map);
+
+        cmc_assert_not_equals(ptr, NULL, frozen);
+
+        size_t *value = fhm_frozen_get_ref(frozen, 50);
+
+        cmc_assert_not_equals(ptr, NULL, value);
+
+        *value = 500;
+
+        cmc_assert_equals(size_t, 500, fhm_frozen_get(frozen, 50));
+        cmc_assert_equals(size_t, 50, fhm_get(map, 50));
+        cmc_assert_equals(ptr, NULL, fhm_frozen_get_ref(frozen, 100));
+
+        fhm_free(map, NULL);
+        fhm_frozen_free(frozen, NULL);
+    });
+
+    CMC_CREATE_TEST(stats, {
+        struct frozen_hashmap *map = fhm_new(100, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(fhm_insert(map, i, i));
+
+        struct frozen_hashmap_frozen *frozen = fhm_freeze(map);
+
+        cmc_assert_not_equals(ptr, NULL, frozen);
+
+        struct cmc_hashtable_stats stats;
+
+        fhm_frozen_stats(frozen, &stats);
+
+        cmc_assert_equals(size_t, 1000, stats.capacity);
+        cmc_assert_equals(size_t, 1000, stats.count);
+        cmc_assert_equals(size_t, 0, stats.max_dist);
+        cmc_assert_equals(size_t, 1000, stats.histogram[0]);
+
+        fhm_free(map, NULL);
+        fhm_frozen_free(frozen, NULL);
+    });
+});
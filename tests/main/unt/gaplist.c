@@ -0,0 +1,220 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/gaplist.h>
+#include <cmc/list.h>
+
+CMC_GENERATE_GAPLIST(gl, gaplist, size_t)
+CMC_GENERATE_LIST(gll, gaplist_reference, size_t)
+
+/* If both lists have the same elements in the same order */
+static bool gaplist_same(struct gaplist *list, struct gaplist_reference *reference)
+{
+    if (gl_count(list) != gll_count(reference))
+        return false;
+
+    for (size_t i = 0; i < gl_count(list); i++)
+    {
+        if (gl_get(list, i) != gll_get(reference, i))
+            return false;
+    }
+
+    return true;
+}
+
+CMC_CREATE_UNIT(gaplist_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct gaplist *l = gl_new(100);
+
+        cmc_assert_not_equals(ptr, NULL, l);
+        cmc_assert_not_equals(ptr, NULL, l->buffer);
+        cmc_assert_equals(size_t, 100, gl_capacity(l));
+        cmc_assert(gl_empty(l));
+        cmc_assert_equals(size_t, 0, gl_front(l));
+        cmc_assert(!gl_pop_back(l));
+
+        gl_free(l, NULL);
+
+        cmc_assert_equals(ptr, NULL, gl_new(0));
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct gaplist *l = gl_new_custom(100, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, l);
+
+        for (size_t i = 0; i < 1000; i++)
+            gl_push_back(l, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        gl_free(l, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(push and pop, {
+        struct gaplist *l = gl_new(2);
+
+        cmc_assert_not_equals(ptr, NULL, l);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(gl_push_back(l, i));
+
+        cmc_assert(gl_push_front(l, 1000));
+        cmc_assert(gl_push_at(l, 2000, 50));
+        cmc_assert(!gl_push_at(l, 0, 103));
+
+        cmc_assert_equals(size_t, 102, gl_count(l));
+        cmc_assert_equals(size_t, 1000, gl_front(l));
+        cmc_assert_equals(size_t, 2000, gl_get(l, 50));
+        cmc_assert_equals(size_t, 48, gl_get(l, 49));
+        cmc_assert_equals(size_t, 49, gl_get(l, 51));
+        cmc_assert_equals(size_t, 99, gl_back(l));
+
+        cmc_assert(gl_pop_at(l, 50));
+        cmc_assert(gl_pop_front(l));
+        cmc_assert(!gl_pop_at(l, 100));
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert_equals(size_t, i, gl_get(l, i));
+
+        *gl_get_ref(l, 10) = 500;
+
+        cmc_assert_equals(size_t, 10, gl_indexof(l, 500, cmp, true));
+        cmc_assert(gl_contains(l, 99, cmp));
+        cmc_assert(!gl_contains(l, 100, cmp));
+
+        size_t elements[3];
+
+        for (size_t i = 0; i < 3; i++)
+            elements[i] = i + 7;
+
+        cmc_assert(gl_seq_push_at(l, elements, 3, 20));
+        cmc_assert_equals(size_t, 8, gl_get(l, 21));
+        cmc_assert(gl_seq_pop_at(l, 20, 22));
+        cmc_assert(!gl_seq_pop_at(l, 5, 100));
+
+        while (!gl_empty(l))
+            cmc_assert(gl_pop_back(l));
+
+        cmc_assert(gl_capacity(l) < 100);
+
+        gl_free(l, NULL);
+    });
+
+    CMC_CREATE_TEST(localized edits, {
+        struct gaplist *l = gl_new(16);
+        struct gaplist_reference *r = gll_new(16);
+
+        cmc_assert_not_equals(ptr, NULL, l);
+        cmc_assert_not_equals(ptr, NULL, r);
+
+        size_t cursor = 0;
+        size_t seed = 12345;
+
+        /* The cursor moves a few positions between edits, with a jump */
+        /* every few hundred */
+        for (size_t i = 0; i < 20000; i++)
+        {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+
+            size_t roll = (seed >> 33) % 100;
+
+            if (i % 500 == 0)
+                cursor = gl_count(l) > 0 ? (seed >> 13) % gl_count(l) : 0;
+            else if (roll < 20 && cursor > 0)
+                cursor--;
+            else if (roll < 40 && cursor < gl_count(l))
+                cursor++;
+
+            if (roll < 75 || gl_empty(l))
+            {
+                cmc_assert(gl_push_at(l, i, cursor));
+                cmc_assert(gll_push_at(r, i, cursor));
+                cursor++;
+            }
+            else
+            {
+                if (cursor == gl_count(l))
+                    cursor--;
+
+                cmc_assert(gl_pop_at(l, cursor));
+                cmc_assert(gll_pop_at(r, cursor));
+            }
+        }
+
+        cmc_assert(gaplist_same(l, r));
+
+        cmc_assert(gl_move_gap(l, 0));
+        cmc_assert(gaplist_same(l, r));
+        cmc_assert(gl_move_gap(l, gl_count(l)));
+        cmc_assert(gaplist_same(l, r));
+        cmc_assert(!gl_move_gap(l, gl_count(l) + 1));
+
+        gl_free(l, NULL);
+        gll_free(r, NULL);
+    });
+
+    CMC_CREATE_TEST(resize, {
+        struct gaplist *l = gl_new(100);
+
+        cmc_assert_not_equals(ptr, NULL, l);
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert(gl_push_back(l, i));
+
+        /* The elements after the gap have to stay at the end */
+        cmc_assert(gl_move_gap(l, 20));
+        cmc_assert(gl_reserve(l, 1000));
+        cmc_assert(gl_reserve(l, 10));
+        cmc_assert_equals(size_t, 1000, gl_capacity(l));
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert_equals(size_t, i, gl_get(l, i));
+
+        cmc_assert(gl_shrink_to_fit(l));
+        cmc_assert(gl_full(l));
+        cmc_assert(!gl_resize(l, 49));
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert_equals(size_t, i, gl_get(l, i));
+
+        gl_free(l, NULL);
+    });
+
+    CMC_CREATE_TEST(iter, {
+        struct gaplist *l = gl_new(10);
+
+        cmc_assert_not_equals(ptr, NULL, l);
+
+        for (size_t i = 0; i < 30; i++)
+            cmc_assert(gl_push_at(l, i, i / 2));
+
+        struct gaplist_iter iter;
+
+        size_t total = 0;
+
+        for (gl_iter_init(&iter, l); !gl_iter_end(&iter); gl_iter_next(&iter))
+        {
+            cmc_assert_equals(size_t, gl_get(l, total), gl_iter_value(&iter));
+            cmc_assert_equals(size_t, total, gl_iter_index(&iter));
+            total++;
+        }
+
+        cmc_assert_equals(size_t, 30, total);
+
+        gl_iter_to_end(&iter);
+
+        cmc_assert(gl_iter_rewind(&iter, 29));
+        cmc_assert(gl_iter_start(&iter) || gl_iter_index(&iter) == 0);
+        cmc_assert(gl_iter_go_to(&iter, 15));
+        cmc_assert_equals(size_t, gl_get(l, 15), *gl_iter_rvalue(&iter));
+
+        gl_free(l, NULL);
+    });
+});
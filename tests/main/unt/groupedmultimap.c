@@ -0,0 +1,200 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/groupedmultimap.h>
+
+CMC_GENERATE_GROUPED_MULTIMAP(gmm, groupedmultimap, size_t, size_t)
+
+static size_t gmm_deallocated = 0;
+
+static void gmm_deallocator(size_t key, size_t *values, size_t n)
+{
+    (void)key;
+    (void)values;
+
+    gmm_deallocated += n;
+}
+
+CMC_CREATE_UNIT(groupedmultimap_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct groupedmultimap *map = gmm_new(100, 0.8, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+        cmc_assert_equals(size_t, 0, gmm_count(map));
+        cmc_assert_equals(size_t, 0, gmm_keys(map));
+        cmc_assert(gmm_empty(map));
+
+        gmm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct groupedmultimap *map = gmm_new_custom(100, 0.8, cmp, hash, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            gmm_insert(map, i % 10, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        gmm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(new[capacity = 0], {
+        struct groupedmultimap *map = gmm_new(0, 0.8, cmp, hash);
+
+        cmc_assert_equals(ptr, NULL, map);
+    });
+
+    CMC_CREATE_TEST(insert[count key_count], {
+        struct groupedmultimap *map = gmm_new(1, 0.8, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(gmm_insert(map, i % 20, i));
+
+        cmc_assert_equals(size_t, 1000, gmm_count(map));
+        cmc_assert_equals(size_t, 20, gmm_keys(map));
+
+        for (size_t i = 0; i < 20; i++)
+            cmc_assert_equals(size_t, 50, gmm_key_count(map, i));
+
+        cmc_assert_equals(size_t, 0, gmm_key_count(map, 20));
+
+        gmm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(stats, {
+        struct groupedmultimap *map = gmm_new(100, 0.8, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 30; i++)
+            cmc_assert(gmm_insert(map, i % 10, i));
+
+        struct cmc_hashtable_stats stats;
+        struct cmc_hashtable_stats groups_stats;
+
+        gmm_stats(map, &stats);
+        gmm_groups_stats(map->groups, &groups_stats);
+
+        // Only distinct keys are entries of the hashtable
+        cmc_assert_equals(size_t, 10, stats.count);
+        cmc_assert_equals(size_t, groups_stats.bytes + sizeof(struct groupedmultimap) +
+                                      sizeof(size_t) * CMC_GROUPED_MULTIMAP_GROUP_SIZE * 10,
+                          stats.bytes);
+
+        gmm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(get_all[insertion order], {
+        struct groupedmultimap *map = gmm_new(1, 0.8, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(gmm_insert(map, i % 7, i));
+
+        size_t *values;
+        size_t n;
+
+        for (size_t k = 0; k < 7; k++)
+        {
+            cmc_assert(gmm_get_all(map, k, &values, &n));
+            cmc_assert_equals(size_t, gmm_key_count(map, k), n);
+
+            for (size_t i = 0; i < n; i++)
+                cmc_assert_equals(size_t, k + i * 7, values[i]);
+        }
+
+        cmc_assert(!gmm_get_all(map, 7, &values, &n));
+        cmc_assert_equals(ptr, NULL, values);
+        cmc_assert_equals(size_t, 0, n);
+
+        gmm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(remove[first in first out], {
+        struct groupedmultimap *map = gmm_new(100, 0.8, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 10; i++)
+            cmc_assert(gmm_insert(map, 1, i));
+
+        size_t r;
+
+        for (size_t i = 0; i < 10; i++)
+        {
+            cmc_assert_equals(size_t, i, gmm_get(map, 1));
+            cmc_assert(gmm_remove(map, 1, &r));
+            cmc_assert_equals(size_t, i, r);
+        }
+
+        cmc_assert(!gmm_remove(map, 1, &r));
+        cmc_assert(!gmm_contains(map, 1));
+        cmc_assert_equals(size_t, 0, gmm_keys(map));
+        cmc_assert(gmm_empty(map));
+
+        gmm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(remove_all, {
+        struct groupedmultimap *map = gmm_new(100, 0.8, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 300; i++)
+            cmc_assert(gmm_insert(map, i % 3, i));
+
+        size_t *values;
+
+        cmc_assert_equals(size_t, 100, gmm_remove_all(map, 1, &values));
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert_equals(size_t, 1 + i * 3, values[i]);
+
+        free(values);
+
+        cmc_assert_equals(size_t, 100, gmm_remove_all(map, 2, NULL));
+        cmc_assert_equals(size_t, 0, gmm_remove_all(map, 2, NULL));
+
+        cmc_assert_equals(size_t, 100, gmm_count(map));
+        cmc_assert_equals(size_t, 1, gmm_keys(map));
+
+        gmm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(clear[deallocator], {
+        struct groupedmultimap *map = gmm_new(100, 0.8, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 300; i++)
+            cmc_assert(gmm_insert(map, i % 120, i));
+
+        gmm_deallocated = 0;
+
+        gmm_clear(map, gmm_deallocator);
+
+        cmc_assert_equals(size_t, 300, gmm_deallocated);
+        cmc_assert_equals(size_t, 0, gmm_count(map));
+        cmc_assert_equals(size_t, 0, gmm_keys(map));
+
+        cmc_assert(gmm_insert(map, 1, 1));
+        cmc_assert_equals(size_t, 1, gmm_get(map, 1));
+
+        gmm_deallocated = 0;
+
+        gmm_free(map, gmm_deallocator);
+
+        cmc_assert_equals(size_t, 1, gmm_deallocated);
+    });
+});
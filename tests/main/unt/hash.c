@@ -0,0 +1,85 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <utl/hash.h>
+
+/* Published vectors of wyhash, each one with its index as the seed */
+static const char *hash_messages[] = { "", "a", "abc", "message digest",
+                                       "abcdefghijklmnopqrstuvwxyz" };
+
+static const uint64_t hash_expected[] = { UINT64_C(0x0409638ee2bde459),
+                                          UINT64_C(0xa8412d091b5fe0a9),
+                                          UINT64_C(0x32dd92e4b2915153),
+                                          UINT64_C(0x8619124089a3a16b),
+                                          UINT64_C(0x7a43afb61d7f5f40) };
+
+static char hash_key[] = "key";
+
+CMC_GENERATE_HASHMAP(hhm, hash_hashmap, size_t, size_t)
+
+CMC_CREATE_UNIT(hash_test, true, {
+    CMC_CREATE_TEST(bytes[test vectors], {
+        for (size_t i = 0; i < 5; i++)
+            cmc_assert_equals(uint64_t, hash_expected[i],
+                              cmc_hash_bytes_seed(hash_messages[i], strlen(hash_messages[i]), i));
+    });
+
+    CMC_CREATE_TEST(bytes[every length], {
+        uint8_t buffer[128];
+
+        memset(buffer, 0, sizeof(buffer));
+
+        // Changing one byte changes the hash, on every branch of the function
+        for (size_t len = 1; len <= 128; len++)
+        {
+            uint64_t before = cmc_hash_bytes(buffer, len);
+
+            buffer[len / 2] ^= 1;
+
+            cmc_assert_not_equals(uint64_t, before, cmc_hash_bytes(buffer, len));
+
+            buffer[len / 2] ^= 1;
+
+            cmc_assert_equals(uint64_t, before, cmc_hash_bytes(buffer, len));
+        }
+    });
+
+    CMC_CREATE_TEST(seed, {
+        cmc_assert_not_equals(size_t, cmc_hash_str_seed(hash_key, 1), cmc_hash_str_seed(hash_key, 2));
+        cmc_assert_not_equals(uint64_t, cmc_hash_u64_seed(1, 1), cmc_hash_u64_seed(1, 2));
+        cmc_assert_not_equals(uint32_t, cmc_hash_crc32c_seed(hash_key, 3, 1),
+                              cmc_hash_crc32c_seed(hash_key, 3, 2));
+        cmc_assert_equals(size_t, cmc_hash_str(hash_key), cmc_hash_bytes(hash_key, 3));
+    });
+
+    CMC_CREATE_TEST(crc32c, {
+        cmc_assert_equals(uint32_t, UINT32_C(0xE3069283), cmc_hash_crc32c("123456789", 9));
+        cmc_assert_equals(uint32_t, 0, cmc_hash_crc32c("", 0));
+
+        // The CRC of a prefix is the seed to continue with the rest
+        uint32_t crc = cmc_hash_crc32c("1234", 4);
+
+        cmc_assert_equals(uint32_t, UINT32_C(0xE3069283), cmc_hash_crc32c_seed("56789", 5, crc));
+    });
+
+    CMC_CREATE_TEST(u64[hashmap distances], {
+        struct hash_hashmap *map = hhm_new(10000, 0.6, cmp, cmc_hash_size);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        // Keys that only differ in their upper bits
+        for (size_t i = 0; i < 10000; i++)
+            cmc_assert(hhm_insert(map, i << 20, i));
+
+        struct cmc_hashtable_stats stats;
+
+        hhm_stats(map, &stats);
+
+        cmc_assert_lesser_equals(double, 1.0, stats.mean_dist);
+        cmc_assert_lesser_equals(size_t, 32, stats.max_dist);
+
+        hhm_free(map, NULL);
+    });
+});
@@ -4,8 +4,46 @@
 #include <utl/test.h>
 
 #include <cmc/hashmap.h>
+#include <utl/cmc_callback.h>
 
 CMC_GENERATE_HASHMAP(hm, hashmap, size_t, size_t)
+CMC_GENERATE_HASHMAP_POW2(hmp, hashmap_pow2, size_t, size_t)
+CMC_GENERATE_HASHMAP_CACHED(hmc, hashmap_cached, size_t, size_t)
+CMC_GENERATE_HASHMAP_INCREMENTAL(hmi, hashmap_incremental, size_t, size_t)
+CMC_GENERATE_HASHMAP_EX(hmx, hashmap_ex, size_t, size_t, cmp, counthash)
+CMC_GENERATE_HASHMAP_SMALL(hms, hashmap_small, size_t, size_t)
+CMC_GENERATE_HASHMAP_SOA(hma, hashmap_soa, size_t, size_t)
+
+static size_t hm_twice(size_t value)
+{
+    return value * 2;
+}
+
+static size_t hm_sum(size_t a, size_t b)
+{
+    return a + b;
+}
+
+#define hm_key_below_100(key, value) ((key) < 100)
+#define hm_value_plus_key(key, value) ((value) + (key))
+#define hm_sum_entry(a, key, value) ((a) + (key) + (value))
+
+CMC_GENERATE_HASHMAP_FILTER(hmi, hashmap_incremental, size_t, size_t, below_100, hm_key_below_100)
+CMC_GENERATE_HASHMAP_MAP(hmi, hashmap_incremental, size_t, size_t, plus_key, hm_value_plus_key)
+CMC_GENERATE_HASHMAP_FOLD(hmi, hashmap_incremental, size_t, size_t, sum, size_t, hm_sum_entry)
+CMC_GENERATE_HASHMAP_FOLD_VALUES(hma, hashmap_soa, size_t, size_t, sum, size_t, hm_sum)
+
+static size_t hm_deallocated = 0;
+
+static void hm_count_deallocator(size_t key, size_t value)
+{
+    hm_deallocated++;
+}
+
+static bool hm_odd_key(size_t key, size_t value)
+{
+    return key % 2 == 1;
+}
 
 CMC_CREATE_UNIT(hashmap_test, true, {
     CMC_CREATE_TEST(new, {
@@ -19,6 +57,23 @@ CMC_CREATE_UNIT(hashmap_test, true, {
         hm_free(map, NULL);
     });
 
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct hashmap *map = hm_new_custom(100, 0.6, cmp, hash, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            hm_insert(map, i, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        hm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
     CMC_CREATE_TEST(new[capacity = 0], {
         struct hashmap *map = hm_new(0, 0.6, cmp, hash);
 
@@ -89,6 +144,27 @@ CMC_CREATE_UNIT(hashmap_test, true, {
         hm_free(map, NULL);
     });
 
+    CMC_CREATE_TEST(insert[prime position], {
+        // The fastmod reduction places every key where the modulo would
+        struct hashmap *map = hm_new(5000, 0.6, cmp, numhash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        size_t capacity = hm_capacity(map);
+
+        cmc_assert_equals(size_t, cmc_hashtable_prime_size((size_t)(5000 / 0.6)), capacity);
+
+        for (size_t i = 0; i < 64; i++)
+        {
+            size_t key = SIZE_MAX - i * (SIZE_MAX / 64);
+
+            cmc_assert(hm_insert(map, key, i));
+            cmc_assert_equals(size_t, key, map->buffer[key % capacity].key);
+        }
+
+        hm_free(map, NULL);
+    });
+
     CMC_CREATE_TEST(insert[distance], {
         struct hashmap *map = hm_new(500, 0.6, cmp, hash0);
 
@@ -164,6 +240,149 @@ CMC_CREATE_UNIT(hashmap_test, true, {
         hm_free(map, NULL);
     });
 
+    CMC_CREATE_TEST(insert_many, {
+        struct hashmap *map = hm_new(1, 0.9, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        size_t keys[1000];
+        size_t values[1000];
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            keys[i] = i % 800;
+            values[i] = i;
+        }
+
+        size_t capacity = hm_capacity(map);
+
+        cmc_assert(hm_insert(map, 0, 0));
+        cmc_assert_equals(size_t, 799, hm_insert_many(map, keys, values, 1000));
+
+        /* Grown once for all of the keys */
+        cmc_assert_greater_equals(size_t, (size_t)(1001 / 0.9), hm_capacity(map));
+        cmc_assert_not_equals(size_t, capacity, hm_capacity(map));
+        cmc_assert_equals(size_t, 800, hm_count(map));
+
+        for (size_t i = 0; i < 800; i++)
+            cmc_assert_equals(size_t, i, hm_get(map, i));
+
+        cmc_assert_equals(size_t, 0, hm_insert_many(map, keys, values, 0));
+
+        hm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(get_or_insert[counter], {
+        struct hashmap *map = hm_new(1, 0.9, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            size_t *counter = hm_get_or_insert(map, i % 100, 0);
+
+            cmc_assert_not_equals(ptr, NULL, counter);
+
+            *counter += 1;
+        }
+
+        cmc_assert_equals(size_t, 100, hm_count(map));
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert_equals(size_t, 10, hm_get(map, i));
+
+        hm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(upsert, {
+        struct hashmap *map = hm_new(100, 0.9, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        cmc_assert(hm_upsert(map, 1, 2));
+        cmc_assert_equals(size_t, 2, hm_get(map, 1));
+        cmc_assert(hm_upsert(map, 1, 3));
+        cmc_assert_equals(size_t, 3, hm_get(map, 1));
+        cmc_assert_equals(size_t, 1, hm_count(map));
+
+        hm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(merge, {
+        struct hashmap *map1 = hm_new(1, 0.9, cmp, hash);
+        struct hashmap *map2 = hm_new(1, 0.9, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map1);
+        cmc_assert_not_equals(ptr, NULL, map2);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(hm_insert(map1, i, 1));
+
+        for (size_t i = 500; i < 2000; i++)
+            cmc_assert(hm_insert(map2, i, 2));
+
+        cmc_assert(hm_merge(map1, map2, hm_sum));
+        cmc_assert_equals(size_t, 2000, hm_count(map1));
+        cmc_assert_equals(size_t, 1500, hm_count(map2));
+
+        for (size_t i = 0; i < 2000; i++)
+            cmc_assert_equals(size_t, i < 500 ? 1 : i < 1000 ? 3 : 2, hm_get(map1, i));
+
+        // Without combine the values of the map are kept
+        cmc_assert(hm_merge(map2, map1, NULL));
+        cmc_assert_equals(size_t, 2000, hm_count(map2));
+        cmc_assert_equals(size_t, 1, hm_get(map2, 0));
+        cmc_assert_equals(size_t, 2, hm_get(map2, 600));
+
+        hm_free(map1, NULL);
+        hm_free(map2, NULL);
+    });
+
+    CMC_CREATE_TEST(merge_free, {
+        struct hashmap *maps[4];
+
+        for (size_t m = 0; m < 4; m++)
+        {
+            maps[m] = hm_new(1, 0.9, cmp, hash);
+
+            cmc_assert_not_equals(ptr, NULL, maps[m]);
+
+            for (size_t i = m * 100; i < m * 100 + 200; i++)
+                cmc_assert(hm_insert(maps[m], i, 1));
+        }
+
+        hm_deallocated = 0;
+
+        // Pairwise reduction, like the one of maps built by many threads
+        cmc_assert(hm_merge_free(maps[0], maps[1], hm_sum, hm_count_deallocator));
+        cmc_assert(hm_merge_free(maps[2], maps[3], hm_sum, hm_count_deallocator));
+        cmc_assert(hm_merge_free(maps[0], maps[2], hm_sum, hm_count_deallocator));
+
+        cmc_assert_equals(size_t, 500, hm_count(maps[0]));
+        cmc_assert_equals(size_t, 300, hm_deallocated);
+
+        for (size_t i = 0; i < 500; i++)
+            cmc_assert_equals(size_t, i < 100 || i >= 400 ? 1 : 2, hm_get(maps[0], i));
+
+        hm_free(maps[0], NULL);
+    });
+
+    CMC_CREATE_TEST(incremental[get_or_insert], {
+        struct hashmap_incremental *map = hmi_new(1, 0.9, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            *hmi_get_or_insert(map, i % 300, 0) += 1;
+
+        cmc_assert_equals(size_t, 300, hmi_count(map));
+
+        for (size_t i = 0; i < 300; i++)
+            cmc_assert_equals(size_t, i < 100 ? 4 : 3, hmi_get(map, i));
+
+        hmi_free(map, NULL);
+    });
+
     CMC_CREATE_TEST(update, {
         struct hashmap *map = hm_new(100, 0.6, cmp, hash);
 
@@ -206,6 +425,49 @@ CMC_CREATE_UNIT(hashmap_test, true, {
         hm_free(map, NULL);
     });
 
+    CMC_CREATE_TEST(remove[backward shift], {
+        struct hashmap *map = hm_new(500, 0.6, cmp, hash0);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 200; i++)
+            cmc_assert(hm_insert(map, i, i));
+
+        cmc_assert(hm_remove(map, 0, NULL));
+
+        // Every following key is moved one position back
+        for (size_t i = 0; i < 199; i++)
+        {
+            cmc_assert_equals(size_t, i + 1, map->buffer[i].key);
+            cmc_assert_equals(size_t, i, map->buffer[i].dist);
+        }
+
+        cmc_assert_equals(int32_t, CMC_ES_EMPTY, map->buffer[199].state);
+
+        cmc_assert(!hm_contains(map, 0));
+
+        for (size_t i = 1; i < 200; i++)
+            cmc_assert(hm_contains(map, i));
+
+        hm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(remove[key zero], {
+        struct hashmap *map = hm_new(100, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert(hm_insert(map, i, i));
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert(hm_remove(map, i, NULL));
+
+        cmc_assert(!hm_contains(map, 0));
+
+        hm_free(map, NULL);
+    });
+
     CMC_CREATE_TEST(remove[count = 0], {
         struct hashmap *map = hm_new(100, 0.6, cmp, hash);
 
@@ -231,6 +493,92 @@ CMC_CREATE_UNIT(hashmap_test, true, {
         hm_free(map, NULL);
     });
 
+    CMC_CREATE_TEST(remove[low water shrink], {
+        struct hashmap *map = hm_new(1, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(hm_insert(map, i, i));
+
+        size_t capacity = hm_capacity(map);
+
+        for (size_t i = 0; i < 990; i++)
+            cmc_assert(hm_remove(map, i, NULL));
+
+        cmc_assert(hm_capacity(map) < capacity);
+        cmc_assert_equals(size_t, 10, hm_count(map));
+
+        for (size_t i = 990; i < 1000; i++)
+            cmc_assert_equals(size_t, i, hm_get(map, i));
+
+        hm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(remove[low water hysteresis], {
+        // A table that shrinks must not be grown right back by a few inserts
+        for (size_t n = 100; n < 200; n++)
+        {
+            struct hashmap *map = hm_new(100, 0.3, cmp, hash);
+
+            cmc_assert_not_equals(ptr, NULL, map);
+
+            for (size_t i = 0; i < n; i++)
+                cmc_assert(hm_insert(map, i, i));
+
+            size_t changes = 0;
+            size_t capacity = hm_capacity(map);
+
+            for (size_t k = 0; k < 100; k++)
+            {
+                for (size_t i = 0; i < 3; i++)
+                    cmc_assert(hm_remove(map, i, NULL));
+
+                if (hm_capacity(map) != capacity)
+                    changes++;
+
+                capacity = hm_capacity(map);
+
+                for (size_t i = 0; i < 3; i++)
+                    cmc_assert(hm_insert(map, i, i));
+
+                if (hm_capacity(map) != capacity)
+                    changes++;
+
+                capacity = hm_capacity(map);
+            }
+
+            cmc_assert_lesser_equals(size_t, 2, changes);
+            cmc_assert_equals(size_t, n, hm_count(map));
+
+            hm_free(map, NULL);
+        }
+    });
+
+    CMC_CREATE_TEST(shrink_to_fit, {
+        struct hashmap *map = hm_new(1000, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 10; i++)
+            cmc_assert(hm_insert(map, i, i));
+
+        cmc_assert(hm_shrink_to_fit(map));
+
+        size_t capacity = hm_capacity(map);
+
+        cmc_assert(capacity < 1000);
+        cmc_assert(capacity * 0.6 >= 10);
+
+        for (size_t i = 0; i < 10; i++)
+            cmc_assert_equals(size_t, i, hm_get(map, i));
+
+        cmc_assert(hm_shrink_to_fit(map));
+        cmc_assert_equals(size_t, capacity, hm_capacity(map));
+
+        hm_free(map, NULL);
+    });
+
     CMC_CREATE_TEST(max, {
         struct hashmap *map = hm_new(100, 0.6, cmp, hash);
 
@@ -334,6 +682,54 @@ CMC_CREATE_UNIT(hashmap_test, true, {
         hm_free(map, NULL);
     });
 
+    CMC_CREATE_TEST(get_many, {
+        struct hashmap *map = hm_new(100, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 101; i <= 200; i++)
+            cmc_assert(hm_insert(map, i, i * 2));
+
+        size_t keys[300];
+        size_t values[300];
+        bool found[300];
+
+        for (size_t i = 0; i < 300; i++)
+            keys[i] = i + 1;
+
+        cmc_assert_equals(size_t, 100, hm_get_many(map, keys, 300, values, found));
+
+        for (size_t i = 0; i < 300; i++)
+        {
+            bool inside = keys[i] >= 101 && keys[i] <= 200;
+
+            cmc_assert_equals(bool, inside, found[i]);
+            cmc_assert_equals(size_t, inside ? keys[i] * 2 : 0, values[i]);
+        }
+
+        hm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(get_many[count = 0], {
+        struct hashmap *map = hm_new(100, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        size_t keys[3];
+        size_t values[3];
+
+        for (size_t i = 0; i < 3; i++)
+            keys[i] = i + 1;
+
+        cmc_assert_equals(size_t, 0, hm_get_many(map, keys, 3, values, NULL));
+        cmc_assert_equals(size_t, 0, hm_get_many(map, keys, 0, values, NULL));
+
+        for (size_t i = 0; i < 3; i++)
+            cmc_assert_equals(size_t, 0, values[i]);
+
+        hm_free(map, NULL);
+    });
+
     CMC_CREATE_TEST(contains, {
         struct hashmap *map = hm_new(100, 0.6, cmp, hash);
 
@@ -374,6 +770,32 @@ CMC_CREATE_UNIT(hashmap_test, true, {
         hm_free(map, NULL);
     });
 
+    CMC_CREATE_TEST(contains_many[sum], {
+        struct hashmap *map = hm_new(100, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 101; i <= 200; i++)
+            cmc_assert(hm_insert(map, i, i));
+
+        size_t keys[300];
+        bool found[300];
+
+        for (size_t i = 0; i < 300; i++)
+            keys[i] = i + 1;
+
+        cmc_assert_equals(size_t, 100, hm_contains_many(map, keys, 300, found));
+
+        size_t sum = 0;
+        for (size_t i = 0; i < 300; i++)
+            if (found[i])
+                sum += keys[i];
+
+        cmc_assert_equals(size_t, 15050, sum);
+
+        hm_free(map, NULL);
+    });
+
     CMC_CREATE_TEST(empty, {
         struct hashmap *map = hm_new(100, 0.6, cmp, hash);
 
@@ -452,4 +874,928 @@ CMC_CREATE_UNIT(hashmap_test, true, {
 
         hm_free(map, NULL);
     });
+
+    CMC_CREATE_TEST(stats, {
+        struct hashmap *map = hm_new(500, 0.6, cmp, hash0);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 200; i++)
+            cmc_assert(hm_insert(map, i, i));
+
+        struct cmc_hashtable_stats stats;
+
+        hm_stats(map, &stats);
+
+        // Everything is hashed to 0 so the distances go from 0 to 199
+        cmc_assert_equals(size_t, hm_capacity(map), stats.capacity);
+        cmc_assert_equals(size_t, 200, stats.count);
+        cmc_assert_equals(size_t, 0, stats.tombstones);
+        cmc_assert_equals(size_t, 199, stats.max_dist);
+        cmc_assert_in_range(double, 99.5 - 0.0001, 99.5 + 0.0001, stats.mean_dist);
+        cmc_assert_in_range(double, 0.0, 0.6, stats.load);
+
+        for (size_t i = 0; i < CMC_HASHTABLE_STATS_BUCKETS - 1; i++)
+            cmc_assert_equals(size_t, 1, stats.histogram[i]);
+
+        cmc_assert_equals(size_t, 200 - (CMC_HASHTABLE_STATS_BUCKETS - 1),
+                          stats.histogram[CMC_HASHTABLE_STATS_BUCKETS - 1]);
+        cmc_assert_lesser_equals(size_t, stats.bytes,
+                                 sizeof(struct hashmap_entry) * hm_capacity(map));
+
+        hm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(stats[incremental], {
+        struct hashmap_incremental *map = hmi_new(1000, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        size_t capacity = hmi_capacity(map);
+        size_t i = 0;
+
+        for (; hmi_capacity(map) == capacity; i++)
+            cmc_assert(hmi_insert(map, i, i));
+
+        cmc_assert_not_equals(ptr, NULL, map->old);
+
+        struct cmc_hashtable_stats stats;
+
+        hmi_stats(map, &stats);
+
+        // Entries that were not moved yet are still counted
+        size_t entries = 0;
+
+        for (size_t j = 0; j < CMC_HASHTABLE_STATS_BUCKETS; j++)
+            entries += stats.histogram[j];
+
+        cmc_assert_equals(size_t, i, stats.count);
+        cmc_assert_equals(size_t, i, entries);
+        cmc_assert_lesser_equals(size_t, stats.bytes,
+                                 sizeof(struct hashmap_incremental_entry) *
+                                     (hmi_capacity(map) + capacity));
+
+        hmi_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(entry[packed], {
+        // The distance and the state share a single unsigned int
+        cmc_assert_lesser_equals(size_t, 3 * sizeof(size_t), sizeof(struct hashmap_entry));
+
+        struct hashmap *map = hm_new(100, 0.6, cmp, hash0);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 1; i <= 100; i++)
+            cmc_assert(hm_insert(map, i, i));
+
+        cmc_assert_equals(int32_t, CMC_ES_FILLED, map->buffer[99].state);
+        cmc_assert_equals(size_t, 99, map->buffer[99].dist);
+
+        cmc_assert(hm_remove(map, 100, NULL));
+
+        cmc_assert_equals(int32_t, CMC_ES_EMPTY, map->buffer[99].state);
+
+        hm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(pow2[capacity], {
+        struct hashmap_pow2 *map = hmp_new(2500, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        size_t capacity = hmp_capacity(map);
+
+        cmc_assert_greater_equals(size_t, (size_t)(2500 / 0.6), capacity);
+        cmc_assert_equals(size_t, 0, capacity & (capacity - 1));
+
+        hmp_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(pow2[capacity small], {
+        struct hashmap_pow2 *map = hmp_new(1, 0.99, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        cmc_assert_equals(size_t, 64, hmp_capacity(map));
+
+        hmp_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(pow2[insert remove growth], {
+        struct hashmap_pow2 *map = hmp_new(1, 0.9, cmp, numhash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 1; i <= 5000; i++)
+            cmc_assert(hmp_insert(map, i, i * 2));
+
+        size_t capacity = hmp_capacity(map);
+
+        cmc_assert_equals(size_t, 5000, hmp_count(map));
+        cmc_assert_equals(size_t, 0, capacity & (capacity - 1));
+
+        for (size_t i = 1; i <= 5000; i++)
+            cmc_assert_equals(size_t, i * 2, hmp_get(map, i));
+
+        for (size_t i = 2; i <= 5000; i += 2)
+            cmc_assert(hmp_remove(map, i, NULL));
+
+        cmc_assert_equals(size_t, 2500, hmp_count(map));
+
+        for (size_t i = 1; i <= 5000; i++)
+            cmc_assert_equals(bool, i % 2 == 1, hmp_contains(map, i));
+
+        hmp_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(cached[insert remove growth], {
+        struct hashmap_cached *map = hmc_new(1, 0.9, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 1; i <= 5000; i++)
+            cmc_assert(hmc_insert(map, i, i * 2));
+
+        cmc_assert_equals(size_t, 5000, hmc_count(map));
+
+        for (size_t i = 1; i <= 5000; i++)
+            cmc_assert_equals(size_t, i * 2, hmc_get(map, i));
+
+        for (size_t i = 2; i <= 5000; i += 2)
+            cmc_assert(hmc_remove(map, i, NULL));
+
+        cmc_assert_equals(size_t, 2500, hmc_count(map));
+
+        for (size_t i = 1; i <= 5000; i++)
+        {
+            cmc_assert_equals(bool, i % 2 == 1, hmc_contains(map, i));
+
+            struct hashmap_cached_entry *entry = hmc_impl_get_entry(map, i);
+
+            if (entry)
+                cmc_assert_equals(size_t, hash(i), entry->hash);
+        }
+
+        hmc_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(cached[resize does not hash], {
+        struct hashmap_cached *map = hmc_new(1, 0.9, cmp, counthash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        hash_calls = 0;
+
+        for (size_t i = 1; i <= 5000; i++)
+            cmc_assert(hmc_insert(map, i, i));
+
+        cmc_assert_equals(size_t, 5000, hash_calls);
+
+        cmc_assert(hmc_resize(map, 20000));
+
+        cmc_assert_equals(size_t, 5000, hash_calls);
+
+        for (size_t i = 1; i <= 5000; i++)
+            cmc_assert_equals(size_t, i, hmc_get(map, i));
+
+        hmc_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(cached[same hash], {
+        struct hashmap_cached *map = hmc_new(100, 0.6, cmp, hash0);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert(hmc_insert(map, i, i));
+
+        cmc_assert(!hmc_insert(map, 25, 0));
+        cmc_assert(hmc_remove(map, 25, NULL));
+        cmc_assert(!hmc_contains(map, 25));
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert_equals(bool, i != 25, hmc_contains(map, i));
+
+        hmc_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(incremental[insert remove growth], {
+        struct hashmap_incremental *map = hmi_new(1, 0.9, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 1; i <= 5000; i++)
+            cmc_assert(hmi_insert(map, i, i * 2));
+
+        cmc_assert(!hmi_insert(map, 1, 0));
+        cmc_assert_equals(size_t, 5000, hmi_count(map));
+
+        for (size_t i = 1; i <= 5000; i++)
+            cmc_assert_equals(size_t, i * 2, hmi_get(map, i));
+
+        for (size_t i = 2; i <= 5000; i += 2)
+            cmc_assert(hmi_remove(map, i, NULL));
+
+        cmc_assert_equals(size_t, 2500, hmi_count(map));
+
+        for (size_t i = 1; i <= 5000; i++)
+            cmc_assert_equals(bool, i % 2 == 1, hmi_contains(map, i));
+
+        hmi_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(incremental[migration], {
+        struct hashmap_incremental *map = hmi_new(1000, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        size_t capacity = hmi_capacity(map);
+        size_t i = 0;
+
+        for (; hmi_capacity(map) == capacity; i++)
+            cmc_assert(hmi_insert(map, i, i));
+
+        /* The previous buffer is only moved a few slots at a time */
+        cmc_assert_not_equals(ptr, NULL, map->old);
+        cmc_assert_equals(size_t, capacity, map->old->capacity);
+
+        size_t lookups = 0;
+
+        for (; map->old != NULL; lookups++)
+            cmc_assert(hmi_contains(map, lookups % i));
+
+        cmc_assert_lesser_equals(size_t, (capacity + i) / CMC_HASHMAP_MIGRATE_STEP + 1, lookups);
+        cmc_assert_equals(size_t, i, hmi_count(map));
+
+        for (size_t j = 0; j < i; j++)
+            cmc_assert_equals(size_t, j, hmi_get(map, j));
+
+        hmi_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(incremental[iterator copy_of], {
+        struct hashmap_incremental *map = hmi_new(1000, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 1; i <= 2000; i++)
+            cmc_assert(hmi_insert(map, i, i));
+
+        cmc_assert_not_equals(ptr, NULL, map->old);
+
+        struct hashmap_incremental *copy = hmi_copy_of(map, NULL, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, copy);
+        cmc_assert_equals(ptr, NULL, map->old);
+
+        size_t sum = 0;
+
+        struct hashmap_incremental_iter iter;
+
+        for (hmi_iter_init(&iter, copy); !hmi_iter_end(&iter); hmi_iter_next(&iter))
+            sum += hmi_iter_value(&iter);
+
+        cmc_assert_equals(size_t, 2001000, sum);
+
+        for (size_t i = 1; i <= 2000; i++)
+            cmc_assert_equals(size_t, i, hmi_get(copy, i));
+
+        hmi_free(map, NULL);
+        hmi_free(copy, NULL);
+    });
+
+    CMC_CREATE_TEST(iterator[sparse], {
+        struct hashmap *map = hm_new(5000, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 5000; i++)
+            cmc_assert(hm_insert(map, i, i));
+
+        // Only the multiples of 100 are left, far apart from each other
+        for (size_t i = 0; i < 5000; i++)
+        {
+            if (i % 100 != 0)
+                cmc_assert(hm_remove(map, i, NULL));
+        }
+
+        size_t sum = 0;
+        size_t n = 0;
+
+        struct hashmap_iter iter;
+
+        for (hm_iter_init(&iter, map); !hm_iter_end(&iter); hm_iter_next(&iter), n++)
+            sum += hm_iter_key(&iter);
+
+        cmc_assert_equals(size_t, 50, n);
+        cmc_assert_equals(size_t, 122500, sum);
+
+        for (hm_iter_to_end(&iter); !hm_iter_start(&iter); hm_iter_prev(&iter))
+            sum -= hm_iter_value(&iter);
+
+        cmc_assert_equals(size_t, 0, sum);
+
+        size_t key;
+
+        cmc_assert(hm_max(map, &key, NULL));
+        cmc_assert_equals(size_t, 4900, key);
+        cmc_assert(hm_min(map, &key, NULL));
+        cmc_assert_equals(size_t, 0, key);
+
+        struct hashmap *copy = hm_copy_of(map, NULL, hm_twice);
+
+        cmc_assert_not_equals(ptr, NULL, copy);
+        cmc_assert_equals(size_t, 50, hm_count(copy));
+        cmc_assert(hm_equals(map, copy, NULL));
+
+        for (size_t i = 0; i < 5000; i += 100)
+            cmc_assert_equals(size_t, i * 2, hm_get(copy, i));
+
+        // The copy keeps track of its own entries
+        cmc_assert(hm_remove(copy, 0, NULL));
+        cmc_assert(hm_insert(copy, 1, 1));
+        cmc_assert(hm_min(copy, &key, NULL));
+        cmc_assert_equals(size_t, 1, key);
+        cmc_assert(hm_min(map, &key, NULL));
+        cmc_assert_equals(size_t, 0, key);
+
+        hm_clear(map, NULL);
+
+        hm_iter_init(&iter, map);
+
+        cmc_assert(hm_iter_end(&iter));
+        cmc_assert(!hm_max(map, &key, NULL));
+
+        hm_free(map, NULL);
+        hm_free(copy, NULL);
+    });
+
+    CMC_CREATE_TEST(ex[insert remove growth], {
+        /* The functions are given at generation time */
+        struct hashmap_ex *map = hmx_new(1, 0.9, NULL, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        hash_calls = 0;
+
+        for (size_t i = 1; i <= 5000; i++)
+            cmc_assert(hmx_insert(map, i, i * 2));
+
+        cmc_assert(hash_calls >= 5000);
+        cmc_assert(!hmx_insert(map, 1, 0));
+        cmc_assert_equals(size_t, 5000, hmx_count(map));
+
+        for (size_t i = 1; i <= 5000; i++)
+            cmc_assert_equals(size_t, i * 2, hmx_get(map, i));
+
+        for (size_t i = 2; i <= 5000; i += 2)
+            cmc_assert(hmx_remove(map, i, NULL));
+
+        cmc_assert_equals(size_t, 2500, hmx_count(map));
+
+        for (size_t i = 1; i <= 5000; i++)
+            cmc_assert_equals(bool, i % 2 == 1, hmx_contains(map, i));
+
+        hmx_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(save restore[layout], {
+        struct hashmap *map = hm_new(100, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(hm_insert(map, i, i * 2));
+
+        for (size_t i = 0; i < 1000; i += 3)
+            cmc_assert(hm_remove(map, i, NULL));
+
+        FILE *file = tmpfile();
+
+        cmc_assert_not_equals(ptr, NULL, file);
+        cmc_assert(hm_save(map, file, NULL, NULL));
+
+        rewind(file);
+
+        // The layout of a map with another entry or sizing is rejected
+        cmc_assert_equals(ptr, NULL, hmc_restore(file, cmp, hash, NULL, NULL));
+
+        rewind(file);
+
+        cmc_assert_equals(ptr, NULL, hmp_restore(file, cmp, hash, NULL, NULL));
+
+        rewind(file);
+
+        struct hashmap *r = hm_restore(file, cmp, hash, NULL, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, r);
+        cmc_assert_equals(size_t, hm_count(map), hm_count(r));
+        cmc_assert_equals(size_t, hm_capacity(map), hm_capacity(r));
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            cmc_assert_equals(bool, i % 3 != 0, hm_contains(r, i));
+            cmc_assert_equals(size_t, i % 3 != 0 ? i * 2 : 0, hm_get(r, i));
+        }
+
+        fclose(file);
+        hm_free(r, NULL);
+        hm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(save restore[writers], {
+        struct hashmap_incremental *map = hmi_new(1, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        // Restored after a migration was left pending
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(hmi_insert(map, i, i * 2));
+
+        FILE *file = tmpfile();
+
+        cmc_assert_not_equals(ptr, NULL, file);
+        cmc_assert(hmi_save(map, file, write_size, NULL));
+
+        rewind(file);
+
+        struct hashmap_incremental *r = hmi_restore(file, cmp, hash, NULL, NULL);
+
+        // The keys need a reader
+        cmc_assert_equals(ptr, NULL, r);
+
+        rewind(file);
+
+        r = hmi_restore(file, cmp, hash, read_size, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, r);
+        cmc_assert_equals(size_t, 1000, hmi_count(r));
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert_equals(size_t, i * 2, hmi_get(r, i));
+
+        fclose(file);
+        hmi_free(r, NULL);
+        hmi_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(small[new], {
+        struct hashmap_small *map = hms_new(4, 0.6, cmp, counthash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+        cmc_assert_equals(ptr, map->small_buffer, map->buffer);
+        cmc_assert_equals(size_t, CMC_HASHTABLE_SMALL_SIZE, hms_capacity(map));
+
+        struct cmc_hashtable_stats stats;
+        hms_stats(map, &stats);
+
+        // Nothing is allocated besides the struct
+        cmc_assert_equals(size_t, sizeof(struct hashmap_small), stats.bytes);
+
+        hms_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(small[no hashing], {
+        struct hashmap_small *map = hms_new(1, 0.6, cmp, counthash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        hash_calls = 0;
+
+        for (size_t i = 1; i < CMC_HASHTABLE_SMALL_SIZE; i++)
+            cmc_assert(hms_insert(map, i, i * 2));
+
+        cmc_assert(!hms_insert(map, 1, 0));
+        cmc_assert(hms_update(map, 2, 5, NULL));
+        cmc_assert(hms_remove(map, 3, NULL));
+        cmc_assert(!hms_contains(map, 3));
+        cmc_assert_equals(size_t, 5, hms_get(map, 2));
+        cmc_assert_equals(size_t, 16, *hms_get_or_insert(map, 8, 16));
+
+        cmc_assert_equals(size_t, 0, hash_calls);
+        cmc_assert_equals(ptr, map->small_buffer, map->buffer);
+        cmc_assert_equals(size_t, CMC_HASHTABLE_SMALL_SIZE - 1, hms_count(map));
+
+        hms_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(small[grow shrink], {
+        struct hashmap_small *map = hms_new(1, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(hms_insert(map, i, i * 2));
+
+        cmc_assert_not_equals(ptr, map->small_buffer, map->buffer);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert_equals(size_t, i * 2, hms_get(map, i));
+
+        for (size_t i = 5; i < 1000; i++)
+            cmc_assert(hms_remove(map, i, NULL));
+
+        cmc_assert(hms_shrink_to_fit(map));
+
+        // The keys left are moved back inside the struct
+        cmc_assert_equals(ptr, map->small_buffer, map->buffer);
+        cmc_assert_equals(size_t, 5, hms_count(map));
+
+        size_t sum = 0;
+        struct hashmap_small_iter iter;
+
+        for (hms_iter_init(&iter, map); !hms_iter_end(&iter); hms_iter_next(&iter))
+            sum += hms_iter_value(&iter);
+
+        cmc_assert_equals(size_t, 20, sum);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert_equals(bool, i < 5, hms_contains(map, i));
+
+        // And grow again
+        for (size_t i = 5; i < 100; i++)
+            cmc_assert(hms_insert(map, i, i * 2));
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert_equals(size_t, i * 2, hms_get(map, i));
+
+        hms_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(small[low water boundary], {
+        struct hashmap_small *map = hms_new(1, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(hms_insert(map, i, i));
+
+        for (size_t i = 999; i >= CMC_HASHTABLE_SMALL_SIZE + 1; i--)
+            cmc_assert(hms_remove(map, i, NULL));
+
+        struct hashmap_small_entry *buffer = map->buffer;
+
+        cmc_assert_not_equals(ptr, map->small_buffer, buffer);
+
+        // One key more or less than fits in the struct doesn't move them
+        for (size_t i = 0; i < 100; i++)
+        {
+            cmc_assert(hms_remove(map, CMC_HASHTABLE_SMALL_SIZE, NULL));
+            cmc_assert_equals(ptr, buffer, map->buffer);
+            cmc_assert(hms_insert(map, CMC_HASHTABLE_SMALL_SIZE, 0));
+            cmc_assert_equals(ptr, buffer, map->buffer);
+        }
+
+        // Until only half of them are left
+        for (size_t i = CMC_HASHTABLE_SMALL_SIZE; i >= CMC_HASHTABLE_SMALL_SIZE / 2; i--)
+        {
+            cmc_assert_not_equals(ptr, map->small_buffer, map->buffer);
+            cmc_assert(hms_remove(map, i, NULL));
+        }
+
+        cmc_assert_equals(ptr, map->small_buffer, map->buffer);
+        cmc_assert_equals(size_t, CMC_HASHTABLE_SMALL_SIZE / 2, hms_count(map));
+
+        for (size_t i = CMC_HASHTABLE_SMALL_SIZE / 2; i <= CMC_HASHTABLE_SMALL_SIZE; i++)
+            cmc_assert(hms_insert(map, i, i));
+
+        cmc_assert_not_equals(ptr, map->small_buffer, map->buffer);
+        cmc_assert(hms_remove(map, CMC_HASHTABLE_SMALL_SIZE, NULL));
+        cmc_assert_not_equals(ptr, map->small_buffer, map->buffer);
+
+        // An explicit shrink moves them as soon as they fit
+        cmc_assert(hms_shrink_to_fit(map));
+        cmc_assert_equals(ptr, map->small_buffer, map->buffer);
+        cmc_assert_equals(size_t, CMC_HASHTABLE_SMALL_SIZE, hms_count(map));
+
+        for (size_t i = 0; i < CMC_HASHTABLE_SMALL_SIZE; i++)
+            cmc_assert(hms_contains(map, i));
+
+        hms_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(small[copy_of save restore], {
+        struct hashmap_small *map = hms_new(1, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 6; i++)
+            cmc_assert(hms_insert(map, i, i));
+
+        struct hashmap_small *copy = hms_copy_of(map, NULL, hm_twice);
+
+        cmc_assert_not_equals(ptr, NULL, copy);
+        cmc_assert_equals(ptr, copy->small_buffer, copy->buffer);
+
+        for (size_t i = 0; i < 6; i++)
+            cmc_assert_equals(size_t, i * 2, hms_get(copy, i));
+
+        FILE *file = tmpfile();
+
+        cmc_assert_not_equals(ptr, NULL, file);
+        cmc_assert(hms_save(copy, file, NULL, NULL));
+
+        rewind(file);
+
+        struct hashmap_small *r = hms_restore(file, cmp, hash, NULL, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, r);
+        cmc_assert_equals(ptr, r->small_buffer, r->buffer);
+        cmc_assert(hms_equals(copy, r, cmp));
+
+        fclose(file);
+        hms_free(r, NULL);
+        hms_free(copy, NULL);
+        hms_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(new_from, {
+        size_t keys[200];
+        size_t values[200];
+
+        for (size_t i = 0; i < 200; i++)
+        {
+            keys[i] = i % 100;
+            values[i] = i;
+        }
+
+        struct hashmap *map = hm_new_from(keys, values, 200, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+        cmc_assert_equals(size_t, 100, hm_count(map));
+
+        /* The first value of a key is kept */
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert_equals(size_t, i, hm_get(map, i));
+
+        hm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(to_array[incremental], {
+        struct hashmap_incremental *map = hmi_new(1, 0.9, cmp, hash);
+
+        /* Leaves a resize in progress */
+        for (size_t i = 0; i < 1000; i++)
+            hmi_insert(map, i, i * 2);
+
+        size_t keys[1000] = { 0 };
+        size_t values[1000] = { 0 };
+
+        cmc_assert_equals(size_t, 1000, hmi_to_array(map, keys, values, 2000));
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert_equals(size_t, keys[i] * 2, values[i]);
+
+        size_t sum = 0;
+
+        for (size_t i = 0; i < 1000; i++)
+            sum += keys[i];
+
+        cmc_assert_equals(size_t, 999 * 1000 / 2, sum);
+
+        cmc_assert_equals(size_t, 10, hmi_to_array(map, NULL, values, 10));
+        cmc_assert_equals(size_t, 10, hmi_to_array(map, keys, NULL, 10));
+
+        hmi_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(parallel_reduce[incremental], {
+        struct hashmap_incremental *map = hmi_new(1, 0.9, cmp, hash);
+
+        /* Leaves a resize in progress */
+        for (size_t i = 1; i <= 100000; i++)
+            hmi_insert(map, i, i * 2);
+
+        cmc_assert_equals(size_t, 15000150000, hmi_parallel_reduce(map, 0, add_entry, add, 4));
+        cmc_assert_equals(size_t, 15000150000, hmi_parallel_reduce(map, 0, add_entry, add, 1));
+
+        hmi_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(callbacks[incremental], {
+        struct hashmap_incremental *map = hmi_new(1, 0.9, cmp, hash);
+        struct hashmap_incremental *low = hmi_new(1, 0.9, cmp, hash);
+
+        /* Leaves a resize in progress */
+        for (size_t i = 0; i < 1000; i++)
+            hmi_insert(map, i, i);
+
+        cmc_assert(hmi_filter_into_below_100(map, low));
+        cmc_assert_equals(size_t, 100, hmi_count(low));
+        cmc_assert_equals(size_t, 9900, hmi_fold_sum(low, 0));
+
+        cmc_assert(hmi_map_into_plus_key(low, low));
+        cmc_assert_equals(size_t, 100, hmi_count(low));
+        cmc_assert_equals(size_t, 14850, hmi_fold_sum(low, 0));
+        cmc_assert_equals(size_t, 198, hmi_get(low, 99));
+
+        cmc_assert(hmi_map_into_plus_key(map, low));
+        cmc_assert_equals(size_t, 1000, hmi_count(low));
+        cmc_assert_equals(size_t, 999 * 1000 / 2 * 3, hmi_fold_sum(low, 0));
+
+        hmi_free(map, NULL);
+        hmi_free(low, NULL);
+    });
+
+    CMC_CREATE_TEST(serialize[incremental], {
+        struct hashmap_incremental *map = hmi_new(1, 0.9, cmp, hash);
+
+        /* Leaves a resize in progress */
+        for (size_t i = 0; i < 5000; i++)
+            hmi_insert(map, i, i * 3);
+
+        struct hashmap_incremental_serializer ser;
+        struct hashmap_incremental_deserializer des;
+
+        cmc_assert(hmi_serialize_begin(&ser, map, 512, true));
+        cmc_assert(hmi_deserialize_begin(&des, cmp, hash, 512));
+
+        /* Partial writes of whatever fits in a small buffer */
+        unsigned char chunk[100];
+        size_t n;
+
+        while ((n = hmi_serialize_next(&ser, chunk, sizeof(chunk))) > 0)
+            cmc_assert(hmi_deserialize_next(&des, chunk, n));
+
+        hmi_serialize_end(&ser);
+
+        struct hashmap_incremental *result = hmi_deserialize_end(&des);
+
+        cmc_assert_not_equals(ptr, NULL, result);
+        cmc_assert_equals(size_t, 5000, hmi_count(result));
+
+        for (size_t i = 0; i < 5000; i++)
+            cmc_assert_equals(size_t, i * 3, hmi_get(result, i));
+
+        hmi_free(map, NULL);
+        hmi_free(result, NULL);
+    });
+
+    CMC_CREATE_TEST(serialize[truncated], {
+        struct hashmap *map = hm_new(100, 0.8, cmp, hash);
+
+        for (size_t i = 0; i < 100; i++)
+            hm_insert(map, i, i);
+
+        struct hashmap_serializer ser;
+        struct hashmap_deserializer des;
+        unsigned char stream[4096];
+
+        cmc_assert(hm_serialize_begin(&ser, map, 0, false));
+        size_t size = hm_serialize_next(&ser, stream, sizeof(stream));
+        hm_serialize_end(&ser);
+
+        /* Everything but the last block */
+        cmc_assert(hm_deserialize_begin(&des, cmp, hash, 0));
+        cmc_assert(hm_deserialize_next(&des, stream, size - 4));
+        cmc_assert_equals(ptr, NULL, hm_deserialize_end(&des));
+
+        cmc_assert(hm_deserialize_begin(&des, cmp, hash, 0));
+        cmc_assert(hm_deserialize_next(&des, stream, size));
+
+        struct hashmap *result = hm_deserialize_end(&des);
+
+        cmc_assert_not_equals(ptr, NULL, result);
+        cmc_assert_equals(size_t, 100, hm_count(result));
+        cmc_assert_equals(size_t, 42, hm_get(result, 42));
+
+        hm_free(map, NULL);
+        hm_free(result, NULL);
+    });
+
+    CMC_CREATE_TEST(fingerprint, {
+        struct hashmap_incremental *map1 = hmi_new(10, 0.6, cmp, hash);
+        struct hashmap_incremental *map2 = hmi_new(1000, 0.6, cmp, hash);
+
+        /* Only the keys count and map1 is still migrating its buffer */
+        for (size_t i = 0; i < 100; i++)
+        {
+            hmi_insert(map1, i, i);
+            hmi_insert(map2, 99 - i, 0);
+        }
+
+        cmc_assert_equals(size_t, hmi_fingerprint(map1), hmi_fingerprint(map2));
+        cmc_assert(hmi_equals(map1, map2, NULL));
+        cmc_assert(!hmi_equals(map1, map2, cmp));
+
+        hmi_remove(map2, 7, NULL);
+        hmi_insert(map2, 100, 0);
+
+        cmc_assert_not_equals(size_t, hmi_fingerprint(map1), hmi_fingerprint(map2));
+        cmc_assert(!hmi_equals(map1, map2, NULL));
+
+        hmi_free(map1, NULL);
+        hmi_free(map2, NULL);
+    });
+
+    CMC_CREATE_TEST(soa[insert remove growth], {
+        struct hashmap_soa *map = hma_new(1, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 10000; i++)
+            cmc_assert(hma_insert(map, i, i * 3));
+
+        /* Backward shift deletion moves the values with their keys */
+        for (size_t i = 1; i < 10000; i += 2)
+            cmc_assert(hma_remove(map, i, NULL));
+
+        bool kept = true;
+
+        for (size_t i = 0; i < 10000; i++)
+            kept = kept && hma_get(map, i) == (i % 2 == 0 ? i * 3 : 0);
+
+        cmc_assert(kept);
+        cmc_assert_equals(size_t, 5000, hma_count(map));
+
+        size_t old = 0;
+
+        cmc_assert(hma_update(map, 10, 1, &old));
+        cmc_assert_equals(size_t, 30, old);
+
+        *hma_get_ref(map, 10) = 30;
+        *hma_get_or_insert(map, 1, 0) += 3;
+
+        size_t value = 0;
+
+        cmc_assert(hma_remove(map, 1, &value));
+        cmc_assert_equals(size_t, 3, value);
+
+        /* Sums of i * 3 and of i + i * 3 for the even i below 10000 */
+        cmc_assert_equals(size_t, 74985000, hma_fold_values_sum(map, 0));
+        cmc_assert_equals(size_t, 99980000, hma_parallel_reduce(map, 0, add_entry, add, 4));
+
+        cmc_assert_greater_equals(size_t, sizeof(size_t) * hma_capacity(map),
+                                  hma_memory_usage(map) - sizeof(struct hashmap_soa_entry) *
+                                                              hma_capacity(map));
+
+        hma_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(soa[copy_of save restore], {
+        struct hashmap_soa *map = hma_new(100, 0.6, cmp, hash);
+
+        for (size_t i = 0; i < 100; i++)
+            hma_insert(map, i, i + 1000);
+
+        struct hashmap_soa *copy = hma_copy_of(map, NULL, hm_twice);
+
+        cmc_assert_not_equals(ptr, NULL, copy);
+        cmc_assert_equals(size_t, 2000, hma_get(copy, 0));
+        cmc_assert(!hma_equals(map, copy, cmp));
+
+        FILE *file = tmpfile();
+
+        cmc_assert_not_equals(ptr, NULL, file);
+        cmc_assert(hma_save(copy, file, NULL, NULL));
+
+        rewind(file);
+
+        struct hashmap_soa *r = hma_restore(file, cmp, hash, NULL, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, r);
+        cmc_assert(hma_equals(copy, r, cmp));
+
+        hma_clear(r, NULL);
+
+        cmc_assert_equals(size_t, 0, hma_fold_values_sum(r, 0));
+
+        fclose(file);
+        hma_free(map, NULL);
+        hma_free(copy, NULL);
+        hma_free(r, NULL);
+    });
+
+    CMC_CREATE_TEST(remove_if, {
+        struct hashmap *map = hm_new(100, 0.8, cmp, hash);
+        struct hashmap_incremental *inc = hmi_new(100, 0.8, cmp, hash);
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            hm_insert(map, i, i * 2);
+            hmi_insert(inc, i, i * 2);
+        }
+
+        hm_deallocated = 0;
+
+        cmc_assert_equals(size_t, 500, hm_remove_if(map, hm_odd_key, hm_count_deallocator));
+        cmc_assert_equals(size_t, 500, hm_deallocated);
+        cmc_assert_equals(size_t, 500, hm_count(map));
+
+        // Entries left in the previous buffer are swept too
+        cmc_assert_equals(size_t, 500, hmi_remove_if(inc, hm_odd_key, NULL));
+        cmc_assert_equals(size_t, 500, hmi_count(inc));
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            cmc_assert_equals(bool, i % 2 == 0, hm_contains(map, i));
+            cmc_assert_equals(bool, i % 2 == 0, hmi_contains(inc, i));
+        }
+
+        cmc_assert_equals(size_t, 20, hm_get(map, 10));
+
+        hm_free(map, NULL);
+        hmi_free(inc, NULL);
+    });
 });
@@ -4,8 +4,28 @@
 #include <utl/test.h>
 
 #include <cmc/hashset.h>
+#include <utl/cmc_callback.h>
 
 CMC_GENERATE_HASHSET(hs, hashset, size_t)
+CMC_GENERATE_HASHSET_CACHED(hsc, hashset_cached, size_t)
+CMC_GENERATE_HASHSET_SMALL(hss, hashset_small, size_t)
+
+static size_t hs_twice(size_t value)
+{
+    return value * 2;
+}
+
+#define hs_is_odd(x) ((x) % 2 == 1)
+#define hs_sum(a, x) ((a) + (x))
+
+CMC_GENERATE_HASHSET_FILTER(hs, hashset, size_t, odd, hs_is_odd)
+CMC_GENERATE_HASHSET_MAP(hs, hashset, size_t, twice, hs_twice)
+CMC_GENERATE_HASHSET_FOLD(hs, hashset, size_t, sum, size_t, hs_sum)
+
+static bool hs_below_300(size_t x)
+{
+    return x < 300;
+}
 
 CMC_CREATE_UNIT(hashset_test, true, {
     CMC_CREATE_TEST(new, {
@@ -19,6 +39,23 @@ CMC_CREATE_UNIT(hashset_test, true, {
         hs_free(set, NULL);
     });
 
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct hashset *set = hs_new_custom(100, 0.6, cmp, hash, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 0; i < 1000; i++)
+            hs_insert(set, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        hs_free(set, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
     CMC_CREATE_TEST(new[capacity = 0], {
         struct hashset *set = hs_new(0, 0.6, cmp, hash);
 
@@ -148,6 +185,28 @@ CMC_CREATE_UNIT(hashset_test, true, {
         hs_free(set, NULL);
     });
 
+    CMC_CREATE_TEST(insert_many, {
+        struct hashset *set = hs_new(1, 0.9, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        size_t elements[1000];
+
+        for (size_t i = 0; i < 1000; i++)
+            elements[i] = i % 800;
+
+        cmc_assert(hs_insert(set, 0));
+        cmc_assert_equals(size_t, 799, hs_insert_many(set, elements, 1000));
+
+        cmc_assert_greater_equals(size_t, (size_t)(1001 / 0.9), hs_capacity(set));
+        cmc_assert_equals(size_t, 800, hs_count(set));
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert_equals(bool, i < 800, hs_contains(set, i));
+
+        hs_free(set, NULL);
+    });
+
     CMC_CREATE_TEST(remove, {
         struct hashset *set = hs_new(100, 0.6, cmp, hash);
 
@@ -162,6 +221,32 @@ CMC_CREATE_UNIT(hashset_test, true, {
         hs_free(set, NULL);
     });
 
+    CMC_CREATE_TEST(remove[backward shift], {
+        struct hashset *set = hs_new(500, 0.6, cmp, hash0);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 0; i < 200; i++)
+            cmc_assert(hs_insert(set, i));
+
+        for (size_t i = 0; i < 200; i += 2)
+            cmc_assert(hs_remove(set, i));
+
+        // Remaining values are packed at the start with no tombstones
+        for (size_t i = 0; i < 100; i++)
+        {
+            cmc_assert_equals(size_t, i * 2 + 1, set->buffer[i].value);
+            cmc_assert_equals(size_t, i, set->buffer[i].dist);
+        }
+
+        cmc_assert_equals(int32_t, CMC_ES_EMPTY, set->buffer[100].state);
+
+        for (size_t i = 0; i < 200; i++)
+            cmc_assert_equals(bool, i % 2 == 1, hs_contains(set, i));
+
+        hs_free(set, NULL);
+    });
+
     CMC_CREATE_TEST(remove[count = 0], {
         struct hashset *set = hs_new(100, 0.6, cmp, hash);
 
@@ -279,6 +364,32 @@ CMC_CREATE_UNIT(hashset_test, true, {
         hs_free(set, NULL);
     });
 
+    CMC_CREATE_TEST(contains_many[sum], {
+        struct hashset *set = hs_new(100, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 101; i <= 200; i++)
+            cmc_assert(hs_insert(set, i));
+
+        size_t elements[300];
+        bool found[300];
+
+        for (size_t i = 0; i < 300; i++)
+            elements[i] = i + 1;
+
+        cmc_assert_equals(size_t, 100, hs_contains_many(set, elements, 300, found));
+
+        size_t sum = 0;
+        for (size_t i = 0; i < 300; i++)
+            if (found[i])
+                sum += elements[i];
+
+        cmc_assert_equals(size_t, 15050, sum);
+
+        hs_free(set, NULL);
+    });
+
     CMC_CREATE_TEST(empty, {
         struct hashset *set = hs_new(100, 0.6, cmp, hash);
 
@@ -357,4 +468,492 @@ CMC_CREATE_UNIT(hashset_test, true, {
 
         hs_free(set, NULL);
     });
+
+    CMC_CREATE_TEST(stats, {
+        struct hashset *set = hs_new(500, 0.6, cmp, hash0);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(hs_insert(set, i));
+
+        cmc_assert(hs_remove(set, 99));
+
+        struct cmc_hashtable_stats stats;
+
+        hs_stats(set, &stats);
+
+        cmc_assert_equals(size_t, hs_capacity(set), stats.capacity);
+        cmc_assert_equals(size_t, 99, stats.count);
+        cmc_assert_equals(size_t, 0, stats.tombstones);
+        cmc_assert_equals(size_t, 98, stats.max_dist);
+        cmc_assert_in_range(double, 49.0 - 0.0001, 49.0 + 0.0001, stats.mean_dist);
+        cmc_assert_equals(size_t, 1, stats.histogram[0]);
+
+        hs_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(iterator[sparse], {
+        struct hashset *set = hs_new(5000, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 0; i < 5000; i++)
+            cmc_assert(hs_insert(set, i));
+
+        // Only the multiples of 100 are left, far apart from each other
+        for (size_t i = 0; i < 5000; i++)
+        {
+            if (i % 100 != 0)
+                cmc_assert(hs_remove(set, i));
+        }
+
+        size_t sum = 0;
+        size_t n = 0;
+
+        struct hashset_iter iter;
+
+        for (hs_iter_init(&iter, set); !hs_iter_end(&iter); hs_iter_next(&iter), n++)
+            sum += hs_iter_value(&iter);
+
+        cmc_assert_equals(size_t, 50, n);
+        cmc_assert_equals(size_t, 122500, sum);
+
+        for (hs_iter_to_end(&iter); !hs_iter_start(&iter); hs_iter_prev(&iter))
+            sum -= hs_iter_value(&iter);
+
+        cmc_assert_equals(size_t, 0, sum);
+
+        size_t value;
+
+        cmc_assert(hs_max(set, &value));
+        cmc_assert_equals(size_t, 4900, value);
+        cmc_assert(hs_min(set, &value));
+        cmc_assert_equals(size_t, 0, value);
+
+        struct hashset *copy = hs_copy_of(set, hs_twice);
+
+        cmc_assert_not_equals(ptr, NULL, copy);
+        cmc_assert_equals(size_t, 50, hs_count(copy));
+
+        // Copied values stay at the slot of the original one
+        sum = 0;
+
+        for (hs_iter_init(&iter, copy); !hs_iter_end(&iter); hs_iter_next(&iter))
+            sum += hs_iter_value(&iter);
+
+        cmc_assert_equals(size_t, 245000, sum);
+
+        hs_free(copy, NULL);
+
+        copy = hs_copy_of(set, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, copy);
+        cmc_assert(hs_equals(set, copy));
+
+        for (size_t i = 0; i < 5000; i += 100)
+            cmc_assert(hs_contains(copy, i));
+
+        // Keeps the multiples of 200
+        for (size_t i = 0; i < 5000; i += 200)
+            cmc_assert(hs_remove(copy, i + 100));
+
+        hs_intersect_with(set, copy);
+
+        cmc_assert_equals(size_t, 25, hs_count(set));
+        cmc_assert(hs_equals(set, copy));
+        cmc_assert(hs_max(set, &value));
+        cmc_assert_equals(size_t, 4800, value);
+
+        hs_clear(set, NULL);
+
+        hs_iter_init(&iter, set);
+
+        cmc_assert(hs_iter_end(&iter));
+        cmc_assert(!hs_min(set, &value));
+
+        hs_free(set, NULL);
+        hs_free(copy, NULL);
+    });
+
+    CMC_CREATE_TEST(cached[insert remove growth], {
+        struct hashset_cached *set = hsc_new(1, 0.9, cmp, counthash);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        hash_calls = 0;
+
+        for (size_t i = 1; i <= 5000; i++)
+            cmc_assert(hsc_insert(set, i));
+
+        /* Growing the set reuses the stored hashes */
+        cmc_assert_equals(size_t, 5000, hash_calls);
+        cmc_assert_equals(size_t, 5000, hsc_count(set));
+
+        for (size_t i = 2; i <= 5000; i += 2)
+            cmc_assert(hsc_remove(set, i));
+
+        cmc_assert_equals(size_t, 2500, hsc_count(set));
+
+        for (size_t i = 1; i <= 5000; i++)
+            cmc_assert_equals(bool, i % 2 == 1, hsc_contains(set, i));
+
+        hsc_free(set, NULL);
+    });
+    CMC_CREATE_TEST(union_into, {
+        struct hashset *set1 = hs_new(1, 0.9, cmp, hash);
+        struct hashset *set2 = hs_new(1, 0.9, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, set1);
+        cmc_assert_not_equals(ptr, NULL, set2);
+
+        for (size_t i = 1; i <= 100; i++)
+            cmc_assert(hs_insert(set1, i));
+
+        for (size_t i = 51; i <= 1000; i++)
+            cmc_assert(hs_insert(set2, i));
+
+        cmc_assert(hs_union_into(set1, set2));
+
+        cmc_assert_equals(size_t, 1000, hs_count(set1));
+        cmc_assert_equals(size_t, 950, hs_count(set2));
+
+        for (size_t i = 1; i <= 1000; i++)
+            cmc_assert(hs_contains(set1, i));
+
+        hs_free(set1, NULL);
+        hs_free(set2, NULL);
+    });
+
+    CMC_CREATE_TEST(intersect_with, {
+        struct hashset *small = hs_new(1, 0.9, cmp, hash);
+        struct hashset *large = hs_new(1, 0.9, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, small);
+        cmc_assert_not_equals(ptr, NULL, large);
+
+        for (size_t i = 1; i <= 100; i++)
+            cmc_assert(hs_insert(small, i * 3));
+
+        for (size_t i = 1; i <= 5000; i++)
+            cmc_assert(hs_insert(large, i * 2));
+
+        /* Probes from the smaller set when it is the one being modified */
+        cmc_assert(hs_intersect_with(small, large));
+
+        cmc_assert_equals(size_t, 50, hs_count(small));
+
+        for (size_t i = 1; i <= 300; i++)
+            cmc_assert_equals(bool, i % 6 == 0, hs_contains(small, i));
+
+        /* And when it is the other operand */
+        cmc_assert(hs_intersect_with(large, small));
+
+        cmc_assert_equals(size_t, 50, hs_count(large));
+
+        for (size_t i = 1; i <= 10000; i++)
+            cmc_assert_equals(bool, i % 6 == 0 && i <= 300, hs_contains(large, i));
+
+        cmc_assert(hs_insert(large, 1));
+        cmc_assert(hs_contains(large, 1));
+
+        hs_free(small, NULL);
+        hs_free(large, NULL);
+    });
+
+    CMC_CREATE_TEST(subtract, {
+        struct hashset *small = hs_new(1, 0.9, cmp, hash);
+        struct hashset *large = hs_new(1, 0.9, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, small);
+        cmc_assert_not_equals(ptr, NULL, large);
+
+        for (size_t i = 1; i <= 100; i++)
+            cmc_assert(hs_insert(small, i * 3));
+
+        for (size_t i = 1; i <= 5000; i++)
+            cmc_assert(hs_insert(large, i * 2));
+
+        hs_subtract(large, small);
+
+        cmc_assert_equals(size_t, 4950, hs_count(large));
+
+        for (size_t i = 1; i <= 10000; i++)
+            cmc_assert_equals(bool, i % 2 == 0 && (i % 6 != 0 || i > 300),
+                              hs_contains(large, i));
+
+        cmc_assert(hs_insert(large, 9));
+        cmc_assert(hs_insert(large, 15));
+
+        /* Scans the smaller set when it is the one being modified */
+        hs_subtract(small, large);
+
+        cmc_assert_equals(size_t, 98, hs_count(small));
+
+        for (size_t i = 1; i <= 300; i++)
+            cmc_assert_equals(bool, i % 3 == 0 && i != 9 && i != 15, hs_contains(small, i));
+
+        hs_subtract(small, small);
+
+        cmc_assert(hs_empty(small));
+
+        hs_free(small, NULL);
+        hs_free(large, NULL);
+    });
+
+    CMC_CREATE_TEST(small[no hashing], {
+        struct hashset_small *set = hss_new(1, 0.6, cmp, counthash);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+        cmc_assert_equals(ptr, set->small_buffer, set->buffer);
+
+        hash_calls = 0;
+
+        for (size_t i = 1; i < CMC_HASHTABLE_SMALL_SIZE; i++)
+            cmc_assert(hss_insert(set, i));
+
+        cmc_assert(!hss_insert(set, 1));
+        cmc_assert(hss_remove(set, 3));
+        cmc_assert(!hss_contains(set, 3));
+        cmc_assert(hss_contains(set, 4));
+
+        cmc_assert_equals(size_t, 0, hash_calls);
+        cmc_assert_equals(size_t, CMC_HASHTABLE_SMALL_SIZE - 2, hss_count(set));
+
+        struct cmc_hashtable_stats stats;
+        hss_stats(set, &stats);
+
+        cmc_assert_equals(size_t, sizeof(struct hashset_small), stats.bytes);
+
+        hss_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(small[grow shrink], {
+        struct hashset_small *set = hss_new(1, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(hss_insert(set, i));
+
+        cmc_assert_not_equals(ptr, set->small_buffer, set->buffer);
+
+        for (size_t i = 3; i < 1000; i++)
+            cmc_assert(hss_remove(set, i));
+
+        cmc_assert(hss_shrink_to_fit(set));
+
+        /* The elements left are moved back inside the struct */
+        cmc_assert_equals(ptr, set->small_buffer, set->buffer);
+        cmc_assert_equals(size_t, 3, hss_count(set));
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert_equals(bool, i < 3, hss_contains(set, i));
+
+        size_t max;
+
+        cmc_assert(hss_max(set, &max));
+        cmc_assert_equals(size_t, 2, max);
+
+        hss_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(small[intersect_with], {
+        struct hashset_small *large = hss_new(1, 0.6, cmp, hash);
+        struct hashset_small *small = hss_new(1, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, large);
+        cmc_assert_not_equals(ptr, NULL, small);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(hss_insert(large, i));
+
+        for (size_t i = 0; i < 5; i++)
+            cmc_assert(hss_insert(small, i * 10));
+
+        /* The result fits inside the struct of large */
+        cmc_assert(hss_intersect_with(large, small));
+
+        cmc_assert_equals(ptr, large->small_buffer, large->buffer);
+        cmc_assert(hss_equals(large, small));
+
+        hss_free(large, NULL);
+        hss_free(small, NULL);
+    });
+
+    CMC_CREATE_TEST(small[copy_of save restore], {
+        struct hashset_small *set = hss_new(1, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 0; i < 6; i++)
+            cmc_assert(hss_insert(set, i));
+
+        struct hashset_small *copy = hss_copy_of(set, hs_twice);
+
+        cmc_assert_not_equals(ptr, NULL, copy);
+        cmc_assert_equals(ptr, copy->small_buffer, copy->buffer);
+
+        for (size_t i = 0; i < 6; i++)
+            cmc_assert(hss_contains(copy, i * 2));
+
+        FILE *file = tmpfile();
+
+        cmc_assert_not_equals(ptr, NULL, file);
+        cmc_assert(hss_save(copy, file, NULL));
+
+        rewind(file);
+
+        struct hashset_small *r = hss_restore(file, cmp, hash, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, r);
+        cmc_assert_equals(ptr, r->small_buffer, r->buffer);
+        cmc_assert(hss_equals(copy, r));
+
+        fclose(file);
+        hss_free(r, NULL);
+        hss_free(copy, NULL);
+        hss_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(new_from, {
+        size_t elements[200];
+
+        for (size_t i = 0; i < 200; i++)
+            elements[i] = i % 100;
+
+        struct hashset *set = hs_new_from(elements, 200, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+        cmc_assert_equals(size_t, 100, hs_count(set));
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(hs_contains(set, i));
+
+        hs_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(to_array, {
+        struct hashset *set = hs_new(100, 0.6, cmp, hash);
+        struct hashset_small *small = hss_new(4, 0.6, cmp, hash);
+
+        for (size_t i = 0; i < 50; i++)
+            hs_insert(set, i);
+
+        for (size_t i = 0; i < 3; i++)
+            hss_insert(small, i);
+
+        size_t elements[50] = { 0 };
+
+        cmc_assert_equals(size_t, 50, hs_to_array(set, elements, 100));
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert(hs_contains(set, elements[i]));
+
+        cmc_assert_equals(size_t, 20, hs_to_array(set, elements, 20));
+
+        cmc_assert_equals(size_t, 3, hss_to_array(small, elements, 50));
+        cmc_assert_equals(size_t, 3, elements[0] + elements[1] + elements[2]);
+
+        hs_free(set, NULL);
+        hss_free(small, NULL);
+    });
+
+    CMC_CREATE_TEST(parallel_reduce, {
+        struct hashset *set = hs_new(100000, 0.6, cmp, hash);
+
+        for (size_t i = 1; i <= 100000; i++)
+            hs_insert(set, i);
+
+        cmc_assert_equals(size_t, 5000050000, hs_parallel_reduce(set, 0, add, add, 4));
+        cmc_assert_equals(size_t, 5000050000, hs_parallel_reduce(set, 0, add, add, 1));
+
+        hs_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(callbacks, {
+        struct hashset *set = hs_new(100, 0.6, cmp, hash);
+        struct hashset *odd = hs_new(1, 0.6, cmp, hash);
+
+        for (size_t i = 0; i < 100; i++)
+            hs_insert(set, i);
+
+        cmc_assert(hs_filter_into_odd(set, odd));
+        cmc_assert_equals(size_t, 50, hs_count(odd));
+        cmc_assert_equals(size_t, 2500, hs_fold_sum(odd, 0));
+
+        /* Doubled odd numbers never collide with the even ones */
+        cmc_assert(hs_map_into_twice(odd, set));
+        cmc_assert_equals(size_t, 125, hs_count(set));
+        cmc_assert_equals(size_t, 4950 + 3750, hs_fold_sum(set, 0));
+
+        hs_free(set, NULL);
+        hs_free(odd, NULL);
+    });
+
+    CMC_CREATE_TEST(fingerprint, {
+        struct hashset *set1 = hs_new(10, 0.6, cmp, hash);
+        struct hashset *set2 = hs_new(1000, 0.6, cmp, hash);
+        struct hashset_small *small = hss_new(8, 0.6, cmp, hash);
+
+        cmc_assert_equals(size_t, 0, hs_fingerprint(set1));
+
+        /* Same elements in a different order and buffer size */
+        for (size_t i = 0; i < 100; i++)
+        {
+            hs_insert(set1, i);
+            hs_insert(set2, 99 - i);
+        }
+
+        cmc_assert_equals(size_t, hs_fingerprint(set1), hs_fingerprint(set2));
+
+        hs_remove(set1, 50);
+
+        cmc_assert_not_equals(size_t, hs_fingerprint(set1), hs_fingerprint(set2));
+        cmc_assert(!hs_equals(set1, set2));
+
+        hs_insert(set1, 50);
+
+        cmc_assert_equals(size_t, hs_fingerprint(set1), hs_fingerprint(set2));
+        cmc_assert(hs_equals(set1, set2));
+
+        /* Small tables that never hash their elements agree with the others */
+        hs_clear(set1, NULL);
+
+        for (size_t i = 0; i < 5; i++)
+        {
+            hs_insert(set1, i);
+            hss_insert(small, i);
+        }
+
+        cmc_assert_equals(size_t, hs_fingerprint(set1), hss_fingerprint(small));
+
+        hs_free(set1, NULL);
+        hs_free(set2, NULL);
+        hss_free(small, NULL);
+    });
+
+    CMC_CREATE_TEST(remove_if, {
+        struct hashset *set = hs_new(100, 0.8, cmp, hash);
+        struct hashset_small *small = hss_new(100, 0.8, cmp, hash);
+
+        for (size_t i = 0; i < 1000; i++)
+            hs_insert(set, i);
+        for (size_t i = 298; i < 302; i++)
+            hss_insert(small, i);
+
+        cmc_assert_equals(size_t, 300, hs_remove_if(set, hs_below_300, NULL));
+        cmc_assert_equals(size_t, 700, hs_count(set));
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert_equals(bool, i >= 300, hs_contains(set, i));
+
+        cmc_assert_equals(size_t, 2, hss_remove_if(small, hs_below_300, NULL));
+        cmc_assert_equals(size_t, 2, hss_count(small));
+        cmc_assert(hss_contains(small, 300));
+        cmc_assert(hss_contains(small, 301));
+
+        hs_free(set, NULL);
+        hss_free(small, NULL);
+    });
 });
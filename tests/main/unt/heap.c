@@ -7,6 +7,11 @@
 
 CMC_GENERATE_HEAP(h, heap, size_t)
 
+static bool h_is_odd(size_t x)
+{
+    return x % 2 == 1;
+}
+
 CMC_CREATE_UNIT(heap_test, true, {
     CMC_CREATE_TEST(new, {
         struct heap *h = h_new(1000000, cmc_max_heap, cmp);
@@ -19,6 +24,23 @@ CMC_CREATE_UNIT(heap_test, true, {
         h_free(h, NULL);
     });
 
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct heap *h = h_new_custom(100, cmc_max_heap, cmp, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+
+        for (size_t i = 0; i < 1000; i++)
+            h_insert(h, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        h_free(h, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
     CMC_CREATE_TEST(new[edge_case capacity = 0], {
         struct heap *h = h_new(0, cmc_max_heap, cmp);
 
@@ -139,6 +161,42 @@ CMC_CREATE_UNIT(heap_test, true, {
         h_free(h, NULL);
     });
 
+    CMC_CREATE_TEST(remove[interleaved], {
+        struct heap *h = h_new(1, cmc_max_heap, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+
+        size_t value;
+
+        /* Every node has a parent CMC_HEAP_ARITY times closer to the root */
+        for (size_t i = 0; i < 5000; i++)
+        {
+            cmc_assert(h_insert(h, (i * 7919) % 5003));
+
+            for (size_t c = 1; c < h_count(h); c++)
+                cmc_assert(h->buffer[c] <= h->buffer[(c - 1) / CMC_HEAP_ARITY]);
+
+            if (i % 3 == 0)
+                cmc_assert(h_remove(h, &value));
+        }
+
+        /* Children of a node start at a multiple of CMC_HEAP_ARITY elements */
+        size_t group = CMC_HEAP_ARITY * sizeof(size_t);
+
+        if (CMC_CACHE_LINE_SIZE % group == 0)
+            cmc_assert_equals(size_t, 0, (uintptr_t)(h->buffer + 1) % group);
+
+        size_t last = SIZE_MAX;
+
+        while (h_remove(h, &value))
+        {
+            cmc_assert(value <= last);
+            last = value;
+        }
+
+        h_free(h, NULL);
+    });
+
     CMC_CREATE_TEST(peek, {
         struct heap *h = h_new(100, cmc_max_heap, cmp);
 
@@ -161,4 +219,228 @@ CMC_CREATE_UNIT(heap_test, true, {
 
         h_free(h, NULL);
     });
+
+    CMC_CREATE_TEST(save restore, {
+        struct heap *h = h_new(100, cmc_min_heap, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+
+        for (size_t i = 1; i <= 100; i++)
+            cmc_assert(h_insert(h, (i * 37) % 101));
+
+        FILE *file = tmpfile();
+
+        cmc_assert_not_equals(ptr, NULL, file);
+        cmc_assert(h_save(h, file, write_size));
+
+        rewind(file);
+
+        // The order of the heap is restored too
+        struct heap *r = h_restore(file, cmp, read_size);
+
+        cmc_assert_not_equals(ptr, NULL, r);
+        cmc_assert_equals(size_t, 100, h_count(r));
+
+        size_t value;
+
+        for (size_t i = 1; i <= 100; i++)
+        {
+            cmc_assert(h_remove(r, &value));
+            cmc_assert_equals(size_t, i, value);
+        }
+
+        fclose(file);
+        h_free(r, NULL);
+        h_free(h, NULL);
+    });
+    CMC_CREATE_TEST(new_from, {
+        size_t elements[1000];
+
+        for (size_t i = 0; i < 1000; i++)
+            elements[i] = (i * 7919) % 1000;
+
+        struct heap *h = h_new_from(elements, 1000, cmc_min_heap, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+        cmc_assert_equals(size_t, 1000, h_count(h));
+        cmc_assert_equals(size_t, 1000, h_capacity(h));
+
+        size_t r;
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            cmc_assert(h_remove(h, &r));
+            cmc_assert_equals(size_t, i, r);
+        }
+
+        h_free(h, NULL);
+
+        h = h_new_from(NULL, 0, cmc_max_heap, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+        cmc_assert(h_empty(h));
+
+        h_free(h, NULL);
+    });
+
+    CMC_CREATE_TEST(insert_many, {
+        struct heap *h = h_new(1, cmc_max_heap, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+
+        size_t elements[300];
+
+        for (size_t i = 0; i < 300; i++)
+            elements[i] = (i * 101) % 300;
+
+        /* The first batch is heapified and the smaller ones float up */
+        cmc_assert(h_insert_many(h, elements, 201));
+        cmc_assert(h_insert_many(h, elements + 201, 98));
+        cmc_assert(h_insert_many(h, elements + 299, 1));
+        cmc_assert(h_insert_many(h, elements, 0));
+        cmc_assert_equals(size_t, 300, h_count(h));
+
+        size_t r;
+
+        for (size_t i = 0; i < 300; i++)
+        {
+            cmc_assert(h_remove(h, &r));
+            cmc_assert_equals(size_t, 299 - i, r);
+        }
+
+        h_free(h, NULL);
+    });
+
+    CMC_CREATE_TEST(offer_bounded, {
+        struct heap *h = h_new(1, cmc_min_heap, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+        cmc_assert(!h_offer_bounded(h, 1, 0));
+
+        /* A MinHeap keeps the 10 largest */
+        for (size_t i = 0; i < 1000; i++)
+            h_offer_bounded(h, (i * 7919) % 1000, 10);
+
+        cmc_assert_equals(size_t, 10, h_count(h));
+        cmc_assert_equals(size_t, 990, h_peek(h));
+        cmc_assert(!h_offer_bounded(h, 990, 10));
+        cmc_assert(h_offer_bounded(h, 991, 10));
+
+        size_t r;
+
+        /* 990 was replaced by the second 991 */
+        cmc_assert(h_remove(h, &r));
+        cmc_assert_equals(size_t, 991, r);
+
+        for (size_t i = 991; i < 1000; i++)
+        {
+            cmc_assert(h_remove(h, &r));
+            cmc_assert_equals(size_t, i, r);
+        }
+
+        h_free(h, NULL);
+
+        /* A MaxHeap keeps the 5 smallest */
+        h = h_new(1, cmc_max_heap, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+
+        for (size_t i = 1000; i > 0; i--)
+            h_offer_bounded(h, i, 5);
+
+        cmc_assert_equals(size_t, 5, h_count(h));
+        cmc_assert_equals(size_t, 5, h_peek(h));
+
+        h_free(h, NULL);
+    });
+
+    CMC_CREATE_TEST(top_k, {
+        size_t elements[1000];
+        size_t out[1000];
+
+        /* Many repeated elements */
+        for (size_t i = 0; i < 1000; i++)
+            elements[i] = (i * 7919) % 250;
+
+        cmc_assert(h_top_k(elements, 1000, 0, out, cmc_max_heap, cmp));
+        cmc_assert(!h_top_k(elements, 1000, 10, out, 0, cmp));
+
+        for (size_t k = 1; k <= 1000; k += 111)
+        {
+            cmc_assert(h_top_k(elements, 1000, k, out, cmc_max_heap, cmp));
+
+            for (size_t i = 0; i < k; i++)
+                cmc_assert_equals(size_t, 249 - i / 4, out[i]);
+
+            cmc_assert(h_top_k(elements, 1000, k, out, cmc_min_heap, cmp));
+
+            for (size_t i = 0; i < k; i++)
+                cmc_assert_equals(size_t, i / 4, out[i]);
+        }
+
+        /* Sorted and reversed elements and a k greater than n */
+        for (size_t i = 0; i < 1000; i++)
+            elements[i] = i;
+
+        cmc_assert(h_top_k(elements, 1000, 2000, out, cmc_max_heap, cmp));
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert_equals(size_t, 999 - i, out[i]);
+
+        for (size_t i = 0; i < 1000; i++)
+            elements[i] = 999 - i;
+
+        cmc_assert(h_top_k(elements, 1000, 500, out, cmc_min_heap, cmp));
+
+        for (size_t i = 0; i < 500; i++)
+            cmc_assert_equals(size_t, i, out[i]);
+
+        /* The elements given are not changed */
+        cmc_assert_equals(size_t, 999, elements[0]);
+    });
+
+    CMC_CREATE_TEST(to_array, {
+        struct heap *h = h_new(100, cmc_max_heap, cmp);
+
+        for (size_t i = 0; i < 50; i++)
+            h_insert(h, i);
+
+        size_t elements[50] = { 0 };
+
+        cmc_assert_equals(size_t, 50, h_to_array(h, elements, 100));
+
+        /* Same order as the buffer */
+        cmc_assert_equals(size_t, 49, elements[0]);
+
+        for (size_t i = 1; i < 50; i++)
+            cmc_assert_lesser_equals(size_t, elements[(i - 1) / CMC_HEAP_ARITY], elements[i]);
+
+        cmc_assert_equals(size_t, 3, h_to_array(h, elements, 3));
+
+        h_free(h, NULL);
+    });
+
+    CMC_CREATE_TEST(remove_if, {
+        struct heap *h = h_new(100, cmc_max_heap, cmp);
+
+        for (size_t i = 0; i < 100; i++)
+            h_insert(h, i);
+
+        cmc_assert_equals(size_t, 50, h_remove_if(h, h_is_odd, NULL));
+        cmc_assert_equals(size_t, 50, h_count(h));
+        cmc_assert_equals(size_t, 0, h_remove_if(h, h_is_odd, NULL));
+
+        size_t result;
+
+        /* Still a heap after the removals */
+        for (size_t i = 0; i < 50; i++)
+        {
+            cmc_assert(h_remove(h, &result));
+            cmc_assert_equals(size_t, 98 - i * 2, result);
+        }
+
+        cmc_assert(h_empty(h));
+
+        h_free(h, NULL);
+    });
 });
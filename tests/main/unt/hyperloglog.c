@@ -0,0 +1,143 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/hyperloglog.h>
+
+CMC_GENERATE_HYPERLOGLOG(hll, hyperloglog, size_t)
+
+CMC_CREATE_UNIT(hyperloglog_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct hyperloglog *counter = hll_new(14, hash);
+
+        cmc_assert_not_equals(ptr, NULL, counter);
+        cmc_assert_equals(size_t, 14, hll_precision(counter));
+        cmc_assert_equals(size_t, 16384, hll_registers(counter));
+        cmc_assert_equals(size_t, 0, hll_cardinality(counter));
+        cmc_assert_equals(size_t, 0, (uintptr_t)counter->registers % CMC_CACHE_LINE_SIZE);
+        cmc_assert(hll_empty(counter));
+
+        hll_free(counter);
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct hyperloglog *counter = hll_new_custom(14, hash, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, counter);
+
+        for (size_t i = 0; i < 1000; i++)
+            hll_insert(counter, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        hll_free(counter);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(new[edge cases], {
+        cmc_assert_equals(ptr, NULL, hll_new(CMC_HYPERLOGLOG_MIN_PRECISION - 1, hash));
+        cmc_assert_equals(ptr, NULL, hll_new(CMC_HYPERLOGLOG_MAX_PRECISION + 1, hash));
+
+        struct hyperloglog *counter = hll_new(CMC_HYPERLOGLOG_MIN_PRECISION, hash);
+
+        cmc_assert_not_equals(ptr, NULL, counter);
+        cmc_assert_equals(size_t, 16, hll_registers(counter));
+
+        hll_free(counter);
+    });
+
+    CMC_CREATE_TEST(insert[duplicates], {
+        struct hyperloglog *counter = hll_new(14, hash);
+
+        cmc_assert_not_equals(ptr, NULL, counter);
+
+        cmc_assert(hll_insert(counter, 1));
+        cmc_assert(!hll_insert(counter, 1));
+        cmc_assert(!hll_empty(counter));
+
+        // Small cardinalities are close to exact
+        for (size_t j = 0; j < 10; j++)
+        {
+            for (size_t i = 0; i < 100; i++)
+                hll_insert(counter, i);
+        }
+
+        cmc_assert_greater_equals(size_t, 98, hll_cardinality(counter));
+        cmc_assert_lesser_equals(size_t, 102, hll_cardinality(counter));
+
+        hll_clear(counter);
+
+        cmc_assert(hll_empty(counter));
+        cmc_assert_equals(size_t, 0, hll_cardinality(counter));
+
+        hll_free(counter);
+    });
+
+    CMC_CREATE_TEST(estimate, {
+        struct hyperloglog *counter = hll_new(14, hash);
+
+        cmc_assert_not_equals(ptr, NULL, counter);
+
+        // The standard error at a precision of 14 is about 0.8%
+        for (size_t i = 1; i <= 200000; i++)
+        {
+            hll_insert(counter, i);
+
+            if (i % 20000 == 0)
+            {
+                size_t cardinality = hll_cardinality(counter);
+
+                cmc_assert_greater_equals(size_t, i - i * 3 / 100, cardinality);
+                cmc_assert_lesser_equals(size_t, i + i * 3 / 100, cardinality);
+            }
+        }
+
+        hll_free(counter);
+    });
+
+    CMC_CREATE_TEST(merge, {
+        struct hyperloglog *counter1 = hll_new(12, hash);
+        struct hyperloglog *counter2 = hll_new(12, hash);
+        struct hyperloglog *all = hll_new(12, hash);
+        struct hyperloglog *other = hll_new(13, hash);
+
+        cmc_assert_not_equals(ptr, NULL, counter1);
+        cmc_assert_not_equals(ptr, NULL, counter2);
+        cmc_assert_not_equals(ptr, NULL, all);
+        cmc_assert_not_equals(ptr, NULL, other);
+
+        // Both have the elements from 5000 to 10000
+        for (size_t i = 0; i < 10000; i++)
+        {
+            hll_insert(counter1, i);
+            hll_insert(counter2, i + 5000);
+        }
+
+        for (size_t i = 0; i < 15000; i++)
+            hll_insert(all, i);
+
+        cmc_assert_equals(ptr, NULL, hll_merge(counter1, other));
+        cmc_assert(!hll_merge_into(counter1, other));
+
+        struct hyperloglog *result = hll_merge(counter1, counter2);
+
+        cmc_assert_not_equals(ptr, NULL, result);
+
+        // The same as inserting every element into a single one
+        cmc_assert(hll_equals(result, all));
+        cmc_assert(!hll_equals(result, counter1));
+
+        cmc_assert(hll_merge_into(counter1, counter2));
+        cmc_assert(hll_equals(counter1, all));
+
+        hll_free(result);
+        hll_free(other);
+        hll_free(all);
+        hll_free(counter2);
+        hll_free(counter1);
+    });
+});
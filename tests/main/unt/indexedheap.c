@@ -0,0 +1,237 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/indexedheap.h>
+
+CMC_GENERATE_INDEXEDHEAP(idh, indexedheap, size_t)
+
+/* If every handle in the heap is below its parent and where its entry says */
+static bool indexedheap_valid(struct indexedheap *h)
+{
+    for (size_t i = 0; i < h->handles; i++)
+    {
+        if (h->entries[h->buffer[i]].position != i)
+            return false;
+
+        size_t parent = (i - 1) / CMC_HEAP_ARITY;
+
+        if (i > 0 && i < h->count &&
+            h->entries[h->buffer[i]].value > h->entries[h->buffer[parent]].value)
+            return false;
+    }
+
+    return true;
+}
+
+CMC_CREATE_UNIT(indexedheap_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct indexedheap *h = idh_new(100, cmc_max_heap, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+        cmc_assert_not_equals(ptr, NULL, h->buffer);
+        cmc_assert_not_equals(ptr, NULL, h->entries);
+        cmc_assert_equals(size_t, 100, idh_capacity(h));
+        cmc_assert(idh_empty(h));
+        cmc_assert(!idh_peek(h, NULL, NULL));
+        cmc_assert(!idh_remove(h, NULL, NULL));
+
+        idh_free(h, NULL);
+
+        cmc_assert_equals(ptr, NULL, idh_new(0, cmc_max_heap, cmp));
+        cmc_assert_equals(ptr, NULL, idh_new(UINT64_MAX, cmc_max_heap, cmp));
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct indexedheap *h = idh_new_custom(100, cmc_max_heap, cmp, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+
+        for (size_t i = 0; i < 1000; i++)
+            idh_insert(h, i, NULL);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        idh_free(h, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(insert remove, {
+        struct indexedheap *h = idh_new(1, cmc_max_heap, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+
+        size_t handles[1000];
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(idh_insert(h, (i * 7919) % 1000, &handles[i]));
+
+        cmc_assert_equals(size_t, 1000, idh_count(h));
+        cmc_assert(indexedheap_valid(h));
+
+        /* Handles are given in order while none is free */
+        for (size_t i = 0; i < 1000; i++)
+        {
+            cmc_assert_equals(size_t, i, handles[i]);
+            cmc_assert_equals(size_t, (i * 7919) % 1000, idh_get(h, handles[i]));
+        }
+
+        size_t value;
+        size_t handle;
+
+        cmc_assert(idh_peek(h, &value, &handle));
+        cmc_assert_equals(size_t, 999, value);
+        cmc_assert_equals(size_t, 999, idh_get(h, handle));
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            cmc_assert(idh_remove(h, &value, &handle));
+            cmc_assert_equals(size_t, 999 - i, value);
+            cmc_assert(!idh_contains(h, handle));
+        }
+
+        cmc_assert(idh_empty(h));
+
+        idh_free(h, NULL);
+    });
+
+    CMC_CREATE_TEST(decrease_key increase_key, {
+        struct indexedheap *h = idh_new(100, cmc_min_heap, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(idh_insert(h, 1000 + i, NULL));
+
+        size_t top;
+
+        /* The last handle moves to the top and then back to the bottom */
+        cmc_assert(idh_decrease_key(h, 99, 5));
+        cmc_assert(idh_peek(h, NULL, &top));
+        cmc_assert_equals(size_t, 99, top);
+
+        cmc_assert(!idh_decrease_key(h, 99, 6));
+        cmc_assert(!idh_increase_key(h, 99, 4));
+        cmc_assert(idh_increase_key(h, 99, 2000));
+        cmc_assert(idh_peek(h, NULL, &top));
+        cmc_assert_equals(size_t, 0, top);
+
+        cmc_assert(idh_update(h, 50, 1));
+        cmc_assert(idh_update(h, 0, 3000));
+
+        size_t value;
+
+        cmc_assert(idh_remove(h, &value, &top));
+        cmc_assert_equals(size_t, 1, value);
+        cmc_assert_equals(size_t, 50, top);
+
+        size_t last = 0;
+
+        while (idh_remove(h, &value, NULL))
+        {
+            cmc_assert(value >= last);
+            last = value;
+        }
+
+        cmc_assert_equals(size_t, 3000, last);
+        cmc_assert(!idh_update(h, 0, 1));
+
+        idh_free(h, NULL);
+    });
+
+    CMC_CREATE_TEST(remove_handle, {
+        struct indexedheap *h = idh_new(10, cmc_max_heap, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+
+        for (size_t i = 0; i < 500; i++)
+            cmc_assert(idh_insert(h, (i * 37) % 500, NULL));
+
+        size_t value;
+
+        for (size_t i = 0; i < 500; i += 2)
+        {
+            cmc_assert(idh_remove_handle(h, i, &value));
+            cmc_assert_equals(size_t, (i * 37) % 500, value);
+            cmc_assert(!idh_contains(h, i));
+            cmc_assert(!idh_remove_handle(h, i, NULL));
+        }
+
+        cmc_assert_equals(size_t, 250, idh_count(h));
+        cmc_assert(indexedheap_valid(h));
+
+        /* Free handles are taken before new ones */
+        size_t handle;
+
+        cmc_assert(idh_insert(h, 10000, &handle));
+        cmc_assert(handle < 500 && handle % 2 == 0);
+        cmc_assert_equals(size_t, 500, h->handles);
+        cmc_assert(idh_peek(h, &value, NULL));
+        cmc_assert_equals(size_t, 10000, value);
+        cmc_assert(!idh_remove_handle(h, 500, NULL));
+
+        idh_clear(h, NULL);
+
+        cmc_assert(idh_empty(h));
+        cmc_assert(!idh_contains(h, handle));
+
+        idh_free(h, NULL);
+    });
+
+    CMC_CREATE_TEST(random, {
+        struct indexedheap *h = idh_new(1, cmc_max_heap, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+
+        /* Value of each handle or SIZE_MAX if it is not in the heap */
+        size_t expected[2000];
+
+        for (size_t i = 0; i < 2000; i++)
+            expected[i] = SIZE_MAX;
+
+        size_t x = 1;
+
+        for (size_t i = 0; i < 20000; i++)
+        {
+            x = x * 6364136223846793005u + 1442695040888963407u;
+
+            size_t r = x >> 33;
+            size_t handle = r % 2000;
+
+            if (r % 5 < 2 && h->count < 2000)
+            {
+                cmc_assert(idh_insert(h, r % 997, &handle));
+                cmc_assert_equals(size_t, SIZE_MAX, expected[handle]);
+                expected[handle] = r % 997;
+            }
+            else if (r % 5 < 4)
+            {
+                bool updated = idh_update(h, handle, r % 991);
+
+                cmc_assert_equals(bool, expected[handle] != SIZE_MAX, updated);
+
+                if (expected[handle] != SIZE_MAX)
+                    expected[handle] = r % 991;
+            }
+            else if (expected[handle] != SIZE_MAX)
+            {
+                cmc_assert(idh_remove_handle(h, handle, NULL));
+                expected[handle] = SIZE_MAX;
+            }
+        }
+
+        cmc_assert(indexedheap_valid(h));
+
+        for (size_t i = 0; i < 2000; i++)
+        {
+            if (expected[i] != SIZE_MAX)
+                cmc_assert_equals(size_t, expected[i], idh_get(h, i));
+        }
+
+        idh_free(h, NULL);
+    });
+});
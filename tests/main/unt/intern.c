@@ -0,0 +1,127 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/hashmap.h>
+#include <utl/intern.h>
+
+CMC_GENERATE_HASHMAP(him, hashmap_interned, const char *, size_t)
+
+CMC_CREATE_UNIT(intern_test, true, {
+    CMC_CREATE_TEST(intern, {
+        struct cmc_intern in = { 0 };
+
+        const char *a = cmc_intern_str(&in, "apple");
+        const char *b = cmc_intern(&in, "apple pie", 5);
+        const char *c = cmc_intern_str(&in, "banana");
+
+        cmc_assert_not_equals(ptr, NULL, (void *)a);
+        cmc_assert_equals(ptr, (void *)a, (void *)b);
+        cmc_assert_not_equals(ptr, (void *)a, (void *)c);
+        cmc_assert(strcmp(a, "apple") == 0);
+        cmc_assert_equals(size_t, 2, cmc_intern_count(&in));
+
+        cmc_assert_equals(size_t, 0, cmc_intern_id(a));
+        cmc_assert_equals(size_t, 1, cmc_intern_id(c));
+        cmc_assert_equals(size_t, 6, cmc_intern_length(c));
+        cmc_assert_equals(ptr, (void *)c, (void *)cmc_intern_string(&in, 1));
+        cmc_assert_equals(ptr, NULL, (void *)cmc_intern_string(&in, 2));
+
+        cmc_assert_equals(ptr, (void *)c, (void *)cmc_intern_find(&in, "banana", 6));
+        cmc_assert_equals(ptr, NULL, (void *)cmc_intern_find(&in, "cherry", 6));
+        cmc_assert_equals(size_t, 2, cmc_intern_count(&in));
+
+        // Strings with zeros in them and the empty string
+        const char *z = cmc_intern(&in, "a\0b", 3);
+        const char *e = cmc_intern(&in, "", 0);
+
+        cmc_assert_not_equals(ptr, (void *)a, (void *)z);
+        cmc_assert_equals(size_t, 3, cmc_intern_length(z));
+        cmc_assert_equals(ptr, (void *)e, (void *)cmc_intern_str(&in, ""));
+        cmc_assert_equals(size_t, 0, cmc_intern_length(e));
+
+        cmc_intern_release(&in);
+
+        cmc_assert_equals(size_t, 0, cmc_intern_count(&in));
+        cmc_assert_equals(ptr, NULL, (void *)cmc_intern_find(&in, "apple", 5));
+    });
+
+    CMC_CREATE_TEST(stable[count allocations], {
+        count_alloc_reset();
+
+        struct cmc_intern in = { 0 };
+        char buffer[32];
+        const char *first[100];
+
+        in.alloc = &count_alloc;
+
+        for (size_t i = 0; i < 100; i++)
+        {
+            snprintf(buffer, sizeof(buffer), "key_%" PRIuMAX, (uintmax_t)i);
+            first[i] = cmc_intern_str(&in, buffer);
+        }
+
+        // Growing the table and adding chunks does not move strings
+        for (size_t i = 0; i < 100000; i++)
+        {
+            snprintf(buffer, sizeof(buffer), "key_%" PRIuMAX, (uintmax_t)i);
+            cmc_intern_str(&in, buffer);
+        }
+
+        cmc_assert_equals(size_t, 100000, cmc_intern_count(&in));
+
+        bool stable = true;
+
+        for (size_t i = 0; i < 100; i++)
+        {
+            snprintf(buffer, sizeof(buffer), "key_%" PRIuMAX, (uintmax_t)i);
+            stable = stable && cmc_intern_str(&in, buffer) == first[i] &&
+                     strcmp(first[i], buffer) == 0 && cmc_intern_id(first[i]) == i;
+        }
+
+        cmc_assert(stable);
+
+        // A string larger than a chunk
+        char *large = malloc(CMC_INTERN_CHUNK_SIZE * 2);
+
+        memset(large, 'x', CMC_INTERN_CHUNK_SIZE * 2);
+
+        const char *interned = cmc_intern(&in, large, CMC_INTERN_CHUNK_SIZE * 2);
+
+        cmc_assert_not_equals(ptr, NULL, (void *)interned);
+        cmc_assert(memcmp(interned, large, CMC_INTERN_CHUNK_SIZE * 2) == 0);
+        cmc_assert_greater(size_t, CMC_INTERN_CHUNK_SIZE * 2, cmc_intern_memory_usage(&in));
+
+        free(large);
+        cmc_intern_release(&in);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(hashmap keys, {
+        struct cmc_intern in = { 0 };
+        struct hashmap_interned *map = him_new(16, 0.7, cmc_intern_cmp, cmc_intern_hash);
+        char buffer[32];
+
+        for (size_t i = 0; i < 5000; i++)
+        {
+            snprintf(buffer, sizeof(buffer), "word_%" PRIuMAX, (uintmax_t)(i % 1000));
+
+            size_t *count = him_get_ref(map, cmc_intern_str(&in, buffer));
+
+            if (count)
+                *count += 1;
+            else
+                him_insert(map, cmc_intern_str(&in, buffer), 1);
+        }
+
+        cmc_assert_equals(size_t, 1000, him_count(map));
+        cmc_assert_equals(size_t, 1000, cmc_intern_count(&in));
+        cmc_assert_equals(size_t, 5, him_get(map, cmc_intern_str(&in, "word_999")));
+        cmc_assert(!him_contains(map, cmc_intern_str(&in, "word_1000")));
+
+        him_free(map, NULL);
+        cmc_intern_release(&in);
+    });
+});
@@ -19,6 +19,23 @@ CMC_CREATE_UNIT(intervalheap_test, true, {
         ih_free(ih, NULL);
     });
 
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct intervalheap *ih = ih_new_custom(100, cmp, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, ih);
+
+        for (size_t i = 0; i < 1000; i++)
+            ih_insert(ih, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        ih_free(ih, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
     CMC_CREATE_TEST(new[capacity = 0], {
         struct intervalheap *ih = ih_new(0, cmp);
 
@@ -99,6 +116,64 @@ CMC_CREATE_UNIT(intervalheap_test, true, {
         ih_free(ih, NULL);
     });
 
+    CMC_CREATE_TEST(remove_min[low water shrink], {
+        struct intervalheap *ih = ih_new(100, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, ih);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(ih_insert(ih, i));
+
+        size_t r;
+
+        for (size_t i = 0; i < 90; i++)
+        {
+            cmc_assert(ih_remove_min(ih, &r));
+            cmc_assert_equals(size_t, i, r);
+        }
+
+        cmc_assert(ih_capacity(ih) < 50);
+
+        cmc_assert(ih_shrink_to_fit(ih));
+        cmc_assert_equals(size_t, 5, ih_capacity(ih));
+
+        for (size_t i = 90; i < 100; i++)
+        {
+            cmc_assert(ih_remove_min(ih, &r));
+            cmc_assert_equals(size_t, i, r);
+        }
+
+        cmc_assert(ih_empty(ih));
+
+        ih_free(ih, NULL);
+    });
+
+    CMC_CREATE_TEST(reserve, {
+        struct intervalheap *ih = ih_new(10, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, ih);
+
+        /* Capacities are in elements, two in each node */
+        cmc_assert(ih_reserve(ih, 100));
+        cmc_assert_equals(size_t, 50, ih_capacity(ih));
+        cmc_assert(ih_reserve(ih, 20));
+        cmc_assert_equals(size_t, 50, ih_capacity(ih));
+
+        for (size_t i = 0; i < 101; i++)
+            cmc_assert(ih_insert(ih, 100 - i));
+
+        cmc_assert_equals(size_t, 100, ih_capacity(ih));
+
+        size_t r;
+
+        cmc_assert(ih_min(ih, &r));
+        cmc_assert_equals(size_t, 0, r);
+        cmc_assert(ih_max(ih, &r));
+        cmc_assert_equals(size_t, 100, r);
+
+        ih_free(ih, NULL);
+    });
+
     CMC_CREATE_TEST(insert[count], {
         struct intervalheap *ih = ih_new(100, cmp);
 
@@ -131,4 +206,164 @@ CMC_CREATE_UNIT(intervalheap_test, true, {
 
         ih_free(ih, NULL);
     });
+    CMC_CREATE_TEST(insert remove[random], {
+        struct intervalheap *ih = ih_new(1, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, ih);
+
+        /* How many of each value are in the heap */
+        size_t counts[64];
+
+        for (size_t i = 0; i < 64; i++)
+            counts[i] = 0;
+
+        size_t x = 1;
+
+        /* The heap gets empty often and each end is checked on every removal */
+        for (size_t i = 0; i < 20000; i++)
+        {
+            x = x * 6364136223846793005u + 1442695040888963407u;
+
+            size_t r = x >> 33;
+            size_t result;
+
+            if (r % 3 == 0 || ih_empty(ih))
+            {
+                cmc_assert(ih_insert(ih, r % 64));
+                counts[r % 64]++;
+                continue;
+            }
+
+            bool max = r % 3 == 1;
+
+            cmc_assert(max ? ih_remove_max(ih, &result) : ih_remove_min(ih, &result));
+
+            for (size_t k = max ? result + 1 : 0; k < (max ? 64 : result); k++)
+                cmc_assert_equals(size_t, 0, counts[k]);
+
+            counts[result]--;
+        }
+
+        ih_free(ih, NULL);
+    });
+
+    CMC_CREATE_TEST(new_from, {
+        size_t elements[1001];
+
+        for (size_t i = 0; i < 1001; i++)
+            elements[i] = (i * 7919) % 1001;
+
+        struct intervalheap *ih = ih_new_from(elements, 1001, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, ih);
+        cmc_assert_equals(size_t, 1001, ih_count(ih));
+
+        size_t r;
+
+        /* Both ends come out in order */
+        for (size_t i = 0; i < 500; i++)
+        {
+            cmc_assert(ih_remove_min(ih, &r));
+            cmc_assert_equals(size_t, i, r);
+            cmc_assert(ih_remove_max(ih, &r));
+            cmc_assert_equals(size_t, 1000 - i, r);
+        }
+
+        cmc_assert(ih_remove_min(ih, &r));
+        cmc_assert_equals(size_t, 500, r);
+        cmc_assert(ih_empty(ih));
+
+        ih_free(ih, NULL);
+    });
+
+    CMC_CREATE_TEST(insert_many, {
+        struct intervalheap *ih = ih_new_from(NULL, 0, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, ih);
+
+        size_t elements[300];
+
+        for (size_t i = 0; i < 300; i++)
+            elements[i] = (i * 101) % 300;
+
+        /* The first batch is heapified and the smaller ones inserted */
+        cmc_assert(ih_insert_many(ih, elements, 201));
+        cmc_assert(ih_insert_many(ih, elements + 201, 98));
+        cmc_assert(ih_insert_many(ih, elements + 299, 1));
+        cmc_assert(ih_insert_many(ih, elements, 0));
+        cmc_assert_equals(size_t, 300, ih_count(ih));
+
+        size_t r;
+
+        for (size_t i = 0; i < 150; i++)
+        {
+            cmc_assert(ih_remove_max(ih, &r));
+            cmc_assert_equals(size_t, 299 - i, r);
+            cmc_assert(ih_remove_min(ih, &r));
+            cmc_assert_equals(size_t, i, r);
+        }
+
+        cmc_assert(ih_empty(ih));
+
+        ih_free(ih, NULL);
+    });
+
+    CMC_CREATE_TEST(offer_bounded, {
+        struct intervalheap *ih = ih_new(1, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, ih);
+        cmc_assert(!ih_offer_bounded_max(ih, 1, 0));
+
+        for (size_t i = 0; i < 1000; i++)
+            ih_offer_bounded_max(ih, (i * 7919) % 1000, 10);
+
+        size_t r;
+
+        cmc_assert_equals(size_t, 10, ih_count(ih));
+        cmc_assert(ih_min(ih, &r));
+        cmc_assert_equals(size_t, 990, r);
+        cmc_assert(ih_max(ih, &r));
+        cmc_assert_equals(size_t, 999, r);
+        cmc_assert(!ih_offer_bounded_max(ih, 990, 10));
+
+        ih_clear(ih, NULL);
+
+        for (size_t i = 0; i < 1000; i++)
+            ih_offer_bounded_min(ih, (i * 7919) % 1000, 10);
+
+        cmc_assert_equals(size_t, 10, ih_count(ih));
+        cmc_assert(!ih_offer_bounded_min(ih, 9, 10));
+        cmc_assert(ih_offer_bounded_min(ih, 8, 10));
+
+        for (size_t i = 0; i < 10; i++)
+        {
+            cmc_assert(ih_remove_min(ih, &r));
+            cmc_assert_equals(size_t, i == 9 ? 8 : i, r);
+        }
+
+        ih_free(ih, NULL);
+    });
+
+    CMC_CREATE_TEST(to_array, {
+        struct intervalheap *h = ih_new(100, cmp);
+
+        for (size_t i = 0; i < 51; i++)
+            ih_insert(h, i);
+
+        size_t elements[51] = { 0 };
+        size_t sum = 0;
+
+        cmc_assert_equals(size_t, 51, ih_to_array(h, elements, 100));
+
+        for (size_t i = 0; i < 51; i++)
+            sum += elements[i];
+
+        cmc_assert_equals(size_t, 50 * 51 / 2, sum);
+        cmc_assert_equals(size_t, 0, elements[0]);
+        cmc_assert_equals(size_t, 50, elements[1]);
+
+        cmc_assert_equals(size_t, 4, ih_to_array(h, elements, 4));
+
+        ih_free(h, NULL);
+    });
 });
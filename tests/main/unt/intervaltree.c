@@ -0,0 +1,188 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/intervaltree.h>
+
+CMC_GENERATE_INTERVALTREE(itv, intervaltree, size_t, size_t)
+
+/* Checks the height and the max of every node and returns the height */
+size_t itv_check(struct intervaltree_node *node, bool *valid)
+{
+    if (!node)
+        return 0;
+
+    size_t hl = itv_check(node->left, valid);
+    size_t hr = itv_check(node->right, valid);
+
+    size_t max = node->high;
+
+    if (node->left && node->left->max > max)
+        max = node->left->max;
+    if (node->right && node->right->max > max)
+        max = node->right->max;
+
+    if (node->max != max || node->height != 1 + (hl > hr ? hl : hr))
+        *valid = false;
+    if (hl > hr + 1 || hr > hl + 1)
+        *valid = false;
+
+    return node->height;
+}
+
+CMC_CREATE_UNIT(intervaltree_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct intervaltree *tree = itv_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, tree);
+        cmc_assert(itv_empty(tree));
+        cmc_assert_equals(size_t, 0, itv_stab(tree, 1, NULL, 0));
+        cmc_assert(!itv_overlaps_any(tree, 0, 100));
+        cmc_assert(!itv_span(tree, NULL, NULL));
+
+        itv_free(tree, NULL);
+
+        cmc_assert_equals(ptr, NULL, itv_new(NULL));
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct intervaltree *tree = itv_new_custom(cmp, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, tree);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(itv_insert(tree, i, i + 10, i));
+
+        cmc_assert_equals(size_t, 101, count_alloc_live);
+
+        itv_free(tree, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(insert, {
+        struct intervaltree *tree = itv_new(cmp);
+
+        cmc_assert(itv_insert(tree, 10, 20, 1));
+        cmc_assert(itv_insert(tree, 10, 15, 2));
+        cmc_assert(itv_insert(tree, 5, 5, 3));
+        cmc_assert(!itv_insert(tree, 10, 20, 4));
+        cmc_assert(!itv_insert(tree, 30, 25, 5));
+
+        cmc_assert_equals(size_t, 3, itv_count(tree));
+        cmc_assert_equals(size_t, 1, itv_get(tree, 10, 20));
+        cmc_assert_equals(size_t, 2, itv_get(tree, 10, 15));
+        cmc_assert(itv_contains(tree, 5, 5));
+        cmc_assert(!itv_contains(tree, 5, 6));
+
+        size_t low = 0;
+        size_t high = 0;
+
+        cmc_assert(itv_span(tree, &low, &high));
+        cmc_assert_equals(size_t, 5, low);
+        cmc_assert_equals(size_t, 20, high);
+
+        size_t old = 0;
+
+        cmc_assert(itv_update(tree, 10, 15, 7, &old));
+        cmc_assert_equals(size_t, 2, old);
+        cmc_assert_equals(size_t, 7, *itv_get_ref(tree, 10, 15));
+
+        itv_free(tree, NULL);
+    });
+
+    CMC_CREATE_TEST(overlaps, {
+        struct intervaltree *tree = itv_new(cmp);
+        struct intervaltree_interval result[8];
+
+        // [0, 9], [10, 19], ... [990, 999] and [500, 2000]
+        for (size_t i = 0; i < 100; i++)
+            itv_insert(tree, i * 10, i * 10 + 9, i);
+
+        itv_insert(tree, 500, 2000, 1000);
+
+        cmc_assert_equals(size_t, 1, itv_stab(tree, 15, result, 8));
+        cmc_assert_equals(size_t, 10, result[0].low);
+        cmc_assert_equals(size_t, 19, result[0].high);
+        cmc_assert_equals(size_t, 1, result[0].value);
+
+        cmc_assert_equals(size_t, 2, itv_stab(tree, 505, result, 8));
+        cmc_assert_equals(size_t, 509, result[0].high);
+        cmc_assert_equals(size_t, 1000, result[1].value);
+
+        cmc_assert_equals(size_t, 1, itv_stab(tree, 1500, result, 8));
+        cmc_assert_equals(size_t, 0, itv_stab(tree, 2001, result, 8));
+
+        // Counts all of them but only writes size
+        cmc_assert_equals(size_t, 5, itv_overlaps(tree, 25, 61, result, 8));
+        cmc_assert_equals(size_t, 21, itv_overlaps(tree, 400, 599, result, 8));
+        cmc_assert_equals(size_t, 400, result[0].low);
+        cmc_assert_equals(size_t, 470, result[7].low);
+        cmc_assert_equals(size_t, 0, itv_overlaps(tree, 30, 20, result, 8));
+
+        cmc_assert(itv_overlaps_any(tree, 1999, 3000));
+        cmc_assert(!itv_overlaps_any(tree, 2001, 3000));
+
+        itv_free(tree, NULL);
+    });
+
+    CMC_CREATE_TEST(remove[balanced], {
+        struct intervaltree *tree = itv_new(cmp);
+
+        for (size_t i = 0; i < 1000; i++)
+            itv_insert(tree, (i * 7919) % 1000, (i * 7919) % 1000 + i % 13, i);
+
+        bool valid = true;
+
+        itv_check(tree->root, &valid);
+        cmc_assert(valid);
+
+        // Every query agrees with a full scan
+        bool agrees = true;
+
+        for (size_t p = 0; p < 1020; p += 3)
+        {
+            size_t expected = 0;
+
+            for (size_t i = 0; i < 1000; i++)
+            {
+                size_t low = (i * 7919) % 1000;
+
+                if (low <= p && p <= low + i % 13)
+                    expected++;
+            }
+
+            agrees = agrees && itv_stab(tree, p, NULL, 0) == expected;
+        }
+
+        cmc_assert(agrees);
+
+        size_t value = 0;
+
+        for (size_t i = 0; i < 1000; i += 2)
+            cmc_assert(itv_remove(tree, (i * 7919) % 1000, (i * 7919) % 1000 + i % 13, &value));
+
+        cmc_assert_equals(size_t, 998, value);
+        cmc_assert_equals(size_t, 500, itv_count(tree));
+        cmc_assert(!itv_remove(tree, 0, 0, NULL));
+
+        itv_check(tree->root, &valid);
+        cmc_assert(valid);
+
+        size_t high = 0;
+
+        itv_span(tree, NULL, &high);
+
+        cmc_assert_equals(size_t, tree->root->max, high);
+
+        itv_clear(tree, NULL);
+
+        cmc_assert(itv_empty(tree));
+        cmc_assert_equals(ptr, NULL, tree->root);
+
+        itv_free(tree, NULL);
+    });
+});
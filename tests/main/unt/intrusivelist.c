@@ -0,0 +1,165 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/intrusivelist.h>
+
+/* An object that is in two lists at once */
+struct il_order
+{
+    size_t id;
+    struct cmc_intrusive_link by_time;
+    struct cmc_intrusive_link by_level;
+};
+
+CMC_GENERATE_INTRUSIVE_LIST(ilt, il_time, struct il_order, by_time)
+CMC_GENERATE_INTRUSIVE_LIST(ill, il_level, struct il_order, by_level)
+
+static size_t il_deallocated = 0;
+
+static void il_deallocator(struct il_order *order)
+{
+    il_deallocated += order->id;
+}
+
+CMC_CREATE_UNIT(intrusivelist_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct il_time *list = ilt_new();
+
+        cmc_assert_not_equals(ptr, NULL, list);
+        cmc_assert(ilt_empty(list));
+        cmc_assert_equals(ptr, NULL, ilt_front(list));
+        cmc_assert_equals(ptr, NULL, ilt_back(list));
+        cmc_assert_equals(ptr, NULL, ilt_pop_front(list));
+        cmc_assert_equals(ptr, NULL, ilt_pop_back(list));
+
+        ilt_free(list, NULL);
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct il_time *list = ilt_new_custom(&count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, list);
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        ilt_free(list, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(push pop remove, {
+        struct il_order orders[10] = { 0 };
+        struct il_time list;
+
+        ilt_init(&list);
+
+        for (size_t i = 0; i < 10; i++)
+        {
+            orders[i].id = i;
+
+            cmc_assert(!ilt_linked(&orders[i]));
+            cmc_assert(ilt_push_back(&list, &orders[i]));
+            cmc_assert(ilt_linked(&orders[i]));
+        }
+
+        /* An object can't be linked twice through the same link */
+        cmc_assert(!ilt_push_front(&list, &orders[3]));
+        cmc_assert_equals(size_t, 10, ilt_count(&list));
+
+        cmc_assert(ilt_remove(&list, &orders[5]));
+        cmc_assert(!ilt_remove(&list, &orders[5]));
+        cmc_assert(!ilt_linked(&orders[5]));
+        cmc_assert_equals(ptr, &orders[6], ilt_next(&list, &orders[4]));
+        cmc_assert_equals(ptr, &orders[4], ilt_prev(&list, &orders[6]));
+
+        cmc_assert(ilt_insert_after(&list, &orders[9], &orders[5]));
+        cmc_assert_equals(ptr, &orders[5], ilt_back(&list));
+        cmc_assert_equals(ptr, NULL, ilt_next(&list, &orders[5]));
+        cmc_assert(ilt_remove(&list, &orders[0]));
+        cmc_assert(!ilt_insert_before(&list, &orders[0], &orders[1]));
+        cmc_assert(ilt_insert_before(&list, &orders[1], &orders[0]));
+        cmc_assert_equals(ptr, &orders[0], ilt_front(&list));
+        cmc_assert_equals(ptr, NULL, ilt_prev(&list, &orders[0]));
+
+        cmc_assert_equals(ptr, &orders[0], ilt_pop_front(&list));
+        cmc_assert_equals(ptr, &orders[5], ilt_pop_back(&list));
+        cmc_assert_equals(size_t, 8, ilt_count(&list));
+
+        il_deallocated = 0;
+        ilt_clear(&list, il_deallocator);
+
+        cmc_assert_equals(size_t, 45 - 5, il_deallocated);
+        cmc_assert(ilt_empty(&list));
+
+        for (size_t i = 0; i < 10; i++)
+            cmc_assert(!ilt_linked(&orders[i]));
+    });
+
+    CMC_CREATE_TEST(two lists, {
+        struct il_order orders[100] = { 0 };
+
+        struct il_time *times = ilt_new();
+        struct il_level *levels = ill_new();
+
+        cmc_assert_not_equals(ptr, NULL, times);
+        cmc_assert_not_equals(ptr, NULL, levels);
+
+        for (size_t i = 0; i < 100; i++)
+        {
+            orders[i].id = i;
+
+            cmc_assert(ilt_push_back(times, &orders[i]));
+
+            if (i % 2 == 0)
+                cmc_assert(ill_push_front(levels, &orders[i]));
+        }
+
+        /* Removing an object from one list leaves it in the other one */
+        for (size_t i = 0; i < 100; i += 4)
+            cmc_assert(ilt_remove(times, &orders[i]));
+
+        cmc_assert_equals(size_t, 75, ilt_count(times));
+        cmc_assert_equals(size_t, 50, ill_count(levels));
+
+        struct il_level_iter iter;
+
+        size_t expected = 98;
+
+        for (ill_iter_init(&iter, levels); !ill_iter_end(&iter); ill_iter_next(&iter))
+        {
+            struct il_order *order = ill_iter_value(&iter);
+
+            cmc_assert_equals(size_t, expected, order->id);
+            cmc_assert_equals(bool, order->id % 4 != 0, ilt_linked(order));
+
+            expected -= 2;
+        }
+
+        cmc_assert_equals(size_t, 49, ill_iter_index(&iter));
+
+        ill_iter_to_start(&iter);
+
+        cmc_assert(ill_iter_advance(&iter, 10));
+        cmc_assert_equals(size_t, 78, ill_iter_value(&iter)->id);
+        cmc_assert(ill_iter_rewind(&iter, 3));
+        cmc_assert_equals(size_t, 84, ill_iter_value(&iter)->id);
+        cmc_assert(ill_iter_go_to(&iter, 49));
+        cmc_assert_equals(size_t, 0, ill_iter_value(&iter)->id);
+        cmc_assert(!ill_iter_advance(&iter, 1));
+
+        ill_iter_to_end(&iter);
+
+        size_t total = 0;
+
+        for (; !ill_iter_start(&iter); ill_iter_prev(&iter))
+            total++;
+
+        cmc_assert_equals(size_t, 50, total);
+
+        ilt_free(times, NULL);
+        ill_free(levels, NULL);
+    });
+});
@@ -7,6 +7,24 @@
 
 CMC_GENERATE_LINKEDLIST(ll, linkedlist, size_t)
 
+static size_t ll_deallocated = 0;
+
+static void ll_deallocator(size_t value)
+{
+    ll_deallocated += value;
+}
+
+static bool ll_is_odd(size_t value)
+{
+    return value % 2 == 1;
+}
+
+/* Compares only the thousands so that the order of equal keys can be seen */
+static int ll_thousands(size_t a, size_t b)
+{
+    return (a / 1000 > b / 1000) - (a / 1000 < b / 1000);
+}
+
 CMC_CREATE_UNIT(linkedlist_test, true, {
     CMC_CREATE_TEST(new, {
         struct linkedlist *ll = ll_new();
@@ -19,6 +37,44 @@ CMC_CREATE_UNIT(linkedlist_test, true, {
         ll_free(ll, NULL);
     });
 
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct linkedlist *ll = ll_new_custom(&count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, ll);
+
+        for (size_t i = 0; i < 1000; i++)
+            ll_push_back(ll, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        ll_free(ll, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(release[arena], {
+        struct linkedlist *ll = ll_new_custom(&test_arena_node);
+
+        cmc_assert_not_equals(ptr, NULL, ll);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(ll_push_back(ll, i));
+
+        ll_release(ll);
+        cmc_arena_reset(&test_arena);
+
+        /* The reset arena hands out the same memory again */
+        struct linkedlist *reused = ll_new_custom(&test_arena_node);
+
+        cmc_assert_equals(ptr, ll, reused);
+        cmc_assert_equals(size_t, 0, ll_count(reused));
+
+        ll_release(reused);
+        cmc_arena_release(&test_arena);
+    });
+
     CMC_CREATE_TEST(clear[count capacity], {
         struct linkedlist *ll = ll_new();
 
@@ -75,4 +131,285 @@ CMC_CREATE_UNIT(linkedlist_test, true, {
 
         ll_free(ll, NULL);
     });
+
+    CMC_CREATE_TEST(pool[reuse], {
+        struct linkedlist *ll = ll_new();
+
+        cmc_assert_not_equals(ptr, NULL, ll);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(ll_push_back(ll, i));
+
+        struct linkedlist_node *node = ll->tail;
+
+        cmc_assert(ll_pop_back(ll));
+        cmc_assert(ll_push_front(ll, 100));
+
+        /* The removed node is the first one to be reused */
+        cmc_assert_equals(ptr, node, ll->head);
+        cmc_assert_equals(size_t, 100, ll_front(ll));
+        cmc_assert_equals(size_t, 98, ll_back(ll));
+
+        cmc_assert(ll_remove_current(ll, ll->head->next));
+        cmc_assert(ll_insert_after(ll, ll->tail, 200));
+        cmc_assert_equals(size_t, 200, ll_back(ll));
+        cmc_assert_equals(size_t, 100, ll_count(ll));
+
+        ll_clear(ll, NULL);
+
+        cmc_assert_equals(ptr, NULL, ll->local_pool.chunks);
+        cmc_assert_equals(ptr, NULL, ll->local_pool.free_nodes);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(ll_push_back(ll, i));
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert_equals(size_t, i, ll_get(ll, i));
+
+        ll_free(ll, NULL);
+    });
+
+    CMC_CREATE_TEST(pool[shared], {
+        struct linkedlist_pool *pool = ll_pool_new();
+
+        cmc_assert_not_equals(ptr, NULL, pool);
+
+        struct linkedlist *ll1 = ll_new_pooled(pool);
+        struct linkedlist *ll2 = ll_new_pooled(pool);
+
+        cmc_assert_not_equals(ptr, NULL, ll1);
+        cmc_assert_not_equals(ptr, NULL, ll2);
+
+        for (size_t i = 1; i <= 300; i++)
+        {
+            cmc_assert(ll_push_back(ll1, i));
+            cmc_assert(ll_push_front(ll2, i));
+        }
+
+        struct linkedlist *ll3 = ll_copy_of(ll1, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, ll3);
+        cmc_assert_equals(ptr, pool, ll3->pool);
+        cmc_assert(ll_equals(ll1, ll3, cmp));
+
+        /* Nodes of a shared pool go back to it instead of being freed */
+        ll_deallocated = 0;
+        ll_clear(ll1, ll_deallocator);
+
+        cmc_assert_equals(size_t, 300 * 301 / 2, ll_deallocated);
+        cmc_assert_not_equals(ptr, NULL, pool->free_nodes);
+        cmc_assert_equals(size_t, 0, ll_count(ll1));
+        cmc_assert_equals(size_t, 300, ll_count(ll2));
+
+        for (size_t i = 0; i < 300; i++)
+            cmc_assert(ll_push_back(ll1, i));
+
+        cmc_assert_equals(ptr, NULL, pool->free_nodes);
+
+        for (size_t i = 0; i < 300; i++)
+        {
+            cmc_assert_equals(size_t, i, ll_get(ll1, i));
+            cmc_assert_equals(size_t, 300 - i, ll_get(ll2, i));
+            cmc_assert_equals(size_t, i + 1, ll_get(ll3, i));
+        }
+
+        ll_free(ll1, NULL);
+        ll_free(ll2, NULL);
+        ll_free(ll3, NULL);
+        ll_pool_free(pool);
+    });
+
+    CMC_CREATE_TEST(splice, {
+        struct linkedlist *ll1 = ll_new();
+        struct linkedlist *ll2 = ll_new();
+
+        cmc_assert_not_equals(ptr, NULL, ll1);
+        cmc_assert_not_equals(ptr, NULL, ll2);
+
+        for (size_t i = 0; i < 10; i++)
+        {
+            cmc_assert(ll_push_back(ll1, i));
+            cmc_assert(ll_push_back(ll2, i + 100));
+        }
+
+        struct linkedlist_node *first = ll_get_node(ll1, 2);
+        struct linkedlist_node *last = ll_get_node(ll1, 4);
+
+        cmc_assert(!ll_splice(ll2, NULL, ll1, last, first));
+
+        /* The lists have their own pools, so the elements get new nodes */
+        cmc_assert(ll_splice(ll2, ll_get_node(ll2, 1), ll1, first, last));
+
+        cmc_assert_equals(size_t, 7, ll_count(ll1));
+        cmc_assert_equals(size_t, 13, ll_count(ll2));
+        cmc_assert_equals(size_t, 5, ll_get(ll1, 2));
+        cmc_assert_equals(size_t, 100, ll_get(ll2, 0));
+        cmc_assert_equals(size_t, 2, ll_get(ll2, 1));
+        cmc_assert_equals(size_t, 4, ll_get(ll2, 3));
+        cmc_assert_equals(size_t, 101, ll_get(ll2, 4));
+
+        /* Moving the whole list to the end of the other one */
+        cmc_assert(ll_splice(ll2, NULL, ll1, ll1->head, ll1->tail));
+
+        cmc_assert(ll_empty(ll1));
+        cmc_assert_equals(ptr, NULL, ll1->head);
+        cmc_assert_equals(ptr, NULL, ll1->tail);
+        cmc_assert_equals(size_t, 20, ll_count(ll2));
+        cmc_assert_equals(size_t, 9, ll_back(ll2));
+        cmc_assert_equals(size_t, 0, ll_get(ll2, 13));
+
+        /* Within the same list the nodes are relinked */
+        first = ll_get_node(ll2, 13);
+        last = ll2->tail;
+
+        cmc_assert(!ll_splice(ll2, ll_get_node(ll2, 15), ll2, first, last));
+        cmc_assert(ll_splice(ll2, ll2->head, ll2, first, last));
+        cmc_assert_equals(ptr, first, ll2->head);
+        cmc_assert_equals(ptr, NULL, ll2->head->prev);
+        cmc_assert_equals(size_t, 20, ll_count(ll2));
+        cmc_assert_equals(size_t, 9, ll_get(ll2, 6));
+        cmc_assert_equals(size_t, 100, ll_get(ll2, 7));
+        cmc_assert_equals(size_t, 109, ll_back(ll2));
+
+        for (struct linkedlist_node *node = ll2->head; node->next; node = node->next)
+            cmc_assert_equals(ptr, node, node->next->prev);
+
+        ll_free(ll1, NULL);
+        ll_free(ll2, NULL);
+    });
+
+    CMC_CREATE_TEST(splice[shared], {
+        struct linkedlist_pool *pool = ll_pool_new();
+
+        cmc_assert_not_equals(ptr, NULL, pool);
+
+        struct linkedlist *ll1 = ll_new_pooled(pool);
+        struct linkedlist *ll2 = ll_new_pooled(pool);
+
+        cmc_assert_not_equals(ptr, NULL, ll1);
+        cmc_assert_not_equals(ptr, NULL, ll2);
+
+        for (size_t i = 0; i < 10; i++)
+            cmc_assert(ll_push_back(ll1, i));
+
+        struct linkedlist_node *first = ll_get_node(ll1, 3);
+        struct linkedlist_node *last = ll_get_node(ll1, 6);
+
+        cmc_assert(ll_splice(ll2, NULL, ll1, first, last));
+
+        /* The same nodes are moved */
+        cmc_assert_equals(ptr, first, ll2->head);
+        cmc_assert_equals(ptr, last, ll2->tail);
+        cmc_assert_equals(size_t, 4, ll_count(ll2));
+        cmc_assert_equals(size_t, 6, ll_count(ll1));
+        cmc_assert_equals(size_t, 7, ll_get(ll1, 3));
+        cmc_assert_equals(ptr, NULL, pool->free_nodes);
+
+        ll_free(ll1, NULL);
+        ll_free(ll2, NULL);
+        ll_pool_free(pool);
+    });
+
+    CMC_CREATE_TEST(sort, {
+        struct linkedlist *ll = ll_new();
+
+        cmc_assert_not_equals(ptr, NULL, ll);
+
+        ll_sort(ll, cmp);
+
+        cmc_assert(ll_empty(ll));
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(ll_push_back(ll, ((i * 7919) % 37) * 1000 + i));
+
+        ll_sort(ll, ll_thousands);
+
+        cmc_assert_equals(size_t, 1000, ll_count(ll));
+        cmc_assert_equals(ptr, NULL, ll->head->prev);
+        cmc_assert_equals(ptr, NULL, ll->tail->next);
+
+        size_t total = 0;
+
+        for (struct linkedlist_node *node = ll->head; node->next; node = node->next)
+        {
+            size_t a = node->data;
+            size_t b = node->next->data;
+
+            /* Equal keys keep the order they were pushed in */
+            cmc_assert(a / 1000 < b / 1000 || (a / 1000 == b / 1000 && a % 1000 < b % 1000));
+            cmc_assert_equals(ptr, node, node->next->prev);
+            total++;
+        }
+
+        cmc_assert_equals(size_t, 999, total);
+        cmc_assert_equals(ptr, ll_get_node(ll, 999), ll->tail);
+
+        ll_free(ll, NULL);
+    });
+
+    CMC_CREATE_TEST(new_from, {
+        size_t elements[100];
+
+        for (size_t i = 0; i < 100; i++)
+            elements[i] = i;
+
+        struct linkedlist *l = ll_new_from(elements, 100);
+
+        cmc_assert_not_equals(ptr, NULL, l);
+        cmc_assert_equals(size_t, 100, ll_count(l));
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert_equals(size_t, i, ll_get(l, i));
+
+        ll_free(l, NULL);
+
+        cmc_assert_equals(ptr, NULL, ll_new_from(elements, 0));
+    });
+
+    CMC_CREATE_TEST(to_array, {
+        struct linkedlist *l = ll_new();
+
+        for (size_t i = 0; i < 50; i++)
+            ll_push_back(l, i);
+
+        size_t elements[50] = { 0 };
+
+        cmc_assert_equals(size_t, 50, ll_to_array(l, elements, 100));
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert_equals(size_t, i, elements[i]);
+
+        cmc_assert_equals(size_t, 0, ll_to_array(l, elements, 0));
+
+        ll_free(l, NULL);
+    });
+
+    CMC_CREATE_TEST(remove_if, {
+        struct linkedlist *l = ll_new();
+
+        for (size_t i = 0; i < 100; i++)
+            ll_push_back(l, i);
+
+        ll_deallocated = 0;
+
+        cmc_assert_equals(size_t, 50, ll_remove_if(l, ll_is_odd, ll_deallocator));
+        cmc_assert_equals(size_t, 2500, ll_deallocated);
+        cmc_assert_equals(size_t, 50, ll_count(l));
+        cmc_assert_equals(size_t, 0, ll_remove_if(l, ll_is_odd, NULL));
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert_equals(size_t, i * 2, ll_get(l, i));
+
+        cmc_assert_equals(size_t, 98, ll_back(l));
+
+        ll_push_back(l, 1);
+        ll_push_front(l, 3);
+
+        /* Both ends are removed */
+        cmc_assert_equals(size_t, 2, ll_remove_if(l, ll_is_odd, NULL));
+        cmc_assert_equals(size_t, 0, ll_front(l));
+        cmc_assert_equals(size_t, 98, ll_back(l));
+
+        ll_free(l, NULL);
+    });
 });
@@ -4,8 +4,62 @@
 #include <utl/test.h>
 
 #include <cmc/list.h>
+#include <utl/cmc_callback.h>
 
 CMC_GENERATE_LIST(l, list, size_t)
+CMC_GENERATE_LIST_BITWISE(lb, list_bitwise, size_t)
+CMC_GENERATE_LIST_BITWISE(lb8, list_bitwise8, uint8_t)
+
+/* Elements of a size that is not compared a vector at a time */
+struct list_rgb
+{
+    uint8_t r, g, b;
+};
+
+CMC_GENERATE_LIST_BITWISE(lb3, list_bitwise3, struct list_rgb)
+
+#define list_is_even(x) ((x) % 2 == 0)
+#define list_sum(a, x) ((a) + (x))
+
+static size_t list_square(size_t x)
+{
+    return x * x;
+}
+
+CMC_GENERATE_LIST_FILTER(l, list, size_t, even, list_is_even)
+CMC_GENERATE_LIST_MAP(l, list, size_t, square, list_square)
+CMC_GENERATE_LIST_FOLD(l, list, size_t, sum, size_t, list_sum)
+
+static bool list_is_multiple_of_3(size_t x)
+{
+    return x % 3 == 0;
+}
+
+/* Fills the list with one of the inputs that are slow for a plain quicksort */
+static void list_sort_pattern(struct list *l, size_t pattern, size_t n)
+{
+    l_clear(l, NULL);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        size_t value;
+
+        if (pattern == 0)
+            value = i;
+        else if (pattern == 1)
+            value = n - i;
+        else if (pattern == 2)
+            value = 7;
+        else if (pattern == 3)
+            value = i < n / 2 ? i : n - i;
+        else if (pattern == 4)
+            value = i % 16;
+        else
+            value = (i * 7919) % 10007;
+
+        l_push_back(l, value);
+    }
+}
 
 CMC_CREATE_UNIT(list_test, true, {
     CMC_CREATE_TEST(new, {
@@ -19,6 +73,23 @@ CMC_CREATE_UNIT(list_test, true, {
         l_free(l, NULL);
     });
 
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct list *l = l_new_custom(100, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, l);
+
+        for (size_t i = 0; i < 1000; i++)
+            l_push_back(l, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        l_free(l, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
     CMC_CREATE_TEST(new[capacity = 0], {
         struct list *l = l_new(0);
 
@@ -337,4 +408,641 @@ CMC_CREATE_UNIT(list_test, true, {
 
         l_free(l, NULL);
     });
+
+    CMC_CREATE_TEST(pop_back[low water shrink], {
+        struct list *l = l_new(1000);
+
+        cmc_assert_not_equals(ptr, NULL, l);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(l_push_back(l, i));
+
+        for (size_t i = 0; i < 900; i++)
+            cmc_assert(l_pop_back(l));
+
+        cmc_assert_equals(size_t, 250, l_capacity(l));
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert_equals(size_t, i, l_get(l, i));
+
+        l_free(l, NULL);
+    });
+
+    CMC_CREATE_TEST(shrink_to_fit, {
+        struct list *l = l_new(100);
+
+        cmc_assert_not_equals(ptr, NULL, l);
+
+        for (size_t i = 0; i < 10; i++)
+            cmc_assert(l_push_back(l, i));
+
+        cmc_assert(l_shrink_to_fit(l));
+        cmc_assert_equals(size_t, 10, l_capacity(l));
+
+        for (size_t i = 0; i < 10; i++)
+            cmc_assert_equals(size_t, i, l_get(l, i));
+
+        l_free(l, NULL);
+    });
+
+    CMC_CREATE_TEST(reserve, {
+        struct list *l = l_new(10);
+
+        cmc_assert_not_equals(ptr, NULL, l);
+
+        for (size_t i = 0; i < 10; i++)
+            cmc_assert(l_push_back(l, i));
+
+        cmc_assert(l_reserve(l, 1000));
+        cmc_assert_equals(size_t, 1000, l_capacity(l));
+
+        /* It never shrinks the buffer */
+        cmc_assert(l_reserve(l, 20));
+        cmc_assert_equals(size_t, 1000, l_capacity(l));
+
+        for (size_t i = 10; i < 1000; i++)
+            cmc_assert(l_push_back(l, i));
+
+        cmc_assert_equals(size_t, 1000, l_capacity(l));
+
+        /* A full list grows by the default policy */
+        cmc_assert(l_push_back(l, 1000));
+        cmc_assert_equals(size_t, 2000, l_capacity(l));
+
+        for (size_t i = 0; i <= 1000; i++)
+            cmc_assert_equals(size_t, i, l_get(l, i));
+
+        l_free(l, NULL);
+    });
+
+    CMC_CREATE_TEST(save restore, {
+        struct list *l = l_new(100);
+
+        cmc_assert_not_equals(ptr, NULL, l);
+
+        for (size_t i = 0; i < 150; i++)
+            cmc_assert(l_push_back(l, i));
+
+        FILE *file = tmpfile();
+
+        cmc_assert_not_equals(ptr, NULL, file);
+
+        cmc_assert(l_save(l, file, NULL));
+        cmc_assert(l_save(l, file, write_size));
+
+        rewind(file);
+
+        for (size_t k = 0; k < 2; k++)
+        {
+            struct list *r = l_restore(file, read_size);
+
+            cmc_assert_not_equals(ptr, NULL, r);
+            cmc_assert_equals(size_t, 150, l_count(r));
+            cmc_assert_equals(size_t, l_capacity(l), l_capacity(r));
+
+            for (size_t i = 0; i < 150; i++)
+                cmc_assert_equals(size_t, i, l_get(r, i));
+
+            l_free(r, NULL);
+        }
+
+        // Nothing left to be read
+        cmc_assert_equals(ptr, NULL, l_restore(file, read_size));
+
+        fclose(file);
+        l_free(l, NULL);
+    });
+
+    CMC_CREATE_TEST(sort, {
+        struct list *l = l_new(100);
+
+        cmc_assert_not_equals(ptr, NULL, l);
+
+        /* Sorted, reversed, equal, organ pipe, few distinct and shuffled */
+        for (size_t pattern = 0; pattern < 6; pattern++)
+        {
+            for (size_t n = 0; n < 3000; n = n * 3 + 1)
+            {
+                list_sort_pattern(l, pattern, n);
+
+                size_t sum = 0;
+
+                for (size_t i = 0; i < n; i++)
+                    sum += l_get(l, i);
+
+                l_sort(l, cmp);
+
+                cmc_assert_equals(size_t, n, l_count(l));
+
+                for (size_t i = 1; i < n; i++)
+                    cmc_assert(l_get(l, i - 1) <= l_get(l, i));
+
+                for (size_t i = 0; i < n; i++)
+                    sum -= l_get(l, i);
+
+                cmc_assert_equals(size_t, 0, sum);
+            }
+        }
+
+        l_free(l, NULL);
+    });
+
+    CMC_CREATE_TEST(sort_parallel, {
+        struct list *l = l_new(100);
+
+        cmc_assert_not_equals(ptr, NULL, l);
+
+        /* An odd amount of threads leaves a run without a pair */
+        for (size_t pattern = 0; pattern < 6; pattern++)
+        {
+            for (size_t threads = 1; threads <= 12; threads = threads * 2 + (threads == 1))
+            {
+                size_t n = 200000 + threads;
+
+                list_sort_pattern(l, pattern, n);
+
+                size_t sum = 0;
+
+                for (size_t i = 0; i < n; i++)
+                    sum += l_get(l, i);
+
+                l_sort_parallel(l, cmp, threads);
+
+                cmc_assert_equals(size_t, n, l_count(l));
+
+                for (size_t i = 1; i < n; i++)
+                    cmc_assert(l_get(l, i - 1) <= l_get(l, i));
+
+                for (size_t i = 0; i < n; i++)
+                    sum -= l_get(l, i);
+
+                cmc_assert_equals(size_t, 0, sum);
+            }
+        }
+
+        l_free(l, NULL);
+    });
+
+    CMC_CREATE_TEST(bitwise, {
+        struct list *l = l_new(100);
+        struct list_bitwise *lb = lb_new(100);
+
+        cmc_assert_not_equals(ptr, NULL, l);
+        cmc_assert_not_equals(ptr, NULL, lb);
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            cmc_assert(l_push_back(l, (i * 7919) % 500));
+            cmc_assert(lb_push_back(lb, (i * 7919) % 500));
+        }
+
+        /* Every count tests a different amount of elements past a vector */
+        for (size_t count = 1000; count > 990; count--)
+        {
+            l->count = count;
+            lb->count = count;
+
+            for (size_t i = 0; i < 600; i++)
+            {
+                cmc_assert_equals(bool, l_contains(l, i, cmp), lb_contains(lb, i, NULL));
+                cmc_assert_equals(size_t, l_indexof(l, i, cmp, true),
+                                  lb_indexof(lb, i, NULL, true));
+                cmc_assert_equals(size_t, l_indexof(l, i, cmp, false),
+                                  lb_indexof(lb, i, NULL, false));
+            }
+        }
+
+        lb_clear(lb, NULL);
+
+        cmc_assert(!lb_contains(lb, 0, NULL));
+        cmc_assert_equals(size_t, 0, lb_indexof(lb, 0, NULL, false));
+
+        l_free(l, NULL);
+        lb_free(lb, NULL);
+    });
+
+    CMC_CREATE_TEST(bitwise[small and odd sizes], {
+        struct list_bitwise8 *lb8 = lb8_new(10);
+        struct list_bitwise3 *lb3 = lb3_new(10);
+
+        cmc_assert_not_equals(ptr, NULL, lb8);
+        cmc_assert_not_equals(ptr, NULL, lb3);
+
+        for (size_t i = 0; i < 200; i++)
+        {
+            struct list_rgb color = { 0 };
+
+            color.g = (uint8_t)i;
+
+            cmc_assert(lb8_push_back(lb8, (uint8_t)(i % 100)));
+            cmc_assert(lb3_push_back(lb3, color));
+        }
+
+        for (size_t i = 0; i < 100; i++)
+        {
+            cmc_assert_equals(size_t, i, lb8_indexof(lb8, (uint8_t)i, NULL, true));
+            cmc_assert_equals(size_t, i + 100, lb8_indexof(lb8, (uint8_t)i, NULL, false));
+        }
+
+        cmc_assert(!lb8_contains(lb8, 100, NULL));
+
+        struct list_rgb color = { 0 };
+
+        color.g = 150;
+
+        cmc_assert_equals(size_t, 150, lb3_indexof(lb3, color, NULL, true));
+
+        color.r = 1;
+
+        cmc_assert(!lb3_contains(lb3, color, NULL));
+
+        lb8_free(lb8, NULL);
+        lb3_free(lb3, NULL);
+    });
+
+    CMC_CREATE_TEST(to_array, {
+        struct list *l = l_new(100);
+
+        for (size_t i = 0; i < 50; i++)
+            l_push_back(l, i);
+
+        size_t elements[60] = { 0 };
+
+        cmc_assert_equals(size_t, 50, l_to_array(l, elements, 60));
+        cmc_assert_equals(size_t, 10, l_to_array(l, elements + 50, 10));
+
+        for (size_t i = 0; i < 60; i++)
+            cmc_assert_equals(size_t, i < 50 ? i : i - 50, elements[i]);
+
+        l_free(l, NULL);
+    });
+
+    CMC_CREATE_TEST(parallel_reduce, {
+        struct list *l = l_new(100000);
+
+        for (size_t i = 1; i <= 100000; i++)
+            l_push_back(l, i);
+
+        cmc_assert_equals(size_t, 5000050000, l_parallel_reduce(l, 0, add, add, 4));
+        cmc_assert_equals(size_t, 5000050000, l_parallel_reduce(l, 0, add, add, 1));
+        cmc_assert_equals(size_t, 5000050000, l_parallel_reduce(l, 0, add, add, 1000));
+
+        l_clear(l, NULL);
+
+        cmc_assert_equals(size_t, 7, l_parallel_reduce(l, 7, add, add, 4));
+
+        l_free(l, NULL);
+    });
+
+    CMC_CREATE_TEST(parallel_reduce, {
+        struct list *l = l_new(100000);
+
+        for (size_t i = 1; i <= 100000; i++)
+            l_push_back(l, i);
+
+        cmc_assert_equals(size_t, 5000050000, l_parallel_reduce(l, 0, add, add, 4));
+        cmc_assert_equals(size_t, 5000050000, l_parallel_reduce(l, 0, add, add, 1));
+        cmc_assert_equals(size_t, 5000050000, l_parallel_reduce(l, 0, add, add, 1000));
+
+        l_clear(l, NULL);
+
+        cmc_assert_equals(size_t, 7, l_parallel_reduce(l, 7, add, add, 4));
+
+        l_free(l, NULL);
+    });
+
+    CMC_CREATE_TEST(callbacks, {
+        struct list *l = l_new(100);
+        struct list *r = l_new(1);
+
+        for (size_t i = 0; i < 100; i++)
+            l_push_back(l, i);
+
+        cmc_assert(l_filter_into_even(l, r));
+        cmc_assert_equals(size_t, 50, l_count(r));
+        cmc_assert_equals(size_t, 100, l_count(l));
+        cmc_assert_equals(size_t, 2450, l_fold_sum(r, 0));
+
+        cmc_assert(l_map_into_square(r, r));
+        cmc_assert_equals(size_t, 36, l_get(r, 3));
+
+        cmc_assert(l_map_into_square(l, r));
+        cmc_assert_equals(size_t, 150, l_count(r));
+        cmc_assert_equals(size_t, 9801, l_back(r));
+
+        cmc_assert(l_filter_into_even(l, l));
+        cmc_assert_equals(size_t, 50, l_count(l));
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert_equals(size_t, i * 2, l_get(l, i));
+
+        cmc_assert_equals(size_t, 7, l_fold_sum(l, 7) - 2450);
+
+        l_free(l, NULL);
+        l_free(r, NULL);
+    });
+
+    CMC_CREATE_TEST(serialize[chunks], {
+        struct list *l = l_new(100);
+
+        for (size_t i = 0; i < 10000; i++)
+            l_push_back(l, i);
+
+        struct list_serializer ser;
+        struct list_deserializer des;
+
+        cmc_assert(l_serialize_begin(&ser, l, 1000, true));
+        cmc_assert(l_deserialize_begin(&des, 1000));
+
+        /* Chunks that split the header, the lengths and the elements */
+        unsigned char chunk[7];
+        size_t n;
+        size_t total = 0;
+
+        while ((n = l_serialize_next(&ser, chunk, sizeof(chunk))) > 0)
+        {
+            cmc_assert(l_deserialize_next(&des, chunk, n));
+            total += n;
+        }
+
+        l_serialize_end(&ser);
+
+        struct list *result = l_deserialize_end(&des);
+
+        cmc_assert_not_equals(ptr, NULL, result);
+        cmc_assert_greater(size_t, 10000 * sizeof(size_t), total);
+        cmc_assert_equals(size_t, l_count(l), l_count(result));
+        cmc_assert(memcmp(l->buffer, result->buffer, l_count(l) * sizeof(size_t)) == 0);
+
+        l_free(l, NULL);
+        l_free(result, NULL);
+    });
+
+    CMC_CREATE_TEST(serialize[checksum], {
+        struct list *l = l_new(100);
+
+        for (size_t i = 0; i < 100; i++)
+            l_push_back(l, i);
+
+        struct list_serializer ser;
+        struct list_deserializer des;
+        unsigned char stream[4096];
+
+        cmc_assert(l_serialize_begin(&ser, l, 0, true));
+        size_t size = l_serialize_next(&ser, stream, sizeof(stream));
+        cmc_assert_equals(size_t, 0, l_serialize_next(&ser, stream + size, sizeof(stream) - size));
+        l_serialize_end(&ser);
+
+        cmc_assert(l_deserialize_begin(&des, 0));
+        cmc_assert(l_deserialize_next(&des, stream, size));
+        struct list *result = l_deserialize_end(&des);
+        cmc_assert_not_equals(ptr, NULL, result);
+        cmc_assert_equals(size_t, l_count(l), l_count(result));
+        cmc_assert(memcmp(l->buffer, result->buffer, l_count(l) * sizeof(size_t)) == 0);
+        l_free(result, NULL);
+
+        /* A flipped bit in an element */
+        stream[size - 20] ^= 1;
+
+        cmc_assert(l_deserialize_begin(&des, 0));
+        cmc_assert(!l_deserialize_next(&des, stream, size));
+        cmc_assert_equals(ptr, NULL, l_deserialize_end(&des));
+
+        /* A stream that stops before its end */
+        stream[size - 20] ^= 1;
+
+        cmc_assert(l_deserialize_begin(&des, 0));
+        cmc_assert(l_deserialize_next(&des, stream, size - 1));
+        cmc_assert_equals(ptr, NULL, l_deserialize_end(&des));
+
+        /* Blocks larger than the limit are rejected */
+        cmc_assert(l_deserialize_begin(&des, 16));
+        cmc_assert(!l_deserialize_next(&des, stream, size));
+        cmc_assert_equals(ptr, NULL, l_deserialize_end(&des));
+
+        l_free(l, NULL);
+    });
+    CMC_CREATE_TEST(copy_of[copy on write], {
+        count_alloc_reset();
+
+        struct list *l = l_new_custom(100, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, l);
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert(l_push_back(l, i));
+
+        l_set_copy_on_write(l, true);
+
+        struct list *c1 = l_copy_of(l, NULL);
+        struct list *c2 = l_copy_of(c1, NULL);
+
+        // Both copies share the buffer and its count
+        cmc_assert_not_equals(ptr, NULL, c2);
+        cmc_assert(l_shared(l));
+        cmc_assert_equals(ptr, l->buffer, c2->buffer);
+        cmc_assert_equals(size_t, 5, count_alloc_live);
+
+        cmc_assert(l_push_back(c1, 50));
+        cmc_assert(!l_shared(c1));
+        cmc_assert(l_shared(l));
+        cmc_assert_equals(size_t, 51, l_count(c1));
+        cmc_assert_equals(size_t, 50, l_count(l));
+
+        *l_get_ref(c2, 0) = 100;
+
+        // The original is the last one using the first buffer
+        cmc_assert(!l_shared(l));
+        cmc_assert_equals(size_t, 0, l_get(l, 0));
+        cmc_assert_equals(size_t, 100, l_get(c2, 0));
+
+        struct list *c3 = l_copy_of(l, NULL);
+
+        l_clear(c3, NULL);
+
+        cmc_assert(l_empty(c3));
+        cmc_assert_equals(size_t, 50, l_count(l));
+
+        l_free(l, NULL);
+        l_free(c1, NULL);
+        l_free(c2, NULL);
+        l_free(c3, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(copy_of[shared free], {
+        count_alloc_reset();
+
+        struct list *l = l_new_custom(100, &count_alloc);
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert(l_push_back(l, i));
+
+        l_set_copy_on_write(l, true);
+
+        struct list *c = l_copy_of(l, NULL);
+
+        // The copy keeps the buffer after the original is freed
+        l_free(l, NULL);
+
+        cmc_assert_equals(size_t, 3, count_alloc_live);
+        cmc_assert(!l_shared(c));
+        cmc_assert_equals(size_t, 49, l_back(c));
+
+        cmc_assert(l_pop_back(c));
+
+        cmc_assert_equals(size_t, 2, count_alloc_live);
+
+        l_free(c, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(callbacks[copy on write], {
+        struct list *l = l_new(100);
+
+        cmc_assert_not_equals(ptr, NULL, l);
+
+        for (size_t i = 1; i <= 5; i++)
+            cmc_assert(l_push_back(l, i));
+
+        l_set_copy_on_write(l, true);
+
+        struct list *c1 = l_copy_of(l, NULL);
+        struct list *c2 = l_copy_of(l, NULL);
+        struct list *c3 = l_copy_of(l, NULL);
+
+        // Writing in place leaves the copies as they were
+        cmc_assert(l_map_into_square(l, l));
+        cmc_assert(l_filter_into_even(c1, c1));
+
+        // And so does adding to a shared list with room left
+        cmc_assert(l_map_into_square(c2, c3));
+
+        for (size_t i = 0; i < 5; i++)
+        {
+            cmc_assert_equals(size_t, (i + 1) * (i + 1), l_get(l, i));
+            cmc_assert_equals(size_t, i + 1, l_get(c2, i));
+        }
+
+        cmc_assert_equals(size_t, 2, l_count(c1));
+        cmc_assert_equals(size_t, 4, l_back(c1));
+        cmc_assert_equals(size_t, 10, l_count(c3));
+        cmc_assert_equals(size_t, 25, l_back(c3));
+        cmc_assert(!l_shared(c2));
+
+        l_free(l, NULL);
+        l_free(c1, NULL);
+        l_free(c2, NULL);
+        l_free(c3, NULL);
+    });
+
+    CMC_CREATE_TEST(equals, {
+        struct list *l1 = l_new(100);
+        struct list *l2 = l_new(100);
+
+        for (size_t i = 0; i < 50; i++)
+        {
+            l_push_back(l1, i);
+            l_push_back(l2, i);
+        }
+
+        cmc_assert(l_equals(l1, l2, cmp));
+
+        l_set_copy_on_write(l1, true);
+
+        struct list *c = l_copy_of(l1, NULL);
+
+        cmc_assert(l_shared(c));
+        cmc_assert(l_equals(l1, c, cmp));
+
+        l_pop_back(c);
+        l_push_back(c, 100);
+
+        cmc_assert(!l_equals(l1, c, cmp));
+        cmc_assert(!l_equals(l2, c, cmp));
+
+        l_free(l1, NULL);
+        l_free(l2, NULL);
+        l_free(c, NULL);
+    });
+
+    CMC_CREATE_TEST(remove_if, {
+        struct list *l = l_new(100);
+
+        for (size_t i = 0; i < 1000; i++)
+            l_push_back(l, i);
+
+        cmc_assert_equals(size_t, 334, l_remove_if(l, list_is_multiple_of_3, NULL));
+        cmc_assert_equals(size_t, 666, l_count(l));
+
+        for (size_t i = 0; i < l_count(l); i++)
+            cmc_assert_equals(size_t, i + i / 2 + 1, l_get(l, i));
+
+        cmc_assert_equals(size_t, 0, l_remove_if(l, list_is_multiple_of_3, NULL));
+        cmc_assert_equals(size_t, 666, l_count(l));
+
+        l_free(l, NULL);
+    });
+
+    CMC_CREATE_TEST(view, {
+        struct list *l = l_new(100);
+        struct list_bitwise *lb = lb_new(100);
+
+        for (size_t i = 0; i < 100; i++)
+        {
+            l_push_back(l, i);
+            lb_push_back(lb, i);
+        }
+
+        count_alloc_reset();
+
+        struct list_view view = l_view(l, 10, 29);
+        struct list_bitwise_view bview = lb_view(lb, 10, 29);
+
+        cmc_assert_equals(size_t, 20, view.count);
+        cmc_assert_equals(ptr, l->buffer + 10, view.data);
+        cmc_assert_equals(size_t, 15, l_view_get(view, 5));
+        cmc_assert_equals(size_t, 0, l_view_get(view, 20));
+
+        cmc_assert(l_view_contains(view, 29, cmp));
+        cmc_assert(!l_view_contains(view, 30, cmp));
+        cmc_assert(!l_view_contains(view, 9, cmp));
+        cmc_assert_equals(size_t, 5, l_view_indexof(view, 15, cmp, true));
+        cmc_assert_equals(size_t, 20, l_view_indexof(view, 5, cmp, false));
+
+        cmc_assert(lb_view_contains(bview, 10, NULL));
+        cmc_assert(!lb_view_contains(bview, 30, NULL));
+        cmc_assert_equals(size_t, 19, lb_view_indexof(bview, 29, NULL, false));
+
+        struct list_view slice = l_view_slice(view, 5, 9);
+
+        cmc_assert_equals(size_t, 5, slice.count);
+        cmc_assert_equals(size_t, 15, l_view_get(slice, 0));
+        cmc_assert_equals(size_t, 0, l_view_slice(view, 5, 20).count);
+
+        cmc_assert_equals(size_t, 0, l_view(l, 50, 100).count);
+        cmc_assert_equals(size_t, 0, l_view(l, 20, 10).count);
+
+        struct list_view_iter iter;
+        size_t sum = 0;
+
+        for (l_view_iter_init(&iter, view); !l_view_iter_end(&iter); l_view_iter_next(&iter))
+        {
+            cmc_assert_equals(size_t, iter.cursor + 10, l_view_iter_value(&iter));
+            sum += l_view_iter_value(&iter);
+        }
+
+        cmc_assert_equals(size_t, 390, sum);
+
+        for (; !l_view_iter_start(&iter); l_view_iter_prev(&iter))
+            sum -= l_view_iter_value(&iter);
+
+        cmc_assert_equals(size_t, 0, sum);
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+
+        l_free(l, NULL);
+        lb_free(lb, NULL);
+    });
 })
@@ -0,0 +1,143 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <utl/log_async.h>
+
+/* Reads everything written to a file */
+static size_t lg_read(FILE *file, char *buffer, size_t size)
+{
+    rewind(file);
+
+    size_t length = fread(buffer, 1, size - 1, file);
+
+    buffer[length] = '\0';
+
+    return length;
+}
+
+CMC_CREATE_UNIT(log_test, true, {
+    CMC_CREATE_TEST(level, {
+        cmc_assert(cmc_log_level(0, CMC_LOG_TRACE));
+        cmc_assert(cmc_log_level(CMC_LOG_WARN, CMC_LOG_ERROR));
+        cmc_assert(!cmc_log_level(CMC_LOG_WARN, CMC_LOG_INFO));
+        cmc_assert(cmc_log_level(-CMC_LOG_WARN, CMC_LOG_INFO));
+        cmc_assert(!cmc_log_level(-CMC_LOG_WARN, CMC_LOG_ERROR));
+    });
+
+    CMC_CREATE_TEST(allow, {
+        time_t second = 0;
+        unsigned count = 0;
+
+        cmc_assert(cmc_log_allow(&second, &count, 3));
+        cmc_assert(cmc_log_allow(&second, &count, 3));
+        cmc_assert(cmc_log_allow(&second, &count, 3));
+
+        /* Unless the second changed right now */
+        if (second == time(NULL))
+            cmc_assert(!cmc_log_allow(&second, &count, 3));
+    });
+
+    CMC_CREATE_TEST(async, {
+        FILE *file = tmpfile();
+        bool tenabled = cmc_log_config.tenabled;
+        FILE *config_file = cmc_log_config.file;
+
+        cmc_assert_not_equals(ptr, NULL, file);
+
+        cmc_log_config.tenabled = false;
+        cmc_log_config.file = file;
+
+        cmc_assert(cmc_log_async_start());
+        cmc_assert(cmc_log_config.sink == cmc_log_async_sink);
+
+        char name[] = "name";
+        cmc_log_warn("int %d size %5zu double %.2f char %c %%", -3, (size_t)42, 1.5, 'x');
+        cmc_log_error("string %s pointer %p long %lx short %hd", name, (void *)0, 255ul, 7);
+
+        /* The string is copied before being changed */
+        name[0] = 'g';
+
+        cmc_log_info("star %*d %.*s", 4, 9, 2, "abc");
+
+        cmc_log_async_flush();
+
+        char buffer[1024];
+        lg_read(file, buffer, sizeof(buffer));
+
+        cmc_assert(strstr(buffer, "int -3 size    42 double 1.50 char x %") != NULL);
+        cmc_assert(strstr(buffer, "string name pointer ") != NULL);
+        cmc_assert(strstr(buffer, " long ff short 7") != NULL);
+        cmc_assert(strstr(buffer, "star    9 ab") != NULL);
+        cmc_assert(strstr(buffer, "  WARN ") != NULL);
+        cmc_assert(strstr(buffer, " ERROR ") != NULL);
+
+        cmc_log_async_stop();
+
+        cmc_assert(cmc_log_config.sink == NULL);
+        cmc_assert_equals(size_t, 0, cmc_log_async_dropped());
+
+        cmc_log_config.tenabled = tenabled;
+        cmc_log_config.file = config_file;
+
+        fclose(file);
+    });
+
+    CMC_CREATE_TEST(async_levels, {
+        FILE *file = tmpfile();
+        bool tenabled = cmc_log_config.tenabled;
+        FILE *config_file = cmc_log_config.file;
+        int flevel = cmc_log_config.flevel;
+
+        cmc_log_config.tenabled = false;
+        cmc_log_config.file = file;
+        cmc_log_config.flevel = CMC_LOG_WARN;
+
+        cmc_assert(cmc_log_async_start());
+
+        cmc_log_info("%s", "below the level");
+        cmc_log_fatal("%s", "above the level");
+
+        /* Stopping writes what is left */
+        cmc_log_async_stop();
+
+        char buffer[1024];
+        lg_read(file, buffer, sizeof(buffer));
+
+        cmc_assert(strstr(buffer, "below the level") == NULL);
+        cmc_assert(strstr(buffer, "above the level") != NULL);
+
+        cmc_log_config.tenabled = tenabled;
+        cmc_log_config.file = config_file;
+        cmc_log_config.flevel = flevel;
+
+        fclose(file);
+    });
+
+    CMC_CREATE_TEST(async_truncated, {
+        FILE *file = tmpfile();
+        bool tenabled = cmc_log_config.tenabled;
+        FILE *config_file = cmc_log_config.file;
+
+        cmc_log_config.tenabled = false;
+        cmc_log_config.file = file;
+
+        cmc_assert(cmc_log_async_start());
+
+        /* Only CMC_LOG_ASYNC_ARGS arguments are kept */
+        cmc_log_debug("%d %d %d %d %d %d %d %d %d %d", 1, 2, 3, 4, 5, 6, 7, 8, 9, 10);
+
+        cmc_log_async_stop();
+
+        char buffer[1024];
+        lg_read(file, buffer, sizeof(buffer));
+
+        cmc_assert(strstr(buffer, "1 2 3 4 5 6 7 8 %d %d") != NULL);
+
+        cmc_log_config.tenabled = tenabled;
+        cmc_log_config.file = config_file;
+
+        fclose(file);
+    });
+});
@@ -0,0 +1,223 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/lrucache.h>
+
+CMC_GENERATE_LRUCACHE(lru, lrucache, size_t, size_t)
+
+static size_t lru_evicted = 0;
+static size_t lru_last_evicted = 0;
+
+static void lru_evictor(size_t key, size_t value)
+{
+    (void)value;
+
+    lru_evicted++;
+    lru_last_evicted = key;
+}
+
+/* Walks the recency list checking that it links every entry of the */
+/* table and that every entry can still be found */
+static bool lru_valid(struct lrucache *cache)
+{
+    size_t n = 0;
+    size_t prev = CMC_LRUCACHE_NONE;
+
+    for (size_t i = cache->head; i != CMC_LRUCACHE_NONE; i = cache->buffer[i].next)
+    {
+        if (!cache->buffer[i].filled || cache->buffer[i].prev != prev)
+            return false;
+
+        if (lru_peek(cache, cache->buffer[i].key) != &(cache->buffer[i].value))
+            return false;
+
+        prev = i;
+        n++;
+    }
+
+    return prev == cache->tail && n == cache->count;
+}
+
+CMC_CREATE_UNIT(lrucache_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct lrucache *cache = lru_new(100, cmp, hash, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, cache);
+        cmc_assert_equals(size_t, 100, lru_limit(cache));
+        cmc_assert_greater_equals(size_t, 100 / CMC_LRUCACHE_LOAD, lru_capacity(cache));
+        cmc_assert(lru_empty(cache));
+        cmc_assert(!lru_oldest(cache, NULL, NULL));
+
+        lru_free(cache, NULL);
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct lrucache *cache = lru_new_custom(100, cmp, hash, NULL, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, cache);
+
+        for (size_t i = 0; i < 1000; i++)
+            lru_put(cache, i, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        lru_free(cache, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(new[limit = 0], {
+        struct lrucache *cache = lru_new(0, cmp, hash, NULL);
+
+        cmc_assert_equals(ptr, NULL, cache);
+    });
+
+    CMC_CREATE_TEST(put[evicts least recently used], {
+        struct lrucache *cache = lru_new(3, cmp, hash, lru_evictor);
+
+        cmc_assert_not_equals(ptr, NULL, cache);
+
+        lru_evicted = 0;
+
+        cmc_assert(lru_put(cache, 1, 10));
+        cmc_assert(lru_put(cache, 2, 20));
+        cmc_assert(lru_put(cache, 3, 30));
+        cmc_assert(lru_full(cache));
+
+        // 1 is used again so 2 becomes the oldest
+        cmc_assert_equals(size_t, 10, lru_get(cache, 1));
+
+        cmc_assert(lru_put(cache, 4, 40));
+        cmc_assert_equals(size_t, 1, lru_evicted);
+        cmc_assert_equals(size_t, 2, lru_last_evicted);
+        cmc_assert(!lru_contains(cache, 2));
+
+        // Updating a key promotes it without evicting anything
+        cmc_assert(!lru_put(cache, 3, 31));
+        cmc_assert_equals(size_t, 1, lru_evicted);
+
+        size_t key;
+        size_t value;
+
+        cmc_assert(lru_oldest(cache, &key, &value));
+        cmc_assert_equals(size_t, 1, key);
+        cmc_assert(lru_newest(cache, &key, &value));
+        cmc_assert_equals(size_t, 3, key);
+        cmc_assert_equals(size_t, 31, value);
+
+        // peek doesn't change the order
+        cmc_assert_equals(size_t, 10, *lru_peek(cache, 1));
+        cmc_assert(lru_put(cache, 5, 50));
+        cmc_assert_equals(size_t, 1, lru_last_evicted);
+
+        cmc_assert_equals(size_t, 3, lru_count(cache));
+        cmc_assert_equals(ptr, NULL, lru_get_ref(cache, 1));
+        cmc_assert(lru_valid(cache));
+
+        lru_free(cache, NULL);
+    });
+
+    CMC_CREATE_TEST(remove[collisions], {
+        // Every key has the same original position
+        struct lrucache *cache = lru_new(50, cmp, hash0, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, cache);
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert(lru_put(cache, i, i));
+
+        size_t value;
+
+        for (size_t i = 0; i < 50; i += 2)
+        {
+            cmc_assert(lru_remove(cache, i, &value));
+            cmc_assert_equals(size_t, i, value);
+        }
+
+        cmc_assert(!lru_remove(cache, 0, NULL));
+        cmc_assert_equals(size_t, 25, lru_count(cache));
+        cmc_assert(lru_valid(cache));
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert_equals(bool, i % 2 == 1, lru_contains(cache, i));
+
+        lru_free(cache, NULL);
+    });
+
+    CMC_CREATE_TEST(put[wrap around], {
+        // Clusters start at the last slot and continue at the first one
+        struct lrucache *cache = lru_new(20, cmp, hashcapminus1, lru_evictor);
+
+        cmc_assert_not_equals(ptr, NULL, cache);
+
+        lru_evicted = 0;
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            lru_put(cache, i, i);
+
+            if (i % 7 == 0)
+                lru_get(cache, i / 2);
+        }
+
+        cmc_assert_equals(size_t, 20, lru_count(cache));
+        cmc_assert_equals(size_t, 980, lru_evicted);
+        cmc_assert(lru_valid(cache));
+
+        lru_free(cache, NULL);
+    });
+
+    CMC_CREATE_TEST(put[many], {
+        struct lrucache *cache = lru_new(1000, cmp, hash, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, cache);
+
+        for (size_t i = 0; i < 100000; i++)
+        {
+            lru_put(cache, i % 3000, i);
+
+            if (i % 3 == 0)
+                lru_remove(cache, (i * 7) % 3000, NULL);
+        }
+
+        cmc_assert(lru_valid(cache));
+
+        // The most recent keys are still in the cache
+        cmc_assert(lru_contains(cache, 99999 % 3000));
+
+        struct cmc_hashtable_stats stats;
+
+        lru_stats(cache, &stats);
+
+        cmc_assert_equals(size_t, lru_count(cache), stats.count);
+        cmc_assert_equals(size_t, 0, stats.tombstones);
+
+        lru_free(cache, NULL);
+    });
+
+    CMC_CREATE_TEST(clear[deallocator], {
+        struct lrucache *cache = lru_new(10, cmp, hash, lru_evictor);
+
+        cmc_assert_not_equals(ptr, NULL, cache);
+
+        for (size_t i = 0; i < 10; i++)
+            cmc_assert(lru_put(cache, i, i));
+
+        lru_evicted = 0;
+
+        lru_clear(cache, lru_evictor);
+
+        cmc_assert_equals(size_t, 10, lru_evicted);
+        cmc_assert(lru_empty(cache));
+        cmc_assert(lru_valid(cache));
+
+        cmc_assert(lru_put(cache, 1, 1));
+        cmc_assert_equals(size_t, 1, lru_get(cache, 1));
+
+        lru_free(cache, NULL);
+    });
+});
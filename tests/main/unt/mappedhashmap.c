@@ -0,0 +1,213 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/mappedhashmap.h>
+
+CMC_GENERATE_MAPPED_HASHMAP(mhm, mappedhashmap, size_t, size_t)
+CMC_GENERATE_MAPPED_HASHMAP(mhms, mappedhashmap_small, uint8_t, uint8_t)
+
+static const char *mhm_path = "mappedhashmap.tmp";
+
+static int mhms_cmp(uint8_t a, uint8_t b)
+{
+    return (a > b) - (a < b);
+}
+
+static size_t mhms_hash(uint8_t a)
+{
+    return a;
+}
+
+CMC_CREATE_UNIT(mappedhashmap_test, true, {
+    CMC_CREATE_TEST(create, {
+        struct mappedhashmap *map = mhm_create(mhm_path, 100, 0.6, 42, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+        cmc_assert_equals(size_t, 0, mhm_count(map));
+        cmc_assert_equals(uint64_t, 42, mhm_seed(map));
+        cmc_assert_greater_equals(size_t, (size_t)(100 / 0.6), mhm_capacity(map));
+        cmc_assert(mhm_empty(map));
+
+        mhm_close(map);
+        remove(mhm_path);
+    });
+
+    CMC_CREATE_TEST(create_custom[count allocations], {
+        count_alloc_reset();
+
+        struct mappedhashmap *map =
+            mhm_create_custom(mhm_path, 100, 0.6, 42, cmp, hash, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(mhm_insert(map, i, i));
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        mhm_close(map);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+
+        map = mhm_open_custom(mhm_path, cmp, hash, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+        cmc_assert_equals(size_t, 1000, mhm_count(map));
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        mhm_close(map);
+        remove(mhm_path);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(create[capacity = 0], {
+        struct mappedhashmap *map = mhm_create(mhm_path, 0, 0.6, 0, cmp, hash);
+
+        cmc_assert_equals(ptr, NULL, map);
+    });
+
+    CMC_CREATE_TEST(insert update remove growth, {
+        struct mappedhashmap *map = mhm_create(mhm_path, 1, 0.6, 0, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(mhm_insert(map, i, i));
+
+        cmc_assert(!mhm_insert(map, 10, 0));
+        cmc_assert_equals(size_t, 1000, mhm_count(map));
+        cmc_assert_greater_equals(size_t, (size_t)(1000 / 0.6), mhm_capacity(map));
+
+        /* Only the file at the given path is left after growing */
+        cmc_assert_equals(ptr, NULL, fopen("mappedhashmap.tmp" CMC_MAPPED_HASHMAP_SUFFIX, "r"));
+
+        size_t old;
+
+        cmc_assert(mhm_update(map, 10, 20, &old));
+        cmc_assert_equals(size_t, 10, old);
+        cmc_assert_equals(size_t, 20, mhm_get(map, 10));
+
+        for (size_t i = 0; i < 500; i++)
+            cmc_assert(mhm_remove(map, i, NULL));
+
+        cmc_assert(!mhm_remove(map, 0, NULL));
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert_equals(bool, i >= 500, mhm_contains(map, i));
+
+        mhm_clear(map);
+
+        cmc_assert(mhm_empty(map));
+
+        mhm_close(map);
+        remove(mhm_path);
+    });
+
+    CMC_CREATE_TEST(open[warm start], {
+        struct mappedhashmap *map = mhm_create(mhm_path, 1, 0.6, 7, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(mhm_insert(map, i, i * 2));
+
+        cmc_assert(mhm_remove(map, 0, NULL));
+
+        size_t capacity = mhm_capacity(map);
+
+        cmc_assert(mhm_sync(map));
+        mhm_close(map);
+
+        map = mhm_open(mhm_path, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+        cmc_assert_equals(size_t, 999, mhm_count(map));
+        cmc_assert_equals(size_t, capacity, mhm_capacity(map));
+        cmc_assert_equals(uint64_t, 7, mhm_seed(map));
+        cmc_assert(!mhm_contains(map, 0));
+
+        for (size_t i = 1; i < 1000; i++)
+            cmc_assert_equals(size_t, i * 2, mhm_get(map, i));
+
+        /* Keeps growing after being opened */
+        for (size_t i = 1000; i < 3000; i++)
+            cmc_assert(mhm_insert(map, i, i * 2));
+
+        mhm_close(map);
+
+        map = mhm_open(mhm_path, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+        cmc_assert_equals(size_t, 2999, mhm_count(map));
+
+        for (size_t i = 1; i < 3000; i++)
+            cmc_assert_equals(size_t, i * 2, mhm_get(map, i));
+
+        mhm_close(map);
+        remove(mhm_path);
+    });
+
+    CMC_CREATE_TEST(open[invalid file], {
+        cmc_assert_equals(ptr, NULL, mhm_open(mhm_path, cmp, hash));
+
+        FILE *file = fopen(mhm_path, "w");
+
+        cmc_assert_not_equals(ptr, NULL, file);
+
+        for (size_t i = 0; i < 200; i++)
+            fputc('x', file);
+
+        fclose(file);
+
+        cmc_assert_equals(ptr, NULL, mhm_open(mhm_path, cmp, hash));
+
+        /* Written with other K and V */
+        struct mappedhashmap_small *small =
+            mhms_create(mhm_path, 10, 0.6, 0, mhms_cmp, mhms_hash);
+
+        cmc_assert_not_equals(ptr, NULL, small);
+        cmc_assert(mhms_insert(small, 1, 2));
+
+        mhms_close(small);
+
+        cmc_assert_equals(ptr, NULL, mhm_open(mhm_path, cmp, hash));
+
+        small = mhms_open(mhm_path, mhms_cmp, mhms_hash);
+
+        cmc_assert_not_equals(ptr, NULL, small);
+        cmc_assert_equals(uint8_t, 2, mhms_get(small, 1));
+
+        mhms_close(small);
+        remove(mhm_path);
+    });
+
+    CMC_CREATE_TEST(stats, {
+        struct mappedhashmap *map = mhm_create(mhm_path, 100, 0.6, 0, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert(mhm_insert(map, i, i));
+
+        struct cmc_hashtable_stats stats;
+
+        mhm_stats(map, &stats);
+
+        cmc_assert_equals(size_t, 50, stats.count);
+        cmc_assert_equals(size_t, mhm_capacity(map), stats.capacity);
+        // Only the bitmap of CMC_HASHTABLE_OCCUPANCY is outside of the mapping
+        size_t bitmap = 0;
+
+        if (CMC_IMPL_HASHTABLE_OCCUPIED(&(map->table)))
+            bitmap = sizeof(uint64_t) * cmc_occupancy_words(mhm_capacity(map));
+
+        cmc_assert_equals(size_t, map->length + sizeof(struct mappedhashmap) + bitmap,
+                          stats.bytes);
+
+        mhm_close(map);
+        remove(mhm_path);
+    });
+});
@@ -0,0 +1,173 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/mappedsortedmap.h>
+#include <cmc/sortedlist.h>
+#include <cmc/treemap.h>
+
+CMC_GENERATE_TREEMAP(msm_tm, msm_treemap, size_t, size_t)
+CMC_GENERATE_SORTEDLIST(msm_sl, msm_sortedlist, size_t)
+CMC_GENERATE_MAPPED_SORTEDMAP(msm, mappedsortedmap, size_t, size_t)
+CMC_GENERATE_MAPPED_SORTEDSET(mss, mappedsortedset, size_t)
+
+static const char *msm_path = "mappedsortedmap.tmp";
+
+/* With and without the sparse index, with steps that do and do not divide */
+/* the amount of keys */
+static const size_t msm_steps[] = { 0, 1, 7, 64, 5000, 10000 };
+
+static bool msm_save(struct msm_treemap *map, size_t step)
+{
+    FILE *file = fopen(msm_path, "wb");
+
+    if (!file)
+        return false;
+
+    bool saved = msm_tm_save_flat(map, file, step);
+
+    return fclose(file) == 0 && saved;
+}
+
+CMC_CREATE_UNIT(mappedsortedmap_test, true, {
+    CMC_CREATE_TEST(get, {
+        struct msm_treemap *map = msm_tm_new(cmp);
+
+        /* Even keys only */
+        for (size_t i = 0; i < 5000; i++)
+            msm_tm_insert(map, i * 2, i);
+
+        for (size_t s = 0; s < sizeof(msm_steps) / sizeof(msm_steps[0]); s++)
+        {
+            cmc_assert(msm_save(map, msm_steps[s]));
+
+            struct mappedsortedmap *view = msm_open(msm_path, cmp);
+
+            cmc_assert_not_equals(ptr, NULL, view);
+            cmc_assert_equals(size_t, 5000, msm_count(view));
+            cmc_assert_equals(size_t, msm_steps[s], msm_step(view));
+
+            for (size_t i = 0; i < 10000; i++)
+            {
+                cmc_assert_equals(bool, i % 2 == 0, msm_contains(view, i));
+                cmc_assert_equals(size_t, i % 2 == 0 ? i / 2 : 0, msm_get(view, i));
+                cmc_assert_equals(size_t, (i + 1) / 2, msm_rank(view, i));
+            }
+
+            cmc_assert(msm_get_ref(view, 10001) == NULL);
+            cmc_assert_equals(size_t, 5000, msm_rank(view, 20000));
+
+            msm_close(view);
+        }
+
+        msm_tm_free(map, NULL);
+        remove(msm_path);
+    });
+
+    CMC_CREATE_TEST(range, {
+        struct msm_treemap *map = msm_tm_new(cmp);
+
+        for (size_t i = 0; i < 1000; i++)
+            msm_tm_insert(map, i * 10, i);
+
+        cmc_assert(msm_save(map, 16));
+
+        struct mappedsortedmap *view = msm_open(msm_path, cmp);
+        struct mappedsortedmap_iter iter;
+
+        cmc_assert_not_equals(ptr, NULL, view);
+
+        /* Keys from 105, inclusive, to 205, exclusive */
+        size_t total = 0;
+
+        for (msm_iter_init_range(&iter, view, 105, 205); !msm_iter_end(&iter);
+             msm_iter_next(&iter))
+        {
+            cmc_assert_equals(size_t, msm_iter_key(&iter) / 10, msm_iter_value(&iter));
+            total++;
+        }
+
+        cmc_assert_equals(size_t, 10, total);
+
+        iter = msm_lower_bound(view, 9990);
+        cmc_assert(!msm_iter_end(&iter));
+        cmc_assert_equals(size_t, 9990, msm_iter_key(&iter));
+        cmc_assert(!msm_iter_next(&iter));
+
+        iter = msm_upper_bound(view, 9990);
+        cmc_assert(msm_iter_end(&iter));
+
+        iter = msm_lower_bound(view, 0);
+        msm_iter_to_end(&iter);
+        cmc_assert_equals(size_t, 9990, msm_iter_key(&iter));
+        cmc_assert(msm_iter_prev(&iter));
+        cmc_assert_equals(size_t, 9980, msm_iter_key(&iter));
+
+        msm_iter_init_range(&iter, view, 500, 100);
+        cmc_assert(msm_iter_end(&iter));
+
+        msm_close(view);
+        msm_tm_free(map, NULL);
+        remove(msm_path);
+    });
+
+    CMC_CREATE_TEST(set, {
+        struct msm_sortedlist *list = msm_sl_new(100, cmp);
+
+        for (size_t i = 0; i < 1000; i++)
+            msm_sl_insert(list, (i * 7) % 1000);
+
+        FILE *file = fopen(msm_path, "wb");
+
+        cmc_assert_not_equals(ptr, NULL, file);
+        cmc_assert(msm_sl_save_flat(list, file, 32));
+        fclose(file);
+
+        /* A map can not open the file of a set */
+        cmc_assert_equals(ptr, NULL, msm_open(msm_path, cmp));
+
+        struct mappedsortedset *view = mss_open(msm_path, cmp);
+        struct mappedsortedset_iter iter;
+        size_t expected = 0;
+
+        cmc_assert_not_equals(ptr, NULL, view);
+
+        for (mss_iter_init(&iter, view); !mss_iter_end(&iter); mss_iter_next(&iter))
+            cmc_assert_equals(size_t, expected++, mss_iter_value(&iter));
+
+        cmc_assert_equals(size_t, 1000, expected);
+        cmc_assert(mss_contains(view, 999));
+        cmc_assert(!mss_contains(view, 1000));
+
+        mss_close(view);
+        msm_sl_free(list, NULL);
+        remove(msm_path);
+    });
+
+    CMC_CREATE_TEST(invalid, {
+        cmc_assert_equals(ptr, NULL, msm_open("mappedsortedmap.none", cmp));
+
+        FILE *file = fopen(msm_path, "wb");
+
+        cmc_assert_not_equals(ptr, NULL, file);
+        fputs("not a flat file", file);
+        fclose(file);
+
+        cmc_assert_equals(ptr, NULL, msm_open(msm_path, cmp));
+
+        /* Saved by save, not save_flat */
+        struct msm_treemap *map = msm_tm_new(cmp);
+
+        msm_tm_insert(map, 1, 1);
+
+        file = fopen(msm_path, "wb");
+        cmc_assert(msm_tm_save(map, file, NULL, NULL));
+        fclose(file);
+
+        cmc_assert_equals(ptr, NULL, msm_open(msm_path, cmp));
+
+        msm_tm_free(map, NULL);
+        remove(msm_path);
+    });
+});
@@ -0,0 +1,378 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <utl/cmc_alloc.h>
+
+/* Uses the collections generated by the other unit tests. A collection */
+/* created with cmc_alloc_node_tracked holds exactly what memory_usage says */
+
+CMC_CREATE_UNIT(memory_test, true, {
+    CMC_CREATE_TEST(list, {
+        cmc_alloc_tracker_reset();
+
+        struct list *list = l_new_custom(10, &cmc_alloc_node_tracked);
+
+        cmc_assert_equals(size_t, cmc_alloc_tracker.current, l_memory_usage(list));
+
+        for (size_t i = 0; i < 1000; i++)
+            l_push_back(list, i);
+
+        cmc_assert_equals(size_t, cmc_alloc_tracker.current, l_memory_usage(list));
+        cmc_assert_greater_equals(size_t, sizeof(size_t) * 1000, l_memory_usage(list));
+
+        l_free(list, NULL);
+
+        cmc_assert_equals(size_t, 0, cmc_alloc_tracker.current);
+    });
+
+    CMC_CREATE_TEST(deque, {
+        cmc_alloc_tracker_reset();
+
+        struct deque *deque = d_new_custom(10, &cmc_alloc_node_tracked);
+
+        for (size_t i = 0; i < 1000; i++)
+            d_push_front(deque, i);
+
+        cmc_assert_equals(size_t, cmc_alloc_tracker.current, d_memory_usage(deque));
+
+        d_free(deque, NULL);
+
+        cmc_assert_equals(size_t, 0, cmc_alloc_tracker.current);
+    });
+
+    CMC_CREATE_TEST(heap, {
+        cmc_alloc_tracker_reset();
+
+        struct heap *heap = h_new_custom(10, cmc_max_heap, cmp, &cmc_alloc_node_tracked);
+
+        for (size_t i = 0; i < 1000; i++)
+            h_insert(heap, i);
+
+        cmc_assert_equals(size_t, cmc_alloc_tracker.current, h_memory_usage(heap));
+
+        h_free(heap, NULL);
+
+        cmc_assert_equals(size_t, 0, cmc_alloc_tracker.current);
+    });
+
+    CMC_CREATE_TEST(gaplist, {
+        cmc_alloc_tracker_reset();
+
+        struct gaplist *list = gl_new_custom(10, &cmc_alloc_node_tracked);
+
+        for (size_t i = 0; i < 1000; i++)
+            gl_push_front(list, i);
+
+        cmc_assert_equals(size_t, cmc_alloc_tracker.current, gl_memory_usage(list));
+
+        gl_free(list, NULL);
+
+        cmc_assert_equals(size_t, 0, cmc_alloc_tracker.current);
+    });
+
+    CMC_CREATE_TEST(blockdeque, {
+        cmc_alloc_tracker_reset();
+
+        struct blockdeque *deque = bd_new_custom(10, &cmc_alloc_node_tracked);
+
+        for (size_t i = 0; i < 5000; i++)
+            bd_push_back(deque, i);
+
+        for (size_t i = 0; i < 2500; i++)
+            bd_pop_front(deque);
+
+        cmc_assert_equals(size_t, cmc_alloc_tracker.current, bd_memory_usage(deque));
+
+        bd_free(deque, NULL);
+
+        cmc_assert_equals(size_t, 0, cmc_alloc_tracker.current);
+    });
+
+    CMC_CREATE_TEST(linkedlist, {
+        cmc_alloc_tracker_reset();
+
+        struct linkedlist *list = ll_new_custom(&cmc_alloc_node_tracked);
+
+        for (size_t i = 0; i < 1000; i++)
+            ll_push_back(list, i);
+
+        cmc_assert_equals(size_t, cmc_alloc_tracker.current, ll_memory_usage(list));
+
+        ll_free(list, NULL);
+
+        cmc_assert_equals(size_t, 0, cmc_alloc_tracker.current);
+    });
+
+    CMC_CREATE_TEST(unrolledlist, {
+        cmc_alloc_tracker_reset();
+
+        struct unrolledlist *list = ul_new_custom(&cmc_alloc_node_tracked);
+
+        for (size_t i = 0; i < 1000; i++)
+            ul_push_back(list, i);
+
+        cmc_assert_equals(size_t, cmc_alloc_tracker.current, ul_memory_usage(list));
+
+        ul_free(list, NULL);
+
+        cmc_assert_equals(size_t, 0, cmc_alloc_tracker.current);
+    });
+
+    CMC_CREATE_TEST(sortedlist, {
+        cmc_alloc_tracker_reset();
+
+        struct sortedlist *list = sl_new_custom(10, cmp, &cmc_alloc_node_tracked);
+
+        for (size_t i = 0; i < 1000; i++)
+            sl_insert(list, (i * 7919) % 1000);
+
+        cmc_assert_equals(size_t, cmc_alloc_tracker.current, sl_memory_usage(list));
+
+        sl_free(list, NULL);
+
+        cmc_assert_equals(size_t, 0, cmc_alloc_tracker.current);
+    });
+
+    CMC_CREATE_TEST(hashmap, {
+        cmc_alloc_tracker_reset();
+
+        struct hashmap *map = hm_new_custom(10, 0.6, cmp, hash, &cmc_alloc_node_tracked);
+
+        for (size_t i = 0; i < 1000; i++)
+            hm_insert(map, i, i);
+
+        cmc_assert_equals(size_t, cmc_alloc_tracker.current, hm_memory_usage(map));
+
+        for (size_t i = 0; i < 900; i++)
+            hm_remove(map, i, NULL);
+
+        cmc_assert_equals(size_t, cmc_alloc_tracker.current, hm_memory_usage(map));
+
+        hm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, cmc_alloc_tracker.current);
+    });
+
+    CMC_CREATE_TEST(hashmap_incremental, {
+        cmc_alloc_tracker_reset();
+
+        struct hashmap_incremental *map =
+            hmi_new_custom(10, 0.6, cmp, hash, &cmc_alloc_node_tracked);
+
+        /* Checked while the old table is still being moved */
+        for (size_t i = 0; i < 1000; i++)
+        {
+            hmi_insert(map, i, i);
+
+            if (i % 97 == 0)
+                cmc_assert_equals(size_t, cmc_alloc_tracker.current, hmi_memory_usage(map));
+        }
+
+        hmi_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, cmc_alloc_tracker.current);
+    });
+
+    CMC_CREATE_TEST(hashset, {
+        cmc_alloc_tracker_reset();
+
+        struct hashset *set = hs_new_custom(10, 0.6, cmp, hash, &cmc_alloc_node_tracked);
+
+        for (size_t i = 0; i < 1000; i++)
+            hs_insert(set, i);
+
+        cmc_assert_equals(size_t, cmc_alloc_tracker.current, hs_memory_usage(set));
+
+        hs_free(set, NULL);
+
+        cmc_assert_equals(size_t, 0, cmc_alloc_tracker.current);
+    });
+
+    CMC_CREATE_TEST(swissmap, {
+        cmc_alloc_tracker_reset();
+
+        struct swissmap *map = sm_new_custom(10, 0.6, cmp, hash, &cmc_alloc_node_tracked);
+
+        for (size_t i = 0; i < 1000; i++)
+            sm_insert(map, i, i);
+
+        cmc_assert_equals(size_t, cmc_alloc_tracker.current, sm_memory_usage(map));
+
+        sm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, cmc_alloc_tracker.current);
+    });
+
+    CMC_CREATE_TEST(multimap, {
+        cmc_alloc_tracker_reset();
+
+        struct multimap *map = mm_new_custom(10, 0.6, cmp, hash, &cmc_alloc_node_tracked);
+
+        for (size_t i = 0; i < 1000; i++)
+            mm_insert(map, i % 100, i);
+
+        cmc_assert_equals(size_t, cmc_alloc_tracker.current, mm_memory_usage(map));
+
+        mm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, cmc_alloc_tracker.current);
+    });
+
+    CMC_CREATE_TEST(multiset, {
+        cmc_alloc_tracker_reset();
+
+        struct multiset *set = ms_new_custom(10, 0.6, cmp, hash, &cmc_alloc_node_tracked);
+
+        for (size_t i = 0; i < 1000; i++)
+            ms_insert(set, i % 100);
+
+        cmc_assert_equals(size_t, cmc_alloc_tracker.current, ms_memory_usage(set));
+
+        ms_free(set, NULL);
+
+        cmc_assert_equals(size_t, 0, cmc_alloc_tracker.current);
+    });
+
+    CMC_CREATE_TEST(bidimap, {
+        cmc_alloc_tracker_reset();
+
+        struct bidimap *map =
+            bm_new_custom(10, 0.6, cmp, hash, cmp, hash, &cmc_alloc_node_tracked);
+
+        for (size_t i = 0; i < 1000; i++)
+            bm_insert(map, i, i + 1000);
+
+        cmc_assert_equals(size_t, cmc_alloc_tracker.current, bm_memory_usage(map));
+
+        bm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, cmc_alloc_tracker.current);
+    });
+
+    CMC_CREATE_TEST(orderedhashmap, {
+        cmc_alloc_tracker_reset();
+
+        struct orderedhashmap *map =
+            ohm_new_custom(10, 0.6, cmp, hash, &cmc_alloc_node_tracked);
+
+        for (size_t i = 0; i < 1000; i++)
+            ohm_insert(map, i, i);
+
+        cmc_assert_equals(size_t, cmc_alloc_tracker.current, ohm_memory_usage(map));
+
+        ohm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, cmc_alloc_tracker.current);
+    });
+
+    CMC_CREATE_TEST(lrucache, {
+        cmc_alloc_tracker_reset();
+
+        struct lrucache *cache = lru_new_custom(100, cmp, hash, NULL, &cmc_alloc_node_tracked);
+
+        for (size_t i = 0; i < 1000; i++)
+            lru_put(cache, i, i);
+
+        cmc_assert_equals(size_t, cmc_alloc_tracker.current, lru_memory_usage(cache));
+
+        lru_free(cache, NULL);
+
+        cmc_assert_equals(size_t, 0, cmc_alloc_tracker.current);
+    });
+
+    CMC_CREATE_TEST(concurrenthashmap, {
+        cmc_alloc_tracker_reset();
+
+        struct concurrenthashmap *map =
+            chm_new_custom(4, 10, 0.6, cmp, hash, &cmc_alloc_node_tracked);
+
+        for (size_t i = 0; i < 1000; i++)
+            chm_insert(map, i, i);
+
+        cmc_assert_equals(size_t, cmc_alloc_tracker.current, chm_memory_usage(map));
+
+        chm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, cmc_alloc_tracker.current);
+    });
+
+    CMC_CREATE_TEST(treemap, {
+        cmc_alloc_tracker_reset();
+
+        struct treemap *map = tm_new_custom(cmp, &cmc_alloc_node_tracked);
+
+        for (size_t i = 0; i < 1000; i++)
+            tm_insert(map, i, i);
+
+        cmc_assert_equals(size_t, cmc_alloc_tracker.current, tm_memory_usage(map));
+
+        tm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, cmc_alloc_tracker.current);
+    });
+
+    CMC_CREATE_TEST(treeset, {
+        cmc_alloc_tracker_reset();
+
+        struct treeset *set = ts_new_custom(cmp, &cmc_alloc_node_tracked);
+
+        for (size_t i = 0; i < 1000; i++)
+            ts_insert(set, i);
+
+        cmc_assert_equals(size_t, cmc_alloc_tracker.current, ts_memory_usage(set));
+
+        ts_free(set, NULL);
+
+        cmc_assert_equals(size_t, 0, cmc_alloc_tracker.current);
+    });
+
+    CMC_CREATE_TEST(btreemap, {
+        cmc_alloc_tracker_reset();
+
+        struct btreemap *map = btm_new_custom(cmp, &cmc_alloc_node_tracked);
+
+        for (size_t i = 0; i < 1000; i++)
+            btm_insert(map, i, i);
+
+        cmc_assert_equals(size_t, cmc_alloc_tracker.current, btm_memory_usage(map));
+
+        btm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, cmc_alloc_tracker.current);
+    });
+
+    CMC_CREATE_TEST(skiplistmap, {
+        cmc_alloc_tracker_reset();
+
+        struct skiplistmap *map = slm_new_custom(cmp, &cmc_alloc_node_tracked);
+
+        for (size_t i = 0; i < 1000; i++)
+            slm_insert(map, i, i);
+
+        for (size_t i = 0; i < 500; i++)
+            slm_remove(map, i, NULL);
+
+        cmc_assert_equals(size_t, cmc_alloc_tracker.current, slm_memory_usage(map));
+
+        slm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, cmc_alloc_tracker.current);
+    });
+
+    CMC_CREATE_TEST(persistenttreemap, {
+        cmc_alloc_tracker_reset();
+
+        struct persistenttreemap *map = ptm_new_custom(cmp, &cmc_alloc_node_tracked);
+
+        for (size_t i = 0; i < 1000; i++)
+            ptm_insert(map, i, i);
+
+        cmc_assert_equals(size_t, cmc_alloc_tracker.current, ptm_memory_usage(map));
+
+        ptm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, cmc_alloc_tracker.current);
+    });
+});
@@ -0,0 +1,306 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/minmaxheap.h>
+
+CMC_GENERATE_MINMAXHEAP(mmh, minmaxheap, size_t)
+CMC_GENERATE_MINMAXHEAP_EX(mmhx, minmaxheapx, size_t, cmp)
+
+/* If every element on a min level is not greater than its descendants and */
+/* every element on a max level is not less than them */
+static bool minmaxheap_valid(struct minmaxheap *h)
+{
+    for (size_t i = 1; i < h->count; i++)
+    {
+        /* Comparing to the parent and to the grandparent covers every pair */
+        size_t parent = (i - 1) / 2;
+        bool parent_min = mmh_impl_min_level(parent);
+
+        if (parent_min ? h->buffer[parent] > h->buffer[i] : h->buffer[parent] < h->buffer[i])
+            return false;
+
+        if (parent == 0)
+            continue;
+
+        size_t grandparent = (parent - 1) / 2;
+        bool grand_min = !parent_min;
+
+        if (grand_min ? h->buffer[grandparent] > h->buffer[i]
+                      : h->buffer[grandparent] < h->buffer[i])
+            return false;
+    }
+
+    return true;
+}
+
+CMC_CREATE_UNIT(minmaxheap_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct minmaxheap *h = mmh_new(1000000, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+        cmc_assert_not_equals(ptr, NULL, h->buffer);
+        cmc_assert_equals(size_t, 1000000, mmh_capacity(h));
+        cmc_assert_equals(size_t, 0, mmh_count(h));
+
+        size_t r;
+
+        cmc_assert(!mmh_min(h, &r));
+        cmc_assert(!mmh_max(h, &r));
+        cmc_assert(!mmh_remove_min(h, &r));
+        cmc_assert(!mmh_remove_max(h, &r));
+
+        mmh_free(h, NULL);
+
+        cmc_assert_equals(ptr, NULL, mmh_new(0, cmp));
+        cmc_assert_equals(ptr, NULL, mmh_new(UINT64_MAX, cmp));
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct minmaxheap *h = mmh_new_custom(100, cmp, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+
+        for (size_t i = 0; i < 1000; i++)
+            mmh_insert(h, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        mmh_free(h, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(insert remove, {
+        struct minmaxheap *h = mmh_new(1, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+
+        for (size_t i = 0; i < 1001; i++)
+        {
+            cmc_assert(mmh_insert(h, (i * 7919) % 1001));
+            cmc_assert(minmaxheap_valid(h));
+        }
+
+        cmc_assert_equals(size_t, 1001, mmh_count(h));
+
+        size_t r;
+
+        cmc_assert(mmh_min(h, &r));
+        cmc_assert_equals(size_t, 0, r);
+        cmc_assert(mmh_max(h, &r));
+        cmc_assert_equals(size_t, 1000, r);
+
+        /* Both ends come out in order */
+        for (size_t i = 0; i < 500; i++)
+        {
+            cmc_assert(mmh_remove_min(h, &r));
+            cmc_assert_equals(size_t, i, r);
+            cmc_assert(mmh_remove_max(h, &r));
+            cmc_assert_equals(size_t, 1000 - i, r);
+            cmc_assert(minmaxheap_valid(h));
+        }
+
+        cmc_assert(mmh_remove_max(h, &r));
+        cmc_assert_equals(size_t, 500, r);
+        cmc_assert(mmh_empty(h));
+
+        /* Removals shrink the buffer */
+        cmc_assert(mmh_capacity(h) < 1001);
+
+        mmh_free(h, NULL);
+    });
+
+    CMC_CREATE_TEST(update, {
+        struct minmaxheap *h = mmh_new(100, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+        cmc_assert(!mmh_update_min(h, 1));
+        cmc_assert(!mmh_update_max(h, 1));
+
+        cmc_assert(mmh_insert(h, 50));
+        cmc_assert(mmh_update_max(h, 60));
+
+        size_t r;
+
+        cmc_assert(mmh_min(h, &r));
+        cmc_assert_equals(size_t, 60, r);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(mmh_insert(h, i * 10));
+
+        /* A minimum greater than the maximum and a maximum less than the */
+        /* minimum end up at the other end */
+        cmc_assert(mmh_update_min(h, 5000));
+        cmc_assert(minmaxheap_valid(h));
+        cmc_assert(mmh_max(h, &r));
+        cmc_assert_equals(size_t, 5000, r);
+        cmc_assert(mmh_min(h, &r));
+        cmc_assert_equals(size_t, 10, r);
+
+        cmc_assert(mmh_update_max(h, 1));
+        cmc_assert(minmaxheap_valid(h));
+        cmc_assert(mmh_min(h, &r));
+        cmc_assert_equals(size_t, 1, r);
+        cmc_assert(mmh_max(h, &r));
+        cmc_assert_equals(size_t, 990, r);
+
+        for (size_t i = 0; i < 50; i++)
+        {
+            cmc_assert(mmh_update_max(h, i));
+            cmc_assert(mmh_update_min(h, 1000 + i));
+            cmc_assert(minmaxheap_valid(h));
+        }
+
+        cmc_assert_equals(size_t, 101, mmh_count(h));
+
+        mmh_free(h, NULL);
+    });
+
+    CMC_CREATE_TEST(new_from insert_many, {
+        size_t elements[1001];
+
+        for (size_t i = 0; i < 1001; i++)
+            elements[i] = (i * 7919) % 1001;
+
+        for (size_t n = 0; n < 40; n++)
+        {
+            struct minmaxheap *h = mmh_new_from(elements, n, cmp);
+
+            cmc_assert_not_equals(ptr, NULL, h);
+            cmc_assert(minmaxheap_valid(h));
+            cmc_assert_equals(size_t, n, mmh_count(h));
+
+            mmh_free(h, NULL);
+        }
+
+        struct minmaxheap *h = mmh_new_from(elements, 300, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+
+        /* The first batch is heapified and the smaller ones inserted */
+        cmc_assert(mmh_insert_many(h, elements + 300, 400));
+        cmc_assert(minmaxheap_valid(h));
+        cmc_assert(mmh_insert_many(h, elements + 700, 301));
+        cmc_assert(minmaxheap_valid(h));
+        cmc_assert(mmh_insert_many(h, elements, 0));
+        cmc_assert_equals(size_t, 1001, mmh_count(h));
+
+        size_t r;
+
+        for (size_t i = 0; i < 1001; i++)
+        {
+            cmc_assert(mmh_remove_min(h, &r));
+            cmc_assert_equals(size_t, i, r);
+        }
+
+        mmh_free(h, NULL);
+    });
+
+    CMC_CREATE_TEST(random, {
+        struct minmaxheap *h = mmh_new(8, cmp);
+        struct minmaxheapx *hx = mmhx_new(8, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+        cmc_assert_not_equals(ptr, NULL, hx);
+
+        /* How many of each value are in the heap */
+        size_t counts[256];
+
+        for (size_t i = 0; i < 256; i++)
+            counts[i] = 0;
+
+        size_t x = 1;
+
+        for (size_t i = 0; i < 20000; i++)
+        {
+            x = x * 6364136223846793005u + 1442695040888963407u;
+
+            size_t r = x >> 33;
+            size_t value = r % 256;
+            size_t result;
+            size_t resultx;
+
+            if (r % 5 < 2)
+            {
+                cmc_assert(mmh_insert(h, value));
+                cmc_assert(mmhx_insert(hx, value));
+                counts[value]++;
+            }
+            else if (mmh_empty(h))
+                continue;
+            else if (r % 5 == 2)
+            {
+                cmc_assert(mmh_remove_min(h, &result));
+                cmc_assert(mmhx_remove_min(hx, &resultx));
+                cmc_assert_equals(size_t, result, resultx);
+
+                for (size_t k = 0; k < result; k++)
+                    cmc_assert_equals(size_t, 0, counts[k]);
+
+                counts[result]--;
+            }
+            else if (r % 5 == 3)
+            {
+                cmc_assert(mmh_remove_max(h, &result));
+                cmc_assert(mmhx_remove_max(hx, &resultx));
+                cmc_assert_equals(size_t, result, resultx);
+
+                for (size_t k = result + 1; k < 256; k++)
+                    cmc_assert_equals(size_t, 0, counts[k]);
+
+                counts[result]--;
+            }
+            else
+            {
+                cmc_assert(mmh_min(h, &result));
+                cmc_assert(mmh_update_min(h, value));
+                cmc_assert(mmhx_update_min(hx, value));
+                counts[result]--;
+                counts[value]++;
+            }
+        }
+
+        cmc_assert(minmaxheap_valid(h));
+        cmc_assert_equals(size_t, mmh_count(h), mmhx_count(hx));
+
+        mmh_free(h, NULL);
+        mmhx_free(hx, NULL);
+    });
+
+    CMC_CREATE_TEST(copy_of equals, {
+        struct minmaxheap *h = mmh_new(10, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(mmh_insert(h, i));
+
+        struct minmaxheap *copy = mmh_copy_of(h, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, copy);
+        cmc_assert(mmh_equals(h, copy));
+        cmc_assert(mmh_contains(copy, 99));
+        cmc_assert(!mmh_contains(copy, 100));
+
+        size_t r;
+
+        cmc_assert(mmh_remove_max(copy, &r));
+        cmc_assert(!mmh_equals(h, copy));
+
+        struct minmaxheap_iter iter;
+
+        size_t sum = 0;
+
+        for (mmh_iter_init(&iter, h); !mmh_iter_end(&iter); mmh_iter_next(&iter))
+            sum += mmh_iter_value(&iter);
+
+        cmc_assert_equals(size_t, 4950, sum);
+
+        mmh_free(h, NULL);
+        mmh_free(copy, NULL);
+    });
+});
@@ -0,0 +1,194 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <cmc/mpmcqueue.h>
+
+CMC_GENERATE_MPMC_QUEUE(mq, mpmcqueue, size_t)
+
+#define MPMC_THREADS 4
+#define MPMC_PER_THREAD 20000
+
+struct mpmc_worker
+{
+    struct mpmcqueue *queue;
+    size_t first;
+    size_t sum;
+    size_t errors;
+    unsigned char *seen;
+};
+
+/* Each producer enqueues its range of values, alternating blocking and */
+/* non-blocking calls */
+static void *mpmc_producer_run(void *arg)
+{
+    struct mpmc_worker *worker = arg;
+
+    for (size_t i = 0; i < MPMC_PER_THREAD; i++)
+    {
+        size_t value = worker->first + i;
+
+        if (i % 2 == 0)
+        {
+            if (!mq_enqueue(worker->queue, value))
+                worker->errors++;
+        }
+        else
+        {
+            while (!mq_try_enqueue(worker->queue, value))
+                sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+static void *mpmc_consumer_run(void *arg)
+{
+    struct mpmc_worker *worker = arg;
+
+    for (size_t i = 0; i < MPMC_PER_THREAD; i++)
+    {
+        size_t value;
+
+        if (!mq_dequeue(worker->queue, &value))
+            worker->errors++;
+
+        worker->sum += value;
+
+        /* Each byte is only written by the consumer of that value */
+        worker->seen[value]++;
+    }
+
+    return NULL;
+}
+
+CMC_CREATE_UNIT(mpmcqueue_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct mpmcqueue *q = mq_new(5);
+
+        cmc_assert_not_equals(ptr, NULL, q);
+        cmc_assert_equals(size_t, 8, mq_capacity(q));
+        cmc_assert(mq_empty(q));
+        cmc_assert(!mq_full(q));
+
+        mq_free(q, NULL);
+
+        cmc_assert_equals(ptr, NULL, mq_new(0));
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct mpmcqueue *q = mq_new_custom(5, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, q);
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        mq_free(q, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(try_enqueue try_dequeue, {
+        struct mpmcqueue *q = mq_new(16);
+
+        cmc_assert_not_equals(ptr, NULL, q);
+
+        size_t value;
+
+        cmc_assert(!mq_try_dequeue(q, &value));
+
+        /* Several turns around the buffer */
+        for (size_t turn = 0; turn < 5; turn++)
+        {
+            for (size_t i = 0; i < 16; i++)
+                cmc_assert(mq_try_enqueue(q, turn * 100 + i));
+
+            cmc_assert(mq_full(q));
+            cmc_assert(!mq_try_enqueue(q, 0));
+            cmc_assert_equals(size_t, 16, mq_count(q));
+
+            for (size_t i = 0; i < 16; i++)
+            {
+                cmc_assert(mq_try_dequeue(q, &value));
+                cmc_assert_equals(size_t, turn * 100 + i, value);
+            }
+
+            cmc_assert(mq_empty(q));
+            cmc_assert(!mq_try_dequeue(q, &value));
+        }
+
+        cmc_assert(mq_enqueue(q, 7));
+        cmc_assert(mq_dequeue(q, &value));
+        cmc_assert_equals(size_t, 7, value);
+
+        mq_free(q, NULL);
+    });
+
+    CMC_CREATE_TEST(threads, {
+        /* A small capacity makes both sides wait on each other */
+        struct mpmcqueue *q = mq_new(8);
+
+        cmc_assert_not_equals(ptr, NULL, q);
+
+        size_t total = MPMC_THREADS * MPMC_PER_THREAD;
+
+        unsigned char *seen = calloc(total, 1);
+
+        cmc_assert_not_equals(ptr, NULL, seen);
+
+        pthread_t producers[MPMC_THREADS];
+        pthread_t consumers[MPMC_THREADS];
+        struct mpmc_worker workers[MPMC_THREADS * 2];
+
+        for (size_t i = 0; i < MPMC_THREADS * 2; i++)
+        {
+            workers[i].queue = q;
+            workers[i].first = (i % MPMC_THREADS) * MPMC_PER_THREAD;
+            workers[i].sum = 0;
+            workers[i].errors = 0;
+            workers[i].seen = seen;
+        }
+
+        for (size_t i = 0; i < MPMC_THREADS; i++)
+        {
+            int r1 = pthread_create(&consumers[i], NULL, mpmc_consumer_run, &workers[i]);
+            int r2 = pthread_create(&producers[i], NULL, mpmc_producer_run,
+                                    &workers[MPMC_THREADS + i]);
+
+            cmc_assert_equals(int32_t, 0, r1);
+            cmc_assert_equals(int32_t, 0, r2);
+        }
+
+        size_t sum = 0;
+
+        for (size_t i = 0; i < MPMC_THREADS; i++)
+        {
+            pthread_join(producers[i], NULL);
+            pthread_join(consumers[i], NULL);
+
+            sum += workers[i].sum;
+
+            cmc_assert_equals(size_t, 0, workers[i].errors);
+            cmc_assert_equals(size_t, 0, workers[MPMC_THREADS + i].errors);
+        }
+
+        cmc_assert_equals(size_t, total * (total - 1) / 2, sum);
+        cmc_assert(mq_empty(q));
+
+        size_t once = 0;
+
+        for (size_t i = 0; i < total; i++)
+            once += seen[i] == 1;
+
+        cmc_assert_equals(size_t, total, once);
+
+        free(seen);
+        mq_free(q, NULL);
+    });
+});
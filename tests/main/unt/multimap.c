@@ -6,6 +6,29 @@
 #include <cmc/multimap.h>
 
 CMC_GENERATE_MULTIMAP(mm, multimap, size_t, size_t)
+CMC_GENERATE_MULTIMAP_CACHED(mmc, multimap_cached, size_t, size_t)
+
+static size_t mm_deallocator_calls = 0;
+
+static void mm_deallocator(size_t key, size_t value)
+{
+    (void)key;
+    (void)value;
+
+    mm_deallocator_calls++;
+}
+
+static bool mm_odd_value(size_t key, size_t value)
+{
+    (void)key;
+
+    return value % 2 == 1;
+}
+
+static void mm_sum_values(size_t value, void *data)
+{
+    *(size_t *)data += value;
+}
 
 CMC_CREATE_UNIT(multimap_test, true, {
     CMC_CREATE_TEST(new, {
@@ -19,6 +42,44 @@ CMC_CREATE_UNIT(multimap_test, true, {
         mm_free(map, NULL);
     });
 
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct multimap *map = mm_new_custom(100, 0.8, cmp, hash, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            mm_insert(map, i % 10, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        mm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(release[arena], {
+        struct multimap *map = mm_new_custom(100, 0.8, cmp, hash, &test_arena_node);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(mm_insert(map, i % 10, i));
+
+        mm_release(map);
+        cmc_arena_reset(&test_arena);
+
+        /* The reset arena hands out the same memory again */
+        struct multimap *reused = mm_new_custom(100, 0.8, cmp, hash, &test_arena_node);
+
+        cmc_assert_equals(ptr, map, reused);
+        cmc_assert_equals(size_t, 0, mm_count(reused));
+
+        mm_release(reused);
+        cmc_arena_release(&test_arena);
+    });
+
     CMC_CREATE_TEST(new[capacity = 0], {
         struct multimap *map = mm_new(0, 0.8, cmp, hash);
 
@@ -104,6 +165,67 @@ CMC_CREATE_UNIT(multimap_test, true, {
         mm_free(map, NULL);
     });
 
+    CMC_CREATE_TEST(remove[entry reuse], {
+        struct multimap *map = mm_new(100, 0.8, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        cmc_assert(mm_insert(map, 1, 10));
+
+        size_t *ref = mm_get_ref(map, 1);
+
+        cmc_assert(mm_remove(map, 1, NULL));
+
+        /* The entry that was just removed is the first to be reused */
+        cmc_assert(mm_insert(map, 5000, 20));
+        cmc_assert(mm_get_ref(map, 5000) == ref);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(mm_insert(map, i, i));
+
+        for (size_t i = 0; i < 1000; i += 2)
+            cmc_assert(mm_remove(map, i, NULL));
+
+        for (size_t i = 1000; i < 1500; i++)
+            cmc_assert(mm_insert(map, i, i));
+
+        cmc_assert_equals(size_t, 1001, mm_count(map));
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert_equals(bool, i % 2 == 1, mm_contains(map, i));
+
+        for (size_t i = 1000; i < 1500; i++)
+            cmc_assert_equals(size_t, i, mm_get(map, i));
+
+        mm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(free[deallocator], {
+        struct multimap *map = mm_new(100, 0.8, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 300; i++)
+            cmc_assert(mm_insert(map, i % 120, i));
+
+        mm_deallocator_calls = 0;
+
+        mm_clear(map, mm_deallocator);
+
+        cmc_assert_equals(size_t, 300, mm_deallocator_calls);
+        cmc_assert_equals(size_t, 0, mm_count(map));
+
+        for (size_t i = 0; i < 300; i++)
+            cmc_assert(mm_insert(map, i % 120, i));
+
+        mm_deallocator_calls = 0;
+
+        /* Every entry is deallocated, including those alone in their bucket */
+        mm_free(map, mm_deallocator);
+
+        cmc_assert_equals(size_t, 300, mm_deallocator_calls);
+    });
+
     CMC_CREATE_TEST(get[key ordering], {
         struct multimap *map = mm_new(100, 0.8, cmp, hash);
 
@@ -135,4 +257,142 @@ CMC_CREATE_UNIT(multimap_test, true, {
 
         mm_free(map, NULL);
     });
+
+    CMC_CREATE_TEST(remove_all_into, {
+        struct multimap *map = mm_new(100, 0.8, cmp, hash0);
+        size_t values[4];
+        size_t sum = 0;
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        /* Every key is in the same chain */
+        for (size_t i = 0; i < 30; i++)
+            cmc_assert(mm_insert(map, i % 3, i));
+
+        cmc_assert_equals(size_t, 4, mm_remove_all_into(map, 1, values, 4));
+        cmc_assert_equals(size_t, 1, values[0]);
+        cmc_assert_equals(size_t, 10, values[3]);
+        cmc_assert_equals(size_t, 6, mm_key_count(map, 1));
+
+        cmc_assert_equals(size_t, 6, mm_update_all_into(map, 1, 100, values, 4));
+        cmc_assert_equals(size_t, 13, values[0]);
+        cmc_assert_equals(size_t, 22, values[3]);
+
+        cmc_assert_equals(size_t, 10, mm_update_all_each(map, 2, 0, mm_sum_values, &sum));
+        cmc_assert_equals(size_t, 155, sum);
+
+        sum = 0;
+
+        cmc_assert_equals(size_t, 6, mm_remove_all_each(map, 1, mm_sum_values, &sum));
+        cmc_assert_equals(size_t, 600, sum);
+        cmc_assert_equals(size_t, 0, mm_remove_all_into(map, 1, values, 4));
+        cmc_assert_equals(size_t, 20, mm_count(map));
+        cmc_assert_equals(size_t, 10, mm_key_count(map, 0));
+        cmc_assert_equals(size_t, 10, mm_key_count(map, 2));
+
+        mm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(remove_all[other key], {
+        struct multimap *map = mm_new(100, 0.8, cmp, hash0);
+        size_t *values = NULL;
+
+        cmc_assert_not_equals(ptr, NULL, map);
+        cmc_assert(mm_insert(map, 5, 50));
+
+        cmc_assert_equals(size_t, 0, mm_remove_all(map, 6, &values));
+        cmc_assert_equals(ptr, NULL, values);
+        cmc_assert_equals(size_t, 1, mm_count(map));
+
+        cmc_assert(mm_insert(map, 5, 51));
+
+        cmc_assert_equals(size_t, 2, mm_remove_all(map, 5, &values));
+        cmc_assert_not_equals(ptr, NULL, values);
+        cmc_assert_equals(size_t, 50, values[0]);
+        cmc_assert_equals(size_t, 51, values[1]);
+        cmc_assert_equals(size_t, 0, mm_count(map));
+
+        free(values);
+        mm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(stats, {
+        struct multimap *map = mm_new(100, 0.8, cmp, hash0);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert(mm_insert(map, i, i));
+
+        struct cmc_hashtable_stats stats;
+
+        mm_stats(map, &stats);
+
+        // Every entry is in the list of the same bucket
+        cmc_assert_equals(size_t, mm_capacity(map), stats.capacity);
+        cmc_assert_equals(size_t, 50, stats.count);
+        cmc_assert_equals(size_t, 49, stats.max_dist);
+        cmc_assert_in_range(double, 24.5 - 0.0001, 24.5 + 0.0001, stats.mean_dist);
+        cmc_assert_lesser_equals(size_t, stats.bytes,
+                                 sizeof(struct multimap_entry) * CMC_MULTIMAP_SLAB_SIZE);
+
+        mm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(cached[key_count growth], {
+        struct multimap_cached *map = mmc_new(1, 0.8, cmp, counthash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        hash_calls = 0;
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(mmc_insert(map, i % 20, i));
+
+        /* Growing the map reuses the stored hashes */
+        cmc_assert_equals(size_t, 1000, hash_calls);
+        cmc_assert_equals(size_t, 1000, mmc_count(map));
+
+        for (size_t i = 0; i < 20; i++)
+        {
+            cmc_assert_equals(size_t, 50, mmc_key_count(map, i));
+            cmc_assert_equals(size_t, i, mmc_get(map, i));
+        }
+
+        mmc_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(remove_if, {
+        struct multimap *map = mm_new(100, 0.8, cmp, hash);
+        struct multimap_cached *cached = mmc_new(100, 0.8, cmp, hash0);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(mm_insert(map, i % 10, i));
+
+        /* Every entry is in the same bucket */
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(mmc_insert(cached, i, i));
+
+        mm_deallocator_calls = 0;
+
+        cmc_assert_equals(size_t, 500, mm_remove_if(map, mm_odd_value, mm_deallocator));
+        cmc_assert_equals(size_t, 500, mm_deallocator_calls);
+        cmc_assert_equals(size_t, 500, mm_count(map));
+        cmc_assert_equals(size_t, 0, mm_remove_if(map, mm_odd_value, NULL));
+
+        for (size_t i = 0; i < 10; i++)
+            cmc_assert_equals(size_t, i % 2 == 0 ? 100 : 0, mm_key_count(map, i));
+
+        cmc_assert_equals(size_t, 50, mmc_remove_if(cached, mm_odd_value, NULL));
+        cmc_assert_equals(size_t, 50, mmc_count(cached));
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert_equals(bool, i % 2 == 0, mmc_contains(cached, i));
+
+        cmc_assert(mmc_insert(cached, 1, 1));
+        cmc_assert_equals(size_t, 1, mmc_get(cached, 1));
+
+        mm_free(map, NULL);
+        mmc_free(cached, NULL);
+    });
 });
@@ -0,0 +1,203 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/multiqueue.h>
+
+CMC_GENERATE_MULTIQUEUE(mtq, multiqueue, size_t)
+
+struct mtq_worker
+{
+    struct multiqueue *queue;
+    size_t start;
+    size_t end;
+    size_t sum;
+};
+
+static void *mtq_worker_run(void *arg)
+{
+    struct mtq_worker *worker = arg;
+
+    for (size_t i = worker->start; i < worker->end; i++)
+        mtq_insert(worker->queue, i);
+
+    /* Every thread removes as many elements as it inserted */
+    for (size_t i = worker->start; i < worker->end; i++)
+    {
+        size_t result = 0;
+
+        if (mtq_remove(worker->queue, &result))
+            worker->sum += result;
+    }
+
+    return NULL;
+}
+
+CMC_CREATE_UNIT(multiqueue_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct multiqueue *queue = mtq_new(5, 1000, cmc_min_heap, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, queue);
+        cmc_assert_equals(size_t, 8, queue->shard_count);
+        cmc_assert_equals(size_t, 0, mtq_count(queue));
+        cmc_assert(mtq_empty(queue));
+
+        for (size_t i = 0; i < queue->shard_count; i++)
+            cmc_assert_equals(size_t, 0, (uintptr_t)&(queue->shards[i]) % CMC_CACHE_LINE_SIZE);
+
+        mtq_free(queue, NULL);
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct multiqueue *queue = mtq_new_custom(4, 10, cmc_max_heap, cmp, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, queue);
+
+        for (size_t i = 0; i < 1000; i++)
+            mtq_insert(queue, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        mtq_free(queue, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(new[invalid], {
+        cmc_assert_equals(ptr, NULL, mtq_new(0, 1000, cmc_min_heap, cmp));
+        cmc_assert_equals(ptr, NULL, mtq_new(4, 0, cmc_min_heap, cmp));
+        cmc_assert_equals(ptr, NULL, mtq_new(4, 1000, 0, cmp));
+    });
+
+    CMC_CREATE_TEST(insert remove[single shard], {
+        // With one shard it is an exact priority queue
+        struct multiqueue *queue = mtq_new(1, 100, cmc_min_heap, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, queue);
+
+        for (size_t i = 1000; i > 0; i--)
+            cmc_assert(mtq_insert(queue, i));
+
+        size_t result = 0;
+
+        for (size_t i = 1; i <= 1000; i++)
+        {
+            cmc_assert(mtq_remove(queue, &result));
+            cmc_assert_equals(size_t, i, result);
+        }
+
+        cmc_assert(!mtq_remove(queue, &result));
+
+        mtq_free(queue, NULL);
+    });
+
+    CMC_CREATE_TEST(insert remove[relaxed], {
+        struct multiqueue *queue = mtq_new(4, 100, cmc_max_heap, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, queue);
+
+        for (size_t i = 0; i < 4000; i++)
+            cmc_assert(mtq_insert(queue, i));
+
+        cmc_assert_equals(size_t, 4000, mtq_count(queue));
+
+        size_t result = 0;
+        size_t sum = 0;
+        size_t first = 0;
+
+        for (size_t i = 0; i < 4000; i++)
+        {
+            cmc_assert(mtq_remove(queue, &result));
+
+            if (i < 100)
+                first += result;
+
+            sum += result;
+        }
+
+        // Every element comes out once and the first ones are near the top
+        cmc_assert_equals(size_t, 3999 * 4000 / 2, sum);
+        cmc_assert_greater(size_t, 3000 * 100, first);
+        cmc_assert(mtq_empty(queue));
+        cmc_assert(!mtq_remove(queue, &result));
+
+        mtq_free(queue, NULL);
+    });
+
+    CMC_CREATE_TEST(remove[sparse], {
+        // An element in any shard is found even if the sampled ones are empty
+        struct multiqueue *queue = mtq_new(16, 100, cmc_min_heap, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, queue);
+
+        size_t result = 0;
+
+        for (size_t i = 0; i < 100; i++)
+        {
+            cmc_assert(mtq_insert(queue, i));
+            cmc_assert(mtq_remove(queue, &result));
+            cmc_assert_equals(size_t, i, result);
+            cmc_assert(!mtq_remove(queue, &result));
+        }
+
+        mtq_free(queue, NULL);
+    });
+
+    CMC_CREATE_TEST(clear, {
+        struct multiqueue *queue = mtq_new(4, 100, cmc_min_heap, cmp);
+
+        for (size_t i = 0; i < 500; i++)
+            mtq_insert(queue, i);
+
+        mtq_clear(queue, NULL);
+
+        cmc_assert(mtq_empty(queue));
+        cmc_assert(mtq_insert(queue, 10));
+        cmc_assert_equals(size_t, 1, mtq_count(queue));
+
+        mtq_free(queue, NULL);
+    });
+
+    CMC_CREATE_TEST(threads, {
+        struct multiqueue *queue = mtq_new(8, 1000, cmc_min_heap, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, queue);
+
+        pthread_t threads[4];
+        struct mtq_worker workers[4];
+
+        for (size_t i = 0; i < 4; i++)
+        {
+            workers[i].queue = queue;
+            workers[i].start = i * 10000;
+            workers[i].end = (i + 1) * 10000;
+            workers[i].sum = 0;
+
+            int result = pthread_create(&threads[i], NULL, mtq_worker_run, &workers[i]);
+
+            cmc_assert_equals(int32_t, 0, result);
+        }
+
+        size_t sum = 0;
+
+        for (size_t i = 0; i < 4; i++)
+        {
+            pthread_join(threads[i], NULL);
+            sum += workers[i].sum;
+        }
+
+        // A thread may see the queue empty before others insert
+        size_t result = 0;
+
+        while (mtq_remove(queue, &result))
+            sum += result;
+
+        cmc_assert_equals(size_t, 39999 * 40000 / 2, sum);
+        cmc_assert(mtq_empty(queue));
+
+        mtq_free(queue, NULL);
+    });
+});
@@ -6,6 +6,24 @@
 #include <cmc/multiset.h>
 
 CMC_GENERATE_MULTISET(ms, multiset, size_t)
+CMC_GENERATE_MULTISET_CACHED(msc, multiset_cached, size_t)
+
+static size_t ms_larger(size_t a, size_t b)
+{
+    return a > b ? a : b;
+}
+
+static size_t ms_deallocated = 0;
+
+static void ms_count_deallocator(size_t value)
+{
+    ms_deallocated++;
+}
+
+static bool ms_is_odd(size_t value)
+{
+    return value % 2 == 1;
+}
 
 CMC_CREATE_UNIT(multiset_test, true, {
     CMC_CREATE_TEST(new, {
@@ -19,6 +37,23 @@ CMC_CREATE_UNIT(multiset_test, true, {
         ms_free(set, NULL);
     });
 
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct multiset *set = ms_new_custom(100, 0.6, cmp, hash, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 0; i < 1000; i++)
+            ms_insert(set, i % 10);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        ms_free(set, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
     CMC_CREATE_TEST(new[capacity = 0], {
         struct multiset *set = ms_new(0, 0.6, cmp, hash);
 
@@ -69,6 +104,27 @@ CMC_CREATE_UNIT(multiset_test, true, {
         ms_free(set, NULL);
     });
 
+    CMC_CREATE_TEST(insert_array[count cardinality multiplicity], {
+        struct multiset *set = ms_new(1, 0.9, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        size_t elements[1000];
+
+        for (size_t i = 0; i < 1000; i++)
+            elements[i] = i % 100;
+
+        cmc_assert_equals(size_t, 1000, ms_insert_array(set, elements, 1000));
+
+        cmc_assert_equals(size_t, 100, ms_count(set));
+        cmc_assert_equals(size_t, 1000, ms_cardinality(set));
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert_equals(size_t, 10, ms_multiplicity_of(set, i));
+
+        ms_free(set, NULL);
+    });
+
     CMC_CREATE_TEST(remove[count cardinality multiplicity], {
         struct multiset *set = ms_new(100, 0.6, cmp, hash);
 
@@ -134,6 +190,31 @@ CMC_CREATE_UNIT(multiset_test, true, {
         ms_free(set, NULL);
     });
 
+    CMC_CREATE_TEST(remove[backward shift], {
+        struct multiset *set = ms_new(500, 0.6, cmp, hash0);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(ms_insert(set, i));
+
+        cmc_assert(ms_insert(set, 50));
+
+        cmc_assert(ms_remove(set, 0));
+        cmc_assert_equals(size_t, 2, ms_remove_all(set, 50));
+
+        cmc_assert_equals(size_t, 98, ms_count(set));
+        cmc_assert_equals(int32_t, CMC_ES_EMPTY, set->buffer[98].state);
+
+        for (size_t i = 0; i < 98; i++)
+            cmc_assert_equals(size_t, i, set->buffer[i].dist);
+
+        for (size_t i = 1; i < 100; i++)
+            cmc_assert_equals(size_t, i == 50 ? 0 : 1, ms_multiplicity_of(set, i));
+
+        ms_free(set, NULL);
+    });
+
     CMC_CREATE_TEST(multiplicity, {
         struct multiset *set = ms_new(50, 0.6, cmp, hash);
 
@@ -150,4 +231,323 @@ CMC_CREATE_UNIT(multiset_test, true, {
 
         ms_free(set, NULL);
     });
+
+    CMC_CREATE_TEST(stats, {
+        struct multiset *set = ms_new(500, 0.6, cmp, hash0);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        // Multiplicities share a single entry
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(ms_insert(set, i % 20));
+
+        struct cmc_hashtable_stats stats;
+
+        ms_stats(set, &stats);
+
+        cmc_assert_equals(size_t, ms_capacity(set), stats.capacity);
+        cmc_assert_equals(size_t, 20, stats.count);
+        cmc_assert_equals(size_t, 19, stats.max_dist);
+        cmc_assert_in_range(double, 9.5 - 0.0001, 9.5 + 0.0001, stats.mean_dist);
+
+        ms_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(insert[robin hood multiplicity], {
+        struct multiset *set = ms_new(1, 0.9, cmp, numhash);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        /* Displaced entries must keep their own multiplicity */
+        for (size_t i = 0; i < 500; i++)
+            cmc_assert(ms_insert_many(set, (i * 7) % 500, i % 5 + 1));
+
+        cmc_assert_equals(size_t, 500, ms_count(set));
+
+        for (size_t i = 0; i < 500; i++)
+            cmc_assert_equals(size_t, i % 5 + 1, ms_multiplicity_of(set, (i * 7) % 500));
+
+        ms_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(cached[multiplicity growth], {
+        struct multiset_cached *set = msc_new(1, 0.9, cmp, counthash);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 0; i < 5000; i++)
+            cmc_assert(msc_insert(set, i % 1000));
+
+        cmc_assert_equals(size_t, 1000, msc_count(set));
+        cmc_assert_equals(size_t, 5000, msc_cardinality(set));
+
+        hash_calls = 0;
+
+        cmc_assert(msc_resize(set, 10000));
+
+        cmc_assert_equals(size_t, 0, hash_calls);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert_equals(size_t, 5, msc_multiplicity_of(set, i));
+
+        msc_free(set, NULL);
+    });
+    CMC_CREATE_TEST(merge, {
+        struct multiset *set1 = ms_new(1, 0.9, cmp, hash);
+        struct multiset *set2 = ms_new(1, 0.9, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, set1);
+        cmc_assert_not_equals(ptr, NULL, set2);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(ms_insert_many(set1, i, i % 5 + 1));
+
+        for (size_t i = 50; i < 1000; i++)
+            cmc_assert(ms_insert_many(set2, i, 3));
+
+        /* Without combine the multiplicities are added */
+        cmc_assert(ms_merge(set1, set2, NULL));
+
+        size_t cardinality = 0;
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            size_t m1 = i < 100 ? i % 5 + 1 : 0;
+            size_t m2 = i >= 50 ? 3 : 0;
+
+            cmc_assert_equals(size_t, m1 + m2, ms_multiplicity_of(set1, i));
+
+            cardinality += m1 + m2;
+        }
+
+        cmc_assert_equals(size_t, 1000, ms_count(set1));
+        cmc_assert_equals(size_t, cardinality, ms_cardinality(set1));
+
+        /* With the maximum it is the same as union_into */
+        cmc_assert(ms_merge(set2, set1, ms_larger));
+        cmc_assert_equals(size_t, 1000, ms_count(set2));
+        cmc_assert_equals(size_t, 1, ms_multiplicity_of(set2, 0));
+        cmc_assert_equals(size_t, 6, ms_multiplicity_of(set2, 52));
+        cmc_assert_equals(size_t, 3, ms_multiplicity_of(set2, 500));
+
+        ms_free(set1, NULL);
+        ms_free(set2, NULL);
+    });
+
+    CMC_CREATE_TEST(merge_free, {
+        struct multiset *set1 = ms_new(1, 0.9, cmp, hash);
+        struct multiset *set2 = ms_new(1, 0.9, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, set1);
+        cmc_assert_not_equals(ptr, NULL, set2);
+
+        for (size_t i = 0; i < 200; i++)
+            cmc_assert(ms_insert_many(set1, i, 2));
+
+        for (size_t i = 100; i < 300; i++)
+            cmc_assert(ms_insert(set2, i));
+
+        ms_deallocated = 0;
+
+        cmc_assert(ms_merge_free(set1, set2, NULL, ms_count_deallocator));
+        cmc_assert_equals(size_t, 300, ms_count(set1));
+        cmc_assert_equals(size_t, 200 * 2 + 200, ms_cardinality(set1));
+        cmc_assert_equals(size_t, 100, ms_deallocated);
+        cmc_assert_equals(size_t, 3, ms_multiplicity_of(set1, 150));
+
+        ms_free(set1, NULL);
+    });
+
+    CMC_CREATE_TEST(union_into[multiplicity], {
+        struct multiset *set1 = ms_new(1, 0.9, cmp, hash);
+        struct multiset *set2 = ms_new(1, 0.9, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, set1);
+        cmc_assert_not_equals(ptr, NULL, set2);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(ms_insert_many(set1, i, i % 5 + 1));
+
+        for (size_t i = 50; i < 1000; i++)
+            cmc_assert(ms_insert_many(set2, i, 3));
+
+        cmc_assert(ms_union_into(set1, set2));
+
+        size_t cardinality = 0;
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            size_t m1 = i < 100 ? i % 5 + 1 : 0;
+            size_t m2 = i >= 50 ? 3 : 0;
+            size_t expected = m1 > m2 ? m1 : m2;
+
+            cmc_assert_equals(size_t, expected, ms_multiplicity_of(set1, i));
+
+            cardinality += expected;
+        }
+
+        cmc_assert_equals(size_t, 1000, ms_count(set1));
+        cmc_assert_equals(size_t, cardinality, ms_cardinality(set1));
+
+        ms_free(set1, NULL);
+        ms_free(set2, NULL);
+    });
+
+    CMC_CREATE_TEST(intersect_with[multiplicity], {
+        struct multiset *small = ms_new(1, 0.9, cmp, hash);
+        struct multiset *large = ms_new(1, 0.9, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, small);
+        cmc_assert_not_equals(ptr, NULL, large);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(ms_insert_many(small, i, i % 5 + 1));
+
+        for (size_t i = 50; i < 5000; i++)
+            cmc_assert(ms_insert_many(large, i, 3));
+
+        cmc_assert(ms_intersect_with(large, small));
+        cmc_assert(ms_intersect_with(small, large));
+
+        size_t cardinality = 0;
+
+        for (size_t i = 0; i < 100; i++)
+        {
+            size_t expected = i < 50 ? 0 : (i % 5 + 1 < 3 ? i % 5 + 1 : 3);
+
+            cmc_assert_equals(size_t, expected, ms_multiplicity_of(small, i));
+            cmc_assert_equals(size_t, expected, ms_multiplicity_of(large, i));
+
+            cardinality += expected;
+        }
+
+        cmc_assert_equals(size_t, 50, ms_count(small));
+        cmc_assert_equals(size_t, 50, ms_count(large));
+        cmc_assert_equals(size_t, cardinality, ms_cardinality(small));
+        cmc_assert_equals(size_t, cardinality, ms_cardinality(large));
+
+        ms_free(small, NULL);
+        ms_free(large, NULL);
+    });
+
+    CMC_CREATE_TEST(subtract[multiplicity], {
+        struct multiset *small = ms_new(1, 0.9, cmp, hash);
+        struct multiset *large = ms_new(1, 0.9, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, small);
+        cmc_assert_not_equals(ptr, NULL, large);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(ms_insert_many(small, i, i % 5 + 1));
+
+        for (size_t i = 50; i < 5000; i++)
+            cmc_assert(ms_insert_many(large, i, 3));
+
+        ms_subtract(large, small);
+
+        /* Values from 50 to 99 with i % 5 + 1 >= 3 are removed */
+        cmc_assert_equals(size_t, 4950 - 30, ms_count(large));
+
+        for (size_t i = 50; i < 100; i++)
+            cmc_assert_equals(size_t, i % 5 + 1 < 3 ? 3 - (i % 5 + 1) : 0,
+                              ms_multiplicity_of(large, i));
+
+        ms_subtract(small, large);
+
+        /* Only values from 50 to 99 with i % 5 < 2 are left in large */
+        cmc_assert_equals(size_t, 90, ms_count(small));
+        cmc_assert_equals(size_t, 280, ms_cardinality(small));
+
+        for (size_t i = 0; i < 100; i++)
+        {
+            size_t expected = i % 5 + 1;
+
+            if (i >= 50 && i % 5 < 2)
+                expected = i % 5;
+
+            cmc_assert_equals(size_t, expected, ms_multiplicity_of(small, i));
+        }
+
+        ms_free(small, NULL);
+        ms_free(large, NULL);
+    });
+
+    CMC_CREATE_TEST(most_common, {
+        struct multiset *set = ms_new(100, 0.6, cmp, hash);
+        size_t values[10];
+        size_t multiplicities[10];
+
+        cmc_assert_equals(size_t, 0, ms_most_common(set, 10, values, multiplicities));
+
+        // Each i is inserted i times, shuffled by the multiplication
+        for (size_t i = 1; i <= 200; i++)
+            ms_insert_many(set, (i * 73) % 201, (i * 73) % 201);
+
+        cmc_assert_equals(size_t, 10, ms_most_common(set, 10, values, multiplicities));
+
+        bool descending = true;
+
+        for (size_t i = 0; i < 10; i++)
+        {
+            descending = descending && values[i] == 200 - i;
+            descending = descending && multiplicities[i] == 200 - i;
+        }
+
+        cmc_assert(descending);
+
+        struct multiset *small = ms_new(100, 0.6, cmp, hash);
+
+        ms_insert_many(small, 7, 2);
+        ms_insert_many(small, 8, 5);
+
+        cmc_assert_equals(size_t, 2, ms_most_common(small, 10, values, multiplicities));
+        cmc_assert_equals(size_t, 8, values[0]);
+        cmc_assert_equals(size_t, 2, multiplicities[1]);
+        cmc_assert_equals(size_t, 0, ms_most_common(small, 0, values, multiplicities));
+
+        ms_free(set, NULL);
+        ms_free(small, NULL);
+    });
+
+    CMC_CREATE_TEST(remove_if, {
+        struct multiset *set = ms_new(100, 0.8, cmp, hash);
+        struct multiset_cached *cached = msc_new(100, 0.8, cmp, hash0);
+
+        size_t total = 0;
+        size_t odd = 0;
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            cmc_assert(ms_insert_many(set, i, i % 3 + 1));
+
+            total += i % 3 + 1;
+
+            if (i % 2 == 1)
+                odd += i % 3 + 1;
+        }
+
+        /* Every element collides, so each removal shifts the ones after it */
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(msc_insert_many(cached, i, 2));
+
+        ms_deallocated = 0;
+
+        cmc_assert_equals(size_t, odd, ms_remove_if(set, ms_is_odd, ms_count_deallocator));
+        cmc_assert_equals(size_t, 500, ms_deallocated);
+        cmc_assert_equals(size_t, 500, ms_count(set));
+        cmc_assert_equals(size_t, total - odd, ms_cardinality(set));
+        cmc_assert_equals(size_t, 0, ms_remove_if(set, ms_is_odd, NULL));
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert_equals(size_t, i % 2 == 1 ? 0 : i % 3 + 1, ms_multiplicity_of(set, i));
+
+        cmc_assert_equals(size_t, 100, msc_remove_if(cached, ms_is_odd, NULL));
+        cmc_assert_equals(size_t, 50, msc_count(cached));
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert_equals(bool, i % 2 == 0, msc_contains(cached, i));
+
+        ms_free(set, NULL);
+        msc_free(cached, NULL);
+    });
 });
@@ -0,0 +1,393 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/orderedhashmap.h>
+
+CMC_GENERATE_ORDEREDHASHMAP(ohm, orderedhashmap, size_t, size_t)
+
+/* Checks that iterating gives the keys in the given order and that the */
+/* index finds the entry of every one of them */
+static bool ohm_in_order(struct orderedhashmap *map, size_t *keys, size_t n)
+{
+    if (ohm_count(map) != n)
+        return false;
+
+    size_t i = 0;
+
+    for (struct orderedhashmap_iter it = map->it_start(map); !ohm_iter_end(&it);
+         ohm_iter_next(&it))
+    {
+        if (i >= n || ohm_iter_key(&it) != keys[i])
+            return false;
+
+        if (ohm_get_ref(map, keys[i]) != ohm_iter_rvalue(&it))
+            return false;
+
+        i++;
+    }
+
+    return i == n;
+}
+
+CMC_CREATE_UNIT(orderedhashmap_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct orderedhashmap *map = ohm_new(100, 0.5, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+        cmc_assert_greater_equals(size_t, 200, ohm_capacity(map));
+        cmc_assert_greater_equals(size_t, 100, map->limit);
+        cmc_assert_equals(size_t, 1, map->width);
+        cmc_assert(ohm_empty(map));
+        cmc_assert(!ohm_first(map, NULL, NULL));
+        cmc_assert(!ohm_last(map, NULL, NULL));
+
+        ohm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct orderedhashmap *map = ohm_new_custom(100, 0.5, cmp, hash, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            ohm_insert(map, i, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        ohm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(new[edge cases], {
+        cmc_assert_equals(ptr, NULL, ohm_new(0, 0.5, cmp, hash));
+        cmc_assert_equals(ptr, NULL, ohm_new(100, 0.0, cmp, hash));
+        cmc_assert_equals(ptr, NULL, ohm_new(100, 1.0, cmp, hash));
+        cmc_assert_equals(ptr, NULL, ohm_new(UINTMAX_MAX, 0.5, cmp, hash));
+    });
+
+    CMC_CREATE_TEST(insert[order], {
+        struct orderedhashmap *map = ohm_new(1, 0.5, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        size_t keys[500];
+
+        // Keys in an order that doesn't follow their hash
+        for (size_t i = 0; i < 500; i++)
+        {
+            keys[i] = (i * 7919) % 500;
+            cmc_assert(ohm_insert(map, keys[i], i));
+        }
+
+        cmc_assert(!ohm_insert(map, keys[10], 0));
+        cmc_assert(ohm_in_order(map, keys, 500));
+
+        size_t key;
+        size_t value;
+
+        cmc_assert(ohm_first(map, &key, &value));
+        cmc_assert_equals(size_t, keys[0], key);
+        cmc_assert_equals(size_t, 0, value);
+        cmc_assert(ohm_last(map, &key, &value));
+        cmc_assert_equals(size_t, keys[499], key);
+        cmc_assert_equals(size_t, 499, value);
+
+        cmc_assert(ohm_max(map, &key, NULL));
+        cmc_assert_equals(size_t, 499, key);
+        cmc_assert(ohm_min(map, &key, NULL));
+        cmc_assert_equals(size_t, 0, key);
+
+        ohm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(upsert[keeps position], {
+        struct orderedhashmap *map = ohm_new(10, 0.5, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        size_t keys[3];
+
+        keys[0] = 3;
+        keys[1] = 1;
+        keys[2] = 2;
+
+        for (size_t i = 0; i < 3; i++)
+            cmc_assert(ohm_insert(map, keys[i], i));
+
+        cmc_assert(ohm_upsert(map, 3, 30));
+        cmc_assert_equals(size_t, 30, *ohm_get_or_insert(map, 3, 0));
+        cmc_assert(ohm_in_order(map, keys, 3));
+
+        size_t old;
+
+        cmc_assert(ohm_update(map, 1, 10, &old));
+        cmc_assert_equals(size_t, 1, old);
+        cmc_assert(!ohm_update(map, 4, 40, NULL));
+        cmc_assert(ohm_in_order(map, keys, 3));
+
+        // A key that is inserted again goes to the end
+        cmc_assert(ohm_remove(map, 3, NULL));
+        cmc_assert(ohm_insert(map, 3, 3));
+
+        keys[0] = 1;
+        keys[1] = 2;
+        keys[2] = 3;
+
+        cmc_assert(ohm_in_order(map, keys, 3));
+
+        ohm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(remove[holes], {
+        // Every key has the same original position
+        struct orderedhashmap *map = ohm_new(100, 0.5, cmp, hash0);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(ohm_insert(map, i, i));
+
+        size_t value;
+
+        for (size_t i = 0; i < 100; i += 2)
+        {
+            cmc_assert(ohm_remove(map, i, &value));
+            cmc_assert_equals(size_t, i, value);
+        }
+
+        cmc_assert(!ohm_remove(map, 0, NULL));
+
+        size_t keys[50];
+
+        for (size_t i = 0; i < 50; i++)
+            keys[i] = i * 2 + 1;
+
+        cmc_assert(ohm_in_order(map, keys, 50));
+
+        struct orderedhashmap_iter it = map->it_end(map);
+
+        for (size_t i = 50; i > 0; i--)
+        {
+            cmc_assert_equals(size_t, keys[i - 1], ohm_iter_key(&it));
+            ohm_iter_prev(&it);
+        }
+
+        cmc_assert(ohm_iter_start(&it));
+
+        // Filling the holes compacts the entries
+        size_t limit = map->limit;
+
+        for (size_t i = 100; i < 100 + limit; i++)
+            cmc_assert(ohm_insert(map, i, i));
+
+        size_t key;
+
+        cmc_assert_equals(size_t, ohm_count(map), map->used);
+        cmc_assert(ohm_first(map, &key, NULL));
+        cmc_assert_equals(size_t, keys[0], key);
+        cmc_assert(ohm_last(map, &key, NULL));
+        cmc_assert_equals(size_t, 99 + limit, key);
+
+        ohm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(remove[wrap around], {
+        // Clusters start at the last slot and continue at the first one
+        struct orderedhashmap *map = ohm_new(1000, 0.5, cmp, hashcapminus1);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(ohm_insert(map, i, i));
+
+        for (size_t i = 0; i < 1000; i += 3)
+            cmc_assert(ohm_remove(map, i, NULL));
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert_equals(bool, i % 3 != 0, ohm_contains(map, i));
+
+        ohm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(insert[width], {
+        struct orderedhashmap *map = ohm_new(1, 0.5, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+        cmc_assert_equals(size_t, 1, map->width);
+
+        // Positions stop fitting in one and then two bytes
+        for (size_t i = 0; i < 70000; i++)
+            cmc_assert(ohm_insert(map, i, i));
+
+        cmc_assert_equals(size_t, 4, map->width);
+
+        for (size_t i = 0; i < 70000; i++)
+            cmc_assert_equals(size_t, i, ohm_get(map, i));
+
+        for (size_t i = 0; i < 70000; i++)
+            cmc_assert(ohm_remove(map, i, NULL));
+
+        // Shrinking goes back to narrower slots
+        cmc_assert(ohm_empty(map));
+        cmc_assert_equals(size_t, 1, map->width);
+
+        ohm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(insert_many, {
+        struct orderedhashmap *map = ohm_new(1, 0.5, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        size_t keys[300];
+        size_t values[300];
+
+        for (size_t i = 0; i < 300; i++)
+        {
+            keys[i] = 300 - i;
+            values[i] = i;
+        }
+
+        cmc_assert_equals(size_t, 300, ohm_insert_many(map, keys, values, 300));
+        cmc_assert_equals(size_t, 0, ohm_insert_many(map, keys, values, 300));
+        cmc_assert(ohm_in_order(map, keys, 300));
+
+        bool found[300];
+
+        cmc_assert_equals(size_t, 300, ohm_contains_many(map, keys, 300, found));
+
+        ohm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(iterator, {
+        struct orderedhashmap *map = ohm_new(100, 0.5, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(ohm_insert(map, 100 - i, i));
+
+        for (size_t i = 0; i < 100; i += 10)
+            cmc_assert(ohm_remove(map, 100 - i, NULL));
+
+        struct orderedhashmap_iter it = map->it_start(map);
+
+        cmc_assert(ohm_iter_start(&it));
+        cmc_assert_equals(size_t, 99, ohm_iter_key(&it));
+
+        cmc_assert(ohm_iter_go_to(&it, 50));
+        cmc_assert_equals(size_t, 50, ohm_iter_index(&it));
+        cmc_assert_equals(size_t, 100 - (50 + 50 / 9 + 1), ohm_iter_key(&it));
+
+        cmc_assert(ohm_iter_rewind(&it, 50));
+        cmc_assert_equals(size_t, 99, ohm_iter_key(&it));
+        cmc_assert(!ohm_iter_rewind(&it, 1));
+
+        cmc_assert(!ohm_iter_advance(&it, 90));
+        cmc_assert(ohm_iter_advance(&it, 89));
+        cmc_assert_equals(size_t, 1, ohm_iter_key(&it));
+        cmc_assert(!ohm_iter_next(&it));
+        cmc_assert(ohm_iter_end(&it));
+
+        ohm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(copy_of equals, {
+        struct orderedhashmap *map = ohm_new(100, 0.5, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(ohm_insert(map, i, i));
+
+        for (size_t i = 0; i < 100; i += 4)
+            cmc_assert(ohm_remove(map, i, NULL));
+
+        struct orderedhashmap *copy = ohm_copy_of(map, NULL, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, copy);
+        cmc_assert(ohm_equals(map, copy, cmp));
+        cmc_assert_equals(size_t, 2, ohm_get(copy, 2));
+
+        cmc_assert(ohm_remove(copy, 1, NULL));
+        cmc_assert(ohm_insert(copy, 1, 1));
+
+        // Same keys in a different order
+        cmc_assert(ohm_equals(map, copy, cmp));
+
+        cmc_assert(ohm_update(copy, 1, 2, NULL));
+        cmc_assert(!ohm_equals(map, copy, cmp));
+        cmc_assert(ohm_equals(map, copy, NULL));
+
+        ohm_free(map, NULL);
+        ohm_free(copy, NULL);
+    });
+
+    CMC_CREATE_TEST(stats, {
+        struct orderedhashmap *map = ohm_new(1000, 0.5, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(ohm_insert(map, i, i));
+
+        struct cmc_hashtable_stats stats;
+
+        ohm_stats(map, &stats);
+
+        cmc_assert_equals(size_t, 1000, stats.count);
+        cmc_assert_equals(size_t, 0, stats.tombstones);
+        cmc_assert_equals(size_t, ohm_capacity(map), stats.capacity);
+
+        // The entries are only as many as the load allows
+        cmc_assert_equals(size_t, sizeof(struct orderedhashmap) +
+                                      map->limit * sizeof(struct orderedhashmap_entry) +
+                                      ohm_capacity(map) * 2,
+                          stats.bytes);
+
+        ohm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(save restore, {
+        struct orderedhashmap *map = ohm_new(1, 0.5, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        size_t keys[1000];
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            keys[i] = (i * 389) % 1000;
+            cmc_assert(ohm_insert(map, keys[i], i * 2));
+        }
+
+        FILE *file = tmpfile();
+
+        cmc_assert_not_equals(ptr, NULL, file);
+        cmc_assert(ohm_save(map, file, write_size, NULL));
+
+        rewind(file);
+
+        struct orderedhashmap *r = ohm_restore(file, cmp, hash, NULL, NULL);
+
+        // The keys need a reader
+        cmc_assert_equals(ptr, NULL, r);
+
+        rewind(file);
+
+        r = ohm_restore(file, cmp, hash, read_size, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, r);
+        cmc_assert(ohm_in_order(r, keys, 1000));
+        cmc_assert(ohm_equals(map, r, cmp));
+
+        fclose(file);
+        ohm_free(r, NULL);
+        ohm_free(map, NULL);
+    });
+});
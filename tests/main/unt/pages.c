@@ -0,0 +1,121 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/hashmap.h>
+#include <utl/pages.h>
+
+CMC_GENERATE_HASHMAP(pghm, pages_hashmap, size_t, size_t)
+
+/* Large blocks are only mapped if mmap can map anonymous memory */
+#ifdef CMC_PAGES_MMAP
+static const bool pages_mmap = true;
+#else
+static const bool pages_mmap = false;
+#endif
+
+CMC_CREATE_UNIT(pages_test, true, {
+    CMC_CREATE_TEST(malloc[alignment], {
+        for (size_t i = 0; i < 100; i++)
+        {
+            unsigned char *block = cmc_pages_malloc(i * 7);
+
+            cmc_assert_not_equals(ptr, NULL, block);
+            cmc_assert_equals(size_t, 0, (uintptr_t)block % CMC_CACHE_LINE_SIZE);
+            cmc_assert(!cmc_pages_mapped(block));
+
+            memset(block, 0xff, i * 7);
+
+            cmc_pages_free(block);
+        }
+
+        cmc_assert_equals(ptr, NULL, cmc_pages_malloc(SIZE_MAX));
+
+        cmc_pages_free(NULL);
+    });
+
+    CMC_CREATE_TEST(malloc[threshold], {
+        unsigned char *block = cmc_pages_malloc(CMC_PAGES_THRESHOLD);
+
+        cmc_assert_not_equals(ptr, NULL, block);
+        cmc_assert_equals(size_t, 0, (uintptr_t)block % CMC_CACHE_LINE_SIZE);
+
+        if (pages_mmap)
+        {
+            uintptr_t base = (uintptr_t)(block - CMC_CACHE_LINE_SIZE);
+
+            cmc_assert(cmc_pages_mapped(block));
+            cmc_assert_equals(size_t, 0, base % CMC_PAGES_HUGE_SIZE);
+        }
+
+        memset(block, 0xff, CMC_PAGES_THRESHOLD);
+
+        cmc_pages_free(block);
+    });
+
+    CMC_CREATE_TEST(calloc, {
+        size_t count = CMC_PAGES_THRESHOLD / sizeof(size_t) + 1;
+
+        size_t *mapped = cmc_pages_calloc(count, sizeof(size_t));
+        size_t *small = cmc_pages_calloc(100, sizeof(size_t));
+
+        cmc_assert_not_equals(ptr, NULL, mapped);
+        cmc_assert_not_equals(ptr, NULL, small);
+
+        for (size_t i = 0; i < count; i += 4096)
+            cmc_assert_equals(size_t, 0, mapped[i]);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert_equals(size_t, 0, small[i]);
+
+        cmc_assert_equals(ptr, NULL, cmc_pages_calloc(SIZE_MAX, 2));
+
+        cmc_pages_free(mapped);
+        cmc_pages_free(small);
+    });
+
+    CMC_CREATE_TEST(realloc, {
+        size_t *block = cmc_pages_realloc(NULL, sizeof(size_t) * 100);
+
+        for (size_t i = 0; i < 100; i++)
+            block[i] = i;
+
+        cmc_assert_equals(ptr, block, cmc_pages_realloc(block, sizeof(size_t) * 60));
+
+        /* From malloc to a mapping and back */
+        size_t count = CMC_PAGES_THRESHOLD / sizeof(size_t) * 2;
+
+        block = cmc_pages_realloc(block, sizeof(size_t) * count);
+
+        cmc_assert_not_equals(ptr, NULL, block);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert_equals(size_t, i, block[i]);
+
+        block[count - 1] = 1;
+
+        block = cmc_pages_realloc(block, sizeof(size_t) * 10);
+
+        for (size_t i = 0; i < 10; i++)
+            cmc_assert_equals(size_t, i, block[i]);
+
+        cmc_pages_free(block);
+    });
+
+    CMC_CREATE_TEST(node[hashmap], {
+        struct pages_hashmap *map =
+            pghm_new_custom(200000, 0.6, cmp, hash, &cmc_alloc_node_pages);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+        cmc_assert_equals(bool, pages_mmap, cmc_pages_mapped(map->buffer));
+
+        for (size_t i = 0; i < 500000; i++)
+            cmc_assert(pghm_insert(map, i, i));
+
+        for (size_t i = 0; i < 500000; i += 1000)
+            cmc_assert_equals(size_t, i, pghm_get(map, i));
+
+        pghm_free(map, NULL);
+    });
+});
@@ -0,0 +1,35 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <utl/cmc_perf.h>
+
+CMC_CREATE_UNIT(perf_test, true, {
+    CMC_CREATE_TEST(counters, {
+        struct cmc_perf perf;
+        volatile uint64_t sum = 0;
+        bool available = cmc_perf_init(&perf);
+
+        cmc_perf_start(perf);
+
+        for (uint64_t i = 0; i < 100000; i++)
+            sum += i;
+
+        cmc_perf_stop(perf);
+
+        /* Counters that were not opened stay at 0 */
+        for (int i = 0; i < CMC_PERF_COUNTERS; i++)
+        {
+            if (!cmc_perf_available(&perf, (enum cmc_perf_counter)i))
+                cmc_assert_equals(uint64_t, 0, perf.values[i]);
+        }
+
+        if (available && cmc_perf_available(&perf, cmc_perf_instructions))
+            cmc_assert_greater_equals(uint64_t, 100000, perf.values[cmc_perf_instructions]);
+
+        cmc_perf_release(&perf);
+
+        cmc_assert(!cmc_perf_available(&perf, cmc_perf_cycles));
+    });
+});
@@ -0,0 +1,234 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <pthread.h>
+
+#include <cmc/persistenttreemap.h>
+
+CMC_GENERATE_PERSISTENT_TREEMAP(ptm, persistenttreemap, size_t, size_t)
+
+/* Height of a subtree, or 0 if it is not a valid AVL tree */
+static size_t persistent_height(struct persistenttreemap_node *node)
+{
+    if (!node)
+        return 1;
+
+    size_t left = persistent_height(node->left);
+    size_t right = persistent_height(node->right);
+
+    if (left == 0 || right == 0 || left > right + 1 || right > left + 1)
+        return 0;
+
+    if (node->left && node->left->key >= node->key)
+        return 0;
+    if (node->right && node->right->key <= node->key)
+        return 0;
+
+    size_t height = (left > right ? left : right) + 1;
+
+    return (size_t)node->height + 1 == height ? height : 0;
+}
+
+struct ptm_worker
+{
+    struct persistenttreemap_snapshot snapshot;
+    size_t errors;
+};
+
+/* Every snapshot was taken with the keys from 0 to count - 1 */
+static void *ptm_worker_read(void *arg)
+{
+    struct ptm_worker *worker = arg;
+
+    size_t count = ptm_snapshot_count(&worker->snapshot);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (ptm_snapshot_get(&worker->snapshot, i) != i)
+            worker->errors++;
+    }
+
+    struct persistenttreemap_iter iter;
+
+    for (ptm_iter_init(&iter, &worker->snapshot); !ptm_iter_end(&iter); ptm_iter_next(&iter))
+    {
+        if (ptm_iter_key(&iter) != ptm_iter_index(&iter))
+            worker->errors++;
+    }
+
+    if (ptm_iter_index(&iter) != count)
+        worker->errors++;
+
+    ptm_snapshot_release(&worker->snapshot);
+
+    return NULL;
+}
+
+CMC_CREATE_UNIT(persistenttreemap_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct persistenttreemap *map = ptm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+        cmc_assert_equals(ptr, NULL, map->root);
+        cmc_assert(ptm_empty(map));
+
+        ptm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct persistenttreemap *map = ptm_new_custom(cmp, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            ptm_insert(map, i, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        ptm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(insert update remove, {
+        struct persistenttreemap *map = ptm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 5000; i++)
+            cmc_assert(ptm_insert(map, (i * 7919) % 5000, i));
+
+        cmc_assert(!ptm_insert(map, 10, 0));
+        cmc_assert_equals(size_t, 5000, ptm_count(map));
+        cmc_assert_not_equals(size_t, 0, persistent_height(map->root));
+
+        size_t old;
+
+        cmc_assert(ptm_update(map, 7919 % 5000, 20, &old));
+        cmc_assert_equals(size_t, 1, old);
+        cmc_assert_equals(size_t, 20, ptm_get(map, 7919 % 5000));
+        cmc_assert(!ptm_update(map, 5000, 0, NULL));
+
+        for (size_t i = 0; i < 5000; i += 2)
+            cmc_assert(ptm_remove(map, i, NULL));
+
+        cmc_assert(!ptm_remove(map, 0, NULL));
+        cmc_assert_equals(size_t, 2500, ptm_count(map));
+        cmc_assert_not_equals(size_t, 0, persistent_height(map->root));
+
+        for (size_t i = 0; i < 5000; i++)
+            cmc_assert_equals(bool, i % 2 == 1, ptm_contains(map, i));
+
+        ptm_clear(map);
+
+        cmc_assert(ptm_empty(map));
+        cmc_assert_equals(ptr, NULL, map->root);
+
+        ptm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(snapshot, {
+        struct persistenttreemap *map = ptm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(ptm_insert(map, i, i));
+
+        struct persistenttreemap_snapshot snapshot1 = ptm_snapshot(map);
+
+        for (size_t i = 0; i < 1000; i += 3)
+            cmc_assert(ptm_remove(map, i, NULL));
+
+        for (size_t i = 1000; i < 2000; i++)
+            cmc_assert(ptm_insert(map, i, i));
+
+        struct persistenttreemap_snapshot snapshot2 = ptm_snapshot(map);
+
+        for (size_t i = 1; i < 2000; i += 3)
+            cmc_assert(ptm_update(map, i, 0, NULL));
+
+        cmc_assert_equals(size_t, 1000, ptm_snapshot_count(&snapshot1));
+        cmc_assert_equals(size_t, 1666, ptm_snapshot_count(&snapshot2));
+        cmc_assert_not_equals(size_t, 0, persistent_height(snapshot1.root));
+        cmc_assert_not_equals(size_t, 0, persistent_height(snapshot2.root));
+        cmc_assert_not_equals(size_t, 0, persistent_height(map->root));
+
+        for (size_t i = 0; i < 2000; i++)
+        {
+            cmc_assert_equals(bool, i < 1000, ptm_snapshot_contains(&snapshot1, i));
+            cmc_assert_equals(bool, i >= 1000 || i % 3 != 0,
+                              ptm_snapshot_contains(&snapshot2, i));
+            cmc_assert_equals(size_t, i < 1000 ? i : 0, ptm_snapshot_get(&snapshot1, i));
+        }
+
+        cmc_assert_equals(size_t, 7, ptm_snapshot_get(&snapshot2, 7));
+        cmc_assert_equals(size_t, 0, ptm_get(map, 7));
+
+        ptm_snapshot_release(&snapshot1);
+
+        cmc_assert_equals(ptr, NULL, snapshot1.root);
+        cmc_assert_equals(size_t, 1666, ptm_snapshot_count(&snapshot2));
+
+        /* The map is freed before the snapshot that uses its nodes */
+        ptm_free(map, NULL);
+
+        struct persistenttreemap_iter iter;
+
+        size_t total = 0;
+
+        for (ptm_iter_init(&iter, &snapshot2); !ptm_iter_end(&iter); ptm_iter_next(&iter))
+        {
+            cmc_assert_equals(size_t, ptm_iter_key(&iter), ptm_iter_value(&iter));
+            total++;
+        }
+
+        cmc_assert_equals(size_t, 1666, total);
+        cmc_assert(!ptm_iter_next(&iter));
+
+        ptm_snapshot_release(&snapshot2);
+        ptm_snapshot_release(&snapshot2);
+    });
+
+    CMC_CREATE_TEST(threads, {
+        struct persistenttreemap *map = ptm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        pthread_t threads[4];
+        struct ptm_worker workers[4];
+
+        for (size_t i = 0; i < 4; i++)
+        {
+            for (size_t j = i * 500; j < (i + 1) * 500; j++)
+                ptm_insert(map, j, j);
+
+            workers[i].snapshot = ptm_snapshot(map);
+            workers[i].errors = 0;
+
+            int result = pthread_create(&threads[i], NULL, ptm_worker_read, &workers[i]);
+
+            cmc_assert_equals(int32_t, 0, result);
+        }
+
+        /* The versions that the readers have are not affected */
+        for (size_t i = 0; i < 2000; i++)
+            ptm_update(map, i, 0, NULL);
+
+        for (size_t i = 0; i < 2000; i += 2)
+            ptm_remove(map, i, NULL);
+
+        for (size_t i = 0; i < 4; i++)
+        {
+            pthread_join(threads[i], NULL);
+
+            cmc_assert_equals(size_t, 0, workers[i].errors);
+        }
+
+        ptm_free(map, NULL);
+    });
+});
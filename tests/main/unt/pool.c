@@ -0,0 +1,195 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <pthread.h>
+
+#include <cmc/skiplistmap.h>
+#include <utl/pool.h>
+
+CMC_GENERATE_SKIPLISTMAP(plsl, pool_skiplistmap, size_t, size_t)
+
+#define POOL_THREADS 4
+#define POOL_PER_THREAD 20000
+
+struct pool_worker
+{
+    struct pool_skiplistmap *map;
+    size_t first;
+    size_t errors;
+};
+
+/* Each worker fills a map, whose nodes are blocks of a few classes, and */
+/* empties half of it, leaving the map to be freed by the main thread */
+static void *pool_worker_run(void *arg)
+{
+    struct pool_worker *worker = arg;
+
+    worker->map = plsl_new_custom(cmp, &cmc_alloc_node_pool);
+
+    if (!worker->map)
+    {
+        worker->errors++;
+        return NULL;
+    }
+
+    for (size_t i = 0; i < POOL_PER_THREAD; i++)
+    {
+        if (!plsl_insert(worker->map, worker->first + i, i))
+            worker->errors++;
+    }
+
+    for (size_t i = 0; i < POOL_PER_THREAD; i += 2)
+    {
+        if (!plsl_remove(worker->map, worker->first + i, NULL))
+            worker->errors++;
+    }
+
+    cmc_pool_flush();
+
+    return NULL;
+}
+
+static size_t pool_sizes[] = { 0, 1, 16, 17, 100, CMC_POOL_MAX_SIZE, CMC_POOL_MAX_SIZE + 1, 5000 };
+
+static size_t pool_depot_batches(size_t size_class)
+{
+    size_t result = 0;
+
+    struct cmc_pool_block *batch = atomic_load(&cmc_pool_depot[size_class]);
+
+    for (; batch; batch = batch->batch)
+        result++;
+
+    return result;
+}
+
+CMC_CREATE_UNIT(pool_test, true, {
+    CMC_CREATE_TEST(malloc[size classes], {
+        for (size_t i = 0; i < sizeof(pool_sizes) / sizeof(pool_sizes[0]); i++)
+        {
+            unsigned char *block = cmc_pool_malloc(pool_sizes[i]);
+
+            cmc_assert_not_equals(ptr, NULL, block);
+            cmc_assert_equals(size_t, 0, (uintptr_t)block % CMC_POOL_HEADER);
+
+            memset(block, 0xff, pool_sizes[i]);
+
+            cmc_pool_free(block);
+
+            /* A freed block is the first one its class hands out */
+            if (pool_sizes[i] <= CMC_POOL_MAX_SIZE)
+                cmc_assert_equals(ptr, block, cmc_pool_malloc(pool_sizes[i]));
+            else
+                block = cmc_pool_malloc(pool_sizes[i]);
+
+            cmc_pool_free(block);
+        }
+
+        cmc_assert_equals(ptr, NULL, cmc_pool_malloc(SIZE_MAX));
+
+        cmc_pool_free(NULL);
+        cmc_pool_flush();
+    });
+
+    CMC_CREATE_TEST(calloc, {
+        unsigned char *block = cmc_pool_malloc(64);
+
+        memset(block, 0xff, 64);
+
+        cmc_pool_free(block);
+
+        unsigned char *zeroed = cmc_pool_calloc(8, 8);
+
+        cmc_assert_equals(ptr, block, zeroed);
+
+        for (size_t i = 0; i < 64; i++)
+            cmc_assert_equals(uint8_t, 0, zeroed[i]);
+
+        cmc_assert_equals(ptr, NULL, cmc_pool_calloc(SIZE_MAX, 2));
+
+        cmc_pool_free(zeroed);
+        cmc_pool_flush();
+    });
+
+    CMC_CREATE_TEST(realloc, {
+        size_t *block = cmc_pool_realloc(NULL, sizeof(size_t) * 2);
+
+        block[0] = 1;
+        block[1] = 2;
+
+        /* Same class */
+        cmc_assert_equals(ptr, block, cmc_pool_realloc(block, sizeof(size_t)));
+
+        block = cmc_pool_realloc(block, sizeof(size_t) * 16);
+
+        cmc_assert_equals(size_t, 1, block[0]);
+        cmc_assert_equals(size_t, 2, block[1]);
+
+        /* From a class to malloc and through it */
+        block = cmc_pool_realloc(block, sizeof(size_t) * 1000);
+
+        cmc_assert_equals(size_t, 2, block[1]);
+
+        block[999] = 3;
+        block = cmc_pool_realloc(block, sizeof(size_t) * 10000);
+
+        cmc_assert_equals(size_t, 2, block[1]);
+        cmc_assert_equals(size_t, 3, block[999]);
+
+        cmc_pool_free(block);
+        cmc_pool_flush();
+    });
+
+    CMC_CREATE_TEST(free[batches go to the depot], {
+        size_t size_class = (48 - 1) / CMC_POOL_GRAIN;
+
+        void *blocks[CMC_POOL_BATCH * 3];
+
+        for (size_t i = 0; i < CMC_POOL_BATCH * 3; i++)
+            blocks[i] = cmc_pool_malloc(48);
+
+        size_t before = pool_depot_batches(size_class);
+
+        /* Twice a full cache keeps one batch and gives one back */
+        for (size_t i = 0; i < CMC_POOL_BATCH * 3; i++)
+            cmc_pool_free(blocks[i]);
+
+        cmc_assert_equals(size_t, before + 2, pool_depot_batches(size_class));
+
+        cmc_pool_flush();
+
+        cmc_assert_equals(size_t, before + 3, pool_depot_batches(size_class));
+        cmc_assert_equals(ptr, NULL, cmc_pool_cache.blocks[size_class]);
+    });
+
+    CMC_CREATE_TEST(threads[freed by another thread], {
+        pthread_t threads[POOL_THREADS];
+        struct pool_worker workers[POOL_THREADS];
+
+        for (size_t i = 0; i < POOL_THREADS; i++)
+        {
+            workers[i] = (struct pool_worker){ 0 };
+            workers[i].first = i * POOL_PER_THREAD;
+
+            cmc_assert_equals(int32_t, 0,
+                              pthread_create(&threads[i], NULL, pool_worker_run, &workers[i]));
+        }
+
+        for (size_t i = 0; i < POOL_THREADS; i++)
+            pthread_join(threads[i], NULL);
+
+        for (size_t i = 0; i < POOL_THREADS; i++)
+        {
+            cmc_assert_equals(size_t, 0, workers[i].errors);
+            cmc_assert_equals(size_t, POOL_PER_THREAD / 2, plsl_count(workers[i].map));
+            cmc_assert(plsl_contains(workers[i].map, workers[i].first + 1));
+            cmc_assert(!plsl_contains(workers[i].map, workers[i].first));
+
+            plsl_free(workers[i].map, NULL);
+        }
+
+        cmc_pool_flush();
+    });
+});
@@ -6,6 +6,12 @@
 #include <cmc/queue.h>
 
 CMC_GENERATE_QUEUE(q, queue, size_t)
+CMC_GENERATE_QUEUE_TRIVIAL(qt, queue_trivial, size_t)
+
+static bool q_is_odd(size_t x)
+{
+    return x % 2 == 1;
+}
 
 CMC_CREATE_UNIT(queue_test, true, {
     CMC_CREATE_TEST(new, {
@@ -20,6 +26,23 @@ CMC_CREATE_UNIT(queue_test, true, {
         q_free(q, NULL);
     });
 
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct queue *q = q_new_custom(100, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, q);
+
+        for (size_t i = 0; i < 1000; i++)
+            q_enqueue(q, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        q_free(q, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
     CMC_CREATE_TEST(new[capacity = 0], {
         struct queue *q = q_new(0);
 
@@ -194,6 +217,115 @@ CMC_CREATE_UNIT(queue_test, true, {
         q_free(q, NULL);
     });
 
+    CMC_CREATE_TEST(enqueue_many and dequeue_many, {
+        struct queue *d = q_new(10);
+
+        cmc_assert_not_equals(ptr, NULL, d);
+
+        size_t elements[300];
+
+        for (size_t i = 0; i < 300; i++)
+            elements[i] = i;
+
+        cmc_assert(!q_enqueue_many(d, elements, 0));
+
+        /* The front is moved so the copies wrap around the buffer */
+        for (size_t i = 0; i < 7; i++)
+            cmc_assert(q_enqueue(d, 1000));
+
+        for (size_t i = 0; i < 7; i++)
+            cmc_assert(q_dequeue(d));
+
+        cmc_assert(q_enqueue_many(d, elements, 8));
+        cmc_assert_equals(size_t, 8, q_count(d));
+
+        for (size_t i = 0; i < 8; i++)
+            cmc_assert_equals(size_t, i, q_get(d, i));
+
+        cmc_assert(q_enqueue_many(d, elements + 8, 292));
+        cmc_assert_equals(size_t, 300, q_count(d));
+
+        for (size_t i = 0; i < 300; i++)
+            cmc_assert_equals(size_t, i, q_get(d, i));
+
+        size_t result[300];
+        size_t *slots[100];
+
+        for (size_t i = 0; i < 100; i++)
+            slots[i] = q_get_ref(d, i);
+
+        cmc_assert_equals(size_t, 100, q_dequeue_many(d, result, 100));
+
+        /* The slots freed are zeroed */
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert_equals(size_t, 0, *slots[i]);
+
+        cmc_assert_equals(size_t, 100, q_peek(d));
+        cmc_assert_equals(size_t, 50, q_dequeue_many(d, NULL, 50));
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert_equals(size_t, i, result[i]);
+
+        cmc_assert_equals(size_t, 150, q_dequeue_many(d, result, 300));
+        cmc_assert(q_empty(d));
+        cmc_assert_equals(size_t, 0, q_dequeue_many(d, result, 1));
+
+        for (size_t i = 0; i < 150; i++)
+            cmc_assert_equals(size_t, i + 150, result[i]);
+
+        q_free(d, NULL);
+    });
+
+    CMC_CREATE_TEST(get and spans, {
+        struct queue *d = q_new(100);
+
+        cmc_assert_not_equals(ptr, NULL, d);
+
+        /* The front ends up at the middle of the buffer */
+        for (size_t i = 0; i < 60; i++)
+            cmc_assert(q_enqueue(d, i));
+
+        for (size_t i = 0; i < 30; i++)
+            cmc_assert(q_dequeue(d));
+
+        for (size_t i = 60; i < 110; i++)
+            cmc_assert(q_enqueue(d, i));
+
+        for (size_t i = 0; i < 80; i++)
+            cmc_assert_equals(size_t, i + 30, q_get(d, i));
+
+        cmc_assert_equals(size_t, 0, q_get(d, 80));
+        cmc_assert_equals(ptr, NULL, q_get_ref(d, 80));
+
+        *q_get_ref(d, 10) = 1000;
+
+        cmc_assert_equals(size_t, 1000, q_get(d, 10));
+
+        size_t *a;
+        size_t *b;
+        size_t a_count;
+        size_t b_count;
+
+        q_spans(d, &a, &a_count, &b, &b_count);
+
+        cmc_assert_equals(size_t, 70, a_count);
+        cmc_assert_equals(size_t, 10, b_count);
+        cmc_assert_equals(ptr, q_get_ref(d, 0), a);
+        cmc_assert_equals(ptr, q_get_ref(d, 70), b);
+
+        /* Without wrapping around there is a single span */
+        for (size_t i = 0; i < 70; i++)
+            cmc_assert(q_dequeue(d));
+
+        q_spans(d, &a, &a_count, &b, &b_count);
+
+        cmc_assert_equals(size_t, 10, a_count);
+        cmc_assert_equals(size_t, 0, b_count);
+        cmc_assert_equals(size_t, 100, a[0]);
+
+        q_free(d, NULL);
+    });
+
     CMC_CREATE_TEST(contains, {
         struct queue *q = q_new(100);
 
@@ -329,6 +461,56 @@ CMC_CREATE_UNIT(queue_test, true, {
         q_free(q, NULL);
     });
 
+    CMC_CREATE_TEST(resize[back], {
+        struct queue *q = q_new(8);
+
+        cmc_assert_not_equals(ptr, NULL, q);
+
+        for (size_t i = 1; i <= 3; i++)
+            cmc_assert(q_enqueue(q, i));
+
+        /* The buffer is left full, so the back wraps around to 0 */
+        cmc_assert(q_shrink_to_fit(q));
+        cmc_assert_equals(size_t, 3, q_capacity(q));
+        cmc_assert_equals(size_t, 0, q->back);
+
+        cmc_assert(q_dequeue(q));
+        cmc_assert(q_enqueue(q, 4));
+
+        for (size_t i = 2; i <= 4; i++)
+        {
+            cmc_assert_equals(size_t, i, q_peek(q));
+            cmc_assert(q_dequeue(q));
+        }
+
+        q_free(q, NULL);
+    });
+
+    CMC_CREATE_TEST(copy_of[back], {
+        struct queue *q1 = q_new(8);
+
+        cmc_assert_not_equals(ptr, NULL, q1);
+
+        for (size_t i = 1; i <= 3; i++)
+            cmc_assert(q_enqueue(q1, i));
+
+        struct queue *q2 = q_copy_of(q1, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, q2);
+
+        /* New elements go after the copied ones */
+        cmc_assert(q_enqueue(q2, 4));
+
+        for (size_t i = 1; i <= 4; i++)
+        {
+            cmc_assert_equals(size_t, i, q_peek(q2));
+            cmc_assert(q_dequeue(q2));
+        }
+
+        q_free(q1, NULL);
+        q_free(q2, NULL);
+    });
+
     CMC_CREATE_TEST(copy_of, {
         struct queue *d1 = q_new(100);
 
@@ -407,4 +589,123 @@ CMC_CREATE_UNIT(queue_test, true, {
         q_free(d1, NULL);
         q_free(d2, NULL);
     });
+
+    CMC_CREATE_TEST(new_from, {
+        size_t elements[100];
+
+        for (size_t i = 0; i < 100; i++)
+            elements[i] = i;
+
+        struct queue *q = q_new_from(elements, 100);
+
+        cmc_assert_not_equals(ptr, NULL, q);
+        cmc_assert_equals(size_t, 100, q_count(q));
+
+        for (size_t i = 0; i < 100; i++)
+        {
+            cmc_assert_equals(size_t, i, q_peek(q));
+            cmc_assert(q_dequeue(q));
+        }
+
+        q_free(q, NULL);
+
+        cmc_assert_equals(ptr, NULL, q_new_from(elements, 0));
+    });
+
+    CMC_CREATE_TEST(to_array[wrapped around], {
+        struct queue *q = q_new(100);
+
+        size_t elements[100] = { 0 };
+
+        cmc_assert_equals(size_t, 0, q_to_array(q, elements, 100));
+
+        for (size_t i = 0; i < 80; i++)
+            q_enqueue(q, i);
+
+        for (size_t i = 0; i < 60; i++)
+            q_dequeue(q);
+
+        for (size_t i = 80; i < 150; i++)
+            q_enqueue(q, i);
+
+        cmc_assert_equals(size_t, 90, q_to_array(q, elements, 100));
+
+        for (size_t i = 0; i < 90; i++)
+            cmc_assert_equals(size_t, i + 60, elements[i]);
+
+        cmc_assert_equals(size_t, 30, q_to_array(q, elements, 30));
+
+        q_free(q, NULL);
+    });
+
+    CMC_CREATE_TEST(trivial, {
+        struct queue_trivial *q = qt_new(100);
+
+        cmc_assert_not_equals(ptr, NULL, q);
+
+        for (size_t i = 1; i <= 80; i++)
+            cmc_assert(qt_enqueue(q, i));
+
+        for (size_t i = 0; i < 30; i++)
+            cmc_assert(qt_dequeue(q));
+
+        // The slots that were freed keep what they had
+        cmc_assert_equals(size_t, 1, q->buffer[0]);
+
+        // Elements that do not wrap around stay where they are
+        cmc_assert(qt_resize(q, 200));
+        cmc_assert_equals(size_t, 30, q->front);
+        cmc_assert_equals(size_t, 80, q->back);
+
+        for (size_t i = 81; i <= 220; i++)
+            cmc_assert(qt_enqueue(q, i));
+
+        cmc_assert_equals(size_t, 20, q->back);
+
+        cmc_assert(qt_resize(q, 400));
+        cmc_assert_equals(size_t, 0, q->front);
+        cmc_assert_equals(size_t, 190, qt_count(q));
+
+        for (size_t i = 0; i < 190; i++)
+            cmc_assert_equals(size_t, i + 31, qt_get(q, i));
+
+        struct queue_trivial *copy = qt_copy_of(q, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, copy);
+        cmc_assert(qt_equals(q, copy, cmp));
+
+        qt_clear(q, NULL);
+
+        cmc_assert(qt_empty(q));
+        cmc_assert(qt_enqueue(q, 10));
+        cmc_assert_equals(size_t, 10, qt_peek(q));
+
+        qt_free(q, NULL);
+        qt_free(copy, NULL);
+    });
+
+    CMC_CREATE_TEST(remove_if[wrapped], {
+        struct queue *q = q_new(100);
+
+        // Half of the elements wrap around the end of the buffer
+        for (size_t i = 0; i < 50; i++)
+            q_enqueue(q, i);
+        for (size_t i = 0; i < 50; i++)
+            q_dequeue(q);
+        for (size_t i = 0; i < 100; i++)
+            q_enqueue(q, i);
+
+        cmc_assert_equals(size_t, 50, q_remove_if(q, q_is_odd, NULL));
+        cmc_assert_equals(size_t, 50, q_count(q));
+        cmc_assert_equals(size_t, 0, q_remove_if(q, q_is_odd, NULL));
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert_equals(size_t, i * 2, q_get(q, i));
+
+        cmc_assert(q_enqueue(q, 100));
+        cmc_assert_equals(size_t, 0, q_peek(q));
+        cmc_assert_equals(size_t, 100, q_get(q, 50));
+
+        q_free(q, NULL);
+    });
 });
@@ -0,0 +1,141 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/radixheap.h>
+
+/* Events ordered by their time */
+struct rh_event
+{
+    uint64_t time;
+    size_t id;
+};
+
+static uint64_t rh_event_time(struct rh_event event)
+{
+    return event.time;
+}
+
+static uint64_t rh_identity(size_t value)
+{
+    return value;
+}
+
+CMC_GENERATE_RADIXHEAP(rh, radixheap, size_t)
+CMC_GENERATE_RADIXHEAP(rhe, radixheap_event, struct rh_event)
+
+CMC_CREATE_UNIT(radixheap_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct radixheap *h = rh_new(rh_identity);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+        cmc_assert(rh_empty(h));
+        cmc_assert_equals(size_t, 0, rh_count(h));
+        cmc_assert_equals(uint64_t, 0, rh_last(h));
+        cmc_assert(!rh_peek(h, NULL));
+        cmc_assert(!rh_remove(h, NULL));
+
+        rh_free(h, NULL);
+
+        cmc_assert_equals(ptr, NULL, rh_new(NULL));
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct radixheap *h = rh_new_custom(rh_identity, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+
+        for (size_t i = 0; i < 1000; i++)
+            rh_insert(h, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        rh_free(h, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(insert remove, {
+        struct radixheap *h = rh_new(rh_identity);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+
+        for (size_t i = 0; i < 5000; i++)
+            cmc_assert(rh_insert(h, (i * 7919) % 5000 + 100));
+
+        cmc_assert_equals(size_t, 5000, rh_count(h));
+
+        size_t value;
+
+        cmc_assert(rh_peek(h, &value));
+        cmc_assert_equals(size_t, 100, value);
+        cmc_assert_equals(uint64_t, 100, rh_last(h));
+
+        for (size_t i = 0; i < 5000; i++)
+        {
+            cmc_assert(rh_remove(h, &value));
+            cmc_assert_equals(size_t, i + 100, value);
+        }
+
+        cmc_assert(rh_empty(h));
+
+        /* Nothing below the last key removed can be inserted */
+        cmc_assert(!rh_insert(h, 5098));
+        cmc_assert(rh_insert(h, 5099));
+        cmc_assert(rh_insert(h, UINT64_MAX));
+        cmc_assert(rh_remove(h, &value));
+        cmc_assert_equals(size_t, 5099, value);
+        cmc_assert(rh_remove(h, &value));
+        cmc_assert_equals(size_t, UINT64_MAX, value);
+
+        rh_clear(h, NULL);
+
+        cmc_assert_equals(uint64_t, 0, rh_last(h));
+        cmc_assert(rh_insert(h, 0));
+
+        rh_free(h, NULL);
+    });
+
+    CMC_CREATE_TEST(scheduler, {
+        struct radixheap_event *h = rhe_new(rh_event_time);
+
+        cmc_assert_not_equals(ptr, NULL, h);
+
+        size_t x = 1;
+        size_t next_id = 0;
+        uint64_t now = 0;
+
+        /* Each event handled schedules up to two more in the future */
+        struct rh_event event;
+
+        event.time = 0;
+        event.id = next_id++;
+
+        cmc_assert(rhe_insert(h, event));
+
+        while (next_id < 20000 || !rhe_empty(h))
+        {
+            cmc_assert(rhe_remove(h, &event));
+            cmc_assert(event.time >= now);
+
+            now = event.time;
+
+            for (size_t i = 0; i < 2 && next_id < 20000; i++)
+            {
+                x = x * 6364136223846793005u + 1442695040888963407u;
+
+                event.time = now + (x >> 40);
+                event.id = next_id++;
+
+                cmc_assert(rhe_insert(h, event));
+            }
+        }
+
+        cmc_assert_equals(size_t, 20000, next_id);
+
+        rhe_free(h, NULL);
+    });
+});
@@ -0,0 +1,344 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/radixtreemap.h>
+
+CMC_GENERATE_RADIXTREEMAP(rtm, radixtreemap, size_t)
+
+#define RADIX_KEYS 3000
+
+/* Keys of every length up to 40, over a few bytes so that they share long */
+/* prefixes, with some ending where others go on */
+static size_t radix_key(size_t seed, char *key)
+{
+    size_t length = (seed * 2654435761u) % 41;
+    size_t state = seed;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        state = state * 6364136223846793005u + 1442695040888963407u;
+        key[i] = "ab\0\xff"[(state >> 60) % 4];
+    }
+
+    return length;
+}
+
+static bool radix_ordered(struct radixtreemap *map)
+{
+    struct radixtreemap_iter iter;
+    const char *last = NULL;
+    size_t last_length = 0;
+    size_t count = 0;
+
+    for (rtm_iter_init(&iter, map); !rtm_iter_end(&iter); rtm_iter_next(&iter))
+    {
+        size_t length;
+        const char *key = rtm_iter_key(&iter, &length);
+
+        if (last && cmc_radix_compare((const uint8_t *)last, last_length, (const uint8_t *)key,
+                                      length) >= 0)
+            return false;
+
+        last = key;
+        last_length = length;
+        count++;
+    }
+
+    return count == rtm_count(map);
+}
+
+CMC_CREATE_UNIT(radixtreemap_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct radixtreemap *map = rtm_new();
+
+        cmc_assert_not_equals(ptr, NULL, map);
+        cmc_assert(rtm_empty(map));
+        cmc_assert(!rtm_contains(map, "", 0));
+
+        rtm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(insert get remove, {
+        struct radixtreemap *map = rtm_new();
+
+        cmc_assert(rtm_insert(map, "romane", 6, 1));
+        cmc_assert(rtm_insert(map, "romanus", 7, 2));
+        cmc_assert(rtm_insert(map, "romulus", 7, 3));
+        cmc_assert(rtm_insert(map, "rubens", 6, 4));
+        cmc_assert(rtm_insert(map, "ruber", 5, 5));
+        cmc_assert(rtm_insert(map, "rubicon", 7, 6));
+        cmc_assert(rtm_insert(map, "rubicundus", 10, 7));
+        cmc_assert(rtm_insert(map, "rom", 3, 8));
+        cmc_assert(rtm_insert(map, "", 0, 9));
+        cmc_assert(!rtm_insert(map, "ruber", 5, 10));
+        cmc_assert_equals(size_t, 9, rtm_count(map));
+
+        cmc_assert_equals(size_t, 5, rtm_get(map, "ruber", 5));
+        cmc_assert_equals(size_t, 8, rtm_get(map, "rom", 3));
+        cmc_assert_equals(size_t, 9, rtm_get(map, "", 0));
+        cmc_assert(!rtm_contains(map, "ro", 2));
+        cmc_assert(!rtm_contains(map, "roman", 5));
+        cmc_assert(!rtm_contains(map, "romanes", 7));
+        cmc_assert(!rtm_contains(map, "rubicon", 6));
+
+        // Only the given length of the key is used
+        cmc_assert(rtm_contains(map, "rubiconxyz", 7));
+
+        size_t old = 0;
+
+        cmc_assert(rtm_update(map, "rom", 3, 80, &old));
+        cmc_assert_equals(size_t, 8, old);
+        cmc_assert(!rtm_update(map, "ro", 2, 1, NULL));
+
+        size_t *ref = rtm_get_or_insert(map, "rubicundus", 10, 0);
+
+        cmc_assert_not_equals(ptr, NULL, ref);
+        *ref += 1;
+        cmc_assert_equals(size_t, 8, rtm_get(map, "rubicundus", 10));
+
+        ref = rtm_get_or_insert(map, "rub", 3, 100);
+
+        cmc_assert_equals(size_t, 100, *ref);
+        cmc_assert_equals(size_t, 10, rtm_count(map));
+        cmc_assert(radix_ordered(map));
+
+        const char *key = NULL;
+        size_t length = 0;
+
+        cmc_assert(rtm_min(map, &key, &length, NULL));
+        cmc_assert_equals(size_t, 0, length);
+        cmc_assert(rtm_max(map, &key, &length, NULL));
+        cmc_assert(strcmp(key, "rubicundus") == 0);
+
+        size_t out = 0;
+
+        cmc_assert(rtm_remove(map, "rom", 3, &out));
+        cmc_assert_equals(size_t, 80, out);
+        cmc_assert(!rtm_remove(map, "rom", 3, NULL));
+        cmc_assert(!rtm_remove(map, "romanu", 6, NULL));
+        cmc_assert(rtm_contains(map, "romanus", 7));
+        cmc_assert(rtm_remove(map, "", 0, NULL));
+        cmc_assert(rtm_remove(map, "romulus", 7, NULL));
+        cmc_assert(rtm_contains(map, "romane", 6));
+        cmc_assert_equals(size_t, 7, rtm_count(map));
+        cmc_assert(radix_ordered(map));
+
+        rtm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(node layouts, {
+        count_alloc_reset();
+
+        struct radixtreemap *map = rtm_new_custom(&count_alloc);
+        char key[2];
+
+        key[0] = 'k';
+
+        // Grows a node through every layout and back down
+        for (size_t i = 0; i < 256; i++)
+        {
+            key[1] = (char)(255 - i);
+            cmc_assert(rtm_insert(map, key, 2, i));
+        }
+
+        cmc_assert_equals(size_t, CMC_RADIX_NODE256, (size_t)((struct cmc_radix_node *)map->root)->type);
+        cmc_assert(radix_ordered(map));
+
+        for (size_t i = 0; i < 256; i++)
+        {
+            key[1] = (char)(255 - i);
+            cmc_assert_equals(size_t, i, rtm_get(map, key, 2));
+        }
+
+        for (size_t i = 0; i < 254; i++)
+        {
+            key[1] = (char)(i * 7 % 256);
+
+            // The multiples of 7 modulo 256 go through every byte
+            cmc_assert(rtm_remove(map, key, 2, NULL));
+        }
+
+        cmc_assert_equals(size_t, CMC_RADIX_NODE4, (size_t)((struct cmc_radix_node *)map->root)->type);
+        cmc_assert_equals(size_t, 2, rtm_count(map));
+        cmc_assert(radix_ordered(map));
+
+        rtm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(long prefixes, {
+        count_alloc_reset();
+
+        struct radixtreemap *map = rtm_new_custom(&count_alloc);
+        char key[100];
+
+        memset(key, 'x', sizeof(key));
+
+        // Prefixes longer than a node holds are split in a chain of nodes
+        cmc_assert(rtm_insert(map, key, 100, 1));
+        cmc_assert(rtm_insert(map, key, 60, 2));
+        cmc_assert(rtm_insert(map, key, 30, 3));
+
+        key[50] = 'y';
+
+        cmc_assert(rtm_insert(map, key, 100, 4));
+        cmc_assert(rtm_insert(map, key, 51, 5));
+        cmc_assert_equals(size_t, 5, rtm_count(map));
+        cmc_assert_equals(size_t, 4, rtm_get(map, key, 100));
+        cmc_assert(!rtm_contains(map, key, 99));
+        cmc_assert(radix_ordered(map));
+
+        key[50] = 'x';
+
+        cmc_assert_equals(size_t, 2, rtm_get(map, key, 60));
+        cmc_assert(rtm_remove(map, key, 60, NULL));
+        cmc_assert(rtm_remove(map, key, 100, NULL));
+        cmc_assert_equals(size_t, 3, rtm_get(map, key, 30));
+
+        key[50] = 'y';
+
+        cmc_assert(rtm_remove(map, key, 51, NULL));
+        cmc_assert(rtm_remove(map, key, 100, NULL));
+
+        key[50] = 'x';
+
+        // A single key is left as the root
+        cmc_assert(CMC_RADIX_IS_LEAF(map->root));
+        cmc_assert(rtm_remove(map, key, 30, NULL));
+        cmc_assert_equals(ptr, NULL, map->root);
+        cmc_assert_equals(size_t, 1, count_alloc_live);
+
+        rtm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(prefix_iter, {
+        struct radixtreemap *map = rtm_new();
+        const char *words[8];
+
+        words[0] = "car";
+        words[1] = "card";
+        words[2] = "care";
+        words[3] = "careful";
+        words[4] = "cart";
+        words[5] = "cat";
+        words[6] = "dog";
+        words[7] = "ca";
+
+        for (size_t i = 0; i < 8; i++)
+            rtm_insert(map, words[i], strlen(words[i]), i);
+
+        struct radixtreemap_iter iter = rtm_prefix_iter(map, "car", 3);
+        size_t count = 0;
+        size_t length = 0;
+
+        for (; !rtm_iter_end(&iter); rtm_iter_next(&iter))
+        {
+            const char *key = rtm_iter_key(&iter, &length);
+
+            cmc_assert(strncmp(key, "car", 3) == 0);
+            count++;
+        }
+
+        cmc_assert_equals(size_t, 5, count);
+
+        rtm_iter_to_end(&iter);
+
+        cmc_assert_equals(size_t, 4, rtm_iter_index(&iter));
+        cmc_assert(strcmp(rtm_iter_key(&iter, NULL), "cart") == 0);
+        cmc_assert(rtm_iter_prev(&iter));
+        cmc_assert(strcmp(rtm_iter_key(&iter, NULL), "careful") == 0);
+
+        // Prefixes that end inside a node, at a leaf, or match nothing
+        iter = rtm_prefix_iter(map, "care", 4);
+        cmc_assert(strcmp(rtm_iter_key(&iter, NULL), "care") == 0);
+
+        iter = rtm_prefix_iter(map, "caref", 5);
+        cmc_assert(strcmp(rtm_iter_key(&iter, NULL), "careful") == 0);
+        cmc_assert(!rtm_iter_next(&iter));
+
+        iter = rtm_prefix_iter(map, "d", 1);
+        cmc_assert_equals(size_t, 6, rtm_iter_value(&iter));
+
+        iter = rtm_prefix_iter(map, "cab", 3);
+        cmc_assert(rtm_iter_end(&iter));
+        cmc_assert(rtm_iter_start(&iter));
+
+        iter = rtm_prefix_iter(map, "carefully", 9);
+        cmc_assert(rtm_iter_end(&iter));
+
+        iter = rtm_prefix_iter(map, "", 0);
+        rtm_iter_to_end(&iter);
+        cmc_assert_equals(size_t, 7, rtm_iter_index(&iter));
+
+        rtm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(random keys, {
+        count_alloc_reset();
+
+        struct radixtreemap *map = rtm_new_custom(&count_alloc);
+        static char keys[RADIX_KEYS][40];
+        static size_t lengths[RADIX_KEYS];
+        static bool present[RADIX_KEYS];
+        size_t count = 0;
+
+        for (size_t i = 0; i < RADIX_KEYS; i++)
+        {
+            lengths[i] = radix_key(i, keys[i]);
+
+            // Keys that were generated before are not inserted again
+            present[i] = rtm_insert(map, keys[i], lengths[i], i);
+            count += present[i];
+        }
+
+        cmc_assert_equals(size_t, count, rtm_count(map));
+        cmc_assert(radix_ordered(map));
+
+        struct radixtreemap *copy = rtm_copy_of(map, NULL);
+
+        cmc_assert(rtm_equals(map, copy, NULL));
+
+        bool found = true;
+
+        for (size_t i = 0; i < RADIX_KEYS; i++)
+        {
+            size_t *value = rtm_get_ref(map, keys[i], lengths[i]);
+
+            found = found && value && (!present[i] || *value == i);
+        }
+
+        cmc_assert(found);
+
+        // Removes every other key that was inserted
+        for (size_t i = 0; i < RADIX_KEYS; i += 2)
+        {
+            if (present[i])
+            {
+                cmc_assert(rtm_remove(map, keys[i], lengths[i], NULL));
+                count--;
+            }
+        }
+
+        cmc_assert_equals(size_t, count, rtm_count(map));
+        cmc_assert(radix_ordered(map));
+        cmc_assert(!rtm_equals(map, copy, NULL));
+
+        found = true;
+
+        for (size_t i = 1; i < RADIX_KEYS; i += 2)
+            found = found && (!present[i] || rtm_get(map, keys[i], lengths[i]) == i);
+
+        cmc_assert(found);
+        cmc_assert_greater(size_t, rtm_memory_usage(map), rtm_memory_usage(copy));
+
+        rtm_free(copy, NULL);
+        rtm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+});
@@ -0,0 +1,225 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/hashmap.h>
+#include <cmc/sortedlist.h>
+#include <utl/replica.h>
+
+CMC_GENERATE_HASHMAP(rph, replica_hashmap, size_t, size_t)
+CMC_GENERATE_SORTEDLIST(rps, replica_sortedlist, size_t)
+
+CMC_GENERATE_REPLICA(rph, replica_hashmap)
+CMC_GENERATE_REPLICA(rps, replica_sortedlist)
+
+static size_t rp_copies = 0;
+
+static struct replica_hashmap *rph_copy(struct replica_hashmap *map)
+{
+    rp_copies++;
+
+    return rph_copy_of(map, NULL, NULL);
+}
+
+static void rph_release(struct replica_hashmap *map)
+{
+    rph_free(map, NULL);
+}
+
+static struct replica_sortedlist *rps_copy(struct replica_sortedlist *list)
+{
+    return rps_copy_of(list, NULL);
+}
+
+static void rps_release(struct replica_sortedlist *list)
+{
+    rps_free(list, NULL);
+}
+
+struct rp_worker
+{
+    struct replica_hashmap_replica *replica;
+    bool consistent;
+};
+
+static void *rp_worker_read(void *arg)
+{
+    struct rp_worker *worker = arg;
+
+    size_t reader = rph_replica_register(worker->replica);
+
+    /* Every published map has the same value for all of its keys */
+    for (size_t i = 0; i < 2000; i++)
+    {
+        struct replica_hashmap *map = rph_replica_enter(worker->replica, reader);
+
+        size_t first = rph_get(map, 0);
+
+        for (size_t j = 1; j < 100; j++)
+        {
+            if (rph_get(map, j) != first)
+                worker->consistent = false;
+        }
+
+        rph_replica_leave(worker->replica, reader);
+    }
+
+    rph_replica_unregister(worker->replica, reader);
+
+    return NULL;
+}
+
+CMC_CREATE_UNIT(replica_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct replica_hashmap *map = rph_new(100, 0.6, cmp, hash);
+
+        for (size_t i = 0; i < 100; i++)
+            rph_insert(map, i, i * 2);
+
+        rp_copies = 0;
+
+        struct replica_hashmap_replica *replica = rph_replica_new(map, rph_copy, rph_release);
+
+        cmc_assert_not_equals(ptr, NULL, replica);
+        cmc_assert_greater_equals(size_t, 1, rph_replica_nodes(replica));
+        cmc_assert_equals(size_t, rph_replica_nodes(replica), rp_copies);
+
+        size_t reader = rph_replica_register(replica);
+
+        cmc_assert_lesser(size_t, CMC_REPLICA_READERS, reader);
+
+        struct replica_hashmap *copy = rph_replica_enter(replica, reader);
+
+        cmc_assert_not_equals(ptr, map, copy);
+        cmc_assert_equals(size_t, 100, rph_count(copy));
+        cmc_assert_equals(size_t, 20, rph_get(copy, 10));
+
+        rph_replica_leave(replica, reader);
+        rph_replica_unregister(replica, reader);
+
+        rph_replica_free(replica);
+        rph_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct replica_sortedlist *list = rps_new(100, cmp);
+
+        for (size_t i = 0; i < 1000; i++)
+            rps_insert(list, 999 - i);
+
+        struct replica_sortedlist_replica *replica =
+            rps_replica_new_custom(list, rps_copy, rps_release, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, replica);
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        rps_replica_free(replica);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+
+        rps_free(list, NULL);
+    });
+
+    CMC_CREATE_TEST(register[full], {
+        struct replica_sortedlist *list = rps_new(100, cmp);
+        struct replica_sortedlist_replica *replica =
+            rps_replica_new(list, rps_copy, rps_release);
+
+        for (size_t i = 0; i < CMC_REPLICA_READERS; i++)
+            cmc_assert_equals(size_t, i, rps_replica_register(replica));
+
+        cmc_assert_equals(size_t, CMC_REPLICA_READERS, rps_replica_register(replica));
+
+        rps_replica_unregister(replica, 5);
+
+        cmc_assert_equals(size_t, 5, rps_replica_register(replica));
+
+        rps_replica_free(replica);
+        rps_free(list, NULL);
+    });
+
+    CMC_CREATE_TEST(publish, {
+        struct replica_sortedlist *list = rps_new(100, cmp);
+
+        for (size_t i = 0; i < 100; i++)
+            rps_insert(list, i);
+
+        struct replica_sortedlist_replica *replica =
+            rps_replica_new(list, rps_copy, rps_release);
+
+        size_t reader = rps_replica_register(replica);
+
+        struct replica_sortedlist *copy = rps_replica_enter(replica, reader);
+
+        cmc_assert_equals(size_t, 100, rps_count(copy));
+
+        rps_replica_leave(replica, reader);
+
+        // The source can change after it was published
+        for (size_t i = 100; i < 200; i++)
+            rps_insert(list, i);
+
+        copy = rps_replica_enter(replica, reader);
+
+        cmc_assert_equals(size_t, 100, rps_count(copy));
+
+        rps_replica_leave(replica, reader);
+
+        cmc_assert(rps_replica_publish(replica, list));
+
+        copy = rps_replica_enter(replica, reader);
+
+        cmc_assert_equals(size_t, 200, rps_count(copy));
+        cmc_assert(rps_contains(copy, 150));
+
+        rps_replica_leave(replica, reader);
+
+        rps_replica_free(replica);
+        rps_free(list, NULL);
+    });
+
+    CMC_CREATE_TEST(threads, {
+        struct replica_hashmap *map = rph_new(100, 0.6, cmp, hash);
+
+        for (size_t i = 0; i < 100; i++)
+            rph_insert(map, i, 0);
+
+        struct replica_hashmap_replica *replica = rph_replica_new(map, rph_copy, rph_release);
+
+        cmc_assert_not_equals(ptr, NULL, replica);
+
+        pthread_t threads[4];
+        struct rp_worker workers[4];
+
+        for (size_t i = 0; i < 4; i++)
+        {
+            workers[i].replica = replica;
+            workers[i].consistent = true;
+
+            int result = pthread_create(&threads[i], NULL, rp_worker_read, &workers[i]);
+
+            cmc_assert_equals(int32_t, 0, result);
+        }
+
+        // Readers never see a map that is only partly updated
+        for (size_t v = 1; v <= 20; v++)
+        {
+            for (size_t i = 0; i < 100; i++)
+                rph_update(map, i, v, NULL);
+
+            cmc_assert(rph_replica_publish(replica, map));
+        }
+
+        for (size_t i = 0; i < 4; i++)
+        {
+            pthread_join(threads[i], NULL);
+            cmc_assert(workers[i].consistent);
+        }
+
+        rph_replica_free(replica);
+        rph_free(map, NULL);
+    });
+});
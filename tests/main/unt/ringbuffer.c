@@ -0,0 +1,202 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/ringbuffer.h>
+
+CMC_GENERATE_RINGBUFFER_NUMERIC(rgb, ringbuffer, size_t, size_t)
+CMC_GENERATE_RINGBUFFER_NUMERIC(rgbd, ringbuffer_double, double, double)
+
+CMC_CREATE_UNIT(ringbuffer_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct ringbuffer *r = rgb_new(100);
+
+        cmc_assert_not_equals(ptr, NULL, r);
+        cmc_assert_equals(size_t, 100, rgb_window(r));
+        cmc_assert_equals(size_t, 128, r->capacity);
+        cmc_assert_equals(size_t, 0, (uintptr_t)r->buffer % CMC_CACHE_LINE_SIZE);
+        cmc_assert(rgb_empty(r));
+
+        rgb_free(r, NULL);
+
+        cmc_assert_equals(ptr, NULL, rgb_new(0));
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct ringbuffer *r = rgb_new_custom(10, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, r);
+
+        for (size_t i = 0; i < 1000; i++)
+            rgb_push(r, i, NULL);
+
+        // Pushing never allocates
+        cmc_assert_equals(size_t, 2, count_alloc_live);
+
+        rgb_free(r, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(push overwrite, {
+        struct ringbuffer *r = rgb_new(5);
+        size_t evicted = 0;
+
+        for (size_t i = 0; i < 5; i++)
+            cmc_assert(!rgb_push(r, i, &evicted));
+
+        cmc_assert(rgb_full(r));
+        cmc_assert(rgb_push(r, 5, &evicted));
+        cmc_assert_equals(size_t, 0, evicted);
+        cmc_assert(rgb_push(r, 6, &evicted));
+        cmc_assert_equals(size_t, 1, evicted);
+
+        cmc_assert_equals(size_t, 5, rgb_count(r));
+        cmc_assert_equals(size_t, 7, rgb_pushed(r));
+        cmc_assert_equals(size_t, 2, rgb_get(r, 0));
+        cmc_assert_equals(size_t, 6, rgb_get(r, 4));
+        cmc_assert_equals(size_t, 6, rgb_get_newest(r, 0));
+        cmc_assert_equals(size_t, 2, rgb_get_newest(r, 4));
+        cmc_assert_equals(size_t, 0, rgb_get(r, 5));
+        cmc_assert_equals(ptr, NULL, rgb_get_ref(r, 5));
+
+        cmc_assert(rgb_pop_oldest(r));
+        cmc_assert_equals(size_t, 3, rgb_get(r, 0));
+        cmc_assert_equals(size_t, 4, rgb_count(r));
+
+        rgb_clear(r, NULL);
+
+        cmc_assert(rgb_empty(r));
+        cmc_assert(!rgb_pop_oldest(r));
+
+        rgb_free(r, NULL);
+    });
+
+    CMC_CREATE_TEST(push_many spans, {
+        struct ringbuffer *r = rgb_new(6);
+        size_t elements[20];
+
+        for (size_t i = 0; i < 20; i++)
+            elements[i] = i;
+
+        cmc_assert_equals(size_t, 0, rgb_push_many(r, elements, 4));
+        cmc_assert_equals(size_t, 2, rgb_push_many(r, elements + 4, 4));
+        cmc_assert_equals(size_t, 6, rgb_count(r));
+
+        // 2 to 7, wrapping around the buffer of 8
+        for (size_t i = 0; i < 6; i++)
+            cmc_assert_equals(size_t, i + 2, rgb_get(r, i));
+
+        size_t *a;
+        size_t *b;
+        size_t a_count;
+        size_t b_count;
+
+        rgb_spans(r, &a, &a_count, &b, &b_count);
+
+        cmc_assert_equals(size_t, 6, a_count + b_count);
+        cmc_assert_equals(size_t, 2, a[0]);
+        cmc_assert_equals(size_t, 7, a_count == 6 ? a[5] : b[b_count - 1]);
+
+        rgb_newest_spans(r, 2, &a, &a_count, &b, &b_count);
+
+        cmc_assert_equals(size_t, 2, a_count + b_count);
+        cmc_assert_equals(size_t, 6, a[0]);
+
+        // More than a window keeps only the last ones
+        cmc_assert_equals(size_t, 20, rgb_push_many(r, elements, 20));
+        cmc_assert_equals(size_t, 14, rgb_get(r, 0));
+        cmc_assert_equals(size_t, 19, rgb_get_newest(r, 0));
+
+        size_t array[10];
+
+        cmc_assert_equals(size_t, 6, rgb_to_array(r, array, 10));
+        cmc_assert_equals(size_t, 14, array[0]);
+        cmc_assert_equals(size_t, 19, array[5]);
+        cmc_assert_equals(size_t, 3, rgb_to_array(r, array, 3));
+        cmc_assert_equals(size_t, 16, array[2]);
+
+        rgb_free(r, NULL);
+    });
+
+    CMC_CREATE_TEST(sum min max, {
+        struct ringbuffer *r = rgb_new(100);
+        size_t value = 0;
+
+        cmc_assert(!rgb_min(r, 100, &value));
+        cmc_assert_equals(size_t, 0, rgb_sum(r, 100));
+
+        for (size_t i = 1; i <= 250; i++)
+            rgb_push(r, (i * 37) % 251, NULL);
+
+        size_t sum = 0;
+        size_t min = SIZE_MAX;
+        size_t max = 0;
+
+        for (size_t i = 0; i < 100; i++)
+        {
+            size_t v = rgb_get(r, i);
+
+            sum += v;
+            min = v < min ? v : min;
+            max = v > max ? v : max;
+        }
+
+        cmc_assert_equals(size_t, sum, rgb_sum(r, 100));
+        cmc_assert_equals(size_t, sum, rgb_sum(r, 1000));
+        cmc_assert(rgb_min(r, 100, &value));
+        cmc_assert_equals(size_t, min, value);
+        cmc_assert(rgb_max(r, 100, &value));
+        cmc_assert_equals(size_t, max, value);
+
+        size_t newest = rgb_get_newest(r, 0) + rgb_get_newest(r, 1) + rgb_get_newest(r, 2);
+
+        cmc_assert_equals(size_t, newest, rgb_sum(r, 3));
+
+        rgb_free(r, NULL);
+
+        struct ringbuffer_double *d = rgbd_new(4);
+        double dv = 0;
+
+        for (size_t i = 0; i < 10; i++)
+            rgbd_push(d, (double)i * 0.5, NULL);
+
+        cmc_assert(rgbd_mean(d, 4) == 3.75);
+        cmc_assert(rgbd_min(d, 4, &dv) && dv == 3.0);
+        cmc_assert(rgbd_max(d, 2, &dv) && dv == 4.5);
+
+        rgbd_free(d, NULL);
+    });
+
+    CMC_CREATE_TEST(iteration, {
+        struct ringbuffer *r = rgb_new(3);
+        struct ringbuffer_iter iter;
+
+        rgb_iter_init(&iter, r);
+
+        cmc_assert(rgb_iter_end(&iter));
+
+        for (size_t i = 0; i < 5; i++)
+            rgb_push(r, i, NULL);
+
+        size_t expected = 2;
+        bool ordered = true;
+
+        for (rgb_iter_init(&iter, r); !rgb_iter_end(&iter); rgb_iter_next(&iter))
+            ordered = ordered && rgb_iter_value(&iter) == expected++;
+
+        cmc_assert(ordered);
+        cmc_assert_equals(size_t, 5, expected);
+
+        for (rgb_iter_to_end(&iter); !rgb_iter_start(&iter); rgb_iter_prev(&iter))
+            ordered = ordered && *rgb_iter_rvalue(&iter) == --expected;
+
+        cmc_assert(ordered);
+        cmc_assert_equals(size_t, 2, expected);
+
+        rgb_free(r, NULL);
+    });
+});
@@ -0,0 +1,395 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/roaring.h>
+
+CMC_GENERATE_ROARING(rb, roaring, size_t)
+
+/* Elements of a reference set kept as one bool per element, spread over */
+/* four chunks of 65536 so that containers of each type are made */
+#define ROARING_UNIVERSE (65536 * 4)
+
+/* The first chunk is sparse, the second dense, the third has long runs */
+/* and the last is empty */
+static bool roaring_pick(size_t i, size_t seed)
+{
+    size_t low = i % 65536;
+
+    if (i < 65536)
+        return (low * 2654435761u + seed) % 97 == 0;
+    else if (i < 65536 * 2)
+        return (low * 2654435761u + seed) % 3 != 0;
+    else if (i < 65536 * 3)
+        return (low + seed * 100) % 1000 < 400;
+
+    return false;
+}
+
+static struct roaring *roaring_random(bool *reference, size_t seed)
+{
+    struct roaring *set = rb_new();
+
+    for (size_t i = 0; i < ROARING_UNIVERSE; i++)
+    {
+        reference[i] = roaring_pick(i, seed);
+
+        if (reference[i])
+            rb_insert(set, i);
+    }
+
+    return set;
+}
+
+static bool roaring_matches(struct roaring *set, bool *reference)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < ROARING_UNIVERSE; i++)
+    {
+        if (rb_contains(set, i) != reference[i])
+            return false;
+
+        count += reference[i];
+    }
+
+    return rb_count(set) == count;
+}
+
+static bool roaring_has_type(struct roaring *set, uint16_t type)
+{
+    for (size_t i = 0; i < set->length; i++)
+    {
+        if (set->containers[i].type == type)
+            return true;
+    }
+
+    return false;
+}
+
+static bool reference_a[ROARING_UNIVERSE];
+static bool reference_b[ROARING_UNIVERSE];
+static bool expected[ROARING_UNIVERSE];
+
+CMC_CREATE_UNIT(roaring_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct roaring *set = rb_new();
+
+        cmc_assert_not_equals(ptr, NULL, set);
+        cmc_assert(rb_empty(set));
+        cmc_assert_equals(size_t, 0, set->length);
+
+        rb_free(set);
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct roaring *set = rb_new_custom(&count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 0; i < 1000000; i += 7)
+            rb_insert(set, i);
+
+        rb_run_optimize(set);
+
+        struct roaring *copy = rb_copy_of(set);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        rb_free(copy);
+        rb_free(set);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(insert remove contains, {
+        struct roaring *set = rb_new();
+
+        cmc_assert(rb_insert(set, 0));
+        cmc_assert(rb_insert(set, 65535));
+        cmc_assert(rb_insert(set, 65536));
+        cmc_assert(rb_insert(set, UINT32_MAX));
+        cmc_assert(!rb_insert(set, 65535));
+        cmc_assert_equals(size_t, 4, rb_count(set));
+        cmc_assert_equals(size_t, 3, set->length);
+
+        // Elements that don't fit in 32 bits
+        cmc_assert(!rb_insert(set, (size_t)UINT32_MAX + 1));
+        cmc_assert(!rb_contains(set, (size_t)UINT32_MAX + 1));
+
+        cmc_assert(rb_contains(set, UINT32_MAX));
+        cmc_assert(!rb_contains(set, 1));
+
+        cmc_assert(rb_remove(set, 65536));
+        cmc_assert(!rb_remove(set, 65536));
+        cmc_assert(!rb_remove(set, 7000000));
+        cmc_assert_equals(size_t, 3, rb_count(set));
+        cmc_assert_equals(size_t, 2, set->length);
+
+        // An array becomes a bitmap past 4096 elements and back when half
+        for (size_t i = 0; i < 5000; i++)
+            rb_insert(set, 200000 + i * 2);
+
+        cmc_assert(roaring_has_type(set, CMC_ROARING_BITMAP));
+
+        for (size_t i = 0; i < 3000; i++)
+            cmc_assert(rb_remove(set, 200000 + i * 2));
+
+        cmc_assert(!roaring_has_type(set, CMC_ROARING_BITMAP));
+        cmc_assert(rb_contains(set, 200000 + 4999 * 2));
+        cmc_assert(!rb_contains(set, 200000 + 2999 * 2));
+        cmc_assert_equals(size_t, 2003, rb_count(set));
+
+        size_t elements[5];
+
+        // 1, 2, 3 and again 1, plus 0 which was already there
+        for (size_t i = 0; i < 4; i++)
+            elements[i] = i % 3 + 1;
+
+        elements[4] = 0;
+
+        cmc_assert_equals(size_t, 3, rb_insert_many(set, elements, 5));
+
+        rb_clear(set);
+
+        cmc_assert(rb_empty(set));
+        cmc_assert(!rb_contains(set, 0));
+
+        rb_free(set);
+    });
+
+    CMC_CREATE_TEST(min max, {
+        struct roaring *set = rb_new();
+        size_t value = 0;
+
+        cmc_assert(!rb_min(set, &value));
+        cmc_assert(!rb_max(set, &value));
+
+        rb_insert(set, 700000);
+        rb_insert(set, 129);
+        rb_insert(set, 4000000000u);
+
+        cmc_assert(rb_min(set, &value));
+        cmc_assert_equals(size_t, 129, value);
+        cmc_assert(rb_max(set, &value));
+        cmc_assert_equals(size_t, 4000000000u, value);
+
+        rb_free(set);
+    });
+
+    CMC_CREATE_TEST(iteration, {
+        struct roaring *set = roaring_random(reference_a, 3);
+
+        // Iterates through containers of each type
+        cmc_assert(rb_run_optimize(set));
+        cmc_assert(roaring_has_type(set, CMC_ROARING_ARRAY));
+        cmc_assert(roaring_has_type(set, CMC_ROARING_BITMAP));
+        cmc_assert(roaring_has_type(set, CMC_ROARING_RUN));
+
+        size_t index = 0;
+        size_t last = 0;
+        bool sorted = true;
+        bool present = true;
+
+        struct roaring_iter iter;
+
+        for (rb_iter_init(&iter, set); !rb_iter_end(&iter); rb_iter_next(&iter))
+        {
+            size_t value = rb_iter_value(&iter);
+
+            sorted = sorted && (index == 0 || value > last);
+            present = present && reference_a[value];
+            last = value;
+            index++;
+        }
+
+        cmc_assert(sorted);
+        cmc_assert(present);
+        cmc_assert_equals(size_t, rb_count(set), index);
+
+        index = 0;
+
+        for (rb_iter_to_end(&iter); !rb_iter_start(&iter); rb_iter_prev(&iter))
+        {
+            size_t value = rb_iter_value(&iter);
+
+            sorted = sorted && (index == 0 || value < last);
+            last = value;
+            index++;
+        }
+
+        cmc_assert(sorted);
+        cmc_assert_equals(size_t, rb_count(set), index);
+
+        size_t *array = malloc(sizeof(size_t) * rb_count(set));
+
+        cmc_assert_equals(size_t, rb_count(set), rb_to_array(set, array, rb_count(set)));
+        cmc_assert_equals(size_t, 3, rb_to_array(set, array, 3));
+        cmc_assert(reference_a[array[0]] && reference_a[array[2]]);
+
+        free(array);
+        rb_free(set);
+    });
+
+    CMC_CREATE_TEST(set operations, {
+        struct roaring *set1 = roaring_random(reference_a, 1);
+        struct roaring *set2 = roaring_random(reference_b, 2);
+
+        // The same operations with and without run containers
+        for (size_t pass = 0; pass < 2; pass++)
+        {
+            if (pass == 1)
+            {
+                cmc_assert(rb_run_optimize(set2));
+                cmc_assert(roaring_has_type(set2, CMC_ROARING_RUN));
+            }
+
+            struct roaring *result = rb_union(set1, set2);
+
+            for (size_t i = 0; i < ROARING_UNIVERSE; i++)
+                expected[i] = reference_a[i] || reference_b[i];
+
+            cmc_assert(roaring_matches(result, expected));
+            cmc_assert(rb_is_subset(set1, result));
+            cmc_assert(rb_is_proper_superset(result, set2));
+            rb_free(result);
+
+            result = rb_intersection(set1, set2);
+
+            for (size_t i = 0; i < ROARING_UNIVERSE; i++)
+                expected[i] = reference_a[i] && reference_b[i];
+
+            cmc_assert(roaring_matches(result, expected));
+            rb_free(result);
+
+            result = rb_difference(set2, set1);
+
+            for (size_t i = 0; i < ROARING_UNIVERSE; i++)
+                expected[i] = reference_b[i] && !reference_a[i];
+
+            cmc_assert(roaring_matches(result, expected));
+            cmc_assert(rb_is_disjointset(result, set1));
+            rb_free(result);
+
+            result = rb_symmetric_difference(set1, set2);
+
+            for (size_t i = 0; i < ROARING_UNIVERSE; i++)
+                expected[i] = reference_a[i] != reference_b[i];
+
+            cmc_assert(roaring_matches(result, expected));
+            rb_free(result);
+        }
+
+        struct roaring *copy = rb_copy_of(set1);
+
+        cmc_assert(rb_union_into(copy, set2));
+
+        for (size_t i = 0; i < ROARING_UNIVERSE; i++)
+            expected[i] = reference_a[i] || reference_b[i];
+
+        cmc_assert(roaring_matches(copy, expected));
+        cmc_assert(rb_is_superset(copy, set1));
+        cmc_assert(!rb_is_subset(copy, set1));
+        cmc_assert(!rb_is_disjointset(set1, set2));
+
+        cmc_assert(rb_subtract(copy, set1));
+
+        for (size_t i = 0; i < ROARING_UNIVERSE; i++)
+            expected[i] = reference_b[i] && !reference_a[i];
+
+        cmc_assert(roaring_matches(copy, expected));
+
+        rb_free(copy);
+        copy = rb_copy_of(set2);
+
+        cmc_assert(rb_intersect_with(copy, set1));
+
+        for (size_t i = 0; i < ROARING_UNIVERSE; i++)
+            expected[i] = reference_a[i] && reference_b[i];
+
+        cmc_assert(roaring_matches(copy, expected));
+
+        rb_free(copy);
+        rb_free(set1);
+        rb_free(set2);
+    });
+
+    CMC_CREATE_TEST(equals run_optimize, {
+        struct roaring *set1 = roaring_random(reference_a, 5);
+        struct roaring *set2 = rb_copy_of(set1);
+
+        size_t before = rb_memory_usage(set2);
+
+        cmc_assert(rb_run_optimize(set2));
+        cmc_assert_lesser(size_t, before, rb_memory_usage(set2));
+
+        // Equal whatever the type of their containers
+        cmc_assert(rb_equals(set1, set2));
+        cmc_assert(rb_equals(set2, set1));
+        cmc_assert(roaring_matches(set2, reference_a));
+
+        // Modifying a run container turns it back
+        cmc_assert(rb_insert(set2, 65536 * 2 + 999));
+        cmc_assert(!rb_equals(set1, set2));
+        cmc_assert(rb_remove(set2, 65536 * 2 + 999));
+        cmc_assert(rb_equals(set1, set2));
+
+        rb_insert(set1, 10);
+        rb_insert(set2, 11);
+
+        // Same count, each with an element the other does not have
+        cmc_assert(!rb_equals(set1, set2));
+
+        rb_free(set1);
+        rb_free(set2);
+    });
+
+    CMC_CREATE_TEST(save restore, {
+        struct roaring *set = roaring_random(reference_a, 7);
+
+        rb_run_optimize(set);
+
+        FILE *file = tmpfile();
+
+        cmc_assert_not_equals(ptr, NULL, file);
+        cmc_assert(rb_save(set, file));
+
+        rewind(file);
+
+        struct roaring *restored = rb_restore(file);
+
+        cmc_assert_not_equals(ptr, NULL, restored);
+        cmc_assert(rb_equals(set, restored));
+        cmc_assert(roaring_matches(restored, reference_a));
+
+        rb_free(restored);
+
+        // A truncated file is not restored
+        rewind(file);
+        fflush(file);
+
+        long size = 0;
+
+        fseek(file, 0, SEEK_END);
+        size = ftell(file);
+
+        char *bytes = malloc((size_t)size);
+
+        rewind(file);
+        cmc_assert_equals(size_t, (size_t)size, fread(bytes, 1, (size_t)size, file));
+        fclose(file);
+
+        file = tmpfile();
+        fwrite(bytes, 1, (size_t)size - 100, file);
+        rewind(file);
+
+        cmc_assert_equals(ptr, NULL, rb_restore(file));
+
+        fclose(file);
+        free(bytes);
+        rb_free(set);
+    });
+});
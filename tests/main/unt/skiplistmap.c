@@ -0,0 +1,228 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <pthread.h>
+
+#include <cmc/skiplistmap.h>
+
+CMC_GENERATE_SKIPLISTMAP(slm, skiplistmap, size_t, size_t)
+
+/* If the keys at each level are sorted and every node is linked at all of */
+/* its levels */
+static bool skiplist_valid(struct skiplistmap *map)
+{
+    for (size_t level = 0; level < CMC_SKIPLIST_LEVELS; level++)
+    {
+        struct skiplistmap_node *prev = NULL;
+        struct skiplistmap_node *scan = atomic_load(&map->head->next[level]);
+
+        for (; scan != NULL; prev = scan, scan = atomic_load(&scan->next[level]))
+        {
+            if (prev && prev->key >= scan->key)
+                return false;
+            if (scan->levels <= level || atomic_load(&scan->marked))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+struct slm_worker
+{
+    struct skiplistmap *map;
+    size_t first;
+    size_t errors;
+};
+
+/* Each worker inserts every fourth key from its first one, removes a third */
+/* of them and then checks that the iteration is still sorted */
+static void *slm_worker_run(void *arg)
+{
+    struct slm_worker *worker = arg;
+
+    for (size_t i = 0; i < 2000; i++)
+    {
+        if (!slm_insert(worker->map, worker->first + i * 4, i))
+            worker->errors++;
+    }
+
+    for (size_t i = 0; i < 2000; i += 3)
+    {
+        size_t value;
+
+        if (!slm_remove(worker->map, worker->first + i * 4, &value) || value != i)
+            worker->errors++;
+    }
+
+    for (size_t i = 0; i < 2000; i++)
+    {
+        size_t key = worker->first + i * 4;
+
+        if (slm_contains(worker->map, key) != (i % 3 != 0))
+            worker->errors++;
+        if (slm_update(worker->map, key, i + 1, NULL) != (i % 3 != 0))
+            worker->errors++;
+    }
+
+    struct skiplistmap_iter iter;
+
+    size_t last = 0;
+
+    for (slm_iter_init(&iter, worker->map); !slm_iter_end(&iter); slm_iter_next(&iter))
+    {
+        size_t key = slm_iter_key(&iter);
+
+        if (slm_iter_index(&iter) > 0 && key <= last)
+            worker->errors++;
+
+        last = key;
+    }
+
+    return NULL;
+}
+
+CMC_CREATE_UNIT(skiplistmap_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct skiplistmap *map = slm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+        cmc_assert_not_equals(ptr, NULL, map->head);
+        cmc_assert(slm_empty(map));
+        cmc_assert(!slm_min(map, NULL, NULL));
+        cmc_assert(!slm_max(map, NULL, NULL));
+
+        slm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct skiplistmap *map = slm_new_custom(cmp, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            slm_insert(map, i, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        slm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(insert update remove, {
+        struct skiplistmap *map = slm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 5000; i++)
+            cmc_assert(slm_insert(map, (i * 7919) % 5000, i));
+
+        cmc_assert(!slm_insert(map, 10, 0));
+        cmc_assert_equals(size_t, 5000, slm_count(map));
+        cmc_assert(skiplist_valid(map));
+
+        size_t old;
+
+        cmc_assert(slm_update(map, 7919 % 5000, 20, &old));
+        cmc_assert_equals(size_t, 1, old);
+        cmc_assert_equals(size_t, 20, slm_get(map, 7919 % 5000));
+        cmc_assert(!slm_update(map, 5000, 0, NULL));
+
+        for (size_t i = 0; i < 5000; i += 2)
+            cmc_assert(slm_remove(map, i, NULL));
+
+        cmc_assert(!slm_remove(map, 0, NULL));
+        cmc_assert_equals(size_t, 2500, slm_count(map));
+        cmc_assert(skiplist_valid(map));
+
+        for (size_t i = 0; i < 5000; i++)
+            cmc_assert_equals(bool, i % 2 == 1, slm_contains(map, i));
+
+        size_t key;
+        size_t value;
+
+        cmc_assert(slm_min(map, &key, &value));
+        cmc_assert_equals(size_t, 1, key);
+        cmc_assert(slm_max(map, &key, NULL));
+        cmc_assert_equals(size_t, 4999, key);
+
+        /* Removed keys can be inserted again before the nodes are freed */
+        cmc_assert(slm_insert(map, 0, 7));
+        cmc_assert_equals(size_t, 7, slm_get(map, 0));
+
+        slm_reclaim(map);
+
+        cmc_assert_equals(ptr, NULL, atomic_load(&map->retired));
+        cmc_assert_equals(size_t, 2501, slm_count(map));
+
+        slm_clear(map, NULL);
+
+        cmc_assert(slm_empty(map));
+        cmc_assert(!slm_contains(map, 1));
+
+        slm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(iter, {
+        struct skiplistmap *map = slm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 1000; i > 0; i--)
+            cmc_assert(slm_insert(map, i, i * 2));
+
+        struct skiplistmap_iter iter;
+
+        size_t total = 0;
+
+        for (slm_iter_init(&iter, map); !slm_iter_end(&iter); slm_iter_next(&iter))
+        {
+            cmc_assert_equals(size_t, total + 1, slm_iter_key(&iter));
+            cmc_assert_equals(size_t, (total + 1) * 2, slm_iter_value(&iter));
+            cmc_assert_equals(size_t, total, slm_iter_index(&iter));
+            total++;
+        }
+
+        cmc_assert_equals(size_t, 1000, total);
+        cmc_assert(!slm_iter_next(&iter));
+
+        slm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(threads, {
+        struct skiplistmap *map = slm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        pthread_t threads[4];
+        struct slm_worker workers[4];
+
+        for (size_t i = 0; i < 4; i++)
+        {
+            workers[i].map = map;
+            workers[i].first = i;
+            workers[i].errors = 0;
+
+            int result = pthread_create(&threads[i], NULL, slm_worker_run, &workers[i]);
+
+            cmc_assert_equals(int32_t, 0, result);
+        }
+
+        for (size_t i = 0; i < 4; i++)
+        {
+            pthread_join(threads[i], NULL);
+
+            cmc_assert_equals(size_t, 0, workers[i].errors);
+        }
+
+        cmc_assert_equals(size_t, 4 * 1333, slm_count(map));
+        cmc_assert(skiplist_valid(map));
+
+        slm_free(map, NULL);
+    });
+});
@@ -0,0 +1,222 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/smalllist.h>
+
+CMC_GENERATE_SMALLLIST(sml, smalllist, size_t, 4)
+
+/* A node of a tree with its children inline */
+struct smalllist_node
+{
+    size_t value;
+    struct smalllist children;
+};
+
+CMC_CREATE_UNIT(smalllist_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct smalllist *l = sml_new(2);
+
+        cmc_assert_not_equals(ptr, NULL, l);
+        cmc_assert(sml_is_inline(l));
+        cmc_assert_equals(size_t, 4, sml_capacity(l));
+        cmc_assert(sml_empty(l));
+
+        sml_free(l, NULL);
+
+        l = sml_new(100);
+
+        cmc_assert_not_equals(ptr, NULL, l);
+        cmc_assert(!sml_is_inline(l));
+        cmc_assert_equals(size_t, 100, sml_capacity(l));
+
+        sml_free(l, NULL);
+    });
+
+    CMC_CREATE_TEST(inline[count allocations], {
+        count_alloc_reset();
+
+        struct smalllist_node nodes[8];
+
+        // Lists that are members of another struct allocate nothing
+        for (size_t i = 0; i < 8; i++)
+        {
+            nodes[i].value = i;
+            sml_init(&nodes[i].children, &count_alloc);
+
+            for (size_t j = 0; j < i % 5; j++)
+                sml_push_back(&nodes[i].children, j);
+        }
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+        cmc_assert_equals(size_t, 4, sml_count(&nodes[4].children));
+        cmc_assert_equals(size_t, 3, sml_get(&nodes[4].children, 3));
+
+        // The fifth element spills them to a buffer
+        cmc_assert(sml_push_back(&nodes[4].children, 4));
+        cmc_assert(!sml_is_inline(&nodes[4].children));
+        cmc_assert_equals(size_t, 1, count_alloc_live);
+
+        for (size_t i = 0; i < 5; i++)
+            cmc_assert_equals(size_t, i, sml_get(&nodes[4].children, i));
+
+        // Moving a spilled list keeps its elements
+        struct smalllist_node moved = nodes[4];
+
+        sml_init(&nodes[4].children, &count_alloc);
+
+        cmc_assert_equals(size_t, 4, sml_back(&moved.children));
+
+        // Back inline once they fit
+        cmc_assert(sml_pop_back(&moved.children));
+        cmc_assert(sml_pop_back(&moved.children));
+        cmc_assert(sml_shrink_to_fit(&moved.children));
+        cmc_assert(sml_is_inline(&moved.children));
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+        cmc_assert_equals(size_t, 2, sml_get(&moved.children, 2));
+
+        sml_release(&moved.children, NULL);
+
+        for (size_t i = 0; i < 8; i++)
+            sml_release(&nodes[i].children, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(push pop, {
+        struct smalllist *l = sml_new(0);
+
+        cmc_assert(sml_push_back(l, 2));
+        cmc_assert(sml_push_front(l, 0));
+        cmc_assert(sml_push_at(l, 1, 1));
+        cmc_assert(!sml_push_at(l, 9, 4));
+        cmc_assert_equals(size_t, 3, sml_count(l));
+        cmc_assert_equals(size_t, 0, sml_front(l));
+        cmc_assert_equals(size_t, 1, sml_get(l, 1));
+        cmc_assert_equals(size_t, 2, sml_back(l));
+        cmc_assert_equals(ptr, NULL, sml_get_ref(l, 3));
+
+        for (size_t i = 3; i < 1000; i++)
+            cmc_assert(sml_push_back(l, i));
+
+        cmc_assert(!sml_is_inline(l));
+
+        bool ordered = true;
+
+        for (size_t i = 0; i < 1000; i++)
+            ordered = ordered && sml_get(l, i) == i;
+
+        cmc_assert(ordered);
+
+        cmc_assert(sml_pop_front(l));
+        cmc_assert(sml_pop_at(l, 1));
+        cmc_assert_equals(size_t, 1, sml_front(l));
+        cmc_assert_equals(size_t, 3, sml_get(l, 1));
+
+        // Removals shrink the buffer until the elements are inline again
+        while (sml_count(l) > 1)
+            cmc_assert(sml_pop_back(l));
+
+        cmc_assert(sml_is_inline(l));
+        cmc_assert_equals(size_t, 1, sml_front(l));
+
+        cmc_assert(sml_pop_back(l));
+        cmc_assert(!sml_pop_back(l));
+        cmc_assert(!sml_pop_front(l));
+
+        sml_free(l, NULL);
+    });
+
+    CMC_CREATE_TEST(indexof contains sort, {
+        struct smalllist *l = sml_new(0);
+
+        for (size_t i = 0; i < 10; i++)
+            sml_push_back(l, (i * 7) % 10);
+
+        cmc_assert_equals(size_t, 3, sml_indexof(l, 1, cmp, true));
+        cmc_assert(sml_contains(l, 9, cmp));
+        cmc_assert(!sml_contains(l, 10, cmp));
+        cmc_assert_equals(size_t, 10, sml_indexof(l, 10, cmp, false));
+
+        sml_sort(l, cmp);
+
+        bool sorted = true;
+
+        for (size_t i = 0; i < 10; i++)
+            sorted = sorted && sml_get(l, i) == i;
+
+        cmc_assert(sorted);
+
+        sml_free(l, NULL);
+    });
+
+    CMC_CREATE_TEST(copy_of equals, {
+        struct smalllist *l1 = sml_new(0);
+
+        sml_push_back(l1, 1);
+        sml_push_back(l1, 2);
+
+        struct smalllist *l2 = sml_copy_of(l1, NULL);
+
+        cmc_assert(sml_equals(l1, l2, cmp));
+        cmc_assert(sml_is_inline(l2));
+
+        for (size_t i = 0; i < 10; i++)
+            sml_push_back(l1, i);
+
+        struct smalllist *l3 = sml_copy_of(l1, NULL);
+
+        cmc_assert(!sml_equals(l1, l2, cmp));
+        cmc_assert(sml_equals(l1, l3, cmp));
+
+        size_t array[20];
+
+        cmc_assert_equals(size_t, 12, sml_to_array(l3, array, 20));
+        cmc_assert_equals(size_t, 9, array[11]);
+
+        sml_free(l1, NULL);
+        sml_free(l2, NULL);
+        sml_free(l3, NULL);
+    });
+
+    CMC_CREATE_TEST(iteration, {
+        struct smalllist *l = sml_new(0);
+        struct smalllist_iter iter;
+
+        sml_iter_init(&iter, l);
+
+        cmc_assert(sml_iter_start(&iter));
+        cmc_assert(sml_iter_end(&iter));
+
+        for (size_t i = 0; i < 6; i++)
+            sml_push_back(l, i);
+
+        size_t sum = 0;
+
+        for (sml_iter_init(&iter, l); !sml_iter_end(&iter); sml_iter_next(&iter))
+        {
+            cmc_assert_equals(size_t, sml_iter_index(&iter), sml_iter_value(&iter));
+            sum += sml_iter_value(&iter);
+        }
+
+        cmc_assert_equals(size_t, 15, sum);
+
+        sum = 0;
+
+        for (sml_iter_to_end(&iter); !sml_iter_start(&iter); sml_iter_prev(&iter))
+            sum += *sml_iter_rvalue(&iter);
+
+        cmc_assert_equals(size_t, 15, sum);
+
+        sml_iter_to_start(&iter);
+
+        cmc_assert(sml_iter_go_to(&iter, 4));
+        cmc_assert_equals(size_t, 4, sml_iter_value(&iter));
+        cmc_assert(sml_iter_rewind(&iter, 3));
+        cmc_assert_equals(size_t, 1, sml_iter_value(&iter));
+        cmc_assert(!sml_iter_advance(&iter, 5));
+
+        sml_free(l, NULL);
+    });
+});
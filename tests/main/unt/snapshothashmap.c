@@ -0,0 +1,188 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/snapshothashmap.h>
+
+CMC_GENERATE_SNAPSHOT_HASHMAP(shm, snapshothashmap, size_t, size_t)
+
+struct shm_worker
+{
+    struct snapshothashmap *map;
+    atomic_bool *done;
+    size_t errors;
+};
+
+static void *shm_worker_read(void *arg)
+{
+    struct shm_worker *worker = arg;
+
+    size_t reader = shm_reader_register(worker->map);
+
+    while (!atomic_load(worker->done))
+    {
+        /* Keys are inserted in order so a snapshot is always a prefix */
+        size_t count = shm_count(worker->map, reader);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            if (shm_get(worker->map, reader, i) != i * 2)
+                worker->errors++;
+        }
+    }
+
+    shm_reader_unregister(worker->map, reader);
+
+    return NULL;
+}
+
+CMC_CREATE_UNIT(snapshothashmap_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct snapshothashmap *map = shm_new(100, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        size_t reader = shm_reader_register(map);
+
+        cmc_assert_equals(size_t, 0, reader);
+        cmc_assert_equals(size_t, 0, shm_count(map, reader));
+
+        shm_reader_unregister(map, reader);
+        shm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct snapshothashmap *map = shm_new_custom(100, 0.6, cmp, hash, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            shm_insert(map, i, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        shm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(new[capacity = 0], {
+        struct snapshothashmap *map = shm_new(0, 0.6, cmp, hash);
+
+        cmc_assert_equals(ptr, NULL, map);
+    });
+
+    CMC_CREATE_TEST(reader_register[full], {
+        struct snapshothashmap *map = shm_new(100, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < CMC_SNAPSHOT_HASHMAP_READERS; i++)
+            cmc_assert_equals(size_t, i, shm_reader_register(map));
+
+        cmc_assert_equals(size_t, CMC_SNAPSHOT_HASHMAP_READERS, shm_reader_register(map));
+
+        shm_reader_unregister(map, 3);
+
+        cmc_assert_equals(size_t, 3, shm_reader_register(map));
+
+        shm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(insert update remove clear, {
+        struct snapshothashmap *map = shm_new(1, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        size_t reader = shm_reader_register(map);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(shm_insert(map, i, i));
+
+        cmc_assert(!shm_insert(map, 10, 0));
+        cmc_assert_equals(size_t, 100, shm_count(map, reader));
+
+        size_t old;
+
+        cmc_assert(shm_update(map, 10, 20, &old));
+        cmc_assert_equals(size_t, 10, old);
+        cmc_assert_equals(size_t, 20, shm_get(map, reader, 10));
+        cmc_assert(!shm_update(map, 1000, 0, NULL));
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert(shm_remove(map, i, NULL));
+
+        cmc_assert(!shm_remove(map, 0, NULL));
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert_equals(bool, i >= 50, shm_contains(map, reader, i));
+
+        shm_clear(map, NULL);
+
+        cmc_assert_equals(size_t, 0, shm_count(map, reader));
+
+        shm_reader_unregister(map, reader);
+        shm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(stats, {
+        struct snapshothashmap *map = shm_new(100, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        size_t reader = shm_reader_register(map);
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert(shm_insert(map, i, i));
+
+        struct cmc_hashtable_stats stats;
+
+        shm_stats(map, reader, &stats);
+
+        cmc_assert_equals(size_t, 50, stats.count);
+        cmc_assert_lesser_equals(size_t, stats.bytes, sizeof(struct snapshothashmap));
+
+        shm_reader_unregister(map, reader);
+        shm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(threads, {
+        struct snapshothashmap *map = shm_new(100, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        atomic_bool done;
+        atomic_init(&done, false);
+
+        pthread_t threads[4];
+        struct shm_worker workers[4];
+
+        for (size_t i = 0; i < 4; i++)
+        {
+            workers[i].map = map;
+            workers[i].done = &done;
+            workers[i].errors = 0;
+
+            int result = pthread_create(&threads[i], NULL, shm_worker_read, &workers[i]);
+
+            cmc_assert_equals(int32_t, 0, result);
+        }
+
+        for (size_t i = 0; i < 2000; i++)
+            shm_insert(map, i, i * 2);
+
+        atomic_store(&done, true);
+
+        for (size_t i = 0; i < 4; i++)
+        {
+            pthread_join(threads[i], NULL);
+
+            cmc_assert_equals(size_t, 0, workers[i].errors);
+        }
+
+        shm_free(map, NULL);
+    });
+});
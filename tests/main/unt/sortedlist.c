@@ -4,8 +4,32 @@
 #include <utl/test.h>
 
 #include <cmc/sortedlist.h>
+#include <utl/cmc_delta.h>
 
 CMC_GENERATE_SORTEDLIST(sl, sortedlist, size_t)
+CMC_GENERATE_SORTEDLIST_EX(slx, sortedlist_ex, size_t, cmp)
+
+static inline uint64_t radix_key_size(size_t value)
+{
+    return value;
+}
+
+CMC_GENERATE_SORTEDLIST_RADIX(slr, sortedlist_radix, size_t, radix_key_size)
+CMC_GENERATE_SORTEDLIST_RADIX(sld, sortedlist_double, double, cmc_radix_key_double)
+CMC_GENERATE_SORTEDLIST(sli, sortedlist_int, int)
+
+CMC_GENERATE_SORTEDLIST_DELTA(sl, sortedlist, size_t)
+CMC_GENERATE_SORTEDLIST_DELTA(sli, sortedlist_int, int)
+
+static int sli_cmp(int a, int b)
+{
+    return (a > b) - (a < b);
+}
+
+static bool sl_is_odd(size_t x)
+{
+    return x % 2 == 1;
+}
 
 CMC_CREATE_UNIT(sortedlist_test, true, {
     CMC_CREATE_TEST(new, {
@@ -20,6 +44,23 @@ CMC_CREATE_UNIT(sortedlist_test, true, {
         sl_free(sl, NULL);
     });
 
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct sortedlist *sl = sl_new_custom(100, cmp, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, sl);
+
+        for (size_t i = 0; i < 1000; i++)
+            sl_insert(sl, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        sl_free(sl, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
     CMC_CREATE_TEST(new[capacity = 0], {
         struct sortedlist *sl = sl_new(0, cmp);
 
@@ -137,4 +178,561 @@ CMC_CREATE_UNIT(sortedlist_test, true, {
 
         sl_free(sl, NULL);
     });
+
+    CMC_CREATE_TEST(sorted tail, {
+        struct sortedlist *sl = sl_new(1, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, sl);
+
+        /* Elements inserted in order keep the list sorted */
+        for (size_t i = 0; i < 1000; i += 2)
+            cmc_assert(sl_insert(sl, i));
+
+        cmc_assert_equals(size_t, 500, sl->sorted);
+
+        /* A few elements are inserted one by one */
+        for (size_t i = 1; i < 10; i += 2)
+            cmc_assert(sl_insert(sl, i));
+
+        cmc_assert_equals(size_t, 500, sl->sorted);
+        cmc_assert_equals(size_t, 9, sl_get(sl, 9));
+        cmc_assert_equals(size_t, 505, sl->sorted);
+
+        /* Many elements are sorted and merged */
+        for (size_t i = 0; i < 495; i++)
+            cmc_assert(sl_insert(sl, ((i * 7919) % 495) * 2 + 11));
+
+        size_t min;
+
+        cmc_assert(sl_min(sl, &min));
+        cmc_assert_equals(size_t, 0, min);
+        cmc_assert_equals(size_t, 1000, sl->sorted);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert_equals(size_t, i, sl_get(sl, i));
+
+        /* Removing an element keeps the rest in order */
+        cmc_assert(sl_remove(sl, 10));
+        cmc_assert_equals(size_t, 999, sl->sorted);
+        cmc_assert(sl_insert(sl, 10));
+        cmc_assert_equals(size_t, 999, sl->sorted);
+        cmc_assert_equals(size_t, 10, sl_get(sl, 10));
+        cmc_assert_equals(size_t, 1000, sl->sorted);
+
+        sl_clear(sl, NULL);
+
+        cmc_assert_equals(size_t, 0, sl->sorted);
+
+        sl_free(sl, NULL);
+    });
+
+    CMC_CREATE_TEST(freeze, {
+        struct sortedlist *sl = sl_new(1, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, sl);
+
+        /* Every shape of the last level of the tree, with repeated elements */
+        for (size_t n = 1; n < 70; n++)
+        {
+            sl_clear(sl, NULL);
+
+            for (size_t i = 0; i < n; i++)
+                cmc_assert(sl_insert(sl, ((i * 7919) % n) / 2 * 2));
+
+            size_t first[72];
+            size_t last[72];
+
+            for (size_t i = 0; i < 72; i++)
+            {
+                first[i] = sl_indexof(sl, i, true);
+                last[i] = sl_indexof(sl, i, false);
+            }
+
+            cmc_assert(sl_freeze(sl));
+            cmc_assert_not_equals(ptr, NULL, sl->frozen);
+
+            for (size_t i = 0; i < 72; i++)
+            {
+                cmc_assert_equals(size_t, first[i], sl_indexof(sl, i, true));
+                cmc_assert_equals(size_t, last[i], sl_indexof(sl, i, false));
+                cmc_assert_equals(bool, i % 2 == 0 && i < n, sl_contains(sl, i));
+            }
+        }
+
+        /* Changes drop the frozen copy */
+        cmc_assert(sl_insert(sl, 1));
+        cmc_assert_equals(ptr, NULL, sl->frozen);
+        cmc_assert(sl_contains(sl, 1));
+
+        cmc_assert(sl_freeze(sl));
+        cmc_assert(sl_remove(sl, 0));
+        cmc_assert_equals(ptr, NULL, sl->frozen);
+
+        cmc_assert(sl_freeze(sl));
+
+        sl_free(sl, NULL);
+    });
+
+    CMC_CREATE_TEST(sort_parallel, {
+        struct sortedlist *sl = sl_new(1, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, sl);
+
+        for (size_t i = 0; i < 100000; i++)
+            cmc_assert(sl_insert(sl, (i * 7919) % 100000));
+
+        sl_sort_parallel(sl, 4);
+
+        cmc_assert_equals(size_t, 100000, sl->sorted);
+
+        for (size_t i = 0; i < 100000; i++)
+            cmc_assert_equals(size_t, i, sl_get(sl, i));
+
+        sl_free(sl, NULL);
+    });
+
+    CMC_CREATE_TEST(set operations, {
+        struct sortedlist *sl1 = sl_new(1, cmp);
+        struct sortedlist *sl2 = sl_new(1, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, sl1);
+        cmc_assert_not_equals(ptr, NULL, sl2);
+
+        /* 0 to 99 twice and the multiples of 3 to 297 once */
+        for (size_t i = 0; i < 200; i++)
+            cmc_assert(sl_insert(sl1, 99 - i % 100));
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(sl_insert(sl2, 297 - i * 3));
+
+        struct sortedlist *u = sl_union(sl1, sl2);
+        struct sortedlist *n = sl_intersection(sl1, sl2);
+        struct sortedlist *d = sl_difference(sl1, sl2);
+
+        cmc_assert_not_equals(ptr, NULL, u);
+        cmc_assert_not_equals(ptr, NULL, n);
+        cmc_assert_not_equals(ptr, NULL, d);
+
+        /* Multiples of 3 below 100 are twice in sl1 and once in sl2 */
+        cmc_assert_equals(size_t, 200 + 66, sl_count(u));
+        cmc_assert_equals(size_t, 34, sl_count(n));
+        cmc_assert_equals(size_t, 166, sl_count(d));
+
+        for (size_t i = 1; i < sl_count(u); i++)
+            cmc_assert(sl_get(u, i - 1) <= sl_get(u, i));
+
+        for (size_t i = 0; i < sl_count(n); i++)
+            cmc_assert_equals(size_t, i * 3, sl_get(n, i));
+
+        cmc_assert_equals(size_t, 0, sl_get(d, 0));
+        cmc_assert_equals(size_t, 1, sl_get(d, 1));
+        cmc_assert_equals(size_t, 1, sl_count(d) - sl_indexof(d, 99, true));
+
+        sl_free(u, NULL);
+        sl_free(n, NULL);
+        sl_free(d, NULL);
+
+        /* Skewed sizes gallop through the larger list */
+        sl_clear(sl1, NULL);
+        sl_clear(sl2, NULL);
+
+        for (size_t i = 0; i < 10000; i++)
+            cmc_assert(sl_insert(sl1, i));
+
+        for (size_t i = 0; i < 20; i++)
+            cmc_assert(sl_insert(sl2, i * 1000 + 1));
+
+        cmc_assert(sl_insert(sl2, 1));
+
+        n = sl_intersection(sl1, sl2);
+
+        cmc_assert_not_equals(ptr, NULL, n);
+        cmc_assert_equals(size_t, 10, sl_count(n));
+
+        for (size_t i = 0; i < 10; i++)
+            cmc_assert_equals(size_t, i * 1000 + 1, sl_get(n, i));
+
+        sl_free(n, NULL);
+
+        n = sl_intersection(sl2, sl1);
+
+        cmc_assert_not_equals(ptr, NULL, n);
+        cmc_assert_equals(size_t, 10, sl_count(n));
+
+        sl_free(n, NULL);
+        sl_free(sl1, NULL);
+        sl_free(sl2, NULL);
+    });
+
+    CMC_CREATE_TEST(merge_k, {
+        struct sortedlist *lists[5];
+
+        for (size_t i = 0; i < 5; i++)
+        {
+            lists[i] = sl_new(1, cmp);
+
+            cmc_assert_not_equals(ptr, NULL, lists[i]);
+
+            /* The last list is empty */
+            for (size_t j = 0; i < 4 && j < 1000; j++)
+                cmc_assert(sl_insert(lists[i], (j * 7919) % 1000 * 4 + i));
+        }
+
+        struct sortedlist *result = sl_merge_k(lists, 5);
+
+        cmc_assert_not_equals(ptr, NULL, result);
+        cmc_assert_equals(size_t, 4000, sl_count(result));
+        cmc_assert_equals(size_t, 4000, result->sorted);
+
+        for (size_t i = 0; i < 4000; i++)
+            cmc_assert_equals(size_t, i, sl_get(result, i));
+
+        cmc_assert_equals(ptr, NULL, sl_merge_k(lists, 0));
+
+        sl_free(result, NULL);
+
+        for (size_t i = 0; i < 5; i++)
+            sl_free(lists[i], NULL);
+    });
+
+    CMC_CREATE_TEST(ex[sort], {
+        struct sortedlist_ex *sl = slx_new(1, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, sl);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(slx_insert(sl, (i * 7919) % 1000));
+
+        slx_sort(sl);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert_equals(size_t, i, slx_indexof(sl, i, true));
+
+        slx_free(sl, NULL);
+    });
+
+    CMC_CREATE_TEST(radix[sort], {
+        struct sortedlist_radix *sl = slr_new(1, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, sl);
+
+        /* The keys spread over the higher bytes too */
+        for (size_t i = 0; i < 5000; i++)
+            cmc_assert(slr_insert(sl, ((i * 7919) % 5000) * 1000003 * 4096));
+
+        slr_sort(sl);
+
+        for (size_t i = 0; i < 5000; i++)
+            cmc_assert_equals(size_t, i * 1000003 * 4096, slr_get(sl, i));
+
+        cmc_assert_equals(size_t, 2500, slr_indexof(sl, (size_t)2500 * 1000003 * 4096, true));
+
+        /* Small lists are sorted by the comparison sort */
+        slr_clear(sl, NULL);
+
+        for (size_t i = 100; i > 0; i--)
+            cmc_assert(slr_insert(sl, i));
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert_equals(size_t, i + 1, slr_get(sl, i));
+
+        slr_free(sl, NULL);
+    });
+
+    CMC_CREATE_TEST(radix[double], {
+        struct sortedlist_double *sl = sld_new(1, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, sl);
+
+        for (size_t i = 0; i < 2000; i++)
+            cmc_assert(sld_insert(sl, (double)((i * 7919) % 2000) - 1000.5));
+
+        for (size_t i = 0; i < 2000; i++)
+            cmc_assert(sld_get(sl, i) == (double)i - 1000.5);
+
+        double min;
+
+        cmc_assert(sld_min(sl, &min));
+        cmc_assert(min == -1000.5);
+
+        sld_free(sl, NULL);
+    });
+
+    CMC_CREATE_TEST(new_from, {
+        size_t elements[100];
+
+        for (size_t i = 0; i < 100; i++)
+            elements[i] = (i * 37) % 100;
+
+        struct sortedlist *l = sl_new_from(elements, 100, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, l);
+        cmc_assert_equals(size_t, 100, sl_count(l));
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert_equals(size_t, i, sl_get(l, i));
+
+        sl_free(l, NULL);
+
+        cmc_assert_equals(ptr, NULL, sl_new_from(elements, 0, cmp));
+    });
+
+    CMC_CREATE_TEST(to_array[sorted], {
+        struct sortedlist *l = sl_new(100, cmp);
+
+        for (size_t i = 0; i < 50; i++)
+            sl_insert(l, 49 - i);
+
+        size_t elements[50] = { 0 };
+
+        cmc_assert_equals(size_t, 50, sl_to_array(l, elements, 100));
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert_equals(size_t, i, elements[i]);
+
+        cmc_assert_equals(size_t, 5, sl_to_array(l, elements, 5));
+
+        sl_free(l, NULL);
+    });
+
+    CMC_CREATE_TEST(parallel_reduce, {
+        struct sortedlist *l = sl_new(100000, cmp);
+
+        for (size_t i = 100000; i > 0; i--)
+            sl_insert(l, i);
+
+        cmc_assert_equals(size_t, 5000050000, sl_parallel_reduce(l, 0, add, add, 4));
+        cmc_assert_equals(size_t, 1, sl_get(l, 0));
+        cmc_assert_equals(size_t, 100000, sl_get(l, 99999));
+
+        sl_free(l, NULL);
+    });
+
+    CMC_CREATE_TEST(delta[save restore], {
+        struct sortedlist *l = sl_new(100, cmp);
+
+        /* Small gaps with a few large ones, inserted out of order */
+        for (size_t i = 0; i < 10000; i++)
+            sl_insert(l, (9999 - i) * 3 + (i % 1000 == 0 ? 1000000 : 0));
+
+        FILE *file = tmpfile();
+
+        cmc_assert_not_equals(ptr, NULL, file);
+        cmc_assert(sl_save_delta(l, file));
+        cmc_assert_lesser(size_t, 10000 * sizeof(size_t) / 4, (size_t)ftell(file));
+
+        rewind(file);
+
+        struct sortedlist *result = sl_restore_delta(file, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, result);
+        cmc_assert_equals(size_t, sl_count(l), sl_count(result));
+
+        for (size_t i = 0; i < sl_count(l); i++)
+            cmc_assert_equals(size_t, sl_get(l, i), sl_get(result, i));
+
+        /* Not a delta file */
+        rewind(file);
+        cmc_assert(sl_save(l, file, NULL));
+        rewind(file);
+        cmc_assert_equals(ptr, NULL, sl_restore_delta(file, cmp));
+
+        fclose(file);
+        sl_free(l, NULL);
+        sl_free(result, NULL);
+    });
+
+    CMC_CREATE_TEST(delta[frozen], {
+        struct sortedlist_int *l = sli_new(100, sli_cmp);
+
+        for (int i = -1000; i < 1000; i += 3)
+            sli_insert(l, i);
+
+        struct cmc_delta delta;
+        struct cmc_delta_iter iter;
+        int expected = -1000;
+
+        cmc_assert(sli_to_delta(l, &delta));
+        cmc_assert_equals(size_t, sli_count(l), delta.count);
+
+        for (cmc_delta_iter_init(&iter, &delta); !cmc_delta_iter_end(&iter);
+             cmc_delta_iter_next(&iter))
+        {
+            cmc_assert_equals(int32_t, expected, sli_delta_value(&iter));
+            expected += 3;
+        }
+
+        cmc_assert_equals(int32_t, 1001, expected);
+
+        for (int i = -1010; i < 1010; i++)
+            cmc_assert_equals(bool, sli_contains(l, i), sli_delta_contains(&delta, i));
+
+        struct sortedlist_int *result = sli_from_delta(&delta, sli_cmp);
+
+        cmc_assert_not_equals(ptr, NULL, result);
+        cmc_assert_equals(int32_t, -1000, sli_get(result, 0));
+        cmc_assert_equals(int32_t, 998, sli_get(result, sli_count(result) - 1));
+
+        cmc_delta_release(&delta);
+        sli_free(l, NULL);
+        sli_free(result, NULL);
+    });
+
+    CMC_CREATE_TEST(remove_if, {
+        struct sortedlist *sl = sl_new(100, cmp);
+
+        for (size_t i = 0; i < 1000; i++)
+            sl_insert(sl, (i * 7919) % 1000);
+
+        cmc_assert_equals(size_t, 500, sl_remove_if(sl, sl_is_odd, NULL));
+        cmc_assert_equals(size_t, 500, sl_count(sl));
+
+        for (size_t i = 0; i < sl_count(sl); i++)
+            cmc_assert_equals(size_t, i * 2, sl_get(sl, i));
+
+        cmc_assert(sl_contains(sl, 998));
+        cmc_assert(!sl_contains(sl, 999));
+
+        sl_free(sl, NULL);
+    });
+
+    CMC_CREATE_TEST(view, {
+        struct sortedlist *sl = sl_new(100, cmp);
+
+        // Every element is in the list twice
+        for (size_t i = 0; i < 200; i++)
+            sl_insert(sl, (i * 7919) % 100);
+
+        struct sortedlist_view view = sl_view(sl, 20, 59);
+
+        cmc_assert_equals(size_t, 40, view.count);
+        cmc_assert_equals(size_t, 10, sl_view_get(view, 0));
+        cmc_assert_equals(size_t, 29, sl_view_get(view, 39));
+
+        cmc_assert(sl_view_contains(view, 10));
+        cmc_assert(!sl_view_contains(view, 30));
+        cmc_assert_equals(size_t, 2, sl_view_indexof(view, 11, true));
+        cmc_assert_equals(size_t, 3, sl_view_indexof(view, 11, false));
+        cmc_assert_equals(size_t, 40, sl_view_indexof(view, 9, true));
+        cmc_assert_equals(size_t, 2, sl_view_lower_bound(view, 11));
+        cmc_assert_equals(size_t, 4, sl_view_upper_bound(view, 11));
+
+        struct sortedlist_view range = sl_view_range(sl, 40, 44);
+
+        cmc_assert_equals(size_t, 10, range.count);
+        cmc_assert_equals(size_t, 40, sl_view_get(range, 0));
+        cmc_assert_equals(size_t, 44, sl_view_get(range, 9));
+        cmc_assert_equals(size_t, 0, sl_view_range(sl, 50, 40).count);
+        cmc_assert_equals(size_t, 0, sl_view_range(sl, 100, 200).count);
+
+        struct sortedlist_view slice = sl_view_slice(view, 38, 39);
+
+        cmc_assert_equals(size_t, 2, slice.count);
+        cmc_assert(sl_view_contains(slice, 29));
+        cmc_assert(!sl_view_contains(slice, 28));
+
+        struct sortedlist_view_iter iter;
+        size_t count = 0;
+
+        for (sl_view_iter_init(&iter, range); !sl_view_iter_end(&iter); sl_view_iter_next(&iter))
+        {
+            cmc_assert_equals(size_t, 40 + count / 2, sl_view_iter_value(&iter));
+            count++;
+        }
+
+        cmc_assert_equals(size_t, 10, count);
+
+        sl_free(sl, NULL);
+    });
+
+    CMC_CREATE_TEST(remove_lazy, {
+        struct sortedlist *sl = sl_new(100, cmp);
+
+        // Every element is in the list twice
+        for (size_t i = 0; i < 1000; i++)
+        {
+            sl_insert(sl, i);
+            sl_insert(sl, 999 - i);
+        }
+
+        for (size_t i = 0; i < 1000; i += 2)
+            cmc_assert(sl_remove_lazy(sl, i));
+
+        cmc_assert_equals(size_t, 1500, sl_count(sl));
+
+        // The removed elements are still in the buffer until the next sort
+        cmc_assert_equals(size_t, 2000, sl->count);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(sl_contains(sl, i));
+
+        for (size_t i = 0; i < 1000; i += 2)
+        {
+            cmc_assert(sl_remove_lazy(sl, i));
+            cmc_assert(!sl_remove_lazy(sl, i));
+            cmc_assert(!sl_contains(sl, i));
+            cmc_assert(sl_contains(sl, i + 1));
+        }
+
+        cmc_assert_equals(size_t, 1000, sl_count(sl));
+        cmc_assert_equals(size_t, 2000, sl->count);
+
+        // Inserting in order keeps the list sorted and the marks in place
+        cmc_assert(sl_insert(sl, 5000));
+        cmc_assert(!sl_contains(sl, 0));
+        cmc_assert(sl_remove_lazy(sl, 5000));
+
+        sl_sort(sl);
+
+        cmc_assert_equals(size_t, 1000, sl->count);
+        cmc_assert_equals(ptr, NULL, sl->dead);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert_equals(size_t, (i / 2) * 2 + 1, sl_get(sl, i));
+
+        sl_free(sl, NULL);
+    });
+
+    CMC_CREATE_TEST(set_unique, {
+        struct sortedlist *sl = sl_new(100, cmp);
+
+        for (size_t i = 0; i < 300; i++)
+            sl_insert(sl, i % 100);
+
+        sl_set_unique(sl, true);
+
+        cmc_assert_equals(size_t, 100, sl_count(sl));
+
+        // Duplicates in order and out of order are dropped by the sort
+        for (size_t i = 0; i < 200; i++)
+            sl_insert(sl, i);
+
+        for (size_t i = 200; i > 0; i--)
+            sl_insert(sl, i - 1);
+
+        sl_sort(sl);
+
+        cmc_assert_equals(size_t, 200, sl_count(sl));
+
+        for (size_t i = 0; i < 200; i++)
+            cmc_assert_equals(size_t, i, sl_get(sl, i));
+
+        cmc_assert(sl_remove_lazy(sl, 10));
+        cmc_assert(!sl_remove_lazy(sl, 10));
+        cmc_assert(sl_insert(sl, 10));
+        cmc_assert(sl_contains(sl, 10));
+
+        struct sortedlist *copy = sl_copy_of(sl, NULL);
+
+        cmc_assert(copy->unique);
+        cmc_assert_equals(size_t, 200, sl_count(copy));
+
+        sl_set_unique(sl, false);
+        sl_insert(sl, 10);
+
+        cmc_assert_equals(size_t, 201, sl_count(sl));
+
+        sl_free(sl, NULL);
+        sl_free(copy, NULL);
+    });
 });
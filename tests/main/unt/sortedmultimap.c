@@ -0,0 +1,200 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/sortedmultimap.h>
+
+CMC_GENERATE_SORTED_MULTIMAP(smm, sortedmultimap, size_t, size_t)
+
+static size_t smm_deallocated = 0;
+
+static void smm_deallocator(size_t key, size_t *values, size_t n)
+{
+    (void)key;
+    (void)values;
+
+    smm_deallocated += n;
+}
+
+CMC_CREATE_UNIT(sortedmultimap_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct sortedmultimap *map = smm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+        cmc_assert_equals(size_t, 0, smm_count(map));
+        cmc_assert_equals(size_t, 0, smm_keys(map));
+        cmc_assert(smm_empty(map));
+
+        size_t key;
+
+        cmc_assert(!smm_min(map, &key));
+        cmc_assert(!smm_max(map, &key));
+
+        smm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct sortedmultimap *map = smm_new_custom(cmp, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            smm_insert(map, i % 10, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        smm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(get_all[insertion order], {
+        struct sortedmultimap *map = smm_new(cmp);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(smm_insert(map, i % 7, i));
+
+        cmc_assert_equals(size_t, 1000, smm_count(map));
+        cmc_assert_equals(size_t, 7, smm_keys(map));
+
+        size_t *values;
+        size_t n;
+
+        for (size_t k = 0; k < 7; k++)
+        {
+            cmc_assert(smm_get_all(map, k, &values, &n));
+            cmc_assert_equals(size_t, smm_key_count(map, k), n);
+
+            for (size_t i = 0; i < n; i++)
+                cmc_assert_equals(size_t, k + i * 7, values[i]);
+        }
+
+        cmc_assert(!smm_get_all(map, 7, &values, &n));
+        cmc_assert_equals(ptr, NULL, values);
+        cmc_assert_equals(size_t, 0, n);
+
+        size_t key;
+
+        cmc_assert(smm_min(map, &key));
+        cmc_assert_equals(size_t, 0, key);
+        cmc_assert(smm_max(map, &key));
+        cmc_assert_equals(size_t, 6, key);
+
+        smm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(iter[sorted keys], {
+        struct sortedmultimap *map = smm_new(cmp);
+
+        // Keys are inserted out of order, three values each
+        for (size_t i = 0; i < 300; i++)
+            cmc_assert(smm_insert(map, (i * 37) % 100 * 10, i));
+
+        struct sortedmultimap_iter iter;
+        size_t *values;
+        size_t n;
+        size_t expected = 0;
+        bool sorted = true;
+
+        smm_iter_init(&iter, map);
+
+        for (smm_iter_to_start(&iter); !smm_iter_end(&iter); smm_iter_next(&iter))
+        {
+            values = smm_iter_values(&iter, &n);
+
+            sorted = sorted && smm_iter_key(&iter) == expected && n == 3;
+            sorted = sorted && (values[0] * 37) % 100 * 10 == expected;
+            expected += 10;
+        }
+
+        cmc_assert(sorted);
+        cmc_assert_equals(size_t, 1000, expected);
+
+        smm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(range, {
+        struct sortedmultimap *map = smm_new(cmp);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(smm_insert(map, i / 4 * 10, i));
+
+        // Keys 100, 110 and 120 but not 130
+        struct sortedmultimap_iter iter = smm_range(map, 95, 130);
+        size_t total = 0;
+        size_t n;
+
+        for (smm_iter_to_start(&iter); !smm_iter_end(&iter); smm_iter_next(&iter))
+        {
+            smm_iter_values(&iter, &n);
+            total += n;
+        }
+
+        cmc_assert_equals(size_t, 12, total);
+
+        iter = smm_lower_bound(map, 230);
+        smm_iter_to_start(&iter);
+
+        cmc_assert_equals(size_t, 230, smm_iter_key(&iter));
+        cmc_assert_equals(size_t, 92, smm_iter_values(&iter, &n)[0]);
+
+        iter = smm_upper_bound(map, 230);
+        smm_iter_to_start(&iter);
+
+        cmc_assert_equals(size_t, 240, smm_iter_key(&iter));
+        cmc_assert(smm_iter_next(&iter) == false);
+
+        iter = smm_range(map, 241, 1000);
+        smm_iter_to_start(&iter);
+
+        cmc_assert(smm_iter_end(&iter));
+        cmc_assert_equals(ptr, NULL, smm_iter_values(&iter, &n));
+        cmc_assert_equals(size_t, 0, n);
+
+        smm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(remove[first in first out], {
+        struct sortedmultimap *map = smm_new(cmp);
+
+        for (size_t i = 0; i < 10; i++)
+            cmc_assert(smm_insert(map, 1, i));
+
+        size_t r;
+
+        for (size_t i = 0; i < 10; i++)
+        {
+            cmc_assert_equals(size_t, i, smm_get(map, 1));
+            cmc_assert(smm_remove(map, 1, &r));
+            cmc_assert_equals(size_t, i, r);
+        }
+
+        cmc_assert(!smm_remove(map, 1, &r));
+        cmc_assert(!smm_contains(map, 1));
+        cmc_assert(smm_empty(map));
+
+        for (size_t i = 0; i < 300; i++)
+            cmc_assert(smm_insert(map, i % 3, i));
+
+        size_t *values;
+
+        cmc_assert_equals(size_t, 100, smm_remove_all(map, 1, &values));
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert_equals(size_t, 1 + i * 3, values[i]);
+
+        free(values);
+
+        cmc_assert_equals(size_t, 0, smm_remove_all(map, 1, NULL));
+        cmc_assert_equals(size_t, 200, smm_count(map));
+
+        smm_deallocated = 0;
+
+        smm_free(map, smm_deallocator);
+
+        cmc_assert_equals(size_t, 200, smm_deallocated);
+    });
+});
@@ -0,0 +1,183 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/sortedwindow.h>
+
+CMC_GENERATE_SORTEDWINDOW(sw, sortedwindow, size_t)
+
+/* Values pushed by the tests, with many duplicates */
+static size_t sortedwindow_sample(size_t i)
+{
+    return (i * 7919) % 1009 + (i / 5000) * 300;
+}
+
+static int sortedwindow_qsort_cmp(const void *a, const void *b)
+{
+    return cmp(*(const size_t *)a, *(const size_t *)b);
+}
+
+/* If the values of the window are exactly the last window samples pushed */
+static bool sortedwindow_valid(struct sortedwindow *window, size_t pushed, size_t *scratch)
+{
+    size_t count = pushed < window->window ? pushed : window->window;
+
+    if (sw_count(window) != count)
+        return false;
+
+    for (size_t i = 0; i < count; i++)
+        scratch[i] = sortedwindow_sample(pushed - count + i);
+
+    qsort(scratch, count, sizeof(size_t), sortedwindow_qsort_cmp);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (sw_get(window, i) != scratch[i])
+            return false;
+    }
+
+    size_t total = 0;
+
+    for (size_t i = 0; i < window->block_count; i++)
+    {
+        if (window->blocks[i].count == 0 || window->blocks[i].count > CMC_SORTED_WINDOW_BLOCK)
+            return false;
+
+        total += window->blocks[i].count;
+    }
+
+    return total == count;
+}
+
+CMC_CREATE_UNIT(sortedwindow_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct sortedwindow *window = sw_new(100, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, window);
+        cmc_assert_not_equals(ptr, NULL, window->ring);
+        cmc_assert_equals(size_t, 100, window->window);
+        cmc_assert(sw_empty(window));
+        cmc_assert(!sw_full(window));
+        cmc_assert(!sw_quantile(window, 0.5, NULL));
+        cmc_assert(!sw_min(window, NULL));
+        cmc_assert(!sw_max(window, NULL));
+
+        cmc_assert_equals(ptr, NULL, sw_new(0, cmp));
+
+        sw_free(window, NULL);
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct sortedwindow *window = sw_new_custom(100, cmp, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, window);
+
+        for (size_t i = 0; i < 1000; i++)
+            sw_push(window, i, NULL);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        sw_free(window, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(push, {
+        struct sortedwindow *window = sw_new(3000, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, window);
+
+        size_t *scratch = malloc(sizeof(size_t) * 3000);
+
+        cmc_assert_not_equals(ptr, NULL, scratch);
+
+        for (size_t i = 0; i < 20000; i++)
+        {
+            size_t evicted = 0;
+
+            cmc_assert(sw_push(window, sortedwindow_sample(i), &evicted));
+
+            if (i >= 3000)
+                cmc_assert_equals(size_t, sortedwindow_sample(i - 3000), evicted);
+
+            if (i % 1499 == 0)
+                cmc_assert(sortedwindow_valid(window, i + 1, scratch));
+        }
+
+        cmc_assert(sw_full(window));
+        cmc_assert(sortedwindow_valid(window, 20000, scratch));
+
+        /* Pushing bigger and bigger values leaves only those in the window */
+        for (size_t i = 0; i < 3000; i++)
+            cmc_assert(sw_push(window, 100000 + i, NULL));
+
+        size_t value;
+
+        cmc_assert(sw_min(window, &value));
+        cmc_assert_equals(size_t, 100000, value);
+        cmc_assert(sw_max(window, &value));
+        cmc_assert_equals(size_t, 102999, value);
+        cmc_assert_equals(size_t, 101500, sw_get(window, 1500));
+        cmc_assert_equals(size_t, 0, sw_get(window, 3000));
+
+        sw_clear(window, NULL);
+
+        cmc_assert(sw_empty(window));
+        cmc_assert_equals(size_t, 0, window->block_count);
+        cmc_assert(sw_push(window, 5, NULL));
+        cmc_assert_equals(size_t, 5, sw_get(window, 0));
+
+        free(scratch);
+        sw_free(window, NULL);
+    });
+
+    CMC_CREATE_TEST(quantile, {
+        struct sortedwindow *window = sw_new(1001, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, window);
+
+        /* The window ends up with the values from 0 to 1000 */
+        for (size_t i = 2000; i > 0; i--)
+            cmc_assert(sw_push(window, i, NULL));
+
+        cmc_assert(sw_push(window, 0, NULL));
+
+        size_t value;
+
+        cmc_assert(sw_quantile(window, 0.0, &value));
+        cmc_assert_equals(size_t, 0, value);
+        cmc_assert(sw_quantile(window, 0.5, &value));
+        cmc_assert_equals(size_t, 500, value);
+        cmc_assert(sw_quantile(window, 0.99, &value));
+        cmc_assert_equals(size_t, 990, value);
+        cmc_assert(sw_quantile(window, 1.0, &value));
+        cmc_assert_equals(size_t, 1000, value);
+        cmc_assert(sw_quantile(window, 2.0, &value));
+        cmc_assert_equals(size_t, 1000, value);
+        cmc_assert(sw_quantile(window, -1.0, &value));
+        cmc_assert_equals(size_t, 0, value);
+
+        sw_free(window, NULL);
+    });
+
+    CMC_CREATE_TEST(window of one, {
+        struct sortedwindow *window = sw_new(1, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, window);
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            size_t evicted = 0;
+
+            cmc_assert(sw_push(window, 1000 - i, &evicted));
+            cmc_assert_equals(size_t, i == 0 ? 0 : 1001 - i, evicted);
+            cmc_assert_equals(size_t, 1, sw_count(window));
+            cmc_assert_equals(size_t, 1000 - i, sw_get(window, 0));
+        }
+
+        sw_free(window, NULL);
+    });
+});
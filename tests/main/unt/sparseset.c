@@ -0,0 +1,208 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/sparseset.h>
+
+CMC_GENERATE_SPARSESET(sps, sparseset, uint32_t)
+CMC_GENERATE_SPARSEMAP(spm, sparsemap, uint32_t, double)
+
+CMC_CREATE_UNIT(sparseset_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct sparseset *set = sps_new(100);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+        cmc_assert(sps_empty(set));
+        cmc_assert_equals(size_t, 128, set->index.universe);
+        cmc_assert(!sps_contains(set, 5));
+        cmc_assert(!sps_contains(set, 1000000));
+
+        sps_free(set);
+
+        set = sps_new(0);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+        cmc_assert(sps_insert(set, 3));
+        cmc_assert(sps_contains(set, 3));
+
+        sps_free(set);
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct sparseset *set = sps_new_custom(10, &count_alloc);
+        struct sparsemap *map = spm_new_custom(0, &count_alloc);
+
+        for (uint32_t i = 0; i < 5000; i += 3)
+        {
+            sps_insert(set, i);
+            spm_insert(map, i, i * 0.5);
+        }
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        sps_free(set);
+        spm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(insert remove contains, {
+        struct sparseset *set = sps_new(0);
+
+        cmc_assert(sps_insert(set, 10));
+        cmc_assert(sps_insert(set, 0));
+        cmc_assert(sps_insert(set, 700));
+        cmc_assert(!sps_insert(set, 10));
+        cmc_assert(!sps_insert(set, UINT32_MAX));
+        cmc_assert_equals(size_t, 3, sps_count(set));
+
+        cmc_assert(sps_contains(set, 0));
+        cmc_assert(sps_contains(set, 700));
+        cmc_assert(!sps_contains(set, 11));
+        cmc_assert_equals(size_t, 1, sps_index_of(set, 0));
+        cmc_assert_equals(size_t, 3, sps_index_of(set, 11));
+
+        // The last element takes the place of the removed one
+        cmc_assert(sps_remove(set, 10));
+        cmc_assert(!sps_remove(set, 10));
+        cmc_assert_equals(size_t, 2, sps_count(set));
+        cmc_assert_equals(size_t, 700, sps_data(set)[0]);
+        cmc_assert_equals(size_t, 0, sps_index_of(set, 700));
+        cmc_assert(!sps_contains(set, 10));
+
+        // Stale entries are not trusted after clear
+        sps_clear(set);
+
+        cmc_assert(sps_empty(set));
+        cmc_assert(!sps_contains(set, 0));
+        cmc_assert(!sps_contains(set, 700));
+        cmc_assert(sps_insert(set, 700));
+        cmc_assert(!sps_contains(set, 0));
+
+        sps_free(set);
+    });
+
+    CMC_CREATE_TEST(random, {
+        struct sparseset *set = sps_new(0);
+        bool reference[4096];
+        size_t count = 0;
+        size_t x = 12345;
+
+        memset(reference, 0, sizeof(reference));
+
+        for (size_t i = 0; i < 100000; i++)
+        {
+            x = x * 6364136223846793005u + 1442695040888963407u;
+
+            uint32_t e = (uint32_t)((x >> 33) % 4096);
+
+            if ((x >> 20) & 1)
+            {
+                cmc_assert(sps_insert(set, e) != reference[e]);
+                count += !reference[e];
+                reference[e] = true;
+            }
+            else
+            {
+                cmc_assert(sps_remove(set, e) == reference[e]);
+                count -= reference[e];
+                reference[e] = false;
+            }
+        }
+
+        bool matches = sps_count(set) == count;
+
+        for (uint32_t i = 0; i < 4096; i++)
+            matches = matches && sps_contains(set, i) == reference[i];
+
+        cmc_assert(matches);
+
+        struct sparseset *copy = sps_copy_of(set);
+
+        cmc_assert(sps_equals(set, copy));
+        cmc_assert(sps_remove(copy, sps_data(copy)[0]));
+        cmc_assert(!sps_equals(set, copy));
+
+        sps_free(copy);
+        sps_free(set);
+    });
+
+    CMC_CREATE_TEST(iteration, {
+        struct sparseset *set = sps_new(0);
+        struct sparseset_iter iter;
+
+        sps_iter_init(&iter, set);
+
+        cmc_assert(sps_iter_end(&iter));
+
+        for (uint32_t i = 0; i < 10; i++)
+            sps_insert(set, i * 10);
+
+        size_t sum = 0;
+
+        for (sps_iter_init(&iter, set); !sps_iter_end(&iter); sps_iter_next(&iter))
+            sum += sps_iter_value(&iter);
+
+        cmc_assert_equals(size_t, 450, sum);
+
+        for (sps_iter_to_end(&iter); !sps_iter_start(&iter); sps_iter_prev(&iter))
+            sum -= sps_iter_value(&iter);
+
+        cmc_assert_equals(size_t, 0, sum);
+
+        sps_free(set);
+    });
+
+    CMC_CREATE_TEST(sparsemap, {
+        struct sparsemap *map = spm_new(0);
+        double value = 0;
+
+        cmc_assert(spm_insert(map, 4, 4.0));
+        cmc_assert(spm_insert(map, 9, 9.0));
+        cmc_assert(spm_insert(map, 2, 2.0));
+        cmc_assert(!spm_insert(map, 9, 0.0));
+        cmc_assert_equals(size_t, 3, spm_count(map));
+
+        cmc_assert(spm_get(map, 9) == 9.0);
+        cmc_assert(spm_get(map, 5) == 0.0);
+        cmc_assert_equals(ptr, NULL, spm_get_ref(map, 5));
+
+        cmc_assert(spm_update(map, 4, 40.0, &value));
+        cmc_assert(value == 4.0);
+        cmc_assert(!spm_update(map, 5, 50.0, NULL));
+
+        cmc_assert(spm_remove(map, 4, &value));
+        cmc_assert(value == 40.0);
+        cmc_assert(!spm_contains(map, 4));
+
+        // Keys and values stay packed in the same order
+        bool paired = true;
+
+        for (size_t i = 0; i < spm_count(map); i++)
+            paired = paired && (double)spm_keys(map)[i] == spm_values(map)[i];
+
+        cmc_assert(paired);
+
+        struct sparsemap_iter iter;
+        double sum = 0;
+
+        for (spm_iter_init(&iter, map); !spm_iter_end(&iter); spm_iter_next(&iter))
+        {
+            *spm_iter_rvalue(&iter) *= 2;
+            sum += spm_iter_value(&iter) - spm_iter_key(&iter);
+        }
+
+        cmc_assert(sum == 11.0);
+        cmc_assert(spm_get(map, 2) == 4.0);
+
+        spm_clear(map, NULL);
+
+        cmc_assert(spm_empty(map));
+        cmc_assert(!spm_contains(map, 2));
+
+        spm_free(map, NULL);
+    });
+});
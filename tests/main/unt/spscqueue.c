@@ -0,0 +1,169 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <sac/spscqueue.h>
+
+SAC_SPSC_QUEUE_GENERATE(spsc, spscqueue, static, size_t, 16)
+
+#define SPSC_TOTAL 200000
+
+/* Aligned to the cache line size, so it is kept as a global */
+static spscqueue spsc_queue;
+
+/* Enqueues 0 to SPSC_TOTAL - 1 in order, alternating single pushes with */
+/* batches of 1 to 7 elements that often go across the end of the buffer */
+static void *spsc_producer_run(void *arg)
+{
+    spscqueue *q = arg;
+    size_t batch[7];
+    size_t next = 0;
+
+    for (size_t round = 0; next < SPSC_TOTAL; round++)
+    {
+        size_t pushed;
+
+        if (round % 2 == 0)
+            pushed = spsc_push(q, next) ? 1 : 0;
+        else
+        {
+            size_t size = round % 7 + 1;
+
+            if (size > SPSC_TOTAL - next)
+                size = SPSC_TOTAL - next;
+
+            for (size_t i = 0; i < size; i++)
+                batch[i] = next + i;
+
+            pushed = spsc_push_many(q, batch, size);
+        }
+
+        next += pushed;
+
+        if (pushed == 0)
+            sched_yield();
+    }
+
+    return NULL;
+}
+
+CMC_CREATE_UNIT(spscqueue_test, true, {
+    CMC_CREATE_TEST(init, {
+        spsc_init(&spsc_queue);
+
+        size_t value = 0;
+
+        cmc_assert_equals(size_t, 16, spsc_capacity());
+        cmc_assert_equals(size_t, 0, spsc_count(&spsc_queue));
+        cmc_assert(spsc_empty(&spsc_queue));
+        cmc_assert(!spsc_pop(&spsc_queue, &value));
+        cmc_assert(!spsc_peek(&spsc_queue, &value));
+        cmc_assert_equals(size_t, 0, spsc_pop_many(&spsc_queue, &value, 1));
+    });
+
+    CMC_CREATE_TEST(full empty, {
+        spsc_init(&spsc_queue);
+
+        size_t elements[20];
+        size_t result[20];
+        size_t value = 0;
+
+        /* Several turns around the buffer, starting at a different position */
+        /* each time */
+        for (size_t turn = 0; turn < 5; turn++)
+        {
+            for (size_t i = 0; i < 16; i++)
+                cmc_assert(spsc_push(&spsc_queue, turn * 100 + i));
+
+            cmc_assert_equals(size_t, 16, spsc_count(&spsc_queue));
+            cmc_assert(!spsc_push(&spsc_queue, 0));
+            cmc_assert_equals(size_t, 0, spsc_push_many(&spsc_queue, elements, 3));
+
+            cmc_assert(spsc_peek(&spsc_queue, &value));
+            cmc_assert_equals(size_t, turn * 100, value);
+
+            for (size_t i = 0; i < 16; i++)
+            {
+                cmc_assert(spsc_pop(&spsc_queue, &value));
+                cmc_assert_equals(size_t, turn * 100 + i, value);
+            }
+
+            cmc_assert(spsc_empty(&spsc_queue));
+            cmc_assert(!spsc_pop(&spsc_queue, &value));
+            cmc_assert(!spsc_peek(&spsc_queue, &value));
+
+            cmc_assert(spsc_push(&spsc_queue, turn));
+            cmc_assert(spsc_pop(&spsc_queue, &value));
+            cmc_assert_equals(size_t, turn, value);
+        }
+
+        /* Batches go across the end of the buffer, which starts at 5, and */
+        /* are cut to the space left */
+        for (size_t i = 0; i < 20; i++)
+            elements[i] = i;
+
+        cmc_assert_equals(size_t, 10, spsc_push_many(&spsc_queue, elements, 10));
+        cmc_assert_equals(size_t, 6, spsc_pop_many(&spsc_queue, result, 6));
+
+        for (size_t i = 0; i < 6; i++)
+            cmc_assert_equals(size_t, i, result[i]);
+
+        cmc_assert_equals(size_t, 10, spsc_push_many(&spsc_queue, elements + 10, 10));
+        cmc_assert_equals(size_t, 2, spsc_push_many(&spsc_queue, elements, 5));
+        cmc_assert_equals(size_t, 16, spsc_count(&spsc_queue));
+        cmc_assert_equals(size_t, 16, spsc_pop_many(&spsc_queue, result, 20));
+
+        for (size_t i = 0; i < 14; i++)
+            cmc_assert_equals(size_t, i + 6, result[i]);
+
+        cmc_assert_equals(size_t, 0, result[14]);
+        cmc_assert_equals(size_t, 1, result[15]);
+
+        cmc_assert(spsc_empty(&spsc_queue));
+        cmc_assert_equals(size_t, 0, spsc_pop_many(&spsc_queue, result, 20));
+    });
+
+    CMC_CREATE_TEST(threads, {
+        spsc_init(&spsc_queue);
+
+        pthread_t producer;
+
+        cmc_assert_equals(int32_t, 0,
+                          pthread_create(&producer, NULL, spsc_producer_run, &spsc_queue));
+
+        /* Dequeues alternating single pops with batches of 1 to 9 elements, */
+        /* checking that every element comes out once and in order */
+        size_t elements[9];
+        size_t expected = 0;
+        size_t errors = 0;
+
+        for (size_t round = 0; expected < SPSC_TOTAL; round++)
+        {
+            size_t popped;
+
+            if (round % 2 == 0)
+                popped = spsc_pop(&spsc_queue, elements) ? 1 : 0;
+            else
+                popped = spsc_pop_many(&spsc_queue, elements, round % 9 + 1);
+
+            for (size_t i = 0; i < popped; i++)
+            {
+                if (elements[i] != expected++)
+                    errors++;
+            }
+
+            if (popped == 0)
+                sched_yield();
+        }
+
+        pthread_join(producer, NULL);
+
+        cmc_assert_equals(size_t, 0, errors);
+        cmc_assert_equals(size_t, SPSC_TOTAL, expected);
+        cmc_assert(spsc_empty(&spsc_queue));
+    });
+});
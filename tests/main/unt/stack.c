@@ -7,6 +7,11 @@
 
 CMC_GENERATE_STACK(s, stack, size_t)
 
+static bool s_is_odd(size_t x)
+{
+    return x % 2 == 1;
+}
+
 CMC_CREATE_UNIT(stack_test, true, {
     CMC_CREATE_TEST(new, {
         struct stack *s = s_new(1000000);
@@ -20,6 +25,23 @@ CMC_CREATE_UNIT(stack_test, true, {
         s_free(s, NULL);
     });
 
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct stack *s = s_new_custom(100, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, s);
+
+        for (size_t i = 0; i < 1000; i++)
+            s_push(s, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        s_free(s, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
     CMC_CREATE_TEST(new[capacity = 0], {
         struct stack *s = s_new(0);
 
@@ -596,4 +618,59 @@ CMC_CREATE_UNIT(stack_test, true, {
 
         s_free(s, NULL);
     });
+
+    CMC_CREATE_TEST(new_from, {
+        size_t elements[100];
+
+        for (size_t i = 0; i < 100; i++)
+            elements[i] = i;
+
+        struct stack *s = s_new_from(elements, 100);
+
+        cmc_assert_not_equals(ptr, NULL, s);
+        cmc_assert_equals(size_t, 100, s_count(s));
+        cmc_assert_equals(size_t, 99, s_top(s));
+
+        s_free(s, NULL);
+
+        cmc_assert_equals(ptr, NULL, s_new_from(elements, 0));
+    });
+
+    CMC_CREATE_TEST(to_array, {
+        struct stack *s = s_new(100);
+
+        for (size_t i = 0; i < 50; i++)
+            s_push(s, i);
+
+        size_t elements[50] = { 0 };
+
+        cmc_assert_equals(size_t, 10, s_to_array(s, elements, 10));
+        cmc_assert_equals(size_t, 50, s_to_array(s, elements, 100));
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert_equals(size_t, i, elements[i]);
+
+        s_free(s, NULL);
+    });
+
+    CMC_CREATE_TEST(remove_if, {
+        struct stack *s = s_new(100);
+
+        for (size_t i = 0; i < 100; i++)
+            s_push(s, i);
+
+        cmc_assert_equals(size_t, 50, s_remove_if(s, s_is_odd, NULL));
+        cmc_assert_equals(size_t, 50, s_count(s));
+        cmc_assert_equals(size_t, 0, s_remove_if(s, s_is_odd, NULL));
+
+        for (size_t i = 0; i < 50; i++)
+        {
+            cmc_assert_equals(size_t, 98 - i * 2, s_top(s));
+            cmc_assert(s_pop(s));
+        }
+
+        cmc_assert(s_empty(s));
+
+        s_free(s, NULL);
+    });
 });
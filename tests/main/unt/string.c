@@ -0,0 +1,87 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/list.h>
+#include <cmc/treemap.h>
+#include <utl/cmc_string.h>
+
+CMC_GENERATE_LIST(str_l, string_list, size_t)
+CMC_GENERATE_TREEMAP(str_tm, string_treemap, size_t, size_t)
+
+CMC_CREATE_UNIT(string_test, true, {
+    CMC_CREATE_TEST(builder, {
+        struct cmc_string_builder builder;
+
+        cmc_string_builder_init(&builder);
+
+        cmc_assert_equals(int32_t, 0, strcmp("", cmc_string_builder_str(&builder)));
+        cmc_assert(cmc_string_builder_puts(&builder, "abc"));
+        cmc_assert(cmc_string_builder_putc(&builder, '-'));
+        cmc_assert(cmc_string_builder_printf(&builder, "%d:%s", 42, "x"));
+        cmc_assert_equals(size_t, 8, builder.length);
+        cmc_assert_equals(int32_t, 0, strcmp("abc-42:x", cmc_string_builder_str(&builder)));
+
+        /* Cleared builders keep their buffer */
+        char *buffer = builder.buffer;
+
+        cmc_string_builder_clear(&builder);
+        cmc_assert_equals(size_t, 0, builder.length);
+        cmc_assert(cmc_string_builder_puts(&builder, "y"));
+        cmc_assert(builder.buffer == buffer);
+        cmc_assert_equals(int32_t, 0, strcmp("y", cmc_string_builder_str(&builder)));
+
+        cmc_string_builder_release(&builder);
+        cmc_assert(builder.buffer == NULL);
+    });
+
+    CMC_CREATE_TEST(builder[grow], {
+        struct cmc_string_builder builder;
+
+        cmc_string_builder_init(&builder);
+
+        /* Formatted strings longer than the free space are formatted again */
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(cmc_string_builder_printf(&builder, "%0*d", 100, 7));
+
+        cmc_assert_equals(size_t, 100000, builder.length);
+        cmc_assert_equals(size_t, 100000, strlen(cmc_string_builder_str(&builder)));
+        cmc_assert_equals(int32_t, '7', builder.buffer[99999]);
+        cmc_assert_equals(int32_t, '0', builder.buffer[99998]);
+
+        cmc_string_builder_release(&builder);
+    });
+
+    CMC_CREATE_TEST(to_string_full, {
+        struct string_list *list = str_l_new(100);
+        struct string_treemap *map = str_tm_new(cmp);
+        struct cmc_string_builder builder;
+
+        cmc_string_builder_init(&builder);
+
+        cmc_assert(str_l_to_string_full(list, &builder, "%zu"));
+        cmc_assert_equals(int32_t, 0, strcmp("[]", cmc_string_builder_str(&builder)));
+
+        for (size_t i = 1; i <= 3; i++)
+        {
+            str_l_push_back(list, i);
+            str_tm_insert(map, i, i * 10);
+        }
+
+        cmc_string_builder_clear(&builder);
+        cmc_assert(str_l_to_string_full(list, &builder, "%zu"));
+        cmc_assert_equals(int32_t, 0, strcmp("[ 1, 2, 3 ]", cmc_string_builder_str(&builder)));
+
+        /* Appended to what is already in the builder */
+        cmc_assert(cmc_string_builder_puts(&builder, " "));
+        cmc_assert(str_tm_to_string_full(map, &builder, "%zu:%zu"));
+        cmc_assert_equals(int32_t, 0,
+                          strcmp("[ 1, 2, 3 ] [ 1:10, 2:20, 3:30 ]",
+                                 cmc_string_builder_str(&builder)));
+
+        cmc_string_builder_release(&builder);
+        str_l_free(list, NULL);
+        str_tm_free(map, NULL);
+    });
+});
@@ -0,0 +1,445 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/swissmap.h>
+
+CMC_GENERATE_SWISSMAP(sm, swissmap, size_t, size_t)
+
+CMC_CREATE_UNIT(swissmap_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct swissmap *map = sm_new(943722, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+        cmc_assert_not_equals(ptr, NULL, map->buffer);
+        cmc_assert_not_equals(ptr, NULL, map->ctrl);
+        cmc_assert_equals(size_t, 0, sm_count(map));
+        cmc_assert_greater_equals(size_t, (943722 / 0.6), sm_capacity(map));
+
+        sm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct swissmap *map = sm_new_custom(100, 0.6, cmp, hash, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            sm_insert(map, i, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        sm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(new[capacity = 0], {
+        struct swissmap *map = sm_new(0, 0.6, cmp, hash);
+
+        cmc_assert_equals(ptr, NULL, map);
+    });
+
+    CMC_CREATE_TEST(new[capacity = UINT64_MAX], {
+        struct swissmap *map = sm_new(UINT64_MAX, 0.99, cmp, hash);
+
+        cmc_assert_equals(ptr, NULL, map);
+    });
+
+    CMC_CREATE_TEST(clear[count capacity], {
+        struct swissmap *map = sm_new(100, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 50; i++)
+            sm_insert(map, i, i);
+
+        cmc_assert_equals(size_t, 50, sm_count(map));
+
+        sm_clear(map, NULL);
+
+        cmc_assert_equals(size_t, 0, sm_count(map));
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert(!sm_contains(map, i));
+
+        sm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(insert, {
+        struct swissmap *map = sm_new(100, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        cmc_assert(sm_insert(map, 1, 1));
+        cmc_assert_equals(size_t, 1, sm_count(map));
+
+        cmc_assert(!sm_insert(map, 1, 2));
+        cmc_assert_equals(size_t, 1, sm_count(map));
+
+        sm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(insert[smallest capacity], {
+        struct swissmap *map = sm_new(1, 0.99, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        cmc_assert_equals(size_t, 64, sm_capacity(map));
+        cmc_assert(sm_insert(map, 1, 1));
+
+        sm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(insert[collisions], {
+        // Every key has the same hash and the same control tag
+        struct swissmap *map = sm_new(500, 0.6, cmp, hash0);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 200; i++)
+            cmc_assert(sm_insert(map, i, i));
+
+        for (size_t i = 0; i < 200; i++)
+            cmc_assert_equals(size_t, i, sm_get(map, i));
+
+        cmc_assert(!sm_contains(map, 200));
+
+        sm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(insert[buffer growth and item preservation], {
+        struct swissmap *map = sm_new(1, 0.99, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        cmc_assert_equals(size_t, 64, sm_capacity(map));
+
+        for (size_t i = 0; i < 100000; i++)
+            cmc_assert(sm_insert(map, i, i));
+
+        size_t capacity = sm_capacity(map);
+
+        cmc_assert_equals(size_t, 0, capacity & (capacity - 1));
+        cmc_assert_greater_equals(size_t, 100000, capacity);
+
+        for (size_t i = 0; i < 100000; i++)
+            cmc_assert(sm_contains(map, i));
+
+        sm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(update, {
+        struct swissmap *map = sm_new(100, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        cmc_assert(sm_insert(map, 1, 1));
+
+        size_t old;
+        cmc_assert(sm_update(map, 1, 2, &old));
+
+        cmc_assert_equals(size_t, 1, old);
+        cmc_assert_equals(size_t, 2, sm_get(map, 1));
+
+        cmc_assert(!sm_update(map, 120, 120, NULL));
+
+        sm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(remove, {
+        struct swissmap *map = sm_new(100, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(sm_insert(map, i, i));
+
+        for (size_t i = 100; i < 200; i++)
+            cmc_assert(!sm_remove(map, i, NULL));
+
+        size_t out;
+        for (size_t i = 0; i < 100; i++)
+        {
+            cmc_assert(sm_remove(map, i, &out));
+            cmc_assert_equals(size_t, i, out);
+        }
+
+        cmc_assert(sm_empty(map));
+
+        sm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(remove[collisions], {
+        struct swissmap *map = sm_new(500, 0.6, cmp, hash0);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 200; i++)
+            cmc_assert(sm_insert(map, i, i));
+
+        // Removing keys from the middle of a long probe sequence must not
+        // cut it short for the keys after them
+        for (size_t i = 0; i < 200; i += 2)
+            cmc_assert(sm_remove(map, i, NULL));
+
+        for (size_t i = 0; i < 200; i++)
+            cmc_assert_equals(bool, i % 2 == 1, sm_contains(map, i));
+
+        sm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(remove[churn], {
+        struct swissmap *map = sm_new(1000, 0.8, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        size_t capacity = sm_capacity(map);
+
+        // A sliding window of keys, deleted slots have to be reclaimed
+        // without the table growing
+        for (size_t i = 0; i < 100000; i++)
+        {
+            cmc_assert(sm_insert(map, i, i));
+
+            if (i >= 500)
+                cmc_assert(sm_remove(map, i - 500, NULL));
+        }
+
+        cmc_assert_equals(size_t, 500, sm_count(map));
+        cmc_assert_equals(size_t, capacity, sm_capacity(map));
+
+        for (size_t i = 100000 - 500; i < 100000; i++)
+            cmc_assert(sm_contains(map, i));
+
+        cmc_assert(!sm_contains(map, 100000 - 501));
+
+        sm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(max min, {
+        struct swissmap *map = sm_new(100, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        cmc_assert(!sm_max(map, NULL, NULL));
+        cmc_assert(!sm_min(map, NULL, NULL));
+
+        for (size_t i = 1; i <= 100; i++)
+            cmc_assert(sm_insert(map, i, i));
+
+        size_t key;
+        size_t val;
+        cmc_assert(sm_max(map, &key, &val));
+
+        cmc_assert_equals(size_t, 100, key);
+        cmc_assert_equals(size_t, 100, val);
+
+        cmc_assert(sm_min(map, &key, &val));
+
+        cmc_assert_equals(size_t, 1, key);
+        cmc_assert_equals(size_t, 1, val);
+
+        sm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(get_ref, {
+        struct swissmap *map = sm_new(100, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        cmc_assert_equals(ptr, NULL, sm_get_ref(map, 4321));
+
+        cmc_assert(sm_insert(map, 4321, 1234));
+
+        size_t *result = sm_get_ref(map, 4321);
+
+        cmc_assert_not_equals(ptr, NULL, result);
+        cmc_assert_equals(size_t, 1234, *result);
+
+        sm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(contains[sum], {
+        struct swissmap *map = sm_new(100, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 101; i <= 200; i++)
+            cmc_assert(sm_insert(map, i, i));
+
+        size_t sum = 0;
+        for (size_t i = 1; i <= 300; i++)
+            if (sm_contains(map, i))
+                sum += i;
+
+        cmc_assert_equals(size_t, 15050, sum);
+
+        sm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(full, {
+        struct swissmap *map = sm_new(64, 0.5, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        size_t capacity = sm_capacity(map);
+
+        for (size_t i = 0; !sm_full(map); i++)
+            cmc_assert(sm_insert(map, i, i));
+
+        cmc_assert(sm_insert(map, 10000, 10000));
+
+        cmc_assert_equals(size_t, capacity * 2, sm_capacity(map));
+
+        cmc_assert(!sm_full(map));
+
+        sm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(stats, {
+        struct swissmap *map = sm_new(1000, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        // Less keys than a group can hold are never displaced
+        for (size_t i = 0; i < CMC_SWISS_GROUP - 1; i++)
+            cmc_assert(sm_insert(map, i, i));
+
+        struct cmc_hashtable_stats stats;
+
+        sm_stats(map, &stats);
+
+        cmc_assert_equals(size_t, sm_capacity(map), stats.capacity);
+        cmc_assert_equals(size_t, CMC_SWISS_GROUP - 1, stats.count);
+        cmc_assert_equals(size_t, CMC_SWISS_GROUP - 1, stats.histogram[0]);
+        cmc_assert_equals(size_t, 0, stats.max_dist);
+
+        cmc_assert(sm_remove(map, 0, NULL));
+
+        sm_stats(map, &stats);
+
+        cmc_assert_equals(size_t, map->deleted, stats.tombstones);
+        cmc_assert_equals(size_t, CMC_SWISS_GROUP - 2, stats.histogram[0]);
+
+        sm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(stats[collisions], {
+        struct swissmap *map = sm_new(1000, 0.6, cmp, hash0);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < CMC_SWISS_GROUP * 3; i++)
+            cmc_assert(sm_insert(map, i, i));
+
+        struct cmc_hashtable_stats stats;
+
+        sm_stats(map, &stats);
+
+        // One group is filled after the other
+        cmc_assert_equals(size_t, 2, stats.max_dist);
+        cmc_assert_equals(size_t, CMC_SWISS_GROUP, stats.histogram[0]);
+        cmc_assert_equals(size_t, CMC_SWISS_GROUP, stats.histogram[1]);
+        cmc_assert_equals(size_t, CMC_SWISS_GROUP, stats.histogram[2]);
+
+        sm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(copy_of, {
+        struct swissmap *map = sm_new(100, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(sm_insert(map, i, i));
+
+        struct swissmap *copy = sm_copy_of(map, NULL, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, copy);
+        cmc_assert_equals(size_t, sm_count(map), sm_count(copy));
+        cmc_assert(sm_equals(map, copy, cmp));
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert_equals(size_t, i, sm_get(copy, i));
+
+        sm_free(map, NULL);
+        sm_free(copy, NULL);
+    });
+
+    CMC_CREATE_TEST(iter, {
+        struct swissmap *map = sm_new(100, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 1; i <= 1000; i++)
+            cmc_assert(sm_insert(map, i, i));
+
+        size_t sum = 0;
+        size_t total = 0;
+        struct swissmap_iter iter;
+
+        for (sm_iter_init(&iter, map); !sm_iter_end(&iter); sm_iter_next(&iter))
+        {
+            sum += sm_iter_key(&iter);
+            total++;
+        }
+
+        cmc_assert_equals(size_t, 1000, total);
+        cmc_assert_equals(size_t, 500500, sum);
+
+        sum = 0;
+        total = 0;
+
+        for (sm_iter_to_end(&iter); !sm_iter_start(&iter); sm_iter_prev(&iter))
+        {
+            sum += sm_iter_value(&iter);
+            total++;
+        }
+
+        cmc_assert_equals(size_t, 1000, total);
+        cmc_assert_equals(size_t, 500500, sum);
+
+        sm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(save restore, {
+        struct swissmap *map = sm_new(100, 0.6, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(sm_insert(map, i, i));
+
+        for (size_t i = 0; i < 1000; i += 2)
+            cmc_assert(sm_remove(map, i, NULL));
+
+        FILE *file = tmpfile();
+
+        cmc_assert_not_equals(ptr, NULL, file);
+
+        cmc_assert(sm_save(map, file, NULL, NULL));
+        cmc_assert(sm_save(map, file, write_size, NULL));
+
+        rewind(file);
+
+        for (size_t k = 0; k < 2; k++)
+        {
+            struct swissmap *r = sm_restore(file, cmp, hash, read_size, NULL);
+
+            cmc_assert_not_equals(ptr, NULL, r);
+            cmc_assert_equals(size_t, 500, sm_count(r));
+
+            for (size_t i = 0; i < 1000; i++)
+                cmc_assert_equals(bool, i % 2 != 0, sm_contains(r, i));
+
+            sm_free(r, NULL);
+        }
+
+        fclose(file);
+        sm_free(map, NULL);
+    });
+});
@@ -0,0 +1,198 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/hashmap.h>
+#include <cmc/list.h>
+#include <cmc/stack.h>
+#include <utl/sync.h>
+
+CMC_GENERATE_HASHMAP(syh, sync_hashmap, size_t, size_t)
+CMC_GENERATE_LIST(syl, sync_list, size_t)
+CMC_GENERATE_STACK(sys, sync_stack, size_t)
+
+CMC_GENERATE_SYNC(HASHMAP, syh, sync_hashmap, size_t, size_t)
+CMC_GENERATE_SYNC(LIST, syl, sync_list, , size_t)
+CMC_GENERATE_SYNC(STACK, sys, sync_stack, , size_t)
+
+CMC_GENERATE_SYNC_READ(syh, sync_hashmap, size_t, capacity, (), ())
+
+struct sync_worker
+{
+    struct sync_hashmap_sync *map;
+    size_t start;
+    size_t end;
+};
+
+static void *sync_worker_insert(void *arg)
+{
+    struct sync_worker *worker = arg;
+
+    for (size_t i = worker->start; i < worker->end; i++)
+        syh_sync_insert(worker->map, i, i * 2);
+
+    /* Readers run alongside the other writers */
+    for (size_t i = worker->start; i < worker->end; i++)
+        syh_sync_get(worker->map, i);
+
+    for (size_t i = worker->start + 1; i < worker->end; i += 2)
+        syh_sync_remove(worker->map, i, NULL);
+
+    return NULL;
+}
+
+static void sync_sum(struct sync_hashmap *map, void *data)
+{
+    size_t *sum = data;
+    struct sync_hashmap_iter iter;
+
+    for (syh_iter_init(&iter, map); !syh_iter_end(&iter); syh_iter_next(&iter))
+        *sum += syh_iter_value(&iter);
+}
+
+static void sync_clear(struct sync_hashmap *map, void *data)
+{
+    syh_clear(map, NULL);
+}
+
+static bool sync_push_back(struct sync_list *list, void *item)
+{
+    return syl_push_back(list, *(size_t *)item);
+}
+
+static bool sync_is_even(struct sync_list *list, void *item)
+{
+    return syl_get(list, *(size_t *)item) % 2 == 0;
+}
+
+CMC_CREATE_UNIT(sync_test, true, {
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct sync_hashmap *inner = syh_new(100, 0.6, cmp, hash);
+        struct sync_hashmap_sync *map = syh_sync_new_custom(inner, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+        cmc_assert_equals(size_t, 1, count_alloc_live);
+
+        syh_free(syh_sync_free(map), NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+        cmc_assert_equals(ptr, NULL, syh_sync_new(NULL));
+    });
+
+    CMC_CREATE_TEST(hashmap, {
+        struct sync_hashmap_sync *map = syh_sync_new(syh_new(100, 0.6, cmp, hash));
+
+        cmc_assert(syh_sync_empty(map));
+        cmc_assert(syh_sync_insert(map, 1, 10));
+        cmc_assert(!syh_sync_insert(map, 1, 11));
+        cmc_assert(syh_sync_contains(map, 1));
+        cmc_assert_equals(size_t, 10, syh_sync_get(map, 1));
+        cmc_assert_greater_equals(size_t, 100, syh_sync_capacity(map));
+
+        size_t old = 0;
+
+        cmc_assert(syh_sync_update(map, 1, 12, &old));
+        cmc_assert_equals(size_t, 10, old);
+        cmc_assert(syh_sync_remove(map, 1, &old));
+        cmc_assert_equals(size_t, 12, old);
+        cmc_assert_equals(size_t, 0, syh_sync_count(map));
+
+        size_t keys[4];
+        size_t values[4];
+
+        /* The last key is a duplicate of the second */
+        for (size_t i = 0; i < 4; i++)
+        {
+            keys[i] = i == 3 ? 2 : i + 1;
+            values[i] = (i + 1) * 10;
+        }
+
+        cmc_assert_equals(size_t, 3, syh_sync_insert_all(map, keys, values, 4));
+
+        keys[3] = 4;
+
+        cmc_assert_equals(size_t, 3, syh_sync_get_all(map, keys, values, 4));
+        cmc_assert_equals(size_t, 20, values[1]);
+        cmc_assert_equals(size_t, 0, values[3]);
+
+        size_t sum = 0;
+
+        syh_sync_read(map, sync_sum, &sum);
+
+        cmc_assert_equals(size_t, 60, sum);
+
+        syh_sync_write(map, sync_clear, NULL);
+
+        cmc_assert(syh_sync_empty(map));
+
+        syh_free(syh_sync_free(map), NULL);
+    });
+
+    CMC_CREATE_TEST(hashmap[threads], {
+        struct sync_hashmap_sync *map = syh_sync_new(syh_new(100, 0.6, cmp, hash));
+        struct sync_worker workers[4];
+        pthread_t threads[4];
+
+        for (size_t i = 0; i < 4; i++)
+        {
+            workers[i].map = map;
+            workers[i].start = i * 1000;
+            workers[i].end = (i + 1) * 1000;
+
+            pthread_create(&threads[i], NULL, sync_worker_insert, &workers[i]);
+        }
+
+        for (size_t i = 0; i < 4; i++)
+            pthread_join(threads[i], NULL);
+
+        cmc_assert_equals(size_t, 2000, syh_sync_count(map));
+
+        bool kept = true;
+
+        for (size_t i = 0; i < 4000; i++)
+            kept = kept && syh_sync_contains(map, i) == (i % 2 == 0);
+
+        cmc_assert(kept);
+
+        syh_free(syh_sync_free(map), NULL);
+    });
+
+    CMC_CREATE_TEST(lock_and_apply, {
+        struct sync_list_sync *list = syl_sync_new(syl_new(10));
+        size_t items[100];
+
+        for (size_t i = 0; i < 100; i++)
+            items[i] = i;
+
+        size_t pushed = syl_sync_lock_and_apply(list, sync_push_back, items, sizeof(size_t), 100);
+        size_t even = syl_sync_lock_and_apply_shared(list, sync_is_even, items, sizeof(size_t), 100);
+
+        cmc_assert_equals(size_t, 100, pushed);
+        cmc_assert_equals(size_t, 50, even);
+
+        cmc_assert(syl_sync_push_front(list, 1000));
+        cmc_assert_equals(size_t, 1000, syl_sync_front(list));
+        cmc_assert_equals(size_t, 99, syl_sync_back(list));
+        cmc_assert(syl_sync_pop_back(list));
+        cmc_assert_equals(size_t, 100, syl_sync_count(list));
+        cmc_assert_equals(size_t, 0, syl_sync_get(list, 1));
+
+        syl_free(syl_sync_free(list), NULL);
+    });
+
+    CMC_CREATE_TEST(stack, {
+        struct sync_stack_sync *stack = sys_sync_new(sys_new(10));
+
+        cmc_assert(sys_sync_push(stack, 1));
+        cmc_assert(sys_sync_push(stack, 2));
+        cmc_assert_equals(size_t, 2, sys_sync_top(stack));
+        cmc_assert(sys_sync_pop(stack));
+        cmc_assert_equals(size_t, 1, sys_sync_top(stack));
+        cmc_assert(!sys_sync_empty(stack));
+
+        sys_free(sys_sync_free(stack), NULL);
+    });
+});
@@ -0,0 +1,72 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <utl/timer.h>
+
+/* Waits for at least the given nanoseconds */
+static void tmr_wait(uint64_t nanoseconds)
+{
+    uint64_t start = cmc_timer_now();
+
+    while (cmc_timer_now() - start < nanoseconds)
+        ;
+}
+
+CMC_CREATE_UNIT(timer_test, true, {
+    CMC_CREATE_TEST(calc, {
+        struct cmc_timer timer = { 0 };
+
+        cmc_timer_start(timer);
+        tmr_wait(2000000);
+        cmc_timer_stop(timer);
+        cmc_timer_calc(timer);
+
+        cmc_assert_greater_equals(uint64_t, 2000000, timer.elapsed);
+        cmc_assert_greater_equals(double, 2.0, timer.result);
+        cmc_assert_equals(uint64_t, timer.stop - timer.start, timer.elapsed);
+    });
+
+    CMC_CREATE_TEST(resolution, {
+        /* Sub millisecond intervals are measured */
+        uint64_t start = cmc_timer_now();
+        uint64_t now = start;
+
+        while (now == start)
+            now = cmc_timer_now();
+
+        cmc_assert_lesser(uint64_t, 1000000, now - start);
+    });
+
+    CMC_CREATE_TEST(lap, {
+        struct cmc_timer timer = { 0 };
+        uint64_t sum = 0;
+
+        cmc_timer_start(timer);
+        uint64_t first = timer.start;
+
+        for (size_t i = 0; i < 3; i++)
+        {
+            tmr_wait(100000);
+            cmc_timer_lap(timer);
+            cmc_timer_accumulate(timer);
+
+            cmc_assert_greater_equals(uint64_t, 100000, timer.elapsed);
+            cmc_assert_equals(uint64_t, timer.stop, timer.start);
+            sum += timer.elapsed;
+        }
+
+        /* Laps are consecutive, so their sum is the whole time */
+        cmc_assert_equals(uint64_t, sum, timer.total);
+        cmc_assert_equals(uint64_t, timer.stop - first, timer.total);
+    });
+
+    CMC_CREATE_TEST(cycles, {
+        uint64_t start = cmc_timer_cycles();
+
+        tmr_wait(100000);
+
+        cmc_assert_greater(uint64_t, start, cmc_timer_cycles());
+    });
+});
@@ -0,0 +1,265 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/timerwheel.h>
+
+CMC_GENERATE_TIMERWHEEL(tw, timerwheel, size_t)
+
+/* Keeps the values fired and checks that their deadlines never go back */
+struct tw_fired
+{
+    struct timerwheel *wheel;
+    size_t values[4000];
+    size_t count;
+    size_t last;
+    bool ordered;
+};
+
+static void tw_record(size_t value, void *data)
+{
+    struct tw_fired *fired = data;
+
+    /* The values of these tests are their deadlines */
+    if (value < fired->last)
+        fired->ordered = false;
+
+    fired->last = value;
+    fired->values[fired->count++] = value;
+}
+
+/* Schedules another timer 100 ticks later while the first 100 fire */
+static void tw_chain(size_t value, void *data)
+{
+    struct tw_fired *fired = data;
+
+    fired->count++;
+
+    if (value < 100)
+        tw_schedule(fired->wheel, tw_now(fired->wheel) + 100, value + 1, NULL);
+}
+
+CMC_CREATE_UNIT(timerwheel_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct timerwheel *w = tw_new(1, 1000);
+
+        cmc_assert_not_equals(ptr, NULL, w);
+        cmc_assert(tw_empty(w));
+        cmc_assert_equals(uint64_t, 1000, tw_now(w));
+
+        uint64_t tick;
+
+        cmc_assert(!tw_next_tick(w, &tick));
+        cmc_assert_equals(size_t, 0, tw_advance(w, 5000, NULL, NULL));
+        cmc_assert_equals(uint64_t, 5000, tw_now(w));
+
+        tw_free(w, NULL);
+
+        cmc_assert_equals(ptr, NULL, tw_new(0, 0));
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct timerwheel *w = tw_new_custom(1, 1000, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, w);
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        tw_free(w, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(schedule advance, {
+        struct timerwheel *w = tw_new(1, 0);
+
+        cmc_assert_not_equals(ptr, NULL, w);
+
+        /* Deadlines spread over every level */
+        for (size_t i = 0; i < 3000; i++)
+        {
+            size_t deadline = ((i * 7919) % 3000) * ((i % 3 == 0) ? 1 : 1000003);
+
+            cmc_assert(tw_schedule(w, deadline, deadline, NULL));
+        }
+
+        cmc_assert_equals(size_t, 3000, tw_count(w));
+
+        struct tw_fired fired;
+
+        fired.count = 0;
+        fired.last = 0;
+        fired.ordered = true;
+
+        uint64_t tick;
+
+        cmc_assert(tw_next_tick(w, &tick));
+        cmc_assert_equals(uint64_t, 0, tick);
+
+        size_t total = 0;
+
+        for (uint64_t now = 0; now < 3000 * 1000003u; now += 999983)
+        {
+            total += tw_advance(w, now, tw_record, &fired);
+
+            for (size_t i = 0; i < fired.count; i++)
+                cmc_assert(fired.values[i] <= now);
+        }
+
+        total += tw_advance(w, 3000 * 1000003u, tw_record, &fired);
+
+        cmc_assert_equals(size_t, 3000, total);
+        cmc_assert_equals(size_t, 3000, fired.count);
+        cmc_assert(fired.ordered);
+        cmc_assert(tw_empty(w));
+
+        tw_free(w, NULL);
+    });
+
+    CMC_CREATE_TEST(cancel reschedule, {
+        struct timerwheel *w = tw_new(100, 50);
+
+        cmc_assert_not_equals(ptr, NULL, w);
+
+        size_t handles[100];
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(tw_schedule(w, 100 + i * 100, 100 + i * 100, &handles[i]));
+
+        size_t value;
+
+        for (size_t i = 0; i < 100; i += 2)
+        {
+            cmc_assert(tw_cancel(w, handles[i], &value));
+            cmc_assert_equals(size_t, 100 + i * 100, value);
+            cmc_assert(!tw_contains(w, handles[i]));
+            cmc_assert(!tw_cancel(w, handles[i], NULL));
+        }
+
+        /* The last timer goes first and a free handle is taken again */
+        cmc_assert(tw_reschedule(w, handles[99], 60));
+        cmc_assert_equals(uint64_t, 60, tw_deadline(w, handles[99]));
+
+        size_t handle;
+
+        cmc_assert(tw_schedule(w, 70, 70, &handle));
+        cmc_assert_equals(size_t, handles[98], handle);
+
+        struct tw_fired fired;
+
+        fired.count = 0;
+        fired.last = 0;
+        fired.ordered = true;
+
+        cmc_assert_equals(size_t, 2, tw_advance(w, 100, tw_record, &fired));
+        cmc_assert_equals(size_t, 10000, fired.values[0]);
+        cmc_assert_equals(size_t, 70, fired.values[1]);
+        cmc_assert(!tw_contains(w, handles[99]));
+        cmc_assert_equals(size_t, 49, tw_count(w));
+        cmc_assert_equals(size_t, 49, tw_advance(w, UINT64_MAX, NULL, NULL));
+
+        tw_free(w, NULL);
+    });
+
+    CMC_CREATE_TEST(callback schedules, {
+        struct timerwheel *w = tw_new(4, 0);
+
+        cmc_assert_not_equals(ptr, NULL, w);
+        cmc_assert(tw_schedule(w, 0, 0, NULL));
+
+        struct tw_fired fired;
+
+        fired.wheel = w;
+        fired.count = 0;
+
+        /* Each advance fires the timer scheduled by the callback before */
+        for (uint64_t now = 0; now <= 100 * 100; now += 100)
+            cmc_assert_equals(size_t, 1, tw_advance(w, now, tw_chain, &fired));
+
+        cmc_assert_equals(size_t, 101, fired.count);
+        cmc_assert(tw_empty(w));
+
+        tw_free(w, NULL);
+    });
+
+    CMC_CREATE_TEST(random, {
+        struct timerwheel *w = tw_new(16, 12345);
+
+        cmc_assert_not_equals(ptr, NULL, w);
+
+        /* Deadline of each handle or 0 if it is not scheduled */
+        uint64_t expected[512];
+
+        for (size_t i = 0; i < 512; i++)
+            expected[i] = 0;
+
+        struct tw_fired fired;
+
+        fired.count = 0;
+
+        size_t x = 7;
+
+        for (size_t i = 0; i < 20000; i++)
+        {
+            x = x * 6364136223846793005u + 1442695040888963407u;
+
+            size_t r = x >> 20;
+            size_t handle = r % 512;
+            uint64_t now = tw_now(w);
+            uint64_t deadline = now + 1 + (r % 4 == 0 ? r % (1u << 30) : r % 5000);
+
+            if (r % 7 < 3 && tw_count(w) < 512)
+            {
+                cmc_assert(tw_schedule(w, deadline, deadline, &handle));
+                expected[handle] = deadline;
+            }
+            else if (r % 7 < 4)
+            {
+                cmc_assert_equals(bool, expected[handle] != 0, tw_cancel(w, handle, NULL));
+                expected[handle] = 0;
+            }
+            else if (r % 7 < 5)
+            {
+                bool moved = tw_reschedule(w, handle, deadline);
+
+                cmc_assert_equals(bool, expected[handle] != 0, moved);
+
+                if (moved)
+                    expected[handle] = deadline;
+            }
+            else
+            {
+                now += r % 3000;
+                fired.count = 0;
+                fired.last = 0;
+                fired.ordered = true;
+
+                size_t due = 0;
+
+                for (size_t k = 0; k < 512; k++)
+                {
+                    if (expected[k] != 0 && expected[k] <= now)
+                    {
+                        due++;
+                        expected[k] = 0;
+                    }
+                }
+
+                /* A value is the first deadline of its timer, not the current one */
+                cmc_assert_equals(size_t, due, tw_advance(w, now, tw_record, &fired));
+            }
+        }
+
+        for (size_t k = 0; k < 512; k++)
+        {
+            cmc_assert_equals(bool, expected[k] != 0, tw_contains(w, k));
+
+            if (expected[k] != 0)
+                cmc_assert_equals(uint64_t, expected[k], tw_deadline(w, k));
+        }
+
+        tw_free(w, NULL);
+    });
+});
@@ -0,0 +1,118 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/topk.h>
+
+CMC_GENERATE_TOPK(tpk, topk, size_t)
+
+/* Sorted counters from the least count up */
+static bool tpk_sorted(struct topk *t)
+{
+    for (size_t i = 1; i < t->k; i++)
+    {
+        if (t->counters[t->order[i - 1]].count > t->counters[t->order[i]].count)
+            return false;
+    }
+
+    return true;
+}
+
+CMC_CREATE_UNIT(topk_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct topk *t = tpk_new(10, cmp, hash);
+
+        cmc_assert_not_equals(ptr, NULL, t);
+        cmc_assert_equals(size_t, 10, tpk_k(t));
+        cmc_assert(tpk_empty(t));
+
+        tpk_free(t, NULL);
+
+        cmc_assert_equals(ptr, NULL, tpk_new(0, cmp, hash));
+    });
+
+    CMC_CREATE_TEST(exact under k, {
+        struct topk *t = tpk_new(10, cmp, hash);
+
+        for (size_t i = 0; i < 5; i++)
+        {
+            for (size_t j = 0; j <= i; j++)
+                cmc_assert(tpk_insert(t, i, NULL));
+        }
+
+        cmc_assert_equals(size_t, 5, tpk_count(t));
+        cmc_assert_equals(size_t, 15, tpk_total(t));
+        cmc_assert(tpk_sorted(t));
+
+        size_t values[10];
+        size_t counts[10];
+        size_t errors[10];
+
+        cmc_assert_equals(size_t, 5, tpk_top(t, 10, values, counts, errors));
+
+        bool exact = true;
+
+        for (size_t i = 0; i < 5; i++)
+        {
+            exact = exact && values[i] == 4 - i;
+            exact = exact && counts[i] == 5 - i;
+            exact = exact && errors[i] == 0;
+        }
+
+        cmc_assert(exact);
+        cmc_assert_equals(size_t, 2, tpk_top(t, 2, values, NULL, NULL));
+        cmc_assert_equals(size_t, 3, values[1]);
+        cmc_assert_equals(size_t, 0, tpk_count_of(t, 5));
+
+        tpk_free(t, NULL);
+    });
+
+    CMC_CREATE_TEST(heavy hitters[count allocations], {
+        count_alloc_reset();
+
+        struct topk *t = tpk_new_custom(8, cmp, hash, &count_alloc);
+        size_t live = count_alloc_live;
+
+        // Three elements take half of a stream of many distinct ones
+        for (size_t i = 0; i < 30000; i++)
+        {
+            if (i % 2 == 0)
+                tpk_insert(t, i % 6 / 2, NULL);
+            else
+                tpk_insert(t, 1000 + i, NULL);
+        }
+
+        cmc_assert_equals(size_t, live, count_alloc_live);
+        cmc_assert_equals(size_t, 8, tpk_count(t));
+        cmc_assert(tpk_sorted(t));
+
+        size_t values[3];
+        size_t counts[3];
+        size_t errors[3];
+
+        cmc_assert_equals(size_t, 3, tpk_top(t, 3, values, counts, errors));
+
+        bool found = true;
+
+        for (size_t i = 0; i < 3; i++)
+        {
+            found = found && values[i] < 3;
+            found = found && counts[i] >= 5000 && counts[i] - errors[i] <= 5000;
+        }
+
+        cmc_assert(found);
+        cmc_assert(tpk_contains(t, 2));
+        cmc_assert_greater_equals(size_t, 5000, tpk_count_of(t, 0));
+
+        tpk_clear(t, NULL);
+
+        cmc_assert(tpk_empty(t));
+        cmc_assert_equals(size_t, 0, tpk_total(t));
+        cmc_assert(!tpk_contains(t, 2));
+
+        tpk_free(t, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+});
@@ -7,6 +7,29 @@
 
 CMC_GENERATE_TREEMAP(tm, treemap, size_t, size_t)
 
+static size_t tm_finger_compares = 0;
+
+static int tm_finger_cmp(size_t a, size_t b)
+{
+    tm_finger_compares++;
+
+    return cmp(a, b);
+}
+
+static size_t tm_dealloc_calls = 0;
+static size_t tm_dealloc_sum = 0;
+
+static void tm_dealloc(size_t key, size_t value)
+{
+    tm_dealloc_calls++;
+    tm_dealloc_sum += key;
+}
+
+static bool tm_odd_key(size_t key, size_t value)
+{
+    return key % 2 == 1;
+}
+
 CMC_CREATE_UNIT(treemap_test, true, {
     CMC_CREATE_TEST(new, {
         struct treemap *map = tm_new(cmp);
@@ -16,6 +39,87 @@ CMC_CREATE_UNIT(treemap_test, true, {
         tm_free(map, NULL);
     });
 
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct treemap *map = tm_new_custom(cmp, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            tm_insert(map, i, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        tm_free(map, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(release[arena], {
+        struct treemap *map = tm_new_custom(cmp, &test_arena_node);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(tm_insert(map, i, i));
+
+        tm_release(map);
+        cmc_arena_reset(&test_arena);
+
+        /* The reset arena hands out the same memory again */
+        struct treemap *reused = tm_new_custom(cmp, &test_arena_node);
+
+        cmc_assert_equals(ptr, map, reused);
+        cmc_assert_equals(size_t, 0, tm_count(reused));
+
+        tm_release(reused);
+        cmc_arena_release(&test_arena);
+    });
+
+    CMC_CREATE_TEST(new_from_sorted, {
+        size_t keys[1000];
+        size_t values[1000];
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            keys[i] = i * 2;
+            values[i] = i;
+        }
+
+        struct treemap *map = tm_new_from_sorted(cmp, keys, values, 1000);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+        cmc_assert_equals(size_t, 1000, tm_count(map));
+
+        /* The smallest height that fits 1000 keys */
+        cmc_assert_equals(uint8_t, 10, map->root->height);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert_equals(size_t, i, tm_get(map, i * 2));
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(tm_insert(map, i * 2 + 1, i));
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(tm_remove(map, i * 2, NULL));
+
+        cmc_assert_equals(size_t, 1000, tm_count(map));
+
+        tm_free(map, NULL);
+
+        keys[500] = 0;
+
+        cmc_assert_equals(ptr, NULL, tm_new_from_sorted(cmp, keys, values, 1000));
+
+        map = tm_new_from_sorted(cmp, keys, values, 0);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+        cmc_assert(tm_empty(map));
+
+        tm_free(map, NULL);
+    });
+
     CMC_CREATE_TEST(clear[count], {
         struct treemap *map = tm_new(cmp);
 
@@ -33,4 +137,693 @@ CMC_CREATE_UNIT(treemap_test, true, {
 
         tm_free(map, NULL);
     });
+
+    CMC_CREATE_TEST(clear[deallocator], {
+        struct treemap *map = tm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        size_t sum = 0;
+
+        for (size_t i = 0; i < 1000; i++)
+            tm_insert(map, i, i);
+
+        /* Removed nodes are skipped, and the reused ones visited once */
+        for (size_t i = 0; i < 1000; i += 3)
+            tm_remove(map, i, NULL);
+
+        for (size_t i = 1000; i < 1100; i++)
+            tm_insert(map, i, i);
+
+        for (size_t i = 0; i < 1100; i++)
+            sum += i % 3 == 0 && i < 1000 ? 0 : i;
+
+        tm_dealloc_calls = 0;
+        tm_dealloc_sum = 0;
+
+        tm_clear(map, tm_dealloc);
+
+        cmc_assert_equals(size_t, 766, tm_dealloc_calls);
+        cmc_assert_equals(size_t, sum, tm_dealloc_sum);
+        cmc_assert_equals(size_t, 0, tm_count(map));
+        cmc_assert_equals(ptr, NULL, map->chunks);
+
+        tm_free(map, tm_dealloc);
+
+        cmc_assert_equals(size_t, 766, tm_dealloc_calls);
+    });
+
+    CMC_CREATE_TEST(get_or_insert[counter], {
+        struct treemap *map = tm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            size_t *counter = tm_get_or_insert(map, i % 100, 0);
+
+            cmc_assert_not_equals(ptr, NULL, counter);
+
+            *counter += 1;
+        }
+
+        cmc_assert_equals(size_t, 100, tm_count(map));
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert_equals(size_t, 10, tm_get(map, i));
+
+        cmc_assert(tm_upsert(map, 0, 50));
+        cmc_assert(tm_upsert(map, 200, 60));
+        cmc_assert_equals(size_t, 50, tm_get(map, 0));
+        cmc_assert_equals(size_t, 60, tm_get(map, 200));
+        cmc_assert_equals(size_t, 101, tm_count(map));
+
+        tm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(remove[reuse], {
+        struct treemap *map = tm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(tm_insert(map, i, i));
+
+        struct treemap_chunk *chunks = map->chunks;
+        size_t chunk_left = map->chunk_left;
+
+        for (size_t i = 0; i < 1000; i += 2)
+            cmc_assert(tm_remove(map, i, NULL));
+
+        /* The removed nodes are used before any new chunk */
+        for (size_t i = 1000; i < 1500; i++)
+            cmc_assert(tm_insert(map, i, i));
+
+        cmc_assert_equals(ptr, chunks, map->chunks);
+        cmc_assert_equals(size_t, chunk_left, map->chunk_left);
+        cmc_assert_equals(ptr, NULL, map->free_nodes);
+        cmc_assert_equals(size_t, 1000, tm_count(map));
+        cmc_assert_equals(size_t, 1001, tm_get(map, 1001));
+
+        tm_clear(map, NULL);
+
+        cmc_assert_equals(ptr, NULL, map->chunks);
+
+        tm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(iter[after removals], {
+        struct treemap *map = tm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        /* Inserted out of order and removed from all over the tree */
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(tm_insert(map, (i * 7) % 1000, i));
+
+        for (size_t i = 0; i < 1000; i += 5)
+            cmc_assert(tm_remove(map, i, NULL));
+
+        size_t min = 0;
+        size_t max = 0;
+        size_t value = 0;
+
+        cmc_assert(tm_min(map, &min, &value));
+        cmc_assert(tm_max(map, &max, &value));
+
+        cmc_assert_equals(size_t, 1, min);
+        cmc_assert_equals(size_t, 999, max);
+
+        struct treemap_iter iter;
+        size_t count = 0;
+        size_t last = 0;
+        bool sorted = true;
+
+        for (tm_iter_init(&iter, map); !tm_iter_end(&iter); tm_iter_next(&iter), count++)
+        {
+            sorted = sorted && tm_iter_key(&iter) > last && tm_iter_key(&iter) % 5 != 0;
+            last = tm_iter_key(&iter);
+        }
+
+        cmc_assert(sorted);
+        cmc_assert_equals(size_t, 800, count);
+
+        for (tm_iter_to_end(&iter); !tm_iter_start(&iter); tm_iter_prev(&iter), count--)
+        {
+            sorted = sorted && tm_iter_key(&iter) <= last;
+            last = tm_iter_key(&iter);
+        }
+
+        cmc_assert(sorted);
+        cmc_assert_equals(size_t, 0, count);
+        cmc_assert_equals(size_t, 1, last);
+
+        tm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(insert_sorted_many, {
+        struct treemap *map = tm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        size_t keys[1000];
+        size_t values[1000];
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(tm_insert(map, i * 2, 0));
+
+        /* Half of the batch is already there, so it is merged and rebuilt */
+        for (size_t i = 0; i < 1000; i++)
+        {
+            keys[i] = 1000 + i;
+            values[i] = 1;
+        }
+
+        cmc_assert_equals(size_t, 500, tm_insert_sorted_many(map, keys, values, 1000));
+        cmc_assert_equals(size_t, 1500, tm_count(map));
+        cmc_assert_equals(size_t, 0, tm_get(map, 1000));
+        cmc_assert_equals(size_t, 1, tm_get(map, 1001));
+        cmc_assert_lesser_equals(size_t, 11, (size_t)map->root->height);
+
+        bool ranked = true;
+        size_t key = 0;
+
+        for (size_t i = 0; i < 1500; i++)
+            ranked = ranked && tm_select(map, i, &key, NULL) && tm_rank(map, key) == i;
+
+        cmc_assert(ranked);
+        cmc_assert_equals(size_t, 1999, key);
+
+        /* A small batch is inserted one key at a time */
+        for (size_t i = 0; i < 10; i++)
+            keys[i] = 3000 + i;
+
+        cmc_assert_equals(size_t, 10, tm_insert_sorted_many(map, keys, values, 10));
+        cmc_assert(!map->use_finger);
+
+        /* Out of order and repeated keys */
+        keys[0] = 5000;
+        keys[1] = 4000;
+        keys[2] = 4000;
+
+        cmc_assert_equals(size_t, 2, tm_insert_sorted_many(map, keys, values, 3));
+        cmc_assert_equals(size_t, 1512, tm_count(map));
+
+        tm_clear(map, NULL);
+
+        for (size_t i = 0; i < 5; i++)
+            keys[i] = i / 2;
+
+        cmc_assert_equals(size_t, 3, tm_insert_sorted_many(map, keys, values, 5));
+        cmc_assert_equals(size_t, 3, tm_count(map));
+        cmc_assert_equals(size_t, 0, tm_insert_sorted_many(map, keys, values, 0));
+
+        tm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(split[join], {
+        struct treemap *map = tm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(tm_insert(map, (i * 7) % 1000, (i * 7) % 1000));
+
+        size_t key = 0;
+        size_t value = 0;
+
+        /* The right side is smaller and copied */
+        struct treemap *right = tm_split(map, 700);
+
+        cmc_assert_not_equals(ptr, NULL, right);
+        cmc_assert_equals(size_t, 700, tm_count(map));
+        cmc_assert_equals(size_t, 300, tm_count(right));
+        cmc_assert(tm_max(map, &key, &value));
+        cmc_assert_equals(size_t, 699, key);
+        cmc_assert(tm_min(right, &key, &value));
+        cmc_assert_equals(size_t, 700, key);
+
+        /* The left side is smaller and copied */
+        struct treemap *middle = tm_split(map, 100);
+
+        cmc_assert_not_equals(ptr, NULL, middle);
+        cmc_assert_equals(size_t, 100, tm_count(map));
+        cmc_assert_equals(size_t, 600, tm_count(middle));
+        cmc_assert(tm_max(map, &key, &value));
+        cmc_assert_equals(size_t, 99, key);
+        cmc_assert(tm_min(middle, &key, &value));
+        cmc_assert_equals(size_t, 100, key);
+
+        /* Only a greater one can be joined */
+        cmc_assert(!tm_join(right, middle));
+        cmc_assert(tm_join(map, middle));
+        cmc_assert(tm_join(map, right));
+        cmc_assert_equals(size_t, 0, tm_count(middle));
+        cmc_assert_equals(size_t, 0, tm_count(right));
+        cmc_assert_equals(size_t, 1000, tm_count(map));
+        cmc_assert_lesser_equals(size_t, 14, (size_t)map->root->height);
+
+        bool ranked = true;
+
+        for (size_t i = 0; i < 1000; i++)
+            ranked = ranked && tm_select(map, i, &key, NULL) && key == i && tm_rank(map, i) == i;
+
+        cmc_assert(ranked);
+
+        /* The nodes handed over are freed with the tree they went to */
+        for (size_t i = 1000; i < 1100; i++)
+            cmc_assert(tm_insert(right, i, i));
+
+        cmc_assert(tm_join(map, right));
+        cmc_assert_equals(size_t, 1100, tm_count(map));
+
+        struct treemap_iter iter;
+        size_t count = 0;
+
+        for (tm_iter_init(&iter, map); !tm_iter_end(&iter); tm_iter_next(&iter))
+            count++;
+
+        cmc_assert_equals(size_t, 1100, count);
+
+        tm_free(right, NULL);
+        tm_free(middle, NULL);
+
+        /* Splitting at either end leaves one of them empty */
+        right = tm_split(map, 5000);
+
+        cmc_assert_equals(size_t, 0, tm_count(right));
+        cmc_assert_equals(size_t, 1100, tm_count(map));
+
+        tm_free(right, NULL);
+
+        right = tm_split(map, 0);
+
+        cmc_assert_equals(size_t, 1100, tm_count(right));
+        cmc_assert_equals(size_t, 0, tm_count(map));
+        cmc_assert(tm_join(map, right));
+        cmc_assert_equals(size_t, 1100, tm_count(map));
+
+        tm_free(right, NULL);
+        tm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(bounds[range], {
+        struct treemap *map = tm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        /* Keys from 10 to 1000 in steps of 10 */
+        for (size_t i = 1; i <= 100; i++)
+            cmc_assert(tm_insert(map, i * 10, i));
+
+        size_t key;
+        size_t value;
+
+        cmc_assert(tm_floor(map, 255, &key, &value));
+        cmc_assert_equals(size_t, 250, key);
+        cmc_assert_equals(size_t, 25, value);
+        cmc_assert(tm_floor(map, 250, &key, NULL));
+        cmc_assert_equals(size_t, 250, key);
+        cmc_assert(!tm_floor(map, 5, &key, &value));
+
+        cmc_assert(tm_ceiling(map, 255, &key, &value));
+        cmc_assert_equals(size_t, 260, key);
+        cmc_assert(tm_ceiling(map, 260, NULL, &value));
+        cmc_assert_equals(size_t, 26, value);
+        cmc_assert(!tm_ceiling(map, 1001, &key, &value));
+
+        struct treemap_iter iter = tm_lower_bound(map, 500);
+
+        cmc_assert_equals(size_t, 500, tm_iter_key(&iter));
+        cmc_assert_equals(size_t, 0, tm_iter_index(&iter));
+
+        iter = tm_upper_bound(map, 500);
+
+        cmc_assert_equals(size_t, 510, tm_iter_key(&iter));
+
+        tm_iter_to_end(&iter);
+
+        cmc_assert_equals(size_t, 1000, tm_iter_key(&iter));
+        cmc_assert_equals(size_t, 49, tm_iter_index(&iter));
+
+        iter = tm_upper_bound(map, 1000);
+
+        cmc_assert(tm_iter_start(&iter));
+        cmc_assert(tm_iter_end(&iter));
+
+        /* Keys from 200 up to but not including 300 */
+        tm_iter_init_range(&iter, map, 195, 300);
+
+        size_t sum = 0;
+        size_t total = 0;
+
+        for (tm_iter_to_start(&iter); !tm_iter_end(&iter); tm_iter_next(&iter))
+        {
+            cmc_assert_equals(size_t, 200 + tm_iter_index(&iter) * 10, tm_iter_key(&iter));
+            sum += tm_iter_key(&iter);
+            total++;
+        }
+
+        cmc_assert_equals(size_t, 10, total);
+        cmc_assert_equals(size_t, 2450, sum);
+
+        cmc_assert(tm_iter_go_to(&iter, 5));
+        cmc_assert_equals(size_t, 250, tm_iter_key(&iter));
+        cmc_assert_equals(size_t, 5, tm_iter_index(&iter));
+        cmc_assert(tm_iter_advance(&iter, 4));
+        cmc_assert_equals(size_t, 290, tm_iter_key(&iter));
+        cmc_assert_equals(size_t, 9, tm_iter_index(&iter));
+        cmc_assert(!tm_iter_go_to(&iter, 10));
+        cmc_assert(tm_iter_rewind(&iter, 9));
+        cmc_assert_equals(size_t, 200, tm_iter_key(&iter));
+
+        tm_iter_init_range(&iter, map, 301, 309);
+
+        cmc_assert(tm_iter_end(&iter));
+
+        tm_iter_init_range(&iter, map, 500, 100);
+
+        cmc_assert(tm_iter_end(&iter));
+
+        tm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(rank[select], {
+        struct treemap *map = tm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        /* Even keys from 0 to 3998 in no particular order */
+        for (size_t i = 0; i < 2000; i++)
+            cmc_assert(tm_insert(map, ((i * 7919) % 2000) * 2, i));
+
+        /* Every multiple of 4 is removed, leaving 2, 6, 10, ... */
+        for (size_t i = 0; i < 4000; i += 4)
+            cmc_assert(tm_remove(map, i, NULL));
+
+        cmc_assert_equals(size_t, 1000, map->root->size);
+
+        size_t key;
+
+        for (size_t i = 0; i < 1000; i++)
+        {
+            cmc_assert(tm_select(map, i, &key, NULL));
+            cmc_assert_equals(size_t, i * 4 + 2, key);
+            cmc_assert_equals(size_t, i, tm_rank(map, key));
+            cmc_assert_equals(size_t, i + 1, tm_rank(map, key + 1));
+        }
+
+        cmc_assert(!tm_select(map, 1000, &key, NULL));
+        cmc_assert_equals(size_t, 0, tm_rank(map, 0));
+        cmc_assert_equals(size_t, 1000, tm_rank(map, 5000));
+
+        struct treemap_iter iter;
+        tm_iter_init(&iter, map);
+
+        cmc_assert(tm_iter_go_to(&iter, 750));
+        cmc_assert_equals(size_t, 3002, tm_iter_key(&iter));
+        cmc_assert(tm_iter_go_to(&iter, 250));
+        cmc_assert_equals(size_t, 1002, tm_iter_key(&iter));
+        cmc_assert(tm_iter_next(&iter));
+        cmc_assert_equals(size_t, 1006, tm_iter_key(&iter));
+        cmc_assert_equals(size_t, 251, tm_iter_index(&iter));
+
+        tm_iter_init_range(&iter, map, 1000, 2000);
+
+        cmc_assert(tm_iter_go_to(&iter, 100));
+        cmc_assert_equals(size_t, 1402, tm_iter_key(&iter));
+        cmc_assert(!tm_iter_go_to(&iter, 250));
+
+        tm_iter_to_end(&iter);
+
+        cmc_assert_equals(size_t, 249, tm_iter_index(&iter));
+
+        tm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(finger, {
+        struct treemap *map = tm_new(tm_finger_cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        tm_set_finger(map, true);
+
+        for (size_t i = 0; i < 10000; i++)
+            cmc_assert(tm_insert(map, i, i));
+
+        tm_finger_compares = 0;
+
+        for (size_t i = 0; i < 10000; i++)
+            cmc_assert_equals(size_t, i, tm_get(map, i));
+
+        /* Searching from the root takes about 14 comparisons per key */
+        cmc_assert(tm_finger_compares < 10000 * 4);
+
+        for (size_t i = 0; i < 10000; i += 3)
+            cmc_assert(tm_remove(map, (i * 7919) % 10000, NULL));
+
+        cmc_assert_equals(size_t, 6666, tm_count(map));
+
+        for (size_t i = 0; i < 10000; i++)
+            cmc_assert_equals(bool, i % 3 != 0, tm_contains(map, (i * 7919) % 10000));
+
+        cmc_assert(!tm_insert(map, 7919, 0));
+        cmc_assert(tm_update(map, 7919, 5, NULL));
+        cmc_assert_equals(size_t, 5, tm_get(map, 7919));
+        cmc_assert(tm_insert(map, 0, 1));
+        cmc_assert_equals(size_t, 1, tm_get(map, 0));
+
+        tm_set_finger(map, false);
+
+        cmc_assert_equals(ptr, NULL, map->finger);
+        cmc_assert_equals(size_t, 5, tm_get(map, 7919));
+        cmc_assert_equals(ptr, NULL, map->finger);
+
+        tm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(new_from, {
+        size_t keys[1000];
+        size_t values[1000];
+
+        /* A sorted start followed by repeated and unsorted keys */
+        for (size_t i = 0; i < 1000; i++)
+        {
+            keys[i] = i < 500 ? i : 999 - i;
+            values[i] = i;
+        }
+
+        struct treemap *map = tm_new_from(cmp, keys, values, 1000);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+        cmc_assert_equals(size_t, 500, tm_count(map));
+
+        /* The first value of a key is kept */
+        for (size_t i = 0; i < 500; i++)
+            cmc_assert_equals(size_t, i, tm_get(map, i));
+
+        tm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(to_array, {
+        struct treemap *map = tm_new(cmp);
+
+        for (size_t i = 0; i < 50; i++)
+            tm_insert(map, 49 - i, i);
+
+        size_t keys[50] = { 0 };
+        size_t values[50] = { 0 };
+
+        cmc_assert_equals(size_t, 50, tm_to_array(map, keys, values, 100));
+
+        for (size_t i = 0; i < 50; i++)
+        {
+            cmc_assert_equals(size_t, i, keys[i]);
+            cmc_assert_equals(size_t, 49 - i, values[i]);
+        }
+
+        cmc_assert_equals(size_t, 5, tm_to_array(map, NULL, values, 5));
+        cmc_assert_equals(size_t, 0, tm_to_array(map, keys, values, 0));
+
+        tm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(serialize, {
+        struct treemap *map = tm_new(cmp);
+
+        for (size_t i = 0; i < 3000; i++)
+            tm_insert(map, (i * 7) % 3000, i);
+
+        struct treemap_serializer ser;
+        struct treemap_deserializer des;
+
+        cmc_assert(tm_serialize_begin(&ser, map, 256, true));
+        cmc_assert(tm_deserialize_begin(&des, cmp, 256));
+
+        unsigned char chunk[33];
+        size_t n;
+
+        while ((n = tm_serialize_next(&ser, chunk, sizeof(chunk))) > 0)
+            cmc_assert(tm_deserialize_next(&des, chunk, n));
+
+        tm_serialize_end(&ser);
+
+        struct treemap *result = tm_deserialize_end(&des);
+
+        cmc_assert_not_equals(ptr, NULL, result);
+        cmc_assert_equals(size_t, 3000, tm_count(result));
+
+        for (size_t i = 0; i < 3000; i++)
+            cmc_assert_equals(size_t, tm_get(map, i), tm_get(result, i));
+
+        tm_free(map, NULL);
+        tm_free(result, NULL);
+    });
+
+    CMC_CREATE_TEST(remove_if, {
+        struct treemap *map = tm_new(cmp);
+
+        for (size_t i = 0; i < 1000; i++)
+            tm_insert(map, i, i * 2);
+
+        tm_dealloc_calls = 0;
+        tm_dealloc_sum = 0;
+
+        cmc_assert_equals(size_t, 500, tm_remove_if(map, tm_odd_key, tm_dealloc));
+        cmc_assert_equals(size_t, 500, tm_dealloc_calls);
+        cmc_assert_equals(size_t, 500 * 500, tm_dealloc_sum);
+        cmc_assert_equals(size_t, 500, tm_count(map));
+
+        size_t key = 0;
+        size_t value = 0;
+
+        for (size_t i = 0; i < 500; i++)
+        {
+            cmc_assert(tm_select(map, i, &key, &value));
+            cmc_assert_equals(size_t, i * 2, key);
+            cmc_assert_equals(size_t, i * 4, value);
+        }
+
+        cmc_assert(tm_insert(map, 1, 2));
+        cmc_assert(tm_remove(map, 998, NULL));
+        cmc_assert_equals(size_t, 500, tm_count(map));
+
+        tm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(remove_if[finger], {
+        struct treemap *map = tm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        tm_set_finger(map, true);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(tm_insert(map, i, i));
+
+        /* Leaves the finger on a node that remove_if releases */
+        cmc_assert(tm_remove(map, 51, NULL));
+        cmc_assert_equals(size_t, 49, tm_remove_if(map, tm_odd_key, NULL));
+        cmc_assert_equals(ptr, NULL, map->finger);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert_equals(bool, i % 2 == 0, tm_contains(map, i));
+
+        for (size_t i = 0; i < 100; i += 2)
+            cmc_assert(tm_remove(map, i, NULL));
+
+        cmc_assert(tm_empty(map));
+
+        tm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(get_many, {
+        struct treemap *map = tm_new(cmp);
+
+        for (size_t i = 0; i < 1000; i += 2)
+            tm_insert(map, i, i * 3);
+
+        size_t keys[100];
+        size_t out[100];
+        bool found[100];
+
+        // Not sorted, so the searches go down in batches
+        for (size_t i = 0; i < 100; i++)
+            keys[i] = (i * 7919) % 1001;
+
+        cmc_assert_equals(size_t, 50, tm_get_many(map, keys, 100, out, found));
+
+        for (size_t i = 0; i < 100; i++)
+        {
+            cmc_assert_equals(bool, keys[i] % 2 == 0 && keys[i] < 1000, found[i]);
+            cmc_assert_equals(size_t, found[i] ? keys[i] * 3 : 0, out[i]);
+        }
+
+        // Sorted, so each search starts from the finger
+        for (size_t i = 0; i < 100; i++)
+            keys[i] = i * 7;
+
+        cmc_assert_equals(size_t, 50, tm_get_many(map, keys, 100, out, NULL));
+        cmc_assert_equals(size_t, 50, tm_contains_many(map, keys, 100, found));
+
+        for (size_t i = 0; i < 100; i++)
+        {
+            cmc_assert_equals(bool, i % 2 == 0, found[i]);
+            cmc_assert_equals(size_t, found[i] ? keys[i] * 3 : 0, out[i]);
+        }
+
+        cmc_assert(!map->use_finger);
+        cmc_assert_equals(size_t, 0, tm_get_many(map, keys, 0, NULL, NULL));
+
+        tm_clear(map, NULL);
+
+        cmc_assert_equals(size_t, 0, tm_contains_many(map, keys, 100, found));
+        cmc_assert(!found[0]);
+
+        tm_free(map, NULL);
+    });
+
+    CMC_CREATE_TEST(get_many[after remove], {
+        struct treemap *map = tm_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, map);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(tm_insert(map, i, i * 3));
+
+        cmc_assert(tm_remove(map, 51, NULL));
+
+        // Only a map with the finger enabled keeps a node there
+        cmc_assert_equals(ptr, NULL, map->finger);
+        cmc_assert_equals(size_t, 49, tm_remove_if(map, tm_odd_key, NULL));
+
+        size_t keys[4];
+        size_t out[4];
+        bool found[4];
+
+        for (size_t i = 0; i < 4; i++)
+            keys[i] = (i + 1) * 10;
+
+        // Sorted, so the searches use the finger even though it is disabled
+        cmc_assert_equals(size_t, 4, tm_get_many(map, keys, 4, out, found));
+
+        for (size_t i = 0; i < 4; i++)
+        {
+            cmc_assert(found[i]);
+            cmc_assert_equals(size_t, keys[i] * 3, out[i]);
+        }
+
+        for (size_t i = 0; i < 100; i += 4)
+            cmc_assert(tm_remove(map, i, NULL));
+
+        cmc_assert_equals(size_t, 1, tm_get_many(map, keys + 1, 2, out, found));
+        cmc_assert_equals(size_t, 2, tm_get_many(map, keys, 4, out, found));
+
+        for (size_t i = 0; i < 4; i++)
+            cmc_assert_equals(bool, i % 2 == 0, found[i]);
+
+        cmc_assert(!map->use_finger);
+
+        tm_free(map, NULL);
+    });
 });
@@ -4,8 +4,24 @@
 #include <utl/test.h>
 
 #include <cmc/treeset.h>
+#include <utl/cmc_delta.h>
 
 CMC_GENERATE_TREESET(ts, treeset, size_t)
+CMC_GENERATE_TREESET_DELTA(ts, treeset, size_t)
+
+static size_t ts_dealloc_calls = 0;
+static size_t ts_dealloc_sum = 0;
+
+static void ts_dealloc(size_t value)
+{
+    ts_dealloc_calls++;
+    ts_dealloc_sum += value;
+}
+
+static bool ts_is_odd(size_t value)
+{
+    return value % 2 == 1;
+}
 
 CMC_CREATE_UNIT(treeset_test, true, {
     CMC_CREATE_TEST(new, {
@@ -16,6 +32,73 @@ CMC_CREATE_UNIT(treeset_test, true, {
         ts_free(set, NULL);
     });
 
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct treeset *set = ts_new_custom(cmp, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 0; i < 1000; i++)
+            ts_insert(set, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        ts_free(set, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(release[arena], {
+        struct treeset *set = ts_new_custom(cmp, &test_arena_node);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(ts_insert(set, i));
+
+        ts_release(set);
+        cmc_arena_reset(&test_arena);
+
+        /* The reset arena hands out the same memory again */
+        struct treeset *reused = ts_new_custom(cmp, &test_arena_node);
+
+        cmc_assert_equals(ptr, set, reused);
+        cmc_assert_equals(size_t, 0, ts_count(reused));
+
+        ts_release(reused);
+        cmc_arena_release(&test_arena);
+    });
+
+    CMC_CREATE_TEST(new_from_sorted, {
+        size_t elements[1000];
+
+        for (size_t i = 0; i < 1000; i++)
+            elements[i] = i * 2;
+
+        struct treeset *set = ts_new_from_sorted(cmp, elements, 1000);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+        cmc_assert_equals(size_t, 1000, ts_count(set));
+
+        /* The smallest height that fits 1000 elements */
+        cmc_assert_equals(uint8_t, 10, set->root->height);
+
+        for (size_t i = 0; i < 2000; i++)
+            cmc_assert_equals(bool, i % 2 == 0, ts_contains(set, i));
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(ts_remove(set, i * 2));
+
+        cmc_assert(ts_empty(set));
+
+        ts_free(set, NULL);
+
+        elements[999] = 1996;
+
+        cmc_assert_equals(ptr, NULL, ts_new_from_sorted(cmp, elements, 1000));
+    });
+
     CMC_CREATE_TEST(clear[count], {
         struct treeset *set = ts_new(cmp);
 
@@ -33,4 +116,574 @@ CMC_CREATE_UNIT(treeset_test, true, {
 
         ts_free(set, NULL);
     });
+
+    CMC_CREATE_TEST(clear[deallocator], {
+        struct treeset *set = ts_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        size_t sum = 0;
+
+        for (size_t i = 0; i < 1000; i++)
+            ts_insert(set, i);
+
+        /* Removed nodes are skipped, and the reused ones visited once */
+        for (size_t i = 0; i < 1000; i += 3)
+            ts_remove(set, i);
+
+        for (size_t i = 1000; i < 1100; i++)
+            ts_insert(set, i);
+
+        for (size_t i = 0; i < 1100; i++)
+            sum += i % 3 == 0 && i < 1000 ? 0 : i;
+
+        ts_dealloc_calls = 0;
+        ts_dealloc_sum = 0;
+
+        ts_clear(set, ts_dealloc);
+
+        cmc_assert_equals(size_t, 766, ts_dealloc_calls);
+        cmc_assert_equals(size_t, sum, ts_dealloc_sum);
+        cmc_assert_equals(size_t, 0, ts_count(set));
+        cmc_assert_equals(ptr, NULL, set->chunks);
+
+        ts_free(set, ts_dealloc);
+
+        cmc_assert_equals(size_t, 766, ts_dealloc_calls);
+    });
+
+    CMC_CREATE_TEST(remove[reuse], {
+        struct treeset *set = ts_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(ts_insert(set, i));
+
+        struct treeset_chunk *chunks = set->chunks;
+
+        for (size_t i = 0; i < 1000; i += 2)
+            cmc_assert(ts_remove(set, i));
+
+        /* The removed nodes are used before any new chunk */
+        for (size_t i = 1000; i < 1500; i++)
+            cmc_assert(ts_insert(set, i));
+
+        cmc_assert_equals(ptr, chunks, set->chunks);
+        cmc_assert_equals(ptr, NULL, set->free_nodes);
+        cmc_assert_equals(size_t, 1000, ts_count(set));
+        cmc_assert(ts_contains(set, 1001));
+        cmc_assert(!ts_contains(set, 2));
+
+        ts_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(iter[after removals], {
+        struct treeset *set = ts_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        /* Inserted out of order and removed from all over the tree */
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(ts_insert(set, (i * 7) % 1000));
+
+        for (size_t i = 0; i < 1000; i += 5)
+            cmc_assert(ts_remove(set, i));
+
+        size_t min = 0;
+        size_t max = 0;
+
+        cmc_assert(ts_min(set, &min));
+        cmc_assert(ts_max(set, &max));
+
+        cmc_assert_equals(size_t, 1, min);
+        cmc_assert_equals(size_t, 999, max);
+
+        struct treeset_iter iter;
+        size_t count = 0;
+        size_t last = 0;
+        bool sorted = true;
+
+        for (ts_iter_init(&iter, set); !ts_iter_end(&iter); ts_iter_next(&iter), count++)
+        {
+            sorted = sorted && ts_iter_value(&iter) > last && ts_iter_value(&iter) % 5 != 0;
+            last = ts_iter_value(&iter);
+        }
+
+        cmc_assert(sorted);
+        cmc_assert_equals(size_t, 800, count);
+
+        for (ts_iter_to_end(&iter); !ts_iter_start(&iter); ts_iter_prev(&iter), count--)
+        {
+            sorted = sorted && ts_iter_value(&iter) <= last;
+            last = ts_iter_value(&iter);
+        }
+
+        cmc_assert(sorted);
+        cmc_assert_equals(size_t, 0, count);
+        cmc_assert_equals(size_t, 1, last);
+
+        ts_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(insert_sorted_many, {
+        struct treeset *set = ts_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        size_t keys[1000];
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(ts_insert(set, i * 2));
+
+        /* Half of the batch is already there, so it is merged and rebuilt */
+        for (size_t i = 0; i < 1000; i++)
+        {
+            keys[i] = 1000 + i;
+        }
+
+        cmc_assert_equals(size_t, 500, ts_insert_sorted_many(set, keys, 1000));
+        cmc_assert_equals(size_t, 1500, ts_count(set));
+        cmc_assert(ts_contains(set, 1000));
+        cmc_assert(ts_contains(set, 1001));
+        cmc_assert_lesser_equals(size_t, 11, (size_t)set->root->height);
+
+        bool ranked = true;
+        size_t key = 0;
+
+        for (size_t i = 0; i < 1500; i++)
+            ranked = ranked && ts_select(set, i, &key) && ts_rank(set, key) == i;
+
+        cmc_assert(ranked);
+        cmc_assert_equals(size_t, 1999, key);
+
+        /* A small batch is inserted one key at a time */
+        for (size_t i = 0; i < 10; i++)
+            keys[i] = 3000 + i;
+
+        cmc_assert_equals(size_t, 10, ts_insert_sorted_many(set, keys, 10));
+
+        /* Out of order and repeated keys */
+        keys[0] = 5000;
+        keys[1] = 4000;
+        keys[2] = 4000;
+
+        cmc_assert_equals(size_t, 2, ts_insert_sorted_many(set, keys, 3));
+        cmc_assert_equals(size_t, 1512, ts_count(set));
+
+        ts_clear(set, NULL);
+
+        for (size_t i = 0; i < 5; i++)
+            keys[i] = i / 2;
+
+        cmc_assert_equals(size_t, 3, ts_insert_sorted_many(set, keys, 5));
+        cmc_assert_equals(size_t, 3, ts_count(set));
+        cmc_assert_equals(size_t, 0, ts_insert_sorted_many(set, keys, 0));
+
+        ts_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(split[join], {
+        struct treeset *set = ts_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(ts_insert(set, (i * 7) % 1000));
+
+        size_t key = 0;
+
+        /* The right side is smaller and copied */
+        struct treeset *right = ts_split(set, 700);
+
+        cmc_assert_not_equals(ptr, NULL, right);
+        cmc_assert_equals(size_t, 700, ts_count(set));
+        cmc_assert_equals(size_t, 300, ts_count(right));
+        cmc_assert(ts_max(set, &key));
+        cmc_assert_equals(size_t, 699, key);
+        cmc_assert(ts_min(right, &key));
+        cmc_assert_equals(size_t, 700, key);
+
+        /* The left side is smaller and copied */
+        struct treeset *middle = ts_split(set, 100);
+
+        cmc_assert_not_equals(ptr, NULL, middle);
+        cmc_assert_equals(size_t, 100, ts_count(set));
+        cmc_assert_equals(size_t, 600, ts_count(middle));
+        cmc_assert(ts_max(set, &key));
+        cmc_assert_equals(size_t, 99, key);
+        cmc_assert(ts_min(middle, &key));
+        cmc_assert_equals(size_t, 100, key);
+
+        /* Only a greater one can be joined */
+        cmc_assert(!ts_join(right, middle));
+        cmc_assert(ts_join(set, middle));
+        cmc_assert(ts_join(set, right));
+        cmc_assert_equals(size_t, 0, ts_count(middle));
+        cmc_assert_equals(size_t, 0, ts_count(right));
+        cmc_assert_equals(size_t, 1000, ts_count(set));
+        cmc_assert_lesser_equals(size_t, 14, (size_t)set->root->height);
+
+        bool ranked = true;
+
+        for (size_t i = 0; i < 1000; i++)
+            ranked = ranked && ts_select(set, i, &key) && key == i && ts_rank(set, i) == i;
+
+        cmc_assert(ranked);
+
+        /* The nodes handed over are freed with the tree they went to */
+        for (size_t i = 1000; i < 1100; i++)
+            cmc_assert(ts_insert(right, i));
+
+        cmc_assert(ts_join(set, right));
+        cmc_assert_equals(size_t, 1100, ts_count(set));
+
+        struct treeset_iter iter;
+        size_t count = 0;
+
+        for (ts_iter_init(&iter, set); !ts_iter_end(&iter); ts_iter_next(&iter))
+            count++;
+
+        cmc_assert_equals(size_t, 1100, count);
+
+        ts_free(right, NULL);
+        ts_free(middle, NULL);
+
+        /* Splitting at either end leaves one of them empty */
+        right = ts_split(set, 5000);
+
+        cmc_assert_equals(size_t, 0, ts_count(right));
+        cmc_assert_equals(size_t, 1100, ts_count(set));
+
+        ts_free(right, NULL);
+
+        right = ts_split(set, 0);
+
+        cmc_assert_equals(size_t, 1100, ts_count(right));
+        cmc_assert_equals(size_t, 0, ts_count(set));
+        cmc_assert(ts_join(set, right));
+        cmc_assert_equals(size_t, 1100, ts_count(set));
+
+        ts_free(right, NULL);
+        ts_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(bounds[range], {
+        struct treeset *set = ts_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        /* Elements from 10 to 1000 in steps of 10 */
+        for (size_t i = 1; i <= 100; i++)
+            cmc_assert(ts_insert(set, i * 10));
+
+        size_t value;
+
+        cmc_assert(ts_floor(set, 999, &value));
+        cmc_assert_equals(size_t, 990, value);
+        cmc_assert(!ts_floor(set, 9, &value));
+        cmc_assert(ts_ceiling(set, 11, &value));
+        cmc_assert_equals(size_t, 20, value);
+        cmc_assert(ts_ceiling(set, 20, NULL));
+        cmc_assert(!ts_ceiling(set, 1001, &value));
+
+        struct treeset_iter iter = ts_lower_bound(set, 0);
+
+        cmc_assert_equals(size_t, 10, ts_iter_value(&iter));
+
+        iter = ts_upper_bound(set, 990);
+
+        cmc_assert_equals(size_t, 1000, ts_iter_value(&iter));
+        cmc_assert(ts_iter_next(&iter));
+        cmc_assert(ts_iter_end(&iter));
+
+        ts_iter_init_range(&iter, set, 10, 1000);
+
+        size_t total = 0;
+
+        for (ts_iter_to_start(&iter); !ts_iter_end(&iter); ts_iter_next(&iter))
+            total++;
+
+        cmc_assert_equals(size_t, 99, total);
+
+        ts_iter_to_end(&iter);
+
+        cmc_assert_equals(size_t, 990, ts_iter_value(&iter));
+        cmc_assert_equals(size_t, 98, ts_iter_index(&iter));
+
+        ts_iter_init_range(&iter, set, 1000, 1000);
+
+        cmc_assert(ts_iter_end(&iter));
+
+        ts_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(rank[select], {
+        struct treeset *set = ts_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 0; i < 3000; i++)
+            cmc_assert(ts_insert(set, (i * 7919) % 3000));
+
+        for (size_t i = 0; i < 3000; i += 3)
+            cmc_assert(ts_remove(set, i));
+
+        cmc_assert_equals(size_t, 2000, set->root->size);
+
+        size_t value;
+
+        /* The median of 1, 2, 4, 5, 7, ... */
+        cmc_assert(ts_select(set, 1000, &value));
+        cmc_assert_equals(size_t, 1501, value);
+        cmc_assert_equals(size_t, 1000, ts_rank(set, 1501));
+        cmc_assert_equals(size_t, 1000, ts_rank(set, 1500));
+        cmc_assert(!ts_select(set, 2000, &value));
+
+        struct treeset_iter iter;
+        ts_iter_init(&iter, set);
+
+        cmc_assert(ts_iter_go_to(&iter, 1999));
+        cmc_assert_equals(size_t, 2999, ts_iter_value(&iter));
+        cmc_assert(ts_iter_rewind(&iter, 1999));
+        cmc_assert_equals(size_t, 1, ts_iter_value(&iter));
+
+        ts_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(set operations, {
+        struct treeset *set1 = ts_new(cmp);
+        struct treeset *set2 = ts_new(cmp);
+
+        cmc_assert_not_equals(ptr, NULL, set1);
+        cmc_assert_not_equals(ptr, NULL, set2);
+
+        /* Multiples of 2 and multiples of 3 */
+        for (size_t i = 0; i < 600; i++)
+        {
+            ts_insert(set1, i * 2);
+            ts_insert(set2, i * 3);
+        }
+
+        struct treeset *set_u = ts_union(set1, set2);
+        struct treeset *set_i = ts_intersection(set1, set2);
+        struct treeset *set_d = ts_difference(set1, set2);
+        struct treeset *set_s = ts_symmetric_difference(set1, set2);
+
+        cmc_assert_equals(size_t, 1000, ts_count(set_u));
+        cmc_assert_equals(size_t, 200, ts_count(set_i));
+        cmc_assert_equals(size_t, 400, ts_count(set_d));
+        cmc_assert_equals(size_t, 800, ts_count(set_s));
+
+        /* The smallest height that fits 1000 elements */
+        cmc_assert_equals(uint8_t, 10, set_u->root->height);
+        cmc_assert_equals(size_t, 1000, set_u->root->size);
+
+        cmc_assert(ts_contains(set_i, 6));
+        cmc_assert(!ts_contains(set_d, 6));
+        cmc_assert(ts_contains(set_d, 4));
+        cmc_assert(ts_contains(set_s, 1797));
+
+        cmc_assert(ts_is_subset(set_i, set1));
+        cmc_assert(ts_is_proper_subset(set_i, set2));
+        cmc_assert(ts_is_superset(set_u, set2));
+        cmc_assert(!ts_is_subset(set1, set2));
+        cmc_assert(!ts_is_proper_superset(set_u, set_u));
+        cmc_assert(ts_is_disjointset(set_d, set2));
+        cmc_assert(!ts_is_disjointset(set1, set2));
+
+        cmc_assert(ts_union_with(set_d, set_i));
+        cmc_assert(ts_equals(set_d, set1));
+        cmc_assert(ts_difference_with(set_d, set2));
+        cmc_assert_equals(size_t, 400, ts_count(set_d));
+        cmc_assert(ts_symmetric_difference_with(set_d, set_s));
+        cmc_assert(ts_intersection_with(set_d, set2));
+        cmc_assert_equals(size_t, 400, ts_count(set_d));
+        cmc_assert(ts_is_subset(set_d, set2));
+        cmc_assert(ts_is_disjointset(set_d, set1));
+
+        /* The new elements can be found and removed like any other */
+        cmc_assert(ts_remove(set_d, 3));
+        cmc_assert(ts_insert(set_d, 3));
+        cmc_assert(ts_intersection_with(set_d, set_i));
+        cmc_assert(ts_empty(set_d));
+        cmc_assert_equals(ptr, NULL, set_d->root);
+
+        ts_free(set1, NULL);
+        ts_free(set2, NULL);
+        ts_free(set_u, NULL);
+        ts_free(set_i, NULL);
+        ts_free(set_d, NULL);
+        ts_free(set_s, NULL);
+    });
+
+    CMC_CREATE_TEST(new_from, {
+        size_t elements[1000];
+
+        /* A sorted start followed by repeated and unsorted elements */
+        for (size_t i = 0; i < 1000; i++)
+            elements[i] = i < 500 ? i * 2 : (i * 7) % 1000;
+
+        struct treeset *set = ts_new_from(cmp, elements, 1000);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(ts_contains(set, elements[i]));
+
+        size_t sorted[1000] = { 0 };
+        size_t count = ts_to_array(set, sorted, 1000);
+
+        cmc_assert_equals(size_t, ts_count(set), count);
+
+        for (size_t i = 1; i < count; i++)
+            cmc_assert_lesser(size_t, sorted[i], sorted[i - 1]);
+
+        ts_free(set, NULL);
+
+        set = ts_new_from(cmp, elements, 0);
+
+        cmc_assert_not_equals(ptr, NULL, set);
+        cmc_assert(ts_empty(set));
+        cmc_assert_equals(size_t, 0, ts_to_array(set, sorted, 1000));
+
+        ts_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(to_array, {
+        struct treeset *set = ts_new(cmp);
+
+        for (size_t i = 0; i < 50; i++)
+            ts_insert(set, 49 - i);
+
+        size_t elements[50] = { 0 };
+
+        cmc_assert_equals(size_t, 50, ts_to_array(set, elements, 100));
+
+        for (size_t i = 0; i < 50; i++)
+            cmc_assert_equals(size_t, i, elements[i]);
+
+        cmc_assert_equals(size_t, 5, ts_to_array(set, elements, 5));
+
+        ts_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(delta, {
+        struct treeset *set = ts_new(cmp);
+
+        for (size_t i = 0; i < 5000; i++)
+            ts_insert(set, i * i);
+
+        struct cmc_delta delta;
+
+        cmc_assert(ts_to_delta(set, &delta));
+        cmc_assert_lesser(size_t, 5000 * sizeof(size_t), cmc_delta_size(&delta));
+
+        cmc_assert(ts_delta_contains(&delta, 4999 * 4999));
+        cmc_assert(ts_delta_contains(&delta, 0));
+        cmc_assert(!ts_delta_contains(&delta, 2));
+
+        struct treeset *result = ts_from_delta(&delta, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, result);
+        cmc_assert(ts_equals(set, result));
+
+        cmc_delta_release(&delta);
+        ts_free(set, NULL);
+        ts_free(result, NULL);
+    });
+
+    CMC_CREATE_TEST(delta[widths], {
+        struct treeset *set = ts_new(cmp);
+        size_t value = 0;
+
+        /* Gaps of every width, with groups that can be shuffled at once */
+        /* and groups with 8 byte gaps mixed */
+        for (size_t i = 0; i < 1000; i++)
+        {
+            if (i % 37 == 0)
+                value += (size_t)1 << 40;
+            else if (i % 3 == 0)
+                value += 70000;
+            else
+                value += i % 2 == 0 ? 300 : 5;
+
+            cmc_assert(ts_insert(set, value));
+        }
+
+        struct cmc_delta delta;
+        struct treeset_iter iter;
+
+        cmc_assert(ts_to_delta(set, &delta));
+
+        for (ts_iter_init(&iter, set); !ts_iter_end(&iter); ts_iter_next(&iter))
+        {
+            cmc_assert(ts_delta_contains(&delta, ts_iter_value(&iter)));
+            cmc_assert(!ts_delta_contains(&delta, ts_iter_value(&iter) + 1));
+        }
+
+        struct treeset *result = ts_from_delta(&delta, cmp);
+
+        cmc_assert_not_equals(ptr, NULL, result);
+        cmc_assert(ts_equals(set, result));
+
+        cmc_delta_release(&delta);
+        ts_free(set, NULL);
+        ts_free(result, NULL);
+    });
+
+    CMC_CREATE_TEST(remove_if, {
+        struct treeset *set = ts_new(cmp);
+
+        for (size_t i = 0; i < 1000; i++)
+            ts_insert(set, i);
+
+        ts_dealloc_calls = 0;
+
+        cmc_assert_equals(size_t, 500, ts_remove_if(set, ts_is_odd, ts_dealloc));
+        cmc_assert_equals(size_t, 500, ts_dealloc_calls);
+        cmc_assert_equals(size_t, 500, ts_count(set));
+
+        size_t value;
+
+        for (size_t i = 0; i < 500; i++)
+        {
+            cmc_assert(ts_select(set, i, &value));
+            cmc_assert_equals(size_t, i * 2, value);
+        }
+
+        cmc_assert_equals(size_t, 0, ts_remove_if(set, ts_is_odd, NULL));
+        cmc_assert(ts_insert(set, 1));
+        cmc_assert(ts_min(set, &value));
+        cmc_assert_equals(size_t, 0, value);
+
+        ts_free(set, NULL);
+    });
+
+    CMC_CREATE_TEST(contains_many, {
+        struct treeset *set = ts_new(cmp);
+
+        for (size_t i = 0; i < 1000; i += 3)
+            ts_insert(set, i);
+
+        size_t elements[200];
+        bool found[200];
+
+        for (size_t i = 0; i < 200; i++)
+            elements[i] = (i * 7919) % 1200;
+
+        size_t expected = 0;
+
+        for (size_t i = 0; i < 200; i++)
+            expected += elements[i] % 3 == 0 && elements[i] < 1000;
+
+        cmc_assert_equals(size_t, expected, ts_contains_many(set, elements, 200, found));
+
+        for (size_t i = 0; i < 200; i++)
+            cmc_assert_equals(bool, ts_contains(set, elements[i]), found[i]);
+
+        cmc_assert_equals(size_t, expected, ts_contains_many(set, elements, 200, NULL));
+
+        ts_free(set, NULL);
+    });
 });
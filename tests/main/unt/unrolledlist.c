@@ -0,0 +1,269 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <cmc/unrolledlist.h>
+
+CMC_GENERATE_UNROLLEDLIST(ul, unrolledlist, size_t)
+
+/* If every node has between 1 and CMC_UNROLLEDLIST_NODE_SIZE elements, the */
+/* links are consistent and the counts add up */
+static bool unrolledlist_valid(struct unrolledlist *ul)
+{
+    size_t count = 0;
+    size_t nodes = 0;
+
+    struct unrolledlist_node *prev = NULL;
+
+    for (struct unrolledlist_node *scan = ul->head; scan != NULL; scan = scan->next)
+    {
+        if (scan->count == 0 || scan->count > CMC_UNROLLEDLIST_NODE_SIZE)
+            return false;
+        if (scan->prev != prev)
+            return false;
+
+        count += scan->count;
+        nodes++;
+        prev = scan;
+    }
+
+    return prev == ul->tail && count == ul->count && nodes == ul->nodes;
+}
+
+CMC_CREATE_UNIT(unrolledlist_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct unrolledlist *ul = ul_new();
+
+        cmc_assert_not_equals(ptr, NULL, ul);
+        cmc_assert_equals(size_t, 0, ul_count(ul));
+        cmc_assert_equals(ptr, NULL, ul->head);
+        cmc_assert_equals(ptr, NULL, ul->tail);
+        cmc_assert(!ul_pop_front(ul));
+        cmc_assert(!ul_pop_back(ul));
+        cmc_assert(!ul_pop_at(ul, 0));
+
+        ul_free(ul, NULL);
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct unrolledlist *ul = ul_new_custom(&count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, ul);
+
+        for (size_t i = 0; i < 1000; i++)
+            ul_push_back(ul, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        ul_free(ul, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(push pop, {
+        struct unrolledlist *ul = ul_new();
+
+        cmc_assert_not_equals(ptr, NULL, ul);
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(ul_push_back(ul, i));
+
+        /* Elements pushed in order fill their nodes */
+        size_t nodes = (1000 + CMC_UNROLLEDLIST_NODE_SIZE - 1) / CMC_UNROLLEDLIST_NODE_SIZE;
+
+        cmc_assert_equals(size_t, nodes, ul->nodes);
+        cmc_assert(unrolledlist_valid(ul));
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert_equals(size_t, i, ul_get(ul, i));
+
+        cmc_assert(!ul_push_at(ul, 0, 1001));
+        cmc_assert(ul_push_at(ul, 2000, 1000));
+        cmc_assert(ul_push_at(ul, 3000, 500));
+        cmc_assert(ul_push_front(ul, 4000));
+
+        cmc_assert_equals(size_t, 1003, ul_count(ul));
+        cmc_assert_equals(size_t, 4000, ul_front(ul));
+        cmc_assert_equals(size_t, 2000, ul_back(ul));
+        cmc_assert_equals(size_t, 3000, ul_get(ul, 501));
+        cmc_assert_equals(size_t, 500, ul_get(ul, 502));
+        cmc_assert(unrolledlist_valid(ul));
+
+        cmc_assert(ul_pop_at(ul, 501));
+        cmc_assert(ul_pop_front(ul));
+        cmc_assert(ul_pop_back(ul));
+
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert_equals(size_t, i, ul_get(ul, i));
+
+        while (!ul_empty(ul))
+        {
+            cmc_assert(ul_pop_at(ul, ul_count(ul) / 2));
+            cmc_assert(unrolledlist_valid(ul));
+        }
+
+        cmc_assert_equals(size_t, 0, ul->nodes);
+        cmc_assert_equals(ptr, NULL, ul->head);
+        cmc_assert_equals(ptr, NULL, ul->tail);
+
+        ul_free(ul, NULL);
+    });
+
+    CMC_CREATE_TEST(random, {
+        struct unrolledlist *ul = ul_new();
+
+        cmc_assert_not_equals(ptr, NULL, ul);
+
+        size_t model[2000];
+        size_t count = 0;
+        size_t seed = 12345;
+
+        for (size_t i = 0; i < 20000; i++)
+        {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+
+            size_t index = (seed >> 33) % (count + 1);
+
+            if (count < 2000 && (count == 0 || (seed >> 20) % 3 != 0))
+            {
+                memmove(model + index + 1, model + index, (count - index) * sizeof(size_t));
+                model[index] = i;
+                count++;
+
+                cmc_assert(ul_push_at(ul, i, index));
+            }
+            else
+            {
+                index %= count;
+
+                memmove(model + index, model + index + 1, (count - index - 1) * sizeof(size_t));
+                count--;
+
+                cmc_assert(ul_pop_at(ul, index));
+            }
+        }
+
+        cmc_assert_equals(size_t, count, ul_count(ul));
+        cmc_assert(unrolledlist_valid(ul));
+
+        for (size_t i = 0; i < count; i++)
+            cmc_assert_equals(size_t, model[i], ul_get(ul, i));
+
+        struct unrolledlist_iter iter;
+
+        size_t total = 0;
+
+        for (ul_iter_init(&iter, ul); !ul_iter_end(&iter); ul_iter_next(&iter))
+        {
+            cmc_assert_equals(size_t, model[total], ul_iter_value(&iter));
+            cmc_assert_equals(size_t, total, ul_iter_index(&iter));
+            total++;
+        }
+
+        cmc_assert_equals(size_t, count, total);
+
+        for (ul_iter_to_end(&iter); !ul_iter_start(&iter); ul_iter_prev(&iter))
+        {
+            total--;
+            cmc_assert_equals(size_t, model[total], ul_iter_value(&iter));
+        }
+
+        cmc_assert_equals(size_t, 0, total);
+
+        ul_iter_to_start(&iter);
+
+        cmc_assert(ul_iter_advance(&iter, count / 2 + 7));
+        cmc_assert_equals(size_t, model[count / 2 + 7], ul_iter_value(&iter));
+        cmc_assert(ul_iter_rewind(&iter, 40));
+        cmc_assert_equals(size_t, model[count / 2 - 33], ul_iter_value(&iter));
+        cmc_assert(ul_iter_go_to(&iter, 3));
+        cmc_assert_equals(size_t, model[3], ul_iter_value(&iter));
+        cmc_assert(!ul_iter_advance(&iter, count));
+
+        ul_free(ul, NULL);
+    });
+
+    CMC_CREATE_TEST(nodes, {
+        struct unrolledlist *ul = ul_new();
+
+        cmc_assert_not_equals(ptr, NULL, ul);
+
+        for (size_t i = 0; i < 100; i++)
+            cmc_assert(ul_push_back(ul, i * 2));
+
+        size_t offset;
+        struct unrolledlist_node *node = ul_get_node(ul, 40, &offset);
+
+        cmc_assert_not_equals(ptr, NULL, node);
+        cmc_assert_equals(size_t, 80, node->data[offset]);
+        cmc_assert_equals(ptr, NULL, ul_get_node(ul, 100, &offset));
+
+        cmc_assert(ul_insert_after(ul, node, offset, 81));
+        cmc_assert(!ul_insert_after(ul, node, node->count, 0));
+
+        node = ul_get_node(ul, 40, &offset);
+
+        cmc_assert(ul_insert_before(ul, node, offset, 79));
+        cmc_assert_equals(size_t, 79, ul_get(ul, 40));
+        cmc_assert_equals(size_t, 80, ul_get(ul, 41));
+        cmc_assert_equals(size_t, 81, ul_get(ul, 42));
+        cmc_assert_equals(size_t, 82, ul_get(ul, 43));
+
+        node = ul_get_node(ul, 41, &offset);
+
+        cmc_assert(ul_remove_current(ul, node, offset));
+        cmc_assert_equals(size_t, 81, ul_get(ul, 41));
+        cmc_assert_equals(size_t, 101, ul_count(ul));
+        cmc_assert(unrolledlist_valid(ul));
+
+        struct unrolledlist_iter iter;
+
+        ul_iter_init(&iter, ul);
+
+        cmc_assert(ul_iter_go_to(&iter, 60));
+        cmc_assert_equals(ptr, ul_get_node(ul, 60, &offset), ul_iter_node(&iter));
+        cmc_assert_equals(size_t, offset, ul_iter_offset(&iter));
+
+        node = ul_next_node(ul_head(ul));
+
+        cmc_assert_equals(ptr, node, ul_prev_node(ul_next_node(node)));
+
+        ul_free(ul, NULL);
+    });
+
+    CMC_CREATE_TEST(copy_of equals, {
+        struct unrolledlist *ul1 = ul_new();
+
+        cmc_assert_not_equals(ptr, NULL, ul1);
+
+        for (size_t i = 0; i < 300; i++)
+            cmc_assert(ul_push_front(ul1, i));
+
+        struct unrolledlist *ul2 = ul_copy_of(ul1, NULL);
+
+        cmc_assert_not_equals(ptr, NULL, ul2);
+        cmc_assert(unrolledlist_valid(ul2));
+        cmc_assert(ul_equals(ul1, ul2, cmp));
+        cmc_assert(ul_contains(ul2, 299, cmp));
+        cmc_assert(!ul_contains(ul2, 300, cmp));
+
+        /* Equal lists whose nodes are filled differently */
+        ul_clear(ul2, NULL);
+
+        for (size_t i = 300; i > 0; i--)
+            cmc_assert(ul_push_back(ul2, i - 1));
+
+        cmc_assert(ul_equals(ul1, ul2, cmp));
+
+        cmc_assert(ul_pop_at(ul2, 100));
+        cmc_assert(ul_push_at(ul2, 1000, 100));
+
+        cmc_assert(!ul_equals(ul1, ul2, cmp));
+
+        ul_free(ul1, NULL);
+        ul_free(ul2, NULL);
+    });
+});
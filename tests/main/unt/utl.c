@@ -4,6 +4,8 @@
 
 #include <stdlib.h>
 #include <cmc/hashmap.h>
+#include <utl/arena.h>
+#include <utl/cmc_alloc.h>
 
 int cmp(size_t a, size_t b)
 {
@@ -41,4 +43,96 @@ size_t hash0(size_t a)
     return 0;
 }
 
+size_t hash_calls = 0;
+
+size_t counthash(size_t a)
+{
+    hash_calls++;
+    return hash(a);
+}
+
+/* Reducers used by the parallel_reduce tests */
+size_t add(size_t a, size_t b)
+{
+    return a + b;
+}
+
+size_t add_entry(size_t partial, size_t key, size_t value)
+{
+    return partial + key + value;
+}
+
+/* Writer and reader used by the serialization tests, each element is */
+/* stored in 8 bytes regardless of the size of size_t */
+bool write_size(size_t a, FILE *file)
+{
+    uint64_t value = a;
+
+    return fwrite(&value, sizeof(value), 1, file) == 1;
+}
+
+bool read_size(size_t *a, FILE *file)
+{
+    uint64_t value;
+
+    if (fread(&value, sizeof(value), 1, file) != 1)
+        return false;
+
+    *a = (size_t)value;
+
+    return true;
+}
+
+/* Allocation functions that count the blocks that were not freed yet, so */
+/* the tests of PFX_new_custom can check that all of them go through it */
+size_t count_alloc_live = 0;
+
+void *count_malloc(size_t size)
+{
+    void *result = malloc(size);
+
+    if (result)
+        count_alloc_live++;
+
+    return result;
+}
+
+void *count_calloc(size_t count, size_t size)
+{
+    void *result = calloc(count, size);
+
+    if (result)
+        count_alloc_live++;
+
+    return result;
+}
+
+void *count_realloc(void *ptr, size_t size)
+{
+    void *result = realloc(ptr, size);
+
+    if (result && !ptr)
+        count_alloc_live++;
+
+    return result;
+}
+
+void count_free(void *ptr)
+{
+    if (ptr)
+        count_alloc_live--;
+
+    free(ptr);
+}
+
+struct cmc_alloc_node count_alloc = { count_malloc, count_calloc, count_realloc, count_free };
+
+void count_alloc_reset(void)
+{
+    count_alloc_live = 0;
+}
+
+/* Arena of the tests of PFX_release */
+CMC_GENERATE_ARENA(test_arena)
+
 #endif /* CMC_UNIT_TEST_UTL__ */
@@ -0,0 +1,196 @@
+#include "utl.c"
+#include <utl/assert.h>
+#include <utl/log.h>
+#include <utl/test.h>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <cmc/wsdeque.h>
+
+CMC_GENERATE_WSDEQUE(wsd, wsdeque, size_t)
+
+#define WSDEQUE_THIEVES 3
+#define WSDEQUE_TASKS 100000
+
+struct wsdeque_thief
+{
+    struct wsdeque *deque;
+    atomic_bool *done;
+    size_t sum;
+    size_t taken;
+    unsigned char *seen;
+};
+
+static void *wsdeque_thief_run(void *arg)
+{
+    struct wsdeque_thief *thief = arg;
+
+    while (true)
+    {
+        size_t value;
+
+        if (wsd_steal(thief->deque, &value))
+        {
+            thief->sum += value;
+            thief->taken++;
+            thief->seen[value]++;
+        }
+        else if (atomic_load(thief->done) && wsd_empty(thief->deque))
+            return NULL;
+        else
+            sched_yield();
+    }
+}
+
+CMC_CREATE_UNIT(wsdeque_test, true, {
+    CMC_CREATE_TEST(new, {
+        struct wsdeque *d = wsd_new(3);
+
+        cmc_assert_not_equals(ptr, NULL, d);
+        cmc_assert_equals(size_t, 4, wsd_capacity(d));
+        cmc_assert(wsd_empty(d));
+
+        size_t value;
+
+        cmc_assert(!wsd_pop(d, &value));
+        cmc_assert(!wsd_steal(d, &value));
+
+        wsd_free(d, NULL);
+
+        cmc_assert_equals(ptr, NULL, wsd_new(0));
+    });
+
+    CMC_CREATE_TEST(new_custom[count allocations], {
+        count_alloc_reset();
+
+        struct wsdeque *d = wsd_new_custom(3, &count_alloc);
+
+        cmc_assert_not_equals(ptr, NULL, d);
+
+        for (size_t i = 0; i < 1000; i++)
+            wsd_push(d, i);
+
+        cmc_assert_greater(size_t, 0, count_alloc_live);
+
+        wsd_free(d, NULL);
+
+        cmc_assert_equals(size_t, 0, count_alloc_live);
+    });
+
+    CMC_CREATE_TEST(push pop steal, {
+        struct wsdeque *d = wsd_new(2);
+
+        cmc_assert_not_equals(ptr, NULL, d);
+
+        /* The array grows a few times */
+        for (size_t i = 0; i < 1000; i++)
+            cmc_assert(wsd_push(d, i));
+
+        cmc_assert_equals(size_t, 1000, wsd_count(d));
+        cmc_assert_equals(size_t, 1024, wsd_capacity(d));
+
+        size_t value;
+
+        /* The owner takes the newest elements and thieves the oldest */
+        for (size_t i = 0; i < 500; i++)
+        {
+            cmc_assert(wsd_pop(d, &value));
+            cmc_assert_equals(size_t, 999 - i, value);
+            cmc_assert(wsd_steal(d, &value));
+            cmc_assert_equals(size_t, i, value);
+        }
+
+        cmc_assert(wsd_empty(d));
+        cmc_assert(!wsd_pop(d, &value));
+        cmc_assert(!wsd_steal(d, &value));
+
+        /* Wrapping around the array */
+        for (size_t i = 0; i < 5000; i++)
+        {
+            cmc_assert(wsd_push(d, i));
+            cmc_assert(wsd_steal(d, &value));
+            cmc_assert_equals(size_t, i, value);
+        }
+
+        cmc_assert_equals(size_t, 1024, wsd_capacity(d));
+
+        wsd_free(d, NULL);
+    });
+
+    CMC_CREATE_TEST(threads, {
+        struct wsdeque *d = wsd_new(16);
+
+        cmc_assert_not_equals(ptr, NULL, d);
+
+        unsigned char *seen = calloc(WSDEQUE_TASKS, 1);
+
+        cmc_assert_not_equals(ptr, NULL, seen);
+
+        atomic_bool done;
+        atomic_init(&done, false);
+
+        pthread_t threads[WSDEQUE_THIEVES];
+        struct wsdeque_thief thieves[WSDEQUE_THIEVES + 1];
+
+        for (size_t i = 0; i <= WSDEQUE_THIEVES; i++)
+        {
+            thieves[i].deque = d;
+            thieves[i].done = &done;
+            thieves[i].sum = 0;
+            thieves[i].taken = 0;
+            thieves[i].seen = seen;
+        }
+
+        for (size_t i = 0; i < WSDEQUE_THIEVES; i++)
+        {
+            int result = pthread_create(&threads[i], NULL, wsdeque_thief_run, &thieves[i]);
+
+            cmc_assert_equals(int32_t, 0, result);
+        }
+
+        /* The owner pushes every task and pops one for every three */
+        struct wsdeque_thief *owner = &thieves[WSDEQUE_THIEVES];
+
+        for (size_t i = 0; i < WSDEQUE_TASKS; i++)
+        {
+            cmc_assert(wsd_push(d, i));
+
+            size_t value;
+
+            if (i % 3 == 0 && wsd_pop(d, &value))
+            {
+                owner->sum += value;
+                owner->taken++;
+                owner->seen[value]++;
+            }
+        }
+
+        atomic_store(&done, true);
+
+        for (size_t i = 0; i < WSDEQUE_THIEVES; i++)
+            pthread_join(threads[i], NULL);
+
+        size_t sum = 0;
+        size_t taken = 0;
+
+        for (size_t i = 0; i <= WSDEQUE_THIEVES; i++)
+        {
+            sum += thieves[i].sum;
+            taken += thieves[i].taken;
+        }
+
+        cmc_assert_equals(size_t, WSDEQUE_TASKS, taken);
+        cmc_assert_equals(size_t, (size_t)WSDEQUE_TASKS * (WSDEQUE_TASKS - 1) / 2, sum);
+
+        size_t once = 0;
+
+        for (size_t i = 0; i < WSDEQUE_TASKS; i++)
+            once += seen[i] == 1;
+
+        cmc_assert_equals(size_t, WSDEQUE_TASKS, once);
+
+        free(seen);
+        wsd_free(d, NULL);
+    });
+});
@@ -0,0 +1,95 @@
+/* Queue and Deque with the power of two capacities of CMC_RING_POW2 */
+#define CMC_RING_POW2 1
+
+#include "../src/cmc/deque.h"
+#include "../src/cmc/queue.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+CMC_GENERATE_QUEUE(q, queue, size_t)
+CMC_GENERATE_DEQUE(d, deque, size_t)
+
+static bool pow2(size_t n)
+{
+    return n > 0 && (n & (n - 1)) == 0;
+}
+
+int main(void)
+{
+    struct queue *q = q_new(100);
+    struct deque *d = d_new(3);
+
+    assert(q_capacity(q) == 128);
+    assert(d_capacity(d) == 4);
+
+    /* The oldest element is always the front of both */
+    size_t front = 0;
+    size_t back = 0;
+
+    for (size_t i = 0; i < 100000; i++)
+    {
+        size_t op = (i * 7919) % 5;
+
+        if (op < 3 || front == back)
+        {
+            assert(q_enqueue(q, back));
+            assert(d_push_back(d, back));
+            back++;
+        }
+        else
+        {
+            assert(q_peek(q) == front);
+            assert(d_front(d) == front);
+            assert(q_dequeue(q));
+            assert(d_pop_front(d));
+            front++;
+        }
+
+        assert(pow2(q_capacity(q)) && pow2(d_capacity(d)));
+        assert(q_count(q) == back - front && d_count(d) == back - front);
+    }
+
+    for (size_t i = 0; i < q_count(q); i++)
+        assert(q_get(q, i) == front + i && d_get(d, i) == front + i);
+
+    assert(d_back(d) == back - 1);
+
+    struct queue_iter qi;
+    struct deque_iter di;
+
+    size_t expected = front;
+
+    for (q_iter_init(&qi, q); !q_iter_end(&qi); q_iter_next(&qi))
+        assert(q_iter_value(&qi) == expected++);
+
+    for (d_iter_init(&di, d), d_iter_to_end(&di); !d_iter_start(&di); d_iter_prev(&di))
+        assert(d_iter_value(&di) == --expected);
+
+    assert(q_resize(q, q_count(q) + 1) && pow2(q_capacity(q)));
+    assert(d_shrink_to_fit(d) && pow2(d_capacity(d)));
+
+    /* Both ends of the deque wrap around */
+    d_clear(d, NULL);
+
+    for (size_t i = 0; i < 1000; i++)
+    {
+        assert(d_push_front(d, i));
+        assert(d_push_back(d, i));
+    }
+
+    for (size_t i = 1000; i > 0; i--)
+    {
+        assert(d_front(d) == i - 1 && d_back(d) == i - 1);
+        assert(d_pop_front(d) && d_pop_back(d));
+    }
+
+    assert(d_empty(d));
+
+    q_free(q, NULL);
+    d_free(d, NULL);
+
+    printf("Power of two rings passed\n");
+
+    return 0;
+}